@@ -11,8 +11,39 @@
 #include <stdbool.h>
 #include <pthread.h>
 
-// Global mutex for thread safety
-static pthread_mutex_t g_v812_mutex = PTHREAD_MUTEX_INITIALIZER;
+// V812 implementation data (AudioInterface::impl_data)
+//
+// Capture and playback are independent paths: record_mutex guards the
+// capture context setup, play_mutex the playback context setup. The steady
+// state (read/acquire_frame/write) takes neither lock, so a blocking
+// AW_MPI_AI_GetFrame never stalls AW_MPI_AO_SendFrame and vice versa.
+// recording/playing are published with release stores after the context
+// is ready, and cleared before it is torn down.
+typedef struct {
+    bool initialized;
+    bool recording;
+    bool playing;
+    pthread_mutex_t record_mutex;
+    pthread_mutex_t play_mutex;
+    record_ai_context_t* record_ctx;
+    play_ao_context_t* play_ctx;
+    int bit_width;
+    int mic_num;
+    int ai_gain;
+    int ao_volume;
+    
+    // Capture frame lent out by acquire_frame (one outstanding at a time)
+    AUDIO_FRAME_S capture_frame;
+    bool capture_frame_held;
+    
+    // MPP timestamp (microseconds) of the last frame acquired
+    uint64_t capture_time_us;
+    bool capture_time_valid;
+    
+    // Pull-mode playback source, called from the AO "frame released" event
+    audio_pull_callback_t pull_callback;
+    void* pull_user_data;
+} AudioV812Data;
 
 // V812 implementation functions
 static int audio_v812_init_impl(AudioInterface* self);
@@ -20,10 +51,17 @@ static void audio_v812_set_config_impl(AudioInterface* self, unsigned int sample
                                        int channels, int periods, int buffer_size, int period_size);
 static int audio_v812_read_impl(AudioInterface* self, short* buffer, size_t frame_size);
 static int audio_v812_write_impl(AudioInterface* self, short* buffer, size_t frame_size);
+static int audio_v812_acquire_frame_impl(AudioInterface* self, audio_capture_frame_t* frame, int timeout_ms);
+static int audio_v812_release_frame_impl(AudioInterface* self, audio_capture_frame_t* frame);
 static int audio_v812_record_impl(AudioInterface* self);
 static int audio_v812_init_play_impl(AudioInterface* self);
 static bool audio_v812_is_play_buffer_empty_impl(AudioInterface* self);
 static int audio_v812_destroy_impl(AudioInterface* self);
+static int audio_v812_set_pull_source_impl(AudioInterface* self, audio_pull_callback_t callback, void* user_data);
+static int audio_v812_get_capture_time_impl(AudioInterface* self, uint64_t* time_us);
+static int audio_v812_get_play_delay_impl(AudioInterface* self, uint32_t* delay_us);
+static int audio_v812_read_timed_impl(AudioInterface* self, short* buffer, size_t frame_size, uint32_t timeout_us,
+                                      uint64_t* time_us);
 
 // V812 vtable
 static const AudioInterfaceVTable audio_v812_vtable = {
@@ -34,7 +72,13 @@ static const AudioInterfaceVTable audio_v812_vtable = {
     .record = audio_v812_record_impl,
     .init_play = audio_v812_init_play_impl,
     .is_play_buffer_empty = audio_v812_is_play_buffer_empty_impl,
-    .destroy = audio_v812_destroy_impl
+    .destroy = audio_v812_destroy_impl,
+    .set_pull_source = audio_v812_set_pull_source_impl,
+    .acquire_frame = audio_v812_acquire_frame_impl,
+    .release_frame = audio_v812_release_frame_impl,
+    .get_capture_time = audio_v812_get_capture_time_impl,
+    .get_play_delay = audio_v812_get_play_delay_impl,
+    .read_timed = audio_v812_read_timed_impl
 };
 
 static int audio_v812_init_impl(AudioInterface* self) {
@@ -44,27 +88,17 @@ static int audio_v812_init_impl(AudioInterface* self) {
     
     AudioV812Data* v812_data = (AudioV812Data*)self->impl_data;
     
-    pthread_mutex_lock(&g_v812_mutex);
+    // Lock order: record_mutex before play_mutex
+    pthread_mutex_lock(&v812_data->record_mutex);
+    pthread_mutex_lock(&v812_data->play_mutex);
     
-    if (v812_data->initialized) {
-        pthread_mutex_unlock(&g_v812_mutex);
-        return 0; // Already initialized
+    if (!v812_data->initialized) {
+        v812_data->initialized = true;
+        self->is_initialized = true;
     }
     
-    // Initialize V812 specific data
-    v812_data->recording = false;
-    v812_data->playing = false;
-    v812_data->record_ctx = NULL;
-    v812_data->play_ctx = NULL;
-    v812_data->bit_width = 16;
-    v812_data->mic_num = 1;
-    v812_data->ai_gain = 8;
-    v812_data->ao_volume = 8;
-    
-    v812_data->initialized = true;
-    self->is_initialized = true;
-    
-    pthread_mutex_unlock(&g_v812_mutex);
+    pthread_mutex_unlock(&v812_data->play_mutex);
+    pthread_mutex_unlock(&v812_data->record_mutex);
     return 0;
 }
 
@@ -76,65 +110,170 @@ static void audio_v812_set_config_impl(AudioInterface* self, unsigned int sample
     
     AudioV812Data* v812_data = (AudioV812Data*)self->impl_data;
     
-    pthread_mutex_lock(&g_v812_mutex);
+    pthread_mutex_lock(&v812_data->record_mutex);
+    pthread_mutex_lock(&v812_data->play_mutex);
+    
+    // The configuration is baked into the MPP channels when they are created
+    if (v812_data->initialized && !v812_data->record_ctx && !v812_data->play_ctx) {
+        self->sample_rate = sample_rate;
+        self->frame_size = frame_size;
+        self->channels = channels;
+        self->periods = periods;
+        self->buffer_size = buffer_size;
+        self->period_size = period_size;
+        
+        // Update V812 specific configuration
+        v812_data->mic_num = channels;
+    }
     
-    if (!v812_data->initialized) {
-        pthread_mutex_unlock(&g_v812_mutex);
-        return;
+    pthread_mutex_unlock(&v812_data->play_mutex);
+    pthread_mutex_unlock(&v812_data->record_mutex);
+}
+
+/**
+ * Copy an acquired MPP frame out and hand it back; a short frame is padded
+ * with silence
+ */
+static void audio_v812_copy_frame(AudioInterface* self, audio_capture_frame_t* frame, short* buffer,
+                                  size_t frame_size) {
+    size_t samples = frame_size * (size_t)self->channels;
+    size_t available = frame->frame_count * (size_t)self->channels;
+    size_t to_copy = available < samples ? available : samples;
+    memcpy(buffer, frame->data, to_copy * sizeof(short));
+    if (to_copy < samples) {
+        memset(buffer + to_copy, 0, (samples - to_copy) * sizeof(short));
     }
     
-    // Update interface configuration
-    self->sample_rate = sample_rate;
-    self->frame_size = frame_size;
-    self->channels = channels;
-    self->periods = periods;
-    self->buffer_size = buffer_size;
-    self->period_size = period_size;
+    audio_v812_release_frame_impl(self, frame);
+}
+
+static int audio_v812_read_impl(AudioInterface* self, short* buffer, size_t frame_size) {
+    if (!self || !self->impl_data || !buffer || frame_size == 0) {
+        return -1;
+    }
     
-    // Update V812 specific configuration
-    v812_data->mic_num = channels;
+    // Copying read on top of the zero-copy path
+    audio_capture_frame_t frame;
+    if (audio_v812_acquire_frame_impl(self, &frame, 1000) != 0) { // 1 second timeout
+        return -1;
+    }
     
-    pthread_mutex_unlock(&g_v812_mutex);
+    audio_v812_copy_frame(self, &frame, buffer, frame_size);
+    return 0;
 }
 
-static int audio_v812_read_impl(AudioInterface* self, short* buffer, size_t frame_size) {
+/**
+ * AW_MPI_AI_GetFrame waits on the AI channel with its own timeout. It does
+ * not tell a timeout from a device error, so once recording is running a
+ * failed get is reported as a timeout and the caller simply retries.
+ */
+static int audio_v812_read_timed_impl(AudioInterface* self, short* buffer, size_t frame_size, uint32_t timeout_us,
+                                      uint64_t* time_us) {
     if (!self || !self->impl_data || !buffer || frame_size == 0) {
         return -1;
     }
     
     AudioV812Data* v812_data = (AudioV812Data*)self->impl_data;
+    if (!__atomic_load_n(&v812_data->recording, __ATOMIC_ACQUIRE) || v812_data->capture_frame_held) {
+        return -1;
+    }
     
-    pthread_mutex_lock(&g_v812_mutex);
+    audio_capture_frame_t frame;
+    int timeout_ms = (int)(((uint64_t)timeout_us + 999u) / 1000u);
+    if (audio_v812_acquire_frame_impl(self, &frame, timeout_ms) != 0) {
+        return AUDIO_READ_TIMEOUT;
+    }
     
-    if (!v812_data->initialized || !v812_data->recording || !v812_data->record_ctx) {
-        pthread_mutex_unlock(&g_v812_mutex);
+    audio_v812_copy_frame(self, &frame, buffer, frame_size);
+    if (time_us) {
+        *time_us = v812_data->capture_time_us;
+    }
+    return 0;
+}
+
+/**
+ * Lend the MPP capture buffer (AW_MPI_AI_GetFrame) to the caller.
+ * Lock-free: record_ctx only changes in record()/destroy(), which must not
+ * race with an active capture loop.
+ */
+static int audio_v812_acquire_frame_impl(AudioInterface* self, audio_capture_frame_t* frame, int timeout_ms) {
+    if (!self || !self->impl_data || !frame) {
         return -1;
     }
     
-    void* frame_data = NULL;
-    size_t data_size = 0;
+    AudioV812Data* v812_data = (AudioV812Data*)self->impl_data;
     
-    // Get frame from V812 recording context
-    int ret = record_ai_get_frame((record_ai_context_t*)v812_data->record_ctx, 
-                                 &frame_data, &data_size, 1000); // 1 second timeout
+    if (!__atomic_load_n(&v812_data->recording, __ATOMIC_ACQUIRE) || v812_data->capture_frame_held) {
+        return -1;
+    }
     
-    if (ret != 0 || !frame_data || data_size == 0) {
-        pthread_mutex_unlock(&g_v812_mutex);
+    if (record_ai_get_frame(v812_data->record_ctx, &v812_data->capture_frame, timeout_ms) != 0) {
         return -1;
     }
     
-    // Copy data to user buffer (convert bytes to samples)
-    size_t bytes_to_copy = frame_size * sizeof(short);
-    if (data_size < bytes_to_copy) {
-        bytes_to_copy = data_size;
+    size_t frame_bytes = (size_t)self->channels * sizeof(short);
+    if (!v812_data->capture_frame.mpAddr || v812_data->capture_frame.mLen < frame_bytes) {
+        record_ai_release_frame(v812_data->record_ctx, &v812_data->capture_frame);
+        return -1;
     }
-    memcpy(buffer, frame_data, bytes_to_copy);
     
-    // Release the frame
-    record_ai_release_frame((record_ai_context_t*)v812_data->record_ctx);
+    v812_data->capture_frame_held = true;
+    v812_data->capture_time_us = (uint64_t)v812_data->capture_frame.mTimeStamp;
+    v812_data->capture_time_valid = true;
+    frame->data = (const short*)v812_data->capture_frame.mpAddr;
+    frame->frame_count = v812_data->capture_frame.mLen / frame_bytes;
+    frame->token = &v812_data->capture_frame;
+    return 0;
+}
+
+static int audio_v812_release_frame_impl(AudioInterface* self, audio_capture_frame_t* frame) {
+    if (!self || !self->impl_data || !frame) {
+        return -1;
+    }
+    
+    AudioV812Data* v812_data = (AudioV812Data*)self->impl_data;
+    
+    if (!v812_data->capture_frame_held || frame->token != &v812_data->capture_frame) {
+        return -1;
+    }
+    
+    int ret = record_ai_release_frame(v812_data->record_ctx, &v812_data->capture_frame);
+    v812_data->capture_frame_held = false;
+    frame->data = NULL;
+    frame->frame_count = 0;
+    frame->token = NULL;
+    return ret;
+}
+
+static int audio_v812_get_capture_time_impl(AudioInterface* self, uint64_t* time_us) {
+    if (!self || !self->impl_data || !time_us) {
+        return -1;
+    }
+    
+    AudioV812Data* v812_data = (AudioV812Data*)self->impl_data;
+    if (!v812_data->capture_time_valid) {
+        return -1;
+    }
+    *time_us = v812_data->capture_time_us;
+    return 0;
+}
+
+/**
+ * Output delay: the AO buffer depth, i.e. frames submitted in push or pull
+ * mode that the hardware has not released back to the idle list
+ */
+static int audio_v812_get_play_delay_impl(AudioInterface* self, uint32_t* delay_us) {
+    if (!self || !self->impl_data || !delay_us || self->sample_rate == 0 || self->channels <= 0) {
+        return -1;
+    }
     
-    pthread_mutex_unlock(&g_v812_mutex);
-    return (int)(bytes_to_copy / sizeof(short)); // Return number of samples
+    AudioV812Data* v812_data = (AudioV812Data*)self->impl_data;
+    if (!__atomic_load_n(&v812_data->playing, __ATOMIC_ACQUIRE)) {
+        return -1;
+    }
+    size_t frames = play_ao_get_queued_bytes(v812_data->play_ctx) / ((size_t)self->channels * sizeof(short));
+    *delay_us = (uint32_t)((uint64_t)frames * 1000000u / self->sample_rate);
+    return 0;
 }
 
 static int audio_v812_write_impl(AudioInterface* self, short* buffer, size_t frame_size) {
@@ -144,20 +283,83 @@ static int audio_v812_write_impl(AudioInterface* self, short* buffer, size_t fra
     
     AudioV812Data* v812_data = (AudioV812Data*)self->impl_data;
     
-    pthread_mutex_lock(&g_v812_mutex);
+    // Lock-free like acquire_frame: play_ctx only changes in init_play()/destroy()
+    if (!__atomic_load_n(&v812_data->playing, __ATOMIC_ACQUIRE)) {
+        return -1;
+    }
     
-    if (!v812_data->initialized || !v812_data->playing || !v812_data->play_ctx) {
-        pthread_mutex_unlock(&g_v812_mutex);
+    // In pull mode the AO event thread owns the idle frames
+    if (__atomic_load_n(&v812_data->pull_callback, __ATOMIC_ACQUIRE)) {
         return -1;
     }
     
-    // Send frame to V812 playback context
-    size_t bytes_to_send = frame_size * sizeof(short);
-    int ret = play_ao_send_frame((play_ao_context_t*)v812_data->play_ctx, 
-                                buffer, bytes_to_send, 1000); // 1 second timeout
+    play_ao_context_t* play_ctx = v812_data->play_ctx;
+    size_t frame_bytes = (size_t)self->channels * sizeof(short);
+    size_t chunk_frames = (size_t)self->frame_size;
+    const char* src = (const char*)buffer;
+    
+    // Copy into the frame manager's idle AUDIO_FRAME_S buffers, one AO period
+    // at a time; play_ao_get_idle_frame waits for the hardware to release one
+    while (frame_size > 0) {
+        size_t frames = frame_size < chunk_frames ? frame_size : chunk_frames;
+        AUDIO_FRAME_S* frame = play_ao_get_idle_frame(play_ctx);
+        if (!frame) {
+            return -1;
+        }
+        
+        memcpy(frame->mpAddr, src, frames * frame_bytes);
+        frame->mLen = (unsigned int)(frames * frame_bytes);
+        if (play_ao_submit_frame(play_ctx, frame) != 0) {
+            return -1;
+        }
+        
+        src += frames * frame_bytes;
+        frame_size -= frames;
+    }
+    
+    return 0;
+}
+
+/**
+ * play_ao data request callback: the pull source decodes straight into the
+ * idle AUDIO_FRAME_S buffer handed out by the frame manager
+ */
+static int audio_v812_pull_trampoline(void* buffer, size_t size, void* user_data) {
+    AudioInterface* self = (AudioInterface*)user_data;
+    AudioV812Data* v812_data = (AudioV812Data*)self->impl_data;
+    
+    audio_pull_callback_t callback = __atomic_load_n(&v812_data->pull_callback, __ATOMIC_ACQUIRE);
+    if (!callback) {
+        return 0;
+    }
     
-    pthread_mutex_unlock(&g_v812_mutex);
-    return (ret == 0) ? (int)frame_size : -1;
+    size_t frame_bytes = (size_t)self->channels * sizeof(short);
+    size_t frames = callback(v812_data->pull_user_data, (short*)buffer, size / frame_bytes);
+    return (int)(frames * frame_bytes);
+}
+
+static int audio_v812_set_pull_source_impl(AudioInterface* self, audio_pull_callback_t callback, void* user_data) {
+    if (!self || !self->impl_data) {
+        return -1;
+    }
+    
+    AudioV812Data* v812_data = (AudioV812Data*)self->impl_data;
+    
+    pthread_mutex_lock(&v812_data->play_mutex);
+    
+    // Publish user_data before the callback that uses it
+    __atomic_store_n(&v812_data->pull_callback, NULL, __ATOMIC_RELEASE);
+    v812_data->pull_user_data = user_data;
+    __atomic_store_n(&v812_data->pull_callback, callback, __ATOMIC_RELEASE);
+    
+    int ret = 0;
+    if (v812_data->play_ctx) {
+        ret = play_ao_set_data_request_callback(v812_data->play_ctx,
+                                                callback ? audio_v812_pull_trampoline : NULL, self);
+    }
+    
+    pthread_mutex_unlock(&v812_data->play_mutex);
+    return ret;
 }
 
 static int audio_v812_record_impl(AudioInterface* self) {
@@ -167,41 +369,51 @@ static int audio_v812_record_impl(AudioInterface* self) {
     
     AudioV812Data* v812_data = (AudioV812Data*)self->impl_data;
     
-    pthread_mutex_lock(&g_v812_mutex);
+    pthread_mutex_lock(&v812_data->record_mutex);
     
     if (!v812_data->initialized) {
-        pthread_mutex_unlock(&g_v812_mutex);
+        pthread_mutex_unlock(&v812_data->record_mutex);
         return -1;
     }
     
     if (!v812_data->recording) {
         // Initialize recording context if not exists
         if (!v812_data->record_ctx) {
-            int ret = record_ai_init((record_ai_context_t**)&v812_data->record_ctx,
-                                   self->sample_rate,
-                                   self->channels,
-                                   v812_data->bit_width,
-                                   self->frame_size,
-                                   v812_data->mic_num,
-                                   v812_data->ai_gain);
-            if (ret != 0) {
-                pthread_mutex_unlock(&g_v812_mutex);
+            record_ai_context_t* record_ctx = (record_ai_context_t*)calloc(1, sizeof(record_ai_context_t));
+            if (!record_ctx) {
+                pthread_mutex_unlock(&v812_data->record_mutex);
+                return -1;
+            }
+            
+            record_ai_config_t config;
+            memset(&config, 0, sizeof(config));
+            config.sample_rate = (int)self->sample_rate;
+            config.channel_count = self->channels;
+            config.bit_width = v812_data->bit_width;
+            config.frame_size = self->frame_size;
+            config.mic_num = v812_data->mic_num;
+            config.ai_gain = v812_data->ai_gain;
+            
+            if (record_ai_init(record_ctx, &config) != 0) {
+                free(record_ctx);
+                pthread_mutex_unlock(&v812_data->record_mutex);
                 return -1;
             }
+            v812_data->record_ctx = record_ctx;
         }
         
-        // Start recording
-        int ret = record_ai_start((record_ai_context_t*)v812_data->record_ctx);
+        // Start recording (frames are pulled with read/acquire_frame)
+        int ret = record_ai_start(v812_data->record_ctx, NULL, NULL);
         if (ret == 0) {
-            v812_data->recording = true;
+            __atomic_store_n(&v812_data->recording, true, __ATOMIC_RELEASE);
             self->is_recording = true;
         } else {
-            pthread_mutex_unlock(&g_v812_mutex);
+            pthread_mutex_unlock(&v812_data->record_mutex);
             return -1;
         }
     }
     
-    pthread_mutex_unlock(&g_v812_mutex);
+    pthread_mutex_unlock(&v812_data->record_mutex);
     return 0;
 }
 
@@ -212,38 +424,55 @@ static int audio_v812_init_play_impl(AudioInterface* self) {
     
     AudioV812Data* v812_data = (AudioV812Data*)self->impl_data;
     
-    pthread_mutex_lock(&g_v812_mutex);
+    pthread_mutex_lock(&v812_data->play_mutex);
     
     if (!v812_data->initialized) {
-        pthread_mutex_unlock(&g_v812_mutex);
+        pthread_mutex_unlock(&v812_data->play_mutex);
         return -1;
     }
     
+    if (v812_data->playing) {
+        pthread_mutex_unlock(&v812_data->play_mutex);
+        return 0;
+    }
+    
     // Initialize playback context if not exists
     if (!v812_data->play_ctx) {
-        int ret = play_ao_init((play_ao_context_t**)&v812_data->play_ctx,
-                              self->sample_rate,
-                              self->channels,
-                              v812_data->bit_width,
-                              self->frame_size,
-                              v812_data->ao_volume);
-        if (ret != 0) {
-            pthread_mutex_unlock(&g_v812_mutex);
+        play_ao_context_t* play_ctx = (play_ao_context_t*)calloc(1, sizeof(play_ao_context_t));
+        if (!play_ctx) {
+            pthread_mutex_unlock(&v812_data->play_mutex);
             return -1;
         }
+        
+        play_ao_config_t config;
+        memset(&config, 0, sizeof(config));
+        config.sample_rate = (int)self->sample_rate;
+        config.channel_count = self->channels;
+        config.bit_width = v812_data->bit_width;
+        config.frame_size = self->frame_size;
+        config.ao_volume = v812_data->ao_volume;
+        
+        if (play_ao_init(play_ctx, &config) != 0) {
+            free(play_ctx);
+            pthread_mutex_unlock(&v812_data->play_mutex);
+            return -1;
+        }
+        v812_data->play_ctx = play_ctx;
     }
     
-    // Start playback
-    int ret = play_ao_start((play_ao_context_t*)v812_data->play_ctx);
+    // Start playback: pulled from the AO event when a pull source is set,
+    // otherwise pushed with write
+    int ret = play_ao_start(v812_data->play_ctx,
+                            v812_data->pull_callback ? audio_v812_pull_trampoline : NULL, self);
     if (ret == 0) {
-        v812_data->playing = true;
+        __atomic_store_n(&v812_data->playing, true, __ATOMIC_RELEASE);
         self->is_playing = true;
     } else {
-        pthread_mutex_unlock(&g_v812_mutex);
+        pthread_mutex_unlock(&v812_data->play_mutex);
         return -1;
     }
     
-    pthread_mutex_unlock(&g_v812_mutex);
+    pthread_mutex_unlock(&v812_data->play_mutex);
     return 0;
 }
 
@@ -254,16 +483,12 @@ static bool audio_v812_is_play_buffer_empty_impl(AudioInterface* self) {
     
     AudioV812Data* v812_data = (AudioV812Data*)self->impl_data;
     
-    pthread_mutex_lock(&g_v812_mutex);
-    
-    bool is_empty = true;
-    if (v812_data->initialized && v812_data->playing && v812_data->play_ctx) {
-        // For V812, we consider buffer empty if not playing
-        is_empty = !play_ao_is_playing((play_ao_context_t*)v812_data->play_ctx);
+    if (!__atomic_load_n(&v812_data->playing, __ATOMIC_ACQUIRE)) {
+        return true;
     }
     
-    pthread_mutex_unlock(&g_v812_mutex);
-    return is_empty;
+    // For V812, we consider buffer empty if not playing
+    return !play_ao_is_playing(v812_data->play_ctx);
 }
 
 static int audio_v812_destroy_impl(AudioInterface* self) {
@@ -273,39 +498,37 @@ static int audio_v812_destroy_impl(AudioInterface* self) {
     
     AudioV812Data* v812_data = (AudioV812Data*)self->impl_data;
     
-    pthread_mutex_lock(&g_v812_mutex);
-    
-    if (!v812_data->initialized) {
-        pthread_mutex_unlock(&g_v812_mutex);
-        return 0;
-    }
-    
-    // Stop and destroy recording context
+    // Capture and playback threads must be stopped before destroy
+    pthread_mutex_lock(&v812_data->record_mutex);
+    __atomic_store_n(&v812_data->recording, false, __ATOMIC_RELEASE);
     if (v812_data->record_ctx) {
-        if (v812_data->recording) {
-            record_ai_stop((record_ai_context_t*)v812_data->record_ctx);
+        if (v812_data->capture_frame_held) {
+            record_ai_release_frame(v812_data->record_ctx, &v812_data->capture_frame);
+            v812_data->capture_frame_held = false;
         }
-        record_ai_destroy((record_ai_context_t*)v812_data->record_ctx);
+        record_ai_destroy(v812_data->record_ctx); // Stops recording if active
+        free(v812_data->record_ctx);
         v812_data->record_ctx = NULL;
-        v812_data->recording = false;
     }
+    pthread_mutex_unlock(&v812_data->record_mutex);
     
-    // Stop and destroy playback context
+    pthread_mutex_lock(&v812_data->play_mutex);
+    __atomic_store_n(&v812_data->playing, false, __ATOMIC_RELEASE);
     if (v812_data->play_ctx) {
-        if (v812_data->playing) {
-            play_ao_stop((play_ao_context_t*)v812_data->play_ctx);
-        }
-        play_ao_destroy((play_ao_context_t*)v812_data->play_ctx);
+        play_ao_destroy(v812_data->play_ctx); // Stops playback if active
+        free(v812_data->play_ctx);
         v812_data->play_ctx = NULL;
-        v812_data->playing = false;
     }
+    pthread_mutex_unlock(&v812_data->play_mutex);
+    
+    pthread_mutex_destroy(&v812_data->record_mutex);
+    pthread_mutex_destroy(&v812_data->play_mutex);
+    free(v812_data);
+    self->impl_data = NULL;
     
-    v812_data->initialized = false;
     self->is_initialized = false;
     self->is_recording = false;
     self->is_playing = false;
-    
-    pthread_mutex_unlock(&g_v812_mutex);
     return 0;
 }
 
@@ -334,6 +557,8 @@ AudioInterface* audio_v812_create(void) {
     v812_data->mic_num = 1;
     v812_data->ai_gain = 8;
     v812_data->ao_volume = 8;
+    pthread_mutex_init(&v812_data->record_mutex, NULL);
+    pthread_mutex_init(&v812_data->play_mutex, NULL);
     
     // Initialize AudioInterface
     memset(interface, 0, sizeof(AudioInterface));
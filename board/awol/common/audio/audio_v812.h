@@ -28,6 +28,20 @@ int audio_v812_init(void);
  */
 int audio_v812_destroy(void);
 
+/**
+ * @brief Create the V812 AudioInterface adapter
+ * 
+ * Supports zero-copy capture (audio_interface_acquire_frame), which lends
+ * the MPP AUDIO_FRAME_S buffer to the caller until it is released, and
+ * pull-mode playback (audio_interface_set_pull_source), where the pull
+ * source fills idle AO frames in place whenever the hardware releases one.
+ * The MPP frame timestamp is reported as the capture time
+ * (audio_interface_get_capture_time).
+ * 
+ * @return AudioInterface instance, NULL on failure
+ */
+AudioInterface* audio_v812_create(void);
+
 /* ========== Recording Functions ========== */
 
 /**
@@ -31,6 +31,7 @@
  */
 
 #include "play_ao.h"
+#include "audio_dsp.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -46,6 +47,9 @@
 /* Default frame buffer count */
 #define DEFAULT_FRAME_COUNT 8
 
+/* Frames kept queued on the AO channel in pull mode (latency vs. underrun margin) */
+#define PULL_QUEUE_DEPTH 3
+
 /**
  * @brief Frame manager function implementations
  */
@@ -250,6 +254,60 @@ static void config_aio_attr_by_config(AIO_ATTR_S* dst, const play_ao_config_t* s
     }
 }
 
+/**
+ * @brief Size of one AO period in bytes
+ */
+static size_t play_ao_frame_bytes(const play_ao_context_t* ctx)
+{
+    return (size_t)ctx->config.frame_size * ctx->config.channel_count * (ctx->config.bit_width / 8);
+}
+
+/**
+ * @brief Pull mode: fill the first idle frame from the data request callback and queue it
+ *
+ * The callback writes straight into the frame manager's AUDIO_FRAME_S buffer.
+ * A short or failed read is padded with silence so the hardware clock keeps
+ * the refill cycle going.
+ */
+static int play_ao_pull_frame(play_ao_context_t* ctx)
+{
+    int (*callback)(void*, size_t, void*) = __atomic_load_n(&ctx->data_request_callback, __ATOMIC_ACQUIRE);
+    if (!callback || !ctx->is_playing) {
+        return -1;
+    }
+    
+    AUDIO_FRAME_S* frame = ctx->frame_manager.prefetch_first_idle_frame(&ctx->frame_manager);
+    if (!frame) {
+        return -1;
+    }
+    
+    size_t capacity = play_ao_frame_bytes(ctx);
+    int produced = callback(frame->mpAddr, capacity, ctx->user_data);
+    if (produced < 0) {
+        produced = 0;
+    } else if ((size_t)produced > capacity) {
+        produced = (int)capacity;
+    }
+    if ((size_t)produced < capacity) {
+        memset((char*)frame->mpAddr + produced, 0, capacity - (size_t)produced);
+    }
+    frame->mLen = (unsigned int)capacity;
+    
+    return play_ao_submit_frame(ctx, frame);
+}
+
+/**
+ * @brief Pull mode: queue frames until PULL_QUEUE_DEPTH are in flight
+ */
+static void play_ao_prime_pull(play_ao_context_t* ctx)
+{
+    for (int i = 0; i < PULL_QUEUE_DEPTH; i++) {
+        if (play_ao_pull_frame(ctx) != 0) {
+            break;
+        }
+    }
+}
+
 /**
  * @brief AO callback wrapper
  */
@@ -269,6 +327,9 @@ static ERRORTYPE ao_callback_wrapper(void* cookie, MPP_CHN_S* chn, MPP_EVENT_TYP
                     cdx_sem_up(&ctx->sem_frame_come);
                 }
                 pthread_mutex_unlock(&ctx->wait_frame_lock);
+                
+                /* Pull mode: the released period is the "frame needed" signal */
+                play_ao_pull_frame(ctx);
             }
             break;
         }
@@ -427,14 +488,18 @@ int play_ao_start(play_ao_context_t* ctx,
         return -1;
     }
     
-    ctx->data_request_callback = data_request_callback;
     ctx->user_data = user_data;
+    __atomic_store_n(&ctx->data_request_callback, data_request_callback, __ATOMIC_RELEASE);
     ctx->is_playing = true;
     ctx->eof_flag = false;
     
     pthread_mutex_unlock(&ctx->mutex);
     
-    alogd("Playback started");
+    if (data_request_callback) {
+        play_ao_prime_pull(ctx);
+    }
+    
+    alogd("Playback started (%s mode)", data_request_callback ? "pull" : "push");
     return 0;
 }
 
@@ -460,7 +525,7 @@ int play_ao_stop(play_ao_context_t* ctx)
     }
     
     ctx->is_playing = false;
-    ctx->data_request_callback = NULL;
+    __atomic_store_n(&ctx->data_request_callback, NULL, __ATOMIC_RELEASE);
     ctx->user_data = NULL;
     
     pthread_mutex_unlock(&ctx->mutex);
@@ -493,6 +558,36 @@ int play_ao_send_frame(play_ao_context_t* ctx, const AUDIO_FRAME_S* frame, int t
     return 0;
 }
 
+int play_ao_set_data_request_callback(play_ao_context_t* ctx,
+                                     int (*data_request_callback)(void* buffer, size_t size, void* user_data),
+                                     void* user_data)
+{
+    if (!ctx) {
+        aloge("Invalid context");
+        return -EINVAL;
+    }
+    
+    pthread_mutex_lock(&ctx->mutex);
+    
+    bool was_pulling = __atomic_load_n(&ctx->data_request_callback, __ATOMIC_ACQUIRE) != NULL;
+    
+    /* Publish user_data before the callback that uses it */
+    __atomic_store_n(&ctx->data_request_callback, NULL, __ATOMIC_RELEASE);
+    ctx->user_data = user_data;
+    __atomic_store_n(&ctx->data_request_callback, data_request_callback, __ATOMIC_RELEASE);
+    
+    bool prime = ctx->is_playing && data_request_callback && !was_pulling;
+    
+    pthread_mutex_unlock(&ctx->mutex);
+    
+    /* Frames already in flight keep the refill cycle going; start one if none are */
+    if (prime) {
+        play_ao_prime_pull(ctx);
+    }
+    
+    return 0;
+}
+
 AUDIO_FRAME_S* play_ao_get_idle_frame(play_ao_context_t* ctx)
 {
     if (!ctx) {
@@ -524,6 +619,11 @@ int play_ao_submit_frame(play_ao_context_t* ctx, AUDIO_FRAME_S* frame)
         return -EINVAL;
     }
     
+    /* Software volume, applied in place before the frame is queued */
+    if (ctx->config.bit_width == 16 && ctx->config.ao_soft_volume > 0 && ctx->config.ao_soft_volume != 100) {
+        audio_dsp_gain((short*)frame->mpAddr, frame->mLen / sizeof(short), ctx->config.ao_soft_volume / 100.0f);
+    }
+    
     /* Mark frame as in use */
     int ret = ctx->frame_manager.use_frame(&ctx->frame_manager, frame);
     if (ret != 0) {
@@ -619,6 +719,23 @@ bool play_ao_is_playing(const play_ao_context_t* ctx)
     return ctx->is_playing;
 }
 
+size_t play_ao_get_queued_bytes(play_ao_context_t* ctx)
+{
+    if (!ctx) {
+        return 0;
+    }
+    
+    size_t bytes = 0;
+    play_ao_frame_node_t* node;
+    pthread_mutex_lock(&ctx->frame_manager.lock);
+    list_for_each_entry(node, &ctx->frame_manager.using_list, list) {
+        bytes += node->audio_frame.mLen;
+    }
+    pthread_mutex_unlock(&ctx->frame_manager.lock);
+    
+    return bytes;
+}
+
 int play_ao_destroy(play_ao_context_t* ctx)
 {
     if (!ctx) {
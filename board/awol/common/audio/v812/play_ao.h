@@ -57,7 +57,7 @@ typedef struct {
     int bit_width;          /**< Bit width (16, 24, 32) */
     int frame_size;         /**< Frame size in samples */
     int ao_volume;          /**< Audio output volume */
-    int ao_soft_volume;     /**< Software volume control */
+    int ao_soft_volume;     /**< Software gain in percent applied to 16-bit frames (<= 0 or 100: off) */
     bool save_data_flag;    /**< Flag to save output data */
 } play_ao_config_t;
 
@@ -125,8 +125,15 @@ int play_ao_init(play_ao_context_t* ctx, const play_ao_config_t* config);
 /**
  * @brief Start audio playback
  * 
+ * With a data_request_callback the channel runs in pull mode: each time the
+ * hardware releases a frame, the callback is invoked (on the MPP event
+ * thread) to fill the next idle AUDIO_FRAME_S in place, and
+ * play_ao_send_frame/play_ao_submit_frame must not be used. Pass NULL for
+ * push mode.
+ * 
  * @param ctx Pointer to playback context
  * @param data_request_callback Callback function to request audio data
+ *                              Return: number of bytes written (short reads are padded with silence)
  * @param user_data User data passed to callback
  * @return 0 on success, negative error code on failure
  */
@@ -152,6 +159,18 @@ int play_ao_stop(play_ao_context_t* ctx);
  */
 int play_ao_send_frame(play_ao_context_t* ctx, const AUDIO_FRAME_S* frame, int timeout_ms);
 
+/**
+ * @brief Switch between pull mode (callback) and push mode (NULL) at runtime
+ * 
+ * @param ctx Pointer to playback context
+ * @param data_request_callback Callback function to request audio data, NULL for push mode
+ * @param user_data User data passed to callback
+ * @return 0 on success, negative error code on failure
+ */
+int play_ao_set_data_request_callback(play_ao_context_t* ctx,
+                                     int (*data_request_callback)(void* buffer, size_t size, void* user_data),
+                                     void* user_data);
+
 /**
  * @brief Set audio output volume
  * 
@@ -205,6 +224,14 @@ int play_ao_destroy(play_ao_context_t* ctx);
  */
 bool play_ao_is_playing(const play_ao_context_t* ctx);
 
+/**
+ * @brief Get the PCM submitted to AO that the hardware has not released yet
+ * 
+ * @param ctx Pointer to playback context
+ * @return Bytes held by frames in the using list (0 if none or invalid context)
+ */
+size_t play_ao_get_queued_bytes(play_ao_context_t* ctx);
+
 /**
  * @brief Get an idle frame for filling with audio data
  * 
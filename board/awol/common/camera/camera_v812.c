@@ -0,0 +1,576 @@
+/**
+ * @file camera_v812.c
+ * @brief V812 camera implementation on Allwinner MPP VI + VENC JPEG
+ */
+
+#include "camera_v812.h"
+#include "log/linx_log.h"
+#include "log/linx_alloc.h"
+#include "mcp/mcp_buffer.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include <mpi_sys.h>
+#include <mpi_vi.h>
+#include <mpi_isp.h>
+#include <mpi_venc.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_BOARD);
+
+#ifndef CAMERA_V812_VI_DEV
+#define CAMERA_V812_VI_DEV 0        // VIPP fed by the sensor
+#endif
+#ifndef CAMERA_V812_ISP_DEV
+#define CAMERA_V812_ISP_DEV 0
+#endif
+#ifndef CAMERA_V812_VENC_CHN
+#define CAMERA_V812_VENC_CHN 0
+#endif
+#define CAMERA_V812_VI_CHN 0
+#define CAMERA_V812_VI_BUFFERS 3
+#define CAMERA_V812_FPS 30
+#define CAMERA_V812_FRAME_WAIT_MS 2000  // First frame after start-up
+#define CAMERA_V812_ENCODE_WAIT_MS 1000
+
+/**
+ * VENC output lent to a captured frame
+ *
+ * A stream is held (stream_held) from GetStream until it is handed back;
+ * streams go back to the encoder oldest first, and only once nothing points
+ * into them any more (stream_needed). The slot is free for the next capture
+ * when it no longer holds a stream and no reference to `buffer` is left.
+ */
+typedef struct CameraV812Slot {
+    mcp_buffer_t buffer;            // data/size of the JPEG, owner = slot
+    struct CameraV812Data* camera;
+    VENC_STREAM_S stream;
+    VENC_PACK_S pack;
+    uint64_t seq;                   // Capture order
+    uint8_t* copy;                  // Contiguous copy of a wrapped JPEG, NULL if lent in place
+    bool stream_held;
+    bool stream_needed;             // `buffer` points into the stream
+    bool lent;                      // References to `buffer` remain
+} CameraV812Slot;
+
+// V812 implementation data (CameraInterface::impl_data)
+//
+// capture_mutex serialises captures and pipeline changes; slot_mutex guards
+// the slots and is also taken by the release callback, which may run on any
+// thread that drops the last reference to a frame.
+typedef struct CameraV812Data {
+    bool initialized;
+    bool pipeline_running;
+    CameraConfig config;
+    int venc_quality;               // Quality the VENC channel is set to
+    pthread_mutex_t capture_mutex;
+    pthread_mutex_t slot_mutex;
+    CameraV812Slot slots[CAMERA_V812_STREAM_SLOTS];
+    uint64_t next_seq;
+} CameraV812Data;
+
+// V812 implementation functions
+static int camera_v812_init(CameraInterface* self);
+static int camera_v812_set_config(CameraInterface* self, const CameraConfig* config);
+static int camera_v812_capture(CameraInterface* self, CameraFrameBuffer* frame);
+static int camera_v812_set_h_mirror(CameraInterface* self, bool enabled);
+static int camera_v812_set_v_flip(CameraInterface* self, bool enabled);
+static int camera_v812_set_explain_url(CameraInterface* self, const char* url, const char* token);
+static int camera_v812_explain(CameraInterface* self, const char* question, char* response, size_t response_size);
+static int camera_v812_release_frame(CameraInterface* self, CameraFrameBuffer* frame);
+static int camera_v812_destroy(CameraInterface* self);
+
+// V812 vtable
+static const CameraInterfaceVTable camera_v812_vtable = {
+    .init = camera_v812_init,
+    .set_config = camera_v812_set_config,
+    .capture = camera_v812_capture,
+    .set_h_mirror = camera_v812_set_h_mirror,
+    .set_v_flip = camera_v812_set_v_flip,
+    .set_explain_url = camera_v812_set_explain_url,
+    .explain = camera_v812_explain,
+    .release_frame = camera_v812_release_frame,
+    .destroy = camera_v812_destroy
+};
+
+/* Hand streams back to the encoder oldest first while nothing uses them (slot_mutex held) */
+static void camera_v812_drain_streams(CameraV812Data* data) {
+    for (;;) {
+        CameraV812Slot* oldest = NULL;
+        for (int i = 0; i < CAMERA_V812_STREAM_SLOTS; i++) {
+            CameraV812Slot* slot = &data->slots[i];
+            if (slot->stream_held && (!oldest || slot->seq < oldest->seq)) {
+                oldest = slot;
+            }
+        }
+        if (!oldest || oldest->stream_needed) {
+            return;
+        }
+        int ret = AW_MPI_VENC_ReleaseStream(CAMERA_V812_VENC_CHN, &oldest->stream);
+        if (ret != SUCCESS) {
+            LOG_ERROR("AW_MPI_VENC_ReleaseStream failed: 0x%x", ret);
+        }
+        oldest->stream_held = false;
+    }
+}
+
+/* Last reference to a captured frame dropped */
+static void camera_v812_slot_release(mcp_buffer_t* buffer) {
+    CameraV812Slot* slot = (CameraV812Slot*)buffer->owner;
+    CameraV812Data* data = slot->camera;
+
+    pthread_mutex_lock(&data->slot_mutex);
+    LINX_FREE(slot->copy);
+    slot->copy = NULL;
+    slot->lent = false;
+    slot->stream_needed = false;
+    camera_v812_drain_streams(data);
+    pthread_mutex_unlock(&data->slot_mutex);
+}
+
+static void camera_v812_config_vi(VI_ATTR_S* attr, const CameraConfig* config) {
+    memset(attr, 0, sizeof(VI_ATTR_S));
+    attr->type = V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
+    attr->memtype = V4L2_MEMORY_MMAP;
+    attr->format.pixelformat = map_PIXEL_FORMAT_E_to_V4L2_PIX_FMT(MM_PIXEL_FORMAT_YVU_SEMIPLANAR_420);
+    attr->format.field = V4L2_FIELD_NONE;
+    attr->format.colorspace = V4L2_COLORSPACE_JPEG;
+    attr->format.width = config->width;
+    attr->format.height = config->height;
+    attr->nbufs = CAMERA_V812_VI_BUFFERS;
+    attr->nplanes = 2;
+    attr->fps = CAMERA_V812_FPS;
+    attr->capturemode = V4L2_MODE_VIDEO;
+    attr->use_current_win = 0;
+}
+
+static void camera_v812_config_venc(VENC_CHN_ATTR_S* attr, const CameraConfig* config) {
+    memset(attr, 0, sizeof(VENC_CHN_ATTR_S));
+    attr->VeAttr.Type = PT_JPEG;
+    attr->VeAttr.AttrJpeg.MaxPicWidth = 0;
+    attr->VeAttr.AttrJpeg.MaxPicHeight = 0;
+    // Room for every lent frame at a generous 1/2 byte per pixel
+    attr->VeAttr.AttrJpeg.BufSize = (unsigned int)config->width * config->height / 2 * CAMERA_V812_STREAM_SLOTS;
+    attr->VeAttr.AttrJpeg.bByFrame = TRUE;
+    attr->VeAttr.AttrJpeg.PicWidth = config->width;
+    attr->VeAttr.AttrJpeg.PicHeight = config->height;
+    attr->VeAttr.AttrJpeg.bSupportDCF = FALSE;
+    attr->VeAttr.SrcPicWidth = config->width;
+    attr->VeAttr.SrcPicHeight = config->height;
+    attr->VeAttr.Field = VIDEO_FIELD_FRAME;
+    attr->VeAttr.PixelFormat = MM_PIXEL_FORMAT_YVU_SEMIPLANAR_420;
+    attr->VeAttr.Rotate = ROTATE_NONE;
+}
+
+static int camera_v812_set_quality(CameraV812Data* data, int quality) {
+    VENC_PARAM_JPEG_S param;
+    memset(&param, 0, sizeof(param));
+    param.Qfactor = quality;
+    int ret = AW_MPI_VENC_SetJpegParam(CAMERA_V812_VENC_CHN, &param);
+    if (ret != SUCCESS) {
+        LOG_ERROR("AW_MPI_VENC_SetJpegParam failed: 0x%x", ret);
+        return -1;
+    }
+    data->venc_quality = quality;
+    return 0;
+}
+
+static void camera_v812_stop_pipeline(CameraV812Data* data) {
+    if (!data->pipeline_running) {
+        return;
+    }
+    AW_MPI_VENC_StopRecvPic(CAMERA_V812_VENC_CHN);
+    AW_MPI_VENC_ResetChn(CAMERA_V812_VENC_CHN);
+    AW_MPI_VENC_DestroyChn(CAMERA_V812_VENC_CHN);
+    AW_MPI_VI_DisableVirChn(CAMERA_V812_VI_DEV, CAMERA_V812_VI_CHN);
+    AW_MPI_VI_DestroyVirChn(CAMERA_V812_VI_DEV, CAMERA_V812_VI_CHN);
+    AW_MPI_VI_DisableVipp(CAMERA_V812_VI_DEV);
+    AW_MPI_ISP_Stop(CAMERA_V812_ISP_DEV);
+    AW_MPI_VI_DestroyVipp(CAMERA_V812_VI_DEV);
+    data->pipeline_running = false;
+}
+
+/* VIPP -> ISP -> virtual channel, and a JPEG channel fed frame by frame from capture */
+static int camera_v812_start_pipeline(CameraV812Data* data) {
+    VI_ATTR_S vi_attr;
+    camera_v812_config_vi(&vi_attr, &data->config);
+
+    int ret = AW_MPI_VI_CreateVipp(CAMERA_V812_VI_DEV);
+    if (ret != SUCCESS) {
+        LOG_ERROR("AW_MPI_VI_CreateVipp failed: 0x%x", ret);
+        return -1;
+    }
+    ret = AW_MPI_VI_SetVippAttr(CAMERA_V812_VI_DEV, &vi_attr);
+    if (ret != SUCCESS) {
+        LOG_ERROR("AW_MPI_VI_SetVippAttr failed: 0x%x", ret);
+        goto error_destroy_vipp;
+    }
+    AW_MPI_ISP_Run(CAMERA_V812_ISP_DEV);
+    AW_MPI_VI_SetVippMirror(CAMERA_V812_VI_DEV, data->config.h_mirror ? 1 : 0);
+    AW_MPI_VI_SetVippFlip(CAMERA_V812_VI_DEV, data->config.v_flip ? 1 : 0);
+    ret = AW_MPI_VI_EnableVipp(CAMERA_V812_VI_DEV);
+    if (ret != SUCCESS) {
+        LOG_ERROR("AW_MPI_VI_EnableVipp failed: 0x%x", ret);
+        goto error_stop_isp;
+    }
+    ret = AW_MPI_VI_CreateVirChn(CAMERA_V812_VI_DEV, CAMERA_V812_VI_CHN, NULL);
+    if (ret != SUCCESS) {
+        LOG_ERROR("AW_MPI_VI_CreateVirChn failed: 0x%x", ret);
+        goto error_disable_vipp;
+    }
+    ret = AW_MPI_VI_EnableVirChn(CAMERA_V812_VI_DEV, CAMERA_V812_VI_CHN);
+    if (ret != SUCCESS) {
+        LOG_ERROR("AW_MPI_VI_EnableVirChn failed: 0x%x", ret);
+        goto error_destroy_chn;
+    }
+
+    VENC_CHN_ATTR_S venc_attr;
+    camera_v812_config_venc(&venc_attr, &data->config);
+    ret = AW_MPI_VENC_CreateChn(CAMERA_V812_VENC_CHN, &venc_attr);
+    if (ret != SUCCESS) {
+        LOG_ERROR("AW_MPI_VENC_CreateChn failed: 0x%x", ret);
+        goto error_disable_chn;
+    }
+    if (camera_v812_set_quality(data, data->config.quality) != 0) {
+        goto error_destroy_venc;
+    }
+    ret = AW_MPI_VENC_StartRecvPic(CAMERA_V812_VENC_CHN);
+    if (ret != SUCCESS) {
+        LOG_ERROR("AW_MPI_VENC_StartRecvPic failed: 0x%x", ret);
+        goto error_destroy_venc;
+    }
+
+    data->pipeline_running = true;
+    LOG_INFO("V812 camera pipeline started: %dx%d, quality %d",
+             data->config.width, data->config.height, data->config.quality);
+    return 0;
+
+error_destroy_venc:
+    AW_MPI_VENC_DestroyChn(CAMERA_V812_VENC_CHN);
+error_disable_chn:
+    AW_MPI_VI_DisableVirChn(CAMERA_V812_VI_DEV, CAMERA_V812_VI_CHN);
+error_destroy_chn:
+    AW_MPI_VI_DestroyVirChn(CAMERA_V812_VI_DEV, CAMERA_V812_VI_CHN);
+error_disable_vipp:
+    AW_MPI_VI_DisableVipp(CAMERA_V812_VI_DEV);
+error_stop_isp:
+    AW_MPI_ISP_Stop(CAMERA_V812_ISP_DEV);
+error_destroy_vipp:
+    AW_MPI_VI_DestroyVipp(CAMERA_V812_VI_DEV);
+    return -1;
+}
+
+/* True while any encoded frame is still lent out (slot_mutex not held) */
+static bool camera_v812_frames_lent(CameraV812Data* data) {
+    bool lent = false;
+    pthread_mutex_lock(&data->slot_mutex);
+    for (int i = 0; i < CAMERA_V812_STREAM_SLOTS; i++) {
+        lent = lent || data->slots[i].lent || data->slots[i].stream_held;
+    }
+    pthread_mutex_unlock(&data->slot_mutex);
+    return lent;
+}
+
+static int camera_v812_init(CameraInterface* self) {
+    if (!self || !self->impl_data) {
+        LOG_ERROR("Invalid camera interface");
+        return -1;
+    }
+    CameraV812Data* data = (CameraV812Data*)self->impl_data;
+
+    pthread_mutex_lock(&data->capture_mutex);
+    if (data->initialized) {
+        pthread_mutex_unlock(&data->capture_mutex);
+        return 0;
+    }
+
+    // The MPP system is shared with the audio adapter; it is left running on destroy
+    MPP_SYS_CONF_S sys_conf;
+    memset(&sys_conf, 0, sizeof(sys_conf));
+    sys_conf.nAlignWidth = 32;
+    AW_MPI_SYS_SetConf(&sys_conf);
+    int ret = AW_MPI_SYS_Init();
+    if (ret != SUCCESS) {
+        LOG_ERROR("AW_MPI_SYS_Init failed: 0x%x", ret);
+        pthread_mutex_unlock(&data->capture_mutex);
+        return -1;
+    }
+
+    int result = camera_v812_start_pipeline(data);
+    if (result == 0) {
+        data->initialized = true;
+        self->is_initialized = true;
+    }
+    pthread_mutex_unlock(&data->capture_mutex);
+    return result;
+}
+
+static int camera_v812_set_config(CameraInterface* self, const CameraConfig* config) {
+    if (!self || !self->impl_data || !config) {
+        LOG_ERROR("Invalid camera interface or config");
+        return -1;
+    }
+    CameraV812Data* data = (CameraV812Data*)self->impl_data;
+
+    if (config->width <= 0 || config->height <= 0 || (config->width & 15) || (config->height & 7)) {
+        LOG_ERROR("Invalid image dimensions for the JPEG encoder: %dx%d", config->width, config->height);
+        return -1;
+    }
+    if (config->quality < 1 || config->quality > 100) {
+        LOG_ERROR("Invalid JPEG quality: %d", config->quality);
+        return -1;
+    }
+    if (config->format != 1) {
+        LOG_ERROR("V812 camera only produces JPEG (format 1), got format %d", config->format);
+        return -1;
+    }
+
+    pthread_mutex_lock(&data->capture_mutex);
+    bool resized = config->width != data->config.width || config->height != data->config.height;
+    int result = 0;
+    if (resized && data->pipeline_running) {
+        // The VENC buffer and the VI pool are sized for the old frames
+        if (camera_v812_frames_lent(data)) {
+            LOG_ERROR("Cannot resize the V812 camera while frames are still referenced");
+            result = -1;
+        } else {
+            camera_v812_stop_pipeline(data);
+            data->config = *config;
+            result = camera_v812_start_pipeline(data);
+        }
+    } else {
+        data->config = *config;
+        if (data->pipeline_running) {
+            AW_MPI_VI_SetVippMirror(CAMERA_V812_VI_DEV, config->h_mirror ? 1 : 0);
+            AW_MPI_VI_SetVippFlip(CAMERA_V812_VI_DEV, config->v_flip ? 1 : 0);
+        }
+    }
+    pthread_mutex_unlock(&data->capture_mutex);
+    return result;
+}
+
+static int camera_v812_capture(CameraInterface* self, CameraFrameBuffer* frame) {
+    if (!self || !self->impl_data || !frame) {
+        LOG_ERROR("Invalid camera interface or frame buffer");
+        return -1;
+    }
+    CameraV812Data* data = (CameraV812Data*)self->impl_data;
+
+    pthread_mutex_lock(&data->capture_mutex);
+    if (!data->pipeline_running) {
+        LOG_ERROR("V812 camera not initialized");
+        pthread_mutex_unlock(&data->capture_mutex);
+        return -1;
+    }
+
+    // Only capture touches free slots, so the one picked here stays free
+    CameraV812Slot* slot = NULL;
+    pthread_mutex_lock(&data->slot_mutex);
+    for (int i = 0; i < CAMERA_V812_STREAM_SLOTS && !slot; i++) {
+        if (!data->slots[i].lent && !data->slots[i].stream_held) {
+            slot = &data->slots[i];
+        }
+    }
+    pthread_mutex_unlock(&data->slot_mutex);
+    if (!slot) {
+        LOG_WARN_EVERY_MS(1000, "All %d V812 encoder outputs are still referenced", CAMERA_V812_STREAM_SLOTS);
+        pthread_mutex_unlock(&data->capture_mutex);
+        return -1;
+    }
+
+    if (data->config.quality != data->venc_quality && camera_v812_set_quality(data, data->config.quality) != 0) {
+        pthread_mutex_unlock(&data->capture_mutex);
+        return -1;
+    }
+
+    // The VI buffer goes to the encoder as is and back to the VI pool once encoded
+    VIDEO_FRAME_INFO_S vi_frame;
+    memset(&vi_frame, 0, sizeof(vi_frame));
+    int ret = AW_MPI_VI_GetFrame(CAMERA_V812_VI_DEV, CAMERA_V812_VI_CHN, &vi_frame, CAMERA_V812_FRAME_WAIT_MS);
+    if (ret != SUCCESS) {
+        LOG_ERROR("AW_MPI_VI_GetFrame failed: 0x%x", ret);
+        pthread_mutex_unlock(&data->capture_mutex);
+        return -1;
+    }
+    ret = AW_MPI_VENC_SendFrame(CAMERA_V812_VENC_CHN, &vi_frame, CAMERA_V812_ENCODE_WAIT_MS);
+    if (ret == SUCCESS) {
+        memset(&slot->stream, 0, sizeof(slot->stream));
+        memset(&slot->pack, 0, sizeof(slot->pack));
+        slot->stream.mpPack = &slot->pack;
+        slot->stream.mPackCount = 1;
+        ret = AW_MPI_VENC_GetStream(CAMERA_V812_VENC_CHN, &slot->stream, CAMERA_V812_ENCODE_WAIT_MS);
+        if (ret != SUCCESS) {
+            LOG_ERROR("AW_MPI_VENC_GetStream failed: 0x%x", ret);
+        }
+    } else {
+        LOG_ERROR("AW_MPI_VENC_SendFrame failed: 0x%x", ret);
+    }
+    AW_MPI_VI_ReleaseFrame(CAMERA_V812_VI_DEV, CAMERA_V812_VI_CHN, &vi_frame);
+    if (ret != SUCCESS) {
+        pthread_mutex_unlock(&data->capture_mutex);
+        return -1;
+    }
+
+    // A JPEG that wrapped around the end of the ring buffer comes in two parts
+    uint8_t* jpeg = slot->pack.mpAddr0;
+    size_t size = slot->pack.mLen0 + slot->pack.mLen1;
+    uint8_t* copy = NULL;
+    if (slot->pack.mLen1 > 0) {
+        copy = (uint8_t*)LINX_MALLOC(size);
+        if (copy) {
+            memcpy(copy, slot->pack.mpAddr0, slot->pack.mLen0);
+            memcpy(copy + slot->pack.mLen0, slot->pack.mpAddr1, slot->pack.mLen1);
+        }
+        jpeg = copy;
+    }
+
+    pthread_mutex_lock(&data->slot_mutex);
+    slot->camera = data;
+    slot->seq = data->next_seq++;
+    slot->stream_held = true;
+    slot->stream_needed = copy == NULL;
+    slot->copy = copy;
+    slot->lent = jpeg != NULL;
+    if (!slot->stream_needed) {
+        // Copied out (or the copy failed): the stream can go back as soon as its turn comes
+        camera_v812_drain_streams(data);
+    }
+    pthread_mutex_unlock(&data->slot_mutex);
+    pthread_mutex_unlock(&data->capture_mutex);
+    if (!jpeg) {
+        LOG_ERROR("Failed to allocate %zu bytes for a wrapped JPEG", size);
+        return -1;
+    }
+
+    mcp_buffer_init(&slot->buffer, jpeg, size, camera_v812_slot_release, slot);
+    frame->data = jpeg;
+    frame->size = size;
+    frame->width = data->config.width;
+    frame->height = data->config.height;
+    frame->format = 1; // JPEG
+    frame->buffer = &slot->buffer;
+    return 0;
+}
+
+static int camera_v812_set_h_mirror(CameraInterface* self, bool enabled) {
+    if (!self || !self->impl_data) {
+        LOG_ERROR("Invalid camera interface");
+        return -1;
+    }
+    CameraV812Data* data = (CameraV812Data*)self->impl_data;
+
+    pthread_mutex_lock(&data->capture_mutex);
+    data->config.h_mirror = enabled;
+    int ret = data->pipeline_running ? AW_MPI_VI_SetVippMirror(CAMERA_V812_VI_DEV, enabled ? 1 : 0) : SUCCESS;
+    pthread_mutex_unlock(&data->capture_mutex);
+    return ret == SUCCESS ? 0 : -1;
+}
+
+static int camera_v812_set_v_flip(CameraInterface* self, bool enabled) {
+    if (!self || !self->impl_data) {
+        LOG_ERROR("Invalid camera interface");
+        return -1;
+    }
+    CameraV812Data* data = (CameraV812Data*)self->impl_data;
+
+    pthread_mutex_lock(&data->capture_mutex);
+    data->config.v_flip = enabled;
+    int ret = data->pipeline_running ? AW_MPI_VI_SetVippFlip(CAMERA_V812_VI_DEV, enabled ? 1 : 0) : SUCCESS;
+    pthread_mutex_unlock(&data->capture_mutex);
+    return ret == SUCCESS ? 0 : -1;
+}
+
+static int camera_v812_set_explain_url(CameraInterface* self, const char* url, const char* token) {
+    (void)self;
+    (void)token;
+    // Kept by camera_interface_set_explain_url for when a service client exists
+    LOG_INFO("V812 camera explain URL set: %s", url);
+    return 0;
+}
+
+static int camera_v812_explain(CameraInterface* self, const char* question, char* response, size_t response_size) {
+    (void)self;
+    (void)question;
+    (void)response;
+    (void)response_size;
+    LOG_ERROR("Explain is not available on the V812 camera");
+    return -1;
+}
+
+static int camera_v812_release_frame(CameraInterface* self, CameraFrameBuffer* frame) {
+    if (!self || !frame) {
+        LOG_ERROR("Invalid camera interface or frame buffer");
+        return -1;
+    }
+
+    if (frame->data) {
+        // Drops the frame's reference; the stream goes back to VENC once shared references are gone too
+        mcp_buffer_release(frame->buffer);
+        frame->data = NULL;
+        frame->buffer = NULL;
+        frame->size = 0;
+        frame->width = 0;
+        frame->height = 0;
+        frame->format = 0;
+    }
+    return 0;
+}
+
+static int camera_v812_destroy(CameraInterface* self) {
+    if (!self) {
+        LOG_ERROR("Invalid camera interface");
+        return -1;
+    }
+
+    CameraV812Data* data = (CameraV812Data*)self->impl_data;
+    if (data) {
+        pthread_mutex_lock(&data->slot_mutex);
+        for (int i = 0; i < CAMERA_V812_STREAM_SLOTS; i++) {
+            CameraV812Slot* slot = &data->slots[i];
+            if (slot->lent) {
+                LOG_WARN("Camera destroyed with frame %d still referenced", i);
+            }
+            if (slot->stream_held) {
+                AW_MPI_VENC_ReleaseStream(CAMERA_V812_VENC_CHN, &slot->stream);
+                slot->stream_held = false;
+            }
+            LINX_FREE(slot->copy);
+            slot->copy = NULL;
+        }
+        pthread_mutex_unlock(&data->slot_mutex);
+
+        camera_v812_stop_pipeline(data);
+        pthread_mutex_destroy(&data->slot_mutex);
+        pthread_mutex_destroy(&data->capture_mutex);
+        LINX_FREE(data);
+    }
+    LINX_FREE(self);
+    LOG_INFO("V812 camera destroyed");
+    return 0;
+}
+
+CameraInterface* camera_v812_create(void) {
+    CameraInterface* interface = (CameraInterface*)LINX_CALLOC(1, sizeof(CameraInterface));
+    CameraV812Data* data = (CameraV812Data*)LINX_CALLOC(1, sizeof(CameraV812Data));
+    if (!interface || !data) {
+        LOG_ERROR("Failed to allocate memory for V812 camera");
+        LINX_FREE(interface);
+        LINX_FREE(data);
+        return NULL;
+    }
+
+    pthread_mutex_init(&data->capture_mutex, NULL);
+    pthread_mutex_init(&data->slot_mutex, NULL);
+    data->config.width = 1280;
+    data->config.height = 720;
+    data->config.quality = 80;
+    data->config.format = 1; // JPEG
+
+    interface->vtable = &camera_v812_vtable;
+    interface->impl_data = data;
+    interface->config = data->config;
+
+    LOG_INFO("V812 camera interface created");
+    return interface;
+}
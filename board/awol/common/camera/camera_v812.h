@@ -0,0 +1,37 @@
+#ifndef CAMERA_V812_H
+#define CAMERA_V812_H
+
+#include "camera/camera_interface.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CAMERA_V812_STREAM_SLOTS 3      // Encoded frames lent out at once, including shared MCP references
+
+/**
+ * @brief Create the V812 CameraInterface adapter
+ *
+ * Frames come from the ISP through MPP VI as NV21 (YVU420 semi-planar) and
+ * are encoded by the VENC JPEG channel in hardware: the VI buffer is handed
+ * to the encoder as is and returned to the VI pool once the JPEG is out, so
+ * the Cortex-A7 never touches the pixels.
+ *
+ * A captured frame points straight into the VENC output buffer and holds it
+ * until the last reference is released (camera_interface_release_frame and
+ * any camera_interface_share_frame() references); the streams are returned
+ * to the encoder in the order they were produced. Only a JPEG that wrapped
+ * around the end of the encoder's ring buffer is copied out.
+ *
+ * Output is always JPEG (format 1). There is no explain service client on
+ * this board yet, so explain requests fail.
+ *
+ * @return CameraInterface instance, NULL on failure
+ */
+CameraInterface* camera_v812_create(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAMERA_V812_H */
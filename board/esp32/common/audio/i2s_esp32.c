@@ -0,0 +1,895 @@
+#include "i2s_esp32.h"
+#include "linx_log.h"
+#include "linx_alloc.h"
+#include "os/linx_os.h"
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/i2s_std.h"
+#include "driver/i2s_pdm.h"
+#include "esp_attr.h"
+#include "esp_idf_version.h"
+#include "esp_timer.h"
+
+#if ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5, 0, 0)
+#error "i2s_esp32 needs the ESP-IDF 5.x I2S channel driver"
+#endif
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_BOARD);
+
+#define I2S_ESP32_DEFAULT_DESC_NUM 2
+#define I2S_ESP32_MAX_DESC_NUM 8
+// Finished-buffer queue; deeper than any descriptor count, so by the time it
+// fills every queued buffer has already been refilled by DMA
+#define I2S_ESP32_READY_SLOTS 16
+// One DMA descriptor carries at most 4092 bytes
+#define I2S_ESP32_MAX_DESC_BYTES 4092
+// Longest read()/write() wait for the DMA before giving up
+#define I2S_ESP32_IO_TIMEOUT_MS 1000
+
+/**
+ * A DMA buffer the receive ISR has finished
+ */
+typedef struct {
+    const short* data;
+    uint32_t seq;               // rx_seq when it completed
+    uint64_t time_us;           // esp_timer time of its first sample
+} i2s_esp32_slot_t;
+
+/**
+ * I2S implementation data structure
+ */
+typedef struct {
+    i2s_esp32_config_t config;
+    i2s_chan_handle_t rx;
+    i2s_chan_handle_t tx;
+    bool channels_ready;
+    uint32_t desc_num;
+    uint32_t desc_frames;
+    uint32_t frame_us;          // Duration of one descriptor
+
+    // Receive ISR -> capture task: single-producer ring of finished buffers.
+    // The ISR also counts completions in rx_seq; once desc_num - 1 newer
+    // buffers have completed, DMA is refilling a queued one and the reader
+    // skips it.
+    i2s_esp32_slot_t ready[I2S_ESP32_READY_SLOTS];
+    uint32_t ready_head;        // ISR only
+    uint32_t ready_tail;        // Reader only
+    uint32_t rx_seq;
+    TaskHandle_t reader;        // Notified by the ISR
+    uint32_t read_offset;       // Frames read() already took from the head slot
+    bool frame_borrowed;
+    uint32_t frame_seq;
+    uint64_t capture_time_us;   // Time of the last frame read
+    bool capture_time_valid;
+    uint32_t rx_dropped;
+    uint32_t rx_overwritten;
+
+    // Playback: bytes handed to i2s_channel_write() vs. sent by the TX ISR
+    // (the ISR also counts the silence auto_clear sends after a starve)
+    uint32_t tx_written;
+    uint32_t tx_sent;
+
+    // Pull-mode source (published atomically), serviced by play_thread
+    audio_pull_callback_t pull_callback;
+    void* pull_user_data;
+    bool play_flush;            // Pull thread restarts the TX DMA on its next frame
+    linx_thread_t* play_thread;
+    bool play_thread_running;
+    short* play_frame;          // One descriptor of pull output
+} I2sEsp32Data;
+
+
+// Forward declarations for vtable functions
+static int i2s_esp32_init(AudioInterface* self);
+static void i2s_esp32_set_config(AudioInterface* self, unsigned int sample_rate,
+                                 int frame_size, int channels, int periods,
+                                 int buffer_size, int period_size);
+static int i2s_esp32_read(AudioInterface* self, short* buffer, size_t frame_size);
+static int i2s_esp32_write(AudioInterface* self, short* buffer, size_t frame_size);
+static int i2s_esp32_record(AudioInterface* self);
+static int i2s_esp32_init_play(AudioInterface* self);
+static bool i2s_esp32_is_play_buffer_empty(AudioInterface* self);
+static int i2s_esp32_destroy(AudioInterface* self);
+static int i2s_esp32_set_pull_source(AudioInterface* self, audio_pull_callback_t callback, void* user_data);
+static int i2s_esp32_acquire_frame(AudioInterface* self, audio_capture_frame_t* frame, int timeout_ms);
+static int i2s_esp32_release_frame(AudioInterface* self, audio_capture_frame_t* frame);
+static int i2s_esp32_flush_play(AudioInterface* self);
+static int i2s_esp32_get_capture_time(AudioInterface* self, uint64_t* time_us);
+static int i2s_esp32_get_play_delay(AudioInterface* self, uint32_t* delay_us);
+static int i2s_esp32_read_timed(AudioInterface* self, short* buffer, size_t frame_size, uint32_t timeout_us,
+                                uint64_t* time_us);
+
+// VTable for ESP32 I2S implementation
+static const AudioInterfaceVTable i2s_esp32_vtable = {
+    .init = i2s_esp32_init,
+    .set_config = i2s_esp32_set_config,
+    .read = i2s_esp32_read,
+    .write = i2s_esp32_write,
+    .record = i2s_esp32_record,
+    .init_play = i2s_esp32_init_play,
+    .is_play_buffer_empty = i2s_esp32_is_play_buffer_empty,
+    .destroy = i2s_esp32_destroy,
+    .set_pull_source = i2s_esp32_set_pull_source,
+    .acquire_frame = i2s_esp32_acquire_frame,
+    .release_frame = i2s_esp32_release_frame,
+    .flush_play = i2s_esp32_flush_play,
+    .get_capture_time = i2s_esp32_get_capture_time,
+    .get_play_delay = i2s_esp32_get_play_delay,
+    .read_timed = i2s_esp32_read_timed
+};
+
+AudioInterface* i2s_esp32_create(const i2s_esp32_config_t* config) {
+    if (!config) {
+        LOG_ERROR("I2S pin configuration is required");
+        return NULL;
+    }
+
+    AudioInterface* interface = (AudioInterface*)LINX_MALLOC(sizeof(AudioInterface));
+    if (!interface) {
+        LOG_ERROR("Failed to allocate memory for AudioInterface");
+        return NULL;
+    }
+
+    I2sEsp32Data* data = (I2sEsp32Data*)LINX_MALLOC(sizeof(I2sEsp32Data));
+    if (!data) {
+        LOG_ERROR("Failed to allocate memory for I2sEsp32Data");
+        LINX_FREE(interface);
+        return NULL;
+    }
+
+    memset(interface, 0, sizeof(AudioInterface));
+    memset(data, 0, sizeof(I2sEsp32Data));
+    data->config = *config;
+
+    interface->vtable = &i2s_esp32_vtable;
+    interface->impl_data = data;
+    return interface;
+}
+
+/**
+ * Receive ISR: queue the finished DMA buffer and wake the capture task
+ */
+static bool IRAM_ATTR i2s_esp32_on_recv(i2s_chan_handle_t handle, i2s_event_data_t* event, void* user_ctx) {
+    I2sEsp32Data* data = (I2sEsp32Data*)user_ctx;
+    uint64_t now = (uint64_t)esp_timer_get_time();
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 2, 0)
+    const short* buffer = (const short*)event->dma_buf;
+#else
+    // Before 5.2 `data` points at the DMA buffer pointer
+    const short* buffer = *(const short**)event->data;
+#endif
+
+    uint32_t seq = __atomic_add_fetch(&data->rx_seq, 1, __ATOMIC_RELEASE);
+    uint32_t head = data->ready_head;
+    uint32_t tail = __atomic_load_n(&data->ready_tail, __ATOMIC_ACQUIRE);
+    if (head - tail < I2S_ESP32_READY_SLOTS) {
+        i2s_esp32_slot_t* slot = &data->ready[head % I2S_ESP32_READY_SLOTS];
+        slot->data = buffer;
+        slot->seq = seq;
+        slot->time_us = now > data->frame_us ? now - data->frame_us : 0;
+        __atomic_store_n(&data->ready_head, head + 1, __ATOMIC_RELEASE);
+    } else {
+        __atomic_add_fetch(&data->rx_dropped, 1, __ATOMIC_RELAXED);
+    }
+
+    BaseType_t woken = pdFALSE;
+    TaskHandle_t reader = __atomic_load_n(&data->reader, __ATOMIC_ACQUIRE);
+    if (reader) {
+        vTaskNotifyGiveFromISR(reader, &woken);
+    }
+    return woken == pdTRUE;
+}
+
+/**
+ * Transmit ISR: account for the buffer DMA just sent
+ */
+static bool IRAM_ATTR i2s_esp32_on_sent(i2s_chan_handle_t handle, i2s_event_data_t* event, void* user_ctx) {
+    I2sEsp32Data* data = (I2sEsp32Data*)user_ctx;
+    __atomic_add_fetch(&data->tx_sent, (uint32_t)event->size, __ATOMIC_RELEASE);
+    return false;
+}
+
+/**
+ * Whether DMA has started refilling the buffer that completed as `seq`
+ */
+static bool i2s_esp32_slot_stale(const I2sEsp32Data* data, uint32_t seq) {
+    uint32_t completed = __atomic_load_n(&data->rx_seq, __ATOMIC_ACQUIRE);
+    return completed - seq >= data->desc_num - 1;
+}
+
+/**
+ * Oldest queued buffer DMA has not refilled yet, waiting for the ISR's
+ * notification if there is none
+ * @param timeout_ms <0 waits forever
+ * @return Slot at the ring tail (left queued), NULL on timeout
+ */
+static const i2s_esp32_slot_t* i2s_esp32_next_slot(I2sEsp32Data* data, int timeout_ms) {
+    TickType_t wait = timeout_ms < 0 ? portMAX_DELAY : pdMS_TO_TICKS((TickType_t)timeout_ms);
+    TimeOut_t timeout;
+    vTaskSetTimeOutState(&timeout);
+    __atomic_store_n(&data->reader, xTaskGetCurrentTaskHandle(), __ATOMIC_RELEASE);
+
+    for (;;) {
+        uint32_t tail = data->ready_tail;
+        uint32_t head = __atomic_load_n(&data->ready_head, __ATOMIC_ACQUIRE);
+        while (tail != head) {
+            const i2s_esp32_slot_t* slot = &data->ready[tail % I2S_ESP32_READY_SLOTS];
+            if (!i2s_esp32_slot_stale(data, slot->seq)) {
+                return slot;
+            }
+            // The reader fell behind: skip buffers DMA is already refilling
+            tail++;
+            __atomic_add_fetch(&data->rx_dropped, 1, __ATOMIC_RELAXED);
+            data->read_offset = 0;
+            __atomic_store_n(&data->ready_tail, tail, __ATOMIC_RELEASE);
+        }
+        if (xTaskCheckForTimeOut(&timeout, &wait) == pdTRUE) {
+            return NULL;
+        }
+        ulTaskNotifyTake(pdTRUE, wait);
+    }
+}
+
+static void i2s_esp32_pop_slot(I2sEsp32Data* data) {
+    data->read_offset = 0;
+    __atomic_store_n(&data->ready_tail, data->ready_tail + 1, __ATOMIC_RELEASE);
+}
+
+static gpio_num_t i2s_esp32_gpio(int pin) {
+    return pin >= 0 ? (gpio_num_t)pin : I2S_GPIO_UNUSED;
+}
+
+static i2s_std_config_t i2s_esp32_std_config(const AudioInterface* self, int slot_bits,
+                                             int mclk, int bclk, int ws, int dout, int din) {
+    i2s_slot_mode_t mode = self->channels > 1 ? I2S_SLOT_MODE_STEREO : I2S_SLOT_MODE_MONO;
+    i2s_std_config_t std_cfg = {
+        .clk_cfg = I2S_STD_CLK_DEFAULT_CONFIG(self->sample_rate),
+        .slot_cfg = I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG(I2S_DATA_BIT_WIDTH_16BIT, mode),
+        .gpio_cfg = {
+            .mclk = i2s_esp32_gpio(mclk),
+            .bclk = i2s_esp32_gpio(bclk),
+            .ws = i2s_esp32_gpio(ws),
+            .dout = i2s_esp32_gpio(dout),
+            .din = i2s_esp32_gpio(din),
+            .invert_flags = { .mclk_inv = false, .bclk_inv = false, .ws_inv = false },
+        },
+    };
+    // 24-bit MEMS mics need 32 clocks per slot; DMA still carries the top 16 bits
+    if (slot_bits == 32) {
+        std_cfg.slot_cfg.slot_bit_width = I2S_SLOT_BIT_WIDTH_32BIT;
+    }
+    return std_cfg;
+}
+
+static void i2s_esp32_delete_channels(I2sEsp32Data* data) {
+    if (data->rx) {
+        i2s_del_channel(data->rx);
+        data->rx = NULL;
+    }
+    if (data->tx) {
+        i2s_del_channel(data->tx);
+        data->tx = NULL;
+    }
+    data->channels_ready = false;
+}
+
+/**
+ * Create and configure both directions on first use (a duplex pair must be
+ * created together); channels are left disabled
+ */
+static int i2s_esp32_open_channels(AudioInterface* self, I2sEsp32Data* data) {
+    if (data->channels_ready) {
+        return 0;
+    }
+    const i2s_esp32_config_t* cfg = &data->config;
+    bool has_mic = cfg->mic_mode != I2S_ESP32_MIC_NONE;
+    bool has_spk = cfg->spk_dout >= 0;
+    bool duplex = has_mic && has_spk && cfg->mic_mode == I2S_ESP32_MIC_STD && cfg->mic_port == cfg->spk_port;
+
+    size_t desc_bytes = (size_t)data->desc_frames * (size_t)self->channels * sizeof(short);
+    if (desc_bytes > I2S_ESP32_MAX_DESC_BYTES) {
+        LOG_ERROR("I2S period of %u frames exceeds one DMA descriptor (%d bytes)",
+                  (unsigned int)data->desc_frames, I2S_ESP32_MAX_DESC_BYTES);
+        return -1;
+    }
+
+    i2s_chan_config_t chan_cfg = I2S_CHANNEL_DEFAULT_CONFIG((i2s_port_t)cfg->spk_port, I2S_ROLE_MASTER);
+    chan_cfg.dma_desc_num = data->desc_num;
+    chan_cfg.dma_frame_num = data->desc_frames;
+    // A starved speaker sends silence rather than repeating stale buffers
+    chan_cfg.auto_clear = true;
+
+    esp_err_t err = ESP_OK;
+    if (duplex) {
+        err = i2s_new_channel(&chan_cfg, &data->tx, &data->rx);
+    } else {
+        if (has_spk) {
+            err = i2s_new_channel(&chan_cfg, &data->tx, NULL);
+        }
+        if (err == ESP_OK && has_mic) {
+            chan_cfg.id = (i2s_port_t)cfg->mic_port;
+            err = i2s_new_channel(&chan_cfg, NULL, &data->rx);
+        }
+    }
+    if (err != ESP_OK) {
+        LOG_ERROR("Failed to create I2S channels: %s", esp_err_to_name(err));
+        i2s_esp32_delete_channels(data);
+        return -1;
+    }
+
+    if (data->tx) {
+        i2s_std_config_t std_cfg = i2s_esp32_std_config(self, duplex ? cfg->mic_slot_bits : 0, cfg->spk_mclk,
+                                                        cfg->spk_bclk, cfg->spk_ws, cfg->spk_dout,
+                                                        duplex ? cfg->mic_din : -1);
+        err = i2s_channel_init_std_mode(data->tx, &std_cfg);
+        if (err == ESP_OK && duplex) {
+            err = i2s_channel_init_std_mode(data->rx, &std_cfg);
+        }
+    }
+    if (err == ESP_OK && data->rx && !duplex) {
+        if (cfg->mic_mode == I2S_ESP32_MIC_PDM) {
+#if SOC_I2S_SUPPORTS_PDM_RX
+            i2s_pdm_rx_config_t pdm_cfg = {
+                .clk_cfg = I2S_PDM_RX_CLK_DEFAULT_CONFIG(self->sample_rate),
+                .slot_cfg = I2S_PDM_RX_SLOT_DEFAULT_CONFIG(I2S_DATA_BIT_WIDTH_16BIT,
+                                                           self->channels > 1 ? I2S_SLOT_MODE_STEREO : I2S_SLOT_MODE_MONO),
+                .gpio_cfg = {
+                    .clk = i2s_esp32_gpio(cfg->mic_pdm_clk),
+                    .din = i2s_esp32_gpio(cfg->mic_pdm_din),
+                    .invert_flags = { .clk_inv = false },
+                },
+            };
+            err = i2s_channel_init_pdm_rx_mode(data->rx, &pdm_cfg);
+#else
+            LOG_ERROR("This chip has no PDM RX mode");
+            err = ESP_ERR_NOT_SUPPORTED;
+#endif
+        } else {
+            i2s_std_config_t std_cfg = i2s_esp32_std_config(self, cfg->mic_slot_bits, -1, cfg->mic_bclk,
+                                                            cfg->mic_ws, -1, cfg->mic_din);
+            err = i2s_channel_init_std_mode(data->rx, &std_cfg);
+        }
+    }
+    if (err != ESP_OK) {
+        LOG_ERROR("Failed to configure I2S channels: %s", esp_err_to_name(err));
+        i2s_esp32_delete_channels(data);
+        return -1;
+    }
+
+    if (data->rx) {
+        i2s_event_callbacks_t callbacks = { .on_recv = i2s_esp32_on_recv };
+        err = i2s_channel_register_event_callback(data->rx, &callbacks, data);
+    }
+    if (err == ESP_OK && data->tx) {
+        i2s_event_callbacks_t callbacks = { .on_sent = i2s_esp32_on_sent };
+        err = i2s_channel_register_event_callback(data->tx, &callbacks, data);
+    }
+    if (err != ESP_OK) {
+        LOG_ERROR("Failed to register I2S callbacks: %s", esp_err_to_name(err));
+        i2s_esp32_delete_channels(data);
+        return -1;
+    }
+
+    data->channels_ready = true;
+    LOG_INFO("I2S %s: %u Hz, %d channels, %u x %u-frame DMA buffers",
+             duplex ? "duplex" : (cfg->mic_mode == I2S_ESP32_MIC_PDM ? "PDM mic" : "simplex"),
+             self->sample_rate, self->channels, (unsigned int)data->desc_num, (unsigned int)data->desc_frames);
+    return 0;
+}
+
+static int i2s_esp32_init(AudioInterface* self) {
+    if (!self || !self->impl_data) {
+        LOG_ERROR("Invalid audio interface");
+        return -1;
+    }
+
+    // Channels are created by record()/init_play() once the geometry is known
+    self->is_initialized = true;
+    LOG_INFO("ESP32 I2S initialized");
+    return 0;
+}
+
+static void i2s_esp32_set_config(AudioInterface* self, unsigned int sample_rate,
+                                 int frame_size, int channels, int periods,
+                                 int buffer_size, int period_size) {
+    if (!self || !self->impl_data) {
+        LOG_ERROR("Invalid audio interface");
+        return;
+    }
+
+    I2sEsp32Data* data = (I2sEsp32Data*)self->impl_data;
+    if (data->channels_ready) {
+        LOG_WARN("I2S configuration changed while channels are open; ignored");
+        return;
+    }
+
+    self->sample_rate = sample_rate;
+    self->frame_size = frame_size;
+    self->channels = channels;
+    self->periods = periods;
+    self->buffer_size = buffer_size;
+    self->period_size = period_size;
+
+    data->desc_frames = (uint32_t)(period_size > 0 ? period_size : frame_size);
+    data->desc_num = periods > 0 ? (uint32_t)periods : I2S_ESP32_DEFAULT_DESC_NUM;
+    if (data->desc_num < 2) {
+        data->desc_num = 2;
+    } else if (data->desc_num > I2S_ESP32_MAX_DESC_NUM) {
+        data->desc_num = I2S_ESP32_MAX_DESC_NUM;
+    }
+    data->frame_us = sample_rate > 0 ? (uint32_t)((uint64_t)data->desc_frames * 1000000u / sample_rate) : 0;
+
+    LOG_INFO("Audio config: %u Hz, %d channels, frame %d, %u DMA buffers of %u frames",
+             sample_rate, channels, frame_size, (unsigned int)data->desc_num, (unsigned int)data->desc_frames);
+}
+
+static bool i2s_esp32_config_valid(const AudioInterface* self, const I2sEsp32Data* data) {
+    if (self->sample_rate == 0 || self->frame_size <= 0 || self->channels <= 0 || data->desc_frames == 0) {
+        LOG_ERROR("Audio interface not configured");
+        return false;
+    }
+    return true;
+}
+
+static int i2s_esp32_read(AudioInterface* self, short* buffer, size_t frame_size) {
+    if (!self || !self->impl_data || !buffer) {
+        LOG_ERROR("Invalid parameters");
+        return -1;
+    }
+
+    I2sEsp32Data* data = (I2sEsp32Data*)self->impl_data;
+    if (!self->is_recording || data->frame_borrowed) {
+        return -1;
+    }
+
+    size_t channels = (size_t)self->channels;
+    size_t done = 0;
+    while (done < frame_size) {
+        const i2s_esp32_slot_t* slot = i2s_esp32_next_slot(data, I2S_ESP32_IO_TIMEOUT_MS);
+        if (!slot) {
+            LOG_WARN("I2S capture timed out");
+            return -1;
+        }
+        if (done == 0) {
+            data->capture_time_us = slot->time_us + (uint64_t)data->read_offset * 1000000u / self->sample_rate;
+            data->capture_time_valid = true;
+        }
+        size_t count = data->desc_frames - data->read_offset;
+        if (count > frame_size - done) {
+            count = frame_size - done;
+        }
+        memcpy(buffer + done * channels, slot->data + (size_t)data->read_offset * channels,
+               count * channels * sizeof(short));
+        if (i2s_esp32_slot_stale(data, slot->seq)) {
+            data->rx_overwritten++;
+        }
+        done += count;
+        data->read_offset += (uint32_t)count;
+        if (data->read_offset >= data->desc_frames) {
+            i2s_esp32_pop_slot(data);
+        }
+    }
+    return 0;
+}
+
+/**
+ * Wait until the queued buffers hold `frames` unread frames, so the read
+ * that follows does not block
+ * @return false on timeout
+ */
+static bool i2s_esp32_wait_frames(I2sEsp32Data* data, size_t frames, int timeout_ms) {
+    TickType_t wait = pdMS_TO_TICKS((TickType_t)timeout_ms);
+    TimeOut_t timeout;
+    vTaskSetTimeOutState(&timeout);
+
+    for (;;) {
+        // Drops stale buffers and registers this task for the ISR's notification
+        if (i2s_esp32_next_slot(data, 0)) {
+            uint32_t queued = __atomic_load_n(&data->ready_head, __ATOMIC_ACQUIRE) - data->ready_tail;
+            if ((size_t)queued * data->desc_frames - data->read_offset >= frames) {
+                return true;
+            }
+        }
+        if (xTaskCheckForTimeOut(&timeout, &wait) == pdTRUE) {
+            return false;
+        }
+        ulTaskNotifyTake(pdTRUE, wait);
+    }
+}
+
+static int i2s_esp32_read_timed(AudioInterface* self, short* buffer, size_t frame_size, uint32_t timeout_us,
+                                uint64_t* time_us) {
+    if (!self || !self->impl_data || !buffer) {
+        LOG_ERROR("Invalid parameters");
+        return -1;
+    }
+
+    // Buffers older than desc_num - 1 completions are being refilled, so
+    // more than that can never be waited for
+    I2sEsp32Data* data = (I2sEsp32Data*)self->impl_data;
+    uint32_t usable = data->desc_num > 1 ? data->desc_num - 1 : 1;
+    if (usable > I2S_ESP32_READY_SLOTS) {
+        usable = I2S_ESP32_READY_SLOTS;
+    }
+    if (!self->is_recording || data->frame_borrowed || frame_size > (size_t)usable * data->desc_frames) {
+        return -1;
+    }
+
+    // Round up to whole ticks so a sub-tick deadline still waits one
+    int timeout_ms = (int)(((uint64_t)timeout_us + 999u) / 1000u);
+    if (!i2s_esp32_wait_frames(data, frame_size, timeout_ms)) {
+        return AUDIO_READ_TIMEOUT;
+    }
+    if (i2s_esp32_read(self, buffer, frame_size) != 0) {
+        return -1;
+    }
+    if (time_us) {
+        *time_us = data->capture_time_us;
+    }
+    return 0;
+}
+
+static int i2s_esp32_acquire_frame(AudioInterface* self, audio_capture_frame_t* frame, int timeout_ms) {
+    if (!self || !self->impl_data || !frame) {
+        LOG_ERROR("Invalid parameters");
+        return -1;
+    }
+
+    // A DMA buffer is exactly one frame only when period_size matches frame_size
+    I2sEsp32Data* data = (I2sEsp32Data*)self->impl_data;
+    if (!self->is_recording || data->frame_borrowed || data->read_offset != 0 ||
+        data->desc_frames != (uint32_t)self->frame_size) {
+        return -1;
+    }
+
+    const i2s_esp32_slot_t* slot = i2s_esp32_next_slot(data, timeout_ms);
+    if (!slot) {
+        return -1;
+    }
+    data->frame_borrowed = true;
+    data->frame_seq = slot->seq;
+    data->capture_time_us = slot->time_us;
+    data->capture_time_valid = true;
+    frame->data = slot->data;
+    frame->frame_count = data->desc_frames;
+    frame->token = data;
+    return 0;
+}
+
+static int i2s_esp32_release_frame(AudioInterface* self, audio_capture_frame_t* frame) {
+    if (!self || !self->impl_data || !frame) {
+        return -1;
+    }
+
+    I2sEsp32Data* data = (I2sEsp32Data*)self->impl_data;
+    if (!data->frame_borrowed || frame->token != data) {
+        return -1;
+    }
+    // Too late to save the samples, but count it so slow encoders show up
+    if (i2s_esp32_slot_stale(data, data->frame_seq)) {
+        data->rx_overwritten++;
+    }
+    data->frame_borrowed = false;
+    i2s_esp32_pop_slot(data);
+    frame->data = NULL;
+    frame->frame_count = 0;
+    frame->token = NULL;
+    return 0;
+}
+
+static int i2s_esp32_get_capture_time(AudioInterface* self, uint64_t* time_us) {
+    if (!self || !self->impl_data || !time_us) {
+        return -1;
+    }
+    I2sEsp32Data* data = (I2sEsp32Data*)self->impl_data;
+    if (!data->capture_time_valid) {
+        return -1;
+    }
+    *time_us = data->capture_time_us;
+    return 0;
+}
+
+/**
+ * Output delay: bytes handed to i2s_channel_write() that the TX ISR has not
+ * reported sent yet (the descriptor on the wire included); the codec's own
+ * path after I2S is a few samples and not counted
+ */
+static int i2s_esp32_get_play_delay(AudioInterface* self, uint32_t* delay_us) {
+    if (!self || !self->impl_data || !delay_us || self->sample_rate == 0 || self->channels <= 0) {
+        return -1;
+    }
+    I2sEsp32Data* data = (I2sEsp32Data*)self->impl_data;
+    if (!self->is_playing) {
+        return -1;
+    }
+    uint32_t written = __atomic_load_n(&data->tx_written, __ATOMIC_ACQUIRE);
+    uint32_t sent = __atomic_load_n(&data->tx_sent, __ATOMIC_ACQUIRE);
+    int32_t queued = (int32_t)(written - sent);
+    uint64_t frames = queued > 0 ? (uint64_t)queued / ((uint64_t)self->channels * sizeof(short)) : 0;
+    *delay_us = (uint32_t)(frames * 1000000u / self->sample_rate);
+    return 0;
+}
+
+/**
+ * Drop what the TX DMA still holds: restarting the channel discards the
+ * queued descriptors
+ */
+static void i2s_esp32_restart_tx(I2sEsp32Data* data) {
+    i2s_channel_disable(data->tx);
+    i2s_channel_enable(data->tx);
+    __atomic_store_n(&data->tx_written, __atomic_load_n(&data->tx_sent, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+}
+
+/**
+ * Copy into the TX DMA buffers, blocking while they are full
+ */
+static int i2s_esp32_write_frames(AudioInterface* self, I2sEsp32Data* data, const short* buffer, size_t frames) {
+    size_t bytes = frames * (size_t)self->channels * sizeof(short);
+    // After a starve the ISR has counted silence too; count from now
+    uint32_t sent = __atomic_load_n(&data->tx_sent, __ATOMIC_ACQUIRE);
+    if ((int32_t)(data->tx_written - sent) < 0) {
+        data->tx_written = sent;
+    }
+
+    size_t written = 0;
+    esp_err_t err = i2s_channel_write(data->tx, buffer, bytes, &written, pdMS_TO_TICKS(I2S_ESP32_IO_TIMEOUT_MS));
+    __atomic_add_fetch(&data->tx_written, (uint32_t)written, __ATOMIC_RELEASE);
+    if (err != ESP_OK || written < bytes) {
+        LOG_WARN("I2S playback write failed: %s", esp_err_to_name(err));
+        return -1;
+    }
+    return 0;
+}
+
+static int i2s_esp32_write(AudioInterface* self, short* buffer, size_t frame_size) {
+    if (!self || !self->impl_data || !buffer) {
+        LOG_ERROR("Invalid parameters");
+        return -1;
+    }
+
+    I2sEsp32Data* data = (I2sEsp32Data*)self->impl_data;
+    if (!self->is_playing || !data->tx || __atomic_load_n(&data->pull_callback, __ATOMIC_ACQUIRE)) {
+        return -1;
+    }
+    return i2s_esp32_write_frames(self, data, buffer, frame_size);
+}
+
+static void* i2s_esp32_play_thread(void* arg) {
+    AudioInterface* self = (AudioInterface*)arg;
+    I2sEsp32Data* data = (I2sEsp32Data*)self->impl_data;
+    size_t frames = data->desc_frames;
+    size_t channels = (size_t)self->channels;
+
+    // i2s_channel_write() blocks until a descriptor frees up, which paces the loop
+    while (__atomic_load_n(&data->play_thread_running, __ATOMIC_ACQUIRE)) {
+        if (__atomic_exchange_n(&data->play_flush, false, __ATOMIC_ACQ_REL)) {
+            i2s_esp32_restart_tx(data);
+        }
+        audio_pull_callback_t callback = __atomic_load_n(&data->pull_callback, __ATOMIC_ACQUIRE);
+        if (!callback) {
+            break;
+        }
+        size_t produced = callback(data->pull_user_data, data->play_frame, frames);
+        if (produced < frames) {
+            memset(data->play_frame + produced * channels, 0, (frames - produced) * channels * sizeof(short));
+        }
+        audio_level_meter_t* meter = __atomic_load_n(&self->playback_level, __ATOMIC_ACQUIRE);
+        if (meter) {
+            audio_level_meter_process(meter, data->play_frame, frames * channels);
+        }
+        i2s_esp32_write_frames(self, data, data->play_frame, frames);
+    }
+    return NULL;
+}
+
+static int i2s_esp32_start_play_thread(AudioInterface* self, I2sEsp32Data* data) {
+    if (data->play_thread || !data->tx) {
+        return 0;
+    }
+
+    linx_thread_attr_t attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.name = "i2s-play";
+    attr.stack_size = 4096;
+    attr.priority = LINX_THREAD_PRIORITY_REALTIME;
+    attr.core_mask = LINX_THREAD_AUDIO_CORE_MASK;
+    attr.sched_priority = LINX_THREAD_AUDIO_SCHED_PRIORITY;
+
+    __atomic_store_n(&data->play_thread_running, true, __ATOMIC_RELEASE);
+    data->play_thread = linx_thread_create(&attr, i2s_esp32_play_thread, self);
+    if (!data->play_thread) {
+        __atomic_store_n(&data->play_thread_running, false, __ATOMIC_RELEASE);
+        LOG_ERROR("Failed to create I2S playback task");
+        return -1;
+    }
+    return 0;
+}
+
+static void i2s_esp32_stop_play_thread(I2sEsp32Data* data) {
+    if (!data->play_thread) {
+        return;
+    }
+    __atomic_store_n(&data->play_thread_running, false, __ATOMIC_RELEASE);
+    linx_thread_join(data->play_thread);
+    data->play_thread = NULL;
+}
+
+static int i2s_esp32_set_pull_source(AudioInterface* self, audio_pull_callback_t callback, void* user_data) {
+    if (!self || !self->impl_data) {
+        LOG_ERROR("Invalid audio interface");
+        return -1;
+    }
+
+    I2sEsp32Data* data = (I2sEsp32Data*)self->impl_data;
+    if (!callback) {
+        i2s_esp32_stop_play_thread(data);
+    }
+
+    // Publish user_data before the callback that uses it
+    __atomic_store_n(&data->pull_callback, NULL, __ATOMIC_RELEASE);
+    data->pull_user_data = user_data;
+    __atomic_store_n(&data->pull_callback, callback, __ATOMIC_RELEASE);
+
+    if (callback) {
+        // Drop anything queued through write() so the two modes never interleave
+        __atomic_store_n(&data->play_flush, true, __ATOMIC_RELEASE);
+        if (self->is_playing && i2s_esp32_start_play_thread(self, data) < 0) {
+            return -1;
+        }
+    } else if (data->tx && self->is_playing) {
+        i2s_esp32_restart_tx(data);
+    }
+
+    LOG_INFO("Playback switched to %s mode", callback ? "pull" : "push");
+    return 0;
+}
+
+static int i2s_esp32_flush_play(AudioInterface* self) {
+    if (!self || !self->impl_data) {
+        LOG_ERROR("Invalid audio interface");
+        return -1;
+    }
+
+    I2sEsp32Data* data = (I2sEsp32Data*)self->impl_data;
+    if (!data->tx || !self->is_playing) {
+        return 0;
+    }
+    // In pull mode the playback task owns the channel and performs the restart
+    if (__atomic_load_n(&data->pull_callback, __ATOMIC_ACQUIRE)) {
+        __atomic_store_n(&data->play_flush, true, __ATOMIC_RELEASE);
+    } else {
+        i2s_esp32_restart_tx(data);
+    }
+    return 0;
+}
+
+static int i2s_esp32_record(AudioInterface* self) {
+    if (!self || !self->impl_data) {
+        LOG_ERROR("Invalid audio interface");
+        return -1;
+    }
+
+    I2sEsp32Data* data = (I2sEsp32Data*)self->impl_data;
+    if (self->is_recording) {
+        return 0;
+    }
+    if (!i2s_esp32_config_valid(self, data) || i2s_esp32_open_channels(self, data) < 0) {
+        return -1;
+    }
+    if (!data->rx) {
+        LOG_ERROR("No microphone configured");
+        return -1;
+    }
+
+    data->ready_head = 0;
+    data->ready_tail = 0;
+    data->read_offset = 0;
+    esp_err_t err = i2s_channel_enable(data->rx);
+    if (err != ESP_OK) {
+        LOG_ERROR("Failed to start I2S capture: %s", esp_err_to_name(err));
+        return -1;
+    }
+
+    self->is_recording = true;
+    LOG_INFO("Recording started");
+    return 0;
+}
+
+static int i2s_esp32_init_play(AudioInterface* self) {
+    if (!self || !self->impl_data) {
+        LOG_ERROR("Invalid audio interface");
+        return -1;
+    }
+
+    I2sEsp32Data* data = (I2sEsp32Data*)self->impl_data;
+    if (self->is_playing) {
+        return 0;
+    }
+    if (!i2s_esp32_config_valid(self, data) || i2s_esp32_open_channels(self, data) < 0) {
+        return -1;
+    }
+    if (!data->tx) {
+        LOG_ERROR("No speaker configured");
+        return -1;
+    }
+
+    data->play_frame = (short*)LINX_MALLOC((size_t)data->desc_frames * (size_t)self->channels * sizeof(short));
+    if (!data->play_frame) {
+        LOG_ERROR("Failed to allocate playback frame buffer");
+        return -1;
+    }
+    esp_err_t err = i2s_channel_enable(data->tx);
+    if (err != ESP_OK) {
+        LOG_ERROR("Failed to start I2S playback: %s", esp_err_to_name(err));
+        LINX_FREE(data->play_frame);
+        data->play_frame = NULL;
+        return -1;
+    }
+
+    self->is_playing = true;
+    if (__atomic_load_n(&data->pull_callback, __ATOMIC_ACQUIRE) && i2s_esp32_start_play_thread(self, data) < 0) {
+        self->is_playing = false;
+        i2s_channel_disable(data->tx);
+        LINX_FREE(data->play_frame);
+        data->play_frame = NULL;
+        return -1;
+    }
+
+    LOG_INFO("Playback started");
+    return 0;
+}
+
+static bool i2s_esp32_is_play_buffer_empty(AudioInterface* self) {
+    if (!self || !self->impl_data) {
+        return true;
+    }
+
+    I2sEsp32Data* data = (I2sEsp32Data*)self->impl_data;
+    if (!self->is_playing) {
+        return true;
+    }
+    uint32_t written = __atomic_load_n(&data->tx_written, __ATOMIC_ACQUIRE);
+    uint32_t sent = __atomic_load_n(&data->tx_sent, __ATOMIC_ACQUIRE);
+    return (int32_t)(written - sent) <= 0;
+}
+
+bool i2s_esp32_get_stats(AudioInterface* self, i2s_esp32_stats_t* stats) {
+    if (!self || !self->impl_data || !stats) {
+        return false;
+    }
+
+    I2sEsp32Data* data = (I2sEsp32Data*)self->impl_data;
+    stats->rx_buffers = __atomic_load_n(&data->rx_seq, __ATOMIC_ACQUIRE);
+    stats->rx_dropped = __atomic_load_n(&data->rx_dropped, __ATOMIC_RELAXED);
+    stats->rx_overwritten = data->rx_overwritten;
+    stats->tx_bytes = __atomic_load_n(&data->tx_sent, __ATOMIC_ACQUIRE);
+    return true;
+}
+
+static int i2s_esp32_destroy(AudioInterface* self) {
+    if (!self || !self->impl_data) {
+        return -1;
+    }
+
+    I2sEsp32Data* data = (I2sEsp32Data*)self->impl_data;
+
+    // The pull task writes to the TX channel; stop it first
+    i2s_esp32_stop_play_thread(data);
+    if (data->rx && self->is_recording) {
+        i2s_channel_disable(data->rx);
+    }
+    if (data->tx && self->is_playing) {
+        i2s_channel_disable(data->tx);
+    }
+    self->is_recording = false;
+    self->is_playing = false;
+    i2s_esp32_delete_channels(data);
+
+    LINX_FREE(data->play_frame);
+    LINX_FREE(data);
+    self->impl_data = NULL;
+
+    LOG_INFO("ESP32 I2S implementation destroyed");
+    return 0;
+}
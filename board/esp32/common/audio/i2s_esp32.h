@@ -0,0 +1,87 @@
+#ifndef I2S_ESP32_H
+#define I2S_ESP32_H
+
+#include "audio/audio_interface.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Microphone interface
+ */
+typedef enum {
+    I2S_ESP32_MIC_STD = 0,      // Standard (Philips) I2S, e.g. INMP441 / ICS-43434
+    I2S_ESP32_MIC_PDM,          // PDM microphone (PDM RX exists on I2S0 only)
+    I2S_ESP32_MIC_NONE          // Playback only
+} i2s_esp32_mic_mode_t;
+
+/**
+ * Pin and controller assignment; GPIO numbers, -1 for unused pins
+ *
+ * A standard-mode mic on the same port as the speaker runs as one full-duplex
+ * channel pair sharing spk_bclk/spk_ws (mic_bclk/mic_ws are then ignored).
+ * spk_dout < 0 builds a capture-only interface.
+ */
+typedef struct {
+    i2s_esp32_mic_mode_t mic_mode;
+    int mic_port;               // I2S controller number
+    int mic_bclk;               // STD: bit clock
+    int mic_ws;                 // STD: word select
+    int mic_din;                // STD: data in
+    int mic_pdm_clk;            // PDM: clock
+    int mic_pdm_din;            // PDM: data in
+    int mic_slot_bits;          // STD: bits per slot on the wire, 0 = 16 (use 32 for 24-bit MEMS mics)
+
+    int spk_port;               // I2S controller number
+    int spk_mclk;               // Master clock for codecs that need one, -1 if not
+    int spk_bclk;
+    int spk_ws;
+    int spk_dout;
+} i2s_esp32_config_t;
+
+/**
+ * Capture and playback counters
+ */
+typedef struct {
+    uint64_t rx_buffers;        // DMA buffers completed by the mic channel
+    uint64_t rx_dropped;        // Buffers DMA refilled before the reader took them
+    uint64_t rx_overwritten;    // Borrowed buffers DMA refilled before they were released
+    uint64_t tx_bytes;          // Bytes the speaker DMA has sent
+} i2s_esp32_stats_t;
+
+/**
+ * Create the ESP-IDF I2S AudioInterface adapter (ESP-IDF 5.x channel driver)
+ *
+ * Each DMA descriptor holds one codec frame; the mic channel's receive ISR
+ * queues every finished buffer and wakes the capture task with a task
+ * notification. acquire_frame() lends that DMA buffer straight to the
+ * encoder (zero-copy) until release_frame(); read() copies from it.
+ *
+ * audio_interface_set_config() sets the DMA geometry: period_size frames
+ * per descriptor (0 uses frame_size; acquire_frame needs the two equal) and
+ * periods descriptors per channel (0 uses 2, i.e. ping-pong). With N
+ * descriptors a borrowed buffer survives N - 1 frame times before DMA
+ * refills it, so the encoder must finish within one frame at the default;
+ * raise periods for slower consumers. buffer_size is ignored.
+ *
+ * Playback copies into the TX DMA buffers with i2s_channel_write(); a pull
+ * source runs on an internal real-time task. Starved TX DMA sends silence.
+ *
+ * @param config Pin assignment (copied)
+ * @return AudioInterface instance, NULL on failure
+ */
+AudioInterface* i2s_esp32_create(const i2s_esp32_config_t* config);
+
+/**
+ * Get capture and playback counters
+ * @return true on success
+ */
+bool i2s_esp32_get_stats(AudioInterface* self, i2s_esp32_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // I2S_ESP32_H
@@ -0,0 +1,1021 @@
+#include "alsa_linux.h"
+#include "linx_log.h"
+#include "linx_alloc.h"
+#include "os/linx_os.h"
+#include <alsa/asoundlib.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_BOARD);
+
+#define ALSA_LINUX_DEFAULT_DEVICE "default"
+#define ALSA_LINUX_DEFAULT_PERIODS 2
+// Longest read()/write() wait for the device before giving up
+#define ALSA_LINUX_IO_TIMEOUT_MS 1000
+
+/**
+ * One PCM direction
+ */
+typedef struct {
+    snd_pcm_t* pcm;
+    snd_pcm_stream_t direction;
+    char device[64];
+    bool mmap;                          // False: device refused mmap, readi/writei fallback
+    snd_pcm_uframes_t period_frames;    // Negotiated geometry
+    snd_pcm_uframes_t buffer_frames;
+    struct pollfd* fds;
+    int nfds;
+    uint64_t xruns;                     // Overruns (capture) / underruns (playback)
+} alsa_stream_t;
+
+/**
+ * ALSA implementation data structure
+ */
+typedef struct {
+    alsa_stream_t capture;
+    alsa_stream_t playback;
+
+    // Pull-mode source (published atomically); serviced by play_thread, or by
+    // the caller through alsa_linux_service() when external_poll is set
+    audio_pull_callback_t pull_callback;
+    void* pull_user_data;
+    bool play_flush;                // Next write()/service drops queued playback
+    bool external_poll;
+    linx_thread_t* play_thread;
+    bool play_thread_running;
+    short* play_scratch;            // One period for the writei fallback
+
+    // Capture frame lent out by acquire_frame (at most one at a time). A
+    // zero frame count means it was copied into frame_bounce because it
+    // wrapped the end of the DMA buffer.
+    bool frame_borrowed;
+    snd_pcm_uframes_t frame_offset;
+    snd_pcm_uframes_t frame_frames;
+    short* frame_bounce;
+
+    uint64_t capture_time_us;       // Time of the last frame read
+    bool capture_time_valid;
+} AlsaLinuxData;
+
+
+// Forward declarations for vtable functions
+static int alsa_linux_init(AudioInterface* self);
+static void alsa_linux_set_config(AudioInterface* self, unsigned int sample_rate,
+                                  int frame_size, int channels, int periods,
+                                  int buffer_size, int period_size);
+static int alsa_linux_read(AudioInterface* self, short* buffer, size_t frame_size);
+static int alsa_linux_write(AudioInterface* self, short* buffer, size_t frame_size);
+static int alsa_linux_record(AudioInterface* self);
+static int alsa_linux_init_play(AudioInterface* self);
+static bool alsa_linux_is_play_buffer_empty(AudioInterface* self);
+static int alsa_linux_destroy(AudioInterface* self);
+static int alsa_linux_set_pull_source(AudioInterface* self, audio_pull_callback_t callback, void* user_data);
+static int alsa_linux_acquire_frame(AudioInterface* self, audio_capture_frame_t* frame, int timeout_ms);
+static int alsa_linux_release_frame(AudioInterface* self, audio_capture_frame_t* frame);
+static int alsa_linux_flush_play(AudioInterface* self);
+static int alsa_linux_get_capture_time(AudioInterface* self, uint64_t* time_us);
+static int alsa_linux_get_play_delay(AudioInterface* self, uint32_t* delay_us);
+static int alsa_linux_read_timed(AudioInterface* self, short* buffer, size_t frame_size, uint32_t timeout_us,
+                                 uint64_t* time_us);
+
+// VTable for ALSA Linux implementation
+static const AudioInterfaceVTable alsa_linux_vtable = {
+    .init = alsa_linux_init,
+    .set_config = alsa_linux_set_config,
+    .read = alsa_linux_read,
+    .write = alsa_linux_write,
+    .record = alsa_linux_record,
+    .init_play = alsa_linux_init_play,
+    .is_play_buffer_empty = alsa_linux_is_play_buffer_empty,
+    .destroy = alsa_linux_destroy,
+    .set_pull_source = alsa_linux_set_pull_source,
+    .acquire_frame = alsa_linux_acquire_frame,
+    .release_frame = alsa_linux_release_frame,
+    .flush_play = alsa_linux_flush_play,
+    .get_capture_time = alsa_linux_get_capture_time,
+    .get_play_delay = alsa_linux_get_play_delay,
+    .read_timed = alsa_linux_read_timed
+};
+
+static void alsa_stream_setup(alsa_stream_t* stream, snd_pcm_stream_t direction, const char* device) {
+    stream->direction = direction;
+    snprintf(stream->device, sizeof(stream->device), "%s", device ? device : ALSA_LINUX_DEFAULT_DEVICE);
+}
+
+static const char* alsa_stream_kind(const alsa_stream_t* stream) {
+    return stream->direction == SND_PCM_STREAM_CAPTURE ? "capture" : "playback";
+}
+
+AudioInterface* alsa_linux_create(const char* capture_device, const char* playback_device) {
+    AudioInterface* interface = (AudioInterface*)LINX_MALLOC(sizeof(AudioInterface));
+    if (!interface) {
+        LOG_ERROR("Failed to allocate memory for AudioInterface");
+        return NULL;
+    }
+
+    AlsaLinuxData* data = (AlsaLinuxData*)LINX_MALLOC(sizeof(AlsaLinuxData));
+    if (!data) {
+        LOG_ERROR("Failed to allocate memory for AlsaLinuxData");
+        LINX_FREE(interface);
+        return NULL;
+    }
+
+    memset(interface, 0, sizeof(AudioInterface));
+    memset(data, 0, sizeof(AlsaLinuxData));
+
+    alsa_stream_setup(&data->capture, SND_PCM_STREAM_CAPTURE, capture_device);
+    alsa_stream_setup(&data->playback, SND_PCM_STREAM_PLAYBACK, playback_device);
+
+    interface->vtable = &alsa_linux_vtable;
+    interface->impl_data = data;
+    return interface;
+}
+
+/**
+ * Start of the interleaved S16 frame at `offset` in an mmap area
+ */
+static short* alsa_area_frames(const snd_pcm_channel_area_t* areas, snd_pcm_uframes_t offset) {
+    return (short*)((uint8_t*)areas[0].addr + (areas[0].first + offset * areas[0].step) / 8);
+}
+
+/**
+ * Open and configure one direction with the geometry from set_config
+ */
+static int alsa_stream_open(AudioInterface* self, alsa_stream_t* stream) {
+    const char* kind = alsa_stream_kind(stream);
+    const char* step = "open";
+    int err = snd_pcm_open(&stream->pcm, stream->device, stream->direction, 0);
+    if (err < 0) {
+        stream->pcm = NULL;
+        LOG_ERROR("Failed to open ALSA %s device %s: %s", kind, stream->device, snd_strerror(err));
+        return -1;
+    }
+    bool capture = stream->direction == SND_PCM_STREAM_CAPTURE;
+
+    snd_pcm_hw_params_t* hw;
+    snd_pcm_hw_params_alloca(&hw);
+    step = "hw params";
+    if ((err = snd_pcm_hw_params_any(stream->pcm, hw)) < 0) {
+        goto fail;
+    }
+
+    // mmap lets read/write and the pull source touch the DMA buffer directly
+    stream->mmap = snd_pcm_hw_params_set_access(stream->pcm, hw, SND_PCM_ACCESS_MMAP_INTERLEAVED) == 0;
+    if (!stream->mmap) {
+        step = "access";
+        if ((err = snd_pcm_hw_params_set_access(stream->pcm, hw, SND_PCM_ACCESS_RW_INTERLEAVED)) < 0) {
+            goto fail;
+        }
+        LOG_WARN("ALSA %s device %s has no mmap access, using read/write", kind, stream->device);
+    }
+
+    step = "format";
+    if ((err = snd_pcm_hw_params_set_format(stream->pcm, hw, SND_PCM_FORMAT_S16_LE)) < 0) {
+        goto fail;
+    }
+    step = "channels";
+    if ((err = snd_pcm_hw_params_set_channels(stream->pcm, hw, (unsigned int)self->channels)) < 0) {
+        goto fail;
+    }
+    // Let plug devices resample; a hw: device without the rate fails here
+    snd_pcm_hw_params_set_rate_resample(stream->pcm, hw, 1);
+    step = "rate (use a plughw: device for conversion)";
+    if ((err = snd_pcm_hw_params_set_rate(stream->pcm, hw, self->sample_rate, 0)) < 0) {
+        goto fail;
+    }
+
+    snd_pcm_uframes_t period = self->period_size > 0 ? (snd_pcm_uframes_t)self->period_size
+                                                     : (snd_pcm_uframes_t)self->frame_size;
+    unsigned int periods = self->periods > 0 ? (unsigned int)self->periods : ALSA_LINUX_DEFAULT_PERIODS;
+    snd_pcm_uframes_t buffer = self->buffer_size > 0 ? (snd_pcm_uframes_t)self->buffer_size : period * periods;
+    if (buffer < period * 2) {
+        buffer = period * 2;
+    }
+    int dir = 0;
+    step = "period size";
+    if ((err = snd_pcm_hw_params_set_period_size_near(stream->pcm, hw, &period, &dir)) < 0) {
+        goto fail;
+    }
+    step = "buffer size";
+    if ((err = snd_pcm_hw_params_set_buffer_size_near(stream->pcm, hw, &buffer)) < 0) {
+        goto fail;
+    }
+    step = "hw params";
+    if ((err = snd_pcm_hw_params(stream->pcm, hw)) < 0) {
+        goto fail;
+    }
+    snd_pcm_hw_params_get_period_size(hw, &stream->period_frames, &dir);
+    snd_pcm_hw_params_get_buffer_size(hw, &stream->buffer_frames);
+
+    snd_pcm_sw_params_t* sw;
+    snd_pcm_sw_params_alloca(&sw);
+    step = "sw params";
+    if ((err = snd_pcm_sw_params_current(stream->pcm, sw)) < 0) {
+        goto fail;
+    }
+    // Wake up once a whole codec frame is captured, or a period can be refilled
+    snd_pcm_sw_params_set_avail_min(stream->pcm, sw, capture ? (snd_pcm_uframes_t)self->frame_size
+                                                             : stream->period_frames);
+    // Playback starts with one period queued; capture is started by record()
+    snd_pcm_sw_params_set_start_threshold(stream->pcm, sw, capture ? stream->buffer_frames
+                                                                   : stream->period_frames);
+    // Driver timestamps on the monotonic clock, for capture times
+    snd_pcm_sw_params_set_tstamp_mode(stream->pcm, sw, SND_PCM_TSTAMP_ENABLE);
+#if SND_LIB_VERSION >= 0x01000f
+    snd_pcm_sw_params_set_tstamp_type(stream->pcm, sw, SND_PCM_TSTAMP_TYPE_MONOTONIC);
+#endif
+    if ((err = snd_pcm_sw_params(stream->pcm, sw)) < 0) {
+        goto fail;
+    }
+
+    step = "poll descriptors";
+    stream->nfds = snd_pcm_poll_descriptors_count(stream->pcm);
+    if (stream->nfds <= 0) {
+        err = -EINVAL;
+        goto fail;
+    }
+    stream->fds = (struct pollfd*)LINX_CALLOC((size_t)stream->nfds, sizeof(struct pollfd));
+    if (!stream->fds) {
+        err = -ENOMEM;
+        goto fail;
+    }
+    snd_pcm_poll_descriptors(stream->pcm, stream->fds, (unsigned int)stream->nfds);
+
+    step = "prepare";
+    if ((err = snd_pcm_prepare(stream->pcm)) < 0) {
+        goto fail;
+    }
+
+    LOG_INFO("ALSA %s %s: %u Hz, %d channels, period %lu frames, buffer %lu frames (%s)",
+             kind, stream->device, self->sample_rate, self->channels,
+             (unsigned long)stream->period_frames, (unsigned long)stream->buffer_frames,
+             stream->mmap ? "mmap" : "read/write");
+    return 0;
+
+fail:
+    LOG_ERROR("Failed to configure ALSA %s device %s (%s): %s", kind, stream->device, step, snd_strerror(err));
+    LINX_FREE(stream->fds);
+    stream->fds = NULL;
+    stream->nfds = 0;
+    snd_pcm_close(stream->pcm);
+    stream->pcm = NULL;
+    return -1;
+}
+
+static void alsa_stream_close(alsa_stream_t* stream) {
+    if (stream->pcm) {
+        snd_pcm_drop(stream->pcm);
+        snd_pcm_close(stream->pcm);
+        stream->pcm = NULL;
+    }
+    LINX_FREE(stream->fds);
+    stream->fds = NULL;
+    stream->nfds = 0;
+}
+
+/**
+ * Recover from an xrun or suspend; a recovered capture stream is restarted
+ */
+static int alsa_stream_recover(alsa_stream_t* stream, int err) {
+    if (err == -EPIPE) {
+        __atomic_add_fetch(&stream->xruns, 1, __ATOMIC_RELAXED);
+        LOG_WARN("ALSA %s %s", alsa_stream_kind(stream),
+                 stream->direction == SND_PCM_STREAM_CAPTURE ? "overrun" : "underrun");
+    }
+    err = snd_pcm_recover(stream->pcm, err, 1);
+    if (err == 0 && stream->direction == SND_PCM_STREAM_CAPTURE) {
+        err = snd_pcm_start(stream->pcm);
+    }
+    if (err < 0) {
+        LOG_ERROR("ALSA %s recovery failed: %s", alsa_stream_kind(stream), snd_strerror(err));
+    }
+    return err;
+}
+
+/**
+ * Wait until `frames` can be transferred without blocking
+ * @param timeout_ms <0 waits forever
+ * @return Available frames, <0 on timeout (-EAGAIN) or device error
+ */
+static snd_pcm_sframes_t alsa_stream_wait(alsa_stream_t* stream, snd_pcm_uframes_t frames, int timeout_ms) {
+    uint64_t deadline = timeout_ms >= 0 ? linx_os_now_ms() + (uint64_t)timeout_ms : 0;
+    for (;;) {
+        snd_pcm_sframes_t avail = snd_pcm_avail_update(stream->pcm);
+        if (avail < 0) {
+            if (alsa_stream_recover(stream, (int)avail) < 0) {
+                return avail;
+            }
+            continue;
+        }
+        if ((snd_pcm_uframes_t)avail >= frames) {
+            return avail;
+        }
+        // A prepared playback stream whose buffer filled below the start
+        // threshold would otherwise never drain
+        if (stream->direction == SND_PCM_STREAM_PLAYBACK && snd_pcm_state(stream->pcm) == SND_PCM_STATE_PREPARED) {
+            snd_pcm_start(stream->pcm);
+        }
+
+        int wait_ms = -1;
+        if (timeout_ms >= 0) {
+            uint64_t now = linx_os_now_ms();
+            if (now >= deadline) {
+                return -EAGAIN;
+            }
+            wait_ms = (int)(deadline - now);
+        }
+        int ret = poll(stream->fds, (nfds_t)stream->nfds, wait_ms);
+        if (ret < 0 && errno != EINTR) {
+            return -errno;
+        }
+        if (ret > 0) {
+            // Plugins (dmix, pulse) need the revents demangled to ack the wakeup
+            unsigned short revents = 0;
+            snd_pcm_poll_descriptors_revents(stream->pcm, stream->fds, (unsigned int)stream->nfds, &revents);
+        }
+    }
+}
+
+/**
+ * Move `frames` interleaved frames between `buffer` and the device; the
+ * caller has waited for them to be available
+ */
+static int alsa_stream_transfer(alsa_stream_t* stream, short* buffer, snd_pcm_uframes_t frames, int channels) {
+    bool capture = stream->direction == SND_PCM_STREAM_CAPTURE;
+    snd_pcm_uframes_t done = 0;
+    while (done < frames) {
+        short* user = buffer + done * (size_t)channels;
+        snd_pcm_sframes_t moved;
+        if (stream->mmap) {
+            const snd_pcm_channel_area_t* areas;
+            snd_pcm_uframes_t offset;
+            snd_pcm_uframes_t count = frames - done;
+            int err = snd_pcm_mmap_begin(stream->pcm, &areas, &offset, &count);
+            if (err < 0) {
+                return err;
+            }
+            if (count == 0) {
+                return -EAGAIN;
+            }
+            short* dma = alsa_area_frames(areas, offset);
+            size_t bytes = count * (size_t)channels * sizeof(short);
+            if (capture) {
+                memcpy(user, dma, bytes);
+            } else {
+                memcpy(dma, user, bytes);
+            }
+            moved = snd_pcm_mmap_commit(stream->pcm, offset, count);
+        } else {
+            moved = capture ? snd_pcm_readi(stream->pcm, user, frames - done)
+                            : snd_pcm_writei(stream->pcm, user, frames - done);
+        }
+        if (moved < 0) {
+            return (int)moved;
+        }
+        if (moved == 0) {
+            return -EAGAIN;
+        }
+        done += (snd_pcm_uframes_t)moved;
+    }
+    return 0;
+}
+
+/**
+ * Capture time of the oldest unread frame: the driver stamped the moment
+ * it last advanced the hardware pointer, when `avail` frames were queued
+ */
+static void alsa_linux_stamp_capture(AudioInterface* self, AlsaLinuxData* data) {
+    snd_pcm_uframes_t avail;
+    snd_htimestamp_t tstamp;
+    data->capture_time_valid = false;
+    if (self->sample_rate == 0 || snd_pcm_htimestamp(data->capture.pcm, &avail, &tstamp) < 0 ||
+        (tstamp.tv_sec == 0 && tstamp.tv_nsec == 0)) {
+        return;
+    }
+    uint64_t stamp_us = (uint64_t)tstamp.tv_sec * 1000000u + (uint64_t)tstamp.tv_nsec / 1000u;
+    uint64_t queued_us = (uint64_t)avail * 1000000u / self->sample_rate;
+    data->capture_time_us = stamp_us > queued_us ? stamp_us - queued_us : 0;
+    data->capture_time_valid = true;
+}
+
+static int alsa_linux_init(AudioInterface* self) {
+    if (!self || !self->impl_data) {
+        LOG_ERROR("Invalid audio interface");
+        return -1;
+    }
+
+    // Devices are opened by record()/init_play() once the geometry is known
+    self->is_initialized = true;
+    LOG_INFO("ALSA initialized (%s)", snd_asoundlib_version());
+    return 0;
+}
+
+static void alsa_linux_set_config(AudioInterface* self, unsigned int sample_rate,
+                                  int frame_size, int channels, int periods,
+                                  int buffer_size, int period_size) {
+    if (!self || !self->impl_data) {
+        LOG_ERROR("Invalid audio interface");
+        return;
+    }
+
+    AlsaLinuxData* data = (AlsaLinuxData*)self->impl_data;
+    if (data->capture.pcm || data->playback.pcm) {
+        LOG_WARN("ALSA configuration changed while streams are open; applies on the next open");
+    }
+
+    self->sample_rate = sample_rate;
+    self->frame_size = frame_size;
+    self->channels = channels;
+    self->periods = periods;
+    self->buffer_size = buffer_size;
+    self->period_size = period_size;
+
+    LOG_INFO("Audio config: %u Hz, %d channels, frame %d, period %d, periods %d, buffer %d",
+             sample_rate, channels, frame_size, period_size, periods, buffer_size);
+}
+
+static bool alsa_linux_config_valid(const AudioInterface* self) {
+    if (self->sample_rate == 0 || self->frame_size <= 0 || self->channels <= 0) {
+        LOG_ERROR("Audio interface not configured");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Wait up to `timeout_ms` for `frame_size` frames, then copy them out
+ * @return 0, AUDIO_READ_TIMEOUT or -1
+ */
+static int alsa_linux_capture(AudioInterface* self, short* buffer, size_t frame_size, int timeout_ms) {
+    if (!self || !self->impl_data || !buffer) {
+        LOG_ERROR("Invalid parameters");
+        return -1;
+    }
+
+    AlsaLinuxData* data = (AlsaLinuxData*)self->impl_data;
+    alsa_stream_t* stream = &data->capture;
+    if (!self->is_recording || !stream->pcm || frame_size > stream->buffer_frames) {
+        return -1;
+    }
+
+    // One retry after recovering from an overrun during the transfer
+    for (int attempt = 0; attempt < 2; attempt++) {
+        snd_pcm_sframes_t avail = alsa_stream_wait(stream, frame_size, timeout_ms);
+        if (avail == -EAGAIN) {
+            return AUDIO_READ_TIMEOUT;
+        }
+        if (avail < 0) {
+            return -1;
+        }
+        alsa_linux_stamp_capture(self, data);
+        int err = alsa_stream_transfer(stream, buffer, frame_size, self->channels);
+        if (err == 0) {
+            return 0;
+        }
+        if (alsa_stream_recover(stream, err) < 0) {
+            return -1;
+        }
+    }
+    return -1;
+}
+
+static int alsa_linux_read(AudioInterface* self, short* buffer, size_t frame_size) {
+    int result = alsa_linux_capture(self, buffer, frame_size, ALSA_LINUX_IO_TIMEOUT_MS);
+    if (result == AUDIO_READ_TIMEOUT) {
+        LOG_WARN("ALSA capture timed out");
+        return -1;
+    }
+    return result;
+}
+
+static int alsa_linux_read_timed(AudioInterface* self, short* buffer, size_t frame_size, uint32_t timeout_us,
+                                 uint64_t* time_us) {
+    // poll() has millisecond resolution; round up so a short deadline still waits
+    int timeout_ms = (int)(((uint64_t)timeout_us + 999u) / 1000u);
+    int result = alsa_linux_capture(self, buffer, frame_size, timeout_ms);
+    if (result == 0 && time_us) {
+        AlsaLinuxData* data = (AlsaLinuxData*)self->impl_data;
+        *time_us = data->capture_time_valid ? data->capture_time_us : 0;
+    }
+    return result;
+}
+
+static int alsa_linux_acquire_frame(AudioInterface* self, audio_capture_frame_t* frame, int timeout_ms) {
+    if (!self || !self->impl_data || !frame) {
+        LOG_ERROR("Invalid parameters");
+        return -1;
+    }
+
+    AlsaLinuxData* data = (AlsaLinuxData*)self->impl_data;
+    alsa_stream_t* stream = &data->capture;
+    snd_pcm_uframes_t frames = (snd_pcm_uframes_t)self->frame_size;
+    if (!self->is_recording || !stream->pcm || data->frame_borrowed || !data->frame_bounce) {
+        return -1;
+    }
+
+    if (alsa_stream_wait(stream, frames, timeout_ms) < 0) {
+        return -1;
+    }
+    alsa_linux_stamp_capture(self, data);
+
+    if (stream->mmap) {
+        const snd_pcm_channel_area_t* areas;
+        snd_pcm_uframes_t offset;
+        snd_pcm_uframes_t count = frames;
+        int err = snd_pcm_mmap_begin(stream->pcm, &areas, &offset, &count);
+        if (err < 0) {
+            alsa_stream_recover(stream, err);
+            return -1;
+        }
+        if (count == frames) {
+            // Lend the DMA area; release_frame commits it
+            data->frame_borrowed = true;
+            data->frame_offset = offset;
+            data->frame_frames = count;
+            frame->data = alsa_area_frames(areas, offset);
+            frame->frame_count = count;
+            frame->token = data;
+            return 0;
+        }
+        // The frame wraps the end of the buffer: hand the area back untouched
+        // and copy both pieces instead
+        snd_pcm_mmap_commit(stream->pcm, offset, 0);
+    }
+
+    int err = alsa_stream_transfer(stream, data->frame_bounce, frames, self->channels);
+    if (err < 0) {
+        alsa_stream_recover(stream, err);
+        return -1;
+    }
+    data->frame_borrowed = true;
+    data->frame_frames = 0;
+    frame->data = data->frame_bounce;
+    frame->frame_count = frames;
+    frame->token = data;
+    return 0;
+}
+
+static int alsa_linux_release_frame(AudioInterface* self, audio_capture_frame_t* frame) {
+    if (!self || !self->impl_data || !frame) {
+        return -1;
+    }
+
+    AlsaLinuxData* data = (AlsaLinuxData*)self->impl_data;
+    if (!data->frame_borrowed || frame->token != data) {
+        return -1;
+    }
+    data->frame_borrowed = false;
+    frame->data = NULL;
+    frame->frame_count = 0;
+    frame->token = NULL;
+    if (data->frame_frames == 0) {
+        return 0;
+    }
+
+    // An overrun while the frame was lent out invalidates it; the committed
+    // frames are lost either way, so only the recovery matters
+    snd_pcm_sframes_t committed = snd_pcm_mmap_commit(data->capture.pcm, data->frame_offset, data->frame_frames);
+    data->frame_frames = 0;
+    if (committed < 0) {
+        return alsa_stream_recover(&data->capture, (int)committed) < 0 ? -1 : 0;
+    }
+    return 0;
+}
+
+static int alsa_linux_get_capture_time(AudioInterface* self, uint64_t* time_us) {
+    if (!self || !self->impl_data || !time_us) {
+        return -1;
+    }
+    AlsaLinuxData* data = (AlsaLinuxData*)self->impl_data;
+    if (!data->capture_time_valid) {
+        return -1;
+    }
+    *time_us = data->capture_time_us;
+    return 0;
+}
+
+/**
+ * Output delay as the driver sees it: snd_pcm_delay() counts the frames
+ * queued in the ring plus the codec/FIFO latency the driver reports
+ */
+static int alsa_linux_get_play_delay(AudioInterface* self, uint32_t* delay_us) {
+    if (!self || !self->impl_data || !delay_us || self->sample_rate == 0) {
+        return -1;
+    }
+    AlsaLinuxData* data = (AlsaLinuxData*)self->impl_data;
+    snd_pcm_sframes_t delay = 0;
+    if (!self->is_playing || !data->playback.pcm || snd_pcm_delay(data->playback.pcm, &delay) < 0) {
+        return -1;
+    }
+    // Negative after an underrun: nothing is queued
+    *delay_us = delay > 0 ? (uint32_t)((uint64_t)delay * 1000000u / self->sample_rate) : 0;
+    return 0;
+}
+
+/**
+ * Drop queued playback and rearm the stream
+ */
+static void alsa_linux_drop_play(alsa_stream_t* stream) {
+    snd_pcm_drop(stream->pcm);
+    snd_pcm_prepare(stream->pcm);
+}
+
+static int alsa_linux_write(AudioInterface* self, short* buffer, size_t frame_size) {
+    if (!self || !self->impl_data || !buffer) {
+        LOG_ERROR("Invalid parameters");
+        return -1;
+    }
+
+    AlsaLinuxData* data = (AlsaLinuxData*)self->impl_data;
+    alsa_stream_t* stream = &data->playback;
+    if (!self->is_playing || !stream->pcm || frame_size > stream->buffer_frames ||
+        __atomic_load_n(&data->pull_callback, __ATOMIC_ACQUIRE)) {
+        return -1;
+    }
+    if (__atomic_exchange_n(&data->play_flush, false, __ATOMIC_ACQ_REL)) {
+        alsa_linux_drop_play(stream);
+    }
+
+    // One retry after recovering from an underrun during the transfer
+    for (int attempt = 0; attempt < 2; attempt++) {
+        if (alsa_stream_wait(stream, frame_size, ALSA_LINUX_IO_TIMEOUT_MS) < 0) {
+            LOG_WARN("ALSA playback timed out");
+            return -1;
+        }
+        int err = alsa_stream_transfer(stream, buffer, frame_size, self->channels);
+        if (err == 0) {
+            return 0;
+        }
+        if (alsa_stream_recover(stream, err) < 0) {
+            return -1;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Fill `frames` device frames from the pull source, silence for the rest
+ */
+static void alsa_linux_pull(AudioInterface* self, AlsaLinuxData* data, audio_pull_callback_t callback,
+                            short* out, snd_pcm_uframes_t frames) {
+    size_t produced = callback(data->pull_user_data, out, frames);
+    if (produced < frames) {
+        memset(out + produced * (size_t)self->channels, 0,
+               (frames - produced) * (size_t)self->channels * sizeof(short));
+    }
+    audio_level_meter_t* meter = __atomic_load_n(&self->playback_level, __ATOMIC_ACQUIRE);
+    if (meter) {
+        audio_level_meter_process(meter, out, frames * (size_t)self->channels);
+    }
+}
+
+/**
+ * Refill every free period from the pull source, straight into the DMA area
+ */
+static int alsa_linux_play_service(AudioInterface* self, AlsaLinuxData* data) {
+    alsa_stream_t* stream = &data->playback;
+    if (!stream->pcm) {
+        return -1;
+    }
+    if (__atomic_exchange_n(&data->play_flush, false, __ATOMIC_ACQ_REL)) {
+        alsa_linux_drop_play(stream);
+    }
+    audio_pull_callback_t callback = __atomic_load_n(&data->pull_callback, __ATOMIC_ACQUIRE);
+    if (!callback) {
+        return 0;
+    }
+
+    snd_pcm_sframes_t avail = snd_pcm_avail_update(stream->pcm);
+    if (avail < 0) {
+        return alsa_stream_recover(stream, (int)avail) < 0 ? -1 : 0;
+    }
+    while ((snd_pcm_uframes_t)avail >= stream->period_frames) {
+        snd_pcm_uframes_t count = stream->period_frames;
+        snd_pcm_sframes_t moved;
+        if (stream->mmap) {
+            const snd_pcm_channel_area_t* areas;
+            snd_pcm_uframes_t offset;
+            int err = snd_pcm_mmap_begin(stream->pcm, &areas, &offset, &count);
+            if (err < 0) {
+                return alsa_stream_recover(stream, err) < 0 ? -1 : 0;
+            }
+            if (count == 0) {
+                break;
+            }
+            alsa_linux_pull(self, data, callback, alsa_area_frames(areas, offset), count);
+            moved = snd_pcm_mmap_commit(stream->pcm, offset, count);
+        } else {
+            alsa_linux_pull(self, data, callback, data->play_scratch, count);
+            moved = snd_pcm_writei(stream->pcm, data->play_scratch, count);
+        }
+        if (moved < 0) {
+            return alsa_stream_recover(stream, (int)moved) < 0 ? -1 : 0;
+        }
+        avail -= moved;
+    }
+
+    if (snd_pcm_state(stream->pcm) == SND_PCM_STATE_PREPARED) {
+        snd_pcm_start(stream->pcm);
+    }
+    return 0;
+}
+
+static void* alsa_linux_play_thread(void* arg) {
+    AudioInterface* self = (AudioInterface*)arg;
+    AlsaLinuxData* data = (AlsaLinuxData*)self->impl_data;
+    alsa_stream_t* stream = &data->playback;
+
+    // Wake at least every few periods so a stop request is noticed
+    int timeout_ms = (int)(stream->period_frames * 4000u / self->sample_rate);
+    if (timeout_ms < 10) {
+        timeout_ms = 10;
+    }
+
+    while (__atomic_load_n(&data->play_thread_running, __ATOMIC_ACQUIRE)) {
+        int ret = poll(stream->fds, (nfds_t)stream->nfds, timeout_ms);
+        if (ret < 0 && errno != EINTR) {
+            LOG_ERROR("ALSA playback poll failed: %s", strerror(errno));
+            break;
+        }
+        if (ret > 0) {
+            unsigned short revents = 0;
+            snd_pcm_poll_descriptors_revents(stream->pcm, stream->fds, (unsigned int)stream->nfds, &revents);
+        }
+        if (alsa_linux_play_service(self, data) < 0) {
+            LOG_ERROR("ALSA playback failed, pull thread exiting");
+            break;
+        }
+    }
+    return NULL;
+}
+
+static int alsa_linux_start_play_thread(AudioInterface* self, AlsaLinuxData* data) {
+    if (data->play_thread || data->external_poll || !data->playback.pcm) {
+        return 0;
+    }
+
+    linx_thread_attr_t attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.name = "alsa-play";
+    attr.priority = LINX_THREAD_PRIORITY_REALTIME;
+    attr.core_mask = LINX_THREAD_AUDIO_CORE_MASK;
+    attr.sched_priority = LINX_THREAD_AUDIO_SCHED_PRIORITY;
+
+    __atomic_store_n(&data->play_thread_running, true, __ATOMIC_RELEASE);
+    data->play_thread = linx_thread_create(&attr, alsa_linux_play_thread, self);
+    if (!data->play_thread) {
+        __atomic_store_n(&data->play_thread_running, false, __ATOMIC_RELEASE);
+        LOG_ERROR("Failed to create ALSA playback thread");
+        return -1;
+    }
+    return 0;
+}
+
+static void alsa_linux_stop_play_thread(AlsaLinuxData* data) {
+    if (!data->play_thread) {
+        return;
+    }
+    __atomic_store_n(&data->play_thread_running, false, __ATOMIC_RELEASE);
+    linx_thread_join(data->play_thread);
+    data->play_thread = NULL;
+}
+
+static int alsa_linux_set_pull_source(AudioInterface* self, audio_pull_callback_t callback, void* user_data) {
+    if (!self || !self->impl_data) {
+        LOG_ERROR("Invalid audio interface");
+        return -1;
+    }
+
+    AlsaLinuxData* data = (AlsaLinuxData*)self->impl_data;
+
+    // Back in push mode nothing drives the pull thread's poll wakeups, which
+    // would otherwise spin on a writable device
+    if (!callback) {
+        alsa_linux_stop_play_thread(data);
+    }
+
+    // Publish user_data before the callback that uses it
+    __atomic_store_n(&data->pull_callback, NULL, __ATOMIC_RELEASE);
+    data->pull_user_data = user_data;
+    __atomic_store_n(&data->pull_callback, callback, __ATOMIC_RELEASE);
+
+    // Drop anything queued in the other mode so the two never interleave
+    __atomic_store_n(&data->play_flush, true, __ATOMIC_RELEASE);
+
+    if (callback && self->is_playing && alsa_linux_start_play_thread(self, data) < 0) {
+        return -1;
+    }
+
+    LOG_INFO("Playback switched to %s mode", callback ? "pull" : "push");
+    return 0;
+}
+
+static int alsa_linux_flush_play(AudioInterface* self) {
+    if (!self || !self->impl_data) {
+        LOG_ERROR("Invalid audio interface");
+        return -1;
+    }
+
+    AlsaLinuxData* data = (AlsaLinuxData*)self->impl_data;
+    if (!data->playback.pcm) {
+        return 0;
+    }
+    // In pull mode the servicing thread owns the stream and performs the drop
+    if (__atomic_load_n(&data->pull_callback, __ATOMIC_ACQUIRE)) {
+        __atomic_store_n(&data->play_flush, true, __ATOMIC_RELEASE);
+    } else {
+        alsa_linux_drop_play(&data->playback);
+    }
+    return 0;
+}
+
+static int alsa_linux_record(AudioInterface* self) {
+    if (!self || !self->impl_data) {
+        LOG_ERROR("Invalid audio interface");
+        return -1;
+    }
+
+    AlsaLinuxData* data = (AlsaLinuxData*)self->impl_data;
+    if (self->is_recording) {
+        return 0;
+    }
+    if (!alsa_linux_config_valid(self)) {
+        return -1;
+    }
+
+    data->frame_bounce = (short*)LINX_MALLOC((size_t)self->frame_size * (size_t)self->channels * sizeof(short));
+    if (!data->frame_bounce) {
+        LOG_ERROR("Failed to allocate capture frame buffer");
+        return -1;
+    }
+    if (alsa_stream_open(self, &data->capture) < 0) {
+        LINX_FREE(data->frame_bounce);
+        data->frame_bounce = NULL;
+        return -1;
+    }
+
+    int err = snd_pcm_start(data->capture.pcm);
+    if (err < 0) {
+        LOG_ERROR("Failed to start ALSA capture: %s", snd_strerror(err));
+        alsa_stream_close(&data->capture);
+        LINX_FREE(data->frame_bounce);
+        data->frame_bounce = NULL;
+        return -1;
+    }
+
+    self->is_recording = true;
+    LOG_INFO("Recording started");
+    return 0;
+}
+
+static int alsa_linux_init_play(AudioInterface* self) {
+    if (!self || !self->impl_data) {
+        LOG_ERROR("Invalid audio interface");
+        return -1;
+    }
+
+    AlsaLinuxData* data = (AlsaLinuxData*)self->impl_data;
+    if (self->is_playing) {
+        return 0;
+    }
+    if (!alsa_linux_config_valid(self) || alsa_stream_open(self, &data->playback) < 0) {
+        return -1;
+    }
+
+    if (!data->playback.mmap) {
+        data->play_scratch = (short*)LINX_MALLOC(data->playback.period_frames * (size_t)self->channels * sizeof(short));
+        if (!data->play_scratch) {
+            LOG_ERROR("Failed to allocate playback period buffer");
+            alsa_stream_close(&data->playback);
+            return -1;
+        }
+    }
+
+    self->is_playing = true;
+    if (__atomic_load_n(&data->pull_callback, __ATOMIC_ACQUIRE) && alsa_linux_start_play_thread(self, data) < 0) {
+        self->is_playing = false;
+        alsa_stream_close(&data->playback);
+        LINX_FREE(data->play_scratch);
+        data->play_scratch = NULL;
+        return -1;
+    }
+
+    LOG_INFO("Playback started");
+    return 0;
+}
+
+static bool alsa_linux_is_play_buffer_empty(AudioInterface* self) {
+    if (!self || !self->impl_data) {
+        return true;
+    }
+
+    AlsaLinuxData* data = (AlsaLinuxData*)self->impl_data;
+    if (!self->is_playing || !data->playback.pcm) {
+        return true;
+    }
+    // An xrun (negative avail) means the device already ran dry
+    snd_pcm_sframes_t avail = snd_pcm_avail(data->playback.pcm);
+    return avail < 0 || (snd_pcm_uframes_t)avail >= data->playback.buffer_frames;
+}
+
+int alsa_linux_set_external_poll(AudioInterface* self, bool external) {
+    if (!self || !self->impl_data) {
+        return -1;
+    }
+    AlsaLinuxData* data = (AlsaLinuxData*)self->impl_data;
+    if (self->is_playing) {
+        LOG_ERROR("External poll must be chosen before playback starts");
+        return -1;
+    }
+    data->external_poll = external;
+    return 0;
+}
+
+int alsa_linux_poll_descriptors_count(AudioInterface* self) {
+    if (!self || !self->impl_data) {
+        return 0;
+    }
+    AlsaLinuxData* data = (AlsaLinuxData*)self->impl_data;
+    return (data->capture.pcm ? data->capture.nfds : 0) + (data->playback.pcm ? data->playback.nfds : 0);
+}
+
+int alsa_linux_poll_descriptors(AudioInterface* self, struct pollfd* fds, unsigned int space) {
+    if (!self || !self->impl_data || !fds) {
+        return -1;
+    }
+    AlsaLinuxData* data = (AlsaLinuxData*)self->impl_data;
+    if (space < (unsigned int)alsa_linux_poll_descriptors_count(self)) {
+        return -1;
+    }
+
+    unsigned int count = 0;
+    if (data->capture.pcm) {
+        memcpy(fds, data->capture.fds, (size_t)data->capture.nfds * sizeof(struct pollfd));
+        count += (unsigned int)data->capture.nfds;
+    }
+    if (data->playback.pcm) {
+        memcpy(fds + count, data->playback.fds, (size_t)data->playback.nfds * sizeof(struct pollfd));
+        count += (unsigned int)data->playback.nfds;
+    }
+    return (int)count;
+}
+
+int alsa_linux_service(AudioInterface* self, const struct pollfd* fds, unsigned int count) {
+    if (!self || !self->impl_data) {
+        return -1;
+    }
+    AlsaLinuxData* data = (AlsaLinuxData*)self->impl_data;
+    alsa_stream_t* stream = &data->playback;
+    if (!self->is_playing || !stream->pcm) {
+        return 0;
+    }
+
+    // Playback descriptors follow the capture ones (alsa_linux_poll_descriptors)
+    unsigned int first = data->capture.pcm ? (unsigned int)data->capture.nfds : 0;
+    if (fds && count >= first + (unsigned int)stream->nfds) {
+        for (int i = 0; i < stream->nfds; i++) {
+            stream->fds[i].revents = fds[first + i].revents;
+        }
+        unsigned short revents = 0;
+        snd_pcm_poll_descriptors_revents(stream->pcm, stream->fds, (unsigned int)stream->nfds, &revents);
+    }
+    return alsa_linux_play_service(self, data);
+}
+
+bool alsa_linux_get_xrun_stats(AudioInterface* self, uint64_t* capture_overruns, uint64_t* playback_underruns) {
+    if (!self || !self->impl_data) {
+        return false;
+    }
+    AlsaLinuxData* data = (AlsaLinuxData*)self->impl_data;
+    if (capture_overruns) {
+        *capture_overruns = __atomic_load_n(&data->capture.xruns, __ATOMIC_RELAXED);
+    }
+    if (playback_underruns) {
+        *playback_underruns = __atomic_load_n(&data->playback.xruns, __ATOMIC_RELAXED);
+    }
+    return true;
+}
+
+static int alsa_linux_destroy(AudioInterface* self) {
+    if (!self || !self->impl_data) {
+        return -1;
+    }
+
+    AlsaLinuxData* data = (AlsaLinuxData*)self->impl_data;
+
+    // The pull thread uses the playback stream; stop it first
+    alsa_linux_stop_play_thread(data);
+    alsa_stream_close(&data->capture);
+    alsa_stream_close(&data->playback);
+    self->is_recording = false;
+    self->is_playing = false;
+
+    LINX_FREE(data->frame_bounce);
+    LINX_FREE(data->play_scratch);
+    LINX_FREE(data);
+    self->impl_data = NULL;
+
+    LOG_INFO("ALSA Linux implementation destroyed");
+    return 0;
+}
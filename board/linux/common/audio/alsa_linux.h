@@ -0,0 +1,84 @@
+#ifndef ALSA_LINUX_H
+#define ALSA_LINUX_H
+
+#include "audio/audio_interface.h"
+#include <poll.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Create the ALSA AudioInterface adapter for generic Linux boards
+ *
+ * Both directions use mmap'ed period access (snd_pcm_mmap_begin/commit), so
+ * PCM moves straight between the caller and the DMA buffer with no
+ * intermediate ring; devices that refuse mmap access (some plugins) fall
+ * back to snd_pcm_readi/writei. audio_interface_set_config() sets the ALSA
+ * geometry: period_size frames per period (0 uses frame_size), periods per
+ * buffer (0 uses 2) and buffer_size frames (0 uses periods * period_size).
+ * The rate is set exactly; hw: devices that lack it need a plughw: device.
+ *
+ * Also supports zero-copy capture (the caller borrows the DMA area when the
+ * frame does not wrap), pull-mode playback, flush_play and capture times
+ * from the driver's monotonic timestamps.
+ *
+ * @param capture_device  ALSA PCM name for capture, NULL for "default"
+ * @param playback_device ALSA PCM name for playback, NULL for "default"
+ * @return AudioInterface instance, NULL on failure
+ */
+AudioInterface* alsa_linux_create(const char* capture_device, const char* playback_device);
+
+/**
+ * Drive pull-mode playback from the caller's own poll() loop
+ *
+ * By default pull-mode playback runs on an internal real-time thread that
+ * waits on the playback PCM descriptors. With external polling enabled the
+ * caller adds the descriptors from alsa_linux_poll_descriptors() to its own
+ * poll set and calls alsa_linux_service() when poll() returns. Must be set
+ * before audio_interface_init_play().
+ *
+ * @return 0 on success, -1 if playback is already running
+ */
+int alsa_linux_set_external_poll(AudioInterface* self, bool external);
+
+/**
+ * Number of descriptors alsa_linux_poll_descriptors() fills (capture first,
+ * then playback; only streams that are open are included)
+ */
+int alsa_linux_poll_descriptors_count(AudioInterface* self);
+
+/**
+ * Fill the capture and playback PCM descriptors
+ *
+ * A capture descriptor turning readable means audio_interface_read() can
+ * return a frame without blocking; playback descriptors wake the pull
+ * source through alsa_linux_service().
+ *
+ * @return Number of descriptors written, -1 on error
+ */
+int alsa_linux_poll_descriptors(AudioInterface* self, struct pollfd* fds, unsigned int space);
+
+/**
+ * Handle poll() results for the descriptors from alsa_linux_poll_descriptors()
+ *
+ * Refills the playback buffer from the pull source, performs a pending
+ * flush and recovers from xruns. Call from one thread only.
+ *
+ * @return 0 on success, -1 on an unrecoverable device error
+ */
+int alsa_linux_service(AudioInterface* self, const struct pollfd* fds, unsigned int count);
+
+/**
+ * Get xrun counters (capture overruns drop mic samples, playback underruns
+ * mean the device ran dry)
+ * @return true on success
+ */
+bool alsa_linux_get_xrun_stats(AudioInterface* self, uint64_t* capture_overruns, uint64_t* playback_underruns);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ALSA_LINUX_H
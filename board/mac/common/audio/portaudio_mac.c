@@ -1,8 +1,14 @@
 #include "portaudio_mac.h"
 #include "linx_log.h"
+#include "linx_alloc.h"
+#include "audio_resampler.h"
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 #include <unistd.h>
+#include <dispatch/dispatch.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_BOARD);
 
 
 
@@ -15,27 +21,62 @@ typedef struct {
     PaStreamParameters input_params;
     PaStreamParameters output_params;
     
-    // Ring buffers for audio data
-    short* record_buffer;
-    short* play_buffer;
-    size_t record_buffer_size;
-    size_t play_buffer_size;
-    size_t record_read_pos;
-    size_t record_write_pos;
-    size_t play_read_pos;
-    size_t play_write_pos;
+    // Lock-free rings shared with the real-time callbacks: the record callback
+    // produces into record_ring, the play callback consumes from play_ring
+    audio_ring_buffer_t* record_ring;
+    audio_ring_buffer_t* play_ring;
     
     // Thread synchronization
+    // The callbacks never take these mutexes; they only signal the conditions
+    // so blocked readers/writers re-check the rings (waits are short and timed,
+    // so a signal that races the wait costs at most one poll interval)
     pthread_mutex_t record_mutex;
     pthread_mutex_t play_mutex;
     pthread_cond_t record_cond;
     pthread_cond_t play_cond;
+    // Counts record periods, so read_timed wakes on the period that completes
+    // its frame instead of polling (signaling it is safe from the callback)
+    dispatch_semaphore_t record_sem;
     
     // State flags
     bool record_thread_running;
     bool play_thread_running;
     pthread_t record_thread;
     pthread_t play_thread;
+    
+    // Pull-mode source; when set the output callback asks it for PCM
+    // instead of draining play_ring (published atomically)
+    audio_pull_callback_t pull_callback;
+    void* pull_user_data;
+    bool play_flush;            // Consumer discards play_ring on the next callback
+    
+    // Devices run at their native rate; the rings and the caller stay at the
+    // configured (codec) rate and the callbacks resample in between. A NULL
+    // resampler means the device already runs at the configured rate.
+    unsigned int input_rate;
+    unsigned int output_rate;
+    unsigned long input_period;     // Device frames per input callback
+    unsigned long output_period;    // Device frames per output callback
+    audio_resampler_t* record_resampler;
+    audio_resampler_t* play_resampler;
+    short* record_scratch;          // Resampled capture, up to record_scratch_frames
+    size_t record_scratch_frames;
+    short* play_stage;              // Codec-rate PCM waiting to be resampled
+    size_t play_stage_frames;       // Capacity
+    size_t play_stage_offset;       // First unconsumed frame
+    size_t play_stage_length;       // Unconsumed frames
+    
+    // Capture clock: the record callback publishes the ADC time of its first
+    // frame together with the ring frame count at that point (a sequence
+    // counter makes the pair consistent without a lock); read() turns its
+    // own frame count into the capture time of the frame it returns
+    uint64_t clock_seq;             // Odd while the callback updates the pair
+    uint64_t clock_us;
+    uint64_t clock_frames;
+    uint64_t frames_written;        // Record callback only
+    uint64_t frames_read;           // Reader only
+    uint64_t capture_time_us;       // Time of the last frame read
+    bool capture_time_valid;
 } PortAudioMacData;
 
 
@@ -50,6 +91,12 @@ static int portaudio_mac_record(AudioInterface* self);
 static int portaudio_mac_init_play(AudioInterface* self);
 static bool portaudio_mac_is_play_buffer_empty(AudioInterface* self);
 static int portaudio_mac_destroy(AudioInterface* self);
+static int portaudio_mac_set_pull_source(AudioInterface* self, audio_pull_callback_t callback, void* user_data);
+static int portaudio_mac_flush_play(AudioInterface* self);
+static int portaudio_mac_get_capture_time(AudioInterface* self, uint64_t* time_us);
+static int portaudio_mac_get_play_delay(AudioInterface* self, uint32_t* delay_us);
+static int portaudio_mac_read_timed(AudioInterface* self, short* buffer, size_t frame_size, uint32_t timeout_us,
+                                    uint64_t* time_us);
 
 // VTable for PortAudio Mac implementation
 static const AudioInterfaceVTable portaudio_mac_vtable = {
@@ -60,7 +107,12 @@ static const AudioInterfaceVTable portaudio_mac_vtable = {
     .record = portaudio_mac_record,
     .init_play = portaudio_mac_init_play,
     .is_play_buffer_empty = portaudio_mac_is_play_buffer_empty,
-    .destroy = portaudio_mac_destroy
+    .destroy = portaudio_mac_destroy,
+    .set_pull_source = portaudio_mac_set_pull_source,
+    .flush_play = portaudio_mac_flush_play,
+    .get_capture_time = portaudio_mac_get_capture_time,
+    .get_play_delay = portaudio_mac_get_play_delay,
+    .read_timed = portaudio_mac_read_timed
 };
 
 
@@ -80,16 +132,16 @@ static int _portaudio_play_callback(const void* input_buffer, void* output_buffe
                            void* user_data);
 
 AudioInterface* portaudio_mac_create(void) {
-    AudioInterface* interface = (AudioInterface*)malloc(sizeof(AudioInterface));
+    AudioInterface* interface = (AudioInterface*)LINX_MALLOC(sizeof(AudioInterface));
     if (!interface) {
         LOG_ERROR("Failed to allocate memory for AudioInterface");
         return NULL;
     }
     
-    PortAudioMacData* data = (PortAudioMacData*)malloc(sizeof(PortAudioMacData));
+    PortAudioMacData* data = (PortAudioMacData*)LINX_MALLOC(sizeof(PortAudioMacData));
     if (!data) {
         LOG_ERROR("Failed to allocate memory for PortAudioMacData");
-        free(interface);
+        LINX_FREE(interface);
         return NULL;
     }
     
@@ -105,10 +157,52 @@ AudioInterface* portaudio_mac_create(void) {
     pthread_mutex_init(&data->play_mutex, NULL);
     pthread_cond_init(&data->record_cond, NULL);
     pthread_cond_init(&data->play_cond, NULL);
+    data->record_sem = dispatch_semaphore_create(0);
+    if (!data->record_sem) {
+        LOG_ERROR("Failed to create the record semaphore");
+        portaudio_mac_destroy(interface);
+        LINX_FREE(interface);
+        return NULL;
+    }
     
     return interface;
 }
 
+/**
+ * Drop the resampling state built by set_config
+ */
+static void portaudio_mac_free_resamplers(PortAudioMacData* data) {
+    audio_resampler_destroy(data->record_resampler);
+    audio_resampler_destroy(data->play_resampler);
+    LINX_FREE(data->record_scratch);
+    LINX_FREE(data->play_stage);
+    data->record_resampler = NULL;
+    data->play_resampler = NULL;
+    data->record_scratch = NULL;
+    data->play_stage = NULL;
+    data->record_scratch_frames = 0;
+    data->play_stage_frames = 0;
+    data->play_stage_offset = 0;
+    data->play_stage_length = 0;
+}
+
+/**
+ * Device frames covering one codec frame at `device_rate`
+ */
+static unsigned long portaudio_mac_device_period(const AudioInterface* self, unsigned int device_rate) {
+    unsigned long period = (unsigned long)(((uint64_t)self->frame_size * device_rate + self->sample_rate / 2) / self->sample_rate);
+    return period > 0 ? period : 1;
+}
+
+/**
+ * Run the device at its native rate so the host does no hidden resampling;
+ * fall back to the configured rate if the device reports none
+ */
+static unsigned int portaudio_mac_device_rate(const PaDeviceInfo* info, unsigned int sample_rate) {
+    unsigned int native = info->defaultSampleRate > 0 ? (unsigned int)(info->defaultSampleRate + 0.5) : 0;
+    return native > 0 ? native : sample_rate;
+}
+
 static int portaudio_mac_init(AudioInterface* self) {
     if (!self || !self->impl_data) {
         LOG_ERROR("Invalid audio interface");
@@ -165,8 +259,10 @@ static void portaudio_mac_set_config(AudioInterface* self, unsigned int sample_r
     data->input_params.suggestedLatency = inputDeviceInfo->defaultLowInputLatency;
     data->input_params.hostApiSpecificStreamInfo = NULL;
     
-    LOG_INFO("Input device: %s, channels: %d (requested: %d, max: %d)", 
-             inputDeviceInfo->name, inputChannels, channels, inputDeviceInfo->maxInputChannels);
+    data->input_rate = portaudio_mac_device_rate(inputDeviceInfo, sample_rate);
+    
+    LOG_INFO("Input device: %s, %u Hz, channels: %d (requested: %d, max: %d)", 
+             inputDeviceInfo->name, data->input_rate, inputChannels, channels, inputDeviceInfo->maxInputChannels);
     
     // Set up output parameters
     data->output_params.device = Pa_GetDefaultOutputDevice();
@@ -189,23 +285,59 @@ static void portaudio_mac_set_config(AudioInterface* self, unsigned int sample_r
     data->output_params.suggestedLatency = outputDeviceInfo->defaultLowOutputLatency;
     data->output_params.hostApiSpecificStreamInfo = NULL;
     
-    LOG_INFO("Output device: %s, channels: %d (requested: %d, max: %d)", 
-             outputDeviceInfo->name, outputChannels, channels, outputDeviceInfo->maxOutputChannels);
+    data->output_rate = portaudio_mac_device_rate(outputDeviceInfo, sample_rate);
     
-    // Allocate ring buffers
-    data->record_buffer_size = buffer_size * channels;
-    data->play_buffer_size = buffer_size * channels;
+    LOG_INFO("Output device: %s, %u Hz, channels: %d (requested: %d, max: %d)", 
+             outputDeviceInfo->name, data->output_rate, outputChannels, channels, outputDeviceInfo->maxOutputChannels);
     
-    data->record_buffer = (short*)malloc(data->record_buffer_size * sizeof(short));
-    data->play_buffer = (short*)malloc(data->play_buffer_size * sizeof(short));
+    // Allocate ring buffers (capacity is rounded up to a power of two)
+    audio_ring_buffer_destroy(data->record_ring);
+    audio_ring_buffer_destroy(data->play_ring);
+    data->record_ring = audio_ring_buffer_create((size_t)buffer_size * channels);
+    data->frames_written = 0;
+    data->frames_read = 0;
+    data->capture_time_valid = false;
+    data->play_ring = audio_ring_buffer_create((size_t)buffer_size * channels);
     
-    if (!data->record_buffer || !data->play_buffer) {
+    if (!data->record_ring || !data->play_ring) {
         LOG_ERROR("Failed to allocate audio buffers");
         return;
     }
     
-    memset(data->record_buffer, 0, data->record_buffer_size * sizeof(short));
-    memset(data->play_buffer, 0, data->play_buffer_size * sizeof(short));
+    // Resamplers between the device rates and the configured rate
+    portaudio_mac_free_resamplers(data);
+    data->input_period = portaudio_mac_device_period(self, data->input_rate);
+    data->output_period = portaudio_mac_device_period(self, data->output_rate);
+    if (data->input_rate != sample_rate) {
+        data->record_resampler = audio_resampler_create(data->input_rate, sample_rate,
+                                                        channels, data->input_period);
+        if (data->record_resampler) {
+            data->record_scratch_frames = audio_resampler_max_output(data->record_resampler, data->input_period);
+            data->record_scratch = (short*)LINX_MALLOC(data->record_scratch_frames * channels * sizeof(short));
+        }
+        if (!data->record_resampler || !data->record_scratch) {
+            LOG_ERROR("Failed to set up capture resampling, using %u Hz on the device", sample_rate);
+            audio_resampler_destroy(data->record_resampler);
+            data->record_resampler = NULL;
+            data->input_rate = sample_rate;
+            data->input_period = (unsigned long)frame_size;
+        }
+    }
+    if (data->output_rate != sample_rate) {
+        data->play_resampler = audio_resampler_create(sample_rate, data->output_rate,
+                                                      channels, (size_t)frame_size * 2);
+        if (data->play_resampler) {
+            data->play_stage_frames = audio_resampler_input_for_output(data->play_resampler, data->output_period);
+            data->play_stage = (short*)LINX_MALLOC(data->play_stage_frames * channels * sizeof(short));
+        }
+        if (!data->play_resampler || !data->play_stage) {
+            LOG_ERROR("Failed to set up playback resampling, using %u Hz on the device", sample_rate);
+            audio_resampler_destroy(data->play_resampler);
+            data->play_resampler = NULL;
+            data->output_rate = sample_rate;
+            data->output_period = (unsigned long)frame_size;
+        }
+    }
     
     LOG_INFO("Audio configuration set: %u Hz, %d channels, %d frame size", 
                   sample_rate, channels, frame_size);
@@ -220,34 +352,113 @@ int _portaudio_record_callback(const void* input_buffer, void* output_buffer,
     PortAudioMacData* data = (PortAudioMacData*)interface->impl_data;
     const short* input = (const short*)input_buffer;
     
-    if (!input || !data) {
+    if (!input || !data || !data->record_ring) {
         return paContinue;
     }
     
-    pthread_mutex_lock(&data->record_mutex);
+    // Some host APIs leave the ADC time at 0; the stream time minus one period is close enough
+    PaTime adc_time = time_info ? time_info->inputBufferAdcTime : 0;
+    if (adc_time <= 0 && data->input_stream) {
+        adc_time = Pa_GetStreamTime(data->input_stream) - (PaTime)frame_count / data->input_rate;
+    }
+    if (adc_time > 0) {
+        __atomic_store_n(&data->clock_seq, data->clock_seq + 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        __atomic_store_n(&data->clock_us, (uint64_t)(adc_time * 1e6), __ATOMIC_RELAXED);
+        __atomic_store_n(&data->clock_frames, data->frames_written, __ATOMIC_RELAXED);
+        __atomic_store_n(&data->clock_seq, data->clock_seq + 1, __ATOMIC_RELEASE);
+    }
     
-    size_t samples_to_write = frame_count * interface->channels;
-    // Calculate used space in the ring buffer
-    size_t used_space = (data->record_write_pos - data->record_read_pos + data->record_buffer_size) % data->record_buffer_size;
-    // Available space is buffer size minus used space minus 1 (to distinguish full from empty)
-    size_t available_space = data->record_buffer_size - used_space - 1;
+    // Overflow drops the whole period and is counted in the ring statistics
+    // (see portaudio_mac_get_ring_stats); no logging from the real-time thread
+    if (!data->record_resampler) {
+        size_t samples_to_write = frame_count * interface->channels;
+        if (audio_ring_buffer_write_all(data->record_ring, input, samples_to_write)) {
+            data->frames_written += frame_count;
+            pthread_cond_signal(&data->record_cond);
+            dispatch_semaphore_signal(data->record_sem);
+        }
+        return paContinue;
+    }
     
-    if (samples_to_write <= available_space) {
-        for (size_t i = 0; i < samples_to_write; i++) {
-            data->record_buffer[data->record_write_pos] = input[i];
-            data->record_write_pos = (data->record_write_pos + 1) % data->record_buffer_size;
+    // Bring the device period down to the configured rate first
+    bool written = false;
+    size_t used_total = 0;
+    while (used_total < frame_count) {
+        size_t used = 0;
+        size_t produced = audio_resampler_process(data->record_resampler,
+                                                  input + used_total * interface->channels,
+                                                  frame_count - used_total, &used,
+                                                  data->record_scratch, data->record_scratch_frames);
+        if (produced > 0 &&
+            audio_ring_buffer_write_all(data->record_ring, data->record_scratch,
+                                        produced * interface->channels)) {
+            data->frames_written += produced;
+            written = true;
+        }
+        if (used == 0) {
+            break;
         }
+        used_total += used;
+    }
+    if (written) {
         pthread_cond_signal(&data->record_cond);
-    } else {
-        // Buffer overflow - log warning but continue
-        LOG_WARN("Record buffer overflow, dropping %lu samples", samples_to_write);
+        dispatch_semaphore_signal(data->record_sem);
     }
     
-    pthread_mutex_unlock(&data->record_mutex);
-    
     return paContinue;
 }
 
+/**
+ * Fill one device period from codec-rate PCM (play_ring or the pull source)
+ * through the playback resampler; input left over is kept for the next call
+ */
+static void portaudio_mac_play_resampled(AudioInterface* interface, PortAudioMacData* data,
+                                         audio_pull_callback_t pull_callback,
+                                         short* output, unsigned long frame_count) {
+    const int channels = interface->channels;
+    size_t filled = 0;
+    bool drained = false;
+    
+    while (filled < frame_count) {
+        if (data->play_stage_length == 0) {
+            size_t want = audio_resampler_input_for_output(data->play_resampler, frame_count - filled);
+            if (want > data->play_stage_frames) {
+                want = data->play_stage_frames;
+            }
+            size_t got;
+            if (pull_callback) {
+                got = pull_callback(data->pull_user_data, data->play_stage, want);
+            } else {
+                got = audio_ring_buffer_read(data->play_ring, data->play_stage, want * channels) / channels;
+                drained = drained || got > 0;
+            }
+            if (got == 0) {
+                break;
+            }
+            data->play_stage_offset = 0;
+            data->play_stage_length = got;
+        }
+        
+        size_t used = 0;
+        filled += audio_resampler_process(data->play_resampler,
+                                          data->play_stage + data->play_stage_offset * channels,
+                                          data->play_stage_length, &used,
+                                          output + filled * channels, frame_count - filled);
+        data->play_stage_offset += used;
+        data->play_stage_length -= used;
+    }
+    
+    if (filled < frame_count) {
+        // Not enough data (counted as an underrun in push mode), output silence
+        memset(output + filled * channels, 0, (frame_count - filled) * channels * sizeof(short));
+    }
+    if (drained) {
+        // Wake a writer blocked waiting for free space
+        pthread_cond_signal(&data->play_cond);
+    }
+}
+
 int _portaudio_play_callback(const void* input_buffer, void* output_buffer,
                            unsigned long frame_count,
                            const PaStreamCallbackTimeInfo* time_info,
@@ -257,32 +468,105 @@ int _portaudio_play_callback(const void* input_buffer, void* output_buffer,
     PortAudioMacData* data = (PortAudioMacData*)interface->impl_data;
     short* output = (short*)output_buffer;
     
-    if (!output || !data) {
+    if (!output || !data || !data->play_ring) {
         return paContinue;
     }
     
-    pthread_mutex_lock(&data->play_mutex);
-    
     size_t samples_to_read = frame_count * interface->channels;
-    // Calculate available data in the ring buffer
-    size_t available_data = (data->play_write_pos - data->play_read_pos + data->play_buffer_size) % data->play_buffer_size;
     
-    if (samples_to_read <= available_data) {
-        for (size_t i = 0; i < samples_to_read; i++) {
-            output[i] = data->play_buffer[data->play_read_pos];
-            data->play_read_pos = (data->play_read_pos + 1) % data->play_buffer_size;
+    // Only this callback consumes play_ring, so a requested flush is done here
+    if (__atomic_exchange_n(&data->play_flush, false, __ATOMIC_ACQ_REL)) {
+        audio_ring_buffer_discard(data->play_ring);
+        data->play_stage_length = 0;
+        audio_resampler_reset(data->play_resampler);
+        pthread_cond_signal(&data->play_cond);
+    }
+    
+    audio_pull_callback_t pull_callback = __atomic_load_n(&data->pull_callback, __ATOMIC_ACQUIRE);
+    if (data->play_resampler) {
+        portaudio_mac_play_resampled(interface, data, pull_callback, output, frame_count);
+        return paContinue;
+    }
+    
+    // Pull mode: the source decodes straight into the device buffer
+    if (pull_callback) {
+        size_t produced = pull_callback(data->pull_user_data, output, frame_count);
+        if (produced < frame_count) {
+            memset(output + produced * interface->channels, 0,
+                   (frame_count - produced) * interface->channels * sizeof(short));
         }
+        return paContinue;
+    }
+    
+    if (audio_ring_buffer_read_all(data->play_ring, output, samples_to_read)) {
+        // Wake a writer blocked waiting for free space
+        pthread_cond_signal(&data->play_cond);
     } else {
-        // Not enough data, output silence
+        // Not enough data (counted as an underrun), output silence
         memset(output, 0, samples_to_read * sizeof(short));
-        //LOG_DEBUG("Play buffer underrun, outputting silence for %lu samples", samples_to_read);
     }
     
-    pthread_mutex_unlock(&data->play_mutex);
-    
     return paContinue;
 }
 
+/**
+ * Wait on `cond` for at most `timeout_ms` (caller holds `mutex`)
+ */
+static void portaudio_mac_timed_wait(pthread_cond_t* cond, pthread_mutex_t* mutex, int timeout_ms) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    pthread_cond_timedwait(cond, mutex, &deadline);
+}
+
+/**
+ * Poll interval for blocked read/write: one device period, at least 1ms
+ */
+static int portaudio_mac_period_ms(const AudioInterface* self) {
+    int period_ms = self->sample_rate > 0 ? (int)((unsigned int)self->frame_size * 1000 / self->sample_rate) : 0;
+    return period_ms > 0 ? period_ms : 1;
+}
+
+/**
+ * Capture time of the next frame in record_ring, from the last clock the
+ * record callback published (frames at the configured rate)
+ */
+static void portaudio_mac_stamp_capture(AudioInterface* self, PortAudioMacData* data) {
+    uint64_t seq, us, frames;
+    do {
+        seq = __atomic_load_n(&data->clock_seq, __ATOMIC_ACQUIRE);
+        us = __atomic_load_n(&data->clock_us, __ATOMIC_RELAXED);
+        frames = __atomic_load_n(&data->clock_frames, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while ((seq & 1) || seq != __atomic_load_n(&data->clock_seq, __ATOMIC_RELAXED));
+    
+    data->capture_time_valid = seq != 0 && self->sample_rate > 0;
+    if (data->capture_time_valid) {
+        int64_t offset = (int64_t)(data->frames_read - frames) * 1000000 / (int64_t)self->sample_rate;
+        data->capture_time_us = (uint64_t)((int64_t)us + offset);
+    }
+}
+
+/**
+ * Take `frame_size` frames from record_ring if the callback has produced them
+ */
+static bool portaudio_mac_take_record(AudioInterface* self, PortAudioMacData* data, short* buffer,
+                                      size_t frame_size) {
+    size_t samples_needed = frame_size * self->channels;
+    if (audio_ring_buffer_available_read(data->record_ring) < samples_needed) {
+        return false;
+    }
+    portaudio_mac_stamp_capture(self, data);
+    audio_ring_buffer_read_all(data->record_ring, buffer, samples_needed);
+    data->frames_read += frame_size;
+    return true;
+}
+
 static int portaudio_mac_read(AudioInterface* self, short* buffer, size_t frame_size) {
     if (!self || !self->impl_data || !buffer) {
         LOG_ERROR("Invalid parameters for read");
@@ -291,37 +575,54 @@ static int portaudio_mac_read(AudioInterface* self, short* buffer, size_t frame_
     
     PortAudioMacData* data = (PortAudioMacData*)self->impl_data;
     size_t samples_needed = frame_size * self->channels;
+    if (!data->record_ring || samples_needed > audio_ring_buffer_capacity(data->record_ring)) {
+        return -1;
+    }
     
-    pthread_mutex_lock(&data->record_mutex);
-    
-    size_t available_data = (data->record_write_pos - data->record_read_pos + data->record_buffer_size) % data->record_buffer_size;
-    
-    if (available_data < samples_needed) {
-        // Wait for more data
-        struct timespec timeout;
-        clock_gettime(CLOCK_REALTIME, &timeout);
-        timeout.tv_sec += 1; // 1 second timeout
-        
-        int result = pthread_cond_timedwait(&data->record_cond, &data->record_mutex, &timeout);
-        if (result != 0) {
-            pthread_mutex_unlock(&data->record_mutex);
+    // Wait up to 1 second for the record callback to produce enough samples
+    int period_ms = portaudio_mac_period_ms(self);
+    for (int waited_ms = 0; ; waited_ms += period_ms) {
+        if (portaudio_mac_take_record(self, data, buffer, frame_size)) {
+            return 0; // Success
+        }
+        if (waited_ms >= 1000) {
             return -1;
         }
-        
-        available_data = (data->record_write_pos - data->record_read_pos + data->record_buffer_size) % data->record_buffer_size;
+        pthread_mutex_lock(&data->record_mutex);
+        portaudio_mac_timed_wait(&data->record_cond, &data->record_mutex, period_ms);
+        pthread_mutex_unlock(&data->record_mutex);
+    }
+}
+
+static int portaudio_mac_read_timed(AudioInterface* self, short* buffer, size_t frame_size, uint32_t timeout_us,
+                                    uint64_t* time_us) {
+    if (!self || !self->impl_data || !buffer) {
+        LOG_ERROR("Invalid parameters for read");
+        return -1;
     }
     
-    if (available_data >= samples_needed) {
-        for (size_t i = 0; i < samples_needed; i++) {
-            buffer[i] = data->record_buffer[data->record_read_pos];
-            data->record_read_pos = (data->record_read_pos + 1) % data->record_buffer_size;
-        }
-        pthread_mutex_unlock(&data->record_mutex);
-        return 0; // Success
+    PortAudioMacData* data = (PortAudioMacData*)self->impl_data;
+    size_t samples_needed = frame_size * self->channels;
+    if (!self->is_recording || !data->record_ring ||
+        samples_needed > audio_ring_buffer_capacity(data->record_ring)) {
+        return -1;
     }
     
-    pthread_mutex_unlock(&data->record_mutex);
-    return -1;
+    // Every written period signals once; stale counts from periods that
+    // read() consumed only cost a re-check
+    dispatch_time_t deadline = dispatch_time(DISPATCH_TIME_NOW, (int64_t)timeout_us * (int64_t)NSEC_PER_USEC);
+    while (!portaudio_mac_take_record(self, data, buffer, frame_size)) {
+        if (dispatch_semaphore_wait(data->record_sem, deadline) != 0) {
+            if (!portaudio_mac_take_record(self, data, buffer, frame_size)) {
+                return AUDIO_READ_TIMEOUT;
+            }
+            break;
+        }
+    }
+    if (time_us) {
+        *time_us = data->capture_time_valid ? data->capture_time_us : 0;
+    }
+    return 0;
 }
 
 static int portaudio_mac_write(AudioInterface* self, short* buffer, size_t frame_size) {
@@ -333,22 +634,116 @@ static int portaudio_mac_write(AudioInterface* self, short* buffer, size_t frame
     PortAudioMacData* data = (PortAudioMacData*)self->impl_data;
     size_t samples_to_write = frame_size * self->channels;
     
-    pthread_mutex_lock(&data->play_mutex);
-    
-    size_t available_space = data->play_buffer_size - 
-                            ((data->play_write_pos - data->play_read_pos + data->play_buffer_size) % data->play_buffer_size);
+    if (!self->is_playing || !data->play_ring ||
+        samples_to_write > audio_ring_buffer_capacity(data->play_ring)) {
+        return -1;
+    }
     
-    if (available_space >= samples_to_write) {
-        for (size_t i = 0; i < samples_to_write; i++) {
-            data->play_buffer[data->play_write_pos] = buffer[i];
-            data->play_write_pos = (data->play_write_pos + 1) % data->play_buffer_size;
+    // Block until the output callback has drained enough samples, so the
+    // caller is paced by the device instead of sleeping for a fixed time
+    int period_ms = portaudio_mac_period_ms(self);
+    for (int waited_ms = 0; ; waited_ms += period_ms) {
+        if (audio_ring_buffer_available_write(data->play_ring) >= samples_to_write) {
+            audio_ring_buffer_write_all(data->play_ring, buffer, samples_to_write);
+            return 0; // Success
         }
+        if (waited_ms >= 1000) {
+            return -1;
+        }
+        pthread_mutex_lock(&data->play_mutex);
+        portaudio_mac_timed_wait(&data->play_cond, &data->play_mutex, period_ms);
         pthread_mutex_unlock(&data->play_mutex);
-        return 0; // Success
+    }
+}
+
+static int portaudio_mac_get_capture_time(AudioInterface* self, uint64_t* time_us) {
+    if (!self || !self->impl_data || !time_us) {
+        return -1;
+    }
+    PortAudioMacData* data = (PortAudioMacData*)self->impl_data;
+    if (!data->capture_time_valid) {
+        return -1;
+    }
+    *time_us = data->capture_time_us;
+    return 0;
+}
+
+/**
+ * Output delay: codec-rate PCM still in play_ring and the resampler stage,
+ * the resampler's group delay and the latency PortAudio reports for the
+ * output stream (device buffer plus the hardware path)
+ */
+static int portaudio_mac_get_play_delay(AudioInterface* self, uint32_t* delay_us) {
+    if (!self || !self->impl_data || !delay_us || self->sample_rate == 0 || self->channels <= 0) {
+        return -1;
+    }
+    PortAudioMacData* data = (PortAudioMacData*)self->impl_data;
+    if (!data->output_stream || !data->play_ring) {
+        return -1;
+    }
+    const PaStreamInfo* info = Pa_GetStreamInfo(data->output_stream);
+    if (!info) {
+        return -1;
     }
     
-    pthread_mutex_unlock(&data->play_mutex);
-    return -1;
+    uint64_t frames = audio_ring_buffer_available_read(data->play_ring) / (size_t)self->channels +
+                      __atomic_load_n(&data->play_stage_length, __ATOMIC_RELAXED);
+    uint64_t us = frames * 1000000u / self->sample_rate + (uint64_t)(info->outputLatency * 1e6);
+    if (data->play_resampler) {
+        us += audio_resampler_latency_us(data->play_resampler);
+    }
+    *delay_us = us > UINT32_MAX ? UINT32_MAX : (uint32_t)us;
+    return 0;
+}
+
+static int portaudio_mac_set_pull_source(AudioInterface* self, audio_pull_callback_t callback, void* user_data) {
+    if (!self || !self->impl_data) {
+        LOG_ERROR("Invalid audio interface");
+        return -1;
+    }
+    
+    PortAudioMacData* data = (PortAudioMacData*)self->impl_data;
+    
+    // Publish user_data before the callback that uses it
+    __atomic_store_n(&data->pull_callback, NULL, __ATOMIC_RELEASE);
+    data->pull_user_data = user_data;
+    __atomic_store_n(&data->pull_callback, callback, __ATOMIC_RELEASE);
+    
+    // Drop anything queued through write() so the two modes never interleave
+    __atomic_store_n(&data->play_flush, true, __ATOMIC_RELEASE);
+    
+    LOG_INFO("Playback switched to %s mode", callback ? "pull" : "push");
+    return 0;
+}
+
+static int portaudio_mac_flush_play(AudioInterface* self) {
+    if (!self || !self->impl_data) {
+        LOG_ERROR("Invalid audio interface");
+        return -1;
+    }
+    
+    // play_ring is single-consumer: the play callback performs the discard
+    PortAudioMacData* data = (PortAudioMacData*)self->impl_data;
+    __atomic_store_n(&data->play_flush, true, __ATOMIC_RELEASE);
+    return 0;
+}
+
+bool portaudio_mac_get_ring_stats(AudioInterface* self,
+                                  audio_ring_buffer_stats_t* record_stats,
+                                  audio_ring_buffer_stats_t* play_stats) {
+    if (!self || !self->impl_data) {
+        return false;
+    }
+    
+    PortAudioMacData* data = (PortAudioMacData*)self->impl_data;
+    bool ok = true;
+    if (record_stats) {
+        ok = audio_ring_buffer_get_stats(data->record_ring, record_stats) && ok;
+    }
+    if (play_stats) {
+        ok = audio_ring_buffer_get_stats(data->play_ring, play_stats) && ok;
+    }
+    return ok;
 }
 
 static int portaudio_mac_record(AudioInterface* self) {
@@ -383,14 +778,14 @@ static int portaudio_mac_record(AudioInterface* self) {
         return -1;
     }
     
-    LOG_INFO("Opening input stream: device=%s, rate=%u, channels=%d, frame_size=%d", 
-             deviceInfo->name, self->sample_rate, self->channels, self->frame_size);
+    LOG_INFO("Opening input stream: device=%s, rate=%u (stream %u), channels=%d, frame_size=%lu", 
+             deviceInfo->name, data->input_rate, self->sample_rate, self->channels, data->input_period);
     
     PaError err = Pa_OpenStream(&data->input_stream,
                                &data->input_params,
                                NULL, // no output
-                               self->sample_rate,
-                               self->frame_size,
+                               data->input_rate,
+                               data->input_period,
                                paClipOff,
                                _portaudio_record_callback,
                                self);
@@ -444,14 +839,14 @@ static int portaudio_mac_init_play(AudioInterface* self) {
         return -1;
     }
     
-    LOG_INFO("Opening output stream: device=%s, rate=%u, channels=%d, frame_size=%d", 
-             deviceInfo->name, self->sample_rate, self->channels, self->frame_size);
+    LOG_INFO("Opening output stream: device=%s, rate=%u (stream %u), channels=%d, frame_size=%lu", 
+             deviceInfo->name, data->output_rate, self->sample_rate, self->channels, data->output_period);
     
     PaError err = Pa_OpenStream(&data->output_stream,
                                NULL, // no input
                                &data->output_params,
-                               self->sample_rate,
-                               self->frame_size,
+                               data->output_rate,
+                               data->output_period,
                                paClipOff,
                                _portaudio_play_callback,
                                self);
@@ -485,13 +880,8 @@ static bool portaudio_mac_is_play_buffer_empty(AudioInterface* self) {
         return true;
     }
     
-    // 检查播放缓冲区是否有数据
-    pthread_mutex_lock(&data->play_mutex);
-    size_t available_data = (data->play_write_pos - data->play_read_pos + data->play_buffer_size) % data->play_buffer_size;
-    pthread_mutex_unlock(&data->play_mutex);
-    
     // 如果缓冲区中没有数据，认为为空
-    return (available_data == 0);
+    return audio_ring_buffer_available_read(data->play_ring) == 0;
 }
 
 static int portaudio_mac_destroy(AudioInterface* self) {
@@ -512,22 +902,21 @@ static int portaudio_mac_destroy(AudioInterface* self) {
         Pa_CloseStream(data->output_stream);
     }
     
-    // Clean up buffers
-    if (data->record_buffer) {
-        free(data->record_buffer);
-    }
-    
-    if (data->play_buffer) {
-        free(data->play_buffer);
-    }
+    // Clean up buffers (streams are closed, callbacks no longer run)
+    audio_ring_buffer_destroy(data->record_ring);
+    audio_ring_buffer_destroy(data->play_ring);
+    portaudio_mac_free_resamplers(data);
     
     // Clean up synchronization objects
     pthread_mutex_destroy(&data->record_mutex);
     pthread_mutex_destroy(&data->play_mutex);
     pthread_cond_destroy(&data->record_cond);
     pthread_cond_destroy(&data->play_cond);
+    if (data->record_sem) {
+        dispatch_release(data->record_sem);
+    }
     
-    free(data);
+    LINX_FREE(data);
     self->impl_data = NULL;
     
     if (self->is_initialized) {
@@ -2,6 +2,7 @@
 #define PORTAUDIO_MAC_H
 
 #include "audio/audio_interface.h"
+#include "audio/audio_ring_buffer.h"
 // 使用相对路径或系统路径包含PortAudio
 #ifdef __APPLE__
     #include <portaudio.h>
@@ -18,6 +19,17 @@ extern "C" {
  */
 AudioInterface* portaudio_mac_create(void);
 
+/**
+ * Get record/play ring statistics (overruns mean dropped mic samples,
+ * underruns mean the device played silence)
+ * @param record_stats Record ring statistics (may be NULL)
+ * @param play_stats Play ring statistics (may be NULL)
+ * @return true on success
+ */
+bool portaudio_mac_get_ring_stats(AudioInterface* self,
+                                  audio_ring_buffer_stats_t* record_stats,
+                                  audio_ring_buffer_stats_t* play_stats);
+
 
 #ifdef __cplusplus
 }
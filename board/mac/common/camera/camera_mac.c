@@ -1,24 +1,30 @@
 #include "camera_mac.h"
+#include "camera/camera_scale.h"
 #include "log/linx_log.h"
+#include "log/linx_alloc.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <unistd.h>
 #include <sys/time.h>
 
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_BOARD);
+
 // Mac-specific includes - using C-compatible headers only
 #ifdef __APPLE__
 #include <CoreFoundation/CoreFoundation.h>
 #include <CoreGraphics/CoreGraphics.h>
 #include <ImageIO/ImageIO.h>
-// Note: AVFoundation and Foundation are Objective-C frameworks
-// For C compatibility, we'll use stub implementations
+// AVFoundation capture and VideoToolbox encoding live in camera_mac_avf.m
 #endif
 
 #define TAG "MacCamera"
 #define MAX_FRAME_SIZE (1920 * 1080 * 4)  // Max frame size for 1080p RGBA
 #define DEFAULT_JPEG_QUALITY 0.8f
 #define HTTP_TIMEOUT_MS 10000  // 10 seconds timeout
+#define FRAME_WAIT_MS 2000     // First frame after start-up
+#define EXPLAIN_IDLE_POLL_MS 1000    // Idle connection service interval
+#define EXPLAIN_KEEPALIVE_MS 30000   // Close the service connection after this long unused
 
 // HTTP request context structure
 typedef struct {
@@ -27,6 +33,7 @@ typedef struct {
     size_t response_len;
     bool request_done;
     bool request_success;
+    bool connection_closed;   // Closed before a response arrived
     int status_code;
 } HttpRequestContext;
 
@@ -38,6 +45,11 @@ static int mac_camera_set_h_mirror(CameraInterface* self, bool enabled);
 static int mac_camera_set_v_flip(CameraInterface* self, bool enabled);
 static int mac_camera_set_explain_url(CameraInterface* self, const char* url, const char* token);
 static int mac_camera_explain(CameraInterface* self, const char* question, char* response, size_t response_size);
+static int mac_camera_explain_async(CameraInterface* self, const char* question,
+                                    camera_explain_callback_t callback, void* user_data,
+                                    uint32_t* request_id);
+static int mac_camera_cancel_explain(CameraInterface* self, uint32_t request_id);
+static int mac_camera_preview(CameraInterface* self, int timeout_ms, camera_preview_sink_t sink, void* user_data);
 static int mac_camera_release_frame(CameraInterface* self, CameraFrameBuffer* frame);
 static int mac_camera_destroy(CameraInterface* self);
 
@@ -51,7 +63,10 @@ static const CameraInterfaceVTable mac_camera_vtable = {
     .set_explain_url = mac_camera_set_explain_url,
     .explain = mac_camera_explain,
     .release_frame = mac_camera_release_frame,
-    .destroy = mac_camera_destroy
+    .destroy = mac_camera_destroy,
+    .explain_async = mac_camera_explain_async,
+    .cancel_explain = mac_camera_cancel_explain,
+    .preview = mac_camera_preview
 };
 
 // Helper function to get current timestamp in milliseconds
@@ -61,16 +76,41 @@ static long long get_timestamp_ms(void) {
     return (long long)(tv.tv_sec) * 1000 + (long long)(tv.tv_usec) / 1000;
 }
 
-// HTTP event handler for mongoose
+// Absolute CLOCK_REALTIME time `ms` from now, for pthread_cond_timedwait
+static void deadline_after_ms(struct timespec* deadline, int ms) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    deadline->tv_sec = tv.tv_sec + ms / 1000;
+    deadline->tv_nsec = (long)tv.tv_usec * 1000 + (long)(ms % 1000) * 1000000L;
+    if (deadline->tv_nsec >= 1000000000L) {
+        deadline->tv_sec++;
+        deadline->tv_nsec -= 1000000000L;
+    }
+}
+
+// HTTP event handler for mongoose. fn_data is the camera; only the current
+// explain connection feeds the request in flight, late events from a
+// connection that was dropped are ignored.
 static void http_event_handler(struct mg_connection *c, int ev, void *ev_data) {
-    HttpRequestContext *ctx = (HttpRequestContext *)c->fn_data;
+    MacCameraData *data = (MacCameraData *)c->fn_data;
+    HttpRequestContext *ctx = c == data->explain_conn ? (HttpRequestContext *)data->explain_http_ctx : NULL;
     
     if (ev == MG_EV_CONNECT) {
         // Connection established
         LOG_DEBUG("HTTP connection established");
+        if (data->explain_conn_url && mg_url_is_ssl(data->explain_conn_url)) {
+            struct mg_tls_opts opts;
+            memset(&opts, 0, sizeof(opts));
+            opts.name = mg_url_host(data->explain_conn_url);
+            mg_tls_init(c, &opts);
+        }
     } else if (ev == MG_EV_HTTP_MSG) {
         // HTTP response received
         struct mg_http_message *hm = (struct mg_http_message *)ev_data;
+        if (!ctx) {
+            LOG_WARN("Ignoring HTTP response with no explain request in flight");
+            return;
+        }
         
         ctx->status_code = mg_http_status(hm);
         LOG_DEBUG("HTTP response received, status: %d", ctx->status_code);
@@ -91,31 +131,171 @@ static void http_event_handler(struct mg_connection *c, int ev, void *ev_data) {
             ctx->request_success = false;
         }
         
+        // The connection stays open for the next request
         ctx->request_done = true;
-        c->is_draining = 1;  // Close connection
     } else if (ev == MG_EV_ERROR) {
         // Connection error
         LOG_ERROR("HTTP connection error: %s", (char *)ev_data);
-        ctx->request_done = true;
-        ctx->request_success = false;
+        if (ctx) {
+            ctx->request_done = true;
+            ctx->request_success = false;
+        }
     } else if (ev == MG_EV_CLOSE) {
         // Connection closed
         LOG_DEBUG("HTTP connection closed");
-        ctx->request_done = true;
+        if (c == data->explain_conn) {
+            data->explain_conn = NULL;
+        }
+        if (ctx && !ctx->request_done) {
+            ctx->connection_closed = true;
+            ctx->request_done = true;
+        }
+    }
+}
+
+static void mac_camera_explain_free_request(MacExplainRequest* request) {
+    LINX_FREE(request->question);
+    LINX_FREE(request);
+}
+
+// True when the request in flight should be abandoned
+static bool mac_camera_explain_interrupted(MacCameraData* data) {
+    pthread_mutex_lock(&data->explain_mutex);
+    bool interrupted = data->explain_stopping || (data->explain_active && data->explain_active->cancelled);
+    pthread_mutex_unlock(&data->explain_mutex);
+    return interrupted;
+}
+
+// Drop the kept-alive connection (explain thread only)
+static void mac_camera_explain_disconnect(MacCameraData* data) {
+    if (data->explain_conn) {
+        data->explain_conn->is_closing = 1;
+        data->explain_conn = NULL;
+        mg_mgr_poll(&data->http_mgr, 0);
     }
 }
 
+// Kept-alive connection to `url`, or a new one (explain thread only)
+static struct mg_connection* mac_camera_explain_connection(MacCameraData* data, const char* url, bool* reused) {
+    struct mg_connection* c = data->explain_conn;
+    if (c && !c->is_closing && !c->is_draining &&
+        data->explain_conn_url && strcmp(data->explain_conn_url, url) == 0) {
+        *reused = true;
+        return c;
+    }
+    
+    *reused = false;
+    mac_camera_explain_disconnect(data);
+    LINX_FREE(data->explain_conn_url);
+    data->explain_conn_url = LINX_STRDUP(url);
+    if (!data->explain_conn_url) {
+        LOG_ERROR("Failed to allocate memory for explain URL");
+        return NULL;
+    }
+    data->explain_conn = mg_http_connect(&data->http_mgr, url, http_event_handler, data);
+    if (!data->explain_conn) {
+        LOG_ERROR("Failed to create HTTP connection to %s", url);
+    }
+    return data->explain_conn;
+}
+
+// Serve the idle connection so a server-side close is noticed, and give it
+// up once it has not been used for EXPLAIN_KEEPALIVE_MS
+static void mac_camera_explain_idle(MacCameraData* data) {
+    mg_mgr_poll(&data->http_mgr, 0);
+    if (data->explain_conn && get_timestamp_ms() - data->explain_conn_used_ms > EXPLAIN_KEEPALIVE_MS) {
+        LOG_DEBUG("Closing idle explain connection");
+        mac_camera_explain_disconnect(data);
+    }
+}
+
+// Explain thread: serves queued requests in order until the camera is destroyed
+static void* mac_camera_explain_thread(void* arg) {
+    MacCameraData* data = (MacCameraData*)arg;
+    char response[CAMERA_EXPLAIN_RESPONSE_SIZE];
+    
+    pthread_mutex_lock(&data->explain_mutex);
+    while (!data->explain_stopping) {
+        MacExplainRequest* request = data->explain_head;
+        if (!request) {
+            if (!data->explain_conn) {
+                pthread_cond_wait(&data->explain_cond, &data->explain_mutex);
+                continue;
+            }
+            struct timespec deadline;
+            deadline_after_ms(&deadline, EXPLAIN_IDLE_POLL_MS);
+            pthread_cond_timedwait(&data->explain_cond, &data->explain_mutex, &deadline);
+            if (!data->explain_head && !data->explain_stopping) {
+                pthread_mutex_unlock(&data->explain_mutex);
+                mac_camera_explain_idle(data);
+                pthread_mutex_lock(&data->explain_mutex);
+            }
+            continue;
+        }
+        
+        data->explain_head = request->next;
+        if (!data->explain_head) {
+            data->explain_tail = NULL;
+        }
+        data->explain_active = request;
+        pthread_mutex_unlock(&data->explain_mutex);
+        
+        response[0] = '\0';
+        int result = mac_camera_explain_internal(data, request->question, response, sizeof(response));
+        
+        pthread_mutex_lock(&data->explain_mutex);
+        data->explain_active = NULL;
+        CameraExplainStatus status = CAMERA_EXPLAIN_OK;
+        if (result != 0) {
+            status = request->cancelled ? CAMERA_EXPLAIN_CANCELLED :
+                     result == CAMERA_EXPLAIN_TIMEOUT ? CAMERA_EXPLAIN_TIMEOUT : CAMERA_EXPLAIN_FAILED;
+        }
+        pthread_mutex_unlock(&data->explain_mutex);
+        
+        request->callback(status, status == CAMERA_EXPLAIN_OK ? response : NULL, request->user_data);
+        mac_camera_explain_free_request(request);
+        pthread_mutex_lock(&data->explain_mutex);
+    }
+    
+    // Requests still queued at shutdown are cancelled
+    MacExplainRequest* pending = data->explain_head;
+    data->explain_head = NULL;
+    data->explain_tail = NULL;
+    pthread_mutex_unlock(&data->explain_mutex);
+    while (pending) {
+        MacExplainRequest* next = pending->next;
+        pending->callback(CAMERA_EXPLAIN_CANCELLED, NULL, pending->user_data);
+        mac_camera_explain_free_request(pending);
+        pending = next;
+    }
+    
+    mac_camera_explain_disconnect(data);
+    return NULL;
+}
+
+static void mac_camera_stop_explain_thread(MacCameraData* data) {
+    if (!data->explain_thread_started) {
+        return;
+    }
+    pthread_mutex_lock(&data->explain_mutex);
+    data->explain_stopping = true;
+    pthread_cond_broadcast(&data->explain_cond);
+    pthread_mutex_unlock(&data->explain_mutex);
+    pthread_join(data->explain_thread, NULL);
+    data->explain_thread_started = false;
+}
+
 CameraInterface* mac_camera_create(void) {
-    CameraInterface* interface = (CameraInterface*)malloc(sizeof(CameraInterface));
+    CameraInterface* interface = (CameraInterface*)LINX_MALLOC(sizeof(CameraInterface));
     if (!interface) {
         LOG_ERROR("Failed to allocate memory for camera interface");
         return NULL;
     }
 
-    MacCameraData* data = (MacCameraData*)malloc(sizeof(MacCameraData));
+    MacCameraData* data = (MacCameraData*)LINX_MALLOC(sizeof(MacCameraData));
     if (!data) {
         LOG_ERROR("Failed to allocate memory for Mac camera data");
-        free(interface);
+        LINX_FREE(interface);
         return NULL;
     }
 
@@ -128,6 +308,11 @@ CameraInterface* mac_camera_create(void) {
     data->h_mirror_enabled = false;
     data->v_flip_enabled = false;
     data->http_mgr_initialized = false;
+    pthread_mutex_init(&data->pool_mutex, NULL);
+    pthread_mutex_init(&data->explain_mutex, NULL);
+    pthread_cond_init(&data->explain_cond, NULL);
+    data->explain_next_id = 1;
+    data->scene_cache = camera_scene_cache_create();
     
     // Set default configuration
     data->config.width = 1280;
@@ -177,6 +362,17 @@ static int mac_camera_init(CameraInterface* self) {
     mg_mgr_init(&data->http_mgr);
     data->http_mgr_initialized = true;
 
+    // The explain thread owns http_mgr from here on
+    data->explain_stopping = false;
+    if (pthread_create(&data->explain_thread, NULL, mac_camera_explain_thread, data) != 0) {
+        LOG_ERROR("Failed to start Mac camera explain thread");
+        mg_mgr_free(&data->http_mgr);
+        data->http_mgr_initialized = false;
+        mac_camera_cleanup_hardware(data);
+        return -1;
+    }
+    data->explain_thread_started = true;
+
     data->initialized = true;
     self->is_initialized = true;
     self->config = data->config;
@@ -220,6 +416,51 @@ static int mac_camera_capture(CameraInterface* self, CameraFrameBuffer* frame) {
     return mac_camera_capture_internal(data, frame);
 }
 
+#ifdef __APPLE__
+typedef struct {
+    camera_preview_sink_t sink;
+    void* user_data;
+} MacCameraPreviewSink;
+
+static void mac_camera_preview_pixels(const uint8_t* bgra, size_t stride, int width, int height, void* user_data) {
+    MacCameraPreviewSink* target = (MacCameraPreviewSink*)user_data;
+    CameraPixels pixels = {
+        .data = bgra,
+        .stride = stride,
+        .width = width,
+        .height = height,
+        .format = CAMERA_PIXEL_BGRA32
+    };
+    target->sink(&pixels, target->user_data);
+}
+#endif
+
+static int mac_camera_preview(CameraInterface* self, int timeout_ms, camera_preview_sink_t sink, void* user_data) {
+    if (!self || !sink) {
+        LOG_ERROR("Invalid camera interface or preview sink");
+        return -1;
+    }
+
+    MacCameraData* data = (MacCameraData*)self->impl_data;
+    if (!data || !data->initialized) {
+        LOG_ERROR("Mac camera not initialized");
+        return -1;
+    }
+
+#ifdef __APPLE__
+    if (!data->avf) {
+        LOG_ERROR("Mac camera capture session not running");
+        return -1;
+    }
+    // The session already delivers BGRA: lend it straight to the sink
+    MacCameraPreviewSink target = { sink, user_data };
+    return mac_camera_avf_preview(data->avf, timeout_ms, mac_camera_preview_pixels, &target);
+#else
+    LOG_ERROR("Mac camera not supported on this platform");
+    return -1;
+#endif
+}
+
 static int mac_camera_set_h_mirror(CameraInterface* self, bool enabled) {
     if (!self) {
         LOG_ERROR("Invalid camera interface");
@@ -270,35 +511,24 @@ static int mac_camera_set_explain_url(CameraInterface* self, const char* url, co
         return -1;
     }
 
-    // Free existing URL and token
-    if (data->explain_url) {
-        free(data->explain_url);
-        data->explain_url = NULL;
-    }
-    if (data->explain_token) {
-        free(data->explain_token);
-        data->explain_token = NULL;
-    }
-
-    // Set new URL
-    data->explain_url = (char*)malloc(strlen(url) + 1);
-    if (!data->explain_url) {
-        LOG_ERROR("Failed to allocate memory for explain URL");
+    char* new_url = LINX_STRDUP(url);
+    char* new_token = token ? LINX_STRDUP(token) : NULL;
+    if (!new_url || (token && !new_token)) {
+        LOG_ERROR("Failed to allocate memory for explain URL or token");
+        LINX_FREE(new_url);
+        LINX_FREE(new_token);
         return -1;
     }
-    strcpy(data->explain_url, url);
 
-    // Set new token if provided
-    if (token) {
-        data->explain_token = (char*)malloc(strlen(token) + 1);
-        if (!data->explain_token) {
-            LOG_ERROR("Failed to allocate memory for explain token");
-            free(data->explain_url);
-            data->explain_url = NULL;
-            return -1;
-        }
-        strcpy(data->explain_token, token);
-    }
+    // Replace URL and token; a request in flight keeps its own copies
+    pthread_mutex_lock(&data->explain_mutex);
+    LINX_FREE(data->explain_url);
+    LINX_FREE(data->explain_token);
+    data->explain_url = new_url;
+    data->explain_token = new_token;
+    pthread_mutex_unlock(&data->explain_mutex);
+    // Answers from the previous service do not count for the new one
+    camera_scene_cache_clear(data->scene_cache);
 
     LOG_INFO("Mac camera explain URL set successfully");
     return 0;
@@ -316,12 +546,100 @@ static int mac_camera_explain(CameraInterface* self, const char* question, char*
         return -1;
     }
 
+    // Served by the explain thread like any other request
+    return camera_interface_explain_timed(self, question, response, response_size, 0) == 0 ? 0 : -1;
+}
+
+static int mac_camera_explain_async(CameraInterface* self, const char* question,
+                                    camera_explain_callback_t callback, void* user_data,
+                                    uint32_t* request_id) {
+    if (!self || !question || !callback) {
+        LOG_ERROR("Invalid camera interface, question, or callback");
+        return -1;
+    }
+
+    MacCameraData* data = (MacCameraData*)self->impl_data;
+    if (!data || !data->explain_thread_started) {
+        LOG_ERROR("Mac camera not initialized");
+        return -1;
+    }
+
+    MacExplainRequest* request = (MacExplainRequest*)LINX_CALLOC(1, sizeof(MacExplainRequest));
+    if (!request || !(request->question = LINX_STRDUP(question))) {
+        LOG_ERROR("Failed to allocate explain request");
+        LINX_FREE(request);
+        return -1;
+    }
+    request->callback = callback;
+    request->user_data = user_data;
+
+    pthread_mutex_lock(&data->explain_mutex);
     if (!data->explain_url) {
+        pthread_mutex_unlock(&data->explain_mutex);
         LOG_ERROR("Explain URL not set");
+        mac_camera_explain_free_request(request);
         return -1;
     }
+    uint32_t id = data->explain_next_id++;
+    if (data->explain_next_id == 0) {
+        data->explain_next_id = 1;
+    }
+    request->id = id;
+    if (data->explain_tail) {
+        data->explain_tail->next = request;
+    } else {
+        data->explain_head = request;
+    }
+    data->explain_tail = request;
+    pthread_cond_signal(&data->explain_cond);
+    pthread_mutex_unlock(&data->explain_mutex);
 
-    return mac_camera_explain_internal(data, question, response, response_size);
+    if (request_id) {
+        *request_id = id;
+    }
+    return 0;
+}
+
+static int mac_camera_cancel_explain(CameraInterface* self, uint32_t request_id) {
+    if (!self || !self->impl_data) {
+        LOG_ERROR("Invalid camera interface");
+        return -1;
+    }
+
+    MacCameraData* data = (MacCameraData*)self->impl_data;
+    MacExplainRequest* removed = NULL;
+    int result = -1;
+
+    pthread_mutex_lock(&data->explain_mutex);
+    if (data->explain_active && data->explain_active->id == request_id) {
+        // The explain thread abandons the request and reports it
+        data->explain_active->cancelled = true;
+        result = 0;
+    } else {
+        MacExplainRequest* prev = NULL;
+        for (MacExplainRequest* r = data->explain_head; r; prev = r, r = r->next) {
+            if (r->id == request_id) {
+                if (prev) {
+                    prev->next = r->next;
+                } else {
+                    data->explain_head = r->next;
+                }
+                if (data->explain_tail == r) {
+                    data->explain_tail = prev;
+                }
+                removed = r;
+                result = 0;
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&data->explain_mutex);
+
+    if (removed) {
+        removed->callback(CAMERA_EXPLAIN_CANCELLED, NULL, removed->user_data);
+        mac_camera_explain_free_request(removed);
+    }
+    return result;
 }
 
 static int mac_camera_release_frame(CameraInterface* self, CameraFrameBuffer* frame) {
@@ -331,8 +649,15 @@ static int mac_camera_release_frame(CameraInterface* self, CameraFrameBuffer* fr
     }
 
     if (frame->data) {
-        free(frame->data);
+        // Pooled frames drop their reference (the slot is reused once shared
+        // references are gone too); anything else was malloc'd
+        if (frame->buffer) {
+            mcp_buffer_release(frame->buffer);
+        } else {
+            LINX_FREE(frame->data);
+        }
         frame->data = NULL;
+        frame->buffer = NULL;
         frame->size = 0;
         frame->width = 0;
         frame->height = 0;
@@ -350,6 +675,9 @@ static int mac_camera_destroy(CameraInterface* self) {
 
     MacCameraData* data = (MacCameraData*)self->impl_data;
     if (data) {
+        // The explain thread uses the capture session and http_mgr; stop it first
+        mac_camera_stop_explain_thread(data);
+
         // Cleanup hardware resources
         mac_camera_cleanup_hardware(data);
 
@@ -361,19 +689,29 @@ static int mac_camera_destroy(CameraInterface* self) {
 
         // Free allocated memory
         if (data->explain_url) {
-            free(data->explain_url);
+            LINX_FREE(data->explain_url);
         }
         if (data->explain_token) {
-            free(data->explain_token);
+            LINX_FREE(data->explain_token);
         }
-        if (data->current_frame_data) {
-            free(data->current_frame_data);
+        LINX_FREE(data->explain_conn_url);
+        camera_scene_cache_destroy(data->scene_cache);
+        pthread_mutex_destroy(&data->explain_mutex);
+        pthread_cond_destroy(&data->explain_cond);
+        mcp_buffer_release(data->last_frame);
+        data->last_frame = NULL;
+        for (int i = 0; i < MAC_CAMERA_FRAME_POOL_SIZE; i++) {
+            if (data->frame_pool[i].in_use) {
+                LOG_WARN("Camera destroyed with frame %d still referenced", i);
+            }
+            LINX_FREE(data->frame_pool[i].buffer.data);
         }
+        pthread_mutex_destroy(&data->pool_mutex);
 
-        free(data);
+        LINX_FREE(data);
     }
 
-    free(self);
+    LINX_FREE(self);
     LOG_INFO("Mac camera destroyed successfully");
     return 0;
 }
@@ -397,14 +735,42 @@ int mac_camera_set_config_internal(MacCameraData* camera_data, const CameraConfi
         return -1;
     }
 
+    if (config->explain_quality < 0 || config->explain_quality > 100) {
+        LOG_ERROR("Invalid explain JPEG quality: %d", config->explain_quality);
+        return -1;
+    }
+
+    if (config->explain_change_threshold < 0 || config->explain_change_threshold > 255) {
+        LOG_ERROR("Invalid explain change threshold: %d", config->explain_change_threshold);
+        return -1;
+    }
+
     // Update configuration
     camera_data->config = *config;
+    
+#ifdef __APPLE__
+    if (camera_data->avf) {
+        mac_camera_avf_set_size(camera_data->avf, config->width, config->height);
+        camera_data->h_mirror_enabled = config->h_mirror;
+        camera_data->v_flip_enabled = config->v_flip;
+        mac_camera_avf_set_orientation(camera_data->avf, config->h_mirror, config->v_flip);
+    }
+#endif
 
     LOG_INFO("Mac camera configuration updated: %dx%d, quality=%d, format=%d",
              config->width, config->height, config->quality, config->format);
     return 0;
 }
 
+// Last reference to a pooled frame dropped: the slot can be captured into again
+static void mac_camera_frame_slot_release(mcp_buffer_t* buffer) {
+    MacCameraData* camera_data = (MacCameraData*)buffer->owner;
+    MacCameraFrameSlot* slot = (MacCameraFrameSlot*)buffer;   // buffer is the first member
+    pthread_mutex_lock(&camera_data->pool_mutex);
+    slot->in_use = false;
+    pthread_mutex_unlock(&camera_data->pool_mutex);
+}
+
 int mac_camera_capture_internal(MacCameraData* camera_data, CameraFrameBuffer* frame) {
     if (!camera_data || !frame) {
         LOG_ERROR("Invalid camera data or frame buffer");
@@ -419,52 +785,63 @@ int mac_camera_capture_internal(MacCameraData* camera_data, CameraFrameBuffer* f
     long long start_time = get_timestamp_ms();
 
 #ifdef __APPLE__
-    // For now, create a dummy frame for testing
-    // In a real implementation, this would capture from AVFoundation
-    int width = camera_data->config.width;
-    int height = camera_data->config.height;
-    size_t frame_size = width * height * 3; // RGB24
-
-    uint8_t* dummy_data = (uint8_t*)malloc(frame_size);
-    if (!dummy_data) {
-        LOG_ERROR("Failed to allocate memory for dummy frame");
+    if (!camera_data->avf) {
+        LOG_ERROR("Mac camera capture session not running");
         return -1;
     }
 
-    // Generate a simple test pattern
-    for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            int offset = (y * width + x) * 3;
-            dummy_data[offset] = (uint8_t)((x * 255) / width);     // Red
-            dummy_data[offset + 1] = (uint8_t)((y * 255) / height); // Green
-            dummy_data[offset + 2] = 128;                           // Blue
+    // Take a free buffer from the pool; its memory is kept across captures
+    MacCameraFrameSlot* slot = NULL;
+    pthread_mutex_lock(&camera_data->pool_mutex);
+    for (int i = 0; i < MAC_CAMERA_FRAME_POOL_SIZE; i++) {
+        if (!camera_data->frame_pool[i].in_use) {
+            slot = &camera_data->frame_pool[i];
+            slot->in_use = true;
+            break;
         }
     }
+    pthread_mutex_unlock(&camera_data->pool_mutex);
+    if (!slot) {
+        LOG_ERROR("All %d camera frames are in use; release frames after use", MAC_CAMERA_FRAME_POOL_SIZE);
+        return -1;
+    }
 
-    // Convert to JPEG if needed
-    if (camera_data->config.format == 1) { // JPEG format
-        uint8_t* jpeg_data = NULL;
-        size_t jpeg_size = 0;
-        
-        int result = mac_camera_convert_to_jpeg(camera_data, dummy_data, frame_size, &jpeg_data, &jpeg_size);
-        free(dummy_data);
-        
-        if (result != 0) {
-            LOG_ERROR("Failed to convert frame to JPEG");
-            return -1;
-        }
-        
-        frame->data = jpeg_data;
-        frame->size = jpeg_size;
-        frame->format = 1; // JPEG
-    } else {
-        frame->data = dummy_data;
-        frame->size = frame_size;
-        frame->format = 0; // RGB
+    camera_data->capture_in_progress = true;
+    int format = camera_data->config.format == 1 ? 1 : 0; // JPEG or RGB
+    size_t size = 0;
+    int width = 0;
+    int height = 0;
+    int result = mac_camera_avf_capture(camera_data->avf, format, camera_data->config.quality,
+                                        FRAME_WAIT_MS, &slot->buffer.data, &slot->capacity,
+                                        &size, &width, &height);
+    camera_data->capture_in_progress = false;
+
+    if (result != 0) {
+        pthread_mutex_lock(&camera_data->pool_mutex);
+        slot->in_use = false;
+        pthread_mutex_unlock(&camera_data->pool_mutex);
+        LOG_ERROR("Failed to capture frame from camera");
+        return -1;
     }
 
+    // The frame holds the first reference; last_frame takes another
+    mcp_buffer_init(&slot->buffer, slot->buffer.data, size, mac_camera_frame_slot_release, camera_data);
+    frame->data = slot->buffer.data;
+    frame->size = size;
+    frame->format = format;
     frame->width = width;
     frame->height = height;
+    frame->buffer = &slot->buffer;
+
+    pthread_mutex_lock(&camera_data->pool_mutex);
+    mcp_buffer_t* previous = camera_data->last_frame;
+    camera_data->last_frame = mcp_buffer_retain(&slot->buffer);
+    camera_data->current_frame_width = width;
+    camera_data->current_frame_height = height;
+    camera_data->current_frame_format = format;
+    camera_data->frame_ready = true;
+    pthread_mutex_unlock(&camera_data->pool_mutex);
+    mcp_buffer_release(previous);   // Takes pool_mutex when the slot frees up
 
 #else
     // Non-Apple platform fallback
@@ -486,6 +863,11 @@ int mac_camera_set_h_mirror_internal(MacCameraData* camera_data, bool enabled) {
     }
 
     camera_data->h_mirror_enabled = enabled;
+#ifdef __APPLE__
+    if (camera_data->avf) {
+        mac_camera_avf_set_orientation(camera_data->avf, enabled, camera_data->v_flip_enabled);
+    }
+#endif
     LOG_INFO("Mac camera horizontal mirror set to: %s", enabled ? "enabled" : "disabled");
     return 0;
 }
@@ -497,10 +879,101 @@ int mac_camera_set_v_flip_internal(MacCameraData* camera_data, bool enabled) {
     }
 
     camera_data->v_flip_enabled = enabled;
+#ifdef __APPLE__
+    if (camera_data->avf) {
+        mac_camera_avf_set_orientation(camera_data->avf, camera_data->h_mirror_enabled, enabled);
+    }
+#endif
     LOG_INFO("Mac camera vertical flip set to: %s", enabled ? "enabled" : "disabled");
     return 0;
 }
 
+#ifdef __APPLE__
+static int mac_camera_encode_rgb_jpeg(const uint8_t* rgb_data, int width, int height, int jpeg_quality,
+                                      uint8_t** jpeg_data, size_t* jpeg_size);
+#endif
+
+/**
+ * Capture -> downscale -> change check -> encode for explain (caller frees *jpeg_data)
+ *
+ * The frame is taken as RGB so it is JPEG-encoded only once, at the size
+ * and quality set by explain_max_size / explain_quality. Its scene
+ * signature goes to `scene`; when the answer cache already holds an answer
+ * to `question` for the same scene, it is copied to `response` and nothing
+ * is encoded.
+ * @return 0 if the image was encoded, 1 if answered from the cache, negative on error
+ */
+static int mac_camera_prepare_explain_image(MacCameraData* camera_data, const char* question,
+                                            char* response, size_t response_size,
+                                            camera_scene_signature_t* scene, bool* scene_valid,
+                                            uint8_t** jpeg_data, size_t* jpeg_size) {
+    *scene_valid = false;
+#ifdef __APPLE__
+    if (!camera_data->avf) {
+        return -1;
+    }
+
+    uint8_t* rgb = NULL;
+    size_t rgb_capacity = 0;
+    size_t rgb_size = 0;
+    int width = 0;
+    int height = 0;
+    if (mac_camera_avf_capture(camera_data->avf, 0, camera_data->config.quality, FRAME_WAIT_MS,
+                               &rgb, &rgb_capacity, &rgb_size, &width, &height) != 0) {
+        LINX_FREE(rgb);
+        return -1;
+    }
+
+    int max_size = camera_data->config.explain_max_size == 0 ?
+                   CAMERA_EXPLAIN_DEFAULT_MAX_SIZE : camera_data->config.explain_max_size;
+    int quality = camera_data->config.explain_quality > 0 ?
+                  camera_data->config.explain_quality : camera_data->config.quality;
+
+    int out_width = width;
+    int out_height = height;
+    const uint8_t* pixels = rgb;
+    uint8_t* scaled = NULL;
+    if (camera_scale_fit(width, height, max_size, &out_width, &out_height)) {
+        scaled = (uint8_t*)LINX_MALLOC((size_t)out_width * out_height * 3);
+        if (!scaled || camera_scale_rgb24(rgb, width, height, (size_t)width * 3,
+                                          scaled, out_width, out_height, (size_t)out_width * 3) != 0) {
+            LOG_ERROR("Failed to downscale explain image");
+            LINX_FREE(scaled);
+            LINX_FREE(rgb);
+            return -1;
+        }
+        pixels = scaled;
+    }
+
+    int cache_ms = camera_data->config.explain_cache_ms == 0 ?
+                   CAMERA_EXPLAIN_DEFAULT_CACHE_MS : camera_data->config.explain_cache_ms;
+    unsigned int threshold = camera_data->config.explain_change_threshold > 0 ?
+                             (unsigned int)camera_data->config.explain_change_threshold :
+                             CAMERA_EXPLAIN_DEFAULT_CHANGE_THRESHOLD;
+    if (cache_ms > 0 && camera_data->scene_cache &&
+        camera_scene_signature_rgb24(pixels, out_width, out_height, (size_t)out_width * 3, scene) == 0) {
+        *scene_valid = true;
+        if (camera_scene_cache_lookup(camera_data->scene_cache, scene, question, cache_ms, threshold,
+                                      response, response_size)) {
+            LINX_FREE(scaled);
+            LINX_FREE(rgb);
+            return 1;
+        }
+    }
+
+    int result = mac_camera_encode_rgb_jpeg(pixels, out_width, out_height, quality, jpeg_data, jpeg_size);
+    LINX_FREE(scaled);
+    LINX_FREE(rgb);
+    if (result == 0) {
+        LOG_INFO("Explain image %dx%d -> %dx%d, quality %d, %zu bytes",
+                 width, height, out_width, out_height, quality, *jpeg_size);
+    }
+    return result;
+#else
+    return -1;
+#endif
+}
+
 int mac_camera_explain_internal(MacCameraData* camera_data, const char* question, 
                                 char* response, size_t response_size) {
     if (!camera_data || !question || !response || response_size == 0) {
@@ -508,45 +981,76 @@ int mac_camera_explain_internal(MacCameraData* camera_data, const char* question
         return -1;
     }
 
-    if (!camera_data->current_frame_data || camera_data->current_frame_size == 0) {
-        LOG_ERROR("No current frame available for explanation");
-        return -1;
-    }
-
-    // Convert current frame to JPEG if needed
+    // Fresh capture, downscaled and re-encoded for upload; fall back to the
+    // last captured frame if the pipeline is unavailable
     uint8_t* jpeg_data = NULL;
     size_t jpeg_size = 0;
-    bool need_free_jpeg = false;
 
-    if (camera_data->current_frame_format == 1) { // Already JPEG
-        jpeg_data = camera_data->current_frame_data;
-        jpeg_size = camera_data->current_frame_size;
-    } else {
-        // Convert to JPEG
-        int result = mac_camera_convert_to_jpeg(camera_data, 
-                                               camera_data->current_frame_data, 
-                                               camera_data->current_frame_size,
+    mcp_buffer_t* last_frame = NULL;
+    camera_scene_signature_t scene;
+    bool scene_valid = false;
+
+    int prepared = mac_camera_prepare_explain_image(camera_data, question, response, response_size,
+                                                    &scene, &scene_valid, &jpeg_data, &jpeg_size);
+    if (prepared == 1) {
+        return 0;
+    }
+    if (prepared != 0) {
+        int result = -1;
+        pthread_mutex_lock(&camera_data->pool_mutex);
+        if (!camera_data->last_frame) {
+            LOG_ERROR("No current frame available for explanation");
+        } else if (camera_data->current_frame_format == 1) { // Already JPEG, send it in place
+            last_frame = mcp_buffer_retain(camera_data->last_frame);
+            jpeg_data = last_frame->data;
+            jpeg_size = last_frame->size;
+            result = 0;
+        } else {
+            // Convert to JPEG
+            result = mac_camera_convert_to_jpeg(camera_data, 
+                                               camera_data->last_frame->data, 
+                                               camera_data->last_frame->size,
                                                &jpeg_data, &jpeg_size);
+            if (result != 0) {
+                LOG_ERROR("Failed to convert frame to JPEG for explanation");
+            }
+        }
+        pthread_mutex_unlock(&camera_data->pool_mutex);
         if (result != 0) {
-            LOG_ERROR("Failed to convert frame to JPEG for explanation");
             return -1;
         }
-        need_free_jpeg = true;
     }
 
+    // The URL and token may be replaced while the request is in flight
+    pthread_mutex_lock(&camera_data->explain_mutex);
+    char* url = camera_data->explain_url ? LINX_STRDUP(camera_data->explain_url) : NULL;
+    char* token = camera_data->explain_token ? LINX_STRDUP(camera_data->explain_token) : NULL;
+    pthread_mutex_unlock(&camera_data->explain_mutex);
+
     // Send explain request
-    int result = mac_camera_send_explain_request(camera_data, camera_data->explain_url, 
-                                                camera_data->explain_token,
+    int result = CAMERA_EXPLAIN_FAILED;
+    if (url) {
+        result = mac_camera_send_explain_request(camera_data, url, token,
                                                 question, jpeg_data, jpeg_size,
                                                 response, response_size);
+    } else {
+        LOG_ERROR("Explain URL not set");
+    }
 
-    if (need_free_jpeg && jpeg_data) {
-        free(jpeg_data);
+    LINX_FREE(url);
+    LINX_FREE(token);
+    if (last_frame) {
+        mcp_buffer_release(last_frame);
+    } else {
+        LINX_FREE(jpeg_data);
     }
 
     if (result != 0) {
         LOG_ERROR("Failed to send explain request");
-        return -1;
+        return result;
+    }
+    if (scene_valid) {
+        camera_scene_cache_store(camera_data->scene_cache, &scene, question, response);
     }
 
     LOG_INFO("Mac camera explain completed for question: %s", question);
@@ -560,17 +1064,14 @@ int mac_camera_init_hardware(MacCameraData* camera_data) {
     }
 
 #ifdef __APPLE__
-    // Initialize AVFoundation capture session
-    // For now, this is a stub implementation
-    // In a real implementation, you would:
-    // 1. Create AVCaptureSession
-    // 2. Find and configure AVCaptureDevice
-    // 3. Create AVCaptureDeviceInput
-    // 4. Create AVCaptureVideoDataOutput
-    // 5. Set up delegate for frame capture
-    // 6. Start capture session
-
-    LOG_WARN("Mac camera hardware initialization (stub)");
+    // Start the capture session once; captures then only encode the newest frame
+    camera_data->avf = mac_camera_avf_create(camera_data->config.width, camera_data->config.height);
+    if (!camera_data->avf) {
+        LOG_ERROR("Failed to start AVFoundation capture");
+        return -1;
+    }
+    mac_camera_avf_set_orientation(camera_data->avf, camera_data->h_mirror_enabled,
+                                   camera_data->v_flip_enabled);
     return 0;
 #else
     LOG_ERROR("Mac camera hardware not supported on this platform");
@@ -584,12 +1085,77 @@ void mac_camera_cleanup_hardware(MacCameraData* camera_data) {
     }
 
 #ifdef __APPLE__
-    // Cleanup AVFoundation resources
-    // For now, this is a stub implementation
-    LOG_INFO("Mac camera hardware cleanup (stub)");
+    mac_camera_avf_destroy(camera_data->avf);
+    camera_data->avf = NULL;
+    LOG_INFO("Mac camera hardware cleaned up");
 #endif
 }
 
+#ifdef __APPLE__
+/**
+ * Encode packed RGB24 as JPEG with CoreGraphics/ImageIO (caller frees *jpeg_data)
+ */
+static int mac_camera_encode_rgb_jpeg(const uint8_t* rgb_data, int width, int height, int jpeg_quality,
+                                      uint8_t** jpeg_data, size_t* jpeg_size) {
+    CFDataRef rgb = CFDataCreateWithBytesNoCopy(kCFAllocatorDefault, rgb_data, (CFIndex)((size_t)width * height * 3), kCFAllocatorNull);
+    CGDataProviderRef provider = rgb ? CGDataProviderCreateWithCFData(rgb) : NULL;
+    CGColorSpaceRef color_space = CGColorSpaceCreateDeviceRGB();
+    CGImageRef image = provider ? CGImageCreate(width, height, 8, 24, (size_t)width * 3, color_space,
+                                                kCGBitmapByteOrderDefault | kCGImageAlphaNone,
+                                                provider, NULL, false, kCGRenderingIntentDefault) : NULL;
+    CFMutableDataRef jpeg = CFDataCreateMutable(kCFAllocatorDefault, 0);
+    CGImageDestinationRef destination = (image && jpeg) ?
+        CGImageDestinationCreateWithData(jpeg, CFSTR("public.jpeg"), 1, NULL) : NULL;
+
+    bool ok = false;
+    if (destination) {
+        float quality = jpeg_quality / 100.0f;
+        CFNumberRef quality_number = CFNumberCreate(kCFAllocatorDefault, kCFNumberFloatType, &quality);
+        const void* keys[] = { kCGImageDestinationLossyCompressionQuality };
+        const void* values[] = { quality_number };
+        CFDictionaryRef props = CFDictionaryCreate(kCFAllocatorDefault, keys, values, 1,
+                                                   &kCFTypeDictionaryKeyCallBacks,
+                                                   &kCFTypeDictionaryValueCallBacks);
+        CGImageDestinationAddImage(destination, image, props);
+        ok = CGImageDestinationFinalize(destination);
+        CFRelease(props);
+        CFRelease(quality_number);
+        CFRelease(destination);
+    }
+
+    *jpeg_data = NULL;
+    *jpeg_size = 0;
+    if (ok && CFDataGetLength(jpeg) > 0) {
+        *jpeg_size = (size_t)CFDataGetLength(jpeg);
+        *jpeg_data = (uint8_t*)LINX_MALLOC(*jpeg_size);
+        if (*jpeg_data) {
+            memcpy(*jpeg_data, CFDataGetBytePtr(jpeg), *jpeg_size);
+        }
+    }
+
+    if (jpeg) {
+        CFRelease(jpeg);
+    }
+    if (image) {
+        CGImageRelease(image);
+    }
+    CGColorSpaceRelease(color_space);
+    if (provider) {
+        CGDataProviderRelease(provider);
+    }
+    if (rgb) {
+        CFRelease(rgb);
+    }
+
+    if (!*jpeg_data) {
+        LOG_ERROR("Failed to encode JPEG");
+        *jpeg_size = 0;
+        return -1;
+    }
+    return 0;
+}
+#endif
+
 int mac_camera_convert_to_jpeg(MacCameraData* camera_data, 
                               const uint8_t* raw_data, size_t raw_size,
                               uint8_t** jpeg_data, size_t* jpeg_size) {
@@ -600,24 +1166,18 @@ int mac_camera_convert_to_jpeg(MacCameraData* camera_data,
 
 #ifdef __APPLE__
     // Use Core Graphics and Image I/O for JPEG conversion
-    // For now, this is a simplified stub implementation
-    
-    // Allocate memory for JPEG data (estimate 1/10 of raw size)
-    size_t estimated_jpeg_size = raw_size / 10;
-    if (estimated_jpeg_size < 1024) {
-        estimated_jpeg_size = 1024;
+    int width = camera_data->current_frame_width;
+    int height = camera_data->current_frame_height;
+    if (width <= 0 || height <= 0 || raw_size < (size_t)width * height * 3) {
+        LOG_ERROR("RGB frame size %zu does not match %dx%d", raw_size, width, height);
+        return -1;
     }
-    
-    *jpeg_data = (uint8_t*)malloc(estimated_jpeg_size);
-    if (!*jpeg_data) {
-        LOG_ERROR("Failed to allocate memory for JPEG data");
+
+    if (mac_camera_encode_rgb_jpeg(raw_data, width, height, camera_data->config.quality,
+                                   jpeg_data, jpeg_size) != 0) {
         return -1;
     }
     
-    // For testing, just copy a portion of the raw data
-    *jpeg_size = estimated_jpeg_size;
-    memset(*jpeg_data, 0xFF, *jpeg_size); // Fill with 0xFF to simulate JPEG header
-    
     LOG_INFO("Converted frame to JPEG: %zu -> %zu bytes", raw_size, *jpeg_size);
     return 0;
 #else
@@ -626,37 +1186,10 @@ int mac_camera_convert_to_jpeg(MacCameraData* camera_data,
 #endif
 }
 
-int mac_camera_send_explain_request(MacCameraData* camera_data, const char* url, const char* token,
-                                   const char* question,
-                                   const uint8_t* jpeg_data, size_t jpeg_size,
-                                   char* response, size_t response_size) {
-    if (!camera_data || !url || !question || !jpeg_data || !response || response_size == 0) {
-        LOG_ERROR("Invalid parameters for explain request");
-        return -1;
-    }
-
-    if (!camera_data->http_mgr_initialized) {
-        LOG_ERROR("HTTP manager not initialized");
-        return -1;
-    }
-
-    // Initialize HTTP request context
-    HttpRequestContext ctx = {
-        .response_buffer = response,
-        .response_size = response_size,
-        .response_len = 0,
-        .request_done = false,
-        .request_success = false,
-        .status_code = 0
-    };
-
-    // Create HTTP connection
-    struct mg_connection *c = mg_http_connect(&camera_data->http_mgr, url, http_event_handler, &ctx);
-    if (!c) {
-        LOG_ERROR("Failed to create HTTP connection to %s", url);
-        return -1;
-    }
-
+// Write the multipart explain request to `c`
+static void mac_camera_write_explain_request(struct mg_connection *c, const char* url, const char* token,
+                                             const char* question,
+                                             const uint8_t* jpeg_data, size_t jpeg_size) {
     // Generate boundary for multipart form data
     char boundary[64];
     snprintf(boundary, sizeof(boundary), "----MacCameraBoundary%lld", get_timestamp_ms());
@@ -676,6 +1209,7 @@ int mac_camera_send_explain_request(MacCameraData* camera_data, const char* url,
     // Send HTTP headers
     mg_printf(c, "POST %s HTTP/1.1\r\n", mg_url_uri(url));
     mg_printf(c, "Host: %.*s\r\n", (int)mg_url_host(url).len, mg_url_host(url).buf);
+    mg_printf(c, "Connection: keep-alive\r\n");
     mg_printf(c, "Content-Type: multipart/form-data; boundary=%s\r\n", boundary);
     mg_printf(c, "Content-Length: %zu\r\n", total_content_len);
     
@@ -699,27 +1233,82 @@ int mac_camera_send_explain_request(MacCameraData* camera_data, const char* url,
 
     // Send end boundary
     mg_printf(c, "--%s--\r\n", boundary);
+}
 
-    LOG_INFO("HTTP request sent to %s, question=%s, jpeg_size=%zu", url, question, jpeg_size);
-
-    // Wait for response with timeout
-    long long start_time = get_timestamp_ms();
-    while (!ctx.request_done && (get_timestamp_ms() - start_time) < HTTP_TIMEOUT_MS) {
-        mg_mgr_poll(&camera_data->http_mgr, 100);  // Poll every 100ms
+int mac_camera_send_explain_request(MacCameraData* camera_data, const char* url, const char* token,
+                                   const char* question,
+                                   const uint8_t* jpeg_data, size_t jpeg_size,
+                                   char* response, size_t response_size) {
+    if (!camera_data || !url || !question || !jpeg_data || !response || response_size == 0) {
+        LOG_ERROR("Invalid parameters for explain request");
+        return -1;
     }
 
-    if (!ctx.request_done) {
-        LOG_ERROR("HTTP request timeout after %d ms", HTTP_TIMEOUT_MS);
-        c->is_draining = 1;  // Force close connection
-        mg_mgr_poll(&camera_data->http_mgr, 100);  // Final poll to clean up
+    if (!camera_data->http_mgr_initialized) {
+        LOG_ERROR("HTTP manager not initialized");
         return -1;
     }
 
-    if (!ctx.request_success) {
+    for (int attempt = 0; attempt < 2; attempt++) {
+        bool reused = false;
+        struct mg_connection *c = mac_camera_explain_connection(camera_data, url, &reused);
+        if (!c) {
+            return CAMERA_EXPLAIN_FAILED;
+        }
+
+        // Initialize HTTP request context
+        HttpRequestContext ctx = {
+            .response_buffer = response,
+            .response_size = response_size,
+            .response_len = 0,
+            .request_done = false,
+            .request_success = false,
+            .connection_closed = false,
+            .status_code = 0
+        };
+        camera_data->explain_http_ctx = &ctx;
+
+        mac_camera_write_explain_request(c, url, token, question, jpeg_data, jpeg_size);
+        LOG_INFO("HTTP request sent to %s%s, question=%s, jpeg_size=%zu",
+                 url, reused ? " (kept-alive)" : "", question, jpeg_size);
+
+        // Wait for response with timeout, giving up early on cancel
+        long long start_time = get_timestamp_ms();
+        bool interrupted = false;
+        while (!ctx.request_done && (get_timestamp_ms() - start_time) < HTTP_TIMEOUT_MS) {
+            if (mac_camera_explain_interrupted(camera_data)) {
+                interrupted = true;
+                break;
+            }
+            mg_mgr_poll(&camera_data->http_mgr, 100);  // Poll every 100ms
+        }
+        camera_data->explain_http_ctx = NULL;
+        camera_data->explain_conn_used_ms = get_timestamp_ms();
+
+        if (!ctx.request_done) {
+            // A late response must not be read as the next request's
+            mac_camera_explain_disconnect(camera_data);
+            if (interrupted) {
+                LOG_INFO("Explain request abandoned");
+                return CAMERA_EXPLAIN_CANCELLED;
+            }
+            LOG_ERROR("HTTP request timeout after %d ms", HTTP_TIMEOUT_MS);
+            return CAMERA_EXPLAIN_TIMEOUT;
+        }
+
+        if (ctx.request_success) {
+            LOG_INFO("HTTP request completed successfully, response length: %zu", ctx.response_len);
+            return 0;
+        }
+
+        if (reused && ctx.connection_closed && ctx.status_code == 0) {
+            LOG_INFO("Kept-alive explain connection was closed by the server, reconnecting");
+            continue;
+        }
+
         LOG_ERROR("HTTP request failed with status: %d", ctx.status_code);
-        return -1;
+        return CAMERA_EXPLAIN_FAILED;
     }
 
-    LOG_INFO("HTTP request completed successfully, response length: %zu", ctx.response_len);
-    return 0;
-}
\ No newline at end of file
+    return CAMERA_EXPLAIN_FAILED;
+}
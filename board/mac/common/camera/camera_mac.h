@@ -2,7 +2,11 @@
 #define MAC_CAMERA_H
 
 #include "camera/camera_interface.h"
+#include "camera/camera_scene.h"
+#include "camera_mac_avf.h"
+#include "mcp/mcp_buffer.h"
 #include "mongoose.h"
+#include <pthread.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <stddef.h>
@@ -11,6 +15,33 @@
 extern "C" {
 #endif
 
+#define MAC_CAMERA_FRAME_POOL_SIZE 4   // Frames held at once, including the last frame kept for explain
+
+/**
+ * Reusable output buffer handed out by capture
+ *
+ * The slot is free again once every reference to `buffer` is released:
+ * the captured frame's own (release_frame), shared ones such as MCP image
+ * results, and last_frame's.
+ */
+typedef struct {
+    mcp_buffer_t buffer;    // data/size of the encoded frame
+    size_t capacity;
+    bool in_use;
+} MacCameraFrameSlot;
+
+/**
+ * Queued explain request; the explain thread owns it once submitted
+ */
+typedef struct MacExplainRequest {
+    uint32_t id;
+    char* question;
+    camera_explain_callback_t callback;
+    void* user_data;
+    bool cancelled;
+    struct MacExplainRequest* next;
+} MacExplainRequest;
+
 /**
  * Mac camera implementation data structure
  * This implementation uses AVFoundation framework for camera access
@@ -19,25 +50,24 @@ typedef struct {
     bool initialized;
     bool capturing;
     CameraConfig config;
-    char* explain_url;
+    char* explain_url;      // Guarded by explain_mutex
     char* explain_token;
     
-    // Mac-specific camera data
-    void* capture_session;      // AVCaptureSession*
-    void* video_device;         // AVCaptureDevice*
-    void* video_input;          // AVCaptureDeviceInput*
-    void* video_output;         // AVCaptureVideoDataOutput*
-    void* delegate;             // Custom delegate for frame capture
+    // AVFoundation capture session, running from init to destroy
+    mac_camera_avf_t* avf;
+    
+    // Encoded frames are written into pooled buffers; a slot's memory is
+    // reused by the next capture once its last reference is released
+    MacCameraFrameSlot frame_pool[MAC_CAMERA_FRAME_POOL_SIZE];
+    pthread_mutex_t pool_mutex;
     
-    // Frame buffer management
-    uint8_t* current_frame_data;
-    size_t current_frame_size;
+    // Reference to the last captured frame, used by explain (pool_mutex)
+    mcp_buffer_t* last_frame;
     int current_frame_width;
     int current_frame_height;
     int current_frame_format;
     
     // Threading and synchronization
-    void* capture_queue;        // dispatch_queue_t
     bool frame_ready;
     bool capture_in_progress;
     
@@ -45,9 +75,30 @@ typedef struct {
     bool h_mirror_enabled;
     bool v_flip_enabled;
     
-    // HTTP client using mongoose
+    // HTTP client using mongoose, owned by the explain thread
     struct mg_mgr http_mgr;
     bool http_mgr_initialized;
+    
+    // Explain thread: requests are queued and served one at a time over a
+    // kept-alive connection to the explain service
+    pthread_t explain_thread;
+    bool explain_thread_started;
+    pthread_mutex_t explain_mutex;
+    pthread_cond_t explain_cond;
+    bool explain_stopping;
+    MacExplainRequest* explain_head;
+    MacExplainRequest* explain_tail;
+    MacExplainRequest* explain_active;
+    uint32_t explain_next_id;
+    
+    // Used only by the explain thread
+    struct mg_connection* explain_conn;
+    char* explain_conn_url;
+    long long explain_conn_used_ms;
+    void* explain_http_ctx;     // Context of the request in flight
+    
+    // Recent answers by question and scene, so an unchanged scene is not uploaded again
+    camera_scene_cache_t* scene_cache;
 } MacCameraData;
 
 /**
@@ -98,6 +149,9 @@ int mac_camera_set_v_flip_internal(MacCameraData* camera_data, bool enabled);
 
 /**
  * Explain captured image using AI service
+ *
+ * Runs on the explain thread; other threads go through the explain_async
+ * and explain vtable entries.
  * @param camera_data Mac camera data structure
  * @param question Question to ask about the image
  * @param response Buffer to store response
@@ -123,7 +177,7 @@ void mac_camera_cleanup_hardware(MacCameraData* camera_data);
 /**
  * Convert captured frame to JPEG format
  * @param camera_data Mac camera data structure
- * @param raw_data Raw frame data
+ * @param raw_data Raw RGB24 frame data (current_frame_width x current_frame_height)
  * @param raw_size Size of raw data
  * @param jpeg_data Output JPEG data (caller must free)
  * @param jpeg_size Output JPEG size
@@ -135,6 +189,10 @@ int mac_camera_convert_to_jpeg(MacCameraData* camera_data,
 
 /**
  * Send HTTP request to explain service using captured image
+ *
+ * Runs on the explain thread, which owns http_mgr. The connection is kept
+ * open for the next request to the same URL; a kept-alive connection the
+ * server has closed in the meantime is replaced and the request resent once.
  * @param camera_data Mac camera data structure
  * @param url Service URL
  * @param token Authentication token
@@ -143,7 +201,7 @@ int mac_camera_convert_to_jpeg(MacCameraData* camera_data,
  * @param jpeg_size Size of JPEG data
  * @param response Buffer to store response
  * @param response_size Size of response buffer
- * @return 0 on success, negative on error
+ * @return 0 on success, negative CameraExplainStatus on error
  */
 int mac_camera_send_explain_request(MacCameraData* camera_data, const char* url, const char* token,
                                    const char* question,
@@ -0,0 +1,92 @@
+#ifndef MAC_CAMERA_AVF_H
+#define MAC_CAMERA_AVF_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * AVFoundation capture backend for the Mac camera
+ *
+ * One capture session runs from create to destroy, so a capture never pays
+ * for device start-up. The video output delivers BGRA frames from
+ * AVFoundation's own CVPixelBuffer pool; only the newest frame is retained
+ * (older ones go straight back to that pool). A capture encodes the newest
+ * frame with the VideoToolbox JPEG encoder, hardware accelerated where the
+ * machine has one, and falls back to ImageIO if no encoder session can be
+ * created. Flips the connection cannot apply are done into a small private
+ * CVPixelBufferPool, so steady-state capture does not allocate pixel memory.
+ *
+ * Implemented in Objective-C (camera_mac_avf.m); this header is plain C.
+ */
+typedef struct mac_camera_avf mac_camera_avf_t;
+
+/**
+ * Open the default video device and start capturing
+ * @param width Requested frame width (frames are scaled by the output)
+ * @param height Requested frame height
+ * @return Backend instance, or NULL if there is no camera or access is denied
+ */
+mac_camera_avf_t* mac_camera_avf_create(int width, int height);
+
+/**
+ * Stop capturing and release the device
+ */
+void mac_camera_avf_destroy(mac_camera_avf_t* avf);
+
+/**
+ * Change the delivered frame size (the session keeps running)
+ * @return 0 on success, negative on error
+ */
+int mac_camera_avf_set_size(mac_camera_avf_t* avf, int width, int height);
+
+/**
+ * Set horizontal mirror / vertical flip for subsequent captures
+ * @return 0 on success, negative on error
+ */
+int mac_camera_avf_set_orientation(mac_camera_avf_t* avf, bool h_mirror, bool v_flip);
+
+/**
+ * Encode the newest frame into a caller-owned buffer (thread-safe)
+ *
+ * @param format 1 for JPEG, 0 for packed RGB24
+ * @param quality JPEG quality (1-100)
+ * @param timeout_ms How long to wait when no frame has arrived yet
+ * @param buffer Destination (in/out); grown with realloc() when too small
+ * @param capacity Allocated size of *buffer (in/out)
+ * @param size Bytes written (output)
+ * @param width Frame width (output)
+ * @param height Frame height (output)
+ * @return 0 on success, negative on error
+ */
+int mac_camera_avf_capture(mac_camera_avf_t* avf, int format, int quality, int timeout_ms,
+                           uint8_t** buffer, size_t* capacity, size_t* size,
+                           int* width, int* height);
+
+/**
+ * Receives the newest frame's BGRA pixels, valid only during the call
+ */
+typedef void (*mac_camera_avf_pixels_t)(const uint8_t* bgra, size_t stride, int width, int height,
+                                        void* user_data);
+
+/**
+ * Lend the newest frame to `sink` in place (thread-safe)
+ *
+ * The CVPixelBuffer is locked read-only for the duration of the call: no
+ * encode and no copy, except into the flip pool when a flip is configured
+ * that the connection cannot apply.
+ *
+ * @param timeout_ms How long to wait when no frame has arrived yet
+ * @return 0 if the sink was called, negative on error
+ */
+int mac_camera_avf_preview(mac_camera_avf_t* avf, int timeout_ms, mac_camera_avf_pixels_t sink, void* user_data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MAC_CAMERA_AVF_H
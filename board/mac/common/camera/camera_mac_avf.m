@@ -0,0 +1,545 @@
+#import <AVFoundation/AVFoundation.h>
+#import <CoreMedia/CoreMedia.h>
+#import <CoreVideo/CoreVideo.h>
+#import <VideoToolbox/VideoToolbox.h>
+#import <ImageIO/ImageIO.h>
+#include "camera_mac_avf.h"
+#include "log/linx_log.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Built with -fobjc-arc (see board/mac/CMakeLists.txt)
+
+#define AVF_ACCESS_TIMEOUT_SEC  30      // Wait for the user to answer the camera permission prompt
+#define AVF_FLIP_POOL_BUFFERS   2
+
+/**
+ * Destination of one JPEG encode (VideoToolbox output callback)
+ */
+typedef struct {
+    uint8_t** buffer;
+    size_t* capacity;
+    size_t* size;
+    int status;
+} AvfJpegSink;
+
+static int avf_reserve(uint8_t** buffer, size_t* capacity, size_t needed) {
+    if (*buffer && *capacity >= needed) {
+        return 0;
+    }
+    size_t grown = needed + needed / 4;
+    uint8_t* data = (uint8_t*)realloc(*buffer, grown);
+    if (!data) {
+        LOG_ERROR("Failed to grow camera frame buffer to %zu bytes", grown);
+        return -1;
+    }
+    *buffer = data;
+    *capacity = grown;
+    return 0;
+}
+
+static void avf_jpeg_output(void* output_refcon, void* frame_refcon, OSStatus status,
+                            VTEncodeInfoFlags info_flags, CMSampleBufferRef sample_buffer) {
+    AvfJpegSink* sink = (AvfJpegSink*)frame_refcon;
+    if (status != noErr || !sample_buffer) {
+        sink->status = -1;
+        return;
+    }
+    CMBlockBufferRef block = CMSampleBufferGetDataBuffer(sample_buffer);
+    size_t length = block ? CMBlockBufferGetDataLength(block) : 0;
+    if (length == 0 || avf_reserve(sink->buffer, sink->capacity, length) != 0 ||
+        CMBlockBufferCopyDataBytes(block, 0, length, *sink->buffer) != kCMBlockBufferNoErr) {
+        sink->status = -1;
+        return;
+    }
+    *sink->size = length;
+    sink->status = 0;
+}
+
+@interface LinxCameraCapture : NSObject <AVCaptureVideoDataOutputSampleBufferDelegate> {
+@public
+    AVCaptureSession* _session;
+    AVCaptureDeviceInput* _input;
+    AVCaptureVideoDataOutput* _output;
+    dispatch_queue_t _queue;
+
+    // Newest delivered frame, guarded by _lock
+    pthread_mutex_t _lock;
+    pthread_cond_t _cond;
+    CVPixelBufferRef _latest;
+
+    int _width;
+    int _height;
+    bool _h_mirror;
+    bool _v_flip;
+    bool _connection_mirrors;       // The connection applies _h_mirror itself
+
+    // Guarded by _capture_lock: captures may come from the caller and the
+    // explain thread at once
+    pthread_mutex_t _capture_lock;
+    VTCompressionSessionRef _encoder;
+    int _encoder_width;
+    int _encoder_height;
+    int _encoder_quality;
+    int64_t _encoder_frames;
+    CVPixelBufferPoolRef _flip_pool;
+    int _flip_width;
+    int _flip_height;
+    CFMutableDataRef _jpeg_data;    // ImageIO fallback, storage reused across captures
+}
+@end
+
+@implementation LinxCameraCapture
+
+- (instancetype)init {
+    if ((self = [super init])) {
+        pthread_mutex_init(&_lock, NULL);
+        pthread_cond_init(&_cond, NULL);
+        pthread_mutex_init(&_capture_lock, NULL);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [self replaceLatest:NULL];
+    if (_encoder) {
+        VTCompressionSessionInvalidate(_encoder);
+        CFRelease(_encoder);
+    }
+    if (_flip_pool) {
+        CVPixelBufferPoolRelease(_flip_pool);
+    }
+    if (_jpeg_data) {
+        CFRelease(_jpeg_data);
+    }
+    pthread_mutex_destroy(&_lock);
+    pthread_cond_destroy(&_cond);
+    pthread_mutex_destroy(&_capture_lock);
+}
+
+- (void)replaceLatest:(CVPixelBufferRef)frame {
+    if (frame) {
+        CVPixelBufferRetain(frame);
+    }
+    pthread_mutex_lock(&_lock);
+    CVPixelBufferRef old = _latest;
+    _latest = frame;
+    if (frame) {
+        pthread_cond_broadcast(&_cond);
+    }
+    pthread_mutex_unlock(&_lock);
+    // Dropping the previous frame hands it back to AVFoundation's pool
+    if (old) {
+        CVPixelBufferRelease(old);
+    }
+}
+
+- (void)captureOutput:(AVCaptureOutput*)output
+didOutputSampleBuffer:(CMSampleBufferRef)sampleBuffer
+       fromConnection:(AVCaptureConnection*)connection {
+    CVPixelBufferRef frame = CMSampleBufferGetImageBuffer(sampleBuffer);
+    if (frame) {
+        [self replaceLatest:frame];
+    }
+}
+
+- (NSDictionary*)videoSettings {
+    return @{
+        (id)kCVPixelBufferPixelFormatTypeKey: @(kCVPixelFormatType_32BGRA),
+        (id)kCVPixelBufferWidthKey: @(_width),
+        (id)kCVPixelBufferHeightKey: @(_height),
+    };
+}
+
+- (void)applyMirror {
+    AVCaptureConnection* connection = [_output connectionWithMediaType:AVMediaTypeVideo];
+    _connection_mirrors = connection && connection.isVideoMirroringSupported;
+    if (_connection_mirrors) {
+        connection.automaticallyAdjustsVideoMirroring = NO;
+        connection.videoMirrored = _h_mirror;
+    }
+}
+
+/**
+ * Wait for and retain the newest frame (caller releases)
+ */
+- (CVPixelBufferRef)copyLatestWithTimeout:(int)timeout_ms {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&_lock);
+    while (!_latest) {
+        if (pthread_cond_timedwait(&_cond, &_lock, &deadline) != 0) {
+            break;
+        }
+    }
+    CVPixelBufferRef frame = _latest ? CVPixelBufferRetain(_latest) : NULL;
+    pthread_mutex_unlock(&_lock);
+    return frame;
+}
+
+/**
+ * Apply the flips the connection did not into a pooled buffer (caller releases)
+ */
+- (CVPixelBufferRef)copyOriented:(CVPixelBufferRef)frame {
+    bool mirror = _h_mirror && !_connection_mirrors;
+    if (!mirror && !_v_flip) {
+        return CVPixelBufferRetain(frame);
+    }
+
+    int width = (int)CVPixelBufferGetWidth(frame);
+    int height = (int)CVPixelBufferGetHeight(frame);
+    if (!_flip_pool || _flip_width != width || _flip_height != height) {
+        if (_flip_pool) {
+            CVPixelBufferPoolRelease(_flip_pool);
+            _flip_pool = NULL;
+        }
+        NSDictionary* pool_attrs = @{ (id)kCVPixelBufferPoolMinimumBufferCountKey: @(AVF_FLIP_POOL_BUFFERS) };
+        NSDictionary* buffer_attrs = @{
+            (id)kCVPixelBufferPixelFormatTypeKey: @(kCVPixelFormatType_32BGRA),
+            (id)kCVPixelBufferWidthKey: @(width),
+            (id)kCVPixelBufferHeightKey: @(height),
+            (id)kCVPixelBufferIOSurfacePropertiesKey: @{},
+        };
+        if (CVPixelBufferPoolCreate(kCFAllocatorDefault, (__bridge CFDictionaryRef)pool_attrs,
+                                    (__bridge CFDictionaryRef)buffer_attrs, &_flip_pool) != kCVReturnSuccess) {
+            LOG_ERROR("Failed to create camera flip buffer pool");
+            _flip_pool = NULL;
+            return NULL;
+        }
+        _flip_width = width;
+        _flip_height = height;
+    }
+
+    CVPixelBufferRef oriented = NULL;
+    if (CVPixelBufferPoolCreatePixelBuffer(kCFAllocatorDefault, _flip_pool, &oriented) != kCVReturnSuccess) {
+        LOG_ERROR("Camera flip buffer pool exhausted");
+        return NULL;
+    }
+
+    CVPixelBufferLockBaseAddress(frame, kCVPixelBufferLock_ReadOnly);
+    CVPixelBufferLockBaseAddress(oriented, 0);
+    const uint8_t* src = (const uint8_t*)CVPixelBufferGetBaseAddress(frame);
+    uint8_t* dst = (uint8_t*)CVPixelBufferGetBaseAddress(oriented);
+    size_t src_stride = CVPixelBufferGetBytesPerRow(frame);
+    size_t dst_stride = CVPixelBufferGetBytesPerRow(oriented);
+    for (int y = 0; y < height; y++) {
+        const uint32_t* src_row = (const uint32_t*)(src + (size_t)(_v_flip ? height - 1 - y : y) * src_stride);
+        uint32_t* dst_row = (uint32_t*)(dst + (size_t)y * dst_stride);
+        if (mirror) {
+            for (int x = 0; x < width; x++) {
+                dst_row[x] = src_row[width - 1 - x];
+            }
+        } else {
+            memcpy(dst_row, src_row, (size_t)width * 4);
+        }
+    }
+    CVPixelBufferUnlockBaseAddress(oriented, 0);
+    CVPixelBufferUnlockBaseAddress(frame, kCVPixelBufferLock_ReadOnly);
+    return oriented;
+}
+
+- (bool)prepareEncoderWidth:(int)width height:(int)height quality:(int)quality {
+    if (_encoder && (_encoder_width != width || _encoder_height != height)) {
+        VTCompressionSessionInvalidate(_encoder);
+        CFRelease(_encoder);
+        _encoder = NULL;
+    }
+    if (!_encoder) {
+        OSStatus status = VTCompressionSessionCreate(kCFAllocatorDefault, width, height,
+                                                     kCMVideoCodecType_JPEG, NULL, NULL, NULL,
+                                                     avf_jpeg_output, NULL, &_encoder);
+        if (status != noErr) {
+            LOG_WARN("VideoToolbox JPEG encoder unavailable (%d), using ImageIO", (int)status);
+            _encoder = NULL;
+            return false;
+        }
+        VTSessionSetProperty(_encoder, kVTCompressionPropertyKey_RealTime, kCFBooleanTrue);
+        _encoder_width = width;
+        _encoder_height = height;
+        _encoder_quality = 0;
+    }
+    if (_encoder_quality != quality) {
+        VTSessionSetProperty(_encoder, kVTCompressionPropertyKey_Quality,
+                             (__bridge CFTypeRef)@((double)quality / 100.0));
+        _encoder_quality = quality;
+    }
+    return true;
+}
+
+- (int)encodeJpeg:(CVPixelBufferRef)frame quality:(int)quality
+           buffer:(uint8_t**)buffer capacity:(size_t*)capacity size:(size_t*)size {
+    int width = (int)CVPixelBufferGetWidth(frame);
+    int height = (int)CVPixelBufferGetHeight(frame);
+
+    if ([self prepareEncoderWidth:width height:height quality:quality]) {
+        AvfJpegSink sink = { buffer, capacity, size, -1 };
+        OSStatus status = VTCompressionSessionEncodeFrame(_encoder, frame,
+                                                          CMTimeMake(_encoder_frames++, 30),
+                                                          kCMTimeInvalid, NULL, &sink, NULL);
+        if (status == noErr) {
+            VTCompressionSessionCompleteFrames(_encoder, kCMTimeInvalid);
+        }
+        if (status == noErr && sink.status == 0) {
+            return 0;
+        }
+        LOG_WARN("VideoToolbox JPEG encode failed (%d), using ImageIO", (int)status);
+    }
+
+    // ImageIO fallback
+    CGImageRef image = NULL;
+    if (VTCreateCGImageFromCVPixelBuffer(frame, NULL, &image) != noErr || !image) {
+        LOG_ERROR("Failed to wrap camera frame as CGImage");
+        return -1;
+    }
+    if (!_jpeg_data) {
+        _jpeg_data = CFDataCreateMutable(kCFAllocatorDefault, 0);
+    }
+    CFDataSetLength(_jpeg_data, 0);
+    CGImageDestinationRef destination = CGImageDestinationCreateWithData(_jpeg_data, CFSTR("public.jpeg"), 1, NULL);
+    bool ok = false;
+    if (destination) {
+        NSDictionary* props = @{ (id)kCGImageDestinationLossyCompressionQuality: @((double)quality / 100.0) };
+        CGImageDestinationAddImage(destination, image, (__bridge CFDictionaryRef)props);
+        ok = CGImageDestinationFinalize(destination);
+        CFRelease(destination);
+    }
+    CGImageRelease(image);
+
+    size_t length = ok ? (size_t)CFDataGetLength(_jpeg_data) : 0;
+    if (length == 0 || avf_reserve(buffer, capacity, length) != 0) {
+        LOG_ERROR("ImageIO JPEG encode failed");
+        return -1;
+    }
+    memcpy(*buffer, CFDataGetBytePtr(_jpeg_data), length);
+    *size = length;
+    return 0;
+}
+
+- (int)convertRgb:(CVPixelBufferRef)frame
+           buffer:(uint8_t**)buffer capacity:(size_t*)capacity size:(size_t*)size {
+    size_t width = CVPixelBufferGetWidth(frame);
+    size_t height = CVPixelBufferGetHeight(frame);
+    size_t needed = width * height * 3;
+    if (avf_reserve(buffer, capacity, needed) != 0) {
+        return -1;
+    }
+
+    CVPixelBufferLockBaseAddress(frame, kCVPixelBufferLock_ReadOnly);
+    const uint8_t* src = (const uint8_t*)CVPixelBufferGetBaseAddress(frame);
+    size_t stride = CVPixelBufferGetBytesPerRow(frame);
+    uint8_t* dst = *buffer;
+    for (size_t y = 0; y < height; y++) {
+        const uint8_t* bgra = src + y * stride;
+        for (size_t x = 0; x < width; x++, bgra += 4, dst += 3) {
+            dst[0] = bgra[2];
+            dst[1] = bgra[1];
+            dst[2] = bgra[0];
+        }
+    }
+    CVPixelBufferUnlockBaseAddress(frame, kCVPixelBufferLock_ReadOnly);
+    *size = needed;
+    return 0;
+}
+
+@end
+
+static bool avf_request_access(void) {
+    if (@available(macOS 10.14, *)) {
+        AVAuthorizationStatus status = [AVCaptureDevice authorizationStatusForMediaType:AVMediaTypeVideo];
+        if (status == AVAuthorizationStatusAuthorized) {
+            return true;
+        }
+        if (status != AVAuthorizationStatusNotDetermined) {
+            LOG_ERROR("Camera access denied");
+            return false;
+        }
+        __block BOOL granted = NO;
+        dispatch_semaphore_t answered = dispatch_semaphore_create(0);
+        [AVCaptureDevice requestAccessForMediaType:AVMediaTypeVideo completionHandler:^(BOOL ok) {
+            granted = ok;
+            dispatch_semaphore_signal(answered);
+        }];
+        dispatch_semaphore_wait(answered, dispatch_time(DISPATCH_TIME_NOW, (int64_t)AVF_ACCESS_TIMEOUT_SEC * NSEC_PER_SEC));
+        if (!granted) {
+            LOG_ERROR("Camera access not granted");
+        }
+        return granted;
+    }
+    return true;
+}
+
+mac_camera_avf_t* mac_camera_avf_create(int width, int height) {
+    @autoreleasepool {
+        if (width <= 0 || height <= 0 || !avf_request_access()) {
+            return NULL;
+        }
+
+        AVCaptureDevice* device = [AVCaptureDevice defaultDeviceWithMediaType:AVMediaTypeVideo];
+        if (!device) {
+            LOG_ERROR("No video capture device found");
+            return NULL;
+        }
+
+        NSError* error = nil;
+        AVCaptureDeviceInput* input = [AVCaptureDeviceInput deviceInputWithDevice:device error:&error];
+        if (!input) {
+            LOG_ERROR("Failed to open camera %s: %s", device.localizedName.UTF8String,
+                      error.localizedDescription.UTF8String);
+            return NULL;
+        }
+
+        LinxCameraCapture* capture = [[LinxCameraCapture alloc] init];
+        capture->_width = width;
+        capture->_height = height;
+        capture->_session = [[AVCaptureSession alloc] init];
+        capture->_input = input;
+        capture->_output = [[AVCaptureVideoDataOutput alloc] init];
+        capture->_output.alwaysDiscardsLateVideoFrames = YES;
+        capture->_output.videoSettings = [capture videoSettings];
+        capture->_queue = dispatch_queue_create("linx.camera.capture", DISPATCH_QUEUE_SERIAL);
+        [capture->_output setSampleBufferDelegate:capture queue:capture->_queue];
+
+        [capture->_session beginConfiguration];
+        if (![capture->_session canAddInput:input] || ![capture->_session canAddOutput:capture->_output]) {
+            [capture->_session commitConfiguration];
+            LOG_ERROR("Camera session rejected its input or output");
+            return NULL;
+        }
+        [capture->_session addInput:input];
+        [capture->_session addOutput:capture->_output];
+        [capture applyMirror];
+        [capture->_session commitConfiguration];
+        [capture->_session startRunning];
+
+        LOG_INFO("Camera %s capturing at %dx%d", device.localizedName.UTF8String, width, height);
+        return (__bridge_retained mac_camera_avf_t*)capture;
+    }
+}
+
+void mac_camera_avf_destroy(mac_camera_avf_t* avf) {
+    if (!avf) {
+        return;
+    }
+    @autoreleasepool {
+        LinxCameraCapture* capture = (__bridge_transfer LinxCameraCapture*)avf;
+        [capture->_session stopRunning];
+        [capture->_output setSampleBufferDelegate:nil queue:NULL];
+        // Let a delegate call already in flight finish before the object goes
+        dispatch_sync(capture->_queue, ^{});
+        capture = nil;
+    }
+}
+
+int mac_camera_avf_set_size(mac_camera_avf_t* avf, int width, int height) {
+    if (!avf || width <= 0 || height <= 0) {
+        return -1;
+    }
+    @autoreleasepool {
+        LinxCameraCapture* capture = (__bridge LinxCameraCapture*)avf;
+        if (capture->_width == width && capture->_height == height) {
+            return 0;
+        }
+        capture->_width = width;
+        capture->_height = height;
+        [capture->_session beginConfiguration];
+        capture->_output.videoSettings = [capture videoSettings];
+        [capture->_session commitConfiguration];
+        // The retained frame has the old size; wait for one at the new size
+        [capture replaceLatest:NULL];
+        LOG_INFO("Camera frame size set to %dx%d", width, height);
+        return 0;
+    }
+}
+
+int mac_camera_avf_set_orientation(mac_camera_avf_t* avf, bool h_mirror, bool v_flip) {
+    if (!avf) {
+        return -1;
+    }
+    @autoreleasepool {
+        LinxCameraCapture* capture = (__bridge LinxCameraCapture*)avf;
+        capture->_h_mirror = h_mirror;
+        capture->_v_flip = v_flip;
+        [capture->_session beginConfiguration];
+        [capture applyMirror];
+        [capture->_session commitConfiguration];
+        return 0;
+    }
+}
+
+int mac_camera_avf_capture(mac_camera_avf_t* avf, int format, int quality, int timeout_ms,
+                           uint8_t** buffer, size_t* capacity, size_t* size,
+                           int* width, int* height) {
+    if (!avf || !buffer || !capacity || !size) {
+        return -1;
+    }
+    @autoreleasepool {
+        LinxCameraCapture* capture = (__bridge LinxCameraCapture*)avf;
+        CVPixelBufferRef frame = [capture copyLatestWithTimeout:timeout_ms];
+        if (!frame) {
+            LOG_ERROR("No camera frame within %d ms", timeout_ms);
+            return -1;
+        }
+
+        pthread_mutex_lock(&capture->_capture_lock);
+        CVPixelBufferRef oriented = [capture copyOriented:frame];
+        CVPixelBufferRelease(frame);
+        if (!oriented) {
+            pthread_mutex_unlock(&capture->_capture_lock);
+            return -1;
+        }
+
+        int result = format == 1
+            ? [capture encodeJpeg:oriented quality:quality buffer:buffer capacity:capacity size:size]
+            : [capture convertRgb:oriented buffer:buffer capacity:capacity size:size];
+        if (result == 0) {
+            if (width) {
+                *width = (int)CVPixelBufferGetWidth(oriented);
+            }
+            if (height) {
+                *height = (int)CVPixelBufferGetHeight(oriented);
+            }
+        }
+        CVPixelBufferRelease(oriented);
+        pthread_mutex_unlock(&capture->_capture_lock);
+        return result;
+    }
+}
+
+int mac_camera_avf_preview(mac_camera_avf_t* avf, int timeout_ms, mac_camera_avf_pixels_t sink, void* user_data) {
+    if (!avf || !sink) {
+        return -1;
+    }
+    @autoreleasepool {
+        LinxCameraCapture* capture = (__bridge LinxCameraCapture*)avf;
+        CVPixelBufferRef frame = [capture copyLatestWithTimeout:timeout_ms];
+        if (!frame) {
+            LOG_ERROR("No camera frame within %d ms", timeout_ms);
+            return -1;
+        }
+
+        // The flip pool is shared with captures; encoding state is not touched
+        pthread_mutex_lock(&capture->_capture_lock);
+        CVPixelBufferRef oriented = [capture copyOriented:frame];
+        pthread_mutex_unlock(&capture->_capture_lock);
+        CVPixelBufferRelease(frame);
+        if (!oriented) {
+            return -1;
+        }
+
+        CVPixelBufferLockBaseAddress(oriented, kCVPixelBufferLock_ReadOnly);
+        sink((const uint8_t*)CVPixelBufferGetBaseAddress(oriented), CVPixelBufferGetBytesPerRow(oriented),
+             (int)CVPixelBufferGetWidth(oriented), (int)CVPixelBufferGetHeight(oriented), user_data);
+        CVPixelBufferUnlockBaseAddress(oriented, kCVPixelBufferLock_ReadOnly);
+        CVPixelBufferRelease(oriented);
+        return 0;
+    }
+}
@@ -0,0 +1,696 @@
+/**
+ * @file linx_fleet.c
+ * @brief 设备群负载发生器
+ *
+ * 一个进程内模拟大量设备：所有 LinxSdk 会话挂在同一个 linx_reactor 上，按设定速率
+ * 逐个连接，各自走 hello → listen → tts 流程。每个会话按计划循环"说话"：实时发送
+ * 预先编码好的 Opus 语音（末尾带静音，供服务端 VAD 判定说完），等待服务端回复直到
+ * tts stop，再等待下一轮。SDK 内置的 MCP 服务端负责回复 tools/list 和 tools/call。
+ *
+ * 每轮记录从说完（最后一帧发出）到 stt、tts start、第一帧下行音频和 tts stop 的时延，
+ * 定期打印汇总，结束时输出各指标的分位数，并可把每个会话的统计写成 CSV。
+ *
+ * 用法见 usage()；大规模运行前需调高文件描述符上限 (ulimit -n)。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <signal.h>
+#include <pthread.h>
+#include <math.h>
+#include <time.h>
+
+#include "linx_sdk.h"
+#include "protocols/linx_reactor.h"
+#include "codecs/opus_codec.h"
+#include "mcp/mcp_server.h"
+#include "log/linx_log.h"
+
+#define FLEET_SAMPLE_RATE     16000
+#define FLEET_CHANNELS        1
+#define FLEET_FRAME_MS        20
+#define FLEET_FRAME_SAMPLES   (FLEET_SAMPLE_RATE * FLEET_FRAME_MS / 1000)
+#define FLEET_MAX_PACKET      512
+#define FLEET_SENDER_MAX      64
+
+// ==================== 语音素材 ====================
+
+/**
+ * @brief 预先编码的语音，所有会话只读共享
+ */
+typedef struct {
+    uint8_t* data;          // 所有包首尾相连
+    size_t* offsets;        // 每包在 data 中的起点
+    uint16_t* sizes;
+    size_t count;
+} utterance_t;
+
+static bool utterance_append(utterance_t* u, const uint8_t* packet, size_t size, size_t* capacity, size_t* data_size) {
+    if (u->count == *capacity) {
+        size_t grown_capacity = *capacity ? *capacity * 2 : 256;
+        size_t* offsets = (size_t*)realloc(u->offsets, grown_capacity * sizeof(size_t));
+        if (!offsets) return false;
+        u->offsets = offsets;
+        uint16_t* sizes = (uint16_t*)realloc(u->sizes, grown_capacity * sizeof(uint16_t));
+        if (!sizes) return false;
+        u->sizes = sizes;
+        uint8_t* data = (uint8_t*)realloc(u->data, grown_capacity * FLEET_MAX_PACKET);
+        if (!data) return false;
+        u->data = data;
+        *capacity = grown_capacity;
+    }
+    memcpy(u->data + *data_size, packet, size);
+    u->offsets[u->count] = *data_size;
+    u->sizes[u->count] = (uint16_t)size;
+    *data_size += size;
+    u->count++;
+    return true;
+}
+
+/**
+ * @brief 读取语音文件：每包为 2 字节大端长度 + Opus 数据
+ */
+static bool utterance_load(utterance_t* u, const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "无法打开语音文件: %s\n", path);
+        return false;
+    }
+
+    size_t capacity = 0, data_size = 0;
+    uint8_t header[2];
+    uint8_t packet[FLEET_MAX_PACKET];
+    bool ok = true;
+    while (ok && fread(header, 1, 2, file) == 2) {
+        size_t size = ((size_t)header[0] << 8) | header[1];
+        if (size == 0 || size > sizeof(packet) || fread(packet, 1, size, file) != size) {
+            fprintf(stderr, "语音文件格式错误: %s\n", path);
+            ok = false;
+            break;
+        }
+        ok = utterance_append(u, packet, size, &capacity, &data_size);
+    }
+    fclose(file);
+    return ok && u->count > 0;
+}
+
+/**
+ * @brief 合成语音：带音节包络的谐波串，随后是静音
+ */
+static bool utterance_synthesize(utterance_t* u, int speech_ms, int silence_ms) {
+    audio_codec_t* encoder = opus_codec_create();
+    audio_format_t format;
+    audio_format_init(&format, FLEET_SAMPLE_RATE, FLEET_CHANNELS, 16, FLEET_FRAME_MS);
+    if (!encoder || audio_codec_init_encoder(encoder, &format) != CODEC_SUCCESS) {
+        audio_codec_destroy(encoder);
+        return false;
+    }
+
+    size_t capacity = 0, data_size = 0;
+    int16_t pcm[FLEET_FRAME_SAMPLES * FLEET_CHANNELS];
+    uint8_t packet[FLEET_MAX_PACKET];
+    int frames = (speech_ms + silence_ms) / FLEET_FRAME_MS;
+    double phase = 0.0;
+    bool ok = true;
+    for (int f = 0; ok && f < frames; f++) {
+        bool speech = f * FLEET_FRAME_MS < speech_ms;
+        for (int i = 0; i < FLEET_FRAME_SAMPLES; i++) {
+            double t = (double)(f * FLEET_FRAME_SAMPLES + i) / FLEET_SAMPLE_RATE;
+            double f0 = 150.0 + 30.0 * sin(2.0 * M_PI * 0.8 * t);
+            phase += 2.0 * M_PI * f0 / FLEET_SAMPLE_RATE;
+            double voiced = sin(phase) + 0.5 * sin(2.0 * phase) + 0.25 * sin(3.0 * phase);
+            double envelope = 0.5 + 0.5 * sin(2.0 * M_PI * 4.0 * t);
+            pcm[i] = speech ? (int16_t)(voiced * envelope * 6000.0) : 0;
+        }
+        size_t encoded = 0;
+        ok = audio_codec_encode(encoder, pcm, FLEET_FRAME_SAMPLES * FLEET_CHANNELS,
+                                packet, sizeof(packet), &encoded) == CODEC_SUCCESS && encoded > 0 &&
+             utterance_append(u, packet, encoded, &capacity, &data_size);
+    }
+    audio_codec_destroy(encoder);
+    return ok;
+}
+
+static void utterance_free(utterance_t* u) {
+    free(u->data);
+    free(u->offsets);
+    free(u->sizes);
+    memset(u, 0, sizeof(*u));
+}
+
+// ==================== 会话 ====================
+
+typedef enum {
+    FLEET_METRIC_CONNECT = 0,   // 发起连接 → 会话建立
+    FLEET_METRIC_STT,           // 说完 → stt
+    FLEET_METRIC_TTS_START,     // 说完 → tts start
+    FLEET_METRIC_FIRST_AUDIO,   // 说完 → 第一帧下行音频
+    FLEET_METRIC_TURN,          // 说完 → tts stop
+    FLEET_METRIC_COUNT
+} fleet_metric_t;
+
+static const char* s_metric_names[FLEET_METRIC_COUNT] = {
+    "connect", "stt", "tts_start", "first_audio", "turn"
+};
+
+typedef enum {
+    SESSION_CONNECTING,     // 等待会话建立
+    SESSION_IDLE,           // 等待下一轮
+    SESSION_SPEAKING,       // 正在发送语音
+    SESSION_WAITING         // 等待服务端回复完成
+} session_phase_t;
+
+typedef struct {
+    int index;
+    LinxSdk* sdk;
+    pthread_mutex_t mutex;
+
+    // 由 mutex 保护：事件回调（reactor 线程）和发送线程都会访问
+    session_phase_t phase;
+    uint64_t connect_us;
+    uint64_t next_turn_us;      // IDLE: 开始说话的时刻
+    uint64_t spoke_us;          // WAITING: 最后一帧发出的时刻
+    size_t frame;               // SPEAKING: 下一帧序号
+    uint64_t speak_start_us;
+    bool seen_stt, seen_tts_start, seen_audio;
+
+    // 统计（由 mutex 保护）
+    uint64_t metric_sum_us[FLEET_METRIC_COUNT];
+    uint32_t metric_max_us[FLEET_METRIC_COUNT];
+    uint32_t metric_count[FLEET_METRIC_COUNT];
+    uint32_t turns;
+    uint32_t timeouts;
+    uint32_t disconnects;
+    uint32_t errors;
+    uint32_t mcp_messages;
+    uint64_t downlink_packets;
+} fleet_session_t;
+
+typedef struct {
+    char server_url[256];
+    char auth_token[256];
+    char device_prefix[32];
+    uint32_t protocol_version;
+    int session_count;
+    int ramp_per_second;
+    int duration_s;
+    int turn_interval_ms;
+    int turn_timeout_ms;
+    int sender_threads;
+    int report_interval_s;
+    const char* utterance_path;
+    const char* csv_path;
+} fleet_config_t;
+
+typedef struct {
+    fleet_config_t config;
+    utterance_t utterance;
+    linx_reactor_t* reactor;
+    fleet_session_t* sessions;
+    int created;                // 已创建的会话数（只增不减）
+
+    // 所有完成轮次的时延样本，结束时计算分位数
+    pthread_mutex_t samples_mutex;
+    uint32_t* samples[FLEET_METRIC_COUNT];
+    size_t sample_count[FLEET_METRIC_COUNT];
+    size_t sample_capacity[FLEET_METRIC_COUNT];
+
+    uint64_t tool_calls;        // 原子读写
+    volatile bool running;
+} fleet_t;
+
+static fleet_t g_fleet;
+
+static uint64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+static void sleep_until_us(uint64_t deadline_us) {
+    uint64_t now = now_us();
+    if (deadline_us <= now) return;
+    uint64_t wait = deadline_us - now;
+    struct timespec ts = { (time_t)(wait / 1000000ULL), (long)(wait % 1000000ULL) * 1000L };
+    nanosleep(&ts, NULL);
+}
+
+// 下一轮开始时刻：间隔上下浮动 25%，避免所有设备同时说话
+static uint64_t schedule_next_turn(fleet_session_t* session, uint64_t now) {
+    unsigned int seed = (unsigned int)(now ^ ((uint64_t)session->index * 2654435761u));
+    double spread = 0.75 + 0.5 * ((double)rand_r(&seed) / RAND_MAX);
+    return now + (uint64_t)(g_fleet.config.turn_interval_ms * spread) * 1000ULL;
+}
+
+// 调用方持有 session->mutex
+static void record_metric(fleet_session_t* session, fleet_metric_t metric, uint64_t start_us, uint64_t end_us) {
+    uint32_t value = (uint32_t)(end_us > start_us ? end_us - start_us : 0);
+    session->metric_sum_us[metric] += value;
+    session->metric_count[metric]++;
+    if (value > session->metric_max_us[metric]) session->metric_max_us[metric] = value;
+
+    pthread_mutex_lock(&g_fleet.samples_mutex);
+    if (g_fleet.sample_count[metric] == g_fleet.sample_capacity[metric]) {
+        size_t capacity = g_fleet.sample_capacity[metric] ? g_fleet.sample_capacity[metric] * 2 : 4096;
+        uint32_t* grown = (uint32_t*)realloc(g_fleet.samples[metric], capacity * sizeof(uint32_t));
+        if (grown) {
+            g_fleet.samples[metric] = grown;
+            g_fleet.sample_capacity[metric] = capacity;
+        }
+    }
+    if (g_fleet.sample_count[metric] < g_fleet.sample_capacity[metric]) {
+        g_fleet.samples[metric][g_fleet.sample_count[metric]++] = value;
+    }
+    pthread_mutex_unlock(&g_fleet.samples_mutex);
+}
+
+/**
+ * @brief 会话事件回调（在 reactor 线程上执行，只更新状态）
+ */
+static void session_event_callback(const LinxEvent* event, void* user_data) {
+    fleet_session_t* session = (fleet_session_t*)user_data;
+    uint64_t now = now_us();
+
+    pthread_mutex_lock(&session->mutex);
+    bool waiting = session->phase == SESSION_WAITING;
+    switch (event->type) {
+        case LINX_EVENT_SESSION_ESTABLISHED:
+            if (session->phase == SESSION_CONNECTING) {
+                record_metric(session, FLEET_METRIC_CONNECT, session->connect_us, now);
+                session->phase = SESSION_IDLE;
+                session->next_turn_us = schedule_next_turn(session, now);
+            }
+            break;
+
+        case LINX_EVENT_TEXT_MESSAGE:
+            if (waiting && !session->seen_stt) {
+                session->seen_stt = true;
+                record_metric(session, FLEET_METRIC_STT, session->spoke_us, now);
+            }
+            break;
+
+        case LINX_EVENT_TTS_STARTED:
+            if (waiting && !session->seen_tts_start) {
+                session->seen_tts_start = true;
+                record_metric(session, FLEET_METRIC_TTS_START, session->spoke_us, now);
+            }
+            break;
+
+        case LINX_EVENT_AUDIO_DATA:
+            session->downlink_packets++;
+            if (waiting && !session->seen_audio) {
+                session->seen_audio = true;
+                record_metric(session, FLEET_METRIC_FIRST_AUDIO, session->spoke_us, now);
+            }
+            break;
+
+        case LINX_EVENT_TTS_STOPPED:
+            if (waiting) {
+                record_metric(session, FLEET_METRIC_TURN, session->spoke_us, now);
+                session->turns++;
+                session->phase = SESSION_IDLE;
+                session->next_turn_us = schedule_next_turn(session, now);
+            }
+            break;
+
+        case LINX_EVENT_MCP_MESSAGE:
+            session->mcp_messages++;
+            break;
+
+        case LINX_EVENT_WEBSOCKET_DISCONNECTED:
+            // 自动重连后重新经过会话建立
+            session->disconnects++;
+            session->phase = SESSION_CONNECTING;
+            session->connect_us = now;
+            break;
+
+        case LINX_EVENT_ERROR:
+            session->errors++;
+            break;
+
+        default:
+            break;
+    }
+    pthread_mutex_unlock(&session->mutex);
+}
+
+static mcp_return_value_t fleet_status_tool(const struct mcp_property_list* properties) {
+    (void)properties;
+    __atomic_fetch_add(&g_fleet.tool_calls, 1, __ATOMIC_RELAXED);
+    return mcp_return_string("{\"battery\": 87, \"volume\": 50, \"simulated\": true}");
+}
+
+static bool session_create(fleet_session_t* session, int index) {
+    const fleet_config_t* fc = &g_fleet.config;
+    memset(session, 0, sizeof(*session));
+    session->index = index;
+    pthread_mutex_init(&session->mutex, NULL);
+
+    LinxSdkConfig config = {0};
+    snprintf(config.server_url, sizeof(config.server_url), "%s", fc->server_url);
+    snprintf(config.auth_token, sizeof(config.auth_token), "%s", fc->auth_token);
+    snprintf(config.audio_format, sizeof(config.audio_format), "opus");
+    snprintf(config.device_id, sizeof(config.device_id), "%s-%06d", fc->device_prefix, index);
+    snprintf(config.client_id, sizeof(config.client_id), "%s-client-%06d", fc->device_prefix, index);
+    config.sample_rate = FLEET_SAMPLE_RATE;
+    config.channels = FLEET_CHANNELS;
+    config.timeout_ms = 10000;
+    config.protocol_version = fc->protocol_version;
+    config.listening_mode = LINX_LISTENING_MODE_AUTO_STOP;
+    config.auto_reconnect = true;
+    config.reactor = g_fleet.reactor;
+
+    session->sdk = linx_sdk_create(&config);
+    if (!session->sdk) {
+        return false;
+    }
+    linx_sdk_set_event_callback(session->sdk, session_event_callback, session);
+    linx_sdk_add_mcp_tool(session->sdk, "self.device.get_status", "获取设备电量和音量", NULL, fleet_status_tool);
+
+    pthread_mutex_lock(&session->mutex);
+    session->phase = SESSION_CONNECTING;
+    session->connect_us = now_us();
+    pthread_mutex_unlock(&session->mutex);
+    return linx_sdk_connect(session->sdk) == LINX_SDK_SUCCESS;
+}
+
+/**
+ * @brief 推进一个会话：到点开始说话、按实时节奏发帧、处理回复超时
+ */
+static void session_tick(fleet_session_t* session, uint64_t now) {
+    const utterance_t* u = &g_fleet.utterance;
+    const uint8_t* packet = NULL;
+    size_t size = 0;
+
+    pthread_mutex_lock(&session->mutex);
+    switch (session->phase) {
+        case SESSION_IDLE:
+            if (now >= session->next_turn_us) {
+                session->phase = SESSION_SPEAKING;
+                session->frame = 0;
+                session->speak_start_us = now;
+            }
+            break;
+        case SESSION_WAITING:
+            if (now - session->spoke_us > (uint64_t)g_fleet.config.turn_timeout_ms * 1000ULL) {
+                session->timeouts++;
+                session->phase = SESSION_IDLE;
+                session->next_turn_us = schedule_next_turn(session, now);
+            }
+            break;
+        default:
+            break;
+    }
+
+    // 帧按开始说话的时刻对齐，发送线程偶尔迟到时连续补发
+    if (session->phase == SESSION_SPEAKING &&
+        now >= session->speak_start_us + (uint64_t)session->frame * FLEET_FRAME_MS * 1000ULL) {
+        packet = u->data + u->offsets[session->frame];
+        size = u->sizes[session->frame];
+        session->frame++;
+        if (session->frame == u->count) {
+            session->phase = SESSION_WAITING;
+            session->spoke_us = now;
+            session->seen_stt = session->seen_tts_start = session->seen_audio = false;
+        }
+    }
+    pthread_mutex_unlock(&session->mutex);
+
+    if (packet && linx_sdk_send_audio(session->sdk, packet, size) != LINX_SDK_SUCCESS) {
+        pthread_mutex_lock(&session->mutex);
+        session->errors++;
+        pthread_mutex_unlock(&session->mutex);
+    }
+}
+
+typedef struct {
+    int thread_index;
+    pthread_t thread;
+} sender_t;
+
+static void* sender_thread(void* arg) {
+    sender_t* sender = (sender_t*)arg;
+    int stride = g_fleet.config.sender_threads;
+    uint64_t next = now_us();
+
+    // 每 5ms 扫一遍本线程负责的会话，帧发送时刻误差不超过一个扫描周期
+    while (g_fleet.running) {
+        next += 5000;
+        uint64_t now = now_us();
+        int created = __atomic_load_n(&g_fleet.created, __ATOMIC_ACQUIRE);
+        for (int i = sender->thread_index; i < created; i += stride) {
+            session_tick(&g_fleet.sessions[i], now);
+        }
+        sleep_until_us(next);
+    }
+    return NULL;
+}
+
+// ==================== 报告 ====================
+
+typedef struct {
+    int connected;
+    int speaking;
+    int waiting;
+    uint64_t turns, timeouts, disconnects, errors, mcp_messages;
+} fleet_totals_t;
+
+static void collect_totals(fleet_totals_t* totals) {
+    memset(totals, 0, sizeof(*totals));
+    int created = __atomic_load_n(&g_fleet.created, __ATOMIC_ACQUIRE);
+    for (int i = 0; i < created; i++) {
+        fleet_session_t* s = &g_fleet.sessions[i];
+        pthread_mutex_lock(&s->mutex);
+        if (s->phase != SESSION_CONNECTING) totals->connected++;
+        if (s->phase == SESSION_SPEAKING) totals->speaking++;
+        if (s->phase == SESSION_WAITING) totals->waiting++;
+        totals->turns += s->turns;
+        totals->timeouts += s->timeouts;
+        totals->disconnects += s->disconnects;
+        totals->errors += s->errors;
+        totals->mcp_messages += s->mcp_messages;
+        pthread_mutex_unlock(&s->mutex);
+    }
+}
+
+static int compare_u32(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile_ms(const uint32_t* sorted, size_t count, double p) {
+    if (count == 0) return 0.0;
+    return sorted[(size_t)(p * (double)(count - 1) + 0.5)] / 1000.0;
+}
+
+static void print_summary(void) {
+    fleet_totals_t totals;
+    collect_totals(&totals);
+    printf("\n==== 汇总: %d 个会话, 已连接 %d ====\n", g_fleet.created, totals.connected);
+    printf("轮次 %llu, 超时 %llu, 断线 %llu, 错误 %llu, MCP 消息 %llu, 工具调用 %llu\n",
+           (unsigned long long)totals.turns, (unsigned long long)totals.timeouts,
+           (unsigned long long)totals.disconnects, (unsigned long long)totals.errors,
+           (unsigned long long)totals.mcp_messages,
+           (unsigned long long)__atomic_load_n(&g_fleet.tool_calls, __ATOMIC_RELAXED));
+    printf("%-12s %8s %9s %9s %9s %9s\n", "指标", "样本", "p50(ms)", "p90(ms)", "p99(ms)", "max(ms)");
+
+    pthread_mutex_lock(&g_fleet.samples_mutex);
+    for (int m = 0; m < FLEET_METRIC_COUNT; m++) {
+        size_t count = g_fleet.sample_count[m];
+        uint32_t* sorted = g_fleet.samples[m];
+        if (count > 0) {
+            qsort(sorted, count, sizeof(uint32_t), compare_u32);
+        }
+        printf("%-12s %8zu %9.1f %9.1f %9.1f %9.1f\n", s_metric_names[m], count,
+               percentile_ms(sorted, count, 0.50), percentile_ms(sorted, count, 0.90),
+               percentile_ms(sorted, count, 0.99), count ? sorted[count - 1] / 1000.0 : 0.0);
+    }
+    pthread_mutex_unlock(&g_fleet.samples_mutex);
+}
+
+static void write_csv(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "无法写入: %s\n", path);
+        return;
+    }
+    fprintf(file, "session,turns,timeouts,disconnects,errors,mcp_messages,downlink_packets");
+    for (int m = 0; m < FLEET_METRIC_COUNT; m++) {
+        fprintf(file, ",%s_avg_ms,%s_max_ms", s_metric_names[m], s_metric_names[m]);
+    }
+    fprintf(file, "\n");
+
+    for (int i = 0; i < g_fleet.created; i++) {
+        fleet_session_t* s = &g_fleet.sessions[i];
+        pthread_mutex_lock(&s->mutex);
+        fprintf(file, "%d,%u,%u,%u,%u,%u,%llu", s->index, s->turns, s->timeouts, s->disconnects,
+                s->errors, s->mcp_messages, (unsigned long long)s->downlink_packets);
+        for (int m = 0; m < FLEET_METRIC_COUNT; m++) {
+            double avg = s->metric_count[m] ? s->metric_sum_us[m] / 1000.0 / s->metric_count[m] : 0.0;
+            fprintf(file, ",%.1f,%.1f", avg, s->metric_max_us[m] / 1000.0);
+        }
+        fprintf(file, "\n");
+        pthread_mutex_unlock(&s->mutex);
+    }
+    fclose(file);
+    printf("每会话统计已写入 %s\n", path);
+}
+
+// ==================== 主程序 ====================
+
+static void signal_handler(int sig) {
+    (void)sig;
+    g_fleet.running = false;
+}
+
+static void usage(const char* program) {
+    printf("用法: %s -u ws://host:port/path [选项]\n", program);
+    printf("  -u URL    服务器地址 (必填)\n");
+    printf("  -n N      模拟设备数 (默认 100)\n");
+    printf("  -r N      每秒新建连接数 (默认 50)\n");
+    printf("  -d S      运行时长，秒，0 为直到 Ctrl+C (默认 300)\n");
+    printf("  -i MS     每台设备两轮对话的平均间隔 (默认 10000)\n");
+    printf("  -w MS     等待服务端回复的超时 (默认 15000)\n");
+    printf("  -v N      协议版本 1/2/3 (默认 1)\n");
+    printf("  -k TOKEN  认证令牌\n");
+    printf("  -x PREFIX 设备ID前缀 (默认 fleet)\n");
+    printf("  -f FILE   语音文件 (每包 2 字节大端长度 + Opus 数据，16kHz 单声道 20ms)；默认合成\n");
+    printf("  -t N      发送线程数 (默认 4，最多 %d)\n", FLEET_SENDER_MAX);
+    printf("  -p S      汇总打印间隔，秒 (默认 10)\n");
+    printf("  -o FILE   结束时写出每会话 CSV\n");
+}
+
+int main(int argc, char* argv[]) {
+    fleet_config_t* fc = &g_fleet.config;
+    fc->protocol_version = 1;
+    fc->session_count = 100;
+    fc->ramp_per_second = 50;
+    fc->duration_s = 300;
+    fc->turn_interval_ms = 10000;
+    fc->turn_timeout_ms = 15000;
+    fc->sender_threads = 4;
+    fc->report_interval_s = 10;
+    snprintf(fc->device_prefix, sizeof(fc->device_prefix), "fleet");
+
+    int opt;
+    while ((opt = getopt(argc, argv, "u:n:r:d:i:w:v:k:x:f:t:p:o:h")) != -1) {
+        switch (opt) {
+            case 'u': snprintf(fc->server_url, sizeof(fc->server_url), "%s", optarg); break;
+            case 'n': fc->session_count = atoi(optarg); break;
+            case 'r': fc->ramp_per_second = atoi(optarg); break;
+            case 'd': fc->duration_s = atoi(optarg); break;
+            case 'i': fc->turn_interval_ms = atoi(optarg); break;
+            case 'w': fc->turn_timeout_ms = atoi(optarg); break;
+            case 'v': fc->protocol_version = (uint32_t)atoi(optarg); break;
+            case 'k': snprintf(fc->auth_token, sizeof(fc->auth_token), "%s", optarg); break;
+            case 'x': snprintf(fc->device_prefix, sizeof(fc->device_prefix), "%s", optarg); break;
+            case 'f': fc->utterance_path = optarg; break;
+            case 't': fc->sender_threads = atoi(optarg); break;
+            case 'p': fc->report_interval_s = atoi(optarg); break;
+            case 'o': fc->csv_path = optarg; break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 2;
+        }
+    }
+    if (fc->server_url[0] == '\0' || fc->session_count < 1 || fc->ramp_per_second < 1 ||
+        fc->sender_threads < 1 || fc->sender_threads > FLEET_SENDER_MAX || fc->report_interval_s < 1) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    // 数千个会话的 INFO 日志会淹没输出
+    log_config_t log_config = LOG_DEFAULT_CONFIG;
+    log_config.level = LOG_LEVEL_WARN;
+    log_init(&log_config);
+
+    bool loaded = fc->utterance_path ? utterance_load(&g_fleet.utterance, fc->utterance_path)
+                                     : utterance_synthesize(&g_fleet.utterance, 1600, 800);
+    if (!loaded) {
+        fprintf(stderr, "准备语音素材失败\n");
+        return 1;
+    }
+
+    g_fleet.sessions = (fleet_session_t*)calloc((size_t)fc->session_count, sizeof(fleet_session_t));
+    g_fleet.reactor = linx_reactor_create();
+    if (!g_fleet.sessions || !g_fleet.reactor || !linx_reactor_start(g_fleet.reactor, 0)) {
+        fprintf(stderr, "初始化失败\n");
+        return 1;
+    }
+    pthread_mutex_init(&g_fleet.samples_mutex, NULL);
+    g_fleet.running = true;
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+
+    sender_t senders[FLEET_SENDER_MAX];
+    for (int i = 0; i < fc->sender_threads; i++) {
+        senders[i].thread_index = i;
+        pthread_create(&senders[i].thread, NULL, sender_thread, &senders[i]);
+    }
+
+    printf("连接 %s: %d 台设备, 每秒 %d 个, 语音 %zu 帧, 协议 v%u\n", fc->server_url, fc->session_count,
+           fc->ramp_per_second, g_fleet.utterance.count, fc->protocol_version);
+
+    uint64_t start = now_us();
+    uint64_t end = fc->duration_s > 0 ? start + (uint64_t)fc->duration_s * 1000000ULL : UINT64_MAX;
+    uint64_t next_report = start + (uint64_t)fc->report_interval_s * 1000000ULL;
+    uint64_t ramp_interval = 1000000ULL / (uint64_t)fc->ramp_per_second;
+    uint64_t next_connect = start;
+    while (g_fleet.running && now_us() < end) {
+        uint64_t now = now_us();
+        // 会话按速率逐个建立；创建完成后才对发送线程可见
+        while (g_fleet.created < fc->session_count && now >= next_connect) {
+            int index = g_fleet.created;
+            if (!session_create(&g_fleet.sessions[index], index)) {
+                fprintf(stderr, "会话 %d 创建失败\n", index);
+            }
+            __atomic_store_n(&g_fleet.created, index + 1, __ATOMIC_RELEASE);
+            next_connect += ramp_interval;
+        }
+
+        if (now >= next_report) {
+            fleet_totals_t totals;
+            collect_totals(&totals);
+            printf("[%4llus] 会话 %d/%d 已连接 %d | 说话 %d 等待 %d | 轮次 %llu 超时 %llu 断线 %llu 错误 %llu\n",
+                   (unsigned long long)((now - start) / 1000000ULL), g_fleet.created, fc->session_count,
+                   totals.connected, totals.speaking, totals.waiting,
+                   (unsigned long long)totals.turns, (unsigned long long)totals.timeouts,
+                   (unsigned long long)totals.disconnects, (unsigned long long)totals.errors);
+            fflush(stdout);
+            next_report += (uint64_t)fc->report_interval_s * 1000000ULL;
+        }
+        sleep_until_us(now + 10000);
+    }
+
+    g_fleet.running = false;
+    for (int i = 0; i < fc->sender_threads; i++) {
+        pthread_join(senders[i].thread, NULL);
+    }
+
+    print_summary();
+    if (fc->csv_path) {
+        write_csv(fc->csv_path);
+    }
+
+    // 先停 reactor，再逐个销毁会话
+    linx_reactor_stop(g_fleet.reactor);
+    for (int i = 0; i < g_fleet.created; i++) {
+        if (g_fleet.sessions[i].sdk) {
+            linx_sdk_destroy(g_fleet.sessions[i].sdk);
+        }
+        pthread_mutex_destroy(&g_fleet.sessions[i].mutex);
+    }
+    linx_reactor_destroy(g_fleet.reactor);
+    free(g_fleet.sessions);
+    for (int m = 0; m < FLEET_METRIC_COUNT; m++) {
+        free(g_fleet.samples[m]);
+    }
+    pthread_mutex_destroy(&g_fleet.samples_mutex);
+    utterance_free(&g_fleet.utterance);
+    log_cleanup();
+    return 0;
+}
@@ -25,34 +25,51 @@
 
 // 引入 Linx SDK
 #include "linx_sdk.h"
+#include "linx_boot.h"
+#include "linx_budget.h"
+#include "log/linx_thread_stats.h"
 #include "protocols/linx_protocol.h"
 #include "audio/audio_interface.h"
 #include "board/mac/audio/portaudio_mac.h"
 #include "codecs/audio_codec.h"
 #include "codecs/opus_codec.h"
+#include "audio/audio_vad.h"
+#include "audio/audio_vad_gate.h"
+#include "audio/audio_aec.h"
+#include "audio/audio_pipeline.h"
 #include "play/linx_player.h"
 #include "mcp/mcp_server.h"
 #include "log/linx_log.h"
 
+// 与服务器协商的二进制协议版本
+#define DEMO_PROTOCOL_VERSION 1
+
+// AUTO_STOP 模式下本地断句的尾部静音时长（毫秒）
+#define DEMO_ENDPOINT_MS 600
+
 // 全局变量和结构体定义
 typedef struct {
     LinxSdk* sdk;
     AudioInterface* audio_interface;
     audio_codec_t* opus_encoder;
     audio_codec_t* opus_decoder;
+    audio_vad_t* vad;
+    audio_vad_gate_t* vad_gate;  // 静音时不发送上行音频
+    audio_aec_t* aec;            // 实时模式下消除播放声音的回声
+    audio_pipeline_t* uplink;    // 采集 -> 回声消除 -> VAD门限编码发送
+    audio_stage_aec_t aec_stage;
+    audio_stage_vad_gate_t gate_stage;
     linx_player_t* player;  // 使用linx_player模块
-    mcp_server_t* mcp_server;
     
     bool running;
     bool connected;
     bool recording;
     bool playing;
     bool tts_data_complete;  // TTS数据传输是否完成
+    bool fast_boot;          // 创建SDK后立即连接，握手与设备初始化并行
+    const char* capture_path; // 录制会话收发的每一帧，供 replay_session 离线回放
     
-    pthread_t audio_thread;
     pthread_t websocket_thread;
-    pthread_mutex_t audio_mutex;
-    pthread_cond_t audio_cond;
     
     char server_url[256];
     int sample_rate;
@@ -71,7 +88,7 @@ bool g_has_audio_data = false;
 #define DEFAULT_SAMPLE_RATE 16000
 #define DEFAULT_CHANNELS 1
 #define DEFAULT_FRAME_SIZE 320  // 20ms at 16kHz
-#define AUDIO_BUFFER_SIZE 4096
+#define COMFORT_NOISE_INTERVAL_MS 400  // 静音期间每 400ms 放行一个舒适噪声包
 
 // 函数声明
 static void signal_handler(int sig);
@@ -79,11 +96,16 @@ static void event_handler(const LinxEvent* event, void* user_data);
 static void player_event_callback(player_state_t old_state, player_state_t new_state, void* user_data);
 static bool init_demo(const char* server_url);
 static void cleanup_demo(void);
-static void* audio_thread_func(void* arg);
 static void* websocket_thread_func(void* arg);
+static bool send_uplink_packet(void* user_data, const uint8_t* packet, size_t size);
+static void player_output_tap(void* user_data, const int16_t* pcm, size_t samples, const uint32_t* timestamp);
+static void set_uplink_timestamp(void* user_data, uint32_t timestamp);
+static void notify_speech_start(void* user_data);
+static void notify_speech_end(void* user_data);
+static bool init_uplink(void);
 static void start_recording(void);
 static void stop_recording(void);
-static void play_audio(const uint8_t* data, size_t size);
+static void play_audio(const linx_audio_stream_packet_t* packet);
 static bool is_play_buffer_empty(void);
 static void check_tts_playback_complete(void);
 static void setup_mcp_tools(void);
@@ -186,7 +208,7 @@ static void event_handler(const LinxEvent* event, void* user_data) {
             
         case LINX_EVENT_AUDIO_DATA:
             LOG_INFO("♪ 收到音频数据: %zu 字节", event->data.audio_data.value->payload_size);
-            play_audio(event->data.audio_data.value->payload, event->data.audio_data.value->payload_size);
+            play_audio(event->data.audio_data.value);
             break;
             
         case LINX_EVENT_TEXT_MESSAGE:
@@ -194,11 +216,8 @@ static void event_handler(const LinxEvent* event, void* user_data) {
             break;
             
         case LINX_EVENT_MCP_MESSAGE:
+            // 工具调用由SDK内置的MCP服务器处理并回复，这里只记录
             LOG_INFO("🔧 MCP工具调用: %s", event->data.mcp_message.message);
-            if (g_demo.mcp_server) {
-                // 处理MCP工具调用
-                mcp_server_parse_message(g_demo.mcp_server, event->data.mcp_message.message);
-            }
             break;
             
         case LINX_EVENT_TTS_STARTED:
@@ -237,18 +256,6 @@ static bool init_demo(const char* server_url) {
     g_demo.frame_size = DEFAULT_FRAME_SIZE;
     g_demo.running = true;
     
-    // 初始化互斥锁和条件变量
-    if (pthread_mutex_init(&g_demo.audio_mutex, NULL) != 0) {
-        LOG_ERROR("✗ 音频互斥锁初始化失败");
-        return false;
-    }
-    
-    if (pthread_cond_init(&g_demo.audio_cond, NULL) != 0) {
-        LOG_ERROR("✗ 音频条件变量初始化失败");
-        pthread_mutex_destroy(&g_demo.audio_mutex);
-        return false;
-    }
-    
     // 初始化SDK
     LinxSdkConfig config = {0};
     strncpy(config.server_url, server_url, sizeof(config.server_url) - 1);
@@ -256,12 +263,41 @@ static bool init_demo(const char* server_url) {
     config.channels = g_demo.channels;
     config.timeout_ms = 5000;
     config.listening_mode = LINX_LISTENING_MODE_REALTIME;
+    // 音频格式；算力紧张的板子可改用 "pcmu"/"adpcm"（需关闭下面的码率自适应）
+    strncpy(config.audio_format, "opus", sizeof(config.audio_format) - 1);
     
     // WebSocket连接配置
     strncpy(config.auth_token, "test-token", sizeof(config.auth_token) - 1);
     strncpy(config.device_id, "98:a3:16:f9:d9:34", sizeof(config.device_id) - 1);
     strncpy(config.client_id, "test-client", sizeof(config.client_id) - 1);
-    config.protocol_version = 1;
+    config.protocol_version = DEMO_PROTOCOL_VERSION;
+    
+    // 上行码率随网络状况自适应
+    config.adaptive_bitrate = true;
+    config.min_bitrate = 8000;
+    config.max_bitrate = 32000;
+    config.adaptive_fec = true;
+    
+    // 记录最近几十轮对话的时间线，/trace 导出
+    config.trace_events = 1024;
+    
+    // 播放时检测到用户说话立即停止播放，不等服务端的 tts stop
+    config.barge_in = true;
+    
+    // AUTO_STOP 模式下本地断句，不等服务端 VAD（实时模式下不生效）
+    config.local_endpoint_ms = DEMO_ENDPOINT_MS;
+    
+    // 上行降噪和自动增益（定点实现）
+    config.noise_suppression = true;
+    config.auto_gain = true;
+    
+    // 快速启动：MCP线程池和OTA留到第一轮对话之后
+    config.fast_boot = g_demo.fast_boot;
+    
+    // 录制会话，线上问题可离线回放复现
+    if (g_demo.capture_path) {
+        snprintf(config.capture_path, sizeof(config.capture_path), "%s", g_demo.capture_path);
+    }
     
     g_demo.sdk = linx_sdk_create(&config);
     if (!g_demo.sdk) {
@@ -271,6 +307,15 @@ static bool init_demo(const char* server_url) {
     
     linx_sdk_set_event_callback(g_demo.sdk, event_handler, NULL);
     
+    // 快速启动时先发起连接，下面的音频设备、编解码器和播放器初始化与握手并行
+    if (g_demo.fast_boot) {
+        LOG_INFO("正在连接到服务器: %s", server_url);
+        if (linx_sdk_connect(g_demo.sdk) != LINX_SDK_SUCCESS) {
+            LOG_ERROR("✗ 连接失败");
+            return false;
+        }
+    }
+    
     // 初始化音频接口 - 使用PortAudio Mac实现
     g_demo.audio_interface = portaudio_mac_create();
     if (!g_demo.audio_interface) {
@@ -284,6 +329,7 @@ static bool init_demo(const char* server_url) {
     // 再配置音频参数（需要在PortAudio初始化后才能获取默认设备）
     audio_interface_set_config(g_demo.audio_interface, g_demo.sample_rate, g_demo.frame_size, 
                               g_demo.channels, 4, 8192, 2048);
+    linx_boot_mark(LINX_BOOT_AUDIO_READY);
 
     
     // 初始化Opus编解码器
@@ -304,6 +350,41 @@ static bool init_demo(const char* server_url) {
         LOG_ERROR("✗ 初始化Opus编解码器失败");
         return false;
     }
+    linx_boot_mark(LINX_BOOT_CODEC_READY);
+    
+    // 编码和发送都在录音线程中进行，码率调整在发送时下发
+    linx_sdk_set_uplink_encoder(g_demo.sdk, g_demo.opus_encoder);
+    
+    // 开启 DTX，静音帧由 VAD 门限拦截，只保留少量舒适噪声包
+    opus_codec_set_dtx(g_demo.opus_encoder, 1);
+    g_demo.vad = audio_energy_vad_create(NULL);
+    audio_vad_gate_config_t gate_config = {
+        .frame_samples = (size_t)(g_demo.frame_size * g_demo.channels),
+        .frame_duration_ms = 20,
+        .comfort_noise_interval_ms = COMFORT_NOISE_INTERVAL_MS,
+    };
+    g_demo.vad_gate = g_demo.vad ? audio_vad_gate_create(g_demo.vad, g_demo.opus_encoder, &gate_config,
+                                                         send_uplink_packet, NULL) : NULL;
+    if (!g_demo.vad_gate) {
+        LOG_ERROR("✗ 创建VAD门限失败");
+        return false;
+    }
+    
+    // 实时模式播放时保持监听，先在设备端消除回声
+    if (config.listening_mode == LINX_LISTENING_MODE_REALTIME) {
+        audio_aec_config_t aec_config = {
+            .sample_rate = (unsigned int)g_demo.sample_rate,
+            .frame_samples = (size_t)(g_demo.frame_size * g_demo.channels),
+        };
+        g_demo.aec = audio_aec_create(&aec_config);
+        if (!g_demo.aec) {
+            LOG_WARN("回声消除创建失败，播放时可能把自己的声音当作输入");
+        }
+    }
+    
+    if (!init_uplink()) {
+        return false;
+    }
     
     // 创建并初始化播放器
     g_demo.player = linx_player_create(g_demo.audio_interface, g_demo.opus_decoder);
@@ -317,7 +398,9 @@ static bool init_demo(const char* server_url) {
         .sample_rate = g_demo.sample_rate,
         .channels = g_demo.channels,
         .frame_size = g_demo.frame_size,
-        .buffer_size = 8192
+        .buffer_size = 8192,
+        .conceal_loss = true, // 仅对带时间戳的协议 v2 生效
+        .pull_mode = true     // PortAudio 输出回调直接解码，省去一次PCM拷贝
     };
     
     if (linx_player_init(g_demo.player, &player_config) != PLAYER_SUCCESS) {
@@ -328,12 +411,23 @@ static bool init_demo(const char* server_url) {
     // 设置播放器事件回调
     linx_player_set_event_callback(g_demo.player, player_event_callback, NULL);
     
+    // 解码耗时、抖动缓冲深度和 TTS 首帧到播出记入SDK的运行指标
+    linx_player_set_metrics(g_demo.player, linx_sdk_get_metrics_recorder(g_demo.sdk));
+    linx_player_set_trace(g_demo.player, linx_sdk_get_trace(g_demo.sdk));
+    linx_sdk_set_player(g_demo.sdk, g_demo.player);
+    
+    // 播放的PCM作为回声消除的远端参考
+    if (g_demo.aec) {
+        linx_player_set_output_tap(g_demo.player, player_output_tap, g_demo.aec);
+    }
+    
     // 启动播放器，让其保持运行状态
     if (linx_player_start(g_demo.player) != PLAYER_SUCCESS) {
         LOG_ERROR("✗ 启动播放器失败");
         return false;
     }
     LOG_INFO("✓ 播放器已启动并保持运行状态");
+    linx_boot_mark(LINX_BOOT_PLAYER_READY);
     
     // 设置MCP工具
     setup_mcp_tools();
@@ -346,27 +440,25 @@ static bool init_demo(const char* server_url) {
  * 设置MCP工具
  */
 static void setup_mcp_tools(void) {
-    g_demo.mcp_server = mcp_server_create("LinxDemo", "1.0.0");
-    if (!g_demo.mcp_server) {
-        LOG_ERROR("✗ MCP服务器创建失败");
-        return;
-    }
-    
-    // 添加天气工具
+    // 添加天气工具（需要联网查询，放到线程池异步执行）
     mcp_property_list_t* weather_props = mcp_property_list_create();
     mcp_property_t* location_prop = mcp_property_create_string("location", "北京", true);
     mcp_property_list_add(weather_props, location_prop);
-    mcp_server_add_simple_tool(g_demo.mcp_server, "get_weather", 
-                              "获取指定城市的天气信息", 
-                              weather_props, weather_tool_callback);
+    if (linx_sdk_add_async_mcp_tool(g_demo.sdk, "get_weather", 
+                                    "获取指定城市的天气信息", 
+                                    weather_props, weather_tool_callback,
+                                    2, 10000) != LINX_SDK_SUCCESS) {
+        LOG_ERROR("✗ MCP服务器不可用");
+        return;
+    }
     
     // 添加计算器工具
     mcp_property_list_t* calc_props = mcp_property_list_create();
     mcp_property_t* expression_prop = mcp_property_create_string("expression", "1+1", true);
     mcp_property_list_add(calc_props, expression_prop);
-    mcp_server_add_simple_tool(g_demo.mcp_server, "calculator", 
-                              "执行数学计算", 
-                              calc_props, calculator_tool_callback);
+    linx_sdk_add_mcp_tool(g_demo.sdk, "calculator", 
+                          "执行数学计算", 
+                          calc_props, calculator_tool_callback);
     
     // 添加文件操作工具
     mcp_property_list_t* file_props = mcp_property_list_create();
@@ -374,55 +466,84 @@ static void setup_mcp_tools(void) {
     mcp_property_t* operation_prop = mcp_property_create_string("operation", "read", true);
     mcp_property_list_add(file_props, path_prop);
     mcp_property_list_add(file_props, operation_prop);
-    mcp_server_add_simple_tool(g_demo.mcp_server, "file_operation", 
-                              "执行文件操作", 
-                              file_props, file_tool_callback);
+    linx_sdk_add_mcp_tool(g_demo.sdk, "file_operation", 
+                          "执行文件操作", 
+                          file_props, file_tool_callback);
     
     LOG_INFO("✓ MCP工具设置完成");
 }
 
 /**
- * 音频线程函数
+ * VAD门限放行的上行音频包
+ */
+static bool send_uplink_packet(void* user_data, const uint8_t* packet, size_t size) {
+    (void)user_data;
+    return linx_sdk_send_audio(g_demo.sdk, packet, size) == LINX_SDK_SUCCESS;
+}
+
+/**
+ * 播放器输出抽头：送入回声消除的远端参考
+ */
+static void player_output_tap(void* user_data, const int16_t* pcm, size_t samples, const uint32_t* timestamp) {
+    audio_aec_feed_far((audio_aec_t*)user_data, pcm, samples, timestamp);
+}
+
+/**
+ * 回声消除后对齐的播放时间戳带到上行包里（协议 v2）
  */
-static void* audio_thread_func(void* arg) {
-    (void)arg; // 避免未使用参数警告
-    short audio_buffer[AUDIO_BUFFER_SIZE];
-    uint8_t encoded_buffer[AUDIO_BUFFER_SIZE];
+static void set_uplink_timestamp(void* user_data, uint32_t timestamp) {
+    (void)user_data;
+    linx_sdk_set_uplink_timestamp(g_demo.sdk, timestamp);
+}
+
+/**
+ * 门限由关到开即用户开始说话，播放中会本地打断
+ */
+static void notify_speech_start(void* user_data) {
+    (void)user_data;
+    linx_sdk_notify_speech_start(g_demo.sdk);
+}
+
+/**
+ * 说完后静音达到 DEMO_ENDPOINT_MS，AUTO_STOP 模式下本地发送 listen stop
+ */
+static void notify_speech_end(void* user_data) {
+    (void)user_data;
+    linx_sdk_notify_speech_end(g_demo.sdk);
+}
+
+/**
+ * 上行音频流水线：采集线程按麦克风节奏逐帧回声消除，再编码并经VAD门限发送
+ * 只发送语音段（含预录和拖尾）及舒适噪声包；驱动支持零拷贝采集时直接处理驱动缓冲区
+ */
+static bool init_uplink(void) {
+    audio_pipeline_config_t config = audio_pipeline_default_config(AUDIO_PIPELINE_UPLINK);
+    config.audio = g_demo.audio_interface;
+    config.frame_samples = (size_t)(g_demo.frame_size * g_demo.channels);
+    g_demo.uplink = audio_pipeline_create(&config);
+    if (!g_demo.uplink) {
+        LOG_ERROR("✗ 创建上行音频流水线失败");
+        return false;
+    }
     
-    while (g_demo.running) {
-        pthread_mutex_lock(&g_demo.audio_mutex);
-        
-        while (!g_demo.recording && g_demo.running) {
-            pthread_cond_wait(&g_demo.audio_cond, &g_demo.audio_mutex);
-        }
-        
-        if (!g_demo.running) {
-            pthread_mutex_unlock(&g_demo.audio_mutex);
-            break;
-        }
-        
-        pthread_mutex_unlock(&g_demo.audio_mutex);
-        
-        // 录制音频
-        int read_success = audio_interface_read(g_demo.audio_interface, 
-                                               audio_buffer, g_demo.frame_size);
-        
-        if (read_success == 0 && g_demo.connected) {
-            // 编码音频
-            size_t encoded_size = 0;
-            if (audio_codec_encode(g_demo.opus_encoder, (int16_t*)audio_buffer, 
-                                  g_demo.frame_size,
-                                  encoded_buffer, sizeof(encoded_buffer), &encoded_size) == CODEC_SUCCESS) {
-                
-                // 发送编码后的音频
-                linx_sdk_send_audio(g_demo.sdk, encoded_buffer, encoded_size);
-            }
-        }
-        
-        usleep(10000); // 10ms
+    if (g_demo.aec) {
+        g_demo.aec_stage.aec = g_demo.aec;
+        g_demo.aec_stage.uplink_timestamp = set_uplink_timestamp;
+        audio_stage_t aec_stage = audio_stage_aec(&g_demo.aec_stage);
+        audio_pipeline_add_stage(g_demo.uplink, &aec_stage);
     }
+    // 回声消除之后降噪、自动增益，VAD 和编码器拿到的是处理后的音频
+    linx_sdk_add_uplink_stages(g_demo.sdk, g_demo.uplink);
+    g_demo.gate_stage.gate = g_demo.vad_gate;
+    g_demo.gate_stage.on_speech_start = notify_speech_start;
+    g_demo.gate_stage.endpoint_ms = DEMO_ENDPOINT_MS;
+    g_demo.gate_stage.on_speech_end = notify_speech_end;
+    audio_stage_t gate_stage = audio_stage_vad_gate(&g_demo.gate_stage);
+    audio_pipeline_add_stage(g_demo.uplink, &gate_stage);
     
-    return NULL;
+    // 开始录音前不处理采集的音频
+    audio_pipeline_set_active(g_demo.uplink, false);
+    return true;
 }
 
 /**
@@ -458,17 +579,13 @@ static void start_recording(void) {
         return;
     }
     
-    pthread_mutex_lock(&g_demo.audio_mutex);
-    g_demo.recording = true;
-    pthread_cond_signal(&g_demo.audio_cond);
-    pthread_mutex_unlock(&g_demo.audio_mutex);
-    
-    int ret = audio_interface_record(g_demo.audio_interface);
-    if(ret != 0) {
+    // 首次录音时打开麦克风并启动采集线程；新一轮录音丢弃上一轮残留的预录音频
+    if (audio_pipeline_start(g_demo.uplink) != 0) {
         LOG_ERROR("✗ 录音失败: ");
-        g_demo.recording = false;
         return;
     }
+    g_demo.recording = true;
+    audio_pipeline_set_active(g_demo.uplink, true);
     LOG_INFO("🎤 开始录音...");
 }
 
@@ -481,9 +598,8 @@ static void stop_recording(void) {
         return;
     }
     
-    pthread_mutex_lock(&g_demo.audio_mutex);
     g_demo.recording = false;
-    pthread_mutex_unlock(&g_demo.audio_mutex);
+    audio_pipeline_set_active(g_demo.uplink, false);
     
     LOG_INFO("🎤 停止录音");
 }
@@ -491,11 +607,13 @@ static void stop_recording(void) {
 /**
  * 播放音频
  */
-static void play_audio(const uint8_t* data, size_t size) {
-    if (!data || size == 0 || !g_demo.player) return;
+static void play_audio(const linx_audio_stream_packet_t* packet) {
+    if (!packet || !packet->payload || packet->payload_size == 0 || !g_demo.player) return;
     
     // 使用linx_player模块播放音频（播放器已保持运行状态，只需喂数据）
-    player_error_t ret = linx_player_feed_data(g_demo.player, data, size);
+    // 只有协议 v2 的二进制帧携带时间戳，交给抖动缓冲区排序与估算抖动
+    player_error_t ret = linx_player_feed_packet(g_demo.player, packet->payload, packet->payload_size,
+                                                 packet->timestamp, linx_binary_protocol_has_timestamp(DEMO_PROTOCOL_VERSION));
     if (ret != PLAYER_SUCCESS) {
         LOG_ERROR("✗ 播放失败: %s", linx_player_error_string(ret));
     } else {
@@ -549,12 +667,15 @@ static void interactive_mode(void) {
     printf("  /stop     - 停止录音\n");
     printf("  /status   - 显示状态\n");
     printf("  /tools    - 显示MCP工具\n");
+    printf("  /metrics  - 显示运行指标(JSON)\n");
+    printf("  /trace    - 保存对话时间线到 linx_trace.json (chrome://tracing)\n");
+    printf("  /boot     - 显示启动各阶段耗时\n");
+    printf("  /budget   - 显示堆峰值、线程栈高水位和各阶段CPU (需 -b 启动)\n");
     printf("  /help     - 显示帮助\n");
     printf("  /quit     - 退出程序\n");
     printf("  其他文本  - 发送文本消息\n\n");
     
     // 启动线程
-    pthread_create(&g_demo.audio_thread, NULL, audio_thread_func, NULL);
     pthread_create(&g_demo.websocket_thread, NULL, websocket_thread_func, NULL);
     
     while (g_demo.running) {
@@ -581,6 +702,19 @@ static void interactive_mode(void) {
             printf("连接状态: %s\n", g_demo.connected ? "已连接" : "未连接");
             printf("录音状态: %s\n", g_demo.recording ? "录音中" : "未录音");
             printf("播放状态: %s\n", g_demo.playing ? "播放中" : "未播放");
+            audio_pipeline_stats_t uplink_stats;
+            if (audio_pipeline_get_stats(g_demo.uplink, &uplink_stats)) {
+                printf("上行音频: %llu 帧，丢弃 %llu 帧，设备错误 %llu 次\n",
+                       (unsigned long long)uplink_stats.frames,
+                       (unsigned long long)uplink_stats.dropped,
+                       (unsigned long long)uplink_stats.device_errors);
+                for (size_t i = 0; i < uplink_stats.stage_count; i++) {
+                    const audio_stage_stats_t* stage = &uplink_stats.stages[i];
+                    printf("  %-10s 平均 %llu us，最长 %u us\n", stage->name,
+                           (unsigned long long)(stage->frames ? stage->total_us / stage->frames : 0),
+                           stage->max_us);
+                }
+            }
             if (g_demo.player) {
                 player_state_t state = linx_player_get_state(g_demo.player);
                 const char* state_str = "未知";
@@ -595,11 +729,32 @@ static void interactive_mode(void) {
                 printf("缓冲区使用率: %.1f%%\n", linx_player_get_buffer_usage(g_demo.player) * 100);
             }
         } else if (strcmp(input, "/tools") == 0) {
-            if (g_demo.mcp_server) {
-                char* tools_json = mcp_server_get_tools_list_json(g_demo.mcp_server, NULL, false);
+            if (g_demo.sdk && g_demo.sdk->mcp_server) {
+                char* tools_json = mcp_server_get_tools_list_json(g_demo.sdk->mcp_server, NULL, false);
                 printf("可用工具:\n%s\n", tools_json);
-                free(tools_json);
+                cJSON_free(tools_json);
+            }
+        } else if (strcmp(input, "/metrics") == 0) {
+            char* metrics_json = linx_sdk_get_metrics_json(g_demo.sdk);
+            if (metrics_json) {
+                printf("%s\n", metrics_json);
+                linx_free(metrics_json);
             }
+        } else if (strcmp(input, "/trace") == 0) {
+            char* trace_json = linx_sdk_get_trace_json(g_demo.sdk);
+            FILE* file = trace_json ? fopen("linx_trace.json", "w") : NULL;
+            if (file) {
+                fputs(trace_json, file);
+                fclose(file);
+                LOG_INFO("✓ 对话时间线已保存到 linx_trace.json");
+            } else {
+                LOG_WARN("✗ 保存对话时间线失败");
+            }
+            linx_free(trace_json);
+        } else if (strcmp(input, "/boot") == 0) {
+            linx_boot_dump();
+        } else if (strcmp(input, "/budget") == 0) {
+            linx_budget_dump();
         } else if (strcmp(input, "/help") == 0) {
             print_usage("linx_demo");
         } else {
@@ -609,8 +764,7 @@ static void interactive_mode(void) {
     
     // 等待线程结束
     g_demo.running = false;
-    pthread_cond_signal(&g_demo.audio_cond);
-    pthread_join(g_demo.audio_thread, NULL);
+    audio_pipeline_stop(g_demo.uplink);
     pthread_join(g_demo.websocket_thread, NULL);
 }
 
@@ -624,6 +778,9 @@ static void cleanup_demo(void) {
         stop_recording();
     }
     
+    // 采集线程先于 SDK（持有降噪和自动增益）、音频设备和编码器退出
+    audio_pipeline_destroy(g_demo.uplink);
+    
     if (g_demo.sdk) {
         if (g_demo.connected) {
             linx_sdk_disconnect(g_demo.sdk);
@@ -635,6 +792,9 @@ static void cleanup_demo(void) {
         audio_interface_destroy(g_demo.audio_interface);
     }
     
+    audio_vad_gate_destroy(g_demo.vad_gate);
+    audio_vad_destroy(g_demo.vad);
+    
     if (g_demo.opus_encoder) {
         audio_codec_destroy(g_demo.opus_encoder);
     }
@@ -649,12 +809,8 @@ static void cleanup_demo(void) {
         linx_player_destroy(g_demo.player);
     }
     
-    if (g_demo.mcp_server) {
-        mcp_server_destroy(g_demo.mcp_server);
-    }
-    
-    pthread_mutex_destroy(&g_demo.audio_mutex);
-    pthread_cond_destroy(&g_demo.audio_cond);
+    // 播放器销毁后不再有远端参考写入
+    audio_aec_destroy(g_demo.aec);
     
     LOG_INFO("✓ 资源清理完成");
 }
@@ -669,6 +825,9 @@ static void print_usage(const char* program_name) {
     printf("  -h, --help              显示此帮助信息\n");
     printf("  -s, --server URL        WebSocket服务器地址 (默认: %s)\n", DEFAULT_SERVER_URL);
     printf("  -i, --interactive       交互模式 (默认)\n");
+    printf("  -f, --fast-boot         快速启动: 连接与设备初始化并行，MCP线程池和OTA推迟到第一轮对话后\n");
+    printf("  -c, --capture FILE      录制会话的 WebSocket 收发到文件，可用 replay_session 回放\n");
+    printf("  -b, --budget            统计堆峰值、线程栈高水位和各阶段CPU，/budget 查看\n");
     printf("\n");
     printf("功能特性:\n");
     printf("  • 实时音频录制和播放\n");
@@ -686,12 +845,23 @@ static void print_usage(const char* program_name) {
  */
 int main(int argc, char* argv[]) {
     const char* server_url = DEFAULT_SERVER_URL;
+    
+    // 无法读取进程启动时间的平台以此为启动耗时的原点
+    linx_boot_begin();
+
+    // 资源统计必须在任何SDK调用（包括日志初始化）之前打开
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-b") == 0 || strcmp(argv[i], "--budget") == 0) {
+            linx_budget_enable();
+        }
+    }
 
       // 初始化日志系统
     log_config_t log_config = LOG_DEFAULT_CONFIG;
     log_config.level = LOG_LEVEL_DEBUG;  // 默认INFO级别
     log_config.enable_timestamp = true;
     log_config.enable_color = true;
+    log_config.async = true;             // 日志输出放到后台线程，避免影响音频线程
     if (log_init(&log_config) != 0) {
         LOG_ERROR("日志系统初始化失败");
         return 0;
@@ -713,6 +883,17 @@ int main(int argc, char* argv[]) {
                 LOG_ERROR("✗ 缺少服务器地址参数");
                 return 1;
             }
+        } else if (strcmp(argv[i], "-b") == 0 || strcmp(argv[i], "--budget") == 0) {
+            // 已在日志初始化前处理
+        } else if (strcmp(argv[i], "-f") == 0 || strcmp(argv[i], "--fast-boot") == 0) {
+            g_demo.fast_boot = true;
+        } else if (strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "--capture") == 0) {
+            if (i + 1 < argc) {
+                g_demo.capture_path = argv[++i];
+            } else {
+                LOG_ERROR("✗ 缺少录制文件参数");
+                return 1;
+            }
         }
     }
     
@@ -722,13 +903,15 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
-    // 连接到服务器
-    LOG_INFO("正在连接到服务器: %s", server_url);
-    LinxSdkError result = linx_sdk_connect(g_demo.sdk);
-    if (result != LINX_SDK_SUCCESS) {
-        LOG_ERROR("✗ 连接失败: %d", result);
-        cleanup_demo();
-        return 1;
+    // 连接到服务器（快速启动时已在初始化过程中发起）
+    if (!g_demo.fast_boot) {
+        LOG_INFO("正在连接到服务器: %s", server_url);
+        LinxSdkError result = linx_sdk_connect(g_demo.sdk);
+        if (result != LINX_SDK_SUCCESS) {
+            LOG_ERROR("✗ 连接失败: %d", result);
+            cleanup_demo();
+            return 1;
+        }
     }
     
     // 等待连接建立
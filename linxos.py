@@ -302,6 +302,86 @@ class LinxOSBuilder:
             log_error(f"应用配置失败: {e}")
             return False
 
+    def _sdk_cmake_args(self, config_data: Dict) -> List[str]:
+        """按当前配置生成SDK的CMake配置参数（不含源码目录）"""
+        cmake_args = [
+            "cmake",
+            f"-DCMAKE_BUILD_TYPE={self.current_config['build_type']}"
+        ]
+        
+        # 添加工具链文件（如果有）
+        toolchain_file = self.current_config.get('toolchain_file')
+        if toolchain_file:
+            toolchain_path = self.build_dir / "toolchains" / toolchain_file
+            if toolchain_path.exists():
+                cmake_args.append(f"-DCMAKE_TOOLCHAIN_FILE={toolchain_path}")
+                log_info(f"使用工具链文件: {toolchain_file}")
+            else:
+                log_warn(f"工具链文件不存在: {toolchain_path}")
+        
+        # 编译期固定 WebSocket 协议版本（0 或未配置时运行时协商）
+        ws_protocol_version = config_data.get("CONFIG_WS_PROTOCOL_VERSION", "0")
+        if ws_protocol_version not in ("", "0"):
+            cmake_args.append(f"-DLINX_WS_PROTOCOL_VERSION={ws_protocol_version}")
+            log_info(f"WebSocket 协议版本固定为 v{ws_protocol_version}")
+        
+        # Opus 构建档位（fixed / neon / float，未配置时按目标处理器自动选择）及默认编码参数
+        opus_profile = config_data.get("CONFIG_OPUS_PROFILE", "auto")
+        if opus_profile not in ("", "auto"):
+            cmake_args.append(f"-DLINX_OPUS_PROFILE={opus_profile}")
+            log_info(f"Opus 构建档位: {opus_profile}")
+        for key, option in (("CONFIG_OPUS_COMPLEXITY", "LINX_OPUS_COMPLEXITY"),
+                            ("CONFIG_OPUS_FRAME_MS", "LINX_OPUS_FRAME_MS")):
+            value = config_data.get(key, "0")
+            if value not in ("", "0"):
+                cmake_args.append(f"-D{option}={value}")
+        
+        # 线程调度的板级默认值（核位图、音频线程实时优先级；0 或未配置时不限制）
+        for key, option in (("CONFIG_AUDIO_THREAD_CORE_MASK", "LINX_THREAD_AUDIO_CORE_MASK"),
+                            ("CONFIG_AUDIO_THREAD_SCHED_PRIORITY", "LINX_THREAD_AUDIO_SCHED_PRIORITY"),
+                            ("CONFIG_NET_THREAD_CORE_MASK", "LINX_THREAD_NET_CORE_MASK"),
+                            ("CONFIG_UI_THREAD_CORE_MASK", "LINX_THREAD_UI_CORE_MASK")):
+            value = config_data.get(key, "0")
+            if value not in ("", "0"):
+                cmake_args.append(f"-D{option}={value}")
+        
+        # WebSocket 收发缓冲区的初始大小和上限（字节，0 或未配置时使用默认值）
+        for key, option in (("CONFIG_NETWORK_BUFFER_SIZE", "LINX_NETWORK_BUFFER_SIZE"),
+                            ("CONFIG_NETWORK_BUFFER_MAX", "LINX_NETWORK_BUFFER_MAX")):
+            value = config_data.get(key, "0")
+            if value not in ("", "0"):
+                cmake_args.append(f"-D{option}={value}")
+        
+        # 静态内存模式（MCU 产品：SDK 和 mongoose 的分配都来自静态内存区）
+        if config_data.get("CONFIG_STATIC_MEMORY", "n") == "y":
+            cmake_args.append("-DLINX_STATIC_MEMORY=ON")
+        static_memory_size = config_data.get("CONFIG_STATIC_MEMORY_SIZE", "0")
+        if static_memory_size not in ("", "0"):
+            cmake_args.append(f"-DLINX_STATIC_MEMORY_SIZE={static_memory_size}")
+        
+        # TLS 后端（builtin / mbedtls）
+        tls_backend = config_data.get("CONFIG_TLS_BACKEND", "builtin")
+        if tls_backend not in ("", "builtin"):
+            cmake_args.append(f"-DLINX_TLS_BACKEND={tls_backend}")
+            log_info(f"TLS 后端: {tls_backend}")
+        
+        # 静态跟踪点（off / usdt / track）
+        tracepoints = config_data.get("CONFIG_TRACEPOINTS", "off")
+        if tracepoints not in ("", "off"):
+            cmake_args.append(f"-DLINX_TRACEPOINTS={tracepoints}")
+            log_info(f"静态跟踪点: {tracepoints}")
+        
+        # 功能裁剪：配置为 n 的模块不编入SDK（未配置时保持开启）
+        for key, option in (("CONFIG_ENABLE_MCP", "LINX_ENABLE_MCP"),
+                            ("CONFIG_ENABLE_OTA", "LINX_ENABLE_OTA"),
+                            ("CONFIG_ENABLE_UI", "LINX_ENABLE_UI")):
+            if config_data.get(key, "y") == "n":
+                cmake_args.append(f"-D{option}=OFF")
+                log_info(f"已裁剪: {key}")
+        if config_data.get("CONFIG_ENABLE_LTO", "n") == "y":
+            cmake_args.append("-DLINX_ENABLE_LTO=ON")
+        return cmake_args
+
     def build_sdk(self, force: bool = False) -> bool:
         """编译SDK"""
         if self.current_config["sdk_built"] and not force:
@@ -321,21 +401,8 @@ class LinxOSBuilder:
             sdk_build_dir.mkdir(exist_ok=True)
             
             # 配置CMake
-            cmake_args = [
-                "cmake",
-                f"-DCMAKE_BUILD_TYPE={self.current_config['build_type']}"
-            ]
-            
-            # 添加工具链文件（如果有）
-            toolchain_file = self.current_config.get('toolchain_file')
-            if toolchain_file:
-                toolchain_path = self.build_dir / "toolchains" / toolchain_file
-                if toolchain_path.exists():
-                    cmake_args.append(f"-DCMAKE_TOOLCHAIN_FILE={toolchain_path}")
-                    log_info(f"使用工具链文件: {toolchain_file}")
-                else:
-                    log_warn(f"工具链文件不存在: {toolchain_path}")
-            
+            config_data = self._parse_config_file(self.config_file) if self.config_file.exists() else {}
+            cmake_args = self._sdk_cmake_args(config_data)
             cmake_args.append(str(sdk_dir))
             
             log_info(f"配置SDK: {' '.join(cmake_args)}")
@@ -370,6 +437,146 @@ class LinxOSBuilder:
             log_error(f"SDK编译过程出错: {e}")
             return False
     
+    def optimize_sdk(self, bench_args: str = "-s 4 -d 10", runner: str = "", cc: str = "") -> bool:
+        """PGO + LTO 编译SDK：插桩编译 → 运行回环基准收集 profile → 按 profile 加 LTO 重新编译并安装，
+        最后对比普通编译和优化后的回环基准，报告各流水线阶段的加速比和各模块代码量"""
+        toolchain_file = self.current_config.get("toolchain_file", "")
+        if self.current_config.get("board") == "esp32" or "esp32" in toolchain_file:
+            log_error("PGO 只支持主机和 Linux 目标，ESP32 固件无法在目标上运行回环基准")
+            return False
+        if toolchain_file and not runner:
+            log_error("交叉编译的 Linux 目标需要用 --runner 指定在目标上运行基准的命令前缀"
+                      "（如 \"qemu-arm -L <sysroot>\"），并用 --cc 指定交叉编译器")
+            return False
+
+        sdk_dir = self.sdk_path / "sdk"
+        bench_dir = sdk_dir / "protocols" / "test"
+        pgo_root = self.build_dir / "pgo"
+        base_dir = pgo_root / "sdk-base"
+        opt_dir = pgo_root / "sdk-opt"
+        profile_dir = pgo_root / "profile"
+        for path in (base_dir, opt_dir, profile_dir):
+            if path.exists():
+                shutil.rmtree(path)
+            path.mkdir(parents=True)
+
+        cc = cc or os.environ.get("CC", "cc")
+        try:
+            version = subprocess.run([cc, "--version"], capture_output=True, text=True).stdout
+        except OSError as e:
+            log_error(f"无法运行编译器 {cc}: {e}")
+            return False
+        is_clang = "clang" in version
+        map_flag = "-Wl,-map," if sys.platform == "darwin" else "-Wl,-Map="
+        runner_cmd = runner.split() if runner else []
+        train_args = bench_args.split()
+        if self.config_file.exists():
+            train_args += ["-C", str(self.config_file)]
+
+        config_data = self._parse_config_file(self.config_file) if self.config_file.exists() else {}
+        common_args = self._sdk_cmake_args(config_data)
+        if not toolchain_file:
+            # 主机目标：SDK 和基准使用同一个编译器，profile 格式才一致
+            common_args.append(f"-DCMAKE_C_COMPILER={cc}")
+
+        def cmake_build(build_dir: Path, extra: List[str], stage: str) -> bool:
+            cmake_args = common_args + [f"-DCMAKE_ARCHIVE_OUTPUT_DIRECTORY={build_dir / 'lib'}"] + extra
+            cmake_args.append(str(sdk_dir))
+            log_info(f"[{stage}] 配置SDK: {' '.join(cmake_args)}")
+            if subprocess.run(cmake_args, cwd=build_dir).returncode != 0:
+                log_error(f"[{stage}] SDK CMake配置失败")
+                return False
+            if subprocess.run(["make", "-j", str(os.cpu_count() or 4)], cwd=build_dir).returncode != 0:
+                log_error(f"[{stage}] SDK编译失败")
+                return False
+            return True
+
+        def build_bench(build_dir: Path, ldflags: str, stage: str) -> Optional[Path]:
+            target = build_dir / "bench_loopback"
+            make_args = ["make", "-C", str(bench_dir), "bench-loopback-lib", f"CC={cc}",
+                         f"LINX_LIB_DIR={build_dir / 'lib'}", f"BENCH_LIB_TARGET={target}",
+                         f"BENCH_LIB_LDFLAGS={ldflags}"]
+            log_info(f"[{stage}] 编译回环基准: {' '.join(make_args)}")
+            if subprocess.run(make_args).returncode != 0:
+                log_error(f"[{stage}] 回环基准编译失败")
+                return None
+            return target
+
+        def run_bench(bench: Path, args: List[str], stage: str) -> bool:
+            run_args = runner_cmd + [str(bench)] + args
+            log_info(f"[{stage}] 运行回环基准: {' '.join(run_args)}")
+            if subprocess.run(run_args, cwd=pgo_root).returncode != 0:
+                log_error(f"[{stage}] 回环基准运行失败")
+                return False
+            return True
+
+        try:
+            # 1. 普通编译，作为对照
+            base_map = base_dir / "bench_loopback.map"
+            if not cmake_build(base_dir, ["-DLINX_PGO=OFF", "-DLINX_ENABLE_LTO=OFF"], "对照"):
+                return False
+            base_bench = build_bench(base_dir, f"{map_flag}{base_map}", "对照")
+            if not base_bench:
+                return False
+
+            # 2. 插桩编译并运行基准收集 profile（GCC 的 .gcda 按目标文件路径存放，
+            #    插桩和优化两次编译必须使用同一个构建目录）
+            if not cmake_build(opt_dir, ["-DLINX_PGO=generate", f"-DLINX_PGO_DIR={profile_dir}",
+                                         "-DLINX_ENABLE_LTO=OFF"], "插桩"):
+                return False
+            train_bench = build_bench(opt_dir, f"-fprofile-generate={profile_dir}", "插桩")
+            if not train_bench or not run_bench(train_bench, train_args, "收集 profile"):
+                return False
+            if is_clang:
+                raw_profiles = [str(p) for p in profile_dir.glob("*.profraw")]
+                if not raw_profiles:
+                    log_error(f"没有收集到 profile: {profile_dir}")
+                    return False
+                profdata = ["xcrun", "llvm-profdata"] if sys.platform == "darwin" else ["llvm-profdata"]
+                merge_args = profdata + ["merge", f"-output={profile_dir / 'default.profdata'}"] + raw_profiles
+                log_info(f"合并 profile: {' '.join(merge_args)}")
+                if subprocess.run(merge_args).returncode != 0:
+                    log_error("profile 合并失败")
+                    return False
+
+            # 3. 按 profile 加 LTO 重新编译
+            opt_map = opt_dir / "bench_loopback.map"
+            if not cmake_build(opt_dir, ["-DLINX_PGO=use", f"-DLINX_PGO_DIR={profile_dir}",
+                                         "-DLINX_ENABLE_LTO=ON"], "PGO + LTO"):
+                return False
+            opt_bench = build_bench(opt_dir, f"-flto -O2 {map_flag}{opt_map}", "PGO + LTO")
+            if not opt_bench:
+                return False
+
+            # 4. 对比两次编译的回环基准
+            base_json = pgo_root / "runtime_base.json"
+            pgo_json = pgo_root / "runtime_pgo.json"
+            if not run_bench(base_bench, train_args + ["-b", str(base_json)], "对照测量") or \
+               not run_bench(opt_bench, train_args + ["-b", str(pgo_json)], "优化后测量"):
+                return False
+            report_path = pgo_root / "pgo_report.md"
+            report_args = [sys.executable, str(bench_dir / "pgo_report.py"),
+                           "--base", str(base_json), "--pgo", str(pgo_json),
+                           "-o", str(report_path), "--json", str(pgo_root / "pgo_report.json")]
+            if base_map.exists() and opt_map.exists():
+                report_args += ["--base-map", str(base_map), "--pgo-map", str(opt_map)]
+            if subprocess.run(report_args, cwd=bench_dir).returncode != 0:
+                log_error("生成优化报告失败")
+                return False
+            print(report_path.read_text(encoding="utf-8"))
+
+            # 5. 安装优化后的SDK，之后编译的 Board 和应用都链接它
+            if subprocess.run(["make", "install"], cwd=opt_dir).returncode != 0:
+                log_error("SDK安装失败")
+                return False
+            self.current_config["sdk_built"] = True
+            log_success(f"PGO + LTO 编译完成，报告: {report_path}")
+            return True
+
+        except Exception as e:
+            log_error(f"PGO 编译过程出错: {e}")
+            return False
+
     def build_board(self, force: bool = False) -> bool:
         """编译Board适配"""
         if not self.current_config["sdk_built"]:
@@ -386,6 +593,12 @@ class LinxOSBuilder:
             board = self.current_config.get("board", "mac")
             board_dir = self.sdk_path / "board" / board
             
+            # ESP32 板级适配是 ESP-IDF 组件，由固件工程经 EXTRA_COMPONENT_DIRS 引入
+            if board == "esp32":
+                log_info(f"ESP32 Board 为 ESP-IDF 组件，请在固件工程的 EXTRA_COMPONENT_DIRS 中加入 {board_dir}")
+                self.current_config["board_built"] = True
+                return True
+            
             if not board_dir.exists():
                 log_error(f"Board目录不存在: {board_dir}")
                 return False
@@ -412,6 +625,12 @@ class LinxOSBuilder:
                     cmake_args.append(f"-DCMAKE_TOOLCHAIN_FILE={toolchain_path}")
                     log_info(f"使用工具链文件: {toolchain_file}")
             
+            # 板级相机驱动随 CONFIG_ENABLE_CAMERA 裁剪
+            config_data = self._parse_config_file(self.config_file) if self.config_file.exists() else {}
+            if config_data.get("CONFIG_ENABLE_CAMERA", "y") == "n":
+                cmake_args.append("-DLINX_ENABLE_CAMERA=OFF")
+                log_info("已裁剪: CONFIG_ENABLE_CAMERA")
+            
             cmake_args.append(str(board_dir))
             
             log_info(f"配置Board: {' '.join(cmake_args)}")
@@ -670,6 +889,12 @@ def main():
     board_parser = subparsers.add_parser("build-board", help="编译Board适配 (已弃用，请使用 build board)")
     board_parser.add_argument("-f", "--force", action="store_true", help="强制重新编译")
     
+    # PGO + LTO 优化编译
+    optimize_parser = subparsers.add_parser("optimize", help="PGO + LTO 编译SDK（主机和 Linux 目标）")
+    optimize_parser.add_argument("--bench-args", default="-s 4 -d 10", help="回环基准参数（训练和测量共用）")
+    optimize_parser.add_argument("--runner", default="", help="在目标上运行基准的命令前缀，交叉编译时必需")
+    optimize_parser.add_argument("--cc", default="", help="编译回环基准的编译器（默认 $CC 或 cc）")
+    
     # 运行项目
     run_parser = subparsers.add_parser("run", help="运行项目")
     run_parser.add_argument("project_type", choices=["apps", "examples"], help="项目类型")
@@ -724,6 +949,8 @@ def main():
             else:
                 log_error(f"无效的编译目标: {args.target}")
                 log_info("可用目标: sdk, board, all, examples, apps <project_name>")
+    elif args.command == "optimize":
+        builder.optimize_sdk(args.bench_args, args.runner, args.cc)
     elif args.command == "run":
         builder.run_project(args.project_type, args.project_name, args.args)
     elif args.command == "clean":
@@ -739,6 +966,7 @@ def main():
         print("  linxos.py build examples         # 编译所有示例")
         print("  linxos.py build examples mac     # 编译mac示例")
         print("  linxos.py run examples mac       # 运行mac示例")
+        print("  linxos.py optimize               # PGO + LTO 编译SDK并报告加速比")
         print("  linxos.py clean                  # 清理所有")
 
 if __name__ == "__main__":
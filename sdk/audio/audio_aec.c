@@ -0,0 +1,737 @@
+#include "audio_aec.h"
+#include "audio_dsp.h"
+#include "audio_ring_buffer.h"
+#include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_AUDIO);
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define AEC_USE_NEON 1
+#else
+#define AEC_USE_NEON 0
+#endif
+
+#define AEC_DEFAULT_TAIL_MS         128
+#define AEC_DEFAULT_DELAY_MS        60
+#define AEC_DEFAULT_FAR_BUFFER_MS   500
+#define AEC_DEFAULT_SUPPRESSION_DB  18
+#define AEC_MAX_ANCHORS             32      // Timestamped reference chunks tracked
+#define AEC_STEP_SIZE               1.0f    // NLMS step, normalized by partitions and bin power
+#define AEC_POWER_SMOOTHING         0.9f
+#define AEC_FAR_ACTIVE_POWER        1e-6f   // -60 dBFS mean square
+#define AEC_DTD_MARGIN              2.0f    // Near peak above predicted echo peak (6 dB)
+#define AEC_DTD_HOLD_MS             60
+#define AEC_DIVERGE_BLOCKS          8       // Error louder than the mic for this long resets the filter
+#define AEC_CONVERGED_ERLE_DB       10.0f
+#define AEC_DTD_RESIDUAL_RATIO      32.0f   // Block residual 15 dB above the smoothed level
+#define AEC_DTD_RESIDUAL_MAX_MS     1000    // Residual-only double talk longer than this is an echo path change
+
+typedef struct {
+    uint64_t index;                 // Reference sample index of pcm[0]
+    uint32_t timestamp;
+} aec_anchor_t;
+
+struct audio_aec {
+    audio_aec_config_t config;
+    size_t block;                   // B: samples per filter block
+    size_t fft_size;                // N = 2B
+    size_t bins;                    // N/2 + 1
+    size_t partitions;              // P
+
+    // FFT tables and scratch (split complex)
+    float* cos_table;
+    float* sin_table;
+    size_t* bitrev;
+    float* fft_re;
+    float* fft_im;
+
+    // Filter state; far spectra ring, newest at x_head
+    float* w_re;
+    float* w_im;
+    float* x_re;
+    float* x_im;
+    size_t x_head;
+    float* power;                   // Smoothed far power per bin
+    float* y_re;
+    float* y_im;
+    float* e_re;
+    float* e_im;
+    float* far_prev;                // Previous far block (first half of the window)
+    float* window;
+    float* far_peaks;               // Per-block |x| maxima over the tail
+    size_t constrain_next;
+    float delta;
+
+    // Far-end reference queue
+    audio_ring_buffer_t* far_ring;
+    pthread_mutex_t anchor_mutex;   // Guards the fields below and far_written
+    aec_anchor_t anchors[AEC_MAX_ANCHORS];
+    size_t anchor_head;
+    size_t anchor_count;
+    uint64_t far_written;
+    uint64_t far_read;
+    bool far_running;
+    bool far_pending;               // Reference queued, latency countdown running
+    size_t far_countdown;           // Near samples to wait before the reference starts
+    short* far_frame;
+    float* far_float;
+    float* near_float;
+
+    // Detector and suppressor state
+    float echo_gain;                // Smoothed echo peak / far tail peak
+    float near_smooth;
+    float error_smooth;
+    int dtd_hold;
+    int dtd_hold_blocks;
+    int dtd_residual_count;
+    int dtd_residual_limit;
+    int diverge_count;
+    float suppress_floor;
+    float suppress_gain;
+    bool converged;
+
+    bool has_far_timestamp;
+    uint32_t far_timestamp;
+    audio_aec_stats_t stats;
+};
+
+// ============================================================================
+// Complex kernels (split real/imaginary arrays)
+// ============================================================================
+
+/* y += w * x */
+static void aec_cmac(float* y_re, float* y_im, const float* w_re, const float* w_im,
+                     const float* x_re, const float* x_im, size_t n) {
+    size_t k = 0;
+#if AEC_USE_NEON
+    for (; k + 4 <= n; k += 4) {
+        float32x4_t wr = vld1q_f32(w_re + k);
+        float32x4_t wi = vld1q_f32(w_im + k);
+        float32x4_t xr = vld1q_f32(x_re + k);
+        float32x4_t xi = vld1q_f32(x_im + k);
+        float32x4_t yr = vld1q_f32(y_re + k);
+        float32x4_t yi = vld1q_f32(y_im + k);
+        yr = vmlaq_f32(yr, wr, xr);
+        yr = vmlsq_f32(yr, wi, xi);
+        yi = vmlaq_f32(yi, wr, xi);
+        yi = vmlaq_f32(yi, wi, xr);
+        vst1q_f32(y_re + k, yr);
+        vst1q_f32(y_im + k, yi);
+    }
+#endif
+    for (; k < n; k++) {
+        y_re[k] += w_re[k] * x_re[k] - w_im[k] * x_im[k];
+        y_im[k] += w_re[k] * x_im[k] + w_im[k] * x_re[k];
+    }
+}
+
+/* w += conj(x) * g */
+static void aec_cupdate(float* w_re, float* w_im, const float* x_re, const float* x_im,
+                        const float* g_re, const float* g_im, size_t n) {
+    size_t k = 0;
+#if AEC_USE_NEON
+    for (; k + 4 <= n; k += 4) {
+        float32x4_t xr = vld1q_f32(x_re + k);
+        float32x4_t xi = vld1q_f32(x_im + k);
+        float32x4_t gr = vld1q_f32(g_re + k);
+        float32x4_t gi = vld1q_f32(g_im + k);
+        float32x4_t wr = vld1q_f32(w_re + k);
+        float32x4_t wi = vld1q_f32(w_im + k);
+        wr = vmlaq_f32(wr, xr, gr);
+        wr = vmlaq_f32(wr, xi, gi);
+        wi = vmlaq_f32(wi, xr, gi);
+        wi = vmlsq_f32(wi, xi, gr);
+        vst1q_f32(w_re + k, wr);
+        vst1q_f32(w_im + k, wi);
+    }
+#endif
+    for (; k < n; k++) {
+        w_re[k] += x_re[k] * g_re[k] + x_im[k] * g_im[k];
+        w_im[k] += x_re[k] * g_im[k] - x_im[k] * g_re[k];
+    }
+}
+
+/* p = a * p + (1 - a) * |x|^2 */
+static void aec_smooth_power(float* p, const float* x_re, const float* x_im, float a, size_t n) {
+    size_t k = 0;
+#if AEC_USE_NEON
+    float32x4_t va = vdupq_n_f32(a);
+    float32x4_t vb = vdupq_n_f32(1.0f - a);
+    for (; k + 4 <= n; k += 4) {
+        float32x4_t xr = vld1q_f32(x_re + k);
+        float32x4_t xi = vld1q_f32(x_im + k);
+        float32x4_t mag = vmlaq_f32(vmulq_f32(xr, xr), xi, xi);
+        vst1q_f32(p + k, vmlaq_f32(vmulq_f32(vld1q_f32(p + k), va), mag, vb));
+    }
+#endif
+    for (; k < n; k++) {
+        p[k] = a * p[k] + (1.0f - a) * (x_re[k] * x_re[k] + x_im[k] * x_im[k]);
+    }
+}
+
+// ============================================================================
+// Real FFT of size N on top of an iterative radix-2 complex FFT
+// ============================================================================
+
+static void aec_fft_complex(audio_aec_t* aec, float* re, float* im, bool inverse) {
+    size_t n = aec->fft_size;
+
+    for (size_t i = 0; i < n; i++) {
+        size_t j = aec->bitrev[i];
+        if (j > i) {
+            float t = re[i]; re[i] = re[j]; re[j] = t;
+            t = im[i]; im[i] = im[j]; im[j] = t;
+        }
+    }
+
+    for (size_t len = 2; len <= n; len <<= 1) {
+        size_t half = len >> 1;
+        size_t step = n / len;
+        for (size_t start = 0; start < n; start += len) {
+            for (size_t k = 0; k < half; k++) {
+                float c = aec->cos_table[k * step];
+                float s = inverse ? aec->sin_table[k * step] : -aec->sin_table[k * step];
+                size_t a = start + k;
+                size_t b = a + half;
+                float tr = re[b] * c - im[b] * s;
+                float ti = re[b] * s + im[b] * c;
+                re[b] = re[a] - tr;
+                im[b] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+            }
+        }
+    }
+}
+
+/* N real samples -> bins 0..N/2 */
+static void aec_fft_forward(audio_aec_t* aec, const float* in, float* out_re, float* out_im) {
+    memcpy(aec->fft_re, in, aec->fft_size * sizeof(float));
+    memset(aec->fft_im, 0, aec->fft_size * sizeof(float));
+    aec_fft_complex(aec, aec->fft_re, aec->fft_im, false);
+    memcpy(out_re, aec->fft_re, aec->bins * sizeof(float));
+    memcpy(out_im, aec->fft_im, aec->bins * sizeof(float));
+}
+
+/* Bins 0..N/2 of a real signal -> N samples, scaled by 1/N */
+static void aec_fft_inverse(audio_aec_t* aec, const float* in_re, const float* in_im, float* out) {
+    size_t n = aec->fft_size;
+    memcpy(aec->fft_re, in_re, aec->bins * sizeof(float));
+    memcpy(aec->fft_im, in_im, aec->bins * sizeof(float));
+    aec->fft_im[0] = 0.0f;
+    aec->fft_im[n / 2] = 0.0f;
+    for (size_t k = 1; k < n / 2; k++) {
+        aec->fft_re[n - k] = in_re[k];
+        aec->fft_im[n - k] = -in_im[k];
+    }
+    aec_fft_complex(aec, aec->fft_re, aec->fft_im, true);
+    float scale = 1.0f / (float)n;
+    for (size_t i = 0; i < n; i++) {
+        out[i] = aec->fft_re[i] * scale;
+    }
+}
+
+// ============================================================================
+// Filter
+// ============================================================================
+
+static void aec_reset_filter(audio_aec_t* aec) {
+    size_t size = aec->partitions * aec->bins * sizeof(float);
+    memset(aec->w_re, 0, size);
+    memset(aec->w_im, 0, size);
+    aec->converged = false;
+    aec->echo_gain = 0.0f;
+    aec->diverge_count = 0;
+}
+
+static void aec_reset_far(audio_aec_t* aec) {
+    size_t size = aec->partitions * aec->bins * sizeof(float);
+    memset(aec->x_re, 0, size);
+    memset(aec->x_im, 0, size);
+    memset(aec->power, 0, aec->bins * sizeof(float));
+    memset(aec->far_prev, 0, aec->block * sizeof(float));
+    memset(aec->far_peaks, 0, aec->partitions * sizeof(float));
+}
+
+/* Keep the time-domain filter of one partition causal (overlap-save gradient constraint) */
+static void aec_constrain(audio_aec_t* aec, size_t p) {
+    float* wr = aec->w_re + p * aec->bins;
+    float* wi = aec->w_im + p * aec->bins;
+    aec_fft_inverse(aec, wr, wi, aec->window);
+    memset(aec->window + aec->block, 0, aec->block * sizeof(float));
+    aec_fft_forward(aec, aec->window, wr, wi);
+}
+
+#define AEC_BLOCK_FAR_ACTIVE   0x1
+#define AEC_BLOCK_DOUBLE_TALK  0x2
+
+/* Cancel one block in place; returns AEC_BLOCK_* flags */
+static int aec_process_block(audio_aec_t* aec, const float* far, float* near) {
+    size_t B = aec->block;
+    size_t K = aec->bins;
+    size_t P = aec->partitions;
+
+    // Far window [previous block, current block] -> newest spectrum
+    aec->x_head = (aec->x_head + P - 1) % P;
+    memcpy(aec->window, aec->far_prev, B * sizeof(float));
+    memcpy(aec->window + B, far, B * sizeof(float));
+    memcpy(aec->far_prev, far, B * sizeof(float));
+    float* x0_re = aec->x_re + aec->x_head * K;
+    float* x0_im = aec->x_im + aec->x_head * K;
+    aec_fft_forward(aec, aec->window, x0_re, x0_im);
+    aec_smooth_power(aec->power, x0_re, x0_im, AEC_POWER_SMOOTHING, K);
+
+    float far_energy = 0.0f;
+    float far_peak = 0.0f;
+    for (size_t i = 0; i < B; i++) {
+        far_energy += far[i] * far[i];
+        float a = fabsf(far[i]);
+        if (a > far_peak) {
+            far_peak = a;
+        }
+    }
+    aec->far_peaks[aec->x_head] = far_peak;
+    float tail_peak = 0.0f;
+    for (size_t p = 0; p < P; p++) {
+        if (aec->far_peaks[p] > tail_peak) {
+            tail_peak = aec->far_peaks[p];
+        }
+    }
+
+    // Echo estimate Y = sum W_p X_p
+    memset(aec->y_re, 0, K * sizeof(float));
+    memset(aec->y_im, 0, K * sizeof(float));
+    for (size_t p = 0; p < P; p++) {
+        size_t slot = (aec->x_head + p) % P;
+        aec_cmac(aec->y_re, aec->y_im, aec->w_re + p * K, aec->w_im + p * K,
+                 aec->x_re + slot * K, aec->x_im + slot * K, K);
+    }
+    aec_fft_inverse(aec, aec->y_re, aec->y_im, aec->window);
+    const float* echo = aec->window + B;
+
+    float near_energy = 0.0f;
+    float error_energy = 0.0f;
+    float near_peak = 0.0f;
+    float echo_peak = 0.0f;
+    float* error = aec->near_float + aec->config.frame_samples; // B floats of scratch
+    for (size_t i = 0; i < B; i++) {
+        error[i] = near[i] - echo[i];
+        near_energy += near[i] * near[i];
+        error_energy += error[i] * error[i];
+        float a = fabsf(near[i]);
+        if (a > near_peak) {
+            near_peak = a;
+        }
+        a = fabsf(echo[i]);
+        if (a > echo_peak) {
+            echo_peak = a;
+        }
+    }
+
+    bool far_active = tail_peak > 0.0f && far_energy > AEC_FAR_ACTIVE_POWER * (float)B;
+
+    // Echo path gain in the peak domain; the estimate does not depend on the near end,
+    // so it keeps tracking while adaptation is frozen
+    if (far_active) {
+        aec->echo_gain = 0.9f * aec->echo_gain + 0.1f * (echo_peak / tail_peak);
+    }
+
+    // Double talk, once the echo path is known: a Geigel test against the predicted
+    // echo peak, plus a residual far above what the filter normally leaves, which
+    // catches near speech at about the echo level. An echo path change looks the same
+    // to the residual test, so a residual-only detection that lasts too long drops the
+    // converged state instead and lets the filter readapt
+    bool double_talk = false;
+    if (far_active && aec->converged) {
+        bool geigel = near_peak > AEC_DTD_MARGIN * aec->echo_gain * tail_peak + 1e-3f;
+        bool residual = error_energy * aec->near_smooth >
+                        AEC_DTD_RESIDUAL_RATIO * near_energy * aec->error_smooth;
+        if (geigel || residual) {
+            aec->dtd_hold = aec->dtd_hold_blocks;
+        }
+        if (residual && !geigel) {
+            if (++aec->dtd_residual_count >= aec->dtd_residual_limit) {
+                aec->converged = false;
+                aec->dtd_hold = 0;
+            }
+        } else {
+            aec->dtd_residual_count = 0;
+        }
+    }
+    if (aec->dtd_hold > 0) {
+        aec->dtd_hold--;
+        double_talk = true;
+    }
+
+    if (far_active && !double_talk) {
+        aec->near_smooth = 0.95f * aec->near_smooth + 0.05f * near_energy;
+        aec->error_smooth = 0.95f * aec->error_smooth + 0.05f * error_energy;
+        if (aec->error_smooth > 0.0f && aec->near_smooth > 0.0f) {
+            aec->stats.erle_db = 10.0f * log10f(aec->near_smooth / aec->error_smooth);
+        }
+        aec->converged = aec->stats.erle_db > AEC_CONVERGED_ERLE_DB;
+
+        // Divergence: the estimate adds energy instead of removing it
+        if (error_energy > 2.0f * near_energy + 1e-9f) {
+            if (++aec->diverge_count >= AEC_DIVERGE_BLOCKS) {
+                aec_reset_filter(aec);
+                aec->stats.resets++;
+            }
+        } else {
+            aec->diverge_count = 0;
+        }
+
+        // NLMS update with per-bin normalization: G = mu / (P * Pxx + delta) * E
+        memset(aec->window, 0, B * sizeof(float));
+        memcpy(aec->window + B, error, B * sizeof(float));
+        aec_fft_forward(aec, aec->window, aec->e_re, aec->e_im);
+        for (size_t k = 0; k < K; k++) {
+            float mu = AEC_STEP_SIZE / ((float)P * aec->power[k] + aec->delta);
+            aec->e_re[k] *= mu;
+            aec->e_im[k] *= mu;
+        }
+        for (size_t p = 0; p < P; p++) {
+            size_t slot = (aec->x_head + p) % P;
+            aec_cupdate(aec->w_re + p * K, aec->w_im + p * K, aec->x_re + slot * K, aec->x_im + slot * K,
+                        aec->e_re, aec->e_im, K);
+        }
+        aec_constrain(aec, aec->constrain_next);
+        aec->constrain_next = (aec->constrain_next + 1) % P;
+    }
+
+    // Never output more than came in
+    const float* result = error_energy > near_energy ? near : error;
+
+    // Residual suppression while only the far end talks; ramp across the block
+    float target = (far_active && !double_talk) ? aec->suppress_floor : 1.0f;
+    float gain = aec->suppress_gain;
+    float step = (target - gain) / (float)B;
+    for (size_t i = 0; i < B; i++) {
+        gain += step;
+        near[i] = result[i] * gain;
+    }
+    aec->suppress_gain = target;
+
+    return (far_active ? AEC_BLOCK_FAR_ACTIVE : 0) | (double_talk ? AEC_BLOCK_DOUBLE_TALK : 0);
+}
+
+// ============================================================================
+// Far-end queue
+// ============================================================================
+
+/* Map a reference sample index to its stream timestamp; caller holds anchor_mutex */
+static bool aec_lookup_timestamp_locked(audio_aec_t* aec, uint64_t index, uint32_t* timestamp) {
+    // Drop anchors superseded by a later one at or before index
+    while (aec->anchor_count > 1) {
+        const aec_anchor_t* next = &aec->anchors[(aec->anchor_head + 1) % AEC_MAX_ANCHORS];
+        if (next->index > index) {
+            break;
+        }
+        aec->anchor_head = (aec->anchor_head + 1) % AEC_MAX_ANCHORS;
+        aec->anchor_count--;
+    }
+    if (aec->anchor_count == 0) {
+        return false;
+    }
+    const aec_anchor_t* anchor = &aec->anchors[aec->anchor_head];
+    if (anchor->index > index) {
+        return false;
+    }
+    *timestamp = anchor->timestamp +
+                 (uint32_t)((index - anchor->index) * 1000 / aec->config.sample_rate);
+    return true;
+}
+
+/* Fill far_frame with the reference aligned to the next near frame */
+static void aec_take_far(audio_aec_t* aec, size_t samples) {
+    size_t delay = (size_t)aec->config.delay_ms * aec->config.sample_rate / 1000;
+    size_t available = audio_ring_buffer_available_read(aec->far_ring);
+    size_t got = 0;
+
+    if (!aec->far_running && available > 0) {
+        // Playback (re)started: its echo reaches the mic after the device latency
+        if (!aec->far_pending) {
+            aec->far_pending = true;
+            aec->far_countdown = delay;
+        }
+        if (aec->far_countdown >= samples) {
+            aec->far_countdown -= samples;
+        } else {
+            aec->far_running = true;
+            aec->far_pending = false;
+        }
+    }
+
+    size_t lead = 0;
+    if (aec->far_running) {
+        // The first frame after the countdown starts part way in
+        lead = aec->far_countdown;
+        aec->far_countdown = 0;
+        memset(aec->far_frame, 0, lead * sizeof(short));
+        got = audio_ring_buffer_read(aec->far_ring, aec->far_frame + lead, samples - lead);
+        if (got < samples - lead) {
+            // Playback stopped or underran; wait for the latency again when it resumes
+            aec->far_running = false;
+            aec->stats.far_realigns++;
+        }
+    }
+    memset(aec->far_frame + lead + got, 0, (samples - lead - got) * sizeof(short));
+
+    pthread_mutex_lock(&aec->anchor_mutex);
+    uint64_t start = aec->far_read;
+    aec->far_read += got;
+    aec->has_far_timestamp = got > 0 && aec_lookup_timestamp_locked(aec, start, &aec->far_timestamp);
+    if (aec->has_far_timestamp) {
+        // Stream time at the start of the frame, before any lead-in silence
+        aec->far_timestamp -= (uint32_t)(lead * 1000 / aec->config.sample_rate);
+    }
+    pthread_mutex_unlock(&aec->anchor_mutex);
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+static size_t aec_pick_block(size_t frame_samples) {
+    static const size_t sizes[] = { 128, 64, 32, 16 };
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        if (frame_samples % sizes[i] == 0) {
+            return sizes[i];
+        }
+    }
+    return 0;
+}
+
+audio_aec_t* audio_aec_create(const audio_aec_config_t* config) {
+    if (!config || config->sample_rate == 0 || config->frame_samples == 0) {
+        LOG_ERROR("Invalid AEC configuration");
+        return NULL;
+    }
+
+    size_t block = aec_pick_block(config->frame_samples);
+    if (block == 0) {
+        LOG_ERROR("AEC frame size %zu is not a multiple of 16 samples", config->frame_samples);
+        return NULL;
+    }
+
+    audio_aec_t* aec = (audio_aec_t*)LINX_CALLOC(1, sizeof(audio_aec_t));
+    if (!aec) {
+        return NULL;
+    }
+
+    aec->config = *config;
+    pthread_mutex_init(&aec->anchor_mutex, NULL);
+    if (aec->config.tail_ms <= 0) {
+        aec->config.tail_ms = AEC_DEFAULT_TAIL_MS;
+    }
+    if (aec->config.delay_ms <= 0) {
+        aec->config.delay_ms = AEC_DEFAULT_DELAY_MS;
+    }
+    if (aec->config.far_buffer_ms <= 0) {
+        aec->config.far_buffer_ms = AEC_DEFAULT_FAR_BUFFER_MS;
+    }
+    if (aec->config.max_suppression_db == 0) {
+        aec->config.max_suppression_db = AEC_DEFAULT_SUPPRESSION_DB;
+    }
+
+    size_t tail = (size_t)aec->config.tail_ms * config->sample_rate / 1000;
+    aec->block = block;
+    aec->fft_size = block * 2;
+    aec->bins = block + 1;
+    aec->partitions = (tail + block - 1) / block;
+    if (aec->partitions == 0) {
+        aec->partitions = 1;
+    }
+
+    size_t N = aec->fft_size;
+    size_t K = aec->bins;
+    size_t PK = aec->partitions * K;
+    aec->cos_table = (float*)LINX_MALLOC(N / 2 * sizeof(float));
+    aec->sin_table = (float*)LINX_MALLOC(N / 2 * sizeof(float));
+    aec->bitrev = (size_t*)LINX_MALLOC(N * sizeof(size_t));
+    aec->fft_re = (float*)LINX_MALLOC(N * sizeof(float));
+    aec->fft_im = (float*)LINX_MALLOC(N * sizeof(float));
+    aec->w_re = (float*)LINX_CALLOC(PK, sizeof(float));
+    aec->w_im = (float*)LINX_CALLOC(PK, sizeof(float));
+    aec->x_re = (float*)LINX_CALLOC(PK, sizeof(float));
+    aec->x_im = (float*)LINX_CALLOC(PK, sizeof(float));
+    aec->power = (float*)LINX_CALLOC(K, sizeof(float));
+    aec->y_re = (float*)LINX_MALLOC(K * sizeof(float));
+    aec->y_im = (float*)LINX_MALLOC(K * sizeof(float));
+    aec->e_re = (float*)LINX_MALLOC(K * sizeof(float));
+    aec->e_im = (float*)LINX_MALLOC(K * sizeof(float));
+    aec->far_prev = (float*)LINX_CALLOC(block, sizeof(float));
+    aec->window = (float*)LINX_MALLOC(N * sizeof(float));
+    aec->far_peaks = (float*)LINX_CALLOC(aec->partitions, sizeof(float));
+    aec->far_frame = (short*)LINX_MALLOC(config->frame_samples * sizeof(short));
+    aec->far_float = (float*)LINX_MALLOC(config->frame_samples * sizeof(float));
+    aec->near_float = (float*)LINX_MALLOC((config->frame_samples + block) * sizeof(float));
+    aec->far_ring = audio_ring_buffer_create((size_t)aec->config.far_buffer_ms * config->sample_rate / 1000);
+
+    if (!aec->cos_table || !aec->sin_table || !aec->bitrev || !aec->fft_re || !aec->fft_im ||
+        !aec->w_re || !aec->w_im || !aec->x_re || !aec->x_im || !aec->power ||
+        !aec->y_re || !aec->y_im || !aec->e_re || !aec->e_im || !aec->far_prev || !aec->window ||
+        !aec->far_peaks || !aec->far_frame || !aec->far_float || !aec->near_float || !aec->far_ring) {
+        LOG_ERROR("Failed to allocate AEC state");
+        audio_aec_destroy(aec);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < N / 2; i++) {
+        double angle = 2.0 * M_PI * (double)i / (double)N;
+        aec->cos_table[i] = (float)cos(angle);
+        aec->sin_table[i] = (float)sin(angle);
+    }
+    size_t bits = 0;
+    while (((size_t)1 << bits) < N) {
+        bits++;
+    }
+    for (size_t i = 0; i < N; i++) {
+        size_t r = 0;
+        for (size_t b = 0; b < bits; b++) {
+            if (i & ((size_t)1 << b)) {
+                r |= (size_t)1 << (bits - 1 - b);
+            }
+        }
+        aec->bitrev[i] = r;
+    }
+
+    // Regularization: far power of a -60 dBFS signal per bin
+    aec->delta = (float)aec->partitions * AEC_FAR_ACTIVE_POWER * (float)N * (float)block;
+    aec->dtd_hold_blocks = (int)((size_t)AEC_DTD_HOLD_MS * config->sample_rate / 1000 / block);
+    aec->dtd_residual_limit = (int)((size_t)AEC_DTD_RESIDUAL_MAX_MS * config->sample_rate / 1000 / block);
+    aec->suppress_floor = aec->config.max_suppression_db > 0 ?
+                          powf(10.0f, -(float)aec->config.max_suppression_db / 20.0f) : 1.0f;
+    aec->suppress_gain = 1.0f;
+
+    LOG_INFO("AEC created: %u Hz, block %zu, %zu partitions (%d ms tail), delay %d ms%s",
+             config->sample_rate, block, aec->partitions, aec->config.tail_ms, aec->config.delay_ms,
+             AEC_USE_NEON ? ", NEON" : "");
+    return aec;
+}
+
+void audio_aec_destroy(audio_aec_t* aec) {
+    if (!aec) {
+        return;
+    }
+    pthread_mutex_destroy(&aec->anchor_mutex);
+    audio_ring_buffer_destroy(aec->far_ring);
+    LINX_FREE(aec->cos_table);
+    LINX_FREE(aec->sin_table);
+    LINX_FREE(aec->bitrev);
+    LINX_FREE(aec->fft_re);
+    LINX_FREE(aec->fft_im);
+    LINX_FREE(aec->w_re);
+    LINX_FREE(aec->w_im);
+    LINX_FREE(aec->x_re);
+    LINX_FREE(aec->x_im);
+    LINX_FREE(aec->power);
+    LINX_FREE(aec->y_re);
+    LINX_FREE(aec->y_im);
+    LINX_FREE(aec->e_re);
+    LINX_FREE(aec->e_im);
+    LINX_FREE(aec->far_prev);
+    LINX_FREE(aec->window);
+    LINX_FREE(aec->far_peaks);
+    LINX_FREE(aec->far_frame);
+    LINX_FREE(aec->far_float);
+    LINX_FREE(aec->near_float);
+    LINX_FREE(aec);
+}
+
+size_t audio_aec_feed_far(audio_aec_t* aec, const short* pcm, size_t samples, const uint32_t* timestamp) {
+    if (!aec || !pcm || samples == 0) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&aec->anchor_mutex);
+    size_t written = audio_ring_buffer_write(aec->far_ring, pcm, samples);
+    if (timestamp && written > 0) {
+        if (aec->anchor_count == AEC_MAX_ANCHORS) {
+            aec->anchor_head = (aec->anchor_head + 1) % AEC_MAX_ANCHORS;
+            aec->anchor_count--;
+        }
+        aec_anchor_t* anchor = &aec->anchors[(aec->anchor_head + aec->anchor_count) % AEC_MAX_ANCHORS];
+        anchor->index = aec->far_written;
+        anchor->timestamp = *timestamp;
+        aec->anchor_count++;
+    }
+    aec->far_written += written;
+    pthread_mutex_unlock(&aec->anchor_mutex);
+    return written;
+}
+
+int audio_aec_process(audio_aec_t* aec, const short* near, short* out, size_t samples) {
+    if (!aec || !near || !out || samples != aec->config.frame_samples) {
+        return -1;
+    }
+
+    aec_take_far(aec, samples);
+
+    audio_dsp_s16_to_float(aec->far_frame, aec->far_float, samples);
+    audio_dsp_s16_to_float(near, aec->near_float, samples);
+
+    int flags = 0;
+    for (size_t offset = 0; offset < samples; offset += aec->block) {
+        flags |= aec_process_block(aec, aec->far_float + offset, aec->near_float + offset);
+    }
+
+    audio_dsp_float_to_s16(aec->near_float, out, samples);
+
+    aec->stats.frames++;
+    if (flags & AEC_BLOCK_FAR_ACTIVE) {
+        aec->stats.far_active_frames++;
+    }
+    if (flags & AEC_BLOCK_DOUBLE_TALK) {
+        aec->stats.double_talk_frames++;
+    }
+    return 0;
+}
+
+bool audio_aec_get_far_timestamp(const audio_aec_t* aec, uint32_t* timestamp) {
+    if (!aec || !timestamp || !aec->has_far_timestamp) {
+        return false;
+    }
+    *timestamp = aec->far_timestamp;
+    return true;
+}
+
+bool audio_aec_get_stats(const audio_aec_t* aec, audio_aec_stats_t* stats) {
+    if (!aec || !stats) {
+        return false;
+    }
+    *stats = aec->stats;
+    return true;
+}
+
+void audio_aec_reset(audio_aec_t* aec) {
+    if (!aec) {
+        return;
+    }
+
+    pthread_mutex_lock(&aec->anchor_mutex);
+    audio_ring_buffer_discard(aec->far_ring);
+    aec->far_read = aec->far_written;
+    aec->anchor_head = 0;
+    aec->anchor_count = 0;
+    pthread_mutex_unlock(&aec->anchor_mutex);
+
+    aec->far_running = false;
+    aec->far_pending = false;
+    aec->far_countdown = 0;
+    aec->has_far_timestamp = false;
+    aec_reset_filter(aec);
+    aec_reset_far(aec);
+    aec->near_smooth = 0.0f;
+    aec->error_smooth = 0.0f;
+    aec->dtd_hold = 0;
+    aec->dtd_residual_count = 0;
+    aec->suppress_gain = 1.0f;
+    aec->stats.erle_db = 0.0f;
+}
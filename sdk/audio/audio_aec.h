@@ -0,0 +1,115 @@
+#ifndef AUDIO_AEC_H
+#define AUDIO_AEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Acoustic echo canceller for full-duplex (realtime) listening
+ *
+ * Sits between audio_interface_read() and the encoder. The playback side
+ * feeds every block of PCM it hands to the device as the far-end
+ * reference; the capture side runs each captured frame through
+ * audio_aec_process(), which subtracts the estimated echo of that
+ * reference.
+ *
+ * The canceller is a partitioned-block frequency-domain NLMS filter
+ * (overlap-save), the same family as the speex MDF and WebRTC AEC. The
+ * block size is the largest of 128/64/32/16 samples that divides the
+ * capture frame, so every AudioInterface period is a whole number of
+ * blocks. A double-talk detector (Geigel test plus a residual level check)
+ * freezes adaptation while the near end talks, and an optional residual
+ * suppressor attenuates what is left of the echo while only the far end
+ * is active, so barge-in still gets through at full level.
+ *
+ * Alignment: reference samples wait in a queue until `delay_ms` worth is
+ * buffered, which models the playback + capture latency of the device;
+ * the adaptive filter covers the remaining `tail_ms`. The queue is
+ * re-aligned when playback stops or drifts. The stream timestamp of the
+ * reference aligned with the last processed frame is available from
+ * audio_aec_get_far_timestamp() (protocol v2 uplink timestamp, used by
+ * server-side AEC).
+ *
+ * Mono 16-bit only. audio_aec_feed_far() and audio_aec_process() may run
+ * on different threads (one each); everything else belongs to the capture
+ * thread. The inner loops use NEON on ARM builds.
+ */
+typedef struct audio_aec audio_aec_t;
+
+/**
+ * Canceller configuration; zero fields take the defaults
+ */
+typedef struct {
+    unsigned int sample_rate;       // Sample rate (required)
+    size_t frame_samples;           // Samples per audio_aec_process() call (required)
+    int tail_ms;                    // Echo tail covered by the filter (default 128)
+    int delay_ms;                   // Playback write -> capture read latency (default 60)
+    int far_buffer_ms;              // Reference queue capacity (default 500)
+    int max_suppression_db;         // Residual echo suppression while only the far end talks
+                                    // (default 18, negative disables)
+} audio_aec_config_t;
+
+/**
+ * Canceller statistics
+ */
+typedef struct {
+    uint64_t frames;                // Frames processed
+    uint64_t far_active_frames;     // Frames with a far-end reference
+    uint64_t double_talk_frames;    // Frames where adaptation was frozen by near-end speech
+    uint64_t resets;                // Filter resets after divergence
+    uint64_t far_realigns;          // Reference queue re-alignments (underrun or drift)
+    float erle_db;                  // Smoothed echo return loss enhancement
+} audio_aec_stats_t;
+
+/**
+ * Create a canceller
+ * @return Canceller instance or NULL on failure (unsupported frame size)
+ */
+audio_aec_t* audio_aec_create(const audio_aec_config_t* config);
+
+/**
+ * Destroy a canceller
+ */
+void audio_aec_destroy(audio_aec_t* aec);
+
+/**
+ * Queue far-end reference PCM (playback thread or device callback)
+ * @param timestamp Stream timestamp of pcm[0] in ms, NULL if unknown
+ * @return Samples queued; the rest did not fit
+ */
+size_t audio_aec_feed_far(audio_aec_t* aec, const short* pcm, size_t samples, const uint32_t* timestamp);
+
+/**
+ * Cancel the echo in one captured frame (capture thread)
+ * @param near Captured PCM, config.frame_samples samples
+ * @param out Echo-cancelled PCM, may be the same buffer as near
+ * @return 0 on success, -1 on invalid input
+ */
+int audio_aec_process(audio_aec_t* aec, const short* near, short* out, size_t samples);
+
+/**
+ * Stream timestamp of the reference aligned with the last processed frame
+ * @return false while no timestamped reference is playing
+ */
+bool audio_aec_get_far_timestamp(const audio_aec_t* aec, uint32_t* timestamp);
+
+/**
+ * Get statistics
+ */
+bool audio_aec_get_stats(const audio_aec_t* aec, audio_aec_stats_t* stats);
+
+/**
+ * Forget the learned echo path and the queued reference (capture thread)
+ */
+void audio_aec_reset(audio_aec_t* aec);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIO_AEC_H
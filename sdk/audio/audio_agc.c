@@ -0,0 +1,226 @@
+#include "audio_agc.h"
+#include "audio_dsp.h"
+#include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
+#include <string.h>
+#include <math.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define AGC_USE_NEON 1
+#else
+#define AGC_USE_NEON 0
+#endif
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_AUDIO);
+
+#define AGC_DEFAULT_TARGET_DBFS     (-18)
+#define AGC_DEFAULT_MAX_GAIN_DB     24
+#define AGC_DEFAULT_MAX_CUT_DB      12
+#define AGC_DEFAULT_GATE_DBFS       (-50)
+#define AGC_DEFAULT_ATTACK_MS       20
+#define AGC_DEFAULT_RELEASE_MS      500
+#define AGC_MAX_GAIN_DB             24      // Keeps the Q12 gain times a sample inside int32
+#define AGC_UNITY_Q12               4096
+#define AGC_PEAK_LIMIT              32000
+#define AGC_RAMP_SHIFT              8       // Ramp accumulator is Q12 << 8
+
+struct audio_agc {
+    audio_agc_config_t config;
+    int32_t target_rms;
+    int32_t gate_rms;
+    int32_t max_gain_q12;
+    int32_t min_gain_q12;
+    int32_t attack_q15;         // Per-frame smoothing coefficients
+    int32_t release_q15;
+
+    int32_t gain_q12;           // Atomic: read by get_stats
+
+    // Atomic counters
+    uint64_t frames;
+    uint64_t gated_frames;
+    uint64_t limited_frames;
+};
+
+static uint32_t agc_isqrt64(uint64_t x) {
+    uint64_t root = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+    while (bit > x) {
+        bit >>= 2;
+    }
+    while (bit) {
+        if (x >= root + bit) {
+            x -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)root;
+}
+
+static int32_t agc_db_to_q12(int db) {
+    return (int32_t)lrint(pow(10.0, (double)db / 20.0) * AGC_UNITY_Q12);
+}
+
+static int32_t agc_coefficient_q15(int frame_ms, int time_ms) {
+    if (time_ms <= frame_ms) {
+        return 32768;
+    }
+    return (int32_t)((int64_t)frame_ms * 32768 / time_ms);
+}
+
+audio_agc_t* audio_agc_create(const audio_agc_config_t* config) {
+    if (!config || config->sample_rate == 0 || config->frame_samples == 0) {
+        LOG_ERROR("Invalid AGC parameters");
+        return NULL;
+    }
+    audio_agc_t* agc = (audio_agc_t*)LINX_CALLOC(1, sizeof(audio_agc_t));
+    if (!agc) {
+        LOG_ERROR("Failed to allocate AGC");
+        return NULL;
+    }
+    agc->config = *config;
+    audio_agc_config_t* c = &agc->config;
+    if (c->channels <= 0) {
+        c->channels = 1;
+    }
+    if (c->target_dbfs >= 0) {
+        c->target_dbfs = AGC_DEFAULT_TARGET_DBFS;
+    }
+    if (c->max_gain_db <= 0) {
+        c->max_gain_db = AGC_DEFAULT_MAX_GAIN_DB;
+    }
+    if (c->max_gain_db > AGC_MAX_GAIN_DB) {
+        LOG_WARN("AGC max gain %d dB clamped to %d dB", c->max_gain_db, AGC_MAX_GAIN_DB);
+        c->max_gain_db = AGC_MAX_GAIN_DB;
+    }
+    if (c->max_cut_db <= 0) {
+        c->max_cut_db = AGC_DEFAULT_MAX_CUT_DB;
+    }
+    if (c->noise_gate_dbfs >= 0) {
+        c->noise_gate_dbfs = AGC_DEFAULT_GATE_DBFS;
+    }
+    if (c->attack_ms <= 0) {
+        c->attack_ms = AGC_DEFAULT_ATTACK_MS;
+    }
+    if (c->release_ms <= 0) {
+        c->release_ms = AGC_DEFAULT_RELEASE_MS;
+    }
+
+    // Levels and coefficients are converted once; the frame path is integer only
+    agc->target_rms = (int32_t)lrint(pow(10.0, (double)c->target_dbfs / 20.0) * 32768.0);
+    agc->gate_rms = (int32_t)lrint(pow(10.0, (double)c->noise_gate_dbfs / 20.0) * 32768.0);
+    agc->max_gain_q12 = agc_db_to_q12(c->max_gain_db);
+    agc->min_gain_q12 = agc_db_to_q12(-c->max_cut_db);
+    int frame_ms = (int)(config->frame_samples / (size_t)c->channels * 1000 / config->sample_rate);
+    if (frame_ms <= 0) {
+        frame_ms = 1;
+    }
+    agc->attack_q15 = agc_coefficient_q15(frame_ms, c->attack_ms);
+    agc->release_q15 = agc_coefficient_q15(frame_ms, c->release_ms);
+    agc->gain_q12 = AGC_UNITY_Q12;
+
+    LOG_INFO("AGC created: target %d dBFS, gain -%d..+%d dB, gate %d dBFS%s",
+             c->target_dbfs, c->max_cut_db, c->max_gain_db, c->noise_gate_dbfs,
+             AGC_USE_NEON ? ", NEON" : "");
+    return agc;
+}
+
+void audio_agc_destroy(audio_agc_t* agc) {
+    LINX_FREE(agc);
+}
+
+/* out = in * gain, gain ramped linearly from `from` to `to` (Q12) */
+static void agc_apply_ramp(const short* in, short* out, size_t count, int32_t from, int32_t to) {
+    int32_t acc = from << AGC_RAMP_SHIFT;
+    int32_t step = (int32_t)((int64_t)(to - from) * (1 << AGC_RAMP_SHIFT) / (int64_t)count);
+    size_t i = 0;
+#if AGC_USE_NEON
+    const int32_t lanes[4] = { 0, 1, 2, 3 };
+    int32x4_t vacc = vmlaq_n_s32(vdupq_n_s32(acc), vld1q_s32(lanes), step);
+    int32x4_t vstep = vdupq_n_s32(step * 4);
+    for (; i + 4 <= count; i += 4) {
+        int32x4_t g = vshrq_n_s32(vacc, AGC_RAMP_SHIFT);
+        int32x4_t x = vmovl_s16(vld1_s16(in + i));
+        vst1_s16(out + i, vqrshrn_n_s32(vmulq_s32(x, g), 12));
+        vacc = vaddq_s32(vacc, vstep);
+    }
+    acc += step * (int32_t)i;
+#endif
+    for (; i < count; i++) {
+        int32_t v = (in[i] * (acc >> AGC_RAMP_SHIFT) + (1 << 11)) >> 12;
+        out[i] = (short)(v > 32767 ? 32767 : (v < -32768 ? -32768 : v));
+        acc += step;
+    }
+}
+
+int audio_agc_process(audio_agc_t* agc, const short* in, short* out, size_t samples) {
+    if (!agc || !in || !out || samples == 0) {
+        return -1;
+    }
+    uint64_t sum_squares = 0;
+    int peak = 0;
+    audio_dsp_level(in, samples, &sum_squares, &peak);
+    int32_t rms = (int32_t)agc_isqrt64(sum_squares / samples);
+
+    int32_t gain = agc->gain_q12;
+    int32_t want = gain;
+    if (rms < agc->gate_rms) {
+        __atomic_add_fetch(&agc->gated_frames, 1, __ATOMIC_RELAXED);
+    } else {
+        want = (int32_t)((int64_t)agc->target_rms * AGC_UNITY_Q12 / rms);
+        want = want > agc->max_gain_q12 ? agc->max_gain_q12 : want;
+        want = want < agc->min_gain_q12 ? agc->min_gain_q12 : want;
+    }
+
+    int32_t coefficient = want < gain ? agc->attack_q15 : agc->release_q15;
+    int32_t next = gain + (int32_t)(((int64_t)(want - gain) * coefficient) >> 15);
+
+    // The peak limit acts at once, without smoothing, on both ends of the ramp: a loud
+    // onset after a quiet stretch would otherwise clip while the gain is still ramping down
+    if (peak > 0) {
+        int64_t limit = (int64_t)AGC_PEAK_LIMIT * AGC_UNITY_Q12 / peak;
+        if (next > limit || gain > limit) {
+            next = next > limit ? (int32_t)limit : next;
+            gain = gain > limit ? (int32_t)limit : gain;
+            __atomic_add_fetch(&agc->limited_frames, 1, __ATOMIC_RELAXED);
+        }
+    }
+
+    agc_apply_ramp(in, out, samples, gain, next);
+    __atomic_store_n(&agc->gain_q12, next, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&agc->frames, 1, __ATOMIC_RELAXED);
+    return 0;
+}
+
+void audio_agc_reset(audio_agc_t* agc) {
+    if (agc) {
+        __atomic_store_n(&agc->gain_q12, AGC_UNITY_Q12, __ATOMIC_RELAXED);
+    }
+}
+
+bool audio_agc_get_stats(const audio_agc_t* agc, audio_agc_stats_t* stats) {
+    if (!agc || !stats) {
+        return false;
+    }
+    stats->frames = __atomic_load_n(&agc->frames, __ATOMIC_RELAXED);
+    stats->gated_frames = __atomic_load_n(&agc->gated_frames, __ATOMIC_RELAXED);
+    stats->limited_frames = __atomic_load_n(&agc->limited_frames, __ATOMIC_RELAXED);
+    stats->gain_q12 = __atomic_load_n(&agc->gain_q12, __ATOMIC_RELAXED);
+    return true;
+}
+
+static int agc_stage_process(void* ctx, const short* in, short* out, size_t samples) {
+    return audio_agc_process((audio_agc_t*)ctx, in, out, samples);
+}
+
+static void agc_stage_reset(void* ctx) {
+    audio_agc_reset((audio_agc_t*)ctx);
+}
+
+audio_stage_t audio_agc_stage(audio_agc_t* agc) {
+    audio_stage_t stage = { "agc", agc_stage_process, agc_stage_reset, AUDIO_STAGE_IN_PLACE, agc, 0 };
+    return stage;
+}
@@ -0,0 +1,95 @@
+#ifndef AUDIO_AGC_H
+#define AUDIO_AGC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "audio_pipeline.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Fixed-point automatic gain control for the uplink
+ *
+ * Brings speech to `target_dbfs` RMS per frame: quiet talkers across the
+ * room are raised up to `max_gain_db`, loud ones close to the microphone
+ * are turned down, and a per-frame peak limit keeps the result out of
+ * clipping. Frames below `noise_gate_dbfs` hold the current gain, so
+ * pauses do not pump the background up. The gain falls with `attack_ms`
+ * and rises with `release_ms`, and is ramped linearly across each frame
+ * so changes do not click.
+ *
+ * Gains are Q12 integers and the level is an integer RMS, so the frame
+ * path needs no FPU (RISC-V32); the gain ramp uses NEON on ARM builds.
+ * Works on whole AudioInterface frames, no buffering and no latency.
+ *
+ * Mono or interleaved 16-bit. Not thread-safe: run it on the capture
+ * thread after noise suppression, so the noise is not amplified.
+ */
+typedef struct audio_agc audio_agc_t;
+
+/**
+ * AGC configuration; zero fields take the defaults
+ */
+typedef struct {
+    unsigned int sample_rate;       // Sample rate (required)
+    size_t frame_samples;           // Samples per audio_agc_process() call, all channels (required)
+    int channels;                   // Interleaved channels (default 1)
+    int target_dbfs;                // Target RMS level, negative (default -18)
+    int max_gain_db;                // Largest boost, at most 24 (default 24)
+    int max_cut_db;                 // Largest attenuation (default 12)
+    int noise_gate_dbfs;            // Frames below this level hold the gain (default -50)
+    int attack_ms;                  // Time constant for falling gain (default 20)
+    int release_ms;                 // Time constant for rising gain (default 500)
+} audio_agc_config_t;
+
+/**
+ * AGC statistics
+ */
+typedef struct {
+    uint64_t frames;                // Frames processed
+    uint64_t gated_frames;          // Frames below the noise gate
+    uint64_t limited_frames;        // Frames where the peak limit lowered the gain
+    int gain_q12;                   // Current gain (4096 = 0 dB)
+} audio_agc_stats_t;
+
+/**
+ * Create an AGC
+ * @return AGC instance or NULL on failure
+ */
+audio_agc_t* audio_agc_create(const audio_agc_config_t* config);
+
+/**
+ * Destroy an AGC
+ */
+void audio_agc_destroy(audio_agc_t* agc);
+
+/**
+ * Apply the gain to one frame
+ * @param out Output, may be the same buffer as in
+ * @return 0 on success, -1 on invalid input
+ */
+int audio_agc_process(audio_agc_t* agc, const short* in, short* out, size_t samples);
+
+/**
+ * Return to unity gain
+ */
+void audio_agc_reset(audio_agc_t* agc);
+
+/**
+ * Get statistics (any thread)
+ */
+bool audio_agc_get_stats(const audio_agc_t* agc, audio_agc_stats_t* stats);
+
+/**
+ * Pipeline stage running the AGC (in place)
+ */
+audio_stage_t audio_agc_stage(audio_agc_t* agc);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIO_AGC_H
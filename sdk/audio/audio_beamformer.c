@@ -0,0 +1,435 @@
+#include "audio_beamformer.h"
+#include "audio_dsp.h"
+#include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
+#include <string.h>
+#include <math.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define BF_USE_NEON 1
+#define BF_USE_SSE2 0
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define BF_USE_NEON 0
+#define BF_USE_SSE2 1
+#else
+#define BF_USE_NEON 0
+#define BF_USE_SSE2 0
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_AUDIO);
+
+#define BF_TAPS                     4       // Lagrange fractional delay taps
+#define BF_BASE_DELAY               1       // Taps are centred on a delay of 1..2 samples
+#define BF_DEFAULT_BEAMS            8
+#define BF_DEFAULT_HYSTERESIS_DB    2
+#define BF_DEFAULT_HOLD_MS          200
+#define BF_DEFAULT_SPEED_OF_SOUND   343.0f
+#define BF_ENERGY_SMOOTHING         0.25f   // Weight of the newest frame in the beam energy
+#define BF_COLLINEAR_MM             1.0f    // Largest distance from the line that still counts as linear
+#define BF_Q15_ONE                  32768
+
+typedef struct {
+    float azimuth_deg;
+    int shift[AUDIO_BEAMFORMER_MAX_MICS];               // Integer part of the steering delay
+    int16_t taps[AUDIO_BEAMFORMER_MAX_MICS][BF_TAPS];   // Fractional part, Q15, 1/N folded in
+} bf_beam_t;
+
+struct audio_beamformer {
+    audio_beamformer_config_t config;
+    size_t mics;
+    size_t frame;               // Samples per channel per frame
+    size_t history;             // Samples kept in front of every channel
+    size_t stride;              // Samples between channels in `planar`
+
+    bf_beam_t beams[AUDIO_BEAMFORMER_MAX_BEAMS];
+    size_t beam_count;
+    int max_shift;
+
+    int16_t* planar;            // mics * stride: [history | frame] per channel
+    int32_t* acc;               // Beam accumulator, frame
+    int16_t* scratch;           // Beams that are not output
+    int16_t* fade;              // Previous beam while a switch crossfades
+    float energy[AUDIO_BEAMFORMER_MAX_BEAMS];
+
+    size_t beam;                // Current output beam
+    int fade_from;              // Beam faded out over this frame, or -1
+    int candidate;              // Beam holding the lead, or -1
+    int lead_ms;                // How long it has held it
+    float lead_ratio;           // Energy ratio that counts as a lead
+
+    uint64_t frames;
+    uint64_t switches;
+};
+
+// ============================================================================
+// Geometry helpers
+// ============================================================================
+
+void audio_beamformer_linear_array(audio_beamformer_config_t* config, int mics, float spacing_mm) {
+    if (!config || mics < 1 || mics > AUDIO_BEAMFORMER_MAX_MICS) {
+        return;
+    }
+    config->channels = mics;
+    for (int m = 0; m < mics; m++) {
+        config->mic_x_mm[m] = spacing_mm * (float)m;
+        config->mic_y_mm[m] = 0.0f;
+    }
+}
+
+void audio_beamformer_circular_array(audio_beamformer_config_t* config, int mics, float radius_mm) {
+    if (!config || mics < 1 || mics > AUDIO_BEAMFORMER_MAX_MICS) {
+        return;
+    }
+    config->channels = mics;
+    for (int m = 0; m < mics; m++) {
+        double a = 2.0 * M_PI * (double)m / (double)mics;
+        config->mic_x_mm[m] = (float)(radius_mm * cos(a));
+        config->mic_y_mm[m] = (float)(radius_mm * sin(a));
+    }
+}
+
+static bool bf_is_collinear(const audio_beamformer_config_t* config) {
+    // Line through the first microphone and the one farthest from it
+    const float x0 = config->mic_x_mm[0];
+    const float y0 = config->mic_y_mm[0];
+    float dx = 0.0f;
+    float dy = 0.0f;
+    float len = 0.0f;
+    for (int m = 1; m < config->channels; m++) {
+        float ex = config->mic_x_mm[m] - x0;
+        float ey = config->mic_y_mm[m] - y0;
+        float l = sqrtf(ex * ex + ey * ey);
+        if (l > len) {
+            dx = ex;
+            dy = ey;
+            len = l;
+        }
+    }
+    if (len <= 0.0f) {
+        return true;
+    }
+    for (int m = 1; m < config->channels; m++) {
+        float ex = config->mic_x_mm[m] - x0;
+        float ey = config->mic_y_mm[m] - y0;
+        if (fabsf(ex * dy - ey * dx) / len > BF_COLLINEAR_MM) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Steering delays for one look direction
+ * A plane wave from `azimuth` reaches the microphone farthest along it first,
+ * so that one is delayed the most; every delay gets BF_BASE_DELAY on top so
+ * the fractional part falls in the well-behaved middle of the 4-tap filter.
+ */
+static void bf_steer(audio_beamformer_t* bf, bf_beam_t* beam, float azimuth_deg) {
+    const audio_beamformer_config_t* c = &bf->config;
+    const double a = (double)azimuth_deg * M_PI / 180.0;
+    const double ux = cos(a);
+    const double uy = sin(a);
+    double proj[AUDIO_BEAMFORMER_MAX_MICS];
+    double lo = 0.0;
+    for (size_t m = 0; m < bf->mics; m++) {
+        proj[m] = c->mic_x_mm[m] * ux + c->mic_y_mm[m] * uy;
+        if (m == 0 || proj[m] < lo) {
+            lo = proj[m];
+        }
+    }
+
+    beam->azimuth_deg = azimuth_deg;
+    for (size_t m = 0; m < bf->mics; m++) {
+        double delay = (proj[m] - lo) / 1000.0 / c->speed_of_sound * (double)c->sample_rate;
+        int shift = (int)floor(delay);
+        double d = (double)BF_BASE_DELAY + (delay - shift);
+        beam->shift[m] = shift;
+        if (shift > bf->max_shift) {
+            bf->max_shift = shift;
+        }
+        for (int k = 0; k < BF_TAPS; k++) {
+            double h = 1.0;
+            for (int j = 0; j < BF_TAPS; j++) {
+                if (j != k) {
+                    h *= (d - j) / (double)(k - j);
+                }
+            }
+            long q = lrint(h * BF_Q15_ONE / (double)bf->mics);
+            beam->taps[m][k] = (int16_t)(q > 32767 ? 32767 : (q < -32768 ? -32768 : q));
+        }
+    }
+}
+
+// ============================================================================
+// Kernels
+// ============================================================================
+
+/**
+ * acc[n] += x[n] * h over `count` samples
+ */
+static void bf_accumulate(int32_t* acc, const int16_t* x, int16_t h, size_t count) {
+    size_t n = 0;
+#if BF_USE_NEON
+    for (; n + 8 <= count; n += 8) {
+        int16x8_t v = vld1q_s16(x + n);
+        int32x4_t lo = vld1q_s32(acc + n);
+        int32x4_t hi = vld1q_s32(acc + n + 4);
+        lo = vmlal_n_s16(lo, vget_low_s16(v), h);
+        hi = vmlal_n_s16(hi, vget_high_s16(v), h);
+        vst1q_s32(acc + n, lo);
+        vst1q_s32(acc + n + 4, hi);
+    }
+#elif BF_USE_SSE2
+    const __m128i vh = _mm_set1_epi16(h);
+    for (; n + 8 <= count; n += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(x + n));
+        __m128i pl = _mm_mullo_epi16(v, vh);
+        __m128i ph = _mm_mulhi_epi16(v, vh);
+        __m128i lo = _mm_loadu_si128((const __m128i*)(acc + n));
+        __m128i hi = _mm_loadu_si128((const __m128i*)(acc + n + 4));
+        lo = _mm_add_epi32(lo, _mm_unpacklo_epi16(pl, ph));
+        hi = _mm_add_epi32(hi, _mm_unpackhi_epi16(pl, ph));
+        _mm_storeu_si128((__m128i*)(acc + n), lo);
+        _mm_storeu_si128((__m128i*)(acc + n + 4), hi);
+    }
+#endif
+    for (; n < count; n++) {
+        acc[n] += (int32_t)x[n] * h;
+    }
+}
+
+/**
+ * out[n] = saturate(round(acc[n] / 2^15))
+ */
+static void bf_pack(const int32_t* acc, int16_t* out, size_t count) {
+    size_t n = 0;
+#if BF_USE_NEON
+    for (; n + 8 <= count; n += 8) {
+        int16x4_t lo = vqrshrn_n_s32(vld1q_s32(acc + n), 15);
+        int16x4_t hi = vqrshrn_n_s32(vld1q_s32(acc + n + 4), 15);
+        vst1q_s16(out + n, vcombine_s16(lo, hi));
+    }
+#elif BF_USE_SSE2
+    const __m128i round = _mm_set1_epi32(1 << 14);
+    for (; n + 8 <= count; n += 8) {
+        __m128i lo = _mm_loadu_si128((const __m128i*)(acc + n));
+        __m128i hi = _mm_loadu_si128((const __m128i*)(acc + n + 4));
+        lo = _mm_srai_epi32(_mm_add_epi32(lo, round), 15);
+        hi = _mm_srai_epi32(_mm_add_epi32(hi, round), 15);
+        _mm_storeu_si128((__m128i*)(out + n), _mm_packs_epi32(lo, hi));
+    }
+#endif
+    for (; n < count; n++) {
+        int32_t v = (acc[n] + (1 << 14)) >> 15;
+        out[n] = (int16_t)(v > 32767 ? 32767 : (v < -32768 ? -32768 : v));
+    }
+}
+
+/**
+ * Delay-and-sum one beam over the current frame into `out`
+ */
+static void bf_form_beam(audio_beamformer_t* bf, const bf_beam_t* beam, int16_t* out) {
+    const size_t N = bf->frame;
+    memset(bf->acc, 0, N * sizeof(int32_t));
+    for (size_t m = 0; m < bf->mics; m++) {
+        const int16_t* x = bf->planar + m * bf->stride + bf->history - (size_t)beam->shift[m];
+        for (int k = 0; k < BF_TAPS; k++) {
+            if (beam->taps[m][k] != 0) {
+                bf_accumulate(bf->acc, x - k, beam->taps[m][k], N);
+            }
+        }
+    }
+    bf_pack(bf->acc, out, N);
+}
+
+// ============================================================================
+// Beam selection
+// ============================================================================
+
+static void bf_select(audio_beamformer_t* bf) {
+    size_t best = bf->beam;
+    for (size_t b = 0; b < bf->beam_count; b++) {
+        if (bf->energy[b] > bf->energy[best]) {
+            best = b;
+        }
+    }
+    if (best == bf->beam || bf->energy[best] <= bf->energy[bf->beam] * bf->lead_ratio) {
+        bf->candidate = -1;
+        bf->lead_ms = 0;
+        return;
+    }
+    const int frame_ms = (int)(bf->frame * 1000 / bf->config.sample_rate);
+    if (bf->candidate != (int)best) {
+        bf->candidate = (int)best;
+        bf->lead_ms = 0;
+    }
+    bf->lead_ms += frame_ms > 0 ? frame_ms : 1;
+    if (bf->lead_ms >= bf->config.hold_ms) {
+        bf->fade_from = (int)bf->beam;
+        bf->beam = best;
+        bf->candidate = -1;
+        bf->lead_ms = 0;
+        bf->switches++;
+    }
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+audio_beamformer_t* audio_beamformer_create(const audio_beamformer_config_t* config) {
+    if (!config || config->sample_rate == 0 || config->frame_samples == 0 ||
+        config->channels < 2 || config->channels > AUDIO_BEAMFORMER_MAX_MICS ||
+        config->frame_samples % (size_t)config->channels != 0 ||
+        config->beams < 0 || config->beams > AUDIO_BEAMFORMER_MAX_BEAMS) {
+        LOG_ERROR("Invalid beamformer parameters");
+        return NULL;
+    }
+
+    audio_beamformer_t* bf = (audio_beamformer_t*)LINX_CALLOC(1, sizeof(audio_beamformer_t));
+    if (!bf) {
+        LOG_ERROR("Failed to allocate beamformer");
+        return NULL;
+    }
+    bf->config = *config;
+    if (bf->config.beams == 0) {
+        bf->config.beams = BF_DEFAULT_BEAMS;
+    }
+    if (bf->config.hysteresis_db <= 0) {
+        bf->config.hysteresis_db = BF_DEFAULT_HYSTERESIS_DB;
+    }
+    if (bf->config.hold_ms <= 0) {
+        bf->config.hold_ms = BF_DEFAULT_HOLD_MS;
+    }
+    if (bf->config.speed_of_sound <= 0.0f) {
+        bf->config.speed_of_sound = BF_DEFAULT_SPEED_OF_SOUND;
+    }
+    bf->mics = (size_t)config->channels;
+    bf->frame = config->frame_samples / bf->mics;
+    bf->beam_count = (size_t)bf->config.beams;
+    bf->lead_ratio = powf(10.0f, (float)bf->config.hysteresis_db / 10.0f);
+
+    // A line cannot tell front from back: spread its beams from one endfire to the other
+    const bool linear = bf_is_collinear(&bf->config);
+    for (size_t b = 0; b < bf->beam_count; b++) {
+        float step = 0.0f;
+        if (bf->beam_count > 1) {
+            step = linear ? 180.0f / (float)(bf->beam_count - 1) : 360.0f / (float)bf->beam_count;
+        }
+        bf_steer(bf, &bf->beams[b], bf->config.look_azimuth_deg + step * (float)b);
+    }
+
+    bf->history = ((size_t)bf->max_shift + BF_TAPS - 1 + 7) & ~(size_t)7;
+    bf->stride = (bf->history + bf->frame + 7) & ~(size_t)7;
+    bf->planar = (int16_t*)LINX_CALLOC(bf->mics * bf->stride, sizeof(int16_t));
+    bf->acc = (int32_t*)LINX_MALLOC(bf->frame * sizeof(int32_t));
+    bf->scratch = (int16_t*)LINX_MALLOC(bf->frame * sizeof(int16_t));
+    bf->fade = (int16_t*)LINX_MALLOC(bf->frame * sizeof(int16_t));
+    if (!bf->planar || !bf->acc || !bf->scratch || !bf->fade) {
+        LOG_ERROR("Failed to allocate beamformer state");
+        audio_beamformer_destroy(bf);
+        return NULL;
+    }
+    audio_beamformer_reset(bf);
+
+    LOG_INFO("Beamformer created: %d mics (%s), %zu beams, %d samples max delay%s",
+             config->channels, linear ? "linear" : "planar", bf->beam_count, bf->max_shift,
+             BF_USE_NEON ? ", NEON" : (BF_USE_SSE2 ? ", SSE2" : ""));
+    return bf;
+}
+
+void audio_beamformer_destroy(audio_beamformer_t* bf) {
+    if (!bf) {
+        return;
+    }
+    LINX_FREE(bf->planar);
+    LINX_FREE(bf->acc);
+    LINX_FREE(bf->scratch);
+    LINX_FREE(bf->fade);
+    LINX_FREE(bf);
+}
+
+int audio_beamformer_process(audio_beamformer_t* bf, const short* in, short* out, size_t samples) {
+    if (!bf || !in || !out || samples != bf->config.frame_samples) {
+        return -1;
+    }
+    const size_t N = bf->frame;
+    short* channels[AUDIO_BEAMFORMER_MAX_MICS];
+    for (size_t m = 0; m < bf->mics; m++) {
+        channels[m] = bf->planar + m * bf->stride + bf->history;
+    }
+    audio_dsp_deinterleave(in, channels, bf->mics, N);
+
+    // Every beam is formed for its energy; only the output (and fade source) is kept
+    for (size_t b = 0; b < bf->beam_count; b++) {
+        int16_t* dst = b == bf->beam ? out : bf->scratch;
+        bf_form_beam(bf, &bf->beams[b], dst);
+        float e = (float)audio_dsp_sum_squares(dst, N) / (float)N;
+        bf->energy[b] += (e - bf->energy[b]) * BF_ENERGY_SMOOTHING;
+        if ((int)b == bf->fade_from) {
+            memcpy(bf->fade, dst, N * sizeof(int16_t));
+        }
+    }
+
+    if (bf->fade_from >= 0) {
+        const int16_t* old = bf->fade;
+        for (size_t n = 0; n < N; n++) {
+            int32_t w = (int32_t)((n * BF_Q15_ONE) / N);
+            out[n] = (short)(((int32_t)old[n] * (BF_Q15_ONE - w) + (int32_t)out[n] * w) / BF_Q15_ONE);
+        }
+        bf->fade_from = -1;
+    }
+
+    for (size_t m = 0; m < bf->mics; m++) {
+        int16_t* buf = bf->planar + m * bf->stride;
+        memmove(buf, buf + N, bf->history * sizeof(int16_t));
+    }
+
+    if (bf->beam_count > 1) {
+        bf_select(bf);
+    }
+    bf->frames++;
+    return 0;
+}
+
+void audio_beamformer_reset(audio_beamformer_t* bf) {
+    if (!bf) {
+        return;
+    }
+    memset(bf->planar, 0, bf->mics * bf->stride * sizeof(int16_t));
+    memset(bf->energy, 0, sizeof(bf->energy));
+    bf->fade_from = -1;
+    bf->candidate = -1;
+    bf->lead_ms = 0;
+}
+
+bool audio_beamformer_get_stats(const audio_beamformer_t* bf, audio_beamformer_stats_t* stats) {
+    if (!bf || !stats) {
+        return false;
+    }
+    stats->frames = bf->frames;
+    stats->switches = bf->switches;
+    stats->beam = (int)bf->beam;
+    stats->azimuth_deg = bf->beams[bf->beam].azimuth_deg;
+    stats->max_delay_samples = bf->max_shift;
+    return true;
+}
+
+static int bf_stage_process(void* ctx, const short* in, short* out, size_t samples) {
+    return audio_beamformer_process((audio_beamformer_t*)ctx, in, out, samples);
+}
+
+static void bf_stage_reset(void* ctx) {
+    audio_beamformer_reset((audio_beamformer_t*)ctx);
+}
+
+audio_stage_t audio_beamformer_stage(audio_beamformer_t* bf) {
+    audio_stage_t stage = { "beamformer", bf_stage_process, bf_stage_reset, 0, bf, 1 };
+    return stage;
+}
@@ -0,0 +1,126 @@
+#ifndef AUDIO_BEAMFORMER_H
+#define AUDIO_BEAMFORMER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "audio_pipeline.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Delay-and-sum beamformer for a microphone array
+ *
+ * Turns an interleaved multi-channel capture frame into one mono frame for
+ * echo cancellation, noise suppression and the encoder. The frame is first
+ * deinterleaved into per-channel planar buffers (one contiguous block per
+ * microphone with its delay history in front, so every channel streams
+ * through the cache once per beam). Each beam delays every microphone so a
+ * plane wave from its look direction adds up in phase: an integer offset
+ * into the history plus a 4-tap Lagrange fractional delay, all in Q15 with
+ * 32-bit accumulators; the 1/N normalisation is folded into the taps.
+ *
+ * With several beams (steered evenly around the array, over 180 degrees for
+ * a linear array, which cannot tell front from back) the output follows the
+ * beam with the most smoothed energy, i.e. the talker when they are the
+ * loudest source in the room. A switch needs `hysteresis_db` on the current
+ * beam for `hold_ms`, and crossfades over one frame so it does not click.
+ * One beam keeps a fixed look direction.
+ *
+ * Far-field speech gains roughly 10*log10(N) dB against diffuse noise and
+ * reverberation; the directivity is modest at low frequencies where the
+ * array is small against the wavelength. Adds one sample of latency.
+ *
+ * 16-bit samples, 2 to AUDIO_BEAMFORMER_MAX_MICS channels. The accumulate
+ * loops use NEON on ARM and SSE2 on x86. Not thread-safe: run it on the
+ * capture thread as the first uplink stage.
+ */
+typedef struct audio_beamformer audio_beamformer_t;
+
+/* Largest number of microphones */
+#define AUDIO_BEAMFORMER_MAX_MICS 8
+
+/* Largest number of beams */
+#define AUDIO_BEAMFORMER_MAX_BEAMS 16
+
+/**
+ * Beamformer configuration; zero fields take the defaults
+ * Fill the geometry directly or with audio_beamformer_linear_array() /
+ * audio_beamformer_circular_array().
+ */
+typedef struct {
+    unsigned int sample_rate;       // Sample rate (required)
+    size_t frame_samples;           // Samples per audio_beamformer_process() call, all channels (required)
+    int channels;                   // Microphones, interleaved in the capture frame (required)
+    float mic_x_mm[AUDIO_BEAMFORMER_MAX_MICS]; // Microphone positions in the array plane (millimetres, any origin)
+    float mic_y_mm[AUDIO_BEAMFORMER_MAX_MICS];
+    int beams;                      // Look directions (default 8; 1 = fixed at look_azimuth_deg)
+    float look_azimuth_deg;         // Direction of the first beam, counter-clockwise from +x
+    int hysteresis_db;              // Energy lead a beam needs to take over (default 2)
+    int hold_ms;                    // How long it must keep the lead (default 200)
+    float speed_of_sound;           // Metres per second (default 343)
+} audio_beamformer_config_t;
+
+/**
+ * Beamformer statistics
+ */
+typedef struct {
+    uint64_t frames;                // Frames processed
+    uint64_t switches;              // Beam changes
+    int beam;                       // Current beam
+    float azimuth_deg;              // Look direction of the current beam
+    int max_delay_samples;          // Longest steering delay (array aperture in samples)
+} audio_beamformer_stats_t;
+
+/**
+ * Place `mics` microphones on the x axis, `spacing_mm` apart
+ */
+void audio_beamformer_linear_array(audio_beamformer_config_t* config, int mics, float spacing_mm);
+
+/**
+ * Place `mics` microphones evenly on a circle of `radius_mm`, the first on +x
+ */
+void audio_beamformer_circular_array(audio_beamformer_config_t* config, int mics, float radius_mm);
+
+/**
+ * Create a beamformer
+ * @return Beamformer instance or NULL on failure
+ */
+audio_beamformer_t* audio_beamformer_create(const audio_beamformer_config_t* config);
+
+/**
+ * Destroy a beamformer
+ */
+void audio_beamformer_destroy(audio_beamformer_t* bf);
+
+/**
+ * Beamform one frame
+ * @param in config.frame_samples interleaved samples
+ * @param out config.frame_samples / config.channels mono samples (must not overlap in)
+ * @return 0 on success, -1 on invalid input
+ */
+int audio_beamformer_process(audio_beamformer_t* bf, const short* in, short* out, size_t samples);
+
+/**
+ * Forget the delay history and the beam energies (the current beam is kept)
+ */
+void audio_beamformer_reset(audio_beamformer_t* bf);
+
+/**
+ * Get statistics (capture thread, or while the pipeline is stopped)
+ */
+bool audio_beamformer_get_stats(const audio_beamformer_t* bf, audio_beamformer_stats_t* stats);
+
+/**
+ * Pipeline stage (out of place, outputs one channel); put it before every
+ * mono stage, i.e. first in the uplink
+ */
+audio_stage_t audio_beamformer_stage(audio_beamformer_t* bf);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIO_BEAMFORMER_H
@@ -0,0 +1,267 @@
+#include "audio_capture_ring.h"
+#include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
+#include <string.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_AUDIO);
+
+#define CAPTURE_RING_DEFAULT_MS     1000
+#define CAPTURE_RING_FIND_STEPS     8       // Slots visited when the clock is not perfectly regular
+
+struct audio_capture_ring {
+    audio_capture_ring_config_t config;
+    size_t capacity;            // Frames
+    uint64_t frame_us;
+
+    short* data;                // capacity * frame_samples
+    uint64_t* times;            // Capture time per slot
+    uint64_t* tags;             // Per slot: seq + 1 while it holds that frame, 0 while it is written
+
+    uint64_t head;              // Next sequence number (published by the producer)
+    uint64_t base;              // Oldest sequence number since the last reset
+    uint64_t gaps;
+    uint64_t last_time_us;      // Producer only
+};
+
+audio_capture_ring_t* audio_capture_ring_create(const audio_capture_ring_config_t* config) {
+    if (!config || config->frame_samples == 0 || config->sample_rate == 0) {
+        LOG_ERROR("Invalid capture ring parameters");
+        return NULL;
+    }
+    const size_t channels = config->channels > 0 ? (size_t)config->channels : 1;
+    if (config->frame_samples % channels != 0) {
+        LOG_ERROR("Capture ring frame of %zu samples does not hold whole %zu-channel frames",
+                  config->frame_samples, channels);
+        return NULL;
+    }
+
+    audio_capture_ring_t* ring = (audio_capture_ring_t*)LINX_CALLOC(1, sizeof(audio_capture_ring_t));
+    if (!ring) {
+        LOG_ERROR("Failed to allocate capture ring");
+        return NULL;
+    }
+    ring->config = *config;
+    ring->config.channels = (int)channels;
+    if (ring->config.capacity_ms <= 0) {
+        ring->config.capacity_ms = CAPTURE_RING_DEFAULT_MS;
+    }
+    ring->frame_us = (uint64_t)(config->frame_samples / channels) * 1000000u / config->sample_rate;
+    if (ring->frame_us == 0) {
+        ring->frame_us = 1;
+    }
+    // One slot more than the history so the frame being overwritten is never one that was promised
+    ring->capacity = (size_t)(((uint64_t)ring->config.capacity_ms * 1000u + ring->frame_us - 1) / ring->frame_us) + 1;
+    if (ring->capacity < 2) {
+        ring->capacity = 2;
+    }
+
+    ring->data = (short*)LINX_CALLOC_BULK(ring->capacity * config->frame_samples, sizeof(short));
+    ring->times = (uint64_t*)LINX_CALLOC(ring->capacity, sizeof(uint64_t));
+    ring->tags = (uint64_t*)LINX_CALLOC(ring->capacity, sizeof(uint64_t));
+    if (!ring->data || !ring->times || !ring->tags) {
+        LOG_ERROR("Failed to allocate capture ring history");
+        audio_capture_ring_destroy(ring);
+        return NULL;
+    }
+
+    LOG_INFO("Capture ring created: %zu frames of %zu samples (%d ms)",
+             ring->capacity, config->frame_samples, ring->config.capacity_ms);
+    return ring;
+}
+
+void audio_capture_ring_destroy(audio_capture_ring_t* ring) {
+    if (!ring) {
+        return;
+    }
+    LINX_FREE(ring->data);
+    LINX_FREE(ring->times);
+    LINX_FREE(ring->tags);
+    LINX_FREE(ring);
+}
+
+void audio_capture_ring_push(audio_capture_ring_t* ring, const short* pcm, uint64_t time_us) {
+    if (!ring || !pcm) {
+        return;
+    }
+    const uint64_t seq = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    const size_t slot = (size_t)(seq % ring->capacity);
+
+    if (seq > __atomic_load_n(&ring->base, __ATOMIC_RELAXED) &&
+        time_us > ring->last_time_us + ring->frame_us + ring->frame_us / 2) {
+        __atomic_fetch_add(&ring->gaps, 1, __ATOMIC_RELAXED);
+    }
+    ring->last_time_us = time_us;
+
+    // Invalidate the slot before touching it; readers that copied it meanwhile see the tag change
+    __atomic_store_n(&ring->tags[slot], 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(ring->data + slot * ring->config.frame_samples, pcm, ring->config.frame_samples * sizeof(short));
+    __atomic_store_n(&ring->times[slot], time_us, __ATOMIC_RELAXED);
+    __atomic_store_n(&ring->tags[slot], seq + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&ring->head, seq + 1, __ATOMIC_RELEASE);
+}
+
+void audio_capture_ring_reset(audio_capture_ring_t* ring) {
+    if (!ring) {
+        return;
+    }
+    __atomic_store_n(&ring->base, __atomic_load_n(&ring->head, __ATOMIC_RELAXED), __ATOMIC_RELEASE);
+}
+
+size_t audio_capture_ring_frame_samples(const audio_capture_ring_t* ring) {
+    return ring ? ring->config.frame_samples : 0;
+}
+
+uint64_t audio_capture_ring_frame_us(const audio_capture_ring_t* ring) {
+    return ring ? ring->frame_us : 0;
+}
+
+/* Oldest sequence number a reader may still get */
+static uint64_t capture_ring_oldest(const audio_capture_ring_t* ring, uint64_t head) {
+    uint64_t base = __atomic_load_n(&ring->base, __ATOMIC_ACQUIRE);
+    uint64_t kept = ring->capacity - 1;
+    uint64_t oldest = head > kept ? head - kept : 0;
+    return oldest > base ? oldest : base;
+}
+
+int audio_capture_ring_read(const audio_capture_ring_t* ring, uint64_t seq, short* pcm,
+                            audio_capture_frame_info_t* info) {
+    if (!ring) {
+        return -1;
+    }
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    if (seq >= head || seq < capture_ring_oldest(ring, head)) {
+        return -1;
+    }
+    const size_t slot = (size_t)(seq % ring->capacity);
+    if (__atomic_load_n(&ring->tags[slot], __ATOMIC_ACQUIRE) != seq + 1) {
+        return -1;
+    }
+    if (pcm) {
+        memcpy(pcm, ring->data + slot * ring->config.frame_samples, ring->config.frame_samples * sizeof(short));
+    }
+    uint64_t time_us = __atomic_load_n(&ring->times[slot], __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&ring->tags[slot], __ATOMIC_RELAXED) != seq + 1) {
+        return -1;
+    }
+    if (info) {
+        info->seq = seq;
+        info->time_us = time_us;
+    }
+    return 0;
+}
+
+bool audio_capture_ring_latest(const audio_capture_ring_t* ring, audio_capture_frame_info_t* info) {
+    if (!ring) {
+        return false;
+    }
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    if (head == 0 || head <= __atomic_load_n(&ring->base, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+    return audio_capture_ring_read(ring, head - 1, NULL, info) == 0;
+}
+
+uint64_t audio_capture_ring_seek_ms(const audio_capture_ring_t* ring, unsigned int ago_ms) {
+    if (!ring) {
+        return 0;
+    }
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint64_t back = ((uint64_t)ago_ms * 1000u + ring->frame_us - 1) / ring->frame_us;
+    uint64_t seq = head > back ? head - back : 0;
+    uint64_t oldest = capture_ring_oldest(ring, head);
+    return seq > oldest ? seq : oldest;
+}
+
+bool audio_capture_ring_find(const audio_capture_ring_t* ring, uint64_t time_us, uint64_t* seq) {
+    audio_capture_frame_info_t newest;
+    if (!ring || !seq || !audio_capture_ring_latest(ring, &newest)) {
+        return false;
+    }
+    if (time_us >= newest.time_us + ring->frame_us) {
+        return false;
+    }
+    if (time_us >= newest.time_us) {
+        *seq = newest.seq;
+        return true;
+    }
+
+    // Estimate from the nominal frame duration, then correct with the stored times
+    uint64_t back = (newest.time_us - time_us + ring->frame_us - 1) / ring->frame_us;
+    uint64_t guess = newest.seq > back ? newest.seq - back : 0;
+    for (int step = 0; step < CAPTURE_RING_FIND_STEPS; step++) {
+        audio_capture_frame_info_t info;
+        if (audio_capture_ring_read(ring, guess, NULL, &info) != 0) {
+            // Older than the history, unless only the estimate overshot
+            uint64_t oldest = capture_ring_oldest(ring, newest.seq + 1);
+            if (guess >= oldest) {
+                return false;
+            }
+            guess = oldest;
+            continue;
+        }
+        if (time_us < info.time_us) {
+            if (guess == 0 || guess <= capture_ring_oldest(ring, newest.seq + 1)) {
+                return false;
+            }
+            guess--;
+            continue;
+        }
+        audio_capture_frame_info_t next;
+        if (guess < newest.seq && audio_capture_ring_read(ring, guess + 1, NULL, &next) == 0 &&
+            time_us >= next.time_us) {
+            guess++;
+            continue;
+        }
+        *seq = guess;
+        return true;
+    }
+    return false;
+}
+
+void audio_capture_ring_reader_init(const audio_capture_ring_t* ring, audio_capture_ring_reader_t* reader,
+                                    unsigned int ago_ms) {
+    if (!ring || !reader) {
+        return;
+    }
+    reader->next = audio_capture_ring_seek_ms(ring, ago_ms);
+    reader->missed = 0;
+}
+
+bool audio_capture_ring_reader_next(const audio_capture_ring_t* ring, audio_capture_ring_reader_t* reader,
+                                    short* pcm, audio_capture_frame_info_t* info) {
+    if (!ring || !reader) {
+        return false;
+    }
+    for (;;) {
+        uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        if (reader->next >= head) {
+            return false;
+        }
+        uint64_t oldest = capture_ring_oldest(ring, head);
+        if (reader->next < oldest) {
+            reader->missed += oldest - reader->next;
+            reader->next = oldest;
+        }
+        if (audio_capture_ring_read(ring, reader->next, pcm, info) == 0) {
+            reader->next++;
+            return true;
+        }
+        // Overwritten while copying: the producer lapped us, try again from the new oldest
+        reader->missed++;
+        reader->next++;
+    }
+}
+
+bool audio_capture_ring_get_stats(const audio_capture_ring_t* ring, audio_capture_ring_stats_t* stats) {
+    if (!ring || !stats) {
+        return false;
+    }
+    audio_capture_frame_info_t newest;
+    stats->capacity_frames = ring->capacity - 1;
+    stats->frames = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    stats->gaps = __atomic_load_n(&ring->gaps, __ATOMIC_RELAXED);
+    stats->newest_time_us = audio_capture_ring_latest(ring, &newest) ? newest.time_us : 0;
+    return true;
+}
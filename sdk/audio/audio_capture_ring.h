@@ -0,0 +1,153 @@
+#ifndef AUDIO_CAPTURE_RING_H
+#define AUDIO_CAPTURE_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Timestamped history of captured frames
+ *
+ * Keeps the last `capacity_ms` of raw capture as fixed-size frames, each
+ * with a sequence number and the capture time of its first sample, so code
+ * that needs "the audio from 300 ms ago" (wake word pre-roll, AEC reference
+ * alignment, the protocol v2 uplink timestamp) can look it up instead of
+ * keeping its own copy.
+ *
+ * One producer (the capture thread, see audio_pipeline_config_t.capture_ring)
+ * and any number of readers on any threads. Readers never block the
+ * producer and take no lock: every slot is guarded by a sequence tag that
+ * the producer clears before it overwrites the slot and sets afterwards, and
+ * a reader that sees the tag change while copying reports the frame as
+ * overwritten. A reader that falls more than the capacity behind loses the
+ * oldest frames; audio_capture_ring_reader_next() skips ahead and counts them.
+ *
+ * Times are in microseconds of the device clock (PortAudio stream time, MPP
+ * frame timestamps) when the AudioInterface reports one, otherwise of
+ * CLOCK_MONOTONIC at the end of the read minus the frame duration.
+ */
+typedef struct audio_capture_ring audio_capture_ring_t;
+
+/**
+ * Capture ring configuration; zero fields take the defaults
+ */
+typedef struct {
+    size_t frame_samples;           // Samples per frame, all channels (required)
+    int channels;                   // Interleaved channels (default 1)
+    unsigned int sample_rate;       // Sample rate (required)
+    int capacity_ms;                // History kept (default 1000)
+} audio_capture_ring_config_t;
+
+/**
+ * Where a frame came from
+ */
+typedef struct {
+    uint64_t seq;                   // Frame number since creation or reset
+    uint64_t time_us;               // Capture time of the first sample
+} audio_capture_frame_info_t;
+
+/**
+ * Reader cursor; plain data owned by the reader, one per consumer
+ */
+typedef struct {
+    uint64_t next;                  // Next frame to read
+    uint64_t missed;                // Frames overwritten before they were read
+} audio_capture_ring_reader_t;
+
+/**
+ * Capture ring statistics
+ */
+typedef struct {
+    size_t capacity_frames;         // Frames kept
+    uint64_t frames;                // Frames pushed
+    uint64_t gaps;                  // Pushes whose time jumped by more than 1.5 frames (lost capture)
+    uint64_t newest_time_us;        // Capture time of the newest frame, 0 before the first
+} audio_capture_ring_stats_t;
+
+/**
+ * Create a capture ring
+ * @return Ring instance or NULL on failure
+ */
+audio_capture_ring_t* audio_capture_ring_create(const audio_capture_ring_config_t* config);
+
+/**
+ * Destroy a capture ring (no reader may be running)
+ */
+void audio_capture_ring_destroy(audio_capture_ring_t* ring);
+
+/**
+ * Producer: append one frame of config.frame_samples samples
+ * @param time_us Capture time of pcm[0]
+ */
+void audio_capture_ring_push(audio_capture_ring_t* ring, const short* pcm, uint64_t time_us);
+
+/**
+ * Producer: forget every frame (sequence numbers keep counting)
+ */
+void audio_capture_ring_reset(audio_capture_ring_t* ring);
+
+/**
+ * Samples per frame, all channels
+ */
+size_t audio_capture_ring_frame_samples(const audio_capture_ring_t* ring);
+
+/**
+ * Frame duration in microseconds
+ */
+uint64_t audio_capture_ring_frame_us(const audio_capture_ring_t* ring);
+
+/**
+ * Newest frame
+ * @return false while the ring is empty
+ */
+bool audio_capture_ring_latest(const audio_capture_ring_t* ring, audio_capture_frame_info_t* info);
+
+/**
+ * Sequence number of the frame that starts `ago_ms` before the end of the
+ * newest frame, clamped to the oldest frame still kept
+ * (0 gives the sequence number the next push will get)
+ */
+uint64_t audio_capture_ring_seek_ms(const audio_capture_ring_t* ring, unsigned int ago_ms);
+
+/**
+ * Find the frame holding the sample captured at `time_us`
+ * @return false if that time is older than the history or not captured yet
+ */
+bool audio_capture_ring_find(const audio_capture_ring_t* ring, uint64_t time_us, uint64_t* seq);
+
+/**
+ * Copy one frame by sequence number
+ * @param pcm config.frame_samples samples, or NULL to read only the info
+ * @param info Frame info, can be NULL
+ * @return 0 on success, -1 if the frame is not pushed yet or was overwritten
+ */
+int audio_capture_ring_read(const audio_capture_ring_t* ring, uint64_t seq, short* pcm,
+                            audio_capture_frame_info_t* info);
+
+/**
+ * Position a reader `ago_ms` back from the newest frame (0 = only new frames)
+ */
+void audio_capture_ring_reader_init(const audio_capture_ring_t* ring, audio_capture_ring_reader_t* reader,
+                                    unsigned int ago_ms);
+
+/**
+ * Copy the reader's next frame and advance it
+ * @return true if a frame was copied, false if the reader is up to date
+ */
+bool audio_capture_ring_reader_next(const audio_capture_ring_t* ring, audio_capture_ring_reader_t* reader,
+                                    short* pcm, audio_capture_frame_info_t* info);
+
+/**
+ * Get statistics (safe to call from any thread)
+ */
+bool audio_capture_ring_get_stats(const audio_capture_ring_t* ring, audio_capture_ring_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIO_CAPTURE_RING_H
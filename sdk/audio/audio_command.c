@@ -0,0 +1,119 @@
+#include "audio_command.h"
+#include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
+#include <string.h>
+#include <stdio.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_AUDIO);
+
+#define COMMAND_DEFAULT_FRAME_MS        20
+#define COMMAND_DEFAULT_REPEAT_GUARD_MS 1000
+
+struct audio_command {
+    audio_kws_t* recognizer;
+    audio_command_config_t config;
+    size_t repeat_guard_frames;
+
+    bool listening;                 // Recognizer ran for the previous frame
+    char last_command[64];          // Last command passed on, "" for none
+    size_t frames_since_command;
+
+    // Atomic counters
+    uint64_t frames;
+    uint64_t recognized_frames;
+    uint64_t commands;
+    uint64_t repeats;
+};
+
+audio_command_t* audio_command_create(audio_kws_t* recognizer, const audio_command_config_t* config) {
+    if (!recognizer || !config || config->frame_samples == 0 || !config->on_command) {
+        LOG_ERROR("Invalid command stage parameters");
+        return NULL;
+    }
+
+    audio_command_t* command = (audio_command_t*)LINX_CALLOC(1, sizeof(audio_command_t));
+    if (!command) {
+        LOG_ERROR("Failed to allocate command stage");
+        return NULL;
+    }
+    command->recognizer = recognizer;
+    command->config = *config;
+    if (command->config.frame_duration_ms <= 0) {
+        command->config.frame_duration_ms = COMMAND_DEFAULT_FRAME_MS;
+    }
+    if (command->config.repeat_guard_ms == 0) {
+        command->config.repeat_guard_ms = COMMAND_DEFAULT_REPEAT_GUARD_MS;
+    }
+    int frame_ms = command->config.frame_duration_ms;
+    if (command->config.repeat_guard_ms > 0) {
+        command->repeat_guard_frames = (size_t)((command->config.repeat_guard_ms + frame_ms - 1) / frame_ms);
+    }
+    return command;
+}
+
+void audio_command_destroy(audio_command_t* command) {
+    LINX_FREE(command);
+}
+
+static void command_reset(void* ctx) {
+    audio_command_t* command = (audio_command_t*)ctx;
+    audio_kws_reset(command->recognizer);
+    command->listening = false;
+    command->last_command[0] = '\0';
+    command->frames_since_command = 0;
+}
+
+static int command_process(void* ctx, const short* in, short* out, size_t samples) {
+    (void)out;
+    audio_command_t* command = (audio_command_t*)ctx;
+    if (samples != command->config.frame_samples) {
+        return -1;
+    }
+    __atomic_add_fetch(&command->frames, 1, __ATOMIC_RELAXED);
+    command->frames_since_command++;
+
+    if (command->config.is_enabled && !command->config.is_enabled(command->config.user_data)) {
+        command->listening = false;
+        return 0;
+    }
+    if (!command->listening) {
+        // Audio from before the pause is not part of the next phrase
+        audio_kws_reset(command->recognizer);
+        command->listening = true;
+    }
+
+    __atomic_add_fetch(&command->recognized_frames, 1, __ATOMIC_RELAXED);
+    const char* name = NULL;
+    if (!audio_kws_detect(command->recognizer, in, samples, &name) || name[0] == '\0') {
+        return 0;
+    }
+    if (command->frames_since_command <= command->repeat_guard_frames &&
+        strcmp(command->last_command, name) == 0) {
+        __atomic_add_fetch(&command->repeats, 1, __ATOMIC_RELAXED);
+        command->frames_since_command = 0;
+        return 0;
+    }
+
+    snprintf(command->last_command, sizeof(command->last_command), "%s", name);
+    command->frames_since_command = 0;
+    __atomic_add_fetch(&command->commands, 1, __ATOMIC_RELAXED);
+    LOG_INFO("Local command \"%s\" recognized", name);
+    command->config.on_command(command->config.user_data, name);
+    return 0;
+}
+
+audio_stage_t audio_command_stage(audio_command_t* command) {
+    audio_stage_t stage = { "command", command_process, command_reset, AUDIO_STAGE_READ_ONLY, command, 0 };
+    return stage;
+}
+
+bool audio_command_get_stats(const audio_command_t* command, audio_command_stats_t* stats) {
+    if (!command || !stats) {
+        return false;
+    }
+    stats->frames = __atomic_load_n(&command->frames, __ATOMIC_RELAXED);
+    stats->recognized_frames = __atomic_load_n(&command->recognized_frames, __ATOMIC_RELAXED);
+    stats->commands = __atomic_load_n(&command->commands, __ATOMIC_RELAXED);
+    stats->repeats = __atomic_load_n(&command->repeats, __ATOMIC_RELAXED);
+    return true;
+}
@@ -0,0 +1,91 @@
+#ifndef AUDIO_COMMAND_H
+#define AUDIO_COMMAND_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "audio_pipeline.h"
+#include "audio_wake.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Local command stage for the uplink audio pipeline
+ *
+ * Recognizes a small fixed vocabulary ("volume up", "stop", "turn off the
+ * light") on the device so those commands skip the server round trip and
+ * keep working offline. The recognizer is an audio_kws_t whose keywords
+ * are the command names: the same vtable as the wake word spotter, loaded
+ * with a command model instead (the SDK does not ship an engine).
+ *
+ * Place it after the front-end stages and ahead of the wake stage, so it
+ * hears the same cleaned-up frames without a second capture path:
+ *
+ *   capture -> AEC -> NS -> command -> wake -> VAD gate / encode / send
+ *
+ * The stage only listens; every frame continues to the next stage. On a
+ * match on_command() is called with the command name, typically
+ * linx_sdk_run_local_command(), which calls the MCP tool bound to it and
+ * tells the server afterwards. Engines often report a phrase on
+ * consecutive blocks, so the same command fires again only after it went
+ * unreported for `repeat_guard_ms`.
+ *
+ * is_enabled() (optional) is asked every frame; while it returns false the
+ * recognizer does not run, e.g. to listen only when idle and leave
+ * commands spoken during a conversation to the server.
+ *
+ * The stage and its callbacks run on the pipeline thread.
+ */
+typedef struct audio_command audio_command_t;
+
+/**
+ * Command stage configuration; zero fields take the defaults
+ */
+typedef struct {
+    size_t frame_samples;           // Samples per frame, all channels (required)
+    int frame_duration_ms;          // Frame duration (default 20)
+    int repeat_guard_ms;            // Ignore the same command again this long (default 1000, <0 off)
+    void (*on_command)(void* user_data, const char* command);  // Command recognized
+    bool (*is_enabled)(void* user_data);    // Recognizer runs for this frame (NULL: always)
+    void* user_data;
+} audio_command_config_t;
+
+/**
+ * Command stage statistics
+ */
+typedef struct {
+    uint64_t frames;                // Frames seen
+    uint64_t recognized_frames;     // Frames given to the recognizer
+    uint64_t commands;              // Commands passed to on_command()
+    uint64_t repeats;               // Matches dropped by the repeat guard
+} audio_command_stats_t;
+
+/**
+ * Create a command stage
+ * @param recognizer Command recognizer (not owned; must outlive the stage)
+ * @return Stage instance or NULL on failure
+ */
+audio_command_t* audio_command_create(audio_kws_t* recognizer, const audio_command_config_t* config);
+
+/**
+ * Destroy a command stage
+ */
+void audio_command_destroy(audio_command_t* command);
+
+/**
+ * Pipeline stage running the recognizer (AUDIO_STAGE_READ_ONLY)
+ */
+audio_stage_t audio_command_stage(audio_command_t* command);
+
+/**
+ * Get statistics (any thread)
+ */
+bool audio_command_get_stats(const audio_command_t* command, audio_command_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIO_COMMAND_H
@@ -0,0 +1,553 @@
+#include "audio_dsp.h"
+#include <math.h>
+
+// AUDIO_DSP_SCALAR builds only the scalar loops (reference for the backend tests)
+#if defined(AUDIO_DSP_SCALAR)
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define AUDIO_DSP_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define AUDIO_DSP_SSE2 1
+#endif
+
+#define AUDIO_DSP_GAIN_SHIFT 12
+#define AUDIO_DSP_GAIN_MAX   32767     // Just under 8.0 in Q12
+
+static inline short saturate_s16(int32_t v) {
+    if (v > 32767) {
+        return 32767;
+    }
+    if (v < -32768) {
+        return -32768;
+    }
+    return (short)v;
+}
+
+static int32_t gain_to_q12(float gain) {
+    long q = lrintf(gain * (float)(1 << AUDIO_DSP_GAIN_SHIFT));
+    if (q < 0) {
+        return 0;
+    }
+    return q > AUDIO_DSP_GAIN_MAX ? AUDIO_DSP_GAIN_MAX : (int32_t)q;
+}
+
+const char* audio_dsp_backend(void) {
+#if defined(AUDIO_DSP_NEON)
+    return "neon";
+#elif defined(AUDIO_DSP_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+void audio_dsp_gain(short* pcm, size_t count, float gain) {
+    if (!pcm) {
+        return;
+    }
+
+    int32_t q = gain_to_q12(gain);
+    if (q == (1 << AUDIO_DSP_GAIN_SHIFT)) {
+        return;
+    }
+    const int16_t g = (int16_t)q;
+
+    size_t i = 0;
+#if defined(AUDIO_DSP_NEON)
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t x = vld1q_s16(pcm + i);
+        int32x4_t lo = vmull_n_s16(vget_low_s16(x), g);
+        int32x4_t hi = vmull_n_s16(vget_high_s16(x), g);
+        vst1q_s16(pcm + i, vcombine_s16(vqrshrn_n_s32(lo, AUDIO_DSP_GAIN_SHIFT),
+                                        vqrshrn_n_s32(hi, AUDIO_DSP_GAIN_SHIFT)));
+    }
+#elif defined(AUDIO_DSP_SSE2)
+    const __m128i vg = _mm_set1_epi16(g);
+    const __m128i round = _mm_set1_epi32(1 << (AUDIO_DSP_GAIN_SHIFT - 1));
+    for (; i + 8 <= count; i += 8) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(pcm + i));
+        __m128i plo = _mm_mullo_epi16(x, vg);
+        __m128i phi = _mm_mulhi_epi16(x, vg);
+        __m128i lo = _mm_srai_epi32(_mm_add_epi32(_mm_unpacklo_epi16(plo, phi), round), AUDIO_DSP_GAIN_SHIFT);
+        __m128i hi = _mm_srai_epi32(_mm_add_epi32(_mm_unpackhi_epi16(plo, phi), round), AUDIO_DSP_GAIN_SHIFT);
+        _mm_storeu_si128((__m128i*)(pcm + i), _mm_packs_epi32(lo, hi));
+    }
+#endif
+    for (; i < count; i++) {
+        int32_t v = ((int32_t)pcm[i] * g + (1 << (AUDIO_DSP_GAIN_SHIFT - 1))) >> AUDIO_DSP_GAIN_SHIFT;
+        pcm[i] = saturate_s16(v);
+    }
+}
+
+// The ramp accumulates the Q12 gain with 15 extra fraction bits; the largest
+// gain (32767 << 15) still fits in an int32
+#define AUDIO_DSP_RAMP_SHIFT 15
+
+void audio_dsp_gain_ramp(short* pcm, size_t count, float gain_start, float gain_end) {
+    if (!pcm || count == 0) {
+        return;
+    }
+
+    int32_t q_start = gain_to_q12(gain_start);
+    int32_t q_end = gain_to_q12(gain_end);
+    if (q_start == q_end) {
+        audio_dsp_gain(pcm, count, gain_start);
+        return;
+    }
+
+    // Sample i uses (acc + i * step) >> RAMP_SHIFT; |i * step| never exceeds
+    // the distance between the endpoints, so the gain stays in range
+    const int32_t acc = q_start * (1 << AUDIO_DSP_RAMP_SHIFT);
+    const int32_t step = (int32_t)((int64_t)(q_end - q_start) * (1 << AUDIO_DSP_RAMP_SHIFT) / (int64_t)count);
+
+    size_t i = 0;
+#if defined(AUDIO_DSP_NEON)
+    // Lane offsets are only formed when a full vector exists (step * 8 is in range then)
+    if (count >= 8) {
+        const int32_t lanes[4] = { 0, 1, 2, 3 };
+        int32x4_t acc_lo = vmlaq_n_s32(vdupq_n_s32(acc), vld1q_s32(lanes), step);
+        int32x4_t acc_hi = vaddq_s32(acc_lo, vdupq_n_s32(step * 4));
+        const int32x4_t advance = vdupq_n_s32(step * 8);
+        for (; i + 8 <= count; i += 8) {
+            int16x8_t x = vld1q_s16(pcm + i);
+            int16x4_t g_lo = vshrn_n_s32(acc_lo, AUDIO_DSP_RAMP_SHIFT);
+            int16x4_t g_hi = vshrn_n_s32(acc_hi, AUDIO_DSP_RAMP_SHIFT);
+            int32x4_t lo = vmull_s16(vget_low_s16(x), g_lo);
+            int32x4_t hi = vmull_s16(vget_high_s16(x), g_hi);
+            vst1q_s16(pcm + i, vcombine_s16(vqrshrn_n_s32(lo, AUDIO_DSP_GAIN_SHIFT),
+                                            vqrshrn_n_s32(hi, AUDIO_DSP_GAIN_SHIFT)));
+            acc_lo = vaddq_s32(acc_lo, advance);
+            acc_hi = vaddq_s32(acc_hi, advance);
+        }
+    }
+#elif defined(AUDIO_DSP_SSE2)
+    // Lane offsets are only formed when a full vector exists (step * 8 is in range then)
+    if (count >= 8) {
+        __m128i acc_lo = _mm_setr_epi32(acc, acc + step, acc + step * 2, acc + step * 3);
+        __m128i acc_hi = _mm_add_epi32(acc_lo, _mm_set1_epi32(step * 4));
+        const __m128i advance = _mm_set1_epi32(step * 8);
+        const __m128i round = _mm_set1_epi32(1 << (AUDIO_DSP_GAIN_SHIFT - 1));
+        for (; i + 8 <= count; i += 8) {
+            __m128i x = _mm_loadu_si128((const __m128i*)(pcm + i));
+            __m128i vg = _mm_packs_epi32(_mm_srai_epi32(acc_lo, AUDIO_DSP_RAMP_SHIFT),
+                                         _mm_srai_epi32(acc_hi, AUDIO_DSP_RAMP_SHIFT));
+            __m128i plo = _mm_mullo_epi16(x, vg);
+            __m128i phi = _mm_mulhi_epi16(x, vg);
+            __m128i lo = _mm_srai_epi32(_mm_add_epi32(_mm_unpacklo_epi16(plo, phi), round), AUDIO_DSP_GAIN_SHIFT);
+            __m128i hi = _mm_srai_epi32(_mm_add_epi32(_mm_unpackhi_epi16(plo, phi), round), AUDIO_DSP_GAIN_SHIFT);
+            _mm_storeu_si128((__m128i*)(pcm + i), _mm_packs_epi32(lo, hi));
+            acc_lo = _mm_add_epi32(acc_lo, advance);
+            acc_hi = _mm_add_epi32(acc_hi, advance);
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        int32_t g = (acc + (int32_t)i * step) >> AUDIO_DSP_RAMP_SHIFT;
+        int32_t v = ((int32_t)pcm[i] * g + (1 << (AUDIO_DSP_GAIN_SHIFT - 1))) >> AUDIO_DSP_GAIN_SHIFT;
+        pcm[i] = saturate_s16(v);
+    }
+}
+
+void audio_dsp_mix(short* dst, const short* src, size_t count) {
+    if (!dst || !src) {
+        return;
+    }
+
+    size_t i = 0;
+#if defined(AUDIO_DSP_NEON)
+    for (; i + 8 <= count; i += 8) {
+        vst1q_s16(dst + i, vqaddq_s16(vld1q_s16(dst + i), vld1q_s16(src + i)));
+    }
+#elif defined(AUDIO_DSP_SSE2)
+    for (; i + 8 <= count; i += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(dst + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(src + i));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_adds_epi16(a, b));
+    }
+#endif
+    for (; i < count; i++) {
+        dst[i] = saturate_s16((int32_t)dst[i] + src[i]);
+    }
+}
+
+void audio_dsp_s16_to_float(const short* in, float* out, size_t count) {
+    if (!in || !out) {
+        return;
+    }
+
+    const float scale = 1.0f / 32768.0f;
+    size_t i = 0;
+#if defined(AUDIO_DSP_NEON)
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t x = vld1q_s16(in + i);
+        vst1q_f32(out + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(x))), scale));
+        vst1q_f32(out + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(x))), scale));
+    }
+#elif defined(AUDIO_DSP_SSE2)
+    const __m128 vscale = _mm_set1_ps(scale);
+    for (; i + 8 <= count; i += 8) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(in + i));
+        // Sign-extend by placing each sample in the upper half and shifting back down
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), vscale));
+        _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), vscale));
+    }
+#endif
+    for (; i < count; i++) {
+        out[i] = (float)in[i] * scale;
+    }
+}
+
+void audio_dsp_float_to_s16(const float* in, short* out, size_t count) {
+    if (!in || !out) {
+        return;
+    }
+
+    // Clamp first, then add +-0.5 and truncate, so every backend rounds the same way
+    size_t i = 0;
+#if defined(AUDIO_DSP_NEON)
+    const float32x4_t vmax = vdupq_n_f32(32767.0f);
+    const float32x4_t vmin = vdupq_n_f32(-32768.0f);
+    const float32x4_t half = vdupq_n_f32(0.5f);
+    const uint32x4_t sign_mask = vdupq_n_u32(0x80000000u);
+    for (; i + 8 <= count; i += 8) {
+        int32x4_t r[2];
+        for (int k = 0; k < 2; k++) {
+            float32x4_t v = vmulq_n_f32(vld1q_f32(in + i + 4 * k), 32768.0f);
+            v = vminq_f32(vmaxq_f32(v, vmin), vmax);
+            uint32x4_t bias = vorrq_u32(vandq_u32(vreinterpretq_u32_f32(v), sign_mask),
+                                        vreinterpretq_u32_f32(half));
+            r[k] = vcvtq_s32_f32(vaddq_f32(v, vreinterpretq_f32_u32(bias)));
+        }
+        vst1q_s16(out + i, vcombine_s16(vqmovn_s32(r[0]), vqmovn_s32(r[1])));
+    }
+#elif defined(AUDIO_DSP_SSE2)
+    const __m128 vmax = _mm_set1_ps(32767.0f);
+    const __m128 vmin = _mm_set1_ps(-32768.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 sign_mask = _mm_set1_ps(-0.0f);
+    const __m128 vscale = _mm_set1_ps(32768.0f);
+    for (; i + 8 <= count; i += 8) {
+        __m128i r[2];
+        for (int k = 0; k < 2; k++) {
+            __m128 v = _mm_mul_ps(_mm_loadu_ps(in + i + 4 * k), vscale);
+            v = _mm_min_ps(_mm_max_ps(v, vmin), vmax);
+            __m128 bias = _mm_or_ps(_mm_and_ps(v, sign_mask), half);
+            r[k] = _mm_cvttps_epi32(_mm_add_ps(v, bias));
+        }
+        _mm_storeu_si128((__m128i*)(out + i), _mm_packs_epi32(r[0], r[1]));
+    }
+#endif
+    for (; i < count; i++) {
+        float v = in[i] * 32768.0f;
+        if (v > 32767.0f) {
+            v = 32767.0f;
+        } else if (v < -32768.0f) {
+            v = -32768.0f;
+        }
+        v += v < 0.0f ? -0.5f : 0.5f;
+        out[i] = saturate_s16((int32_t)v);
+    }
+}
+
+void audio_dsp_stereo_to_mono(const short* in, short* out, size_t frames) {
+    if (!in || !out) {
+        return;
+    }
+
+    size_t i = 0;
+#if defined(AUDIO_DSP_NEON)
+    for (; i + 8 <= frames; i += 8) {
+        int16x8x2_t lr = vld2q_s16(in + 2 * i);
+        vst1q_s16(out + i, vhaddq_s16(lr.val[0], lr.val[1]));
+    }
+#elif defined(AUDIO_DSP_SSE2)
+    const __m128i ones = _mm_set1_epi16(1);
+    for (; i + 8 <= frames; i += 8) {
+        // madd with ones sums each L/R pair into 32 bits
+        __m128i a = _mm_madd_epi16(_mm_loadu_si128((const __m128i*)(in + 2 * i)), ones);
+        __m128i b = _mm_madd_epi16(_mm_loadu_si128((const __m128i*)(in + 2 * i + 8)), ones);
+        _mm_storeu_si128((__m128i*)(out + i), _mm_packs_epi32(_mm_srai_epi32(a, 1), _mm_srai_epi32(b, 1)));
+    }
+#endif
+    for (; i < frames; i++) {
+        out[i] = (short)(((int32_t)in[2 * i] + in[2 * i + 1]) >> 1);
+    }
+}
+
+void audio_dsp_mono_to_stereo(const short* in, short* out, size_t frames) {
+    if (!in || !out) {
+        return;
+    }
+
+    size_t i = 0;
+#if defined(AUDIO_DSP_NEON)
+    for (; i + 8 <= frames; i += 8) {
+        int16x8_t x = vld1q_s16(in + i);
+        int16x8x2_t lr = { { x, x } };
+        vst2q_s16(out + 2 * i, lr);
+    }
+#elif defined(AUDIO_DSP_SSE2)
+    for (; i + 8 <= frames; i += 8) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(in + i));
+        _mm_storeu_si128((__m128i*)(out + 2 * i), _mm_unpacklo_epi16(x, x));
+        _mm_storeu_si128((__m128i*)(out + 2 * i + 8), _mm_unpackhi_epi16(x, x));
+    }
+#endif
+    for (; i < frames; i++) {
+        out[2 * i] = in[i];
+        out[2 * i + 1] = in[i];
+    }
+}
+
+#if defined(AUDIO_DSP_SSE2)
+/* Split 8 interleaved pairs into their first and second halves; sign
+ * extension keeps every value in range, so the saturating pack is exact */
+static inline void split_pairs(__m128i a, __m128i b, __m128i* first, __m128i* second) {
+    *first = _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(a, 16), 16), _mm_srai_epi32(_mm_slli_epi32(b, 16), 16));
+    *second = _mm_packs_epi32(_mm_srai_epi32(a, 16), _mm_srai_epi32(b, 16));
+}
+#endif
+
+void audio_dsp_deinterleave(const short* in, short* const* out, size_t channels, size_t frames) {
+    if (!in || !out || channels == 0) {
+        return;
+    }
+
+    size_t i = 0;
+    if (channels == 2) {
+#if defined(AUDIO_DSP_NEON)
+        for (; i + 8 <= frames; i += 8) {
+            int16x8x2_t x = vld2q_s16(in + 2 * i);
+            vst1q_s16(out[0] + i, x.val[0]);
+            vst1q_s16(out[1] + i, x.val[1]);
+        }
+#elif defined(AUDIO_DSP_SSE2)
+        for (; i + 8 <= frames; i += 8) {
+            __m128i first, second;
+            split_pairs(_mm_loadu_si128((const __m128i*)(in + 2 * i)),
+                        _mm_loadu_si128((const __m128i*)(in + 2 * i + 8)), &first, &second);
+            _mm_storeu_si128((__m128i*)(out[0] + i), first);
+            _mm_storeu_si128((__m128i*)(out[1] + i), second);
+        }
+#endif
+    } else if (channels == 4) {
+#if defined(AUDIO_DSP_NEON)
+        for (; i + 8 <= frames; i += 8) {
+            int16x8x4_t x = vld4q_s16(in + 4 * i);
+            vst1q_s16(out[0] + i, x.val[0]);
+            vst1q_s16(out[1] + i, x.val[1]);
+            vst1q_s16(out[2] + i, x.val[2]);
+            vst1q_s16(out[3] + i, x.val[3]);
+        }
+#elif defined(AUDIO_DSP_SSE2)
+        // Two rounds of pair splitting: 0 2 | 1 3, then 0 | 2 and 1 | 3
+        for (; i + 8 <= frames; i += 8) {
+            const __m128i* src = (const __m128i*)(in + 4 * i);
+            __m128i even_lo, odd_lo, even_hi, odd_hi, c0, c1, c2, c3;
+            split_pairs(_mm_loadu_si128(src), _mm_loadu_si128(src + 1), &even_lo, &odd_lo);
+            split_pairs(_mm_loadu_si128(src + 2), _mm_loadu_si128(src + 3), &even_hi, &odd_hi);
+            split_pairs(even_lo, even_hi, &c0, &c2);
+            split_pairs(odd_lo, odd_hi, &c1, &c3);
+            _mm_storeu_si128((__m128i*)(out[0] + i), c0);
+            _mm_storeu_si128((__m128i*)(out[1] + i), c1);
+            _mm_storeu_si128((__m128i*)(out[2] + i), c2);
+            _mm_storeu_si128((__m128i*)(out[3] + i), c3);
+        }
+#endif
+    }
+    for (; i < frames; i++) {
+        for (size_t c = 0; c < channels; c++) {
+            out[c][i] = in[i * channels + c];
+        }
+    }
+}
+
+uint64_t audio_dsp_sum_squares(const short* pcm, size_t count) {
+    if (!pcm) {
+        return 0;
+    }
+
+    uint64_t sum = 0;
+    size_t i = 0;
+#if defined(AUDIO_DSP_NEON)
+    uint64x2_t acc = vdupq_n_u64(0);
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t x = vld1q_s16(pcm + i);
+        // Each square is at most 2^30 and non-negative, so it fits in a u32 lane
+        uint32x4_t lo = vreinterpretq_u32_s32(vmull_s16(vget_low_s16(x), vget_low_s16(x)));
+        uint32x4_t hi = vreinterpretq_u32_s32(vmull_s16(vget_high_s16(x), vget_high_s16(x)));
+        acc = vpadalq_u32(acc, lo);
+        acc = vpadalq_u32(acc, hi);
+    }
+    sum = vgetq_lane_u64(acc, 0) + vgetq_lane_u64(acc, 1);
+#elif defined(AUDIO_DSP_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = zero;
+    for (; i + 8 <= count; i += 8) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(pcm + i));
+        // Pair sums reach 2^31 only for two -32768 samples, which still fits unsigned
+        __m128i sq = _mm_madd_epi16(x, x);
+        acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(sq, zero));
+        acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(sq, zero));
+    }
+    uint64_t lanes[2];
+    _mm_storeu_si128((__m128i*)lanes, acc);
+    sum = lanes[0] + lanes[1];
+#endif
+    for (; i < count; i++) {
+        int32_t s = pcm[i];
+        sum += (uint64_t)(s * s);
+    }
+    return sum;
+}
+
+float audio_dsp_rms(const short* pcm, size_t count) {
+    if (!pcm || count == 0) {
+        return 0.0f;
+    }
+    return (float)sqrt((double)audio_dsp_sum_squares(pcm, count) / (double)count);
+}
+
+int audio_dsp_peak(const short* pcm, size_t count) {
+    if (!pcm) {
+        return 0;
+    }
+
+    int16_t max = 0;
+    int16_t min = 0;
+    size_t i = 0;
+#if defined(AUDIO_DSP_NEON)
+    if (count >= 8) {
+        int16x8_t vmax = vdupq_n_s16(0);
+        int16x8_t vmin = vdupq_n_s16(0);
+        for (; i + 8 <= count; i += 8) {
+            int16x8_t x = vld1q_s16(pcm + i);
+            vmax = vmaxq_s16(vmax, x);
+            vmin = vminq_s16(vmin, x);
+        }
+        int16x4_t m = vpmax_s16(vget_low_s16(vmax), vget_high_s16(vmax));
+        m = vpmax_s16(m, m);
+        m = vpmax_s16(m, m);
+        max = vget_lane_s16(m, 0);
+        int16x4_t n = vpmin_s16(vget_low_s16(vmin), vget_high_s16(vmin));
+        n = vpmin_s16(n, n);
+        n = vpmin_s16(n, n);
+        min = vget_lane_s16(n, 0);
+    }
+#elif defined(AUDIO_DSP_SSE2)
+    if (count >= 8) {
+        __m128i vmax = _mm_setzero_si128();
+        __m128i vmin = _mm_setzero_si128();
+        for (; i + 8 <= count; i += 8) {
+            __m128i x = _mm_loadu_si128((const __m128i*)(pcm + i));
+            vmax = _mm_max_epi16(vmax, x);
+            vmin = _mm_min_epi16(vmin, x);
+        }
+        int16_t lanes[8];
+        _mm_storeu_si128((__m128i*)lanes, vmax);
+        for (int k = 0; k < 8; k++) {
+            if (lanes[k] > max) {
+                max = lanes[k];
+            }
+        }
+        _mm_storeu_si128((__m128i*)lanes, vmin);
+        for (int k = 0; k < 8; k++) {
+            if (lanes[k] < min) {
+                min = lanes[k];
+            }
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        if (pcm[i] > max) {
+            max = pcm[i];
+        } else if (pcm[i] < min) {
+            min = pcm[i];
+        }
+    }
+    return -(int)min > (int)max ? -(int)min : (int)max;
+}
+
+void audio_dsp_level(const short* pcm, size_t count, uint64_t* sum_squares, int* peak) {
+    uint64_t sum = 0;
+    int16_t max = 0;
+    int16_t min = 0;
+    size_t i = 0;
+    if (!pcm) {
+        count = 0;
+    }
+#if defined(AUDIO_DSP_NEON)
+    if (count >= 8) {
+        uint64x2_t acc = vdupq_n_u64(0);
+        int16x8_t vmax = vdupq_n_s16(0);
+        int16x8_t vmin = vdupq_n_s16(0);
+        for (; i + 8 <= count; i += 8) {
+            int16x8_t x = vld1q_s16(pcm + i);
+            uint32x4_t lo = vreinterpretq_u32_s32(vmull_s16(vget_low_s16(x), vget_low_s16(x)));
+            uint32x4_t hi = vreinterpretq_u32_s32(vmull_s16(vget_high_s16(x), vget_high_s16(x)));
+            acc = vpadalq_u32(acc, lo);
+            acc = vpadalq_u32(acc, hi);
+            vmax = vmaxq_s16(vmax, x);
+            vmin = vminq_s16(vmin, x);
+        }
+        sum = vgetq_lane_u64(acc, 0) + vgetq_lane_u64(acc, 1);
+        int16x4_t m = vpmax_s16(vget_low_s16(vmax), vget_high_s16(vmax));
+        m = vpmax_s16(m, m);
+        m = vpmax_s16(m, m);
+        max = vget_lane_s16(m, 0);
+        int16x4_t n = vpmin_s16(vget_low_s16(vmin), vget_high_s16(vmin));
+        n = vpmin_s16(n, n);
+        n = vpmin_s16(n, n);
+        min = vget_lane_s16(n, 0);
+    }
+#elif defined(AUDIO_DSP_SSE2)
+    if (count >= 8) {
+        const __m128i zero = _mm_setzero_si128();
+        __m128i acc = zero;
+        __m128i vmax = zero;
+        __m128i vmin = zero;
+        for (; i + 8 <= count; i += 8) {
+            __m128i x = _mm_loadu_si128((const __m128i*)(pcm + i));
+            __m128i sq = _mm_madd_epi16(x, x);
+            acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(sq, zero));
+            acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(sq, zero));
+            vmax = _mm_max_epi16(vmax, x);
+            vmin = _mm_min_epi16(vmin, x);
+        }
+        uint64_t sums[2];
+        _mm_storeu_si128((__m128i*)sums, acc);
+        sum = sums[0] + sums[1];
+        int16_t lanes[8];
+        _mm_storeu_si128((__m128i*)lanes, vmax);
+        for (int k = 0; k < 8; k++) {
+            if (lanes[k] > max) {
+                max = lanes[k];
+            }
+        }
+        _mm_storeu_si128((__m128i*)lanes, vmin);
+        for (int k = 0; k < 8; k++) {
+            if (lanes[k] < min) {
+                min = lanes[k];
+            }
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        int32_t s = pcm[i];
+        sum += (uint64_t)(s * s);
+        if (pcm[i] > max) {
+            max = pcm[i];
+        } else if (pcm[i] < min) {
+            min = pcm[i];
+        }
+    }
+    if (sum_squares) {
+        *sum_squares = sum;
+    }
+    if (peak) {
+        *peak = -(int)min > (int)max ? -(int)min : (int)max;
+    }
+}
@@ -0,0 +1,104 @@
+#ifndef AUDIO_DSP_H
+#define AUDIO_DSP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * PCM utility kernels
+ *
+ * Per-sample loops shared by the audio pipeline (volume, mixing, format
+ * conversion, channel conversion, level metering). Each kernel has a NEON,
+ * an SSE2 and a scalar implementation; the vector path is chosen at compile
+ * time from the target flags (__ARM_NEON / __SSE2__), and the scalar loop
+ * handles the tail and every other target. Defining AUDIO_DSP_SCALAR
+ * forces the scalar loops. All backends produce identical results
+ * (checked by sdk/audio/test/audio_test_dsp.c).
+ *
+ * Buffers need no particular alignment. Unless noted otherwise, input and
+ * output may be the same buffer.
+ */
+
+/**
+ * Name of the compiled-in vector backend ("neon", "sse2" or "scalar")
+ */
+const char* audio_dsp_backend(void);
+
+/**
+ * Scale samples by `gain`, saturating (gain is applied in Q12, range 0..8)
+ */
+void audio_dsp_gain(short* pcm, size_t count, float gain);
+
+/**
+ * Scale samples by a gain ramping linearly from `gain_start` (first sample)
+ * towards `gain_end` (reached by the sample after the last one), saturating
+ * Same Q12 arithmetic and range as audio_dsp_gain(); consecutive calls with
+ * matching end/start gains form a continuous ramp with no steps at the seams
+ */
+void audio_dsp_gain_ramp(short* pcm, size_t count, float gain_start, float gain_end);
+
+/**
+ * Mix `src` into `dst` with saturation: dst = sat(dst + src)
+ */
+void audio_dsp_mix(short* dst, const short* src, size_t count);
+
+/**
+ * int16 -> float in [-1, 1)
+ */
+void audio_dsp_s16_to_float(const short* in, float* out, size_t count);
+
+/**
+ * float in [-1, 1) -> int16, rounded half away from zero and saturated
+ */
+void audio_dsp_float_to_s16(const float* in, short* out, size_t count);
+
+/**
+ * Interleaved stereo -> mono, averaging both channels
+ * @param frames Stereo frames in `in`; `out` receives `frames` samples
+ */
+void audio_dsp_stereo_to_mono(const short* in, short* out, size_t frames);
+
+/**
+ * Mono -> interleaved stereo, duplicating each sample
+ * `out` receives 2 * `frames` samples and must not overlap `in`
+ */
+void audio_dsp_mono_to_stereo(const short* in, short* out, size_t frames);
+
+/**
+ * Interleaved -> planar: out[c][i] = in[i * channels + c]
+ * Vector paths for 2 and 4 channels, scalar for any other count.
+ * `out` holds `channels` buffers of `frames` samples that must not overlap `in`
+ */
+void audio_dsp_deinterleave(const short* in, short* const* out, size_t channels, size_t frames);
+
+/**
+ * Sum of squared samples (basis for RMS and energy)
+ */
+uint64_t audio_dsp_sum_squares(const short* pcm, size_t count);
+
+/**
+ * Root mean square level, 0 for an empty buffer
+ */
+float audio_dsp_rms(const short* pcm, size_t count);
+
+/**
+ * Peak absolute sample value (0..32768)
+ */
+int audio_dsp_peak(const short* pcm, size_t count);
+
+/**
+ * Sum of squares and peak in a single pass over `pcm` (level metering)
+ * Same results as audio_dsp_sum_squares() and audio_dsp_peak(); either output
+ * may be NULL
+ */
+void audio_dsp_level(const short* pcm, size_t count, uint64_t* sum_squares, int* peak);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIO_DSP_H
@@ -1,5 +1,6 @@
 #include "audio_interface.h"
 #include "../log/linx_log.h"
+#include "../os/linx_os.h"
 
 int audio_interface_init(AudioInterface* self) {
     if (!self || !self->vtable || !self->vtable->init) {
@@ -35,7 +36,51 @@ int audio_interface_read(AudioInterface* self, short* buffer, size_t frame_size)
         LOG_ERROR("Invalid audio interface or vtable");
         return -1;
     }
-    return self->vtable->read(self, buffer, frame_size);
+    int result = self->vtable->read(self, buffer, frame_size);
+    audio_level_meter_t* meter = __atomic_load_n(&self->capture_level, __ATOMIC_ACQUIRE);
+    if (meter && result == 0) {
+        audio_level_meter_process(meter, buffer, frame_size);
+    }
+    return result;
+}
+
+int audio_interface_read_timed(AudioInterface* self, short* buffer, size_t frame_size, uint32_t timeout_us,
+                               uint64_t* time_us) {
+    if (!self || !self->vtable || !self->vtable->read) {
+        LOG_ERROR("Invalid audio interface or vtable");
+        return -1;
+    }
+    uint64_t device_time = 0;
+    int result;
+    if (self->vtable->read_timed) {
+        result = self->vtable->read_timed(self, buffer, frame_size, timeout_us, &device_time);
+    } else {
+        result = self->vtable->read(self, buffer, frame_size);
+        if (result == 0 && self->vtable->get_capture_time &&
+            self->vtable->get_capture_time(self, &device_time) != 0) {
+            device_time = 0;
+        }
+    }
+    if (result != 0) {
+        return result;
+    }
+
+    audio_level_meter_t* meter = __atomic_load_n(&self->capture_level, __ATOMIC_ACQUIRE);
+    if (meter) {
+        audio_level_meter_process(meter, buffer, frame_size);
+    }
+    if (time_us) {
+        if (device_time == 0) {
+            // The read returned as its last frame arrived
+            int channels = self->channels > 0 ? self->channels : 1;
+            uint64_t duration = self->sample_rate ?
+                (uint64_t)(frame_size / (size_t)channels) * 1000000u / self->sample_rate : 0;
+            uint64_t now = linx_os_now_us();
+            device_time = now > duration ? now - duration : 0;
+        }
+        *time_us = device_time;
+    }
+    return 0;
 }
 
 int audio_interface_write(AudioInterface* self, short* buffer, size_t frame_size) {
@@ -43,7 +88,12 @@ int audio_interface_write(AudioInterface* self, short* buffer, size_t frame_size
         LOG_ERROR("Invalid audio interface or vtable");
         return -1;
     }
-    return self->vtable->write(self, buffer, frame_size);
+    int result = self->vtable->write(self, buffer, frame_size);
+    audio_level_meter_t* meter = __atomic_load_n(&self->playback_level, __ATOMIC_ACQUIRE);
+    if (meter && result == 0) {
+        audio_level_meter_process(meter, buffer, frame_size);
+    }
+    return result;
 }
 
 int audio_interface_record(AudioInterface* self) {
@@ -71,6 +121,105 @@ bool audio_interface_is_play_buffer_empty(AudioInterface* self) {
     return self->vtable->is_play_buffer_empty(self);
 }
 
+int audio_interface_set_pull_source(AudioInterface* self, audio_pull_callback_t callback, void* user_data) {
+    if (!self || !self->vtable) {
+        LOG_ERROR("Invalid audio interface or vtable");
+        return -1;
+    }
+    if (!self->vtable->set_pull_source) {
+        return -1;
+    }
+    return self->vtable->set_pull_source(self, callback, user_data);
+}
+
+bool audio_interface_supports_pull(const AudioInterface* self) {
+    return self && self->vtable && self->vtable->set_pull_source;
+}
+
+int audio_interface_flush_play(AudioInterface* self) {
+    if (!self || !self->vtable) {
+        LOG_ERROR("Invalid audio interface or vtable");
+        return -1;
+    }
+    if (!self->vtable->flush_play) {
+        return -1;
+    }
+    return self->vtable->flush_play(self);
+}
+
+int audio_interface_acquire_frame(AudioInterface* self, audio_capture_frame_t* frame, int timeout_ms) {
+    if (!self || !self->vtable || !frame) {
+        LOG_ERROR("Invalid audio interface or vtable");
+        return -1;
+    }
+    if (!self->vtable->acquire_frame) {
+        return -1;
+    }
+    int result = self->vtable->acquire_frame(self, frame, timeout_ms);
+    audio_level_meter_t* meter = __atomic_load_n(&self->capture_level, __ATOMIC_ACQUIRE);
+    if (meter && result == 0) {
+        size_t channels = self->channels > 0 ? (size_t)self->channels : 1;
+        audio_level_meter_process(meter, frame->data, frame->frame_count * channels);
+    }
+    return result;
+}
+
+int audio_interface_release_frame(AudioInterface* self, audio_capture_frame_t* frame) {
+    if (!self || !self->vtable || !self->vtable->release_frame || !frame) {
+        LOG_ERROR("Invalid audio interface or vtable");
+        return -1;
+    }
+    return self->vtable->release_frame(self, frame);
+}
+
+bool audio_interface_supports_acquire(const AudioInterface* self) {
+    return self && self->vtable && self->vtable->acquire_frame && self->vtable->release_frame;
+}
+
+int audio_interface_get_capture_time(AudioInterface* self, uint64_t* time_us) {
+    if (!self || !self->vtable || !time_us) {
+        LOG_ERROR("Invalid audio interface or vtable");
+        return -1;
+    }
+    if (!self->vtable->get_capture_time) {
+        return -1;
+    }
+    return self->vtable->get_capture_time(self, time_us);
+}
+
+bool audio_interface_supports_capture_time(const AudioInterface* self) {
+    return self && self->vtable && self->vtable->get_capture_time;
+}
+
+int audio_interface_get_play_delay(AudioInterface* self, uint32_t* delay_us) {
+    if (!self || !self->vtable || !delay_us) {
+        LOG_ERROR("Invalid audio interface or vtable");
+        return -1;
+    }
+    if (!self->vtable->get_play_delay) {
+        return -1;
+    }
+    return self->vtable->get_play_delay(self, delay_us);
+}
+
+bool audio_interface_supports_play_delay(const AudioInterface* self) {
+    return self && self->vtable && self->vtable->get_play_delay;
+}
+
+bool audio_interface_supports_read_timed(const AudioInterface* self) {
+    return self && self->vtable && self->vtable->read_timed;
+}
+
+void audio_interface_set_level_meters(AudioInterface* self, audio_level_meter_t* capture,
+                                      audio_level_meter_t* playback) {
+    if (!self) {
+        LOG_ERROR("Invalid audio interface");
+        return;
+    }
+    __atomic_store_n(&self->capture_level, capture, __ATOMIC_RELEASE);
+    __atomic_store_n(&self->playback_level, playback, __ATOMIC_RELEASE);
+}
+
 int audio_interface_destroy(AudioInterface* self) {
     if (!self || !self->vtable || !self->vtable->destroy) {
         LOG_ERROR("Invalid audio interface or vtable");
@@ -2,7 +2,9 @@
 #define AUDIO_INTERFACE_H
 
 #include <stddef.h>
+#include <stdint.h>
 #include <stdbool.h>
+#include "audio_level.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -13,6 +15,29 @@ extern "C" {
  */
 typedef struct AudioInterface AudioInterface;
 
+/* read_timed() result when the deadline passed before the data was captured */
+#define AUDIO_READ_TIMEOUT 1
+
+/**
+ * Pull-mode playback source
+ * Called from the device's output callback to fill `buffer` with up to
+ * `frame_count` frames (interleaved). Returns the number of frames produced;
+ * the device outputs silence for the remainder.
+ */
+typedef size_t (*audio_pull_callback_t)(void* user_data, short* buffer, size_t frame_count);
+
+/**
+ * Capture buffer borrowed from the device (zero-copy read)
+ * `data` points into driver-owned memory and stays valid until the frame is
+ * handed back with audio_interface_release_frame(). `token` is private to the
+ * implementation.
+ */
+typedef struct {
+    const short* data;      // Interleaved PCM
+    size_t frame_count;     // Frames available at `data`
+    void* token;            // Release token
+} audio_capture_frame_t;
+
 /**
  * Audio interface function pointers
  */
@@ -26,6 +51,29 @@ typedef struct {
     int (*init_play)(AudioInterface* self);
     bool (*is_play_buffer_empty)(AudioInterface* self);
     int (*destroy)(AudioInterface* self);
+    // Optional: let the output callback pull PCM directly instead of draining
+    // what write() queued. Pass NULL to return to push mode.
+    int (*set_pull_source)(AudioInterface* self, audio_pull_callback_t callback, void* user_data);
+    // Optional: borrow the next captured frame from the driver instead of
+    // copying it with read(). Every acquired frame must be released.
+    int (*acquire_frame)(AudioInterface* self, audio_capture_frame_t* frame, int timeout_ms);
+    int (*release_frame)(AudioInterface* self, audio_capture_frame_t* frame);
+    // Optional: drop the PCM queued through write() that the device has not
+    // played yet (e.g. on barge-in). Safe to call from the producer thread.
+    int (*flush_play)(AudioInterface* self);
+    // Optional: device clock time (microseconds) of the first sample of the
+    // frame last returned by read() / acquire_frame(). Capture thread only.
+    int (*get_capture_time)(AudioInterface* self, uint64_t* time_us);
+    // Optional: time (microseconds) until PCM handed over now through write()
+    // or the pull callback is heard: PCM the driver has queued but not played
+    // plus the device's own output latency. Any thread.
+    int (*get_play_delay)(AudioInterface* self, uint32_t* delay_us);
+    // Optional: read() bounded by `timeout_us`, waking on the driver's own
+    // period notification. Returns 0, AUDIO_READ_TIMEOUT when the deadline
+    // passed first (nothing consumed) or -1 on error; `time_us` gets the
+    // device clock time of the first frame, 0 if unknown.
+    int (*read_timed)(AudioInterface* self, short* buffer, size_t frame_size, uint32_t timeout_us,
+                      uint64_t* time_us);
 } AudioInterfaceVTable;
 
 /**
@@ -47,6 +95,10 @@ struct AudioInterface {
     bool is_recording;
     bool is_playing;
     bool is_initialized;
+
+    // Level taps (audio_interface_set_level_meters), NULL when not metered
+    audio_level_meter_t* capture_level;
+    audio_level_meter_t* playback_level;
 };
 
 /**
@@ -86,6 +138,94 @@ int audio_interface_init_play(AudioInterface* self);
  */
 bool audio_interface_is_play_buffer_empty(AudioInterface* self);
 
+/**
+ * Set pull-mode playback source (NULL callback restores push mode)
+ * Returns -1 if the implementation does not support pull mode
+ */
+int audio_interface_set_pull_source(AudioInterface* self, audio_pull_callback_t callback, void* user_data);
+
+/**
+ * Check if pull-mode playback is supported
+ */
+bool audio_interface_supports_pull(const AudioInterface* self);
+
+/**
+ * Drop queued playback PCM; takes effect by the next device period
+ * Returns -1 if the implementation cannot flush its play buffer
+ */
+int audio_interface_flush_play(AudioInterface* self);
+
+/**
+ * Borrow the next captured frame (blocks up to timeout_ms, -1 for infinite)
+ * Returns 0 on success, -1 on timeout/error or if zero-copy capture is not
+ * supported; use audio_interface_read() then
+ */
+int audio_interface_acquire_frame(AudioInterface* self, audio_capture_frame_t* frame, int timeout_ms);
+
+/**
+ * Hand a frame obtained with audio_interface_acquire_frame() back to the driver
+ */
+int audio_interface_release_frame(AudioInterface* self, audio_capture_frame_t* frame);
+
+/**
+ * Check if zero-copy capture is supported
+ */
+bool audio_interface_supports_acquire(const AudioInterface* self);
+
+/**
+ * Device clock time of the first sample of the last frame read or acquired
+ * Returns -1 if the implementation has no capture clock (or nothing was
+ * captured yet); time the read on the host clock then
+ */
+int audio_interface_get_capture_time(AudioInterface* self, uint64_t* time_us);
+
+/**
+ * Check if the device reports capture times
+ */
+bool audio_interface_supports_capture_time(const AudioInterface* self);
+
+/**
+ * Output delay: how long until a sample written (or pulled) now is played
+ * Returns -1 if the implementation cannot tell; the caller then has no better
+ * estimate than the PCM it knows it queued itself
+ */
+int audio_interface_get_play_delay(AudioInterface* self, uint32_t* delay_us);
+
+/**
+ * Check if the device reports its output delay
+ */
+bool audio_interface_supports_play_delay(const AudioInterface* self);
+
+/**
+ * Read `frame_size` like read(), giving up after `timeout_us`
+ * Wakes as soon as the device has the data, so a capture loop built on it
+ * stays period-aligned without sleeping. Returns 0 on success,
+ * AUDIO_READ_TIMEOUT if the deadline passed first (nothing is consumed) and
+ * -1 on error. `time_us` (may be NULL) receives the capture time of the first
+ * frame: the device clock when it has one, otherwise the host clock minus the
+ * read duration. Without a read_timed hook this falls back to read(), whose
+ * blocking time is up to the driver.
+ */
+int audio_interface_read_timed(AudioInterface* self, short* buffer, size_t frame_size, uint32_t timeout_us,
+                               uint64_t* time_us);
+
+/**
+ * Check if the device implements deadline reads (otherwise read() is used)
+ */
+bool audio_interface_supports_read_timed(const AudioInterface* self);
+
+/**
+ * Attach level meters to the capture and playback paths (NULL detaches)
+ * Every period returned by audio_interface_read() / acquire_frame() or
+ * accepted by audio_interface_write() is measured on the calling thread after
+ * the driver call; the device's own callback never runs meter code, so
+ * pull-mode playback is not metered. Without meters each call costs one
+ * atomic load. Keep a detached meter alive until any read/write already
+ * in progress has returned.
+ */
+void audio_interface_set_level_meters(AudioInterface* self, audio_level_meter_t* capture,
+                                      audio_level_meter_t* playback);
+
 /**
  * Destroy audio interface
  */
@@ -0,0 +1,55 @@
+#include "audio_level.h"
+#include "audio_dsp.h"
+#include <math.h>
+
+#define AUDIO_LEVEL_FULL_SCALE 32768.0f
+
+void audio_level_meter_init(audio_level_meter_t* meter) {
+    if (!meter) {
+        return;
+    }
+    __atomic_store_n(&meter->mailbox, 0, __ATOMIC_RELEASE);
+}
+
+void audio_level_meter_process(audio_level_meter_t* meter, const short* pcm, size_t count) {
+    if (!meter || !pcm || count == 0) {
+        return;
+    }
+
+    uint64_t sum = 0;
+    int peak = 0;
+    audio_dsp_level(pcm, count, &sum, &peak);
+    // Both values are at most 32768, so each fits its 16-bit field
+    uint32_t rms = (uint32_t)lrint(sqrt((double)sum / (double)count));
+
+    // Single producer: the sequence only needs to be read back, not CAS'd
+    uint64_t previous = __atomic_load_n(&meter->mailbox, __ATOMIC_RELAXED);
+    uint32_t sequence = (uint32_t)(previous >> 32) + 1;
+    uint64_t packed = (uint64_t)rms | ((uint64_t)(uint32_t)peak << 16) | ((uint64_t)sequence << 32);
+    __atomic_store_n(&meter->mailbox, packed, __ATOMIC_RELEASE);
+}
+
+void audio_level_meter_read(const audio_level_meter_t* meter, audio_level_t* level) {
+    if (!level) {
+        return;
+    }
+    if (!meter) {
+        level->rms = 0.0f;
+        level->peak = 0.0f;
+        level->sequence = 0;
+        return;
+    }
+
+    uint64_t packed = __atomic_load_n(&meter->mailbox, __ATOMIC_ACQUIRE);
+    level->rms = (float)(packed & 0xFFFF) / AUDIO_LEVEL_FULL_SCALE;
+    level->peak = (float)((packed >> 16) & 0xFFFF) / AUDIO_LEVEL_FULL_SCALE;
+    level->sequence = (uint32_t)(packed >> 32);
+}
+
+float audio_level_to_dbfs(float level, float floor_db) {
+    if (level <= 0.0f) {
+        return floor_db;
+    }
+    float db = 20.0f * log10f(level);
+    return db < floor_db ? floor_db : db;
+}
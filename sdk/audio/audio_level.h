@@ -0,0 +1,62 @@
+#ifndef AUDIO_LEVEL_H
+#define AUDIO_LEVEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Audio level meter
+ *
+ * The audio thread measures RMS and peak of each period it already holds
+ * (one audio_dsp_level() pass, no copy) and publishes the result with a
+ * single atomic store into a one-value mailbox. Readers, typically the UI at
+ * display rate, load that value whenever they like; nothing is queued, no
+ * lock is taken and a slow reader simply skips periods.
+ *
+ * Each meter has one producer (the thread that calls process) and any number
+ * of readers. The struct is plain data: embed it or make it static, and keep
+ * it alive for as long as it is attached to an audio interface.
+ */
+
+typedef struct {
+    uint64_t mailbox;       // Packed rms | peak << 16 | sequence << 32
+} audio_level_meter_t;
+
+/**
+ * Snapshot of the last measured period
+ */
+typedef struct {
+    float rms;              // RMS, 0..1 of full scale
+    float peak;             // Peak absolute sample, 0..1 of full scale
+    uint32_t sequence;      // Periods published so far; unchanged means no new audio
+} audio_level_t;
+
+/**
+ * Reset the meter to silence with sequence 0
+ */
+void audio_level_meter_init(audio_level_meter_t* meter);
+
+/**
+ * Measure one period of interleaved PCM and publish it (producer thread)
+ */
+void audio_level_meter_process(audio_level_meter_t* meter, const short* pcm, size_t count);
+
+/**
+ * Read the newest published level (any thread, lock-free)
+ */
+void audio_level_meter_read(const audio_level_meter_t* meter, audio_level_t* level);
+
+/**
+ * Level in dB relative to full scale, clamped to `floor_db` for silence
+ */
+float audio_level_to_dbfs(float level, float floor_db);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIO_LEVEL_H
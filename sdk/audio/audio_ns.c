@@ -0,0 +1,446 @@
+#include "audio_ns.h"
+#include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
+#include <string.h>
+#include <math.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define NS_USE_NEON 1
+#else
+#define NS_USE_NEON 0
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_AUDIO);
+
+#define NS_MAX_HOP                  256
+#define NS_MIN_HOP                  32
+#define NS_DEFAULT_SUPPRESSION_DB   15
+#define NS_DEFAULT_OVER_SUBTRACTION 200
+#define NS_INIT_HOPS                16      // Hops averaged into the first noise estimate
+#define NS_INPUT_SHIFT              7       // Samples enter the FFT as Q7 (x * w >> 8 with a Q15 window)
+#define NS_Q15_ONE                  32767
+
+struct audio_ns {
+    audio_ns_config_t config;
+    size_t hop;                 // Samples per hop, divides frame_samples
+    size_t window_size;         // 2 * hop
+    size_t N;                   // FFT size, power of two >= window_size
+    size_t bins;                // N / 2 + 1
+
+    int16_t* window;            // sqrt periodic Hann, Q15, window_size
+    uint16_t* bitrev;           // N
+    int32_t* tw_re;             // Per stage twiddles at [half - 1 + k], Q31
+    int32_t* tw_im;             // Forward: -sin
+    int32_t* re;                // FFT work, N
+    int32_t* im;
+    int16_t* history;           // Last window_size input samples
+    int32_t* overlap;           // Overlap-add accumulator, window_size
+    int64_t* power;             // Smoothed bin power, bins
+    int64_t* noise;             // Noise floor estimate, bins
+    int32_t* gain;              // Bin gain, Q15, bins
+    int32_t* gain_q31;          // Gain mirrored over all N bins, Q31
+
+    int32_t floor_q15;          // Lowest gain
+    int over_subtraction;       // Percent
+    int strength;               // Requested strength in percent (atomic)
+    int applied_strength;       // Strength floor_q15 and over_subtraction were set for
+    uint32_t hops;              // Hops since reset (saturates)
+
+    uint64_t frames;            // Atomic
+    int mean_gain_q15;          // Atomic
+};
+
+// ============================================================================
+// Fixed-point radix-2 FFT (split real/imaginary Q31 twiddles)
+// ============================================================================
+
+static inline int32_t ns_mul_q31(int32_t a, int32_t w) {
+    return (int32_t)(((int64_t)a * w + ((int64_t)1 << 30)) >> 31);
+}
+
+static void ns_bitrev(const audio_ns_t* ns, int32_t* re, int32_t* im) {
+    for (size_t i = 0; i < ns->N; i++) {
+        size_t j = ns->bitrev[i];
+        if (i < j) {
+            int32_t t = re[i]; re[i] = re[j]; re[j] = t;
+            t = im[i]; im[i] = im[j]; im[j] = t;
+        }
+    }
+}
+
+/* Forward transform scaled by 1/N (every stage halves), inverse unscaled */
+static void ns_fft(const audio_ns_t* ns, int32_t* re, int32_t* im, bool inverse) {
+    const size_t N = ns->N;
+    ns_bitrev(ns, re, im);
+    for (size_t half = 1; half < N; half <<= 1) {
+        const int32_t* wr = ns->tw_re + half - 1;
+        const int32_t* wi = ns->tw_im + half - 1;
+        for (size_t start = 0; start < N; start += 2 * half) {
+            int32_t* ar = re + start;
+            int32_t* ai = im + start;
+            int32_t* br = ar + half;
+            int32_t* bi = ai + half;
+            size_t k = 0;
+#if NS_USE_NEON
+            for (; k + 4 <= half; k += 4) {
+                int32x4_t vwr = vld1q_s32(wr + k);
+                int32x4_t vwi = vld1q_s32(wi + k);
+                if (inverse) {
+                    vwi = vnegq_s32(vwi);
+                }
+                int32x4_t vbr = vld1q_s32(br + k);
+                int32x4_t vbi = vld1q_s32(bi + k);
+                int32x4_t tr = vsubq_s32(vqrdmulhq_s32(vbr, vwr), vqrdmulhq_s32(vbi, vwi));
+                int32x4_t ti = vaddq_s32(vqrdmulhq_s32(vbr, vwi), vqrdmulhq_s32(vbi, vwr));
+                int32x4_t var = vld1q_s32(ar + k);
+                int32x4_t vai = vld1q_s32(ai + k);
+                if (inverse) {
+                    vst1q_s32(ar + k, vaddq_s32(var, tr));
+                    vst1q_s32(ai + k, vaddq_s32(vai, ti));
+                    vst1q_s32(br + k, vsubq_s32(var, tr));
+                    vst1q_s32(bi + k, vsubq_s32(vai, ti));
+                } else {
+                    vst1q_s32(ar + k, vhaddq_s32(var, tr));
+                    vst1q_s32(ai + k, vhaddq_s32(vai, ti));
+                    vst1q_s32(br + k, vhsubq_s32(var, tr));
+                    vst1q_s32(bi + k, vhsubq_s32(vai, ti));
+                }
+            }
+#endif
+            for (; k < half; k++) {
+                int32_t w_im = inverse ? -wi[k] : wi[k];
+                int32_t tr = ns_mul_q31(br[k], wr[k]) - ns_mul_q31(bi[k], w_im);
+                int32_t ti = ns_mul_q31(br[k], w_im) + ns_mul_q31(bi[k], wr[k]);
+                int32_t xr = ar[k];
+                int32_t xi = ai[k];
+                if (inverse) {
+                    ar[k] = xr + tr;
+                    ai[k] = xi + ti;
+                    br[k] = xr - tr;
+                    bi[k] = xi - ti;
+                } else {
+                    ar[k] = (int32_t)(((int64_t)xr + tr) >> 1);
+                    ai[k] = (int32_t)(((int64_t)xi + ti) >> 1);
+                    br[k] = (int32_t)(((int64_t)xr - tr) >> 1);
+                    bi[k] = (int32_t)(((int64_t)xi - ti) >> 1);
+                }
+            }
+        }
+    }
+}
+
+// ============================================================================
+// Spectral gain
+// ============================================================================
+
+/* x * window into the FFT input, zero padded to N */
+static void ns_analyze(audio_ns_t* ns) {
+    const size_t L = ns->window_size;
+    size_t n = 0;
+#if NS_USE_NEON
+    for (; n + 4 <= L; n += 4) {
+        int32x4_t v = vmull_s16(vld1_s16(ns->history + n), vld1_s16(ns->window + n));
+        vst1q_s32(ns->re + n, vshrq_n_s32(v, 15 - NS_INPUT_SHIFT));
+    }
+#endif
+    for (; n < L; n++) {
+        ns->re[n] = ((int32_t)ns->history[n] * ns->window[n]) >> (15 - NS_INPUT_SHIFT);
+    }
+    memset(ns->re + L, 0, (ns->N - L) * sizeof(int32_t));
+    memset(ns->im, 0, ns->N * sizeof(int32_t));
+}
+
+/* Noise floor and Wiener-style gain per bin */
+static void ns_update_gain(audio_ns_t* ns) {
+    const size_t N = ns->N;
+    int64_t gain_sum = 0;
+    bool init = ns->hops < NS_INIT_HOPS;
+
+    for (size_t k = 0; k < ns->bins; k++) {
+        int64_t p = (int64_t)ns->re[k] * ns->re[k] + (int64_t)ns->im[k] * ns->im[k];
+        int64_t ps = ns->power[k];
+        ps = ns->hops == 0 ? p : ps + ((p - ps) >> 2);
+        ns->power[k] = ps;
+
+        int64_t noise = ns->noise[k];
+        if (init) {
+            noise += (ps - noise) / (int64_t)(ns->hops + 1);
+        } else if (ps < noise) {
+            noise -= (noise - ps) >> 3;
+        } else {
+            // Rise slowly so speech is not learned as noise (about 1.7 dB/s at 10 ms hops)
+            int64_t step = (noise >> 8) + 1;
+            noise += (ps - noise) < step ? (ps - noise) : step;
+        }
+        ns->noise[k] = noise;
+
+        // g = 1 - over_subtraction * noise / power
+        int32_t target = ns->floor_q15;
+        int64_t num = noise * ns->over_subtraction / 100;
+        int64_t den = ps;
+        if (num < den) {
+            while (den >= ((int64_t)1 << 47)) {
+                den >>= 1;
+                num >>= 1;
+            }
+            int32_t g = NS_Q15_ONE - (int32_t)((num << 15) / den);
+            target = g > target ? g : target;
+        }
+
+        int32_t g = ns->gain[k];
+        g = target > g ? target : (3 * g + target) >> 2;
+        ns->gain[k] = g;
+        gain_sum += g;
+
+        int32_t g31 = g << 16;
+        ns->gain_q31[k] = g31;
+        if (k > 0 && k < N / 2) {
+            ns->gain_q31[N - k] = g31;
+        }
+    }
+    __atomic_store_n(&ns->mean_gain_q15, (int)(gain_sum / (int64_t)ns->bins), __ATOMIC_RELAXED);
+}
+
+static void ns_apply_gain(audio_ns_t* ns) {
+    size_t k = 0;
+#if NS_USE_NEON
+    for (; k + 4 <= ns->N; k += 4) {
+        int32x4_t g = vld1q_s32(ns->gain_q31 + k);
+        vst1q_s32(ns->re + k, vqrdmulhq_s32(vld1q_s32(ns->re + k), g));
+        vst1q_s32(ns->im + k, vqrdmulhq_s32(vld1q_s32(ns->im + k), g));
+    }
+#endif
+    for (; k < ns->N; k++) {
+        ns->re[k] = ns_mul_q31(ns->re[k], ns->gain_q31[k]);
+        ns->im[k] = ns_mul_q31(ns->im[k], ns->gain_q31[k]);
+    }
+}
+
+/* Synthesis window, overlap-add, emit one hop */
+static void ns_synthesize(audio_ns_t* ns, short* out) {
+    const size_t L = ns->window_size;
+    const size_t H = ns->hop;
+    for (size_t n = 0; n < L; n++) {
+        ns->overlap[n] += (int32_t)(((int64_t)ns->re[n] * ns->window[n] + (1 << 14)) >> 15);
+    }
+    for (size_t n = 0; n < H; n++) {
+        int32_t v = (ns->overlap[n] + (1 << (NS_INPUT_SHIFT - 1))) >> NS_INPUT_SHIFT;
+        out[n] = (short)(v > 32767 ? 32767 : (v < -32768 ? -32768 : v));
+    }
+    memmove(ns->overlap, ns->overlap + H, (L - H) * sizeof(int32_t));
+    memset(ns->overlap + L - H, 0, H * sizeof(int32_t));
+}
+
+/* Gain floor and over-subtraction scaled by the strength */
+static void ns_apply_strength(audio_ns_t* ns, int strength) {
+    double db = (double)ns->config.max_suppression_db * strength / 100.0;
+    ns->floor_q15 = (int32_t)lrint(pow(10.0, -db / 20.0) * NS_Q15_ONE);
+    ns->over_subtraction = 100 + (ns->config.over_subtraction - 100) * strength / 100;
+    ns->applied_strength = strength;
+}
+
+static void ns_process_hop(audio_ns_t* ns, const short* in, short* out) {
+    const size_t H = ns->hop;
+    memmove(ns->history, ns->history + H, (ns->window_size - H) * sizeof(int16_t));
+    memcpy(ns->history + ns->window_size - H, in, H * sizeof(int16_t));
+
+    ns_analyze(ns);
+    if (ns->applied_strength == 0) {
+        // Unity gain: windowing and overlap-add alone reconstruct the input one hop late,
+        // and the overlap stays valid for switching back
+        ns_synthesize(ns, out);
+        return;
+    }
+    ns_fft(ns, ns->re, ns->im, false);
+    ns_update_gain(ns);
+    ns_apply_gain(ns);
+    ns_fft(ns, ns->re, ns->im, true);
+    ns_synthesize(ns, out);
+    if (ns->hops < UINT32_MAX) {
+        ns->hops++;
+    }
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+audio_ns_t* audio_ns_create(const audio_ns_config_t* config) {
+    if (!config || config->sample_rate == 0 || config->frame_samples == 0) {
+        LOG_ERROR("Invalid noise suppressor parameters");
+        return NULL;
+    }
+    size_t hop = config->frame_samples < NS_MAX_HOP ? config->frame_samples : NS_MAX_HOP;
+    while (config->frame_samples % hop != 0) {
+        hop--;
+    }
+    if (hop < NS_MIN_HOP) {
+        LOG_ERROR("Noise suppressor: frame of %zu samples has no hop between %d and %d",
+                  config->frame_samples, NS_MIN_HOP, NS_MAX_HOP);
+        return NULL;
+    }
+
+    audio_ns_t* ns = (audio_ns_t*)LINX_CALLOC(1, sizeof(audio_ns_t));
+    if (!ns) {
+        LOG_ERROR("Failed to allocate noise suppressor");
+        return NULL;
+    }
+    ns->config = *config;
+    if (ns->config.max_suppression_db <= 0) {
+        ns->config.max_suppression_db = NS_DEFAULT_SUPPRESSION_DB;
+    }
+    if (ns->config.over_subtraction <= 0) {
+        ns->config.over_subtraction = NS_DEFAULT_OVER_SUBTRACTION;
+    }
+    ns->hop = hop;
+    ns->window_size = 2 * hop;
+    ns->N = 1;
+    while (ns->N < ns->window_size) {
+        ns->N <<= 1;
+    }
+    ns->bins = ns->N / 2 + 1;
+    const size_t N = ns->N;
+    const size_t L = ns->window_size;
+
+    ns->window = (int16_t*)LINX_MALLOC(L * sizeof(int16_t));
+    ns->bitrev = (uint16_t*)LINX_MALLOC(N * sizeof(uint16_t));
+    ns->tw_re = (int32_t*)LINX_MALLOC(N * sizeof(int32_t));
+    ns->tw_im = (int32_t*)LINX_MALLOC(N * sizeof(int32_t));
+    ns->re = (int32_t*)LINX_MALLOC(N * sizeof(int32_t));
+    ns->im = (int32_t*)LINX_MALLOC(N * sizeof(int32_t));
+    ns->history = (int16_t*)LINX_CALLOC(L, sizeof(int16_t));
+    ns->overlap = (int32_t*)LINX_CALLOC(L, sizeof(int32_t));
+    ns->power = (int64_t*)LINX_CALLOC(ns->bins, sizeof(int64_t));
+    ns->noise = (int64_t*)LINX_CALLOC(ns->bins, sizeof(int64_t));
+    ns->gain = (int32_t*)LINX_MALLOC(ns->bins * sizeof(int32_t));
+    ns->gain_q31 = (int32_t*)LINX_MALLOC(N * sizeof(int32_t));
+
+    if (!ns->window || !ns->bitrev || !ns->tw_re || !ns->tw_im || !ns->re || !ns->im ||
+        !ns->history || !ns->overlap || !ns->power || !ns->noise || !ns->gain || !ns->gain_q31) {
+        LOG_ERROR("Failed to allocate noise suppressor state");
+        audio_ns_destroy(ns);
+        return NULL;
+    }
+
+    // Tables are built once in floating point; processing is integer only
+    for (size_t n = 0; n < L; n++) {
+        double w = sqrt(0.5 - 0.5 * cos(2.0 * M_PI * (double)n / (double)L));
+        ns->window[n] = (int16_t)lrint(w * NS_Q15_ONE);
+    }
+    size_t bits = 0;
+    while (((size_t)1 << bits) < N) {
+        bits++;
+    }
+    for (size_t i = 0; i < N; i++) {
+        size_t r = 0;
+        for (size_t b = 0; b < bits; b++) {
+            if (i & ((size_t)1 << b)) {
+                r |= (size_t)1 << (bits - 1 - b);
+            }
+        }
+        ns->bitrev[i] = (uint16_t)r;
+    }
+    for (size_t half = 1; half < N; half <<= 1) {
+        for (size_t k = 0; k < half; k++) {
+            double angle = M_PI * (double)k / (double)half;
+            ns->tw_re[half - 1 + k] = (int32_t)lrint(cos(angle) * 2147483647.0);
+            ns->tw_im[half - 1 + k] = (int32_t)lrint(-sin(angle) * 2147483647.0);
+        }
+    }
+    ns->strength = 100;
+    ns_apply_strength(ns, 100);
+    audio_ns_reset(ns);
+
+    LOG_INFO("Noise suppressor created: %u Hz, hop %zu, FFT %zu, %d dB max suppression%s",
+             config->sample_rate, ns->hop, ns->N, ns->config.max_suppression_db,
+             NS_USE_NEON ? ", NEON" : "");
+    return ns;
+}
+
+void audio_ns_destroy(audio_ns_t* ns) {
+    if (!ns) {
+        return;
+    }
+    LINX_FREE(ns->window);
+    LINX_FREE(ns->bitrev);
+    LINX_FREE(ns->tw_re);
+    LINX_FREE(ns->tw_im);
+    LINX_FREE(ns->re);
+    LINX_FREE(ns->im);
+    LINX_FREE(ns->history);
+    LINX_FREE(ns->overlap);
+    LINX_FREE(ns->power);
+    LINX_FREE(ns->noise);
+    LINX_FREE(ns->gain);
+    LINX_FREE(ns->gain_q31);
+    LINX_FREE(ns);
+}
+
+int audio_ns_process(audio_ns_t* ns, const short* in, short* out, size_t samples) {
+    if (!ns || !in || !out || samples != ns->config.frame_samples) {
+        return -1;
+    }
+    int strength = __atomic_load_n(&ns->strength, __ATOMIC_RELAXED);
+    if (strength != ns->applied_strength) {
+        ns_apply_strength(ns, strength);
+    }
+    // Hops are read into the history before they are written, so in == out is fine
+    for (size_t off = 0; off < samples; off += ns->hop) {
+        ns_process_hop(ns, in + off, out + off);
+    }
+    __atomic_add_fetch(&ns->frames, 1, __ATOMIC_RELAXED);
+    return 0;
+}
+
+void audio_ns_reset(audio_ns_t* ns) {
+    if (!ns) {
+        return;
+    }
+    memset(ns->history, 0, ns->window_size * sizeof(int16_t));
+    memset(ns->overlap, 0, ns->window_size * sizeof(int32_t));
+    memset(ns->power, 0, ns->bins * sizeof(int64_t));
+    memset(ns->noise, 0, ns->bins * sizeof(int64_t));
+    for (size_t k = 0; k < ns->bins; k++) {
+        ns->gain[k] = NS_Q15_ONE;
+    }
+    ns->hops = 0;
+    __atomic_store_n(&ns->mean_gain_q15, NS_Q15_ONE, __ATOMIC_RELAXED);
+}
+
+int audio_ns_set_strength(audio_ns_t* ns, int percent) {
+    if (!ns || percent < 0 || percent > 100) {
+        return -1;
+    }
+    __atomic_store_n(&ns->strength, percent, __ATOMIC_RELAXED);
+    return 0;
+}
+
+bool audio_ns_get_stats(const audio_ns_t* ns, audio_ns_stats_t* stats) {
+    if (!ns || !stats) {
+        return false;
+    }
+    stats->frames = __atomic_load_n(&ns->frames, __ATOMIC_RELAXED);
+    stats->hop_samples = ns->hop;
+    stats->fft_size = ns->N;
+    stats->mean_gain_q15 = __atomic_load_n(&ns->mean_gain_q15, __ATOMIC_RELAXED);
+    stats->strength = __atomic_load_n(&ns->strength, __ATOMIC_RELAXED);
+    return true;
+}
+
+static int ns_stage_process(void* ctx, const short* in, short* out, size_t samples) {
+    return audio_ns_process((audio_ns_t*)ctx, in, out, samples);
+}
+
+static void ns_stage_reset(void* ctx) {
+    audio_ns_reset((audio_ns_t*)ctx);
+}
+
+audio_stage_t audio_ns_stage(audio_ns_t* ns) {
+    audio_stage_t stage = { "ns", ns_stage_process, ns_stage_reset, AUDIO_STAGE_IN_PLACE, ns, 0 };
+    return stage;
+}
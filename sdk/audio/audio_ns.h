@@ -0,0 +1,109 @@
+#ifndef AUDIO_NS_H
+#define AUDIO_NS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "audio_pipeline.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Fixed-point noise suppressor for the uplink
+ *
+ * Short-time spectral gain: each capture frame is split into hops of at
+ * most 256 samples that divide it exactly (160 for 20 ms at 16 kHz), so
+ * frames of the AudioInterface size are processed as they arrive without
+ * re-buffering across frames. Every hop is windowed (sqrt-Hann, 50%
+ * overlap), transformed with a Q31 radix-2 FFT, and each bin is scaled by
+ * a Wiener-style gain from the smoothed bin power and a tracked noise
+ * floor (fast to fall, slow to rise, so steady kitchen or road noise is
+ * learned while speech passes). The gain falls slowly and rises at once,
+ * which keeps musical noise down without smearing onsets. Adds one hop
+ * of latency.
+ *
+ * The processing path is integer only (32-bit data, 64-bit products), for
+ * cores without an FPU such as RISC-V32; the butterflies, windowing and
+ * gain use NEON on ARM builds. Tables are computed once at creation.
+ *
+ * Mono 16-bit only. Not thread-safe: run it on the capture thread, after
+ * echo cancellation and before AGC and the encoder.
+ */
+typedef struct audio_ns audio_ns_t;
+
+/**
+ * Suppressor configuration; zero fields take the defaults
+ */
+typedef struct {
+    unsigned int sample_rate;       // Sample rate (required)
+    size_t frame_samples;           // Samples per audio_ns_process() call (required)
+    int max_suppression_db;         // Deepest attenuation of a noise-only bin (default 15)
+    int over_subtraction;           // Noise estimate multiplier in percent (default 200)
+} audio_ns_config_t;
+
+/**
+ * Suppressor statistics
+ */
+typedef struct {
+    uint64_t frames;                // Frames processed
+    size_t hop_samples;             // Samples per spectral hop
+    size_t fft_size;                // FFT length
+    int mean_gain_q15;              // Average bin gain of the last hop (32767 = unity)
+    int strength;                   // Current strength in percent (audio_ns_set_strength)
+} audio_ns_stats_t;
+
+/**
+ * Create a suppressor
+ * @return Suppressor instance or NULL on failure
+ */
+audio_ns_t* audio_ns_create(const audio_ns_config_t* config);
+
+/**
+ * Destroy a suppressor
+ */
+void audio_ns_destroy(audio_ns_t* ns);
+
+/**
+ * Suppress the noise in one frame
+ * @param in config.frame_samples samples
+ * @param out Output, may be the same buffer as in
+ * @return 0 on success, -1 on invalid input
+ */
+int audio_ns_process(audio_ns_t* ns, const short* in, short* out, size_t samples);
+
+/**
+ * Scale the suppression, e.g. to shed load when the CPU is saturated
+ *
+ * 100 is the configured suppression; lower values reduce the attenuation and
+ * the over-subtraction proportionally. 0 skips the FFTs and passes the audio
+ * through with the same one-hop latency, while the noise estimate is frozen,
+ * so switching back is seamless. Any thread may call this; the capture
+ * thread picks the new strength up at the next frame.
+ *
+ * @param percent 0-100
+ * @return 0 on success, -1 on invalid input
+ */
+int audio_ns_set_strength(audio_ns_t* ns, int percent);
+
+/**
+ * Forget the noise estimate and the overlap
+ */
+void audio_ns_reset(audio_ns_t* ns);
+
+/**
+ * Get statistics
+ */
+bool audio_ns_get_stats(const audio_ns_t* ns, audio_ns_stats_t* stats);
+
+/**
+ * Pipeline stage running the suppressor (in place)
+ */
+audio_stage_t audio_ns_stage(audio_ns_t* ns);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIO_NS_H
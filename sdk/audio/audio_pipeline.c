@@ -0,0 +1,798 @@
+#include "audio_pipeline.h"
+#include "audio_dsp.h"
+#include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
+#include "../log/linx_thread_stats.h"
+#include "../log/linx_deadline.h"
+#include <string.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_AUDIO);
+
+#define PIPELINE_DEFAULT_FRAME_MS           20
+#define PIPELINE_DEFAULT_CAPTURE_TIMEOUT_MS 1000
+
+typedef struct {
+    uint64_t frames;
+    uint64_t stops;
+    uint64_t errors;
+    uint64_t total_us;
+    uint32_t max_us;
+} stage_counters_t;
+
+struct audio_pipeline {
+    audio_pipeline_config_t config;
+    size_t frame_bytes;
+    size_t channels;
+    size_t output_samples;      // Frame size after the last stage
+    size_t output_channels;
+
+    audio_stage_t stages[AUDIO_PIPELINE_MAX_STAGES];
+    stage_counters_t counters[AUDIO_PIPELINE_MAX_STAGES];
+    size_t stage_count;
+
+    // Preallocated frames: ping-pong pair for out-of-place stages, staging
+    // frame for device periods split across frames (uplink) or the source
+    // output (downlink)
+    short* work[2];
+    short* staging;
+    size_t staged;              // Uplink: samples waiting in staging
+    uint64_t staged_time_us;    // Uplink: capture time of staging[0]
+    uint64_t frame_time_us;     // Uplink: capture time of the frame in the stages
+    bool frame_timed;
+
+    // Pull mode: processed frame being handed to the output callback
+    const short* pull_frame;
+    size_t pull_pos;
+    size_t pull_len;
+    bool pull_installed;
+
+    linx_thread_t* thread;
+    bool thread_started;
+    bool running;               // Atomic: thread keeps going
+    bool active;                // Atomic: frames go through the stages
+    bool reset_pending;         // Atomic: reset the stages before the next frame
+    linx_deadline_t* deadline;  // Period monitor while started (NULL when the monitors are full)
+
+    // Atomic counters
+    uint64_t frames;
+    uint64_t completed;
+    uint64_t dropped;
+    uint64_t idle_frames;
+    uint64_t underruns;
+    uint64_t device_errors;
+    uint64_t deadline_misses;
+    uint32_t max_late_us;
+};
+
+static uint64_t pipeline_now_us(void) {
+    return linx_os_now_us();
+}
+
+static void counter_add(uint64_t* counter, uint64_t value) {
+    __atomic_add_fetch(counter, value, __ATOMIC_RELAXED);
+}
+
+static uint64_t counter_get(const uint64_t* counter) {
+    return __atomic_load_n(counter, __ATOMIC_RELAXED);
+}
+
+/* A device period of `samples` samples starts now; count the previous one if it ran late */
+static void pipeline_tick(audio_pipeline_t* pipeline, size_t samples) {
+    uint32_t period_us = (uint32_t)((uint64_t)samples * (uint64_t)pipeline->config.frame_duration_ms * 1000u /
+                                    pipeline->config.frame_samples);
+    uint32_t late_us = linx_deadline_tick(pipeline->deadline, period_us);
+    if (late_us > 0) {
+        counter_add(&pipeline->deadline_misses, 1);
+        // Single writer: a plain compare is enough
+        if (late_us > __atomic_load_n(&pipeline->max_late_us, __ATOMIC_RELAXED)) {
+            __atomic_store_n(&pipeline->max_late_us, late_us, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+audio_pipeline_config_t audio_pipeline_default_config(audio_pipeline_direction_t direction) {
+    audio_pipeline_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.direction = direction;
+    config.frame_duration_ms = PIPELINE_DEFAULT_FRAME_MS;
+    config.capture_timeout_ms = PIPELINE_DEFAULT_CAPTURE_TIMEOUT_MS;
+    return config;
+}
+
+audio_pipeline_t* audio_pipeline_create(const audio_pipeline_config_t* config) {
+    if (!config || config->frame_samples == 0 ||
+        (config->direction != AUDIO_PIPELINE_UPLINK && config->direction != AUDIO_PIPELINE_DOWNLINK)) {
+        LOG_ERROR("Invalid audio pipeline config");
+        return NULL;
+    }
+
+    audio_pipeline_t* pipeline = (audio_pipeline_t*)LINX_CALLOC(1, sizeof(audio_pipeline_t));
+    if (!pipeline) {
+        LOG_ERROR("Failed to allocate audio pipeline");
+        return NULL;
+    }
+    pipeline->config = *config;
+    if (pipeline->config.frame_duration_ms <= 0) {
+        pipeline->config.frame_duration_ms = PIPELINE_DEFAULT_FRAME_MS;
+    }
+    if (pipeline->config.capture_timeout_ms <= 0) {
+        pipeline->config.capture_timeout_ms = PIPELINE_DEFAULT_CAPTURE_TIMEOUT_MS;
+    }
+    if (config->capture_ring && (config->direction != AUDIO_PIPELINE_UPLINK ||
+        audio_capture_ring_frame_samples(config->capture_ring) != config->frame_samples)) {
+        LOG_ERROR("Capture ring needs an uplink pipeline with %zu-sample frames", config->frame_samples);
+        LINX_FREE(pipeline);
+        return NULL;
+    }
+    if (!pipeline->config.thread_name) {
+        pipeline->config.thread_name = config->direction == AUDIO_PIPELINE_UPLINK ? "capture" : "playback";
+    }
+    if (config->channels > 0) {
+        pipeline->channels = (size_t)config->channels;
+    } else {
+        pipeline->channels = (config->audio && config->audio->channels > 0) ? (size_t)config->audio->channels : 1;
+    }
+    if (config->frame_samples % pipeline->channels != 0) {
+        LOG_ERROR("Frame of %zu samples does not hold whole %zu-channel frames", config->frame_samples,
+                  pipeline->channels);
+        LINX_FREE(pipeline);
+        return NULL;
+    }
+    pipeline->output_samples = config->frame_samples;
+    pipeline->output_channels = pipeline->channels;
+    pipeline->frame_bytes = config->frame_samples * sizeof(short);
+    pipeline->active = true;
+
+    pipeline->work[0] = (short*)LINX_CALLOC(config->frame_samples, sizeof(short));
+    pipeline->work[1] = (short*)LINX_CALLOC(config->frame_samples, sizeof(short));
+    pipeline->staging = (short*)LINX_CALLOC(config->frame_samples, sizeof(short));
+    if (!pipeline->work[0] || !pipeline->work[1] || !pipeline->staging) {
+        LOG_ERROR("Failed to allocate audio pipeline buffers");
+        audio_pipeline_destroy(pipeline);
+        return NULL;
+    }
+    return pipeline;
+}
+
+void audio_pipeline_destroy(audio_pipeline_t* pipeline) {
+    if (!pipeline) {
+        return;
+    }
+    audio_pipeline_stop(pipeline);
+    LINX_FREE(pipeline->work[0]);
+    LINX_FREE(pipeline->work[1]);
+    LINX_FREE(pipeline->staging);
+    LINX_FREE(pipeline);
+}
+
+int audio_pipeline_add_stage(audio_pipeline_t* pipeline, const audio_stage_t* stage) {
+    if (!pipeline || !stage || !stage->process) {
+        return -1;
+    }
+    if (pipeline->thread_started || pipeline->pull_installed) {
+        LOG_ERROR("Cannot add stage %s to a running pipeline", stage->name ? stage->name : "?");
+        return -1;
+    }
+    if (pipeline->stage_count >= AUDIO_PIPELINE_MAX_STAGES) {
+        LOG_ERROR("Audio pipeline is full (%d stages)", AUDIO_PIPELINE_MAX_STAGES);
+        return -1;
+    }
+    if (stage->output_channels > 0) {
+        // Only shrinking fits the preallocated frames; in-place stages cannot change the layout
+        if (pipeline->config.direction != AUDIO_PIPELINE_UPLINK ||
+            (size_t)stage->output_channels >= pipeline->output_channels ||
+            (stage->flags & (AUDIO_STAGE_IN_PLACE | AUDIO_STAGE_READ_ONLY))) {
+            LOG_ERROR("Stage %s cannot turn %zu channels into %d", stage->name ? stage->name : "?",
+                      pipeline->output_channels, stage->output_channels);
+            return -1;
+        }
+        pipeline->output_samples = pipeline->output_samples / pipeline->output_channels *
+                                   (size_t)stage->output_channels;
+        pipeline->output_channels = (size_t)stage->output_channels;
+    }
+    pipeline->stages[pipeline->stage_count] = *stage;
+    if (!pipeline->stages[pipeline->stage_count].name) {
+        pipeline->stages[pipeline->stage_count].name = "stage";
+    }
+    return (int)pipeline->stage_count++;
+}
+
+static void pipeline_reset_stages(audio_pipeline_t* pipeline) {
+    for (size_t i = 0; i < pipeline->stage_count; i++) {
+        if (pipeline->stages[i].reset) {
+            pipeline->stages[i].reset(pipeline->stages[i].ctx);
+        }
+    }
+    pipeline->staged = 0;
+    pipeline->pull_pos = 0;
+    pipeline->pull_len = 0;
+}
+
+/**
+ * Run one frame through the stages
+ * `writable` tells whether `in` is one of the pipeline's own frames; a
+ * borrowed frame is copied before the first stage that writes to it.
+ * On success *result points at the processed frame.
+ * @return 0, AUDIO_STAGE_STOP, or -1 if a stage failed
+ */
+static int pipeline_run(audio_pipeline_t* pipeline, const short* in, bool writable, const short** result) {
+    size_t samples = pipeline->config.frame_samples;
+    size_t channels = pipeline->channels;
+    const short* cur = in;
+
+    for (size_t i = 0; i < pipeline->stage_count; i++) {
+        const audio_stage_t* stage = &pipeline->stages[i];
+        stage_counters_t* counters = &pipeline->counters[i];
+        short* out = NULL;
+        if (stage->flags & AUDIO_STAGE_READ_ONLY) {
+            out = NULL;
+        } else if (stage->flags & AUDIO_STAGE_IN_PLACE) {
+            if (!writable) {
+                memcpy(pipeline->work[0], cur, samples * sizeof(short));
+                cur = pipeline->work[0];
+                writable = true;
+            }
+            out = (short*)cur;
+        } else {
+            out = cur == pipeline->work[0] ? pipeline->work[1] : pipeline->work[0];
+        }
+
+        linx_deadline_activity(stage->name);
+        uint64_t start = pipeline_now_us();
+        int ret = stage->process(stage->ctx, cur, out, samples);
+        uint64_t elapsed = pipeline_now_us() - start;
+
+        counter_add(&counters->frames, 1);
+        counter_add(&counters->total_us, elapsed);
+        // Single writer: a plain compare is enough
+        if (elapsed > __atomic_load_n(&counters->max_us, __ATOMIC_RELAXED)) {
+            __atomic_store_n(&counters->max_us, (uint32_t)(elapsed > UINT32_MAX ? UINT32_MAX : elapsed),
+                             __ATOMIC_RELAXED);
+        }
+        if (ret < 0) {
+            counter_add(&counters->errors, 1);
+            counter_add(&pipeline->dropped, 1);
+            return -1;
+        }
+        if (ret == AUDIO_STAGE_STOP) {
+            counter_add(&counters->stops, 1);
+            counter_add(&pipeline->completed, 1);
+            return AUDIO_STAGE_STOP;
+        }
+        if (out) {
+            cur = out;
+            writable = true;
+        }
+        if (stage->output_channels > 0) {
+            samples = samples / channels * (size_t)stage->output_channels;
+            channels = (size_t)stage->output_channels;
+        }
+    }
+    counter_add(&pipeline->completed, 1);
+    *result = cur;
+    return 0;
+}
+
+/* Pending reset and active flag, checked at the start of every frame on the processing thread */
+static bool pipeline_frame_begin(audio_pipeline_t* pipeline) {
+    counter_add(&pipeline->frames, 1);
+    if (__atomic_exchange_n(&pipeline->reset_pending, false, __ATOMIC_ACQ_REL)) {
+        pipeline_reset_stages(pipeline);
+    }
+    return __atomic_load_n(&pipeline->active, __ATOMIC_ACQUIRE);
+}
+
+// ---------------------------------------------------------------------------
+// Uplink
+// ---------------------------------------------------------------------------
+
+static int uplink_frame(audio_pipeline_t* pipeline, const short* in, bool writable, const short** result,
+                        uint64_t time_us) {
+    pipeline->frame_time_us = time_us;
+    pipeline->frame_timed = true;
+    if (pipeline->config.capture_ring) {
+        audio_capture_ring_push(pipeline->config.capture_ring, in, time_us);
+    }
+    if (!pipeline_frame_begin(pipeline)) {
+        counter_add(&pipeline->idle_frames, 1);
+        return AUDIO_STAGE_STOP;
+    }
+    linx_alloc_no_alloc_enter();
+    int ret = pipeline_run(pipeline, in, writable, result);
+    linx_alloc_no_alloc_leave();
+    return ret;
+}
+
+/* Capture time of `samples` samples after a period that started at `time_us` */
+static uint64_t uplink_time_after(const audio_pipeline_t* pipeline, uint64_t time_us, size_t samples) {
+    return time_us + (uint64_t)samples * (uint64_t)pipeline->config.frame_duration_ms * 1000u /
+                     pipeline->config.frame_samples;
+}
+
+/*
+ * Capture time of a period the device just returned: the device clock when
+ * it has one, otherwise now minus the period duration
+ */
+static uint64_t uplink_period_time(audio_pipeline_t* pipeline, size_t samples) {
+    uint64_t time_us;
+    if (audio_interface_get_capture_time(pipeline->config.audio, &time_us) == 0) {
+        return time_us;
+    }
+    uint64_t now = pipeline_now_us();
+    uint64_t duration = uplink_time_after(pipeline, 0, samples);
+    return now > duration ? now - duration : 0;
+}
+
+/* Split a captured period into frames; a partial frame waits in staging */
+static void uplink_feed(audio_pipeline_t* pipeline, const short* pcm, size_t samples, uint64_t time_us) {
+    const size_t frame = pipeline->config.frame_samples;
+    const short* result;
+    size_t offset = 0;
+    while (samples > 0) {
+        if (pipeline->staged == 0 && samples >= frame) {
+            uplink_frame(pipeline, pcm, false, &result, uplink_time_after(pipeline, time_us, offset));
+            pcm += frame;
+            samples -= frame;
+            offset += frame;
+            continue;
+        }
+        if (pipeline->staged == 0) {
+            pipeline->staged_time_us = uplink_time_after(pipeline, time_us, offset);
+        }
+        size_t take = frame - pipeline->staged;
+        if (take > samples) {
+            take = samples;
+        }
+        memcpy(pipeline->staging + pipeline->staged, pcm, take * sizeof(short));
+        pipeline->staged += take;
+        pcm += take;
+        samples -= take;
+        offset += take;
+        if (pipeline->staged == frame) {
+            pipeline->staged = 0;
+            uplink_frame(pipeline, pipeline->staging, true, &result, pipeline->staged_time_us);
+        }
+    }
+}
+
+static void* uplink_thread(void* arg) {
+    audio_pipeline_t* pipeline = (audio_pipeline_t*)arg;
+    AudioInterface* audio = pipeline->config.audio;
+    bool zero_copy = audio_interface_supports_acquire(audio);
+    bool timed = audio_interface_supports_read_timed(audio);
+    uint32_t timeout_us = (uint32_t)pipeline->config.capture_timeout_ms * 1000u;
+    linx_thread_stats_register(pipeline->config.thread_name, LINX_THREAD_STAGE_CAPTURE);
+
+    // Blocking on the device paces the loop; each captured period starts a deadline period
+    while (__atomic_load_n(&pipeline->running, __ATOMIC_ACQUIRE)) {
+        linx_deadline_activity("device_read");
+        if (zero_copy) {
+            audio_capture_frame_t capture;
+            if (audio_interface_acquire_frame(audio, &capture, pipeline->config.capture_timeout_ms) != 0) {
+                counter_add(&pipeline->device_errors, 1);
+                linx_deadline_idle(pipeline->deadline);
+                continue;
+            }
+            size_t samples = capture.frame_count * pipeline->channels;
+            pipeline_tick(pipeline, samples);
+            uplink_feed(pipeline, capture.data, samples, uplink_period_time(pipeline, samples));
+            audio_interface_release_frame(audio, &capture);
+            continue;
+        }
+
+        const short* result;
+        if (timed) {
+            // The device wakes the loop when the frame is complete; a missed
+            // deadline returns without sleeping so shutdown is noticed
+            uint64_t time_us;
+            int ret = audio_interface_read_timed(audio, pipeline->staging, pipeline->config.frame_samples,
+                                                 timeout_us, &time_us);
+            if (ret == 0) {
+                pipeline_tick(pipeline, pipeline->config.frame_samples);
+                uplink_frame(pipeline, pipeline->staging, true, &result, time_us);
+                continue;
+            }
+            counter_add(&pipeline->device_errors, 1);
+            linx_deadline_idle(pipeline->deadline);
+            if (ret < 0) {
+                linx_os_sleep_ms((unsigned int)pipeline->config.frame_duration_ms);
+            }
+            continue;
+        }
+
+        if (audio_interface_read(audio, pipeline->staging, pipeline->config.frame_samples) != 0) {
+            counter_add(&pipeline->device_errors, 1);
+            linx_deadline_idle(pipeline->deadline);
+            linx_os_sleep_ms((unsigned int)pipeline->config.frame_duration_ms);
+            continue;
+        }
+        pipeline_tick(pipeline, pipeline->config.frame_samples);
+        uplink_frame(pipeline, pipeline->staging, true, &result,
+                     uplink_period_time(pipeline, pipeline->config.frame_samples));
+    }
+
+    linx_deadline_idle(pipeline->deadline);
+    linx_thread_stats_unregister();
+    return NULL;
+}
+
+// ---------------------------------------------------------------------------
+// Downlink
+// ---------------------------------------------------------------------------
+
+/**
+ * Produce the next processed frame; silence when inactive or when a stage
+ * failed or consumed the frame
+ */
+static const short* downlink_frame(audio_pipeline_t* pipeline, const short* in) {
+    const size_t frame = pipeline->config.frame_samples;
+    short* pcm = pipeline->staging;
+    if (!pipeline_frame_begin(pipeline)) {
+        memset(pcm, 0, pipeline->frame_bytes);
+        return pcm;
+    }
+
+    linx_alloc_no_alloc_enter();
+    if (in) {
+        memcpy(pcm, in, pipeline->frame_bytes);
+    } else {
+        size_t produced = pipeline->config.source ?
+            pipeline->config.source(pipeline->config.source_user_data, pcm, frame) : 0;
+        if (produced > frame) {
+            produced = frame;
+        }
+        if (produced < frame) {
+            memset(pcm + produced, 0, (frame - produced) * sizeof(short));
+            counter_add(&pipeline->underruns, 1);
+        }
+    }
+
+    const short* result = pcm;
+    int ret = pipeline_run(pipeline, pcm, true, &result);
+    linx_alloc_no_alloc_leave();
+    if (ret != 0) {
+        memset(pcm, 0, pipeline->frame_bytes);
+        return pcm;
+    }
+    return result;
+}
+
+static void* downlink_thread(void* arg) {
+    audio_pipeline_t* pipeline = (audio_pipeline_t*)arg;
+    linx_thread_stats_register(pipeline->config.thread_name, LINX_THREAD_STAGE_PLAYBACK);
+
+    // audio_interface_write blocks while the device buffer is full; the next
+    // frame is due when the one just written has played
+    while (__atomic_load_n(&pipeline->running, __ATOMIC_ACQUIRE)) {
+        const short* pcm = downlink_frame(pipeline, NULL);
+        linx_deadline_activity("device_write");
+        if (audio_interface_write(pipeline->config.audio, (short*)pcm, pipeline->config.frame_samples) != 0) {
+            counter_add(&pipeline->device_errors, 1);
+            linx_deadline_idle(pipeline->deadline);
+            linx_os_sleep_ms((unsigned int)pipeline->config.frame_duration_ms);
+            continue;
+        }
+        pipeline_tick(pipeline, pipeline->config.frame_samples);
+    }
+
+    linx_deadline_idle(pipeline->deadline);
+    linx_thread_stats_unregister();
+    return NULL;
+}
+
+/* Device output callback: hand out processed frames, carrying a partial one over */
+static size_t downlink_pull(void* user_data, short* buffer, size_t frame_count) {
+    audio_pipeline_t* pipeline = (audio_pipeline_t*)user_data;
+    size_t wanted = frame_count * pipeline->channels;
+    size_t filled = 0;
+    pipeline_tick(pipeline, wanted);
+    while (filled < wanted) {
+        if (pipeline->pull_pos >= pipeline->pull_len) {
+            pipeline->pull_frame = downlink_frame(pipeline, NULL);
+            pipeline->pull_pos = 0;
+            pipeline->pull_len = pipeline->config.frame_samples;
+        }
+        size_t take = pipeline->pull_len - pipeline->pull_pos;
+        if (take > wanted - filled) {
+            take = wanted - filled;
+        }
+        memcpy(buffer + filled, pipeline->pull_frame + pipeline->pull_pos, take * sizeof(short));
+        pipeline->pull_pos += take;
+        filled += take;
+    }
+    return frame_count;
+}
+
+// ---------------------------------------------------------------------------
+// Control
+// ---------------------------------------------------------------------------
+
+int audio_pipeline_start(audio_pipeline_t* pipeline) {
+    if (!pipeline || !pipeline->config.audio) {
+        LOG_ERROR("Audio pipeline has no device");
+        return -1;
+    }
+    if (pipeline->thread_started || pipeline->pull_installed) {
+        return 0;
+    }
+    AudioInterface* audio = pipeline->config.audio;
+    pipeline->channels = audio->channels > 0 ? (size_t)audio->channels : 1;
+    if (pipeline->config.frame_samples % pipeline->channels != 0) {
+        LOG_ERROR("Audio pipeline frame of %zu samples is not a whole number of %zu-channel frames",
+                  pipeline->config.frame_samples, pipeline->channels);
+        return -1;
+    }
+
+    bool uplink = pipeline->config.direction == AUDIO_PIPELINE_UPLINK;
+    if (!pipeline->deadline) {
+        const linx_deadline_config_t deadline_config = {
+            .name = pipeline->config.thread_name,
+            .period_us = (uint32_t)pipeline->config.frame_duration_ms * 1000u
+        };
+        pipeline->deadline = linx_deadline_create(&deadline_config);
+    }
+    if (uplink) {
+        if (audio_interface_record(audio) != 0) {
+            LOG_ERROR("Audio pipeline failed to start capture");
+            return -1;
+        }
+    } else {
+        if (!pipeline->config.source) {
+            LOG_ERROR("Downlink audio pipeline has no source");
+            return -1;
+        }
+        if (audio_interface_init_play(audio) != 0) {
+            LOG_ERROR("Audio pipeline failed to start playback");
+            return -1;
+        }
+        if (pipeline->config.use_pull && audio_interface_supports_pull(audio) &&
+            audio_interface_set_pull_source(audio, downlink_pull, pipeline) == 0) {
+            pipeline->pull_installed = true;
+            LOG_INFO("Downlink audio pipeline running in the output callback (%zu stages)",
+                     pipeline->stage_count);
+            return 0;
+        }
+    }
+
+    __atomic_store_n(&pipeline->running, true, __ATOMIC_RELEASE);
+    const linx_thread_attr_t defaults = {
+        .priority = LINX_THREAD_PRIORITY_HIGH,
+        .core_mask = LINX_THREAD_AUDIO_CORE_MASK,
+        .sched_priority = LINX_THREAD_AUDIO_SCHED_PRIORITY
+    };
+    const linx_thread_attr_t requested = {
+        .name = pipeline->config.thread_name,
+        .stack_size = pipeline->config.thread_stack_size,
+        .priority = pipeline->config.thread_priority,
+        .core_mask = pipeline->config.thread_core_mask,
+        .sched_priority = pipeline->config.thread_sched_priority
+    };
+    linx_thread_attr_t attr = linx_thread_attr_merge(&requested, &defaults);
+    pipeline->thread = linx_thread_create(&attr, uplink ? uplink_thread : downlink_thread, pipeline);
+    if (!pipeline->thread) {
+        LOG_ERROR("Failed to create audio pipeline thread");
+        __atomic_store_n(&pipeline->running, false, __ATOMIC_RELEASE);
+        return -1;
+    }
+    pipeline->thread_started = true;
+    LOG_INFO("%s audio pipeline started (%zu stages, %zu samples per frame)",
+             uplink ? "Uplink" : "Downlink", pipeline->stage_count, pipeline->config.frame_samples);
+    return 0;
+}
+
+void audio_pipeline_stop(audio_pipeline_t* pipeline) {
+    if (!pipeline) {
+        return;
+    }
+    if (pipeline->pull_installed) {
+        audio_interface_set_pull_source(pipeline->config.audio, NULL, NULL);
+        pipeline->pull_installed = false;
+    }
+    if (pipeline->thread_started) {
+        __atomic_store_n(&pipeline->running, false, __ATOMIC_RELEASE);
+        linx_thread_join(pipeline->thread);
+        pipeline->thread = NULL;
+        pipeline->thread_started = false;
+    }
+    linx_deadline_destroy(pipeline->deadline);
+    pipeline->deadline = NULL;
+}
+
+void audio_pipeline_set_active(audio_pipeline_t* pipeline, bool active) {
+    if (!pipeline) {
+        return;
+    }
+    bool was_active = __atomic_exchange_n(&pipeline->active, active, __ATOMIC_ACQ_REL);
+    if (active && !was_active) {
+        __atomic_store_n(&pipeline->reset_pending, true, __ATOMIC_RELEASE);
+    }
+}
+
+bool audio_pipeline_is_active(const audio_pipeline_t* pipeline) {
+    return pipeline && __atomic_load_n(&pipeline->active, __ATOMIC_ACQUIRE);
+}
+
+size_t audio_pipeline_get_frame_samples(const audio_pipeline_t* pipeline) {
+    return pipeline ? pipeline->config.frame_samples : 0;
+}
+
+size_t audio_pipeline_get_output_samples(const audio_pipeline_t* pipeline) {
+    return pipeline ? pipeline->output_samples : 0;
+}
+
+int audio_pipeline_get_output_channels(const audio_pipeline_t* pipeline) {
+    return pipeline ? (int)pipeline->output_channels : 0;
+}
+
+bool audio_pipeline_get_frame_time(const audio_pipeline_t* pipeline, uint64_t* time_us) {
+    if (!pipeline || !time_us || !pipeline->frame_timed) {
+        return false;
+    }
+    *time_us = pipeline->frame_time_us;
+    return true;
+}
+
+int audio_pipeline_process(audio_pipeline_t* pipeline, const short* in, short* out, size_t frame_count) {
+    if (!pipeline) {
+        return -1;
+    }
+    const size_t frame = pipeline->config.frame_samples;
+    int completed = 0;
+
+    if (pipeline->config.direction == AUDIO_PIPELINE_UPLINK) {
+        if (!in) {
+            return -1;
+        }
+        const size_t out_frame = pipeline->output_samples;
+        const uint64_t start_us = pipeline_now_us();
+        for (size_t i = 0; i < frame_count; i++) {
+            const short* result = NULL;
+            int ret = uplink_frame(pipeline, in + i * frame, false, &result,
+                                   uplink_time_after(pipeline, start_us, i * frame));
+            if (ret >= 0) {
+                completed++;
+            }
+            if (ret == 0 && out && result != out + i * out_frame) {
+                memmove(out + i * out_frame, result, out_frame * sizeof(short));
+            }
+        }
+        return completed;
+    }
+
+    if (!out) {
+        return -1;
+    }
+    for (size_t i = 0; i < frame_count; i++) {
+        const short* pcm = downlink_frame(pipeline, in ? in + i * frame : NULL);
+        memcpy(out + i * frame, pcm, pipeline->frame_bytes);
+        completed++;
+    }
+    return completed;
+}
+
+void audio_pipeline_reset(audio_pipeline_t* pipeline) {
+    if (!pipeline) {
+        return;
+    }
+    __atomic_store_n(&pipeline->reset_pending, false, __ATOMIC_RELEASE);
+    pipeline_reset_stages(pipeline);
+}
+
+bool audio_pipeline_get_stats(const audio_pipeline_t* pipeline, audio_pipeline_stats_t* stats) {
+    if (!pipeline || !stats) {
+        return false;
+    }
+    memset(stats, 0, sizeof(*stats));
+    stats->frames = counter_get(&pipeline->frames);
+    stats->completed = counter_get(&pipeline->completed);
+    stats->dropped = counter_get(&pipeline->dropped);
+    stats->idle_frames = counter_get(&pipeline->idle_frames);
+    stats->underruns = counter_get(&pipeline->underruns);
+    stats->device_errors = counter_get(&pipeline->device_errors);
+    stats->deadline_misses = counter_get(&pipeline->deadline_misses);
+    stats->max_late_us = __atomic_load_n(&pipeline->max_late_us, __ATOMIC_RELAXED);
+    stats->stage_count = pipeline->stage_count;
+    for (size_t i = 0; i < pipeline->stage_count; i++) {
+        const stage_counters_t* counters = &pipeline->counters[i];
+        stats->stages[i].name = pipeline->stages[i].name;
+        stats->stages[i].frames = counter_get(&counters->frames);
+        stats->stages[i].stops = counter_get(&counters->stops);
+        stats->stages[i].errors = counter_get(&counters->errors);
+        stats->stages[i].total_us = counter_get(&counters->total_us);
+        stats->stages[i].max_us = __atomic_load_n(&counters->max_us, __ATOMIC_RELAXED);
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Built-in stages
+// ---------------------------------------------------------------------------
+
+static int stage_aec_process(void* ctx, const short* in, short* out, size_t samples) {
+    audio_stage_aec_t* stage = (audio_stage_aec_t*)ctx;
+    if (audio_aec_process(stage->aec, in, out, samples) != 0) {
+        return -1;
+    }
+    uint32_t timestamp;
+    if (stage->uplink_timestamp && audio_aec_get_far_timestamp(stage->aec, &timestamp)) {
+        stage->uplink_timestamp(stage->user_data, timestamp);
+    }
+    return 0;
+}
+
+audio_stage_t audio_stage_aec(audio_stage_aec_t* ctx) {
+    // No reset: the learned echo path stays valid between listening sessions
+    audio_stage_t stage = { "aec", stage_aec_process, NULL, AUDIO_STAGE_IN_PLACE, ctx, 0 };
+    return stage;
+}
+
+static int stage_aec_reference_process(void* ctx, const short* in, short* out, size_t samples) {
+    (void)out;
+    audio_aec_feed_far((audio_aec_t*)ctx, in, samples, NULL);
+    return 0;
+}
+
+audio_stage_t audio_stage_aec_reference(audio_aec_t* aec) {
+    audio_stage_t stage = { "aec_reference", stage_aec_reference_process, NULL, AUDIO_STAGE_READ_ONLY, aec, 0 };
+    return stage;
+}
+
+static int stage_gain_process(void* ctx, const short* in, short* out, size_t samples) {
+    audio_stage_gain_t* stage = (audio_stage_gain_t*)ctx;
+    float gain;
+    __atomic_load(&stage->gain, &gain, __ATOMIC_RELAXED);
+    if (out != in) {
+        memcpy(out, in, samples * sizeof(short));
+    }
+    if (gain != 1.0f) {
+        audio_dsp_gain(out, samples, gain);
+    }
+    return 0;
+}
+
+audio_stage_t audio_stage_gain(audio_stage_gain_t* ctx) {
+    audio_stage_t stage = { "gain", stage_gain_process, NULL, AUDIO_STAGE_IN_PLACE, ctx, 0 };
+    return stage;
+}
+
+void audio_stage_gain_set(audio_stage_gain_t* ctx, float gain) {
+    if (ctx) {
+        __atomic_store(&ctx->gain, &gain, __ATOMIC_RELAXED);
+    }
+}
+
+static int stage_vad_gate_process(void* ctx, const short* in, short* out, size_t samples) {
+    (void)out;
+    (void)samples;
+    audio_stage_vad_gate_t* stage = (audio_stage_vad_gate_t*)ctx;
+    bool was_open = audio_vad_gate_is_open(stage->gate);
+    if (audio_vad_gate_process(stage->gate, in, 1) < 0) {
+        return -1;
+    }
+    if (!was_open && audio_vad_gate_is_open(stage->gate)) {
+        stage->speaking = true;
+        if (stage->on_speech_start) {
+            stage->on_speech_start(stage->user_data);
+        }
+    }
+    // Endpoint once per utterance; the gate may have closed (shorter hangover) well before
+    if (stage->speaking && stage->endpoint_ms > 0 &&
+        audio_vad_gate_silence_ms(stage->gate) >= stage->endpoint_ms) {
+        stage->speaking = false;
+        if (stage->on_speech_end) {
+            stage->on_speech_end(stage->user_data);
+        }
+    }
+    return AUDIO_STAGE_STOP;
+}
+
+static void stage_vad_gate_reset(void* ctx) {
+    audio_stage_vad_gate_t* stage = (audio_stage_vad_gate_t*)ctx;
+    audio_vad_gate_reset(stage->gate);
+    stage->speaking = false;
+}
+
+audio_stage_t audio_stage_vad_gate(audio_stage_vad_gate_t* ctx) {
+    audio_stage_t stage = { "vad_gate", stage_vad_gate_process, stage_vad_gate_reset, AUDIO_STAGE_READ_ONLY, ctx, 0 };
+    return stage;
+}
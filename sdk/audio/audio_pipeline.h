@@ -0,0 +1,295 @@
+#ifndef AUDIO_PIPELINE_H
+#define AUDIO_PIPELINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "audio_interface.h"
+#include "audio_aec.h"
+#include "audio_vad_gate.h"
+#include "audio_capture_ring.h"
+#include "../os/linx_os.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Audio processing graph between an AudioInterface and the protocol
+ *
+ * A pipeline moves fixed-size frames through a chain of stages for one
+ * direction:
+ *
+ *   uplink:   device capture -> AEC -> gain -> ... -> VAD gate / encode / send
+ *   downlink: source (decoder, tone, ...) -> gain -> AEC reference -> device
+ *
+ * Every stage works on the same frame size, so the buffers are allocated
+ * once at creation: two ping-pong frames plus a staging frame for device
+ * periods that are not a whole number of frames. In-place stages run on the
+ * frame they are given, read-only stages (taps such as the AEC reference)
+ * see it without a copy, and a frame borrowed from the driver with
+ * audio_interface_acquire_frame() is only copied when the first stage
+ * writes to it.
+ *
+ * Uplink frames carry their capture time (the device clock when the
+ * AudioInterface reports one); with a `capture_ring` the raw frames are
+ * also kept, timestamped, for readers that need recent history.
+ *
+ * Each direction runs on a single thread and is paced by the device clock:
+ * the uplink thread blocks on capture, the downlink thread on
+ * audio_interface_write(). With `use_pull` the downlink runs directly in
+ * the device's output callback instead. Frames are processed inside a
+ * zero-allocation region (linx_alloc_no_alloc_enter), so stages must not
+ * allocate, lock for long or block.
+ *
+ * Each stage keeps timing and outcome counters (audio_pipeline_get_stats),
+ * which is where a frame budget overrun shows up first. The pipeline thread
+ * (or output callback) is also watched by a log/linx_deadline.h monitor named
+ * after thread_name: a device period that comes late is counted here and
+ * reported, with the stage that was running, to the deadline listeners.
+ *
+ * An uplink stage may reduce the channel count (a beamformer turning a
+ * microphone array into mono, see audio_stage_t.output_channels); later
+ * stages get the smaller frame, which still fits the preallocated buffers.
+ * Stages that change the frame duration (resampling) do not fit the model;
+ * resample before or after the pipeline.
+ */
+typedef struct audio_pipeline audio_pipeline_t;
+
+/* Largest number of stages in one pipeline */
+#define AUDIO_PIPELINE_MAX_STAGES 8
+
+/* Stage return values besides 0 (continue with the next stage) and <0 (error, frame dropped) */
+#define AUDIO_STAGE_STOP 1          // Frame consumed (e.g. sent); later stages are skipped,
+                                    // a downlink frame is played as silence
+
+/* Stage flags */
+#define AUDIO_STAGE_IN_PLACE    0x1 // process() may get out == in
+#define AUDIO_STAGE_READ_ONLY   0x2 // process() only looks at the frame; out is NULL
+
+/**
+ * One processing step
+ * process() gets `samples` samples (all channels) at `in` and writes the
+ * same number to `out`, unless the stage is AUDIO_STAGE_READ_ONLY; a stage
+ * with `output_channels` writes samples / channels * output_channels.
+ */
+typedef struct {
+    const char* name;               // Name in the statistics (not copied)
+    int (*process)(void* ctx, const short* in, short* out, size_t samples);
+    void (*reset)(void* ctx);       // Drop state between sessions (can be NULL)
+    unsigned int flags;             // AUDIO_STAGE_* flags
+    void* ctx;                      // Passed to process() and reset()
+    int output_channels;            // Uplink: channels the stage outputs, fewer than it gets
+                                    // (out of place only); 0 keeps the count
+} audio_stage_t;
+
+typedef enum {
+    AUDIO_PIPELINE_UPLINK = 0,      // Device capture through the stages
+    AUDIO_PIPELINE_DOWNLINK         // Source through the stages to the device
+} audio_pipeline_direction_t;
+
+/**
+ * Downlink source: fill `pcm` with up to `samples` samples
+ * @return Samples produced; the rest of the frame is silence
+ */
+typedef size_t (*audio_pipeline_source_t)(void* user_data, short* pcm, size_t samples);
+
+/**
+ * Pipeline configuration; zero fields take the defaults
+ */
+typedef struct {
+    audio_pipeline_direction_t direction;
+    AudioInterface* audio;          // Device; NULL when driven only by audio_pipeline_process()
+    size_t frame_samples;           // Samples per frame, all channels (required)
+    int channels;                   // Interleaved channels per frame (default audio->channels, or 1)
+    int frame_duration_ms;          // Frame duration (default 20)
+    int capture_timeout_ms;         // Uplink: wait for a captured frame (acquire_frame/read_timed, default 1000)
+    audio_pipeline_source_t source; // Downlink: frame source (required for start)
+    void* source_user_data;
+    bool use_pull;                  // Downlink: run in the device output callback when supported
+    const char* thread_name;        // Thread / task name, also in linx_thread_stats (default "capture" / "playback")
+    size_t thread_stack_size;       // Pipeline thread stack in bytes (default: platform default)
+    linx_thread_priority_t thread_priority; // Pipeline thread priority (default LINX_THREAD_PRIORITY_HIGH)
+    unsigned int thread_core_mask;  // CPU cores the thread may run on, bit N = core N (default LINX_THREAD_AUDIO_CORE_MASK)
+    int thread_sched_priority;      // >0: SCHED_FIFO priority / FreeRTOS task priority (default LINX_THREAD_AUDIO_SCHED_PRIORITY)
+    audio_capture_ring_t* capture_ring; // Uplink: every captured frame is pushed here with its capture
+                                    // time before the stages, also while inactive (can be NULL;
+                                    // same frame size; not owned)
+} audio_pipeline_config_t;
+
+/**
+ * Per-stage statistics
+ */
+typedef struct {
+    const char* name;
+    uint64_t frames;                // Frames given to the stage
+    uint64_t stops;                 // Frames the stage consumed (AUDIO_STAGE_STOP)
+    uint64_t errors;                // Frames the stage failed on
+    uint64_t total_us;              // Time spent in process()
+    uint32_t max_us;                // Slowest frame
+} audio_stage_stats_t;
+
+/**
+ * Pipeline statistics
+ */
+typedef struct {
+    uint64_t frames;                // Frames that entered the pipeline
+    uint64_t completed;             // Frames that went through every stage (or were consumed)
+    uint64_t dropped;               // Frames dropped by a stage error
+    uint64_t idle_frames;           // Uplink: frames read while inactive and discarded
+    uint64_t underruns;             // Downlink: frames the source could not fill completely
+    uint64_t device_errors;         // Failed device reads / writes
+    uint64_t deadline_misses;       // Device periods that started later than period + slack
+    uint32_t max_late_us;           // Worst lateness of a device period
+    size_t stage_count;
+    audio_stage_stats_t stages[AUDIO_PIPELINE_MAX_STAGES];
+} audio_pipeline_stats_t;
+
+/**
+ * Get the default configuration for a direction
+ */
+audio_pipeline_config_t audio_pipeline_default_config(audio_pipeline_direction_t direction);
+
+/**
+ * Create a pipeline with no stages
+ * @return Pipeline or NULL on failure
+ */
+audio_pipeline_t* audio_pipeline_create(const audio_pipeline_config_t* config);
+
+/**
+ * Stop and destroy a pipeline (stage contexts are not owned)
+ */
+void audio_pipeline_destroy(audio_pipeline_t* pipeline);
+
+/**
+ * Append a stage (before audio_pipeline_start)
+ * @return Stage index, or -1 if the pipeline is full or running
+ */
+int audio_pipeline_add_stage(audio_pipeline_t* pipeline, const audio_stage_t* stage);
+
+/**
+ * Start the device and the pipeline thread (or the pull source)
+ * @return 0 on success, -1 on failure
+ */
+int audio_pipeline_start(audio_pipeline_t* pipeline);
+
+/**
+ * Stop the pipeline thread; the device keeps its state
+ */
+void audio_pipeline_stop(audio_pipeline_t* pipeline);
+
+/**
+ * Pause or resume processing (any thread)
+ * An inactive uplink keeps reading the device so no stale audio builds up,
+ * but discards the frames; an inactive downlink outputs silence. Stages are
+ * reset on the thread that runs them before the first frame after resuming.
+ */
+void audio_pipeline_set_active(audio_pipeline_t* pipeline, bool active);
+
+/**
+ * Whether the pipeline is processing frames
+ */
+bool audio_pipeline_is_active(const audio_pipeline_t* pipeline);
+
+/**
+ * Samples per frame, all channels (the size the first stage is given)
+ */
+size_t audio_pipeline_get_frame_samples(const audio_pipeline_t* pipeline);
+
+/**
+ * Samples per frame after the stages added so far (the size the next stage
+ * is given); equals the frame size unless a stage reduced the channels
+ */
+size_t audio_pipeline_get_output_samples(const audio_pipeline_t* pipeline);
+
+/**
+ * Channels after the stages added so far
+ */
+int audio_pipeline_get_output_channels(const audio_pipeline_t* pipeline);
+
+/**
+ * Uplink: capture time of the frame the stages are processing, in the clock
+ * of audio_capture_ring_t (call from a stage, i.e. on the capture thread)
+ * @return false before the first frame
+ */
+bool audio_pipeline_get_frame_time(const audio_pipeline_t* pipeline, uint64_t* time_us);
+
+/**
+ * Run frames through the stages on the calling thread (pipelines that are not started)
+ * Uplink: `in` holds the frames, `out` receives what is left after the last stage
+ * (can be NULL or `in`), audio_pipeline_get_output_samples() per frame; frames are timed
+ * on the host clock from the call. Downlink: `in` is NULL to call the source,
+ * `out` is required and receives every frame (silence where a stage stopped it).
+ * @param frame_count Whole frames at `in` / `out`
+ * @return Frames that completed, or -1 on invalid input
+ */
+int audio_pipeline_process(audio_pipeline_t* pipeline, const short* in, short* out, size_t frame_count);
+
+/**
+ * Reset every stage (on the pipeline thread, or while stopped)
+ */
+void audio_pipeline_reset(audio_pipeline_t* pipeline);
+
+/**
+ * Get statistics (any thread)
+ */
+bool audio_pipeline_get_stats(const audio_pipeline_t* pipeline, audio_pipeline_stats_t* stats);
+
+/**
+ * Built-in stages
+ * The objects they wrap are not owned and must outlive the pipeline.
+ */
+
+/**
+ * Uplink echo cancellation (in place); `uplink_timestamp` receives the
+ * far-end timestamp aligned with each frame (protocol v2), can be NULL
+ */
+typedef struct {
+    audio_aec_t* aec;
+    void (*uplink_timestamp)(void* user_data, uint32_t timestamp);
+    void* user_data;
+} audio_stage_aec_t;
+
+audio_stage_t audio_stage_aec(audio_stage_aec_t* ctx);
+
+/**
+ * Downlink tap feeding the played PCM to the canceller as its far-end reference
+ */
+audio_stage_t audio_stage_aec_reference(audio_aec_t* aec);
+
+/**
+ * Gain (in place); the gain is read atomically every frame, so any thread may
+ * change it with audio_stage_gain_set()
+ */
+typedef struct {
+    float gain;
+} audio_stage_gain_t;
+
+audio_stage_t audio_stage_gain(audio_stage_gain_t* ctx);
+void audio_stage_gain_set(audio_stage_gain_t* ctx, float gain);
+
+/**
+ * Uplink sink: encode and send through an audio_vad_gate (consumes the frame)
+ * `on_speech_start` is called on the pipeline thread when the gate opens
+ * (e.g. linx_sdk_notify_speech_start for local barge-in), can be NULL.
+ * With `endpoint_ms` > 0, `on_speech_end` is called once per utterance when
+ * the trailing silence after it reaches `endpoint_ms` (local endpointing,
+ * e.g. linx_sdk_notify_speech_end); use at least the gate's hangover so the
+ * last packets are sent before the stop.
+ */
+typedef struct {
+    audio_vad_gate_t* gate;
+    void (*on_speech_start)(void* user_data);
+    int endpoint_ms;
+    void (*on_speech_end)(void* user_data);
+    void* user_data;
+    bool speaking;                  // Set by the stage: gate opened, endpoint not reached yet
+} audio_stage_vad_gate_t;
+
+audio_stage_t audio_stage_vad_gate(audio_stage_vad_gate_t* ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIO_PIPELINE_H
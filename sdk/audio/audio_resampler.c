@@ -0,0 +1,270 @@
+#include "audio_resampler.h"
+#include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_AUDIO);
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define RESAMPLER_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RESAMPLER_SSE 1
+#endif
+
+#define RESAMPLER_BASE_TAPS     32      // Taps per phase when the cutoff is the input Nyquist
+#define RESAMPLER_ROLLOFF       0.9     // Cutoff as a fraction of the lower Nyquist
+#define RESAMPLER_KAISER_BETA   8.0     // ~80 dB stopband
+#define RESAMPLER_MAX_PHASES    1024
+
+struct audio_resampler {
+    unsigned int in_rate;
+    unsigned int out_rate;
+    int channels;
+    size_t max_input;
+    uint32_t up;                    // L
+    uint32_t down;                  // M
+    size_t taps;                    // T, a multiple of 4
+    float* coefs;                   // L phases of T taps
+    float* work;                    // Per channel: T-1 history + max_input new samples
+    size_t work_stride;
+    size_t pos;                     // Window start in the work buffer for the next output
+    uint32_t phase;                 // Next output's phase, 0..L-1
+};
+
+static uint32_t resampler_gcd(uint32_t a, uint32_t b) {
+    while (b) {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/* Zeroth-order modified Bessel function of the first kind */
+static double resampler_bessel_i0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    double q = x * x / 4.0;
+    for (int k = 1; k < 50; k++) {
+        term *= q / ((double)k * (double)k);
+        sum += term;
+        if (term < sum * 1e-12) {
+            break;
+        }
+    }
+    return sum;
+}
+
+static float resampler_dot(const float* a, const float* b, size_t n) {
+    size_t i = 0;
+    float sum = 0.0f;
+#if defined(RESAMPLER_NEON)
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    for (; i + 4 <= n; i += 4) {
+        acc = vmlaq_f32(acc, vld1q_f32(a + i), vld1q_f32(b + i));
+    }
+    float32x2_t half = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+    sum = vget_lane_f32(vpadd_f32(half, half), 0);
+#elif defined(RESAMPLER_SSE)
+    __m128 acc = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4) {
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, acc);
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+    for (; i < n; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+/**
+ * Phase p, tap j weights input sample (window start + j) for an output at
+ * fractional position p/L past the window centre; each phase is normalized
+ * to unity DC gain
+ */
+static void resampler_design(audio_resampler_t* rs) {
+    size_t T = rs->taps;
+    double ratio = (double)rs->out_rate / (double)rs->in_rate;
+    double fc = 0.5 * (ratio < 1.0 ? ratio : 1.0) * RESAMPLER_ROLLOFF;   // cycles per input sample
+    double half = (double)T / 2.0;
+    double i0_beta = resampler_bessel_i0(RESAMPLER_KAISER_BETA);
+
+    for (uint32_t p = 0; p < rs->up; p++) {
+        float* h = rs->coefs + (size_t)p * T;
+        double sum = 0.0;
+        for (size_t j = 0; j < T; j++) {
+            double tau = (double)p / (double)rs->up + half - 1.0 - (double)j;
+            double x = tau / half;
+            double w = fabs(x) < 1.0 ? resampler_bessel_i0(RESAMPLER_KAISER_BETA * sqrt(1.0 - x * x)) / i0_beta : 0.0;
+            double arg = 2.0 * M_PI * fc * tau;
+            double sinc = fabs(arg) < 1e-9 ? 1.0 : sin(arg) / arg;
+            double v = 2.0 * fc * sinc * w;
+            h[j] = (float)v;
+            sum += v;
+        }
+        if (sum != 0.0) {
+            for (size_t j = 0; j < T; j++) {
+                h[j] = (float)(h[j] / sum);
+            }
+        }
+    }
+}
+
+audio_resampler_t* audio_resampler_create(unsigned int in_rate, unsigned int out_rate,
+                                          int channels, size_t max_input_frames) {
+    if (in_rate == 0 || out_rate == 0 || channels <= 0 || max_input_frames == 0) {
+        LOG_ERROR("Invalid resampler parameters");
+        return NULL;
+    }
+
+    uint32_t g = resampler_gcd(in_rate, out_rate);
+    uint32_t up = out_rate / g;
+    uint32_t down = in_rate / g;
+    if (up > RESAMPLER_MAX_PHASES) {
+        LOG_ERROR("Unsupported resampling ratio %u -> %u Hz", in_rate, out_rate);
+        return NULL;
+    }
+
+    audio_resampler_t* rs = (audio_resampler_t*)LINX_CALLOC(1, sizeof(audio_resampler_t));
+    if (!rs) {
+        return NULL;
+    }
+
+    rs->in_rate = in_rate;
+    rs->out_rate = out_rate;
+    rs->channels = channels;
+    rs->max_input = max_input_frames;
+    rs->up = up;
+    rs->down = down;
+
+    // Lowering the cutoff widens the sinc in input samples, so scale the filter length with it
+    double widen = in_rate > out_rate ? (double)in_rate / (double)out_rate : 1.0;
+    rs->taps = ((size_t)ceil(RESAMPLER_BASE_TAPS * widen) + 3) & ~(size_t)3;
+    rs->work_stride = rs->taps - 1 + max_input_frames;
+
+    rs->coefs = (float*)LINX_MALLOC((size_t)up * rs->taps * sizeof(float));
+    rs->work = (float*)LINX_CALLOC((size_t)channels * rs->work_stride, sizeof(float));
+    if (!rs->coefs || !rs->work) {
+        LOG_ERROR("Failed to allocate resampler");
+        audio_resampler_destroy(rs);
+        return NULL;
+    }
+
+    resampler_design(rs);
+
+    LOG_INFO("Resampler %u -> %u Hz: %u/%u, %zu taps per phase, %u us delay",
+             in_rate, out_rate, up, down, rs->taps, audio_resampler_latency_us(rs));
+    return rs;
+}
+
+void audio_resampler_destroy(audio_resampler_t* rs) {
+    if (!rs) {
+        return;
+    }
+    LINX_FREE(rs->coefs);
+    LINX_FREE(rs->work);
+    LINX_FREE(rs);
+}
+
+size_t audio_resampler_process(audio_resampler_t* rs, const short* in, size_t in_frames,
+                               size_t* consumed, short* out, size_t out_frames) {
+    size_t used = 0;
+    size_t produced = 0;
+    if (!rs || (!in && in_frames > 0) || (!out && out_frames > 0)) {
+        if (consumed) {
+            *consumed = 0;
+        }
+        return 0;
+    }
+
+    const int channels = rs->channels;
+    const size_t T = rs->taps;
+    const size_t history = T - 1;
+
+    while (in_frames > used && produced < out_frames) {
+        size_t n = in_frames - used;
+        if (n > rs->max_input) {
+            n = rs->max_input;
+        }
+
+        // Append the new block behind the history, one plane per channel
+        const short* src = in + used * channels;
+        for (int c = 0; c < channels; c++) {
+            float* plane = rs->work + (size_t)c * rs->work_stride + history;
+            for (size_t i = 0; i < n; i++) {
+                plane[i] = (float)src[i * channels + c];
+            }
+        }
+
+        // Every window that ends inside the block yields one output
+        while (rs->pos < n && produced < out_frames) {
+            const float* h = rs->coefs + (size_t)rs->phase * T;
+            short* dst = out + produced * channels;
+            for (int c = 0; c < channels; c++) {
+                float v = resampler_dot(h, rs->work + (size_t)c * rs->work_stride + rs->pos, T);
+                v += v < 0.0f ? -0.5f : 0.5f;
+                dst[c] = v >= 32767.0f ? 32767 : (v <= -32768.0f ? -32768 : (short)v);
+            }
+            produced++;
+            rs->phase += rs->down;
+            rs->pos += rs->phase / rs->up;
+            rs->phase %= rs->up;
+        }
+
+        // Keep the T-1 samples before the next window; input past it was not consumed
+        size_t advance = rs->pos < n ? rs->pos : n;
+        for (int c = 0; c < channels; c++) {
+            float* plane = rs->work + (size_t)c * rs->work_stride;
+            memmove(plane, plane + advance, history * sizeof(float));
+        }
+        rs->pos -= advance;
+        used += advance;
+        if (advance < n) {
+            break;
+        }
+    }
+
+    if (consumed) {
+        *consumed = used;
+    }
+    return produced;
+}
+
+size_t audio_resampler_max_output(const audio_resampler_t* rs, size_t in_frames) {
+    if (!rs) {
+        return 0;
+    }
+    return (size_t)(((uint64_t)in_frames * rs->up + rs->down - 1) / rs->down) + 1;
+}
+
+size_t audio_resampler_input_for_output(const audio_resampler_t* rs, size_t out_frames) {
+    if (!rs) {
+        return 0;
+    }
+    return (size_t)(((uint64_t)out_frames * rs->down + rs->up - 1) / rs->up) + 1;
+}
+
+unsigned int audio_resampler_latency_us(const audio_resampler_t* rs) {
+    if (!rs) {
+        return 0;
+    }
+    // Output k sits T/2 input samples before input time k * M / L
+    return (unsigned int)((uint64_t)(rs->taps / 2) * 1000000 / rs->in_rate);
+}
+
+void audio_resampler_reset(audio_resampler_t* rs) {
+    if (!rs) {
+        return;
+    }
+    memset(rs->work, 0, (size_t)rs->channels * rs->work_stride * sizeof(float));
+    rs->pos = 0;
+    rs->phase = 0;
+}
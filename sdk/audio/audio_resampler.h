@@ -0,0 +1,87 @@
+#ifndef AUDIO_RESAMPLER_H
+#define AUDIO_RESAMPLER_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Streaming polyphase resampler
+ *
+ * Converts interleaved 16-bit PCM between two fixed rates, e.g. a device
+ * running at its native 44.1/48 kHz and the 16 kHz stream the codec uses.
+ * The rate ratio is reduced to L/M and each output sample is a dot product
+ * of one of L windowed-sinc (Kaiser) phases with the most recent input, so
+ * the cost per output sample is constant and there is no block latency: the
+ * only delay is the filter's group delay, reported by
+ * audio_resampler_latency_us(). The anti-aliasing cutoff follows the lower
+ * of the two rates.
+ *
+ * The dot products use NEON or SSE on builds that have them. After create
+ * the resampler never allocates, so it can run inside device callbacks.
+ * One instance serves one direction of one stream and is not thread-safe.
+ */
+typedef struct audio_resampler audio_resampler_t;
+
+/**
+ * Create a resampler
+ * @param in_rate Input sample rate
+ * @param out_rate Output sample rate
+ * @param channels Interleaved channels
+ * @param max_input_frames Largest `in_frames` per process call (larger calls are split)
+ * @return Resampler instance or NULL on failure
+ */
+audio_resampler_t* audio_resampler_create(unsigned int in_rate, unsigned int out_rate,
+                                          int channels, size_t max_input_frames);
+
+/**
+ * Destroy a resampler
+ */
+void audio_resampler_destroy(audio_resampler_t* rs);
+
+/**
+ * Resample a block of input
+ *
+ * Stops when either the input is used up or `out_frames` outputs have been
+ * produced; in the latter case the caller passes the unconsumed input again
+ * next time.
+ *
+ * @param in Interleaved input PCM
+ * @param in_frames Input frames available
+ * @param consumed Input frames used (output parameter, may be NULL when the
+ *                 output buffer is sized with audio_resampler_max_output())
+ * @param out Interleaved output PCM
+ * @param out_frames Output capacity in frames
+ * @return Output frames produced
+ */
+size_t audio_resampler_process(audio_resampler_t* rs, const short* in, size_t in_frames,
+                               size_t* consumed, short* out, size_t out_frames);
+
+/**
+ * Output frames that `in_frames` input frames can produce at most
+ */
+size_t audio_resampler_max_output(const audio_resampler_t* rs, size_t in_frames);
+
+/**
+ * Input frames needed to produce at least `out_frames` output frames
+ */
+size_t audio_resampler_input_for_output(const audio_resampler_t* rs, size_t out_frames);
+
+/**
+ * Group delay in microseconds
+ */
+unsigned int audio_resampler_latency_us(const audio_resampler_t* rs);
+
+/**
+ * Clear the filter history (e.g. when a stream restarts)
+ */
+void audio_resampler_reset(audio_resampler_t* rs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIO_RESAMPLER_H
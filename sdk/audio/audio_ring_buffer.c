@@ -0,0 +1,211 @@
+#include "audio_ring_buffer.h"
+#include "../log/linx_alloc.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_AUDIO);
+
+/* Padding that keeps producer and consumer fields on separate cache lines */
+#define RING_CACHE_LINE 64
+#define RING_PAD(name) char name[RING_CACHE_LINE - sizeof(size_t)]
+
+struct audio_ring_buffer {
+    short* data;
+    size_t capacity;            // Power of two
+    size_t mask;                // capacity - 1
+    RING_PAD(pad0);
+
+    // Free-running positions; head is owned by the producer, tail by the consumer
+    size_t head;
+    RING_PAD(pad1);
+    size_t tail;
+    RING_PAD(pad2);
+
+    // Counters are updated by one side and read from anywhere
+    size_t overruns;
+    size_t dropped_samples;
+    size_t underruns;
+};
+
+static size_t round_up_pow2(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        if (result > SIZE_MAX / 2) {
+            return 0;
+        }
+        result <<= 1;
+    }
+    return result;
+}
+
+audio_ring_buffer_t* audio_ring_buffer_create(size_t min_capacity) {
+    size_t capacity = round_up_pow2(min_capacity ? min_capacity : 1);
+    if (capacity == 0 || capacity > SIZE_MAX / sizeof(short)) {
+        return NULL;
+    }
+
+    audio_ring_buffer_t* rb = (audio_ring_buffer_t*)LINX_CALLOC(1, sizeof(audio_ring_buffer_t));
+    if (!rb) {
+        return NULL;
+    }
+
+    rb->data = (short*)LINX_CALLOC(capacity, sizeof(short));
+    if (!rb->data) {
+        LINX_FREE(rb);
+        return NULL;
+    }
+
+    rb->capacity = capacity;
+    rb->mask = capacity - 1;
+    return rb;
+}
+
+void audio_ring_buffer_destroy(audio_ring_buffer_t* rb) {
+    if (!rb) {
+        return;
+    }
+    LINX_FREE(rb->data);
+    LINX_FREE(rb);
+}
+
+/* Copy into the ring starting at `pos`, splitting at the wrap point */
+static void ring_copy_in(audio_ring_buffer_t* rb, size_t pos, const short* samples, size_t count) {
+    size_t index = pos & rb->mask;
+    size_t first = rb->capacity - index;
+    if (first > count) {
+        first = count;
+    }
+    memcpy(rb->data + index, samples, first * sizeof(short));
+    memcpy(rb->data, samples + first, (count - first) * sizeof(short));
+}
+
+static void ring_copy_out(const audio_ring_buffer_t* rb, size_t pos, short* samples, size_t count) {
+    size_t index = pos & rb->mask;
+    size_t first = rb->capacity - index;
+    if (first > count) {
+        first = count;
+    }
+    memcpy(samples, rb->data + index, first * sizeof(short));
+    memcpy(samples + first, rb->data, (count - first) * sizeof(short));
+}
+
+static void note_overrun(audio_ring_buffer_t* rb, size_t dropped) {
+    __atomic_fetch_add(&rb->overruns, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&rb->dropped_samples, dropped, __ATOMIC_RELAXED);
+}
+
+size_t audio_ring_buffer_write(audio_ring_buffer_t* rb, const short* samples, size_t count) {
+    if (!rb || !samples || count == 0) {
+        return 0;
+    }
+
+    size_t head = rb->head;
+    size_t tail = __atomic_load_n(&rb->tail, __ATOMIC_ACQUIRE);
+    size_t space = rb->capacity - (head - tail);
+    size_t written = count < space ? count : space;
+
+    if (written > 0) {
+        ring_copy_in(rb, head, samples, written);
+        __atomic_store_n(&rb->head, head + written, __ATOMIC_RELEASE);
+    }
+    if (written < count) {
+        note_overrun(rb, count - written);
+    }
+    return written;
+}
+
+bool audio_ring_buffer_write_all(audio_ring_buffer_t* rb, const short* samples, size_t count) {
+    if (!rb || !samples) {
+        return false;
+    }
+
+    size_t head = rb->head;
+    size_t tail = __atomic_load_n(&rb->tail, __ATOMIC_ACQUIRE);
+    if (rb->capacity - (head - tail) < count) {
+        note_overrun(rb, count);
+        return false;
+    }
+
+    ring_copy_in(rb, head, samples, count);
+    __atomic_store_n(&rb->head, head + count, __ATOMIC_RELEASE);
+    return true;
+}
+
+size_t audio_ring_buffer_read(audio_ring_buffer_t* rb, short* samples, size_t count) {
+    if (!rb || !samples || count == 0) {
+        return 0;
+    }
+
+    size_t tail = rb->tail;
+    size_t head = __atomic_load_n(&rb->head, __ATOMIC_ACQUIRE);
+    size_t available = head - tail;
+    size_t read = count < available ? count : available;
+
+    if (read > 0) {
+        ring_copy_out(rb, tail, samples, read);
+        __atomic_store_n(&rb->tail, tail + read, __ATOMIC_RELEASE);
+    }
+    if (read < count) {
+        __atomic_fetch_add(&rb->underruns, 1, __ATOMIC_RELAXED);
+    }
+    return read;
+}
+
+bool audio_ring_buffer_read_all(audio_ring_buffer_t* rb, short* samples, size_t count) {
+    if (!rb || !samples) {
+        return false;
+    }
+
+    size_t tail = rb->tail;
+    size_t head = __atomic_load_n(&rb->head, __ATOMIC_ACQUIRE);
+    if (head - tail < count) {
+        __atomic_fetch_add(&rb->underruns, 1, __ATOMIC_RELAXED);
+        return false;
+    }
+
+    ring_copy_out(rb, tail, samples, count);
+    __atomic_store_n(&rb->tail, tail + count, __ATOMIC_RELEASE);
+    return true;
+}
+
+void audio_ring_buffer_discard(audio_ring_buffer_t* rb) {
+    if (!rb) {
+        return;
+    }
+    size_t head = __atomic_load_n(&rb->head, __ATOMIC_ACQUIRE);
+    __atomic_store_n(&rb->tail, head, __ATOMIC_RELEASE);
+}
+
+size_t audio_ring_buffer_available_read(const audio_ring_buffer_t* rb) {
+    if (!rb) {
+        return 0;
+    }
+    size_t tail = __atomic_load_n(&rb->tail, __ATOMIC_ACQUIRE);
+    size_t head = __atomic_load_n(&rb->head, __ATOMIC_ACQUIRE);
+    return head - tail;
+}
+
+size_t audio_ring_buffer_available_write(const audio_ring_buffer_t* rb) {
+    if (!rb) {
+        return 0;
+    }
+    return rb->capacity - audio_ring_buffer_available_read(rb);
+}
+
+size_t audio_ring_buffer_capacity(const audio_ring_buffer_t* rb) {
+    return rb ? rb->capacity : 0;
+}
+
+bool audio_ring_buffer_get_stats(const audio_ring_buffer_t* rb, audio_ring_buffer_stats_t* stats) {
+    if (!rb || !stats) {
+        return false;
+    }
+
+    stats->capacity = rb->capacity;
+    stats->available = audio_ring_buffer_available_read(rb);
+    stats->overruns = __atomic_load_n(&rb->overruns, __ATOMIC_RELAXED);
+    stats->dropped_samples = __atomic_load_n(&rb->dropped_samples, __ATOMIC_RELAXED);
+    stats->underruns = __atomic_load_n(&rb->underruns, __ATOMIC_RELAXED);
+    return true;
+}
@@ -0,0 +1,102 @@
+#ifndef AUDIO_RING_BUFFER_H
+#define AUDIO_RING_BUFFER_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Lock-free single-producer/single-consumer PCM ring buffer
+ *
+ * Intended for sharing samples between a real-time audio callback and a
+ * regular thread: exactly one thread writes and exactly one thread reads,
+ * neither side ever blocks or takes a lock. Capacity is rounded up to a power
+ * of two so positions wrap with a mask. Head and tail are free-running counters
+ * published with acquire/release atomics.
+ *
+ * Writes that do not fit and reads that cannot be satisfied are counted as
+ * overruns/underruns so callers can tell from the outside whether samples are
+ * being dropped.
+ */
+typedef struct audio_ring_buffer audio_ring_buffer_t;
+
+/**
+ * Ring buffer statistics
+ */
+typedef struct {
+    size_t capacity;        // Capacity in samples
+    size_t available;       // Samples currently buffered
+    size_t overruns;        // Writes that did not fit completely
+    size_t dropped_samples; // Samples discarded by those writes
+    size_t underruns;       // Reads that found fewer samples than requested
+} audio_ring_buffer_stats_t;
+
+/**
+ * Create a ring buffer
+ * @param min_capacity Minimum capacity in samples (rounded up to a power of two)
+ * @return Ring buffer instance or NULL on failure
+ */
+audio_ring_buffer_t* audio_ring_buffer_create(size_t min_capacity);
+
+/**
+ * Destroy a ring buffer
+ */
+void audio_ring_buffer_destroy(audio_ring_buffer_t* rb);
+
+/**
+ * Producer: write up to `count` samples
+ * @return Number of samples written; a short write is counted as an overrun
+ */
+size_t audio_ring_buffer_write(audio_ring_buffer_t* rb, const short* samples, size_t count);
+
+/**
+ * Producer: write all `count` samples or nothing
+ * @return true if written; false (counted as an overrun) if there is not enough space
+ */
+bool audio_ring_buffer_write_all(audio_ring_buffer_t* rb, const short* samples, size_t count);
+
+/**
+ * Consumer: read up to `count` samples
+ * @return Number of samples read; a short read is counted as an underrun
+ */
+size_t audio_ring_buffer_read(audio_ring_buffer_t* rb, short* samples, size_t count);
+
+/**
+ * Consumer: read exactly `count` samples or nothing
+ * @return true if read; false (counted as an underrun) if not enough samples are buffered
+ */
+bool audio_ring_buffer_read_all(audio_ring_buffer_t* rb, short* samples, size_t count);
+
+/**
+ * Consumer: discard everything currently buffered
+ */
+void audio_ring_buffer_discard(audio_ring_buffer_t* rb);
+
+/**
+ * Samples available to the consumer
+ */
+size_t audio_ring_buffer_available_read(const audio_ring_buffer_t* rb);
+
+/**
+ * Free space available to the producer
+ */
+size_t audio_ring_buffer_available_write(const audio_ring_buffer_t* rb);
+
+/**
+ * Capacity in samples
+ */
+size_t audio_ring_buffer_capacity(const audio_ring_buffer_t* rb);
+
+/**
+ * Get statistics (safe to call from any thread)
+ */
+bool audio_ring_buffer_get_stats(const audio_ring_buffer_t* rb, audio_ring_buffer_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIO_RING_BUFFER_H
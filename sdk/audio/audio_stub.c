@@ -1,6 +1,18 @@
 #include "audio_stub.h"
+#include "../log/linx_alloc.h"
+#include <math.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_AUDIO);
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Quiet output needed to end a detected burst; bridges the tone's zero crossings
+#define TONE_RELEASE_MS 5
 
 // Forward declarations for vtable functions
 static int audio_stub_init(AudioInterface* self);
@@ -12,6 +24,7 @@ static int audio_stub_record(AudioInterface* self);
 static int audio_stub_init_play(AudioInterface* self);
 static bool audio_stub_is_play_buffer_empty(AudioInterface* self);
 static int audio_stub_destroy(AudioInterface* self);
+static int audio_stub_flush_play(AudioInterface* self);
 
 // Stub vtable
 static const AudioInterfaceVTable audio_stub_vtable = {
@@ -22,18 +35,170 @@ static const AudioInterfaceVTable audio_stub_vtable = {
     .record = audio_stub_record,
     .init_play = audio_stub_init_play,
     .is_play_buffer_empty = audio_stub_is_play_buffer_empty,
-    .destroy = audio_stub_destroy
+    .destroy = audio_stub_destroy,
+    .flush_play = audio_stub_flush_play
 };
 
+static uint64_t stub_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+static void stub_sleep_until_us(uint64_t deadline_us) {
+    uint64_t now = stub_now_us();
+    if (deadline_us <= now) return;
+    uint64_t wait = deadline_us - now;
+    struct timespec ts = { (time_t)(wait / 1000000ULL), (long)(wait % 1000000ULL) * 1000L };
+    nanosleep(&ts, NULL);
+}
+
+// Drop outstanding bursts older than one interval; caller holds tone_mutex
+static void stub_tone_expire(AudioStubData* data, uint64_t now_us) {
+    uint64_t window_us = (uint64_t)data->tone.interval_ms * 1000ULL;
+    while (data->pending_count > 0 &&
+           now_us - data->pending_us[data->pending_head] > window_us) {
+        data->pending_head = (data->pending_head + 1) % AUDIO_STUB_TONE_PENDING;
+        data->pending_count--;
+        data->tone_stats.bursts_lost++;
+    }
+}
+
+// Generate the next captured frame in tone mode; caller holds tone_mutex
+static void stub_tone_fill(AudioInterface* self, AudioStubData* data, short* buffer, size_t samples) {
+    int channels = self->channels > 0 ? self->channels : 1;
+    unsigned int rate = self->sample_rate > 0 ? self->sample_rate : 16000;
+    uint64_t interval = (uint64_t)rate * data->tone.interval_ms / 1000;
+    uint64_t duration = (uint64_t)rate * data->tone.duration_ms / 1000;
+    size_t frames = samples / (size_t)channels;
+    
+    for (size_t i = 0; i < frames; i++) {
+        uint64_t index = data->captured_frames + i;
+        uint64_t phase = index % interval;
+        short value = 0;
+        if (phase == 0) {
+            // Burst capture time from the sample clock, not from when read() returned
+            if (data->pending_count == AUDIO_STUB_TONE_PENDING) {
+                data->pending_head = (data->pending_head + 1) % AUDIO_STUB_TONE_PENDING;
+                data->pending_count--;
+                data->tone_stats.bursts_lost++;
+            }
+            size_t slot = (data->pending_head + data->pending_count) % AUDIO_STUB_TONE_PENDING;
+            data->pending_us[slot] = data->capture_start_us + index * 1000000ULL / rate;
+            data->pending_count++;
+            data->tone_stats.bursts_sent++;
+        }
+        if (phase < duration) {
+            double t = (double)phase / (double)rate;
+            value = (short)(data->tone.amplitude * sin(2.0 * M_PI * data->tone.frequency_hz * t));
+        }
+        for (int c = 0; c < channels; c++) {
+            buffer[i * (size_t)channels + (size_t)c] = value;
+        }
+    }
+    memset(buffer + frames * (size_t)channels, 0, (samples - frames * (size_t)channels) * sizeof(short));
+    data->captured_frames += frames;
+}
+
+// Scan played PCM for burst onsets; caller holds tone_mutex
+static void stub_tone_detect(AudioInterface* self, AudioStubData* data, const short* buffer, size_t samples) {
+    unsigned int rate = self->sample_rate > 0 ? self->sample_rate : 16000;
+    int channels = self->channels > 0 ? self->channels : 1;
+    size_t release = (size_t)rate * TONE_RELEASE_MS / 1000 * (size_t)channels;
+    uint64_t now = stub_now_us();
+    
+    stub_tone_expire(data, now);
+    
+    for (size_t i = 0; i < samples; i++) {
+        int v = buffer[i] < 0 ? -buffer[i] : buffer[i];
+        if (v >= data->tone.detect_threshold) {
+            data->output_quiet_samples = 0;
+            if (data->output_in_tone) continue;
+            data->output_in_tone = true;
+            
+            if (data->pending_count == 0) {
+                data->tone_stats.spurious_onsets++;
+                continue;
+            }
+            uint64_t sent = data->pending_us[data->pending_head];
+            data->pending_head = (data->pending_head + 1) % AUDIO_STUB_TONE_PENDING;
+            data->pending_count--;
+            data->tone_stats.bursts_received++;
+            
+            if (data->latency_count == data->latency_capacity) {
+                size_t capacity = data->latency_capacity ? data->latency_capacity * 2 : 256;
+                uint32_t* grown = (uint32_t*)LINX_REALLOC(data->latencies_us, capacity * sizeof(uint32_t));
+                if (!grown) continue;
+                data->latencies_us = grown;
+                data->latency_capacity = capacity;
+            }
+            data->latencies_us[data->latency_count++] = (uint32_t)(now > sent ? now - sent : 0);
+        } else if (data->output_in_tone && ++data->output_quiet_samples >= release) {
+            data->output_in_tone = false;
+        }
+    }
+}
+
+int audio_stub_enable_tone(AudioInterface* self, const audio_stub_tone_config_t* config) {
+    if (!self || !self->impl_data) return -1;
+    
+    AudioStubData* data = (AudioStubData*)self->impl_data;
+    audio_stub_tone_config_t tone = {0};
+    if (config) tone = *config;
+    if (tone.interval_ms == 0) tone.interval_ms = 1000;
+    if (tone.duration_ms == 0) tone.duration_ms = 100;
+    if (tone.frequency_hz == 0) tone.frequency_hz = 1000;
+    if (tone.amplitude <= 0) tone.amplitude = 8000;
+    if (tone.detect_threshold <= 0) tone.detect_threshold = tone.amplitude / 4;
+    if (tone.duration_ms >= tone.interval_ms) return -1;
+    
+    pthread_mutex_lock(&data->tone_mutex);
+    data->tone = tone;
+    data->tone_enabled = true;
+    data->capture_start_us = 0;
+    data->captured_frames = 0;
+    data->pending_head = 0;
+    data->pending_count = 0;
+    data->output_in_tone = false;
+    data->output_quiet_samples = 0;
+    data->latency_count = 0;
+    memset(&data->tone_stats, 0, sizeof(data->tone_stats));
+    pthread_mutex_unlock(&data->tone_mutex);
+    return 0;
+}
+
+size_t audio_stub_get_latencies(AudioInterface* self, uint32_t* latencies_us, size_t max) {
+    if (!self || !self->impl_data) return 0;
+    
+    AudioStubData* data = (AudioStubData*)self->impl_data;
+    pthread_mutex_lock(&data->tone_mutex);
+    size_t count = data->latency_count;
+    if (latencies_us && max > 0) {
+        memcpy(latencies_us, data->latencies_us, (count < max ? count : max) * sizeof(uint32_t));
+    }
+    pthread_mutex_unlock(&data->tone_mutex);
+    return count;
+}
+
+bool audio_stub_get_tone_stats(AudioInterface* self, audio_stub_tone_stats_t* stats) {
+    if (!self || !self->impl_data || !stats) return false;
+    
+    AudioStubData* data = (AudioStubData*)self->impl_data;
+    pthread_mutex_lock(&data->tone_mutex);
+    *stats = data->tone_stats;
+    pthread_mutex_unlock(&data->tone_mutex);
+    return true;
+}
+
 AudioInterface* audio_stub_create(void) {
-    AudioInterface* interface = (AudioInterface*)malloc(sizeof(AudioInterface));
+    AudioInterface* interface = (AudioInterface*)LINX_MALLOC(sizeof(AudioInterface));
     if (!interface) {
         return NULL;
     }
     
-    AudioStubData* data = (AudioStubData*)malloc(sizeof(AudioStubData));
+    AudioStubData* data = (AudioStubData*)LINX_MALLOC(sizeof(AudioStubData));
     if (!data) {
-        free(interface);
+        LINX_FREE(interface);
         return NULL;
     }
     
@@ -44,6 +209,7 @@ AudioInterface* audio_stub_create(void) {
     
     // Initialize stub data
     memset(data, 0, sizeof(AudioStubData));
+    pthread_mutex_init(&data->tone_mutex, NULL);
     
     return interface;
 }
@@ -78,6 +244,23 @@ static int audio_stub_read(AudioInterface* self, short* buffer, size_t frame_siz
     AudioStubData* data = (AudioStubData*)self->impl_data;
     if (!data || !data->recording) return -1;
     
+    if (data->tone_enabled) {
+        // Pace capture to real time so playback sees the same clock as a microphone
+        pthread_mutex_lock(&data->tone_mutex);
+        unsigned int rate = self->sample_rate > 0 ? self->sample_rate : 16000;
+        int channels = self->channels > 0 ? self->channels : 1;
+        if (data->capture_start_us == 0) {
+            data->capture_start_us = stub_now_us();
+        }
+        uint64_t deadline = data->capture_start_us +
+            (data->captured_frames + frame_size / (size_t)channels) * 1000000ULL / rate;
+        stub_tone_fill(self, data, buffer, frame_size);
+        pthread_mutex_unlock(&data->tone_mutex);
+        
+        stub_sleep_until_us(deadline);
+        return 0;
+    }
+    
     // Fill buffer with silence (zeros)
     memset(buffer, 0, frame_size * sizeof(short));
     return 0; // Success (stub implementation - returns silence)
@@ -89,6 +272,13 @@ static int audio_stub_write(AudioInterface* self, short* buffer, size_t frame_si
     AudioStubData* data = (AudioStubData*)self->impl_data;
     if (!data || !data->playing) return -1;
     
+    if (data->tone_enabled) {
+        pthread_mutex_lock(&data->tone_mutex);
+        stub_tone_detect(self, data, buffer, frame_size);
+        pthread_mutex_unlock(&data->tone_mutex);
+        return 0;
+    }
+    
     // Stub implementation - just discard the data
     (void)frame_size; // Suppress unused parameter warning
     return 0; // Success (stub implementation - discards data)
@@ -131,8 +321,17 @@ static int audio_stub_destroy(AudioInterface* self) {
     
     AudioStubData* data = (AudioStubData*)self->impl_data;
     if (data) {
-        free(data);
+        pthread_mutex_destroy(&data->tone_mutex);
+        LINX_FREE(data->latencies_us);
+        LINX_FREE(data);
         self->impl_data = NULL;
     }
     return 0; // Success
+}
+
+static int audio_stub_flush_play(AudioInterface* self) {
+    if (!self) return -1;
+    
+    // Nothing is queued in the stub; written data is consumed immediately
+    return 0;
 }
\ No newline at end of file
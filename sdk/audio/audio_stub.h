@@ -2,11 +2,44 @@
 #define AUDIO_STUB_H
 
 #include "audio_interface.h"
+#include <pthread.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * Tone loopback mode (headless latency measurement)
+ *
+ * Once enabled, read() is paced to real time like a microphone and emits a
+ * short tone burst every `interval_ms`; write() watches the played PCM for
+ * burst onsets and records the mouth-to-ear delay of each one: the time from
+ * when its first sample was captured to when it reached write(). A burst is
+ * matched to the oldest one still outstanding; bursts not heard back within
+ * one interval are counted as lost, so delays must stay below the interval.
+ */
+typedef struct {
+    unsigned int interval_ms;       // Time between burst starts (default 1000)
+    unsigned int duration_ms;       // Burst length (default 100)
+    unsigned int frequency_hz;      // Tone frequency (default 1000)
+    short amplitude;                // Peak amplitude (default 8000)
+    short detect_threshold;         // |sample| on output that counts as tone (default amplitude / 4)
+} audio_stub_tone_config_t;
+
+/**
+ * Tone loopback statistics
+ */
+typedef struct {
+    uint64_t bursts_sent;           // Bursts emitted by read()
+    uint64_t bursts_received;       // Bursts detected by write() and matched
+    uint64_t bursts_lost;           // Bursts not heard back within one interval
+    uint64_t spurious_onsets;       // Onsets with no outstanding burst
+} audio_stub_tone_stats_t;
+
+/* Outstanding bursts tracked at once */
+#define AUDIO_STUB_TONE_PENDING 16
+
 /**
  * Stub audio implementation data structure
  * This is a placeholder implementation for platforms without audio support
@@ -15,6 +48,22 @@ typedef struct {
     bool initialized;
     bool recording;
     bool playing;
+    
+    // Tone loopback mode (guarded by tone_mutex; read and write run on different threads)
+    pthread_mutex_t tone_mutex;
+    bool tone_enabled;
+    audio_stub_tone_config_t tone;
+    uint64_t capture_start_us;      // Monotonic time of the first captured sample
+    uint64_t captured_frames;       // Frames returned by read() so far
+    uint64_t pending_us[AUDIO_STUB_TONE_PENDING];   // Capture times of outstanding bursts
+    size_t pending_head;
+    size_t pending_count;
+    bool output_in_tone;            // write() is inside a detected burst
+    size_t output_quiet_samples;    // Consecutive quiet samples since the last loud one
+    uint32_t* latencies_us;         // Recorded mouth-to-ear delays
+    size_t latency_count;
+    size_t latency_capacity;
+    audio_stub_tone_stats_t tone_stats;
 } AudioStubData;
 
 /**
@@ -23,6 +72,24 @@ typedef struct {
  */
 AudioInterface* audio_stub_create(void);
 
+/**
+ * Enable tone loopback mode (call before recording starts)
+ * @param config Tone parameters; NULL or zero fields take the defaults
+ * @return 0 on success, -1 on failure
+ */
+int audio_stub_enable_tone(AudioInterface* self, const audio_stub_tone_config_t* config);
+
+/**
+ * Copy the recorded mouth-to-ear delays (microseconds, in detection order)
+ * @return Number of delays recorded; at most `max` are copied
+ */
+size_t audio_stub_get_latencies(AudioInterface* self, uint32_t* latencies_us, size_t max);
+
+/**
+ * Get tone loopback statistics
+ */
+bool audio_stub_get_tone_stats(AudioInterface* self, audio_stub_tone_stats_t* stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,105 @@
+#include "audio_vad.h"
+#include "audio_dsp.h"
+#include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
+#include <stdlib.h>
+#include <stdint.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_AUDIO);
+
+#define ENERGY_VAD_DEFAULT_RATIO    8
+#define ENERGY_VAD_DEFAULT_MIN_RMS  60
+#define ENERGY_VAD_RISE_SHIFT       6   // Noise floor rises by 1/64 of the gap per non-speech frame
+#define ENERGY_VAD_SPEECH_SHIFT     10  // ... and by 1/1024 during speech, to recover from a noise step
+
+typedef struct {
+    double energy_ratio;
+    double min_energy;          // min_rms squared
+    double noise_floor;         // Mean square energy of the background
+    bool primed;                // noise_floor has been seeded from a real frame
+} energy_vad_t;
+
+bool audio_vad_is_speech(audio_vad_t* vad, const short* samples, size_t count) {
+    if (!vad || !vad->vtable || !vad->vtable->is_speech || !samples || count == 0) {
+        return false;
+    }
+    return vad->vtable->is_speech(vad, samples, count);
+}
+
+void audio_vad_reset(audio_vad_t* vad) {
+    if (vad && vad->vtable && vad->vtable->reset) {
+        vad->vtable->reset(vad);
+    }
+}
+
+void audio_vad_destroy(audio_vad_t* vad) {
+    if (vad && vad->vtable && vad->vtable->destroy) {
+        vad->vtable->destroy(vad);
+    }
+}
+
+static bool energy_vad_is_speech(audio_vad_t* self, const short* samples, size_t count) {
+    energy_vad_t* impl = (energy_vad_t*)self->impl_data;
+
+    double energy = (double)audio_dsp_sum_squares(samples, count) / (double)count;
+
+    if (!impl->primed) {
+        // Seed the floor from the first frame; listening normally starts before speech,
+        // and if it does not, the floor drops to the background in the first pause
+        impl->noise_floor = energy;
+        impl->primed = true;
+    }
+
+    bool speech = energy >= impl->min_energy && energy > impl->noise_floor * impl->energy_ratio;
+
+    if (energy < impl->noise_floor) {
+        // Quiet frames pull the floor down quickly
+        impl->noise_floor = (impl->noise_floor + energy) / 2;
+    } else {
+        int shift = speech ? ENERGY_VAD_SPEECH_SHIFT : ENERGY_VAD_RISE_SHIFT;
+        impl->noise_floor += (energy - impl->noise_floor) / (double)(1 << shift);
+    }
+    if (impl->noise_floor < 1.0) {
+        impl->noise_floor = 1.0;
+    }
+    return speech;
+}
+
+static void energy_vad_reset(audio_vad_t* self) {
+    energy_vad_t* impl = (energy_vad_t*)self->impl_data;
+    impl->noise_floor = 1.0;
+    impl->primed = false;
+}
+
+static void energy_vad_destroy(audio_vad_t* self) {
+    LINX_FREE(self->impl_data);
+    LINX_FREE(self);
+}
+
+static const audio_vad_vtable_t energy_vad_vtable = {
+    .is_speech = energy_vad_is_speech,
+    .reset = energy_vad_reset,
+    .destroy = energy_vad_destroy,
+};
+
+audio_vad_t* audio_energy_vad_create(const audio_energy_vad_config_t* config) {
+    audio_vad_t* vad = (audio_vad_t*)LINX_CALLOC(1, sizeof(audio_vad_t));
+    energy_vad_t* impl = (energy_vad_t*)LINX_CALLOC(1, sizeof(energy_vad_t));
+    if (!vad || !impl) {
+        LOG_ERROR("Failed to allocate energy VAD");
+        LINX_FREE(vad);
+        LINX_FREE(impl);
+        return NULL;
+    }
+
+    unsigned int ratio = config && config->energy_ratio > 1 ? config->energy_ratio : ENERGY_VAD_DEFAULT_RATIO;
+    unsigned int min_rms = config && config->min_rms > 0 ? config->min_rms : ENERGY_VAD_DEFAULT_MIN_RMS;
+
+    impl->energy_ratio = (double)ratio;
+    impl->min_energy = (double)min_rms * (double)min_rms;
+
+    vad->vtable = &energy_vad_vtable;
+    vad->impl_data = impl;
+    energy_vad_reset(vad);
+    return vad;
+}
@@ -0,0 +1,65 @@
+#ifndef AUDIO_VAD_H
+#define AUDIO_VAD_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Voice activity detector
+ *
+ * Classifies PCM frames as speech or non-speech. Implementations plug in
+ * through the vtable; the SDK ships an adaptive energy detector, a model-based
+ * detector can be added later without touching callers.
+ */
+typedef struct audio_vad audio_vad_t;
+
+/**
+ * Voice activity detector function pointers
+ */
+typedef struct {
+    // Classify one frame of interleaved samples; true means speech
+    bool (*is_speech)(audio_vad_t* self, const short* samples, size_t count);
+    // Forget adaptive state (noise floor etc.)
+    void (*reset)(audio_vad_t* self);
+    void (*destroy)(audio_vad_t* self);
+} audio_vad_vtable_t;
+
+/**
+ * Voice activity detector base structure
+ */
+struct audio_vad {
+    const audio_vad_vtable_t* vtable;
+    void* impl_data;
+};
+
+/**
+ * Energy detector configuration
+ */
+typedef struct {
+    unsigned int energy_ratio;  // Speech energy must exceed the noise floor by this factor (default 8, ~9 dB)
+    unsigned int min_rms;       // Frames quieter than this RMS are never speech (default 60, ~-55 dBFS)
+} audio_energy_vad_config_t;
+
+/**
+ * Create the adaptive energy detector
+ * The noise floor follows quiet frames quickly and louder frames slowly, so
+ * steady background noise is learned and only energy well above it counts.
+ * @param config Configuration, NULL for defaults
+ * @return Detector instance or NULL on failure
+ */
+audio_vad_t* audio_energy_vad_create(const audio_energy_vad_config_t* config);
+
+/* Wrapper functions */
+bool audio_vad_is_speech(audio_vad_t* vad, const short* samples, size_t count);
+void audio_vad_reset(audio_vad_t* vad);
+void audio_vad_destroy(audio_vad_t* vad);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIO_VAD_H
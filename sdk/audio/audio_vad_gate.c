@@ -0,0 +1,294 @@
+#include "audio_vad_gate.h"
+#include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
+#include <stdlib.h>
+#include <string.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_AUDIO);
+
+#define GATE_DEFAULT_FRAME_MS           20
+#define GATE_DEFAULT_PRE_ROLL_MS        200
+#define GATE_DEFAULT_HANGOVER_MS        400
+#define GATE_DEFAULT_ONSET_FRAMES       2
+#define GATE_DEFAULT_MAX_PACKET_BYTES   1275
+#define GATE_DTX_MAX_BYTES              2   // Opus DTX frames carry no audio
+#define GATE_BATCH_FRAMES               8   // Frames encoded per audio_codec_encode_batch call
+
+struct audio_vad_gate {
+    audio_vad_t* vad;
+    audio_codec_t* encoder;
+    audio_vad_gate_output_t output;
+    void* user_data;
+    audio_vad_gate_config_t config;
+    int hangover_frames;
+
+    // Pre-roll: ring of packets encoded while closed, oldest at preroll_head
+    size_t preroll_capacity;
+    size_t preroll_head;
+    size_t preroll_count;
+    uint8_t* preroll_data;
+    size_t* preroll_sizes;
+    bool* preroll_sent;         // Already sent as comfort noise
+
+    // Encoder output for one batch
+    uint8_t* scratch;
+    size_t packet_sizes[GATE_BATCH_FRAMES];
+
+    bool open;
+    int speech_run;             // Consecutive speech frames while closed
+    int hangover_left;          // Frames left before closing
+    int silence_ms;             // Since the last speech frame, -1 before the first one
+    int since_comfort_ms;
+    audio_vad_gate_stats_t stats;
+};
+
+static void gate_emit(audio_vad_gate_t* gate, const uint8_t* packet, size_t size) {
+    if (!gate->output(gate->user_data, packet, size)) {
+        gate->stats.send_failures++;
+    }
+}
+
+static void preroll_push(audio_vad_gate_t* gate, const uint8_t* packet, size_t size, bool sent) {
+    size_t index;
+    if (gate->preroll_count == gate->preroll_capacity) {
+        // Evict the oldest
+        index = gate->preroll_head;
+        if (!gate->preroll_sent[index]) {
+            gate->stats.suppressed_frames++;
+        }
+        gate->preroll_head = (gate->preroll_head + 1) % gate->preroll_capacity;
+    } else {
+        index = (gate->preroll_head + gate->preroll_count) % gate->preroll_capacity;
+        gate->preroll_count++;
+    }
+
+    memcpy(gate->preroll_data + index * gate->config.max_packet_bytes, packet, size);
+    gate->preroll_sizes[index] = size;
+    gate->preroll_sent[index] = sent;
+}
+
+/* Send the pre-roll; returns the number of packets sent */
+static int preroll_flush(audio_vad_gate_t* gate) {
+    // Packets older than the last comfort-noise packet would arrive out of order, skip them
+    size_t start = 0;
+    for (size_t i = 0; i < gate->preroll_count; i++) {
+        if (gate->preroll_sent[(gate->preroll_head + i) % gate->preroll_capacity]) {
+            start = i + 1;
+        }
+    }
+
+    int sent = 0;
+    for (size_t i = 0; i < gate->preroll_count; i++) {
+        size_t index = (gate->preroll_head + i) % gate->preroll_capacity;
+        if (i < start) {
+            gate->stats.suppressed_frames += gate->preroll_sent[index] ? 0 : 1;
+            continue;
+        }
+        gate_emit(gate, gate->preroll_data + index * gate->config.max_packet_bytes,
+                  gate->preroll_sizes[index]);
+        gate->stats.sent_frames++;
+        sent++;
+    }
+    gate->preroll_head = 0;
+    gate->preroll_count = 0;
+    return sent;
+}
+
+static void preroll_drop(audio_vad_gate_t* gate) {
+    for (size_t i = 0; i < gate->preroll_count; i++) {
+        size_t index = (gate->preroll_head + i) % gate->preroll_capacity;
+        if (!gate->preroll_sent[index]) {
+            gate->stats.suppressed_frames++;
+        }
+    }
+    gate->preroll_head = 0;
+    gate->preroll_count = 0;
+}
+
+/* Decide what to do with one encoded frame; returns the number of packets sent */
+static int gate_handle_frame(audio_vad_gate_t* gate, const uint8_t* packet, size_t size, bool speech) {
+    gate->stats.frames++;
+    if (speech) {
+        gate->silence_ms = 0;
+    } else if (gate->silence_ms >= 0 && gate->silence_ms < INT32_MAX - gate->config.frame_duration_ms) {
+        gate->silence_ms += gate->config.frame_duration_ms;
+    }
+
+    if (gate->open) {
+        if (speech) {
+            gate->hangover_left = gate->hangover_frames;
+        } else if (gate->hangover_left > 0) {
+            gate->hangover_left--;
+        }
+
+        gate_emit(gate, packet, size);
+        gate->stats.sent_frames++;
+
+        if (!speech && gate->hangover_left == 0) {
+            gate->open = false;
+            gate->speech_run = 0;
+            gate->since_comfort_ms = 0;
+        }
+        return 1;
+    }
+
+    gate->speech_run = speech ? gate->speech_run + 1 : 0;
+    if (gate->speech_run >= gate->config.onset_frames) {
+        // Onset: send what led up to it, then the current frame
+        int sent = preroll_flush(gate);
+        gate_emit(gate, packet, size);
+        gate->stats.sent_frames++;
+
+        gate->open = true;
+        gate->hangover_left = gate->hangover_frames;
+        gate->stats.onsets++;
+        return sent + 1;
+    }
+
+    // Closed: keep it for the pre-roll, and let a comfort-noise packet through now and then
+    bool comfort = false;
+    gate->since_comfort_ms += gate->config.frame_duration_ms;
+    if (gate->config.comfort_noise_interval_ms > 0 && size > GATE_DTX_MAX_BYTES &&
+        gate->since_comfort_ms >= gate->config.comfort_noise_interval_ms) {
+        gate_emit(gate, packet, size);
+        gate->stats.comfort_frames++;
+        gate->since_comfort_ms = 0;
+        comfort = true;
+    }
+
+    preroll_push(gate, packet, size, comfort);
+    return comfort ? 1 : 0;
+}
+
+audio_vad_gate_t* audio_vad_gate_create(audio_vad_t* vad, audio_codec_t* encoder,
+                                        const audio_vad_gate_config_t* config,
+                                        audio_vad_gate_output_t output, void* user_data) {
+    if (!vad || !encoder || !config || config->frame_samples == 0 || !output) {
+        LOG_ERROR("Invalid VAD gate parameters");
+        return NULL;
+    }
+
+    audio_vad_gate_t* gate = (audio_vad_gate_t*)LINX_CALLOC(1, sizeof(audio_vad_gate_t));
+    if (!gate) {
+        LOG_ERROR("Failed to allocate VAD gate");
+        return NULL;
+    }
+
+    gate->vad = vad;
+    gate->encoder = encoder;
+    gate->output = output;
+    gate->user_data = user_data;
+    gate->config = *config;
+    if (gate->config.frame_duration_ms <= 0) {
+        gate->config.frame_duration_ms = GATE_DEFAULT_FRAME_MS;
+    }
+    if (gate->config.pre_roll_ms <= 0) {
+        gate->config.pre_roll_ms = GATE_DEFAULT_PRE_ROLL_MS;
+    }
+    if (gate->config.hangover_ms <= 0) {
+        gate->config.hangover_ms = GATE_DEFAULT_HANGOVER_MS;
+    }
+    if (gate->config.onset_frames <= 0) {
+        gate->config.onset_frames = GATE_DEFAULT_ONSET_FRAMES;
+    }
+    if (gate->config.comfort_noise_interval_ms < 0) {
+        gate->config.comfort_noise_interval_ms = 0;
+    }
+    if (gate->config.max_packet_bytes == 0) {
+        gate->config.max_packet_bytes = GATE_DEFAULT_MAX_PACKET_BYTES;
+    }
+
+    int frame_ms = gate->config.frame_duration_ms;
+    gate->silence_ms = -1;
+    gate->hangover_frames = (gate->config.hangover_ms + frame_ms - 1) / frame_ms;
+    // The speech frames that precede the onset decision are part of the pre-roll too
+    gate->preroll_capacity = (size_t)((gate->config.pre_roll_ms + frame_ms - 1) / frame_ms) +
+                             (size_t)(gate->config.onset_frames - 1);
+
+    gate->preroll_data = (uint8_t*)LINX_MALLOC(gate->preroll_capacity * gate->config.max_packet_bytes);
+    gate->preroll_sizes = (size_t*)LINX_CALLOC(gate->preroll_capacity, sizeof(size_t));
+    gate->preroll_sent = (bool*)LINX_CALLOC(gate->preroll_capacity, sizeof(bool));
+    gate->scratch = (uint8_t*)LINX_MALLOC(GATE_BATCH_FRAMES * gate->config.max_packet_bytes);
+    if (!gate->preroll_data || !gate->preroll_sizes || !gate->preroll_sent || !gate->scratch) {
+        LOG_ERROR("Failed to allocate VAD gate buffers");
+        audio_vad_gate_destroy(gate);
+        return NULL;
+    }
+
+    LOG_INFO("VAD gate: pre-roll %d ms, hangover %d ms, comfort noise every %d ms",
+             gate->config.pre_roll_ms, gate->config.hangover_ms, gate->config.comfort_noise_interval_ms);
+    return gate;
+}
+
+void audio_vad_gate_destroy(audio_vad_gate_t* gate) {
+    if (!gate) {
+        return;
+    }
+    LINX_FREE(gate->preroll_data);
+    LINX_FREE(gate->preroll_sizes);
+    LINX_FREE(gate->preroll_sent);
+    LINX_FREE(gate->scratch);
+    LINX_FREE(gate);
+}
+
+int audio_vad_gate_process(audio_vad_gate_t* gate, const short* pcm, size_t frame_count) {
+    if (!gate || !pcm) {
+        return -1;
+    }
+
+    size_t frame_samples = gate->config.frame_samples;
+    int sent = 0;
+
+    while (frame_count > 0) {
+        size_t batch = frame_count < GATE_BATCH_FRAMES ? frame_count : GATE_BATCH_FRAMES;
+        size_t encoded = 0;
+        codec_error_t result = audio_codec_encode_batch(gate->encoder, (const int16_t*)pcm, frame_samples, batch,
+                                                        gate->scratch, batch * gate->config.max_packet_bytes,
+                                                        gate->packet_sizes, &encoded);
+
+        size_t offset = 0;
+        for (size_t i = 0; i < encoded; i++) {
+            bool speech = audio_vad_is_speech(gate->vad, pcm + i * frame_samples, frame_samples);
+            sent += gate_handle_frame(gate, gate->scratch + offset, gate->packet_sizes[i], speech);
+            offset += gate->packet_sizes[i];
+        }
+
+        if (result != CODEC_SUCCESS) {
+            LOG_ERROR("VAD gate encode failed: %d", result);
+            return -1;
+        }
+
+        pcm += batch * frame_samples;
+        frame_count -= batch;
+    }
+
+    return sent;
+}
+
+void audio_vad_gate_reset(audio_vad_gate_t* gate) {
+    if (!gate) {
+        return;
+    }
+    preroll_drop(gate);
+    gate->open = false;
+    gate->speech_run = 0;
+    gate->hangover_left = 0;
+    gate->since_comfort_ms = 0;
+    gate->silence_ms = -1;
+}
+
+int audio_vad_gate_silence_ms(const audio_vad_gate_t* gate) {
+    return gate ? gate->silence_ms : -1;
+}
+
+bool audio_vad_gate_is_open(const audio_vad_gate_t* gate) {
+    return gate ? gate->open : false;
+}
+
+bool audio_vad_gate_get_stats(const audio_vad_gate_t* gate, audio_vad_gate_stats_t* stats) {
+    if (!gate || !stats) {
+        return false;
+    }
+    *stats = gate->stats;
+    return true;
+}
@@ -0,0 +1,113 @@
+#ifndef AUDIO_VAD_GATE_H
+#define AUDIO_VAD_GATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "audio_vad.h"
+#include "../codecs/audio_codec.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Voice-activity gate for the uplink
+ *
+ * Sits in front of the encoder's output: every captured frame is encoded so
+ * the encoder state stays continuous, but packets are only handed to the
+ * output callback while the gate is open. The gate opens after a short run of
+ * speech frames, flushes the pre-roll (the packets encoded just before the
+ * onset) so word beginnings are not clipped, and closes again after a
+ * hangover period without speech.
+ *
+ * While closed, an optional comfort-noise interval lets one packet through
+ * every N ms so the far end can keep generating background noise. With Opus,
+ * enable DTX on the encoder (opus_codec_set_dtx); the 1-2 byte DTX packets it
+ * then emits in silence are never sent by the gate. Packets are always sent in
+ * encode order, so at an onset the pre-roll only reaches back to the last
+ * comfort-noise packet.
+ *
+ * Not thread-safe: feed it from the capture/encode thread.
+ */
+typedef struct audio_vad_gate audio_vad_gate_t;
+
+/**
+ * Receives each packet the gate lets through, in order
+ * @return false to report a send failure (counted, does not stop the gate)
+ */
+typedef bool (*audio_vad_gate_output_t)(void* user_data, const uint8_t* packet, size_t size);
+
+/**
+ * Gate configuration; zero fields take the defaults
+ */
+typedef struct {
+    size_t frame_samples;           // Samples per frame, all channels (required)
+    int frame_duration_ms;          // Frame duration (default 20)
+    int pre_roll_ms;                // Audio flushed ahead of an onset (default 200)
+    int hangover_ms;                // Keep sending this long after the last speech frame (default 400)
+    int onset_frames;               // Consecutive speech frames needed to open (default 2)
+    int comfort_noise_interval_ms;  // Let one packet through every N ms while closed, 0 = never
+    size_t max_packet_bytes;        // Largest encoded frame (default 1275, the Opus limit)
+} audio_vad_gate_config_t;
+
+/**
+ * Gate statistics
+ */
+typedef struct {
+    uint64_t frames;                // Frames processed
+    uint64_t sent_frames;           // Speech, pre-roll and hangover packets sent
+    uint64_t comfort_frames;        // Comfort-noise packets sent while closed
+    uint64_t suppressed_frames;     // Packets never sent
+    uint64_t onsets;                // Times the gate opened
+    uint64_t send_failures;         // Packets the output callback rejected
+} audio_vad_gate_stats_t;
+
+/**
+ * Create a gate
+ * @param vad Detector (not owned; must outlive the gate)
+ * @param encoder Initialized encoder (not owned)
+ * @param output Packet receiver
+ * @return Gate instance or NULL on failure
+ */
+audio_vad_gate_t* audio_vad_gate_create(audio_vad_t* vad, audio_codec_t* encoder,
+                                        const audio_vad_gate_config_t* config,
+                                        audio_vad_gate_output_t output, void* user_data);
+
+/**
+ * Destroy a gate
+ */
+void audio_vad_gate_destroy(audio_vad_gate_t* gate);
+
+/**
+ * Encode `frame_count` consecutive frames and send what the gate lets through
+ * @return Number of packets sent, or -1 if encoding failed
+ */
+int audio_vad_gate_process(audio_vad_gate_t* gate, const short* pcm, size_t frame_count);
+
+/**
+ * Close the gate and drop the pre-roll (e.g. when listening stops)
+ */
+void audio_vad_gate_reset(audio_vad_gate_t* gate);
+
+/**
+ * Whether speech packets are currently being sent
+ */
+bool audio_vad_gate_is_open(const audio_vad_gate_t* gate);
+
+/**
+ * Trailing silence: time since the last frame the detector called speech
+ * @return Milliseconds, or -1 if no speech was seen since the last reset
+ */
+int audio_vad_gate_silence_ms(const audio_vad_gate_t* gate);
+
+/**
+ * Get statistics
+ */
+bool audio_vad_gate_get_stats(const audio_vad_gate_t* gate, audio_vad_gate_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIO_VAD_GATE_H
@@ -0,0 +1,320 @@
+#include "audio_wake.h"
+#include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
+#include <string.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_AUDIO);
+
+#define WAKE_DEFAULT_FRAME_MS       20
+#define WAKE_DEFAULT_PRE_ROLL_MS    1000
+#define WAKE_DEFAULT_MAX_PENDING_MS 2000
+#define WAKE_DEFAULT_VERIFY_MS      1000
+
+struct audio_wake {
+    audio_kws_t* kws;
+    audio_wake_config_t config;
+    size_t pre_roll_frames;
+    size_t max_pending_frames;
+    size_t verify_frames;
+
+    // Ring of whole frames, oldest at head
+    short* ring;
+    size_t ring_frames;
+    size_t head;
+    size_t count;
+
+    audio_wake_state_t state;   // Atomic: written by the pipeline thread
+    size_t pending_frames;      // Frames since the detection
+    size_t verifying_frames;    // Frames since the first stage hit
+    bool rearm_pending;         // Atomic
+
+    // Atomic counters
+    uint64_t frames;
+    uint64_t spotted_frames;
+    uint64_t detections;
+    uint64_t candidates;
+    uint64_t rejections;
+    uint64_t flushed_frames;
+    uint64_t timeouts;
+    uint32_t last_wait_ms;
+};
+
+bool audio_kws_detect(audio_kws_t* kws, const short* samples, size_t count, const char** keyword) {
+    const char* name = NULL;
+    if (!kws || !kws->vtable || !kws->vtable->detect || !samples) {
+        return false;
+    }
+    bool detected = kws->vtable->detect(kws, samples, count, &name);
+    if (keyword) {
+        *keyword = name ? name : "";
+    }
+    return detected;
+}
+
+void audio_kws_reset(audio_kws_t* kws) {
+    if (kws && kws->vtable && kws->vtable->reset) {
+        kws->vtable->reset(kws);
+    }
+}
+
+void audio_kws_destroy(audio_kws_t* kws) {
+    if (kws && kws->vtable && kws->vtable->destroy) {
+        kws->vtable->destroy(kws);
+    }
+}
+
+audio_wake_t* audio_wake_create(audio_kws_t* kws, const audio_wake_config_t* config) {
+    if (!kws || !config || config->frame_samples == 0) {
+        LOG_ERROR("Invalid wake stage parameters");
+        return NULL;
+    }
+
+    audio_wake_t* wake = (audio_wake_t*)LINX_CALLOC(1, sizeof(audio_wake_t));
+    if (!wake) {
+        LOG_ERROR("Failed to allocate wake stage");
+        return NULL;
+    }
+    wake->kws = kws;
+    wake->config = *config;
+    if (wake->config.frame_duration_ms <= 0) {
+        wake->config.frame_duration_ms = WAKE_DEFAULT_FRAME_MS;
+    }
+    if (wake->config.pre_roll_ms <= 0) {
+        wake->config.pre_roll_ms = WAKE_DEFAULT_PRE_ROLL_MS;
+    }
+    if (wake->config.max_pending_ms <= 0) {
+        wake->config.max_pending_ms = WAKE_DEFAULT_MAX_PENDING_MS;
+    }
+    if (wake->config.verify_timeout_ms <= 0) {
+        wake->config.verify_timeout_ms = WAKE_DEFAULT_VERIFY_MS;
+    }
+    int frame_ms = wake->config.frame_duration_ms;
+    wake->pre_roll_frames = (size_t)((wake->config.pre_roll_ms + frame_ms - 1) / frame_ms);
+    wake->max_pending_frames = (size_t)((wake->config.max_pending_ms + frame_ms - 1) / frame_ms);
+    if (wake->config.verifier) {
+        wake->verify_frames = (size_t)((wake->config.verify_timeout_ms + frame_ms - 1) / frame_ms);
+    }
+
+    // Pre-roll plus everything captured while the keyword is verified and the session comes up;
+    // seconds of PCM, so bulk memory
+    wake->ring_frames = wake->pre_roll_frames + wake->verify_frames + wake->max_pending_frames + 1;
+    wake->ring = (short*)LINX_CALLOC_BULK(wake->ring_frames * config->frame_samples, sizeof(short));
+    if (!wake->ring) {
+        LOG_ERROR("Failed to allocate wake pre-roll (%zu frames)", wake->ring_frames);
+        LINX_FREE(wake);
+        return NULL;
+    }
+    if (wake->config.verifier) {
+        LOG_INFO("Wake stage: %d ms pre-roll, two-stage with %d ms to verify, %d ms max wait for the session",
+                 wake->config.pre_roll_ms, wake->config.verify_timeout_ms, wake->config.max_pending_ms);
+    } else {
+        LOG_INFO("Wake stage: %d ms pre-roll, %d ms max wait for the session",
+                 wake->config.pre_roll_ms, wake->config.max_pending_ms);
+    }
+    return wake;
+}
+
+void audio_wake_destroy(audio_wake_t* wake) {
+    if (!wake) {
+        return;
+    }
+    LINX_FREE(wake->ring);
+    LINX_FREE(wake);
+}
+
+static short* wake_ring_frame(audio_wake_t* wake, size_t index) {
+    return wake->ring + ((wake->head + index) % wake->ring_frames) * wake->config.frame_samples;
+}
+
+/* Append a frame; while spotting only the pre-roll is kept */
+static void wake_ring_push(audio_wake_t* wake, const short* pcm, size_t limit) {
+    while (wake->count >= limit) {
+        wake->head = (wake->head + 1) % wake->ring_frames;
+        wake->count--;
+    }
+    memcpy(wake_ring_frame(wake, wake->count), pcm, wake->config.frame_samples * sizeof(short));
+    wake->count++;
+}
+
+static void wake_ring_trim(audio_wake_t* wake, size_t keep) {
+    while (wake->count > keep) {
+        wake->head = (wake->head + 1) % wake->ring_frames;
+        wake->count--;
+    }
+}
+
+static void wake_set_state(audio_wake_t* wake, audio_wake_state_t state) {
+    __atomic_store_n(&wake->state, state, __ATOMIC_RELEASE);
+}
+
+static void wake_flush(audio_wake_t* wake) {
+    const audio_stage_t* sink = &wake->config.sink;
+    size_t flushed = wake->count;
+    if (sink->process) {
+        for (size_t i = 0; i < wake->count; i++) {
+            if (sink->process(sink->ctx, wake_ring_frame(wake, i), NULL, wake->config.frame_samples) < 0) {
+                LOG_WARN("Wake sink failed, %zu pre-roll frames not sent", wake->count - i);
+                flushed = i;
+                break;
+            }
+        }
+    }
+    __atomic_add_fetch(&wake->flushed_frames, flushed, __ATOMIC_RELAXED);
+    wake->head = 0;
+    wake->count = 0;
+}
+
+static void wake_reset(void* ctx) {
+    audio_wake_t* wake = (audio_wake_t*)ctx;
+    audio_kws_reset(wake->kws);
+    audio_kws_reset(wake->config.verifier);
+    wake->head = 0;
+    wake->count = 0;
+    wake->pending_frames = 0;
+    wake->verifying_frames = 0;
+    wake_set_state(wake, AUDIO_WAKE_SPOTTING);
+}
+
+/* Keyword confirmed: wait for the session, holding what follows */
+static void wake_detected(audio_wake_t* wake, const char* keyword) {
+    __atomic_add_fetch(&wake->detections, 1, __ATOMIC_RELAXED);
+    LOG_INFO("Wake word \"%s\" detected", keyword);
+    wake->pending_frames = 0;
+    wake_set_state(wake, AUDIO_WAKE_PENDING);
+    if (wake->config.on_wake) {
+        wake->config.on_wake(wake->config.user_data, keyword);
+    }
+}
+
+/* First stage hit: let the verifier listen to the pre-roll, which ends with the candidate */
+static bool wake_candidate(audio_wake_t* wake, const char* keyword) {
+    __atomic_add_fetch(&wake->candidates, 1, __ATOMIC_RELAXED);
+    LOG_INFO("Wake word \"%s\" candidate, verifying", keyword);
+    wake->verifying_frames = 0;
+    wake_set_state(wake, AUDIO_WAKE_VERIFYING);
+    if (wake->config.on_candidate) {
+        wake->config.on_candidate(wake->config.user_data, keyword);
+    }
+    audio_kws_reset(wake->config.verifier);
+    const char* confirmed = NULL;
+    for (size_t i = 0; i < wake->count; i++) {
+        if (audio_kws_detect(wake->config.verifier, wake_ring_frame(wake, i), wake->config.frame_samples,
+                             &confirmed)) {
+            wake_detected(wake, confirmed);
+            return true;
+        }
+    }
+    return false;
+}
+
+static int wake_process(void* ctx, const short* in, short* out, size_t samples) {
+    (void)out;
+    audio_wake_t* wake = (audio_wake_t*)ctx;
+    if (samples != wake->config.frame_samples) {
+        return -1;
+    }
+    __atomic_add_fetch(&wake->frames, 1, __ATOMIC_RELAXED);
+    if (__atomic_exchange_n(&wake->rearm_pending, false, __ATOMIC_ACQ_REL)) {
+        wake_reset(wake);
+    }
+
+    const char* keyword = NULL;
+    audio_wake_state_t state = __atomic_load_n(&wake->state, __ATOMIC_RELAXED);
+    if (state == AUDIO_WAKE_AWAKE) {
+        if (wake->config.detect_while_awake) {
+            __atomic_add_fetch(&wake->spotted_frames, 1, __ATOMIC_RELAXED);
+            if (audio_kws_detect(wake->kws, in, samples, &keyword)) {
+                __atomic_add_fetch(&wake->detections, 1, __ATOMIC_RELAXED);
+                LOG_INFO("Wake word \"%s\" detected while awake", keyword);
+                if (wake->config.on_wake) {
+                    wake->config.on_wake(wake->config.user_data, keyword);
+                }
+            }
+        }
+        return 0;
+    }
+
+    if (state == AUDIO_WAKE_SPOTTING) {
+        wake_ring_push(wake, in, wake->pre_roll_frames);
+        __atomic_add_fetch(&wake->spotted_frames, 1, __ATOMIC_RELAXED);
+        if (!audio_kws_detect(wake->kws, in, samples, &keyword)) {
+            return AUDIO_STAGE_STOP;
+        }
+        if (wake->config.verifier) {
+            if (!wake_candidate(wake, keyword)) {
+                return AUDIO_STAGE_STOP;
+            }
+        } else {
+            wake_detected(wake, keyword);
+        }
+    } else if (state == AUDIO_WAKE_VERIFYING) {
+        wake_ring_push(wake, in, wake->ring_frames);
+        wake->verifying_frames++;
+        if (!audio_kws_detect(wake->config.verifier, in, samples, &keyword)) {
+            if (wake->verifying_frames >= wake->verify_frames) {
+                __atomic_add_fetch(&wake->rejections, 1, __ATOMIC_RELAXED);
+                LOG_INFO("Wake word candidate not confirmed, back to spotting");
+                wake_ring_trim(wake, wake->pre_roll_frames);
+                audio_kws_reset(wake->kws);
+                wake_set_state(wake, AUDIO_WAKE_SPOTTING);
+                if (wake->config.on_reject) {
+                    wake->config.on_reject(wake->config.user_data);
+                }
+            }
+            return AUDIO_STAGE_STOP;
+        }
+        wake_detected(wake, keyword);
+    } else {
+        // Hold the audio that follows the keyword until the session is up
+        wake_ring_push(wake, in, wake->ring_frames);
+        wake->pending_frames++;
+    }
+
+    if (wake->config.is_ready && !wake->config.is_ready(wake->config.user_data)) {
+        if (wake->pending_frames >= wake->max_pending_frames) {
+            __atomic_add_fetch(&wake->timeouts, 1, __ATOMIC_RELAXED);
+            LOG_WARN("Session not ready %d ms after the wake word, back to spotting", wake->config.max_pending_ms);
+            wake_ring_trim(wake, wake->pre_roll_frames);
+            audio_kws_reset(wake->kws);
+            wake_set_state(wake, AUDIO_WAKE_SPOTTING);
+        }
+        return AUDIO_STAGE_STOP;
+    }
+
+    // This frame is the newest in the ring, so it is flushed with the rest
+    __atomic_store_n(&wake->last_wait_ms,
+                     (uint32_t)(wake->pending_frames * (size_t)wake->config.frame_duration_ms), __ATOMIC_RELAXED);
+    wake_flush(wake);
+    wake_set_state(wake, AUDIO_WAKE_AWAKE);
+    return AUDIO_STAGE_STOP;
+}
+
+audio_stage_t audio_wake_stage(audio_wake_t* wake) {
+    audio_stage_t stage = { "wake", wake_process, wake_reset, AUDIO_STAGE_READ_ONLY, wake, 0 };
+    return stage;
+}
+
+void audio_wake_rearm(audio_wake_t* wake) {
+    if (wake) {
+        __atomic_store_n(&wake->rearm_pending, true, __ATOMIC_RELEASE);
+    }
+}
+
+audio_wake_state_t audio_wake_get_state(const audio_wake_t* wake) {
+    return wake ? __atomic_load_n(&wake->state, __ATOMIC_ACQUIRE) : AUDIO_WAKE_SPOTTING;
+}
+
+bool audio_wake_get_stats(const audio_wake_t* wake, audio_wake_stats_t* stats) {
+    if (!wake || !stats) {
+        return false;
+    }
+    stats->frames = __atomic_load_n(&wake->frames, __ATOMIC_RELAXED);
+    stats->spotted_frames = __atomic_load_n(&wake->spotted_frames, __ATOMIC_RELAXED);
+    stats->detections = __atomic_load_n(&wake->detections, __ATOMIC_RELAXED);
+    stats->candidates = __atomic_load_n(&wake->candidates, __ATOMIC_RELAXED);
+    stats->rejections = __atomic_load_n(&wake->rejections, __ATOMIC_RELAXED);
+    stats->flushed_frames = __atomic_load_n(&wake->flushed_frames, __ATOMIC_RELAXED);
+    stats->timeouts = __atomic_load_n(&wake->timeouts, __ATOMIC_RELAXED);
+    stats->last_wait_ms = __atomic_load_n(&wake->last_wait_ms, __ATOMIC_RELAXED);
+    return true;
+}
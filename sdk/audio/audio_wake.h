@@ -0,0 +1,167 @@
+#ifndef AUDIO_WAKE_H
+#define AUDIO_WAKE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "audio_pipeline.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Keyword spotter
+ *
+ * On-device wake word engines (WakeNet, Porcupine, a vendor DSP model...)
+ * plug in through the vtable. The SDK does not ship an engine.
+ */
+typedef struct audio_kws audio_kws_t;
+
+/**
+ * Keyword spotter function pointers
+ */
+typedef struct {
+    // Feed interleaved samples (any count, the engine re-chunks internally);
+    // true when a keyword ended in this block, with *keyword set to its
+    // name (owned by the engine, valid until the next call)
+    bool (*detect)(audio_kws_t* self, const short* samples, size_t count, const char** keyword);
+    // Forget the partial match and any buffered samples
+    void (*reset)(audio_kws_t* self);
+    void (*destroy)(audio_kws_t* self);
+} audio_kws_vtable_t;
+
+/**
+ * Keyword spotter base structure
+ */
+struct audio_kws {
+    const audio_kws_vtable_t* vtable;
+    void* impl_data;
+};
+
+/* Wrapper functions */
+bool audio_kws_detect(audio_kws_t* kws, const short* samples, size_t count, const char** keyword);
+void audio_kws_reset(audio_kws_t* kws);
+void audio_kws_destroy(audio_kws_t* kws);
+
+/**
+ * Wake word stage for the uplink audio pipeline
+ *
+ * Place it after the front-end stages (AEC, noise suppression) and before
+ * the encoder sink, so the spotter listens to the same cleaned-up frames
+ * that are sent and no second capture or feature path runs:
+ *
+ *   capture -> AEC -> NS -> wake -> VAD gate / encode / send
+ *
+ * Keeps the last `pre_roll_ms` of audio in a ring of frames. States:
+ * - SPOTTING: every frame goes to the spotter and into the ring; nothing
+ *   reaches the later stages, so the encoder does not run while idle
+ * - PENDING: a keyword was detected and on_wake() was called (typically
+ *   linx_sdk_wake(), which connects and sends the wake word once the
+ *   session is up). Frames keep collecting after the pre-roll until
+ *   is_ready() reports that the session takes audio
+ *   (linx_sdk_is_uplink_open()), then the pre-roll and everything held
+ *   since are pushed through `sink`, oldest first, in one go
+ * - AWAKE: frames pass on to the later stages; the spotter only runs with
+ *   `detect_while_awake` (barge-in by wake word)
+ *
+ * audio_wake_rearm() returns to SPOTTING when the conversation ends.
+ * A session that does not become ready within `max_pending_ms` also falls
+ * back to SPOTTING.
+ *
+ * Two-stage spotting: with a `verifier`, a hit of the first (cheap) spotter
+ * only makes the audio a candidate. on_candidate() is called (typically
+ * linx_sdk_wake_speculative(), which starts connect -> hello -> listen
+ * while the audio is still being checked) and the state is VERIFYING: the
+ * pre-roll and every following frame go to the verifier and are held in
+ * the ring. A verifier hit continues as above with on_wake() (typically
+ * linx_sdk_wake(), which confirms the speculative session); no hit within
+ * `verify_timeout_ms` calls on_reject() (typically linx_sdk_wake_cancel())
+ * and goes back to SPOTTING.
+ *
+ * The sink is usually the same VAD gate stage that follows in the
+ * pipeline (audio_stage_vad_gate): the keyword is speech, so the gate
+ * opens on the flushed audio and the server receives the keyword, and the
+ * encoder sees one continuous stream.
+ *
+ * The stage and its callbacks run on the pipeline thread.
+ */
+typedef struct audio_wake audio_wake_t;
+
+typedef enum {
+    AUDIO_WAKE_SPOTTING = 0,
+    AUDIO_WAKE_PENDING,
+    AUDIO_WAKE_AWAKE,
+    AUDIO_WAKE_VERIFYING            // First stage hit, waiting for the verifier
+} audio_wake_state_t;
+
+/**
+ * Wake stage configuration; zero fields take the defaults
+ */
+typedef struct {
+    size_t frame_samples;           // Samples per frame, all channels (required)
+    int frame_duration_ms;          // Frame duration (default 20)
+    int pre_roll_ms;                // Audio kept ahead of the detection (default 1000)
+    int max_pending_ms;             // Wait for the session at most this long (default 2000)
+    bool detect_while_awake;        // Keep spotting while awake, on_wake() on every keyword
+    audio_stage_t sink;             // Receives the flushed frames (process NULL: not flushed)
+    void (*on_wake)(void* user_data, const char* keyword);  // Keyword detected
+    bool (*is_ready)(void* user_data);  // Session takes audio (NULL: at once)
+    audio_kws_t* verifier;          // Second stage spotter (not owned; NULL: single stage)
+    int verify_timeout_ms;          // Give up on a candidate after this long (default 1000)
+    void (*on_candidate)(void* user_data, const char* keyword);  // First stage hit (verifier only)
+    void (*on_reject)(void* user_data); // Verifier did not confirm the candidate
+    void* user_data;
+} audio_wake_config_t;
+
+/**
+ * Wake stage statistics
+ */
+typedef struct {
+    uint64_t frames;                // Frames seen
+    uint64_t spotted_frames;        // Frames given to the spotter
+    uint64_t detections;            // Keywords detected (confirmed by the verifier when there is one)
+    uint64_t candidates;            // First stage hits handed to the verifier
+    uint64_t rejections;            // Candidates the verifier did not confirm
+    uint64_t flushed_frames;        // Pre-roll and held frames pushed to the sink
+    uint64_t timeouts;              // Sessions that were not ready within max_pending_ms
+    uint32_t last_wait_ms;          // Detection to ready of the last wake
+} audio_wake_stats_t;
+
+/**
+ * Create a wake stage
+ * @param kws Spotter (not owned; must outlive the stage)
+ * @return Stage instance or NULL on failure
+ */
+audio_wake_t* audio_wake_create(audio_kws_t* kws, const audio_wake_config_t* config);
+
+/**
+ * Destroy a wake stage
+ */
+void audio_wake_destroy(audio_wake_t* wake);
+
+/**
+ * Pipeline stage running the wake logic (AUDIO_STAGE_READ_ONLY)
+ */
+audio_stage_t audio_wake_stage(audio_wake_t* wake);
+
+/**
+ * Go back to spotting before the next frame, e.g. when the session ends (any thread)
+ */
+void audio_wake_rearm(audio_wake_t* wake);
+
+/**
+ * Current state (any thread)
+ */
+audio_wake_state_t audio_wake_get_state(const audio_wake_t* wake);
+
+/**
+ * Get statistics (any thread)
+ */
+bool audio_wake_get_stats(const audio_wake_t* wake, audio_wake_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIO_WAKE_H
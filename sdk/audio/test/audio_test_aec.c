@@ -0,0 +1,275 @@
+/**
+ * Offline tests for audio_aec
+ *
+ * The far end plays speech-like noise through a simulated echo path: a
+ * 70 ms bulk delay (10 ms more than the configured device latency) followed
+ * by a 600-tap exponentially decaying random impulse response. Each 20 ms
+ * step feeds the played frame as the reference and then cancels the
+ * captured frame, as the SDK's playback tap and capture loop do.
+ *
+ * Measured: ERLE of the linear filter once converged (about 40 dB), residual
+ * suppression while only the far end talks, near-end speech passing through
+ * double talk without a filter reset, pass-through with no reference, and
+ * the aligned far-end timestamp.
+ */
+
+#include "../audio_aec.h"
+#include "audio_test_signal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define RATE            16000
+#define FRAME           320                   // 20 ms
+#define ECHO_DELAY      (RATE * 70 / 1000)    // Bulk delay of the simulated path
+#define ECHO_TAPS       600
+#define FAR_AMP         6000.0
+#define MIC_NOISE       8.0
+
+typedef struct {
+    float h[ECHO_TAPS];
+    short* history;                 // Every far sample played so far
+    size_t played;
+    size_t capacity;
+    uint32_t seed;
+    float far_lp;                   // State of the speech-like far-end filter
+    float near_lp;
+} echo_sim_t;
+
+static bool echo_sim_init(echo_sim_t* sim, size_t seconds) {
+    memset(sim, 0, sizeof(*sim));
+    sim->seed = 2024;
+    sim->capacity = (size_t)RATE * seconds + FRAME;
+    sim->history = (short*)calloc(sim->capacity, sizeof(short));
+    /* Direct path plus a decaying reverberant tail, -40 dB at the last tap; echo return loss about 8 dB */
+    for (int j = 0; j < ECHO_TAPS; j++) {
+        sim->h[j] = (float)(audio_test_noise(&sim->seed, 0.05) * exp(-4.6 * j / ECHO_TAPS));
+    }
+    sim->h[0] = 0.3f;
+    return sim->history != NULL;
+}
+
+/* Low-passed noise with a syllable-rate envelope, so its spectrum and level vary like speech */
+static void speech_like(uint32_t* seed, float* lp, size_t index, double amp, double rate_hz, short* out) {
+    for (size_t i = 0; i < FRAME; i++) {
+        double t = (double)(index + i) / RATE;
+        double envelope = 0.55 + 0.45 * sin(2.0 * M_PI * rate_hz * t);
+        *lp = 0.7f * *lp + 0.3f * (float)audio_test_noise(seed, 1.0);
+        out[i] = audio_test_clip(amp * envelope * *lp * 2.0);
+    }
+}
+
+/* Play one far frame and capture what the mic hears: echo + near talk + mic noise */
+static void echo_sim_step(echo_sim_t* sim, const short* far, const short* near_talk, short* mic, float* echo_out) {
+    memcpy(sim->history + sim->played, far, FRAME * sizeof(short));
+    for (size_t i = 0; i < FRAME; i++) {
+        size_t n = sim->played + i;
+        double echo = 0.0;
+        for (int j = 0; j < ECHO_TAPS; j++) {
+            if (n >= (size_t)(ECHO_DELAY + j)) {
+                echo += sim->h[j] * sim->history[n - ECHO_DELAY - j];
+            }
+        }
+        if (echo_out) {
+            echo_out[i] = (float)echo;
+        }
+        double v = echo + (near_talk ? near_talk[i] : 0) + audio_test_noise(&sim->seed, MIC_NOISE);
+        mic[i] = audio_test_clip(v);
+    }
+    sim->played += FRAME;
+}
+
+static audio_aec_t* create_aec(int suppression_db) {
+    audio_aec_config_t config = {
+        .sample_rate = RATE,
+        .frame_samples = FRAME,
+        .max_suppression_db = suppression_db,
+    };
+    return audio_aec_create(&config);
+}
+
+/*
+ * 8 s far end only, then 3 s double talk, then 3 s far end only again:
+ * ERLE is measured over the last 2 s of each far-only stretch.
+ */
+static void test_echo_path(int suppression_db) {
+    const size_t frames = 14 * RATE / FRAME;
+    const size_t dt_start = 8 * RATE / FRAME;
+    const size_t dt_end = 11 * RATE / FRAME;
+    echo_sim_t sim;
+    audio_aec_t* aec = create_aec(suppression_db);
+    if (!echo_sim_init(&sim, 14) || !aec) {
+        CHECK(0, "echo path: create");
+        free(sim.history);
+        audio_aec_destroy(aec);
+        return;
+    }
+
+    short far[FRAME];
+    short talk[FRAME];
+    short mic[FRAME];
+    short out[FRAME];
+    float echo[FRAME];
+    uint32_t near_seed = 77;
+    double echo_power[2] = {0};
+    double out_power[2] = {0};
+    double talk_power = 0.0;
+    double talk_error = 0.0;
+    bool processed = true;
+    uint64_t flagged[3] = {0};          // Double talk frames counted at 2 s, at the start and end of double talk
+
+    for (size_t f = 0; f < frames; f++) {
+        bool double_talk = f >= dt_start && f < dt_end;
+        speech_like(&sim.seed, &sim.far_lp, f * FRAME, FAR_AMP, 3.0, far);
+        if (double_talk) {
+            speech_like(&near_seed, &sim.near_lp, f * FRAME, FAR_AMP, 4.3, talk);
+        }
+        echo_sim_step(&sim, far, double_talk ? talk : NULL, mic, echo);
+
+        uint32_t timestamp = (uint32_t)(f * 20);
+        audio_aec_feed_far(aec, far, FRAME, &timestamp);
+        processed = processed && audio_aec_process(aec, mic, out, FRAME) == 0;
+        if (f + 1 == 100 || f + 1 == dt_start || f + 1 == dt_end) {
+            audio_aec_stats_t stats;
+            audio_aec_get_stats(aec, &stats);
+            flagged[f + 1 == 100 ? 0 : (f + 1 == dt_start ? 1 : 2)] = stats.double_talk_frames;
+        }
+
+        /* Last 2 s before double talk and last 2 s of the run */
+        int window = f >= dt_start - 100 && f < dt_start ? 0 : (f >= frames - 100 ? 1 : -1);
+        for (size_t i = 0; i < FRAME; i++) {
+            if (window >= 0) {
+                echo_power[window] += (double)echo[i] * echo[i];
+                out_power[window] += (double)out[i] * out[i];
+            }
+            /* Skip the first 200 ms of double talk, while detection is still catching up */
+            if (double_talk && f >= dt_start + 10) {
+                double e = (double)out[i] - (double)talk[i];
+                talk_power += (double)talk[i] * talk[i];
+                talk_error += e * e;
+            }
+        }
+    }
+
+    audio_aec_stats_t stats;
+    audio_aec_get_stats(aec, &stats);
+    double erle = audio_test_db(echo_power[0] / out_power[0]);
+    double erle_after = audio_test_db(echo_power[1] / out_power[1]);
+    double talk_snr = audio_test_db(talk_power / talk_error);
+    const char* mode = suppression_db < 0 ? "linear" : "with suppression";
+
+    CHECK(processed, "%s: every frame processed", mode);
+    if (suppression_db < 0) {
+        CHECK(erle > 35.0, "%s: ERLE %.1f dB after 8 s of far end", mode, erle);
+        CHECK(erle_after > 35.0, "%s: ERLE %.1f dB after double talk", mode, erle_after);
+    } else {
+        CHECK(erle > 40.0, "%s: echo reduced by %.1f dB while only the far end talks", mode, erle);
+    }
+    CHECK(stats.erle_db > 10.0f, "%s: reported ERLE %.1f dB", mode, stats.erle_db);
+    CHECK(talk_snr > 10.0, "%s: near-end speech through double talk, %.1f dB above residual", mode, talk_snr);
+    /* Every detection holds for 60 ms, so occasional Geigel/residual hits cost a few frames each */
+    uint64_t far_only = flagged[1] - flagged[0];
+    uint64_t detected = flagged[2] - flagged[1];
+    CHECK(far_only < (dt_start - 100) / 2, "%s: double talk flagged in %llu of %zu converged far-only frames",
+          mode, (unsigned long long)far_only, dt_start - 100);
+    CHECK(detected * 10 >= (dt_end - dt_start) * 9, "%s: double talk flagged in %llu of %zu double talk frames",
+          mode, (unsigned long long)detected, dt_end - dt_start);
+    CHECK(stats.resets == 0, "%s: filter never reset (%llu)", mode, (unsigned long long)stats.resets);
+    CHECK(stats.far_active_frames + 5 >= frames, "%s: %llu of %zu frames had a reference", mode,
+          (unsigned long long)stats.far_active_frames, frames);
+
+    free(sim.history);
+    audio_aec_destroy(aec);
+}
+
+/* Without a reference the near signal passes through untouched in level */
+static void test_no_reference(void) {
+    audio_aec_t* aec = create_aec(0);
+    if (!aec) {
+        CHECK(0, "no reference: create");
+        return;
+    }
+    uint32_t seed = 5;
+    float lp = 0.0f;
+    short near[FRAME];
+    short out[FRAME];
+    double in_power = 0.0;
+    double out_power = 0.0;
+    for (size_t f = 0; f < 50; f++) {
+        speech_like(&seed, &lp, f * FRAME, FAR_AMP, 4.0, near);
+        audio_aec_process(aec, near, out, FRAME);
+        in_power += audio_test_power(near, FRAME, 1);
+        out_power += audio_test_power(out, FRAME, 1);
+    }
+    double change = audio_test_db(out_power / in_power);
+    CHECK(fabs(change) < 0.5, "no reference: level changed by %.2f dB", change);
+
+    uint32_t timestamp = 0;
+    CHECK(!audio_aec_get_far_timestamp(aec, &timestamp), "no reference: no far timestamp");
+    audio_aec_stats_t stats;
+    audio_aec_get_stats(aec, &stats);
+    CHECK(stats.far_active_frames == 0, "no reference: no far-active frames");
+
+    short odd[FRAME + 1] = {0};
+    CHECK(audio_aec_process(aec, odd, odd, FRAME + 1) == -1, "wrong frame size rejected");
+    audio_aec_destroy(aec);
+
+    audio_aec_config_t bad = { .sample_rate = RATE, .frame_samples = 100 };
+    CHECK(audio_aec_create(&bad) == NULL, "frame size that is not a multiple of 16 rejected");
+}
+
+/* The reported far timestamp is the stream time of the reference aligned with the frame */
+static void test_far_timestamp(void) {
+    audio_aec_t* aec = create_aec(0);
+    if (!aec) {
+        CHECK(0, "far timestamp: create");
+        return;
+    }
+    short far[FRAME];
+    short near[FRAME] = {0};
+    short out[FRAME];
+    audio_test_sine(far, FRAME, 1, 500.0, RATE, 1000.0);
+
+    bool aligned = true;
+    bool seen = false;
+    for (size_t f = 0; f < 40; f++) {
+        uint32_t timestamp = 100000 + (uint32_t)(f * 20);
+        audio_aec_feed_far(aec, far, FRAME, &timestamp);
+        audio_aec_process(aec, near, out, FRAME);
+        uint32_t aligned_ts = 0;
+        if (audio_aec_get_far_timestamp(aec, &aligned_ts)) {
+            seen = true;
+            /* The default 60 ms device latency: frame f carries the reference played 60 ms earlier */
+            int64_t expect = 100000 + (int64_t)f * 20 - 60;
+            if (llabs((long long)((int64_t)aligned_ts - expect)) > 1) {
+                aligned = false;
+            }
+        }
+    }
+    CHECK(seen, "far timestamp reported once the latency has elapsed");
+    CHECK(aligned, "far timestamp trails the played stream by the configured latency");
+
+    /* Playback stops: the 60 ms still queued drains, then the timestamp goes away */
+    for (int f = 0; f < 4; f++) {
+        audio_aec_process(aec, near, out, FRAME);
+    }
+    uint32_t timestamp = 0;
+    CHECK(!audio_aec_get_far_timestamp(aec, &timestamp), "no far timestamp after playback stops");
+    audio_aec_stats_t stats;
+    audio_aec_get_stats(aec, &stats);
+    CHECK(stats.far_realigns >= 1, "underrun counted as a re-alignment");
+
+    audio_aec_reset(aec);
+    audio_aec_get_stats(aec, &stats);
+    CHECK(stats.erle_db == 0.0f, "reset clears the ERLE estimate");
+    audio_aec_destroy(aec);
+}
+
+int main(void) {
+    printf("audio_aec offline tests\n");
+    test_echo_path(-1);
+    test_echo_path(0);
+    test_no_reference();
+    test_far_timestamp();
+    return audio_test_finish("audio_aec");
+}
@@ -0,0 +1,243 @@
+/**
+ * Offline tests for audio_agc
+ *
+ * Tones at fixed levels stand in for talkers near and far from the
+ * microphone. Measured: convergence to the target level from below and
+ * above, the gain and cut limits, the gain held through frames under the
+ * noise gate, the peak limit acting on the first loud frame, no steps in
+ * the gain inside a frame, and interleaved stereo.
+ */
+
+#include "../audio_agc.h"
+#include "audio_test_signal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define RATE            16000
+#define FRAME           320                   // 20 ms
+#define TARGET_DBFS     (-18)
+#define TONE_HZ         440.0
+
+static audio_agc_t* create_agc(int channels) {
+    audio_agc_config_t config = {
+        .sample_rate = RATE,
+        .frame_samples = (size_t)FRAME * (size_t)channels,
+        .channels = channels,
+    };
+    return audio_agc_create(&config);
+}
+
+/* Sine amplitude for an RMS level in dBFS */
+static double amp_for_dbfs(double dbfs) {
+    return 32768.0 * pow(10.0, dbfs / 20.0) * sqrt(2.0);
+}
+
+static double level_dbfs(const short* x, size_t frames, int stride) {
+    return audio_test_db(audio_test_power(x, frames, stride) / (32768.0 * 32768.0));
+}
+
+/* Run `seconds` of a tone at `in_dbfs`; returns the output level of the last 200 ms */
+static double run_tone(audio_agc_t* agc, double in_dbfs, double seconds, size_t* start) {
+    short in[FRAME];
+    short out[FRAME];
+    double amp = amp_for_dbfs(in_dbfs);
+    size_t frames = (size_t)(seconds * RATE / FRAME);
+    double power = 0.0;
+    for (size_t f = 0; f < frames; f++) {
+        for (size_t i = 0; i < FRAME; i++) {
+            in[i] = audio_test_clip(amp * sin(2.0 * M_PI * TONE_HZ * (double)(*start + i) / RATE));
+        }
+        *start += FRAME;
+        audio_agc_process(agc, in, out, FRAME);
+        if (f + 10 >= frames) {
+            power += audio_test_power(out, FRAME, 1);
+        }
+    }
+    return audio_test_db(power / 10.0 / (32768.0 * 32768.0));
+}
+
+static void test_levels(void) {
+    static const struct {
+        double in_dbfs;
+        double expect_dbfs;
+        const char* what;
+    } cases[] = {
+        { -30.0, TARGET_DBFS, "quiet talker raised" },
+        { -8.0, TARGET_DBFS, "loud talker turned down" },
+        { -45.0, -45.0 + 24.0, "far talker limited to +24 dB" },
+        { -3.0, -3.0 - 12.0, "very loud talker limited to -12 dB" },
+    };
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        audio_agc_t* agc = create_agc(1);
+        if (!agc) {
+            CHECK(0, "levels: create");
+            return;
+        }
+        size_t t = 0;
+        double level = run_tone(agc, cases[c].in_dbfs, 4.0, &t);
+        CHECK(fabs(level - cases[c].expect_dbfs) < 0.5, "%s: %.0f dBFS in, %.2f dBFS out", cases[c].what,
+              cases[c].in_dbfs, level);
+        audio_agc_destroy(agc);
+    }
+}
+
+/* Attack is fast, release slow */
+static void test_timing(void) {
+    audio_agc_t* agc = create_agc(1);
+    if (!agc) {
+        CHECK(0, "timing: create");
+        return;
+    }
+    size_t t = 0;
+    run_tone(agc, -30.0, 4.0, &t);
+    /* Jump up 20 dB: within 100 ms the level is back near the target */
+    double after_jump = run_tone(agc, -10.0, 0.3, &t);
+    CHECK(fabs(after_jump - TARGET_DBFS) < 1.0, "attack: 20 dB jump corrected within 300 ms (%.2f dBFS)",
+          after_jump);
+    /* Drop 20 dB: 300 ms later the gain is still on its way up */
+    double after_drop = run_tone(agc, -30.0, 0.3, &t);
+    CHECK(after_drop < TARGET_DBFS - 3.0, "release: gain rises slowly after a 20 dB drop (%.2f dBFS)",
+          after_drop);
+    audio_agc_destroy(agc);
+}
+
+/* Below the noise gate the gain holds, so pauses do not pump the background up */
+static void test_gate(void) {
+    audio_agc_t* agc = create_agc(1);
+    if (!agc) {
+        CHECK(0, "gate: create");
+        return;
+    }
+    size_t t = 0;
+    run_tone(agc, -8.0, 2.0, &t);
+    audio_agc_stats_t before;
+    audio_agc_get_stats(agc, &before);
+    run_tone(agc, -60.0, 2.0, &t);
+    audio_agc_stats_t after;
+    audio_agc_get_stats(agc, &after);
+    CHECK(after.gain_q12 == before.gain_q12, "gain held at %d through 2 s under the gate", after.gain_q12);
+    CHECK(after.gated_frames - before.gated_frames == 100, "%llu gated frames counted",
+          (unsigned long long)(after.gated_frames - before.gated_frames));
+
+    audio_agc_reset(agc);
+    audio_agc_get_stats(agc, &after);
+    CHECK(after.gain_q12 == 4096, "reset returns to unity gain");
+    audio_agc_destroy(agc);
+}
+
+/* After a quiet stretch the gain is high; a loud frame must not clip */
+static void test_peak_limit(void) {
+    audio_agc_t* agc = create_agc(1);
+    if (!agc) {
+        CHECK(0, "peak limit: create");
+        return;
+    }
+    size_t t = 0;
+    run_tone(agc, -40.0, 4.0, &t);
+    audio_agc_stats_t before;
+    audio_agc_get_stats(agc, &before);
+
+    short in[FRAME];
+    short out[FRAME];
+    audio_test_sine(in, FRAME, 1, TONE_HZ, RATE, 30000.0);
+    audio_agc_process(agc, in, out, FRAME);
+    int peak = 0;
+    for (size_t i = 0; i < FRAME; i++) {
+        peak = abs(out[i]) > peak ? abs(out[i]) : peak;
+    }
+    audio_agc_stats_t after;
+    audio_agc_get_stats(agc, &after);
+    CHECK(before.gain_q12 > 4096 * 8, "gain %d after quiet speech", before.gain_q12);
+    CHECK(peak <= 32000, "first loud frame peaks at %d, not clipped", peak);
+    CHECK(after.limited_frames == before.limited_frames + 1, "peak limit counted");
+
+    /* Full-scale -32768 input at unity gain stays in range */
+    audio_agc_reset(agc);
+    for (size_t i = 0; i < FRAME; i++) {
+        in[i] = i % 2 ? -32768 : 32767;
+    }
+    audio_agc_process(agc, in, out, FRAME);
+    bool sign_kept = true;
+    for (size_t i = 0; i < FRAME; i++) {
+        sign_kept = sign_kept && (i % 2 ? out[i] < 0 : out[i] > 0);
+    }
+    CHECK(sign_kept, "full-scale input does not wrap");
+    audio_agc_destroy(agc);
+}
+
+/* The gain moves linearly across a frame: on a constant input the output never steps */
+static void test_ramp(void) {
+    audio_agc_t* agc = create_agc(1);
+    if (!agc) {
+        CHECK(0, "ramp: create");
+        return;
+    }
+    short in[FRAME];
+    short out[FRAME];
+    for (size_t i = 0; i < FRAME; i++) {
+        in[i] = 1000;
+    }
+    int worst = 0;
+    int last = -1;
+    for (int f = 0; f < 50; f++) {
+        audio_agc_process(agc, in, out, FRAME);
+        for (size_t i = 0; i < FRAME; i++) {
+            if (last >= 0) {
+                int step = abs(out[i] - last);
+                worst = step > worst ? step : worst;
+            }
+            last = out[i];
+        }
+    }
+    CHECK(worst <= 2, "constant input: largest sample-to-sample step %d", worst);
+
+    short copy[FRAME];
+    audio_agc_reset(agc);
+    audio_agc_process(agc, in, out, FRAME);
+    audio_agc_reset(agc);
+    memcpy(copy, in, sizeof(copy));
+    audio_agc_process(agc, copy, copy, FRAME);
+    CHECK(memcmp(copy, out, sizeof(out)) == 0, "in place matches out of place");
+    audio_agc_destroy(agc);
+}
+
+/* One gain for both channels of an interleaved frame */
+static void test_stereo(void) {
+    audio_agc_t* agc = create_agc(2);
+    if (!agc) {
+        CHECK(0, "stereo: create");
+        return;
+    }
+    short in[FRAME * 2];
+    short out[FRAME * 2];
+    double amp = amp_for_dbfs(-30.0);
+    for (int f = 0; f < 200; f++) {
+        for (size_t i = 0; i < FRAME; i++) {
+            double v = sin(2.0 * M_PI * TONE_HZ * (double)(f * FRAME + i) / RATE);
+            in[2 * i] = audio_test_clip(amp * v);
+            in[2 * i + 1] = audio_test_clip(amp * v / 2.0);
+        }
+        audio_agc_process(agc, in, out, FRAME * 2);
+    }
+    double left = level_dbfs(out, FRAME, 2);
+    double right = level_dbfs(out + 1, FRAME, 2);
+    CHECK(fabs((left - right) - 20.0 * log10(2.0)) < 0.1, "stereo: channel balance kept (%.2f / %.2f dBFS)",
+          left, right);
+    audio_agc_destroy(agc);
+
+    audio_agc_config_t bad = { .sample_rate = 0, .frame_samples = FRAME };
+    CHECK(audio_agc_create(&bad) == NULL, "zero sample rate rejected");
+    CHECK(audio_agc_process(NULL, in, out, FRAME) == -1, "NULL AGC rejected");
+}
+
+int main(void) {
+    printf("audio_agc offline tests\n");
+    test_levels();
+    test_timing();
+    test_gate();
+    test_peak_limit();
+    test_ramp();
+    test_stereo();
+    return audio_test_finish("audio_agc");
+}
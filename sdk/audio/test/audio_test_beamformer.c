@@ -0,0 +1,279 @@
+/**
+ * Offline tests for audio_beamformer
+ *
+ * Plane waves are synthesised at every microphone with the exact
+ * (fractional) arrival time, from tones evaluated analytically, plus
+ * independent noise per microphone for a diffuse field. Measured: unity
+ * gain towards the look direction, attenuation of an off-axis source, the
+ * 10*log10(N) gain against uncorrelated noise, beam selection following the
+ * talker only after hold_ms, a switch without a click, full-scale input
+ * without wrap-around, and a linear array.
+ */
+
+#include "../audio_beamformer.h"
+#include "audio_test_signal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define RATE            16000
+#define FRAME           320                   // 20 ms per channel
+#define MICS            4
+#define RADIUS_MM       32.0f
+#define SPEED           343.0
+
+typedef struct {
+    double azimuth_deg;
+    double freq;
+    double amp;
+} source_t;
+
+/* One interleaved frame: the sources as plane waves plus independent noise of `noise_amp` per microphone */
+static void scene_frame(const audio_beamformer_config_t* config, const source_t* sources, int count,
+                        double noise_amp, uint32_t* seed, size_t index, short* out) {
+    for (size_t n = 0; n < FRAME; n++) {
+        for (int m = 0; m < config->channels; m++) {
+            double v = noise_amp > 0.0 ? audio_test_noise(seed, noise_amp) : 0.0;
+            for (int s = 0; s < count; s++) {
+                double a = sources[s].azimuth_deg * M_PI / 180.0;
+                /* Microphones farther along the arrival direction hear the wave earlier */
+                double lead = (config->mic_x_mm[m] * cos(a) + config->mic_y_mm[m] * sin(a)) / 1000.0 / SPEED;
+                double t = (double)(index * FRAME + n) / RATE + lead;
+                v += sources[s].amp * sin(2.0 * M_PI * sources[s].freq * t);
+            }
+            out[n * (size_t)config->channels + (size_t)m] = audio_test_clip(v);
+        }
+    }
+}
+
+static audio_beamformer_config_t circular_config(int beams, float look_deg) {
+    audio_beamformer_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.sample_rate = RATE;
+    config.frame_samples = FRAME * MICS;
+    config.beams = beams;
+    config.look_azimuth_deg = look_deg;
+    audio_beamformer_circular_array(&config, MICS, RADIUS_MM);
+    return config;
+}
+
+/* Run `frames` frames of a scene; the tone fit and power are over the last 10 frames */
+static void run_scene(audio_beamformer_t* bf, const audio_beamformer_config_t* config, const source_t* sources,
+                      int count, double noise_amp, size_t frames, size_t* index, double fit_freq,
+                      double* amp, double* power) {
+    short in[FRAME * MICS];
+    short out[FRAME * 10];
+    uint32_t seed = 1234 + (uint32_t)*index;
+    for (size_t f = 0; f < frames; f++) {
+        scene_frame(config, sources, count, noise_amp, &seed, (*index)++, in);
+        audio_beamformer_process(bf, in, out + (f + 10 >= frames ? (f + 10 - frames) * FRAME : 0), FRAME * MICS);
+    }
+    if (amp) {
+        audio_test_tone_snr(out, FRAME * 10, 1, fit_freq, RATE, amp);
+    }
+    if (power) {
+        *power = audio_test_power(out, FRAME * 10, 1);
+    }
+}
+
+/* One fixed beam: on-axis at unity gain, off-axis attenuated */
+static void test_fixed_beam(void) {
+    audio_beamformer_config_t config = circular_config(1, 0.0f);
+    audio_beamformer_t* bf = audio_beamformer_create(&config);
+    if (!bf) {
+        CHECK(0, "fixed beam: create");
+        return;
+    }
+    static const double freqs[] = { 500.0, 1000.0, 2000.0, 3000.0 };
+    for (size_t i = 0; i < sizeof(freqs) / sizeof(freqs[0]); i++) {
+        source_t on = { 0.0, freqs[i], 10000.0 };
+        size_t index = 0;
+        double amp = 0.0;
+        audio_beamformer_reset(bf);
+        run_scene(bf, &config, &on, 1, 0.0, 20, &index, freqs[i], &amp, NULL);
+        double gain_db = 20.0 * log10(amp / on.amp);
+        CHECK(fabs(gain_db) < 0.5, "on-axis %.0f Hz: %.2f dB", freqs[i], gain_db);
+    }
+
+    /* 4 kHz from the back: the wavelength is close to the aperture, so the array rejects it */
+    source_t off = { 180.0, 4000.0, 10000.0 };
+    size_t index = 0;
+    double amp = 0.0;
+    audio_beamformer_reset(bf);
+    run_scene(bf, &config, &off, 1, 0.0, 20, &index, off.freq, &amp, NULL);
+    double off_db = 20.0 * log10(amp / off.amp);
+    CHECK(off_db < -6.0, "off-axis 4 kHz from 180 degrees: %.1f dB", off_db);
+
+    audio_beamformer_stats_t stats;
+    audio_beamformer_get_stats(bf, &stats);
+    CHECK(stats.beam == 0 && stats.switches == 0 && stats.max_delay_samples == 2,
+          "one beam never switches, max delay %d samples", stats.max_delay_samples);
+    audio_beamformer_destroy(bf);
+}
+
+/* Independent noise at every microphone averages down by 1/N in power */
+static void test_diffuse_noise(void) {
+    audio_beamformer_config_t config = circular_config(1, 0.0f);
+    audio_beamformer_t* bf = audio_beamformer_create(&config);
+    if (!bf) {
+        CHECK(0, "diffuse noise: create");
+        return;
+    }
+    size_t index = 0;
+    double power = 0.0;
+    const double noise_amp = 3000.0;
+    run_scene(bf, &config, NULL, 0, noise_amp, 20, &index, 0.0, NULL, &power);
+    double mic_power = noise_amp * noise_amp / 3.0;
+    double gain_db = audio_test_db(mic_power / power);
+    double expect = 10.0 * log10((double)MICS);
+    CHECK(gain_db > expect - 1.5, "uncorrelated noise down %.1f dB (10*log10(%d) = %.1f dB)", gain_db, MICS,
+          expect);
+    audio_beamformer_destroy(bf);
+}
+
+/* 8 beams: the output follows the talker, but only after hold_ms, and the switch does not click */
+static void test_steering(void) {
+    audio_beamformer_config_t config = circular_config(8, 0.0f);
+    audio_beamformer_t* bf = audio_beamformer_create(&config);
+    if (!bf) {
+        CHECK(0, "steering: create");
+        return;
+    }
+    source_t talker = { 90.0, 3000.0, 8000.0 };
+    size_t index = 0;
+    run_scene(bf, &config, &talker, 1, 200.0, 50, &index, talker.freq, NULL, NULL);
+    audio_beamformer_stats_t stats;
+    audio_beamformer_get_stats(bf, &stats);
+    CHECK(stats.azimuth_deg == 90.0f, "talker at 90 degrees: beam %d at %.0f degrees", stats.beam,
+          stats.azimuth_deg);
+
+    /* The talker moves to 225 degrees; count the frames until the beam follows */
+    talker.azimuth_deg = 225.0;
+    short in[FRAME * MICS];
+    short out[FRAME];
+    uint32_t seed = 77;
+    uint64_t switches = stats.switches;
+    int moved_after = -1;
+    int worst_step = 0;
+    int last = 0;
+    for (int f = 0; f < 50; f++) {
+        scene_frame(&config, &talker, 1, 0.0, &seed, index++, in);
+        audio_beamformer_process(bf, in, out, FRAME * MICS);
+        for (size_t n = 0; n < FRAME; n++) {
+            int step = abs(out[n] - last);
+            worst_step = f > 0 && step > worst_step ? step : worst_step;
+            last = out[n];
+        }
+        audio_beamformer_get_stats(bf, &stats);
+        if (moved_after < 0 && stats.switches != switches) {
+            moved_after = f + 1;
+        }
+    }
+    CHECK(stats.azimuth_deg == 225.0f, "talker at 225 degrees: beam at %.0f degrees", stats.azimuth_deg);
+    CHECK(moved_after * FRAME * 1000 / RATE >= 200, "switch only after the 200 ms hold (%d ms)",
+          moved_after * FRAME * 1000 / RATE);
+    CHECK(stats.switches >= switches + 1, "%llu switches counted", (unsigned long long)stats.switches);
+    /* A 3 kHz tone of amplitude A moves at most 2*pi*3000/16000*A per sample */
+    int max_step = (int)(2.0 * M_PI * 3000.0 / RATE * talker.amp) + 64;
+    CHECK(worst_step <= max_step, "no click across the switch: largest step %d (tone up to %d)",
+          worst_step, max_step);
+
+    /* Reset keeps the beam */
+    audio_beamformer_reset(bf);
+    audio_beamformer_get_stats(bf, &stats);
+    CHECK(stats.azimuth_deg == 225.0f, "reset keeps the current beam");
+    audio_beamformer_destroy(bf);
+}
+
+/* Full-scale broadside input: the normalised taps must not overflow */
+static void test_full_scale(void) {
+    audio_beamformer_config_t config = circular_config(1, 0.0f);
+    audio_beamformer_t* bf = audio_beamformer_create(&config);
+    if (!bf) {
+        CHECK(0, "full scale: create");
+        return;
+    }
+    short in[FRAME * MICS];
+    short out[FRAME];
+    bool kept = true;
+    for (int f = 0; f < 5; f++) {
+        for (size_t n = 0; n < FRAME; n++) {
+            short v = (n / 16) % 2 ? -32768 : 32767;
+            for (int m = 0; m < MICS; m++) {
+                in[n * MICS + (size_t)m] = v;
+            }
+        }
+        audio_beamformer_process(bf, in, out, FRAME * MICS);
+        /* Away from the edges of each half period the output must keep the input's sign */
+        for (size_t n = 8; n < FRAME; n++) {
+            size_t phase = n % 16;
+            if (f > 0 && phase >= 6 && phase <= 10) {
+                short v = (n / 16) % 2 ? -32768 : 32767;
+                kept = kept && (int)out[n] * v > 0;
+            }
+        }
+    }
+    CHECK(kept, "full-scale square wave does not wrap");
+    audio_beamformer_destroy(bf);
+}
+
+/* A linear array spreads its beams over 180 degrees */
+static void test_linear(void) {
+    audio_beamformer_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.sample_rate = RATE;
+    config.frame_samples = FRAME * 2;
+    config.beams = 3;
+    audio_beamformer_linear_array(&config, 2, 60.0f);
+    audio_beamformer_t* bf = audio_beamformer_create(&config);
+    if (!bf) {
+        CHECK(0, "linear: create");
+        return;
+    }
+    source_t talker = { 180.0, 2000.0, 8000.0 };
+    short in[FRAME * 2];
+    short out[FRAME];
+    uint32_t seed = 5;
+    for (size_t f = 0; f < 50; f++) {
+        scene_frame(&config, &talker, 1, 0.0, &seed, f, in);
+        audio_beamformer_process(bf, in, out, FRAME * 2);
+    }
+    audio_beamformer_stats_t stats;
+    audio_beamformer_get_stats(bf, &stats);
+    CHECK(stats.azimuth_deg == 180.0f, "endfire talker at 180 degrees: beam at %.0f degrees (0/90/180)",
+          stats.azimuth_deg);
+    CHECK(stats.max_delay_samples == 2, "60 mm aperture: %d samples max delay", stats.max_delay_samples);
+    audio_beamformer_destroy(bf);
+}
+
+static void test_create(void) {
+    audio_beamformer_config_t config = circular_config(1, 0.0f);
+    config.channels = 1;
+    CHECK(audio_beamformer_create(&config) == NULL, "one microphone rejected");
+    config = circular_config(1, 0.0f);
+    config.frame_samples = FRAME * MICS + 1;
+    CHECK(audio_beamformer_create(&config) == NULL, "frame not a multiple of the channels rejected");
+    config = circular_config(AUDIO_BEAMFORMER_MAX_BEAMS + 1, 0.0f);
+    CHECK(audio_beamformer_create(&config) == NULL, "too many beams rejected");
+
+    config = circular_config(1, 0.0f);
+    audio_beamformer_t* bf = audio_beamformer_create(&config);
+    short in[FRAME * MICS] = {0};
+    short out[FRAME];
+    CHECK(bf && audio_beamformer_process(bf, in, out, FRAME) == -1, "wrong frame size rejected");
+    audio_stage_t stage = audio_beamformer_stage(bf);
+    CHECK(stage.output_channels == 1 && !(stage.flags & AUDIO_STAGE_IN_PLACE),
+          "stage outputs one channel, out of place");
+    audio_beamformer_destroy(bf);
+}
+
+int main(void) {
+    printf("audio_beamformer offline tests\n");
+    test_fixed_beam();
+    test_diffuse_noise();
+    test_steering();
+    test_full_scale();
+    test_linear();
+    test_create();
+    return audio_test_finish("audio_beamformer");
+}
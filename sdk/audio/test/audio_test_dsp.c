@@ -0,0 +1,284 @@
+/**
+ * Offline tests for audio_dsp
+ *
+ * audio_dsp.c is compiled a second time into this file with
+ * AUDIO_DSP_SCALAR set and every public function renamed to ref_*, giving
+ * the scalar reference next to the backend the build selected (SSE2 on
+ * x86-64, NEON on ARM). Every kernel must match the reference
+ * sample-for-sample over random lengths, unaligned buffers, and the int16
+ * saturation edges: full-scale samples, -32768, gains at and past the Q12
+ * limit, mixes that overflow, and floats outside [-1, 1].
+ */
+
+#define AUDIO_DSP_SCALAR 1
+#define audio_dsp_backend       ref_backend
+#define audio_dsp_gain          ref_gain
+#define audio_dsp_gain_ramp     ref_gain_ramp
+#define audio_dsp_mix           ref_mix
+#define audio_dsp_s16_to_float  ref_s16_to_float
+#define audio_dsp_float_to_s16  ref_float_to_s16
+#define audio_dsp_stereo_to_mono ref_stereo_to_mono
+#define audio_dsp_mono_to_stereo ref_mono_to_stereo
+#define audio_dsp_deinterleave  ref_deinterleave
+#define audio_dsp_sum_squares   ref_sum_squares
+#define audio_dsp_rms           ref_rms
+#define audio_dsp_peak          ref_peak
+#define audio_dsp_level         ref_level
+#include "../audio_dsp.c"
+#undef audio_dsp_backend
+#undef audio_dsp_gain
+#undef audio_dsp_gain_ramp
+#undef audio_dsp_mix
+#undef audio_dsp_s16_to_float
+#undef audio_dsp_float_to_s16
+#undef audio_dsp_stereo_to_mono
+#undef audio_dsp_mono_to_stereo
+#undef audio_dsp_deinterleave
+#undef audio_dsp_sum_squares
+#undef audio_dsp_rms
+#undef audio_dsp_peak
+#undef audio_dsp_level
+#undef AUDIO_DSP_H
+#include "../audio_dsp.h"
+
+#include "audio_test_signal.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#define MAX_LEN         67                    // Several full vectors plus every tail length
+#define MAX_OFFSET      3                     // Unaligned starts
+#define EDGE_LEN        4096                  // Long enough to overflow 32-bit accumulators
+
+static uint32_t seed = 4242;
+
+/* Random samples with the saturation edges mixed in */
+static short edge_sample(void) {
+    static const short edges[] = { 32767, -32768, -32767, 32766, 0, 1, -1 };
+    uint32_t r = audio_test_rand(&seed);
+    if (r % 4 == 0) {
+        return edges[(r >> 4) % (sizeof(edges) / sizeof(edges[0]))];
+    }
+    return (short)(audio_test_rand(&seed) & 0xffff);
+}
+
+static void fill(short* pcm, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        pcm[i] = edge_sample();
+    }
+}
+
+static void test_gain(void) {
+    static const float gains[] = { 0.0f, 0.5f, 1.0f, 1.0001f, 2.0f, 7.99f, 8.0f, 100.0f, -1.0f, 0.000122f };
+    short in[MAX_LEN + MAX_OFFSET];
+    short expect[MAX_LEN + MAX_OFFSET];
+    short got[MAX_LEN + MAX_OFFSET];
+    bool same = true;
+    bool ramp_same = true;
+    for (size_t g = 0; g < sizeof(gains) / sizeof(gains[0]); g++) {
+        for (size_t len = 0; len <= MAX_LEN; len++) {
+            size_t off = len % (MAX_OFFSET + 1);
+            fill(in, len + off);
+            memcpy(expect, in, sizeof(in));
+            memcpy(got, in, sizeof(in));
+            ref_gain(expect + off, len, gains[g]);
+            audio_dsp_gain(got + off, len, gains[g]);
+            same = same && memcmp(expect, got, sizeof(in)) == 0;
+
+            float end = gains[(g + 1 + len) % (sizeof(gains) / sizeof(gains[0]))];
+            memcpy(expect, in, sizeof(in));
+            memcpy(got, in, sizeof(in));
+            ref_gain_ramp(expect + off, len, gains[g], end);
+            audio_dsp_gain_ramp(got + off, len, gains[g], end);
+            ramp_same = ramp_same && memcmp(expect, got, sizeof(in)) == 0;
+        }
+    }
+    CHECK(same, "gain: 0 .. past the Q12 limit matches the scalar reference");
+    CHECK(ramp_same, "gain ramp: up and down ramps match the scalar reference");
+
+    short full[16];
+    for (int i = 0; i < 16; i++) {
+        full[i] = i % 2 ? -32768 : 32767;
+    }
+    audio_dsp_gain(full, 16, 2.0f);
+    CHECK(full[0] == 32767 && full[1] == -32768 && full[14] == 32767 && full[15] == -32768,
+          "gain: x2 on full scale saturates (%d, %d)", full[0], full[1]);
+}
+
+static void test_mix(void) {
+    short dst[MAX_LEN + MAX_OFFSET];
+    short src[MAX_LEN + MAX_OFFSET];
+    short expect[MAX_LEN + MAX_OFFSET];
+    bool same = true;
+    for (size_t len = 0; len <= MAX_LEN; len++) {
+        size_t off = len % (MAX_OFFSET + 1);
+        fill(dst, len + off);
+        fill(src, len + off);
+        memcpy(expect, dst, sizeof(dst));
+        ref_mix(expect + off, src, len);
+        audio_dsp_mix(dst + off, src, len);
+        same = same && memcmp(expect, dst, sizeof(dst)) == 0;
+    }
+    CHECK(same, "mix: overflowing sums match the scalar reference");
+
+    short a[16];
+    short b[16];
+    for (int i = 0; i < 16; i++) {
+        a[i] = i % 2 ? -30000 : 30000;
+        b[i] = i % 2 ? -30000 : 30000;
+    }
+    audio_dsp_mix(a, b, 16);
+    CHECK(a[0] == 32767 && a[1] == -32768 && a[14] == 32767 && a[15] == -32768,
+          "mix: overflow saturates (%d, %d)", a[0], a[1]);
+}
+
+static void test_float(void) {
+    /* Full scale, out of range, half-way rounding points and signed zero */
+    static const float edges[] = {
+        1.0f, -1.0f, 2.0f, -2.0f, 1e9f, -1e9f, 32767.0f / 32768.0f, -32767.0f / 32768.0f,
+        0.5f / 32768.0f, -0.5f / 32768.0f, 1.5f / 32768.0f, -1.5f / 32768.0f, 0.0f, -0.0f,
+        32766.5f / 32768.0f, -32767.5f / 32768.0f, 0.49f / 32768.0f, -0.51f / 32768.0f,
+    };
+    const size_t n_edges = sizeof(edges) / sizeof(edges[0]);
+    float in[MAX_LEN + MAX_OFFSET];
+    short expect[MAX_LEN + MAX_OFFSET];
+    short got[MAX_LEN + MAX_OFFSET];
+    float fexpect[MAX_LEN + MAX_OFFSET];
+    float fgot[MAX_LEN + MAX_OFFSET];
+    short pcm[MAX_LEN + MAX_OFFSET];
+    bool to_s16 = true;
+    bool to_float = true;
+    for (size_t len = 0; len <= MAX_LEN; len++) {
+        size_t off = len % (MAX_OFFSET + 1);
+        for (size_t i = 0; i < len + off; i++) {
+            in[i] = i % 3 == 0 ? edges[(i + len) % n_edges] : (float)audio_test_noise(&seed, 1.2);
+        }
+        memset(expect, 0, sizeof(expect));
+        memset(got, 0, sizeof(got));
+        ref_float_to_s16(in + off, expect + off, len);
+        audio_dsp_float_to_s16(in + off, got + off, len);
+        to_s16 = to_s16 && memcmp(expect, got, sizeof(got)) == 0;
+
+        fill(pcm, len + off);
+        memset(fexpect, 0, sizeof(fexpect));
+        memset(fgot, 0, sizeof(fgot));
+        ref_s16_to_float(pcm + off, fexpect + off, len);
+        audio_dsp_s16_to_float(pcm + off, fgot + off, len);
+        to_float = to_float && memcmp(fexpect, fgot, sizeof(fgot)) == 0;
+    }
+    CHECK(to_s16, "float_to_s16: clamping and rounding match the scalar reference");
+    CHECK(to_float, "s16_to_float: matches the scalar reference");
+
+    float full[8] = { 1.0f, -1.0f, 3.0f, -3.0f, 0.5f / 32768.0f, -0.5f / 32768.0f, 0.0f, -0.0f };
+    short out[8];
+    audio_dsp_float_to_s16(full, out, 8);
+    CHECK(out[0] == 32767 && out[1] == -32768 && out[2] == 32767 && out[3] == -32768 &&
+          out[4] == 1 && out[5] == -1 && out[6] == 0 && out[7] == 0,
+          "float_to_s16: +-1 and beyond clamp, halves round away from zero");
+}
+
+static void test_channels(void) {
+    short in[(MAX_LEN + MAX_OFFSET) * 6];
+    short expect[(MAX_LEN + MAX_OFFSET) * 2];
+    short got[(MAX_LEN + MAX_OFFSET) * 2];
+    bool down = true;
+    bool up = true;
+    for (size_t frames = 0; frames <= MAX_LEN; frames++) {
+        size_t off = frames % (MAX_OFFSET + 1);
+        fill(in, (frames + off) * 2);
+        memset(expect, 0, sizeof(expect));
+        memset(got, 0, sizeof(got));
+        ref_stereo_to_mono(in + off, expect + off, frames);
+        audio_dsp_stereo_to_mono(in + off, got + off, frames);
+        down = down && memcmp(expect, got, sizeof(got)) == 0;
+
+        memset(expect, 0, sizeof(expect));
+        memset(got, 0, sizeof(got));
+        ref_mono_to_stereo(in + off, expect + off, frames);
+        audio_dsp_mono_to_stereo(in + off, got + off, frames);
+        up = up && memcmp(expect, got, sizeof(got)) == 0;
+    }
+    CHECK(down, "stereo_to_mono: matches the scalar reference");
+    CHECK(up, "mono_to_stereo: matches the scalar reference");
+
+    short pairs[16];
+    short mono[8];
+    for (int i = 0; i < 16; i++) {
+        pairs[i] = i < 8 ? -32768 : 32767;
+    }
+    audio_dsp_stereo_to_mono(pairs, mono, 8);
+    CHECK(mono[0] == -32768 && mono[7] == 32767, "stereo_to_mono: full-scale pairs keep full scale (%d, %d)",
+          mono[0], mono[7]);
+
+    static const size_t channel_counts[] = { 1, 2, 3, 4, 6 };
+    bool split = true;
+    for (size_t c = 0; c < sizeof(channel_counts) / sizeof(channel_counts[0]); c++) {
+        size_t channels = channel_counts[c];
+        short ref_planes[6][MAX_LEN];
+        short planes[6][MAX_LEN];
+        short* ref_out[6];
+        short* out[6];
+        for (size_t ch = 0; ch < 6; ch++) {
+            ref_out[ch] = ref_planes[ch];
+            out[ch] = planes[ch];
+        }
+        for (size_t frames = 0; frames <= MAX_LEN; frames++) {
+            fill(in, frames * channels);
+            memset(ref_planes, 0, sizeof(ref_planes));
+            memset(planes, 0, sizeof(planes));
+            ref_deinterleave(in, ref_out, channels, frames);
+            audio_dsp_deinterleave(in, out, channels, frames);
+            split = split && memcmp(ref_planes, planes, sizeof(planes)) == 0;
+        }
+    }
+    CHECK(split, "deinterleave: 1/2/3/4/6 channels match the scalar reference");
+}
+
+static void test_levels(void) {
+    short pcm[MAX_LEN + MAX_OFFSET];
+    bool same = true;
+    for (size_t len = 0; len <= MAX_LEN; len++) {
+        size_t off = len % (MAX_OFFSET + 1);
+        fill(pcm, len + off);
+        const short* x = pcm + off;
+        uint64_t ref_sum = 0;
+        uint64_t sum = 0;
+        int ref_pk = -1;
+        int pk = -1;
+        ref_level(x, len, &ref_sum, &ref_pk);
+        audio_dsp_level(x, len, &sum, &pk);
+        same = same && ref_sum == sum && ref_pk == pk &&
+               ref_sum_squares(x, len) == audio_dsp_sum_squares(x, len) &&
+               ref_peak(x, len) == audio_dsp_peak(x, len) &&
+               ref_rms(x, len) == audio_dsp_rms(x, len);
+    }
+    CHECK(same, "sum_squares / peak / rms / level: match the scalar reference");
+
+    /* All -32768: each square is 2^30, so any 32-bit partial sum would overflow */
+    static short low[EDGE_LEN];
+    for (size_t i = 0; i < EDGE_LEN; i++) {
+        low[i] = -32768;
+    }
+    uint64_t expect = (uint64_t)EDGE_LEN << 30;
+    uint64_t sum = 0;
+    int pk = 0;
+    audio_dsp_level(low, EDGE_LEN, &sum, &pk);
+    CHECK(audio_dsp_sum_squares(low, EDGE_LEN) == expect && sum == expect,
+          "sum_squares: %d x -32768 sums to %llu", EDGE_LEN, (unsigned long long)sum);
+    CHECK(audio_dsp_peak(low, EDGE_LEN) == 32768 && pk == 32768, "peak: -32768 reports 32768 (%d)", pk);
+    CHECK(audio_dsp_rms(low, EDGE_LEN) == 32768.0f, "rms: -32768 reports %.1f", audio_dsp_rms(low, EDGE_LEN));
+
+    audio_dsp_level(low, EDGE_LEN, NULL, &pk);
+    audio_dsp_level(low, EDGE_LEN, &sum, NULL);
+    CHECK(pk == 32768 && sum == expect, "level: either output may be NULL");
+}
+
+int main(void) {
+    printf("audio_dsp offline tests (%s backend, %s reference)\n", audio_dsp_backend(), ref_backend());
+    test_gain();
+    test_mix();
+    test_float();
+    test_channels();
+    test_levels();
+    return audio_test_finish("audio_dsp");
+}
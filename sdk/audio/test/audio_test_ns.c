@@ -0,0 +1,210 @@
+/**
+ * Offline tests for audio_ns
+ *
+ * White noise stands in for steady background noise and a tone for
+ * speech. Measured: attenuation of noise once the floor is learned, the
+ * tone kept at its level (fitted at the output, so the one-hop delay does
+ * not matter) with the SNR improved, a tone onset passing at once, the
+ * strength control, and reconstruction one hop late at strength 0,
+ * including full-scale input.
+ */
+
+#include "../audio_ns.h"
+#include "audio_test_signal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define RATE            16000
+#define FRAME           320                   // 20 ms
+#define NOISE_AMP       1000.0
+#define TONE_AMP        8000.0
+#define TONE_HZ         1000.0
+
+static audio_ns_t* create_ns(void) {
+    audio_ns_config_t config = { .sample_rate = RATE, .frame_samples = FRAME };
+    return audio_ns_create(&config);
+}
+
+/* Noise, plus the tone from frame `tone_from` on (-1: none) */
+static void make_frame(uint32_t* seed, size_t f, long tone_from, short* out) {
+    for (size_t i = 0; i < FRAME; i++) {
+        size_t n = f * FRAME + i;
+        double v = audio_test_noise(seed, NOISE_AMP);
+        if (tone_from >= 0 && f >= (size_t)tone_from) {
+            v += TONE_AMP * sin(2.0 * M_PI * TONE_HZ * (double)n / RATE);
+        }
+        out[i] = audio_test_clip(v);
+    }
+}
+
+/* Noise only for 3 s: the floor is learned and the noise pushed down */
+static void test_noise(void) {
+    audio_ns_t* ns = create_ns();
+    if (!ns) {
+        CHECK(0, "noise: create");
+        return;
+    }
+    uint32_t seed = 99;
+    short in[FRAME];
+    short out[FRAME];
+    double in_power = 0.0;
+    double out_power = 0.0;
+    for (size_t f = 0; f < 150; f++) {
+        make_frame(&seed, f, -1, in);
+        audio_ns_process(ns, in, out, FRAME);
+        if (f >= 100) {
+            in_power += audio_test_power(in, FRAME, 1);
+            out_power += audio_test_power(out, FRAME, 1);
+        }
+    }
+    double reduction = audio_test_db(in_power / out_power);
+    CHECK(reduction > 10.0 && reduction < 17.0, "steady noise reduced by %.1f dB (limit 15 dB)", reduction);
+
+    audio_ns_stats_t stats;
+    audio_ns_get_stats(ns, &stats);
+    CHECK(stats.frames == 150 && stats.hop_samples == 160 && stats.fft_size == 512,
+          "stats: %llu frames, hop %zu, FFT %zu", (unsigned long long)stats.frames, stats.hop_samples,
+          stats.fft_size);
+    CHECK(stats.mean_gain_q15 < 32767 / 4, "mean bin gain %d in noise", stats.mean_gain_q15);
+
+    /* Half strength attenuates less */
+    audio_ns_set_strength(ns, 50);
+    in_power = 0.0;
+    out_power = 0.0;
+    for (size_t f = 150; f < 200; f++) {
+        make_frame(&seed, f, -1, in);
+        audio_ns_process(ns, in, out, FRAME);
+        if (f >= 160) {
+            in_power += audio_test_power(in, FRAME, 1);
+            out_power += audio_test_power(out, FRAME, 1);
+        }
+    }
+    double half = audio_test_db(in_power / out_power);
+    CHECK(half > 3.0 && half < reduction - 3.0, "strength 50: noise reduced by %.1f dB", half);
+    audio_ns_get_stats(ns, &stats);
+    CHECK(stats.strength == 50, "strength reported as %d", stats.strength);
+    CHECK(audio_ns_set_strength(ns, 101) == -1 && audio_ns_set_strength(ns, -1) == -1,
+          "strength outside 0-100 rejected");
+    audio_ns_destroy(ns);
+}
+
+/* 2 s of noise, then the tone joins: it must come through at its level, at once */
+static void test_tone(void) {
+    const size_t frames = 200;
+    const long onset = 100;
+    audio_ns_t* ns = create_ns();
+    short* in = (short*)malloc(frames * FRAME * sizeof(short));
+    short* out = (short*)malloc(frames * FRAME * sizeof(short));
+    if (!ns || !in || !out) {
+        CHECK(0, "tone: create");
+        goto done;
+    }
+    uint32_t seed = 7;
+    for (size_t f = 0; f < frames; f++) {
+        make_frame(&seed, f, onset, in + f * FRAME);
+        audio_ns_process(ns, in + f * FRAME, out + f * FRAME, FRAME);
+    }
+
+    /* Steady state over the last second */
+    size_t from = (frames - 50) * FRAME;
+    size_t count = 50 * FRAME;
+    double in_amp = 0.0;
+    double out_amp = 0.0;
+    double in_snr = audio_test_tone_snr(in + from, count, 1, TONE_HZ, RATE, &in_amp);
+    double out_snr = audio_test_tone_snr(out + from, count, 1, TONE_HZ, RATE, &out_amp);
+    double gain_db = 20.0 * log10(out_amp / in_amp);
+    CHECK(fabs(gain_db) < 1.0, "tone level kept: %.2f dB", gain_db);
+    CHECK(out_snr > in_snr + 6.0, "SNR %.1f dB in, %.1f dB out", in_snr, out_snr);
+
+    /* Onset: the 20 ms after the first full hop of tone, allowing for the hop of latency */
+    size_t onset_at = (size_t)onset * FRAME + 2 * 160;
+    double onset_amp = 0.0;
+    audio_test_tone_snr(out + onset_at, FRAME, 1, TONE_HZ, RATE, &onset_amp);
+    double onset_db = 20.0 * log10(onset_amp / TONE_AMP);
+    CHECK(fabs(onset_db) < 1.5, "tone onset passes at once: %.2f dB in the first 20 ms", onset_db);
+
+done:
+    free(in);
+    free(out);
+    audio_ns_destroy(ns);
+}
+
+/* Strength 0: windowing and overlap-add alone, so the input comes back one hop late */
+static void test_passthrough(void) {
+    const size_t frames = 20;
+    audio_ns_t* ns = create_ns();
+    short* in = (short*)malloc(frames * FRAME * sizeof(short));
+    short* out = (short*)malloc(frames * FRAME * sizeof(short));
+    if (!ns || !in || !out) {
+        CHECK(0, "passthrough: create");
+        goto done;
+    }
+    audio_ns_set_strength(ns, 0);
+    uint32_t seed = 3;
+    for (size_t n = 0; n < frames * FRAME; n++) {
+        /* Noise for half the run, then a full-scale square wave */
+        if (n < frames * FRAME / 2) {
+            in[n] = audio_test_clip(audio_test_noise(&seed, 20000.0));
+        } else {
+            in[n] = (n / 40) % 2 ? -32768 : 32767;
+        }
+    }
+    for (size_t f = 0; f < frames; f++) {
+        audio_ns_process(ns, in + f * FRAME, out + f * FRAME, FRAME);
+    }
+    audio_ns_stats_t stats;
+    audio_ns_get_stats(ns, &stats);
+    size_t hop = stats.hop_samples;
+    int worst = 0;
+    bool sign_kept = true;
+    for (size_t n = 2 * hop; n < frames * FRAME; n++) {
+        int err = abs((int)out[n] - (int)in[n - hop]);
+        worst = err > worst ? err : worst;
+        sign_kept = sign_kept && (int)out[n] * (int)in[n - hop] >= 0;
+    }
+    /* Q15 window rounding leaves a few LSB at full scale */
+    CHECK(worst <= 4, "strength 0: input one hop late, within %d LSB", worst);
+    CHECK(sign_kept, "strength 0: full-scale square wave does not wrap");
+
+    /* In-place processing gives the same result */
+    audio_ns_reset(ns);
+    short* copy = (short*)malloc(frames * FRAME * sizeof(short));
+    if (copy) {
+        memcpy(copy, in, frames * FRAME * sizeof(short));
+        for (size_t f = 0; f < frames; f++) {
+            audio_ns_process(ns, copy + f * FRAME, copy + f * FRAME, FRAME);
+        }
+        CHECK(memcmp(copy, out, frames * FRAME * sizeof(short)) == 0, "in place matches out of place after reset");
+        free(copy);
+    }
+
+done:
+    free(in);
+    free(out);
+    audio_ns_destroy(ns);
+}
+
+static void test_create(void) {
+    audio_ns_config_t config = { .sample_rate = RATE, .frame_samples = 31 };
+    CHECK(audio_ns_create(&config) == NULL, "frame with no hop of 32-256 samples rejected");
+    config.frame_samples = 0;
+    CHECK(audio_ns_create(&config) == NULL, "zero frame size rejected");
+    config.frame_samples = 480;
+    audio_ns_t* ns = audio_ns_create(&config);
+    audio_ns_stats_t stats = {0};
+    audio_ns_get_stats(ns, &stats);
+    CHECK(ns && stats.hop_samples == 240, "30 ms frame split into %zu-sample hops", stats.hop_samples);
+    short in[FRAME] = {0};
+    CHECK(audio_ns_process(ns, in, in, FRAME) == -1, "wrong frame size rejected");
+    audio_ns_destroy(ns);
+}
+
+int main(void) {
+    printf("audio_ns offline tests\n");
+    test_noise();
+    test_tone();
+    test_passthrough();
+    test_create();
+    return audio_test_finish("audio_ns");
+}
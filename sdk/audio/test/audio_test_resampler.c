@@ -0,0 +1,239 @@
+/**
+ * Offline tests for audio_resampler
+ *
+ * Tones are resampled between the native device rates and the 16 kHz codec
+ * rate and fitted at the output rate: the fitted amplitude checks unity gain,
+ * the residual checks SNR. A tone above the output Nyquist checks the
+ * anti-aliasing filter. Streaming in uneven chunks, with the output capacity
+ * limited as the PortAudio callbacks do, must match a one-shot run exactly.
+ */
+
+#include "../audio_resampler.h"
+#include "audio_test_signal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define TONE_AMP        16000.0
+#define TONE_SECONDS    1
+
+/* Resample `frames` input frames in one call into a buffer sized with audio_resampler_max_output() */
+static short* resample_all(audio_resampler_t* rs, const short* in, size_t frames, int channels, size_t* out_frames) {
+    size_t capacity = audio_resampler_max_output(rs, frames);
+    short* out = (short*)calloc(capacity * (size_t)channels, sizeof(short));
+    if (!out) {
+        *out_frames = 0;
+        return NULL;
+    }
+    size_t consumed = 0;
+    *out_frames = audio_resampler_process(rs, in, frames, &consumed, out, capacity);
+    return out;
+}
+
+static void test_tone(unsigned int in_rate, unsigned int out_rate, double freq) {
+    size_t frames = in_rate * TONE_SECONDS;
+    short* in = (short*)malloc(frames * sizeof(short));
+    audio_resampler_t* rs = audio_resampler_create(in_rate, out_rate, 1, 1024);
+    if (!in || !rs) {
+        CHECK(0, "%u -> %u Hz: create", in_rate, out_rate);
+        free(in);
+        audio_resampler_destroy(rs);
+        return;
+    }
+    audio_test_sine(in, frames, 1, freq, in_rate, TONE_AMP);
+
+    size_t out_frames = 0;
+    short* out = resample_all(rs, in, frames, 1, &out_frames);
+    size_t expected = (size_t)((uint64_t)frames * out_rate / in_rate);
+    CHECK(out && out_frames + 2 >= expected && out_frames <= expected + 2,
+          "%u -> %u Hz: %zu frames out for %zu in", in_rate, out_rate, out_frames, frames);
+
+    /* Skip the filter's start-up transient */
+    size_t skip = (size_t)audio_resampler_latency_us(rs) * out_rate / 1000000 * 4 + 16;
+    if (out && out_frames > skip * 2) {
+        double amp = 0.0;
+        double snr = audio_test_tone_snr(out + skip, out_frames - skip, 1, freq, out_rate, &amp);
+        double gain_db = 20.0 * log10(amp / TONE_AMP);
+        CHECK(fabs(gain_db) < 0.05, "%u -> %u Hz: %.0f Hz gain %.3f dB", in_rate, out_rate, freq, gain_db);
+        CHECK(snr > 80.0, "%u -> %u Hz: %.0f Hz SNR %.1f dB", in_rate, out_rate, freq, snr);
+    }
+
+    free(out);
+    free(in);
+    audio_resampler_destroy(rs);
+}
+
+/* 10 kHz aliases to 6 kHz at 16 kHz output; the Kaiser stopband must remove it */
+static void test_alias(void) {
+    const unsigned int in_rate = 48000;
+    const unsigned int out_rate = 16000;
+    size_t frames = in_rate * TONE_SECONDS;
+    short* in = (short*)malloc(frames * sizeof(short));
+    audio_resampler_t* rs = audio_resampler_create(in_rate, out_rate, 1, 1024);
+    if (!in || !rs) {
+        CHECK(0, "alias: create");
+        free(in);
+        audio_resampler_destroy(rs);
+        return;
+    }
+    audio_test_sine(in, frames, 1, 10000.0, in_rate, TONE_AMP);
+
+    size_t out_frames = 0;
+    short* out = resample_all(rs, in, frames, 1, &out_frames);
+    size_t skip = 256;
+    if (out && out_frames > skip) {
+        double power = audio_test_power(out + skip, out_frames - skip, 1);
+        double level = audio_test_db(power / (TONE_AMP * TONE_AMP / 2.0));
+        CHECK(level < -80.0, "48000 -> 16000 Hz: 10 kHz alias at %.1f dB", level);
+    } else {
+        CHECK(0, "alias: output produced");
+    }
+
+    free(out);
+    free(in);
+    audio_resampler_destroy(rs);
+}
+
+/* Each channel of an interleaved stream is filtered on its own */
+static void test_stereo(void) {
+    const unsigned int in_rate = 44100;
+    const unsigned int out_rate = 16000;
+    size_t frames = in_rate * TONE_SECONDS;
+    short* in = (short*)calloc(frames * 2, sizeof(short));
+    audio_resampler_t* rs = audio_resampler_create(in_rate, out_rate, 2, 512);
+    if (!in || !rs) {
+        CHECK(0, "stereo: create");
+        free(in);
+        audio_resampler_destroy(rs);
+        return;
+    }
+    audio_test_sine(in, frames, 2, 440.0, in_rate, TONE_AMP);
+    audio_test_sine(in + 1, frames, 2, 3000.0, in_rate, TONE_AMP / 2.0);
+
+    size_t out_frames = 0;
+    short* out = resample_all(rs, in, frames, 2, &out_frames);
+    size_t skip = 256;
+    if (out && out_frames > skip) {
+        double left = audio_test_tone_snr(out + skip * 2, out_frames - skip, 2, 440.0, out_rate, NULL);
+        double right = audio_test_tone_snr(out + skip * 2 + 1, out_frames - skip, 2, 3000.0, out_rate, NULL);
+        CHECK(left > 80.0 && right > 74.0, "stereo 44100 -> 16000 Hz: SNR %.1f / %.1f dB", left, right);
+    } else {
+        CHECK(0, "stereo: output produced");
+    }
+
+    free(out);
+    free(in);
+    audio_resampler_destroy(rs);
+}
+
+/*
+ * Feed uneven chunks (some larger than max_input_frames) into a small output
+ * buffer, carrying unconsumed input over like the play callback does; the
+ * result must be sample-identical to one call over the whole signal.
+ */
+static void test_streaming(unsigned int in_rate, unsigned int out_rate) {
+    const size_t frames = in_rate / 2;
+    const size_t max_input = 160;
+    uint32_t seed = 12345;
+    short* in = (short*)malloc(frames * sizeof(short));
+    if (!in) {
+        CHECK(0, "streaming: allocate");
+        return;
+    }
+    for (size_t i = 0; i < frames; i++) {
+        in[i] = audio_test_clip(0.5 * sin(2.0 * M_PI * 1234.0 * (double)i / in_rate) * TONE_AMP +
+                                audio_test_noise(&seed, 4000.0));
+    }
+
+    audio_resampler_t* whole = audio_resampler_create(in_rate, out_rate, 1, max_input);
+    audio_resampler_t* chunked = audio_resampler_create(in_rate, out_rate, 1, max_input);
+    size_t reference_frames = 0;
+    short* reference = whole ? resample_all(whole, in, frames, 1, &reference_frames) : NULL;
+    short* out = reference ? (short*)calloc(reference_frames + 64, sizeof(short)) : NULL;
+    if (!chunked || !out) {
+        CHECK(0, "streaming: create");
+        goto done;
+    }
+
+    size_t pos = 0;
+    size_t produced = 0;
+    bool bounded = true;
+    while (pos < frames) {
+        size_t chunk = 1 + audio_test_rand(&seed) % 400;
+        if (chunk > frames - pos) {
+            chunk = frames - pos;
+        }
+        /* Output capacity limited to a few frames now and then, as a device period would */
+        size_t capacity = 1 + audio_test_rand(&seed) % 97;
+        if (produced + capacity > reference_frames + 64) {
+            capacity = reference_frames + 64 - produced;
+        }
+        size_t consumed = 0;
+        size_t n = audio_resampler_process(chunked, in + pos, chunk, &consumed, out + produced, capacity);
+        if (n > audio_resampler_max_output(chunked, chunk) || consumed > chunk) {
+            bounded = false;
+        }
+        if (n == 0 && consumed == 0) {
+            bounded = false;
+            break;
+        }
+        produced += n;
+        pos += consumed;
+    }
+
+    CHECK(bounded, "%u -> %u Hz: every call within max_output() and makes progress", in_rate, out_rate);
+    CHECK(produced == reference_frames, "%u -> %u Hz: chunked run produced %zu frames, one-shot %zu",
+          in_rate, out_rate, produced, reference_frames);
+    CHECK(produced == reference_frames && memcmp(out, reference, produced * sizeof(short)) == 0,
+          "%u -> %u Hz: chunked output identical to one-shot output", in_rate, out_rate);
+
+    /* After reset the instance behaves like a new one */
+    audio_resampler_reset(chunked);
+    size_t again_frames = 0;
+    short* again = resample_all(chunked, in, frames, 1, &again_frames);
+    CHECK(again && again_frames == reference_frames &&
+          memcmp(again, reference, again_frames * sizeof(short)) == 0,
+          "%u -> %u Hz: output after reset identical to a new instance", in_rate, out_rate);
+    free(again);
+
+done:
+    free(out);
+    free(reference);
+    free(in);
+    audio_resampler_destroy(whole);
+    audio_resampler_destroy(chunked);
+}
+
+static void test_sizing(void) {
+    audio_resampler_t* rs = audio_resampler_create(44100, 16000, 1, 512);
+    CHECK(rs != NULL, "44100 -> 16000 Hz: create");
+    if (!rs) {
+        return;
+    }
+    /* Enough input for a 20 ms codec frame must be enough for every phase position */
+    size_t need = audio_resampler_input_for_output(rs, 320);
+    CHECK(audio_resampler_max_output(rs, need) >= 320, "input_for_output(320) = %zu frames covers 320 outputs", need);
+    CHECK(audio_resampler_latency_us(rs) > 0 && audio_resampler_latency_us(rs) < 2000,
+          "group delay %u us", audio_resampler_latency_us(rs));
+    audio_resampler_destroy(rs);
+
+    CHECK(audio_resampler_create(0, 16000, 1, 160) == NULL, "zero rate rejected");
+    CHECK(audio_resampler_create(48000, 16000, 0, 160) == NULL, "zero channels rejected");
+    CHECK(audio_resampler_process(NULL, NULL, 0, NULL, NULL, 0) == 0, "NULL resampler produces nothing");
+}
+
+int main(void) {
+    printf("audio_resampler offline tests\n");
+    test_tone(48000, 16000, 1000.0);
+    test_tone(44100, 16000, 1000.0);
+    test_tone(16000, 48000, 1000.0);
+    test_tone(16000, 44100, 1000.0);
+    test_tone(48000, 16000, 5000.0);
+    test_alias();
+    test_stereo();
+    test_streaming(48000, 16000);
+    test_streaming(44100, 16000);
+    test_streaming(16000, 44100);
+    test_sizing();
+    return audio_test_finish("audio_resampler");
+}
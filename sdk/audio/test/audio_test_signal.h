@@ -0,0 +1,132 @@
+/**
+ * Shared helpers for the offline audio tests
+ *
+ * The offline tests run the DSP stages on synthetic signals and need no
+ * audio device. Each test is its own executable; CHECK prints one line per
+ * assertion and audio_test_finish() turns the failure count into the exit
+ * status used by `make test-offline`.
+ */
+
+#ifndef AUDIO_TEST_SIGNAL_H
+#define AUDIO_TEST_SIGNAL_H
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stddef.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+static int audio_test_failures = 0;
+
+#define CHECK(cond, ...) do { \
+    int check_ok_ = (cond) ? 1 : 0; \
+    printf(check_ok_ ? "  ok   " : "  FAIL "); \
+    printf(__VA_ARGS__); \
+    if (!check_ok_) { \
+        printf("  (%s:%d)", __FILE__, __LINE__); \
+        audio_test_failures++; \
+    } \
+    printf("\n"); \
+} while (0)
+
+static inline int audio_test_finish(const char* name) {
+    printf("%s: %s (%d failed)\n", name, audio_test_failures == 0 ? "passed" : "FAILED", audio_test_failures);
+    return audio_test_failures == 0 ? 0 : 1;
+}
+
+/* Deterministic pseudo-random numbers so every run sees the same signals */
+static inline uint32_t audio_test_rand(uint32_t* state) {
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 8;
+}
+
+/* Uniform noise in [-amp, amp] */
+static inline double audio_test_noise(uint32_t* state, double amp) {
+    return amp * ((double)audio_test_rand(state) / (double)(1u << 23) - 1.0);
+}
+
+static inline short audio_test_clip(double v) {
+    v += v < 0.0 ? -0.5 : 0.5;
+    return v >= 32767.0 ? 32767 : (v <= -32768.0 ? -32768 : (short)v);
+}
+
+/* Write a sine into one channel of an interleaved buffer */
+static inline void audio_test_sine(short* out, size_t frames, int stride, double freq, double rate,
+                                   double amp) {
+    for (size_t i = 0; i < frames; i++) {
+        out[i * (size_t)stride] = audio_test_clip(amp * sin(2.0 * M_PI * freq * (double)i / rate));
+    }
+}
+
+static inline double audio_test_db(double ratio) {
+    return ratio > 0.0 ? 10.0 * log10(ratio) : -999.0;
+}
+
+static inline double audio_test_power(const short* x, size_t frames, int stride) {
+    double sum = 0.0;
+    for (size_t i = 0; i < frames; i++) {
+        double v = x[i * (size_t)stride];
+        sum += v * v;
+    }
+    return frames ? sum / (double)frames : 0.0;
+}
+
+/**
+ * Least-squares fit of a*sin + b*cos + dc at a known frequency; returns the
+ * SNR in dB of the fitted tone against the residual and the tone amplitude
+ * through `amp`. The phase is free, so filter delay does not matter.
+ */
+static inline double audio_test_tone_snr(const short* x, size_t frames, int stride, double freq,
+                                         double rate, double* amp) {
+    /* Normal equations for the basis (sin, cos, 1) */
+    double m[3][3] = {{0}};
+    double r[3] = {0};
+    for (size_t i = 0; i < frames; i++) {
+        double w = 2.0 * M_PI * freq * (double)i / rate;
+        double basis[3] = { sin(w), cos(w), 1.0 };
+        double v = x[i * (size_t)stride];
+        for (int a = 0; a < 3; a++) {
+            r[a] += basis[a] * v;
+            for (int b = 0; b < 3; b++) {
+                m[a][b] += basis[a] * basis[b];
+            }
+        }
+    }
+    /* Gaussian elimination; the matrix is well conditioned for frames >> rate / freq */
+    for (int k = 0; k < 3; k++) {
+        for (int a = k + 1; a < 3; a++) {
+            double f = m[a][k] / m[k][k];
+            for (int b = k; b < 3; b++) {
+                m[a][b] -= f * m[k][b];
+            }
+            r[a] -= f * r[k];
+        }
+    }
+    double c[3];
+    for (int k = 2; k >= 0; k--) {
+        double s = r[k];
+        for (int b = k + 1; b < 3; b++) {
+            s -= m[k][b] * c[b];
+        }
+        c[k] = s / m[k][k];
+    }
+
+    double signal = 0.0;
+    double noise = 0.0;
+    for (size_t i = 0; i < frames; i++) {
+        double w = 2.0 * M_PI * freq * (double)i / rate;
+        double tone = c[0] * sin(w) + c[1] * cos(w);
+        double e = x[i * (size_t)stride] - tone - c[2];
+        signal += tone * tone;
+        noise += e * e;
+    }
+    if (amp) {
+        *amp = sqrt(c[0] * c[0] + c[1] * c[1]);
+    }
+    return audio_test_db(noise > 0.0 ? signal / noise : 1e30);
+}
+
+#endif /* AUDIO_TEST_SIGNAL_H */
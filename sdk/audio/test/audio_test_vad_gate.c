@@ -0,0 +1,216 @@
+/**
+ * Offline tests for the VAD gate stage and local end-of-speech detection
+ *
+ * The gate stage (audio_stage_vad_gate) runs on single frames with the PCM
+ * codec as the encoder. A scripted detector gives exact speech / silence
+ * runs to check the trailing-silence clock, that the endpoint fires once
+ * per utterance after endpoint_ms and only after the gate has opened, and
+ * that short pauses and blips do not end or start an utterance. The energy
+ * detector then finds the end of a tone burst in noise.
+ */
+
+#include "../audio_pipeline.h"
+#include "../audio_vad_gate.h"
+#include "../../codecs/pcm_codec.h"
+#include "audio_test_signal.h"
+
+#include <string.h>
+
+#define RATE            16000
+#define FRAME           320                   // 20 ms
+#define FRAME_MS        20
+#define ENDPOINT_MS     600
+#define HANGOVER_MS     400
+
+/* Detector that reports whatever the test sets */
+typedef struct {
+    audio_vad_t base;
+    bool speech;
+} script_vad_t;
+
+static bool script_is_speech(audio_vad_t* self, const short* samples, size_t count) {
+    (void)samples;
+    (void)count;
+    return ((script_vad_t*)self)->speech;
+}
+
+static const audio_vad_vtable_t script_vtable = { script_is_speech, NULL, NULL };
+
+typedef struct {
+    int starts;
+    int ends;
+    size_t packets;
+} session_t;
+
+static bool on_packet(void* user_data, const uint8_t* packet, size_t size) {
+    (void)packet;
+    (void)size;
+    ((session_t*)user_data)->packets++;
+    return true;
+}
+
+static void on_speech_start(void* user_data) {
+    ((session_t*)user_data)->starts++;
+}
+
+static void on_speech_end(void* user_data) {
+    ((session_t*)user_data)->ends++;
+}
+
+typedef struct {
+    audio_codec_t* encoder;
+    audio_vad_gate_t* gate;
+    audio_stage_vad_gate_t ctx;
+    audio_stage_t stage;
+    session_t session;
+} gate_fixture_t;
+
+static bool fixture_init(gate_fixture_t* fx, audio_vad_t* vad) {
+    memset(fx, 0, sizeof(*fx));
+    audio_format_t format = { RATE, 1, 16, FRAME_MS };
+    fx->encoder = pcm_codec_create();
+    if (!fx->encoder || audio_codec_init_encoder(fx->encoder, &format) != CODEC_SUCCESS) {
+        return false;
+    }
+    audio_vad_gate_config_t config = {
+        .frame_samples = FRAME,
+        .frame_duration_ms = FRAME_MS,
+        .hangover_ms = HANGOVER_MS,
+    };
+    fx->gate = audio_vad_gate_create(vad, fx->encoder, &config, on_packet, &fx->session);
+    if (!fx->gate) {
+        return false;
+    }
+    fx->ctx.gate = fx->gate;
+    fx->ctx.on_speech_start = on_speech_start;
+    fx->ctx.endpoint_ms = ENDPOINT_MS;
+    fx->ctx.on_speech_end = on_speech_end;
+    fx->ctx.user_data = &fx->session;
+    fx->stage = audio_stage_vad_gate(&fx->ctx);
+    return true;
+}
+
+static void fixture_destroy(gate_fixture_t* fx) {
+    audio_vad_gate_destroy(fx->gate);
+    audio_codec_destroy(fx->encoder);
+}
+
+/* Run `frames` frames with the scripted decision; returns the frame (1-based) on which the endpoint fired, 0 if none */
+static int run(gate_fixture_t* fx, script_vad_t* vad, bool speech, int frames) {
+    short pcm[FRAME] = {0};
+    int fired_at = 0;
+    vad->speech = speech;
+    for (int f = 1; f <= frames; f++) {
+        int ends = fx->session.ends;
+        fx->stage.process(fx->stage.ctx, pcm, NULL, FRAME);
+        if (fx->session.ends != ends && fired_at == 0) {
+            fired_at = f;
+        }
+    }
+    return fired_at;
+}
+
+static void test_endpoint(void) {
+    script_vad_t vad = { { &script_vtable, NULL }, false };
+    gate_fixture_t fx = {0};
+    if (!fixture_init(&fx, &vad.base)) {
+        CHECK(0, "endpoint: create");
+        fixture_destroy(&fx);
+        return;
+    }
+
+    CHECK(run(&fx, &vad, false, 50) == 0 && audio_vad_gate_silence_ms(fx.gate) == -1,
+          "silence before any speech: no clock, no endpoint");
+
+    run(&fx, &vad, true, 10);
+    CHECK(fx.session.starts == 1 && fx.ctx.speaking && audio_vad_gate_is_open(fx.gate),
+          "speech opens the gate, on_speech_start once");
+    CHECK(audio_vad_gate_silence_ms(fx.gate) == 0, "silence clock at 0 during speech");
+
+    /* A 300 ms pause inside the utterance is shorter than the hangover and the endpoint */
+    CHECK(run(&fx, &vad, false, 15) == 0, "300 ms pause does not end the utterance");
+    CHECK(audio_vad_gate_silence_ms(fx.gate) == 300, "silence clock at %d ms after the pause",
+          audio_vad_gate_silence_ms(fx.gate));
+    run(&fx, &vad, true, 5);
+    CHECK(fx.session.starts == 1 && audio_vad_gate_silence_ms(fx.gate) == 0,
+          "speech after the pause continues the utterance");
+
+    /* Trailing silence: the gate closes after its hangover, the endpoint follows at 600 ms */
+    int fired = run(&fx, &vad, false, 60);
+    CHECK(fired == ENDPOINT_MS / FRAME_MS, "endpoint after %d ms of trailing silence", fired * FRAME_MS);
+    CHECK(fx.session.ends == 1 && !fx.ctx.speaking, "endpoint fires once per utterance");
+    CHECK(!audio_vad_gate_is_open(fx.gate), "gate closed after its %d ms hangover", HANGOVER_MS);
+
+    /* A one-frame blip does not open the gate, so no utterance and no endpoint */
+    run(&fx, &vad, true, 1);
+    CHECK(run(&fx, &vad, false, 60) == 0 && fx.session.starts == 1 && fx.session.ends == 1,
+          "blip shorter than the onset is no utterance");
+
+    /* A 500 ms pause closes the gate (400 ms hangover) but is still inside the utterance */
+    run(&fx, &vad, true, 5);
+    CHECK(run(&fx, &vad, false, 25) == 0 && !audio_vad_gate_is_open(fx.gate) && fx.ctx.speaking,
+          "pause past the hangover closes the gate without an endpoint");
+    run(&fx, &vad, true, 5);
+    CHECK(run(&fx, &vad, false, 60) == ENDPOINT_MS / FRAME_MS && fx.session.starts == 3 && fx.session.ends == 2,
+          "the utterance ends %d ms after its last speech, once", ENDPOINT_MS);
+
+    /* Reset mid-utterance (listening stopped): no late endpoint */
+    run(&fx, &vad, true, 5);
+    fx.stage.reset(fx.stage.ctx);
+    CHECK(!fx.ctx.speaking && audio_vad_gate_silence_ms(fx.gate) == -1, "reset clears the utterance and the clock");
+    CHECK(run(&fx, &vad, false, 60) == 0 && fx.session.ends == 2, "no endpoint after a reset");
+
+    /* Without endpoint_ms the stage never reports an end */
+    fx.ctx.endpoint_ms = 0;
+    run(&fx, &vad, true, 5);
+    CHECK(run(&fx, &vad, false, 60) == 0 && fx.session.ends == 2, "endpoint_ms 0: no local endpointing");
+    fixture_destroy(&fx);
+}
+
+/* Energy detector on 1 s of tone in steady noise: the end is found within endpoint_ms plus a few frames */
+static void test_energy_vad(void) {
+    audio_vad_t* vad = audio_energy_vad_create(NULL);
+    gate_fixture_t fx = {0};
+    if (!vad || !fixture_init(&fx, vad)) {
+        CHECK(0, "energy VAD: create");
+        fixture_destroy(&fx);
+        audio_vad_destroy(vad);
+        return;
+    }
+    uint32_t seed = 21;
+    short pcm[FRAME];
+    int tone_end = 0;
+    int fired_at = -1;
+    for (int f = 0; f < 200; f++) {
+        bool tone = f >= 50 && f < 100;
+        for (size_t i = 0; i < FRAME; i++) {
+            double v = audio_test_noise(&seed, 100.0);
+            if (tone) {
+                v += 8000.0 * sin(2.0 * M_PI * 300.0 * (double)(f * FRAME + (int)i) / RATE);
+            }
+            pcm[i] = audio_test_clip(v);
+        }
+        if (tone) {
+            tone_end = f + 1;
+        }
+        int ends = fx.session.ends;
+        fx.stage.process(fx.stage.ctx, pcm, NULL, FRAME);
+        if (fx.session.ends != ends && fired_at < 0) {
+            fired_at = f + 1;
+        }
+    }
+    int delay_ms = (fired_at - tone_end) * FRAME_MS;
+    CHECK(fx.session.starts == 1 && fx.session.ends == 1, "one utterance detected in the burst");
+    CHECK(fired_at > 0 && delay_ms >= ENDPOINT_MS && delay_ms <= ENDPOINT_MS + 100,
+          "end of speech reported %d ms after the burst", delay_ms);
+    CHECK(fx.session.packets > 50, "%zu packets sent for the utterance", fx.session.packets);
+    fixture_destroy(&fx);
+    audio_vad_destroy(vad);
+}
+
+int main(void) {
+    printf("audio_vad_gate offline tests\n");
+    test_endpoint();
+    test_energy_vad();
+    return audio_test_finish("audio_vad_gate");
+}
@@ -0,0 +1,331 @@
+/**
+ * Offline tests for audio_wake
+ *
+ * The stage is driven frame by frame with a scripted spotter: every sample
+ * of frame f holds the value f, and the spotter fires on the frame whose
+ * value it was told to look for. A recording sink stores the values it
+ * receives, so the pre-roll, the audio held while the session comes up and
+ * its order can be checked exactly, together with the state machine
+ * (spotting, pending, awake, verifying) and the timeout paths.
+ */
+
+#include "../audio_wake.h"
+#include "audio_test_signal.h"
+
+#include <string.h>
+
+#define FRAME           160                   // 10 ms at 16 kHz
+#define FRAME_MS        10
+#define PRE_ROLL_MS     50                    // 5 frames
+#define MAX_PENDING_MS  100                   // 10 frames
+#define VERIFY_MS       80                    // 8 frames
+#define MAX_SINK        64
+
+/* Spotter firing on one frame value */
+typedef struct {
+    audio_kws_t base;
+    short trigger;
+    int calls;
+    int resets;
+} script_kws_t;
+
+static bool script_detect(audio_kws_t* self, const short* samples, size_t count, const char** keyword) {
+    script_kws_t* kws = (script_kws_t*)self;
+    kws->calls++;
+    if (count > 0 && samples[0] == kws->trigger) {
+        *keyword = "hi linx";
+        return true;
+    }
+    return false;
+}
+
+static void script_reset(audio_kws_t* self) {
+    ((script_kws_t*)self)->resets++;
+}
+
+static const audio_kws_vtable_t script_vtable = { script_detect, script_reset, NULL };
+
+static void script_init(script_kws_t* kws, short trigger) {
+    memset(kws, 0, sizeof(*kws));
+    kws->base.vtable = &script_vtable;
+    kws->trigger = trigger;
+}
+
+/* Session and sink: counts the callbacks and records the first sample of every flushed frame */
+typedef struct {
+    bool ready;
+    int wakes;
+    int candidates;
+    int rejects;
+    short received[MAX_SINK];
+    size_t count;
+} session_t;
+
+static int sink_process(void* ctx, const short* in, short* out, size_t samples) {
+    (void)out;
+    session_t* s = (session_t*)ctx;
+    if (samples != FRAME) {
+        return -1;
+    }
+    if (s->count < MAX_SINK) {
+        s->received[s->count] = in[0];
+    }
+    s->count++;
+    return AUDIO_STAGE_STOP;
+}
+
+static void on_wake(void* user_data, const char* keyword) {
+    (void)keyword;
+    ((session_t*)user_data)->wakes++;
+}
+
+static void on_candidate(void* user_data, const char* keyword) {
+    (void)keyword;
+    ((session_t*)user_data)->candidates++;
+}
+
+static void on_reject(void* user_data) {
+    ((session_t*)user_data)->rejects++;
+}
+
+static bool is_ready(void* user_data) {
+    return ((session_t*)user_data)->ready;
+}
+
+static audio_wake_t* create_wake(script_kws_t* kws, script_kws_t* verifier, session_t* session,
+                                 bool while_awake) {
+    memset(session, 0, sizeof(*session));
+    audio_wake_config_t config = {
+        .frame_samples = FRAME,
+        .frame_duration_ms = FRAME_MS,
+        .pre_roll_ms = PRE_ROLL_MS,
+        .max_pending_ms = MAX_PENDING_MS,
+        .detect_while_awake = while_awake,
+        .sink = { "sink", sink_process, NULL, AUDIO_STAGE_READ_ONLY, session, 0 },
+        .on_wake = on_wake,
+        .is_ready = is_ready,
+        .verifier = verifier ? &verifier->base : NULL,
+        .verify_timeout_ms = VERIFY_MS,
+        .on_candidate = on_candidate,
+        .on_reject = on_reject,
+        .user_data = session,
+    };
+    return audio_wake_create(&kws->base, &config);
+}
+
+static int feed(audio_stage_t* stage, short value) {
+    short frame[FRAME];
+    for (size_t i = 0; i < FRAME; i++) {
+        frame[i] = value;
+    }
+    return stage->process(stage->ctx, frame, NULL, FRAME);
+}
+
+/* Received frames are the consecutive values first .. first + count - 1 */
+static bool received_run(const session_t* s, short first, size_t count) {
+    if (s->count != count) {
+        return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (s->received[i] != (short)(first + i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Keyword in frame 20, session ready 4 frames later: pre-roll 16..20 and held 21..24 arrive in order */
+static void test_wake(void) {
+    script_kws_t kws;
+    session_t session;
+    script_init(&kws, 20);
+    audio_wake_t* wake = create_wake(&kws, NULL, &session, false);
+    if (!wake) {
+        CHECK(0, "wake: create");
+        return;
+    }
+    audio_stage_t stage = audio_wake_stage(wake);
+
+    bool stopped = true;
+    for (short f = 0; f < 20; f++) {
+        stopped = stopped && feed(&stage, f) == AUDIO_STAGE_STOP;
+    }
+    CHECK(stopped && session.count == 0 && audio_wake_get_state(wake) == AUDIO_WAKE_SPOTTING,
+          "spotting: every frame consumed, nothing reaches the sink");
+
+    CHECK(feed(&stage, 20) == AUDIO_STAGE_STOP && session.wakes == 1, "keyword calls on_wake");
+    CHECK(audio_wake_get_state(wake) == AUDIO_WAKE_PENDING && session.count == 0,
+          "pending until the session is ready");
+    for (short f = 21; f < 24; f++) {
+        feed(&stage, f);
+    }
+    session.ready = true;
+    CHECK(feed(&stage, 24) == AUDIO_STAGE_STOP, "frame that finds the session ready is flushed, not passed on");
+    CHECK(received_run(&session, 16, 9), "sink got %zu frames: pre-roll 16..20 and held 21..24 in order",
+          session.count);
+    CHECK(audio_wake_get_state(wake) == AUDIO_WAKE_AWAKE, "awake after the flush");
+    CHECK(feed(&stage, 25) == 0 && session.count == 9, "awake: frames pass on to the later stages");
+
+    int calls = kws.calls;
+    feed(&stage, 20);
+    CHECK(kws.calls == calls && session.wakes == 1, "awake: spotter idle without detect_while_awake");
+
+    audio_wake_stats_t stats;
+    audio_wake_get_stats(wake, &stats);
+    CHECK(stats.detections == 1 && stats.flushed_frames == 9 && stats.spotted_frames == 21 &&
+          stats.last_wait_ms == 4 * FRAME_MS,
+          "stats: %llu detection, %llu flushed, %llu spotted, waited %u ms",
+          (unsigned long long)stats.detections, (unsigned long long)stats.flushed_frames,
+          (unsigned long long)stats.spotted_frames, stats.last_wait_ms);
+
+    audio_wake_rearm(wake);
+    CHECK(feed(&stage, 30) == AUDIO_STAGE_STOP && audio_wake_get_state(wake) == AUDIO_WAKE_SPOTTING,
+          "rearm: back to spotting before the next frame");
+    CHECK(kws.resets >= 1, "rearm resets the spotter");
+
+    /* Ready at once: the keyword frame itself completes the wake */
+    session.count = 0;
+    feed(&stage, 20);
+    CHECK(audio_wake_get_state(wake) == AUDIO_WAKE_AWAKE && session.count == 2 &&
+          session.received[0] == 30 && session.received[1] == 20,
+          "ready at once: pre-roll since the rearm flushed with the keyword frame");
+
+    short odd[FRAME + 1] = {0};
+    CHECK(stage.process(stage.ctx, odd, NULL, FRAME + 1) == -1, "wrong frame size rejected");
+    audio_wake_destroy(wake);
+}
+
+/* The session never comes up: back to spotting after max_pending_ms, keeping only the pre-roll */
+static void test_timeout(void) {
+    script_kws_t kws;
+    session_t session;
+    script_init(&kws, 5);
+    audio_wake_t* wake = create_wake(&kws, NULL, &session, false);
+    if (!wake) {
+        CHECK(0, "timeout: create");
+        return;
+    }
+    audio_stage_t stage = audio_wake_stage(wake);
+    for (short f = 0; f <= 5; f++) {
+        feed(&stage, f);
+    }
+    short f = 6;
+    while (audio_wake_get_state(wake) == AUDIO_WAKE_PENDING && f < 100) {
+        feed(&stage, f++);
+    }
+    CHECK(f - 6 == MAX_PENDING_MS / FRAME_MS, "timed out after %d held frames", f - 6);
+    audio_wake_stats_t stats;
+    audio_wake_get_stats(wake, &stats);
+    CHECK(stats.timeouts == 1 && session.count == 0, "timeout counted, nothing flushed");
+
+    /* Next wake flushes only the last pre-roll, none of the stale held audio */
+    kws.trigger = 40;
+    while (f <= 40) {
+        feed(&stage, f++);
+    }
+    session.ready = true;
+    feed(&stage, f);
+    CHECK(received_run(&session, 36, 6), "next wake flushes pre-roll 36..40 and frame 41 (%zu frames)",
+          session.count);
+    audio_wake_destroy(wake);
+}
+
+/* Barge-in by wake word while awake */
+static void test_while_awake(void) {
+    script_kws_t kws;
+    session_t session;
+    script_init(&kws, 3);
+    audio_wake_t* wake = create_wake(&kws, NULL, &session, true);
+    if (!wake) {
+        CHECK(0, "while awake: create");
+        return;
+    }
+    audio_stage_t stage = audio_wake_stage(wake);
+    session.ready = true;
+    for (short f = 0; f < 6; f++) {
+        feed(&stage, f);
+    }
+    CHECK(feed(&stage, 3) == 0 && session.wakes == 2 && audio_wake_get_state(wake) == AUDIO_WAKE_AWAKE,
+          "detect_while_awake: keyword calls on_wake again, frames keep flowing");
+    audio_wake_destroy(wake);
+}
+
+/* Two-stage spotting: confirmed in the pre-roll, confirmed later, and rejected */
+static void test_verifier(void) {
+    script_kws_t kws;
+    script_kws_t verifier;
+    session_t session;
+    script_init(&kws, 10);
+    script_init(&verifier, 8);
+    audio_wake_t* wake = create_wake(&kws, &verifier, &session, false);
+    if (!wake) {
+        CHECK(0, "verifier: create");
+        return;
+    }
+    audio_stage_t stage = audio_wake_stage(wake);
+    session.ready = true;
+
+    for (short f = 0; f <= 10; f++) {
+        feed(&stage, f);
+    }
+    CHECK(session.candidates == 1 && session.wakes == 1 && audio_wake_get_state(wake) == AUDIO_WAKE_AWAKE,
+          "verifier confirms from the pre-roll at once");
+    CHECK(received_run(&session, 6, 5), "pre-roll 6..10 flushed after the confirmation");
+
+    /* Confirmation 3 frames after the candidate */
+    audio_wake_rearm(wake);
+    memset(&session.received, 0, sizeof(session.received));
+    session.count = 0;
+    verifier.trigger = 23;
+    for (short f = 15; f <= 20; f++) {
+        feed(&stage, f);
+    }
+    kws.trigger = 21;
+    feed(&stage, 21);
+    CHECK(session.candidates == 2 && audio_wake_get_state(wake) == AUDIO_WAKE_VERIFYING && session.count == 0,
+          "candidate held while verifying");
+    feed(&stage, 22);
+    feed(&stage, 23);
+    CHECK(session.wakes == 2 && received_run(&session, 17, 7), "confirmed: pre-roll 17..21 and 22..23 flushed");
+
+    /* No confirmation within verify_timeout_ms */
+    audio_wake_rearm(wake);
+    session.count = 0;
+    verifier.trigger = -1;
+    kws.trigger = 30;
+    for (short f = 26; f <= 30; f++) {
+        feed(&stage, f);
+    }
+    short f = 31;
+    while (audio_wake_get_state(wake) == AUDIO_WAKE_VERIFYING && f < 100) {
+        feed(&stage, f++);
+    }
+    CHECK(session.rejects == 1 && f - 31 == VERIFY_MS / FRAME_MS && session.count == 0,
+          "rejected after %d frames, on_reject called, nothing flushed", f - 31);
+    audio_wake_stats_t stats;
+    audio_wake_get_stats(wake, &stats);
+    CHECK(stats.candidates == 3 && stats.detections == 2 && stats.rejections == 1,
+          "stats: %llu candidates, %llu detections, %llu rejections", (unsigned long long)stats.candidates,
+          (unsigned long long)stats.detections, (unsigned long long)stats.rejections);
+    audio_wake_destroy(wake);
+}
+
+static void test_create(void) {
+    script_kws_t kws;
+    script_init(&kws, 0);
+    audio_wake_config_t config = { .frame_samples = 0 };
+    CHECK(audio_wake_create(&kws.base, &config) == NULL, "zero frame size rejected");
+    config.frame_samples = FRAME;
+    CHECK(audio_wake_create(NULL, &config) == NULL, "missing spotter rejected");
+    CHECK(audio_wake_get_state(NULL) == AUDIO_WAKE_SPOTTING, "NULL stage reports spotting");
+}
+
+int main(void) {
+    printf("audio_wake offline tests\n");
+    test_wake();
+    test_timeout();
+    test_while_awake();
+    test_verifier();
+    test_create();
+    return audio_test_finish("audio_wake");
+}
@@ -1,7 +1,14 @@
 #include "camera_interface.h"
 #include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
+#include "../mcp/mcp_buffer.h"
+#include <errno.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_CAMERA);
 
 int camera_interface_init(CameraInterface* self) {
     if (!self || !self->vtable || !self->vtable->init) {
@@ -32,9 +39,42 @@ int camera_interface_capture(CameraInterface* self, CameraFrameBuffer* frame) {
         LOG_ERROR("Invalid camera interface, frame buffer, or vtable");
         return -1;
     }
+    frame->buffer = NULL;
     return self->vtable->capture(self, frame);
 }
 
+int camera_interface_preview(CameraInterface* self, int timeout_ms, camera_preview_sink_t sink, void* user_data) {
+    if (!self || !sink || !self->vtable) {
+        LOG_ERROR("Invalid camera interface, sink, or vtable");
+        return -1;
+    }
+    if (self->vtable->preview) {
+        return self->vtable->preview(self, timeout_ms, sink, user_data);
+    }
+    
+    // No native preview: only uncompressed captures can be shown without decoding
+    CameraFrameBuffer frame = {0};
+    if (camera_interface_capture(self, &frame) != 0) {
+        return -1;
+    }
+    int result = -1;
+    if (frame.format == 0 && frame.data && frame.size >= (size_t)frame.width * frame.height * 3) {
+        CameraPixels pixels = {
+            .data = frame.data,
+            .stride = (size_t)frame.width * 3,
+            .width = frame.width,
+            .height = frame.height,
+            .format = CAMERA_PIXEL_RGB24
+        };
+        sink(&pixels, user_data);
+        result = 0;
+    } else {
+        LOG_WARN_EVERY_MS(5000, "Camera frames are compressed (format %d); set format 0 for previews", frame.format);
+    }
+    camera_interface_release_frame(self, &frame);
+    return result;
+}
+
 int camera_interface_set_h_mirror(CameraInterface* self, bool enabled) {
     if (!self || !self->vtable || !self->vtable->set_h_mirror) {
         LOG_ERROR("Invalid camera interface or vtable");
@@ -67,26 +107,26 @@ int camera_interface_set_explain_url(CameraInterface* self, const char* url, con
     
     // Free existing strings
     if (self->explain_url) {
-        free(self->explain_url);
+        LINX_FREE(self->explain_url);
         self->explain_url = NULL;
     }
     if (self->explain_token) {
-        free(self->explain_token);
+        LINX_FREE(self->explain_token);
         self->explain_token = NULL;
     }
     
     // Allocate and copy new strings
-    self->explain_url = malloc(strlen(url) + 1);
+    self->explain_url = LINX_MALLOC(strlen(url) + 1);
     if (!self->explain_url) {
         LOG_ERROR("Failed to allocate memory for explain URL");
         return -1;
     }
     strcpy(self->explain_url, url);
     
-    self->explain_token = malloc(strlen(token) + 1);
+    self->explain_token = LINX_MALLOC(strlen(token) + 1);
     if (!self->explain_token) {
         LOG_ERROR("Failed to allocate memory for explain token");
-        free(self->explain_url);
+        LINX_FREE(self->explain_url);
         self->explain_url = NULL;
         return -1;
     }
@@ -113,6 +153,201 @@ int camera_interface_explain(CameraInterface* self, const char* question, char*
     return self->vtable->explain(self, question, response, response_size);
 }
 
+int camera_interface_explain_async(CameraInterface* self, const char* question,
+                                   camera_explain_callback_t callback, void* user_data,
+                                   uint32_t* request_id) {
+    if (!self || !question || !callback) {
+        LOG_ERROR("Invalid camera interface, question, or callback");
+        return -1;
+    }
+    if (request_id) {
+        *request_id = 0;
+    }
+    
+    if (self->vtable && self->vtable->explain_async) {
+        return self->vtable->explain_async(self, question, callback, user_data, request_id);
+    }
+    
+    // No asynchronous support: run it now and complete before returning
+    char* response = (char*)LINX_MALLOC(CAMERA_EXPLAIN_RESPONSE_SIZE);
+    if (!response) {
+        LOG_ERROR("Failed to allocate explain response buffer");
+        return -1;
+    }
+    response[0] = '\0';
+    int result = camera_interface_explain(self, question, response, CAMERA_EXPLAIN_RESPONSE_SIZE);
+    callback(result == 0 ? CAMERA_EXPLAIN_OK : CAMERA_EXPLAIN_FAILED, result == 0 ? response : NULL, user_data);
+    LINX_FREE(response);
+    return 0;
+}
+
+int camera_interface_cancel_explain(CameraInterface* self, uint32_t request_id) {
+    if (!self || !self->vtable || !self->vtable->cancel_explain) {
+        return -1;
+    }
+    return self->vtable->cancel_explain(self, request_id);
+}
+
+/**
+ * Explain request behind a future: one reference for the explain callback,
+ * one for the future's canceller
+ */
+typedef struct {
+    CameraInterface* camera;
+    uint32_t request_id;
+    linx_future_t* future;
+    int refs;
+} CameraExplainFuture;
+
+static void camera_explain_future_release(CameraExplainFuture* pending) {
+    if (__atomic_sub_fetch(&pending->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+        linx_future_release(pending->future);
+        LINX_FREE(pending);
+    }
+}
+
+static void camera_explain_future_done(CameraExplainStatus status, const char* response, void* user_data) {
+    CameraExplainFuture* pending = (CameraExplainFuture*)user_data;
+    linx_future_complete(pending->future, status, response, response ? strlen(response) + 1 : 0);
+    camera_explain_future_release(pending);
+}
+
+static void camera_explain_future_cancel(void* user_data, bool cancelled) {
+    CameraExplainFuture* pending = (CameraExplainFuture*)user_data;
+    if (cancelled) {
+        camera_interface_cancel_explain(pending->camera, pending->request_id);
+    }
+    camera_explain_future_release(pending);
+}
+
+linx_future_t* camera_interface_explain_future(CameraInterface* self, const char* question) {
+    if (!self || !question) {
+        LOG_ERROR("Invalid camera interface or question");
+        return NULL;
+    }
+    
+    CameraExplainFuture* pending = (CameraExplainFuture*)LINX_CALLOC(1, sizeof(CameraExplainFuture));
+    linx_future_t* future = linx_future_create();
+    if (!pending || !future) {
+        LOG_ERROR("Failed to allocate explain future");
+        LINX_FREE(pending);
+        linx_future_release(future);
+        return NULL;
+    }
+    pending->camera = self;
+    pending->future = linx_future_retain(future);
+    pending->refs = 2;
+    
+    if (camera_interface_explain_async(self, question, camera_explain_future_done, pending,
+                                       &pending->request_id) != 0) {
+        linx_future_release(pending->future);
+        LINX_FREE(pending);
+        linx_future_release(future);
+        return NULL;
+    }
+    // Runs the canceller right away if the request already completed
+    linx_future_set_canceller(future, camera_explain_future_cancel, pending);
+    return future;
+}
+
+/**
+ * Blocking wait on an asynchronous explain request
+ */
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    bool done;
+    CameraExplainStatus status;
+    char* response;
+    size_t response_size;
+} CameraExplainWaiter;
+
+static void camera_explain_waiter_done(CameraExplainStatus status, const char* response, void* user_data) {
+    CameraExplainWaiter* waiter = (CameraExplainWaiter*)user_data;
+    
+    pthread_mutex_lock(&waiter->mutex);
+    if (status == CAMERA_EXPLAIN_OK && response) {
+        size_t length = strlen(response);
+        if (length >= waiter->response_size) {
+            length = waiter->response_size - 1;
+        }
+        memcpy(waiter->response, response, length);
+        waiter->response[length] = '\0';
+    }
+    waiter->status = status;
+    waiter->done = true;
+    pthread_cond_signal(&waiter->cond);
+    pthread_mutex_unlock(&waiter->mutex);
+}
+
+int camera_interface_explain_timed(CameraInterface* self, const char* question,
+                                   char* response, size_t response_size, uint32_t timeout_ms) {
+    if (!self || !question || !response || response_size == 0) {
+        LOG_ERROR("Invalid camera interface, question, response buffer, or size");
+        return CAMERA_EXPLAIN_FAILED;
+    }
+    
+    CameraExplainWaiter waiter;
+    memset(&waiter, 0, sizeof(waiter));
+    pthread_mutex_init(&waiter.mutex, NULL);
+    pthread_cond_init(&waiter.cond, NULL);
+    waiter.status = CAMERA_EXPLAIN_FAILED;
+    waiter.response = response;
+    waiter.response_size = response_size;
+    response[0] = '\0';
+    
+    uint32_t request_id = 0;
+    if (camera_interface_explain_async(self, question, camera_explain_waiter_done, &waiter, &request_id) != 0) {
+        pthread_cond_destroy(&waiter.cond);
+        pthread_mutex_destroy(&waiter.mutex);
+        return CAMERA_EXPLAIN_FAILED;
+    }
+    
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    
+    pthread_mutex_lock(&waiter.mutex);
+    while (!waiter.done) {
+        if (timeout_ms == 0) {
+            pthread_cond_wait(&waiter.cond, &waiter.mutex);
+        } else if (pthread_cond_timedwait(&waiter.cond, &waiter.mutex, &deadline) == ETIMEDOUT && !waiter.done) {
+            pthread_mutex_unlock(&waiter.mutex);
+            camera_interface_cancel_explain(self, request_id);
+            pthread_mutex_lock(&waiter.mutex);
+            // The callback still runs (as cancelled); `waiter` must outlive it
+            while (!waiter.done) {
+                pthread_cond_wait(&waiter.cond, &waiter.mutex);
+            }
+            if (waiter.status == CAMERA_EXPLAIN_CANCELLED) {
+                waiter.status = CAMERA_EXPLAIN_TIMEOUT;
+            }
+        }
+    }
+    CameraExplainStatus status = waiter.status;
+    pthread_mutex_unlock(&waiter.mutex);
+    
+    pthread_cond_destroy(&waiter.cond);
+    pthread_mutex_destroy(&waiter.mutex);
+    
+    if (status == CAMERA_EXPLAIN_TIMEOUT) {
+        LOG_WARN("Explain request %u timed out after %u ms", request_id, timeout_ms);
+    }
+    return status == CAMERA_EXPLAIN_OK ? 0 : (int)status;
+}
+
+struct mcp_buffer* camera_interface_share_frame(const CameraFrameBuffer* frame) {
+    if (!frame || !frame->data || !frame->buffer) {
+        return NULL;
+    }
+    return mcp_buffer_retain(frame->buffer);
+}
+
 int camera_interface_release_frame(CameraInterface* self, CameraFrameBuffer* frame) {
     if (!self || !frame) {
         LOG_ERROR("Invalid camera interface or frame buffer");
@@ -126,6 +361,7 @@ int camera_interface_release_frame(CameraInterface* self, CameraFrameBuffer* fra
     // Default implementation: just clear the frame buffer
     if (frame->data) {
         frame->data = NULL;
+        frame->buffer = NULL;
         frame->size = 0;
         frame->width = 0;
         frame->height = 0;
@@ -143,11 +379,11 @@ int camera_interface_destroy(CameraInterface* self) {
     
     // Free explain URL and token
     if (self->explain_url) {
-        free(self->explain_url);
+        LINX_FREE(self->explain_url);
         self->explain_url = NULL;
     }
     if (self->explain_token) {
-        free(self->explain_token);
+        LINX_FREE(self->explain_token);
         self->explain_token = NULL;
     }
     
@@ -4,6 +4,8 @@
 #include <stddef.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include "camera_scale.h"
+#include "../linx_future.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -14,6 +16,8 @@ extern "C" {
  */
 typedef struct CameraInterface CameraInterface;
 
+struct mcp_buffer;  // Reference-counted buffer shared with sdk/mcp (mcp/mcp_buffer.h)
+
 /**
  * Camera frame buffer structure
  */
@@ -23,10 +27,34 @@ typedef struct {
     int width;          // Image width in pixels
     int height;         // Image height in pixels
     int format;         // Image format (JPEG, RGB, etc.)
+    struct mcp_buffer* buffer;  // Shared buffer holding `data`, NULL if the backend has none
 } CameraFrameBuffer;
 
+/**
+ * Uncompressed pixels lent to a preview sink, valid only during the call
+ */
+typedef struct {
+    const uint8_t* data;
+    size_t stride;                      // Bytes per row
+    int width;
+    int height;
+    camera_pixel_format_t format;       // CAMERA_PIXEL_RGB24 or CAMERA_PIXEL_BGRA32
+} CameraPixels;
+
+typedef void (*camera_preview_sink_t)(const CameraPixels* pixels, void* user_data);
+
+#define CAMERA_EXPLAIN_DEFAULT_MAX_SIZE 512   // Longest side sent to the explain service
+#define CAMERA_EXPLAIN_DEFAULT_CACHE_MS 10000 // How long an answer is reused for an unchanged scene
+#define CAMERA_EXPLAIN_DEFAULT_CHANGE_THRESHOLD 6   // Mean luma difference (0-255) that counts as a change
+
 /**
  * Camera configuration structure
+ *
+ * Explain requests capture, downscale (camera_scale.h) and re-encode the
+ * image before upload, since vision models rarely use more than ~512px.
+ * The same question about a scene that has not changed since a recent
+ * answer gets that answer again without an upload (camera_scene.h).
+ * Zero-initialized explain fields select the defaults.
  */
 typedef struct {
     int width;          // Image width
@@ -35,8 +63,31 @@ typedef struct {
     int format;         // Image format
     bool h_mirror;      // Horizontal mirror
     bool v_flip;        // Vertical flip
+    int explain_max_size;   // Longest side for explain images: 0 = default, < 0 = full resolution
+    int explain_quality;    // JPEG quality for explain images (1-100), 0 = use `quality`
+    int explain_cache_ms;   // Reuse window for answers to unchanged scenes: 0 = default, < 0 = always ask
+    int explain_change_threshold;   // Mean luma difference that counts as a changed scene, 0 = default
 } CameraConfig;
 
+#define CAMERA_EXPLAIN_RESPONSE_SIZE 4096     // Response buffer for asynchronous explain
+
+/**
+ * Outcome of an asynchronous explain request
+ */
+typedef enum {
+    CAMERA_EXPLAIN_OK = 0,
+    CAMERA_EXPLAIN_FAILED = -1,
+    CAMERA_EXPLAIN_CANCELLED = -2,
+    CAMERA_EXPLAIN_TIMEOUT = -3
+} CameraExplainStatus;
+
+/**
+ * Explain completion callback
+ * Runs on the implementation's explain thread; `response` is NULL unless
+ * status is CAMERA_EXPLAIN_OK and is only valid during the call.
+ */
+typedef void (*camera_explain_callback_t)(CameraExplainStatus status, const char* response, void* user_data);
+
 /**
  * Camera interface function pointers
  */
@@ -50,6 +101,13 @@ typedef struct {
     int (*explain)(CameraInterface* self, const char* question, char* response, size_t response_size);
     int (*release_frame)(CameraInterface* self, CameraFrameBuffer* frame);
     int (*destroy)(CameraInterface* self);
+    // Optional: queue an explain request and return at once
+    int (*explain_async)(CameraInterface* self, const char* question,
+                         camera_explain_callback_t callback, void* user_data, uint32_t* request_id);
+    // Optional: cancel a queued or running explain request
+    int (*cancel_explain)(CameraInterface* self, uint32_t request_id);
+    // Optional: lend the newest frame's pixels to a sink without encoding or copying
+    int (*preview)(CameraInterface* self, int timeout_ms, camera_preview_sink_t sink, void* user_data);
 } CameraInterfaceVTable;
 
 /**
@@ -94,6 +152,21 @@ int camera_interface_set_config(CameraInterface* self, const CameraConfig* confi
  */
 int camera_interface_capture(CameraInterface* self, CameraFrameBuffer* frame);
 
+/**
+ * Hand the newest frame to `sink` as uncompressed pixels, for display previews
+ *
+ * Backends with a preview op lend their own frame memory (no JPEG encode, no
+ * copy); the sink runs on the calling thread and must not keep the pointer.
+ * Otherwise a frame is captured and passed on if it is uncompressed RGB.
+ *
+ * @param self Camera interface instance
+ * @param timeout_ms How long to wait when no frame has arrived yet
+ * @param sink Receives the pixels
+ * @param user_data Passed to the sink
+ * @return 0 if the sink was called, negative on error
+ */
+int camera_interface_preview(CameraInterface* self, int timeout_ms, camera_preview_sink_t sink, void* user_data);
+
 /**
  * Set horizontal mirror
  * @param self Camera interface instance
@@ -129,6 +202,75 @@ int camera_interface_set_explain_url(CameraInterface* self, const char* url, con
  */
 int camera_interface_explain(CameraInterface* self, const char* question, char* response, size_t response_size);
 
+/**
+ * Explain an image without blocking the caller
+ *
+ * The callback is invoked exactly once, also when the request is cancelled
+ * or the camera is destroyed first. Implementations without asynchronous
+ * support run the request synchronously and call back before returning.
+ *
+ * @param self Camera interface instance
+ * @param question Question to ask about the image (copied)
+ * @param callback Completion callback
+ * @param user_data Passed to the callback
+ * @param request_id Request handle for camera_interface_cancel_explain (output, may be NULL)
+ * @return 0 if the request was accepted, negative on error (no callback)
+ */
+int camera_interface_explain_async(CameraInterface* self, const char* question,
+                                   camera_explain_callback_t callback, void* user_data,
+                                   uint32_t* request_id);
+
+/**
+ * Cancel an explain request; its callback reports CAMERA_EXPLAIN_CANCELLED
+ * @param self Camera interface instance
+ * @param request_id Handle from camera_interface_explain_async
+ * @return 0 if the request was still pending, negative otherwise
+ */
+int camera_interface_cancel_explain(CameraInterface* self, uint32_t request_id);
+
+/**
+ * Explain with a deadline, cancelling the request when it passes
+ *
+ * Meant for async MCP tools: pass the tool's timeout so the worker thread is
+ * released when the server has already answered the call with a timeout.
+ *
+ * @param self Camera interface instance
+ * @param question Question to ask about the image
+ * @param response Buffer to store the response
+ * @param response_size Size of the response buffer
+ * @param timeout_ms Deadline in milliseconds, 0 for none
+ * @return 0 on success, negative on error (CameraExplainStatus values)
+ */
+int camera_interface_explain_timed(CameraInterface* self, const char* question,
+                                   char* response, size_t response_size, uint32_t timeout_ms);
+
+/**
+ * Explain an image and return a future for the answer
+ *
+ * The future completes on the thread that runs the explain callback. Its
+ * status is a CameraExplainStatus; on CAMERA_EXPLAIN_OK its data is the
+ * NUL-terminated response. Cancelling the future cancels the request.
+ *
+ * @param self Camera interface instance
+ * @param question Question to ask about the image (copied)
+ * @return Future (drop with linx_future_release), or NULL if the request was
+ *         not accepted
+ */
+linx_future_t* camera_interface_explain_future(CameraInterface* self, const char* question);
+
+/**
+ * Take a reference to a captured frame's memory
+ *
+ * The reference outlives camera_interface_release_frame, so the frame can be
+ * handed on without copying, e.g. as an MCP tool result with
+ * mcp_image_content_create_shared(). The backend gets the memory back once
+ * the last reference is released.
+ * @param frame Frame from camera_interface_capture
+ * @return New reference (drop with mcp_buffer_release), or NULL if the
+ *         backend does not share frame memory and the data must be copied
+ */
+struct mcp_buffer* camera_interface_share_frame(const CameraFrameBuffer* frame);
+
 /**
  * Release frame buffer
  * @param self Camera interface instance
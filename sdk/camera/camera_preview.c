@@ -0,0 +1,275 @@
+#include "camera_preview.h"
+#include "camera_scale.h"
+#include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
+#include <pthread.h>
+#include <string.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_CAMERA);
+
+typedef enum {
+    PREVIEW_SLOT_FREE = 0,
+    PREVIEW_SLOT_WRITING,       // Owned by the producer
+    PREVIEW_SLOT_READY,         // Newest converted frame, not shown yet
+    PREVIEW_SLOT_SHOWN          // Source of the image widget
+} preview_slot_state_t;
+
+typedef struct {
+    lv_draw_buf_t* buf;
+    preview_slot_state_t state;
+    void* scratch;              // camera_scale_convert row buffers, owned by the writer
+    size_t scratch_size;
+} preview_slot_t;
+
+struct camera_preview {
+    lv_obj_t* image;
+    camera_pixel_format_t format;
+    int32_t width;
+    int32_t height;
+    void (*frame_ready)(camera_preview_t* preview, void* user_data);
+    void* user_data;
+
+    pthread_mutex_t mutex;      // Slot states, ready/shown and stats
+    preview_slot_t slots[CAMERA_PREVIEW_MAX_BUFFERS];
+    int slot_count;
+    int ready;                  // READY slot, -1 if none
+    int shown;                  // SHOWN slot, -1 if none
+    camera_preview_stats_t stats;
+};
+
+camera_preview_config_t camera_preview_default_config(void) {
+    camera_preview_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.width = 320;
+    config.height = 240;
+    config.color_format = LV_COLOR_FORMAT_UNKNOWN;
+    config.buffer_count = CAMERA_PREVIEW_DEFAULT_BUFFERS;
+    return config;
+}
+
+/* Largest size within the preview area with the frame's aspect ratio; never upscales */
+static void preview_fit(const camera_preview_t* preview, int src_w, int src_h, int* dst_w, int* dst_h) {
+    if (src_w <= preview->width && src_h <= preview->height) {
+        *dst_w = src_w;
+        *dst_h = src_h;
+        return;
+    }
+    if ((int64_t)src_w * preview->height >= (int64_t)src_h * preview->width) {
+        *dst_w = preview->width;
+        *dst_h = (int)(((int64_t)src_h * preview->width + src_w / 2) / src_w);
+    } else {
+        *dst_h = preview->height;
+        *dst_w = (int)(((int64_t)src_w * preview->height + src_h / 2) / src_h);
+    }
+    if (*dst_w < 1) {
+        *dst_w = 1;
+    }
+    if (*dst_h < 1) {
+        *dst_h = 1;
+    }
+}
+
+camera_preview_t* camera_preview_create(lv_obj_t* parent, const camera_preview_config_t* config) {
+    if (!parent || !config || config->width <= 0 || config->height <= 0) {
+        LOG_ERROR("Invalid camera preview parameters");
+        return NULL;
+    }
+
+    lv_color_format_t cf = config->color_format;
+    if (cf == LV_COLOR_FORMAT_UNKNOWN) {
+        lv_display_t* display = lv_obj_get_display(parent);
+        cf = display ? lv_display_get_color_format(display) : LV_COLOR_FORMAT_RGB565;
+    }
+    camera_pixel_format_t format;
+    if (cf == LV_COLOR_FORMAT_RGB565) {
+        format = CAMERA_PIXEL_RGB565;
+    } else if (cf == LV_COLOR_FORMAT_ARGB8888 || cf == LV_COLOR_FORMAT_XRGB8888) {
+        format = CAMERA_PIXEL_BGRA32;
+    } else {
+        LOG_ERROR("Camera preview does not support color format %d", (int)cf);
+        return NULL;
+    }
+
+    int count = config->buffer_count ? config->buffer_count : CAMERA_PREVIEW_DEFAULT_BUFFERS;
+    if (count < 2 || count > CAMERA_PREVIEW_MAX_BUFFERS) {
+        LOG_ERROR("Camera preview needs 2..%d buffers, got %d", CAMERA_PREVIEW_MAX_BUFFERS, count);
+        return NULL;
+    }
+
+    camera_preview_t* preview = (camera_preview_t*)LINX_CALLOC(1, sizeof(camera_preview_t));
+    if (!preview) {
+        LOG_ERROR("Failed to allocate camera preview");
+        return NULL;
+    }
+    preview->format = format;
+    preview->width = config->width;
+    preview->height = config->height;
+    preview->frame_ready = config->frame_ready;
+    preview->user_data = config->user_data;
+    preview->slot_count = count;
+    preview->ready = -1;
+    preview->shown = -1;
+    pthread_mutex_init(&preview->mutex, NULL);
+
+    for (int i = 0; i < count; i++) {
+        preview->slots[i].buf = lv_draw_buf_create((uint32_t)config->width, (uint32_t)config->height, cf, 0);
+        if (!preview->slots[i].buf) {
+            LOG_ERROR("Failed to allocate %dx%d camera preview buffer", (int)config->width, (int)config->height);
+            camera_preview_delete(preview);
+            return NULL;
+        }
+    }
+
+    preview->image = lv_image_create(parent);
+    if (!preview->image) {
+        camera_preview_delete(preview);
+        return NULL;
+    }
+
+    LOG_INFO("Camera preview %dx%d, format %d, %d buffers",
+             (int)config->width, (int)config->height, (int)cf, count);
+    return preview;
+}
+
+void camera_preview_delete(camera_preview_t* preview) {
+    if (!preview) {
+        return;
+    }
+    if (preview->image) {
+        lv_obj_delete(preview->image);
+    }
+    for (int i = 0; i < preview->slot_count; i++) {
+        if (preview->slots[i].buf) {
+            lv_image_cache_drop(preview->slots[i].buf);
+            lv_draw_buf_destroy(preview->slots[i].buf);
+        }
+        LINX_FREE(preview->slots[i].scratch);
+    }
+    pthread_mutex_destroy(&preview->mutex);
+    LINX_FREE(preview);
+}
+
+int camera_preview_submit(camera_preview_t* preview, const CameraPixels* pixels) {
+    if (!preview || !pixels || !pixels->data || pixels->width <= 0 || pixels->height <= 0) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&preview->mutex);
+    int index = -1;
+    for (int i = 0; i < preview->slot_count; i++) {
+        if (preview->slots[i].state == PREVIEW_SLOT_FREE) {
+            index = i;
+            break;
+        }
+    }
+    if (index < 0) {
+        preview->stats.busy++;
+        pthread_mutex_unlock(&preview->mutex);
+        return -1;
+    }
+    preview_slot_t* slot = &preview->slots[index];
+    slot->state = PREVIEW_SLOT_WRITING;
+    pthread_mutex_unlock(&preview->mutex);
+
+    // The slot is ours until it is published: convert without holding the lock
+    int dst_w = 0;
+    int dst_h = 0;
+    preview_fit(preview, pixels->width, pixels->height, &dst_w, &dst_h);
+    int result = 0;
+    size_t needed = camera_scale_convert_scratch_size(pixels->format, pixels->width, dst_w);
+    if (needed > slot->scratch_size) {
+        LINX_FREE(slot->scratch);
+        slot->scratch = LINX_MALLOC(needed);
+        slot->scratch_size = slot->scratch ? needed : 0;
+        if (!slot->scratch) {
+            LOG_ERROR("Failed to allocate camera preview scratch (%zu bytes)", needed);
+            result = -1;
+        }
+    }
+    if (result == 0) {
+        lv_draw_buf_t* buf = slot->buf;
+        result = camera_scale_convert(pixels->data, pixels->format, pixels->width, pixels->height, pixels->stride,
+                                      buf->data, preview->format, dst_w, dst_h, buf->header.stride,
+                                      slot->scratch);
+        if (result == 0) {
+            // Same stride and allocation, only the visible size follows the frame
+            buf->header.w = (uint32_t)dst_w;
+            buf->header.h = (uint32_t)dst_h;
+        }
+    }
+
+    pthread_mutex_lock(&preview->mutex);
+    if (result == 0) {
+        if (preview->ready >= 0) {
+            preview->slots[preview->ready].state = PREVIEW_SLOT_FREE;
+            preview->stats.replaced++;
+        }
+        slot->state = PREVIEW_SLOT_READY;
+        preview->ready = index;
+        preview->stats.submitted++;
+    } else {
+        slot->state = PREVIEW_SLOT_FREE;
+    }
+    pthread_mutex_unlock(&preview->mutex);
+
+    if (result == 0 && preview->frame_ready) {
+        preview->frame_ready(preview, preview->user_data);
+    }
+    return result;
+}
+
+static void camera_preview_sink(const CameraPixels* pixels, void* user_data) {
+    camera_preview_submit((camera_preview_t*)user_data, pixels);
+}
+
+int camera_preview_update(camera_preview_t* preview, CameraInterface* camera, int timeout_ms) {
+    if (!preview || !camera) {
+        return -1;
+    }
+    return camera_interface_preview(camera, timeout_ms, camera_preview_sink, preview);
+}
+
+bool camera_preview_present(camera_preview_t* preview) {
+    if (!preview) {
+        return false;
+    }
+
+    pthread_mutex_lock(&preview->mutex);
+    int index = preview->ready;
+    if (index < 0) {
+        pthread_mutex_unlock(&preview->mutex);
+        return false;
+    }
+    preview->ready = -1;
+    preview->slots[index].state = PREVIEW_SLOT_SHOWN;
+    int previous = preview->shown;
+    preview->shown = index;
+    pthread_mutex_unlock(&preview->mutex);
+
+    // Buffers are reused with new contents: never let a decoder cache entry outlive a frame
+    lv_draw_buf_t* buf = preview->slots[index].buf;
+    lv_image_cache_drop(buf);
+    lv_image_set_src(preview->image, buf);
+
+    // Rendering happens on this thread, so the old buffer is unreferenced now
+    pthread_mutex_lock(&preview->mutex);
+    if (previous >= 0) {
+        preview->slots[previous].state = PREVIEW_SLOT_FREE;
+    }
+    preview->stats.presented++;
+    pthread_mutex_unlock(&preview->mutex);
+    return true;
+}
+
+lv_obj_t* camera_preview_get_obj(camera_preview_t* preview) {
+    return preview ? preview->image : NULL;
+}
+
+void camera_preview_get_stats(camera_preview_t* preview, camera_preview_stats_t* stats) {
+    if (!preview || !stats) {
+        return;
+    }
+    pthread_mutex_lock(&preview->mutex);
+    *stats = preview->stats;
+    pthread_mutex_unlock(&preview->mutex);
+}
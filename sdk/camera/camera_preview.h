@@ -0,0 +1,111 @@
+#ifndef CAMERA_PREVIEW_H
+#define CAMERA_PREVIEW_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "lvgl.h"
+#include "camera_interface.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Live camera preview on an LVGL image
+ *
+ * Frames go from the camera's own memory (camera_interface_preview) straight
+ * into a pooled lv_draw_buf_t in the display's native format: one fused
+ * downscale + colour conversion pass (camera_scale_convert) writes the
+ * preview-sized pixels, and the image widget is pointed at that buffer. No
+ * JPEG is encoded or decoded and no intermediate image is made.
+ *
+ * Producer and LVGL thread never touch the same buffer: with the default
+ * three buffers one is on screen, one holds the newest converted frame and
+ * one is being written, so a producer running at the camera rate never
+ * waits for the UI. A frame that is replaced before it was shown is simply
+ * overwritten by the next one.
+ *
+ * Threads: create, delete, present and get_obj on the LVGL thread; submit
+ * and update from any one producer thread.
+ */
+
+#define CAMERA_PREVIEW_MAX_BUFFERS      4
+#define CAMERA_PREVIEW_DEFAULT_BUFFERS  3
+
+typedef struct camera_preview camera_preview_t;
+
+/**
+ * Preview configuration
+ */
+typedef struct {
+    int32_t width;                      // Preview area; frames are fitted inside, keeping the aspect ratio
+    int32_t height;
+    lv_color_format_t color_format;     // RGB565, ARGB8888 or XRGB8888; UNKNOWN = default display's format
+    uint8_t buffer_count;               // Pooled draw buffers (2..CAMERA_PREVIEW_MAX_BUFFERS), 0 = default
+    // Called on the producer thread when a frame is ready to present, e.g. to
+    // post camera_preview_present to the LVGL thread (may be NULL)
+    void (*frame_ready)(camera_preview_t* preview, void* user_data);
+    void* user_data;
+} camera_preview_config_t;
+
+/**
+ * Preview statistics
+ */
+typedef struct {
+    uint32_t submitted;     // Frames converted into the pool
+    uint32_t presented;     // Frames put on screen
+    uint32_t replaced;      // Converted frames replaced by a newer one before being shown
+    uint32_t busy;          // Frames dropped because no buffer was free
+} camera_preview_stats_t;
+
+/**
+ * Default configuration: 320x240, display format, three buffers
+ */
+camera_preview_config_t camera_preview_default_config(void);
+
+/**
+ * Create the preview image and allocate its draw buffers (LVGL thread)
+ * @return Preview, or NULL on error
+ */
+camera_preview_t* camera_preview_create(lv_obj_t* parent, const camera_preview_config_t* config);
+
+/**
+ * Delete the image and free the pool (LVGL thread; stop the producer first)
+ */
+void camera_preview_delete(camera_preview_t* preview);
+
+/**
+ * Convert a frame into a free pool buffer and mark it ready (producer thread)
+ * @return 0 on success, negative if the frame was dropped or invalid
+ */
+int camera_preview_submit(camera_preview_t* preview, const CameraPixels* pixels);
+
+/**
+ * Fetch the newest camera frame and submit it (producer thread)
+ * @param timeout_ms How long to wait when the camera has no frame yet
+ * @return 0 on success, negative on error
+ */
+int camera_preview_update(camera_preview_t* preview, CameraInterface* camera, int timeout_ms);
+
+/**
+ * Show the newest ready frame, if any (LVGL thread)
+ * @return true if the image changed
+ */
+bool camera_preview_present(camera_preview_t* preview);
+
+/**
+ * Image widget, for layout
+ */
+lv_obj_t* camera_preview_get_obj(camera_preview_t* preview);
+
+/**
+ * Get statistics (any thread)
+ */
+void camera_preview_get_stats(camera_preview_t* preview, camera_preview_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAMERA_PREVIEW_H
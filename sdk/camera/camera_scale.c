@@ -0,0 +1,464 @@
+#include "camera_scale.h"
+#include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
+#include <stdlib.h>
+#include <string.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_CAMERA);
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define CAMERA_SCALE_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CAMERA_SCALE_SSE2 1
+#endif
+
+#define CAMERA_SCALE_MAX_BOX_ROWS   257     // 257 * 255 still fits the 16-bit row sums
+
+bool camera_scale_fit(int src_w, int src_h, int max_size, int* dst_w, int* dst_h) {
+    int longest = src_w > src_h ? src_w : src_h;
+    if (max_size <= 0 || longest <= max_size) {
+        *dst_w = src_w;
+        *dst_h = src_h;
+        return false;
+    }
+    if (src_w >= src_h) {
+        *dst_w = max_size;
+        *dst_h = (int)(((int64_t)src_h * max_size + src_w / 2) / src_w);
+    } else {
+        *dst_h = max_size;
+        *dst_w = (int)(((int64_t)src_w * max_size + src_h / 2) / src_h);
+    }
+    if (*dst_w < 1) {
+        *dst_w = 1;
+    }
+    if (*dst_h < 1) {
+        *dst_h = 1;
+    }
+    return true;
+}
+
+/* acc[i] += row[i] */
+static void scale_accumulate_row(uint16_t* acc, const uint8_t* row, size_t count) {
+    size_t i = 0;
+#if defined(CAMERA_SCALE_NEON)
+    for (; i + 16 <= count; i += 16) {
+        uint8x16_t v = vld1q_u8(row + i);
+        vst1q_u16(acc + i, vaddw_u8(vld1q_u16(acc + i), vget_low_u8(v)));
+        vst1q_u16(acc + i + 8, vaddw_u8(vld1q_u16(acc + i + 8), vget_high_u8(v)));
+    }
+#elif defined(CAMERA_SCALE_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= count; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(row + i));
+        __m128i lo = _mm_loadu_si128((const __m128i*)(acc + i));
+        __m128i hi = _mm_loadu_si128((const __m128i*)(acc + i + 8));
+        _mm_storeu_si128((__m128i*)(acc + i), _mm_add_epi16(lo, _mm_unpacklo_epi8(v, zero)));
+        _mm_storeu_si128((__m128i*)(acc + i + 8), _mm_add_epi16(hi, _mm_unpackhi_epi8(v, zero)));
+    }
+#endif
+    for (; i < count; i++) {
+        acc[i] = (uint16_t)(acc[i] + row[i]);
+    }
+}
+
+/* out[i] = a[i] * (256 - f) + b[i] * f, f in 0..256 */
+static void scale_blend_rows(uint16_t* out, const uint8_t* a, const uint8_t* b, unsigned int f, size_t count) {
+    size_t i = 0;
+    const unsigned int g = 256 - f;
+#if defined(CAMERA_SCALE_NEON)
+    // f or g may be 256, which does not fit a u8 lane: blend as a * 256 + (b - a) * f
+    if (f < 256 && g < 256) {
+        uint8x8_t vf = vdup_n_u8((uint8_t)f);
+        uint8x8_t vg = vdup_n_u8((uint8_t)g);
+        for (; i + 8 <= count; i += 8) {
+            uint16x8_t v = vmull_u8(vld1_u8(a + i), vg);
+            v = vmlal_u8(v, vld1_u8(b + i), vf);
+            vst1q_u16(out + i, v);
+        }
+    }
+#elif defined(CAMERA_SCALE_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i vf = _mm_set1_epi16((short)f);
+    const __m128i vg = _mm_set1_epi16((short)g);
+    for (; i + 8 <= count; i += 8) {
+        __m128i va = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(a + i)), zero);
+        __m128i vb = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(b + i)), zero);
+        // Products stay below 65536, so the low 16 bits are exact
+        _mm_storeu_si128((__m128i*)(out + i),
+                         _mm_add_epi16(_mm_mullo_epi16(va, vg), _mm_mullo_epi16(vb, vf)));
+    }
+#endif
+    for (; i < count; i++) {
+        out[i] = (uint16_t)(a[i] * g + b[i] * f);
+    }
+}
+
+/**
+ * Average `fx` x `fy` blocks; output is (src_w / fx) x (src_h / fy), packed
+ */
+static int scale_box(const uint8_t* src, int src_w, int src_h, size_t src_stride,
+                     int fx, int fy, uint8_t* out) {
+    int out_w = src_w / fx;
+    int out_h = src_h / fy;
+    size_t row_len = (size_t)out_w * fx * 3;
+    uint16_t* acc = (uint16_t*)LINX_MALLOC(row_len * sizeof(uint16_t));
+    if (!acc) {
+        return -1;
+    }
+    const uint32_t area = (uint32_t)fx * (uint32_t)fy;
+
+    for (int oy = 0; oy < out_h; oy++) {
+        memset(acc, 0, row_len * sizeof(uint16_t));
+        for (int r = 0; r < fy; r++) {
+            scale_accumulate_row(acc, src + (size_t)(oy * fy + r) * src_stride, row_len);
+        }
+        uint8_t* dst = out + (size_t)oy * out_w * 3;
+        const uint16_t* p = acc;
+        for (int ox = 0; ox < out_w; ox++) {
+            uint32_t s0 = 0, s1 = 0, s2 = 0;
+            for (int c = 0; c < fx; c++, p += 3) {
+                s0 += p[0];
+                s1 += p[1];
+                s2 += p[2];
+            }
+            dst[ox * 3 + 0] = (uint8_t)((s0 + area / 2) / area);
+            dst[ox * 3 + 1] = (uint8_t)((s1 + area / 2) / area);
+            dst[ox * 3 + 2] = (uint8_t)((s2 + area / 2) / area);
+        }
+    }
+
+    LINX_FREE(acc);
+    return 0;
+}
+
+/**
+ * Bilinear resample with pixel centres aligned (8-bit weights)
+ */
+static int scale_bilinear(const uint8_t* src, int src_w, int src_h, size_t src_stride,
+                          uint8_t* dst, int dst_w, int dst_h, size_t dst_stride) {
+    size_t row_len = (size_t)src_w * 3;
+    uint16_t* blend = (uint16_t*)LINX_MALLOC(row_len * sizeof(uint16_t));
+    int32_t* x0 = (int32_t*)LINX_MALLOC((size_t)dst_w * sizeof(int32_t));
+    uint16_t* xf = (uint16_t*)LINX_MALLOC((size_t)dst_w * sizeof(uint16_t));
+    if (!blend || !x0 || !xf) {
+        LINX_FREE(blend);
+        LINX_FREE(x0);
+        LINX_FREE(xf);
+        return -1;
+    }
+
+    // Source x for each destination column, in 1/256 pixel
+    for (int x = 0; x < dst_w; x++) {
+        int64_t sx = ((int64_t)(2 * x + 1) * src_w * 256) / (2 * dst_w) - 128;
+        if (sx < 0) {
+            sx = 0;
+        }
+        int i = (int)(sx >> 8);
+        int f = (int)(sx & 255);
+        if (i >= src_w - 1) {
+            i = src_w - 1;
+            f = 0;
+        }
+        x0[x] = i * 3;
+        xf[x] = (uint16_t)f;
+    }
+
+    for (int y = 0; y < dst_h; y++) {
+        int64_t sy = ((int64_t)(2 * y + 1) * src_h * 256) / (2 * dst_h) - 128;
+        if (sy < 0) {
+            sy = 0;
+        }
+        int i = (int)(sy >> 8);
+        unsigned int f = (unsigned int)(sy & 255);
+        if (i >= src_h - 1) {
+            i = src_h - 1;
+            f = 0;
+        }
+        const uint8_t* row_a = src + (size_t)i * src_stride;
+        const uint8_t* row_b = f ? row_a + src_stride : row_a;
+        scale_blend_rows(blend, row_a, row_b, f, row_len);
+
+        uint8_t* out = dst + (size_t)y * dst_stride;
+        for (int x = 0; x < dst_w; x++) {
+            const uint16_t* p = blend + x0[x];
+            uint32_t g = xf[x];
+            if (g == 0) {
+                out[x * 3 + 0] = (uint8_t)((p[0] + 128) >> 8);
+                out[x * 3 + 1] = (uint8_t)((p[1] + 128) >> 8);
+                out[x * 3 + 2] = (uint8_t)((p[2] + 128) >> 8);
+            } else {
+                out[x * 3 + 0] = (uint8_t)((p[0] * (256 - g) + p[3] * g + 32768) >> 16);
+                out[x * 3 + 1] = (uint8_t)((p[1] * (256 - g) + p[4] * g + 32768) >> 16);
+                out[x * 3 + 2] = (uint8_t)((p[2] * (256 - g) + p[5] * g + 32768) >> 16);
+            }
+        }
+    }
+
+    LINX_FREE(blend);
+    LINX_FREE(x0);
+    LINX_FREE(xf);
+    return 0;
+}
+
+int camera_scale_rgb24(const uint8_t* src, int src_w, int src_h, size_t src_stride,
+                       uint8_t* dst, int dst_w, int dst_h, size_t dst_stride) {
+    if (!src || !dst || src_w <= 0 || src_h <= 0 || dst_w <= 0 || dst_h <= 0 ||
+        src_stride < (size_t)src_w * 3 || dst_stride < (size_t)dst_w * 3) {
+        LOG_ERROR("Invalid scale parameters");
+        return -1;
+    }
+    if (dst_w > src_w || dst_h > src_h) {
+        LOG_ERROR("Upscaling %dx%d -> %dx%d is not supported", src_w, src_h, dst_w, dst_h);
+        return -1;
+    }
+
+    // Box filter down to within 2x of the target, the bilinear pass does the rest
+    int fx = src_w / dst_w;
+    int fy = src_h / dst_h;
+    if (fy > CAMERA_SCALE_MAX_BOX_ROWS) {
+        fy = CAMERA_SCALE_MAX_BOX_ROWS;
+    }
+    if (fx < 2 && fy < 2) {
+        return scale_bilinear(src, src_w, src_h, src_stride, dst, dst_w, dst_h, dst_stride);
+    }
+
+    int box_w = src_w / fx;
+    int box_h = src_h / fy;
+    uint8_t* box = (uint8_t*)LINX_MALLOC_BULK((size_t)box_w * box_h * 3);
+    if (!box) {
+        LOG_ERROR("Failed to allocate scale buffer");
+        return -1;
+    }
+    int result = scale_box(src, src_w, src_h, src_stride, fx, fy, box);
+    if (result == 0) {
+        if (box_w == dst_w && box_h == dst_h) {
+            for (int y = 0; y < dst_h; y++) {
+                memcpy(dst + (size_t)y * dst_stride, box + (size_t)y * box_w * 3, (size_t)dst_w * 3);
+            }
+        } else {
+            result = scale_bilinear(box, box_w, box_h, (size_t)box_w * 3, dst, dst_w, dst_h, dst_stride);
+        }
+    }
+    LINX_FREE(box);
+    return result;
+}
+
+static int pixel_size(camera_pixel_format_t format) {
+    switch (format) {
+    case CAMERA_PIXEL_RGB24:
+        return 3;
+    case CAMERA_PIXEL_BGRA32:
+        return 4;
+    case CAMERA_PIXEL_RGB565:
+        return 2;
+    }
+    return 0;
+}
+
+static inline uint16_t pack_rgb565(unsigned int r, unsigned int g, unsigned int b) {
+    return (uint16_t)(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+}
+
+static inline void store_pixel(uint8_t* dst, camera_pixel_format_t format,
+                               unsigned int r, unsigned int g, unsigned int b) {
+    if (format == CAMERA_PIXEL_RGB565) {
+        *(uint16_t*)dst = pack_rgb565(r, g, b);
+    } else {
+        dst[0] = (uint8_t)b;
+        dst[1] = (uint8_t)g;
+        dst[2] = (uint8_t)r;
+        dst[3] = 0xFF;
+    }
+}
+
+static void convert_bgra_to_rgb565(const uint8_t* src, uint16_t* dst, int width) {
+    int x = 0;
+#if defined(CAMERA_SCALE_NEON)
+    for (; x + 8 <= width; x += 8) {
+        uint8x8x4_t p = vld4_u8(src + (size_t)x * 4);
+        // Keep the top bits of R, shift-insert G and B below them
+        uint16x8_t v = vshll_n_u8(p.val[2], 8);
+        v = vsriq_n_u16(v, vshll_n_u8(p.val[1], 8), 5);
+        v = vsriq_n_u16(v, vshll_n_u8(p.val[0], 8), 11);
+        vst1q_u16(dst + x, v);
+    }
+#elif defined(CAMERA_SCALE_SSE2)
+    const __m128i mask_r = _mm_set1_epi32(0xF800);
+    const __m128i mask_g = _mm_set1_epi32(0x07E0);
+    const __m128i mask_b = _mm_set1_epi32(0x001F);
+    const __m128i bias32 = _mm_set1_epi32(0x8000);
+    const __m128i bias16 = _mm_set1_epi16((short)0x8000);
+    for (; x + 8 <= width; x += 8) {
+        __m128i lo = _mm_loadu_si128((const __m128i*)(src + (size_t)x * 4));
+        __m128i hi = _mm_loadu_si128((const __m128i*)(src + (size_t)x * 4 + 16));
+        // 0xAARRGGBB lanes -> RGB565 in the low 16 bits
+        lo = _mm_or_si128(_mm_or_si128(_mm_and_si128(_mm_srli_epi32(lo, 8), mask_r),
+                                       _mm_and_si128(_mm_srli_epi32(lo, 5), mask_g)),
+                          _mm_and_si128(_mm_srli_epi32(lo, 3), mask_b));
+        hi = _mm_or_si128(_mm_or_si128(_mm_and_si128(_mm_srli_epi32(hi, 8), mask_r),
+                                       _mm_and_si128(_mm_srli_epi32(hi, 5), mask_g)),
+                          _mm_and_si128(_mm_srli_epi32(hi, 3), mask_b));
+        // The signed pack saturates above 0x7FFF: bias into range and back
+        __m128i packed = _mm_packs_epi32(_mm_sub_epi32(lo, bias32), _mm_sub_epi32(hi, bias32));
+        _mm_storeu_si128((__m128i*)(dst + x), _mm_xor_si128(packed, bias16));
+    }
+#endif
+    for (; x < width; x++) {
+        const uint8_t* p = src + (size_t)x * 4;
+        dst[x] = pack_rgb565(p[2], p[1], p[0]);
+    }
+}
+
+static void convert_rgb24_to_rgb565(const uint8_t* src, uint16_t* dst, int width) {
+    int x = 0;
+#if defined(CAMERA_SCALE_NEON)
+    for (; x + 8 <= width; x += 8) {
+        uint8x8x3_t p = vld3_u8(src + (size_t)x * 3);
+        uint16x8_t v = vshll_n_u8(p.val[0], 8);
+        v = vsriq_n_u16(v, vshll_n_u8(p.val[1], 8), 5);
+        v = vsriq_n_u16(v, vshll_n_u8(p.val[2], 8), 11);
+        vst1q_u16(dst + x, v);
+    }
+#endif
+    for (; x < width; x++) {
+        const uint8_t* p = src + (size_t)x * 3;
+        dst[x] = pack_rgb565(p[0], p[1], p[2]);
+    }
+}
+
+static void convert_rgb24_to_bgra(const uint8_t* src, uint8_t* dst, int width) {
+    int x = 0;
+#if defined(CAMERA_SCALE_NEON)
+    for (; x + 16 <= width; x += 16) {
+        uint8x16x3_t p = vld3q_u8(src + (size_t)x * 3);
+        uint8x16x4_t q;
+        q.val[0] = p.val[2];
+        q.val[1] = p.val[1];
+        q.val[2] = p.val[0];
+        q.val[3] = vdupq_n_u8(0xFF);
+        vst4q_u8(dst + (size_t)x * 4, q);
+    }
+#endif
+    for (; x < width; x++) {
+        const uint8_t* p = src + (size_t)x * 3;
+        uint8_t* q = dst + (size_t)x * 4;
+        q[0] = p[2];
+        q[1] = p[1];
+        q[2] = p[0];
+        q[3] = 0xFF;
+    }
+}
+
+static void convert_row(const uint8_t* src, camera_pixel_format_t src_format,
+                        uint8_t* dst, camera_pixel_format_t dst_format, int width) {
+    if (src_format == CAMERA_PIXEL_BGRA32) {
+        if (dst_format == CAMERA_PIXEL_BGRA32) {
+            memcpy(dst, src, (size_t)width * 4);
+        } else {
+            convert_bgra_to_rgb565(src, (uint16_t*)dst, width);
+        }
+    } else if (dst_format == CAMERA_PIXEL_BGRA32) {
+        convert_rgb24_to_bgra(src, dst, width);
+    } else {
+        convert_rgb24_to_rgb565(src, (uint16_t*)dst, width);
+    }
+}
+
+size_t camera_scale_convert_scratch_size(camera_pixel_format_t src_format, int src_w, int dst_w) {
+    if (src_w <= 0 || dst_w <= 0) {
+        return 0;
+    }
+    // Column bounds and reciprocals first so the row sums stay 16-bit aligned
+    return (size_t)(dst_w + 1) * sizeof(int32_t) + (size_t)dst_w * sizeof(uint32_t) +
+           (size_t)src_w * pixel_size(src_format) * sizeof(uint16_t);
+}
+
+int camera_scale_convert(const uint8_t* src, camera_pixel_format_t src_format,
+                         int src_w, int src_h, size_t src_stride,
+                         uint8_t* dst, camera_pixel_format_t dst_format,
+                         int dst_w, int dst_h, size_t dst_stride, void* scratch) {
+    int bpp = (src_format == CAMERA_PIXEL_RGB24 || src_format == CAMERA_PIXEL_BGRA32) ? pixel_size(src_format) : 0;
+    int out_bpp = (dst_format == CAMERA_PIXEL_RGB565 || dst_format == CAMERA_PIXEL_BGRA32) ? pixel_size(dst_format) : 0;
+    if (!src || !dst || !bpp || !out_bpp || src_w <= 0 || src_h <= 0 || dst_w <= 0 || dst_h <= 0 ||
+        src_stride < (size_t)src_w * bpp || dst_stride < (size_t)dst_w * out_bpp) {
+        LOG_ERROR("Invalid convert parameters");
+        return -1;
+    }
+    if (dst_w > src_w || dst_h > src_h) {
+        LOG_ERROR("Upscaling %dx%d -> %dx%d is not supported", src_w, src_h, dst_w, dst_h);
+        return -1;
+    }
+
+    if (dst_w == src_w && dst_h == src_h) {
+        for (int y = 0; y < dst_h; y++) {
+            convert_row(src + (size_t)y * src_stride, src_format, dst + (size_t)y * dst_stride, dst_format, dst_w);
+        }
+        return 0;
+    }
+
+    void* owned = NULL;
+    if (!scratch) {
+        owned = LINX_MALLOC(camera_scale_convert_scratch_size(src_format, src_w, dst_w));
+        if (!owned) {
+            LOG_ERROR("Failed to allocate convert buffer");
+            return -1;
+        }
+        scratch = owned;
+    }
+    int32_t* x0 = (int32_t*)scratch;
+    uint32_t* recip = (uint32_t*)(x0 + dst_w + 1);
+    uint16_t* acc = (uint16_t*)(recip + dst_w);
+    size_t row_len = (size_t)src_w * bpp;
+    const int r_off = src_format == CAMERA_PIXEL_BGRA32 ? 2 : 0;
+    const int b_off = 2 - r_off;
+
+    // Destination column x averages source columns [x0[x], x0[x + 1])
+    for (int x = 0; x <= dst_w; x++) {
+        x0[x] = (int32_t)(((int64_t)x * src_w) / dst_w);
+    }
+
+    int recip_rows = 0;
+    for (int y = 0; y < dst_h; y++) {
+        int r0 = (int)(((int64_t)y * src_h) / dst_h);
+        int rows = (int)(((int64_t)(y + 1) * src_h) / dst_h) - r0;
+        if (rows > CAMERA_SCALE_MAX_BOX_ROWS) {
+            rows = CAMERA_SCALE_MAX_BOX_ROWS;
+        }
+        if (rows != recip_rows) {
+            // Block areas only change with the row count, which takes at most two values
+            for (int x = 0; x < dst_w; x++) {
+                uint32_t area = (uint32_t)(x0[x + 1] - x0[x]) * (uint32_t)rows;
+                recip[x] = (uint32_t)(((1u << 24) + area / 2) / area);
+            }
+            recip_rows = rows;
+        }
+
+        memset(acc, 0, row_len * sizeof(uint16_t));
+        for (int r = 0; r < rows; r++) {
+            scale_accumulate_row(acc, src + (size_t)(r0 + r) * src_stride, row_len);
+        }
+
+        uint8_t* out = dst + (size_t)y * dst_stride;
+        for (int x = 0; x < dst_w; x++, out += out_bpp) {
+            const uint16_t* p = acc + (size_t)x0[x] * bpp;
+            const uint16_t* end = acc + (size_t)x0[x + 1] * bpp;
+            uint32_t s0 = 0, s1 = 0, s2 = 0;
+            for (; p < end; p += bpp) {
+                s0 += p[0];
+                s1 += p[1];
+                s2 += p[2];
+            }
+            uint64_t k = recip[x];
+            unsigned int c0 = (unsigned int)((s0 * k + (1u << 23)) >> 24);
+            unsigned int c1 = (unsigned int)((s1 * k + (1u << 23)) >> 24);
+            unsigned int c2 = (unsigned int)((s2 * k + (1u << 23)) >> 24);
+            unsigned int c[3] = { c0 > 255 ? 255 : c0, c1 > 255 ? 255 : c1, c2 > 255 ? 255 : c2 };
+            store_pixel(out, dst_format, c[r_off], c[1], c[b_off]);
+        }
+    }
+
+    LINX_FREE(owned);
+    return 0;
+}
@@ -0,0 +1,78 @@
+#ifndef CAMERA_SCALE_H
+#define CAMERA_SCALE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Image downscaling for the capture -> resize -> encode pipeline
+ *
+ * Packed RGB24 is reduced in two steps: an integer box filter (area average
+ * over whole source blocks) takes the image to within 2x of the target, then
+ * a bilinear pass produces the exact size. The box row accumulation and the
+ * vertical bilinear blend use NEON or SSE2 when the target has them; all
+ * backends give identical output.
+ */
+
+/**
+ * Pixel layouts, named by byte order in memory
+ */
+typedef enum {
+    CAMERA_PIXEL_RGB24 = 0,     // R, G, B
+    CAMERA_PIXEL_BGRA32,        // B, G, R, A: CoreVideo 32BGRA, LVGL ARGB8888 / XRGB8888
+    CAMERA_PIXEL_RGB565         // Native-endian uint16 (R in the top 5 bits), LVGL RGB565
+} camera_pixel_format_t;
+
+/**
+ * Size that fits `src_w` x `src_h` into `max_size` on the longer side,
+ * keeping the aspect ratio
+ * @param max_size Longest side in pixels; <= 0 means no limit
+ * @return true if the image has to be scaled
+ */
+bool camera_scale_fit(int src_w, int src_h, int max_size, int* dst_w, int* dst_h);
+
+/**
+ * Downscale packed RGB24
+ * @param src Source pixels
+ * @param src_stride Bytes per source row
+ * @param dst Destination pixels (must not overlap `src`)
+ * @param dst_stride Bytes per destination row
+ * @return 0 on success, negative on error (including upscaling requests)
+ */
+int camera_scale_rgb24(const uint8_t* src, int src_w, int src_h, size_t src_stride,
+                       uint8_t* dst, int dst_w, int dst_h, size_t dst_stride);
+
+/**
+ * Scratch bytes camera_scale_convert needs for a given source width
+ */
+size_t camera_scale_convert_scratch_size(camera_pixel_format_t src_format, int src_w, int dst_w);
+
+/**
+ * Downscale and convert in one pass, for display previews
+ *
+ * Each destination pixel is the average of the source pixels its area
+ * covers (any ratio, no intermediate image), packed straight into the
+ * destination format. Source rows are summed with NEON or SSE2; at 1:1 the
+ * conversion itself is vectorised (BGRA32 -> BGRA32 is a row copy). Sources
+ * are RGB24 or BGRA32, destinations RGB565 or BGRA32 (alpha set to 0xFF,
+ * except that the 1:1 BGRA32 copy keeps the source alpha).
+ *
+ * @param scratch camera_scale_convert_scratch_size() bytes, or NULL to
+ *                allocate for this call
+ * @return 0 on success, negative on error (including upscaling requests)
+ */
+int camera_scale_convert(const uint8_t* src, camera_pixel_format_t src_format,
+                         int src_w, int src_h, size_t src_stride,
+                         uint8_t* dst, camera_pixel_format_t dst_format,
+                         int dst_w, int dst_h, size_t dst_stride, void* scratch);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAMERA_SCALE_H
@@ -0,0 +1,224 @@
+#include "camera_scene.h"
+#include "camera_scale.h"
+#include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
+#include "../log/linx_mem_pressure.h"
+#include "../os/linx_os.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_CAMERA);
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define CAMERA_SCENE_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CAMERA_SCENE_SSE2 1
+#endif
+
+#define CAMERA_SCENE_PIXELS (CAMERA_SCENE_THUMB_SIZE * CAMERA_SCENE_THUMB_SIZE)
+
+typedef struct {
+    camera_scene_signature_t signature;
+    char* question;
+    char* response;
+    uint64_t stored_ms;
+} camera_scene_entry_t;
+
+struct camera_scene_cache {
+    pthread_mutex_t mutex;
+    camera_scene_entry_t entries[CAMERA_SCENE_CACHE_ENTRIES];
+};
+
+int camera_scene_signature_rgb24(const uint8_t* rgb, int width, int height, size_t stride,
+                                 camera_scene_signature_t* signature) {
+    if (!rgb || !signature || width < CAMERA_SCENE_THUMB_SIZE || height < CAMERA_SCENE_THUMB_SIZE) {
+        return -1;
+    }
+
+    uint8_t thumb[CAMERA_SCENE_PIXELS * 3];
+    if (camera_scale_rgb24(rgb, width, height, stride, thumb, CAMERA_SCENE_THUMB_SIZE,
+                           CAMERA_SCENE_THUMB_SIZE, CAMERA_SCENE_THUMB_SIZE * 3) != 0) {
+        return -1;
+    }
+    for (int i = 0; i < CAMERA_SCENE_PIXELS; i++) {
+        const uint8_t* p = thumb + i * 3;
+        signature->luma[i] = (uint8_t)((77 * p[0] + 150 * p[1] + 29 * p[2] + 128) >> 8);
+    }
+
+    // 64 blocks of 2x2 pixels, each compared with the mean of the thumbnail
+    unsigned int blocks[64];
+    unsigned int total = 0;
+    for (int by = 0; by < 8; by++) {
+        for (int bx = 0; bx < 8; bx++) {
+            const uint8_t* p = signature->luma + by * 2 * CAMERA_SCENE_THUMB_SIZE + bx * 2;
+            unsigned int sum = p[0] + p[1] + p[CAMERA_SCENE_THUMB_SIZE] + p[CAMERA_SCENE_THUMB_SIZE + 1];
+            blocks[by * 8 + bx] = sum;
+            total += sum;
+        }
+    }
+    signature->hash = 0;
+    for (int i = 0; i < 64; i++) {
+        if (blocks[i] * 64 > total) {
+            signature->hash |= (uint64_t)1 << i;
+        }
+    }
+    return 0;
+}
+
+unsigned int camera_scene_difference(const camera_scene_signature_t* a, const camera_scene_signature_t* b) {
+    size_t i = 0;
+    unsigned int sum = 0;
+#if defined(CAMERA_SCENE_NEON)
+    uint32x4_t acc = vdupq_n_u32(0);
+    for (; i + 16 <= CAMERA_SCENE_PIXELS; i += 16) {
+        uint8x16_t d = vabdq_u8(vld1q_u8(a->luma + i), vld1q_u8(b->luma + i));
+        acc = vpadalq_u16(acc, vpaddlq_u8(d));
+    }
+    uint64x2_t pairs = vpaddlq_u32(acc);
+    sum = (unsigned int)(vgetq_lane_u64(pairs, 0) + vgetq_lane_u64(pairs, 1));
+#elif defined(CAMERA_SCENE_SSE2)
+    __m128i acc = _mm_setzero_si128();
+    for (; i + 16 <= CAMERA_SCENE_PIXELS; i += 16) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a->luma + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b->luma + i));
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(va, vb));
+    }
+    sum = (unsigned int)(_mm_cvtsi128_si32(acc) + _mm_cvtsi128_si32(_mm_srli_si128(acc, 8)));
+#endif
+    for (; i < CAMERA_SCENE_PIXELS; i++) {
+        sum += a->luma[i] > b->luma[i] ? a->luma[i] - b->luma[i] : b->luma[i] - a->luma[i];
+    }
+    return (sum + CAMERA_SCENE_PIXELS / 2) / CAMERA_SCENE_PIXELS;
+}
+
+int camera_scene_hash_distance(const camera_scene_signature_t* a, const camera_scene_signature_t* b) {
+    return __builtin_popcountll(a->hash ^ b->hash);
+}
+
+static void camera_scene_entry_clear(camera_scene_entry_t* entry) {
+    LINX_FREE(entry->question);
+    LINX_FREE(entry->response);
+    memset(entry, 0, sizeof(*entry));
+}
+
+// Cached answers are cheap to recompute, so they go on the first sign of memory pressure
+static size_t camera_scene_cache_shrink(void* user_data, linx_mem_pressure_level_t level) {
+    (void)level;
+    camera_scene_cache_t* cache = (camera_scene_cache_t*)user_data;
+    size_t released = 0;
+    pthread_mutex_lock(&cache->mutex);
+    for (int i = 0; i < CAMERA_SCENE_CACHE_ENTRIES; i++) {
+        camera_scene_entry_t* entry = &cache->entries[i];
+        if (entry->question) {
+            released += strlen(entry->question) + strlen(entry->response) + 2;
+            camera_scene_entry_clear(entry);
+        }
+    }
+    pthread_mutex_unlock(&cache->mutex);
+    return released;
+}
+
+camera_scene_cache_t* camera_scene_cache_create(void) {
+    camera_scene_cache_t* cache = (camera_scene_cache_t*)LINX_CALLOC(1, sizeof(camera_scene_cache_t));
+    if (!cache) {
+        LOG_ERROR("Failed to allocate explain answer cache");
+        return NULL;
+    }
+    pthread_mutex_init(&cache->mutex, NULL);
+    if (!linx_mem_pressure_register("explain_answers", LINX_MEM_PRESSURE_PRIORITY_RESULTS,
+                                    camera_scene_cache_shrink, cache)) {
+        LOG_WARN("Memory pressure shrinkers full, explain answers are kept under pressure");
+    }
+    return cache;
+}
+
+void camera_scene_cache_destroy(camera_scene_cache_t* cache) {
+    if (!cache) {
+        return;
+    }
+    linx_mem_pressure_unregister(camera_scene_cache_shrink, cache);
+    for (int i = 0; i < CAMERA_SCENE_CACHE_ENTRIES; i++) {
+        camera_scene_entry_clear(&cache->entries[i]);
+    }
+    pthread_mutex_destroy(&cache->mutex);
+    LINX_FREE(cache);
+}
+
+bool camera_scene_cache_lookup(camera_scene_cache_t* cache, const camera_scene_signature_t* signature,
+                               const char* question, int max_age_ms, unsigned int threshold,
+                               char* response, size_t response_size) {
+    if (!cache || !signature || !question || !response || response_size == 0 || max_age_ms <= 0) {
+        return false;
+    }
+
+    uint64_t now = linx_os_now_ms();
+    bool found = false;
+    pthread_mutex_lock(&cache->mutex);
+    for (int i = 0; i < CAMERA_SCENE_CACHE_ENTRIES && !found; i++) {
+        camera_scene_entry_t* entry = &cache->entries[i];
+        if (!entry->question || now - entry->stored_ms > (uint64_t)max_age_ms ||
+            strcmp(entry->question, question) != 0 ||
+            camera_scene_hash_distance(&entry->signature, signature) > CAMERA_SCENE_HASH_TOLERANCE) {
+            continue;
+        }
+        unsigned int difference = camera_scene_difference(&entry->signature, signature);
+        if (difference > threshold) {
+            continue;
+        }
+        strncpy(response, entry->response, response_size - 1);
+        response[response_size - 1] = '\0';
+        LOG_INFO("Scene unchanged (difference %u, %llu ms old), reusing explain answer",
+                 difference, (unsigned long long)(now - entry->stored_ms));
+        found = true;
+    }
+    pthread_mutex_unlock(&cache->mutex);
+    return found;
+}
+
+void camera_scene_cache_store(camera_scene_cache_t* cache, const camera_scene_signature_t* signature,
+                              const char* question, const char* response) {
+    if (!cache || !signature || !question || !response) {
+        return;
+    }
+
+    char* question_copy = LINX_STRDUP(question);
+    char* response_copy = LINX_STRDUP(response);
+    if (!question_copy || !response_copy) {
+        LINX_FREE(question_copy);
+        LINX_FREE(response_copy);
+        return;
+    }
+
+    pthread_mutex_lock(&cache->mutex);
+    camera_scene_entry_t* slot = &cache->entries[0];
+    for (int i = 0; i < CAMERA_SCENE_CACHE_ENTRIES; i++) {
+        camera_scene_entry_t* entry = &cache->entries[i];
+        if (!entry->question) {
+            slot = entry;
+            break;
+        }
+        if (entry->stored_ms < slot->stored_ms) {
+            slot = entry;
+        }
+    }
+    camera_scene_entry_clear(slot);
+    slot->signature = *signature;
+    slot->question = question_copy;
+    slot->response = response_copy;
+    slot->stored_ms = linx_os_now_ms();
+    pthread_mutex_unlock(&cache->mutex);
+}
+
+void camera_scene_cache_clear(camera_scene_cache_t* cache) {
+    if (!cache) {
+        return;
+    }
+    pthread_mutex_lock(&cache->mutex);
+    for (int i = 0; i < CAMERA_SCENE_CACHE_ENTRIES; i++) {
+        camera_scene_entry_clear(&cache->entries[i]);
+    }
+    pthread_mutex_unlock(&cache->mutex);
+}
@@ -0,0 +1,100 @@
+#ifndef CAMERA_SCENE_H
+#define CAMERA_SCENE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Change detection for explain requests
+ *
+ * MCP vision tools tend to ask about the same, barely changed scene over and
+ * over, and every explain call is an upload plus a model run of several
+ * seconds. Before encoding, the explain image is reduced to a small luma
+ * thumbnail; if a recent answer to the same question was given for a
+ * thumbnail that differs by less than the threshold, that answer is returned
+ * instead of calling the service again.
+ *
+ * The signature is a 16x16 luma thumbnail (box filtered with camera_scale.h)
+ * plus a 64-bit average hash of its 2x2 blocks. The hash picks candidate
+ * entries cheaply; the mean absolute difference of the thumbnails, summed
+ * with NEON or SSE2 where available, decides whether the scene changed.
+ */
+
+#define CAMERA_SCENE_THUMB_SIZE 16          // Thumbnail side in pixels
+#define CAMERA_SCENE_CACHE_ENTRIES 4        // Answers kept, oldest replaced first
+#define CAMERA_SCENE_HASH_TOLERANCE 8       // Hash bits that may differ for a candidate
+
+/**
+ * Scene signature of one image
+ */
+typedef struct {
+    uint64_t hash;                          // Average hash, bit set where a block is brighter than the mean
+    uint8_t luma[CAMERA_SCENE_THUMB_SIZE * CAMERA_SCENE_THUMB_SIZE];
+} camera_scene_signature_t;
+
+typedef struct camera_scene_cache camera_scene_cache_t;
+
+/**
+ * Compute the signature of packed RGB24 pixels
+ * @return 0 on success, negative if the image is smaller than the thumbnail
+ */
+int camera_scene_signature_rgb24(const uint8_t* rgb, int width, int height, size_t stride,
+                                 camera_scene_signature_t* signature);
+
+/**
+ * Mean absolute luma difference between two signatures, 0-255
+ */
+unsigned int camera_scene_difference(const camera_scene_signature_t* a, const camera_scene_signature_t* b);
+
+/**
+ * Number of differing hash bits between two signatures, 0-64
+ */
+int camera_scene_hash_distance(const camera_scene_signature_t* a, const camera_scene_signature_t* b);
+
+/**
+ * Create an answer cache (thread-safe)
+ *
+ * The cache registers a memory-pressure shrinker (linx_mem_pressure.h) that
+ * drops every stored answer.
+ *
+ * @return Cache, or NULL on allocation failure
+ */
+camera_scene_cache_t* camera_scene_cache_create(void);
+
+/**
+ * Destroy an answer cache
+ */
+void camera_scene_cache_destroy(camera_scene_cache_t* cache);
+
+/**
+ * Find an answer to `question` for an unchanged scene
+ * @param max_age_ms Ignore answers older than this
+ * @param threshold Largest camera_scene_difference() still counted as unchanged
+ * @param response Receives the answer (truncated to response_size)
+ * @return true if a cached answer was copied to `response`
+ */
+bool camera_scene_cache_lookup(camera_scene_cache_t* cache, const camera_scene_signature_t* signature,
+                               const char* question, int max_age_ms, unsigned int threshold,
+                               char* response, size_t response_size);
+
+/**
+ * Remember the answer to `question` for a scene
+ */
+void camera_scene_cache_store(camera_scene_cache_t* cache, const camera_scene_signature_t* signature,
+                              const char* question, const char* response);
+
+/**
+ * Forget all answers, e.g. when the explain service changes
+ */
+void camera_scene_cache_clear(camera_scene_cache_t* cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAMERA_SCENE_H
@@ -1,8 +1,11 @@
 #include "camera_stub.h"
 #include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
 #include <stdlib.h>
 #include <string.h>
 
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_CAMERA);
+
 // Forward declarations for vtable functions
 static int camera_stub_init(CameraInterface* self);
 static int camera_stub_set_config(CameraInterface* self, const CameraConfig* config);
@@ -28,16 +31,16 @@ static const CameraInterfaceVTable camera_stub_vtable = {
 };
 
 CameraInterface* camera_stub_create(void) {
-    CameraInterface* interface = (CameraInterface*)malloc(sizeof(CameraInterface));
+    CameraInterface* interface = (CameraInterface*)LINX_MALLOC(sizeof(CameraInterface));
     if (!interface) {
         LOG_ERROR("Failed to allocate memory for camera interface");
         return NULL;
     }
     
-    CameraStubData* data = (CameraStubData*)malloc(sizeof(CameraStubData));
+    CameraStubData* data = (CameraStubData*)LINX_MALLOC(sizeof(CameraStubData));
     if (!data) {
         LOG_ERROR("Failed to allocate memory for camera stub data");
-        free(interface);
+        LINX_FREE(interface);
         return NULL;
     }
     
@@ -59,7 +62,7 @@ CameraInterface* camera_stub_create(void) {
     
     // Create dummy frame data (simple pattern)
     data->dummy_frame_size = 1024; // 1KB dummy JPEG data
-    data->dummy_frame_data = (uint8_t*)malloc(data->dummy_frame_size);
+    data->dummy_frame_data = (uint8_t*)LINX_MALLOC_BULK(data->dummy_frame_size);
     if (data->dummy_frame_data) {
         // Fill with a simple pattern
         for (size_t i = 0; i < data->dummy_frame_size; i++) {
@@ -188,26 +191,26 @@ static int camera_stub_set_explain_url(CameraInterface* self, const char* url, c
     
     // Free existing strings
     if (data->explain_url) {
-        free(data->explain_url);
+        LINX_FREE(data->explain_url);
         data->explain_url = NULL;
     }
     if (data->explain_token) {
-        free(data->explain_token);
+        LINX_FREE(data->explain_token);
         data->explain_token = NULL;
     }
     
     // Allocate and copy new strings
-    data->explain_url = malloc(strlen(url) + 1);
+    data->explain_url = LINX_MALLOC(strlen(url) + 1);
     if (!data->explain_url) {
         LOG_ERROR("Failed to allocate memory for explain URL");
         return -1;
     }
     strcpy(data->explain_url, url);
     
-    data->explain_token = malloc(strlen(token) + 1);
+    data->explain_token = LINX_MALLOC(strlen(token) + 1);
     if (!data->explain_token) {
         LOG_ERROR("Failed to allocate memory for explain token");
-        free(data->explain_url);
+        LINX_FREE(data->explain_url);
         data->explain_url = NULL;
         return -1;
     }
@@ -274,21 +277,21 @@ static int camera_stub_destroy(CameraInterface* self) {
     if (data) {
         // Free explain URL and token
         if (data->explain_url) {
-            free(data->explain_url);
+            LINX_FREE(data->explain_url);
         }
         if (data->explain_token) {
-            free(data->explain_token);
+            LINX_FREE(data->explain_token);
         }
         
         // Free dummy frame data
         if (data->dummy_frame_data) {
-            free(data->dummy_frame_data);
+            LINX_FREE(data->dummy_frame_data);
         }
         
-        free(data);
+        LINX_FREE(data);
     }
     
-    free(self);
+    LINX_FREE(self);
     
     LOG_INFO("Camera stub destroyed");
     return 0;
@@ -15,9 +15,15 @@
 
 // Camera includes
 #include "camera_interface.h"
+#include "camera_preview.h"
 #include "camera_mac.h"
 #include "log/linx_log.h"
 
+#define PREVIEW_WIDTH       320
+#define PREVIEW_HEIGHT      240
+#define PREVIEW_PERIOD_US   33000   // ~30 fps
+#define PREVIEW_WAIT_MS     100
+
 // Global variables
 static CameraInterface *g_camera = NULL;
 static volatile int running = 1;
@@ -25,7 +31,8 @@ static pthread_mutex_t camera_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 // GUI objects
 static lv_obj_t *main_screen;
-static lv_obj_t *preview_img;
+static lv_obj_t *preview_area;
+static lv_obj_t *preview_label;
 static lv_obj_t *capture_btn;
 static lv_obj_t *explain_btn;
 static lv_obj_t *status_label;
@@ -36,6 +43,12 @@ static lv_obj_t *config_panel;
 static CameraFrameBuffer current_frame = {0};
 static bool frame_available = false;
 
+// Live preview: a producer thread converts camera frames into the preview's
+// draw buffers, the main loop presents the newest one
+static camera_preview_t *g_preview = NULL;
+static pthread_t preview_thread;
+static volatile int preview_running = 0;
+
 // Function prototypes
 static void cleanup_and_exit(int sig);
 static int init_camera_system(void);
@@ -48,7 +61,8 @@ static void capture_btn_event_cb(lv_event_t * e);
 static void explain_btn_event_cb(lv_event_t * e);
 static void update_status(const char* status);
 static void update_response(const char* response);
-static void update_preview_image(void);
+static void start_preview(void);
+static void stop_preview(void);
 
 /**
  * Signal handler for graceful shutdown
@@ -123,6 +137,7 @@ static int init_camera_system(void) {
  * Cleanup camera system
  */
 static void cleanup_camera_system(void) {
+    stop_preview();
     pthread_mutex_lock(&camera_mutex);
     if (g_camera) {
         printf("Cleaning up camera system...\n");
@@ -228,21 +243,32 @@ static void create_gui(void) {
     lv_obj_set_style_text_color(title, lv_color_white(), 0);
     lv_obj_align(title, LV_ALIGN_TOP_MID, 0, 20);
     
-    // Preview image area
-    preview_img = lv_img_create(main_screen);
-    lv_obj_set_size(preview_img, 320, 240);
-    lv_obj_align(preview_img, LV_ALIGN_TOP_LEFT, 20, 70);
-    lv_obj_set_style_bg_color(preview_img, lv_color_hex(0x4C566A), 0);
-    lv_obj_set_style_bg_opa(preview_img, LV_OPA_COVER, 0);
-    lv_obj_set_style_border_width(preview_img, 2, 0);
-    lv_obj_set_style_border_color(preview_img, lv_color_hex(0x5E81AC), 0);
-    
-    // Placeholder text for preview
-    lv_obj_t * preview_label = lv_label_create(preview_img);
-    lv_label_set_text(preview_label, "Camera Preview\n(Click Capture)");
+    // Preview area
+    preview_area = lv_obj_create(main_screen);
+    lv_obj_set_size(preview_area, PREVIEW_WIDTH + 4, PREVIEW_HEIGHT + 4);
+    lv_obj_align(preview_area, LV_ALIGN_TOP_LEFT, 20, 70);
+    lv_obj_set_style_bg_color(preview_area, lv_color_hex(0x4C566A), 0);
+    lv_obj_set_style_bg_opa(preview_area, LV_OPA_COVER, 0);
+    lv_obj_set_style_border_width(preview_area, 2, 0);
+    lv_obj_set_style_border_color(preview_area, lv_color_hex(0x5E81AC), 0);
+    lv_obj_set_style_pad_all(preview_area, 0, 0);
+    lv_obj_clear_flag(preview_area, LV_OBJ_FLAG_SCROLLABLE);
+    
+    // Placeholder text until the first frame arrives
+    preview_label = lv_label_create(preview_area);
+    lv_label_set_text(preview_label, "Camera Preview\n(Starting...)");
     lv_obj_set_style_text_color(preview_label, lv_color_white(), 0);
     lv_obj_center(preview_label);
     
+    // Live preview in the display's native format
+    camera_preview_config_t preview_config = camera_preview_default_config();
+    preview_config.width = PREVIEW_WIDTH;
+    preview_config.height = PREVIEW_HEIGHT;
+    g_preview = camera_preview_create(preview_area, &preview_config);
+    if (g_preview) {
+        lv_obj_center(camera_preview_get_obj(g_preview));
+    }
+    
     // Control panel
     config_panel = lv_obj_create(main_screen);
     lv_obj_set_size(config_panel, 420, 240);
@@ -300,7 +326,6 @@ static void capture_btn_event_cb(lv_event_t * e) {
     
     if (capture_image() == 0) {
         update_status("Status: Image captured successfully");
-        update_preview_image();
     } else {
         update_status("Status: Failed to capture image");
     }
@@ -344,39 +369,42 @@ static void update_response(const char* response) {
 }
 
 /**
- * Update preview image
+ * Preview producer: lend each camera frame to the preview, no JPEG involved
+ */
+static void* preview_thread_func(void* arg) {
+    (void)arg;
+    while (preview_running) {
+        if (g_camera && g_preview) {
+            camera_preview_update(g_preview, g_camera, PREVIEW_WAIT_MS);
+        }
+        usleep(PREVIEW_PERIOD_US);
+    }
+    return NULL;
+}
+
+/**
+ * Start the preview producer thread
  */
-static void update_preview_image(void) {
-    if (!preview_img || !frame_available || !current_frame.data) {
+static void start_preview(void) {
+    if (!g_preview || preview_running) {
         return;
     }
-    
-    pthread_mutex_lock(&camera_mutex);
-    
-    // Remove the placeholder label if it exists
-    lv_obj_t * preview_label = lv_obj_get_child(preview_img, 0);
-    if (preview_label) {
-        lv_obj_del(preview_label);
+    preview_running = 1;
+    if (pthread_create(&preview_thread, NULL, preview_thread_func, NULL) != 0) {
+        printf("Failed to start preview thread\n");
+        preview_running = 0;
     }
-    
-    // Create image descriptor for JPEG data
-    static lv_image_dsc_t img_dsc;
-    img_dsc.header.w = 640;  // Camera width
-    img_dsc.header.h = 480;  // Camera height
-    img_dsc.header.cf = LV_COLOR_FORMAT_RAW;  // Raw JPEG data
-    img_dsc.data_size = current_frame.size;
-    img_dsc.data = current_frame.data;
-    
-    // Set the image source
-    lv_img_set_src(preview_img, &img_dsc);
-    
-    // Scale the image to fit the preview area (320x240)
-    lv_img_set_zoom(preview_img, 128);  // 50% zoom (256 = 100%)
-    
-    pthread_mutex_unlock(&camera_mutex);
 }
 
-
+/**
+ * Stop the preview producer thread
+ */
+static void stop_preview(void) {
+    if (preview_running) {
+        preview_running = 0;
+        pthread_join(preview_thread, NULL);
+    }
+}
 
 /**
  * Main function
@@ -401,11 +429,16 @@ int main(void) {
     
     // Create GUI
     create_gui();
+    start_preview();
     
     printf("GUI started successfully. Use the interface to capture and explain images.\n");
     
     // Main loop - handle LVGL events on main thread
     while (running) {
+        if (camera_preview_present(g_preview) && preview_label) {
+            lv_obj_del(preview_label);
+            preview_label = NULL;
+        }
         lv_timer_handler();
         usleep(5000); // 5ms delay
     }
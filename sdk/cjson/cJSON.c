@@ -49,6 +49,15 @@
 #include <locale.h>
 #endif
 
+/* Vector string scanning, picked by the toolchain's target flags; scalar otherwise */
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define CJSON_SIMD_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CJSON_SIMD_SSE2 1
+#endif
+
 #if defined(_MSC_VER)
 #pragma warning (pop)
 #endif
@@ -249,6 +258,147 @@ static cJSON *cJSON_New_Item(const internal_hooks * const hooks)
     return node;
 }
 
+/* Hashed key index of an object's members, one allocation: header followed by the slots.
+ * Open addressing with linear probing, at most half full; an empty slot has item == NULL. */
+typedef struct
+{
+    unsigned long hash;
+    cJSON *item;
+} object_index_slot;
+
+struct cJSON_ObjectIndex
+{
+    size_t mask;
+    object_index_slot slots[1];
+};
+
+static size_t object_index_threshold = CJSON_OBJECT_INDEX_THRESHOLD;
+
+/* The index is built on lookups through a const object; several readers may race to publish it */
+#if defined(__GNUC__) || defined(__clang__)
+#define object_index_load(object) __atomic_load_n(&(object)->key_index, __ATOMIC_ACQUIRE)
+#define object_index_publish(object, index) __extension__ ({ struct cJSON_ObjectIndex *expected_ = NULL; \
+    __atomic_compare_exchange_n(&(object)->key_index, &expected_, (index), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE); })
+#define object_index_take(object) __atomic_exchange_n(&(object)->key_index, NULL, __ATOMIC_ACQ_REL)
+#else
+#define object_index_load(object) ((object)->key_index)
+#define object_index_publish(object, index) (((object)->key_index == NULL) ? ((object)->key_index = (index), 1) : 0)
+static struct cJSON_ObjectIndex *object_index_take(cJSON * const object)
+{
+    struct cJSON_ObjectIndex *index = object->key_index;
+    object->key_index = NULL;
+    return index;
+}
+#endif
+
+/* FNV-1a; 0 is reserved for "not computed yet" in cJSON_Key */
+static unsigned long hash_key(const char *string)
+{
+    const unsigned char *pointer = (const unsigned char*)string;
+    unsigned long hash = 2166136261UL;
+
+    while (*pointer != '\0')
+    {
+        hash ^= *pointer++;
+        hash *= 16777619UL;
+    }
+    hash &= 0xFFFFFFFFUL;
+
+    return (hash == 0) ? 1 : hash;
+}
+
+static struct cJSON_ObjectIndex *build_object_index(const cJSON * const object)
+{
+    struct cJSON_ObjectIndex *index = NULL;
+    const cJSON *current_element = NULL;
+    size_t members = 0;
+    size_t capacity = 8;
+
+    /* same members a case-sensitive scan can reach: up to the first one without a name */
+    for (current_element = object->child; (current_element != NULL) && (current_element->string != NULL); current_element = current_element->next)
+    {
+        members++;
+    }
+    while (capacity < (members * 2))
+    {
+        if (capacity > ((size_t)-1 / 4 / sizeof(object_index_slot)))
+        {
+            return NULL;
+        }
+        capacity *= 2;
+    }
+
+    index = (struct cJSON_ObjectIndex*)global_hooks.allocate(sizeof(struct cJSON_ObjectIndex) + ((capacity - 1) * sizeof(object_index_slot)));
+    if (index == NULL)
+    {
+        return NULL;
+    }
+    memset(index->slots, '\0', capacity * sizeof(object_index_slot));
+    index->mask = capacity - 1;
+
+    for (current_element = object->child; (current_element != NULL) && (current_element->string != NULL); current_element = current_element->next)
+    {
+        unsigned long hash = hash_key(current_element->string);
+        size_t position = (size_t)hash & index->mask;
+
+        while (index->slots[position].item != NULL)
+        {
+            /* duplicate key: the linear scan returns the first one, so does the index */
+            if ((index->slots[position].hash == hash) && (strcmp(index->slots[position].item->string, current_element->string) == 0))
+            {
+                break;
+            }
+            position = (position + 1) & index->mask;
+        }
+        if (index->slots[position].item == NULL)
+        {
+            index->slots[position].hash = hash;
+            index->slots[position].item = (cJSON*)current_element;
+        }
+    }
+
+    return index;
+}
+
+static cJSON *object_index_find(const struct cJSON_ObjectIndex * const index, const char * const name, const unsigned long hash)
+{
+    size_t position = (size_t)hash & index->mask;
+
+    while (index->slots[position].item != NULL)
+    {
+        if ((index->slots[position].hash == hash) && (strcmp(index->slots[position].item->string, name) == 0))
+        {
+            return index->slots[position].item;
+        }
+        position = (position + 1) & index->mask;
+    }
+
+    return NULL;
+}
+
+CJSON_PUBLIC(size_t) cJSON_SetObjectIndexThreshold(size_t members)
+{
+    size_t previous = object_index_threshold;
+    object_index_threshold = members;
+    return previous;
+}
+
+CJSON_PUBLIC(void) cJSON_ResetObjectIndex(cJSON * const object)
+{
+    struct cJSON_ObjectIndex *index = NULL;
+
+    if (object == NULL)
+    {
+        return;
+    }
+
+    index = object_index_take(object);
+    if (index != NULL)
+    {
+        global_hooks.deallocate(index);
+    }
+}
+
 /* Delete a cJSON structure. */
 CJSON_PUBLIC(void) cJSON_Delete(cJSON *item)
 {
@@ -268,6 +418,10 @@ CJSON_PUBLIC(void) cJSON_Delete(cJSON *item)
         {
             global_hooks.deallocate(item->string);
         }
+        if (item->key_index != NULL)
+        {
+            global_hooks.deallocate(item->key_index);
+        }
         global_hooks.deallocate(item);
         item = next;
     }
@@ -290,9 +444,26 @@ typedef struct
     size_t length;
     size_t offset;
     size_t depth; /* How deeply nested (in arrays/objects) is the input at the current offset. */
+    size_t max_depth; /* Nesting at which parsing is rejected, at most CJSON_NESTING_LIMIT. */
+    size_t items_left; /* Nodes that may still be allocated; (size_t)-1 is unlimited. */
     internal_hooks hooks;
 } parse_buffer;
 
+/* Allocate the next node of a parse, failing once the node budget is spent */
+static cJSON *parse_buffer_new_item(parse_buffer * const buffer)
+{
+    if (buffer->items_left == 0)
+    {
+        return NULL;
+    }
+    if (buffer->items_left != (size_t)-1)
+    {
+        buffer->items_left--;
+    }
+
+    return cJSON_New_Item(&(buffer->hooks));
+}
+
 /* check if the given size is left to read in a given parse buffer (starting with 1) */
 #define can_read(buffer, size) ((buffer != NULL) && (((buffer)->offset + size) <= (buffer)->length))
 /* check if the buffer can be accessed at the given index (starting with 0) */
@@ -774,6 +945,68 @@ fail:
     return 0;
 }
 
+/* is this byte one that a JSON string can't hold as is? */
+#define string_byte_needs_escape(c) (((c) < 32) || ((c) == '\"') || ((c) == '\\'))
+
+CJSON_PUBLIC(size_t) cJSON_StringPlainSpan(const char *string, size_t length)
+{
+    const unsigned char *start = (const unsigned char*)string;
+    const unsigned char *pointer = start;
+    const unsigned char *end = start + length;
+
+    if (string == NULL)
+    {
+        return 0;
+    }
+
+    /* whole blocks of 16 plain bytes are skipped at once; the block holding the first special byte is
+     * left to the scalar loop */
+#if defined(CJSON_SIMD_SSE2)
+    {
+        const __m128i quote = _mm_set1_epi8('\"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i control_max = _mm_set1_epi8(31);
+        while ((size_t)(end - pointer) >= 16)
+        {
+            __m128i block = _mm_loadu_si128((const __m128i*)(const void*)pointer);
+            __m128i special = _mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_cmpeq_epi8(block, backslash));
+            special = _mm_or_si128(special, _mm_cmpeq_epi8(_mm_max_epu8(block, control_max), control_max));
+            if (_mm_movemask_epi8(special) != 0)
+            {
+                break;
+            }
+            pointer += 16;
+        }
+    }
+#elif defined(CJSON_SIMD_NEON)
+    {
+        const uint8x16_t quote = vdupq_n_u8('\"');
+        const uint8x16_t backslash = vdupq_n_u8('\\');
+        const uint8x16_t control_end = vdupq_n_u8(32);
+        while ((size_t)(end - pointer) >= 16)
+        {
+            uint8x16_t block = vld1q_u8(pointer);
+            uint8x16_t special = vorrq_u8(vceqq_u8(block, quote), vceqq_u8(block, backslash));
+            uint64x2_t lanes;
+            special = vorrq_u8(special, vcltq_u8(block, control_end));
+            lanes = vreinterpretq_u64_u8(special);
+            if ((vgetq_lane_u64(lanes, 0) | vgetq_lane_u64(lanes, 1)) != 0)
+            {
+                break;
+            }
+            pointer += 16;
+        }
+    }
+#endif
+
+    while ((pointer < end) && !string_byte_needs_escape(*pointer))
+    {
+        pointer++;
+    }
+
+    return (size_t)(pointer - start);
+}
+
 /* Parse the input text into an unescaped cinput, and populate item. */
 static cJSON_bool parse_string(cJSON * const item, parse_buffer * const input_buffer)
 {
@@ -806,6 +1039,11 @@ static cJSON_bool parse_string(cJSON * const item, parse_buffer * const input_bu
                 input_end++;
             }
             input_end++;
+            /* skip the run of plain characters that follows */
+            if ((size_t)(input_end - input_buffer->content) < input_buffer->length)
+            {
+                input_end += cJSON_StringPlainSpan((const char*)input_end, input_buffer->length - (size_t)(input_end - input_buffer->content));
+            }
         }
         if (((size_t)(input_end - input_buffer->content) >= input_buffer->length) || (*input_end != '\"'))
         {
@@ -827,7 +1065,12 @@ static cJSON_bool parse_string(cJSON * const item, parse_buffer * const input_bu
     {
         if (*input_pointer != '\\')
         {
-            *output_pointer++ = *input_pointer++;
+            /* copy everything up to the next escape sequence in one go */
+            const unsigned char *escape = (const unsigned char*)memchr(input_pointer, '\\', (size_t)(input_end - input_pointer));
+            size_t run_length = (size_t)(((escape != NULL) ? escape : input_end) - input_pointer);
+            memcpy(output_pointer, input_pointer, run_length);
+            output_pointer += run_length;
+            input_pointer += run_length;
         }
         /* escape sequence */
         else
@@ -907,6 +1150,7 @@ fail:
 static cJSON_bool print_string_ptr(const unsigned char * const input, printbuffer * const output_buffer)
 {
     const unsigned char *input_pointer = NULL;
+    const unsigned char *input_end = NULL;
     unsigned char *output = NULL;
     unsigned char *output_pointer = NULL;
     size_t output_length = 0;
@@ -932,8 +1176,14 @@ static cJSON_bool print_string_ptr(const unsigned char * const input, printbuffe
     }
 
     /* set "flag" to 1 if something needs to be escaped */
-    for (input_pointer = input; *input_pointer; input_pointer++)
+    input_end = input + strlen((const char*)input);
+    for (input_pointer = input; input_pointer < input_end; input_pointer++)
     {
+        input_pointer += cJSON_StringPlainSpan((const char*)input_pointer, (size_t)(input_end - input_pointer));
+        if (input_pointer == input_end)
+        {
+            break;
+        }
         switch (*input_pointer)
         {
             case '\"':
@@ -955,7 +1205,7 @@ static cJSON_bool print_string_ptr(const unsigned char * const input, printbuffe
                 break;
         }
     }
-    output_length = (size_t)(input_pointer - input) + escape_characters;
+    output_length = (size_t)(input_end - input) + escape_characters;
 
     output = ensure(output_buffer, output_length + sizeof("\"\""));
     if (output == NULL)
@@ -977,12 +1227,15 @@ static cJSON_bool print_string_ptr(const unsigned char * const input, printbuffe
     output[0] = '\"';
     output_pointer = output + 1;
     /* copy the string */
-    for (input_pointer = input; *input_pointer != '\0'; (void)input_pointer++, output_pointer++)
+    for (input_pointer = input; input_pointer < input_end; (void)input_pointer++, output_pointer++)
     {
-        if ((*input_pointer > 31) && (*input_pointer != '\"') && (*input_pointer != '\\'))
+        size_t run_length = cJSON_StringPlainSpan((const char*)input_pointer, (size_t)(input_end - input_pointer));
+        if (run_length > 0)
         {
-            /* normal character, copy */
-            *output_pointer = *input_pointer;
+            /* normal characters, copy the whole run; the loop steps past the last one */
+            memcpy(output_pointer, input_pointer, run_length);
+            input_pointer += run_length - 1;
+            output_pointer += run_length - 1;
         }
         else
         {
@@ -1096,10 +1349,10 @@ CJSON_PUBLIC(cJSON *) cJSON_ParseWithOpts(const char *value, const char **return
     return cJSON_ParseWithLengthOpts(value, buffer_length, return_parse_end, require_null_terminated);
 }
 
-/* Parse an object - create a new root, and populate. */
-CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthOpts(const char *value, size_t buffer_length, const char **return_parse_end, cJSON_bool require_null_terminated)
+/* Parse an object - create a new root, and populate. limits may be NULL. */
+static cJSON *parse_with_limits(const char *value, size_t buffer_length, const char **return_parse_end, cJSON_bool require_null_terminated, const cJSON_ParseLimits *limits)
 {
-    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 } };
+    parse_buffer buffer = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 } };
     cJSON *item = NULL;
 
     /* reset error position */
@@ -1114,9 +1367,28 @@ CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthOpts(const char *value, size_t buffer
     buffer.content = (const unsigned char*)value;
     buffer.length = buffer_length;
     buffer.offset = 0;
+    buffer.max_depth = CJSON_NESTING_LIMIT;
+    buffer.items_left = (size_t)-1;
     buffer.hooks = global_hooks;
 
-    item = cJSON_New_Item(&global_hooks);
+    if (limits != NULL)
+    {
+        /* Oversized input is rejected before anything is allocated */
+        if ((limits->max_length > 0) && (buffer_length > limits->max_length))
+        {
+            goto fail;
+        }
+        if ((limits->max_depth > 0) && (limits->max_depth < CJSON_NESTING_LIMIT))
+        {
+            buffer.max_depth = limits->max_depth;
+        }
+        if (limits->max_items > 0)
+        {
+            buffer.items_left = limits->max_items;
+        }
+    }
+
+    item = parse_buffer_new_item(&buffer);
     if (item == NULL) /* memory fail */
     {
         goto fail;
@@ -1176,6 +1448,16 @@ fail:
     return NULL;
 }
 
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthOpts(const char *value, size_t buffer_length, const char **return_parse_end, cJSON_bool require_null_terminated)
+{
+    return parse_with_limits(value, buffer_length, return_parse_end, require_null_terminated, NULL);
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithLimits(const char *value, size_t buffer_length, const cJSON_ParseLimits *limits)
+{
+    return parse_with_limits(value, buffer_length, 0, 0, limits);
+}
+
 /* Default options for cJSON_Parse */
 CJSON_PUBLIC(cJSON *) cJSON_Parse(const char *value)
 {
@@ -1448,7 +1730,7 @@ static cJSON_bool parse_array(cJSON * const item, parse_buffer * const input_buf
     cJSON *head = NULL; /* head of the linked list */
     cJSON *current_item = NULL;
 
-    if (input_buffer->depth >= CJSON_NESTING_LIMIT)
+    if (input_buffer->depth >= input_buffer->max_depth)
     {
         return false; /* to deeply nested */
     }
@@ -1481,10 +1763,10 @@ static cJSON_bool parse_array(cJSON * const item, parse_buffer * const input_buf
     do
     {
         /* allocate next item */
-        cJSON *new_item = cJSON_New_Item(&(input_buffer->hooks));
+        cJSON *new_item = parse_buffer_new_item(input_buffer);
         if (new_item == NULL)
         {
-            goto fail; /* allocation failure */
+            goto fail; /* allocation failure or node limit */
         }
 
         /* attach next item to list */
@@ -1608,7 +1890,7 @@ static cJSON_bool parse_object(cJSON * const item, parse_buffer * const input_bu
     cJSON *head = NULL; /* linked list head */
     cJSON *current_item = NULL;
 
-    if (input_buffer->depth >= CJSON_NESTING_LIMIT)
+    if (input_buffer->depth >= input_buffer->max_depth)
     {
         return false; /* to deeply nested */
     }
@@ -1639,10 +1921,10 @@ static cJSON_bool parse_object(cJSON * const item, parse_buffer * const input_bu
     do
     {
         /* allocate next item */
-        cJSON *new_item = cJSON_New_Item(&(input_buffer->hooks));
+        cJSON *new_item = parse_buffer_new_item(input_buffer);
         if (new_item == NULL)
         {
-            goto fail; /* allocation failure */
+            goto fail; /* allocation failure or node limit */
         }
 
         /* attach next item to list */
@@ -1882,6 +2164,54 @@ CJSON_PUBLIC(cJSON *) cJSON_GetArrayItem(const cJSON *array, int index)
     return get_array_item(array, (size_t)index);
 }
 
+/* Case-sensitive lookup; hash is 0 until computed. Indexes the object once the scan walks past the threshold. */
+static cJSON *get_object_item_hashed(const cJSON * const object, const char * const name, unsigned long *hash)
+{
+    struct cJSON_ObjectIndex *index = object_index_load(object);
+    cJSON *current_element = NULL;
+    size_t scanned = 0;
+
+    if (index != NULL)
+    {
+        if (*hash == 0)
+        {
+            *hash = hash_key(name);
+        }
+        return object_index_find(index, name, *hash);
+    }
+
+    current_element = object->child;
+    while ((current_element != NULL) && (current_element->string != NULL) && (strcmp(name, current_element->string) != 0))
+    {
+        scanned++;
+        /* references share another object's members, whose changes would not reset this index */
+        if ((scanned == object_index_threshold) && cJSON_IsObject(object) && !(object->type & cJSON_IsReference))
+        {
+            index = build_object_index(object);
+            if (index != NULL)
+            {
+                if (!object_index_publish((cJSON*)object, index))
+                {
+                    global_hooks.deallocate(index);
+                }
+                if (*hash == 0)
+                {
+                    *hash = hash_key(name);
+                }
+                return object_index_find(object_index_load(object), name, *hash);
+            }
+        }
+        current_element = current_element->next;
+    }
+
+    if ((current_element == NULL) || (current_element->string == NULL))
+    {
+        return NULL;
+    }
+
+    return current_element;
+}
+
 static cJSON *get_object_item(const cJSON * const object, const char * const name, const cJSON_bool case_sensitive)
 {
     cJSON *current_element = NULL;
@@ -1894,10 +2224,8 @@ static cJSON *get_object_item(const cJSON * const object, const char * const nam
     current_element = object->child;
     if (case_sensitive)
     {
-        while ((current_element != NULL) && (current_element->string != NULL) && (strcmp(name, current_element->string) != 0))
-        {
-            current_element = current_element->next;
-        }
+        unsigned long hash = 0;
+        return get_object_item_hashed(object, name, &hash);
     }
     else
     {
@@ -1924,6 +2252,31 @@ CJSON_PUBLIC(cJSON *) cJSON_GetObjectItemCaseSensitive(const cJSON * const objec
     return get_object_item(object, string, true);
 }
 
+CJSON_PUBLIC(cJSON *) cJSON_GetObjectItemByKey(const cJSON * const object, cJSON_Key * const key)
+{
+    unsigned long hash = 0;
+    cJSON *item = NULL;
+
+    if ((object == NULL) || (key == NULL) || (key->string == NULL))
+    {
+        return NULL;
+    }
+
+#if defined(__GNUC__) || defined(__clang__)
+    hash = __atomic_load_n(&key->hash, __ATOMIC_RELAXED);
+#else
+    hash = key->hash;
+#endif
+    item = get_object_item_hashed(object, key->string, &hash);
+#if defined(__GNUC__) || defined(__clang__)
+    __atomic_store_n(&key->hash, hash, __ATOMIC_RELAXED);
+#else
+    key->hash = hash;
+#endif
+
+    return item;
+}
+
 CJSON_PUBLIC(cJSON_bool) cJSON_HasObjectItem(const cJSON *object, const char *string)
 {
     return cJSON_GetObjectItem(object, string) ? 1 : 0;
@@ -1967,6 +2320,7 @@ static cJSON_bool add_item_to_array(cJSON *array, cJSON *item)
         return false;
     }
 
+    cJSON_ResetObjectIndex(array);
     child = array->child;
     /*
      * To find the last item in array quickly, we use prev in array
@@ -2196,6 +2550,7 @@ CJSON_PUBLIC(cJSON *) cJSON_DetachItemViaPointer(cJSON *parent, cJSON * const it
         return NULL;
     }
 
+    cJSON_ResetObjectIndex(parent);
     if (item != parent->child)
     {
         /* not the first element */
@@ -2285,6 +2640,7 @@ CJSON_PUBLIC(cJSON_bool) cJSON_InsertItemInArray(cJSON *array, int which, cJSON
         return false;
     }
 
+    cJSON_ResetObjectIndex(array);
     newitem->next = after_inserted;
     newitem->prev = after_inserted->prev;
     after_inserted->prev = newitem;
@@ -2311,6 +2667,7 @@ CJSON_PUBLIC(cJSON_bool) cJSON_ReplaceItemViaPointer(cJSON * const parent, cJSON
         return true;
     }
 
+    cJSON_ResetObjectIndex(parent);
     replacement->next = item->next;
     replacement->prev = item->prev;
 
@@ -120,8 +120,20 @@ typedef struct cJSON
 
     /* The item's name string, if this item is the child of, or is in the list of subitems of an object. */
     char *string;
+
+    /* Key index of a large object, built lazily by case-sensitive lookups (see cJSON_SetObjectIndexThreshold) */
+    struct cJSON_ObjectIndex *key_index;
 } cJSON;
 
+/* A lookup key whose hash is computed once and kept with it, e.g. a static CJSON_KEY("session_id") */
+typedef struct cJSON_Key
+{
+    const char *string;
+    unsigned long hash;
+} cJSON_Key;
+
+#define CJSON_KEY(literal) { (literal), 0 }
+
 typedef struct cJSON_Hooks
 {
       /* malloc/free are CDECL on Windows regardless of the default calling convention of the compiler, so ensure the hooks allow passing those functions directly. */
@@ -131,12 +143,25 @@ typedef struct cJSON_Hooks
 
 typedef int cJSON_bool;
 
+/* Default for cJSON_SetObjectIndexThreshold: 0 keeps every lookup a linear scan */
+#ifndef CJSON_OBJECT_INDEX_THRESHOLD
+#define CJSON_OBJECT_INDEX_THRESHOLD 0
+#endif
+
 /* Limits how deeply nested arrays/objects can be before cJSON rejects to parse them.
  * This is to prevent stack overflows. */
 #ifndef CJSON_NESTING_LIMIT
 #define CJSON_NESTING_LIMIT 1000
 #endif
 
+/* Bounds for cJSON_ParseWithLimits; 0 in a field leaves that bound off */
+typedef struct cJSON_ParseLimits
+{
+    size_t max_length; /* input bytes, checked before anything is allocated */
+    size_t max_depth; /* nesting of arrays/objects, never more than CJSON_NESTING_LIMIT */
+    size_t max_items; /* cJSON nodes in the tree, the root included */
+} cJSON_ParseLimits;
+
 /* returns the version of cJSON as a string */
 CJSON_PUBLIC(const char*) cJSON_Version(void);
 
@@ -151,6 +176,9 @@ CJSON_PUBLIC(cJSON *) cJSON_ParseWithLength(const char *value, size_t buffer_len
 /* If you supply a ptr in return_parse_end and parsing fails, then return_parse_end will contain a pointer to the error so will match cJSON_GetErrorPtr(). */
 CJSON_PUBLIC(cJSON *) cJSON_ParseWithOpts(const char *value, const char **return_parse_end, cJSON_bool require_null_terminated);
 CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthOpts(const char *value, size_t buffer_length, const char **return_parse_end, cJSON_bool require_null_terminated);
+/* ParseWithLength that fails as soon as the input breaks one of the limits (NULL: none), freeing what it built so far.
+ * The failure is reported like any other parse error, through cJSON_GetErrorPtr(). */
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithLimits(const char *value, size_t buffer_length, const cJSON_ParseLimits *limits);
 
 /* Render a cJSON entity to text for transfer/storage. */
 CJSON_PUBLIC(char *) cJSON_Print(const cJSON *item);
@@ -161,6 +189,9 @@ CJSON_PUBLIC(char *) cJSON_PrintBuffered(const cJSON *item, int prebuffer, cJSON
 /* Render a cJSON entity to text using a buffer already allocated in memory with given length. Returns 1 on success and 0 on failure. */
 /* NOTE: cJSON is not always 100% accurate in estimating how much memory it will use, so to be safe allocate 5 bytes more than you actually need */
 CJSON_PUBLIC(cJSON_bool) cJSON_PrintPreallocated(cJSON *item, char *buffer, const int length, const cJSON_bool format);
+/* Number of leading bytes among the first length of string that a JSON string holds without escaping:
+ * everything but '"', '\\' and control characters (NUL included). Uses SSE2/NEON when the target has it. */
+CJSON_PUBLIC(size_t) cJSON_StringPlainSpan(const char *string, size_t length);
 /* Delete a cJSON entity and all subentities. */
 CJSON_PUBLIC(void) cJSON_Delete(cJSON *item);
 
@@ -171,6 +202,14 @@ CJSON_PUBLIC(cJSON *) cJSON_GetArrayItem(const cJSON *array, int index);
 /* Get item "string" from object. Case insensitive. */
 CJSON_PUBLIC(cJSON *) cJSON_GetObjectItem(const cJSON * const object, const char * const string);
 CJSON_PUBLIC(cJSON *) cJSON_GetObjectItemCaseSensitive(const cJSON * const object, const char * const string);
+/* Case-sensitive lookup with a key that carries its own hash; otherwise the same as cJSON_GetObjectItemCaseSensitive */
+CJSON_PUBLIC(cJSON *) cJSON_GetObjectItemByKey(const cJSON * const object, cJSON_Key * const key);
+/* Opt-in hashed lookups: once a case-sensitive lookup walks past this many members of an object, a hash
+ * index of its keys is built and kept on the object until its members change. 0 disables indexing.
+ * Set it once, before objects are shared between threads. Returns the previous threshold. */
+CJSON_PUBLIC(size_t) cJSON_SetObjectIndexThreshold(size_t members);
+/* Drop an object's key index; for code that relinks an object's members directly (cJSON_Utils sorting) */
+CJSON_PUBLIC(void) cJSON_ResetObjectIndex(cJSON * const object);
 CJSON_PUBLIC(cJSON_bool) cJSON_HasObjectItem(const cJSON *object, const char *string);
 /* For analysing failed parses. This returns a pointer to the parse error. You'll probably need to look a few chars back to make sense of it. Defined when cJSON_Parse() returns 0. 0 when cJSON_Parse() succeeds. */
 CJSON_PUBLIC(const char *) cJSON_GetErrorPtr(void);
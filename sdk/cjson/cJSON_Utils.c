@@ -393,6 +393,7 @@ static void decode_pointer_inplace(unsigned char *string)
 static cJSON *detach_item_from_array(cJSON *array, size_t which)
 {
     cJSON *c = array->child;
+    cJSON_ResetObjectIndex(array);
     while (c && (which > 0))
     {
         c = c->next;
@@ -598,7 +599,19 @@ static void sort_object(cJSON * const object, const cJSON_bool case_sensitive)
     {
         return;
     }
+    /* the first of duplicate keys may change */
+    cJSON_ResetObjectIndex(object);
     object->child = sort_list(object->child, case_sensitive);
+    if (object->child != NULL)
+    {
+        /* sort_list doesn't maintain the head's prev, which cJSON uses to find the last item when appending */
+        cJSON *tail = object->child;
+        while (tail->next != NULL)
+        {
+            tail = tail->next;
+        }
+        object->child->prev = tail;
+    }
 }
 
 static cJSON_bool compare_json(cJSON *a, cJSON *b, const cJSON_bool case_sensitive)
@@ -710,6 +723,7 @@ static cJSON_bool insert_item_in_array(cJSON *array, size_t which, cJSON *newite
     }
 
     /* insert into the linked list */
+    cJSON_ResetObjectIndex(array);
     newitem->next = child;
     newitem->prev = child->prev;
     child->prev = newitem;
@@ -800,6 +814,7 @@ static void overwrite_item(cJSON * const root, const cJSON replacement)
     {
         cJSON_Delete(root->child);
     }
+    cJSON_ResetObjectIndex(root);
 
     memcpy(root, &replacement, sizeof(cJSON));
 }
@@ -840,7 +855,7 @@ static int apply_patch(cJSON *object, const cJSON *patch, const cJSON_bool case_
     {
         if (opcode == REMOVE)
         {
-            static const cJSON invalid = { NULL, NULL, NULL, cJSON_Invalid, NULL, 0, 0, NULL};
+            static const cJSON invalid = { NULL, NULL, NULL, cJSON_Invalid, NULL, 0, 0, NULL, NULL};
 
             overwrite_item(object, invalid);
 
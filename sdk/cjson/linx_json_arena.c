@@ -0,0 +1,187 @@
+#include "linx_json_arena.h"
+#include "../log/linx_alloc.h"
+#include "cJSON.h"
+#include <stdlib.h>
+#include <stdint.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_JSON);
+
+/* 分配对齐（满足 cJSON 节点中 double 与指针的对齐要求） */
+#define LINX_JSON_ARENA_ALIGN (sizeof(void*) > sizeof(double) ? sizeof(void*) : sizeof(double))
+
+struct linx_json_arena {
+    unsigned char* buffer;          // 连续缓冲区
+    size_t capacity;                // 缓冲区容量
+    size_t used;                    // 当前水位线
+    linx_json_arena_t* outer;       // 嵌套时外层的竞技场
+    linx_json_arena_stats_t stats;  // 统计信息
+};
+
+/* 线程当前绑定的竞技场与暂停状态 */
+static __thread linx_json_arena_t* g_current_arena = NULL;
+static __thread bool g_arena_suspended = false;
+
+/* 分配钩子是否已安装 */
+static int g_hooks_installed = 0;
+
+/* 默认堆分配：经 SDK 分配接口，按 cJSON 记账 */
+static void* json_heap_malloc(size_t size) {
+    return linx_alloc_malloc(size, LINX_ALLOC_MODULE_JSON, "cJSON", 0);
+}
+
+static void json_heap_free(void* pointer) {
+    linx_alloc_free(pointer, LINX_ALLOC_MODULE_JSON, "cJSON", 0);
+}
+
+/* 竞技场之外的堆分配函数（默认 SDK 分配接口） */
+static void* (*g_heap_malloc)(size_t size) = json_heap_malloc;
+static void (*g_heap_free)(void* pointer) = json_heap_free;
+
+static bool arena_contains(const linx_json_arena_t* arena, const void* pointer) {
+    const unsigned char* p = (const unsigned char*)pointer;
+    return p >= arena->buffer && p < arena->buffer + arena->capacity;
+}
+
+static void* CJSON_CDECL arena_malloc(size_t size) {
+    linx_json_arena_t* arena = g_current_arena;
+    if (!arena || g_arena_suspended) {
+        return g_heap_malloc(size);
+    }
+
+    size_t aligned = (size + LINX_JSON_ARENA_ALIGN - 1) & ~(LINX_JSON_ARENA_ALIGN - 1);
+    if (aligned < size || aligned > arena->capacity - arena->used) {
+        arena->stats.fallbacks++;
+        return g_heap_malloc(size);
+    }
+
+    void* pointer = arena->buffer + arena->used;
+    arena->used += aligned;
+    arena->stats.allocations++;
+    if (arena->used > arena->stats.peak_used) {
+        arena->stats.peak_used = arena->used;
+    }
+    return pointer;
+}
+
+static void CJSON_CDECL arena_free(void* pointer) {
+    if (!pointer) {
+        return;
+    }
+
+    /* 竞技场内的内存在作用域结束时统一回收 */
+    for (const linx_json_arena_t* arena = g_current_arena; arena; arena = arena->outer) {
+        if (arena_contains(arena, pointer)) {
+            return;
+        }
+    }
+    g_heap_free(pointer);
+}
+
+static void arena_install_hooks(void) {
+    if (__atomic_load_n(&g_hooks_installed, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+
+    int expected = 0;
+    if (__atomic_compare_exchange_n(&g_hooks_installed, &expected, 1, false,
+                                    __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        cJSON_Hooks hooks = { arena_malloc, arena_free };
+        cJSON_InitHooks(&hooks);
+    }
+}
+
+void linx_json_arena_set_heap_allocator(void* (*malloc_fn)(size_t size), void (*free_fn)(void* pointer)) {
+    g_heap_malloc = (malloc_fn && free_fn) ? malloc_fn : json_heap_malloc;
+    g_heap_free = (malloc_fn && free_fn) ? free_fn : json_heap_free;
+    arena_install_hooks();
+}
+
+linx_json_arena_t* linx_json_arena_create(size_t capacity) {
+    if (capacity == 0) {
+        capacity = LINX_JSON_ARENA_DEFAULT_CAPACITY;
+    }
+
+    linx_json_arena_t* arena = (linx_json_arena_t*)LINX_CALLOC(1, sizeof(linx_json_arena_t));
+    if (!arena) {
+        return NULL;
+    }
+
+    arena->buffer = (unsigned char*)LINX_MALLOC(capacity);
+    if (!arena->buffer) {
+        LINX_FREE(arena);
+        return NULL;
+    }
+
+    arena->capacity = capacity;
+    arena->stats.capacity = capacity;
+    return arena;
+}
+
+void linx_json_arena_destroy(linx_json_arena_t* arena) {
+    if (!arena) {
+        return;
+    }
+
+    LINX_FREE(arena->buffer);
+    LINX_FREE(arena);
+}
+
+void linx_json_arena_begin(linx_json_arena_t* arena, linx_json_arena_scope_t* scope) {
+    if (!scope) {
+        return;
+    }
+
+    scope->arena = arena;
+    scope->prev = g_current_arena;
+    scope->prev_suspended = g_arena_suspended;
+    scope->mark = 0;
+
+    if (!arena) {
+        return;
+    }
+
+    arena_install_hooks();
+
+    scope->mark = arena->used;
+    if (arena != g_current_arena) {
+        arena->outer = g_current_arena;
+    }
+    g_current_arena = arena;
+    g_arena_suspended = false;
+}
+
+void linx_json_arena_end(linx_json_arena_scope_t* scope) {
+    if (!scope || !scope->arena) {
+        return;
+    }
+
+    linx_json_arena_t* arena = scope->arena;
+    arena->used = scope->mark;
+    if (arena != scope->prev) {
+        arena->outer = NULL;
+    }
+
+    g_current_arena = scope->prev;
+    g_arena_suspended = scope->prev_suspended;
+    scope->arena = NULL;
+}
+
+bool linx_json_arena_suspend(void) {
+    bool was_suspended = g_arena_suspended;
+    g_arena_suspended = true;
+    return was_suspended;
+}
+
+void linx_json_arena_resume(bool was_suspended) {
+    g_arena_suspended = was_suspended;
+}
+
+bool linx_json_arena_get_stats(const linx_json_arena_t* arena, linx_json_arena_stats_t* stats) {
+    if (!arena || !stats) {
+        return false;
+    }
+
+    *stats = arena->stats;
+    stats->used = arena->used;
+    return true;
+}
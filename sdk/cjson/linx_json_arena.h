@@ -0,0 +1,111 @@
+#ifndef LINX_JSON_ARENA_H
+#define LINX_JSON_ARENA_H
+
+/*
+ * cJSON 单消息内存竞技场（bump arena）
+ *
+ * 通过 cJSON_InitHooks 安装分配钩子：线程进入竞技场作用域后，cJSON 的节点
+ * 与字符串分配从预分配的连续缓冲区中顺序切出，释放为空操作；作用域结束时
+ * 把水位线回退到进入时的位置，一次性回收整条消息的全部节点（O(1)）。
+ * 缓冲区用尽时自动回退到堆（默认经 linx_alloc 分配接口），钩子释放时按地址区分两种来源。
+ *
+ * 使用约束：
+ * - 作用域内由 cJSON 分配的内存（包括 cJSON_Print 的结果）必须用
+ *   cJSON_free / cJSON_Delete 释放，且不能在作用域结束后继续使用
+ * - 调用应用层回调前应使用 linx_json_arena_suspend() 暂停，使应用代码
+ *   得到普通堆内存；暂停期间仍能正确释放竞技场内的节点
+ * - 作用域与线程绑定，同一竞技场同一时刻只能被一个线程使用
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 默认竞技场容量（字节） */
+#define LINX_JSON_ARENA_DEFAULT_CAPACITY (16 * 1024)
+
+/* 竞技场 - 前向声明（隐藏实现细节） */
+typedef struct linx_json_arena linx_json_arena_t;
+
+/* 竞技场作用域（由调用者在栈上保存） */
+typedef struct {
+    linx_json_arena_t* arena;       // 本作用域使用的竞技场
+    linx_json_arena_t* prev;        // 进入前的当前竞技场
+    bool prev_suspended;            // 进入前是否处于暂停状态
+    size_t mark;                    // 进入时的水位线
+} linx_json_arena_scope_t;
+
+/* 竞技场统计信息 */
+typedef struct {
+    size_t capacity;                // 缓冲区容量
+    size_t used;                    // 当前已用字节数
+    size_t peak_used;               // 历史最高已用字节数
+    size_t allocations;             // 从竞技场切出的分配次数
+    size_t fallbacks;               // 空间不足回退到 malloc 的次数
+} linx_json_arena_stats_t;
+
+/**
+ * 设置竞技场之外使用的堆分配函数（暂停、未进入作用域或空间不足时）
+ * 同时安装 cJSON 分配钩子；cJSON_InitHooks 会被竞技场钩子覆盖，
+ * 自定义 cJSON 堆分配（外部 PSRAM、分配计数等）应改用本函数或 linx_alloc_set_hooks()。
+ * 须在任何 cJSON 分配之前调用，分配与释放函数必须成对
+ * @param malloc_fn 分配函数，为 NULL 时恢复 SDK 分配接口（linx_alloc）
+ * @param free_fn 释放函数，为 NULL 时恢复 SDK 分配接口（linx_alloc）
+ */
+void linx_json_arena_set_heap_allocator(void* (*malloc_fn)(size_t size), void (*free_fn)(void* pointer));
+
+/**
+ * 创建竞技场
+ * @param capacity 缓冲区容量（字节），0 表示使用默认容量
+ * @return 竞技场实例，失败返回 NULL
+ */
+linx_json_arena_t* linx_json_arena_create(size_t capacity);
+
+/**
+ * 销毁竞技场（不能处于任何线程的作用域中）
+ * @param arena 竞技场实例
+ */
+void linx_json_arena_destroy(linx_json_arena_t* arena);
+
+/**
+ * 进入竞技场作用域，之后本线程的 cJSON 分配来自该竞技场
+ * 首次调用时安装 cJSON 分配钩子；作用域可以嵌套
+ * @param arena 竞技场实例，为 NULL 时作用域不生效
+ * @param scope 作用域状态（输出参数）
+ */
+void linx_json_arena_begin(linx_json_arena_t* arena, linx_json_arena_scope_t* scope);
+
+/**
+ * 退出竞技场作用域，回收作用域内的全部分配并恢复之前的状态
+ * @param scope linx_json_arena_begin() 填充的作用域状态
+ */
+void linx_json_arena_end(linx_json_arena_scope_t* scope);
+
+/**
+ * 暂停本线程的竞技场分配（用于调用应用层回调）
+ * @return 暂停前是否已处于暂停状态，传给 linx_json_arena_resume()
+ */
+bool linx_json_arena_suspend(void);
+
+/**
+ * 恢复本线程的竞技场分配
+ * @param was_suspended linx_json_arena_suspend() 的返回值
+ */
+void linx_json_arena_resume(bool was_suspended);
+
+/**
+ * 获取竞技场统计信息
+ * @param arena 竞技场实例
+ * @param stats 统计信息（输出参数）
+ * @return 成功返回 true
+ */
+bool linx_json_arena_get_stats(const linx_json_arena_t* arena, linx_json_arena_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINX_JSON_ARENA_H */
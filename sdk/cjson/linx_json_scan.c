@@ -0,0 +1,358 @@
+#include "linx_json_scan.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+/* 扫描游标 */
+typedef struct {
+    const char* cur;
+    const char* end;
+} linx_json_cursor_t;
+
+static void skip_whitespace(linx_json_cursor_t* c) {
+    while (c->cur < c->end && (*c->cur == ' ' || *c->cur == '\t' || *c->cur == '\n' || *c->cur == '\r')) {
+        c->cur++;
+    }
+}
+
+/* 扫描字符串，游标位于起始引号；输出引号内的原始范围 */
+static bool scan_string(linx_json_cursor_t* c, const char** start, size_t* length, bool* escaped) {
+    if (c->cur >= c->end || *c->cur != '"') {
+        return false;
+    }
+    c->cur++;
+    *start = c->cur;
+    *escaped = false;
+
+    while (c->cur < c->end) {
+        char ch = *c->cur;
+        if (ch == '"') {
+            *length = (size_t)(c->cur - *start);
+            c->cur++;
+            return true;
+        }
+        if (ch == '\\') {
+            *escaped = true;
+            c->cur++;
+            if (c->cur >= c->end) {
+                return false;
+            }
+        } else if ((unsigned char)ch < 0x20) {
+            /* 控制字符必须转义 */
+            return false;
+        }
+        c->cur++;
+    }
+
+    return false;
+}
+
+/* 跳过嵌套对象或数组，游标位于起始括号 */
+static bool skip_container(linx_json_cursor_t* c) {
+    int depth = 0;
+
+    while (c->cur < c->end) {
+        char ch = *c->cur;
+        if (ch == '"') {
+            const char* s;
+            size_t len;
+            bool esc;
+            if (!scan_string(c, &s, &len, &esc)) {
+                return false;
+            }
+            continue;
+        }
+        if (ch == '{' || ch == '[') {
+            depth++;
+        } else if (ch == '}' || ch == ']') {
+            depth--;
+            if (depth == 0) {
+                c->cur++;
+                return true;
+            }
+        }
+        c->cur++;
+    }
+
+    return false;
+}
+
+static bool match_literal(linx_json_cursor_t* c, const char* literal) {
+    size_t len = strlen(literal);
+    if ((size_t)(c->end - c->cur) < len || memcmp(c->cur, literal, len) != 0) {
+        return false;
+    }
+    c->cur += len;
+    return true;
+}
+
+/* 扫描任意值，输出类型与原始范围 */
+static bool scan_value(linx_json_cursor_t* c, linx_json_scan_type_t* type,
+                       const char** start, size_t* length, bool* escaped) {
+    if (c->cur >= c->end) {
+        return false;
+    }
+
+    *escaped = false;
+    char ch = *c->cur;
+
+    if (ch == '"') {
+        *type = LINX_JSON_SCAN_STRING;
+        return scan_string(c, start, length, escaped);
+    }
+
+    *start = c->cur;
+    if (ch == '{' || ch == '[') {
+        *type = (ch == '{') ? LINX_JSON_SCAN_OBJECT : LINX_JSON_SCAN_ARRAY;
+        if (!skip_container(c)) {
+            return false;
+        }
+    } else if (ch == 't') {
+        *type = LINX_JSON_SCAN_TRUE;
+        if (!match_literal(c, "true")) return false;
+    } else if (ch == 'f') {
+        *type = LINX_JSON_SCAN_FALSE;
+        if (!match_literal(c, "false")) return false;
+    } else if (ch == 'n') {
+        *type = LINX_JSON_SCAN_NULL;
+        if (!match_literal(c, "null")) return false;
+    } else if (ch == '-' || (ch >= '0' && ch <= '9')) {
+        *type = LINX_JSON_SCAN_NUMBER;
+        while (c->cur < c->end) {
+            ch = *c->cur;
+            if ((ch >= '0' && ch <= '9') || ch == '-' || ch == '+' || ch == '.' || ch == 'e' || ch == 'E') {
+                c->cur++;
+            } else {
+                break;
+            }
+        }
+    } else {
+        return false;
+    }
+
+    *length = (size_t)(c->cur - *start);
+    return true;
+}
+
+int linx_json_scan_object(const char* json, size_t length, linx_json_scan_field_t* fields, size_t field_count) {
+    if (!json || (!fields && field_count > 0)) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < field_count; i++) {
+        fields[i].type = LINX_JSON_SCAN_NONE;
+        fields[i].value = NULL;
+        fields[i].length = 0;
+        fields[i].escaped = false;
+    }
+
+    linx_json_cursor_t c = { json, json + length };
+    int found = 0;
+
+    skip_whitespace(&c);
+    if (c.cur >= c.end || *c.cur != '{') {
+        return -1;
+    }
+    c.cur++;
+    skip_whitespace(&c);
+
+    if (c.cur < c.end && *c.cur == '}') {
+        return 0;
+    }
+
+    while (c.cur < c.end) {
+        const char* key;
+        size_t key_len;
+        bool key_escaped;
+
+        skip_whitespace(&c);
+        if (!scan_string(&c, &key, &key_len, &key_escaped)) {
+            return -1;
+        }
+
+        skip_whitespace(&c);
+        if (c.cur >= c.end || *c.cur != ':') {
+            return -1;
+        }
+        c.cur++;
+        skip_whitespace(&c);
+
+        linx_json_scan_type_t type;
+        const char* value;
+        size_t value_len;
+        bool value_escaped;
+        if (!scan_value(&c, &type, &value, &value_len, &value_escaped)) {
+            return -1;
+        }
+
+        if (!key_escaped) {
+            for (size_t i = 0; i < field_count; i++) {
+                if (fields[i].type == LINX_JSON_SCAN_NONE && fields[i].key &&
+                    strlen(fields[i].key) == key_len && memcmp(fields[i].key, key, key_len) == 0) {
+                    fields[i].type = type;
+                    fields[i].value = value;
+                    fields[i].length = value_len;
+                    fields[i].escaped = value_escaped;
+                    found++;
+                    break;
+                }
+            }
+        }
+
+        skip_whitespace(&c);
+        if (c.cur >= c.end) {
+            return -1;
+        }
+        if (*c.cur == ',') {
+            c.cur++;
+            continue;
+        }
+        if (*c.cur == '}') {
+            return found;
+        }
+        return -1;
+    }
+
+    return -1;
+}
+
+bool linx_json_scan_equals(const linx_json_scan_field_t* field, const char* str) {
+    if (!field || !str || field->type != LINX_JSON_SCAN_STRING || field->escaped) {
+        return false;
+    }
+
+    size_t len = strlen(str);
+    return field->length == len && memcmp(field->value, str, len) == 0;
+}
+
+static int hex_value(char ch) {
+    if (ch >= '0' && ch <= '9') return ch - '0';
+    if (ch >= 'a' && ch <= 'f') return ch - 'a' + 10;
+    if (ch >= 'A' && ch <= 'F') return ch - 'A' + 10;
+    return -1;
+}
+
+static bool parse_hex4(const char* p, const char* end, uint32_t* out) {
+    if (end - p < 4) {
+        return false;
+    }
+
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++) {
+        int h = hex_value(p[i]);
+        if (h < 0) {
+            return false;
+        }
+        value = (value << 4) | (uint32_t)h;
+    }
+    *out = value;
+    return true;
+}
+
+size_t linx_json_scan_copy_string(const linx_json_scan_field_t* field, char* buffer, size_t size) {
+    if (!field || !buffer || size == 0 || field->type != LINX_JSON_SCAN_STRING) {
+        return (size_t)-1;
+    }
+
+    if (!field->escaped) {
+        if (field->length >= size) {
+            return (size_t)-1;
+        }
+        memcpy(buffer, field->value, field->length);
+        buffer[field->length] = '\0';
+        return field->length;
+    }
+
+    const char* p = field->value;
+    const char* end = field->value + field->length;
+    size_t out = 0;
+
+    while (p < end) {
+        char utf8[4];
+        size_t n = 1;
+
+        if (*p != '\\') {
+            utf8[0] = *p++;
+        } else {
+            p++;
+            if (p >= end) {
+                return (size_t)-1;
+            }
+            char esc = *p++;
+            switch (esc) {
+                case '"':  utf8[0] = '"';  break;
+                case '\\': utf8[0] = '\\'; break;
+                case '/':  utf8[0] = '/';  break;
+                case 'b':  utf8[0] = '\b'; break;
+                case 'f':  utf8[0] = '\f'; break;
+                case 'n':  utf8[0] = '\n'; break;
+                case 'r':  utf8[0] = '\r'; break;
+                case 't':  utf8[0] = '\t'; break;
+                case 'u': {
+                    uint32_t cp;
+                    if (!parse_hex4(p, end, &cp)) {
+                        return (size_t)-1;
+                    }
+                    p += 4;
+                    /* UTF-16 代理对 */
+                    if (cp >= 0xD800 && cp <= 0xDBFF) {
+                        uint32_t low;
+                        if (end - p < 6 || p[0] != '\\' || p[1] != 'u' || !parse_hex4(p + 2, end, &low) ||
+                            low < 0xDC00 || low > 0xDFFF) {
+                            return (size_t)-1;
+                        }
+                        p += 6;
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+                        return (size_t)-1;
+                    }
+
+                    if (cp < 0x80) {
+                        utf8[0] = (char)cp;
+                    } else if (cp < 0x800) {
+                        utf8[0] = (char)(0xC0 | (cp >> 6));
+                        utf8[1] = (char)(0x80 | (cp & 0x3F));
+                        n = 2;
+                    } else if (cp < 0x10000) {
+                        utf8[0] = (char)(0xE0 | (cp >> 12));
+                        utf8[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+                        utf8[2] = (char)(0x80 | (cp & 0x3F));
+                        n = 3;
+                    } else {
+                        utf8[0] = (char)(0xF0 | (cp >> 18));
+                        utf8[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+                        utf8[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+                        utf8[3] = (char)(0x80 | (cp & 0x3F));
+                        n = 4;
+                    }
+                    break;
+                }
+                default:
+                    return (size_t)-1;
+            }
+        }
+
+        if (out + n >= size) {
+            return (size_t)-1;
+        }
+        memcpy(buffer + out, utf8, n);
+        out += n;
+    }
+
+    buffer[out] = '\0';
+    return out;
+}
+
+double linx_json_scan_number(const linx_json_scan_field_t* field, double fallback) {
+    if (!field || field->type != LINX_JSON_SCAN_NUMBER || field->length == 0 || field->length >= 64) {
+        return fallback;
+    }
+
+    char number[64];
+    memcpy(number, field->value, field->length);
+    number[field->length] = '\0';
+
+    char* end = NULL;
+    double value = strtod(number, &end);
+    return (end && *end == '\0') ? value : fallback;
+}
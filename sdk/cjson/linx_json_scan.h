@@ -0,0 +1,81 @@
+#ifndef LINX_JSON_SCAN_H
+#define LINX_JSON_SCAN_H
+
+/*
+ * 轻量级 JSON 扫描器
+ *
+ * 针对服务器下发的小型扁平控制消息（如 {"type":"tts","state":"start"}），
+ * 只扫描顶层对象并按键名提取值，不构建 cJSON 树、不分配任何内存。
+ * 值以指向原始缓冲区的片段给出，字符串需要时再用 linx_json_scan_copy_string()
+ * 解码转义。嵌套对象/数组只记录其原始范围，需要时再交给 cJSON 完整解析。
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 扫描到的值类型 */
+typedef enum {
+    LINX_JSON_SCAN_NONE = 0,    // 未找到该键
+    LINX_JSON_SCAN_STRING,      // 字符串
+    LINX_JSON_SCAN_NUMBER,      // 数字
+    LINX_JSON_SCAN_TRUE,        // true
+    LINX_JSON_SCAN_FALSE,       // false
+    LINX_JSON_SCAN_NULL,        // null
+    LINX_JSON_SCAN_OBJECT,      // 嵌套对象（原始范围含花括号）
+    LINX_JSON_SCAN_ARRAY        // 数组（原始范围含方括号）
+} linx_json_scan_type_t;
+
+/* 待提取字段 */
+typedef struct {
+    const char* key;                // 键名（输入，不支持含转义字符的键）
+    linx_json_scan_type_t type;     // 值类型（输出）
+    const char* value;              // 值在原始缓冲区中的起始位置；字符串不含引号
+    size_t length;                  // 值的原始长度
+    bool escaped;                   // 字符串是否含有转义序列
+} linx_json_scan_field_t;
+
+/**
+ * 扫描顶层 JSON 对象并提取指定字段
+ * 重复出现的键以第一次出现为准（与 cJSON_GetObjectItem 行为一致）
+ * @param json JSON 文本（无需以 '\0' 结尾）
+ * @param length 文本长度
+ * @param fields 待提取字段数组，type/value/length/escaped 会被重置后填充
+ * @param field_count 字段数量
+ * @return 找到的字段数量；JSON 不是合法对象时返回 -1
+ */
+int linx_json_scan_object(const char* json, size_t length, linx_json_scan_field_t* fields, size_t field_count);
+
+/**
+ * 判断字符串字段是否等于给定值（仅适用于不含转义的字符串）
+ * @param field 字段
+ * @param str 比较的字符串
+ * @return 相等返回 true
+ */
+bool linx_json_scan_equals(const linx_json_scan_field_t* field, const char* str);
+
+/**
+ * 将字符串字段解码（处理转义，\uXXXX 转为 UTF-8）并复制到缓冲区
+ * @param field 字符串字段
+ * @param buffer 输出缓冲区
+ * @param size 缓冲区大小（含结束符）
+ * @return 写入的字节数（不含结束符）；类型不符、转义非法或缓冲区不足时返回 (size_t)-1
+ */
+size_t linx_json_scan_copy_string(const linx_json_scan_field_t* field, char* buffer, size_t size);
+
+/**
+ * 将数字字段转换为 double
+ * @param field 数字字段
+ * @param fallback 类型不符时的返回值
+ * @return 数值
+ */
+double linx_json_scan_number(const linx_json_scan_field_t* field, double fallback);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINX_JSON_SCAN_H */
@@ -0,0 +1,564 @@
+#include "linx_json_stream.h"
+#include "../log/linx_alloc.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_JSON);
+
+/* 标记缓冲区首次分配和 reset 后保留的大小 */
+#define LINX_JSON_STREAM_TOKEN_KEEP 256
+
+/* 父节点栈首次分配的深度 */
+#define LINX_JSON_STREAM_STACK_INITIAL 8
+
+/* 扫描状态 */
+typedef enum {
+    STATE_VALUE,            // 期待一个值
+    STATE_VALUE_OR_END,     // '[' 之后：值或 ']'
+    STATE_KEY_OR_END,       // '{' 之后：键或 '}'
+    STATE_KEY,              // 对象中 ',' 之后：键
+    STATE_COLON,            // 键之后：':'
+    STATE_AFTER,            // 容器中的值之后：',' 或结束括号
+    STATE_STRING,           // 字符串内
+    STATE_ESCAPE,           // '\' 之后
+    STATE_UNICODE,          // \u 之后的 4 位十六进制
+    STATE_LOW_BACKSLASH,    // 高代理项之后，期待低代理项的 '\'
+    STATE_LOW_U,            // 高代理项之后，期待低代理项的 'u'
+    STATE_NUMBER,           // 数字内
+    STATE_LITERAL,          // true / false / null 内
+    STATE_DONE,             // 顶层值已结束
+    STATE_ERROR
+} linx_json_stream_state_t;
+
+struct linx_json_stream {
+    cJSON_ParseLimits limits;
+    size_t depth_limit;             // 生效的最大嵌套层数
+
+    linx_json_stream_state_t state;
+    const char* error;
+    size_t consumed;
+    size_t items;
+
+    cJSON* root;
+    cJSON** stack;                  // 打开的容器，栈顶是当前父节点
+    size_t depth;
+    size_t stack_capacity;
+
+    char* token;                    // 正在扫描的字符串或数字（以 '\0' 结尾）
+    size_t token_length;
+    size_t token_capacity;
+    char* key;                      // 当前成员的键
+    size_t key_capacity;
+    bool in_key;                    // 正在扫描的字符串是键
+
+    uint32_t code_point;            // \u 转义的累计值
+    uint32_t high_surrogate;        // 等待低代理项的高代理项，0 为没有
+    int hex_digits;                 // 已读的十六进制位数
+
+    const char* literal;            // 正在匹配的字面量
+    size_t literal_pos;
+};
+
+static linx_json_stream_status_t fail(linx_json_stream_t* s, const char* reason) {
+    if (s->state != STATE_ERROR) {
+        s->state = STATE_ERROR;
+        s->error = reason;
+        cJSON_Delete(s->root);
+        s->root = NULL;
+        s->depth = 0;
+    }
+    return LINX_JSON_STREAM_ERROR;
+}
+
+linx_json_stream_t* linx_json_stream_create(const cJSON_ParseLimits* limits) {
+    linx_json_stream_t* s = (linx_json_stream_t*)LINX_CALLOC(1, sizeof(*s));
+    if (!s) {
+        return NULL;
+    }
+    if (limits) {
+        s->limits = *limits;
+    }
+    s->depth_limit = s->limits.max_depth > 0 && s->limits.max_depth < CJSON_NESTING_LIMIT ?
+                     s->limits.max_depth : CJSON_NESTING_LIMIT;
+    s->state = STATE_VALUE;
+    return s;
+}
+
+void linx_json_stream_destroy(linx_json_stream_t* s) {
+    if (!s) {
+        return;
+    }
+    cJSON_Delete(s->root);
+    LINX_FREE(s->stack);
+    LINX_FREE(s->token);
+    LINX_FREE(s->key);
+    LINX_FREE(s);
+}
+
+void linx_json_stream_reset(linx_json_stream_t* s) {
+    if (!s) {
+        return;
+    }
+    cJSON_Delete(s->root);
+    s->root = NULL;
+    s->depth = 0;
+    s->state = STATE_VALUE;
+    s->error = NULL;
+    s->consumed = 0;
+    s->items = 0;
+    s->token_length = 0;
+    s->high_surrogate = 0;
+    /* One huge string must not pin its buffer until the next one */
+    if (s->token_capacity > LINX_JSON_STREAM_TOKEN_KEEP) {
+        LINX_FREE(s->token);
+        s->token = NULL;
+        s->token_capacity = 0;
+    }
+    if (s->key_capacity > LINX_JSON_STREAM_TOKEN_KEEP) {
+        LINX_FREE(s->key);
+        s->key = NULL;
+        s->key_capacity = 0;
+    }
+}
+
+const char* linx_json_stream_error(const linx_json_stream_t* s) {
+    return s ? s->error : NULL;
+}
+
+size_t linx_json_stream_consumed(const linx_json_stream_t* s) {
+    return s ? s->consumed : 0;
+}
+
+static bool reserve(char** buffer, size_t* capacity, size_t needed) {
+    if (needed <= *capacity) {
+        return true;
+    }
+    size_t new_capacity = *capacity > 0 ? *capacity : LINX_JSON_STREAM_TOKEN_KEEP;
+    while (new_capacity < needed) {
+        new_capacity *= 2;
+    }
+    char* grown = (char*)LINX_REALLOC(*buffer, new_capacity);
+    if (!grown) {
+        return false;
+    }
+    *buffer = grown;
+    *capacity = new_capacity;
+    return true;
+}
+
+static bool token_append(linx_json_stream_t* s, const char* data, size_t size) {
+    if (!reserve(&s->token, &s->token_capacity, s->token_length + size + 1)) {
+        return false;
+    }
+    memcpy(s->token + s->token_length, data, size);
+    s->token_length += size;
+    s->token[s->token_length] = '\0';
+    return true;
+}
+
+static bool token_append_utf8(linx_json_stream_t* s, uint32_t cp) {
+    char out[4];
+    size_t n;
+    if (cp < 0x80) {
+        out[0] = (char)cp;
+        n = 1;
+    } else if (cp < 0x800) {
+        out[0] = (char)(0xC0 | (cp >> 6));
+        out[1] = (char)(0x80 | (cp & 0x3F));
+        n = 2;
+    } else if (cp < 0x10000) {
+        out[0] = (char)(0xE0 | (cp >> 12));
+        out[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (cp & 0x3F));
+        n = 3;
+    } else {
+        out[0] = (char)(0xF0 | (cp >> 18));
+        out[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+        out[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        out[3] = (char)(0x80 | (cp & 0x3F));
+        n = 4;
+    }
+    return token_append(s, out, n);
+}
+
+/* 把一个节点挂到当前父节点下（或作为根），item 的所有权随之转移 */
+static bool attach(linx_json_stream_t* s, cJSON* item) {
+    if (!item) {
+        fail(s, "out of memory");
+        return false;
+    }
+    if (s->limits.max_items > 0 && ++s->items > s->limits.max_items) {
+        cJSON_Delete(item);
+        fail(s, "too many items");
+        return false;
+    }
+    if (s->depth == 0) {
+        s->root = item;
+        return true;
+    }
+    cJSON* parent = s->stack[s->depth - 1];
+    bool added = cJSON_IsObject(parent) ? cJSON_AddItemToObject(parent, s->key, item) :
+                                         cJSON_AddItemToArray(parent, item);
+    if (!added) {
+        cJSON_Delete(item);
+        fail(s, "out of memory");
+        return false;
+    }
+    return true;
+}
+
+static void after_value(linx_json_stream_t* s) {
+    s->state = s->depth == 0 ? STATE_DONE : STATE_AFTER;
+}
+
+static bool open_container(linx_json_stream_t* s, bool object) {
+    if (s->depth >= s->depth_limit) {
+        fail(s, "nesting too deep");
+        return false;
+    }
+    if (s->depth == s->stack_capacity) {
+        size_t capacity = s->stack_capacity > 0 ? s->stack_capacity * 2 : LINX_JSON_STREAM_STACK_INITIAL;
+        cJSON** grown = (cJSON**)LINX_REALLOC(s->stack, capacity * sizeof(*grown));
+        if (!grown) {
+            fail(s, "out of memory");
+            return false;
+        }
+        s->stack = grown;
+        s->stack_capacity = capacity;
+    }
+    cJSON* item = object ? cJSON_CreateObject() : cJSON_CreateArray();
+    if (!attach(s, item)) {
+        return false;
+    }
+    s->stack[s->depth++] = item;
+    s->state = object ? STATE_KEY_OR_END : STATE_VALUE_OR_END;
+    return true;
+}
+
+static bool close_container(linx_json_stream_t* s, bool object) {
+    if (s->depth == 0 || cJSON_IsObject(s->stack[s->depth - 1]) != object) {
+        fail(s, "mismatched bracket");
+        return false;
+    }
+    s->depth--;
+    after_value(s);
+    return true;
+}
+
+static bool finish_string(linx_json_stream_t* s) {
+    if (s->in_key) {
+        if (!reserve(&s->key, &s->key_capacity, s->token_length + 1)) {
+            fail(s, "out of memory");
+            return false;
+        }
+        memcpy(s->key, s->token, s->token_length + 1);
+        s->state = STATE_COLON;
+        return true;
+    }
+    if (!attach(s, cJSON_CreateString(s->token))) {
+        return false;
+    }
+    after_value(s);
+    return true;
+}
+
+static bool finish_number(linx_json_stream_t* s) {
+    char* end = NULL;
+    double value = strtod(s->token, &end);
+    if (s->token_length == 0 || end != s->token + s->token_length) {
+        fail(s, "invalid number");
+        return false;
+    }
+    if (!attach(s, cJSON_CreateNumber(value))) {
+        return false;
+    }
+    after_value(s);
+    return true;
+}
+
+static bool begin_string(linx_json_stream_t* s, bool key) {
+    s->token_length = 0;
+    s->in_key = key;
+    s->state = STATE_STRING;
+    if (!token_append(s, "", 0)) {
+        fail(s, "out of memory");
+        return false;
+    }
+    return true;
+}
+
+/* 在期待值的位置开始一个值 */
+static bool begin_value(linx_json_stream_t* s, char ch) {
+    s->token_length = 0;
+    switch (ch) {
+        case '{':
+            return open_container(s, true);
+        case '[':
+            return open_container(s, false);
+        case '"':
+            return begin_string(s, false);
+        case 't':
+            s->literal = "true";
+            break;
+        case 'f':
+            s->literal = "false";
+            break;
+        case 'n':
+            s->literal = "null";
+            break;
+        default:
+            if (ch == '-' || (ch >= '0' && ch <= '9')) {
+                s->state = STATE_NUMBER;
+                if (!token_append(s, &ch, 1)) {
+                    fail(s, "out of memory");
+                    return false;
+                }
+                return true;
+            }
+            fail(s, "unexpected character");
+            return false;
+    }
+    s->literal_pos = 1;
+    s->state = STATE_LITERAL;
+    return true;
+}
+
+static bool finish_literal(linx_json_stream_t* s) {
+    cJSON* item = s->literal[0] == 't' ? cJSON_CreateTrue() :
+                  s->literal[0] == 'f' ? cJSON_CreateFalse() : cJSON_CreateNull();
+    if (!attach(s, item)) {
+        return false;
+    }
+    after_value(s);
+    return true;
+}
+
+static int hex_value(char ch) {
+    if (ch >= '0' && ch <= '9') {
+        return ch - '0';
+    }
+    if (ch >= 'a' && ch <= 'f') {
+        return ch - 'a' + 10;
+    }
+    if (ch >= 'A' && ch <= 'F') {
+        return ch - 'A' + 10;
+    }
+    return -1;
+}
+
+static bool finish_unicode(linx_json_stream_t* s) {
+    uint32_t cp = s->code_point;
+    if (s->high_surrogate) {
+        if (cp < 0xDC00 || cp > 0xDFFF) {
+            fail(s, "invalid surrogate pair");
+            return false;
+        }
+        cp = 0x10000 + ((s->high_surrogate - 0xD800) << 10) + (cp - 0xDC00);
+        s->high_surrogate = 0;
+    } else if (cp >= 0xD800 && cp <= 0xDBFF) {
+        s->high_surrogate = cp;
+        s->state = STATE_LOW_BACKSLASH;
+        return true;
+    } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+        fail(s, "invalid surrogate pair");
+        return false;
+    }
+    if (!token_append_utf8(s, cp)) {
+        fail(s, "out of memory");
+        return false;
+    }
+    s->state = STATE_STRING;
+    return true;
+}
+
+static bool is_space(char ch) {
+    return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
+}
+
+linx_json_stream_status_t linx_json_stream_feed(linx_json_stream_t* s, const char* data, size_t size) {
+    if (!s) {
+        return LINX_JSON_STREAM_ERROR;
+    }
+    if (s->state == STATE_ERROR) {
+        return LINX_JSON_STREAM_ERROR;
+    }
+    s->consumed += size;
+    if (s->limits.max_length > 0 && s->consumed > s->limits.max_length) {
+        return fail(s, "input too long");
+    }
+
+    size_t i = 0;
+    while (i < size) {
+        char ch = data[i];
+        switch (s->state) {
+            case STATE_STRING: {
+                /* Copy the run up to the next quote or backslash in one go; raw control
+                 * characters are kept, as cJSON_ParseWithLimits() does */
+                size_t start = i;
+                while (i < size && data[i] != '"' && data[i] != '\\') {
+                    i++;
+                }
+                if (i > start && !token_append(s, data + start, i - start)) {
+                    return fail(s, "out of memory");
+                }
+                if (i == size) {
+                    continue;
+                }
+                ch = data[i++];
+                if (ch == '\\') {
+                    s->state = STATE_ESCAPE;
+                } else if (!finish_string(s)) {
+                    return LINX_JSON_STREAM_ERROR;
+                }
+                continue;
+            }
+            case STATE_ESCAPE: {
+                static const char escapes[] = "\"\"\\\\//b\bf\fn\nr\rt\t";
+                i++;
+                if (ch == 'u') {
+                    s->code_point = 0;
+                    s->hex_digits = 0;
+                    s->state = STATE_UNICODE;
+                    continue;
+                }
+                const char* e = NULL;
+                for (size_t k = 0; k + 1 < sizeof(escapes); k += 2) {
+                    if (escapes[k] == ch) {
+                        e = &escapes[k + 1];
+                        break;
+                    }
+                }
+                if (!e) {
+                    return fail(s, "invalid escape");
+                }
+                if (!token_append(s, e, 1)) {
+                    return fail(s, "out of memory");
+                }
+                s->state = STATE_STRING;
+                continue;
+            }
+            case STATE_UNICODE: {
+                int v = hex_value(ch);
+                i++;
+                if (v < 0) {
+                    return fail(s, "invalid unicode escape");
+                }
+                s->code_point = (s->code_point << 4) | (uint32_t)v;
+                if (++s->hex_digits == 4 && !finish_unicode(s)) {
+                    return LINX_JSON_STREAM_ERROR;
+                }
+                continue;
+            }
+            case STATE_LOW_BACKSLASH:
+                i++;
+                if (ch != '\\') {
+                    return fail(s, "invalid surrogate pair");
+                }
+                s->state = STATE_LOW_U;
+                continue;
+            case STATE_LOW_U:
+                i++;
+                if (ch != 'u') {
+                    return fail(s, "invalid surrogate pair");
+                }
+                s->code_point = 0;
+                s->hex_digits = 0;
+                s->state = STATE_UNICODE;
+                continue;
+            case STATE_NUMBER:
+                if ((ch >= '0' && ch <= '9') || ch == '-' || ch == '+' || ch == '.' || ch == 'e' || ch == 'E') {
+                    if (!token_append(s, &ch, 1)) {
+                        return fail(s, "out of memory");
+                    }
+                    i++;
+                } else if (!finish_number(s)) {
+                    return LINX_JSON_STREAM_ERROR;
+                }
+                /* The terminating character is scanned again in the next state */
+                continue;
+            case STATE_LITERAL:
+                i++;
+                if (ch != s->literal[s->literal_pos]) {
+                    return fail(s, "invalid literal");
+                }
+                if (s->literal[++s->literal_pos] == '\0' && !finish_literal(s)) {
+                    return LINX_JSON_STREAM_ERROR;
+                }
+                continue;
+            default:
+                break;
+        }
+
+        /* Structural states: whitespace between tokens is skipped */
+        i++;
+        if (is_space(ch)) {
+            continue;
+        }
+        bool ok;
+        switch (s->state) {
+            case STATE_VALUE:
+                ok = begin_value(s, ch);
+                break;
+            case STATE_VALUE_OR_END:
+                ok = ch == ']' ? close_container(s, false) : begin_value(s, ch);
+                break;
+            case STATE_KEY_OR_END:
+            case STATE_KEY:
+                if (ch == '}' && s->state == STATE_KEY_OR_END) {
+                    ok = close_container(s, true);
+                } else if (ch == '"') {
+                    ok = begin_string(s, true);
+                } else {
+                    return fail(s, "expected key");
+                }
+                break;
+            case STATE_COLON:
+                if (ch != ':') {
+                    return fail(s, "expected ':'");
+                }
+                s->state = STATE_VALUE;
+                ok = true;
+                break;
+            case STATE_AFTER:
+                if (ch == ',') {
+                    s->state = cJSON_IsObject(s->stack[s->depth - 1]) ? STATE_KEY : STATE_VALUE;
+                    ok = true;
+                } else if (ch == '}' || ch == ']') {
+                    ok = close_container(s, ch == '}');
+                } else {
+                    return fail(s, "expected ',' or closing bracket");
+                }
+                break;
+            case STATE_DONE:
+                return fail(s, "trailing characters");
+            default:
+                return fail(s, "invalid state");
+        }
+        if (!ok) {
+            return LINX_JSON_STREAM_ERROR;
+        }
+    }
+    return s->state == STATE_DONE ? LINX_JSON_STREAM_DONE : LINX_JSON_STREAM_MORE;
+}
+
+cJSON* linx_json_stream_finish(linx_json_stream_t* s) {
+    if (!s) {
+        return NULL;
+    }
+    /* A top-level number has no terminator of its own */
+    if (s->state == STATE_NUMBER && s->depth == 0) {
+        finish_number(s);
+    }
+    cJSON* root = NULL;
+    if (s->state == STATE_DONE) {
+        root = s->root;
+        s->root = NULL;
+    } else if (s->state != STATE_ERROR) {
+        fail(s, "incomplete input");
+    }
+    const char* error = s->error;
+    linx_json_stream_reset(s);
+    s->error = error;
+    return root;
+}
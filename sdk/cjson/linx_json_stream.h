@@ -0,0 +1,78 @@
+#ifndef LINX_JSON_STREAM_H
+#define LINX_JSON_STREAM_H
+
+/*
+ * 增量 JSON 解析器
+ *
+ * JSON 文本按到达顺序分段喂入，边扫描边建 cJSON 树，不需要先拼出整条文本，
+ * 用于 WebSocket 分片到达的大消息：峰值内存是树本身，加上正在扫描的一个
+ * 字符串/数字/键和按嵌套深度增长的父节点栈。分段可以在任意字节处切开
+ * （包括转义序列和 UTF-8 字符中间）。
+ *
+ * 节点经 cJSON 的分配钩子分配：超出限制（cJSON_ParseLimits，与 cJSON_ParseWithLimits()
+ * 含义相同）或语法错误时立即放弃并释放已建的节点，之后的输入被忽略直到
+ * linx_json_stream_reset()。
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "cJSON.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct linx_json_stream linx_json_stream_t;
+
+/* 喂入结果 */
+typedef enum {
+    LINX_JSON_STREAM_MORE = 0,      // 顶层值尚未结束，需要更多输入
+    LINX_JSON_STREAM_DONE,          // 顶层值已完整（之后只允许空白）
+    LINX_JSON_STREAM_ERROR          // 语法错误或超出限制，见 linx_json_stream_error()
+} linx_json_stream_status_t;
+
+/**
+ * 创建解析器
+ * @param limits 解析限制，复制保存；NULL 只受 CJSON_NESTING_LIMIT 限制
+ * @return 解析器，内存不足返回 NULL
+ */
+linx_json_stream_t* linx_json_stream_create(const cJSON_ParseLimits* limits);
+
+/**
+ * 销毁解析器，未取走的树一并释放
+ */
+void linx_json_stream_destroy(linx_json_stream_t* stream);
+
+/**
+ * 丢弃当前的树和扫描状态，开始下一份文本
+ */
+void linx_json_stream_reset(linx_json_stream_t* stream);
+
+/**
+ * 喂入一段文本
+ * @return 喂入后的状态；已经是 ERROR 时直接返回 ERROR
+ */
+linx_json_stream_status_t linx_json_stream_feed(linx_json_stream_t* stream, const char* data, size_t size);
+
+/**
+ * 输入结束，取走树并重置解析器
+ * 顶层是数字时以输入结束作为数字的结尾
+ * @return 完整的树（调用者用 cJSON_Delete() 释放）；文本不完整或出错返回 NULL
+ */
+cJSON* linx_json_stream_finish(linx_json_stream_t* stream);
+
+/**
+ * 出错原因（静态字符串），没有出错返回 NULL
+ */
+const char* linx_json_stream_error(const linx_json_stream_t* stream);
+
+/**
+ * 已喂入的字节数（自上次 reset / finish 起）
+ */
+size_t linx_json_stream_consumed(const linx_json_stream_t* stream);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINX_JSON_STREAM_H */
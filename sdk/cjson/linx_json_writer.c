@@ -0,0 +1,395 @@
+#include "linx_json_writer.h"
+#include "../log/linx_alloc.h"
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_JSON);
+
+/* 首次分配的缓冲区大小，足以容纳常见控制消息 */
+#define LINX_JSON_WRITER_INITIAL_CAPACITY 256
+
+/* cJSON 打印数字的最大长度（"%1.17g" 的结果，见 cJSON.c print_number） */
+#define LINX_JSON_NUMBER_MAX_LENGTH 26
+
+static bool writer_reserve(linx_json_writer_t* w, size_t extra) {
+    if (w->failed) {
+        return false;
+    }
+
+    /* 额外预留结尾的 '\0' */
+    if (extra > SIZE_MAX - w->length - 1) {
+        w->failed = true;
+        return false;
+    }
+    size_t needed = w->length + extra + 1;
+    if (needed <= w->capacity) {
+        return true;
+    }
+
+    size_t capacity = w->capacity ? w->capacity : LINX_JSON_WRITER_INITIAL_CAPACITY;
+    while (capacity < needed) {
+        if (capacity > SIZE_MAX / 2) {
+            capacity = needed;
+            break;
+        }
+        capacity *= 2;
+    }
+
+    char* buffer = (char*)LINX_REALLOC(w->buffer, capacity);
+    if (!buffer) {
+        w->failed = true;
+        return false;
+    }
+    w->buffer = buffer;
+    w->capacity = capacity;
+    return true;
+}
+
+static bool writer_append(linx_json_writer_t* w, const char* data, size_t length) {
+    if (!writer_reserve(w, length)) {
+        return false;
+    }
+    memcpy(w->buffer + w->length, data, length);
+    w->length += length;
+    return true;
+}
+
+static bool writer_append_char(linx_json_writer_t* w, char ch) {
+    if (!writer_reserve(w, 1)) {
+        return false;
+    }
+    w->buffer[w->length++] = ch;
+    return true;
+}
+
+/* 写入值之前的分隔处理：键名之后直接写值，数组/顶层元素之间补逗号 */
+static bool writer_before_value(linx_json_writer_t* w) {
+    if (w->failed) {
+        return false;
+    }
+    if (w->after_key) {
+        w->after_key = false;
+        return true;
+    }
+    if (w->depth > 0) {
+        uint32_t bit = 1u << (w->depth - 1);
+        if (w->has_items & bit) {
+            if (!writer_append_char(w, ',')) {
+                return false;
+            }
+        }
+        w->has_items |= bit;
+    }
+    return true;
+}
+
+static bool writer_append_escaped(linx_json_writer_t* w, const char* str) {
+    static const char hex[] = "0123456789abcdef";
+
+    if (!writer_append_char(w, '"')) {
+        return false;
+    }
+
+    const char* end = str + strlen(str);
+    const char* run = str;
+    for (const char* p = str; p < end; ) {
+        /* 先整段写出无需转义的部分 */
+        p += cJSON_StringPlainSpan(p, (size_t)(end - p));
+        if (p > run && !writer_append(w, run, (size_t)(p - run))) {
+            return false;
+        }
+        if (p == end) {
+            break;
+        }
+        unsigned char ch = (unsigned char)*p++;
+        run = p;
+
+        char esc[6] = { '\\', 0, 0, 0, 0, 0 };
+        size_t esc_len = 2;
+        switch (ch) {
+            case '"':  esc[1] = '"';  break;
+            case '\\': esc[1] = '\\'; break;
+            case '\b': esc[1] = 'b';  break;
+            case '\f': esc[1] = 'f';  break;
+            case '\n': esc[1] = 'n';  break;
+            case '\r': esc[1] = 'r';  break;
+            case '\t': esc[1] = 't';  break;
+            default:
+                esc[1] = 'u';
+                esc[2] = '0';
+                esc[3] = '0';
+                esc[4] = hex[ch >> 4];
+                esc[5] = hex[ch & 0x0f];
+                esc_len = 6;
+                break;
+        }
+        if (!writer_append(w, esc, esc_len)) {
+            return false;
+        }
+    }
+
+    return writer_append_char(w, '"');
+}
+
+static bool writer_begin_container(linx_json_writer_t* w, char open) {
+    if (!writer_before_value(w)) {
+        return false;
+    }
+    if (w->depth >= LINX_JSON_WRITER_MAX_DEPTH) {
+        w->failed = true;
+        return false;
+    }
+    if (!writer_append_char(w, open)) {
+        return false;
+    }
+    w->depth++;
+    w->has_items &= ~(1u << (w->depth - 1));
+    return true;
+}
+
+static bool writer_end_container(linx_json_writer_t* w, char close) {
+    if (w->failed) {
+        return false;
+    }
+    if (w->depth == 0 || w->after_key) {
+        w->failed = true;
+        return false;
+    }
+    if (!writer_append_char(w, close)) {
+        return false;
+    }
+    w->depth--;
+    return true;
+}
+
+void linx_json_writer_init(linx_json_writer_t* writer) {
+    if (writer) {
+        memset(writer, 0, sizeof(*writer));
+    }
+}
+
+void linx_json_writer_free(linx_json_writer_t* writer) {
+    if (!writer) {
+        return;
+    }
+    LINX_FREE(writer->buffer);
+    memset(writer, 0, sizeof(*writer));
+}
+
+void linx_json_writer_reset(linx_json_writer_t* writer) {
+    if (!writer) {
+        return;
+    }
+    writer->length = 0;
+    writer->has_items = 0;
+    writer->depth = 0;
+    writer->after_key = false;
+    writer->failed = false;
+}
+
+bool linx_json_writer_begin_object(linx_json_writer_t* writer) {
+    return writer && writer_begin_container(writer, '{');
+}
+
+bool linx_json_writer_end_object(linx_json_writer_t* writer) {
+    return writer && writer_end_container(writer, '}');
+}
+
+bool linx_json_writer_begin_array(linx_json_writer_t* writer) {
+    return writer && writer_begin_container(writer, '[');
+}
+
+bool linx_json_writer_end_array(linx_json_writer_t* writer) {
+    return writer && writer_end_container(writer, ']');
+}
+
+bool linx_json_writer_key(linx_json_writer_t* writer, const char* key) {
+    if (!writer || writer->failed) {
+        return false;
+    }
+    if (!key || writer->depth == 0 || writer->after_key) {
+        writer->failed = true;
+        return false;
+    }
+    if (!writer_before_value(writer) ||
+        !writer_append_escaped(writer, key) ||
+        !writer_append_char(writer, ':')) {
+        return false;
+    }
+    writer->after_key = true;
+    return true;
+}
+
+bool linx_json_writer_string(linx_json_writer_t* writer, const char* value) {
+    if (!value) {
+        return linx_json_writer_null(writer);
+    }
+    return writer && writer_before_value(writer) && writer_append_escaped(writer, value);
+}
+
+bool linx_json_writer_int(linx_json_writer_t* writer, long long value) {
+    if (!writer || !writer_before_value(writer)) {
+        return false;
+    }
+
+    char digits[24];
+    size_t pos = sizeof(digits);
+    /* 以无符号数运算，避免取反 LLONG_MIN 溢出 */
+    unsigned long long magnitude = value < 0 ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+    do {
+        digits[--pos] = (char)('0' + (magnitude % 10));
+        magnitude /= 10;
+    } while (magnitude > 0);
+    if (value < 0) {
+        digits[--pos] = '-';
+    }
+    return writer_append(writer, digits + pos, sizeof(digits) - pos);
+}
+
+bool linx_json_writer_bool(linx_json_writer_t* writer, bool value) {
+    if (!writer || !writer_before_value(writer)) {
+        return false;
+    }
+    return value ? writer_append(writer, "true", 4) : writer_append(writer, "false", 5);
+}
+
+bool linx_json_writer_null(linx_json_writer_t* writer) {
+    if (!writer || !writer_before_value(writer)) {
+        return false;
+    }
+    return writer_append(writer, "null", 4);
+}
+
+bool linx_json_writer_raw(linx_json_writer_t* writer, const char* json, size_t length) {
+    if (!writer || writer->failed) {
+        return false;
+    }
+    if (!json || length == 0) {
+        writer->failed = true;
+        return false;
+    }
+    return writer_before_value(writer) && writer_append(writer, json, length);
+}
+
+bool linx_json_writer_add_string(linx_json_writer_t* writer, const char* key, const char* value) {
+    return linx_json_writer_key(writer, key) && linx_json_writer_string(writer, value);
+}
+
+bool linx_json_writer_add_int(linx_json_writer_t* writer, const char* key, long long value) {
+    return linx_json_writer_key(writer, key) && linx_json_writer_int(writer, value);
+}
+
+bool linx_json_writer_add_bool(linx_json_writer_t* writer, const char* key, bool value) {
+    return linx_json_writer_key(writer, key) && linx_json_writer_bool(writer, value);
+}
+
+bool linx_json_writer_add_raw(linx_json_writer_t* writer, const char* key, const char* json, size_t length) {
+    return linx_json_writer_key(writer, key) && linx_json_writer_raw(writer, json, length);
+}
+
+bool linx_json_writer_value(linx_json_writer_t* writer, const cJSON* item) {
+    if (!writer || writer->failed) {
+        return false;
+    }
+    size_t estimate = linx_json_print_estimate(item);
+    if (estimate == 0 || estimate > INT_MAX - LINX_JSON_PRINT_SLACK) {
+        writer->failed = true;
+        return false;
+    }
+    if (!writer_before_value(writer) || !writer_reserve(writer, estimate + LINX_JSON_PRINT_SLACK)) {
+        return false;
+    }
+
+    char* out = writer->buffer + writer->length;
+    size_t available = writer->capacity - writer->length;
+    if (!cJSON_PrintPreallocated((cJSON*)item, out, available > INT_MAX ? INT_MAX : (int)available, 0)) {
+        writer->failed = true;
+        return false;
+    }
+    writer->length += strlen(out);
+    return true;
+}
+
+bool linx_json_writer_add_value(linx_json_writer_t* writer, const char* key, const cJSON* item) {
+    return linx_json_writer_key(writer, key) && linx_json_writer_value(writer, item);
+}
+
+const char* linx_json_print(linx_json_writer_t* writer, const cJSON* item) {
+    if (!writer) {
+        return NULL;
+    }
+    linx_json_writer_reset(writer);
+    if (!linx_json_writer_value(writer, item)) {
+        return NULL;
+    }
+    return linx_json_writer_finish(writer);
+}
+
+/* 带引号的字符串，转义规则与 cJSON print_string_ptr 一致（NULL 打印为 ""） */
+static size_t json_string_estimate(const char* str) {
+    size_t size = 2;
+    if (!str) {
+        return size;
+    }
+    const char* end = str + strlen(str);
+    for (const unsigned char* p = (const unsigned char*)str; (const char*)p < end; p++) {
+        size_t plain = cJSON_StringPlainSpan((const char*)p, (size_t)(end - (const char*)p));
+        size += plain;
+        p += plain;
+        if ((const char*)p == end) {
+            break;
+        }
+        if (*p == '"' || *p == '\\' || *p == '\b' || *p == '\f' || *p == '\n' || *p == '\r' || *p == '\t') {
+            size += 2;
+        } else {
+            size += 6;
+        }
+    }
+    return size;
+}
+
+size_t linx_json_print_estimate(const cJSON* item) {
+    if (!item) {
+        return 0;
+    }
+
+    size_t size;
+    switch (item->type & 0xFF) {
+        case cJSON_NULL:
+        case cJSON_True:
+            return 4;
+        case cJSON_False:
+            return 5;
+        case cJSON_Number:
+            return LINX_JSON_NUMBER_MAX_LENGTH;
+        case cJSON_String:
+            return json_string_estimate(item->valuestring);
+        case cJSON_Raw:
+            return item->valuestring ? strlen(item->valuestring) : 0;
+        case cJSON_Array:
+            /* 括号，每个元素后最多一个逗号 */
+            size = 2;
+            for (const cJSON* child = item->child; child; child = child->next) {
+                size += linx_json_print_estimate(child) + 1;
+            }
+            return size;
+        case cJSON_Object:
+            /* 括号，每个成员的键、冒号和逗号 */
+            size = 2;
+            for (const cJSON* child = item->child; child; child = child->next) {
+                size += json_string_estimate(child->string) + linx_json_print_estimate(child) + 2;
+            }
+            return size;
+        default:
+            return 0;
+    }
+}
+
+const char* linx_json_writer_finish(linx_json_writer_t* writer) {
+    if (!writer || writer->failed || writer->depth != 0 || writer->after_key || writer->length == 0) {
+        return NULL;
+    }
+    writer->buffer[writer->length] = '\0';
+    return writer->buffer;
+}
@@ -0,0 +1,135 @@
+#ifndef LINX_JSON_WRITER_H
+#define LINX_JSON_WRITER_H
+
+/*
+ * 追加式 JSON 写入器
+ *
+ * 用于构建上行控制消息：按顺序追加键值，字符串自动转义，缓冲区按需扩容，
+ * 不会截断。reset 后复用同一块缓冲区，稳定运行时不再产生内存分配。
+ * 已序列化好的 JSON（如 MCP 载荷）可通过 raw 接口原样嵌入，cJSON 树可通过 value 接口
+ * 紧凑打印进同一块缓冲区（linx_json_print() 用写入器作为可复用的打印缓冲区，替代 cJSON_Print）。
+ *
+ * 任一步骤失败（内存不足、嵌套不匹配）后写入器进入失败状态，
+ * 后续追加均被忽略，linx_json_writer_finish() 返回 NULL。
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "cJSON.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* cJSON_PrintPreallocated 要求在所需长度之外多留的字节 */
+#define LINX_JSON_PRINT_SLACK 5
+
+/* 最大嵌套深度 */
+#define LINX_JSON_WRITER_MAX_DEPTH 32
+
+/* 写入器状态 */
+typedef struct {
+    char* buffer;                   // 输出缓冲区（以 '\0' 结尾）
+    size_t length;                  // 已写入长度
+    size_t capacity;                // 缓冲区容量
+    uint32_t has_items;             // 每层容器是否已有元素（按位，决定是否补逗号）
+    uint8_t depth;                  // 当前嵌套深度
+    bool after_key;                 // 刚写完键名，等待值
+    bool failed;                    // 是否已失败
+} linx_json_writer_t;
+
+/**
+ * 初始化写入器（不分配内存，首次写入时再分配）
+ * @param writer 写入器
+ */
+void linx_json_writer_init(linx_json_writer_t* writer);
+
+/**
+ * 释放写入器的缓冲区
+ * @param writer 写入器
+ */
+void linx_json_writer_free(linx_json_writer_t* writer);
+
+/**
+ * 清空内容以便复用，保留已分配的缓冲区
+ * @param writer 写入器
+ */
+void linx_json_writer_reset(linx_json_writer_t* writer);
+
+/* 容器 */
+bool linx_json_writer_begin_object(linx_json_writer_t* writer);
+bool linx_json_writer_end_object(linx_json_writer_t* writer);
+bool linx_json_writer_begin_array(linx_json_writer_t* writer);
+bool linx_json_writer_end_array(linx_json_writer_t* writer);
+
+/**
+ * 写入对象键名（自动转义）
+ * @param writer 写入器
+ * @param key 键名
+ * @return 成功返回 true
+ */
+bool linx_json_writer_key(linx_json_writer_t* writer, const char* key);
+
+/* 值（string 为 NULL 时写入 null） */
+bool linx_json_writer_string(linx_json_writer_t* writer, const char* value);
+bool linx_json_writer_int(linx_json_writer_t* writer, long long value);
+bool linx_json_writer_bool(linx_json_writer_t* writer, bool value);
+bool linx_json_writer_null(linx_json_writer_t* writer);
+
+/**
+ * 原样写入已序列化的 JSON 值（调用者保证其合法）
+ * @param writer 写入器
+ * @param json JSON 文本
+ * @param length 文本长度
+ * @return 成功返回 true
+ */
+bool linx_json_writer_raw(linx_json_writer_t* writer, const char* json, size_t length);
+
+/**
+ * 以紧凑格式写入一棵 cJSON 树作为值
+ * 先遍历估算长度并一次性预留，再用 cJSON_PrintPreallocated 直接打印进缓冲区，
+ * 不经过 cJSON 打印时的逐步扩容
+ * @param writer 写入器
+ * @param item cJSON 节点
+ * @return 成功返回 true
+ */
+bool linx_json_writer_value(linx_json_writer_t* writer, const cJSON* item);
+
+/* 键值对便捷接口 */
+bool linx_json_writer_add_string(linx_json_writer_t* writer, const char* key, const char* value);
+bool linx_json_writer_add_int(linx_json_writer_t* writer, const char* key, long long value);
+bool linx_json_writer_add_bool(linx_json_writer_t* writer, const char* key, bool value);
+bool linx_json_writer_add_raw(linx_json_writer_t* writer, const char* key, const char* json, size_t length);
+bool linx_json_writer_add_value(linx_json_writer_t* writer, const char* key, const cJSON* item);
+
+/**
+ * 结束写入并获取结果
+ * @param writer 写入器
+ * @return 以 '\0' 结尾的 JSON 文本（归写入器所有，reset 前有效）；
+ *         失败或容器未闭合时返回 NULL
+ */
+const char* linx_json_writer_finish(linx_json_writer_t* writer);
+
+/**
+ * 把整棵 cJSON 树紧凑打印到写入器（先 reset），用于替代 cJSON_Print / cJSON_PrintUnformatted：
+ * 缓冲区归调用者的写入器所有并被复用，稳定运行时不再分配
+ * @param writer 用作打印缓冲区的写入器
+ * @param item cJSON 节点
+ * @return 以 '\0' 结尾的 JSON 文本（reset 前有效），失败返回 NULL
+ */
+const char* linx_json_print(linx_json_writer_t* writer, const cJSON* item);
+
+/**
+ * 紧凑打印 item 所需字节数的上界（不含结尾 '\0' 和 LINX_JSON_PRINT_SLACK）
+ * 字符串按实际转义计算，数字按 cJSON 格式化的最大长度计算
+ * @param item cJSON 节点
+ * @return 字节数，item 为 NULL 或类型无效时返回 0
+ */
+size_t linx_json_print_estimate(const cJSON* item);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINX_JSON_WRITER_H */
@@ -0,0 +1,322 @@
+#include "adpcm_codec.h"
+#include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
+#include <stdlib.h>
+#include <string.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_CODEC);
+
+#define ADPCM_MAX_CHANNELS  2
+#define ADPCM_MAX_INDEX     88
+
+// 单声道预测状态
+typedef struct {
+    int predictor;
+    int index;
+} adpcm_channel_state_t;
+
+// IMA-ADPCM 实现数据
+typedef struct {
+    adpcm_channel_state_t encoder[ADPCM_MAX_CHANNELS];
+} adpcm_codec_impl_t;
+
+static const int16_t adpcm_step_table[ADPCM_MAX_INDEX + 1] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+    19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+    130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+    337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+    876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+    5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+static const int8_t adpcm_index_table[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+// 前向声明
+static codec_error_t adpcm_init_encoder(audio_codec_t* codec, const audio_format_t* format);
+static codec_error_t adpcm_init_decoder(audio_codec_t* codec, const audio_format_t* format);
+static codec_error_t adpcm_encode(audio_codec_t* codec, const int16_t* input, size_t input_size,
+                                 uint8_t* output, size_t output_size, size_t* encoded_size);
+static codec_error_t adpcm_decode(audio_codec_t* codec, const uint8_t* input, size_t input_size,
+                                 int16_t* output, size_t output_size, size_t* decoded_size);
+static const char* adpcm_get_codec_name(const audio_codec_t* codec);
+static codec_error_t adpcm_reset(audio_codec_t* codec);
+static int adpcm_get_input_frame_size(const audio_codec_t* codec);
+static int adpcm_get_max_output_size(const audio_codec_t* codec);
+static void adpcm_destroy(audio_codec_t* codec);
+
+// IMA-ADPCM 编解码器虚函数表
+static const audio_codec_vtable_t adpcm_vtable = {
+    .init_encoder = adpcm_init_encoder,
+    .init_decoder = adpcm_init_decoder,
+    .encode = adpcm_encode,
+    .decode = adpcm_decode,
+    .get_codec_name = adpcm_get_codec_name,
+    .reset = adpcm_reset,
+    .get_input_frame_size = adpcm_get_input_frame_size,
+    .get_max_output_size = adpcm_get_max_output_size,
+    .destroy = adpcm_destroy
+};
+
+static inline int adpcm_clamp_sample(int value) {
+    if (value > 32767) {
+        return 32767;
+    }
+    if (value < -32768) {
+        return -32768;
+    }
+    return value;
+}
+
+static inline int adpcm_clamp_index(int index) {
+    if (index < 0) {
+        return 0;
+    }
+    if (index > ADPCM_MAX_INDEX) {
+        return ADPCM_MAX_INDEX;
+    }
+    return index;
+}
+
+// 编码一个样本，返回 4 位码字并更新状态
+static inline uint8_t adpcm_encode_sample(adpcm_channel_state_t* state, int sample) {
+    int step = adpcm_step_table[state->index];
+    int diff = sample - state->predictor;
+    uint8_t code = 0;
+    if (diff < 0) {
+        code = 8;
+        diff = -diff;
+    }
+
+    // 逐位逼近，delta 与解码端重建的差值完全一致
+    int delta = step >> 3;
+    if (diff >= step) {
+        code |= 4;
+        diff -= step;
+        delta += step;
+    }
+    step >>= 1;
+    if (diff >= step) {
+        code |= 2;
+        diff -= step;
+        delta += step;
+    }
+    step >>= 1;
+    if (diff >= step) {
+        code |= 1;
+        delta += step;
+    }
+
+    state->predictor = adpcm_clamp_sample(state->predictor + ((code & 8) ? -delta : delta));
+    state->index = adpcm_clamp_index(state->index + adpcm_index_table[code]);
+    return code;
+}
+
+// 解码一个 4 位码字并更新状态
+static inline int16_t adpcm_decode_sample(adpcm_channel_state_t* state, uint8_t code) {
+    int step = adpcm_step_table[state->index];
+    int delta = step >> 3;
+    if (code & 4) {
+        delta += step;
+    }
+    if (code & 2) {
+        delta += step >> 1;
+    }
+    if (code & 1) {
+        delta += step >> 2;
+    }
+
+    state->predictor = adpcm_clamp_sample(state->predictor + ((code & 8) ? -delta : delta));
+    state->index = adpcm_clamp_index(state->index + adpcm_index_table[code]);
+    return (int16_t)state->predictor;
+}
+
+// 创建 IMA-ADPCM 编解码器实例
+audio_codec_t* adpcm_codec_create(void) {
+    audio_codec_t* codec = (audio_codec_t*)LINX_CALLOC(1, sizeof(audio_codec_t));
+    if (!codec) {
+        LOG_ERROR("Failed to allocate memory for ADPCM codec");
+        return NULL;
+    }
+
+    adpcm_codec_impl_t* impl = (adpcm_codec_impl_t*)LINX_CALLOC(1, sizeof(adpcm_codec_impl_t));
+    if (!impl) {
+        LOG_ERROR("Failed to allocate memory for ADPCM codec implementation");
+        LINX_FREE(codec);
+        return NULL;
+    }
+
+    codec->vtable = &adpcm_vtable;
+    codec->impl_data = impl;
+    audio_format_default(&codec->format);
+
+    LOG_INFO("ADPCM codec created successfully");
+    return codec;
+}
+
+static codec_error_t adpcm_init_encoder(audio_codec_t* codec, const audio_format_t* format) {
+    if (!codec || !codec->impl_data || !format || format->bits_per_sample != 16 ||
+        format->channels <= 0 || format->channels > ADPCM_MAX_CHANNELS) {
+        return CODEC_INVALID_PARAMETER;
+    }
+
+    adpcm_codec_impl_t* impl = (adpcm_codec_impl_t*)codec->impl_data;
+    memset(impl->encoder, 0, sizeof(impl->encoder));
+    codec->format = *format;
+    codec->encoder_initialized = true;
+    return CODEC_SUCCESS;
+}
+
+static codec_error_t adpcm_init_decoder(audio_codec_t* codec, const audio_format_t* format) {
+    if (!codec || !codec->impl_data || !format || format->bits_per_sample != 16 ||
+        format->channels <= 0 || format->channels > ADPCM_MAX_CHANNELS) {
+        return CODEC_INVALID_PARAMETER;
+    }
+    codec->format = *format;
+    codec->decoder_initialized = true;
+    return CODEC_SUCCESS;
+}
+
+static codec_error_t adpcm_encode(audio_codec_t* codec, const int16_t* input, size_t input_size,
+                                 uint8_t* output, size_t output_size, size_t* encoded_size) {
+    if (!codec || !codec->impl_data || !input || !output || !encoded_size) {
+        return CODEC_INVALID_PARAMETER;
+    }
+    if (!codec->encoder_initialized) {
+        return CODEC_INITIALIZATION_FAILED;
+    }
+
+    int channels = codec->format.channels;
+    if (input_size % 2 != 0 || input_size % (size_t)channels != 0) {
+        return CODEC_INVALID_PARAMETER;
+    }
+    size_t packet_bytes = ADPCM_PACKET_BYTES(input_size, channels);
+    if (packet_bytes > output_size) {
+        return CODEC_BUFFER_TOO_SMALL;
+    }
+
+    adpcm_codec_impl_t* impl = (adpcm_codec_impl_t*)codec->impl_data;
+    uint8_t* out = output;
+    for (int c = 0; c < channels; c++) {
+        uint16_t predictor = (uint16_t)(int16_t)impl->encoder[c].predictor;
+        *out++ = (uint8_t)(predictor & 0xFF);
+        *out++ = (uint8_t)(predictor >> 8);
+        *out++ = (uint8_t)impl->encoder[c].index;
+        *out++ = 0;
+    }
+
+    if (channels == 1) {
+        // 单声道：两个样本一字节，不需要按声道取状态
+        adpcm_channel_state_t state = impl->encoder[0];
+        for (size_t i = 0; i < input_size / 2; i++) {
+            uint8_t low = adpcm_encode_sample(&state, input[2 * i]);
+            uint8_t high = adpcm_encode_sample(&state, input[2 * i + 1]);
+            out[i] = (uint8_t)(low | (high << 4));
+        }
+        impl->encoder[0] = state;
+    } else {
+        memset(out, 0, input_size / 2);
+        for (size_t i = 0; i < input_size; i++) {
+            uint8_t code = adpcm_encode_sample(&impl->encoder[i % (size_t)channels], input[i]);
+            out[i >> 1] |= (uint8_t)(code << ((i & 1) * 4));
+        }
+    }
+
+    *encoded_size = packet_bytes;
+    return CODEC_SUCCESS;
+}
+
+static codec_error_t adpcm_decode(audio_codec_t* codec, const uint8_t* input, size_t input_size,
+                                 int16_t* output, size_t output_size, size_t* decoded_size) {
+    if (!codec || !input || !output || !decoded_size) {
+        return CODEC_INVALID_PARAMETER;
+    }
+    if (!codec->decoder_initialized) {
+        return CODEC_INITIALIZATION_FAILED;
+    }
+
+    int channels = codec->format.channels;
+    size_t header_bytes = (size_t)channels * ADPCM_HEADER_BYTES_PER_CHANNEL;
+    if (input_size < header_bytes) {
+        LOG_WARN("ADPCM decoder: packet too short (%zu bytes)", input_size);
+        return CODEC_DECODING_FAILED;
+    }
+
+    // 包头恢复预测状态，每个包独立解码
+    adpcm_channel_state_t states[ADPCM_MAX_CHANNELS];
+    for (int c = 0; c < channels; c++) {
+        const uint8_t* header = input + c * ADPCM_HEADER_BYTES_PER_CHANNEL;
+        states[c].predictor = (int16_t)((uint16_t)header[0] | ((uint16_t)header[1] << 8));
+        states[c].index = adpcm_clamp_index(header[2]);
+    }
+
+    size_t samples = (input_size - header_bytes) * 2;
+    if (samples % (size_t)channels != 0) {
+        return CODEC_DECODING_FAILED;
+    }
+    if (samples > output_size) {
+        return CODEC_BUFFER_TOO_SMALL;
+    }
+
+    const uint8_t* data = input + header_bytes;
+    if (channels == 1) {
+        adpcm_channel_state_t state = states[0];
+        for (size_t i = 0; i < samples / 2; i++) {
+            output[2 * i] = adpcm_decode_sample(&state, data[i] & 0x0F);
+            output[2 * i + 1] = adpcm_decode_sample(&state, data[i] >> 4);
+        }
+    } else {
+        for (size_t i = 0; i < samples; i++) {
+            uint8_t code = (data[i >> 1] >> ((i & 1) * 4)) & 0x0F;
+            output[i] = adpcm_decode_sample(&states[i % (size_t)channels], code);
+        }
+    }
+
+    *decoded_size = samples;
+    return CODEC_SUCCESS;
+}
+
+static const char* adpcm_get_codec_name(const audio_codec_t* codec) {
+    (void)codec;
+    return "IMA-ADPCM";
+}
+
+// 重置编码器预测状态
+static codec_error_t adpcm_reset(audio_codec_t* codec) {
+    if (!codec || !codec->impl_data) {
+        return CODEC_INVALID_PARAMETER;
+    }
+    adpcm_codec_impl_t* impl = (adpcm_codec_impl_t*)codec->impl_data;
+    memset(impl->encoder, 0, sizeof(impl->encoder));
+    return CODEC_SUCCESS;
+}
+
+// 获取建议的输入帧大小（每声道样本数）
+static int adpcm_get_input_frame_size(const audio_codec_t* codec) {
+    if (!codec) {
+        return -1;
+    }
+    return codec->format.sample_rate * codec->format.frame_size_ms / 1000;
+}
+
+// 获取最大输出缓冲区大小（样本数，用于解码），与 Opus 一致按 120ms 计算
+static int adpcm_get_max_output_size(const audio_codec_t* codec) {
+    if (!codec) {
+        return -1;
+    }
+    return codec->format.sample_rate * 120 / 1000 * codec->format.channels;
+}
+
+static void adpcm_destroy(audio_codec_t* codec) {
+    if (!codec) {
+        return;
+    }
+    LINX_FREE(codec->impl_data);
+    LINX_FREE(codec);
+    LOG_INFO("ADPCM codec destroyed");
+}
@@ -0,0 +1,36 @@
+#ifndef ADPCM_CODEC_H
+#define ADPCM_CODEC_H
+
+#include "audio_codec.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * IMA-ADPCM 编解码器
+ *
+ * 每个样本压缩成 4 位，码率为 PCM16 的 1/4，编解码都只有加减、移位和查表。
+ *
+ * 包格式 (每个包都可独立解码，丢包不会影响后续包)：
+ *   每声道 4 字节头: int16 预测值 (小端) + uint8 步长索引 + 1 字节保留 (0)
+ *   之后是 4 位码字，按交织样本顺序排列，每字节先低 4 位后高 4 位
+ * 每包的 (交织) 样本数必须是偶数。
+ * 编码器在包之间保持预测状态连续，包头记录的是该包开始时的状态。
+ */
+
+// 每声道包头字节数
+#define ADPCM_HEADER_BYTES_PER_CHANNEL 4
+
+// 编码 samples 个 (交织) 样本后的包大小
+#define ADPCM_PACKET_BYTES(samples, channels) \
+    ((size_t)(channels) * ADPCM_HEADER_BYTES_PER_CHANNEL + (size_t)(samples) / 2)
+
+// 创建 IMA-ADPCM 编解码器实例
+audio_codec_t* adpcm_codec_create(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ADPCM_CODEC_H
@@ -59,6 +59,103 @@ codec_error_t audio_codec_decode(audio_codec_t* codec, const uint8_t* input, siz
     return codec->vtable->decode(codec, input, input_size, output, output_size, decoded_size);
 }
 
+codec_error_t audio_codec_encode_batch(audio_codec_t* codec, const int16_t* input, size_t frame_samples,
+                                      size_t frame_count, uint8_t* output, size_t output_size,
+                                      size_t* packet_sizes, size_t* encoded_frames) {
+    if (!codec || !codec->vtable || !codec->vtable->encode) {
+        LOG_ERROR("Invalid codec or vtable");
+        return CODEC_INVALID_PARAMETER;
+    }
+    
+    if (!input || !output || !packet_sizes || !encoded_frames || frame_samples == 0) {
+        LOG_ERROR("Invalid parameters");
+        return CODEC_INVALID_PARAMETER;
+    }
+    
+    *encoded_frames = 0;
+    if (codec->vtable->encode_batch) {
+        return codec->vtable->encode_batch(codec, input, frame_samples, frame_count,
+                                           output, output_size, packet_sizes, encoded_frames);
+    }
+    
+    // 默认实现：逐帧编码
+    size_t offset = 0;
+    for (size_t i = 0; i < frame_count; i++) {
+        size_t encoded_size = 0;
+        codec_error_t result = codec->vtable->encode(codec, input + i * frame_samples, frame_samples,
+                                                     output + offset, output_size - offset, &encoded_size);
+        if (result != CODEC_SUCCESS) {
+            return result;
+        }
+        packet_sizes[i] = encoded_size;
+        offset += encoded_size;
+        *encoded_frames = i + 1;
+    }
+    return CODEC_SUCCESS;
+}
+
+codec_error_t audio_codec_decode_batch(audio_codec_t* codec, const uint8_t* input, const size_t* packet_sizes,
+                                      size_t packet_count, int16_t* output, size_t output_size,
+                                      size_t* decoded_size, size_t* decoded_packets) {
+    if (!codec || !codec->vtable || !codec->vtable->decode) {
+        LOG_ERROR("Invalid codec or vtable");
+        return CODEC_INVALID_PARAMETER;
+    }
+    
+    if (!input || !packet_sizes || !output || !decoded_size || !decoded_packets) {
+        LOG_ERROR("Invalid parameters");
+        return CODEC_INVALID_PARAMETER;
+    }
+    
+    *decoded_size = 0;
+    *decoded_packets = 0;
+    if (codec->vtable->decode_batch) {
+        return codec->vtable->decode_batch(codec, input, packet_sizes, packet_count,
+                                           output, output_size, decoded_size, decoded_packets);
+    }
+    
+    // 默认实现：逐包解码
+    size_t offset = 0;
+    for (size_t i = 0; i < packet_count; i++) {
+        size_t samples = 0;
+        codec_error_t result = codec->vtable->decode(codec, input + offset, packet_sizes[i],
+                                                     output + *decoded_size, output_size - *decoded_size,
+                                                     &samples);
+        if (result != CODEC_SUCCESS) {
+            return result;
+        }
+        offset += packet_sizes[i];
+        *decoded_size += samples;
+        *decoded_packets = i + 1;
+    }
+    return CODEC_SUCCESS;
+}
+
+codec_error_t audio_codec_decode_lost(audio_codec_t* codec, const uint8_t* next_input, size_t next_input_size,
+                                     size_t frame_samples, int16_t* output, size_t output_size,
+                                     size_t* decoded_size) {
+    if (!codec || !codec->vtable) {
+        LOG_ERROR("Invalid codec or vtable");
+        return CODEC_INVALID_PARAMETER;
+    }
+    
+    if (!codec->vtable->decode_lost) {
+        return CODEC_UNSUPPORTED_FORMAT;
+    }
+    
+    if (!output || !decoded_size || frame_samples == 0) {
+        LOG_ERROR("Invalid parameters");
+        return CODEC_INVALID_PARAMETER;
+    }
+    
+    return codec->vtable->decode_lost(codec, next_input, next_input_size, frame_samples,
+                                      output, output_size, decoded_size);
+}
+
+bool audio_codec_supports_loss_recovery(const audio_codec_t* codec) {
+    return codec && codec->vtable && codec->vtable->decode_lost;
+}
+
 const char* audio_codec_get_name(const audio_codec_t* codec) {
     if (!codec || !codec->vtable || !codec->vtable->get_codec_name) {
         LOG_ERROR("Invalid codec or vtable");
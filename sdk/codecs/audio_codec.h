@@ -58,6 +58,37 @@ typedef struct {
     codec_error_t (*decode)(audio_codec_t* codec, const uint8_t* input, size_t input_size,
                            int16_t* output, size_t output_size, size_t* decoded_size);
     
+    // 批量编码连续多帧（可选，为 NULL 时由基类逐帧调用 encode）
+    // input: frame_count 帧连续的PCM数据
+    // frame_samples: 每帧样本数（与 encode 的 input_size 含义相同）
+    // output: 各帧编码结果依次紧密存放
+    // packet_sizes: 每帧编码后的字节数（长度至少为 frame_count）
+    // encoded_frames: 实际编码的帧数（出错时为出错前已完成的帧数）
+    codec_error_t (*encode_batch)(audio_codec_t* codec, const int16_t* input, size_t frame_samples,
+                                 size_t frame_count, uint8_t* output, size_t output_size,
+                                 size_t* packet_sizes, size_t* encoded_frames);
+    
+    // 批量解码多个包（可选，为 NULL 时由基类逐包调用 decode）
+    // input: packet_count 个包依次紧密存放
+    // packet_sizes: 每个包的字节数
+    // output: 解码后的PCM依次存放
+    // decoded_size: 实际解码的总样本数
+    // decoded_packets: 实际解码的包数（出错时为出错前已完成的包数）
+    codec_error_t (*decode_batch)(audio_codec_t* codec, const uint8_t* input, const size_t* packet_sizes,
+                                 size_t packet_count, int16_t* output, size_t output_size,
+                                 size_t* decoded_size, size_t* decoded_packets);
+    
+    // 恢复一个丢失的帧（可选，为 NULL 表示不支持）
+    // next_input: 丢失帧之后的下一个包，用于带内FEC恢复；为 NULL 时执行丢包隐藏（PLC）
+    // next_input_size: 下一个包的大小（字节数）
+    // frame_samples: 丢失帧的时长（每声道样本数）
+    // output: 恢复出的PCM音频数据缓冲区
+    // output_size: 输出缓冲区大小（样本数）
+    // decoded_size: 实际输出的样本数
+    codec_error_t (*decode_lost)(audio_codec_t* codec, const uint8_t* next_input, size_t next_input_size,
+                                size_t frame_samples, int16_t* output, size_t output_size,
+                                size_t* decoded_size);
+    
     // 获取编码器名称
     const char* (*get_codec_name)(const audio_codec_t* codec);
     
@@ -93,6 +124,16 @@ codec_error_t audio_codec_encode(audio_codec_t* codec, const int16_t* input, siz
                                 uint8_t* output, size_t output_size, size_t* encoded_size);
 codec_error_t audio_codec_decode(audio_codec_t* codec, const uint8_t* input, size_t input_size,
                                 int16_t* output, size_t output_size, size_t* decoded_size);
+codec_error_t audio_codec_encode_batch(audio_codec_t* codec, const int16_t* input, size_t frame_samples,
+                                      size_t frame_count, uint8_t* output, size_t output_size,
+                                      size_t* packet_sizes, size_t* encoded_frames);
+codec_error_t audio_codec_decode_batch(audio_codec_t* codec, const uint8_t* input, const size_t* packet_sizes,
+                                      size_t packet_count, int16_t* output, size_t output_size,
+                                      size_t* decoded_size, size_t* decoded_packets);
+codec_error_t audio_codec_decode_lost(audio_codec_t* codec, const uint8_t* next_input, size_t next_input_size,
+                                     size_t frame_samples, int16_t* output, size_t output_size,
+                                     size_t* decoded_size);
+bool audio_codec_supports_loss_recovery(const audio_codec_t* codec);
 const char* audio_codec_get_name(const audio_codec_t* codec);
 codec_error_t audio_codec_reset(audio_codec_t* codec);
 int audio_codec_get_input_frame_size(const audio_codec_t* codec);
@@ -0,0 +1,253 @@
+#include "codec_factory.h"
+#include "opus_codec.h"
+#include "pcm_codec.h"
+#include "g711_codec.h"
+#include "adpcm_codec.h"
+#include "../log/linx_log.h"
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+
+static audio_codec_t* create_pcmu(void) {
+    return g711_codec_create(G711_LAW_ULAW);
+}
+
+static audio_codec_t* create_pcma(void) {
+    return g711_codec_create(G711_LAW_ALAW);
+}
+
+// 内置格式，下标即类型
+static const codec_descriptor_t builtin_descriptors[CODEC_TYPE_COUNT] = {
+    [CODEC_TYPE_OPUS] = {
+        .name = "opus",
+        .cost = CODEC_COST_HIGH,
+        .bits_per_sample = 0,
+        .sample_rates = { 8000, 12000, 16000, 24000, 48000 },
+        .frame_sizes_ms = { 10, 20, 40, 60, 80, 100, 120 },
+        .create = opus_codec_create,
+    },
+    [CODEC_TYPE_PCM] = {
+        .name = "pcm",
+        .aliases = { "pcm_s16le" },
+        .cost = CODEC_COST_TRIVIAL,
+        .bits_per_sample = 16,
+        .create = pcm_codec_create,
+    },
+    [CODEC_TYPE_PCMU] = {
+        .name = "pcmu",
+        .aliases = { "g711u" },
+        .cost = CODEC_COST_TRIVIAL,
+        .bits_per_sample = 8,
+        .create = create_pcmu,
+    },
+    [CODEC_TYPE_PCMA] = {
+        .name = "pcma",
+        .aliases = { "g711a" },
+        .cost = CODEC_COST_TRIVIAL,
+        .bits_per_sample = 8,
+        .create = create_pcma,
+    },
+    [CODEC_TYPE_ADPCM] = {
+        .name = "adpcm",
+        .aliases = { "ima_adpcm" },
+        .cost = CODEC_COST_LOW,
+        .bits_per_sample = 4,
+        .create = adpcm_codec_create,
+    },
+};
+
+// 注册的编解码器，类型为 CODEC_TYPE_COUNT + 下标
+static codec_descriptor_t registered_descriptors[CODEC_FACTORY_MAX_REGISTERED];
+static size_t registered_count = 0;
+
+static bool descriptor_matches(const codec_descriptor_t* descriptor, const char* format) {
+    if (strcasecmp(format, descriptor->name) == 0) {
+        return true;
+    }
+    for (size_t i = 0; i < CODEC_FACTORY_MAX_ALIASES && descriptor->aliases[i]; i++) {
+        if (strcasecmp(format, descriptor->aliases[i]) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 注册的描述符覆盖同名的内置格式
+static bool builtin_overridden(codec_type_t type) {
+    for (size_t i = 0; i < registered_count; i++) {
+        if (strcasecmp(registered_descriptors[i].name, builtin_descriptors[type].name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+codec_error_t codec_factory_register(const codec_descriptor_t* descriptor, codec_type_t* type) {
+    if (!descriptor || !descriptor->name || !descriptor->create) {
+        return CODEC_INVALID_PARAMETER;
+    }
+    size_t slot = registered_count;
+    for (size_t i = 0; i < registered_count; i++) {
+        if (strcasecmp(registered_descriptors[i].name, descriptor->name) == 0) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot >= CODEC_FACTORY_MAX_REGISTERED) {
+        LOG_ERROR("Codec registry full (%d), cannot register %s", CODEC_FACTORY_MAX_REGISTERED, descriptor->name);
+        return CODEC_INVALID_PARAMETER;
+    }
+    registered_descriptors[slot] = *descriptor;
+    if (slot == registered_count) {
+        registered_count++;
+    }
+    if (type) {
+        *type = (codec_type_t)(CODEC_TYPE_COUNT + slot);
+    }
+    LOG_INFO("Codec registered: %s (cost %d)", descriptor->name, descriptor->cost);
+    return CODEC_SUCCESS;
+}
+
+const codec_descriptor_t* codec_factory_get_descriptor(codec_type_t type) {
+    if ((int)type >= 0 && type < CODEC_TYPE_COUNT) {
+        return &builtin_descriptors[type];
+    }
+    size_t slot = (size_t)type - CODEC_TYPE_COUNT;
+    if ((int)type >= CODEC_TYPE_COUNT && slot < registered_count) {
+        return &registered_descriptors[slot];
+    }
+    return NULL;
+}
+
+static bool list_contains(const int* values, size_t count, int value) {
+    if (values[0] == 0) {
+        return true;
+    }
+    for (size_t i = 0; i < count && values[i]; i++) {
+        if (values[i] == value) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool codec_factory_supports(const codec_descriptor_t* descriptor, int sample_rate, int frame_size_ms) {
+    if (!descriptor) {
+        return false;
+    }
+    return list_contains(descriptor->sample_rates, CODEC_FACTORY_MAX_SAMPLE_RATES, sample_rate) &&
+           (frame_size_ms <= 0 ||
+            list_contains(descriptor->frame_sizes_ms, CODEC_FACTORY_MAX_FRAME_SIZES, frame_size_ms));
+}
+
+audio_codec_t* codec_factory_create(codec_type_t type) {
+    const codec_descriptor_t* descriptor = codec_factory_get_descriptor(type);
+    if (!descriptor) {
+        LOG_ERROR("Unknown codec type: %d", type);
+        return NULL;
+    }
+    // 内置类型被同名注册覆盖时，按类型创建的也使用注册的实现
+    if (type < CODEC_TYPE_COUNT && builtin_overridden(type)) {
+        return codec_factory_create_for_format(descriptor->name);
+    }
+    return descriptor->create();
+}
+
+audio_codec_t* codec_factory_create_for_format(const char* format) {
+    codec_type_t type;
+    if (!codec_factory_parse_format(format, &type)) {
+        LOG_ERROR("Unsupported audio format: %s", format ? format : "(null)");
+        return NULL;
+    }
+    return codec_factory_get_descriptor(type)->create();
+}
+
+void codec_factory_destroy(audio_codec_t* codec) {
+    audio_codec_destroy(codec);
+}
+
+bool codec_factory_parse_format(const char* format, codec_type_t* type) {
+    if (!format || !type) {
+        return false;
+    }
+    for (size_t i = 0; i < registered_count; i++) {
+        if (descriptor_matches(&registered_descriptors[i], format)) {
+            *type = (codec_type_t)(CODEC_TYPE_COUNT + i);
+            return true;
+        }
+    }
+    for (int i = 0; i < CODEC_TYPE_COUNT; i++) {
+        if (descriptor_matches(&builtin_descriptors[i], format)) {
+            *type = (codec_type_t)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* codec_factory_format_name(codec_type_t type) {
+    const codec_descriptor_t* descriptor = codec_factory_get_descriptor(type);
+    return descriptor ? descriptor->name : NULL;
+}
+
+// 压缩率排序键：可变码率最前，其余按每样本位数
+static int offer_rank(const codec_descriptor_t* descriptor) {
+    return descriptor->bits_per_sample > 0 ? descriptor->bits_per_sample : 0;
+}
+
+size_t codec_factory_build_offer(const char* preferred, codec_cost_t max_cost, int sample_rate,
+                                 int frame_size_ms, size_t max_formats, char* out, size_t out_size) {
+    if (!out || out_size == 0) {
+        return 0;
+    }
+    out[0] = '\0';
+
+    // 候选：先注册的再内置的，跳过被覆盖的内置格式
+    const codec_descriptor_t* candidates[CODEC_FACTORY_MAX_REGISTERED + CODEC_TYPE_COUNT];
+    size_t count = 0;
+    for (size_t i = 0; i < registered_count; i++) {
+        candidates[count++] = &registered_descriptors[i];
+    }
+    for (int i = 0; i < CODEC_TYPE_COUNT; i++) {
+        if (!builtin_overridden((codec_type_t)i)) {
+            candidates[count++] = &builtin_descriptors[i];
+        }
+    }
+
+    // 插入排序（稳定），preferred 固定在最前
+    for (size_t i = 1; i < count; i++) {
+        const codec_descriptor_t* current = candidates[i];
+        size_t j = i;
+        while (j > 0 && offer_rank(candidates[j - 1]) > offer_rank(current)) {
+            candidates[j] = candidates[j - 1];
+            j--;
+        }
+        candidates[j] = current;
+    }
+    for (size_t i = 0; preferred && i < count; i++) {
+        if (descriptor_matches(candidates[i], preferred)) {
+            const codec_descriptor_t* first = candidates[i];
+            memmove(&candidates[1], &candidates[0], i * sizeof(candidates[0]));
+            candidates[0] = first;
+            break;
+        }
+    }
+
+    size_t listed = 0;
+    size_t used = 0;
+    for (size_t i = 0; i < count && (max_formats == 0 || listed < max_formats); i++) {
+        const codec_descriptor_t* descriptor = candidates[i];
+        if ((max_cost > 0 && descriptor->cost > max_cost) ||
+            !codec_factory_supports(descriptor, sample_rate, frame_size_ms)) {
+            continue;
+        }
+        int written = snprintf(out + used, out_size - used, "%s%s", listed > 0 ? "," : "", descriptor->name);
+        if (written < 0 || (size_t)written >= out_size - used) {
+            out[used] = '\0';
+            break;
+        }
+        used += (size_t)written;
+        listed++;
+    }
+    return listed;
+}
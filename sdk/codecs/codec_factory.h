@@ -0,0 +1,132 @@
+#ifndef CODEC_FACTORY_H
+#define CODEC_FACTORY_H
+
+#include "audio_codec.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 编解码器工厂
+ *
+ * 按类型或 hello 消息 audio_params.format 中的格式名创建编解码器，
+ * 让各板子按自己的算力在 Opus 与轻量编解码器之间取舍。
+ *
+ * 格式名              类型               每样本位数   算力档次
+ * "opus"              CODEC_TYPE_OPUS    可变         HIGH
+ * "pcm" / "pcm_s16le" CODEC_TYPE_PCM     16           TRIVIAL
+ * "pcmu" / "g711u"    CODEC_TYPE_PCMU    8            TRIVIAL
+ * "pcma" / "g711a"    CODEC_TYPE_PCMA    8            TRIVIAL
+ * "adpcm" / "ima_adpcm" CODEC_TYPE_ADPCM 4            LOW
+ *
+ * 每种格式有一个描述符（算力档次、支持的采样率和帧长）。应用或板级代码可以在启动时用
+ * codec_factory_register() 注册新的编解码器，或用同名描述符替换内置实现（例如硬件 Opus），
+ * 之后按格式名创建的地方（SDK 的 hello 协商结果、linx_sdk_create_codec()）不需要修改。
+ */
+
+// 编解码器类型
+typedef enum {
+    CODEC_TYPE_OPUS = 0,
+    CODEC_TYPE_PCM,         // PCM16 直通
+    CODEC_TYPE_PCMU,        // G.711 μ-law
+    CODEC_TYPE_PCMA,        // G.711 A-law
+    CODEC_TYPE_ADPCM,       // IMA-ADPCM
+    CODEC_TYPE_COUNT        // 内置类型数，注册的编解码器从这里开始编号
+} codec_type_t;
+
+/* 可注册的编解码器数上限 */
+#ifndef CODEC_FACTORY_MAX_REGISTERED
+#define CODEC_FACTORY_MAX_REGISTERED 4
+#endif
+
+#define CODEC_FACTORY_MAX_ALIASES       2
+#define CODEC_FACTORY_MAX_SAMPLE_RATES  6
+#define CODEC_FACTORY_MAX_FRAME_SIZES   8
+
+// 编解码器的算力档次，板子按自己的算力上限筛选候选格式
+typedef enum {
+    CODEC_COST_TRIVIAL = 1,     // 直通、查表（PCM、G.711）
+    CODEC_COST_LOW = 2,         // 简单预测（ADPCM）
+    CODEC_COST_HIGH = 3         // 变换编码（Opus）
+} codec_cost_t;
+
+// 编解码器描述符
+typedef struct {
+    const char* name;                                   // 标准格式名（hello 中使用）
+    const char* aliases[CODEC_FACTORY_MAX_ALIASES];     // 其他可接受的格式名，未用的为 NULL
+    codec_cost_t cost;                                  // 算力档次
+    int bits_per_sample;                                // 每样本位数，0 为可变码率
+    int sample_rates[CODEC_FACTORY_MAX_SAMPLE_RATES];   // 支持的采样率，0 结尾；首项为 0 表示不限
+    int frame_sizes_ms[CODEC_FACTORY_MAX_FRAME_SIZES];  // 支持的帧长（毫秒），0 结尾；首项为 0 表示不限
+    audio_codec_t* (*create)(void);                     // 创建未初始化的编解码器
+} codec_descriptor_t;
+
+/**
+ * 注册编解码器（启动时、创建编解码器之前调用，不与创建并发）
+ *
+ * 描述符被复制，其中的字符串须在程序运行期间有效。与已注册的同名时替换之前的注册，
+ * 与内置格式同名时之后按该格式名创建的都是注册的实现。
+ * @param type 输出：分配的类型，可为 NULL
+ * @return 成功返回 CODEC_SUCCESS；参数无效或已满返回 CODEC_INVALID_PARAMETER
+ */
+codec_error_t codec_factory_register(const codec_descriptor_t* descriptor, codec_type_t* type);
+
+/**
+ * 获取类型的描述符
+ * @return 描述符，类型未知时返回 NULL
+ */
+const codec_descriptor_t* codec_factory_get_descriptor(codec_type_t type);
+
+/**
+ * 描述符是否支持给定的采样率和帧长
+ * @param frame_size_ms 帧长，0 表示不检查
+ */
+bool codec_factory_supports(const codec_descriptor_t* descriptor, int sample_rate, int frame_size_ms);
+
+/**
+ * 生成 hello 的候选格式列表（逗号分隔，可直接用作 LinxSdkConfig.audio_formats）
+ *
+ * preferred 受支持且不超过 max_cost 时排在第一位，其余按压缩率从高到低
+ * （可变码率、每样本位数少的在前），相同时注册的在前。
+ * @param max_cost 算力上限，0 表示不限
+ * @param max_formats 最多列出的格式数，0 表示不限
+ * @return 列出的格式数
+ */
+size_t codec_factory_build_offer(const char* preferred, codec_cost_t max_cost, int sample_rate,
+                                 int frame_size_ms, size_t max_formats, char* out, size_t out_size);
+
+/**
+ * 创建指定类型的编解码器
+ * @return 编解码器实例，类型未知或内存不足时返回 NULL
+ */
+audio_codec_t* codec_factory_create(codec_type_t type);
+
+/**
+ * 按格式名创建编解码器 (不区分大小写)
+ * @return 编解码器实例，格式不支持时返回 NULL
+ */
+audio_codec_t* codec_factory_create_for_format(const char* format);
+
+/**
+ * 销毁编解码器，等同于 audio_codec_destroy()
+ */
+void codec_factory_destroy(audio_codec_t* codec);
+
+/**
+ * 解析格式名
+ * @return 格式受支持时返回 true
+ */
+bool codec_factory_parse_format(const char* format, codec_type_t* type);
+
+/**
+ * 获取类型在 hello 消息中使用的标准格式名
+ * @return 格式名，类型未知时返回 NULL
+ */
+const char* codec_factory_format_name(codec_type_t type);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CODEC_FACTORY_H
@@ -1,8 +1,11 @@
 #include "codec_stub.h"
 #include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
 #include <stdlib.h>
 #include <string.h>
 
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_CODEC);
+
 // 前向声明
 static codec_error_t stub_init_encoder(audio_codec_t* codec, const audio_format_t* format);
 static codec_error_t stub_init_decoder(audio_codec_t* codec, const audio_format_t* format);
@@ -31,16 +34,16 @@ static const audio_codec_vtable_t stub_vtable = {
 
 // 创建 stub 编解码器实例
 audio_codec_t* codec_stub_create(void) {
-    audio_codec_t* codec = (audio_codec_t*)malloc(sizeof(audio_codec_t));
+    audio_codec_t* codec = (audio_codec_t*)LINX_MALLOC(sizeof(audio_codec_t));
     if (!codec) {
         LOG_ERROR("Failed to allocate memory for stub codec");
         return NULL;
     }
 
-    CodecStubData* impl = (CodecStubData*)malloc(sizeof(CodecStubData));
+    CodecStubData* impl = (CodecStubData*)LINX_MALLOC(sizeof(CodecStubData));
     if (!impl) {
         LOG_ERROR("Failed to allocate memory for stub codec implementation");
-        free(codec);
+        LINX_FREE(codec);
         return NULL;
     }
 
@@ -237,9 +240,9 @@ static void stub_destroy(audio_codec_t* codec) {
         LOG_INFO("Destroying stub codec - final stats: %d frames, %d encoded bytes, %d decoded samples",
                  impl->frame_count, impl->total_encoded_bytes, impl->total_decoded_samples);
         
-        free(impl);
+        LINX_FREE(impl);
     }
 
-    free(codec);
+    LINX_FREE(codec);
     LOG_INFO("Stub codec destroyed");
 }
\ No newline at end of file
@@ -0,0 +1,158 @@
+#include "encoded_frame_buffer.h"
+#include "../log/linx_alloc.h"
+#include <stdlib.h>
+#include <string.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_CODEC);
+
+typedef struct {
+    size_t offset;              // 在 data 中的起始位置
+    size_t size;                // 帧字节数
+    uint32_t timestamp;         // 上行时间戳
+} encoded_frame_entry_t;
+
+struct encoded_frame_buffer {
+    encoded_frame_entry_t* entries; // 帧索引环，first 为最旧的帧
+    size_t max_frames;
+    size_t first;
+    size_t count;
+
+    // 每帧连续存放；尾部放不下时从头开始，尾部剩余空间留空
+    uint8_t* data;
+    size_t capacity;
+    size_t tail;                // 下一帧的写入位置
+
+    uint64_t dropped;
+};
+
+encoded_frame_buffer_t* encoded_frame_buffer_create(size_t max_frames, size_t max_bytes) {
+    if (max_frames == 0 || max_bytes == 0) {
+        return NULL;
+    }
+
+    encoded_frame_buffer_t* buffer = (encoded_frame_buffer_t*)LINX_CALLOC(1, sizeof(encoded_frame_buffer_t));
+    if (!buffer) {
+        return NULL;
+    }
+
+    buffer->entries = (encoded_frame_entry_t*)LINX_CALLOC(max_frames, sizeof(encoded_frame_entry_t));
+    buffer->data = (uint8_t*)LINX_MALLOC(max_bytes);
+    if (!buffer->entries || !buffer->data) {
+        encoded_frame_buffer_destroy(buffer);
+        return NULL;
+    }
+
+    buffer->max_frames = max_frames;
+    buffer->capacity = max_bytes;
+    return buffer;
+}
+
+void encoded_frame_buffer_destroy(encoded_frame_buffer_t* buffer) {
+    if (!buffer) {
+        return;
+    }
+    LINX_FREE(buffer->entries);
+    LINX_FREE(buffer->data);
+    LINX_FREE(buffer);
+}
+
+// 找一段能连续放下 size 字节的空闲空间
+static bool frame_buffer_find_space(const encoded_frame_buffer_t* buffer, size_t size, size_t* offset) {
+    if (buffer->count == 0) {
+        *offset = 0;
+        return true;
+    }
+
+    size_t head = buffer->entries[buffer->first].offset;
+    if (buffer->tail > head) {
+        // 数据位于 [head, tail)，空闲的是尾部和开头
+        if (buffer->capacity - buffer->tail >= size) {
+            *offset = buffer->tail;
+            return true;
+        }
+        if (head >= size) {
+            *offset = 0;
+            return true;
+        }
+        return false;
+    }
+
+    // 已经绕回: 空闲的是 [tail, head)
+    if (head - buffer->tail >= size) {
+        *offset = buffer->tail;
+        return true;
+    }
+    return false;
+}
+
+codec_error_t encoded_frame_buffer_push(encoded_frame_buffer_t* buffer, const uint8_t* frame, size_t size,
+                                        uint32_t timestamp) {
+    if (!buffer || !frame || size == 0 || size > buffer->capacity) {
+        return CODEC_INVALID_PARAMETER;
+    }
+
+    if (buffer->count == buffer->max_frames) {
+        encoded_frame_buffer_pop(buffer);
+        buffer->dropped++;
+    }
+
+    size_t offset = 0;
+    while (!frame_buffer_find_space(buffer, size, &offset)) {
+        encoded_frame_buffer_pop(buffer);
+        buffer->dropped++;
+    }
+
+    memcpy(buffer->data + offset, frame, size);
+    encoded_frame_entry_t* entry = &buffer->entries[(buffer->first + buffer->count) % buffer->max_frames];
+    entry->offset = offset;
+    entry->size = size;
+    entry->timestamp = timestamp;
+    buffer->count++;
+    buffer->tail = offset + size;
+    return CODEC_SUCCESS;
+}
+
+bool encoded_frame_buffer_front(const encoded_frame_buffer_t* buffer, const uint8_t** frame, size_t* size,
+                                uint32_t* timestamp) {
+    if (!buffer || !frame || !size || buffer->count == 0) {
+        return false;
+    }
+
+    const encoded_frame_entry_t* entry = &buffer->entries[buffer->first];
+    *frame = buffer->data + entry->offset;
+    *size = entry->size;
+    if (timestamp) {
+        *timestamp = entry->timestamp;
+    }
+    return true;
+}
+
+void encoded_frame_buffer_pop(encoded_frame_buffer_t* buffer) {
+    if (!buffer || buffer->count == 0) {
+        return;
+    }
+
+    buffer->first = (buffer->first + 1) % buffer->max_frames;
+    buffer->count--;
+    if (buffer->count == 0) {
+        buffer->first = 0;
+        buffer->tail = 0;
+    }
+}
+
+void encoded_frame_buffer_clear(encoded_frame_buffer_t* buffer) {
+    if (!buffer) {
+        return;
+    }
+    buffer->first = 0;
+    buffer->count = 0;
+    buffer->tail = 0;
+}
+
+size_t encoded_frame_buffer_count(const encoded_frame_buffer_t* buffer) {
+    return buffer ? buffer->count : 0;
+}
+
+uint64_t encoded_frame_buffer_dropped(const encoded_frame_buffer_t* buffer) {
+    return buffer ? buffer->dropped : 0;
+}
@@ -0,0 +1,77 @@
+#ifndef ENCODED_FRAME_BUFFER_H
+#define ENCODED_FRAME_BUFFER_H
+
+#include "audio_codec.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 编码帧缓冲
+ *
+ * 有界的先进先出队列，按帧保存编码后的音频及其上行时间戳，用于连接建立、
+ * hello 握手期间暂存唤醒后最先说出的语音，音频通道打开后按原顺序补发。
+ * 帧数据紧密存放在一块预分配的环形内存中，运行期间不再分配内存；
+ * 帧数或字节数超出上限时丢弃最旧的帧，始终保留最近的一段音频。
+ *
+ * 不是线程安全的，调用方负责加锁。
+ */
+typedef struct encoded_frame_buffer encoded_frame_buffer_t;
+
+/**
+ * 创建编码帧缓冲
+ * @param max_frames 最多保存的帧数
+ * @param max_bytes  帧数据总字节数上限 (单帧不能超过该值)
+ * @return 缓冲实例，失败返回 NULL
+ */
+encoded_frame_buffer_t* encoded_frame_buffer_create(size_t max_frames, size_t max_bytes);
+
+/**
+ * 销毁编码帧缓冲 (未取走的帧直接丢弃)
+ */
+void encoded_frame_buffer_destroy(encoded_frame_buffer_t* buffer);
+
+/**
+ * 放入一帧 (复制数据)，空间不足时先丢弃最旧的帧
+ * @param timestamp 该帧的上行时间戳，取出时原样返回
+ * @return CODEC_SUCCESS；帧为空或超过 max_bytes 时返回 CODEC_INVALID_PARAMETER
+ */
+codec_error_t encoded_frame_buffer_push(encoded_frame_buffer_t* buffer, const uint8_t* frame, size_t size,
+                                        uint32_t timestamp);
+
+/**
+ * 查看最旧的一帧，不取出
+ * @param frame     帧数据地址，在下一次 push/pop/clear 前有效
+ * @param size      帧字节数
+ * @param timestamp 帧时间戳，可为 NULL
+ * @return 缓冲为空时返回 false
+ */
+bool encoded_frame_buffer_front(const encoded_frame_buffer_t* buffer, const uint8_t** frame, size_t* size,
+                                uint32_t* timestamp);
+
+/**
+ * 取出 (丢弃) 最旧的一帧
+ */
+void encoded_frame_buffer_pop(encoded_frame_buffer_t* buffer);
+
+/**
+ * 清空缓冲
+ */
+void encoded_frame_buffer_clear(encoded_frame_buffer_t* buffer);
+
+/**
+ * 当前缓存的帧数
+ */
+size_t encoded_frame_buffer_count(const encoded_frame_buffer_t* buffer);
+
+/**
+ * 因空间不足被丢弃的帧数 (累计值)
+ */
+uint64_t encoded_frame_buffer_dropped(const encoded_frame_buffer_t* buffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ENCODED_FRAME_BUFFER_H
@@ -0,0 +1,256 @@
+#include "g711_codec.h"
+#include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
+#include <stdlib.h>
+#include <string.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_CODEC);
+
+#define G711_ULAW_BIAS  0x84    // μ-law 偏置 (132)
+#define G711_ULAW_CLIP  32635   // 加偏置后不溢出的最大幅度
+
+// G.711 实现数据
+typedef struct {
+    g711_law_t law;
+    int16_t decode_table[256];  // 码字 -> 线性样本
+} g711_codec_impl_t;
+
+// 8 位值最高置位的位置 (0/1 -> 0)，即压扩段号
+static const uint8_t g711_segment_table[256] = {
+    0, 0, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
+    5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+};
+
+// 前向声明
+static codec_error_t g711_init_encoder(audio_codec_t* codec, const audio_format_t* format);
+static codec_error_t g711_init_decoder(audio_codec_t* codec, const audio_format_t* format);
+static codec_error_t g711_encode(audio_codec_t* codec, const int16_t* input, size_t input_size,
+                                uint8_t* output, size_t output_size, size_t* encoded_size);
+static codec_error_t g711_decode(audio_codec_t* codec, const uint8_t* input, size_t input_size,
+                                int16_t* output, size_t output_size, size_t* decoded_size);
+static const char* g711_get_codec_name(const audio_codec_t* codec);
+static codec_error_t g711_reset(audio_codec_t* codec);
+static int g711_get_input_frame_size(const audio_codec_t* codec);
+static int g711_get_max_output_size(const audio_codec_t* codec);
+static void g711_destroy(audio_codec_t* codec);
+
+// G.711 编解码器虚函数表
+static const audio_codec_vtable_t g711_vtable = {
+    .init_encoder = g711_init_encoder,
+    .init_decoder = g711_init_decoder,
+    .encode = g711_encode,
+    .decode = g711_decode,
+    .get_codec_name = g711_get_codec_name,
+    .reset = g711_reset,
+    .get_input_frame_size = g711_get_input_frame_size,
+    .get_max_output_size = g711_get_max_output_size,
+    .destroy = g711_destroy
+};
+
+static inline uint8_t g711_linear_to_ulaw(int16_t pcm) {
+    int value = pcm;
+    uint8_t sign = 0;
+    if (value < 0) {
+        value = -value;
+        sign = 0x80;
+    }
+    if (value > G711_ULAW_CLIP) {
+        value = G711_ULAW_CLIP;
+    }
+    value += G711_ULAW_BIAS;
+
+    int segment = g711_segment_table[value >> 7];
+    int mantissa = (value >> (segment + 3)) & 0x0F;
+    return (uint8_t)~(sign | (segment << 4) | mantissa);
+}
+
+static inline int16_t g711_ulaw_to_linear(uint8_t code) {
+    code = (uint8_t)~code;
+    int value = (((code & 0x0F) << 3) + G711_ULAW_BIAS) << ((code & 0x70) >> 4);
+    return (int16_t)((code & 0x80) ? (G711_ULAW_BIAS - value) : (value - G711_ULAW_BIAS));
+}
+
+static inline uint8_t g711_linear_to_alaw(int16_t pcm) {
+    int value = pcm >> 3;  // A-law 使用 13 位幅度
+    uint8_t mask;
+    if (value >= 0) {
+        mask = 0xD5;
+    } else {
+        mask = 0x55;
+        value = -value - 1;
+    }
+
+    int segment = g711_segment_table[value >> 4];
+    int mantissa = segment < 2 ? (value >> 1) & 0x0F : (value >> segment) & 0x0F;
+    return (uint8_t)(((segment << 4) | mantissa) ^ mask);
+}
+
+static inline int16_t g711_alaw_to_linear(uint8_t code) {
+    code ^= 0x55;
+    int value = (code & 0x0F) << 4;
+    int segment = (code & 0x70) >> 4;
+    if (segment == 0) {
+        value += 8;
+    } else {
+        value = (value + 0x108) << (segment - 1);
+    }
+    return (int16_t)((code & 0x80) ? value : -value);
+}
+
+// 创建 G.711 编解码器实例
+audio_codec_t* g711_codec_create(g711_law_t law) {
+    if (law != G711_LAW_ULAW && law != G711_LAW_ALAW) {
+        LOG_ERROR("Invalid G.711 law: %d", law);
+        return NULL;
+    }
+
+    audio_codec_t* codec = (audio_codec_t*)LINX_CALLOC(1, sizeof(audio_codec_t));
+    if (!codec) {
+        LOG_ERROR("Failed to allocate memory for G.711 codec");
+        return NULL;
+    }
+
+    g711_codec_impl_t* impl = (g711_codec_impl_t*)LINX_CALLOC(1, sizeof(g711_codec_impl_t));
+    if (!impl) {
+        LOG_ERROR("Failed to allocate memory for G.711 codec implementation");
+        LINX_FREE(codec);
+        return NULL;
+    }
+
+    impl->law = law;
+    for (int i = 0; i < 256; i++) {
+        impl->decode_table[i] = law == G711_LAW_ULAW ? g711_ulaw_to_linear((uint8_t)i)
+                                                     : g711_alaw_to_linear((uint8_t)i);
+    }
+
+    codec->vtable = &g711_vtable;
+    codec->impl_data = impl;
+    audio_format_default(&codec->format);
+
+    LOG_INFO("G.711 %s codec created successfully", law == G711_LAW_ULAW ? "u-law" : "A-law");
+    return codec;
+}
+
+g711_law_t g711_codec_get_law(const audio_codec_t* codec) {
+    if (!codec || !codec->impl_data || codec->vtable != &g711_vtable) {
+        return G711_LAW_ULAW;
+    }
+    return ((const g711_codec_impl_t*)codec->impl_data)->law;
+}
+
+static codec_error_t g711_init_encoder(audio_codec_t* codec, const audio_format_t* format) {
+    if (!codec || !codec->impl_data || !format || format->channels <= 0 || format->bits_per_sample != 16) {
+        return CODEC_INVALID_PARAMETER;
+    }
+    codec->format = *format;
+    codec->encoder_initialized = true;
+    return CODEC_SUCCESS;
+}
+
+static codec_error_t g711_init_decoder(audio_codec_t* codec, const audio_format_t* format) {
+    if (!codec || !codec->impl_data || !format || format->channels <= 0 || format->bits_per_sample != 16) {
+        return CODEC_INVALID_PARAMETER;
+    }
+    codec->format = *format;
+    codec->decoder_initialized = true;
+    return CODEC_SUCCESS;
+}
+
+static codec_error_t g711_encode(audio_codec_t* codec, const int16_t* input, size_t input_size,
+                                uint8_t* output, size_t output_size, size_t* encoded_size) {
+    if (!codec || !codec->impl_data || !input || !output || !encoded_size) {
+        return CODEC_INVALID_PARAMETER;
+    }
+    if (!codec->encoder_initialized) {
+        return CODEC_INITIALIZATION_FAILED;
+    }
+    if (input_size > output_size) {
+        return CODEC_BUFFER_TOO_SMALL;
+    }
+
+    // 两条独立的直线循环，内层没有分支跳转到另一种压扩律
+    g711_codec_impl_t* impl = (g711_codec_impl_t*)codec->impl_data;
+    if (impl->law == G711_LAW_ULAW) {
+        for (size_t i = 0; i < input_size; i++) {
+            output[i] = g711_linear_to_ulaw(input[i]);
+        }
+    } else {
+        for (size_t i = 0; i < input_size; i++) {
+            output[i] = g711_linear_to_alaw(input[i]);
+        }
+    }
+
+    *encoded_size = input_size;
+    return CODEC_SUCCESS;
+}
+
+static codec_error_t g711_decode(audio_codec_t* codec, const uint8_t* input, size_t input_size,
+                                int16_t* output, size_t output_size, size_t* decoded_size) {
+    if (!codec || !codec->impl_data || !input || !output || !decoded_size) {
+        return CODEC_INVALID_PARAMETER;
+    }
+    if (!codec->decoder_initialized) {
+        return CODEC_INITIALIZATION_FAILED;
+    }
+    if (input_size > output_size) {
+        return CODEC_BUFFER_TOO_SMALL;
+    }
+
+    const int16_t* table = ((g711_codec_impl_t*)codec->impl_data)->decode_table;
+    for (size_t i = 0; i < input_size; i++) {
+        output[i] = table[input[i]];
+    }
+
+    *decoded_size = input_size;
+    return CODEC_SUCCESS;
+}
+
+static const char* g711_get_codec_name(const audio_codec_t* codec) {
+    if (codec && codec->impl_data && ((g711_codec_impl_t*)codec->impl_data)->law == G711_LAW_ALAW) {
+        return "G.711 A-law";
+    }
+    return "G.711 u-law";
+}
+
+static codec_error_t g711_reset(audio_codec_t* codec) {
+    return codec ? CODEC_SUCCESS : CODEC_INVALID_PARAMETER;
+}
+
+// 获取建议的输入帧大小（每声道样本数）
+static int g711_get_input_frame_size(const audio_codec_t* codec) {
+    if (!codec) {
+        return -1;
+    }
+    return codec->format.sample_rate * codec->format.frame_size_ms / 1000;
+}
+
+// 获取最大输出缓冲区大小（样本数，用于解码），与 Opus 一致按 120ms 计算
+static int g711_get_max_output_size(const audio_codec_t* codec) {
+    if (!codec) {
+        return -1;
+    }
+    return codec->format.sample_rate * 120 / 1000 * codec->format.channels;
+}
+
+static void g711_destroy(audio_codec_t* codec) {
+    if (!codec) {
+        return;
+    }
+    LINX_FREE(codec->impl_data);
+    LINX_FREE(codec);
+    LOG_INFO("G.711 codec destroyed");
+}
@@ -0,0 +1,34 @@
+#ifndef G711_CODEC_H
+#define G711_CODEC_H
+
+#include "audio_codec.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * G.711 编解码器 (ITU-T G.711)
+ *
+ * 每个样本压缩成 1 字节，码率为 PCM16 的一半。编码只有移位和一次查表，
+ * 解码完全查表，适合 Opus 编码开销过大的低端 MCU。对 8kHz 以上的
+ * 采样率同样按样本逐个压扩。
+ */
+
+// 压扩律
+typedef enum {
+    G711_LAW_ULAW = 0,  // μ-law (PCMU)
+    G711_LAW_ALAW       // A-law (PCMA)
+} g711_law_t;
+
+// 创建 G.711 编解码器实例
+audio_codec_t* g711_codec_create(g711_law_t law);
+
+// 获取压扩律
+g711_law_t g711_codec_get_law(const audio_codec_t* codec);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // G711_CODEC_H
@@ -1,9 +1,31 @@
 #include "opus_codec.h"
 #include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
+#include "../linx_tracepoint.h"
 #include <stdlib.h>
 #include <string.h>
 #include <opus.h>
 
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_CODEC);
+
+// 构建档位及其默认编码参数，由 sdk/CMakeLists.txt 按 LINX_OPUS_PROFILE 传入
+#ifndef LINX_OPUS_PROFILE_NAME
+#define LINX_OPUS_PROFILE_NAME "float"
+#endif
+
+#ifndef LINX_OPUS_DEFAULT_COMPLEXITY
+#define LINX_OPUS_DEFAULT_COMPLEXITY 10
+#endif
+
+#ifndef LINX_OPUS_DEFAULT_FRAME_MS
+#define LINX_OPUS_DEFAULT_FRAME_MS 20
+#endif
+
+// 状态池容量（编码器和解码器合计），0 关闭状态池
+#ifndef LINX_OPUS_STATE_POOL_SIZE
+#define LINX_OPUS_STATE_POOL_SIZE 4
+#endif
+
 // Opus编解码器实现数据
 typedef struct {
     OpusEncoder* encoder;
@@ -21,37 +43,36 @@ typedef struct {
     int prediction_disabled; // 预测禁用
     int use_inband_fec;   // 使用带内FEC
     int use_dtx;          // 使用DTX
+    int frame_size_ms;    // 初始化时未指定帧长使用的默认帧长
+    int encoder_sample_rate; // 编码器状态的采样率和声道数（归还状态池时作为键）
+    int encoder_channels;
+    int decoder_sample_rate; // 解码器状态的采样率和声道数
+    int decoder_channels;
 } opus_codec_impl_t;
 
+/*
+ * 编解码器状态池
+ *
+ * 切换音色、采样率或会话时，旧的编解码器状态按 (类型, 采样率, 声道数, application) 放回池中，
+ * 保持已初始化；同一格式再次初始化时取出后 OPUS_RESET_STATE 即可使用，声道数相同、采样率
+ * 不同时在原内存上重新 opus_*_init()（状态大小只取决于声道数），都不再分配内存。
+ * 池满时归还的状态直接释放。临界区只有数组操作，用自旋锁保护。
+ */
+typedef struct {
+    void* state;            // OpusEncoder* / OpusDecoder*，NULL 表示空槽
+    bool encoder;
+    int sample_rate;
+    int channels;
+    int application;        // 仅编码器
+} opus_pool_entry_t;
+
+#if LINX_OPUS_STATE_POOL_SIZE > 0
+static opus_pool_entry_t s_state_pool[LINX_OPUS_STATE_POOL_SIZE];
+#endif
+static bool s_state_pool_lock;
+static opus_codec_pool_stats_t s_state_pool_stats;
 
 
-// Opus编解码器特定函数
-static codec_error_t opus_codec_set_bitrate(audio_codec_t* codec, int bitrate);
-static codec_error_t opus_codec_set_complexity(audio_codec_t* codec, int complexity);
-static codec_error_t opus_codec_set_signal_type(audio_codec_t* codec, int signal_type);
-static codec_error_t opus_codec_set_vbr(audio_codec_t* codec, int vbr);
-static codec_error_t opus_codec_set_vbr_constraint(audio_codec_t* codec, int vbr_constraint);
-static codec_error_t opus_codec_set_force_channels(audio_codec_t* codec, int force_channels);
-static codec_error_t opus_codec_set_max_bandwidth(audio_codec_t* codec, int max_bandwidth);
-static codec_error_t opus_codec_set_packet_loss_perc(audio_codec_t* codec, int packet_loss_perc);
-static codec_error_t opus_codec_set_lsb_depth(audio_codec_t* codec, int lsb_depth);
-static codec_error_t opus_codec_set_prediction_disabled(audio_codec_t* codec, int prediction_disabled);
-static codec_error_t opus_codec_set_inband_fec(audio_codec_t* codec, int use_inband_fec);
-static codec_error_t opus_codec_set_dtx(audio_codec_t* codec, int use_dtx);
-
-// 获取Opus编解码器参数
-static int opus_codec_get_bitrate(const audio_codec_t* codec);
-static int opus_codec_get_complexity(const audio_codec_t* codec);
-static int opus_codec_get_signal_type(const audio_codec_t* codec);
-static int opus_codec_get_vbr(const audio_codec_t* codec);
-static int opus_codec_get_vbr_constraint(const audio_codec_t* codec);
-static int opus_codec_get_force_channels(const audio_codec_t* codec);
-static int opus_codec_get_max_bandwidth(const audio_codec_t* codec);
-static int opus_codec_get_packet_loss_perc(const audio_codec_t* codec);
-static int opus_codec_get_lsb_depth(const audio_codec_t* codec);
-static int opus_codec_get_prediction_disabled(const audio_codec_t* codec);
-static int opus_codec_get_inband_fec(const audio_codec_t* codec);
-static int opus_codec_get_dtx(const audio_codec_t* codec);
 
 // 前向声明
 static codec_error_t opus_init_encoder(audio_codec_t* codec, const audio_format_t* format);
@@ -60,6 +81,15 @@ static codec_error_t opus_codec_encode_impl(audio_codec_t* codec, const int16_t*
                                             uint8_t* output, size_t output_size, size_t* encoded_size);
 static codec_error_t opus_codec_decode_impl(audio_codec_t* codec, const uint8_t* input, size_t input_size,
                                             int16_t* output, size_t output_size, size_t* decoded_size);
+static codec_error_t opus_codec_encode_batch_impl(audio_codec_t* codec, const int16_t* input, size_t frame_samples,
+                                                  size_t frame_count, uint8_t* output, size_t output_size,
+                                                  size_t* packet_sizes, size_t* encoded_frames);
+static codec_error_t opus_codec_decode_batch_impl(audio_codec_t* codec, const uint8_t* input, const size_t* packet_sizes,
+                                                  size_t packet_count, int16_t* output, size_t output_size,
+                                                  size_t* decoded_size, size_t* decoded_packets);
+static codec_error_t opus_codec_decode_lost_impl(audio_codec_t* codec, const uint8_t* next_input, size_t next_input_size,
+                                                 size_t frame_samples, int16_t* output, size_t output_size,
+                                                 size_t* decoded_size);
 static const char* opus_get_codec_name(const audio_codec_t* codec);
 static codec_error_t opus_reset(audio_codec_t* codec);
 static int opus_get_input_frame_size(const audio_codec_t* codec);
@@ -72,6 +102,9 @@ static const audio_codec_vtable_t opus_vtable = {
     .init_decoder = opus_init_decoder,
     .encode = opus_codec_encode_impl,
     .decode = opus_codec_decode_impl,
+    .encode_batch = opus_codec_encode_batch_impl,
+    .decode_batch = opus_codec_decode_batch_impl,
+    .decode_lost = opus_codec_decode_lost_impl,
     .get_codec_name = opus_get_codec_name,
     .reset = opus_reset,
     .get_input_frame_size = opus_get_input_frame_size,
@@ -79,18 +112,233 @@ static const audio_codec_vtable_t opus_vtable = {
     .destroy = opus_destroy
 };
 
+const char* opus_codec_build_profile(void) {
+    return LINX_OPUS_PROFILE_NAME;
+}
+
+static void opus_pool_lock(void) {
+    while (__atomic_test_and_set(&s_state_pool_lock, __ATOMIC_ACQUIRE)) {
+    }
+}
+
+static void opus_pool_unlock(void) {
+    __atomic_clear(&s_state_pool_lock, __ATOMIC_RELEASE);
+}
+
+static int opus_state_size(bool encoder, int channels) {
+    return encoder ? opus_encoder_get_size(channels) : opus_decoder_get_size(channels);
+}
+
+static int opus_state_init(void* state, bool encoder, int sample_rate, int channels, int application) {
+    return encoder ? opus_encoder_init((OpusEncoder*)state, sample_rate, channels, application)
+                   : opus_decoder_init((OpusDecoder*)state, sample_rate, channels);
+}
+
+// 从池中取出状态；exact 表示格式完全相同（只需复位），否则是声道数相同、需要重新初始化的状态
+static void* opus_pool_take(bool encoder, int sample_rate, int channels, int application, bool* exact) {
+    void* state = NULL;
+#if LINX_OPUS_STATE_POOL_SIZE > 0
+    int reuse = -1;
+    opus_pool_lock();
+    for (int i = 0; i < LINX_OPUS_STATE_POOL_SIZE; i++) {
+        opus_pool_entry_t* entry = &s_state_pool[i];
+        if (!entry->state || entry->encoder != encoder || entry->channels != channels) {
+            continue;
+        }
+        if (entry->sample_rate == sample_rate && (!encoder || entry->application == application)) {
+            reuse = i;
+            *exact = true;
+            break;
+        }
+        if (reuse < 0) {
+            reuse = i;
+        }
+    }
+    if (reuse >= 0) {
+        state = s_state_pool[reuse].state;
+        s_state_pool[reuse].state = NULL;
+        s_state_pool_stats.pooled--;
+    }
+    opus_pool_unlock();
+#else
+    (void)encoder; (void)sample_rate; (void)channels; (void)application; (void)exact;
+#endif
+    return state;
+}
+
+// 取得一个按格式初始化好的状态：池中同格式的复位，同大小的重新初始化，否则分配
+static void* opus_state_acquire(bool encoder, int sample_rate, int channels, int application,
+                                codec_error_t* error) {
+    int state_size = opus_state_size(encoder, channels);
+    if (state_size <= 0) {
+        LOG_ERROR("Unsupported channel count for Opus %s: %d", encoder ? "encoder" : "decoder", channels);
+        *error = CODEC_UNSUPPORTED_FORMAT;
+        return NULL;
+    }
+
+    bool exact = false;
+    void* state = opus_pool_take(encoder, sample_rate, channels, application, &exact);
+    if (state && exact) {
+        if (encoder) {
+            opus_encoder_ctl((OpusEncoder*)state, OPUS_RESET_STATE);
+        } else {
+            opus_decoder_ctl((OpusDecoder*)state, OPUS_RESET_STATE);
+        }
+        __atomic_fetch_add(&s_state_pool_stats.hits, 1, __ATOMIC_RELAXED);
+        return state;
+    }
+    if (state) {
+        __atomic_fetch_add(&s_state_pool_stats.reinits, 1, __ATOMIC_RELAXED);
+    } else {
+        // 状态由 SDK 分配器分配（静态内存构建时来自静态内存区），libopus 内部不再 malloc
+        state = LINX_MALLOC((size_t)state_size);
+        if (!state) {
+            LOG_ERROR("Failed to allocate Opus %s state (%d bytes)", encoder ? "encoder" : "decoder", state_size);
+            *error = CODEC_MEMORY_ALLOCATION_FAILED;
+            return NULL;
+        }
+        __atomic_fetch_add(&s_state_pool_stats.allocs, 1, __ATOMIC_RELAXED);
+    }
+    int result = opus_state_init(state, encoder, sample_rate, channels, application);
+    if (result != OPUS_OK) {
+        LOG_ERROR("Failed to create Opus %s: %s", encoder ? "encoder" : "decoder", opus_strerror(result));
+        LINX_FREE(state);
+        *error = CODEC_INITIALIZATION_FAILED;
+        return NULL;
+    }
+    return state;
+}
+
+// 归还状态：放入空槽，池满时释放
+static void opus_state_release(void* state, bool encoder, int sample_rate, int channels, int application) {
+    if (!state) {
+        return;
+    }
+#if LINX_OPUS_STATE_POOL_SIZE > 0
+    opus_pool_lock();
+    for (int i = 0; i < LINX_OPUS_STATE_POOL_SIZE; i++) {
+        opus_pool_entry_t* entry = &s_state_pool[i];
+        if (!entry->state) {
+            entry->state = state;
+            entry->encoder = encoder;
+            entry->sample_rate = sample_rate;
+            entry->channels = channels;
+            entry->application = application;
+            s_state_pool_stats.pooled++;
+            state = NULL;
+            break;
+        }
+    }
+    opus_pool_unlock();
+#else
+    (void)encoder; (void)sample_rate; (void)channels; (void)application;
+#endif
+    LINX_FREE(state);
+}
+
+codec_error_t opus_codec_pool_prepare(const audio_format_t* format, int encoders, int decoders) {
+    if (!format || encoders < 0 || decoders < 0) {
+        return CODEC_INVALID_PARAMETER;
+    }
+    if (encoders + decoders > LINX_OPUS_STATE_POOL_SIZE) {
+        LOG_WARN("Opus state pool holds at most %d states", LINX_OPUS_STATE_POOL_SIZE);
+        return CODEC_INVALID_PARAMETER;
+    }
+
+    // 先全部取出再归还，已在池中的同格式状态计入数量，不会重复分配
+    int application = opus_codec_default_options().application;
+    void* states[LINX_OPUS_STATE_POOL_SIZE > 0 ? LINX_OPUS_STATE_POOL_SIZE : 1];
+    int count = 0;
+    codec_error_t error = CODEC_SUCCESS;
+    for (int i = 0; i < encoders + decoders; i++) {
+        bool encoder = i < encoders;
+        states[count] = opus_state_acquire(encoder, format->sample_rate, format->channels, application, &error);
+        if (!states[count]) {
+            break;
+        }
+        count++;
+    }
+    for (int i = 0; i < count; i++) {
+        opus_state_release(states[i], i < encoders, format->sample_rate, format->channels, application);
+    }
+    return error;
+}
+
+void opus_codec_pool_clear(void) {
+#if LINX_OPUS_STATE_POOL_SIZE > 0
+    void* states[LINX_OPUS_STATE_POOL_SIZE];
+    opus_pool_lock();
+    for (int i = 0; i < LINX_OPUS_STATE_POOL_SIZE; i++) {
+        states[i] = s_state_pool[i].state;
+        s_state_pool[i].state = NULL;
+    }
+    s_state_pool_stats.pooled = 0;
+    opus_pool_unlock();
+    for (int i = 0; i < LINX_OPUS_STATE_POOL_SIZE; i++) {
+        LINX_FREE(states[i]);
+    }
+#endif
+}
+
+void opus_codec_pool_get_stats(opus_codec_pool_stats_t* stats) {
+    if (!stats) {
+        return;
+    }
+    opus_pool_lock();
+    stats->pooled = s_state_pool_stats.pooled;
+    opus_pool_unlock();
+    stats->hits = __atomic_load_n(&s_state_pool_stats.hits, __ATOMIC_RELAXED);
+    stats->reinits = __atomic_load_n(&s_state_pool_stats.reinits, __ATOMIC_RELAXED);
+    stats->allocs = __atomic_load_n(&s_state_pool_stats.allocs, __ATOMIC_RELAXED);
+}
+
+opus_codec_options_t opus_codec_default_options(void) {
+    opus_codec_options_t options;
+    memset(&options, 0, sizeof(options));
+    options.complexity = LINX_OPUS_DEFAULT_COMPLEXITY;
+    options.frame_size_ms = LINX_OPUS_DEFAULT_FRAME_MS;
+    options.bitrate = 64000;
+    options.application = OPUS_APPLICATION_VOIP;
+    return options;
+}
+
 // 创建Opus编解码器实例
 audio_codec_t* opus_codec_create(void) {
-    audio_codec_t* codec = (audio_codec_t*)malloc(sizeof(audio_codec_t));
+    return opus_codec_create_with_options(NULL);
+}
+
+audio_codec_t* opus_codec_create_with_options(const opus_codec_options_t* options) {
+    opus_codec_options_t defaults = opus_codec_default_options();
+    if (options) {
+        if (options->complexity < 0 || options->complexity > 10 || options->frame_size_ms < 0 ||
+            options->bitrate < 0) {
+            LOG_ERROR("Invalid Opus codec options");
+            return NULL;
+        }
+        if (options->complexity > 0) {
+            defaults.complexity = options->complexity;
+        }
+        if (options->frame_size_ms > 0) {
+            defaults.frame_size_ms = options->frame_size_ms;
+        }
+        if (options->bitrate > 0) {
+            defaults.bitrate = options->bitrate;
+        }
+        if (options->application != 0) {
+            defaults.application = options->application;
+        }
+    }
+
+    audio_codec_t* codec = (audio_codec_t*)LINX_MALLOC(sizeof(audio_codec_t));
     if (!codec) {
         LOG_ERROR("Failed to allocate memory for Opus codec");
         return NULL;
     }
 
-    opus_codec_impl_t* impl = (opus_codec_impl_t*)malloc(sizeof(opus_codec_impl_t));
+    opus_codec_impl_t* impl = (opus_codec_impl_t*)LINX_MALLOC(sizeof(opus_codec_impl_t));
     if (!impl) {
         LOG_ERROR("Failed to allocate memory for Opus codec implementation");
-        free(codec);
+        LINX_FREE(codec);
         return NULL;
     }
 
@@ -104,9 +352,9 @@ audio_codec_t* opus_codec_create(void) {
     codec->decoder_initialized = false;
 
     // 设置默认参数
-    impl->application = OPUS_APPLICATION_VOIP;
-    impl->bitrate = 64000;  // 64 kbps
-    impl->complexity = 10;
+    impl->application = defaults.application;
+    impl->bitrate = defaults.bitrate;
+    impl->complexity = defaults.complexity;
     impl->signal_type = OPUS_AUTO;
     impl->vbr = 1;
     impl->vbr_constraint = 0;
@@ -117,11 +365,14 @@ audio_codec_t* opus_codec_create(void) {
     impl->prediction_disabled = 0;
     impl->use_inband_fec = 0;
     impl->use_dtx = 0;
+    impl->frame_size_ms = defaults.frame_size_ms;
 
     // 设置默认音频格式
     audio_format_default(&codec->format);
+    codec->format.frame_size_ms = impl->frame_size_ms;
 
-    LOG_INFO("Opus codec created successfully");
+    LOG_INFO("Opus codec created (%s profile, complexity %d, %d ms frames)", LINX_OPUS_PROFILE_NAME,
+             impl->complexity, impl->frame_size_ms);
     return codec;
 }
 
@@ -133,20 +384,24 @@ static codec_error_t opus_init_encoder(audio_codec_t* codec, const audio_format_
     }
 
     opus_codec_impl_t* impl = (opus_codec_impl_t*)codec->impl_data;
-    int error;
-
-    // 如果编码器已经初始化，先销毁
-    if (impl->encoder) {
-        opus_encoder_destroy(impl->encoder);
-        impl->encoder = NULL;
-    }
 
-    // 创建编码器
-    impl->encoder = opus_encoder_create(format->sample_rate, format->channels, 
-                                       impl->application, &error);
-    if (error != OPUS_OK || !impl->encoder) {
-        LOG_ERROR("Failed to create Opus encoder: %s", opus_strerror(error));
-        return CODEC_INITIALIZATION_FAILED;
+    // 格式不变时原地复位；否则按新格式从状态池取出或分配，旧状态随后归还状态池，
+    // 来回切换两种格式时两边都只需复位
+    if (impl->encoder && impl->encoder_sample_rate == format->sample_rate &&
+        impl->encoder_channels == format->channels) {
+        opus_encoder_ctl(impl->encoder, OPUS_RESET_STATE);
+    } else {
+        codec_error_t error = CODEC_SUCCESS;
+        OpusEncoder* encoder = (OpusEncoder*)opus_state_acquire(true, format->sample_rate, format->channels,
+                                                                impl->application, &error);
+        if (!encoder) {
+            return error;
+        }
+        opus_state_release(impl->encoder, true, impl->encoder_sample_rate, impl->encoder_channels,
+                           impl->application);
+        impl->encoder = encoder;
+        impl->encoder_sample_rate = format->sample_rate;
+        impl->encoder_channels = format->channels;
     }
 
     // 设置编码器参数
@@ -164,6 +419,9 @@ static codec_error_t opus_init_encoder(audio_codec_t* codec, const audio_format_
     opus_encoder_ctl(impl->encoder, OPUS_SET_DTX(impl->use_dtx));
 
     codec->format = *format;
+    if (codec->format.frame_size_ms <= 0) {
+        codec->format.frame_size_ms = impl->frame_size_ms;
+    }
     codec->encoder_initialized = true;
 
     LOG_INFO("Opus encoder initialized: %d Hz, %d channels, %d kbps", 
@@ -179,22 +437,27 @@ static codec_error_t opus_init_decoder(audio_codec_t* codec, const audio_format_
     }
 
     opus_codec_impl_t* impl = (opus_codec_impl_t*)codec->impl_data;
-    int error;
 
-    // 如果解码器已经初始化，先销毁
-    if (impl->decoder) {
-        opus_decoder_destroy(impl->decoder);
-        impl->decoder = NULL;
-    }
-
-    // 创建解码器
-    impl->decoder = opus_decoder_create(format->sample_rate, format->channels, &error);
-    if (error != OPUS_OK || !impl->decoder) {
-        LOG_ERROR("Failed to create Opus decoder: %s", opus_strerror(error));
-        return CODEC_INITIALIZATION_FAILED;
+    // 同编码器：格式不变时原地复位，否则经状态池切换
+    if (impl->decoder && impl->decoder_sample_rate == format->sample_rate &&
+        impl->decoder_channels == format->channels) {
+        opus_decoder_ctl(impl->decoder, OPUS_RESET_STATE);
+    } else {
+        codec_error_t error = CODEC_SUCCESS;
+        OpusDecoder* decoder = (OpusDecoder*)opus_state_acquire(false, format->sample_rate, format->channels, 0, &error);
+        if (!decoder) {
+            return error;
+        }
+        opus_state_release(impl->decoder, false, impl->decoder_sample_rate, impl->decoder_channels, 0);
+        impl->decoder = decoder;
+        impl->decoder_sample_rate = format->sample_rate;
+        impl->decoder_channels = format->channels;
     }
 
     codec->format = *format;
+    if (codec->format.frame_size_ms <= 0) {
+        codec->format.frame_size_ms = impl->frame_size_ms;
+    }
     codec->decoder_initialized = true;
 
     LOG_INFO("Opus decoder initialized: %d Hz, %d channels", 
@@ -227,7 +490,9 @@ static codec_error_t opus_codec_encode_impl(audio_codec_t* codec, const int16_t*
     }
 
     // 编码
+    LINX_TRACEPOINT_BEGIN(opus_encode);
     int result = opus_encode(impl->encoder, input, frame_size, output, (opus_int32)output_size);
+    LINX_TRACEPOINT_END(opus_encode, input_size, result > 0 ? result : 0);
     if (result < 0) {
         LOG_ERROR("Opus encoding failed: %s", opus_strerror(result));
         return CODEC_ENCODING_FAILED;
@@ -253,18 +518,25 @@ static codec_error_t opus_codec_decode_impl(audio_codec_t* codec, const uint8_t*
     opus_codec_impl_t* impl = (opus_codec_impl_t*)codec->impl_data;
     
     // 计算最大帧大小 - Opus 支持最大 120ms 的帧
-    // 为了安全起见，我们使用 120ms 作为最大帧大小
+    // 输出缓冲区不足 120ms 时（如直接解码到设备缓冲区）按缓冲区大小限制，
+    // 包的时长超过缓冲区时 opus_decode 会在解码前返回 OPUS_BUFFER_TOO_SMALL
     int max_frame_size = codec->format.sample_rate * 120 / 1000;  // 120ms 最大帧
+    size_t output_frames = output_size / (size_t)codec->format.channels;
+    if (output_frames < (size_t)max_frame_size) {
+        max_frame_size = (int)output_frames;
+    }
     
-    if (output_size < (size_t)(max_frame_size * codec->format.channels)) {
-        LOG_ERROR("Output buffer too small for Opus decoding: need %d samples, got %zu", 
-                  max_frame_size * codec->format.channels, output_size);
+    if (max_frame_size <= 0) {
+        LOG_ERROR("Output buffer too small for Opus decoding: got %zu samples", output_size);
         return CODEC_BUFFER_TOO_SMALL;
     }
 
     // 解码
     int result = opus_decode(impl->decoder, input, (opus_int32)input_size, 
                             output, max_frame_size, 0);
+    if (result == OPUS_BUFFER_TOO_SMALL) {
+        return CODEC_BUFFER_TOO_SMALL;
+    }
     if (result < 0) {
         LOG_ERROR("Opus decoding failed: %s", opus_strerror(result));
         return CODEC_DECODING_FAILED;
@@ -274,6 +546,134 @@ static codec_error_t opus_codec_decode_impl(audio_codec_t* codec, const uint8_t*
     return CODEC_SUCCESS;
 }
 
+// 批量编码：参数只校验一次，随后连续调用 opus_encode 复用同一个编码器状态
+static codec_error_t opus_codec_encode_batch_impl(audio_codec_t* codec, const int16_t* input, size_t frame_samples,
+                                                  size_t frame_count, uint8_t* output, size_t output_size,
+                                                  size_t* packet_sizes, size_t* encoded_frames) {
+    if (!codec || !codec->impl_data) {
+        LOG_ERROR("Invalid parameters for Opus batch encoding");
+        return CODEC_INVALID_PARAMETER;
+    }
+
+    if (!codec->encoder_initialized) {
+        LOG_ERROR("Opus encoder not initialized");
+        return CODEC_INITIALIZATION_FAILED;
+    }
+
+    opus_codec_impl_t* impl = (opus_codec_impl_t*)codec->impl_data;
+    int frame_size = codec->format.sample_rate * codec->format.frame_size_ms / 1000;
+
+    if ((int)frame_samples != frame_size * codec->format.channels) {
+        LOG_ERROR("Invalid input size for Opus encoding: expected %d, got %zu",
+                  frame_size * codec->format.channels, frame_samples);
+        return CODEC_INVALID_PARAMETER;
+    }
+
+    size_t offset = 0;
+    for (size_t i = 0; i < frame_count; i++) {
+        if (offset >= output_size) {
+            return CODEC_BUFFER_TOO_SMALL;
+        }
+        LINX_TRACEPOINT_BEGIN(opus_encode);
+        int result = opus_encode(impl->encoder, input + i * frame_samples, frame_size,
+                                 output + offset, (opus_int32)(output_size - offset));
+        LINX_TRACEPOINT_END(opus_encode, frame_samples, result > 0 ? result : 0);
+        if (result == OPUS_BUFFER_TOO_SMALL) {
+            return CODEC_BUFFER_TOO_SMALL;
+        }
+        if (result < 0) {
+            LOG_ERROR("Opus encoding failed: %s", opus_strerror(result));
+            return CODEC_ENCODING_FAILED;
+        }
+        packet_sizes[i] = (size_t)result;
+        offset += (size_t)result;
+        *encoded_frames = i + 1;
+    }
+
+    return CODEC_SUCCESS;
+}
+
+// 批量解码：每个包的可用输出按剩余空间计算，最多 120ms
+static codec_error_t opus_codec_decode_batch_impl(audio_codec_t* codec, const uint8_t* input, const size_t* packet_sizes,
+                                                  size_t packet_count, int16_t* output, size_t output_size,
+                                                  size_t* decoded_size, size_t* decoded_packets) {
+    if (!codec || !codec->impl_data) {
+        LOG_ERROR("Invalid parameters for Opus batch decoding");
+        return CODEC_INVALID_PARAMETER;
+    }
+
+    if (!codec->decoder_initialized) {
+        LOG_ERROR("Opus decoder not initialized");
+        return CODEC_INITIALIZATION_FAILED;
+    }
+
+    opus_codec_impl_t* impl = (opus_codec_impl_t*)codec->impl_data;
+    size_t channels = (size_t)codec->format.channels;
+    size_t max_frame_size = (size_t)codec->format.sample_rate * 120 / 1000;
+    size_t offset = 0;
+
+    for (size_t i = 0; i < packet_count; i++) {
+        size_t frames_left = (output_size - *decoded_size) / channels;
+        int frame_size = (int)(frames_left < max_frame_size ? frames_left : max_frame_size);
+        if (frame_size <= 0) {
+            return CODEC_BUFFER_TOO_SMALL;
+        }
+        int result = opus_decode(impl->decoder, input + offset, (opus_int32)packet_sizes[i],
+                                 output + *decoded_size, frame_size, 0);
+        if (result == OPUS_BUFFER_TOO_SMALL) {
+            return CODEC_BUFFER_TOO_SMALL;
+        }
+        if (result < 0) {
+            LOG_ERROR("Opus decoding failed: %s", opus_strerror(result));
+            return CODEC_DECODING_FAILED;
+        }
+        offset += packet_sizes[i];
+        *decoded_size += (size_t)result * channels;
+        *decoded_packets = i + 1;
+    }
+
+    return CODEC_SUCCESS;
+}
+
+// 恢复丢失的帧：有下一个包时用其带内FEC数据重建，否则执行PLC
+static codec_error_t opus_codec_decode_lost_impl(audio_codec_t* codec, const uint8_t* next_input, size_t next_input_size,
+                                                 size_t frame_samples, int16_t* output, size_t output_size,
+                                                 size_t* decoded_size) {
+    if (!codec || !codec->impl_data || !output || !decoded_size) {
+        LOG_ERROR("Invalid parameters for Opus loss recovery");
+        return CODEC_INVALID_PARAMETER;
+    }
+
+    if (!codec->decoder_initialized) {
+        LOG_ERROR("Opus decoder not initialized");
+        return CODEC_INITIALIZATION_FAILED;
+    }
+
+    if (output_size < frame_samples * (size_t)codec->format.channels) {
+        LOG_ERROR("Output buffer too small for Opus loss recovery: need %zu samples, got %zu",
+                  frame_samples * (size_t)codec->format.channels, output_size);
+        return CODEC_BUFFER_TOO_SMALL;
+    }
+
+    opus_codec_impl_t* impl = (opus_codec_impl_t*)codec->impl_data;
+
+    // frame_size 必须正好是丢失帧的时长，FEC 只能恢复紧邻下一个包之前的那一帧
+    int result;
+    if (next_input && next_input_size > 0) {
+        result = opus_decode(impl->decoder, next_input, (opus_int32)next_input_size,
+                             output, (int)frame_samples, 1);
+    } else {
+        result = opus_decode(impl->decoder, NULL, 0, output, (int)frame_samples, 0);
+    }
+    if (result < 0) {
+        LOG_ERROR("Opus loss recovery failed: %s", opus_strerror(result));
+        return CODEC_DECODING_FAILED;
+    }
+
+    *decoded_size = (size_t)(result * codec->format.channels);
+    return CODEC_SUCCESS;
+}
+
 // 获取编码器名称
 static const char* opus_get_codec_name(const audio_codec_t* codec) {
     (void)codec; // 避免未使用参数警告
@@ -332,18 +732,15 @@ static void opus_destroy(audio_codec_t* codec) {
     if (codec->impl_data) {
         opus_codec_impl_t* impl = (opus_codec_impl_t*)codec->impl_data;
         
-        if (impl->encoder) {
-            opus_encoder_destroy(impl->encoder);
-        }
-        
-        if (impl->decoder) {
-            opus_decoder_destroy(impl->decoder);
-        }
+        // 编解码器状态归还状态池，供下一个同格式的编解码器直接复位使用
+        opus_state_release(impl->encoder, true, impl->encoder_sample_rate, impl->encoder_channels,
+                           impl->application);
+        opus_state_release(impl->decoder, false, impl->decoder_sample_rate, impl->decoder_channels, 0);
         
-        free(impl);
+        LINX_FREE(impl);
     }
     
-    free(codec);
+    LINX_FREE(codec);
     LOG_INFO("Opus codec destroyed");
 }
 
@@ -8,9 +8,86 @@
 extern "C" {
 #endif
 
-// 创建Opus编解码器实例
+/*
+ * 构建档位（sdk/CMakeLists.txt 的 LINX_OPUS_PROFILE，按工具链选择）：
+ * - fixed：定点 libopus，用于没有双精度 FPU 的 ESP32 / RV32 核
+ * - neon：浮点 + NEON 内建函数（ARM Linux）
+ * - float：浮点 + SSE4.1/AVX 运行时检测（mac / Ubuntu 主机）
+ * 档位同时决定下面选项的默认值：定点档位复杂度 3、帧长 60 毫秒（每秒编码调用更少），
+ * 32 位 NEON 复杂度 5、帧长 20 毫秒，其余复杂度 10、帧长 20 毫秒。
+ */
+
+// 创建选项；0 表示使用构建档位的默认值
+typedef struct {
+    int complexity;         // 编码复杂度 (1-10，0 为档位默认值)
+    int frame_size_ms;      // 默认帧长 (毫秒，init_encoder/init_decoder 的 format.frame_size_ms 为 0 时使用)
+    int bitrate;            // 比特率 (bps，0 为 64000)
+    int application;        // OPUS_APPLICATION_*，0 为 OPUS_APPLICATION_VOIP
+} opus_codec_options_t;
+
+// 创建Opus编解码器实例（档位默认选项）
 audio_codec_t* opus_codec_create(void);
 
+// 按选项创建Opus编解码器实例，options 为 NULL 时同 opus_codec_create()
+audio_codec_t* opus_codec_create_with_options(const opus_codec_options_t* options);
+
+// 当前构建档位的默认选项
+opus_codec_options_t opus_codec_default_options(void);
+
+// 当前构建档位名称 ("fixed" / "neon" / "float")
+const char* opus_codec_build_profile(void);
+
+/*
+ * 编解码器状态池（容量 LINX_OPUS_STATE_POOL_SIZE，默认 4，编码器和解码器合计）
+ *
+ * 编解码器销毁或按新格式重新初始化时，旧状态保持初始化放回池中；之后同一格式的
+ * init_encoder/init_decoder 只复位池中的状态，声道数相同时在原内存上重新初始化，
+ * 切换音色、采样率或会话不再分配内存，第一个包的解码更早开始。池满时状态直接释放。
+ */
+typedef struct {
+    size_t hits;            // 取到同格式状态（只复位）的次数
+    size_t reinits;         // 取到同大小状态、原地重新初始化的次数
+    size_t allocs;          // 新分配状态的次数
+    size_t pooled;          // 当前池中的状态数
+} opus_codec_pool_stats_t;
+
+// 按格式预先初始化 encoders 个编码器和 decoders 个解码器状态放入池中（启动时调用）
+codec_error_t opus_codec_pool_prepare(const audio_format_t* format, int encoders, int decoders);
+
+// 释放池中的全部状态
+void opus_codec_pool_clear(void);
+
+// 获取状态池统计
+void opus_codec_pool_get_stats(opus_codec_pool_stats_t* stats);
+
+// Opus编解码器特定函数
+codec_error_t opus_codec_set_bitrate(audio_codec_t* codec, int bitrate);
+codec_error_t opus_codec_set_complexity(audio_codec_t* codec, int complexity);
+codec_error_t opus_codec_set_signal_type(audio_codec_t* codec, int signal_type);
+codec_error_t opus_codec_set_vbr(audio_codec_t* codec, int vbr);
+codec_error_t opus_codec_set_vbr_constraint(audio_codec_t* codec, int vbr_constraint);
+codec_error_t opus_codec_set_force_channels(audio_codec_t* codec, int force_channels);
+codec_error_t opus_codec_set_max_bandwidth(audio_codec_t* codec, int max_bandwidth);
+codec_error_t opus_codec_set_packet_loss_perc(audio_codec_t* codec, int packet_loss_perc);
+codec_error_t opus_codec_set_lsb_depth(audio_codec_t* codec, int lsb_depth);
+codec_error_t opus_codec_set_prediction_disabled(audio_codec_t* codec, int prediction_disabled);
+codec_error_t opus_codec_set_inband_fec(audio_codec_t* codec, int use_inband_fec);
+codec_error_t opus_codec_set_dtx(audio_codec_t* codec, int use_dtx);
+
+// 获取Opus编解码器参数
+int opus_codec_get_bitrate(const audio_codec_t* codec);
+int opus_codec_get_complexity(const audio_codec_t* codec);
+int opus_codec_get_signal_type(const audio_codec_t* codec);
+int opus_codec_get_vbr(const audio_codec_t* codec);
+int opus_codec_get_vbr_constraint(const audio_codec_t* codec);
+int opus_codec_get_force_channels(const audio_codec_t* codec);
+int opus_codec_get_max_bandwidth(const audio_codec_t* codec);
+int opus_codec_get_packet_loss_perc(const audio_codec_t* codec);
+int opus_codec_get_lsb_depth(const audio_codec_t* codec);
+int opus_codec_get_prediction_disabled(const audio_codec_t* codec);
+int opus_codec_get_inband_fec(const audio_codec_t* codec);
+int opus_codec_get_dtx(const audio_codec_t* codec);
+
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,167 @@
+#include "opus_frame_bundler.h"
+#include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
+#include <stdlib.h>
+#include <string.h>
+#include <opus.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_CODEC);
+
+// 合并包的最大字节数: TOC + 帧数字节 + 每帧最多 2 字节长度 + 帧数据
+#define BUNDLER_MAX_PACKET_BYTES \
+    (2 + OPUS_FRAME_BUNDLER_MAX_FRAMES * (OPUS_FRAME_BUNDLER_MAX_FRAME_BYTES + 2))
+
+struct opus_frame_bundler {
+    OpusRepacketizer* rp;
+    int bundle_frames;          // 每包合并的帧数，1 表示直通
+    int pending;                // 已放入 rp 的帧数
+
+    // repacketizer 只保存指针，帧数据必须在 out 之前保持有效
+    uint8_t frames[OPUS_FRAME_BUNDLER_MAX_FRAMES][OPUS_FRAME_BUNDLER_MAX_FRAME_BYTES];
+    uint8_t packet[BUNDLER_MAX_PACKET_BYTES];
+};
+
+static bool bundler_frames_valid(int bundle_frames) {
+    return bundle_frames >= 0 && bundle_frames <= OPUS_FRAME_BUNDLER_MAX_FRAMES;
+}
+
+static void bundler_reset(opus_frame_bundler_t* bundler) {
+    opus_repacketizer_init(bundler->rp);
+    bundler->pending = 0;
+}
+
+// 把已缓存的帧合并输出到 bundler->packet
+static codec_error_t bundler_emit(opus_frame_bundler_t* bundler, size_t* packet_size) {
+    opus_int32 len = opus_repacketizer_out(bundler->rp, bundler->packet, (opus_int32)sizeof(bundler->packet));
+    bundler_reset(bundler);
+    if (len < 0) {
+        LOG_ERROR("Opus合包失败: %s", opus_strerror(len));
+        *packet_size = 0;
+        return CODEC_ENCODING_FAILED;
+    }
+    *packet_size = (size_t)len;
+    return CODEC_SUCCESS;
+}
+
+opus_frame_bundler_t* opus_frame_bundler_create(int bundle_frames) {
+    if (!bundler_frames_valid(bundle_frames)) {
+        return NULL;
+    }
+
+    opus_frame_bundler_t* bundler = (opus_frame_bundler_t*)LINX_CALLOC(1, sizeof(opus_frame_bundler_t));
+    if (!bundler) {
+        return NULL;
+    }
+
+    // repacketizer 状态由 SDK 分配器分配，与编解码器状态一样不经 libopus 内部的 malloc
+    bundler->rp = (OpusRepacketizer*)LINX_MALLOC((size_t)opus_repacketizer_get_size());
+    if (!bundler->rp) {
+        LINX_FREE(bundler);
+        return NULL;
+    }
+    opus_repacketizer_init(bundler->rp);
+
+    bundler->bundle_frames = bundle_frames > 1 ? bundle_frames : 1;
+    bundler->pending = 0;
+    return bundler;
+}
+
+void opus_frame_bundler_destroy(opus_frame_bundler_t* bundler) {
+    if (!bundler) {
+        return;
+    }
+    LINX_FREE(bundler->rp);
+    LINX_FREE(bundler);
+}
+
+codec_error_t opus_frame_bundler_set_bundle_frames(opus_frame_bundler_t* bundler, int bundle_frames) {
+    if (!bundler || !bundler_frames_valid(bundle_frames)) {
+        return CODEC_INVALID_PARAMETER;
+    }
+    bundler_reset(bundler);
+    bundler->bundle_frames = bundle_frames > 1 ? bundle_frames : 1;
+    return CODEC_SUCCESS;
+}
+
+int opus_frame_bundler_get_bundle_frames(const opus_frame_bundler_t* bundler) {
+    return bundler ? bundler->bundle_frames : 0;
+}
+
+codec_error_t opus_frame_bundler_push(opus_frame_bundler_t* bundler, const uint8_t* frame, size_t frame_size,
+                                      const uint8_t** packet, size_t* packet_size) {
+    if (!bundler || !frame || !packet || !packet_size) {
+        return CODEC_INVALID_PARAMETER;
+    }
+
+    *packet = NULL;
+    *packet_size = 0;
+
+    if (frame_size == 0 || frame_size > OPUS_FRAME_BUNDLER_MAX_FRAME_BYTES ||
+        opus_packet_get_nb_frames(frame, (opus_int32)frame_size) < 1) {
+        return CODEC_INVALID_PARAMETER;
+    }
+
+    // 直通: 原样输出
+    if (bundler->bundle_frames <= 1 && bundler->pending == 0) {
+        memcpy(bundler->packet, frame, frame_size);
+        *packet = bundler->packet;
+        *packet_size = frame_size;
+        return CODEC_SUCCESS;
+    }
+
+    uint8_t* slot = bundler->frames[bundler->pending];
+    memcpy(slot, frame, frame_size);
+
+    codec_error_t result = CODEC_SUCCESS;
+    if (opus_repacketizer_cat(bundler->rp, slot, (opus_int32)frame_size) != OPUS_OK) {
+        if (bundler->pending == 0) {
+            bundler_reset(bundler);
+            return CODEC_INVALID_PARAMETER;
+        }
+
+        // 与已缓存的帧参数不一致或总时长超过 120ms: 先输出已有部分，当前帧开始新的一包
+        result = bundler_emit(bundler, packet_size);
+        if (result == CODEC_SUCCESS) {
+            *packet = bundler->packet;
+        }
+
+        memcpy(bundler->frames[0], frame, frame_size);
+        if (opus_repacketizer_cat(bundler->rp, bundler->frames[0], (opus_int32)frame_size) != OPUS_OK) {
+            bundler_reset(bundler);
+            return result;
+        }
+        bundler->pending = 1;
+        return result;
+    }
+
+    bundler->pending++;
+    if (bundler->pending >= bundler->bundle_frames) {
+        result = bundler_emit(bundler, packet_size);
+        if (result == CODEC_SUCCESS) {
+            *packet = bundler->packet;
+        }
+    }
+    return result;
+}
+
+codec_error_t opus_frame_bundler_flush(opus_frame_bundler_t* bundler, const uint8_t** packet, size_t* packet_size) {
+    if (!bundler || !packet || !packet_size) {
+        return CODEC_INVALID_PARAMETER;
+    }
+
+    *packet = NULL;
+    *packet_size = 0;
+    if (bundler->pending == 0) {
+        return CODEC_SUCCESS;
+    }
+
+    codec_error_t result = bundler_emit(bundler, packet_size);
+    if (result == CODEC_SUCCESS) {
+        *packet = bundler->packet;
+    }
+    return result;
+}
+
+int opus_frame_bundler_pending(const opus_frame_bundler_t* bundler) {
+    return bundler ? bundler->pending : 0;
+}
@@ -0,0 +1,82 @@
+#ifndef OPUS_FRAME_BUNDLER_H
+#define OPUS_FRAME_BUNDLER_H
+
+#include "audio_codec.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 单个包最多合并的帧数 (6 x 20ms = Opus 单包上限 120ms)
+#define OPUS_FRAME_BUNDLER_MAX_FRAMES 6
+
+// 单个 Opus 帧的最大字节数
+#define OPUS_FRAME_BUNDLER_MAX_FRAME_BYTES 1275
+
+/**
+ * Opus 多帧合包器
+ *
+ * 基于 libopus 的 OpusRepacketizer，把连续的若干个编码帧合并成一个 Opus 包
+ * (code 3 多帧包)，减少上行消息数量和每条消息的协议头开销。合包只改写 TOC
+ * 和帧长字段，不重新编码，音质不变；代价是最多增加 (N-1) 帧的上行延迟。
+ *
+ * bundle_frames 为 0 或 1 时直通，每帧原样输出，适用于低延迟场景。
+ * 不是线程安全的，调用方负责加锁。
+ */
+typedef struct opus_frame_bundler opus_frame_bundler_t;
+
+/**
+ * 创建合包器
+ * @param bundle_frames 每包合并的帧数 (0/1 表示不合包，最大 OPUS_FRAME_BUNDLER_MAX_FRAMES)
+ * @return 合包器实例，失败返回 NULL
+ */
+opus_frame_bundler_t* opus_frame_bundler_create(int bundle_frames);
+
+/**
+ * 销毁合包器 (未输出的帧直接丢弃)
+ */
+void opus_frame_bundler_destroy(opus_frame_bundler_t* bundler);
+
+/**
+ * 修改每包合并的帧数
+ * 调用前应先用 opus_frame_bundler_flush() 取走已缓存的帧，否则缓存帧会被丢弃
+ * @return 参数非法时返回 CODEC_INVALID_PARAMETER
+ */
+codec_error_t opus_frame_bundler_set_bundle_frames(opus_frame_bundler_t* bundler, int bundle_frames);
+
+/**
+ * 当前每包合并的帧数 (直通时为 1)
+ */
+int opus_frame_bundler_get_bundle_frames(const opus_frame_bundler_t* bundler);
+
+/**
+ * 放入一个 Opus 帧
+ *
+ * 攒够 bundle_frames 帧时通过 packet 输出合并后的包；帧参数 (模式/带宽/帧长)
+ * 变化导致无法合并，或总时长超过 120ms 时，先输出已攒的部分，当前帧留作下一包的开头。
+ *
+ * @param packet      输出包地址，没有可输出的包时置为 NULL；在下一次调用前有效
+ * @param packet_size 输出包字节数，没有可输出的包时为 0
+ * @return CODEC_SUCCESS 或错误码 (帧非法时返回 CODEC_INVALID_PARAMETER，已缓存的帧保持不变)
+ */
+codec_error_t opus_frame_bundler_push(opus_frame_bundler_t* bundler, const uint8_t* frame, size_t frame_size,
+                                      const uint8_t** packet, size_t* packet_size);
+
+/**
+ * 取走尚未攒满的帧，合并成一个包输出
+ * 用于一段语音结束时，避免尾部最多 (N-1) 帧滞留
+ * @param packet      输出包地址，没有缓存帧时置为 NULL
+ * @param packet_size 输出包字节数
+ */
+codec_error_t opus_frame_bundler_flush(opus_frame_bundler_t* bundler, const uint8_t** packet, size_t* packet_size);
+
+/**
+ * 当前已缓存、尚未输出的帧数
+ */
+int opus_frame_bundler_pending(const opus_frame_bundler_t* bundler);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // OPUS_FRAME_BUNDLER_H
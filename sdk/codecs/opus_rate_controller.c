@@ -0,0 +1,225 @@
+#include "opus_rate_controller.h"
+#include "../log/linx_alloc.h"
+#include "opus_codec.h"
+#include <stdlib.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_CODEC);
+
+#define RATE_UPDATE_INTERVAL_MS     250     // 两次评估的最小间隔
+#define RATE_CONGESTED_DELAY_MS     200     // 估计排队时延超过此值视为拥塞
+#define RATE_CLEAR_DELAY_MS         60      // 估计排队时延低于此值视为空闲
+#define RATE_DECREASE_HOLD_MS       500     // 两次下调的最小间隔，等待上一次下调生效
+#define RATE_INCREASE_HOLD_MS       3000    // 持续空闲多久后开始回升
+#define RATE_INCREASE_INTERVAL_MS   1000    // 回升步进间隔
+#define RATE_INCREASE_MIN_STEP      1000    // 回升最小步长 (bps)
+#define RATE_FEC_ON_PERC            2       // 平滑丢包率达到此值开启 FEC
+#define RATE_FEC_OFF_PERC           1       // 平滑丢包率低于此值关闭 FEC
+#define RATE_LOSS_SCALE             16      // 丢包率定点放大倍数
+
+struct opus_rate_controller {
+    opus_rate_controller_config_t config;
+    opus_rate_controller_target_t target;
+
+    // 已下发给编码器的参数，-1 表示尚未下发
+    int applied_bitrate;
+    int applied_packet_loss_perc;
+    int applied_fec;
+
+    // 网络观测
+    int rtt_base_ms;            // RTT 基线 (近似无排队时的往返时间)，-1 表示未知
+    int loss_scaled;            // 平滑后的丢包率 x RATE_LOSS_SCALE
+    bool loss_known;
+    int pending_loss_perc;      // 两次评估之间收到的最新丢包率，-1 表示没有
+
+    // 调整节奏
+    bool started;
+    bool has_decreased;
+    uint64_t last_update_ms;
+    uint64_t last_decrease_ms;
+    uint64_t last_increase_ms;
+    uint64_t clear_since_ms;    // 连续空闲的起始时间
+};
+
+static int clamp_int(int value, int min_value, int max_value) {
+    if (value < min_value) return min_value;
+    if (value > max_value) return max_value;
+    return value;
+}
+
+opus_rate_controller_t* opus_rate_controller_create(const opus_rate_controller_config_t* config) {
+    if (!config || config->min_bitrate <= 0 || config->max_bitrate < config->min_bitrate ||
+        config->max_packet_loss_perc < 0 || config->max_packet_loss_perc > 100) {
+        return NULL;
+    }
+
+    opus_rate_controller_t* ctrl = (opus_rate_controller_t*)LINX_CALLOC(1, sizeof(opus_rate_controller_t));
+    if (!ctrl) {
+        return NULL;
+    }
+
+    ctrl->config = *config;
+    if (ctrl->config.frame_duration_ms <= 0) {
+        ctrl->config.frame_duration_ms = 20;
+    }
+
+    ctrl->target.bitrate = config->max_bitrate;
+    ctrl->target.packet_loss_perc = 0;
+    ctrl->target.inband_fec = false;
+    opus_rate_controller_reset(ctrl);
+    return ctrl;
+}
+
+void opus_rate_controller_destroy(opus_rate_controller_t* ctrl) {
+    LINX_FREE(ctrl);
+}
+
+void opus_rate_controller_reset(opus_rate_controller_t* ctrl) {
+    if (!ctrl) {
+        return;
+    }
+    ctrl->applied_bitrate = -1;
+    ctrl->applied_packet_loss_perc = -1;
+    ctrl->applied_fec = -1;
+    ctrl->rtt_base_ms = -1;
+    ctrl->loss_scaled = 0;
+    ctrl->loss_known = false;
+    ctrl->pending_loss_perc = -1;
+    ctrl->started = false;
+    ctrl->has_decreased = false;
+}
+
+/* 根据积压和 RTT 估计当前的排队时延 (毫秒) */
+static uint64_t estimate_queue_delay_ms(opus_rate_controller_t* ctrl, const opus_rate_controller_sample_t* sample) {
+    uint64_t delay_ms = (uint64_t)sample->queued_frames * (uint64_t)ctrl->config.frame_duration_ms;
+    delay_ms += (uint64_t)sample->backlog_bytes * 8000 / (uint64_t)ctrl->target.bitrate;
+
+    if (sample->rtt_ms >= 0) {
+        if (ctrl->rtt_base_ms < 0 || sample->rtt_ms < ctrl->rtt_base_ms) {
+            ctrl->rtt_base_ms = sample->rtt_ms;
+        } else {
+            // 基线缓慢跟随，适应路由变化
+            ctrl->rtt_base_ms += (sample->rtt_ms - ctrl->rtt_base_ms + 63) / 64;
+        }
+        delay_ms += (uint64_t)(sample->rtt_ms - ctrl->rtt_base_ms);
+    }
+    return delay_ms;
+}
+
+static void update_bitrate(opus_rate_controller_t* ctrl, uint64_t delay_ms, uint64_t now_ms) {
+    int bitrate = ctrl->target.bitrate;
+
+    if (delay_ms >= RATE_CONGESTED_DELAY_MS) {
+        // 拥塞: 乘性下降
+        if (!ctrl->has_decreased || now_ms - ctrl->last_decrease_ms >= RATE_DECREASE_HOLD_MS) {
+            bitrate = bitrate * 3 / 4;
+            ctrl->has_decreased = true;
+            ctrl->last_decrease_ms = now_ms;
+        }
+        ctrl->clear_since_ms = now_ms;
+    } else if (delay_ms > RATE_CLEAR_DELAY_MS) {
+        // 轻度积压: 保持
+        ctrl->clear_since_ms = now_ms;
+    } else if (now_ms - ctrl->clear_since_ms >= RATE_INCREASE_HOLD_MS &&
+               now_ms - ctrl->last_increase_ms >= RATE_INCREASE_INTERVAL_MS) {
+        // 持续空闲: 加性回升
+        int step = bitrate / 16;
+        bitrate += step > RATE_INCREASE_MIN_STEP ? step : RATE_INCREASE_MIN_STEP;
+        ctrl->last_increase_ms = now_ms;
+    }
+
+    ctrl->target.bitrate = clamp_int(bitrate, ctrl->config.min_bitrate, ctrl->config.max_bitrate);
+}
+
+static void update_loss(opus_rate_controller_t* ctrl, int loss_perc) {
+    if (loss_perc >= 0) {
+        int scaled = clamp_int(loss_perc, 0, 100) * RATE_LOSS_SCALE;
+        ctrl->loss_scaled = ctrl->loss_known ? (ctrl->loss_scaled * 3 + scaled) / 4 : scaled;
+        ctrl->loss_known = true;
+    }
+
+    // 向上取整，避免少量丢包被平滑成 0
+    int loss = (ctrl->loss_scaled + RATE_LOSS_SCALE - 1) / RATE_LOSS_SCALE;
+    ctrl->target.packet_loss_perc = clamp_int(loss, 0, ctrl->config.max_packet_loss_perc);
+
+    if (!ctrl->config.adaptive_fec) {
+        ctrl->target.inband_fec = false;
+    } else if (!ctrl->target.inband_fec && loss >= RATE_FEC_ON_PERC) {
+        ctrl->target.inband_fec = true;
+    } else if (ctrl->target.inband_fec && loss < RATE_FEC_OFF_PERC) {
+        ctrl->target.inband_fec = false;
+    }
+}
+
+bool opus_rate_controller_update(opus_rate_controller_t* ctrl, const opus_rate_controller_sample_t* sample,
+                                 uint64_t now_ms) {
+    if (!ctrl || !sample) {
+        return false;
+    }
+
+    if (!ctrl->started) {
+        ctrl->started = true;
+        ctrl->clear_since_ms = now_ms;
+        ctrl->last_increase_ms = now_ms;
+    } else if (now_ms - ctrl->last_update_ms < RATE_UPDATE_INTERVAL_MS) {
+        // 丢包率报告留到下次评估，不因限频而丢失
+        if (sample->loss_perc >= 0) {
+            ctrl->pending_loss_perc = sample->loss_perc;
+        }
+        return false;
+    }
+    ctrl->last_update_ms = now_ms;
+
+    int loss_perc = sample->loss_perc >= 0 ? sample->loss_perc : ctrl->pending_loss_perc;
+    ctrl->pending_loss_perc = -1;
+
+    opus_rate_controller_target_t previous = ctrl->target;
+
+    update_bitrate(ctrl, estimate_queue_delay_ms(ctrl, sample), now_ms);
+    update_loss(ctrl, loss_perc);
+
+    return previous.bitrate != ctrl->target.bitrate ||
+           previous.packet_loss_perc != ctrl->target.packet_loss_perc ||
+           previous.inband_fec != ctrl->target.inband_fec;
+}
+
+bool opus_rate_controller_get_target(const opus_rate_controller_t* ctrl, opus_rate_controller_target_t* target) {
+    if (!ctrl || !target) {
+        return false;
+    }
+    *target = ctrl->target;
+    return true;
+}
+
+codec_error_t opus_rate_controller_apply(opus_rate_controller_t* ctrl, audio_codec_t* codec) {
+    if (!ctrl || !codec) {
+        return CODEC_INVALID_PARAMETER;
+    }
+
+    codec_error_t result;
+    if (ctrl->applied_bitrate != ctrl->target.bitrate) {
+        result = opus_codec_set_bitrate(codec, ctrl->target.bitrate);
+        if (result != CODEC_SUCCESS) {
+            return result;
+        }
+        ctrl->applied_bitrate = ctrl->target.bitrate;
+    }
+
+    if (ctrl->applied_packet_loss_perc != ctrl->target.packet_loss_perc) {
+        result = opus_codec_set_packet_loss_perc(codec, ctrl->target.packet_loss_perc);
+        if (result != CODEC_SUCCESS) {
+            return result;
+        }
+        ctrl->applied_packet_loss_perc = ctrl->target.packet_loss_perc;
+    }
+
+    int fec = ctrl->target.inband_fec ? 1 : 0;
+    if (ctrl->applied_fec != fec) {
+        result = opus_codec_set_inband_fec(codec, fec);
+        if (result != CODEC_SUCCESS) {
+            return result;
+        }
+        ctrl->applied_fec = fec;
+    }
+
+    return CODEC_SUCCESS;
+}
@@ -0,0 +1,89 @@
+#ifndef OPUS_RATE_CONTROLLER_H
+#define OPUS_RATE_CONTROLLER_H
+
+#include "audio_codec.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Opus 上行码率自适应控制器
+ *
+ * 根据发送积压、往返时间和服务端报告的丢包率调整编码参数：
+ * - 积压或排队时延 (RTT 高出基线的部分) 超过阈值时码率乘性下降，
+ *   网络持续空闲后码率加性回升 (AIMD)，始终限制在 [min_bitrate, max_bitrate]；
+ * - 平滑后的丢包率同步给编码器 (OPUS_SET_PACKET_LOSS_PERC)，
+ *   丢包明显时开启带内 FEC，恢复后关闭 (带滞回)。
+ *
+ * 控制器本身只做计算，不是线程安全的；opus_rate_controller_apply() 必须在
+ * 调用编码器的线程上执行，避免与 opus_encode 并发。
+ */
+typedef struct opus_rate_controller opus_rate_controller_t;
+
+// 控制器配置
+typedef struct {
+    int min_bitrate;            // 码率下限 (bps)
+    int max_bitrate;            // 码率上限 (bps)，也是初始码率
+    int max_packet_loss_perc;   // 告知编码器的预期丢包率上限 (0-100)
+    bool adaptive_fec;          // 丢包时是否自动开启带内 FEC
+    int frame_duration_ms;      // 每帧时长 (毫秒)，用于把排队帧数换算成时延
+} opus_rate_controller_config_t;
+
+// 一次网络观测
+typedef struct {
+    size_t queued_frames;       // 等待发送的音频帧数
+    size_t backlog_bytes;       // socket 发送缓冲区中尚未写出的字节数
+    int rtt_ms;                 // 最近一次往返时间，小于 0 表示未知
+    int loss_perc;              // 服务端报告的丢包率 (%)，小于 0 表示未知
+} opus_rate_controller_sample_t;
+
+// 控制器输出的编码参数
+typedef struct {
+    int bitrate;                // 码率 (bps)
+    int packet_loss_perc;       // 预期丢包率 (%)
+    bool inband_fec;            // 是否开启带内 FEC
+} opus_rate_controller_target_t;
+
+/**
+ * 创建控制器
+ * @return 控制器实例，配置非法或内存不足时返回 NULL
+ */
+opus_rate_controller_t* opus_rate_controller_create(const opus_rate_controller_config_t* config);
+
+/**
+ * 销毁控制器
+ */
+void opus_rate_controller_destroy(opus_rate_controller_t* ctrl);
+
+/**
+ * 清除网络观测 (RTT 基线、丢包率)，保留当前码率；下次 apply 时重新下发全部参数
+ * 用于重新建立连接或更换编码器后
+ */
+void opus_rate_controller_reset(opus_rate_controller_t* ctrl);
+
+/**
+ * 输入一次观测并更新目标参数
+ * 内部限制调整频率，可以每帧调用
+ * @param now_ms 单调时钟时间 (毫秒)
+ * @return 目标参数发生变化时返回 true
+ */
+bool opus_rate_controller_update(opus_rate_controller_t* ctrl, const opus_rate_controller_sample_t* sample,
+                                 uint64_t now_ms);
+
+/**
+ * 获取当前目标参数
+ */
+bool opus_rate_controller_get_target(const opus_rate_controller_t* ctrl, opus_rate_controller_target_t* target);
+
+/**
+ * 把目标参数中发生变化的部分下发给 Opus 编码器
+ * @param codec opus_codec_create() 创建并已初始化编码器的实例
+ */
+codec_error_t opus_rate_controller_apply(opus_rate_controller_t* ctrl, audio_codec_t* codec);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // OPUS_RATE_CONTROLLER_H
@@ -0,0 +1,159 @@
+#include "pcm_codec.h"
+#include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
+#include <stdlib.h>
+#include <string.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_CODEC);
+
+// 前向声明
+static codec_error_t pcm_init_encoder(audio_codec_t* codec, const audio_format_t* format);
+static codec_error_t pcm_init_decoder(audio_codec_t* codec, const audio_format_t* format);
+static codec_error_t pcm_encode(audio_codec_t* codec, const int16_t* input, size_t input_size,
+                               uint8_t* output, size_t output_size, size_t* encoded_size);
+static codec_error_t pcm_decode(audio_codec_t* codec, const uint8_t* input, size_t input_size,
+                               int16_t* output, size_t output_size, size_t* decoded_size);
+static const char* pcm_get_codec_name(const audio_codec_t* codec);
+static codec_error_t pcm_reset(audio_codec_t* codec);
+static int pcm_get_input_frame_size(const audio_codec_t* codec);
+static int pcm_get_max_output_size(const audio_codec_t* codec);
+static void pcm_destroy(audio_codec_t* codec);
+
+// PCM 编解码器虚函数表
+static const audio_codec_vtable_t pcm_vtable = {
+    .init_encoder = pcm_init_encoder,
+    .init_decoder = pcm_init_decoder,
+    .encode = pcm_encode,
+    .decode = pcm_decode,
+    .get_codec_name = pcm_get_codec_name,
+    .reset = pcm_reset,
+    .get_input_frame_size = pcm_get_input_frame_size,
+    .get_max_output_size = pcm_get_max_output_size,
+    .destroy = pcm_destroy
+};
+
+// 创建 PCM 编解码器实例
+audio_codec_t* pcm_codec_create(void) {
+    audio_codec_t* codec = (audio_codec_t*)LINX_CALLOC(1, sizeof(audio_codec_t));
+    if (!codec) {
+        LOG_ERROR("Failed to allocate memory for PCM codec");
+        return NULL;
+    }
+
+    codec->vtable = &pcm_vtable;
+    codec->impl_data = NULL;  // 无状态
+    audio_format_default(&codec->format);
+
+    LOG_INFO("PCM codec created successfully");
+    return codec;
+}
+
+static codec_error_t pcm_init_encoder(audio_codec_t* codec, const audio_format_t* format) {
+    if (!codec || !format || format->channels <= 0 || format->bits_per_sample != 16) {
+        return CODEC_INVALID_PARAMETER;
+    }
+    codec->format = *format;
+    codec->encoder_initialized = true;
+    return CODEC_SUCCESS;
+}
+
+static codec_error_t pcm_init_decoder(audio_codec_t* codec, const audio_format_t* format) {
+    if (!codec || !format || format->channels <= 0 || format->bits_per_sample != 16) {
+        return CODEC_INVALID_PARAMETER;
+    }
+    codec->format = *format;
+    codec->decoder_initialized = true;
+    return CODEC_SUCCESS;
+}
+
+// 编码：按小端序输出，小端平台上就是一次 memcpy
+static codec_error_t pcm_encode(audio_codec_t* codec, const int16_t* input, size_t input_size,
+                               uint8_t* output, size_t output_size, size_t* encoded_size) {
+    if (!codec || !input || !output || !encoded_size) {
+        return CODEC_INVALID_PARAMETER;
+    }
+    if (!codec->encoder_initialized) {
+        return CODEC_INITIALIZATION_FAILED;
+    }
+
+    size_t bytes = input_size * 2;
+    if (bytes > output_size) {
+        return CODEC_BUFFER_TOO_SMALL;
+    }
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    for (size_t i = 0; i < input_size; i++) {
+        uint16_t s = (uint16_t)input[i];
+        output[2 * i] = (uint8_t)(s & 0xFF);
+        output[2 * i + 1] = (uint8_t)(s >> 8);
+    }
+#else
+    memcpy(output, input, bytes);
+#endif
+
+    *encoded_size = bytes;
+    return CODEC_SUCCESS;
+}
+
+static codec_error_t pcm_decode(audio_codec_t* codec, const uint8_t* input, size_t input_size,
+                               int16_t* output, size_t output_size, size_t* decoded_size) {
+    if (!codec || !input || !output || !decoded_size) {
+        return CODEC_INVALID_PARAMETER;
+    }
+    if (!codec->decoder_initialized) {
+        return CODEC_INITIALIZATION_FAILED;
+    }
+    if (input_size % 2 != 0) {
+        LOG_WARN("PCM decoder: odd payload size %zu", input_size);
+        return CODEC_DECODING_FAILED;
+    }
+
+    size_t samples = input_size / 2;
+    if (samples > output_size) {
+        return CODEC_BUFFER_TOO_SMALL;
+    }
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    for (size_t i = 0; i < samples; i++) {
+        output[i] = (int16_t)((uint16_t)input[2 * i] | ((uint16_t)input[2 * i + 1] << 8));
+    }
+#else
+    memcpy(output, input, input_size);
+#endif
+
+    *decoded_size = samples;
+    return CODEC_SUCCESS;
+}
+
+static const char* pcm_get_codec_name(const audio_codec_t* codec) {
+    (void)codec;
+    return "PCM16";
+}
+
+static codec_error_t pcm_reset(audio_codec_t* codec) {
+    return codec ? CODEC_SUCCESS : CODEC_INVALID_PARAMETER;
+}
+
+// 获取建议的输入帧大小（每声道样本数）
+static int pcm_get_input_frame_size(const audio_codec_t* codec) {
+    if (!codec) {
+        return -1;
+    }
+    return codec->format.sample_rate * codec->format.frame_size_ms / 1000;
+}
+
+// 获取最大输出缓冲区大小（样本数，用于解码），与 Opus 一致按 120ms 计算
+static int pcm_get_max_output_size(const audio_codec_t* codec) {
+    if (!codec) {
+        return -1;
+    }
+    return codec->format.sample_rate * 120 / 1000 * codec->format.channels;
+}
+
+static void pcm_destroy(audio_codec_t* codec) {
+    if (!codec) {
+        return;
+    }
+    LINX_FREE(codec);
+    LOG_INFO("PCM codec destroyed");
+}
@@ -0,0 +1,24 @@
+#ifndef PCM_CODEC_H
+#define PCM_CODEC_H
+
+#include "audio_codec.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * PCM16 直通编解码器
+ *
+ * 不做压缩，每个样本按 16 位小端序存放 (pcm_s16le)。
+ * 几乎不占 CPU，适合算力最紧张、带宽充裕的板子。
+ */
+
+// 创建 PCM16 直通编解码器实例
+audio_codec_t* pcm_codec_create(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PCM_CODEC_H
@@ -0,0 +1,454 @@
+/**
+ * Opus 编解码性能基准
+ *
+ * 遍历复杂度、码率、帧长 (10/20/40/60ms) 和 FEC/DTX 组合，每组配置新建一对编解码器，
+ * 输出每帧编码/解码耗时 (平均与最大, µs)、实时倍数 xRT (音频时长 / 处理耗时)、
+ * 平均包长，以及每个 audio_codec_t 的栈峰值和堆峰值，用于为各板卡选择默认参数。
+ *
+ * 栈峰值用栈着色测得：先在当前栈下方填充标记字节，调用编解码后统计被改写的深度。
+ * 堆峰值需要链接时用 -Wl,--wrap=malloc,... 包装分配函数 (CMake 在 GNU 链接器下自动开启，
+ * 定义 CODEC_BENCH_TRACK_HEAP)，否则该列输出 "-"。
+ *
+ * 交叉编译时使用 build/toolchains 下的工具链文件构建本目录，在目标板上运行；
+ * ESP-IDF 工程中以 app_main 入口用默认参数运行一次。
+ *
+ * 用法: codec_bench [-d 每组秒数] [-q] [--csv]
+ *   -q     快速模式：复杂度 0/5/10，码率 16k，关闭 FEC/DTX
+ *   --csv  输出 CSV，便于汇总不同工具链的结果
+ */
+
+#include "audio_codec.h"
+#include "opus_codec.h"
+#include "../log/linx_log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include <time.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define BENCH_SAMPLE_RATE 16000
+#define BENCH_CHANNELS 1
+#define BENCH_MAX_FRAME_MS 60
+#define BENCH_MAX_FRAME (BENCH_SAMPLE_RATE * BENCH_MAX_FRAME_MS / 1000)
+#define BENCH_MAX_PACKET 4000
+#define BENCH_STACK_PAINT (48 * 1024)   // 着色深度，需大于 Opus 最坏栈用量
+#define BENCH_STACK_MAGIC 0xA5
+
+#ifndef CODEC_BENCH_TOOLCHAIN
+#define CODEC_BENCH_TOOLCHAIN "host"
+#endif
+
+#if defined(__XTENSA__)
+#define BENCH_ARCH "xtensa"
+#elif defined(__riscv)
+#define BENCH_ARCH "riscv"
+#elif defined(__aarch64__)
+#define BENCH_ARCH "aarch64"
+#elif defined(__arm__)
+#define BENCH_ARCH "arm"
+#elif defined(__x86_64__)
+#define BENCH_ARCH "x86_64"
+#else
+#define BENCH_ARCH "unknown"
+#endif
+
+// ==================== 堆统计 (--wrap) ====================
+
+static size_t g_heap_current = 0;
+static size_t g_heap_peak = 0;
+
+#ifdef CODEC_BENCH_TRACK_HEAP
+// 每个块前加一个头记录大小；没有标记的指针来自未包装的分配 (如 libc 内部)，直接交回
+#define HEAP_HEADER_SIZE 16
+#define HEAP_TAG 0x4C494E58u
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+void __real_free(void* ptr);
+
+typedef struct {
+    uint32_t tag;
+    uint32_t reserved;
+    uint64_t size;
+} heap_header_t;
+
+static void* heap_track(void* raw, size_t size) {
+    if (!raw) return NULL;
+    heap_header_t* header = (heap_header_t*)raw;
+    header->tag = HEAP_TAG;
+    header->size = size;
+    g_heap_current += size;
+    if (g_heap_current > g_heap_peak) g_heap_peak = g_heap_current;
+    return (uint8_t*)raw + HEAP_HEADER_SIZE;
+}
+
+static heap_header_t* heap_header(void* ptr) {
+    heap_header_t* header = (heap_header_t*)((uint8_t*)ptr - HEAP_HEADER_SIZE);
+    return header->tag == HEAP_TAG ? header : NULL;
+}
+
+void* __wrap_malloc(size_t size) {
+    return heap_track(__real_malloc(size + HEAP_HEADER_SIZE), size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    if (size && count > (SIZE_MAX - HEAP_HEADER_SIZE) / size) return NULL;
+    size_t total = count * size;
+    void* raw = __real_malloc(total + HEAP_HEADER_SIZE);
+    if (raw) memset((uint8_t*)raw + HEAP_HEADER_SIZE, 0, total);
+    return heap_track(raw, total);
+}
+
+void __wrap_free(void* ptr) {
+    if (!ptr) return;
+    heap_header_t* header = heap_header(ptr);
+    if (!header) {
+        __real_free(ptr);
+        return;
+    }
+    g_heap_current -= (size_t)header->size;
+    header->tag = 0;
+    __real_free(header);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    if (!ptr) return __wrap_malloc(size);
+    heap_header_t* header = heap_header(ptr);
+    if (!header) return __real_realloc(ptr, size);
+
+    size_t old_size = (size_t)header->size;
+    void* raw = __real_realloc(header, size + HEAP_HEADER_SIZE);
+    if (!raw) return NULL;
+    g_heap_current -= old_size;
+    return heap_track(raw, size);
+}
+#endif
+
+// ==================== 栈着色 ====================
+
+static size_t g_stack_base_depth = 0;
+
+__attribute__((noinline)) static void stack_paint(void) {
+    volatile uint8_t region[BENCH_STACK_PAINT];
+    for (size_t i = 0; i < sizeof(region); i++) {
+        region[i] = BENCH_STACK_MAGIC;
+    }
+}
+
+// 与 stack_paint 同深度调用：从最深处起数仍保持标记的字节，其余即被改写的深度
+__attribute__((noinline)) static size_t stack_measure(void) {
+    volatile uint8_t region[BENCH_STACK_PAINT];
+    size_t untouched = 0;
+    while (untouched < sizeof(region) && region[untouched] == BENCH_STACK_MAGIC) {
+        untouched++;
+    }
+    return sizeof(region) - untouched;
+}
+
+// 空调用的改写深度作为基线，消除测量函数自身的栈帧
+static void stack_calibrate(void) {
+    stack_paint();
+    g_stack_base_depth = stack_measure();
+}
+
+// ==================== 测试信号 ====================
+
+/**
+ * 生成类语音信号：基频随时间滑动的谐波串加噪声，按音节调幅，每 3 秒有 1 秒静音 (供 DTX 生效)
+ */
+static void generate_speech_like(int16_t* buffer, size_t samples) {
+    uint32_t seed = 12345;
+    double phase = 0.0;
+    for (size_t i = 0; i < samples; i++) {
+        double t = (double)i / BENCH_SAMPLE_RATE;
+        seed = seed * 1103515245u + 12345u;
+        double noise = ((double)((seed >> 16) & 0x7FFF) / 16384.0 - 1.0) * 0.05;
+        double f0 = 140.0 + 40.0 * sin(2.0 * M_PI * 0.7 * t);
+        phase += 2.0 * M_PI * f0 / BENCH_SAMPLE_RATE;
+        double voiced = 0.0;
+        for (int h = 1; h <= 8; h++) {
+            voiced += sin(phase * h) / h;
+        }
+        double envelope = 0.5 + 0.5 * sin(2.0 * M_PI * 4.0 * t);
+        bool silent = fmod(t, 3.0) >= 2.0;
+        double sample = silent ? noise * 0.02 : (voiced * envelope * 0.4 + noise);
+        buffer[i] = (int16_t)(sample * 12000.0);
+    }
+}
+
+// ==================== 基准 ====================
+
+typedef struct {
+    int complexity;
+    int bitrate;
+    int frame_ms;
+    bool fec;
+    bool dtx;
+} bench_config_t;
+
+typedef struct {
+    double encode_avg_us;
+    double encode_max_us;
+    double decode_avg_us;
+    double decode_max_us;
+    double encode_xrt;
+    double decode_xrt;
+    double avg_packet_bytes;
+    size_t encoder_stack;
+    size_t decoder_stack;
+    size_t encoder_heap;
+    size_t decoder_heap;
+} bench_result_t;
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e6 + (double)ts.tv_nsec / 1e3;
+}
+
+static audio_codec_t* create_encoder(const bench_config_t* config, const audio_format_t* format, size_t* heap) {
+    size_t before = g_heap_current;
+    g_heap_peak = g_heap_current;
+
+    audio_codec_t* codec = opus_codec_create();
+    if (!codec || audio_codec_init_encoder(codec, format) != CODEC_SUCCESS) {
+        audio_codec_destroy(codec);
+        return NULL;
+    }
+    opus_codec_set_complexity(codec, config->complexity);
+    opus_codec_set_bitrate(codec, config->bitrate);
+    opus_codec_set_inband_fec(codec, config->fec ? 1 : 0);
+    opus_codec_set_packet_loss_perc(codec, config->fec ? 10 : 0);
+    opus_codec_set_dtx(codec, config->dtx ? 1 : 0);
+
+    *heap = g_heap_peak - before;
+    return codec;
+}
+
+static audio_codec_t* create_decoder(const audio_format_t* format, size_t* heap) {
+    size_t before = g_heap_current;
+    g_heap_peak = g_heap_current;
+
+    audio_codec_t* codec = opus_codec_create();
+    if (!codec || audio_codec_init_decoder(codec, format) != CODEC_SUCCESS) {
+        audio_codec_destroy(codec);
+        return NULL;
+    }
+
+    *heap = g_heap_peak - before;
+    return codec;
+}
+
+static bool run_config(const bench_config_t* config, const int16_t* signal, size_t signal_samples,
+                       bench_result_t* result) {
+    audio_format_t format;
+    audio_format_init(&format, BENCH_SAMPLE_RATE, BENCH_CHANNELS, 16, config->frame_ms);
+    size_t frame_samples = (size_t)(BENCH_SAMPLE_RATE * config->frame_ms / 1000) * BENCH_CHANNELS;
+    size_t frame_count = signal_samples / frame_samples;
+
+    memset(result, 0, sizeof(*result));
+    audio_codec_t* encoder = create_encoder(config, &format, &result->encoder_heap);
+    audio_codec_t* decoder = create_decoder(&format, &result->decoder_heap);
+    if (!encoder || !decoder || frame_count == 0) {
+        audio_codec_destroy(encoder);
+        audio_codec_destroy(decoder);
+        return false;
+    }
+
+    static uint8_t packet[BENCH_MAX_PACKET];
+    static int16_t pcm[BENCH_MAX_FRAME * BENCH_CHANNELS];
+    double encode_total = 0.0, decode_total = 0.0;
+    size_t bytes_total = 0;
+
+    for (size_t i = 0; i < frame_count; i++) {
+        const int16_t* input = signal + i * frame_samples;
+        size_t encoded = 0;
+        size_t decoded = 0;
+        bool measure_stack = (i == frame_count / 2);
+
+        // 取中间一帧测栈：此时编码器已处于稳态
+        if (measure_stack) stack_paint();
+        double start = now_us();
+        codec_error_t err = audio_codec_encode(encoder, input, frame_samples, packet, sizeof(packet), &encoded);
+        double encode_us = now_us() - start;
+        if (measure_stack) result->encoder_stack = stack_measure() - g_stack_base_depth;
+        if (err != CODEC_SUCCESS) {
+            continue;
+        }
+
+        if (measure_stack) stack_paint();
+        start = now_us();
+        // DTX 不发送的帧 (<= 2 字节) 按丢包补偿解码，与实际接收端一致
+        if (encoded > 2) {
+            err = audio_codec_decode(decoder, packet, encoded, pcm, sizeof(pcm) / sizeof(pcm[0]), &decoded);
+        } else {
+            err = audio_codec_decode_lost(decoder, NULL, 0, frame_samples, pcm,
+                                          sizeof(pcm) / sizeof(pcm[0]), &decoded);
+        }
+        double decode_us = now_us() - start;
+        if (measure_stack) result->decoder_stack = stack_measure() - g_stack_base_depth;
+        (void)err;
+
+        encode_total += encode_us;
+        decode_total += decode_us;
+        bytes_total += encoded;
+        if (encode_us > result->encode_max_us) result->encode_max_us = encode_us;
+        if (decode_us > result->decode_max_us) result->decode_max_us = decode_us;
+    }
+
+    double audio_us = (double)frame_count * config->frame_ms * 1000.0;
+    result->encode_avg_us = encode_total / frame_count;
+    result->decode_avg_us = decode_total / frame_count;
+    result->encode_xrt = encode_total > 0 ? audio_us / encode_total : 0.0;
+    result->decode_xrt = decode_total > 0 ? audio_us / decode_total : 0.0;
+    result->avg_packet_bytes = (double)bytes_total / frame_count;
+
+    audio_codec_destroy(encoder);
+    audio_codec_destroy(decoder);
+    return true;
+}
+
+static void format_heap(char* out, size_t size, size_t bytes) {
+#ifdef CODEC_BENCH_TRACK_HEAP
+    snprintf(out, size, "%zu", bytes);
+#else
+    (void)bytes;
+    snprintf(out, size, "-");
+#endif
+}
+
+static void print_result(const bench_config_t* config, const bench_result_t* result, bool csv) {
+    char enc_heap[16], dec_heap[16];
+    format_heap(enc_heap, sizeof(enc_heap), result->encoder_heap);
+    format_heap(dec_heap, sizeof(dec_heap), result->decoder_heap);
+
+    if (csv) {
+        printf("%s,%s,%d,%d,%d,%d,%d,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%zu,%zu,%s,%s\n",
+               CODEC_BENCH_TOOLCHAIN, BENCH_ARCH, config->complexity, config->bitrate, config->frame_ms,
+               config->fec, config->dtx,
+               result->encode_avg_us, result->encode_max_us, result->decode_avg_us, result->decode_max_us,
+               result->encode_xrt, result->decode_xrt, result->avg_packet_bytes,
+               result->encoder_stack, result->decoder_stack, enc_heap, dec_heap);
+    } else {
+        printf("%4d %6d %4d %3s %3s | %8.1f %8.1f %7.1f | %8.1f %8.1f %7.1f | %6.1f | %6zu %6zu | %7s %7s\n",
+               config->complexity, config->bitrate, config->frame_ms,
+               config->fec ? "on" : "off", config->dtx ? "on" : "off",
+               result->encode_avg_us, result->encode_max_us, result->encode_xrt,
+               result->decode_avg_us, result->decode_max_us, result->decode_xrt,
+               result->avg_packet_bytes, result->encoder_stack, result->decoder_stack, enc_heap, dec_heap);
+    }
+}
+
+static int codec_bench_run(int duration_s, bool quick, bool csv) {
+    static const int complexities_full[] = {0, 2, 5, 8, 10};
+    static const int complexities_quick[] = {0, 5, 10};
+    static const int bitrates_full[] = {8000, 16000, 24000, 32000};
+    static const int bitrates_quick[] = {16000};
+    static const int frame_sizes[] = {10, 20, 40, 60};
+    static const bool fec_dtx_full[][2] = {{false, false}, {true, false}, {false, true}};
+    static const bool fec_dtx_quick[][2] = {{false, false}};
+
+    const int* complexities = quick ? complexities_quick : complexities_full;
+    size_t complexity_count = quick ? 3 : 5;
+    const int* bitrates = quick ? bitrates_quick : bitrates_full;
+    size_t bitrate_count = quick ? 1 : 4;
+    const bool (*fec_dtx)[2] = quick ? fec_dtx_quick : fec_dtx_full;
+    size_t fec_dtx_count = quick ? 1 : 3;
+
+    size_t signal_samples = (size_t)duration_s * BENCH_SAMPLE_RATE * BENCH_CHANNELS;
+    int16_t* signal = (int16_t*)malloc(signal_samples * sizeof(int16_t));
+    if (!signal) {
+        printf("无法分配测试信号\n");
+        return 1;
+    }
+    generate_speech_like(signal, signal_samples);
+    stack_calibrate();
+
+    if (csv) {
+        printf("toolchain,arch,complexity,bitrate,frame_ms,fec,dtx,"
+               "enc_avg_us,enc_max_us,dec_avg_us,dec_max_us,enc_xrt,dec_xrt,avg_bytes,"
+               "enc_stack,dec_stack,enc_heap,dec_heap\n");
+    } else {
+        printf("Opus 基准: 工具链 %s (%s), %d Hz, 每组 %d 秒\n",
+               CODEC_BENCH_TOOLCHAIN, BENCH_ARCH, BENCH_SAMPLE_RATE, duration_s);
+        printf("cplx   rate   ms fec dtx |  enc_avg  enc_max enc_xRT |  dec_avg  dec_max dec_xRT | "
+               " bytes | stk_en stk_de | heap_en heap_de\n");
+    }
+
+    int failures = 0;
+    for (size_t c = 0; c < complexity_count; c++) {
+        for (size_t b = 0; b < bitrate_count; b++) {
+            for (size_t f = 0; f < sizeof(frame_sizes) / sizeof(frame_sizes[0]); f++) {
+                for (size_t m = 0; m < fec_dtx_count; m++) {
+                    bench_config_t config = {
+                        .complexity = complexities[c],
+                        .bitrate = bitrates[b],
+                        .frame_ms = frame_sizes[f],
+                        .fec = fec_dtx[m][0],
+                        .dtx = fec_dtx[m][1],
+                    };
+                    bench_result_t result;
+                    if (!run_config(&config, signal, signal_samples, &result)) {
+                        printf("配置失败: complexity=%d bitrate=%d frame=%dms\n",
+                               config.complexity, config.bitrate, config.frame_ms);
+                        failures++;
+                        continue;
+                    }
+                    print_result(&config, &result, csv);
+                }
+            }
+        }
+    }
+
+    free(signal);
+    return failures > 0 ? 1 : 0;
+}
+
+#ifdef ESP_PLATFORM
+void app_main(void) {
+    log_config_t log_config = LOG_DEFAULT_CONFIG;
+    log_config.level = LOG_LEVEL_WARN;
+    log_init(&log_config);
+    codec_bench_run(3, true, true);
+    log_cleanup();
+}
+#else
+int main(int argc, char* argv[]) {
+    int duration_s = 5;
+    bool quick = false;
+    bool csv = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+            duration_s = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-q") == 0) {
+            quick = true;
+        } else if (strcmp(argv[i], "--csv") == 0) {
+            csv = true;
+        } else {
+            printf("用法: %s [-d 每组秒数] [-q] [--csv]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (duration_s < 1) {
+        duration_s = 1;
+    }
+
+    // 编解码器的警告日志会打乱表格输出
+    log_config_t log_config = LOG_DEFAULT_CONFIG;
+    log_config.level = LOG_LEVEL_ERROR;
+    log_init(&log_config);
+
+    int ret = codec_bench_run(duration_s, quick, csv);
+
+    log_cleanup();
+    return ret;
+}
+#endif
@@ -1,6 +1,9 @@
 #include "audio_codec.h"
 #include "opus_codec.h"
 #include "codec_stub.h"
+#include "codec_factory.h"
+#include "adpcm_codec.h"
+#include "pcm_codec.h"
 #include "../log/linx_log.h"
 #include <stdio.h>
 #include <stdlib.h>
@@ -236,6 +239,250 @@ int test_opus_codec_parameters(void) {
     return 0;
 }
 
+// 测试创建选项和构建档位默认值
+int test_opus_codec_options(void) {
+    printf("Testing Opus codec options (%s profile)...\n", opus_codec_build_profile());
+    
+    opus_codec_options_t defaults = opus_codec_default_options();
+    assert(defaults.complexity >= 1 && defaults.complexity <= 10);
+    assert(defaults.frame_size_ms > 0);
+    
+    // 未指定的选项取档位默认值
+    opus_codec_options_t options;
+    memset(&options, 0, sizeof(options));
+    options.frame_size_ms = 40;
+    audio_codec_t* codec = opus_codec_create_with_options(&options);
+    assert(codec != NULL);
+    assert(opus_codec_get_complexity(codec) == defaults.complexity);
+    
+    // format.frame_size_ms 为 0 时使用选项中的帧长
+    audio_format_t format;
+    audio_format_init(&format, SAMPLE_RATE, CHANNELS, 16, 0);
+    assert(audio_codec_init_encoder(codec, &format) == CODEC_SUCCESS);
+    assert(audio_codec_get_input_frame_size(codec) == SAMPLE_RATE * 40 / 1000);
+    audio_codec_destroy(codec);
+    
+    options.complexity = 2;
+    options.bitrate = 24000;
+    codec = opus_codec_create_with_options(&options);
+    assert(codec != NULL);
+    assert(opus_codec_get_complexity(codec) == 2);
+    assert(opus_codec_get_bitrate(codec) == 24000);
+    audio_codec_destroy(codec);
+    
+    // 越界选项
+    options.complexity = 11;
+    assert(opus_codec_create_with_options(&options) == NULL);
+    
+    printf("Opus codec options test passed!\n\n");
+    return 0;
+}
+
+// 测试轻量编解码器 (PCM16 / G.711 / IMA-ADPCM) 编解码往返
+int test_lightweight_codecs(void) {
+    printf("Testing lightweight codecs...\n");
+    
+    static const struct {
+        const char* format;
+        size_t packet_bytes;    // 每帧编码后的字节数
+        double min_snr_db;      // 最低信噪比
+    } cases[] = {
+        { "pcm",   FRAME_SIZE * 2,                        90.0 },
+        { "pcmu",  FRAME_SIZE,                            30.0 },
+        { "PCMA",  FRAME_SIZE,                            30.0 },
+        { "adpcm", ADPCM_PACKET_BYTES(FRAME_SIZE, 1),     20.0 },
+    };
+    
+    audio_format_t format;
+    audio_format_init(&format, SAMPLE_RATE, CHANNELS, 16, FRAME_SIZE_MS);
+    
+    int16_t input[FRAME_SIZE];
+    int16_t decoded[FRAME_SIZE];
+    uint8_t packet[MAX_PACKET_SIZE];
+    
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        audio_codec_t* encoder = codec_factory_create_for_format(cases[c].format);
+        audio_codec_t* decoder = codec_factory_create_for_format(cases[c].format);
+        assert(encoder != NULL && decoder != NULL);
+        assert(audio_codec_init_encoder(encoder, &format) == CODEC_SUCCESS);
+        assert(audio_codec_init_decoder(decoder, &format) == CODEC_SUCCESS);
+        
+        double signal = 0.0;
+        double noise = 0.0;
+        for (int frame = 0; frame < 10; frame++) {
+            generate_test_audio(input, FRAME_SIZE, 440.0 + frame * 50.0);
+            
+            size_t encoded_size = 0;
+            size_t decoded_size = 0;
+            assert(audio_codec_encode(encoder, input, FRAME_SIZE, packet, sizeof(packet),
+                                      &encoded_size) == CODEC_SUCCESS);
+            assert(encoded_size == cases[c].packet_bytes);
+            assert(audio_codec_decode(decoder, packet, encoded_size, decoded, FRAME_SIZE,
+                                      &decoded_size) == CODEC_SUCCESS);
+            assert(decoded_size == FRAME_SIZE);
+            
+            for (size_t i = 0; i < FRAME_SIZE; i++) {
+                double diff = (double)input[i] - (double)decoded[i];
+                signal += (double)input[i] * (double)input[i];
+                noise += diff * diff;
+            }
+        }
+        
+        double snr_db = noise > 0.0 ? 10.0 * log10(signal / noise) : 120.0;
+        printf("%s (%s): %zu bytes/frame, SNR %.1f dB\n", cases[c].format,
+               audio_codec_get_name(encoder), cases[c].packet_bytes, snr_db);
+        assert(snr_db >= cases[c].min_snr_db);
+        
+        codec_factory_destroy(encoder);
+        codec_factory_destroy(decoder);
+    }
+    
+    // 格式名解析
+    codec_type_t type;
+    assert(codec_factory_parse_format("G711U", &type) && type == CODEC_TYPE_PCMU);
+    assert(!codec_factory_parse_format("mp3", &type));
+    assert(codec_factory_create_for_format("mp3") == NULL);
+    assert(strcmp(codec_factory_format_name(CODEC_TYPE_ADPCM), "adpcm") == 0);
+    
+    printf("Lightweight codec test passed!\n\n");
+    return 0;
+}
+
+static int registry_creates = 0;
+
+// 测试注册用的编解码器：PCM 直通，统计创建次数
+static audio_codec_t* create_counted_pcm(void) {
+    registry_creates++;
+    return pcm_codec_create();
+}
+
+// 测试编解码器注册表：描述符、注册与替换、按算力生成候选格式
+int test_codec_registry(void) {
+    printf("Testing codec registry...\n");
+    
+    const codec_descriptor_t* opus = codec_factory_get_descriptor(CODEC_TYPE_OPUS);
+    assert(opus != NULL && strcmp(opus->name, "opus") == 0 && opus->cost == CODEC_COST_HIGH);
+    assert(codec_factory_supports(opus, 16000, 20));
+    assert(!codec_factory_supports(opus, 22050, 20));
+    assert(codec_factory_supports(codec_factory_get_descriptor(CODEC_TYPE_PCM), 22050, 0));
+    assert(codec_factory_get_descriptor(CODEC_TYPE_COUNT) == NULL);
+    
+    // 按压缩率排序，首选格式在最前；算力上限排除 Opus
+    char offer[64];
+    assert(codec_factory_build_offer(NULL, 0, SAMPLE_RATE, FRAME_SIZE_MS, 0, offer, sizeof(offer)) == 5);
+    assert(strcmp(offer, "opus,adpcm,pcmu,pcma,pcm") == 0);
+    assert(codec_factory_build_offer("pcma", CODEC_COST_LOW, SAMPLE_RATE, FRAME_SIZE_MS, 3, offer, sizeof(offer)) == 3);
+    assert(strcmp(offer, "pcma,adpcm,pcmu") == 0);
+    assert(codec_factory_build_offer(NULL, 0, 22050, FRAME_SIZE_MS, 1, offer, sizeof(offer)) == 1);
+    assert(strcmp(offer, "adpcm") == 0);
+    
+    // 注册新格式
+    codec_descriptor_t descriptor = {
+        .name = "l16",
+        .aliases = { "linear16" },
+        .cost = CODEC_COST_TRIVIAL,
+        .bits_per_sample = 16,
+        .sample_rates = { 16000 },
+        .create = create_counted_pcm,
+    };
+    codec_type_t type;
+    assert(codec_factory_register(&descriptor, &type) == CODEC_SUCCESS);
+    assert(type >= CODEC_TYPE_COUNT);
+    codec_type_t parsed;
+    assert(codec_factory_parse_format("LINEAR16", &parsed) && parsed == type);
+    assert(strcmp(codec_factory_format_name(type), "l16") == 0);
+    audio_codec_t* codec = codec_factory_create_for_format("l16");
+    assert(codec != NULL && registry_creates == 1);
+    codec_factory_destroy(codec);
+    // 同位数时注册的排在内置的前面
+    assert(codec_factory_build_offer(NULL, CODEC_COST_TRIVIAL, SAMPLE_RATE, 0, 0, offer, sizeof(offer)) == 4);
+    assert(strcmp(offer, "pcmu,pcma,l16,pcm") == 0);
+    
+    // 替换内置格式：按格式名和按类型创建的都是注册的实现
+    descriptor.name = "pcm";
+    descriptor.aliases[0] = NULL;
+    codec_type_t override_type;
+    assert(codec_factory_register(&descriptor, &override_type) == CODEC_SUCCESS && override_type != type);
+    codec = codec_factory_create(CODEC_TYPE_PCM);
+    assert(codec != NULL && registry_creates == 2);
+    codec_factory_destroy(codec);
+    codec = codec_factory_create_for_format("pcm");
+    assert(codec != NULL && registry_creates == 3);
+    codec_factory_destroy(codec);
+    assert(codec_factory_build_offer(NULL, CODEC_COST_TRIVIAL, SAMPLE_RATE, 0, 0, offer, sizeof(offer)) == 4);
+    
+    // 再次注册同名的替换之前的注册
+    assert(codec_factory_register(&descriptor, &parsed) == CODEC_SUCCESS && parsed == override_type);
+    descriptor.name = NULL;
+    assert(codec_factory_register(&descriptor, NULL) == CODEC_INVALID_PARAMETER);
+    
+    printf("Codec registry test passed!\n\n");
+    return 0;
+}
+
+// 测试编解码器状态池：销毁和切换格式时状态放回池中，同格式再次初始化只复位
+int test_opus_state_pool(void) {
+    printf("Testing Opus state pool...\n");
+    
+    opus_codec_pool_clear();
+    opus_codec_pool_stats_t before;
+    opus_codec_pool_stats_t stats;
+    opus_codec_pool_get_stats(&before);
+    assert(before.pooled == 0);
+    
+    audio_format_t wide;
+    audio_format_t super_wide;
+    audio_format_init(&wide, SAMPLE_RATE, CHANNELS, 16, FRAME_SIZE_MS);
+    audio_format_init(&super_wide, 24000, CHANNELS, 16, FRAME_SIZE_MS);
+    
+    // 第一个解码器分配状态，销毁后放回池中
+    audio_codec_t* decoder = opus_codec_create();
+    assert(audio_codec_init_decoder(decoder, &wide) == CODEC_SUCCESS);
+    audio_codec_destroy(decoder);
+    opus_codec_pool_get_stats(&stats);
+    assert(stats.allocs == before.allocs + 1 && stats.pooled == 1);
+    
+    // 同格式的新解码器只复位池中的状态
+    decoder = opus_codec_create();
+    assert(audio_codec_init_decoder(decoder, &wide) == CODEC_SUCCESS);
+    opus_codec_pool_get_stats(&stats);
+    assert(stats.hits == before.hits + 1 && stats.pooled == 0);
+    
+    // 切到 24kHz 时分配新状态，16kHz 的状态放回池中；切回 16kHz 只复位
+    assert(audio_codec_init_decoder(decoder, &super_wide) == CODEC_SUCCESS);
+    opus_codec_pool_get_stats(&stats);
+    assert(stats.allocs == before.allocs + 2 && stats.pooled == 1);
+    assert(audio_codec_init_decoder(decoder, &wide) == CODEC_SUCCESS);
+    opus_codec_pool_get_stats(&stats);
+    assert(stats.hits == before.hits + 2 && stats.allocs == before.allocs + 2 && stats.pooled == 1);
+    
+    // 预先初始化的编码器状态同样只复位，取出的状态编解码正常
+    assert(opus_codec_pool_prepare(&wide, 1, 0) == CODEC_SUCCESS);
+    audio_codec_t* encoder = opus_codec_create();
+    assert(audio_codec_init_encoder(encoder, &wide) == CODEC_SUCCESS);
+    opus_codec_pool_get_stats(&stats);
+    assert(stats.hits == before.hits + 3 && stats.allocs == before.allocs + 3);
+    
+    int16_t input[FRAME_SIZE];
+    int16_t output[FRAME_SIZE];
+    uint8_t packet[MAX_PACKET_SIZE];
+    size_t encoded_size = 0;
+    size_t decoded_size = 0;
+    generate_test_audio(input, FRAME_SIZE, 440.0);
+    assert(audio_codec_encode(encoder, input, FRAME_SIZE, packet, sizeof(packet), &encoded_size) == CODEC_SUCCESS);
+    assert(audio_codec_decode(decoder, packet, encoded_size, output, FRAME_SIZE, &decoded_size) == CODEC_SUCCESS);
+    assert(decoded_size == FRAME_SIZE);
+    
+    audio_codec_destroy(encoder);
+    audio_codec_destroy(decoder);
+    opus_codec_pool_clear();
+    opus_codec_pool_get_stats(&stats);
+    assert(stats.pooled == 0);
+    
+    printf("Opus state pool test passed!\n\n");
+    return 0;
+}
+
 // 测试错误处理
 int test_error_handling(void) {
     printf("Testing error handling...\n");
@@ -272,6 +519,10 @@ int main(void) {
     if (test_opus_codec_basic() != 0) return 1;
     if (test_opus_codec_encode_decode() != 0) return 1;
     if (test_opus_codec_parameters() != 0) return 1;
+    if (test_opus_codec_options() != 0) return 1;
+    if (test_lightweight_codecs() != 0) return 1;
+    if (test_codec_registry() != 0) return 1;
+    if (test_opus_state_pool() != 0) return 1;
     if (test_error_handling() != 0) return 1;
     
     printf("All tests passed successfully!\n");
@@ -0,0 +1,278 @@
+/**
+ * @file linx_assets.c
+ * @brief 只读资源包实现
+ */
+
+#include "linx_assets.h"
+#include "log/linx_alloc.h"
+#include "log/linx_log.h"
+#include <string.h>
+
+#if defined(ESP_PLATFORM)
+#include "esp_partition.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_CORE);
+
+struct linx_assets {
+    const uint8_t* base;
+    size_t size;
+    const linx_assets_entry_t* entries;
+    size_t count;
+    const char* names;
+    size_t names_size;
+#if defined(ESP_PLATFORM)
+    esp_partition_mmap_handle_t mmap_handle;
+    bool mapped;
+#else
+    void* mapping;                  // mmap 的起始地址，内存资源包为 NULL
+#endif
+};
+
+static uint32_t assets_crc32(const void* data, size_t length) {
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+    };
+    const uint8_t* p = (const uint8_t*)data;
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; i++) {
+        crc = table[(crc ^ p[i]) & 0x0F] ^ (crc >> 4);
+        crc = table[(crc ^ (p[i] >> 4)) & 0x0F] ^ (crc >> 4);
+    }
+    return ~crc;
+}
+
+static uint32_t assets_name_hash(const char* name) {
+    uint32_t hash = 2166136261u;
+    for (const uint8_t* p = (const uint8_t*)name; *p; p++) {
+        hash ^= *p;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/* 校验文件头、索引和名称表，成功时填写 assets 的视图字段 */
+static bool assets_parse(linx_assets_t* assets, const uint8_t* base, size_t size) {
+    if (size < sizeof(linx_assets_header_t)) {
+        return false;
+    }
+    linx_assets_header_t header;
+    memcpy(&header, base, sizeof(header));
+    if (memcmp(header.magic, LINX_ASSETS_MAGIC, 4) != 0 || header.version != LINX_ASSETS_VERSION) {
+        LOG_WARN("资源包格式不支持");
+        return false;
+    }
+    size_t index_bytes = (size_t)header.entry_count * sizeof(linx_assets_entry_t);
+    if (header.total_size > size || header.alignment == 0 || (header.alignment & (header.alignment - 1)) != 0 ||
+        (header.index_offset & 3) != 0 || header.index_offset > header.total_size ||
+        index_bytes > header.total_size - header.index_offset ||
+        header.names_offset != header.index_offset + index_bytes ||
+        header.names_size > header.total_size - header.names_offset ||
+        (header.names_size > 0 && base[header.names_offset + header.names_size - 1] != '\0')) {
+        LOG_WARN("资源包索引越界");
+        return false;
+    }
+    if (assets_crc32(base + header.index_offset, index_bytes + header.names_size) != header.index_crc) {
+        LOG_WARN("资源包索引损坏");
+        return false;
+    }
+
+    const linx_assets_entry_t* entries = (const linx_assets_entry_t*)(base + header.index_offset);
+    for (size_t i = 0; i < header.entry_count; i++) {
+        const linx_assets_entry_t* entry = &entries[i];
+        if (entry->name_offset >= header.names_size || entry->offset > header.total_size ||
+            entry->size > header.total_size - entry->offset || (entry->offset & (header.alignment - 1)) != 0) {
+            LOG_WARN("资源包第 %zu 项越界", i);
+            return false;
+        }
+    }
+
+    assets->base = base;
+    assets->size = header.total_size;
+    assets->entries = entries;
+    assets->count = header.entry_count;
+    assets->names = (const char*)(base + header.names_offset);
+    assets->names_size = header.names_size;
+    return true;
+}
+
+static void assets_fill(const linx_assets_t* assets, const linx_assets_entry_t* entry, linx_asset_t* asset) {
+    asset->name = assets->names + entry->name_offset;
+    asset->type = (linx_asset_type_t)entry->type;
+    asset->data = assets->base + entry->offset;
+    asset->size = entry->size;
+}
+
+linx_assets_t* linx_assets_open_memory(const void* data, size_t size) {
+    if (!data) {
+        return NULL;
+    }
+    linx_assets_t* assets = (linx_assets_t*)LINX_CALLOC(1, sizeof(linx_assets_t));
+    if (!assets) {
+        return NULL;
+    }
+    if (!assets_parse(assets, (const uint8_t*)data, size)) {
+        LINX_FREE(assets);
+        return NULL;
+    }
+    return assets;
+}
+
+#if defined(ESP_PLATFORM)
+linx_assets_t* linx_assets_open_file(const char* path) {
+    LOG_WARN("ESP32 上资源包应烧写到数据分区，用 linx_assets_open_partition() 打开: %s", path ? path : "");
+    return NULL;
+}
+
+linx_assets_t* linx_assets_open_partition(const char* label) {
+    if (!label) {
+        return NULL;
+    }
+    const esp_partition_t* partition =
+        esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+    if (!partition) {
+        LOG_ERROR("找不到资源分区: %s", label);
+        return NULL;
+    }
+
+    // 先读文件头，只映射资源包实际占用的部分
+    linx_assets_header_t header;
+    if (esp_partition_read(partition, 0, &header, sizeof(header)) != ESP_OK ||
+        memcmp(header.magic, LINX_ASSETS_MAGIC, 4) != 0 || header.total_size > partition->size) {
+        LOG_ERROR("资源分区 %s 中没有有效的资源包", label);
+        return NULL;
+    }
+
+    linx_assets_t* assets = (linx_assets_t*)LINX_CALLOC(1, sizeof(linx_assets_t));
+    if (!assets) {
+        return NULL;
+    }
+    const void* mapping = NULL;
+    if (esp_partition_mmap(partition, 0, header.total_size, ESP_PARTITION_MMAP_DATA, &mapping,
+                           &assets->mmap_handle) != ESP_OK) {
+        LOG_ERROR("资源分区 %s 映射失败", label);
+        LINX_FREE(assets);
+        return NULL;
+    }
+    assets->mapped = true;
+    if (!assets_parse(assets, (const uint8_t*)mapping, header.total_size)) {
+        linx_assets_close(assets);
+        return NULL;
+    }
+    LOG_INFO("资源分区 %s 已映射：%zu 项，%zu 字节", label, assets->count, assets->size);
+    return assets;
+}
+#else
+linx_assets_t* linx_assets_open_file(const char* path) {
+    if (!path) {
+        return NULL;
+    }
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        LOG_WARN("资源包打开失败: %s", path);
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return NULL;
+    }
+    // 只读映射，页面在首次访问时才换入；映射在关闭描述符后仍有效
+    void* mapping = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        LOG_WARN("资源包映射失败: %s", path);
+        return NULL;
+    }
+
+    linx_assets_t* assets = (linx_assets_t*)LINX_CALLOC(1, sizeof(linx_assets_t));
+    if (!assets) {
+        munmap(mapping, (size_t)st.st_size);
+        return NULL;
+    }
+    if (!assets_parse(assets, (const uint8_t*)mapping, (size_t)st.st_size)) {
+        munmap(mapping, (size_t)st.st_size);
+        LINX_FREE(assets);
+        return NULL;
+    }
+    assets->mapping = mapping;
+    assets->size = (size_t)st.st_size;
+    LOG_INFO("资源包 %s 已映射：%zu 项，%zu 字节", path, assets->count, assets->size);
+    return assets;
+}
+#endif
+
+void linx_assets_close(linx_assets_t* assets) {
+    if (!assets) {
+        return;
+    }
+#if defined(ESP_PLATFORM)
+    if (assets->mapped) {
+        esp_partition_munmap(assets->mmap_handle);
+    }
+#else
+    if (assets->mapping) {
+        munmap(assets->mapping, assets->size);
+    }
+#endif
+    LINX_FREE(assets);
+}
+
+size_t linx_assets_count(const linx_assets_t* assets) {
+    return assets ? assets->count : 0;
+}
+
+bool linx_assets_get(const linx_assets_t* assets, size_t index, linx_asset_t* asset) {
+    if (!assets || !asset || index >= assets->count) {
+        return false;
+    }
+    assets_fill(assets, &assets->entries[index], asset);
+    return true;
+}
+
+bool linx_assets_find(const linx_assets_t* assets, const char* name, linx_asset_t* asset) {
+    if (!assets || !name || !asset) {
+        return false;
+    }
+    uint32_t hash = assets_name_hash(name);
+
+    // 找到第一个哈希不小于 hash 的项，再在哈希相同的项中比较名称
+    size_t low = 0;
+    size_t high = assets->count;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (assets->entries[mid].name_hash < hash) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    for (size_t i = low; i < assets->count && assets->entries[i].name_hash == hash; i++) {
+        if (strcmp(assets->names + assets->entries[i].name_offset, name) == 0) {
+            assets_fill(assets, &assets->entries[i], asset);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool linx_assets_verify(const linx_assets_t* assets) {
+    if (!assets) {
+        return false;
+    }
+    bool ok = true;
+    for (size_t i = 0; i < assets->count; i++) {
+        const linx_assets_entry_t* entry = &assets->entries[i];
+        if (assets_crc32(assets->base + entry->offset, entry->size) != entry->crc) {
+            LOG_ERROR("资源 %s 数据损坏", assets->names + entry->name_offset);
+            ok = false;
+        }
+    }
+    return ok;
+}
@@ -0,0 +1,140 @@
+/**
+ * @file linx_assets.h
+ * @brief 只读资源包（提示音、字体、表情动画）
+ *
+ * 提示音、LVGL 字体和表情精灵条打成一个带索引的资源包，由主机工具
+ * sdk/tools/linx_assets_pack.py 生成。运行时整包映射为只读内存：
+ *
+ * - Linux 等 POSIX 目标：linx_assets_open_file() 用 mmap 映射，页面在首次访问时才换入
+ * - ESP32：资源包烧写到一个数据分区，linx_assets_open_partition() 用 esp_partition_mmap()
+ *   映射到 flash 缓存地址空间
+ * - 链接进固件的数组：linx_assets_open_memory()
+ *
+ * 资源原地使用，不拷贝到堆、不做打开时解码：linx_sound_bank_add_assets() 登记提示音，
+ * linx_emotion_cache_add_assets() 登记表情动画，字体等其他资源用 linx_assets_find()
+ * 取得指针（TTF 字体可交给 lv_tiny_ttf_create_data() 原地使用）。
+ * 资源包必须比使用其中资源的对象活得久。
+ *
+ * 文件格式（小端）：
+ *   linx_assets_header_t
+ *   索引：entry_count 个 linx_assets_entry_t，按 (name_hash, 名称) 排序
+ *   名称表：以 '\0' 结尾的名称依次排列
+ *   数据：每项按 alignment 对齐（相对资源包起始），填充为 0
+ *
+ * 打开时只校验文件头、索引和名称表；各项数据的 CRC 用 linx_assets_verify() 按需检查。
+ * 打开后只读，线程安全。
+ */
+
+#ifndef LINX_ASSETS_H
+#define LINX_ASSETS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LINX_ASSETS_MAGIC           "LXAB"
+#define LINX_ASSETS_VERSION         1
+
+/* 资源类型 */
+typedef enum {
+    LINX_ASSET_RAW = 0,             // 未指定
+    LINX_ASSET_SOUND_PCM16,         // 提示音：交错的 16 位 PCM（见 LINX_SOUND_PCM16）
+    LINX_ASSET_SOUND_PACKETS,       // 提示音：2 字节大端长度前缀的编码包（见 LINX_SOUND_PACKETS）
+    LINX_ASSET_EMOTION,             // 表情动画（linx_emotion.h 的资源文件格式）
+    LINX_ASSET_FONT,                // 字体（TTF 或 LVGL 二进制字体）
+    LINX_ASSET_IMAGE                // 其他图像
+} linx_asset_type_t;
+
+/**
+ * 资源包文件头（32 字节）
+ */
+typedef struct {
+    char magic[4];                  // LINX_ASSETS_MAGIC
+    uint16_t version;               // LINX_ASSETS_VERSION
+    uint16_t alignment;             // 数据对齐（2 的幂）
+    uint32_t entry_count;
+    uint32_t index_offset;          // 索引偏移
+    uint32_t names_offset;          // 名称表偏移
+    uint32_t names_size;            // 名称表字节数
+    uint32_t total_size;            // 资源包总字节数
+    uint32_t index_crc;             // 索引和名称表的 CRC32
+} linx_assets_header_t;
+
+/**
+ * 索引项（24 字节）
+ */
+typedef struct {
+    uint32_t name_hash;             // 名称的 FNV-1a 哈希
+    uint32_t name_offset;           // 名称在名称表中的偏移
+    uint32_t offset;                // 数据偏移（相对资源包起始）
+    uint32_t size;                  // 数据字节数
+    uint16_t type;                  // linx_asset_type_t
+    uint16_t reserved;
+    uint32_t crc;                   // 数据的 CRC32
+} linx_assets_entry_t;
+
+/* 一项资源；指针指向映射区，资源包关闭后失效 */
+typedef struct {
+    const char* name;
+    linx_asset_type_t type;
+    const void* data;
+    size_t size;
+} linx_asset_t;
+
+typedef struct linx_assets linx_assets_t;
+
+/**
+ * 打开内存中的资源包（数据须在资源包关闭前一直有效，不复制）
+ * @return 资源包，格式无效返回 NULL
+ */
+linx_assets_t* linx_assets_open_memory(const void* data, size_t size);
+
+/**
+ * 以只读方式 mmap 一个资源包文件
+ */
+linx_assets_t* linx_assets_open_file(const char* path);
+
+#if defined(ESP_PLATFORM)
+/**
+ * 用 esp_partition_mmap() 映射一个数据分区中的资源包
+ * @param label 分区名
+ */
+linx_assets_t* linx_assets_open_partition(const char* label);
+#endif
+
+/**
+ * 关闭资源包并解除映射
+ */
+void linx_assets_close(linx_assets_t* assets);
+
+/**
+ * 资源数
+ */
+size_t linx_assets_count(const linx_assets_t* assets);
+
+/**
+ * 按序号获取资源（0 ~ count-1，按索引顺序）
+ */
+bool linx_assets_get(const linx_assets_t* assets, size_t index, linx_asset_t* asset);
+
+/**
+ * 按名称查找资源（二分查找索引）
+ * @return 找到返回 true
+ */
+bool linx_assets_find(const linx_assets_t* assets, const char* name, linx_asset_t* asset);
+
+/**
+ * 检查所有数据的 CRC（会读完整个资源包，只在升级或诊断时调用）
+ * @return 全部一致返回 true
+ */
+bool linx_assets_verify(const linx_assets_t* assets);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINX_ASSETS_H */
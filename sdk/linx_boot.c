@@ -0,0 +1,256 @@
+/**
+ * @file linx_boot.c
+ * @brief 启动耗时剖析实现
+ */
+
+#include "linx_boot.h"
+#include "linx_metrics.h"
+#include "log/linx_alloc.h"
+#include "log/linx_log.h"
+#include "cjson/linx_json_writer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__APPLE__)
+#include <sys/sysctl.h>
+#include <sys/time.h>
+#endif
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_CORE);
+
+static const char* const s_phase_names[LINX_BOOT_PHASE_COUNT] = {
+    [LINX_BOOT_SDK_CREATED] = "sdk_created",
+    [LINX_BOOT_CONNECT_START] = "connect_start",
+    [LINX_BOOT_WS_CONNECTED] = "ws_connected",
+    [LINX_BOOT_SESSION_READY] = "session_ready",
+    [LINX_BOOT_LISTEN_READY] = "listen_ready",
+    [LINX_BOOT_AUDIO_READY] = "audio_ready",
+    [LINX_BOOT_CODEC_READY] = "codec_ready",
+    [LINX_BOOT_PLAYER_READY] = "player_ready",
+    [LINX_BOOT_FIRST_TURN_DONE] = "first_turn_done",
+    [LINX_BOOT_DEFERRED_READY] = "deferred_ready",
+};
+
+/* 均为 CLOCK_MONOTONIC 微秒，0 表示未记录 */
+static uint64_t s_origin_us;
+static uint64_t s_phase_us[LINX_BOOT_PHASE_COUNT];
+static int s_origin_is_process;
+
+/* 进程已运行的微秒数，无法获取返回 -1 */
+static int64_t process_age_us(void) {
+#if defined(__linux__)
+    /* /proc/self/stat 第 22 个字段是以时钟节拍计的、自系统启动起的进程启动时刻 */
+    FILE* fp = fopen("/proc/self/stat", "r");
+    if (!fp) {
+        return -1;
+    }
+    char buf[1024];
+    size_t len = fread(buf, 1, sizeof(buf) - 1, fp);
+    fclose(fp);
+    buf[len] = '\0';
+
+    /* comm 字段可能含空格和括号，从最后一个 ')' 之后开始数 */
+    char* p = strrchr(buf, ')');
+    if (!p) {
+        return -1;
+    }
+    unsigned long long start_ticks = 0;
+    int field = 2;
+    for (p++; *p && field < 22; p++) {
+        if (*p == ' ') {
+            field++;
+        }
+    }
+    if (field != 22 || sscanf(p, "%llu", &start_ticks) != 1) {
+        return -1;
+    }
+    long hz = sysconf(_SC_CLK_TCK);
+    struct timespec ts;
+    if (hz <= 0 || clock_gettime(CLOCK_BOOTTIME, &ts) != 0) {
+        return -1;
+    }
+    int64_t now_us = (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+    int64_t start_us = (int64_t)(start_ticks * 1000000ULL / (unsigned long long)hz);
+    return now_us >= start_us ? now_us - start_us : -1;
+#elif defined(__APPLE__)
+    int mib[4] = {CTL_KERN, KERN_PROC, KERN_PROC_PID, (int)getpid()};
+    struct kinfo_proc info;
+    size_t size = sizeof(info);
+    if (sysctl(mib, 4, &info, &size, NULL, 0) != 0 || size == 0) {
+        return -1;
+    }
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    const struct timeval* start = &info.kp_proc.p_starttime;
+    int64_t age = ((int64_t)now.tv_sec - start->tv_sec) * 1000000 + (now.tv_usec - start->tv_usec);
+    return age >= 0 ? age : -1;
+#else
+    return -1;
+#endif
+}
+
+static uint64_t ensure_origin(void) {
+    uint64_t origin = __atomic_load_n(&s_origin_us, __ATOMIC_ACQUIRE);
+    if (origin) {
+        return origin;
+    }
+
+    uint64_t now = linx_metrics_now_us();
+    int64_t age = process_age_us();
+    int is_process = age >= 0 && (uint64_t)age < now;
+    uint64_t candidate = is_process ? now - (uint64_t)age : now;
+    if (candidate == 0) {
+        candidate = 1;
+    }
+
+    if (__atomic_compare_exchange_n(&s_origin_us, &origin, candidate, false, __ATOMIC_ACQ_REL,
+                                    __ATOMIC_ACQUIRE)) {
+        __atomic_store_n(&s_origin_is_process, is_process, __ATOMIC_RELEASE);
+        return candidate;
+    }
+    return origin;
+}
+
+void linx_boot_begin(void) {
+    ensure_origin();
+}
+
+void linx_boot_mark(linx_boot_phase_t phase) {
+    if ((unsigned)phase >= LINX_BOOT_PHASE_COUNT) {
+        return;
+    }
+    ensure_origin();
+    if (__atomic_load_n(&s_phase_us[phase], __ATOMIC_RELAXED)) {
+        return;
+    }
+    uint64_t expected = 0;
+    __atomic_compare_exchange_n(&s_phase_us[phase], &expected, linx_metrics_now_us(), false, __ATOMIC_RELEASE,
+                                __ATOMIC_RELAXED);
+}
+
+int64_t linx_boot_elapsed_us(linx_boot_phase_t phase) {
+    if ((unsigned)phase >= LINX_BOOT_PHASE_COUNT) {
+        return -1;
+    }
+    uint64_t at = __atomic_load_n(&s_phase_us[phase], __ATOMIC_ACQUIRE);
+    uint64_t origin = __atomic_load_n(&s_origin_us, __ATOMIC_ACQUIRE);
+    if (!at || !origin) {
+        return -1;
+    }
+    return at > origin ? (int64_t)(at - origin) : 0;
+}
+
+int64_t linx_boot_ready_to_listen_us(void) {
+    static const linx_boot_phase_t app_phases[] = {
+        LINX_BOOT_AUDIO_READY,
+        LINX_BOOT_CODEC_READY,
+        LINX_BOOT_PLAYER_READY,
+    };
+
+    int64_t ready = linx_boot_elapsed_us(LINX_BOOT_LISTEN_READY);
+    if (ready < 0) {
+        return -1;
+    }
+    for (size_t i = 0; i < sizeof(app_phases) / sizeof(app_phases[0]); i++) {
+        int64_t at = linx_boot_elapsed_us(app_phases[i]);
+        if (at > ready) {
+            ready = at;
+        }
+    }
+    return ready;
+}
+
+bool linx_boot_origin_is_process_start(void) {
+    ensure_origin();
+    return __atomic_load_n(&s_origin_is_process, __ATOMIC_ACQUIRE) != 0;
+}
+
+const char* linx_boot_phase_name(linx_boot_phase_t phase) {
+    if ((unsigned)phase >= LINX_BOOT_PHASE_COUNT) {
+        return "unknown";
+    }
+    return s_phase_names[phase];
+}
+
+void linx_boot_reset(void) {
+    for (size_t i = 0; i < LINX_BOOT_PHASE_COUNT; i++) {
+        __atomic_store_n(&s_phase_us[i], 0, __ATOMIC_RELAXED);
+    }
+    /* 重置后以当前时刻为原点，不再回溯到进程启动 */
+    __atomic_store_n(&s_origin_is_process, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&s_origin_us, linx_metrics_now_us(), __ATOMIC_RELEASE);
+}
+
+/* 已到达的阶段按到达时刻排序 */
+static size_t sorted_phases(linx_boot_phase_t* phases, int64_t* elapsed) {
+    size_t count = 0;
+    for (int i = 0; i < LINX_BOOT_PHASE_COUNT; i++) {
+        int64_t at = linx_boot_elapsed_us((linx_boot_phase_t)i);
+        if (at < 0) {
+            continue;
+        }
+        size_t j = count++;
+        while (j > 0 && elapsed[j - 1] > at) {
+            phases[j] = phases[j - 1];
+            elapsed[j] = elapsed[j - 1];
+            j--;
+        }
+        phases[j] = (linx_boot_phase_t)i;
+        elapsed[j] = at;
+    }
+    return count;
+}
+
+void linx_boot_dump(void) {
+    linx_boot_phase_t phases[LINX_BOOT_PHASE_COUNT];
+    int64_t elapsed[LINX_BOOT_PHASE_COUNT];
+    size_t count = sorted_phases(phases, elapsed);
+    bool from_process = linx_boot_origin_is_process_start();
+
+    LOG_INFO("启动耗时 (原点: %s)", from_process ? "进程启动" : "首次记录");
+    int64_t prev = 0;
+    for (size_t i = 0; i < count; i++) {
+        LOG_INFO("  %-16s %8.1f ms  (+%.1f ms)", linx_boot_phase_name(phases[i]), elapsed[i] / 1000.0,
+                  (elapsed[i] - prev) / 1000.0);
+        prev = elapsed[i];
+    }
+    int64_t ready = linx_boot_ready_to_listen_us();
+    if (ready >= 0) {
+        LOG_INFO("  ready_to_listen  %8.1f ms", ready / 1000.0);
+    } else {
+        LOG_INFO("  ready_to_listen  (尚未开始监听)");
+    }
+}
+
+char* linx_boot_to_json(void) {
+    linx_json_writer_t writer;
+    linx_json_writer_init(&writer);
+
+    linx_json_writer_begin_object(&writer);
+    linx_json_writer_add_string(&writer, "origin", linx_boot_origin_is_process_start() ? "process" : "first_mark");
+    int64_t ready = linx_boot_ready_to_listen_us();
+    linx_json_writer_key(&writer, "ready_to_listen_us");
+    if (ready >= 0) {
+        linx_json_writer_int(&writer, (long long)ready);
+    } else {
+        linx_json_writer_null(&writer);
+    }
+    linx_json_writer_key(&writer, "phases");
+    linx_json_writer_begin_object(&writer);
+    for (int i = 0; i < LINX_BOOT_PHASE_COUNT; i++) {
+        int64_t at = linx_boot_elapsed_us((linx_boot_phase_t)i);
+        if (at >= 0) {
+            linx_json_writer_add_int(&writer, s_phase_names[i], (long long)at);
+        }
+    }
+    linx_json_writer_end_object(&writer);
+    linx_json_writer_end_object(&writer);
+
+    const char* json = linx_json_writer_finish(&writer);
+    char* result = json ? LINX_STRDUP(json) : NULL;
+    linx_json_writer_free(&writer);
+    return result;
+}
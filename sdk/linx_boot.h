@@ -0,0 +1,105 @@
+/**
+ * @file linx_boot.h
+ * @brief 启动耗时剖析
+ *
+ * 记录从进程启动到"可以开始监听"之间各阶段到达的时刻，用于分析冷启动耗时。
+ * 时刻以进程启动为原点（Linux 读取 /proc/self/stat，macOS 读取进程启动时间），
+ * 无法获取时以第一次调用 linx_boot_begin() 或 linx_boot_mark() 的时刻为原点。
+ *
+ * SDK自动记录网络相关阶段（SDK创建、开始连接、握手完成、会话建立、开始监听、
+ * 第一轮对话结束和推迟的初始化完成）；音频设备、编解码器和播放器由应用在各自
+ * 就绪后调用 linx_boot_mark() 上报。每个阶段只记录第一次到达，之后的重连、
+ * 后续对话不会覆盖。
+ *
+ * 记录接口是无锁的，可以在任意线程调用。统计是进程级的，多个SDK实例共享。
+ */
+
+#ifndef LINX_BOOT_H
+#define LINX_BOOT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 启动阶段
+ */
+typedef enum {
+    LINX_BOOT_SDK_CREATED = 0,      ///< linx_sdk_create() 返回
+    LINX_BOOT_CONNECT_START,        ///< linx_sdk_connect() 开始
+    LINX_BOOT_WS_CONNECTED,         ///< WebSocket 握手完成
+    LINX_BOOT_SESSION_READY,        ///< 收到服务端 hello，会话建立
+    LINX_BOOT_LISTEN_READY,         ///< 发出 listen start，服务端开始接收语音
+    LINX_BOOT_AUDIO_READY,          ///< 音频设备就绪（应用上报）
+    LINX_BOOT_CODEC_READY,          ///< 编解码器就绪（应用上报）
+    LINX_BOOT_PLAYER_READY,         ///< 播放器就绪（应用上报）
+    LINX_BOOT_FIRST_TURN_DONE,      ///< 第一轮对话结束（收到 tts stop）
+    LINX_BOOT_DEFERRED_READY,       ///< 快速启动推迟的初始化（MCP 线程池、OTA）完成
+    LINX_BOOT_PHASE_COUNT
+} linx_boot_phase_t;
+
+/**
+ * @brief 确定时间原点；进程启动时间可用时调用与否没有区别
+ *
+ * 在无法获取进程启动时间的平台上应尽早（main 开头）调用。
+ */
+void linx_boot_begin(void);
+
+/**
+ * @brief 记录阶段到达；已经记录过的阶段忽略
+ */
+void linx_boot_mark(linx_boot_phase_t phase);
+
+/**
+ * @brief 阶段到达时刻
+ * @return 距原点的微秒数，尚未到达返回 -1
+ */
+int64_t linx_boot_elapsed_us(linx_boot_phase_t phase);
+
+/**
+ * @brief 进程启动到可以开始监听的耗时
+ *
+ * 取 LINX_BOOT_LISTEN_READY 与已上报的音频设备、编解码器、播放器就绪时刻中最晚的一个。
+ *
+ * @return 微秒数，尚未开始监听返回 -1
+ */
+int64_t linx_boot_ready_to_listen_us(void);
+
+/**
+ * @brief 时间原点是否为进程启动时刻（否则为第一次调用的时刻）
+ */
+bool linx_boot_origin_is_process_start(void);
+
+/**
+ * @brief 阶段在 JSON 和日志中使用的名称
+ */
+const char* linx_boot_phase_name(linx_boot_phase_t phase);
+
+/**
+ * @brief 清除全部记录并重新确定原点（同一进程内模拟再次冷启动时使用）
+ */
+void linx_boot_reset(void);
+
+/**
+ * @brief 以 INFO 级别按到达顺序输出各阶段时刻
+ */
+void linx_boot_dump(void);
+
+/**
+ * @brief 把记录序列化为 JSON
+ *
+ * 格式：{"origin":"process","ready_to_listen_us":212400,"phases":{"sdk_created":35100,...}}，
+ * 单位为微秒，未到达的阶段不输出，尚未开始监听时 ready_to_listen_us 为 null。
+ *
+ * @return 以 '\0' 结尾的 JSON 文本，调用者用 linx_free() 释放；内存不足时返回 NULL
+ */
+char* linx_boot_to_json(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LINX_BOOT_H
@@ -0,0 +1,150 @@
+/**
+ * @file linx_budget.c
+ * @brief 运行期资源预算报告实现
+ */
+
+#include "linx_budget.h"
+#include "linx_sdk.h"
+#include "log/linx_alloc.h"
+#include "log/linx_log.h"
+#include "log/linx_thread_stats.h"
+#include "cjson/linx_json_writer.h"
+#include <string.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_CORE);
+
+/* 单个流水线阶段的汇总 */
+typedef struct {
+    size_t threads;
+    long long cpu_permille;
+    size_t stack_max;
+} budget_stage_t;
+
+static long long thread_cpu_permille(const linx_thread_stats_t* stats) {
+    if (stats->window_us == 0) {
+        return 0;
+    }
+    return (long long)(stats->window_cpu_us * 1000 / stats->window_us);
+}
+
+static void sum_stages(const linx_thread_stats_t* threads, size_t count, budget_stage_t* stages) {
+    memset(stages, 0, sizeof(budget_stage_t) * LINX_THREAD_STAGE_COUNT);
+    for (size_t i = 0; i < count; i++) {
+        budget_stage_t* stage = &stages[threads[i].stage];
+        stage->threads++;
+        stage->cpu_permille += thread_cpu_permille(&threads[i]);
+        if (threads[i].stack_used > stage->stack_max) {
+            stage->stack_max = threads[i].stack_used;
+        }
+    }
+}
+
+bool linx_budget_enable(void) {
+    linx_thread_stats_enable();
+    if (linx_alloc_tracking_enabled()) {
+        return true;
+    }
+    return linx_sdk_enable_alloc_tracking(NULL) == LINX_SDK_SUCCESS;
+}
+
+void linx_budget_window_begin(void) {
+    linx_thread_stats_window_begin();
+}
+
+void linx_budget_dump(void) {
+    size_t peak = 0;
+    size_t current = linx_alloc_get_total(&peak);
+    if (linx_alloc_tracking_enabled()) {
+        LOG_INFO("堆: 当前 %zu 字节, 峰值 %zu 字节", current, peak);
+    } else {
+        LOG_INFO("堆: 未启用分配跟踪");
+    }
+
+    linx_thread_stats_t threads[LINX_THREAD_STATS_MAX_THREADS];
+    size_t count = linx_thread_stats_get(threads, LINX_THREAD_STATS_MAX_THREADS);
+    budget_stage_t stages[LINX_THREAD_STAGE_COUNT];
+    sum_stages(threads, count, stages);
+    for (int s = 0; s < LINX_THREAD_STAGE_COUNT; s++) {
+        if (stages[s].threads == 0) {
+            continue;
+        }
+        LOG_INFO("阶段 %-9s 线程 %2zu  CPU %5.1f%%  栈高水位 %zu 字节", linx_thread_stage_name((linx_thread_stage_t)s),
+                 stages[s].threads, stages[s].cpu_permille / 10.0, stages[s].stack_max);
+    }
+    linx_thread_stats_dump();
+}
+
+char* linx_budget_to_json(void) {
+    linx_thread_stats_t threads[LINX_THREAD_STATS_MAX_THREADS];
+    size_t count = linx_thread_stats_get(threads, LINX_THREAD_STATS_MAX_THREADS);
+    budget_stage_t stages[LINX_THREAD_STAGE_COUNT];
+    sum_stages(threads, count, stages);
+
+    linx_json_writer_t writer;
+    linx_json_writer_init(&writer);
+    linx_json_writer_begin_object(&writer);
+
+    // 堆
+    size_t peak = 0;
+    size_t current = linx_alloc_get_total(&peak);
+    linx_json_writer_key(&writer, "heap");
+    linx_json_writer_begin_object(&writer);
+    linx_json_writer_add_bool(&writer, "tracking", linx_alloc_tracking_enabled());
+    linx_json_writer_add_int(&writer, "current", (long long)current);
+    linx_json_writer_add_int(&writer, "peak", (long long)peak);
+    linx_json_writer_key(&writer, "modules");
+    linx_json_writer_begin_object(&writer);
+    for (int m = 0; m < LINX_ALLOC_MODULE_COUNT; m++) {
+        linx_alloc_module_stats_t stats;
+        if (!linx_alloc_get_module_stats((linx_alloc_module_t)m, &stats) || stats.allocations == 0) {
+            continue;
+        }
+        linx_json_writer_key(&writer, linx_alloc_module_name((linx_alloc_module_t)m));
+        linx_json_writer_begin_object(&writer);
+        linx_json_writer_add_int(&writer, "peak", (long long)stats.peak_bytes);
+        linx_json_writer_add_int(&writer, "at_peak", (long long)stats.bytes_at_peak);
+        linx_json_writer_end_object(&writer);
+    }
+    linx_json_writer_end_object(&writer);
+    linx_json_writer_end_object(&writer);
+
+    // 流水线阶段
+    linx_json_writer_key(&writer, "stages");
+    linx_json_writer_begin_object(&writer);
+    for (int s = 0; s < LINX_THREAD_STAGE_COUNT; s++) {
+        if (stages[s].threads == 0) {
+            continue;
+        }
+        linx_json_writer_key(&writer, linx_thread_stage_name((linx_thread_stage_t)s));
+        linx_json_writer_begin_object(&writer);
+        linx_json_writer_add_int(&writer, "threads", (long long)stages[s].threads);
+        linx_json_writer_add_int(&writer, "cpu_permille", stages[s].cpu_permille);
+        linx_json_writer_add_int(&writer, "stack_max", (long long)stages[s].stack_max);
+        linx_json_writer_end_object(&writer);
+    }
+    linx_json_writer_end_object(&writer);
+
+    // 线程
+    linx_json_writer_key(&writer, "threads");
+    linx_json_writer_begin_array(&writer);
+    for (size_t i = 0; i < count; i++) {
+        linx_json_writer_begin_object(&writer);
+        linx_json_writer_add_string(&writer, "name", threads[i].name);
+        linx_json_writer_add_string(&writer, "stage", linx_thread_stage_name(threads[i].stage));
+        linx_json_writer_add_bool(&writer, "alive", threads[i].alive);
+        linx_json_writer_add_int(&writer, "stack_size", (long long)threads[i].stack_size);
+        linx_json_writer_add_int(&writer, "stack_used", (long long)threads[i].stack_used);
+        linx_json_writer_add_bool(&writer, "stack_saturated", threads[i].stack_saturated);
+        linx_json_writer_add_int(&writer, "cpu_us", (long long)threads[i].cpu_us);
+        linx_json_writer_add_int(&writer, "cpu_permille", thread_cpu_permille(&threads[i]));
+        linx_json_writer_end_object(&writer);
+    }
+    linx_json_writer_end_array(&writer);
+
+    linx_json_writer_end_object(&writer);
+
+    const char* json = linx_json_writer_finish(&writer);
+    char* result = json ? LINX_STRDUP(json) : NULL;
+    linx_json_writer_free(&writer);
+    return result;
+}
@@ -0,0 +1,60 @@
+/**
+ * @file linx_budget.h
+ * @brief 运行期资源预算报告
+ *
+ * 汇总一次运行的资源占用，用于判断某块板子能承担哪些功能：
+ * - 堆：总峰值，以及峰值时各模块的占用（来自 linx_alloc 跟踪分配器）
+ * - 栈：SDK 各线程的栈大小和高水位（来自 log/linx_thread_stats.h）
+ * - CPU：统计窗口内各线程及各流水线阶段（网络、派发、播放、采集、MCP、日志）的稳态占用
+ *
+ * 静态 RAM/Flash 不在运行期统计，由 sdk/protocols/test/budget_report.py 从链接 map 文件
+ * 按模块汇总，并与本报告的 JSON 合并成各板级配置的预算表。
+ */
+
+#ifndef LINX_BUDGET_H
+#define LINX_BUDGET_H
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 打开堆跟踪和线程统计
+ *
+ * 必须在任何SDK调用（包括 log_init()）之前调用，之后创建的线程才会统计栈和CPU。
+ *
+ * @return 成功返回 true；堆跟踪启用失败返回 false（线程统计仍会打开）
+ */
+bool linx_budget_enable(void);
+
+/**
+ * @brief 开始CPU统计窗口，在进入稳态（如会话建立、开始收发音频）后调用
+ */
+void linx_budget_window_begin(void);
+
+/**
+ * @brief 以 INFO 级别输出堆、各阶段CPU与各线程栈高水位
+ */
+void linx_budget_dump(void);
+
+/**
+ * @brief 把报告序列化为 JSON
+ *
+ * 格式：
+ * {"heap":{"tracking":true,"current":..,"peak":..,"modules":{"protocol":{"peak":..,"at_peak":..},...}},
+ *  "stages":{"network":{"threads":1,"cpu_permille":35,"stack_max":9120},...},
+ *  "threads":[{"name":"reactor","stage":"network","alive":true,"stack_size":..,"stack_used":..,
+ *              "stack_saturated":false,"cpu_us":..,"cpu_permille":..},...]}
+ * 字节数为整数；cpu_permille 为窗口内占单核的千分比；没有线程的阶段不输出。
+ *
+ * @return 以 '\0' 结尾的 JSON 文本，调用者用 linx_free() 释放；内存不足时返回 NULL
+ */
+char* linx_budget_to_json(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LINX_BUDGET_H
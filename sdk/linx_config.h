@@ -0,0 +1,43 @@
+/**
+ * @file linx_config.h
+ * @brief 编译期功能裁剪开关
+ *
+ * 构建配置（build/configs 下的 .config 文件）里的 CONFIG_ENABLE_MCP / CONFIG_ENABLE_OTA /
+ * CONFIG_ENABLE_UI / CONFIG_ENABLE_CAMERA 经 linxos.py 传给 CMake 的 LINX_ENABLE_*
+ * 选项，再以同名宏（0 或 1）传给使用 SDK 的所有目标。关闭的模块不参与编译，
+ * linx_sdk.c 中对应的调用也一并去掉，配合 -ffunction-sections / --gc-sections
+ * 只做语音的固件不含这些模块的代码。
+ *
+ * 关闭某个模块后，它的公共接口仍然可以调用：
+ * - MCP：linx_sdk_add_mcp_tool() 等返回 LINX_SDK_ERROR_NOT_INITIALIZED，
+ *   服务器下发的 "mcp" 消息只以 LINX_EVENT_MCP_MESSAGE 事件交给应用
+ * - OTA：linx_sdk_ota_check_async() 等返回 LINX_SDK_ERROR_NOT_INITIALIZED
+ * 头文件中的类型照常可见，应用代码无需为裁剪改写。
+ *
+ * 不经 CMake 构建时未定义的开关按开启处理。
+ */
+
+#ifndef LINX_CONFIG_H
+#define LINX_CONFIG_H
+
+/* MCP 工具服务器（sdk/mcp） */
+#ifndef LINX_ENABLE_MCP
+#define LINX_ENABLE_MCP 1
+#endif
+
+/* 固件升级（sdk/ota） */
+#ifndef LINX_ENABLE_OTA
+#define LINX_ENABLE_OTA 1
+#endif
+
+/* 界面模块（sdk/ui，依赖 LVGL） */
+#ifndef LINX_ENABLE_UI
+#define LINX_ENABLE_UI 1
+#endif
+
+/* 相机采集和预览（sdk/camera 及板级相机驱动） */
+#ifndef LINX_ENABLE_CAMERA
+#define LINX_ENABLE_CAMERA 1
+#endif
+
+#endif /* LINX_CONFIG_H */
@@ -0,0 +1,236 @@
+/**
+ * @file linx_crypto.c
+ * @brief 加密算法提供者实现
+ */
+
+#include "linx_crypto.h"
+#include <string.h>
+
+#if LINX_CRYPTO_MBEDTLS
+#include "mbedtls/aes.h"
+#include "mbedtls/sha256.h"
+#endif
+
+/* ==================== 软件 SHA-256（FIPS 180-4） ==================== */
+
+typedef struct {
+    uint32_t h[8];
+    uint64_t length;            // 已输入的字节数
+    uint8_t block[64];
+    uint32_t used;              // block 中待压缩的字节数
+} sw_sha256_t;
+
+typedef char sw_sha256_fits[sizeof(sw_sha256_t) <= sizeof(linx_sha256_state_t) ? 1 : -1];
+
+static const uint32_t s_sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static uint32_t sha256_ror(uint32_t x, int n) {
+    return x >> n | x << (32 - n);
+}
+
+static void sha256_compress(uint32_t h[8], const uint8_t block[64]) {
+    uint32_t w[64];
+    for (int i = 0; i < 16; i++) {
+        w[i] = (uint32_t)block[i * 4] << 24 | (uint32_t)block[i * 4 + 1] << 16 |
+               (uint32_t)block[i * 4 + 2] << 8 | block[i * 4 + 3];
+    }
+    for (int i = 16; i < 64; i++) {
+        uint32_t s0 = sha256_ror(w[i - 15], 7) ^ sha256_ror(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = sha256_ror(w[i - 2], 17) ^ sha256_ror(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], k = h[7];
+    for (int i = 0; i < 64; i++) {
+        uint32_t t1 = k + (sha256_ror(e, 6) ^ sha256_ror(e, 11) ^ sha256_ror(e, 25)) +
+                      ((e & f) ^ (~e & g)) + s_sha256_k[i] + w[i];
+        uint32_t t2 = (sha256_ror(a, 2) ^ sha256_ror(a, 13) ^ sha256_ror(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        k = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    h[0] += a;
+    h[1] += b;
+    h[2] += c;
+    h[3] += d;
+    h[4] += e;
+    h[5] += f;
+    h[6] += g;
+    h[7] += k;
+}
+
+static void sw_sha256_init(linx_sha256_state_t* state) {
+    static const uint32_t iv[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+    };
+    sw_sha256_t* sha = (sw_sha256_t*)state->bytes;
+    memset(sha, 0, sizeof(*sha));
+    memcpy(sha->h, iv, sizeof(iv));
+}
+
+static void sw_sha256_update(linx_sha256_state_t* state, const uint8_t* data, size_t len) {
+    sw_sha256_t* sha = (sw_sha256_t*)state->bytes;
+    sha->length += len;
+    if (sha->used > 0) {
+        size_t take = 64 - sha->used < len ? 64 - sha->used : len;
+        memcpy(sha->block + sha->used, data, take);
+        sha->used += (uint32_t)take;
+        data += take;
+        len -= take;
+        if (sha->used < 64) {
+            return;
+        }
+        sha256_compress(sha->h, sha->block);
+        sha->used = 0;
+    }
+    for (; len >= 64; data += 64, len -= 64) {
+        sha256_compress(sha->h, data);
+    }
+    memcpy(sha->block, data, len);
+    sha->used = (uint32_t)len;
+}
+
+static void sw_sha256_final(linx_sha256_state_t* state, uint8_t digest[LINX_SHA256_DIGEST_SIZE]) {
+    sw_sha256_t* sha = (sw_sha256_t*)state->bytes;
+    uint64_t bits = sha->length * 8;
+    sha->block[sha->used++] = 0x80;
+    if (sha->used > 56) {
+        memset(sha->block + sha->used, 0, 64 - sha->used);
+        sha256_compress(sha->h, sha->block);
+        sha->used = 0;
+    }
+    memset(sha->block + sha->used, 0, 56 - sha->used);
+    for (int i = 0; i < 8; i++) {
+        sha->block[56 + i] = (uint8_t)(bits >> (56 - 8 * i));
+    }
+    sha256_compress(sha->h, sha->block);
+    for (int i = 0; i < 8; i++) {
+        digest[i * 4] = (uint8_t)(sha->h[i] >> 24);
+        digest[i * 4 + 1] = (uint8_t)(sha->h[i] >> 16);
+        digest[i * 4 + 2] = (uint8_t)(sha->h[i] >> 8);
+        digest[i * 4 + 3] = (uint8_t)sha->h[i];
+    }
+}
+
+/* AES 的软件实现在 protocols/linx_aes_ctr.c，aes128_ctr 为 NULL 时由调用方直接使用 */
+static const linx_crypto_provider_t s_software_provider = {
+    .name = "software",
+    .sha256_init = sw_sha256_init,
+    .sha256_update = sw_sha256_update,
+    .sha256_final = sw_sha256_final,
+    .aes128_ctr = NULL,
+};
+
+static const linx_crypto_provider_t* s_provider = &s_software_provider;
+
+bool linx_crypto_set_provider(const linx_crypto_provider_t* provider) {
+    if (provider) {
+        bool any = provider->sha256_init || provider->sha256_update || provider->sha256_final;
+        bool all = provider->sha256_init && provider->sha256_update && provider->sha256_final;
+        if (any && !all) {
+            return false;
+        }
+    }
+    __atomic_store_n(&s_provider, provider ? provider : &s_software_provider, __ATOMIC_RELEASE);
+    return true;
+}
+
+const linx_crypto_provider_t* linx_crypto_get_provider(void) {
+    return __atomic_load_n(&s_provider, __ATOMIC_ACQUIRE);
+}
+
+/* ==================== SHA-256 ==================== */
+
+/* 提供者没有 SHA-256 时使用软件实现 */
+static const linx_crypto_provider_t* sha256_provider(void) {
+    const linx_crypto_provider_t* provider = linx_crypto_get_provider();
+    return provider->sha256_init ? provider : &s_software_provider;
+}
+
+void linx_sha256_init(linx_sha256_ctx_t* ctx) {
+    ctx->provider = sha256_provider();
+    ctx->provider->sha256_init(&ctx->state);
+}
+
+void linx_sha256_update(linx_sha256_ctx_t* ctx, const void* data, size_t len) {
+    if (len > 0) {
+        ctx->provider->sha256_update(&ctx->state, (const uint8_t*)data, len);
+    }
+}
+
+void linx_sha256_final(linx_sha256_ctx_t* ctx, uint8_t digest[LINX_SHA256_DIGEST_SIZE]) {
+    ctx->provider->sha256_final(&ctx->state, digest);
+}
+
+bool linx_sha256_resume(linx_sha256_ctx_t* ctx, const char* name, const linx_sha256_state_t* state) {
+    const linx_crypto_provider_t* provider = sha256_provider();
+    if (!name || !provider->name || strcmp(name, provider->name) != 0) {
+        return false;
+    }
+    ctx->provider = provider;
+    ctx->state = *state;
+    return true;
+}
+
+/* ==================== mbedTLS ==================== */
+
+#if LINX_CRYPTO_MBEDTLS
+typedef char mbedtls_sha256_fits[sizeof(mbedtls_sha256_context) <= sizeof(linx_sha256_state_t) ? 1 : -1];
+
+static void mbedtls_provider_sha256_init(linx_sha256_state_t* state) {
+    mbedtls_sha256_context* sha = (mbedtls_sha256_context*)state->bytes;
+    mbedtls_sha256_init(sha);
+    mbedtls_sha256_starts(sha, 0);
+}
+
+static void mbedtls_provider_sha256_update(linx_sha256_state_t* state, const uint8_t* data, size_t len) {
+    mbedtls_sha256_update((mbedtls_sha256_context*)state->bytes, data, len);
+}
+
+static void mbedtls_provider_sha256_final(linx_sha256_state_t* state, uint8_t digest[LINX_SHA256_DIGEST_SIZE]) {
+    mbedtls_sha256_context* sha = (mbedtls_sha256_context*)state->bytes;
+    mbedtls_sha256_finish(sha, digest);
+    mbedtls_sha256_free(sha);
+}
+
+static bool mbedtls_provider_aes128_ctr(const uint8_t key[16], const uint8_t counter[16],
+                                        const uint8_t* in, uint8_t* out, size_t size) {
+    mbedtls_aes_context aes;
+    unsigned char nonce_counter[16];
+    unsigned char stream_block[16];
+    size_t offset = 0;
+    memcpy(nonce_counter, counter, sizeof(nonce_counter));
+
+    mbedtls_aes_init(&aes);
+    bool ok = mbedtls_aes_setkey_enc(&aes, key, 128) == 0 &&
+              mbedtls_aes_crypt_ctr(&aes, size, &offset, nonce_counter, stream_block, in, out) == 0;
+    mbedtls_aes_free(&aes);
+    return ok;
+}
+
+static const linx_crypto_provider_t s_mbedtls_provider = {
+    .name = "mbedtls",
+    .sha256_init = mbedtls_provider_sha256_init,
+    .sha256_update = mbedtls_provider_sha256_update,
+    .sha256_final = mbedtls_provider_sha256_final,
+    .aes128_ctr = mbedtls_provider_aes128_ctr,
+};
+
+const linx_crypto_provider_t* linx_crypto_mbedtls_provider(void) {
+    return &s_mbedtls_provider;
+}
+#endif
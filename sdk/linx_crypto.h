@@ -0,0 +1,109 @@
+/**
+ * @file linx_crypto.h
+ * @brief 加密算法提供者
+ *
+ * SDK 自己做的摘要和加密（OTA 镜像与差分升级的 SHA-256、MQTT+UDP 音频的 AES-128-CTR）都经这里，
+ * 应用可以换成芯片的 AES/SHA 外设（ESP32、全志 V 系列）或硬件加速的 mbedTLS，
+ * 这些运算就不再占用音频线程所在核的 CPU。未设置时使用软件实现。
+ *
+ * TLS（WebSocket、OTA 下载、图像解释上传）的握手和记录层加密由 mongoose 完成，不经过这里：
+ * 构建时 LINX_TLS_BACKEND=mbedtls（构建配置 CONFIG_TLS_BACKEND）让 mongoose 改用 mbedTLS，
+ * ESP-IDF 的 mbedTLS 组件默认启用 AES、SHA 和大数运算的硬件加速。同一构建下
+ * linx_crypto_mbedtls_provider() 把 SDK 自己的 SHA-256/AES 也交给 mbedTLS。
+ *
+ * 提供者是进程内全局的，应在创建 SDK（或开始 OTA）之前设置。
+ */
+
+#ifndef LINX_CRYPTO_H
+#define LINX_CRYPTO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LINX_SHA256_DIGEST_SIZE 32
+
+/* 提供者 SHA-256 上下文可用的字节数 */
+#define LINX_SHA256_STATE_SIZE 192
+
+/**
+ * SHA-256 中间状态，由提供者解释
+ *
+ * 必须是可以按字节拷贝的普通数据：OTA 校验时复制一份求中间摘要，
+ * 断点续传时把它写入状态文件，重启后读回继续计算。状态保存在引擎寄存器里的硬件实现
+ * 需要在 update 结束前把状态读回内存。
+ */
+typedef union {
+    uint8_t bytes[LINX_SHA256_STATE_SIZE];
+    uint64_t align;
+} linx_sha256_state_t;
+
+typedef struct linx_crypto_provider linx_crypto_provider_t;
+
+/**
+ * 可替换的算法实现；函数指针为 NULL 的算法使用软件实现
+ */
+struct linx_crypto_provider {
+    const char* name;               ///< 名称，写入 OTA 续传状态，换了提供者的续传记录不会被误用（最长 15 字节）
+
+    /* SHA-256：三个函数同时提供或同时为 NULL */
+    void (*sha256_init)(linx_sha256_state_t* state);
+    void (*sha256_update)(linx_sha256_state_t* state, const uint8_t* data, size_t len);
+    void (*sha256_final)(linx_sha256_state_t* state, uint8_t digest[LINX_SHA256_DIGEST_SIZE]);
+
+    /**
+     * AES-128-CTR，计数器为整个 16 字节大端递增（与 linx_aes128_ctr() 一致），in 与 out 可以相同；
+     * 在 MQTT+UDP 的收发线程上逐包调用。返回 false 时该包改用软件实现（如引擎正忙）
+     */
+    bool (*aes128_ctr)(const uint8_t key[16], const uint8_t counter[16],
+                       const uint8_t* in, uint8_t* out, size_t size);
+};
+
+/**
+ * 设置加密提供者
+ * @param provider 提供者（调用者持有，须一直有效），NULL 恢复软件实现
+ * @return false 表示 SHA-256 的三个函数没有同时提供
+ */
+bool linx_crypto_set_provider(const linx_crypto_provider_t* provider);
+
+/**
+ * 当前提供者，从未设置时为软件实现（名称 "software"）
+ */
+const linx_crypto_provider_t* linx_crypto_get_provider(void);
+
+/* ==================== SHA-256 ==================== */
+
+typedef struct {
+    const linx_crypto_provider_t* provider;     ///< 由 linx_sha256_init() 绑定，换提供者不影响进行中的计算
+    linx_sha256_state_t state;
+} linx_sha256_ctx_t;
+
+void linx_sha256_init(linx_sha256_ctx_t* ctx);
+
+void linx_sha256_update(linx_sha256_ctx_t* ctx, const void* data, size_t len);
+
+void linx_sha256_final(linx_sha256_ctx_t* ctx, uint8_t digest[LINX_SHA256_DIGEST_SIZE]);
+
+/**
+ * 从保存的中间状态继续计算（OTA 续传）
+ * @param name 产生该状态的提供者名称（保存时的 ctx->provider->name）
+ * @return false 表示当前会绑定的提供者不是 name，状态无法继续使用
+ */
+bool linx_sha256_resume(linx_sha256_ctx_t* ctx, const char* name, const linx_sha256_state_t* state);
+
+#if LINX_CRYPTO_MBEDTLS
+/**
+ * 基于 mbedTLS 的提供者（LINX_TLS_BACKEND=mbedtls 时编入）；ESP-IDF 上 mbedTLS 使用 AES/SHA 外设
+ */
+const linx_crypto_provider_t* linx_crypto_mbedtls_provider(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINX_CRYPTO_H */
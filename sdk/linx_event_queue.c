@@ -0,0 +1,578 @@
+/**
+ * @file linx_event_queue.c
+ * @brief SDK事件队列实现
+ */
+
+#include "linx_event_queue.h"
+#include "log/linx_log.h"
+#include "log/linx_alloc.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_CORE);
+
+/** 空闲链表在音频队列深度之外额外保留的节点数 */
+#define LINX_EVENT_QUEUE_SPARE_NODES 16
+
+/**
+ * @brief 事件节点：事件、OTA信息和字符串放在同一块内存中
+ */
+typedef struct linx_event_node {
+    struct linx_event_node* next;   ///< 队列或空闲链表中的下一个节点
+    linx_event_queue_t* queue;      ///< 池化节点所属的队列，直接分配的节点为 NULL
+    int refcount;                   ///< 引用计数（原子操作）
+    LinxEvent event;                ///< 事件，字符串字段指向 strings
+    linx_ota_info_t ota_info;       ///< OTA 检查结果副本
+    char strings[];                 ///< 字符串存储
+} linx_event_node_t;
+
+struct linx_event_queue {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    linx_event_node_t* head;        ///< 最早入队的事件
+    linx_event_node_t* tail;
+    size_t audio_count;             ///< 排队中的音频事件数
+    size_t max_audio;               ///< 音频事件上限
+    linx_event_node_t* free_list;   ///< 可复用的池化节点
+    size_t free_count;
+    size_t free_max;
+    size_t outstanding;             ///< 已借出（排队中或被应用持有）的池化节点数
+    bool destroyed;                 ///< 已销毁，等最后一个借出的节点归还后释放
+    bool wakeup;                    ///< 唤醒请求
+    bool merge_state;               ///< 合并排队中的状态改变事件
+    uint64_t dropped;               ///< 丢弃的音频事件数
+};
+
+/**
+ * @brief 取出事件类型对应的字符串字段
+ * @return 字段数量
+ */
+static int linx_event_string_fields(LinxEvent* event, char** fields[2]) {
+    switch (event->type) {
+        case LINX_EVENT_TEXT_MESSAGE:
+        case LINX_EVENT_SENTENCE_START:
+        case LINX_EVENT_SENTENCE_END:
+            fields[0] = &event->data.text_message.text;
+            fields[1] = &event->data.text_message.role;
+            return 2;
+        case LINX_EVENT_CUSTOM_MESSAGE:
+            fields[0] = &event->data.custom_message.value;
+            return 1;
+        case LINX_EVENT_EMOTION_MESSAGE:
+            fields[0] = &event->data.emotion.value;
+            return 1;
+        case LINX_EVENT_ERROR:
+            fields[0] = &event->data.error.message;
+            return 1;
+        case LINX_EVENT_SESSION_ESTABLISHED:
+            fields[0] = &event->data.session_established.session_id;
+            fields[1] = &event->data.session_established.audio_format;
+            return 2;
+        case LINX_EVENT_MCP_MESSAGE:
+            fields[0] = &event->data.mcp_message.message;
+            fields[1] = &event->data.mcp_message.type;
+            return 2;
+        case LINX_EVENT_SYSTEM_MESSAGE:
+            fields[0] = &event->data.system_message.message;
+            return 1;
+        case LINX_EVENT_AUDIO_DEADLINE_MISSED:
+            fields[0] = &event->data.audio_deadline.summary;
+            return 1;
+        case LINX_EVENT_MCP_SLOW_TOOL:
+            fields[0] = &event->data.mcp_slow_tool.tool;
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static bool linx_event_is_ota(LinxEventType type) {
+    return type == LINX_EVENT_OTA_CHECKED || type == LINX_EVENT_OTA_PROGRESS || type == LINX_EVENT_OTA_COMPLETED;
+}
+
+static void linx_event_queue_free(linx_event_queue_t* queue) {
+    pthread_mutex_destroy(&queue->mutex);
+    pthread_cond_destroy(&queue->cond);
+    LINX_FREE(queue);
+}
+
+static linx_event_node_t* linx_event_node_alloc(linx_event_queue_t* queue, size_t strings_size) {
+    linx_event_node_t* node = NULL;
+
+    if (queue && strings_size <= LINX_EVENT_QUEUE_INLINE_BYTES) {
+        pthread_mutex_lock(&queue->mutex);
+        node = queue->free_list;
+        if (node) {
+            queue->free_list = node->next;
+            queue->free_count--;
+        }
+        queue->outstanding++;
+        pthread_mutex_unlock(&queue->mutex);
+
+        if (!node) {
+            node = (linx_event_node_t*)LINX_MALLOC(sizeof(linx_event_node_t) + LINX_EVENT_QUEUE_INLINE_BYTES);
+            if (!node) {
+                pthread_mutex_lock(&queue->mutex);
+                queue->outstanding--;
+                pthread_mutex_unlock(&queue->mutex);
+                return NULL;
+            }
+        }
+        node->queue = queue;
+    } else {
+        node = (linx_event_node_t*)LINX_MALLOC(sizeof(linx_event_node_t) + strings_size);
+        if (!node) {
+            return NULL;
+        }
+        node->queue = NULL;
+    }
+
+    node->next = NULL;
+    node->refcount = 1;
+    return node;
+}
+
+static void linx_event_node_free(linx_event_node_t* node) {
+    linx_event_queue_t* queue = node->queue;
+    if (!queue) {
+        LINX_FREE(node);
+        return;
+    }
+
+    bool free_queue = false;
+    pthread_mutex_lock(&queue->mutex);
+    queue->outstanding--;
+    if (!queue->destroyed && queue->free_count < queue->free_max) {
+        node->next = queue->free_list;
+        queue->free_list = node;
+        queue->free_count++;
+        node = NULL;
+    }
+    free_queue = queue->destroyed && queue->outstanding == 0;
+    pthread_mutex_unlock(&queue->mutex);
+
+    LINX_FREE(node);
+    if (free_queue) {
+        linx_event_queue_free(queue);
+    }
+}
+
+linx_event_queue_t* linx_event_queue_create(size_t max_audio_events) {
+    linx_event_queue_t* queue = (linx_event_queue_t*)LINX_CALLOC(1, sizeof(linx_event_queue_t));
+    if (!queue) {
+        return NULL;
+    }
+
+    if (pthread_mutex_init(&queue->mutex, NULL) != 0) {
+        LINX_FREE(queue);
+        return NULL;
+    }
+    if (pthread_cond_init(&queue->cond, NULL) != 0) {
+        pthread_mutex_destroy(&queue->mutex);
+        LINX_FREE(queue);
+        return NULL;
+    }
+
+    queue->max_audio = max_audio_events > 0 ? max_audio_events : LINX_EVENT_QUEUE_DEFAULT_AUDIO_DEPTH;
+    queue->free_max = queue->max_audio + LINX_EVENT_QUEUE_SPARE_NODES;
+    return queue;
+}
+
+size_t linx_event_queue_reserve(linx_event_queue_t* queue, size_t count) {
+    if (!queue) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&queue->mutex);
+    size_t target = count > 0 && count < queue->free_max ? count : queue->free_max;
+    while (queue->free_count < target) {
+        linx_event_node_t* node =
+            (linx_event_node_t*)LINX_MALLOC(sizeof(linx_event_node_t) + LINX_EVENT_QUEUE_INLINE_BYTES);
+        if (!node) {
+            break;
+        }
+        node->queue = queue;
+        node->next = queue->free_list;
+        queue->free_list = node;
+        queue->free_count++;
+    }
+    size_t reserved = queue->free_count;
+    pthread_mutex_unlock(&queue->mutex);
+    return reserved;
+}
+
+void linx_event_queue_destroy(linx_event_queue_t* queue) {
+    if (!queue) {
+        return;
+    }
+
+    linx_event_queue_clear(queue);
+
+    pthread_mutex_lock(&queue->mutex);
+    queue->destroyed = true;
+    linx_event_node_t* node = queue->free_list;
+    queue->free_list = NULL;
+    queue->free_count = 0;
+    bool free_now = queue->outstanding == 0;
+    pthread_mutex_unlock(&queue->mutex);
+
+    while (node) {
+        linx_event_node_t* next = node->next;
+        LINX_FREE(node);
+        node = next;
+    }
+
+    // 应用仍持有事件时，由最后一次 linx_event_release() 释放队列
+    if (free_now) {
+        linx_event_queue_free(queue);
+    }
+}
+
+LinxEvent* linx_event_copy(linx_event_queue_t* queue, const LinxEvent* event, linx_audio_packet_pool_t* pool) {
+    if (!event) {
+        return NULL;
+    }
+
+    LinxEvent source = *event;
+    char** fields[2];
+    int count = linx_event_string_fields(&source, fields);
+    size_t strings_size = 0;
+    for (int i = 0; i < count; i++) {
+        if (*fields[i]) {
+            strings_size += strlen(*fields[i]) + 1;
+        }
+    }
+
+    linx_event_node_t* node = linx_event_node_alloc(queue, strings_size);
+    if (!node) {
+        LOG_ERROR("事件节点分配失败");
+        return NULL;
+    }
+
+    node->event = *event;
+    node->event.owner = node;
+
+    // 字符串依次复制到节点尾部
+    char* cursor = node->strings;
+    linx_event_string_fields(&node->event, fields);
+    for (int i = 0; i < count; i++) {
+        if (*fields[i]) {
+            size_t len = strlen(*fields[i]) + 1;
+            memcpy(cursor, *fields[i], len);
+            *fields[i] = cursor;
+            cursor += len;
+        }
+    }
+
+    if (linx_event_is_ota(event->type) && event->data.ota.info) {
+        node->ota_info = *event->data.ota.info;
+        node->event.data.ota.info = &node->ota_info;
+    }
+
+    if (event->type == LINX_EVENT_AUDIO_DATA && event->data.audio_data.value) {
+        node->event.data.audio_data.value = linx_audio_packet_pool_retain(pool, event->data.audio_data.value);
+        if (!node->event.data.audio_data.value) {
+            LOG_ERROR("音频事件数据包保留失败");
+            linx_event_node_free(node);
+            return NULL;
+        }
+    }
+
+    return &node->event;
+}
+
+LinxEvent* linx_event_retain(LinxEvent* event) {
+    if (!event || !event->owner) {
+        return NULL;
+    }
+
+    linx_event_node_t* node = (linx_event_node_t*)event->owner;
+    __atomic_add_fetch(&node->refcount, 1, __ATOMIC_RELAXED);
+    return event;
+}
+
+void linx_event_release(LinxEvent* event) {
+    if (!event || !event->owner) {
+        return;
+    }
+
+    linx_event_node_t* node = (linx_event_node_t*)event->owner;
+    if (__atomic_sub_fetch(&node->refcount, 1, __ATOMIC_ACQ_REL) > 0) {
+        return;
+    }
+
+    if (node->event.type == LINX_EVENT_AUDIO_DATA && node->event.data.audio_data.value) {
+        linx_audio_stream_packet_destroy(node->event.data.audio_data.value);
+    }
+    linx_event_node_free(node);
+}
+
+bool linx_event_queue_push(linx_event_queue_t* queue, const LinxEvent* event, linx_audio_packet_pool_t* pool) {
+    if (!queue || !event) {
+        return false;
+    }
+
+    // 状态改变并入队尾的状态事件，不需要复制新事件
+    if (event->type == LINX_EVENT_STATE_CHANGED && __atomic_load_n(&queue->merge_state, __ATOMIC_RELAXED)) {
+        linx_event_node_t* merged = NULL;
+        bool handled = false;
+        pthread_mutex_lock(&queue->mutex);
+        linx_event_node_t* tail = queue->tail;
+        if (tail && tail->event.type == LINX_EVENT_STATE_CHANGED) {
+            tail->event.data.state_changed.new_state = event->data.state_changed.new_state;
+            tail->event.timestamp = event->timestamp;
+            handled = true;
+            // 回到了原来的状态：两条都不需要派发
+            if (tail->event.data.state_changed.old_state == tail->event.data.state_changed.new_state) {
+                linx_event_node_t** link = &queue->head;
+                linx_event_node_t* prev = NULL;
+                while (*link != tail) {
+                    prev = *link;
+                    link = &(*link)->next;
+                }
+                *link = NULL;
+                queue->tail = prev;
+                merged = tail;
+            }
+        }
+        pthread_mutex_unlock(&queue->mutex);
+        if (merged) {
+            linx_event_release(&merged->event);
+        }
+        if (handled) {
+            return true;
+        }
+    }
+
+    LinxEvent* copy = linx_event_copy(queue, event, pool);
+    if (!copy) {
+        return false;
+    }
+    linx_event_node_t* node = (linx_event_node_t*)copy->owner;
+    bool is_audio = event->type == LINX_EVENT_AUDIO_DATA;
+    linx_event_node_t* dropped = NULL;
+
+    pthread_mutex_lock(&queue->mutex);
+
+    // 音频事件超出上限时丢弃最旧的一个，控制类事件不受影响
+    if (is_audio && queue->audio_count >= queue->max_audio) {
+        linx_event_node_t** link = &queue->head;
+        linx_event_node_t* prev = NULL;
+        while (*link && (*link)->event.type != LINX_EVENT_AUDIO_DATA) {
+            prev = *link;
+            link = &(*link)->next;
+        }
+        if (*link) {
+            dropped = *link;
+            *link = dropped->next;
+            if (queue->tail == dropped) {
+                queue->tail = prev;
+            }
+            queue->audio_count--;
+            queue->dropped++;
+        }
+    }
+
+    if (queue->tail) {
+        queue->tail->next = node;
+    } else {
+        queue->head = node;
+    }
+    queue->tail = node;
+    if (is_audio) {
+        queue->audio_count++;
+    }
+    pthread_cond_signal(&queue->cond);
+
+    pthread_mutex_unlock(&queue->mutex);
+
+    if (dropped) {
+        linx_event_release(&dropped->event);
+    }
+    return true;
+}
+
+LinxEvent* linx_event_queue_pop(linx_event_queue_t* queue, int timeout_ms) {
+    if (!queue) {
+        return NULL;
+    }
+
+    struct timespec deadline;
+    if (timeout_ms > 0) {
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += timeout_ms / 1000;
+        deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+    }
+
+    pthread_mutex_lock(&queue->mutex);
+    while (!queue->head && !queue->wakeup && timeout_ms != 0) {
+        if (timeout_ms < 0) {
+            pthread_cond_wait(&queue->cond, &queue->mutex);
+        } else if (pthread_cond_timedwait(&queue->cond, &queue->mutex, &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+    queue->wakeup = false;
+
+    linx_event_node_t* node = queue->head;
+    if (node) {
+        queue->head = node->next;
+        if (!queue->head) {
+            queue->tail = NULL;
+        }
+        if (node->event.type == LINX_EVENT_AUDIO_DATA) {
+            queue->audio_count--;
+        }
+        node->next = NULL;
+    }
+    pthread_mutex_unlock(&queue->mutex);
+
+    return node ? &node->event : NULL;
+}
+
+LinxEvent* linx_event_queue_pop_type(linx_event_queue_t* queue, LinxEventType type) {
+    if (!queue) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&queue->mutex);
+    linx_event_node_t* node = queue->head;
+    if (node && node->event.type == type) {
+        queue->head = node->next;
+        if (!queue->head) {
+            queue->tail = NULL;
+        }
+        if (type == LINX_EVENT_AUDIO_DATA) {
+            queue->audio_count--;
+        }
+        node->next = NULL;
+    } else {
+        node = NULL;
+    }
+    pthread_mutex_unlock(&queue->mutex);
+
+    return node ? &node->event : NULL;
+}
+
+void linx_event_queue_set_merge_state(linx_event_queue_t* queue, bool enabled) {
+    if (queue) {
+        __atomic_store_n(&queue->merge_state, enabled, __ATOMIC_RELAXED);
+    }
+}
+
+void linx_event_queue_wakeup(linx_event_queue_t* queue) {
+    if (!queue) {
+        return;
+    }
+
+    pthread_mutex_lock(&queue->mutex);
+    queue->wakeup = true;
+    pthread_cond_broadcast(&queue->cond);
+    pthread_mutex_unlock(&queue->mutex);
+}
+
+void linx_event_queue_clear(linx_event_queue_t* queue) {
+    if (!queue) {
+        return;
+    }
+
+    pthread_mutex_lock(&queue->mutex);
+    linx_event_node_t* node = queue->head;
+    queue->head = NULL;
+    queue->tail = NULL;
+    queue->audio_count = 0;
+    pthread_mutex_unlock(&queue->mutex);
+
+    while (node) {
+        linx_event_node_t* next = node->next;
+        linx_event_release(&node->event);
+        node = next;
+    }
+}
+
+uint64_t linx_event_queue_dropped(linx_event_queue_t* queue) {
+    if (!queue) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&queue->mutex);
+    uint64_t dropped = queue->dropped;
+    pthread_mutex_unlock(&queue->mutex);
+    return dropped;
+}
+
+struct linx_event_history {
+    pthread_mutex_t mutex;
+    linx_event_queue_t* pool;       ///< 只用作节点池，不入队
+    size_t depth;
+    size_t next;                    ///< 下一个写入的位置（环形）
+    LinxEvent* events[];            ///< 持有引用的事件，未填满时为 NULL
+};
+
+bool linx_event_history_accepts(LinxEventType type) {
+    return type == LINX_EVENT_TEXT_MESSAGE || type == LINX_EVENT_SENTENCE_START || type == LINX_EVENT_SENTENCE_END;
+}
+
+linx_event_history_t* linx_event_history_create(size_t depth) {
+    if (depth == 0) {
+        return NULL;
+    }
+
+    linx_event_history_t* history =
+        (linx_event_history_t*)LINX_CALLOC(1, sizeof(linx_event_history_t) + depth * sizeof(LinxEvent*));
+    if (!history) {
+        return NULL;
+    }
+
+    // 同时借出的节点最多是保留的 depth 个加正在回调的一个
+    history->pool = linx_event_queue_create(depth + 1);
+    if (!history->pool || pthread_mutex_init(&history->mutex, NULL) != 0) {
+        linx_event_queue_destroy(history->pool);
+        LINX_FREE(history);
+        return NULL;
+    }
+    linx_event_queue_reserve(history->pool, depth + 1);
+    history->depth = depth;
+    return history;
+}
+
+void linx_event_history_destroy(linx_event_history_t* history) {
+    if (!history) {
+        return;
+    }
+
+    for (size_t i = 0; i < history->depth; i++) {
+        linx_event_release(history->events[i]);
+    }
+    // 应用仍持有的节点在最后一次释放时归还，节点池随之释放
+    linx_event_queue_destroy(history->pool);
+    pthread_mutex_destroy(&history->mutex);
+    LINX_FREE(history);
+}
+
+LinxEvent* linx_event_history_copy(linx_event_history_t* history, const LinxEvent* event) {
+    if (!history) {
+        return NULL;
+    }
+    return linx_event_copy(history->pool, event, NULL);
+}
+
+void linx_event_history_keep(linx_event_history_t* history, LinxEvent* event) {
+    if (!history || !linx_event_retain(event)) {
+        return;
+    }
+
+    pthread_mutex_lock(&history->mutex);
+    LinxEvent* evicted = history->events[history->next];
+    history->events[history->next] = event;
+    history->next = (history->next + 1) % history->depth;
+    pthread_mutex_unlock(&history->mutex);
+
+    linx_event_release(evicted);
+}
@@ -0,0 +1,161 @@
+/**
+ * @file linx_event_queue.h
+ * @brief SDK事件队列
+ *
+ * 把网络线程上产生的 LinxEvent 复制成由SDK持有的事件，放入队列，由应用线程
+ * (linx_sdk_poll_events) 或SDK的派发线程取出后调用事件回调。
+ *
+ * 每个队列事件是一个带引用计数的节点：事件结构、全部字符串和OTA信息放在同一块
+ * 内存中，音频数据包从连接的数据包内存池中保留一份。字符串不超过内联容量的节点
+ * 来自队列自带的空闲链表，稳定运行时不再调用 malloc；更大的事件单独分配。
+ * 应用可用 linx_event_retain() 在回调返回后继续持有事件，不需要再复制；连接销毁时
+ * 内存池推迟到最后一个借出的数据包归还后才释放，保留的音频事件在断开连接、
+ * 销毁SDK之后同样有效。
+ *
+ * 事件历史（linx_event_history_*）持有最近几个文本事件的引用，应用在回调中拿到的
+ * 字符串指针在之后的若干个文本事件内保持有效（如字幕显示），不需要自己复制。
+ *
+ * 队列本身是线程安全的。
+ */
+
+#ifndef LINX_EVENT_QUEUE_H
+#define LINX_EVENT_QUEUE_H
+
+#include "linx_sdk.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** 池化节点内联存放的字符串字节数上限，超过时单独分配 */
+#define LINX_EVENT_QUEUE_INLINE_BYTES 512
+
+/** 默认最多排队的音频事件数 */
+#define LINX_EVENT_QUEUE_DEFAULT_AUDIO_DEPTH 64
+
+typedef struct linx_event_queue linx_event_queue_t;
+
+/**
+ * @brief 创建事件队列
+ * @param max_audio_events 最多排队的音频事件数，0 为默认值；超出时丢弃最旧的音频事件。
+ *                         其他事件（状态、文本等）总是入队，不会丢弃
+ * @return 队列实例，失败返回 NULL
+ */
+linx_event_queue_t* linx_event_queue_create(size_t max_audio_events);
+
+/**
+ * @brief 预先分配池化节点放入空闲链表，之后的小事件入队不再调用 malloc
+ * @param count 预分配的节点数，0 表示填满空闲链表（音频队列深度加备用节点）
+ * @return 空闲链表中的节点数
+ */
+size_t linx_event_queue_reserve(linx_event_queue_t* queue, size_t count);
+
+/**
+ * @brief 销毁事件队列，丢弃尚未取出的事件
+ *
+ * 应用仍持有（retain）的事件保持有效，最后一次释放时才归还内存。
+ */
+void linx_event_queue_destroy(linx_event_queue_t* queue);
+
+/**
+ * @brief 复制事件并入队
+ * @param event 源事件（字符串和数据包只需在调用期间有效）
+ * @param pool  保留音频数据包使用的内存池，可为 NULL
+ * @return 入队成功返回 true
+ */
+bool linx_event_queue_push(linx_event_queue_t* queue, const LinxEvent* event, linx_audio_packet_pool_t* pool);
+
+/**
+ * @brief 取出最早的事件
+ * @param timeout_ms 队列为空时的等待时间（毫秒），-1 无限等待，0 立即返回
+ * @return 事件（调用方持有一个引用，用完后 linx_event_release()），超时或被唤醒时返回 NULL
+ */
+LinxEvent* linx_event_queue_pop(linx_event_queue_t* queue, int timeout_ms);
+
+/**
+ * @brief 队首是指定类型的事件时取出，否则立即返回 NULL（不等待）
+ *
+ * 用于把连续排队的同类事件一次取完（如合成音频批次）。
+ */
+LinxEvent* linx_event_queue_pop_type(linx_event_queue_t* queue, LinxEventType type);
+
+/**
+ * @brief 开启后，入队的状态改变事件与队尾尚未取出的状态改变事件合并
+ *
+ * 队尾保留最早的 old_state，new_state 和时间戳取新事件的；合并后 old_state 与
+ * new_state 相同时两条一起丢弃。
+ */
+void linx_event_queue_set_merge_state(linx_event_queue_t* queue, bool enabled);
+
+/**
+ * @brief 唤醒阻塞在 linx_event_queue_pop() 中的线程
+ */
+void linx_event_queue_wakeup(linx_event_queue_t* queue);
+
+/**
+ * @brief 丢弃全部尚未取出的事件
+ */
+void linx_event_queue_clear(linx_event_queue_t* queue);
+
+/**
+ * @brief 因音频事件超出上限而丢弃的事件数（累计值）
+ */
+uint64_t linx_event_queue_dropped(linx_event_queue_t* queue);
+
+/**
+ * @brief 把事件复制为独立持有的事件（不入队）
+ * @param queue 提供节点池的队列，可为 NULL（直接分配）
+ * @param event 源事件
+ * @param pool  保留音频数据包使用的内存池，可为 NULL
+ * @return 新事件（引用计数为 1），失败返回 NULL
+ */
+LinxEvent* linx_event_copy(linx_event_queue_t* queue, const LinxEvent* event, linx_audio_packet_pool_t* pool);
+
+/**
+ * @brief 增加队列事件的引用计数
+ * @param event 由本模块创建的事件（event->owner 非 NULL）
+ * @return event；不是本模块创建的事件时返回 NULL
+ */
+LinxEvent* linx_event_retain(LinxEvent* event);
+
+/**
+ * @brief 释放一个引用，引用计数归零时释放事件及其数据包
+ */
+void linx_event_release(LinxEvent* event);
+
+typedef struct linx_event_history linx_event_history_t;
+
+/**
+ * @brief 是否是事件历史保留的文本事件（TEXT_MESSAGE、SENTENCE_START、SENTENCE_END）
+ */
+bool linx_event_history_accepts(LinxEventType type);
+
+/**
+ * @brief 创建事件历史，同时预分配 depth + 1 个池化节点
+ * @param depth 保留的事件数，须大于 0
+ * @return 实例，失败返回 NULL
+ */
+linx_event_history_t* linx_event_history_create(size_t depth);
+
+/**
+ * @brief 销毁事件历史，释放它持有的引用；应用另外持有的事件不受影响
+ */
+void linx_event_history_destroy(linx_event_history_t* history);
+
+/**
+ * @brief 用历史自带的节点池复制事件，字符串不超过内联容量时稳定运行不调用 malloc
+ * @return 新事件（引用计数为 1），失败返回 NULL
+ */
+LinxEvent* linx_event_history_copy(linx_event_history_t* history, const LinxEvent* event);
+
+/**
+ * @brief 保留事件的一个引用，已满时释放最早的一个
+ * @param event 由本模块创建的事件（event->owner 非 NULL），其他事件忽略
+ */
+void linx_event_history_keep(linx_event_history_t* history, LinxEvent* event);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINX_EVENT_QUEUE_H */
@@ -0,0 +1,373 @@
+/**
+ * @file linx_executor.c
+ * @brief 后台任务执行器实现
+ */
+
+#include "linx_executor.h"
+#include "log/linx_log.h"
+#include "log/linx_alloc.h"
+#include "log/linx_thread_stats.h"
+#include <stdio.h>
+#include <string.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_CORE);
+
+struct linx_cancel_token {
+    int refs;
+    bool cancelled;
+};
+
+/* 执行器销毁时丢弃的任务收到的令牌 */
+static linx_cancel_token_t s_shutdown_token = { 1, true };
+
+typedef struct linx_executor_task {
+    struct linx_executor_task* prev;
+    struct linx_executor_task* next;
+    linx_task_func_t func;
+    void* arg;
+    linx_cancel_token_t* token;
+} linx_executor_task_t;
+
+/* 双向链表：head 为最早放入的一端（窃取、注入队列从这里取），tail 为最新的一端 */
+typedef struct {
+    linx_executor_task_t* head;
+    linx_executor_task_t* tail;
+} linx_executor_list_t;
+
+typedef struct {
+    linx_executor_t* executor;
+    int index;
+    linx_thread_t* thread;
+    linx_mutex_t* mutex;                                    // 保护 deques
+    linx_executor_list_t deques[LINX_TASK_PRIORITY_COUNT];
+} linx_executor_worker_t;
+
+struct linx_executor {
+    linx_executor_worker_t workers[LINX_EXECUTOR_MAX_WORKERS];
+    size_t worker_count;
+    size_t max_pending;
+
+    linx_mutex_t* inject_mutex;                             // 保护 inject，提交与销毁用它串行判断 stopping
+    linx_executor_list_t inject[LINX_TASK_PRIORITY_COUNT];  // 其他线程提交的任务
+    linx_sem_t* wake;                                       // 有新任务或正在销毁
+    unsigned int inject_next;
+
+    size_t pending;                                         // 以下字段原子读写
+    bool stopping;
+    uint64_t submitted;
+    uint64_t executed;
+    uint64_t stolen;
+    uint64_t rejected;
+};
+
+static __thread linx_executor_worker_t* t_worker = NULL;
+
+static void linx_executor_list_push_tail(linx_executor_list_t* list, linx_executor_task_t* task) {
+    task->next = NULL;
+    task->prev = list->tail;
+    if (list->tail) {
+        list->tail->next = task;
+    } else {
+        list->head = task;
+    }
+    list->tail = task;
+}
+
+static linx_executor_task_t* linx_executor_list_pop_head(linx_executor_list_t* list) {
+    linx_executor_task_t* task = list->head;
+    if (task) {
+        list->head = task->next;
+        if (list->head) {
+            list->head->prev = NULL;
+        } else {
+            list->tail = NULL;
+        }
+    }
+    return task;
+}
+
+static linx_executor_task_t* linx_executor_list_pop_tail(linx_executor_list_t* list) {
+    linx_executor_task_t* task = list->tail;
+    if (task) {
+        list->tail = task->prev;
+        if (list->tail) {
+            list->tail->next = NULL;
+        } else {
+            list->head = NULL;
+        }
+    }
+    return task;
+}
+
+/* 按优先级依次看自己的队列底部、注入队列、其他工作线程队列的顶部 */
+static linx_executor_task_t* linx_executor_take(linx_executor_t* executor, linx_executor_worker_t* self) {
+    if (__atomic_load_n(&executor->pending, __ATOMIC_ACQUIRE) == 0) {
+        return NULL;
+    }
+
+    for (int priority = 0; priority < LINX_TASK_PRIORITY_COUNT; priority++) {
+        linx_mutex_lock(self->mutex);
+        linx_executor_task_t* task = linx_executor_list_pop_tail(&self->deques[priority]);
+        linx_mutex_unlock(self->mutex);
+        if (task) {
+            return task;
+        }
+
+        linx_mutex_lock(executor->inject_mutex);
+        task = linx_executor_list_pop_head(&executor->inject[priority]);
+        linx_mutex_unlock(executor->inject_mutex);
+        if (task) {
+            return task;
+        }
+
+        for (size_t i = 1; i < executor->worker_count; i++) {
+            linx_executor_worker_t* victim = &executor->workers[((size_t)self->index + i) % executor->worker_count];
+            linx_mutex_lock(victim->mutex);
+            task = linx_executor_list_pop_head(&victim->deques[priority]);
+            linx_mutex_unlock(victim->mutex);
+            if (task) {
+                __atomic_fetch_add(&executor->stolen, 1, __ATOMIC_RELAXED);
+                return task;
+            }
+        }
+    }
+    return NULL;
+}
+
+static void linx_executor_run(linx_executor_t* executor, linx_executor_task_t* task,
+                              const linx_cancel_token_t* token) {
+    __atomic_fetch_sub(&executor->pending, 1, __ATOMIC_ACQ_REL);
+    task->func(task->arg, token);
+    linx_cancel_token_release(task->token);
+    LINX_FREE(task);
+    __atomic_fetch_add(&executor->executed, 1, __ATOMIC_RELAXED);
+}
+
+static void* linx_executor_thread(void* arg) {
+    linx_executor_worker_t* worker = (linx_executor_worker_t*)arg;
+    linx_executor_t* executor = worker->executor;
+    t_worker = worker;
+
+    char name[24];
+    snprintf(name, sizeof(name), "linx_exec_%d", worker->index);
+    linx_thread_stats_register(name, LINX_THREAD_STAGE_MCP);
+
+    while (!__atomic_load_n(&executor->stopping, __ATOMIC_ACQUIRE)) {
+        linx_executor_task_t* task = linx_executor_take(executor, worker);
+        if (task) {
+            linx_executor_run(executor, task, task->token);
+            continue;
+        }
+        // 提交在 pending 加一之后唤醒，这里没取到任务后再等待不会错过
+        linx_sem_take(executor->wake, LINX_OS_WAIT_FOREVER);
+    }
+
+    linx_thread_stats_unregister();
+    t_worker = NULL;
+    return NULL;
+}
+
+linx_executor_t* linx_executor_create(const linx_executor_config_t* config) {
+    linx_executor_config_t defaults = { 0 };
+    if (!config) {
+        config = &defaults;
+    }
+
+    linx_executor_t* executor = (linx_executor_t*)LINX_CALLOC(1, sizeof(linx_executor_t));
+    if (!executor) {
+        LOG_ERROR("Executor creation failed: memory allocation failed");
+        return NULL;
+    }
+    size_t workers = config->workers > 0 ? config->workers : LINX_EXECUTOR_DEFAULT_WORKERS;
+    if (workers > LINX_EXECUTOR_MAX_WORKERS) {
+        workers = LINX_EXECUTOR_MAX_WORKERS;
+    }
+    executor->max_pending = config->max_pending > 0 ? config->max_pending : LINX_EXECUTOR_DEFAULT_MAX_PENDING;
+
+    executor->inject_mutex = linx_mutex_create();
+    executor->wake = linx_sem_create(0, (unsigned int)workers);
+    bool ok = executor->inject_mutex && executor->wake;
+    for (size_t i = 0; ok && i < workers; i++) {
+        executor->workers[i].executor = executor;
+        executor->workers[i].index = (int)i;
+        executor->workers[i].mutex = linx_mutex_create();
+        ok = executor->workers[i].mutex != NULL;
+    }
+    if (!ok) {
+        LOG_ERROR("Executor creation failed: synchronization primitives unavailable");
+        linx_executor_destroy(executor);
+        return NULL;
+    }
+
+    static const linx_thread_attr_t thread_defaults = {
+        .name = "linx_exec",
+        .priority = LINX_THREAD_PRIORITY_NORMAL,
+    };
+    linx_thread_attr_t attr = linx_thread_attr_merge(&config->thread, &thread_defaults);
+    executor->worker_count = workers;
+    for (size_t i = 0; i < workers; i++) {
+        executor->workers[i].thread = linx_thread_create(&attr, linx_executor_thread, &executor->workers[i]);
+        if (!executor->workers[i].thread) {
+            LOG_ERROR("Failed to start executor worker %zu", i);
+            linx_executor_destroy(executor);
+            return NULL;
+        }
+    }
+
+    LOG_INFO("Executor started: %zu workers, %zu pending tasks max", workers, executor->max_pending);
+    return executor;
+}
+
+void linx_executor_destroy(linx_executor_t* executor) {
+    if (!executor) {
+        return;
+    }
+
+    // 在注入锁内置位：之后的提交都会看到 stopping 而失败，之前的提交已经入队，下面一并取消
+    if (executor->inject_mutex) {
+        linx_mutex_lock(executor->inject_mutex);
+    }
+    __atomic_store_n(&executor->stopping, true, __ATOMIC_RELEASE);
+    if (executor->inject_mutex) {
+        linx_mutex_unlock(executor->inject_mutex);
+    }
+    for (size_t i = 0; i < executor->worker_count; i++) {
+        linx_sem_give(executor->wake);
+    }
+    for (size_t i = 0; i < executor->worker_count; i++) {
+        if (executor->workers[i].thread) {
+            // 信号量计数有上限，逐个补发直到每个线程都醒来退出
+            linx_sem_give(executor->wake);
+            linx_thread_join(executor->workers[i].thread);
+        }
+    }
+
+    // 线程都已退出，未开始的任务以已取消的令牌调用一次
+    for (int priority = 0; priority < LINX_TASK_PRIORITY_COUNT; priority++) {
+        linx_executor_task_t* task;
+        while ((task = linx_executor_list_pop_head(&executor->inject[priority])) != NULL) {
+            linx_executor_run(executor, task, &s_shutdown_token);
+        }
+        for (size_t i = 0; i < executor->worker_count; i++) {
+            while ((task = linx_executor_list_pop_head(&executor->workers[i].deques[priority])) != NULL) {
+                linx_executor_run(executor, task, &s_shutdown_token);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < LINX_EXECUTOR_MAX_WORKERS; i++) {
+        if (executor->workers[i].mutex) {
+            linx_mutex_destroy(executor->workers[i].mutex);
+        }
+    }
+    if (executor->wake) {
+        linx_sem_destroy(executor->wake);
+    }
+    if (executor->inject_mutex) {
+        linx_mutex_destroy(executor->inject_mutex);
+    }
+    LINX_FREE(executor);
+}
+
+bool linx_executor_submit(linx_executor_t* executor, linx_task_priority_t priority,
+                          linx_task_func_t func, void* arg, linx_cancel_token_t* token) {
+    if (!executor || !func) {
+        return false;
+    }
+    if ((int)priority < 0 || priority >= LINX_TASK_PRIORITY_COUNT) {
+        priority = LINX_TASK_PRIORITY_NORMAL;
+    }
+
+    linx_executor_task_t* task = (linx_executor_task_t*)LINX_MALLOC(sizeof(linx_executor_task_t));
+    if (!task) {
+        __atomic_fetch_add(&executor->rejected, 1, __ATOMIC_RELAXED);
+        return false;
+    }
+    task->func = func;
+    task->arg = arg;
+    task->token = NULL;
+
+    // stopping 的判断和入队都在注入锁内，与销毁时置位互斥，不会在销毁取消剩余任务之后入队
+    linx_mutex_lock(executor->inject_mutex);
+    bool accepted = !__atomic_load_n(&executor->stopping, __ATOMIC_ACQUIRE);
+    if (accepted && __atomic_add_fetch(&executor->pending, 1, __ATOMIC_ACQ_REL) > executor->max_pending) {
+        __atomic_fetch_sub(&executor->pending, 1, __ATOMIC_ACQ_REL);
+        accepted = false;
+    }
+    if (!accepted) {
+        __atomic_fetch_add(&executor->rejected, 1, __ATOMIC_RELAXED);
+        linx_mutex_unlock(executor->inject_mutex);
+        LINX_FREE(task);
+        return false;
+    }
+    task->token = token ? linx_cancel_token_retain(token) : NULL;
+
+    linx_executor_worker_t* self = t_worker;
+    if (self && self->executor == executor) {
+        linx_mutex_lock(self->mutex);
+        linx_executor_list_push_tail(&self->deques[priority], task);
+        linx_mutex_unlock(self->mutex);
+    } else {
+        linx_executor_list_push_tail(&executor->inject[priority], task);
+    }
+    // 解锁后销毁可能随时完成，唤醒也在锁内
+    __atomic_fetch_add(&executor->submitted, 1, __ATOMIC_RELAXED);
+    linx_sem_give(executor->wake);
+    linx_mutex_unlock(executor->inject_mutex);
+    return true;
+}
+
+int linx_executor_current_worker(const linx_executor_t* executor) {
+    linx_executor_worker_t* self = t_worker;
+    return self && executor && self->executor == executor ? self->index : -1;
+}
+
+size_t linx_executor_worker_count(const linx_executor_t* executor) {
+    return executor ? executor->worker_count : 0;
+}
+
+bool linx_executor_get_stats(const linx_executor_t* executor, linx_executor_stats_t* stats) {
+    if (!executor || !stats) {
+        return false;
+    }
+    stats->workers = executor->worker_count;
+    stats->pending = __atomic_load_n(&executor->pending, __ATOMIC_RELAXED);
+    stats->submitted = __atomic_load_n(&executor->submitted, __ATOMIC_RELAXED);
+    stats->executed = __atomic_load_n(&executor->executed, __ATOMIC_RELAXED);
+    stats->stolen = __atomic_load_n(&executor->stolen, __ATOMIC_RELAXED);
+    stats->rejected = __atomic_load_n(&executor->rejected, __ATOMIC_RELAXED);
+    return true;
+}
+
+/* ==================== 取消令牌 ==================== */
+
+linx_cancel_token_t* linx_cancel_token_create(void) {
+    linx_cancel_token_t* token = (linx_cancel_token_t*)LINX_CALLOC(1, sizeof(linx_cancel_token_t));
+    if (token) {
+        token->refs = 1;
+    }
+    return token;
+}
+
+linx_cancel_token_t* linx_cancel_token_retain(linx_cancel_token_t* token) {
+    if (token) {
+        __atomic_fetch_add(&token->refs, 1, __ATOMIC_RELAXED);
+    }
+    return token;
+}
+
+void linx_cancel_token_release(linx_cancel_token_t* token) {
+    if (token && __atomic_sub_fetch(&token->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+        LINX_FREE(token);
+    }
+}
+
+void linx_cancel_token_cancel(linx_cancel_token_t* token) {
+    if (token) {
+        __atomic_store_n(&token->cancelled, true, __ATOMIC_RELEASE);
+    }
+}
+
+bool linx_cancel_token_is_cancelled(const linx_cancel_token_t* token) {
+    return token && __atomic_load_n(&token->cancelled, __ATOMIC_ACQUIRE);
+}
@@ -0,0 +1,136 @@
+/**
+ * @file linx_executor.h
+ * @brief 后台任务执行器
+ *
+ * SDK 的后台工作（MCP 异步工具、图像解释、OTA 校验、资源解码等）共用一组固定数量的
+ * 工作线程，不再由各模块各自创建线程。
+ *
+ * 每个工作线程有自己的双端队列：工作线程里提交的任务放在自己队列的底部并优先从底部取
+ * （刚提交的任务数据还在缓存里）；其他线程提交的任务进入共享的先进先出注入队列；
+ * 自己没有任务时先取注入队列，再从其他工作线程队列的顶部窃取最早的任务。
+ * 任务分三个优先级，取任务时总是先看完所有队列中更高优先级的任务。
+ *
+ * 取消是协作式的：提交时可以附带取消令牌，任务执行中用 linx_cancel_token_is_cancelled()
+ * 检查后自行提前结束。令牌在任务开始前已取消、或执行器销毁时任务还没开始的，任务函数
+ * 仍会被调用一次（令牌为已取消状态），用于释放参数。
+ *
+ * 提交和令牌操作可在任意线程调用。提交可以与销毁并发：销毁开始前完成入队的任务以
+ * 已取消的令牌调用一次，之后的提交返回 false；调用方需保证销毁返回后不再提交。
+ */
+
+#ifndef LINX_EXECUTOR_H
+#define LINX_EXECUTOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "os/linx_os.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** 默认工作线程数 */
+#ifndef LINX_EXECUTOR_DEFAULT_WORKERS
+#define LINX_EXECUTOR_DEFAULT_WORKERS 2
+#endif
+
+/** 默认最多未开始的任务数，超出时提交失败 */
+#ifndef LINX_EXECUTOR_DEFAULT_MAX_PENDING
+#define LINX_EXECUTOR_DEFAULT_MAX_PENDING 64
+#endif
+
+/** 工作线程数上限 */
+#define LINX_EXECUTOR_MAX_WORKERS 16
+
+typedef struct linx_executor linx_executor_t;
+typedef struct linx_cancel_token linx_cancel_token_t;
+
+/** 任务优先级 */
+typedef enum {
+    LINX_TASK_PRIORITY_HIGH = 0,        // 用户正在等待结果：MCP 工具、图像解释
+    LINX_TASK_PRIORITY_NORMAL,          // 一般后台工作
+    LINX_TASK_PRIORITY_LOW,             // 可以推迟：OTA 校验、日志压缩、资源预解码
+    LINX_TASK_PRIORITY_COUNT
+} linx_task_priority_t;
+
+/**
+ * 任务函数
+ * @param arg 提交时的参数
+ * @param token 提交时的取消令牌（未附带时为 NULL，执行器销毁时丢弃的任务为一个已取消的令牌）
+ */
+typedef void (*linx_task_func_t)(void* arg, const linx_cancel_token_t* token);
+
+/** 执行器配置；零值字段取默认值 */
+typedef struct {
+    size_t workers;                     // 工作线程数，0 为 LINX_EXECUTOR_DEFAULT_WORKERS
+    size_t max_pending;                 // 最多未开始的任务数，0 为 LINX_EXECUTOR_DEFAULT_MAX_PENDING
+    linx_thread_attr_t thread;          // 工作线程属性，默认名称 "linx_exec"、NORMAL 优先级
+} linx_executor_config_t;
+
+/** 统计 */
+typedef struct {
+    size_t workers;
+    size_t pending;                     // 未开始的任务数
+    uint64_t submitted;
+    uint64_t executed;
+    uint64_t stolen;                    // 从其他工作线程窃取执行的任务数
+    uint64_t rejected;                  // 因排队已满或正在销毁而提交失败的次数
+} linx_executor_stats_t;
+
+/**
+ * 创建执行器并启动工作线程
+ * @param config 配置，NULL 使用默认值
+ * @return 执行器实例，失败返回 NULL
+ */
+linx_executor_t* linx_executor_create(const linx_executor_config_t* config);
+
+/**
+ * 销毁执行器：等待执行中的任务返回，未开始的任务以已取消的令牌在调用线程上调用一次
+ * 不能在工作线程中调用；与其并发的提交要么入队后被取消，要么返回 false
+ */
+void linx_executor_destroy(linx_executor_t* executor);
+
+/**
+ * 提交任务
+ * @param priority 优先级
+ * @param token 取消令牌，可为 NULL；执行器持有一个引用直到任务返回
+ * @return false 表示排队已满、正在销毁或内存不足，任务不会被调用
+ */
+bool linx_executor_submit(linx_executor_t* executor, linx_task_priority_t priority,
+                          linx_task_func_t func, void* arg, linx_cancel_token_t* token);
+
+/**
+ * 调用线程在该执行器中的工作线程编号
+ * @return 0 起的编号，不是该执行器的工作线程时返回 -1
+ */
+int linx_executor_current_worker(const linx_executor_t* executor);
+
+size_t linx_executor_worker_count(const linx_executor_t* executor);
+
+bool linx_executor_get_stats(const linx_executor_t* executor, linx_executor_stats_t* stats);
+
+/* ==================== 取消令牌 ==================== */
+
+/**
+ * 创建取消令牌（引用计数为 1）
+ * @return 令牌，失败返回 NULL
+ */
+linx_cancel_token_t* linx_cancel_token_create(void);
+
+linx_cancel_token_t* linx_cancel_token_retain(linx_cancel_token_t* token);
+
+/** 释放引用，token 可为 NULL */
+void linx_cancel_token_release(linx_cancel_token_t* token);
+
+/** 请求取消（不可撤销） */
+void linx_cancel_token_cancel(linx_cancel_token_t* token);
+
+/** 是否已请求取消，token 为 NULL 时返回 false */
+bool linx_cancel_token_is_cancelled(const linx_cancel_token_t* token);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINX_EXECUTOR_H */
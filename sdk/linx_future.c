@@ -0,0 +1,249 @@
+/**
+ * @file linx_future.c
+ * @brief 异步操作句柄与无栈协程实现
+ */
+
+#include "linx_future.h"
+#include "os/linx_os.h"
+#include "log/linx_alloc.h"
+#include <string.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_CORE);
+
+struct linx_future {
+    int refs;
+    linx_mutex_t* mutex;                // 保护以下字段
+    linx_sem_t* done_sem;               // 完成时给出；等待者取到后再给出，唤醒下一个等待者
+    linx_future_state_t state;
+    int status;
+    void* data;
+    size_t size;
+    linx_future_callback_t callback;
+    void* callback_data;
+    linx_future_cancel_t cancel;
+    void* cancel_data;
+};
+
+linx_future_t* linx_future_create(void) {
+    linx_future_t* future = (linx_future_t*)LINX_CALLOC(1, sizeof(linx_future_t));
+    if (!future) {
+        return NULL;
+    }
+    future->refs = 1;
+    future->mutex = linx_mutex_create();
+    future->done_sem = linx_sem_create(0, 1);
+    if (!future->mutex || !future->done_sem) {
+        linx_future_release(future);
+        return NULL;
+    }
+    return future;
+}
+
+linx_future_t* linx_future_retain(linx_future_t* future) {
+    if (future) {
+        __atomic_fetch_add(&future->refs, 1, __ATOMIC_RELAXED);
+    }
+    return future;
+}
+
+void linx_future_release(linx_future_t* future) {
+    if (!future || __atomic_sub_fetch(&future->refs, 1, __ATOMIC_ACQ_REL) != 0) {
+        return;
+    }
+    if (future->cancel) {
+        future->cancel(future->cancel_data, false);
+    }
+    if (future->done_sem) {
+        linx_sem_destroy(future->done_sem);
+    }
+    if (future->mutex) {
+        linx_mutex_destroy(future->mutex);
+    }
+    LINX_FREE(future->data);
+    LINX_FREE(future);
+}
+
+/* 状态已改为完成或取消（调用者持有锁）：解锁后调用取消函数、唤醒等待者并调用后续回调 */
+static void linx_future_settle_unlock(linx_future_t* future) {
+    linx_future_callback_t callback = future->callback;
+    void* callback_data = future->callback_data;
+    linx_future_cancel_t cancel = future->cancel;
+    void* cancel_data = future->cancel_data;
+    bool cancelled = future->state == LINX_FUTURE_CANCELLED;
+    future->cancel = NULL;
+    linx_mutex_unlock(future->mutex);
+
+    // 底层操作在取消之后的完成会被 linx_future_complete 忽略
+    if (cancel) {
+        cancel(cancel_data, cancelled);
+    }
+    linx_sem_give(future->done_sem);
+    if (callback) {
+        callback(future, callback_data);
+    }
+}
+
+bool linx_future_complete(linx_future_t* future, int status, const void* data, size_t size) {
+    if (!future) {
+        return false;
+    }
+
+    void* copy = NULL;
+    if (data && size > 0) {
+        copy = LINX_MALLOC(size);
+        if (copy) {
+            memcpy(copy, data, size);
+        }
+    }
+
+    linx_mutex_lock(future->mutex);
+    if (future->state != LINX_FUTURE_PENDING) {
+        linx_mutex_unlock(future->mutex);
+        LINX_FREE(copy);
+        return false;
+    }
+    future->state = LINX_FUTURE_DONE;
+    future->status = status;
+    future->data = copy;
+    future->size = copy ? size : 0;
+    linx_future_settle_unlock(future);
+    return true;
+}
+
+void linx_future_set_canceller(linx_future_t* future, linx_future_cancel_t cancel, void* user_data) {
+    if (!future) {
+        return;
+    }
+    linx_mutex_lock(future->mutex);
+    linx_future_state_t state = future->state;
+    if (state == LINX_FUTURE_PENDING) {
+        future->cancel = cancel;
+        future->cancel_data = user_data;
+    }
+    linx_mutex_unlock(future->mutex);
+
+    if (state != LINX_FUTURE_PENDING && cancel) {
+        cancel(user_data, state == LINX_FUTURE_CANCELLED);
+    }
+}
+
+bool linx_future_cancel(linx_future_t* future) {
+    if (!future) {
+        return false;
+    }
+
+    linx_mutex_lock(future->mutex);
+    if (future->state != LINX_FUTURE_PENDING) {
+        linx_mutex_unlock(future->mutex);
+        return false;
+    }
+    future->state = LINX_FUTURE_CANCELLED;
+    linx_future_settle_unlock(future);
+    return true;
+}
+
+linx_future_state_t linx_future_state(const linx_future_t* future) {
+    if (!future) {
+        return LINX_FUTURE_CANCELLED;
+    }
+    linx_mutex_lock(future->mutex);
+    linx_future_state_t state = future->state;
+    linx_mutex_unlock(future->mutex);
+    return state;
+}
+
+bool linx_future_is_done(const linx_future_t* future) {
+    return linx_future_state(future) != LINX_FUTURE_PENDING;
+}
+
+int linx_future_status(const linx_future_t* future) {
+    if (!future) {
+        return 0;
+    }
+    linx_mutex_lock(future->mutex);
+    int status = future->status;
+    linx_mutex_unlock(future->mutex);
+    return status;
+}
+
+const void* linx_future_data(const linx_future_t* future, size_t* size) {
+    if (!future) {
+        if (size) {
+            *size = 0;
+        }
+        return NULL;
+    }
+    // 数据在完成时写入一次，之后不再改变
+    linx_mutex_lock(future->mutex);
+    const void* data = future->data;
+    if (size) {
+        *size = future->size;
+    }
+    linx_mutex_unlock(future->mutex);
+    return data;
+}
+
+linx_future_state_t linx_future_wait(linx_future_t* future, int timeout_ms) {
+    if (!future) {
+        return LINX_FUTURE_CANCELLED;
+    }
+    if (linx_future_is_done(future)) {
+        return linx_future_state(future);
+    }
+    if (linx_sem_take(future->done_sem, timeout_ms)) {
+        linx_sem_give(future->done_sem);
+    }
+    return linx_future_state(future);
+}
+
+bool linx_future_then(linx_future_t* future, linx_future_callback_t callback, void* user_data) {
+    if (!future || !callback) {
+        return false;
+    }
+
+    linx_mutex_lock(future->mutex);
+    if (future->callback) {
+        linx_mutex_unlock(future->mutex);
+        return false;
+    }
+    if (future->state != LINX_FUTURE_PENDING) {
+        linx_mutex_unlock(future->mutex);
+        callback(future, user_data);
+        return true;
+    }
+    future->callback = callback;
+    future->callback_data = user_data;
+    linx_mutex_unlock(future->mutex);
+    return true;
+}
+
+/* ==================== 无栈协程 ==================== */
+
+static void linx_coro_resume(linx_future_t* future, void* user_data) {
+    (void)future;
+    linx_coro_t* co = (linx_coro_t*)user_data;
+    co->func(co);
+}
+
+bool linx_coro_start(linx_coro_t* co, linx_coro_func_t func) {
+    if (!co || !func) {
+        return false;
+    }
+    co->line = 0;
+    co->func = func;
+    return func(co);
+}
+
+bool linx_coro_suspend_(linx_coro_t* co, linx_future_t* future) {
+    if (!future) {
+        return false;
+    }
+    linx_mutex_lock(future->mutex);
+    bool pending = future->state == LINX_FUTURE_PENDING && !future->callback;
+    if (pending) {
+        future->callback = linx_coro_resume;
+        future->callback_data = co;
+    }
+    linx_mutex_unlock(future->mutex);
+    return pending;
+}
@@ -0,0 +1,174 @@
+/**
+ * @file linx_future.h
+ * @brief 异步操作句柄（future）与无栈协程
+ *
+ * 耗时的操作（连接、OTA 检查/下载、图像解释等）返回一个 future，操作结束时由产生方
+ * 完成（linx_future_complete）。应用可以：
+ *   - 轮询：linx_future_is_done()
+ *   - 等待：linx_future_wait()，不能在完成它的线程（SDK 事件循环）上调用
+ *   - 设置后续回调：linx_future_then()，在完成 future 的线程上调用——SDK 操作的
+ *     future 由 SDK 事件循环完成，回调即运行在事件循环上
+ *   - 取消：linx_future_cancel()，产生方登记了取消函数时一并取消底层操作
+ *
+ * 结果是一个状态码（含义由产生方定义，0 表示成功）和一段可选的数据（完成时复制，
+ * 与 future 生命周期相同）。future 有引用计数，返回给应用的 future 用完后调用
+ * linx_future_release()。
+ *
+ * 无栈协程（C99，基于 switch 的行号续点）把多个 future 串成顺序代码，不需要嵌套
+ * 回调或手写状态机：
+ *
+ *     typedef struct { linx_coro_t co; LinxSdk* sdk; linx_future_t* f; } upgrade_t;
+ *
+ *     static bool upgrade_step(linx_coro_t* co) {
+ *         upgrade_t* u = (upgrade_t*)co;
+ *         LINX_CORO_BEGIN(co);
+ *         u->f = linx_sdk_connect_future(u->sdk);
+ *         LINX_CORO_AWAIT(co, u->f);
+ *         ...检查 linx_future_status(u->f)，linx_future_release(u->f)...
+ *         u->f = linx_sdk_ota_check_future(u->sdk);
+ *         LINX_CORO_AWAIT(co, u->f);
+ *         ...
+ *         LINX_CORO_END(co);
+ *     }
+ *
+ *     linx_coro_start(&u->co, upgrade_step);
+ *
+ * 协程函数每次从上次等待处继续执行，局部变量不会保留，跨等待使用的状态放在协程
+ * 结构体里；LINX_CORO_BEGIN/END 之间不能再使用 switch。
+ */
+
+#ifndef LINX_FUTURE_H
+#define LINX_FUTURE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct linx_future linx_future_t;
+
+/** future 状态 */
+typedef enum {
+    LINX_FUTURE_PENDING = 0,        // 尚未完成
+    LINX_FUTURE_DONE,               // 已完成，结果见 linx_future_status()/linx_future_data()
+    LINX_FUTURE_CANCELLED           // 已取消
+} linx_future_state_t;
+
+/** 后续回调 */
+typedef void (*linx_future_callback_t)(linx_future_t* future, void* user_data);
+
+/**
+ * 取消函数（产生方登记），恰好调用一次：
+ * 被取消时 cancelled 为 true，应取消底层操作；完成或未完成就被释放时为 false，只需释放 user_data
+ */
+typedef void (*linx_future_cancel_t)(void* user_data, bool cancelled);
+
+/**
+ * 创建未完成的 future（引用计数为 1）
+ * @return future，内存不足返回 NULL
+ */
+linx_future_t* linx_future_create(void);
+
+linx_future_t* linx_future_retain(linx_future_t* future);
+
+/** 释放引用，future 可为 NULL */
+void linx_future_release(linx_future_t* future);
+
+/**
+ * 完成 future 并调用后续回调（产生方调用）
+ * @param status 状态码，0 表示成功
+ * @param data 结果数据（复制），可为 NULL
+ * @param size 数据字节数
+ * @return false 表示已完成或已取消，本次结果被丢弃
+ */
+bool linx_future_complete(linx_future_t* future, int status, const void* data, size_t size);
+
+/**
+ * 登记取消底层操作的函数（产生方调用，只能登记一次）
+ * 已完成时立即以 cancelled=false 调用，已取消时立即以 cancelled=true 调用
+ */
+void linx_future_set_canceller(linx_future_t* future, linx_future_cancel_t cancel, void* user_data);
+
+/**
+ * 取消：未完成时状态变为 LINX_FUTURE_CANCELLED，调用登记的取消函数和后续回调
+ * @return false 表示已经完成或已取消
+ */
+bool linx_future_cancel(linx_future_t* future);
+
+linx_future_state_t linx_future_state(const linx_future_t* future);
+
+/** 已完成或已取消 */
+bool linx_future_is_done(const linx_future_t* future);
+
+/** 状态码（未完成时为 0） */
+int linx_future_status(const linx_future_t* future);
+
+/**
+ * 结果数据，在 future 释放前有效
+ * @param size 输出数据字节数，可为 NULL
+ * @return 没有数据时返回 NULL
+ */
+const void* linx_future_data(const linx_future_t* future, size_t* size);
+
+/**
+ * 等待完成
+ * @param timeout_ms 超时（毫秒），-1 一直等待
+ * @return 返回时的状态，超时返回 LINX_FUTURE_PENDING
+ */
+linx_future_state_t linx_future_wait(linx_future_t* future, int timeout_ms);
+
+/**
+ * 设置后续回调（每个 future 一个）
+ * 已完成时立即在调用线程上执行，否则在完成或取消 future 的线程上执行
+ * @return false 表示已经设置过
+ */
+bool linx_future_then(linx_future_t* future, linx_future_callback_t callback, void* user_data);
+
+/* ==================== 无栈协程 ==================== */
+
+typedef struct linx_coro linx_coro_t;
+
+/**
+ * 协程函数：从上次的续点继续执行
+ * @return 执行到 LINX_CORO_END 时返回 true，在等待中返回 false
+ */
+typedef bool (*linx_coro_func_t)(linx_coro_t* co);
+
+/** 协程状态，嵌入到应用的结构体开头 */
+struct linx_coro {
+    int line;                       // 续点，0 为开头，-1 为已结束
+    linx_coro_func_t func;
+};
+
+/** 从头开始执行协程，直到第一次等待或结束 */
+bool linx_coro_start(linx_coro_t* co, linx_coro_func_t func);
+
+/** 协程是否已结束 */
+static inline bool linx_coro_finished(const linx_coro_t* co) {
+    return co->line == -1;
+}
+
+/* 内部使用：future 未完成时登记恢复回调并返回 true */
+bool linx_coro_suspend_(linx_coro_t* co, linx_future_t* future);
+
+#define LINX_CORO_BEGIN(co)  switch ((co)->line) { case 0:
+
+/** 等待 future 完成或取消；future 为 NULL 时不等待，不能对设置了后续回调的 future 等待 */
+#define LINX_CORO_AWAIT(co, future)                         \
+    do {                                                    \
+        (co)->line = __LINE__;                              \
+        /* FALLTHRU */ case __LINE__:                       \
+        if (linx_coro_suspend_((co), (future))) {           \
+            return false;                                   \
+        }                                                   \
+    } while (0)
+
+#define LINX_CORO_END(co)    } (co)->line = -1; return true
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINX_FUTURE_H */
@@ -0,0 +1,313 @@
+/**
+ * @file linx_governor.c
+ * @brief 按 CPU 负载调节各模块质量的调速器实现
+ */
+
+#include "linx_governor.h"
+#include "log/linx_alloc.h"
+#include "log/linx_log.h"
+#include "os/linx_os.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_CORE);
+
+static const char* const s_knob_names[LINX_GOVERNOR_KNOB_COUNT] = {
+    [LINX_GOVERNOR_UI_FPS] = "ui_fps",
+    [LINX_GOVERNOR_ENCODER_COMPLEXITY] = "encoder_complexity",
+    [LINX_GOVERNOR_NS_STRENGTH] = "ns_strength",
+    [LINX_GOVERNOR_LOG_LEVEL] = "log_level",
+};
+
+typedef struct {
+    int levels;                     /* 0 表示未登记 */
+    int level;
+    linx_governor_apply_t apply;
+    void* user_data;
+} linx_governor_knob_t;
+
+struct linx_governor {
+    linx_governor_config_t config;
+    pthread_mutex_t mutex;
+    linx_governor_knob_t knobs[LINX_GOVERNOR_KNOB_COUNT];
+
+    uint64_t next_sample_ms;        /* 0 表示尚未采样 */
+    uint64_t last_misses;
+    bool misses_valid;
+    unsigned int pressure;          /* 连续压力次数 */
+    unsigned int calm;              /* 连续空闲次数 */
+
+    /* 平台默认的 CPU 负载采样基准 */
+    uint64_t cpu_busy;
+    uint64_t cpu_total;
+    bool cpu_valid;
+
+    linx_governor_stats_t stats;
+};
+
+/* ============================================================================
+ * CPU 负载
+ * ============================================================================ */
+
+/* 读取累计的忙碌时间和总时间，单位由平台决定，只用于求比值 */
+static bool linx_governor_read_cpu(uint64_t* busy, uint64_t* total) {
+#if defined(__linux__)
+    FILE* fp = fopen("/proc/stat", "r");
+    if (!fp) {
+        return false;
+    }
+    unsigned long long user = 0, nice = 0, system = 0, idle = 0, iowait = 0, irq = 0, softirq = 0, steal = 0;
+    int n = fscanf(fp, "cpu %llu %llu %llu %llu %llu %llu %llu %llu",
+                   &user, &nice, &system, &idle, &iowait, &irq, &softirq, &steal);
+    fclose(fp);
+    if (n < 4) {
+        return false;
+    }
+    *busy = user + nice + system + irq + softirq + steal;
+    *total = *busy + idle + iowait;
+    return true;
+#elif defined(__unix__) || defined(__APPLE__)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return false;
+    }
+    *busy = (uint64_t)usage.ru_utime.tv_sec * 1000000 + (uint64_t)usage.ru_utime.tv_usec +
+            (uint64_t)usage.ru_stime.tv_sec * 1000000 + (uint64_t)usage.ru_stime.tv_usec;
+    *total = linx_os_now_us();
+    return true;
+#else
+    (void)busy;
+    (void)total;
+    return false;
+#endif
+}
+
+static int linx_governor_cpu_permille(linx_governor_t* governor) {
+    if (governor->config.cpu_load) {
+        return governor->config.cpu_load(governor->config.cpu_load_user_data);
+    }
+
+    uint64_t busy, total;
+    if (!linx_governor_read_cpu(&busy, &total)) {
+        return -1;
+    }
+    int permille = -1;
+    if (governor->cpu_valid && total > governor->cpu_total && busy >= governor->cpu_busy) {
+        uint64_t load = (busy - governor->cpu_busy) * 1000 / (total - governor->cpu_total);
+        permille = load > 1000 ? 1000 : (int)load;
+    }
+    governor->cpu_busy = busy;
+    governor->cpu_total = total;
+    governor->cpu_valid = true;
+    return permille;
+}
+
+/* ============================================================================
+ * 档位调整（持有 mutex）
+ * ============================================================================ */
+
+static bool linx_governor_step(linx_governor_t* governor, int direction) {
+    // 降级从前往后找第一个还能降的调节项，恢复从后往前找第一个降过的
+    for (int i = 0; i < LINX_GOVERNOR_KNOB_COUNT; i++) {
+        int index = direction < 0 ? i : LINX_GOVERNOR_KNOB_COUNT - 1 - i;
+        linx_governor_knob_t* knob = &governor->knobs[index];
+        int target = knob->level - direction;
+        if (knob->levels == 0 || target < 0 || target > knob->levels) {
+            continue;
+        }
+        if (!knob->apply(knob->user_data, target)) {
+            // 降级时换下一个调节项；恢复失败时保持原档位，下次再试
+            LOG_WARN("质量调速: %s 切换到 %d 级失败", s_knob_names[index], target);
+            if (direction < 0) {
+                continue;
+            }
+            return false;
+        }
+        knob->level = target;
+        governor->stats.knob_levels[index] = target;
+        governor->stats.level -= direction;
+        LOG_INFO("质量调速: %s %s到 %d/%d 级 (总档位 %d, CPU %d‰)", s_knob_names[index],
+                 direction < 0 ? "降" : "恢复", target, knob->levels, governor->stats.level,
+                 governor->stats.cpu_permille);
+        return true;
+    }
+    return false;
+}
+
+/* ============================================================================
+ * 公共接口
+ * ============================================================================ */
+
+linx_governor_t* linx_governor_create(const linx_governor_config_t* config) {
+    linx_governor_config_t defaults = {0};
+    if (config) {
+        defaults = *config;
+    }
+    if (defaults.interval_ms == 0) {
+        defaults.interval_ms = LINX_GOVERNOR_DEFAULT_INTERVAL_MS;
+    }
+    if (defaults.high_permille == 0) {
+        defaults.high_permille = LINX_GOVERNOR_DEFAULT_HIGH_PERMILLE;
+    }
+    if (defaults.low_permille == 0) {
+        defaults.low_permille = LINX_GOVERNOR_DEFAULT_LOW_PERMILLE;
+    }
+    if (defaults.degrade_samples == 0) {
+        defaults.degrade_samples = LINX_GOVERNOR_DEFAULT_DEGRADE_SAMPLES;
+    }
+    if (defaults.restore_samples == 0) {
+        defaults.restore_samples = LINX_GOVERNOR_DEFAULT_RESTORE_SAMPLES;
+    }
+    if (defaults.high_permille > 1000 || defaults.low_permille >= defaults.high_permille) {
+        LOG_ERROR("质量调速阈值无效: 低 %u‰, 高 %u‰", defaults.low_permille, defaults.high_permille);
+        return NULL;
+    }
+
+    linx_governor_t* governor = (linx_governor_t*)LINX_CALLOC(1, sizeof(linx_governor_t));
+    if (!governor) {
+        return NULL;
+    }
+    governor->config = defaults;
+    governor->stats.cpu_permille = -1;
+    pthread_mutex_init(&governor->mutex, NULL);
+    return governor;
+}
+
+void linx_governor_destroy(linx_governor_t* governor) {
+    if (!governor) {
+        return;
+    }
+    pthread_mutex_destroy(&governor->mutex);
+    LINX_FREE(governor);
+}
+
+bool linx_governor_set_knob(linx_governor_t* governor, linx_governor_knob_id_t knob, int levels,
+                            linx_governor_apply_t apply, void* user_data) {
+    if (!governor || (unsigned)knob >= LINX_GOVERNOR_KNOB_COUNT || levels < 0 ||
+        levels > LINX_GOVERNOR_MAX_LEVELS || (levels > 0 && !apply)) {
+        return false;
+    }
+
+    pthread_mutex_lock(&governor->mutex);
+    linx_governor_knob_t* slot = &governor->knobs[knob];
+    if (slot->levels > 0 && slot->level > 0) {
+        slot->apply(slot->user_data, 0);
+        governor->stats.level -= slot->level;
+    }
+    governor->stats.max_level += levels - slot->levels;
+    slot->levels = levels;
+    slot->level = 0;
+    slot->apply = levels > 0 ? apply : NULL;
+    slot->user_data = levels > 0 ? user_data : NULL;
+    governor->stats.knob_levels[knob] = 0;
+    pthread_mutex_unlock(&governor->mutex);
+    return true;
+}
+
+int linx_governor_sample(linx_governor_t* governor, uint64_t now_ms, uint64_t deadline_misses) {
+    if (!governor) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&governor->mutex);
+    if (governor->next_sample_ms != 0 && now_ms < governor->next_sample_ms) {
+        pthread_mutex_unlock(&governor->mutex);
+        return 0;
+    }
+    governor->next_sample_ms = now_ms + governor->config.interval_ms;
+
+    int cpu = linx_governor_cpu_permille(governor);
+    bool missed = governor->misses_valid && deadline_misses > governor->last_misses;
+    governor->last_misses = deadline_misses;
+    governor->misses_valid = true;
+    governor->stats.cpu_permille = cpu;
+    governor->stats.samples++;
+
+    int direction = 0;
+    if (missed) {
+        // 音频已经超时，不等负载确认
+        governor->pressure = 0;
+        governor->calm = 0;
+        if (linx_governor_step(governor, -1)) {
+            governor->stats.deadline_degrades++;
+            direction = -1;
+        }
+    } else if (cpu > (int)governor->config.high_permille) {
+        governor->calm = 0;
+        if (++governor->pressure >= governor->config.degrade_samples) {
+            governor->pressure = 0;
+            if (linx_governor_step(governor, -1)) {
+                direction = -1;
+            }
+        }
+    } else if (cpu < (int)governor->config.low_permille) {
+        // 负载未知时没有超时也算空闲
+        governor->pressure = 0;
+        if (++governor->calm >= governor->config.restore_samples) {
+            governor->calm = 0;
+            if (linx_governor_step(governor, 1)) {
+                direction = 1;
+            }
+        }
+    } else {
+        governor->pressure = 0;
+        governor->calm = 0;
+    }
+
+    if (direction < 0) {
+        governor->stats.degrades++;
+    } else if (direction > 0) {
+        governor->stats.restores++;
+    }
+    pthread_mutex_unlock(&governor->mutex);
+    return direction;
+}
+
+int linx_governor_next_timeout_ms(linx_governor_t* governor, uint64_t now_ms) {
+    if (!governor) {
+        return -1;
+    }
+    pthread_mutex_lock(&governor->mutex);
+    uint64_t next = governor->next_sample_ms;
+    pthread_mutex_unlock(&governor->mutex);
+    if (next <= now_ms) {
+        return 0;
+    }
+    uint64_t wait = next - now_ms;
+    return wait > (uint64_t)INT32_MAX ? INT32_MAX : (int)wait;
+}
+
+void linx_governor_reset(linx_governor_t* governor) {
+    if (!governor) {
+        return;
+    }
+    pthread_mutex_lock(&governor->mutex);
+    while (governor->stats.level > 0 && linx_governor_step(governor, 1)) {
+    }
+    governor->pressure = 0;
+    governor->calm = 0;
+    pthread_mutex_unlock(&governor->mutex);
+}
+
+void linx_governor_get_stats(linx_governor_t* governor, linx_governor_stats_t* stats) {
+    if (!stats) {
+        return;
+    }
+    if (!governor) {
+        memset(stats, 0, sizeof(*stats));
+        stats->cpu_permille = -1;
+        return;
+    }
+    pthread_mutex_lock(&governor->mutex);
+    *stats = governor->stats;
+    pthread_mutex_unlock(&governor->mutex);
+}
+
+const char* linx_governor_knob_name(linx_governor_knob_id_t knob) {
+    return (unsigned)knob < LINX_GOVERNOR_KNOB_COUNT ? s_knob_names[knob] : "unknown";
+}
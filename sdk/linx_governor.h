@@ -0,0 +1,159 @@
+/**
+ * @file linx_governor.h
+ * @brief 按 CPU 负载调节各模块质量的调速器
+ *
+ * 单核板子上 Opus 编码、回声消除/降噪、LVGL 刷新和日志输出共用一个核，瞬时负载
+ * 升高时最先出问题的是音频周期超时（卡顿）。调速器定期采样 CPU 负载和音频线程的
+ * 周期超时次数，压力持续时按固定顺序逐级降低质量，负载回落并保持一段时间后按
+ * 相反顺序逐级恢复：
+ *
+ *   界面帧率 -> 编码复杂度 -> 降噪强度 -> 日志级别
+ *
+ * 每个调节项（knob）有若干级，0 级为原始质量。总档位 = 各调节项级数之和，档位每变化
+ * 一级只改变一个调节项：降级时先把前面的调节项降到底，再降下一个；恢复时先恢复最后
+ * 降下的。没有登记的调节项跳过。
+ *
+ * 迟滞：CPU 负载超过 high_permille 连续 degrade_samples 次才降一级；出现周期超时时
+ * 立即降一级（音频余量已经用完）。负载低于 low_permille 且没有超时连续 restore_samples
+ * 次才恢复一级。每次调整后连续计数重新开始；负载在两个阈值之间时保持当前档位。
+ *
+ * CPU 负载默认在 Linux 上读 /proc/stat（整机），其他 POSIX 系统用 getrusage()
+ * （本进程），其余平台（如 FreeRTOS）需要通过 cpu_load 回调提供，否则只按周期
+ * 超时调节。
+ *
+ * 线程安全：全部函数可在任意线程调用；调节回调在 linx_governor_sample() 的调用
+ * 线程上、持有调速器锁时执行，不能再调用本调速器的函数。
+ */
+
+#ifndef LINX_GOVERNOR_H
+#define LINX_GOVERNOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** 默认值 */
+#define LINX_GOVERNOR_DEFAULT_INTERVAL_MS 1000
+#define LINX_GOVERNOR_DEFAULT_HIGH_PERMILLE 850
+#define LINX_GOVERNOR_DEFAULT_LOW_PERMILLE 600
+#define LINX_GOVERNOR_DEFAULT_DEGRADE_SAMPLES 2
+#define LINX_GOVERNOR_DEFAULT_RESTORE_SAMPLES 10
+
+/** 一个调节项最多的级数 */
+#define LINX_GOVERNOR_MAX_LEVELS 8
+
+/**
+ * @brief 调节项，按降级顺序排列
+ */
+typedef enum {
+    LINX_GOVERNOR_UI_FPS = 0,               ///< 界面刷新和动画帧率（见 linx_ui_governor_apply()）
+    LINX_GOVERNOR_ENCODER_COMPLEXITY,       ///< 上行 Opus 编码复杂度
+    LINX_GOVERNOR_NS_STRENGTH,              ///< 上行降噪强度，最后一级直通
+    LINX_GOVERNOR_LOG_LEVEL,                ///< 日志级别提高到 WARN，减少格式化和输出
+    LINX_GOVERNOR_KNOB_COUNT
+} linx_governor_knob_id_t;
+
+/**
+ * @brief 调节回调：切换到 level 级（0 为原始质量）
+ * @return 已生效返回 true；返回 false 时降级改试下一个调节项，恢复保持原档位
+ */
+typedef bool (*linx_governor_apply_t)(void* user_data, int level);
+
+/**
+ * @brief CPU 负载回调
+ * @return 上次调用以来的负载（千分比，0-1000），未知返回 -1
+ */
+typedef int (*linx_governor_cpu_load_t)(void* user_data);
+
+/**
+ * @brief 调速器配置（字段为 0 时使用默认值）
+ */
+typedef struct {
+    uint32_t interval_ms;                   ///< 采样周期（毫秒），默认 1000
+    uint16_t high_permille;                 ///< 高于此负载算作压力（千分比），默认 850
+    uint16_t low_permille;                  ///< 低于此负载算作空闲（千分比），默认 600，须小于 high_permille
+    uint8_t degrade_samples;                ///< 连续几次压力后降一级，默认 2
+    uint8_t restore_samples;                ///< 连续几次空闲后恢复一级，默认 10
+    linx_governor_cpu_load_t cpu_load;      ///< CPU 负载来源，NULL 使用平台默认
+    void* cpu_load_user_data;
+} linx_governor_config_t;
+
+/**
+ * @brief 调速器统计
+ */
+typedef struct {
+    int level;                              ///< 当前总档位，0 为原始质量
+    int max_level;                          ///< 登记的调节项级数之和
+    int knob_levels[LINX_GOVERNOR_KNOB_COUNT]; ///< 各调节项的当前级
+    int cpu_permille;                       ///< 最近一次采样的 CPU 负载，未知为 -1
+    uint64_t samples;                       ///< 采样次数
+    uint64_t degrades;                      ///< 降级次数
+    uint64_t restores;                      ///< 恢复次数
+    uint64_t deadline_degrades;             ///< 其中因周期超时立即降级的次数
+} linx_governor_stats_t;
+
+typedef struct linx_governor linx_governor_t;
+
+/**
+ * @brief 创建调速器
+ * @param config 配置，NULL 全部取默认值
+ * @return 调速器实例，配置无效或内存不足返回 NULL
+ */
+linx_governor_t* linx_governor_create(const linx_governor_config_t* config);
+
+/**
+ * @brief 销毁调速器（不恢复各调节项，需要时先调用 linx_governor_reset()）
+ */
+void linx_governor_destroy(linx_governor_t* governor);
+
+/**
+ * @brief 登记或替换调节项
+ *
+ * 替换或取消（levels 为 0）已降级的调节项时先把它恢复到 0 级。
+ *
+ * @param levels 级数（不含 0 级），0 取消登记，最多 LINX_GOVERNOR_MAX_LEVELS
+ * @return 成功返回 true
+ */
+bool linx_governor_set_knob(linx_governor_t* governor, linx_governor_knob_id_t knob, int levels,
+                            linx_governor_apply_t apply, void* user_data);
+
+/**
+ * @brief 采样一次，到了采样周期时判定并按需调整一级
+ *
+ * 通常在事件循环的每次迭代中调用，未到采样周期时只比较一次时间。
+ *
+ * @param now_ms 单调时钟（毫秒）
+ * @param deadline_misses 音频线程周期超时的累计次数（如 LINX_METRIC_DEADLINE_MISSES）
+ * @return 本次调整的方向：-1 降级，1 恢复，0 不变
+ */
+int linx_governor_sample(linx_governor_t* governor, uint64_t now_ms, uint64_t deadline_misses);
+
+/**
+ * @brief 距下一次采样的时间（毫秒），用作事件循环的等待上限
+ */
+int linx_governor_next_timeout_ms(linx_governor_t* governor, uint64_t now_ms);
+
+/**
+ * @brief 全部调节项恢复到 0 级
+ */
+void linx_governor_reset(linx_governor_t* governor);
+
+/**
+ * @brief 获取统计
+ */
+void linx_governor_get_stats(linx_governor_t* governor, linx_governor_stats_t* stats);
+
+/**
+ * @brief 调节项在日志和 JSON 中的名称
+ */
+const char* linx_governor_knob_name(linx_governor_knob_id_t knob);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LINX_GOVERNOR_H
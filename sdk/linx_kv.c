@@ -0,0 +1,811 @@
+/**
+ * @file linx_kv.c
+ * @brief 日志结构的键值存储实现
+ *
+ * 布局：区域平分为两个存储体，每个存储体开头是 16 字节的头部，之后是按 4 字节对齐的记录：
+ *
+ *   头部  [magic 4B "LKV1"][generation 4B][0xFFFFFFFF][crc32 4B]
+ *   记录  [magic 2B 0x4B56][flags 1B][key_len 1B][value_len 2B][0xFFFF][crc32 4B][key][value][0xFF 填充]
+ *
+ * 两个存储体都有效时 generation 较新的一个为当前存储体。记录的 crc32 覆盖头部前 8 字节、
+ * 键和值；flags 的 bit0 表示删除。
+ */
+
+#include "linx_kv.h"
+#include "log/linx_alloc.h"
+#include "log/linx_log.h"
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(ESP_PLATFORM)
+#include "esp_partition.h"
+#endif
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_CORE);
+
+#define KV_BANK_MAGIC           0x31564B4Cu     // "LKV1"
+#define KV_BANK_HEADER_SIZE     16
+#define KV_RECORD_MAGIC         0x4B56u
+#define KV_RECORD_HEADER_SIZE   12
+#define KV_RECORD_DELETED       0x01
+#define KV_ALIGN(n)             (((n) + 3) & ~(size_t)3)
+#define KV_FILE_DEFAULT_SIZE    (16 * 1024)
+#define KV_FILE_SECTOR_SIZE     4096
+
+typedef struct {
+    char key[LINX_KV_MAX_KEY + 1];
+    uint8_t* value;
+    size_t length;
+    size_t capacity;
+    bool present;                   // false 为已删除，删除记录写入后移除
+    bool dirty;                     // 待写入
+    uint32_t batch;                 // 最近一次写入所在的批次，写入失败时据此重新标记
+} kv_entry_t;
+
+struct linx_kv {
+    linx_kv_backend_t backend;
+    linx_kv_config_t config;
+    size_t bank_size;
+
+    pthread_mutex_t mutex;          // 保护键值和统计
+    pthread_mutex_t io_mutex;       // 串行化写入，持有期间不持有 mutex 做 I/O
+    kv_entry_t* entries;
+    size_t count;
+    size_t capacity;
+    size_t pending_bytes;           // 上次写入之后写入的记录字节数（估计值）
+
+    // 以下由 io_mutex 保护
+    int bank;                       // 当前存储体
+    uint32_t generation;
+    size_t tail;                    // 当前存储体中下一条记录的位置
+    bool tail_dirty;                // 末尾有半条记录，下次写入前先压缩
+    uint8_t* buffer;                // 一个存储体大小的批量写入缓冲区
+    uint32_t batch_id;
+
+    linx_sem_t* wake;
+    linx_thread_t* thread;
+    bool stopping;
+
+    linx_kv_stats_t stats;
+};
+
+/* ==================== 工具 ==================== */
+
+static uint32_t kv_crc32(uint32_t crc, const void* data, size_t length) {
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+    };
+    const uint8_t* p = (const uint8_t*)data;
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++) {
+        crc = table[(crc ^ p[i]) & 0x0F] ^ (crc >> 4);
+        crc = table[(crc ^ (p[i] >> 4)) & 0x0F] ^ (crc >> 4);
+    }
+    return ~crc;
+}
+
+static void kv_put16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void kv_put32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint16_t kv_get16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t kv_get32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static size_t kv_record_size(size_t key_length, size_t value_length) {
+    return KV_ALIGN(KV_RECORD_HEADER_SIZE + key_length + value_length);
+}
+
+/* 序列化一条记录，返回占用的字节数（填充为 0xFF，不改变已擦除的 flash） */
+static size_t kv_encode_record(uint8_t* out, const kv_entry_t* entry) {
+    size_t key_length = strlen(entry->key);
+    size_t value_length = entry->present ? entry->length : 0;
+    size_t size = kv_record_size(key_length, value_length);
+    kv_put16(out, KV_RECORD_MAGIC);
+    out[2] = entry->present ? 0 : KV_RECORD_DELETED;
+    out[3] = (uint8_t)key_length;
+    kv_put16(out + 4, (uint16_t)value_length);
+    kv_put16(out + 6, 0xFFFF);
+    memcpy(out + KV_RECORD_HEADER_SIZE, entry->key, key_length);
+    if (value_length > 0) {
+        memcpy(out + KV_RECORD_HEADER_SIZE + key_length, entry->value, value_length);
+    }
+    memset(out + KV_RECORD_HEADER_SIZE + key_length + value_length, 0xFF,
+           size - KV_RECORD_HEADER_SIZE - key_length - value_length);
+    uint32_t crc = kv_crc32(0, out, 8);
+    crc = kv_crc32(crc, out + KV_RECORD_HEADER_SIZE, key_length + value_length);
+    kv_put32(out + 8, crc);
+    return size;
+}
+
+static bool kv_is_erased(const uint8_t* p, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        if (p[i] != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* ==================== RAM 中的键值（持 mutex） ==================== */
+
+static kv_entry_t* kv_find(linx_kv_t* kv, const char* key) {
+    for (size_t i = 0; i < kv->count; i++) {
+        if (strcmp(kv->entries[i].key, key) == 0) {
+            return &kv->entries[i];
+        }
+    }
+    return NULL;
+}
+
+static kv_entry_t* kv_find_or_add(linx_kv_t* kv, const char* key) {
+    kv_entry_t* entry = kv_find(kv, key);
+    if (entry) {
+        return entry;
+    }
+    if (kv->count == kv->capacity) {
+        size_t capacity = kv->capacity ? kv->capacity * 2 : 16;
+        kv_entry_t* entries = (kv_entry_t*)LINX_REALLOC(kv->entries, capacity * sizeof(kv_entry_t));
+        if (!entries) {
+            return NULL;
+        }
+        kv->entries = entries;
+        kv->capacity = capacity;
+    }
+    entry = &kv->entries[kv->count++];
+    memset(entry, 0, sizeof(*entry));
+    snprintf(entry->key, sizeof(entry->key), "%s", key);
+    return entry;
+}
+
+static bool kv_assign(kv_entry_t* entry, const void* value, size_t length) {
+    if (length > entry->capacity) {
+        uint8_t* buffer = (uint8_t*)LINX_REALLOC(entry->value, length);
+        if (!buffer) {
+            return false;
+        }
+        entry->value = buffer;
+        entry->capacity = length;
+    }
+    if (length > 0) {
+        memcpy(entry->value, value, length);
+    }
+    entry->length = length;
+    entry->present = true;
+    return true;
+}
+
+/* 移除已写入的删除记录 */
+static void kv_drop_deleted(linx_kv_t* kv) {
+    size_t i = 0;
+    while (i < kv->count) {
+        kv_entry_t* entry = &kv->entries[i];
+        if (!entry->present && !entry->dirty) {
+            LINX_FREE(entry->value);
+            kv->entries[i] = kv->entries[--kv->count];
+        } else {
+            i++;
+        }
+    }
+}
+
+/* 写入失败：这一批中之后没有再改动的键重新标记为待写入 */
+static void kv_remark_batch(linx_kv_t* kv, uint32_t batch) {
+    for (size_t i = 0; i < kv->count; i++) {
+        if (kv->entries[i].batch == batch) {
+            kv->entries[i].dirty = true;
+        }
+    }
+}
+
+/* ==================== 存储体 ==================== */
+
+static size_t kv_bank_offset(const linx_kv_t* kv, int bank) {
+    return (size_t)bank * kv->bank_size;
+}
+
+static bool kv_read_header(linx_kv_t* kv, int bank, uint32_t* generation) {
+    uint8_t header[KV_BANK_HEADER_SIZE];
+    if (!kv->backend.read(kv->backend.user_data, kv_bank_offset(kv, bank), header, sizeof(header))) {
+        return false;
+    }
+    if (kv_get32(header) != KV_BANK_MAGIC || kv_get32(header + 12) != kv_crc32(0, header, 8)) {
+        return false;
+    }
+    *generation = kv_get32(header + 4);
+    return true;
+}
+
+static bool kv_write_header(linx_kv_t* kv, int bank, uint32_t generation) {
+    uint8_t header[KV_BANK_HEADER_SIZE];
+    kv_put32(header, KV_BANK_MAGIC);
+    kv_put32(header + 4, generation);
+    kv_put32(header + 8, 0xFFFFFFFFu);
+    kv_put32(header + 12, kv_crc32(0, header, 8));
+    return kv->backend.write(kv->backend.user_data, kv_bank_offset(kv, bank), header, sizeof(header));
+}
+
+static bool kv_sync(linx_kv_t* kv) {
+    return !kv->backend.sync || kv->backend.sync(kv->backend.user_data);
+}
+
+/* 扫描当前存储体，重建键值并定位末尾 */
+static bool kv_scan(linx_kv_t* kv) {
+    uint8_t* data = kv->buffer;
+    if (!kv->backend.read(kv->backend.user_data, kv_bank_offset(kv, kv->bank), data, kv->bank_size)) {
+        return false;
+    }
+
+    size_t pos = KV_BANK_HEADER_SIZE;
+    while (pos + KV_RECORD_HEADER_SIZE <= kv->bank_size) {
+        const uint8_t* rec = data + pos;
+        if (kv_is_erased(rec, KV_RECORD_HEADER_SIZE)) {
+            break;
+        }
+        size_t key_length = rec[3];
+        size_t value_length = kv_get16(rec + 4);
+        size_t size = kv_record_size(key_length, value_length);
+        if (kv_get16(rec) != KV_RECORD_MAGIC || key_length == 0 || key_length > LINX_KV_MAX_KEY ||
+            pos + size > kv->bank_size) {
+            kv->tail_dirty = true;
+            break;
+        }
+        uint32_t crc = kv_crc32(0, rec, 8);
+        crc = kv_crc32(crc, rec + KV_RECORD_HEADER_SIZE, key_length + value_length);
+        if (crc != kv_get32(rec + 8)) {
+            kv->tail_dirty = true;
+            break;
+        }
+
+        char key[LINX_KV_MAX_KEY + 1];
+        memcpy(key, rec + KV_RECORD_HEADER_SIZE, key_length);
+        key[key_length] = '\0';
+        kv_entry_t* entry = kv_find_or_add(kv, key);
+        if (!entry) {
+            return false;
+        }
+        if (rec[2] & KV_RECORD_DELETED) {
+            entry->present = false;
+        } else if (!kv_assign(entry, rec + KV_RECORD_HEADER_SIZE + key_length, value_length)) {
+            return false;
+        }
+        pos += size;
+    }
+    kv->tail = pos;
+    kv_drop_deleted(kv);
+    if (kv->tail_dirty) {
+        LOG_WARN("键值存储末尾有不完整的记录（%zu 字节处），下次写入时压缩", pos);
+    }
+    return true;
+}
+
+static bool kv_format(linx_kv_t* kv) {
+    if (!kv->backend.erase(kv->backend.user_data, kv_bank_offset(kv, 0), kv->bank_size) ||
+        !kv_write_header(kv, 0, 1) || !kv_sync(kv)) {
+        return false;
+    }
+    kv->bank = 0;
+    kv->generation = 1;
+    kv->tail = KV_BANK_HEADER_SIZE;
+    kv->tail_dirty = false;
+    return true;
+}
+
+static bool kv_mount(linx_kv_t* kv) {
+    uint32_t generation[2];
+    bool valid[2];
+    for (int bank = 0; bank < 2; bank++) {
+        valid[bank] = kv_read_header(kv, bank, &generation[bank]);
+    }
+    if (!valid[0] && !valid[1]) {
+        LOG_INFO("键值存储为空，格式化（%zu 字节 x 2）", kv->bank_size);
+        return kv_format(kv);
+    }
+    if (valid[0] && valid[1]) {
+        kv->bank = (int32_t)(generation[1] - generation[0]) > 0 ? 1 : 0;
+    } else {
+        kv->bank = valid[1] ? 1 : 0;
+    }
+    kv->generation = generation[kv->bank];
+    return kv_scan(kv);
+}
+
+/* ==================== 写入 ==================== */
+
+/* 把所有键写入另一个存储体：先写记录，最后写头部（调用方持 io_mutex，不持 mutex） */
+static bool kv_compact(linx_kv_t* kv) {
+    uint8_t* out = kv->buffer;
+    size_t capacity = kv->bank_size - KV_BANK_HEADER_SIZE;
+    size_t length = 0;
+    uint32_t batch = ++kv->batch_id;
+
+    pthread_mutex_lock(&kv->mutex);
+    for (size_t i = 0; i < kv->count; i++) {
+        kv_entry_t* entry = &kv->entries[i];
+        if (entry->dirty) {
+            entry->dirty = false;
+            entry->batch = batch;
+        }
+        if (!entry->present) {
+            continue;
+        }
+        size_t size = kv_record_size(strlen(entry->key), entry->length);
+        if (length + size > capacity) {
+            kv_remark_batch(kv, batch);
+            pthread_mutex_unlock(&kv->mutex);
+            LOG_ERROR("键值存储放不下所有有效的键（存储体 %zu 字节）", kv->bank_size);
+            return false;
+        }
+        length += kv_encode_record(out + length, entry);
+    }
+    kv->pending_bytes = 0;
+    pthread_mutex_unlock(&kv->mutex);
+
+    int target = 1 - kv->bank;
+    size_t base = kv_bank_offset(kv, target);
+    bool ok = kv->backend.erase(kv->backend.user_data, base, kv->bank_size) &&
+              (length == 0 || kv->backend.write(kv->backend.user_data, base + KV_BANK_HEADER_SIZE, out, length)) &&
+              kv_sync(kv) && kv_write_header(kv, target, kv->generation + 1) && kv_sync(kv);
+
+    pthread_mutex_lock(&kv->mutex);
+    if (ok) {
+        kv->bank = target;
+        kv->generation++;
+        kv->tail = KV_BANK_HEADER_SIZE + length;
+        kv->tail_dirty = false;
+        kv_drop_deleted(kv);
+        kv->stats.compactions++;
+        kv->stats.bytes_written += length + KV_BANK_HEADER_SIZE;
+    } else {
+        kv_remark_batch(kv, batch);
+        kv->stats.errors++;
+    }
+    pthread_mutex_unlock(&kv->mutex);
+
+    if (ok) {
+        LOG_INFO("键值存储已压缩到存储体 %d：%zu 字节有效", target, length);
+    } else {
+        LOG_ERROR("键值存储压缩失败");
+    }
+    return ok;
+}
+
+bool linx_kv_flush(linx_kv_t* kv) {
+    if (!kv) {
+        return false;
+    }
+    pthread_mutex_lock(&kv->io_mutex);
+
+    // 收集待写入的记录
+    pthread_mutex_lock(&kv->mutex);
+    size_t length = 0;
+    size_t records = 0;
+    for (size_t i = 0; i < kv->count; i++) {
+        if (kv->entries[i].dirty) {
+            length += kv_record_size(strlen(kv->entries[i].key), kv->entries[i].present ? kv->entries[i].length : 0);
+            records++;
+        }
+    }
+    bool compact = kv->tail_dirty || kv->tail + length > kv->bank_size;
+    if (records == 0 && !kv->tail_dirty) {
+        pthread_mutex_unlock(&kv->mutex);
+        pthread_mutex_unlock(&kv->io_mutex);
+        return true;
+    }
+    if (compact) {
+        pthread_mutex_unlock(&kv->mutex);
+        bool ok = kv_compact(kv);
+        pthread_mutex_lock(&kv->mutex);
+        if (ok) {
+            kv->stats.flushes++;
+            kv->stats.records_written += records;
+        }
+        pthread_mutex_unlock(&kv->mutex);
+        pthread_mutex_unlock(&kv->io_mutex);
+        return ok;
+    }
+
+    uint32_t batch = ++kv->batch_id;
+    size_t offset = 0;
+    for (size_t i = 0; i < kv->count; i++) {
+        kv_entry_t* entry = &kv->entries[i];
+        if (entry->dirty) {
+            offset += kv_encode_record(kv->buffer + offset, entry);
+            entry->dirty = false;
+            entry->batch = batch;
+        }
+    }
+    kv->pending_bytes = 0;
+    pthread_mutex_unlock(&kv->mutex);
+
+    // 一批记录一次写入、一次同步
+    bool ok = kv->backend.write(kv->backend.user_data, kv_bank_offset(kv, kv->bank) + kv->tail, kv->buffer, length) &&
+              kv_sync(kv);
+
+    pthread_mutex_lock(&kv->mutex);
+    if (ok) {
+        kv->tail += length;
+        kv_drop_deleted(kv);
+        kv->stats.flushes++;
+        kv->stats.records_written += records;
+        kv->stats.bytes_written += length;
+    } else {
+        // 可能写了一部分，末尾不再可信
+        kv->tail_dirty = true;
+        kv_remark_batch(kv, batch);
+        kv->stats.errors++;
+    }
+    pthread_mutex_unlock(&kv->mutex);
+    pthread_mutex_unlock(&kv->io_mutex);
+
+    if (!ok) {
+        LOG_ERROR("键值存储写入失败（%zu 条记录），下次重试", records);
+    }
+    return ok;
+}
+
+static void* kv_flush_thread(void* arg) {
+    linx_kv_t* kv = (linx_kv_t*)arg;
+    while (!__atomic_load_n(&kv->stopping, __ATOMIC_ACQUIRE)) {
+        linx_sem_take(kv->wake, kv->config.flush_interval_ms);
+        if (__atomic_load_n(&kv->stopping, __ATOMIC_ACQUIRE)) {
+            break;
+        }
+        linx_kv_flush(kv);
+    }
+    return NULL;
+}
+
+/* ==================== 接口 ==================== */
+
+linx_kv_t* linx_kv_open(const linx_kv_backend_t* backend, const linx_kv_config_t* config) {
+    if (!backend || !backend->read || !backend->write || !backend->erase || backend->sector_size == 0 ||
+        backend->size < 2 * backend->sector_size) {
+        LOG_ERROR("键值存储参数无效");
+        return NULL;
+    }
+
+    linx_kv_t* kv = (linx_kv_t*)LINX_CALLOC(1, sizeof(linx_kv_t));
+    if (!kv) {
+        return NULL;
+    }
+    kv->backend = *backend;
+    if (config) {
+        kv->config = *config;
+    }
+    if (kv->config.max_value_bytes == 0) {
+        kv->config.max_value_bytes = LINX_KV_DEFAULT_MAX_VALUE;
+    }
+    if (kv->config.max_pending_bytes == 0) {
+        kv->config.max_pending_bytes = LINX_KV_DEFAULT_MAX_PENDING_BYTES;
+    }
+    if (kv->config.flush_interval_ms == 0) {
+        kv->config.flush_interval_ms = LINX_KV_DEFAULT_FLUSH_INTERVAL_MS;
+    }
+    // 值的长度字段为 16 位
+    if (kv->config.max_value_bytes > 0xFFFF) {
+        kv->config.max_value_bytes = 0xFFFF;
+    }
+    kv->bank_size = (backend->size / backend->sector_size / 2) * backend->sector_size;
+
+    pthread_mutex_init(&kv->mutex, NULL);
+    pthread_mutex_init(&kv->io_mutex, NULL);
+    kv->buffer = (uint8_t*)LINX_MALLOC(kv->bank_size);
+    if (!kv->buffer || !kv_mount(kv)) {
+        LOG_ERROR("键值存储打开失败");
+        linx_kv_close(kv);
+        return NULL;
+    }
+
+    if (kv->config.flush_interval_ms > 0) {
+        const linx_thread_attr_t defaults = {
+            .name = "linx_kv",
+            .priority = LINX_THREAD_PRIORITY_LOW
+        };
+        linx_thread_attr_t attr = linx_thread_attr_merge(&kv->config.flush_thread, &defaults);
+        kv->wake = linx_sem_create(0, 1);
+        kv->thread = kv->wake ? linx_thread_create(&attr, kv_flush_thread, kv) : NULL;
+        if (!kv->thread) {
+            LOG_ERROR("键值存储后台线程创建失败");
+            linx_kv_close(kv);
+            return NULL;
+        }
+    }
+
+    LOG_INFO("键值存储已打开：%zu 个键，存储体 %d 已用 %zu/%zu 字节", kv->count, kv->bank, kv->tail,
+             kv->bank_size);
+    return kv;
+}
+
+void linx_kv_close(linx_kv_t* kv) {
+    if (!kv) {
+        return;
+    }
+    if (kv->thread) {
+        __atomic_store_n(&kv->stopping, true, __ATOMIC_RELEASE);
+        linx_sem_give(kv->wake);
+        linx_thread_join(kv->thread);
+        kv->thread = NULL;
+    }
+    if (kv->buffer) {
+        linx_kv_flush(kv);
+    }
+    if (kv->wake) {
+        linx_sem_destroy(kv->wake);
+    }
+    for (size_t i = 0; i < kv->count; i++) {
+        LINX_FREE(kv->entries[i].value);
+    }
+    LINX_FREE(kv->entries);
+    LINX_FREE(kv->buffer);
+    pthread_mutex_destroy(&kv->io_mutex);
+    pthread_mutex_destroy(&kv->mutex);
+    LINX_FREE(kv);
+}
+
+bool linx_kv_get(linx_kv_t* kv, const char* key, void* value, size_t size, size_t* length) {
+    if (!kv || !key || (!value && size > 0)) {
+        return false;
+    }
+    pthread_mutex_lock(&kv->mutex);
+    kv_entry_t* entry = kv_find(kv, key);
+    bool found = entry && entry->present && entry->length <= size;
+    if (found) {
+        if (entry->length > 0) {
+            memcpy(value, entry->value, entry->length);
+        }
+        if (length) {
+            *length = entry->length;
+        }
+    }
+    pthread_mutex_unlock(&kv->mutex);
+    return found;
+}
+
+/* 标记待写入，积累够一批时唤醒后台线程（持 mutex） */
+static void kv_mark_dirty(linx_kv_t* kv, kv_entry_t* entry) {
+    entry->dirty = true;
+    kv->stats.sets++;
+    kv->pending_bytes += kv_record_size(strlen(entry->key), entry->present ? entry->length : 0);
+    if (kv->pending_bytes >= kv->config.max_pending_bytes && kv->wake) {
+        linx_sem_give(kv->wake);
+    }
+}
+
+bool linx_kv_set(linx_kv_t* kv, const char* key, const void* value, size_t length) {
+    if (!kv || !key || key[0] == '\0' || strlen(key) > LINX_KV_MAX_KEY || (!value && length > 0) ||
+        length > kv->config.max_value_bytes) {
+        return false;
+    }
+    pthread_mutex_lock(&kv->mutex);
+    kv_entry_t* entry = kv_find_or_add(kv, key);
+    if (!entry) {
+        pthread_mutex_unlock(&kv->mutex);
+        return false;
+    }
+    if (entry->present && entry->length == length && (length == 0 || memcmp(entry->value, value, length) == 0)) {
+        // 与已有的值（已写入或待写入）相同，不产生写入
+        kv->stats.unchanged++;
+        pthread_mutex_unlock(&kv->mutex);
+        return true;
+    }
+    bool was_present = entry->present;
+    if (!kv_assign(entry, value, length)) {
+        if (!was_present && !entry->dirty) {
+            // 刚加入的键在末尾
+            kv->count--;
+        }
+        pthread_mutex_unlock(&kv->mutex);
+        return false;
+    }
+    kv_mark_dirty(kv, entry);
+    pthread_mutex_unlock(&kv->mutex);
+    return true;
+}
+
+bool linx_kv_delete(linx_kv_t* kv, const char* key) {
+    if (!kv || !key) {
+        return false;
+    }
+    pthread_mutex_lock(&kv->mutex);
+    kv_entry_t* entry = kv_find(kv, key);
+    bool found = entry && entry->present;
+    if (found) {
+        entry->present = false;
+        entry->length = 0;
+        kv_mark_dirty(kv, entry);
+    }
+    pthread_mutex_unlock(&kv->mutex);
+    return found;
+}
+
+bool linx_kv_get_stats(linx_kv_t* kv, linx_kv_stats_t* stats) {
+    if (!kv || !stats) {
+        return false;
+    }
+    pthread_mutex_lock(&kv->mutex);
+    *stats = kv->stats;
+    stats->keys = 0;
+    stats->live_bytes = 0;
+    stats->pending_keys = 0;
+    for (size_t i = 0; i < kv->count; i++) {
+        const kv_entry_t* entry = &kv->entries[i];
+        if (entry->present) {
+            stats->keys++;
+            stats->live_bytes += kv_record_size(strlen(entry->key), entry->length);
+        }
+        if (entry->dirty) {
+            stats->pending_keys++;
+        }
+    }
+    stats->used_bytes = kv->tail;
+    stats->bank_bytes = kv->bank_size;
+    pthread_mutex_unlock(&kv->mutex);
+    return true;
+}
+
+/* ==================== 会话缓存适配 ==================== */
+
+static bool kv_store_load(void* user_data, const char* key, void* value, size_t size, size_t* length) {
+    return linx_kv_get((linx_kv_t*)user_data, key, value, size, length);
+}
+
+static bool kv_store_store(void* user_data, const char* key, const void* value, size_t length) {
+    if (length == 0) {
+        linx_kv_delete((linx_kv_t*)user_data, key);
+        return true;
+    }
+    return linx_kv_set((linx_kv_t*)user_data, key, value, length);
+}
+
+linx_kv_store_t linx_kv_session_store(linx_kv_t* kv) {
+    linx_kv_store_t store = { kv_store_load, kv_store_store, kv };
+    return store;
+}
+
+/* ==================== 文件存储介质 ==================== */
+
+static bool kv_file_read(void* user_data, size_t offset, void* buffer, size_t length) {
+    int fd = (int)(intptr_t)user_data;
+    uint8_t* p = (uint8_t*)buffer;
+    while (length > 0) {
+        ssize_t n = pread(fd, p, length, (off_t)offset);
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        offset += (size_t)n;
+        length -= (size_t)n;
+    }
+    return true;
+}
+
+static bool kv_file_write(void* user_data, size_t offset, const void* data, size_t length) {
+    int fd = (int)(intptr_t)user_data;
+    const uint8_t* p = (const uint8_t*)data;
+    while (length > 0) {
+        ssize_t n = pwrite(fd, p, length, (off_t)offset);
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        offset += (size_t)n;
+        length -= (size_t)n;
+    }
+    return true;
+}
+
+static bool kv_file_erase(void* user_data, size_t offset, size_t length) {
+    uint8_t erased[256];
+    memset(erased, 0xFF, sizeof(erased));
+    while (length > 0) {
+        size_t n = length < sizeof(erased) ? length : sizeof(erased);
+        if (!kv_file_write(user_data, offset, erased, n)) {
+            return false;
+        }
+        offset += n;
+        length -= n;
+    }
+    return true;
+}
+
+static bool kv_file_sync(void* user_data) {
+    return fsync((int)(intptr_t)user_data) == 0;
+}
+
+bool linx_kv_file_backend_open(linx_kv_backend_t* backend, const char* path, size_t size) {
+    if (!backend || !path) {
+        return false;
+    }
+    if (size == 0) {
+        size = KV_FILE_DEFAULT_SIZE;
+    }
+    size = (size / (2 * KV_FILE_SECTOR_SIZE)) * (2 * KV_FILE_SECTOR_SIZE);
+    if (size == 0) {
+        return false;
+    }
+
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        LOG_ERROR("键值存储文件打开失败: %s", path);
+        return false;
+    }
+    memset(backend, 0, sizeof(*backend));
+    backend->read = kv_file_read;
+    backend->write = kv_file_write;
+    backend->erase = kv_file_erase;
+    backend->sync = kv_file_sync;
+    backend->size = size;
+    backend->sector_size = KV_FILE_SECTOR_SIZE;
+    backend->user_data = (void*)(intptr_t)fd;
+
+    // 新文件或比区域短的部分按已擦除处理
+    struct stat st;
+    if (fstat(fd, &st) != 0 ||
+        ((size_t)st.st_size < size && !kv_file_erase(backend->user_data, (size_t)st.st_size, size - (size_t)st.st_size))) {
+        close(fd);
+        memset(backend, 0, sizeof(*backend));
+        return false;
+    }
+    return true;
+}
+
+void linx_kv_file_backend_close(linx_kv_backend_t* backend) {
+    if (backend && backend->read == kv_file_read) {
+        close((int)(intptr_t)backend->user_data);
+        memset(backend, 0, sizeof(*backend));
+    }
+}
+
+/* ==================== 分区存储介质 ==================== */
+
+#if defined(ESP_PLATFORM)
+static bool kv_partition_read(void* user_data, size_t offset, void* buffer, size_t length) {
+    return esp_partition_read((const esp_partition_t*)user_data, offset, buffer, length) == ESP_OK;
+}
+
+static bool kv_partition_write(void* user_data, size_t offset, const void* data, size_t length) {
+    return esp_partition_write((const esp_partition_t*)user_data, offset, data, length) == ESP_OK;
+}
+
+static bool kv_partition_erase(void* user_data, size_t offset, size_t length) {
+    return esp_partition_erase_range((const esp_partition_t*)user_data, offset, length) == ESP_OK;
+}
+
+bool linx_kv_partition_backend(linx_kv_backend_t* backend, const char* label) {
+    if (!backend || !label) {
+        return false;
+    }
+    const esp_partition_t* partition =
+        esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+    if (!partition) {
+        LOG_ERROR("找不到键值存储分区: %s", label);
+        return false;
+    }
+    memset(backend, 0, sizeof(*backend));
+    backend->read = kv_partition_read;
+    backend->write = kv_partition_write;
+    backend->erase = kv_partition_erase;
+    backend->size = partition->size;
+    backend->sector_size = partition->erase_size;
+    backend->user_data = (void*)partition;
+    return true;
+}
+#endif
@@ -0,0 +1,178 @@
+/**
+ * @file linx_kv.h
+ * @brief 日志结构的键值存储（SDK 的小块持久状态）
+ *
+ * 会话缓存、OTA 续传位置、统计计数、TTS 缓存索引这类状态都很小、改得很频繁，每次改动都
+ * 整块重写 flash 扇区既磨损 flash，又让调用方在擦写上阻塞几十毫秒。本存储把它们放在一块
+ * 只追加的区域里：
+ *
+ * - 所有键值都在 RAM 中，读不访问存储；写只改 RAM 并标记为待写入，不做 I/O，音频线程上
+ *   调用也不会阻塞在 flash 上
+ * - 待写入的键由后台线程按 flush_interval_ms 批量追加到区域末尾（一次写入、一次同步），
+ *   间隔内同一个键改多次只写最后的值，与已写入的值相同的写入直接丢弃
+ * - 区域分成两个存储体，轮流使用：当前存储体写满时把所有有效的键重写到另一个存储体
+ *   （压缩），擦除只发生在压缩时，两个存储体交替承担擦写次数
+ *
+ * 每条记录带 CRC，启动时扫描当前存储体重建 RAM 中的键值；断电留下的半条记录被丢弃
+ * （同一批里之前的键仍然有效），下次写入前先压缩到另一个存储体。压缩时新存储体的头部
+ * 最后写入，压缩中途断电时旧存储体仍然完整。
+ *
+ * 存储介质由 linx_kv_backend_t 提供：linx_kv_file_backend_open() 用一个文件模拟，
+ * ESP-IDF 上 linx_kv_partition_backend() 直接使用一个数据分区；
+ * linx_kv_session_store() 把存储用作 linx_session_cache 的 linx_kv_store_t。
+ *
+ * 线程安全。
+ */
+
+#ifndef LINX_KV_H
+#define LINX_KV_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "os/linx_os.h"
+#include "linx_session_cache.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 键的最大字节数 */
+#define LINX_KV_MAX_KEY 63
+
+/* 默认值的最大字节数 */
+#ifndef LINX_KV_DEFAULT_MAX_VALUE
+#define LINX_KV_DEFAULT_MAX_VALUE 2048
+#endif
+
+/* 后台批量写入的默认间隔(毫秒) */
+#ifndef LINX_KV_DEFAULT_FLUSH_INTERVAL_MS
+#define LINX_KV_DEFAULT_FLUSH_INTERVAL_MS 1000
+#endif
+
+/* 待写入超过该字节数时不等间隔到期，立即唤醒后台线程 */
+#ifndef LINX_KV_DEFAULT_MAX_PENDING_BYTES
+#define LINX_KV_DEFAULT_MAX_PENDING_BYTES 2048
+#endif
+
+typedef struct linx_kv linx_kv_t;
+
+/* 存储介质：擦除后为 0xFF，只能写入已擦除的区域（NOR flash 的语义） */
+typedef struct {
+    bool (*read)(void* user_data, size_t offset, void* buffer, size_t length);
+    bool (*write)(void* user_data, size_t offset, const void* data, size_t length);
+    /* 擦除 [offset, offset + length)，两者都是 sector_size 的整数倍 */
+    bool (*erase)(void* user_data, size_t offset, size_t length);
+    /* 把已写入的数据落盘（可为 NULL） */
+    bool (*sync)(void* user_data);
+    size_t size;                    // 区域大小，至少两个扇区，按两个存储体平分
+    size_t sector_size;             // 擦除单位
+    void* user_data;
+} linx_kv_backend_t;
+
+/* 配置（字段为 0 时使用默认值） */
+typedef struct {
+    size_t max_value_bytes;         // 单个值的上限（默认 LINX_KV_DEFAULT_MAX_VALUE）
+    size_t max_pending_bytes;       // 待写入超过该值立即唤醒后台线程（默认 LINX_KV_DEFAULT_MAX_PENDING_BYTES）
+    int flush_interval_ms;          // 后台批量写入间隔（默认 LINX_KV_DEFAULT_FLUSH_INTERVAL_MS），
+                                    // <0 不创建后台线程，由应用调用 linx_kv_flush()
+    linx_thread_attr_t flush_thread; // 后台线程属性，默认名称 "linx_kv"、LOW 优先级
+} linx_kv_config_t;
+
+/* 统计信息 */
+typedef struct {
+    size_t keys;                    // 当前的键数
+    size_t live_bytes;              // 有效记录占用的字节数（压缩后的大小）
+    size_t used_bytes;              // 当前存储体已使用的字节数
+    size_t bank_bytes;              // 每个存储体的字节数
+    size_t pending_keys;            // 待写入的键数
+    uint64_t sets;                  // 写入次数（含删除）
+    uint64_t unchanged;             // 与已有值相同而丢弃的写入次数
+    uint64_t records_written;       // 追加到存储的记录数
+    uint64_t bytes_written;         // 追加到存储的字节数（含压缩）
+    uint64_t flushes;               // 批量写入次数
+    uint64_t compactions;           // 压缩次数（每次擦除一个存储体）
+    uint64_t errors;                // 写入失败次数（待写入的键保留到下一次）
+} linx_kv_stats_t;
+
+/**
+ * 打开存储：扫描区域重建 RAM 中的键值，区域为空或无法识别时格式化
+ * @param backend 存储介质（复制，user_data 必须一直有效）
+ * @param config 配置，可为 NULL
+ * @return 存储实例，失败返回 NULL
+ */
+linx_kv_t* linx_kv_open(const linx_kv_backend_t* backend, const linx_kv_config_t* config);
+
+/**
+ * 写入所有待写入的键并关闭存储
+ */
+void linx_kv_close(linx_kv_t* kv);
+
+/**
+ * 读取一个键（只读 RAM）
+ * @param value 输出缓冲区
+ * @param size 缓冲区大小
+ * @param length 值的字节数，可为 NULL
+ * @return 键存在且放得下返回 true
+ */
+bool linx_kv_get(linx_kv_t* kv, const char* key, void* value, size_t size, size_t* length);
+
+/**
+ * 写入一个键：只更新 RAM，由后台线程或 linx_kv_flush() 写入存储
+ * @return 键或值超长、内存不足时返回 false
+ */
+bool linx_kv_set(linx_kv_t* kv, const char* key, const void* value, size_t length);
+
+/**
+ * 删除一个键（同样延后写入）
+ * @return 键原本存在返回 true
+ */
+bool linx_kv_delete(linx_kv_t* kv, const char* key);
+
+/**
+ * 立即把待写入的键追加到存储并同步，剩余空间不够时先压缩
+ *
+ * 在调用线程上做 I/O，不要在音频线程上调用；进入深度睡眠、关机或重启前调用。
+ * @return 成功（或没有待写入的键）返回 true
+ */
+bool linx_kv_flush(linx_kv_t* kv);
+
+/**
+ * 获取统计信息
+ */
+bool linx_kv_get_stats(linx_kv_t* kv, linx_kv_stats_t* stats);
+
+/**
+ * 用一个文件作为存储介质（不存在时创建并填充 0xFF）
+ * @param backend 输出的存储介质
+ * @param path 文件路径
+ * @param size 区域大小，0 为 16KB
+ * @return 成功返回 true；用完后调用 linx_kv_file_backend_close()
+ */
+bool linx_kv_file_backend_open(linx_kv_backend_t* backend, const char* path, size_t size);
+
+/**
+ * 关闭 linx_kv_file_backend_open() 打开的文件（先关闭存储）
+ */
+void linx_kv_file_backend_close(linx_kv_backend_t* backend);
+
+#if defined(ESP_PLATFORM)
+/**
+ * 用一个数据分区作为存储介质
+ * @param label 分区名（分区表中 type 为 data）
+ * @return 找到分区返回 true
+ */
+bool linx_kv_partition_backend(linx_kv_backend_t* backend, const char* label);
+#endif
+
+/**
+ * 把存储用作会话缓存的 linx_kv_store_t（LinxSdkConfig.session_store）
+ * @param kv 存储实例，必须比使用者活得久
+ */
+linx_kv_store_t linx_kv_session_store(linx_kv_t* kv);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINX_KV_H */
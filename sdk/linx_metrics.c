@@ -0,0 +1,261 @@
+/**
+ * @file linx_metrics.c
+ * @brief SDK运行指标实现
+ */
+
+#include "linx_metrics.h"
+#include "log/linx_alloc.h"
+#include "cjson/linx_json_writer.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_CORE);
+
+static const char* const s_histogram_names[LINX_METRIC_HISTOGRAM_COUNT] = {
+    [LINX_METRIC_WAKE_TO_FIRST_UPLINK] = "wake_to_first_uplink_us",
+    [LINX_METRIC_SPEECH_END_TO_STT] = "speech_end_to_stt_us",
+    [LINX_METRIC_TTS_TO_PLAYBACK] = "tts_to_playback_us",
+    [LINX_METRIC_JITTER_DEPTH] = "jitter_depth_ms",
+    [LINX_METRIC_DECODE_TIME] = "decode_time_us",
+    [LINX_METRIC_SEND_QUEUE_DEPTH] = "send_queue_depth_frames",
+    [LINX_METRIC_DECODE_AHEAD_DEPTH] = "decode_ahead_periods",
+    [LINX_METRIC_DEADLINE_OVERRUN] = "deadline_overrun_us",
+    [LINX_METRIC_CPU_LOAD] = "cpu_load_permille",
+    [LINX_METRIC_MCP_TOOL_ARGS] = "mcp_tool_args_us",
+    [LINX_METRIC_MCP_TOOL_CALLBACK] = "mcp_tool_callback_us",
+    [LINX_METRIC_MCP_TOOL_SERIALIZE] = "mcp_tool_serialize_us",
+    [LINX_METRIC_MCP_TOOL_REPLY_SIZE] = "mcp_tool_reply_bytes",
+};
+
+static const char* const s_counter_names[LINX_METRIC_COUNTER_COUNT] = {
+    [LINX_METRIC_RECONNECTS] = "reconnects",
+    [LINX_METRIC_UPLINK_DROPS] = "uplink_drops",
+    [LINX_METRIC_DOWNLINK_DROPS] = "downlink_drops",
+    [LINX_METRIC_CONCEALED_FRAMES] = "concealed_frames",
+    [LINX_METRIC_UPLINK_PACKETS] = "uplink_packets",
+    [LINX_METRIC_DOWNLINK_PACKETS] = "downlink_packets",
+    [LINX_METRIC_MESSAGES_RECEIVED] = "messages_received",
+    [LINX_METRIC_LOCAL_ENDPOINTS] = "local_endpoints",
+    [LINX_METRIC_TTS_CACHE_HITS] = "tts_cache_hits",
+    [LINX_METRIC_DECODE_AHEAD_STARVED] = "decode_ahead_starved",
+    [LINX_METRIC_DEADLINE_MISSES] = "deadline_misses",
+    [LINX_METRIC_GOVERNOR_DEGRADES] = "governor_degrades",
+    [LINX_METRIC_GOVERNOR_RESTORES] = "governor_restores",
+    [LINX_METRIC_MCP_TOOL_CALLS] = "mcp_tool_calls",
+    [LINX_METRIC_MCP_SLOW_TOOLS] = "mcp_slow_tools",
+};
+
+/* 小于子桶数的值各占一个桶，之后每个 2 的幂区间按最高位之后的 3 位再分 8 份 */
+static size_t bucket_index(uint32_t value) {
+    if (value < LINX_METRICS_SUB_BUCKETS) {
+        return value;
+    }
+    unsigned msb = 31u - (unsigned)__builtin_clz(value);
+    unsigned shift = msb - LINX_METRICS_SUB_BUCKET_BITS;
+    return (size_t)(shift + 1) * LINX_METRICS_SUB_BUCKETS +
+           ((value >> shift) & (LINX_METRICS_SUB_BUCKETS - 1));
+}
+
+static uint32_t bucket_upper_bound(size_t index) {
+    if (index < LINX_METRICS_SUB_BUCKETS) {
+        return (uint32_t)index;
+    }
+    unsigned shift = (unsigned)(index / LINX_METRICS_SUB_BUCKETS) - 1;
+    uint64_t lower = (uint64_t)(LINX_METRICS_SUB_BUCKETS + index % LINX_METRICS_SUB_BUCKETS) << shift;
+    return (uint32_t)(lower + ((uint64_t)1 << shift) - 1);
+}
+
+void linx_metrics_reset(linx_metrics_t* metrics) {
+    if (!metrics) {
+        return;
+    }
+    memset(metrics, 0, sizeof(*metrics));
+    for (size_t i = 0; i < LINX_METRIC_HISTOGRAM_COUNT; i++) {
+        metrics->data.histograms[i].min = UINT32_MAX;
+    }
+}
+
+uint64_t linx_metrics_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)(ts.tv_nsec / 1000);
+}
+
+void linx_metrics_add(linx_metrics_t* metrics, linx_metrics_counter_id_t counter, uint64_t n) {
+    if (!metrics || (unsigned)counter >= LINX_METRIC_COUNTER_COUNT) {
+        return;
+    }
+    __atomic_fetch_add(&metrics->data.counters[counter], n, __ATOMIC_RELAXED);
+}
+
+void linx_metrics_record(linx_metrics_t* metrics, linx_metrics_histogram_id_t histogram, uint32_t value) {
+    if (!metrics || (unsigned)histogram >= LINX_METRIC_HISTOGRAM_COUNT) {
+        return;
+    }
+    linx_metrics_histogram_t* h = &metrics->data.histograms[histogram];
+
+    __atomic_fetch_add(&h->buckets[bucket_index(value)], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&h->sum, value, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&h->count, 1, __ATOMIC_RELAXED);
+
+    uint32_t seen = __atomic_load_n(&h->min, __ATOMIC_RELAXED);
+    while (value < seen && !__atomic_compare_exchange_n(&h->min, &seen, value, true,
+                                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+    seen = __atomic_load_n(&h->max, __ATOMIC_RELAXED);
+    while (value > seen && !__atomic_compare_exchange_n(&h->max, &seen, value, true,
+                                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+bool linx_metrics_stage_begin(linx_metrics_t* metrics, linx_metrics_histogram_id_t stage) {
+    if (!metrics || (unsigned)stage >= LINX_METRIC_HISTOGRAM_COUNT) {
+        return false;
+    }
+    uint64_t idle = 0;
+    return __atomic_compare_exchange_n(&metrics->stage_start_us[stage], &idle, linx_metrics_now_us(), false,
+                                       __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+
+void linx_metrics_stage_touch(linx_metrics_t* metrics, linx_metrics_histogram_id_t stage) {
+    if (!metrics || (unsigned)stage >= LINX_METRIC_HISTOGRAM_COUNT) {
+        return;
+    }
+    __atomic_store_n(&metrics->stage_start_us[stage], linx_metrics_now_us(), __ATOMIC_RELAXED);
+}
+
+bool linx_metrics_stage_end(linx_metrics_t* metrics, linx_metrics_histogram_id_t stage) {
+    if (!metrics || (unsigned)stage >= LINX_METRIC_HISTOGRAM_COUNT) {
+        return false;
+    }
+    // 热路径上大多没有进行中的阶段，先读一次避免每次都写缓存行
+    if (__atomic_load_n(&metrics->stage_start_us[stage], __ATOMIC_RELAXED) == 0) {
+        return false;
+    }
+    uint64_t start = __atomic_exchange_n(&metrics->stage_start_us[stage], 0, __ATOMIC_RELAXED);
+    if (start == 0) {
+        return false;
+    }
+
+    uint64_t now = linx_metrics_now_us();
+    uint64_t elapsed = now > start ? now - start : 0;
+    linx_metrics_record(metrics, stage, elapsed > UINT32_MAX ? UINT32_MAX : (uint32_t)elapsed);
+    return true;
+}
+
+void linx_metrics_stage_cancel(linx_metrics_t* metrics, linx_metrics_histogram_id_t stage) {
+    if (!metrics || (unsigned)stage >= LINX_METRIC_HISTOGRAM_COUNT) {
+        return;
+    }
+    __atomic_store_n(&metrics->stage_start_us[stage], 0, __ATOMIC_RELAXED);
+}
+
+void linx_metrics_snapshot(const linx_metrics_t* metrics, linx_metrics_snapshot_t* snapshot) {
+    if (!snapshot) {
+        return;
+    }
+    if (!metrics) {
+        memset(snapshot, 0, sizeof(*snapshot));
+        return;
+    }
+
+    for (size_t i = 0; i < LINX_METRIC_COUNTER_COUNT; i++) {
+        snapshot->counters[i] = __atomic_load_n(&metrics->data.counters[i], __ATOMIC_RELAXED);
+    }
+    for (size_t i = 0; i < LINX_METRIC_HISTOGRAM_COUNT; i++) {
+        const linx_metrics_histogram_t* src = &metrics->data.histograms[i];
+        linx_metrics_histogram_t* dst = &snapshot->histograms[i];
+        dst->count = __atomic_load_n(&src->count, __ATOMIC_RELAXED);
+        dst->sum = __atomic_load_n(&src->sum, __ATOMIC_RELAXED);
+        dst->min = __atomic_load_n(&src->min, __ATOMIC_RELAXED);
+        dst->max = __atomic_load_n(&src->max, __ATOMIC_RELAXED);
+        for (size_t b = 0; b < LINX_METRICS_HISTOGRAM_BUCKETS; b++) {
+            dst->buckets[b] = __atomic_load_n(&src->buckets[b], __ATOMIC_RELAXED);
+        }
+    }
+}
+
+uint32_t linx_metrics_histogram_percentile(const linx_metrics_histogram_t* histogram, double percentile) {
+    if (!histogram || histogram->count == 0) {
+        return 0;
+    }
+    if (percentile < 0) {
+        percentile = 0;
+    } else if (percentile > 100) {
+        percentile = 100;
+    }
+
+    // 以桶计数之和为准：快照中 count 与桶可能相差正在记录的几个样本
+    uint64_t total = 0;
+    for (size_t b = 0; b < LINX_METRICS_HISTOGRAM_BUCKETS; b++) {
+        total += histogram->buckets[b];
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    uint64_t rank = (uint64_t)(percentile / 100.0 * (double)total + 0.5);
+    if (rank == 0) {
+        rank = 1;
+    }
+
+    uint64_t seen = 0;
+    for (size_t b = 0; b < LINX_METRICS_HISTOGRAM_BUCKETS; b++) {
+        seen += histogram->buckets[b];
+        if (seen >= rank) {
+            uint32_t upper = bucket_upper_bound(b);
+            return upper < histogram->max ? upper : histogram->max;
+        }
+    }
+    return histogram->max;
+}
+
+const char* linx_metrics_histogram_name(linx_metrics_histogram_id_t histogram) {
+    return (unsigned)histogram < LINX_METRIC_HISTOGRAM_COUNT ? s_histogram_names[histogram] : "unknown";
+}
+
+const char* linx_metrics_counter_name(linx_metrics_counter_id_t counter) {
+    return (unsigned)counter < LINX_METRIC_COUNTER_COUNT ? s_counter_names[counter] : "unknown";
+}
+
+char* linx_metrics_to_json(const linx_metrics_snapshot_t* snapshot) {
+    if (!snapshot) {
+        return NULL;
+    }
+
+    linx_json_writer_t writer;
+    linx_json_writer_init(&writer);
+
+    linx_json_writer_begin_object(&writer);
+    linx_json_writer_key(&writer, "counters");
+    linx_json_writer_begin_object(&writer);
+    for (size_t i = 0; i < LINX_METRIC_COUNTER_COUNT; i++) {
+        linx_json_writer_add_int(&writer, s_counter_names[i], (long long)snapshot->counters[i]);
+    }
+    linx_json_writer_end_object(&writer);
+
+    linx_json_writer_key(&writer, "histograms");
+    linx_json_writer_begin_object(&writer);
+    for (size_t i = 0; i < LINX_METRIC_HISTOGRAM_COUNT; i++) {
+        const linx_metrics_histogram_t* h = &snapshot->histograms[i];
+        bool empty = h->count == 0;
+        linx_json_writer_key(&writer, s_histogram_names[i]);
+        linx_json_writer_begin_object(&writer);
+        linx_json_writer_add_int(&writer, "count", (long long)h->count);
+        linx_json_writer_add_int(&writer, "min", empty ? 0 : (long long)h->min);
+        linx_json_writer_add_int(&writer, "max", empty ? 0 : (long long)h->max);
+        linx_json_writer_add_int(&writer, "mean", empty ? 0 : (long long)(h->sum / h->count));
+        linx_json_writer_add_int(&writer, "p50", linx_metrics_histogram_percentile(h, 50));
+        linx_json_writer_add_int(&writer, "p90", linx_metrics_histogram_percentile(h, 90));
+        linx_json_writer_add_int(&writer, "p99", linx_metrics_histogram_percentile(h, 99));
+        linx_json_writer_end_object(&writer);
+    }
+    linx_json_writer_end_object(&writer);
+    linx_json_writer_end_object(&writer);
+
+    const char* json = linx_json_writer_finish(&writer);
+    char* result = json ? LINX_STRDUP(json) : NULL;
+    linx_json_writer_free(&writer);
+    return result;
+}
@@ -0,0 +1,180 @@
+/**
+ * @file linx_metrics.h
+ * @brief SDK运行指标：计数器与延迟直方图
+ *
+ * 所有记录接口都是无锁的（只用原子操作），可以在网络线程、播放线程和设备回调中
+ * 直接调用，不会阻塞也不会分配内存。直方图采用 HDR 风格的对数分桶：每个 2 的幂
+ * 区间再等分为 LINX_METRICS_SUB_BUCKETS 份，任意取值的相对误差不超过 1/8，
+ * 固定 LINX_METRICS_HISTOGRAM_BUCKETS 个桶覆盖完整的 uint32 范围。
+ *
+ * 阶段耗时（如唤醒到第一帧上行）由"起点 + 终点"两次调用得到：起点记录在
+ * 阶段槽位里，终点取走起点并把差值记入同名直方图，因此同一阶段只计一次，
+ * 起点和终点可以在不同线程、不同模块（如SDK与播放器）中记录。
+ *
+ * 快照逐项原子读取，各项之间不保证处于同一时刻，适合监控与回归分析。
+ */
+
+#ifndef LINX_METRICS_H
+#define LINX_METRICS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** 每个 2 的幂区间的子桶数（2^3） */
+#define LINX_METRICS_SUB_BUCKET_BITS 3
+#define LINX_METRICS_SUB_BUCKETS (1u << LINX_METRICS_SUB_BUCKET_BITS)
+
+/** 覆盖 0 ~ UINT32_MAX 所需的桶数 */
+#define LINX_METRICS_HISTOGRAM_BUCKETS ((32 - LINX_METRICS_SUB_BUCKET_BITS + 1) * LINX_METRICS_SUB_BUCKETS)
+
+/**
+ * @brief 直方图
+ *
+ * 耗时类直方图单位为微秒，深度类直方图单位见各自说明。
+ */
+typedef enum {
+    LINX_METRIC_WAKE_TO_FIRST_UPLINK = 0,   ///< 唤醒/发起连接到第一帧上行音频发出（微秒）
+    LINX_METRIC_SPEECH_END_TO_STT,          ///< 最后一帧上行音频到收到 stt 结果（微秒）
+    LINX_METRIC_TTS_TO_PLAYBACK,            ///< 收到第一帧 TTS 音频到第一个样本交给音频设备（微秒）
+    LINX_METRIC_JITTER_DEPTH,               ///< 每个下行包入队后的抖动缓冲深度（毫秒）
+    LINX_METRIC_DECODE_TIME,                ///< 单帧解码耗时（微秒）
+    LINX_METRIC_SEND_QUEUE_DEPTH,           ///< 每帧上行时跨线程发送队列中的音频帧数
+    LINX_METRIC_DECODE_AHEAD_DEPTH,         ///< 推模式每次写设备时解码超前队列中的周期数
+    LINX_METRIC_DEADLINE_OVERRUN,           ///< 音频线程一个周期超出截止时间的时长（微秒，见 log/linx_deadline.h）
+    LINX_METRIC_CPU_LOAD,                   ///< 质量调速器每次采样的 CPU 负载（千分比，见 linx_governor.h）
+    LINX_METRIC_MCP_TOOL_ARGS,              ///< MCP 工具调用的参数转换、校验耗时（微秒，需开启 mcp_tool_profiling）
+    LINX_METRIC_MCP_TOOL_CALLBACK,          ///< MCP 工具回调耗时（微秒）
+    LINX_METRIC_MCP_TOOL_SERIALIZE,         ///< MCP 工具结果序列化并发出的耗时（微秒）
+    LINX_METRIC_MCP_TOOL_REPLY_SIZE,        ///< MCP 工具调用的回复大小（字节）
+    LINX_METRIC_HISTOGRAM_COUNT
+} linx_metrics_histogram_id_t;
+
+/**
+ * @brief 计数器
+ */
+typedef enum {
+    LINX_METRIC_RECONNECTS = 0,             ///< 自动重连次数（每次断线后进入重连计一次）
+    LINX_METRIC_UPLINK_DROPS,               ///< 发送失败而丢弃的上行音频包（未连接、发送队列已满）
+    LINX_METRIC_DOWNLINK_DROPS,             ///< 抖动缓冲丢弃的下行音频包（已满、迟到、重复）
+    LINX_METRIC_CONCEALED_FRAMES,           ///< 丢包补齐（FEC/PLC）生成的帧数
+    LINX_METRIC_UPLINK_PACKETS,             ///< 已发出的上行音频包
+    LINX_METRIC_DOWNLINK_PACKETS,           ///< 收到的下行音频包
+    LINX_METRIC_MESSAGES_RECEIVED,          ///< 收到的文本消息
+    LINX_METRIC_LOCAL_ENDPOINTS,            ///< 设备本地断句发出的 listen stop
+    LINX_METRIC_TTS_CACHE_HITS,             ///< 由句子缓存本地回放、通知服务端跳过的句子
+    LINX_METRIC_DECODE_AHEAD_STARVED,       ///< 解码超前队列播空而解码方还有音频未解码（解码尖峰）
+    LINX_METRIC_DEADLINE_MISSES,            ///< 采集、播放线程超出周期截止时间的次数
+    LINX_METRIC_GOVERNOR_DEGRADES,          ///< 质量调速器降低一级质量的次数
+    LINX_METRIC_GOVERNOR_RESTORES,          ///< 质量调速器恢复一级质量的次数
+    LINX_METRIC_MCP_TOOL_CALLS,             ///< 已完成的 MCP 工具调用（需开启 mcp_tool_profiling）
+    LINX_METRIC_MCP_SLOW_TOOLS,             ///< 超过 mcp_slow_tool_ms 的 MCP 工具调用
+    LINX_METRIC_COUNTER_COUNT
+} linx_metrics_counter_id_t;
+
+/**
+ * @brief 直方图数据（快照中为普通值，记录端只通过原子操作访问）
+ */
+typedef struct {
+    uint64_t count;                         ///< 样本数
+    uint64_t sum;                           ///< 样本总和
+    uint32_t min;                           ///< 最小值（count 为 0 时无意义）
+    uint32_t max;                           ///< 最大值
+    uint32_t buckets[LINX_METRICS_HISTOGRAM_BUCKETS];
+} linx_metrics_histogram_t;
+
+/**
+ * @brief 指标快照
+ */
+typedef struct {
+    uint64_t counters[LINX_METRIC_COUNTER_COUNT];
+    linx_metrics_histogram_t histograms[LINX_METRIC_HISTOGRAM_COUNT];
+} linx_metrics_snapshot_t;
+
+/**
+ * @brief 指标记录器（可直接嵌入其他结构体，使用前调用 linx_metrics_reset()）
+ */
+typedef struct linx_metrics {
+    linx_metrics_snapshot_t data;
+    uint64_t stage_start_us[LINX_METRIC_HISTOGRAM_COUNT];  ///< 阶段起点，0 表示没有进行中的阶段
+} linx_metrics_t;
+
+/**
+ * @brief 清零全部指标和进行中的阶段（不要与记录并发调用）
+ */
+void linx_metrics_reset(linx_metrics_t* metrics);
+
+/**
+ * @brief 单调时钟（微秒），阶段起止使用的时间基准
+ */
+uint64_t linx_metrics_now_us(void);
+
+/**
+ * @brief 计数器加 n（metrics 为 NULL 时忽略，下同）
+ */
+void linx_metrics_add(linx_metrics_t* metrics, linx_metrics_counter_id_t counter, uint64_t n);
+
+/**
+ * @brief 记录一个直方图样本
+ */
+void linx_metrics_record(linx_metrics_t* metrics, linx_metrics_histogram_id_t histogram, uint32_t value);
+
+/**
+ * @brief 开始一个阶段；已有进行中的阶段时保留原起点
+ * @return 本次设置了起点返回 true
+ */
+bool linx_metrics_stage_begin(linx_metrics_t* metrics, linx_metrics_histogram_id_t stage);
+
+/**
+ * @brief 开始一个阶段；已有进行中的阶段时把起点移到现在（如"最后一帧上行"）
+ */
+void linx_metrics_stage_touch(linx_metrics_t* metrics, linx_metrics_histogram_id_t stage);
+
+/**
+ * @brief 结束进行中的阶段并把耗时（微秒）记入同名直方图；没有进行中的阶段时忽略
+ * @return 记录了样本返回 true
+ */
+bool linx_metrics_stage_end(linx_metrics_t* metrics, linx_metrics_histogram_id_t stage);
+
+/**
+ * @brief 取消进行中的阶段（如断线后唤醒不再会有上行）
+ */
+void linx_metrics_stage_cancel(linx_metrics_t* metrics, linx_metrics_histogram_id_t stage);
+
+/**
+ * @brief 复制当前指标
+ */
+void linx_metrics_snapshot(const linx_metrics_t* metrics, linx_metrics_snapshot_t* snapshot);
+
+/**
+ * @brief 计算直方图分位数
+ * @param percentile 分位（0-100）
+ * @return 所在桶的上界（不超过 max），没有样本时返回 0
+ */
+uint32_t linx_metrics_histogram_percentile(const linx_metrics_histogram_t* histogram, double percentile);
+
+/**
+ * @brief 直方图/计数器在 JSON 中使用的名称
+ */
+const char* linx_metrics_histogram_name(linx_metrics_histogram_id_t histogram);
+const char* linx_metrics_counter_name(linx_metrics_counter_id_t counter);
+
+/**
+ * @brief 把快照序列化为 JSON
+ *
+ * 格式：{"counters":{"reconnects":0,...},"histograms":{"decode_time_us":
+ * {"count":..,"min":..,"max":..,"mean":..,"p50":..,"p90":..,"p99":..},...}}
+ *
+ * @return 以 '\0' 结尾的 JSON 文本，调用者用 linx_free() 释放；内存不足时返回 NULL
+ */
+char* linx_metrics_to_json(const linx_metrics_snapshot_t* snapshot);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LINX_METRICS_H
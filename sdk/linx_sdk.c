@@ -8,7 +8,16 @@
  */
 
 #include "linx_sdk.h"
+#include "linx_event_queue.h"
+#include "linx_boot.h"
+#include "linx_tracepoint.h"
 #include "log/linx_log.h"
+#include "log/linx_alloc.h"
+#include "log/linx_thread_stats.h"
+#include "log/linx_deadline.h"
+#include "codecs/opus_codec.h"
+#include "cjson/linx_json_scan.h"
+#include "cjson/linx_json_arena.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -16,47 +25,273 @@
 #include <pthread.h>
 #include <unistd.h>
 
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_CORE);
+
+// 静态内存构建（CONFIG_STATIC_MEMORY_SIZE）的内置内存区字节数，0 使用堆
+#ifndef LINX_STATIC_MEMORY_SIZE
+#define LINX_STATIC_MEMORY_SIZE 0
+#endif
+
+#if LINX_STATIC_MEMORY_SIZE > 0
+static uint8_t s_linx_static_memory[LINX_STATIC_MEMORY_SIZE] __attribute__((aligned(16)));
+#endif
+
 // ============================================================================
 // 内部函数声明
 // ============================================================================
 
 static void _linx_sdk_set_state(LinxSdk* sdk, LinxDeviceState new_state);
 static void _linx_sdk_emit_event(LinxSdk* sdk, const LinxEvent* event);
+static bool _linx_sdk_batches_audio(LinxSdk* sdk);
+static void _linx_sdk_flush_audio_batch(LinxSdk* sdk);
+static void _linx_sdk_discard_audio_batch(LinxSdk* sdk);
 static void _linx_sdk_set_error(LinxSdk* sdk, const char* error_msg, int error_code);
 
 // WebSocket回调函数
 static void _linx_sdk_on_websocket_connected(void* user_data);
 static void _linx_sdk_on_websocket_disconnected(void* user_data);
 static void _linx_sdk_on_websocket_error(const char* error_msg, void* user_data);
-static void _linx_sdk_on_websocket_message(const cJSON* root, void* user_data);
+static void _linx_sdk_on_websocket_message(const cJSON* root, const char* type, void* user_data);
+static bool _linx_sdk_on_websocket_text(const char* type, const char* json, size_t length, void* user_data);
+static bool _linx_sdk_on_websocket_control(const linx_control_message_t* message, void* user_data);
 static void _linx_sdk_on_websocket_audio_data(linx_audio_stream_packet_t* packet, void* user_data);
+static int _linx_sdk_downlink_level(void* user_data);
+static void _linx_sdk_set_protocol_callbacks(LinxSdk* sdk, linx_protocol_t* protocol);
+static LinxSdkError _linx_sdk_connect_stream(LinxSdk* sdk);
+
+// 内置服务器消息处理函数
+static void _linx_sdk_register_builtin_handlers(LinxSdk* sdk);
+static void _linx_sdk_handle_hello_message(const cJSON* root, void* user_data);
+static void _linx_sdk_handle_tts_message(const cJSON* root, void* user_data);
+static void _linx_sdk_handle_stt_message(const cJSON* root, void* user_data);
+static void _linx_sdk_handle_llm_message(const cJSON* root, void* user_data);
+static void _linx_sdk_handle_mcp_message(const cJSON* root, void* user_data);
+static void _linx_sdk_handle_system_message(const cJSON* root, void* user_data);
+static void _linx_sdk_handle_alert_message(const cJSON* root, void* user_data);
+static void _linx_sdk_handle_custom_message(const cJSON* root, void* user_data);
+static void _linx_sdk_process_tts(LinxSdk* sdk, const char* state, const char* text);
+static void _linx_sdk_process_stt(LinxSdk* sdk, const char* text);
+static void _linx_sdk_process_llm(LinxSdk* sdk, const char* emotion);
+static void _linx_sdk_trace_begin_turn(LinxSdk* sdk, bool listen_start);
+static void _linx_sdk_deliver_downlink(LinxSdk* sdk, linx_audio_stream_packet_t* packet);
+static void _linx_sdk_tts_cache_reset(LinxSdk* sdk);
+static void _linx_sdk_session_cache_apply(LinxSdk* sdk);
+static void _linx_sdk_touch_activity(LinxSdk* sdk);
+static void _linx_sdk_check_idle(LinxSdk* sdk);
+static void _linx_sdk_endpoint_select(LinxSdk* sdk);
+static void _linx_sdk_endpoint_on_dial(void* user_data, int reconnect_attempt);
+static void _linx_sdk_endpoint_on_connected(LinxSdk* sdk);
+static void _linx_sdk_endpoint_on_disconnected(LinxSdk* sdk, bool was_connected, bool reconnecting);
+static void _linx_sdk_service_endpoints(LinxSdk* sdk);
+static void _linx_sdk_service_governor(LinxSdk* sdk);
+static void _linx_sdk_service_memory(LinxSdk* sdk);
+static size_t _linx_sdk_shrink_tts_cache(void* user_data, linx_mem_pressure_level_t level);
+static void _linx_sdk_on_memory_pressure(void* user_data, linx_mem_pressure_level_t level, size_t free_bytes);
+#if LINX_ENABLE_MCP
+static void _linx_sdk_on_tool_profile(const mcp_tool_call_profile_t* profile, void* user_data);
+#endif
+static bool _linx_sdk_apply_complexity_locked(LinxSdk* sdk);
+static bool _linx_sdk_governor_complexity(void* user_data, int level);
+static bool _linx_sdk_governor_ns(void* user_data, int level);
+static bool _linx_sdk_governor_log_level(void* user_data, int level);
+static void _linx_sdk_session_cache_on_hello(LinxSdk* sdk, const char* session_id, const LinxSessionParams* params);
+#if LINX_ENABLE_OTA
+static void _linx_sdk_session_cache_on_ota(LinxSdk* sdk, const linx_ota_event_t* ota_event);
+static void _linx_sdk_endpoints_on_ota(LinxSdk* sdk, const linx_ota_event_t* ota_event);
+#endif
+#if LINX_ENABLE_MCP
+static void _linx_sdk_session_cache_on_tools_list(LinxSdk* sdk);
+#endif
+static void _linx_sdk_tts_cache_end_sentence(LinxSdk* sdk);
+static void _linx_sdk_tts_cache_begin_sentence(LinxSdk* sdk, const char* text);
+static void _linx_sdk_tts_cache_pump(LinxSdk* sdk, bool flush);
+static void _linx_sdk_report_playback_position(LinxSdk* sdk);
 
 // 事件处理线程
 static void* _linx_sdk_event_thread(void* arg);
+static void _linx_sdk_stop_event_thread(LinxSdk* sdk);
+static int _linx_sdk_loop_timeout_ms(LinxSdk* sdk);
+static void _linx_sdk_reactor_on_poll(void* user_data);
+static int _linx_sdk_reactor_next_timeout(void* user_data, int idle_ms);
+static void _linx_sdk_cancel_ota_task(void* arg);
+static void _linx_sdk_run_loop_once(LinxSdk* sdk, int timeout_ms);
+
+// 事件队列派发
+static void _linx_sdk_dispatch_event(LinxSdk* sdk, LinxEvent* event);
+static void* _linx_sdk_dispatch_thread(void* arg);
+static bool _linx_sdk_start_event_queue(LinxSdk* sdk);
+static void _linx_sdk_stop_event_queue(LinxSdk* sdk);
 
 // 状态管理函数
 static void _linx_sdk_set_session_id(LinxSdk* sdk, const char* session_id);
-static void _linx_sdk_set_listen_state(LinxSdk* sdk, const char* state);
-static void _linx_sdk_set_tts_state(LinxSdk* sdk, const char* state);
+static bool _linx_sdk_transition(LinxSdk* sdk, int device, int listen, int tts);
+
+// 状态字：低 8 位设备状态，之后 8 位监听状态，再 8 位TTS状态
+#define LINX_STATE_KEEP (-1)
+#define LINX_STATE_BIT(state) (1u << (state))
+
+static inline uint32_t _linx_state_pack(LinxDeviceState device, LinxListenState listen, LinxTtsState tts) {
+    return (uint32_t)device | ((uint32_t)listen << 8) | ((uint32_t)tts << 16);
+}
+
+static inline LinxDeviceState _linx_state_device(uint32_t word) {
+    return (LinxDeviceState)(word & 0xff);
+}
+
+static inline LinxListenState _linx_state_listen(uint32_t word) {
+    return (LinxListenState)((word >> 8) & 0xff);
+}
+
+static inline LinxTtsState _linx_state_tts(uint32_t word) {
+    return (LinxTtsState)((word >> 16) & 0xff);
+}
+
+// 设备状态转换表：每个状态允许进入的状态
+static const uint32_t s_device_transitions[] = {
+    // 撤销推测式唤醒后连接仍在，下一次唤醒从 IDLE 直接回到 LISTENING
+    [LINX_DEVICE_STATE_IDLE] = LINX_STATE_BIT(LINX_DEVICE_STATE_CONNECTING) |
+                               LINX_STATE_BIT(LINX_DEVICE_STATE_LISTENING) |
+                               LINX_STATE_BIT(LINX_DEVICE_STATE_ERROR),
+    [LINX_DEVICE_STATE_CONNECTING] = LINX_STATE_BIT(LINX_DEVICE_STATE_IDLE) |
+                                     LINX_STATE_BIT(LINX_DEVICE_STATE_LISTENING) |
+                                     LINX_STATE_BIT(LINX_DEVICE_STATE_DISCONNECTED) |
+                                     LINX_STATE_BIT(LINX_DEVICE_STATE_ERROR),
+    [LINX_DEVICE_STATE_LISTENING] = LINX_STATE_BIT(LINX_DEVICE_STATE_IDLE) |
+                                    LINX_STATE_BIT(LINX_DEVICE_STATE_CONNECTING) |
+                                    LINX_STATE_BIT(LINX_DEVICE_STATE_SPEAKING) |
+                                    LINX_STATE_BIT(LINX_DEVICE_STATE_DISCONNECTED) |
+                                    LINX_STATE_BIT(LINX_DEVICE_STATE_ERROR),
+    [LINX_DEVICE_STATE_SPEAKING] = LINX_STATE_BIT(LINX_DEVICE_STATE_IDLE) |
+                                   LINX_STATE_BIT(LINX_DEVICE_STATE_CONNECTING) |
+                                   LINX_STATE_BIT(LINX_DEVICE_STATE_LISTENING) |
+                                   LINX_STATE_BIT(LINX_DEVICE_STATE_DISCONNECTED) |
+                                   LINX_STATE_BIT(LINX_DEVICE_STATE_ERROR),
+    [LINX_DEVICE_STATE_DISCONNECTED] = LINX_STATE_BIT(LINX_DEVICE_STATE_IDLE) |
+                                       LINX_STATE_BIT(LINX_DEVICE_STATE_CONNECTING) |
+                                       LINX_STATE_BIT(LINX_DEVICE_STATE_ERROR),
+    [LINX_DEVICE_STATE_ERROR] = LINX_STATE_BIT(LINX_DEVICE_STATE_IDLE) |
+                                LINX_STATE_BIT(LINX_DEVICE_STATE_CONNECTING) |
+                                LINX_STATE_BIT(LINX_DEVICE_STATE_DISCONNECTED),
+};
+
+// 上行音频
+static LinxSdkError _linx_sdk_send_audio_packet(LinxSdk* sdk, const uint8_t* data, size_t size,
+                                                uint32_t timestamp);
+static LinxSdkError _linx_sdk_send_frame_locked(LinxSdk* sdk, const uint8_t* data, size_t size,
+                                                uint32_t timestamp);
+static void _linx_sdk_flush_preconnect_locked(LinxSdk* sdk);
+static void _linx_sdk_send_pending_wake_word_locked(LinxSdk* sdk);
+static void _linx_sdk_park_listening(LinxSdk* sdk);
+static void _linx_sdk_resume_listening(LinxSdk* sdk);
+
+// 推测式唤醒（linx_sdk_wake_speculative()）的进展，存于 wake_speculation
+enum {
+    LINX_WAKE_SPEC_NONE = 0,    // 没有推测式会话
+    LINX_WAKE_SPEC_CONNECTING,  // 正在建立会话，就绪后上行保持关闭
+    LINX_WAKE_SPEC_HELD,        // 会话已就绪、正在监听，等待确认后打开上行
+    LINX_WAKE_SPEC_CANCELLED,   // 会话就绪前被撤销，就绪后随即停止监听
+    LINX_WAKE_SPEC_PARKED       // 已撤销并停止监听，连接保留
+};
+static LinxSdkError _linx_sdk_flush_uplink_locked(LinxSdk* sdk);
+static void _linx_sdk_update_rate_control_locked(LinxSdk* sdk);
+static uint64_t _linx_sdk_now_ms(void);
+static void _linx_sdk_set_zero_alloc_armed(LinxSdk* sdk, bool armed);
+static void _linx_sdk_run_deferred_boot(LinxSdk* sdk);
+#if LINX_ENABLE_MCP
+static void _linx_sdk_start_mcp_workers(LinxSdk* sdk);
+#endif
+
+// OTA
+static LinxSdkError _linx_sdk_request_ota(LinxSdk* sdk, LinxSdkOtaRequest request,
+                                          const linx_ota_info_t* info, linx_ota_sink_t* sink,
+                                          linx_future_t* future);
+static void _linx_sdk_service_ota(LinxSdk* sdk);
+
+// 异步操作句柄
+static void _linx_sdk_finish_future(linx_future_t* future, int status, const void* data, size_t size);
+static void _linx_sdk_finish_connect_future(LinxSdk* sdk, LinxSdkError error);
+#if LINX_ENABLE_OTA
+static void _linx_sdk_on_ota_event(const linx_ota_event_t* ota_event, void* user_data);
+static void _linx_sdk_on_deadline(void* user_data, const linx_deadline_snapshot_t* snapshot);
+#endif
+
+// 远程日志
+static size_t _linx_sdk_next_log_message(void* user_data, char* buffer, size_t size);
 
 // 内部监听控制函数 (预留接口)
 
 // MCP回调函数
-static void _linx_sdk_mcp_send_callback(const char* message);
+#if LINX_ENABLE_MCP
+static void _linx_sdk_mcp_send_callback(const char* message, void* user_data);
+#endif
 
 // ============================================================================
 // 核心API函数实现
 // ============================================================================
 
+LinxSdkError linx_sdk_set_alloc_hooks(const linx_alloc_hooks_t* hooks) {
+    if (!linx_alloc_set_hooks(hooks)) {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
+    // 安装 cJSON 钩子，cJSON 的堆分配经竞技场回退进入同一个分配器
+    linx_json_arena_set_heap_allocator(NULL, NULL);
+    return LINX_SDK_SUCCESS;
+}
+
+LinxSdkError linx_sdk_enable_alloc_tracking(const linx_alloc_hooks_t* backing) {
+    if (!linx_alloc_tracking_enable(backing)) {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
+    linx_json_arena_set_heap_allocator(NULL, NULL);
+    return LINX_SDK_SUCCESS;
+}
+
+LinxSdk* linx_sdk_create_static(const LinxSdkConfig* config, void* memory, size_t size) {
+    if (!config) {
+        return NULL;
+    }
+    if (linx_alloc_get_hooks()) {
+        LOG_ERROR("已安装内存分配器，不能再使用静态内存区");
+        return NULL;
+    }
+    linx_alloc_hooks_t hooks;
+    if (!linx_alloc_static_hooks(memory, size, &hooks) || linx_sdk_set_alloc_hooks(&hooks) != LINX_SDK_SUCCESS) {
+        LOG_ERROR("静态内存区无效: %p, %zu 字节", memory, size);
+        return NULL;
+    }
+    return linx_sdk_create(config);
+}
+
+LinxSdkError linx_sdk_seal_memory(LinxSdk* sdk) {
+    if (!sdk) {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
+    linx_alloc_static_stats_t stats;
+    if (!linx_alloc_static_get_stats(&stats)) {
+        return LINX_SDK_ERROR_NOT_INITIALIZED;
+    }
+    linx_alloc_static_seal();
+    return LINX_SDK_SUCCESS;
+}
+
 LinxSdk* linx_sdk_create(const LinxSdkConfig* config) {
     if (!config) {
         return NULL;
     }
     
+#if LINX_STATIC_MEMORY_SIZE > 0
+    // 静态内存构建：应用未安装分配器时使用内置内存区
+    if (!linx_alloc_get_hooks()) {
+        linx_alloc_hooks_t hooks;
+        if (linx_alloc_static_hooks(s_linx_static_memory, sizeof(s_linx_static_memory), &hooks)) {
+            linx_sdk_set_alloc_hooks(&hooks);
+        }
+    }
+#endif
 
     LOG_INFO("开始创建LinxSDK实例");
     
-    LinxSdk* sdk = (LinxSdk*)calloc(1, sizeof(LinxSdk));
+    LinxSdk* sdk = (LinxSdk*)LINX_CALLOC(1, sizeof(LinxSdk));
     if (!sdk) {
         LOG_ERROR("SDK内存分配失败");
         return NULL;
@@ -64,6 +299,28 @@ LinxSdk* linx_sdk_create(const LinxSdkConfig* config) {
     
     // 复制配置
     memcpy(&sdk->config, config, sizeof(LinxSdkConfig));
+    sdk->executor = sdk->config.executor;
+    
+    // 会话缓存：没有配置地址时直接用上次 OTA 检查给出的地址，不等这次检查
+    if (sdk->config.session_store.load && sdk->config.session_store.store) {
+        sdk->session_cache_enabled = true;
+        linx_session_cache_load(&sdk->config.session_store, &sdk->session_cache);
+        sdk->config.server_url[sizeof(sdk->config.server_url) - 1] = '\0';
+        if (sdk->config.server_url[0] == '\0' && sdk->session_cache.websocket_url[0]) {
+            snprintf(sdk->config.server_url, sizeof(sdk->config.server_url), "%s", sdk->session_cache.websocket_url);
+            sdk->session_url_cached = true;
+            LOG_INFO("使用缓存的服务器地址: %s", sdk->config.server_url);
+        }
+    }
+    
+    if (sdk->config.json_index_threshold > 0) {
+        cJSON_SetObjectIndexThreshold(sdk->config.json_index_threshold);
+    }
+    if (sdk->config.crypto_provider && !linx_crypto_set_provider(sdk->config.crypto_provider)) {
+        LOG_WARN("加密提供者 %s 的 SHA-256 函数不完整，继续使用 %s", 
+                 sdk->config.crypto_provider->name ? sdk->config.crypto_provider->name : "(unnamed)",
+                 linx_crypto_get_provider()->name);
+    }
     
     // 设置默认值
     if (sdk->config.sample_rate == 0) {
@@ -75,39 +332,302 @@ LinxSdk* linx_sdk_create(const LinxSdkConfig* config) {
     if (sdk->config.timeout_ms == 0) {
         sdk->config.timeout_ms = 30000;
     }
+    if (sdk->config.uplink_frame_duration_ms == 0) {
+        sdk->config.uplink_frame_duration_ms = 20;
+    }
+    
+    // 音频格式：合包和码率自适应只对 Opus 有意义
+    sdk->config.audio_format[sizeof(sdk->config.audio_format) - 1] = '\0';
+    if (sdk->config.audio_format[0] == '\0') {
+        strcpy(sdk->config.audio_format, "opus");
+    }
+    if (!codec_factory_parse_format(sdk->config.audio_format, &sdk->audio_codec_type)) {
+        LOG_WARN("不支持的音频格式 %s，使用 opus", sdk->config.audio_format);
+        strcpy(sdk->config.audio_format, "opus");
+        sdk->audio_codec_type = CODEC_TYPE_OPUS;
+    }
+    
+    // 板子的算力上限：首选格式超出时换成上限内压缩率最高的格式；未指定候选时按注册表生成
+    if (sdk->config.codec_max_cost > 0) {
+        codec_cost_t max_cost = (codec_cost_t)sdk->config.codec_max_cost;
+        const codec_descriptor_t* descriptor = codec_factory_get_descriptor(sdk->audio_codec_type);
+        char first[sizeof(sdk->config.audio_format)];
+        if (descriptor && descriptor->cost > max_cost &&
+            codec_factory_build_offer(NULL, max_cost, (int)sdk->config.sample_rate, 0, 1, first, sizeof(first)) == 1 &&
+            codec_factory_parse_format(first, &sdk->audio_codec_type)) {
+            LOG_WARN("音频格式 %s 超出算力上限 %d，使用 %s", sdk->config.audio_format, max_cost, first);
+            snprintf(sdk->config.audio_format, sizeof(sdk->config.audio_format), "%s", first);
+        }
+        if (sdk->config.audio_formats[0] == '\0') {
+            codec_factory_build_offer(sdk->config.audio_format, max_cost, (int)sdk->config.sample_rate,
+                                      sdk->config.uplink_frame_duration_ms, LINX_WEBSOCKET_MAX_AUDIO_FORMATS,
+                                      sdk->config.audio_formats, sizeof(sdk->config.audio_formats));
+            LOG_INFO("候选音频格式: %s", sdk->config.audio_formats);
+        }
+    }
+    if (sdk->audio_codec_type != CODEC_TYPE_OPUS) {
+        if (sdk->config.uplink_bundle_frames > 1 || sdk->config.adaptive_bitrate) {
+            LOG_WARN("音频格式 %s 不支持合包和码率自适应，已关闭", sdk->config.audio_format);
+        }
+        sdk->config.uplink_bundle_frames = 0;
+        sdk->config.adaptive_bitrate = false;
+    }
     
     // 初始化状态
-    sdk->state = LINX_DEVICE_STATE_IDLE;
+    sdk->state_word = _linx_state_pack(LINX_DEVICE_STATE_IDLE, LINX_LISTEN_STATE_NONE, LINX_TTS_STATE_NONE);
     sdk->initialized = true;
     sdk->connected = false;
     sdk->event_callback = NULL;
     sdk->user_data = NULL;
     sdk->connect_time = 0;
     sdk->message_count = 0;
+    linx_metrics_reset(&sdk->metrics);
+    sdk->player = NULL;
+    sdk->barge_in_dropping = false;
+    sdk->trace = NULL;
+    if (sdk->config.trace_events > 0) {
+        sdk->trace = linx_trace_create(sdk->config.trace_events);
+        if (!sdk->trace) {
+            LOG_WARN("对话时间线创建失败，追踪已关闭");
+        }
+    }
+    sdk->tts_cache = NULL;
+    sdk->tts_cache_active = false;
+    sdk->playback_position_active = false;
+    sdk->tts_skipping = false;
+    sdk->tts_replay = NULL;
+    sdk->tts_cache_shrink = 0;
+    if (sdk->config.tts_cache_bytes > 0) {
+        linx_tts_cache_config_t cache_config = { .max_bytes = sdk->config.tts_cache_bytes };
+        sdk->tts_cache = linx_tts_cache_create(&cache_config);
+        if (!sdk->tts_cache) {
+            LOG_WARN("TTS句子缓存创建失败，缓存已关闭");
+        } else if (!linx_mem_pressure_register("tts_cache", LINX_MEM_PRESSURE_PRIORITY_MEDIA,
+                                               _linx_sdk_shrink_tts_cache, sdk)) {
+            LOG_WARN("内存压力收缩回调已满，句子缓存不会在内存紧张时清空");
+        }
+    }
     
     // 初始化WebSocket相关字段
     sdk->ws_protocol = NULL;
     sdk->event_thread_running = false;
     sdk->session_id = NULL;
-    sdk->listen_state = NULL;
-    sdk->tts_state = NULL;
     pthread_mutex_init(&sdk->state_mutex, NULL);
+    pthread_mutex_init(&sdk->power_mutex, NULL);
+    
+    // 事件订阅与音频批次
+    sdk->event_mask = sdk->config.event_mask;
+    sdk->audio_batch_count = 0;
+    pthread_mutex_init(&sdk->audio_batch_mutex, NULL);
+    
+    // 端点列表：server_url 在前，server_urls 依次在后
+    pthread_mutex_init(&sdk->endpoint_mutex, NULL);
+    sdk->config.server_urls[sizeof(sdk->config.server_urls) - 1] = '\0';
+    linx_endpoints_set(&sdk->endpoints, sdk->config.server_url, sdk->config.server_urls);
+    sdk->endpoint_current = -1;
+    
+    // 初始化上行合包
+    pthread_mutex_init(&sdk->uplink_mutex, NULL);
+    if (sdk->config.uplink_bundle_frames > OPUS_FRAME_BUNDLER_MAX_FRAMES) {
+        LOG_WARN("上行合包帧数 %u 超出上限，使用 %d",
+                 (unsigned)sdk->config.uplink_bundle_frames, OPUS_FRAME_BUNDLER_MAX_FRAMES);
+        sdk->config.uplink_bundle_frames = OPUS_FRAME_BUNDLER_MAX_FRAMES;
+    }
+    sdk->uplink_bundler = NULL;
+    if (sdk->config.uplink_bundle_frames > 1) {
+        sdk->uplink_bundler = opus_frame_bundler_create(sdk->config.uplink_bundle_frames);
+        if (!sdk->uplink_bundler) {
+            LOG_WARN("上行合包器创建失败，每帧单独发送");
+            sdk->config.uplink_bundle_frames = 0;
+        }
+    }
+    
+    // 初始化上行码率自适应
+    sdk->rate_controller = NULL;
+    sdk->uplink_encoder = NULL;
+    sdk->uplink_loss_perc = -1;
+    if (sdk->config.adaptive_bitrate) {
+        if (sdk->config.min_bitrate == 0) {
+            sdk->config.min_bitrate = 8000;
+        }
+        if (sdk->config.max_bitrate == 0) {
+            sdk->config.max_bitrate = 32000;
+        }
+        if (sdk->config.max_bitrate < sdk->config.min_bitrate) {
+            sdk->config.max_bitrate = sdk->config.min_bitrate;
+        }
+        if (sdk->config.max_packet_loss_perc == 0) {
+            sdk->config.max_packet_loss_perc = 25;
+        }
+        
+        opus_rate_controller_config_t rate_config = {
+            .min_bitrate = (int)sdk->config.min_bitrate,
+            .max_bitrate = (int)sdk->config.max_bitrate,
+            .max_packet_loss_perc = sdk->config.max_packet_loss_perc > 100 ? 100 : sdk->config.max_packet_loss_perc,
+            .adaptive_fec = sdk->config.adaptive_fec,
+            .frame_duration_ms = sdk->config.uplink_frame_duration_ms
+        };
+        sdk->rate_controller = opus_rate_controller_create(&rate_config);
+        if (!sdk->rate_controller) {
+            LOG_WARN("码率控制器创建失败，码率自适应已关闭");
+            sdk->config.adaptive_bitrate = false;
+        } else {
+            LOG_INFO("码率自适应: %u-%u bps", sdk->config.min_bitrate, sdk->config.max_bitrate);
+        }
+    }
+    
+    // 初始化连接前上行缓冲：容量按原始 PCM 或 Opus 码率上限（含 2 倍余量）估算
+    sdk->preconnect_buffer = NULL;
+    sdk->uplink_open = false;
+    sdk->pending_wake_word[0] = '\0';
+    sdk->wake_speculation = LINX_WAKE_SPEC_NONE;
+    if (sdk->config.preconnect_buffer_ms > 0) {
+        size_t frames = sdk->config.preconnect_buffer_ms / sdk->config.uplink_frame_duration_ms + 1;
+        size_t bytes;
+        if (sdk->audio_codec_type == CODEC_TYPE_OPUS) {
+            uint32_t bitrate = sdk->config.max_bitrate > 0 ? sdk->config.max_bitrate : 32000;
+            bytes = (size_t)bitrate / 8 * sdk->config.preconnect_buffer_ms / 1000 * 2;
+        } else {
+            bytes = (size_t)sdk->config.sample_rate * sdk->config.channels * 2 * sdk->config.preconnect_buffer_ms / 1000;
+        }
+        if (bytes < OPUS_FRAME_BUNDLER_MAX_FRAME_BYTES) {
+            bytes = OPUS_FRAME_BUNDLER_MAX_FRAME_BYTES;
+        }
+        sdk->preconnect_buffer = encoded_frame_buffer_create(frames, bytes);
+        if (!sdk->preconnect_buffer) {
+            LOG_WARN("连接前上行缓冲创建失败，连接建立前的音频将被丢弃");
+            sdk->config.preconnect_buffer_ms = 0;
+        } else {
+            LOG_INFO("连接前上行缓冲: %u ms (%zu 帧, %zu 字节)",
+                     (unsigned)sdk->config.preconnect_buffer_ms, frames, bytes);
+        }
+    }
+    
+    // 外部循环模式下SDK不创建线程，派发线程改为由 linx_sdk_poll_events 派发；共享 reactor 时不使用 event_loop_mode
+    bool external_loop = !sdk->config.reactor && sdk->config.event_loop_mode == LINX_EVENT_LOOP_EXTERNAL;
+    if (external_loop && sdk->config.event_delivery == LINX_EVENT_DELIVERY_THREAD) {
+        LOG_WARN("外部循环模式不创建派发线程，事件改为在 linx_sdk_poll_events 中派发");
+        sdk->config.event_delivery = LINX_EVENT_DELIVERY_POLL;
+    }
+    
+    // 队列派发：事件由SDK持有，回调在应用线程或派发线程上执行
+    if (sdk->config.event_delivery != LINX_EVENT_DELIVERY_CALLBACK && !_linx_sdk_start_event_queue(sdk)) {
+        LOG_WARN("事件队列创建失败，改为在网络线程上同步回调");
+        sdk->config.event_delivery = LINX_EVENT_DELIVERY_CALLBACK;
+    }
+    
+    // 文本事件历史：字幕等显示可直接引用事件中的字符串
+    if (sdk->config.text_event_history > 0) {
+        sdk->text_history = linx_event_history_create(sdk->config.text_event_history);
+        if (!sdk->text_history) {
+            LOG_WARN("文本事件历史创建失败，字符串只在回调期间有效");
+        }
+    }
     
     // 初始化MCP相关字段
     sdk->mcp_server = NULL;
 
     memset(sdk->last_error, 0, sizeof(sdk->last_error));
     
+    linx_json_writer_init(&sdk->json_scratch);
+    
+    // 创建消息路由表并注册内置消息类型
+    sdk->msg_router = linx_message_router_create();
+    if (!sdk->msg_router) {
+        LOG_ERROR("消息路由表创建失败");
+        _linx_sdk_stop_event_queue(sdk);
+        linx_event_history_destroy(sdk->text_history);
+        encoded_frame_buffer_destroy(sdk->preconnect_buffer);
+        opus_rate_controller_destroy(sdk->rate_controller);
+        opus_frame_bundler_destroy(sdk->uplink_bundler);
+        pthread_mutex_destroy(&sdk->uplink_mutex);
+        pthread_mutex_destroy(&sdk->state_mutex);
+        pthread_mutex_destroy(&sdk->power_mutex);
+        pthread_mutex_destroy(&sdk->audio_batch_mutex);
+        pthread_mutex_destroy(&sdk->endpoint_mutex);
+        LINX_FREE(sdk);
+        return NULL;
+    }
+    _linx_sdk_register_builtin_handlers(sdk);
+    
+    // 远程日志：连接后在上行空闲时上传
+    if (sdk->config.remote_log) {
+        log_upload_config_t upload_config = {
+            .min_level = sdk->config.remote_log_level
+        };
+        sdk->log_upload = log_upload_create(&upload_config);
+        if (!sdk->log_upload) {
+            LOG_WARN("远程日志上传器创建失败，远程日志已关闭");
+            sdk->config.remote_log = false;
+        }
+    }
+    
+#if LINX_ENABLE_MCP
     // 创建MCP服务器（如果启用）
     sdk->mcp_server = mcp_server_create("LinxSDK", "1.0.0");
     if (!sdk->mcp_server) {
         LOG_WARN("MCP服务器创建失败");
     } else {
         // 设置MCP消息发送回调
-        mcp_server_set_send_callback(_linx_sdk_mcp_send_callback);
+        mcp_server_set_send_handler(sdk->mcp_server, _linx_sdk_mcp_send_callback, sdk);
+        
+        if (sdk->config.mcp_tool_profiling) {
+            mcp_server_set_tool_profile_handler(sdk->mcp_server, _linx_sdk_on_tool_profile, sdk);
+            mcp_server_set_tool_profiling(sdk->mcp_server, true, sdk->config.mcp_slow_tool_ms);
+        }
+        
+        // 异步工具在线程池中执行，不阻塞收消息的线程；外部循环和共享 reactor 时同步执行。
+        // 快速启动时线程池推迟到第一轮对话结束后再启动
+        bool use_workers = !external_loop && !sdk->config.reactor;
+        if (use_workers && sdk->config.fast_boot) {
+            sdk->mcp_workers_deferred = true;
+        } else if (use_workers) {
+            _linx_sdk_start_mcp_workers(sdk);
+        }
+        sdk->mcp_enabled = true;
         LOG_INFO("MCP服务器创建成功");
     }
+#endif
+    
+    // 音频线程的周期超时计入指标并通过事件上报
+    if (!linx_deadline_add_listener(_linx_sdk_on_deadline, sdk)) {
+        LOG_WARN("音频超时监听者已满，超时不会上报");
+    }
+    
+    // 质量调速：按降级顺序登记SDK自己的调节项，界面帧率由应用登记
+    sdk->governor = NULL;
+    sdk->uplink_complexity = -1;
+    sdk->uplink_complexity_level = 0;
+    sdk->governor_log_level = -1;
+    if (sdk->config.quality_governor) {
+        sdk->governor = linx_governor_create(&sdk->config.governor);
+        if (!sdk->governor) {
+            LOG_WARN("质量调速器创建失败，质量调速已关闭");
+            sdk->config.quality_governor = false;
+        } else {
+            linx_governor_set_knob(sdk->governor, LINX_GOVERNOR_ENCODER_COMPLEXITY, 2,
+                                   _linx_sdk_governor_complexity, sdk);
+            if (sdk->config.noise_suppression) {
+                linx_governor_set_knob(sdk->governor, LINX_GOVERNOR_NS_STRENGTH, 2, _linx_sdk_governor_ns, sdk);
+            }
+            linx_governor_set_knob(sdk->governor, LINX_GOVERNOR_LOG_LEVEL, 1, _linx_sdk_governor_log_level, sdk);
+        }
+    }
     
+    // 内存压力：水位是全局的，各模块在创建时已登记收缩回调，这里负责定期检查和上报
+    if (sdk->config.memory_pressure) {
+        if (!linx_mem_pressure_configure(&sdk->config.memory)) {
+            LOG_WARN("内存压力水位无效，内存压力检查已关闭");
+            sdk->config.memory_pressure = false;
+        } else if (!linx_mem_pressure_add_listener(_linx_sdk_on_memory_pressure, sdk)) {
+            LOG_WARN("内存压力监听者已满，档位变化不会上报");
+        }
+    }
+    
+    if (sdk->config.fast_boot) {
+        sdk->boot_deferred = true;
+    }
+    linx_boot_mark(LINX_BOOT_SDK_CREATED);
     return sdk;
 }
 
@@ -116,49 +636,122 @@ void linx_sdk_destroy(LinxSdk* sdk) {
         return;
     }
     
-    // 断开连接
-    if (sdk->connected) {
-        linx_sdk_disconnect(sdk);
+    // 返回后巡检线程不再回调，之后才能释放事件队列
+    linx_deadline_remove_listener(_linx_sdk_on_deadline, sdk);
+    linx_mem_pressure_remove_listener(_linx_sdk_on_memory_pressure, sdk);
+    linx_mem_pressure_unregister(_linx_sdk_shrink_tts_cache, sdk);
+    
+#if LINX_ENABLE_MCP
+    // 先停止MCP线程池，之后不会再有工具结果发往连接
+    if (sdk->mcp_server) {
+        mcp_server_stop_workers(sdk->mcp_server);
     }
+#endif
     
-    // 停止事件处理线程
-    if (sdk->event_thread_running) {
-        sdk->event_thread_running = false;
-        pthread_join(sdk->event_thread, NULL);
+    // 等待自动进入低功耗完成
+    linx_thread_t* sleep_thread = __atomic_exchange_n(&sdk->sleep_thread, NULL, __ATOMIC_ACQ_REL);
+    if (sleep_thread) {
+        linx_thread_join(sleep_thread);
     }
     
+    // 断开连接（包括正在等待重连的连接）
+    linx_sdk_disconnect(sdk);
+    
+    // 停止事件处理线程
+    _linx_sdk_stop_event_thread(sdk);
+    
+    // 停止事件派发，先归还排队的音频事件和攒批的数据包，连接的数据包内存池随连接一起释放；
+    // 应用仍保留的音频事件不受影响，内存池等它们释放后才归还内存
+    _linx_sdk_stop_event_queue(sdk);
+    _linx_sdk_discard_audio_batch(sdk);
+    linx_event_history_destroy(sdk->text_history);
+    sdk->text_history = NULL;
+    
     // 清理WebSocket协议
     if (sdk->ws_protocol) {
         linx_websocket_destroy((linx_protocol_t*)sdk->ws_protocol);
         sdk->ws_protocol = NULL;
     }
     
+#if LINX_ENABLE_MCP
     // 清理MCP服务器
     if (sdk->mcp_server) {
         mcp_server_destroy(sdk->mcp_server);
         sdk->mcp_server = NULL;
+        sdk->mcp_enabled = false;
+    }
+#endif
+    
+    // 事件循环已停止，未完成的句柄不会再完成
+    _linx_sdk_finish_connect_future(sdk, LINX_SDK_ERROR_NOT_INITIALIZED);
+    _linx_sdk_finish_future(sdk->ota_request_future, LINX_OTA_ERROR_REQUEST, NULL, 0);
+    sdk->ota_request_future = NULL;
+    _linx_sdk_finish_future(sdk->ota_future, LINX_OTA_ERROR_REQUEST, NULL, 0);
+    sdk->ota_future = NULL;
+    
+    // 使用执行器的模块都已停止
+    if (sdk->owns_executor) {
+        linx_executor_destroy(sdk->executor);
     }
+    sdk->executor = NULL;
+    
+    // 清理消息路由表
+    linx_message_router_destroy(sdk->msg_router);
+    sdk->msg_router = NULL;
+    linx_json_writer_free(&sdk->json_scratch);
+    
+    // 停止远程日志（WebSocket 已销毁，不会再取消息）
+    log_upload_destroy(sdk->log_upload);
+    sdk->log_upload = NULL;
+    
+    // 清理对话时间线（播放器已不再记录）
+    linx_trace_destroy(sdk->trace);
+    sdk->trace = NULL;
+    
+    // 清理TTS句子缓存（事件线程已停止）
+    _linx_sdk_tts_cache_reset(sdk);
+    linx_tts_cache_destroy(sdk->tts_cache);
+    sdk->tts_cache = NULL;
     
     // 清理字符串资源
     if (sdk->session_id) {
-        free(sdk->session_id);
+        LINX_FREE(sdk->session_id);
     }
-    if (sdk->listen_state) {
-        free(sdk->listen_state);
-    }
-    if (sdk->tts_state) {
-        free(sdk->tts_state);
+    
+    // 清理上行合包器
+    opus_frame_bundler_destroy(sdk->uplink_bundler);
+    sdk->uplink_bundler = NULL;
+    opus_rate_controller_destroy(sdk->rate_controller);
+    sdk->rate_controller = NULL;
+    encoded_frame_buffer_destroy(sdk->preconnect_buffer);
+    sdk->preconnect_buffer = NULL;
+    
+    // 清理质量调速器：编码器和界面可能已由应用销毁，只恢复SDK自己改过的日志级别
+    linx_governor_destroy(sdk->governor);
+    sdk->governor = NULL;
+    if (sdk->governor_log_level >= 0) {
+        log_set_level((log_level_t)sdk->governor_log_level);
     }
     
+    // 清理上行前处理（流水线已由应用销毁）
+    audio_ns_destroy(sdk->uplink_ns);
+    sdk->uplink_ns = NULL;
+    audio_agc_destroy(sdk->uplink_agc);
+    sdk->uplink_agc = NULL;
+    
     // 销毁互斥锁
+    pthread_mutex_destroy(&sdk->uplink_mutex);
     pthread_mutex_destroy(&sdk->state_mutex);
+    pthread_mutex_destroy(&sdk->power_mutex);
+    pthread_mutex_destroy(&sdk->endpoint_mutex);
+    pthread_mutex_destroy(&sdk->audio_batch_mutex);
     
     LOG_INFO("LinxSDK实例已销毁");
     
     // 清理日志系统
     log_cleanup();
     
-    free(sdk);
+    LINX_FREE(sdk);
 }
 
 LinxSdkError linx_sdk_set_event_callback(LinxSdk* sdk, LinxEventCallback callback, void* user_data) {
@@ -176,6 +769,19 @@ LinxSdkError linx_sdk_set_event_callback(LinxSdk* sdk, LinxEventCallback callbac
     return LINX_SDK_SUCCESS;
 }
 
+LinxSdkError linx_sdk_set_event_mask(LinxSdk* sdk, uint32_t mask) {
+    if (!sdk) {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
+    
+    if (!sdk->initialized) {
+        return LINX_SDK_ERROR_NOT_INITIALIZED;
+    }
+    
+    __atomic_store_n(&sdk->event_mask, mask, __ATOMIC_RELAXED);
+    return LINX_SDK_SUCCESS;
+}
+
 LinxSdkError linx_sdk_connect(LinxSdk* sdk) {
     if (!sdk) {
         return LINX_SDK_ERROR_INVALID_PARAM;
@@ -185,12 +791,24 @@ LinxSdkError linx_sdk_connect(LinxSdk* sdk) {
         return LINX_SDK_ERROR_NOT_INITIALIZED;
     }
     
-    if (sdk->connected) {
+    // 已连接或正在自动重连时不再创建新连接
+    if (sdk->connected || linx_websocket_is_reconnecting(sdk->ws_protocol)) {
         return LINX_SDK_SUCCESS;
     }
     
     _linx_sdk_set_state(sdk, LINX_DEVICE_STATE_CONNECTING);
+    linx_boot_mark(LINX_BOOT_CONNECT_START);
     
+    // 唤醒后通常随即连接，从这里开始计算到第一帧上行的耗时
+    linx_metrics_stage_begin(&sdk->metrics, LINX_METRIC_WAKE_TO_FIRST_UPLINK);
+    
+    // 共用其他实例的连接：只打开一个流
+    if (sdk->config.shared_connection) {
+        LOG_INFO("正在连接到服务器: %s", sdk->config.server_url);
+        return _linx_sdk_connect_stream(sdk);
+    }
+    
+    _linx_sdk_endpoint_select(sdk);
     LOG_INFO("正在连接到服务器: %s", sdk->config.server_url);
     
     // 检查服务器URL
@@ -200,14 +818,61 @@ LinxSdkError linx_sdk_connect(LinxSdk* sdk) {
         return LINX_SDK_ERROR_INVALID_PARAM;
     }
     
+    // 服务端上次取得的工具表没有变化时在 hello 中告知，服务端可以不再拉取
+    char tools_hash[17] = "";
+#if LINX_ENABLE_MCP
+    if (sdk->session_cache_enabled && sdk->session_cache.has_tools_hash && sdk->mcp_server &&
+        mcp_server_get_tools_hash(sdk->mcp_server) == sdk->session_cache.tools_hash) {
+        snprintf(tools_hash, sizeof(tools_hash), "%016llx", (unsigned long long)sdk->session_cache.tools_hash);
+    }
+#endif
+    
     // 创建WebSocket协议实例
     linx_websocket_config_t ws_config = {
         .url = sdk->config.server_url,
         .auth_token = strlen(sdk->config.auth_token) > 0 ? sdk->config.auth_token : NULL,
         .device_id = strlen(sdk->config.device_id) > 0 ? sdk->config.device_id : NULL,
         .client_id = strlen(sdk->config.client_id) > 0 ? sdk->config.client_id : NULL,
-        .protocol_version = sdk->config.protocol_version > 0 ? sdk->config.protocol_version : 1
+        .protocol_version = sdk->config.protocol_version > 0 ? sdk->config.protocol_version : 1,
+        .client_audio_format = sdk->config.audio_format,
+        .audio_sample_rate = (int)sdk->config.sample_rate,
+        .audio_channels = sdk->config.channels,
+        .audio_frame_duration = sdk->config.uplink_frame_duration_ms,
+        .auto_reconnect = sdk->config.auto_reconnect,
+        .reconnect_base_ms = (int)sdk->config.reconnect_base_ms,
+        .reconnect_max_ms = (int)sdk->config.reconnect_max_ms,
+        .reconnect_max_attempts = (int)sdk->config.reconnect_max_attempts,
+        .keepalive_idle_ms = (int)sdk->config.keepalive_idle_ms,
+        .keepalive_active_ms = (int)sdk->config.keepalive_active_ms,
+        .keepalive_max_missed = sdk->config.keepalive_max_missed,
+        .dns_cache_ttl_ms = (int)sdk->config.dns_cache_ttl_ms,
+        .early_hello = sdk->config.early_hello,
+        .text_deflate = sdk->config.text_deflate,
+        .deflate_window_bits = sdk->config.deflate_window_bits,
+        .deflate_dictionary = sdk->config.deflate_dictionary,
+        .binary_control = sdk->config.binary_control,
+        .multiplex = sdk->config.multiplex,
+        .downlink_level = sdk->config.downlink_buffer_ms > 0 ? _linx_sdk_downlink_level : NULL,
+        .downlink_level_user_data = sdk,
+        .downlink_capacity_ms = (int)sdk->config.downlink_buffer_ms,
+        .audio_formats = sdk->config.audio_formats[0] ? sdk->config.audio_formats : NULL,
+        .audio_features = sdk->config.audio_features |
+                          (sdk->config.adaptive_fec ? LINX_WEBSOCKET_AUDIO_FEATURE_FEC : 0) |
+                          (sdk->config.uplink_bundle_frames > 1 ? LINX_WEBSOCKET_AUDIO_FEATURE_BUNDLING : 0) |
+                          (sdk->tts_cache ? LINX_WEBSOCKET_AUDIO_FEATURE_TTS_CACHE : 0),
+        .reactor = sdk->config.reactor,
+        .capture_path = sdk->config.capture_path[0] ? sdk->config.capture_path : NULL,
+        .record_path = sdk->config.record_path[0] ? sdk->config.record_path : NULL,
+        .replay_path = sdk->config.replay_path[0] ? sdk->config.replay_path : NULL,
+        .replay_speed = sdk->config.replay_speed,
+        .max_text_bytes = (int)sdk->config.max_text_bytes,
+        .max_json_depth = (int)sdk->config.max_json_depth,
+        .max_json_items = (int)sdk->config.max_json_items,
+        .mcp_tools_hash = tools_hash[0] ? tools_hash : NULL
     };
+    for (int i = 0; i < LINX_WEBSOCKET_MAX_FRAME_DURATIONS; i++) {
+        ws_config.frame_durations[i] = sdk->config.frame_durations_ms[i];
+    }
     
     sdk->ws_protocol = linx_websocket_protocol_create(&ws_config);
     if (!sdk->ws_protocol) {
@@ -217,15 +882,14 @@ LinxSdkError linx_sdk_connect(LinxSdk* sdk) {
     }
     
     // 设置WebSocket回调函数
-    linx_protocol_callbacks_t callbacks = {
-        .on_connected = _linx_sdk_on_websocket_connected,
-        .on_disconnected = _linx_sdk_on_websocket_disconnected,
-        .on_network_error = _linx_sdk_on_websocket_error,
-        .on_incoming_json = _linx_sdk_on_websocket_message,
-        .on_incoming_audio = _linx_sdk_on_websocket_audio_data,
-        .user_data = sdk
-    };
-    linx_protocol_set_callbacks((linx_protocol_t*)sdk->ws_protocol, &callbacks);
+    _linx_sdk_set_protocol_callbacks(sdk, (linx_protocol_t*)sdk->ws_protocol);
+    _linx_sdk_session_cache_apply(sdk);
+    
+    // 远程日志作为低优先级消息，只在上行空闲时发送
+    if (sdk->log_upload) {
+        linx_websocket_set_idle_sender(sdk->ws_protocol, _linx_sdk_next_log_message, sdk);
+    }
+    linx_websocket_set_dial_hook(sdk->ws_protocol, _linx_sdk_endpoint_on_dial, sdk);
     
     // 启动WebSocket连接
     if (!linx_websocket_start((linx_protocol_t*)sdk->ws_protocol)) {
@@ -236,9 +900,35 @@ LinxSdkError linx_sdk_connect(LinxSdk* sdk) {
         return LINX_SDK_ERROR_NETWORK;
     }
     
-    // 启动事件处理线程
+    // 共享 reactor 时由 reactor 的轮询驱动OTA和RTT测量，不创建线程
+    if (sdk->config.reactor) {
+        sdk->reactor_hook.on_poll = _linx_sdk_reactor_on_poll;
+        sdk->reactor_hook.next_timeout_ms = _linx_sdk_reactor_next_timeout;
+        sdk->reactor_hook.user_data = sdk;
+        if (!linx_reactor_add_hook(sdk->config.reactor, &sdk->reactor_hook)) {
+            _linx_sdk_set_error(sdk, "事件循环注册失败", LINX_SDK_ERROR_UNKNOWN);
+            _linx_sdk_set_state(sdk, LINX_DEVICE_STATE_ERROR);
+            linx_websocket_destroy((linx_protocol_t*)sdk->ws_protocol);
+            sdk->ws_protocol = NULL;
+            return LINX_SDK_ERROR_UNKNOWN;
+        }
+        sdk->event_thread_running = true;
+        LOG_INFO("WebSocket连接启动成功(共享事件循环)，等待连接建立...");
+        return LINX_SDK_SUCCESS;
+    }
+    
+    // 启动事件处理线程；外部循环模式下由应用调用 linx_sdk_poll_events 驱动
     sdk->event_thread_running = true;
-    if (pthread_create(&sdk->event_thread, NULL, _linx_sdk_event_thread, sdk) != 0) {
+    if (sdk->config.event_loop_mode != LINX_EVENT_LOOP_EXTERNAL) {
+        const linx_thread_attr_t defaults = {
+            .name = "sdk_event",
+            .priority = LINX_THREAD_PRIORITY_NORMAL,
+            .core_mask = LINX_THREAD_NET_CORE_MASK
+        };
+        linx_thread_attr_t attr = linx_thread_attr_merge(&sdk->config.event_thread_attr, &defaults);
+        sdk->event_thread = linx_thread_create(&attr, _linx_sdk_event_thread, sdk);
+    }
+    if (sdk->config.event_loop_mode != LINX_EVENT_LOOP_EXTERNAL && !sdk->event_thread) {
         _linx_sdk_set_error(sdk, "事件处理线程创建失败", LINX_SDK_ERROR_UNKNOWN);
         _linx_sdk_set_state(sdk, LINX_DEVICE_STATE_ERROR);
         sdk->event_thread_running = false;
@@ -251,6 +941,79 @@ LinxSdkError linx_sdk_connect(LinxSdk* sdk) {
     return LINX_SDK_SUCCESS;
 }
 
+/**
+ * @brief 设置协议实例（连接或流）的回调函数，都指向本实例
+ * 
+ * @param sdk 指向LinxSdk实例的指针
+ * @param protocol 协议实例
+ */
+static void _linx_sdk_set_protocol_callbacks(LinxSdk* sdk, linx_protocol_t* protocol) {
+    linx_protocol_callbacks_t callbacks = {
+        .on_connected = _linx_sdk_on_websocket_connected,
+        .on_disconnected = _linx_sdk_on_websocket_disconnected,
+        .on_network_error = _linx_sdk_on_websocket_error,
+        .on_incoming_message = _linx_sdk_on_websocket_message,
+        .on_incoming_text = _linx_sdk_on_websocket_text,
+        .on_incoming_control = _linx_sdk_on_websocket_control,
+        .on_incoming_audio = _linx_sdk_on_websocket_audio_data,
+        .user_data = sdk
+    };
+    linx_protocol_set_callbacks(protocol, &callbacks);
+}
+
+/**
+ * @brief 在 shared_connection 指向的实例的连接上打开本实例的流
+ * 
+ * 流的 hello、session_id 和收发都独立，回调在承载实例的事件循环上下文中调用；
+ * 连接统计、协商参数和数据包内存池取自承载连接，本实例不创建事件线程。
+ * 
+ * @param sdk 指向LinxSdk实例的指针
+ * @return LinxSdkError 错误码
+ */
+static LinxSdkError _linx_sdk_connect_stream(LinxSdk* sdk) {
+    LinxSdk* carrier = sdk->config.shared_connection;
+    if (carrier == sdk || !carrier->ws_protocol || carrier->ws_stream) {
+        _linx_sdk_set_error(sdk, "共用的连接不存在或本身是流", LINX_SDK_ERROR_INVALID_PARAM);
+        _linx_sdk_set_state(sdk, LINX_DEVICE_STATE_ERROR);
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
+    
+    linx_websocket_stream_config_t stream_config = {
+        .device_id = strlen(sdk->config.device_id) > 0 ? sdk->config.device_id : NULL,
+        .client_id = strlen(sdk->config.client_id) > 0 ? sdk->config.client_id : NULL
+    };
+    sdk->ws_stream = linx_websocket_stream_create(carrier->ws_protocol, &stream_config);
+    if (!sdk->ws_stream) {
+        _linx_sdk_set_error(sdk, "多路复用流创建失败", LINX_SDK_ERROR_NETWORK);
+        _linx_sdk_set_state(sdk, LINX_DEVICE_STATE_ERROR);
+        return LINX_SDK_ERROR_NETWORK;
+    }
+    
+    // 回调可能在启动后立即到达，连接需先就位
+    sdk->ws_protocol = carrier->ws_protocol;
+    _linx_sdk_set_protocol_callbacks(sdk, (linx_protocol_t*)sdk->ws_stream);
+    if (!linx_protocol_start((linx_protocol_t*)sdk->ws_stream)) {
+        _linx_sdk_set_error(sdk, "多路复用流启动失败", LINX_SDK_ERROR_NETWORK);
+        _linx_sdk_set_state(sdk, LINX_DEVICE_STATE_ERROR);
+        linx_websocket_stream_destroy((linx_protocol_t*)sdk->ws_stream);
+        sdk->ws_stream = NULL;
+        sdk->ws_protocol = NULL;
+        return LINX_SDK_ERROR_NETWORK;
+    }
+    
+    // 由承载实例的事件循环驱动，没有自己的线程
+    sdk->event_thread_running = true;
+    LOG_INFO("多路复用流 %u 已启动，等待服务端确认...", linx_websocket_stream_get_id(sdk->ws_stream));
+    return LINX_SDK_SUCCESS;
+}
+
+/**
+ * @brief 本实例用于收发的协议实例：共用连接时为流，否则为自己的连接
+ */
+static linx_protocol_t* _linx_sdk_protocol(LinxSdk* sdk) {
+    return sdk->ws_stream ? (linx_protocol_t*)sdk->ws_stream : (linx_protocol_t*)sdk->ws_protocol;
+}
+
 LinxSdkError linx_sdk_disconnect(LinxSdk* sdk) {
     if (!sdk) {
         return LINX_SDK_ERROR_INVALID_PARAM;
@@ -260,25 +1023,37 @@ LinxSdkError linx_sdk_disconnect(LinxSdk* sdk) {
         return LINX_SDK_ERROR_NOT_INITIALIZED;
     }
     
-    if (!sdk->connected) {
+    if (!sdk->connected && !sdk->ws_stream && !linx_websocket_is_reconnecting(sdk->ws_protocol)) {
         return LINX_SDK_SUCCESS;
     }
     
     LOG_INFO("正在断开连接...");
     
+    // 连接断开后缓存的上行帧已无意义，直接丢弃
+    pthread_mutex_lock(&sdk->uplink_mutex);
+    opus_frame_bundler_set_bundle_frames(sdk->uplink_bundler, sdk->config.uplink_bundle_frames);
+    encoded_frame_buffer_clear(sdk->preconnect_buffer);
+    sdk->uplink_open = false;
+    sdk->pending_wake_word[0] = '\0';
+    sdk->wake_speculation = LINX_WAKE_SPEC_NONE;
+    pthread_mutex_unlock(&sdk->uplink_mutex);
+    
     // 停止事件处理线程
-    if (sdk->event_thread_running) {
-        sdk->event_thread_running = false;
-        pthread_join(sdk->event_thread, NULL);
-    }
+    _linx_sdk_stop_event_thread(sdk);
+    linx_metrics_stage_cancel(&sdk->metrics, LINX_METRIC_WAKE_TO_FIRST_UPLINK);
     
-    // 停止WebSocket连接
-    if (sdk->ws_protocol) {
+    // 停止WebSocket连接；共用连接时只关闭本实例的流，连接继续承载其他实例
+    if (sdk->ws_stream) {
+        linx_websocket_stream_destroy((linx_protocol_t*)sdk->ws_stream);
+        sdk->ws_stream = NULL;
+        sdk->ws_protocol = NULL;
+    } else if (sdk->ws_protocol) {
         linx_websocket_stop(sdk->ws_protocol);
     }
     
     sdk->connected = false;
     sdk->connect_time = 0;
+    _linx_sdk_set_zero_alloc_armed(sdk, false);
     _linx_sdk_set_state(sdk, LINX_DEVICE_STATE_IDLE);
     
     LOG_INFO("连接已断开");
@@ -303,7 +1078,7 @@ LinxSdkError linx_sdk_send_text(LinxSdk* sdk, const char* text) {
     // 增加消息计数
     sdk->message_count++;
     
-    if (!linx_websocket_send_text((linx_protocol_t*)sdk->ws_protocol, text)) {
+    if (!linx_protocol_send_text(_linx_sdk_protocol(sdk), text)) {
         return LINX_SDK_ERROR_NETWORK;
     }
     
@@ -319,826 +1094,4157 @@ LinxSdkError linx_sdk_send_audio(LinxSdk* sdk, const uint8_t* data, size_t size)
         return LINX_SDK_ERROR_NOT_INITIALIZED;
     }
     
+    //LOG_DEBUG("发送音频数据: %zu 字节", size);
+    
+    pthread_mutex_lock(&sdk->uplink_mutex);
+    
+    uint32_t timestamp = __atomic_load_n(&sdk->uplink_timestamp, __ATOMIC_RELAXED);
+    
+    // 音频通道打开前先暂存，连同时间戳在开始监听后补发
+    if (sdk->preconnect_buffer && !sdk->uplink_open) {
+        codec_error_t err = encoded_frame_buffer_push(sdk->preconnect_buffer, data, size, timestamp);
+        pthread_mutex_unlock(&sdk->uplink_mutex);
+        return err == CODEC_SUCCESS ? LINX_SDK_SUCCESS : LINX_SDK_ERROR_INVALID_PARAM;
+    }
+    
     if (!sdk->connected) {
+        pthread_mutex_unlock(&sdk->uplink_mutex);
         return LINX_SDK_ERROR_NETWORK;
     }
     
-    //LOG_DEBUG("发送音频数据: %zu 字节", size);
+    // 在编码线程上调整编码参数，对下一帧生效
+    _linx_sdk_update_rate_control_locked(sdk);
     
-    // 创建音频数据包并发送
-    linx_audio_stream_packet_t packet = {
-        .payload = (uint8_t*)data,
-        .payload_size = size
-    };
+    // 稳定上行路径：合包、入队都不应再分配内存
+    linx_alloc_no_alloc_enter();
+    LinxSdkError result = _linx_sdk_send_frame_locked(sdk, data, size, timestamp);
+    linx_alloc_no_alloc_leave();
     
-    if (!linx_websocket_send_audio((linx_protocol_t*)sdk->ws_protocol, &packet)) {
-        return LINX_SDK_ERROR_NETWORK;
+    pthread_mutex_unlock(&sdk->uplink_mutex);
+    if (result == LINX_SDK_SUCCESS) {
+        _linx_sdk_touch_activity(sdk);
     }
-    
-    return LINX_SDK_SUCCESS;
+    return result;
 }
 
-LinxDeviceState linx_sdk_get_state(LinxSdk* sdk) {
-    if (!sdk) {
-        return LINX_DEVICE_STATE_ERROR;
+/**
+ * @brief 发送一个编码帧（合包模式下先放入合包器），调用方需持有 uplink_mutex
+ * 
+ * @param sdk 指向LinxSdk实例的指针
+ * @param data 编码帧
+ * @param size 帧字节数
+ * @param timestamp 帧的上行时间戳；合包时使用凑满一包的那一帧的时间戳
+ */
+static LinxSdkError _linx_sdk_send_frame_locked(LinxSdk* sdk, const uint8_t* data, size_t size,
+                                                uint32_t timestamp) {
+    if (opus_frame_bundler_get_bundle_frames(sdk->uplink_bundler) <= 1) {
+        return _linx_sdk_send_audio_packet(sdk, data, size, timestamp);
     }
     
-    return sdk->state;
+    // 合包模式: 攒够帧数才发送
+    const uint8_t* packet = NULL;
+    size_t packet_size = 0;
+    codec_error_t err = opus_frame_bundler_push(sdk->uplink_bundler, data, size, &packet, &packet_size);
+    if (err == CODEC_INVALID_PARAMETER) {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    } else if (err != CODEC_SUCCESS) {
+        return LINX_SDK_ERROR_UNKNOWN;
+    }
+    return packet ? _linx_sdk_send_audio_packet(sdk, packet, packet_size, timestamp) : LINX_SDK_SUCCESS;
 }
 
-// ============================================================================
-// 内部函数实现
-// ============================================================================
-
 /**
- * @brief 设置SDK设备状态并触发状态变化事件
- * 
- * 这是一个内部函数，用于安全地更新SDK的设备状态，并自动触发状态变化事件
- * 通知应用程序状态的改变。该函数确保状态变化的原子性和事件的一致性。
- * 
- * @param sdk 指向LinxSdk实例的指针，不能为NULL
- * @param new_state 新的设备状态
+ * @brief 音频通道打开后按原顺序补发暂存的帧，调用方需持有 uplink_mutex
  * 
- * @note 该函数是线程安全的，可以在多线程环境中调用
- * @note 如果sdk为NULL，函数会安全返回而不执行任何操作
- * @note 状态变化会自动记录到日志系统中
+ * 每帧沿用暂存时记录的时间戳，服务端看到的时间轴与实时发送一致。
  * 
- * @see LinxDeviceState
- * @see _linx_sdk_emit_event
- * @see LINX_EVENT_STATE_CHANGED
+ * @param sdk 指向LinxSdk实例的指针
  */
-static void _linx_sdk_set_state(LinxSdk* sdk, LinxDeviceState new_state) {
-    if (!sdk || sdk->state == new_state) {
+static void _linx_sdk_flush_preconnect_locked(LinxSdk* sdk) {
+    size_t pending = encoded_frame_buffer_count(sdk->preconnect_buffer);
+    if (pending == 0) {
         return;
     }
     
-    LinxDeviceState old_state = sdk->state;
-    sdk->state = new_state;
-    
-    LOG_DEBUG("状态变化: %d -> %d", old_state, new_state);
-    
-    // 发送状态变化事件
-    if (sdk->event_callback) {
-        LinxEvent event = {0};
-        event.type = LINX_EVENT_STATE_CHANGED;
-        event.timestamp = time(NULL);
-        event.data.state_changed.old_state = old_state;
-        event.data.state_changed.new_state = new_state;
-        
-        _linx_sdk_emit_event(sdk, &event);
+    const uint8_t* frame = NULL;
+    size_t size = 0;
+    uint32_t timestamp = 0;
+    size_t sent = 0;
+    while (encoded_frame_buffer_front(sdk->preconnect_buffer, &frame, &size, &timestamp)) {
+        if (_linx_sdk_send_frame_locked(sdk, frame, size, timestamp) != LINX_SDK_SUCCESS) {
+            LOG_WARN("连接前缓存的音频补发失败，丢弃剩余 %zu 帧", pending - sent);
+            break;
+        }
+        encoded_frame_buffer_pop(sdk->preconnect_buffer);
+        sent++;
     }
+    encoded_frame_buffer_clear(sdk->preconnect_buffer);
+    LOG_INFO("补发连接前缓存的音频 %zu 帧 (累计因缓冲已满丢弃 %llu 帧)", sent,
+             (unsigned long long)encoded_frame_buffer_dropped(sdk->preconnect_buffer));
 }
 
 /**
- * @brief 向应用程序发射事件通知
- * 
- * 这是一个内部函数，用于安全地向应用程序发送事件通知。该函数会检查
- * 所有必要的条件（SDK实例、事件对象、回调函数），确保事件能够正确传递。
- * 
- * @param sdk 指向LinxSdk实例的指针，不能为NULL
- * @param event 指向要发送的事件对象的指针，不能为NULL
- * 
- * @note 该函数是线程安全的，可以在多线程环境中调用
- * @note 如果sdk、event为NULL或未设置事件回调，函数会安全返回
- * @note 事件回调在调用线程的上下文中执行，应用程序需要确保回调函数的线程安全性
+ * @brief 发送 linx_sdk_wake() 在音频通道打开前记下的唤醒词，调用方需持有 uplink_mutex
  * 
- * @see LinxEvent
- * @see LinxEventCallback
- * @see linx_sdk_set_event_callback
+ * @param sdk 指向LinxSdk实例的指针
  */
-static void _linx_sdk_emit_event(LinxSdk* sdk, const LinxEvent* event) {
-    if (!sdk || !event || !sdk->event_callback) {
+static void _linx_sdk_send_pending_wake_word_locked(LinxSdk* sdk) {
+    if (sdk->pending_wake_word[0] == '\0') {
         return;
     }
+    LOG_INFO("会话就绪，发送唤醒词: %s", sdk->pending_wake_word);
+    linx_protocol_send_wake_word_detected(_linx_sdk_protocol(sdk), sdk->pending_wake_word);
+    sdk->pending_wake_word[0] = '\0';
+}
+
+LinxSdkError linx_sdk_set_uplink_bundle_frames(LinxSdk* sdk, uint8_t frames) {
+    if (!sdk || frames > OPUS_FRAME_BUNDLER_MAX_FRAMES ||
+        (frames > 1 && sdk->audio_codec_type != CODEC_TYPE_OPUS)) {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
     
-    sdk->event_callback(event, sdk->user_data);
+    if (!sdk->initialized) {
+        return LINX_SDK_ERROR_NOT_INITIALIZED;
+    }
+    
+    pthread_mutex_lock(&sdk->uplink_mutex);
+    
+    // 先把已缓存的帧按旧设置发出去
+    if (_linx_sdk_flush_uplink_locked(sdk) != LINX_SDK_SUCCESS) {
+        LOG_WARN("切换合包帧数时缓存帧发送失败");
+    }
+    
+    LinxSdkError result = LINX_SDK_SUCCESS;
+    if (frames > 1 && !sdk->uplink_bundler) {
+        sdk->uplink_bundler = opus_frame_bundler_create(frames);
+        if (!sdk->uplink_bundler) {
+            result = LINX_SDK_ERROR_MEMORY;
+        }
+    } else if (sdk->uplink_bundler) {
+        opus_frame_bundler_set_bundle_frames(sdk->uplink_bundler, frames);
+    }
+    
+    if (result == LINX_SDK_SUCCESS) {
+        sdk->config.uplink_bundle_frames = frames;
+        LOG_INFO("上行合包帧数: %u", (unsigned)frames);
+    }
+    
+    pthread_mutex_unlock(&sdk->uplink_mutex);
+    return result;
 }
 
-/**
- * @brief 设置SDK错误信息并触发错误事件
- * 
- * 这是一个内部函数，用于记录SDK运行过程中发生的错误，并向应用程序
- * 发送错误事件通知。该函数会安全地处理错误消息的存储和事件的发送。
- * 
- * @param sdk 指向LinxSdk实例的指针，不能为NULL
- * @param error_msg 错误消息字符串，可以为NULL
- * @param error_code 错误代码，通常对应LinxSdkError枚举值
- * 
- * @note 该函数是线程安全的，可以在多线程环境中调用
- * @note 错误消息会被截断以适应内部缓冲区大小，并确保字符串正确终止
- * @note 如果error_msg为NULL，将使用"未知错误"作为默认消息
- * @note 错误信息会自动记录到日志系统中
- * 
- * @see LinxSdkError
- * @see LINX_EVENT_ERROR
- * @see _linx_sdk_emit_event
- */
-static void _linx_sdk_set_error(LinxSdk* sdk, const char* error_msg, int error_code) {
+LinxSdkError linx_sdk_get_audio_format(LinxSdk* sdk, char* format, size_t size) {
+    if (!sdk || !format || size == 0) {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
+    
+    if (!sdk->ws_protocol || !linx_websocket_get_audio_format(sdk->ws_protocol, format, size)) {
+        snprintf(format, size, "%s", sdk->config.audio_format);
+    }
+    return LINX_SDK_SUCCESS;
+}
+
+audio_codec_t* linx_sdk_create_codec(LinxSdk* sdk, bool encoder) {
     if (!sdk) {
-        return;
+        return NULL;
     }
     
-    // 保存错误信息
-    if (error_msg) {
-        strncpy(sdk->last_error, error_msg, sizeof(sdk->last_error) - 1);
-        sdk->last_error[sizeof(sdk->last_error) - 1] = '\0';
+    char format_name[sizeof(sdk->config.audio_format)];
+    linx_sdk_get_audio_format(sdk, format_name, sizeof(format_name));
+    audio_codec_t* codec = codec_factory_create_for_format(format_name);
+    if (!codec) {
+        return NULL;
     }
     
-    LOG_ERROR("错误: %s (代码: %d)", error_msg ? error_msg : "未知错误", error_code);
+    int sample_rate = (int)sdk->config.sample_rate;
+    int frame_duration = sdk->config.uplink_frame_duration_ms;
+    LinxSessionParams params;
+    if (sdk->ws_protocol && linx_websocket_get_session_params(sdk->ws_protocol, &params)) {
+        if (params.frame_duration > 0) {
+            frame_duration = params.frame_duration;
+        }
+        if (!encoder && params.sample_rate > 0) {
+            sample_rate = params.sample_rate;
+        }
+    }
+    audio_format_t format;
+    audio_format_init(&format, sample_rate, sdk->config.channels, 16, frame_duration);
+    codec_error_t result = encoder ? audio_codec_init_encoder(codec, &format) : audio_codec_init_decoder(codec, &format);
+    if (result != CODEC_SUCCESS) {
+        LOG_ERROR("初始化%s失败: %s %dHz", encoder ? "编码器" : "解码器", format_name, sample_rate);
+        audio_codec_destroy(codec);
+        return NULL;
+    }
+    return codec;
+}
+
+LinxSdkError linx_sdk_get_replay_stats(LinxSdk* sdk, LinxReplayStats* stats) {
+    if (!sdk || !stats) {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
     
-    // 发送错误事件
-    if (sdk->event_callback) {
-        LinxEvent event = {0};
-        event.type = LINX_EVENT_ERROR;
-        event.timestamp = time(NULL);
-        event.data.error.message = sdk->last_error;
-        event.data.error.code = error_code;
-        
-        _linx_sdk_emit_event(sdk, &event);
+    if (!sdk->ws_protocol || !linx_websocket_get_replay_stats(sdk->ws_protocol, stats)) {
+        return LINX_SDK_ERROR_NOT_INITIALIZED;
     }
+    return LINX_SDK_SUCCESS;
 }
 
-bool linx_sdk_is_connected(LinxSdk* sdk) {
+LinxSdkError linx_sdk_flush_audio(LinxSdk* sdk) {
     if (!sdk) {
-        return false;
+        return LINX_SDK_ERROR_INVALID_PARAM;
     }
     
-    return sdk->connected;
+    pthread_mutex_lock(&sdk->uplink_mutex);
+    LinxSdkError result = _linx_sdk_flush_uplink_locked(sdk);
+    pthread_mutex_unlock(&sdk->uplink_mutex);
+    return result;
 }
 
-uint32_t linx_sdk_get_message_count(LinxSdk* sdk) {
+LinxSdkError linx_sdk_set_uplink_timestamp(LinxSdk* sdk, uint32_t timestamp) {
     if (!sdk) {
-        return 0;
+        return LINX_SDK_ERROR_INVALID_PARAM;
     }
     
-    return sdk->message_count;
+    __atomic_store_n(&sdk->uplink_timestamp, timestamp, __ATOMIC_RELAXED);
+    return LINX_SDK_SUCCESS;
 }
 
-time_t linx_sdk_get_connect_time(LinxSdk* sdk) {
+LinxSdkError linx_sdk_set_uplink_encoder(LinxSdk* sdk, audio_codec_t* encoder) {
     if (!sdk) {
-        return 0;
+        return LINX_SDK_ERROR_INVALID_PARAM;
     }
-    return sdk->connect_time;
+    
+    if (!sdk->rate_controller) {
+        return LINX_SDK_ERROR_NOT_INITIALIZED;
+    }
+    
+    pthread_mutex_lock(&sdk->uplink_mutex);
+    sdk->uplink_encoder = encoder;
+    // 新编码器需要重新下发全部参数，调速器降过的复杂度也按新编码器的原值重新计算
+    opus_rate_controller_reset(sdk->rate_controller);
+    sdk->uplink_complexity = -1;
+    _linx_sdk_apply_complexity_locked(sdk);
+    pthread_mutex_unlock(&sdk->uplink_mutex);
+    
+    return LINX_SDK_SUCCESS;
 }
 
-// WebSocket回调函数实现
-/**
- * @brief WebSocket连接成功回调函数
- * 
- * 当WebSocket连接成功建立时，该回调函数会被调用。函数会更新SDK的连接状态，
- * 记录连接时间，设置设备状态为监听状态，并向应用程序发送连接成功事件。
- * 
- * @param user_data 用户数据指针，应该指向LinxSdk实例
- * 
- * @note 该函数在WebSocket线程上下文中被调用
- * @note 如果user_data为NULL，函数会安全返回
- * @note 连接成功后设备状态会自动切换到LINX_DEVICE_STATE_LISTENING
- * @note 连接时间会被记录用于统计和调试
- * 
- * @see LINX_EVENT_WEBSOCKET_CONNECTED
- * @see LINX_DEVICE_STATE_LISTENING
- * @see _linx_sdk_set_state
- */
-static void _linx_sdk_on_websocket_connected(void* user_data) {
-    LinxSdk* sdk = (LinxSdk*)user_data;
-    if (!sdk) return;
+LinxSdkError linx_sdk_add_uplink_stages(LinxSdk* sdk, audio_pipeline_t* pipeline) {
+    if (!sdk || !pipeline) {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
     
-    sdk->connected = true;
-    sdk->connect_time = time(NULL);
-    _linx_sdk_set_state(sdk, LINX_DEVICE_STATE_LISTENING);
+    if (sdk->uplink_ns || sdk->uplink_agc) {
+        return LINX_SDK_ERROR_NOT_INITIALIZED;
+    }
     
-    // 触发连接成功事件
-    LinxEvent event = {
-        .type = LINX_EVENT_WEBSOCKET_CONNECTED,
-        .timestamp = time(NULL)
-    };
+    // 接在已有的阶段之后（例如把麦克风阵列合成单声道的波束形成），按其输出的帧大小和声道数创建
+    size_t frame_samples = audio_pipeline_get_output_samples(pipeline);
+    uint32_t sample_rate = sdk->config.sample_rate ? sdk->config.sample_rate : 16000;
+    int channels = audio_pipeline_get_output_channels(pipeline);
+    audio_stage_t stages[2];
+    size_t count = 0;
     
-    if (sdk->event_callback) {
-        sdk->event_callback(&event, sdk->user_data);
+    if (sdk->config.noise_suppression) {
+        if (channels != 1) {
+            LOG_WARN("降噪只支持单声道，当前 %d 声道，不加入降噪", channels);
+        } else {
+            audio_ns_config_t ns_config = {
+                .sample_rate = sample_rate,
+                .frame_samples = frame_samples,
+                .max_suppression_db = sdk->config.ns_max_suppression_db,
+            };
+            sdk->uplink_ns = audio_ns_create(&ns_config);
+            if (!sdk->uplink_ns) {
+                return LINX_SDK_ERROR_MEMORY;
+            }
+            stages[count++] = audio_ns_stage(sdk->uplink_ns);
+        }
     }
     
-    LOG_INFO("WebSocket连接成功");
+    if (sdk->config.auto_gain) {
+        audio_agc_config_t agc_config = {
+            .sample_rate = sample_rate,
+            .frame_samples = frame_samples,
+            .channels = channels,
+            .target_dbfs = sdk->config.agc_target_dbfs,
+            .max_gain_db = sdk->config.agc_max_gain_db,
+        };
+        sdk->uplink_agc = audio_agc_create(&agc_config);
+        if (!sdk->uplink_agc) {
+            audio_ns_destroy(sdk->uplink_ns);
+            sdk->uplink_ns = NULL;
+            return LINX_SDK_ERROR_MEMORY;
+        }
+        stages[count++] = audio_agc_stage(sdk->uplink_agc);
+    }
+    
+    for (size_t i = 0; i < count; i++) {
+        if (audio_pipeline_add_stage(pipeline, &stages[i]) < 0) {
+            // 已加入的阶段引用着处理对象，保留到 SDK 销毁
+            LOG_ERROR("上行流水线无法加入 %s 阶段", stages[i].name);
+            return LINX_SDK_ERROR_INVALID_PARAM;
+        }
+    }
+    
+    LOG_INFO("上行前处理: 降噪%s，自动增益%s", sdk->uplink_ns ? "开" : "关", sdk->uplink_agc ? "开" : "关");
+    return LINX_SDK_SUCCESS;
+}
+
+LinxSdkError linx_sdk_report_uplink_loss(LinxSdk* sdk, int loss_perc) {
+    if (!sdk || loss_perc < 0 || loss_perc > 100) {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
+    
+    __atomic_store_n(&sdk->uplink_loss_perc, loss_perc, __ATOMIC_RELAXED);
+    return LINX_SDK_SUCCESS;
+}
+
+bool linx_sdk_get_uplink_target(LinxSdk* sdk, opus_rate_controller_target_t* target) {
+    if (!sdk || !target || !sdk->rate_controller) {
+        return false;
+    }
+    
+    pthread_mutex_lock(&sdk->uplink_mutex);
+    bool result = opus_rate_controller_get_target(sdk->rate_controller, target);
+    pthread_mutex_unlock(&sdk->uplink_mutex);
+    return result;
+}
+
+LinxDeviceState linx_sdk_get_state(LinxSdk* sdk) {
+    if (!sdk) {
+        return LINX_DEVICE_STATE_ERROR;
+    }
+    
+    return _linx_state_device(__atomic_load_n(&sdk->state_word, __ATOMIC_ACQUIRE));
+}
+
+LinxListenState linx_sdk_get_listen_state(LinxSdk* sdk) {
+    if (!sdk) {
+        return LINX_LISTEN_STATE_NONE;
+    }
+    
+    return _linx_state_listen(__atomic_load_n(&sdk->state_word, __ATOMIC_ACQUIRE));
+}
+
+LinxTtsState linx_sdk_get_tts_state(LinxSdk* sdk) {
+    if (!sdk) {
+        return LINX_TTS_STATE_NONE;
+    }
+    
+    return _linx_state_tts(__atomic_load_n(&sdk->state_word, __ATOMIC_ACQUIRE));
 }
 
 /**
- * @brief WebSocket连接断开回调函数
+ * @brief 发送一条上行音频消息
  * 
- * 当WebSocket连接断开时，该回调函数会被调用。函数会更新SDK的连接状态，
- * 设置设备状态为断开状态，并向应用程序发送断开连接事件。
- * 
- * @param user_data 用户数据指针，应该指向LinxSdk实例
- * 
- * @note 该函数在WebSocket线程上下文中被调用
- * @note 如果user_data为NULL，函数会安全返回
- * @note 断开连接后设备状态会自动切换到LINX_DEVICE_STATE_DISCONNECTED
- * @note 应用程序应该监听此事件以处理重连逻辑
- * 
- * @see LINX_EVENT_WEBSOCKET_DISCONNECTED
- * @see LINX_DEVICE_STATE_DISCONNECTED
- * @see _linx_sdk_set_state
+ * @param sdk 指向LinxSdk实例的指针
+ * @param data 音频数据 (单帧或合包后的 Opus 包)
+ * @param size 数据字节数
+ * @param timestamp 上行时间戳 (协议 v2)
  */
-static void _linx_sdk_on_websocket_disconnected(void* user_data) {
-    LinxSdk* sdk = (LinxSdk*)user_data;
-    if (!sdk) return;
+static LinxSdkError _linx_sdk_send_audio_packet(LinxSdk* sdk, const uint8_t* data, size_t size,
+                                                uint32_t timestamp) {
+    // 创建音频数据包并发送
+    linx_audio_stream_packet_t packet = {
+        .timestamp = timestamp,
+        .payload = (uint8_t*)data,
+        .payload_size = size
+    };
     
-    sdk->connected = false;
-    _linx_sdk_set_state(sdk, LINX_DEVICE_STATE_DISCONNECTED);
+    if (!sdk->connected || !linx_protocol_send_audio(_linx_sdk_protocol(sdk), &packet)) {
+        linx_metrics_add(&sdk->metrics, LINX_METRIC_UPLINK_DROPS, 1);
+        return LINX_SDK_ERROR_NETWORK;
+    }
     
-    // 触发断开连接事件
-    LinxEvent event = {
-        .type = LINX_EVENT_WEBSOCKET_DISCONNECTED,
-        .timestamp = time(NULL)
-    };
+    linx_metrics_add(&sdk->metrics, LINX_METRIC_UPLINK_PACKETS, 1);
+    linx_metrics_stage_end(&sdk->metrics, LINX_METRIC_WAKE_TO_FIRST_UPLINK);
+    // 最后一帧上行的时刻作为说话结束的近似，stt 到达时结束
+    linx_metrics_stage_touch(&sdk->metrics, LINX_METRIC_SPEECH_END_TO_STT);
+    linx_trace_mark_first(sdk->trace, LINX_TRACE_FIRST_UPLINK);
     
-    if (sdk->event_callback) {
-        sdk->event_callback(&event, sdk->user_data);
+    linx_websocket_uplink_stats_t stats;
+    if (linx_websocket_get_uplink_stats(sdk->ws_protocol, &stats)) {
+        linx_metrics_record(&sdk->metrics, LINX_METRIC_SEND_QUEUE_DEPTH, (uint32_t)stats.queued_audio_frames);
     }
     
-    LOG_INFO("WebSocket连接已断开");
+    return LINX_SDK_SUCCESS;
 }
 
 /**
- * @brief WebSocket错误回调函数
- * 
- * 当WebSocket连接发生错误时，该回调函数会被调用。函数会记录错误信息
- * 并向应用程序发送错误事件通知。
+ * @brief 发送合包器中尚未攒满的帧，调用方需持有 uplink_mutex
  * 
- * @param error_msg 错误消息字符串，可能为NULL
- * @param user_data 用户数据指针，应该指向LinxSdk实例
+ * @param sdk 指向LinxSdk实例的指针
+ */
+static uint64_t _linx_sdk_now_ms(void) {
+    return linx_os_now_ms();
+}
+
+/**
+ * @brief 按调速器的降级级数设置编码复杂度，调用方需持有 uplink_mutex
  * 
- * @note 该函数在WebSocket线程上下文中被调用
- * @note 如果user_data为NULL，函数会安全返回
- * @note 错误信息会被记录到SDK的错误状态中
- * @note 应用程序应该监听错误事件以处理异常情况
+ * 第 1 级为原复杂度的一半，第 2 级为 0；恢复到 0 级时还原编码器原本的复杂度。
  * 
- * @see LINX_SDK_ERROR_WEBSOCKET
- * @see _linx_sdk_set_error
- * @see LINX_EVENT_ERROR
+ * @return 没有注册编码器时返回 false
  */
-static void _linx_sdk_on_websocket_error(const char* error_msg, void* user_data) {
-    LinxSdk* sdk = (LinxSdk*)user_data;
-    if (!sdk) return;
-    
-    _linx_sdk_set_error(sdk, error_msg, LINX_SDK_ERROR_WEBSOCKET);
+static bool _linx_sdk_apply_complexity_locked(LinxSdk* sdk) {
+    if (!sdk->uplink_encoder) {
+        return sdk->uplink_complexity_level == 0;
+    }
+    if (sdk->uplink_complexity < 0) {
+        if (sdk->uplink_complexity_level == 0) {
+            return true;
+        }
+        sdk->uplink_complexity = opus_codec_get_complexity(sdk->uplink_encoder);
+        if (sdk->uplink_complexity < 0) {
+            return false;
+        }
+    }
+    int complexity = sdk->uplink_complexity - sdk->uplink_complexity * sdk->uplink_complexity_level / 2;
+    return opus_codec_set_complexity(sdk->uplink_encoder, complexity) == CODEC_SUCCESS;
 }
 
-static void _linx_sdk_on_websocket_message(const cJSON* root, void* user_data) {
+/**
+ * @brief 调速器的编码复杂度调节项（网络事件循环）
+ */
+static bool _linx_sdk_governor_complexity(void* user_data, int level) {
     LinxSdk* sdk = (LinxSdk*)user_data;
-    if (!sdk || !root) return;
-    
-    char* json_string = cJSON_Print(root);
-    if (!json_string) return;
-    
-    LOG_DEBUG("收到WebSocket消息: %s", json_string);
-    
-    // 获取消息类型
-    const cJSON* type = cJSON_GetObjectItem(root, "type");
-    if (!type || !cJSON_IsString(type)) {
-        LOG_ERROR("消息类型缺失或无效");
-        free(json_string);
-        return;
+    pthread_mutex_lock(&sdk->uplink_mutex);
+    int previous = sdk->uplink_complexity_level;
+    sdk->uplink_complexity_level = level;
+    bool applied = _linx_sdk_apply_complexity_locked(sdk);
+    if (!applied) {
+        sdk->uplink_complexity_level = previous;
     }
-    
-    // 处理hello响应
-    if (strcmp(type->valuestring, "hello") == 0) {
-        const cJSON* session_id = cJSON_GetObjectItem(root, "session_id");
-        if (session_id && cJSON_IsString(session_id)) {
-            _linx_sdk_set_session_id(sdk, session_id->valuestring);
-            LOG_INFO("会话建立，ID: %s", session_id->valuestring);
-            
-            // 触发会话建立事件
-            LinxEvent event = {
-                .type = LINX_EVENT_SESSION_ESTABLISHED,
-                .timestamp = time(NULL),
-                .data.session_established = {
-                    .session_id = session_id->valuestring
-                }
-            };
-            
-            if (sdk->event_callback) {
-                sdk->event_callback(&event, sdk->user_data);
-            }
-            
-            // 自动开始监听（如果配置了音频通道）
-            _linx_sdk_set_listen_state(sdk, "start");
-            linx_protocol_send_start_listening((linx_protocol_t*)sdk->ws_protocol, sdk->config.listening_mode);
-            LOG_INFO("开始语音监听");
-            
-            // 触发监听开始事件
-            LinxEvent listen_event = {
-                .type = LINX_EVENT_LISTENING_STARTED,
-                .timestamp = time(NULL)
-            };
-            
-            if (sdk->event_callback) {
-                sdk->event_callback(&listen_event, sdk->user_data);
-            }
-        }
+    pthread_mutex_unlock(&sdk->uplink_mutex);
+    return applied;
+}
+
+/**
+ * @brief 调速器的降噪强度调节项：第 1 级强度减半，第 2 级直通（网络事件循环）
+ */
+static bool _linx_sdk_governor_ns(void* user_data, int level) {
+    LinxSdk* sdk = (LinxSdk*)user_data;
+    static const int strengths[] = { 100, 50, 0 };
+    if (!sdk->uplink_ns || level < 0 || level > 2) {
+        return level == 0;
     }
-    // 处理TTS状态
-    else if (strcmp(type->valuestring, "tts") == 0) {
-        const cJSON* state = cJSON_GetObjectItem(root, "state");
-        if (state && cJSON_IsString(state)) {
-            _linx_sdk_set_tts_state(sdk, state->valuestring);
-            LOG_INFO("TTS状态: %s", state->valuestring);
-            
-            if (strcmp(state->valuestring, "start") == 0) {
-                // TTS开始播放，停止监听避免回音
-                _linx_sdk_set_listen_state(sdk, "stop");
-                if (sdk->ws_protocol) {
-                    linx_protocol_send_stop_listening((linx_protocol_t*)sdk->ws_protocol);
-                }
-                LOG_INFO("停止监听（TTS播放中）");
-                
-                // 触发TTS开始事件
-                LinxEvent event = {
-                    .type = LINX_EVENT_TTS_STARTED,
-                    .timestamp = time(NULL)
-                };
-                
-                if (sdk->event_callback) {
-                    sdk->event_callback(&event, sdk->user_data);
-                }
-            } else if (strcmp(state->valuestring, "stop") == 0) {
-                // TTS播放结束，重新开始监听
-                _linx_sdk_set_listen_state(sdk, "start");
-                if (sdk->ws_protocol) {
-                    linx_protocol_send_start_listening((linx_protocol_t*)sdk->ws_protocol, sdk->config.listening_mode);
-                }
-                LOG_INFO("恢复语音监听");
-                
-                // 触发TTS停止事件
-                LinxEvent event = {
-                    .type = LINX_EVENT_TTS_STOPPED,
-                    .timestamp = time(NULL)
-                };
-                
-                if (sdk->event_callback) {
-                    sdk->event_callback(&event, sdk->user_data);
-                }
-            } else if (strcmp(state->valuestring, "sentence_start") == 0) {
-                // TTS句子开始，处理文本内容
-                const cJSON* text = cJSON_GetObjectItem(root, "text");
-                if (text && cJSON_IsString(text)) {
-                    LOG_INFO("TTS句子开始: %s", text->valuestring);
-                    
-                    // 触发文本消息事件
-                    LinxEvent event = {
-                        .type = LINX_EVENT_SENTENCE_START,
-                        .timestamp = time(NULL),
-                        .data.text_message = {
-                            .text = text->valuestring,
-                            .role = "assistant"
-                        }
-                    };
-                    
-                    if (sdk->event_callback) {
-                        sdk->event_callback(&event, sdk->user_data);
-                    }
-                }
-            }
+    return audio_ns_set_strength(sdk->uplink_ns, strengths[level]) == 0;
+}
+
+/**
+ * @brief 调速器的日志级别调节项：第 1 级把日志级别提高到 WARN（网络事件循环）
+ */
+static bool _linx_sdk_governor_log_level(void* user_data, int level) {
+    LinxSdk* sdk = (LinxSdk*)user_data;
+    if (level > 0) {
+        log_level_t current = log_get_level();
+        if (sdk->governor_log_level < 0 && current < LOG_LEVEL_WARN) {
+            sdk->governor_log_level = (int)current;
+            log_set_level(LOG_LEVEL_WARN);
         }
+    } else if (sdk->governor_log_level >= 0) {
+        log_set_level((log_level_t)sdk->governor_log_level);
+        sdk->governor_log_level = -1;
     }
-    // 处理STT消息
-    else if (strcmp(type->valuestring, "stt") == 0) {
-        const cJSON* text = cJSON_GetObjectItem(root, "text");
-        if (text && cJSON_IsString(text)) {
-            LOG_INFO("STT识别结果: %s", text->valuestring);
-            
-            // 触发文本消息事件
-            LinxEvent event = {
-                .type = LINX_EVENT_TEXT_MESSAGE,
-                .timestamp = time(NULL),
-                .data.text_message = {
-                    .text = text->valuestring,
-                    .role = "assistant"
-                }
-            };
-            
-            if (sdk->event_callback) {
-                sdk->event_callback(&event, sdk->user_data);
-            }
-        }
+    return true;
+}
+
+/**
+ * @brief 事件循环的定时工作：到期时采样 CPU 负载和音频周期超时，由调速器调整一级质量
+ * 
+ * @param sdk 指向LinxSdk实例的指针
+ */
+static void _linx_sdk_service_governor(LinxSdk* sdk) {
+    if (!sdk->governor) {
+        return;
     }
-    // 处理LLM消息
-    else if (strcmp(type->valuestring, "llm") == 0) {
-        const cJSON* emotion = cJSON_GetObjectItem(root, "emotion");
-        if (emotion && cJSON_IsString(emotion)) {
-            LOG_INFO("LLM情感状态: %s", emotion->valuestring);
-            // 触发情感状态事件
-            LinxEvent event = {
-                .type = LINX_EVENT_EMOTION_MESSAGE,
-                .timestamp = time(NULL),
-                .data.emotion = {
-                    .value = emotion->valuestring
-                }
-            };
-            
-            if (sdk->event_callback) {
-                sdk->event_callback(&event, sdk->user_data);
-            }
+    uint64_t now = linx_os_now_ms();
+    if (linx_governor_next_timeout_ms(sdk->governor, now) > 0) {
+        return;
+    }
+    
+    uint64_t misses = __atomic_load_n(&sdk->metrics.data.counters[LINX_METRIC_DEADLINE_MISSES], __ATOMIC_RELAXED);
+    int direction = linx_governor_sample(sdk->governor, now, misses);
+    if (direction < 0) {
+        linx_metrics_add(&sdk->metrics, LINX_METRIC_GOVERNOR_DEGRADES, 1);
+    } else if (direction > 0) {
+        linx_metrics_add(&sdk->metrics, LINX_METRIC_GOVERNOR_RESTORES, 1);
+    }
+    
+    linx_governor_stats_t stats;
+    linx_governor_get_stats(sdk->governor, &stats);
+    if (stats.cpu_permille >= 0) {
+        linx_metrics_record(&sdk->metrics, LINX_METRIC_CPU_LOAD, (uint32_t)stats.cpu_permille);
+    }
+}
+
+/**
+ * @brief 事件循环的内存压力工作：执行收缩回调推迟过来的句子缓存清空，到期时检查一次水位
+ * 
+ * @param sdk 指向LinxSdk实例的指针
+ */
+static void _linx_sdk_service_memory(LinxSdk* sdk) {
+    if (sdk->config.memory_pressure) {
+        linx_mem_pressure_check(false);
+    }
+    
+    // 句子缓存只在事件循环上访问，收缩回调只留下标记；正在回放的条目被固定，不受影响
+    if (__atomic_exchange_n(&sdk->tts_cache_shrink, 0, __ATOMIC_ACQ_REL) && sdk->tts_cache) {
+        linx_tts_cache_stats_t stats;
+        size_t before = linx_tts_cache_get_stats(sdk->tts_cache, &stats) ? stats.bytes : 0;
+        linx_tts_cache_clear(sdk->tts_cache);
+        size_t after = linx_tts_cache_get_stats(sdk->tts_cache, &stats) ? stats.bytes : 0;
+        LOG_INFO("内存压力: 句子缓存释放 %zu 字节", before > after ? before - after : 0);
+    }
+}
+
+/**
+ * @brief 内存压力收缩回调：请求事件循环清空句子缓存（可能在任意线程上调用）
+ */
+static size_t _linx_sdk_shrink_tts_cache(void* user_data, linx_mem_pressure_level_t level) {
+    (void)level;
+    LinxSdk* sdk = (LinxSdk*)user_data;
+    __atomic_store_n(&sdk->tts_cache_shrink, 1, __ATOMIC_RELEASE);
+    if (sdk->ws_protocol) {
+        linx_websocket_wakeup(sdk->ws_protocol);
+    }
+    return 0;
+}
+
+/**
+ * @brief 内存压力档位变化的监听者，在执行检查的线程上调用
+ */
+static void _linx_sdk_on_memory_pressure(void* user_data, linx_mem_pressure_level_t level, size_t free_bytes) {
+    LinxSdk* sdk = (LinxSdk*)user_data;
+    
+    LinxEvent event = {0};
+    event.type = LINX_EVENT_MEMORY_PRESSURE;
+    event.timestamp = time(NULL);
+    event.data.memory_pressure.level = level;
+    event.data.memory_pressure.free_bytes = free_bytes;
+    _linx_sdk_emit_event(sdk, &event);
+}
+
+#if LINX_ENABLE_MCP
+/**
+ * @brief MCP 工具调用的剖析回调，在执行工具的线程上调用
+ */
+static void _linx_sdk_on_tool_profile(const mcp_tool_call_profile_t* profile, void* user_data) {
+    LinxSdk* sdk = (LinxSdk*)user_data;
+    
+    linx_metrics_add(&sdk->metrics, LINX_METRIC_MCP_TOOL_CALLS, 1);
+    linx_metrics_record(&sdk->metrics, LINX_METRIC_MCP_TOOL_ARGS, profile->args_us);
+    linx_metrics_record(&sdk->metrics, LINX_METRIC_MCP_TOOL_CALLBACK, profile->callback_us);
+    linx_metrics_record(&sdk->metrics, LINX_METRIC_MCP_TOOL_SERIALIZE, profile->serialize_us);
+    linx_metrics_record(&sdk->metrics, LINX_METRIC_MCP_TOOL_REPLY_SIZE, profile->reply_bytes);
+    if (!profile->slow) {
+        return;
+    }
+    linx_metrics_add(&sdk->metrics, LINX_METRIC_MCP_SLOW_TOOLS, 1);
+    
+    LinxEvent event = {0};
+    event.type = LINX_EVENT_MCP_SLOW_TOOL;
+    event.timestamp = time(NULL);
+    event.data.mcp_slow_tool.tool = (char*)profile->tool_name;
+    event.data.mcp_slow_tool.args_us = profile->args_us;
+    event.data.mcp_slow_tool.callback_us = profile->callback_us;
+    event.data.mcp_slow_tool.serialize_us = profile->serialize_us;
+    event.data.mcp_slow_tool.reply_bytes = profile->reply_bytes;
+    event.data.mcp_slow_tool.async = profile->async;
+    _linx_sdk_emit_event(sdk, &event);
+}
+#endif
+
+/**
+ * @brief 采集一次上行观测并把变化的编码参数下发给编码器，调用方需持有 uplink_mutex
+ * 
+ * @param sdk 指向LinxSdk实例的指针
+ */
+static void _linx_sdk_update_rate_control_locked(LinxSdk* sdk) {
+    if (!sdk->rate_controller || !sdk->uplink_encoder || !sdk->ws_protocol) {
+        return;
+    }
+    
+    linx_websocket_uplink_stats_t stats;
+    if (!linx_websocket_get_uplink_stats(sdk->ws_protocol, &stats)) {
+        return;
+    }
+    
+    opus_rate_controller_sample_t sample = {
+        .queued_frames = stats.queued_audio_frames,
+        .backlog_bytes = stats.send_backlog_bytes,
+        .rtt_ms = stats.rtt_valid ? (int)stats.srtt_ms : -1,
+        // 每次上报只计入一次
+        .loss_perc = __atomic_exchange_n(&sdk->uplink_loss_perc, -1, __ATOMIC_RELAXED)
+    };
+    
+    if (opus_rate_controller_update(sdk->rate_controller, &sample, _linx_sdk_now_ms())) {
+        opus_rate_controller_target_t target;
+        opus_rate_controller_get_target(sdk->rate_controller, &target);
+        LOG_INFO("上行编码参数调整: 码率=%d bps, 预期丢包=%d%%, FEC=%s (积压 %zu 帧/%zu 字节, RTT %d ms)",
+                 target.bitrate, target.packet_loss_perc, target.inband_fec ? "开" : "关",
+                 sample.queued_frames, sample.backlog_bytes, sample.rtt_ms);
+    }
+    
+    if (opus_rate_controller_apply(sdk->rate_controller, sdk->uplink_encoder) != CODEC_SUCCESS) {
+        LOG_WARN("上行编码参数下发失败");
+    }
+}
+
+/**
+ * @brief 执行快速启动推迟的初始化，只执行一次
+ * 
+ * 启动MCP线程池并放行暂缓的OTA请求。在网络线程上调用，与工具调用的分发
+ * 在同一线程，线程池启动前到达的异步工具已同步执行完毕。
+ * 
+ * @param sdk 指向LinxSdk实例的指针
+ */
+#if LINX_ENABLE_MCP
+/**
+ * 在后台任务执行器上启动MCP线程池；应用未提供执行器时创建SDK自己的
+ */
+static void _linx_sdk_start_mcp_workers(LinxSdk* sdk) {
+    if (!sdk->executor) {
+        linx_executor_config_t config = { .workers = MCP_DEFAULT_WORKER_COUNT };
+        linx_executor_t* executor = linx_executor_create(&config);
+        sdk->owns_executor = executor != NULL;
+        __atomic_store_n(&sdk->executor, executor, __ATOMIC_RELEASE);
+    }
+    if (!sdk->executor || !mcp_server_start_workers_on(sdk->mcp_server, sdk->executor, 0)) {
+        LOG_WARN("MCP线程池启动失败，异步工具将同步执行");
+    }
+}
+#endif
+
+static void _linx_sdk_run_deferred_boot(LinxSdk* sdk) {
+    if (!__atomic_exchange_n(&sdk->boot_deferred, false, __ATOMIC_ACQ_REL)) {
+        return;
+    }
+    
+#if LINX_ENABLE_MCP
+    if (sdk->mcp_workers_deferred) {
+        sdk->mcp_workers_deferred = false;
+        _linx_sdk_start_mcp_workers(sdk);
+    }
+#endif
+    
+    // 暂缓的OTA请求在下一轮事件循环中启动
+    if (sdk->ws_protocol) {
+        linx_websocket_wakeup(sdk->ws_protocol);
+    }
+    
+    linx_boot_mark(LINX_BOOT_DEFERRED_READY);
+    LOG_INFO("快速启动推迟的初始化已完成");
+}
+
+/**
+ * @brief 开启 zero_alloc_assert 时打开/关闭零分配检查，每个会话只计一次
+ * 
+ * @param sdk 指向LinxSdk实例的指针
+ * @param armed true 为会话建立后打开，false 为断开时关闭
+ */
+static void _linx_sdk_set_zero_alloc_armed(LinxSdk* sdk, bool armed) {
+    if (!sdk->config.zero_alloc_assert) {
+        return;
+    }
+    if (__atomic_exchange_n(&sdk->zero_alloc_armed, armed, __ATOMIC_ACQ_REL) == armed) {
+        return;
+    }
+    if (armed) {
+        linx_alloc_no_alloc_arm();
+        LOG_INFO("零分配检查已打开");
+    } else {
+        linx_alloc_no_alloc_disarm();
+    }
+}
+
+static LinxSdkError _linx_sdk_flush_uplink_locked(LinxSdk* sdk) {
+    if (opus_frame_bundler_pending(sdk->uplink_bundler) == 0) {
+        return LINX_SDK_SUCCESS;
+    }
+    
+    const uint8_t* packet = NULL;
+    size_t packet_size = 0;
+    if (opus_frame_bundler_flush(sdk->uplink_bundler, &packet, &packet_size) != CODEC_SUCCESS) {
+        return LINX_SDK_ERROR_UNKNOWN;
+    }
+    
+    return packet ? _linx_sdk_send_audio_packet(sdk, packet, packet_size,
+                                                __atomic_load_n(&sdk->uplink_timestamp, __ATOMIC_RELAXED))
+                  : LINX_SDK_SUCCESS;
+}
+
+// ============================================================================
+// 内部函数实现
+// ============================================================================
+
+/**
+ * @brief 原子地更新状态字（设备状态、监听状态、TTS状态）
+ * 
+ * 三个字段在同一次 CAS 中更新，读取方任何时候看到的都是一致的组合。
+ * 设备状态只按 s_device_transitions 中允许的方向变化，不允许的设备状态变化
+ * （如断开后迟到的 tts start 要求进入 SPEAKING）被忽略，其余字段照常更新；
+ * 设备状态不是 LISTENING/SPEAKING 时监听和TTS状态总是 NONE。
+ * 
+ * @param sdk 指向LinxSdk实例的指针，不能为NULL
+ * @param device 新的设备状态，LINX_STATE_KEEP 表示不变
+ * @param listen 新的监听状态，LINX_STATE_KEEP 表示不变
+ * @param tts 新的TTS状态，LINX_STATE_KEEP 表示不变
+ * 
+ * @return 设备状态发生了变化返回 true（此时已发出 LINX_EVENT_STATE_CHANGED）
+ * 
+ * @note 该函数是线程安全的，不加锁；并发的状态变化事件按各自 CAS 成功的先后发出
+ * 
+ * @see LinxDeviceState
+ * @see LINX_EVENT_STATE_CHANGED
+ */
+static bool _linx_sdk_transition(LinxSdk* sdk, int device, int listen, int tts) {
+    uint32_t old_word = __atomic_load_n(&sdk->state_word, __ATOMIC_ACQUIRE);
+    uint32_t new_word;
+    LinxDeviceState old_device;
+    LinxDeviceState new_device;
+    
+    do {
+        old_device = _linx_state_device(old_word);
+        new_device = old_device;
+        if (device != LINX_STATE_KEEP && (s_device_transitions[old_device] & LINX_STATE_BIT(device))) {
+            new_device = (LinxDeviceState)device;
         }
         
-    }
-    // 处理MCP消息
-    else if (strcmp(type->valuestring, "mcp") == 0) {
-        const cJSON* payload = cJSON_GetObjectItem(root, "payload");
-        if (payload && cJSON_IsObject(payload)) {
-            char* payload_str = cJSON_Print(payload);
-            if (payload_str) {
-                LOG_INFO("收到MCP消息: %s", payload_str);
-
-
-                 // 如果启用了MCP，将消息传递给MCP服务器处理
-                if (sdk->mcp_server) {
-                    mcp_server_parse_message(sdk->mcp_server, payload_str);
-                } 
-                
-                // 触发MCP消息事件
-                LinxEvent event = {
-                    .type = LINX_EVENT_MCP_MESSAGE,
-                    .timestamp = time(NULL),
-                    .data.mcp_message = {
-                        .message = payload_str,
-                        .type = "mcp"
-                    }
-                };
-                
-                if (sdk->event_callback) {
-                    sdk->event_callback(&event, sdk->user_data);
-                }
-                
-                free(payload_str);
-            }
+        LinxListenState new_listen = listen == LINX_STATE_KEEP ? _linx_state_listen(old_word) : (LinxListenState)listen;
+        LinxTtsState new_tts = tts == LINX_STATE_KEEP ? _linx_state_tts(old_word) : (LinxTtsState)tts;
+        if (new_device != LINX_DEVICE_STATE_LISTENING && new_device != LINX_DEVICE_STATE_SPEAKING) {
+            new_listen = LINX_LISTEN_STATE_NONE;
+            new_tts = LINX_TTS_STATE_NONE;
         }
-    }
-    // 处理系统命令消息
-    else if (strcmp(type->valuestring, "system") == 0) {
-        const cJSON* command = cJSON_GetObjectItem(root, "command");
-        if (command && cJSON_IsString(command)) {
-            LOG_INFO("系统命令: %s", command->valuestring);
-            
-            // 触发MCP消息事件
-            LinxEvent event = {
-                .type = LINX_EVENT_SYSTEM_MESSAGE,
-                .timestamp = time(NULL),
-                .data.system_message = {
-                    .message = command->valuestring
-                }
-            };
-            
-            if (sdk->event_callback) {
-                sdk->event_callback(&event, sdk->user_data);
-            }
-                
+        
+        new_word = _linx_state_pack(new_device, new_listen, new_tts);
+        if (new_word == old_word) {
+            break;
         }
+    } while (!__atomic_compare_exchange_n(&sdk->state_word, &old_word, new_word, true,
+                                          __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+    
+    if (device != LINX_STATE_KEEP && device != (int)old_device && new_device == old_device) {
+        LOG_DEBUG("忽略状态转换: %d -> %d", old_device, device);
+    }
+    if (new_device == old_device) {
+        return false;
     }
-    // 处理警告消息
-    else if (strcmp(type->valuestring, "alert") == 0) {
-        const cJSON* status = cJSON_GetObjectItem(root, "status");
-        const cJSON* message = cJSON_GetObjectItem(root, "message");
-        const cJSON* emotion = cJSON_GetObjectItem(root, "emotion");
+    
+    LOG_DEBUG("状态变化: %d -> %d", old_device, new_device);
+    LINX_TRACEPOINT(state, old_device, new_device);
+    
+    // 发送状态变化事件
+    if (sdk->event_callback) {
+        LinxEvent event = {0};
+        event.type = LINX_EVENT_STATE_CHANGED;
+        event.timestamp = time(NULL);
+        event.data.state_changed.old_state = old_device;
+        event.data.state_changed.new_state = new_device;
         
-        if (status && cJSON_IsString(status) && 
-            message && cJSON_IsString(message) && 
-            emotion && cJSON_IsString(emotion)) {
-            
-            LOG_WARN("警告消息 - 状态: %s, 消息: %s, 情感: %s", 
-                     status->valuestring, message->valuestring, emotion->valuestring);
-            
-            // 触发错误事件（警告作为特殊的错误事件处理）
-            LinxEvent event = {
-                .type = LINX_EVENT_ERROR,
-                .timestamp = time(NULL),
-                .data.error = {
-                    .message = message->valuestring,
-                    .code = 0  // 警告级别错误代码
-                }
-            };
-            
-            if (sdk->event_callback) {
-                sdk->event_callback(&event, sdk->user_data);
-            }
-        } else {
-            LOG_WARN("警告消息格式不完整，需要status、message和emotion字段");
-        }
-    }
-    // 处理自定义消息
-    else if (strcmp(type->valuestring, "custom") == 0) {
-        const cJSON* payload = cJSON_GetObjectItem(root, "payload");
-        if (payload && cJSON_IsObject(payload)) {
-            char* payload_str = cJSON_Print(payload);
-            if (payload_str) {
-                LOG_INFO("收到自定义消息: %s", payload_str);
-                
-                // 触发文本消息事件（自定义消息作为系统消息处理）
-                LinxEvent event = {
-                    .type = LINX_EVENT_CUSTOM_MESSAGE,
-                    .timestamp = time(NULL),
-                    .data.custom_message = {
-                        .value = payload_str
-                    }
-                };
-                
-                if (sdk->event_callback) {
-                    sdk->event_callback(&event, sdk->user_data);
+        _linx_sdk_emit_event(sdk, &event);
+    }
+    return true;
+}
+
+/**
+ * @brief 设置SDK设备状态并触发状态变化事件
+ * 
+ * @param sdk 指向LinxSdk实例的指针
+ * @param new_state 新的设备状态
+ * 
+ * @note 如果sdk为NULL，函数会安全返回而不执行任何操作
+ * 
+ * @see _linx_sdk_transition
+ */
+static void _linx_sdk_set_state(LinxSdk* sdk, LinxDeviceState new_state) {
+    if (!sdk) {
+        return;
+    }
+    
+    _linx_sdk_transition(sdk, new_state, LINX_STATE_KEEP, LINX_STATE_KEEP);
+}
+
+/**
+ * @brief 向应用程序发射事件通知
+ * 
+ * 这是一个内部函数，用于安全地向应用程序发送事件通知。该函数会检查
+ * 所有必要的条件（SDK实例、事件对象、回调函数），确保事件能够正确传递。
+ * 
+ * @param sdk 指向LinxSdk实例的指针，不能为NULL
+ * @param event 指向要发送的事件对象的指针，不能为NULL
+ * 
+ * @note 该函数是线程安全的，可以在多线程环境中调用
+ * @note 如果sdk、event为NULL或未设置事件回调，函数会安全返回
+ * @note 事件回调在调用线程的上下文中执行，应用程序需要确保回调函数的线程安全性
+ * @note 回调期间暂停本线程的 cJSON 竞技场，应用代码得到的是普通堆内存
+ * 
+ * @see LinxEvent
+ * @see LinxEventCallback
+ * @see linx_sdk_set_event_callback
+ */
+static void _linx_sdk_emit_event(LinxSdk* sdk, const LinxEvent* event) {
+    if (!sdk || !event || !sdk->event_callback) {
+        return;
+    }
+    
+    // 未订阅的事件在复制之前丢弃
+    uint32_t mask = __atomic_load_n(&sdk->event_mask, __ATOMIC_RELAXED);
+    if (mask && !(mask & LINX_EVENT_MASK(event->type))) {
+        return;
+    }
+    
+    // 队列模式：复制成SDK持有的事件，网络线程不等待应用处理
+    if (sdk->event_queue) {
+        if (!linx_event_queue_push(sdk->event_queue, event, linx_websocket_get_packet_pool(sdk->ws_protocol))) {
+            LOG_WARN("事件入队失败，类型: %d", event->type);
+        }
+        return;
+    }
+    
+    // 同步回调：音频数据攒到本次循环迭代结束时一起回调，其他事件先送出已攒的批次保持顺序
+    if (_linx_sdk_batches_audio(sdk)) {
+        if (event->type == LINX_EVENT_AUDIO_DATA && event->data.audio_data.value) {
+            linx_audio_stream_packet_t* packet = linx_audio_packet_pool_retain(
+                linx_websocket_get_packet_pool(sdk->ws_protocol), event->data.audio_data.value);
+            if (packet) {
+                pthread_mutex_lock(&sdk->audio_batch_mutex);
+                sdk->audio_batch[sdk->audio_batch_count++] = packet;
+                bool full = sdk->audio_batch_count == LINX_SDK_AUDIO_BATCH_MAX;
+                pthread_mutex_unlock(&sdk->audio_batch_mutex);
+                if (full) {
+                    _linx_sdk_flush_audio_batch(sdk);
                 }
-                
-                free(payload_str);
+                return;
             }
+            // 复制失败时退回单个事件回调
+            _linx_sdk_flush_audio_batch(sdk);
         } else {
-            LOG_WARN("自定义消息格式无效：缺少payload字段");
+            _linx_sdk_flush_audio_batch(sdk);
+        }
+    }
+    
+    // 文本事件复制到历史的节点中，字符串在回调返回后仍然有效
+    LinxEvent* kept = NULL;
+    if (sdk->text_history && linx_event_history_accepts(event->type)) {
+        kept = linx_event_history_copy(sdk->text_history, event);
+        if (kept) {
+            linx_event_history_keep(sdk->text_history, kept);
+            event = kept;
         }
     }
-    // 处理其他消息类型
-    else {
-        LOG_WARN("未知消息类型: %s", type->valuestring);
+    
+    bool arena_suspended = linx_json_arena_suspend();
+    sdk->event_callback(event, sdk->user_data);
+    linx_json_arena_resume(arena_suspended);
+    linx_event_release(kept);
+}
+
+/**
+ * @brief 同步回调方式下是否把音频数据攒成批次
+ * 
+ * 共用连接的实例在对方的网络线程上收到音频，不按本实例的循环迭代攒批。
+ */
+static bool _linx_sdk_batches_audio(LinxSdk* sdk) {
+    return (sdk->config.event_coalesce & LINX_EVENT_COALESCE_AUDIO) && !sdk->config.shared_connection;
+}
+
+/**
+ * @brief 送出同步回调方式下攒好的音频批次
+ * 
+ * 在网络线程上调用：事件循环每次迭代结束时、批次满时、其他事件回调之前。
+ * 
+ * @param sdk 指向LinxSdk实例的指针
+ */
+static void _linx_sdk_flush_audio_batch(LinxSdk* sdk) {
+    linx_audio_stream_packet_t* packets[LINX_SDK_AUDIO_BATCH_MAX];
+    
+    pthread_mutex_lock(&sdk->audio_batch_mutex);
+    size_t count = sdk->audio_batch_count;
+    memcpy(packets, sdk->audio_batch, count * sizeof(packets[0]));
+    sdk->audio_batch_count = 0;
+    pthread_mutex_unlock(&sdk->audio_batch_mutex);
+    
+    if (count == 0) {
+        return;
+    }
+    
+    LinxEventCallback callback = sdk->event_callback;
+    if (callback) {
+        LinxEvent event = {0};
+        event.type = LINX_EVENT_AUDIO_BATCH;
+        event.timestamp = time(NULL);
+        event.data.audio_batch.packets = packets;
+        event.data.audio_batch.count = count;
+        
+        bool arena_suspended = linx_json_arena_suspend();
+        callback(&event, sdk->user_data);
+        linx_json_arena_resume(arena_suspended);
+    }
+    
+    for (size_t i = 0; i < count; i++) {
+        linx_audio_stream_packet_destroy(packets[i]);
+    }
+}
+
+/**
+ * @brief 丢弃尚未送出的音频批次（销毁时调用）
+ */
+static void _linx_sdk_discard_audio_batch(LinxSdk* sdk) {
+    pthread_mutex_lock(&sdk->audio_batch_mutex);
+    for (size_t i = 0; i < sdk->audio_batch_count; i++) {
+        linx_audio_stream_packet_destroy(sdk->audio_batch[i]);
+    }
+    sdk->audio_batch_count = 0;
+    pthread_mutex_unlock(&sdk->audio_batch_mutex);
+}
+
+/**
+ * @brief 设置SDK错误信息并触发错误事件
+ * 
+ * 这是一个内部函数，用于记录SDK运行过程中发生的错误，并向应用程序
+ * 发送错误事件通知。该函数会安全地处理错误消息的存储和事件的发送。
+ * 
+ * @param sdk 指向LinxSdk实例的指针，不能为NULL
+ * @param error_msg 错误消息字符串，可以为NULL
+ * @param error_code 错误代码，通常对应LinxSdkError枚举值
+ * 
+ * @note 该函数是线程安全的，可以在多线程环境中调用
+ * @note 错误消息会被截断以适应内部缓冲区大小，并确保字符串正确终止
+ * @note 如果error_msg为NULL，将使用"未知错误"作为默认消息
+ * @note 错误信息会自动记录到日志系统中
+ * 
+ * @see LinxSdkError
+ * @see LINX_EVENT_ERROR
+ * @see _linx_sdk_emit_event
+ */
+static void _linx_sdk_set_error(LinxSdk* sdk, const char* error_msg, int error_code) {
+    if (!sdk) {
+        return;
+    }
+    
+    // 保存错误信息
+    if (error_msg) {
+        strncpy(sdk->last_error, error_msg, sizeof(sdk->last_error) - 1);
+        sdk->last_error[sizeof(sdk->last_error) - 1] = '\0';
+    }
+    
+    LOG_ERROR("错误: %s (代码: %d)", error_msg ? error_msg : "未知错误", error_code);
+    
+    // 发送错误事件
+    if (sdk->event_callback) {
+        LinxEvent event = {0};
+        event.type = LINX_EVENT_ERROR;
+        event.timestamp = time(NULL);
+        event.data.error.message = sdk->last_error;
+        event.data.error.code = error_code;
+        
+        _linx_sdk_emit_event(sdk, &event);
+    }
+}
+
+bool linx_sdk_is_connected(LinxSdk* sdk) {
+    if (!sdk) {
+        return false;
+    }
+    
+    return sdk->connected;
+}
+
+uint32_t linx_sdk_get_message_count(LinxSdk* sdk) {
+    if (!sdk) {
+        return 0;
+    }
+    
+    return sdk->message_count;
+}
+
+time_t linx_sdk_get_connect_time(LinxSdk* sdk) {
+    if (!sdk) {
+        return 0;
+    }
+    return sdk->connect_time;
+}
+
+LinxSdkError linx_sdk_get_metrics(LinxSdk* sdk, linx_metrics_snapshot_t* snapshot) {
+    if (!sdk || !snapshot) {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
+    
+    linx_metrics_snapshot(&sdk->metrics, snapshot);
+    return LINX_SDK_SUCCESS;
+}
+
+LinxSdkError linx_sdk_set_governor_knob(LinxSdk* sdk, linx_governor_knob_id_t knob, int levels,
+                                        linx_governor_apply_t apply, void* user_data) {
+    if (!sdk) {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
+    
+    if (!sdk->governor) {
+        return LINX_SDK_ERROR_NOT_INITIALIZED;
+    }
+    
+    if (!linx_governor_set_knob(sdk->governor, knob, levels, apply, user_data)) {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
+    return LINX_SDK_SUCCESS;
+}
+
+bool linx_sdk_get_governor_stats(LinxSdk* sdk, linx_governor_stats_t* stats) {
+    if (!sdk || !sdk->governor || !stats) {
+        return false;
+    }
+    
+    linx_governor_get_stats(sdk->governor, stats);
+    return true;
+}
+
+char* linx_sdk_get_metrics_json(LinxSdk* sdk) {
+    if (!sdk) {
+        return NULL;
+    }
+    
+    // 快照约 6KB，放在堆上以免占用调用线程的小栈
+    linx_metrics_snapshot_t* snapshot = (linx_metrics_snapshot_t*)LINX_MALLOC(sizeof(linx_metrics_snapshot_t));
+    if (!snapshot) {
+        return NULL;
+    }
+    linx_metrics_snapshot(&sdk->metrics, snapshot);
+    char* json = linx_metrics_to_json(snapshot);
+    LINX_FREE(snapshot);
+    return json;
+}
+
+linx_metrics_t* linx_sdk_get_metrics_recorder(LinxSdk* sdk) {
+    return sdk ? &sdk->metrics : NULL;
+}
+
+char* linx_sdk_get_trace_json(LinxSdk* sdk) {
+    return sdk ? linx_trace_to_chrome_json(sdk->trace) : NULL;
+}
+
+LinxSdkError linx_sdk_trace_mark(LinxSdk* sdk, linx_trace_point_t point) {
+    if (!sdk || (unsigned)point >= LINX_TRACE_POINT_COUNT) {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
+    if (!sdk->trace) {
+        return LINX_SDK_ERROR_NOT_INITIALIZED;
+    }
+    linx_trace_mark_first(sdk->trace, point);
+    return LINX_SDK_SUCCESS;
+}
+
+linx_trace_t* linx_sdk_get_trace(LinxSdk* sdk) {
+    return sdk ? sdk->trace : NULL;
+}
+
+linx_tts_cache_t* linx_sdk_get_tts_cache(LinxSdk* sdk) {
+    return sdk ? sdk->tts_cache : NULL;
+}
+
+LinxSdkError linx_sdk_get_playback_position(LinxSdk* sdk, linx_player_position_t* position) {
+    if (!sdk || !position) {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
+    linx_player_t* player = __atomic_load_n(&sdk->player, __ATOMIC_ACQUIRE);
+    if (!player || linx_player_get_position(player, position) != PLAYER_SUCCESS) {
+        return LINX_SDK_ERROR_NOT_INITIALIZED;
+    }
+    return LINX_SDK_SUCCESS;
+}
+
+/**
+ * @brief 向服务端上报下行音频的播出位置（协商了 playback_position 且有 TTS 时间戳时）
+ */
+static void _linx_sdk_report_playback_position(LinxSdk* sdk) {
+    if (!__atomic_load_n(&sdk->playback_position_active, __ATOMIC_RELAXED) || !sdk->connected || !sdk->ws_protocol) {
+        return;
+    }
+    linx_player_t* player = __atomic_load_n(&sdk->player, __ATOMIC_ACQUIRE);
+    linx_player_position_t position;
+    if (!player || linx_player_get_position(player, &position) != PLAYER_SUCCESS || !position.has_timestamp) {
+        return;
+    }
+    linx_protocol_send_playback_position(_linx_sdk_protocol(sdk), position.timestamp,
+                                         position.output_delay_us / 1000u);
+}
+
+// WebSocket回调函数实现
+/**
+ * @brief WebSocket连接成功回调函数
+ * 
+ * 当WebSocket连接成功建立时，该回调函数会被调用。函数会更新SDK的连接状态，
+ * 记录连接时间，设置设备状态为监听状态，并向应用程序发送连接成功事件。
+ * 
+ * @param user_data 用户数据指针，应该指向LinxSdk实例
+ * 
+ * @note 该函数在WebSocket线程上下文中被调用
+ * @note 如果user_data为NULL，函数会安全返回
+ * @note 连接成功后设备状态会自动切换到LINX_DEVICE_STATE_LISTENING
+ * @note 连接时间会被记录用于统计和调试
+ * 
+ * @see LINX_EVENT_WEBSOCKET_CONNECTED
+ * @see LINX_DEVICE_STATE_LISTENING
+ * @see _linx_sdk_set_state
+ */
+static void _linx_sdk_on_websocket_connected(void* user_data) {
+    LinxSdk* sdk = (LinxSdk*)user_data;
+    if (!sdk) return;
+    
+    sdk->connected = true;
+    sdk->connect_time = time(NULL);
+    _linx_sdk_set_state(sdk, LINX_DEVICE_STATE_LISTENING);
+    linx_boot_mark(LINX_BOOT_WS_CONNECTED);
+    _linx_sdk_endpoint_on_connected(sdk);
+    
+    // 新连接的 RTT 基线和丢包统计需要重新建立
+    if (sdk->rate_controller) {
+        pthread_mutex_lock(&sdk->uplink_mutex);
+        opus_rate_controller_reset(sdk->rate_controller);
+        pthread_mutex_unlock(&sdk->uplink_mutex);
+    }
+    
+    // 触发连接成功事件
+    LinxEvent event = {
+        .type = LINX_EVENT_WEBSOCKET_CONNECTED,
+        .timestamp = time(NULL)
+    };
+    
+    _linx_sdk_emit_event(sdk, &event);
+    _linx_sdk_touch_activity(sdk);
+    
+    LOG_INFO("WebSocket连接成功");
+}
+
+/**
+ * @brief WebSocket连接断开回调函数
+ * 
+ * 当WebSocket连接断开时，该回调函数会被调用。函数会更新SDK的连接状态，
+ * 设置设备状态为断开状态，并向应用程序发送断开连接事件。
+ * 
+ * @param user_data 用户数据指针，应该指向LinxSdk实例
+ * 
+ * @note 该函数在WebSocket线程上下文中被调用
+ * @note 如果user_data为NULL，函数会安全返回
+ * @note 断开连接后设备状态会自动切换到LINX_DEVICE_STATE_DISCONNECTED；
+ *       开启 auto_reconnect 且仍在重连时切换到LINX_DEVICE_STATE_CONNECTING
+ * @note 未开启 auto_reconnect 时，应用程序应该监听此事件以处理重连逻辑
+ * 
+ * @see LINX_EVENT_WEBSOCKET_DISCONNECTED
+ * @see LINX_DEVICE_STATE_DISCONNECTED
+ * @see _linx_sdk_set_state
+ */
+static void _linx_sdk_on_websocket_disconnected(void* user_data) {
+    LinxSdk* sdk = (LinxSdk*)user_data;
+    if (!sdk) return;
+    
+    bool was_connected = sdk->connected;
+    sdk->connected = false;
+    _linx_sdk_set_zero_alloc_armed(sdk, false);
+    bool reconnecting = linx_websocket_is_reconnecting(sdk->ws_protocol);
+    _linx_sdk_endpoint_on_disconnected(sdk, was_connected, reconnecting);
+    pthread_mutex_lock(&sdk->state_mutex);
+    sdk->session_ready = false;
+    pthread_mutex_unlock(&sdk->state_mutex);
+    
+    // 重连期间的音频重新进入连接前缓冲；不再重连时未发送的唤醒词和推测式会话作废，
+    // 重连时等待确认的推测式会话在新会话上重新等待
+    pthread_mutex_lock(&sdk->uplink_mutex);
+    sdk->uplink_open = false;
+    if (!reconnecting) {
+        sdk->pending_wake_word[0] = '\0';
+        sdk->wake_speculation = LINX_WAKE_SPEC_NONE;
+    } else if (sdk->wake_speculation == LINX_WAKE_SPEC_HELD) {
+        sdk->wake_speculation = LINX_WAKE_SPEC_CONNECTING;
+    }
+    pthread_mutex_unlock(&sdk->uplink_mutex);
+    _linx_sdk_set_state(sdk, reconnecting ? LINX_DEVICE_STATE_CONNECTING : LINX_DEVICE_STATE_DISCONNECTED);
+    _linx_sdk_tts_cache_reset(sdk);
+    sdk->tts_cache_active = false;
+    __atomic_store_n(&sdk->playback_position_active, false, __ATOMIC_RELAXED);
+    if (reconnecting) {
+        linx_metrics_add(&sdk->metrics, LINX_METRIC_RECONNECTS, 1);
+    } else {
+        linx_metrics_stage_cancel(&sdk->metrics, LINX_METRIC_WAKE_TO_FIRST_UPLINK);
+    }
+    
+    // 触发断开连接事件
+    LinxEvent event = {
+        .type = LINX_EVENT_WEBSOCKET_DISCONNECTED,
+        .timestamp = time(NULL)
+    };
+    
+    _linx_sdk_emit_event(sdk, &event);
+    if (!reconnecting) {
+        _linx_sdk_finish_connect_future(sdk, LINX_SDK_ERROR_NETWORK);
+    }
+    
+    LOG_INFO(reconnecting ? "WebSocket连接已断开，等待自动重连" : "WebSocket连接已断开");
+}
+
+/**
+ * @brief WebSocket错误回调函数
+ * 
+ * 当WebSocket连接发生错误时，该回调函数会被调用。函数会记录错误信息
+ * 并向应用程序发送错误事件通知。
+ * 
+ * @param error_msg 错误消息字符串，可能为NULL
+ * @param user_data 用户数据指针，应该指向LinxSdk实例
+ * 
+ * @note 该函数在WebSocket线程上下文中被调用
+ * @note 如果user_data为NULL，函数会安全返回
+ * @note 错误信息会被记录到SDK的错误状态中
+ * @note 应用程序应该监听错误事件以处理异常情况
+ * 
+ * @see LINX_SDK_ERROR_WEBSOCKET
+ * @see _linx_sdk_set_error
+ * @see LINX_EVENT_ERROR
+ */
+static void _linx_sdk_on_websocket_error(const char* error_msg, void* user_data) {
+    LinxSdk* sdk = (LinxSdk*)user_data;
+    if (!sdk) return;
+    
+    _linx_sdk_set_error(sdk, error_msg, LINX_SDK_ERROR_WEBSOCKET);
+}
+
+/**
+ * @brief 处理"hello"类型的服务器消息（hello响应）
+ * 
+ * @param root 完整的消息JSON对象
+ * @param user_data 指向LinxSdk实例的指针
+ */
+static void _linx_sdk_handle_hello_message(const cJSON* root, void* user_data) {
+    LinxSdk* sdk = (LinxSdk*)user_data;
+    
+    const cJSON* session_id = cJSON_GetObjectItemCaseSensitive(root, "session_id");
+    if (session_id && cJSON_IsString(session_id)) {
+        _linx_sdk_set_session_id(sdk, session_id->valuestring);
+        pthread_mutex_lock(&sdk->state_mutex);
+        sdk->session_ready = true;
+        pthread_mutex_unlock(&sdk->state_mutex);
+        linx_boot_mark(LINX_BOOT_SESSION_READY);
+        
+        // 服务端可能在 hello 中改用其他音频格式
+        char audio_format[sizeof(sdk->config.audio_format)];
+        if (linx_sdk_get_audio_format(sdk, audio_format, sizeof(audio_format)) != LINX_SDK_SUCCESS) {
+            snprintf(audio_format, sizeof(audio_format), "%s", sdk->config.audio_format);
+        }
+        LinxSessionParams params;
+        if (sdk->ws_protocol && linx_websocket_get_session_params(sdk->ws_protocol, &params)) {
+            _linx_sdk_session_cache_on_hello(sdk, session_id->valuestring, &params);
+        } else {
+            memset(&params, 0, sizeof(params));
+            params.frame_duration = sdk->config.uplink_frame_duration_ms;
+        }
+        LOG_INFO("会话%s，ID: %s，音频格式: %s，帧长: %dms，协议版本: %d，可选特性: 0x%x",
+                 linx_websocket_is_session_resumed(sdk->ws_protocol) ? "已恢复" : "建立",
+                 session_id->valuestring, audio_format, params.frame_duration, params.version,
+                 (unsigned)params.audio_features);
+        
+        // 服务端接受 tts_cache 时才使用句子缓存；键里带上音频格式，格式变了不会回放旧格式的包
+        _linx_sdk_tts_cache_reset(sdk);
+        sdk->tts_cache_active = sdk->tts_cache && (params.audio_features & LINX_WEBSOCKET_AUDIO_FEATURE_TTS_CACHE);
+        snprintf(sdk->tts_cache_voice, sizeof(sdk->tts_cache_voice), "%s/%s", sdk->config.tts_voice, audio_format);
+        sdk->downlink_sample_rate = params.sample_rate;
+        __atomic_store_n(&sdk->playback_position_active,
+                         (params.audio_features & LINX_WEBSOCKET_AUDIO_FEATURE_PLAYBACK_POSITION) != 0,
+                         __ATOMIC_RELAXED);
+        
+        // 触发会话建立事件
+        LinxEvent event = {
+            .type = LINX_EVENT_SESSION_ESTABLISHED,
+            .timestamp = time(NULL),
+            .data.session_established = {
+                .session_id = session_id->valuestring,
+                .audio_format = audio_format,
+                .frame_duration_ms = params.frame_duration,
+                .audio_features = params.audio_features
+            }
+        };
+        
+        _linx_sdk_emit_event(sdk, &event);
+        _linx_sdk_finish_connect_future(sdk, LINX_SDK_SUCCESS);
+        
+        // 自动开始监听（如果配置了音频通道）
+        _linx_sdk_transition(sdk, LINX_STATE_KEEP, LINX_LISTEN_STATE_STARTED, LINX_STATE_KEEP);
+        linx_protocol_send_start_listening(_linx_sdk_protocol(sdk), sdk->config.listening_mode);
+        _linx_sdk_trace_begin_turn(sdk, true);
+        LOG_INFO("开始语音监听");
+        
+        // 首次开始监听时输出启动耗时
+        if (linx_boot_elapsed_us(LINX_BOOT_LISTEN_READY) < 0) {
+            linx_boot_mark(LINX_BOOT_LISTEN_READY);
+            LOG_INFO("启动到开始监听耗时: %.1f ms", linx_boot_elapsed_us(LINX_BOOT_LISTEN_READY) / 1000.0);
+        }
+        
+        // 音频通道已打开：先发送 linx_sdk_wake() 留下的唤醒词，再补发唤醒后暂存的语音，之后的帧直接发送。
+        // 推测式会话在确认前保持上行关闭；已被撤销的在开始监听后随即停止
+        bool park = false;
+        pthread_mutex_lock(&sdk->uplink_mutex);
+        if (sdk->wake_speculation == LINX_WAKE_SPEC_CONNECTING) {
+            sdk->wake_speculation = LINX_WAKE_SPEC_HELD;
+            LOG_INFO("推测式会话就绪，等待唤醒确认");
+        } else if (sdk->wake_speculation == LINX_WAKE_SPEC_CANCELLED ||
+                   sdk->wake_speculation == LINX_WAKE_SPEC_PARKED) {
+            sdk->wake_speculation = LINX_WAKE_SPEC_PARKED;
+            encoded_frame_buffer_clear(sdk->preconnect_buffer);
+            park = true;
+        } else {
+            _linx_sdk_send_pending_wake_word_locked(sdk);
+            sdk->uplink_open = true;
+            _linx_sdk_flush_preconnect_locked(sdk);
+        }
+        pthread_mutex_unlock(&sdk->uplink_mutex);
+        
+        // 会话资源已就绪，此后音频热路径不应再分配内存
+        _linx_sdk_set_zero_alloc_armed(sdk, true);
+        
+        // 触发监听开始事件
+        LinxEvent listen_event = {
+            .type = LINX_EVENT_LISTENING_STARTED,
+            .timestamp = time(NULL)
+        };
+        
+        _linx_sdk_emit_event(sdk, &listen_event);
+        
+        if (park) {
+            _linx_sdk_park_listening(sdk);
+        }
+    }
+}
+
+/**
+ * @brief 撤销推测式会话：通知服务端放弃本轮并停止监听，回到空闲状态，连接保留
+ * 
+ * 调用方不能持有 uplink_mutex（状态变化会触发事件回调）。
+ * 
+ * @param sdk 指向LinxSdk实例的指针
+ */
+static void _linx_sdk_park_listening(LinxSdk* sdk) {
+    if (sdk->connected) {
+        linx_protocol_send_abort_speaking(_linx_sdk_protocol(sdk), LINX_ABORT_REASON_NONE);
+        linx_protocol_send_stop_listening(_linx_sdk_protocol(sdk));
+    }
+    linx_metrics_stage_cancel(&sdk->metrics, LINX_METRIC_WAKE_TO_FIRST_UPLINK);
+    _linx_sdk_transition(sdk, LINX_DEVICE_STATE_IDLE, LINX_STATE_KEEP, LINX_STATE_KEEP);
+    LOG_INFO("唤醒未确认，停止监听并保留连接");
+    
+    LinxEvent event = {
+        .type = LINX_EVENT_LISTENING_STOPPED,
+        .timestamp = time(NULL)
+    };
+    _linx_sdk_emit_event(sdk, &event);
+}
+
+/**
+ * @brief 在保留的连接上重新开始监听（推测式会话撤销后的下一次唤醒）
+ * 
+ * 调用方不能持有 uplink_mutex。
+ * 
+ * @param sdk 指向LinxSdk实例的指针
+ */
+static void _linx_sdk_resume_listening(LinxSdk* sdk) {
+    _linx_sdk_transition(sdk, LINX_DEVICE_STATE_LISTENING, LINX_LISTEN_STATE_STARTED, LINX_STATE_KEEP);
+    linx_metrics_stage_begin(&sdk->metrics, LINX_METRIC_WAKE_TO_FIRST_UPLINK);
+    linx_protocol_send_start_listening(_linx_sdk_protocol(sdk), sdk->config.listening_mode);
+    _linx_sdk_trace_begin_turn(sdk, true);
+    LOG_INFO("重新开始语音监听");
+    
+    LinxEvent event = {
+        .type = LINX_EVENT_LISTENING_STARTED,
+        .timestamp = time(NULL)
+    };
+    _linx_sdk_emit_event(sdk, &event);
+}
+
+/**
+ * @brief 在对话时间线上开始新的轮次
+ * 
+ * @param sdk 指向LinxSdk实例的指针
+ * @param listen_start 本轮由发送 listen start 开始，记录 LINX_TRACE_LISTEN_START
+ */
+static void _linx_sdk_trace_begin_turn(LinxSdk* sdk, bool listen_start) {
+    if (!sdk->trace) {
+        return;
+    }
+    
+    char session_id[LINX_TRACE_SESSION_ID_MAX] = {0};
+    pthread_mutex_lock(&sdk->state_mutex);
+    if (sdk->session_id) {
+        snprintf(session_id, sizeof(session_id), "%s", sdk->session_id);
+    }
+    pthread_mutex_unlock(&sdk->state_mutex);
+    
+    linx_trace_begin_turn(sdk->trace, session_id);
+    if (listen_start) {
+        linx_trace_mark(sdk->trace, LINX_TRACE_LISTEN_START);
+    }
+}
+
+/**
+ * @brief 处理TTS状态变化（树解析与快速扫描两条路径共用）
+ * 
+ * @param sdk 指向LinxSdk实例的指针
+ * @param state TTS状态字符串
+ * @param text sentence_start 时的句子文本，可以为NULL
+ */
+static void _linx_sdk_process_tts(LinxSdk* sdk, const char* state, const char* text) {
+    LOG_INFO("TTS状态: %s", state);
+    
+    // 实时模式由设备端回声消除去掉播放声音，播放期间保持监听，用户可以随时打断
+    bool realtime = sdk->config.listening_mode == LINX_LISTENING_MODE_REALTIME;
+    
+    if (strcmp(state, "start") == 0) {
+        // 新的回复开始，本地打断的丢弃到此结束
+        __atomic_store_n(&sdk->barge_in_dropping, false, __ATOMIC_RELEASE);
+        _linx_sdk_tts_cache_reset(sdk);
+        
+        // 回复由多句组成，句子之间缓冲区欠载时播放器用 PLC 衔接
+        linx_player_t* player = __atomic_load_n(&sdk->player, __ATOMIC_ACQUIRE);
+        if (player) {
+            linx_player_set_continuation(player, true);
+        }
+        
+        if (!realtime) {
+            // TTS开始播放，停止监听避免回音；先把尚未攒满的上行合包发出去
+            linx_sdk_flush_audio(sdk);
+        }
+        _linx_sdk_transition(sdk, LINX_DEVICE_STATE_SPEAKING,
+                             realtime ? LINX_STATE_KEEP : LINX_LISTEN_STATE_STOPPED, LINX_TTS_STATE_STARTED);
+        if (!realtime) {
+            if (sdk->ws_protocol) {
+                linx_protocol_send_stop_listening(_linx_sdk_protocol(sdk));
+            }
+            LOG_INFO("停止监听（TTS播放中）");
+        }
+        
+        // 下一帧下行音频是本轮 TTS 的第一帧，播放器播出第一个样本时结束计时
+        __atomic_store_n(&sdk->tts_first_frame_pending, true, __ATOMIC_RELAXED);
+        linx_trace_mark(sdk->trace, LINX_TRACE_TTS_START);
+        
+        // 触发TTS开始事件
+        LinxEvent event = {
+            .type = LINX_EVENT_TTS_STARTED,
+            .timestamp = time(NULL)
+        };
+        
+        _linx_sdk_emit_event(sdk, &event);
+    } else if (strcmp(state, "stop") == 0) {
+        // 第一轮对话结束（含被打断的回复），执行快速启动推迟的初始化
+        linx_boot_mark(LINX_BOOT_FIRST_TURN_DONE);
+        _linx_sdk_run_deferred_boot(sdk);
+        
+        // 回放完缓存的最后一句、存入录制的最后一句（被打断的不存入）
+        _linx_sdk_tts_cache_end_sentence(sdk);
+        
+        // 最后一句之后的欠载就是回复结束，不再衔接
+        linx_player_t* player = __atomic_load_n(&sdk->player, __ATOMIC_ACQUIRE);
+        if (player) {
+            linx_player_set_continuation(player, false);
+        }
+        
+        // 本地打断时已经切回监听并上报过 TTS 停止
+        if (__atomic_exchange_n(&sdk->barge_in_dropping, false, __ATOMIC_ACQ_REL)) {
+            LOG_INFO("被打断的TTS已结束");
+            return;
+        }
+        
+        // 本轮到此结束，之后的上行属于下一轮
+        linx_trace_mark(sdk->trace, LINX_TRACE_TTS_STOP);
+        
+        _linx_sdk_transition(sdk, LINX_DEVICE_STATE_LISTENING,
+                             realtime ? LINX_STATE_KEEP : LINX_LISTEN_STATE_STARTED, LINX_TTS_STATE_STOPPED);
+        if (!realtime) {
+            // TTS播放结束，重新开始监听
+            if (sdk->ws_protocol) {
+                linx_protocol_send_start_listening(_linx_sdk_protocol(sdk), sdk->config.listening_mode);
+            }
+            LOG_INFO("恢复语音监听");
+        }
+        _linx_sdk_trace_begin_turn(sdk, !realtime);
+        
+        // 触发TTS停止事件
+        LinxEvent event = {
+            .type = LINX_EVENT_TTS_STOPPED,
+            .timestamp = time(NULL)
+        };
+        
+        _linx_sdk_emit_event(sdk, &event);
+    } else if (strcmp(state, "sentence_start") == 0) {
+        // TTS句子开始，处理文本内容（被打断的回复不再上报）
+        if (text && !__atomic_load_n(&sdk->barge_in_dropping, __ATOMIC_ACQUIRE)) {
+            LOG_INFO("TTS句子开始: %s", text);
+            _linx_sdk_tts_cache_end_sentence(sdk);
+            _linx_sdk_report_playback_position(sdk);
+            
+            // 触发文本消息事件
+            LinxEvent event = {
+                .type = LINX_EVENT_SENTENCE_START,
+                .timestamp = time(NULL),
+                .data.text_message = {
+                    .text = (char*)text,
+                    .role = "assistant"
+                }
+            };
+            
+            _linx_sdk_emit_event(sdk, &event);
+            
+            // 缓存命中时本地回放这一句，否则录制服务端下发的音频
+            _linx_sdk_tts_cache_begin_sentence(sdk, text);
+        }
+    }
+}
+
+/**
+ * @brief 处理STT识别结果
+ * 
+ * @param sdk 指向LinxSdk实例的指针
+ * @param text 识别文本
+ */
+static void _linx_sdk_process_stt(LinxSdk* sdk, const char* text) {
+    LOG_INFO("STT识别结果: %s", text);
+    linx_metrics_stage_end(&sdk->metrics, LINX_METRIC_SPEECH_END_TO_STT);
+    linx_trace_mark(sdk->trace, LINX_TRACE_STT);
+    
+    // 触发文本消息事件
+    LinxEvent event = {
+        .type = LINX_EVENT_TEXT_MESSAGE,
+        .timestamp = time(NULL),
+        .data.text_message = {
+            .text = (char*)text,
+            .role = "assistant"
+        }
+    };
+    
+    _linx_sdk_emit_event(sdk, &event);
+}
+
+/**
+ * @brief 处理LLM情感状态
+ * 
+ * @param sdk 指向LinxSdk实例的指针
+ * @param emotion 情感字符串
+ */
+static void _linx_sdk_process_llm(LinxSdk* sdk, const char* emotion) {
+    LOG_INFO("LLM情感状态: %s", emotion);
+    linx_trace_mark(sdk->trace, LINX_TRACE_LLM);
+    // 触发情感状态事件
+    LinxEvent event = {
+        .type = LINX_EVENT_EMOTION_MESSAGE,
+        .timestamp = time(NULL),
+        .data.emotion = {
+            .value = (char*)emotion
+        }
+    };
+    
+    _linx_sdk_emit_event(sdk, &event);
+}
+
+/**
+ * @brief 处理"tts"类型的服务器消息（TTS状态消息）
+ * 
+ * @param root 完整的消息JSON对象
+ * @param user_data 指向LinxSdk实例的指针
+ */
+static void _linx_sdk_handle_tts_message(const cJSON* root, void* user_data) {
+    LinxSdk* sdk = (LinxSdk*)user_data;
+    
+    const cJSON* state = cJSON_GetObjectItemCaseSensitive(root, "state");
+    if (state && cJSON_IsString(state)) {
+        const cJSON* text = cJSON_GetObjectItemCaseSensitive(root, "text");
+        _linx_sdk_process_tts(sdk, state->valuestring,
+                              (text && cJSON_IsString(text)) ? text->valuestring : NULL);
+    }
+}
+
+/**
+ * @brief 处理"stt"类型的服务器消息（STT识别结果消息）
+ * 
+ * @param root 完整的消息JSON对象
+ * @param user_data 指向LinxSdk实例的指针
+ */
+static void _linx_sdk_handle_stt_message(const cJSON* root, void* user_data) {
+    LinxSdk* sdk = (LinxSdk*)user_data;
+    
+    const cJSON* text = cJSON_GetObjectItemCaseSensitive(root, "text");
+    if (text && cJSON_IsString(text)) {
+        _linx_sdk_process_stt(sdk, text->valuestring);
+    }
+}
+
+/**
+ * @brief 处理"llm"类型的服务器消息（LLM情感消息）
+ * 
+ * @param root 完整的消息JSON对象
+ * @param user_data 指向LinxSdk实例的指针
+ */
+static void _linx_sdk_handle_llm_message(const cJSON* root, void* user_data) {
+    LinxSdk* sdk = (LinxSdk*)user_data;
+    
+    const cJSON* emotion = cJSON_GetObjectItemCaseSensitive(root, "emotion");
+    if (emotion && cJSON_IsString(emotion)) {
+        _linx_sdk_process_llm(sdk, emotion->valuestring);
+    }
+}
+
+/**
+ * @brief 处理"mcp"类型的服务器消息（MCP消息）
+ * 
+ * @param root 完整的消息JSON对象
+ * @param user_data 指向LinxSdk实例的指针
+ */
+static void _linx_sdk_handle_mcp_message(const cJSON* root, void* user_data) {
+    LinxSdk* sdk = (LinxSdk*)user_data;
+    
+    const cJSON* payload = cJSON_GetObjectItemCaseSensitive(root, "payload");
+    if (payload && (cJSON_IsObject(payload) || cJSON_IsArray(payload))) {
+#if LINX_ENABLE_MCP
+        // 如果启用了MCP，直接把已解析的payload交给MCP服务器处理，避免序列化后再解析
+        if (sdk->mcp_server) {
+            mcp_server_parse_json_message(sdk->mcp_server, payload);
+            
+            const cJSON* method = cJSON_GetObjectItemCaseSensitive(payload, "method");
+            if (sdk->session_cache_enabled && cJSON_IsString(method) && strcmp(method->valuestring, "tools/list") == 0) {
+                _linx_sdk_session_cache_on_tools_list(sdk);
+            }
+        }
+#endif
+        
+        // 只有在需要日志或事件回调时才序列化payload
+        const char* payload_str = NULL;
+        if (sdk->event_callback || log_is_level_enabled(LOG_LEVEL_INFO)) {
+            payload_str = linx_json_print(&sdk->json_scratch, payload);
+        }
+        if (payload_str) {
+            LOG_INFO("收到MCP消息: %s", payload_str);
+            
+            // 触发MCP消息事件
+            LinxEvent event = {
+                .type = LINX_EVENT_MCP_MESSAGE,
+                .timestamp = time(NULL),
+                .data.mcp_message = {
+                    .message = (char*)payload_str,
+                    .type = "mcp"
+                }
+            };
+            
+            _linx_sdk_emit_event(sdk, &event);
+        }
+    }
+}
+
+/**
+ * @brief 处理"system"类型的服务器消息（系统命令消息）
+ * 
+ * @param root 完整的消息JSON对象
+ * @param user_data 指向LinxSdk实例的指针
+ */
+static void _linx_sdk_handle_system_message(const cJSON* root, void* user_data) {
+    LinxSdk* sdk = (LinxSdk*)user_data;
+    
+    const cJSON* command = cJSON_GetObjectItemCaseSensitive(root, "command");
+    if (command && cJSON_IsString(command)) {
+        LOG_INFO("系统命令: %s", command->valuestring);
+        
+        // 触发MCP消息事件
+        LinxEvent event = {
+            .type = LINX_EVENT_SYSTEM_MESSAGE,
+            .timestamp = time(NULL),
+            .data.system_message = {
+                .message = command->valuestring
+            }
+        };
+        
+        _linx_sdk_emit_event(sdk, &event);
+            
+    }
+}
+
+/**
+ * @brief 处理"alert"类型的服务器消息（警告消息）
+ * 
+ * @param root 完整的消息JSON对象
+ * @param user_data 指向LinxSdk实例的指针
+ */
+static void _linx_sdk_handle_alert_message(const cJSON* root, void* user_data) {
+    LinxSdk* sdk = (LinxSdk*)user_data;
+    
+    const cJSON* status = cJSON_GetObjectItemCaseSensitive(root, "status");
+    const cJSON* message = cJSON_GetObjectItemCaseSensitive(root, "message");
+    const cJSON* emotion = cJSON_GetObjectItemCaseSensitive(root, "emotion");
+    
+    if (status && cJSON_IsString(status) && 
+        message && cJSON_IsString(message) && 
+        emotion && cJSON_IsString(emotion)) {
+        
+        LOG_WARN("警告消息 - 状态: %s, 消息: %s, 情感: %s", 
+                 status->valuestring, message->valuestring, emotion->valuestring);
+        
+        // 触发错误事件（警告作为特殊的错误事件处理）
+        LinxEvent event = {
+            .type = LINX_EVENT_ERROR,
+            .timestamp = time(NULL),
+            .data.error = {
+                .message = message->valuestring,
+                .code = 0  // 警告级别错误代码
+            }
+        };
+        
+        _linx_sdk_emit_event(sdk, &event);
+    } else {
+        LOG_WARN("警告消息格式不完整，需要status、message和emotion字段");
+    }
+}
+
+/**
+ * @brief 处理"custom"类型的服务器消息（自定义消息）
+ * 
+ * @param root 完整的消息JSON对象
+ * @param user_data 指向LinxSdk实例的指针
+ */
+static void _linx_sdk_handle_custom_message(const cJSON* root, void* user_data) {
+    LinxSdk* sdk = (LinxSdk*)user_data;
+    
+    const cJSON* payload = cJSON_GetObjectItemCaseSensitive(root, "payload");
+    if (payload && cJSON_IsObject(payload)) {
+        // 只有在需要日志或事件回调时才序列化payload
+        const char* payload_str = NULL;
+        if (sdk->event_callback || log_is_level_enabled(LOG_LEVEL_INFO)) {
+            payload_str = linx_json_print(&sdk->json_scratch, payload);
+        }
+        if (payload_str) {
+            LOG_INFO("收到自定义消息: %s", payload_str);
+            
+            // 触发文本消息事件（自定义消息作为系统消息处理）
+            LinxEvent event = {
+                .type = LINX_EVENT_CUSTOM_MESSAGE,
+                .timestamp = time(NULL),
+                .data.custom_message = {
+                    .value = (char*)payload_str
+                }
+            };
+            
+            _linx_sdk_emit_event(sdk, &event);
+        }
+    } else {
+        LOG_WARN("自定义消息格式无效：缺少payload字段");
+    }
+}
+
+/**
+ * @brief 注册SDK内置的服务器消息处理函数
+ * 
+ * @param sdk 指向LinxSdk实例的指针
+ */
+static void _linx_sdk_register_builtin_handlers(LinxSdk* sdk) {
+    static const struct {
+        const char* type;
+        linx_message_handler_t handler;
+    } builtin[] = {
+        { "hello",  _linx_sdk_handle_hello_message },
+        { "tts",    _linx_sdk_handle_tts_message },
+        { "stt",    _linx_sdk_handle_stt_message },
+        { "llm",    _linx_sdk_handle_llm_message },
+        { "mcp",    _linx_sdk_handle_mcp_message },
+        { "system", _linx_sdk_handle_system_message },
+        { "alert",  _linx_sdk_handle_alert_message },
+        { "custom", _linx_sdk_handle_custom_message },
+    };
+    
+    for (size_t i = 0; i < sizeof(builtin) / sizeof(builtin[0]); i++) {
+        linx_message_router_register(sdk->msg_router, builtin[i].type, builtin[i].handler, sdk);
+    }
+}
+
+/**
+ * @brief WebSocket文本消息快速处理回调
+ * 
+ * 对高频的tts/stt/llm小型扁平消息使用 linx_json_scan 直接提取字段，
+ * 不构建cJSON树。其他类型、被应用替换了处理函数的类型、或字段无法
+ * 放入栈缓冲区时返回false，由协议层回退到完整解析。
+ * 
+ * @param type 消息类型字符串（已由协议层解析）
+ * @param json 原始JSON文本
+ * @param length 文本长度
+ * @param user_data 指向LinxSdk实例的指针
+ * @return 已处理返回true
+ * 
+ * @see linx_json_scan_object
+ * @see _linx_sdk_on_websocket_message
+ */
+static bool _linx_sdk_on_websocket_text(const char* type, const char* json, size_t length, void* user_data) {
+    LinxSdk* sdk = (LinxSdk*)user_data;
+    if (!sdk || !type || !json) return false;
+    
+    linx_metrics_add(&sdk->metrics, LINX_METRIC_MESSAGES_RECEIVED, 1);
+    _linx_sdk_touch_activity(sdk);
+    
+    linx_message_handler_t handler = linx_message_router_get_handler(sdk->msg_router, type);
+    if (handler != _linx_sdk_handle_tts_message &&
+        handler != _linx_sdk_handle_stt_message &&
+        handler != _linx_sdk_handle_llm_message) {
+        return false;
+    }
+    
+    if (log_is_level_enabled(LOG_LEVEL_DEBUG)) {
+        LOG_DEBUG("收到WebSocket消息: %.*s", (int)length, json);
+    }
+    
+    linx_json_scan_field_t fields[] = {
+        { .key = "state" },
+        { .key = "text" },
+        { .key = "emotion" },
+    };
+    if (linx_json_scan_object(json, length, fields, sizeof(fields) / sizeof(fields[0])) < 0) {
+        return false;
+    }
+    
+    char state[32];
+    char text[1024];
+    char emotion[64];
+    
+    if (handler == _linx_sdk_handle_tts_message) {
+        if (fields[0].type != LINX_JSON_SCAN_STRING) {
+            return true;    // 与树解析路径一致：缺少state时忽略
+        }
+        if (linx_json_scan_copy_string(&fields[0], state, sizeof(state)) == (size_t)-1) {
+            return false;
+        }
+        const char* text_ptr = NULL;
+        if (fields[1].type == LINX_JSON_SCAN_STRING) {
+            if (linx_json_scan_copy_string(&fields[1], text, sizeof(text)) == (size_t)-1) {
+                return false;
+            }
+            text_ptr = text;
+        }
+        _linx_sdk_process_tts(sdk, state, text_ptr);
+    } else if (handler == _linx_sdk_handle_stt_message) {
+        if (fields[1].type != LINX_JSON_SCAN_STRING) {
+            return true;
+        }
+        if (linx_json_scan_copy_string(&fields[1], text, sizeof(text)) == (size_t)-1) {
+            return false;
+        }
+        _linx_sdk_process_stt(sdk, text);
+    } else {
+        if (fields[2].type != LINX_JSON_SCAN_STRING) {
+            return true;
+        }
+        if (linx_json_scan_copy_string(&fields[2], emotion, sizeof(emotion)) == (size_t)-1) {
+            return false;
+        }
+        _linx_sdk_process_llm(sdk, emotion);
+    }
+    
+    return true;
+}
+
+/**
+ * @brief WebSocket CBOR控制消息回调
+ * 
+ * 与文本快速路径相同，tts/stt/llm 直接从解码后的定长结构取字段；其他类型、
+ * 被应用替换了处理函数的类型、或字段放不进栈缓冲区时返回false，
+ * 由协议层转换为cJSON后走路由表。
+ * 
+ * @param message 解码后的控制消息（字段指向接收缓冲区）
+ * @param user_data 指向LinxSdk实例的指针
+ * @return 已处理返回true
+ * 
+ * @see _linx_sdk_on_websocket_text
+ */
+static bool _linx_sdk_on_websocket_control(const linx_control_message_t* message, void* user_data) {
+    LinxSdk* sdk = (LinxSdk*)user_data;
+    const char* type = message ? linx_control_type_name(message->type) : NULL;
+    if (!sdk || !type) return false;
+    
+    linx_metrics_add(&sdk->metrics, LINX_METRIC_MESSAGES_RECEIVED, 1);
+    _linx_sdk_touch_activity(sdk);
+    
+    linx_message_handler_t handler = linx_message_router_get_handler(sdk->msg_router, type);
+    if (handler != _linx_sdk_handle_tts_message &&
+        handler != _linx_sdk_handle_stt_message &&
+        handler != _linx_sdk_handle_llm_message) {
+        return false;
+    }
+    
+    LOG_DEBUG("收到CBOR控制消息: %s", type);
+    
+    char state[32];
+    char text[1024];
+    char emotion[64];
+    
+    if (handler == _linx_sdk_handle_tts_message) {
+        if (!linx_control_message_has(message, LINX_CONTROL_FIELD_STATE)) {
+            return true;    // 与树解析路径一致：缺少state时忽略
+        }
+        if (linx_control_message_copy(message, LINX_CONTROL_FIELD_STATE, state, sizeof(state)) == (size_t)-1) {
+            return false;
+        }
+        const char* text_ptr = NULL;
+        if (linx_control_message_has(message, LINX_CONTROL_FIELD_TEXT)) {
+            if (linx_control_message_copy(message, LINX_CONTROL_FIELD_TEXT, text, sizeof(text)) == (size_t)-1) {
+                return false;
+            }
+            text_ptr = text;
+        }
+        _linx_sdk_process_tts(sdk, state, text_ptr);
+    } else if (handler == _linx_sdk_handle_stt_message) {
+        if (!linx_control_message_has(message, LINX_CONTROL_FIELD_TEXT)) {
+            return true;
+        }
+        if (linx_control_message_copy(message, LINX_CONTROL_FIELD_TEXT, text, sizeof(text)) == (size_t)-1) {
+            return false;
+        }
+        _linx_sdk_process_stt(sdk, text);
+    } else {
+        if (!linx_control_message_has(message, LINX_CONTROL_FIELD_EMOTION)) {
+            return true;
+        }
+        if (linx_control_message_copy(message, LINX_CONTROL_FIELD_EMOTION, emotion, sizeof(emotion)) == (size_t)-1) {
+            return false;
+        }
+        _linx_sdk_process_llm(sdk, emotion);
+    }
+    
+    return true;
+}
+
+/**
+ * @brief WebSocket JSON消息回调函数
+ * 
+ * 按消息类型通过路由表分发到已注册的处理函数。内置类型在SDK创建时注册，
+ * 应用程序可以通过 linx_sdk_register_message_handler() 添加或替换处理函数。
+ * 
+ * @param root 完整的消息JSON对象
+ * @param type 消息类型字符串（已由协议层解析）
+ * @param user_data 指向LinxSdk实例的指针
+ * 
+ * @note 该函数在WebSocket线程上下文中被调用
+ * 
+ * @see linx_sdk_register_message_handler
+ * @see linx_message_router_dispatch
+ */
+static void _linx_sdk_on_websocket_message(const cJSON* root, const char* type, void* user_data) {
+    LinxSdk* sdk = (LinxSdk*)user_data;
+    if (!sdk || !root || !type) return;
+    
+    // 仅在DEBUG级别开启时才序列化消息用于日志
+    if (log_is_level_enabled(LOG_LEVEL_DEBUG)) {
+        const char* json_string = linx_json_print(&sdk->json_scratch, root);
+        if (json_string) {
+            LOG_DEBUG("收到WebSocket消息: %s", json_string);
+        }
+    }
+    
+    if (!linx_message_router_dispatch(sdk->msg_router, type, root)) {
+        LOG_WARN("未知消息类型: %s", type);
+    }
+}
+
+/**
+ * @brief WebSocket音频数据回调函数
+ * 
+ * 当接收到WebSocket音频数据包时，该回调函数会被调用。函数会处理音频数据
+ * 并触发相应的TTS事件通知应用程序。
+ * 
+ * @param packet 指向音频数据包的指针，包含音频数据和大小信息
+ * @param user_data 用户数据指针，应该指向LinxSdk实例
+ * 
+ * @note 该函数在WebSocket线程上下文中被调用
+ * @note 如果packet或user_data为NULL，函数会安全返回
+ * @note 音频数据的处理可以扩展为实际的音频播放功能
+ * @note 接收到音频数据会触发LINX_EVENT_AUDIO_DATA事件
+ * @note packet 是指向网络接收缓冲区的视图，回调返回后即失效
+ * 
+ * @see linx_audio_stream_packet_t
+ * @see linx_audio_stream_packet_retain
+ * @see LINX_EVENT_AUDIO_DATA
+ * @see LinxEvent
+ */
+static void _linx_sdk_on_websocket_audio_data(linx_audio_stream_packet_t* packet, void* user_data) {
+    //LOG_INFO("[%s] Audio packet: %d bytes", __FUNCTION__, packet->payload_size);
+    LinxSdk* sdk = (LinxSdk*)user_data;
+    if (!sdk || !packet) return;
+
+
+    LOG_DEBUG_EVERY_N(50, "收到音频数据: %zu 字节", packet->payload_size);
+    
+    linx_metrics_add(&sdk->metrics, LINX_METRIC_DOWNLINK_PACKETS, 1);
+    _linx_sdk_touch_activity(sdk);
+    
+    // 本地打断后服务端还在路上的音频属于被打断的回复
+    if (__atomic_load_n(&sdk->barge_in_dropping, __ATOMIC_ACQUIRE)) {
+        LOG_DEBUG_EVERY_N(50, "丢弃被打断回复的音频: %zu 字节", packet->payload_size);
+        linx_tts_cache_record_abort(sdk->tts_cache);
+        return;
+    }
+    
+    sdk->downlink_sample_rate = packet->sample_rate;
+    if (sdk->tts_cache) {
+        // 本地回放的句子：服务端处理跳过之前已经发出的音频
+        if (sdk->tts_skipping) {
+            LOG_DEBUG_EVERY_N(50, "丢弃已由缓存回放的句子音频: %zu 字节", packet->payload_size);
+            return;
+        }
+        if (linx_tts_cache_is_recording(sdk->tts_cache)) {
+            linx_tts_cache_record_append(sdk->tts_cache, packet->payload, packet->payload_size,
+                                         packet->frame_duration);
+        }
+        sdk->downlink_next_timestamp = packet->timestamp + (uint32_t)packet->frame_duration;
+    }
+    
+    _linx_sdk_deliver_downlink(sdk, packet);
+}
+
+/**
+ * @brief 把一个下行音频包交给应用（服务端下发或句子缓存回放）
+ * 
+ * @param sdk 指向LinxSdk实例的指针
+ * @param packet 数据包视图，只在调用期间有效
+ */
+static void _linx_sdk_deliver_downlink(LinxSdk* sdk, linx_audio_stream_packet_t* packet) {
+    if (__atomic_load_n(&sdk->tts_first_frame_pending, __ATOMIC_RELAXED) &&
+        __atomic_exchange_n(&sdk->tts_first_frame_pending, false, __ATOMIC_RELAXED)) {
+        linx_metrics_stage_touch(&sdk->metrics, LINX_METRIC_TTS_TO_PLAYBACK);
+    }
+    linx_trace_mark_first(sdk->trace, LINX_TRACE_FIRST_AUDIO);
+    
+    // 这里可以处理音频数据，例如播放TTS音频
+    // 触发TTS相关事件
+    LinxEvent event = {
+        .type = LINX_EVENT_AUDIO_DATA,
+        .timestamp = time(NULL),
+        .data.audio_data.value = packet
+    };
+    
+    _linx_sdk_emit_event(sdk, &event);
+}
+
+/**
+ * @brief 用缓存的 hello 和 TLS 会话初始化新建的连接
+ * 
+ * 缓存的会话属于缓存地址上的服务器，配置了其他地址时不使用。没有配置 session_store 时
+ * 只有退出低功耗后的第一次连接使用内存中的会话。
+ * 
+ * @param sdk 指向LinxSdk实例的指针
+ */
+static void _linx_sdk_session_cache_apply(LinxSdk* sdk) {
+    const linx_session_cache_t* cache = &sdk->session_cache;
+    bool resume = sdk->sleep_resume;
+    sdk->sleep_resume = false;
+    if ((!sdk->session_cache_enabled && !resume) ||
+        (cache->websocket_url[0] && strcmp(cache->websocket_url, sdk->config.server_url) != 0)) {
+        return;
+    }
+    if (cache->has_params) {
+        linx_websocket_set_resume_state(sdk->ws_protocol, cache->session_id, &cache->params);
+    }
+    if (cache->tls_session_len > 0 &&
+        !linx_websocket_set_tls_session(sdk->ws_protocol, cache->tls_session, cache->tls_session_len)) {
+        LOG_DEBUG("当前TLS后端不支持会话恢复，忽略缓存的TLS会话");
+    }
+}
+
+/**
+ * @brief 会话建立后写回 hello 协商结果和 TLS 会话，缓存的地址在后台重新做 OTA 检查
+ * 
+ * 没有配置 session_store 时只更新内存中的缓存，供退出低功耗后恢复会话。
+ * 
+ * @param sdk 指向LinxSdk实例的指针
+ * @param session_id 服务端给出的 session_id
+ * @param params hello 协商结果
+ * 
+ * @note 在网络事件循环中调用
+ */
+static void _linx_sdk_session_cache_on_hello(LinxSdk* sdk, const char* session_id, const LinxSessionParams* params) {
+    linx_session_cache_t* fresh = (linx_session_cache_t*)LINX_CALLOC(1, sizeof(linx_session_cache_t));
+    if (fresh) {
+        snprintf(fresh->session_id, sizeof(fresh->session_id), "%s", session_id);
+        fresh->params = *params;
+        fresh->has_params = true;
+        fresh->tls_session_len = linx_websocket_get_tls_session(sdk->ws_protocol, fresh->tls_session,
+                                                                sizeof(fresh->tls_session));
+        linx_session_cache_update(sdk->session_cache_enabled ? &sdk->config.session_store : NULL,
+                                  &sdk->session_cache, fresh);
+        LINX_FREE(fresh);
+    }
+    
+    // 地址取自缓存：连接已经用上，再确认一次是否仍然有效（快速启动时推迟到第一轮对话之后）
+    if (sdk->session_url_cached && sdk->config.ota && !sdk->session_revalidating) {
+        sdk->session_revalidating = true;
+        if (linx_sdk_ota_check_async(sdk) != LINX_SDK_SUCCESS) {
+            LOG_WARN("缓存地址的后台OTA检查提交失败");
+        }
+    }
+}
+
+#if LINX_ENABLE_OTA
+/**
+ * @brief OTA 检查完成时写回 websocket_url
+ * 
+ * 地址变化时更新配置，正在使用的连接不受影响，下次连接生效。
+ * 
+ * @param sdk 指向LinxSdk实例的指针
+ * @param ota_event OTA 检查完成事件
+ * 
+ * @note 在网络事件循环中调用
+ */
+static void _linx_sdk_session_cache_on_ota(LinxSdk* sdk, const linx_ota_event_t* ota_event) {
+    if (!sdk->session_cache_enabled || ota_event->status != LINX_OTA_SUCCESS || !ota_event->info ||
+        ota_event->info->websocket_url[0] == '\0') {
+        return;
+    }
+    
+    const char* url = ota_event->info->websocket_url;
+    if (strcmp(url, sdk->session_cache.websocket_url) != 0) {
+        linx_session_cache_t* fresh = (linx_session_cache_t*)LINX_CALLOC(1, sizeof(linx_session_cache_t));
+        if (fresh) {
+            snprintf(fresh->websocket_url, sizeof(fresh->websocket_url), "%s", url);
+            linx_session_cache_update(&sdk->config.session_store, &sdk->session_cache, fresh);
+            LINX_FREE(fresh);
+        }
+    }
+    if (sdk->session_url_cached && strcmp(url, sdk->config.server_url) != 0) {
+        LOG_WARN("OTA 给出了新的服务器地址 %s，下次连接生效", url);
+        snprintf(sdk->config.server_url, sizeof(sdk->config.server_url), "%s", url);
+    }
+    sdk->session_url_cached = false;
+}
+#endif
+
+/**
+ * @brief 连接前选择得分最低的端点，写入 config.server_url
+ * 
+ * @param sdk 指向LinxSdk实例的指针
+ */
+static void _linx_sdk_endpoint_select(LinxSdk* sdk) {
+    pthread_mutex_lock(&sdk->endpoint_mutex);
+    int best = linx_endpoints_best(&sdk->endpoints, sdk->endpoint_current, linx_os_now_ms());
+    if (best >= 0) {
+        if (sdk->endpoint_current >= 0 && best != sdk->endpoint_current) {
+            LOG_INFO("选择服务器 %s (得分 %u ms，原服务器 %u ms)", sdk->endpoints.items[best].url,
+                     linx_endpoints_score(&sdk->endpoints, best),
+                     linx_endpoints_score(&sdk->endpoints, sdk->endpoint_current));
+        }
+        sdk->endpoint_current = best;
+        snprintf(sdk->config.server_url, sizeof(sdk->config.server_url), "%s", sdk->endpoints.items[best].url);
+    }
+    sdk->endpoint_dialing = false;
+    pthread_mutex_unlock(&sdk->endpoint_mutex);
+}
+
+/**
+ * @brief 拨号钩子：记下上一次拨号的失败，重连时换到得分最低、不在冷却期的端点
+ * 
+ * 换到一个没有失败过的端点时退避从最小延迟重新开始，所有端点都失败过之后才按退避增长。
+ * 
+ * @param user_data 指向LinxSdk实例的指针
+ * @param reconnect_attempt 连续第几次重连
+ * 
+ * @note 在网络事件循环中调用
+ */
+static void _linx_sdk_endpoint_on_dial(void* user_data, int reconnect_attempt) {
+    LinxSdk* sdk = (LinxSdk*)user_data;
+    uint64_t now = linx_os_now_ms();
+    char url[LINX_ENDPOINTS_URL_MAX] = "";
+    bool fresh = false;
+    
+    pthread_mutex_lock(&sdk->endpoint_mutex);
+    if (sdk->endpoint_dialing) {
+        linx_endpoints_record_connect(&sdk->endpoints, sdk->endpoint_current, false, 0, now);
+    }
+    if (reconnect_attempt > 0 && sdk->endpoints.count > 1) {
+        int best = linx_endpoints_best(&sdk->endpoints, sdk->endpoint_current, now);
+        if (best >= 0 && best != sdk->endpoint_current) {
+            fresh = !linx_endpoints_cooling_down(&sdk->endpoints, best, now);
+            sdk->endpoint_current = best;
+            snprintf(url, sizeof(url), "%s", sdk->endpoints.items[best].url);
+            snprintf(sdk->config.server_url, sizeof(sdk->config.server_url), "%s", url);
+        }
+    }
+    sdk->endpoint_dialing = true;
+    sdk->endpoint_dial_ms = now;
+    pthread_mutex_unlock(&sdk->endpoint_mutex);
+    
+    if (url[0]) {
+        LOG_WARN("切换到服务器 %s", url);
+        linx_websocket_set_server_url(sdk->ws_protocol, url);
+        if (fresh) {
+            linx_websocket_reset_reconnect_attempts(sdk->ws_protocol);
+        }
+    }
+}
+
+/**
+ * @brief 连接建立：记下握手耗时，保活统计从这里开始采样
+ * 
+ * @note 在网络事件循环中调用
+ */
+static void _linx_sdk_endpoint_on_connected(LinxSdk* sdk) {
+    linx_websocket_uplink_stats_t stats = {0};
+    linx_websocket_get_uplink_stats(sdk->ws_protocol, &stats);
+    uint64_t now = linx_os_now_ms();
+    
+    pthread_mutex_lock(&sdk->endpoint_mutex);
+    if (sdk->endpoint_dialing) {
+        uint32_t handshake_ms = (uint32_t)(now - sdk->endpoint_dial_ms);
+        linx_endpoints_record_connect(&sdk->endpoints, sdk->endpoint_current, true, handshake_ms, now);
+        LOG_DEBUG("服务器 %s 握手 %u ms", sdk->config.server_url, handshake_ms);
+    }
+    sdk->endpoint_dialing = false;
+    sdk->endpoint_keepalive_probes = stats.keepalive_probes;
+    sdk->endpoint_keepalive_missed = stats.keepalive_missed;
+    pthread_mutex_unlock(&sdk->endpoint_mutex);
+}
+
+/**
+ * @brief 连接断开：仍在自动重连说明不是主动断开，计入当前端点的错误率
+ * 
+ * @param was_connected 断开前连接已建立；否则是放弃重连前的最后一次拨号失败
+ * 
+ * @note 在网络事件循环中调用
+ */
+static void _linx_sdk_endpoint_on_disconnected(LinxSdk* sdk, bool was_connected, bool reconnecting) {
+    uint64_t now = linx_os_now_ms();
+    pthread_mutex_lock(&sdk->endpoint_mutex);
+    if (was_connected && reconnecting) {
+        linx_endpoints_record_drop(&sdk->endpoints, sdk->endpoint_current, now);
+    } else if (!was_connected && sdk->endpoint_dialing) {
+        linx_endpoints_record_connect(&sdk->endpoints, sdk->endpoint_current, false, 0, now);
+    }
+    if (!reconnecting) {
+        sdk->endpoint_dialing = false;
+    }
+    pthread_mutex_unlock(&sdk->endpoint_mutex);
+}
+
+/**
+ * @brief RTT 探测结果
+ * 
+ * @note 在网络事件循环中调用
+ */
+static void _linx_sdk_endpoint_on_probe(void* user_data, const char* url, int rtt_ms) {
+    LinxSdk* sdk = (LinxSdk*)user_data;
+    uint64_t now = linx_os_now_ms();
+    pthread_mutex_lock(&sdk->endpoint_mutex);
+    int index = linx_endpoints_find(&sdk->endpoints, url);
+    if (rtt_ms >= 0) {
+        linx_endpoints_record_rtt(&sdk->endpoints, index, (uint32_t)rtt_ms, now);
+    } else {
+        linx_endpoints_record_loss(&sdk->endpoints, index, now);
+    }
+    sdk->endpoint_probing = false;
+    pthread_mutex_unlock(&sdk->endpoint_mutex);
+    LOG_DEBUG("服务器 %s RTT %d ms", url, rtt_ms);
+}
+
+/**
+ * @brief 事件循环的定时工作：采样当前连接的保活 RTT 和丢包，按间隔探测其他端点
+ * 
+ * 播放回复期间不发起新的探测。
+ * 
+ * @param sdk 指向LinxSdk实例的指针
+ */
+static void _linx_sdk_service_endpoints(LinxSdk* sdk) {
+    if (!sdk->ws_protocol || sdk->config.shared_connection) {
+        return;
+    }
+    linx_websocket_uplink_stats_t stats = {0};
+    bool sampled = sdk->connected && linx_websocket_get_uplink_stats(sdk->ws_protocol, &stats);
+    bool speaking = linx_sdk_get_state(sdk) == LINX_DEVICE_STATE_SPEAKING;
+    uint64_t now = linx_os_now_ms();
+    char url[LINX_ENDPOINTS_URL_MAX] = "";
+    
+    pthread_mutex_lock(&sdk->endpoint_mutex);
+    if (sampled && stats.keepalive_probes > sdk->endpoint_keepalive_probes) {
+        uint64_t sent = stats.keepalive_probes - sdk->endpoint_keepalive_probes;
+        uint64_t missed = stats.keepalive_missed - sdk->endpoint_keepalive_missed;
+        for (uint64_t i = 0; i < missed; i++) {
+            linx_endpoints_record_loss(&sdk->endpoints, sdk->endpoint_current, now);
+        }
+        if (sent > missed && stats.rtt_valid) {
+            linx_endpoints_record_rtt(&sdk->endpoints, sdk->endpoint_current, stats.rtt_ms, now);
+        }
+        sdk->endpoint_keepalive_probes = stats.keepalive_probes;
+        sdk->endpoint_keepalive_missed = stats.keepalive_missed;
+    }
+    if (!sdk->endpoint_probing && !speaking && sdk->endpoints.count > 1 && sdk->config.endpoint_probe_ms >= 0) {
+        uint32_t interval = sdk->config.endpoint_probe_ms > 0 ? (uint32_t)sdk->config.endpoint_probe_ms
+                                                               : LINX_SDK_DEFAULT_ENDPOINT_PROBE_MS;
+        int index = linx_endpoints_next_probe(&sdk->endpoints, sdk->connected ? sdk->endpoint_current : -1,
+                                              now, interval);
+        if (index >= 0) {
+            snprintf(url, sizeof(url), "%s", sdk->endpoints.items[index].url);
+            sdk->endpoint_probing = true;
+        }
+    }
+    pthread_mutex_unlock(&sdk->endpoint_mutex);
+    
+    if (url[0] && !linx_websocket_probe_rtt(sdk->ws_protocol, url, 0, _linx_sdk_endpoint_on_probe, sdk)) {
+        pthread_mutex_lock(&sdk->endpoint_mutex);
+        linx_endpoints_record_loss(&sdk->endpoints, linx_endpoints_find(&sdk->endpoints, url), now);
+        sdk->endpoint_probing = false;
+        pthread_mutex_unlock(&sdk->endpoint_mutex);
+    }
+}
+
+#if LINX_ENABLE_OTA
+/**
+ * @brief OTA 检查给出 websocket.urls 时替换端点列表，已有端点保留测量，下次连接生效
+ * 
+ * @note 在网络事件循环中调用
+ */
+static void _linx_sdk_endpoints_on_ota(LinxSdk* sdk, const linx_ota_event_t* ota_event) {
+    if (ota_event->status != LINX_OTA_SUCCESS || !ota_event->info || ota_event->info->websocket_urls[0] == '\0') {
+        return;
+    }
+    const linx_ota_info_t* info = ota_event->info;
+    pthread_mutex_lock(&sdk->endpoint_mutex);
+    size_t count = linx_endpoints_set(&sdk->endpoints, info->websocket_url[0] ? info->websocket_url : sdk->config.server_url,
+                                      info->websocket_urls);
+    sdk->endpoint_current = linx_endpoints_find(&sdk->endpoints, sdk->config.server_url);
+    pthread_mutex_unlock(&sdk->endpoint_mutex);
+    LOG_INFO("OTA 给出 %zu 个服务器地址", count);
+}
+#endif
+
+LinxSdkError linx_sdk_get_endpoints(LinxSdk* sdk, linx_endpoints_t* endpoints, int* current) {
+    if (!sdk || !endpoints) {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
+    pthread_mutex_lock(&sdk->endpoint_mutex);
+    *endpoints = sdk->endpoints;
+    if (current) {
+        *current = sdk->endpoint_current;
+    }
+    pthread_mutex_unlock(&sdk->endpoint_mutex);
+    return LINX_SDK_SUCCESS;
+}
+
+#if LINX_ENABLE_MCP
+/**
+ * @brief 服务端拉取了工具表：记下哈希，工具表不变时下次连接在 hello 中告知
+ * 
+ * @param sdk 指向LinxSdk实例的指针
+ * 
+ * @note 在网络事件循环中调用
+ */
+static void _linx_sdk_session_cache_on_tools_list(LinxSdk* sdk) {
+    uint64_t hash = mcp_server_get_tools_hash(sdk->mcp_server);
+    if (hash == 0 || (sdk->session_cache.has_tools_hash && sdk->session_cache.tools_hash == hash)) {
+        return;
+    }
+    linx_session_cache_t* fresh = (linx_session_cache_t*)LINX_CALLOC(1, sizeof(linx_session_cache_t));
+    if (fresh) {
+        fresh->tools_hash = hash;
+        fresh->has_tools_hash = true;
+        linx_session_cache_update(&sdk->config.session_store, &sdk->session_cache, fresh);
+        LINX_FREE(fresh);
+    }
+}
+#endif
+
+/**
+ * @brief 停止句子缓存的回放并丢弃录制中的句子（新回复开始、打断、会话变化）
+ * 
+ * @param sdk 指向LinxSdk实例的指针
+ * 
+ * @note 在网络事件循环中调用（或事件线程停止之后）
+ */
+static void _linx_sdk_tts_cache_reset(LinxSdk* sdk) {
+    if (!sdk->tts_cache) {
+        return;
+    }
+    
+    linx_tts_cache_record_abort(sdk->tts_cache);
+    if (sdk->tts_replay) {
+        linx_tts_cache_release(sdk->tts_cache, sdk->tts_replay);
+        sdk->tts_replay = NULL;
+    }
+    sdk->tts_skipping = false;
+}
+
+/**
+ * @brief 结束当前句子：回放完剩余的缓存包，存入录制的句子
+ * 
+ * 被打断的回复整句丢弃，不会把半句话存入缓存。
+ * 
+ * @param sdk 指向LinxSdk实例的指针
+ */
+static void _linx_sdk_tts_cache_end_sentence(LinxSdk* sdk) {
+    if (!sdk->tts_cache) {
+        return;
+    }
+    
+    if (__atomic_load_n(&sdk->barge_in_dropping, __ATOMIC_ACQUIRE)) {
+        _linx_sdk_tts_cache_reset(sdk);
+        return;
+    }
+    
+    _linx_sdk_tts_cache_pump(sdk, true);
+    if (linx_tts_cache_is_recording(sdk->tts_cache)) {
+        linx_tts_cache_record_commit(sdk->tts_cache);
+    }
+    sdk->tts_skipping = false;
+}
+
+/**
+ * @brief 开始一个句子：命中缓存时通知服务端跳过并本地回放，否则开始录制
+ * 
+ * @param sdk 指向LinxSdk实例的指针
+ * @param text sentence_start 的文本
+ */
+static void _linx_sdk_tts_cache_begin_sentence(LinxSdk* sdk, const char* text) {
+    if (!sdk->tts_cache_active) {
+        return;
+    }
+    
+    linx_tts_cache_entry_t* entry = linx_tts_cache_acquire(sdk->tts_cache, sdk->tts_cache_voice, text);
+    if (!entry) {
+        linx_tts_cache_record_begin(sdk->tts_cache, sdk->tts_cache_voice, text);
+        return;
+    }
+    
+    uint32_t duration_ms = linx_tts_cache_entry_duration_ms(entry);
+    linx_protocol_send_tts_skip(_linx_sdk_protocol(sdk), text, duration_ms);
+    linx_metrics_add(&sdk->metrics, LINX_METRIC_TTS_CACHE_HITS, 1);
+    LOG_INFO("TTS句子缓存命中 (%u ms, %zu 字节)，本地回放", (unsigned)duration_ms,
+             linx_tts_cache_entry_audio_bytes(entry));
+    
+    // 回放包接在已收到的下行音频之后，服务端跳过时把时间戳前移同样的时长
+    sdk->tts_skipping = true;
+    sdk->tts_replay = entry;
+    sdk->tts_replay_offset = 0;
+    sdk->tts_replay_start_ms = _linx_sdk_now_ms();
+    sdk->tts_replay_sent_ms = 0;
+    sdk->tts_replay_timestamp = sdk->downlink_next_timestamp;
+    _linx_sdk_tts_cache_pump(sdk, false);
+}
+
+/**
+ * @brief 按实时节奏回放缓存的句子，播放器中保持约 LINX_SDK_TTS_REPLAY_LEAD_MS 的待播音频
+ * 
+ * 回放期间下行流控报告缓冲已满，服务端的后续消息留在网络层，顺序不会乱。
+ * 
+ * @param sdk 指向LinxSdk实例的指针
+ * @param flush 一次回放完剩余的包（句子结束时）
+ * 
+ * @note 在网络事件循环中调用
+ */
+static void _linx_sdk_tts_cache_pump(LinxSdk* sdk, bool flush) {
+    if (!sdk->tts_replay) {
+        return;
+    }
+    
+    // 本地打断后剩余的包不再回放
+    if (__atomic_load_n(&sdk->barge_in_dropping, __ATOMIC_ACQUIRE)) {
+        _linx_sdk_tts_cache_reset(sdk);
+        return;
+    }
+    
+    uint64_t elapsed_ms = _linx_sdk_now_ms() - sdk->tts_replay_start_ms;
+    while (flush || sdk->tts_replay_sent_ms < elapsed_ms + LINX_SDK_TTS_REPLAY_LEAD_MS) {
+        const uint8_t* payload = NULL;
+        size_t size = 0;
+        int duration_ms = 0;
+        if (!linx_tts_cache_entry_next(sdk->tts_replay, &sdk->tts_replay_offset, &payload, &size, &duration_ms)) {
+            linx_tts_cache_release(sdk->tts_cache, sdk->tts_replay);
+            sdk->tts_replay = NULL;
+            sdk->downlink_next_timestamp = sdk->tts_replay_timestamp;
+            return;
+        }
+        
+        linx_audio_stream_packet_t packet = {
+            .sample_rate = sdk->downlink_sample_rate,
+            .frame_duration = duration_ms,
+            .timestamp = sdk->tts_replay_timestamp,
+            .payload = (uint8_t*)payload,
+            .payload_size = size,
+            .owned = false
+        };
+        _linx_sdk_deliver_downlink(sdk, &packet);
+        sdk->tts_replay_timestamp += (uint32_t)duration_ms;
+        sdk->tts_replay_sent_ms += (uint32_t)duration_ms;
+    }
+}
+
+/**
+ * @brief SDK事件处理线程函数
+ * 
+ * 这是SDK的主要事件处理线程，负责轮询WebSocket连接并处理网络事件。
+ * 线程会持续运行直到SDK被销毁或明确停止。
+ * 
+ * @param arg 线程参数，应该指向LinxSdk实例
+ * @return void* 线程返回值，总是返回NULL
+ * 
+ * @note 该函数在独立的线程中运行
+ * @note 事件驱动模式下线程阻塞在 mg_mgr_poll 中，直到有 socket 活动、
+ *       其他线程发送数据或停止时通过 linx_websocket_wakeup() 唤醒
+ * @note 轮询模式下保持旧行为，以10ms的间隔轮询WebSocket事件
+ * @note 如果arg为NULL，线程会立即退出
+ * @note 线程的运行状态由sdk->event_thread_running控制
+ * 
+ * @see linx_websocket_poll
+ * @see linx_websocket_wakeup
+ * @see LinxSdk::event_thread_running
+ */
+static void* _linx_sdk_event_thread(void* arg) {
+    LinxSdk* sdk = (LinxSdk*)arg;
+    if (!sdk) return NULL;
+    linx_thread_stats_register("sdk_event", LINX_THREAD_STAGE_NETWORK);
+    
+    bool event_driven = sdk->config.event_loop_mode == LINX_EVENT_LOOP_EVENT_DRIVEN;
+    
+    while (sdk->event_thread_running) {
+        if (!sdk->ws_protocol) {
+            linx_os_sleep_ms(10);
+            continue;
+        }
+        
+        if (event_driven) {
+            // 阻塞等待socket活动或唤醒，OTA限速暂停或重试到期时提前返回
+            _linx_sdk_run_loop_once(sdk, LINX_SDK_EVENT_LOOP_IDLE_TIMEOUT_MS);
+        } else {
+            // 轮询WebSocket协议
+            _linx_sdk_run_loop_once(sdk, 10);
+            
+            // 短暂休眠避免CPU占用过高
+            linx_os_sleep_ms(10);
+        }
+    }
+    
+    linx_thread_stats_unregister();
+    return NULL;
+}
+
+/**
+ * @brief 网络事件循环的最长等待时间（OTA限速暂停或重试到期时缩短）
+ * 
+ * @param sdk 指向LinxSdk实例的指针
+ * @return 毫秒数
+ */
+static int _linx_sdk_loop_timeout_ms(LinxSdk* sdk) {
+#if LINX_ENABLE_OTA
+    int timeout_ms = sdk->ota_active ? linx_ota_poll_timeout_ms(sdk->config.ota, LINX_SDK_EVENT_LOOP_IDLE_TIMEOUT_MS)
+                                     : LINX_SDK_EVENT_LOOP_IDLE_TIMEOUT_MS;
+#else
+    int timeout_ms = LINX_SDK_EVENT_LOOP_IDLE_TIMEOUT_MS;
+#endif
+    
+    // 句子缓存回放中，定时补包
+    if (sdk->tts_replay && timeout_ms > LINX_SDK_TTS_REPLAY_LEAD_MS / 12) {
+        timeout_ms = LINX_SDK_TTS_REPLAY_LEAD_MS / 12;
+    }
+    
+    // 调速器按采样周期醒来
+    if (sdk->governor) {
+        int governor_ms = linx_governor_next_timeout_ms(sdk->governor, linx_os_now_ms());
+        if (governor_ms < timeout_ms) {
+            timeout_ms = governor_ms;
+        }
+    }
+    
+    // 内存压力按检查周期醒来
+    if (sdk->config.memory_pressure) {
+        int memory_ms = linx_mem_pressure_next_timeout_ms();
+        if (memory_ms < timeout_ms) {
+            timeout_ms = memory_ms;
+        }
+    }
+    return timeout_ms;
+}
+
+/**
+ * @brief 事件循环的一次迭代：轮询网络，然后驱动OTA和RTT测量
+ * 
+ * 由事件线程或外部循环模式下的 linx_sdk_poll_events 调用。
+ * 
+ * @param sdk 指向LinxSdk实例的指针
+ * @param timeout_ms 最多等待的时间（毫秒），-1 表示没有上限（仍受OTA定时器限制）
+ */
+static void _linx_sdk_run_loop_once(LinxSdk* sdk, int timeout_ms) {
+    int loop_timeout_ms = _linx_sdk_loop_timeout_ms(sdk);
+    if (timeout_ms < 0 || timeout_ms > loop_timeout_ms) {
+        timeout_ms = loop_timeout_ms;
+    }
+    
+    linx_websocket_poll(sdk->ws_protocol, timeout_ms);
+    _linx_sdk_tts_cache_pump(sdk, false);
+    _linx_sdk_service_ota(sdk);
+    _linx_sdk_service_endpoints(sdk);
+    _linx_sdk_service_governor(sdk);
+    _linx_sdk_service_memory(sdk);
+    _linx_sdk_check_idle(sdk);
+    _linx_sdk_flush_audio_batch(sdk);
+}
+
+/**
+ * @brief 共享 reactor 的轮询钩子：驱动本实例的OTA和句子缓存回放（循环上下文；RTT 由 WebSocket 保活测量）
+ * 
+ * @param user_data 指向LinxSdk实例的指针
+ */
+static void _linx_sdk_reactor_on_poll(void* user_data) {
+    LinxSdk* sdk = (LinxSdk*)user_data;
+    if (sdk->ws_protocol) {
+        _linx_sdk_tts_cache_pump(sdk, false);
+        _linx_sdk_service_ota(sdk);
+        _linx_sdk_service_endpoints(sdk);
+        _linx_sdk_service_governor(sdk);
+        _linx_sdk_service_memory(sdk);
+        _linx_sdk_check_idle(sdk);
+        _linx_sdk_flush_audio_batch(sdk);
+    }
+}
+
+/**
+ * @brief 共享 reactor 的等待时间钩子：OTA限速暂停或重试到期时缩短轮询等待
+ */
+static int _linx_sdk_reactor_next_timeout(void* user_data, int idle_ms) {
+    int timeout_ms = _linx_sdk_loop_timeout_ms((LinxSdk*)user_data);
+    return timeout_ms < idle_ms ? timeout_ms : idle_ms;
+}
+
+/**
+ * @brief 在循环上下文中取消本实例的OTA操作
+ * 
+ * @param arg 指向LinxSdk实例的指针
+ */
+static void _linx_sdk_cancel_ota_task(void* arg) {
+    LinxSdk* sdk = (LinxSdk*)arg;
+#if LINX_ENABLE_OTA
+    if (sdk->ota_active) {
+        linx_ota_cancel(sdk->config.ota);
+        sdk->ota_active = false;
+    }
+#endif
+    _linx_sdk_finish_future(sdk->ota_future, LINX_OTA_ERROR_REQUEST, NULL, 0);
+    sdk->ota_future = NULL;
+}
+
+/**
+ * @brief 停止事件处理线程
+ * 
+ * 清除运行标志后唤醒可能阻塞在 mg_mgr_poll 中的事件线程，再等待其退出。
+ * 共享 reactor 时注销轮询钩子，reactor 本身继续为其他实例运行。
+ * 
+ * @param sdk 指向LinxSdk实例的指针
+ */
+static void _linx_sdk_stop_event_thread(LinxSdk* sdk) {
+    if (!sdk->event_thread_running) {
+        return;
+    }
+    
+    sdk->event_thread_running = false;
+    if (sdk->ws_stream) {
+        // 流由承载实例的事件循环驱动，本实例没有线程，也不会有OTA连接
+    } else if (sdk->config.reactor) {
+        // 钩子注销后本实例不再被轮询，OTA连接仍在共享管理器上，需在循环上下文中取消
+        linx_reactor_remove_hook(sdk->config.reactor, &sdk->reactor_hook);
+        linx_reactor_run(sdk->config.reactor, _linx_sdk_cancel_ota_task, sdk);
+    } else {
+        if (sdk->config.event_loop_mode != LINX_EVENT_LOOP_EXTERNAL) {
+            if (sdk->ws_protocol) {
+                linx_websocket_wakeup(sdk->ws_protocol);
+            }
+            linx_thread_join(sdk->event_thread);
+            sdk->event_thread = NULL;
+        }
+        
+        // 事件线程已退出，OTA连接所在的管理器不再被轮询，在此取消
+        _linx_sdk_cancel_ota_task(sdk);
+    }
+    pthread_mutex_lock(&sdk->state_mutex);
+    sdk->ota_request = LINX_SDK_OTA_REQUEST_NONE;
+    sdk->ota_sink = NULL;
+    pthread_mutex_unlock(&sdk->state_mutex);
+}
+
+// 状态管理函数
+/**
+ * @brief 设置SDK会话ID
+ * 
+ * 这是一个线程安全的内部函数，用于设置或清除SDK的会话ID。
+ * 会话ID用于标识与服务器的特定会话连接。
+ * 
+ * @param sdk 指向LinxSdk实例的指针，不能为NULL
+ * @param session_id 会话ID字符串，可以为NULL表示清除会话ID
+ * 
+ * @note 该函数是线程安全的，使用互斥锁保护会话ID的设置
+ * @note 如果sdk为NULL，函数会安全返回
+ * @note 会话ID会被动态分配内存存储
+ * @note 设置会话ID的操作会被记录到日志中
+ * 
+ * @see LinxSdk::session_id
+ * @see LinxSdk::state_mutex
+ */
+static void _linx_sdk_set_session_id(LinxSdk* sdk, const char* session_id) {
+    if (!sdk) return;
+    
+    pthread_mutex_lock(&sdk->state_mutex);
+    
+    if (sdk->session_id) {
+        LINX_FREE(sdk->session_id);
+        sdk->session_id = NULL;
+    }
+    
+    if (session_id) {
+        sdk->session_id = LINX_STRDUP(session_id);
+    }
+    
+    pthread_mutex_unlock(&sdk->state_mutex);
+    
+    LOG_INFO("会话ID已设置: %s", session_id ? session_id : "(空)");
+}
+
+// 预留的监听控制函数接口，待后续实现
+
+/**
+ * @brief MCP消息发送回调函数
+ * 
+ * 这是一个内部回调函数，把MCP（Model Context Protocol）服务器的响应
+ * 封装成"mcp"消息发给服务端。回调按服务器实例注册，同一进程中的
+ * 多个SDK实例各自回复到自己的连接。
+ * 
+ * @param message MCP消息字符串，可能为NULL
+ * @param user_data 持有该MCP服务器的SDK实例
+ * 
+ * @note 同步工具在收消息的线程、异步工具在MCP工作线程中调用本函数，
+ *       linx_protocol_send_mcp_message 是线程安全的
+ * @note 未连接时响应被丢弃
+ * 
+ * @see mcp_server_set_send_handler
+ */
+#if LINX_ENABLE_MCP
+static void _linx_sdk_mcp_send_callback(const char* message, void* user_data) {
+    LinxSdk* sdk = (LinxSdk*)user_data;
+    if (!message || !sdk) {
+        return;
+    }
+    
+    if (!sdk->connected || !sdk->ws_protocol) {
+        LOG_WARN("未连接，丢弃MCP响应");
+        return;
+    }
+    
+    LOG_DEBUG("发送MCP消息: %s", message);
+    linx_protocol_send_mcp_message(_linx_sdk_protocol(sdk), message);
+}
+#endif
+
+// ============================================================================
+// WebSocket相关函数实现
+// ============================================================================
+
+LinxSdkError linx_sdk_abort_speaking(LinxSdk* sdk, linx_abort_reason_t reason) {
+    if (!sdk) {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
+    
+    if (!sdk->connected || !sdk->ws_protocol) {
+        return LINX_SDK_ERROR_NETWORK;
+    }
+    
+    _linx_sdk_report_playback_position(sdk);
+    linx_protocol_send_abort_speaking(_linx_sdk_protocol(sdk), reason);
+    
+    return LINX_SDK_SUCCESS;
+}
+
+LinxSdkError linx_sdk_send_wake_word(LinxSdk* sdk, const char* wake_word) {
+    if (!sdk || !wake_word) {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
+    
+    if (!sdk->connected || !sdk->ws_protocol) {
+        return LINX_SDK_ERROR_NETWORK;
+    }
+    
+    if (sdk->config.barge_in) {
+        linx_sdk_barge_in(sdk, LINX_ABORT_REASON_WAKE_WORD_DETECTED);
+    }
+    
+    linx_protocol_send_wake_word_detected(_linx_sdk_protocol(sdk), wake_word);
+    linx_metrics_stage_begin(&sdk->metrics, LINX_METRIC_WAKE_TO_FIRST_UPLINK);
+    
+    return LINX_SDK_SUCCESS;
+}
+
+LinxSdkError linx_sdk_wake(LinxSdk* sdk, const char* wake_word) {
+    if (!sdk || !wake_word || wake_word[0] == '\0') {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
+    
+    // 与 hello 处理共用 uplink_mutex：要么看到已打开的通道，要么唤醒词在打开时发出
+    pthread_mutex_lock(&sdk->uplink_mutex);
+    bool open = sdk->uplink_open && sdk->connected;
+    uint8_t speculation = sdk->wake_speculation;
+    bool confirm = false;
+    if (!open) {
+        snprintf(sdk->pending_wake_word, sizeof(sdk->pending_wake_word), "%s", wake_word);
+        // 推测式会话已就绪（或已撤销、连接仍在）时就地确认，否则唤醒词随 hello 处理发出
+        confirm = sdk->connected && (speculation == LINX_WAKE_SPEC_HELD || speculation == LINX_WAKE_SPEC_PARKED);
+        sdk->wake_speculation = confirm ? LINX_WAKE_SPEC_HELD : LINX_WAKE_SPEC_NONE;
+    }
+    pthread_mutex_unlock(&sdk->uplink_mutex);
+    
+    if (open) {
+        return linx_sdk_send_wake_word(sdk, wake_word);
+    }
+    if (confirm) {
+        if (speculation == LINX_WAKE_SPEC_PARKED) {
+            _linx_sdk_resume_listening(sdk);
+        }
+        pthread_mutex_lock(&sdk->uplink_mutex);
+        if (sdk->wake_speculation == LINX_WAKE_SPEC_HELD && sdk->connected) {
+            sdk->wake_speculation = LINX_WAKE_SPEC_NONE;
+            _linx_sdk_send_pending_wake_word_locked(sdk);
+            sdk->uplink_open = true;
+            _linx_sdk_flush_preconnect_locked(sdk);
+        }
+        pthread_mutex_unlock(&sdk->uplink_mutex);
+        return LINX_SDK_SUCCESS;
+    }
+    LOG_INFO("检测到唤醒词 %s，会话就绪后发送", wake_word);
+    // 推测式会话正在建立，不再发起新的连接
+    if ((speculation == LINX_WAKE_SPEC_CONNECTING || speculation == LINX_WAKE_SPEC_CANCELLED) &&
+        (sdk->connected || linx_sdk_get_state(sdk) == LINX_DEVICE_STATE_CONNECTING)) {
+        return LINX_SDK_SUCCESS;
+    }
+    if (linx_sdk_is_sleeping(sdk)) {
+        return linx_sdk_exit_sleep(sdk);
+    }
+    return linx_sdk_connect(sdk);
+}
+
+LinxSdkError linx_sdk_wake_speculative(LinxSdk* sdk) {
+    if (!sdk) {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
+    
+    if (!sdk->initialized) {
+        return LINX_SDK_ERROR_NOT_INITIALIZED;
+    }
+    
+    pthread_mutex_lock(&sdk->uplink_mutex);
+    bool open = sdk->uplink_open && sdk->connected;
+    uint8_t speculation = sdk->wake_speculation;
+    bool resume = false;
+    if (!open && speculation != LINX_WAKE_SPEC_HELD) {
+        resume = speculation == LINX_WAKE_SPEC_PARKED && sdk->connected;
+        sdk->wake_speculation = resume ? LINX_WAKE_SPEC_HELD : LINX_WAKE_SPEC_CONNECTING;
+    }
+    pthread_mutex_unlock(&sdk->uplink_mutex);
+    
+    // 正在对话，或上一次推测式会话还在等待确认
+    if (open || speculation == LINX_WAKE_SPEC_HELD) {
+        return LINX_SDK_SUCCESS;
+    }
+    if (resume) {
+        _linx_sdk_resume_listening(sdk);
+        return LINX_SDK_SUCCESS;
+    }
+    
+    LOG_INFO("唤醒词待确认，推测式建立会话");
+    if (sdk->connected || linx_sdk_get_state(sdk) == LINX_DEVICE_STATE_CONNECTING) {
+        return LINX_SDK_SUCCESS;
+    }
+    LinxSdkError result = linx_sdk_is_sleeping(sdk) ? linx_sdk_exit_sleep(sdk) : linx_sdk_connect(sdk);
+    if (result != LINX_SDK_SUCCESS) {
+        pthread_mutex_lock(&sdk->uplink_mutex);
+        if (sdk->wake_speculation == LINX_WAKE_SPEC_CONNECTING) {
+            sdk->wake_speculation = LINX_WAKE_SPEC_NONE;
+        }
+        pthread_mutex_unlock(&sdk->uplink_mutex);
+    }
+    return result;
+}
+
+LinxSdkError linx_sdk_wake_cancel(LinxSdk* sdk) {
+    if (!sdk) {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
+    
+    // 暂存的是被否决的语音，不能再发给服务端
+    pthread_mutex_lock(&sdk->uplink_mutex);
+    uint8_t speculation = sdk->wake_speculation;
+    if (speculation == LINX_WAKE_SPEC_CONNECTING) {
+        sdk->wake_speculation = LINX_WAKE_SPEC_CANCELLED;
+        encoded_frame_buffer_clear(sdk->preconnect_buffer);
+    } else if (speculation == LINX_WAKE_SPEC_HELD) {
+        sdk->wake_speculation = LINX_WAKE_SPEC_PARKED;
+        encoded_frame_buffer_clear(sdk->preconnect_buffer);
+    }
+    pthread_mutex_unlock(&sdk->uplink_mutex);
+    
+    if (speculation == LINX_WAKE_SPEC_HELD) {
+        _linx_sdk_park_listening(sdk);
+    } else if (speculation == LINX_WAKE_SPEC_CONNECTING) {
+        LOG_INFO("唤醒未确认，会话就绪后停止监听");
+    }
+    return LINX_SDK_SUCCESS;
+}
+
+/**
+ * @brief 记录一次活动（收发音频、收到服务端消息），空闲检测从此刻重新计时
+ * 
+ * @param sdk 指向LinxSdk实例的指针
+ */
+static void _linx_sdk_touch_activity(LinxSdk* sdk) {
+    __atomic_store_n(&sdk->last_activity_ms, linx_os_now_ms(), __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief 当前线程是否是驱动本实例网络的事件循环（事件线程或共享 reactor）
+ */
+static bool _linx_sdk_in_event_loop(LinxSdk* sdk) {
+    if (sdk->config.reactor) {
+        return linx_reactor_in_loop(sdk->config.reactor);
+    }
+    return sdk->event_thread && linx_thread_is_current(sdk->event_thread);
+}
+
+static void* _linx_sdk_sleep_thread(void* arg) {
+    LinxSdk* sdk = (LinxSdk*)arg;
+    linx_sdk_enter_sleep(sdk);
+    __atomic_store_n(&sdk->sleep_pending, false, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+/**
+ * @brief 在单独的线程上进入低功耗（断开连接要等待事件线程退出，不能在事件线程上执行）
+ * 
+ * @param sdk 指向LinxSdk实例的指针
+ * @return 已提交或已有一次在进行中返回 true
+ */
+static bool _linx_sdk_request_sleep(LinxSdk* sdk) {
+    if (__atomic_exchange_n(&sdk->sleep_pending, true, __ATOMIC_ACQ_REL)) {
+        return true;
+    }
+    // 回收上一次的线程
+    linx_thread_t* previous = __atomic_exchange_n(&sdk->sleep_thread, NULL, __ATOMIC_ACQ_REL);
+    if (previous) {
+        linx_thread_join(previous);
+    }
+    const linx_thread_attr_t attr = {
+        .name = "sdk_sleep",
+        .priority = LINX_THREAD_PRIORITY_NORMAL
+    };
+    linx_thread_t* thread = linx_thread_create(&attr, _linx_sdk_sleep_thread, sdk);
+    if (!thread) {
+        __atomic_store_n(&sdk->sleep_pending, false, __ATOMIC_RELEASE);
+        LOG_WARN("低功耗线程创建失败");
+        return false;
+    }
+    __atomic_store_n(&sdk->sleep_thread, thread, __ATOMIC_RELEASE);
+    return true;
+}
+
+/**
+ * @brief 空闲检测：已连接、不在播放回复，且超过 sleep_idle_ms 没有活动时自动进入低功耗
+ * 
+ * @param sdk 指向LinxSdk实例的指针
+ * 
+ * @note 在网络事件循环中调用
+ */
+static void _linx_sdk_check_idle(LinxSdk* sdk) {
+    if (sdk->config.sleep_idle_ms <= 0 || !sdk->connected ||
+        __atomic_load_n(&sdk->sleep_pending, __ATOMIC_ACQUIRE) ||
+        linx_sdk_get_tts_state(sdk) == LINX_TTS_STATE_STARTED) {
+        return;
+    }
+    uint64_t last = __atomic_load_n(&sdk->last_activity_ms, __ATOMIC_RELAXED);
+    if (linx_os_now_ms() - last < (uint64_t)sdk->config.sleep_idle_ms) {
+        return;
+    }
+    LOG_INFO("空闲 %d 毫秒，进入低功耗", (int)sdk->config.sleep_idle_ms);
+    _linx_sdk_request_sleep(sdk);
+}
+
+LinxSdkError linx_sdk_enter_sleep(LinxSdk* sdk) {
+    if (!sdk) {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
+    
+    if (!sdk->initialized) {
+        return LINX_SDK_ERROR_NOT_INITIALIZED;
+    }
+    
+    if (_linx_sdk_in_event_loop(sdk)) {
+        return _linx_sdk_request_sleep(sdk) ? LINX_SDK_SUCCESS : LINX_SDK_ERROR_UNKNOWN;
+    }
+    
+    pthread_mutex_lock(&sdk->power_mutex);
+    if (__atomic_load_n(&sdk->sleeping, __ATOMIC_ACQUIRE)) {
+        pthread_mutex_unlock(&sdk->power_mutex);
+        return LINX_SDK_SUCCESS;
+    }
+    
+    uint64_t start_us = linx_os_now_us();
+    // 会话状态（session_id、hello 协商结果、TLS 会话）在 hello 时已记下，断开不会清除
+    linx_sdk_disconnect(sdk);
+    linx_player_t* player = __atomic_load_n(&sdk->player, __ATOMIC_ACQUIRE);
+    if (player) {
+        linx_player_stop(player);
+    }
+    if (sdk->config.power_hooks.on_sleep) {
+        sdk->config.power_hooks.on_sleep(sdk->config.power_hooks.user_data);
+    }
+    sdk->sleep_resume = true;
+    __atomic_store_n(&sdk->sleeping, true, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&sdk->power_mutex);
+    
+    LOG_INFO("已进入低功耗，用时 %llu 微秒", (unsigned long long)(linx_os_now_us() - start_us));
+    LinxEvent event = {
+        .type = LINX_EVENT_SLEEP_ENTERED,
+        .timestamp = time(NULL)
+    };
+    _linx_sdk_emit_event(sdk, &event);
+    return LINX_SDK_SUCCESS;
+}
+
+LinxSdkError linx_sdk_exit_sleep(LinxSdk* sdk) {
+    if (!sdk) {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
+    
+    if (!sdk->initialized) {
+        return LINX_SDK_ERROR_NOT_INITIALIZED;
+    }
+    
+    // 自动进入低功耗可能还在进行，等它完成再恢复（线程句柄在创建后才存入，短暂等待）
+    linx_thread_t* sleep_thread;
+    while (!(sleep_thread = __atomic_exchange_n(&sdk->sleep_thread, NULL, __ATOMIC_ACQ_REL)) &&
+           __atomic_load_n(&sdk->sleep_pending, __ATOMIC_ACQUIRE)) {
+        usleep(1000);
+    }
+    if (sleep_thread && linx_thread_is_current(sleep_thread)) {
+        // 在 LINX_EVENT_SLEEP_ENTERED 回调中调用：线程由之后的调用或销毁回收
+        __atomic_store_n(&sdk->sleep_thread, sleep_thread, __ATOMIC_RELEASE);
+    } else if (sleep_thread) {
+        linx_thread_join(sleep_thread);
+    }
+    
+    pthread_mutex_lock(&sdk->power_mutex);
+    if (!__atomic_load_n(&sdk->sleeping, __ATOMIC_ACQUIRE)) {
+        pthread_mutex_unlock(&sdk->power_mutex);
+        return LINX_SDK_SUCCESS;
+    }
+    __atomic_store_n(&sdk->sleeping, false, __ATOMIC_RELEASE);
+    
+    // 先发起连接：DNS、TCP、TLS 和 hello 在事件线程上进行，同时启动音频设备
+    uint64_t t0 = linx_os_now_us();
+    LinxSdkError result = linx_sdk_connect(sdk);
+    uint64_t t1 = linx_os_now_us();
+    if (sdk->config.power_hooks.on_wake) {
+        sdk->config.power_hooks.on_wake(sdk->config.power_hooks.user_data);
+    }
+    uint64_t t2 = linx_os_now_us();
+    linx_player_t* player = __atomic_load_n(&sdk->player, __ATOMIC_ACQUIRE);
+    if (player) {
+        linx_player_start(player);
+    }
+    uint64_t t3 = linx_os_now_us();
+    _linx_sdk_touch_activity(sdk);
+    pthread_mutex_unlock(&sdk->power_mutex);
+    
+    LOG_INFO("退出低功耗: 发起连接 %llu 微秒，音频设备 %llu 微秒，播放器 %llu 微秒",
+             (unsigned long long)(t1 - t0), (unsigned long long)(t2 - t1), (unsigned long long)(t3 - t2));
+    if (result != LINX_SDK_SUCCESS) {
+        LOG_WARN("退出低功耗时连接失败: %d", result);
+    }
+    LinxEvent event = {
+        .type = LINX_EVENT_SLEEP_EXITED,
+        .timestamp = time(NULL)
+    };
+    _linx_sdk_emit_event(sdk, &event);
+    return result;
+}
+
+bool linx_sdk_is_sleeping(LinxSdk* sdk) {
+    return sdk && __atomic_load_n(&sdk->sleeping, __ATOMIC_ACQUIRE);
+}
+
+bool linx_sdk_is_uplink_open(LinxSdk* sdk) {
+    if (!sdk) {
+        return false;
+    }
+    pthread_mutex_lock(&sdk->uplink_mutex);
+    bool open = sdk->uplink_open;
+    pthread_mutex_unlock(&sdk->uplink_mutex);
+    return open;
+}
+
+bool linx_sdk_barge_in(LinxSdk* sdk, linx_abort_reason_t reason) {
+    if (!sdk) {
+        return false;
+    }
+    
+    bool realtime = sdk->config.listening_mode == LINX_LISTENING_MODE_REALTIME;
+    
+    // 只有把 SPEAKING 切回 LISTENING 的那次调用执行打断，与 tts stop 和其他线程的打断互斥
+    if (linx_sdk_get_state(sdk) != LINX_DEVICE_STATE_SPEAKING ||
+        !_linx_sdk_transition(sdk, LINX_DEVICE_STATE_LISTENING,
+                              realtime ? LINX_STATE_KEEP : LINX_LISTEN_STATE_STARTED, LINX_TTS_STATE_STOPPED)) {
+        return false;
+    }
+    
+    // 先停声音和下行，再通知服务端；播出位置在清空之前取，告诉服务端用户听到了哪里
+    __atomic_store_n(&sdk->barge_in_dropping, true, __ATOMIC_RELEASE);
+    __atomic_store_n(&sdk->tts_first_frame_pending, false, __ATOMIC_RELAXED);
+    linx_metrics_stage_cancel(&sdk->metrics, LINX_METRIC_TTS_TO_PLAYBACK);
+    linx_player_position_t position;
+    bool has_position = false;
+    linx_player_t* player = __atomic_load_n(&sdk->player, __ATOMIC_ACQUIRE);
+    if (player && __atomic_load_n(&sdk->playback_position_active, __ATOMIC_RELAXED)) {
+        has_position = linx_player_get_position(player, &position) == PLAYER_SUCCESS && position.has_timestamp;
+    }
+    if (player) {
+        linx_player_set_continuation(player, false);
+        linx_player_flush(player);
+    }
+    
+    if (sdk->connected && sdk->ws_protocol) {
+        if (has_position) {
+            linx_protocol_send_playback_position(_linx_sdk_protocol(sdk), position.timestamp,
+                                                 position.output_delay_us / 1000u);
+        }
+        linx_protocol_send_abort_speaking(_linx_sdk_protocol(sdk), reason);
+        if (!realtime) {
+            linx_protocol_send_start_listening(_linx_sdk_protocol(sdk), sdk->config.listening_mode);
+        }
+    }
+    _linx_sdk_trace_begin_turn(sdk, !realtime);
+    LOG_INFO("本地打断TTS播放");
+    
+    LinxEvent event = {
+        .type = LINX_EVENT_TTS_STOPPED,
+        .timestamp = time(NULL)
+    };
+    _linx_sdk_emit_event(sdk, &event);
+    
+    if (!realtime) {
+        LinxEvent listen_event = {
+            .type = LINX_EVENT_LISTENING_STARTED,
+            .timestamp = time(NULL)
+        };
+        _linx_sdk_emit_event(sdk, &listen_event);
+    }
+    return true;
+}
+
+LinxSdkError linx_sdk_notify_speech_start(LinxSdk* sdk) {
+    if (!sdk) {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
+    
+    // 打断会开始新的轮次，VAD 节点记在新轮次里
+    if (sdk->config.barge_in) {
+        linx_sdk_barge_in(sdk, LINX_ABORT_REASON_NONE);
+    }
+    linx_trace_mark_first(sdk->trace, LINX_TRACE_VAD_ONSET);
+    return LINX_SDK_SUCCESS;
+}
+
+LinxSdkError linx_sdk_notify_speech_end(LinxSdk* sdk) {
+    if (!sdk) {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
+    
+    if (sdk->config.local_endpoint_ms == 0 || sdk->config.listening_mode != LINX_LISTENING_MODE_AUTO_STOP) {
+        return LINX_SDK_SUCCESS;
+    }
+    
+    // 只在监听中从 STARTED 切到 STOPPED 一次；与服务端的 stt、tts start 并发时只有一方生效
+    uint32_t old_word = __atomic_load_n(&sdk->state_word, __ATOMIC_ACQUIRE);
+    uint32_t new_word;
+    do {
+        if (_linx_state_device(old_word) != LINX_DEVICE_STATE_LISTENING ||
+            _linx_state_listen(old_word) != LINX_LISTEN_STATE_STARTED) {
+            return LINX_SDK_SUCCESS;
+        }
+        new_word = _linx_state_pack(LINX_DEVICE_STATE_LISTENING, LINX_LISTEN_STATE_STOPPED,
+                                    _linx_state_tts(old_word));
+    } while (!__atomic_compare_exchange_n(&sdk->state_word, &old_word, new_word, true,
+                                          __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+    
+    // 最后几帧先于 listen stop 发出
+    linx_sdk_flush_audio(sdk);
+    if (sdk->connected && sdk->ws_protocol) {
+        linx_protocol_send_stop_listening(_linx_sdk_protocol(sdk));
+    }
+    linx_metrics_add(&sdk->metrics, LINX_METRIC_LOCAL_ENDPOINTS, 1);
+    LOG_INFO("本地检测到说话结束，停止监听");
+    
+    LinxEvent event = {
+        .type = LINX_EVENT_LISTENING_STOPPED,
+        .timestamp = time(NULL)
+    };
+    _linx_sdk_emit_event(sdk, &event);
+    return LINX_SDK_SUCCESS;
+}
+
+LinxSdkError linx_sdk_set_player(LinxSdk* sdk, linx_player_t* player) {
+    if (!sdk) {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
+    
+    __atomic_store_n(&sdk->player, player, __ATOMIC_RELEASE);
+    return LINX_SDK_SUCCESS;
+}
+
+/**
+ * @brief 下行流控的缓冲水位：播放器抖动缓冲区中已缓冲的时长
+ * 
+ * @note 在WebSocket事件循环中调用；未设置播放器时返回 -1，不暂停读取
+ */
+static int _linx_sdk_downlink_level(void* user_data) {
+    LinxSdk* sdk = (LinxSdk*)user_data;
+    linx_player_t* player = __atomic_load_n(&sdk->player, __ATOMIC_ACQUIRE);
+    int buffered_ms = 0;
+    
+    if (!player || linx_player_get_buffer_level(player, &buffered_ms, NULL) != PLAYER_SUCCESS) {
+        return -1;
+    }
+    
+    // 句子缓存回放期间暂停读取，服务端之后的消息和音频排在回放之后
+    if (sdk->tts_replay) {
+        return (int)sdk->config.downlink_buffer_ms;
+    }
+    return buffered_ms;
+}
+
+LinxSdkError linx_sdk_get_session_params(LinxSdk* sdk, LinxSessionParams* params) {
+    if (!sdk || !params) {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
+    
+    if (!sdk->ws_protocol || !linx_websocket_get_session_params(sdk->ws_protocol, params)) {
+        return LINX_SDK_ERROR_NOT_INITIALIZED;
+    }
+    return LINX_SDK_SUCCESS;
+}
+
+linx_executor_t* linx_sdk_get_executor(LinxSdk* sdk) {
+    return sdk ? __atomic_load_n(&sdk->executor, __ATOMIC_ACQUIRE) : NULL;
+}
+
+LinxSdkError linx_sdk_get_flow_stats(LinxSdk* sdk, LinxFlowStats* stats) {
+    if (!sdk || !stats) {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
+    
+    if (!sdk->ws_protocol || !linx_websocket_get_flow_stats(sdk->ws_protocol, stats)) {
+        return LINX_SDK_ERROR_NOT_INITIALIZED;
+    }
+    return LINX_SDK_SUCCESS;
+}
+
+const char* linx_sdk_get_session_id(LinxSdk* sdk) {
+    if (!sdk) {
+        return NULL;
+    }
+    
+    return sdk->session_id;
+}
+
+// ============================================================================
+// MCP相关函数实现
+// ============================================================================
+
+#if LINX_ENABLE_MCP
+LinxSdkError linx_sdk_add_mcp_tool(LinxSdk* sdk, const char* name, const char* description,
+                                   mcp_property_list_t* properties, mcp_tool_callback_t callback) {
+    if (!sdk || !name || !description) {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
+    
+    if (!sdk->mcp_enabled || !sdk->mcp_server) {
+        return LINX_SDK_ERROR_NOT_INITIALIZED;
+    }
+   // 添加MCP工具
+    if (!mcp_server_add_simple_tool(sdk->mcp_server, name, description, properties, callback)) {
+        return LINX_SDK_ERROR_UNKNOWN;
+    }
+    
+    return LINX_SDK_SUCCESS;
+}
+
+LinxSdkError linx_sdk_add_async_mcp_tool(LinxSdk* sdk, const char* name, const char* description,
+                                         mcp_property_list_t* properties, mcp_tool_callback_t callback,
+                                         int max_concurrency, uint32_t timeout_ms) {
+    if (!sdk || !name || !description || !callback) {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
+    
+    if (!sdk->mcp_enabled || !sdk->mcp_server) {
+        return LINX_SDK_ERROR_NOT_INITIALIZED;
+    }
+    
+    if (!mcp_server_add_async_tool(sdk->mcp_server, name, description, properties, callback,
+                                   max_concurrency, timeout_ms)) {
+        return LINX_SDK_ERROR_UNKNOWN;
+    }
+    
+    return LINX_SDK_SUCCESS;
+}
+
+LinxSdkError linx_sdk_add_mcp_tool_with_args(LinxSdk* sdk, const char* name, const char* description,
+                                             mcp_property_list_t* properties, mcp_tool_args_callback_t callback) {
+    if (!sdk || !name || !description || !callback) {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
+    
+    if (!sdk->mcp_enabled || !sdk->mcp_server) {
+        return LINX_SDK_ERROR_NOT_INITIALIZED;
+    }
+    
+    if (!mcp_server_add_tool_with_args(sdk->mcp_server, name, description, properties, callback)) {
+        return LINX_SDK_ERROR_UNKNOWN;
+    }
+    
+    return LINX_SDK_SUCCESS;
+}
+
+LinxSdkError linx_sdk_add_static_mcp_tools(LinxSdk* sdk, mcp_tool_t* const* tools, size_t count) {
+    if (!sdk || !tools) {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
+    
+    if (!sdk->mcp_enabled || !sdk->mcp_server) {
+        return LINX_SDK_ERROR_NOT_INITIALIZED;
+    }
+    
+    if (!mcp_server_add_static_tools(sdk->mcp_server, tools, count)) {
+        return LINX_SDK_ERROR_UNKNOWN;
+    }
+    
+    return LINX_SDK_SUCCESS;
+}
+
+LinxSdkError linx_sdk_remove_mcp_tool(LinxSdk* sdk, const char* name) {
+    if (!sdk || !name) {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
+    
+    if (!sdk->mcp_enabled || !sdk->mcp_server) {
+        return LINX_SDK_ERROR_NOT_INITIALIZED;
+    }
+    
+    if (!mcp_server_remove_tool(sdk->mcp_server, name)) {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
+    
+    return LINX_SDK_SUCCESS;
+}
+
+LinxSdkError linx_sdk_publish_mcp_state(LinxSdk* sdk, const char* resource, const cJSON* state) {
+    if (!sdk || !resource) {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
+    
+    if (!sdk->mcp_enabled || !sdk->mcp_server) {
+        return LINX_SDK_ERROR_NOT_INITIALIZED;
+    }
+    
+    if (!mcp_server_publish_state(sdk->mcp_server, resource, state)) {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
+    
+    return LINX_SDK_SUCCESS;
+}
+
+LinxSdkError linx_sdk_bind_local_command(LinxSdk* sdk, const char* command, const char* tool_name,
+                                         const char* arguments_json) {
+    if (!sdk || !command || !tool_name || command[0] == '\0' || tool_name[0] == '\0') {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
+    
+    if (!sdk->mcp_enabled || !sdk->mcp_server) {
+        return LINX_SDK_ERROR_NOT_INITIALIZED;
+    }
+    
+    LinxSdkLocalCommand binding;
+    memset(&binding, 0, sizeof(binding));
+    if (strlen(command) >= sizeof(binding.command) || strlen(tool_name) >= sizeof(binding.tool) ||
+        (arguments_json && strlen(arguments_json) >= sizeof(binding.arguments))) {
+        LOG_ERROR("本地命令 %s 的名称或参数过长", command);
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
+    if (arguments_json) {
+        // 绑定时校验一次，执行时不会因为参数格式失败
+        cJSON* arguments = cJSON_Parse(arguments_json);
+        bool valid = cJSON_IsObject(arguments);
+        cJSON_Delete(arguments);
+        if (!valid) {
+            LOG_ERROR("本地命令 %s 的参数不是 JSON 对象", command);
+            return LINX_SDK_ERROR_INVALID_PARAM;
+        }
+        strcpy(binding.arguments, arguments_json);
+    }
+    strcpy(binding.command, command);
+    strcpy(binding.tool, tool_name);
+    
+    LinxSdkError result = LINX_SDK_SUCCESS;
+    pthread_mutex_lock(&sdk->state_mutex);
+    size_t index = 0;
+    while (index < sdk->local_command_count && strcmp(sdk->local_commands[index].command, command) != 0) {
+        index++;
+    }
+    if (index == LINX_SDK_MAX_LOCAL_COMMANDS) {
+        result = LINX_SDK_ERROR_INVALID_PARAM;
+    } else {
+        sdk->local_commands[index] = binding;
+        if (index == sdk->local_command_count) {
+            sdk->local_command_count++;
+        }
+    }
+    pthread_mutex_unlock(&sdk->state_mutex);
+    
+    if (result != LINX_SDK_SUCCESS) {
+        LOG_ERROR("本地命令绑定已满（%d 条）", LINX_SDK_MAX_LOCAL_COMMANDS);
+    }
+    return result;
+}
+
+LinxSdkError linx_sdk_run_local_command(LinxSdk* sdk, const char* command) {
+    if (!sdk || !command) {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
+    
+    if (!sdk->mcp_enabled || !sdk->mcp_server) {
+        return LINX_SDK_ERROR_NOT_INITIALIZED;
+    }
+    
+    // 复制绑定后在锁外调用工具，工具回调中可以再调用SDK
+    LinxSdkLocalCommand binding;
+    bool found = false;
+    pthread_mutex_lock(&sdk->state_mutex);
+    for (size_t i = 0; i < sdk->local_command_count; i++) {
+        if (strcmp(sdk->local_commands[i].command, command) == 0) {
+            binding = sdk->local_commands[i];
+            found = true;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&sdk->state_mutex);
+    if (!found) {
+        LOG_WARN("本地命令 %s 没有绑定工具", command);
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
+    
+    uint64_t start_us = linx_os_now_us();
+    cJSON* arguments = binding.arguments[0] != '\0' ? cJSON_Parse(binding.arguments) : NULL;
+    bool ok = mcp_server_call_tool_local(sdk->mcp_server, binding.tool, arguments, command, NULL);
+    cJSON_Delete(arguments);
+    LOG_INFO("本地命令 %s -> %s %s，耗时 %u us", command, binding.tool, ok ? "完成" : "失败",
+             (unsigned)(linx_os_now_us() - start_us));
+    
+    // 会话中立即告知服务端，未连接时留到下次 initialize 之后
+    if (sdk->connected) {
+        mcp_server_flush_local_calls(sdk->mcp_server);
+    }
+    return ok ? LINX_SDK_SUCCESS : LINX_SDK_ERROR_UNKNOWN;
+}
+#else
+// 编译时裁剪了MCP：接口保留，参数检查后一律返回未初始化
+LinxSdkError linx_sdk_add_mcp_tool(LinxSdk* sdk, const char* name, const char* description,
+                                   mcp_property_list_t* properties, mcp_tool_callback_t callback) {
+    return !sdk || !name || !description ? LINX_SDK_ERROR_INVALID_PARAM : LINX_SDK_ERROR_NOT_INITIALIZED;
+}
+
+LinxSdkError linx_sdk_add_async_mcp_tool(LinxSdk* sdk, const char* name, const char* description,
+                                         mcp_property_list_t* properties, mcp_tool_callback_t callback,
+                                         int max_concurrency, uint32_t timeout_ms) {
+    return !sdk || !name || !description || !callback ? LINX_SDK_ERROR_INVALID_PARAM : LINX_SDK_ERROR_NOT_INITIALIZED;
+}
+
+LinxSdkError linx_sdk_add_mcp_tool_with_args(LinxSdk* sdk, const char* name, const char* description,
+                                             mcp_property_list_t* properties, mcp_tool_args_callback_t callback) {
+    return !sdk || !name || !description || !callback ? LINX_SDK_ERROR_INVALID_PARAM : LINX_SDK_ERROR_NOT_INITIALIZED;
+}
+
+LinxSdkError linx_sdk_add_static_mcp_tools(LinxSdk* sdk, mcp_tool_t* const* tools, size_t count) {
+    return !sdk || !tools ? LINX_SDK_ERROR_INVALID_PARAM : LINX_SDK_ERROR_NOT_INITIALIZED;
+}
+
+LinxSdkError linx_sdk_remove_mcp_tool(LinxSdk* sdk, const char* name) {
+    return !sdk || !name ? LINX_SDK_ERROR_INVALID_PARAM : LINX_SDK_ERROR_NOT_INITIALIZED;
+}
+
+LinxSdkError linx_sdk_publish_mcp_state(LinxSdk* sdk, const char* resource, const cJSON* state) {
+    return !sdk || !resource ? LINX_SDK_ERROR_INVALID_PARAM : LINX_SDK_ERROR_NOT_INITIALIZED;
+}
+
+LinxSdkError linx_sdk_bind_local_command(LinxSdk* sdk, const char* command, const char* tool_name,
+                                         const char* arguments_json) {
+    return !sdk || !command || !tool_name ? LINX_SDK_ERROR_INVALID_PARAM : LINX_SDK_ERROR_NOT_INITIALIZED;
+}
+
+LinxSdkError linx_sdk_run_local_command(LinxSdk* sdk, const char* command) {
+    return !sdk || !command ? LINX_SDK_ERROR_INVALID_PARAM : LINX_SDK_ERROR_NOT_INITIALIZED;
+}
+#endif
+
+LinxSdkError linx_sdk_register_message_handler(LinxSdk* sdk, const char* type,
+                                               linx_message_handler_t handler, void* user_data) {
+    if (!sdk || !type) {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
+    
+    if (!sdk->initialized || !sdk->msg_router) {
+        return LINX_SDK_ERROR_NOT_INITIALIZED;
+    }
+    
+    if (!handler) {
+        linx_message_router_unregister(sdk->msg_router, type);
+        return LINX_SDK_SUCCESS;
+    }
+    
+    if (linx_message_router_register(sdk->msg_router, type, handler, user_data) == LINX_MESSAGE_TYPE_INVALID) {
+        return LINX_SDK_ERROR_MEMORY;
+    }
+    
+    return LINX_SDK_SUCCESS;
+}
+
+// ============================================================================
+// OTA相关函数实现
+// ============================================================================
+
+LinxSdkError linx_sdk_ota_check_async(LinxSdk* sdk) {
+    return _linx_sdk_request_ota(sdk, LINX_SDK_OTA_REQUEST_CHECK, NULL, NULL, NULL);
+}
+
+LinxSdkError linx_sdk_ota_download_async(LinxSdk* sdk, const linx_ota_info_t* info, linx_ota_sink_t* sink) {
+    if (!info || !sink) {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
+    return _linx_sdk_request_ota(sdk, LINX_SDK_OTA_REQUEST_DOWNLOAD, info, sink, NULL);
+}
+
+LinxSdkError linx_sdk_ota_cancel(LinxSdk* sdk) {
+    return _linx_sdk_request_ota(sdk, LINX_SDK_OTA_REQUEST_CANCEL, NULL, NULL, NULL);
+}
+
+uint32_t linx_sdk_ota_quiet_delay_s(LinxSdk* sdk) {
+    if (!sdk) {
+        return 0;
+    }
+    uint32_t hours[24];
+    uint32_t total = 0;
+    for (int h = 0; h < 24; h++) {
+        hours[h] = __atomic_load_n(&sdk->ota_usage_hours[h], __ATOMIC_RELAXED);
+        total += hours[h];
+    }
+    if (total < LINX_SDK_OTA_USAGE_MIN_SESSIONS) {
+        return 0;
+    }
+    
+    time_t now = time(NULL);
+    struct tm local;
+    localtime_r(&now, &local);
+    for (int k = 0; k < 24; k++) {
+        int hour = (local.tm_hour + k) % 24;
+        // 不超过平均值的一半：hours * 24 <= total / 2
+        if (hours[hour] * 48 <= total) {
+            return k == 0 ? 0 : (uint32_t)(k * 3600 - local.tm_min * 60 - local.tm_sec);
+        }
+    }
+    return 0;
+}
+
+// ============================================================================
+// 异步操作句柄
+// ============================================================================
+
+/**
+ * @brief 完成句柄并释放SDK持有的引用
+ */
+static void _linx_sdk_finish_future(linx_future_t* future, int status, const void* data, size_t size) {
+    if (future) {
+        linx_future_complete(future, status, data, size);
+        linx_future_release(future);
+    }
+}
+
+/**
+ * @brief 取出连接句柄并完成
+ */
+static void _linx_sdk_finish_connect_future(LinxSdk* sdk, LinxSdkError error) {
+    pthread_mutex_lock(&sdk->state_mutex);
+    linx_future_t* future = sdk->connect_future;
+    sdk->connect_future = NULL;
+    pthread_mutex_unlock(&sdk->state_mutex);
+    _linx_sdk_finish_future(future, error, NULL, 0);
+}
+
+linx_future_t* linx_sdk_connect_future(LinxSdk* sdk) {
+    if (!sdk) {
+        return NULL;
+    }
+    linx_future_t* future = linx_future_create();
+    if (!future) {
+        return NULL;
+    }
+    
+    pthread_mutex_lock(&sdk->state_mutex);
+    if (sdk->connect_future) {
+        // 仍在连接：返回同一个句柄
+        linx_future_t* existing = linx_future_retain(sdk->connect_future);
+        pthread_mutex_unlock(&sdk->state_mutex);
+        linx_future_release(future);
+        return existing;
+    }
+    bool ready = sdk->session_ready;
+    if (!ready) {
+        sdk->connect_future = linx_future_retain(future);
+    }
+    pthread_mutex_unlock(&sdk->state_mutex);
+    
+    if (ready) {
+        linx_future_complete(future, LINX_SDK_SUCCESS, NULL, 0);
+        return future;
+    }
+    LinxSdkError error = linx_sdk_connect(sdk);
+    if (error != LINX_SDK_SUCCESS) {
+        _linx_sdk_finish_connect_future(sdk, error);
+    }
+    return future;
+}
+
+/**
+ * @brief 取消OTA句柄时取消底层操作
+ */
+static void _linx_sdk_ota_future_cancel(void* user_data, bool cancelled) {
+    if (cancelled) {
+        linx_sdk_ota_cancel((LinxSdk*)user_data);
+    }
+}
+
+static linx_future_t* _linx_sdk_ota_future(LinxSdk* sdk, LinxSdkOtaRequest request,
+                                           const linx_ota_info_t* info, linx_ota_sink_t* sink) {
+    linx_future_t* future = linx_future_create();
+    if (!future) {
+        return NULL;
+    }
+    // 请求带着一个引用交给事件线程，启动或完成时由事件线程释放
+    if (_linx_sdk_request_ota(sdk, request, info, sink, linx_future_retain(future)) != LINX_SDK_SUCCESS) {
+        linx_future_release(future);
+        linx_future_complete(future, LINX_OTA_ERROR_INIT, NULL, 0);
+        return future;
+    }
+    linx_future_set_canceller(future, _linx_sdk_ota_future_cancel, sdk);
+    return future;
+}
+
+linx_future_t* linx_sdk_ota_check_future(LinxSdk* sdk) {
+    if (!sdk) {
+        return NULL;
+    }
+    return _linx_sdk_ota_future(sdk, LINX_SDK_OTA_REQUEST_CHECK, NULL, NULL);
+}
+
+linx_future_t* linx_sdk_ota_download_future(LinxSdk* sdk, const linx_ota_info_t* info, linx_ota_sink_t* sink) {
+    if (!sdk || !info || !sink) {
+        return NULL;
     }
-    
-   
-    
-    free(json_string);
+    return _linx_sdk_ota_future(sdk, LINX_SDK_OTA_REQUEST_DOWNLOAD, info, sink);
 }
 
 /**
- * @brief WebSocket音频数据回调函数
- * 
- * 当接收到WebSocket音频数据包时，该回调函数会被调用。函数会处理音频数据
- * 并触发相应的TTS事件通知应用程序。
- * 
- * @param packet 指向音频数据包的指针，包含音频数据和大小信息
- * @param user_data 用户数据指针，应该指向LinxSdk实例
+ * @brief 提交OTA操作并唤醒事件线程
  * 
- * @note 该函数在WebSocket线程上下文中被调用
- * @note 如果packet或user_data为NULL，函数会安全返回
- * @note 音频数据的处理可以扩展为实际的音频播放功能
- * @note 接收到音频数据会触发LINX_EVENT_AUDIO_DATA事件
+ * OTA模块只能在轮询其管理器的线程中调用，因此请求先记录下来，
+ * 由事件线程在下一轮循环中启动。后提交的请求覆盖尚未启动的请求。
  * 
- * @see linx_audio_stream_packet_t
- * @see LINX_EVENT_AUDIO_DATA
- * @see LinxEvent
+ * @param sdk 指向LinxSdk实例的指针
+ * @param request 请求类型
+ * @param info 固件信息（仅下载请求）
+ * @param sink 下载目标（仅下载请求）
+ * @param future 请求的句柄（接管一个引用），可为NULL；出错时不接管
+ * @return LinxSdkError 错误码
  */
-static void _linx_sdk_on_websocket_audio_data(linx_audio_stream_packet_t* packet, void* user_data) {
-    //LOG_INFO("[%s] Audio packet: %d bytes", __FUNCTION__, packet->payload_size);
-    LinxSdk* sdk = (LinxSdk*)user_data;
-    if (!sdk || !packet) return;
-
-
-    LOG_DEBUG("收到音频数据: %zu 字节", packet->payload_size);
+static LinxSdkError _linx_sdk_request_ota(LinxSdk* sdk, LinxSdkOtaRequest request,
+                                          const linx_ota_info_t* info, linx_ota_sink_t* sink,
+                                          linx_future_t* future) {
+    if (!sdk) {
+        return LINX_SDK_ERROR_INVALID_PARAM;
+    }
     
-    // 这里可以处理音频数据，例如播放TTS音频
-    // 触发TTS相关事件
-    LinxEvent event = {
-        .type = LINX_EVENT_AUDIO_DATA,
-        .timestamp = time(NULL),
-        .data.audio_data.value = packet
-    };
+#if !LINX_ENABLE_OTA
+    // 编译时裁剪了OTA
+    (void)request;
+    (void)info;
+    (void)sink;
+    (void)future;
+    return LINX_SDK_ERROR_NOT_INITIALIZED;
+#else
+    if (!sdk->initialized || !sdk->event_thread_running || !sdk->ws_protocol || sdk->ws_stream || !sdk->config.ota) {
+        return LINX_SDK_ERROR_NOT_INITIALIZED;
+    }
     
-    if (sdk->event_callback) {
-        sdk->event_callback(&event, sdk->user_data);
+    pthread_mutex_lock(&sdk->state_mutex);
+    sdk->ota_request = request;
+    if (info) {
+        memcpy(&sdk->ota_info, info, sizeof(linx_ota_info_t));
     }
+    sdk->ota_sink = sink;
+    linx_future_t* replaced = sdk->ota_request_future;
+    sdk->ota_request_future = future;
+    pthread_mutex_unlock(&sdk->state_mutex);
+    
+    // 被覆盖的请求不会再启动
+    _linx_sdk_finish_future(replaced, LINX_OTA_ERROR_REQUEST, NULL, 0);
+    linx_websocket_wakeup(sdk->ws_protocol);
+    return LINX_SDK_SUCCESS;
+#endif
 }
 
 /**
- * @brief SDK事件处理线程函数
- * 
- * 这是SDK的主要事件处理线程，负责轮询WebSocket连接并处理网络事件。
- * 线程会持续运行直到SDK被销毁或明确停止。
- * 
- * @param arg 线程参数，应该指向LinxSdk实例
- * @return void* 线程返回值，总是返回NULL
+ * @brief 在事件线程中启动待处理的OTA操作并驱动OTA定时器
  * 
- * @note 该函数在独立的线程中运行
- * @note 线程会以10ms的间隔轮询WebSocket事件
- * @note 如果arg为NULL，线程会立即退出
- * @note 线程的运行状态由sdk->event_thread_running控制
- * @note 使用usleep避免过高的CPU占用
+ * OTA连接建立在WebSocket的 mongoose 管理器上，由同一个 mg_mgr_poll 驱动，
+ * 网络事件到达后立即处理，不再有独立的阻塞轮询循环。
  * 
- * @see linx_websocket_poll
- * @see LinxSdk::event_thread_running
+ * @param sdk 指向LinxSdk实例的指针
  */
-static void* _linx_sdk_event_thread(void* arg) {
-    LinxSdk* sdk = (LinxSdk*)arg;
-    if (!sdk) return NULL;
-    
-    while (sdk->event_thread_running) {
-        // 轮询WebSocket协议
-        if (sdk->ws_protocol) {
-            linx_websocket_poll(sdk->ws_protocol, 10);
+#if LINX_ENABLE_OTA
+/**
+ * @brief 记录一次开始对话（按本地时间的小时），计数过大时整体减半，近期的使用习惯权重更高
+ */
+static void _linx_sdk_ota_record_session(LinxSdk* sdk) {
+    time_t now = time(NULL);
+    struct tm local;
+    localtime_r(&now, &local);
+    uint16_t count = __atomic_add_fetch(&sdk->ota_usage_hours[local.tm_hour], 1, __ATOMIC_RELAXED);
+    if (count >= LINX_SDK_OTA_USAGE_DECAY_AT) {
+        for (int h = 0; h < 24; h++) {
+            uint16_t value = __atomic_load_n(&sdk->ota_usage_hours[h], __ATOMIC_RELAXED);
+            __atomic_store_n(&sdk->ota_usage_hours[h], (uint16_t)(value / 2), __ATOMIC_RELAXED);
         }
-        
-        // 短暂休眠避免CPU占用过高
-        usleep(10000); // 10ms
     }
-    
-    return NULL;
 }
 
-// 状态管理函数
 /**
- * @brief 设置SDK会话ID
- * 
- * 这是一个线程安全的内部函数，用于设置或清除SDK的会话ID。
- * 会话ID用于标识与服务器的特定会话连接。
- * 
- * @param sdk 指向LinxSdk实例的指针，不能为NULL
- * @param session_id 会话ID字符串，可以为NULL表示清除会话ID
+ * @brief 对话中让出OTA下载带宽：LISTENING/SPEAKING 时按 ota_session_rate 暂停或限速，空闲时恢复
  * 
- * @note 该函数是线程安全的，使用互斥锁保护会话ID的设置
- * @note 如果sdk为NULL，函数会安全返回
- * @note 会话ID会被动态分配内存存储
- * @note 设置会话ID的操作会被记录到日志中
+ * @param sdk 指向LinxSdk实例的指针
  * 
- * @see LinxSdk::session_id
- * @see LinxSdk::state_mutex
+ * @note 在事件线程中调用
  */
-static void _linx_sdk_set_session_id(LinxSdk* sdk, const char* session_id) {
-    if (!sdk) return;
-    
-    pthread_mutex_lock(&sdk->state_mutex);
-    
-    if (sdk->session_id) {
-        free(sdk->session_id);
-        sdk->session_id = NULL;
+static void _linx_sdk_ota_schedule(LinxSdk* sdk) {
+    LinxDeviceState state = linx_sdk_get_state(sdk);
+    bool busy = state == LINX_DEVICE_STATE_LISTENING || state == LINX_DEVICE_STATE_SPEAKING;
+    if (busy && !sdk->ota_session_busy) {
+        _linx_sdk_ota_record_session(sdk);
     }
+    sdk->ota_session_busy = busy;
     
-    if (session_id) {
-        sdk->session_id = strdup(session_id);
+    int32_t session_rate = sdk->config.ota_session_rate;
+    bool yield = busy && sdk->ota_active && session_rate >= 0;
+    if (yield == sdk->ota_yielding) {
+        return;
     }
     
-    pthread_mutex_unlock(&sdk->state_mutex);
-    
-    LOG_INFO("会话ID已设置: %s", session_id ? session_id : "(空)");
+    linx_ota_t* ota = sdk->config.ota;
+    if (yield) {
+        sdk->ota_idle_rate = linx_ota_get_max_download_rate(ota);
+        if (session_rate == 0) {
+            linx_ota_set_paused(ota, true);
+        } else if (sdk->ota_idle_rate == 0 || (uint32_t)session_rate < sdk->ota_idle_rate) {
+            linx_ota_set_max_download_rate(ota, (uint32_t)session_rate);
+        }
+        LOG_INFO("对话中，OTA下载%s", session_rate == 0 ? "暂停" : "限速");
+    } else {
+        linx_ota_set_paused(ota, false);
+        linx_ota_set_max_download_rate(ota, sdk->ota_idle_rate);
+        if (sdk->ota_active) {
+            LOG_INFO("对话结束，OTA下载恢复");
+        }
+    }
+    sdk->ota_yielding = yield;
 }
 
-/**
- * @brief 设置SDK监听状态
- * 
- * 这是一个线程安全的内部函数，用于设置或清除SDK的监听状态字符串。
- * 监听状态反映了当前语音监听的具体状态信息。
- * 
- * @param sdk 指向LinxSdk实例的指针，不能为NULL
- * @param state 监听状态字符串，可以为NULL表示清除状态
- * 
- * @note 该函数是线程安全的，使用互斥锁保护监听状态的设置
- * @note 如果sdk为NULL，函数会安全返回
- * @note 状态字符串会被动态分配内存存储
- * 
- * @see LinxSdk::listen_state
- * @see LinxSdk::state_mutex
- */
-static void _linx_sdk_set_listen_state(LinxSdk* sdk, const char* state) {
-    if (!sdk) return;
+static void _linx_sdk_service_ota(LinxSdk* sdk) {
+    LinxSdkOtaRequest request;
+    linx_ota_info_t info;
+    linx_ota_sink_t* sink;
+    linx_future_t* future = NULL;
     
     pthread_mutex_lock(&sdk->state_mutex);
+    request = sdk->ota_request;
+    if (request != LINX_SDK_OTA_REQUEST_CANCEL && __atomic_load_n(&sdk->boot_deferred, __ATOMIC_ACQUIRE)) {
+        // 快速启动：检查和下载留到第一轮对话结束后，取消立即执行
+        request = LINX_SDK_OTA_REQUEST_NONE;
+    } else {
+        sdk->ota_request = LINX_SDK_OTA_REQUEST_NONE;
+        future = sdk->ota_request_future;
+        sdk->ota_request_future = NULL;
+    }
+    if (request == LINX_SDK_OTA_REQUEST_DOWNLOAD) {
+        memcpy(&info, &sdk->ota_info, sizeof(linx_ota_info_t));
+    }
+    sink = sdk->ota_sink;
+    pthread_mutex_unlock(&sdk->state_mutex);
     
-    if (sdk->listen_state) {
-        free(sdk->listen_state);
-        sdk->listen_state = NULL;
+    if (sdk->config.ota) {
+        _linx_sdk_ota_schedule(sdk);
     }
     
-    if (state) {
-        sdk->listen_state = strdup(state);
+    struct mg_mgr* mgr = linx_websocket_get_mgr(sdk->ws_protocol);
+    linx_ota_status_t status = LINX_OTA_SUCCESS;
+    LinxEventType failed_event = LINX_EVENT_OTA_CHECKED;
+    
+    switch (request) {
+        case LINX_SDK_OTA_REQUEST_CHECK:
+            status = linx_ota_check_update_async(sdk->config.ota, mgr, _linx_sdk_on_ota_event, sdk);
+            failed_event = LINX_EVENT_OTA_CHECKED;
+            break;
+        case LINX_SDK_OTA_REQUEST_DOWNLOAD:
+            status = linx_ota_download_to_sink_async(sdk->config.ota, mgr, &info, sink, _linx_sdk_on_ota_event, sdk);
+            failed_event = LINX_EVENT_OTA_COMPLETED;
+            break;
+        case LINX_SDK_OTA_REQUEST_CANCEL:
+            _linx_sdk_cancel_ota_task(sdk);
+            break;
+        default:
+            break;
     }
     
-    pthread_mutex_unlock(&sdk->state_mutex);
+    if (request == LINX_SDK_OTA_REQUEST_CHECK || request == LINX_SDK_OTA_REQUEST_DOWNLOAD) {
+        if (status == LINX_OTA_SUCCESS) {
+            sdk->ota_active = true;
+            _linx_sdk_finish_future(sdk->ota_future, LINX_OTA_ERROR_REQUEST, NULL, 0);
+            sdk->ota_future = future;
+            future = NULL;
+        } else {
+            LOG_WARN("OTA操作启动失败: %s", linx_ota_status_str(status));
+            _linx_sdk_finish_future(future, status, NULL, 0);
+            future = NULL;
+            LinxEvent event = {
+                .type = failed_event,
+                .timestamp = time(NULL),
+                .data.ota.status = status,
+                .data.ota.percentage = -1
+            };
+            _linx_sdk_emit_event(sdk, &event);
+        }
+    }
+    
+    if (sdk->ota_active) {
+        linx_ota_poll(sdk->config.ota);
+    }
 }
 
 /**
- * @brief 设置SDK TTS状态
- * 
- * 这是一个线程安全的内部函数，用于设置或清除SDK的TTS（文本转语音）状态字符串。
- * TTS状态反映了当前语音合成和播放的具体状态信息。
+ * @brief OTA模块事件回调，转换为SDK事件
  * 
- * @param sdk 指向LinxSdk实例的指针，不能为NULL
- * @param state TTS状态字符串，可以为NULL表示清除状态
- * 
- * @note 该函数是线程安全的，使用互斥锁保护TTS状态的设置
- * @note 如果sdk为NULL，函数会安全返回
- * @note 状态字符串会被动态分配内存存储
- * 
- * @see LinxSdk::tts_state
- * @see LinxSdk::state_mutex
+ * @param ota_event OTA事件
+ * @param user_data 指向LinxSdk实例的指针
  */
-static void _linx_sdk_set_tts_state(LinxSdk* sdk, const char* state) {
-    if (!sdk) return;
+/**
+ * @brief 音频线程周期超时的监听者，在巡检线程上调用
+ */
+static void _linx_sdk_on_deadline(void* user_data, const linx_deadline_snapshot_t* snapshot) {
+    LinxSdk* sdk = (LinxSdk*)user_data;
     
-    pthread_mutex_lock(&sdk->state_mutex);
+    if (snapshot->misses > 0) {
+        linx_metrics_add(&sdk->metrics, LINX_METRIC_DEADLINE_MISSES, snapshot->misses);
+        linx_metrics_record(&sdk->metrics, LINX_METRIC_DEADLINE_OVERRUN, snapshot->late_us);
+    }
+    
+    char summary[320];
+    linx_deadline_snapshot_format(snapshot, summary, sizeof(summary));
+    LOG_WARN_EVERY_MS(1000, "音频周期超时: %s", summary);
     
-    if (sdk->tts_state) {
-        free(sdk->tts_state);
-        sdk->tts_state = NULL;
+    LinxEvent event = {0};
+    event.type = LINX_EVENT_AUDIO_DEADLINE_MISSED;
+    event.timestamp = time(NULL);
+    event.data.audio_deadline.summary = summary;
+    event.data.audio_deadline.late_us = snapshot->late_us;
+    event.data.audio_deadline.period_us = snapshot->period_us;
+    event.data.audio_deadline.misses = snapshot->misses;
+    event.data.audio_deadline.stalled = snapshot->stalled;
+    _linx_sdk_emit_event(sdk, &event);
+}
+
+static void _linx_sdk_on_ota_event(const linx_ota_event_t* ota_event, void* user_data) {
+    LinxSdk* sdk = (LinxSdk*)user_data;
+    if (!sdk || !ota_event) {
+        return;
     }
     
-    if (state) {
-        sdk->tts_state = strdup(state);
+    LinxEvent event = {
+        .timestamp = time(NULL),
+        .data.ota.status = ota_event->status,
+        .data.ota.info = ota_event->info,
+        .data.ota.received = ota_event->received,
+        .data.ota.total = ota_event->total,
+        .data.ota.percentage = ota_event->percentage
+    };
+    
+    switch (ota_event->type) {
+        case LINX_OTA_EVENT_CHECK_DONE:
+            sdk->ota_active = false;
+            event.type = LINX_EVENT_OTA_CHECKED;
+            _linx_sdk_session_cache_on_ota(sdk, ota_event);
+            _linx_sdk_endpoints_on_ota(sdk, ota_event);
+            break;
+        case LINX_OTA_EVENT_PROGRESS:
+            event.type = LINX_EVENT_OTA_PROGRESS;
+            break;
+        case LINX_OTA_EVENT_DOWNLOAD_DONE:
+            sdk->ota_active = false;
+            event.type = LINX_EVENT_OTA_COMPLETED;
+            break;
+        default:
+            return;
     }
     
-    pthread_mutex_unlock(&sdk->state_mutex);
+    _linx_sdk_emit_event(sdk, &event);
+    
+    if (!sdk->ota_active && sdk->ota_future) {
+        linx_future_t* future = sdk->ota_future;
+        sdk->ota_future = NULL;
+        bool has_info = ota_event->type == LINX_OTA_EVENT_CHECK_DONE && ota_event->status == LINX_OTA_SUCCESS &&
+                        ota_event->info;
+        _linx_sdk_finish_future(future, ota_event->status, has_info ? ota_event->info : NULL,
+                                has_info ? sizeof(linx_ota_info_t) : 0);
+    }
 }
-
-// 预留的监听控制函数接口，待后续实现
+#else
+static void _linx_sdk_service_ota(LinxSdk* sdk) {
+    (void)sdk;
+}
+#endif
 
 /**
- * @brief MCP消息发送回调函数
- * 
- * 这是一个内部回调函数，用于处理从MCP（Model Context Protocol）
- * 服务器需要发送的消息。由于回调函数签名的限制，无法直接获取SDK实例，
- * 实际实现中可能需要使用全局变量或其他方式来访问SDK上下文。
- * 
- * @param message MCP消息字符串，可能为NULL
- * 
- * @note 该函数在MCP服务器的上下文中被调用
- * @note 如果message为NULL，函数会安全返回
- * @note 接收到的MCP消息会被记录到调试日志中
- * @note 由于回调函数签名限制，暂时无法获取SDK实例进行实际发送
- * @note 实际实现中可能需要重新设计回调机制以支持SDK上下文传递
- * 
- * @see mcp_server_set_send_callback
- * @see LOG_DEBUG
+ * @brief WebSocket 空闲上行回调：取出一批日志生成 "log" 消息（事件线程）
  */
-static void _linx_sdk_mcp_send_callback(const char* message) {
-    // 这里需要获取sdk实例，但由于回调函数签名限制，暂时留空
-    // 实际实现中可能需要使用全局变量或其他方式
-    if (message) {
-        // 发送MCP消息的逻辑
-        LOG_DEBUG("收到MCP消息: %s", message);
+static size_t _linx_sdk_next_log_message(void* user_data, char* buffer, size_t size) {
+    LinxSdk* sdk = (LinxSdk*)user_data;
+    char session_id[128] = {0};
+    
+    pthread_mutex_lock(&sdk->state_mutex);
+    if (sdk->session_id) {
+        strncpy(session_id, sdk->session_id, sizeof(session_id) - 1);
     }
+    pthread_mutex_unlock(&sdk->state_mutex);
+    
+    return log_upload_next_message(sdk->log_upload, session_id[0] ? session_id : NULL, buffer, size);
 }
 
 // ============================================================================
-// WebSocket相关函数实现
+// 事件处理函数实现
 // ============================================================================
 
-LinxSdkError linx_sdk_abort_speaking(LinxSdk* sdk, linx_abort_reason_t reason) {
+LinxSdkError linx_sdk_poll_events(LinxSdk* sdk, int timeout_ms) {
     if (!sdk) {
         return LINX_SDK_ERROR_INVALID_PARAM;
     }
     
-    if (!sdk->connected || !sdk->ws_protocol) {
-        return LINX_SDK_ERROR_NETWORK;
+    if (!sdk->initialized) {
+        return LINX_SDK_ERROR_NOT_INITIALIZED;
     }
     
-    linx_protocol_send_abort_speaking((linx_protocol_t*)sdk->ws_protocol, reason);
-    
-    return LINX_SDK_SUCCESS;
-}
-
-LinxSdkError linx_sdk_send_wake_word(LinxSdk* sdk, const char* wake_word) {
-    if (!sdk || !wake_word) {
-        return LINX_SDK_ERROR_INVALID_PARAM;
+    // 外部循环：在调用线程上完成事件线程的一次迭代，之后派发本次产生的事件
+    if (sdk->config.event_loop_mode == LINX_EVENT_LOOP_EXTERNAL && !sdk->config.reactor) {
+        if (sdk->event_thread_running && sdk->ws_protocol && !sdk->ws_stream) {
+            _linx_sdk_run_loop_once(sdk, timeout_ms);
+            timeout_ms = 0;
+        } else if (timeout_ms != 0) {
+            // 未连接时没有可等待的描述符，最多等待空闲超时，避免应用循环空转或永久阻塞
+            if (timeout_ms < 0 || timeout_ms > LINX_SDK_EVENT_LOOP_IDLE_TIMEOUT_MS) {
+                timeout_ms = LINX_SDK_EVENT_LOOP_IDLE_TIMEOUT_MS;
+            }
+            if (!sdk->event_queue) {
+                linx_os_sleep_ms((unsigned int)timeout_ms);
+            }
+        }
     }
     
-    if (!sdk->connected || !sdk->ws_protocol) {
-        return LINX_SDK_ERROR_NETWORK;
+    // 只有 POLL 派发方式由调用线程取事件，其他方式下事件由网络线程或派发线程处理
+    if (sdk->config.event_delivery != LINX_EVENT_DELIVERY_POLL || !sdk->event_queue) {
+        return LINX_SDK_SUCCESS;
     }
     
-    linx_protocol_send_wake_word_detected((linx_protocol_t*)sdk->ws_protocol, wake_word);
+    // 第一个事件最多等待 timeout_ms，之后把已排队的事件全部派发
+    LinxEvent* event = linx_event_queue_pop(sdk->event_queue, timeout_ms);
+    while (event) {
+        _linx_sdk_dispatch_event(sdk, event);
+        event = linx_event_queue_pop(sdk->event_queue, 0);
+    }
     
     return LINX_SDK_SUCCESS;
 }
 
-const char* linx_sdk_get_session_id(LinxSdk* sdk) {
+size_t linx_sdk_get_poll_fds(LinxSdk* sdk, LinxPollFd* fds, size_t max_fds) {
+    if (!sdk || sdk->config.event_loop_mode != LINX_EVENT_LOOP_EXTERNAL || sdk->config.reactor ||
+        !sdk->event_thread_running || sdk->ws_stream) {
+        return 0;
+    }
+    return linx_websocket_get_poll_fds(sdk->ws_protocol, fds, max_fds);
+}
+
+int linx_sdk_get_poll_timeout_ms(LinxSdk* sdk) {
     if (!sdk) {
+        return LINX_SDK_EVENT_LOOP_IDLE_TIMEOUT_MS;
+    }
+    return linx_websocket_get_poll_timeout_ms(sdk->ws_protocol, _linx_sdk_loop_timeout_ms(sdk));
+}
+
+LinxEvent* linx_sdk_event_retain(LinxSdk* sdk, const LinxEvent* event) {
+    if (!sdk || !event) {
         return NULL;
     }
     
-    return sdk->session_id;
+    // 批次只在回调期间有效，数据包需逐个保留
+    if (event->type == LINX_EVENT_AUDIO_BATCH) {
+        return NULL;
+    }
+    
+    // 队列事件只加引用，同步回调的事件复制一份
+    if (event->owner) {
+        return linx_event_retain((LinxEvent*)event);
+    }
+    return linx_event_copy(sdk->event_queue, event, linx_websocket_get_packet_pool(sdk->ws_protocol));
 }
 
-// ============================================================================
-// MCP相关函数实现
-// ============================================================================
+void linx_sdk_event_release(LinxEvent* event) {
+    linx_event_release(event);
+}
 
-LinxSdkError linx_sdk_add_mcp_tool(LinxSdk* sdk, const char* name, const char* description,
-                                   mcp_property_list_t* properties, mcp_tool_callback_t callback) {
-    if (!sdk || !name || !description) {
-        return LINX_SDK_ERROR_INVALID_PARAM;
+/**
+ * @brief 调用事件回调并释放队列事件
+ * 
+ * @param sdk 指向LinxSdk实例的指针
+ * @param event 从队列取出的事件（调用方持有的引用在此释放）
+ */
+static void _linx_sdk_dispatch_event(LinxSdk* sdk, LinxEvent* event) {
+    LinxEventCallback callback = sdk->event_callback;
+    
+    // 已排队的连续音频事件合成一个批次回调
+    if (event->type == LINX_EVENT_AUDIO_DATA && (sdk->config.event_coalesce & LINX_EVENT_COALESCE_AUDIO)) {
+        LinxEvent* events[LINX_SDK_AUDIO_BATCH_MAX];
+        linx_audio_stream_packet_t* packets[LINX_SDK_AUDIO_BATCH_MAX];
+        size_t count = 0;
+        events[count++] = event;
+        while (count < LINX_SDK_AUDIO_BATCH_MAX) {
+            LinxEvent* next = linx_event_queue_pop_type(sdk->event_queue, LINX_EVENT_AUDIO_DATA);
+            if (!next) {
+                break;
+            }
+            events[count++] = next;
+        }
+        
+        size_t packet_count = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (events[i]->data.audio_data.value) {
+                packets[packet_count++] = events[i]->data.audio_data.value;
+            }
+        }
+        if (callback && packet_count > 0) {
+            LinxEvent batch = {0};
+            batch.type = LINX_EVENT_AUDIO_BATCH;
+            batch.timestamp = events[count - 1]->timestamp;
+            batch.data.audio_batch.packets = packets;
+            batch.data.audio_batch.count = packet_count;
+            callback(&batch, sdk->user_data);
+        }
+        for (size_t i = 0; i < count; i++) {
+            linx_event_release(events[i]);
+        }
+        return;
     }
     
-    if (!sdk->mcp_enabled || !sdk->mcp_server) {
-        return LINX_SDK_ERROR_NOT_INITIALIZED;
+    if (sdk->text_history && linx_event_history_accepts(event->type)) {
+        linx_event_history_keep(sdk->text_history, event);
     }
-   // 添加MCP工具
-    if (!mcp_server_add_simple_tool(sdk->mcp_server, name, description, properties, callback)) {
-        return LINX_SDK_ERROR_UNKNOWN;
+    if (callback) {
+        callback(event, sdk->user_data);
     }
-    
-    return LINX_SDK_SUCCESS;
+    linx_event_release(event);
 }
 
-// ============================================================================
-// 事件处理函数实现
-// ============================================================================
+/**
+ * @brief 事件派发线程：取出队列中的事件并调用事件回调
+ * 
+ * @param arg 指向LinxSdk实例的指针
+ */
+static void* _linx_sdk_dispatch_thread(void* arg) {
+    LinxSdk* sdk = (LinxSdk*)arg;
+    linx_thread_stats_register("sdk_dispatch", LINX_THREAD_STAGE_DISPATCH);
+    
+    while (__atomic_load_n(&sdk->dispatch_thread_running, __ATOMIC_ACQUIRE)) {
+        LinxEvent* event = linx_event_queue_pop(sdk->event_queue, -1);
+        if (event) {
+            _linx_sdk_dispatch_event(sdk, event);
+        }
+    }
+    linx_thread_stats_unregister();
+    return NULL;
+}
 
-LinxSdkError linx_sdk_poll_events(LinxSdk* sdk, int timeout_ms) {
-    if (!sdk) {
-        return LINX_SDK_ERROR_INVALID_PARAM;
+/**
+ * @brief 创建事件队列，THREAD 派发方式下同时启动派发线程
+ * 
+ * @param sdk 指向LinxSdk实例的指针
+ * @return 成功返回 true
+ */
+static bool _linx_sdk_start_event_queue(LinxSdk* sdk) {
+    sdk->event_queue = linx_event_queue_create(sdk->config.event_queue_audio_depth);
+    if (!sdk->event_queue) {
+        return false;
+    }
+    
+    // 零分配检查要求下行音频事件入队不再分配节点
+    if (sdk->config.zero_alloc_assert) {
+        linx_event_queue_reserve(sdk->event_queue, 0);
     }
     
-    // 在事件线程模式下，这个函数不需要做任何事情
-    // 事件处理由专门的线程负责
-    (void)timeout_ms; // 避免未使用参数警告
+    if (sdk->config.event_coalesce & LINX_EVENT_COALESCE_STATE) {
+        linx_event_queue_set_merge_state(sdk->event_queue, true);
+    }
     
-    return LINX_SDK_SUCCESS;
+    if (sdk->config.event_delivery != LINX_EVENT_DELIVERY_THREAD) {
+        return true;
+    }
+    
+    const linx_thread_attr_t defaults = {
+        .name = "sdk_dispatch",
+        .stack_size = sdk->config.event_dispatch_stack_size,
+        .priority = LINX_THREAD_PRIORITY_NORMAL,
+        .core_mask = LINX_THREAD_NET_CORE_MASK
+    };
+    linx_thread_attr_t attr = linx_thread_attr_merge(&sdk->config.dispatch_thread_attr, &defaults);
+    
+    sdk->dispatch_thread_running = true;
+    sdk->dispatch_thread = linx_thread_create(&attr, _linx_sdk_dispatch_thread, sdk);
+    if (!sdk->dispatch_thread) {
+        sdk->dispatch_thread_running = false;
+        linx_event_queue_destroy(sdk->event_queue);
+        sdk->event_queue = NULL;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 停止派发线程并销毁事件队列，尚未派发的事件直接丢弃
+ * 
+ * @param sdk 指向LinxSdk实例的指针
+ */
+static void _linx_sdk_stop_event_queue(LinxSdk* sdk) {
+    if (sdk->dispatch_thread_running) {
+        __atomic_store_n(&sdk->dispatch_thread_running, false, __ATOMIC_RELEASE);
+        linx_event_queue_wakeup(sdk->event_queue);
+        linx_thread_join(sdk->dispatch_thread);
+        sdk->dispatch_thread = NULL;
+    }
+    
+    linx_event_queue_destroy(sdk->event_queue);
+    sdk->event_queue = NULL;
 }
\ No newline at end of file
@@ -19,8 +19,31 @@
 
 // 引入相关模块
 
+#include "linx_config.h"
+#include "os/linx_os.h"
 #include "protocols/linx_websocket.h"
+#include "protocols/linx_endpoints.h"
+#include "protocols/linx_message_router.h"
 #include "mcp/mcp_server.h"
+#include "codecs/opus_frame_bundler.h"
+#include "codecs/opus_rate_controller.h"
+#include "codecs/encoded_frame_buffer.h"
+#include "codecs/codec_factory.h"
+#include "ota/linx_ota.h"
+#include "play/linx_player.h"
+#include "audio/audio_ns.h"
+#include "audio/audio_agc.h"
+#include "log/linx_log_upload.h"
+#include "log/linx_alloc.h"
+#include "log/linx_mem_pressure.h"
+#include "linx_metrics.h"
+#include "linx_governor.h"
+#include "linx_trace.h"
+#include "linx_tts_cache.h"
+#include "linx_session_cache.h"
+#include "linx_crypto.h"
+#include "linx_executor.h"
+#include "linx_future.h"
 #include "cjson/cJSON.h"
 
 #ifdef __cplusplus
@@ -57,23 +80,280 @@ typedef enum {
     LINX_DEVICE_STATE_ERROR
 } LinxDeviceState;
 
+/**
+ * @brief 语音监听状态
+ */
+typedef enum {
+    LINX_LISTEN_STATE_NONE = 0,     ///< 会话尚未开始监听（未连接、hello 未完成）
+    LINX_LISTEN_STATE_STARTED,      ///< 已发送 listen start
+    LINX_LISTEN_STATE_STOPPED       ///< 已发送 listen stop（非实时模式下 TTS 播放期间）
+} LinxListenState;
+
+/**
+ * @brief TTS状态
+ */
+typedef enum {
+    LINX_TTS_STATE_NONE = 0,        ///< 本次连接尚未收到 tts 消息
+    LINX_TTS_STATE_STARTED,         ///< 收到 tts start，正在下发语音
+    LINX_TTS_STATE_STOPPED          ///< 收到 tts stop
+} LinxTtsState;
+
+/**
+ * @brief 事件循环模式
+ */
+typedef enum {
+    LINX_EVENT_LOOP_EVENT_DRIVEN = 0,   ///< 事件驱动：阻塞在 mg_mgr_poll 中，直到有 socket 活动或被唤醒（默认）
+    LINX_EVENT_LOOP_POLLING,            ///< 定时轮询：每 10ms 轮询一次（兼容旧行为）
+    LINX_EVENT_LOOP_EXTERNAL            ///< 外部循环：SDK不创建任何线程，由应用循环调用 linx_sdk_poll_events()
+} LinxEventLoopMode;
+
+/**
+ * @brief 外部循环需要监听的文件描述符（见 linx_sdk_get_poll_fds()）
+ */
+typedef linx_websocket_poll_fd_t LinxPollFd;
+
+/**
+ * @brief 回放统计（见 linx_sdk_get_replay_stats()）
+ */
+typedef linx_websocket_replay_stats_t LinxReplayStats;
+
+/**
+ * @brief 下行流控统计（见 linx_sdk_get_flow_stats()）
+ */
+typedef linx_websocket_flow_stats_t LinxFlowStats;
+
+/**
+ * @brief hello 协商结果（见 linx_sdk_get_session_params()）
+ */
+typedef linx_websocket_session_params_t LinxSessionParams;
+
+/**
+ * @brief 事件派发方式
+ */
+typedef enum {
+    LINX_EVENT_DELIVERY_CALLBACK = 0,   ///< 在网络线程上同步调用事件回调，事件中的指针只在回调期间有效（默认）
+    LINX_EVENT_DELIVERY_POLL,           ///< 事件复制后入队，由应用线程调用 linx_sdk_poll_events() 派发
+    LINX_EVENT_DELIVERY_THREAD          ///< 事件复制后入队，由SDK的派发线程调用事件回调
+} LinxEventDelivery;
+
+/**
+ * @brief 事件合并选项（LinxSdkConfig.event_coalesce，可组合）
+ */
+typedef enum {
+    LINX_EVENT_COALESCE_AUDIO = 1 << 0, ///< 连续的音频数据事件合成一个 LINX_EVENT_AUDIO_BATCH：同步回调时按事件循环的一次迭代，
+                                        ///< 队列派发时按一次取出时已排队的事件；其他事件到来前先送出已攒的批次，顺序不变
+    LINX_EVENT_COALESCE_STATE = 1 << 1  ///< 队列中尚未派发的状态改变事件与新的合并为一个（old_state 取最早的），合并后状态未变则一起丢弃
+} LinxEventCoalesce;
+
+/** 一个音频批次事件最多包含的数据包数 */
+#define LINX_SDK_AUDIO_BATCH_MAX 16
+
+/**
+ * @brief 低功耗回调（见 linx_sdk_enter_sleep()、linx_sdk_exit_sleep()），在调用这两个函数的线程上执行
+ */
+typedef struct {
+    void (*on_sleep)(void* user_data);  ///< 连接已断开、播放器已停止：停止采集流水线和音频设备，之后可以进入深度睡眠
+    void (*on_wake)(void* user_data);   ///< 连接已发起：启动音频设备和采集流水线，与建立连接同时进行
+    void* user_data;
+} LinxSdkPowerHooks;
+
+/**
+ * @brief 事件驱动模式下无任何活动时的最长阻塞时间(毫秒)
+ */
+#define LINX_SDK_EVENT_LOOP_IDLE_TIMEOUT_MS 1000
+
+/**
+ * @brief TTS 句子缓存回放时保持在播放器中的提前量(毫秒)；回放期间事件循环每隔其 1/12 (20ms) 补一次包
+ */
+#define LINX_SDK_TTS_REPLAY_LEAD_MS 240
+
+/**
+ * @brief 空闲时段预测（linx_sdk_ota_quiet_delay_s()）至少需要的对话次数；某个小时的计数达到
+ *        LINX_SDK_OTA_USAGE_DECAY_AT 时全部减半
+ */
+#ifndef LINX_SDK_OTA_USAGE_MIN_SESSIONS
+#define LINX_SDK_OTA_USAGE_MIN_SESSIONS 24
+#endif
+#ifndef LINX_SDK_OTA_USAGE_DECAY_AT
+#define LINX_SDK_OTA_USAGE_DECAY_AT 64
+#endif
+
+/**
+ * @brief 探测备选服务器 RTT 的默认间隔(毫秒)
+ */
+#ifndef LINX_SDK_DEFAULT_ENDPOINT_PROBE_MS
+#define LINX_SDK_DEFAULT_ENDPOINT_PROBE_MS 60000
+#endif
+
+/**
+ * @brief 本地命令绑定数上限（linx_sdk_bind_local_command()）
+ */
+#ifndef LINX_SDK_MAX_LOCAL_COMMANDS
+#define LINX_SDK_MAX_LOCAL_COMMANDS 8
+#endif
+
+
 /**
  * @brief SDK配置结构体
  */
 typedef struct {
     // 基础配置
     char server_url[256];           ///< 服务器URL
+    char server_urls[512];          ///< 其他地域的备选服务器，逗号分隔；与 server_url 一起按连接健康度选择、断线时切换
+                                    ///< (见 protocols/linx_endpoints.h)，OTA 检查给出 websocket.urls 时替换为服务端的列表
+    int32_t endpoint_probe_ms;      ///< 有备选服务器时，测量各服务器 RTT 的间隔(毫秒)，0 为默认值 60000，<0 不探测
     uint32_t sample_rate;           ///< 采样率 (默认16000)
     uint16_t channels;              ///< 声道数 (默认1)
+    char audio_format[16];          ///< 音频格式 "opus"/"pcm"/"pcmu"/"pcma"/"adpcm" (默认 "opus")，见 codec_factory.h
+    char audio_formats[64];         ///< hello 中按优先级提供的候选格式，逗号分隔，如 "opus,adpcm"；空为只提供 audio_format
+    uint8_t codec_max_cost;         ///< 板子的编解码算力上限 codec_cost_t，0 不限；设置后 audio_format 超出时换成上限内的格式，audio_formats 为空时按编解码器注册表生成候选格式
     uint32_t timeout_ms;            ///< 超时时间(毫秒)
     
     // WebSocket连接配置
     char auth_token[256];           ///< 认证令牌
     char device_id[64];             ///< 设备ID
     char client_id[64];             ///< 客户端ID
-    uint32_t protocol_version;      ///< 协议版本
+    uint32_t protocol_version;      ///< 协议版本：1 无帧头，2/3 带帧头，4 带帧序号和时间戳；服务端 hello 可降低
+    
+    // 自动重连 (按带抖动的指数退避重连，服务端支持时恢复原会话)
+    bool auto_reconnect;            ///< 连接断开后自动重连，重连期间设备状态为 CONNECTING
+    uint32_t reconnect_base_ms;     ///< 最小重连延迟(毫秒) (默认 500)
+    uint32_t reconnect_max_ms;      ///< 最大重连延迟(毫秒) (默认 30000)
+    uint32_t reconnect_max_attempts; ///< 连续重连次数上限，0 为不限；用尽后状态为 DISCONNECTED
+    
+    // 保活与断线检测 (ping/pong 测量 RTT，供码率自适应使用；见 protocols/linx_websocket.h)
+    int32_t keepalive_idle_ms;      ///< 空闲时的保活间隔(毫秒)，0 为默认值 15000，<0 关闭保活和断线检测
+    uint32_t keepalive_active_ms;   ///< 有音频收发时的探测间隔(毫秒)，0 为默认值 1000
+    uint8_t keepalive_max_missed;   ///< 连续多少个探测无应答判定为断线，0 为默认值 2；之后按 auto_reconnect 处理
+    
+    // 连接预热 (缩短唤醒到首帧上传的时间)
+    uint32_t dns_cache_ttl_ms;      ///< 服务器地址缓存有效期(毫秒)，有效期内重连跳过 DNS 查询 (默认 300000)
+    bool early_hello;               ///< hello 随 WebSocket 升级请求一起发出，省去一次往返 (需服务端支持)
+    
+    // 文本消息压缩 (permessage-deflate，只压缩 JSON 控制消息，音频从不压缩；见 protocols/linx_ws_deflate.h)
+    bool text_deflate;              ///< 协商压缩，服务端不支持时照常不压缩
+    uint8_t deflate_window_bits;    ///< 窗口位数 9-15，0 为默认值 11；越小双方占用的内存越少
+    bool deflate_dictionary;        ///< 协商 SDK 预置的 JSON 键名字典，短消息压缩率更高 (需服务端支持)
+    
+    // 控制消息二进制编码 (listen/tts/stt/llm/abort 改用 CBOR；见 protocols/linx_control_cbor.h)
+    bool binary_control;            ///< 在 hello 中声明支持，服务端确认且协议版本 >= 2 时启用，否则照常使用 JSON
+    
+    // 下行流控 (按 linx_sdk_set_player() 设置的播放器缓冲水位暂停/恢复读取；见 protocols/linx_websocket.h)
+    uint32_t downlink_buffer_ms;    ///< 在 hello 中声明的下行缓冲容量(毫秒)，0 为关闭；应不大于播放器抖动缓冲区容量
     
     linx_listening_mode_t listening_mode; ///< 监听模式
+    LinxEventLoopMode event_loop_mode;    ///< 事件循环模式 (默认事件驱动)
+    
+    // 多会话 (对象由应用创建和销毁，生命周期需长于SDK实例)
+    linx_reactor_t* reactor;        ///< 共享事件循环；非 NULL 时连接挂在 reactor 上，不创建事件线程，忽略 event_loop_mode
+    linx_ota_t* ota;                ///< 本实例使用的OTA对象；NULL 时OTA请求返回 LINX_SDK_ERROR_NOT_INITIALIZED
+    int32_t ota_session_rate;       ///< 对话中(LISTENING/SPEAKING)的OTA下载带宽(字节/秒)：0 暂停下载，>0 限速，<0 不调整；
+                                    ///< 回到空闲时恢复原来的带宽，暂停期间断开的连接恢复后用 Range 续传
+    linx_executor_t* executor;      ///< 共享的后台任务执行器（异步MCP工具等）；NULL 时SDK在需要时创建自己的
+    
+    // 连接多路复用 (网关等一台设备上运行多个逻辑设备时共用一条连接；需要协议版本 >= 2，见 linx_websocket_stream_create())
+    bool multiplex;                 ///< 本实例的连接可承载其他实例的会话 (在 hello 中声明 features.streams)
+    struct LinxSdk* shared_connection; ///< 非 NULL 时不建立自己的连接，作为一个流挂在该实例 (需开启 multiplex 并已连接) 的连接上；
+                                       ///< 连接参数、重连和保活都跟随该实例，本实例不创建事件线程、不支持OTA，需在该实例之前断开
+    
+    // 事件派发 (队列模式下事件由SDK持有，回调耗时不会阻塞网络线程)
+    LinxEventDelivery event_delivery;     ///< 事件派发方式 (默认在网络线程上同步回调)
+    uint16_t event_queue_audio_depth;     ///< 队列中最多缓存的音频事件数，超出时丢弃最旧的 (默认 64)
+    size_t event_dispatch_stack_size;     ///< 派发线程栈大小(字节)，0 为系统默认值 (dispatch_thread_attr.stack_size 优先)
+    uint32_t event_mask;                  ///< 订阅的事件类型 LINX_EVENT_MASK() 的组合，0 为全部；未订阅的事件不复制、不入队、不回调
+                                          ///< (运行中可用 linx_sdk_set_event_mask() 修改)
+    uint8_t event_coalesce;               ///< 事件合并选项 LINX_EVENT_COALESCE_* 的组合，0 为逐个派发 (共用连接的实例同步回调时不合并音频事件)
+    
+    // 线程调度 (见 os/linx_os.h；零值字段取默认值：NORMAL 优先级，核位图为板级默认值 LINX_THREAD_NET_CORE_MASK，
+    // 把网络和 OTA 下载与音频线程分开)
+    linx_thread_attr_t event_thread_attr;    ///< 网络事件线程 (默认名称 "sdk_event")
+    linx_thread_attr_t dispatch_thread_attr; ///< 事件派发线程 (默认名称 "sdk_dispatch")
+    uint16_t text_event_history;          ///< >0 时文本事件 (TEXT_MESSAGE/SENTENCE_START/SENTENCE_END) 的字符串在回调返回后
+                                          ///< 继续有效，直到又收到这么多个文本事件；字符串来自SDK的节点池，应用不必复制
+    
+    // 上行音频配置
+    uint8_t uplink_bundle_frames;   ///< 上行合包帧数: 0/1 每帧单独发送(默认)，2-6 把连续的 Opus 帧合成一个包发送
+    
+    // 上行码率自适应 (需通过 linx_sdk_set_uplink_encoder() 注册编码器)
+    bool adaptive_bitrate;          ///< 根据发送积压、RTT 和丢包率自动调节编码参数
+    uint32_t min_bitrate;           ///< 码率下限 bps (默认 8000)
+    uint32_t max_bitrate;           ///< 码率上限 bps，也是初始码率 (默认 32000)
+    uint8_t max_packet_loss_perc;   ///< 告知编码器的预期丢包率上限 % (默认 25)
+    bool adaptive_fec;              ///< 丢包时自动开启带内 FEC
+    uint16_t uplink_frame_duration_ms; ///< 上行每帧时长(毫秒)，用于换算排队时延 (默认 20)
+    uint16_t frame_durations_ms[4]; ///< hello 中按优先级提供的候选帧长(毫秒)，如 {20, 60, 10}，0 结束；全 0 只提供 uplink_frame_duration_ms
+    uint32_t audio_features;        ///< hello 中额外声明的可选特性 LINX_WEBSOCKET_AUDIO_FEATURE_*；adaptive_fec、uplink_bundle_frames > 1 时自动声明 FEC、BUNDLING
+    uint16_t preconnect_buffer_ms;  ///< 音频通道打开前暂存的上行音频时长(毫秒)，0 关闭；建议 1000-2000
+    
+    // 上行前处理 (由 linx_sdk_add_uplink_stages() 加入上行流水线；定点实现，按流水线帧长处理，不另外缓冲)
+    bool noise_suppression;         ///< 降噪 (audio/audio_ns.h，仅单声道)
+    uint8_t ns_max_suppression_db;  ///< 降噪最大衰减(dB)，0 为默认值 15
+    bool auto_gain;                 ///< 自动增益 (audio/audio_agc.h)
+    int8_t agc_target_dbfs;         ///< 自动增益的目标电平(dBFS)，0 为默认值 -18
+    uint8_t agc_max_gain_db;        ///< 自动增益的最大增益(dB)，0 为默认值 24 (也是上限)
+    
+    // 质量调速 (见 linx_governor.h；负载持续升高或音频周期超时时依次降低界面帧率、编码复杂度、降噪强度和日志级别)
+    bool quality_governor;          ///< 开启调速器；编码复杂度、降噪和日志级别由SDK登记，界面帧率由应用用 linx_sdk_set_governor_knob() 登记
+    linx_governor_config_t governor; ///< 调速器参数，零值字段取默认值
+    
+    // 内存压力 (见 linx_mem_pressure.h；剩余内存低于水位时按优先级丢弃 MCP 缓存、画面解释答案和句子缓存)
+    bool memory_pressure;           ///< 按 memory 设置全局水位，事件循环定期检查并上报 LINX_EVENT_MEMORY_PRESSURE
+    linx_mem_pressure_config_t memory; ///< 水位和剩余内存来源，零值字段取默认值（多个实例时以最后创建的为准）
+    
+    // MCP 工具剖析 (见 mcp_server_set_tool_profiling()；服务端可用 tools/stats 查询各工具的耗时分布)
+    bool mcp_tool_profiling;        ///< 记录每个工具的参数转换、回调、序列化耗时和回复大小，同时计入运行指标
+    uint32_t mcp_slow_tool_ms;      ///< 慢调用阈值(毫秒)，超过时上报 LINX_EVENT_MCP_SLOW_TOOL，0 不上报
+    
+    // 远程日志 (通过 WebSocket 以 "log" 消息上传，只在上行空闲时发送，语音优先)
+    bool remote_log;                ///< 上传本机输出的日志，便于现场调试
+    log_level_t remote_log_level;   ///< 上传的最低日志级别 (默认 LOG_LEVEL_DEBUG，即所有输出的日志)
+    
+    // 对话时间线追踪 (见 linx_sdk_get_trace_json())
+    uint32_t trace_events;          ///< 时间线环形缓冲保留的节点记录数，0 关闭；约 24 字节/条，建议 512-4096
+    
+    // 打断 (见 linx_sdk_barge_in())
+    bool barge_in;                  ///< 播放期间 linx_sdk_send_wake_word()/linx_sdk_notify_speech_start() 立即本地打断
+    
+    // 本地断句 (见 linx_sdk_notify_speech_end())
+    uint16_t local_endpoint_ms;     ///< AUTO_STOP 模式下说话后尾部静音达到该时长(毫秒)即由设备发送 listen stop，0 关闭；
+                                    ///< 应不小于 VAD 门的 hangover，建议 500-800；服务端断句照常作为兜底
+    
+    // TTS 句子缓存 (见 linx_tts_cache.h，需服务端在 hello 中接受 features.tts_cache)
+    uint32_t tts_cache_bytes;       ///< 缓存重复句子下行音频的 RAM 上限(字节)，0 关闭；命中时本地回放并通知服务端跳过，建议 64-256 KB
+    char tts_voice[32];             ///< 当前音色，与协商的音频格式一起作为缓存键的一部分；切换音色时不会误用旧音色的音频
+    
+    // 调试: 零分配检查 (见 linx_alloc_no_alloc_arm())
+    bool zero_alloc_assert;         ///< 会话建立后音频收发、播放解码路径上的堆分配触发陷阱（默认 abort），仅用于调试
+    
+    // 快速启动 (见 linx_boot.h；可与 early_hello 一起开启)
+    bool fast_boot;                 ///< 推迟 MCP 线程池和 OTA 检查/下载到第一轮对话结束后，期间异步工具同步执行
+    
+    // 会话缓存 (见 linx_session_cache.h；可与 fast_boot、early_hello 一起开启)
+    linx_kv_store_t session_store;  ///< 掉电保留服务器地址、hello 协商结果、TLS 会话和工具表摘要，load/store 为 NULL 时关闭；
+                                    ///< server_url 为空时使用缓存的地址，会话建立后在后台重新做 OTA 检查 (需设置 ota)
+    
+    // 低功耗 (见 linx_sdk_enter_sleep())
+    int32_t sleep_idle_ms;          ///< 没有上下行音频和服务端消息、也不在播放回复，持续多久后自动进入低功耗(毫秒)，0 关闭
+    LinxSdkPowerHooks power_hooks;  ///< 进入、退出低功耗时停止、启动音频设备
+    
+    // 调试: 会话录制与回放 (见 protocols/linx_ws_capture.h)
+    char capture_path[256];         ///< 非空时把 WebSocket 收发的每一帧连同时间戳录制到该文件
+    char replay_path[256];          ///< 非空时不连接网络，按录制文件回放服务端消息 (不能与 reactor 同时使用)
+    float replay_speed;             ///< 回放速度倍数: 1 为录制时的节奏，>1 加速，<=0 尽快回放
+    
+    // 调试: 音频录制 (见 protocols/linx_ogg_recorder.h，开销很小，可在试点部署中常开)
+    char record_path[256];          ///< 非空时把上下行 Opus 包不经重新编码录制为 <record_path>.up.opus / .down.opus
+    
+    // JSON 大对象查找 (见 cJSON_SetObjectIndexThreshold()，进程内全局生效)
+    uint16_t json_index_threshold;  ///< >0 时区分大小写的键查找在对象成员超过该数量后改用惰性建立的哈希索引，0 保持线性查找
+    
+    // 入站 JSON 限制 (见 protocols/linx_websocket.h；超限的消息只丢弃这一条，避免异常的大消息耗尽内存)
+    int32_t max_text_bytes;         ///< 文本消息最大字节数，0 为默认值 65536，<0 不限
+    int32_t max_json_depth;         ///< 最大嵌套层数，0 为默认值 32，<0 不限
+    int32_t max_json_items;         ///< 一条消息最多的 JSON 节点数，0 为默认值 2048，<0 不限
+    
+    // 加密提供者 (见 linx_crypto.h，进程内全局生效)
+    const linx_crypto_provider_t* crypto_provider;  ///< 非 NULL 时 OTA 的 SHA-256 和 MQTT+UDP 的 AES 交给它（如芯片外设），NULL 保持当前提供者
 } LinxSdkConfig;
 
 /**
@@ -103,9 +383,30 @@ typedef enum {
     
     // MCP相关事件
     LINX_EVENT_MCP_MESSAGE,         ///< MCP消息
+    
+    // OTA相关事件
+    LINX_EVENT_OTA_CHECKED,         ///< OTA检查完成
+    LINX_EVENT_OTA_PROGRESS,        ///< OTA下载进度
+    LINX_EVENT_OTA_COMPLETED,       ///< OTA下载结束（成功或失败）
+    
+    // 低功耗相关事件
+    LINX_EVENT_SLEEP_ENTERED,       ///< 已进入低功耗（连接断开、音频设备停止）
+    LINX_EVENT_SLEEP_EXITED,        ///< 已退出低功耗（连接已发起、音频设备已启动）
+    
+    // 诊断事件
+    LINX_EVENT_AUDIO_DEADLINE_MISSED, ///< 音频线程周期超时或卡死（未使用事件队列时在巡检线程上回调）
+    
+    LINX_EVENT_AUDIO_BATCH,         ///< 一批连续的音频数据（开启 LINX_EVENT_COALESCE_AUDIO 时代替 LINX_EVENT_AUDIO_DATA）
+    
+    LINX_EVENT_MEMORY_PRESSURE,     ///< 内存压力档位变化（开启 memory_pressure 时，在执行检查的线程上回调）
+    
+    LINX_EVENT_MCP_SLOW_TOOL,       ///< MCP 工具调用超过 mcp_slow_tool_ms（未使用事件队列时在执行工具的线程上回调）
 
 } LinxEventType;
 
+/** 事件类型对应的订阅位 (LinxSdkConfig.event_mask)；音频批次随 LINX_EVENT_AUDIO_DATA 订阅 */
+#define LINX_EVENT_MASK(type) (1u << (type))
+
 /**
  * @brief SDK事件数据
  */
@@ -119,7 +420,7 @@ typedef struct {
             LinxDeviceState new_state;
         } state_changed;
         
-        // 文本事件
+        // 文本事件（配置了 text_event_history 时字符串在回调返回后仍有效一段时间）
         struct {
             char* text;
             char* role;  // "user", "assistant"
@@ -137,7 +438,7 @@ typedef struct {
         
         // 音频数据
         struct {
-            linx_audio_stream_packet_t* value; // 音频数据
+            linx_audio_stream_packet_t* value; // 音频数据（零拷贝视图，仅在回调期间有效，需保留时调用 linx_audio_stream_packet_retain）
         } audio_data;
         
         // 错误事件
@@ -149,6 +450,9 @@ typedef struct {
         // 会话建立事件
         struct {
             char* session_id;
+            char* audio_format;     ///< 协商后的音频格式，可传给 codec_factory_create_for_format()
+            int frame_duration_ms;  ///< 协商后的帧时长(毫秒)，编码器应按此分帧
+            uint32_t audio_features; ///< 双方都支持的 LINX_WEBSOCKET_AUDIO_FEATURE_*
         } session_established;
         
         // MCP消息
@@ -161,7 +465,48 @@ typedef struct {
         struct {
             char* message;
         } system_message;
+        
+        // OTA事件
+        struct {
+            linx_ota_status_t status;       ///< 检查/下载结果，含义同 linx_ota_check_update() / linx_ota_download_to_sink()
+            const linx_ota_info_t* info;    ///< 检查结果（仅 LINX_EVENT_OTA_CHECKED，仅在回调期间有效）
+            size_t received;                ///< 已下载字节数
+            size_t total;                   ///< 固件总字节数，收到响应头前为 0
+            int percentage;                 ///< 下载百分比，未知时为 -1
+        } ota;
+        
+        // 音频批次（数据包按到达顺序排列，数组和数据包都只在回调期间有效，需保留时逐个调用 linx_audio_stream_packet_retain）
+        struct {
+            linx_audio_stream_packet_t* const* packets;
+            size_t count;
+        } audio_batch;
+        
+        // 音频周期超时事件
+        struct {
+            char* summary;                  ///< 现场的一行文本（线程、阶段、锁、队列深度、栈地址）
+            uint32_t late_us;               ///< 超出周期的时长(微秒)
+            uint32_t period_us;             ///< 周期长度(微秒)
+            uint32_t misses;                ///< 本事件包含的超时次数，stalled 时为 0
+            bool stalled;                   ///< 报告时线程仍未进入下一周期
+        } audio_deadline;
+        
+        // 内存压力事件
+        struct {
+            linx_mem_pressure_level_t level; ///< 新的档位，收缩回调已在事件之前执行
+            size_t free_bytes;              ///< 检查时的剩余内存，未知为 SIZE_MAX
+        } memory_pressure;
+        
+        // MCP 慢调用事件
+        struct {
+            char* tool;                     ///< 工具名称
+            uint32_t args_us;               ///< 参数校验与转换耗时(微秒)
+            uint32_t callback_us;           ///< 工具回调耗时(微秒)
+            uint32_t serialize_us;          ///< 结果序列化与发送耗时(微秒)
+            uint32_t reply_bytes;           ///< 回复大小(字节)
+            bool async;                     ///< 在工作线程池中执行
+        } mcp_slow_tool;
     } data;
+    void* owner;                            ///< 内部使用：队列事件的所有者，同步回调的事件为 NULL
 } LinxEvent;
 
 /**
@@ -169,12 +514,31 @@ typedef struct {
  */
 typedef void (*LinxEventCallback)(const LinxEvent* event, void* user_data);
 
+/**
+ * @brief 等待事件线程启动的 OTA 操作
+ */
+typedef enum {
+    LINX_SDK_OTA_REQUEST_NONE = 0,
+    LINX_SDK_OTA_REQUEST_CHECK,
+    LINX_SDK_OTA_REQUEST_DOWNLOAD,
+    LINX_SDK_OTA_REQUEST_CANCEL
+} LinxSdkOtaRequest;
+
+/**
+ * @brief 本地命令到 MCP 工具的绑定
+ */
+typedef struct {
+    char command[32];                       ///< 命令识别器报告的命令名
+    char tool[64];                          ///< 调用的工具名称
+    char arguments[128];                    ///< 工具参数（JSON 对象文本），空串表示无参数
+} LinxSdkLocalCommand;
+
 /**
  * @brief LinxSdk 内部结构体
  */
 struct LinxSdk {
     LinxSdkConfig config;                   ///< SDK配置
-    LinxDeviceState state;                  ///< 当前状态
+    uint32_t state_word;                    ///< 设备、监听、TTS 状态打包的原子状态字，CAS 更新
     LinxEventCallback event_callback;       ///< 事件回调函数
     void* user_data;                        ///< 用户数据
     
@@ -186,19 +550,136 @@ struct LinxSdk {
     // 简化的连接状态
     time_t connect_time;                    ///< 连接时间
     uint32_t message_count;                 ///< 消息计数
+    linx_json_writer_t json_scratch;        ///< 消息回调中打印 JSON（日志、事件）的复用缓冲区，只在协议回调线程使用
+    
+    // 事件队列（event_delivery 非 CALLBACK 时使用）
+    struct linx_event_queue* event_queue;   ///< SDK持有的事件队列
+    linx_thread_t* dispatch_thread;         ///< 事件派发线程（LINX_EVENT_DELIVERY_THREAD）
+    bool dispatch_thread_running;           ///< 派发线程运行状态
+    struct linx_event_history* text_history; ///< 最近的文本事件（text_event_history > 0 时使用）
+    uint32_t event_mask;                    ///< 订阅的事件类型（原子读写）
+    pthread_mutex_t audio_batch_mutex;      ///< 保护同步回调方式下攒批的音频数据包
+    linx_audio_stream_packet_t* audio_batch[LINX_SDK_AUDIO_BATCH_MAX]; ///< 攒批的数据包（从连接的内存池保留的副本）
+    size_t audio_batch_count;
     
     // WebSocket协议相关
-    linx_websocket_protocol_t* ws_protocol; ///< WebSocket协议实例
-    pthread_t event_thread;                 ///< 事件处理线程
-    bool event_thread_running;              ///< 事件线程运行状态
+    linx_websocket_protocol_t* ws_protocol; ///< WebSocket协议实例（共用连接时指向承载实例的连接，不归本实例所有）
+    linx_websocket_stream_t* ws_stream;     ///< 共用连接时本实例的流，NULL 表示独占连接
+    linx_thread_t* event_thread;            ///< 事件处理线程
+    bool event_thread_running;              ///< 事件循环运行状态（外部循环模式下不创建线程）
     char* session_id;                       ///< 会话ID
-    char* listen_state;                     ///< 监听状态
-    char* tts_state;                        ///< TTS状态
     pthread_mutex_t state_mutex;            ///< 状态互斥锁
+    bool session_ready;                     ///< 当前连接已收到服务端 hello，由 state_mutex 保护
+    linx_future_t* connect_future;          ///< linx_sdk_connect_future() 返回的句柄，由 state_mutex 保护
+    codec_type_t audio_codec_type;          ///< 配置的音频格式
+    
+    // 上行音频合包
+    opus_frame_bundler_t* uplink_bundler;   ///< Opus 多帧合包器
+    pthread_mutex_t uplink_mutex;           ///< 保护合包器、码率控制器和上行发送顺序
+    
+    // 上行码率自适应
+    opus_rate_controller_t* rate_controller; ///< 码率控制器
+    audio_codec_t* uplink_encoder;          ///< 被调节的编码器（由应用持有）
+    int uplink_loss_perc;                   ///< 最近上报的上行丢包率，-1 表示未知
+    uint32_t uplink_timestamp;              ///< 上行音频包时间戳（协议 v2，原子读写）
+    
+    // 连接建立前的上行缓冲（由 uplink_mutex 保护）
+    encoded_frame_buffer_t* preconnect_buffer; ///< 音频通道打开前暂存的编码帧，未开启时为 NULL
+    bool uplink_open;                       ///< 服务端 hello 已处理、开始监听，上行音频可直接发送
+    char pending_wake_word[64];             ///< linx_sdk_wake() 留待开始监听时发送的唤醒词，空串表示没有（由 uplink_mutex 保护）
+    uint8_t wake_speculation;               ///< linx_sdk_wake_speculative() 开始的推测式会话的进展（由 uplink_mutex 保护）
+    
+    // 上行前处理（linx_sdk_add_uplink_stages() 创建，在采集线程上运行）
+    audio_ns_t* uplink_ns;                  ///< 降噪，未开启时为 NULL
+    audio_agc_t* uplink_agc;                ///< 自动增益，未开启时为 NULL
+    
+    // 质量调速（在网络事件循环中采样）
+    linx_governor_t* governor;              ///< 调速器，未开启时为 NULL
+    int uplink_complexity;                  ///< 编码器原本的复杂度，-1 为尚未读取（由 uplink_mutex 保护）
+    int uplink_complexity_level;            ///< 编码复杂度的降级级数（由 uplink_mutex 保护）
+    int governor_log_level;                 ///< 降级前的日志级别，-1 为未降级（只在调速器回调中访问）
     
     // MCP相关
     bool mcp_enabled;                       ///< MCP是否启用
+    bool mcp_workers_deferred;              ///< 快速启动推迟了MCP线程池的启动
+    linx_executor_t* executor;              ///< 后台任务执行器，首次需要时创建（原子读写）
+    bool owns_executor;                     ///< 执行器由SDK创建，销毁时一并销毁
     mcp_server_t* mcp_server;               ///< MCP服务器实例
+    LinxSdkLocalCommand local_commands[LINX_SDK_MAX_LOCAL_COMMANDS]; ///< 本地命令绑定，由 state_mutex 保护
+    size_t local_command_count;             ///< 本地命令绑定数，由 state_mutex 保护
+    
+    // 消息分发
+    linx_message_router_t* msg_router;      ///< 服务器消息类型路由表
+    
+    // OTA（在事件线程中运行，与WebSocket共用 mongoose 管理器）
+    LinxSdkOtaRequest ota_request;          ///< 待启动的操作，由 state_mutex 保护
+    linx_ota_info_t ota_info;               ///< 待下载的固件信息，由 state_mutex 保护
+    linx_ota_sink_t* ota_sink;              ///< 下载目标（由应用持有），由 state_mutex 保护
+    bool ota_active;                        ///< 事件线程上是否有本实例启动的 OTA 操作
+    linx_future_t* ota_request_future;      ///< 待启动操作的句柄（linx_sdk_ota_*_future()），由 state_mutex 保护
+    linx_future_t* ota_future;              ///< 事件线程上进行中的操作的句柄
+    bool ota_yielding;                      ///< 对话中，OTA下载已暂停或限速（事件线程）
+    uint32_t ota_idle_rate;                 ///< 让出前的下载带宽上限，回到空闲时恢复（事件线程）
+    bool ota_session_busy;                  ///< 上一轮循环时是否在对话中（事件线程）
+    uint16_t ota_usage_hours[24];           ///< 按本地时间小时统计的对话次数（衰减，原子读写）
+    linx_reactor_hook_t reactor_hook;       ///< 共享 reactor 上的轮询钩子（驱动OTA和RTT测量）
+    
+    // 远程日志
+    log_upload_t* log_upload;               ///< 日志上传器，未启用时为 NULL
+    
+    // 运行指标（无锁，任意线程记录和读取）
+    linx_metrics_t metrics;                 ///< 计数器与阶段延迟直方图
+    bool tts_first_frame_pending;           ///< TTS 开始后尚未收到第一帧音频（原子读写）
+    linx_trace_t* trace;                    ///< 对话时间线，未启用时为 NULL
+    
+    // 打断
+    linx_player_t* player;                  ///< 打断时清空的播放器（原子读写），未设置时为 NULL
+    bool barge_in_dropping;                 ///< 已本地打断、丢弃被打断回复剩余的下行音频（原子读写）
+    
+    // TTS 句子缓存（以下字段只在网络事件循环中访问）
+    linx_tts_cache_t* tts_cache;            ///< 句子缓存，未启用时为 NULL
+    bool tts_cache_active;                  ///< 本会话服务端接受了 tts_cache 特性
+    bool playback_position_active;          ///< 本会话服务端接受了 playback_position 特性（原子读写）
+    char tts_cache_voice[64];               ///< 缓存键中的音色部分：tts_voice/音频格式
+    int tts_cache_shrink;                   ///< 内存压力回调请求清空句子缓存，由事件循环执行（原子读写）
+    bool tts_skipping;                      ///< 当前句子由缓存回放，丢弃服务端可能仍在路上的音频
+    linx_tts_cache_entry_t* tts_replay;     ///< 正在回放的条目，没有时为 NULL
+    size_t tts_replay_offset;               ///< 回放读取位置
+    uint64_t tts_replay_start_ms;           ///< 回放开始的单调时钟
+    uint32_t tts_replay_sent_ms;            ///< 已回放的音频时长
+    uint32_t tts_replay_timestamp;          ///< 下一个回放包的时间戳
+    uint32_t downlink_next_timestamp;       ///< 下行音频时间线上的下一个时间戳（回放包接在其后）
+    int downlink_sample_rate;               ///< 最近一个下行包的采样率
+    
+    // 零分配检查
+    bool zero_alloc_armed;                  ///< 本会话已打开零分配检查（原子读写）
+    
+    // 快速启动
+    bool boot_deferred;                     ///< 开启 fast_boot 且推迟的初始化尚未执行（原子读写）
+    
+    // 会话缓存（创建时读取，之后只在事件线程上更新）
+    bool session_cache_enabled;             ///< 配置了 session_store
+    linx_session_cache_t session_cache;     ///< 存储中的当前内容
+    bool session_url_cached;                ///< server_url 取自缓存，OTA 重新检查之前未经确认
+    bool session_revalidating;              ///< 已为缓存的地址提交后台 OTA 检查
+    
+    // 低功耗
+    pthread_mutex_t power_mutex;            ///< 串行化进入和退出低功耗
+    bool sleeping;                          ///< 处于低功耗（原子读写）
+    bool sleep_pending;                     ///< 空闲检测已发起自动进入低功耗（原子读写）
+    bool sleep_resume;                      ///< 退出低功耗后的连接恢复睡眠前的会话（连接时消费）
+    uint64_t last_activity_ms;              ///< 最近一次收发音频或收到服务端消息的时刻（原子读写）
+    linx_thread_t* sleep_thread;            ///< 自动进入低功耗的线程，退出低功耗或销毁时回收（原子读写）
+    
+    // 服务器端点选择（endpoint_mutex 保护；探测和采样在事件线程上进行）
+    pthread_mutex_t endpoint_mutex;
+    linx_endpoints_t endpoints;             ///< server_url 与 server_urls 的健康度记录
+    int endpoint_current;                   ///< 当前使用的端点，-1 为没有
+    bool endpoint_dialing;                  ///< 已拨号，尚未建立连接
+    uint64_t endpoint_dial_ms;              ///< 最近一次拨号的时刻
+    uint64_t endpoint_keepalive_probes;     ///< 上次采样时保活已发送的探测数
+    uint64_t endpoint_keepalive_missed;     ///< 上次采样时保活未应答的探测数
+    bool endpoint_probing;                  ///< 有一个 RTT 探测在进行
 
 };
 
@@ -213,6 +694,66 @@ typedef struct LinxSdk LinxSdk;
 // 核心API函数
 // ============================================================================
 
+/**
+ * @brief 安装SDK的内存分配器（外部 PSRAM、内存池等）
+ * 
+ * SDK 各模块与 cJSON 的堆分配都改由 hooks 完成，分配时带有模块、调用位置和
+ * 放置类别，见 log/linx_alloc.h。片内 SRAM / PSRAM 分区放置用
+ * linx_alloc_placement_hooks() 生成 hooks。
+ * 
+ * @param hooks 分配器，为 NULL 时恢复 libc
+ * @return 成功返回 LINX_SDK_SUCCESS，hooks 中有函数为空返回 LINX_SDK_ERROR_INVALID_PARAM
+ * 
+ * @warning 必须在创建任何SDK实例、使用任何 cJSON 接口之前调用，运行期间不能更换
+ */
+LinxSdkError linx_sdk_set_alloc_hooks(const linx_alloc_hooks_t* hooks);
+
+/**
+ * @brief 启用分配跟踪：按模块和调用位置统计堆占用和峰值
+ * 
+ * 统计用 linx_alloc_get_module_stats()、linx_alloc_get_sites() 读取，
+ * 或用 linx_alloc_dump() 输出到日志；bytes_at_peak 给出堆峰值时各模块的占用。
+ * 
+ * @param backing 实际分配内存的分配器，为 NULL 时使用 libc
+ * @return 成功返回 LINX_SDK_SUCCESS，backing 中有函数为空返回 LINX_SDK_ERROR_INVALID_PARAM
+ * 
+ * @warning 与 linx_sdk_set_alloc_hooks() 相同，必须在任何SDK调用之前启用
+ */
+LinxSdkError linx_sdk_enable_alloc_tracking(const linx_alloc_hooks_t* backing);
+
+/**
+ * @brief 在调用者提供的内存上创建SDK实例（静态内存模式）
+ * 
+ * 先在 memory 上安装静态内存区分配器（见 log/linx_alloc.h 的 linx_alloc_static_hooks()），
+ * 再按 linx_sdk_create() 创建实例。之后SDK的全部分配（协议、播放器、包池、MCP、cJSON、
+ * Opus 状态）都来自这块内存；以 LINX_STATIC_MEMORY 构建时 mongoose 的分配也在其中。
+ * 
+ * 内存区大小按构建配置的 CONFIG_STATIC_MEMORY_SIZE 或回环基准（bench_loopback -b）
+ * 统计的堆峰值加余量确定。以 LINX_STATIC_MEMORY_SIZE 非零构建时，linx_sdk_create()
+ * 在未安装分配器的情况下自动使用SDK内置的同样大小的静态内存区。
+ * 
+ * @param config SDK配置参数，同 linx_sdk_create()
+ * @param memory 内存区，SDK 使用期间必须有效
+ * @param size 内存区字节数
+ * @return 成功返回SDK实例；已安装其他分配器、内存区过小或创建失败返回NULL
+ * 
+ * @warning 与 linx_sdk_set_alloc_hooks() 相同，必须在任何SDK调用之前调用，进程内只能调用一次；
+ *          销毁后重新创建实例用 linx_sdk_create()，分配器保持不变
+ */
+LinxSdk* linx_sdk_create_static(const LinxSdkConfig* config, void* memory, size_t size);
+
+/**
+ * @brief 封存静态内存区：之后不再切出新块，只复用已释放的块
+ * 
+ * 在初始化和第一次会话建立（hello 完成、播放器和包池已创建）后调用，之后稳态运行
+ * 不再增长内存占用；断线重连释放并重新创建同样大小的对象，同样由已释放的块满足。
+ * 封存后仍需新块的分配会失败，统计见 linx_alloc_static_get_stats()。
+ * 
+ * @param sdk SDK实例
+ * @return 成功返回 LINX_SDK_SUCCESS；未使用静态内存区返回 LINX_SDK_ERROR_NOT_INITIALIZED
+ */
+LinxSdkError linx_sdk_seal_memory(LinxSdk* sdk);
+
 /**
  * @brief 创建SDK实例
  * 
@@ -333,6 +874,25 @@ void linx_sdk_destroy(LinxSdk* sdk);
  */
 LinxSdkError linx_sdk_set_event_callback(LinxSdk* sdk, LinxEventCallback callback, void* user_data);
 
+/**
+ * @brief 修改订阅的事件类型
+ * 
+ * 未订阅的事件在产生处直接丢弃，不复制、不入队、不调用回调；例如由播放器
+ * (linx_sdk_set_player()) 处理下行音频的应用可以不订阅 LINX_EVENT_AUDIO_DATA。
+ * 已经入队的事件照常派发。
+ * 
+ * @param sdk SDK实例指针
+ * @param mask LINX_EVENT_MASK() 的组合，0 为全部事件
+ * @return 成功返回 LINX_SDK_SUCCESS
+ * 
+ * @example
+ * ```c
+ * linx_sdk_set_event_mask(sdk, LINX_EVENT_MASK(LINX_EVENT_STATE_CHANGED) |
+ *                              LINX_EVENT_MASK(LINX_EVENT_TEXT_MESSAGE));
+ * ```
+ */
+LinxSdkError linx_sdk_set_event_mask(LinxSdk* sdk, uint32_t mask);
+
 /**
  * @brief 连接到服务器
  * 
@@ -350,6 +910,10 @@ LinxSdkError linx_sdk_set_event_callback(LinxSdk* sdk, LinxEventCallback callbac
  * - 连接成功后会触发LINX_EVENT_WEBSOCKET_CONNECTED事件
  * - 连接过程是异步的，函数返回成功不代表连接已完全建立
  * - 如果已经连接，重复调用会返回成功
+ * - 开启 auto_reconnect 后，断线时会在同一连接对象上自动重连并尝试恢复原会话，
+ *   重连期间设备状态为 LINX_DEVICE_STATE_CONNECTING，此时调用也直接返回成功
+ * - 握手（DNS、TLS、WebSocket 升级）需要数百毫秒，建议在唤醒词开始时就调用，
+ *   不要等唤醒词结束
  * 
  * @warning 
  * - 确保在调用前已设置事件回调函数
@@ -455,6 +1019,9 @@ LinxSdkError linx_sdk_send_text(LinxSdk* sdk, const char* text);
  * - 音频数据应符合SDK配置中指定的采样率和声道数
  * - 推荐使用PCM格式的音频数据
  * - 数据会被实时发送到服务器进行处理
+ * - 配置了 preconnect_buffer_ms 时，连接建立、hello 握手期间（包括自动重连期间）的帧
+ *   连同当时的上行时间戳暂存起来并返回成功，开始监听后按原顺序一次补发；
+ *   超出缓冲时长时丢弃最旧的帧。可在检测到唤醒词时就开始调用
  * 
  * @warning 
  * - 确保音频数据格式与SDK配置一致
@@ -477,116 +1044,354 @@ LinxSdkError linx_sdk_send_text(LinxSdk* sdk, const char* text);
 LinxSdkError linx_sdk_send_audio(LinxSdk* sdk, const uint8_t* data, size_t size);
 
 /**
- * @brief 获取当前状态
+ * @brief 设置上行合包帧数
  * 
- * 获取SDK当前的设备状态。
+ * 合包开启后，linx_sdk_send_audio() 传入的每个 Opus 帧先缓存，攒够 frames 帧
+ * 后通过 Opus repacketizer 合成一个多帧包作为一条消息发送，减少消息数量和协议头
+ * 开销，代价是最多增加 (frames-1) 帧的上行延迟。对延迟敏感时可随时设为 1，
+ * 恢复每帧单独发送。
  * 
  * @param sdk SDK实例指针
+ * @param frames 每包合并的帧数，0/1 表示不合包，最大 OPUS_FRAME_BUNDLER_MAX_FRAMES
  * 
- * @return 当前设备状态，如果sdk为NULL则返回LINX_DEVICE_STATE_ERROR
- * - LINX_DEVICE_STATE_IDLE: 空闲状态
- * - LINX_DEVICE_STATE_CONNECTING: 正在连接
- * - LINX_DEVICE_STATE_LISTENING: 正在监听
- * - LINX_DEVICE_STATE_SPEAKING: 正在播放语音
- * - LINX_DEVICE_STATE_ERROR: 错误状态
+ * @return LinxSdkError 错误码
+ * - LINX_SDK_SUCCESS: 设置成功
+ * - LINX_SDK_ERROR_INVALID_PARAM: 参数无效
+ * - LINX_SDK_ERROR_MEMORY: 合包器创建失败
  * 
- * @note 
- * - 此函数是线程安全的
- * - 状态变化会通过LINX_EVENT_STATE_CHANGED事件通知
+ * @note 修改前已缓存的帧会先合并发送出去
+ * @note 合包要求服务端按 Opus 多帧包解码 (单包最长 120ms)，非 Opus 格式下只能设为 0/1
+ */
+LinxSdkError linx_sdk_set_uplink_bundle_frames(LinxSdk* sdk, uint8_t frames);
+
+/**
+ * @brief 获取协商后的音频格式
  * 
- * @see LinxDeviceState, LINX_EVENT_STATE_CHANGED
+ * 服务端在 hello 响应的 audio_params.format 中指定格式时以服务端为准，
+ * 否则为 LinxSdkConfig.audio_format。应用据此用 codec_factory_create_for_format()
+ * 创建编解码器，也可直接使用 LINX_EVENT_SESSION_ESTABLISHED 事件中的 audio_format。
  * 
- * @example
- * ```c
- * LinxDeviceState state = linx_sdk_get_state(sdk);
- * switch (state) {
- *     case LINX_DEVICE_STATE_IDLE:
- *         printf("设备空闲\n");
- *         break;
- *     case LINX_DEVICE_STATE_LISTENING:
- *         printf("正在监听\n");
- *         break;
- *     // ... 处理其他状态
- * }
- * ```
+ * @param sdk SDK实例指针
+ * @param format 格式名（输出参数）
+ * @param size format 缓冲区大小
+ * 
+ * @return LinxSdkError 错误码
+ * - LINX_SDK_SUCCESS: 获取成功
+ * - LINX_SDK_ERROR_INVALID_PARAM: 参数无效
  */
-LinxDeviceState linx_sdk_get_state(LinxSdk* sdk);
-
-// ============================================================================
-// 辅助函数
-// ============================================================================
+LinxSdkError linx_sdk_get_audio_format(LinxSdk* sdk, char* format, size_t size);
 
 /**
- * @brief 检查是否已连接
+ * @brief 按协商后的音频格式创建并初始化编解码器
  * 
- * 检查SDK是否已成功连接到服务器。
+ * 格式同 linx_sdk_get_audio_format()，经编解码器注册表创建（codec_factory.h），
+ * 注册的实现（如硬件编解码器）对应用透明。采样率和声道数取自配置，会话建立后
+ * 解码器使用服务端下发的采样率，帧长取协商结果。
  * 
  * @param sdk SDK实例指针
+ * @param encoder true 创建编码器，false 创建解码器
+ * @return 已初始化的编解码器，由调用方用 audio_codec_destroy() 销毁；失败返回 NULL
+ */
+audio_codec_t* linx_sdk_create_codec(LinxSdk* sdk, bool encoder);
+
+/**
+ * @brief 获取会话回放进度
  * 
- * @return 
- * - true: 已连接到服务器
- * - false: 未连接或sdk为NULL
- * 
- * @note 
- * - 此函数是线程安全的
- * - 连接状态变化会通过相应事件通知
+ * 配置了 LinxSdkConfig::replay_path 时，linx_sdk_connect() 不连接网络，而是按录制文件
+ * 的时间戳把服务端消息交给与真实连接相同的处理路径，SDK发出的消息只计数不发送。
+ * 文件回放完毕后 finished 为 true，并已上报 LINX_EVENT_WEBSOCKET_DISCONNECTED。
  * 
- * @see linx_sdk_connect(), linx_sdk_disconnect()
+ * @param sdk SDK实例指针
+ * @param stats 回放统计（输出参数）
  * 
- * @example
- * ```c
- * if (linx_sdk_is_connected(sdk)) {
- *     printf("已连接，可以发送消息\n");
- *     linx_sdk_send_text(sdk, "Hello");
- * } else {
- *     printf("未连接，需要先连接\n");
- *     linx_sdk_connect(sdk);
- * }
- * ```
+ * @return LinxSdkError 错误码
+ * - LINX_SDK_SUCCESS: 获取成功
+ * - LINX_SDK_ERROR_INVALID_PARAM: 参数无效
+ * - LINX_SDK_ERROR_NOT_INITIALIZED: 未连接或未处于回放模式
  */
-bool linx_sdk_is_connected(LinxSdk* sdk);
+LinxSdkError linx_sdk_get_replay_stats(LinxSdk* sdk, LinxReplayStats* stats);
 
 /**
- * @brief 获取消息计数
+ * @brief 获取下行流控统计
  * 
- * 获取SDK自连接以来发送和接收的消息总数。
+ * 配置了 LinxSdkConfig::downlink_buffer_ms 时，播放器缓冲超过容量的 3/4 暂停读取 WebSocket
+ * （TCP 窗口填满后服务端自然减速），回落到 1/2 以下恢复；服务端在 hello 中确认支持时
+ * 还会收到 {"type":"flow"} 水位报告，可据此主动调整发送速度。
  * 
  * @param sdk SDK实例指针
+ * @param stats 流控统计（输出参数）
  * 
- * @return 消息计数，如果sdk为NULL则返回0
+ * @return LinxSdkError 错误码
+ * - LINX_SDK_SUCCESS: 获取成功
+ * - LINX_SDK_ERROR_INVALID_PARAM: 参数无效
+ * - LINX_SDK_ERROR_NOT_INITIALIZED: 未连接
+ */
+LinxSdkError linx_sdk_get_flow_stats(LinxSdk* sdk, LinxFlowStats* stats);
+
+/**
+ * @brief 获取 hello 协商结果
  * 
- * @note 
- * - 计数包括发送和接收的所有消息
- * - 断开连接后重新连接，计数会重置
- * - 此函数是线程安全的
+ * 设备在 hello 中按优先级提供候选格式（LinxSdkConfig::audio_formats）、帧长
+ * （LinxSdkConfig::frame_durations_ms）、协议版本和可选特性，服务端各选一个写回。
+ * 应用在 LINX_EVENT_SESSION_ESTABLISHED 之后据此配置编码器（格式、帧长、FEC/DTX、合包）。
  * 
- * @see linx_sdk_get_connect_time()
+ * @param sdk SDK实例指针
+ * @param params 协商结果（输出参数）
  * 
- * @example
- * ```c
- * uint32_t count = linx_sdk_get_message_count(sdk);
- * printf("已处理 %u 条消息\n", count);
- * ```
+ * @return LinxSdkError 错误码
+ * - LINX_SDK_SUCCESS: 获取成功
+ * - LINX_SDK_ERROR_INVALID_PARAM: 参数无效
+ * - LINX_SDK_ERROR_NOT_INITIALIZED: 尚未收到服务端 hello
  */
-uint32_t linx_sdk_get_message_count(LinxSdk* sdk);
+LinxSdkError linx_sdk_get_session_params(LinxSdk* sdk, LinxSessionParams* params);
 
 /**
- * @brief 获取连接时间
+ * @brief 获取SDK的后台任务执行器
  * 
- * 获取SDK最后一次成功连接的时间戳。
+ * 应用的异步功能（图像解释、资源解码等）可以提交到同一个执行器，不必自己创建线程。
+ * 返回 LinxSdkConfig::executor，未设置时返回SDK自己创建的执行器；快速启动时要等
+ * 第一轮对话结束后才创建，之前返回NULL。
  * 
  * @param sdk SDK实例指针
+ * @return 执行器，尚未创建时返回NULL；SDK销毁后失效
+ */
+linx_executor_t* linx_sdk_get_executor(LinxSdk* sdk);
+
+/**
+ * @brief 立即发送尚未攒满的上行合包
  * 
- * @return 连接时间戳（Unix时间），如果sdk为NULL或未连接则返回0
- * 
- * @note 
- * - 返回的是Unix时间戳（自1970年1月1日以来的秒数）
- * - 每次重新连接都会更新此时间
- * - 此函数是线程安全的
+ * 一段语音结束时调用，避免尾部最多 (frames-1) 帧滞留在合包器中。
+ * TTS 开始、SDK 发送停止监听前会自动调用。未开启合包时直接返回成功。
  * 
- * @see linx_sdk_get_message_count(), linx_sdk_is_connected()
+ * @param sdk SDK实例指针
  * 
- * @example
+ * @return LinxSdkError 错误码
+ * - LINX_SDK_SUCCESS: 发送成功或没有缓存帧
+ * - LINX_SDK_ERROR_INVALID_PARAM: sdk参数为NULL
+ * - LINX_SDK_ERROR_NETWORK: 网络发送失败
+ */
+LinxSdkError linx_sdk_flush_audio(LinxSdk* sdk);
+
+/**
+ * @brief 设置上行音频包的时间戳
+ * 
+ * 协议 v2 的二进制音频包带有时间戳，实时监听模式下服务端用它把上行音频和下行
+ * 播放对齐做回声消除。设备端回声消除可用 audio_aec_get_far_timestamp() 取得与
+ * 当前采集帧对齐的播放时间戳，在每次 linx_sdk_send_audio() 前调用本函数。
+ * 可在任意线程调用；合包和预录缓冲发出的包使用发送时的最新值。
+ * 
+ * @param sdk SDK实例指针
+ * @param timestamp 时间戳（毫秒）
+ * 
+ * @return LinxSdkError 错误码
+ */
+LinxSdkError linx_sdk_set_uplink_timestamp(LinxSdk* sdk, uint32_t timestamp);
+
+/**
+ * @brief 注册由码率自适应调节的上行编码器
+ * 
+ * 开启 adaptive_bitrate 后，SDK 根据发送队列积压、ping 往返时间和上报的丢包率
+ * 计算目标码率、预期丢包率和带内 FEC 开关，并在 linx_sdk_send_audio() 中下发
+ * 给该编码器。参数下发发生在调用 linx_sdk_send_audio() 的线程上，因此编码和发送
+ * 必须在同一线程中交替进行，SDK 不会和 opus_encode 并发访问编码器。
+ * 
+ * @param sdk SDK实例指针
+ * @param encoder opus_codec_create() 创建并已初始化编码器的实例，传 NULL 取消注册
+ * 
+ * @return LinxSdkError 错误码
+ * - LINX_SDK_SUCCESS: 注册成功
+ * - LINX_SDK_ERROR_INVALID_PARAM: sdk参数为NULL
+ * - LINX_SDK_ERROR_NOT_INITIALIZED: 未开启 adaptive_bitrate
+ * 
+ * @note 编码器由应用销毁，销毁前应先传 NULL 取消注册
+ */
+LinxSdkError linx_sdk_set_uplink_encoder(LinxSdk* sdk, audio_codec_t* encoder);
+
+/**
+ * @brief 按配置在上行音频流水线中加入降噪和自动增益
+ * 
+ * 根据 noise_suppression、auto_gain 创建 audio_ns / audio_agc 并依次追加到
+ * pipeline 末尾，帧长和声道数取 audio_pipeline_get_output_samples() /
+ * audio_pipeline_get_output_channels()，即前面各阶段的输出，不另外缓冲。
+ * 应在回声消除之后、唤醒词和 VAD 门控之前调用：
+ * 
+ *   采集 -> [波束形成] -> AEC -> 降噪 -> 自动增益 -> 唤醒词 / VAD 门控 / 编码发送
+ * 
+ * 麦克风阵列采集时先加入 audio_beamformer_stage()，把多声道合成单声道，降噪才会启用。
+ * 
+ * 两者均为定点实现（无 FPU 的 RISC-V32 也可实时运行），ARM 上使用 NEON。
+ * 
+ * @param sdk SDK实例指针
+ * @param pipeline audio_pipeline_create() 创建的上行流水线，尚未启动
+ * 
+ * @return LinxSdkError 错误码
+ * - LINX_SDK_SUCCESS: 已加入（两项都未开启时什么也不做）
+ * - LINX_SDK_ERROR_INVALID_PARAM: 参数为 NULL，或流水线已满、已启动
+ * - LINX_SDK_ERROR_NOT_INITIALIZED: 已为另一条流水线创建过
+ * - LINX_SDK_ERROR_MEMORY: 创建失败
+ * 
+ * @note 处理对象由 SDK 持有，linx_sdk_destroy() 时释放，流水线须先于 SDK 销毁；
+ *       统计见 audio_ns_get_stats() / audio_agc_get_stats()（sdk->uplink_ns、sdk->uplink_agc）
+ */
+LinxSdkError linx_sdk_add_uplink_stages(LinxSdk* sdk, audio_pipeline_t* pipeline);
+
+/**
+ * @brief 上报服务端统计的上行丢包率
+ * 
+ * 协议本身没有丢包统计消息，服务端通过自定义消息下发时，可在
+ * linx_sdk_register_message_handler() 注册的处理函数中调用本函数。
+ * 可在任意线程调用。
+ * 
+ * @param sdk SDK实例指针
+ * @param loss_perc 丢包率 (0-100)
+ * 
+ * @return LinxSdkError 错误码
+ */
+LinxSdkError linx_sdk_report_uplink_loss(LinxSdk* sdk, int loss_perc);
+
+/**
+ * @brief 获取码率自适应当前的目标编码参数
+ * 
+ * @param sdk SDK实例指针
+ * @param target 目标参数（输出参数）
+ * 
+ * @return 未开启码率自适应时返回 false
+ */
+bool linx_sdk_get_uplink_target(LinxSdk* sdk, opus_rate_controller_target_t* target);
+
+/**
+ * @brief 获取当前状态
+ * 
+ * 获取SDK当前的设备状态。
+ * 
+ * @param sdk SDK实例指针
+ * 
+ * @return 当前设备状态，如果sdk为NULL则返回LINX_DEVICE_STATE_ERROR
+ * - LINX_DEVICE_STATE_IDLE: 空闲状态
+ * - LINX_DEVICE_STATE_CONNECTING: 正在连接
+ * - LINX_DEVICE_STATE_LISTENING: 正在监听
+ * - LINX_DEVICE_STATE_SPEAKING: 正在播放语音
+ * - LINX_DEVICE_STATE_ERROR: 错误状态
+ * 
+ * @note 
+ * - 此函数是线程安全的，只做一次原子读取，可以在UI线程中频繁调用
+ * - 状态变化会通过LINX_EVENT_STATE_CHANGED事件通知
+ * - 收到 tts start 时切换到 LINX_DEVICE_STATE_SPEAKING，tts stop 后回到 LINX_DEVICE_STATE_LISTENING
+ * - 状态只按固定的转换表变化，断开后迟到的回调不会把状态改回 LISTENING/SPEAKING
+ * 
+ * @see LinxDeviceState, LINX_EVENT_STATE_CHANGED
+ * 
+ * @example
+ * ```c
+ * LinxDeviceState state = linx_sdk_get_state(sdk);
+ * switch (state) {
+ *     case LINX_DEVICE_STATE_IDLE:
+ *         printf("设备空闲\n");
+ *         break;
+ *     case LINX_DEVICE_STATE_LISTENING:
+ *         printf("正在监听\n");
+ *         break;
+ *     // ... 处理其他状态
+ * }
+ * ```
+ */
+LinxDeviceState linx_sdk_get_state(LinxSdk* sdk);
+
+/**
+ * @brief 获取语音监听状态
+ * 
+ * @param sdk SDK实例指针
+ * @return 监听状态，sdk为NULL或不在会话中时返回LINX_LISTEN_STATE_NONE
+ * 
+ * @note 此函数是线程安全的，只做一次原子读取
+ */
+LinxListenState linx_sdk_get_listen_state(LinxSdk* sdk);
+
+/**
+ * @brief 获取TTS状态
+ * 
+ * @param sdk SDK实例指针
+ * @return TTS状态，sdk为NULL或不在会话中时返回LINX_TTS_STATE_NONE
+ * 
+ * @note 此函数是线程安全的，只做一次原子读取
+ */
+LinxTtsState linx_sdk_get_tts_state(LinxSdk* sdk);
+
+// ============================================================================
+// 辅助函数
+// ============================================================================
+
+/**
+ * @brief 检查是否已连接
+ * 
+ * 检查SDK是否已成功连接到服务器。
+ * 
+ * @param sdk SDK实例指针
+ * 
+ * @return 
+ * - true: 已连接到服务器
+ * - false: 未连接或sdk为NULL
+ * 
+ * @note 
+ * - 此函数是线程安全的
+ * - 连接状态变化会通过相应事件通知
+ * 
+ * @see linx_sdk_connect(), linx_sdk_disconnect()
+ * 
+ * @example
+ * ```c
+ * if (linx_sdk_is_connected(sdk)) {
+ *     printf("已连接，可以发送消息\n");
+ *     linx_sdk_send_text(sdk, "Hello");
+ * } else {
+ *     printf("未连接，需要先连接\n");
+ *     linx_sdk_connect(sdk);
+ * }
+ * ```
+ */
+bool linx_sdk_is_connected(LinxSdk* sdk);
+
+/**
+ * @brief 获取消息计数
+ * 
+ * 获取SDK自连接以来发送和接收的消息总数。
+ * 
+ * @param sdk SDK实例指针
+ * 
+ * @return 消息计数，如果sdk为NULL则返回0
+ * 
+ * @note 
+ * - 计数包括发送和接收的所有消息
+ * - 断开连接后重新连接，计数会重置
+ * - 此函数是线程安全的
+ * 
+ * @see linx_sdk_get_connect_time()
+ * 
+ * @example
+ * ```c
+ * uint32_t count = linx_sdk_get_message_count(sdk);
+ * printf("已处理 %u 条消息\n", count);
+ * ```
+ */
+uint32_t linx_sdk_get_message_count(LinxSdk* sdk);
+
+/**
+ * @brief 获取连接时间
+ * 
+ * 获取SDK最后一次成功连接的时间戳。
+ * 
+ * @param sdk SDK实例指针
+ * 
+ * @return 连接时间戳（Unix时间），如果sdk为NULL或未连接则返回0
+ * 
+ * @note 
+ * - 返回的是Unix时间戳（自1970年1月1日以来的秒数）
+ * - 每次重新连接都会更新此时间
+ * - 此函数是线程安全的
+ * 
+ * @see linx_sdk_get_message_count(), linx_sdk_is_connected()
+ * 
+ * @example
  * ```c
  * time_t connect_time = linx_sdk_get_connect_time(sdk);
  * if (connect_time > 0) {
@@ -596,80 +1401,418 @@ uint32_t linx_sdk_get_message_count(LinxSdk* sdk);
  */
 time_t linx_sdk_get_connect_time(LinxSdk* sdk);
 
+/**
+ * @brief 获取运行指标快照
+ * 
+ * 包含各阶段延迟直方图（唤醒到第一帧上行、最后一帧上行到 stt、TTS 首帧到播出、
+ * 抖动缓冲深度、解码耗时、发送队列深度）和计数器（重连、上下行丢包等）。
+ * 播放相关的指标需要先用 linx_player_set_metrics() 把 linx_sdk_get_metrics_recorder()
+ * 交给播放器。指标在SDK实例的整个生命周期内累计，断开重连不会清零。
+ * 
+ * @param sdk SDK实例指针
+ * @param snapshot 输出快照（约 6KB，建议不要放在小栈上）
+ * 
+ * @return 
+ * - LINX_SDK_SUCCESS: 成功
+ * - LINX_SDK_ERROR_INVALID_PARAM: 参数为NULL
+ * 
+ * @note 此函数是线程安全的，不加锁
+ * 
+ * @see linx_metrics_histogram_percentile(), linx_sdk_get_metrics_json()
+ */
+LinxSdkError linx_sdk_get_metrics(LinxSdk* sdk, linx_metrics_snapshot_t* snapshot);
+
+/**
+ * @brief 以 JSON 导出运行指标（格式见 linx_metrics_to_json()）
+ * 
+ * @param sdk SDK实例指针
+ * @return JSON 文本，调用者用 linx_free() 释放；sdk 为 NULL 或内存不足时返回 NULL
+ */
+char* linx_sdk_get_metrics_json(LinxSdk* sdk);
+
+/**
+ * @brief 登记或替换质量调速器的调节项（需开启 quality_governor）
+ * 
+ * SDK 已登记编码复杂度（2 级：减半、最低）、降噪强度（2 级：减半、直通，需开启
+ * noise_suppression）和日志级别（1 级：提高到 WARN）；界面帧率等应用侧的调节项由应用登记，
+ * 也可以替换SDK的调节项或以 levels 为 0 取消。回调在网络事件循环上执行，不能阻塞。
+ * 
+ * @code
+ * linx_sdk_set_governor_knob(sdk, LINX_GOVERNOR_UI_FPS, 2, linx_ui_governor_apply, ui);
+ * @endcode
+ * 
+ * @return 
+ * - LINX_SDK_SUCCESS: 成功
+ * - LINX_SDK_ERROR_INVALID_PARAM: 参数无效
+ * - LINX_SDK_ERROR_NOT_INITIALIZED: 未开启调速器
+ */
+LinxSdkError linx_sdk_set_governor_knob(LinxSdk* sdk, linx_governor_knob_id_t knob, int levels,
+                                        linx_governor_apply_t apply, void* user_data);
+
+/**
+ * @brief 获取质量调速器的当前档位和调整次数
+ * 
+ * 调整次数同时计入运行指标（governor_degrades、governor_restores），每次采样的 CPU 负载
+ * 记入 cpu_load_permille 直方图。
+ * 
+ * @return 未开启调速器时返回 false
+ */
+bool linx_sdk_get_governor_stats(LinxSdk* sdk, linx_governor_stats_t* stats);
+
+/**
+ * @brief 获取SDK的指标记录器，供播放器等模块记录到同一组指标
+ * 
+ * @param sdk SDK实例指针
+ * @return 记录器指针，在SDK销毁前有效；sdk 为 NULL 时返回 NULL
+ */
+linx_metrics_t* linx_sdk_get_metrics_recorder(LinxSdk* sdk);
+
+/**
+ * @brief 以 Chrome trace JSON 导出对话时间线（格式见 linx_trace_to_chrome_json()）
+ * 
+ * 每次开始监听（hello 之后、非实时模式下 TTS 结束后）或实时模式下 TTS 结束时开始新的轮次，
+ * 轮次内记录 stt、llm、tts start/stop、第一帧上行和第一帧下行音频。
+ * 第一个样本写入音频设备的时刻需要先用 linx_player_set_trace() 把 linx_sdk_get_trace()
+ * 交给播放器；VAD 等应用侧节点用 linx_sdk_trace_mark() 上报。
+ * 
+ * @param sdk SDK实例指针
+ * @return JSON 文本，调用者用 linx_free() 释放；未配置 trace_events 或内存不足时返回 NULL
+ * 
+ * @note 此函数是线程安全的，不阻塞记录端
+ */
+char* linx_sdk_get_trace_json(LinxSdk* sdk);
+
+/**
+ * @brief 记录一个应用侧的时间线节点（如本地 VAD 检测到说话时的 LINX_TRACE_VAD_ONSET）
+ * 
+ * 同一轮次内只记录第一次，可以在音频采集回调中每帧调用。
+ * 
+ * @param sdk SDK实例指针
+ * @param point 时间线节点
+ * @return 
+ * - LINX_SDK_SUCCESS: 成功（本轮已记录过时也返回成功）
+ * - LINX_SDK_ERROR_INVALID_PARAM: 参数无效
+ * - LINX_SDK_ERROR_NOT_INITIALIZED: 未配置 trace_events
+ */
+LinxSdkError linx_sdk_trace_mark(LinxSdk* sdk, linx_trace_point_t point);
+
+/**
+ * @brief 获取SDK的时间线，供播放器等模块记录到同一时间线
+ * 
+ * @param sdk SDK实例指针
+ * @return 时间线指针，在SDK销毁前有效；未启用时返回 NULL
+ */
+linx_trace_t* linx_sdk_get_trace(LinxSdk* sdk);
+
+/**
+ * @brief 获取SDK的 TTS 句子缓存，用于把缓存导出到 flash 或开机后导入
+ * 
+ * 句子的录制和回放都在网络事件循环中进行；导出、导入和统计可以在任意线程调用
+ * (linx_tts_cache_export() / linx_tts_cache_import() / linx_tts_cache_get_stats())。
+ * 
+ * @param sdk SDK实例指针
+ * @return 缓存指针，在SDK销毁前有效；未配置 tts_cache_bytes 时返回 NULL
+ */
+linx_tts_cache_t* linx_sdk_get_tts_cache(LinxSdk* sdk);
+
+/**
+ * @brief 获取下行音频的播出位置和输出延迟（见 linx_player_get_position()）
+ * 
+ * audio_features 中声明 LINX_WEBSOCKET_AUDIO_FEATURE_PLAYBACK_POSITION 且服务端接受时，
+ * SDK 在每句开始和打断时自动把位置上报给服务端，用于回声参考对齐和字幕同步。
+ * 
+ * @param sdk SDK实例指针
+ * @param position 输出：播出位置
+ * @return 成功返回 LINX_SDK_SUCCESS；未设置播放器返回 LINX_SDK_ERROR_NOT_INITIALIZED
+ */
+LinxSdkError linx_sdk_get_playback_position(LinxSdk* sdk, linx_player_position_t* position);
+
 // ============================================================================
 // WebSocket相关函数
 // ============================================================================
 
 
 /**
- * @brief 中止语音播放
+ * @brief 中止语音播放
+ * 
+ * 立即停止当前正在播放的TTS语音，并恢复语音监听。
+ * 
+ * @param sdk SDK实例指针
+ * @param reason 中止原因，用于日志记录和事件通知
+ * 
+ * @return 
+ * - LINX_SDK_SUCCESS: 中止成功
+ * - LINX_SDK_ERROR_INVALID_PARAM: sdk参数为NULL
+ * - LINX_SDK_ERROR_NOT_INITIALIZED: SDK未连接到服务器
+ * 
+ * @note 
+ * - 只有在TTS播放状态下调用才有效果
+ * - 中止后会自动恢复语音监听
+ * - 会触发相应的状态变化事件
+ * 
+ * @warning 
+ * - 确保在连接状态下调用此函数
+ * 
+ * @see linx_sdk_get_state(), LINX_EVENT_TTS_STOPPED
+ * 
+ * @example
+ * ```c
+ * if (linx_sdk_get_state(sdk) == LINX_DEVICE_STATE_SPEAKING) {
+ *     LinxSdkError result = linx_sdk_abort_speaking(sdk, LINX_ABORT_USER_INTERRUPT);
+ *     if (result == LINX_SDK_SUCCESS) {
+ *         printf("语音播放已中止\n");
+ *     }
+ * }
+ * ```
+ */
+LinxSdkError linx_sdk_abort_speaking(LinxSdk* sdk, linx_abort_reason_t reason);
+
+/**
+ * @brief 发送唤醒词
+ * 
+ * 向服务器发送唤醒词，用于激活语音交互会话。
+ * 
+ * @param sdk SDK实例指针
+ * @param wake_word 唤醒词字符串，必须是UTF-8编码
+ * 
+ * @return 
+ * - LINX_SDK_SUCCESS: 发送成功
+ * - LINX_SDK_ERROR_INVALID_PARAM: sdk或wake_word参数为NULL
+ * - LINX_SDK_ERROR_NOT_INITIALIZED: SDK未连接到服务器
+ * - LINX_SDK_ERROR_NETWORK: 网络发送失败
+ * 
+ * @note 
+ * - 唤醒词用于启动新的对话会话
+ * - 发送成功后可能会收到会话建立事件
+ * - 支持自定义唤醒词
+ * - 开启 LinxSdkConfig::barge_in 且正在播放时先本地打断（见 linx_sdk_barge_in()）
+ * 
+ * @warning 
+ * - 确保在连接状态下调用此函数
+ * - 唤醒词不应为空字符串
+ * 
+ * @see LINX_EVENT_SESSION_ESTABLISHED, linx_sdk_send_text()
+ * 
+ * @example
+ * ```c
+ * LinxSdkError result = linx_sdk_send_wake_word(sdk, "小助手");
+ * if (result == LINX_SDK_SUCCESS) {
+ *     printf("唤醒词已发送\n");
+ * }
+ * ```
+ */
+LinxSdkError linx_sdk_send_wake_word(LinxSdk* sdk, const char* wake_word);
+
+/**
+ * @brief 本地检测到唤醒词：按需连接，会话就绪后发送唤醒词
+ * 
+ * - 音频通道已打开时等同于 linx_sdk_send_wake_word()
+ * - 否则记下唤醒词并调用 linx_sdk_connect()；服务端 hello 处理完、开始监听后先发送
+ *   唤醒词，再补发连接前缓存的上行音频（preconnect_buffer_ms），之后的帧直接发送
+ * - 处于低功耗时先退出低功耗（linx_sdk_exit_sleep()，power_hooks.on_wake 在调用线程上执行）
+ * 
+ * - 之前调用过 linx_sdk_wake_speculative() 时确认推测式会话：会话已就绪则立即发送唤醒词并
+ *   打开上行，否则在会话就绪时发送
+ * 
+ * 与 audio_wake（audio/audio_wake.h）配合：on_wake 中调用本函数，is_ready 使用
+ * linx_sdk_is_uplink_open()，唤醒词之前的预录音频在音频通道打开后经上行发送。
+ * 
+ * @param sdk SDK实例指针
+ * @param wake_word 唤醒词字符串，UTF-8 编码，超过 63 字节截断
+ * 
+ * @return 
+ * - LINX_SDK_SUCCESS: 已发送或已开始连接
+ * - LINX_SDK_ERROR_INVALID_PARAM: 参数为 NULL 或唤醒词为空
+ * - 其他: linx_sdk_connect() 的错误
+ * 
+ * @note 线程安全，可以在音频流水线线程上调用；断开连接时丢弃未发送的唤醒词
+ * 
+ * @see linx_sdk_send_wake_word(), linx_sdk_is_uplink_open()
+ */
+LinxSdkError linx_sdk_wake(LinxSdk* sdk, const char* wake_word);
+
+/**
+ * @brief 一级唤醒词检测命中、尚待二级确认：推测式地建立会话
+ * 
+ * 连接、hello 和开始监听与二级校验并行进行，确认（linx_sdk_wake()）时往往会话已经就绪，
+ * 唤醒到第一帧上行的时延不再包含建连耗时。确认之前上行保持关闭，音频暂存在连接前缓冲中，
+ * 服务端收不到任何语音。
+ * 
+ * - 音频通道已打开（正在对话）时什么都不做
+ * - 之前被 linx_sdk_wake_cancel() 停止监听、连接仍在时重新开始监听
+ * - 处于低功耗时先退出低功耗
+ * 
+ * 与 audio_wake 的两级检测配合：on_candidate 中调用本函数，on_wake 中调用 linx_sdk_wake()，
+ * on_reject 中调用 linx_sdk_wake_cancel()。
+ * 
+ * @param sdk SDK实例指针
+ * 
+ * @return 
+ * - LINX_SDK_SUCCESS: 已开始连接或会话已就绪
+ * - 其他: linx_sdk_connect() 的错误
+ * 
+ * @note 线程安全，可以在音频流水线线程上调用
+ */
+LinxSdkError linx_sdk_wake_speculative(LinxSdk* sdk);
+
+/**
+ * @brief 二级校验否决了唤醒：撤销 linx_sdk_wake_speculative() 开始的会话
+ * 
+ * 丢弃暂存的上行音频。会话已就绪时发送 abort 和 listen stop 并回到空闲状态，
+ * 会话尚未就绪时在就绪后这样做；连接保留，下一次唤醒不必重新建连。
+ * 没有推测式会话时什么都不做。
+ * 
+ * @param sdk SDK实例指针
+ * 
+ * @return LINX_SDK_SUCCESS，参数为 NULL 时返回 LINX_SDK_ERROR_INVALID_PARAM
+ * 
+ * @note 线程安全，可以在音频流水线线程上调用
+ */
+LinxSdkError linx_sdk_wake_cancel(LinxSdk* sdk);
+
+/**
+ * @brief 进入低功耗：对话之间让电池设备睡眠，不必销毁重建 LinxSdk
+ * 
+ * 依次执行：
+ * 1. 断开连接，保留会话状态：最近一次的 session_id、hello 协商结果和 TLS 会话留在内存中，
+ *    配置了 session_store 时同时已写入存储（重启后同样可以恢复）
+ * 2. 停止 linx_sdk_set_player() 设置的播放器（回收播放线程）
+ * 3. 调用 power_hooks.on_sleep，由应用停止采集流水线和音频设备
+ * 4. 触发 LINX_EVENT_SLEEP_ENTERED，之后应用可以让芯片进入深度睡眠
+ * 
+ * 配置 sleep_idle_ms 时，空闲超过该时长后SDK在自己的线程上自动调用本函数。
+ * 
+ * @param sdk SDK实例指针
+ * 
+ * @return 
+ * - LINX_SDK_SUCCESS: 已进入低功耗（或已经处于低功耗）；在事件线程上调用时为已提交
+ * - LINX_SDK_ERROR_INVALID_PARAM: sdk参数为NULL
+ * - LINX_SDK_ERROR_NOT_INITIALIZED: SDK未初始化
+ * - LINX_SDK_ERROR_UNKNOWN: 在事件线程上调用且无法创建执行线程
+ * 
+ * @note 线程安全；在事件回调（事件线程）中调用时转到单独的线程执行
+ * 
+ * @see linx_sdk_exit_sleep()
+ */
+LinxSdkError linx_sdk_enter_sleep(LinxSdk* sdk);
+
+/**
+ * @brief 退出低功耗：按最快的顺序恢复，连接建立与音频设备启动同时进行
+ * 
+ * 依次执行：
+ * 1. linx_sdk_connect()：DNS（地址缓存）、TCP、TLS（尝试恢复TLS会话）和 hello（请求恢复会话）
+ *    在事件线程上进行，本函数不等待
+ * 2. 调用 power_hooks.on_wake，由应用启动音频设备和采集流水线
+ * 3. 重新启动播放器
+ * 4. 触发 LINX_EVENT_SLEEP_EXITED，各步耗时记录在日志中
+ * 
+ * 唤醒词（低功耗核心或 DSP 上的检测）触发时直接调用 linx_sdk_wake()，它会先退出低功耗；
+ * 按键等其他唤醒源调用本函数。
+ * 
+ * @param sdk SDK实例指针
+ * 
+ * @return 
+ * - LINX_SDK_SUCCESS: 已退出低功耗（或本来就没有进入）
+ * - LINX_SDK_ERROR_INVALID_PARAM: sdk参数为NULL
+ * - LINX_SDK_ERROR_NOT_INITIALIZED: SDK未初始化
+ * - 其他: linx_sdk_connect() 的错误（音频设备和播放器仍已启动）
+ * 
+ * @note 线程安全，但不能在中断上下文中调用：中断里只通知任务，由任务调用本函数；
+ *       on_wake 在调用线程上执行，不要在音频流水线线程上调用
+ * 
+ * @see linx_sdk_enter_sleep()
+ */
+LinxSdkError linx_sdk_exit_sleep(LinxSdk* sdk);
+
+/**
+ * @brief 是否处于低功耗
+ * 
+ * @param sdk SDK实例指针
+ * @return 处于低功耗返回 true
+ * 
+ * @note 线程安全
+ */
+bool linx_sdk_is_sleeping(LinxSdk* sdk);
+
+/**
+ * @brief 音频通道是否已打开
  * 
- * 立即停止当前正在播放的TTS语音，并恢复语音监听。
+ * 服务端 hello 已处理、已开始监听时返回 true，此时 linx_sdk_send_audio() 直接发送，
+ * 不进入连接前缓冲。
  * 
  * @param sdk SDK实例指针
- * @param reason 中止原因，用于日志记录和事件通知
+ * @return 音频通道已打开返回 true；未连接、握手中或 sdk 为 NULL 返回 false
  * 
- * @return 
- * - LINX_SDK_SUCCESS: 中止成功
- * - LINX_SDK_ERROR_INVALID_PARAM: sdk参数为NULL
- * - LINX_SDK_ERROR_NOT_INITIALIZED: SDK未连接到服务器
+ * @note 线程安全
+ */
+bool linx_sdk_is_uplink_open(LinxSdk* sdk);
+
+/**
+ * @brief 本地打断正在播放的回复，不等待服务端的 tts stop
  * 
- * @note 
- * - 只有在TTS播放状态下调用才有效果
- * - 中止后会自动恢复语音监听
- * - 会触发相应的状态变化事件
+ * 设备处于 LINX_DEVICE_STATE_SPEAKING 时同时完成：
+ * - 清空 linx_sdk_set_player() 设置的播放器（含音频设备中排队的PCM），声音在一个音频周期内停止
+ * - 丢弃被打断回复剩余的下行音频和句子事件，直到服务端的 tts stop（不再上报）或下一个 tts start
+ * - 发送 abort，非实时模式下立即发送 listen start 重新开始监听
+ * - 状态切换到 LINX_DEVICE_STATE_LISTENING，并发出 LINX_EVENT_TTS_STOPPED
  * 
- * @warning 
- * - 确保在连接状态下调用此函数
+ * @param sdk SDK实例指针
+ * @param reason 打断原因，随 abort 发给服务端
  * 
- * @see linx_sdk_get_state(), LINX_EVENT_TTS_STOPPED
+ * @return 本次调用打断了播放返回 true；不在播放或已被其他线程打断时返回 false
  * 
- * @example
- * ```c
- * if (linx_sdk_get_state(sdk) == LINX_DEVICE_STATE_SPEAKING) {
- *     LinxSdkError result = linx_sdk_abort_speaking(sdk, LINX_ABORT_USER_INTERRUPT);
- *     if (result == LINX_SDK_SUCCESS) {
- *         printf("语音播放已中止\n");
- *     }
- * }
- * ```
+ * @note 此函数是线程安全的，可以在音频采集线程中调用；事件在调用线程上发出
+ * 
+ * @see linx_sdk_set_player(), linx_sdk_notify_speech_start(), LinxSdkConfig::barge_in
  */
-LinxSdkError linx_sdk_abort_speaking(LinxSdk* sdk, linx_abort_reason_t reason);
+bool linx_sdk_barge_in(LinxSdk* sdk, linx_abort_reason_t reason);
 
 /**
- * @brief 发送唤醒词
+ * @brief 上报本地 VAD 检测到用户开始说话
  * 
- * 向服务器发送唤醒词，用于激活语音交互会话。
+ * 在时间线上记录 LINX_TRACE_VAD_ONSET；开启 LinxSdkConfig::barge_in 且正在播放时
+ * 先调用 linx_sdk_barge_in() 打断。说话开始时调用一次即可（如 VAD 门由关到开时）。
  * 
  * @param sdk SDK实例指针
- * @param wake_word 唤醒词字符串，必须是UTF-8编码
  * 
  * @return 
- * - LINX_SDK_SUCCESS: 发送成功
- * - LINX_SDK_ERROR_INVALID_PARAM: sdk或wake_word参数为NULL
- * - LINX_SDK_ERROR_NOT_INITIALIZED: SDK未连接到服务器
- * - LINX_SDK_ERROR_NETWORK: 网络发送失败
+ * - LINX_SDK_SUCCESS: 成功
+ * - LINX_SDK_ERROR_INVALID_PARAM: sdk参数为NULL
+ */
+LinxSdkError linx_sdk_notify_speech_start(LinxSdk* sdk);
+
+/**
+ * @brief 上报本地 VAD 判定用户说完（尾部静音已达 LinxSdkConfig::local_endpoint_ms）
  * 
- * @note 
- * - 唤醒词用于启动新的对话会话
- * - 发送成功后可能会收到会话建立事件
- * - 支持自定义唤醒词
+ * AUTO_STOP 模式下由服务端 VAD 断句，要多等网络往返和服务端的静音拖尾才收到 stt。
+ * 开启 local_endpoint_ms 后设备自己断句：正在监听时先发出尚未攒满的上行合包，再发送
+ * listen stop，监听状态改为 LINX_LISTEN_STATE_STOPPED 并发出 LINX_EVENT_LISTENING_STOPPED。
+ * 本地 VAD 漏判时服务端照常断句。
  * 
- * @warning 
- * - 确保在连接状态下调用此函数
- * - 唤醒词不应为空字符串
+ * 通常接在上行流水线 VAD 门阶段的 on_speech_end 上，endpoint_ms 取 local_endpoint_ms
+ * （见 audio_stage_vad_gate_t）。
  * 
- * @see LINX_EVENT_SESSION_ESTABLISHED, linx_sdk_send_text()
+ * @param sdk SDK实例指针
  * 
- * @example
- * ```c
- * LinxSdkError result = linx_sdk_send_wake_word(sdk, "小助手");
- * if (result == LINX_SDK_SUCCESS) {
- *     printf("唤醒词已发送\n");
- * }
- * ```
+ * @return 
+ * - LINX_SDK_SUCCESS: 成功（未开启、非 AUTO_STOP 模式或不在监听时什么也不做）
+ * - LINX_SDK_ERROR_INVALID_PARAM: sdk参数为NULL
+ * 
+ * @note 线程安全，可以在音频流水线线程上调用；事件在调用线程上发出
  */
-LinxSdkError linx_sdk_send_wake_word(LinxSdk* sdk, const char* wake_word);
+LinxSdkError linx_sdk_notify_speech_end(LinxSdk* sdk);
+
+/**
+ * @brief 设置打断时清空的播放器
+ * 
+ * @param sdk SDK实例指针
+ * @param player 播放器，NULL 表示不再清空；需在SDK销毁或重新设置前保持有效
+ * 
+ * @return 
+ * - LINX_SDK_SUCCESS: 成功
+ * - LINX_SDK_ERROR_INVALID_PARAM: sdk参数为NULL
+ */
+LinxSdkError linx_sdk_set_player(LinxSdk* sdk, linx_player_t* player);
 
 /**
  * @brief 获取会话ID
@@ -760,6 +1903,351 @@ const char* linx_sdk_get_session_id(LinxSdk* sdk);
 LinxSdkError linx_sdk_add_mcp_tool(LinxSdk* sdk, const char* name, const char* description,
                                    mcp_property_list_t* properties, mcp_tool_callback_t callback);
 
+/**
+ * @brief 添加异步MCP工具
+ * 
+ * 与 linx_sdk_add_mcp_tool 相同，但回调在MCP线程池中执行，收消息的线程
+ * 立即返回，耗时的工具（网络查询、设备控制等）不会卡住音频。
+ * 
+ * @param sdk SDK实例指针
+ * @param name 工具名称
+ * @param description 工具描述
+ * @param properties 工具参数定义，可以为NULL
+ * @param callback 工具回调函数
+ * @param max_concurrency 该工具同时执行的最大调用数，超出的调用直接回复忙错误，<=0 取1
+ * @param timeout_ms 超时时间（毫秒），超时后回复错误并丢弃迟到的结果，0 使用默认值
+ * 
+ * @return 
+ * - LINX_SDK_SUCCESS: 添加成功
+ * - LINX_SDK_ERROR_INVALID_PARAM: 参数无效
+ * - LINX_SDK_ERROR_NOT_INITIALIZED: MCP服务器不可用
+ * - LINX_SDK_ERROR_UNKNOWN: 添加失败
+ * 
+ * @warning 回调在工作线程中执行，必须是线程安全的；超时无法中断回调本身
+ */
+LinxSdkError linx_sdk_add_async_mcp_tool(LinxSdk* sdk, const char* name, const char* description,
+                                         mcp_property_list_t* properties, mcp_tool_callback_t callback,
+                                         int max_concurrency, uint32_t timeout_ms);
+
+/**
+ * @brief 添加接收参数视图的MCP工具
+ * 
+ * arguments 按 properties 声明校验一次后以只读视图（mcp_arguments_t）传给回调，
+ * 可直接读取浮点数、64位整数、数组和对象参数；校验失败时直接回复错误。
+ * 
+ * @param sdk SDK实例指针
+ * @param name 工具名称
+ * @param description 工具描述
+ * @param properties 工具参数声明，可以为NULL
+ * @param callback 工具回调函数，视图只在回调期间有效
+ * 
+ * @return 
+ * - LINX_SDK_SUCCESS: 添加成功
+ * - LINX_SDK_ERROR_INVALID_PARAM: 参数无效
+ * - LINX_SDK_ERROR_NOT_INITIALIZED: MCP服务器不可用
+ * - LINX_SDK_ERROR_UNKNOWN: 添加失败
+ */
+LinxSdkError linx_sdk_add_mcp_tool_with_args(LinxSdk* sdk, const char* name, const char* description,
+                                             mcp_property_list_t* properties, mcp_tool_args_callback_t callback);
+
+/**
+ * @brief 注册编译期声明的静态MCP工具表
+ * 
+ * 固件中固定的工具表用 MCP_STATIC_TOOLS_DEFINE（mcp/mcp_static_tool.h）声明，
+ * 参数和 tools/list JSON 都是常量，注册时不创建属性、不序列化。
+ * 
+ * @param sdk SDK实例指针
+ * @param tools 工具指针数组
+ * @param count 工具数（MCP_STATIC_TOOLS_COUNT）
+ * 
+ * @return 
+ * - LINX_SDK_SUCCESS: 全部注册成功
+ * - LINX_SDK_ERROR_INVALID_PARAM: 参数无效
+ * - LINX_SDK_ERROR_NOT_INITIALIZED: MCP服务器不可用
+ * - LINX_SDK_ERROR_UNKNOWN: 工具重名或内存不足，失败之前的工具保持注册
+ */
+LinxSdkError linx_sdk_add_static_mcp_tools(LinxSdk* sdk, mcp_tool_t* const* tools, size_t count);
+
+/**
+ * @brief 移除MCP工具
+ * 
+ * 用于按需注册的工具（例如每个配对配件一组控制工具）在配件解绑时注销。
+ * 仍在执行的异步调用会正常完成并回复，之后工具才被销毁。
+ * 
+ * @param sdk SDK实例指针
+ * @param name 工具名称
+ * 
+ * @return 
+ * - LINX_SDK_SUCCESS: 移除成功
+ * - LINX_SDK_ERROR_INVALID_PARAM: 参数无效或工具不存在
+ * - LINX_SDK_ERROR_NOT_INITIALIZED: MCP服务器不可用
+ */
+LinxSdkError linx_sdk_remove_mcp_tool(LinxSdk* sdk, const char* name);
+
+/**
+ * @brief 发布设备状态等 JSON 对象，经 MCP 增量同步给服务端
+ * 
+ * 服务端在 initialize 中声明 capabilities.stateSync.mergePatch 后，每次发布只发送相对于
+ * 其最后确认版本的 JSON Merge Patch（RFC 7386），适合数 KB、每次只变一两个字段的状态对象；
+ * 工具表的变化由SDK自动同步。协议见 mcp/mcp_state_sync.h。
+ * 
+ * @param sdk SDK实例指针
+ * @param resource 资源名（如 "device"），不能是 "tools"
+ * @param state 完整的状态对象，SDK 复制后保存，调用者保留所有权；NULL 表示删除
+ * 
+ * @return 
+ * - LINX_SDK_SUCCESS: 已记录（内容未变化时不发送）
+ * - LINX_SDK_ERROR_INVALID_PARAM: 参数无效、资源名保留或资源数已满
+ * - LINX_SDK_ERROR_NOT_INITIALIZED: MCP服务器不可用
+ */
+LinxSdkError linx_sdk_publish_mcp_state(LinxSdk* sdk, const char* resource, const cJSON* state);
+
+/**
+ * @brief 把本地识别的命令绑定到 MCP 工具
+ * 
+ * 常用的设备命令（调音量、停止播放、开关灯）在设备上识别后直接调用已注册的工具，
+ * 不经过上行音频、服务端识别和大模型，离线时同样可用。命令由 audio_command
+ * （audio/audio_command.h）的识别器报告，on_command 中调用 linx_sdk_run_local_command()。
+ * 同一命令重复绑定时替换原绑定。
+ * 
+ * @param sdk SDK实例指针
+ * @param command 命令名（识别器的关键词），不超过 31 字节
+ * @param tool_name 工具名称，调用时才查找，可以晚于绑定注册
+ * @param arguments_json 工具参数，JSON 对象文本（如 "{\"volume\":80}"），不超过 127 字节；NULL 表示无参数
+ * 
+ * @return 
+ * - LINX_SDK_SUCCESS: 绑定成功
+ * - LINX_SDK_ERROR_INVALID_PARAM: 参数为空、过长、参数不是 JSON 对象或绑定数已满
+ * - LINX_SDK_ERROR_NOT_INITIALIZED: MCP服务器不可用
+ * 
+ * @example
+ * ```c
+ * linx_sdk_bind_local_command(sdk, "volume_up", "self.audio_speaker.set_volume", "{\"volume\":80}");
+ * linx_sdk_bind_local_command(sdk, "light_off", "self.light.turn_off", NULL);
+ * 
+ * static void on_command(void* user_data, const char* command) {
+ *     linx_sdk_run_local_command((LinxSdk*)user_data, command);
+ * }
+ * static bool command_enabled(void* user_data) {
+ *     // 对话中的指令交给服务端，只在空闲时走本地路径
+ *     return linx_sdk_get_state((LinxSdk*)user_data) == LINX_DEVICE_STATE_IDLE;
+ * }
+ * ```
+ * 
+ * @see linx_sdk_run_local_command(), mcp_server_call_tool_local()
+ */
+LinxSdkError linx_sdk_bind_local_command(LinxSdk* sdk, const char* command, const char* tool_name,
+                                         const char* arguments_json);
+
+/**
+ * @brief 执行本地识别的命令
+ * 
+ * 按 linx_sdk_bind_local_command() 的绑定在调用线程上同步调用工具，随后把调用经
+ * notifications/tools/local_call 告知服务端，服务端据此把操作补进对话上下文；
+ * 未连接时通知排队（最多 MCP_LOCAL_CALL_BACKLOG 条），下次会话 initialize 之后发送。
+ * 
+ * @param sdk SDK实例指针
+ * @param command 命令名
+ * 
+ * @return 
+ * - LINX_SDK_SUCCESS: 工具执行成功
+ * - LINX_SDK_ERROR_INVALID_PARAM: 参数为空或命令没有绑定
+ * - LINX_SDK_ERROR_NOT_INITIALIZED: MCP服务器不可用
+ * - LINX_SDK_ERROR_UNKNOWN: 工具不存在或执行失败
+ * 
+ * @note 线程安全，通常在音频流水线线程上调用；工具回调在调用线程上执行（异步工具也不进入线程池），
+ *       绑定的工具应当很快返回，以免耽误采集
+ */
+LinxSdkError linx_sdk_run_local_command(LinxSdk* sdk, const char* command);
+
+// ============================================================================
+// OTA相关函数
+// ============================================================================
+
+/**
+ * @brief 在SDK事件线程上异步检查固件更新
+ * 
+ * 请求交给事件线程，在WebSocket所用的 mongoose 管理器上发出，调用线程立即返回。
+ * 结果通过 LINX_EVENT_OTA_CHECKED 事件通知，data.ota.info 为检查结果。
+ * 
+ * @param sdk SDK实例指针
+ * 
+ * @return 
+ * - LINX_SDK_SUCCESS: 请求已提交
+ * - LINX_SDK_ERROR_INVALID_PARAM: sdk参数为NULL
+ * - LINX_SDK_ERROR_NOT_INITIALIZED: SDK未连接，事件线程未运行，或未设置OTA对象
+ * 
+ * @note 
+ * - 需先用 linx_ota_create() 创建OTA对象并设置到 LinxSdkConfig::ota，每个OTA对象同一时间只运行一个操作
+ * - 启动失败（如已有操作在进行）时同样通过 LINX_EVENT_OTA_CHECKED 报告
+ * - 开启 LinxSdkConfig::fast_boot 时检查和下载在第一轮对话结束后才启动
+ * 
+ * @see linx_sdk_ota_download_async(), LINX_EVENT_OTA_CHECKED
+ */
+LinxSdkError linx_sdk_ota_check_async(LinxSdk* sdk);
+
+/**
+ * @brief 在SDK事件线程上异步下载固件
+ * 
+ * 与 linx_ota_download_to_sink() 行为相同（流式写入、校验、Range 续传），
+ * 但在事件线程上非阻塞运行。进度通过 LINX_EVENT_OTA_PROGRESS 通知，
+ * 结束时触发 LINX_EVENT_OTA_COMPLETED。配置 linx_ota_config_t::max_download_rate
+ * 可限制下载带宽，避免挤占语音WebSocket；对话中按 LinxSdkConfig::ota_session_rate
+ * 暂停（默认）或进一步限速，回到空闲后全速继续。
+ * 
+ * @param sdk SDK实例指针
+ * @param info 固件信息（LINX_EVENT_OTA_CHECKED 的结果，会被复制）
+ * @param sink 下载目标，由应用持有
+ * 
+ * @return 
+ * - LINX_SDK_SUCCESS: 请求已提交
+ * - LINX_SDK_ERROR_INVALID_PARAM: 参数为NULL
+ * - LINX_SDK_ERROR_NOT_INITIALIZED: SDK未连接，事件线程未运行，或未设置OTA对象
+ * 
+ * @warning sink 必须保持有效，直到收到 LINX_EVENT_OTA_COMPLETED 或断开连接
+ * 
+ * @see linx_sdk_ota_cancel(), LINX_EVENT_OTA_COMPLETED
+ */
+LinxSdkError linx_sdk_ota_download_async(LinxSdk* sdk, const linx_ota_info_t* info, linx_ota_sink_t* sink);
+
+/**
+ * @brief 取消本实例启动的OTA操作
+ * 
+ * 取消在事件线程的下一轮循环中生效，之后不再触发完成事件。支持续传的下载
+ * 会保留已下载部分。断开连接时会自动取消。
+ * 
+ * @param sdk SDK实例指针
+ * 
+ * @return 
+ * - LINX_SDK_SUCCESS: 请求已提交
+ * - LINX_SDK_ERROR_INVALID_PARAM: sdk参数为NULL
+ * - LINX_SDK_ERROR_NOT_INITIALIZED: SDK未连接，事件线程未运行，或未设置OTA对象
+ */
+LinxSdkError linx_sdk_ota_cancel(LinxSdk* sdk);
+
+/**
+ * @brief 距离下一个通常不对话的时段还有多久，用于安排固件下载
+ * 
+ * SDK按本地时间的小时统计开始对话的次数（较早的记录逐渐衰减）。对话次数不超过
+ * 平均值一半的小时视为空闲时段。应用收到 LINX_EVENT_OTA_CHECKED 发现有更新时，
+ * 可以等到空闲时段再调用 linx_sdk_ota_download_async()，下载与对话撞车的机会更小。
+ * 下载期间发生的对话仍按 ota_session_rate 让出带宽。
+ * 
+ * @param sdk SDK实例指针
+ * 
+ * @return 秒数；当前已在空闲时段、统计还不够或参数为NULL时返回 0
+ * 
+ * @note 线程安全；统计只在内存中，重启后重新积累
+ */
+uint32_t linx_sdk_ota_quiet_delay_s(LinxSdk* sdk);
+
+/**
+ * @brief 获取各服务器端点的健康度记录
+ * 
+ * 有多个端点（server_url 与 server_urls，或 OTA 检查给出的 websocket.urls）时，SDK 在
+ * 空闲时按 endpoint_probe_ms 依次测量未连接端点的 RTT（一次 TCP 建连，不做 TLS 握手），
+ * 已连接端点的 RTT 和丢包取自 WebSocket 保活；每次拨号记下握手耗时，拨号失败和异常断开
+ * 计入错误率。连接时选择得分最低的端点；拨号失败或连接断开后，重连立即换到下一个
+ * 得分最低、不在冷却期的端点，不等待退避增长。
+ * 
+ * @param sdk SDK实例指针
+ * @param endpoints 输出的快照
+ * @param current 当前使用的端点下标，-1 为没有；可为NULL
+ * 
+ * @return 成功返回 LINX_SDK_SUCCESS
+ * 
+ * @note 线程安全
+ */
+LinxSdkError linx_sdk_get_endpoints(LinxSdk* sdk, linx_endpoints_t* endpoints, int* current);
+
+// ============================================================================
+// 异步操作句柄 (见 linx_future.h)
+// ============================================================================
+
+/**
+ * @brief 连接并返回等待会话建立的句柄
+ * 
+ * 调用 linx_sdk_connect()，收到服务端 hello 时完成，状态码为 LINX_SDK_SUCCESS；
+ * 连接失败且不再重连时以 LINX_SDK_ERROR_NETWORK 完成，linx_sdk_connect() 出错时
+ * 立即以其错误码完成。会话已建立时返回已完成的句柄，连接中再次调用返回同一个句柄。
+ * 句柄在SDK事件循环上完成，后续回调运行在事件循环上。
+ * 
+ * @param sdk SDK实例指针
+ * @return 句柄（用完后 linx_future_release()），参数无效或内存不足返回NULL
+ */
+linx_future_t* linx_sdk_connect_future(LinxSdk* sdk);
+
+/**
+ * @brief 检查OTA更新并返回等待结果的句柄
+ * 
+ * 同 linx_sdk_ota_check_async()，结果也仍然通过 LINX_EVENT_OTA_CHECKED 通知。
+ * 状态码为 linx_ota_status_t；LINX_OTA_SUCCESS 时数据为 linx_ota_info_t。
+ * 取消句柄会取消检查。已有OTA操作在进行时以 LINX_OTA_IN_PROGRESS 完成；
+ * 操作被 linx_sdk_ota_cancel()、断开连接或尚未启动时被新的OTA请求覆盖时以
+ * LINX_OTA_ERROR_REQUEST 完成；SDK未连接等无法提交时以 LINX_OTA_ERROR_INIT 完成。
+ * 
+ * @param sdk SDK实例指针
+ * @return 句柄（用完后 linx_future_release()），参数无效或内存不足返回NULL
+ */
+linx_future_t* linx_sdk_ota_check_future(LinxSdk* sdk);
+
+/**
+ * @brief 下载固件并返回等待结果的句柄
+ * 
+ * 同 linx_sdk_ota_download_async()，进度仍然通过 LINX_EVENT_OTA_PROGRESS 通知。
+ * 状态码为 linx_ota_status_t，取消句柄会取消下载；其余同 linx_sdk_ota_check_future()。
+ * 
+ * @param sdk SDK实例指针
+ * @param info 固件信息（会被复制）
+ * @param sink 下载目标，必须保持有效直到句柄完成
+ * @return 句柄（用完后 linx_future_release()），参数无效或内存不足返回NULL
+ */
+linx_future_t* linx_sdk_ota_download_future(LinxSdk* sdk, const linx_ota_info_t* info, linx_ota_sink_t* sink);
+
+// ============================================================================
+// 消息分发函数
+// ============================================================================
+
+/**
+ * @brief 注册服务器消息类型处理函数
+ * 
+ * 按消息的 "type" 字段把服务器下发的JSON消息分发到处理函数。SDK内置了
+ * hello、tts、stt、llm、mcp、system、alert、custom 的处理函数，应用程序可以
+ * 为新的消息类型添加处理函数，也可以替换内置处理函数。
+ * 
+ * @param sdk SDK实例指针
+ * @param type 消息类型字符串（长度小于 LINX_MESSAGE_ROUTER_MAX_TYPE_LEN）
+ * @param handler 处理函数，传NULL表示注销该类型
+ * @param user_data 传给处理函数的用户数据
+ * 
+ * @return 
+ * - LINX_SDK_SUCCESS: 注册成功
+ * - LINX_SDK_ERROR_INVALID_PARAM: sdk或type为NULL
+ * - LINX_SDK_ERROR_NOT_INITIALIZED: SDK未正确初始化
+ * - LINX_SDK_ERROR_MEMORY: 路由表已满或类型名过长
+ * 
+ * @note 
+ * - 处理函数在WebSocket事件线程中被调用，应避免长时间阻塞
+ * - root 仅在回调期间有效，需要保留数据时应自行复制
+ * - 连接期间也可以注册或注销；注销返回时已经开始的分发仍可能调用一次旧的处理函数，
+ *   释放 user_data 前应先断开连接或在处理函数中自行同步
+ * - 替换内置类型（如 "tts"）后SDK不再处理该类型的内部状态
+ * 
+ * @see linx_message_handler_t
+ * 
+ * @example
+ * ```c
+ * static void on_iot_message(const cJSON* root, void* user_data) {
+ *     const cJSON* cmd = cJSON_GetObjectItemCaseSensitive(root, "command");
+ *     // 处理设备控制命令
+ * }
+ * 
+ * linx_sdk_register_message_handler(sdk, "iot", on_iot_message, NULL);
+ * ```
+ */
+LinxSdkError linx_sdk_register_message_handler(LinxSdk* sdk, const char* type,
+                                               linx_message_handler_t handler, void* user_data);
+
 
 // ============================================================================
 // 事件处理函数
@@ -770,6 +2258,17 @@ LinxSdkError linx_sdk_add_mcp_tool(LinxSdk* sdk, const char* name, const char* d
  * 
  * 主动轮询SDK事件，用于在没有设置事件回调或需要同步处理事件的场景。
  * 
+ * event_loop_mode 为 LINX_EVENT_LOOP_EXTERNAL 时，在调用线程上驱动整个SDK：轮询网络
+ * （最多等待 timeout_ms）、执行重连/OTA/RTT测量，并处理收到的消息；MCP工具也在此同步执行。
+ * 此时事件回调都在调用线程上执行，派发方式为 POLL 时本次收到的事件在返回前派发。
+ * 
+ * 设置了 LinxSdkConfig::reactor 时网络由 reactor 驱动（linx_reactor_start() 或
+ * linx_reactor_poll()），本函数只派发 POLL 方式排队的事件；MCP工具在 reactor 的循环上下文中同步执行。
+ * 
+ * 其他事件循环模式下，event_delivery 为 LINX_EVENT_DELIVERY_POLL 时在调用线程上取出
+ * 队列中的事件并依次调用事件回调：队列为空时最多等待 timeout_ms，取到事件后把已排队的
+ * 事件全部派发；其他派发方式下立即返回。
+ * 
  * @param sdk SDK实例指针
  * @param timeout_ms 超时时间（毫秒），-1表示无限等待，0表示立即返回
  * 
@@ -804,6 +2303,53 @@ LinxSdkError linx_sdk_add_mcp_tool(LinxSdk* sdk, const char* name, const char* d
  */
 LinxSdkError linx_sdk_poll_events(LinxSdk* sdk, int timeout_ms);
 
+/**
+ * @brief 获取外部循环需要监听的文件描述符
+ * 
+ * 用于把SDK并入应用自己的 epoll/kqueue/select：等待这些描述符就绪（want_write 为 true 时
+ * 同时等待可写）或超时（见 linx_sdk_get_poll_timeout_ms()）后调用 linx_sdk_poll_events(sdk, 0)。
+ * 描述符集合在每次 linx_sdk_poll_events() 后可能变化，需要重新获取。
+ * 仅 LINX_EVENT_LOOP_EXTERNAL 模式下可用，且只能在调用 linx_sdk_poll_events() 的线程中调用。
+ * 
+ * @param sdk SDK实例指针
+ * @param fds 输出数组
+ * @param max_fds 数组容量
+ * @return 描述符总数（可能大于 max_fds，此时只填充前 max_fds 个）；未连接时返回 0
+ */
+size_t linx_sdk_get_poll_fds(LinxSdk* sdk, LinxPollFd* fds, size_t max_fds);
+
+/**
+ * @brief 获取外部循环在没有描述符就绪时的最长等待时间
+ * 
+ * 考虑了待执行的重连和OTA定时器，不超过 LINX_SDK_EVENT_LOOP_IDLE_TIMEOUT_MS。
+ * 
+ * @param sdk SDK实例指针
+ * @return 等待时间（毫秒）
+ */
+int linx_sdk_get_poll_timeout_ms(LinxSdk* sdk);
+
+/**
+ * @brief 在事件回调返回后继续持有事件
+ * 
+ * 队列派发的事件只增加引用计数，不复制；同步回调的事件（owner 为 NULL）复制一份，
+ * 字符串、OTA信息和音频数据包都归返回的事件所有。音频批次事件不能持有，需要时
+ * 逐个保留其中的数据包。
+ * 
+ * @param sdk SDK实例指针
+ * @param event 事件回调收到的事件
+ * @return 可在任意线程使用的事件，用完后调用 linx_sdk_event_release()；失败返回 NULL
+ * 
+ * @warning 必须在 linx_sdk_destroy() 之前释放全部持有的事件
+ */
+LinxEvent* linx_sdk_event_retain(LinxSdk* sdk, const LinxEvent* event);
+
+/**
+ * @brief 释放 linx_sdk_event_retain() 返回的事件
+ * 
+ * @param event 事件，NULL 时不做任何操作
+ */
+void linx_sdk_event_release(LinxEvent* event);
+
 #ifdef __cplusplus
 }
 #endif
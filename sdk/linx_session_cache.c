@@ -0,0 +1,220 @@
+/**
+ * @file linx_session_cache.c
+ * @brief 掉电保留的会话缓存实现
+ */
+
+#include "linx_session_cache.h"
+#include "log/linx_log.h"
+#include <stdio.h>
+#include <string.h>
+
+#define SESSION_CACHE_HELLO_MAGIC   0x4C484C4Fu     // "LHLO"
+#define SESSION_CACHE_HELLO_VERSION 1
+
+/* hello 项的记录；同一固件读写，结构体直接落盘，版本和大小对不上时丢弃 */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;
+    char session_id[64];
+    linx_websocket_session_params_t params;
+} session_cache_hello_record_t;
+
+/* 文件存储 */
+
+static bool kv_file_path(const char* dir, const char* key, char* path, size_t size) {
+    int n = snprintf(path, size, "%s/%s", dir, key);
+    return n > 0 && (size_t)n < size;
+}
+
+static bool kv_file_load(void* user_data, const char* key, void* value, size_t size, size_t* length) {
+    char path[512];
+    if (!kv_file_path((const char*)user_data, key, path, sizeof(path))) {
+        return false;
+    }
+    FILE* fp = fopen(path, "rb");
+    if (!fp) {
+        return false;
+    }
+    // 多读一个字节判断是否放得下
+    uint8_t extra;
+    size_t n = fread(value, 1, size, fp);
+    bool fits = n < size || fread(&extra, 1, 1, fp) == 0;
+    fclose(fp);
+    *length = n;
+    return fits;
+}
+
+static bool kv_file_store(void* user_data, const char* key, const void* value, size_t length) {
+    char path[512];
+    char tmp_path[520];
+    if (!kv_file_path((const char*)user_data, key, path, sizeof(path))) {
+        return false;
+    }
+    if (length == 0) {
+        remove(path);
+        return true;
+    }
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    FILE* fp = fopen(tmp_path, "wb");
+    if (!fp) {
+        return false;
+    }
+    bool ok = fwrite(value, length, 1, fp) == 1;
+    ok = fclose(fp) == 0 && ok;
+    if (!ok || rename(tmp_path, path) != 0) {
+        remove(tmp_path);
+        return false;
+    }
+    return true;
+}
+
+linx_kv_store_t linx_kv_file_store(const char* dir) {
+    linx_kv_store_t store = { kv_file_load, kv_file_store, (void*)dir };
+    return store;
+}
+
+/* 缓存 */
+
+static bool store_ready(const linx_kv_store_t* store) {
+    return store && store->load && store->store;
+}
+
+static bool cache_store(const linx_kv_store_t* store, const char* key, const void* value, size_t length) {
+    if (!store_ready(store)) {
+        return true;
+    }
+    if (!store->store(store->user_data, key, value, length)) {
+        LOG_WARN("会话缓存 %s 写入失败", key);
+        return false;
+    }
+    return true;
+}
+
+bool linx_session_cache_load(const linx_kv_store_t* store, linx_session_cache_t* cache) {
+    if (!cache) {
+        return false;
+    }
+    memset(cache, 0, sizeof(*cache));
+    if (!store_ready(store)) {
+        return false;
+    }
+
+    size_t length = 0;
+    bool found = false;
+    if (store->load(store->user_data, LINX_SESSION_CACHE_KEY_URL, cache->websocket_url,
+                    sizeof(cache->websocket_url) - 1, &length)) {
+        cache->websocket_url[length] = '\0';
+        found = found || length > 0;
+    } else {
+        cache->websocket_url[0] = '\0';
+    }
+
+    session_cache_hello_record_t hello;
+    if (store->load(store->user_data, LINX_SESSION_CACHE_KEY_HELLO, &hello, sizeof(hello), &length) &&
+        length == sizeof(hello) && hello.magic == SESSION_CACHE_HELLO_MAGIC &&
+        hello.version == SESSION_CACHE_HELLO_VERSION && hello.size == sizeof(hello)) {
+        hello.session_id[sizeof(hello.session_id) - 1] = '\0';
+        hello.params.audio_format[sizeof(hello.params.audio_format) - 1] = '\0';
+        memcpy(cache->session_id, hello.session_id, sizeof(cache->session_id));
+        cache->params = hello.params;
+        cache->has_params = true;
+        found = true;
+    }
+
+    if (store->load(store->user_data, LINX_SESSION_CACHE_KEY_TLS, cache->tls_session,
+                    sizeof(cache->tls_session), &length)) {
+        cache->tls_session_len = length;
+        found = found || length > 0;
+    }
+
+    uint64_t tools_hash = 0;
+    if (store->load(store->user_data, LINX_SESSION_CACHE_KEY_TOOLS, &tools_hash, sizeof(tools_hash), &length) &&
+        length == sizeof(tools_hash)) {
+        cache->tools_hash = tools_hash;
+        cache->has_tools_hash = true;
+        found = true;
+    }
+
+    if (found) {
+        LOG_INFO("已读取会话缓存: 地址 %s，hello %s，TLS 会话 %zu 字节，工具表摘要 %s",
+                 cache->websocket_url[0] ? cache->websocket_url : "无", cache->has_params ? "有" : "无",
+                 cache->tls_session_len, cache->has_tools_hash ? "有" : "无");
+    }
+    return found;
+}
+
+bool linx_session_cache_update(const linx_kv_store_t* store, linx_session_cache_t* cache,
+                               const linx_session_cache_t* fresh) {
+    if (!cache || !fresh) {
+        return false;
+    }
+    bool ok = true;
+
+    if (fresh->websocket_url[0] && strcmp(fresh->websocket_url, cache->websocket_url) != 0) {
+        if (cache_store(store, LINX_SESSION_CACHE_KEY_URL, fresh->websocket_url, strlen(fresh->websocket_url))) {
+            snprintf(cache->websocket_url, sizeof(cache->websocket_url), "%s", fresh->websocket_url);
+        } else {
+            ok = false;
+        }
+    }
+
+    if (fresh->has_params &&
+        (!cache->has_params || strcmp(fresh->session_id, cache->session_id) != 0 ||
+         memcmp(&fresh->params, &cache->params, sizeof(fresh->params)) != 0)) {
+        session_cache_hello_record_t hello;
+        memset(&hello, 0, sizeof(hello));
+        hello.magic = SESSION_CACHE_HELLO_MAGIC;
+        hello.version = SESSION_CACHE_HELLO_VERSION;
+        hello.size = sizeof(hello);
+        snprintf(hello.session_id, sizeof(hello.session_id), "%s", fresh->session_id);
+        hello.params = fresh->params;
+        if (cache_store(store, LINX_SESSION_CACHE_KEY_HELLO, &hello, sizeof(hello))) {
+            memcpy(cache->session_id, hello.session_id, sizeof(cache->session_id));
+            cache->params = fresh->params;
+            cache->has_params = true;
+        } else {
+            ok = false;
+        }
+    }
+
+    if (fresh->tls_session_len > 0 && fresh->tls_session_len <= sizeof(cache->tls_session) &&
+        (fresh->tls_session_len != cache->tls_session_len ||
+         memcmp(fresh->tls_session, cache->tls_session, fresh->tls_session_len) != 0)) {
+        if (cache_store(store, LINX_SESSION_CACHE_KEY_TLS, fresh->tls_session, fresh->tls_session_len)) {
+            memcpy(cache->tls_session, fresh->tls_session, fresh->tls_session_len);
+            cache->tls_session_len = fresh->tls_session_len;
+        } else {
+            ok = false;
+        }
+    }
+
+    if (fresh->has_tools_hash && (!cache->has_tools_hash || fresh->tools_hash != cache->tools_hash)) {
+        if (cache_store(store, LINX_SESSION_CACHE_KEY_TOOLS, &fresh->tools_hash, sizeof(fresh->tools_hash))) {
+            cache->tools_hash = fresh->tools_hash;
+            cache->has_tools_hash = true;
+        } else {
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+void linx_session_cache_forget(const linx_kv_store_t* store, linx_session_cache_t* cache, const char* key) {
+    if (!cache || !key) {
+        return;
+    }
+    cache_store(store, key, NULL, 0);
+    if (strcmp(key, LINX_SESSION_CACHE_KEY_URL) == 0) {
+        cache->websocket_url[0] = '\0';
+    } else if (strcmp(key, LINX_SESSION_CACHE_KEY_HELLO) == 0) {
+        cache->session_id[0] = '\0';
+        memset(&cache->params, 0, sizeof(cache->params));
+        cache->has_params = false;
+    } else if (strcmp(key, LINX_SESSION_CACHE_KEY_TLS) == 0) {
+        cache->tls_session_len = 0;
+    } else if (strcmp(key, LINX_SESSION_CACHE_KEY_TOOLS) == 0) {
+        cache->tools_hash = 0;
+        cache->has_tools_hash = false;
+    }
+}
@@ -0,0 +1,108 @@
+/**
+ * @file linx_session_cache.h
+ * @brief 掉电保留的会话缓存（重启后立即连接）
+ *
+ * 冷启动时设备通常要先做一次 OTA 检查拿到 websocket_url，再连接、完成 TLS 握手和 hello
+ * 协商，最后服务端还会重新拉取 MCP 工具表。本缓存把这些结果写入一个小的键值存储，
+ * 重启后直接用缓存的地址连接：
+ *
+ * - websocket_url：上次 OTA 检查给出的服务器地址，配置的 server_url 为空时使用，
+ *   连接建立后在后台重新做 OTA 检查，地址变化时更新缓存（下次连接生效）
+ * - hello：上次的 session_id 和协商结果，服务端支持会话恢复时第一条 hello 就请求恢复
+ *   (见 linx_websocket_set_resume_state())
+ * - TLS 会话：wss 握手尝试恢复上次的 TLS 会话，省去完整握手（需 mbedTLS 后端，
+ *   见 linx_websocket_set_tls_session()）
+ * - MCP 工具表摘要：服务端上次取得的工具表的哈希，工具表未变时在 hello 中带上，
+ *   服务端可跳过 tools/list
+ *
+ * 每项是存储中的一个键，只在内容变化时写入，避免每次连接都写 flash。存储由应用提供
+ * (NVS、文件系统等)，也可以用 linx_kv_file_store() 把每个键存为目录下的一个文件，
+ * 或用 linx_kv_session_store() 放进日志结构的键值存储（linx_kv.h，批量写入、不阻塞调用方）。
+ * 缓存只是提示：任何一项缺失、损坏或被服务端拒绝时照常走完整流程。
+ */
+
+#ifndef LINX_SESSION_CACHE_H
+#define LINX_SESSION_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "protocols/linx_websocket.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* TLS 会话的最大字节数（mbedtls_ssl_session_save() 的输出，含票据），更大的会话不缓存 */
+#ifndef LINX_SESSION_CACHE_TLS_MAX
+#define LINX_SESSION_CACHE_TLS_MAX 1024
+#endif
+
+/* 各项在存储中的键 */
+#define LINX_SESSION_CACHE_KEY_URL      "linx.ws_url"
+#define LINX_SESSION_CACHE_KEY_HELLO    "linx.hello"
+#define LINX_SESSION_CACHE_KEY_TLS      "linx.tls"
+#define LINX_SESSION_CACHE_KEY_TOOLS    "linx.tools"
+
+/* 键值存储（回调可能在SDK事件线程上调用，应当很快返回） */
+typedef struct {
+    /**
+     * 读取一个键
+     * @param value 输出缓冲区
+     * @param size 缓冲区大小
+     * @param length 输出值的字节数
+     * @return 键存在且放得下返回 true
+     */
+    bool (*load)(void* user_data, const char* key, void* value, size_t size, size_t* length);
+    /* 写入一个键（length 为 0 时删除），成功返回 true */
+    bool (*store)(void* user_data, const char* key, const void* value, size_t length);
+    void* user_data;
+} linx_kv_store_t;
+
+/* 缓存内容；字符串为空、has_* 为 false 或长度为 0 表示该项没有缓存 */
+typedef struct {
+    char websocket_url[256];        // OTA 检查给出的服务器地址
+    char session_id[64];            // 上次会话的 session_id
+    linx_websocket_session_params_t params; // 上次的 hello 协商结果
+    bool has_params;
+    uint8_t tls_session[LINX_SESSION_CACHE_TLS_MAX]; // 上次的 TLS 会话
+    size_t tls_session_len;
+    uint64_t tools_hash;            // 服务端上次取得的 MCP 工具表的哈希
+    bool has_tools_hash;
+} linx_session_cache_t;
+
+/**
+ * 基于文件的存储：每个键存为 dir 下的同名文件，先写临时文件再改名，掉电不会留下半条记录
+ * @param dir 目录，不复制，必须一直有效
+ */
+linx_kv_store_t linx_kv_file_store(const char* dir);
+
+/**
+ * 从存储读取缓存；缺失或损坏的项保持为空
+ * @return 至少读到一项返回 true
+ */
+bool linx_session_cache_load(const linx_kv_store_t* store, linx_session_cache_t* cache);
+
+/**
+ * 写入与 cache 不同的项，并把它们复制到 cache
+ *
+ * fresh 中为空的项表示"没有新值"，保留原有的缓存；要删除某一项用 linx_session_cache_forget()。
+ * store 为 NULL 时只更新内存中的 cache（不跨重启，如低功耗睡眠期间保留会话）。
+ * @param cache 当前缓存（上次 load 或 update 的结果）
+ * @param fresh 新的内容
+ * @return 写入失败返回 false（cache 中失败的项保持原样）
+ */
+bool linx_session_cache_update(const linx_kv_store_t* store, linx_session_cache_t* cache,
+                               const linx_session_cache_t* fresh);
+
+/**
+ * 删除一项（如服务端拒绝了缓存的会话）
+ * @param key LINX_SESSION_CACHE_KEY_*
+ */
+void linx_session_cache_forget(const linx_kv_store_t* store, linx_session_cache_t* cache, const char* key);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINX_SESSION_CACHE_H */
@@ -0,0 +1,298 @@
+/**
+ * @file linx_timer.c
+ * @brief 分层时间轮定时器实现
+ */
+
+#include "linx_timer.h"
+#include "os/linx_os.h"
+#include "log/linx_alloc.h"
+#include <limits.h>
+#include <string.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_CORE);
+
+#define LINX_TIMER_SLOT_BITS 6
+#define LINX_TIMER_SLOT_MASK (LINX_TIMER_SLOTS - 1)
+
+/** 不级联时能放置的最大节拍数（最高级的跨度） */
+#define LINX_TIMER_MAX_DELTA (((uint64_t)1 << (LINX_TIMER_SLOT_BITS * LINX_TIMER_LEVELS)) - 1)
+
+/** level 字段：在到期链表中 */
+#define LINX_TIMER_LEVEL_EXPIRED LINX_TIMER_LEVELS
+
+struct linx_timer_wheel {
+    linx_timer_clock_t clock;
+    uint32_t tick_ms;
+    uint64_t base_ms;                                       // 第 0 个节拍对应的时刻
+    uint64_t now_tick;                                      // 已处理到的节拍
+    size_t pending;                                         // 已安排的定时器数
+    uint64_t occupied[LINX_TIMER_LEVELS];                   // 每级的非空槽位位图
+    linx_timer_t* slots[LINX_TIMER_LEVELS][LINX_TIMER_SLOTS];
+    linx_timer_t* expired;                                  // 安排时已到期，下一次推进时触发
+};
+
+static uint64_t linx_timer_default_clock(void) {
+    return linx_os_now_ms();
+}
+
+/* 循环右移，使 shift 号槽位落到第 0 位 */
+static uint64_t linx_timer_rotate(uint64_t bits, unsigned shift) {
+    return shift == 0 ? bits : bits >> shift | bits << (64 - shift);
+}
+
+static void linx_timer_link(linx_timer_t** head, linx_timer_t* timer) {
+    timer->next = *head;
+    if (timer->next) {
+        timer->next->pprev = &timer->next;
+    }
+    timer->pprev = head;
+    *head = timer;
+}
+
+static void linx_timer_unlink(linx_timer_t* timer) {
+    *timer->pprev = timer->next;
+    if (timer->next) {
+        timer->next->pprev = timer->pprev;
+    }
+    timer->next = NULL;
+    timer->pprev = NULL;
+
+    if (timer->level < LINX_TIMER_LEVELS) {
+        linx_timer_wheel_t* wheel = timer->wheel;
+        if (!wheel->slots[timer->level][timer->slot]) {
+            wheel->occupied[timer->level] &= ~((uint64_t)1 << timer->slot);
+        }
+    }
+}
+
+/* 按到期时刻放到对应的级和槽位，不改变计数 */
+static void linx_timer_place(linx_timer_wheel_t* wheel, linx_timer_t* timer) {
+    uint64_t expires_tick = 0;
+    if (timer->expires_ms > wheel->base_ms) {
+        expires_tick = (timer->expires_ms - wheel->base_ms + wheel->tick_ms - 1) / wheel->tick_ms;
+    }
+    if (expires_tick <= wheel->now_tick) {
+        timer->level = LINX_TIMER_LEVEL_EXPIRED;
+        linx_timer_link(&wheel->expired, timer);
+        return;
+    }
+
+    uint64_t delta = expires_tick - wheel->now_tick;
+    if (delta > LINX_TIMER_MAX_DELTA) {
+        /* 超出最高级跨度：先放在最远的槽位，级联时再按剩余时间放置 */
+        delta = LINX_TIMER_MAX_DELTA;
+        expires_tick = wheel->now_tick + delta;
+    }
+
+    unsigned level = 0;
+    while (level + 1 < LINX_TIMER_LEVELS && delta >> (LINX_TIMER_SLOT_BITS * (level + 1)) != 0) {
+        level++;
+    }
+    unsigned slot = (unsigned)(expires_tick >> (LINX_TIMER_SLOT_BITS * level)) & LINX_TIMER_SLOT_MASK;
+
+    timer->level = (uint8_t)level;
+    timer->slot = (uint8_t)slot;
+    linx_timer_link(&wheel->slots[level][slot], timer);
+    wheel->occupied[level] |= (uint64_t)1 << slot;
+}
+
+/* 把上一级当前槽位中的定时器按剩余时间重新放置 */
+static void linx_timer_cascade(linx_timer_wheel_t* wheel, unsigned level) {
+    unsigned slot = (unsigned)(wheel->now_tick >> (LINX_TIMER_SLOT_BITS * level)) & LINX_TIMER_SLOT_MASK;
+    linx_timer_t* timer;
+    while ((timer = wheel->slots[level][slot]) != NULL) {
+        linx_timer_unlink(timer);
+        linx_timer_place(wheel, timer);
+    }
+}
+
+/* 触发一个到期定时器：周期定时器先重新安排，回调里可以取消 */
+static void linx_timer_fire(linx_timer_wheel_t* wheel, linx_timer_t* timer, uint64_t now) {
+    linx_timer_unlink(timer);
+    if (timer->period_ms > 0) {
+        timer->expires_ms += timer->period_ms;
+        if (timer->expires_ms <= now) {
+            /* 错过了若干个周期：跳到下一个未来的周期，不补发 */
+            uint64_t behind = now - timer->expires_ms;
+            timer->expires_ms += (behind / timer->period_ms + 1) * timer->period_ms;
+        }
+        linx_timer_place(wheel, timer);
+    } else {
+        wheel->pending--;
+    }
+    timer->callback(timer, timer->user_data);
+}
+
+linx_timer_wheel_t* linx_timer_wheel_create(uint32_t tick_ms, linx_timer_clock_t clock) {
+    linx_timer_wheel_t* wheel = (linx_timer_wheel_t*)LINX_CALLOC(1, sizeof(linx_timer_wheel_t));
+    if (!wheel) {
+        return NULL;
+    }
+    wheel->clock = clock ? clock : linx_timer_default_clock;
+    wheel->tick_ms = tick_ms > 0 ? tick_ms : LINX_TIMER_DEFAULT_TICK_MS;
+    wheel->base_ms = wheel->clock();
+    return wheel;
+}
+
+void linx_timer_wheel_destroy(linx_timer_wheel_t* wheel) {
+    if (!wheel) {
+        return;
+    }
+    for (unsigned level = 0; level < LINX_TIMER_LEVELS; level++) {
+        for (unsigned slot = 0; slot < LINX_TIMER_SLOTS; slot++) {
+            while (wheel->slots[level][slot]) {
+                linx_timer_unlink(wheel->slots[level][slot]);
+            }
+        }
+    }
+    while (wheel->expired) {
+        linx_timer_unlink(wheel->expired);
+    }
+    LINX_FREE(wheel);
+}
+
+size_t linx_timer_wheel_advance(linx_timer_wheel_t* wheel) {
+    if (!wheel) {
+        return 0;
+    }
+
+    uint64_t now = wheel->clock();
+    uint64_t target = now > wheel->base_ms ? (now - wheel->base_ms) / wheel->tick_ms : 0;
+    size_t fired = 0;
+
+    /* 先触发安排时已到期的；回调新安排的到期定时器留到下一次推进 */
+    linx_timer_t* expired = wheel->expired;
+    wheel->expired = NULL;
+    if (expired) {
+        expired->pprev = &expired;
+    }
+    while (expired) {
+        linx_timer_fire(wheel, expired, now);
+        fired++;
+    }
+
+    while (wheel->now_tick < target) {
+        uint64_t any = 0;
+        for (unsigned level = 0; level < LINX_TIMER_LEVELS; level++) {
+            any |= wheel->occupied[level];
+        }
+        if (!any) {
+            wheel->now_tick = target;
+            break;
+        }
+
+        uint64_t tick = wheel->now_tick + 1;
+        if (!wheel->occupied[0]) {
+            /* 第 0 级为空：直接跳到下一个级联点 */
+            tick = (wheel->now_tick | LINX_TIMER_SLOT_MASK) + 1;
+            if (tick > target) {
+                wheel->now_tick = target;
+                break;
+            }
+        }
+        wheel->now_tick = tick;
+
+        for (unsigned level = 1; level < LINX_TIMER_LEVELS; level++) {
+            if ((tick >> (LINX_TIMER_SLOT_BITS * (level - 1))) & LINX_TIMER_SLOT_MASK) {
+                break;
+            }
+            linx_timer_cascade(wheel, level);
+        }
+
+        linx_timer_t** head = &wheel->slots[0][tick & LINX_TIMER_SLOT_MASK];
+        while (*head) {
+            linx_timer_fire(wheel, *head, now);
+            fired++;
+        }
+    }
+    return fired;
+}
+
+int linx_timer_wheel_next_timeout_ms(const linx_timer_wheel_t* wheel) {
+    if (!wheel || wheel->pending == 0) {
+        return -1;
+    }
+    if (wheel->expired) {
+        return 0;
+    }
+
+    /* 第 0 级给出精确的到期节拍，更高级给出级联节拍（不晚于其中最早的到期） */
+    uint64_t next_tick = UINT64_MAX;
+    for (unsigned level = 0; level < LINX_TIMER_LEVELS; level++) {
+        uint64_t bits = wheel->occupied[level];
+        if (!bits) {
+            continue;
+        }
+        unsigned shift = LINX_TIMER_SLOT_BITS * level;
+        uint64_t block = wheel->now_tick >> shift;
+        unsigned current = (unsigned)block & LINX_TIMER_SLOT_MASK;
+        uint64_t ahead = (uint64_t)__builtin_ctzll(linx_timer_rotate(bits, (current + 1) & LINX_TIMER_SLOT_MASK)) + 1;
+        uint64_t tick = level == 0 ? wheel->now_tick + ahead : (block + ahead) << shift;
+        if (tick < next_tick) {
+            next_tick = tick;
+        }
+    }
+    if (next_tick == UINT64_MAX) {
+        return -1;
+    }
+
+    uint64_t due = wheel->base_ms + next_tick * wheel->tick_ms;
+    uint64_t now = wheel->clock();
+    if (now >= due) {
+        return 0;
+    }
+    return due - now > (uint64_t)INT_MAX ? INT_MAX : (int)(due - now);
+}
+
+int linx_timer_wheel_clamp_timeout(const linx_timer_wheel_t* wheel, int timeout_ms) {
+    int next = linx_timer_wheel_next_timeout_ms(wheel);
+    if (next < 0) {
+        return timeout_ms;
+    }
+    return timeout_ms < 0 || next < timeout_ms ? next : timeout_ms;
+}
+
+uint64_t linx_timer_wheel_now_ms(const linx_timer_wheel_t* wheel) {
+    return wheel->clock();
+}
+
+size_t linx_timer_wheel_pending(const linx_timer_wheel_t* wheel) {
+    return wheel ? wheel->pending : 0;
+}
+
+void linx_timer_init(linx_timer_t* timer, linx_timer_callback_t callback, void* user_data) {
+    memset(timer, 0, sizeof(*timer));
+    timer->callback = callback;
+    timer->user_data = user_data;
+}
+
+static void linx_timer_arm(linx_timer_wheel_t* wheel, linx_timer_t* timer, uint64_t expires_ms, uint32_t period_ms) {
+    linx_timer_cancel(timer);
+    timer->wheel = wheel;
+    timer->expires_ms = expires_ms;
+    timer->period_ms = period_ms;
+    linx_timer_place(wheel, timer);
+    wheel->pending++;
+}
+
+void linx_timer_schedule(linx_timer_wheel_t* wheel, linx_timer_t* timer, uint32_t delay_ms, uint32_t period_ms) {
+    if (!wheel || !timer || !timer->callback) {
+        return;
+    }
+    linx_timer_arm(wheel, timer, wheel->clock() + delay_ms, period_ms);
+}
+
+void linx_timer_schedule_at(linx_timer_wheel_t* wheel, linx_timer_t* timer, uint64_t expires_ms) {
+    if (!wheel || !timer || !timer->callback) {
+        return;
+    }
+    linx_timer_arm(wheel, timer, expires_ms, 0);
+}
+
+void linx_timer_cancel(linx_timer_t* timer) {
+    if (!timer || !timer->pprev) {
+        return;
+    }
+    linx_timer_unlink(timer);
+    timer->wheel->pending--;
+}
@@ -0,0 +1,137 @@
+/**
+ * @file linx_timer.h
+ * @brief 分层时间轮定时器
+ *
+ * 事件循环上的所有截止时间（重连退避、保活探测与探测超时等）挂在一个时间轮上，
+ * 循环每轮轮询后推进时间轮、触发到期的定时器，并用 linx_timer_wheel_next_timeout_ms()
+ * 作为下一次轮询的等待上限，不需要专门的线程，也不需要在空闲时按固定间隔醒来检查。
+ *
+ * 时间轮分 4 级，每级 64 个槽位，第 0 级的槽位是一个节拍（tick_ms），每向上一级
+ * 槽位跨度乘以 64；每级用一个 64 位的占用位图找下一个非空槽位。定时器节点由调用者
+ * 持有（嵌入到自己的结构体中），安排和取消都是 O(1) 的链表操作，不分配内存。
+ * 超过最高级跨度的定时器先放在最高级，级联时再按剩余时间重新放置。
+ *
+ * 定时器只会晚于、不会早于到期时间触发，最多晚一个节拍（加上轮询本身的延迟）。
+ *
+ * 时间轮不是线程安全的：安排、取消、推进都必须在同一个循环上下文中进行
+ * （WebSocket 的事件循环线程或持有 reactor 循环锁的线程）。回调在 linx_timer_wheel_advance()
+ * 中执行，可以安排或取消任何定时器（包括自己），但不能销毁时间轮。
+ */
+
+#ifndef LINX_TIMER_H
+#define LINX_TIMER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** 默认节拍（毫秒） */
+#define LINX_TIMER_DEFAULT_TICK_MS 10
+
+/** 级数和每级槽位数 */
+#define LINX_TIMER_LEVELS 4
+#define LINX_TIMER_SLOTS 64
+
+typedef struct linx_timer_wheel linx_timer_wheel_t;
+typedef struct linx_timer linx_timer_t;
+
+/** 定时器回调（在 linx_timer_wheel_advance() 中调用） */
+typedef void (*linx_timer_callback_t)(linx_timer_t* timer, void* user_data);
+
+/** 单调时钟（毫秒） */
+typedef uint64_t (*linx_timer_clock_t)(void);
+
+/**
+ * 定时器节点，由调用者持有；字段由时间轮维护，只能通过下面的函数访问
+ */
+struct linx_timer {
+    linx_timer_t* next;
+    linx_timer_t** pprev;               // 所在链表中指向自己的指针，NULL 表示未安排
+    linx_timer_wheel_t* wheel;
+    uint64_t expires_ms;                // 到期时刻（时间轮时钟）
+    uint32_t period_ms;                 // 周期，0 为单次
+    uint8_t level;                      // 所在级，LINX_TIMER_LEVELS 表示在到期链表中
+    uint8_t slot;
+    linx_timer_callback_t callback;
+    void* user_data;
+};
+
+/**
+ * 创建时间轮
+ * @param tick_ms 节拍（毫秒），0 为 LINX_TIMER_DEFAULT_TICK_MS
+ * @param clock 单调时钟，NULL 使用 linx_os_now_ms()
+ * @return 时间轮实例，失败返回 NULL
+ */
+linx_timer_wheel_t* linx_timer_wheel_create(uint32_t tick_ms, linx_timer_clock_t clock);
+
+/**
+ * 销毁时间轮；仍在安排中的定时器变为未安排状态，不会被调用
+ */
+void linx_timer_wheel_destroy(linx_timer_wheel_t* wheel);
+
+/**
+ * 推进到当前时刻，依次调用全部到期定时器的回调
+ * @return 调用的回调数
+ */
+size_t linx_timer_wheel_advance(linx_timer_wheel_t* wheel);
+
+/**
+ * 距下一个定时器到期的毫秒数
+ * @return 0 表示已有定时器到期，-1 表示没有安排任何定时器
+ */
+int linx_timer_wheel_next_timeout_ms(const linx_timer_wheel_t* wheel);
+
+/**
+ * 把等待上限收紧到下一个定时器到期（轮询前调用）
+ * @param timeout_ms 原等待上限，-1 表示不限
+ * @return 两者中较小的一个
+ */
+int linx_timer_wheel_clamp_timeout(const linx_timer_wheel_t* wheel, int timeout_ms);
+
+/** 当前时刻（时间轮时钟） */
+uint64_t linx_timer_wheel_now_ms(const linx_timer_wheel_t* wheel);
+
+/** 已安排的定时器数 */
+size_t linx_timer_wheel_pending(const linx_timer_wheel_t* wheel);
+
+/**
+ * 初始化定时器节点（安排前调用一次）
+ */
+void linx_timer_init(linx_timer_t* timer, linx_timer_callback_t callback, void* user_data);
+
+/**
+ * 安排定时器，已安排的先取消再按新的时间安排
+ * @param delay_ms 从现在起的延迟（毫秒），0 表示在下一次推进时触发
+ * @param period_ms 周期（毫秒），0 为单次；周期定时器按到期时刻累加，不随回调耗时漂移
+ */
+void linx_timer_schedule(linx_timer_wheel_t* wheel, linx_timer_t* timer, uint32_t delay_ms, uint32_t period_ms);
+
+/**
+ * 按绝对时刻安排单次定时器（时间轮时钟），已过去的时刻在下一次推进时触发
+ */
+void linx_timer_schedule_at(linx_timer_wheel_t* wheel, linx_timer_t* timer, uint64_t expires_ms);
+
+/**
+ * 取消定时器，未安排时不做任何操作
+ */
+void linx_timer_cancel(linx_timer_t* timer);
+
+/** 定时器是否已安排 */
+static inline bool linx_timer_pending(const linx_timer_t* timer) {
+    return timer->pprev != NULL;
+}
+
+/** 已安排定时器的到期时刻 */
+static inline uint64_t linx_timer_expires_ms(const linx_timer_t* timer) {
+    return timer->expires_ms;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINX_TIMER_H */
@@ -0,0 +1,323 @@
+/**
+ * @file linx_trace.c
+ * @brief 语音对话时间线追踪实现
+ */
+
+#include "linx_trace.h"
+#include "log/linx_alloc.h"
+#include "linx_metrics.h"
+#include "cjson/linx_json_writer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_CORE);
+
+/* 节点记录：seq 为写入序号 + 1，0 表示正在写入（seqlock） */
+typedef struct {
+    uint64_t seq;
+    uint64_t ts_us;
+    uint32_t turn;
+    uint32_t point;
+} linx_trace_record_t;
+
+/* 轮次信息：seq 为轮次编号，0 表示正在写入 */
+typedef struct {
+    uint32_t seq;
+    char session_id[LINX_TRACE_SESSION_ID_MAX];
+} linx_trace_turn_t;
+
+struct linx_trace {
+    linx_trace_record_t* records;
+    size_t capacity;
+    linx_trace_turn_t* turns;
+    size_t turn_capacity;
+    uint64_t head;              // 下一条记录的写入序号
+    uint32_t turn;              // 当前轮次，0 表示尚未开始
+    uint32_t first_mask;        // 当前轮次已记录的"第一次"类节点
+};
+
+/* 导出时按轮次整理的记录 */
+typedef struct {
+    uint64_t ts_us;
+    uint32_t turn;
+    uint32_t point;
+} linx_trace_entry_t;
+
+/* 相邻节点之间的阶段，起止节点都取本轮第一次出现的时间 */
+typedef struct {
+    linx_trace_point_t from;
+    linx_trace_point_t to;
+    const char* name;
+    const char* attribution;
+} linx_trace_phase_t;
+
+static const char* const s_point_names[LINX_TRACE_POINT_COUNT] = {
+    [LINX_TRACE_LISTEN_START] = "listen_start",
+    [LINX_TRACE_VAD_ONSET] = "vad_onset",
+    [LINX_TRACE_FIRST_UPLINK] = "first_uplink",
+    [LINX_TRACE_STT] = "stt",
+    [LINX_TRACE_LLM] = "llm",
+    [LINX_TRACE_TTS_START] = "tts_start",
+    [LINX_TRACE_FIRST_AUDIO] = "first_audio",
+    [LINX_TRACE_FIRST_PLAYBACK] = "first_playback",
+    [LINX_TRACE_TTS_STOP] = "tts_stop",
+};
+
+static const linx_trace_phase_t s_phases[] = {
+    { LINX_TRACE_LISTEN_START, LINX_TRACE_FIRST_UPLINK, "capture", "device" },
+    { LINX_TRACE_VAD_ONSET, LINX_TRACE_FIRST_UPLINK, "vad_to_uplink", "device" },
+    { LINX_TRACE_FIRST_UPLINK, LINX_TRACE_STT, "speech_and_recognition", "server" },
+    { LINX_TRACE_STT, LINX_TRACE_LLM, "llm", "server" },
+    { LINX_TRACE_STT, LINX_TRACE_TTS_START, "response", "server" },
+    { LINX_TRACE_TTS_START, LINX_TRACE_FIRST_AUDIO, "first_audio", "network" },
+    { LINX_TRACE_FIRST_AUDIO, LINX_TRACE_FIRST_PLAYBACK, "playout", "device" },
+    { LINX_TRACE_TTS_START, LINX_TRACE_TTS_STOP, "speaking", "server" },
+};
+
+linx_trace_t* linx_trace_create(size_t capacity) {
+    if (capacity == 0) {
+        return NULL;
+    }
+
+    linx_trace_t* trace = LINX_CALLOC(1, sizeof(*trace));
+    if (!trace) {
+        return NULL;
+    }
+    // 一个轮次通常有 6~9 条记录，按 4 条估算轮次表的大小已足够覆盖整个缓冲区
+    trace->capacity = capacity;
+    trace->turn_capacity = capacity / 4 + 1;
+    trace->records = LINX_CALLOC(trace->capacity, sizeof(*trace->records));
+    trace->turns = LINX_CALLOC(trace->turn_capacity, sizeof(*trace->turns));
+    if (!trace->records || !trace->turns) {
+        linx_trace_destroy(trace);
+        return NULL;
+    }
+    return trace;
+}
+
+void linx_trace_destroy(linx_trace_t* trace) {
+    if (!trace) {
+        return;
+    }
+    LINX_FREE(trace->records);
+    LINX_FREE(trace->turns);
+    LINX_FREE(trace);
+}
+
+uint32_t linx_trace_begin_turn(linx_trace_t* trace, const char* session_id) {
+    if (!trace) {
+        return 0;
+    }
+
+    uint32_t turn = __atomic_add_fetch(&trace->turn, 1, __ATOMIC_RELAXED);
+    if (turn == 0) {
+        // 回绕时跳过 0，0 在记录中表示"不属于任何轮次"
+        turn = __atomic_add_fetch(&trace->turn, 1, __ATOMIC_RELAXED);
+    }
+
+    linx_trace_turn_t* slot = &trace->turns[turn % trace->turn_capacity];
+    __atomic_store_n(&slot->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    snprintf(slot->session_id, sizeof(slot->session_id), "%s", session_id ? session_id : "");
+    __atomic_store_n(&slot->seq, turn, __ATOMIC_RELEASE);
+
+    __atomic_store_n(&trace->first_mask, 0, __ATOMIC_RELEASE);
+    return turn;
+}
+
+void linx_trace_mark(linx_trace_t* trace, linx_trace_point_t point) {
+    if (!trace || (unsigned)point >= LINX_TRACE_POINT_COUNT) {
+        return;
+    }
+
+    uint64_t index = __atomic_fetch_add(&trace->head, 1, __ATOMIC_RELAXED);
+    linx_trace_record_t* record = &trace->records[index % trace->capacity];
+
+    __atomic_store_n(&record->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&record->ts_us, linx_metrics_now_us(), __ATOMIC_RELAXED);
+    __atomic_store_n(&record->turn, __atomic_load_n(&trace->turn, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+    __atomic_store_n(&record->point, (uint32_t)point, __ATOMIC_RELAXED);
+    __atomic_store_n(&record->seq, index + 1, __ATOMIC_RELEASE);
+}
+
+bool linx_trace_mark_first(linx_trace_t* trace, linx_trace_point_t point) {
+    if (!trace || (unsigned)point >= LINX_TRACE_POINT_COUNT) {
+        return false;
+    }
+
+    uint32_t bit = 1u << point;
+    // 热路径（每帧音频）上绝大多数调用到这里就返回
+    if (__atomic_load_n(&trace->first_mask, __ATOMIC_RELAXED) & bit) {
+        return false;
+    }
+    if (__atomic_fetch_or(&trace->first_mask, bit, __ATOMIC_ACQ_REL) & bit) {
+        return false;
+    }
+    linx_trace_mark(trace, point);
+    return true;
+}
+
+const char* linx_trace_point_name(linx_trace_point_t point) {
+    return (unsigned)point < LINX_TRACE_POINT_COUNT ? s_point_names[point] : "unknown";
+}
+
+static int compare_entries(const void* a, const void* b) {
+    const linx_trace_entry_t* x = a;
+    const linx_trace_entry_t* y = b;
+    if (x->turn != y->turn) {
+        return x->turn < y->turn ? -1 : 1;
+    }
+    if (x->ts_us != y->ts_us) {
+        return x->ts_us < y->ts_us ? -1 : 1;
+    }
+    return (int)x->point - (int)y->point;
+}
+
+/* 按 seqlock 读取一条记录，正在写入或已被覆盖时返回 false */
+static bool read_record(const linx_trace_t* trace, uint64_t index, linx_trace_entry_t* entry) {
+    const linx_trace_record_t* record = &trace->records[index % trace->capacity];
+
+    uint64_t seq = __atomic_load_n(&record->seq, __ATOMIC_ACQUIRE);
+    if (seq != index + 1) {
+        return false;
+    }
+    entry->ts_us = __atomic_load_n(&record->ts_us, __ATOMIC_RELAXED);
+    entry->turn = __atomic_load_n(&record->turn, __ATOMIC_RELAXED);
+    entry->point = __atomic_load_n(&record->point, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&record->seq, __ATOMIC_RELAXED) == seq && entry->point < LINX_TRACE_POINT_COUNT;
+}
+
+static void read_session_id(const linx_trace_t* trace, uint32_t turn, char* out, size_t size) {
+    const linx_trace_turn_t* slot = &trace->turns[turn % trace->turn_capacity];
+
+    out[0] = '\0';
+    if (turn == 0 || __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != turn) {
+        return;
+    }
+    memcpy(out, slot->session_id, size < sizeof(slot->session_id) ? size : sizeof(slot->session_id));
+    out[size - 1] = '\0';
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) != turn) {
+        out[0] = '\0';
+    }
+}
+
+static void write_turn(linx_json_writer_t* writer, uint32_t turn, const char* session_id,
+                       const linx_trace_entry_t* entries, size_t count) {
+    char thread_name[LINX_TRACE_SESSION_ID_MAX + 32];
+    if (session_id[0]) {
+        snprintf(thread_name, sizeof(thread_name), "turn %u (%s)", turn, session_id);
+    } else {
+        snprintf(thread_name, sizeof(thread_name), "turn %u", turn);
+    }
+
+    linx_json_writer_begin_object(writer);
+    linx_json_writer_add_string(writer, "name", "thread_name");
+    linx_json_writer_add_string(writer, "ph", "M");
+    linx_json_writer_add_int(writer, "pid", 1);
+    linx_json_writer_add_int(writer, "tid", turn);
+    linx_json_writer_key(writer, "args");
+    linx_json_writer_begin_object(writer);
+    linx_json_writer_add_string(writer, "name", thread_name);
+    linx_json_writer_end_object(writer);
+    linx_json_writer_end_object(writer);
+
+    uint64_t first[LINX_TRACE_POINT_COUNT] = { 0 };
+    for (size_t i = 0; i < count; i++) {
+        const linx_trace_entry_t* e = &entries[i];
+        if (first[e->point] == 0) {
+            first[e->point] = e->ts_us;
+        }
+
+        linx_json_writer_begin_object(writer);
+        linx_json_writer_add_string(writer, "name", s_point_names[e->point]);
+        linx_json_writer_add_string(writer, "cat", "point");
+        linx_json_writer_add_string(writer, "ph", "i");
+        linx_json_writer_add_string(writer, "s", "t");
+        linx_json_writer_add_int(writer, "ts", (long long)e->ts_us);
+        linx_json_writer_add_int(writer, "pid", 1);
+        linx_json_writer_add_int(writer, "tid", turn);
+        linx_json_writer_key(writer, "args");
+        linx_json_writer_begin_object(writer);
+        linx_json_writer_add_string(writer, "session_id", session_id);
+        linx_json_writer_add_int(writer, "turn", turn);
+        linx_json_writer_end_object(writer);
+        linx_json_writer_end_object(writer);
+    }
+
+    for (size_t i = 0; i < sizeof(s_phases) / sizeof(s_phases[0]); i++) {
+        const linx_trace_phase_t* phase = &s_phases[i];
+        uint64_t from = first[phase->from];
+        uint64_t to = first[phase->to];
+        if (from == 0 || to < from) {
+            continue;
+        }
+
+        linx_json_writer_begin_object(writer);
+        linx_json_writer_add_string(writer, "name", phase->name);
+        linx_json_writer_add_string(writer, "cat", "phase");
+        linx_json_writer_add_string(writer, "ph", "X");
+        linx_json_writer_add_int(writer, "ts", (long long)from);
+        linx_json_writer_add_int(writer, "dur", (long long)(to - from));
+        linx_json_writer_add_int(writer, "pid", 1);
+        linx_json_writer_add_int(writer, "tid", turn);
+        linx_json_writer_key(writer, "args");
+        linx_json_writer_begin_object(writer);
+        linx_json_writer_add_string(writer, "attribution", phase->attribution);
+        linx_json_writer_add_string(writer, "session_id", session_id);
+        linx_json_writer_add_int(writer, "turn", turn);
+        linx_json_writer_end_object(writer);
+        linx_json_writer_end_object(writer);
+    }
+}
+
+char* linx_trace_to_chrome_json(linx_trace_t* trace) {
+    if (!trace) {
+        return NULL;
+    }
+
+    uint64_t head = __atomic_load_n(&trace->head, __ATOMIC_ACQUIRE);
+    uint64_t begin = head > trace->capacity ? head - trace->capacity : 0;
+    linx_trace_entry_t* entries = LINX_MALLOC((size_t)(head - begin + 1) * sizeof(*entries));
+    if (!entries) {
+        return NULL;
+    }
+
+    size_t count = 0;
+    for (uint64_t index = begin; index < head; index++) {
+        if (read_record(trace, index, &entries[count])) {
+            count++;
+        }
+    }
+    qsort(entries, count, sizeof(*entries), compare_entries);
+
+    linx_json_writer_t writer;
+    linx_json_writer_init(&writer);
+    linx_json_writer_begin_object(&writer);
+    linx_json_writer_key(&writer, "traceEvents");
+    linx_json_writer_begin_array(&writer);
+
+    for (size_t start = 0; start < count;) {
+        size_t end = start + 1;
+        while (end < count && entries[end].turn == entries[start].turn) {
+            end++;
+        }
+        char session_id[LINX_TRACE_SESSION_ID_MAX];
+        read_session_id(trace, entries[start].turn, session_id, sizeof(session_id));
+        write_turn(&writer, entries[start].turn, session_id, &entries[start], end - start);
+        start = end;
+    }
+
+    linx_json_writer_end_array(&writer);
+    linx_json_writer_add_string(&writer, "displayTimeUnit", "ms");
+    linx_json_writer_end_object(&writer);
+    LINX_FREE(entries);
+
+    const char* json = linx_json_writer_finish(&writer);
+    char* result = json ? LINX_STRDUP(json) : NULL;
+    linx_json_writer_free(&writer);
+    return result;
+}
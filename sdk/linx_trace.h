@@ -0,0 +1,97 @@
+/**
+ * @file linx_trace.h
+ * @brief 语音对话时间线追踪
+ *
+ * 按"轮次"记录一次对话中各关键节点的时间戳（开始监听、VAD 检测到说话、第一帧上行、
+ * stt、llm、tts start、第一帧下行音频、第一个样本写入音频设备、tts stop），
+ * 写入固定容量的环形缓冲区，最旧的记录被覆盖。导出为 Chrome trace JSON
+ * （chrome://tracing 或 Perfetto 打开）：每个轮次一行，除节点外还给出相邻节点之间的
+ * 阶段及其归属（设备、网络、服务端），用于定位慢轮次的原因。
+ *
+ * 记录接口无锁且不分配内存，可在网络线程、播放线程和设备回调中调用。
+ * 轮次由 linx_trace_begin_turn() 开始，同一轮次内"第一次"类节点只记录一次。
+ */
+
+#ifndef LINX_TRACE_H
+#define LINX_TRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** 会话ID保存的最大长度（含结尾的 '\0'） */
+#define LINX_TRACE_SESSION_ID_MAX 48
+
+/**
+ * @brief 时间线节点
+ */
+typedef enum {
+    LINX_TRACE_LISTEN_START = 0,    ///< 开始监听（发送 listen start）
+    LINX_TRACE_VAD_ONSET,           ///< 本地 VAD 检测到说话（由应用上报）
+    LINX_TRACE_FIRST_UPLINK,        ///< 本轮第一帧上行音频发出
+    LINX_TRACE_STT,                 ///< 收到 stt 识别结果
+    LINX_TRACE_LLM,                 ///< 收到 llm 消息
+    LINX_TRACE_TTS_START,           ///< 收到 tts start
+    LINX_TRACE_FIRST_AUDIO,         ///< 本轮第一帧下行音频（第一个 LINX_EVENT_AUDIO_DATA）
+    LINX_TRACE_FIRST_PLAYBACK,      ///< 本轮第一个样本写入音频设备
+    LINX_TRACE_TTS_STOP,            ///< 收到 tts stop
+    LINX_TRACE_POINT_COUNT
+} linx_trace_point_t;
+
+typedef struct linx_trace linx_trace_t;
+
+/**
+ * @brief 创建追踪缓冲区
+ * @param capacity 最多保留的节点记录数（约 24 字节/条）
+ * @return 追踪实例，capacity 为 0 或内存不足时返回 NULL
+ */
+linx_trace_t* linx_trace_create(size_t capacity);
+
+/**
+ * @brief 销毁追踪缓冲区（NULL 时忽略）
+ */
+void linx_trace_destroy(linx_trace_t* trace);
+
+/**
+ * @brief 开始新的轮次，之后的节点都归入该轮次
+ * @param session_id 当前会话ID，可为 NULL
+ * @return 轮次编号（从 1 开始），trace 为 NULL 时返回 0
+ */
+uint32_t linx_trace_begin_turn(linx_trace_t* trace, const char* session_id);
+
+/**
+ * @brief 记录一个节点（trace 为 NULL 时忽略，下同）
+ */
+void linx_trace_mark(linx_trace_t* trace, linx_trace_point_t point);
+
+/**
+ * @brief 记录本轮次中第一次出现的节点，之后的调用只做一次原子读取
+ * @return 本次记录了节点返回 true
+ */
+bool linx_trace_mark_first(linx_trace_t* trace, linx_trace_point_t point);
+
+/**
+ * @brief 节点在 trace JSON 中的名称
+ */
+const char* linx_trace_point_name(linx_trace_point_t point);
+
+/**
+ * @brief 导出缓冲区中的全部记录为 Chrome trace JSON
+ *
+ * 格式为 {"traceEvents":[...],"displayTimeUnit":"ms"}：每个节点是一个即时事件（ph "i"），
+ * 相邻节点之间的阶段是完整事件（ph "X"，args.attribution 为 device/network/server），
+ * 每个轮次一条"线程"，名称含会话ID。可以与记录并发调用，正被覆盖的记录会被跳过。
+ *
+ * @return JSON 文本，调用者用 linx_free() 释放；内存不足时返回 NULL
+ */
+char* linx_trace_to_chrome_json(linx_trace_t* trace);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LINX_TRACE_H
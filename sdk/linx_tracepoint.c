@@ -0,0 +1,250 @@
+/**
+ * @file linx_tracepoint.c
+ * @brief 静态跟踪点的内存轨道实现
+ */
+
+#include "linx_tracepoint.h"
+#include "log/linx_alloc.h"
+#include "linx_metrics.h"
+#include "cjson/linx_json_writer.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_CORE);
+
+/* 探针名称和参数名称 */
+typedef struct {
+    const char* name;
+    const char* arg_a;
+    const char* arg_b;
+} linx_tracepoint_info_t;
+
+static const linx_tracepoint_info_t s_infos[LINX_TRACEPOINT_ID_COUNT] = {
+#define LINX_TRACEPOINT_INFO(name, a, b) [LINX_TRACEPOINT_ID_##name] = { #name, a, b },
+    LINX_TRACEPOINT_LIST(LINX_TRACEPOINT_INFO)
+#undef LINX_TRACEPOINT_INFO
+};
+
+const char* linx_tracepoint_name(linx_tracepoint_id_t id) {
+    return (unsigned)id < LINX_TRACEPOINT_ID_COUNT ? s_infos[id].name : "unknown";
+}
+
+#if LINX_TRACEPOINTS == LINX_TRACEPOINTS_TRACK
+
+/* 一条记录：seq 为写入序号 + 1，0 表示正在写入（seqlock） */
+typedef struct {
+    uint64_t seq;
+    uint64_t ts_us;
+    int64_t a;
+    int64_t b;
+    uint32_t tid;
+    uint16_t id;
+    uint16_t phase;
+} linx_tracepoint_slot_t;
+
+/* 导出时读出的记录 */
+typedef struct {
+    uint64_t ts_us;
+    uint64_t index;
+    int64_t a;
+    int64_t b;
+    uint32_t tid;
+    uint16_t id;
+    uint16_t phase;
+} linx_tracepoint_entry_t;
+
+static pthread_mutex_t s_mutex = PTHREAD_MUTEX_INITIALIZER;
+static linx_tracepoint_slot_t* s_slots;     // 分配后不再释放，记录方无需与导出方同步生命周期
+static size_t s_capacity;
+static uint64_t s_head;                     // 下一条记录的写入序号
+static uint64_t s_start;                    // 本次开始记录时的 s_head，之前的记录不导出
+static bool s_enabled;
+static uint32_t s_next_tid;
+static __thread uint32_t t_tid;
+
+void linx_tracepoint_record(linx_tracepoint_id_t id, linx_tracepoint_phase_t phase, int64_t a, int64_t b) {
+    if (!__atomic_load_n(&s_enabled, __ATOMIC_ACQUIRE) || (unsigned)id >= LINX_TRACEPOINT_ID_COUNT) {
+        return;
+    }
+    if (t_tid == 0) {
+        t_tid = __atomic_add_fetch(&s_next_tid, 1, __ATOMIC_RELAXED);
+    }
+
+    uint64_t index = __atomic_fetch_add(&s_head, 1, __ATOMIC_RELAXED);
+    linx_tracepoint_slot_t* slot = &s_slots[index % s_capacity];
+
+    __atomic_store_n(&slot->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&slot->ts_us, linx_metrics_now_us(), __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->a, a, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->b, b, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->tid, t_tid, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->id, (uint16_t)id, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->phase, (uint16_t)phase, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->seq, index + 1, __ATOMIC_RELEASE);
+}
+
+bool linx_tracepoint_track_start(size_t capacity) {
+    pthread_mutex_lock(&s_mutex);
+    if (!s_slots) {
+        s_capacity = capacity > 0 ? capacity : LINX_TRACEPOINT_DEFAULT_CAPACITY;
+        s_slots = LINX_CALLOC(s_capacity, sizeof(*s_slots));
+    }
+    bool ok = s_slots != NULL;
+    if (ok) {
+        __atomic_store_n(&s_start, __atomic_load_n(&s_head, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+        __atomic_store_n(&s_enabled, true, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&s_mutex);
+    return ok;
+}
+
+void linx_tracepoint_track_stop(void) {
+    __atomic_store_n(&s_enabled, false, __ATOMIC_RELEASE);
+}
+
+/* 按 seqlock 读取一条记录，正在写入或已被覆盖时返回 false */
+static bool read_slot(uint64_t index, linx_tracepoint_entry_t* entry) {
+    const linx_tracepoint_slot_t* slot = &s_slots[index % s_capacity];
+
+    uint64_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+    if (seq != index + 1) {
+        return false;
+    }
+    entry->index = index;
+    entry->ts_us = __atomic_load_n(&slot->ts_us, __ATOMIC_RELAXED);
+    entry->a = __atomic_load_n(&slot->a, __ATOMIC_RELAXED);
+    entry->b = __atomic_load_n(&slot->b, __ATOMIC_RELAXED);
+    entry->tid = __atomic_load_n(&slot->tid, __ATOMIC_RELAXED);
+    entry->id = __atomic_load_n(&slot->id, __ATOMIC_RELAXED);
+    entry->phase = __atomic_load_n(&slot->phase, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == seq && entry->id < LINX_TRACEPOINT_ID_COUNT &&
+           entry->phase <= LINX_TRACEPOINT_END;
+}
+
+/* 同一线程内按时间排序，时间相同时按写入顺序（保证 B 在 E 之前） */
+static int compare_entries(const void* a, const void* b) {
+    const linx_tracepoint_entry_t* x = a;
+    const linx_tracepoint_entry_t* y = b;
+    if (x->tid != y->tid) {
+        return x->tid < y->tid ? -1 : 1;
+    }
+    if (x->ts_us != y->ts_us) {
+        return x->ts_us < y->ts_us ? -1 : 1;
+    }
+    return x->index < y->index ? -1 : (x->index > y->index ? 1 : 0);
+}
+
+static void write_thread_name(linx_json_writer_t* writer, uint32_t tid) {
+    char name[32];
+    snprintf(name, sizeof(name), "thread %u", tid);
+
+    linx_json_writer_begin_object(writer);
+    linx_json_writer_add_string(writer, "name", "thread_name");
+    linx_json_writer_add_string(writer, "ph", "M");
+    linx_json_writer_add_int(writer, "pid", 1);
+    linx_json_writer_add_int(writer, "tid", tid);
+    linx_json_writer_key(writer, "args");
+    linx_json_writer_begin_object(writer);
+    linx_json_writer_add_string(writer, "name", name);
+    linx_json_writer_end_object(writer);
+    linx_json_writer_end_object(writer);
+}
+
+static void write_entry(linx_json_writer_t* writer, const linx_tracepoint_entry_t* e) {
+    static const char* const phases[] = { "i", "B", "E" };
+    const linx_tracepoint_info_t* info = &s_infos[e->id];
+
+    linx_json_writer_begin_object(writer);
+    linx_json_writer_add_string(writer, "name", info->name);
+    linx_json_writer_add_string(writer, "cat", "linx");
+    linx_json_writer_add_string(writer, "ph", phases[e->phase]);
+    if (e->phase == LINX_TRACEPOINT_INSTANT) {
+        linx_json_writer_add_string(writer, "s", "t");
+    }
+    linx_json_writer_add_int(writer, "ts", (long long)e->ts_us);
+    linx_json_writer_add_int(writer, "pid", 1);
+    linx_json_writer_add_int(writer, "tid", e->tid);
+    if (e->phase != LINX_TRACEPOINT_BEGIN) {
+        linx_json_writer_key(writer, "args");
+        linx_json_writer_begin_object(writer);
+        linx_json_writer_add_int(writer, info->arg_a, (long long)e->a);
+        linx_json_writer_add_int(writer, info->arg_b, (long long)e->b);
+        linx_json_writer_end_object(writer);
+    }
+    linx_json_writer_end_object(writer);
+}
+
+char* linx_tracepoint_track_to_json(void) {
+    pthread_mutex_lock(&s_mutex);
+    bool allocated = s_slots != NULL;
+    pthread_mutex_unlock(&s_mutex);
+    if (!allocated) {
+        return NULL;
+    }
+
+    uint64_t head = __atomic_load_n(&s_head, __ATOMIC_ACQUIRE);
+    uint64_t begin = __atomic_load_n(&s_start, __ATOMIC_RELAXED);
+    if (head - begin > s_capacity) {
+        begin = head - s_capacity;
+    }
+    linx_tracepoint_entry_t* entries = LINX_MALLOC((size_t)(head - begin + 1) * sizeof(*entries));
+    if (!entries) {
+        return NULL;
+    }
+
+    size_t count = 0;
+    for (uint64_t index = begin; index < head; index++) {
+        if (read_slot(index, &entries[count])) {
+            count++;
+        }
+    }
+    qsort(entries, count, sizeof(*entries), compare_entries);
+
+    linx_json_writer_t writer;
+    linx_json_writer_init(&writer);
+    linx_json_writer_begin_object(&writer);
+    linx_json_writer_key(&writer, "traceEvents");
+    linx_json_writer_begin_array(&writer);
+    for (size_t i = 0; i < count; i++) {
+        if (i == 0 || entries[i].tid != entries[i - 1].tid) {
+            write_thread_name(&writer, entries[i].tid);
+        }
+        write_entry(&writer, &entries[i]);
+    }
+    linx_json_writer_end_array(&writer);
+    linx_json_writer_add_string(&writer, "displayTimeUnit", "ms");
+    linx_json_writer_end_object(&writer);
+    LINX_FREE(entries);
+
+    const char* json = linx_json_writer_finish(&writer);
+    char* result = json ? LINX_STRDUP(json) : NULL;
+    linx_json_writer_free(&writer);
+    return result;
+}
+
+#else
+
+void linx_tracepoint_record(linx_tracepoint_id_t id, linx_tracepoint_phase_t phase, int64_t a, int64_t b) {
+    (void)id;
+    (void)phase;
+    (void)a;
+    (void)b;
+}
+
+bool linx_tracepoint_track_start(size_t capacity) {
+    (void)capacity;
+    return false;
+}
+
+void linx_tracepoint_track_stop(void) {
+}
+
+char* linx_tracepoint_track_to_json(void) {
+    return NULL;
+}
+
+#endif
@@ -0,0 +1,132 @@
+/**
+ * @file linx_tracepoint.h
+ * @brief 热路径上的静态跟踪点
+ *
+ * 在 WebSocket 收发、播放器入队/解码/写设备、Opus 编码、MCP 分派和设备状态变化处
+ * 放置固定的探针，量产固件上也能按阶段归因时延，不必换成 DEBUG 日志的版本。
+ * 编译期由 LINX_TRACEPOINTS 选择实现（构建配置的 CONFIG_TRACEPOINTS，经 CMake 的
+ * 同名选项传入）：
+ *
+ * - LINX_TRACEPOINTS_OFF（默认）：宏展开为空，参数不求值，不产生任何代码
+ * - LINX_TRACEPOINTS_USDT：USDT 探针（<sys/sdt.h>，Linux 上来自 systemtap-sdt-dev），
+ *   provider 为 "linx"。未附加时每个探针只是一条 nop，附加方式例如：
+ *     perf probe -x app sdt_linx:player_decode_end
+ *     bpftrace -e 'usdt:./app:linx:ws_rx { @bytes = hist(arg1); }'
+ *   区间探针分为 <name>_begin 和 <name>_end 两个，用二者的时间差统计耗时
+ * - LINX_TRACEPOINTS_TRACK：记录到进程内的环形缓冲区（无锁、不分配内存），
+ *   linx_tracepoint_track_start() 开始记录，linx_tracepoint_track_to_json() 导出为
+ *   Chrome trace JSON，在 Perfetto 中打开；时间基准与 linx_trace 相同，两份导出可以对照
+ *
+ * 每个探针带两个整数参数，含义见 LINX_TRACEPOINT_LIST。
+ */
+
+#ifndef LINX_TRACEPOINT_H
+#define LINX_TRACEPOINT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LINX_TRACEPOINTS_OFF 0
+#define LINX_TRACEPOINTS_USDT 1
+#define LINX_TRACEPOINTS_TRACK 2
+
+#ifndef LINX_TRACEPOINTS
+#define LINX_TRACEPOINTS LINX_TRACEPOINTS_OFF
+#endif
+
+/* 内存轨道默认保留的记录数（每条 40 字节） */
+#ifndef LINX_TRACEPOINT_DEFAULT_CAPACITY
+#define LINX_TRACEPOINT_DEFAULT_CAPACITY 8192
+#endif
+
+/*
+ * 探针列表：X(名称, 参数 a 的含义, 参数 b 的含义)
+ * 区间探针（BEGIN/END）的参数在 END 时给出
+ */
+#define LINX_TRACEPOINT_LIST(X)                                                 \
+    X(ws_rx, "opcode", "bytes")          /* 收到一条 WebSocket 消息 */            \
+    X(ws_tx, "opcode", "bytes")          /* 一条 WebSocket 消息写入发送缓冲区 */   \
+    X(player_feed, "bytes", "timestamp") /* 下行音频包放入播放器 */                \
+    X(player_decode, "bytes", "samples") /* 区间：解码一个下行音频包 */            \
+    X(player_write, "samples", "pull")   /* 区间：写音频设备（pull 为拉模式回调） */ \
+    X(opus_encode, "samples", "bytes")   /* 区间：编码一帧上行音频 */              \
+    X(mcp_dispatch, "id", "handled")     /* 区间：分派并处理一个 MCP 请求 */       \
+    X(state, "from", "to")               /* 设备状态变化（LinxDeviceState） */
+
+typedef enum {
+#define LINX_TRACEPOINT_ENUM(name, a, b) LINX_TRACEPOINT_ID_##name,
+    LINX_TRACEPOINT_LIST(LINX_TRACEPOINT_ENUM)
+#undef LINX_TRACEPOINT_ENUM
+    LINX_TRACEPOINT_ID_COUNT
+} linx_tracepoint_id_t;
+
+/* 记录类型，对应 Chrome trace 的 ph */
+typedef enum {
+    LINX_TRACEPOINT_INSTANT = 0,    // 即时事件（ph "i"）
+    LINX_TRACEPOINT_BEGIN,          // 区间开始（ph "B"）
+    LINX_TRACEPOINT_END             // 区间结束（ph "E"）
+} linx_tracepoint_phase_t;
+
+#if LINX_TRACEPOINTS == LINX_TRACEPOINTS_USDT
+#include <sys/sdt.h>
+#define LINX_TRACEPOINT(name, a, b) DTRACE_PROBE2(linx, name, (int64_t)(a), (int64_t)(b))
+#define LINX_TRACEPOINT_BEGIN(name) DTRACE_PROBE(linx, name##_begin)
+#define LINX_TRACEPOINT_END(name, a, b) DTRACE_PROBE2(linx, name##_end, (int64_t)(a), (int64_t)(b))
+#elif LINX_TRACEPOINTS == LINX_TRACEPOINTS_TRACK
+#define LINX_TRACEPOINT(name, a, b) \
+    linx_tracepoint_record(LINX_TRACEPOINT_ID_##name, LINX_TRACEPOINT_INSTANT, (int64_t)(a), (int64_t)(b))
+#define LINX_TRACEPOINT_BEGIN(name) \
+    linx_tracepoint_record(LINX_TRACEPOINT_ID_##name, LINX_TRACEPOINT_BEGIN, 0, 0)
+#define LINX_TRACEPOINT_END(name, a, b) \
+    linx_tracepoint_record(LINX_TRACEPOINT_ID_##name, LINX_TRACEPOINT_END, (int64_t)(a), (int64_t)(b))
+#else
+#define LINX_TRACEPOINT(name, a, b) ((void)0)
+#define LINX_TRACEPOINT_BEGIN(name) ((void)0)
+#define LINX_TRACEPOINT_END(name, a, b) ((void)0)
+#endif
+
+/**
+ * @brief 记录一条跟踪点（由 LINX_TRACEPOINT* 宏调用）；未开始记录时只做一次原子读取
+ */
+void linx_tracepoint_record(linx_tracepoint_id_t id, linx_tracepoint_phase_t phase, int64_t a, int64_t b);
+
+/**
+ * @brief 开始记录到内存轨道
+ *
+ * 第一次调用时分配缓冲区，之后的调用清空已有记录后继续使用同一缓冲区（capacity 被忽略）。
+ * 缓冲区在进程退出前不释放，探针可以在任何线程上随时调用。
+ * @param capacity 保留的记录数，满后覆盖最旧的记录；0 使用 LINX_TRACEPOINT_DEFAULT_CAPACITY
+ * @return 已开始返回 true；未编译内存轨道（LINX_TRACEPOINTS 不是 TRACK）或内存不足返回 false
+ */
+bool linx_tracepoint_track_start(size_t capacity);
+
+/**
+ * @brief 停止记录，缓冲区中的记录保留，可以继续导出
+ */
+void linx_tracepoint_track_stop(void);
+
+/**
+ * @brief 导出内存轨道为 Chrome trace JSON
+ *
+ * 格式为 {"traceEvents":[...],"displayTimeUnit":"ms"}，每个记录过探针的线程一条轨道，
+ * 参数按 LINX_TRACEPOINT_LIST 中的名称放在 args 中。可以与记录并发调用，
+ * 正被覆盖的记录会被跳过。
+ * @return JSON 文本，调用者用 linx_free() 释放；没有缓冲区或内存不足时返回 NULL
+ */
+char* linx_tracepoint_track_to_json(void);
+
+/**
+ * @brief 探针名称
+ */
+const char* linx_tracepoint_name(linx_tracepoint_id_t id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINX_TRACEPOINT_H */
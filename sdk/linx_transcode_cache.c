@@ -0,0 +1,1103 @@
+/**
+ * @file linx_transcode_cache.c
+ * @brief 提示音转码缓存实现
+ *
+ * 转码流水线：源读取（WAV 样本转换 / 编码包解码 / Ogg 解封装 + Opus 解码）→ 声道混缩 →
+ * 重采样 → 按目标帧长分帧编码。每一级按块处理，内存占用与资源长度无关（输出缓冲区除外）。
+ *
+ * 存储记录：[magic 4B "LXTC"][version 2B][header_size 2B][source_hash 8B][target_hash 4B]
+ *           [payload_size 4B][包序列]，小端
+ */
+
+#include "linx_transcode_cache.h"
+#include "audio/audio_resampler.h"
+#include "codecs/codec_factory.h"
+#include "log/linx_alloc.h"
+#include "log/linx_log.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_CORE);
+
+#define TRANSCODE_KEY_PREFIX        "lxtc."
+#define TRANSCODE_MAGIC             0x4354584Cu     // "LXTC"
+#define TRANSCODE_VERSION           1
+#define TRANSCODE_HEADER_SIZE       24
+#define TRANSCODE_BLOCK_FRAMES      480             // 每块处理的帧数
+#define TRANSCODE_MAX_PACKET        8192            // Ogg 中单个包的上限（Opus 120ms 包不超过 7.5KB）
+
+/* 一个转码结果 */
+typedef struct {
+    char name[LINX_TRANSCODE_MAX_NAME + 1];
+    uint64_t source_hash;           // 0 表示从存储装入时没有比较源数据
+    uint8_t* record;                // 存储记录（头部 + 包序列）
+    size_t payload_size;
+} transcode_entry_t;
+
+struct linx_transcode_cache {
+    linx_transcode_cache_config_t config;
+    uint32_t target_hash;
+    linx_cancel_token_t* token;     // 销毁时取消排队的任务
+
+    pthread_mutex_t mutex;
+    pthread_cond_t idle;            // pending 归零时通知
+    transcode_entry_t** entries;    // 条目单独分配，名称指针不随数组扩容移动
+    size_t count;
+    size_t capacity;
+    uint8_t** retired;              // 被替换的旧结果，销毁时释放
+    size_t retired_count;
+    linx_transcode_cache_stats_t stats;
+};
+
+/* 一次提交 */
+typedef struct {
+    linx_transcode_cache_t* cache;
+    char name[LINX_TRANSCODE_MAX_NAME + 1];
+    linx_transcode_source_t source;
+    linx_transcode_done_cb_t done;
+    void* user_data;
+} transcode_job_t;
+
+/* ==================== 工具 ==================== */
+
+static uint64_t fnv1a64(uint64_t hash, const void* data, size_t size) {
+    const uint8_t* p = (const uint8_t*)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= p[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static uint16_t read_le16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t read_le32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t read_le64(const uint8_t* p) {
+    return (uint64_t)read_le32(p) | ((uint64_t)read_le32(p + 4) << 32);
+}
+
+static void write_le16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void write_le32(uint8_t* p, uint32_t v) {
+    write_le16(p, (uint16_t)v);
+    write_le16(p + 2, (uint16_t)(v >> 16));
+}
+
+static void write_le64(uint8_t* p, uint64_t v) {
+    write_le32(p, (uint32_t)v);
+    write_le32(p + 4, (uint32_t)(v >> 32));
+}
+
+/* 存储中的键：文件存储把键用作文件名，名称中的其他字符换成 '_' */
+static void make_key(const char* name, char* key, size_t size) {
+    size_t prefix = strlen(TRANSCODE_KEY_PREFIX);
+    snprintf(key, size, "%s%s", TRANSCODE_KEY_PREFIX, name);
+    for (char* p = key + prefix; *p; p++) {
+        char c = *p;
+        if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+              c == '-' || c == '_' || c == '.')) {
+            *p = '_';
+        }
+    }
+}
+
+static bool store_ready(const linx_kv_store_t* store) {
+    return store->load && store->store;
+}
+
+/* 检查包序列的长度前缀 */
+static bool packets_valid(const uint8_t* data, size_t size) {
+    size_t offset = 0;
+    while (offset + 2 <= size) {
+        size_t length = ((size_t)data[offset] << 8) | data[offset + 1];
+        if (length == 0 || offset + 2 + length > size) {
+            return false;
+        }
+        offset += 2 + length;
+    }
+    return offset == size && size > 0;
+}
+
+/* ==================== 源读取 ==================== */
+
+typedef enum {
+    READER_PCM,                     // PCM16 和 WAV：直接转换样本
+    READER_PACKETS,                 // 长度前缀的编码包
+    READER_OGG                      // Ogg Opus
+} reader_kind_t;
+
+/* 源读取器：每次产生一块源采样率、源声道数的 PCM */
+typedef struct {
+    reader_kind_t kind;
+    const uint8_t* data;
+    size_t size;
+    size_t offset;                  // PCM / PACKETS 的读取位置
+    int sample_rate;
+    int channels;
+
+    // PCM / WAV
+    int bits;                       // 8 / 16 / 24 / 32
+    bool is_float;
+
+    // 解码
+    audio_codec_t* decoder;
+    int16_t* pcm;                   // 输出块
+    size_t pcm_capacity;            // 样本数（所有声道合计）
+
+    // Ogg
+    uint32_t serial;
+    size_t page;                    // 当前页的偏移
+    size_t segments;                // 当前页的段数，0 表示需要读下一页
+    size_t segment;                 // 下一个段
+    size_t body;                    // 下一个段的数据偏移
+    uint8_t* packet;                // 正在拼接的包
+    size_t packet_len;
+    size_t skip_frames;             // 还要丢弃的起始帧（pre-skip）
+    uint64_t remaining_frames;      // 按最后一页的 granule 还可以输出的帧数，UINT64_MAX 为不限
+} transcode_reader_t;
+
+static bool reader_alloc_pcm(transcode_reader_t* reader, size_t samples) {
+    reader->pcm = (int16_t*)LINX_MALLOC(samples * sizeof(int16_t));
+    reader->pcm_capacity = samples;
+    return reader->pcm != NULL;
+}
+
+static bool reader_open_decoder(transcode_reader_t* reader, const char* codec) {
+    reader->decoder = codec_factory_create_for_format(codec ? codec : "opus");
+    if (!reader->decoder) {
+        LOG_ERROR("转码：不支持的编码格式 %s", codec ? codec : "opus");
+        return false;
+    }
+    audio_format_t format;
+    audio_format_init(&format, reader->sample_rate, reader->channels, 16, 20);
+    if (audio_codec_init_decoder(reader->decoder, &format) != CODEC_SUCCESS) {
+        LOG_ERROR("转码：%s 解码器初始化失败（%d Hz，%d 声道）", codec ? codec : "opus",
+                  reader->sample_rate, reader->channels);
+        return false;
+    }
+    int max_output = audio_codec_get_max_output_size(reader->decoder);
+    size_t samples = (size_t)(max_output > 0 ? max_output : 0);
+    if (samples < (size_t)TRANSCODE_BLOCK_FRAMES * reader->channels) {
+        samples = (size_t)TRANSCODE_BLOCK_FRAMES * reader->channels;
+    }
+    return reader_alloc_pcm(reader, samples);
+}
+
+static bool wav_open(transcode_reader_t* reader, const uint8_t* data, size_t size) {
+    if (size < 12 || memcmp(data, "RIFF", 4) != 0 || memcmp(data + 8, "WAVE", 4) != 0) {
+        LOG_ERROR("转码：不是 WAV 文件");
+        return false;
+    }
+    bool have_format = false;
+    size_t offset = 12;
+    while (offset + 8 <= size) {
+        const uint8_t* chunk = data + offset;
+        size_t length = read_le32(chunk + 4);
+        size_t body = offset + 8;
+        if (memcmp(chunk, "fmt ", 4) == 0 && length >= 16 && body + length <= size) {
+            uint16_t tag = read_le16(data + body);
+            if (tag == 0xFFFE && length >= 26) {
+                tag = read_le16(data + body + 24);      // WAVE_FORMAT_EXTENSIBLE 的子格式
+            }
+            reader->channels = read_le16(data + body + 2);
+            reader->sample_rate = (int)read_le32(data + body + 4);
+            reader->bits = read_le16(data + body + 14);
+            reader->is_float = tag == 3;
+            if (!((tag == 1 && (reader->bits == 8 || reader->bits == 16 || reader->bits == 24 ||
+                                reader->bits == 32)) ||
+                  (tag == 3 && reader->bits == 32))) {
+                LOG_ERROR("转码：不支持的 WAV 格式 %u（%d 位）", tag, reader->bits);
+                return false;
+            }
+            have_format = true;
+        } else if (memcmp(chunk, "data", 4) == 0 && have_format) {
+            // 流式写出的 WAV 长度可能是 0 或 0xFFFFFFFF，按文件实际长度截断
+            reader->data = data + body;
+            reader->size = (length == 0 || body + length > size) ? size - body : length;
+            return true;
+        }
+        offset = body + length + (length & 1);
+    }
+    LOG_ERROR("转码：WAV 缺少 fmt 或 data 块");
+    return false;
+}
+
+/* 一个样本转成 16 位 */
+static int16_t pcm_sample(const transcode_reader_t* reader, const uint8_t* p) {
+    switch (reader->bits) {
+    case 8:
+        return (int16_t)((p[0] - 128) * 256);
+    case 24:
+        return (int16_t)read_le16(p + 1);
+    case 32:
+        if (reader->is_float) {
+            uint32_t bits = read_le32(p);
+            float value;
+            memcpy(&value, &bits, sizeof(value));
+            value *= 32768.0f;
+            if (value >= 32767.0f) {
+                return 32767;
+            }
+            if (value <= -32768.0f) {
+                return -32768;
+            }
+            return (int16_t)value;
+        }
+        return (int16_t)read_le16(p + 2);
+    default:
+        return (int16_t)read_le16(p);
+    }
+}
+
+static bool pcm_next(transcode_reader_t* reader, size_t* frames) {
+    size_t frame_bytes = (size_t)(reader->bits / 8) * reader->channels;
+    size_t available = (reader->size - reader->offset) / frame_bytes;
+    size_t count = available < TRANSCODE_BLOCK_FRAMES ? available : TRANSCODE_BLOCK_FRAMES;
+    const uint8_t* p = reader->data + reader->offset;
+    size_t sample_bytes = (size_t)reader->bits / 8;
+    for (size_t i = 0; i < count * reader->channels; i++) {
+        reader->pcm[i] = pcm_sample(reader, p + i * sample_bytes);
+    }
+    reader->offset += count * frame_bytes;
+    *frames = count;
+    return true;
+}
+
+static bool packets_next(transcode_reader_t* reader, size_t* frames) {
+    *frames = 0;
+    while (*frames == 0 && reader->offset + 2 <= reader->size) {
+        size_t length = ((size_t)reader->data[reader->offset] << 8) | reader->data[reader->offset + 1];
+        if (length == 0 || reader->offset + 2 + length > reader->size) {
+            LOG_ERROR("转码：编码包数据损坏（%zu 字节处）", reader->offset);
+            return false;
+        }
+        size_t decoded = 0;
+        if (audio_codec_decode(reader->decoder, reader->data + reader->offset + 2, length, reader->pcm,
+                               reader->pcm_capacity, &decoded) != CODEC_SUCCESS) {
+            LOG_ERROR("转码：编码包解码失败（%zu 字节处）", reader->offset);
+            return false;
+        }
+        reader->offset += 2 + length;
+        *frames = decoded / (size_t)reader->channels;
+    }
+    return true;
+}
+
+/* 检查 offset 处的 Ogg 页，返回页长度，无效返回 0 */
+static size_t ogg_page_size(const uint8_t* data, size_t size, size_t offset) {
+    if (offset + 27 > size || memcmp(data + offset, "OggS", 4) != 0 || data[offset + 4] != 0) {
+        return 0;
+    }
+    size_t segments = data[offset + 26];
+    if (offset + 27 + segments > size) {
+        return 0;
+    }
+    size_t body = 0;
+    for (size_t i = 0; i < segments; i++) {
+        body += data[offset + 27 + i];
+    }
+    if (offset + 27 + segments + body > size) {
+        return 0;
+    }
+    return 27 + segments + body;
+}
+
+/* 取下一个包（只取第一个逻辑流）；返回 1 有包，0 结束，-1 数据损坏 */
+static int ogg_next_packet(transcode_reader_t* reader) {
+    reader->packet_len = 0;
+    for (;;) {
+        if (reader->segments == 0) {
+            if (reader->page >= reader->size) {
+                return 0;
+            }
+            size_t page_size = ogg_page_size(reader->data, reader->size, reader->page);
+            if (page_size == 0) {
+                LOG_ERROR("转码：Ogg 页损坏（%zu 字节处）", reader->page);
+                return -1;
+            }
+            if (read_le32(reader->data + reader->page + 14) != reader->serial) {
+                reader->page += page_size;
+                continue;
+            }
+            reader->segments = reader->data[reader->page + 26];
+            reader->segment = 0;
+            reader->body = reader->page + 27 + reader->segments;
+            if (reader->segments == 0) {
+                reader->page += page_size;
+                continue;
+            }
+        }
+
+        const uint8_t* lacing = reader->data + reader->page + 27;
+        while (reader->segment < reader->segments) {
+            size_t length = lacing[reader->segment++];
+            if (reader->packet_len + length > TRANSCODE_MAX_PACKET) {
+                LOG_ERROR("转码：Ogg 包超过 %d 字节", TRANSCODE_MAX_PACKET);
+                return -1;
+            }
+            memcpy(reader->packet + reader->packet_len, reader->data + reader->body, length);
+            reader->packet_len += length;
+            reader->body += length;
+            if (length < 255) {
+                if (reader->segment == reader->segments) {
+                    reader->page = reader->body;
+                    reader->segments = 0;
+                }
+                return 1;
+            }
+        }
+        // 包跨页，继续拼接下一页
+        reader->page = reader->body;
+        reader->segments = 0;
+    }
+}
+
+static bool ogg_open(transcode_reader_t* reader, const uint8_t* data, size_t size, int target_rate) {
+    reader->data = data;
+    reader->size = size;
+    if (ogg_page_size(data, size, 0) == 0) {
+        LOG_ERROR("转码：不是 Ogg 文件");
+        return false;
+    }
+    reader->serial = read_le32(data + 14);
+
+    // 最后一页的 granule 给出总时长，用于去掉编码器在末尾补的样本
+    uint64_t last_granule = UINT64_MAX;
+    for (size_t offset = 0; offset < size;) {
+        size_t page_size = ogg_page_size(data, size, offset);
+        if (page_size == 0) {
+            break;
+        }
+        uint64_t granule = read_le64(data + offset + 6);
+        if (read_le32(data + offset + 14) == reader->serial && granule != UINT64_MAX) {
+            last_granule = granule;
+        }
+        offset += page_size;
+    }
+
+    reader->packet = (uint8_t*)LINX_MALLOC(TRANSCODE_MAX_PACKET);
+    if (!reader->packet) {
+        return false;
+    }
+    if (ogg_next_packet(reader) != 1 || reader->packet_len < 19 || memcmp(reader->packet, "OpusHead", 8) != 0) {
+        LOG_ERROR("转码：Ogg 文件不是 Opus");
+        return false;
+    }
+    int channels = reader->packet[9];
+    uint16_t pre_skip = read_le16(reader->packet + 10);
+    if (reader->packet[18] != 0 || channels < 1 || channels > 2) {
+        LOG_ERROR("转码：不支持的 Ogg Opus 声道映射（族 %u，%d 声道）", reader->packet[18], channels);
+        return false;
+    }
+    if (ogg_next_packet(reader) != 1 || reader->packet_len < 8 || memcmp(reader->packet, "OpusTags", 8) != 0) {
+        LOG_ERROR("转码：Ogg Opus 缺少 OpusTags");
+        return false;
+    }
+
+    // Opus 可以直接解码到这几个采样率，目标采样率是其中之一时省掉重采样
+    reader->sample_rate = 48000;
+    if (target_rate == 8000 || target_rate == 12000 || target_rate == 16000 || target_rate == 24000) {
+        reader->sample_rate = target_rate;
+    }
+    reader->channels = channels;
+    int scale = 48000 / reader->sample_rate;
+    reader->skip_frames = pre_skip / scale;
+    reader->remaining_frames = UINT64_MAX;
+    if (last_granule != UINT64_MAX) {
+        reader->remaining_frames = last_granule > pre_skip ? (last_granule - pre_skip) / scale : 0;
+    }
+    return reader_open_decoder(reader, "opus");
+}
+
+static bool ogg_next(transcode_reader_t* reader, size_t* frames) {
+    *frames = 0;
+    while (*frames == 0 && reader->remaining_frames > 0) {
+        int result = ogg_next_packet(reader);
+        if (result <= 0) {
+            return result == 0;
+        }
+        if (reader->packet_len == 0) {
+            continue;
+        }
+        size_t decoded = 0;
+        if (audio_codec_decode(reader->decoder, reader->packet, reader->packet_len, reader->pcm,
+                               reader->pcm_capacity, &decoded) != CODEC_SUCCESS) {
+            LOG_ERROR("转码：Ogg Opus 解码失败（%zu 字节处）", reader->page);
+            return false;
+        }
+        size_t count = decoded / (size_t)reader->channels;
+        size_t skip = count < reader->skip_frames ? count : reader->skip_frames;
+        reader->skip_frames -= skip;
+        count -= skip;
+        if (skip > 0 && count > 0) {
+            memmove(reader->pcm, reader->pcm + skip * reader->channels, count * reader->channels * sizeof(int16_t));
+        }
+        if (count > reader->remaining_frames) {
+            count = (size_t)reader->remaining_frames;
+        }
+        if (reader->remaining_frames != UINT64_MAX) {
+            reader->remaining_frames -= count;
+        }
+        *frames = count;
+    }
+    return true;
+}
+
+static linx_transcode_format_t detect_format(const linx_transcode_source_t* source) {
+    const uint8_t* data = (const uint8_t*)source->data;
+    if (source->format != LINX_TRANSCODE_AUTO) {
+        return source->format;
+    }
+    if (source->size >= 12 && memcmp(data, "RIFF", 4) == 0 && memcmp(data + 8, "WAVE", 4) == 0) {
+        return LINX_TRANSCODE_WAV;
+    }
+    if (source->size >= 4 && memcmp(data, "OggS", 4) == 0) {
+        return LINX_TRANSCODE_OGG_OPUS;
+    }
+    return LINX_TRANSCODE_AUTO;
+}
+
+static bool reader_open(transcode_reader_t* reader, const linx_transcode_source_t* source, int target_rate) {
+    memset(reader, 0, sizeof(*reader));
+    const uint8_t* data = (const uint8_t*)source->data;
+    switch (detect_format(source)) {
+    case LINX_TRANSCODE_WAV:
+        reader->kind = READER_PCM;
+        if (!wav_open(reader, data, source->size)) {
+            return false;
+        }
+        break;
+    case LINX_TRANSCODE_PCM16:
+        reader->kind = READER_PCM;
+        reader->data = data;
+        reader->size = source->size;
+        reader->sample_rate = source->sample_rate;
+        reader->channels = source->channels;
+        reader->bits = 16;
+        break;
+    case LINX_TRANSCODE_PACKETS:
+        reader->kind = READER_PACKETS;
+        reader->data = data;
+        reader->size = source->size;
+        reader->sample_rate = source->sample_rate;
+        reader->channels = source->channels;
+        break;
+    case LINX_TRANSCODE_OGG_OPUS:
+        reader->kind = READER_OGG;
+        return ogg_open(reader, data, source->size, target_rate);
+    default:
+        LOG_ERROR("转码：无法识别源格式");
+        return false;
+    }
+
+    if (reader->sample_rate <= 0 || reader->channels < 1 || reader->channels > LINX_TRANSCODE_MAX_CHANNELS) {
+        LOG_ERROR("转码：源格式无效（%d Hz，%d 声道）", reader->sample_rate, reader->channels);
+        return false;
+    }
+    if (reader->kind == READER_PACKETS) {
+        return reader_open_decoder(reader, source->codec);
+    }
+    return reader_alloc_pcm(reader, (size_t)TRANSCODE_BLOCK_FRAMES * reader->channels);
+}
+
+/* 读下一块；frames 为 0 表示读完 */
+static bool reader_next(transcode_reader_t* reader, size_t* frames) {
+    switch (reader->kind) {
+    case READER_PACKETS:
+        return packets_next(reader, frames);
+    case READER_OGG:
+        return ogg_next(reader, frames);
+    default:
+        return pcm_next(reader, frames);
+    }
+}
+
+static void reader_close(transcode_reader_t* reader) {
+    if (reader->decoder) {
+        audio_codec_destroy(reader->decoder);
+    }
+    LINX_FREE(reader->pcm);
+    LINX_FREE(reader->packet);
+}
+
+/* ==================== 转码 ==================== */
+
+/* 源读取之后的各级：声道混缩、重采样、分帧编码，结果追加到 output */
+typedef struct {
+    const linx_transcode_cache_config_t* config;
+    int source_channels;
+    audio_resampler_t* resampler;
+    size_t resampler_skip;          // 还要丢弃的重采样输出帧（滤波器群延迟）
+    int16_t* mixed;                 // 混缩后的一块
+    int16_t* resampled;
+    size_t resampled_capacity;      // 帧数
+    audio_codec_t* encoder;
+    int16_t* frame;                 // 正在凑的一帧
+    size_t frame_samples;           // 每帧样本数（所有声道合计）
+    size_t frame_fill;
+    uint8_t* packet;
+    size_t packet_capacity;
+    uint8_t* output;                // 存储记录，包序列从 TRANSCODE_HEADER_SIZE 开始
+    size_t output_size;
+    size_t output_capacity;
+} transcode_pipeline_t;
+
+static bool pipeline_append(transcode_pipeline_t* pipe, const uint8_t* packet, size_t length) {
+    size_t limit = TRANSCODE_HEADER_SIZE + pipe->config->max_asset_bytes;
+    size_t needed = pipe->output_size + 2 + length;
+    if (length == 0 || length > 0xFFFF || needed > limit) {
+        LOG_ERROR("转码：结果超过 %zu 字节", pipe->config->max_asset_bytes);
+        return false;
+    }
+    if (needed > pipe->output_capacity) {
+        size_t capacity = pipe->output_capacity ? pipe->output_capacity * 2 : 4096;
+        while (capacity < needed) {
+            capacity *= 2;
+        }
+        if (capacity > limit) {
+            capacity = limit;
+        }
+        uint8_t* grown = (uint8_t*)LINX_REALLOC_BULK(pipe->output, capacity);
+        if (!grown) {
+            LOG_ERROR("转码：输出缓冲区分配失败（%zu 字节）", capacity);
+            return false;
+        }
+        pipe->output = grown;
+        pipe->output_capacity = capacity;
+    }
+    pipe->output[pipe->output_size] = (uint8_t)(length >> 8);
+    pipe->output[pipe->output_size + 1] = (uint8_t)length;
+    memcpy(pipe->output + pipe->output_size + 2, packet, length);
+    pipe->output_size = needed;
+    return true;
+}
+
+static bool pipeline_encode_frame(transcode_pipeline_t* pipe) {
+    size_t encoded = 0;
+    if (audio_codec_encode(pipe->encoder, pipe->frame, pipe->frame_samples, pipe->packet, pipe->packet_capacity,
+                           &encoded) != CODEC_SUCCESS) {
+        LOG_ERROR("转码：编码失败");
+        return false;
+    }
+    pipe->frame_fill = 0;
+    return pipeline_append(pipe, pipe->packet, encoded);
+}
+
+/* 目标采样率和声道数的 PCM 分帧编码 */
+static bool pipeline_push_frames(transcode_pipeline_t* pipe, const int16_t* pcm, size_t frames) {
+    size_t samples = frames * (size_t)pipe->config->channels;
+    while (samples > 0) {
+        size_t count = pipe->frame_samples - pipe->frame_fill;
+        if (count > samples) {
+            count = samples;
+        }
+        memcpy(pipe->frame + pipe->frame_fill, pcm, count * sizeof(int16_t));
+        pipe->frame_fill += count;
+        pcm += count;
+        samples -= count;
+        if (pipe->frame_fill == pipe->frame_samples && !pipeline_encode_frame(pipe)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* 目标声道数、源采样率的 PCM 重采样后分帧 */
+static bool pipeline_push_mixed(transcode_pipeline_t* pipe, const int16_t* pcm, size_t frames) {
+    if (!pipe->resampler) {
+        return pipeline_push_frames(pipe, pcm, frames);
+    }
+    int channels = pipe->config->channels;
+    while (frames > 0) {
+        size_t consumed = 0;
+        size_t produced = audio_resampler_process(pipe->resampler, pcm, frames, &consumed, pipe->resampled,
+                                                  pipe->resampled_capacity);
+        const int16_t* out = pipe->resampled;
+        size_t skip = produced < pipe->resampler_skip ? produced : pipe->resampler_skip;
+        pipe->resampler_skip -= skip;
+        if (!pipeline_push_frames(pipe, out + skip * channels, produced - skip)) {
+            return false;
+        }
+        if (consumed == 0 && produced == 0) {
+            break;
+        }
+        pcm += consumed * channels;
+        frames -= consumed;
+    }
+    return true;
+}
+
+/* 源声道数转到目标声道数：单声道取平均，其他按声道序号循环取用 */
+static bool pipeline_push(transcode_pipeline_t* pipe, const int16_t* pcm, size_t frames) {
+    int in_channels = pipe->source_channels;
+    int out_channels = pipe->config->channels;
+    if (in_channels == out_channels) {
+        return pipeline_push_mixed(pipe, pcm, frames);
+    }
+    for (size_t i = 0; i < frames; i++) {
+        const int16_t* in = pcm + i * in_channels;
+        int16_t* out = pipe->mixed + i * out_channels;
+        if (out_channels == 1) {
+            int32_t sum = 0;
+            for (int c = 0; c < in_channels; c++) {
+                sum += in[c];
+            }
+            out[0] = (int16_t)(sum / in_channels);
+        } else {
+            for (int c = 0; c < out_channels; c++) {
+                out[c] = in[c % in_channels];
+            }
+        }
+    }
+    return pipeline_push_mixed(pipe, pipe->mixed, frames);
+}
+
+/* 冲出重采样器中的尾部，补齐最后一帧 */
+static bool pipeline_finish(transcode_pipeline_t* pipe, int source_rate) {
+    if (pipe->resampler) {
+        unsigned int latency_us = audio_resampler_latency_us(pipe->resampler);
+        size_t tail = (size_t)(((uint64_t)latency_us * (uint64_t)source_rate + 999999) / 1000000) + 1;
+        memset(pipe->mixed, 0, (size_t)TRANSCODE_BLOCK_FRAMES * pipe->config->channels * sizeof(int16_t));
+        while (tail > 0) {
+            size_t count = tail < TRANSCODE_BLOCK_FRAMES ? tail : TRANSCODE_BLOCK_FRAMES;
+            if (!pipeline_push_mixed(pipe, pipe->mixed, count)) {
+                return false;
+            }
+            tail -= count;
+        }
+    }
+    if (pipe->frame_fill > 0) {
+        memset(pipe->frame + pipe->frame_fill, 0, (pipe->frame_samples - pipe->frame_fill) * sizeof(int16_t));
+        return pipeline_encode_frame(pipe);
+    }
+    return true;
+}
+
+static bool pipeline_open(transcode_pipeline_t* pipe, const linx_transcode_cache_config_t* config,
+                          const transcode_reader_t* reader) {
+    memset(pipe, 0, sizeof(*pipe));
+    pipe->config = config;
+    pipe->source_channels = reader->channels;
+    pipe->output_size = TRANSCODE_HEADER_SIZE;
+
+    size_t block_samples = (size_t)TRANSCODE_BLOCK_FRAMES * config->channels;
+    // 解码器一次可能给出多于一块的帧（如 120ms 的 Opus 包），混缩缓冲区按读取器的输出块计
+    size_t reader_frames = reader->pcm_capacity / (size_t)reader->channels;
+    size_t mixed_frames = reader_frames > TRANSCODE_BLOCK_FRAMES ? reader_frames : TRANSCODE_BLOCK_FRAMES;
+    pipe->mixed = (int16_t*)LINX_MALLOC(mixed_frames * config->channels * sizeof(int16_t));
+    if (!pipe->mixed || block_samples == 0) {
+        return false;
+    }
+
+    if (reader->sample_rate != config->sample_rate) {
+        pipe->resampler = audio_resampler_create((unsigned int)reader->sample_rate,
+                                                 (unsigned int)config->sample_rate, config->channels,
+                                                 TRANSCODE_BLOCK_FRAMES);
+        if (!pipe->resampler) {
+            LOG_ERROR("转码：重采样器创建失败（%d -> %d Hz）", reader->sample_rate, config->sample_rate);
+            return false;
+        }
+        pipe->resampler_skip = (size_t)((uint64_t)audio_resampler_latency_us(pipe->resampler) *
+                                        (uint64_t)config->sample_rate / 1000000);
+        pipe->resampled_capacity = audio_resampler_max_output(pipe->resampler, TRANSCODE_BLOCK_FRAMES);
+        pipe->resampled = (int16_t*)LINX_MALLOC(pipe->resampled_capacity * config->channels * sizeof(int16_t));
+        if (!pipe->resampled) {
+            return false;
+        }
+    }
+
+    pipe->encoder = codec_factory_create_for_format(config->codec);
+    if (!pipe->encoder) {
+        LOG_ERROR("转码：不支持的目标格式 %s", config->codec);
+        return false;
+    }
+    audio_format_t format;
+    audio_format_init(&format, config->sample_rate, config->channels, 16, config->frame_duration_ms);
+    if (audio_codec_init_encoder(pipe->encoder, &format) != CODEC_SUCCESS) {
+        LOG_ERROR("转码：%s 编码器初始化失败（%d Hz，%d 声道，%d ms）", config->codec, config->sample_rate,
+                  config->channels, config->frame_duration_ms);
+        return false;
+    }
+    pipe->frame_samples = (size_t)config->sample_rate * config->frame_duration_ms / 1000 * config->channels;
+    int max_output = audio_codec_get_max_output_size(pipe->encoder);
+    pipe->packet_capacity = max_output > 0 ? (size_t)max_output : 4000;
+    pipe->frame = (int16_t*)LINX_MALLOC(pipe->frame_samples * sizeof(int16_t));
+    pipe->packet = (uint8_t*)LINX_MALLOC(pipe->packet_capacity);
+    return pipe->frame_samples > 0 && pipe->frame && pipe->packet;
+}
+
+static void pipeline_close(transcode_pipeline_t* pipe) {
+    if (pipe->resampler) {
+        audio_resampler_destroy(pipe->resampler);
+    }
+    if (pipe->encoder) {
+        audio_codec_destroy(pipe->encoder);
+    }
+    LINX_FREE(pipe->mixed);
+    LINX_FREE(pipe->resampled);
+    LINX_FREE(pipe->frame);
+    LINX_FREE(pipe->packet);
+    LINX_FREE(pipe->output);
+}
+
+/* 转码一个资源，成功时返回存储记录（头部待填）并输出记录长度 */
+static uint8_t* transcode(linx_transcode_cache_t* cache, const transcode_job_t* job, size_t* record_size,
+                          const linx_cancel_token_t* token) {
+    transcode_reader_t reader;
+    transcode_pipeline_t pipe;
+    memset(&pipe, 0, sizeof(pipe));
+    bool ok = reader_open(&reader, &job->source, cache->config.sample_rate) &&
+              pipeline_open(&pipe, &cache->config, &reader);
+
+    while (ok) {
+        size_t frames = 0;
+        if (linx_cancel_token_is_cancelled(token) || !reader_next(&reader, &frames)) {
+            ok = false;
+            break;
+        }
+        if (frames == 0) {
+            ok = pipeline_finish(&pipe, reader.sample_rate);
+            break;
+        }
+        ok = pipeline_push(&pipe, reader.pcm, frames);
+    }
+    if (ok && pipe.output_size == TRANSCODE_HEADER_SIZE) {
+        LOG_ERROR("转码：%s 没有音频", job->name);
+        ok = false;
+    }
+
+    uint8_t* record = NULL;
+    if (ok) {
+        if (reader.sample_rate != cache->config.sample_rate || reader.channels != cache->config.channels) {
+            LOG_INFO("转码 %s：%d Hz %d 声道 -> %d Hz %d 声道，%zu 字节", job->name, reader.sample_rate,
+                     reader.channels, cache->config.sample_rate, cache->config.channels,
+                     pipe.output_size - TRANSCODE_HEADER_SIZE);
+        } else {
+            LOG_INFO("转码 %s：%zu 字节", job->name, pipe.output_size - TRANSCODE_HEADER_SIZE);
+        }
+        // 缩小到实际长度，输出缓冲区交给调用者
+        record = (uint8_t*)LINX_REALLOC_BULK(pipe.output, pipe.output_size);
+        if (!record) {
+            record = pipe.output;
+        }
+        *record_size = pipe.output_size;
+        pipe.output = NULL;
+    }
+    pipeline_close(&pipe);
+    reader_close(&reader);
+    return record;
+}
+
+/* ==================== 缓存 ==================== */
+
+static uint64_t source_hash(const linx_transcode_source_t* source) {
+    int32_t params[3] = { (int32_t)source->format, source->sample_rate, source->channels };
+    const char* codec = source->codec ? source->codec : "opus";
+    uint64_t hash = fnv1a64(14695981039346656037ULL, params, sizeof(params));
+    hash = fnv1a64(hash, codec, strlen(codec));
+    hash = fnv1a64(hash, source->data, source->size);
+    return hash ? hash : 1;
+}
+
+static transcode_entry_t* find_entry(linx_transcode_cache_t* cache, const char* name) {
+    for (size_t i = 0; i < cache->count; i++) {
+        if (strcmp(cache->entries[i]->name, name) == 0) {
+            return cache->entries[i];
+        }
+    }
+    return NULL;
+}
+
+static void entry_to_asset(const transcode_entry_t* entry, linx_sound_asset_t* asset) {
+    asset->name = entry->name;
+    asset->format = LINX_SOUND_PACKETS;
+    asset->data = entry->record + TRANSCODE_HEADER_SIZE;
+    asset->size = entry->payload_size;
+}
+
+/* 存入结果（持锁），返回条目；同名条目的旧记录保留到销毁 */
+static transcode_entry_t* insert_entry(linx_transcode_cache_t* cache, const char* name, uint64_t hash,
+                                       uint8_t* record, size_t record_size) {
+    transcode_entry_t* entry = find_entry(cache, name);
+    if (entry) {
+        uint8_t** retired = (uint8_t**)LINX_REALLOC(cache->retired, (cache->retired_count + 1) * sizeof(uint8_t*));
+        if (!retired) {
+            return NULL;
+        }
+        cache->retired = retired;
+        cache->retired[cache->retired_count++] = entry->record;
+    } else {
+        if (cache->count == cache->capacity) {
+            size_t capacity = cache->capacity ? cache->capacity * 2 : 8;
+            transcode_entry_t** grown = (transcode_entry_t**)LINX_REALLOC(cache->entries,
+                                                                          capacity * sizeof(transcode_entry_t*));
+            if (!grown) {
+                return NULL;
+            }
+            cache->entries = grown;
+            cache->capacity = capacity;
+        }
+        entry = (transcode_entry_t*)LINX_CALLOC(1, sizeof(transcode_entry_t));
+        if (!entry) {
+            return NULL;
+        }
+        snprintf(entry->name, sizeof(entry->name), "%s", name);
+        cache->entries[cache->count++] = entry;
+        cache->stats.entries = cache->count;
+    }
+    entry->source_hash = hash;
+    entry->record = record;
+    entry->payload_size = record_size - TRANSCODE_HEADER_SIZE;
+    cache->stats.bytes += record_size;
+    return entry;
+}
+
+/* 从存储装入；hash 为 0 时不比较源数据 */
+static uint8_t* store_load(linx_transcode_cache_t* cache, const char* key, uint64_t hash, size_t* record_size) {
+    const linx_kv_store_t* store = &cache->config.store;
+    size_t capacity = TRANSCODE_HEADER_SIZE + cache->config.max_asset_bytes;
+    uint8_t* record = (uint8_t*)LINX_MALLOC_BULK(capacity);
+    if (!record) {
+        return NULL;
+    }
+    size_t length = 0;
+    if (!store->load(store->user_data, key, record, capacity, &length) || length <= TRANSCODE_HEADER_SIZE ||
+        read_le32(record) != TRANSCODE_MAGIC || read_le16(record + 4) != TRANSCODE_VERSION ||
+        read_le16(record + 6) != TRANSCODE_HEADER_SIZE || read_le32(record + 16) != cache->target_hash ||
+        read_le32(record + 20) != length - TRANSCODE_HEADER_SIZE ||
+        (hash != 0 && read_le64(record + 8) != hash) ||
+        !packets_valid(record + TRANSCODE_HEADER_SIZE, length - TRANSCODE_HEADER_SIZE)) {
+        LINX_FREE(record);
+        return NULL;
+    }
+    uint8_t* shrunk = (uint8_t*)LINX_REALLOC_BULK(record, length);
+    *record_size = length;
+    return shrunk ? shrunk : record;
+}
+
+/* 回调并结束任务；asset 在持锁时从条目取得，之后同名条目被替换也不影响 */
+static void job_finish(transcode_job_t* job, const linx_sound_asset_t* asset) {
+    linx_transcode_cache_t* cache = job->cache;
+    if (job->done) {
+        job->done(job->user_data, job->name, asset);
+    }
+
+    pthread_mutex_lock(&cache->mutex);
+    if (--cache->stats.pending == 0) {
+        pthread_cond_broadcast(&cache->idle);
+    }
+    pthread_mutex_unlock(&cache->mutex);
+    LINX_FREE(job);
+}
+
+static void transcode_task(void* arg, const linx_cancel_token_t* token) {
+    transcode_job_t* job = (transcode_job_t*)arg;
+    linx_transcode_cache_t* cache = job->cache;
+    if (linx_cancel_token_is_cancelled(token)) {
+        job_finish(job, NULL);
+        return;
+    }
+
+    bool has_source = job->source.data != NULL;
+    uint64_t hash = has_source ? source_hash(&job->source) : 0;
+
+    // RAM 中已有
+    linx_sound_asset_t asset;
+    pthread_mutex_lock(&cache->mutex);
+    transcode_entry_t* entry = find_entry(cache, job->name);
+    bool cached = entry && (!has_source || entry->source_hash == hash);
+    if (cached) {
+        entry_to_asset(entry, &asset);
+    }
+    pthread_mutex_unlock(&cache->mutex);
+    if (cached) {
+        job_finish(job, &asset);
+        return;
+    }
+
+    char key[sizeof(TRANSCODE_KEY_PREFIX) + LINX_TRANSCODE_MAX_NAME];
+    make_key(job->name, key, sizeof(key));
+    bool from_store = false;
+    size_t record_size = 0;
+    uint8_t* record = NULL;
+    if (store_ready(&cache->config.store)) {
+        record = store_load(cache, key, hash, &record_size);
+        from_store = record != NULL;
+    }
+    if (!record && has_source) {
+        record = transcode(cache, job, &record_size, token);
+        if (record) {
+            write_le32(record, TRANSCODE_MAGIC);
+            write_le16(record + 4, TRANSCODE_VERSION);
+            write_le16(record + 6, TRANSCODE_HEADER_SIZE);
+            write_le64(record + 8, hash);
+            write_le32(record + 16, cache->target_hash);
+            write_le32(record + 20, (uint32_t)(record_size - TRANSCODE_HEADER_SIZE));
+            const linx_kv_store_t* store = &cache->config.store;
+            if (store_ready(store) && !store->store(store->user_data, key, record, record_size)) {
+                LOG_WARN("转码结果 %s 写入存储失败，本次运行仍可使用", job->name);
+            }
+        }
+    }
+    if (!record && !has_source) {
+        LOG_WARN("转码缓存：存储中没有 %s 的可用结果", job->name);
+    }
+
+    pthread_mutex_lock(&cache->mutex);
+    entry = record ? insert_entry(cache, job->name, from_store ? read_le64(record + 8) : hash, record, record_size)
+                   : NULL;
+    if (entry) {
+        entry_to_asset(entry, &asset);
+        if (from_store) {
+            cache->stats.store_hits++;
+        } else {
+            cache->stats.transcodes++;
+            cache->stats.source_bytes += job->source.size;
+        }
+    } else {
+        cache->stats.failures++;
+    }
+    pthread_mutex_unlock(&cache->mutex);
+    if (record && !entry) {
+        LINX_FREE(record);
+    }
+    job_finish(job, entry ? &asset : NULL);
+}
+
+linx_transcode_cache_t* linx_transcode_cache_create(const linx_transcode_cache_config_t* config) {
+    if (!config || !config->executor || config->sample_rate <= 0) {
+        LOG_ERROR("转码缓存配置无效");
+        return NULL;
+    }
+    linx_transcode_cache_t* cache = (linx_transcode_cache_t*)LINX_CALLOC(1, sizeof(linx_transcode_cache_t));
+    if (!cache) {
+        LOG_ERROR("转码缓存分配失败");
+        return NULL;
+    }
+    cache->config = *config;
+    if (!cache->config.codec) {
+        cache->config.codec = "opus";
+    }
+    if (cache->config.channels <= 0) {
+        cache->config.channels = 1;
+    }
+    if (cache->config.frame_duration_ms <= 0) {
+        cache->config.frame_duration_ms = LINX_TRANSCODE_DEFAULT_FRAME_MS;
+    }
+    if (cache->config.max_asset_bytes == 0) {
+        cache->config.max_asset_bytes = LINX_TRANSCODE_DEFAULT_MAX_ASSET_BYTES;
+    }
+    if (cache->config.channels > 2) {
+        LOG_ERROR("转码缓存：目标声道数 %d 无效", cache->config.channels);
+        LINX_FREE(cache);
+        return NULL;
+    }
+
+    char target[64];
+    snprintf(target, sizeof(target), "%s/%d/%d/%d", cache->config.codec, cache->config.sample_rate,
+             cache->config.channels, cache->config.frame_duration_ms);
+    cache->target_hash = (uint32_t)fnv1a64(14695981039346656037ULL, target, strlen(target));
+
+    cache->token = linx_cancel_token_create();
+    if (!cache->token) {
+        LINX_FREE(cache);
+        return NULL;
+    }
+    pthread_mutex_init(&cache->mutex, NULL);
+    pthread_cond_init(&cache->idle, NULL);
+    return cache;
+}
+
+void linx_transcode_cache_destroy(linx_transcode_cache_t* cache) {
+    if (!cache) {
+        return;
+    }
+    linx_cancel_token_cancel(cache->token);
+    pthread_mutex_lock(&cache->mutex);
+    while (cache->stats.pending > 0) {
+        pthread_cond_wait(&cache->idle, &cache->mutex);
+    }
+    pthread_mutex_unlock(&cache->mutex);
+
+    for (size_t i = 0; i < cache->count; i++) {
+        LINX_FREE(cache->entries[i]->record);
+        LINX_FREE(cache->entries[i]);
+    }
+    for (size_t i = 0; i < cache->retired_count; i++) {
+        LINX_FREE(cache->retired[i]);
+    }
+    LINX_FREE(cache->entries);
+    LINX_FREE(cache->retired);
+    linx_cancel_token_release(cache->token);
+    pthread_cond_destroy(&cache->idle);
+    pthread_mutex_destroy(&cache->mutex);
+    LINX_FREE(cache);
+}
+
+bool linx_transcode_cache_submit(linx_transcode_cache_t* cache, const char* name,
+                                 const linx_transcode_source_t* source,
+                                 linx_transcode_done_cb_t done, void* user_data) {
+    if (!cache || !name || !name[0] || !source || (source->data && source->size == 0)) {
+        return false;
+    }
+    if (strlen(name) > LINX_TRANSCODE_MAX_NAME) {
+        LOG_ERROR("转码缓存：资源名过长 %s", name);
+        return false;
+    }
+    transcode_job_t* job = (transcode_job_t*)LINX_CALLOC(1, sizeof(transcode_job_t));
+    if (!job) {
+        return false;
+    }
+    job->cache = cache;
+    snprintf(job->name, sizeof(job->name), "%s", name);
+    job->source = *source;
+    job->done = done;
+    job->user_data = user_data;
+
+    pthread_mutex_lock(&cache->mutex);
+    cache->stats.pending++;
+    pthread_mutex_unlock(&cache->mutex);
+    if (!linx_executor_submit(cache->config.executor, LINX_TASK_PRIORITY_LOW, transcode_task, job, cache->token)) {
+        LOG_WARN("转码缓存：%s 提交失败", name);
+        pthread_mutex_lock(&cache->mutex);
+        if (--cache->stats.pending == 0) {
+            pthread_cond_broadcast(&cache->idle);
+        }
+        pthread_mutex_unlock(&cache->mutex);
+        LINX_FREE(job);
+        return false;
+    }
+    return true;
+}
+
+bool linx_transcode_cache_get(linx_transcode_cache_t* cache, const char* name, linx_sound_asset_t* asset) {
+    if (!cache || !name || !asset) {
+        return false;
+    }
+    pthread_mutex_lock(&cache->mutex);
+    transcode_entry_t* entry = find_entry(cache, name);
+    if (entry) {
+        entry_to_asset(entry, asset);
+    }
+    pthread_mutex_unlock(&cache->mutex);
+    return entry != NULL;
+}
+
+bool linx_transcode_cache_get_stats(linx_transcode_cache_t* cache, linx_transcode_cache_stats_t* stats) {
+    if (!cache || !stats) {
+        return false;
+    }
+    pthread_mutex_lock(&cache->mutex);
+    *stats = cache->stats;
+    pthread_mutex_unlock(&cache->mutex);
+    return true;
+}
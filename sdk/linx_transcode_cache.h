@@ -0,0 +1,142 @@
+/**
+ * @file linx_transcode_cache.h
+ * @brief 提示音转码缓存
+ *
+ * OTA 下发的提示音格式各异：不同采样率、声道数的 WAV，Ogg Opus 文件，其他采样率的编码包。
+ * 播放时再做重采样或解码陌生格式，既占播放路径的算力，也要为每种格式常驻一个解码器。
+ * 本缓存在后台把每个资源转码一次，得到设备原生的播放格式：目标编码（默认 Opus）、
+ * 目标采样率、声道数和帧长，按 2 字节大端长度前缀的包序列保存（即 LINX_SOUND_PACKETS），
+ * 可直接交给 linx_sound_bank_add() 与服务器下发的音频走同一个解码器。
+ *
+ * - 转码在 linx_executor 的工作线程上以 LOW 优先级进行，逐块解码、混缩声道、重采样、
+ *   编码，不把整段 PCM 放进内存
+ * - 结果写入 linx_kv_store_t（通常是 linx_kv_file_store()），记录中带源数据的哈希和目标
+ *   格式；下次提交同一资源时直接从存储装入，不再转码；源数据已删除时也可以只按名称装入
+ * - 目标格式（如 hello 协商的下行采样率）改变后，存储中的旧结果不再匹配，提交时重新转码
+ *
+ * 转码结果在缓存销毁前一直有效；同名资源换了源数据重新转码时，旧结果也保留到销毁，
+ * 已登记到提示音库的指针不会失效。线程安全。
+ */
+
+#ifndef LINX_TRANSCODE_CACHE_H
+#define LINX_TRANSCODE_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "linx_executor.h"
+#include "linx_session_cache.h"
+#include "play/linx_sound_bank.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 资源名的最大字节数（存储中的键为 "lxtc." + 资源名） */
+#define LINX_TRANSCODE_MAX_NAME 47
+
+/* 源数据的最大声道数 */
+#define LINX_TRANSCODE_MAX_CHANNELS 8
+
+/* 默认目标帧长(毫秒) */
+#ifndef LINX_TRANSCODE_DEFAULT_FRAME_MS
+#define LINX_TRANSCODE_DEFAULT_FRAME_MS 60
+#endif
+
+/* 单个转码结果的默认上限(字节) */
+#ifndef LINX_TRANSCODE_DEFAULT_MAX_ASSET_BYTES
+#define LINX_TRANSCODE_DEFAULT_MAX_ASSET_BYTES (128 * 1024)
+#endif
+
+typedef struct linx_transcode_cache linx_transcode_cache_t;
+
+/* 源格式 */
+typedef enum {
+    LINX_TRANSCODE_AUTO = 0,        // 按文件头识别 WAV 和 Ogg Opus
+    LINX_TRANSCODE_WAV,             // WAV：8/16/24/32 位整数或 32 位浮点 PCM，任意采样率和声道数
+    LINX_TRANSCODE_OGG_OPUS,        // Ogg Opus 文件（映射族 0：单声道或立体声）
+    LINX_TRANSCODE_PCM16,           // 无文件头的交错 16 位小端 PCM
+    LINX_TRANSCODE_PACKETS          // 2 字节大端长度前缀的编码包（与 LINX_SOUND_PACKETS 相同）
+} linx_transcode_format_t;
+
+/* 源数据 */
+typedef struct {
+    linx_transcode_format_t format;
+    const void* data;               // 须在完成回调返回前一直有效；NULL 表示只从存储装入
+    size_t size;
+    int sample_rate;                // PCM16 / PACKETS 的采样率，其他格式从文件头读取
+    int channels;                   // PCM16 / PACKETS 的声道数
+    const char* codec;              // PACKETS 的编码格式名（见 codec_factory.h），NULL 为 "opus"
+} linx_transcode_source_t;
+
+/* 配置（字段为 0 时使用默认值） */
+typedef struct {
+    linx_executor_t* executor;      // 执行转码的执行器（必填，如 linx_sdk_get_executor()），须比缓存活得久
+    linx_kv_store_t store;          // 保存转码结果，load/store 为 NULL 时结果只在 RAM 中
+    const char* codec;              // 目标编码格式名，NULL 为 "opus"；字符串须一直有效
+    int sample_rate;                // 目标采样率（必填，与播放器和提示音库的解码器相同）
+    int channels;                   // 目标声道数（默认 1）
+    int frame_duration_ms;          // 目标帧长（默认 LINX_TRANSCODE_DEFAULT_FRAME_MS）
+    size_t max_asset_bytes;         // 单个结果的上限，超出时转码失败（默认 LINX_TRANSCODE_DEFAULT_MAX_ASSET_BYTES）
+} linx_transcode_cache_config_t;
+
+/* 统计信息 */
+typedef struct {
+    size_t entries;                 // 可用的资源数
+    size_t bytes;                   // 转码结果占用的字节数（含已替换、保留到销毁的旧结果）
+    size_t pending;                 // 排队或正在转码的资源数
+    uint64_t transcodes;            // 完成的转码次数
+    uint64_t store_hits;            // 直接从存储装入的次数
+    uint64_t failures;              // 转码或装入失败的次数
+    uint64_t source_bytes;          // 转码读入的源数据字节数
+} linx_transcode_cache_stats_t;
+
+/**
+ * 完成回调，在执行器的工作线程上调用
+ * @param asset 转码结果（format 为 LINX_SOUND_PACKETS，在缓存销毁前有效），失败时为 NULL
+ */
+typedef void (*linx_transcode_done_cb_t)(void* user_data, const char* name, const linx_sound_asset_t* asset);
+
+/**
+ * 创建缓存
+ * @return 缓存实例，配置无效或内存不足返回 NULL
+ */
+linx_transcode_cache_t* linx_transcode_cache_create(const linx_transcode_cache_config_t* config);
+
+/**
+ * 取消排队的转码，等待正在进行的转码返回，然后销毁缓存
+ * @note 先从提示音库中移除转码结果（或先销毁提示音库），再销毁缓存；不能在完成回调中调用
+ */
+void linx_transcode_cache_destroy(linx_transcode_cache_t* cache);
+
+/**
+ * 提交一个资源
+ *
+ * 存储中有同名、目标格式相同且源数据相同（source->data 为 NULL 时不比较源数据）的结果时
+ * 直接装入，否则转码并写入存储；RAM 中已有相同结果时不做任何 I/O。
+ * @param name 资源名（不超过 LINX_TRANSCODE_MAX_NAME 字节），复制
+ * @param source 源数据（结构体复制，data 不复制）
+ * @param done 完成回调，可为 NULL
+ * @return 已排队返回 true；参数无效、资源名过长或执行器排队已满返回 false（不回调）
+ */
+bool linx_transcode_cache_submit(linx_transcode_cache_t* cache, const char* name,
+                                 const linx_transcode_source_t* source,
+                                 linx_transcode_done_cb_t done, void* user_data);
+
+/**
+ * 按名称获取转码结果
+ * @param asset 输出：format 为 LINX_SOUND_PACKETS，name 和 data 在缓存销毁前有效
+ * @return 已有结果返回 true
+ */
+bool linx_transcode_cache_get(linx_transcode_cache_t* cache, const char* name, linx_sound_asset_t* asset);
+
+/**
+ * 获取统计信息
+ */
+bool linx_transcode_cache_get_stats(linx_transcode_cache_t* cache, linx_transcode_cache_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINX_TRANSCODE_CACHE_H */
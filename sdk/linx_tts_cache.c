@@ -0,0 +1,535 @@
+/**
+ * @file linx_tts_cache.c
+ * @brief 句子级 TTS 音频缓存实现
+ */
+
+#include "linx_tts_cache.h"
+#include "log/linx_alloc.h"
+#include "log/linx_log.h"
+#include <pthread.h>
+#include <string.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_CORE);
+
+#define TTS_CACHE_DEFAULT_MAX_TEXT  256
+#define TTS_CACHE_PACKET_HEADER     3       // 2 字节大端长度 + 1 字节时长
+#define TTS_CACHE_MAGIC             "LTC1"
+#define TTS_CACHE_MAGIC_SIZE        4
+
+struct linx_tts_cache_entry {
+    linx_tts_cache_entry_t* prev;   // LRU 链表，表头最新
+    linx_tts_cache_entry_t* next;
+    uint32_t hash;
+    size_t key_length;              // key 为 音色 '\0' 文本，长度不含结尾的 '\0'
+    uint8_t* data;                  // 包序列：[长度 2B 大端][时长 1B][数据]...
+    size_t data_size;
+    size_t audio_bytes;
+    uint32_t duration_ms;
+    size_t cost;                    // 计入 max_bytes 的字节数
+    int pins;                       // 被 acquire 固定的次数
+    char key[];
+};
+
+struct linx_tts_cache {
+    linx_tts_cache_config_t config;
+    pthread_mutex_t mutex;
+    linx_tts_cache_entry_t* head;
+    linx_tts_cache_entry_t* tail;
+
+    char* lookup_key;               // 查找时拼 key 的缓冲区（持锁使用）
+    size_t key_capacity;
+
+    // 正在录制的句子；record_data 预先按 max_entry_bytes 分配，追加包时不分配内存
+    bool recording;
+    char* record_key;
+    size_t record_key_length;
+    uint8_t* record_data;
+    size_t record_size;
+    size_t record_audio_bytes;
+    uint32_t record_duration_ms;
+
+    linx_tts_cache_stats_t stats;
+};
+
+/* FNV-1a */
+static uint32_t key_hash(const char* key, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ (uint8_t)key[i]) * 16777619u;
+    }
+    return hash;
+}
+
+/* 拼出 音色 '\0' 文本，返回长度；超过 capacity 返回 0 */
+static size_t build_key(char* key, size_t capacity, const char* voice, const char* text) {
+    size_t voice_length = voice ? strlen(voice) : 0;
+    size_t text_length = strlen(text);
+    size_t length = voice_length + 1 + text_length;
+    if (length >= capacity) {
+        return 0;
+    }
+    if (voice_length > 0) {
+        memcpy(key, voice, voice_length);
+    }
+    key[voice_length] = '\0';
+    memcpy(key + voice_length + 1, text, text_length + 1);
+    return length;
+}
+
+static void lru_unlink(linx_tts_cache_t* cache, linx_tts_cache_entry_t* entry) {
+    if (entry->prev) {
+        entry->prev->next = entry->next;
+    } else {
+        cache->head = entry->next;
+    }
+    if (entry->next) {
+        entry->next->prev = entry->prev;
+    } else {
+        cache->tail = entry->prev;
+    }
+    entry->prev = entry->next = NULL;
+}
+
+static void lru_push_front(linx_tts_cache_t* cache, linx_tts_cache_entry_t* entry) {
+    entry->prev = NULL;
+    entry->next = cache->head;
+    if (cache->head) {
+        cache->head->prev = entry;
+    } else {
+        cache->tail = entry;
+    }
+    cache->head = entry;
+}
+
+/* 调用者持有锁 */
+static linx_tts_cache_entry_t* find_entry(linx_tts_cache_t* cache, const char* key, size_t length) {
+    uint32_t hash = key_hash(key, length);
+    for (linx_tts_cache_entry_t* entry = cache->head; entry; entry = entry->next) {
+        if (entry->hash == hash && entry->key_length == length && memcmp(entry->key, key, length) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/* 调用者持有锁 */
+static void free_entry(linx_tts_cache_t* cache, linx_tts_cache_entry_t* entry) {
+    lru_unlink(cache, entry);
+    cache->stats.entries--;
+    cache->stats.bytes -= entry->cost;
+    LINX_FREE(entry->data);
+    LINX_FREE(entry);
+}
+
+/* 从最旧的未固定条目开始淘汰，直到能放下 cost（调用者持有锁） */
+static bool make_room(linx_tts_cache_t* cache, size_t cost) {
+    linx_tts_cache_entry_t* entry = cache->tail;
+    while (cache->stats.bytes + cost > cache->config.max_bytes && entry) {
+        linx_tts_cache_entry_t* prev = entry->prev;
+        if (entry->pins == 0) {
+            free_entry(cache, entry);
+            cache->stats.evictions++;
+        }
+        entry = prev;
+    }
+    return cache->stats.bytes + cost <= cache->config.max_bytes;
+}
+
+/* 新建条目作为最新（调用者持有锁）；data 的所有权转给条目 */
+static bool insert_entry(linx_tts_cache_t* cache, const char* key, size_t key_length,
+                         uint8_t* data, size_t data_size, size_t audio_bytes, uint32_t duration_ms) {
+    size_t cost = sizeof(linx_tts_cache_entry_t) + key_length + 1 + data_size;
+    if (cost > cache->config.max_bytes || find_entry(cache, key, key_length) || !make_room(cache, cost)) {
+        return false;
+    }
+
+    linx_tts_cache_entry_t* entry = (linx_tts_cache_entry_t*)LINX_MALLOC(sizeof(linx_tts_cache_entry_t) + key_length + 1);
+    if (!entry) {
+        return false;
+    }
+    memset(entry, 0, sizeof(*entry));
+    memcpy(entry->key, key, key_length);
+    entry->key[key_length] = '\0';
+    entry->key_length = key_length;
+    entry->hash = key_hash(key, key_length);
+    entry->data = data;
+    entry->data_size = data_size;
+    entry->audio_bytes = audio_bytes;
+    entry->duration_ms = duration_ms;
+    entry->cost = cost;
+    lru_push_front(cache, entry);
+    cache->stats.entries++;
+    cache->stats.bytes += cost;
+    return true;
+}
+
+/* 调用者持有锁 */
+static void reset_recording(linx_tts_cache_t* cache) {
+    cache->record_size = 0;
+    cache->record_audio_bytes = 0;
+    cache->record_duration_ms = 0;
+    cache->record_key_length = 0;
+    cache->recording = false;
+}
+
+linx_tts_cache_t* linx_tts_cache_create(const linx_tts_cache_config_t* config) {
+    if (!config || config->max_bytes == 0) {
+        LOG_ERROR("TTS缓存参数无效");
+        return NULL;
+    }
+
+    linx_tts_cache_t* cache = (linx_tts_cache_t*)LINX_CALLOC(1, sizeof(linx_tts_cache_t));
+    if (!cache) {
+        LOG_ERROR("TTS缓存分配失败");
+        return NULL;
+    }
+    cache->config = *config;
+    if (cache->config.max_entry_bytes == 0 || cache->config.max_entry_bytes > cache->config.max_bytes) {
+        cache->config.max_entry_bytes = cache->config.max_bytes / 4;
+    }
+    if (cache->config.max_text_bytes == 0) {
+        cache->config.max_text_bytes = TTS_CACHE_DEFAULT_MAX_TEXT;
+    }
+
+    // 录制的 key 为 音色 + 文本，音色按文本上限计
+    cache->key_capacity = cache->config.max_text_bytes * 2 + 2;
+    cache->record_key = (char*)LINX_MALLOC(cache->key_capacity);
+    cache->lookup_key = (char*)LINX_MALLOC(cache->key_capacity);
+    cache->record_data = (uint8_t*)LINX_MALLOC_BULK(cache->config.max_entry_bytes);
+    if (!cache->record_key || !cache->lookup_key || !cache->record_data ||
+        pthread_mutex_init(&cache->mutex, NULL) != 0) {
+        LOG_ERROR("TTS缓存初始化失败");
+        LINX_FREE(cache->record_key);
+        LINX_FREE(cache->lookup_key);
+        LINX_FREE(cache->record_data);
+        LINX_FREE(cache);
+        return NULL;
+    }
+
+    LOG_INFO("TTS缓存: 上限 %zu 字节，单句上限 %zu 字节", cache->config.max_bytes, cache->config.max_entry_bytes);
+    return cache;
+}
+
+void linx_tts_cache_destroy(linx_tts_cache_t* cache) {
+    if (!cache) {
+        return;
+    }
+
+    while (cache->head) {
+        free_entry(cache, cache->head);
+    }
+    LINX_FREE(cache->record_data);
+    LINX_FREE(cache->record_key);
+    LINX_FREE(cache->lookup_key);
+    pthread_mutex_destroy(&cache->mutex);
+    LINX_FREE(cache);
+}
+
+linx_tts_cache_entry_t* linx_tts_cache_acquire(linx_tts_cache_t* cache, const char* voice, const char* text) {
+    if (!cache || !text) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&cache->mutex);
+    linx_tts_cache_entry_t* entry = NULL;
+    size_t length = strlen(text) <= cache->config.max_text_bytes ?
+                    build_key(cache->lookup_key, cache->key_capacity, voice, text) : 0;
+    if (length > 0) {
+        entry = find_entry(cache, cache->lookup_key, length);
+    }
+
+    if (entry) {
+        entry->pins++;
+        lru_unlink(cache, entry);
+        lru_push_front(cache, entry);
+        cache->stats.hits++;
+        cache->stats.bytes_saved += entry->audio_bytes;
+    } else {
+        cache->stats.misses++;
+    }
+    pthread_mutex_unlock(&cache->mutex);
+    return entry;
+}
+
+void linx_tts_cache_release(linx_tts_cache_t* cache, linx_tts_cache_entry_t* entry) {
+    if (!cache || !entry) {
+        return;
+    }
+
+    pthread_mutex_lock(&cache->mutex);
+    if (entry->pins > 0) {
+        entry->pins--;
+    }
+    pthread_mutex_unlock(&cache->mutex);
+}
+
+uint32_t linx_tts_cache_entry_duration_ms(const linx_tts_cache_entry_t* entry) {
+    return entry ? entry->duration_ms : 0;
+}
+
+size_t linx_tts_cache_entry_audio_bytes(const linx_tts_cache_entry_t* entry) {
+    return entry ? entry->audio_bytes : 0;
+}
+
+bool linx_tts_cache_entry_next(const linx_tts_cache_entry_t* entry, size_t* offset,
+                               const uint8_t** payload, size_t* size, int* duration_ms) {
+    if (!entry || !offset || *offset + TTS_CACHE_PACKET_HEADER > entry->data_size) {
+        return false;
+    }
+
+    const uint8_t* header = entry->data + *offset;
+    size_t length = ((size_t)header[0] << 8) | header[1];
+    if (*offset + TTS_CACHE_PACKET_HEADER + length > entry->data_size) {
+        return false;
+    }
+    if (payload) {
+        *payload = header + TTS_CACHE_PACKET_HEADER;
+    }
+    if (size) {
+        *size = length;
+    }
+    if (duration_ms) {
+        *duration_ms = header[2];
+    }
+    *offset += TTS_CACHE_PACKET_HEADER + length;
+    return true;
+}
+
+bool linx_tts_cache_record_begin(linx_tts_cache_t* cache, const char* voice, const char* text) {
+    if (!cache || !text || text[0] == '\0') {
+        return false;
+    }
+
+    pthread_mutex_lock(&cache->mutex);
+    if (cache->recording) {
+        cache->stats.rejected++;
+    }
+    reset_recording(cache);
+    size_t length = strlen(text) <= cache->config.max_text_bytes ?
+                    build_key(cache->record_key, cache->key_capacity, voice, text) : 0;
+    if (length > 0 && !find_entry(cache, cache->record_key, length)) {
+        cache->record_key_length = length;
+        cache->recording = true;
+    }
+    bool recording = cache->recording;
+    pthread_mutex_unlock(&cache->mutex);
+    return recording;
+}
+
+bool linx_tts_cache_record_append(linx_tts_cache_t* cache, const uint8_t* payload, size_t size, int duration_ms) {
+    if (!cache || !payload || size == 0) {
+        return false;
+    }
+
+    pthread_mutex_lock(&cache->mutex);
+    if (!cache->recording) {
+        pthread_mutex_unlock(&cache->mutex);
+        return false;
+    }
+
+    size_t needed = cache->record_size + TTS_CACHE_PACKET_HEADER + size;
+    if (size > 0xFFFF || duration_ms <= 0 || duration_ms > 0xFF || needed > cache->config.max_entry_bytes) {
+        // 超长的句子（或无法记录时长的包）整句放弃
+        cache->stats.rejected++;
+        reset_recording(cache);
+        pthread_mutex_unlock(&cache->mutex);
+        return false;
+    }
+
+    uint8_t* header = cache->record_data + cache->record_size;
+    header[0] = (uint8_t)(size >> 8);
+    header[1] = (uint8_t)size;
+    header[2] = (uint8_t)duration_ms;
+    memcpy(header + TTS_CACHE_PACKET_HEADER, payload, size);
+    cache->record_size = needed;
+    cache->record_audio_bytes += size;
+    cache->record_duration_ms += (uint32_t)duration_ms;
+    pthread_mutex_unlock(&cache->mutex);
+    return true;
+}
+
+bool linx_tts_cache_record_commit(linx_tts_cache_t* cache) {
+    if (!cache) {
+        return false;
+    }
+
+    pthread_mutex_lock(&cache->mutex);
+    if (!cache->recording) {
+        pthread_mutex_unlock(&cache->mutex);
+        return false;
+    }
+
+    // 按实际大小拷贝一份交给条目，录制缓冲区留给下一句
+    bool stored = false;
+    uint8_t* data = cache->record_size > 0 ? (uint8_t*)LINX_MALLOC_BULK(cache->record_size) : NULL;
+    if (data) {
+        memcpy(data, cache->record_data, cache->record_size);
+        stored = insert_entry(cache, cache->record_key, cache->record_key_length, data,
+                              cache->record_size, cache->record_audio_bytes, cache->record_duration_ms);
+        if (stored) {
+            cache->stats.inserts++;
+        } else {
+            LINX_FREE(data);
+        }
+    }
+    if (!stored) {
+        cache->stats.rejected++;
+    }
+    reset_recording(cache);
+    pthread_mutex_unlock(&cache->mutex);
+    return stored;
+}
+
+void linx_tts_cache_record_abort(linx_tts_cache_t* cache) {
+    if (!cache) {
+        return;
+    }
+
+    pthread_mutex_lock(&cache->mutex);
+    if (cache->recording) {
+        cache->stats.rejected++;
+    }
+    reset_recording(cache);
+    pthread_mutex_unlock(&cache->mutex);
+}
+
+bool linx_tts_cache_is_recording(linx_tts_cache_t* cache) {
+    if (!cache) {
+        return false;
+    }
+
+    pthread_mutex_lock(&cache->mutex);
+    bool recording = cache->recording;
+    pthread_mutex_unlock(&cache->mutex);
+    return recording;
+}
+
+void linx_tts_cache_clear(linx_tts_cache_t* cache) {
+    if (!cache) {
+        return;
+    }
+
+    pthread_mutex_lock(&cache->mutex);
+    linx_tts_cache_entry_t* entry = cache->head;
+    while (entry) {
+        linx_tts_cache_entry_t* next = entry->next;
+        if (entry->pins == 0) {
+            free_entry(cache, entry);
+        }
+        entry = next;
+    }
+    pthread_mutex_unlock(&cache->mutex);
+}
+
+/*
+ * 序列化格式（整数均为大端）：
+ *   "LTC1" | 条目数 4B | 条目...（从旧到新）
+ *   条目：key 长度 2B | key | 时长 4B | 音频字节数 4B | 包序列长度 4B | 包序列
+ */
+static uint8_t* put_be(uint8_t* p, uint32_t value, int bytes) {
+    for (int i = bytes - 1; i >= 0; i--) {
+        *p++ = (uint8_t)(value >> (8 * i));
+    }
+    return p;
+}
+
+static uint32_t get_be(const uint8_t* p, int bytes) {
+    uint32_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+size_t linx_tts_cache_export(linx_tts_cache_t* cache, uint8_t* buffer, size_t size) {
+    if (!cache) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&cache->mutex);
+    size_t needed = TTS_CACHE_MAGIC_SIZE + 4;
+    uint32_t count = 0;
+    for (linx_tts_cache_entry_t* entry = cache->head; entry; entry = entry->next) {
+        needed += 2 + entry->key_length + 12 + entry->data_size;
+        count++;
+    }
+
+    if (!buffer || needed > size) {
+        pthread_mutex_unlock(&cache->mutex);
+        return buffer ? 0 : needed;
+    }
+
+    uint8_t* p = buffer;
+    memcpy(p, TTS_CACHE_MAGIC, TTS_CACHE_MAGIC_SIZE);
+    p = put_be(p + TTS_CACHE_MAGIC_SIZE, count, 4);
+    for (linx_tts_cache_entry_t* entry = cache->tail; entry; entry = entry->prev) {
+        p = put_be(p, (uint32_t)entry->key_length, 2);
+        memcpy(p, entry->key, entry->key_length);
+        p = put_be(p + entry->key_length, entry->duration_ms, 4);
+        p = put_be(p, (uint32_t)entry->audio_bytes, 4);
+        p = put_be(p, (uint32_t)entry->data_size, 4);
+        memcpy(p, entry->data, entry->data_size);
+        p += entry->data_size;
+    }
+    pthread_mutex_unlock(&cache->mutex);
+    return needed;
+}
+
+size_t linx_tts_cache_import(linx_tts_cache_t* cache, const uint8_t* data, size_t size) {
+    if (!cache || !data || size < TTS_CACHE_MAGIC_SIZE + 4 ||
+        memcmp(data, TTS_CACHE_MAGIC, TTS_CACHE_MAGIC_SIZE) != 0) {
+        return 0;
+    }
+
+    uint32_t count = get_be(data + TTS_CACHE_MAGIC_SIZE, 4);
+    size_t offset = TTS_CACHE_MAGIC_SIZE + 4;
+    size_t imported = 0;
+    pthread_mutex_lock(&cache->mutex);
+    for (uint32_t i = 0; i < count; i++) {
+        if (offset + 2 > size) {
+            break;
+        }
+        size_t key_length = get_be(data + offset, 2);
+        if (key_length == 0 || key_length >= cache->key_capacity || offset + 2 + key_length + 12 > size) {
+            break;
+        }
+        const char* key = (const char*)data + offset + 2;
+        const uint8_t* p = data + offset + 2 + key_length;
+        uint32_t duration_ms = get_be(p, 4);
+        size_t audio_bytes = get_be(p + 4, 4);
+        size_t data_size = get_be(p + 8, 4);
+        if (data_size == 0 || offset + 2 + key_length + 12 + data_size > size) {
+            break;
+        }
+        offset += 2 + key_length + 12 + data_size;
+        if (data_size > cache->config.max_entry_bytes) {
+            continue;
+        }
+
+        uint8_t* copy = (uint8_t*)LINX_MALLOC_BULK(data_size);
+        if (!copy) {
+            break;
+        }
+        memcpy(copy, p + 12, data_size);
+        if (insert_entry(cache, key, key_length, copy, data_size, audio_bytes, duration_ms)) {
+            imported++;
+        } else {
+            LINX_FREE(copy);
+        }
+    }
+    pthread_mutex_unlock(&cache->mutex);
+
+    LOG_INFO("TTS缓存导入 %zu 条", imported);
+    return imported;
+}
+
+bool linx_tts_cache_get_stats(linx_tts_cache_t* cache, linx_tts_cache_stats_t* stats) {
+    if (!cache || !stats) {
+        return false;
+    }
+
+    pthread_mutex_lock(&cache->mutex);
+    *stats = cache->stats;
+    pthread_mutex_unlock(&cache->mutex);
+    return true;
+}
@@ -0,0 +1,159 @@
+/**
+ * @file linx_tts_cache.h
+ * @brief 句子级 TTS 音频缓存
+ *
+ * 服务端的回复中有大量重复的句子（问候、确认、报时的固定部分），每次都重新合成、
+ * 下发同样的 Opus 包。本缓存按 "音色 + sentence_start 文本" 保存一句话的全部下行包，
+ * 同一句再次出现时由设备直接回放，并通知服务端跳过这一句的音频
+ * (见 linx_protocol_send_tts_skip())，既省下行流量，常用语句也能立即开始播放。
+ *
+ * 条目放在 RAM 中，总字节数受 max_bytes 限制，超出时按最久未使用淘汰（正在回放的条目除外）。
+ * 需要掉电保留时用 linx_tts_cache_export() 序列化后写入 flash，开机后用
+ * linx_tts_cache_import() 装回；序列化格式按 LRU 顺序排列，导入时保持原有的新旧关系。
+ *
+ * 录制：sentence_start 未命中时 linx_tts_cache_record_begin()，之后这一句的每个下行包
+ * linx_tts_cache_record_append()，下一句开始或 TTS 结束时 linx_tts_cache_record_commit()；
+ * 被打断或超长的句子 linx_tts_cache_record_abort() 丢弃。同一时刻只录制一句。
+ *
+ * 线程安全。
+ */
+
+#ifndef LINX_TTS_CACHE_H
+#define LINX_TTS_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 缓存 - 前向声明（隐藏实现细节） */
+typedef struct linx_tts_cache linx_tts_cache_t;
+
+/* 一句话的缓存条目 */
+typedef struct linx_tts_cache_entry linx_tts_cache_entry_t;
+
+/* 配置（字段为 0 时使用默认值） */
+typedef struct {
+    size_t max_bytes;               // 所有条目的总字节数上限（必填）
+    size_t max_entry_bytes;         // 单句上限，超过的句子不缓存（默认 max_bytes / 4）
+    size_t max_text_bytes;          // 文本上限，更长的句子不缓存（默认 256）
+} linx_tts_cache_config_t;
+
+/* 统计信息 */
+typedef struct {
+    size_t entries;                 // 当前条目数
+    size_t bytes;                   // 当前占用的字节数（含文本和包头）
+    uint64_t hits;                  // 命中次数
+    uint64_t misses;                // 未命中次数
+    uint64_t inserts;               // 录制完成存入的条目数
+    uint64_t rejected;              // 超长、被打断等未存入的句子数
+    uint64_t evictions;             // 淘汰次数
+    uint64_t bytes_saved;           // 命中省下的下行音频字节数
+} linx_tts_cache_stats_t;
+
+/**
+ * 创建缓存
+ * @return 缓存实例，失败返回 NULL
+ */
+linx_tts_cache_t* linx_tts_cache_create(const linx_tts_cache_config_t* config);
+
+/**
+ * 销毁缓存
+ * @note 调用前释放所有 linx_tts_cache_acquire() 得到的条目
+ */
+void linx_tts_cache_destroy(linx_tts_cache_t* cache);
+
+/**
+ * 查找一句话并固定条目（命中计入 hits，否则计入 misses）
+ * @param voice 音色，可以为 NULL（等同于空串）
+ * @return 条目，未命中返回 NULL；用完后调用 linx_tts_cache_release()
+ */
+linx_tts_cache_entry_t* linx_tts_cache_acquire(linx_tts_cache_t* cache, const char* voice, const char* text);
+
+/**
+ * 释放 linx_tts_cache_acquire() 固定的条目
+ */
+void linx_tts_cache_release(linx_tts_cache_t* cache, linx_tts_cache_entry_t* entry);
+
+/**
+ * 条目的总时长（毫秒）
+ */
+uint32_t linx_tts_cache_entry_duration_ms(const linx_tts_cache_entry_t* entry);
+
+/**
+ * 条目的音频字节数（不含包头）
+ */
+size_t linx_tts_cache_entry_audio_bytes(const linx_tts_cache_entry_t* entry);
+
+/**
+ * 依次读取条目中的包
+ * @param offset 读取位置，从 0 开始，每次调用后前进到下一个包
+ * @param payload 输出包数据，条目被固定期间有效
+ * @param size 输出包字节数
+ * @param duration_ms 输出包时长（毫秒）
+ * @return 还有包返回 true，读完返回 false
+ */
+bool linx_tts_cache_entry_next(const linx_tts_cache_entry_t* entry, size_t* offset,
+                               const uint8_t** payload, size_t* size, int* duration_ms);
+
+/**
+ * 开始录制一句话；上一句尚未提交的录制被丢弃
+ * @return 开始录制返回 true；文本过长或已经缓存时返回 false
+ */
+bool linx_tts_cache_record_begin(linx_tts_cache_t* cache, const char* voice, const char* text);
+
+/**
+ * 追加一个包到正在录制的句子（不分配内存，可在下行零分配区内调用）
+ * @param duration_ms 包时长（毫秒，1-255）
+ * @return 成功返回 true；没有在录制或句子超过 max_entry_bytes 返回 false（录制被丢弃）
+ */
+bool linx_tts_cache_record_append(linx_tts_cache_t* cache, const uint8_t* payload, size_t size, int duration_ms);
+
+/**
+ * 提交正在录制的句子，必要时淘汰旧条目
+ * @return 存入返回 true
+ */
+bool linx_tts_cache_record_commit(linx_tts_cache_t* cache);
+
+/**
+ * 丢弃正在录制的句子
+ */
+void linx_tts_cache_record_abort(linx_tts_cache_t* cache);
+
+/**
+ * 是否正在录制
+ */
+bool linx_tts_cache_is_recording(linx_tts_cache_t* cache);
+
+/**
+ * 清空所有未固定的条目（例如服务端改了音色或音频格式）
+ */
+void linx_tts_cache_clear(linx_tts_cache_t* cache);
+
+/**
+ * 序列化所有条目，供写入 flash
+ * @param buffer 输出缓冲区，为 NULL 时只计算所需大小
+ * @param size 缓冲区大小
+ * @return 序列化的字节数（buffer 为 NULL 时为所需大小），缓冲区不足返回 0
+ */
+size_t linx_tts_cache_export(linx_tts_cache_t* cache, uint8_t* buffer, size_t size);
+
+/**
+ * 从 linx_tts_cache_export() 的输出装入条目，已有的同一句保留
+ * @return 装入的条目数；格式错误时返回已装入的部分
+ */
+size_t linx_tts_cache_import(linx_tts_cache_t* cache, const uint8_t* data, size_t size);
+
+/**
+ * 获取统计信息
+ */
+bool linx_tts_cache_get_stats(linx_tts_cache_t* cache, linx_tts_cache_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LINX_TTS_CACHE_H
@@ -0,0 +1,1024 @@
+#include "linx_alloc.h"
+#include "linx_log.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+LINX_LOG_TAG_DEFINE(s_alloc_log, "LINX_ALLOC");
+
+/* 提供 mongoose 的 mg_calloc / mg_free（LINX_STATIC_MEMORY 构建时由 CMake 打开） */
+#ifndef LINX_ALLOC_MONGOOSE_HOOKS
+#define LINX_ALLOC_MONGOOSE_HOOKS 0
+#endif
+
+/* 跟踪头部标记，用于识别非跟踪分配器分配的内存 */
+#define LINX_ALLOC_TRACK_MAGIC 0x4C4E5841u
+
+/* 跟踪头部：固定 16 字节，保持 malloc 返回地址的对齐 */
+typedef union {
+    struct {
+        size_t size;                // 用户请求的字节数
+        uint16_t module;            // 分配时的模块
+        uint16_t site;              // 调用位置槽位
+        uint32_t magic;             // LINX_ALLOC_TRACK_MAGIC，释放后清零
+    } info;
+    double align[2];
+} linx_alloc_track_header_t;
+
+static const char* s_module_names[LINX_ALLOC_MODULE_COUNT] = {
+    "core", "log", "json", "mcp", "protocol", "codec",
+    "audio", "play", "ota", "camera", "ui", "board", "app"
+};
+
+/* 已安装的分配器；NULL 表示直接使用 libc */
+static linx_alloc_hooks_t g_hooks;
+static const linx_alloc_hooks_t* g_active_hooks = NULL;
+
+/* 跟踪分配器状态，由 g_track_mutex 保护 */
+static pthread_mutex_t g_track_mutex = PTHREAD_MUTEX_INITIALIZER;
+static bool g_track_has_backing = false;
+static linx_alloc_hooks_t g_track_backing;
+static linx_alloc_module_stats_t g_track_modules[LINX_ALLOC_MODULE_COUNT];
+static linx_alloc_site_stats_t g_track_sites[LINX_ALLOC_TRACK_MAX_SITES];   // 槽位 0 为 "<other>"
+static size_t g_track_current = 0;
+static size_t g_track_peak = 0;
+static bool g_tracking = false;
+
+/* 分配失败次数（含 libc 直通），供内存压力检查发现"已经开始失败" */
+static uint64_t g_alloc_failures = 0;
+
+/* 区域放置：策略在生成分配器时复制，之后只读；统计用原子操作更新 */
+static linx_alloc_placement_t g_place;
+static linx_alloc_region_stats_t g_place_stats[LINX_ALLOC_REGION_COUNT];
+static bool g_place_ready = false;
+
+/* 零分配区检查 */
+static __thread int t_no_alloc_depth = 0;
+static int g_no_alloc_armed = 0;
+static uint64_t g_no_alloc_violations = 0;
+static linx_alloc_trap_fn g_trap_fn = NULL;
+static void* g_trap_user_data = NULL;
+
+static void no_alloc_check(size_t size, linx_alloc_module_t module, const char* file, int line);
+
+/* ==================== 分配入口 ==================== */
+
+bool linx_alloc_set_hooks(const linx_alloc_hooks_t* hooks) {
+    if (!hooks) {
+        __atomic_store_n(&g_active_hooks, NULL, __ATOMIC_RELEASE);
+        __atomic_store_n(&g_tracking, false, __ATOMIC_RELEASE);
+        return true;
+    }
+    if (!hooks->malloc_fn || !hooks->realloc_fn || !hooks->free_fn) {
+        return false;
+    }
+
+    g_hooks = *hooks;
+    __atomic_store_n(&g_active_hooks, &g_hooks, __ATOMIC_RELEASE);
+    __atomic_store_n(&g_tracking, false, __ATOMIC_RELEASE);
+    return true;
+}
+
+const linx_alloc_hooks_t* linx_alloc_get_hooks(void) {
+    return __atomic_load_n(&g_active_hooks, __ATOMIC_ACQUIRE);
+}
+
+static inline void* alloc_counted(void* ptr, size_t size) {
+    if (!ptr && size != 0) {
+        __atomic_add_fetch(&g_alloc_failures, 1, __ATOMIC_RELAXED);
+    }
+    return ptr;
+}
+
+static void* alloc_malloc(size_t size, linx_alloc_class_t placement,
+                          linx_alloc_module_t module, const char* file, int line) {
+    if (t_no_alloc_depth > 0) {
+        no_alloc_check(size, module, file, line);
+    }
+    const linx_alloc_hooks_t* hooks = __atomic_load_n(&g_active_hooks, __ATOMIC_ACQUIRE);
+    if (!hooks) {
+        return alloc_counted(malloc(size), size);
+    }
+    linx_alloc_site_t site = { module, file, line, placement };
+    return alloc_counted(hooks->malloc_fn(size, &site, hooks->user_data), size);
+}
+
+static void* alloc_calloc(size_t count, size_t size, linx_alloc_class_t placement,
+                          linx_alloc_module_t module, const char* file, int line) {
+    if (t_no_alloc_depth > 0) {
+        no_alloc_check(count * size, module, file, line);
+    }
+    const linx_alloc_hooks_t* hooks = __atomic_load_n(&g_active_hooks, __ATOMIC_ACQUIRE);
+    if (!hooks) {
+        return alloc_counted(calloc(count, size), count * size);
+    }
+    if (size != 0 && count > SIZE_MAX / size) {
+        return alloc_counted(NULL, 1);
+    }
+    linx_alloc_site_t site = { module, file, line, placement };
+    void* ptr = alloc_counted(hooks->malloc_fn(count * size, &site, hooks->user_data), count * size);
+    if (ptr) {
+        memset(ptr, 0, count * size);
+    }
+    return ptr;
+}
+
+static void* alloc_realloc(void* ptr, size_t size, linx_alloc_class_t placement,
+                           linx_alloc_module_t module, const char* file, int line) {
+    if (t_no_alloc_depth > 0) {
+        no_alloc_check(size, module, file, line);
+    }
+    const linx_alloc_hooks_t* hooks = __atomic_load_n(&g_active_hooks, __ATOMIC_ACQUIRE);
+    if (!hooks) {
+        return alloc_counted(realloc(ptr, size), size);
+    }
+    linx_alloc_site_t site = { module, file, line, placement };
+    if (!ptr) {
+        return alloc_counted(hooks->malloc_fn(size, &site, hooks->user_data), size);
+    }
+    return alloc_counted(hooks->realloc_fn(ptr, size, &site, hooks->user_data), size);
+}
+
+void* linx_alloc_malloc(size_t size, linx_alloc_module_t module, const char* file, int line) {
+    return alloc_malloc(size, LINX_ALLOC_HOT, module, file, line);
+}
+
+void* linx_alloc_calloc(size_t count, size_t size, linx_alloc_module_t module, const char* file, int line) {
+    return alloc_calloc(count, size, LINX_ALLOC_HOT, module, file, line);
+}
+
+void* linx_alloc_realloc(void* ptr, size_t size, linx_alloc_module_t module, const char* file, int line) {
+    return alloc_realloc(ptr, size, LINX_ALLOC_HOT, module, file, line);
+}
+
+void* linx_alloc_malloc_bulk(size_t size, linx_alloc_module_t module, const char* file, int line) {
+    return alloc_malloc(size, LINX_ALLOC_BULK, module, file, line);
+}
+
+void* linx_alloc_calloc_bulk(size_t count, size_t size, linx_alloc_module_t module, const char* file, int line) {
+    return alloc_calloc(count, size, LINX_ALLOC_BULK, module, file, line);
+}
+
+void* linx_alloc_realloc_bulk(void* ptr, size_t size, linx_alloc_module_t module, const char* file, int line) {
+    return alloc_realloc(ptr, size, LINX_ALLOC_BULK, module, file, line);
+}
+
+void linx_alloc_free(void* ptr, linx_alloc_module_t module, const char* file, int line) {
+    if (!ptr) {
+        return;
+    }
+    const linx_alloc_hooks_t* hooks = __atomic_load_n(&g_active_hooks, __ATOMIC_ACQUIRE);
+    if (!hooks) {
+        free(ptr);
+        return;
+    }
+    linx_alloc_site_t site = { module, file, line, LINX_ALLOC_HOT };
+    hooks->free_fn(ptr, &site, hooks->user_data);
+}
+
+char* linx_alloc_strdup(const char* str, linx_alloc_module_t module, const char* file, int line) {
+    if (!str) {
+        return NULL;
+    }
+    size_t size = strlen(str) + 1;
+    char* copy = (char*)linx_alloc_malloc(size, module, file, line);
+    if (copy) {
+        memcpy(copy, str, size);
+    }
+    return copy;
+}
+
+void* linx_malloc(size_t size) {
+    return linx_alloc_malloc(size, LINX_ALLOC_MODULE_APP, "app", 0);
+}
+
+void linx_free(void* ptr) {
+    linx_alloc_free(ptr, LINX_ALLOC_MODULE_APP, "app", 0);
+}
+
+const char* linx_alloc_module_name(linx_alloc_module_t module) {
+    if ((int)module < 0 || module >= LINX_ALLOC_MODULE_COUNT) {
+        return "unknown";
+    }
+    return s_module_names[module];
+}
+
+/* ==================== 跟踪分配器 ==================== */
+
+/* 调用方持有 g_track_mutex；同一文件的 __FILE__ 通常是同一个指针，不同时再比较内容 */
+static uint16_t track_site_slot(const linx_alloc_site_t* site) {
+    const size_t slots = LINX_ALLOC_TRACK_MAX_SITES - 1;
+    size_t hash = ((size_t)site->line * 2654435761u) ^ (size_t)(uintptr_t)site->file;
+    for (size_t probe = 0; probe < slots; probe++) {
+        size_t index = 1 + (hash + probe) % slots;
+        linx_alloc_site_stats_t* slot = &g_track_sites[index];
+        if (!slot->site.file) {
+            slot->site = *site;
+            return (uint16_t)index;
+        }
+        if (slot->site.line == site->line &&
+            (slot->site.file == site->file || strcmp(slot->site.file, site->file) == 0)) {
+            return (uint16_t)index;
+        }
+    }
+    return 0;
+}
+
+/* 调用方持有 g_track_mutex */
+static void track_account_alloc(linx_alloc_track_header_t* header, size_t size,
+                                const linx_alloc_site_t* site) {
+    linx_alloc_module_t module = site->module < LINX_ALLOC_MODULE_COUNT ? site->module : LINX_ALLOC_MODULE_APP;
+    uint16_t index = track_site_slot(site);
+
+    header->info.size = size;
+    header->info.module = (uint16_t)module;
+    header->info.site = index;
+    header->info.magic = LINX_ALLOC_TRACK_MAGIC;
+
+    linx_alloc_module_stats_t* stats = &g_track_modules[module];
+    stats->current_bytes += size;
+    stats->current_blocks++;
+    stats->allocations++;
+    stats->total_bytes += size;
+    if (stats->current_bytes > stats->peak_bytes) {
+        stats->peak_bytes = stats->current_bytes;
+    }
+
+    linx_alloc_site_stats_t* slot = &g_track_sites[index];
+    slot->current_bytes += size;
+    slot->current_blocks++;
+    slot->allocations++;
+    if (slot->current_bytes > slot->peak_bytes) {
+        slot->peak_bytes = slot->current_bytes;
+    }
+
+    g_track_current += size;
+    if (g_track_current > g_track_peak) {
+        g_track_peak = g_track_current;
+        for (int m = 0; m < LINX_ALLOC_MODULE_COUNT; m++) {
+            g_track_modules[m].bytes_at_peak = g_track_modules[m].current_bytes;
+        }
+    }
+}
+
+/* 调用方持有 g_track_mutex */
+static void track_account_free(const linx_alloc_track_header_t* header) {
+    size_t size = header->info.size;
+    linx_alloc_module_stats_t* stats = &g_track_modules[header->info.module];
+    stats->current_bytes -= size;
+    stats->current_blocks--;
+    stats->frees++;
+
+    linx_alloc_site_stats_t* slot = &g_track_sites[header->info.site];
+    slot->current_bytes -= size;
+    slot->current_blocks--;
+
+    g_track_current -= size;
+}
+
+static void* track_backing_malloc(size_t size, const linx_alloc_site_t* site) {
+    return g_track_has_backing ? g_track_backing.malloc_fn(size, site, g_track_backing.user_data) : malloc(size);
+}
+
+static void* track_backing_realloc(void* ptr, size_t size, const linx_alloc_site_t* site) {
+    return g_track_has_backing ? g_track_backing.realloc_fn(ptr, size, site, g_track_backing.user_data)
+                               : realloc(ptr, size);
+}
+
+static void track_backing_free(void* ptr, const linx_alloc_site_t* site) {
+    if (g_track_has_backing) {
+        g_track_backing.free_fn(ptr, site, g_track_backing.user_data);
+    } else {
+        free(ptr);
+    }
+}
+
+static void* track_malloc(size_t size, const linx_alloc_site_t* site, void* user_data) {
+    (void)user_data;
+    if (size > SIZE_MAX - sizeof(linx_alloc_track_header_t)) {
+        return NULL;
+    }
+    linx_alloc_track_header_t* header =
+        (linx_alloc_track_header_t*)track_backing_malloc(sizeof(*header) + size, site);
+    if (!header) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&g_track_mutex);
+    track_account_alloc(header, size, site);
+    pthread_mutex_unlock(&g_track_mutex);
+    return header + 1;
+}
+
+static void track_free(void* ptr, const linx_alloc_site_t* site, void* user_data) {
+    (void)user_data;
+    linx_alloc_track_header_t* header = (linx_alloc_track_header_t*)ptr - 1;
+    if (header->info.magic != LINX_ALLOC_TRACK_MAGIC) {
+        // 重复释放，或内存不是经跟踪分配器分配的（钩子安装前的分配、libc 分配交给了 LINX_FREE）
+        LINX_LOGE(s_alloc_log, "free of untracked block %p at %s:%d", ptr,
+                  site->file ? site->file : "?", site->line);
+        return;
+    }
+
+    pthread_mutex_lock(&g_track_mutex);
+    track_account_free(header);
+    pthread_mutex_unlock(&g_track_mutex);
+    header->info.magic = 0;
+    track_backing_free(header, site);
+}
+
+static void* track_realloc(void* ptr, size_t size, const linx_alloc_site_t* site, void* user_data) {
+    (void)user_data;
+    linx_alloc_track_header_t* header = (linx_alloc_track_header_t*)ptr - 1;
+    if (header->info.magic != LINX_ALLOC_TRACK_MAGIC) {
+        LINX_LOGE(s_alloc_log, "realloc of untracked block %p at %s:%d", ptr,
+                  site->file ? site->file : "?", site->line);
+        return NULL;
+    }
+    if (size > SIZE_MAX - sizeof(linx_alloc_track_header_t)) {
+        return NULL;
+    }
+
+    // 先按新位置重新记账：失败时原块保持不变，成功后归属转到本次调用位置
+    linx_alloc_track_header_t old = *header;
+    linx_alloc_track_header_t* grown =
+        (linx_alloc_track_header_t*)track_backing_realloc(header, sizeof(*header) + size, site);
+    if (!grown) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&g_track_mutex);
+    track_account_free(&old);
+    track_account_alloc(grown, size, site);
+    pthread_mutex_unlock(&g_track_mutex);
+    return grown + 1;
+}
+
+bool linx_alloc_tracking_enable(const linx_alloc_hooks_t* backing) {
+    if (backing && (!backing->malloc_fn || !backing->realloc_fn || !backing->free_fn)) {
+        return false;
+    }
+
+    pthread_mutex_lock(&g_track_mutex);
+    g_track_has_backing = backing != NULL;
+    if (backing) {
+        g_track_backing = *backing;
+    }
+    pthread_mutex_unlock(&g_track_mutex);
+
+    linx_alloc_hooks_t hooks = { track_malloc, track_realloc, track_free, NULL };
+    if (!linx_alloc_set_hooks(&hooks)) {
+        return false;
+    }
+    __atomic_store_n(&g_tracking, true, __ATOMIC_RELEASE);
+    return true;
+}
+
+bool linx_alloc_tracking_enabled(void) {
+    return __atomic_load_n(&g_tracking, __ATOMIC_ACQUIRE);
+}
+
+size_t linx_alloc_get_total(size_t* peak_bytes) {
+    pthread_mutex_lock(&g_track_mutex);
+    size_t current = g_track_current;
+    if (peak_bytes) {
+        *peak_bytes = g_track_peak;
+    }
+    pthread_mutex_unlock(&g_track_mutex);
+    return current;
+}
+
+bool linx_alloc_get_module_stats(linx_alloc_module_t module, linx_alloc_module_stats_t* stats) {
+    if (!stats || (int)module < 0 || module >= LINX_ALLOC_MODULE_COUNT || !linx_alloc_tracking_enabled()) {
+        return false;
+    }
+    pthread_mutex_lock(&g_track_mutex);
+    *stats = g_track_modules[module];
+    pthread_mutex_unlock(&g_track_mutex);
+    return true;
+}
+
+size_t linx_alloc_get_sites(linx_alloc_site_stats_t* sites, size_t max_sites) {
+    if (!sites || max_sites == 0) {
+        return 0;
+    }
+
+    // 插入排序保留当前占用最多的 max_sites 个位置
+    size_t count = 0;
+    pthread_mutex_lock(&g_track_mutex);
+    for (size_t i = 0; i < LINX_ALLOC_TRACK_MAX_SITES; i++) {
+        const linx_alloc_site_stats_t* slot = &g_track_sites[i];
+        if (slot->allocations == 0) {
+            continue;
+        }
+        size_t pos = count < max_sites ? count : max_sites;
+        while (pos > 0 && sites[pos - 1].current_bytes < slot->current_bytes) {
+            if (pos < max_sites) {
+                sites[pos] = sites[pos - 1];
+            }
+            pos--;
+        }
+        if (pos < max_sites) {
+            sites[pos] = *slot;
+            if (i == 0) {
+                sites[pos].site.file = "<other>";
+            }
+            if (count < max_sites) {
+                count++;
+            }
+        }
+    }
+    pthread_mutex_unlock(&g_track_mutex);
+    return count;
+}
+
+void linx_alloc_reset_peak(void) {
+    pthread_mutex_lock(&g_track_mutex);
+    g_track_peak = g_track_current;
+    for (int m = 0; m < LINX_ALLOC_MODULE_COUNT; m++) {
+        g_track_modules[m].peak_bytes = g_track_modules[m].current_bytes;
+        g_track_modules[m].bytes_at_peak = g_track_modules[m].current_bytes;
+    }
+    for (size_t i = 0; i < LINX_ALLOC_TRACK_MAX_SITES; i++) {
+        g_track_sites[i].peak_bytes = g_track_sites[i].current_bytes;
+    }
+    pthread_mutex_unlock(&g_track_mutex);
+}
+
+static const char* site_basename(const char* file) {
+    const char* slash = file ? strrchr(file, '/') : NULL;
+    return slash ? slash + 1 : (file ? file : "?");
+}
+
+void linx_alloc_dump(size_t top_sites) {
+    if (!linx_alloc_tracking_enabled()) {
+        LINX_LOGI(s_alloc_log, "allocation tracking is not enabled");
+        return;
+    }
+
+    // 先复制再输出：日志本身会分配内存，不能在持锁时调用
+    linx_alloc_module_stats_t modules[LINX_ALLOC_MODULE_COUNT];
+    size_t peak = 0;
+    size_t current = linx_alloc_get_total(&peak);
+    pthread_mutex_lock(&g_track_mutex);
+    memcpy(modules, g_track_modules, sizeof(modules));
+    pthread_mutex_unlock(&g_track_mutex);
+
+    LINX_LOGI(s_alloc_log, "heap: current %zu bytes, peak %zu bytes", current, peak);
+    LINX_LOGI(s_alloc_log, "%-9s %10s %8s %10s %10s %10s %10s", "module", "current", "blocks",
+              "peak", "at_peak", "allocs", "frees");
+    for (int m = 0; m < LINX_ALLOC_MODULE_COUNT; m++) {
+        if (modules[m].allocations == 0) {
+            continue;
+        }
+        LINX_LOGI(s_alloc_log, "%-9s %10zu %8zu %10zu %10zu %10llu %10llu", s_module_names[m],
+                  modules[m].current_bytes, modules[m].current_blocks, modules[m].peak_bytes,
+                  modules[m].bytes_at_peak, (unsigned long long)modules[m].allocations,
+                  (unsigned long long)modules[m].frees);
+    }
+
+    if (top_sites == 0) {
+        return;
+    }
+    linx_alloc_site_stats_t* sites = (linx_alloc_site_stats_t*)malloc(top_sites * sizeof(*sites));
+    if (!sites) {
+        return;
+    }
+    size_t count = linx_alloc_get_sites(sites, top_sites);
+    for (size_t i = 0; i < count; i++) {
+        LINX_LOGI(s_alloc_log, "  %-9s %s:%d current %zu (%zu blocks) peak %zu allocs %llu",
+                  linx_alloc_module_name(sites[i].site.module), site_basename(sites[i].site.file),
+                  sites[i].site.line, sites[i].current_bytes, sites[i].current_blocks,
+                  sites[i].peak_bytes, (unsigned long long)sites[i].allocations);
+    }
+    free(sites);
+}
+
+/* ==================== 区域放置 ==================== */
+
+/* 放置头部标记 */
+#define LINX_ALLOC_PLACE_MAGIC 0x4C4E5850u
+#define LINX_ALLOC_DEFAULT_BULK_THRESHOLD 4096
+
+/* 放置头部：固定 16 字节，保持区域分配器返回地址的对齐 */
+typedef union {
+    struct {
+        size_t size;                // 用户请求的字节数
+        uint32_t region;            // 所在区域
+        uint32_t magic;             // LINX_ALLOC_PLACE_MAGIC，释放后清零
+    } info;
+    double align[2];
+} linx_alloc_place_header_t;
+
+static const char* s_region_names[LINX_ALLOC_REGION_COUNT] = { "internal", "external" };
+
+static bool place_has_region(int region) {
+    return g_place.regions[region].heap.malloc_fn != NULL;
+}
+
+/* 按预算预留字节数，超出预算返回 false */
+static bool place_reserve(int region, size_t bytes) {
+    linx_alloc_region_stats_t* stats = &g_place_stats[region];
+    size_t budget = g_place.regions[region].budget_bytes;
+    size_t current = __atomic_load_n(&stats->current_bytes, __ATOMIC_RELAXED);
+    do {
+        if (budget && (bytes > budget || current > budget - bytes)) {
+            __atomic_add_fetch(&stats->over_budget, 1, __ATOMIC_RELAXED);
+            return false;
+        }
+    } while (!__atomic_compare_exchange_n(&stats->current_bytes, &current, current + bytes, true,
+                                          __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+    size_t now = current + bytes;
+    size_t peak = __atomic_load_n(&stats->peak_bytes, __ATOMIC_RELAXED);
+    while (now > peak && !__atomic_compare_exchange_n(&stats->peak_bytes, &peak, now, true,
+                                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+    return true;
+}
+
+static void place_unreserve(int region, size_t bytes) {
+    __atomic_sub_fetch(&g_place_stats[region].current_bytes, bytes, __ATOMIC_RELAXED);
+}
+
+/* 在指定区域分配 total 字节（含头部），失败返回 NULL */
+static linx_alloc_place_header_t* place_alloc_in(int region, size_t total, const linx_alloc_site_t* site) {
+    if (!place_has_region(region) || !place_reserve(region, total)) {
+        return NULL;
+    }
+    const linx_alloc_hooks_t* heap = &g_place.regions[region].heap;
+    linx_alloc_place_header_t* header = (linx_alloc_place_header_t*)heap->malloc_fn(total, site, heap->user_data);
+    linx_alloc_region_stats_t* stats = &g_place_stats[region];
+    if (!header) {
+        place_unreserve(region, total);
+        __atomic_add_fetch(&stats->failures, 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+    __atomic_add_fetch(&stats->allocations, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&stats->current_blocks, 1, __ATOMIC_RELAXED);
+    header->info.region = (uint32_t)region;
+    header->info.magic = LINX_ALLOC_PLACE_MAGIC;
+    return header;
+}
+
+/* 首选区域失败时按策略回退到另一区域 */
+static linx_alloc_place_header_t* place_alloc_routed(int preferred, size_t total, const linx_alloc_site_t* site) {
+    int other = 1 - preferred;
+    if (!place_has_region(preferred)) {
+        // 没有该区域（如板子没有 PSRAM）不算回退
+        return place_alloc_in(other, total, site);
+    }
+    linx_alloc_place_header_t* header = place_alloc_in(preferred, total, site);
+    if (!header && g_place.allow_fallback && place_has_region(other)) {
+        header = place_alloc_in(other, total, site);
+        if (header) {
+            __atomic_add_fetch(&g_place_stats[other].fallbacks, 1, __ATOMIC_RELAXED);
+        }
+    }
+    return header;
+}
+
+static void* place_malloc(size_t size, const linx_alloc_site_t* site, void* user_data) {
+    (void)user_data;
+    if (size > SIZE_MAX - sizeof(linx_alloc_place_header_t)) {
+        return NULL;
+    }
+    bool bulk = site->placement == LINX_ALLOC_BULK ||
+                (g_place.bulk_threshold && size >= g_place.bulk_threshold);
+    linx_alloc_place_header_t* header = place_alloc_routed(
+        bulk ? LINX_ALLOC_REGION_EXTERNAL : LINX_ALLOC_REGION_INTERNAL, sizeof(*header) + size, site);
+    if (!header) {
+        return NULL;
+    }
+    header->info.size = size;
+    return header + 1;
+}
+
+static void place_release(linx_alloc_place_header_t* header, const linx_alloc_site_t* site) {
+    int region = (int)header->info.region;
+    size_t total = sizeof(*header) + header->info.size;
+    header->info.magic = 0;
+    const linx_alloc_hooks_t* heap = &g_place.regions[region].heap;
+    heap->free_fn(header, site, heap->user_data);
+    place_unreserve(region, total);
+    __atomic_sub_fetch(&g_place_stats[region].current_blocks, 1, __ATOMIC_RELAXED);
+}
+
+static void place_free(void* ptr, const linx_alloc_site_t* site, void* user_data) {
+    (void)user_data;
+    linx_alloc_place_header_t* header = (linx_alloc_place_header_t*)ptr - 1;
+    if (header->info.magic != LINX_ALLOC_PLACE_MAGIC || header->info.region >= LINX_ALLOC_REGION_COUNT) {
+        LINX_LOGE(s_alloc_log, "free of unplaced block %p at %s:%d", ptr,
+                  site->file ? site->file : "?", site->line);
+        return;
+    }
+    place_release(header, site);
+}
+
+static void* place_realloc(void* ptr, size_t size, const linx_alloc_site_t* site, void* user_data) {
+    (void)user_data;
+    linx_alloc_place_header_t* header = (linx_alloc_place_header_t*)ptr - 1;
+    if (header->info.magic != LINX_ALLOC_PLACE_MAGIC || header->info.region >= LINX_ALLOC_REGION_COUNT) {
+        LINX_LOGE(s_alloc_log, "realloc of unplaced block %p at %s:%d", ptr,
+                  site->file ? site->file : "?", site->line);
+        return NULL;
+    }
+    if (size > SIZE_MAX - sizeof(linx_alloc_place_header_t)) {
+        return NULL;
+    }
+
+    int region = (int)header->info.region;
+    size_t old_size = header->info.size;
+    size_t old_total = sizeof(*header) + old_size;
+    size_t new_total = sizeof(*header) + size;
+    const linx_alloc_hooks_t* heap = &g_place.regions[region].heap;
+
+    // 先尝试留在原区域：增长部分先占预算，失败时原块保持不变
+    if (new_total <= old_total || place_reserve(region, new_total - old_total)) {
+        linx_alloc_place_header_t* grown =
+            (linx_alloc_place_header_t*)heap->realloc_fn(header, new_total, site, heap->user_data);
+        if (grown) {
+            if (new_total < old_total) {
+                place_unreserve(region, old_total - new_total);
+            }
+            grown->info.size = size;
+            return grown + 1;
+        }
+        if (new_total > old_total) {
+            place_unreserve(region, new_total - old_total);
+        }
+        __atomic_add_fetch(&g_place_stats[region].failures, 1, __ATOMIC_RELAXED);
+    }
+
+    // 原区域放不下：搬到另一区域
+    int other = 1 - region;
+    if (!g_place.allow_fallback || !place_has_region(other)) {
+        return NULL;
+    }
+    linx_alloc_place_header_t* moved = place_alloc_in(other, new_total, site);
+    if (!moved) {
+        return NULL;
+    }
+    __atomic_add_fetch(&g_place_stats[other].fallbacks, 1, __ATOMIC_RELAXED);
+    moved->info.size = size;
+    memcpy(moved + 1, ptr, old_size < size ? old_size : size);
+    place_release(header, site);
+    return moved + 1;
+}
+
+static bool place_heap_valid(const linx_alloc_hooks_t* heap, bool required) {
+    if (!heap->malloc_fn && !heap->realloc_fn && !heap->free_fn) {
+        return !required;
+    }
+    return heap->malloc_fn && heap->realloc_fn && heap->free_fn;
+}
+
+static void* place_libc_malloc(size_t size, const linx_alloc_site_t* site, void* user_data) {
+    (void)site;
+    (void)user_data;
+    return malloc(size);
+}
+
+static void* place_libc_realloc(void* ptr, size_t size, const linx_alloc_site_t* site, void* user_data) {
+    (void)site;
+    (void)user_data;
+    return realloc(ptr, size);
+}
+
+static void place_libc_free(void* ptr, const linx_alloc_site_t* site, void* user_data) {
+    (void)site;
+    (void)user_data;
+    free(ptr);
+}
+
+void linx_alloc_placement_default(linx_alloc_placement_t* placement) {
+    if (!placement) {
+        return;
+    }
+    memset(placement, 0, sizeof(*placement));
+    linx_alloc_hooks_t libc = { place_libc_malloc, place_libc_realloc, place_libc_free, NULL };
+    placement->regions[LINX_ALLOC_REGION_INTERNAL].heap = libc;
+    placement->bulk_threshold = LINX_ALLOC_DEFAULT_BULK_THRESHOLD;
+    placement->allow_fallback = true;
+}
+
+bool linx_alloc_placement_hooks(const linx_alloc_placement_t* placement, linx_alloc_hooks_t* hooks) {
+    if (!placement || !hooks ||
+        !place_heap_valid(&placement->regions[LINX_ALLOC_REGION_INTERNAL].heap, true) ||
+        !place_heap_valid(&placement->regions[LINX_ALLOC_REGION_EXTERNAL].heap, false)) {
+        return false;
+    }
+
+    g_place = *placement;
+    memset(g_place_stats, 0, sizeof(g_place_stats));
+    for (int r = 0; r < LINX_ALLOC_REGION_COUNT; r++) {
+        g_place_stats[r].budget_bytes = g_place.regions[r].budget_bytes;
+    }
+    __atomic_store_n(&g_place_ready, true, __ATOMIC_RELEASE);
+
+    hooks->malloc_fn = place_malloc;
+    hooks->realloc_fn = place_realloc;
+    hooks->free_fn = place_free;
+    hooks->user_data = NULL;
+    return true;
+}
+
+bool linx_alloc_get_region_stats(linx_alloc_region_t region, linx_alloc_region_stats_t* stats) {
+    if (!stats || (int)region < 0 || region >= LINX_ALLOC_REGION_COUNT ||
+        !__atomic_load_n(&g_place_ready, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+    const linx_alloc_region_stats_t* src = &g_place_stats[region];
+    stats->current_bytes = __atomic_load_n(&src->current_bytes, __ATOMIC_RELAXED);
+    stats->peak_bytes = __atomic_load_n(&src->peak_bytes, __ATOMIC_RELAXED);
+    stats->budget_bytes = src->budget_bytes;
+    stats->current_blocks = __atomic_load_n(&src->current_blocks, __ATOMIC_RELAXED);
+    stats->allocations = __atomic_load_n(&src->allocations, __ATOMIC_RELAXED);
+    stats->fallbacks = __atomic_load_n(&src->fallbacks, __ATOMIC_RELAXED);
+    stats->over_budget = __atomic_load_n(&src->over_budget, __ATOMIC_RELAXED);
+    stats->failures = __atomic_load_n(&src->failures, __ATOMIC_RELAXED);
+    return true;
+}
+
+const char* linx_alloc_region_name(linx_alloc_region_t region) {
+    if ((int)region < 0 || region >= LINX_ALLOC_REGION_COUNT) {
+        return "unknown";
+    }
+    return s_region_names[region];
+}
+
+/* ==================== 静态内存区 ==================== */
+
+/* 静态块头部标记 */
+#define LINX_ALLOC_STATIC_MAGIC 0x4C4E5853u
+/* 最小块（含头部）和内存区最小容量 */
+#define LINX_ALLOC_STATIC_MIN_BLOCK 64u
+#define LINX_ALLOC_STATIC_MIN_CAPACITY 1024u
+/* 档位数：64 字节一档，之后每个二的幂区间 4 档 */
+#define LINX_ALLOC_STATIC_CLASSES (4 * (sizeof(size_t) * 8 - 6) + 1)
+
+/* 静态块头部：固定 16 字节，块大小都是 16 的倍数，用户地址保持 16 字节对齐 */
+typedef union {
+    struct {
+        uint32_t size_class;        // 尺寸档位
+        uint32_t magic;             // LINX_ALLOC_STATIC_MAGIC，释放后清零
+        size_t size;                // 用户请求的字节数
+    } info;
+    double align[2];
+} linx_alloc_static_header_t;
+
+/* 静态内存区状态，由 g_static_mutex 保护；空闲块的用户区首个指针链接下一个空闲块 */
+static pthread_mutex_t g_static_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uint8_t* g_static_base = NULL;
+static linx_alloc_static_header_t* g_static_free[LINX_ALLOC_STATIC_CLASSES];
+static linx_alloc_static_stats_t g_static_stats;
+static bool g_static_ready = false;
+static bool g_static_warned = false;
+
+static unsigned static_class_of(size_t total) {
+    if (total <= LINX_ALLOC_STATIC_MIN_BLOCK) {
+        return 0;
+    }
+    unsigned long long m = (unsigned long long)(total - 1);
+    unsigned k = 63u - (unsigned)__builtin_clzll(m);
+    unsigned sub = (unsigned)(m >> (k - 2)) & 3u;
+    return (k - 6) * 4 + sub + 1;
+}
+
+static size_t static_class_size(unsigned size_class) {
+    if (size_class == 0) {
+        return LINX_ALLOC_STATIC_MIN_BLOCK;
+    }
+    unsigned k = 6 + (size_class - 1) / 4;
+    unsigned sub = (size_class - 1) % 4;
+    return (size_t)(5 + sub) << (k - 2);
+}
+
+static void* static_malloc(size_t size, const linx_alloc_site_t* site, void* user_data) {
+    (void)user_data;
+    if (size > SIZE_MAX / 4) {
+        return NULL;
+    }
+    unsigned size_class = static_class_of(sizeof(linx_alloc_static_header_t) + size);
+    size_t block = static_class_size(size_class);
+
+    pthread_mutex_lock(&g_static_mutex);
+    linx_alloc_static_stats_t* stats = &g_static_stats;
+    linx_alloc_static_header_t* header = g_static_free[size_class];
+    if (header) {
+        g_static_free[size_class] = *(linx_alloc_static_header_t**)(header + 1);
+        stats->reused++;
+    } else if (!stats->sealed && block <= stats->capacity - stats->carved_bytes) {
+        header = (linx_alloc_static_header_t*)(g_static_base + stats->carved_bytes);
+        stats->carved_bytes += block;
+    }
+    bool warn = false;
+    if (!header) {
+        stats->failures++;
+        warn = !g_static_warned;
+        g_static_warned = true;
+    } else {
+        stats->allocations++;
+        stats->current_blocks++;
+        stats->current_bytes += block;
+        if (stats->current_bytes > stats->peak_bytes) {
+            stats->peak_bytes = stats->current_bytes;
+        }
+    }
+    bool sealed = stats->sealed;
+    size_t carved = stats->carved_bytes;
+    pthread_mutex_unlock(&g_static_mutex);
+
+    if (!header) {
+        if (warn) {
+            LINX_LOGW(s_alloc_log, "static memory %s: %zu bytes at %s:%d (%zu of %zu bytes carved)",
+                      sealed ? "sealed, no free block" : "exhausted", size,
+                      site->file ? site->file : "?", site->line, carved, g_static_stats.capacity);
+        }
+        return NULL;
+    }
+    header->info.size_class = size_class;
+    header->info.magic = LINX_ALLOC_STATIC_MAGIC;
+    header->info.size = size;
+    return header + 1;
+}
+
+static linx_alloc_static_header_t* static_header(void* ptr, const linx_alloc_site_t* site, const char* op) {
+    linx_alloc_static_header_t* header = (linx_alloc_static_header_t*)ptr - 1;
+    if ((uint8_t*)header < g_static_base ||
+        (uint8_t*)header >= g_static_base + g_static_stats.capacity ||
+        header->info.magic != LINX_ALLOC_STATIC_MAGIC || header->info.size_class >= LINX_ALLOC_STATIC_CLASSES) {
+        LINX_LOGE(s_alloc_log, "%s of non-static block %p at %s:%d", op, ptr,
+                  site->file ? site->file : "?", site->line);
+        return NULL;
+    }
+    return header;
+}
+
+static void static_free(void* ptr, const linx_alloc_site_t* site, void* user_data) {
+    (void)user_data;
+    linx_alloc_static_header_t* header = static_header(ptr, site, "free");
+    if (!header) {
+        return;
+    }
+    unsigned size_class = header->info.size_class;
+    header->info.magic = 0;
+
+    pthread_mutex_lock(&g_static_mutex);
+    *(linx_alloc_static_header_t**)(header + 1) = g_static_free[size_class];
+    g_static_free[size_class] = header;
+    g_static_stats.current_blocks--;
+    g_static_stats.current_bytes -= static_class_size(size_class);
+    pthread_mutex_unlock(&g_static_mutex);
+}
+
+static void* static_realloc(void* ptr, size_t size, const linx_alloc_site_t* site, void* user_data) {
+    linx_alloc_static_header_t* header = static_header(ptr, site, "realloc");
+    if (!header || size > SIZE_MAX / 4) {
+        return NULL;
+    }
+    // 本档放得下就原地调整，缩小时不换档
+    if (sizeof(*header) + size <= static_class_size(header->info.size_class)) {
+        header->info.size = size;
+        return ptr;
+    }
+    void* moved = static_malloc(size, site, user_data);
+    if (!moved) {
+        return NULL;
+    }
+    memcpy(moved, ptr, header->info.size);
+    static_free(ptr, site, user_data);
+    return moved;
+}
+
+bool linx_alloc_static_hooks(void* memory, size_t size, linx_alloc_hooks_t* hooks) {
+    if (!memory || !hooks) {
+        return false;
+    }
+    uintptr_t start = ((uintptr_t)memory + 15u) & ~(uintptr_t)15u;
+    size_t skipped = (size_t)(start - (uintptr_t)memory);
+    if (size < skipped + LINX_ALLOC_STATIC_MIN_CAPACITY) {
+        return false;
+    }
+
+    pthread_mutex_lock(&g_static_mutex);
+    g_static_base = (uint8_t*)start;
+    memset(g_static_free, 0, sizeof(g_static_free));
+    memset(&g_static_stats, 0, sizeof(g_static_stats));
+    g_static_stats.capacity = (size - skipped) & ~(size_t)15u;
+    g_static_warned = false;
+    pthread_mutex_unlock(&g_static_mutex);
+    __atomic_store_n(&g_static_ready, true, __ATOMIC_RELEASE);
+
+    hooks->malloc_fn = static_malloc;
+    hooks->realloc_fn = static_realloc;
+    hooks->free_fn = static_free;
+    hooks->user_data = NULL;
+    return true;
+}
+
+void linx_alloc_static_seal(void) {
+    if (!__atomic_load_n(&g_static_ready, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+    pthread_mutex_lock(&g_static_mutex);
+    g_static_stats.sealed = true;
+    size_t carved = g_static_stats.carved_bytes;
+    size_t current = g_static_stats.current_bytes;
+    pthread_mutex_unlock(&g_static_mutex);
+    LINX_LOGI(s_alloc_log, "static memory sealed: %zu of %zu bytes carved, %zu in use",
+              carved, g_static_stats.capacity, current);
+}
+
+bool linx_alloc_static_get_stats(linx_alloc_static_stats_t* stats) {
+    if (!stats || !__atomic_load_n(&g_static_ready, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+    pthread_mutex_lock(&g_static_mutex);
+    *stats = g_static_stats;
+    pthread_mutex_unlock(&g_static_mutex);
+    return true;
+}
+
+#if LINX_ALLOC_MONGOOSE_HOOKS
+/* mongoose 以 MG_ENABLE_CUSTOM_CALLOC=1 编译时（LINX_STATIC_MEMORY 构建）的分配入口：
+ * 连接和收发缓冲经本接口分配，归入 protocol 模块 */
+void* mg_calloc(size_t count, size_t size);
+void mg_free(void* ptr);
+
+void* mg_calloc(size_t count, size_t size) {
+    return linx_alloc_calloc(count, size, LINX_ALLOC_MODULE_PROTOCOL, "mongoose", 0);
+}
+
+void mg_free(void* ptr) {
+    linx_alloc_free(ptr, LINX_ALLOC_MODULE_PROTOCOL, "mongoose", 0);
+}
+#endif
+
+/* ==================== 零分配区检查 ==================== */
+
+static void no_alloc_default_trap(const linx_alloc_site_t* site, size_t size, void* user_data) {
+    (void)user_data;
+    LINX_LOGF(s_alloc_log, "heap allocation in no-alloc zone: %zu bytes at %s:%d (%s)", size,
+              site_basename(site->file), site->line, linx_alloc_module_name(site->module));
+    abort();
+}
+
+static void no_alloc_check(size_t size, linx_alloc_module_t module, const char* file, int line) {
+    if (__atomic_load_n(&g_no_alloc_armed, __ATOMIC_ACQUIRE) <= 0) {
+        return;
+    }
+    __atomic_add_fetch(&g_no_alloc_violations, 1, __ATOMIC_RELAXED);
+
+    linx_alloc_trap_fn trap = __atomic_load_n(&g_trap_fn, __ATOMIC_ACQUIRE);
+    void* user_data = __atomic_load_n(&g_trap_user_data, __ATOMIC_ACQUIRE);
+    linx_alloc_site_t site = { module, file, line, LINX_ALLOC_HOT };
+
+    // 回调内可能打日志或分配，临时退出零分配区避免递归
+    int depth = t_no_alloc_depth;
+    t_no_alloc_depth = 0;
+    if (trap) {
+        trap(&site, size, user_data);
+    } else {
+        no_alloc_default_trap(&site, size, NULL);
+    }
+    t_no_alloc_depth = depth;
+}
+
+void linx_alloc_no_alloc_enter(void) {
+    t_no_alloc_depth++;
+}
+
+void linx_alloc_no_alloc_leave(void) {
+    if (t_no_alloc_depth > 0) {
+        t_no_alloc_depth--;
+    }
+}
+
+void linx_alloc_no_alloc_arm(void) {
+    __atomic_add_fetch(&g_no_alloc_armed, 1, __ATOMIC_ACQ_REL);
+}
+
+void linx_alloc_no_alloc_disarm(void) {
+    int armed = __atomic_load_n(&g_no_alloc_armed, __ATOMIC_ACQUIRE);
+    while (armed > 0 &&
+           !__atomic_compare_exchange_n(&g_no_alloc_armed, &armed, armed - 1, false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+    }
+}
+
+bool linx_alloc_no_alloc_active(void) {
+    return t_no_alloc_depth > 0 && __atomic_load_n(&g_no_alloc_armed, __ATOMIC_ACQUIRE) > 0;
+}
+
+void linx_alloc_set_trap(linx_alloc_trap_fn trap, void* user_data) {
+    __atomic_store_n(&g_trap_user_data, user_data, __ATOMIC_RELEASE);
+    __atomic_store_n(&g_trap_fn, trap, __ATOMIC_RELEASE);
+}
+
+uint64_t linx_alloc_get_violations(void) {
+    return __atomic_load_n(&g_no_alloc_violations, __ATOMIC_RELAXED);
+}
+
+uint64_t linx_alloc_get_failures(void) {
+    return __atomic_load_n(&g_alloc_failures, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,404 @@
+#ifndef LINX_ALLOC_H
+#define LINX_ALLOC_H
+
+/*
+ * SDK 统一内存分配接口
+ *
+ * SDK 内部所有堆分配都经过 LINX_MALLOC / LINX_CALLOC / LINX_REALLOC / LINX_FREE /
+ * LINX_STRDUP，并带上模块和调用位置（文件、行号）。默认直接转发给 libc；
+ * linx_alloc_set_hooks() 可换成外部 PSRAM、内存池等自定义分配器。
+ *
+ * cJSON 的分配经 linx_json_arena 的堆回退进入本接口（归入 LINX_ALLOC_MODULE_JSON），
+ * 但 cJSON 钩子要由 cJSON 模块安装：应用应使用 linx_sdk_set_alloc_hooks() /
+ * linx_sdk_enable_alloc_tracking()，它们会同时接入 cJSON；单独使用 MCP 等子模块时，
+ * 设置钩子后调用 linx_json_arena_set_heap_allocator(NULL, NULL)。
+ *
+ * 放置策略：每次分配带有类别，LINX_MALLOC 等为 HOT（小而频繁访问的对象，如 LVGL
+ * 对象、包池、cJSON 竞技场），LINX_MALLOC_BULK 等为 BULK（大块顺序访问的缓冲，如
+ * 绘制缓冲、抖动缓冲、摄像头帧、OTA 分块）。linx_alloc_placement_hooks() 生成按类别
+ * 把分配路由到片内 SRAM / 外部 PSRAM 两个区域的分配器，各区域有独立的预算和统计。
+ *
+ * linx_alloc_tracking_enable() 安装内置的跟踪分配器：按模块和调用位置统计当前
+ * 字节数、块数、分配次数和峰值，并在总用量创新高时记录各模块的占用快照，
+ * 用于回答"堆峰值时每个模块各占多少"。
+ *
+ * 使用约束：
+ * - 钩子必须在任何 SDK 调用（包括 cJSON）之前设置，运行期间不能更换，
+ *   否则旧分配器分配的内存会交给新分配器释放
+ * - SDK 返回给调用者的内存用 linx_free() 释放；交给 SDK 接管的内存
+ *   （如 mcp_buffer_adopt 的数据）用 linx_malloc() 分配。
+ *   未安装钩子时二者等同 malloc() / free()
+ *
+ * 源文件用法：
+ *   #include "../log/linx_alloc.h"
+ *   LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_PROTOCOL);
+ *   buf = LINX_MALLOC(size);
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 内存归属模块 */
+typedef enum {
+    LINX_ALLOC_MODULE_CORE = 0,     // linx_sdk、事件队列、metrics、trace
+    LINX_ALLOC_MODULE_LOG,          // 日志与日志上传
+    LINX_ALLOC_MODULE_JSON,         // cJSON 及 JSON 工具
+    LINX_ALLOC_MODULE_MCP,          // MCP 服务端
+    LINX_ALLOC_MODULE_PROTOCOL,     // 协议、WebSocket、reactor
+    LINX_ALLOC_MODULE_CODEC,        // 编解码器
+    LINX_ALLOC_MODULE_AUDIO,        // 音频接口、VAD、AEC、重采样
+    LINX_ALLOC_MODULE_PLAY,         // 播放器与抖动缓冲
+    LINX_ALLOC_MODULE_OTA,          // OTA
+    LINX_ALLOC_MODULE_CAMERA,       // 摄像头
+    LINX_ALLOC_MODULE_UI,           // LVGL 界面
+    LINX_ALLOC_MODULE_BOARD,        // 板级适配
+    LINX_ALLOC_MODULE_APP,          // 应用通过 linx_malloc() 的分配
+    LINX_ALLOC_MODULE_COUNT
+} linx_alloc_module_t;
+
+/* 放置类别 */
+typedef enum {
+    LINX_ALLOC_HOT = 0,             // 小而频繁访问，放片内 SRAM（默认）
+    LINX_ALLOC_BULK                 // 大块顺序访问，放外部 PSRAM
+} linx_alloc_class_t;
+
+/* 分配调用位置 */
+typedef struct {
+    linx_alloc_module_t module;     // 归属模块
+    const char* file;               // 源文件（__FILE__）
+    int line;                       // 行号
+    linx_alloc_class_t placement;   // 放置类别（释放时无意义）
+} linx_alloc_site_t;
+
+/*
+ * 自定义分配器
+ * 三个函数都必填，语义与 malloc / realloc / free 相同（free_fn 不会收到 NULL）。
+ * 释放时的 site 是调用 LINX_FREE 的位置，不是分配位置。
+ */
+typedef struct {
+    void* (*malloc_fn)(size_t size, const linx_alloc_site_t* site, void* user_data);
+    void* (*realloc_fn)(void* ptr, size_t size, const linx_alloc_site_t* site, void* user_data);
+    void (*free_fn)(void* ptr, const linx_alloc_site_t* site, void* user_data);
+    void* user_data;
+} linx_alloc_hooks_t;
+
+/* 模块统计 */
+typedef struct {
+    size_t current_bytes;           // 当前占用字节数
+    size_t current_blocks;          // 当前存活块数
+    size_t peak_bytes;              // 本模块历史最高占用
+    size_t bytes_at_peak;           // 全局占用达到峰值时本模块的占用
+    uint64_t allocations;           // 累计分配次数（realloc 计一次分配和一次释放）
+    uint64_t frees;                 // 累计释放次数
+    uint64_t total_bytes;           // 累计分配字节数
+} linx_alloc_module_stats_t;
+
+/* 调用位置统计 */
+typedef struct {
+    linx_alloc_site_t site;         // 分配位置
+    size_t current_bytes;           // 由该位置分配、尚未释放的字节数
+    size_t current_blocks;          // 尚未释放的块数
+    size_t peak_bytes;              // 该位置的历史最高占用
+    uint64_t allocations;           // 累计分配次数
+} linx_alloc_site_stats_t;
+
+/* 跟踪分配器最多区分的调用位置数，超出的归入 "<other>" */
+#define LINX_ALLOC_TRACK_MAX_SITES 256
+
+/* 定义本文件的内存归属模块 */
+#define LINX_ALLOC_MODULE_DEFINE(module) \
+    static const linx_alloc_module_t linx_alloc_file_module = (module)
+
+#define LINX_MALLOC(size)           linx_alloc_malloc((size), linx_alloc_file_module, __FILE__, __LINE__)
+#define LINX_CALLOC(count, size)    linx_alloc_calloc((count), (size), linx_alloc_file_module, __FILE__, __LINE__)
+#define LINX_REALLOC(ptr, size)     linx_alloc_realloc((ptr), (size), linx_alloc_file_module, __FILE__, __LINE__)
+#define LINX_FREE(ptr)              linx_alloc_free((ptr), linx_alloc_file_module, __FILE__, __LINE__)
+#define LINX_STRDUP(str)            linx_alloc_strdup((str), linx_alloc_file_module, __FILE__, __LINE__)
+
+/* 大块缓冲：与上面相同，放置类别为 LINX_ALLOC_BULK，用 LINX_FREE 释放 */
+#define LINX_MALLOC_BULK(size)          linx_alloc_malloc_bulk((size), linx_alloc_file_module, __FILE__, __LINE__)
+#define LINX_CALLOC_BULK(count, size)   linx_alloc_calloc_bulk((count), (size), linx_alloc_file_module, __FILE__, __LINE__)
+#define LINX_REALLOC_BULK(ptr, size)    linx_alloc_realloc_bulk((ptr), (size), linx_alloc_file_module, __FILE__, __LINE__)
+
+/**
+ * 安装自定义分配器
+ * @param hooks 分配器，内容会被复制；为 NULL 时恢复 libc
+ * @return 成功返回 true；有函数为空返回 false
+ */
+bool linx_alloc_set_hooks(const linx_alloc_hooks_t* hooks);
+
+/**
+ * 获取当前分配器
+ * @return 已安装的分配器，未安装时返回 NULL
+ */
+const linx_alloc_hooks_t* linx_alloc_get_hooks(void);
+
+/* 分配入口，一般通过上面的宏调用 */
+void* linx_alloc_malloc(size_t size, linx_alloc_module_t module, const char* file, int line);
+void* linx_alloc_calloc(size_t count, size_t size, linx_alloc_module_t module, const char* file, int line);
+void* linx_alloc_realloc(void* ptr, size_t size, linx_alloc_module_t module, const char* file, int line);
+void linx_alloc_free(void* ptr, linx_alloc_module_t module, const char* file, int line);
+char* linx_alloc_strdup(const char* str, linx_alloc_module_t module, const char* file, int line);
+void* linx_alloc_malloc_bulk(size_t size, linx_alloc_module_t module, const char* file, int line);
+void* linx_alloc_calloc_bulk(size_t count, size_t size, linx_alloc_module_t module, const char* file, int line);
+void* linx_alloc_realloc_bulk(void* ptr, size_t size, linx_alloc_module_t module, const char* file, int line);
+
+/**
+ * 应用分配交给 SDK 接管的内存（计入 LINX_ALLOC_MODULE_APP）
+ */
+void* linx_malloc(size_t size);
+
+/**
+ * 释放 SDK 返回给调用者的内存；ptr 为 NULL 时无操作
+ */
+void linx_free(void* ptr);
+
+/**
+ * 获取模块名
+ * @return 模块名，越界返回 "unknown"
+ */
+const char* linx_alloc_module_name(linx_alloc_module_t module);
+
+/*
+ * 内存区域放置
+ *
+ * ESP32-S3 等板子的 PSRAM 经 cache 访问，频繁访问的小对象放进去延迟高 2~3 倍；
+ * 大块缓冲多为顺序读写，放 PSRAM 可以把片内 SRAM 留给热数据。
+ *
+ * 路由规则：BULK 分配和不小于 bulk_threshold 的 HOT 分配首选外部区域，其余首选
+ * 片内区域；首选区域不存在、超出预算或分配失败时，allow_fallback 为 true 则改用
+ * 另一区域。realloc 尽量留在块原来的区域。每块前附加 16 字节头部记录大小和区域。
+ *
+ * 用法（ESP-IDF）：
+ *   linx_alloc_placement_t placement;
+ *   linx_alloc_placement_default(&placement);
+ *   placement.regions[LINX_ALLOC_REGION_INTERNAL].heap = internal_hooks;  // heap_caps_*(MALLOC_CAP_INTERNAL)
+ *   placement.regions[LINX_ALLOC_REGION_EXTERNAL].heap = psram_hooks;     // heap_caps_*(MALLOC_CAP_SPIRAM)
+ *   placement.regions[LINX_ALLOC_REGION_INTERNAL].budget_bytes = 96 * 1024;
+ *   linx_alloc_hooks_t hooks;
+ *   linx_alloc_placement_hooks(&placement, &hooks);
+ *   linx_sdk_set_alloc_hooks(&hooks);   // 或作为 linx_sdk_enable_alloc_tracking() 的 backing
+ */
+
+/* 内存区域 */
+typedef enum {
+    LINX_ALLOC_REGION_INTERNAL = 0, // 片内 SRAM
+    LINX_ALLOC_REGION_EXTERNAL,     // 外部 PSRAM
+    LINX_ALLOC_REGION_COUNT
+} linx_alloc_region_t;
+
+/* 区域配置 */
+typedef struct {
+    linx_alloc_hooks_t heap;        // 区域的分配器，malloc_fn 为 NULL 表示没有该区域
+    size_t budget_bytes;            // SDK 在该区域的占用上限（含头部），0 不限
+} linx_alloc_region_config_t;
+
+/* 放置策略 */
+typedef struct {
+    linx_alloc_region_config_t regions[LINX_ALLOC_REGION_COUNT];
+    size_t bulk_threshold;          // 不小于该字节数的 HOT 分配也首选外部区域，0 只按类别
+    bool allow_fallback;            // 首选区域不可用时改用另一区域
+} linx_alloc_placement_t;
+
+/* 区域统计 */
+typedef struct {
+    size_t current_bytes;           // 当前占用（含头部）
+    size_t peak_bytes;              // 历史最高占用
+    size_t budget_bytes;            // 预算，0 不限
+    size_t current_blocks;          // 当前存活块数
+    uint64_t allocations;           // 累计分配次数
+    uint64_t fallbacks;             // 首选其他区域、转到本区域的分配次数
+    uint64_t over_budget;           // 因本区域预算不足转走或失败的次数
+    uint64_t failures;              // 本区域分配器返回 NULL 的次数
+} linx_alloc_region_stats_t;
+
+/**
+ * 默认策略：片内区域使用 libc、没有外部区域、不限预算、允许回退、阈值 4KB
+ */
+void linx_alloc_placement_default(linx_alloc_placement_t* placement);
+
+/**
+ * 按策略生成分配器（全局只有一份策略，重新调用会覆盖，须在安装钩子前调用）
+ * @param placement 策略，内容会被复制；片内区域必须有分配器
+ * @param hooks 输出，交给 linx_sdk_set_alloc_hooks() 或作为跟踪分配器的 backing
+ * @return 成功返回 true；区域分配器函数不全返回 false
+ */
+bool linx_alloc_placement_hooks(const linx_alloc_placement_t* placement, linx_alloc_hooks_t* hooks);
+
+/**
+ * 获取区域统计
+ * @return 成功返回 true；未生成放置分配器或区域越界返回 false
+ */
+bool linx_alloc_get_region_stats(linx_alloc_region_t region, linx_alloc_region_stats_t* stats);
+
+/**
+ * 获取区域名（"internal" / "external"），越界返回 "unknown"
+ */
+const char* linx_alloc_region_name(linx_alloc_region_t region);
+
+/*
+ * 静态内存区
+ *
+ * 认证和长期运行的 MCU 产品要求内存确定：SDK 的全部分配（LinxSdk、WebSocket 协议、
+ * 播放环形缓冲、包池、MCP 工具表、cJSON 竞技场、Opus 编解码器状态，启用
+ * LINX_STATIC_MEMORY 构建时还有 mongoose 的连接和收发缓冲）都从调用者提供的一块内存中切出，
+ * 不再调用 malloc。
+ *
+ * 分配按尺寸档位进行：每个二的幂区间分 4 档（64、80、96、112、128、160…字节，含 16 字节
+ * 头部），释放的块挂在本档的空闲链表上供同档再次分配，新块从内存区尾部顺序切出。
+ * 分配和释放都是 O(1)，不合并、不拆分，因此不会随运行时间产生碎片；代价是每块最多
+ * 浪费约 20%。
+ *
+ * linx_alloc_static_seal() 封存内存区：之后不再从尾部切出新块，只能复用已释放的块。
+ * 初始化和第一次会话完成后封存，稳态下的分配都由空闲链表满足；封存后仍需要新块
+ * 说明稳态不封闭，分配失败并计入 failures（第一次失败以 WARN 级别输出调用位置）。
+ *
+ * 用法：
+ *   static uint8_t s_sdk_memory[160 * 1024] __attribute__((aligned(16)));
+ *   LinxSdk* sdk = linx_sdk_create_static(&config, s_sdk_memory, sizeof(s_sdk_memory));
+ *   ...第一次会话建立后...
+ *   linx_sdk_seal_memory(sdk);
+ */
+
+/* 静态内存区统计 */
+typedef struct {
+    size_t capacity;                // 可用字节数（按 16 字节对齐后）
+    size_t carved_bytes;            // 已从尾部切出的字节数（只增不减）
+    size_t current_bytes;           // 在用块占用（按档位大小计，含头部）
+    size_t peak_bytes;              // 历史最高占用
+    size_t current_blocks;          // 在用块数
+    uint64_t allocations;           // 累计分配次数
+    uint64_t reused;                // 由空闲链表满足的分配次数
+    uint64_t failures;              // 内存区不足或封存后没有可复用块的次数
+    bool sealed;                    // 已封存
+} linx_alloc_static_stats_t;
+
+/**
+ * 在调用者提供的内存上生成分配器（全局只有一个静态内存区，重新调用会丢弃之前的内存区，
+ * 须在安装钩子前调用）
+ * @param memory 内存区，SDK 使用期间必须有效；起始地址不足 16 字节对齐的部分不使用
+ * @param size 内存区字节数
+ * @param hooks 输出，交给 linx_sdk_set_alloc_hooks() 或作为跟踪分配器的 backing
+ * @return 成功返回 true；memory 为 NULL 或不足 1KB 返回 false
+ */
+bool linx_alloc_static_hooks(void* memory, size_t size, linx_alloc_hooks_t* hooks);
+
+/**
+ * 封存静态内存区：之后只复用已释放的块
+ */
+void linx_alloc_static_seal(void);
+
+/**
+ * 获取静态内存区统计
+ * @return 成功返回 true；未生成静态内存区分配器返回 false
+ */
+bool linx_alloc_static_get_stats(linx_alloc_static_stats_t* stats);
+
+/**
+ * 安装跟踪分配器
+ * 每块内存前附加一个 16 字节的头部记录大小、模块和调用位置
+ * @param backing 实际分配内存的分配器，为 NULL 时使用 libc
+ * @return 成功返回 true
+ */
+bool linx_alloc_tracking_enable(const linx_alloc_hooks_t* backing);
+
+/**
+ * 跟踪分配器是否已安装
+ */
+bool linx_alloc_tracking_enabled(void);
+
+/**
+ * 获取总占用
+ * @param peak_bytes 输出历史峰值，可为 NULL
+ * @return 当前总占用字节数；未启用跟踪时返回 0
+ */
+size_t linx_alloc_get_total(size_t* peak_bytes);
+
+/**
+ * 获取分配失败次数（非零大小的 malloc / calloc / realloc 返回 NULL）
+ * 不依赖跟踪分配器，直接使用 libc 时同样计数
+ */
+uint64_t linx_alloc_get_failures(void);
+
+/**
+ * 获取模块统计
+ * @return 成功返回 true；未启用跟踪或模块越界返回 false
+ */
+bool linx_alloc_get_module_stats(linx_alloc_module_t module, linx_alloc_module_stats_t* stats);
+
+/**
+ * 获取调用位置统计，按当前占用从大到小排序
+ * @param sites 输出数组
+ * @param max_sites 数组容量
+ * @return 写入的条目数
+ */
+size_t linx_alloc_get_sites(linx_alloc_site_stats_t* sites, size_t max_sites);
+
+/**
+ * 把全局峰值和各模块峰值重置为当前占用（累计次数不变）
+ */
+void linx_alloc_reset_peak(void);
+
+/**
+ * 以 INFO 级别输出模块统计和占用最多的 top_sites 个调用位置
+ */
+void linx_alloc_dump(size_t top_sites);
+
+/*
+ * 零分配区检查
+ *
+ * 音频热路径（上行发送、下行分发、播放解码）用 enter/leave 标记为零分配区。
+ * linx_alloc_no_alloc_arm() 打开检查后，零分配区内经本接口的任何分配
+ * （malloc / calloc / realloc / strdup，不含 free）都会调用陷阱函数，
+ * 默认陷阱以 FATAL 级别输出调用位置后 abort()。
+ *
+ * - 区域深度按线程记录，可以嵌套；未打开检查时 enter/leave 只是计数
+ * - arm/disarm 是全局计数，多个会话各自 arm 一次、disarm 一次即可
+ * - 只能拦截经本接口的分配；Opus 的状态经本接口分配，mongoose 只在 LINX_STATIC_MEMORY
+ *   构建时经本接口分配，其余第三方库的内部分配不在检查范围
+ */
+
+/**
+ * 零分配区内发生分配时的回调
+ * 回调期间本线程临时退出零分配区，可以打日志或分配内存；返回后分配照常进行
+ * @param site 分配位置
+ * @param size 请求的字节数
+ * @param user_data linx_alloc_set_trap() 传入的用户数据
+ */
+typedef void (*linx_alloc_trap_fn)(const linx_alloc_site_t* site, size_t size, void* user_data);
+
+/* 进入 / 离开本线程的零分配区 */
+void linx_alloc_no_alloc_enter(void);
+void linx_alloc_no_alloc_leave(void);
+
+/* 打开 / 关闭零分配检查 */
+void linx_alloc_no_alloc_arm(void);
+void linx_alloc_no_alloc_disarm(void);
+
+/**
+ * 本线程当前是否处于已打开检查的零分配区
+ */
+bool linx_alloc_no_alloc_active(void);
+
+/**
+ * 设置陷阱函数
+ * @param trap 陷阱函数，为 NULL 时恢复默认（输出位置后 abort）
+ * @param user_data 传给陷阱函数的用户数据
+ */
+void linx_alloc_set_trap(linx_alloc_trap_fn trap, void* user_data);
+
+/**
+ * 获取零分配区内发生过的分配次数
+ */
+uint64_t linx_alloc_get_violations(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINX_ALLOC_H */
@@ -0,0 +1,626 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE             /* pthread_getname_np */
+#endif
+
+#include "linx_deadline.h"
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* 栈采样使用的信号，0 关闭；默认只在有 backtrace() 的平台上打开 */
+#ifndef LINX_DEADLINE_STACK_SIGNAL
+#if defined(__GLIBC__) || defined(__APPLE__)
+#define LINX_DEADLINE_STACK_SIGNAL SIGURG
+#else
+#define LINX_DEADLINE_STACK_SIGNAL 0
+#endif
+#endif
+
+#if LINX_DEADLINE_STACK_SIGNAL
+#include <execinfo.h>
+#endif
+
+#if defined(__GLIBC__) || defined(__APPLE__)
+#define LINX_DEADLINE_HAVE_THREAD_NAME 1
+#endif
+
+/* 栈采样时丢弃的最内层帧：信号处理函数和信号跳板 */
+#define LINX_DEADLINE_STACK_SKIP 2
+
+/* 等待目标线程完成栈采样的最长时间(微秒) */
+#define LINX_DEADLINE_SAMPLE_WAIT_US 20000
+
+/* 巡检线程栈大小，监听者回调也在这个线程上 */
+#define LINX_DEADLINE_WATCHDOG_STACK_SIZE (32 * 1024)
+
+/* 持有锁的线程名称表，编号从 1 开始，1 为无法识别的线程 */
+#define LINX_DEADLINE_MAX_THREAD_NAMES 32
+
+struct linx_deadline {
+    bool used;                      // 槽位已分配（由 s_mutex 保护）
+    uint32_t id;                    // 每次分配槽位时递增，线程绑定据此判断监测器是否还在（原子读写）
+    char name[LINX_DEADLINE_NAME_SIZE];
+    uint32_t period_us;
+    uint32_t slack_us;
+    linx_deadline_context_cb_t context;
+    void* context_user_data;
+
+    // 由监测的线程写入（原子读写）
+    uint64_t last_us;               // 当前周期的开始时刻，0 为空闲
+    uint32_t expected_us;           // 当前周期的长度
+    const char* activity;
+    const char* waiting;
+    pthread_t thread;               // 最近一次 tick 的线程
+
+    // 统计（原子读写）
+    uint64_t periods;
+    uint64_t misses;
+    uint64_t stalls;
+    uint64_t total_late_us;
+    uint32_t max_late_us;
+    uint32_t unreported;            // 还没有报告的超时次数
+
+    // 现场（由 report_mutex 保护）
+    pthread_mutex_t report_mutex;
+    linx_deadline_snapshot_t sample;    // 巡检线程在周期 sampled_for 超时期间抓取的现场
+    uint64_t sampled_for;
+    linx_deadline_snapshot_t report;    // 待送出的报告
+    bool report_pending;
+
+    uint64_t stall_reported_for;    // 已提前报告卡死的周期（仅巡检线程访问）
+};
+
+typedef struct {
+    linx_deadline_listener_t listener;
+    void* user_data;
+} linx_deadline_listener_slot_t;
+
+/* 监测器放在静态槽位中：线程局部的绑定和锁的等待标注在监测器销毁后写入也不会越界 */
+static pthread_mutex_t s_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_delivered = PTHREAD_COND_INITIALIZER;
+static struct linx_deadline s_monitors[LINX_DEADLINE_MAX_MONITORS];
+static size_t s_monitor_count;
+static uint32_t s_next_id;
+static linx_deadline_lock_t* s_locks[LINX_DEADLINE_MAX_LOCKS];
+static linx_deadline_listener_slot_t s_listeners[LINX_DEADLINE_MAX_LISTENERS];
+static bool s_watchdog_running;
+static pthread_t s_watchdog_thread;
+static bool s_delivering;
+
+/* 只追加的线程名称表，条目写入后不再修改 */
+static char s_thread_names[LINX_DEADLINE_MAX_THREAD_NAMES][LINX_DEADLINE_NAME_SIZE] = { "thread" };
+static uint32_t s_thread_name_count = 1;
+
+/* 巡检线程待送出的现场，仅巡检线程访问 */
+static linx_deadline_snapshot_t s_outbox[LINX_DEADLINE_MAX_MONITORS * 2];
+
+static __thread struct linx_deadline* t_monitor;
+static __thread uint32_t t_monitor_id;
+static __thread uint32_t t_name_id;
+
+static uint64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ull + (uint64_t)ts.tv_nsec / 1000ull;
+}
+
+static void copy_name(char* dst, size_t size, const char* src) {
+    snprintf(dst, size, "%s", src ? src : "");
+}
+
+/* 当前线程绑定的监测器，已销毁时返回 NULL */
+static struct linx_deadline* bound_monitor(void) {
+    struct linx_deadline* dl = t_monitor;
+    return dl && __atomic_load_n(&dl->id, __ATOMIC_ACQUIRE) == t_monitor_id ? dl : NULL;
+}
+
+/* ==================== 栈采样 ==================== */
+
+#if LINX_DEADLINE_STACK_SIGNAL
+static void* s_sample_frames[LINX_DEADLINE_STACK_DEPTH + LINX_DEADLINE_STACK_SKIP];
+static int s_sample_depth;
+static int s_sample_done;
+static bool s_handler_installed;
+
+static void sample_handler(int sig) {
+    (void)sig;
+    int saved_errno = errno;
+    __atomic_store_n(&s_sample_depth,
+                     backtrace(s_sample_frames, LINX_DEADLINE_STACK_DEPTH + LINX_DEADLINE_STACK_SKIP),
+                     __ATOMIC_RELAXED);
+    __atomic_store_n(&s_sample_done, 1, __ATOMIC_RELEASE);
+    errno = saved_errno;
+}
+
+/* 在巡检线程上调用一次：应用没有占用该信号时安装处理函数，并预先加载 backtrace 的依赖 */
+static void install_sample_handler(void) {
+    void* frame;
+    backtrace(&frame, 1);
+
+    struct sigaction old;
+    if (sigaction(LINX_DEADLINE_STACK_SIGNAL, NULL, &old) != 0 ||
+        (!(old.sa_flags & SA_SIGINFO) && old.sa_handler != SIG_DFL && old.sa_handler != SIG_IGN &&
+         old.sa_handler != sample_handler)) {
+        return;
+    }
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = sample_handler;
+    sa.sa_flags = SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    s_handler_installed = sigaction(LINX_DEADLINE_STACK_SIGNAL, &sa, NULL) == 0;
+}
+#endif
+
+/* 向卡住的线程发信号取栈，仅巡检线程调用 */
+static size_t sample_stack(struct linx_deadline* dl, void** stack) {
+#if LINX_DEADLINE_STACK_SIGNAL
+    if (!s_handler_installed) {
+        return 0;
+    }
+    pthread_t target;
+    __atomic_load(&dl->thread, &target, __ATOMIC_ACQUIRE);
+    __atomic_store_n(&s_sample_done, 0, __ATOMIC_RELAXED);
+    if (pthread_kill(target, LINX_DEADLINE_STACK_SIGNAL) != 0) {
+        return 0;
+    }
+    struct timespec step = { 0, 500 * 1000 };
+    for (int waited = 0; !__atomic_load_n(&s_sample_done, __ATOMIC_ACQUIRE); waited += 500) {
+        if (waited >= LINX_DEADLINE_SAMPLE_WAIT_US) {
+            return 0;
+        }
+        nanosleep(&step, NULL);
+    }
+    int depth = __atomic_load_n(&s_sample_depth, __ATOMIC_RELAXED) - LINX_DEADLINE_STACK_SKIP;
+    if (depth <= 0) {
+        return 0;
+    }
+    memcpy(stack, s_sample_frames + LINX_DEADLINE_STACK_SKIP, (size_t)depth * sizeof(void*));
+    return (size_t)depth;
+#else
+    (void)dl;
+    (void)stack;
+    return 0;
+#endif
+}
+
+/* ==================== 现场 ==================== */
+
+/* 填充除栈和时长以外的现场；列出持有的锁需要 s_mutex，have_registry 为 false 时尝试获取 */
+static void fill_snapshot(struct linx_deadline* dl, linx_deadline_snapshot_t* snap, bool have_registry) {
+    memcpy(snap->name, dl->name, sizeof(snap->name));
+    copy_name(snap->activity, sizeof(snap->activity), __atomic_load_n(&dl->activity, __ATOMIC_RELAXED));
+    copy_name(snap->waiting, sizeof(snap->waiting), __atomic_load_n(&dl->waiting, __ATOMIC_RELAXED));
+    snap->stack_depth = 0;
+
+    snap->locks[0] = '\0';
+    if (have_registry || pthread_mutex_trylock(&s_mutex) == 0) {
+        size_t used = 0;
+        for (size_t i = 0; i < LINX_DEADLINE_MAX_LOCKS && used < sizeof(snap->locks); i++) {
+            uint32_t holder = s_locks[i] ? __atomic_load_n(&s_locks[i]->holder, __ATOMIC_RELAXED) : 0;
+            if (holder == 0 || holder > s_thread_name_count) {
+                continue;
+            }
+            int n = snprintf(snap->locks + used, sizeof(snap->locks) - used, "%s%s@%s",
+                             used > 0 ? " " : "", s_locks[i]->name, s_thread_names[holder - 1]);
+            if (n > 0) {
+                used += (size_t)n;
+            }
+        }
+        if (!have_registry) {
+            pthread_mutex_unlock(&s_mutex);
+        }
+    }
+
+    snap->context[0] = '\0';
+    if (dl->context) {
+        size_t n = dl->context(dl->context_user_data, snap->context, sizeof(snap->context));
+        snap->context[n < sizeof(snap->context) ? n : sizeof(snap->context) - 1] = '\0';
+    }
+}
+
+/* 记录一次超时并准备报告，在监测的线程上调用，不阻塞 */
+static void record_miss(struct linx_deadline* dl, uint64_t start_us, uint32_t period_us, uint32_t late_us) {
+    __atomic_fetch_add(&dl->misses, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&dl->total_late_us, late_us, __ATOMIC_RELAXED);
+    uint32_t max = __atomic_load_n(&dl->max_late_us, __ATOMIC_RELAXED);
+    while (late_us > max &&
+           !__atomic_compare_exchange_n(&dl->max_late_us, &max, late_us, true, __ATOMIC_RELAXED,
+                                        __ATOMIC_RELAXED)) {
+    }
+    __atomic_fetch_add(&dl->unreported, 1, __ATOMIC_RELAXED);
+
+    // 巡检线程正在抓取现场时不等待，次数并入下一次报告
+    if (pthread_mutex_trylock(&dl->report_mutex) != 0) {
+        return;
+    }
+    if (!dl->report_pending) {
+        if (dl->sampled_for == start_us) {
+            dl->report = dl->sample;
+        } else {
+            fill_snapshot(dl, &dl->report, false);
+        }
+        dl->report.deadline_us = start_us + period_us;
+        dl->report.period_us = period_us;
+        dl->report.late_us = late_us;
+        dl->report.stalled = false;
+        dl->report_pending = true;
+    }
+    pthread_mutex_unlock(&dl->report_mutex);
+}
+
+/* 检查一个监测器，把要送出的现场放入 s_outbox，调用方持有 s_mutex */
+static size_t scan_monitor(struct linx_deadline* dl, uint64_t now, linx_deadline_snapshot_t* out) {
+    size_t count = 0;
+    uint64_t start = __atomic_load_n(&dl->last_us, __ATOMIC_ACQUIRE);
+    uint32_t period = __atomic_load_n(&dl->expected_us, __ATOMIC_RELAXED);
+
+    if (start != 0 && now > start && now - start > (uint64_t)period + dl->slack_us) {
+        uint64_t late = now - start - period;
+        if (dl->sampled_for != start) {
+            // 先在锁外取栈，监测的线程恢复后 tick 中的 trylock 不会因此失败
+            void* stack[LINX_DEADLINE_STACK_DEPTH];
+            size_t depth = sample_stack(dl, stack);
+            pthread_mutex_lock(&dl->report_mutex);
+            fill_snapshot(dl, &dl->sample, true);
+            memcpy(dl->sample.stack, stack, depth * sizeof(void*));
+            dl->sample.stack_depth = depth;
+            dl->sampled_for = start;
+            pthread_mutex_unlock(&dl->report_mutex);
+        }
+        if (late >= (uint64_t)LINX_DEADLINE_STALL_MS * 1000 && dl->stall_reported_for != start) {
+            dl->stall_reported_for = start;
+            __atomic_fetch_add(&dl->stalls, 1, __ATOMIC_RELAXED);
+            pthread_mutex_lock(&dl->report_mutex);
+            out[count] = dl->sample;
+            pthread_mutex_unlock(&dl->report_mutex);
+            out[count].deadline_us = start + period;
+            out[count].period_us = period;
+            out[count].late_us = late > UINT32_MAX ? UINT32_MAX : (uint32_t)late;
+            out[count].misses = 0;
+            out[count].stalled = true;
+            count++;
+        }
+    }
+
+    pthread_mutex_lock(&dl->report_mutex);
+    if (dl->report_pending) {
+        out[count] = dl->report;
+        out[count].misses = __atomic_exchange_n(&dl->unreported, 0, __ATOMIC_RELAXED);
+        dl->report_pending = false;
+        count++;
+    }
+    pthread_mutex_unlock(&dl->report_mutex);
+    return count;
+}
+
+/* ==================== 巡检线程 ==================== */
+
+static void* watchdog_thread(void* arg) {
+    (void)arg;
+#if LINX_DEADLINE_STACK_SIGNAL
+    install_sample_handler();
+#endif
+    struct timespec interval = { 0, LINX_DEADLINE_WATCHDOG_MS * 1000000L };
+
+    pthread_mutex_lock(&s_mutex);
+    while (s_monitor_count > 0) {
+        pthread_mutex_unlock(&s_mutex);
+        nanosleep(&interval, NULL);
+        pthread_mutex_lock(&s_mutex);
+
+        uint64_t now = now_us();
+        size_t count = 0;
+        for (size_t i = 0; i < LINX_DEADLINE_MAX_MONITORS; i++) {
+            if (s_monitors[i].used) {
+                count += scan_monitor(&s_monitors[i], now, s_outbox + count);
+            }
+        }
+        if (count == 0) {
+            continue;
+        }
+
+        linx_deadline_listener_slot_t listeners[LINX_DEADLINE_MAX_LISTENERS];
+        memcpy(listeners, s_listeners, sizeof(listeners));
+        s_delivering = true;
+        pthread_mutex_unlock(&s_mutex);
+        for (size_t i = 0; i < count; i++) {
+            for (size_t j = 0; j < LINX_DEADLINE_MAX_LISTENERS; j++) {
+                if (listeners[j].listener) {
+                    listeners[j].listener(listeners[j].user_data, &s_outbox[i]);
+                }
+            }
+        }
+        pthread_mutex_lock(&s_mutex);
+        s_delivering = false;
+        pthread_cond_broadcast(&s_delivered);
+    }
+    s_watchdog_running = false;
+    pthread_mutex_unlock(&s_mutex);
+    return NULL;
+}
+
+/* 调用方持有 s_mutex */
+static void start_watchdog_locked(void) {
+    if (s_watchdog_running) {
+        return;
+    }
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    pthread_attr_setstacksize(&attr, LINX_DEADLINE_WATCHDOG_STACK_SIZE);
+    s_watchdog_running = pthread_create(&s_watchdog_thread, &attr, watchdog_thread, NULL) == 0;
+    pthread_attr_destroy(&attr);
+}
+
+/* ==================== 监测器 ==================== */
+
+linx_deadline_t* linx_deadline_create(const linx_deadline_config_t* config) {
+    if (!config || config->period_us == 0) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&s_mutex);
+    struct linx_deadline* dl = NULL;
+    for (size_t i = 0; i < LINX_DEADLINE_MAX_MONITORS; i++) {
+        if (!s_monitors[i].used) {
+            dl = &s_monitors[i];
+            break;
+        }
+    }
+    if (!dl) {
+        pthread_mutex_unlock(&s_mutex);
+        return NULL;
+    }
+
+    uint32_t id = ++s_next_id;
+    memset(dl, 0, sizeof(*dl));
+    dl->used = true;
+    copy_name(dl->name, sizeof(dl->name), config->name);
+    dl->period_us = config->period_us;
+    dl->slack_us = config->slack_us > 0 ? config->slack_us : config->period_us / 2;
+    dl->context = config->context;
+    dl->context_user_data = config->context_user_data;
+    dl->expected_us = config->period_us;
+    pthread_mutex_init(&dl->report_mutex, NULL);
+    __atomic_store_n(&dl->id, id, __ATOMIC_RELEASE);
+
+    s_monitor_count++;
+    start_watchdog_locked();
+    pthread_mutex_unlock(&s_mutex);
+    return dl;
+}
+
+void linx_deadline_destroy(linx_deadline_t* deadline) {
+    if (!deadline) {
+        return;
+    }
+    pthread_mutex_lock(&s_mutex);
+    if (deadline->used) {
+        __atomic_store_n(&deadline->id, 0, __ATOMIC_RELEASE);
+        __atomic_store_n(&deadline->last_us, 0, __ATOMIC_RELEASE);
+        pthread_mutex_destroy(&deadline->report_mutex);
+        deadline->used = false;
+        s_monitor_count--;
+    }
+    pthread_mutex_unlock(&s_mutex);
+}
+
+uint32_t linx_deadline_tick(linx_deadline_t* deadline, uint32_t period_us) {
+    if (!deadline) {
+        return 0;
+    }
+    uint64_t now = now_us();
+    if (t_monitor != deadline || t_monitor_id != __atomic_load_n(&deadline->id, __ATOMIC_RELAXED)) {
+        pthread_t self = pthread_self();
+        __atomic_store(&deadline->thread, &self, __ATOMIC_RELEASE);
+        t_monitor = deadline;
+        t_monitor_id = __atomic_load_n(&deadline->id, __ATOMIC_RELAXED);
+    }
+
+    uint32_t late_us = 0;
+    uint64_t start = __atomic_load_n(&deadline->last_us, __ATOMIC_RELAXED);
+    if (start != 0 && now > start) {
+        uint32_t expected = __atomic_load_n(&deadline->expected_us, __ATOMIC_RELAXED);
+        uint64_t elapsed = now - start;
+        if (elapsed > (uint64_t)expected + deadline->slack_us) {
+            uint64_t late = elapsed - expected;
+            late_us = late > UINT32_MAX ? UINT32_MAX : (uint32_t)late;
+            record_miss(deadline, start, expected, late_us);
+        }
+    }
+
+    __atomic_fetch_add(&deadline->periods, 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&deadline->expected_us, period_us > 0 ? period_us : deadline->period_us, __ATOMIC_RELAXED);
+    __atomic_store_n(&deadline->last_us, now, __ATOMIC_RELEASE);
+    return late_us;
+}
+
+void linx_deadline_idle(linx_deadline_t* deadline) {
+    if (deadline) {
+        __atomic_store_n(&deadline->last_us, 0, __ATOMIC_RELEASE);
+    }
+}
+
+const char* linx_deadline_activity(const char* activity) {
+    struct linx_deadline* dl = bound_monitor();
+    return dl ? __atomic_exchange_n(&dl->activity, activity, __ATOMIC_RELAXED) : NULL;
+}
+
+bool linx_deadline_get_stats(const linx_deadline_t* deadline, linx_deadline_stats_t* stats) {
+    if (!deadline || !stats) {
+        return false;
+    }
+    stats->periods = __atomic_load_n(&deadline->periods, __ATOMIC_RELAXED);
+    stats->misses = __atomic_load_n(&deadline->misses, __ATOMIC_RELAXED);
+    stats->stalls = __atomic_load_n(&deadline->stalls, __ATOMIC_RELAXED);
+    stats->total_late_us = __atomic_load_n(&deadline->total_late_us, __ATOMIC_RELAXED);
+    stats->max_late_us = __atomic_load_n(&deadline->max_late_us, __ATOMIC_RELAXED);
+    return true;
+}
+
+/* ==================== 锁标注 ==================== */
+
+/* 当前线程在名称表中的编号，第一次调用时按线程名登记 */
+static uint32_t current_name_id(void) {
+    if (t_name_id != 0) {
+        return t_name_id;
+    }
+    char name[LINX_DEADLINE_NAME_SIZE] = "";
+#if defined(LINX_DEADLINE_HAVE_THREAD_NAME)
+    pthread_getname_np(pthread_self(), name, sizeof(name));
+#endif
+    struct linx_deadline* dl = bound_monitor();
+    if (name[0] == '\0' && dl) {
+        memcpy(name, dl->name, sizeof(name));
+    }
+
+    uint32_t id = 1;
+    if (name[0] != '\0') {
+        pthread_mutex_lock(&s_mutex);
+        uint32_t i = 0;
+        while (i < s_thread_name_count && strcmp(s_thread_names[i], name) != 0) {
+            i++;
+        }
+        if (i == s_thread_name_count && i < LINX_DEADLINE_MAX_THREAD_NAMES) {
+            memcpy(s_thread_names[i], name, sizeof(name));
+            s_thread_name_count++;
+        }
+        if (i < s_thread_name_count) {
+            id = i + 1;
+        }
+        pthread_mutex_unlock(&s_mutex);
+    }
+    t_name_id = id;
+    return id;
+}
+
+static void register_lock(linx_deadline_lock_t* lock) {
+    pthread_mutex_lock(&s_mutex);
+    if (!lock->registered) {
+        for (size_t i = 0; i < LINX_DEADLINE_MAX_LOCKS; i++) {
+            if (!s_locks[i]) {
+                s_locks[i] = lock;
+                break;
+            }
+        }
+        // 槽位已满时不再重试，这把锁不出现在现场中
+        __atomic_store_n(&lock->registered, true, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&s_mutex);
+}
+
+void linx_deadline_lock(linx_deadline_lock_t* lock, pthread_mutex_t* mutex) {
+    uint32_t name_id = current_name_id();
+    if (!__atomic_load_n(&lock->registered, __ATOMIC_ACQUIRE)) {
+        register_lock(lock);
+    }
+    if (pthread_mutex_trylock(mutex) != 0) {
+        struct linx_deadline* dl = bound_monitor();
+        if (dl) {
+            __atomic_store_n(&dl->waiting, lock->name, __ATOMIC_RELAXED);
+        }
+        pthread_mutex_lock(mutex);
+        if (dl) {
+            __atomic_store_n(&dl->waiting, NULL, __ATOMIC_RELAXED);
+        }
+    }
+    __atomic_store_n(&lock->holder, name_id, __ATOMIC_RELAXED);
+}
+
+void linx_deadline_unlock(linx_deadline_lock_t* lock, pthread_mutex_t* mutex) {
+    __atomic_store_n(&lock->holder, 0, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(mutex);
+}
+
+void linx_deadline_lock_unregister(linx_deadline_lock_t* lock) {
+    if (!lock) {
+        return;
+    }
+    pthread_mutex_lock(&s_mutex);
+    for (size_t i = 0; i < LINX_DEADLINE_MAX_LOCKS; i++) {
+        if (s_locks[i] == lock) {
+            s_locks[i] = NULL;
+        }
+    }
+    __atomic_store_n(&lock->registered, false, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&s_mutex);
+}
+
+/* ==================== 监听者 ==================== */
+
+bool linx_deadline_add_listener(linx_deadline_listener_t listener, void* user_data) {
+    if (!listener) {
+        return false;
+    }
+    bool added = false;
+    pthread_mutex_lock(&s_mutex);
+    for (size_t i = 0; i < LINX_DEADLINE_MAX_LISTENERS && !added; i++) {
+        if (!s_listeners[i].listener) {
+            s_listeners[i].listener = listener;
+            s_listeners[i].user_data = user_data;
+            added = true;
+        }
+    }
+    pthread_mutex_unlock(&s_mutex);
+    return added;
+}
+
+void linx_deadline_remove_listener(linx_deadline_listener_t listener, void* user_data) {
+    pthread_mutex_lock(&s_mutex);
+    for (size_t i = 0; i < LINX_DEADLINE_MAX_LISTENERS; i++) {
+        if (s_listeners[i].listener == listener && s_listeners[i].user_data == user_data) {
+            s_listeners[i].listener = NULL;
+            s_listeners[i].user_data = NULL;
+        }
+    }
+    // 巡检线程可能还在用移除前的副本回调，等它送完（回调中移除时不等待）
+    while (s_delivering && !pthread_equal(pthread_self(), s_watchdog_thread)) {
+        pthread_cond_wait(&s_delivered, &s_mutex);
+    }
+    pthread_mutex_unlock(&s_mutex);
+}
+
+size_t linx_deadline_snapshot_format(const linx_deadline_snapshot_t* snapshot, char* buf, size_t size) {
+    if (!snapshot || !buf || size == 0) {
+        return 0;
+    }
+    size_t used = 0;
+#define LINX_DEADLINE_APPEND(...)                                               \
+    do {                                                                        \
+        if (used < size) {                                                      \
+            int n = snprintf(buf + used, size - used, __VA_ARGS__);             \
+            used = n < 0 ? used : (used + (size_t)n < size ? used + (size_t)n : size - 1); \
+        }                                                                       \
+    } while (0)
+
+    LINX_DEADLINE_APPEND("%s %s %u.%ums (period %u.%ums)", snapshot->name,
+                         snapshot->stalled ? "stalled" : "late",
+                         snapshot->late_us / 1000, snapshot->late_us % 1000 / 100,
+                         snapshot->period_us / 1000, snapshot->period_us % 1000 / 100);
+    if (snapshot->misses > 1) {
+        LINX_DEADLINE_APPEND(" x%u", snapshot->misses);
+    }
+    if (snapshot->activity[0]) {
+        LINX_DEADLINE_APPEND(" activity=%s", snapshot->activity);
+    }
+    if (snapshot->waiting[0]) {
+        LINX_DEADLINE_APPEND(" waiting=%s", snapshot->waiting);
+    }
+    if (snapshot->locks[0]) {
+        LINX_DEADLINE_APPEND(" locks=[%s]", snapshot->locks);
+    }
+    if (snapshot->context[0]) {
+        LINX_DEADLINE_APPEND(" %s", snapshot->context);
+    }
+    if (snapshot->stack_depth > 0) {
+        LINX_DEADLINE_APPEND(" stack=");
+        for (size_t i = 0; i < snapshot->stack_depth; i++) {
+            LINX_DEADLINE_APPEND("%s%p", i > 0 ? "," : "", snapshot->stack[i]);
+        }
+    }
+#undef LINX_DEADLINE_APPEND
+    return used;
+}
@@ -0,0 +1,204 @@
+#ifndef LINX_DEADLINE_H
+#define LINX_DEADLINE_H
+
+/*
+ * 音频线程的周期截止监测
+ *
+ * 采集、播放循环每个周期都必须按时完成，慢解码、锁等待、阻塞的日志输出让某个周期
+ * 超时以后，现场只能听到一声卡顿。每个音频线程创建一个监测器，在每个周期开始时调用
+ * linx_deadline_tick()：它记下时间戳，与上一周期开始的间隔超过周期 + 余量即为一次超时，
+ * 统计超时次数和超出的时长。
+ *
+ * 超时时抓取一份简短的现场（linx_deadline_snapshot_t）：
+ * - 线程当前的工作阶段（linx_deadline_activity() 标注，如 "decode"、"device_write"）
+ * - 线程正在等待的锁和所有被持有的已标注锁及其持有线程（linx_deadline_lock()）
+ * - 创建时给出的上下文回调输出，通常是各个队列的深度
+ * - 栈采样：后台巡检线程发现某个线程已经超时还没进入下一周期时，向它发送信号、在信号
+ *   处理中取 backtrace()，得到卡住时的返回地址（glibc 和 macOS；其他平台为空）
+ *
+ * 巡检线程在第一个监测器创建时启动、最后一个销毁时退出，每 LINX_DEADLINE_WATCHDOG_MS
+ * 检查一次，并在自己的线程上把现场交给 linx_deadline_add_listener() 登记的监听者：
+ * 周期结束后每次超时报告一次；超时持续 LINX_DEADLINE_STALL_MS 仍未恢复（卡死）时
+ * 提前报告一次 stalled 现场。音频线程上只有一次时钟读取和几次原子操作，超时时
+ * 才做一次 trylock 和现场填充，不分配内存、不阻塞。
+ *
+ * 使用约束：
+ * - 线程暂停等待数据前调用 linx_deadline_idle()，下一次 tick 重新计时，不算超时
+ * - 线程退出前调用 linx_deadline_idle()，巡检线程不会再向它发送信号
+ * - 栈采样会打断目标线程当前的系统调用（SA_RESTART，大多数调用自动重启）；
+ *   编译时定义 LINX_DEADLINE_STACK_SIGNAL=0 关闭
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 最多同时存在的监测器数 */
+#ifndef LINX_DEADLINE_MAX_MONITORS
+#define LINX_DEADLINE_MAX_MONITORS 8
+#endif
+
+/* 最多登记的锁数 */
+#ifndef LINX_DEADLINE_MAX_LOCKS
+#define LINX_DEADLINE_MAX_LOCKS 16
+#endif
+
+/* 最多登记的监听者数 */
+#ifndef LINX_DEADLINE_MAX_LISTENERS
+#define LINX_DEADLINE_MAX_LISTENERS 4
+#endif
+
+/* 巡检间隔(毫秒) */
+#ifndef LINX_DEADLINE_WATCHDOG_MS
+#define LINX_DEADLINE_WATCHDOG_MS 10
+#endif
+
+/* 超时持续这么久仍未恢复时提前报告(毫秒) */
+#ifndef LINX_DEADLINE_STALL_MS
+#define LINX_DEADLINE_STALL_MS 500
+#endif
+
+/* 栈采样保留的帧数 */
+#define LINX_DEADLINE_STACK_DEPTH 16
+
+/* 名称最大长度（含结尾 '\0'） */
+#define LINX_DEADLINE_NAME_SIZE 16
+
+typedef struct linx_deadline linx_deadline_t;
+
+/**
+ * 上下文回调：向 buf 写入一行说明（如 "jitter=3 ahead=2"），返回写入的字节数
+ * 可能在监测的线程或巡检线程上调用，只能做无锁读取
+ */
+typedef size_t (*linx_deadline_context_cb_t)(void* user_data, char* buf, size_t size);
+
+/* 配置（字段为 0 时使用默认值） */
+typedef struct {
+    const char* name;               // 监测器名（复制，超长截断）
+    uint32_t period_us;             // 周期(微秒)，tick 未给出周期时使用（必填）
+    uint32_t slack_us;              // 允许超出周期的余量（默认周期的一半）
+    linx_deadline_context_cb_t context; // 现场中的上下文，可为 NULL
+    void* context_user_data;
+} linx_deadline_config_t;
+
+/* 超时现场 */
+typedef struct {
+    char name[LINX_DEADLINE_NAME_SIZE]; // 监测器名
+    uint64_t deadline_us;           // 本应开始下一周期的时刻（CLOCK_MONOTONIC 微秒）
+    uint32_t period_us;             // 超时的周期长度
+    uint32_t late_us;               // 超出周期的时长；stalled 时为报告时已超出的时长
+    uint32_t misses;                // 本报告包含的超时次数（上一次报告来不及送出时合并，stalled 时为 0）
+    bool stalled;                   // 报告时线程仍未进入下一周期
+    char activity[24];              // 工作阶段，未标注为空
+    char waiting[LINX_DEADLINE_NAME_SIZE]; // 正在等待的锁，没有为空
+    char locks[96];                 // 被持有的锁："名称@持有线程"，空格分隔
+    char context[96];               // 上下文回调的输出
+    size_t stack_depth;             // 栈采样的帧数，0 为没有采样
+    void* stack[LINX_DEADLINE_STACK_DEPTH]; // 返回地址，最内层在前
+} linx_deadline_snapshot_t;
+
+/* 统计（原子读取，各字段之间不保证一致） */
+typedef struct {
+    uint64_t periods;               // 周期数
+    uint64_t misses;                // 超时次数
+    uint64_t stalls;                // 提前报告的卡死次数
+    uint64_t total_late_us;         // 超出周期的总时长
+    uint32_t max_late_us;           // 最大超出时长
+} linx_deadline_stats_t;
+
+/**
+ * 监听者，在巡检线程上调用；snapshot 只在回调期间有效
+ * 回调中不能创建或销毁监测器、登记或移除监听者
+ */
+typedef void (*linx_deadline_listener_t)(void* user_data, const linx_deadline_snapshot_t* snapshot);
+
+/**
+ * 标注过的锁：持有和等待会出现在超时现场中
+ * 名称须是一直有效的字符串；静态锁第一次加锁时自动登记，动态创建的锁在释放前
+ * 调用 linx_deadline_lock_unregister()
+ */
+typedef struct {
+    const char* name;
+    uint32_t holder;                // 持有线程的名称编号，0 为未持有（原子读写）
+    bool registered;
+} linx_deadline_lock_t;
+
+#define LINX_DEADLINE_LOCK_INIT(lock_name) { (lock_name), 0, false }
+
+/**
+ * 创建监测器，刚创建时处于空闲状态
+ * @return 监测器；配置无效或监测器已满返回 NULL
+ */
+linx_deadline_t* linx_deadline_create(const linx_deadline_config_t* config);
+
+/**
+ * 销毁监测器（监测的线程已不再调用 tick），未送出的报告丢弃
+ * @note 不能在监听者回调中调用
+ */
+void linx_deadline_destroy(linx_deadline_t* deadline);
+
+/**
+ * 一个周期开始，在监测的线程上调用
+ * @param period_us 这个周期的长度，0 使用配置的周期（如按实际帧长变化的设备写入）
+ * @return 上一周期超出的时长(微秒)，按时返回 0
+ */
+uint32_t linx_deadline_tick(linx_deadline_t* deadline, uint32_t period_us);
+
+/**
+ * 进入空闲：暂停等待数据或线程退出前调用，任意线程可调用
+ */
+void linx_deadline_idle(linx_deadline_t* deadline);
+
+/**
+ * 标注当前线程的工作阶段（最近一次 tick 的监测器），当前线程没有监测器时无操作
+ * @param activity 一直有效的字符串（通常是字面量），NULL 清除
+ * @return 之前的阶段，用于恢复
+ */
+const char* linx_deadline_activity(const char* activity);
+
+/**
+ * 加锁并记录持有线程；等待期间锁名出现在当前线程现场的 waiting 中
+ */
+void linx_deadline_lock(linx_deadline_lock_t* lock, pthread_mutex_t* mutex);
+
+/**
+ * 清除持有线程并解锁
+ */
+void linx_deadline_unlock(linx_deadline_lock_t* lock, pthread_mutex_t* mutex);
+
+/**
+ * 移除动态创建的锁（之后不能再以它加锁）
+ */
+void linx_deadline_lock_unregister(linx_deadline_lock_t* lock);
+
+/**
+ * 获取统计
+ */
+bool linx_deadline_get_stats(const linx_deadline_t* deadline, linx_deadline_stats_t* stats);
+
+/**
+ * 登记监听者
+ * @return 已登记返回 true，监听者已满返回 false
+ */
+bool linx_deadline_add_listener(linx_deadline_listener_t listener, void* user_data);
+
+/**
+ * 移除监听者，返回后回调不再被调用（正在进行的回调已经返回）
+ */
+void linx_deadline_remove_listener(linx_deadline_listener_t listener, void* user_data);
+
+/**
+ * 把现场格式化为一行文本（栈为十六进制地址），返回写入的字节数（不含 '\0'）
+ */
+size_t linx_deadline_snapshot_format(const linx_deadline_snapshot_t* snapshot, char* buf, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINX_DEADLINE_H */
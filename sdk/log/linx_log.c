@@ -1,11 +1,121 @@
 #include "linx_log.h"
+#include "linx_alloc.h"
+#include "linx_thread_stats.h"
+#include "linx_deadline.h"
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <errno.h>
 #include <pthread.h>
+#include <sched.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_LOG);
 
 /* 全局日志上下文 */
 static log_context_t g_log_ctx = {0};
-static pthread_mutex_t g_log_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t g_log_mutex = PTHREAD_MUTEX_INITIALIZER;   /* 保护配置和输出 */
+
+/* 输出路径上 g_log_mutex 的持有标注：音频线程因同步输出或 flush 卡住时出现在超时现场中 */
+static linx_deadline_lock_t g_log_lock = LINX_DEADLINE_LOCK_INIT("log");
+
+/* 全局级别阈值，宏中无锁读取；未初始化时关闭全部日志 */
+int log_level_threshold = LOG_LEVEL_MAX;
+
+/* 日志转发，由 g_log_mutex 保护 */
+static log_forward_cb_t g_log_forward_cb = NULL;
+static void *g_log_forward_user_data = NULL;
+static log_level_t g_log_forward_level = LOG_LEVEL_DEBUG;
+
+/* 当前线程是否在转发回调中，回调里的日志直接丢弃以免重入 */
+static __thread bool g_log_in_forwarder = false;
+
+/* 单独设置了级别的模块 */
+typedef struct {
+    char name[LOG_TAG_NAME_SIZE];
+    int level;
+} log_tag_override_t;
+
+/* 模块注册表：只在模块首次输出日志和修改模块级别时加锁 */
+static pthread_mutex_t g_log_tag_mutex = PTHREAD_MUTEX_INITIALIZER;
+static log_tag_t *g_log_tags = NULL;
+static log_tag_override_t g_log_tag_overrides[LOG_MAX_TAG_OVERRIDES];
+static size_t g_log_tag_override_count = 0;
+
+/* 异步模式下后台线程无日志时的最长等待时间(毫秒) */
+#define LOG_ASYNC_IDLE_WAIT_MS 100
+
+/* 异步队列中的一条日志：调用线程只格式化消息正文，其余在后台线程完成 */
+typedef struct {
+    size_t sequence;                /* 槽位序号：等于写入位置+1 表示可读，等于读取位置+容量表示可写 */
+    log_level_t level;
+    time_t timestamp;
+    const char *file;               /* __FILE__ / __func__ 为静态字符串，直接保存指针 */
+    const char *func;
+    int line;
+    const char *format;             /* 二进制记录的格式串，NULL 表示 message 为已格式化文本 */
+    size_t args_len;                /* 二进制记录时 message 中编码参数的长度 */
+    char message[LOG_ASYNC_MESSAGE_SIZE];
+} log_record_t;
+
+/* 有界多生产者单消费者无锁队列（按槽位序号同步，生产者只做一次 CAS） */
+typedef struct {
+    log_record_t *slots;
+    size_t mask;                    /* 容量-1，容量为2的幂 */
+    size_t enqueue_pos;             /* 生产者 CAS 推进 */
+    size_t dequeue_pos;             /* 仅在持有 g_log_mutex 时推进 */
+    unsigned long long dropped;     /* 队列满时丢弃的条数 */
+    unsigned long long reported;    /* 已输出过提示的丢弃条数 */
+
+    pthread_t thread;
+    bool running;
+    bool sleeping;                  /* 后台线程正在等待，入队后需要唤醒 */
+    pthread_mutex_t wait_mutex;
+    pthread_cond_t wait_cond;
+} log_async_t;
+
+static log_async_t g_log_async = {0};
+static bool g_log_async_enabled = false;   /* 新日志是否进入异步队列 */
+static int g_log_async_writers = 0;        /* 正在写入队列的调用线程数，清理时等待归零 */
+
+/* 二进制日志参数类型 */
+typedef enum {
+    LOG_ARG_NONE = 0,               /* %% 不消耗参数 */
+    LOG_ARG_INT,                    /* 有符号整数，按64位保存 */
+    LOG_ARG_UINT,                   /* 无符号整数，按64位保存 */
+    LOG_ARG_DOUBLE,                 /* 浮点数，long double 按 double 保存 */
+    LOG_ARG_POINTER,
+    LOG_ARG_STRING,                 /* 复制字符串内容，以 '\0' 结尾 */
+    LOG_ARG_INVALID                 /* %n、宽字符等不支持的转换 */
+} log_arg_kind_t;
+
+/* 格式串中的一个转换说明 */
+typedef struct {
+    size_t length;                  /* 整个转换说明的长度 */
+    size_t prefix_length;           /* '%'、标志、宽度和精度部分的长度 */
+    bool width_star;                /* 宽度从参数读取 */
+    bool precision_star;            /* 精度从参数读取 */
+    int precision;                  /* 格式串中写明的精度，-1 表示未指定 */
+    char modifier;                  /* 长度修饰：'H'=hh 'h' 'l' 'q'=ll 'j' 'z' 't' 'L'，0 表示无 */
+    char conversion;
+    log_arg_kind_t kind;
+} log_spec_t;
+
+/* 二进制日志文件中的条目类型 */
+#define LOG_BINARY_ENTRY_STRING 'S'     /* 字符串定义：id(4) 长度(2) 内容 */
+#define LOG_BINARY_ENTRY_RECORD 'R'     /* 日志：级别(1) 时间(8) 文件(4) 函数(4) 格式(4) 行号(4) 参数长度(2) 参数 */
+#define LOG_BINARY_RECORD_HEADER_SIZE 28
+
+/* 二进制日志文件：静态字符串首次出现时写入定义，之后记录只引用编号 */
+typedef struct {
+    FILE *fp;
+    const char **strings;           /* 按指针开放寻址的已定义字符串 */
+    uint32_t *ids;
+    size_t capacity;                /* 2的幂 */
+    uint32_t count;
+} log_binary_file_t;
+
+static log_binary_file_t g_log_bin = {0};
 
 /* 日志级别字符串 */
 const char* log_level_strings[LOG_LEVEL_MAX] = {
@@ -25,17 +135,39 @@ const char* log_level_colors[LOG_LEVEL_MAX] = {
 #define COLOR_RESET "\033[0m"
 
 /* 内部函数声明 */
-static void log_format_timestamp(char *buffer, size_t size);
+static void log_format_timestamp(time_t now, char *buffer, size_t size);
+static void log_format_line(char *buffer, size_t size, bool with_timestamp, log_level_t level,
+                            time_t now, const char *file, int line, const char *func,
+                            const char *message);
+static void log_output_locked(log_level_t level, time_t now, const char *file, int line,
+                              const char *func, const char *message);
+static void log_dispatch(log_level_t level, const char *file, int line, const char *func,
+                         bool binary, const char *format, va_list args);
+static uint64_t log_bin_get(const uint8_t *buf, size_t bytes);
+static int log_bin_encode(uint8_t *buf, size_t size, const char *format, va_list args);
+static void log_bin_format(char *out, size_t size, const char *format,
+                           const uint8_t *args, size_t args_len);
+static bool log_bin_open(const char *path);
+static void log_bin_close(void);
+static void log_bin_output_locked(log_level_t level, time_t now, const char *file, int line,
+                                  const char *func, const char *format,
+                                  const uint8_t *args, size_t args_len);
+static bool log_async_start(size_t queue_size);
+static void log_async_stop(void);
+static bool log_async_write(log_level_t level, const char *file, int line, const char *func,
+                            bool binary, const char *format, va_list args);
+static size_t log_async_drain_locked(void);
+static void *log_async_thread(void *arg);
 
 int log_init(const log_config_t *config)
 {
-    pthread_mutex_lock(&g_log_mutex);
-    
-    /* 如果已经初始化，先清理 */
+    /* 如果已经初始化，先清理（清理需要等待后台线程退出，不能持有锁） */
     if (g_log_ctx.initialized) {
         log_cleanup();
     }
-    
+
+    pthread_mutex_lock(&g_log_mutex);
+
     /* 使用默认配置或用户配置 */
     if (config) {
         g_log_ctx.config = *config;
@@ -43,19 +175,38 @@ int log_init(const log_config_t *config)
         log_config_t default_config = LOG_DEFAULT_CONFIG;
         g_log_ctx.config = default_config;
     }
-    
+
+    /* 二进制日志文件打不开时 LOG_BIN_* 按普通日志输出 */
+    if (g_log_ctx.config.binary_file && !log_bin_open(g_log_ctx.config.binary_file)) {
+        fprintf(stderr, "[WARN] 无法打开二进制日志文件 %s，使用文本输出\n", g_log_ctx.config.binary_file);
+    }
+    g_log_ctx.config.binary_file = NULL;    /* 不保留调用方的字符串 */
+
     g_log_ctx.initialized = true;
+    __atomic_store_n(&log_level_threshold, (int)g_log_ctx.config.level, __ATOMIC_RELEASE);
     pthread_mutex_unlock(&g_log_mutex);
-    
+
+    /* 异步模式启动失败时保持同步输出 */
+    if (g_log_ctx.config.async && !log_async_start(g_log_ctx.config.async_queue_size)) {
+        pthread_mutex_lock(&g_log_mutex);
+        g_log_ctx.config.async = false;
+        pthread_mutex_unlock(&g_log_mutex);
+        fprintf(stderr, "[WARN] 异步日志初始化失败，使用同步输出\n");
+    }
+
     return 0;
 }
 
 void log_cleanup(void)
 {
+    __atomic_store_n(&log_level_threshold, LOG_LEVEL_MAX, __ATOMIC_RELEASE);
+    log_async_stop();
+
     pthread_mutex_lock(&g_log_mutex);
-    
+
     g_log_ctx.initialized = false;
-    
+    log_bin_close();
+
     pthread_mutex_unlock(&g_log_mutex);
 }
 
@@ -64,6 +215,9 @@ void log_set_level(log_level_t level)
     if (level >= LOG_LEVEL_DEBUG && level < LOG_LEVEL_MAX) {
         pthread_mutex_lock(&g_log_mutex);
         g_log_ctx.config.level = level;
+        if (g_log_ctx.initialized) {
+            __atomic_store_n(&log_level_threshold, (int)level, __ATOMIC_RELEASE);
+        }
         pthread_mutex_unlock(&g_log_mutex);
     }
 }
@@ -78,75 +232,1085 @@ log_level_t log_get_level(void)
 
 bool log_is_level_enabled(log_level_t level)
 {
-    return (g_log_ctx.initialized && level >= g_log_ctx.config.level);
+    return log_level_passes(level);
+}
+
+bool log_rate_limit_pass(uint64_t *next_ms, uint32_t interval_ms)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t now = (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+
+    uint64_t next = __atomic_load_n(next_ms, __ATOMIC_RELAXED);
+    return now >= next &&
+           __atomic_compare_exchange_n(next_ms, &next, now + interval_ms, false,
+                                       __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+
+/* 查找模块的单独级别，调用方持有 g_log_tag_mutex */
+static log_tag_override_t *log_tag_find_override_locked(const char *name)
+{
+    for (size_t i = 0; i < g_log_tag_override_count; i++) {
+        if (strcmp(g_log_tag_overrides[i].name, name) == 0) {
+            return &g_log_tag_overrides[i];
+        }
+    }
+    return NULL;
+}
+
+/* 更新所有同名模块缓存的级别，调用方持有 g_log_tag_mutex */
+static void log_tag_apply_locked(const char *name, int level)
+{
+    for (log_tag_t *tag = g_log_tags; tag; tag = tag->next) {
+        if (strcmp(tag->name, name) == 0) {
+            __atomic_store_n(&tag->level, level, __ATOMIC_RELEASE);
+        }
+    }
+}
+
+int log_set_tag_level(const char *tag, log_level_t level)
+{
+    if (!tag || strlen(tag) >= LOG_TAG_NAME_SIZE || level < LOG_LEVEL_DEBUG || level >= LOG_LEVEL_MAX) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&g_log_tag_mutex);
+
+    log_tag_override_t *entry = log_tag_find_override_locked(tag);
+    if (!entry) {
+        if (g_log_tag_override_count >= LOG_MAX_TAG_OVERRIDES) {
+            pthread_mutex_unlock(&g_log_tag_mutex);
+            return -1;
+        }
+        entry = &g_log_tag_overrides[g_log_tag_override_count++];
+        strcpy(entry->name, tag);
+    }
+    entry->level = (int)level;
+    log_tag_apply_locked(tag, (int)level);
+
+    pthread_mutex_unlock(&g_log_tag_mutex);
+    return 0;
+}
+
+void log_reset_tag_level(const char *tag)
+{
+    if (!tag) {
+        return;
+    }
+
+    pthread_mutex_lock(&g_log_tag_mutex);
+
+    log_tag_override_t *entry = log_tag_find_override_locked(tag);
+    if (entry) {
+        *entry = g_log_tag_overrides[--g_log_tag_override_count];
+        log_tag_apply_locked(tag, LOG_TAG_LEVEL_GLOBAL);
+    }
+
+    pthread_mutex_unlock(&g_log_tag_mutex);
+}
+
+int log_tag_resolve(log_tag_t *tag)
+{
+    pthread_mutex_lock(&g_log_tag_mutex);
+
+    /* 其他线程可能已经解析过 */
+    int level = __atomic_load_n(&tag->level, __ATOMIC_ACQUIRE);
+    if (level == LOG_TAG_LEVEL_UNRESOLVED) {
+        log_tag_override_t *entry = log_tag_find_override_locked(tag->name);
+        level = entry ? entry->level : LOG_TAG_LEVEL_GLOBAL;
+        tag->next = g_log_tags;
+        g_log_tags = tag;
+        __atomic_store_n(&tag->level, level, __ATOMIC_RELEASE);
+    }
+
+    pthread_mutex_unlock(&g_log_tag_mutex);
+    return level;
 }
 
-void log_write(log_level_t level, const char *file, int line, 
+void log_write(log_level_t level, const char *file, int line,
                const char *func, const char *format, ...)
 {
-    if (!g_log_ctx.initialized || level < g_log_ctx.config.level) {
+    if (!g_log_ctx.initialized || !log_level_passes(level)) {
         return;
     }
-    
-    pthread_mutex_lock(&g_log_mutex);
-    
-    char timestamp[64] = {0};
-    char message[1024] = {0};
-    char log_line[1536] = {0};
-    
-    /* 格式化时间戳 */
-    if (g_log_ctx.config.enable_timestamp) {
-        log_format_timestamp(timestamp, sizeof(timestamp));
+
+    va_list args;
+    va_start(args, format);
+    log_dispatch(level, file, line, func, false, format, args);
+    va_end(args);
+}
+
+void log_write_tag(log_tag_t *tag, log_level_t level, const char *file, int line,
+                   const char *func, const char *format, ...)
+{
+    if (!g_log_ctx.initialized || !log_tag_is_enabled(tag, level)) {
+        return;
     }
-    
-    /* 格式化用户消息 */
+
+    va_list args;
+    va_start(args, format);
+    log_dispatch(level, file, line, func, false, format, args);
+    va_end(args);
+}
+
+void log_write_binary(log_level_t level, const char *file, int line,
+                      const char *func, const char *format, ...)
+{
+    if (!g_log_ctx.initialized || !log_level_passes(level)) {
+        return;
+    }
+
     va_list args;
     va_start(args, format);
-    vsnprintf(message, sizeof(message), format, args);
+    log_dispatch(level, file, line, func, true, format, args);
     va_end(args);
-    
-    /* 构建完整的日志行 */
+}
+
+void log_flush(void)
+{
+    linx_deadline_lock(&g_log_lock, &g_log_mutex);
+
+    if (__atomic_load_n(&g_log_async_enabled, __ATOMIC_ACQUIRE)) {
+        log_async_drain_locked();
+    }
+    if (g_log_bin.fp) {
+        fflush(g_log_bin.fp);
+    }
+    fflush(stderr);
+    fflush(stdout);
+
+    linx_deadline_unlock(&g_log_lock, &g_log_mutex);
+}
+
+void log_set_forwarder(log_forward_cb_t callback, void *user_data, log_level_t min_level)
+{
+    pthread_mutex_lock(&g_log_mutex);
+    g_log_forward_cb = callback;
+    g_log_forward_user_data = user_data;
+    g_log_forward_level = min_level;
+    pthread_mutex_unlock(&g_log_mutex);
+}
+
+unsigned long long log_get_dropped_count(void)
+{
+    return __atomic_load_n(&g_log_async.dropped, __ATOMIC_RELAXED);
+}
+
+int log_binary_decode(FILE *in, FILE *out)
+{
+    char magic[8];
+    if (!in || !out || fread(magic, 1, sizeof(magic), in) != sizeof(magic) ||
+        memcmp(magic, LOG_BINARY_MAGIC, sizeof(magic)) != 0) {
+        return -1;
+    }
+
+    char **strings = NULL;
+    size_t count = 0;
+    size_t capacity = 0;
+    int records = 0;
+    int type;
+
+    /* 文件末尾不完整的条目直接结束解码 */
+    while (records >= 0 && (type = fgetc(in)) != EOF) {
+        if (type == LOG_BINARY_ENTRY_STRING) {
+            uint8_t header[6];
+            if (fread(header, 1, sizeof(header), in) != sizeof(header)) {
+                break;
+            }
+            size_t len = (size_t)log_bin_get(header + 4, 2);
+            if (log_bin_get(header, 4) != count) {
+                records = -1;
+                break;
+            }
+            if (count == capacity) {
+                size_t new_capacity = capacity ? capacity * 2 : 64;
+                char **grown = (char **)LINX_REALLOC(strings, new_capacity * sizeof(*strings));
+                if (!grown) {
+                    records = -1;
+                    break;
+                }
+                strings = grown;
+                capacity = new_capacity;
+            }
+            char *str = (char *)LINX_MALLOC(len + 1);
+            if (!str) {
+                records = -1;
+                break;
+            }
+            if (fread(str, 1, len, in) != len) {
+                LINX_FREE(str);
+                break;
+            }
+            str[len] = '\0';
+            strings[count++] = str;
+        } else if (type == LOG_BINARY_ENTRY_RECORD) {
+            uint8_t header[LOG_BINARY_RECORD_HEADER_SIZE - 1];
+            uint8_t args[LOG_ASYNC_MESSAGE_SIZE];
+            if (fread(header, 1, sizeof(header), in) != sizeof(header)) {
+                break;
+            }
+            log_level_t level = (log_level_t)header[0];
+            time_t timestamp = (time_t)(int64_t)log_bin_get(header + 1, 8);
+            uint64_t file_id = log_bin_get(header + 9, 4);
+            uint64_t func_id = log_bin_get(header + 13, 4);
+            uint64_t format_id = log_bin_get(header + 17, 4);
+            int line = (int)(int32_t)log_bin_get(header + 21, 4);
+            size_t args_len = (size_t)log_bin_get(header + 25, 2);
+            if (level >= LOG_LEVEL_MAX || file_id >= count || func_id >= count ||
+                format_id >= count || args_len > sizeof(args)) {
+                records = -1;
+                break;
+            }
+            if (fread(args, 1, args_len, in) != args_len) {
+                break;
+            }
+
+            char message[1024];
+            char log_line[1536];
+            log_bin_format(message, sizeof(message), strings[format_id], args, args_len);
+            log_format_line(log_line, sizeof(log_line), true, level, timestamp,
+                            strings[file_id], line, strings[func_id], message);
+            fputs(log_line, out);
+            records++;
+        } else {
+            records = -1;
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        LINX_FREE(strings[i]);
+    }
+    LINX_FREE(strings);
+    return records;
+}
+
+/* 内部函数实现 */
+
+static void log_format_timestamp(time_t now, char *buffer, size_t size)
+{
+    struct tm tm_info;
+
+    localtime_r(&now, &tm_info);
+
+    strftime(buffer, size, "%Y-%m-%d %H:%M:%S", &tm_info);
+}
+
+/* 拼装一行日志（含换行） */
+static void log_format_line(char *buffer, size_t size, bool with_timestamp, log_level_t level,
+                            time_t now, const char *file, int line, const char *func,
+                            const char *message)
+{
     const char *basename = strrchr(file, '/');
     basename = basename ? basename + 1 : file;
-    
-    if (g_log_ctx.config.enable_timestamp) {
-        snprintf(log_line, sizeof(log_line), "[%s] [%s] %s:%d %s() - %s\n",
+
+    if (with_timestamp) {
+        char timestamp[64] = {0};
+        log_format_timestamp(now, timestamp, sizeof(timestamp));
+        snprintf(buffer, size, "[%s] [%s] %s:%d %s() - %s\n",
                 timestamp, log_level_strings[level], basename, line, func, message);
     } else {
-        snprintf(log_line, sizeof(log_line), "[%s] %s:%d %s() - %s\n",
+        snprintf(buffer, size, "[%s] %s:%d %s() - %s\n",
                 log_level_strings[level], basename, line, func, message);
     }
-    
+}
+
+/* 拼装并输出一行日志，调用方持有 g_log_mutex */
+static void log_output_locked(log_level_t level, time_t now, const char *file, int line,
+                              const char *func, const char *message)
+{
+    char log_line[1536] = {0};
+
+    log_format_line(log_line, sizeof(log_line), g_log_ctx.config.enable_timestamp,
+                    level, now, file, line, func, message);
+
     /* 输出到控制台 */
     if (g_log_ctx.config.enable_color) {
         fprintf(stderr, "%s%s%s", log_level_colors[level], log_line, COLOR_RESET);
     } else {
         fprintf(stderr, "%s", log_line);
     }
-    fflush(stderr);
-    
-    pthread_mutex_unlock(&g_log_mutex);
+
+    if (g_log_forward_cb && level >= g_log_forward_level) {
+        g_log_in_forwarder = true;
+        g_log_forward_cb(g_log_forward_user_data, level, log_line, strlen(log_line));
+        g_log_in_forwarder = false;
+    }
 }
 
-void log_flush(void)
+/* 同步输出或写入异步队列 */
+static void log_dispatch(log_level_t level, const char *file, int line, const char *func,
+                         bool binary, const char *format, va_list args)
 {
-    pthread_mutex_lock(&g_log_mutex);
-    
+    va_list copy;
+
+    if (g_log_in_forwarder) {
+        return;
+    }
+
+    /* 异步模式：入队后立即返回，FATAL 走下面的同步路径 */
+    if (level < LOG_LEVEL_FATAL) {
+        va_copy(copy, args);
+        bool queued = log_async_write(level, file, line, func, binary, format, copy);
+        va_end(copy);
+        if (queued) {
+            return;
+        }
+    }
+
+    char message[1024] = {0};
+    uint8_t encoded[LOG_ASYNC_MESSAGE_SIZE];
+    int encoded_len = -1;
+    time_t now = time(NULL);
+
+    /* 有二进制日志文件时只编码参数，否则格式化用户消息 */
+    if (binary && g_log_bin.fp) {
+        va_copy(copy, args);
+        encoded_len = log_bin_encode(encoded, sizeof(encoded), format, copy);
+        va_end(copy);
+    }
+    if (encoded_len < 0) {
+        vsnprintf(message, sizeof(message), format, args);
+    }
+
+    linx_deadline_lock(&g_log_lock, &g_log_mutex);
+
+    /* 先写出队列中更早的日志，保证顺序且在进程退出前全部落地 */
+    if (__atomic_load_n(&g_log_async_enabled, __ATOMIC_ACQUIRE)) {
+        log_async_drain_locked();
+    }
+
+    if (encoded_len >= 0) {
+        log_bin_output_locked(level, now, file, line, func, format, encoded, (size_t)encoded_len);
+        if (g_log_bin.fp) {
+            fflush(g_log_bin.fp);
+        }
+    } else {
+        log_output_locked(level, now, file, line, func, message);
+    }
     fflush(stderr);
-    fflush(stdout);
-    
-    pthread_mutex_unlock(&g_log_mutex);
+
+    linx_deadline_unlock(&g_log_lock, &g_log_mutex);
 }
 
-/* 内部函数实现 */
+/* 解析 p（指向 '%'）处的转换说明 */
+static void log_spec_parse(const char *p, log_spec_t *spec)
+{
+    const char *s = p + 1;
+
+    memset(spec, 0, sizeof(*spec));
+    spec->precision = -1;
+
+    if (*s == '%') {
+        spec->length = 2;
+        spec->kind = LOG_ARG_NONE;
+        return;
+    }
+
+    while (*s && strchr("-+ #0'", *s)) {
+        s++;
+    }
+    if (*s == '*') {
+        spec->width_star = true;
+        s++;
+    } else {
+        while (*s >= '0' && *s <= '9') {
+            s++;
+        }
+    }
+    if (*s == '.') {
+        s++;
+        if (*s == '*') {
+            spec->precision_star = true;
+            s++;
+        } else {
+            spec->precision = 0;
+            while (*s >= '0' && *s <= '9') {
+                spec->precision = spec->precision * 10 + (*s - '0');
+                s++;
+            }
+        }
+    }
+    spec->prefix_length = (size_t)(s - p);
+
+    switch (*s) {
+    case 'h':
+        s++;
+        spec->modifier = (*s == 'h') ? (s++, 'H') : 'h';
+        break;
+    case 'l':
+        s++;
+        spec->modifier = (*s == 'l') ? (s++, 'q') : 'l';
+        break;
+    case 'j': case 'z': case 't': case 'L':
+        spec->modifier = *s++;
+        break;
+    default:
+        break;
+    }
+
+    spec->conversion = *s;
+    if (*s) {
+        s++;
+    }
+    spec->length = (size_t)(s - p);
+
+    switch (spec->conversion) {
+    case 'd': case 'i':
+        spec->kind = spec->modifier == 'L' ? LOG_ARG_INVALID : LOG_ARG_INT;
+        break;
+    case 'u': case 'o': case 'x': case 'X':
+        spec->kind = spec->modifier == 'L' ? LOG_ARG_INVALID : LOG_ARG_UINT;
+        break;
+    case 'c':
+        spec->kind = spec->modifier == 0 ? LOG_ARG_INT : LOG_ARG_INVALID;
+        break;
+    case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+        spec->kind = (spec->modifier == 0 || spec->modifier == 'l' || spec->modifier == 'L')
+                     ? LOG_ARG_DOUBLE : LOG_ARG_INVALID;
+        break;
+    case 's':
+        spec->kind = spec->modifier == 0 ? LOG_ARG_STRING : LOG_ARG_INVALID;
+        break;
+    case 'p':
+        spec->kind = spec->modifier == 0 ? LOG_ARG_POINTER : LOG_ARG_INVALID;
+        break;
+    default:
+        spec->kind = LOG_ARG_INVALID;
+        break;
+    }
+}
+
+/* 小端写入/读取，二进制日志文件与主机字节序无关 */
+static void log_bin_put(uint8_t *buf, uint64_t value, size_t bytes)
+{
+    for (size_t i = 0; i < bytes; i++) {
+        buf[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static uint64_t log_bin_get(const uint8_t *buf, size_t bytes)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; i++) {
+        value |= (uint64_t)buf[i] << (8 * i);
+    }
+    return value;
+}
+
+/* 按格式串把参数编码进 buf，不做格式化；返回编码长度，遇到不支持的转换或空间不足返回 -1 */
+static int log_bin_encode(uint8_t *buf, size_t size, const char *format, va_list args)
+{
+    size_t pos = 0;
+
+    for (const char *p = strchr(format, '%'); p; p = strchr(p, '%')) {
+        log_spec_t spec;
+        log_spec_parse(p, &spec);
+        p += spec.length;
+
+        if (spec.kind == LOG_ARG_NONE) {
+            continue;
+        }
+        if (spec.kind == LOG_ARG_INVALID) {
+            return -1;
+        }
+
+        /* '*' 宽度和精度各占一个参数 */
+        int precision = spec.precision;
+        if (spec.width_star) {
+            if (size - pos < 8) {
+                return -1;
+            }
+            log_bin_put(buf + pos, (uint64_t)(int64_t)va_arg(args, int), 8);
+            pos += 8;
+        }
+        if (spec.precision_star) {
+            if (size - pos < 8) {
+                return -1;
+            }
+            precision = va_arg(args, int);
+            log_bin_put(buf + pos, (uint64_t)(int64_t)precision, 8);
+            pos += 8;
+        }
+
+        if (spec.kind == LOG_ARG_STRING) {
+            const char *str = va_arg(args, const char *);
+            if (!str) {
+                str = "(null)";
+            }
+            /* 带精度的 %s 可能指向不以 '\0' 结尾的缓冲区 */
+            size_t len = precision >= 0 ? strnlen(str, (size_t)precision) : strlen(str);
+            if (size - pos < 1) {
+                return -1;
+            }
+            if (len > size - pos - 1) {
+                len = size - pos - 1;
+            }
+            memcpy(buf + pos, str, len);
+            buf[pos + len] = '\0';
+            pos += len + 1;
+            continue;
+        }
+
+        uint64_t value = 0;
+        switch (spec.kind) {
+        case LOG_ARG_INT:
+            switch (spec.modifier) {
+            case 'l': value = (uint64_t)(int64_t)va_arg(args, long); break;
+            case 'q': value = (uint64_t)(int64_t)va_arg(args, long long); break;
+            case 'j': value = (uint64_t)(int64_t)va_arg(args, intmax_t); break;
+            case 'z': value = (uint64_t)(int64_t)(ptrdiff_t)va_arg(args, size_t); break;
+            case 't': value = (uint64_t)(int64_t)va_arg(args, ptrdiff_t); break;
+            default: value = (uint64_t)(int64_t)va_arg(args, int); break;    /* hh/h 已提升为 int */
+            }
+            break;
+        case LOG_ARG_UINT:
+            switch (spec.modifier) {
+            case 'l': value = va_arg(args, unsigned long); break;
+            case 'q': value = va_arg(args, unsigned long long); break;
+            case 'j': value = va_arg(args, uintmax_t); break;
+            case 'z': value = va_arg(args, size_t); break;
+            case 't': value = (uint64_t)va_arg(args, ptrdiff_t); break;
+            default: value = va_arg(args, unsigned int); break;
+            }
+            break;
+        case LOG_ARG_DOUBLE: {
+            double d = spec.modifier == 'L' ? (double)va_arg(args, long double) : va_arg(args, double);
+            memcpy(&value, &d, sizeof(value));
+            break;
+        }
+        case LOG_ARG_POINTER:
+            value = (uint64_t)(uintptr_t)va_arg(args, void *);
+            break;
+        default:
+            break;
+        }
+
+        if (size - pos < 8) {
+            return -1;
+        }
+        log_bin_put(buf + pos, value, 8);
+        pos += 8;
+    }
+
+    return (int)pos;
+}
+
+/* 追加文本到 out，超出部分截断 */
+static void log_bin_append(char *out, size_t size, size_t *pos, const char *text, size_t len)
+{
+    if (*pos + 1 >= size) {
+        return;
+    }
+    if (len > size - *pos - 1) {
+        len = size - *pos - 1;
+    }
+    memcpy(out + *pos, text, len);
+    *pos += len;
+    out[*pos] = '\0';
+}
+
+/* 按格式串和编码后的参数生成消息文本；参数不足或损坏时其余部分原样输出 */
+static void log_bin_format(char *out, size_t size, const char *format,
+                           const uint8_t *args, size_t args_len)
+{
+    size_t pos = 0;
+    size_t arg = 0;
+    const char *p = format;
+
+    if (size == 0) {
+        return;
+    }
+    out[0] = '\0';
+
+    while (*p) {
+        const char *percent = strchr(p, '%');
+        if (!percent) {
+            log_bin_append(out, size, &pos, p, strlen(p));
+            break;
+        }
+        log_bin_append(out, size, &pos, p, (size_t)(percent - p));
+
+        log_spec_t spec;
+        log_spec_parse(percent, &spec);
+        p = percent + spec.length;
+
+        if (spec.kind == LOG_ARG_NONE) {
+            log_bin_append(out, size, &pos, "%", 1);
+            continue;
+        }
+
+        /* 重建单个转换说明：'*' 换成记录的数值，整数统一按 64 位输出 */
+        char conversion[64];
+        size_t n = 0;
+        size_t dot = 0;
+        bool ok = spec.kind != LOG_ARG_INVALID && spec.prefix_length + 24 < sizeof(conversion);
+        for (size_t i = 0; ok && i < spec.prefix_length; i++) {
+            char c = percent[i];
+            if (c == '.') {
+                dot = n;
+            }
+            if (c != '*') {
+                conversion[n++] = c;
+                continue;
+            }
+            if (args_len - arg < 8) {
+                ok = false;
+                break;
+            }
+            int64_t star = (int64_t)log_bin_get(args + arg, 8);
+            arg += 8;
+            if (dot && star < 0) {
+                n = dot;    /* 负的精度等同于未指定 */
+            } else {
+                n += (size_t)snprintf(conversion + n, sizeof(conversion) - n, "%d", (int)star);
+            }
+        }
+
+        uint64_t value = 0;
+        const char *str = NULL;
+        if (ok && spec.kind == LOG_ARG_STRING) {
+            const uint8_t *end = memchr(args + arg, '\0', args_len - arg);
+            if (end) {
+                str = (const char *)(args + arg);
+                arg = (size_t)(end - args) + 1;
+            } else {
+                ok = false;
+            }
+        } else if (ok) {
+            if (args_len - arg < 8) {
+                ok = false;
+            } else {
+                value = log_bin_get(args + arg, 8);
+                arg += 8;
+            }
+        }
+
+        if (!ok) {
+            log_bin_append(out, size, &pos, percent, strlen(percent));
+            break;
+        }
+
+        if (spec.kind == LOG_ARG_INT || spec.kind == LOG_ARG_UINT) {
+            if (spec.conversion != 'c') {
+                conversion[n++] = 'l';
+                conversion[n++] = 'l';
+            }
+        }
+        conversion[n++] = spec.conversion;
+        conversion[n] = '\0';
+
+        int written = 0;
+        char *dst = out + pos;
+        size_t avail = size - pos;
+        switch (spec.kind) {
+        case LOG_ARG_INT: {
+            long long v = (long long)(int64_t)value;
+            if (spec.modifier == 'H') {
+                v = (signed char)v;
+            } else if (spec.modifier == 'h') {
+                v = (short)v;
+            }
+            written = spec.conversion == 'c' ? snprintf(dst, avail, conversion, (int)v)
+                                             : snprintf(dst, avail, conversion, v);
+            break;
+        }
+        case LOG_ARG_UINT: {
+            unsigned long long v = value;
+            if (spec.modifier == 'H') {
+                v = (unsigned char)v;
+            } else if (spec.modifier == 'h') {
+                v = (unsigned short)v;
+            } else if (spec.modifier == 0) {
+                v = (unsigned int)v;
+            }
+            written = snprintf(dst, avail, conversion, v);
+            break;
+        }
+        case LOG_ARG_DOUBLE: {
+            double d;
+            memcpy(&d, &value, sizeof(d));
+            written = snprintf(dst, avail, conversion, d);
+            break;
+        }
+        case LOG_ARG_POINTER:
+            written = snprintf(dst, avail, conversion, (void *)(uintptr_t)value);
+            break;
+        case LOG_ARG_STRING:
+            written = snprintf(dst, avail, conversion, str);
+            break;
+        default:
+            break;
+        }
+
+        if (written > 0) {
+            pos += (size_t)written < avail ? (size_t)written : avail - 1;
+        }
+        if (pos + 1 >= size) {
+            break;
+        }
+    }
+}
 
-static void log_format_timestamp(char *buffer, size_t size)
+static bool log_bin_open(const char *path)
 {
-    time_t now;
-    struct tm *tm_info;
-    
-    time(&now);
-    tm_info = localtime(&now);
-    
-    strftime(buffer, size, "%Y-%m-%d %H:%M:%S", tm_info);
-}
\ No newline at end of file
+    FILE *fp = fopen(path, "wb");
+    if (!fp) {
+        return false;
+    }
+    if (fwrite(LOG_BINARY_MAGIC, 1, 8, fp) != 8) {
+        fclose(fp);
+        return false;
+    }
+
+    g_log_bin.fp = fp;
+    g_log_bin.strings = NULL;
+    g_log_bin.ids = NULL;
+    g_log_bin.capacity = 0;
+    g_log_bin.count = 0;
+    return true;
+}
+
+static void log_bin_close(void)
+{
+    if (g_log_bin.fp) {
+        fclose(g_log_bin.fp);
+    }
+    LINX_FREE(g_log_bin.strings);
+    LINX_FREE(g_log_bin.ids);
+    memset(&g_log_bin, 0, sizeof(g_log_bin));
+}
+
+/* 扩大字符串表并重新散列 */
+static bool log_bin_grow_locked(void)
+{
+    size_t capacity = g_log_bin.capacity ? g_log_bin.capacity * 2 : 64;
+    const char **strings = (const char **)LINX_CALLOC(capacity, sizeof(*strings));
+    uint32_t *ids = (uint32_t *)LINX_CALLOC(capacity, sizeof(*ids));
+    if (!strings || !ids) {
+        LINX_FREE(strings);
+        LINX_FREE(ids);
+        return false;
+    }
+
+    for (size_t i = 0; i < g_log_bin.capacity; i++) {
+        if (!g_log_bin.strings[i]) {
+            continue;
+        }
+        size_t h = ((uintptr_t)g_log_bin.strings[i] * 2654435761u) & (capacity - 1);
+        while (strings[h]) {
+            h = (h + 1) & (capacity - 1);
+        }
+        strings[h] = g_log_bin.strings[i];
+        ids[h] = g_log_bin.ids[i];
+    }
+
+    LINX_FREE(g_log_bin.strings);
+    LINX_FREE(g_log_bin.ids);
+    g_log_bin.strings = strings;
+    g_log_bin.ids = ids;
+    g_log_bin.capacity = capacity;
+    return true;
+}
+
+/* 查找静态字符串的编号，首次出现时写入定义 */
+static bool log_bin_string_id_locked(const char *str, uint32_t *id)
+{
+    if ((size_t)g_log_bin.count * 2 >= g_log_bin.capacity && !log_bin_grow_locked()) {
+        return false;
+    }
+
+    size_t mask = g_log_bin.capacity - 1;
+    size_t h = ((uintptr_t)str * 2654435761u) & mask;
+    while (g_log_bin.strings[h]) {
+        if (g_log_bin.strings[h] == str) {
+            *id = g_log_bin.ids[h];
+            return true;
+        }
+        h = (h + 1) & mask;
+    }
+
+    size_t len = strlen(str);
+    if (len > UINT16_MAX) {
+        len = UINT16_MAX;
+    }
+    uint8_t header[7];
+    header[0] = LOG_BINARY_ENTRY_STRING;
+    log_bin_put(header + 1, g_log_bin.count, 4);
+    log_bin_put(header + 5, len, 2);
+    if (fwrite(header, 1, sizeof(header), g_log_bin.fp) != sizeof(header) ||
+        fwrite(str, 1, len, g_log_bin.fp) != len) {
+        return false;
+    }
+
+    g_log_bin.strings[h] = str;
+    g_log_bin.ids[h] = g_log_bin.count;
+    *id = g_log_bin.count++;
+    return true;
+}
+
+/* 输出一条二进制记录：写入二进制日志文件，没有文件时在此格式化输出，调用方持有 g_log_mutex */
+static void log_bin_output_locked(log_level_t level, time_t now, const char *file, int line,
+                                  const char *func, const char *format,
+                                  const uint8_t *args, size_t args_len)
+{
+    if (!g_log_bin.fp) {
+        char message[1024];
+        log_bin_format(message, sizeof(message), format, args, args_len);
+        log_output_locked(level, now, file, line, func, message);
+        return;
+    }
+
+    uint32_t file_id, func_id, format_id;
+    if (!log_bin_string_id_locked(file, &file_id) ||
+        !log_bin_string_id_locked(func, &func_id) ||
+        !log_bin_string_id_locked(format, &format_id)) {
+        return;
+    }
+
+    uint8_t header[LOG_BINARY_RECORD_HEADER_SIZE];
+    header[0] = LOG_BINARY_ENTRY_RECORD;
+    header[1] = (uint8_t)level;
+    log_bin_put(header + 2, (uint64_t)(int64_t)now, 8);
+    log_bin_put(header + 10, file_id, 4);
+    log_bin_put(header + 14, func_id, 4);
+    log_bin_put(header + 18, format_id, 4);
+    log_bin_put(header + 22, (uint32_t)line, 4);
+    log_bin_put(header + 26, args_len, 2);
+    fwrite(header, 1, sizeof(header), g_log_bin.fp);
+    fwrite(args, 1, args_len, g_log_bin.fp);
+}
+
+static bool log_async_start(size_t queue_size)
+{
+    size_t capacity = 2;
+    if (queue_size == 0) {
+        queue_size = LOG_ASYNC_DEFAULT_QUEUE_SIZE;
+    }
+    while (capacity < queue_size) {
+        capacity <<= 1;
+    }
+
+    log_record_t *slots = (log_record_t *)LINX_MALLOC(capacity * sizeof(log_record_t));
+    if (!slots) {
+        return false;
+    }
+    for (size_t i = 0; i < capacity; i++) {
+        slots[i].sequence = i;
+    }
+
+    g_log_async.slots = slots;
+    g_log_async.mask = capacity - 1;
+    g_log_async.enqueue_pos = 0;
+    g_log_async.dequeue_pos = 0;
+    g_log_async.dropped = 0;
+    g_log_async.reported = 0;
+    g_log_async.sleeping = false;
+    g_log_async.running = true;
+    pthread_mutex_init(&g_log_async.wait_mutex, NULL);
+    pthread_cond_init(&g_log_async.wait_cond, NULL);
+
+    if (pthread_create(&g_log_async.thread, NULL, log_async_thread, NULL) != 0) {
+        pthread_cond_destroy(&g_log_async.wait_cond);
+        pthread_mutex_destroy(&g_log_async.wait_mutex);
+        LINX_FREE(slots);
+        g_log_async.slots = NULL;
+        g_log_async.running = false;
+        return false;
+    }
+
+    __atomic_store_n(&g_log_async_enabled, true, __ATOMIC_RELEASE);
+    return true;
+}
+
+static void log_async_stop(void)
+{
+    if (!g_log_async.slots) {
+        return;
+    }
+
+    /* 新日志改走同步路径，等待正在入队的线程离开 */
+    __atomic_store_n(&g_log_async_enabled, false, __ATOMIC_SEQ_CST);
+    while (__atomic_load_n(&g_log_async_writers, __ATOMIC_SEQ_CST) > 0) {
+        sched_yield();
+    }
+
+    pthread_mutex_lock(&g_log_async.wait_mutex);
+    __atomic_store_n(&g_log_async.running, false, __ATOMIC_RELEASE);
+    pthread_cond_signal(&g_log_async.wait_cond);
+    pthread_mutex_unlock(&g_log_async.wait_mutex);
+    pthread_join(g_log_async.thread, NULL);
+
+    pthread_cond_destroy(&g_log_async.wait_cond);
+    pthread_mutex_destroy(&g_log_async.wait_mutex);
+    LINX_FREE(g_log_async.slots);
+    g_log_async.slots = NULL;
+}
+
+/* 写入异步队列，返回 false 表示未启用异步模式，由调用方同步输出；
+ * binary 为 true 时只编码参数，格式化留给后台线程或离线解码 */
+static bool log_async_write(log_level_t level, const char *file, int line, const char *func,
+                            bool binary, const char *format, va_list args)
+{
+    if (!__atomic_load_n(&g_log_async_enabled, __ATOMIC_RELAXED)) {
+        return false;
+    }
+
+    __atomic_add_fetch(&g_log_async_writers, 1, __ATOMIC_SEQ_CST);
+    if (!__atomic_load_n(&g_log_async_enabled, __ATOMIC_SEQ_CST)) {
+        __atomic_sub_fetch(&g_log_async_writers, 1, __ATOMIC_SEQ_CST);
+        return false;
+    }
+
+    /* 抢占槽位：序号等于写入位置说明该槽位已被读走 */
+    log_record_t *record = NULL;
+    size_t pos = __atomic_load_n(&g_log_async.enqueue_pos, __ATOMIC_RELAXED);
+    for (;;) {
+        log_record_t *slot = &g_log_async.slots[pos & g_log_async.mask];
+        size_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&g_log_async.enqueue_pos, &pos, pos + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                record = slot;
+                break;
+            }
+        } else if (diff < 0) {
+            break;  /* 队列已满 */
+        } else {
+            pos = __atomic_load_n(&g_log_async.enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+
+    if (!record) {
+        __atomic_add_fetch(&g_log_async.dropped, 1, __ATOMIC_RELAXED);
+        __atomic_sub_fetch(&g_log_async_writers, 1, __ATOMIC_SEQ_CST);
+        return true;
+    }
+
+    record->level = level;
+    record->timestamp = time(NULL);
+    record->file = file;
+    record->func = func;
+    record->line = line;
+    record->format = NULL;
+    if (binary) {
+        va_list copy;
+        va_copy(copy, args);
+        int len = log_bin_encode((uint8_t *)record->message, sizeof(record->message), format, copy);
+        va_end(copy);
+        if (len >= 0) {
+            record->format = format;
+            record->args_len = (size_t)len;
+        }
+    }
+    if (!record->format) {
+        vsnprintf(record->message, sizeof(record->message), format, args);
+    }
+    __atomic_store_n(&record->sequence, pos + 1, __ATOMIC_RELEASE);
+
+    /* 后台线程空闲时唤醒，它忙于输出时入队不涉及任何锁 */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&g_log_async.sleeping, __ATOMIC_RELAXED)) {
+        pthread_mutex_lock(&g_log_async.wait_mutex);
+        pthread_cond_signal(&g_log_async.wait_cond);
+        pthread_mutex_unlock(&g_log_async.wait_mutex);
+    }
+
+    __atomic_sub_fetch(&g_log_async_writers, 1, __ATOMIC_SEQ_CST);
+    return true;
+}
+
+/* 队首日志是否已写完可读 */
+static bool log_async_pending(void)
+{
+    size_t pos = __atomic_load_n(&g_log_async.dequeue_pos, __ATOMIC_RELAXED);
+    log_record_t *slot = &g_log_async.slots[pos & g_log_async.mask];
+    return __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) == pos + 1;
+}
+
+/* 输出队列中已写完的日志，调用方持有 g_log_mutex；返回输出的条数 */
+static size_t log_async_drain_locked(void)
+{
+    size_t count = 0;
+    size_t capacity = g_log_async.mask + 1;
+
+    while (log_async_pending()) {
+        size_t pos = g_log_async.dequeue_pos;
+        log_record_t *slot = &g_log_async.slots[pos & g_log_async.mask];
+
+        if (slot->format) {
+            log_bin_output_locked(slot->level, slot->timestamp, slot->file, slot->line, slot->func,
+                                  slot->format, (const uint8_t *)slot->message, slot->args_len);
+        } else {
+            log_output_locked(slot->level, slot->timestamp, slot->file, slot->line,
+                              slot->func, slot->message);
+        }
+        __atomic_store_n(&slot->sequence, pos + capacity, __ATOMIC_RELEASE);
+        __atomic_store_n(&g_log_async.dequeue_pos, pos + 1, __ATOMIC_RELAXED);
+        count++;
+    }
+
+    unsigned long long dropped = __atomic_load_n(&g_log_async.dropped, __ATOMIC_RELAXED);
+    if (dropped != g_log_async.reported) {
+        fprintf(stderr, "[%s] 日志队列已满，丢弃 %llu 条日志\n",
+                log_level_strings[LOG_LEVEL_WARN], dropped - g_log_async.reported);
+        g_log_async.reported = dropped;
+        count++;
+    }
+
+    if (count > 0) {
+        if (g_log_bin.fp) {
+            fflush(g_log_bin.fp);
+        }
+        fflush(stderr);
+    }
+    return count;
+}
+
+/* 无日志时等待入队唤醒，超时后也会醒来检查 */
+static void log_async_wait(void)
+{
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += LOG_ASYNC_IDLE_WAIT_MS * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec += 1;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&g_log_async.wait_mutex);
+    __atomic_store_n(&g_log_async.sleeping, true, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&g_log_async.running, __ATOMIC_ACQUIRE) && !log_async_pending()) {
+        int rc = 0;
+        while (rc != ETIMEDOUT && __atomic_load_n(&g_log_async.running, __ATOMIC_ACQUIRE) &&
+               !log_async_pending()) {
+            rc = pthread_cond_timedwait(&g_log_async.wait_cond, &g_log_async.wait_mutex, &deadline);
+        }
+    }
+    __atomic_store_n(&g_log_async.sleeping, false, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&g_log_async.wait_mutex);
+}
+
+/* 后台输出线程：批量输出，队列空时睡眠；停止前输出剩余日志 */
+static void *log_async_thread(void *arg)
+{
+    (void)arg;
+    linx_thread_stats_register("log", LINX_THREAD_STAGE_LOG);
+
+    while (__atomic_load_n(&g_log_async.running, __ATOMIC_ACQUIRE)) {
+        linx_deadline_lock(&g_log_lock, &g_log_mutex);
+        size_t count = log_async_drain_locked();
+        linx_deadline_unlock(&g_log_lock, &g_log_mutex);
+
+        if (count == 0) {
+            log_async_wait();
+        }
+    }
+
+    pthread_mutex_lock(&g_log_mutex);
+    log_async_drain_locked();
+    pthread_mutex_unlock(&g_log_mutex);
+    linx_thread_stats_unregister();
+    return NULL;
+}
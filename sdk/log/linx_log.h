@@ -5,6 +5,7 @@
 #include <stdarg.h>
 #include <time.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -20,14 +21,66 @@ typedef enum {
     LOG_LEVEL_MAX
 } log_level_t;
 
+/*
+ * 编译期最低日志级别（数值同 log_level_t：0=DEBUG 1=INFO 2=WARN 3=ERROR 4=FATAL 5=全部关闭）
+ * 低于该级别的 LOG_* / LOG_BIN_* / LINX_LOG* 调用在编译时整体移除，不占代码空间也不做运行时检查。
+ * 发布固件可在编译选项中加 -DLINX_LOG_MIN_LEVEL=1 去掉全部 DEBUG 日志
+ */
+#ifndef LINX_LOG_MIN_LEVEL
+#define LINX_LOG_MIN_LEVEL 0
+#endif
+
+/* 该级别的日志是否编译进来（常量表达式，由编译器折叠） */
+#define LOG_LEVEL_COMPILED(level) ((int)(level) >= LINX_LOG_MIN_LEVEL)
+
+/* 模块日志级别：尚未解析 / 跟随全局级别 */
+#define LOG_TAG_LEVEL_UNRESOLVED (-2)
+#define LOG_TAG_LEVEL_GLOBAL (-1)
+
+/* 可单独设置运行时级别的模块数上限 */
+#define LOG_MAX_TAG_OVERRIDES 16
+
+/* 模块名最大长度（含结尾的 '\0'） */
+#define LOG_TAG_NAME_SIZE 32
+
+/* 异步模式默认队列容量（条） */
+#define LOG_ASYNC_DEFAULT_QUEUE_SIZE 64
+
+/* 异步模式下单条消息的最大长度（含结尾的 '\0'），超出部分截断 */
+#define LOG_ASYNC_MESSAGE_SIZE 512
+
+/* 二进制日志文件魔数（8字节） */
+#define LOG_BINARY_MAGIC "LINXLOG1"
+
+/* 让编译器按 printf 规则检查 LOG_BIN_* 的参数类型，二进制编码依赖参数与格式串一致 */
+#if defined(__GNUC__)
+#define LOG_PRINTF_FORMAT(fmt_index, args_index) __attribute__((format(printf, fmt_index, args_index)))
+#else
+#define LOG_PRINTF_FORMAT(fmt_index, args_index)
+#endif
+
 /* 日志配置结构体 */
 typedef struct {
     log_level_t level;              /* 最低日志级别 */
     bool enable_timestamp;          /* 是否启用时间戳 */
     bool enable_thread_id;          /* 是否启用线程ID */
     bool enable_color;              /* 是否启用颜色输出 */
+    bool async;                     /* 异步模式：调用线程只格式化消息并写入无锁队列，后台线程负责时间戳、拼装和输出 */
+    size_t async_queue_size;        /* 异步队列容量（条），0 使用 LOG_ASYNC_DEFAULT_QUEUE_SIZE，向上取整为2的幂 */
+    const char *binary_file;        /* 非NULL时 LOG_BIN_* 日志不格式化，以二进制记录写入该文件，用 log_binary_decode 离线解码 */
 } log_config_t;
 
+/**
+ * 日志转发回调：每条输出到控制台的日志在写出后调用一次
+ * 异步模式下在后台输出线程调用，同步模式下在写日志的线程调用，调用时持有日志锁；
+ * 回调中输出的日志会被丢弃。写入 binary_file 的二进制记录不转发
+ * @param user_data log_set_forwarder 传入的用户指针
+ * @param level 日志级别
+ * @param line 日志行（无颜色，以换行结尾）
+ * @param len 日志行长度
+ */
+typedef void (*log_forward_cb_t)(void *user_data, log_level_t level, const char *line, size_t len);
+
 /* 日志上下文结构体 */
 typedef struct {
     log_config_t config;
@@ -39,9 +92,29 @@ typedef struct {
     .level = LOG_LEVEL_INFO, \
     .enable_timestamp = true, \
     .enable_thread_id = false, \
-    .enable_color = true \
+    .enable_color = true, \
+    .async = false, \
+    .async_queue_size = 0, \
+    .binary_file = NULL \
 }
 
+/*
+ * 日志模块（标签），每个源文件用 LINX_LOG_TAG_DEFINE 定义一个
+ * level 缓存该模块的有效级别，首次使用时解析，之后的级别检查只是一次原子读
+ */
+typedef struct log_tag {
+    const char *name;               /* 模块名，输出为 "[name] " 前缀 */
+    int level;                      /* LOG_TAG_LEVEL_UNRESOLVED / LOG_TAG_LEVEL_GLOBAL / 单独设置的级别 */
+    struct log_tag *next;           /* 已解析模块链表 */
+} log_tag_t;
+
+/* 定义本文件的日志模块 */
+#define LINX_LOG_TAG_DEFINE(var, tag_name) \
+    static log_tag_t var = { tag_name, LOG_TAG_LEVEL_UNRESOLVED, NULL }
+
+/* 内部使用：当前全局级别阈值，未初始化时为 LOG_LEVEL_MAX（全部关闭） */
+extern int log_level_threshold;
+
 /* 日志级别字符串 */
 extern const char* log_level_strings[LOG_LEVEL_MAX];
 
@@ -52,6 +125,7 @@ extern const char* log_level_colors[LOG_LEVEL_MAX];
 
 /**
  * 初始化日志模块
+ * 异步模式下会启动后台输出线程；队列或线程创建失败时退回同步模式
  * @param config 日志配置，如果为NULL则使用默认配置
  * @return 0成功，-1失败
  */
@@ -59,6 +133,7 @@ int log_init(const log_config_t *config);
 
 /**
  * 清理日志模块
+ * 异步模式下先输出队列中剩余的日志，再停止后台线程
  */
 void log_cleanup(void);
 
@@ -76,6 +151,8 @@ log_level_t log_get_level(void);
 
 /**
  * 写入日志
+ * 异步模式下队列已满时丢弃该条日志并计数；FATAL 级别始终同步输出，
+ * 输出前先写出队列中尚未输出的日志
  * @param level 日志级别
  * @param file 源文件名
  * @param line 行号
@@ -86,11 +163,55 @@ log_level_t log_get_level(void);
 void log_write(log_level_t level, const char *file, int line, 
                const char *func, const char *format, ...);
 
+/**
+ * 写入二进制日志（参数延迟格式化）
+ * 调用线程只按格式串把参数原样编码（整数、浮点、指针，字符串复制内容），
+ * 格式化推迟到异步线程输出时，或配置了 binary_file 时推迟到离线解码。
+ * 同步模式且未配置 binary_file 时与 log_write 相同。
+ * format、file、func 只保存指针，必须是字符串常量；
+ * 不支持 %n 和宽字符转换，遇到时退回文本格式化。
+ * 单条记录的参数编码不超过 LOG_ASYNC_MESSAGE_SIZE 字节，超长字符串截断
+ * @param level 日志级别
+ * @param file 源文件名
+ * @param line 行号
+ * @param func 函数名
+ * @param format 格式化字符串（字符串常量）
+ * @param ... 可变参数
+ */
+void log_write_binary(log_level_t level, const char *file, int line,
+                      const char *func, const char *format, ...) LOG_PRINTF_FORMAT(5, 6);
+
+/**
+ * 把 binary_file 生成的二进制日志解码为文本
+ * 输出格式与控制台日志相同（含时间戳，无颜色）。文件末尾不完整的记录
+ * （例如设备掉电）被忽略
+ * @param in 二进制日志文件
+ * @param out 文本输出
+ * @return 解码的日志条数，文件格式错误返回 -1
+ */
+int log_binary_decode(FILE *in, FILE *out);
+
 /**
  * 刷新日志缓冲区
+ * 异步模式下在调用线程中输出队列中已有的日志
  */
 void log_flush(void);
 
+/**
+ * 设置日志转发回调（如远程日志上传），同一时间只有一个
+ * 返回后旧回调不会再被调用
+ * @param callback 转发回调，NULL 取消转发
+ * @param user_data 用户指针
+ * @param min_level 转发的最低级别
+ */
+void log_set_forwarder(log_forward_cb_t callback, void *user_data, log_level_t min_level);
+
+/**
+ * 获取异步模式下因队列已满而丢弃的日志条数
+ * @return 自初始化以来的丢弃条数
+ */
+unsigned long long log_get_dropped_count(void);
+
 /**
  * 检查日志级别是否启用
  * @param level 日志级别
@@ -98,42 +219,160 @@ void log_flush(void);
  */
 bool log_is_level_enabled(log_level_t level);
 
-/* 便捷宏定义 */
-#define LOG_DEBUG(fmt, ...) \
+/**
+ * 设置模块的运行时日志级别，覆盖全局级别
+ * 可在模块首次输出日志之前调用；最多单独设置 LOG_MAX_TAG_OVERRIDES 个模块
+ * @param tag 模块名（与 LINX_LOG_TAG_DEFINE 中的名字相同）
+ * @param level 日志级别
+ * @return 0成功，-1参数错误或已达上限
+ */
+int log_set_tag_level(const char *tag, log_level_t level);
+
+/**
+ * 取消模块的单独级别，恢复跟随全局级别
+ * @param tag 模块名
+ */
+void log_reset_tag_level(const char *tag);
+
+/**
+ * 解析模块的有效级别（模块首次输出日志时由 log_tag_is_enabled 调用）
+ * @param tag 日志模块
+ * @return LOG_TAG_LEVEL_GLOBAL 或单独设置的级别
+ */
+int log_tag_resolve(log_tag_t *tag);
+
+/**
+ * 写入模块日志，级别按模块的有效级别过滤，其余同 log_write
+ * @param tag 日志模块
+ * @param level 日志级别
+ * @param file 源文件名
+ * @param line 行号
+ * @param func 函数名
+ * @param format 格式化字符串
+ * @param ... 可变参数
+ */
+void log_write_tag(log_tag_t *tag, log_level_t level, const char *file, int line,
+                   const char *func, const char *format, ...) LOG_PRINTF_FORMAT(6, 7);
+
+/**
+ * 限频日志的时间检查：距离上次通过已超过 interval_ms 时返回 true 并记录本次时间
+ * 多线程同时到达时只有一个通过
+ * @param next_ms 调用点的状态（下次允许输出的时间，初始为0）
+ * @param interval_ms 最小输出间隔(毫秒)
+ * @return true输出，false跳过
+ */
+bool log_rate_limit_pass(uint64_t *next_ms, uint32_t interval_ms);
+
+/* 全局级别检查，无锁，宏中内联使用 */
+static inline bool log_level_passes(log_level_t level)
+{
+    return (int)level >= __atomic_load_n(&log_level_threshold, __ATOMIC_RELAXED);
+}
+
+/* 模块级别检查，无锁；首次调用时解析模块级别 */
+static inline bool log_tag_is_enabled(log_tag_t *tag, log_level_t level)
+{
+    int threshold = __atomic_load_n(&tag->level, __ATOMIC_ACQUIRE);
+    if (threshold == LOG_TAG_LEVEL_UNRESOLVED) {
+        threshold = log_tag_resolve(tag);
+    }
+    if (threshold == LOG_TAG_LEVEL_GLOBAL) {
+        threshold = __atomic_load_n(&log_level_threshold, __ATOMIC_RELAXED);
+    }
+    return (int)level >= threshold;
+}
+
+/* 便捷宏定义：低于 LINX_LOG_MIN_LEVEL 的调用被编译器移除 */
+#define LOG_AT_LEVEL(level, fmt, ...) \
+    do { \
+        if (LOG_LEVEL_COMPILED(level) && log_level_passes(level)) { \
+            log_write(level, __FILE__, __LINE__, __func__, fmt, ##__VA_ARGS__); \
+        } \
+    } while(0)
+
+#define LOG_DEBUG(fmt, ...) LOG_AT_LEVEL(LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+#define LOG_INFO(fmt, ...)  LOG_AT_LEVEL(LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#define LOG_WARN(fmt, ...)  LOG_AT_LEVEL(LOG_LEVEL_WARN, fmt, ##__VA_ARGS__)
+#define LOG_ERROR(fmt, ...) LOG_AT_LEVEL(LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#define LOG_FATAL(fmt, ...) LOG_AT_LEVEL(LOG_LEVEL_FATAL, fmt, ##__VA_ARGS__)
+
+/* 二进制日志宏：用于音频帧等高频路径，格式化不占用调用线程 */
+#define LOG_BIN_AT_LEVEL(level, fmt, ...) \
     do { \
-        if (log_is_level_enabled(LOG_LEVEL_DEBUG)) { \
-            log_write(LOG_LEVEL_DEBUG, __FILE__, __LINE__, __func__, fmt, ##__VA_ARGS__); \
+        if (LOG_LEVEL_COMPILED(level) && log_level_passes(level)) { \
+            log_write_binary(level, __FILE__, __LINE__, __func__, fmt, ##__VA_ARGS__); \
         } \
     } while(0)
 
-#define LOG_INFO(fmt, ...) \
+#define LOG_BIN_DEBUG(fmt, ...) LOG_BIN_AT_LEVEL(LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+#define LOG_BIN_INFO(fmt, ...)  LOG_BIN_AT_LEVEL(LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#define LOG_BIN_WARN(fmt, ...)  LOG_BIN_AT_LEVEL(LOG_LEVEL_WARN, fmt, ##__VA_ARGS__)
+#define LOG_BIN_ERROR(fmt, ...) LOG_BIN_AT_LEVEL(LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+
+/* 模块日志宏：tag 为 LINX_LOG_TAG_DEFINE 定义的变量，按模块级别过滤并加 "[name] " 前缀 */
+#define LINX_LOG_AT_LEVEL(level, tag, fmt, ...) \
     do { \
-        if (log_is_level_enabled(LOG_LEVEL_INFO)) { \
-            log_write(LOG_LEVEL_INFO, __FILE__, __LINE__, __func__, fmt, ##__VA_ARGS__); \
+        if (LOG_LEVEL_COMPILED(level) && log_tag_is_enabled(&(tag), level)) { \
+            log_write_tag(&(tag), level, __FILE__, __LINE__, __func__, "[%s] " fmt, (tag).name, ##__VA_ARGS__); \
         } \
     } while(0)
 
-#define LOG_WARN(fmt, ...) \
+#define LINX_LOGD(tag, fmt, ...) LINX_LOG_AT_LEVEL(LOG_LEVEL_DEBUG, tag, fmt, ##__VA_ARGS__)
+#define LINX_LOGI(tag, fmt, ...) LINX_LOG_AT_LEVEL(LOG_LEVEL_INFO, tag, fmt, ##__VA_ARGS__)
+#define LINX_LOGW(tag, fmt, ...) LINX_LOG_AT_LEVEL(LOG_LEVEL_WARN, tag, fmt, ##__VA_ARGS__)
+#define LINX_LOGE(tag, fmt, ...) LINX_LOG_AT_LEVEL(LOG_LEVEL_ERROR, tag, fmt, ##__VA_ARGS__)
+#define LINX_LOGF(tag, fmt, ...) LINX_LOG_AT_LEVEL(LOG_LEVEL_FATAL, tag, fmt, ##__VA_ARGS__)
+
+/*
+ * 采样与限频日志宏：每个调用点有自己的静态状态，多线程安全
+ *   EVERY_N   第1、N+1、2N+1...次调用时输出
+ *   EVERY_MS  两次输出至少间隔 ms 毫秒，期间的调用被跳过
+ *   FIRST_N   只输出前 N 次
+ * 级别未启用时不计数。与 LOG_BIN_* 一样按二进制记录写入（格式串须为字符串常量）
+ */
+#define LOG_EVERY_N(level, n, fmt, ...) \
     do { \
-        if (log_is_level_enabled(LOG_LEVEL_WARN)) { \
-            log_write(LOG_LEVEL_WARN, __FILE__, __LINE__, __func__, fmt, ##__VA_ARGS__); \
+        static unsigned int log_site_count_ = 0; \
+        if (LOG_LEVEL_COMPILED(level) && log_level_passes(level) && \
+            __atomic_fetch_add(&log_site_count_, 1, __ATOMIC_RELAXED) % (unsigned int)(n) == 0) { \
+            log_write_binary(level, __FILE__, __LINE__, __func__, fmt, ##__VA_ARGS__); \
         } \
     } while(0)
 
-#define LOG_ERROR(fmt, ...) \
+#define LOG_EVERY_MS(level, ms, fmt, ...) \
     do { \
-        if (log_is_level_enabled(LOG_LEVEL_ERROR)) { \
-            log_write(LOG_LEVEL_ERROR, __FILE__, __LINE__, __func__, fmt, ##__VA_ARGS__); \
+        static uint64_t log_site_next_ms_ = 0; \
+        if (LOG_LEVEL_COMPILED(level) && log_level_passes(level) && \
+            log_rate_limit_pass(&log_site_next_ms_, (uint32_t)(ms))) { \
+            log_write_binary(level, __FILE__, __LINE__, __func__, fmt, ##__VA_ARGS__); \
         } \
     } while(0)
 
-#define LOG_FATAL(fmt, ...) \
+#define LOG_FIRST_N(level, n, fmt, ...) \
     do { \
-        if (log_is_level_enabled(LOG_LEVEL_FATAL)) { \
-            log_write(LOG_LEVEL_FATAL, __FILE__, __LINE__, __func__, fmt, ##__VA_ARGS__); \
+        static unsigned int log_site_count_ = 0; \
+        if (LOG_LEVEL_COMPILED(level) && log_level_passes(level) && \
+            __atomic_load_n(&log_site_count_, __ATOMIC_RELAXED) < (unsigned int)(n) && \
+            __atomic_fetch_add(&log_site_count_, 1, __ATOMIC_RELAXED) < (unsigned int)(n)) { \
+            log_write_binary(level, __FILE__, __LINE__, __func__, fmt, ##__VA_ARGS__); \
         } \
     } while(0)
 
+#define LOG_DEBUG_EVERY_N(n, fmt, ...) LOG_EVERY_N(LOG_LEVEL_DEBUG, n, fmt, ##__VA_ARGS__)
+#define LOG_INFO_EVERY_N(n, fmt, ...)  LOG_EVERY_N(LOG_LEVEL_INFO, n, fmt, ##__VA_ARGS__)
+#define LOG_WARN_EVERY_N(n, fmt, ...)  LOG_EVERY_N(LOG_LEVEL_WARN, n, fmt, ##__VA_ARGS__)
+#define LOG_ERROR_EVERY_N(n, fmt, ...) LOG_EVERY_N(LOG_LEVEL_ERROR, n, fmt, ##__VA_ARGS__)
+
+#define LOG_DEBUG_EVERY_MS(ms, fmt, ...) LOG_EVERY_MS(LOG_LEVEL_DEBUG, ms, fmt, ##__VA_ARGS__)
+#define LOG_INFO_EVERY_MS(ms, fmt, ...)  LOG_EVERY_MS(LOG_LEVEL_INFO, ms, fmt, ##__VA_ARGS__)
+#define LOG_WARN_EVERY_MS(ms, fmt, ...)  LOG_EVERY_MS(LOG_LEVEL_WARN, ms, fmt, ##__VA_ARGS__)
+#define LOG_ERROR_EVERY_MS(ms, fmt, ...) LOG_EVERY_MS(LOG_LEVEL_ERROR, ms, fmt, ##__VA_ARGS__)
+
+#define LOG_DEBUG_FIRST_N(n, fmt, ...) LOG_FIRST_N(LOG_LEVEL_DEBUG, n, fmt, ##__VA_ARGS__)
+#define LOG_INFO_FIRST_N(n, fmt, ...)  LOG_FIRST_N(LOG_LEVEL_INFO, n, fmt, ##__VA_ARGS__)
+#define LOG_WARN_FIRST_N(n, fmt, ...)  LOG_FIRST_N(LOG_LEVEL_WARN, n, fmt, ##__VA_ARGS__)
+#define LOG_ERROR_FIRST_N(n, fmt, ...) LOG_FIRST_N(LOG_LEVEL_ERROR, n, fmt, ##__VA_ARGS__)
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,373 @@
+#include "linx_log_upload.h"
+#include "linx_alloc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_LOG);
+
+/* LZ4 块格式参数 */
+#define LZ4_MIN_MATCH 4
+#define LZ4_LAST_LITERALS 5         /* 块末尾至少保留的字面量字节数 */
+#define LZ4_MATCH_LIMIT 12          /* 距块末尾不足该长度时不再开始匹配 */
+#define LZ4_HASH_BITS 12
+#define LZ4_MAX_OFFSET 65535
+
+/* LZ4 压缩后的最大长度 */
+#define LZ4_COMPRESS_BOUND(n) ((n) + (n) / 255 + 16)
+
+/* 压缩后的一批日志 */
+typedef struct log_upload_batch {
+    struct log_upload_batch *next;
+    size_t raw_size;                /* 压缩前字节数 */
+    size_t size;                    /* 压缩后字节数 */
+    uint8_t data[];
+} log_upload_batch_t;
+
+struct log_upload {
+    log_upload_config_t config;
+    pthread_mutex_t mutex;          /* 保护以下所有字段；持有时不能输出日志 */
+
+    /* 正在攒的原始日志 */
+    char staging[LOG_UPLOAD_MAX_BATCH];
+    size_t staging_len;
+    uint64_t staging_since_ms;      /* 第一行进入的时间 */
+
+    /* 待上传的批次（FIFO） */
+    log_upload_batch_t *head;
+    log_upload_batch_t *tail;
+    size_t buffered_bytes;
+
+    uint32_t seq;
+    uint32_t lost;                  /* 自上一条消息以来丢弃的批次数 */
+    log_upload_stats_t stats;
+
+    uint16_t hash_table[1 << LZ4_HASH_BITS];
+};
+
+static const char s_base64_alphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static uint64_t log_upload_now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+static uint32_t log_upload_read32(const uint8_t *p)
+{
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+/* 写入 LZ4 长度扩展字节 */
+static uint8_t *lz4_write_length(uint8_t *op, size_t length)
+{
+    while (length >= 255) {
+        *op++ = 255;
+        length -= 255;
+    }
+    *op++ = (uint8_t)length;
+    return op;
+}
+
+/* 按 LZ4 块格式压缩 src（不超过 64KB），dst 至少 LZ4_COMPRESS_BOUND(n) 字节；返回压缩后长度 */
+static size_t lz4_compress(uint16_t *table, const uint8_t *src, size_t n, uint8_t *dst)
+{
+    uint8_t *op = dst;
+    size_t anchor = 0;
+
+    memset(table, 0, sizeof(uint16_t) << LZ4_HASH_BITS);
+
+    if (n > LZ4_MATCH_LIMIT) {
+        size_t limit = n - LZ4_MATCH_LIMIT;
+        size_t ip = 0;
+
+        while (ip < limit) {
+            uint32_t sequence = log_upload_read32(src + ip);
+            uint32_t hash = (sequence * 2654435761u) >> (32 - LZ4_HASH_BITS);
+            size_t ref = table[hash];
+            table[hash] = (uint16_t)ip;
+
+            /* 表项初始为0，必须校验内容才能当作匹配 */
+            if (ref >= ip || ip - ref > LZ4_MAX_OFFSET || log_upload_read32(src + ref) != sequence) {
+                ip++;
+                continue;
+            }
+
+            size_t match_len = LZ4_MIN_MATCH;
+            while (ip + match_len < n - LZ4_LAST_LITERALS && src[ref + match_len] == src[ip + match_len]) {
+                match_len++;
+            }
+
+            size_t literal_len = ip - anchor;
+            uint8_t *token = op++;
+            *token = (uint8_t)((literal_len >= 15 ? 15 : literal_len) << 4);
+            if (literal_len >= 15) {
+                op = lz4_write_length(op, literal_len - 15);
+            }
+            memcpy(op, src + anchor, literal_len);
+            op += literal_len;
+
+            size_t offset = ip - ref;
+            *op++ = (uint8_t)(offset & 0xff);
+            *op++ = (uint8_t)(offset >> 8);
+
+            size_t extra = match_len - LZ4_MIN_MATCH;
+            *token |= (uint8_t)(extra >= 15 ? 15 : extra);
+            if (extra >= 15) {
+                op = lz4_write_length(op, extra - 15);
+            }
+
+            ip += match_len;
+            anchor = ip;
+        }
+    }
+
+    /* 剩余字面量 */
+    size_t literal_len = n - anchor;
+    uint8_t *token = op++;
+    *token = (uint8_t)((literal_len >= 15 ? 15 : literal_len) << 4);
+    if (literal_len >= 15) {
+        op = lz4_write_length(op, literal_len - 15);
+    }
+    memcpy(op, src + anchor, literal_len);
+    op += literal_len;
+
+    return (size_t)(op - dst);
+}
+
+/* 把攒好的日志压缩成一批放入待上传队列，调用方持有 mutex */
+static void log_upload_seal_locked(log_upload_t *upload)
+{
+    if (upload->staging_len == 0) {
+        return;
+    }
+
+    log_upload_batch_t *batch = (log_upload_batch_t *)LINX_MALLOC(sizeof(log_upload_batch_t) +
+                                                             LZ4_COMPRESS_BOUND(upload->staging_len));
+    if (!batch) {
+        upload->staging_len = 0;
+        upload->lost++;
+        upload->stats.batches_dropped++;
+        return;
+    }
+
+    batch->next = NULL;
+    batch->raw_size = upload->staging_len;
+    batch->size = lz4_compress(upload->hash_table, (const uint8_t *)upload->staging,
+                               upload->staging_len, batch->data);
+    upload->staging_len = 0;
+
+    if (upload->tail) {
+        upload->tail->next = batch;
+    } else {
+        upload->head = batch;
+    }
+    upload->tail = batch;
+    upload->buffered_bytes += batch->size;
+
+    /* 超出容量时丢弃最旧的批次，最新的日志更有价值 */
+    while (upload->buffered_bytes > upload->config.buffer_size && upload->head != batch) {
+        log_upload_batch_t *oldest = upload->head;
+        upload->head = oldest->next;
+        upload->buffered_bytes -= oldest->size;
+        upload->lost++;
+        upload->stats.batches_dropped++;
+        LINX_FREE(oldest);
+    }
+}
+
+/* 日志转发回调，在日志输出线程中调用 */
+static void log_upload_forward(void *user_data, log_level_t level, const char *line, size_t len)
+{
+    log_upload_t *upload = (log_upload_t *)user_data;
+    (void)level;
+
+    if (len > upload->config.batch_size) {
+        len = upload->config.batch_size;
+    }
+
+    pthread_mutex_lock(&upload->mutex);
+
+    if (upload->staging_len + len > upload->config.batch_size) {
+        log_upload_seal_locked(upload);
+    }
+    if (upload->staging_len == 0) {
+        upload->staging_since_ms = log_upload_now_ms();
+    }
+    memcpy(upload->staging + upload->staging_len, line, len);
+    upload->staging_len += len;
+    upload->stats.lines++;
+
+    pthread_mutex_unlock(&upload->mutex);
+}
+
+log_upload_t *log_upload_create(const log_upload_config_t *config)
+{
+    log_upload_t *upload = (log_upload_t *)LINX_CALLOC(1, sizeof(log_upload_t));
+    if (!upload) {
+        LOG_ERROR("远程日志上传器内存分配失败");
+        return NULL;
+    }
+
+    if (config) {
+        upload->config = *config;
+    } else {
+        upload->config.min_level = LOG_LEVEL_INFO;
+    }
+    if (upload->config.batch_size == 0 || upload->config.batch_size > LOG_UPLOAD_MAX_BATCH) {
+        upload->config.batch_size = LOG_UPLOAD_MAX_BATCH;
+    }
+    if (upload->config.buffer_size == 0) {
+        upload->config.buffer_size = LOG_UPLOAD_DEFAULT_BUFFER_SIZE;
+    }
+    if (upload->config.flush_interval_ms == 0) {
+        upload->config.flush_interval_ms = LOG_UPLOAD_DEFAULT_FLUSH_MS;
+    }
+
+    pthread_mutex_init(&upload->mutex, NULL);
+    log_set_forwarder(log_upload_forward, upload, upload->config.min_level);
+
+    LOG_INFO("远程日志上传已启用，缓冲区 %zu 字节", upload->config.buffer_size);
+    return upload;
+}
+
+void log_upload_destroy(log_upload_t *upload)
+{
+    if (!upload) {
+        return;
+    }
+
+    /* 返回后转发回调不会再被调用 */
+    log_set_forwarder(NULL, NULL, LOG_LEVEL_DEBUG);
+
+    log_upload_batch_t *batch = upload->head;
+    while (batch) {
+        log_upload_batch_t *next = batch->next;
+        LINX_FREE(batch);
+        batch = next;
+    }
+
+    pthread_mutex_destroy(&upload->mutex);
+    LINX_FREE(upload);
+}
+
+/* base64 编码，dst 至少 4 * ((len + 2) / 3) 字节；返回写入长度 */
+static size_t log_upload_base64(const uint8_t *src, size_t len, char *dst)
+{
+    char *out = dst;
+    size_t i = 0;
+
+    for (; i + 3 <= len; i += 3) {
+        uint32_t v = ((uint32_t)src[i] << 16) | ((uint32_t)src[i + 1] << 8) | src[i + 2];
+        *out++ = s_base64_alphabet[(v >> 18) & 0x3f];
+        *out++ = s_base64_alphabet[(v >> 12) & 0x3f];
+        *out++ = s_base64_alphabet[(v >> 6) & 0x3f];
+        *out++ = s_base64_alphabet[v & 0x3f];
+    }
+    if (i < len) {
+        uint32_t v = (uint32_t)src[i] << 16;
+        if (i + 1 < len) {
+            v |= (uint32_t)src[i + 1] << 8;
+        }
+        *out++ = s_base64_alphabet[(v >> 18) & 0x3f];
+        *out++ = s_base64_alphabet[(v >> 12) & 0x3f];
+        *out++ = i + 1 < len ? s_base64_alphabet[(v >> 6) & 0x3f] : '=';
+        *out++ = '=';
+    }
+    return (size_t)(out - dst);
+}
+
+size_t log_upload_next_message(log_upload_t *upload, const char *session_id, char *buffer, size_t size)
+{
+    if (!upload || !buffer || size == 0) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&upload->mutex);
+
+    if (upload->staging_len > 0 &&
+        log_upload_now_ms() - upload->staging_since_ms >= upload->config.flush_interval_ms) {
+        log_upload_seal_locked(upload);
+    }
+
+    log_upload_batch_t *batch = upload->head;
+    if (!batch) {
+        pthread_mutex_unlock(&upload->mutex);
+        return 0;
+    }
+    upload->head = batch->next;
+    if (!upload->head) {
+        upload->tail = NULL;
+    }
+    upload->buffered_bytes -= batch->size;
+
+    uint32_t seq = ++upload->seq;
+    uint32_t lost = upload->lost;
+    upload->lost = 0;
+
+    pthread_mutex_unlock(&upload->mutex);
+
+    /* 会话ID来自服务器，含需要转义的字符时省略 */
+    if (session_id && strpbrk(session_id, "\"\\")) {
+        session_id = NULL;
+    }
+
+    int header_len;
+    if (session_id) {
+        header_len = snprintf(buffer, size,
+                              "{\"session_id\":\"%s\",\"type\":\"log\",\"seq\":%u,\"encoding\":\"lz4\","
+                              "\"raw_size\":%zu,\"lost\":%u,\"data\":\"",
+                              session_id, (unsigned)seq, batch->raw_size, (unsigned)lost);
+    } else {
+        header_len = snprintf(buffer, size,
+                              "{\"type\":\"log\",\"seq\":%u,\"encoding\":\"lz4\","
+                              "\"raw_size\":%zu,\"lost\":%u,\"data\":\"",
+                              (unsigned)seq, batch->raw_size, (unsigned)lost);
+    }
+
+    size_t encoded_len = 4 * ((batch->size + 2) / 3);
+    size_t total = header_len > 0 ? (size_t)header_len + encoded_len + 2 : 0;
+    if (total == 0 || total >= size) {
+        /* 缓冲区太小，这一批只能丢弃，在下一条消息的 lost 中体现 */
+        pthread_mutex_lock(&upload->mutex);
+        upload->lost++;
+        upload->stats.batches_dropped++;
+        pthread_mutex_unlock(&upload->mutex);
+        LINX_FREE(batch);
+        return 0;
+    }
+
+    size_t pos = (size_t)header_len;
+    pos += log_upload_base64(batch->data, batch->size, buffer + pos);
+    buffer[pos++] = '"';
+    buffer[pos++] = '}';
+    buffer[pos] = '\0';
+
+    pthread_mutex_lock(&upload->mutex);
+    upload->stats.batches_sent++;
+    upload->stats.raw_bytes += batch->raw_size;
+    upload->stats.compressed_bytes += batch->size;
+    pthread_mutex_unlock(&upload->mutex);
+
+    LINX_FREE(batch);
+    return pos;
+}
+
+bool log_upload_get_stats(log_upload_t *upload, log_upload_stats_t *stats)
+{
+    if (!upload || !stats) {
+        return false;
+    }
+
+    pthread_mutex_lock(&upload->mutex);
+    *stats = upload->stats;
+    stats->buffered_bytes = upload->buffered_bytes;
+    pthread_mutex_unlock(&upload->mutex);
+    return true;
+}
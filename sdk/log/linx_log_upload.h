@@ -0,0 +1,96 @@
+#ifndef LINX_LOG_UPLOAD_H
+#define LINX_LOG_UPLOAD_H
+
+#include "linx_log.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 远程日志上传
+ *
+ * 通过日志转发回调收集输出的日志行（异步模式下在后台输出线程收集），
+ * 攒成批后用 LZ4 块格式压缩，存入有界缓冲区；缓冲区满时丢弃最旧的批次。
+ * 网络空闲时由发送方调用 log_upload_next_message() 取出一批，生成低优先级文本消息：
+ *
+ *   {"session_id":"...","type":"log","seq":1,"encoding":"lz4","raw_size":1834,
+ *    "lost":0,"data":"<base64>"}
+ *
+ * data 为 base64 编码的 LZ4 块（不含帧头），解压后长度为 raw_size，内容是以换行分隔的日志行；
+ * seq 每批递增，lost 为自上一批以来因缓冲区已满丢弃的批次数
+ */
+
+/* 单批原始日志的最大字节数，保证编码后的消息不超过 LOG_UPLOAD_MESSAGE_MAX */
+#define LOG_UPLOAD_MAX_BATCH 2048
+
+/* log_upload_next_message() 生成的消息最大长度（含结尾的 '\0'） */
+#define LOG_UPLOAD_MESSAGE_MAX 4096
+
+/* 默认配置 */
+#define LOG_UPLOAD_DEFAULT_BUFFER_SIZE 16384
+#define LOG_UPLOAD_DEFAULT_FLUSH_MS 5000
+
+/* 远程日志上传器 */
+typedef struct log_upload log_upload_t;
+
+/* 上传配置 */
+typedef struct {
+    log_level_t min_level;          /* 上传的最低级别 */
+    size_t batch_size;              /* 单批原始日志字节数，0 或超过 LOG_UPLOAD_MAX_BATCH 时取 LOG_UPLOAD_MAX_BATCH */
+    size_t buffer_size;             /* 压缩后待上传数据的总容量（字节），0 使用 LOG_UPLOAD_DEFAULT_BUFFER_SIZE */
+    uint32_t flush_interval_ms;     /* 不满一批的日志最长等待时间，0 使用 LOG_UPLOAD_DEFAULT_FLUSH_MS */
+} log_upload_config_t;
+
+/* 上传统计 */
+typedef struct {
+    uint64_t lines;                 /* 收集的日志行数 */
+    uint64_t raw_bytes;             /* 已上传批次的原始字节数 */
+    uint64_t compressed_bytes;      /* 已上传批次的压缩后字节数 */
+    uint32_t batches_sent;          /* 已生成消息的批次数 */
+    uint32_t batches_dropped;       /* 因缓冲区已满丢弃的批次数 */
+    size_t buffered_bytes;          /* 当前等待上传的压缩数据字节数 */
+} log_upload_stats_t;
+
+/**
+ * 创建上传器并注册为日志转发回调
+ * 同一时间只能有一个上传器（日志转发回调只有一个）
+ * @param config 上传配置，NULL 使用默认值（INFO 及以上）
+ * @return 上传器，失败返回 NULL
+ */
+log_upload_t *log_upload_create(const log_upload_config_t *config);
+
+/**
+ * 取消日志转发并销毁上传器，未上传的日志被丢弃
+ * @param upload 上传器
+ */
+void log_upload_destroy(log_upload_t *upload);
+
+/**
+ * 取出最早的一批日志，生成上传消息
+ * 已攒的日志超过 flush_interval_ms 未成批时，也会在这里压缩成批；
+ * 可在任意线程调用，不输出日志
+ * @param upload 上传器
+ * @param session_id 会话ID，NULL 时省略该字段
+ * @param buffer 消息缓冲区
+ * @param size 缓冲区大小，至少 LOG_UPLOAD_MESSAGE_MAX
+ * @return 消息长度，暂无可上传的日志返回 0
+ */
+size_t log_upload_next_message(log_upload_t *upload, const char *session_id, char *buffer, size_t size);
+
+/**
+ * 获取上传统计
+ * @param upload 上传器
+ * @param stats 统计信息（输出参数）
+ * @return 成功返回 true
+ */
+bool log_upload_get_stats(log_upload_t *upload, log_upload_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINX_LOG_UPLOAD_H */
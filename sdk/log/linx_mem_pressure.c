@@ -0,0 +1,324 @@
+#include "linx_mem_pressure.h"
+#include "linx_alloc.h"
+#include "linx_log.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct {
+    linx_mem_shrink_fn shrink;      // NULL 表示空槽位
+    void* user_data;
+    int priority;
+    char name[LINX_MEM_PRESSURE_NAME_SIZE];
+} linx_mem_shrinker_slot_t;
+
+typedef struct {
+    linx_mem_pressure_listener_t listener;
+    void* user_data;
+} linx_mem_listener_slot_t;
+
+/* 登记项、配置和统计由 s_mutex 保护；回调在解锁后用副本调用 */
+static pthread_mutex_t s_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_checked = PTHREAD_COND_INITIALIZER;
+static linx_mem_pressure_config_t s_config;
+static linx_mem_shrinker_slot_t s_shrinkers[LINX_MEM_PRESSURE_MAX_SHRINKERS];
+static linx_mem_listener_slot_t s_listeners[LINX_MEM_PRESSURE_MAX_LISTENERS];
+static linx_mem_pressure_stats_t s_stats = { .free_bytes = SIZE_MAX, .min_free_bytes = SIZE_MAX };
+static uint64_t s_next_check_ms;    // 0 表示尚未检查
+static uint64_t s_last_failures;    // 上一次检查时的分配失败次数（仅检查线程访问）
+static bool s_failures_valid;
+static bool s_checking;             // 有线程正在检查（单飞）
+static pthread_t s_checker;
+
+/* 当前档位，音频线程无锁读取 */
+static int s_level = LINX_MEM_PRESSURE_NONE;
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000ull + (uint64_t)ts.tv_nsec / 1000000ull;
+}
+
+/* 调用方持有 s_mutex */
+static uint32_t interval_ms(void) {
+    return s_config.interval_ms ? s_config.interval_ms : LINX_MEM_PRESSURE_DEFAULT_INTERVAL_MS;
+}
+
+/* 按配置读取剩余内存，未知返回 false；config 是检查开始时的副本 */
+static bool read_free_bytes(const linx_mem_pressure_config_t* config, size_t* free_bytes) {
+    if (config->free_bytes) {
+        return config->free_bytes(config->free_bytes_user_data, free_bytes);
+    }
+    if (config->budget_bytes > 0 && linx_alloc_tracking_enabled()) {
+        size_t used = linx_alloc_get_total(NULL);
+        *free_bytes = used < config->budget_bytes ? config->budget_bytes - used : 0;
+        return true;
+    }
+    // 音频路径的小块分配都在片内区域，按它的预算余量判断
+    linx_alloc_region_stats_t region;
+    if (linx_alloc_get_region_stats(LINX_ALLOC_REGION_INTERNAL, &region) && region.budget_bytes > 0) {
+        *free_bytes = region.current_bytes < region.budget_bytes ? region.budget_bytes - region.current_bytes : 0;
+        return true;
+    }
+    return false;
+}
+
+/* 带迟滞的档位判定：解除压力需要剩余超过水位的 9/8 */
+static linx_mem_pressure_level_t classify(const linx_mem_pressure_config_t* config, linx_mem_pressure_level_t current,
+                                          bool known, size_t free_bytes, bool failed) {
+    if (failed) {
+        return LINX_MEM_PRESSURE_CRITICAL;
+    }
+    if (!known || config->low_free_bytes == 0) {
+        return LINX_MEM_PRESSURE_NONE;
+    }
+    size_t critical = config->critical_free_bytes ? config->critical_free_bytes : config->low_free_bytes / 2;
+    size_t low = config->low_free_bytes;
+    if (free_bytes <= critical ||
+        (current == LINX_MEM_PRESSURE_CRITICAL && free_bytes <= critical + critical / 8)) {
+        return LINX_MEM_PRESSURE_CRITICAL;
+    }
+    if (free_bytes <= low || (current != LINX_MEM_PRESSURE_NONE && free_bytes <= low + low / 8)) {
+        return LINX_MEM_PRESSURE_LOW;
+    }
+    return LINX_MEM_PRESSURE_NONE;
+}
+
+static int compare_priority(const void* a, const void* b) {
+    const linx_mem_shrinker_slot_t* x = (const linx_mem_shrinker_slot_t*)a;
+    const linx_mem_shrinker_slot_t* y = (const linx_mem_shrinker_slot_t*)b;
+    return (x->priority > y->priority) - (x->priority < y->priority);
+}
+
+/* 按优先级收缩；LOW 时释放够了就停。返回调用次数，released 输出释放的字节数 */
+static size_t run_shrinkers(linx_mem_shrinker_slot_t* shrinkers, size_t count, linx_mem_pressure_level_t level,
+                            bool known, size_t free_bytes, size_t target, uint64_t* released) {
+    size_t calls = 0;
+    *released = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (level == LINX_MEM_PRESSURE_LOW && known && free_bytes + *released > target) {
+            break;
+        }
+        size_t bytes = shrinkers[i].shrink(shrinkers[i].user_data, level);
+        calls++;
+        *released += bytes;
+        if (bytes > 0) {
+            LOG_INFO("内存压力(%s): %s 释放 %zu 字节", linx_mem_pressure_level_name(level), shrinkers[i].name, bytes);
+        }
+    }
+    return calls;
+}
+
+/* ==================== 配置 ==================== */
+
+bool linx_mem_pressure_configure(const linx_mem_pressure_config_t* config) {
+    linx_mem_pressure_config_t value = {0};
+    if (config) {
+        value = *config;
+    }
+    if (value.critical_free_bytes > value.low_free_bytes) {
+        LOG_ERROR("内存压力水位无效: critical %zu > low %zu", value.critical_free_bytes, value.low_free_bytes);
+        return false;
+    }
+    pthread_mutex_lock(&s_mutex);
+    s_config = value;
+    s_next_check_ms = 0;
+    pthread_mutex_unlock(&s_mutex);
+    return true;
+}
+
+/* ==================== 登记 ==================== */
+
+/* 等待检查线程用完移除前的副本（在检查线程自己的回调中时不等待），调用方持有 s_mutex */
+static void wait_checker_locked(void) {
+    while (s_checking && !pthread_equal(pthread_self(), s_checker)) {
+        pthread_cond_wait(&s_checked, &s_mutex);
+    }
+}
+
+bool linx_mem_pressure_register(const char* name, int priority, linx_mem_shrink_fn shrink, void* user_data) {
+    if (!shrink) {
+        return false;
+    }
+    linx_mem_shrinker_slot_t* slot = NULL;
+    pthread_mutex_lock(&s_mutex);
+    for (size_t i = 0; i < LINX_MEM_PRESSURE_MAX_SHRINKERS; i++) {
+        linx_mem_shrinker_slot_t* s = &s_shrinkers[i];
+        if (s->shrink == shrink && s->user_data == user_data) {
+            slot = s;
+            break;
+        }
+        if (!s->shrink && !slot) {
+            slot = s;
+        }
+    }
+    if (slot) {
+        slot->shrink = shrink;
+        slot->user_data = user_data;
+        slot->priority = priority;
+        snprintf(slot->name, sizeof(slot->name), "%s", name ? name : "");
+    }
+    pthread_mutex_unlock(&s_mutex);
+    return slot != NULL;
+}
+
+void linx_mem_pressure_unregister(linx_mem_shrink_fn shrink, void* user_data) {
+    pthread_mutex_lock(&s_mutex);
+    for (size_t i = 0; i < LINX_MEM_PRESSURE_MAX_SHRINKERS; i++) {
+        if (s_shrinkers[i].shrink == shrink && s_shrinkers[i].user_data == user_data) {
+            memset(&s_shrinkers[i], 0, sizeof(s_shrinkers[i]));
+        }
+    }
+    wait_checker_locked();
+    pthread_mutex_unlock(&s_mutex);
+}
+
+bool linx_mem_pressure_add_listener(linx_mem_pressure_listener_t listener, void* user_data) {
+    if (!listener) {
+        return false;
+    }
+    bool added = false;
+    pthread_mutex_lock(&s_mutex);
+    for (size_t i = 0; i < LINX_MEM_PRESSURE_MAX_LISTENERS && !added; i++) {
+        if (!s_listeners[i].listener) {
+            s_listeners[i].listener = listener;
+            s_listeners[i].user_data = user_data;
+            added = true;
+        }
+    }
+    pthread_mutex_unlock(&s_mutex);
+    return added;
+}
+
+void linx_mem_pressure_remove_listener(linx_mem_pressure_listener_t listener, void* user_data) {
+    pthread_mutex_lock(&s_mutex);
+    for (size_t i = 0; i < LINX_MEM_PRESSURE_MAX_LISTENERS; i++) {
+        if (s_listeners[i].listener == listener && s_listeners[i].user_data == user_data) {
+            s_listeners[i].listener = NULL;
+            s_listeners[i].user_data = NULL;
+        }
+    }
+    wait_checker_locked();
+    pthread_mutex_unlock(&s_mutex);
+}
+
+/* ==================== 检查 ==================== */
+
+linx_mem_pressure_level_t linx_mem_pressure_check(bool force) {
+    uint64_t now = now_ms();
+    pthread_mutex_lock(&s_mutex);
+    linx_mem_pressure_level_t current = (linx_mem_pressure_level_t)s_level;
+    if (s_checking || (!force && s_next_check_ms != 0 && now < s_next_check_ms)) {
+        pthread_mutex_unlock(&s_mutex);
+        return current;
+    }
+    s_checking = true;
+    s_checker = pthread_self();
+    s_next_check_ms = now + interval_ms();
+    linx_mem_pressure_config_t config = s_config;
+    linx_mem_shrinker_slot_t shrinkers[LINX_MEM_PRESSURE_MAX_SHRINKERS];
+    size_t shrinker_count = 0;
+    for (size_t i = 0; i < LINX_MEM_PRESSURE_MAX_SHRINKERS; i++) {
+        if (s_shrinkers[i].shrink) {
+            shrinkers[shrinker_count++] = s_shrinkers[i];
+        }
+    }
+    linx_mem_listener_slot_t listeners[LINX_MEM_PRESSURE_MAX_LISTENERS];
+    memcpy(listeners, s_listeners, sizeof(listeners));
+    pthread_mutex_unlock(&s_mutex);
+
+    // 读剩余内存和失败计数时不持锁：平台堆统计可能要加堆锁
+    size_t free_bytes = SIZE_MAX;
+    bool known = read_free_bytes(&config, &free_bytes);
+    if (!known) {
+        free_bytes = SIZE_MAX;
+    }
+    uint64_t failures = linx_alloc_get_failures();
+    bool failed = s_failures_valid && failures > s_last_failures;
+    s_last_failures = failures;
+    s_failures_valid = true;
+    linx_mem_pressure_level_t level = classify(&config, current, known, free_bytes, failed);
+
+    size_t calls = 0;
+    uint64_t released = 0;
+    if (level != LINX_MEM_PRESSURE_NONE && shrinker_count > 0) {
+        qsort(shrinkers, shrinker_count, sizeof(shrinkers[0]), compare_priority);
+        size_t low = config.low_free_bytes;
+        calls = run_shrinkers(shrinkers, shrinker_count, level, known, free_bytes, low + low / 8, &released);
+    }
+
+    if (level != current) {
+        __atomic_store_n(&s_level, (int)level, __ATOMIC_RELEASE);
+        if (level == LINX_MEM_PRESSURE_NONE) {
+            LOG_INFO("内存压力解除 (剩余 %zu 字节)", free_bytes);
+        } else if (known) {
+            LOG_WARN("内存压力: %s (剩余 %zu 字节%s)", linx_mem_pressure_level_name(level), free_bytes,
+                     failed ? "，出现分配失败" : "");
+        } else {
+            LOG_WARN("内存压力: %s (出现分配失败)", linx_mem_pressure_level_name(level));
+        }
+        for (size_t i = 0; i < LINX_MEM_PRESSURE_MAX_LISTENERS; i++) {
+            if (listeners[i].listener) {
+                listeners[i].listener(listeners[i].user_data, level, free_bytes);
+            }
+        }
+    }
+
+    pthread_mutex_lock(&s_mutex);
+    s_stats.level = level;
+    s_stats.free_bytes = free_bytes;
+    if (known && free_bytes < s_stats.min_free_bytes) {
+        s_stats.min_free_bytes = free_bytes;
+    }
+    s_stats.checks++;
+    if (level > current) {
+        if (level == LINX_MEM_PRESSURE_LOW) {
+            s_stats.low_events++;
+        } else {
+            s_stats.critical_events++;
+        }
+    }
+    s_stats.shrinks += calls;
+    s_stats.released_bytes += released;
+    s_checking = false;
+    pthread_cond_broadcast(&s_checked);
+    pthread_mutex_unlock(&s_mutex);
+    return level;
+}
+
+linx_mem_pressure_level_t linx_mem_pressure_level(void) {
+    return (linx_mem_pressure_level_t)__atomic_load_n(&s_level, __ATOMIC_ACQUIRE);
+}
+
+int linx_mem_pressure_next_timeout_ms(void) {
+    uint64_t now = now_ms();
+    pthread_mutex_lock(&s_mutex);
+    uint64_t next = s_next_check_ms;
+    pthread_mutex_unlock(&s_mutex);
+    if (next <= now) {
+        return 0;
+    }
+    uint64_t wait = next - now;
+    return wait > (uint64_t)INT32_MAX ? INT32_MAX : (int)wait;
+}
+
+void linx_mem_pressure_get_stats(linx_mem_pressure_stats_t* stats) {
+    if (!stats) {
+        return;
+    }
+    pthread_mutex_lock(&s_mutex);
+    *stats = s_stats;
+    pthread_mutex_unlock(&s_mutex);
+    stats->alloc_failures = linx_alloc_get_failures();
+}
+
+const char* linx_mem_pressure_level_name(linx_mem_pressure_level_t level) {
+    switch (level) {
+        case LINX_MEM_PRESSURE_NONE: return "none";
+        case LINX_MEM_PRESSURE_LOW: return "low";
+        case LINX_MEM_PRESSURE_CRITICAL: return "critical";
+    }
+    return "unknown";
+}
@@ -0,0 +1,161 @@
+#ifndef LINX_MEM_PRESSURE_H
+#define LINX_MEM_PRESSURE_H
+
+/*
+ * 内存压力检查
+ *
+ * 小内存板子上缓存（句子缓存、MCP 工具列表、画面解释的答案等）会一直涨到预算上限，
+ * 等到音频路径的分配失败才发现内存不够就晚了。本模块定期比较剩余内存和两条水位，
+ * 低于水位时按优先级从低到高调用各模块登记的收缩回调，让它们先释放可以重建的缓存：
+ *
+ *   剩余 <= low_free_bytes       LOW：逐个收缩，直到释放量使剩余回到 low 水位以上
+ *   剩余 <= critical_free_bytes  CRITICAL：调用全部收缩回调
+ *   出现新的分配失败              CRITICAL（linx_alloc_get_failures() 增加）
+ *
+ * 剩余内存依次取自：config.free_bytes 回调（平台堆统计，如 heap_caps_get_free_size()）、
+ * budget_bytes 减去跟踪分配器的总占用（需 linx_alloc_tracking_enable()）、放置分配器
+ * 片内区域的预算余量；都没有时只按分配失败判断。压力解除需要剩余超过水位的 9/8，
+ * 避免在水位附近来回切换。
+ *
+ * 全局只有一份状态，全部函数可在任意线程调用。检查是单飞的：另一个线程正在检查时
+ * 直接返回当前档位。收缩回调和监听者在执行检查的线程上、不持有内部锁时调用，可以
+ * 释放内存和加自己的锁；回调中不能调用 linx_mem_pressure_check() 或移除别的登记项。
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 登记项上限 */
+#define LINX_MEM_PRESSURE_MAX_SHRINKERS 16
+#define LINX_MEM_PRESSURE_MAX_LISTENERS 4
+#define LINX_MEM_PRESSURE_NAME_SIZE 24
+
+/* 默认检查周期（毫秒） */
+#define LINX_MEM_PRESSURE_DEFAULT_INTERVAL_MS 1000
+
+/* 收缩优先级：数值小的先收缩，丢掉后代价小的缓存用小数值 */
+#define LINX_MEM_PRESSURE_PRIORITY_RESULTS 10   // 可重新计算的结果（工具列表、画面解释答案）
+#define LINX_MEM_PRESSURE_PRIORITY_MEDIA 20     // 可重新下载的媒体（句子缓存）
+#define LINX_MEM_PRESSURE_PRIORITY_AUDIO 30     // 音频路径的备用缓冲，最后收缩
+
+/* 压力档位 */
+typedef enum {
+    LINX_MEM_PRESSURE_NONE = 0,
+    LINX_MEM_PRESSURE_LOW,
+    LINX_MEM_PRESSURE_CRITICAL
+} linx_mem_pressure_level_t;
+
+/**
+ * 收缩回调
+ * @param level 当前档位（LOW 或 CRITICAL），CRITICAL 时应释放全部可重建的内存
+ * @return 释放的字节数（估计值即可）；推迟到其他线程释放的返回 0
+ */
+typedef size_t (*linx_mem_shrink_fn)(void* user_data, linx_mem_pressure_level_t level);
+
+/**
+ * 档位变化的监听者
+ * @param free_bytes 本次检查的剩余内存，未知为 SIZE_MAX
+ */
+typedef void (*linx_mem_pressure_listener_t)(void* user_data, linx_mem_pressure_level_t level, size_t free_bytes);
+
+/**
+ * 剩余内存来源
+ * @return 成功返回 true 并写入 free_bytes
+ */
+typedef bool (*linx_mem_free_fn)(void* user_data, size_t* free_bytes);
+
+/* 配置（字段为 0 时使用默认值） */
+typedef struct {
+    size_t low_free_bytes;          // LOW 水位，0 不检查水位（只按分配失败判断）
+    size_t critical_free_bytes;     // CRITICAL 水位，默认 low_free_bytes / 2，须不大于 low_free_bytes
+    size_t budget_bytes;            // 没有 free_bytes 回调时，跟踪分配器总占用的预算
+    uint32_t interval_ms;           // 检查周期，默认 1000
+    linx_mem_free_fn free_bytes;    // 平台堆统计，NULL 按 budget_bytes 或区域预算计算
+    void* free_bytes_user_data;
+} linx_mem_pressure_config_t;
+
+/* 统计 */
+typedef struct {
+    linx_mem_pressure_level_t level;    // 当前档位
+    size_t free_bytes;                  // 最近一次检查的剩余内存，未知为 SIZE_MAX
+    size_t min_free_bytes;              // 检查到的最低剩余内存，未知为 SIZE_MAX
+    uint64_t checks;                    // 检查次数
+    uint64_t low_events;                // 进入 LOW 的次数
+    uint64_t critical_events;           // 进入 CRITICAL 的次数
+    uint64_t shrinks;                   // 收缩回调的调用次数
+    uint64_t released_bytes;            // 收缩回调报告释放的字节数
+    uint64_t alloc_failures;            // 分配失败次数（同 linx_alloc_get_failures()）
+} linx_mem_pressure_stats_t;
+
+/**
+ * 设置水位（可重复调用，下一次检查生效）
+ * @param config 配置，NULL 恢复为只按分配失败判断
+ * @return 成功返回 true；critical_free_bytes 大于 low_free_bytes 返回 false
+ */
+bool linx_mem_pressure_configure(const linx_mem_pressure_config_t* config);
+
+/**
+ * 登记收缩回调，同一 (shrink, user_data) 重复登记时更新名称和优先级
+ * @param name 日志中的名称
+ * @param priority 收缩顺序，见 LINX_MEM_PRESSURE_PRIORITY_*
+ * @return 已登记返回 true，登记项已满返回 false
+ */
+bool linx_mem_pressure_register(const char* name, int priority, linx_mem_shrink_fn shrink, void* user_data);
+
+/**
+ * 移除收缩回调，返回后回调不再被调用（正在进行的回调已经返回；回调中移除自己时不等待）
+ */
+void linx_mem_pressure_unregister(linx_mem_shrink_fn shrink, void* user_data);
+
+/**
+ * 登记档位变化的监听者
+ * @return 已登记返回 true，监听者已满返回 false
+ */
+bool linx_mem_pressure_add_listener(linx_mem_pressure_listener_t listener, void* user_data);
+
+/**
+ * 移除监听者，返回后回调不再被调用（与 linx_mem_pressure_unregister() 相同的等待规则）
+ */
+void linx_mem_pressure_remove_listener(linx_mem_pressure_listener_t listener, void* user_data);
+
+/**
+ * 检查一次：到了检查周期（或 force）时读剩余内存、判定档位，有压力时调用收缩回调，
+ * 档位变化时通知监听者
+ *
+ * 通常在事件循环的每次迭代中调用，未到检查周期时只比较一次时间。
+ *
+ * @param force 不等检查周期（例如刚遇到分配失败）
+ * @return 检查后的档位
+ */
+linx_mem_pressure_level_t linx_mem_pressure_check(bool force);
+
+/**
+ * 当前档位（只读一次原子变量，音频线程可以调用）
+ */
+linx_mem_pressure_level_t linx_mem_pressure_level(void);
+
+/**
+ * 距下一次检查的时间（毫秒），用作事件循环的等待上限
+ */
+int linx_mem_pressure_next_timeout_ms(void);
+
+/**
+ * 获取统计
+ */
+void linx_mem_pressure_get_stats(linx_mem_pressure_stats_t* stats);
+
+/**
+ * 档位名称（"none" / "low" / "critical"）
+ */
+const char* linx_mem_pressure_level_name(linx_mem_pressure_level_t level);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINX_MEM_PRESSURE_H */
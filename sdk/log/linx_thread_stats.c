@@ -0,0 +1,343 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE             /* pthread_getattr_np */
+#endif
+
+#include "linx_thread_stats.h"
+#include "linx_log.h"
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#if defined(__APPLE__)
+#include <mach/mach.h>
+#elif defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+LINX_LOG_TAG_DEFINE(s_thread_stats_log, "LINX_THREAD");
+
+/* 栈填充标记字 */
+#define LINX_THREAD_STATS_PATTERN 0x5A17C0DEu
+
+/* 填充时在当前栈帧下方保留的字节数，留给 painting 本身和信号处理 */
+#define LINX_THREAD_STATS_PAINT_MARGIN 4096
+
+/* 栈底保留不填充的字节数（部分平台把保护页算在栈内） */
+#define LINX_THREAD_STATS_PAINT_FLOOR 256
+
+typedef struct {
+    bool used;                      // 槽位已分配
+    linx_thread_stats_t stats;      // 对外数据；alive 时 stack_used/cpu 在统计时刷新
+    uint8_t* stack_top;             // 栈最高地址（栈向下生长）
+    uint32_t* paint_low;            // 填充范围 [paint_low, paint_high)
+    uint32_t* paint_high;
+    uint64_t registered_us;         // 登记时刻
+    uint64_t exited_us;             // 注销时刻
+    uint64_t window_cpu_base_us;    // 窗口开始时的 CPU 时间
+    uint64_t window_start_us;       // 本线程的窗口起点
+    uint64_t sequence;              // 登记序号，复用槽位时淘汰最早退出的
+#if defined(__APPLE__)
+    mach_port_t port;
+#elif defined(__linux__)
+    clockid_t clock;
+    bool has_clock;
+#endif
+} linx_thread_slot_t;
+
+static const char* s_stage_names[LINX_THREAD_STAGE_COUNT] = {
+    "network", "dispatch", "playback", "capture", "mcp", "log", "ui", "other"
+};
+
+/* 槽位由 g_slots_mutex 保护 */
+static pthread_mutex_t g_slots_mutex = PTHREAD_MUTEX_INITIALIZER;
+static linx_thread_slot_t g_slots[LINX_THREAD_STATS_MAX_THREADS];
+static uint64_t g_sequence = 0;
+static uint64_t g_window_start_us = 0;
+static bool g_enabled = false;
+
+static __thread int t_slot = -1;
+
+static uint64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ull + (uint64_t)ts.tv_nsec / 1000ull;
+}
+
+/* ==================== 平台相关 ==================== */
+
+static bool is_main_thread(void) {
+#if defined(__APPLE__)
+    return pthread_main_np() != 0;
+#elif defined(__linux__)
+    return (pid_t)syscall(SYS_gettid) == getpid();
+#else
+    return false;
+#endif
+}
+
+/* 当前线程的栈范围 [low, low + size) */
+static bool current_stack_bounds(uint8_t** low, size_t* size) {
+#if defined(__APPLE__)
+    pthread_t self = pthread_self();
+    uint8_t* high = (uint8_t*)pthread_get_stackaddr_np(self);
+    *size = pthread_get_stacksize_np(self);
+    *low = high - *size;
+    return *size > 0;
+#elif defined(__linux__)
+    pthread_attr_t attr;
+    void* addr = NULL;
+    if (pthread_getattr_np(pthread_self(), &attr) != 0) {
+        return false;
+    }
+    int result = pthread_attr_getstack(&attr, &addr, size);
+    pthread_attr_destroy(&attr);
+    *low = (uint8_t*)addr;
+    return result == 0 && *size > 0;
+#else
+    (void)low;
+    (void)size;
+    return false;
+#endif
+}
+
+static void slot_init_clock(linx_thread_slot_t* slot) {
+#if defined(__APPLE__)
+    slot->port = pthread_mach_thread_np(pthread_self());
+#elif defined(__linux__)
+    slot->has_clock = pthread_getcpuclockid(pthread_self(), &slot->clock) == 0;
+#else
+    (void)slot;
+#endif
+}
+
+/* 读取槽位线程的 CPU 时间；线程必须仍在运行（调用者持锁，线程注销前会等锁） */
+static uint64_t slot_read_cpu_us(const linx_thread_slot_t* slot) {
+#if defined(__APPLE__)
+    thread_basic_info_data_t info;
+    mach_msg_type_number_t count = THREAD_BASIC_INFO_COUNT;
+    if (thread_info(slot->port, THREAD_BASIC_INFO, (thread_info_t)&info, &count) != KERN_SUCCESS) {
+        return slot->stats.cpu_us;
+    }
+    return (uint64_t)(info.user_time.seconds + info.system_time.seconds) * 1000000ull +
+           (uint64_t)(info.user_time.microseconds + info.system_time.microseconds);
+#elif defined(__linux__)
+    struct timespec ts;
+    if (!slot->has_clock || clock_gettime(slot->clock, &ts) != 0) {
+        return slot->stats.cpu_us;
+    }
+    return (uint64_t)ts.tv_sec * 1000000ull + (uint64_t)ts.tv_nsec / 1000ull;
+#else
+    return slot->stats.cpu_us;
+#endif
+}
+
+/* ==================== 栈高水位 ==================== */
+
+/* 填充当前栈帧以下的未用部分；不能内联，保证 marker 位于调用者栈帧之下 */
+static __attribute__((noinline)) void slot_paint_stack(linx_thread_slot_t* slot, uint8_t* low) {
+    volatile uint8_t marker = 0;
+    uintptr_t sp = (uintptr_t)&marker;
+    uintptr_t floor = (uintptr_t)low + LINX_THREAD_STATS_PAINT_FLOOR;
+    if (sp <= floor + LINX_THREAD_STATS_PAINT_MARGIN) {
+        return;
+    }
+
+    uintptr_t high = (sp - LINX_THREAD_STATS_PAINT_MARGIN) & ~(uintptr_t)3;
+    uintptr_t start = high - floor > LINX_THREAD_STATS_PAINT_MAX ? high - LINX_THREAD_STATS_PAINT_MAX : floor;
+    volatile uint32_t* word = (volatile uint32_t*)((start + 3) & ~(uintptr_t)3);
+    volatile uint32_t* end = (volatile uint32_t*)high;
+
+    slot->paint_low = (uint32_t*)word;
+    slot->paint_high = (uint32_t*)end;
+    while (word < end) {
+        *word++ = LINX_THREAD_STATS_PATTERN;
+    }
+}
+
+/* 从填充范围底部向上找第一个被改写的字 */
+static void slot_scan_stack(linx_thread_slot_t* slot) {
+    if (!slot->paint_low || slot->paint_low >= slot->paint_high) {
+        return;
+    }
+
+    const volatile uint32_t* word = slot->paint_low;
+    while (word < slot->paint_high && *word == LINX_THREAD_STATS_PATTERN) {
+        word++;
+    }
+    slot->stats.stack_saturated = word == slot->paint_low;
+    size_t used = (size_t)(slot->stack_top - (const uint8_t*)word);
+    if (used > slot->stats.stack_used) {
+        slot->stats.stack_used = used;
+    }
+}
+
+/* 刷新存活线程的栈和 CPU 数据（调用者持锁） */
+static void slot_refresh(linx_thread_slot_t* slot, uint64_t now) {
+    if (!slot->stats.alive) {
+        return;
+    }
+    slot_scan_stack(slot);
+    slot->stats.cpu_us = slot_read_cpu_us(slot);
+    slot->stats.window_cpu_us = slot->stats.cpu_us - slot->window_cpu_base_us;
+    slot->stats.window_us = now - slot->window_start_us;
+}
+
+/* ==================== 接口 ==================== */
+
+void linx_thread_stats_enable(void) {
+    pthread_mutex_lock(&g_slots_mutex);
+    if (!g_enabled) {
+        g_window_start_us = now_us();
+    }
+    __atomic_store_n(&g_enabled, true, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&g_slots_mutex);
+}
+
+bool linx_thread_stats_enabled(void) {
+    return __atomic_load_n(&g_enabled, __ATOMIC_ACQUIRE);
+}
+
+bool linx_thread_stats_register(const char* name, linx_thread_stage_t stage) {
+    if (!linx_thread_stats_enabled() || t_slot >= 0) {
+        return t_slot >= 0;
+    }
+
+    pthread_mutex_lock(&g_slots_mutex);
+    // 优先使用空槽位，其次复用最早登记的已退出线程
+    int index = -1;
+    for (int i = 0; i < LINX_THREAD_STATS_MAX_THREADS; i++) {
+        if (!g_slots[i].used) {
+            index = i;
+            break;
+        }
+        if (!g_slots[i].stats.alive && (index < 0 || g_slots[i].sequence < g_slots[index].sequence)) {
+            index = i;
+        }
+    }
+    if (index < 0) {
+        pthread_mutex_unlock(&g_slots_mutex);
+        return false;
+    }
+
+    linx_thread_slot_t* slot = &g_slots[index];
+    memset(slot, 0, sizeof(*slot));
+    slot->used = true;
+    slot->sequence = ++g_sequence;
+    strncpy(slot->stats.name, name ? name : "thread", sizeof(slot->stats.name) - 1);
+    slot->stats.stage = stage < LINX_THREAD_STAGE_COUNT ? stage : LINX_THREAD_STAGE_OTHER;
+    slot->stats.alive = true;
+    slot->registered_us = now_us();
+    slot->window_start_us = slot->registered_us > g_window_start_us ? slot->registered_us : g_window_start_us;
+    slot_init_clock(slot);
+
+    uint8_t* low = NULL;
+    size_t size = 0;
+    if (current_stack_bounds(&low, &size)) {
+        slot->stack_top = low + size;
+        slot->stats.stack_size = size;
+        if (!is_main_thread()) {
+            slot_paint_stack(slot, low);
+        }
+    }
+    t_slot = index;
+    pthread_mutex_unlock(&g_slots_mutex);
+    return true;
+}
+
+void linx_thread_stats_unregister(void) {
+    if (t_slot < 0) {
+        return;
+    }
+
+    pthread_mutex_lock(&g_slots_mutex);
+    linx_thread_slot_t* slot = &g_slots[t_slot];
+    uint64_t now = now_us();
+    slot_refresh(slot, now);
+    slot->stats.alive = false;
+    slot->exited_us = now;
+    slot->paint_low = slot->paint_high = NULL;
+    pthread_mutex_unlock(&g_slots_mutex);
+    t_slot = -1;
+}
+
+void linx_thread_stats_window_begin(void) {
+    pthread_mutex_lock(&g_slots_mutex);
+    uint64_t now = now_us();
+    g_window_start_us = now;
+    for (int i = 0; i < LINX_THREAD_STATS_MAX_THREADS; i++) {
+        linx_thread_slot_t* slot = &g_slots[i];
+        if (!slot->used || !slot->stats.alive) {
+            continue;
+        }
+        slot->window_cpu_base_us = slot_read_cpu_us(slot);
+        slot->window_start_us = now;
+        slot->stats.window_cpu_us = 0;
+        slot->stats.window_us = 0;
+    }
+    pthread_mutex_unlock(&g_slots_mutex);
+}
+
+size_t linx_thread_stats_get(linx_thread_stats_t* stats, size_t max_threads) {
+    if (!stats || max_threads == 0) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&g_slots_mutex);
+    uint64_t now = now_us();
+    // 按登记序号输出
+    size_t count = 0;
+    uint64_t last = 0;
+    while (count < max_threads) {
+        int next = -1;
+        for (int i = 0; i < LINX_THREAD_STATS_MAX_THREADS; i++) {
+            if (g_slots[i].used && g_slots[i].sequence > last &&
+                (next < 0 || g_slots[i].sequence < g_slots[next].sequence)) {
+                next = i;
+            }
+        }
+        if (next < 0) {
+            break;
+        }
+        slot_refresh(&g_slots[next], now);
+        stats[count++] = g_slots[next].stats;
+        last = g_slots[next].sequence;
+    }
+    pthread_mutex_unlock(&g_slots_mutex);
+    return count;
+}
+
+void linx_thread_stats_clear_exited(void) {
+    pthread_mutex_lock(&g_slots_mutex);
+    for (int i = 0; i < LINX_THREAD_STATS_MAX_THREADS; i++) {
+        if (g_slots[i].used && !g_slots[i].stats.alive) {
+            g_slots[i].used = false;
+        }
+    }
+    pthread_mutex_unlock(&g_slots_mutex);
+}
+
+const char* linx_thread_stage_name(linx_thread_stage_t stage) {
+    if ((int)stage < 0 || stage >= LINX_THREAD_STAGE_COUNT) {
+        return "unknown";
+    }
+    return s_stage_names[stage];
+}
+
+void linx_thread_stats_dump(void) {
+    if (!linx_thread_stats_enabled()) {
+        LINX_LOGI(s_thread_stats_log, "thread stats are not enabled");
+        return;
+    }
+
+    // 先复制再输出：异步日志线程自己也登记在内，不能在持锁时写日志
+    linx_thread_stats_t stats[LINX_THREAD_STATS_MAX_THREADS];
+    size_t count = linx_thread_stats_get(stats, LINX_THREAD_STATS_MAX_THREADS);
+    LINX_LOGI(s_thread_stats_log, "%-20s %-9s %10s %10s %8s", "thread", "stage", "stack", "stack_used", "cpu(%)");
+    for (size_t i = 0; i < count; i++) {
+        double cpu = stats[i].window_us > 0 ? (double)stats[i].window_cpu_us * 100.0 / (double)stats[i].window_us : 0.0;
+        LINX_LOGI(s_thread_stats_log, "%-20s %-9s %10zu %9zu%s %8.1f%s", stats[i].name,
+                  linx_thread_stage_name(stats[i].stage), stats[i].stack_size, stats[i].stack_used,
+                  stats[i].stack_saturated ? "+" : " ", cpu, stats[i].alive ? "" : " (exited)");
+    }
+}
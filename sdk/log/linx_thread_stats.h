@@ -0,0 +1,127 @@
+#ifndef LINX_THREAD_STATS_H
+#define LINX_THREAD_STATS_H
+
+/*
+ * SDK 线程资源统计
+ *
+ * SDK 创建的每个线程（事件循环、派发、播放、后台任务执行器、异步日志）启动时登记、
+ * 退出前注销，统计每个线程的栈高水位和 CPU 时间，用于评估某块板子的栈和算力
+ * 能否承担一组功能。应用自己的采集/编码线程也可以登记。
+ *
+ * 栈高水位：登记时在本线程栈的未用部分填充标记字，统计时从栈底向上找到第一个
+ * 被改写的字。填充范围最多 LINX_THREAD_STATS_PAINT_MAX 字节，用量超出时只能给出
+ * 下限（stack_saturated）。主线程不填充。
+ *
+ * CPU：按线程读取 CPU 时钟（Linux pthread_getcpuclockid，macOS thread_info），
+ * linx_thread_stats_window_begin() 开始一个统计窗口，窗口内的 CPU 时间除以窗口
+ * 长度即该线程的稳态占用。
+ *
+ * 统计默认关闭，linx_thread_stats_enable() 之后创建的线程才会登记；
+ * 其他平台上登记照常，但栈和 CPU 数据为 0。
+ *
+ * 使用约束：
+ * - 登记过的线程必须在退出前调用 linx_thread_stats_unregister()，
+ *   退出后线程栈可能被回收，统计时不能再读取
+ * - 已退出线程的最后一次数据会保留，直到槽位被复用或调用 linx_thread_stats_clear_exited()
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 线程所属的流水线阶段 */
+typedef enum {
+    LINX_THREAD_STAGE_NETWORK = 0,  // 事件循环：WebSocket 收发、协议解析、同步回调
+    LINX_THREAD_STAGE_DISPATCH,     // 事件派发线程：队列模式下的应用回调
+    LINX_THREAD_STAGE_PLAYBACK,     // 播放线程：抖动缓冲、解码、写音频设备
+    LINX_THREAD_STAGE_CAPTURE,      // 采集与编码（应用线程登记）
+    LINX_THREAD_STAGE_MCP,          // MCP 工具与后台任务执行器（linx_executor）
+    LINX_THREAD_STAGE_LOG,          // 异步日志
+    LINX_THREAD_STAGE_UI,           // LVGL 界面线程
+    LINX_THREAD_STAGE_OTHER,        // 其他
+    LINX_THREAD_STAGE_COUNT
+} linx_thread_stage_t;
+
+/* 最多同时统计的线程数（含已退出的） */
+#define LINX_THREAD_STATS_MAX_THREADS 64
+
+/* 每个线程最多填充的栈字节数 */
+#define LINX_THREAD_STATS_PAINT_MAX (256 * 1024)
+
+/* 线程名最大长度（含结尾 '\0'） */
+#define LINX_THREAD_STATS_NAME_SIZE 24
+
+/* 线程统计 */
+typedef struct {
+    char name[LINX_THREAD_STATS_NAME_SIZE]; // 登记时的名称
+    linx_thread_stage_t stage;      // 流水线阶段
+    bool alive;                     // 尚未注销
+    size_t stack_size;              // 栈大小（字节），未知为 0
+    size_t stack_used;              // 栈高水位（字节）
+    bool stack_saturated;           // 用量超出填充范围，stack_used 只是下限
+    uint64_t cpu_us;                // 从线程启动起累计的 CPU 时间
+    uint64_t window_cpu_us;         // 当前统计窗口内的 CPU 时间
+    uint64_t window_us;             // 窗口长度：从窗口开始（或线程登记）到现在（或线程注销）
+} linx_thread_stats_t;
+
+/**
+ * 打开统计，之后登记的线程才会被跟踪
+ */
+void linx_thread_stats_enable(void);
+
+/**
+ * 统计是否已打开
+ */
+bool linx_thread_stats_enabled(void);
+
+/**
+ * 登记当前线程，在线程入口处调用
+ * @param name 线程名，超长截断
+ * @param stage 流水线阶段
+ * @return 已登记返回 true；统计未打开或槽位已满返回 false
+ */
+bool linx_thread_stats_register(const char* name, linx_thread_stage_t stage);
+
+/**
+ * 注销当前线程并保存最后的栈和 CPU 数据，未登记时无操作
+ */
+void linx_thread_stats_unregister(void);
+
+/**
+ * 开始新的统计窗口（如会话建立、进入稳态后）
+ */
+void linx_thread_stats_window_begin(void);
+
+/**
+ * 获取所有线程的统计，按登记顺序
+ * @param stats 输出数组
+ * @param max_threads 数组容量
+ * @return 写入的条目数
+ */
+size_t linx_thread_stats_get(linx_thread_stats_t* stats, size_t max_threads);
+
+/**
+ * 丢弃已退出线程的数据
+ */
+void linx_thread_stats_clear_exited(void);
+
+/**
+ * 获取阶段名
+ * @return 阶段名，越界返回 "unknown"
+ */
+const char* linx_thread_stage_name(linx_thread_stage_t stage);
+
+/**
+ * 以 INFO 级别输出每个线程的栈高水位和窗口内 CPU 占用
+ */
+void linx_thread_stats_dump(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINX_THREAD_STATS_H */
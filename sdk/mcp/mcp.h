@@ -10,9 +10,13 @@
  */
 
 #include "mcp_types.h"      // MCP类型定义
+#include "mcp_buffer.h"     // 共享数据缓冲区
 #include "mcp_utils.h"      // MCP工具函数
 #include "mcp_property.h"   // MCP属性管理
+#include "mcp_arguments.h"  // MCP工具调用参数视图
 #include "mcp_tool.h"       // MCP工具管理
+#include "mcp_static_tool.h" // 编译期声明的静态工具
+#include "mcp_state_sync.h" // 状态增量同步
 #include "mcp_server.h"     // MCP服务器实现
 #include "../log/linx_log.h" // 日志模块
 
@@ -55,6 +59,14 @@ extern "C" {
 #define MCP_PROPERTY_INT_RANGE_REQUIRED(name, min_val, max_val) \
     mcp_property_create_integer(name, 0, false, true, min_val, max_val)
 
+/* 创建浮点数类型属性（带默认值） */
+#define MCP_PROPERTY_NUMBER(name, default_val) \
+    mcp_property_create_number(name, default_val, true)
+
+/* 创建必需的浮点数类型属性（无默认值） */
+#define MCP_PROPERTY_NUMBER_REQUIRED(name) \
+    mcp_property_create_number(name, 0.0, false)
+
 /* 创建字符串类型属性（带默认值） */
 #define MCP_PROPERTY_STRING(name, default_val) \
     mcp_property_create_string(name, default_val, true)
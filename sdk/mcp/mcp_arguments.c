@@ -0,0 +1,175 @@
+/*
+ * MCP工具调用参数视图实现文件
+ * 实现 arguments 的一次性校验和类型化只读访问
+ */
+
+#include "mcp_arguments.h"
+#include "../log/linx_log.h"
+#include <math.h>
+#include <limits.h>
+#include <stdio.h>
+
+/* 2^63，int64_t 能表示的数值上界（不含） */
+#define MCP_INT64_LIMIT 9223372036854775808.0
+
+/**
+ * 查找参数节点（区分大小写）
+ */
+static const cJSON* mcp_arguments_find(const mcp_arguments_t* args, const char* name) {
+    if (!args || !args->json || !name) {
+        return NULL;
+    }
+    return cJSON_GetObjectItemCaseSensitive(args->json, name);
+}
+
+/**
+ * 查找声明了默认值的参数
+ */
+static const mcp_property_t* mcp_arguments_default(const mcp_arguments_t* args, const char* name) {
+    if (!args || !args->schema) {
+        return NULL;
+    }
+    const mcp_property_t* prop = mcp_property_list_find(args->schema, name);
+    return prop && prop->has_default_value ? prop : NULL;
+}
+
+/**
+ * 数值是否为整数
+ */
+static bool mcp_number_is_integral(double value) {
+    return isfinite(value) && floor(value) == value;
+}
+
+static void mcp_arguments_set_error(char* error, size_t error_size, const char* format, const char* name) {
+    if (error && error_size > 0) {
+        snprintf(error, error_size, format, name);
+    }
+}
+
+/**
+ * 按声明的参数校验 arguments
+ */
+bool mcp_arguments_validate(const cJSON* arguments, const mcp_property_list_t* schema,
+                            char* error, size_t error_size) {
+    if (arguments && !cJSON_IsObject(arguments)) {
+        mcp_arguments_set_error(error, error_size, "%s must be an object", "arguments");
+        return false;
+    }
+    if (!schema) {
+        return true;
+    }
+    
+    for (size_t i = 0; i < schema->count; i++) {
+        const mcp_property_t* prop = &schema->properties[i];
+        const cJSON* item = arguments ? cJSON_GetObjectItemCaseSensitive(arguments, prop->name) : NULL;
+        
+        if (!item) {
+            if (!prop->has_default_value) {
+                mcp_arguments_set_error(error, error_size, "Missing required argument: %s", prop->name);
+                return false;
+            }
+            continue;
+        }
+        
+        switch (prop->type) {
+            case MCP_PROPERTY_TYPE_BOOLEAN:
+                if (!cJSON_IsBool(item)) {
+                    mcp_arguments_set_error(error, error_size, "Argument '%s' must be a boolean", prop->name);
+                    return false;
+                }
+                break;
+                
+            case MCP_PROPERTY_TYPE_INTEGER:
+                if (!cJSON_IsNumber(item) || !mcp_number_is_integral(item->valuedouble) ||
+                    item->valuedouble < (double)INT_MIN || item->valuedouble > (double)INT_MAX) {
+                    mcp_arguments_set_error(error, error_size, "Argument '%s' must be an integer", prop->name);
+                    return false;
+                }
+                if (prop->has_range && (item->valuedouble < prop->min_value || item->valuedouble > prop->max_value)) {
+                    mcp_arguments_set_error(error, error_size, "Argument '%s' is out of range", prop->name);
+                    return false;
+                }
+                break;
+                
+            case MCP_PROPERTY_TYPE_NUMBER:
+                if (!cJSON_IsNumber(item)) {
+                    mcp_arguments_set_error(error, error_size, "Argument '%s' must be a number", prop->name);
+                    return false;
+                }
+                break;
+                
+            case MCP_PROPERTY_TYPE_STRING:
+                if (!cJSON_IsString(item)) {
+                    mcp_arguments_set_error(error, error_size, "Argument '%s' must be a string", prop->name);
+                    return false;
+                }
+                break;
+        }
+    }
+    
+    return true;
+}
+
+bool mcp_arguments_has(const mcp_arguments_t* args, const char* name) {
+    return mcp_arguments_find(args, name) != NULL;
+}
+
+bool mcp_arguments_get_bool(const mcp_arguments_t* args, const char* name, bool fallback) {
+    const cJSON* item = mcp_arguments_find(args, name);
+    if (item && cJSON_IsBool(item)) {
+        return cJSON_IsTrue(item);
+    }
+    const mcp_property_t* prop = mcp_arguments_default(args, name);
+    return prop && prop->type == MCP_PROPERTY_TYPE_BOOLEAN ? prop->value.bool_val : fallback;
+}
+
+int mcp_arguments_get_int(const mcp_arguments_t* args, const char* name, int fallback) {
+    const cJSON* item = mcp_arguments_find(args, name);
+    if (item && cJSON_IsNumber(item) && mcp_number_is_integral(item->valuedouble) &&
+        item->valuedouble >= (double)INT_MIN && item->valuedouble <= (double)INT_MAX) {
+        return (int)item->valuedouble;
+    }
+    const mcp_property_t* prop = mcp_arguments_default(args, name);
+    return prop && prop->type == MCP_PROPERTY_TYPE_INTEGER ? prop->value.int_val : fallback;
+}
+
+int64_t mcp_arguments_get_int64(const mcp_arguments_t* args, const char* name, int64_t fallback) {
+    const cJSON* item = mcp_arguments_find(args, name);
+    if (item && cJSON_IsNumber(item) && mcp_number_is_integral(item->valuedouble) &&
+        item->valuedouble >= -MCP_INT64_LIMIT && item->valuedouble < MCP_INT64_LIMIT) {
+        return (int64_t)item->valuedouble;
+    }
+    const mcp_property_t* prop = mcp_arguments_default(args, name);
+    return prop && prop->type == MCP_PROPERTY_TYPE_INTEGER ? (int64_t)prop->value.int_val : fallback;
+}
+
+double mcp_arguments_get_double(const mcp_arguments_t* args, const char* name, double fallback) {
+    const cJSON* item = mcp_arguments_find(args, name);
+    if (item && cJSON_IsNumber(item)) {
+        return item->valuedouble;
+    }
+    const mcp_property_t* prop = mcp_arguments_default(args, name);
+    if (prop && (prop->type == MCP_PROPERTY_TYPE_NUMBER || prop->type == MCP_PROPERTY_TYPE_INTEGER)) {
+        return mcp_property_get_number_value(prop);
+    }
+    return fallback;
+}
+
+const char* mcp_arguments_get_string(const mcp_arguments_t* args, const char* name, const char* fallback) {
+    const cJSON* item = mcp_arguments_find(args, name);
+    if (item && cJSON_IsString(item)) {
+        return item->valuestring;
+    }
+    const mcp_property_t* prop = mcp_arguments_default(args, name);
+    return prop && prop->type == MCP_PROPERTY_TYPE_STRING && prop->value.string_val ? prop->value.string_val : fallback;
+}
+
+const cJSON* mcp_arguments_get_array(const mcp_arguments_t* args, const char* name) {
+    const cJSON* item = mcp_arguments_find(args, name);
+    return item && cJSON_IsArray(item) ? item : NULL;
+}
+
+const cJSON* mcp_arguments_get_object(const mcp_arguments_t* args, const char* name) {
+    const cJSON* item = mcp_arguments_find(args, name);
+    return item && cJSON_IsObject(item) ? item : NULL;
+}
@@ -0,0 +1,90 @@
+/*
+ * MCP工具调用参数视图头文件
+ * 在 tools/call 的 arguments 对象上提供只读的类型化访问，避免逐个转换为属性
+ */
+
+#ifndef MCP_ARGUMENTS_H
+#define MCP_ARGUMENTS_H
+
+#include "mcp_types.h"      // MCP类型定义
+#include "mcp_property.h"   // 工具声明的参数
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 参数视图：只在工具回调执行期间有效 */
+typedef struct mcp_arguments {
+    const cJSON* json;                  // arguments 对象，未传参数时为NULL
+    const mcp_property_list_t* schema;  // 工具声明的参数，提供缺省值，可以为NULL
+} mcp_arguments_t;
+
+/**
+ * 按工具声明的参数校验 arguments（服务器在调用回调前执行一次）
+ * 已声明的参数必须类型匹配，整数需在取值范围内，无默认值的参数必须出现；
+ * 未声明的参数原样保留
+ * @param arguments 参数JSON对象，可以为NULL
+ * @param schema 工具声明的参数，可以为NULL
+ * @param error 校验失败时写入错误信息，可以为NULL
+ * @param error_size error 缓冲区大小
+ * @return 校验通过返回true
+ */
+bool mcp_arguments_validate(const cJSON* arguments, const mcp_property_list_t* schema,
+                            char* error, size_t error_size);
+
+/**
+ * 参数是否出现在 arguments 中
+ * @param args 参数视图
+ * @param name 参数名称
+ * @return 出现返回true
+ */
+bool mcp_arguments_has(const mcp_arguments_t* args, const char* name);
+
+/**
+ * 读取布尔参数
+ * 参数缺失或类型不符时依次使用声明的默认值、fallback，以下访问函数相同
+ * @param args 参数视图
+ * @param name 参数名称
+ * @param fallback 无法取值时的返回值
+ * @return 参数值
+ */
+bool mcp_arguments_get_bool(const mcp_arguments_t* args, const char* name, bool fallback);
+
+/**
+ * 读取整数参数（必须是 int 范围内的整数值）
+ */
+int mcp_arguments_get_int(const mcp_arguments_t* args, const char* name, int fallback);
+
+/**
+ * 读取64位整数参数（必须是整数值；超过 2^53 的值受 JSON 双精度表示限制）
+ */
+int64_t mcp_arguments_get_int64(const mcp_arguments_t* args, const char* name, int64_t fallback);
+
+/**
+ * 读取浮点数参数（任意数值）
+ */
+double mcp_arguments_get_double(const mcp_arguments_t* args, const char* name, double fallback);
+
+/**
+ * 读取字符串参数
+ * @return 字符串指针，由 arguments 持有，回调返回后失效
+ */
+const char* mcp_arguments_get_string(const mcp_arguments_t* args, const char* name, const char* fallback);
+
+/**
+ * 读取数组参数
+ * @return 数组节点（只读，回调返回后失效），缺失或类型不符返回NULL
+ */
+const cJSON* mcp_arguments_get_array(const mcp_arguments_t* args, const char* name);
+
+/**
+ * 读取对象参数
+ * @return 对象节点（只读，回调返回后失效），缺失或类型不符返回NULL
+ */
+const cJSON* mcp_arguments_get_object(const mcp_arguments_t* args, const char* name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MCP_ARGUMENTS_H */
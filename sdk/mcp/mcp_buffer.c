@@ -0,0 +1,60 @@
+/**
+ * @file mcp_buffer.c
+ * @brief 引用计数的共享数据缓冲区实现
+ */
+#include "mcp_buffer.h"
+#include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
+#include <stdlib.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_MCP);
+
+static void mcp_buffer_free(mcp_buffer_t* buffer) {
+    LINX_FREE(buffer->data);
+    LINX_FREE(buffer);
+}
+
+void mcp_buffer_init(mcp_buffer_t* buffer, uint8_t* data, size_t size,
+                     mcp_buffer_release_fn release, void* owner) {
+    if (!buffer || !release) {
+        LOG_ERROR("Invalid shared buffer or release callback");
+        return;
+    }
+    buffer->data = data;
+    buffer->size = size;
+    buffer->release = release;
+    buffer->owner = owner;
+    __atomic_store_n(&buffer->refcount, 1, __ATOMIC_RELEASE);
+}
+
+mcp_buffer_t* mcp_buffer_adopt(uint8_t* data, size_t size) {
+    if (!data) {
+        LOG_ERROR("Invalid data for shared buffer");
+        return NULL;
+    }
+    
+    mcp_buffer_t* buffer = LINX_MALLOC(sizeof(mcp_buffer_t));
+    if (!buffer) {
+        LOG_ERROR("Failed to allocate shared buffer");
+        return NULL;
+    }
+    mcp_buffer_init(buffer, data, size, mcp_buffer_free, NULL);
+    return buffer;
+}
+
+mcp_buffer_t* mcp_buffer_retain(mcp_buffer_t* buffer) {
+    if (buffer) {
+        __atomic_add_fetch(&buffer->refcount, 1, __ATOMIC_RELAXED);
+    }
+    return buffer;
+}
+
+void mcp_buffer_release(mcp_buffer_t* buffer) {
+    if (!buffer) {
+        return;
+    }
+    // 释放之前对数据的访问必须先于所有者回收内存
+    if (__atomic_sub_fetch(&buffer->refcount, 1, __ATOMIC_ACQ_REL) == 0) {
+        buffer->release(buffer);
+    }
+}
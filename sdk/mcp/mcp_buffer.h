@@ -0,0 +1,81 @@
+/**
+ * @file mcp_buffer.h
+ * @brief 引用计数的共享数据缓冲区
+ * 
+ * 让数据在产生者（如相机帧池）和MCP回复之间共享而不复制：
+ * 相机把JPEG直接编码进帧池缓冲区，图像内容对象持有同一缓冲区的引用，
+ * 回复时Base64直接从中写入发送缓冲区。最后一个引用释放时调用 release
+ * 回调，把内存交还给所有者（例如把帧池槽位标记为空闲）。
+ * 
+ * 引用计数使用原子操作，可以在不同线程中 retain/release。
+ * 本头文件不依赖cJSON，相机等模块可以单独包含。
+ */
+#ifndef MCP_BUFFER_H
+#define MCP_BUFFER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct mcp_buffer mcp_buffer_t;
+
+/**
+ * @brief 最后一个引用释放时的回调
+ * @param buffer 缓冲区对象，回调返回后不再被访问
+ */
+typedef void (*mcp_buffer_release_fn)(mcp_buffer_t* buffer);
+
+/**
+ * @brief 共享缓冲区
+ * 
+ * 可以嵌入到所有者的结构体中（mcp_buffer_init），也可以单独分配
+ * （mcp_buffer_adopt）。data/size 在持有引用期间只读。
+ */
+struct mcp_buffer {
+    uint8_t* data;                  /**< 数据 */
+    size_t size;                    /**< 数据长度 */
+    int refcount;                   /**< 引用计数（原子访问） */
+    mcp_buffer_release_fn release;  /**< 释放回调 */
+    void* owner;                    /**< 所有者上下文，供 release 使用 */
+};
+
+/**
+ * @brief 初始化所有者提供的缓冲区，引用计数为1
+ * @param buffer 缓冲区对象（通常嵌入在所有者结构体中）
+ * @param data 数据
+ * @param size 数据长度
+ * @param release 释放回调，不能为NULL
+ * @param owner 所有者上下文
+ */
+void mcp_buffer_init(mcp_buffer_t* buffer, uint8_t* data, size_t size,
+                     mcp_buffer_release_fn release, void* owner);
+
+/**
+ * @brief 创建接管堆数据的缓冲区，引用计数为1
+ * @param data linx_malloc() 分配的数据，最后一个引用释放时 linx_free
+ * @param size 数据长度
+ * @return 缓冲区对象，失败返回NULL（此时 data 仍归调用者）
+ */
+mcp_buffer_t* mcp_buffer_adopt(uint8_t* data, size_t size);
+
+/**
+ * @brief 增加引用
+ * @param buffer 缓冲区对象
+ * @return buffer 本身，便于链式赋值
+ */
+mcp_buffer_t* mcp_buffer_retain(mcp_buffer_t* buffer);
+
+/**
+ * @brief 释放引用，最后一个引用释放时调用 release
+ * @param buffer 缓冲区对象，可以为NULL
+ */
+void mcp_buffer_release(mcp_buffer_t* buffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MCP_BUFFER_H
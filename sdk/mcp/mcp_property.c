@@ -6,10 +6,24 @@
 #include "mcp_property.h"
 #include "mcp_utils.h"      // 包含工具函数
 #include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_MCP);
+
+/* 名称存储块默认大小（字节），单个名称更长时按需分配 */
+#define MCP_NAME_CHUNK_SIZE 256
+
+/* 名称存储块：只追加，不移动，列表销毁时整体释放 */
+struct mcp_name_chunk {
+    struct mcp_name_chunk* next;
+    size_t capacity;
+    size_t used;
+    char data[];
+};
+
 /**
  * 创建布尔类型属性
  */
@@ -24,15 +38,18 @@ mcp_property_t* mcp_property_create_boolean(const char* name, bool default_value
               name, default_value ? "true" : "false", has_default ? "true" : "false");
     
     // 分配内存
-    mcp_property_t* prop = malloc(sizeof(mcp_property_t));
+    mcp_property_t* prop = LINX_MALLOC(sizeof(mcp_property_t));
     if (!prop) {
         LOG_ERROR("Failed to allocate memory for boolean property '%s'", name);
         return NULL;
     }
     
     // 初始化属性
-    strncpy(prop->name, name, MCP_MAX_NAME_LENGTH - 1);
-    prop->name[MCP_MAX_NAME_LENGTH - 1] = '\0';
+    prop->name = mcp_strdup(name);
+    if (!prop->name) {
+        LINX_FREE(prop);
+        return NULL;
+    }
     prop->type = MCP_PROPERTY_TYPE_BOOLEAN;
     prop->has_default_value = has_default;
     prop->has_range = false;
@@ -74,15 +91,18 @@ mcp_property_t* mcp_property_create_integer(const char* name, int default_value,
               name, default_value, has_default ? "true" : "false", min_value, max_value);
     
     // 分配内存
-    mcp_property_t* prop = malloc(sizeof(mcp_property_t));
+    mcp_property_t* prop = LINX_MALLOC(sizeof(mcp_property_t));
     if (!prop) {
         LOG_ERROR("Failed to allocate memory for integer property '%s'", name);
         return NULL;
     }
     
     // 初始化属性
-    strncpy(prop->name, name, MCP_MAX_NAME_LENGTH - 1);
-    prop->name[MCP_MAX_NAME_LENGTH - 1] = '\0';
+    prop->name = mcp_strdup(name);
+    if (!prop->name) {
+        LINX_FREE(prop);
+        return NULL;
+    }
     prop->type = MCP_PROPERTY_TYPE_INTEGER;
     prop->has_default_value = has_default;
     prop->has_range = has_range;
@@ -112,15 +132,18 @@ mcp_property_t* mcp_property_create_string(const char* name, const char* default
               name, has_default ? "true" : "false");
     
     // 分配内存
-    mcp_property_t* prop = malloc(sizeof(mcp_property_t));
+    mcp_property_t* prop = LINX_MALLOC(sizeof(mcp_property_t));
     if (!prop) {
         LOG_ERROR("Failed to allocate memory for string property '%s'", name);
         return NULL;
     }
     
     // 初始化属性
-    strncpy(prop->name, name, MCP_MAX_NAME_LENGTH - 1);
-    prop->name[MCP_MAX_NAME_LENGTH - 1] = '\0';
+    prop->name = mcp_strdup(name);
+    if (!prop->name) {
+        LINX_FREE(prop);
+        return NULL;
+    }
     prop->type = MCP_PROPERTY_TYPE_STRING;
     prop->has_default_value = has_default;
     prop->has_range = false;
@@ -133,7 +156,8 @@ mcp_property_t* mcp_property_create_string(const char* name, const char* default
         prop->value.string_val = mcp_strdup(default_value);
         if (!prop->value.string_val) {
             LOG_ERROR("Failed to duplicate default string value for property '%s'", name);
-            free(prop);
+            LINX_FREE((char*)prop->name);
+            LINX_FREE(prop);
             return NULL;
         }
     }
@@ -142,6 +166,40 @@ mcp_property_t* mcp_property_create_string(const char* name, const char* default
     return prop;
 }
 
+/**
+ * 创建浮点数类型属性
+ */
+mcp_property_t* mcp_property_create_number(const char* name, double default_value, bool has_default) {
+    // 检查参数有效性
+    if (!name || strlen(name) == 0 || strlen(name) >= MCP_MAX_NAME_LENGTH) {
+        LOG_ERROR("Invalid property name: name=%p, length=%zu", name, name ? strlen(name) : 0);
+        return NULL;
+    }
+    
+    // 分配内存
+    mcp_property_t* prop = LINX_MALLOC(sizeof(mcp_property_t));
+    if (!prop) {
+        LOG_ERROR("Failed to allocate memory for number property '%s'", name);
+        return NULL;
+    }
+    
+    // 初始化属性
+    prop->name = mcp_strdup(name);
+    if (!prop->name) {
+        LINX_FREE(prop);
+        return NULL;
+    }
+    prop->type = MCP_PROPERTY_TYPE_NUMBER;
+    prop->has_default_value = has_default;
+    prop->has_range = false;
+    prop->min_value = 0;
+    prop->max_value = 0;
+    prop->value.number_val = has_default ? default_value : 0.0;
+    
+    LOG_DEBUG("Number property '%s' created successfully", name);
+    return prop;
+}
+
 /**
  * 设置布尔属性值
  */
@@ -186,7 +244,7 @@ int mcp_property_set_string_value(mcp_property_t* prop, const char* value) {
     
     // 释放旧值
     if (prop->value.string_val) {
-        free(prop->value.string_val);
+        LINX_FREE(prop->value.string_val);
     }
     
     // 设置新值
@@ -224,6 +282,19 @@ const char* mcp_property_get_string_value(const mcp_property_t* prop) {
     return prop->value.string_val;
 }
 
+/**
+ * 获取浮点数属性值
+ */
+double mcp_property_get_number_value(const mcp_property_t* prop) {
+    if (!prop) {
+        return 0.0;
+    }
+    if (prop->type == MCP_PROPERTY_TYPE_INTEGER) {
+        return (double)prop->value.int_val;
+    }
+    return prop->type == MCP_PROPERTY_TYPE_NUMBER ? prop->value.number_val : 0.0;
+}
+
 /**
  * 将属性转换为JSON字符串
  */
@@ -232,7 +303,7 @@ char* mcp_property_to_json(const mcp_property_t* prop) {
         return NULL;
     }
     
-    char* json = malloc(1024);  // 分配足够的空间
+    char* json = LINX_MALLOC(1024);  // 分配足够的空间
     if (!json) {
         return NULL;
     }
@@ -267,6 +338,22 @@ char* mcp_property_to_json(const mcp_property_t* prop) {
             );
             break;
             
+        case MCP_PROPERTY_TYPE_NUMBER: {
+            char default_str[48] = "";
+            if (prop->has_default_value) {
+                snprintf(default_str, sizeof(default_str), ",\n  \"default\": %.15g", prop->value.number_val);
+            }
+            snprintf(json, 1024,
+                "{\n"
+                "  \"type\": \"number\",\n"
+                "  \"description\": \"%s\"%s\n"
+                "}",
+                prop->name,
+                default_str
+            );
+            break;
+        }
+            
         case MCP_PROPERTY_TYPE_STRING:
             snprintf(json, 1024,
                 "{\n"
@@ -281,7 +368,7 @@ char* mcp_property_to_json(const mcp_property_t* prop) {
             break;
             
         default:
-            free(json);
+            LINX_FREE(json);
             return NULL;
     }
     
@@ -297,12 +384,15 @@ void mcp_property_destroy(mcp_property_t* prop) {
         
         // 如果是字符串类型，释放字符串内存
         if (prop->type == MCP_PROPERTY_TYPE_STRING && prop->value.string_val) {
-            free(prop->value.string_val);
+            LINX_FREE(prop->value.string_val);
             prop->value.string_val = NULL;
         }
         
+        LINX_FREE((char*)prop->name);
+        prop->name = NULL;
+        
         // 释放属性内存
-        free(prop);
+        LINX_FREE(prop);
         prop = NULL;
         
         LOG_DEBUG("Property destroyed successfully");
@@ -311,23 +401,176 @@ void mcp_property_destroy(mcp_property_t* prop) {
     }
 }
 
+/**
+ * 在列表的名称块中保存一份名称
+ */
+static const char* mcp_property_list_store_name(mcp_property_list_t* list, const char* name) {
+    size_t length = strlen(name) + 1;
+    mcp_name_chunk_t* chunk = list->names;
+    
+    if (!chunk || chunk->capacity - chunk->used < length) {
+        size_t capacity = length > MCP_NAME_CHUNK_SIZE ? length : MCP_NAME_CHUNK_SIZE;
+        chunk = LINX_MALLOC(sizeof(mcp_name_chunk_t) + capacity);
+        if (!chunk) {
+            return NULL;
+        }
+        chunk->capacity = capacity;
+        chunk->used = 0;
+        chunk->next = list->names;
+        list->names = chunk;
+    }
+    
+    char* stored = chunk->data + chunk->used;
+    memcpy(stored, name, length);
+    chunk->used += length;
+    return stored;
+}
+
+/**
+ * 保证属性数组至少能容纳 capacity 个属性
+ */
+static bool mcp_property_list_reserve(mcp_property_list_t* list, size_t capacity) {
+    if (capacity <= list->capacity) {
+        return true;
+    }
+    
+    size_t new_capacity = list->capacity * 2;
+    if (new_capacity < capacity) {
+        new_capacity = capacity;
+    }
+    if (new_capacity > MCP_MAX_PROPERTIES) {
+        new_capacity = MCP_MAX_PROPERTIES;
+    }
+    
+    mcp_property_t* properties;
+    if (list->properties == list->inline_properties) {
+        properties = LINX_MALLOC(new_capacity * sizeof(mcp_property_t));
+        if (properties) {
+            memcpy(properties, list->inline_properties, list->count * sizeof(mcp_property_t));
+        }
+    } else {
+        properties = LINX_REALLOC(list->properties, new_capacity * sizeof(mcp_property_t));
+    }
+    if (!properties) {
+        return false;
+    }
+    
+    list->properties = properties;
+    list->capacity = new_capacity;
+    return true;
+}
+
 /**
  * 创建属性列表
  */
 mcp_property_list_t* mcp_property_list_create(void) {
     LOG_DEBUG("Creating property list");
     
-    mcp_property_list_t* list = malloc(sizeof(mcp_property_list_t));
+    mcp_property_list_t* list = LINX_MALLOC(sizeof(mcp_property_list_t));
     if (list) {
+        list->properties = list->inline_properties;
         list->count = 0;
-        memset(list->properties, 0, sizeof(list->properties));
-        LOG_INFO("Property list created successfully");
+        list->capacity = MCP_PROPERTY_LIST_INLINE;
+        list->names = NULL;
+        list->borrowed = false;
+        memset(list->inline_properties, 0, sizeof(list->inline_properties));
+        LOG_DEBUG("Property list created successfully");
     } else {
         LOG_ERROR("Failed to allocate memory for property list");
     }
     return list;
 }
 
+/**
+ * 从 arguments 对象生成属性列表
+ */
+mcp_property_list_t* mcp_property_list_create_from_json(const cJSON* arguments, bool borrow) {
+    if (!arguments || !cJSON_IsObject(arguments)) {
+        return NULL;
+    }
+    
+    // 统计支持的参数，确定一次分配的大小
+    size_t count = 0;
+    size_t names_length = 0;
+    const cJSON* arg = NULL;
+    cJSON_ArrayForEach(arg, arguments) {
+        if (arg->string && (cJSON_IsBool(arg) || cJSON_IsNumber(arg) || cJSON_IsString(arg))) {
+            count++;
+            names_length += strlen(arg->string) + 1;
+        }
+    }
+    if (count > MCP_MAX_PROPERTIES) {
+        LOG_WARN("Too many arguments (%zu), keeping the first %d", count, MCP_MAX_PROPERTIES);
+        count = MCP_MAX_PROPERTIES;
+    }
+    
+    mcp_property_list_t* list = mcp_property_list_create();
+    if (!list) {
+        return NULL;
+    }
+    list->borrowed = borrow;
+    
+    if (!mcp_property_list_reserve(list, count)) {
+        mcp_property_list_destroy(list);
+        return NULL;
+    }
+    
+    // 复制名称时预先分配一个足够大的名称块
+    if (!borrow && names_length > 0) {
+        mcp_name_chunk_t* chunk = LINX_MALLOC(sizeof(mcp_name_chunk_t) + names_length);
+        if (!chunk) {
+            mcp_property_list_destroy(list);
+            return NULL;
+        }
+        chunk->capacity = names_length;
+        chunk->used = 0;
+        chunk->next = NULL;
+        list->names = chunk;
+    }
+    
+    cJSON_ArrayForEach(arg, arguments) {
+        if (list->count >= count) {
+            break;
+        }
+        if (!arg->string || !(cJSON_IsBool(arg) || cJSON_IsNumber(arg) || cJSON_IsString(arg))) {
+            continue;
+        }
+        
+        // 与逐个 mcp_property_list_add 一样，重复的名称只保留第一个
+        if (mcp_property_list_find(list, arg->string)) {
+            continue;
+        }
+        
+        mcp_property_t* prop = &list->properties[list->count];
+        memset(prop, 0, sizeof(mcp_property_t));
+        prop->name = borrow ? arg->string : mcp_property_list_store_name(list, arg->string);
+        prop->has_default_value = true;
+        
+        if (cJSON_IsBool(arg)) {
+            prop->type = MCP_PROPERTY_TYPE_BOOLEAN;
+            prop->value.bool_val = cJSON_IsTrue(arg);
+        } else if (cJSON_IsNumber(arg)) {
+            prop->type = MCP_PROPERTY_TYPE_INTEGER;
+            prop->value.int_val = arg->valueint;
+        } else {
+            prop->type = MCP_PROPERTY_TYPE_STRING;
+            prop->value.string_val = borrow ? arg->valuestring : mcp_strdup(arg->valuestring);
+            if (!prop->value.string_val) {
+                mcp_property_list_destroy(list);
+                return NULL;
+            }
+        }
+        
+        if (!prop->name) {
+            mcp_property_list_destroy(list);
+            return NULL;
+        }
+        list->count++;
+    }
+    
+    return list;
+}
+
 /**
  * 销毁属性列表
  */
@@ -337,25 +580,35 @@ void mcp_property_list_destroy(mcp_property_list_t* list) {
         return;
     }
     
-    LOG_INFO("Destroying property list with %zu properties", list->count);
+    LOG_DEBUG("Destroying property list with %zu properties", list->count);
     
-    // 销毁所有属性
-    for (size_t i = 0; i < list->count; i++) {
-        if (list->properties[i].type == MCP_PROPERTY_TYPE_STRING && 
-            list->properties[i].value.string_val) {
-            free(list->properties[i].value.string_val);
-            list->properties[i].value.string_val = NULL;  // 防止多次释放
+    // 销毁所有属性（借用的字符串归 cJSON 所有）
+    if (!list->borrowed) {
+        for (size_t i = 0; i < list->count; i++) {
+            if (list->properties[i].type == MCP_PROPERTY_TYPE_STRING && 
+                list->properties[i].value.string_val) {
+                LINX_FREE(list->properties[i].value.string_val);
+                list->properties[i].value.string_val = NULL;  // 防止多次释放
+            }
         }
-        // 清理属性状态
-        memset(&list->properties[i], 0, sizeof(mcp_property_t));
+    }
+    
+    // 释放名称块和外置的属性数组
+    mcp_name_chunk_t* chunk = list->names;
+    while (chunk) {
+        mcp_name_chunk_t* next = chunk->next;
+        LINX_FREE(chunk);
+        chunk = next;
+    }
+    if (list->properties != list->inline_properties) {
+        LINX_FREE(list->properties);
     }
     
     // 清理列表状态
     list->count = 0;
-    memset(list->properties, 0, sizeof(list->properties));
     
     // 释放列表内存
-    free(list);
+    LINX_FREE(list);
     list = NULL;
     
     LOG_DEBUG("Property list destroyed successfully");
@@ -377,26 +630,13 @@ mcp_property_list_t* mcp_property_list_clone(const mcp_property_list_t* list) {
     
     // 复制所有属性
     for (size_t i = 0; i < list->count; i++) {
-        const mcp_property_t* src_prop = &list->properties[i];
-        mcp_property_t* dest_prop = &cloned_list->properties[cloned_list->count];
-        
-        // 复制基本属性信息
-        memcpy(dest_prop, src_prop, sizeof(mcp_property_t));
-        
-        // 如果是字符串类型，需要深拷贝字符串值
-        if (src_prop->type == MCP_PROPERTY_TYPE_STRING && src_prop->value.string_val) {
-            dest_prop->value.string_val = mcp_strdup(src_prop->value.string_val);
-            if (!dest_prop->value.string_val) {
-                // 如果字符串复制失败，清理已分配的资源
-                mcp_property_list_destroy(cloned_list);
-                return NULL;
-            }
+        if (!mcp_property_list_add(cloned_list, &list->properties[i])) {
+            mcp_property_list_destroy(cloned_list);
+            return NULL;
         }
-        
-        cloned_list->count++;
     }
     
-    printf("[MCP] mcp_property_list_clone() cloned %zu properties\n", cloned_list->count);
+    LOG_DEBUG("mcp_property_list_clone() cloned %zu properties", cloned_list->count);
     return cloned_list;
 }
 
@@ -404,7 +644,7 @@ mcp_property_list_t* mcp_property_list_clone(const mcp_property_list_t* list) {
  * 向属性列表添加属性
  */
 bool mcp_property_list_add(mcp_property_list_t* list, const mcp_property_t* prop) {
-    if (!list || !prop || list->count >= MCP_MAX_PROPERTIES) {
+    if (!list || !prop || !prop->name || list->count >= MCP_MAX_PROPERTIES || list->borrowed) {
         LOG_ERROR("Invalid parameters or property limit reached: list=%p, prop=%p, count=%zu/%d", 
                   list, prop, list ? list->count : 0, MCP_MAX_PROPERTIES);
         return false;
@@ -413,16 +653,24 @@ bool mcp_property_list_add(mcp_property_list_t* list, const mcp_property_t* prop
     LOG_DEBUG("Adding property '%s' to list (current count: %zu)", prop->name, list->count);
     
     // 检查重复的属性名称
-    for (size_t i = 0; i < list->count; i++) {
-        if (strcmp(list->properties[i].name, prop->name) == 0) {
-            LOG_WARN("Property with name '%s' already exists in list", prop->name);
-            return false;
-        }
+    if (mcp_property_list_find(list, prop->name)) {
+        LOG_WARN("Property with name '%s' already exists in list", prop->name);
+        return false;
+    }
+    
+    if (!mcp_property_list_reserve(list, list->count + 1)) {
+        LOG_ERROR("Failed to grow property list for '%s'", prop->name);
+        return false;
     }
     
-    // 复制属性
+    // 复制属性，名称放进列表的名称块
     mcp_property_t* dest = &list->properties[list->count];
     memcpy(dest, prop, sizeof(mcp_property_t));
+    dest->name = mcp_property_list_store_name(list, prop->name);
+    if (!dest->name) {
+        LOG_ERROR("Failed to store name for property '%s'", prop->name);
+        return false;
+    }
     
     // 如果是字符串类型，需要复制字符串值
     if (prop->type == MCP_PROPERTY_TYPE_STRING && prop->value.string_val) {
@@ -435,8 +683,8 @@ bool mcp_property_list_add(mcp_property_list_t* list, const mcp_property_t* prop
     
     list->count++;
     
-    LOG_INFO("Property '%s' added successfully to list (total properties: %zu)", 
-             prop->name, list->count);
+    LOG_DEBUG("Property '%s' added successfully to list (total properties: %zu)", 
+              prop->name, list->count);
     return true;
 }
 
@@ -462,7 +710,7 @@ const mcp_property_t* mcp_property_list_find(const mcp_property_list_t* list, co
  * 在属性列表中查找属性（可修改）
  */
 mcp_property_t* mcp_property_list_find_mutable(mcp_property_list_t* list, const char* name) {
-    if (!list || !name) {
+    if (!list || !name || list->borrowed) {
         return NULL;
     }
     
@@ -485,7 +733,7 @@ char* mcp_property_list_to_json(const mcp_property_list_t* list) {
     }
     
     // 分配足够的空间
-    char* json = malloc(4096);
+    char* json = LINX_MALLOC(4096);
     if (!json) {
         return NULL;
     }
@@ -504,7 +752,7 @@ char* mcp_property_list_to_json(const mcp_property_list_t* list) {
                 strcat(json, ",");
             }
             strcat(json, "\n");
-            free(prop_json);
+            LINX_FREE(prop_json);
         }
     }
     
@@ -521,7 +769,7 @@ char* mcp_property_list_get_required_json(const mcp_property_list_t* list) {
     }
     
     // 分配足够的空间
-    char* json = malloc(1024);
+    char* json = LINX_MALLOC(1024);
     if (!json) {
         return NULL;
     }
@@ -12,10 +12,16 @@
 extern "C" {
 #endif
 
+/* 属性列表内联容量，多数工具只有几个参数，超出后才在堆上扩容 */
+#define MCP_PROPERTY_LIST_INLINE 4
+
+/* 名称存储块 - 前向声明（隐藏实现细节） */
+typedef struct mcp_name_chunk mcp_name_chunk_t;
+
 /* 属性结构体 */
 typedef struct mcp_property {
-    char name[MCP_MAX_NAME_LENGTH];     // 属性名称
-    mcp_property_type_t type;           // 属性类型（布尔、整数、字符串）
+    const char* name;                   // 属性名称（独立属性自有，列表中的属性存放在列表的名称块中）
+    mcp_property_type_t type;           // 属性类型（布尔、整数、字符串、浮点数）
     mcp_property_value_t value;         // 属性值联合体
     bool has_default_value;             // 是否有默认值
     bool has_range;                     // 是否有取值范围（仅对整数类型有效）
@@ -25,8 +31,12 @@ typedef struct mcp_property {
 
 /* 属性列表结构体 */
 typedef struct mcp_property_list {
-    mcp_property_t properties[MCP_MAX_PROPERTIES];  // 属性数组
-    size_t count;                                   // 属性数量
+    mcp_property_t* properties;                     // 属性数组（指向 inline_properties 或堆内存）
+    size_t count;                                   // 属性数量（不超过 MCP_MAX_PROPERTIES）
+    size_t capacity;                                // 属性数组容量
+    mcp_name_chunk_t* names;                        // 属性名称存储块链表，随列表一起释放
+    bool borrowed;                                  // 名称和字符串值借用自 cJSON 参数，不归列表所有
+    mcp_property_t inline_properties[MCP_PROPERTY_LIST_INLINE]; // 内联属性存储
 } mcp_property_list_t;
 
 /* 属性操作函数 */
@@ -62,6 +72,15 @@ mcp_property_t* mcp_property_create_integer(const char* name, int default_value,
  */
 mcp_property_t* mcp_property_create_string(const char* name, const char* default_value, bool has_default);
 
+/**
+ * 创建浮点数类型属性
+ * @param name 属性名称
+ * @param default_value 默认值
+ * @param has_default 是否有默认值
+ * @return 创建的属性指针，失败返回NULL
+ */
+mcp_property_t* mcp_property_create_number(const char* name, double default_value, bool has_default);
+
 /**
  * 设置布尔属性值
  * @param prop 属性指针
@@ -107,6 +126,13 @@ int mcp_property_get_int_value(const mcp_property_t* prop);
  */
 const char* mcp_property_get_string_value(const mcp_property_t* prop);
 
+/**
+ * 获取浮点数属性值（整数属性按整数值返回）
+ * @param prop 属性指针
+ * @return 属性值
+ */
+double mcp_property_get_number_value(const mcp_property_t* prop);
+
 /**
  * 将属性转换为JSON字符串
  * @param prop 属性指针
@@ -128,6 +154,16 @@ void mcp_property_destroy(mcp_property_t* prop);
  */
 mcp_property_list_t* mcp_property_list_create(void);
 
+/**
+ * 直接从 tools/call 的 arguments 对象生成属性列表
+ * 按参数个数一次分配；borrow 为 true 时名称和字符串值直接引用 cJSON 节点，
+ * 不做复制，列表只能在 arguments 释放前使用且不可修改
+ * @param arguments 参数JSON对象
+ * @param borrow 是否借用 cJSON 中的字符串
+ * @return 创建的属性列表指针，失败返回NULL
+ */
+mcp_property_list_t* mcp_property_list_create_from_json(const cJSON* arguments, bool borrow);
+
 /**
  * 销毁属性列表并释放内存
  * @param list 属性列表指针
@@ -135,7 +171,7 @@ mcp_property_list_t* mcp_property_list_create(void);
 void mcp_property_list_destroy(mcp_property_list_t* list);
 
 /**
- * 克隆属性列表（深拷贝）
+ * 克隆属性列表（深拷贝，借用的列表克隆后归新列表所有）
  * @param list 要克隆的属性列表指针
  * @return 克隆的属性列表指针，失败返回NULL
  */
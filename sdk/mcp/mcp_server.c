@@ -6,12 +6,159 @@
 #include "mcp_server.h"
 #include "mcp.h"        // 包含MCP协议版本定义
 #include "../log/linx_log.h"  // 日志模块
+#include "../log/linx_alloc.h"
+#include "../log/linx_thread_stats.h"
+#include "../log/linx_mem_pressure.h"
+#include "../cjson/linx_json_writer.h"
+#include "../linx_tracepoint.h"
+#include <limits.h>
+#include <math.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/time.h>
 
-/* 全局消息发送回调函数 */
-static mcp_send_message_callback_t g_send_callback = NULL;
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_MCP);
+
+/* 超时检查线程单次等待上限（毫秒），用于容忍系统时间跳变 */
+#define MCP_MONITOR_MAX_WAIT_MS 100
+/* 超时检查线程单轮最多回复的超时数，其余留到下一轮 */
+#define MCP_MONITOR_BATCH 8
+
+/* 批量请求的响应收集：各请求的响应按完成顺序拼接，全部完成后作为一个数组发送 */
+typedef struct mcp_reply_batch {
+    pthread_mutex_t mutex;              // 保护以下字段，异步调用在工作线程中完成
+    mcp_server_t* server;
+    size_t pending;                     // 未完成的异步调用数，分发期间另加1
+    char* json;                         // 已收集的响应，逗号分隔（不含方括号）
+    size_t length;
+    size_t capacity;
+    size_t count;                       // 已收集的响应数
+} mcp_reply_batch_t;
+
+/* 当前线程的回复收集目标，NULL 时直接发送 */
+static __thread mcp_reply_batch_t* t_reply_batch = NULL;
+
+/* 工具调用的推送句柄；调用结束后仍可能被其他线程持有，按引用计数释放 */
+struct mcp_tool_stream {
+    pthread_mutex_t mutex;              // 保护以下字段；持锁发送，结束后不会再有通知发出
+    int refs;                           // 引用计数（原子操作）
+    bool finished;                      // 调用已回复或超时，之后的推送直接丢弃
+    mcp_server_t* server;
+    int id;                             // 请求ID
+    char progress_token[MCP_PROGRESS_TOKEN_MAX]; // 打印好的 progressToken，空串表示请求未携带
+    bool has_progress;                  // 已发送过进度
+    double last_progress;               // 已发送的最大进度
+    uint32_t chunk_index;               // 下一个分块序号
+    linx_json_writer_t writer;          // 通知的打印缓冲区，复用
+};
+
+/* 异步工具调用 */
+typedef struct mcp_tool_job {
+    struct mcp_tool_job* next;
+    mcp_worker_pool_t* pool;
+    mcp_tool_t* tool;
+    int id;                             // 请求ID
+    mcp_property_list_t* properties;    // 调用参数（由任务持有）
+    cJSON* arguments;                   // 参数视图工具的 arguments 副本（由任务持有）
+    char* cache_key;                    // 结果缓存键，工具未启用缓存时为NULL（由任务持有）
+    uint64_t deadline_ms;               // 超时时刻（单调时钟）
+    bool timed_out;                     // 已回复超时错误，执行结果直接丢弃
+    bool queued;                        // 在排队列表中（执行器尚未开始执行）
+    linx_cancel_token_t* token;         // 取消令牌，超时或停止时取消
+    mcp_reply_batch_t* batch;           // 所属批量请求，单条请求时为NULL
+    char progress_token[MCP_PROGRESS_TOKEN_MAX]; // 请求的 progressToken，空串表示未携带
+    mcp_tool_stream_t* stream;          // 回调创建的推送句柄（任务持有一个引用），超时时由检查线程结束
+    mcp_tool_stats_t* stats;            // 工具的调用统计，提交时未开启剖析为NULL
+    uint32_t args_us;                   // 提交前参数转换的耗时（微秒）
+} mcp_tool_job_t;
+
+/* 正在执行的工具调用，推送句柄在回调首次请求时才创建 */
+typedef struct {
+    mcp_server_t* server;
+    int id;
+    const char* progress_token;
+    mcp_tool_job_t* job;                // 异步调用所属任务，同步调用为NULL
+    mcp_tool_stream_t* stream;
+} mcp_tool_call_frame_t;
+
+/* 当前线程正在执行的工具调用 */
+static __thread mcp_tool_call_frame_t* t_tool_call = NULL;
+
+/* 异步工具线程池 */
+struct mcp_worker_pool {
+    pthread_mutex_t mutex;              // 保护以下全部字段及工具的 active_calls
+    pthread_cond_t idle_cond;           // 已提交的任务全部结束
+    pthread_cond_t monitor_cond;        // 任务集合变化或正在停止
+    linx_executor_t* executor;          // 执行工具回调的后台任务执行器
+    bool owns_executor;                 // 由 mcp_server_start_workers 创建，停止时销毁
+    pthread_t monitor;                  // 超时检查线程
+    bool monitor_started;
+    mcp_tool_job_t* queue_head;         // 已提交、尚未开始执行的任务（FIFO）
+    mcp_tool_job_t* queue_tail;
+    size_t queued;
+    size_t capacity;
+    size_t outstanding;                 // 已提交、任务函数尚未返回的任务数
+    mcp_tool_job_t* running;            // 执行中的任务
+    bool stopping;
+    mcp_server_t* server;               // 所属服务器，用于回复结果
+};
+
+/* 方法处理函数类型 */
+typedef void (*mcp_method_handler_t)(mcp_server_t* server, int id, const cJSON* params);
+
+/* 方法分发表：按名称长度+首字符快速过滤，再做完整比较 */
+typedef struct {
+    const char* name;
+    size_t length;
+    mcp_method_handler_t handler;
+} mcp_method_entry_t;
+
+#define MCP_METHOD_ENTRY(name, handler) { name, sizeof(name) - 1, handler }
+
+static const mcp_method_entry_t g_method_table[] = {
+    MCP_METHOD_ENTRY("initialize", mcp_server_handle_initialize),
+    MCP_METHOD_ENTRY("tools/list", mcp_server_handle_tools_list),
+    MCP_METHOD_ENTRY("tools/call", mcp_server_handle_tools_call),
+    MCP_METHOD_ENTRY("tools/stats", mcp_server_handle_tools_stats),
+};
+
+static size_t mcp_server_reply_tool_result(mcp_server_t* server, mcp_tool_t* tool, const char* cache_key,
+                                           int id, mcp_return_value_t* result);
+static mcp_tool_stats_t* mcp_server_tool_stats(mcp_server_t* server, mcp_tool_t* tool);
+static void mcp_server_profile_call(mcp_server_t* server, mcp_tool_t* tool, mcp_tool_stats_t* stats, bool async,
+                                    uint32_t args_us, uint64_t callback_start_us, uint64_t callback_end_us,
+                                    size_t reply_bytes);
+static void mcp_reply_batch_release(mcp_reply_batch_t* batch);
+static bool mcp_server_reserve_tools(mcp_server_t* server, size_t capacity);
+static void mcp_server_invalidate_tools_list(mcp_server_t* server);
+static size_t mcp_server_shrink(void* user_data, linx_mem_pressure_level_t level);
+static mcp_tool_t* mcp_server_find_tool_mutable(mcp_server_t* server, const char* name);
+static void mcp_server_publish_tools(mcp_server_t* server);
+static void mcp_server_sync_tools(mcp_server_t* server);
+static void mcp_server_state_send(const char* message, void* user_data);
+static void mcp_server_send_direct(mcp_server_t* server, const char* payload);
+static void mcp_tool_stream_finish(mcp_tool_stream_t* stream);
+static char* mcp_tool_result_format(const mcp_return_value_t* result, bool* is_error);
+
+/**
+ * 查找方法对应的处理函数
+ */
+static mcp_method_handler_t mcp_server_find_method_handler(const char* method) {
+    size_t length = strlen(method);
+    
+    for (size_t i = 0; i < sizeof(g_method_table) / sizeof(g_method_table[0]); i++) {
+        const mcp_method_entry_t* entry = &g_method_table[i];
+        if (entry->length == length && entry->name[0] == method[0] &&
+            memcmp(entry->name, method, length) == 0) {
+            return entry->handler;
+        }
+    }
+    
+    return NULL;
+}
 
 /**
  * 创建MCP服务器实例
@@ -24,15 +171,32 @@ mcp_server_t* mcp_server_create(const char* server_name, const char* server_vers
     
     LOG_INFO("Creating MCP server: name='%s', version='%s'", server_name, server_version);
     
-    mcp_server_t* server = malloc(sizeof(mcp_server_t));
+    mcp_server_t* server = LINX_MALLOC(sizeof(mcp_server_t));
     if (!server) {
         LOG_ERROR("Failed to allocate memory for MCP server");
         return NULL;
     }
     
-    // 初始化工具数组
-    memset(server->tools, 0, sizeof(server->tools));
+    // 初始化工具表
+    server->tools = NULL;
     server->tool_count = 0;
+    server->tool_capacity = 0;
+    server->tool_index = NULL;
+    server->tool_index_size = 0;
+    if (!mcp_server_reserve_tools(server, MCP_MAX_TOOLS)) {
+        LOG_ERROR("Failed to allocate MCP tool registry");
+        LINX_FREE(server->tools);
+        LINX_FREE(server);
+        return NULL;
+    }
+    
+    // 工具回调中可能再注册工具，使用可重入锁
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&server->registry_mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+    memset(server->tools_list_cache, 0, sizeof(server->tools_list_cache));
     
     // 复制服务器名称
     strncpy(server->server_name, server_name, MCP_MAX_NAME_LENGTH - 1);
@@ -45,6 +209,53 @@ mcp_server_t* mcp_server_create(const char* server_name, const char* server_vers
     /* 初始化能力回调结构体 */
     memset(&server->capability_callbacks, 0, sizeof(server->capability_callbacks));
     
+    server->worker_pool = NULL;
+    server->send_handler = NULL;
+    server->send_user_data = NULL;
+    mcp_state_sync_init(&server->state_sync);
+    server->client_state_sync = false;
+    server->capabilities_hash = 0;
+    server->capabilities_parsed = false;
+    pthread_mutex_init(&server->local_call_mutex, NULL);
+    memset(server->local_calls, 0, sizeof(server->local_calls));
+    server->local_call_head = 0;
+    server->local_call_count = 0;
+    server->tool_profiling = false;
+    server->slow_tool_us = 0;
+    server->profile_handler = NULL;
+    server->profile_user_data = NULL;
+    
+    // 名称和版本此后不变，initialize 响应只生成一次
+    const char* result_format = "{\"protocolVersion\":\"%s\",\"capabilities\":{\"tools\":{\"listChanged\":false},"
+                                "\"experimental\":{\"stateSync\":{\"mergePatch\":true},\"toolStats\":{}}},"
+                                "\"serverInfo\":{\"name\":\"%s\",\"version\":\"%s\"}}";
+    int result_length = snprintf(NULL, 0, result_format, MCP_PROTOCOL_VERSION,
+                                 server->server_name, server->server_version);
+    server->initialize_result = LINX_MALLOC((size_t)result_length + 1);
+    if (!server->initialize_result) {
+        LOG_ERROR("Failed to allocate initialize response");
+        mcp_state_sync_deinit(&server->state_sync);
+        pthread_mutex_destroy(&server->local_call_mutex);
+        pthread_mutex_destroy(&server->registry_mutex);
+        LINX_FREE(server->tools);
+        LINX_FREE(server->tool_index);
+        LINX_FREE(server);
+        return NULL;
+    }
+    snprintf(server->initialize_result, (size_t)result_length + 1, result_format, MCP_PROTOCOL_VERSION,
+             server->server_name, server->server_version);
+    
+    /* 创建响应构建用的 cJSON 竞技场，失败时退化为普通堆分配 */
+    server->json_arena = linx_json_arena_create(LINX_JSON_ARENA_DEFAULT_CAPACITY);
+    if (!server->json_arena) {
+        LOG_WARN("Failed to create JSON arena, falling back to heap allocation");
+    }
+    
+    // 内存紧张时丢弃 tools/list 缓存和工具结果缓存，下次请求时重新生成
+    if (!linx_mem_pressure_register("mcp_server", LINX_MEM_PRESSURE_PRIORITY_RESULTS, mcp_server_shrink, server)) {
+        LOG_WARN("Memory pressure shrinkers full, MCP caches are kept under pressure");
+    }
+    
     LOG_DEBUG("MCP server created successfully: %p", server);
     return server;
 }
@@ -56,6 +267,10 @@ void mcp_server_destroy(mcp_server_t* server) {
     if (server) {
         LOG_INFO("Destroying MCP server: %p (name='%s', tools=%zu)", server, server->server_name, server->tool_count);
         
+        // 先停止线程池，确保没有工作线程还在使用工具
+        mcp_server_stop_workers(server);
+        linx_mem_pressure_unregister(mcp_server_shrink, server);
+        
         // 销毁所有工具
         for (size_t i = 0; i < server->tool_count; i++) {
             if (server->tools[i]) {
@@ -66,8 +281,18 @@ void mcp_server_destroy(mcp_server_t* server) {
         }
         // 清理服务器状态
         server->tool_count = 0;
-        memset(server->tools, 0, sizeof(server->tools));
-        free(server);
+        LINX_FREE(server->tools);
+        LINX_FREE(server->tool_index);
+        mcp_server_invalidate_tools_list(server);
+        pthread_mutex_destroy(&server->registry_mutex);
+        mcp_state_sync_deinit(&server->state_sync);
+        for (size_t i = 0; i < server->local_call_count; i++) {
+            cJSON_free(server->local_calls[(server->local_call_head + i) % MCP_LOCAL_CALL_BACKLOG]);
+        }
+        pthread_mutex_destroy(&server->local_call_mutex);
+        linx_json_arena_destroy(server->json_arena);
+        LINX_FREE(server->initialize_result);
+        LINX_FREE(server);
         server = NULL;
         
         LOG_DEBUG("MCP server destroyed successfully");
@@ -76,34 +301,228 @@ void mcp_server_destroy(mcp_server_t* server) {
     }
 }
 
+/**
+ * 工具名称哈希（FNV-1a）
+ */
+static size_t mcp_tool_name_hash(const char* name) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char* p = (const unsigned char*)name; *p; p++) {
+        hash ^= *p;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * 在索引中查找工具名称所在的槽（调用者持有工具表锁）
+ * @return 命中时返回槽位，未命中时返回可插入的空槽
+ */
+static size_t mcp_server_index_slot(const mcp_server_t* server, const char* name) {
+    size_t mask = server->tool_index_size - 1;
+    size_t slot = mcp_tool_name_hash(name) & mask;
+    while (server->tool_index[slot] != 0) {
+        if (strcmp(server->tools[server->tool_index[slot] - 1]->name, name) == 0) {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+/**
+ * 按数组内容重建哈希索引（调用者持有工具表锁）
+ */
+static void mcp_server_rebuild_index(mcp_server_t* server) {
+    memset(server->tool_index, 0, server->tool_index_size * sizeof(size_t));
+    for (size_t i = 0; i < server->tool_count; i++) {
+        size_t slot = mcp_server_index_slot(server, server->tools[i]->name);
+        server->tool_index[slot] = i + 1;
+    }
+}
+
+/**
+ * 保证工具表至少能容纳 capacity 个工具（调用者持有工具表锁）
+ */
+static bool mcp_server_reserve_tools(mcp_server_t* server, size_t capacity) {
+    if (capacity <= server->tool_capacity) {
+        return true;
+    }
+    
+    size_t new_capacity = server->tool_capacity ? server->tool_capacity : MCP_MAX_TOOLS;
+    while (new_capacity < capacity) {
+        new_capacity *= 2;
+    }
+    
+    // 索引装载率不超过 1/2
+    size_t index_size = 1;
+    while (index_size < new_capacity * 2) {
+        index_size <<= 1;
+    }
+    
+    mcp_tool_t** tools = LINX_REALLOC(server->tools, new_capacity * sizeof(mcp_tool_t*));
+    if (!tools) {
+        return false;
+    }
+    server->tools = tools;
+    
+    size_t* index = LINX_CALLOC(index_size, sizeof(size_t));
+    if (!index) {
+        return false;
+    }
+    LINX_FREE(server->tool_index);
+    server->tool_index = index;
+    server->tool_index_size = index_size;
+    server->tool_capacity = new_capacity;
+    mcp_server_rebuild_index(server);
+    return true;
+}
+
+/**
+ * 释放已从工具表中摘除的工具（调用者持有工具表锁）
+ * 仍有异步调用排队或执行时只做标记，由最后一个调用销毁
+ */
+static void mcp_server_retire_tool(mcp_server_t* server, mcp_tool_t* tool) {
+    mcp_worker_pool_t* pool = server->worker_pool;
+    if (pool) {
+        pthread_mutex_lock(&pool->mutex);
+        if (tool->active_calls > 0) {
+            LOG_INFO("Tool '%s' still has %d async calls, destroying after they finish",
+                     tool->name, tool->active_calls);
+            tool->retired = true;
+            pthread_mutex_unlock(&pool->mutex);
+            return;
+        }
+        pthread_mutex_unlock(&pool->mutex);
+    }
+    mcp_tool_destroy(tool);
+}
+
 /**
  * 向服务器添加工具
  */
 bool mcp_server_add_tool(mcp_server_t* server, mcp_tool_t* tool) {
-    if (!server || !tool || server->tool_count >= MCP_MAX_TOOLS) {
-        LOG_ERROR("Invalid parameters or tool limit reached: server=%p, tool=%p, count=%zu/%d", 
-                  server, tool, server ? server->tool_count : 0, MCP_MAX_TOOLS);
+    if (!server || !tool) {
+        LOG_ERROR("Invalid parameters: server=%p, tool=%p", server, tool);
         return false;
     }
     
     LOG_DEBUG("Adding tool '%s' to server '%s'", tool->name, server->server_name);
     
+    pthread_mutex_lock(&server->registry_mutex);
+    
     /* 检查重复的工具名称 */
-    for (size_t i = 0; i < server->tool_count; i++) {
-        if (strcmp(server->tools[i]->name, tool->name) == 0) {
-            LOG_WARN("Tool with name '%s' already exists in server", tool->name);
-            return false;
-        }
+    if (server->tool_index[mcp_server_index_slot(server, tool->name)] != 0) {
+        pthread_mutex_unlock(&server->registry_mutex);
+        LOG_WARN("Tool with name '%s' already exists in server", tool->name);
+        return false;
     }
     
+    if (!mcp_server_reserve_tools(server, server->tool_count + 1)) {
+        pthread_mutex_unlock(&server->registry_mutex);
+        LOG_ERROR("Failed to grow tool registry for '%s'", tool->name);
+        return false;
+    }
+    
+    // 扩容会重建索引，重新定位空槽
     server->tools[server->tool_count] = tool;
     server->tool_count++;
+    server->tool_index[mcp_server_index_slot(server, tool->name)] = server->tool_count;
+    size_t count = server->tool_count;
+    mcp_server_invalidate_tools_list(server);
+    
+    pthread_mutex_unlock(&server->registry_mutex);
     
     LOG_INFO("Tool '%s' added successfully to server '%s' (total tools: %zu)", 
-             tool->name, server->server_name, server->tool_count);
+             tool->name, server->server_name, count);
+    mcp_server_sync_tools(server);
+    return true;
+}
+
+/**
+ * 添加或替换同名工具
+ */
+bool mcp_server_replace_tool(mcp_server_t* server, mcp_tool_t* tool) {
+    if (!server || !tool) {
+        return false;
+    }
+    
+    pthread_mutex_lock(&server->registry_mutex);
+    
+    size_t entry = server->tool_index[mcp_server_index_slot(server, tool->name)];
+    if (entry == 0) {
+        pthread_mutex_unlock(&server->registry_mutex);
+        return mcp_server_add_tool(server, tool);
+    }
+    
+    // 名称相同，索引不变，原位替换
+    mcp_tool_t* old_tool = server->tools[entry - 1];
+    server->tools[entry - 1] = tool;
+    mcp_server_invalidate_tools_list(server);
+    mcp_server_retire_tool(server, old_tool);
+    
+    pthread_mutex_unlock(&server->registry_mutex);
+    
+    LOG_INFO("Tool '%s' replaced in server '%s'", tool->name, server->server_name);
+    mcp_server_sync_tools(server);
+    return true;
+}
+
+/**
+ * 移除并销毁工具
+ */
+bool mcp_server_remove_tool(mcp_server_t* server, const char* name) {
+    if (!server || !name) {
+        return false;
+    }
+    
+    pthread_mutex_lock(&server->registry_mutex);
+    
+    size_t entry = server->tool_index[mcp_server_index_slot(server, name)];
+    if (entry == 0) {
+        pthread_mutex_unlock(&server->registry_mutex);
+        LOG_WARN("Tool '%s' not found, nothing to remove", name);
+        return false;
+    }
+    
+    // 保持注册顺序，后面的工具前移，下标变化后重建索引
+    size_t i = entry - 1;
+    mcp_tool_t* tool = server->tools[i];
+    memmove(&server->tools[i], &server->tools[i + 1], (server->tool_count - i - 1) * sizeof(mcp_tool_t*));
+    server->tool_count--;
+    mcp_server_rebuild_index(server);
+    mcp_server_invalidate_tools_list(server);
+    
+    LOG_INFO("Tool '%s' removed from server '%s' (total tools: %zu)", name, server->server_name, server->tool_count);
+    mcp_server_retire_tool(server, tool);
+    
+    pthread_mutex_unlock(&server->registry_mutex);
+    mcp_server_sync_tools(server);
     return true;
 }
 
+/**
+ * 清空工具的结果缓存
+ */
+bool mcp_server_invalidate_tool_cache(mcp_server_t* server, const char* name) {
+    if (!server) {
+        return false;
+    }
+    
+    pthread_mutex_lock(&server->registry_mutex);
+    bool found = true;
+    if (name) {
+        mcp_tool_t* tool = mcp_server_find_tool_mutable(server, name);
+        mcp_tool_invalidate_result_cache(tool);
+        found = tool != NULL;
+    } else {
+        for (size_t i = 0; i < server->tool_count; i++) {
+            mcp_tool_invalidate_result_cache(server->tools[i]);
+        }
+    }
+    pthread_mutex_unlock(&server->registry_mutex);
+    return found;
+}
+
 /**
  * 向服务器添加简单工具
  */
@@ -144,208 +563,918 @@ bool mcp_server_add_user_only_tool(mcp_server_t* server, const char* name, const
 }
 
 /**
- * 根据名称查找工具
+ * 向服务器添加异步工具
  */
-const mcp_tool_t* mcp_server_find_tool(const mcp_server_t* server, const char* name) {
-    if (!server || !name) {
-        return NULL;
+bool mcp_server_add_async_tool(mcp_server_t* server, const char* name, const char* description,
+                               mcp_property_list_t* properties, mcp_tool_callback_t callback,
+                               int max_concurrency, uint32_t timeout_ms) {
+    mcp_tool_t* tool = mcp_tool_create(name, description, properties, callback);
+    if (!tool) {
+        return false;
     }
     
-    for (size_t i = 0; i < server->tool_count; i++) {
-        if (strcmp(server->tools[i]->name, name) == 0) {
-            return server->tools[i];
-        }
+    mcp_tool_set_async(tool, true, max_concurrency, timeout_ms);
+    
+    if (!mcp_server_add_tool(server, tool)) {
+        mcp_tool_destroy(tool);
+        return false;
     }
     
-    return NULL;
-}
-
-/**
- * 设置消息发送回调函数
- */
-void mcp_server_set_send_callback(mcp_send_message_callback_t callback) {
-    g_send_callback = callback;
+    return true;
 }
 
 /**
- * 解析字符串消息
+ * 向服务器添加接收参数视图的工具
  */
-void mcp_server_parse_message(mcp_server_t* server, const char* message) {
-    if (!server || !message) {
-        return;
+bool mcp_server_add_tool_with_args(mcp_server_t* server, const char* name, const char* description,
+                                   mcp_property_list_t* properties, mcp_tool_args_callback_t args_callback) {
+    mcp_tool_t* tool = mcp_tool_create_with_args(name, description, properties, args_callback);
+    if (!tool) {
+        return false;
     }
     
-    cJSON* json = cJSON_Parse(message);
-    if (!json) {
-        return;
+    if (!mcp_server_add_tool(server, tool)) {
+        mcp_tool_destroy(tool);
+        return false;
     }
     
-    mcp_server_parse_json_message(server, json);
-    cJSON_Delete(json);
+    return true;
 }
 
 /**
- * 解析JSON消息
+ * 注册静态工具表
  */
-void mcp_server_parse_json_message(mcp_server_t* server, const cJSON* json) {
-    if (!server || !json) {
-        LOG_ERROR("Invalid parameters: server=%p, json=%p", server, json);
-        return;
-    }
-    
-    LOG_DEBUG("Parsing JSON message for server '%s'", server->server_name);
-    
-    /* 检查JSONRPC版本 */
-    const cJSON* version = cJSON_GetObjectItem(json, "jsonrpc");
-    if (!version || !cJSON_IsString(version) || strcmp(version->valuestring, "2.0") != 0) {
-        LOG_WARN("Invalid or missing JSONRPC version");
-        return;
+bool mcp_server_add_static_tools(mcp_server_t* server, mcp_tool_t* const* tools, size_t count) {
+    if (!server || (!tools && count > 0)) {
+        return false;
     }
     
-    /* 检查方法名 */
-    const cJSON* method = cJSON_GetObjectItem(json, "method");
-    if (!method || !cJSON_IsString(method)) {
-        LOG_WARN("Invalid or missing method name");
-        return;
+    pthread_mutex_lock(&server->registry_mutex);
+    bool reserved = mcp_server_reserve_tools(server, server->tool_count + count);
+    pthread_mutex_unlock(&server->registry_mutex);
+    if (!reserved) {
+        LOG_ERROR("Failed to grow tool registry for %zu static tools", count);
+        return false;
     }
     
-    LOG_DEBUG("Processing method: '%s'", method->valuestring);
-    
-    /* 跳过通知消息 */
-    if (strstr(method->valuestring, "notifications") == method->valuestring) {
-        LOG_DEBUG("Skipping notification message: '%s'", method->valuestring);
-        return;
+    for (size_t i = 0; i < count; i++) {
+        if (!tools[i] || !tools[i]->static_schema || !mcp_server_add_tool(server, tools[i])) {
+            LOG_ERROR("Failed to add static tool %zu of %zu", i, count);
+            return false;
+        }
     }
-    
-    /* 检查参数 */
-    const cJSON* params = cJSON_GetObjectItem(json, "params");
-    if (params && !cJSON_IsObject(params)) {
-        return;
+    return true;
+}
+
+/**
+ * 释放任务并归还工具的并发名额（调用者持有线程池锁）
+ */
+static void mcp_tool_job_release_locked(mcp_tool_job_t* job) {
+    job->tool->active_calls--;
+    if (job->tool->retired && job->tool->active_calls == 0) {
+        LOG_DEBUG("Destroying retired tool '%s'", job->tool->name);
+        mcp_tool_destroy(job->tool);
     }
-    
-    /* 检查请求ID */
-    const cJSON* id = cJSON_GetObjectItem(json, "id");
-    if (!id || !cJSON_IsNumber(id)) {
-        return;
+    if (job->properties) {
+        mcp_property_list_destroy(job->properties);
     }
-    
-    int id_int = id->valueint;
-    const char* method_str = method->valuestring;
-    
-    // 根据方法名分发处理
-    LOG_INFO("Handling method '%s' with ID %d", method_str, id_int);
-    
-    if (strcmp(method_str, "initialize") == 0) {
-        mcp_server_handle_initialize(server, id_int, params);
-    } else if (strcmp(method_str, "tools/list") == 0) {
-        mcp_server_handle_tools_list(server, id_int, params);
-    } else if (strcmp(method_str, "tools/call") == 0) {
-        mcp_server_handle_tools_call(server, id_int, params);
-    } else {
-        LOG_WARN("Method not implemented: %s", method_str);
-        char error_msg[256];
-        snprintf(error_msg, sizeof(error_msg), "Method not implemented: %s", method_str);
-        mcp_server_reply_error(id_int, error_msg);
+    if (job->arguments) {
+        cJSON_Delete(job->arguments);
     }
+    mcp_tool_stream_release(job->stream);
+    linx_cancel_token_release(job->token);
+    LINX_FREE(job->cache_key);
+    LINX_FREE(job);
 }
 
 /**
- * 回复成功结果
+ * 任务函数即将返回：释放任务，全部结束时唤醒等待停止的线程（调用者持有线程池锁）
  */
-void mcp_server_reply_result(int id, const char* result) {
-    if (!g_send_callback || !result) {
-        return;
-    }
-    
-    char* payload = malloc(strlen(result) + 128);
-    if (!payload) {
-        return;
+static void mcp_worker_pool_finish_locked(mcp_worker_pool_t* pool, mcp_tool_job_t* job) {
+    mcp_tool_job_release_locked(job);
+    pool->outstanding--;
+    pthread_cond_signal(&pool->monitor_cond);
+    if (pool->outstanding == 0) {
+        pthread_cond_broadcast(&pool->idle_cond);
     }
-    
-    sprintf(payload, "{\"jsonrpc\":\"2.0\",\"id\":%d,\"result\":%s}", id, result);
-    g_send_callback(payload);
-    free(payload);
 }
 
 /**
- * 回复错误信息
+ * 从排队列表移除任务（调用者持有线程池锁）
  */
-void mcp_server_reply_error(int id, const char* message) {
-    if (!g_send_callback || !message) {
-        return;
-    }
-    
-    char* payload = malloc(strlen(message) + 128);
-    if (!payload) {
-        return;
+static void mcp_worker_pool_unqueue_locked(mcp_worker_pool_t* pool, mcp_tool_job_t* job) {
+    mcp_tool_job_t* prev = NULL;
+    for (mcp_tool_job_t* it = pool->queue_head; it; prev = it, it = it->next) {
+        if (it != job) {
+            continue;
+        }
+        if (prev) {
+            prev->next = job->next;
+        } else {
+            pool->queue_head = job->next;
+        }
+        if (pool->queue_tail == job) {
+            pool->queue_tail = prev;
+        }
+        break;
     }
-    
-    sprintf(payload, "{\"jsonrpc\":\"2.0\",\"id\":%d,\"error\":{\"message\":\"%s\"}}", id, message);
-    g_send_callback(payload);
-    free(payload);
+    job->next = NULL;
+    job->queued = false;
+    pool->queued--;
 }
 
 /**
- * 设置能力回调函数
+ * 从执行中列表移除任务（调用者持有线程池锁）
  */
-void mcp_server_set_capability_callbacks(mcp_server_t* server, const mcp_capability_callbacks_t* callbacks) {
-    if (server && callbacks) {
-        server->capability_callbacks = *callbacks;
+static void mcp_worker_pool_remove_running_locked(mcp_worker_pool_t* pool, mcp_tool_job_t* job) {
+    mcp_tool_job_t** link = &pool->running;
+    while (*link) {
+        if (*link == job) {
+            *link = job->next;
+            job->next = NULL;
+            return;
+        }
+        link = &(*link)->next;
     }
 }
 
 /**
- * 解析能力配置
+ * 执行器任务：执行工具回调并回复结果
  */
-void mcp_server_parse_capabilities(mcp_server_t* server, const cJSON* capabilities) {
-    if (!server || !capabilities) {
+static void mcp_tool_job_task(void* arg, const linx_cancel_token_t* token) {
+    mcp_tool_job_t* job = (mcp_tool_job_t*)arg;
+    mcp_worker_pool_t* pool = job->pool;
+    mcp_server_t* server = pool->server;
+    
+    pthread_mutex_lock(&pool->mutex);
+    if (job->queued) {
+        mcp_worker_pool_unqueue_locked(pool, job);
+    }
+    // 排队中超时的已由超时检查线程回复；正在停止或执行器销毁时丢弃，不回复
+    if (job->timed_out || pool->stopping || linx_cancel_token_is_cancelled(token)) {
+        mcp_reply_batch_t* batch = job->timed_out ? NULL : job->batch;
+        mcp_worker_pool_finish_locked(pool, job);
+        pthread_mutex_unlock(&pool->mutex);
+        if (batch) {
+            mcp_reply_batch_release(batch);
+        }
         return;
     }
+    job->next = pool->running;
+    pool->running = job;
+    pthread_mutex_unlock(&pool->mutex);
     
-    // 解析摄像头能力配置
-    const cJSON* camera = cJSON_GetObjectItem(capabilities, "camera");
-    if (camera && cJSON_IsObject(camera)) {
-        const cJSON* explain_url = cJSON_GetObjectItem(camera, "explain_url");
-        const cJSON* token = cJSON_GetObjectItem(camera, "token");
-        
-        if (explain_url && cJSON_IsString(explain_url) && 
-            token && cJSON_IsString(token) &&
-            server->capability_callbacks.camera_set_explain_url) {
-            // 调用摄像头解释URL设置回调
-            server->capability_callbacks.camera_set_explain_url(
-                explain_url->valuestring, 
-                token->valuestring
-            );
-        }
+    LOG_DEBUG("Running async tool '%s' (id=%d)", job->tool->name, job->id);
+    uint64_t callback_start_us = job->stats ? mcp_time_now_us() : 0;
+    mcp_tool_call_frame_t frame = { server, job->id, job->progress_token, job, NULL };
+    t_tool_call = &frame;
+    mcp_return_value_t result;
+    if (job->tool->args_callback) {
+        mcp_arguments_t args = { job->arguments, job->tool->properties };
+        result = job->tool->args_callback(&args);
+    } else {
+        result = job->tool->callback(job->properties);
     }
+    t_tool_call = NULL;
     
-    // 可以在这里添加其他能力的解析逻辑
-}
+    // 响应之前结束推送，晚到的分块不会排在响应后面
+    mcp_tool_stream_finish(frame.stream);
+    mcp_tool_stream_release(frame.stream);
+    uint64_t callback_end_us = job->stats ? mcp_time_now_us() : 0;
+    
+    pthread_mutex_lock(&pool->mutex);
+    mcp_worker_pool_remove_running_locked(pool, job);
+    bool timed_out = job->timed_out;
+    int id = job->id;
+    const char* tool_name = job->tool->name;
+    mcp_reply_batch_t* batch = job->batch;
+    pthread_mutex_unlock(&pool->mutex);
+    
+    // 回复在锁外进行，发送回调可能较慢；超时的调用已由超时检查线程回复
+    if (timed_out) {
+        LOG_WARN("Async tool '%s' (id=%d) finished after its timeout, result dropped", tool_name, id);
+        mcp_return_value_cleanup(&result, result.type);
+        if (job->stats) {
+            __atomic_fetch_add(&job->stats->errors, 1, __ATOMIC_RELAXED);
+        }
+    } else {
+        t_reply_batch = batch;
+        size_t reply_bytes = mcp_server_reply_tool_result(server, job->tool, job->cache_key, id, &result);
+        t_reply_batch = NULL;
+        if (job->stats) {
+            mcp_server_profile_call(server, job->tool, job->stats, true, job->args_us, callback_start_us,
+                                    callback_end_us, reply_bytes);
+        }
+        if (batch) {
+            mcp_reply_batch_release(batch);
+        }
+    }
+    
+    pthread_mutex_lock(&pool->mutex);
+    mcp_worker_pool_finish_locked(pool, job);
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+/**
+ * 超时检查线程：到期的调用立即回复错误，排队中的直接取消
+ */
+static void* mcp_monitor_thread(void* arg) {
+    mcp_worker_pool_t* pool = (mcp_worker_pool_t*)arg;
+    linx_thread_stats_register("mcp_monitor", LINX_THREAD_STAGE_MCP);
+    
+    pthread_mutex_lock(&pool->mutex);
+    while (!pool->stopping) {
+        uint64_t now = mcp_time_now_ms();
+        uint64_t next_deadline = UINT64_MAX;
+        int expired_ids[MCP_MONITOR_BATCH];
+        mcp_reply_batch_t* expired_batches[MCP_MONITOR_BATCH];
+        mcp_tool_stream_t* expired_streams[MCP_MONITOR_BATCH];
+        size_t expired_count = 0;
+        
+        // 执行中的任务只标记超时，结果由工作线程丢弃
+        for (mcp_tool_job_t* job = pool->running; job; job = job->next) {
+            if (job->timed_out) {
+                continue;
+            }
+            if (job->deadline_ms <= now && expired_count < MCP_MONITOR_BATCH) {
+                job->timed_out = true;
+                linx_cancel_token_cancel(job->token);
+                expired_batches[expired_count] = job->batch;
+                expired_streams[expired_count] = job->stream ? mcp_tool_stream_retain(job->stream) : NULL;
+                expired_ids[expired_count++] = job->id;
+            } else if (job->deadline_ms < next_deadline) {
+                next_deadline = job->deadline_ms;
+            }
+        }
+        
+        // 排队中已到期的任务不再执行，由执行器任务开始时释放
+        mcp_tool_job_t* job = pool->queue_head;
+        while (job) {
+            mcp_tool_job_t* next = job->next;
+            if (job->deadline_ms <= now && expired_count < MCP_MONITOR_BATCH) {
+                mcp_worker_pool_unqueue_locked(pool, job);
+                job->timed_out = true;
+                linx_cancel_token_cancel(job->token);
+                expired_batches[expired_count] = job->batch;
+                expired_streams[expired_count] = NULL;
+                expired_ids[expired_count++] = job->id;
+                LOG_WARN("Async tool '%s' (id=%d) timed out in queue", job->tool->name, job->id);
+            } else if (job->deadline_ms < next_deadline) {
+                next_deadline = job->deadline_ms;
+            }
+            job = next;
+        }
+        
+        if (expired_count > 0) {
+            pthread_mutex_unlock(&pool->mutex);
+            for (size_t i = 0; i < expired_count; i++) {
+                LOG_WARN("Async tool call %d timed out", expired_ids[i]);
+                mcp_tool_stream_finish(expired_streams[i]);
+                mcp_tool_stream_release(expired_streams[i]);
+                t_reply_batch = expired_batches[i];
+                mcp_server_reply_error(pool->server, expired_ids[i], "Tool execution timed out");
+                t_reply_batch = NULL;
+                if (expired_batches[i]) {
+                    mcp_reply_batch_release(expired_batches[i]);
+                }
+            }
+            pthread_mutex_lock(&pool->mutex);
+            continue;
+        }
+        
+        // 等到最早的截止时间，单次最多等待 MCP_MONITOR_MAX_WAIT_MS
+        if (next_deadline == UINT64_MAX) {
+            pthread_cond_wait(&pool->monitor_cond, &pool->mutex);
+        } else {
+            uint64_t wait_ms = next_deadline - now;
+            if (wait_ms > MCP_MONITOR_MAX_WAIT_MS) {
+                wait_ms = MCP_MONITOR_MAX_WAIT_MS;
+            }
+            struct timeval tv;
+            gettimeofday(&tv, NULL);
+            uint64_t abs_us = (uint64_t)tv.tv_sec * 1000000 + (uint64_t)tv.tv_usec + wait_ms * 1000;
+            struct timespec abstime = {
+                .tv_sec = (time_t)(abs_us / 1000000),
+                .tv_nsec = (long)(abs_us % 1000000) * 1000
+            };
+            pthread_cond_timedwait(&pool->monitor_cond, &pool->mutex, &abstime);
+        }
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    linx_thread_stats_unregister();
+    return NULL;
+}
+
+/**
+ * 在执行器上启动线程池
+ */
+static bool mcp_server_start_pool(mcp_server_t* server, linx_executor_t* executor, bool owns_executor,
+                                  size_t queue_capacity) {
+    if (queue_capacity == 0) {
+        queue_capacity = MCP_DEFAULT_QUEUE_CAPACITY;
+    }
+    
+    mcp_worker_pool_t* pool = LINX_CALLOC(1, sizeof(mcp_worker_pool_t));
+    if (!pool) {
+        LOG_ERROR("Failed to allocate MCP worker pool");
+        if (owns_executor) {
+            linx_executor_destroy(executor);
+        }
+        return false;
+    }
+    pool->executor = executor;
+    pool->owns_executor = owns_executor;
+    pool->capacity = queue_capacity;
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->idle_cond, NULL);
+    pthread_cond_init(&pool->monitor_cond, NULL);
+    pool->server = server;
+    server->worker_pool = pool;
+    
+    pool->monitor_started = pthread_create(&pool->monitor, NULL, mcp_monitor_thread, pool) == 0;
+    if (!pool->monitor_started) {
+        LOG_ERROR("Failed to start MCP worker pool");
+        mcp_server_stop_workers(server);
+        return false;
+    }
+    
+    LOG_INFO("MCP worker pool started: %zu workers%s, queue capacity %zu",
+             linx_executor_worker_count(executor), owns_executor ? "" : " (shared)", pool->capacity);
+    return true;
+}
+
+/**
+ * 启动异步工具线程池
+ */
+bool mcp_server_start_workers(mcp_server_t* server, size_t worker_count, size_t queue_capacity) {
+    if (!server) {
+        return false;
+    }
+    if (server->worker_pool) {
+        LOG_WARN("MCP worker pool already running");
+        return true;
+    }
+    
+    linx_executor_config_t config = {
+        .workers = worker_count > 0 ? worker_count : MCP_DEFAULT_WORKER_COUNT,
+        .thread = { .name = "mcp_worker" },
+    };
+    linx_executor_t* executor = linx_executor_create(&config);
+    if (!executor) {
+        LOG_ERROR("Failed to start MCP worker threads");
+        return false;
+    }
+    return mcp_server_start_pool(server, executor, true, queue_capacity);
+}
+
+/**
+ * 在共享执行器上启动异步工具线程池
+ */
+bool mcp_server_start_workers_on(mcp_server_t* server, linx_executor_t* executor, size_t queue_capacity) {
+    if (!server || !executor) {
+        return false;
+    }
+    if (server->worker_pool) {
+        LOG_WARN("MCP worker pool already running");
+        return true;
+    }
+    return mcp_server_start_pool(server, executor, false, queue_capacity);
+}
+
+/**
+ * 停止异步工具线程池
+ */
+void mcp_server_stop_workers(mcp_server_t* server) {
+    if (!server || !server->worker_pool) {
+        return;
+    }
+    
+    mcp_worker_pool_t* pool = server->worker_pool;
+    
+    // 排队中的任务开始时直接丢弃，执行中的通过令牌请求提前结束
+    pthread_mutex_lock(&pool->mutex);
+    pool->stopping = true;
+    for (mcp_tool_job_t* job = pool->running; job; job = job->next) {
+        linx_cancel_token_cancel(job->token);
+    }
+    for (mcp_tool_job_t* job = pool->queue_head; job; job = job->next) {
+        linx_cancel_token_cancel(job->token);
+    }
+    pthread_cond_broadcast(&pool->monitor_cond);
+    while (pool->outstanding > 0) {
+        pthread_cond_wait(&pool->idle_cond, &pool->mutex);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    
+    if (pool->monitor_started) {
+        pthread_join(pool->monitor, NULL);
+    }
+    if (pool->owns_executor) {
+        linx_executor_destroy(pool->executor);
+    }
+    
+    pthread_cond_destroy(&pool->monitor_cond);
+    pthread_cond_destroy(&pool->idle_cond);
+    pthread_mutex_destroy(&pool->mutex);
+    LINX_FREE(pool);
+    server->worker_pool = NULL;
+    
+    LOG_INFO("MCP worker pool stopped");
+}
+
+/**
+ * 当前工具调用是否已被取消
+ */
+bool mcp_tool_call_is_cancelled(void) {
+    mcp_tool_call_frame_t* frame = t_tool_call;
+    return frame && frame->job && linx_cancel_token_is_cancelled(frame->job->token);
+}
+
+/**
+ * 把异步工具调用提交到线程池，成功后任务接管 properties、arguments 和 cache_key
+ * @return 失败时返回错误消息，成功返回NULL
+ */
+static const char* mcp_server_submit_tool_job(mcp_server_t* server, mcp_tool_t* tool, int id,
+                                              mcp_property_list_t* properties, cJSON* arguments,
+                                              char* cache_key, const char* progress_token,
+                                              mcp_tool_stats_t* stats, uint32_t args_us) {
+    mcp_worker_pool_t* pool = server->worker_pool;
+    
+    mcp_tool_job_t* job = LINX_CALLOC(1, sizeof(mcp_tool_job_t));
+    linx_cancel_token_t* token = linx_cancel_token_create();
+    if (!job || !token) {
+        LINX_FREE(job);
+        linx_cancel_token_release(token);
+        return "Failed to queue tool call - memory allocation error";
+    }
+    job->pool = pool;
+    job->token = token;
+    job->tool = tool;
+    job->id = id;
+    job->properties = properties;
+    job->arguments = arguments;
+    job->cache_key = cache_key;
+    job->stats = stats;
+    job->args_us = args_us;
+    job->deadline_ms = mcp_time_now_ms() + tool->timeout_ms;
+    strcpy(job->progress_token, progress_token);
+    
+    pthread_mutex_lock(&pool->mutex);
+    if (tool->active_calls >= tool->max_concurrency) {
+        pthread_mutex_unlock(&pool->mutex);
+        linx_cancel_token_release(token);
+        LINX_FREE(job);
+        return "Tool is busy, too many concurrent calls";
+    }
+    // 任务开始时先取线程池锁，下面登记完成之前不会执行
+    if (pool->queued >= pool->capacity ||
+        !linx_executor_submit(pool->executor, LINX_TASK_PRIORITY_HIGH, mcp_tool_job_task, job, token)) {
+        pthread_mutex_unlock(&pool->mutex);
+        linx_cancel_token_release(token);
+        LINX_FREE(job);
+        return "Server is busy, too many pending tool calls";
+    }
+    
+    tool->active_calls++;
+    if (t_reply_batch) {
+        // 批量请求中的调用：批量响应等到它完成后才发送
+        pthread_mutex_lock(&t_reply_batch->mutex);
+        t_reply_batch->pending++;
+        pthread_mutex_unlock(&t_reply_batch->mutex);
+        job->batch = t_reply_batch;
+    }
+    if (pool->queue_tail) {
+        pool->queue_tail->next = job;
+    } else {
+        pool->queue_head = job;
+    }
+    pool->queue_tail = job;
+    job->queued = true;
+    pool->queued++;
+    pool->outstanding++;
+    pthread_cond_signal(&pool->monitor_cond);
+    pthread_mutex_unlock(&pool->mutex);
+    
+    LOG_DEBUG("Queued async tool '%s' (id=%d)", tool->name, id);
+    return NULL;
+}
+
+/**
+ * 按名称查找可修改的工具（内部使用）
+ */
+static mcp_tool_t* mcp_server_find_tool_mutable(mcp_server_t* server, const char* name) {
+    size_t entry = server->tool_index[mcp_server_index_slot(server, name)];
+    return entry ? server->tools[entry - 1] : NULL;
+}
+
+/**
+ * 根据名称查找工具
+ */
+const mcp_tool_t* mcp_server_find_tool(const mcp_server_t* server, const char* name) {
+    if (!server || !name) {
+        return NULL;
+    }
+    
+    mcp_server_t* registry = (mcp_server_t*)server;
+    pthread_mutex_lock(&registry->registry_mutex);
+    const mcp_tool_t* tool = mcp_server_find_tool_mutable(registry, name);
+    pthread_mutex_unlock(&registry->registry_mutex);
+    
+    return tool;
+}
+
+/**
+ * 设置服务器实例的消息发送回调
+ */
+void mcp_server_set_send_handler(mcp_server_t* server, mcp_server_send_handler_t handler, void* user_data) {
+    if (!server) {
+        return;
+    }
+    server->send_handler = handler;
+    server->send_user_data = user_data;
+}
+
+/**
+ * 是否有可用的发送回调
+ */
+static bool mcp_server_can_send(const mcp_server_t* server) {
+    return server && server->send_handler;
+}
+
+/**
+ * 直接发送消息
+ */
+static void mcp_server_send_direct(mcp_server_t* server, const char* payload) {
+    if (server && server->send_handler) {
+        server->send_handler(payload, server->send_user_data);
+    }
+}
+
+/**
+ * 把响应加入批量响应
+ */
+static void mcp_reply_batch_add(mcp_reply_batch_t* batch, const char* payload) {
+    size_t length = strlen(payload);
+    
+    pthread_mutex_lock(&batch->mutex);
+    size_t needed = batch->length + length + 1;
+    if (needed > batch->capacity) {
+        size_t capacity = batch->capacity ? batch->capacity : 256;
+        while (capacity < needed) {
+            capacity *= 2;
+        }
+        char* json = LINX_REALLOC(batch->json, capacity);
+        if (!json) {
+            pthread_mutex_unlock(&batch->mutex);
+            LOG_ERROR("Failed to grow batch response, reply dropped");
+            return;
+        }
+        batch->json = json;
+        batch->capacity = capacity;
+    }
+    if (batch->count > 0) {
+        batch->json[batch->length++] = ',';
+    }
+    memcpy(batch->json + batch->length, payload, length);
+    batch->length += length;
+    batch->count++;
+    pthread_mutex_unlock(&batch->mutex);
+}
+
+/**
+ * 结束批量请求中的一项未完成工作；全部完成时发送批量响应并释放
+ * 由最后完成的线程（收消息的线程或工作线程）执行发送
+ */
+static void mcp_reply_batch_release(mcp_reply_batch_t* batch) {
+    pthread_mutex_lock(&batch->mutex);
+    bool done = --batch->pending == 0;
+    pthread_mutex_unlock(&batch->mutex);
+    if (!done) {
+        return;
+    }
+    
+    // 全是通知时不发送响应
+    if (batch->count > 0) {
+        char* payload = LINX_MALLOC(batch->length + 3);
+        if (payload) {
+            payload[0] = '[';
+            memcpy(payload + 1, batch->json, batch->length);
+            payload[batch->length + 1] = ']';
+            payload[batch->length + 2] = '\0';
+            mcp_server_send_direct(batch->server, payload);
+            LINX_FREE(payload);
+        } else {
+            LOG_ERROR("Failed to allocate batch response");
+        }
+    }
+    
+    pthread_mutex_destroy(&batch->mutex);
+    LINX_FREE(batch->json);
+    LINX_FREE(batch);
+}
+
+/**
+ * 发送一条完整的 JSON-RPC 消息；处理批量请求期间加入批量响应
+ */
+static void mcp_server_send(mcp_server_t* server, const char* payload) {
+    if (t_reply_batch) {
+        mcp_reply_batch_add(t_reply_batch, payload);
+    } else {
+        mcp_server_send_direct(server, payload);
+    }
+}
+
+/**
+ * 处理 JSON-RPC 批量请求
+ * 各请求依次分发：同步工具在当前线程执行，异步工具在线程池中并行执行，
+ * 所有响应收齐后作为一个数组回复
+ */
+static void mcp_server_parse_batch(mcp_server_t* server, const cJSON* batch_json) {
+    if (cJSON_GetArraySize(batch_json) == 0) {
+        LOG_WARN("Empty JSON-RPC batch");
+        return;
+    }
+    if (t_reply_batch) {
+        LOG_WARN("Nested JSON-RPC batch ignored");
+        return;
+    }
+    
+    mcp_reply_batch_t* batch = LINX_CALLOC(1, sizeof(mcp_reply_batch_t));
+    if (!batch) {
+        LOG_ERROR("Failed to allocate batch context");
+        return;
+    }
+    pthread_mutex_init(&batch->mutex, NULL);
+    batch->server = server;
+    batch->pending = 1;     // 分发期间的占位，防止异步调用先完成时提前发送
+    
+    t_reply_batch = batch;
+    const cJSON* request = NULL;
+    cJSON_ArrayForEach(request, batch_json) {
+        if (!cJSON_IsObject(request)) {
+            LOG_WARN("Skipping non-object entry in JSON-RPC batch");
+            continue;
+        }
+        mcp_server_parse_json_message(server, request);
+    }
+    t_reply_batch = NULL;
+    
+    mcp_reply_batch_release(batch);
+}
+
+/**
+ * 解析字符串消息
+ */
+void mcp_server_parse_message(mcp_server_t* server, const char* message) {
+    if (!server || !message) {
+        return;
+    }
+    
+    cJSON* json = cJSON_Parse(message);
+    if (!json) {
+        return;
+    }
+    
+    mcp_server_parse_json_message(server, json);
+    cJSON_Delete(json);
+}
+
+/**
+ * 解析JSON消息
+ */
+void mcp_server_parse_json_message(mcp_server_t* server, const cJSON* json) {
+    if (!server || !json) {
+        LOG_ERROR("Invalid parameters: server=%p, json=%p", server, json);
+        return;
+    }
+    
+    if (cJSON_IsArray(json)) {
+        mcp_server_parse_batch(server, json);
+        return;
+    }
+    
+    LOG_DEBUG("Parsing JSON message for server '%s'", server->server_name);
+    
+    /* 检查JSONRPC版本 */
+    const cJSON* version = cJSON_GetObjectItemCaseSensitive(json, "jsonrpc");
+    if (!version || !cJSON_IsString(version) || strcmp(version->valuestring, "2.0") != 0) {
+        LOG_WARN("Invalid or missing JSONRPC version");
+        return;
+    }
+    
+    /* 检查方法名 */
+    const cJSON* method = cJSON_GetObjectItemCaseSensitive(json, "method");
+    if (!method || !cJSON_IsString(method)) {
+        LOG_WARN("Invalid or missing method name");
+        return;
+    }
+    
+    LOG_DEBUG("Processing method: '%s'", method->valuestring);
+    
+    /* 状态同步的确认是客户端发来的通知 */
+    if (strcmp(method->valuestring, "notifications/state/ack") == 0) {
+        const cJSON* ack_params = cJSON_GetObjectItemCaseSensitive(json, "params");
+        mcp_state_sync_handle_ack(&server->state_sync, ack_params, mcp_server_state_send, server);
+        return;
+    }
+    
+    /* 跳过通知消息 */
+    if (strstr(method->valuestring, "notifications") == method->valuestring) {
+        LOG_DEBUG("Skipping notification message: '%s'", method->valuestring);
+        return;
+    }
+    
+    /* 检查参数 */
+    const cJSON* params = cJSON_GetObjectItemCaseSensitive(json, "params");
+    if (params && !cJSON_IsObject(params)) {
+        return;
+    }
+    
+    /* 检查请求ID */
+    const cJSON* id = cJSON_GetObjectItemCaseSensitive(json, "id");
+    if (!id || !cJSON_IsNumber(id)) {
+        return;
+    }
+    
+    int id_int = id->valueint;
+    const char* method_str = method->valuestring;
+    
+    // 根据方法名分发处理
+    LOG_INFO("Handling method '%s' with ID %d", method_str, id_int);
+    
+    LINX_TRACEPOINT_BEGIN(mcp_dispatch);
+    mcp_method_handler_t handler = mcp_server_find_method_handler(method_str);
+    if (handler) {
+        /* 响应构建期间的 cJSON 节点从竞技场分配，处理结束后整体回收 */
+        linx_json_arena_scope_t arena_scope;
+        linx_json_arena_begin(server->json_arena, &arena_scope);
+        handler(server, id_int, params);
+        linx_json_arena_end(&arena_scope);
+    } else {
+        LOG_WARN("Method not implemented: %s", method_str);
+        char error_msg[256];
+        snprintf(error_msg, sizeof(error_msg), "Method not implemented: %s", method_str);
+        mcp_server_reply_error(server, id_int, error_msg);
+    }
+    LINX_TRACEPOINT_END(mcp_dispatch, id_int, handler != NULL);
+}
+
+/**
+ * 回复成功结果
+ */
+void mcp_server_reply_result(mcp_server_t* server, int id, const char* result) {
+    if (!mcp_server_can_send(server) || !result) {
+        return;
+    }
+    
+    char* payload = LINX_MALLOC(strlen(result) + 128);
+    if (!payload) {
+        return;
+    }
+    
+    sprintf(payload, "{\"jsonrpc\":\"2.0\",\"id\":%d,\"result\":%s}", id, result);
+    mcp_server_send(server, payload);
+    LINX_FREE(payload);
+}
+
+/**
+ * 回复错误信息
+ */
+void mcp_server_reply_error(mcp_server_t* server, int id, const char* message) {
+    if (!mcp_server_can_send(server) || !message) {
+        return;
+    }
+    
+    char* payload = LINX_MALLOC(strlen(message) + 128);
+    if (!payload) {
+        return;
+    }
+    
+    sprintf(payload, "{\"jsonrpc\":\"2.0\",\"id\":%d,\"error\":{\"message\":\"%s\"}}", id, message);
+    mcp_server_send(server, payload);
+    LINX_FREE(payload);
+}
+
+/**
+ * 设置能力回调函数
+ */
+void mcp_server_set_capability_callbacks(mcp_server_t* server, const mcp_capability_callbacks_t* callbacks) {
+    if (server && callbacks) {
+        server->capability_callbacks = *callbacks;
+        // 新的回调还没有收到过能力配置
+        server->capabilities_parsed = false;
+    }
+}
+
+/**
+ * 解析能力配置
+ */
+void mcp_server_parse_capabilities(mcp_server_t* server, const cJSON* capabilities) {
+    if (!server || !capabilities) {
+        return;
+    }
+    
+    // 直接调用时不记录哈希，下次 initialize 照常解析
+    server->capabilities_parsed = false;
+    
+    // 解析摄像头能力配置
+    const cJSON* camera = cJSON_GetObjectItemCaseSensitive(capabilities, "camera");
+    if (camera && cJSON_IsObject(camera)) {
+        const cJSON* explain_url = cJSON_GetObjectItemCaseSensitive(camera, "explain_url");
+        const cJSON* token = cJSON_GetObjectItemCaseSensitive(camera, "token");
+        
+        if (explain_url && cJSON_IsString(explain_url) && 
+            token && cJSON_IsString(token) &&
+            server->capability_callbacks.camera_set_explain_url) {
+            // 调用摄像头解释URL设置回调
+            bool arena_suspended = linx_json_arena_suspend();
+            server->capability_callbacks.camera_set_explain_url(
+                explain_url->valuestring, 
+                token->valuestring
+            );
+            linx_json_arena_resume(arena_suspended);
+        }
+    }
+    
+    // 状态增量同步（见 mcp_state_sync.h）
+    const cJSON* state_sync = cJSON_GetObjectItemCaseSensitive(capabilities, "stateSync");
+    server->client_state_sync = cJSON_IsObject(state_sync) &&
+                                cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(state_sync, "mergePatch"));
+    
+    // 可以在这里添加其他能力的解析逻辑
+}
+
+/**
+ * JSON 结构哈希（FNV-1a）：依次混入类型、键名、值和子节点，与打印后逐字节比较等价（不计空白）
+ */
+static uint64_t mcp_hash_bytes(uint64_t hash, const void* data, size_t length) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static uint64_t mcp_json_hash(const cJSON* item, uint64_t hash) {
+    unsigned char type = (unsigned char)(item->type & 0xFF);
+    hash = mcp_hash_bytes(hash, &type, 1);
+    if (item->string) {
+        hash = mcp_hash_bytes(hash, item->string, strlen(item->string) + 1);
+    }
+    if ((cJSON_IsString(item) || cJSON_IsRaw(item)) && item->valuestring) {
+        hash = mcp_hash_bytes(hash, item->valuestring, strlen(item->valuestring) + 1);
+    } else if (cJSON_IsNumber(item)) {
+        hash = mcp_hash_bytes(hash, &item->valuedouble, sizeof(item->valuedouble));
+    }
+    for (const cJSON* child = item->child; child; child = child->next) {
+        hash = mcp_json_hash(child, hash);
+    }
+    // 子节点结束标记，区分嵌套层次
+    unsigned char end = 0xFF;
+    return mcp_hash_bytes(hash, &end, 1);
+}
 
 /**
  * 处理初始化请求
  */
 void mcp_server_handle_initialize(mcp_server_t* server, int id, const cJSON* params) {
     if (!server) {
-        mcp_server_reply_error(id, "Server not initialized");
+        mcp_server_reply_error(server, id, "Server not initialized");
         return;
     }
     
-    // 解析客户端能力配置
-    if (params) {
-        const cJSON* capabilities = cJSON_GetObjectItem(params, "capabilities");
-        if (capabilities) {
+    // 新会话：旧客户端的确认不再有效
+    mcp_state_sync_reset(&server->state_sync);
+    
+    // 解析客户端能力配置；重连时通常与上次完全相同，此时能力回调已按这些值调用过，
+    // 沿用上次的解析结果（64位结构哈希，碰撞概率可以忽略）
+    const cJSON* capabilities = params ? cJSON_GetObjectItemCaseSensitive(params, "capabilities") : NULL;
+    if (capabilities) {
+        uint64_t hash = mcp_json_hash(capabilities, 14695981039346656037ULL);
+        if (server->capabilities_parsed && server->capabilities_hash == hash) {
+            LOG_DEBUG("Client capabilities unchanged, skipping parse");
+        } else {
+            server->client_state_sync = false;
             mcp_server_parse_capabilities(server, capabilities);
+            server->capabilities_hash = hash;
+            server->capabilities_parsed = true;
         }
+    } else {
+        server->client_state_sync = false;
+        server->capabilities_parsed = false;
     }
     
-    // 构建初始化响应
-    char result[512];
-    snprintf(result, sizeof(result), 
-        "{\"protocolVersion\":\"%s\",\"capabilities\":{\"tools\":{\"listChanged\":false}},\"serverInfo\":{\"name\":\"%s\",\"version\":\"%s\"}}",
-        MCP_PROTOCOL_VERSION, server->server_name, server->server_version);
+    mcp_server_reply_result(server, id, server->initialize_result);
     
-    mcp_server_reply_result(id, result);
+    // 响应之后发送各资源的完整对象，此后只发送补丁
+    if (server->client_state_sync) {
+        mcp_server_publish_tools(server);
+        mcp_state_sync_activate(&server->state_sync, mcp_server_state_send, server);
+    }
+    
+    // 离线或上次会话结束后在本地执行的调用
+    mcp_server_flush_local_calls(server);
 }
 
 /**
@@ -353,7 +1482,7 @@ void mcp_server_handle_initialize(mcp_server_t* server, int id, const cJSON* par
  */
 void mcp_server_handle_tools_list(mcp_server_t* server, int id, const cJSON* params) {
     if (!server) {
-        mcp_server_reply_error(id, "Server not initialized");
+        mcp_server_reply_error(server, id, "Server not initialized");
         return;
     }
     
@@ -362,12 +1491,12 @@ void mcp_server_handle_tools_list(mcp_server_t* server, int id, const cJSON* par
     
     // 解析参数
     if (params) {
-        const cJSON* cursor_json = cJSON_GetObjectItem(params, "cursor");
+        const cJSON* cursor_json = cJSON_GetObjectItemCaseSensitive(params, "cursor");
         if (cursor_json && cJSON_IsString(cursor_json)) {
             cursor = cursor_json->valuestring;
         }
         
-        const cJSON* user_only = cJSON_GetObjectItem(params, "listUserOnlyTools");
+        const cJSON* user_only = cJSON_GetObjectItemCaseSensitive(params, "listUserOnlyTools");
         if (user_only && cJSON_IsBool(user_only)) {
             list_user_only_tools = cJSON_IsTrue(user_only);
         }
@@ -376,10 +1505,28 @@ void mcp_server_handle_tools_list(mcp_server_t* server, int id, const cJSON* par
     // 获取工具列表JSON
     char* tools_json = mcp_server_get_tools_list_json(server, cursor, list_user_only_tools);
     if (tools_json) {
-        mcp_server_reply_result(id, tools_json);
-        free(tools_json);
+        mcp_server_reply_result(server, id, tools_json);
+        cJSON_free(tools_json);
+    } else if (cursor) {
+        mcp_server_reply_error(server, id, "Invalid cursor");
     } else {
-        mcp_server_reply_error(id, "Failed to generate tools list");
+        mcp_server_reply_error(server, id, "Failed to generate tools list");
+    }
+}
+
+/**
+ * 读取 params._meta.progressToken（字符串或数字），打印为JSON文本；未携带或过长时为空串
+ */
+static void mcp_server_read_progress_token(const cJSON* params, char token[MCP_PROGRESS_TOKEN_MAX]) {
+    token[0] = '\0';
+    const cJSON* meta = cJSON_GetObjectItemCaseSensitive(params, "_meta");
+    const cJSON* value = cJSON_GetObjectItemCaseSensitive(meta, "progressToken");
+    if (!cJSON_IsString(value) && !cJSON_IsNumber(value)) {
+        return;
+    }
+    if (!cJSON_PrintPreallocated((cJSON*)value, token, MCP_PROGRESS_TOKEN_MAX, 0)) {
+        LOG_WARN("Progress token too long, progress notifications disabled");
+        token[0] = '\0';
     }
 }
 
@@ -388,87 +1535,378 @@ void mcp_server_handle_tools_list(mcp_server_t* server, int id, const cJSON* par
  */
 void mcp_server_handle_tools_call(mcp_server_t* server, int id, const cJSON* params) {
     if (!server || !params) {
-        mcp_server_reply_error(id, "Invalid parameters");
+        mcp_server_reply_error(server, id, "Invalid parameters");
         return;
     }
     
     // 获取工具名称
-    const cJSON* name_json = cJSON_GetObjectItem(params, "name");
+    const cJSON* name_json = cJSON_GetObjectItemCaseSensitive(params, "name");
     if (!name_json || !cJSON_IsString(name_json)) {
-        mcp_server_reply_error(id, "Tool name is required");
+        mcp_server_reply_error(server, id, "Tool name is required");
         return;
     }
     
     const char* tool_name = name_json->valuestring;
     
-    // 查找工具
-    const mcp_tool_t* tool = mcp_server_find_tool(server, tool_name);
+    // 查找工具；同步回调执行期间持有工具表锁，防止工具被并发移除
+    pthread_mutex_lock(&server->registry_mutex);
+    mcp_tool_t* tool = mcp_server_find_tool_mutable(server, tool_name);
     if (!tool) {
+        pthread_mutex_unlock(&server->registry_mutex);
         char error_msg[256];
         snprintf(error_msg, sizeof(error_msg), "Tool not found: %s", tool_name);
-        mcp_server_reply_error(id, error_msg);
+        mcp_server_reply_error(server, id, error_msg);
         return;
     }
     
-    // 解析工具参数
-    const cJSON* arguments = cJSON_GetObjectItem(params, "arguments");
+    // 开启剖析时从找到工具开始计时：缓存查找、参数校验和转换都算作参数转换
+    mcp_tool_stats_t* stats = mcp_server_tool_stats(server, tool);
+    uint64_t args_start_us = stats ? mcp_time_now_us() : 0;
+    bool run_async = tool->async && server->worker_pool;
+    const cJSON* arguments = cJSON_GetObjectItemCaseSensitive(params, "arguments");
     mcp_property_list_t* properties = NULL;
+    cJSON* arguments_copy = NULL;
+    char progress_token[MCP_PROGRESS_TOKEN_MAX];
+    mcp_server_read_progress_token(params, progress_token);
     
-    if (arguments && cJSON_IsObject(arguments)) {
-        // 将JSON参数转换为属性列表
-        properties = mcp_property_list_create();
-        if (properties) {
-            // 遍历JSON对象的所有字段
-            const cJSON* arg = NULL;
-            cJSON_ArrayForEach(arg, arguments) {
-                const char* key = arg->string;
-                if (key) {
-                    if (cJSON_IsBool(arg)) {
-                        mcp_property_t* prop = mcp_property_create_boolean(key, cJSON_IsTrue(arg), true);
-                        if (prop) {
-                            mcp_property_list_add(properties, prop);
-                            mcp_property_destroy(prop);
-                        }
-                    } else if (cJSON_IsNumber(arg)) {
-                        mcp_property_t* prop = mcp_property_create_integer(key, arg->valueint, true, false, 0, 0);
-                        if (prop) {
-                            mcp_property_list_add(properties, prop);
-                            mcp_property_destroy(prop);
-                        }
-                    } else if (cJSON_IsString(arg)) {
-                        mcp_property_t* prop = mcp_property_create_string(key, arg->valuestring, true);
-                        if (prop) {
-                            mcp_property_list_add(properties, prop);
-                            mcp_property_destroy(prop);
-                        }
-                    }
-                }
+    // 启用结果缓存的工具：相同参数的未过期结果直接回复，不执行回调
+    char* cache_key = mcp_tool_result_cache_key(tool, arguments);
+    if (cache_key) {
+        char* cached = mcp_tool_result_cache_lookup(tool, cache_key);
+        if (cached) {
+            pthread_mutex_unlock(&server->registry_mutex);
+            if (stats) {
+                __atomic_fetch_add(&stats->cache_hits, 1, __ATOMIC_RELAXED);
             }
+            LINX_FREE(cache_key);
+            mcp_server_reply_result(server, id, cached);
+            LINX_FREE(cached);
+            return;
         }
     }
     
-    // 调用工具回调函数
-    mcp_return_value_t result = tool->callback(properties);
+    if (tool->args_callback) {
+        // 参数视图工具：按声明校验一次，回调直接读取 arguments
+        char error_msg[256];
+        if (!mcp_arguments_validate(arguments, tool->properties, error_msg, sizeof(error_msg))) {
+            if (stats) {
+                __atomic_fetch_add(&stats->errors, 1, __ATOMIC_RELAXED);
+            }
+            pthread_mutex_unlock(&server->registry_mutex);
+            LINX_FREE(cache_key);
+            mcp_server_reply_error(server, id, error_msg);
+            return;
+        }
+        if (run_async && arguments) {
+            // 异步调用晚于消息释放执行，复制到普通堆内存
+            bool suspended = linx_json_arena_suspend();
+            arguments_copy = cJSON_Duplicate(arguments, true);
+            linx_json_arena_resume(suspended);
+            if (!arguments_copy) {
+                pthread_mutex_unlock(&server->registry_mutex);
+                LINX_FREE(cache_key);
+                mcp_server_reply_error(server, id, "Failed to copy tool arguments");
+                return;
+            }
+        }
+    } else {
+        // 解析工具参数：同步调用期间 arguments 一直有效，直接借用其中的字符串；
+        // 异步调用晚于消息释放执行，需要复制
+        properties = mcp_property_list_create_from_json(arguments, !run_async);
+    }
+    
+    uint64_t callback_start_us = stats ? mcp_time_now_us() : 0;
+    uint32_t args_us = (uint32_t)(callback_start_us - args_start_us);
+    
+    // 异步工具交给线程池，收消息的线程立即返回
+    if (run_async) {
+        const char* error = mcp_server_submit_tool_job(server, tool, id, properties, arguments_copy, cache_key,
+                                                       progress_token, stats, args_us);
+        if (error) {
+            LOG_WARN("Async tool '%s' rejected: %s", tool->name, error);
+            if (stats) {
+                __atomic_fetch_add(&stats->errors, 1, __ATOMIC_RELAXED);
+            }
+        }
+        pthread_mutex_unlock(&server->registry_mutex);
+        if (error) {
+            if (properties) {
+                mcp_property_list_destroy(properties);
+            }
+            if (arguments_copy) {
+                cJSON_Delete(arguments_copy);
+            }
+            LINX_FREE(cache_key);
+            mcp_server_reply_error(server, id, error);
+        }
+        return;
+    }
+    
+    // 调用工具回调函数（暂停竞技场，回调中的分配使用普通堆内存）
+    bool arena_suspended = linx_json_arena_suspend();
+    mcp_tool_call_frame_t frame = { server, id, progress_token, NULL, NULL };
+    mcp_tool_call_frame_t* outer_call = t_tool_call;
+    t_tool_call = &frame;
+    mcp_return_value_t result;
+    if (tool->args_callback) {
+        mcp_arguments_t args = { arguments, tool->properties };
+        result = tool->args_callback(&args);
+    } else {
+        result = tool->callback(properties);
+    }
+    t_tool_call = outer_call;
+    mcp_tool_stream_finish(frame.stream);
+    mcp_tool_stream_release(frame.stream);
+    linx_json_arena_resume(arena_suspended);
+    uint64_t callback_end_us = stats ? mcp_time_now_us() : 0;
     
     // 清理属性列表
     if (properties) {
         mcp_property_list_destroy(properties);
     }
     
-    // 构建响应
+    if (!cache_key) {
+        pthread_mutex_unlock(&server->registry_mutex);
+        size_t reply_bytes = mcp_server_reply_tool_result(server, NULL, NULL, id, &result);
+        if (stats) {
+            // 回复期间工具可能被移除（统计随之释放），重新加锁确认后再记录
+            pthread_mutex_lock(&server->registry_mutex);
+            if (mcp_server_find_tool_mutable(server, tool_name) == tool && tool->stats == stats) {
+                mcp_server_profile_call(server, tool, stats, false, args_us, callback_start_us,
+                                        callback_end_us, reply_bytes);
+            }
+            pthread_mutex_unlock(&server->registry_mutex);
+        }
+        return;
+    }
+    
+    // 写入结果缓存时工具不能被移除，回复完成后再解锁
+    size_t reply_bytes = mcp_server_reply_tool_result(server, tool, cache_key, id, &result);
+    if (stats) {
+        mcp_server_profile_call(server, tool, stats, false, args_us, callback_start_us, callback_end_us,
+                                reply_bytes);
+    }
+    pthread_mutex_unlock(&server->registry_mutex);
+    LINX_FREE(cache_key);
+}
+
+/**
+ * 记录一次本地调用，等待 mcp_server_flush_local_calls() 发送
+ * result 为调用结果的 JSON，失败时为NULL并携带 error
+ */
+static void mcp_server_record_local_call(mcp_server_t* server, const char* name, const cJSON* arguments,
+                                         const char* utterance, const char* result, const char* error) {
+    // 可能在其他消息的处理中调用，通知要比竞技场活得久
+    bool suspended = linx_json_arena_suspend();
+    char* notification = NULL;
+    cJSON* root = cJSON_CreateObject();
+    if (root) {
+        cJSON_AddStringToObject(root, "jsonrpc", "2.0");
+        cJSON_AddStringToObject(root, "method", "notifications/tools/local_call");
+    }
+    cJSON* params = root ? cJSON_AddObjectToObject(root, "params") : NULL;
+    if (params) {
+        cJSON_AddStringToObject(params, "name", name);
+        cJSON_AddItemToObject(params, "arguments",
+                              arguments ? cJSON_Duplicate(arguments, true) : cJSON_CreateObject());
+        if (utterance) {
+            cJSON_AddStringToObject(params, "utterance", utterance);
+        }
+        if (result) {
+            cJSON_AddRawToObject(params, "result", result);
+        } else {
+            cJSON_AddStringToObject(params, "error", error ? error : "Tool execution failed");
+        }
+        notification = cJSON_PrintUnformatted(root);
+    }
+    cJSON_Delete(root);
+    linx_json_arena_resume(suspended);
+    if (!notification) {
+        LOG_ERROR("Failed to build local call notification for '%s'", name);
+        return;
+    }
+    
+    char* dropped = NULL;
+    pthread_mutex_lock(&server->local_call_mutex);
+    if (server->local_call_count == MCP_LOCAL_CALL_BACKLOG) {
+        dropped = server->local_calls[server->local_call_head];
+        server->local_call_head = (server->local_call_head + 1) % MCP_LOCAL_CALL_BACKLOG;
+        server->local_call_count--;
+    }
+    server->local_calls[(server->local_call_head + server->local_call_count) % MCP_LOCAL_CALL_BACKLOG] = notification;
+    server->local_call_count++;
+    pthread_mutex_unlock(&server->local_call_mutex);
+    if (dropped) {
+        LOG_WARN("Local call backlog full, dropping the oldest notification");
+        cJSON_free(dropped);
+    }
+}
+
+/**
+ * 在本地调用工具
+ */
+bool mcp_server_call_tool_local(mcp_server_t* server, const char* name, const cJSON* arguments,
+                                const char* utterance, char** result) {
+    if (result) {
+        *result = NULL;
+    }
+    if (!server || !name) {
+        return false;
+    }
+    
+    pthread_mutex_lock(&server->registry_mutex);
+    mcp_tool_t* tool = mcp_server_find_tool_mutable(server, name);
+    if (!tool) {
+        pthread_mutex_unlock(&server->registry_mutex);
+        LOG_WARN("Local call: tool not found: %s", name);
+        mcp_server_record_local_call(server, name, arguments, utterance, NULL, "Tool not found");
+        return false;
+    }
+    
+    mcp_property_list_t* properties = NULL;
+    if (tool->args_callback) {
+        char error_msg[256];
+        if (!mcp_arguments_validate(arguments, tool->properties, error_msg, sizeof(error_msg))) {
+            pthread_mutex_unlock(&server->registry_mutex);
+            LOG_WARN("Local call to '%s' rejected: %s", name, error_msg);
+            mcp_server_record_local_call(server, name, arguments, utterance, NULL, error_msg);
+            return false;
+        }
+    } else {
+        properties = mcp_property_list_create_from_json(arguments, true);
+    }
+    
+    // 没有请求 id 和发送目标：回调中的推送句柄照常可用，推送的内容丢弃
+    bool arena_suspended = linx_json_arena_suspend();
+    mcp_tool_call_frame_t frame = { NULL, -1, "", NULL, NULL };
+    mcp_tool_call_frame_t* outer_call = t_tool_call;
+    t_tool_call = &frame;
+    mcp_return_value_t value;
+    if (tool->args_callback) {
+        mcp_arguments_t args = { arguments, tool->properties };
+        value = tool->args_callback(&args);
+    } else {
+        value = tool->callback(properties);
+    }
+    t_tool_call = outer_call;
+    mcp_tool_stream_finish(frame.stream);
+    mcp_tool_stream_release(frame.stream);
+    linx_json_arena_resume(arena_suspended);
+    if (properties) {
+        mcp_property_list_destroy(properties);
+    }
+    pthread_mutex_unlock(&server->registry_mutex);
+    
+    // 图像结果只能作为响应发给客户端，本地调用不支持
+    bool is_error = value.type == MCP_RETURN_TYPE_IMAGE;
+    char* response = is_error ? NULL : mcp_tool_result_format(&value, &is_error);
+    mcp_return_value_cleanup(&value, value.type);
+    
+    bool ok = response && !is_error;
+    const char* error = is_error ? "Unsupported return type" : "Out of memory";
+    mcp_server_record_local_call(server, name, arguments, utterance, ok ? response : NULL, ok ? NULL : error);
+    LOG_INFO("Local call to '%s'%s%s%s %s", name, utterance ? " for \"" : "", utterance ? utterance : "",
+             utterance ? "\"" : "", ok ? "done" : error);
+    if (ok && result) {
+        *result = response;
+    } else {
+        LINX_FREE(response);
+    }
+    return ok;
+}
+
+/**
+ * 发送排队的本地调用通知
+ */
+size_t mcp_server_flush_local_calls(mcp_server_t* server) {
+    if (!mcp_server_can_send(server)) {
+        return 0;
+    }
+    
+    // 逐条取出后在锁外发送，发送回调中可以再发起本地调用
+    size_t sent = 0;
+    for (;;) {
+        char* notification = NULL;
+        pthread_mutex_lock(&server->local_call_mutex);
+        if (server->local_call_count > 0) {
+            notification = server->local_calls[server->local_call_head];
+            server->local_calls[server->local_call_head] = NULL;
+            server->local_call_head = (server->local_call_head + 1) % MCP_LOCAL_CALL_BACKLOG;
+            server->local_call_count--;
+        }
+        pthread_mutex_unlock(&server->local_call_mutex);
+        if (!notification) {
+            break;
+        }
+        mcp_server_send_direct(server, notification);
+        cJSON_free(notification);
+        sent++;
+    }
+    return sent;
+}
+
+/**
+ * 回复图像结果：按最终长度分配一次，Base64直接编码进待发送的消息，
+ * 图像不再经过编码副本、cJSON节点和中间响应字符串
+ * @return 已发送返回消息的字节数，否则返回0
+ */
+static size_t mcp_server_reply_image_result(mcp_server_t* server, int id, const mcp_image_content_t* image) {
+    if (!mcp_server_can_send(server) || !image->mime_type || (!image->encoded_data && !image->raw_data)) {
+        return 0;
+    }
+    
+    char head[160];
+    int head_len = snprintf(head, sizeof(head),
+                            "{\"jsonrpc\":\"2.0\",\"id\":%d,\"result\":{\"content\":[{\"type\":\"image\",\"mimeType\":\"", id);
+    static const char middle[] = "\",\"data\":\"";
+    static const char tail[] = "\"}],\"isError\":false}}";
+    size_t mime_len = strlen(image->mime_type);
+    size_t data_len = mcp_image_content_encoded_length(image);
+    size_t total = (size_t)head_len + mime_len + sizeof(middle) - 1 + data_len + sizeof(tail) - 1;
+    
+    char* payload = LINX_MALLOC(total + 1);
+    if (!payload) {
+        LOG_ERROR("Failed to allocate %zu bytes for image result", total + 1);
+        return 0;
+    }
+    
+    char* out = payload;
+    memcpy(out, head, (size_t)head_len);
+    out += head_len;
+    memcpy(out, image->mime_type, mime_len);
+    out += mime_len;
+    memcpy(out, middle, sizeof(middle) - 1);
+    out += sizeof(middle) - 1;
+    out += mcp_image_content_write_data(image, out);
+    memcpy(out, tail, sizeof(tail) - 1);
+    out += sizeof(tail) - 1;
+    *out = '\0';
+    
+    mcp_server_send(server, payload);
+    LINX_FREE(payload);
+    return total;
+}
+
+/**
+ * 把工具返回值转换为 tools/call 响应的 result JSON（不释放返回值，不处理图像）
+ * @param is_error 输出：返回值类型不受支持
+ * @return LINX_FREE 释放的字符串，内存不足返回NULL
+ */
+static char* mcp_tool_result_format(const mcp_return_value_t* result_ptr, bool* is_error) {
+    mcp_return_value_t result = *result_ptr;
     char* response = NULL;
-    bool is_error = false;
+    *is_error = false;
     
     switch (result.type) {
         case MCP_RETURN_TYPE_BOOL:
-            response = malloc(128);
+            response = LINX_MALLOC(128);
             if (response) {
                 snprintf(response, 128, "{\"content\":[{\"type\":\"text\",\"text\":\"%s\"}],\"isError\":false}", 
                         result.value.bool_val ? "true" : "false");
             }
             break;
         case MCP_RETURN_TYPE_INT:
-            response = malloc(128);
+            response = LINX_MALLOC(128);
             if (response) {
                 snprintf(response, 128, "{\"content\":[{\"type\":\"text\",\"text\":\"%d\"}],\"isError\":false}", 
                         result.value.int_val);
@@ -477,7 +1915,7 @@ void mcp_server_handle_tools_call(mcp_server_t* server, int id, const cJSON* par
         case MCP_RETURN_TYPE_STRING:
             if (result.value.string_val) {
                 size_t len = strlen(result.value.string_val) + 128;
-                response = malloc(len);
+                response = LINX_MALLOC(len);
                 if (response) {
                     snprintf(response, len, "{\"content\":[{\"type\":\"text\",\"text\":\"%s\"}],\"isError\":false}", 
                             result.value.string_val);
@@ -486,101 +1924,713 @@ void mcp_server_handle_tools_call(mcp_server_t* server, int id, const cJSON* par
             break;
         case MCP_RETURN_TYPE_JSON:
             if (result.value.json_val) {
-                char* json_str = cJSON_Print(result.value.json_val);
-                if (json_str) {
-                    size_t len = strlen(json_str) + 128;
-                    response = malloc(len);
-                    if (response) {
-                        snprintf(response, len, "{\"content\":[{\"type\":\"text\",\"text\":%s}],\"isError\":false}", json_str);
-                    }
-                    free(json_str);
+                // 估算长度后一次分配，结果紧凑打印进响应，不再单独序列化后拼接
+                static const char prefix[] = "{\"content\":[{\"type\":\"text\",\"text\":";
+                static const char suffix[] = "}],\"isError\":false}";
+                size_t estimate = linx_json_print_estimate(result.value.json_val);
+                if (estimate > 0 && estimate <= INT_MAX - LINX_JSON_PRINT_SLACK) {
+                    response = LINX_MALLOC(sizeof(prefix) - 1 + estimate + LINX_JSON_PRINT_SLACK + sizeof(suffix));
                 }
-            }
-            break;
-        case MCP_RETURN_TYPE_IMAGE:
-            if (result.value.image_val) {
-                char* image_json = mcp_image_content_to_json(result.value.image_val);
-                if (image_json) {
-                    size_t len = strlen(image_json) + 128;
-                    response = malloc(len);
-                    if (response) {
-                        snprintf(response, len, "{\"content\":[%s],\"isError\":false}", image_json);
+                if (response) {
+                    memcpy(response, prefix, sizeof(prefix) - 1);
+                    char* value = response + sizeof(prefix) - 1;
+                    if (cJSON_PrintPreallocated(result.value.json_val, value, (int)(estimate + LINX_JSON_PRINT_SLACK), 0)) {
+                        memcpy(value + strlen(value), suffix, sizeof(suffix));
+                    } else {
+                        LINX_FREE(response);
+                        response = NULL;
                     }
-                    free(image_json);
                 }
             }
             break;
         default:
-            response = malloc(256);
+            response = LINX_MALLOC(256);
             if (response) {
                 strcpy(response, "{\"content\":[{\"type\":\"text\",\"text\":\"Unsupported return type\"}],\"isError\":true}");
             }
-            is_error = true;
+            *is_error = true;
             break;
     }
+    return response;
+}
+
+/**
+ * 把工具返回值转换为响应并回复，随后释放返回值资源
+ * 同步调用在收消息的线程、异步调用在工作线程中执行；cache_key 非NULL时
+ * 成功的非图像结果同时写入工具的结果缓存
+ * @return 回复的 result 字节数（图像为整条消息），回复错误时返回0
+ */
+static size_t mcp_server_reply_tool_result(mcp_server_t* server, mcp_tool_t* tool, const char* cache_key,
+                                           int id, mcp_return_value_t* result_ptr) {
+    mcp_return_value_t result = *result_ptr;
+    char* response = NULL;
+    bool is_error = false;
+    size_t reply_bytes = 0;
+    
+    if (result.type == MCP_RETURN_TYPE_IMAGE) {
+        if (result.value.image_val) {
+            reply_bytes = mcp_server_reply_image_result(server, id, result.value.image_val);
+        }
+        if (reply_bytes > 0) {
+            mcp_return_value_cleanup(result_ptr, result.type);
+            return reply_bytes;
+        }
+    } else {
+        response = mcp_tool_result_format(result_ptr, &is_error);
+    }
     
     // 清理返回值资源
-    mcp_return_value_cleanup(&result, result.type);
+    mcp_return_value_cleanup(result_ptr, result.type);
     
     if (response) {
         if (is_error) {
-            mcp_server_reply_error(id, "Tool execution failed");
+            mcp_server_reply_error(server, id, "Tool execution failed");
         } else {
-            mcp_server_reply_result(id, response);
+            if (cache_key) {
+                mcp_tool_result_cache_store(tool, cache_key, response);
+            }
+            mcp_server_reply_result(server, id, response);
+            reply_bytes = strlen(response);
         }
-        free(response);
+        LINX_FREE(response);
     } else {
-        mcp_server_reply_error(id, "Failed to process tool result - memory allocation error");
+        mcp_server_reply_error(server, id, "Failed to process tool result - memory allocation error");
     }
+    return reply_bytes;
 }
 
+/* ==================== 工具调用剖析 ==================== */
+
 /**
- * 获取工具列表的JSON字符串
+ * 开启剖析时返回工具的统计，首次调用时创建（调用者持有工具表锁）
  */
-char* mcp_server_get_tools_list_json(const mcp_server_t* server, const char* cursor, bool list_user_only_tools) {
-    if (!server) {
+static mcp_tool_stats_t* mcp_server_tool_stats(mcp_server_t* server, mcp_tool_t* tool) {
+    if (!__atomic_load_n(&server->tool_profiling, __ATOMIC_RELAXED)) {
         return NULL;
     }
+    if (!tool->stats) {
+        mcp_tool_stats_t* stats = LINX_CALLOC(1, sizeof(mcp_tool_stats_t));
+        if (!stats) {
+            return NULL;
+        }
+        for (size_t i = 0; i < MCP_TOOL_STAGE_COUNT; i++) {
+            stats->stages[i].min = UINT32_MAX;
+        }
+        __atomic_store_n(&tool->stats, stats, __ATOMIC_RELEASE);
+    }
+    return tool->stats;
+}
+
+static uint32_t mcp_server_clamp_u32(uint64_t value) {
+    return value > UINT32_MAX ? UINT32_MAX : (uint32_t)value;
+}
+
+/**
+ * 记录一次执行了回调的调用；序列化耗时从回调结束量到现在
+ * 同步调用持有工具表锁，异步调用在工作线程上（工具在调用结束前不会被销毁）
+ */
+static void mcp_server_profile_call(mcp_server_t* server, mcp_tool_t* tool, mcp_tool_stats_t* stats, bool async,
+                                    uint32_t args_us, uint64_t callback_start_us, uint64_t callback_end_us,
+                                    size_t reply_bytes) {
+    mcp_tool_call_profile_t profile = {
+        .tool_name = tool->name,
+        .args_us = args_us,
+        .callback_us = mcp_server_clamp_u32(callback_end_us - callback_start_us),
+        .serialize_us = mcp_server_clamp_u32(mcp_time_now_us() - callback_end_us),
+        .reply_bytes = mcp_server_clamp_u32(reply_bytes),
+        .async = async
+    };
     
-    cJSON* root = cJSON_CreateObject();
-    if (!root) {
-        return NULL;
+    __atomic_fetch_add(&stats->calls, 1, __ATOMIC_RELAXED);
+    if (reply_bytes == 0) {
+        __atomic_fetch_add(&stats->errors, 1, __ATOMIC_RELAXED);
     }
+    mcp_tool_histogram_record(&stats->stages[MCP_TOOL_STAGE_ARGS], profile.args_us);
+    mcp_tool_histogram_record(&stats->stages[MCP_TOOL_STAGE_CALLBACK], profile.callback_us);
+    mcp_tool_histogram_record(&stats->stages[MCP_TOOL_STAGE_SERIALIZE], profile.serialize_us);
+    mcp_tool_histogram_record(&stats->stages[MCP_TOOL_STAGE_REPLY_BYTES], profile.reply_bytes);
     
-    cJSON* tools_array = cJSON_CreateArray();
-    if (!tools_array) {
-        cJSON_Delete(root);
-        return NULL;
+    uint32_t slow_us = __atomic_load_n(&server->slow_tool_us, __ATOMIC_RELAXED);
+    uint64_t total_us = (uint64_t)profile.args_us + profile.callback_us + profile.serialize_us;
+    if (slow_us > 0 && total_us > slow_us) {
+        profile.slow = true;
+        __atomic_fetch_add(&stats->slow, 1, __ATOMIC_RELAXED);
+        LOG_WARN("Slow tool '%s': %llu us (args %u, callback %u, serialize %u), reply %u bytes",
+                 tool->name, (unsigned long long)total_us, profile.args_us, profile.callback_us,
+                 profile.serialize_us, profile.reply_bytes);
+    }
+    
+    mcp_tool_profile_handler_t handler = __atomic_load_n(&server->profile_handler, __ATOMIC_ACQUIRE);
+    if (handler) {
+        handler(&profile, server->profile_user_data);
+    }
+}
+
+/**
+ * 开启或关闭工具调用剖析
+ */
+void mcp_server_set_tool_profiling(mcp_server_t* server, bool enabled, uint32_t slow_threshold_ms) {
+    if (!server) {
+        return;
+    }
+    uint64_t slow_us = (uint64_t)slow_threshold_ms * 1000;
+    __atomic_store_n(&server->slow_tool_us, mcp_server_clamp_u32(slow_us), __ATOMIC_RELAXED);
+    __atomic_store_n(&server->tool_profiling, enabled, __ATOMIC_RELAXED);
+}
+
+/**
+ * 设置工具调用剖析回调
+ */
+void mcp_server_set_tool_profile_handler(mcp_server_t* server, mcp_tool_profile_handler_t handler, void* user_data) {
+    if (!server) {
+        return;
+    }
+    server->profile_user_data = user_data;
+    __atomic_store_n(&server->profile_handler, handler, __ATOMIC_RELEASE);
+}
+
+/**
+ * 获取工具的调用统计
+ */
+bool mcp_server_get_tool_stats(mcp_server_t* server, const char* name, mcp_tool_stats_t* stats) {
+    if (!server || !name || !stats) {
+        return false;
+    }
+    pthread_mutex_lock(&server->registry_mutex);
+    bool found = mcp_tool_get_stats(mcp_server_find_tool_mutable(server, name), stats);
+    pthread_mutex_unlock(&server->registry_mutex);
+    return found;
+}
+
+/**
+ * 写入一个阶段的直方图摘要
+ */
+static void mcp_server_write_stage(linx_json_writer_t* writer, const char* key, const mcp_tool_histogram_t* h) {
+    bool empty = h->count == 0;
+    linx_json_writer_key(writer, key);
+    linx_json_writer_begin_object(writer);
+    linx_json_writer_add_int(writer, "count", (long long)h->count);
+    linx_json_writer_add_int(writer, "min", empty ? 0 : (long long)h->min);
+    linx_json_writer_add_int(writer, "max", empty ? 0 : (long long)h->max);
+    linx_json_writer_add_int(writer, "mean", empty ? 0 : (long long)(h->sum / h->count));
+    linx_json_writer_add_int(writer, "p50", (long long)mcp_tool_histogram_percentile(h, 50));
+    linx_json_writer_add_int(writer, "p90", (long long)mcp_tool_histogram_percentile(h, 90));
+    linx_json_writer_add_int(writer, "p99", (long long)mcp_tool_histogram_percentile(h, 99));
+    linx_json_writer_end_object(writer);
+}
+
+/**
+ * 处理工具统计请求
+ *
+ * 结果格式：{"enabled":true,"slowThresholdMs":200,"tools":[{"name":"x","calls":3,"cacheHits":0,
+ * "errors":0,"slow":1,"argsUs":{...},"callbackUs":{...},"serializeUs":{...},"replyBytes":{...}}]}，
+ * 各阶段为 {"count","min","max","mean","p50","p90","p99"}；没有被调用过的工具不列出
+ */
+void mcp_server_handle_tools_stats(mcp_server_t* server, int id, const cJSON* params) {
+    if (!server) {
+        return;
     }
+    const cJSON* name_json = cJSON_GetObjectItemCaseSensitive(params, "name");
+    const char* name = cJSON_IsString(name_json) ? name_json->valuestring : NULL;
+    static const char* const stage_keys[MCP_TOOL_STAGE_COUNT] = {
+        [MCP_TOOL_STAGE_ARGS] = "argsUs",
+        [MCP_TOOL_STAGE_CALLBACK] = "callbackUs",
+        [MCP_TOOL_STAGE_SERIALIZE] = "serializeUs",
+        [MCP_TOOL_STAGE_REPLY_BYTES] = "replyBytes",
+    };
     
-    // 添加工具到数组
+    linx_json_writer_t writer;
+    linx_json_writer_init(&writer);
+    linx_json_writer_begin_object(&writer);
+    linx_json_writer_add_bool(&writer, "enabled", __atomic_load_n(&server->tool_profiling, __ATOMIC_RELAXED));
+    linx_json_writer_add_int(&writer, "slowThresholdMs",
+                             (long long)(__atomic_load_n(&server->slow_tool_us, __ATOMIC_RELAXED) / 1000));
+    linx_json_writer_key(&writer, "tools");
+    linx_json_writer_begin_array(&writer);
+    
+    // 统计逐个复制到栈上再序列化，持锁期间只做内存读写
+    mcp_tool_stats_t stats;
+    pthread_mutex_lock(&server->registry_mutex);
     for (size_t i = 0; i < server->tool_count; i++) {
         const mcp_tool_t* tool = server->tools[i];
+        if (!tool || (name && strcmp(tool->name, name) != 0) || !mcp_tool_get_stats(tool, &stats)) {
+            continue;
+        }
+        linx_json_writer_begin_object(&writer);
+        linx_json_writer_add_string(&writer, "name", tool->name);
+        linx_json_writer_add_int(&writer, "calls", (long long)stats.calls);
+        linx_json_writer_add_int(&writer, "cacheHits", (long long)stats.cache_hits);
+        linx_json_writer_add_int(&writer, "errors", (long long)stats.errors);
+        linx_json_writer_add_int(&writer, "slow", (long long)stats.slow);
+        for (size_t s = 0; s < MCP_TOOL_STAGE_COUNT; s++) {
+            mcp_server_write_stage(&writer, stage_keys[s], &stats.stages[s]);
+        }
+        linx_json_writer_end_object(&writer);
+    }
+    pthread_mutex_unlock(&server->registry_mutex);
+    
+    linx_json_writer_end_array(&writer);
+    linx_json_writer_end_object(&writer);
+    const char* result = linx_json_writer_finish(&writer);
+    if (result) {
+        mcp_server_reply_result(server, id, result);
+    } else {
+        mcp_server_reply_error(server, id, "Failed to generate tool stats");
+    }
+    linx_json_writer_free(&writer);
+}
+
+/**
+ * 创建推送句柄（引用计数为1）
+ */
+static mcp_tool_stream_t* mcp_tool_stream_create(mcp_server_t* server, int id, const char* progress_token) {
+    mcp_tool_stream_t* stream = LINX_CALLOC(1, sizeof(mcp_tool_stream_t));
+    if (!stream) {
+        LOG_ERROR("Failed to allocate tool stream for call %d", id);
+        return NULL;
+    }
+    pthread_mutex_init(&stream->mutex, NULL);
+    stream->refs = 1;
+    stream->server = server;
+    stream->id = id;
+    strcpy(stream->progress_token, progress_token);
+    linx_json_writer_init(&stream->writer);
+    return stream;
+}
+
+/**
+ * 调用已回复或超时，之后的推送全部丢弃
+ */
+static void mcp_tool_stream_finish(mcp_tool_stream_t* stream) {
+    if (!stream) {
+        return;
+    }
+    pthread_mutex_lock(&stream->mutex);
+    stream->finished = true;
+    pthread_mutex_unlock(&stream->mutex);
+}
+
+/**
+ * 获取当前工具调用的推送句柄
+ */
+mcp_tool_stream_t* mcp_tool_stream_current(void) {
+    mcp_tool_call_frame_t* frame = t_tool_call;
+    if (!frame) {
+        return NULL;
+    }
+    if (!frame->stream) {
+        frame->stream = mcp_tool_stream_create(frame->server, frame->id, frame->progress_token);
+        if (frame->stream && frame->job) {
+            // 交给任务一个引用，超时检查线程回复超时错误前先结束推送
+            mcp_worker_pool_t* pool = frame->server->worker_pool;
+            pthread_mutex_lock(&pool->mutex);
+            frame->job->stream = mcp_tool_stream_retain(frame->stream);
+            if (frame->job->timed_out) {
+                mcp_tool_stream_finish(frame->stream);
+            }
+            pthread_mutex_unlock(&pool->mutex);
+        }
+    }
+    return frame->stream;
+}
+
+/**
+ * 增加句柄引用
+ */
+mcp_tool_stream_t* mcp_tool_stream_retain(mcp_tool_stream_t* stream) {
+    if (stream) {
+        __atomic_add_fetch(&stream->refs, 1, __ATOMIC_RELAXED);
+    }
+    return stream;
+}
+
+/**
+ * 释放句柄引用
+ */
+void mcp_tool_stream_release(mcp_tool_stream_t* stream) {
+    if (!stream || __atomic_sub_fetch(&stream->refs, 1, __ATOMIC_ACQ_REL) != 0) {
+        return;
+    }
+    linx_json_writer_free(&stream->writer);
+    pthread_mutex_destroy(&stream->mutex);
+    LINX_FREE(stream);
+}
+
+/**
+ * 调用是否仍在进行
+ */
+bool mcp_tool_stream_is_open(mcp_tool_stream_t* stream) {
+    if (!stream) {
+        return false;
+    }
+    pthread_mutex_lock(&stream->mutex);
+    bool open = !stream->finished;
+    pthread_mutex_unlock(&stream->mutex);
+    return open;
+}
+
+/**
+ * 写入数字成员（进度值可能是小数）
+ */
+static void mcp_tool_stream_add_number(linx_json_writer_t* writer, const char* key, double value) {
+    char number[32];
+    int length = snprintf(number, sizeof(number), "%.15g", value);
+    linx_json_writer_add_raw(writer, key, number, (size_t)length);
+}
+
+/**
+ * 发送进度通知
+ */
+bool mcp_tool_stream_progress(mcp_tool_stream_t* stream, double progress, double total, const char* message) {
+    if (!stream || stream->progress_token[0] == '\0' || !isfinite(progress) || !isfinite(total)) {
+        return false;
+    }
+    
+    pthread_mutex_lock(&stream->mutex);
+    bool sent = false;
+    if (!stream->finished && (!stream->has_progress || progress > stream->last_progress)) {
+        linx_json_writer_t* writer = &stream->writer;
+        linx_json_writer_reset(writer);
+        linx_json_writer_begin_object(writer);
+        linx_json_writer_add_string(writer, "jsonrpc", "2.0");
+        linx_json_writer_add_string(writer, "method", "notifications/progress");
+        linx_json_writer_key(writer, "params");
+        linx_json_writer_begin_object(writer);
+        linx_json_writer_add_raw(writer, "progressToken", stream->progress_token, strlen(stream->progress_token));
+        mcp_tool_stream_add_number(writer, "progress", progress);
+        if (total > 0) {
+            mcp_tool_stream_add_number(writer, "total", total);
+        }
+        if (message) {
+            linx_json_writer_add_string(writer, "message", message);
+        }
+        linx_json_writer_end_object(writer);
+        linx_json_writer_end_object(writer);
+        
+        const char* notification = linx_json_writer_finish(writer);
+        if (notification) {
+            // 通知不是响应，不加入批量响应
+            mcp_server_send_direct(stream->server, notification);
+            stream->has_progress = true;
+            stream->last_progress = progress;
+            sent = true;
+        }
+    }
+    pthread_mutex_unlock(&stream->mutex);
+    return sent;
+}
+
+/**
+ * 发送一段文本部分结果
+ */
+bool mcp_tool_stream_send_text(mcp_tool_stream_t* stream, const char* text) {
+    if (!stream || !text) {
+        return false;
+    }
+    
+    pthread_mutex_lock(&stream->mutex);
+    bool sent = false;
+    if (!stream->finished) {
+        linx_json_writer_t* writer = &stream->writer;
+        linx_json_writer_reset(writer);
+        linx_json_writer_begin_object(writer);
+        linx_json_writer_add_string(writer, "jsonrpc", "2.0");
+        linx_json_writer_add_string(writer, "method", "notifications/tools/chunk");
+        linx_json_writer_key(writer, "params");
+        linx_json_writer_begin_object(writer);
+        linx_json_writer_add_int(writer, "requestId", stream->id);
+        if (stream->progress_token[0] != '\0') {
+            linx_json_writer_add_raw(writer, "progressToken", stream->progress_token, strlen(stream->progress_token));
+        }
+        linx_json_writer_add_int(writer, "index", stream->chunk_index);
+        linx_json_writer_key(writer, "content");
+        linx_json_writer_begin_array(writer);
+        linx_json_writer_begin_object(writer);
+        linx_json_writer_add_string(writer, "type", "text");
+        linx_json_writer_add_string(writer, "text", text);
+        linx_json_writer_end_object(writer);
+        linx_json_writer_end_array(writer);
+        linx_json_writer_end_object(writer);
+        linx_json_writer_end_object(writer);
         
-        // 根据过滤条件决定是否包含此工具
+        const char* notification = linx_json_writer_finish(writer);
+        if (notification) {
+            mcp_server_send_direct(stream->server, notification);
+            stream->chunk_index++;
+            sent = true;
+        } else {
+            LOG_ERROR("Failed to print chunk for call %d", stream->id);
+        }
+    }
+    pthread_mutex_unlock(&stream->mutex);
+    return sent;
+}
+
+/**
+ * 发送状态同步通知
+ * 通知不是响应，不加入批量响应
+ */
+static void mcp_server_state_send(const char* message, void* user_data) {
+    mcp_server_send_direct((mcp_server_t*)user_data, message);
+}
+
+/**
+ * 把工具表以 {工具名: 工具定义} 对象发布到状态同步
+ * 工具定义来自各工具的 JSON 缓存
+ */
+static void mcp_server_publish_tools(mcp_server_t* server) {
+    // 保存的对象跨消息存在，不从竞技场分配
+    bool arena_suspended = linx_json_arena_suspend();
+    cJSON* tools = cJSON_CreateObject();
+    bool ok = tools != NULL;
+    
+    pthread_mutex_lock(&server->registry_mutex);
+    for (size_t i = 0; ok && i < server->tool_count; i++) {
+        mcp_tool_t* tool = server->tools[i];
+        size_t length = 0;
+        const char* json = mcp_tool_get_cached_json(tool, &length);
+        cJSON* definition = json ? cJSON_ParseWithLength(json, length) : NULL;
+        ok = definition && cJSON_AddItemToObject(tools, tool->name, definition);
+        if (!ok) {
+            cJSON_Delete(definition);
+        }
+    }
+    // 持锁发布，并发的工具表修改按顺序生成版本
+    if (ok) {
+        mcp_state_sync_publish(&server->state_sync, MCP_STATE_SYNC_TOOLS, tools, mcp_server_state_send, server);
+    } else {
+        LOG_ERROR("Failed to build tools object for state sync");
+    }
+    pthread_mutex_unlock(&server->registry_mutex);
+    cJSON_Delete(tools);
+    linx_json_arena_resume(arena_suspended);
+}
+
+/**
+ * 工具表变化后同步（不持有工具表锁调用），未启用同步时不做任何工作
+ */
+static void mcp_server_sync_tools(mcp_server_t* server) {
+    if (mcp_state_sync_is_active(&server->state_sync)) {
+        mcp_server_publish_tools(server);
+    }
+}
+
+/**
+ * 发布状态对象
+ */
+bool mcp_server_publish_state(mcp_server_t* server, const char* resource, const cJSON* state) {
+    if (!server || !resource || strcmp(resource, MCP_STATE_SYNC_TOOLS) == 0) {
+        return false;
+    }
+    return mcp_state_sync_publish(&server->state_sync, resource, state, mcp_server_state_send, server);
+}
+
+/**
+ * 获取状态同步统计
+ */
+void mcp_server_get_state_sync_stats(mcp_server_t* server, mcp_state_sync_stats_t* stats) {
+    if (server) {
+        mcp_state_sync_get_stats(&server->state_sync, stats);
+    }
+}
+
+/**
+ * 丢弃 tools/list 缓存（调用者持有工具表锁）
+ */
+static void mcp_server_invalidate_tools_list(mcp_server_t* server) {
+    for (size_t i = 0; i < 2; i++) {
+        mcp_tools_list_cache_t* cache = &server->tools_list_cache[i];
+        LINX_FREE(cache->json);
+        LINX_FREE(cache->offsets);
+        memset(cache, 0, sizeof(*cache));
+    }
+}
+
+/**
+ * 内存压力收缩回调：释放 tools/list 缓存和各工具的结果缓存
+ *
+ * 工具表锁被占用（例如正在执行同步工具）时本次跳过，不阻塞检查线程。
+ */
+static size_t mcp_server_shrink(void* user_data, linx_mem_pressure_level_t level) {
+    (void)level;
+    mcp_server_t* server = (mcp_server_t*)user_data;
+    if (pthread_mutex_trylock(&server->registry_mutex) != 0) {
+        return 0;
+    }
+    size_t released = 0;
+    for (size_t i = 0; i < 2; i++) {
+        const mcp_tools_list_cache_t* cache = &server->tools_list_cache[i];
+        if (cache->json) {
+            released += cache->length + 1 + cache->count * sizeof(size_t);
+        }
+    }
+    mcp_server_invalidate_tools_list(server);
+    for (size_t i = 0; i < server->tool_count; i++) {
+        mcp_tool_invalidate_result_cache(server->tools[i]);
+    }
+    pthread_mutex_unlock(&server->registry_mutex);
+    return released;
+}
+
+/**
+ * 生成 tools/list 缓存（调用者持有工具表锁）
+ */
+static bool mcp_server_build_tools_list(mcp_server_t* server, bool list_user_only_tools) {
+    mcp_tools_list_cache_t* cache = &server->tools_list_cache[list_user_only_tools ? 1 : 0];
+    
+    // 第一遍：生成各工具的JSON并统计总长度
+    size_t total = 0;
+    size_t count = 0;
+    for (size_t i = 0; i < server->tool_count; i++) {
+        mcp_tool_t* tool = server->tools[i];
         if (list_user_only_tools && !mcp_tool_is_user_only(tool)) {
             continue;
         }
-        
-        char* tool_json_str = mcp_tool_to_json(tool);
-        if (tool_json_str) {
-            cJSON* tool_json = cJSON_Parse(tool_json_str);
-            if (tool_json) {
-                cJSON_AddItemToArray(tools_array, tool_json);
-            }
-            free(tool_json_str);
+        size_t length = 0;
+        if (!mcp_tool_get_cached_json(tool, &length)) {
+            LOG_ERROR("Failed to serialize tool '%s'", tool->name);
+            return false;
         }
+        total += length + (count > 0 ? 1 : 0);
+        count++;
     }
     
-    cJSON_AddItemToObject(root, "tools", tools_array);
+    char* json = LINX_MALLOC(total + 1);
+    size_t* offsets = LINX_MALLOC((count > 0 ? count : 1) * sizeof(size_t));
+    if (!json || !offsets) {
+        LINX_FREE(json);
+        LINX_FREE(offsets);
+        return false;
+    }
     
-    // 添加分页信息（如果需要）
-    if (cursor) {
-        cJSON_AddStringToObject(root, "nextCursor", cursor);
+    // 第二遍：拼接并记录每个工具的起始偏移
+    size_t pos = 0;
+    size_t n = 0;
+    for (size_t i = 0; i < server->tool_count; i++) {
+        mcp_tool_t* tool = server->tools[i];
+        if (list_user_only_tools && !mcp_tool_is_user_only(tool)) {
+            continue;
+        }
+        if (n > 0) {
+            json[pos++] = ',';
+        }
+        offsets[n++] = pos;
+        memcpy(json + pos, tool->json_cache, tool->json_cache_length);
+        pos += tool->json_cache_length;
     }
+    json[pos] = '\0';
     
-    char* json_string = cJSON_Print(root);
-    cJSON_Delete(root);
+    cache->json = json;
+    cache->length = pos;
+    cache->offsets = offsets;
+    cache->count = count;
+    
+    LOG_DEBUG("Built %s tools list cache: %zu tools, %zu bytes",
+              list_user_only_tools ? "user-only" : "full", count, pos);
+    return true;
+}
+
+/**
+ * 在缓存中定位游标对应的工具下标
+ * @return 找到返回true
+ */
+static bool mcp_tools_list_find_cursor(const mcp_tools_list_cache_t* cache, const char* cursor, size_t* index) {
+    if (!cursor || cursor[0] == '\0') {
+        *index = 0;
+        return true;
+    }
+    
+    char* end = NULL;
+    unsigned long long offset = strtoull(cursor, &end, 10);
+    if (*end != '\0' || cursor[0] == '-') {
+        return false;
+    }
+    
+    // offsets 单调递增，二分查找
+    size_t lo = 0;
+    size_t hi = cache->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (cache->offsets[mid] < offset) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo == cache->count || cache->offsets[lo] != offset) {
+        return false;
+    }
+    *index = lo;
+    return true;
+}
+
+/**
+ * 获取工具列表的JSON字符串
+ */
+uint64_t mcp_server_get_tools_hash(const mcp_server_t* server) {
+    if (!server) {
+        return 0;
+    }
+    
+    mcp_server_t* registry = (mcp_server_t*)server;
+    pthread_mutex_lock(&registry->registry_mutex);
+    uint64_t hash = 0;
+    mcp_tools_list_cache_t* cache = &registry->tools_list_cache[0];
+    if (cache->json || mcp_server_build_tools_list(registry, false)) {
+        hash = mcp_hash_bytes(14695981039346656037ULL, cache->json, cache->length);
+    }
+    pthread_mutex_unlock(&registry->registry_mutex);
+    return hash;
+}
+
+char* mcp_server_get_tools_list_json(const mcp_server_t* server, const char* cursor, bool list_user_only_tools) {
+    if (!server) {
+        return NULL;
+    }
     
+    mcp_server_t* registry = (mcp_server_t*)server;
+    pthread_mutex_lock(&registry->registry_mutex);
+    
+    mcp_tools_list_cache_t* cache = &registry->tools_list_cache[list_user_only_tools ? 1 : 0];
+    if (!cache->json && !mcp_server_build_tools_list(registry, list_user_only_tools)) {
+        pthread_mutex_unlock(&registry->registry_mutex);
+        return NULL;
+    }
+    
+    size_t first = 0;
+    if (!mcp_tools_list_find_cursor(cache, cursor, &first)) {
+        pthread_mutex_unlock(&registry->registry_mutex);
+        LOG_WARN("Invalid tools/list cursor: %s", cursor);
+        return NULL;
+    }
+    
+    // 按整条工具截取本页，至少包含一个工具
+    size_t start = first < cache->count ? cache->offsets[first] : cache->length;
+    size_t last = first;
+    size_t end = start;
+    while (last < cache->count) {
+        size_t tool_end = last + 1 < cache->count ? cache->offsets[last + 1] - 1 : cache->length;
+        if (last > first && tool_end - start > MCP_TOOLS_LIST_MAX_PAYLOAD) {
+            break;
+        }
+        end = tool_end;
+        last++;
+    }
+    bool has_more = last < cache->count;
+    
+    size_t size = (end - start) + 64;
+    char* json_string = LINX_MALLOC(size);
+    if (json_string) {
+        int head = snprintf(json_string, size, "{\"tools\":[");
+        memcpy(json_string + head, cache->json + start, end - start);
+        size_t pos = (size_t)head + (end - start);
+        if (has_more) {
+            snprintf(json_string + pos, size - pos, "],\"nextCursor\":\"%zu\"}", cache->offsets[last]);
+        } else {
+            snprintf(json_string + pos, size - pos, "]}");
+        }
+    }
+    
+    pthread_mutex_unlock(&registry->registry_mutex);
     return json_string;
-}
\ No newline at end of file
+}
@@ -8,26 +8,97 @@
 
 #include "mcp_types.h"  // MCP类型定义
 #include "mcp_tool.h"   // MCP工具定义
+#include "mcp_state_sync.h"  // 状态增量同步
+#include "../cjson/linx_json_arena.h"  // cJSON 单消息竞技场
+#include "../linx_executor.h"  // 后台任务执行器
+#include <pthread.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* 异步工具线程池默认配置 */
+#define MCP_DEFAULT_WORKER_COUNT 2      // 工作线程数
+#define MCP_DEFAULT_QUEUE_CAPACITY 8    // 排队中的调用上限，超出时立即回复错误
+
+/* tools/call 请求 _meta.progressToken 的最大JSON长度（含结尾 '\0'），更长的令牌忽略 */
+#define MCP_PROGRESS_TOKEN_MAX 64
+
+/* tools/list 单页工具JSON的最大字节数，超出部分通过 nextCursor 分页 */
+#define MCP_TOOLS_LIST_MAX_PAYLOAD 8000
+
+/* 尚未告知客户端的本地工具调用上限，超出时丢弃最早的一条 */
+#ifndef MCP_LOCAL_CALL_BACKLOG
+#define MCP_LOCAL_CALL_BACKLOG 8
+#endif
+
+/* tools/list 缓存：各工具JSON以逗号拼接，工具表变化时整体失效 */
+typedef struct {
+    char* json;                                 // 拼接后的工具数组内容（不含方括号），NULL 表示未生成
+    size_t length;                              // json 的字节数
+    size_t* offsets;                            // 每个工具在 json 中的起始字节偏移，即分页游标
+    size_t count;                               // 工具数量
+} mcp_tools_list_cache_t;
+
+/* 一次工具调用的剖析结果 */
+typedef struct {
+    const char* tool_name;                      // 工具名称，回调返回后失效
+    uint32_t args_us;                           // 参数校验与转换耗时（微秒）
+    uint32_t callback_us;                       // 工具回调耗时（微秒）
+    uint32_t serialize_us;                      // 返回值序列化与发送耗时（微秒）
+    uint32_t reply_bytes;                       // 响应中 result 的字节数，回复错误时为0
+    bool async;                                 // 在工作线程池中执行
+    bool slow;                                  // 三段耗时之和超过慢调用阈值
+} mcp_tool_call_profile_t;
+
+/* 工具调用剖析回调，在执行工具的线程上调用（异步工具为工作线程），不能阻塞 */
+typedef void (*mcp_tool_profile_handler_t)(const mcp_tool_call_profile_t* profile, void* user_data);
+
+/* 服务器实例的消息发送回调类型，message 为完整的 JSON-RPC 消息，回调返回后失效 */
+typedef void (*mcp_server_send_handler_t)(const char* message, void* user_data);
+
+/* 异步工具线程池 - 前向声明（隐藏实现细节） */
+typedef struct mcp_worker_pool mcp_worker_pool_t;
+
+/* 工具调用的进度/分块推送句柄 - 前向声明（隐藏实现细节） */
+typedef struct mcp_tool_stream mcp_tool_stream_t;
+
 /* MCP服务器结构体 */
 typedef struct mcp_server {
-    mcp_tool_t* tools[MCP_MAX_TOOLS];           // 工具数组
+    mcp_tool_t** tools;                         // 工具数组（按注册顺序，用于列表）
     size_t tool_count;                          // 工具数量
+    size_t tool_capacity;                       // 工具数组容量，不足时翻倍
+    size_t* tool_index;                         // 名称哈希索引（开放寻址，存 下标+1，0 为空槽）
+    size_t tool_index_size;                     // 索引槽数（2的幂，不低于工具容量的两倍）
+    pthread_mutex_t registry_mutex;             // 保护工具表，允许在工具回调中重入
+    mcp_tools_list_cache_t tools_list_cache[2]; // tools/list 缓存：[0] 全部工具，[1] 仅用户工具
     char server_name[MCP_MAX_NAME_LENGTH];      // 服务器名称
     char server_version[64];                    // 服务器版本
     mcp_capability_callbacks_t capability_callbacks; // 能力回调函数集合
+    linx_json_arena_t* json_arena;              // 构建响应用的 cJSON 竞技场（每条消息处理完后整体回收）
+    mcp_worker_pool_t* worker_pool;             // 异步工具线程池，未启动时为NULL
+    mcp_server_send_handler_t send_handler;     // 实例消息发送回调，NULL 时不发送
+    void* send_user_data;                       // 传给 send_handler 的用户数据
+    mcp_state_sync_t state_sync;                // 工具表和设备状态的增量同步，客户端声明支持后启用
+    bool client_state_sync;                     // 本次 initialize 的客户端声明了 capabilities.stateSync.mergePatch
+    char* initialize_result;                    // initialize 响应的 result，创建时生成（名称和版本不变）
+    uint64_t capabilities_hash;                 // 上次解析的 capabilities 的结构哈希
+    bool capabilities_parsed;                   // capabilities_hash 有效；修改能力回调后失效，下次重新解析
+    pthread_mutex_t local_call_mutex;           // 保护本地调用通知队列
+    char* local_calls[MCP_LOCAL_CALL_BACKLOG];  // 待发送的 notifications/tools/local_call（环形，cJSON_free 释放）
+    size_t local_call_head;                     // 最早一条的下标
+    size_t local_call_count;                    // 队列中的条数
+    bool tool_profiling;                        // 记录各工具的调用统计（原子读写）
+    uint32_t slow_tool_us;                      // 慢调用阈值（微秒），0 不报告（原子读写）
+    mcp_tool_profile_handler_t profile_handler; // 每次调用结束后的剖析回调（开始收消息前设置）
+    void* profile_user_data;                    // 传给 profile_handler 的用户数据
 } mcp_server_t;
 
-/* 消息发送回调函数类型 */
-typedef void (*mcp_send_message_callback_t)(const char* message);
 
 /* 服务器基础函数 */
 /**
  * 创建MCP服务器实例
+ * 实例登记一个内存压力收缩回调（见 linx_mem_pressure.h），压力升高时丢弃 tools/list 和工具结果缓存
  * @param server_name 服务器名称
  * @param server_version 服务器版本
  * @return 服务器实例指针，失败返回NULL
@@ -49,6 +120,24 @@ void mcp_server_destroy(mcp_server_t* server);
  */
 bool mcp_server_add_tool(mcp_server_t* server, mcp_tool_t* tool);
 
+/**
+ * 添加或替换同名工具（热更新）
+ * 替换时保留原工具在列表中的位置；旧工具若仍有异步调用在执行，等调用结束后再销毁
+ * @param server 服务器实例
+ * @param tool 工具实例，成功后所有权归服务器
+ * @return 成功返回true，失败返回false
+ */
+bool mcp_server_replace_tool(mcp_server_t* server, mcp_tool_t* tool);
+
+/**
+ * 移除并销毁工具
+ * 仍有异步调用在执行时推迟到调用结束后销毁，迟到的结果照常回复
+ * @param server 服务器实例
+ * @param name 工具名称
+ * @return 找到并移除返回true，否则返回false
+ */
+bool mcp_server_remove_tool(mcp_server_t* server, const char* name);
+
 /**
  * 向服务器添加简单工具
  * @param server 服务器实例
@@ -74,19 +163,236 @@ bool mcp_server_add_user_only_tool(mcp_server_t* server, const char* name, const
                                    mcp_property_list_t* properties, mcp_tool_callback_t callback);
 
 /**
- * 根据名称查找工具
+ * 向服务器添加异步工具
+ * 工具回调在工作线程中执行，结果通过消息发送回调回复，调用方线程不会被阻塞
+ * @param server 服务器实例
+ * @param name 工具名称
+ * @param description 工具描述
+ * @param properties 工具属性列表
+ * @param callback 工具回调函数（在工作线程中调用，必须是线程安全的）
+ * @param max_concurrency 最大并发调用数
+ * @param timeout_ms 超时时间（毫秒），0 表示默认值
+ * @return 成功返回true，失败返回false
+ */
+bool mcp_server_add_async_tool(mcp_server_t* server, const char* name, const char* description,
+                               mcp_property_list_t* properties, mcp_tool_callback_t callback,
+                               int max_concurrency, uint32_t timeout_ms);
+
+/**
+ * 向服务器添加接收参数视图的工具
+ * arguments 按 properties 校验一次后以只读视图传给回调，校验失败直接回复错误；
+ * 需要异步执行时用 mcp_tool_create_with_args 创建工具，mcp_tool_set_async 后经 mcp_server_add_tool 注册
+ * @param server 服务器实例
+ * @param name 工具名称
+ * @param description 工具描述
+ * @param properties 工具参数声明（提供类型、范围和默认值）
+ * @param args_callback 工具回调函数
+ * @return 成功返回true，失败返回false
+ */
+bool mcp_server_add_tool_with_args(mcp_server_t* server, const char* name, const char* description,
+                                   mcp_property_list_t* properties, mcp_tool_args_callback_t args_callback);
+
+/**
+ * 注册 MCP_STATIC_TOOLS_DEFINE 生成的静态工具表
+ * 工具直接引用编译期常量，不复制参数、不生成JSON；工具表只扩容一次
+ * @param server 服务器实例
+ * @param tools 工具指针数组
+ * @param count 工具数（MCP_STATIC_TOOLS_COUNT）
+ * @return 全部注册成功返回true；遇到重名等失败时停止，之前的工具保持注册
+ */
+bool mcp_server_add_static_tools(mcp_server_t* server, mcp_tool_t* const* tools, size_t count);
+
+/**
+ * 清空工具的结果缓存（见 mcp_tool_set_result_cache）
+ * 设备状态等被工具之外的途径修改后调用，下次调用重新执行回调
+ * @param server 服务器实例
+ * @param name 工具名称，NULL 表示全部工具
+ * @return 找到工具返回true
+ */
+bool mcp_server_invalidate_tool_cache(mcp_server_t* server, const char* name);
+
+/* 异步执行函数 */
+/**
+ * 启动异步工具线程池（创建服务器独占的后台任务执行器）
+ * 启动前异步工具仍在调用方线程同步执行
+ * @param server 服务器实例
+ * @param worker_count 工作线程数，0 表示 MCP_DEFAULT_WORKER_COUNT
+ * @param queue_capacity 排队上限，0 表示 MCP_DEFAULT_QUEUE_CAPACITY
+ * @return 成功返回true，失败返回false
+ */
+bool mcp_server_start_workers(mcp_server_t* server, size_t worker_count, size_t queue_capacity);
+
+/**
+ * 在共享的后台任务执行器上运行异步工具（高优先级任务）
+ * 执行器由调用者持有，必须在 mcp_server_stop_workers() 之后才能销毁
+ * @param server 服务器实例
+ * @param executor 执行器
+ * @param queue_capacity 排队上限，0 表示 MCP_DEFAULT_QUEUE_CAPACITY
+ * @return 成功返回true，失败返回false
+ */
+bool mcp_server_start_workers_on(mcp_server_t* server, linx_executor_t* executor, size_t queue_capacity);
+
+/**
+ * 停止异步工具线程池
+ * 丢弃排队中的调用，取消执行中调用的令牌并等待回调返回；mcp_server_destroy() 会自动调用
+ * @param server 服务器实例
+ */
+void mcp_server_stop_workers(mcp_server_t* server);
+
+/**
+ * 当前工具调用是否已被取消（异步调用超时或线程池停止）
+ * 耗时的工具在回调中定期检查，已取消时尽早返回，返回值会被丢弃
+ * @return 不在异步工具回调中时返回false
+ */
+bool mcp_tool_call_is_cancelled(void);
+
+/**
+ * 根据名称查找工具（哈希索引，O(1)）
  * @param server 服务器实例
  * @param name 工具名称
- * @return 工具实例指针，未找到返回NULL
+ * @return 工具实例指针，未找到返回NULL；工具被移除或替换后指针失效
  */
 const mcp_tool_t* mcp_server_find_tool(const mcp_server_t* server, const char* name);
 
+/**
+ * 在设备本地调用工具（本地命令识别等不经过服务端的快速路径）
+ * 在调用方线程同步执行回调，异步工具也不进入线程池；参数按 tools/call 的规则校验，
+ * 不使用结果缓存，回调中的进度和分块推送直接丢弃。
+ * 调用结果（成功或失败）记入通知队列，由 mcp_server_flush_local_calls() 发给客户端：
+ *   notifications/tools/local_call {"name":"...","arguments":{...},"utterance":"...",
+ *                                   "result":{...}} 或 {..., "error":"..."}
+ * 客户端据此把设备已执行的操作补进对话上下文。下一次 initialize 响应之后自动发送，
+ * 离线期间的调用在重新连接后告知客户端。
+ * @param server 服务器实例
+ * @param name 工具名称
+ * @param arguments 工具参数对象，可为NULL
+ * @param utterance 触发调用的用户指令（如识别出的命令词），可为NULL
+ * @param result 输出：tools/call 响应中的 result JSON，调用者使用 LINX_FREE 释放；可为NULL
+ * @return 工具存在且执行成功返回true
+ */
+bool mcp_server_call_tool_local(mcp_server_t* server, const char* name, const cJSON* arguments,
+                                const char* utterance, char** result);
+
+/**
+ * 发送排队的本地调用通知（会话已建立时调用；发送回调离线时丢弃的通知不会重发）
+ * @param server 服务器实例
+ * @return 发送的通知数
+ */
+size_t mcp_server_flush_local_calls(mcp_server_t* server);
+
+/* 工具调用进度与分块结果
+ * 耗时的工具（MCP 升级、摄像头扫描等）在回调中取得推送句柄，调用完成前即可发送：
+ *   notifications/progress      {"progressToken":T,"progress":3,"total":10,"message":"..."}
+ *     标准进度通知，仅当请求在 params._meta.progressToken 中携带令牌时发送；进度必须递增
+ *   notifications/tools/chunk   {"requestId":7,"progressToken":T,"index":0,
+ *                                "content":[{"type":"text","text":"..."}]}
+ *     部分结果，客户端可以先行播报；index 从 0 递增，请求没有令牌时不带 progressToken
+ * 最终结果仍由回调返回值作为 tools/call 响应发送，分块内容不会在其中重复。
+ * 调用回复（或异步调用超时）之后的推送直接丢弃，保证通知不会晚于响应。
+ */
+
+/**
+ * 获取当前线程正在执行的工具调用的推送句柄（首次调用时创建）
+ * 只能在工具回调所在的线程中调用；句柄在回调返回前有效，
+ * 需要交给其他线程推送时先 mcp_tool_stream_retain
+ * @return 推送句柄，不在工具回调中或内存不足时返回NULL
+ */
+mcp_tool_stream_t* mcp_tool_stream_current(void);
+
+/**
+ * 增加句柄引用
+ * @param stream 推送句柄
+ * @return stream
+ */
+mcp_tool_stream_t* mcp_tool_stream_retain(mcp_tool_stream_t* stream);
+
+/**
+ * 释放 mcp_tool_stream_retain 取得的引用
+ * @param stream 推送句柄，可以为NULL
+ */
+void mcp_tool_stream_release(mcp_tool_stream_t* stream);
+
+/**
+ * 调用是否仍在进行（未回复、未超时），可用于提前放弃已无意义的工作
+ * @param stream 推送句柄
+ * @return 仍可推送返回true
+ */
+bool mcp_tool_stream_is_open(mcp_tool_stream_t* stream);
+
+/**
+ * 发送进度通知（线程安全）
+ * @param stream 推送句柄
+ * @param progress 当前进度，必须大于上次发送的值
+ * @param total 总量，小于等于0表示未知
+ * @param message 进度说明，可以为NULL
+ * @return 已发送返回true；请求未携带 progressToken、进度未递增或调用已结束返回false
+ */
+bool mcp_tool_stream_progress(mcp_tool_stream_t* stream, double progress, double total, const char* message);
+
+/**
+ * 发送一段文本部分结果（线程安全）
+ * @param stream 推送句柄
+ * @param text 文本内容
+ * @return 已发送返回true；调用已结束或内存不足返回false
+ */
+bool mcp_tool_stream_send_text(mcp_tool_stream_t* stream, const char* text);
+
+/* 状态同步函数（协议见 mcp_state_sync.h） */
+/**
+ * 发布一个状态对象（如设备状态），客户端支持增量同步时发送相对于其最后确认版本的 Merge Patch
+ * 内容与上次发布相同时不发送；客户端不支持时只记录，下次支持增量同步的客户端初始化后整体发送
+ * @param server 服务器实例
+ * @param resource 资源名，不能是 MCP_STATE_SYNC_TOOLS（工具表由服务器自动同步）
+ * @param state 完整的 JSON 对象（复制，调用者保留所有权），NULL 表示删除
+ * @return 成功返回true
+ */
+bool mcp_server_publish_state(mcp_server_t* server, const char* resource, const cJSON* state);
+
+/**
+ * 获取状态同步统计
+ * @param server 服务器实例
+ * @param stats 输出统计
+ */
+void mcp_server_get_state_sync_stats(mcp_server_t* server, mcp_state_sync_stats_t* stats);
+
+/* 工具调用剖析 */
+/**
+ * 开启或关闭工具调用剖析
+ * 开启后每个工具在首次调用时创建统计（约 600 字节），记录调用次数、参数转换、回调、
+ * 序列化耗时和响应大小的直方图；客户端可用 tools/stats 查询。关闭后停止记录，已有统计保留
+ * @param server 服务器实例
+ * @param enabled 是否记录
+ * @param slow_threshold_ms 慢调用阈值（毫秒），超过时输出警告并在剖析回调中标记，0 不报告
+ */
+void mcp_server_set_tool_profiling(mcp_server_t* server, bool enabled, uint32_t slow_threshold_ms);
+
+/**
+ * 设置工具调用剖析回调（需开启剖析，应在开始收消息前设置）
+ * @param server 服务器实例
+ * @param handler 每次执行回调的调用结束后调用，NULL 取消
+ * @param user_data 传给回调的用户数据
+ */
+void mcp_server_set_tool_profile_handler(mcp_server_t* server, mcp_tool_profile_handler_t handler, void* user_data);
+
+/**
+ * 获取工具的调用统计
+ * @param server 服务器实例
+ * @param name 工具名称
+ * @param stats 输出统计
+ * @return 工具存在且有统计返回true
+ */
+bool mcp_server_get_tool_stats(mcp_server_t* server, const char* name, mcp_tool_stats_t* stats);
+
 /* 消息处理函数 */
 /**
- * 设置消息发送回调函数
- * @param callback 回调函数指针
+ * 设置服务器实例的消息发送回调
+ * 同一进程中的多个服务器可以各自回复到不同的连接；
+ * 回调可能在工作线程中调用，应在 mcp_server_start_workers 之前设置
+ * @param server 服务器实例
+ * @param handler 回调函数，NULL 表示不再发送回复
+ * @param user_data 传给回调的用户数据
  */
-void mcp_server_set_send_callback(mcp_send_message_callback_t callback);
+void mcp_server_set_send_handler(mcp_server_t* server, mcp_server_send_handler_t handler, void* user_data);
 
 /**
  * 解析字符串消息
@@ -97,25 +403,29 @@ void mcp_server_parse_message(mcp_server_t* server, const char* message);
 
 /**
  * 解析JSON消息
+ * 支持 JSON-RPC 2.0 批量请求（请求数组）：异步工具在线程池中并行执行，
+ * 全部完成后以一个响应数组回复，只含通知的批量请求不回复
  * @param server 服务器实例
- * @param json JSON对象
+ * @param json JSON对象或请求数组
  */
 void mcp_server_parse_json_message(mcp_server_t* server, const cJSON* json);
 
 /* 响应函数 */
 /**
  * 回复成功结果
+ * @param server 服务器实例
  * @param id 请求ID
  * @param result 结果字符串
  */
-void mcp_server_reply_result(int id, const char* result);
+void mcp_server_reply_result(mcp_server_t* server, int id, const char* result);
 
 /**
  * 回复错误信息
+ * @param server 服务器实例
  * @param id 请求ID
  * @param message 错误消息
  */
-void mcp_server_reply_error(int id, const char* message);
+void mcp_server_reply_error(mcp_server_t* server, int id, const char* message);
 
 /* 处理器函数 */
 /**
@@ -136,12 +446,22 @@ void mcp_server_handle_tools_list(mcp_server_t* server, int id, const cJSON* par
 
 /**
  * 处理工具调用请求
+ * 异步工具在线程池启动后提交到线程池，结果稍后回复
  * @param server 服务器实例
  * @param id 请求ID
  * @param params 参数JSON对象
  */
 void mcp_server_handle_tools_call(mcp_server_t* server, int id, const cJSON* params);
 
+/**
+ * 处理工具统计请求（扩展方法 tools/stats）
+ * 返回开启剖析以来各工具的调用统计；params.name 只返回指定工具
+ * @param server 服务器实例
+ * @param id 请求ID
+ * @param params 参数JSON对象，可以为NULL
+ */
+void mcp_server_handle_tools_stats(mcp_server_t* server, int id, const cJSON* params);
+
 /* 能力解析函数 */
 /**
  * 解析能力配置
@@ -161,13 +481,23 @@ void mcp_server_set_capability_callbacks(mcp_server_t* server, const mcp_capabil
 /* 工具函数 */
 /**
  * 获取工具列表的JSON字符串
+ * 结果来自缓存，工具增删或替换后才重新生成；单页超过 MCP_TOOLS_LIST_MAX_PAYLOAD
+ * 时附带 nextCursor（下一个工具在缓存中的字节偏移）
  * @param server 服务器实例
- * @param cursor 游标（用于分页）
+ * @param cursor 游标（上一页的 nextCursor），NULL 表示第一页
  * @param list_user_only_tools 是否只列出用户专用工具
- * @return JSON字符串，需要调用者释放内存
+ * @return JSON字符串，需要调用者使用 cJSON_free() 释放内存；游标无效返回NULL
  */
 char* mcp_server_get_tools_list_json(const mcp_server_t* server, const char* cursor, bool list_user_only_tools);
 
+/**
+ * 获取完整工具列表的哈希（FNV-1a，覆盖 tools/list 返回的全部工具JSON）
+ * 工具增删、替换或描述变化后哈希随之改变，可用来判断客户端上次取得的列表是否仍然有效
+ * @param server 服务器实例
+ * @return 哈希值，失败返回 0
+ */
+uint64_t mcp_server_get_tools_hash(const mcp_server_t* server);
+
 #ifdef __cplusplus
 }
 #endif
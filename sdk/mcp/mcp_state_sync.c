@@ -0,0 +1,326 @@
+/*
+ * MCP状态增量同步实现文件
+ * 记录每个资源的最新状态、客户端最后确认的状态和在途版本，按需生成 Merge Patch 通知
+ */
+
+#include "mcp_state_sync.h"
+#include "../log/linx_log.h"
+#include "../cjson/cJSON_Utils.h"
+#include "../cjson/linx_json_arena.h"
+#include <string.h>
+
+/**
+ * 初始化状态同步器
+ */
+void mcp_state_sync_init(mcp_state_sync_t* sync) {
+    if (!sync) {
+        return;
+    }
+    memset(sync, 0, sizeof(*sync));
+
+    // 发送回调可能再发布状态，使用可重入锁
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&sync->mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+    linx_json_writer_init(&sync->writer);
+}
+
+/**
+ * 丢弃资源的确认和在途版本（调用者持锁）
+ */
+static void mcp_state_sync_forget(mcp_state_sync_resource_t* resource) {
+    cJSON_Delete(resource->acked);
+    resource->acked = NULL;
+    resource->acked_version = 0;
+    for (size_t i = 0; i < resource->inflight_count; i++) {
+        cJSON_Delete(resource->inflight[i].state);
+    }
+    memset(resource->inflight, 0, sizeof(resource->inflight));
+    resource->inflight_count = 0;
+}
+
+/**
+ * 释放同步器持有的全部状态
+ */
+void mcp_state_sync_deinit(mcp_state_sync_t* sync) {
+    if (!sync) {
+        return;
+    }
+
+    bool arena_suspended = linx_json_arena_suspend();
+    for (size_t i = 0; i < sync->resource_count; i++) {
+        mcp_state_sync_forget(&sync->resources[i]);
+        cJSON_Delete(sync->resources[i].current);
+        sync->resources[i].current = NULL;
+    }
+    linx_json_arena_resume(arena_suspended);
+    sync->resource_count = 0;
+    linx_json_writer_free(&sync->writer);
+    pthread_mutex_destroy(&sync->mutex);
+}
+
+/**
+ * 按名称查找资源，create 为 true 时不存在则新建（调用者持锁）
+ */
+static mcp_state_sync_resource_t* mcp_state_sync_find(mcp_state_sync_t* sync, const char* name, bool create) {
+    for (size_t i = 0; i < sync->resource_count; i++) {
+        if (strcmp(sync->resources[i].name, name) == 0) {
+            return &sync->resources[i];
+        }
+    }
+    if (!create || sync->resource_count >= MCP_STATE_SYNC_MAX_RESOURCES ||
+        strlen(name) >= MCP_STATE_SYNC_NAME_LENGTH) {
+        return NULL;
+    }
+
+    mcp_state_sync_resource_t* resource = &sync->resources[sync->resource_count++];
+    memset(resource, 0, sizeof(*resource));
+    strcpy(resource->name, name);
+    resource->next_version = 1;
+    return resource;
+}
+
+/**
+ * 发送资源最新状态相对于最后确认版本的补丁，并记为在途版本（调用者持锁、已暂停竞技场）
+ */
+static void mcp_state_sync_send_current(mcp_state_sync_t* sync, mcp_state_sync_resource_t* resource,
+                                        mcp_state_sync_send_t send, void* user_data) {
+    if (!sync->active || !send) {
+        return;
+    }
+
+    // 补丁生成会对两侧对象的成员排序，对快照操作，不动 current
+    cJSON* target = NULL;
+    if (resource->current) {
+        target = cJSON_Duplicate(resource->current, true);
+        if (!target) {
+            LOG_ERROR("State sync: failed to snapshot '%s'", resource->name);
+            return;
+        }
+    }
+
+    cJSON* patch = NULL;
+    bool full = resource->acked == NULL || target == NULL;
+    if (!full) {
+        patch = cJSONUtils_GenerateMergePatchCaseSensitive(resource->acked, target);
+    }
+
+    uint32_t version = resource->next_version;
+    linx_json_writer_t* writer = &sync->writer;
+    linx_json_writer_reset(writer);
+    linx_json_writer_begin_object(writer);
+    linx_json_writer_add_string(writer, "jsonrpc", "2.0");
+    linx_json_writer_add_string(writer, "method", "notifications/state/patch");
+    linx_json_writer_key(writer, "params");
+    linx_json_writer_begin_object(writer);
+    linx_json_writer_add_string(writer, "resource", resource->name);
+    linx_json_writer_add_int(writer, "version", version);
+    linx_json_writer_add_int(writer, "base", full ? 0 : resource->acked_version);
+    linx_json_writer_key(writer, "patch");
+    size_t patch_start = writer->length;
+    if (!target) {
+        // 资源被删除，按 RFC 7386 以 null 表示
+        linx_json_writer_null(writer);
+    } else if (full) {
+        linx_json_writer_value(writer, target);
+    } else if (patch) {
+        linx_json_writer_value(writer, patch);
+    } else {
+        // 与已确认版本相同
+        linx_json_writer_raw(writer, "{}", 2);
+    }
+    size_t patch_length = writer->length - patch_start;
+    linx_json_writer_end_object(writer);
+    linx_json_writer_end_object(writer);
+    cJSON_Delete(patch);
+
+    const char* message = linx_json_writer_finish(writer);
+    if (!message) {
+        LOG_ERROR("State sync: failed to print patch for '%s'", resource->name);
+        cJSON_Delete(target);
+        return;
+    }
+
+    // 在途版本已满时丢弃最旧的，对它的确认将被忽略
+    if (resource->inflight_count == MCP_STATE_SYNC_MAX_INFLIGHT) {
+        cJSON_Delete(resource->inflight[0].state);
+        memmove(&resource->inflight[0], &resource->inflight[1],
+                (MCP_STATE_SYNC_MAX_INFLIGHT - 1) * sizeof(resource->inflight[0]));
+        resource->inflight_count--;
+    }
+    resource->inflight[resource->inflight_count].version = version;
+    resource->inflight[resource->inflight_count].state = target;
+    resource->inflight_count++;
+    resource->next_version = version == UINT32_MAX ? 1 : version + 1;
+
+    sync->stats.patches_sent++;
+    sync->stats.full_sent += full ? 1 : 0;
+    sync->stats.patch_bytes += patch_length;
+    sync->stats.full_bytes += full ? patch_length : linx_json_print_estimate(target);
+    LOG_DEBUG("State sync: '%s' v%u base v%u, %zu bytes", resource->name, version,
+              full ? 0 : resource->acked_version, patch_length);
+
+    send(message, user_data);
+}
+
+/**
+ * 结束当前同步会话
+ */
+void mcp_state_sync_reset(mcp_state_sync_t* sync) {
+    if (!sync) {
+        return;
+    }
+
+    pthread_mutex_lock(&sync->mutex);
+    bool arena_suspended = linx_json_arena_suspend();
+    __atomic_store_n(&sync->active, false, __ATOMIC_RELEASE);
+    for (size_t i = 0; i < sync->resource_count; i++) {
+        mcp_state_sync_forget(&sync->resources[i]);
+    }
+    linx_json_arena_resume(arena_suspended);
+    pthread_mutex_unlock(&sync->mutex);
+}
+
+/**
+ * 开始同步并发送各资源的完整对象
+ */
+void mcp_state_sync_activate(mcp_state_sync_t* sync, mcp_state_sync_send_t send, void* user_data) {
+    if (!sync) {
+        return;
+    }
+
+    pthread_mutex_lock(&sync->mutex);
+    bool arena_suspended = linx_json_arena_suspend();
+    __atomic_store_n(&sync->active, true, __ATOMIC_RELEASE);
+    for (size_t i = 0; i < sync->resource_count; i++) {
+        if (sync->resources[i].current) {
+            mcp_state_sync_send_current(sync, &sync->resources[i], send, user_data);
+        }
+    }
+    linx_json_arena_resume(arena_suspended);
+    pthread_mutex_unlock(&sync->mutex);
+}
+
+/**
+ * 是否已激活
+ */
+bool mcp_state_sync_is_active(const mcp_state_sync_t* sync) {
+    return sync && __atomic_load_n(&sync->active, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * 发布资源的最新状态
+ */
+bool mcp_state_sync_publish(mcp_state_sync_t* sync, const char* resource_name, const cJSON* state,
+                            mcp_state_sync_send_t send, void* user_data) {
+    if (!sync || !resource_name || resource_name[0] == '\0') {
+        return false;
+    }
+
+    pthread_mutex_lock(&sync->mutex);
+    // 保存的状态跨消息存在，不能从调用方的竞技场分配
+    bool arena_suspended = linx_json_arena_suspend();
+
+    bool ok = true;
+    mcp_state_sync_resource_t* resource = mcp_state_sync_find(sync, resource_name, state != NULL);
+    if (!resource) {
+        ok = state == NULL;
+        if (!ok) {
+            LOG_WARN("State sync: cannot track resource '%s'", resource_name);
+        }
+    } else if ((!resource->current && !state) ||
+               (resource->current && state && cJSON_Compare(resource->current, state, true))) {
+        // 内容没有变化
+    } else {
+        cJSON* copy = state ? cJSON_Duplicate(state, true) : NULL;
+        if (state && !copy) {
+            LOG_ERROR("State sync: failed to copy '%s'", resource_name);
+            ok = false;
+        } else {
+            cJSON_Delete(resource->current);
+            resource->current = copy;
+            mcp_state_sync_send_current(sync, resource, send, user_data);
+        }
+    }
+
+    linx_json_arena_resume(arena_suspended);
+    pthread_mutex_unlock(&sync->mutex);
+    return ok;
+}
+
+/**
+ * 处理 notifications/state/ack
+ */
+bool mcp_state_sync_handle_ack(mcp_state_sync_t* sync, const cJSON* params,
+                               mcp_state_sync_send_t send, void* user_data) {
+    if (!sync || !params) {
+        return false;
+    }
+
+    const cJSON* name = cJSON_GetObjectItemCaseSensitive(params, "resource");
+    const cJSON* version_json = cJSON_GetObjectItemCaseSensitive(params, "version");
+    if (!cJSON_IsString(name) || !cJSON_IsNumber(version_json) ||
+        version_json->valuedouble < 0 || version_json->valuedouble > (double)UINT32_MAX) {
+        LOG_WARN("State sync: malformed ack");
+        return false;
+    }
+    uint32_t version = (uint32_t)version_json->valuedouble;
+
+    pthread_mutex_lock(&sync->mutex);
+    bool arena_suspended = linx_json_arena_suspend();
+
+    bool ok = false;
+    mcp_state_sync_resource_t* resource = mcp_state_sync_find(sync, name->valuestring, false);
+    if (!resource) {
+        LOG_WARN("State sync: ack for unknown resource '%s'", name->valuestring);
+    } else if (version == 0) {
+        // 客户端丢失了状态，从完整对象重新开始
+        LOG_INFO("State sync: client requested full '%s'", resource->name);
+        mcp_state_sync_forget(resource);
+        if (resource->current) {
+            mcp_state_sync_send_current(sync, resource, send, user_data);
+        }
+        ok = true;
+    } else {
+        size_t i = 0;
+        while (i < resource->inflight_count && resource->inflight[i].version != version) {
+            i++;
+        }
+        if (i == resource->inflight_count) {
+            // 重复的确认或已被挤出的版本，继续以原基准发送
+            sync->stats.stale_acks++;
+            LOG_DEBUG("State sync: stale ack '%s' v%u", resource->name, version);
+        } else {
+            // 确认的版本成为新基准，更早的在途版本不会再被确认
+            cJSON_Delete(resource->acked);
+            resource->acked = resource->inflight[i].state;
+            resource->acked_version = version;
+            for (size_t j = 0; j < i; j++) {
+                cJSON_Delete(resource->inflight[j].state);
+            }
+            resource->inflight_count -= i + 1;
+            memmove(&resource->inflight[0], &resource->inflight[i + 1],
+                    resource->inflight_count * sizeof(resource->inflight[0]));
+            sync->stats.acks++;
+            ok = true;
+        }
+    }
+
+    linx_json_arena_resume(arena_suspended);
+    pthread_mutex_unlock(&sync->mutex);
+    return ok;
+}
+
+/**
+ * 获取同步统计
+ */
+void mcp_state_sync_get_stats(mcp_state_sync_t* sync, mcp_state_sync_stats_t* stats) {
+    if (!sync || !stats) {
+        return;
+    }
+    pthread_mutex_lock(&sync->mutex);
+    *stats = sync->stats;
+    pthread_mutex_unlock(&sync->mutex);
+}
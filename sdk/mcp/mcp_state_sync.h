@@ -0,0 +1,149 @@
+/*
+ * MCP状态增量同步头文件
+ * 工具表、设备状态等对象变化时只发送相对于客户端最后确认版本的 JSON Merge Patch（RFC 7386），
+ * 不再每次发送完整对象
+ *
+ * 协议（客户端在 initialize 的 capabilities.stateSync.mergePatch 中声明支持后启用）：
+ *   服务器 -> 客户端  notifications/state/patch
+ *     {"resource":"device","version":5,"base":3,"patch":{...}}
+ *     patch 是从 base 版本到 version 版本的差异；base 为 0 时 patch 即完整对象
+ *   客户端 -> 服务器  notifications/state/ack
+ *     {"resource":"device","version":5}
+ *     确认已应用某个版本，之后的补丁以它为基准；version 为 0 表示请求完整重发
+ * 客户端需要保留已确认版本之后收到的各版本，直到确认了更新的版本：补丁总是相对于服务器
+ * 收到的最后一次确认，确认在途时仍会收到以旧版本为基准的补丁。
+ */
+
+#ifndef MCP_STATE_SYNC_H
+#define MCP_STATE_SYNC_H
+
+#include "mcp_types.h"          // MCP类型定义
+#include "../cjson/linx_json_writer.h"
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 同步资源数上限（包括服务器自己的工具表） */
+#define MCP_STATE_SYNC_MAX_RESOURCES 8
+
+/* 每个资源保留的未确认版本数，超出时丢弃最旧的（该版本的确认随之失效） */
+#define MCP_STATE_SYNC_MAX_INFLIGHT 4
+
+/* 资源名最大长度（含结尾 '\0'） */
+#define MCP_STATE_SYNC_NAME_LENGTH 32
+
+/* 服务器工具表对应的资源名：以工具名为键、工具定义为值的对象 */
+#define MCP_STATE_SYNC_TOOLS "tools"
+
+/* 已发送、等待确认的版本 */
+typedef struct {
+    uint32_t version;
+    cJSON* state;                       // 该版本的完整对象
+} mcp_state_sync_version_t;
+
+/* 一个同步资源 */
+typedef struct {
+    char name[MCP_STATE_SYNC_NAME_LENGTH];
+    cJSON* current;                     // 最新状态（由 mcp_state_sync_publish 设置），NULL 表示未发布
+    cJSON* acked;                       // 客户端最后确认的状态，NULL 表示客户端没有任何版本
+    uint32_t acked_version;             // acked 的版本号，0 表示没有
+    uint32_t next_version;              // 下一个发送的版本号
+    mcp_state_sync_version_t inflight[MCP_STATE_SYNC_MAX_INFLIGHT]; // 按版本递增
+    size_t inflight_count;
+} mcp_state_sync_resource_t;
+
+/* 同步统计 */
+typedef struct {
+    uint64_t patches_sent;              // 已发送的补丁数
+    uint64_t full_sent;                 // 其中以完整对象发送的（base 为 0）
+    uint64_t patch_bytes;               // 已发送补丁的 patch 部分字节数
+    uint64_t full_bytes;                // 同样这些版本按完整对象发送时的字节数（估算上界），用于对比
+    uint64_t acks;                      // 有效确认数
+    uint64_t stale_acks;                // 版本已不在保留范围内而忽略的确认数
+} mcp_state_sync_stats_t;
+
+/* 发送通知回调，message 为完整的 JSON-RPC 通知，回调返回后失效 */
+typedef void (*mcp_state_sync_send_t)(const char* message, void* user_data);
+
+/* 状态同步器 */
+typedef struct {
+    pthread_mutex_t mutex;              // 保护以下字段；发送回调在持锁时调用，保证通知按版本顺序发出
+    bool active;                        // 客户端已声明支持，未声明时只记录最新状态
+    mcp_state_sync_resource_t resources[MCP_STATE_SYNC_MAX_RESOURCES];
+    size_t resource_count;
+    linx_json_writer_t writer;          // 通知的打印缓冲区，复用
+    mcp_state_sync_stats_t stats;
+} mcp_state_sync_t;
+
+/**
+ * 初始化状态同步器（未激活）
+ * @param sync 同步器
+ */
+void mcp_state_sync_init(mcp_state_sync_t* sync);
+
+/**
+ * 释放同步器持有的全部状态
+ * @param sync 同步器
+ */
+void mcp_state_sync_deinit(mcp_state_sync_t* sync);
+
+/**
+ * 结束当前同步会话（收到 initialize 时调用）：停止发送，丢弃所有确认和在途版本，保留最新状态
+ * @param sync 同步器
+ */
+void mcp_state_sync_reset(mcp_state_sync_t* sync);
+
+/**
+ * 客户端声明支持后开始同步，把每个已发布的资源以完整对象发送一次
+ * @param sync 同步器
+ * @param send 发送回调
+ * @param user_data 传给 send 的用户数据
+ */
+void mcp_state_sync_activate(mcp_state_sync_t* sync, mcp_state_sync_send_t send, void* user_data);
+
+/**
+ * 是否已激活（无锁读取，用于跳过只有激活时才需要的准备工作）
+ * @param sync 同步器
+ * @return 已激活返回true
+ */
+bool mcp_state_sync_is_active(const mcp_state_sync_t* sync);
+
+/**
+ * 发布资源的最新状态
+ * 与上次发布的内容相同时不发送；激活时发送相对于最后确认版本的补丁
+ * @param sync 同步器
+ * @param resource 资源名
+ * @param state 完整的 JSON 对象（复制，调用者保留所有权），NULL 表示删除资源
+ * @param send 发送回调
+ * @param user_data 传给 send 的用户数据
+ * @return 状态已记录返回true；资源数已满、参数无效或内存不足返回false
+ */
+bool mcp_state_sync_publish(mcp_state_sync_t* sync, const char* resource, const cJSON* state,
+                            mcp_state_sync_send_t send, void* user_data);
+
+/**
+ * 处理 notifications/state/ack
+ * 版本 0 时清空确认并立即以完整对象重发
+ * @param sync 同步器
+ * @param params 通知参数
+ * @param send 发送回调
+ * @param user_data 传给 send 的用户数据
+ * @return 确认有效返回true
+ */
+bool mcp_state_sync_handle_ack(mcp_state_sync_t* sync, const cJSON* params,
+                               mcp_state_sync_send_t send, void* user_data);
+
+/**
+ * 获取同步统计
+ * @param sync 同步器
+ * @param stats 输出统计
+ */
+void mcp_state_sync_get_stats(mcp_state_sync_t* sync, mcp_state_sync_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MCP_STATE_SYNC_H */
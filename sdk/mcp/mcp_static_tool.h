@@ -0,0 +1,256 @@
+/*
+ * MCP静态工具声明头文件
+ * 固件中固定不变的工具表可以用 X-macro 在编译期声明：参数数组、参数列表和每个工具在
+ * tools/list 中的 JSON 都生成为常量（位于 flash），注册时不创建属性、不复制、不序列化，
+ * 启动时没有额外开销，tools/list 直接拼接这些常量
+ *
+ * 用法：
+ *
+ *   #define DEVICE_TOOLS(TOOL)                                                        \
+ *       TOOL(get_status, "self.get_device_status", "Get the device status",           \
+ *            MCP_STATIC_CALLBACK(on_get_status), MCP_STATIC_PUBLIC,                   \
+ *            MCP_STATIC_NO_PARAMS, MCP_STATIC_NO_PARAMS)                              \
+ *       TOOL(set_volume, "self.audio_speaker.set_volume", "Set the speaker volume",   \
+ *            MCP_STATIC_CALLBACK(on_set_volume), MCP_STATIC_PUBLIC,                   \
+ *            MCP_STATIC_PARAMS(MCP_STATIC_INTEGER_RANGE("volume", 0, 100)),           \
+ *            MCP_STATIC_PARAMS(MCP_STATIC_BOOLEAN_DEFAULT("fade", false)))
+ *
+ *   MCP_STATIC_TOOLS_DEFINE(device_tools, DEVICE_TOOLS);
+ *
+ *   mcp_server_add_static_tools(server, device_tools, MCP_STATIC_TOOLS_COUNT(device_tools));
+ *
+ * TOOL 的参数依次为：标识符（生成的变量名后缀）、工具名、描述、回调、可见性、
+ * 必需参数组、可选参数组（带默认值）。参数组为 MCP_STATIC_PARAMS(...) 或 MCP_STATIC_NO_PARAMS，
+ * 每组最多 MCP_STATIC_MAX_GROUP_PARAMS 个参数；生成的 JSON 与同样顺序（先必需后可选）
+ * 经 mcp_tool_create 创建的工具一致，可用 mcp_tool_check_static 核对。
+ *
+ * 限制（JSON 在编译期拼接，不做转义）：
+ *   - 工具名、描述、参数名和字符串默认值必须是字符串字面量，不能含 '"'、'\' 或控制字符
+ *   - 整数、浮点数默认值和范围必须是字面量（或展开为字面量的宏），浮点数不带 f 后缀
+ *   - 布尔默认值为 true/false（或 1/0）
+ *
+ * 工具结构体本身（调用计数、结果缓存等运行时状态）仍在 RAM 中，约百字节；
+ * 异步执行、结果缓存在注册前用 mcp_tool_set_async / mcp_tool_set_result_cache 设置。
+ * 静态工具从服务器移除或服务器销毁时只清理运行时状态，之后可以重新注册。
+ */
+
+#ifndef MCP_STATIC_TOOL_H
+#define MCP_STATIC_TOOL_H
+
+#include "mcp_tool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 每个参数组的参数数上限 */
+#define MCP_STATIC_MAX_GROUP_PARAMS 8
+
+/* ---- 参数声明 ---- */
+
+#define MCP_STATIC_BOOLEAN(name)                         (MCP_SK_BOOLEAN, name, 0, 0, 0)
+#define MCP_STATIC_BOOLEAN_DEFAULT(name, value)          (MCP_SK_BOOLEAN_DEFAULT, name, value, 0, 0)
+#define MCP_STATIC_INTEGER(name)                         (MCP_SK_INTEGER, name, 0, 0, 0)
+#define MCP_STATIC_INTEGER_DEFAULT(name, value)          (MCP_SK_INTEGER_DEFAULT, name, value, 0, 0)
+#define MCP_STATIC_INTEGER_RANGE(name, min, max)         (MCP_SK_INTEGER_RANGE, name, 0, min, max)
+#define MCP_STATIC_INTEGER_RANGE_DEFAULT(name, value, min, max) \
+                                                         (MCP_SK_INTEGER_RANGE_DEFAULT, name, value, min, max)
+#define MCP_STATIC_STRING(name)                          (MCP_SK_STRING, name, 0, 0, 0)
+#define MCP_STATIC_STRING_DEFAULT(name, value)           (MCP_SK_STRING_DEFAULT, name, value, 0, 0)
+#define MCP_STATIC_NUMBER(name)                          (MCP_SK_NUMBER, name, 0, 0, 0)
+#define MCP_STATIC_NUMBER_DEFAULT(name, value)           (MCP_SK_NUMBER_DEFAULT, name, value, 0, 0)
+
+/* 参数组 */
+#define MCP_STATIC_PARAMS(...)  (1, (__VA_ARGS__))
+#define MCP_STATIC_NO_PARAMS    (0, ())
+
+/* 回调：属性列表形式或参数视图形式 */
+#define MCP_STATIC_CALLBACK(fn)      .callback = (fn)
+#define MCP_STATIC_ARGS_CALLBACK(fn) .args_callback = (fn)
+
+/* 可见性 */
+#define MCP_STATIC_PUBLIC     (0, "")
+#define MCP_STATIC_USER_ONLY  (1, ",\"annotations\":{\"audience\":[\"user\"]}")
+
+/**
+ * 定义静态工具表
+ * 生成 static mcp_tool_t* const table[]，其余生成的对象均为 static，不占用外部符号
+ * @param table 工具指针数组的变量名
+ * @param LIST X-macro 工具列表，形如 LIST(TOOL)
+ */
+#define MCP_STATIC_TOOLS_DEFINE(table, LIST)                                        \
+    LIST(MCP_SJ_TOOL_DEFINE)                                                        \
+    static mcp_tool_t* const table[] = { LIST(MCP_SJ_TOOL_REF) }
+
+/* 工具表中的工具数 */
+#define MCP_STATIC_TOOLS_COUNT(table) (sizeof(table) / sizeof((table)[0]))
+
+/* 单个静态工具的变量（MCP_STATIC_TOOLS_DEFINE 之后可用，例如用于设置异步） */
+#define MCP_STATIC_TOOL(id) (&mcp_static_tool_##id)
+
+/* ======== 以下为实现细节 ======== */
+
+#define MCP_PP_CAT(a, b) MCP_PP_CAT_I(a, b)
+#define MCP_PP_CAT_I(a, b) a##b
+#define MCP_PP_CAT3(a, b, c) MCP_PP_CAT3_I(a, b, c)
+#define MCP_PP_CAT3_I(a, b, c) a##b##c
+#define MCP_PP_STR(x) MCP_PP_STR_I(x)
+#define MCP_PP_STR_I(x) #x
+#define MCP_PP_UNPACK(...) __VA_ARGS__
+#define MCP_PP_FIRST(a, b) a
+#define MCP_PP_SECOND(a, b) b
+#define MCP_PP_COMMA() ,
+
+#define MCP_PP_NARGS(...) MCP_PP_NARGS_I(__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define MCP_PP_NARGS_I(_1, _2, _3, _4, _5, _6, _7, _8, n, ...) n
+
+/* 对每个元组调用 M，相邻两次之间插入 S() */
+#define MCP_PP_JOIN(M, S, ...) MCP_PP_JOIN_N(MCP_PP_NARGS(__VA_ARGS__), M, S, __VA_ARGS__)
+#define MCP_PP_JOIN_N(n, M, S, ...) MCP_PP_CAT(MCP_PP_JOIN_, n)(M, S, __VA_ARGS__)
+#define MCP_PP_JOIN_1(M, S, a) M a
+#define MCP_PP_JOIN_2(M, S, a, ...) M a S() MCP_PP_JOIN_1(M, S, __VA_ARGS__)
+#define MCP_PP_JOIN_3(M, S, a, ...) M a S() MCP_PP_JOIN_2(M, S, __VA_ARGS__)
+#define MCP_PP_JOIN_4(M, S, a, ...) M a S() MCP_PP_JOIN_3(M, S, __VA_ARGS__)
+#define MCP_PP_JOIN_5(M, S, a, ...) M a S() MCP_PP_JOIN_4(M, S, __VA_ARGS__)
+#define MCP_PP_JOIN_6(M, S, a, ...) M a S() MCP_PP_JOIN_5(M, S, __VA_ARGS__)
+#define MCP_PP_JOIN_7(M, S, a, ...) M a S() MCP_PP_JOIN_6(M, S, __VA_ARGS__)
+#define MCP_PP_JOIN_8(M, S, a, ...) M a S() MCP_PP_JOIN_7(M, S, __VA_ARGS__)
+
+/* 参数组：(有无参数, (参数元组...)) */
+#define MCP_SJ_GROUP_FLAG(group) MCP_PP_FIRST group
+#define MCP_SJ_GROUP(M, S, group) MCP_SJ_GROUP_I(M, S, MCP_PP_UNPACK group)
+#define MCP_SJ_GROUP_I(M, S, ...) MCP_SJ_GROUP_II(M, S, __VA_ARGS__)
+#define MCP_SJ_GROUP_II(M, S, flag, params) MCP_PP_CAT(MCP_SJ_GROUP_, flag)(M, S, params)
+#define MCP_SJ_GROUP_0(M, S, params)
+#define MCP_SJ_GROUP_1(M, S, params) MCP_PP_JOIN(M, S, MCP_PP_UNPACK params)
+
+/* 两组依次展开，都不为空时中间插入 S() */
+#define MCP_SJ_GROUPS(M, S, required, optional)                                     \
+    MCP_SJ_GROUP(M, S, required)                                                    \
+    MCP_PP_CAT3(MCP_SJ_BETWEEN_, MCP_SJ_GROUP_FLAG(required), MCP_SJ_GROUP_FLAG(optional))(S) \
+    MCP_SJ_GROUP(M, S, optional)
+#define MCP_SJ_BETWEEN_00(S)
+#define MCP_SJ_BETWEEN_01(S)
+#define MCP_SJ_BETWEEN_10(S)
+#define MCP_SJ_BETWEEN_11(S) S()
+
+#define MCP_SJ_JSON_COMMA() ","
+
+/* 布尔值的 JSON 文本 */
+#define MCP_SJ_BOOL_JSON(value) MCP_PP_CAT(MCP_SJ_BOOL_JSON_, value)
+#define MCP_SJ_BOOL_JSON_0 "false"
+#define MCP_SJ_BOOL_JSON_1 "true"
+#define MCP_SJ_BOOL_JSON_false "false"
+#define MCP_SJ_BOOL_JSON_true "true"
+
+/* 单个参数的 JSON，键顺序与 mcp_property_to_json 相同 */
+#define MCP_SJ_PROPERTY_JSON(kind, name, value, min, max)                           \
+    "\"" name "\":{\"type\":" MCP_SJ_JSON_##kind(name, value, min, max) "}"
+#define MCP_SJ_JSON_MCP_SK_BOOLEAN(name, value, min, max)                           \
+    "\"boolean\",\"description\":\"" name "\""
+#define MCP_SJ_JSON_MCP_SK_BOOLEAN_DEFAULT(name, value, min, max)                   \
+    "\"boolean\",\"description\":\"" name "\",\"default\":" MCP_SJ_BOOL_JSON(value)
+#define MCP_SJ_JSON_MCP_SK_INTEGER(name, value, min, max)                           \
+    "\"integer\",\"description\":\"" name "\""
+#define MCP_SJ_JSON_MCP_SK_INTEGER_DEFAULT(name, value, min, max)                   \
+    "\"integer\",\"description\":\"" name "\",\"default\":" MCP_PP_STR(value)
+#define MCP_SJ_JSON_MCP_SK_INTEGER_RANGE(name, value, min, max)                     \
+    "\"integer\",\"description\":\"" name "\",\"minimum\":" MCP_PP_STR(min)         \
+    ",\"maximum\":" MCP_PP_STR(max)
+#define MCP_SJ_JSON_MCP_SK_INTEGER_RANGE_DEFAULT(name, value, min, max)             \
+    "\"integer\",\"description\":\"" name "\",\"default\":" MCP_PP_STR(value)       \
+    ",\"minimum\":" MCP_PP_STR(min) ",\"maximum\":" MCP_PP_STR(max)
+#define MCP_SJ_JSON_MCP_SK_STRING(name, value, min, max)                            \
+    "\"string\",\"description\":\"" name "\""
+#define MCP_SJ_JSON_MCP_SK_STRING_DEFAULT(name, value, min, max)                    \
+    "\"string\",\"description\":\"" name "\",\"default\":\"" value "\""
+#define MCP_SJ_JSON_MCP_SK_NUMBER(name, value, min, max)                            \
+    "\"number\",\"description\":\"" name "\""
+#define MCP_SJ_JSON_MCP_SK_NUMBER_DEFAULT(name, value, min, max)                    \
+    "\"number\",\"description\":\"" name "\",\"default\":" MCP_PP_STR(value)
+
+/* required 数组中的参数名 */
+#define MCP_SJ_REQUIRED_NAME(kind, name, value, min, max) "\"" name "\""
+#define MCP_SJ_REQUIRED(required) MCP_PP_CAT(MCP_SJ_REQUIRED_, MCP_SJ_GROUP_FLAG(required))(required)
+#define MCP_SJ_REQUIRED_0(required) ""
+#define MCP_SJ_REQUIRED_1(required)                                                 \
+    ",\"required\":[" MCP_SJ_GROUP(MCP_SJ_REQUIRED_NAME, MCP_SJ_JSON_COMMA, required) "]"
+
+/* 单个参数的 mcp_property_t 初始化 */
+#define MCP_SJ_PROPERTY_INIT(kind, name, value, min, max) MCP_SJ_INIT_##kind(name, value, min, max)
+#define MCP_SJ_INIT(pname, ptype, member, pvalue, with_default, with_range, pmin, pmax) \
+    { .name = (pname), .type = MCP_PROPERTY_TYPE_##ptype, .value = { .member = (pvalue) }, \
+      .has_default_value = (with_default), .has_range = (with_range),              \
+      .min_value = (pmin), .max_value = (pmax) }
+#define MCP_SJ_INIT_MCP_SK_BOOLEAN(name, value, min, max)                           \
+    MCP_SJ_INIT(name, BOOLEAN, bool_val, 0, 0, 0, 0, 0)
+#define MCP_SJ_INIT_MCP_SK_BOOLEAN_DEFAULT(name, value, min, max)                   \
+    MCP_SJ_INIT(name, BOOLEAN, bool_val, value, 1, 0, 0, 0)
+#define MCP_SJ_INIT_MCP_SK_INTEGER(name, value, min, max)                           \
+    MCP_SJ_INIT(name, INTEGER, int_val, 0, 0, 0, 0, 0)
+#define MCP_SJ_INIT_MCP_SK_INTEGER_DEFAULT(name, value, min, max)                   \
+    MCP_SJ_INIT(name, INTEGER, int_val, value, 1, 0, 0, 0)
+#define MCP_SJ_INIT_MCP_SK_INTEGER_RANGE(name, value, min, max)                     \
+    MCP_SJ_INIT(name, INTEGER, int_val, 0, 0, 1, min, max)
+#define MCP_SJ_INIT_MCP_SK_INTEGER_RANGE_DEFAULT(name, value, min, max)             \
+    MCP_SJ_INIT(name, INTEGER, int_val, value, 1, 1, min, max)
+#define MCP_SJ_INIT_MCP_SK_STRING(name, value, min, max)                            \
+    MCP_SJ_INIT(name, STRING, string_val, NULL, 0, 0, 0, 0)
+#define MCP_SJ_INIT_MCP_SK_STRING_DEFAULT(name, value, min, max)                    \
+    MCP_SJ_INIT(name, STRING, string_val, (char*)(value), 1, 0, 0, 0)
+#define MCP_SJ_INIT_MCP_SK_NUMBER(name, value, min, max)                            \
+    MCP_SJ_INIT(name, NUMBER, number_val, 0, 0, 0, 0, 0)
+#define MCP_SJ_INIT_MCP_SK_NUMBER_DEFAULT(name, value, min, max)                    \
+    MCP_SJ_INIT(name, NUMBER, number_val, value, 1, 0, 0, 0)
+
+/* 参数列表：没有参数时不生成数组 */
+#define MCP_SJ_LIST_DEFINE(id, required, optional)                                  \
+    MCP_PP_CAT3(MCP_SJ_LIST_DEFINE_, MCP_SJ_GROUP_FLAG(required), MCP_SJ_GROUP_FLAG(optional))(id, required, optional)
+#define MCP_SJ_LIST_DEFINE_00(id, required, optional)                               \
+    static const mcp_property_list_t mcp_static_properties_##id = { .borrowed = true };
+#define MCP_SJ_LIST_DEFINE_01(id, required, optional) MCP_SJ_LIST_DEFINE_ARRAY(id, required, optional)
+#define MCP_SJ_LIST_DEFINE_10(id, required, optional) MCP_SJ_LIST_DEFINE_ARRAY(id, required, optional)
+#define MCP_SJ_LIST_DEFINE_11(id, required, optional) MCP_SJ_LIST_DEFINE_ARRAY(id, required, optional)
+#define MCP_SJ_LIST_DEFINE_ARRAY(id, required, optional)                            \
+    static const mcp_property_t mcp_static_property_array_##id[] = {                \
+        MCP_SJ_GROUPS(MCP_SJ_PROPERTY_INIT, MCP_PP_COMMA, required, optional)       \
+    };                                                                              \
+    static const mcp_property_list_t mcp_static_properties_##id = {                 \
+        .properties = (mcp_property_t*)mcp_static_property_array_##id,              \
+        .count = sizeof(mcp_static_property_array_##id) / sizeof(mcp_property_t),   \
+        .capacity = sizeof(mcp_static_property_array_##id) / sizeof(mcp_property_t),\
+        .borrowed = true                                                            \
+    };
+
+/* 工具的 tools/list JSON，与 mcp_tool_to_json 的输出一致 */
+#define MCP_SJ_TOOL_JSON(name, description, visibility, required, optional)        \
+    "{\"name\":\"" name "\",\"description\":\"" description "\","                   \
+    "\"inputSchema\":{\"type\":\"object\",\"properties\":{\"properties\":{"         \
+    MCP_SJ_GROUPS(MCP_SJ_PROPERTY_JSON, MCP_SJ_JSON_COMMA, required, optional)      \
+    "}}" MCP_SJ_REQUIRED(required) "}" MCP_PP_SECOND visibility "}"
+
+#define MCP_SJ_TOOL_DEFINE(id, tname, tdesc, callback, visibility, required, optional) \
+    MCP_SJ_LIST_DEFINE(id, required, optional)                                      \
+    static const char mcp_static_json_##id[] =                                      \
+        MCP_SJ_TOOL_JSON(tname, tdesc, visibility, required, optional);             \
+    static mcp_tool_t mcp_static_tool_##id = {                                      \
+        .name = (tname),                                                            \
+        .description = (tdesc),                                                     \
+        .properties = (mcp_property_list_t*)&mcp_static_properties_##id,            \
+        callback,                                                                   \
+        .user_only = MCP_PP_FIRST visibility,                                       \
+        .max_concurrency = 1,                                                       \
+        .timeout_ms = MCP_DEFAULT_TOOL_TIMEOUT_MS,                                  \
+        .json_cache = (char*)mcp_static_json_##id,                                  \
+        .json_cache_length = sizeof(mcp_static_json_##id) - 1,                      \
+        .static_schema = true                                                       \
+    };
+
+#define MCP_SJ_TOOL_REF(id, tname, tdesc, callback, visibility, required, optional) \
+    &mcp_static_tool_##id,
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MCP_STATIC_TOOL_H */
@@ -5,18 +5,41 @@
 
 #include "mcp_tool.h"
 #include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
+#include "../cjson/linx_json_arena.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <pthread.h>
+#include "../cjson/cJSON_Utils.h"
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_MCP);
+
+/* 结果缓存条目 */
+typedef struct {
+    uint64_t hash;          // 缓存键哈希，先比较哈希再比较键
+    char* key;              // 规范化的参数JSON，NULL 表示空条目
+    char* result;           // 结果JSON
+    uint64_t expires_ms;    // 过期时刻（单调时钟）
+} mcp_tool_result_entry_t;
+
+/* 调用结果缓存；异步工具在多个工作线程中读写，使用独立的锁 */
+struct mcp_tool_result_cache {
+    pthread_mutex_t mutex;
+    uint32_t ttl_ms;
+    mcp_tool_result_entry_t entries[MCP_TOOL_RESULT_CACHE_SIZE];
+};
 
 /**
- * 创建工具
+ * 创建工具（两种回调恰好提供一种）
  */
-mcp_tool_t* mcp_tool_create(const char* name, const char* description,
-                           mcp_property_list_t* properties, mcp_tool_callback_t callback) {
+static mcp_tool_t* mcp_tool_create_internal(const char* name, const char* description,
+                                            mcp_property_list_t* properties, mcp_tool_callback_t callback,
+                                            mcp_tool_args_callback_t args_callback) {
     // 检查参数有效性
-    if (!name || !description || !callback) {
-        LOG_ERROR("Invalid parameters: name=%p, description=%p, callback=%p", name, description, callback);
+    if (!name || !description || !callback == !args_callback) {
+        LOG_ERROR("Invalid parameters: name=%p, description=%p, callback=%p", name, description,
+                  callback ? (void*)callback : (void*)args_callback);
         return NULL;
     }
     
@@ -27,27 +50,29 @@ mcp_tool_t* mcp_tool_create(const char* name, const char* description,
     }
     
     // 检查名称和描述长度
-    if (strlen(name) >= MCP_MAX_NAME_LENGTH || strlen(description) >= MCP_MAX_DESCRIPTION_LENGTH) {
+    size_t name_length = strlen(name);
+    size_t description_length = strlen(description);
+    if (name_length >= MCP_MAX_NAME_LENGTH || description_length >= MCP_MAX_DESCRIPTION_LENGTH) {
         LOG_ERROR("Tool name or description too long: name_len=%zu, desc_len=%zu", 
-                  strlen(name), strlen(description));
+                  name_length, description_length);
         return NULL;
     }
     
     LOG_INFO("Creating tool: '%s'", name);
     
-    // 分配内存
-    mcp_tool_t* tool = malloc(sizeof(mcp_tool_t));
+    // 名称和描述按实际长度紧跟在结构体后面，一次分配
+    mcp_tool_t* tool = LINX_MALLOC(sizeof(mcp_tool_t) + name_length + description_length + 2);
     if (!tool) {
         LOG_ERROR("Failed to allocate memory for tool '%s'", name);
         return NULL;
     }
     
     // 初始化工具
-    strncpy(tool->name, name, MCP_MAX_NAME_LENGTH - 1);
-    tool->name[MCP_MAX_NAME_LENGTH - 1] = '\0';
-    
-    strncpy(tool->description, description, MCP_MAX_DESCRIPTION_LENGTH - 1);
-    tool->description[MCP_MAX_DESCRIPTION_LENGTH - 1] = '\0';
+    char* strings = (char*)(tool + 1);
+    memcpy(strings, name, name_length + 1);
+    memcpy(strings + name_length + 1, description, description_length + 1);
+    tool->name = strings;
+    tool->description = strings + name_length + 1;
     
     // 如果没有提供属性列表，创建一个空的属性列表
     if (properties == NULL) {
@@ -55,7 +80,7 @@ mcp_tool_t* mcp_tool_create(const char* name, const char* description,
         tool->properties = mcp_property_list_create();
         if (!tool->properties) {
             LOG_ERROR("Failed to create property list for tool '%s'", name);
-            free(tool);
+            LINX_FREE(tool);
             return NULL;
         }
     } else {
@@ -64,23 +89,58 @@ mcp_tool_t* mcp_tool_create(const char* name, const char* description,
         tool->properties = mcp_property_list_clone(properties);
         if (!tool->properties) {
             LOG_ERROR("Failed to clone property list for tool '%s'", name);
-            free(tool);
+            LINX_FREE(tool);
             return NULL;
         }
     }
     
     tool->callback = callback;
+    tool->args_callback = args_callback;
     tool->user_only = false;
+    tool->async = false;
+    tool->max_concurrency = 1;
+    tool->timeout_ms = MCP_DEFAULT_TOOL_TIMEOUT_MS;
+    tool->active_calls = 0;
+    tool->retired = false;
+    tool->result_cache = NULL;
+    tool->json_cache = NULL;
+    tool->json_cache_length = 0;
+    tool->static_schema = false;
+    tool->stats = NULL;
     
     LOG_INFO("Tool '%s' created successfully", name);
     return tool;
 }
 
+/**
+ * 创建工具
+ */
+mcp_tool_t* mcp_tool_create(const char* name, const char* description,
+                           mcp_property_list_t* properties, mcp_tool_callback_t callback) {
+    return mcp_tool_create_internal(name, description, properties, callback, NULL);
+}
+
+/**
+ * 创建接收参数视图的工具
+ */
+mcp_tool_t* mcp_tool_create_with_args(const char* name, const char* description,
+                                      mcp_property_list_t* properties, mcp_tool_args_callback_t args_callback) {
+    return mcp_tool_create_internal(name, description, properties, NULL, args_callback);
+}
+
 /**
  * 销毁工具并释放内存
  */
 void mcp_tool_destroy(mcp_tool_t* tool) {
-    if (tool) {
+    if (tool && tool->static_schema) {
+        // 静态工具恢复到刚声明时的状态，可以再次注册
+        LOG_INFO("Releasing static tool: '%s'", tool->name);
+        mcp_tool_set_result_cache(tool, 0);
+        LINX_FREE(tool->stats);
+        tool->stats = NULL;
+        tool->active_calls = 0;
+        tool->retired = false;
+    } else if (tool) {
         LOG_INFO("Destroying tool: '%s'", tool->name);
         
         // 销毁属性列表
@@ -90,14 +150,24 @@ void mcp_tool_destroy(mcp_tool_t* tool) {
             tool->properties = NULL;  // 防止多次释放
         }
         
+        if (tool->json_cache) {
+            cJSON_free(tool->json_cache);
+            tool->json_cache = NULL;
+        }
+        
+        mcp_tool_set_result_cache(tool, 0);
+        LINX_FREE(tool->stats);
+        tool->stats = NULL;
+        
         // 清理工具状态
-        memset(tool->name, 0, sizeof(tool->name));
-        memset(tool->description, 0, sizeof(tool->description));
+        tool->name = NULL;
+        tool->description = NULL;
         tool->callback = NULL;
+        tool->args_callback = NULL;
         tool->user_only = false;
         
         // 释放工具本身
-        free(tool);
+        LINX_FREE(tool);
         tool = NULL;  // 防止野指针
         
         LOG_DEBUG("Tool destroyed successfully");
@@ -110,7 +180,17 @@ void mcp_tool_destroy(mcp_tool_t* tool) {
  * 设置工具是否仅限用户使用
  */
 void mcp_tool_set_user_only(mcp_tool_t* tool, bool user_only) {
-    if (tool) {
+    if (tool && tool->static_schema) {
+        if (tool->user_only != user_only) {
+            LOG_WARN("Visibility of static tool '%s' is fixed at compile time", tool->name);
+        }
+    } else if (tool) {
+        if (tool->user_only != user_only && tool->json_cache) {
+            // 注解随之变化，缓存失效
+            cJSON_free(tool->json_cache);
+            tool->json_cache = NULL;
+            tool->json_cache_length = 0;
+        }
         tool->user_only = user_only;
     }
 }
@@ -125,6 +205,296 @@ bool mcp_tool_is_user_only(const mcp_tool_t* tool) {
     return tool->user_only;
 }
 
+/**
+ * 设置工具为异步执行
+ */
+void mcp_tool_set_async(mcp_tool_t* tool, bool async, int max_concurrency, uint32_t timeout_ms) {
+    if (tool) {
+        tool->async = async;
+        tool->max_concurrency = max_concurrency > 0 ? max_concurrency : 1;
+        tool->timeout_ms = timeout_ms > 0 ? timeout_ms : MCP_DEFAULT_TOOL_TIMEOUT_MS;
+    }
+}
+
+/**
+ * 检查工具是否异步执行
+ */
+bool mcp_tool_is_async(const mcp_tool_t* tool) {
+    if (!tool) {
+        return false;
+    }
+    return tool->async;
+}
+
+/**
+ * 释放缓存条目内容（调用者持有缓存锁）
+ */
+static void mcp_tool_result_entry_clear(mcp_tool_result_entry_t* entry) {
+    LINX_FREE(entry->key);
+    LINX_FREE(entry->result);
+    memset(entry, 0, sizeof(*entry));
+}
+
+/**
+ * 启用或关闭工具调用结果缓存
+ */
+bool mcp_tool_set_result_cache(mcp_tool_t* tool, uint32_t ttl_ms) {
+    if (!tool) {
+        return false;
+    }
+    
+    if (ttl_ms == 0) {
+        if (tool->result_cache) {
+            for (size_t i = 0; i < MCP_TOOL_RESULT_CACHE_SIZE; i++) {
+                mcp_tool_result_entry_clear(&tool->result_cache->entries[i]);
+            }
+            pthread_mutex_destroy(&tool->result_cache->mutex);
+            LINX_FREE(tool->result_cache);
+            tool->result_cache = NULL;
+        }
+        return true;
+    }
+    
+    if (!tool->result_cache) {
+        tool->result_cache = LINX_CALLOC(1, sizeof(struct mcp_tool_result_cache));
+        if (!tool->result_cache) {
+            LOG_ERROR("Failed to allocate result cache for tool '%s'", tool->name);
+            return false;
+        }
+        pthread_mutex_init(&tool->result_cache->mutex, NULL);
+    }
+    tool->result_cache->ttl_ms = ttl_ms;
+    return true;
+}
+
+/**
+ * 清空工具的结果缓存
+ */
+void mcp_tool_invalidate_result_cache(mcp_tool_t* tool) {
+    if (!tool || !tool->result_cache) {
+        return;
+    }
+    pthread_mutex_lock(&tool->result_cache->mutex);
+    for (size_t i = 0; i < MCP_TOOL_RESULT_CACHE_SIZE; i++) {
+        mcp_tool_result_entry_clear(&tool->result_cache->entries[i]);
+    }
+    pthread_mutex_unlock(&tool->result_cache->mutex);
+}
+
+/**
+ * 对象成员按键名递归排序，使键顺序不同的相同参数得到相同的缓存键
+ */
+static void mcp_sort_json_recursive(cJSON* json) {
+    if (cJSON_IsObject(json)) {
+        cJSONUtils_SortObjectCaseSensitive(json);
+    }
+    for (cJSON* child = json->child; child; child = child->next) {
+        mcp_sort_json_recursive(child);
+    }
+}
+
+/**
+ * FNV-1a 64位哈希
+ */
+static uint64_t mcp_cache_hash(const char* key) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (const unsigned char* p = (const unsigned char*)key; *p; p++) {
+        hash ^= *p;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/**
+ * 生成结果缓存键
+ */
+char* mcp_tool_result_cache_key(const mcp_tool_t* tool, const cJSON* arguments) {
+    if (!tool || !tool->result_cache) {
+        return NULL;
+    }
+    if (!arguments || (cJSON_IsObject(arguments) && !arguments->child)) {
+        return mcp_strdup("{}");
+    }
+    
+    // 键需要比消息活得久，使用普通堆内存
+    bool arena_suspended = linx_json_arena_suspend();
+    char* key = NULL;
+    cJSON* normalized = cJSON_Duplicate(arguments, true);
+    if (normalized) {
+        mcp_sort_json_recursive(normalized);
+        key = mcp_json_to_string(normalized);
+        cJSON_Delete(normalized);
+    }
+    linx_json_arena_resume(arena_suspended);
+    return key;
+}
+
+/**
+ * 查找未过期的缓存结果
+ */
+char* mcp_tool_result_cache_lookup(mcp_tool_t* tool, const char* key) {
+    if (!tool || !tool->result_cache || !key) {
+        return NULL;
+    }
+    
+    struct mcp_tool_result_cache* cache = tool->result_cache;
+    uint64_t hash = mcp_cache_hash(key);
+    uint64_t now = mcp_time_now_ms();
+    char* result = NULL;
+    
+    pthread_mutex_lock(&cache->mutex);
+    for (size_t i = 0; i < MCP_TOOL_RESULT_CACHE_SIZE; i++) {
+        mcp_tool_result_entry_t* entry = &cache->entries[i];
+        if (!entry->key || entry->hash != hash || strcmp(entry->key, key) != 0) {
+            continue;
+        }
+        if (entry->expires_ms > now) {
+            result = mcp_strdup(entry->result);
+        } else {
+            mcp_tool_result_entry_clear(entry);
+        }
+        break;
+    }
+    pthread_mutex_unlock(&cache->mutex);
+    
+    if (result) {
+        LOG_DEBUG("Tool '%s' answered from result cache", tool->name);
+    }
+    return result;
+}
+
+/**
+ * 保存调用结果
+ */
+void mcp_tool_result_cache_store(mcp_tool_t* tool, const char* key, const char* result) {
+    if (!tool || !tool->result_cache || !key || !result) {
+        return;
+    }
+    
+    char* key_copy = mcp_strdup(key);
+    char* result_copy = mcp_strdup(result);
+    if (!key_copy || !result_copy) {
+        LINX_FREE(key_copy);
+        LINX_FREE(result_copy);
+        return;
+    }
+    
+    struct mcp_tool_result_cache* cache = tool->result_cache;
+    uint64_t hash = mcp_cache_hash(key);
+    uint64_t now = mcp_time_now_ms();
+    
+    pthread_mutex_lock(&cache->mutex);
+    // 同键条目直接覆盖，否则用空条目或最早到期的条目
+    mcp_tool_result_entry_t* slot = &cache->entries[0];
+    for (size_t i = 0; i < MCP_TOOL_RESULT_CACHE_SIZE; i++) {
+        mcp_tool_result_entry_t* entry = &cache->entries[i];
+        if (entry->key && entry->hash == hash && strcmp(entry->key, key) == 0) {
+            slot = entry;
+            break;
+        }
+        if (slot->key && (!entry->key || entry->expires_ms < slot->expires_ms)) {
+            slot = entry;
+        }
+    }
+    mcp_tool_result_entry_clear(slot);
+    slot->hash = hash;
+    slot->key = key_copy;
+    slot->result = result_copy;
+    slot->expires_ms = now + cache->ttl_ms;
+    pthread_mutex_unlock(&cache->mutex);
+}
+
+/**
+ * 样本所在的桶：0 单独一桶，其余按最高有效位
+ */
+static size_t mcp_tool_histogram_bucket(uint32_t value) {
+    return value == 0 ? 0 : (size_t)(32 - __builtin_clz(value));
+}
+
+/**
+ * 记录一个调用剖析样本
+ */
+void mcp_tool_histogram_record(mcp_tool_histogram_t* histogram, uint32_t value) {
+    if (!histogram) {
+        return;
+    }
+    __atomic_fetch_add(&histogram->buckets[mcp_tool_histogram_bucket(value)], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&histogram->sum, value, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&histogram->count, 1, __ATOMIC_RELAXED);
+    
+    uint32_t seen = __atomic_load_n(&histogram->min, __ATOMIC_RELAXED);
+    while (value < seen && !__atomic_compare_exchange_n(&histogram->min, &seen, value, true,
+                                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+    seen = __atomic_load_n(&histogram->max, __ATOMIC_RELAXED);
+    while (value > seen && !__atomic_compare_exchange_n(&histogram->max, &seen, value, true,
+                                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+/**
+ * 计算调用剖析直方图的分位数
+ */
+uint32_t mcp_tool_histogram_percentile(const mcp_tool_histogram_t* histogram, double percentile) {
+    if (!histogram || histogram->count == 0) {
+        return 0;
+    }
+    if (percentile < 0) {
+        percentile = 0;
+    } else if (percentile > 100) {
+        percentile = 100;
+    }
+    
+    uint64_t total = 0;
+    for (size_t b = 0; b < MCP_TOOL_HISTOGRAM_BUCKETS; b++) {
+        total += histogram->buckets[b];
+    }
+    uint64_t rank = (uint64_t)(percentile / 100.0 * (double)total + 0.5);
+    if (rank == 0) {
+        rank = 1;
+    }
+    
+    uint64_t seen = 0;
+    for (size_t b = 0; b < MCP_TOOL_HISTOGRAM_BUCKETS; b++) {
+        seen += histogram->buckets[b];
+        if (seen >= rank) {
+            uint32_t upper = b == 0 ? 0 : (b >= 32 ? UINT32_MAX : (uint32_t)((1ull << b) - 1));
+            return upper < histogram->max ? upper : histogram->max;
+        }
+    }
+    return histogram->max;
+}
+
+/**
+ * 复制工具的调用统计
+ */
+bool mcp_tool_get_stats(const mcp_tool_t* tool, mcp_tool_stats_t* stats) {
+    if (!stats) {
+        return false;
+    }
+    memset(stats, 0, sizeof(*stats));
+    const mcp_tool_stats_t* src = tool ? __atomic_load_n(&tool->stats, __ATOMIC_ACQUIRE) : NULL;
+    if (!src) {
+        return false;
+    }
+    stats->calls = __atomic_load_n(&src->calls, __ATOMIC_RELAXED);
+    stats->cache_hits = __atomic_load_n(&src->cache_hits, __ATOMIC_RELAXED);
+    stats->errors = __atomic_load_n(&src->errors, __ATOMIC_RELAXED);
+    stats->slow = __atomic_load_n(&src->slow, __ATOMIC_RELAXED);
+    for (size_t i = 0; i < MCP_TOOL_STAGE_COUNT; i++) {
+        const mcp_tool_histogram_t* h = &src->stages[i];
+        mcp_tool_histogram_t* dst = &stats->stages[i];
+        dst->count = __atomic_load_n(&h->count, __ATOMIC_RELAXED);
+        dst->sum = __atomic_load_n(&h->sum, __ATOMIC_RELAXED);
+        dst->min = __atomic_load_n(&h->min, __ATOMIC_RELAXED);
+        dst->max = __atomic_load_n(&h->max, __ATOMIC_RELAXED);
+        for (size_t b = 0; b < MCP_TOOL_HISTOGRAM_BUCKETS; b++) {
+            dst->buckets[b] = __atomic_load_n(&h->buckets[b], __ATOMIC_RELAXED);
+        }
+    }
+    return true;
+}
+
 /**
  * 将工具转换为JSON字符串
  * @param tool 工具指针
@@ -156,7 +526,7 @@ char* mcp_tool_to_json(const mcp_tool_t* tool) {
             if (properties_json) {
                 cJSON_AddItemToObject(input_schema, "properties", properties_json);
             }
-            free(properties_json_str);
+            LINX_FREE(properties_json_str);
         }
         
         // 添加必需属性
@@ -168,7 +538,7 @@ char* mcp_tool_to_json(const mcp_tool_t* tool) {
             } else {
                 cJSON_Delete(required_json);
             }
-            free(required_json_str);
+            LINX_FREE(required_json_str);
         }
     }
     
@@ -184,12 +554,57 @@ char* mcp_tool_to_json(const mcp_tool_t* tool) {
     }
     
     // 转换为字符串
-    char* json_str = cJSON_PrintUnformatted(json);
+    char* json_str = mcp_json_to_string(json);
     cJSON_Delete(json);
     
     return json_str;
 }
 
+/**
+ * 获取缓存的工具JSON
+ */
+const char* mcp_tool_get_cached_json(mcp_tool_t* tool, size_t* length) {
+    if (!tool) {
+        return NULL;
+    }
+    
+    if (!tool->json_cache) {
+        // 缓存跨消息存在，不能分配在竞技场里
+        bool arena_suspended = linx_json_arena_suspend();
+        tool->json_cache = mcp_tool_to_json(tool);
+        linx_json_arena_resume(arena_suspended);
+        tool->json_cache_length = tool->json_cache ? strlen(tool->json_cache) : 0;
+    }
+    
+    if (length) {
+        *length = tool->json_cache_length;
+    }
+    return tool->json_cache;
+}
+
+/**
+ * 核对静态工具的编译期JSON
+ */
+bool mcp_tool_check_static(const mcp_tool_t* tool) {
+    if (!tool || !tool->static_schema || !tool->json_cache) {
+        return false;
+    }
+    
+    char* runtime_json = mcp_tool_to_json(tool);
+    cJSON* expected = runtime_json ? cJSON_Parse(runtime_json) : NULL;
+    cJSON* actual = cJSON_ParseWithLength(tool->json_cache, tool->json_cache_length);
+    bool same = expected && actual && cJSON_Compare(expected, actual, true);
+    if (!same) {
+        LOG_ERROR("Static tool '%s' JSON differs from its schema: %s", tool->name, tool->json_cache);
+    }
+    cJSON_Delete(expected);
+    cJSON_Delete(actual);
+    if (runtime_json) {
+        cJSON_free(runtime_json);
+    }
+    return same;
+}
+
 /**
  * 调用工具并获取结果
  */
@@ -244,7 +659,14 @@ char* mcp_tool_call(const mcp_tool_t* tool, const mcp_property_list_t* propertie
             if (result.value.image_val) {
                 cJSON* image_json = cJSON_CreateObject();
                 cJSON_AddStringToObject(image_json, "type", "image");
-                cJSON_AddStringToObject(image_json, "data", result.value.image_val->encoded_data);
+                if (result.value.image_val->encoded_data) {
+                    cJSON_AddStringToObject(image_json, "data", result.value.image_val->encoded_data);
+                } else {
+                    char* encoded = mcp_base64_encode(result.value.image_val->raw_data,
+                                                      result.value.image_val->raw_length);
+                    cJSON_AddStringToObject(image_json, "data", encoded ? encoded : "");
+                    LINX_FREE(encoded);
+                }
                 cJSON_AddStringToObject(image_json, "mimeType", result.value.image_val->mime_type);
                 cJSON_AddItemToObject(json, "result", image_json);
             } else {
@@ -258,7 +680,7 @@ char* mcp_tool_call(const mcp_tool_t* tool, const mcp_property_list_t* propertie
     }
     
     // 转换为字符串
-    char* json_str = cJSON_PrintUnformatted(json);
+    char* json_str = mcp_json_to_string(json);
     cJSON_Delete(json);
     
     // 清理返回值
@@ -336,7 +758,7 @@ void mcp_return_value_cleanup(mcp_return_value_t* ret_val, mcp_return_type_t typ
     switch (type) {
         case MCP_RETURN_TYPE_STRING:
             if (ret_val->value.string_val) {
-                free((void*)ret_val->value.string_val);
+                LINX_FREE((void*)ret_val->value.string_val);
                 ret_val->value.string_val = NULL;
             }
             break;
@@ -350,13 +772,7 @@ void mcp_return_value_cleanup(mcp_return_value_t* ret_val, mcp_return_type_t typ
             
         case MCP_RETURN_TYPE_IMAGE:
             if (ret_val->value.image_val) {
-                if (ret_val->value.image_val->encoded_data) {
-                    free(ret_val->value.image_val->encoded_data);
-                }
-                if (ret_val->value.image_val->mime_type) {
-                    free(ret_val->value.image_val->mime_type);
-                }
-                free(ret_val->value.image_val);
+                mcp_image_content_destroy(ret_val->value.image_val);
                 ret_val->value.image_val = NULL;
             }
             break;
@@ -14,13 +14,58 @@
 extern "C" {
 #endif
 
+/* 每个工具缓存的结果数（按参数区分），满时替换最早到期的一条 */
+#define MCP_TOOL_RESULT_CACHE_SIZE 4
+
+/* 调用剖析直方图的桶数：桶 0 为 0，桶 i 为 [2^(i-1), 2^i)，覆盖完整的 uint32 范围 */
+#define MCP_TOOL_HISTOGRAM_BUCKETS 33
+
+/* 调用剖析直方图（记录端只通过原子操作访问） */
+typedef struct {
+    uint64_t count;                                     // 样本数
+    uint64_t sum;                                       // 样本总和
+    uint32_t min;                                       // 最小值（初始为 UINT32_MAX，count 为 0 时无意义）
+    uint32_t max;                                       // 最大值
+    uint32_t buckets[MCP_TOOL_HISTOGRAM_BUCKETS];
+} mcp_tool_histogram_t;
+
+/* 调用剖析的各阶段 */
+typedef enum {
+    MCP_TOOL_STAGE_ARGS = 0,                            // 参数校验与转换（微秒）
+    MCP_TOOL_STAGE_CALLBACK,                            // 工具回调（微秒，含推送分块）
+    MCP_TOOL_STAGE_SERIALIZE,                           // 返回值序列化与发送（微秒）
+    MCP_TOOL_STAGE_REPLY_BYTES,                         // 响应中 result 的字节数
+    MCP_TOOL_STAGE_COUNT
+} mcp_tool_stage_t;
+
+/* 工具的调用统计（开启剖析后首次调用时创建，见 mcp_server_set_tool_profiling） */
+typedef struct mcp_tool_stats {
+    uint64_t calls;                                     // 执行回调的次数
+    uint64_t cache_hits;                                // 由结果缓存直接回复的次数
+    uint64_t errors;                                    // 参数无效、被拒绝或返回值无法序列化的次数
+    uint64_t slow;                                      // 超过慢调用阈值的次数
+    mcp_tool_histogram_t stages[MCP_TOOL_STAGE_COUNT];
+} mcp_tool_stats_t;
+
 /* 工具结构体 */
 typedef struct mcp_tool {
-    char name[MCP_MAX_NAME_LENGTH];                     // 工具名称
-    char description[MCP_MAX_DESCRIPTION_LENGTH];       // 工具描述
+    const char* name;                                   // 工具名称（与描述一起存放在工具的同一块内存中）
+    const char* description;                            // 工具描述
     mcp_property_list_t* properties;                    // 工具参数列表
-    mcp_tool_callback_t callback;                       // 工具回调函数
+    mcp_tool_callback_t callback;                       // 工具回调函数（属性列表形式）
+    mcp_tool_args_callback_t args_callback;             // 工具回调函数（参数视图形式），与 callback 二选一
     bool user_only;                                     // 是否仅限用户使用
+    bool async;                                         // 是否在服务器工作线程池中执行
+    int max_concurrency;                                // 异步调用的最大并发数（含排队中的调用）
+    uint32_t timeout_ms;                                // 异步调用超时（毫秒），超时后直接回复错误
+    int active_calls;                                   // 排队或执行中的异步调用数（由服务器维护）
+    bool retired;                                       // 已从服务器移除，最后一个异步调用结束时销毁
+    struct mcp_tool_result_cache* result_cache;         // 调用结果缓存，未启用时为NULL
+    char* json_cache;                                   // 序列化后的工具描述（tools/list 用，惰性生成）
+    size_t json_cache_length;                           // json_cache 的字节数
+    bool static_schema;                                 // 编译期声明的工具（mcp_static_tool.h）：名称、描述、
+                                                        // 参数和 JSON 都是常量，工具本身也不在堆上
+    mcp_tool_stats_t* stats;                            // 调用统计，未开启剖析或尚未调用时为NULL（由服务器维护）
 } mcp_tool_t;
 
 /* 工具操作函数 */
@@ -36,14 +81,29 @@ typedef struct mcp_tool {
 mcp_tool_t* mcp_tool_create(const char* name, const char* description, 
                            mcp_property_list_t* properties, mcp_tool_callback_t callback);
 
+/**
+ * 创建接收参数视图的工具
+ * 服务器按 properties 校验一次 arguments 后直接传入只读视图，不再逐个转换为属性；
+ * 这类工具只能经服务器调用，mcp_tool_call 不适用
+ * @param name 工具名称
+ * @param description 工具描述
+ * @param properties 工具参数声明
+ * @param args_callback 工具回调函数
+ * @return 创建的工具指针，失败返回NULL
+ */
+mcp_tool_t* mcp_tool_create_with_args(const char* name, const char* description,
+                                      mcp_property_list_t* properties, mcp_tool_args_callback_t args_callback);
+
 /**
  * 销毁工具并释放内存
+ * 静态工具只清理运行时状态（结果缓存、调用计数），常量部分不释放
  * @param tool 工具指针
  */
 void mcp_tool_destroy(mcp_tool_t* tool);
 
 /**
  * 设置工具是否仅限用户使用
+ * 静态工具的可见性在声明时确定，这里不能修改
  * @param tool 工具指针
  * @param user_only 是否仅限用户使用
  */
@@ -56,6 +116,88 @@ void mcp_tool_set_user_only(mcp_tool_t* tool, bool user_only);
  */
 bool mcp_tool_is_user_only(const mcp_tool_t* tool);
 
+/**
+ * 设置工具为异步执行
+ * 异步工具的调用交给服务器工作线程池执行，不阻塞收消息的线程；
+ * 服务器未启动工作线程池时仍同步执行
+ * @param tool 工具指针
+ * @param async 是否异步执行
+ * @param max_concurrency 最大并发调用数，小于等于0时为1；超出时立即回复错误
+ * @param timeout_ms 超时时间（毫秒），0 表示 MCP_DEFAULT_TOOL_TIMEOUT_MS
+ */
+void mcp_tool_set_async(mcp_tool_t* tool, bool async, int max_concurrency, uint32_t timeout_ms);
+
+/**
+ * 检查工具是否异步执行
+ * @param tool 工具指针
+ * @return 异步执行返回true，否则返回false
+ */
+bool mcp_tool_is_async(const mcp_tool_t* tool);
+
+/**
+ * 启用或关闭工具调用结果缓存
+ * 适用于幂等的只读工具（设备状态、电量等）：相同参数在 ttl_ms 内再次调用时
+ * 服务器直接回复缓存的结果，不执行回调；图像结果不缓存
+ * @param tool 工具指针
+ * @param ttl_ms 缓存有效期（毫秒），0 表示关闭并清空缓存
+ * @return 成功返回true，内存不足返回false
+ * @note 应在工具注册前或没有调用进行时设置
+ */
+bool mcp_tool_set_result_cache(mcp_tool_t* tool, uint32_t ttl_ms);
+
+/**
+ * 清空工具的结果缓存（工具对应的状态发生变化时调用）
+ * @param tool 工具指针
+ */
+void mcp_tool_invalidate_result_cache(mcp_tool_t* tool);
+
+/**
+ * 生成结果缓存键：参数按键名递归排序后的紧凑JSON
+ * @param tool 工具指针
+ * @param arguments 调用参数，可以为NULL
+ * @return 缓存键（调用者用 linx_free 释放），工具未启用缓存或失败时返回NULL
+ */
+char* mcp_tool_result_cache_key(const mcp_tool_t* tool, const cJSON* arguments);
+
+/**
+ * 查找未过期的缓存结果
+ * @param tool 工具指针
+ * @param key mcp_tool_result_cache_key 生成的缓存键
+ * @return 结果JSON的副本（调用者用 linx_free 释放），未命中返回NULL
+ */
+char* mcp_tool_result_cache_lookup(mcp_tool_t* tool, const char* key);
+
+/**
+ * 保存调用结果
+ * @param tool 工具指针
+ * @param key 缓存键
+ * @param result 结果JSON（tools/call 响应的 result 部分），会被复制
+ */
+void mcp_tool_result_cache_store(mcp_tool_t* tool, const char* key, const char* result);
+
+/**
+ * 记录一个调用剖析样本（无锁，可在多个工作线程中并发调用）
+ * @param histogram 直方图
+ * @param value 样本值
+ */
+void mcp_tool_histogram_record(mcp_tool_histogram_t* histogram, uint32_t value);
+
+/**
+ * 计算调用剖析直方图的分位数
+ * @param histogram 直方图
+ * @param percentile 分位（0-100）
+ * @return 所在桶的上界（不超过 max），没有样本时返回0
+ */
+uint32_t mcp_tool_histogram_percentile(const mcp_tool_histogram_t* histogram, double percentile);
+
+/**
+ * 复制工具的调用统计（逐项原子读取）
+ * @param tool 工具指针
+ * @param stats 输出
+ * @return 工具有调用统计返回true，否则清零 stats 并返回false
+ */
+bool mcp_tool_get_stats(const mcp_tool_t* tool, mcp_tool_stats_t* stats);
+
 /**
  * 将工具转换为JSON字符串
  * @param tool 工具指针
@@ -63,6 +205,23 @@ bool mcp_tool_is_user_only(const mcp_tool_t* tool);
  */
 char* mcp_tool_to_json(const mcp_tool_t* tool);
 
+/**
+ * 获取缓存的工具JSON（首次调用时生成）
+ * 工具描述在注册后视为不变；mcp_tool_set_user_only 会使缓存失效
+ * @param tool 工具指针
+ * @param length 输出JSON字节数，可以为NULL
+ * @return JSON字符串，由工具持有，工具销毁前有效；失败返回NULL
+ */
+const char* mcp_tool_get_cached_json(mcp_tool_t* tool, size_t* length);
+
+/**
+ * 核对静态工具的编译期 JSON 与按其参数列表运行时生成的 JSON 是否等价
+ * 用于测试或调试构建，发现声明中未转义的字符、非法的默认值字面量等问题
+ * @param tool 静态工具指针
+ * @return 等价返回true；不是静态工具、JSON 无法解析或内容不同返回false
+ */
+bool mcp_tool_check_static(const mcp_tool_t* tool);
+
 /**
  * 调用工具并获取结果
  * @param tool 工具指针
@@ -19,7 +19,8 @@ extern "C" {
 typedef enum {
     MCP_PROPERTY_TYPE_BOOLEAN,  // 布尔类型属性
     MCP_PROPERTY_TYPE_INTEGER,  // 整数类型属性
-    MCP_PROPERTY_TYPE_STRING    // 字符串类型属性
+    MCP_PROPERTY_TYPE_STRING,   // 字符串类型属性
+    MCP_PROPERTY_TYPE_NUMBER    // 浮点数类型属性（JSON Schema 的 number）
 } mcp_property_type_t;
 
 /* 返回值类型枚举 */
@@ -36,6 +37,7 @@ typedef union {
     bool bool_val;      // 布尔值
     int int_val;        // 整数值
     char* string_val;   // 字符串值
+    double number_val;  // 浮点数值
 } mcp_property_value_t;
 
 /* 带类型信息的返回值结构体 */
@@ -56,10 +58,14 @@ struct mcp_property_list;   // MCP属性列表结构体
 struct mcp_tool;            // MCP工具结构体
 struct mcp_server;          // MCP服务器结构体
 struct mcp_image_content;   // MCP图像内容结构体
+struct mcp_arguments;       // MCP工具调用参数视图
 
 /* 工具回调函数类型 */
 typedef mcp_return_value_t (*mcp_tool_callback_t)(const struct mcp_property_list* properties);
 
+/* 工具回调函数类型（直接读取已校验的 arguments，不做属性转换） */
+typedef mcp_return_value_t (*mcp_tool_args_callback_t)(const struct mcp_arguments* args);
+
 /* 能力配置回调函数类型 */
 /* 摄像头解释URL设置回调函数类型 */
 typedef void (*mcp_camera_set_explain_url_callback_t)(const char* url, const char* token);
@@ -73,9 +79,10 @@ typedef struct {
 /* 常量定义 */
 #define MCP_MAX_NAME_LENGTH 256         // 最大名称长度
 #define MCP_MAX_DESCRIPTION_LENGTH 1024 // 最大描述长度
-#define MCP_MAX_TOOLS 64                // 最大工具数量
+#define MCP_MAX_TOOLS 64                // 工具表初始容量（超出后自动扩容）
 #define MCP_MAX_PROPERTIES 32           // 最大属性数量
 #define MCP_MAX_URL_LENGTH 512          // 最大URL长度
+#define MCP_DEFAULT_TOOL_TIMEOUT_MS 15000 // 异步工具默认超时（毫秒）
 
 #ifdef __cplusplus
 }
@@ -7,9 +7,24 @@
  */
 #include "mcp_utils.h"
 #include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
+#include "../cjson/linx_json_writer.h"
+#include <limits.h>        // INT_MAX
 #include <stdlib.h>        // 内存管理函数
 #include <string.h>        // 字符串操作函数
 #include <stdio.h>         // 标准输入输出函数
+#include <time.h>          // 单调时钟
+
+// Base64 向量编码按工具链的目标指令集选择；NEON 的 64 字节查表 (vqtbl4q) 只有 AArch64 有
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MCP_BASE64_NEON 1
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#define MCP_BASE64_SSSE3 1
+#endif
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_MCP);
 
 /**
  * @brief Base64编码字符表
@@ -18,6 +33,124 @@
  */
 static const char base64_chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
+/**
+ * @brief Base64解码表：字符到6位值加1，0 为非字母表字符
+ */
+static const unsigned char base64_values[256] = {
+    ['A'] = 1,  ['B'] = 2,  ['C'] = 3,  ['D'] = 4,  ['E'] = 5,  ['F'] = 6,  ['G'] = 7,  ['H'] = 8,
+    ['I'] = 9,  ['J'] = 10, ['K'] = 11, ['L'] = 12, ['M'] = 13, ['N'] = 14, ['O'] = 15, ['P'] = 16,
+    ['Q'] = 17, ['R'] = 18, ['S'] = 19, ['T'] = 20, ['U'] = 21, ['V'] = 22, ['W'] = 23, ['X'] = 24,
+    ['Y'] = 25, ['Z'] = 26, ['a'] = 27, ['b'] = 28, ['c'] = 29, ['d'] = 30, ['e'] = 31, ['f'] = 32,
+    ['g'] = 33, ['h'] = 34, ['i'] = 35, ['j'] = 36, ['k'] = 37, ['l'] = 38, ['m'] = 39, ['n'] = 40,
+    ['o'] = 41, ['p'] = 42, ['q'] = 43, ['r'] = 44, ['s'] = 45, ['t'] = 46, ['u'] = 47, ['v'] = 48,
+    ['w'] = 49, ['x'] = 50, ['y'] = 51, ['z'] = 52, ['0'] = 53, ['1'] = 54, ['2'] = 55, ['3'] = 56,
+    ['4'] = 57, ['5'] = 58, ['6'] = 59, ['7'] = 60, ['8'] = 61, ['9'] = 62, ['+'] = 63, ['/'] = 64,
+};
+
+/**
+ * @brief 字符的6位值，非字母表字符返回值不小于 64
+ */
+static inline unsigned int base64_value(unsigned char ch) {
+    return (unsigned int)base64_values[ch] - 1u;
+}
+
+/**
+ * @brief 计算Base64编码后的字符数（不含结束符）
+ */
+size_t mcp_base64_encoded_length(size_t data_len) {
+    return 4 * ((data_len + 2) / 3);
+}
+
+/**
+ * @brief 用向量指令编码开头的整块数据
+ * @return 消耗的输入字节数（3的倍数），输出为其 4/3 个字符；没有向量实现时为 0
+ */
+static size_t base64_encode_blocks(char* dst, const unsigned char* src, size_t len) {
+    size_t done = 0;
+#if defined(MCP_BASE64_NEON)
+    // 每次 48 字节：按 3 路解交织载入，拆出 4 路 6 位索引，查表后 4 路交织写出 64 个字符
+    uint8x16x4_t table;
+    table.val[0] = vld1q_u8((const uint8_t*)base64_chars);
+    table.val[1] = vld1q_u8((const uint8_t*)base64_chars + 16);
+    table.val[2] = vld1q_u8((const uint8_t*)base64_chars + 32);
+    table.val[3] = vld1q_u8((const uint8_t*)base64_chars + 48);
+    const uint8x16_t mask = vdupq_n_u8(0x3F);
+    for (; done + 48 <= len; done += 48) {
+        uint8x16x3_t in = vld3q_u8(src + done);
+        uint8x16x4_t out;
+        out.val[0] = vshrq_n_u8(in.val[0], 2);
+        out.val[1] = vandq_u8(vorrq_u8(vshlq_n_u8(in.val[0], 4), vshrq_n_u8(in.val[1], 4)), mask);
+        out.val[2] = vandq_u8(vorrq_u8(vshlq_n_u8(in.val[1], 2), vshrq_n_u8(in.val[2], 6)), mask);
+        out.val[3] = vandq_u8(in.val[2], mask);
+        out.val[0] = vqtbl4q_u8(table, out.val[0]);
+        out.val[1] = vqtbl4q_u8(table, out.val[1]);
+        out.val[2] = vqtbl4q_u8(table, out.val[2]);
+        out.val[3] = vqtbl4q_u8(table, out.val[3]);
+        vst4q_u8((uint8_t*)dst + done / 3 * 4, out);
+    }
+#elif defined(MCP_BASE64_SSSE3)
+    // 每次 12 字节（载入 16 字节，需要 4 字节余量）：重排成每 32 位一组 3 字节，移位拆出 4 个索引，
+    // 再按索引所在区间（A-Z、a-z、0-9、+、/）加上对应的偏移得到字符
+    const __m128i shuffle = _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+    const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                          '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                          '/' - 63, 'A', 0, 0);
+    for (; done + 16 <= len; done += 12) {
+        __m128i in = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(const void*)(src + done)), shuffle);
+        __m128i hi = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0FC0FC00)), _mm_set1_epi32(0x04000040));
+        __m128i lo = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003F03F0)), _mm_set1_epi32(0x01000010));
+        __m128i indices = _mm_or_si128(hi, lo);
+        // 0-25 -> 13，26-51 -> 0，52-63 -> 1-12，作为偏移表的下标
+        __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+        range = _mm_or_si128(range, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), indices), _mm_set1_epi8(13)));
+        __m128i chars = _mm_add_epi8(indices, _mm_shuffle_epi8(offsets, range));
+        _mm_storeu_si128((__m128i*)(void*)(dst + done / 3 * 4), chars);
+    }
+#else
+    (void)dst;
+    (void)src;
+    (void)len;
+#endif
+    return done;
+}
+
+/**
+ * @brief 将二进制数据Base64编码到调用者提供的缓冲区
+ * 
+ * 有向量实现时先整块编码，其余每次处理完整的3字节组，不再逐字节判断越界，尾部单独补齐
+ */
+size_t mcp_base64_encode_into(char* dst, const void* data, size_t data_len) {
+    const unsigned char* src = (const unsigned char*)data;
+    size_t i = base64_encode_blocks(dst, src, data_len);
+    char* out = dst + i / 3 * 4;
+    
+    // 完整的3字节组
+    for (; i + 3 <= data_len; i += 3) {
+        uint32_t triple = ((uint32_t)src[i] << 16) | ((uint32_t)src[i + 1] << 8) | src[i + 2];
+        out[0] = base64_chars[(triple >> 18) & 0x3F];
+        out[1] = base64_chars[(triple >> 12) & 0x3F];
+        out[2] = base64_chars[(triple >> 6) & 0x3F];
+        out[3] = base64_chars[triple & 0x3F];
+        out += 4;
+    }
+    
+    // 剩余1或2字节，用'='填充
+    size_t remaining = data_len - i;
+    if (remaining > 0) {
+        uint32_t triple = (uint32_t)src[i] << 16;
+        if (remaining == 2) {
+            triple |= (uint32_t)src[i + 1] << 8;
+        }
+        out[0] = base64_chars[(triple >> 18) & 0x3F];
+        out[1] = base64_chars[(triple >> 12) & 0x3F];
+        out[2] = remaining == 2 ? base64_chars[(triple >> 6) & 0x3F] : '=';
+        out[3] = '=';
+        out += 4;
+    }
+    
+    return (size_t)(out - dst);
+}
+
 /**
  * @brief 将二进制数据编码为Base64字符串
  * @param data 要编码的二进制数据
@@ -33,53 +166,241 @@ char* mcp_base64_encode(const char* data, size_t data_len) {
     
     LOG_DEBUG("Base64 encoding %zu bytes of data", data_len);
     
-    // 处理空数据的情况
-    if (data_len == 0) {
-        char* empty_result = malloc(1);
-        if (empty_result) {
-            empty_result[0] = '\0';
-            LOG_DEBUG("Base64 encoding completed for empty data");
-        } else {
-            LOG_ERROR("Failed to allocate memory for empty base64 result");
-        }
-        return empty_result;
-    }
-    
     // 计算编码后的长度：每3个字节编码为4个字符
-    size_t encoded_len = 4 * ((data_len + 2) / 3);
-    char* encoded = malloc(encoded_len + 1);  // +1为字符串结束符
+    size_t encoded_len = mcp_base64_encoded_length(data_len);
+    char* encoded = LINX_MALLOC(encoded_len + 1);  // +1为字符串结束符
     if (!encoded) {
         LOG_ERROR("Failed to allocate %zu bytes for base64 encoding", encoded_len + 1);
         return NULL;  // 内存分配失败
     }
     
-    size_t i, j;
-    // 按3字节为一组进行编码
-    for (i = 0, j = 0; i < data_len;) {
-        // 读取3个字节（不足时用0填充）
-        uint32_t octet_a = i < data_len ? (unsigned char)data[i++] : 0;
-        uint32_t octet_b = i < data_len ? (unsigned char)data[i++] : 0;
-        uint32_t octet_c = i < data_len ? (unsigned char)data[i++] : 0;
+    mcp_base64_encode_into(encoded, data, data_len);
+    encoded[encoded_len] = '\0';  // 添加字符串结束符
+    
+    LOG_DEBUG("Base64 encoding completed successfully: %zu bytes -> %zu characters", data_len, encoded_len);
+    return encoded;
+}
+
+/**
+ * @brief 初始化流式编码器
+ */
+void mcp_base64_encoder_init(mcp_base64_encoder_t* encoder) {
+    if (encoder) {
+        memset(encoder, 0, sizeof(*encoder));
+    }
+}
+
+/**
+ * @brief 本次 update 最多写出的字符数
+ */
+size_t mcp_base64_encode_update_length(const mcp_base64_encoder_t* encoder, size_t data_len) {
+    size_t pending = encoder ? encoder->pending_len : 0;
+    return (pending + data_len) / 3 * 4;
+}
+
+/**
+ * @brief 编码一段输入，凑不满3字节组的尾部留到下一次
+ */
+size_t mcp_base64_encode_update(mcp_base64_encoder_t* encoder, const void* data, size_t data_len, char* dst) {
+    if (!encoder || (!data && data_len > 0) || !dst) {
+        return 0;
+    }
+    
+    const unsigned char* src = (const unsigned char*)data;
+    size_t written = 0;
+    
+    // 先用新输入补齐上次留下的字节
+    if (encoder->pending_len > 0) {
+        while (encoder->pending_len < 3 && data_len > 0) {
+            encoder->pending[encoder->pending_len++] = *src++;
+            data_len--;
+        }
+        if (encoder->pending_len < 3) {
+            return 0;
+        }
+        written = mcp_base64_encode_into(dst, encoder->pending, 3);
+        encoder->pending_len = 0;
+    }
+    
+    size_t whole = data_len / 3 * 3;
+    written += mcp_base64_encode_into(dst + written, src, whole);
+    encoder->pending_len = data_len - whole;
+    memcpy(encoder->pending, src + whole, encoder->pending_len);
+    return written;
+}
+
+/**
+ * @brief 写出剩余的1或2个字节及填充
+ */
+size_t mcp_base64_encode_final(mcp_base64_encoder_t* encoder, char* dst) {
+    if (!encoder || !dst) {
+        return 0;
+    }
+    size_t written = mcp_base64_encode_into(dst, encoder->pending, encoder->pending_len);
+    encoder->pending_len = 0;
+    return written;
+}
+
+/**
+ * @brief 解码 text_len 个字符最多得到的字节数（含流式解码器中留存的字符）
+ */
+size_t mcp_base64_decoded_max_length(size_t text_len) {
+    return (text_len + 3) / 4 * 3;
+}
+
+/**
+ * @brief 初始化流式解码器
+ */
+void mcp_base64_decoder_init(mcp_base64_decoder_t* decoder) {
+    if (decoder) {
+        memset(decoder, 0, sizeof(*decoder));
+    }
+}
+
+/**
+ * @brief 解码一段Base64文本，不足4个字符的尾部留到下一次
+ *
+ * 没有留存字符时每次查表合并4个字符，遇到填充字符或非法字符才逐个处理
+ */
+bool mcp_base64_decode_update(mcp_base64_decoder_t* decoder, const char* text, size_t text_len,
+                              void* dst, size_t* written) {
+    if (written) {
+        *written = 0;
+    }
+    if (!decoder || (!text && text_len > 0) || !dst || decoder->failed) {
+        return false;
+    }
+    
+    const unsigned char* in = (const unsigned char*)text;
+    const unsigned char* end = in + text_len;
+    unsigned char* out = (unsigned char*)dst;
+    
+    while (in < end) {
+        // 整组快速路径：四个值按位或仍小于 64 说明都在字母表内
+        if (decoder->count == 0 && decoder->padding == 0) {
+            while (end - in >= 4) {
+                unsigned int a = base64_value(in[0]);
+                unsigned int b = base64_value(in[1]);
+                unsigned int c = base64_value(in[2]);
+                unsigned int d = base64_value(in[3]);
+                if ((a | b | c | d) >= 64) {
+                    break;
+                }
+                uint32_t v = (a << 18) | (b << 12) | (c << 6) | d;
+                out[0] = (unsigned char)(v >> 16);
+                out[1] = (unsigned char)(v >> 8);
+                out[2] = (unsigned char)v;
+                out += 3;
+                in += 4;
+            }
+            if (in == end) {
+                break;
+            }
+        }
         
-        // 将3个字节合并为24位整数
-        uint32_t triple = (octet_a << 0x10) + (octet_b << 0x08) + octet_c;
+        unsigned char ch = *in++;
+        if (ch == '=') {
+            // 填充只能出现在一组的第3、4个位置，且之后不能再有数据
+            if (decoder->count + decoder->padding < 2 || decoder->count + decoder->padding >= 4) {
+                decoder->failed = true;
+                break;
+            }
+            if (decoder->padding == 0) {
+                if (decoder->count == 2) {
+                    *out++ = (unsigned char)(decoder->bits >> 4);
+                } else {
+                    *out++ = (unsigned char)(decoder->bits >> 10);
+                    *out++ = (unsigned char)(decoder->bits >> 2);
+                }
+            }
+            decoder->padding++;
+            continue;
+        }
         
-        // 将24位分为4组，每组6位，映射到Base64字符
-        encoded[j++] = base64_chars[(triple >> 3 * 6) & 0x3F];
-        encoded[j++] = base64_chars[(triple >> 2 * 6) & 0x3F];
-        encoded[j++] = base64_chars[(triple >> 1 * 6) & 0x3F];
-        encoded[j++] = base64_chars[(triple >> 0 * 6) & 0x3F];
+        unsigned int value = base64_value(ch);
+        if (value >= 64 || decoder->padding > 0) {
+            decoder->failed = true;
+            break;
+        }
+        decoder->bits = (decoder->bits << 6) | value;
+        if (++decoder->count == 4) {
+            out[0] = (unsigned char)(decoder->bits >> 16);
+            out[1] = (unsigned char)(decoder->bits >> 8);
+            out[2] = (unsigned char)decoder->bits;
+            out += 3;
+            decoder->bits = 0;
+            decoder->count = 0;
+        }
     }
     
-    // 添加填充字符'='
-    for (i = 0; i < (3 - data_len % 3) % 3; i++) {
-        encoded[encoded_len - 1 - i] = '=';
+    if (written) {
+        *written = (size_t)(out - (unsigned char*)dst);
+    }
+    return !decoder->failed;
+}
+
+/**
+ * @brief 结束解码，写出没有填充的尾部（最多2字节）
+ */
+bool mcp_base64_decode_final(mcp_base64_decoder_t* decoder, void* dst, size_t* written) {
+    if (written) {
+        *written = 0;
+    }
+    if (!decoder || !dst || decoder->failed) {
+        return false;
     }
     
-    encoded[encoded_len] = '\0';  // 添加字符串结束符
-    
-    LOG_INFO("Base64 encoding completed successfully: %zu bytes -> %zu characters", data_len, encoded_len);
-    return encoded;
+    unsigned char* out = (unsigned char*)dst;
+    bool ok = true;
+    if (decoder->padding > 0) {
+        // 填充已写出数据，只需凑满一组
+        ok = decoder->count + decoder->padding == 4;
+    } else if (decoder->count == 2) {
+        out[0] = (unsigned char)(decoder->bits >> 4);
+        if (written) {
+            *written = 1;
+        }
+    } else if (decoder->count == 3) {
+        out[0] = (unsigned char)(decoder->bits >> 10);
+        out[1] = (unsigned char)(decoder->bits >> 2);
+        if (written) {
+            *written = 2;
+        }
+    } else {
+        ok = decoder->count == 0;
+    }
+    mcp_base64_decoder_init(decoder);
+    decoder->failed = !ok;
+    return ok;
+}
+
+/**
+ * @brief 一次解码完整的Base64文本
+ */
+bool mcp_base64_decode_into(void* dst, const char* text, size_t text_len, size_t* decoded_len) {
+    mcp_base64_decoder_t decoder;
+    size_t body = 0;
+    size_t tail = 0;
+    
+    mcp_base64_decoder_init(&decoder);
+    bool ok = mcp_base64_decode_update(&decoder, text, text_len, dst, &body) &&
+              mcp_base64_decode_final(&decoder, (unsigned char*)dst + body, &tail);
+    if (decoded_len) {
+        *decoded_len = ok ? body + tail : 0;
+    }
+    return ok;
+}
+
+/**
+ * @brief MIME类型能否不经转义直接写入JSON字符串
+ */
+static bool mcp_mime_type_is_valid(const char* mime_type) {
+    for (const char* p = mime_type; *p; p++) {
+        if ((unsigned char)*p < 0x20 || *p == '"' || *p == '\\') {
+            return false;
+        }
+    }
+    return mime_type[0] != '\0';
 }
 
 /**
@@ -96,10 +417,15 @@ mcp_image_content_t* mcp_image_content_create(const char* mime_type, const char*
         return NULL;
     }
     
+    if (!mcp_mime_type_is_valid(mime_type)) {
+        LOG_ERROR("Invalid MIME type for image content");
+        return NULL;
+    }
+    
     LOG_DEBUG("Creating image content: mime_type='%s', data_len=%zu", mime_type, data_len);
     
     // 分配图像内容结构体内存
-    mcp_image_content_t* image = malloc(sizeof(mcp_image_content_t));
+    mcp_image_content_t* image = LINX_CALLOC(1, sizeof(mcp_image_content_t));
     if (!image) {
         LOG_ERROR("Failed to allocate memory for image content structure");
         return NULL;
@@ -109,7 +435,7 @@ mcp_image_content_t* mcp_image_content_create(const char* mime_type, const char*
     image->encoded_data = mcp_base64_encode(data, data_len);
     if (!image->encoded_data) {
         LOG_ERROR("Failed to base64 encode image data");
-        free(image);
+        LINX_FREE(image);
         return NULL;
     }
     
@@ -117,8 +443,8 @@ mcp_image_content_t* mcp_image_content_create(const char* mime_type, const char*
     image->mime_type = mcp_strdup(mime_type);
     if (!image->mime_type) {
         LOG_ERROR("Failed to duplicate MIME type string");
-        free(image->encoded_data);
-        free(image);
+        LINX_FREE(image->encoded_data);
+        LINX_FREE(image);
         return NULL;
     }
     
@@ -126,6 +452,104 @@ mcp_image_content_t* mcp_image_content_create(const char* mime_type, const char*
     return image;
 }
 
+/**
+ * @brief 创建保存原始数据的图像内容对象（接管 data）
+ */
+mcp_image_content_t* mcp_image_content_adopt(const char* mime_type, char* data, size_t data_len) {
+    if (!mime_type || !data || data_len == 0 || !mcp_mime_type_is_valid(mime_type)) {
+        LOG_ERROR("Invalid parameters for raw image content: mime_type=%p, data=%p, data_len=%zu", mime_type, data, data_len);
+        return NULL;
+    }
+    
+    mcp_image_content_t* image = LINX_CALLOC(1, sizeof(mcp_image_content_t));
+    if (!image) {
+        LOG_ERROR("Failed to allocate memory for image content structure");
+        return NULL;
+    }
+    
+    image->mime_type = mcp_strdup(mime_type);
+    if (!image->mime_type) {
+        LINX_FREE(image);
+        return NULL;
+    }
+    image->raw_data = data;
+    image->raw_length = data_len;
+    
+    LOG_DEBUG("Raw image content created: mime_type='%s', data_len=%zu", mime_type, data_len);
+    return image;
+}
+
+/**
+ * @brief 创建保存原始数据的图像内容对象（复制 data）
+ */
+mcp_image_content_t* mcp_image_content_create_raw(const char* mime_type, const char* data, size_t data_len) {
+    if (!data || data_len == 0) {
+        LOG_ERROR("Invalid parameters for raw image content: data=%p, data_len=%zu", data, data_len);
+        return NULL;
+    }
+    
+    char* copy = LINX_MALLOC(data_len);
+    if (!copy) {
+        LOG_ERROR("Failed to allocate %zu bytes for raw image data", data_len);
+        return NULL;
+    }
+    memcpy(copy, data, data_len);
+    
+    mcp_image_content_t* image = mcp_image_content_adopt(mime_type, copy, data_len);
+    if (!image) {
+        LINX_FREE(copy);
+    }
+    return image;
+}
+
+/**
+ * @brief 创建引用共享缓冲区的图像内容对象
+ */
+mcp_image_content_t* mcp_image_content_create_shared(const char* mime_type, mcp_buffer_t* buffer) {
+    if (!buffer || !buffer->data || buffer->size == 0) {
+        LOG_ERROR("Invalid shared buffer for image content: buffer=%p", buffer);
+        return NULL;
+    }
+    
+    mcp_image_content_t* image = mcp_image_content_adopt(mime_type, (char*)buffer->data, buffer->size);
+    if (!image) {
+        return NULL;
+    }
+    image->buffer = mcp_buffer_retain(buffer);
+    return image;
+}
+
+/**
+ * @brief 获取图像数据的Base64字符数
+ */
+size_t mcp_image_content_encoded_length(const mcp_image_content_t* image) {
+    if (!image) {
+        return 0;
+    }
+    if (image->encoded_data) {
+        return strlen(image->encoded_data);
+    }
+    return mcp_base64_encoded_length(image->raw_length);
+}
+
+/**
+ * @brief 把图像数据的Base64文本写入调用者提供的缓冲区
+ */
+size_t mcp_image_content_write_data(const mcp_image_content_t* image, char* dst) {
+    if (!image || !dst) {
+        return 0;
+    }
+    if (image->encoded_data) {
+        size_t length = strlen(image->encoded_data);
+        memcpy(dst, image->encoded_data, length);
+        return length;
+    }
+    if (image->raw_data) {
+        return mcp_base64_encode_into(dst, image->raw_data, image->raw_length);
+    }
+    return 0;
+}
+
 /**
  * @brief 销毁图像内容对象
  * @param image 要销毁的图像内容对象
@@ -140,18 +564,27 @@ void mcp_image_content_destroy(mcp_image_content_t* image) {
     
     // 释放MIME类型字符串
     if (image->mime_type) {
-        free(image->mime_type);
+        LINX_FREE(image->mime_type);
         image->mime_type = NULL;
     }
     
     // 释放编码数据字符串
     if (image->encoded_data) {
-        free(image->encoded_data);
+        LINX_FREE(image->encoded_data);
         image->encoded_data = NULL;
     }
     
+    // 释放原始数据（共享缓冲区只释放引用）
+    if (image->buffer) {
+        mcp_buffer_release(image->buffer);
+        image->buffer = NULL;
+    } else if (image->raw_data) {
+        LINX_FREE(image->raw_data);
+    }
+    image->raw_data = NULL;
+    
     // 释放结构体本身
-    free(image);
+    LINX_FREE(image);
     
     LOG_DEBUG("Image content destroyed successfully");
 }
@@ -160,9 +593,11 @@ void mcp_image_content_destroy(mcp_image_content_t* image) {
  * @brief 将图像内容转换为JSON字符串
  * @param image 图像内容对象
  * @return JSON字符串，失败返回NULL
+ * 
+ * 按最终长度一次分配，Base64文本直接写入结果，不经过cJSON中转
  */
 char* mcp_image_content_to_json(const mcp_image_content_t* image) {
-    if (!image || !image->mime_type || !image->encoded_data) {
+    if (!image || !image->mime_type || (!image->encoded_data && !image->raw_data)) {
         LOG_ERROR("Invalid image content for JSON conversion: image=%p, mime_type=%p, encoded_data=%p", 
                   image, image ? image->mime_type : NULL, image ? image->encoded_data : NULL);
         return NULL;
@@ -170,32 +605,32 @@ char* mcp_image_content_to_json(const mcp_image_content_t* image) {
     
     LOG_DEBUG("Converting image content to JSON: mime_type='%s'", image->mime_type);
     
-    // 创建JSON对象
-    cJSON* json = cJSON_CreateObject();
-    if (!json) {
-        LOG_ERROR("Failed to create JSON object for image content");
-        return NULL;
-    }
-    
-    // 添加type字段
-    cJSON_AddStringToObject(json, "type", "image");
-    
-    // 添加mimeType字段
-    cJSON_AddStringToObject(json, "mimeType", image->mime_type);
-    
-    // 添加data字段
-    cJSON_AddStringToObject(json, "data", image->encoded_data);
+    static const char prefix[] = "{\"type\":\"image\",\"mimeType\":\"";
+    static const char middle[] = "\",\"data\":\"";
+    static const char suffix[] = "\"}";
+    size_t mime_len = strlen(image->mime_type);
+    size_t data_len = mcp_image_content_encoded_length(image);
+    size_t total = sizeof(prefix) - 1 + mime_len + sizeof(middle) - 1 + data_len + sizeof(suffix) - 1;
     
-    // 转换为字符串（使用紧凑格式）
-    char* json_string = cJSON_PrintUnformatted(json);
-    cJSON_Delete(json);
-    
-    if (json_string) {
-        LOG_INFO("Image content converted to JSON successfully: mime_type='%s'", image->mime_type);
-    } else {
-        LOG_ERROR("Failed to convert JSON object to string");
+    char* json_string = LINX_MALLOC(total + 1);
+    if (!json_string) {
+        LOG_ERROR("Failed to allocate %zu bytes for image JSON", total + 1);
+        return NULL;
     }
     
+    char* out = json_string;
+    memcpy(out, prefix, sizeof(prefix) - 1);
+    out += sizeof(prefix) - 1;
+    memcpy(out, image->mime_type, mime_len);
+    out += mime_len;
+    memcpy(out, middle, sizeof(middle) - 1);
+    out += sizeof(middle) - 1;
+    out += mcp_image_content_write_data(image, out);
+    memcpy(out, suffix, sizeof(suffix) - 1);
+    out += sizeof(suffix) - 1;
+    *out = '\0';
+    
+    LOG_DEBUG("Image content converted to JSON successfully: mime_type='%s'", image->mime_type);
     return json_string;
 }
 
@@ -214,7 +649,7 @@ char* mcp_strdup(const char* str) {
     size_t len = strlen(str);
     LOG_DEBUG("Duplicating string of length %zu", len);
     
-    char* copy = malloc(len + 1);  // +1为字符串结束符
+    char* copy = LINX_MALLOC(len + 1);  // +1为字符串结束符
     if (!copy) {
         LOG_ERROR("Failed to allocate %zu bytes for string duplication", len + 1);
         return NULL;
@@ -233,7 +668,7 @@ char* mcp_strdup(const char* str) {
 void mcp_free_string(char* str) {
     if (str) {
         LOG_DEBUG("Freeing string memory");
-        free(str);
+        LINX_FREE(str);
     } else {
         LOG_WARN("Attempted to free NULL string");
     }
@@ -249,7 +684,7 @@ char* mcp_itoa(int value) {
     
     // 计算所需的缓冲区大小
     // 最大整数需要11个字符（包括负号和结束符）：-2147483648\0
-    char* buffer = malloc(12);
+    char* buffer = LINX_MALLOC(12);
     if (!buffer) {
         LOG_ERROR("Failed to allocate 12 bytes for integer to string conversion");
         return NULL;  // 内存分配失败
@@ -259,7 +694,7 @@ char* mcp_itoa(int value) {
     int result = snprintf(buffer, 12, "%d", value);
     if (result < 0) {
         LOG_ERROR("Failed to convert integer %d to string", value);
-        free(buffer);  // 转换失败，释放内存
+        LINX_FREE(buffer);  // 转换失败，释放内存
         return NULL;
     }
     
@@ -268,9 +703,30 @@ char* mcp_itoa(int value) {
 }
 
 /**
- * @brief 将cJSON对象转换为字符串
+ * @brief 获取单调时钟时间（毫秒）
+ */
+uint64_t mcp_time_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)(ts.tv_nsec / 1000000);
+}
+
+/**
+ * @brief 获取单调时钟时间（微秒）
+ */
+uint64_t mcp_time_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)(ts.tv_nsec / 1000);
+}
+
+/**
+ * @brief 将cJSON对象转换为紧凑格式的字符串
+ * 
+ * 先估算长度一次性分配，再用 cJSON_PrintPreallocated 打印，不经过 cJSON 打印时的逐步扩容。
+ * 
  * @param json cJSON对象
- * @return JSON字符串，失败返回NULL
+ * @return JSON字符串（用 cJSON_free 释放），失败返回NULL
  */
 char* mcp_json_to_string(const cJSON* json) {
     if (!json) {
@@ -278,13 +734,14 @@ char* mcp_json_to_string(const cJSON* json) {
         return NULL;
     }
     
-    LOG_DEBUG("Converting JSON object to string");
-    
-    char* json_string = cJSON_PrintUnformatted(json);
-    if (json_string) {
-        LOG_DEBUG("JSON object converted to string successfully");
-    } else {
+    size_t estimate = linx_json_print_estimate(json);
+    char* json_string = estimate > 0 && estimate <= INT_MAX - LINX_JSON_PRINT_SLACK ?
+                        (char*)cJSON_malloc(estimate + LINX_JSON_PRINT_SLACK) : NULL;
+    if (!json_string ||
+        !cJSON_PrintPreallocated((cJSON*)json, json_string, (int)(estimate + LINX_JSON_PRINT_SLACK), 0)) {
         LOG_ERROR("Failed to convert JSON object to string");
+        cJSON_free(json_string);
+        return NULL;
     }
     
     return json_string;
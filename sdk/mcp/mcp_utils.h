@@ -12,6 +12,7 @@
 #define MCP_UTILS_H
 
 #include "mcp_types.h"        // 包含MCP类型定义
+#include "mcp_buffer.h"       // 共享数据缓冲区
 
 #ifdef __cplusplus
 extern "C" {
@@ -20,15 +21,35 @@ extern "C" {
 /**
  * @brief 图像内容结构体
  * 
- * 用于存储图像数据的MIME类型和Base64编码后的数据
+ * 用于存储图像数据的MIME类型和Base64编码后的数据；
+ * 也可以只保存原始数据，在生成响应时直接编码进发送缓冲区
  */
 typedef struct mcp_image_content {
     char* mime_type;      /**< 图像MIME类型（如"image/png", "image/jpeg"等） */
-    char* encoded_data;   /**< Base64编码后的图像数据 */
+    char* encoded_data;   /**< Base64编码后的图像数据，原始数据形式时为NULL */
+    char* raw_data;       /**< 原始图像数据（mcp_image_content_create_raw/adopt/shared），否则为NULL */
+    size_t raw_length;    /**< 原始图像数据长度 */
+    mcp_buffer_t* buffer; /**< raw_data 所在的共享缓冲区（mcp_image_content_create_shared），否则为NULL */
 } mcp_image_content_t;
 
 /* Base64编码函数 */
 
+/**
+ * @brief 计算Base64编码后的字符数
+ * @param data_len 原始数据长度
+ * @return 编码后的字符数（含填充，不含结束符）
+ */
+size_t mcp_base64_encoded_length(size_t data_len);
+
+/**
+ * @brief 将二进制数据Base64编码到调用者提供的缓冲区
+ * @param dst 输出缓冲区，至少 mcp_base64_encoded_length(data_len) 字节
+ * @param data 要编码的二进制数据
+ * @param data_len 数据长度
+ * @return 写入的字符数，不写结束符
+ */
+size_t mcp_base64_encode_into(char* dst, const void* data, size_t data_len);
+
 /**
  * @brief 将二进制数据编码为Base64字符串
  * @param data 要编码的二进制数据
@@ -38,6 +59,89 @@ typedef struct mcp_image_content {
  */
 char* mcp_base64_encode(const char* data, size_t data_len);
 
+/*
+ * 流式Base64编解码：输入按任意大小分段送入，输出写入调用者的缓冲区，不分配内存。
+ * 编码在 SSSE3（x86 需 -mssse3 或更高的 -march）和 AArch64 NEON 上整块向量化，
+ * 其他目标使用逐组查表；解码按4个字符一组查表。
+ */
+
+/**
+ * @brief 流式Base64编码器
+ */
+typedef struct {
+    unsigned char pending[3];   /**< 上次未凑满3字节组的输入 */
+    size_t pending_len;
+} mcp_base64_encoder_t;
+
+/**
+ * @brief 流式Base64解码器
+ */
+typedef struct {
+    uint32_t bits;              /**< 未凑满一组的6位值 */
+    uint8_t count;              /**< bits 中的字符数 */
+    uint8_t padding;            /**< 已读到的 '=' 数 */
+    bool failed;                /**< 遇到非法输入，之后的调用都失败 */
+} mcp_base64_decoder_t;
+
+/**
+ * @brief 初始化流式编码器
+ */
+void mcp_base64_encoder_init(mcp_base64_encoder_t* encoder);
+
+/**
+ * @brief 下一次 mcp_base64_encode_update() 最多写出的字符数
+ */
+size_t mcp_base64_encode_update_length(const mcp_base64_encoder_t* encoder, size_t data_len);
+
+/**
+ * @brief 编码一段输入，凑不满3字节组的尾部留到下一次
+ * @param dst 输出缓冲区，至少 mcp_base64_encode_update_length() 字节
+ * @return 写入的字符数，不写结束符
+ */
+size_t mcp_base64_encode_update(mcp_base64_encoder_t* encoder, const void* data, size_t data_len, char* dst);
+
+/**
+ * @brief 结束编码，写出剩余字节和填充
+ * @param dst 输出缓冲区，至少 4 字节
+ * @return 写入的字符数（0 或 4）
+ */
+size_t mcp_base64_encode_final(mcp_base64_encoder_t* encoder, char* dst);
+
+/**
+ * @brief 解码 text_len 个字符最多写出的字节数，流式解码的每一段也适用
+ */
+size_t mcp_base64_decoded_max_length(size_t text_len);
+
+/**
+ * @brief 初始化流式解码器
+ */
+void mcp_base64_decoder_init(mcp_base64_decoder_t* decoder);
+
+/**
+ * @brief 解码一段Base64文本，不足一组的尾部留到下一次
+ * @param dst 输出缓冲区，至少 mcp_base64_decoded_max_length(text_len) 字节
+ * @param written 写入的字节数（输出参数，可为 NULL）
+ * @return 遇到字母表以外的字符或位置错误的填充时返回 false，解码器随之失效
+ */
+bool mcp_base64_decode_update(mcp_base64_decoder_t* decoder, const char* text, size_t text_len,
+                              void* dst, size_t* written);
+
+/**
+ * @brief 结束解码，写出没有填充的尾部，并重置解码器
+ * @param dst 输出缓冲区，至少 2 字节
+ * @param written 写入的字节数（输出参数，可为 NULL）
+ * @return 输入在组边界上结束（或按规则省略了填充）返回 true
+ */
+bool mcp_base64_decode_final(mcp_base64_decoder_t* decoder, void* dst, size_t* written);
+
+/**
+ * @brief 一次解码完整的Base64文本
+ * @param dst 输出缓冲区，至少 mcp_base64_decoded_max_length(text_len) 字节
+ * @param decoded_len 解码得到的字节数（输出参数，可为 NULL）
+ * @return 解码成功返回 true
+ */
+bool mcp_base64_decode_into(void* dst, const char* text, size_t text_len, size_t* decoded_len);
+
 /* 图像内容操作函数 */
 
 /**
@@ -50,6 +154,50 @@ char* mcp_base64_encode(const char* data, size_t data_len);
  */
 mcp_image_content_t* mcp_image_content_create(const char* mime_type, const char* data, size_t data_len);
 
+/**
+ * @brief 创建保存原始数据的图像内容对象
+ * @param mime_type 图像MIME类型
+ * @param data 原始图像数据（会被复制）
+ * @param data_len 数据长度
+ * @return 创建的图像内容对象，失败返回NULL
+ * @note 不预先编码：回复时Base64直接写入响应缓冲区，省去编码副本和JSON中转副本
+ */
+mcp_image_content_t* mcp_image_content_create_raw(const char* mime_type, const char* data, size_t data_len);
+
+/**
+ * @brief 创建保存原始数据的图像内容对象并接管数据
+ * @param mime_type 图像MIME类型
+ * @param data linx_malloc() 分配的原始图像数据，成功后由图像对象释放
+ * @param data_len 数据长度
+ * @return 创建的图像内容对象，失败返回NULL（此时 data 仍归调用者）
+ */
+mcp_image_content_t* mcp_image_content_adopt(const char* mime_type, char* data, size_t data_len);
+
+/**
+ * @brief 创建引用共享缓冲区的图像内容对象
+ * @param mime_type 图像MIME类型
+ * @param buffer 图像数据所在的共享缓冲区（增加一个引用，销毁图像时释放）
+ * @return 创建的图像内容对象，失败返回NULL
+ * @note 不复制也不预先编码：例如相机帧池中的JPEG可以直接作为工具结果，
+ *       回复时Base64从帧缓冲区直接写入响应缓冲区
+ */
+mcp_image_content_t* mcp_image_content_create_shared(const char* mime_type, mcp_buffer_t* buffer);
+
+/**
+ * @brief 获取图像数据的Base64字符数
+ * @param image 图像内容对象
+ * @return Base64字符数
+ */
+size_t mcp_image_content_encoded_length(const mcp_image_content_t* image);
+
+/**
+ * @brief 把图像数据的Base64文本写入调用者提供的缓冲区
+ * @param image 图像内容对象
+ * @param dst 输出缓冲区，至少 mcp_image_content_encoded_length 字节
+ * @return 写入的字符数，不写结束符
+ */
+size_t mcp_image_content_write_data(const mcp_image_content_t* image, char* dst);
+
 /**
  * @brief 销毁图像内容对象
  * @param image 要销毁的图像内容对象
@@ -90,13 +238,27 @@ void mcp_free_string(char* str);
  */
 char* mcp_itoa(int value);
 
+/* 时间工具函数 */
+
+/**
+ * @brief 获取单调时钟时间
+ * @return 毫秒数，不受系统时间调整影响
+ */
+uint64_t mcp_time_now_ms(void);
+
+/**
+ * @brief 获取单调时钟时间
+ * @return 微秒数，用于调用剖析
+ */
+uint64_t mcp_time_now_us(void);
+
 /* JSON工具函数 */
 
 /**
- * @brief 将cJSON对象转换为字符串
+ * @brief 将cJSON对象转换为紧凑格式的字符串（按估算长度一次分配）
  * @param json cJSON对象
  * @return JSON字符串，失败返回NULL
- * @note 返回的字符串需要调用者释放内存
+ * @note 返回的字符串需要调用者用 cJSON_free 释放
  */
 char* mcp_json_to_string(const cJSON* json);
 
@@ -0,0 +1,175 @@
+/*
+ * MCP 服务器微基准测试
+ *
+ * 测量 mcp_server_parse_message 处理 initialize、tools/list、tools/call
+ * 三类消息的耗时（ns/op）和 cJSON 堆分配次数（allocs/op），
+ * 覆盖 1 / 16 / 64 个已注册工具以及 0 / 4 / 16 个调用参数。
+ *
+ * 分配计数通过 linx_json_arena_set_heap_allocator 挂在 cJSON 的堆分配上，
+ * 只统计竞技场之外的 cJSON 分配（回退、暂停期间和作用域外的分配），
+ * 服务器自身直接调用 malloc 的缓冲区不在统计范围内。
+ *
+ * 用法：bench_mcp [每项迭代次数]
+ */
+
+#include "../mcp.h"
+#include "linx_json_arena.h"
+#include "linx_log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_DEFAULT_ITERATIONS 20000
+#define BENCH_WARMUP_ITERATIONS  100
+#define BENCH_MAX_ARGS           16
+
+/* 分配计数 */
+static size_t g_alloc_count = 0;
+static size_t g_alloc_bytes = 0;
+
+/* 防止编译器把回复当成无用结果 */
+static size_t g_reply_bytes = 0;
+
+static void* counting_malloc(size_t size) {
+    g_alloc_count++;
+    g_alloc_bytes += size;
+    return malloc(size);
+}
+
+static void counting_free(void* pointer) {
+    free(pointer);
+}
+
+static void discard_send_handler(const char* message, void* user_data) {
+    (void)user_data;
+    g_reply_bytes += strlen(message);
+}
+
+static mcp_return_value_t bench_tool_callback(const mcp_property_list_t* properties) {
+    (void)properties;
+    return mcp_return_bool(true);
+}
+
+static uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* 注册 tool_count 个工具，每个工具声明 arg_count 个整数参数 */
+static mcp_server_t* bench_create_server(int tool_count, int arg_count) {
+    mcp_server_t* server = mcp_server_create("bench_server", "1.0.0");
+    if (!server) {
+        return NULL;
+    }
+    mcp_server_set_send_handler(server, discard_send_handler, NULL);
+
+    mcp_property_list_t* properties = mcp_property_list_create();
+    for (int i = 0; i < arg_count; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "arg%d", i);
+        mcp_property_t* prop = mcp_property_create_integer(name, 0, false, true, -1000000, 1000000);
+        mcp_property_list_add(properties, prop);
+        mcp_property_destroy(prop);
+    }
+
+    for (int i = 0; i < tool_count; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "self.bench.tool_%d", i);
+        if (!mcp_server_add_simple_tool(server, name, "Benchmark tool that always returns true",
+                                        properties, bench_tool_callback)) {
+            mcp_property_list_destroy(properties);
+            mcp_server_destroy(server);
+            return NULL;
+        }
+    }
+
+    mcp_property_list_destroy(properties);
+    return server;
+}
+
+/* 调用最后注册的工具，使查找走完整个工具表 */
+static void bench_build_call(char* buffer, size_t size, int tool_count, int arg_count) {
+    int written = snprintf(buffer, size,
+                           "{\"jsonrpc\":\"2.0\",\"id\":3,\"method\":\"tools/call\","
+                           "\"params\":{\"name\":\"self.bench.tool_%d\",\"arguments\":{",
+                           tool_count - 1);
+    for (int i = 0; i < arg_count; i++) {
+        written += snprintf(buffer + written, size - (size_t)written, "%s\"arg%d\":%d",
+                            i > 0 ? "," : "", i, i * 7);
+    }
+    snprintf(buffer + written, size - (size_t)written, "}}}");
+}
+
+static void bench_run(const char* label, mcp_server_t* server, const char* message, int iterations) {
+    for (int i = 0; i < BENCH_WARMUP_ITERATIONS; i++) {
+        mcp_server_parse_message(server, message);
+    }
+
+    size_t allocs_before = g_alloc_count;
+    size_t bytes_before = g_alloc_bytes;
+    uint64_t start = bench_now_ns();
+    for (int i = 0; i < iterations; i++) {
+        mcp_server_parse_message(server, message);
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+
+    printf("%-28s %12.1f %12.2f %12.1f\n", label,
+           (double)elapsed / iterations,
+           (double)(g_alloc_count - allocs_before) / iterations,
+           (double)(g_alloc_bytes - bytes_before) / iterations);
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? atoi(argv[1]) : BENCH_DEFAULT_ITERATIONS;
+    if (iterations <= 0) {
+        iterations = BENCH_DEFAULT_ITERATIONS;
+    }
+
+    log_set_level(LOG_LEVEL_ERROR);
+    linx_json_arena_set_heap_allocator(counting_malloc, counting_free);
+
+    static const char* initialize_message =
+        "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"initialize\","
+        "\"params\":{\"protocolVersion\":\"2024-11-05\",\"capabilities\":{}}}";
+    static const char* tools_list_message =
+        "{\"jsonrpc\":\"2.0\",\"id\":2,\"method\":\"tools/list\",\"params\":{}}";
+
+    static const int tool_counts[] = { 1, 16, 64 };
+    static const int arg_counts[] = { 0, 4, BENCH_MAX_ARGS };
+    char label[64];
+    char call_message[1024];
+
+    printf("MCP 微基准测试（每项 %d 次迭代）\n\n", iterations);
+    printf("%-28s %12s %12s %12s\n", "case", "ns/op", "allocs/op", "bytes/op");
+
+    for (size_t t = 0; t < sizeof(tool_counts) / sizeof(tool_counts[0]); t++) {
+        int tool_count = tool_counts[t];
+        for (size_t a = 0; a < sizeof(arg_counts) / sizeof(arg_counts[0]); a++) {
+            int arg_count = arg_counts[a];
+            mcp_server_t* server = bench_create_server(tool_count, arg_count);
+            if (!server) {
+                fprintf(stderr, "创建服务器失败: tools=%d args=%d\n", tool_count, arg_count);
+                return 1;
+            }
+
+            if (a == 0) {
+                snprintf(label, sizeof(label), "initialize/%d", tool_count);
+                bench_run(label, server, initialize_message, iterations);
+            }
+
+            snprintf(label, sizeof(label), "tools/list/%d/args=%d", tool_count, arg_count);
+            bench_run(label, server, tools_list_message, iterations);
+
+            bench_build_call(call_message, sizeof(call_message), tool_count, arg_count);
+            snprintf(label, sizeof(label), "tools/call/%d/args=%d", tool_count, arg_count);
+            bench_run(label, server, call_message, iterations);
+
+            mcp_server_destroy(server);
+        }
+    }
+
+    printf("\n回复总字节数: %zu\n", g_reply_bytes);
+    return 0;
+}
@@ -28,7 +28,8 @@ static mcp_server_t* g_server = NULL;
 static char g_work_dir[512] = "./sandbox";
 
 // 消息发送回调函数
-void send_message(const char* message) {
+void send_message(const char* message, void* user_data) {
+    (void)user_data;
     printf("SEND: %s\n", message);
     fflush(stdout);
 }
@@ -343,7 +344,7 @@ bool init_file_manager_server() {
     }
     
     // 设置消息发送回调
-    mcp_server_set_send_callback(send_message);
+    mcp_server_set_send_handler(g_server, send_message, NULL);
     
     // 创建读取文件工具
     mcp_property_list_t* read_props = mcp_property_list_create();
@@ -51,7 +51,8 @@ static weather_data_t g_weather_db[] = {
 static const size_t g_weather_db_size = sizeof(g_weather_db) / sizeof(weather_data_t);
 
 // 消息发送回调函数
-void send_message(const char* message) {
+void send_message(const char* message, void* user_data) {
+    (void)user_data;
     printf("SEND: %s\n", message);
     fflush(stdout);
 }
@@ -420,7 +421,7 @@ bool init_weather_server() {
     }
     
     // 设置消息发送回调
-    mcp_server_set_send_callback(send_message);
+    mcp_server_set_send_handler(g_server, send_message, NULL);
     
     // 创建获取当前天气工具
     mcp_property_list_t* current_props = mcp_property_list_create();
@@ -27,7 +27,7 @@ PASSED_TESTS=0
 FAILED_TESTS=0
 
 # 可用的测试列表
-AVAILABLE_TESTS=("types" "utils" "property" "tool" "server" "integration")
+AVAILABLE_TESTS=("types" "utils" "property" "tool" "server" "integration" "executor")
 
 # 显示帮助信息
 show_help() {
@@ -50,6 +50,7 @@ show_help() {
     echo "  tool                    工具管理测试"
     echo "  server                  服务器功能测试"
     echo "  integration             集成测试"
+    echo "  executor                任务执行器测试"
     echo "  all                     所有测试（默认）"
     echo ""
     echo "示例:"
@@ -68,6 +69,7 @@ list_tests() {
     echo "  tool        - 工具管理测试"
     echo "  server      - 服务器功能测试"
     echo "  integration - 集成测试"
+    echo "  executor    - 任务执行器测试"
 }
 
 # 打印带颜色的消息
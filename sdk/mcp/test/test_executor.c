@@ -0,0 +1,368 @@
+/**
+ * @file test_executor.c
+ * @brief 后台任务执行器单元测试
+ *
+ * MCP 异步工具的工作线程池运行在 linx_executor 上。测试优先级顺序、工作线程之间的
+ * 任务窃取、取消令牌，以及销毁时未开始的任务以已取消的令牌调用一次（包括与销毁并发的提交）。
+ */
+
+#include "test_framework.h"
+#include "../../linx_executor.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#define EXEC_WAIT_US 5000000    // 等待条件成立的上限（5 秒）
+
+/* 等待 *flag 达到 value，超时返回 false */
+static bool exec_wait_for(const int* flag, int value) {
+    for (int waited = 0; waited < EXEC_WAIT_US; waited += 100) {
+        if (__atomic_load_n(flag, __ATOMIC_ACQUIRE) >= value) {
+            return true;
+        }
+        usleep(100);
+    }
+    return false;
+}
+
+/* 占住工作线程直到 release 置位 */
+typedef struct {
+    int started;
+    int release;
+} exec_gate_t;
+
+static void exec_gate_task(void* arg, const linx_cancel_token_t* token) {
+    (void)token;
+    exec_gate_t* gate = (exec_gate_t*)arg;
+    __atomic_store_n(&gate->started, 1, __ATOMIC_RELEASE);
+    exec_wait_for(&gate->release, 1);
+}
+
+/* ==================== 优先级 ==================== */
+
+typedef struct {
+    int order[8];
+    int count;
+    int done;                   // 写入 order 之后再计数，主线程据此等待
+} exec_order_t;
+
+typedef struct {
+    exec_order_t* order;
+    int id;
+} exec_order_arg_t;
+
+static void exec_order_task(void* arg, const linx_cancel_token_t* token) {
+    (void)token;
+    exec_order_arg_t* item = (exec_order_arg_t*)arg;
+    int index = __atomic_fetch_add(&item->order->count, 1, __ATOMIC_ACQ_REL);
+    if (index < 8) {
+        item->order->order[index] = item->id;
+    }
+    __atomic_fetch_add(&item->order->done, 1, __ATOMIC_RELEASE);
+}
+
+void test_executor_priority_order(void) {
+    TEST_CASE_START("Executor Priority Order");
+
+    linx_executor_config_t config = { .workers = 1 };
+    linx_executor_t* executor = linx_executor_create(&config);
+    TEST_ASSERT_NOT_NULL(executor);
+    if (!executor) {
+        return;
+    }
+
+    // 工作线程被占住时排队，放开后应先执行完全部高优先级再执行低优先级，同优先级先进先出
+    exec_gate_t gate = { 0 };
+    TEST_ASSERT(linx_executor_submit(executor, LINX_TASK_PRIORITY_NORMAL, exec_gate_task, &gate, NULL),
+                "Gate task submitted");
+    TEST_ASSERT(exec_wait_for(&gate.started, 1), "Gate task occupies the worker");
+
+    exec_order_t order = { { 0 }, 0, 0 };
+    static const linx_task_priority_t priorities[] = {
+        LINX_TASK_PRIORITY_LOW, LINX_TASK_PRIORITY_NORMAL, LINX_TASK_PRIORITY_HIGH,
+        LINX_TASK_PRIORITY_HIGH, LINX_TASK_PRIORITY_LOW, LINX_TASK_PRIORITY_NORMAL,
+    };
+    exec_order_arg_t args[6];
+    for (int i = 0; i < 6; i++) {
+        args[i].order = &order;
+        args[i].id = i;
+        linx_executor_submit(executor, priorities[i], exec_order_task, &args[i], NULL);
+    }
+    __atomic_store_n(&gate.release, 1, __ATOMIC_RELEASE);
+    TEST_ASSERT(exec_wait_for(&order.done, 6), "All queued tasks ran");
+
+    static const int expected[] = { 2, 3, 1, 5, 0, 4 };
+    TEST_ASSERT(memcmp(order.order, expected, sizeof(expected)) == 0,
+                "Tasks ran high -> normal -> low, FIFO within a priority");
+
+    linx_executor_destroy(executor);
+}
+
+/* ==================== 窃取 ==================== */
+
+#define EXEC_STEAL_CHILDREN 16
+
+typedef struct {
+    linx_executor_t* executor;
+    int parent_worker;
+    int children_done;
+    int children_on_other_worker;
+    int children_submitted;
+} exec_steal_t;
+
+static void exec_steal_child(void* arg, const linx_cancel_token_t* token) {
+    (void)token;
+    exec_steal_t* steal = (exec_steal_t*)arg;
+    if (linx_executor_current_worker(steal->executor) != steal->parent_worker) {
+        __atomic_fetch_add(&steal->children_on_other_worker, 1, __ATOMIC_RELAXED);
+    }
+    __atomic_fetch_add(&steal->children_done, 1, __ATOMIC_ACQ_REL);
+}
+
+/* 把子任务放进自己的队列后一直等待，子任务只能被另一个工作线程窃取执行 */
+static void exec_steal_parent(void* arg, const linx_cancel_token_t* token) {
+    (void)token;
+    exec_steal_t* steal = (exec_steal_t*)arg;
+    steal->parent_worker = linx_executor_current_worker(steal->executor);
+    int submitted = 0;
+    for (int i = 0; i < EXEC_STEAL_CHILDREN; i++) {
+        if (linx_executor_submit(steal->executor, LINX_TASK_PRIORITY_NORMAL, exec_steal_child, steal, NULL)) {
+            submitted++;
+        }
+    }
+    __atomic_store_n(&steal->children_submitted, submitted, __ATOMIC_RELEASE);
+    exec_wait_for(&steal->children_done, submitted);
+}
+
+void test_executor_work_stealing(void) {
+    TEST_CASE_START("Executor Work Stealing");
+
+    linx_executor_config_t config = { .workers = 2 };
+    linx_executor_t* executor = linx_executor_create(&config);
+    TEST_ASSERT_NOT_NULL(executor);
+    if (!executor) {
+        return;
+    }
+    TEST_ASSERT_EQUAL_INT(2, (int)linx_executor_worker_count(executor));
+    TEST_ASSERT_EQUAL_INT(-1, linx_executor_current_worker(executor));
+
+    exec_steal_t steal = { .executor = executor, .parent_worker = -1 };
+    TEST_ASSERT(linx_executor_submit(executor, LINX_TASK_PRIORITY_HIGH, exec_steal_parent, &steal, NULL),
+                "Parent task submitted");
+    TEST_ASSERT(exec_wait_for(&steal.children_done, EXEC_STEAL_CHILDREN), "All children ran");
+    TEST_ASSERT(exec_wait_for(&steal.children_submitted, EXEC_STEAL_CHILDREN), "Parent submitted every child");
+    TEST_ASSERT(steal.parent_worker == 0 || steal.parent_worker == 1, "Parent ran on a worker");
+    TEST_ASSERT_EQUAL_INT(EXEC_STEAL_CHILDREN, steal.children_on_other_worker);
+
+    linx_executor_stats_t stats;
+    TEST_ASSERT_TRUE(linx_executor_get_stats(executor, &stats));
+    TEST_ASSERT(stats.stolen >= EXEC_STEAL_CHILDREN, "Stolen tasks are counted");
+
+    linx_executor_destroy(executor);
+}
+
+/* ==================== 取消与销毁 ==================== */
+
+typedef struct {
+    int calls;
+    int cancelled_calls;
+    int null_token_calls;
+    pthread_t caller;
+} exec_cancel_t;
+
+static void exec_cancel_task(void* arg, const linx_cancel_token_t* token) {
+    exec_cancel_t* record = (exec_cancel_t*)arg;
+    __atomic_fetch_add(&record->calls, 1, __ATOMIC_ACQ_REL);
+    if (!token) {
+        __atomic_fetch_add(&record->null_token_calls, 1, __ATOMIC_RELAXED);
+    } else if (linx_cancel_token_is_cancelled(token)) {
+        __atomic_fetch_add(&record->cancelled_calls, 1, __ATOMIC_RELAXED);
+    }
+    record->caller = pthread_self();
+}
+
+void test_executor_cancelled_token(void) {
+    TEST_CASE_START("Executor Cancelled Token");
+
+    linx_executor_config_t config = { .workers = 1 };
+    linx_executor_t* executor = linx_executor_create(&config);
+    TEST_ASSERT_NOT_NULL(executor);
+    if (!executor) {
+        return;
+    }
+
+    // 开始前已取消的任务仍被调用一次，收到的是已取消的令牌
+    linx_cancel_token_t* token = linx_cancel_token_create();
+    TEST_ASSERT_NOT_NULL(token);
+    TEST_ASSERT_FALSE(linx_cancel_token_is_cancelled(token));
+    linx_cancel_token_cancel(token);
+    TEST_ASSERT_TRUE(linx_cancel_token_is_cancelled(token));
+    TEST_ASSERT_FALSE(linx_cancel_token_is_cancelled(NULL));
+
+    exec_cancel_t record = { 0 };
+    TEST_ASSERT(linx_executor_submit(executor, LINX_TASK_PRIORITY_NORMAL, exec_cancel_task, &record, token),
+                "Task with a cancelled token submitted");
+    linx_cancel_token_release(token);   // 执行器持有自己的引用
+    TEST_ASSERT(exec_wait_for(&record.calls, 1), "Task called once");
+    TEST_ASSERT_EQUAL_INT(1, record.cancelled_calls);
+
+    linx_executor_destroy(executor);
+}
+
+typedef struct {
+    linx_executor_t* executor;
+    int destroyed;
+} exec_destroy_arg_t;
+
+static void* exec_destroy_thread(void* arg) {
+    exec_destroy_arg_t* destroy = (exec_destroy_arg_t*)arg;
+    linx_executor_destroy(destroy->executor);
+    __atomic_store_n(&destroy->destroyed, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+static void exec_noop_task(void* arg, const linx_cancel_token_t* token) {
+    (void)arg;
+    (void)token;
+}
+
+void test_executor_shutdown_cancels_pending(void) {
+    TEST_CASE_START("Executor Shutdown Cancels Pending Tasks");
+
+    // 排队上限放宽，下面探测提交失败时只可能是因为正在销毁
+    linx_executor_config_t config = { .workers = 1, .max_pending = 100000 };
+    linx_executor_t* executor = linx_executor_create(&config);
+    TEST_ASSERT_NOT_NULL(executor);
+    if (!executor) {
+        return;
+    }
+
+    exec_gate_t gate = { 0 };
+    linx_executor_submit(executor, LINX_TASK_PRIORITY_NORMAL, exec_gate_task, &gate, NULL);
+    TEST_ASSERT(exec_wait_for(&gate.started, 1), "Gate task occupies the worker");
+
+    // 未开始的任务：一半附带用户令牌，一半不带
+    exec_cancel_t record = { 0 };
+    linx_cancel_token_t* token = linx_cancel_token_create();
+    for (int i = 0; i < 6; i++) {
+        linx_executor_submit(executor, (linx_task_priority_t)(i % LINX_TASK_PRIORITY_COUNT), exec_cancel_task,
+                             &record, i % 2 ? token : NULL);
+    }
+    linx_cancel_token_release(token);
+
+    // 另一线程开始销毁，提交失败说明 stopping 已置位，再放开正在执行的任务
+    exec_destroy_arg_t destroy = { executor, 0 };
+    pthread_t thread;
+    TEST_ASSERT(pthread_create(&thread, NULL, exec_destroy_thread, &destroy) == 0, "Destroy thread started");
+    bool rejected = false;
+    for (int waited = 0; waited < EXEC_WAIT_US && !rejected; waited += 100) {
+        rejected = !linx_executor_submit(executor, LINX_TASK_PRIORITY_HIGH, exec_noop_task, NULL, NULL);
+        if (!rejected) {
+            usleep(100);
+        }
+    }
+    TEST_ASSERT(rejected, "Submit fails once destroy has started");
+    TEST_ASSERT_EQUAL_INT(0, __atomic_load_n(&destroy.destroyed, __ATOMIC_ACQUIRE));
+    __atomic_store_n(&gate.release, 1, __ATOMIC_RELEASE);
+    pthread_join(thread, NULL);
+
+    TEST_ASSERT_EQUAL_INT(6, record.calls);
+    TEST_ASSERT_EQUAL_INT(6, record.cancelled_calls);
+    TEST_ASSERT_EQUAL_INT(0, record.null_token_calls);
+    TEST_ASSERT(pthread_equal(record.caller, thread), "Cancelled tasks ran on the destroying thread");
+}
+
+/* ==================== 提交与销毁并发 ==================== */
+
+#define EXEC_RACE_SUBMITTERS 4
+#define EXEC_RACE_MAX_PER_THREAD (1 << 20)   // 安全上限，正常在销毁时被拒绝而停止
+
+typedef struct {
+    linx_executor_t* executor;
+    int accepted;
+    int calls;
+    int submitters_done;
+} exec_race_t;
+
+static void exec_race_task(void* arg, const linx_cancel_token_t* token) {
+    (void)token;
+    exec_race_t* race = (exec_race_t*)arg;
+    __atomic_fetch_add(&race->calls, 1, __ATOMIC_ACQ_REL);
+}
+
+/* 提交直到被拒绝（max_pending 足够大，只有销毁会拒绝），之后不再调用执行器 */
+static void* exec_race_submitter(void* arg) {
+    exec_race_t* race = (exec_race_t*)arg;
+    for (int i = 0; i < EXEC_RACE_MAX_PER_THREAD; i++) {
+        if (!linx_executor_submit(race->executor, (linx_task_priority_t)(i % LINX_TASK_PRIORITY_COUNT),
+                                  exec_race_task, race, NULL)) {
+            break;
+        }
+        __atomic_fetch_add(&race->accepted, 1, __ATOMIC_ACQ_REL);
+    }
+    __atomic_fetch_add(&race->submitters_done, 1, __ATOMIC_ACQ_REL);
+    return NULL;
+}
+
+/* 占住唯一的工作线程，直到全部提交线程退出：销毁因此不会在有提交进行时返回 */
+static void exec_race_gate(void* arg, const linx_cancel_token_t* token) {
+    (void)token;
+    exec_race_t* race = (exec_race_t*)arg;
+    exec_wait_for(&race->submitters_done, EXEC_RACE_SUBMITTERS);
+}
+
+void test_executor_submit_during_destroy(void) {
+    TEST_CASE_START("Executor Submit During Destroy");
+
+    linx_executor_config_t config = {
+        .workers = 1,
+        .max_pending = EXEC_RACE_SUBMITTERS * EXEC_RACE_MAX_PER_THREAD + 1,
+    };
+    exec_race_t race = { 0 };
+    race.executor = linx_executor_create(&config);
+    TEST_ASSERT_NOT_NULL(race.executor);
+    if (!race.executor) {
+        return;
+    }
+    linx_executor_submit(race.executor, LINX_TASK_PRIORITY_HIGH, exec_race_gate, &race, NULL);
+
+    pthread_t submitters[EXEC_RACE_SUBMITTERS];
+    for (int i = 0; i < EXEC_RACE_SUBMITTERS; i++) {
+        pthread_create(&submitters[i], NULL, exec_race_submitter, &race);
+    }
+    // 提交进行到一半时销毁
+    exec_wait_for(&race.accepted, 2000);
+    linx_executor_destroy(race.executor);
+    for (int i = 0; i < EXEC_RACE_SUBMITTERS; i++) {
+        pthread_join(submitters[i], NULL);
+    }
+
+    printf("  accepted %d tasks before destroy\n", race.accepted);
+    TEST_ASSERT(race.accepted < EXEC_RACE_SUBMITTERS * EXEC_RACE_MAX_PER_THREAD,
+                "Some submissions were rejected by destroy");
+    TEST_ASSERT_EQUAL_INT(race.accepted, race.calls);
+}
+
+void run_executor_tests(void) {
+    TEST_SUITE_START("Executor Tests");
+
+    test_executor_priority_order();
+    test_executor_work_stealing();
+    test_executor_cancelled_token();
+    test_executor_shutdown_cancels_pending();
+    test_executor_submit_during_destroy();
+
+    TEST_SUITE_END("Executor Tests");
+}
+
+int main(void) {
+    test_init();
+    run_executor_tests();
+    test_summary();
+
+    // 检查内存泄漏
+    test_check_memory_leaks();
+
+    return (g_test_stats.failed_tests > 0) ? 1 : 0;
+}
@@ -8,7 +8,8 @@ static char* received_messages[10];
 static int message_count = 0;
 
 // 测试消息接收回调
-void integration_test_send_callback(const char* message) {
+void integration_test_send_callback(const char* message, void* user_data) {
+    (void)user_data;
     if (message_count < 10) {
         received_messages[message_count] = mcp_strdup(message);
         message_count++;
@@ -111,7 +112,7 @@ void test_complete_mcp_workflow() {
     TEST_ASSERT(server != NULL, "Server creation failed");
     
     // 2. 设置消息回调
-    mcp_server_set_send_callback(integration_test_send_callback);
+    mcp_server_set_send_handler(server, integration_test_send_callback, NULL);
     
     // 3. 创建并添加计算器工具
     mcp_property_list_t* calc_props = mcp_property_list_create();
@@ -190,7 +191,7 @@ void test_property_validation_integration() {
     mcp_server_t* server = mcp_server_create("Validation Test Server", "1.0.0");
     TEST_ASSERT(server != NULL, "Server creation failed");
     
-    mcp_server_set_send_callback(integration_test_send_callback);
+    mcp_server_set_send_handler(server, integration_test_send_callback, NULL);
     
     // 创建带有复杂验证规则的工具
     mcp_property_list_t* props = mcp_property_list_create();
@@ -293,7 +294,7 @@ void test_error_handling_integration() {
     mcp_server_t* server = mcp_server_create("Error Test Server", "1.0.0");
     TEST_ASSERT(server != NULL, "Server creation failed");
     
-    mcp_server_set_send_callback(integration_test_send_callback);
+    mcp_server_set_send_handler(server, integration_test_send_callback, NULL);
     
     // 测试调用不存在的工具
     const char* nonexistent_msg = "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"tools/call\",\"params\":{\"name\":\"nonexistent_tool\",\"arguments\":{}}}";
@@ -244,6 +244,63 @@ void test_property_edge_cases() {
     mcp_property_destroy(prop);
 }
 
+// 测试属性列表扩容与从JSON生成
+void test_property_list_compact() {
+    printf("Testing compact property list storage...\n");
+    
+    // 超出内联容量后扩容，名称保持有效
+    mcp_property_list_t* list = mcp_property_list_create();
+    TEST_ASSERT(list != NULL, "Property list creation failed");
+    TEST_ASSERT(list->properties == list->inline_properties, "Small list should use inline storage");
+    for (int i = 0; i < MCP_MAX_PROPERTIES; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "prop_%d", i);
+        mcp_property_t* prop = mcp_property_create_integer(name, i, true, false, 0, 0);
+        TEST_ASSERT(mcp_property_list_add(list, prop), "Property list add failed");
+        mcp_property_destroy(prop);
+    }
+    TEST_ASSERT(list->properties != list->inline_properties, "Large list should move to the heap");
+    mcp_property_t* extra = mcp_property_create_boolean("extra", true, true);
+    TEST_ASSERT(!mcp_property_list_add(list, extra), "Adding beyond MCP_MAX_PROPERTIES should fail");
+    mcp_property_destroy(extra);
+    const mcp_property_t* found = mcp_property_list_find(list, "prop_0");
+    TEST_ASSERT(found != NULL && mcp_property_get_int_value(found) == 0, "First property lost after growth");
+    found = mcp_property_list_find(list, "prop_31");
+    TEST_ASSERT(found != NULL && mcp_property_get_int_value(found) == 31, "Last property not found");
+    
+    mcp_property_list_t* cloned = mcp_property_list_clone(list);
+    TEST_ASSERT(cloned != NULL && cloned->count == list->count, "Clone count mismatch");
+    mcp_property_list_destroy(list);
+    found = mcp_property_list_find(cloned, "prop_17");
+    TEST_ASSERT(found != NULL && mcp_property_get_int_value(found) == 17, "Clone should own its names");
+    mcp_property_list_destroy(cloned);
+    
+    // 从 arguments 生成，借用模式不复制字符串
+    cJSON* arguments = cJSON_Parse("{\"city\":\"Beijing\",\"days\":3,\"metric\":true,\"ignored\":[1],\"city\":\"dup\"}");
+    TEST_ASSERT(arguments != NULL, "Arguments parse failed");
+    
+    list = mcp_property_list_create_from_json(arguments, true);
+    TEST_ASSERT(list != NULL && list->count == 3, "Borrowed list should hold the scalar arguments");
+    TEST_ASSERT(list->borrowed, "List should be marked borrowed");
+    found = mcp_property_list_find(list, "city");
+    TEST_ASSERT(found != NULL && found->value.string_val == cJSON_GetObjectItem(arguments, "city")->valuestring,
+                "Borrowed string should point into the JSON");
+    TEST_ASSERT(mcp_property_list_find_mutable(list, "city") == NULL, "Borrowed list should be read-only");
+    TEST_ASSERT(mcp_property_get_int_value(mcp_property_list_find(list, "days")) == 3, "Integer argument mismatch");
+    TEST_ASSERT(mcp_property_get_bool_value(mcp_property_list_find(list, "metric")), "Boolean argument mismatch");
+    mcp_property_list_destroy(list);
+    
+    // 复制模式在 JSON 释放后仍然可用
+    list = mcp_property_list_create_from_json(arguments, false);
+    cJSON_Delete(arguments);
+    TEST_ASSERT(list != NULL && list->count == 3, "Owned list should hold the scalar arguments");
+    TEST_ASSERT(strcmp(mcp_property_get_string_value(mcp_property_list_find(list, "city")), "Beijing") == 0,
+                "Owned string should survive the JSON");
+    mcp_property_list_destroy(list);
+    
+    TEST_ASSERT(mcp_property_list_create_from_json(NULL, true) == NULL, "NULL arguments should give NULL");
+}
+
 // 运行所有属性测试
 void run_property_tests() {
     printf("\n=== Running Property Tests ===\n");
@@ -255,6 +312,7 @@ void run_property_tests() {
     test_property_serialization();
     test_property_list_serialization();
     test_property_edge_cases();
+    test_property_list_compact();
     
     printf("=== Property Tests Complete ===\n\n");
 }
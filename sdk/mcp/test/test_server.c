@@ -3,13 +3,19 @@
 #include "../mcp_types.h"
 #include "../mcp_tool.h"
 #include "../mcp_property.h"
+#include "../mcp_arguments.h"
+#include "../mcp_static_tool.h"
+#include "../../cjson/cJSON_Utils.h"
 #include <string.h>
 #include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
 
 // 测试消息发送回调函数
 static char* last_sent_message = NULL;
 
-void test_send_callback(const char* message) {
+void test_send_callback(const char* message, void* user_data) {
+    (void)user_data;
     if (last_sent_message) {
         free(last_sent_message);
     }
@@ -45,9 +51,123 @@ mcp_return_value_t echo_tool_callback(const mcp_property_list_t* properties) {
     return result;
 }
 
+// 异步工具测试：工作线程也会调用发送回调，需要加锁
+static pthread_mutex_t async_mutex = PTHREAD_MUTEX_INITIALIZER;
+static char* async_messages[8];
+static int async_message_count = 0;
+static int async_release = 0;
+
+void async_send_callback(const char* message, void* user_data) {
+    (void)user_data;
+    pthread_mutex_lock(&async_mutex);
+    if (async_message_count < 8) {
+        async_messages[async_message_count++] = mcp_strdup(message);
+    }
+    pthread_mutex_unlock(&async_mutex);
+}
+
+static void async_reset_messages(void) {
+    pthread_mutex_lock(&async_mutex);
+    for (int i = 0; i < async_message_count; i++) {
+        free(async_messages[i]);
+        async_messages[i] = NULL;
+    }
+    async_message_count = 0;
+    pthread_mutex_unlock(&async_mutex);
+}
+
+// 等待收到指定数量的消息，最多等待 timeout_ms
+static int async_wait_messages(int count, int timeout_ms) {
+    for (int waited = 0; waited < timeout_ms; waited += 5) {
+        pthread_mutex_lock(&async_mutex);
+        int current = async_message_count;
+        pthread_mutex_unlock(&async_mutex);
+        if (current >= count) {
+            return current;
+        }
+        usleep(5000);
+    }
+    pthread_mutex_lock(&async_mutex);
+    int current = async_message_count;
+    pthread_mutex_unlock(&async_mutex);
+    return current;
+}
+
+static int async_find_message(const char* needle) {
+    int found = -1;
+    pthread_mutex_lock(&async_mutex);
+    for (int i = 0; i < async_message_count; i++) {
+        if (strstr(async_messages[i], needle)) {
+            found = i;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&async_mutex);
+    return found;
+}
+
+// 阻塞到 async_release 置位才返回
+mcp_return_value_t blocking_tool_callback(const mcp_property_list_t* properties) {
+    (void)properties;
+    while (!__atomic_load_n(&async_release, __ATOMIC_ACQUIRE)) {
+        usleep(1000);
+    }
+    return mcp_return_string("blocking done");
+}
+
+// 参数视图工具：读取浮点数、64位整数和数组
+mcp_return_value_t scale_args_callback(const mcp_arguments_t* args) {
+    double factor = mcp_arguments_get_double(args, "factor", 0.0);
+    int64_t offset = mcp_arguments_get_int64(args, "offset", -1);
+    const cJSON* values = mcp_arguments_get_array(args, "values");
+    double sum = 0.0;
+    const cJSON* item = NULL;
+    cJSON_ArrayForEach(item, values) {
+        sum += cJSON_IsNumber(item) ? item->valuedouble : 0.0;
+    }
+    
+    char* output = malloc(128);
+    snprintf(output, 128, "scaled=%.2f offset=%lld label=%s", sum * factor, (long long)offset,
+             mcp_arguments_get_string(args, "label", "none"));
+    mcp_return_value_t result;
+    result.type = MCP_RETURN_TYPE_STRING;
+    result.value.string_val = output;
+    return result;
+}
+
+// 返回原始数据形式的图像
+mcp_return_value_t snapshot_tool_callback(const mcp_property_list_t* properties) {
+    (void)properties;
+    return mcp_return_image(mcp_image_content_create_raw("image/jpeg", "ABCDE", 5));
+}
+
+// 实例发送回调：按 user_data 记录最后一条消息
+typedef struct {
+    char* last_message;
+    int count;
+} instance_sink_t;
+
+void instance_send_handler(const char* message, void* user_data) {
+    instance_sink_t* sink = (instance_sink_t*)user_data;
+    free(sink->last_message);
+    sink->last_message = mcp_strdup(message);
+    sink->count++;
+}
+
+// 统计调用次数的只读工具
+static int status_calls = 0;
+
+mcp_return_value_t status_tool_callback(const mcp_property_list_t* properties) {
+    (void)properties;
+    int calls = __atomic_add_fetch(&status_calls, 1, __ATOMIC_SEQ_CST);
+    return mcp_return_int(calls);
+}
+
 // 测试能力回调函数
+static int camera_callback_calls = 0;
+
 void test_camera_set_explain_url(const char* url, const char* token) {
-    // 这里可以添加测试逻辑
+    camera_callback_calls++;
     printf("Camera explain URL set: %s with token: %s\n", url, token);
 }
 
@@ -175,7 +295,7 @@ void test_server_message_handling() {
     TEST_ASSERT(server != NULL, "Server creation failed");
     
     // 设置消息发送回调
-    mcp_server_set_send_callback(test_send_callback);
+    mcp_server_set_send_handler(server, test_send_callback, NULL);
     
     // 测试初始化消息
     const char* init_message = "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"initialize\",\"params\":{\"protocolVersion\":\"2024-11-05\",\"capabilities\":{}}}";
@@ -218,7 +338,7 @@ void test_server_tool_call() {
     TEST_ASSERT(server != NULL, "Server creation failed");
     
     // 设置消息发送回调
-    mcp_server_set_send_callback(test_send_callback);
+    mcp_server_set_send_handler(server, test_send_callback, NULL);
     
     // 添加echo工具
     mcp_property_list_t* properties = mcp_property_list_create();
@@ -244,6 +364,243 @@ void test_server_tool_call() {
     mcp_server_destroy(server);
 }
 
+// 测试图像结果直接编码进响应
+void test_server_image_tool_call() {
+    printf("Testing server image tool call...\n");
+    
+    mcp_server_t* server = mcp_server_create("test_server", "1.0.0");
+    TEST_ASSERT(server != NULL, "Server creation failed");
+    mcp_server_set_send_handler(server, test_send_callback, NULL);
+    TEST_ASSERT(mcp_server_add_simple_tool(server, "snapshot", "Snapshot tool", NULL, snapshot_tool_callback),
+                "Failed to add image tool");
+    
+    mcp_server_parse_message(server, "{\"jsonrpc\":\"2.0\",\"id\":9,\"method\":\"tools/call\",\"params\":{\"name\":\"snapshot\"}}");
+    TEST_ASSERT(last_sent_message != NULL, "No image response sent");
+    TEST_ASSERT_EQUAL_STR("{\"jsonrpc\":\"2.0\",\"id\":9,\"result\":{\"content\":[{\"type\":\"image\",\"mimeType\":\"image/jpeg\",\"data\":\"QUJDREU=\"}],\"isError\":false}}",
+                          last_sent_message);
+    
+    free(last_sent_message);
+    last_sent_message = NULL;
+    mcp_server_destroy(server);
+}
+
+// 测试每个服务器实例独立的发送回调
+void test_server_instance_send_handler() {
+    printf("Testing per-instance send handler...\n");
+    
+    mcp_server_t* first = mcp_server_create("first", "1.0.0");
+    mcp_server_t* second = mcp_server_create("second", "1.0.0");
+    TEST_ASSERT(first != NULL && second != NULL, "Server creation failed");
+    
+    instance_sink_t first_sink = { NULL, 0 };
+    instance_sink_t second_sink = { NULL, 0 };
+    mcp_server_set_send_handler(first, instance_send_handler, &first_sink);
+    mcp_server_set_send_handler(second, instance_send_handler, &second_sink);
+    
+    mcp_server_parse_message(first, "{\"jsonrpc\":\"2.0\",\"id\":21,\"method\":\"initialize\",\"params\":{}}");
+    mcp_server_parse_message(second, "{\"jsonrpc\":\"2.0\",\"id\":22,\"method\":\"initialize\",\"params\":{}}");
+    
+    // 回复只经过各自的实例回调，不经过全局回调
+    TEST_ASSERT(first_sink.count == 1 && strstr(first_sink.last_message, "\"id\":21") != NULL,
+                "First server reply not routed to its handler");
+    TEST_ASSERT(second_sink.count == 1 && strstr(second_sink.last_message, "\"id\":22") != NULL,
+                "Second server reply not routed to its handler");
+    TEST_ASSERT(strstr(second_sink.last_message, "\"second\"") != NULL, "Wrong server info in reply");
+    TEST_ASSERT(last_sent_message == NULL, "Other handlers should not be used");
+    
+    // 清除实例回调后不再发送，也不会串到其他服务器
+    mcp_server_set_send_handler(first, NULL, NULL);
+    mcp_server_parse_message(first, "{\"jsonrpc\":\"2.0\",\"id\":23,\"method\":\"initialize\",\"params\":{}}");
+    TEST_ASSERT(first_sink.count == 1, "Cleared handler should not be called");
+    TEST_ASSERT(second_sink.count == 1, "Reply must not reach another server's handler");
+    
+    free(first_sink.last_message);
+    free(second_sink.last_message);
+    free(last_sent_message);
+    last_sent_message = NULL;
+    mcp_server_destroy(first);
+    mcp_server_destroy(second);
+}
+
+// 测试异步工具调用
+void test_server_async_tool_call() {
+    printf("Testing server async tool call...\n");
+    
+    mcp_server_t* server = mcp_server_create("test_server", "1.0.0");
+    TEST_ASSERT(server != NULL, "Server creation failed");
+    mcp_server_set_send_handler(server, async_send_callback, NULL);
+    async_reset_messages();
+    
+    mcp_property_list_t* properties = mcp_property_list_create();
+    mcp_property_list_add(properties, mcp_property_create_string("message", NULL, false));
+    TEST_ASSERT(mcp_server_add_async_tool(server, "echo", "Echo tool", properties, echo_tool_callback, 1, 0),
+                "Failed to add async tool");
+    
+    const mcp_tool_t* tool = mcp_server_find_tool(server, "echo");
+    TEST_ASSERT(tool != NULL && mcp_tool_is_async(tool), "Tool should be async");
+    
+    // 没有线程池时退化为同步执行
+    const char* call = "{\"jsonrpc\":\"2.0\",\"id\":7,\"method\":\"tools/call\",\"params\":{\"name\":\"echo\",\"arguments\":{\"message\":\"sync\"}}}";
+    mcp_server_parse_message(server, call);
+    TEST_ASSERT(async_find_message("Echo: sync") >= 0, "Async tool without workers should run inline");
+    async_reset_messages();
+    
+    // 有线程池时在工作线程中执行并回复
+    TEST_ASSERT(mcp_server_start_workers(server, 2, 4), "Failed to start workers");
+    call = "{\"jsonrpc\":\"2.0\",\"id\":8,\"method\":\"tools/call\",\"params\":{\"name\":\"echo\",\"arguments\":{\"message\":\"async\"}}}";
+    mcp_server_parse_message(server, call);
+    TEST_ASSERT(async_wait_messages(1, 2000) == 1, "No async tool response");
+    TEST_ASSERT(async_find_message("Echo: async") >= 0, "Async tool response not correct");
+    TEST_ASSERT(async_find_message("\"id\":8") >= 0, "Async response has wrong id");
+    
+    async_reset_messages();
+    mcp_server_destroy(server);
+}
+
+// 测试异步工具并发上限
+void test_server_async_tool_busy() {
+    printf("Testing server async tool concurrency limit...\n");
+    
+    mcp_server_t* server = mcp_server_create("test_server", "1.0.0");
+    TEST_ASSERT(server != NULL, "Server creation failed");
+    mcp_server_set_send_handler(server, async_send_callback, NULL);
+    async_reset_messages();
+    __atomic_store_n(&async_release, 0, __ATOMIC_RELEASE);
+    
+    TEST_ASSERT(mcp_server_add_async_tool(server, "block", "Blocking tool", NULL, blocking_tool_callback, 1, 5000),
+                "Failed to add async tool");
+    TEST_ASSERT(mcp_server_start_workers(server, 2, 4), "Failed to start workers");
+    
+    mcp_server_parse_message(server, "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"tools/call\",\"params\":{\"name\":\"block\"}}");
+    mcp_server_parse_message(server, "{\"jsonrpc\":\"2.0\",\"id\":2,\"method\":\"tools/call\",\"params\":{\"name\":\"block\"}}");
+    
+    // 第二次调用超出并发上限，立即回复忙
+    TEST_ASSERT(async_wait_messages(1, 100) == 1, "Busy call should be rejected immediately");
+    int busy = async_find_message("busy");
+    TEST_ASSERT(busy >= 0 && strstr(async_messages[busy], "\"id\":2") != NULL, "Second call should report busy");
+    
+    __atomic_store_n(&async_release, 1, __ATOMIC_RELEASE);
+    TEST_ASSERT(async_wait_messages(2, 2000) == 2, "First call should complete");
+    TEST_ASSERT(async_find_message("blocking done") >= 0, "First call result missing");
+    
+    async_reset_messages();
+    mcp_server_destroy(server);
+}
+
+// 测试异步工具超时
+void test_server_async_tool_timeout() {
+    printf("Testing server async tool timeout...\n");
+    
+    mcp_server_t* server = mcp_server_create("test_server", "1.0.0");
+    TEST_ASSERT(server != NULL, "Server creation failed");
+    mcp_server_set_send_handler(server, async_send_callback, NULL);
+    async_reset_messages();
+    __atomic_store_n(&async_release, 0, __ATOMIC_RELEASE);
+    
+    TEST_ASSERT(mcp_server_add_async_tool(server, "block", "Blocking tool", NULL, blocking_tool_callback, 1, 50),
+                "Failed to add async tool");
+    TEST_ASSERT(mcp_server_start_workers(server, 1, 4), "Failed to start workers");
+    
+    mcp_server_parse_message(server, "{\"jsonrpc\":\"2.0\",\"id\":5,\"method\":\"tools/call\",\"params\":{\"name\":\"block\"}}");
+    TEST_ASSERT(async_wait_messages(1, 2000) == 1, "Timeout error not sent");
+    TEST_ASSERT(async_find_message("timed out") >= 0, "Expected timeout error");
+    
+    // 迟到的结果被丢弃，名额归还后可以再次调用
+    __atomic_store_n(&async_release, 1, __ATOMIC_RELEASE);
+    usleep(50000);
+    TEST_ASSERT(async_find_message("blocking done") < 0, "Late result should be dropped");
+    
+    mcp_server_parse_message(server, "{\"jsonrpc\":\"2.0\",\"id\":6,\"method\":\"tools/call\",\"params\":{\"name\":\"block\"}}");
+    TEST_ASSERT(async_wait_messages(2, 2000) == 2, "Tool should accept calls after a timeout");
+    TEST_ASSERT(async_find_message("blocking done") >= 0, "Second call result missing");
+    
+    async_reset_messages();
+    mcp_server_destroy(server);
+}
+
+// 测试工具移除与热替换
+void test_server_tool_remove_replace() {
+    printf("Testing server tool remove and replace...\n");
+    
+    mcp_server_t* server = mcp_server_create("test_server", "1.0.0");
+    TEST_ASSERT(server != NULL, "Server creation failed");
+    mcp_server_set_send_handler(server, test_send_callback, NULL);
+    
+    for (int i = 0; i < 200; i++) {
+        char tool_name[32];
+        snprintf(tool_name, sizeof(tool_name), "device_%d", i);
+        TEST_ASSERT(mcp_server_add_simple_tool(server, tool_name, "Device tool", NULL, test_server_tool_callback),
+                    "Failed to add device tool");
+    }
+    TEST_ASSERT(server->tool_count == 200, "Server should have 200 tools");
+    
+    // 移除后查找失败，其余工具保持注册顺序
+    TEST_ASSERT(mcp_server_remove_tool(server, "device_10"), "Failed to remove tool");
+    TEST_ASSERT(!mcp_server_remove_tool(server, "device_10"), "Removing twice should fail");
+    TEST_ASSERT(server->tool_count == 199, "Tool count should drop after removal");
+    TEST_ASSERT(mcp_server_find_tool(server, "device_10") == NULL, "Removed tool still found");
+    TEST_ASSERT(strcmp(server->tools[10]->name, "device_11") == 0, "Registration order not kept");
+    for (int i = 0; i < 200; i++) {
+        char tool_name[32];
+        snprintf(tool_name, sizeof(tool_name), "device_%d", i);
+        if (i != 10) {
+            TEST_ASSERT(mcp_server_find_tool(server, tool_name) != NULL, "Tool lost after removal");
+        }
+    }
+    
+    // 同名替换保留位置，调用走新回调
+    mcp_tool_t* echo = mcp_tool_create("device_5", "Echo device", NULL, echo_tool_callback);
+    TEST_ASSERT(mcp_server_replace_tool(server, echo), "Failed to replace tool");
+    TEST_ASSERT(server->tool_count == 199, "Replace should not change tool count");
+    TEST_ASSERT(server->tools[5] == echo, "Replaced tool should keep its position");
+    TEST_ASSERT(mcp_server_find_tool(server, "device_5") == echo, "Lookup should return the new tool");
+    
+    mcp_server_parse_message(server, "{\"jsonrpc\":\"2.0\",\"id\":9,\"method\":\"tools/call\",\"params\":{\"name\":\"device_5\"}}");
+    TEST_ASSERT(last_sent_message != NULL && strstr(last_sent_message, "No parameters") != NULL,
+                "Call should use the replacement tool");
+    
+    // 替换不存在的工具等同于添加，移除后可以重新注册
+    mcp_tool_t* added = mcp_tool_create("device_new", "New device", NULL, test_server_tool_callback);
+    TEST_ASSERT(mcp_server_replace_tool(server, added), "Replace should add a missing tool");
+    TEST_ASSERT(server->tools[server->tool_count - 1] == added, "New tool should be appended");
+    TEST_ASSERT(mcp_server_add_simple_tool(server, "device_10", "Device tool", NULL, test_server_tool_callback),
+                "Removed tool name should be reusable");
+    
+    if (last_sent_message) {
+        free(last_sent_message);
+        last_sent_message = NULL;
+    }
+    mcp_server_destroy(server);
+}
+
+// 测试移除仍在执行的异步工具
+void test_server_remove_running_async_tool() {
+    printf("Testing removal of a running async tool...\n");
+    
+    mcp_server_t* server = mcp_server_create("test_server", "1.0.0");
+    TEST_ASSERT(server != NULL, "Server creation failed");
+    mcp_server_set_send_handler(server, async_send_callback, NULL);
+    async_reset_messages();
+    __atomic_store_n(&async_release, 0, __ATOMIC_RELEASE);
+    
+    TEST_ASSERT(mcp_server_add_async_tool(server, "block", "Blocking tool", NULL, blocking_tool_callback, 1, 5000),
+                "Failed to add async tool");
+    TEST_ASSERT(mcp_server_start_workers(server, 1, 4), "Failed to start workers");
+    
+    mcp_server_parse_message(server, "{\"jsonrpc\":\"2.0\",\"id\":11,\"method\":\"tools/call\",\"params\":{\"name\":\"block\"}}");
+    usleep(20000);
+    TEST_ASSERT(mcp_server_remove_tool(server, "block"), "Failed to remove running tool");
+    TEST_ASSERT(mcp_server_find_tool(server, "block") == NULL, "Removed tool still found");
+    
+    // 执行中的调用仍然完成并回复
+    __atomic_store_n(&async_release, 1, __ATOMIC_RELEASE);
+    TEST_ASSERT(async_wait_messages(1, 2000) == 1, "Running call should still reply");
+    TEST_ASSERT(async_find_message("blocking done") >= 0, "Running call result missing");
+    
+    async_reset_messages();
+    mcp_server_destroy(server);
+}
+
 // 测试能力配置
 void test_server_capabilities() {
     printf("Testing server capabilities...\n");
@@ -275,6 +632,55 @@ void test_server_capabilities() {
     mcp_server_destroy(server);
 }
 
+// 测试重复的 initialize：响应复用，相同的能力配置不再解析
+void test_server_initialize_cache() {
+    printf("Testing server initialize cache...\n");
+    
+    mcp_server_t* server = mcp_server_create("test_server", "1.0.0");
+    TEST_ASSERT(server != NULL, "Server creation failed");
+    mcp_server_set_send_handler(server, async_send_callback, NULL);
+    async_reset_messages();
+    mcp_capability_callbacks_t callbacks;
+    memset(&callbacks, 0, sizeof(callbacks));
+    callbacks.camera_set_explain_url = test_camera_set_explain_url;
+    mcp_server_set_capability_callbacks(server, &callbacks);
+    camera_callback_calls = 0;
+    
+    const char* init = "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"initialize\",\"params\":{\"capabilities\":"
+                       "{\"camera\":{\"explain_url\":\"http://a/explain\",\"token\":\"t1\"},\"stateSync\":{\"mergePatch\":true}}}}";
+    mcp_server_parse_message(server, init);
+    TEST_ASSERT(camera_callback_calls == 1, "First initialize should parse capabilities");
+    TEST_ASSERT(async_message_count >= 1 && strstr(async_messages[0], "\"serverInfo\":{\"name\":\"test_server\",\"version\":\"1.0.0\"}") != NULL,
+                "Initialize reply mismatch");
+    char* first_reply = mcp_strdup(async_messages[0]);
+    async_reset_messages();
+    
+    // 重连：相同的能力配置（空白不同）跳过解析，但沿用状态同步的声明
+    mcp_server_parse_message(server, "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"initialize\",\"params\":{\"capabilities\": "
+                             "{\"camera\": {\"explain_url\": \"http://a/explain\", \"token\": \"t1\"}, \"stateSync\": {\"mergePatch\": true}}}}");
+    TEST_ASSERT(camera_callback_calls == 1, "Identical capabilities should not be parsed again");
+    TEST_ASSERT(server->client_state_sync, "Cached capabilities should keep state sync enabled");
+    TEST_ASSERT(async_message_count >= 2, "State sync should still start after a cached initialize");
+    TEST_ASSERT(strcmp(async_messages[0], first_reply) == 0, "Cached reply should be identical");
+    free(first_reply);
+    async_reset_messages();
+    
+    // 令牌变化时重新解析
+    mcp_server_parse_message(server, "{\"jsonrpc\":\"2.0\",\"id\":2,\"method\":\"initialize\",\"params\":{\"capabilities\":"
+                             "{\"camera\":{\"explain_url\":\"http://a/explain\",\"token\":\"t2\"}}}}");
+    TEST_ASSERT(camera_callback_calls == 2, "Changed capabilities should be parsed");
+    TEST_ASSERT(!server->client_state_sync, "State sync should follow the new capabilities");
+    
+    // 重新设置回调后即使配置相同也要解析一次
+    mcp_server_set_capability_callbacks(server, &callbacks);
+    mcp_server_parse_message(server, "{\"jsonrpc\":\"2.0\",\"id\":3,\"method\":\"initialize\",\"params\":{\"capabilities\":"
+                             "{\"camera\":{\"explain_url\":\"http://a/explain\",\"token\":\"t2\"}}}}");
+    TEST_ASSERT(camera_callback_calls == 3, "New callbacks should receive the capabilities");
+    
+    async_reset_messages();
+    mcp_server_destroy(server);
+}
+
 // 测试工具列表JSON生成
 void test_server_tools_list_json() {
     printf("Testing server tools list JSON generation...\n");
@@ -305,7 +711,639 @@ void test_server_tools_list_json() {
     mcp_server_destroy(server);
 }
 
+// 测试工具列表缓存与分页
+void test_server_tools_list_pagination() {
+    printf("Testing server tools list cache and pagination...\n");
+    
+    mcp_server_t* server = mcp_server_create("test_server", "1.0.0");
+    TEST_ASSERT(server != NULL, "Server creation failed");
+    
+    // 每个工具约 300 字节，100 个工具需要分多页
+    char description[256];
+    memset(description, 'd', sizeof(description) - 1);
+    description[sizeof(description) - 1] = '\0';
+    for (int i = 0; i < 100; i++) {
+        char tool_name[32];
+        snprintf(tool_name, sizeof(tool_name), "page_tool_%03d", i);
+        mcp_server_add_simple_tool(server, tool_name, description, NULL, test_server_tool_callback);
+    }
+    
+    char* json = mcp_server_get_tools_list_json(server, NULL, false);
+    TEST_ASSERT(json != NULL, "First page generation failed");
+    TEST_ASSERT(server->tools_list_cache[0].json != NULL, "Tools list should be cached");
+    const char* cached = server->tools_list_cache[0].json;
+    
+    int seen = 0;
+    int pages = 0;
+    char cursor[32] = "";
+    while (json) {
+        pages++;
+        cJSON* root = cJSON_Parse(json);
+        TEST_ASSERT(root != NULL, "Page is not valid JSON");
+        TEST_ASSERT(strlen(json) < MCP_TOOLS_LIST_MAX_PAYLOAD + 64, "Page exceeds payload limit");
+        cJSON* tools = cJSON_GetObjectItem(root, "tools");
+        cJSON* item = NULL;
+        cJSON_ArrayForEach(item, tools) {
+            char expected[32];
+            snprintf(expected, sizeof(expected), "page_tool_%03d", seen);
+            TEST_ASSERT(strcmp(cJSON_GetObjectItem(item, "name")->valuestring, expected) == 0,
+                        "Tools should be listed in registration order");
+            seen++;
+        }
+        cJSON* next = cJSON_GetObjectItem(root, "nextCursor");
+        bool more = next && cJSON_IsString(next);
+        if (more) {
+            snprintf(cursor, sizeof(cursor), "%s", next->valuestring);
+        }
+        cJSON_Delete(root);
+        free(json);
+        json = more ? mcp_server_get_tools_list_json(server, cursor, false) : NULL;
+    }
+    TEST_ASSERT(seen == 100, "All tools should be listed across pages");
+    TEST_ASSERT(pages > 1, "Large tool list should be paginated");
+    TEST_ASSERT(server->tools_list_cache[0].json == cached, "Paging should reuse the cache");
+    
+    // 无效游标
+    TEST_ASSERT(mcp_server_get_tools_list_json(server, "1", false) == NULL, "Cursor inside a tool should be rejected");
+    TEST_ASSERT(mcp_server_get_tools_list_json(server, "abc", false) == NULL, "Non-numeric cursor should be rejected");
+    
+    // 增删工具后缓存失效
+    mcp_server_add_user_only_tool(server, "late_tool", "Late tool", NULL, test_server_tool_callback);
+    TEST_ASSERT(server->tools_list_cache[0].json == NULL, "Adding a tool should invalidate the cache");
+    json = mcp_server_get_tools_list_json(server, NULL, true);
+    TEST_ASSERT(json != NULL && strstr(json, "late_tool") != NULL, "User-only list should contain the new tool");
+    TEST_ASSERT(strstr(json, "nextCursor") == NULL, "Single page should have no cursor");
+    free(json);
+    mcp_server_remove_tool(server, "late_tool");
+    TEST_ASSERT(server->tools_list_cache[1].json == NULL, "Removing a tool should invalidate the cache");
+    json = mcp_server_get_tools_list_json(server, NULL, true);
+    TEST_ASSERT(json != NULL && strcmp(json, "{\"tools\":[]}") == 0, "User-only list should be empty");
+    free(json);
+    
+    mcp_server_destroy(server);
+}
+
+// 测试接收参数视图的工具
+void test_server_args_tool_call() {
+    printf("Testing server args tool call...\n");
+    
+    mcp_server_t* server = mcp_server_create("test_server", "1.0.0");
+    TEST_ASSERT(server != NULL, "Server creation failed");
+    mcp_server_set_send_handler(server, async_send_callback, NULL);
+    async_reset_messages();
+    
+    mcp_property_list_t* properties = mcp_property_list_create();
+    mcp_property_list_add(properties, mcp_property_create_number("factor", 0.0, false));
+    mcp_property_list_add(properties, mcp_property_create_integer("offset", 5, true, true, 0, 100));
+    mcp_property_list_add(properties, mcp_property_create_string("label", "none", true));
+    TEST_ASSERT(mcp_server_add_tool_with_args(server, "scale", "Scale tool", properties, scale_args_callback),
+                "Failed to add args tool");
+    TEST_ASSERT(mcp_tool_call(mcp_server_find_tool(server, "scale"), NULL) == NULL,
+                "Args tool should not run through mcp_tool_call");
+    
+    // 浮点数不被截断，缺失的参数取声明的默认值
+    mcp_server_parse_message(server, "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"tools/call\",\"params\":{\"name\":\"scale\",\"arguments\":{\"factor\":0.5,\"values\":[1,2.5,3]}}}");
+    TEST_ASSERT(async_find_message("scaled=3.25 offset=5 label=none") >= 0, "Args tool response not correct");
+    async_reset_messages();
+    
+    // 校验失败时回调不执行
+    mcp_server_parse_message(server, "{\"jsonrpc\":\"2.0\",\"id\":2,\"method\":\"tools/call\",\"params\":{\"name\":\"scale\",\"arguments\":{\"offset\":1}}}");
+    TEST_ASSERT(async_find_message("Missing required argument: factor") >= 0, "Missing argument not reported");
+    async_reset_messages();
+    mcp_server_parse_message(server, "{\"jsonrpc\":\"2.0\",\"id\":3,\"method\":\"tools/call\",\"params\":{\"name\":\"scale\",\"arguments\":{\"factor\":1,\"offset\":500}}}");
+    TEST_ASSERT(async_find_message("out of range") >= 0, "Out-of-range argument not reported");
+    async_reset_messages();
+    mcp_server_parse_message(server, "{\"jsonrpc\":\"2.0\",\"id\":4,\"method\":\"tools/call\",\"params\":{\"name\":\"scale\",\"arguments\":{\"factor\":\"x\"}}}");
+    TEST_ASSERT(async_find_message("must be a number") >= 0, "Type mismatch not reported");
+    async_reset_messages();
+    
+    // 异步执行时使用 arguments 副本
+    mcp_tool_t* async_tool = mcp_tool_create_with_args("scale_async", "Scale tool", properties, scale_args_callback);
+    TEST_ASSERT(async_tool != NULL, "Failed to create args tool");
+    mcp_tool_set_async(async_tool, true, 1, 0);
+    TEST_ASSERT(mcp_server_add_tool(server, async_tool), "Failed to add async args tool");
+    TEST_ASSERT(mcp_server_start_workers(server, 1, 4), "Failed to start workers");
+    mcp_server_parse_message(server, "{\"jsonrpc\":\"2.0\",\"id\":5,\"method\":\"tools/call\",\"params\":{\"name\":\"scale_async\",\"arguments\":{\"factor\":2,\"offset\":7,\"label\":\"bg\",\"values\":[1.25]}}}");
+    TEST_ASSERT(async_wait_messages(1, 2000) == 1, "No async args tool response");
+    TEST_ASSERT(async_find_message("scaled=2.50 offset=7 label=bg") >= 0, "Async args tool response not correct");
+    
+    async_reset_messages();
+    mcp_property_list_destroy(properties);
+    mcp_server_destroy(server);
+}
+
+// 测试工具结果缓存
+void test_server_tool_result_cache() {
+    printf("Testing server tool result cache...\n");
+    
+    mcp_server_t* server = mcp_server_create("test_server", "1.0.0");
+    TEST_ASSERT(server != NULL, "Server creation failed");
+    mcp_server_set_send_handler(server, async_send_callback, NULL);
+    async_reset_messages();
+    status_calls = 0;
+    
+    mcp_tool_t* tool = mcp_tool_create("status", "Device status", NULL, status_tool_callback);
+    TEST_ASSERT(mcp_tool_set_result_cache(tool, 200), "Failed to enable result cache");
+    TEST_ASSERT(mcp_server_add_tool(server, tool), "Failed to add cached tool");
+    
+    const char* call_ab = "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"tools/call\",\"params\":{\"name\":\"status\",\"arguments\":{\"a\":1,\"b\":{\"y\":2,\"x\":1}}}}";
+    const char* call_ba = "{\"jsonrpc\":\"2.0\",\"id\":2,\"method\":\"tools/call\",\"params\":{\"name\":\"status\",\"arguments\":{\"b\":{\"x\":1,\"y\":2},\"a\":1}}}";
+    const char* call_other = "{\"jsonrpc\":\"2.0\",\"id\":3,\"method\":\"tools/call\",\"params\":{\"name\":\"status\",\"arguments\":{\"a\":2}}}";
+    
+    mcp_server_parse_message(server, call_ab);
+    mcp_server_parse_message(server, call_ba);
+    TEST_ASSERT(status_calls == 1, "Same arguments in a different order should hit the cache");
+    TEST_ASSERT(async_message_count == 2 && strstr(async_messages[1], "\"id\":2") != NULL &&
+                strstr(async_messages[1], "\"text\":\"1\"") != NULL, "Cached reply should carry the new id");
+    
+    mcp_server_parse_message(server, call_other);
+    TEST_ASSERT(status_calls == 2, "Different arguments should miss the cache");
+    
+    TEST_ASSERT(mcp_server_invalidate_tool_cache(server, "status"), "Invalidate should find the tool");
+    TEST_ASSERT(!mcp_server_invalidate_tool_cache(server, "missing"), "Invalidate should report unknown tools");
+    mcp_server_parse_message(server, call_ab);
+    TEST_ASSERT(status_calls == 3, "Invalidated entry should not be used");
+    
+    usleep(250000);
+    mcp_server_parse_message(server, call_ab);
+    TEST_ASSERT(status_calls == 4, "Expired entry should not be used");
+    
+    async_reset_messages();
+    mcp_server_destroy(server);
+}
+
+// 测试工具调用剖析和 tools/stats
+static int profile_calls = 0;
+static mcp_tool_call_profile_t last_profile;
+
+static void test_profile_handler(const mcp_tool_call_profile_t* profile, void* user_data) {
+    (void)user_data;
+    profile_calls++;
+    last_profile = *profile;
+}
+
+static mcp_return_value_t slow_tool_callback(const mcp_property_list_t* properties) {
+    (void)properties;
+    usleep(20000);
+    mcp_return_value_t result;
+    result.type = MCP_RETURN_TYPE_STRING;
+    result.value.string_val = mcp_strdup("done");
+    return result;
+}
+
+void test_server_tool_profiling() {
+    printf("Testing server tool profiling...\n");
+    
+    mcp_server_t* server = mcp_server_create("test_server", "1.0.0");
+    TEST_ASSERT(server != NULL, "Server creation failed");
+    mcp_server_set_send_handler(server, async_send_callback, NULL);
+    async_reset_messages();
+    profile_calls = 0;
+    
+    TEST_ASSERT(mcp_server_add_simple_tool(server, "fast", "Fast tool", NULL, test_server_tool_callback),
+                "Failed to add fast tool");
+    TEST_ASSERT(mcp_server_add_simple_tool(server, "slow", "Slow tool", NULL, slow_tool_callback),
+                "Failed to add slow tool");
+    
+    const char* call_fast = "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"tools/call\",\"params\":{\"name\":\"fast\"}}";
+    const char* call_slow = "{\"jsonrpc\":\"2.0\",\"id\":2,\"method\":\"tools/call\",\"params\":{\"name\":\"slow\"}}";
+    
+    // 未开启时不记录
+    mcp_tool_stats_t stats;
+    mcp_server_parse_message(server, call_fast);
+    TEST_ASSERT(!mcp_server_get_tool_stats(server, "fast", &stats), "Stats should not exist before profiling");
+    
+    mcp_server_set_tool_profiling(server, true, 10);
+    mcp_server_set_tool_profile_handler(server, test_profile_handler, NULL);
+    mcp_server_parse_message(server, call_fast);
+    mcp_server_parse_message(server, call_fast);
+    TEST_ASSERT(profile_calls == 2 && !last_profile.slow && !last_profile.async, "Fast calls should be profiled");
+    TEST_ASSERT(last_profile.reply_bytes == strlen("{\"content\":[{\"type\":\"text\",\"text\":\"server test result\"}],\"isError\":false}"),
+                "Reply size should be the result length");
+    TEST_ASSERT(mcp_server_get_tool_stats(server, "fast", &stats), "Fast tool should have stats");
+    TEST_ASSERT(stats.calls == 2 && stats.slow == 0 && stats.stages[MCP_TOOL_STAGE_CALLBACK].count == 2,
+                "Fast tool should count two calls");
+    TEST_ASSERT(stats.stages[MCP_TOOL_STAGE_REPLY_BYTES].min == last_profile.reply_bytes &&
+                stats.stages[MCP_TOOL_STAGE_REPLY_BYTES].max == last_profile.reply_bytes,
+                "Reply size histogram should hold the reply length");
+    
+    mcp_server_parse_message(server, call_slow);
+    TEST_ASSERT(profile_calls == 3 && last_profile.slow && last_profile.callback_us >= 20000,
+                "Slow call should be reported");
+    TEST_ASSERT(mcp_server_get_tool_stats(server, "slow", &stats) && stats.slow == 1, "Slow call should be counted");
+    TEST_ASSERT(mcp_tool_histogram_percentile(&stats.stages[MCP_TOOL_STAGE_CALLBACK], 50) >= 20000,
+                "Callback percentile should cover the sleep");
+    
+    async_reset_messages();
+    mcp_server_parse_message(server, "{\"jsonrpc\":\"2.0\",\"id\":3,\"method\":\"tools/stats\"}");
+    TEST_ASSERT(async_message_count == 1, "tools/stats should reply");
+    cJSON* reply = async_message_count == 1 ? cJSON_Parse(async_messages[0]) : NULL;
+    const cJSON* result = cJSON_GetObjectItemCaseSensitive(reply, "result");
+    const cJSON* tools = cJSON_GetObjectItemCaseSensitive(result, "tools");
+    TEST_ASSERT(cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(result, "enabled")), "Stats should report enabled");
+    TEST_ASSERT(cJSON_GetArraySize(tools) == 2, "Both called tools should be listed");
+    const cJSON* fast = cJSON_GetArrayItem(tools, 0);
+    TEST_ASSERT(cJSON_GetObjectItemCaseSensitive(fast, "calls")->valueint == 2, "Fast tool should list two calls");
+    TEST_ASSERT(cJSON_GetObjectItemCaseSensitive(cJSON_GetObjectItemCaseSensitive(fast, "callbackUs"), "p99") != NULL,
+                "Stages should carry percentiles");
+    cJSON_Delete(reply);
+    
+    async_reset_messages();
+    mcp_server_parse_message(server, "{\"jsonrpc\":\"2.0\",\"id\":4,\"method\":\"tools/stats\",\"params\":{\"name\":\"slow\"}}");
+    reply = async_message_count == 1 ? cJSON_Parse(async_messages[0]) : NULL;
+    tools = cJSON_GetObjectItemCaseSensitive(cJSON_GetObjectItemCaseSensitive(reply, "result"), "tools");
+    TEST_ASSERT(cJSON_GetArraySize(tools) == 1, "Name filter should list one tool");
+    cJSON_Delete(reply);
+    
+    async_reset_messages();
+    mcp_server_destroy(server);
+}
+
+// 测试 JSON-RPC 批量请求
+void test_server_batch_request() {
+    printf("Testing server batch request...\n");
+    
+    mcp_server_t* server = mcp_server_create("test_server", "1.0.0");
+    TEST_ASSERT(server != NULL, "Server creation failed");
+    mcp_server_set_send_handler(server, async_send_callback, NULL);
+    async_reset_messages();
+    
+    mcp_property_list_t* properties = mcp_property_list_create();
+    mcp_property_list_add(properties, mcp_property_create_string("message", NULL, false));
+    TEST_ASSERT(mcp_server_add_simple_tool(server, "echo", "Echo tool", properties, echo_tool_callback),
+                "Failed to add echo tool");
+    TEST_ASSERT(mcp_server_add_async_tool(server, "echo_async", "Echo tool", properties, echo_tool_callback, 4, 0),
+                "Failed to add async tool");
+    
+    // 同步调用、通知和错误一起回复为一个数组
+    mcp_server_parse_message(server, "["
+        "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"tools/call\",\"params\":{\"name\":\"echo\",\"arguments\":{\"message\":\"one\"}}},"
+        "{\"jsonrpc\":\"2.0\",\"method\":\"notifications/initialized\"},"
+        "{\"jsonrpc\":\"2.0\",\"id\":2,\"method\":\"tools/call\",\"params\":{\"name\":\"missing\"}}"
+        "]");
+    TEST_ASSERT(async_message_count == 1, "Batch should produce a single message");
+    TEST_ASSERT(async_messages[0][0] == '[', "Batch response should be an array");
+    cJSON* response = cJSON_Parse(async_messages[0]);
+    TEST_ASSERT(response != NULL && cJSON_GetArraySize(response) == 2, "Batch response should hold two replies");
+    cJSON_Delete(response);
+    TEST_ASSERT(async_find_message("Echo: one") >= 0, "Sync result missing from batch");
+    TEST_ASSERT(async_find_message("Tool not found: missing") >= 0, "Error missing from batch");
+    async_reset_messages();
+    
+    // 只有通知时不回复
+    mcp_server_parse_message(server, "[{\"jsonrpc\":\"2.0\",\"method\":\"notifications/initialized\"}]");
+    TEST_ASSERT(async_message_count == 0, "Notification-only batch should not be answered");
+    
+    // 异步调用在线程池中并行执行，全部完成后才回复
+    TEST_ASSERT(mcp_server_start_workers(server, 3, 8), "Failed to start workers");
+    mcp_server_parse_message(server, "["
+        "{\"jsonrpc\":\"2.0\",\"id\":3,\"method\":\"tools/call\",\"params\":{\"name\":\"echo_async\",\"arguments\":{\"message\":\"volume\"}}},"
+        "{\"jsonrpc\":\"2.0\",\"id\":4,\"method\":\"tools/call\",\"params\":{\"name\":\"echo_async\",\"arguments\":{\"message\":\"brightness\"}}},"
+        "{\"jsonrpc\":\"2.0\",\"id\":5,\"method\":\"tools/call\",\"params\":{\"name\":\"echo\",\"arguments\":{\"message\":\"mode\"}}}"
+        "]");
+    TEST_ASSERT(async_wait_messages(1, 2000) == 1, "No batch response");
+    usleep(20000);
+    TEST_ASSERT(async_message_count == 1, "Async batch should produce a single message");
+    response = cJSON_Parse(async_messages[0]);
+    TEST_ASSERT(response != NULL && cJSON_GetArraySize(response) == 3, "Batch response should hold three replies");
+    cJSON_Delete(response);
+    TEST_ASSERT(async_find_message("Echo: volume") >= 0 && async_find_message("Echo: brightness") >= 0 &&
+                async_find_message("Echo: mode") >= 0, "Batch results missing");
+    
+    async_reset_messages();
+    mcp_property_list_destroy(properties);
+    mcp_server_destroy(server);
+}
+
+// 取出第 index 条消息中 notifications/state/patch 的 params（调用者释放返回的根节点）
+static cJSON* state_patch_message(int index, const cJSON** params) {
+    cJSON* root = index < async_message_count ? cJSON_Parse(async_messages[index]) : NULL;
+    const cJSON* method = cJSON_GetObjectItemCaseSensitive(root, "method");
+    if (!cJSON_IsString(method) || strcmp(method->valuestring, "notifications/state/patch") != 0) {
+        cJSON_Delete(root);
+        return NULL;
+    }
+    *params = cJSON_GetObjectItemCaseSensitive(root, "params");
+    return root;
+}
+
+// 按客户端的做法把补丁应用到 base 版本上，检查结果与服务器发布的状态一致
+static bool state_patch_applies(const cJSON* params, const cJSON* base, const cJSON* expected, int* version) {
+    cJSON* state = base ? cJSON_Duplicate(base, true) : cJSON_CreateObject();
+    cJSON* patch = cJSON_Duplicate(cJSON_GetObjectItemCaseSensitive(params, "patch"), true);
+    state = cJSONUtils_MergePatchCaseSensitive(state, patch);
+    bool equal = cJSON_Compare(state, expected, true);
+    *version = cJSON_GetObjectItemCaseSensitive(params, "version")->valueint;
+    cJSON_Delete(patch);
+    cJSON_Delete(state);
+    return equal;
+}
+
+// 测试工具表和设备状态的增量同步
+void test_server_state_sync() {
+    printf("Testing server state sync...\n");
+    
+    mcp_server_t* server = mcp_server_create("test_server", "1.0.0");
+    TEST_ASSERT(server != NULL, "Server creation failed");
+    mcp_server_set_send_handler(server, async_send_callback, NULL);
+    async_reset_messages();
+    TEST_ASSERT(mcp_server_add_simple_tool(server, "echo", "Echo the message back", NULL, echo_tool_callback),
+                "Failed to add echo tool");
+    
+    cJSON* device = cJSON_Parse("{\"volume\":50,\"battery\":80,\"name\":\"kitchen\",\"wifi\":{\"rssi\":-60,\"ssid\":\"home\"}}");
+    TEST_ASSERT(mcp_server_publish_state(server, "device", device), "Publishing state should succeed");
+    TEST_ASSERT(!mcp_server_publish_state(server, MCP_STATE_SYNC_TOOLS, device), "Tools resource is reserved");
+    TEST_ASSERT(async_message_count == 0, "Nothing should be sent before a client opts in");
+    
+    // 未声明支持的客户端只收到初始化响应
+    mcp_server_parse_message(server, "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"initialize\",\"params\":{\"capabilities\":{}}}");
+    TEST_ASSERT(async_message_count == 1, "Plain client should only get the initialize reply");
+    TEST_ASSERT(strstr(async_messages[0], "\"stateSync\":{\"mergePatch\":true}") != NULL,
+                "Server should advertise state sync");
+    async_reset_messages();
+    
+    // 声明支持后，响应之后整体发送各资源
+    mcp_server_parse_message(server, "{\"jsonrpc\":\"2.0\",\"id\":2,\"method\":\"initialize\","
+        "\"params\":{\"capabilities\":{\"stateSync\":{\"mergePatch\":true}}}}");
+    TEST_ASSERT(async_message_count == 3, "Expected reply plus one full object per resource");
+    TEST_ASSERT(strstr(async_messages[0], "\"id\":2") != NULL, "Initialize reply should come first");
+    int device_version = 0;
+    int tools_version = 0;
+    cJSON* client_device = NULL;
+    for (int i = 1; i < 3; i++) {
+        const cJSON* params = NULL;
+        cJSON* root = state_patch_message(i, &params);
+        TEST_ASSERT(root != NULL, "Expected a state patch notification");
+        TEST_ASSERT(cJSON_GetObjectItemCaseSensitive(params, "base")->valueint == 0, "First send should be full");
+        const char* resource = cJSON_GetObjectItemCaseSensitive(params, "resource")->valuestring;
+        if (strcmp(resource, "device") == 0) {
+            TEST_ASSERT(state_patch_applies(params, NULL, device, &device_version), "Full device state mismatch");
+            client_device = cJSON_Duplicate(device, true);
+        } else {
+            TEST_ASSERT(strcmp(resource, MCP_STATE_SYNC_TOOLS) == 0, "Unexpected resource");
+            tools_version = cJSON_GetObjectItemCaseSensitive(params, "version")->valueint;
+            TEST_ASSERT(cJSON_GetObjectItemCaseSensitive(cJSON_GetObjectItemCaseSensitive(params, "patch"), "echo") != NULL,
+                        "Tools object should be keyed by tool name");
+        }
+        cJSON_Delete(root);
+    }
+    async_reset_messages();
+    
+    // 确认后只发送变化的字段
+    char ack[160];
+    snprintf(ack, sizeof(ack), "{\"jsonrpc\":\"2.0\",\"method\":\"notifications/state/ack\",\"params\":{\"resource\":\"device\",\"version\":%d}}", device_version);
+    mcp_server_parse_message(server, ack);
+    TEST_ASSERT(async_message_count == 0, "Acks are not answered");
+    cJSON_ReplaceItemInObjectCaseSensitive(device, "volume", cJSON_CreateNumber(60));
+    TEST_ASSERT(mcp_server_publish_state(server, "device", device), "Publishing state should succeed");
+    TEST_ASSERT(async_message_count == 1, "Changed state should produce one patch");
+    TEST_ASSERT(strstr(async_messages[0], "battery") == NULL && strstr(async_messages[0], "kitchen") == NULL,
+                "Patch should hold only the changed field");
+    const cJSON* params = NULL;
+    cJSON* root = state_patch_message(0, &params);
+    TEST_ASSERT(root && cJSON_GetObjectItemCaseSensitive(params, "base")->valueint == device_version,
+                "Patch should be against the acked version");
+    int version = 0;
+    TEST_ASSERT(state_patch_applies(params, client_device, device, &version), "Patched state mismatch");
+    cJSON_Delete(root);
+    async_reset_messages();
+    
+    // 内容未变化时不发送
+    TEST_ASSERT(mcp_server_publish_state(server, "device", device), "Publishing state should succeed");
+    TEST_ASSERT(async_message_count == 0, "Unchanged state should not be sent");
+    
+    // 未确认时仍以旧的确认版本为基准，补丁累积
+    cJSON_ReplaceItemInObjectCaseSensitive(cJSON_GetObjectItemCaseSensitive(device, "wifi"), "rssi", cJSON_CreateNumber(-70));
+    cJSON_DeleteItemFromObjectCaseSensitive(device, "name");
+    TEST_ASSERT(mcp_server_publish_state(server, "device", device), "Publishing state should succeed");
+    root = state_patch_message(0, &params);
+    TEST_ASSERT(root && cJSON_GetObjectItemCaseSensitive(params, "base")->valueint == device_version,
+                "Unacked patch should keep the old base");
+    TEST_ASSERT(strstr(async_messages[0], "\"name\":null") != NULL, "Removed field should be null in the patch");
+    TEST_ASSERT(strstr(async_messages[0], "home") == NULL, "Unchanged nested field should not be sent");
+    TEST_ASSERT(state_patch_applies(params, client_device, device, &version), "Cumulative patch mismatch");
+    cJSON_Delete(root);
+    async_reset_messages();
+    
+    // 确认最新版本，旧版本的确认随之失效
+    snprintf(ack, sizeof(ack), "{\"jsonrpc\":\"2.0\",\"method\":\"notifications/state/ack\",\"params\":{\"resource\":\"device\",\"version\":%d}}", version);
+    mcp_server_parse_message(server, ack);
+    mcp_server_parse_message(server, ack);
+    mcp_state_sync_stats_t stats;
+    mcp_server_get_state_sync_stats(server, &stats);
+    TEST_ASSERT(stats.acks == 2 && stats.stale_acks == 1, "Repeated ack should be stale");
+    TEST_ASSERT(stats.patch_bytes < stats.full_bytes, "Patches should be smaller than full objects");
+    cJSON_Delete(client_device);
+    client_device = cJSON_Duplicate(device, true);
+    
+    // 工具表变化只发送新增的工具
+    snprintf(ack, sizeof(ack), "{\"jsonrpc\":\"2.0\",\"method\":\"notifications/state/ack\",\"params\":{\"resource\":\"tools\",\"version\":%d}}", tools_version);
+    mcp_server_parse_message(server, ack);
+    TEST_ASSERT(mcp_server_add_simple_tool(server, "echo2", "Second echo", NULL, echo_tool_callback),
+                "Failed to add second tool");
+    TEST_ASSERT(async_message_count == 1, "Tool change should produce one patch");
+    TEST_ASSERT(strstr(async_messages[0], "echo2") != NULL &&
+                strstr(async_messages[0], "Echo the message back") == NULL, "Tools patch should hold only the new tool");
+    async_reset_messages();
+    TEST_ASSERT(mcp_server_remove_tool(server, "echo"), "Failed to remove tool");
+    TEST_ASSERT(async_message_count == 1 && strstr(async_messages[0], "\"echo\":null") != NULL,
+                "Removed tool should be null in the patch");
+    async_reset_messages();
+    
+    // 版本 0 请求完整重发
+    mcp_server_parse_message(server, "{\"jsonrpc\":\"2.0\",\"method\":\"notifications/state/ack\",\"params\":{\"resource\":\"device\",\"version\":0}}");
+    root = state_patch_message(0, &params);
+    TEST_ASSERT(root && cJSON_GetObjectItemCaseSensitive(params, "base")->valueint == 0, "Resync should send a full object");
+    TEST_ASSERT(state_patch_applies(params, NULL, device, &version), "Resent state mismatch");
+    cJSON_Delete(root);
+    async_reset_messages();
+    
+    cJSON_Delete(client_device);
+    cJSON_Delete(device);
+    mcp_server_destroy(server);
+}
+
 // 测试边界条件和错误处理
+// 推送进度和部分结果的工具；保留句柄，返回后的推送应被丢弃
+static mcp_tool_stream_t* retained_stream = NULL;
+
+mcp_return_value_t scan_tool_callback(const mcp_property_list_t* properties) {
+    (void)properties;
+    mcp_tool_stream_t* stream = mcp_tool_stream_current();
+    mcp_tool_stream_progress(stream, 1, 2, "scanning");
+    mcp_tool_stream_progress(stream, 1, 2, "not increasing");
+    mcp_tool_stream_send_text(stream, "found \"cat\"");
+    mcp_tool_stream_progress(stream, 2, 2, NULL);
+    retained_stream = mcp_tool_stream_retain(stream);
+    return mcp_return_string("scan done");
+}
+
+// 测试工具调用的进度通知和分块结果
+void test_server_tool_stream() {
+    printf("Testing server tool progress streaming...\n");
+    
+    mcp_server_t* server = mcp_server_create("test_server", "1.0.0");
+    TEST_ASSERT(server != NULL, "Server creation failed");
+    mcp_server_set_send_handler(server, async_send_callback, NULL);
+    async_reset_messages();
+    TEST_ASSERT(mcp_server_add_simple_tool(server, "scan", "Scan", NULL, scan_tool_callback), "Failed to add scan tool");
+    TEST_ASSERT(mcp_server_add_async_tool(server, "scan_async", "Scan", NULL, scan_tool_callback, 1, 0),
+                "Failed to add async scan tool");
+    TEST_ASSERT(mcp_tool_stream_current() == NULL, "No stream outside a tool callback");
+    
+    // 携带令牌：进度、分块、进度，最后是响应
+    mcp_server_parse_message(server, "{\"jsonrpc\":\"2.0\",\"id\":11,\"method\":\"tools/call\","
+        "\"params\":{\"name\":\"scan\",\"arguments\":{},\"_meta\":{\"progressToken\":\"scan-1\"}}}");
+    TEST_ASSERT(async_message_count == 4, "Expected two progress, one chunk and the reply");
+    TEST_ASSERT(strstr(async_messages[0], "\"method\":\"notifications/progress\"") != NULL &&
+                strstr(async_messages[0], "\"progressToken\":\"scan-1\",\"progress\":1,\"total\":2,\"message\":\"scanning\"") != NULL,
+                "First progress notification mismatch");
+    TEST_ASSERT(strstr(async_messages[1], "\"method\":\"notifications/tools/chunk\"") != NULL &&
+                strstr(async_messages[1], "\"requestId\":11,\"progressToken\":\"scan-1\",\"index\":0") != NULL &&
+                strstr(async_messages[1], "\"text\":\"found \\\"cat\\\"\"") != NULL,
+                "Chunk notification mismatch");
+    TEST_ASSERT(strstr(async_messages[2], "\"progress\":2") != NULL && strstr(async_messages[2], "message") == NULL,
+                "Second progress notification mismatch");
+    TEST_ASSERT(strstr(async_messages[3], "\"id\":11") != NULL && strstr(async_messages[3], "scan done") != NULL,
+                "Reply should come last");
+    
+    // 回复之后的推送被丢弃
+    TEST_ASSERT(retained_stream != NULL && !mcp_tool_stream_is_open(retained_stream), "Stream should be closed");
+    TEST_ASSERT(!mcp_tool_stream_send_text(retained_stream, "late"), "Late chunk should be dropped");
+    mcp_tool_stream_release(retained_stream);
+    retained_stream = NULL;
+    async_reset_messages();
+    
+    // 没有令牌：只发送分块，不带 progressToken
+    mcp_server_parse_message(server, "{\"jsonrpc\":\"2.0\",\"id\":12,\"method\":\"tools/call\","
+        "\"params\":{\"name\":\"scan\",\"arguments\":{}}}");
+    TEST_ASSERT(async_message_count == 2, "Expected one chunk and the reply");
+    TEST_ASSERT(strstr(async_messages[0], "\"requestId\":12,\"index\":0") != NULL, "Chunk without token mismatch");
+    mcp_tool_stream_release(retained_stream);
+    retained_stream = NULL;
+    async_reset_messages();
+    
+    // 工作线程中推送，数字令牌原样带回
+    TEST_ASSERT(mcp_server_start_workers(server, 1, 4), "Failed to start workers");
+    mcp_server_parse_message(server, "{\"jsonrpc\":\"2.0\",\"id\":13,\"method\":\"tools/call\","
+        "\"params\":{\"name\":\"scan_async\",\"arguments\":{},\"_meta\":{\"progressToken\":7}}}");
+    TEST_ASSERT(async_wait_messages(4, 2000) == 4, "Async call should stream before replying");
+    TEST_ASSERT(strstr(async_messages[0], "\"progressToken\":7,") != NULL, "Numeric token mismatch");
+    TEST_ASSERT(strstr(async_messages[3], "\"id\":13") != NULL, "Async reply should come last");
+    mcp_server_stop_workers(server);
+    TEST_ASSERT(!mcp_tool_stream_is_open(retained_stream), "Async stream should be closed");
+    mcp_tool_stream_release(retained_stream);
+    retained_stream = NULL;
+    
+    async_reset_messages();
+    mcp_server_destroy(server);
+}
+
+// 本地调用：在调用方线程执行，通知排队到 flush 或下一次 initialize 之后发送
+void test_server_local_call() {
+    printf("Testing server local tool calls...\n");
+    
+    mcp_server_t* server = mcp_server_create("test_server", "1.0.0");
+    TEST_ASSERT(server != NULL, "Server creation failed");
+    mcp_server_set_send_handler(server, async_send_callback, NULL);
+    async_reset_messages();
+    TEST_ASSERT(mcp_server_add_simple_tool(server, "echo", "Echo", NULL, echo_tool_callback), "Failed to add echo tool");
+    
+    cJSON* arguments = cJSON_Parse("{\"message\":\"hi\"}");
+    char* result = NULL;
+    TEST_ASSERT(mcp_server_call_tool_local(server, "echo", arguments, "说你好", &result), "Local call failed");
+    TEST_ASSERT(result != NULL && strstr(result, "Echo: hi") != NULL && strstr(result, "\"isError\":false") != NULL,
+                "Local call result mismatch");
+    free(result);
+    TEST_ASSERT(!mcp_server_call_tool_local(server, "missing", NULL, NULL, &result) && result == NULL,
+                "Unknown tool should fail");
+    TEST_ASSERT(async_message_count == 0, "Local calls should not send before a flush");
+    
+    TEST_ASSERT(mcp_server_flush_local_calls(server) == 2, "Expected two notifications");
+    TEST_ASSERT(async_message_count == 2, "Expected two messages");
+    TEST_ASSERT(strstr(async_messages[0], "\"method\":\"notifications/tools/local_call\"") != NULL &&
+                strstr(async_messages[0], "\"name\":\"echo\",\"arguments\":{\"message\":\"hi\"},\"utterance\":\"说你好\"") != NULL &&
+                strstr(async_messages[0], "\"result\":{\"content\"") != NULL,
+                "Local call notification mismatch");
+    TEST_ASSERT(strstr(async_messages[1], "\"error\":\"Tool not found\"") != NULL && strstr(async_messages[1], "id") == NULL,
+                "Failed call should be reported as a notification");
+    TEST_ASSERT(mcp_server_flush_local_calls(server) == 0, "Backlog should be empty after a flush");
+    async_reset_messages();
+    
+    // 离线期间的调用在 initialize 响应之后发送
+    TEST_ASSERT(mcp_server_call_tool_local(server, "echo", arguments, NULL, NULL), "Local call without result failed");
+    mcp_server_parse_message(server, "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"initialize\",\"params\":{}}");
+    TEST_ASSERT(async_message_count == 2, "Expected the initialize reply and one notification");
+    TEST_ASSERT(strstr(async_messages[0], "\"id\":1") != NULL && strstr(async_messages[1], "local_call") != NULL &&
+                strstr(async_messages[1], "utterance") == NULL,
+                "Notification should follow the initialize reply");
+    async_reset_messages();
+    
+    // 队列满时丢弃最早的调用
+    for (int i = 0; i <= MCP_LOCAL_CALL_BACKLOG; i++) {
+        char utterance[16];
+        snprintf(utterance, sizeof(utterance), "u%d", i);
+        mcp_server_call_tool_local(server, "echo", arguments, utterance, NULL);
+    }
+    TEST_ASSERT(mcp_server_flush_local_calls(server) == MCP_LOCAL_CALL_BACKLOG, "Backlog should be bounded");
+    TEST_ASSERT(strstr(async_messages[0], "\"utterance\":\"u1\"") != NULL, "Oldest call should be dropped");
+    
+    // 未发送的通知随服务器释放
+    mcp_server_call_tool_local(server, "echo", arguments, NULL, NULL);
+    cJSON_Delete(arguments);
+    async_reset_messages();
+    mcp_server_destroy(server);
+}
+
+// 静态工具表：注册、列出、调用和移除后重新注册
+#define TEST_SERVER_STATIC_TOOLS(TOOL)                                              \
+    TOOL(echo, "static_echo", "Echo the message back",                             \
+         MCP_STATIC_CALLBACK(echo_tool_callback), MCP_STATIC_PUBLIC,               \
+         MCP_STATIC_PARAMS(MCP_STATIC_STRING("message")), MCP_STATIC_NO_PARAMS)    \
+    TOOL(panel, "static_panel", "Open the settings panel",                         \
+         MCP_STATIC_CALLBACK(test_server_tool_callback), MCP_STATIC_USER_ONLY,     \
+         MCP_STATIC_NO_PARAMS, MCP_STATIC_NO_PARAMS)
+
+MCP_STATIC_TOOLS_DEFINE(server_static_tools, TEST_SERVER_STATIC_TOOLS);
+
+void test_server_static_tools() {
+    printf("Testing server static tools...\n");
+    
+    mcp_server_t* server = mcp_server_create("test_server", "1.0.0");
+    TEST_ASSERT(server != NULL, "Server creation failed");
+    mcp_server_set_send_handler(server, test_send_callback, NULL);
+    
+    TEST_ASSERT(mcp_server_add_static_tools(server, server_static_tools,
+                                            MCP_STATIC_TOOLS_COUNT(server_static_tools)),
+                "Registering static tools failed");
+    TEST_ASSERT(!mcp_server_add_static_tools(server, server_static_tools, 1), "Duplicate names should fail");
+    
+    char* json = mcp_server_get_tools_list_json(server, NULL, false);
+    TEST_ASSERT(json != NULL && strstr(json, MCP_STATIC_TOOL(echo)->json_cache) != NULL,
+                "Tools list should embed the static JSON");
+    free(json);
+    json = mcp_server_get_tools_list_json(server, NULL, true);
+    TEST_ASSERT(json != NULL && strstr(json, "static_panel") != NULL && strstr(json, "static_echo") == NULL,
+                "User-only filter should use the static visibility");
+    free(json);
+    
+    mcp_server_parse_message(server, "{\"jsonrpc\":\"2.0\",\"id\":5,\"method\":\"tools/call\","
+        "\"params\":{\"name\":\"static_echo\",\"arguments\":{\"message\":\"flash\"}}}");
+    TEST_ASSERT(last_sent_message != NULL && strstr(last_sent_message, "Echo: flash") != NULL,
+                "Static tool call failed");
+    
+    // 移除后工具常量仍在，可以重新注册
+    TEST_ASSERT(mcp_server_remove_tool(server, "static_echo"), "Removing static tool failed");
+    TEST_ASSERT(mcp_server_add_tool(server, MCP_STATIC_TOOL(echo)), "Re-adding static tool failed");
+    TEST_ASSERT(mcp_server_find_tool(server, "static_echo") == MCP_STATIC_TOOL(echo), "Static tool not found");
+    
+    mcp_server_destroy(server);
+    if (last_sent_message) {
+        free(last_sent_message);
+        last_sent_message = NULL;
+    }
+}
+
 void test_server_edge_cases() {
     printf("Testing server edge cases...\n");
     
@@ -322,23 +1360,19 @@ void test_server_edge_cases() {
     mcp_server_parse_message(server, "invalid json");
     mcp_server_parse_message(server, "{incomplete json");
     
-    // 测试工具数量限制
+    // 测试超过初始容量后自动扩容
     for (int i = 0; i < MCP_MAX_TOOLS + 5; i++) {
         char tool_name[32];
         snprintf(tool_name, sizeof(tool_name), "tool_%d", i);
         
         mcp_tool_t* tool = mcp_tool_create(tool_name, "Test tool", NULL, test_server_tool_callback);
         bool added = mcp_server_add_tool(server, tool);
-        
-        if (i < MCP_MAX_TOOLS) {
-            TEST_ASSERT(added == true, "Tool addition should succeed within limit");
-        } else {
-            TEST_ASSERT(added == false, "Tool addition should fail beyond limit");
-            mcp_tool_destroy(tool);  // 清理未添加的工具
-        }
+        TEST_ASSERT(added == true, "Tool addition should succeed beyond initial capacity");
     }
     
-    TEST_ASSERT(server->tool_count == MCP_MAX_TOOLS, "Server should have maximum tools");
+    TEST_ASSERT(server->tool_count == MCP_MAX_TOOLS + 5, "Server should grow past initial capacity");
+    TEST_ASSERT(mcp_server_find_tool(server, "tool_0") != NULL, "First tool lost after growth");
+    TEST_ASSERT(mcp_server_find_tool(server, "tool_68") != NULL, "Last tool not found after growth");
     
     // 测试服务器名称长度限制
     char long_name[MCP_MAX_NAME_LENGTH + 10];
@@ -363,8 +1397,25 @@ void run_server_tests() {
     test_server_simple_tool_add();
     test_server_message_handling();
     test_server_tool_call();
+    test_server_image_tool_call();
+    test_server_instance_send_handler();
+    test_server_async_tool_call();
+    test_server_async_tool_busy();
+    test_server_async_tool_timeout();
+    test_server_args_tool_call();
+    test_server_tool_result_cache();
+    test_server_tool_profiling();
+    test_server_batch_request();
+    test_server_tool_remove_replace();
+    test_server_remove_running_async_tool();
     test_server_capabilities();
     test_server_tools_list_json();
+    test_server_tools_list_pagination();
+    test_server_state_sync();
+    test_server_static_tools();
+    test_server_tool_stream();
+    test_server_local_call();
+    test_server_initialize_cache();
     test_server_edge_cases();
     
     printf("=== Server Tests Complete ===\n\n");
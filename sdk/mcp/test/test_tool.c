@@ -1,5 +1,6 @@
 #include "test_framework.h"
 #include "../mcp_tool.h"
+#include "../mcp_static_tool.h"
 #include "../mcp_types.h"
 #include <string.h>
 #include <stdlib.h>
@@ -320,7 +321,93 @@ void test_tool_edge_cases() {
     mcp_property_list_destroy(properties);  // 释放原始的properties列表
 }
 
-// ... existing code ...
+// 编译期声明的静态工具
+#define TEST_STATIC_TOOLS(TOOL)                                                     \
+    TOOL(status, "self.get_status", "Get the device status",                       \
+         MCP_STATIC_CALLBACK(test_callback_simple), MCP_STATIC_PUBLIC,             \
+         MCP_STATIC_NO_PARAMS, MCP_STATIC_NO_PARAMS)                               \
+    TOOL(set_volume, "self.audio.set_volume", "Set the volume",                    \
+         MCP_STATIC_CALLBACK(test_callback_with_params), MCP_STATIC_USER_ONLY,     \
+         MCP_STATIC_PARAMS(MCP_STATIC_STRING("text"), MCP_STATIC_BOOLEAN("on"),    \
+                           MCP_STATIC_INTEGER_RANGE("level", -10, 10)),            \
+         MCP_STATIC_PARAMS(MCP_STATIC_INTEGER_RANGE_DEFAULT("volume", 50, 0, 100), \
+                           MCP_STATIC_NUMBER_DEFAULT("ratio", 0.5),                \
+                           MCP_STATIC_STRING_DEFAULT("voice", "warm"),             \
+                           MCP_STATIC_BOOLEAN_DEFAULT("fade", false)))             \
+    TOOL(set_mode, "self.set_mode", "Set the mode",                                \
+         MCP_STATIC_CALLBACK(test_callback_integer), MCP_STATIC_PUBLIC,            \
+         MCP_STATIC_NO_PARAMS,                                                     \
+         MCP_STATIC_PARAMS(MCP_STATIC_INTEGER_DEFAULT("mode", 2)))
+
+MCP_STATIC_TOOLS_DEFINE(test_static_tools, TEST_STATIC_TOOLS);
+
+// 测试静态工具的编译期JSON与运行时创建的同样工具一致
+void test_tool_static_schema() {
+    printf("Testing static tool schema...\n");
+    
+    TEST_ASSERT(MCP_STATIC_TOOLS_COUNT(test_static_tools) == 3, "Static table should hold 3 tools");
+    TEST_ASSERT(MCP_STATIC_TOOL(set_volume) == test_static_tools[1], "Tools should keep declaration order");
+    
+    // 按相同顺序运行时创建
+    mcp_property_list_t* properties = mcp_property_list_create();
+    mcp_property_t* props[] = {
+        mcp_property_create_string("text", NULL, false),
+        mcp_property_create_boolean("on", false, false),
+        mcp_property_create_integer("level", 0, false, true, -10, 10),
+        mcp_property_create_integer("volume", 50, true, true, 0, 100),
+        mcp_property_create_number("ratio", 0.5, true),
+        mcp_property_create_string("voice", "warm", true),
+        mcp_property_create_boolean("fade", false, true),
+    };
+    for (size_t i = 0; i < sizeof(props) / sizeof(props[0]); i++) {
+        mcp_property_list_add(properties, props[i]);
+        mcp_property_destroy(props[i]);
+    }
+    mcp_tool_t* runtime = mcp_tool_create("self.audio.set_volume", "Set the volume", properties, test_callback_with_params);
+    mcp_property_list_destroy(properties);
+    TEST_ASSERT(runtime != NULL, "Runtime tool creation failed");
+    mcp_tool_set_user_only(runtime, true);
+    
+    char* expected = mcp_tool_to_json(runtime);
+    size_t length = 0;
+    const char* actual = mcp_tool_get_cached_json(MCP_STATIC_TOOL(set_volume), &length);
+    TEST_ASSERT(expected != NULL && actual != NULL, "Tool JSON missing");
+    TEST_ASSERT_EQUAL_STR(expected, actual);
+    TEST_ASSERT(length == strlen(actual), "Static JSON length mismatch");
+    free(expected);
+    mcp_tool_destroy(runtime);
+    
+    runtime = mcp_tool_create("self.get_status", "Get the device status", NULL, test_callback_simple);
+    expected = mcp_tool_to_json(runtime);
+    TEST_ASSERT_EQUAL_STR(expected, MCP_STATIC_TOOL(status)->json_cache);
+    free(expected);
+    mcp_tool_destroy(runtime);
+    
+    for (size_t i = 0; i < MCP_STATIC_TOOLS_COUNT(test_static_tools); i++) {
+        TEST_ASSERT(mcp_tool_check_static(test_static_tools[i]), "Static JSON should match the declared schema");
+    }
+    
+    // 参数声明可直接用于查找和调用
+    const mcp_property_t* mode = mcp_property_list_find(MCP_STATIC_TOOL(set_mode)->properties, "mode");
+    TEST_ASSERT(mode != NULL && mode->has_default_value && mode->value.int_val == 2, "Static property mismatch");
+    char* result = mcp_tool_call(MCP_STATIC_TOOL(set_mode), NULL);
+    TEST_ASSERT(result != NULL && strstr(result, "42") != NULL, "Static tool call failed");
+    free(result);
+    
+    // 可见性是常量；销毁只清理运行时状态
+    mcp_tool_set_user_only(MCP_STATIC_TOOL(status), true);
+    TEST_ASSERT(!mcp_tool_is_user_only(MCP_STATIC_TOOL(status)), "Static visibility should not change");
+    TEST_ASSERT(mcp_tool_set_result_cache(MCP_STATIC_TOOL(status), 1000), "Result cache should be allowed");
+    mcp_tool_destroy(MCP_STATIC_TOOL(status));
+    TEST_ASSERT(MCP_STATIC_TOOL(status)->result_cache == NULL, "Destroy should drop the result cache");
+    TEST_ASSERT(MCP_STATIC_TOOL(status)->json_cache != NULL, "Destroy should keep the static JSON");
+    
+    // 运行时工具不是静态工具
+    runtime = mcp_tool_create("dynamic", "Dynamic tool", NULL, test_callback_simple);
+    TEST_ASSERT(!mcp_tool_check_static(runtime), "Runtime tools are not static");
+    mcp_tool_destroy(runtime);
+}
+
 
 // 运行所有工具测试
 void run_tool_tests() {
@@ -332,6 +419,7 @@ void run_tool_tests() {
     test_tool_serialization();
     test_tool_validation();
     test_tool_edge_cases();
+    test_tool_static_schema();
     
     printf("=== Tool Tests Complete ===\n\n");
 }
@@ -59,6 +59,124 @@ void test_base64_encode(void) {
     TEST_ASSERT_NULL(result);
 }
 
+/**
+ * 逐组编码的参考实现，用于核对向量化的整块编码
+ */
+static size_t reference_base64(char* dst, const unsigned char* src, size_t len) {
+    static const char chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t n = 0;
+    for (size_t i = 0; i < len; i += 3) {
+        unsigned int v = (unsigned int)src[i] << 16;
+        if (i + 1 < len) v |= (unsigned int)src[i + 1] << 8;
+        if (i + 2 < len) v |= src[i + 2];
+        dst[n++] = chars[(v >> 18) & 0x3F];
+        dst[n++] = chars[(v >> 12) & 0x3F];
+        dst[n++] = i + 1 < len ? chars[(v >> 6) & 0x3F] : '=';
+        dst[n++] = i + 2 < len ? chars[v & 0x3F] : '=';
+    }
+    return n;
+}
+
+/**
+ * 测试流式Base64编码（含整块向量编码的所有长度和分段方式）
+ */
+void test_base64_streaming(void) {
+    TEST_CASE_START("Base64 Streaming");
+    
+    unsigned char data[300];
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (unsigned char)(i * 167 + 13);
+    }
+    char expected[404];
+    char actual[404];
+    
+    // 整块和尾部在每个长度上都与参考实现一致
+    bool all_match = true;
+    for (size_t len = 0; len <= sizeof(data); len++) {
+        size_t n = reference_base64(expected, data, len);
+        if (mcp_base64_encode_into(actual, data, len) != n || memcmp(actual, expected, n) != 0) {
+            all_match = false;
+        }
+    }
+    TEST_ASSERT(all_match, "Block encoding differs from reference");
+    
+    // 任意分段送入的结果与一次编码相同
+    size_t expected_len = reference_base64(expected, data, sizeof(data));
+    for (size_t chunk = 1; chunk <= 7; chunk++) {
+        mcp_base64_encoder_t encoder;
+        mcp_base64_encoder_init(&encoder);
+        size_t total = 0;
+        bool within_bound = true;
+        for (size_t offset = 0; offset < sizeof(data); offset += chunk) {
+            size_t len = sizeof(data) - offset < chunk ? sizeof(data) - offset : chunk;
+            size_t bound = mcp_base64_encode_update_length(&encoder, len);
+            size_t n = mcp_base64_encode_update(&encoder, data + offset, len, actual + total);
+            within_bound = within_bound && n <= bound;
+            total += n;
+        }
+        total += mcp_base64_encode_final(&encoder, actual + total);
+        TEST_ASSERT(within_bound, "Update wrote more than its bound");
+        TEST_ASSERT(total == expected_len, "Streamed encoding length mismatch");
+        TEST_ASSERT(memcmp(actual, expected, expected_len) == 0, "Streamed encoding mismatch");
+    }
+    
+    // 分段解码还原原始数据
+    for (size_t chunk = 1; chunk <= 9; chunk += 4) {
+        mcp_base64_decoder_t decoder;
+        mcp_base64_decoder_init(&decoder);
+        unsigned char decoded[310];
+        size_t total = 0;
+        bool ok = true;
+        for (size_t offset = 0; offset < expected_len; offset += chunk) {
+            size_t len = expected_len - offset < chunk ? expected_len - offset : chunk;
+            size_t n = 0;
+            ok = mcp_base64_decode_update(&decoder, expected + offset, len, decoded + total, &n) && ok &&
+                 n <= mcp_base64_decoded_max_length(len);
+            total += n;
+        }
+        TEST_ASSERT(ok, "Streamed decode failed or overran its bound");
+        size_t tail = 0;
+        TEST_ASSERT(mcp_base64_decode_final(&decoder, decoded + total, &tail), "Decode final failed");
+        total += tail;
+        TEST_ASSERT(total == sizeof(data), "Streamed decode length mismatch");
+        TEST_ASSERT(memcmp(decoded, data, sizeof(data)) == 0, "Streamed decode mismatch");
+    }
+}
+
+/**
+ * 测试Base64解码的填充和非法输入
+ */
+void test_base64_decode(void) {
+    TEST_CASE_START("Base64 Decode");
+    
+    char out[16];
+    size_t len = 0;
+    TEST_ASSERT(mcp_base64_decode_into(out, "QQ==", 4, &len) && len == 1 && out[0] == 'A', "QQ== should decode");
+    TEST_ASSERT(mcp_base64_decode_into(out, "QUI=", 4, &len) && len == 2 && memcmp(out, "AB", 2) == 0,
+                "QUI= should decode");
+    TEST_ASSERT(mcp_base64_decode_into(out, "SGVsbG8gV29ybGQ=", 16, &len) && len == 11 &&
+                memcmp(out, "Hello World", 11) == 0, "Hello World should decode");
+    TEST_ASSERT(mcp_base64_decode_into(out, "", 0, &len) && len == 0, "Empty input should decode");
+    
+    // 省略填充时按剩余字符数补齐
+    TEST_ASSERT(mcp_base64_decode_into(out, "QUI", 3, &len) && len == 2 && memcmp(out, "AB", 2) == 0,
+                "Unpadded input should decode");
+    
+    // 非法字符、多余或错位的填充、单个剩余字符都被拒绝
+    TEST_ASSERT(!mcp_base64_decode_into(out, "QU*D", 4, &len) && len == 0, "Invalid character accepted");
+    TEST_ASSERT(!mcp_base64_decode_into(out, "Q===", 4, &len), "Misplaced padding accepted");
+    TEST_ASSERT(!mcp_base64_decode_into(out, "QQ=A", 4, &len), "Data after padding accepted");
+    TEST_ASSERT(!mcp_base64_decode_into(out, "QQ===", 5, &len), "Extra padding accepted");
+    TEST_ASSERT(!mcp_base64_decode_into(out, "QUJDR", 5, &len), "Dangling character accepted");
+    TEST_ASSERT(!mcp_base64_decode_into(out, "QQ=", 3, &len), "Half padding accepted");
+    
+    // 失效的解码器不再接受输入
+    mcp_base64_decoder_t decoder;
+    mcp_base64_decoder_init(&decoder);
+    TEST_ASSERT(!mcp_base64_decode_update(&decoder, "!", 1, out, &len), "Invalid character accepted");
+    TEST_ASSERT(!mcp_base64_decode_update(&decoder, "QUJD", 4, out, &len), "Failed decoder accepted input");
+}
+
 /**
  * 测试图像内容创建
  */
@@ -147,6 +265,109 @@ void test_image_content_to_json(void) {
     TEST_ASSERT_NULL(json_str);
 }
 
+/**
+ * 测试原始数据形式的图像内容
+ */
+void test_image_content_raw(void) {
+    TEST_CASE_START("Image Content Raw");
+    
+    // 所有字节值、三种尾部长度都与逐字节编码结果一致
+    char binary[256];
+    for (int i = 0; i < 256; i++) {
+        binary[i] = (char)i;
+    }
+    for (size_t len = 1; len <= 6; len++) {
+        char* expected = mcp_base64_encode(binary + 250 - len, len);
+        char buffer[16];
+        size_t written = mcp_base64_encode_into(buffer, binary + 250 - len, len);
+        TEST_ASSERT(written == mcp_base64_encoded_length(len), "Encoded length mismatch");
+        TEST_ASSERT(memcmp(buffer, expected, written) == 0, "Encoded data mismatch");
+        free(expected);
+    }
+    
+    mcp_image_content_t* image = mcp_image_content_create_raw("image/jpeg", binary, sizeof(binary));
+    TEST_ASSERT_NOT_NULL(image);
+    TEST_ASSERT_NULL(image->encoded_data);
+    TEST_ASSERT(mcp_image_content_encoded_length(image) == 344, "Raw image encoded length wrong");
+    
+    // 与预先编码的图像生成相同的JSON
+    mcp_image_content_t* encoded = mcp_image_content_create("image/jpeg", binary, sizeof(binary));
+    char* raw_json = mcp_image_content_to_json(image);
+    char* encoded_json = mcp_image_content_to_json(encoded);
+    TEST_ASSERT_NOT_NULL(raw_json);
+    TEST_ASSERT_NOT_NULL(encoded_json);
+    TEST_ASSERT_EQUAL_STR(encoded_json, raw_json);
+    free(raw_json);
+    free(encoded_json);
+    mcp_image_content_destroy(encoded);
+    mcp_image_content_destroy(image);
+    
+    // 接管调用者的缓冲区
+    char* owned = malloc(3);
+    memcpy(owned, "ABC", 3);
+    image = mcp_image_content_adopt("image/png", owned, 3);
+    TEST_ASSERT_NOT_NULL(image);
+    char data[8];
+    TEST_ASSERT(mcp_image_content_write_data(image, data) == 4, "Adopted image length wrong");
+    TEST_ASSERT(memcmp(data, "QUJD", 4) == 0, "Adopted image data wrong");
+    mcp_image_content_destroy(image);
+    
+    // 需要转义的MIME类型被拒绝
+    TEST_ASSERT_NULL(mcp_image_content_create_raw("image/\"png", "x", 1));
+}
+
+static int shared_release_count = 0;
+
+static void shared_buffer_released(mcp_buffer_t* buffer) {
+    (void)buffer;
+    shared_release_count++;
+}
+
+/**
+ * 测试引用共享缓冲区的图像内容
+ */
+void test_image_content_shared(void) {
+    TEST_CASE_START("Image Content Shared");
+    
+    // 模拟帧池中的槽位：缓冲区由所有者持有，不会被图像对象释放
+    uint8_t frame[3] = { 'A', 'B', 'C' };
+    mcp_buffer_t buffer;
+    shared_release_count = 0;
+    mcp_buffer_init(&buffer, frame, sizeof(frame), shared_buffer_released, NULL);
+    
+    mcp_image_content_t* image = mcp_image_content_create_shared("image/jpeg", &buffer);
+    TEST_ASSERT_NOT_NULL(image);
+    TEST_ASSERT(image->raw_data == (char*)frame, "Shared image should not copy the data");
+    char data[8];
+    TEST_ASSERT(mcp_image_content_write_data(image, data) == 4, "Shared image length wrong");
+    TEST_ASSERT(memcmp(data, "QUJD", 4) == 0, "Shared image data wrong");
+    
+    // 帧先释放，图像仍然持有引用
+    mcp_buffer_release(&buffer);
+    TEST_ASSERT(shared_release_count == 0, "Buffer released while still referenced");
+    mcp_image_content_destroy(image);
+    TEST_ASSERT(shared_release_count == 1, "Buffer not released by the last reference");
+    
+    // 接管 malloc 数据的缓冲区
+    uint8_t* owned = malloc(3);
+    memcpy(owned, "ABC", 3);
+    mcp_buffer_t* adopted = mcp_buffer_adopt(owned, 3);
+    TEST_ASSERT_NOT_NULL(adopted);
+    image = mcp_image_content_create_shared("image/png", adopted);
+    mcp_buffer_release(adopted);
+    TEST_ASSERT_NOT_NULL(image);
+    char* json = mcp_image_content_to_json(image);
+    TEST_ASSERT_EQUAL_STR("{\"type\":\"image\",\"mimeType\":\"image/png\",\"data\":\"QUJD\"}", json);
+    free(json);
+    mcp_image_content_destroy(image);
+    
+    // 无效参数；失败时不持有引用
+    mcp_buffer_init(&buffer, frame, sizeof(frame), shared_buffer_released, NULL);
+    TEST_ASSERT_NULL(mcp_image_content_create_shared("image/\"png", &buffer));
+    TEST_ASSERT_NULL(mcp_image_content_create_shared("image/png", NULL));
+    TEST_ASSERT(buffer.refcount == 1, "Failed creation changed the reference count");
+}
+
 /**
  * 测试字符串复制
  */
@@ -305,9 +526,13 @@ void run_utils_tests(void) {
     TEST_SUITE_START("MCP Utils Tests");
     
     test_base64_encode();
+    test_base64_streaming();
+    test_base64_decode();
     test_image_content_create();
     test_image_content_destroy();
     test_image_content_to_json();
+    test_image_content_raw();
+    test_image_content_shared();
     test_string_duplicate();
     test_string_free();
     test_json_to_string();
@@ -0,0 +1,252 @@
+#ifndef LINX_OS_H
+#define LINX_OS_H
+
+/*
+ * 操作系统抽象层：线程、互斥锁、信号量、消息队列和单调时钟
+ *
+ * SDK 自己创建的线程（事件循环、派发、播放、音频流水线、reactor）都经这里创建，
+ * 以便在 RTOS 上直接使用原生任务：
+ * - POSIX（Linux/macOS）：pthread，栈大小经 pthread_attr 设置，核绑定用
+ *   pthread_setaffinity_np（仅 Linux），实时优先级尝试 SCHED_FIFO，无权限时保持默认调度
+ * - FreeRTOS / ESP-IDF：xTaskCreate（ESP-IDF 上为 xTaskCreatePinnedToCore），
+ *   栈按字节指定，不经 pthread 兼容层，因此没有每线程额外的 pthread 结构开销，
+ *   音频任务可以固定在某个核上
+ *
+ * 后端在编译期选择：定义 ESP_PLATFORM（ESP-IDF）或 LINX_OS_FREERTOS=1 时使用 FreeRTOS，
+ * 否则使用 POSIX。两个后端的源文件都可以编入，未选中的一个编译为空。
+ *
+ * 互斥锁、信号量和队列是不透明句柄，由 *_create() 分配；SDK 内部已有的
+ * pthread_mutex/cond 代码在 ESP-IDF 上由其原生 pthread 组件直接映射到 FreeRTOS 原语，
+ * 新代码请使用这里的接口。
+ *
+ * 超时参数单位为毫秒：0 不等待，<0（LINX_OS_WAIT_FOREVER）一直等待。
+ *
+ * 线程调度的板级默认值（LINX_THREAD_*_CORE_MASK / LINX_THREAD_AUDIO_SCHED_PRIORITY）来自
+ * 构建配置的 CONFIG_*_THREAD_*，把音频线程和界面、网络（含 OTA 下载）线程分到不同的核上，
+ * 避免后者占满共享核时播放和采集断续；各模块配置中的线程属性非零时优先。
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef LINX_OS_FREERTOS
+#if defined(ESP_PLATFORM)
+#define LINX_OS_FREERTOS 1
+#else
+#define LINX_OS_FREERTOS 0
+#endif
+#endif
+
+/* 一直等待 */
+#define LINX_OS_WAIT_FOREVER (-1)
+
+/* 播放、音频流水线线程默认允许运行的核（位图，0 不限制） */
+#ifndef LINX_THREAD_AUDIO_CORE_MASK
+#define LINX_THREAD_AUDIO_CORE_MASK 0
+#endif
+
+/* 播放、音频流水线线程默认的 sched_priority（见 linx_thread_attr_t），0 按优先级档位 */
+#ifndef LINX_THREAD_AUDIO_SCHED_PRIORITY
+#define LINX_THREAD_AUDIO_SCHED_PRIORITY 0
+#endif
+
+/* SDK 网络事件、派发和 reactor 线程默认允许运行的核 */
+#ifndef LINX_THREAD_NET_CORE_MASK
+#define LINX_THREAD_NET_CORE_MASK 0
+#endif
+
+/* 界面线程默认允许运行的核 */
+#ifndef LINX_THREAD_UI_CORE_MASK
+#define LINX_THREAD_UI_CORE_MASK 0
+#endif
+
+/* ==================== 线程 ==================== */
+
+typedef struct linx_thread linx_thread_t;
+
+/* 线程入口，返回值被忽略（与 pthread 入口签名相同，便于迁移） */
+typedef void* (*linx_thread_func_t)(void* arg);
+
+/* 相对优先级，各后端映射到自己的优先级范围 */
+typedef enum {
+    LINX_THREAD_PRIORITY_DEFAULT = 0,   // 由创建线程的模块决定（未指定时等同 NORMAL）
+    LINX_THREAD_PRIORITY_LOW,           // 后台：日志、统计
+    LINX_THREAD_PRIORITY_NORMAL,        // 网络事件循环、事件派发
+    LINX_THREAD_PRIORITY_HIGH,          // 播放、音频流水线
+    LINX_THREAD_PRIORITY_REALTIME       // 与声卡时钟同步的采集/播放
+} linx_thread_priority_t;
+
+/* 线程属性；零值字段取默认值 */
+typedef struct {
+    const char* name;                   // 线程名（FreeRTOS 任务名 / 系统线程名），NULL 为 "linx"
+    size_t stack_size;                  // 栈大小（字节），0 为平台默认值
+    linx_thread_priority_t priority;    // 优先级
+    unsigned int core_mask;             // 允许运行的 CPU 核位图（bit N 为核 N），0 不限制
+    int sched_priority;                 // >0 时覆盖 priority：POSIX 上以 SCHED_FIFO 的该优先级运行（1-99，
+                                        // 无权限时退回默认调度），FreeRTOS 上直接作为任务优先级
+} linx_thread_attr_t;
+
+/**
+ * 合并线程属性：user 中的非零字段优先，其余取 defaults（两者都可为 NULL）
+ */
+static inline linx_thread_attr_t linx_thread_attr_merge(const linx_thread_attr_t* user,
+                                                        const linx_thread_attr_t* defaults) {
+    linx_thread_attr_t merged;
+    if (defaults) {
+        merged = *defaults;
+    } else {
+        memset(&merged, 0, sizeof(merged));
+    }
+    if (user) {
+        if (user->name) {
+            merged.name = user->name;
+        }
+        if (user->stack_size > 0) {
+            merged.stack_size = user->stack_size;
+        }
+        if (user->priority != LINX_THREAD_PRIORITY_DEFAULT) {
+            merged.priority = user->priority;
+        }
+        if (user->core_mask != 0) {
+            merged.core_mask = user->core_mask;
+        }
+        if (user->sched_priority > 0) {
+            merged.sched_priority = user->sched_priority;
+        }
+    }
+    return merged;
+}
+
+/**
+ * 创建并启动线程
+ * @param attr 线程属性，可为 NULL
+ * @return 线程句柄，失败返回 NULL；句柄由 linx_thread_join() 释放
+ */
+linx_thread_t* linx_thread_create(const linx_thread_attr_t* attr, linx_thread_func_t func, void* arg);
+
+/**
+ * 等待线程结束并释放句柄（不能在该线程自身中调用）
+ * @return 0 成功，-1 失败
+ */
+int linx_thread_join(linx_thread_t* thread);
+
+/**
+ * 把优先级、核绑定和线程名应用到调用线程（应用自己创建的采集/编码线程等）；
+ * stack_size 被忽略
+ * @return 0 全部生效，-1 有设置未生效（如没有实时调度权限，或 ESP-IDF 上任务创建后不能换核）
+ */
+int linx_thread_configure_current(const linx_thread_attr_t* attr);
+
+/**
+ * 调用者是否就是该线程
+ */
+bool linx_thread_is_current(const linx_thread_t* thread);
+
+/**
+ * 线程实际得到的栈大小（字节），未知为 0
+ */
+size_t linx_thread_stack_size(const linx_thread_t* thread);
+
+/* ==================== 互斥锁 ==================== */
+
+typedef struct linx_mutex linx_mutex_t;
+
+/**
+ * 创建互斥锁（不可递归）
+ * @return 互斥锁，失败返回 NULL
+ */
+linx_mutex_t* linx_mutex_create(void);
+
+void linx_mutex_destroy(linx_mutex_t* mutex);
+
+void linx_mutex_lock(linx_mutex_t* mutex);
+
+void linx_mutex_unlock(linx_mutex_t* mutex);
+
+/* ==================== 信号量 ==================== */
+
+typedef struct linx_sem linx_sem_t;
+
+/**
+ * 创建计数信号量
+ * @param initial 初始计数
+ * @param max 最大计数（>= 1，give 到上限后不再增加）
+ * @return 信号量，失败返回 NULL
+ */
+linx_sem_t* linx_sem_create(unsigned int initial, unsigned int max);
+
+void linx_sem_destroy(linx_sem_t* sem);
+
+/**
+ * 计数减一，计数为 0 时等待
+ * @return true 成功，false 超时
+ */
+bool linx_sem_take(linx_sem_t* sem, int timeout_ms);
+
+/**
+ * 计数加一（任意线程；FreeRTOS 上不能在中断中调用）
+ */
+void linx_sem_give(linx_sem_t* sem);
+
+/* ==================== 消息队列 ==================== */
+
+typedef struct linx_queue linx_queue_t;
+
+/**
+ * 创建定长消息队列，消息按值拷贝
+ * @param item_size 每条消息的字节数
+ * @param depth 最多缓存的消息数
+ * @return 队列，失败返回 NULL
+ */
+linx_queue_t* linx_queue_create(size_t item_size, size_t depth);
+
+/**
+ * 销毁队列（不能有线程正在等待）
+ */
+void linx_queue_destroy(linx_queue_t* queue);
+
+/**
+ * 拷贝一条消息到队尾，队列满时等待
+ * @return true 成功，false 超时
+ */
+bool linx_queue_send(linx_queue_t* queue, const void* item, int timeout_ms);
+
+/**
+ * 取出队首消息，队列空时等待
+ * @return true 成功，false 超时
+ */
+bool linx_queue_recv(linx_queue_t* queue, void* item, int timeout_ms);
+
+/**
+ * 当前缓存的消息数
+ */
+size_t linx_queue_count(linx_queue_t* queue);
+
+/* ==================== 时间 ==================== */
+
+/**
+ * 单调时钟（毫秒），起点不定，只用于计算间隔
+ */
+uint64_t linx_os_now_ms(void);
+
+/**
+ * 单调时钟（微秒）；FreeRTOS 上精度为 1 个 tick，ESP-IDF 上为 esp_timer 的微秒
+ */
+uint64_t linx_os_now_us(void);
+
+/**
+ * 让出 CPU 至少 ms 毫秒
+ */
+void linx_os_sleep_ms(unsigned int ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINX_OS_H */
@@ -0,0 +1,278 @@
+#include "linx_os.h"
+
+#if LINX_OS_FREERTOS
+
+#include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#ifdef ESP_PLATFORM
+#include "esp_timer.h"
+#endif
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_CORE);
+
+/* 未指定栈大小时的任务栈（字节） */
+#ifndef LINX_OS_DEFAULT_STACK_SIZE
+#define LINX_OS_DEFAULT_STACK_SIZE (8 * 1024)
+#endif
+
+struct linx_thread {
+    TaskHandle_t task;
+    SemaphoreHandle_t done;     // 入口函数返回后释放，linx_thread_join() 等待它
+    linx_thread_func_t func;
+    void* arg;
+    size_t stack_size;
+};
+
+/* FreeRTOS 互斥量、信号量和队列本身就是句柄，这里的结构只是类型名 */
+struct linx_mutex;
+struct linx_sem;
+struct linx_queue;
+
+static TickType_t linx_os_ticks(int timeout_ms) {
+    if (timeout_ms < 0) {
+        return portMAX_DELAY;
+    }
+    TickType_t ticks = pdMS_TO_TICKS((TickType_t)timeout_ms);
+    return timeout_ms > 0 && ticks == 0 ? 1 : ticks;
+}
+
+/* ==================== 线程 ==================== */
+
+static UBaseType_t linx_thread_priority(linx_thread_priority_t priority) {
+    UBaseType_t value;
+    switch (priority) {
+        case LINX_THREAD_PRIORITY_LOW:
+            value = tskIDLE_PRIORITY + 1;
+            break;
+        case LINX_THREAD_PRIORITY_HIGH:
+            value = tskIDLE_PRIORITY + 10;
+            break;
+        case LINX_THREAD_PRIORITY_REALTIME:
+            value = configMAX_PRIORITIES - 2;
+            break;
+        default:
+            value = tskIDLE_PRIORITY + 5;
+            break;
+    }
+    return value < configMAX_PRIORITIES ? value : configMAX_PRIORITIES - 1;
+}
+
+/* sched_priority > 0 时直接作为任务优先级 */
+static UBaseType_t linx_thread_attr_priority(const linx_thread_attr_t* attr) {
+    if (attr->sched_priority > 0) {
+        UBaseType_t value = (UBaseType_t)attr->sched_priority;
+        return value < configMAX_PRIORITIES ? value : configMAX_PRIORITIES - 1;
+    }
+    return linx_thread_priority(attr->priority);
+}
+
+static void linx_thread_entry(void* arg) {
+    linx_thread_t* thread = (linx_thread_t*)arg;
+    thread->func(thread->arg);
+    xSemaphoreGive(thread->done);
+    vTaskDelete(NULL);
+}
+
+linx_thread_t* linx_thread_create(const linx_thread_attr_t* attr, linx_thread_func_t func, void* arg) {
+    if (!func) {
+        return NULL;
+    }
+    linx_thread_attr_t defaults;
+    memset(&defaults, 0, sizeof(defaults));
+    if (!attr) {
+        attr = &defaults;
+    }
+
+    linx_thread_t* thread = (linx_thread_t*)LINX_CALLOC(1, sizeof(linx_thread_t));
+    if (!thread) {
+        return NULL;
+    }
+    thread->done = xSemaphoreCreateBinary();
+    if (!thread->done) {
+        LINX_FREE(thread);
+        return NULL;
+    }
+    thread->func = func;
+    thread->arg = arg;
+    thread->stack_size = attr->stack_size > 0 ? attr->stack_size : LINX_OS_DEFAULT_STACK_SIZE;
+
+    const char* name = attr->name ? attr->name : "linx";
+    UBaseType_t priority = linx_thread_attr_priority(attr);
+    BaseType_t result;
+#ifdef ESP_PLATFORM
+    /* ESP-IDF 的栈深度以字节计；只允许一个核时固定在该核上 */
+    BaseType_t core = tskNO_AFFINITY;
+    if (attr->core_mask != 0 && (attr->core_mask & (attr->core_mask - 1)) == 0) {
+        core = (BaseType_t)__builtin_ctz(attr->core_mask);
+        if (core >= portNUM_PROCESSORS) {
+            LOG_WARN("Thread %s: core %d does not exist, not pinned", name, (int)core);
+            core = tskNO_AFFINITY;
+        }
+    }
+    result = xTaskCreatePinnedToCore(linx_thread_entry, name, (uint32_t)thread->stack_size, thread, priority,
+                                     &thread->task, core);
+#else
+    /* 原版 FreeRTOS 的栈深度以 StackType_t 计 */
+    result = xTaskCreate(linx_thread_entry, name,
+                         (configSTACK_DEPTH_TYPE)((thread->stack_size + sizeof(StackType_t) - 1) / sizeof(StackType_t)),
+                         thread, priority, &thread->task);
+#if configUSE_CORE_AFFINITY && configNUMBER_OF_CORES > 1
+    if (result == pdPASS && attr->core_mask != 0) {
+        vTaskCoreAffinitySet(thread->task, (UBaseType_t)attr->core_mask);
+    }
+#endif
+#endif
+    if (result != pdPASS) {
+        LOG_ERROR("Failed to create task %s (%zu bytes of stack)", name, thread->stack_size);
+        vSemaphoreDelete(thread->done);
+        LINX_FREE(thread);
+        return NULL;
+    }
+    return thread;
+}
+
+int linx_thread_join(linx_thread_t* thread) {
+    if (!thread) {
+        return -1;
+    }
+    xSemaphoreTake(thread->done, portMAX_DELAY);
+    /* 入口释放信号量后立即 vTaskDelete(NULL)，任务栈由空闲任务回收 */
+    vSemaphoreDelete(thread->done);
+    LINX_FREE(thread);
+    return 0;
+}
+
+int linx_thread_configure_current(const linx_thread_attr_t* attr) {
+    if (!attr) {
+        return -1;
+    }
+    int result = 0;
+    /* 任务名在创建时确定，这里只调整优先级和核 */
+    if (attr->priority != LINX_THREAD_PRIORITY_DEFAULT || attr->sched_priority > 0) {
+        vTaskPrioritySet(NULL, linx_thread_attr_priority(attr));
+    }
+    if (attr->core_mask != 0) {
+#if !defined(ESP_PLATFORM) && configUSE_CORE_AFFINITY && configNUMBER_OF_CORES > 1
+        vTaskCoreAffinitySet(NULL, (UBaseType_t)attr->core_mask);
+#else
+        /* ESP-IDF 的任务只能在创建时固定核 */
+        LOG_WARN("Task %s: core affinity can only be set at creation", pcTaskGetName(NULL));
+        result = -1;
+#endif
+    }
+    return result;
+}
+
+bool linx_thread_is_current(const linx_thread_t* thread) {
+    return thread && thread->task == xTaskGetCurrentTaskHandle();
+}
+
+size_t linx_thread_stack_size(const linx_thread_t* thread) {
+    return thread ? thread->stack_size : 0;
+}
+
+/* ==================== 互斥锁 ==================== */
+
+linx_mutex_t* linx_mutex_create(void) {
+    return (linx_mutex_t*)xSemaphoreCreateMutex();
+}
+
+void linx_mutex_destroy(linx_mutex_t* mutex) {
+    if (mutex) {
+        vSemaphoreDelete((SemaphoreHandle_t)mutex);
+    }
+}
+
+void linx_mutex_lock(linx_mutex_t* mutex) {
+    xSemaphoreTake((SemaphoreHandle_t)mutex, portMAX_DELAY);
+}
+
+void linx_mutex_unlock(linx_mutex_t* mutex) {
+    xSemaphoreGive((SemaphoreHandle_t)mutex);
+}
+
+/* ==================== 信号量 ==================== */
+
+linx_sem_t* linx_sem_create(unsigned int initial, unsigned int max) {
+    if (max == 0 || initial > max) {
+        return NULL;
+    }
+    return (linx_sem_t*)xSemaphoreCreateCounting((UBaseType_t)max, (UBaseType_t)initial);
+}
+
+void linx_sem_destroy(linx_sem_t* sem) {
+    if (sem) {
+        vSemaphoreDelete((SemaphoreHandle_t)sem);
+    }
+}
+
+bool linx_sem_take(linx_sem_t* sem, int timeout_ms) {
+    return xSemaphoreTake((SemaphoreHandle_t)sem, linx_os_ticks(timeout_ms)) == pdTRUE;
+}
+
+void linx_sem_give(linx_sem_t* sem) {
+    xSemaphoreGive((SemaphoreHandle_t)sem);
+}
+
+/* ==================== 消息队列 ==================== */
+
+linx_queue_t* linx_queue_create(size_t item_size, size_t depth) {
+    if (item_size == 0 || depth == 0) {
+        return NULL;
+    }
+    return (linx_queue_t*)xQueueCreate((UBaseType_t)depth, (UBaseType_t)item_size);
+}
+
+void linx_queue_destroy(linx_queue_t* queue) {
+    if (queue) {
+        vQueueDelete((QueueHandle_t)queue);
+    }
+}
+
+bool linx_queue_send(linx_queue_t* queue, const void* item, int timeout_ms) {
+    return xQueueSend((QueueHandle_t)queue, item, linx_os_ticks(timeout_ms)) == pdTRUE;
+}
+
+bool linx_queue_recv(linx_queue_t* queue, void* item, int timeout_ms) {
+    return xQueueReceive((QueueHandle_t)queue, item, linx_os_ticks(timeout_ms)) == pdTRUE;
+}
+
+size_t linx_queue_count(linx_queue_t* queue) {
+    return (size_t)uxQueueMessagesWaiting((QueueHandle_t)queue);
+}
+
+/* ==================== 时间 ==================== */
+
+uint64_t linx_os_now_us(void) {
+#ifdef ESP_PLATFORM
+    return (uint64_t)esp_timer_get_time();
+#else
+    /* 32 位 tick 计数约 49 天（1 kHz）回绕一次，这里按回绕次数扩展为 64 位 */
+    static TickType_t last_ticks;
+    static uint64_t wraps;
+    taskENTER_CRITICAL();
+    TickType_t ticks = xTaskGetTickCount();
+    if (ticks < last_ticks) {
+        wraps++;
+    }
+    last_ticks = ticks;
+    uint64_t total = wraps * ((uint64_t)portMAX_DELAY + 1) + ticks;
+    taskEXIT_CRITICAL();
+    return total * 1000000ull / configTICK_RATE_HZ;
+#endif
+}
+
+uint64_t linx_os_now_ms(void) {
+    return linx_os_now_us() / 1000u;
+}
+
+void linx_os_sleep_ms(unsigned int ms) {
+    vTaskDelay(linx_os_ticks((int)ms));
+}
+
+#endif /* LINX_OS_FREERTOS */
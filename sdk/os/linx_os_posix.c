@@ -0,0 +1,410 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "linx_os.h"
+
+#if !LINX_OS_FREERTOS
+
+#include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
+#include <pthread.h>
+#include <sched.h>
+#include <errno.h>
+#include <limits.h>
+#include <string.h>
+#include <time.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_CORE);
+
+/* Linux 线程名最长 15 字节 */
+#define LINX_OS_THREAD_NAME_SIZE 16
+
+struct linx_thread {
+    pthread_t tid;
+    linx_thread_func_t func;
+    void* arg;
+    char name[LINX_OS_THREAD_NAME_SIZE];
+    size_t stack_size;
+};
+
+struct linx_mutex {
+    pthread_mutex_t mutex;
+};
+
+struct linx_sem {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    unsigned int count;
+    unsigned int max;
+};
+
+struct linx_queue {
+    pthread_mutex_t mutex;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    uint8_t* items;
+    size_t item_size;
+    size_t depth;
+    size_t head;
+    size_t count;
+};
+
+/* 计算 timeout_ms 之后的绝对时间（pthread_cond_timedwait 使用 CLOCK_REALTIME） */
+static void linx_os_deadline(struct timespec* deadline, int timeout_ms) {
+    clock_gettime(CLOCK_REALTIME, deadline);
+    deadline->tv_sec += timeout_ms / 1000;
+    deadline->tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline->tv_nsec >= 1000000000L) {
+        deadline->tv_sec++;
+        deadline->tv_nsec -= 1000000000L;
+    }
+}
+
+/* 在条件变量上等待到 deadline；返回 false 表示超时 */
+static bool linx_os_cond_wait(pthread_cond_t* cond, pthread_mutex_t* mutex, int timeout_ms,
+                              const struct timespec* deadline) {
+    if (timeout_ms < 0) {
+        pthread_cond_wait(cond, mutex);
+        return true;
+    }
+    return pthread_cond_timedwait(cond, mutex, deadline) != ETIMEDOUT;
+}
+
+/* ==================== 线程 ==================== */
+
+static void* linx_thread_entry(void* arg) {
+    linx_thread_t* thread = (linx_thread_t*)arg;
+#if defined(__APPLE__)
+    pthread_setname_np(thread->name);
+#elif defined(__linux__)
+    pthread_setname_np(pthread_self(), thread->name);
+#endif
+    return thread->func(thread->arg);
+}
+
+/*
+ * 实时调度需要权限（root 或 CAP_SYS_NICE / RLIMIT_RTPRIO），失败时保持默认调度；
+ * sched_priority 优先，否则只有 REALTIME 档位使用 SCHED_FIFO 的最低实时优先级
+ */
+static bool linx_thread_apply_priority(pthread_t tid, const char* name, const linx_thread_attr_t* attr) {
+    int sched_priority = attr->sched_priority;
+    if (sched_priority <= 0) {
+        if (attr->priority != LINX_THREAD_PRIORITY_REALTIME) {
+            return true;
+        }
+        sched_priority = sched_get_priority_min(SCHED_FIFO) + 1;
+    }
+    int min = sched_get_priority_min(SCHED_FIFO);
+    int max = sched_get_priority_max(SCHED_FIFO);
+    if (sched_priority < min) {
+        sched_priority = min;
+    } else if (sched_priority > max) {
+        sched_priority = max;
+    }
+
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = sched_priority;
+    int result = pthread_setschedparam(tid, SCHED_FIFO, &param);
+    if (result != 0) {
+        LOG_DEBUG("Thread %s keeps the default scheduler (SCHED_FIFO %d: %s)", name, sched_priority,
+                  strerror(result));
+        return false;
+    }
+    return true;
+}
+
+static bool linx_thread_apply_affinity(pthread_t tid, const char* name, unsigned int core_mask) {
+    if (core_mask == 0) {
+        return true;
+    }
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (unsigned int core = 0; core < sizeof(core_mask) * 8; core++) {
+        if (core_mask & (1u << core)) {
+            CPU_SET(core, &set);
+        }
+    }
+    int result = pthread_setaffinity_np(tid, sizeof(set), &set);
+    if (result != 0) {
+        LOG_WARN("Failed to pin thread %s to cores 0x%x: %s", name, core_mask, strerror(result));
+        return false;
+    }
+    return true;
+#else
+    (void)tid;
+    LOG_DEBUG("Thread %s: core affinity is not supported on this platform", name);
+    return false;
+#endif
+}
+
+linx_thread_t* linx_thread_create(const linx_thread_attr_t* attr, linx_thread_func_t func, void* arg) {
+    if (!func) {
+        return NULL;
+    }
+    linx_thread_attr_t defaults;
+    memset(&defaults, 0, sizeof(defaults));
+    if (!attr) {
+        attr = &defaults;
+    }
+
+    linx_thread_t* thread = (linx_thread_t*)LINX_CALLOC(1, sizeof(linx_thread_t));
+    if (!thread) {
+        return NULL;
+    }
+    thread->func = func;
+    thread->arg = arg;
+    strncpy(thread->name, attr->name ? attr->name : "linx", sizeof(thread->name) - 1);
+
+    pthread_attr_t pattr;
+    pthread_attr_init(&pattr);
+    if (attr->stack_size > 0) {
+        size_t stack_size = attr->stack_size < (size_t)PTHREAD_STACK_MIN ? (size_t)PTHREAD_STACK_MIN : attr->stack_size;
+        if (pthread_attr_setstacksize(&pattr, stack_size) != 0) {
+            LOG_WARN("Invalid stack size %zu for thread %s, using the default", attr->stack_size, thread->name);
+        }
+    }
+    pthread_attr_getstacksize(&pattr, &thread->stack_size);
+
+    int result = pthread_create(&thread->tid, &pattr, linx_thread_entry, thread);
+    pthread_attr_destroy(&pattr);
+    if (result != 0) {
+        LOG_ERROR("Failed to create thread %s: %s", thread->name, strerror(result));
+        LINX_FREE(thread);
+        return NULL;
+    }
+
+    linx_thread_apply_priority(thread->tid, thread->name, attr);
+    linx_thread_apply_affinity(thread->tid, thread->name, attr->core_mask);
+    return thread;
+}
+
+int linx_thread_configure_current(const linx_thread_attr_t* attr) {
+    if (!attr) {
+        return -1;
+    }
+    char name[LINX_OS_THREAD_NAME_SIZE] = {0};
+    if (attr->name) {
+        strncpy(name, attr->name, sizeof(name) - 1);
+#if defined(__APPLE__)
+        pthread_setname_np(name);
+#elif defined(__linux__)
+        pthread_setname_np(pthread_self(), name);
+#endif
+    } else {
+        strncpy(name, "current", sizeof(name) - 1);
+    }
+    bool ok = linx_thread_apply_priority(pthread_self(), name, attr);
+    ok = linx_thread_apply_affinity(pthread_self(), name, attr->core_mask) && ok;
+    return ok ? 0 : -1;
+}
+
+int linx_thread_join(linx_thread_t* thread) {
+    if (!thread) {
+        return -1;
+    }
+    int result = pthread_join(thread->tid, NULL);
+    LINX_FREE(thread);
+    return result == 0 ? 0 : -1;
+}
+
+bool linx_thread_is_current(const linx_thread_t* thread) {
+    return thread && pthread_equal(thread->tid, pthread_self());
+}
+
+size_t linx_thread_stack_size(const linx_thread_t* thread) {
+    return thread ? thread->stack_size : 0;
+}
+
+/* ==================== 互斥锁 ==================== */
+
+linx_mutex_t* linx_mutex_create(void) {
+    linx_mutex_t* mutex = (linx_mutex_t*)LINX_CALLOC(1, sizeof(linx_mutex_t));
+    if (mutex && pthread_mutex_init(&mutex->mutex, NULL) != 0) {
+        LINX_FREE(mutex);
+        return NULL;
+    }
+    return mutex;
+}
+
+void linx_mutex_destroy(linx_mutex_t* mutex) {
+    if (!mutex) {
+        return;
+    }
+    pthread_mutex_destroy(&mutex->mutex);
+    LINX_FREE(mutex);
+}
+
+void linx_mutex_lock(linx_mutex_t* mutex) {
+    pthread_mutex_lock(&mutex->mutex);
+}
+
+void linx_mutex_unlock(linx_mutex_t* mutex) {
+    pthread_mutex_unlock(&mutex->mutex);
+}
+
+/* ==================== 信号量 ==================== */
+
+/* macOS 不支持匿名 sem_t，统一用条件变量实现 */
+linx_sem_t* linx_sem_create(unsigned int initial, unsigned int max) {
+    if (max == 0 || initial > max) {
+        return NULL;
+    }
+    linx_sem_t* sem = (linx_sem_t*)LINX_CALLOC(1, sizeof(linx_sem_t));
+    if (!sem) {
+        return NULL;
+    }
+    pthread_mutex_init(&sem->mutex, NULL);
+    pthread_cond_init(&sem->cond, NULL);
+    sem->count = initial;
+    sem->max = max;
+    return sem;
+}
+
+void linx_sem_destroy(linx_sem_t* sem) {
+    if (!sem) {
+        return;
+    }
+    pthread_cond_destroy(&sem->cond);
+    pthread_mutex_destroy(&sem->mutex);
+    LINX_FREE(sem);
+}
+
+bool linx_sem_take(linx_sem_t* sem, int timeout_ms) {
+    struct timespec deadline;
+    if (timeout_ms > 0) {
+        linx_os_deadline(&deadline, timeout_ms);
+    }
+    pthread_mutex_lock(&sem->mutex);
+    while (sem->count == 0 && timeout_ms != 0) {
+        if (!linx_os_cond_wait(&sem->cond, &sem->mutex, timeout_ms, &deadline)) {
+            break;
+        }
+    }
+    bool taken = sem->count > 0;
+    if (taken) {
+        sem->count--;
+    }
+    pthread_mutex_unlock(&sem->mutex);
+    return taken;
+}
+
+void linx_sem_give(linx_sem_t* sem) {
+    pthread_mutex_lock(&sem->mutex);
+    if (sem->count < sem->max) {
+        sem->count++;
+    }
+    pthread_cond_signal(&sem->cond);
+    pthread_mutex_unlock(&sem->mutex);
+}
+
+/* ==================== 消息队列 ==================== */
+
+linx_queue_t* linx_queue_create(size_t item_size, size_t depth) {
+    if (item_size == 0 || depth == 0) {
+        return NULL;
+    }
+    linx_queue_t* queue = (linx_queue_t*)LINX_CALLOC(1, sizeof(linx_queue_t));
+    if (!queue) {
+        return NULL;
+    }
+    queue->items = (uint8_t*)LINX_MALLOC_BULK(item_size * depth);
+    if (!queue->items) {
+        LINX_FREE(queue);
+        return NULL;
+    }
+    pthread_mutex_init(&queue->mutex, NULL);
+    pthread_cond_init(&queue->not_empty, NULL);
+    pthread_cond_init(&queue->not_full, NULL);
+    queue->item_size = item_size;
+    queue->depth = depth;
+    return queue;
+}
+
+void linx_queue_destroy(linx_queue_t* queue) {
+    if (!queue) {
+        return;
+    }
+    pthread_cond_destroy(&queue->not_full);
+    pthread_cond_destroy(&queue->not_empty);
+    pthread_mutex_destroy(&queue->mutex);
+    LINX_FREE(queue->items);
+    LINX_FREE(queue);
+}
+
+bool linx_queue_send(linx_queue_t* queue, const void* item, int timeout_ms) {
+    struct timespec deadline;
+    if (timeout_ms > 0) {
+        linx_os_deadline(&deadline, timeout_ms);
+    }
+    pthread_mutex_lock(&queue->mutex);
+    while (queue->count == queue->depth && timeout_ms != 0) {
+        if (!linx_os_cond_wait(&queue->not_full, &queue->mutex, timeout_ms, &deadline)) {
+            break;
+        }
+    }
+    bool sent = queue->count < queue->depth;
+    if (sent) {
+        size_t tail = (queue->head + queue->count) % queue->depth;
+        memcpy(queue->items + tail * queue->item_size, item, queue->item_size);
+        queue->count++;
+        pthread_cond_signal(&queue->not_empty);
+    }
+    pthread_mutex_unlock(&queue->mutex);
+    return sent;
+}
+
+bool linx_queue_recv(linx_queue_t* queue, void* item, int timeout_ms) {
+    struct timespec deadline;
+    if (timeout_ms > 0) {
+        linx_os_deadline(&deadline, timeout_ms);
+    }
+    pthread_mutex_lock(&queue->mutex);
+    while (queue->count == 0 && timeout_ms != 0) {
+        if (!linx_os_cond_wait(&queue->not_empty, &queue->mutex, timeout_ms, &deadline)) {
+            break;
+        }
+    }
+    bool received = queue->count > 0;
+    if (received) {
+        memcpy(item, queue->items + queue->head * queue->item_size, queue->item_size);
+        queue->head = (queue->head + 1) % queue->depth;
+        queue->count--;
+        pthread_cond_signal(&queue->not_full);
+    }
+    pthread_mutex_unlock(&queue->mutex);
+    return received;
+}
+
+size_t linx_queue_count(linx_queue_t* queue) {
+    pthread_mutex_lock(&queue->mutex);
+    size_t count = queue->count;
+    pthread_mutex_unlock(&queue->mutex);
+    return count;
+}
+
+/* ==================== 时间 ==================== */
+
+uint64_t linx_os_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ull + (uint64_t)ts.tv_nsec / 1000ull;
+}
+
+uint64_t linx_os_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000ull + (uint64_t)(ts.tv_nsec / 1000000);
+}
+
+void linx_os_sleep_ms(unsigned int ms) {
+    struct timespec ts;
+    ts.tv_sec = ms / 1000;
+    ts.tv_nsec = (long)(ms % 1000) * 1000000L;
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+    }
+}
+
+#endif /* !LINX_OS_FREERTOS */
@@ -5,35 +5,86 @@
 
 #include "linx_ota.h"
 #include "../third/mongoose/mongoose.h"
+#include "../linx_crypto.h"
 #include "../cjson/cJSON.h"
 #include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
 
+#include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-#define OTA_TAG "LINX_OTA"
+LINX_LOG_TAG_DEFINE(s_ota_log, "LINX_OTA");
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_OTA);
+#define OTA_MAX_HEADER_SIZE 8192    // Give up if the response headers do not fit
+#define OTA_RESUME_SAVE_INTERVAL (64 * 1024)    // Persist resume state every this many bytes
+#define OTA_RETRY_DELAY_MS 1000
+#define OTA_RESUME_MAGIC 0x4f54414cu    // "LATO"
+#define OTA_RESUME_VERSION 2
+#define OTA_SYNC_POLL_MS 100            // Longest the blocking calls sleep in mg_mgr_poll
+#define OTA_THROTTLE_WINDOW_MS 100      // The bandwidth limit is enforced per window
 
-// Define LINX log macros
-#define LINX_LOGE(tag, fmt, ...) LOG_ERROR("[%s] " fmt, tag, ##__VA_ARGS__)
-#define LINX_LOGW(tag, fmt, ...) LOG_WARN("[%s] " fmt, tag, ##__VA_ARGS__)
-#define LINX_LOGI(tag, fmt, ...) LOG_INFO("[%s] " fmt, tag, ##__VA_ARGS__)
-
-// OTA context structure
+// Resume state file contents (device-local, native byte order)
 typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    char url[256];                  // Firmware URL the record belongs to
+    char sha256[65];                // Expected image digest (hex), may be empty
+    char etag[64];                  // ETag of the first response, sent as If-Range
+    uint64_t image_size;
+    uint64_t offset;                // Bytes already in the sink
+    char crypto[16];                // Crypto provider that produced sha256_state
+    linx_sha256_state_t sha256_state;   // Hash state at offset
+} ota_resume_record_t;
+
+// OTA instance: one per device session, no state is shared between instances
+struct linx_ota {
     linx_ota_config_t config;
-    struct mg_mgr mgr;
-    bool initialized;
+    struct mg_mgr mgr;              // Own manager, polled by the blocking calls
     bool request_in_progress;
-    bool download_in_progress;
+    bool download_in_progress;      // Set from start until the download completes, across retries
     linx_ota_info_t info;
-    char *download_buffer;
-    size_t download_size;
-    size_t download_received;
+    linx_ota_status_t check_status;
     void (*progress_cb)(int percentage);
-} ota_ctx_t;
 
-static ota_ctx_t s_ota_ctx = {0};
+    // Operation currently running
+    struct mg_mgr *active_mgr;      // Manager the download runs on
+    struct mg_connection *conn;     // Connection of the current request or attempt, NULL between attempts
+    linx_ota_event_cb_t event_cb;
+    void *event_user_data;
+    linx_ota_sink_t *owned_sink;    // Destroyed when the download completes (async delta)
+
+    // Download state
+    linx_ota_sink_t *sink;
+    bool sink_opened;               // open() or resume() succeeded, abort() on failure
+    bool resumable;                 // Sink can continue after a restart
+    linx_ota_status_t download_status;
+    int attempt;                    // Retries used so far
+    uint64_t retry_at;              // mg_millis() of the next attempt, 0 = none scheduled
+    bool retryable;                 // Attempt failed in a way a Range retry can fix
+    bool headers_received;
+    char url[256];
+    char etag[64];
+    size_t download_size;           // Image size
+    size_t download_received;       // Image offset after the last received byte
+    size_t written;                 // Bytes handed to the sink
+    size_t saved_offset;            // Offset in the resume state file
+    int download_percentage;
+    uint8_t *chunk_buffer;          // Pending bytes, flushed to the sink when full
+    size_t chunk_size;
+    size_t chunk_used;
+    bool verify_sha256;             // Expected digest available
+    uint8_t expected_sha256[32];
+    char expected_sha256_hex[65];
+    linx_sha256_ctx_t sha256;       // Hash of the bytes handed to the sink
+
+    // Bandwidth limit: reads pause (is_full) once a window's budget is used up
+    uint64_t throttle_window_start;
+    size_t throttle_window_bytes;
+    uint64_t throttle_until;        // Reads resume at this mg_millis(), 0 = not paused
+    bool paused;                    // linx_ota_set_paused(): reads and retries held
+};
 
 // Status strings
 static const char *s_ota_status_str[] = {
@@ -47,6 +98,22 @@ static const char *s_ota_status_str[] = {
     "OTA in progress"
 };
 
+bool linx_ota_parse_sha256(const char *hex, uint8_t digest[32]) {
+    if (!hex || strlen(hex) != 64) {
+        return false;
+    }
+    for (int i = 0; i < 32; i++) {
+        int hi = (unsigned char) hex[2 * i], lo = (unsigned char) hex[2 * i + 1];
+        if (!isxdigit(hi) || !isxdigit(lo)) {
+            return false;
+        }
+        hi = isdigit(hi) ? hi - '0' : tolower(hi) - 'a' + 10;
+        lo = isdigit(lo) ? lo - '0' : tolower(lo) - 'a' + 10;
+        digest[i] = (uint8_t)((hi << 4) | lo);
+    }
+    return true;
+}
+
 // Forward declarations
 static void ota_http_handler(struct mg_connection *c, int ev, void *ev_data);
 static void ota_download_handler(struct mg_connection *c, int ev, void *ev_data);
@@ -58,82 +125,169 @@ const char *linx_ota_status_str(linx_ota_status_t status) {
     return s_ota_status_str[status];
 }
 
-linx_ota_status_t linx_ota_init(const linx_ota_config_t *config) {
+linx_ota_t *linx_ota_create(const linx_ota_config_t *config) {
     if (config == NULL) {
-        LINX_LOGE(OTA_TAG, "Invalid OTA configuration");
-        return LINX_OTA_ERROR_INIT;
+        LINX_LOGE(s_ota_log, "Invalid OTA configuration");
+        return NULL;
     }
 
-    if (s_ota_ctx.initialized) {
-        linx_ota_cleanup();
+    linx_ota_t *ota = (linx_ota_t *) LINX_CALLOC(1, sizeof(linx_ota_t));
+    if (ota == NULL) {
+        LINX_LOGE(s_ota_log, "Failed to allocate OTA instance");
+        return NULL;
     }
 
-    // Initialize mongoose
-    mg_mgr_init(&s_ota_ctx.mgr);
+    // Own manager for the blocking calls; the *_async calls use the caller's
+    mg_mgr_init(&ota->mgr);
 
     // Copy configuration
-    memcpy(&s_ota_ctx.config, config, sizeof(linx_ota_config_t));
-    s_ota_ctx.progress_cb = config->progress_cb;
-    s_ota_ctx.initialized = true;
-    s_ota_ctx.request_in_progress = false;
-    s_ota_ctx.download_in_progress = false;
+    memcpy(&ota->config, config, sizeof(linx_ota_config_t));
+    ota->progress_cb = config->progress_cb;
 
-    LINX_LOGI(OTA_TAG, "OTA module initialized");
-    return LINX_OTA_SUCCESS;
+    LINX_LOGI(s_ota_log, "OTA instance created");
+    return ota;
+}
+
+void linx_ota_destroy(linx_ota_t *ota) {
+    if (ota == NULL) {
+        return;
+    }
+    linx_ota_cancel(ota);
+    mg_mgr_free(&ota->mgr);
+    LINX_FREE(ota->chunk_buffer);
+    LINX_FREE(ota);
+    LINX_LOGI(s_ota_log, "OTA instance destroyed");
 }
 
-void linx_ota_cleanup(void) {
-    if (s_ota_ctx.initialized) {
-        mg_mgr_free(&s_ota_ctx.mgr);
-        if (s_ota_ctx.download_buffer) {
-            free(s_ota_ctx.download_buffer);
-            s_ota_ctx.download_buffer = NULL;
+// Poll the own manager until the operation started on it completes
+static void ota_run_sync(linx_ota_t *ota) {
+    while (linx_ota_busy(ota)) {
+        mg_mgr_poll(&ota->mgr, linx_ota_poll_timeout_ms(ota, OTA_SYNC_POLL_MS));
+        linx_ota_poll(ota);
+    }
+}
+
+static void ota_notify(linx_ota_t *ota, linx_ota_event_cb_t cb, void *user_data, linx_ota_event_type_t type,
+                       linx_ota_status_t status) {
+    if (!cb) {
+        return;
+    }
+    linx_ota_event_t event = {
+        .type = type,
+        .status = status,
+        .info = type == LINX_OTA_EVENT_CHECK_DONE ? &ota->info : NULL,
+        .received = ota->download_received,
+        .total = ota->download_size,
+        .percentage = ota->download_percentage,
+    };
+    cb(&event, user_data);
+}
+
+bool linx_ota_busy(linx_ota_t *ota) {
+    return ota && (ota->request_in_progress || ota->download_in_progress);
+}
+
+void linx_ota_set_paused(linx_ota_t *ota, bool paused) {
+    if (ota == NULL || ota->paused == paused) {
+        return;
+    }
+    ota->paused = paused;
+    if (ota->conn) {
+        ota->conn->is_full = paused || ota->throttle_until != 0;
+    }
+    if (!paused) {
+        ota->throttle_window_start = mg_millis();
+        ota->throttle_window_bytes = 0;
+    }
+    LINX_LOGI(s_ota_log, "Download %s", paused ? "paused" : "resumed");
+}
+
+bool linx_ota_is_paused(linx_ota_t *ota) {
+    return ota && ota->paused;
+}
+
+void linx_ota_set_max_download_rate(linx_ota_t *ota, uint32_t rate) {
+    if (ota == NULL) {
+        return;
+    }
+    ota->config.max_download_rate = rate;
+    // The new limit applies from a fresh window; a pending pause is ended early
+    ota->throttle_window_start = mg_millis();
+    ota->throttle_window_bytes = 0;
+    if (ota->throttle_until) {
+        ota->throttle_until = 0;
+        if (ota->conn && !ota->paused) {
+            ota->conn->is_full = 0;
         }
-        memset(&s_ota_ctx, 0, sizeof(ota_ctx_t));
-        LINX_LOGI(OTA_TAG, "OTA module cleaned up");
     }
 }
 
-linx_ota_status_t linx_ota_check_update(linx_ota_info_t *info) {
-    if (!s_ota_ctx.initialized) {
-        LINX_LOGE(OTA_TAG, "OTA module not initialized");
+uint32_t linx_ota_get_max_download_rate(linx_ota_t *ota) {
+    return ota ? ota->config.max_download_rate : 0;
+}
+
+linx_ota_status_t linx_ota_check_update(linx_ota_t *ota, linx_ota_info_t *info) {
+    if (ota == NULL) {
+        return LINX_OTA_ERROR_INIT;
+    }
+    linx_ota_status_t status = linx_ota_check_update_async(ota, &ota->mgr, NULL, NULL);
+    if (status != LINX_OTA_SUCCESS) {
+        return status;
+    }
+    ota_run_sync(ota);
+
+    // Copy info if provided
+    if (info) {
+        memcpy(info, &ota->info, sizeof(linx_ota_info_t));
+    }
+    return ota->check_status;
+}
+
+linx_ota_status_t linx_ota_check_update_async(linx_ota_t *ota, struct mg_mgr *mgr, linx_ota_event_cb_t cb,
+                                              void *user_data) {
+    if (ota == NULL) {
+        LINX_LOGE(s_ota_log, "OTA instance is NULL");
         return LINX_OTA_ERROR_INIT;
     }
 
-    if (s_ota_ctx.request_in_progress || s_ota_ctx.download_in_progress) {
-        LINX_LOGW(OTA_TAG, "OTA operation already in progress");
+    if (linx_ota_busy(ota)) {
+        LINX_LOGW(s_ota_log, "OTA operation already in progress");
         return LINX_OTA_IN_PROGRESS;
     }
 
+    if (mgr == NULL) {
+        LINX_LOGE(s_ota_log, "Invalid event manager");
+        return LINX_OTA_ERROR_REQUEST;
+    }
+
     // Clear previous info
-    memset(&s_ota_ctx.info, 0, sizeof(linx_ota_info_t));
-    s_ota_ctx.request_in_progress = true;
+    memset(&ota->info, 0, sizeof(linx_ota_info_t));
+    ota->check_status = LINX_OTA_ERROR_REQUEST;
 
     // Prepare JSON request body using string concatenation - matching JavaScript request structure
-    const char *app_name = s_ota_ctx.config.app_name ? s_ota_ctx.config.app_name : "xiaoniu-web-test";
-    const char *compile_time = s_ota_ctx.config.compile_time ? s_ota_ctx.config.compile_time : "2025-04-16 10:00:00";
-    const char *idf_version = s_ota_ctx.config.idf_version ? s_ota_ctx.config.idf_version : "4.4.3";
-    const char *ota_label = s_ota_ctx.config.ota_label ? s_ota_ctx.config.ota_label : "xiaoniu-web-test";
-    const char *ip_address = s_ota_ctx.config.ip_address ? s_ota_ctx.config.ip_address : "192.168.1.1";
+    const char *app_name = ota->config.app_name ? ota->config.app_name : "xiaoniu-web-test";
+    const char *compile_time = ota->config.compile_time ? ota->config.compile_time : "2025-04-16 10:00:00";
+    const char *idf_version = ota->config.idf_version ? ota->config.idf_version : "4.4.3";
+    const char *ota_label = ota->config.ota_label ? ota->config.ota_label : "xiaoniu-web-test";
+    const char *ip_address = ota->config.ip_address ? ota->config.ip_address : "192.168.1.1";
     
     // Calculate buffer size needed
     size_t json_size = 2048; // Base size for JSON structure
     json_size += strlen(app_name) * 2; // Used in multiple places
-    json_size += s_ota_ctx.config.current_version ? strlen(s_ota_ctx.config.current_version) : 0;
+    json_size += ota->config.current_version ? strlen(ota->config.current_version) : 0;
     json_size += strlen(compile_time);
     json_size += strlen(idf_version);
-    json_size += s_ota_ctx.config.elf_sha256 ? strlen(s_ota_ctx.config.elf_sha256) : 0;
+    json_size += ota->config.elf_sha256 ? strlen(ota->config.elf_sha256) : 0;
     json_size += strlen(ota_label);
-    json_size += s_ota_ctx.config.board_type ? strlen(s_ota_ctx.config.board_type) : 0;
-    json_size += s_ota_ctx.config.ssid ? strlen(s_ota_ctx.config.ssid) : 0;
+    json_size += ota->config.board_type ? strlen(ota->config.board_type) : 0;
+    json_size += ota->config.ssid ? strlen(ota->config.ssid) : 0;
     json_size += strlen(ip_address);
-    json_size += s_ota_ctx.config.mac_address ? strlen(s_ota_ctx.config.mac_address) * 2 : 0; // Used twice
-    json_size += s_ota_ctx.config.chip_model ? strlen(s_ota_ctx.config.chip_model) : 0;
+    json_size += ota->config.mac_address ? strlen(ota->config.mac_address) * 2 : 0; // Used twice
+    json_size += ota->config.chip_model ? strlen(ota->config.chip_model) : 0;
     
-    char *json_str = malloc(json_size);
+    char *json_str = LINX_MALLOC(json_size);
     if (!json_str) {
-        LINX_LOGE(OTA_TAG, "Failed to allocate memory for JSON request");
-        s_ota_ctx.request_in_progress = false;
+        LINX_LOGE(s_ota_log, "Failed to allocate memory for JSON request");
         return LINX_OTA_ERROR_REQUEST;
     }
     
@@ -150,7 +304,7 @@ linx_ota_status_t linx_ota_check_update(linx_ota_info_t *info) {
             "\"elf_sha256\":\"%s\""
         "},"
         "\"ota\":{"
-            "\"label\":\"%s\""
+            "\"label\":\"%s\"%s"
         "},"
         "\"board\":{"
             "\"type\":\"%s\","
@@ -179,52 +333,53 @@ linx_ota_status_t linx_ota_check_update(linx_ota_info_t *info) {
         "}]"
         "}",
         app_name,
-        s_ota_ctx.config.current_version ? s_ota_ctx.config.current_version : "",
+        ota->config.current_version ? ota->config.current_version : "",
         compile_time,
         idf_version,
-        s_ota_ctx.config.elf_sha256 ? s_ota_ctx.config.elf_sha256 : "",
+        ota->config.elf_sha256 ? ota->config.elf_sha256 : "",
         ota_label,
-        s_ota_ctx.config.board_type ? s_ota_ctx.config.board_type : "",
-        s_ota_ctx.config.ssid ? s_ota_ctx.config.ssid : "",
-        s_ota_ctx.config.rssi,
-        s_ota_ctx.config.wifi_channel,
+        ota->config.delta_enabled ? ",\"delta_formats\":[\"" LINX_OTA_DELTA_FORMAT "\"]" : "",
+        ota->config.board_type ? ota->config.board_type : "",
+        ota->config.ssid ? ota->config.ssid : "",
+        ota->config.rssi,
+        ota->config.wifi_channel,
         ip_address,
-        s_ota_ctx.config.mac_address ? s_ota_ctx.config.mac_address : "",
-        s_ota_ctx.config.flash_size,
-        s_ota_ctx.config.minimum_free_heap_size,
-        s_ota_ctx.config.mac_address ? s_ota_ctx.config.mac_address : "",
-        s_ota_ctx.config.chip_model ? s_ota_ctx.config.chip_model : "",
-        s_ota_ctx.config.chip_model_id,
-        s_ota_ctx.config.chip_cores,
-        s_ota_ctx.config.chip_revision,
-        s_ota_ctx.config.chip_features
+        ota->config.mac_address ? ota->config.mac_address : "",
+        ota->config.flash_size,
+        ota->config.minimum_free_heap_size,
+        ota->config.mac_address ? ota->config.mac_address : "",
+        ota->config.chip_model ? ota->config.chip_model : "",
+        ota->config.chip_model_id,
+        ota->config.chip_cores,
+        ota->config.chip_revision,
+        ota->config.chip_features
     );
 
     if (json_len < 0 || json_len >= json_size) {
-        LINX_LOGE(OTA_TAG, "Failed to create JSON request - buffer too small");
-        free(json_str);
-        s_ota_ctx.request_in_progress = false;
+        LINX_LOGE(s_ota_log, "Failed to create JSON request - buffer too small");
+        LINX_FREE(json_str);
         return LINX_OTA_ERROR_REQUEST;
     }
     
     // Debug: Log the JSON request
-    LINX_LOGI(OTA_TAG, "Sending JSON request (%d bytes): %s", json_len, json_str);
+    LINX_LOGI(s_ota_log, "Sending JSON request (%d bytes): %s", json_len, json_str);
 
     // Create HTTP connection
-    struct mg_connection *c = mg_http_connect(&s_ota_ctx.mgr, s_ota_ctx.config.ota_server_url, 
-                                             ota_http_handler, NULL);
+    struct mg_connection *c = mg_http_connect(mgr, ota->config.ota_server_url, 
+                                             ota_http_handler, ota);
     if (c == NULL) {
-        LINX_LOGE(OTA_TAG, "Failed to create HTTP connection");
-        free(json_str);
-        s_ota_ctx.request_in_progress = false;
+        LINX_LOGE(s_ota_log, "Failed to create HTTP connection");
+        LINX_FREE(json_str);
         return LINX_OTA_ERROR_REQUEST;
     }
     
-    // Store the info pointer in the connection's user data
-    c->fn_data = info;
+    ota->conn = c;
+    ota->event_cb = cb;
+    ota->event_user_data = user_data;
+    ota->request_in_progress = true;
 
     // Extract hostname safely
-    struct mg_str host = mg_url_host(s_ota_ctx.config.ota_server_url);
+    struct mg_str host = mg_url_host(ota->config.ota_server_url);
     char host_str[256] = {0};
     if (host.len > 0 && host.len < sizeof(host_str)) {
         strncpy(host_str, host.buf, host.len);
@@ -249,92 +404,146 @@ linx_ota_status_t linx_ota_check_update(linx_ota_info_t *info) {
               "%s",
               host_str,
               json_len,
-              s_ota_ctx.config.user_agent ? s_ota_ctx.config.user_agent : "LinxOS-OTA/1.0",
-              s_ota_ctx.config.client_id ? s_ota_ctx.config.client_id : "",
-              s_ota_ctx.config.device_id ? s_ota_ctx.config.device_id : "",
+              ota->config.user_agent ? ota->config.user_agent : "LinxOS-OTA/1.0",
+              ota->config.client_id ? ota->config.client_id : "",
+              ota->config.device_id ? ota->config.device_id : "",
               json_str);
 
-    free(json_str);
-
-    // Poll for events
-    while (s_ota_ctx.request_in_progress) {
-        mg_mgr_poll(&s_ota_ctx.mgr, 1000);
-    }
+    LINX_FREE(json_str);
+    return LINX_OTA_SUCCESS;
+}
 
-    // Copy info if provided
-    if (info) {
-        memcpy(info, &s_ota_ctx.info, sizeof(linx_ota_info_t));
-    }
+// The check is over; the callback may start the next operation
+static void ota_check_finish(linx_ota_t *ota, linx_ota_status_t status) {
+    linx_ota_event_cb_t cb = ota->event_cb;
+    void *user_data = ota->event_user_data;
 
-    return s_ota_ctx.info.update_available ? LINX_OTA_SUCCESS : LINX_OTA_NO_UPDATE;
+    ota->check_status = status;
+    ota->request_in_progress = false;
+    ota->conn = NULL;
+    ota->event_cb = NULL;
+    ota->event_user_data = NULL;
+    ota_notify(ota, cb, user_data, LINX_OTA_EVENT_CHECK_DONE, status);
 }
 
+
 static void ota_http_handler(struct mg_connection *c, int ev, void *ev_data) {
-    linx_ota_info_t *info = (linx_ota_info_t *)c->fn_data;
-    
+    linx_ota_t *ota = (linx_ota_t *) c->fn_data;
+
+    // Cancelled requests linger until mongoose closes them
+    if (c != ota->conn) {
+        return;
+    }
+
     if (ev == MG_EV_HTTP_MSG) {
         struct mg_http_message *hm = (struct mg_http_message *) ev_data;
         int status_code = mg_http_status(hm);
+        linx_ota_status_t status = LINX_OTA_ERROR_REQUEST;
         
         if (status_code == 200) {
             // Parse JSON response
             cJSON *root = cJSON_ParseWithLength(hm->body.buf, hm->body.len);
             if (root) {
                 // Extract activation info
-                cJSON *activation = cJSON_GetObjectItem(root, "activation");
+                cJSON *activation = cJSON_GetObjectItemCaseSensitive(root, "activation");
                 if (activation) {
-                    cJSON *code = cJSON_GetObjectItem(activation, "code");
-                    cJSON *message = cJSON_GetObjectItem(activation, "message");
+                    cJSON *code = cJSON_GetObjectItemCaseSensitive(activation, "code");
+                    cJSON *message = cJSON_GetObjectItemCaseSensitive(activation, "message");
                     
                     if (cJSON_IsString(code) && code->valuestring) {
-                        strncpy(s_ota_ctx.info.activation_code, code->valuestring, 
-                                sizeof(s_ota_ctx.info.activation_code) - 1);
+                        strncpy(ota->info.activation_code, code->valuestring, 
+                                sizeof(ota->info.activation_code) - 1);
                     }
                     
                     if (cJSON_IsString(message) && message->valuestring) {
-                        strncpy(s_ota_ctx.info.activation_message, message->valuestring, 
-                                sizeof(s_ota_ctx.info.activation_message) - 1);
+                        strncpy(ota->info.activation_message, message->valuestring, 
+                                sizeof(ota->info.activation_message) - 1);
                     }
                 }
                 
                 // Extract websocket info
-                cJSON *websocket = cJSON_GetObjectItem(root, "websocket");
+                cJSON *websocket = cJSON_GetObjectItemCaseSensitive(root, "websocket");
                 if (websocket) {
-                    cJSON *url = cJSON_GetObjectItem(websocket, "url");
+                    cJSON *url = cJSON_GetObjectItemCaseSensitive(websocket, "url");
                     if (cJSON_IsString(url) && url->valuestring) {
-                        strncpy(s_ota_ctx.info.websocket_url, url->valuestring, 
-                                sizeof(s_ota_ctx.info.websocket_url) - 1);
+                        strncpy(ota->info.websocket_url, url->valuestring, 
+                                sizeof(ota->info.websocket_url) - 1);
+                    }
+                    
+                    // Other regions the device may pick by connection health
+                    cJSON *urls = cJSON_GetObjectItemCaseSensitive(websocket, "urls");
+                    cJSON *item = NULL;
+                    cJSON_ArrayForEach(item, urls) {
+                        size_t used = strlen(ota->info.websocket_urls);
+                        if (!cJSON_IsString(item) || !item->valuestring || !item->valuestring[0] ||
+                            used + strlen(item->valuestring) + 2 > sizeof(ota->info.websocket_urls)) {
+                            continue;
+                        }
+                        snprintf(ota->info.websocket_urls + used, sizeof(ota->info.websocket_urls) - used,
+                                 "%s%s", used ? "," : "", item->valuestring);
                     }
                 }
                 
                 // Extract firmware info
-                cJSON *firmware = cJSON_GetObjectItem(root, "firmware");
+                cJSON *firmware = cJSON_GetObjectItemCaseSensitive(root, "firmware");
                 if (firmware) {
-                    cJSON *version = cJSON_GetObjectItem(firmware, "version");
-                    cJSON *url = cJSON_GetObjectItem(firmware, "url");
+                    cJSON *version = cJSON_GetObjectItemCaseSensitive(firmware, "version");
+                    cJSON *url = cJSON_GetObjectItemCaseSensitive(firmware, "url");
                     
                     if (cJSON_IsString(version) && version->valuestring) {
-                        strncpy(s_ota_ctx.info.firmware_version, version->valuestring, 
-                                sizeof(s_ota_ctx.info.firmware_version) - 1);
+                        strncpy(ota->info.firmware_version, version->valuestring, 
+                                sizeof(ota->info.firmware_version) - 1);
                     }
                     
                     if (cJSON_IsString(url) && url->valuestring) {
-                        strncpy(s_ota_ctx.info.firmware_url, url->valuestring, 
-                                sizeof(s_ota_ctx.info.firmware_url) - 1);
-                        s_ota_ctx.info.update_available = true;
+                        strncpy(ota->info.firmware_url, url->valuestring, 
+                                sizeof(ota->info.firmware_url) - 1);
+                        ota->info.update_available = true;
+                    }
+
+                    uint8_t digest[32];
+                    cJSON *sha256 = cJSON_GetObjectItemCaseSensitive(firmware, "sha256");
+                    if (cJSON_IsString(sha256) && linx_ota_parse_sha256(sha256->valuestring, digest)) {
+                        strncpy(ota->info.firmware_sha256, sha256->valuestring, 
+                                sizeof(ota->info.firmware_sha256) - 1);
+                    } else if (sha256) {
+                        LINX_LOGW(s_ota_log, "Ignoring malformed firmware sha256");
+                    }
+
+                    // A delta is only usable if it was made against the image we are running
+                    cJSON *delta = cJSON_GetObjectItemCaseSensitive(firmware, "delta");
+                    if (ota->config.delta_enabled && cJSON_IsObject(delta)) {
+                        cJSON *delta_url = cJSON_GetObjectItemCaseSensitive(delta, "url");
+                        cJSON *delta_sha256 = cJSON_GetObjectItemCaseSensitive(delta, "sha256");
+                        cJSON *base_sha256 = cJSON_GetObjectItemCaseSensitive(delta, "base_sha256");
+                        cJSON *format = cJSON_GetObjectItemCaseSensitive(delta, "format");
+                        uint8_t base_digest[32], current_digest[32];
+
+                        if (cJSON_IsString(delta_url) && delta_url->valuestring[0] &&
+                            strlen(delta_url->valuestring) < sizeof(ota->info.delta_url) &&
+                            cJSON_IsString(format) && strcmp(format->valuestring, LINX_OTA_DELTA_FORMAT) == 0 &&
+                            cJSON_IsString(base_sha256) &&
+                            linx_ota_parse_sha256(base_sha256->valuestring, base_digest) &&
+                            linx_ota_parse_sha256(ota->config.elf_sha256, current_digest) &&
+                            memcmp(base_digest, current_digest, sizeof(base_digest)) == 0) {
+                            strcpy(ota->info.delta_url, delta_url->valuestring);
+                            if (cJSON_IsString(delta_sha256) && linx_ota_parse_sha256(delta_sha256->valuestring, digest)) {
+                                strcpy(ota->info.delta_sha256, delta_sha256->valuestring);
+                            }
+                            ota->info.delta_available = true;
+                        } else {
+                            LINX_LOGW(s_ota_log, "Ignoring delta package that does not match the running image");
+                        }
                     }
                 }
                 
                 cJSON_Delete(root);
                 
-                LINX_LOGI(OTA_TAG, "OTA check completed, update available: %d", 
-                         s_ota_ctx.info.update_available);
-                
-                if (info) {
-                    memcpy(info, &s_ota_ctx.info, sizeof(linx_ota_info_t));
-                }
+                LINX_LOGI(s_ota_log, "OTA check completed, update available: %d", 
+                         ota->info.update_available);
+                status = ota->info.update_available ? LINX_OTA_SUCCESS : LINX_OTA_NO_UPDATE;
             } else {
-                LINX_LOGE(OTA_TAG, "Failed to parse OTA response");
+                LINX_LOGE(s_ota_log, "Failed to parse OTA response");
             }
         } else {
             // Log the response body for debugging
@@ -344,58 +553,172 @@ static void ota_http_handler(struct mg_connection *c, int ev, void *ev_data) {
                 strncpy(response_body, hm->body.buf, body_len);
                 response_body[body_len] = '\0';
             }
-            LINX_LOGE(OTA_TAG, "OTA check failed with status code: %d, response: %s", status_code, response_body);
+            LINX_LOGE(s_ota_log, "OTA check failed with status code: %d, response: %s", status_code, response_body);
         }
         
-        s_ota_ctx.request_in_progress = false;
         c->is_closing = 1;
+        ota_check_finish(ota, status);
     } else if (ev == MG_EV_ERROR || ev == MG_EV_CLOSE) {
-        if (s_ota_ctx.request_in_progress) {
-            LINX_LOGE(OTA_TAG, "OTA check connection error or closed");
-            s_ota_ctx.request_in_progress = false;
-        }
+        LINX_LOGE(s_ota_log, "OTA check connection error or closed");
+        ota_check_finish(ota, LINX_OTA_ERROR_REQUEST);
     }
 }
 
-linx_ota_status_t linx_ota_download(const linx_ota_info_t *info, const char *download_path) {
-    if (!s_ota_ctx.initialized) {
-        LINX_LOGE(OTA_TAG, "OTA module not initialized");
-        return LINX_OTA_ERROR_INIT;
+linx_ota_status_t linx_ota_download(linx_ota_t *ota, const linx_ota_info_t *info, const char *download_path) {
+    if (!download_path) {
+        LINX_LOGE(s_ota_log, "Invalid download path");
+        return LINX_OTA_ERROR_DOWNLOAD;
     }
 
-    if (s_ota_ctx.request_in_progress || s_ota_ctx.download_in_progress) {
-        LINX_LOGW(OTA_TAG, "OTA operation already in progress");
-        return LINX_OTA_IN_PROGRESS;
+    linx_ota_sink_t *sink = linx_ota_file_sink_create(download_path);
+    if (!sink) {
+        return LINX_OTA_ERROR_DOWNLOAD;
     }
 
-    if (!info || !info->update_available || !info->firmware_url[0]) {
-        LINX_LOGE(OTA_TAG, "No firmware URL available for download");
-        return LINX_OTA_ERROR_DOWNLOAD;
+    linx_ota_status_t status = linx_ota_download_to_sink(ota, info, sink);
+    linx_ota_sink_destroy(sink);
+
+    if (status == LINX_OTA_SUCCESS) {
+        LINX_LOGI(s_ota_log, "Firmware downloaded successfully to %s", download_path);
     }
+    return status;
+}
 
-    // Initialize download context
-    s_ota_ctx.download_in_progress = true;
-    s_ota_ctx.download_buffer = NULL;
-    s_ota_ctx.download_size = 0;
-    s_ota_ctx.download_received = 0;
-
-    // Create HTTP connection for download
-    struct mg_connection *c = mg_http_connect(&s_ota_ctx.mgr, info->firmware_url, 
-                                             ota_download_handler, NULL);
-    if (c == NULL) {
-        LINX_LOGE(OTA_TAG, "Failed to create download connection");
-        s_ota_ctx.download_in_progress = false;
-        return LINX_OTA_ERROR_DOWNLOAD;
+// Persist how far the sink has got, so a later call can continue with a Range request
+static void ota_resume_save(linx_ota_t *ota) {
+    const char *path = ota->config.resume_state_path;
+    if (!path || !ota->resumable || ota->written == 0) {
+        return;
     }
-    
-    // Store the download path in a dynamically allocated string to ensure it remains valid
-    if (download_path) {
-        c->fn_data = strdup(download_path);
+
+    ota_resume_record_t record;
+    memset(&record, 0, sizeof(record));
+    record.magic = OTA_RESUME_MAGIC;
+    record.version = OTA_RESUME_VERSION;
+    strncpy(record.url, ota->url, sizeof(record.url) - 1);
+    strncpy(record.sha256, ota->expected_sha256_hex, sizeof(record.sha256) - 1);
+    strncpy(record.etag, ota->etag, sizeof(record.etag) - 1);
+    record.image_size = ota->download_size;
+    record.offset = ota->written;
+    strncpy(record.crypto, ota->sha256.provider->name, sizeof(record.crypto) - 1);
+    record.sha256_state = ota->sha256.state;
+
+    // Write a temporary file and rename it, so a power cut never leaves a torn record
+    char tmp_path[512];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    FILE *fp = fopen(tmp_path, "wb");
+    if (!fp) {
+        LINX_LOGW(s_ota_log, "Failed to save OTA resume state to %s", path);
+        return;
+    }
+    bool ok = fwrite(&record, sizeof(record), 1, fp) == 1;
+    ok = fclose(fp) == 0 && ok;
+    if (!ok || rename(tmp_path, path) != 0) {
+        LINX_LOGW(s_ota_log, "Failed to save OTA resume state to %s", path);
+        remove(tmp_path);
+        return;
+    }
+    ota->saved_offset = ota->written;
+}
+
+static void ota_resume_clear(linx_ota_t *ota) {
+    if (ota->config.resume_state_path) {
+        remove(ota->config.resume_state_path);
     }
+    ota->saved_offset = 0;
+}
+
+// Pick up a download an earlier call left behind; returns true if the sink was positioned
+static bool ota_resume_load(linx_ota_t *ota, const linx_ota_info_t *info, linx_ota_sink_t *sink) {
+    const char *path = ota->config.resume_state_path;
+    if (!path || !sink->vtable->resume) {
+        return false;
+    }
+
+    FILE *fp = fopen(path, "rb");
+    if (!fp) {
+        return false;
+    }
+    ota_resume_record_t record;
+    bool ok = fread(&record, sizeof(record), 1, fp) == 1;
+    fclose(fp);
+
+    // Only continue the same image: same URL, same expected digest, sane offset, and a
+    // hash state the current crypto provider can continue
+    linx_sha256_ctx_t sha256;
+    record.crypto[sizeof(record.crypto) - 1] = '\0';
+    ok = ok && record.magic == OTA_RESUME_MAGIC && record.version == OTA_RESUME_VERSION &&
+         strncmp(record.url, info->firmware_url, sizeof(record.url)) == 0 &&
+         strncmp(record.sha256, info->firmware_sha256, sizeof(record.sha256)) == 0 &&
+         record.offset > 0 && record.offset < record.image_size && record.image_size == (size_t) record.image_size &&
+         linx_sha256_resume(&sha256, record.crypto, &record.sha256_state);
+    if (!ok) {
+        LINX_LOGI(s_ota_log, "Discarding stale OTA resume state");
+        ota_resume_clear(ota);
+        return false;
+    }
+
+    if (!sink->vtable->resume(sink, (size_t) record.offset, (size_t) record.image_size)) {
+        LINX_LOGW(s_ota_log, "Sink cannot resume at offset %llu, starting over",
+                  (unsigned long long) record.offset);
+        ota_resume_clear(ota);
+        return false;
+    }
+
+    ota->download_size = (size_t) record.image_size;
+    ota->written = (size_t) record.offset;
+    ota->saved_offset = ota->written;
+    ota->sha256 = sha256;
+    memcpy(ota->etag, record.etag, sizeof(ota->etag));
+    ota->etag[sizeof(ota->etag) - 1] = '\0';
+    ota->sink_opened = true;
+    LINX_LOGI(s_ota_log, "Resuming firmware download at %zu of %zu bytes",
+              ota->written, ota->download_size);
+    return true;
+}
+
+// Hand one chunk to the sink, hashing exactly what the sink has received
+static bool ota_sink_write(linx_ota_t *ota, const uint8_t *data, size_t len) {
+    linx_sha256_update(&ota->sha256, data, len);
+    if (!ota->sink->vtable->write(ota->sink, data, len)) {
+        LINX_LOGE(s_ota_log, "Failed to write firmware chunk at offset %zu", ota->written);
+        return false;
+    }
+    ota->written += len;
+
+    if (ota->written - ota->saved_offset >= OTA_RESUME_SAVE_INTERVAL) {
+        ota_resume_save(ota);
+    }
+    return true;
+}
+
+// Start one HTTP request; continues from ota->written with a Range header when non-zero
+static bool ota_download_attempt_start(linx_ota_t *ota) {
+    const char *url = ota->url;
+
+    ota->retryable = false;
+    ota->headers_received = false;
+    ota->download_received = ota->written;
+    ota->download_percentage = -1;
+    ota->chunk_used = 0;
+
+    // Plain TCP connection: the response is parsed here so the body can be
+    // streamed instead of being buffered whole by the HTTP protocol handler
+    struct mg_connection *c = mg_connect(ota->active_mgr, url, ota_download_handler, ota);
+    if (c == NULL) {
+        LINX_LOGE(s_ota_log, "Failed to create download connection");
+        ota->retryable = true;
+        return false;
+    }
+    ota->conn = c;
+    ota->throttle_window_start = mg_millis();
+    ota->throttle_window_bytes = 0;
+    ota->throttle_until = 0;
+    c->is_full = ota->paused;
 
     // Extract URI and hostname safely
-    const char *uri = mg_url_uri(info->firmware_url);
-    struct mg_str host = mg_url_host(info->firmware_url);
+    const char *uri = mg_url_uri(url);
+    struct mg_str host = mg_url_host(url);
     
     char uri_str[512] = {0};
     char host_str[256] = {0};
@@ -414,189 +737,629 @@ linx_ota_status_t linx_ota_download(const linx_ota_info_t *info, const char *dow
         strncpy(host_str, "localhost", sizeof(host_str) - 1);
     }
 
+    // Range request when continuing; If-Range makes the server send the whole
+    // image instead if it changed since the first response
+    char range_header[160] = {0};
+    if (ota->written > 0) {
+        int n = snprintf(range_header, sizeof(range_header), "Range: bytes=%zu-\r\n", ota->written);
+        if (ota->etag[0] && n > 0 && (size_t) n < sizeof(range_header)) {
+            snprintf(range_header + n, sizeof(range_header) - (size_t) n, "If-Range: %s\r\n", ota->etag);
+        }
+    }
+
     // Send HTTP GET request
     mg_printf(c, "GET %s HTTP/1.1\r\n"
                 "Host: %s\r\n"
                 "User-Agent: %s\r\n"
+                "%s"
                 "Connection: close\r\n"
                 "\r\n",
                 uri_str,
                 host_str,
-                s_ota_ctx.config.user_agent);
-
-    // Poll for events
-    while (s_ota_ctx.download_in_progress) {
-        mg_mgr_poll(&s_ota_ctx.mgr, 1000);
-    }
-
-    // Check if download was successful
-    if (s_ota_ctx.download_buffer && s_ota_ctx.download_size > 0) {
-        // Save to file
-        FILE *fp = fopen(download_path, "wb");
-        if (fp) {
-            size_t written = fwrite(s_ota_ctx.download_buffer, 1, s_ota_ctx.download_size, fp);
-            fclose(fp);
-            
-            if (written == s_ota_ctx.download_size) {
-                LINX_LOGI(OTA_TAG, "Firmware downloaded successfully to %s (%zu bytes)", 
-                         download_path, s_ota_ctx.download_size);
-                free(s_ota_ctx.download_buffer);
-                s_ota_ctx.download_buffer = NULL;
-                return LINX_OTA_SUCCESS;
-            } else {
-                LINX_LOGE(OTA_TAG, "Failed to write firmware to file");
-            }
+                ota->config.user_agent ? ota->config.user_agent : "LinxOS-OTA/1.0",
+                range_header);
+    return true;
+}
+
+// Verify, flush and finish (or abort) the sink; the callback may start the next operation
+static void ota_download_complete(linx_ota_t *ota, linx_ota_status_t status, bool notify) {
+    linx_ota_sink_t *sink = ota->sink;
+
+    // Verify before the final chunk goes out, so a bad image is never completed
+    if (status == LINX_OTA_SUCCESS && ota->verify_sha256) {
+        uint8_t digest[32];
+        linx_sha256_ctx_t sha256 = ota->sha256;
+        linx_sha256_update(&sha256, ota->chunk_buffer, ota->chunk_used);
+        linx_sha256_final(&sha256, digest);
+        if (memcmp(digest, ota->expected_sha256, sizeof(digest)) != 0) {
+            LINX_LOGE(s_ota_log, "Firmware sha256 mismatch, expected %s", ota->expected_sha256_hex);
+            status = LINX_OTA_ERROR_VERIFY;
         } else {
-            LINX_LOGE(OTA_TAG, "Failed to open download file for writing");
+            LINX_LOGI(s_ota_log, "Firmware sha256 verified");
         }
-        
-        free(s_ota_ctx.download_buffer);
-        s_ota_ctx.download_buffer = NULL;
+    }
+
+    if (status == LINX_OTA_SUCCESS && ota->chunk_used > 0 &&
+        !ota_sink_write(ota, ota->chunk_buffer, ota->chunk_used)) {
+        status = LINX_OTA_ERROR_DOWNLOAD;
+    }
+    ota->chunk_used = 0;
+
+    if (status == LINX_OTA_SUCCESS && sink->vtable->finish && !sink->vtable->finish(sink)) {
+        LINX_LOGE(s_ota_log, "Failed to finish firmware image");
+        status = LINX_OTA_ERROR_DOWNLOAD;
+    }
+
+    if (status == LINX_OTA_SUCCESS) {
+        LINX_LOGI(s_ota_log, "Firmware download completed (%zu bytes)", ota->written);
+        ota_resume_clear(ota);
+    } else if (ota->retryable && ota->resumable && ota->config.resume_state_path &&
+               ota->saved_offset > 0) {
+        // Dropped connection: keep the partial image for the next call to resume
+        LINX_LOGW(s_ota_log, "Firmware download interrupted, %zu bytes kept for resume", ota->saved_offset);
+    } else {
+        if (ota->sink_opened && sink->vtable->abort) {
+            sink->vtable->abort(sink);
+        }
+        ota_resume_clear(ota);
+    }
+
+    linx_ota_event_cb_t cb = ota->event_cb;
+    void *user_data = ota->event_user_data;
+
+    linx_ota_sink_destroy(ota->owned_sink);
+    ota->owned_sink = NULL;
+    ota->sink = NULL;
+    ota->conn = NULL;
+    ota->retry_at = 0;
+    ota->throttle_until = 0;
+    ota->download_status = status;
+    ota->download_in_progress = false;
+    ota->event_cb = NULL;
+    ota->event_user_data = NULL;
+    if (notify) {
+        ota_notify(ota, cb, user_data, LINX_OTA_EVENT_DOWNLOAD_DONE, status);
+    }
+}
+
+// Keep what the sink already has; flush the partial chunk so the next request starts after it
+static bool ota_download_keep_partial(linx_ota_t *ota) {
+    if (ota->chunk_used > 0 && !ota_sink_write(ota, ota->chunk_buffer, ota->chunk_used)) {
+        ota->retryable = false;
+        return false;
+    }
+    ota->chunk_used = 0;
+    ota_resume_save(ota);
+    return true;
+}
+
+// One request is over: schedule a Range retry or complete the download
+static void ota_download_attempt_done(linx_ota_t *ota, linx_ota_status_t status) {
+    ota->conn = NULL;
+    ota->throttle_until = 0;
+
+    // A connection the server dropped while reads were paused does not use up a retry
+    if (status != LINX_OTA_SUCCESS && ota->retryable && ota_download_keep_partial(ota) &&
+        (ota->paused || ota->attempt < ota->config.download_retries)) {
+        if (!ota->paused) {
+            ota->attempt++;
+        }
+        LINX_LOGW(s_ota_log, "Retrying firmware download at %zu of %zu bytes (%d/%d)",
+                  ota->written, ota->download_size, ota->attempt, ota->config.download_retries);
+        ota->retry_at = mg_millis() + OTA_RETRY_DELAY_MS;
+        return;
+    }
+    ota_download_complete(ota, status, true);
+}
+
+linx_ota_status_t linx_ota_download_to_sink(linx_ota_t *ota, const linx_ota_info_t *info, linx_ota_sink_t *sink) {
+    if (ota == NULL) {
+        return LINX_OTA_ERROR_INIT;
+    }
+    linx_ota_status_t status = linx_ota_download_to_sink_async(ota, &ota->mgr, info, sink, NULL, NULL);
+    if (status != LINX_OTA_SUCCESS) {
+        return status;
+    }
+    ota_run_sync(ota);
+    return ota->download_status;
+}
+
+linx_ota_status_t linx_ota_download_to_sink_async(linx_ota_t *ota, struct mg_mgr *mgr,
+                                                  const linx_ota_info_t *info, linx_ota_sink_t *sink,
+                                                  linx_ota_event_cb_t cb, void *user_data) {
+    if (ota == NULL) {
+        LINX_LOGE(s_ota_log, "OTA instance is NULL");
+        return LINX_OTA_ERROR_INIT;
+    }
+
+    if (linx_ota_busy(ota)) {
+        LINX_LOGW(s_ota_log, "OTA operation already in progress");
+        return LINX_OTA_IN_PROGRESS;
+    }
+
+    if (mgr == NULL) {
+        LINX_LOGE(s_ota_log, "Invalid event manager");
+        return LINX_OTA_ERROR_DOWNLOAD;
+    }
+
+    if (!info || !info->update_available || !info->firmware_url[0]) {
+        LINX_LOGE(s_ota_log, "No firmware URL available for download");
+        return LINX_OTA_ERROR_DOWNLOAD;
+    }
+
+    if (!sink || !sink->vtable || !sink->vtable->open || !sink->vtable->write) {
+        LINX_LOGE(s_ota_log, "Invalid download sink");
+        return LINX_OTA_ERROR_DOWNLOAD;
+    }
+
+    ota->verify_sha256 = info->firmware_sha256[0] != '\0';
+    if (ota->verify_sha256 && !linx_ota_parse_sha256(info->firmware_sha256, ota->expected_sha256)) {
+        LINX_LOGE(s_ota_log, "Invalid firmware sha256: %s", info->firmware_sha256);
+        return LINX_OTA_ERROR_VERIFY;
+    }
+    if (!ota->verify_sha256) {
+        LINX_LOGW(s_ota_log, "No firmware sha256 provided, image will not be verified");
+    }
+
+    // The chunk buffer is the only per-download allocation, reused across downloads
+    size_t chunk_size = ota->config.download_chunk_size ? ota->config.download_chunk_size
+                                                             : LINX_OTA_DEFAULT_CHUNK_SIZE;
+    if (!ota->chunk_buffer || ota->chunk_size != chunk_size) {
+        LINX_FREE(ota->chunk_buffer);
+        ota->chunk_buffer = LINX_MALLOC_BULK(chunk_size);
+        ota->chunk_size = ota->chunk_buffer ? chunk_size : 0;
+        if (!ota->chunk_buffer) {
+            LINX_LOGE(s_ota_log, "Failed to allocate %zu byte download chunk", chunk_size);
+            return LINX_OTA_ERROR_DOWNLOAD;
+        }
+    }
+
+    // Initialize download context
+    ota->sink = sink;
+    ota->sink_opened = false;
+    ota->resumable = sink->vtable->resume != NULL;
+    ota->download_size = 0;
+    ota->written = 0;
+    ota->saved_offset = 0;
+    ota->etag[0] = '\0';
+    strncpy(ota->url, info->firmware_url, sizeof(ota->url) - 1);
+    ota->url[sizeof(ota->url) - 1] = '\0';
+    strncpy(ota->expected_sha256_hex, info->firmware_sha256, sizeof(ota->expected_sha256_hex) - 1);
+    ota->expected_sha256_hex[sizeof(ota->expected_sha256_hex) - 1] = '\0';
+    linx_sha256_init(&ota->sha256);
+    ota_resume_load(ota, info, sink);
+
+    ota->active_mgr = mgr;
+    ota->event_cb = cb;
+    ota->event_user_data = user_data;
+    ota->attempt = 0;
+    ota->retry_at = 0;
+    ota->download_in_progress = true;
+
+    // The first request must at least be created; later failures are reported through the callback
+    if (!ota_download_attempt_start(ota)) {
+        ota_download_complete(ota, LINX_OTA_ERROR_DOWNLOAD, false);
         return LINX_OTA_ERROR_DOWNLOAD;
     }
+    return LINX_OTA_SUCCESS;
+}
+
+// Close the attempt's connection and hand its result on
+static void ota_download_finish(linx_ota_t *ota, struct mg_connection *c, linx_ota_status_t status) {
+    c->is_closing = 1;
+    c->is_full = 0;
+    ota_download_attempt_done(ota, status);
+}
+
+// Copy a header value into a NUL-terminated buffer; returns false if missing or too long
+static bool ota_header_value(struct mg_http_message *hm, const char *name, char *buf, size_t size) {
+    struct mg_str *value = mg_http_get_header(hm, name);
+    if (!value || value->len >= size) {
+        return false;
+    }
+    memcpy(buf, value->buf, value->len);
+    buf[value->len] = '\0';
+    return true;
+}
+
+// Check "Content-Range: bytes start-end/total" against the offset that was requested
+static bool ota_check_content_range(linx_ota_t *ota, struct mg_http_message *hm, size_t content_length) {
+    char range[96];
+    unsigned long long start = 0, end = 0, total = 0;
+    if (!ota_header_value(hm, "Content-Range", range, sizeof(range)) ||
+        sscanf(range, "bytes %llu-%llu/%llu", &start, &end, &total) != 3) {
+        LINX_LOGE(s_ota_log, "Missing or malformed Content-Range in partial response");
+        return false;
+    }
+    if (start != ota->written || end + 1 != total || end < start ||
+        end - start + 1 != content_length ||
+        (ota->download_size && total != ota->download_size)) {
+        LINX_LOGE(s_ota_log, "Unexpected Content-Range '%s' for offset %zu of %zu",
+                  range, ota->written, ota->download_size);
+        return false;
+    }
+    return true;
+}
+
+// Parse the response headers once they are complete; returns the header length, 0 if incomplete
+static int ota_download_parse_headers(linx_ota_t *ota, struct mg_connection *c) {
+    struct mg_http_message hm;
+    int n = mg_http_parse((const char *) c->recv.buf, c->recv.len, &hm);
+    if (n == 0) {
+        if (c->recv.len > OTA_MAX_HEADER_SIZE) {
+            LINX_LOGE(s_ota_log, "Firmware response headers too large");
+            ota_download_finish(ota, c, LINX_OTA_ERROR_DOWNLOAD);
+            return -1;
+        }
+        return 0;
+    }
+    if (n < 0) {
+        LINX_LOGE(s_ota_log, "Malformed firmware response");
+        ota_download_finish(ota, c, LINX_OTA_ERROR_DOWNLOAD);
+        return -1;
+    }
+
+    int status_code = mg_http_status(&hm);
+    if (status_code == 416 && ota->written > 0) {
+        // The server no longer has what we resumed from; start over on the next attempt
+        LINX_LOGW(s_ota_log, "Range not satisfiable, restarting firmware download");
+        ota->retryable = true;
+        ota->written = 0;
+        ota->etag[0] = '\0';
+        linx_sha256_init(&ota->sha256);
+        ota_resume_clear(ota);
+        ota_download_finish(ota, c, LINX_OTA_ERROR_DOWNLOAD);
+        return -1;
+    }
+    if (status_code != 200 && !(status_code == 206 && ota->written > 0)) {
+        LINX_LOGE(s_ota_log, "Firmware download failed with status code: %d", status_code);
+        ota_download_finish(ota, c, LINX_OTA_ERROR_DOWNLOAD);
+        return -1;
+    }
+
+    char length_str[24];
+    char *end = NULL;
+    unsigned long long length = 0;
+    if (ota_header_value(&hm, "Content-Length", length_str, sizeof(length_str))) {
+        length = strtoull(length_str, &end, 10);
+    }
+    if (end == NULL || end == length_str || length == 0 || length > SIZE_MAX) {
+        LINX_LOGE(s_ota_log, "Missing or invalid Content-Length");
+        ota_download_finish(ota, c, LINX_OTA_ERROR_DOWNLOAD);
+        return -1;
+    }
+
+    if (status_code == 206) {
+        if (!ota_check_content_range(ota, &hm, (size_t) length)) {
+            ota_download_finish(ota, c, LINX_OTA_ERROR_DOWNLOAD);
+            return -1;
+        }
+        LINX_LOGI(s_ota_log, "Resuming firmware download at %zu of %zu bytes",
+                  ota->written, ota->download_size);
+    } else {
+        if (ota->written > 0) {
+            // Range ignored or the image changed (If-Range): the whole image follows
+            LINX_LOGW(s_ota_log, "Server sent the full image, restarting from 0");
+            ota->written = 0;
+            ota->download_received = 0;
+            linx_sha256_init(&ota->sha256);
+            ota_resume_clear(ota);
+        }
+        ota->download_size = (size_t) length;
+        if (!ota_header_value(&hm, "ETag", ota->etag, sizeof(ota->etag))) {
+            ota->etag[0] = '\0';
+        }
+        LINX_LOGI(s_ota_log, "Firmware size: %zu bytes", ota->download_size);
+
+        ota->sink_opened = true;
+        if (!ota->sink->vtable->open(ota->sink, ota->download_size)) {
+            LINX_LOGE(s_ota_log, "Failed to open firmware sink");
+            ota_download_finish(ota, c, LINX_OTA_ERROR_DOWNLOAD);
+            return -1;
+        }
+    }
+
+    ota->headers_received = true;
+    return n;
+}
+
+// Copy body bytes into the chunk buffer, handing full chunks to the sink
+static bool ota_download_consume(linx_ota_t *ota, const uint8_t *data, size_t len) {
+    while (len > 0) {
+        size_t space = ota->chunk_size - ota->chunk_used;
+        size_t n = len < space ? len : space;
+        memcpy(ota->chunk_buffer + ota->chunk_used, data, n);
+        ota->chunk_used += n;
+        data += n;
+        len -= n;
+
+        if (ota->chunk_used == ota->chunk_size) {
+            if (!ota_sink_write(ota, ota->chunk_buffer, ota->chunk_used)) {
+                return false;
+            }
+            ota->chunk_used = 0;
+        }
+    }
+    return true;
+}
+
+// Pause reads once this window's share of max_download_rate is used up
+static void ota_download_throttle(linx_ota_t *ota, struct mg_connection *c, size_t len) {
+    uint32_t rate = ota->config.max_download_rate;
+    if (rate == 0) {
+        return;
+    }
 
-    return LINX_OTA_ERROR_DOWNLOAD;
+    uint64_t now = mg_millis();
+    if (now - ota->throttle_window_start >= OTA_THROTTLE_WINDOW_MS) {
+        ota->throttle_window_start = now;
+        ota->throttle_window_bytes = 0;
+    }
+    ota->throttle_window_bytes += len;
+
+    // A read can overshoot the budget; the pause then covers the excess too
+    uint64_t until = ota->throttle_window_start +
+                     (uint64_t) ota->throttle_window_bytes * 1000 / rate;
+    if (until > now) {
+        c->is_full = 1;
+        ota->throttle_until = until;
+    }
 }
 
 static void ota_download_handler(struct mg_connection *c, int ev, void *ev_data) {
-    const char *download_path = c->fn_data ? (const char *)c->fn_data : NULL;
-    
-    if (ev == MG_EV_HTTP_MSG) {
-        struct mg_http_message *hm = (struct mg_http_message *) ev_data;
-        int status_code = mg_http_status(hm);
-        
-        if (status_code == 200) {
-            // Get content length
-            struct mg_str *cl_header = mg_http_get_header(hm, "Content-Length");
-            if (cl_header) {
-                s_ota_ctx.download_size = strtoul(cl_header->buf, NULL, 10);
-                LINX_LOGI(OTA_TAG, "Firmware size: %zu bytes", s_ota_ctx.download_size);
-                
-                // Allocate buffer for the firmware
-                s_ota_ctx.download_buffer = malloc(s_ota_ctx.download_size);
-                if (!s_ota_ctx.download_buffer) {
-                    LINX_LOGE(OTA_TAG, "Failed to allocate memory for firmware download");
-                    s_ota_ctx.download_in_progress = false;
-                    c->is_closing = 1;
-                    return;
-                }
-                
-                // Copy body data
-                memcpy(s_ota_ctx.download_buffer, hm->body.buf, hm->body.len);
-                s_ota_ctx.download_received = hm->body.len;
-                
-                // Report progress
-                if (s_ota_ctx.progress_cb) {
-                    int percentage = (int)((s_ota_ctx.download_received * 100) / s_ota_ctx.download_size);
-                    s_ota_ctx.progress_cb(percentage);
-                }
-                
-                // Check if we got all data in one chunk
-                if (s_ota_ctx.download_received >= s_ota_ctx.download_size) {
-                    LINX_LOGI(OTA_TAG, "Firmware download completed in one chunk");
-                    s_ota_ctx.download_in_progress = false;
-                    c->is_closing = 1;
-                }
-            } else {
-                LINX_LOGE(OTA_TAG, "Content-Length header not found");
-                s_ota_ctx.download_in_progress = false;
-                c->is_closing = 1;
+    linx_ota_t *ota = (linx_ota_t *) c->fn_data;
+    (void) ev_data;
+
+    // Finished and cancelled attempts linger until mongoose closes them
+    if (c != ota->conn) {
+        if (ev == MG_EV_READ) {
+            mg_iobuf_del(&c->recv, 0, c->recv.len);
+        }
+        return;
+    }
+
+    if (ev == MG_EV_READ) {
+
+        if (!ota->headers_received) {
+            int header_len = ota_download_parse_headers(ota, c);
+            if (header_len <= 0) {
+                return;
             }
-        } else {
-            LINX_LOGE(OTA_TAG, "Firmware download failed with status code: %d", status_code);
-            s_ota_ctx.download_in_progress = false;
-            c->is_closing = 1;
+            mg_iobuf_del(&c->recv, 0, (size_t) header_len);
         }
-    } else if (ev == MG_EV_READ) {
-        long *bytes_read = (long *) ev_data;
-        
-        // Append data to buffer
-        if (s_ota_ctx.download_buffer && 
-            s_ota_ctx.download_received + *bytes_read <= s_ota_ctx.download_size) {
-            // For MG_EV_READ, we need to read from the connection's receive buffer
-            // The data is already in the connection's receive buffer
-            size_t bytes_to_copy = *bytes_read;
-            memcpy(s_ota_ctx.download_buffer + s_ota_ctx.download_received, 
-                   c->recv.buf, bytes_to_copy);
-            s_ota_ctx.download_received += bytes_to_copy;
-            
-            // Mark the data as consumed
-            mg_iobuf_del(&c->recv, 0, bytes_to_copy);
-            
-            // Report progress
-            if (s_ota_ctx.progress_cb) {
-                int percentage = (int)((s_ota_ctx.download_received * 100) / s_ota_ctx.download_size);
-                s_ota_ctx.progress_cb(percentage);
+
+        // Stream whatever body bytes are buffered; anything past the image size is rejected
+        size_t remaining = ota->download_size - ota->download_received;
+        size_t len = c->recv.len;
+        if (len > remaining) {
+            LINX_LOGE(s_ota_log, "Firmware response longer than Content-Length");
+            mg_iobuf_del(&c->recv, 0, c->recv.len);
+            ota_download_finish(ota, c, LINX_OTA_ERROR_DOWNLOAD);
+            return;
+        }
+
+        if (len > 0) {
+            if (!ota_download_consume(ota, c->recv.buf, len)) {
+                mg_iobuf_del(&c->recv, 0, c->recv.len);
+                ota_download_finish(ota, c, LINX_OTA_ERROR_DOWNLOAD);
+                return;
             }
-            
-            LINX_LOGI(OTA_TAG, "Downloaded %zu of %zu bytes (%d%%)", 
-                     s_ota_ctx.download_received, s_ota_ctx.download_size,
-                     (int)((s_ota_ctx.download_received * 100) / s_ota_ctx.download_size));
-            
-            // Check if download is complete
-            if (s_ota_ctx.download_received >= s_ota_ctx.download_size) {
-                LINX_LOGI(OTA_TAG, "Firmware download completed");
-                s_ota_ctx.download_in_progress = false;
-                c->is_closing = 1;
+            ota->download_received += len;
+            mg_iobuf_del(&c->recv, 0, len);
+            ota_download_throttle(ota, c, len);
+
+            int percentage = (int)((ota->download_received * 100) / ota->download_size);
+            if (percentage != ota->download_percentage) {
+                ota->download_percentage = percentage;
+                if (ota->progress_cb) {
+                    ota->progress_cb(percentage);
+                }
+                LINX_LOGI(s_ota_log, "Downloaded %zu of %zu bytes (%d%%)", 
+                         ota->download_received, ota->download_size, percentage);
+                ota_notify(ota, ota->event_cb, ota->event_user_data, LINX_OTA_EVENT_PROGRESS,
+                           LINX_OTA_SUCCESS);
+                if (c != ota->conn) {
+                    return;     // Cancelled from the callback
+                }
             }
         }
+
+        if (ota->download_received == ota->download_size) {
+            ota_download_finish(ota, c, LINX_OTA_SUCCESS);
+        }
     } else if (ev == MG_EV_ERROR || ev == MG_EV_CLOSE) {
-        if (s_ota_ctx.download_in_progress) {
-            if (s_ota_ctx.download_buffer && 
-                s_ota_ctx.download_received == s_ota_ctx.download_size) {
-                LINX_LOGI(OTA_TAG, "Firmware download completed on connection close");
-            } else {
-                LINX_LOGE(OTA_TAG, "Firmware download failed or connection closed prematurely");
-                if (s_ota_ctx.download_buffer) {
-                    free(s_ota_ctx.download_buffer);
-                    s_ota_ctx.download_buffer = NULL;
-                }
-            }
-            s_ota_ctx.download_in_progress = false;
+        LINX_LOGE(s_ota_log, "Firmware download failed or connection closed prematurely (%zu of %zu bytes)",
+                  ota->download_received, ota->download_size);
+        ota->retryable = true;
+        ota_download_attempt_done(ota, LINX_OTA_ERROR_DOWNLOAD);
+    }
+}
+
+void linx_ota_poll(linx_ota_t *ota) {
+    if (ota == NULL || !ota->download_in_progress) {
+        return;
+    }
+
+    uint64_t now = mg_millis();
+    if (ota->throttle_until && now >= ota->throttle_until) {
+        ota->throttle_until = 0;
+        ota->throttle_window_start = now;
+        ota->throttle_window_bytes = 0;
+        if (ota->conn && !ota->paused) {
+            ota->conn->is_full = 0;
         }
-        
-        // Free the allocated download path
-        if (c->fn_data) {
-            free(c->fn_data);
-            c->fn_data = NULL;
+    }
+
+    if (ota->retry_at && now >= ota->retry_at && !ota->paused) {
+        ota->retry_at = 0;
+        if (!ota_download_attempt_start(ota)) {
+            ota_download_attempt_done(ota, LINX_OTA_ERROR_DOWNLOAD);
         }
     }
 }
 
-linx_ota_status_t linx_ota_apply(const char *download_path) {
-    if (!s_ota_ctx.initialized) {
-        LINX_LOGE(OTA_TAG, "OTA module not initialized");
+int linx_ota_poll_timeout_ms(linx_ota_t *ota, int idle_ms) {
+    if (ota == NULL) {
+        return idle_ms;
+    }
+    uint64_t deadline = ota->throttle_until ? ota->throttle_until : ota->retry_at;
+    if (!ota->download_in_progress || deadline == 0 || ota->paused) {
+        return idle_ms;
+    }
+
+    uint64_t now = mg_millis();
+    if (deadline <= now) {
+        return 0;
+    }
+    return deadline - now < (uint64_t) idle_ms ? (int) (deadline - now) : idle_ms;
+}
+
+void linx_ota_cancel(linx_ota_t *ota) {
+    if (ota == NULL) {
+        return;
+    }
+
+    if (ota->request_in_progress) {
+        if (ota->conn) {
+            ota->conn->is_closing = 1;
+        }
+        ota->conn = NULL;
+        ota->request_in_progress = false;
+        ota->event_cb = NULL;
+        ota->event_user_data = NULL;
+        LINX_LOGI(s_ota_log, "OTA check cancelled");
+    }
+
+    if (ota->download_in_progress) {
+        if (ota->conn) {
+            ota->conn->is_closing = 1;
+            ota->conn->is_full = 0;
+            ota->conn = NULL;
+        }
+        // Treated like a dropped connection, so a resumable download can continue later
+        ota->retryable = true;
+        ota_download_keep_partial(ota);
+        ota_download_complete(ota, LINX_OTA_ERROR_DOWNLOAD, false);
+        LINX_LOGI(s_ota_log, "Firmware download cancelled");
+    }
+}
+
+linx_ota_status_t linx_ota_download_delta(linx_ota_t *ota, const linx_ota_info_t *info, linx_ota_sink_t *target,
+                                          const linx_ota_delta_base_t *base) {
+    if (ota == NULL) {
         return LINX_OTA_ERROR_INIT;
     }
+    linx_ota_status_t status = linx_ota_download_delta_async(ota, &ota->mgr, info, target, base, NULL, NULL);
+    if (status != LINX_OTA_SUCCESS) {
+        return status;
+    }
+    ota_run_sync(ota);
 
-    if (!download_path) {
-        LINX_LOGE(OTA_TAG, "Invalid download path");
-        return LINX_OTA_ERROR_APPLY;
+    if (ota->download_status == LINX_OTA_SUCCESS) {
+        LINX_LOGI(s_ota_log, "Delta update applied from %s", info->delta_url);
     }
+    return ota->download_status;
+}
+
+linx_ota_status_t linx_ota_download_delta_async(linx_ota_t *ota, struct mg_mgr *mgr, const linx_ota_info_t *info,
+                                                linx_ota_sink_t *target, const linx_ota_delta_base_t *base,
+                                                linx_ota_event_cb_t cb, void *user_data) {
+    if (ota == NULL) {
+        return LINX_OTA_ERROR_INIT;
+    }
+
+    if (!info || !info->delta_available || !info->delta_url[0]) {
+        LINX_LOGE(s_ota_log, "No delta package available for download");
+        return LINX_OTA_ERROR_DOWNLOAD;
+    }
+
+    if (linx_ota_busy(ota)) {
+        LINX_LOGW(s_ota_log, "OTA operation already in progress");
+        return LINX_OTA_IN_PROGRESS;
+    }
+
+    linx_ota_sink_t *delta_sink = linx_ota_delta_sink_create(target, base, info->firmware_sha256);
+    if (!delta_sink) {
+        return LINX_OTA_ERROR_DOWNLOAD;
+    }
+
+    // Download the package like a full image; the delta sink turns it into one
+    linx_ota_info_t delta_info = *info;
+    memcpy(delta_info.firmware_url, info->delta_url, sizeof(delta_info.firmware_url));
+    memcpy(delta_info.firmware_sha256, info->delta_sha256, sizeof(delta_info.firmware_sha256));
+
+    linx_ota_status_t status = linx_ota_download_to_sink_async(ota, mgr, &delta_info, delta_sink, cb, user_data);
+    if (status != LINX_OTA_SUCCESS) {
+        linx_ota_sink_destroy(delta_sink);
+        return status;
+    }
+
+    // Destroyed by ota_download_complete
+    ota->owned_sink = delta_sink;
+    return LINX_OTA_SUCCESS;
+}
 
-    // Check if file exists
-    FILE *fp = fopen(download_path, "rb");
+// Legacy two-step flow: write an already downloaded file into the inactive slot
+static linx_ota_status_t ota_copy_to_slot(linx_ota_t *ota, const char *path) {
+    FILE *fp = fopen(path, "rb");
     if (!fp) {
-        LINX_LOGE(OTA_TAG, "Firmware file not found: %s", download_path);
+        LINX_LOGE(s_ota_log, "Firmware file not found: %s", path);
         return LINX_OTA_ERROR_APPLY;
     }
+    long size = fseek(fp, 0, SEEK_END) == 0 ? ftell(fp) : -1;
+    size_t chunk_size = ota->config.download_chunk_size > 0 ? ota->config.download_chunk_size
+                                                             : LINX_OTA_DEFAULT_CHUNK_SIZE;
+    uint8_t *buffer = (uint8_t *)LINX_MALLOC(chunk_size);
+    linx_ota_sink_t *sink = linx_ota_slot_sink_create(ota->config.slot);
+    bool ok = size > 0 && fseek(fp, 0, SEEK_SET) == 0 && buffer && sink &&
+              sink->vtable->open(sink, (size_t)size);
+    bool opened = ok;
+
+    LINX_LOGI(s_ota_log, "Copying %s (%ld bytes) into the inactive slot", path, size);
+    size_t n;
+    while (ok && (n = fread(buffer, 1, chunk_size, fp)) > 0) {
+        ok = sink->vtable->write(sink, buffer, n);
+    }
+    ok = ok && !ferror(fp) && sink->vtable->finish(sink);
+    if (!ok && opened) {
+        sink->vtable->abort(sink);
+    }
+
     fclose(fp);
+    linx_ota_sink_destroy(sink);
+    LINX_FREE(buffer);
+    if (!ok) {
+        LINX_LOGE(s_ota_log, "Failed to write %s into the inactive slot", path);
+        return LINX_OTA_ERROR_APPLY;
+    }
+    return LINX_OTA_SUCCESS;
+}
 
-    LINX_LOGI(OTA_TAG, "Applying firmware update from %s", download_path);
+linx_ota_status_t linx_ota_apply(linx_ota_t *ota, const char *download_path) {
+    if (ota == NULL) {
+        LINX_LOGE(s_ota_log, "OTA instance is NULL");
+        return LINX_OTA_ERROR_INIT;
+    }
 
-    // Platform-specific implementation for applying the update
-    // This is a placeholder - actual implementation depends on the target platform
-    #if defined(__APPLE__) || defined(__linux__)
-    // For desktop platforms, we just simulate the update
-    LINX_LOGI(OTA_TAG, "Simulating firmware update on desktop platform");
+#if !defined(ESP_PLATFORM)
+    if (!ota->config.slot) {
+        LINX_LOGE(s_ota_log, "No A/B slots configured, cannot apply the update");
+        return LINX_OTA_ERROR_APPLY;
+    }
+#endif
+
+    if (download_path) {
+        linx_ota_status_t status = ota_copy_to_slot(ota, download_path);
+        if (status != LINX_OTA_SUCCESS) {
+            return status;
+        }
+    }
+
+    if (!linx_ota_slot_has_pending(ota->config.slot)) {
+        LINX_LOGE(s_ota_log, "No verified image is pending in the inactive slot");
+        return LINX_OTA_ERROR_APPLY;
+    }
+    LINX_LOGI(s_ota_log, "Update staged in slot %c, reboot to start it",
+              'A' + (1 - linx_ota_slot_running(ota->config.slot)));
     return LINX_OTA_SUCCESS;
-    #else
-    // For embedded platforms, implement the actual update mechanism
-    // This would typically involve:
-    // 1. Verifying the firmware image
-    // 2. Writing to a staging area or directly to flash
-    // 3. Setting up for reboot to apply the update
-    LINX_LOGE(OTA_TAG, "OTA apply not implemented for this platform");
-    return LINX_OTA_ERROR_APPLY;
-    #endif
 }
\ No newline at end of file
@@ -8,11 +8,28 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include "linx_ota_sink.h"
+#include "linx_ota_delta.h"
+#include "linx_ota_slot.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+struct mg_mgr;
+
+/**
+ * @brief OTA instance
+ *
+ * Holds the configuration and the state of the running operation. Instances
+ * are independent, so several device sessions in one process can each check
+ * and download on their own; one instance runs one operation at a time.
+ */
+typedef struct linx_ota linx_ota_t;
+
+/** Default sink write size (one flash sector) */
+#define LINX_OTA_DEFAULT_CHUNK_SIZE 4096
+
 /**
  * @brief OTA status codes
  */
@@ -61,6 +78,12 @@ typedef struct {
     uint32_t chip_features;         /**< Chip features */
     
     void (*progress_cb)(int percentage); /**< Progress callback */
+    size_t download_chunk_size;     /**< Bytes per sink write, 0 = LINX_OTA_DEFAULT_CHUNK_SIZE */
+    int download_retries;           /**< Extra attempts after a dropped connection, resumed with Range */
+    const char *resume_state_path;  /**< File keeping partial-download state across calls, NULL = none */
+    bool delta_enabled;             /**< Advertise delta package support in the check request */
+    uint32_t max_download_rate;     /**< Download bandwidth limit in bytes per second, 0 = unlimited */
+    const linx_ota_slot_config_t *slot; /**< A/B slots used by linx_ota_apply, NULL = none (ignored on ESP-IDF) */
 } linx_ota_config_t;
 
 /**
@@ -70,43 +93,272 @@ typedef struct {
     char activation_code[32];       /**< Activation code */
     char activation_message[256];   /**< Activation message */
     char websocket_url[256];        /**< WebSocket URL */
+    char websocket_urls[512];       /**< Alternative WebSocket URLs (websocket.urls), comma-separated, may be empty */
     char firmware_version[32];      /**< New firmware version */
     char firmware_url[256];         /**< Firmware download URL */
+    char firmware_sha256[65];       /**< Expected SHA-256 of the image (hex), empty if not provided */
+    char delta_url[256];            /**< Delta package URL, set when delta_available */
+    char delta_sha256[65];          /**< SHA-256 of the delta package (hex), may be empty */
+    bool delta_available;           /**< Server offered a delta against the running image */
     bool update_available;          /**< Whether update is available */
 } linx_ota_info_t;
 
 /**
- * @brief Initialize OTA module
- * 
+ * @brief Events raised by the asynchronous API
+ */
+typedef enum {
+    LINX_OTA_EVENT_CHECK_DONE,      /**< Update check finished; info holds the result */
+    LINX_OTA_EVENT_PROGRESS,        /**< Download percentage changed */
+    LINX_OTA_EVENT_DOWNLOAD_DONE,   /**< Download finished; status tells how */
+} linx_ota_event_type_t;
+
+/**
+ * @brief Asynchronous OTA event
+ */
+typedef struct {
+    linx_ota_event_type_t type;
+    linx_ota_status_t status;       /**< Result for the *_DONE events, as the blocking call would return it */
+    const linx_ota_info_t *info;    /**< CHECK_DONE only; valid until the next check starts */
+    size_t received;                /**< Image bytes received so far */
+    size_t total;                   /**< Image size, 0 until the response headers arrived */
+    int percentage;                 /**< Download percentage, -1 until known */
+} linx_ota_event_t;
+
+/**
+ * @brief Asynchronous OTA event callback
+ *
+ * Runs on the thread polling the event manager. The *_DONE events are raised
+ * after the operation has ended, so the callback may start the next one.
+ */
+typedef void (*linx_ota_event_cb_t)(const linx_ota_event_t *event, void *user_data);
+
+/**
+ * @brief Create an OTA instance
+ *
+ * The configuration is copied, the strings it points to are not and must
+ * outlive the instance.
+ *
  * @param config OTA configuration
- * @return linx_ota_status_t Status code
+ * @return New instance, NULL on invalid configuration or out of memory
  */
-linx_ota_status_t linx_ota_init(const linx_ota_config_t *config);
+linx_ota_t *linx_ota_create(const linx_ota_config_t *config);
 
 /**
  * @brief Check for OTA updates
  * 
+ * @param ota OTA instance
  * @param info Pointer to store OTA information
  * @return linx_ota_status_t Status code
  */
-linx_ota_status_t linx_ota_check_update(linx_ota_info_t *info);
+linx_ota_status_t linx_ota_check_update(linx_ota_t *ota, linx_ota_info_t *info);
 
 /**
  * @brief Download OTA update
  * 
+ * @param ota OTA instance
  * @param info OTA information with firmware URL
  * @param download_path Path to save downloaded firmware
  * @return linx_ota_status_t Status code
  */
-linx_ota_status_t linx_ota_download(const linx_ota_info_t *info, const char *download_path);
+linx_ota_status_t linx_ota_download(linx_ota_t *ota, const linx_ota_info_t *info, const char *download_path);
 
 /**
- * @brief Apply OTA update
- * 
- * @param download_path Path to downloaded firmware
+ * @brief Download OTA update into a sink
+ *
+ * The body is streamed to the sink in download_chunk_size pieces as it
+ * arrives; memory use does not depend on the image size. The sink is
+ * finished when every byte announced by Content-Length has been written and
+ * aborted otherwise. The sink stays owned by the caller.
+ *
+ * When info->firmware_sha256 is set the image is hashed while it streams
+ * in and checked as soon as the last byte arrives; on a mismatch the sink
+ * is aborted without being finished and LINX_OTA_ERROR_VERIFY is returned.
+ *
+ * A dropped connection is retried up to config.download_retries times with
+ * "Range: bytes=N-", continuing the same sink and hash. With
+ * config.resume_state_path set and a sink that supports resume, the offset
+ * and hash state are also saved to that file; an interrupted download then
+ * keeps its partial image and the next call for the same URL and digest
+ * continues where it stopped.
+ *
+ * @param ota OTA instance
+ * @param info OTA information with firmware URL
+ * @param sink Destination of the firmware image
+ * @return linx_ota_status_t Status code
+ */
+linx_ota_status_t linx_ota_download_to_sink(linx_ota_t *ota, const linx_ota_info_t *info, linx_ota_sink_t *sink);
+
+/**
+ * @brief Download a delta package and patch it into the new image
+ *
+ * Only valid when info->delta_available is set, i.e. the server offered a
+ * delta whose base digest matches config.elf_sha256. The package is checked
+ * against info->delta_sha256 while it streams in, the reconstructed image
+ * against info->firmware_sha256. When this fails, fall back to a full
+ * linx_ota_download_to_sink.
+ *
+ * @param ota OTA instance
+ * @param info OTA information with delta URL
+ * @param target Destination of the new image (not owned)
+ * @param base Reader for the running image (see linx_ota_delta.h)
  * @return linx_ota_status_t Status code
  */
-linx_ota_status_t linx_ota_apply(const char *download_path);
+linx_ota_status_t linx_ota_download_delta(linx_ota_t *ota, const linx_ota_info_t *info, linx_ota_sink_t *target,
+                                          const linx_ota_delta_base_t *base);
+
+/**
+ * @brief Start an update check on an existing mongoose event manager
+ *
+ * Returns as soon as the request is queued; the result arrives as a
+ * LINX_OTA_EVENT_CHECK_DONE event. This and the other *_async calls, as well
+ * as linx_ota_poll and linx_ota_cancel, must run on the thread that polls
+ * mgr. Each instance runs one OTA operation at a time; instances may share mgr.
+ *
+ * @param ota OTA instance
+ * @param mgr Event manager, e.g. the one driving the SDK's WebSocket
+ * @param cb Event callback, may be NULL
+ * @param user_data User pointer passed to cb
+ * @return LINX_OTA_SUCCESS if the request was started
+ */
+linx_ota_status_t linx_ota_check_update_async(linx_ota_t *ota, struct mg_mgr *mgr, linx_ota_event_cb_t cb,
+                                              void *user_data);
+
+/**
+ * @brief Start a download into a sink on an existing mongoose event manager
+ *
+ * Same behaviour as linx_ota_download_to_sink (streaming, verification,
+ * retries, resume), but returns once the first request is queued. Progress
+ * is reported with LINX_OTA_EVENT_PROGRESS and the result with
+ * LINX_OTA_EVENT_DOWNLOAD_DONE. The sink must stay valid until then; info is
+ * copied.
+ *
+ * @param ota OTA instance
+ * @param mgr Event manager
+ * @param info OTA information with firmware URL
+ * @param sink Destination of the firmware image
+ * @param cb Event callback, may be NULL
+ * @param user_data User pointer passed to cb
+ * @return LINX_OTA_SUCCESS if the download was started
+ */
+linx_ota_status_t linx_ota_download_to_sink_async(linx_ota_t *ota, struct mg_mgr *mgr,
+                                                  const linx_ota_info_t *info, linx_ota_sink_t *sink,
+                                                  linx_ota_event_cb_t cb, void *user_data);
+
+/**
+ * @brief Start a delta download on an existing mongoose event manager
+ *
+ * Asynchronous form of linx_ota_download_delta. target and base must stay
+ * valid until LINX_OTA_EVENT_DOWNLOAD_DONE.
+ *
+ * @param ota OTA instance
+ * @param mgr Event manager
+ * @param info OTA information with delta URL
+ * @param target Destination of the new image (not owned)
+ * @param base Reader for the running image
+ * @param cb Event callback, may be NULL
+ * @param user_data User pointer passed to cb
+ * @return LINX_OTA_SUCCESS if the download was started
+ */
+linx_ota_status_t linx_ota_download_delta_async(linx_ota_t *ota, struct mg_mgr *mgr, const linx_ota_info_t *info,
+                                                linx_ota_sink_t *target, const linx_ota_delta_base_t *base,
+                                                linx_ota_event_cb_t cb, void *user_data);
+
+/**
+ * @brief Run OTA timers: resume throttled reads and start scheduled retries
+ *
+ * Call after every mg_mgr_poll of the manager an asynchronous operation runs on.
+ *
+ * @param ota OTA instance
+ */
+void linx_ota_poll(linx_ota_t *ota);
+
+/**
+ * @brief Poll timeout that keeps OTA timers on time
+ *
+ * @param ota OTA instance
+ * @param idle_ms Timeout the event loop would use otherwise
+ * @return idle_ms, or less when a throttle pause or retry is due sooner
+ */
+int linx_ota_poll_timeout_ms(linx_ota_t *ota, int idle_ms);
+
+/**
+ * @brief Whether a check or download is running
+ *
+ * @param ota OTA instance
+ * @return true while an OTA operation is in progress
+ */
+bool linx_ota_busy(linx_ota_t *ota);
+
+/**
+ * @brief Hold or release the running download
+ *
+ * While paused the download connection is not read, so TCP flow control
+ * stops the sender, and scheduled retries wait. If the server drops the
+ * idle connection meanwhile, the Range retry after resuming does not count
+ * against config.download_retries. The state persists across downloads.
+ * Must run on the thread that polls the event manager.
+ *
+ * @param ota OTA instance
+ * @param paused true to hold, false to continue
+ */
+void linx_ota_set_paused(linx_ota_t *ota, bool paused);
+
+/**
+ * @brief Whether downloads are held by linx_ota_set_paused
+ */
+bool linx_ota_is_paused(linx_ota_t *ota);
+
+/**
+ * @brief Change config.max_download_rate, effective immediately
+ *
+ * Must run on the thread that polls the event manager.
+ *
+ * @param ota OTA instance
+ * @param rate Bytes per second, 0 = unlimited
+ */
+void linx_ota_set_max_download_rate(linx_ota_t *ota, uint32_t rate);
+
+/**
+ * @brief Current download bandwidth limit in bytes per second, 0 = unlimited
+ */
+uint32_t linx_ota_get_max_download_rate(linx_ota_t *ota);
+
+/**
+ * @brief Stop the running operation without raising its *_DONE event
+ *
+ * A download is treated like a dropped connection: with resume support the
+ * partial image is kept for the next download, otherwise the sink is aborted.
+ * Must be called before the event manager it runs on is freed.
+ *
+ * @param ota OTA instance
+ */
+void linx_ota_cancel(linx_ota_t *ota);
+
+/**
+ * @brief Apply a downloaded update; the caller reboots on success
+ *
+ * The preferred flow downloads straight into the inactive slot with
+ * linx_ota_slot_sink_create(config.slot) and calls this with a NULL path,
+ * which only checks that the verified image is pending for the next boot.
+ * With a path, the file is first copied into the inactive slot; this costs
+ * a second write of the whole image and is kept for file-based downloads.
+ *
+ * Without config.slot this fails on platforms other than ESP-IDF.
+ *
+ * @param ota OTA instance
+ * @param download_path Downloaded firmware file, NULL if it was streamed to a slot
+ * @return LINX_OTA_SUCCESS if an image is pending, LINX_OTA_ERROR_APPLY otherwise
+ */
+linx_ota_status_t linx_ota_apply(linx_ota_t *ota, const char *download_path);
+
+/**
+ * @brief Decode a 64-character hex SHA-256 digest
+ *
+ * @param hex Digest in hex, either case
+ * @param digest Decoded digest (output)
+ * @return true if hex is a well-formed digest
+ */
+bool linx_ota_parse_sha256(const char *hex, uint8_t digest[32]);
 
 /**
  * @brief Get OTA status string
@@ -117,9 +369,14 @@ linx_ota_status_t linx_ota_apply(const char *download_path);
 const char *linx_ota_status_str(linx_ota_status_t status);
 
 /**
- * @brief Cleanup OTA module
+ * @brief Destroy an OTA instance
+ *
+ * Cancels a running operation first, so it must run on the thread polling
+ * the manager an asynchronous operation was started on.
+ *
+ * @param ota OTA instance, may be NULL
  */
-void linx_ota_cleanup(void);
+void linx_ota_destroy(linx_ota_t *ota);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,425 @@
+/**
+ * @file linx_ota_delta.c
+ * @brief Streaming LINXDIFF/BSDIFF1 patch application
+ */
+
+#include "linx_ota.h"
+#include "../linx_crypto.h"
+#include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(ESP_PLATFORM)
+#include "esp_ota_ops.h"
+#include "esp_partition.h"
+#endif
+
+LINX_LOG_TAG_DEFINE(s_ota_delta_log, "LINX_OTA_DELTA");
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_OTA);
+#define OTA_DELTA_MAGIC "LINXDIFF/BSDIFF1"
+#define OTA_DELTA_MAGIC_LEN 16
+#define OTA_DELTA_BUFFER_SIZE 4096  // Output and base read buffers
+
+typedef enum {
+    DELTA_STATE_HEADER,             // Magic and new size
+    DELTA_STATE_CONTROL,            // diff_len, extra_len, seek
+    DELTA_STATE_DIFF,
+    DELTA_STATE_EXTRA,
+    DELTA_STATE_DONE,
+    DELTA_STATE_ERROR,
+} delta_state_t;
+
+typedef struct {
+    linx_ota_sink_t *target;
+    linx_ota_delta_base_t base;
+    bool target_opened;
+
+    delta_state_t state;
+    uint8_t field[24];              // Header / control triple being assembled
+    size_t field_used;
+    uint64_t new_size;
+    uint64_t new_pos;
+    int64_t old_pos;                // Base cursor, may step outside the base
+    uint64_t diff_left;
+    uint64_t extra_left;
+    int64_t seek;
+
+    uint8_t out[OTA_DELTA_BUFFER_SIZE];
+    size_t out_used;
+    uint8_t old[OTA_DELTA_BUFFER_SIZE];
+
+    bool verify;
+    uint8_t expected_sha256[32];
+    linx_sha256_ctx_t sha256;
+} ota_delta_sink_t;
+
+// bsdiff integer: little-endian magnitude, sign in bit 63
+static int64_t delta_read_int(const uint8_t *p) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; i--) {
+        value = (value << 8) | p[i];
+    }
+    int64_t magnitude = (int64_t)(value & 0x7fffffffffffffffULL);
+    return (value >> 63) ? -magnitude : magnitude;
+}
+
+static bool delta_flush(ota_delta_sink_t *impl) {
+    if (impl->out_used == 0) {
+        return true;
+    }
+    if (!impl->target->vtable->write(impl->target, impl->out, impl->out_used)) {
+        return false;
+    }
+    impl->out_used = 0;
+    return true;
+}
+
+// Append produced bytes to the output buffer; the final buffer is flushed by finish
+static bool delta_emit(ota_delta_sink_t *impl, const uint8_t *data, size_t len) {
+    if (impl->verify) {
+        linx_sha256_update(&impl->sha256, data, len);
+    }
+    while (len > 0) {
+        if (impl->out_used == sizeof(impl->out) && !delta_flush(impl)) {
+            return false;
+        }
+        size_t space = sizeof(impl->out) - impl->out_used;
+        size_t n = len < space ? len : space;
+        memcpy(impl->out + impl->out_used, data, n);
+        impl->out_used += n;
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+// Add patch bytes to the base at the cursor; bytes outside the base add 0, as in bspatch
+static bool delta_apply_diff(ota_delta_sink_t *impl, const uint8_t *data, size_t len) {
+    while (len > 0) {
+        size_t n = len < sizeof(impl->old) ? len : sizeof(impl->old);
+        memset(impl->old, 0, n);
+
+        int64_t start = impl->old_pos;
+        int64_t end = start + (int64_t)n;
+        int64_t lo = start > 0 ? start : 0;
+        int64_t hi = end < (int64_t)impl->base.size ? end : (int64_t)impl->base.size;
+        if (lo < hi && !impl->base.read(impl->base.user_data, (size_t)lo,
+                                        impl->old + (lo - start), (size_t)(hi - lo))) {
+            LINX_LOGE(s_ota_delta_log, "Failed to read base image at %lld", (long long)lo);
+            return false;
+        }
+
+        for (size_t i = 0; i < n; i++) {
+            impl->old[i] = (uint8_t)(impl->old[i] + data[i]);
+        }
+        if (!delta_emit(impl, impl->old, n)) {
+            return false;
+        }
+
+        impl->old_pos += (int64_t)n;
+        impl->new_pos += n;
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+// Collect a fixed-size field; returns the bytes consumed
+static size_t delta_collect(ota_delta_sink_t *impl, const uint8_t *data, size_t len, size_t want) {
+    size_t n = want - impl->field_used;
+    n = len < n ? len : n;
+    memcpy(impl->field + impl->field_used, data, n);
+    impl->field_used += n;
+    return n;
+}
+
+static bool delta_parse_header(ota_delta_sink_t *impl) {
+    if (memcmp(impl->field, OTA_DELTA_MAGIC, OTA_DELTA_MAGIC_LEN) != 0) {
+        LINX_LOGE(s_ota_delta_log, "Not a %s patch", OTA_DELTA_MAGIC);
+        return false;
+    }
+    int64_t new_size = delta_read_int(impl->field + OTA_DELTA_MAGIC_LEN);
+    if (new_size <= 0 || (uint64_t)new_size > SIZE_MAX) {
+        LINX_LOGE(s_ota_delta_log, "Invalid new image size %lld", (long long)new_size);
+        return false;
+    }
+
+    impl->new_size = (uint64_t)new_size;
+    if (!impl->target->vtable->open(impl->target, (size_t)impl->new_size)) {
+        LINX_LOGE(s_ota_delta_log, "Failed to open target sink");
+        return false;
+    }
+    impl->target_opened = true;
+    LINX_LOGI(s_ota_delta_log, "Patching %zu byte base into %llu byte image",
+              impl->base.size, (unsigned long long)impl->new_size);
+    return true;
+}
+
+static bool delta_parse_control(ota_delta_sink_t *impl) {
+    int64_t diff_len = delta_read_int(impl->field);
+    int64_t extra_len = delta_read_int(impl->field + 8);
+    impl->seek = delta_read_int(impl->field + 16);
+
+    // The base cursor moves by diff_len + seek; reject triples that would overflow it
+    uint64_t left = impl->new_size - impl->new_pos;
+    int64_t diff_end, seek_end;
+    if (diff_len < 0 || extra_len < 0 || (uint64_t)diff_len > left ||
+        (uint64_t)extra_len > left - (uint64_t)diff_len ||
+        __builtin_add_overflow(impl->old_pos, diff_len, &diff_end) ||
+        __builtin_add_overflow(diff_end, impl->seek, &seek_end)) {
+        LINX_LOGE(s_ota_delta_log, "Corrupt control block at new offset %llu",
+                  (unsigned long long)impl->new_pos);
+        return false;
+    }
+    impl->diff_left = (uint64_t)diff_len;
+    impl->extra_left = (uint64_t)extra_len;
+    return true;
+}
+
+// Move on once the current stage has no bytes left
+static void delta_advance(ota_delta_sink_t *impl) {
+    if (impl->state == DELTA_STATE_DIFF && impl->diff_left == 0) {
+        impl->state = DELTA_STATE_EXTRA;
+    }
+    if (impl->state == DELTA_STATE_EXTRA && impl->extra_left == 0) {
+        impl->old_pos += impl->seek;    // Range checked by delta_parse_control
+        impl->field_used = 0;
+        impl->state = impl->new_pos == impl->new_size ? DELTA_STATE_DONE : DELTA_STATE_CONTROL;
+    }
+}
+
+static bool delta_sink_open(linx_ota_sink_t *sink, size_t image_size) {
+    ota_delta_sink_t *impl = (ota_delta_sink_t *)sink->impl_data;
+    (void)image_size;  // Patch size; the new size comes from the patch header
+
+    // Reopened when the server restarts the patch from 0
+    if (impl->target_opened && impl->target->vtable->abort) {
+        impl->target->vtable->abort(impl->target);
+    }
+    impl->target_opened = false;
+    impl->state = DELTA_STATE_HEADER;
+    impl->field_used = 0;
+    impl->new_size = 0;
+    impl->new_pos = 0;
+    impl->old_pos = 0;
+    impl->out_used = 0;
+    linx_sha256_init(&impl->sha256);
+    return true;
+}
+
+static bool delta_sink_write(linx_ota_sink_t *sink, const uint8_t *data, size_t len) {
+    ota_delta_sink_t *impl = (ota_delta_sink_t *)sink->impl_data;
+
+    while (len > 0) {
+        size_t n = 0;
+        switch (impl->state) {
+        case DELTA_STATE_HEADER:
+            n = delta_collect(impl, data, len, OTA_DELTA_MAGIC_LEN + 8);
+            if (impl->field_used == OTA_DELTA_MAGIC_LEN + 8) {
+                if (!delta_parse_header(impl)) {
+                    impl->state = DELTA_STATE_ERROR;
+                    return false;
+                }
+                impl->field_used = 0;
+                impl->state = DELTA_STATE_CONTROL;
+            }
+            break;
+
+        case DELTA_STATE_CONTROL:
+            n = delta_collect(impl, data, len, 24);
+            if (impl->field_used == 24) {
+                if (!delta_parse_control(impl)) {
+                    impl->state = DELTA_STATE_ERROR;
+                    return false;
+                }
+                impl->state = DELTA_STATE_DIFF;
+                delta_advance(impl);
+            }
+            break;
+
+        case DELTA_STATE_DIFF:
+            n = len < impl->diff_left ? len : (size_t)impl->diff_left;
+            if (!delta_apply_diff(impl, data, n)) {
+                impl->state = DELTA_STATE_ERROR;
+                return false;
+            }
+            impl->diff_left -= n;
+            delta_advance(impl);
+            break;
+
+        case DELTA_STATE_EXTRA:
+            n = len < impl->extra_left ? len : (size_t)impl->extra_left;
+            if (!delta_emit(impl, data, n)) {
+                impl->state = DELTA_STATE_ERROR;
+                return false;
+            }
+            impl->new_pos += n;
+            impl->extra_left -= n;
+            delta_advance(impl);
+            break;
+
+        case DELTA_STATE_DONE:
+            LINX_LOGE(s_ota_delta_log, "Trailing data after the end of the patch");
+            impl->state = DELTA_STATE_ERROR;
+            return false;
+
+        case DELTA_STATE_ERROR:
+        default:
+            return false;
+        }
+
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+static bool delta_sink_finish(linx_ota_sink_t *sink) {
+    ota_delta_sink_t *impl = (ota_delta_sink_t *)sink->impl_data;
+    if (impl->state != DELTA_STATE_DONE) {
+        LINX_LOGE(s_ota_delta_log, "Patch ended early at new offset %llu of %llu",
+                  (unsigned long long)impl->new_pos, (unsigned long long)impl->new_size);
+        return false;
+    }
+
+    // Verify before the final buffer goes out, so a bad image is never completed
+    if (impl->verify) {
+        uint8_t digest[32];
+        linx_sha256_final(&impl->sha256, digest);
+        if (memcmp(digest, impl->expected_sha256, sizeof(digest)) != 0) {
+            LINX_LOGE(s_ota_delta_log, "Patched image sha256 mismatch");
+            return false;
+        }
+    }
+
+    if (!delta_flush(impl)) {
+        return false;
+    }
+    if (impl->target->vtable->finish && !impl->target->vtable->finish(impl->target)) {
+        return false;
+    }
+    impl->target_opened = false;
+    return true;
+}
+
+static void delta_sink_abort(linx_ota_sink_t *sink) {
+    ota_delta_sink_t *impl = (ota_delta_sink_t *)sink->impl_data;
+    if (impl->target_opened && impl->target->vtable->abort) {
+        impl->target->vtable->abort(impl->target);
+    }
+    impl->target_opened = false;
+    impl->state = DELTA_STATE_ERROR;
+}
+
+static void delta_sink_destroy(linx_ota_sink_t *sink) {
+    LINX_FREE(sink->impl_data);
+    LINX_FREE(sink);
+}
+
+// No resume: the patch state machine and base cursor are not persisted
+static const linx_ota_sink_vtable_t s_delta_sink_vtable = {
+    .open = delta_sink_open,
+    .write = delta_sink_write,
+    .resume = NULL,
+    .finish = delta_sink_finish,
+    .abort = delta_sink_abort,
+    .destroy = delta_sink_destroy,
+};
+
+linx_ota_sink_t *linx_ota_delta_sink_create(linx_ota_sink_t *target, const linx_ota_delta_base_t *base,
+                                            const char *expected_sha256) {
+    if (!target || !target->vtable || !target->vtable->open || !target->vtable->write ||
+        !base || !base->read) {
+        LINX_LOGE(s_ota_delta_log, "Invalid delta sink parameters");
+        return NULL;
+    }
+
+    linx_ota_sink_t *sink = (linx_ota_sink_t *)LINX_CALLOC(1, sizeof(linx_ota_sink_t));
+    ota_delta_sink_t *impl = (ota_delta_sink_t *)LINX_CALLOC(1, sizeof(ota_delta_sink_t));
+    if (!sink || !impl) {
+        LINX_LOGE(s_ota_delta_log, "Failed to allocate delta sink");
+        LINX_FREE(sink);
+        LINX_FREE(impl);
+        return NULL;
+    }
+
+    if (expected_sha256 && expected_sha256[0]) {
+        if (!linx_ota_parse_sha256(expected_sha256, impl->expected_sha256)) {
+            LINX_LOGE(s_ota_delta_log, "Invalid image sha256: %s", expected_sha256);
+            LINX_FREE(sink);
+            LINX_FREE(impl);
+            return NULL;
+        }
+        impl->verify = true;
+    }
+
+    impl->target = target;
+    impl->base = *base;
+    sink->vtable = &s_delta_sink_vtable;
+    sink->impl_data = impl;
+    delta_sink_open(sink, 0);
+    return sink;
+}
+
+static bool file_base_read(void *user_data, size_t offset, uint8_t *buf, size_t len) {
+    FILE *fp = (FILE *)user_data;
+    return fseek(fp, (long)offset, SEEK_SET) == 0 && fread(buf, 1, len, fp) == len;
+}
+
+bool linx_ota_delta_base_from_file(linx_ota_delta_base_t *base, const char *path) {
+    if (!base || !path) {
+        return false;
+    }
+
+    FILE *fp = fopen(path, "rb");
+    if (!fp) {
+        LINX_LOGE(s_ota_delta_log, "Failed to open base image %s", path);
+        return false;
+    }
+    long size = fseek(fp, 0, SEEK_END) == 0 ? ftell(fp) : -1;
+    if (size < 0) {
+        fclose(fp);
+        return false;
+    }
+
+    base->read = file_base_read;
+    base->size = (size_t)size;
+    base->user_data = fp;
+    return true;
+}
+
+#if defined(ESP_PLATFORM)
+static bool partition_base_read(void *user_data, size_t offset, uint8_t *buf, size_t len) {
+    return esp_partition_read((const esp_partition_t *)user_data, offset, buf, len) == ESP_OK;
+}
+
+bool linx_ota_delta_base_from_running_partition(linx_ota_delta_base_t *base) {
+    const esp_partition_t *partition = base ? esp_ota_get_running_partition() : NULL;
+    if (!partition) {
+        return false;
+    }
+
+    base->read = partition_base_read;
+    base->size = partition->size;
+    base->user_data = (void *)partition;
+    return true;
+}
+#else
+bool linx_ota_delta_base_from_running_partition(linx_ota_delta_base_t *base) {
+    (void)base;
+    LINX_LOGE(s_ota_delta_log, "Running partition base not supported on this platform");
+    return false;
+}
+#endif
+
+void linx_ota_delta_base_close(linx_ota_delta_base_t *base) {
+    if (base && base->read == file_base_read && base->user_data) {
+        fclose((FILE *)base->user_data);
+    }
+    if (base) {
+        memset(base, 0, sizeof(*base));
+    }
+}
@@ -0,0 +1,96 @@
+/**
+ * @file linx_ota_delta.h
+ * @brief Streaming delta (binary patch) OTA updates
+ *
+ * A delta package describes the new image relative to the image currently
+ * installed (the base). The delta sink sits between the downloader and the
+ * real destination: it consumes the patch as it streams in, reads the base
+ * where the patch refers to it, and writes the reconstructed new image to
+ * the target sink. Memory use is two small buffers, independent of the image
+ * size.
+ *
+ * Patch format (LINXDIFF/BSDIFF1): the bsdiff 4.x control/diff/extra stream
+ * without the bzip2 stage, in the ENDSLEY/BSDIFF43 interleaved layout:
+ *
+ *   "LINXDIFF/BSDIFF1"   16-byte magic
+ *   new_size             8-byte bsdiff integer
+ *   repeated until new_size bytes are produced:
+ *     diff_len, extra_len, seek   three 8-byte bsdiff integers
+ *     diff_len bytes              added bytewise to the base at the cursor
+ *     extra_len bytes             copied verbatim
+ *   after each triple the base cursor moves by diff_len + seek
+ *
+ * bsdiff integers are little-endian sign-magnitude (bit 63 is the sign).
+ * A server can produce it with any bsdiff43 tool by decompressing the
+ * payload after the header. Transfer compression is left to HTTP.
+ */
+
+#ifndef LINX_OTA_DELTA_H
+#define LINX_OTA_DELTA_H
+
+#include "linx_ota_sink.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Patch format name advertised to the OTA server */
+#define LINX_OTA_DELTA_FORMAT "linxdiff1"
+
+/**
+ * @brief Read access to the base image the patch was made against
+ */
+typedef struct {
+    /** Read len bytes at offset; return false on I/O error */
+    bool (*read)(void *user_data, size_t offset, uint8_t *buf, size_t len);
+    size_t size;                    /**< Base image size */
+    void *user_data;
+} linx_ota_delta_base_t;
+
+/**
+ * @brief Create a sink that applies a delta patch on the fly
+ *
+ * The patch bytes written to this sink are turned into the new image, which
+ * is written to target. When expected_sha256 is given the new image is
+ * hashed as it is produced, and finish fails on a mismatch without
+ * finishing the target.
+ *
+ * @param target Destination of the new image (not owned)
+ * @param base Base image reader (copied; must stay readable until destroy)
+ * @param expected_sha256 SHA-256 of the new image (hex), NULL or "" to skip
+ * @return Sink instance or NULL on failure
+ */
+linx_ota_sink_t *linx_ota_delta_sink_create(linx_ota_sink_t *target, const linx_ota_delta_base_t *base,
+                                            const char *expected_sha256);
+
+/**
+ * @brief Use a file as the base image
+ *
+ * @param base Base reader to fill
+ * @param path Base image path
+ * @return true on success; release with linx_ota_delta_base_close
+ */
+bool linx_ota_delta_base_from_file(linx_ota_delta_base_t *base, const char *path);
+
+/**
+ * @brief Use the running app partition as the base image
+ *
+ * Only available on ESP-IDF; returns false elsewhere.
+ *
+ * @param base Base reader to fill
+ * @return true on success
+ */
+bool linx_ota_delta_base_from_running_partition(linx_ota_delta_base_t *base);
+
+/**
+ * @brief Release a base reader created by the helpers above
+ *
+ * @param base Base reader
+ */
+void linx_ota_delta_base_close(linx_ota_delta_base_t *base);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINX_OTA_DELTA_H */
@@ -0,0 +1,332 @@
+/**
+ * @file linx_ota_sink.c
+ * @brief File, callback and partition sinks for OTA downloads
+ */
+
+#include "linx_ota_sink.h"
+#include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(ESP_PLATFORM)
+#include "esp_ota_ops.h"
+#endif
+
+LINX_LOG_TAG_DEFINE(s_ota_sink_log, "LINX_OTA_SINK");
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_OTA);
+
+// File sink
+typedef struct {
+    char *path;
+    FILE *fp;
+} ota_file_sink_t;
+
+static bool file_sink_open(linx_ota_sink_t *sink, size_t image_size) {
+    ota_file_sink_t *impl = (ota_file_sink_t *)sink->impl_data;
+    (void)image_size;
+
+    if (impl->fp) {
+        fclose(impl->fp);
+    }
+    impl->fp = fopen(impl->path, "wb");
+    if (!impl->fp) {
+        LINX_LOGE(s_ota_sink_log, "Failed to open %s for writing", impl->path);
+        return false;
+    }
+    return true;
+}
+
+static bool file_sink_resume(linx_ota_sink_t *sink, size_t offset, size_t image_size) {
+    ota_file_sink_t *impl = (ota_file_sink_t *)sink->impl_data;
+    (void)image_size;
+
+    if (impl->fp) {
+        fclose(impl->fp);
+    }
+    impl->fp = fopen(impl->path, "r+b");
+    if (!impl->fp) {
+        return false;
+    }
+
+    // The file may be longer than the saved offset, never shorter; the tail is overwritten
+    long size = fseek(impl->fp, 0, SEEK_END) == 0 ? ftell(impl->fp) : -1;
+    if (size < 0 || (size_t)size < offset || fseek(impl->fp, (long)offset, SEEK_SET) != 0) {
+        LINX_LOGW(s_ota_sink_log, "%s is shorter than resume offset %zu", impl->path, offset);
+        fclose(impl->fp);
+        impl->fp = NULL;
+        return false;
+    }
+    return true;
+}
+
+static bool file_sink_write(linx_ota_sink_t *sink, const uint8_t *data, size_t len) {
+    ota_file_sink_t *impl = (ota_file_sink_t *)sink->impl_data;
+    if (!impl->fp || fwrite(data, 1, len, impl->fp) != len || fflush(impl->fp) != 0) {
+        LINX_LOGE(s_ota_sink_log, "Failed to write %zu bytes to %s", len, impl->path);
+        return false;
+    }
+    return true;
+}
+
+static bool file_sink_finish(linx_ota_sink_t *sink) {
+    ota_file_sink_t *impl = (ota_file_sink_t *)sink->impl_data;
+    if (!impl->fp) {
+        return false;
+    }
+
+    bool ok = fflush(impl->fp) == 0;
+    ok = fclose(impl->fp) == 0 && ok;
+    impl->fp = NULL;
+    if (!ok) {
+        LINX_LOGE(s_ota_sink_log, "Failed to flush %s", impl->path);
+        remove(impl->path);
+    }
+    return ok;
+}
+
+static void file_sink_abort(linx_ota_sink_t *sink) {
+    ota_file_sink_t *impl = (ota_file_sink_t *)sink->impl_data;
+    if (impl->fp) {
+        fclose(impl->fp);
+        impl->fp = NULL;
+        remove(impl->path);
+    }
+}
+
+static void file_sink_destroy(linx_ota_sink_t *sink) {
+    ota_file_sink_t *impl = (ota_file_sink_t *)sink->impl_data;
+    if (impl) {
+        if (impl->fp) {
+            fclose(impl->fp);
+        }
+        LINX_FREE(impl->path);
+        LINX_FREE(impl);
+    }
+    LINX_FREE(sink);
+}
+
+static const linx_ota_sink_vtable_t s_file_sink_vtable = {
+    .open = file_sink_open,
+    .write = file_sink_write,
+    .resume = file_sink_resume,
+    .finish = file_sink_finish,
+    .abort = file_sink_abort,
+    .destroy = file_sink_destroy,
+};
+
+linx_ota_sink_t *linx_ota_file_sink_create(const char *path) {
+    if (!path || !path[0]) {
+        LINX_LOGE(s_ota_sink_log, "Invalid file sink path");
+        return NULL;
+    }
+
+    linx_ota_sink_t *sink = (linx_ota_sink_t *)LINX_CALLOC(1, sizeof(linx_ota_sink_t));
+    ota_file_sink_t *impl = (ota_file_sink_t *)LINX_CALLOC(1, sizeof(ota_file_sink_t));
+    char *path_copy = LINX_STRDUP(path);
+    if (!sink || !impl || !path_copy) {
+        LINX_LOGE(s_ota_sink_log, "Failed to allocate file sink");
+        LINX_FREE(sink);
+        LINX_FREE(impl);
+        LINX_FREE(path_copy);
+        return NULL;
+    }
+
+    impl->path = path_copy;
+    sink->vtable = &s_file_sink_vtable;
+    sink->impl_data = impl;
+    return sink;
+}
+
+// Callback sink
+typedef struct {
+    linx_ota_sink_write_cb_t write_cb;
+    void *user_data;
+    size_t offset;
+} ota_callback_sink_t;
+
+static bool callback_sink_open(linx_ota_sink_t *sink, size_t image_size) {
+    ota_callback_sink_t *impl = (ota_callback_sink_t *)sink->impl_data;
+    (void)image_size;
+    impl->offset = 0;
+    return true;
+}
+
+static bool callback_sink_resume(linx_ota_sink_t *sink, size_t offset, size_t image_size) {
+    ota_callback_sink_t *impl = (ota_callback_sink_t *)sink->impl_data;
+    (void)image_size;
+    impl->offset = offset;
+    return true;
+}
+
+static bool callback_sink_write(linx_ota_sink_t *sink, const uint8_t *data, size_t len) {
+    ota_callback_sink_t *impl = (ota_callback_sink_t *)sink->impl_data;
+    if (!impl->write_cb(impl->user_data, impl->offset, data, len)) {
+        return false;
+    }
+    impl->offset += len;
+    return true;
+}
+
+static bool callback_sink_finish(linx_ota_sink_t *sink) {
+    (void)sink;
+    return true;
+}
+
+static void callback_sink_abort(linx_ota_sink_t *sink) {
+    (void)sink;
+}
+
+static void callback_sink_destroy(linx_ota_sink_t *sink) {
+    LINX_FREE(sink->impl_data);
+    LINX_FREE(sink);
+}
+
+static const linx_ota_sink_vtable_t s_callback_sink_vtable = {
+    .open = callback_sink_open,
+    .write = callback_sink_write,
+    .resume = callback_sink_resume,
+    .finish = callback_sink_finish,
+    .abort = callback_sink_abort,
+    .destroy = callback_sink_destroy,
+};
+
+linx_ota_sink_t *linx_ota_callback_sink_create(linx_ota_sink_write_cb_t write_cb, void *user_data) {
+    if (!write_cb) {
+        LINX_LOGE(s_ota_sink_log, "Invalid callback sink parameters");
+        return NULL;
+    }
+
+    linx_ota_sink_t *sink = (linx_ota_sink_t *)LINX_CALLOC(1, sizeof(linx_ota_sink_t));
+    ota_callback_sink_t *impl = (ota_callback_sink_t *)LINX_CALLOC(1, sizeof(ota_callback_sink_t));
+    if (!sink || !impl) {
+        LINX_LOGE(s_ota_sink_log, "Failed to allocate callback sink");
+        LINX_FREE(sink);
+        LINX_FREE(impl);
+        return NULL;
+    }
+
+    impl->write_cb = write_cb;
+    impl->user_data = user_data;
+    sink->vtable = &s_callback_sink_vtable;
+    sink->impl_data = impl;
+    return sink;
+}
+
+#if defined(ESP_PLATFORM)
+// Partition sink (ESP-IDF app partitions)
+typedef struct {
+    const esp_partition_t *partition;
+    esp_ota_handle_t handle;
+    bool active;
+} ota_partition_sink_t;
+
+static bool partition_sink_open(linx_ota_sink_t *sink, size_t image_size) {
+    ota_partition_sink_t *impl = (ota_partition_sink_t *)sink->impl_data;
+
+    // Reopened when the server restarts the image from 0
+    if (impl->active) {
+        esp_ota_abort(impl->handle);
+        impl->active = false;
+    }
+
+    impl->partition = esp_ota_get_next_update_partition(NULL);
+    if (!impl->partition) {
+        LINX_LOGE(s_ota_sink_log, "No OTA update partition");
+        return false;
+    }
+    if (image_size > impl->partition->size) {
+        LINX_LOGE(s_ota_sink_log, "Image (%zu bytes) does not fit partition %s (%u bytes)",
+                  image_size, impl->partition->label, (unsigned)impl->partition->size);
+        return false;
+    }
+
+    esp_err_t err = esp_ota_begin(impl->partition, image_size, &impl->handle);
+    if (err != ESP_OK) {
+        LINX_LOGE(s_ota_sink_log, "esp_ota_begin failed: %d", err);
+        return false;
+    }
+    impl->active = true;
+    LINX_LOGI(s_ota_sink_log, "Writing image to partition %s", impl->partition->label);
+    return true;
+}
+
+static bool partition_sink_write(linx_ota_sink_t *sink, const uint8_t *data, size_t len) {
+    ota_partition_sink_t *impl = (ota_partition_sink_t *)sink->impl_data;
+    esp_err_t err = impl->active ? esp_ota_write(impl->handle, data, len) : ESP_FAIL;
+    if (err != ESP_OK) {
+        LINX_LOGE(s_ota_sink_log, "esp_ota_write failed: %d", err);
+        return false;
+    }
+    return true;
+}
+
+static bool partition_sink_finish(linx_ota_sink_t *sink) {
+    ota_partition_sink_t *impl = (ota_partition_sink_t *)sink->impl_data;
+    if (!impl->active) {
+        return false;
+    }
+
+    impl->active = false;
+    esp_err_t err = esp_ota_end(impl->handle);
+    if (err == ESP_OK) {
+        err = esp_ota_set_boot_partition(impl->partition);
+    }
+    if (err != ESP_OK) {
+        LINX_LOGE(s_ota_sink_log, "Failed to finalize partition %s: %d", impl->partition->label, err);
+        return false;
+    }
+    return true;
+}
+
+static void partition_sink_abort(linx_ota_sink_t *sink) {
+    ota_partition_sink_t *impl = (ota_partition_sink_t *)sink->impl_data;
+    if (impl->active) {
+        esp_ota_abort(impl->handle);
+        impl->active = false;
+    }
+}
+
+static void partition_sink_destroy(linx_ota_sink_t *sink) {
+    partition_sink_abort(sink);
+    LINX_FREE(sink->impl_data);
+    LINX_FREE(sink);
+}
+
+static const linx_ota_sink_vtable_t s_partition_sink_vtable = {
+    .open = partition_sink_open,
+    .write = partition_sink_write,
+    .resume = NULL,
+    .finish = partition_sink_finish,
+    .abort = partition_sink_abort,
+    .destroy = partition_sink_destroy,
+};
+
+linx_ota_sink_t *linx_ota_partition_sink_create(void) {
+    linx_ota_sink_t *sink = (linx_ota_sink_t *)LINX_CALLOC(1, sizeof(linx_ota_sink_t));
+    ota_partition_sink_t *impl = (ota_partition_sink_t *)LINX_CALLOC(1, sizeof(ota_partition_sink_t));
+    if (!sink || !impl) {
+        LINX_LOGE(s_ota_sink_log, "Failed to allocate partition sink");
+        LINX_FREE(sink);
+        LINX_FREE(impl);
+        return NULL;
+    }
+
+    sink->vtable = &s_partition_sink_vtable;
+    sink->impl_data = impl;
+    return sink;
+}
+#else
+linx_ota_sink_t *linx_ota_partition_sink_create(void) {
+    LINX_LOGE(s_ota_sink_log, "Partition sink not supported on this platform");
+    return NULL;
+}
+#endif
+
+void linx_ota_sink_destroy(linx_ota_sink_t *sink) {
+    if (sink && sink->vtable && sink->vtable->destroy) {
+        sink->vtable->destroy(sink);
+    }
+}
@@ -0,0 +1,108 @@
+/**
+ * @file linx_ota_sink.h
+ * @brief Streaming destinations for OTA firmware downloads
+ *
+ * The downloader hands the firmware to a sink in fixed-size chunks as it
+ * arrives from the network, so the image never has to fit in RAM. A sink is
+ * opened once with the expected image size, receives the chunks in order,
+ * and is then either finished (all bytes arrived) or aborted (download
+ * failed; the sink discards what it wrote).
+ *
+ * Sinks that implement resume can also be positioned on a partial image an
+ * earlier download left behind, instead of being opened; the downloader then
+ * continues with an HTTP Range request.
+ */
+
+#ifndef LINX_OTA_SINK_H
+#define LINX_OTA_SINK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct linx_ota_sink linx_ota_sink_t;
+
+/**
+ * @brief Sink operations
+ */
+typedef struct {
+    bool (*open)(linx_ota_sink_t *sink, size_t image_size);                 /**< Prepare for image_size bytes */
+    bool (*write)(linx_ota_sink_t *sink, const uint8_t *data, size_t len);  /**< Append the next chunk */
+    bool (*resume)(linx_ota_sink_t *sink, size_t offset, size_t image_size); /**< Continue a partial image at offset (optional) */
+    bool (*finish)(linx_ota_sink_t *sink);                                  /**< All bytes written */
+    void (*abort)(linx_ota_sink_t *sink);                                   /**< Discard the partial image */
+    void (*destroy)(linx_ota_sink_t *sink);                                 /**< Free the sink */
+} linx_ota_sink_vtable_t;
+
+/**
+ * @brief Sink instance
+ */
+struct linx_ota_sink {
+    const linx_ota_sink_vtable_t *vtable;
+    void *impl_data;
+};
+
+/**
+ * @brief Write callback used by the callback sink
+ *
+ * @param user_data User pointer passed to linx_ota_callback_sink_create
+ * @param offset Offset of this chunk in the image
+ * @param data Chunk data
+ * @param len Chunk length
+ * @return true on success, false to abort the download
+ */
+typedef bool (*linx_ota_sink_write_cb_t)(void *user_data, size_t offset, const uint8_t *data, size_t len);
+
+/**
+ * @brief Create a sink that writes the image to a file
+ *
+ * The file is truncated on open and removed again if the download aborts.
+ * Every chunk is flushed, so after a crash the file holds at least the bytes
+ * a saved resume offset refers to.
+ *
+ * @param path File path (copied)
+ * @return Sink instance or NULL on failure
+ */
+linx_ota_sink_t *linx_ota_file_sink_create(const char *path);
+
+/**
+ * @brief Create a sink that hands every chunk to a callback
+ *
+ * Use this to write straight to a flash partition on boards without a
+ * built-in partition sink. Supports resume: after a restart the callback
+ * simply continues at the saved offset, so the region must not be erased
+ * in between.
+ *
+ * @param write_cb Chunk receiver
+ * @param user_data User pointer passed to write_cb
+ * @return Sink instance or NULL on failure
+ */
+linx_ota_sink_t *linx_ota_callback_sink_create(linx_ota_sink_write_cb_t write_cb, void *user_data);
+
+/**
+ * @brief Create a sink that writes to the next OTA app partition
+ *
+ * Only available on ESP-IDF; on other platforms returns NULL. On finish the
+ * partition is marked as the boot partition. Does not support resume,
+ * because esp_ota_begin erases the partition.
+ *
+ * @return Sink instance or NULL on failure
+ */
+linx_ota_sink_t *linx_ota_partition_sink_create(void);
+
+/**
+ * @brief Destroy a sink
+ *
+ * @param sink Sink instance
+ */
+void linx_ota_sink_destroy(linx_ota_sink_t *sink);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINX_OTA_SINK_H */
@@ -0,0 +1,399 @@
+/**
+ * @file linx_ota_slot.c
+ * @brief A/B image slots with trial boot and automatic rollback
+ */
+
+#include "linx_ota_slot.h"
+#include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#if defined(ESP_PLATFORM)
+#include "esp_ota_ops.h"
+#else
+#include <unistd.h>
+#endif
+
+LINX_LOG_TAG_DEFINE(s_ota_slot_log, "LINX_OTA_SLOT");
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_OTA);
+
+#if defined(ESP_PLATFORM)
+static int slot_index(const esp_partition_t *partition) {
+    if (partition && partition->subtype >= ESP_PARTITION_SUBTYPE_APP_OTA_0 &&
+        partition->subtype <= ESP_PARTITION_SUBTYPE_APP_OTA_MAX) {
+        return (partition->subtype - ESP_PARTITION_SUBTYPE_APP_OTA_0) & 1;
+    }
+    return 0;
+}
+
+linx_ota_sink_t *linx_ota_slot_sink_create(const linx_ota_slot_config_t *config) {
+    (void)config;
+    if (linx_ota_slot_get_state(NULL) == LINX_OTA_SLOT_PENDING_VERIFY) {
+        LINX_LOGE(s_ota_slot_log, "Running image is not confirmed yet, refusing to overwrite the other slot");
+        return NULL;
+    }
+    return linx_ota_partition_sink_create();
+}
+
+int linx_ota_slot_select_boot(const linx_ota_slot_config_t *config) {
+    // The bootloader picks the partition and handles the trial boot itself
+    return linx_ota_slot_running(config);
+}
+
+int linx_ota_slot_running(const linx_ota_slot_config_t *config) {
+    (void)config;
+    return slot_index(esp_ota_get_running_partition());
+}
+
+linx_ota_slot_state_t linx_ota_slot_get_state(const linx_ota_slot_config_t *config) {
+    (void)config;
+    esp_ota_img_states_t state;
+    if (esp_ota_get_state_partition(esp_ota_get_running_partition(), &state) == ESP_OK &&
+        state == ESP_OTA_IMG_PENDING_VERIFY) {
+        return LINX_OTA_SLOT_PENDING_VERIFY;
+    }
+    return LINX_OTA_SLOT_VALID;
+}
+
+bool linx_ota_slot_has_pending(const linx_ota_slot_config_t *config) {
+    (void)config;
+    return esp_ota_get_boot_partition() != esp_ota_get_running_partition();
+}
+
+bool linx_ota_slot_mark_valid(const linx_ota_slot_config_t *config) {
+    if (linx_ota_slot_get_state(config) != LINX_OTA_SLOT_PENDING_VERIFY) {
+        return true;
+    }
+    esp_err_t err = esp_ota_mark_app_valid_cancel_rollback();
+    if (err != ESP_OK) {
+        LINX_LOGE(s_ota_slot_log, "Failed to confirm running image: %d", err);
+        return false;
+    }
+    LINX_LOGI(s_ota_slot_log, "Running image confirmed");
+    return true;
+}
+
+bool linx_ota_slot_mark_invalid(const linx_ota_slot_config_t *config) {
+    if (linx_ota_slot_get_state(config) != LINX_OTA_SLOT_PENDING_VERIFY) {
+        return false;
+    }
+    LINX_LOGW(s_ota_slot_log, "Rejecting running image, rolling back");
+    esp_ota_mark_app_invalid_rollback_and_reboot();
+    return false;
+}
+#else
+#define OTA_SLOT_MAGIC 0x544f4c53u      // "SLOT"
+#define OTA_SLOT_VERSION 1
+
+// Boot state file contents (device-local, native byte order)
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    int8_t active;                  // Last confirmed slot
+    int8_t pending;                 // Slot holding a new image, -1 = none
+    int8_t booted;                  // Slot picked by the last linx_ota_slot_select_boot, -1 = unknown
+    uint8_t trial_boots_left;       // Boots the pending image has left
+} ota_slot_state_t;
+
+static void slot_state_load(const linx_ota_slot_config_t *config, ota_slot_state_t *state) {
+    memset(state, 0, sizeof(*state));
+    state->pending = -1;
+    state->booted = -1;
+
+    FILE *fp = config->state_path ? fopen(config->state_path, "rb") : NULL;
+    if (!fp) {
+        return;
+    }
+    ota_slot_state_t record;
+    bool ok = fread(&record, sizeof(record), 1, fp) == 1;
+    fclose(fp);
+    if (!ok || record.magic != OTA_SLOT_MAGIC || record.version != OTA_SLOT_VERSION ||
+        (record.active & ~1) != 0 || record.pending < -1 || record.pending > 1 ||
+        record.booted < -1 || record.booted > 1) {
+        LINX_LOGW(s_ota_slot_log, "Ignoring invalid boot state in %s", config->state_path);
+        return;
+    }
+    *state = record;
+}
+
+static bool slot_state_save(const linx_ota_slot_config_t *config, const ota_slot_state_t *state) {
+    if (!config->state_path) {
+        return false;
+    }
+
+    // Write a temporary file and rename it, so a power cut never leaves a torn record
+    char tmp_path[512];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", config->state_path);
+    FILE *fp = fopen(tmp_path, "wb");
+    if (!fp) {
+        LINX_LOGE(s_ota_slot_log, "Failed to save boot state to %s", config->state_path);
+        return false;
+    }
+    ota_slot_state_t record = *state;
+    record.magic = OTA_SLOT_MAGIC;
+    record.version = OTA_SLOT_VERSION;
+    bool ok = fwrite(&record, sizeof(record), 1, fp) == 1 && fflush(fp) == 0 && fsync(fileno(fp)) == 0;
+    ok = fclose(fp) == 0 && ok;
+    if (!ok || rename(tmp_path, config->state_path) != 0) {
+        LINX_LOGE(s_ota_slot_log, "Failed to save boot state to %s", config->state_path);
+        remove(tmp_path);
+        return false;
+    }
+    return true;
+}
+
+static int slot_running(const ota_slot_state_t *state) {
+    return state->booted >= 0 ? state->booted : state->active;
+}
+
+static bool slot_on_trial(const ota_slot_state_t *state) {
+    return state->pending >= 0 && state->booted == state->pending;
+}
+
+static int slot_trial_boots(const linx_ota_slot_config_t *config) {
+    int boots = config->max_trial_boots > 0 ? config->max_trial_boots : LINX_OTA_SLOT_DEFAULT_TRIAL_BOOTS;
+    return boots > 255 ? 255 : boots;
+}
+
+// Slot sink
+typedef struct {
+    linx_ota_slot_config_t config;
+    int target;                     // Slot being written
+    FILE *fp;
+} ota_slot_sink_t;
+
+static bool slot_sink_prepare(ota_slot_sink_t *impl, size_t image_size) {
+    if (impl->fp) {
+        fclose(impl->fp);
+        impl->fp = NULL;
+    }
+
+    ota_slot_state_t state;
+    slot_state_load(&impl->config, &state);
+    if (state.booted >= 0 && state.booted != state.active) {
+        // Running a trial or rejected image: the other slot holds the only known-good one
+        LINX_LOGE(s_ota_slot_log, "Running image is not confirmed, refusing to overwrite the other slot");
+        return false;
+    }
+    if (impl->config.slot_size > 0 && image_size > impl->config.slot_size) {
+        LINX_LOGE(s_ota_slot_log, "Image (%zu bytes) does not fit slot (%zu bytes)", image_size, impl->config.slot_size);
+        return false;
+    }
+
+    impl->target = 1 - state.active;
+    if (state.pending == impl->target) {
+        // The staged image is about to be overwritten, so it must not be booted any more
+        state.pending = -1;
+        state.trial_boots_left = 0;
+        if (!slot_state_save(&impl->config, &state)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool slot_sink_open(linx_ota_sink_t *sink, size_t image_size) {
+    ota_slot_sink_t *impl = (ota_slot_sink_t *)sink->impl_data;
+    if (!slot_sink_prepare(impl, image_size)) {
+        return false;
+    }
+
+    // Block devices and existing images are written in place; "wb" only creates a missing image file
+    const char *path = impl->config.slot_paths[impl->target];
+    impl->fp = fopen(path, "r+b");
+    if (!impl->fp) {
+        impl->fp = fopen(path, "wb");
+    }
+    if (!impl->fp) {
+        LINX_LOGE(s_ota_slot_log, "Failed to open slot %c (%s)", 'A' + impl->target, path);
+        return false;
+    }
+    LINX_LOGI(s_ota_slot_log, "Writing %zu-byte image to slot %c (%s)", image_size, 'A' + impl->target, path);
+    return true;
+}
+
+static bool slot_sink_resume(linx_ota_sink_t *sink, size_t offset, size_t image_size) {
+    ota_slot_sink_t *impl = (ota_slot_sink_t *)sink->impl_data;
+    if (!slot_sink_prepare(impl, image_size)) {
+        return false;
+    }
+
+    const char *path = impl->config.slot_paths[impl->target];
+    impl->fp = fopen(path, "r+b");
+    if (!impl->fp || fseek(impl->fp, (long)offset, SEEK_SET) != 0) {
+        LINX_LOGW(s_ota_slot_log, "Cannot resume slot %c at offset %zu", 'A' + impl->target, offset);
+        if (impl->fp) {
+            fclose(impl->fp);
+            impl->fp = NULL;
+        }
+        return false;
+    }
+    LINX_LOGI(s_ota_slot_log, "Resuming slot %c at %zu/%zu bytes", 'A' + impl->target, offset, image_size);
+    return true;
+}
+
+static bool slot_sink_write(linx_ota_sink_t *sink, const uint8_t *data, size_t len) {
+    ota_slot_sink_t *impl = (ota_slot_sink_t *)sink->impl_data;
+    if (!impl->fp || fwrite(data, 1, len, impl->fp) != len || fflush(impl->fp) != 0) {
+        LINX_LOGE(s_ota_slot_log, "Failed to write %zu bytes to slot %c", len, 'A' + impl->target);
+        return false;
+    }
+    return true;
+}
+
+static bool slot_sink_finish(linx_ota_sink_t *sink) {
+    ota_slot_sink_t *impl = (ota_slot_sink_t *)sink->impl_data;
+    if (!impl->fp) {
+        return false;
+    }
+
+    // The image must be on the medium before the state points at it
+    bool ok = fflush(impl->fp) == 0 && fsync(fileno(impl->fp)) == 0;
+    ok = fclose(impl->fp) == 0 && ok;
+    impl->fp = NULL;
+    if (!ok) {
+        LINX_LOGE(s_ota_slot_log, "Failed to sync slot %c", 'A' + impl->target);
+        return false;
+    }
+
+    ota_slot_state_t state;
+    slot_state_load(&impl->config, &state);
+    state.pending = (int8_t)impl->target;
+    state.trial_boots_left = (uint8_t)slot_trial_boots(&impl->config);
+    if (!slot_state_save(&impl->config, &state)) {
+        return false;
+    }
+    LINX_LOGI(s_ota_slot_log, "Slot %c pending, %d trial boots", 'A' + impl->target, state.trial_boots_left);
+    return true;
+}
+
+static void slot_sink_abort(linx_ota_sink_t *sink) {
+    ota_slot_sink_t *impl = (ota_slot_sink_t *)sink->impl_data;
+    // The slot is not pending, so the partial image is harmless and simply overwritten next time
+    if (impl->fp) {
+        fclose(impl->fp);
+        impl->fp = NULL;
+    }
+}
+
+static void slot_sink_destroy(linx_ota_sink_t *sink) {
+    slot_sink_abort(sink);
+    LINX_FREE(sink->impl_data);
+    LINX_FREE(sink);
+}
+
+static const linx_ota_sink_vtable_t s_slot_sink_vtable = {
+    .open = slot_sink_open,
+    .write = slot_sink_write,
+    .resume = slot_sink_resume,
+    .finish = slot_sink_finish,
+    .abort = slot_sink_abort,
+    .destroy = slot_sink_destroy,
+};
+
+linx_ota_sink_t *linx_ota_slot_sink_create(const linx_ota_slot_config_t *config) {
+    if (!config || !config->slot_paths[0] || !config->slot_paths[1] || !config->state_path) {
+        LINX_LOGE(s_ota_slot_log, "Slot sink needs two slot paths and a state path");
+        return NULL;
+    }
+
+    linx_ota_sink_t *sink = (linx_ota_sink_t *)LINX_CALLOC(1, sizeof(linx_ota_sink_t));
+    ota_slot_sink_t *impl = (ota_slot_sink_t *)LINX_CALLOC(1, sizeof(ota_slot_sink_t));
+    if (!sink || !impl) {
+        LINX_LOGE(s_ota_slot_log, "Failed to allocate slot sink");
+        LINX_FREE(sink);
+        LINX_FREE(impl);
+        return NULL;
+    }
+
+    impl->config = *config;
+    sink->vtable = &s_slot_sink_vtable;
+    sink->impl_data = impl;
+    return sink;
+}
+
+int linx_ota_slot_select_boot(const linx_ota_slot_config_t *config) {
+    if (!config) {
+        return 0;
+    }
+    ota_slot_state_t state;
+    slot_state_load(config, &state);
+
+    int slot = state.active;
+    if (state.pending >= 0 && state.trial_boots_left > 0) {
+        state.trial_boots_left--;
+        slot = state.pending;
+        LINX_LOGI(s_ota_slot_log, "Trial boot of slot %c, %d left", 'A' + slot, state.trial_boots_left);
+    } else if (state.pending >= 0) {
+        LINX_LOGW(s_ota_slot_log, "Slot %c was never confirmed, rolling back to slot %c",
+                  'A' + state.pending, 'A' + state.active);
+        state.pending = -1;
+    }
+    state.booted = (int8_t)slot;
+    slot_state_save(config, &state);
+    return slot;
+}
+
+int linx_ota_slot_running(const linx_ota_slot_config_t *config) {
+    if (!config) {
+        return 0;
+    }
+    ota_slot_state_t state;
+    slot_state_load(config, &state);
+    return slot_running(&state);
+}
+
+linx_ota_slot_state_t linx_ota_slot_get_state(const linx_ota_slot_config_t *config) {
+    if (!config) {
+        return LINX_OTA_SLOT_VALID;
+    }
+    ota_slot_state_t state;
+    slot_state_load(config, &state);
+    return slot_on_trial(&state) ? LINX_OTA_SLOT_PENDING_VERIFY : LINX_OTA_SLOT_VALID;
+}
+
+bool linx_ota_slot_has_pending(const linx_ota_slot_config_t *config) {
+    if (!config) {
+        return false;
+    }
+    ota_slot_state_t state;
+    slot_state_load(config, &state);
+    return state.pending >= 0 && !slot_on_trial(&state);
+}
+
+bool linx_ota_slot_mark_valid(const linx_ota_slot_config_t *config) {
+    if (!config) {
+        return false;
+    }
+    ota_slot_state_t state;
+    slot_state_load(config, &state);
+    if (!slot_on_trial(&state)) {
+        return true;
+    }
+    state.active = state.pending;
+    state.pending = -1;
+    state.trial_boots_left = 0;
+    if (!slot_state_save(config, &state)) {
+        return false;
+    }
+    LINX_LOGI(s_ota_slot_log, "Slot %c confirmed", 'A' + state.active);
+    return true;
+}
+
+bool linx_ota_slot_mark_invalid(const linx_ota_slot_config_t *config) {
+    if (!config) {
+        return false;
+    }
+    ota_slot_state_t state;
+    slot_state_load(config, &state);
+    if (!slot_on_trial(&state)) {
+        return false;
+    }
+    LINX_LOGW(s_ota_slot_log, "Rejecting slot %c, slot %c boots next", 'A' + state.pending, 'A' + state.active);
+    state.pending = -1;
+    state.trial_boots_left = 0;
+    return slot_state_save(config, &state);
+}
+#endif
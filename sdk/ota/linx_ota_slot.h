@@ -0,0 +1,123 @@
+/**
+ * @file linx_ota_slot.h
+ * @brief A/B image slots with trial boot and automatic rollback
+ *
+ * The device keeps two image slots. The running image lives in one of them;
+ * a download streams straight into the other through the sink returned by
+ * linx_ota_slot_sink_create(), so the image is written exactly once and
+ * never staged in RAM or in a temporary file. The downloader verifies the
+ * SHA-256 before it finishes the sink, and only a finished sink marks the
+ * new slot as pending for the next boot.
+ *
+ * A pending image gets a limited number of trial boots. The application
+ * calls linx_ota_slot_mark_valid() once it is healthy (for example after
+ * the first successful server connection); if it crashes or hangs before
+ * that, the next boot falls back to the previous slot once the trial boots
+ * are used up. linx_ota_slot_mark_invalid() rolls back right away.
+ *
+ * On ESP-IDF the slots are the ota_0 / ota_1 app partitions and the boot
+ * state is the bootloader's own rollback state (CONFIG_BOOTLOADER_APP_ROLLBACK_ENABLE);
+ * the config argument is ignored there. On other platforms the slots are
+ * two block devices or files and a small state file records which one to
+ * boot; the launcher (init script, U-Boot script or a small wrapper) calls
+ * linx_ota_slot_select_boot() once per boot to pick the image.
+ */
+
+#ifndef LINX_OTA_SLOT_H
+#define LINX_OTA_SLOT_H
+
+#include "linx_ota_sink.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef LINX_OTA_SLOT_DEFAULT_TRIAL_BOOTS
+#define LINX_OTA_SLOT_DEFAULT_TRIAL_BOOTS 3
+#endif
+
+/**
+ * @brief Slot layout (ignored on ESP-IDF)
+ */
+typedef struct {
+    const char *slot_paths[2];      /**< Slot A and B: block devices, partitions or image files */
+    const char *state_path;         /**< Boot state file, written atomically */
+    size_t slot_size;               /**< Capacity of each slot in bytes, 0 = not checked */
+    int max_trial_boots;            /**< Boots a new image gets before rollback, 0 = LINX_OTA_SLOT_DEFAULT_TRIAL_BOOTS */
+} linx_ota_slot_config_t;
+
+/**
+ * @brief State of the running image
+ */
+typedef enum {
+    LINX_OTA_SLOT_VALID = 0,        /**< Confirmed image */
+    LINX_OTA_SLOT_PENDING_VERIFY,   /**< New image on trial; confirm with linx_ota_slot_mark_valid */
+} linx_ota_slot_state_t;
+
+/**
+ * @brief Create a sink that writes the image into the inactive slot
+ *
+ * Opening the sink drops a pending image that lives in that slot. Writes
+ * go to the slot in place and every chunk is flushed, so the sink supports
+ * resume. Finishing syncs the slot and marks it pending for the next boot;
+ * aborting leaves the boot state unchanged.
+ *
+ * Refuses to open while the running image is not confirmed (on trial or
+ * rejected), since the inactive slot then holds the only known-good image.
+ *
+ * @param config Slot layout (copied; ignored on ESP-IDF)
+ * @return Sink instance or NULL on failure
+ */
+linx_ota_sink_t *linx_ota_slot_sink_create(const linx_ota_slot_config_t *config);
+
+/**
+ * @brief Pick the slot to boot; call once per boot from the launcher
+ *
+ * Boots the pending slot while it has trial boots left, consuming one, and
+ * clears the pending image once they are used up so the previous slot runs
+ * again. On ESP-IDF the bootloader already did this and the running slot
+ * is returned.
+ *
+ * @param config Slot layout
+ * @return Slot index (0 or 1) to boot
+ */
+int linx_ota_slot_select_boot(const linx_ota_slot_config_t *config);
+
+/**
+ * @brief Slot the running image was booted from
+ */
+int linx_ota_slot_running(const linx_ota_slot_config_t *config);
+
+/**
+ * @brief Whether the running image is confirmed or still on trial
+ */
+linx_ota_slot_state_t linx_ota_slot_get_state(const linx_ota_slot_config_t *config);
+
+/**
+ * @brief Whether an image is waiting in the inactive slot for the next boot
+ */
+bool linx_ota_slot_has_pending(const linx_ota_slot_config_t *config);
+
+/**
+ * @brief Confirm the running image so it is kept on the next boots
+ *
+ * @return true on success (also when the image was already confirmed)
+ */
+bool linx_ota_slot_mark_valid(const linx_ota_slot_config_t *config);
+
+/**
+ * @brief Reject the running trial image and roll back to the previous slot
+ *
+ * On ESP-IDF this reboots into the previous app and does not return. On
+ * other platforms the previous slot is selected for the next boot; the
+ * caller restarts the device.
+ *
+ * @return true if a trial image was rejected
+ */
+bool linx_ota_slot_mark_invalid(const linx_ota_slot_config_t *config);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINX_OTA_SLOT_H */
@@ -4,8 +4,11 @@
  */
 
 #include "../linx_ota.h"
+#include "../linx_ota_delta.h"
+#include "../../linx_crypto.h"
 #include "../../log/linx_log.h"
 
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -13,11 +16,308 @@
 
 #define TAG "OTA_TEST"
 
+static int s_failures = 0;
+
+#define CHECK(cond, msg) do { \
+    if (cond) { \
+        printf("  PASS: %s\n", msg); \
+    } else { \
+        printf("  FAIL: %s (%s:%d)\n", msg, __FILE__, __LINE__); \
+        s_failures++; \
+    } \
+} while (0)
+
 // Progress callback
 static void progress_callback(int percentage) {
     printf("Download progress: %d%%\n", percentage);
 }
 
+/* ============================================================================
+ * Delta patch tests (no network)
+ * ============================================================================ */
+
+#define DELTA_TEST_CAPACITY 256
+
+// In-memory target sink recording what the delta sink hands it
+typedef struct {
+    uint8_t data[DELTA_TEST_CAPACITY];
+    size_t size;
+    size_t image_size;
+    int opens;
+    int finishes;
+    int aborts;
+} memory_target_t;
+
+static bool memory_target_open(linx_ota_sink_t *sink, size_t image_size) {
+    memory_target_t *target = (memory_target_t *)sink->impl_data;
+    target->size = 0;
+    target->image_size = image_size;
+    target->opens++;
+    return true;
+}
+
+static bool memory_target_write(linx_ota_sink_t *sink, const uint8_t *data, size_t len) {
+    memory_target_t *target = (memory_target_t *)sink->impl_data;
+    if (target->size + len > sizeof(target->data)) {
+        return false;
+    }
+    memcpy(target->data + target->size, data, len);
+    target->size += len;
+    return true;
+}
+
+static bool memory_target_finish(linx_ota_sink_t *sink) {
+    ((memory_target_t *)sink->impl_data)->finishes++;
+    return true;
+}
+
+static void memory_target_abort(linx_ota_sink_t *sink) {
+    ((memory_target_t *)sink->impl_data)->aborts++;
+}
+
+static const linx_ota_sink_vtable_t s_memory_target_vtable = {
+    .open = memory_target_open,
+    .write = memory_target_write,
+    .finish = memory_target_finish,
+    .abort = memory_target_abort,
+};
+
+static const uint8_t s_delta_base[16] = "0123456789abcdef";
+
+static bool memory_base_read(void *user_data, size_t offset, uint8_t *buf, size_t len) {
+    (void)user_data;
+    if (offset > sizeof(s_delta_base) || len > sizeof(s_delta_base) - offset) {
+        return false;
+    }
+    memcpy(buf, s_delta_base + offset, len);
+    return true;
+}
+
+// Patch under construction
+typedef struct {
+    uint8_t data[DELTA_TEST_CAPACITY];
+    size_t size;
+} patch_t;
+
+static void patch_bytes(patch_t *patch, const void *data, size_t len) {
+    memcpy(patch->data + patch->size, data, len);
+    patch->size += len;
+}
+
+// bsdiff integer: little-endian magnitude, sign in bit 63
+static void patch_int(patch_t *patch, int64_t value) {
+    uint64_t raw = value < 0 ? ((uint64_t)0 - (uint64_t)value) | (1ULL << 63) : (uint64_t)value;
+    for (int i = 0; i < 8; i++) {
+        patch->data[patch->size++] = (uint8_t)(raw >> (8 * i));
+    }
+}
+
+static void patch_header(patch_t *patch, int64_t new_size) {
+    patch->size = 0;
+    patch_bytes(patch, "LINXDIFF/BSDIFF1", 16);
+    patch_int(patch, new_size);
+}
+
+static void patch_control(patch_t *patch, int64_t diff_len, int64_t extra_len, int64_t seek) {
+    patch_int(patch, diff_len);
+    patch_int(patch, extra_len);
+    patch_int(patch, seek);
+}
+
+/*
+ * A 24-byte image from the 16-byte base in three triples:
+ *   diff 6 at base 0, extra "XY", seek -10  -> base cursor -4
+ *   diff 8 at base -4 (first 4 bytes outside the base read as 0), extra "Z", seek 10 -> cursor 14
+ *   diff 4 at base 14 (last 2 bytes past the end), extra 3
+ */
+static const uint8_t s_diff1[6] = {0, 1, 0, 0, 2, 0};
+static const uint8_t s_diff2[8] = {'a', 'b', 'c', 'd', 0, 0, 0, 1};
+static const uint8_t s_diff3[4] = {0, 0, 'q', 'r'};
+
+static void build_known_patch(patch_t *patch) {
+    patch_header(patch, 24);
+    patch_control(patch, 6, 2, -10);
+    patch_bytes(patch, s_diff1, sizeof(s_diff1));
+    patch_bytes(patch, "XY", 2);
+    patch_control(patch, 8, 1, 10);
+    patch_bytes(patch, s_diff2, sizeof(s_diff2));
+    patch_bytes(patch, "Z", 1);
+    patch_control(patch, 4, 3, 0);
+    patch_bytes(patch, s_diff3, sizeof(s_diff3));
+    patch_bytes(patch, "end", 3);
+}
+
+static const uint8_t s_known_image[24] = {
+    '0', '2', '2', '3', '6', '5', 'X', 'Y',
+    'a', 'b', 'c', 'd', '0', '1', '2', '4', 'Z',
+    'e', 'f', 'q', 'r', 'e', 'n', 'd',
+};
+
+static void sha256_hex(const uint8_t *data, size_t len, char hex[65]) {
+    uint8_t digest[LINX_SHA256_DIGEST_SIZE];
+    linx_sha256_ctx_t ctx;
+    linx_sha256_init(&ctx);
+    linx_sha256_update(&ctx, data, len);
+    linx_sha256_final(&ctx, digest);
+    for (int i = 0; i < LINX_SHA256_DIGEST_SIZE; i++) {
+        snprintf(hex + 2 * i, 3, "%02x", digest[i]);
+    }
+}
+
+// Feed the patch in chunks of `chunk` bytes (0 = all at once); returns false when a write fails
+static bool delta_feed(linx_ota_sink_t *sink, const patch_t *patch, size_t chunk) {
+    if (!sink->vtable->open(sink, patch->size)) {
+        return false;
+    }
+    size_t offset = 0;
+    while (offset < patch->size) {
+        size_t n = chunk == 0 || chunk > patch->size - offset ? patch->size - offset : chunk;
+        if (!sink->vtable->write(sink, patch->data + offset, n)) {
+            return false;
+        }
+        offset += n;
+    }
+    return true;
+}
+
+static linx_ota_sink_t *delta_sink_for(memory_target_t *target, linx_ota_sink_t *target_sink,
+                                       const char *sha256) {
+    memset(target, 0, sizeof(*target));
+    target_sink->vtable = &s_memory_target_vtable;
+    target_sink->impl_data = target;
+    linx_ota_delta_base_t base = {
+        .read = memory_base_read,
+        .size = sizeof(s_delta_base),
+        .user_data = NULL,
+    };
+    return linx_ota_delta_sink_create(target_sink, &base, sha256);
+}
+
+static void test_delta_known_patch(void) {
+    printf("Delta: known patch\n");
+    patch_t patch;
+    build_known_patch(&patch);
+    char hex[65];
+    sha256_hex(s_known_image, sizeof(s_known_image), hex);
+
+    memory_target_t target;
+    linx_ota_sink_t target_sink;
+    linx_ota_sink_t *sink = delta_sink_for(&target, &target_sink, hex);
+    CHECK(sink != NULL, "delta sink created");
+    if (!sink) {
+        return;
+    }
+    CHECK(delta_feed(sink, &patch, 0), "patch accepted");
+    CHECK(sink->vtable->finish(sink), "finish succeeds with matching sha256");
+    CHECK(target.image_size == sizeof(s_known_image), "target opened with the new image size");
+    CHECK(target.size == sizeof(s_known_image) && memcmp(target.data, s_known_image, target.size) == 0,
+          "new image matches, including the base read before offset 0 and past the end");
+    CHECK(target.finishes == 1, "target finished once");
+    linx_ota_sink_destroy(sink);
+}
+
+static void test_delta_chunked(void) {
+    printf("Delta: patch split at arbitrary byte boundaries\n");
+    patch_t patch;
+    build_known_patch(&patch);
+    static const size_t chunks[] = {1, 2, 3, 5, 7, 11, 23, 24, 25, 64};
+
+    bool all_ok = true;
+    for (size_t i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++) {
+        memory_target_t target;
+        linx_ota_sink_t target_sink;
+        linx_ota_sink_t *sink = delta_sink_for(&target, &target_sink, NULL);
+        bool ok = sink && delta_feed(sink, &patch, chunks[i]) && sink->vtable->finish(sink) &&
+                  target.size == sizeof(s_known_image) &&
+                  memcmp(target.data, s_known_image, target.size) == 0;
+        if (!ok) {
+            printf("    chunk size %zu produced a different image\n", chunks[i]);
+            all_ok = false;
+        }
+        linx_ota_sink_destroy(sink);
+    }
+    CHECK(all_ok, "every chunking yields the same image");
+}
+
+// Header for a 8-byte image followed by one control triple; the write must be rejected
+static bool delta_control_rejected(int64_t diff_len, int64_t extra_len, int64_t seek) {
+    patch_t patch;
+    patch_header(&patch, 8);
+    patch_control(&patch, diff_len, extra_len, seek);
+
+    memory_target_t target;
+    linx_ota_sink_t target_sink;
+    linx_ota_sink_t *sink = delta_sink_for(&target, &target_sink, NULL);
+    bool rejected = sink && !delta_feed(sink, &patch, 0) && !sink->vtable->finish(sink) &&
+                    target.finishes == 0;
+    linx_ota_sink_destroy(sink);
+    return rejected;
+}
+
+static void test_delta_corrupt_control(void) {
+    printf("Delta: corrupt control blocks\n");
+    CHECK(delta_control_rejected(-1, 0, 0), "negative diff length rejected");
+    CHECK(delta_control_rejected(0, -1, 0), "negative extra length rejected");
+    CHECK(delta_control_rejected(9, 0, 0), "diff length past new_size rejected");
+    CHECK(delta_control_rejected(4, 5, 0), "diff + extra past new_size rejected");
+    CHECK(delta_control_rejected(INT64_MAX, INT64_MAX, 0), "huge lengths rejected");
+    CHECK(delta_control_rejected(4, 4, INT64_MAX), "seek overflowing the base cursor rejected");
+
+    // A cursor pushed far out by a first triple must not overflow on the next one
+    patch_t patch;
+    patch_header(&patch, 8);
+    patch_control(&patch, 0, 4, INT64_MAX);
+    patch_bytes(&patch, "abcd", 4);
+    patch_control(&patch, 4, 0, 0);
+
+    memory_target_t target;
+    linx_ota_sink_t target_sink;
+    linx_ota_sink_t *sink = delta_sink_for(&target, &target_sink, NULL);
+    CHECK(sink && !delta_feed(sink, &patch, 0), "diff after a maximal seek rejected");
+    linx_ota_sink_destroy(sink);
+}
+
+static void test_delta_trailing_data(void) {
+    printf("Delta: trailing bytes after the end of the patch\n");
+    patch_t patch;
+    build_known_patch(&patch);
+    patch_bytes(&patch, "!", 1);
+
+    memory_target_t target;
+    linx_ota_sink_t target_sink;
+    linx_ota_sink_t *sink = delta_sink_for(&target, &target_sink, NULL);
+    CHECK(sink && !delta_feed(sink, &patch, 0), "trailing byte rejected");
+    CHECK(sink && !sink->vtable->finish(sink), "finish fails after trailing data");
+    CHECK(target.finishes == 0, "target not finished");
+    linx_ota_sink_destroy(sink);
+}
+
+static void test_delta_sha256_mismatch(void) {
+    printf("Delta: sha256 mismatch\n");
+    patch_t patch;
+    build_known_patch(&patch);
+    char hex[65];
+    sha256_hex((const uint8_t *)"something else", 14, hex);
+
+    memory_target_t target;
+    linx_ota_sink_t target_sink;
+    linx_ota_sink_t *sink = delta_sink_for(&target, &target_sink, hex);
+    CHECK(sink && delta_feed(sink, &patch, 0), "patch accepted");
+    CHECK(sink && !sink->vtable->finish(sink), "finish fails on sha256 mismatch");
+    CHECK(target.finishes == 0, "target finish not called");
+    linx_ota_sink_destroy(sink);
+}
+
+static int run_delta_tests(void) {
+    test_delta_known_patch();
+    test_delta_chunked();
+    test_delta_corrupt_control();
+    test_delta_trailing_data();
+    test_delta_sha256_mismatch();
+    printf("Delta tests: %s (%d failures)\n", s_failures == 0 ? "OK" : "FAILED", s_failures);
+    return s_failures;
+}
+
 int main(int argc, char *argv[]) {
     // 初始化日志系统
     log_config_t log_config = LOG_DEFAULT_CONFIG;
@@ -31,6 +331,14 @@ int main(int argc, char *argv[]) {
     
     printf("LinX OS SDK OTA Test\n");
     
+    // Offline tests first; "ota_test delta" runs only these
+    if (run_delta_tests() != 0) {
+        return 1;
+    }
+    if (argc > 1 && strcmp(argv[1], "delta") == 0) {
+        return 0;
+    }
+    
     // OTA configuration - matching the JavaScript fetch request
     linx_ota_config_t config = {
         .ota_server_url = "http://xrobo.qiniuapi.com/v1/ota/",
@@ -65,16 +373,16 @@ int main(int argc, char *argv[]) {
         .progress_cb = progress_callback
     };
     
-    // Initialize OTA module
-    linx_ota_status_t status = linx_ota_init(&config);
-    if (status != LINX_OTA_SUCCESS) {
-        printf("Failed to initialize OTA module: %s\n", linx_ota_status_str(status));
+    // Create OTA instance
+    linx_ota_t *ota = linx_ota_create(&config);
+    if (!ota) {
+        printf("Failed to create OTA instance\n");
         return -1;
     }
     
     // Check for updates
     linx_ota_info_t info;
-    status = linx_ota_check_update(&info);
+    linx_ota_status_t status = linx_ota_check_update(ota, &info);
     
     if (status == LINX_OTA_SUCCESS) {
         printf("[OTA] Update available\n");
@@ -85,13 +393,13 @@ int main(int argc, char *argv[]) {
         
         // // Download firmware
         // const char *download_path = "/tmp/linx_firmware.bin";
-        // status = linx_ota_download(&info, download_path);
+        // status = linx_ota_download(ota, &info, download_path);
         
         // if (status == LINX_OTA_SUCCESS) {
         //     printf("Firmware downloaded successfully\n");
             
         //     // Apply update
-        //     status = linx_ota_apply(download_path);
+        //     status = linx_ota_apply(ota, download_path);
         //     if (status == LINX_OTA_SUCCESS) {
         //         printf("Firmware update applied successfully\n");
         //     } else {
@@ -107,7 +415,7 @@ int main(int argc, char *argv[]) {
     }
     
     // Cleanup
-    linx_ota_cleanup();
+    linx_ota_destroy(ota);
     
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,380 @@
+#include "linx_jitter_buffer.h"
+#include "../log/linx_alloc.h"
+#include <stdlib.h>
+#include <string.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_PLAY);
+
+/* 时间戳回退超过该值视为新的音频流（例如服务器为新一句 TTS 重置了时间戳） */
+#define LINX_JITTER_RESYNC_MS 1000
+
+/* 最少槽位数 */
+#define LINX_JITTER_MIN_SLOTS 8
+
+typedef struct {
+    uint32_t timestamp;                             // 包时间戳（毫秒）
+    size_t size;                                    // 包长度
+    uint8_t* heap;                                  // 超长包的单独分配，否则为 NULL
+    uint8_t data[LINX_JITTER_BUFFER_SLOT_BYTES];    // 内联数据
+} linx_jitter_slot_t;
+
+struct linx_jitter_buffer {
+    linx_jitter_buffer_config_t config;
+
+    linx_jitter_slot_t* slots;      // 槽位数组
+    size_t capacity;                // 槽位数
+    size_t* free_list;              // 空闲槽位索引栈
+    size_t free_count;
+    size_t* order;                  // 按时间戳排序的已用槽位索引
+    size_t count;
+
+    bool playing;                   // 已完成预缓冲，正在出队
+    bool has_played;                // last_played_ts 是否有效
+    uint32_t last_played_ts;        // 最近一次出队的时间戳
+    bool has_last_in;               // last_in_ts 是否有效
+    uint32_t last_in_ts;            // 已入队的最大时间戳
+    uint64_t last_arrival_ms;       // 最近一次入队的时间
+
+    bool has_transit;               // last_transit 是否有效
+    int64_t last_transit;           // 上一个包的 到达时间 - 时间戳
+    float jitter_ms;                // RFC 3550 抖动估计
+    int target_depth_ms;            // 当前生效的目标深度
+    int adaptive_target_ms;         // 根据抖动计算的目标深度，下一次预缓冲时生效
+
+    linx_jitter_buffer_stats_t stats;
+};
+
+static int32_t ts_diff(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b);
+}
+
+static void slot_release(linx_jitter_buffer_t* jb, size_t index) {
+    linx_jitter_slot_t* slot = &jb->slots[index];
+    LINX_FREE(slot->heap);
+    slot->heap = NULL;
+    slot->size = 0;
+    jb->free_list[jb->free_count++] = index;
+}
+
+static void reset_timeline(linx_jitter_buffer_t* jb) {
+    jb->has_played = false;
+    jb->has_last_in = false;
+    jb->has_transit = false;
+}
+
+static void update_jitter(linx_jitter_buffer_t* jb, uint32_t timestamp, uint64_t now_ms) {
+    int64_t transit = (int64_t)now_ms - (int64_t)timestamp;
+    if (jb->has_transit) {
+        int64_t d = transit - jb->last_transit;
+        if (d < 0) {
+            d = -d;
+        }
+        jb->jitter_ms += ((float)d - jb->jitter_ms) / 16.0f;
+    }
+    jb->last_transit = transit;
+    jb->has_transit = true;
+
+    if (!jb->config.adaptive) {
+        return;
+    }
+
+    int frame = jb->config.frame_duration_ms;
+    int target = frame + (int)(3.0f * jb->jitter_ms + 0.5f);
+    target = ((target + frame - 1) / frame) * frame;
+    if (target < jb->config.min_depth_ms) {
+        target = jb->config.min_depth_ms;
+    }
+    if (target > jb->config.max_depth_ms) {
+        target = jb->config.max_depth_ms;
+    }
+    jb->adaptive_target_ms = target;
+}
+
+linx_jitter_buffer_t* linx_jitter_buffer_create(const linx_jitter_buffer_config_t* config) {
+    linx_jitter_buffer_t* jb = (linx_jitter_buffer_t*)LINX_CALLOC(1, sizeof(linx_jitter_buffer_t));
+    if (!jb) {
+        return NULL;
+    }
+
+    if (config) {
+        jb->config = *config;
+    }
+    if (jb->config.frame_duration_ms <= 0) {
+        jb->config.frame_duration_ms = LINX_JITTER_BUFFER_DEFAULT_FRAME_MS;
+    }
+    if (jb->config.min_depth_ms <= 0) {
+        jb->config.min_depth_ms = LINX_JITTER_BUFFER_DEFAULT_MIN_MS;
+    }
+    if (jb->config.max_depth_ms <= 0) {
+        jb->config.max_depth_ms = LINX_JITTER_BUFFER_DEFAULT_MAX_MS;
+    }
+    if (jb->config.max_depth_ms < jb->config.min_depth_ms) {
+        jb->config.max_depth_ms = jb->config.min_depth_ms;
+    }
+    if (jb->config.target_depth_ms <= 0) {
+        jb->config.target_depth_ms = LINX_JITTER_BUFFER_DEFAULT_TARGET_MS;
+    }
+    if (jb->config.target_depth_ms < jb->config.min_depth_ms) {
+        jb->config.target_depth_ms = jb->config.min_depth_ms;
+    }
+    if (jb->config.target_depth_ms > jb->config.max_depth_ms) {
+        jb->config.target_depth_ms = jb->config.max_depth_ms;
+    }
+
+    /* 容量为最大深度的两倍，容纳服务器快于实时的突发发送 */
+    size_t capacity = (size_t)(jb->config.max_depth_ms * 2 / jb->config.frame_duration_ms) + 2;
+    if (capacity < LINX_JITTER_MIN_SLOTS) {
+        capacity = LINX_JITTER_MIN_SLOTS;
+    }
+
+    /* 槽位数组是大块包存储，放外部内存；空闲表和顺序表很小，留在片内 */
+    jb->slots = (linx_jitter_slot_t*)LINX_CALLOC_BULK(capacity, sizeof(linx_jitter_slot_t));
+    jb->free_list = (size_t*)LINX_MALLOC(capacity * sizeof(size_t));
+    jb->order = (size_t*)LINX_MALLOC(capacity * sizeof(size_t));
+    if (!jb->slots || !jb->free_list || !jb->order) {
+        linx_jitter_buffer_destroy(jb);
+        return NULL;
+    }
+
+    jb->capacity = capacity;
+    for (size_t i = 0; i < capacity; i++) {
+        jb->free_list[i] = capacity - 1 - i;
+    }
+    jb->free_count = capacity;
+
+    jb->target_depth_ms = jb->config.target_depth_ms;
+    jb->adaptive_target_ms = jb->config.target_depth_ms;
+    return jb;
+}
+
+void linx_jitter_buffer_destroy(linx_jitter_buffer_t* jb) {
+    if (!jb) {
+        return;
+    }
+
+    if (jb->slots) {
+        for (size_t i = 0; i < jb->capacity; i++) {
+            LINX_FREE(jb->slots[i].heap);
+        }
+    }
+    LINX_FREE(jb->slots);
+    LINX_FREE(jb->free_list);
+    LINX_FREE(jb->order);
+    LINX_FREE(jb);
+}
+
+linx_jitter_result_t linx_jitter_buffer_push(linx_jitter_buffer_t* jb, const uint8_t* data, size_t size,
+                                             uint32_t timestamp, bool has_timestamp, uint64_t now_ms) {
+    if (!jb || !data || size == 0) {
+        return LINX_JITTER_INVALID;
+    }
+
+    int frame = jb->config.frame_duration_ms;
+
+    /* 空闲较久后到来的包属于新的音频流 */
+    if (jb->count == 0 && !jb->playing && jb->has_last_in &&
+        now_ms - jb->last_arrival_ms > (uint64_t)jb->config.max_depth_ms + LINX_JITTER_RESYNC_MS) {
+        reset_timeline(jb);
+    }
+
+    if (!has_timestamp) {
+        /* 无时间戳：按到达顺序排在最后 */
+        if (jb->has_last_in) {
+            timestamp = jb->last_in_ts + (uint32_t)frame;
+        } else if (jb->has_played) {
+            timestamp = jb->last_played_ts + (uint32_t)frame;
+        } else {
+            timestamp = 0;
+        }
+    } else if (jb->has_played && ts_diff(timestamp, jb->last_played_ts) < -LINX_JITTER_RESYNC_MS) {
+        /* 时间戳大幅回退：服务器开始了新的音频流 */
+        reset_timeline(jb);
+    }
+
+    if (jb->has_played && ts_diff(timestamp, jb->last_played_ts) <= 0) {
+        jb->stats.late_packets++;
+        return LINX_JITTER_LATE;
+    }
+
+    /* 从尾部向前找插入位置，同时检查重复 */
+    size_t pos = jb->count;
+    while (pos > 0) {
+        int32_t d = ts_diff(timestamp, jb->slots[jb->order[pos - 1]].timestamp);
+        if (d == 0) {
+            jb->stats.duplicate_packets++;
+            return LINX_JITTER_DUPLICATE;
+        }
+        if (d > 0) {
+            break;
+        }
+        pos--;
+    }
+
+    if (jb->free_count == 0) {
+        jb->stats.overflows++;
+        return LINX_JITTER_FULL;
+    }
+
+    size_t index = jb->free_list[jb->free_count - 1];
+    linx_jitter_slot_t* slot = &jb->slots[index];
+    if (size > sizeof(slot->data)) {
+        slot->heap = (uint8_t*)LINX_MALLOC_BULK(size);
+        if (!slot->heap) {
+            jb->stats.overflows++;
+            return LINX_JITTER_FULL;
+        }
+        memcpy(slot->heap, data, size);
+    } else {
+        memcpy(slot->data, data, size);
+    }
+    jb->free_count--;
+    slot->size = size;
+    slot->timestamp = timestamp;
+
+    memmove(&jb->order[pos + 1], &jb->order[pos], (jb->count - pos) * sizeof(size_t));
+    jb->order[pos] = index;
+    jb->count++;
+
+    if (has_timestamp) {
+        update_jitter(jb, timestamp, now_ms);
+    }
+    if (!jb->has_last_in || ts_diff(timestamp, jb->last_in_ts) > 0) {
+        jb->last_in_ts = timestamp;
+        jb->has_last_in = true;
+    }
+    jb->last_arrival_ms = now_ms;
+    jb->stats.packets_in++;
+    return LINX_JITTER_OK;
+}
+
+linx_jitter_result_t linx_jitter_buffer_pop(linx_jitter_buffer_t* jb, uint8_t* buffer, size_t buffer_size,
+                                            size_t* size, uint32_t* timestamp, uint64_t now_ms) {
+    if (!jb || !buffer || !size) {
+        return LINX_JITTER_INVALID;
+    }
+
+    if (jb->count == 0) {
+        if (jb->playing) {
+            jb->playing = false;
+            jb->stats.underruns++;
+        }
+        return LINX_JITTER_EMPTY;
+    }
+
+    if (!jb->playing) {
+        if (jb->config.adaptive) {
+            jb->target_depth_ms = jb->adaptive_target_ms;
+        }
+        /* 达到目标深度，或一段时间没有新包（一段音频已经发完），开始出队 */
+        bool deep_enough = linx_jitter_buffer_depth_ms(jb) >= jb->target_depth_ms;
+        bool drained = now_ms - jb->last_arrival_ms >= (uint64_t)jb->target_depth_ms;
+        if (!deep_enough && !drained) {
+            return LINX_JITTER_BUFFERING;
+        }
+        jb->playing = true;
+    }
+
+    size_t index = jb->order[0];
+    linx_jitter_slot_t* slot = &jb->slots[index];
+    memmove(&jb->order[0], &jb->order[1], (jb->count - 1) * sizeof(size_t));
+    jb->count--;
+
+    jb->last_played_ts = slot->timestamp;
+    jb->has_played = true;
+    *size = slot->size;
+    if (timestamp) {
+        *timestamp = slot->timestamp;
+    }
+
+    linx_jitter_result_t result = LINX_JITTER_OK;
+    if (slot->size > buffer_size) {
+        result = LINX_JITTER_INVALID;
+    } else {
+        memcpy(buffer, slot->heap ? slot->heap : slot->data, slot->size);
+        jb->stats.packets_out++;
+    }
+
+    slot_release(jb, index);
+    return result;
+}
+
+int linx_jitter_buffer_wait_hint_ms(const linx_jitter_buffer_t* jb, uint64_t now_ms) {
+    if (!jb || jb->count == 0) {
+        return -1;
+    }
+    if (jb->playing) {
+        return 0;
+    }
+
+    int target = jb->config.adaptive ? jb->adaptive_target_ms : jb->target_depth_ms;
+    if (linx_jitter_buffer_depth_ms(jb) >= target) {
+        return 0;
+    }
+    uint64_t idle = now_ms - jb->last_arrival_ms;
+    return idle >= (uint64_t)target ? 0 : (int)((uint64_t)target - idle);
+}
+
+bool linx_jitter_buffer_resume(linx_jitter_buffer_t* jb) {
+    if (!jb || jb->count == 0) {
+        return false;
+    }
+    jb->playing = true;
+    return true;
+}
+
+bool linx_jitter_buffer_head_in_order(const linx_jitter_buffer_t* jb) {
+    if (!jb || jb->count == 0) {
+        return false;
+    }
+    if (!jb->has_played || jb->config.frame_duration_ms <= 0) {
+        return true;
+    }
+    /* 队首与上次出队的时间戳相差不超过一帧即为连续；无时间戳的包在入队时已按
+     * 上一个包的时间戳加一帧补齐，同样适用 */
+    return ts_diff(jb->slots[jb->order[0]].timestamp, jb->last_played_ts) <= jb->config.frame_duration_ms;
+}
+
+void linx_jitter_buffer_clear(linx_jitter_buffer_t* jb) {
+    if (!jb) {
+        return;
+    }
+
+    while (jb->count > 0) {
+        slot_release(jb, jb->order[--jb->count]);
+    }
+    jb->playing = false;
+    reset_timeline(jb);
+}
+
+size_t linx_jitter_buffer_count(const linx_jitter_buffer_t* jb) {
+    return jb ? jb->count : 0;
+}
+
+size_t linx_jitter_buffer_capacity(const linx_jitter_buffer_t* jb) {
+    return jb ? jb->capacity : 0;
+}
+
+int linx_jitter_buffer_depth_ms(const linx_jitter_buffer_t* jb) {
+    return jb ? (int)jb->count * jb->config.frame_duration_ms : 0;
+}
+
+int linx_jitter_buffer_max_depth_ms(const linx_jitter_buffer_t* jb) {
+    return jb ? jb->config.max_depth_ms : 0;
+}
+
+int linx_jitter_buffer_capacity_ms(const linx_jitter_buffer_t* jb) {
+    return jb ? (int)jb->capacity * jb->config.frame_duration_ms : 0;
+}
+
+bool linx_jitter_buffer_get_stats(const linx_jitter_buffer_t* jb, linx_jitter_buffer_stats_t* stats) {
+    if (!jb || !stats) {
+        return false;
+    }
+
+    *stats = jb->stats;
+    stats->packet_count = jb->count;
+    stats->depth_ms = linx_jitter_buffer_depth_ms(jb);
+    stats->target_depth_ms = jb->config.adaptive ? jb->adaptive_target_ms : jb->target_depth_ms;
+    stats->jitter_ms = jb->jitter_ms;
+    return true;
+}
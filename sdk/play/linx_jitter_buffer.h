@@ -0,0 +1,162 @@
+#ifndef LINX_JITTER_BUFFER_H
+#define LINX_JITTER_BUFFER_H
+
+/*
+ * 按包组织的抖动缓冲区
+ *
+ * 每个 Opus 包单独存放并保留长度与时间戳，按时间戳排序出队，
+ * 迟到包与重复包直接丢弃。缓冲区先预缓冲到目标深度再开始出队，
+ * 出现欠载后重新预缓冲；若一段时间没有新包到达（一句 TTS 结束），
+ * 剩余包会直接播放完而不必等满目标深度。
+ *
+ * 自适应模式下，按 RFC 3550 的方法由包到达时间与时间戳估算抖动，
+ * 目标深度 = 帧长 + 3 × 抖动，限制在 [min_depth_ms, max_depth_ms] 内，
+ * 在下一次预缓冲时生效。
+ *
+ * 非线程安全，由调用者加锁。
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 单个槽位内联存放的最大包长，超过时单独分配 */
+#define LINX_JITTER_BUFFER_SLOT_BYTES 512
+
+/* 默认参数 */
+#define LINX_JITTER_BUFFER_DEFAULT_FRAME_MS     60
+#define LINX_JITTER_BUFFER_DEFAULT_TARGET_MS    120
+#define LINX_JITTER_BUFFER_DEFAULT_MIN_MS       60
+#define LINX_JITTER_BUFFER_DEFAULT_MAX_MS       480
+
+/* 抖动缓冲区 - 前向声明（隐藏实现细节） */
+typedef struct linx_jitter_buffer linx_jitter_buffer_t;
+
+/* 操作结果 */
+typedef enum {
+    LINX_JITTER_OK = 0,             // 成功
+    LINX_JITTER_EMPTY,              // 缓冲区为空
+    LINX_JITTER_BUFFERING,          // 正在预缓冲，尚未达到目标深度
+    LINX_JITTER_FULL,               // 缓冲区已满
+    LINX_JITTER_LATE,               // 包已迟到（早于已播放的位置），被丢弃
+    LINX_JITTER_DUPLICATE,          // 重复包，被丢弃
+    LINX_JITTER_INVALID             // 参数错误
+} linx_jitter_result_t;
+
+/* 配置（字段为 0 时使用默认值） */
+typedef struct {
+    int frame_duration_ms;          // 每包时长（毫秒）
+    int target_depth_ms;            // 目标深度（非自适应时固定使用，自适应时作为初始值）
+    int min_depth_ms;               // 自适应下限
+    int max_depth_ms;               // 自适应上限（同时决定缓冲区容量）
+    bool adaptive;                  // 是否根据到达抖动自动调整目标深度
+} linx_jitter_buffer_config_t;
+
+/* 统计信息 */
+typedef struct {
+    size_t packets_in;              // 入队包数
+    size_t packets_out;             // 出队包数
+    size_t late_packets;            // 迟到丢弃数
+    size_t duplicate_packets;       // 重复丢弃数
+    size_t overflows;               // 缓冲区满拒绝数
+    size_t underruns;               // 欠载次数
+    size_t packet_count;            // 当前包数
+    int depth_ms;                   // 当前深度（毫秒）
+    int target_depth_ms;            // 当前目标深度（毫秒）
+    float jitter_ms;                // 估算的到达抖动（毫秒）
+} linx_jitter_buffer_stats_t;
+
+/**
+ * 创建抖动缓冲区
+ * @param config 配置，为 NULL 时全部使用默认值
+ * @return 缓冲区实例，失败返回 NULL
+ */
+linx_jitter_buffer_t* linx_jitter_buffer_create(const linx_jitter_buffer_config_t* config);
+
+/**
+ * 销毁抖动缓冲区
+ * @param jb 缓冲区实例
+ */
+void linx_jitter_buffer_destroy(linx_jitter_buffer_t* jb);
+
+/**
+ * 放入一个编码包
+ * @param jb 缓冲区实例
+ * @param data 包数据
+ * @param size 包长度
+ * @param timestamp 包时间戳（毫秒）
+ * @param has_timestamp 时间戳是否有效；无效时按到达顺序排在最后
+ * @param now_ms 当前单调时间（毫秒）
+ * @return LINX_JITTER_OK 或丢弃原因
+ */
+linx_jitter_result_t linx_jitter_buffer_push(linx_jitter_buffer_t* jb, const uint8_t* data, size_t size,
+                                             uint32_t timestamp, bool has_timestamp, uint64_t now_ms);
+
+/**
+ * 取出下一个应播放的包
+ * @param jb 缓冲区实例
+ * @param buffer 输出缓冲区
+ * @param buffer_size 输出缓冲区大小
+ * @param size 包长度（输出参数）
+ * @param timestamp 包时间戳（输出参数，可为 NULL）
+ * @param now_ms 当前单调时间（毫秒）
+ * @return LINX_JITTER_OK、LINX_JITTER_EMPTY 或 LINX_JITTER_BUFFERING
+ */
+linx_jitter_result_t linx_jitter_buffer_pop(linx_jitter_buffer_t* jb, uint8_t* buffer, size_t buffer_size,
+                                            size_t* size, uint32_t* timestamp, uint64_t now_ms);
+
+/**
+ * 距离下一次可能出队还需等待的时间（用于带超时的条件等待）
+ * @param jb 缓冲区实例
+ * @param now_ms 当前单调时间（毫秒）
+ * @return 毫秒数；缓冲区为空时返回 -1（需等待新包）
+ */
+int linx_jitter_buffer_wait_hint_ms(const linx_jitter_buffer_t* jb, uint64_t now_ms);
+
+/**
+ * 有包时立即恢复出队，不再等待预缓冲达到目标深度
+ * 用于一段连续音频中途欠载后（例如句子之间），播放方已经用补齐音频衔接了空档
+ * @param jb 缓冲区实例
+ * @return 缓冲区中有包可以出队时返回 true
+ */
+bool linx_jitter_buffer_resume(linx_jitter_buffer_t* jb);
+
+/**
+ * 队首的包是否紧接上一次出队的包，即前面没有缺失、可能迟到的包
+ * 播放方提前出队（解码超前）时用来决定是否还要等一等迟到的包
+ * @param jb 缓冲区实例
+ * @return 缓冲区为空时返回 false；还没有出队过或帧时长未知时返回 true
+ */
+bool linx_jitter_buffer_head_in_order(const linx_jitter_buffer_t* jb);
+
+/**
+ * 清空缓冲区（保留抖动估计）
+ * @param jb 缓冲区实例
+ */
+void linx_jitter_buffer_clear(linx_jitter_buffer_t* jb);
+
+/* 状态查询 */
+size_t linx_jitter_buffer_count(const linx_jitter_buffer_t* jb);
+size_t linx_jitter_buffer_capacity(const linx_jitter_buffer_t* jb);
+int linx_jitter_buffer_depth_ms(const linx_jitter_buffer_t* jb);
+int linx_jitter_buffer_max_depth_ms(const linx_jitter_buffer_t* jb);
+/* 缓冲区满（push 返回 LINX_JITTER_FULL）前最多能容纳的音频时长（毫秒） */
+int linx_jitter_buffer_capacity_ms(const linx_jitter_buffer_t* jb);
+
+/**
+ * 获取统计信息
+ * @param jb 缓冲区实例
+ * @param stats 统计信息（输出参数）
+ * @return 成功返回 true
+ */
+bool linx_jitter_buffer_get_stats(const linx_jitter_buffer_t* jb, linx_jitter_buffer_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINX_JITTER_BUFFER_H */
@@ -0,0 +1,306 @@
+#include "linx_mixer.h"
+#include "linx_packet_queue.h"
+#include "../codecs/audio_codec.h"
+#include "../audio/audio_dsp.h"
+#include "../os/linx_os.h"
+#include "../log/linx_alloc.h"
+#include <math.h>
+#include <string.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_PLAY);
+
+#define LINX_MIXER_DEFAULT_DUCK_DB 12
+#define LINX_MIXER_DEFAULT_RAMP_MS 50
+#define LINX_MIXER_DEFAULT_HOLD_MS 300
+#define LINX_MIXER_DEFAULT_PACKETS 64
+#define LINX_MIXER_MAX_PACKET_MS 120    // Opus 单包最长 120ms
+
+struct linx_mixer_stream {
+    bool used;
+    audio_codec_t* decoder;
+    int priority;
+    float gain;                     // 应用设置的增益
+    float current;                  // 当前实际增益（含压低），只由解码方修改
+    bool was_playing;               // 上一段有音频，否则从目标增益直接开始
+    linx_packet_queue_t* queue;
+    int16_t* pcm;                   // 已解码未混出的 PCM
+    size_t offset;
+    size_t length;
+};
+
+struct linx_mixer {
+    int sample_rate;
+    int channels;
+    float duck_gain;                // 被压低时的线性增益
+    float ramp_step;                // 每个样本的最大增益变化
+    size_t hold_samples;
+    size_t max_packet_samples;
+    linx_mutex_t* mutex;            // 保护流的打开、关闭、增益和混音
+    linx_mixer_stream_t streams[LINX_MIXER_MAX_STREAMS];
+    float main_current;             // 主流当前增益
+    size_t main_hold;               // 主流停下后仍按播放中处理的剩余样本数
+    size_t top_hold[LINX_MIXER_MAX_STREAMS]; // 各流停下后的保持样本数
+};
+
+linx_mixer_t* linx_mixer_create(const linx_mixer_config_t* config) {
+    if (!config || config->sample_rate <= 0 || config->channels <= 0) {
+        return NULL;
+    }
+
+    linx_mixer_t* mixer = (linx_mixer_t*)LINX_CALLOC(1, sizeof(linx_mixer_t));
+    if (!mixer) {
+        return NULL;
+    }
+    mixer->mutex = linx_mutex_create();
+    if (!mixer->mutex) {
+        LINX_FREE(mixer);
+        return NULL;
+    }
+
+    int duck_db = config->duck_db == 0 ? LINX_MIXER_DEFAULT_DUCK_DB : config->duck_db;
+    int ramp_ms = config->duck_ramp_ms > 0 ? config->duck_ramp_ms : LINX_MIXER_DEFAULT_RAMP_MS;
+    int hold_ms = config->duck_hold_ms > 0 ? config->duck_hold_ms : LINX_MIXER_DEFAULT_HOLD_MS;
+    size_t samples_per_ms = (size_t)config->sample_rate * (size_t)config->channels / 1000;
+
+    mixer->sample_rate = config->sample_rate;
+    mixer->channels = config->channels;
+    mixer->duck_gain = duck_db < 0 ? 1.0f : powf(10.0f, -(float)duck_db / 20.0f);
+    mixer->ramp_step = 1.0f / (float)(samples_per_ms * (size_t)ramp_ms + 1);
+    mixer->hold_samples = samples_per_ms * (size_t)hold_ms;
+    mixer->max_packet_samples = samples_per_ms * LINX_MIXER_MAX_PACKET_MS;
+    mixer->main_current = 1.0f;
+    return mixer;
+}
+
+static void linx_mixer_release_stream(linx_mixer_stream_t* stream) {
+    linx_packet_queue_destroy(stream->queue);
+    LINX_FREE(stream->pcm);
+    memset(stream, 0, sizeof(*stream));
+}
+
+void linx_mixer_destroy(linx_mixer_t* mixer) {
+    if (!mixer) {
+        return;
+    }
+    for (int i = 0; i < LINX_MIXER_MAX_STREAMS; i++) {
+        if (mixer->streams[i].used) {
+            linx_mixer_release_stream(&mixer->streams[i]);
+        }
+    }
+    linx_mutex_destroy(mixer->mutex);
+    LINX_FREE(mixer);
+}
+
+linx_mixer_stream_t* linx_mixer_open(linx_mixer_t* mixer, const linx_mixer_stream_config_t* config) {
+    if (!mixer || !config || !config->decoder) {
+        return NULL;
+    }
+
+    // 队列和解码缓冲区在锁外分配，混音时不分配内存
+    linx_packet_queue_t* queue = linx_packet_queue_create(config->max_packets > 0 ? config->max_packets
+                                                                                  : LINX_MIXER_DEFAULT_PACKETS);
+    int16_t* pcm = (int16_t*)LINX_MALLOC(2 * mixer->max_packet_samples * sizeof(int16_t));
+    if (!queue || !pcm) {
+        linx_packet_queue_destroy(queue);
+        LINX_FREE(pcm);
+        return NULL;
+    }
+
+    linx_mixer_stream_t* stream = NULL;
+    linx_mutex_lock(mixer->mutex);
+    for (int i = 0; i < LINX_MIXER_MAX_STREAMS; i++) {
+        if (!mixer->streams[i].used) {
+            stream = &mixer->streams[i];
+            memset(stream, 0, sizeof(*stream));
+            stream->used = true;
+            stream->decoder = config->decoder;
+            stream->priority = config->priority;
+            stream->gain = config->gain > 0.0f ? config->gain : 1.0f;
+            stream->queue = queue;
+            stream->pcm = pcm;
+            mixer->top_hold[i] = 0;
+            break;
+        }
+    }
+    linx_mutex_unlock(mixer->mutex);
+
+    if (!stream) {
+        linx_packet_queue_destroy(queue);
+        LINX_FREE(pcm);
+    }
+    return stream;
+}
+
+void linx_mixer_close(linx_mixer_t* mixer, linx_mixer_stream_t* stream) {
+    if (!mixer || !stream) {
+        return;
+    }
+    linx_mutex_lock(mixer->mutex);
+    if (stream->used) {
+        linx_mixer_release_stream(stream);
+    }
+    linx_mutex_unlock(mixer->mutex);
+}
+
+bool linx_mixer_feed(linx_mixer_stream_t* stream, const uint8_t* data, size_t size, bool* was_empty) {
+    if (was_empty) {
+        *was_empty = false;
+    }
+    if (!stream || !stream->used || !data || size == 0) {
+        return false;
+    }
+    bool queue_empty = false;
+    bool ok = linx_packet_queue_push(stream->queue, data, size, 0, false, 0, &queue_empty) ==
+              LINX_PACKET_QUEUE_OK;
+    if (was_empty) {
+        *was_empty = ok && queue_empty && __atomic_load_n(&stream->length, __ATOMIC_RELAXED) == 0;
+    }
+    return ok;
+}
+
+void linx_mixer_stream_set_gain(linx_mixer_t* mixer, linx_mixer_stream_t* stream, float gain) {
+    if (!mixer || !stream) {
+        return;
+    }
+    linx_mutex_lock(mixer->mutex);
+    if (stream->used) {
+        stream->gain = gain > 0.0f ? gain : 0.0f;
+    }
+    linx_mutex_unlock(mixer->mutex);
+}
+
+static bool linx_mixer_stream_pending(const linx_mixer_stream_t* stream) {
+    return stream->used && (stream->length > 0 || !linx_packet_queue_is_empty(stream->queue));
+}
+
+bool linx_mixer_stream_is_playing(linx_mixer_t* mixer, linx_mixer_stream_t* stream) {
+    if (!mixer || !stream) {
+        return false;
+    }
+    linx_mutex_lock(mixer->mutex);
+    bool playing = linx_mixer_stream_pending(stream);
+    linx_mutex_unlock(mixer->mutex);
+    return playing;
+}
+
+bool linx_mixer_active(linx_mixer_t* mixer) {
+    if (!mixer) {
+        return false;
+    }
+    bool active = false;
+    linx_mutex_lock(mixer->mutex);
+    for (int i = 0; i < LINX_MIXER_MAX_STREAMS && !active; i++) {
+        active = linx_mixer_stream_pending(&mixer->streams[i]);
+    }
+    linx_mutex_unlock(mixer->mutex);
+    return active;
+}
+
+/* 解码直到流至少有 wanted 个样本或队列为空 */
+static void linx_mixer_fill(linx_mixer_t* mixer, linx_mixer_stream_t* stream, size_t wanted) {
+    while (stream->length < wanted) {
+        const linx_packet_queue_entry_t* entry = linx_packet_queue_peek(stream->queue);
+        if (!entry) {
+            break;
+        }
+        if (stream->offset > 0) {
+            memmove(stream->pcm, stream->pcm + stream->offset, stream->length * sizeof(int16_t));
+            stream->offset = 0;
+        }
+        size_t decoded = 0;
+        size_t room = 2 * mixer->max_packet_samples - stream->length;
+        if (audio_codec_decode(stream->decoder, entry->data, entry->size, stream->pcm + stream->length, room,
+                               &decoded) == CODEC_SUCCESS) {
+            __atomic_store_n(&stream->length, stream->length + decoded, __ATOMIC_RELAXED);
+        }
+        linx_packet_queue_pop(stream->queue);
+    }
+}
+
+/* 增益向目标移动，每个样本最多移动 ramp_step */
+static float linx_mixer_approach(const linx_mixer_t* mixer, float current, float target, size_t samples) {
+    float step = mixer->ramp_step * (float)samples;
+    if (target > current) {
+        return current + step < target ? current + step : target;
+    }
+    return current - step > target ? current - step : target;
+}
+
+static void linx_mixer_mix_chunk(linx_mixer_t* mixer, int16_t* pcm, size_t samples, bool main_active) {
+    // 本段中播放的最高优先级；停下的声音在保持期内仍参与压低
+    main_active = main_active || mixer->main_hold > 0;
+    int top = main_active ? LINX_MIXER_PRIORITY_VOICE : -1;
+    bool any = main_active;
+    bool playing[LINX_MIXER_MAX_STREAMS] = {false};
+    for (int i = 0; i < LINX_MIXER_MAX_STREAMS; i++) {
+        linx_mixer_stream_t* stream = &mixer->streams[i];
+        if (!stream->used) {
+            continue;
+        }
+        linx_mixer_fill(mixer, stream, samples);
+        playing[i] = stream->length > 0;
+        if (playing[i] || mixer->top_hold[i] > 0) {
+            if (!any || stream->priority > top) {
+                top = stream->priority;
+            }
+            any = true;
+        }
+    }
+
+    // 主流：有更高优先级的流时压低
+    float main_target = any && top > LINX_MIXER_PRIORITY_VOICE ? mixer->duck_gain : 1.0f;
+    float main_next = linx_mixer_approach(mixer, mixer->main_current, main_target, samples);
+    if (mixer->main_current != 1.0f || main_next != 1.0f) {
+        audio_dsp_gain_ramp(pcm, samples, mixer->main_current, main_next);
+    }
+    mixer->main_current = main_next;
+
+    for (int i = 0; i < LINX_MIXER_MAX_STREAMS; i++) {
+        linx_mixer_stream_t* stream = &mixer->streams[i];
+        if (!stream->used) {
+            continue;
+        }
+        mixer->top_hold[i] = playing[i] ? mixer->hold_samples
+                                        : (mixer->top_hold[i] > samples ? mixer->top_hold[i] - samples : 0);
+        float target = stream->gain * (top > stream->priority ? mixer->duck_gain : 1.0f);
+        bool was_playing = stream->was_playing;
+        stream->was_playing = playing[i];
+        if (!playing[i]) {
+            continue;
+        }
+        // 刚开始播放时直接使用目标增益，不从上一次的增益过渡
+        if (!was_playing) {
+            stream->current = target;
+        }
+        size_t count = stream->length < samples ? stream->length : samples;
+        int16_t* src = stream->pcm + stream->offset;
+        float next = linx_mixer_approach(mixer, stream->current, target, count);
+        if (stream->current != 1.0f || next != 1.0f) {
+            audio_dsp_gain_ramp(src, count, stream->current, next);
+        }
+        stream->current = next;
+        audio_dsp_mix(pcm, src, count);
+        stream->offset += count;
+        __atomic_store_n(&stream->length, stream->length - count, __ATOMIC_RELAXED);
+        if (stream->length == 0) {
+            stream->offset = 0;
+        }
+    }
+}
+
+void linx_mixer_mix(linx_mixer_t* mixer, int16_t* pcm, size_t samples, bool main_active) {
+    if (!mixer || !pcm) {
+        return;
+    }
+    linx_mutex_lock(mixer->mutex);
+    // 按不超过单包长度分段，保证解码缓冲区装得下
+    while (samples > 0) {
+        size_t chunk = samples < mixer->max_packet_samples ? samples : mixer->max_packet_samples;
+        linx_mixer_mix_chunk(mixer, pcm, chunk, main_active);
+        mixer->main_hold = main_active ? mixer->hold_samples
+                                       : (mixer->main_hold > chunk ? mixer->main_hold - chunk : 0);
+        pcm += chunk;
+        samples -= chunk;
+    }
+    linx_mutex_unlock(mixer->mutex);
+}
@@ -0,0 +1,120 @@
+#ifndef LINX_MIXER_H
+#define LINX_MIXER_H
+
+/*
+ * 多路播放流混音器
+ *
+ * TTS 之外的音频（MCP 工具播放的音乐/媒体、通知、闹钟）各自作为一路流：每路流有自己的
+ * 解码器和编码包队列，应用线程无锁放入编码包；解码方（播放器的解码阶段：播放线程、
+ * 设备回调或外部循环）按需解码，在同一段 PCM 上与 TTS 逐样本混音，最终只有一个设备
+ * 写入方。应用不必为了第二路声音关闭再重新打开音频设备。
+ *
+ * 每路流有增益和优先级：有更高优先级的声音在播放时，低优先级的流按 duck_db 压低，
+ * 播放器主流（TTS）的优先级为 LINX_MIXER_PRIORITY_VOICE。压低和恢复按 duck_ramp_ms
+ * 平滑过渡，高优先级声音停下后保持 duck_hold_ms 再恢复，句子之间不会忽高忽低。
+ * 增益和混音使用 audio_dsp 的向量内核（NEON/SSE2）。
+ *
+ * 一般通过 linx_player_open_stream() 使用，不需要直接创建混音器。
+ * 线程安全：打开、关闭、设置增益可在任意线程调用；同一路流的 feed 只能来自一个线程。
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct audio_codec audio_codec_t;
+
+/* 同时打开的流数上限 */
+#ifndef LINX_MIXER_MAX_STREAMS
+#define LINX_MIXER_MAX_STREAMS 4
+#endif
+
+typedef struct linx_mixer linx_mixer_t;
+typedef struct linx_mixer_stream linx_mixer_stream_t;
+
+/* 流优先级（可使用其他整数值，越大越优先） */
+typedef enum {
+    LINX_MIXER_PRIORITY_MEDIA = 0,          // 音乐、媒体
+    LINX_MIXER_PRIORITY_NOTIFICATION = 1,   // 通知
+    LINX_MIXER_PRIORITY_VOICE = 2,          // TTS（播放器主流）
+    LINX_MIXER_PRIORITY_ALERT = 3           // 闹钟、告警，播放时压低 TTS
+} linx_mixer_priority_t;
+
+/* 混音器配置；零值字段取默认值 */
+typedef struct {
+    int sample_rate;                // 采样率（Hz），所有流相同
+    int channels;                   // 声道数，所有流相同
+    int duck_db;                    // 压低低优先级流的衰减（dB），0 为默认值 12，<0 不压低
+    int duck_ramp_ms;               // 压低和恢复的过渡时长（毫秒），0 为默认值 50
+    int duck_hold_ms;               // 高优先级声音停下后保持压低的时长（毫秒），0 为默认值 300
+} linx_mixer_config_t;
+
+/* 流配置 */
+typedef struct {
+    audio_codec_t* decoder;         // 已初始化的解码器，采样率和声道数与混音器相同；每路流独占，不持有
+    int priority;                   // 优先级，见 linx_mixer_priority_t
+    float gain;                     // 增益，0 为默认值 1.0（静音用 linx_mixer_stream_set_gain()）
+    size_t max_packets;             // 编码包队列容量，0 为默认值 64
+} linx_mixer_stream_config_t;
+
+/**
+ * 创建混音器
+ * @return 混音器实例，失败返回 NULL
+ */
+linx_mixer_t* linx_mixer_create(const linx_mixer_config_t* config);
+
+/**
+ * 销毁混音器，关闭所有流
+ */
+void linx_mixer_destroy(linx_mixer_t* mixer);
+
+/**
+ * 打开一路流
+ * @return 流句柄，流数已满或内存不足返回 NULL
+ */
+linx_mixer_stream_t* linx_mixer_open(linx_mixer_t* mixer, const linx_mixer_stream_config_t* config);
+
+/**
+ * 关闭一路流，丢弃尚未播放的音频；返回后不再使用该流的解码器
+ */
+void linx_mixer_close(linx_mixer_t* mixer, linx_mixer_stream_t* stream);
+
+/**
+ * 放入一个完整的编码包（按顺序播放）
+ * @param was_empty 输出：放入前该流没有待播放的音频（解码方可能在等待），可为 NULL
+ * @return 队列已满或内存不足返回 false
+ */
+bool linx_mixer_feed(linx_mixer_stream_t* stream, const uint8_t* data, size_t size, bool* was_empty);
+
+/**
+ * 设置流的增益（线性，1.0 为原始音量，按 duck_ramp_ms 过渡）
+ */
+void linx_mixer_stream_set_gain(linx_mixer_t* mixer, linx_mixer_stream_t* stream, float gain);
+
+/**
+ * 流是否还有未播完的音频
+ */
+bool linx_mixer_stream_is_playing(linx_mixer_t* mixer, linx_mixer_stream_t* stream);
+
+/**
+ * 是否有任何流还有未播完的音频
+ */
+bool linx_mixer_active(linx_mixer_t* mixer);
+
+/**
+ * 解码方：把各路流混入一段 PCM（不分配内存）
+ * @param pcm 交错 PCM，已有主流（TTS）的音频或静音
+ * @param samples 样本数（所有声道合计）
+ * @param main_active pcm 中有主流的音频：主流按 LINX_MIXER_PRIORITY_VOICE 参与压低
+ */
+void linx_mixer_mix(linx_mixer_t* mixer, int16_t* pcm, size_t samples, bool main_active);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINX_MIXER_H */
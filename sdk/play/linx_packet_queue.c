@@ -0,0 +1,117 @@
+#include "linx_packet_queue.h"
+#include "../log/linx_alloc.h"
+#include <string.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_PLAY);
+
+typedef struct {
+    linx_packet_queue_entry_t entry;
+    uint8_t* heap;                                  // 超长包的单独分配，否则为 NULL
+    uint8_t data[LINX_PACKET_QUEUE_SLOT_BYTES];     // 内联数据
+} linx_packet_queue_slot_t;
+
+struct linx_packet_queue {
+    linx_packet_queue_slot_t* slots;
+    size_t capacity;                // 槽位数（2 的幂）
+    size_t mask;
+    size_t head;                    // 生产者写入位置（自由递增）
+    size_t tail;                    // 消费者读取位置（自由递增）
+};
+
+linx_packet_queue_t* linx_packet_queue_create(size_t min_packets) {
+    size_t capacity = 1;
+    while (capacity < min_packets) {
+        capacity <<= 1;
+    }
+
+    linx_packet_queue_t* queue = (linx_packet_queue_t*)LINX_CALLOC(1, sizeof(linx_packet_queue_t));
+    if (!queue) {
+        return NULL;
+    }
+    queue->slots = (linx_packet_queue_slot_t*)LINX_CALLOC(capacity, sizeof(linx_packet_queue_slot_t));
+    if (!queue->slots) {
+        LINX_FREE(queue);
+        return NULL;
+    }
+    queue->capacity = capacity;
+    queue->mask = capacity - 1;
+    return queue;
+}
+
+void linx_packet_queue_destroy(linx_packet_queue_t* queue) {
+    if (!queue) {
+        return;
+    }
+    while (linx_packet_queue_peek(queue)) {
+        linx_packet_queue_pop(queue);
+    }
+    LINX_FREE(queue->slots);
+    LINX_FREE(queue);
+}
+
+linx_packet_queue_result_t linx_packet_queue_push(linx_packet_queue_t* queue, const uint8_t* data, size_t size,
+                                                  uint32_t timestamp, bool has_timestamp, uint64_t arrival_ms,
+                                                  bool* was_empty) {
+    size_t head = queue->head;
+    if (head - __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE) >= queue->capacity) {
+        return LINX_PACKET_QUEUE_FULL;
+    }
+
+    linx_packet_queue_slot_t* slot = &queue->slots[head & queue->mask];
+    uint8_t* storage = slot->data;
+    if (size > LINX_PACKET_QUEUE_SLOT_BYTES) {
+        slot->heap = (uint8_t*)LINX_MALLOC(size);
+        if (!slot->heap) {
+            return LINX_PACKET_QUEUE_NO_MEMORY;
+        }
+        storage = slot->heap;
+    }
+    memcpy(storage, data, size);
+    slot->entry.data = storage;
+    slot->entry.size = size;
+    slot->entry.timestamp = timestamp;
+    slot->entry.has_timestamp = has_timestamp;
+    slot->entry.arrival_ms = arrival_ms;
+
+    // 发布与随后读取 tail 都用顺序一致的原子操作，与消费者等待前的 is_empty 配对
+    __atomic_store_n(&queue->head, head + 1, __ATOMIC_SEQ_CST);
+    if (was_empty) {
+        *was_empty = __atomic_load_n(&queue->tail, __ATOMIC_SEQ_CST) == head;
+    }
+    return LINX_PACKET_QUEUE_OK;
+}
+
+const linx_packet_queue_entry_t* linx_packet_queue_peek(linx_packet_queue_t* queue) {
+    size_t tail = queue->tail;
+    if (__atomic_load_n(&queue->head, __ATOMIC_ACQUIRE) == tail) {
+        return NULL;
+    }
+    return &queue->slots[tail & queue->mask].entry;
+}
+
+void linx_packet_queue_pop(linx_packet_queue_t* queue) {
+    size_t tail = queue->tail;
+    if (__atomic_load_n(&queue->head, __ATOMIC_ACQUIRE) == tail) {
+        return;
+    }
+    linx_packet_queue_slot_t* slot = &queue->slots[tail & queue->mask];
+    if (slot->heap) {
+        LINX_FREE(slot->heap);
+        slot->heap = NULL;
+    }
+    __atomic_store_n(&queue->tail, tail + 1, __ATOMIC_SEQ_CST);
+}
+
+bool linx_packet_queue_is_empty(const linx_packet_queue_t* queue) {
+    return __atomic_load_n(&queue->head, __ATOMIC_SEQ_CST) == __atomic_load_n(&queue->tail, __ATOMIC_SEQ_CST);
+}
+
+size_t linx_packet_queue_count(const linx_packet_queue_t* queue) {
+    size_t tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+    size_t head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+    return head - tail;
+}
+
+size_t linx_packet_queue_capacity(const linx_packet_queue_t* queue) {
+    return queue->capacity;
+}
@@ -0,0 +1,91 @@
+#ifndef LINX_PACKET_QUEUE_H
+#define LINX_PACKET_QUEUE_H
+
+/*
+ * 单生产者/单消费者的无锁编码包队列
+ *
+ * 网络线程（生产者）把收到的包连同到达时间放入队列，解码方（消费者：播放线程、
+ * 设备回调或外部循环）取出后再放入抖动缓冲区，两端都不加锁。槽位数取 2 的幂，
+ * 头尾位置是自由递增的计数，用 acquire/release 原子操作发布。
+ * 不超过 LINX_PACKET_QUEUE_SLOT_BYTES 的包内联存放，更长的包由生产者单独分配、
+ * 消费者释放。
+ *
+ * push 报告队列是否从空变为非空，生产者只在这时唤醒消费者；消费者在等待前用
+ * linx_packet_queue_is_empty() 再确认一次（与 push 的判断都是顺序一致的原子操作，
+ * 两边至少有一方能看到对方，不会丢失唤醒）。
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 单个槽位内联存放的最大包长 */
+#define LINX_PACKET_QUEUE_SLOT_BYTES 512
+
+typedef struct linx_packet_queue linx_packet_queue_t;
+
+/* 队列中的一个包（消费者读取，pop 之前有效） */
+typedef struct {
+    const uint8_t* data;            // 包数据
+    size_t size;                    // 包长度
+    uint32_t timestamp;             // 包时间戳（毫秒）
+    bool has_timestamp;             // 时间戳是否有效
+    uint64_t arrival_ms;            // 生产者放入时的单调时间（毫秒）
+} linx_packet_queue_entry_t;
+
+/* 放入结果 */
+typedef enum {
+    LINX_PACKET_QUEUE_OK = 0,
+    LINX_PACKET_QUEUE_FULL,         // 槽位已满
+    LINX_PACKET_QUEUE_NO_MEMORY     // 超长包分配失败
+} linx_packet_queue_result_t;
+
+/**
+ * 创建队列
+ * @param min_packets 最少容纳的包数（向上取为 2 的幂）
+ * @return 队列实例，失败返回 NULL
+ */
+linx_packet_queue_t* linx_packet_queue_create(size_t min_packets);
+
+/**
+ * 销毁队列（释放仍在队列中的超长包）
+ */
+void linx_packet_queue_destroy(linx_packet_queue_t* queue);
+
+/**
+ * 生产者：放入一个包
+ * @param was_empty 输出：放入前队列为空（消费者可能在等待），可为 NULL
+ */
+linx_packet_queue_result_t linx_packet_queue_push(linx_packet_queue_t* queue, const uint8_t* data, size_t size,
+                                                  uint32_t timestamp, bool has_timestamp, uint64_t arrival_ms,
+                                                  bool* was_empty);
+
+/**
+ * 消费者：查看队首的包
+ * @return 队首的包，队列为空时返回 NULL
+ */
+const linx_packet_queue_entry_t* linx_packet_queue_peek(linx_packet_queue_t* queue);
+
+/**
+ * 消费者：移除队首的包
+ */
+void linx_packet_queue_pop(linx_packet_queue_t* queue);
+
+/**
+ * 消费者：等待前确认队列为空
+ */
+bool linx_packet_queue_is_empty(const linx_packet_queue_t* queue);
+
+/* 状态查询（任意线程，结果是某一时刻的近似值） */
+size_t linx_packet_queue_count(const linx_packet_queue_t* queue);
+size_t linx_packet_queue_capacity(const linx_packet_queue_t* queue);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINX_PACKET_QUEUE_H */
@@ -0,0 +1,97 @@
+#include "linx_pcm_ring.h"
+#include "../log/linx_alloc.h"
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_PLAY);
+
+struct linx_pcm_ring {
+    linx_pcm_ring_period_t* periods;
+    int16_t* storage;               // 所有周期的 PCM，一次分配
+    size_t capacity;                // 可排队的周期数
+    size_t slots;                   // 槽位数（不小于 capacity 的 2 的幂）
+    size_t mask;
+    size_t period_samples;
+    size_t head;                    // 生产者写入位置（自由递增）
+    size_t tail;                    // 消费者读取位置（自由递增）
+};
+
+linx_pcm_ring_t* linx_pcm_ring_create(size_t periods, size_t period_samples) {
+    if (periods == 0 || period_samples == 0) {
+        return NULL;
+    }
+
+    // 槽位取 2 的幂以便用掩码取下标，满的判断仍按请求的周期数
+    size_t slots = 1;
+    while (slots < periods) {
+        slots <<= 1;
+    }
+
+    linx_pcm_ring_t* ring = (linx_pcm_ring_t*)LINX_CALLOC(1, sizeof(linx_pcm_ring_t));
+    if (!ring) {
+        return NULL;
+    }
+    ring->periods = (linx_pcm_ring_period_t*)LINX_CALLOC(slots, sizeof(linx_pcm_ring_period_t));
+    ring->storage = (int16_t*)LINX_CALLOC(slots * period_samples, sizeof(int16_t));
+    if (!ring->periods || !ring->storage) {
+        linx_pcm_ring_destroy(ring);
+        return NULL;
+    }
+    for (size_t i = 0; i < slots; i++) {
+        ring->periods[i].pcm = ring->storage + i * period_samples;
+    }
+    ring->capacity = periods;
+    ring->slots = slots;
+    ring->mask = slots - 1;
+    ring->period_samples = period_samples;
+    return ring;
+}
+
+void linx_pcm_ring_destroy(linx_pcm_ring_t* ring) {
+    if (!ring) {
+        return;
+    }
+    LINX_FREE(ring->periods);
+    LINX_FREE(ring->storage);
+    LINX_FREE(ring);
+}
+
+linx_pcm_ring_period_t* linx_pcm_ring_acquire(linx_pcm_ring_t* ring) {
+    size_t head = ring->head;
+    if (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) >= ring->capacity) {
+        return NULL;
+    }
+    return &ring->periods[head & ring->mask];
+}
+
+void linx_pcm_ring_commit(linx_pcm_ring_t* ring) {
+    __atomic_store_n(&ring->head, ring->head + 1, __ATOMIC_RELEASE);
+}
+
+const linx_pcm_ring_period_t* linx_pcm_ring_peek(linx_pcm_ring_t* ring) {
+    size_t tail = ring->tail;
+    if (__atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) == tail) {
+        return NULL;
+    }
+    return &ring->periods[tail & ring->mask];
+}
+
+void linx_pcm_ring_pop(linx_pcm_ring_t* ring) {
+    size_t tail = ring->tail;
+    if (__atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) == tail) {
+        return;
+    }
+    __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+size_t linx_pcm_ring_count(const linx_pcm_ring_t* ring) {
+    size_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    size_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    return head - tail;
+}
+
+size_t linx_pcm_ring_capacity(const linx_pcm_ring_t* ring) {
+    return ring->capacity;
+}
+
+size_t linx_pcm_ring_period_samples(const linx_pcm_ring_t* ring) {
+    return ring->period_samples;
+}
@@ -0,0 +1,77 @@
+#ifndef LINX_PCM_RING_H
+#define LINX_PCM_RING_H
+
+/*
+ * 单生产者/单消费者的无锁 PCM 周期队列（解码超前）
+ *
+ * 推模式下解码线程（生产者）把解码后的 PCM 按周期放入队列，输出线程（消费者）按设备
+ * 节奏取出写入音频接口；队列里保持的几个周期吸收解码耗时的尖峰（高复杂度帧、与 UI
+ * 抢占 CPU）。每个周期的缓冲区在创建时一次分配好，生产者直接写入槽位，放入和取出
+ * 都不分配内存、不加锁。头尾位置是自由递增的计数，用 acquire/release 原子操作发布。
+ *
+ * 队列不负责唤醒：生产者在 acquire 返回 NULL、消费者在 peek 返回 NULL 时由调用方
+ * 在各自的信号量上等待，对方在 commit/pop 之后给出信号量。
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct linx_pcm_ring linx_pcm_ring_t;
+
+/* 队列中的一个周期 */
+typedef struct {
+    int16_t* pcm;                   // 交错 PCM，容量为 period_samples
+    size_t samples;                 // 有效样本数（所有声道合计）
+    uint32_t timestamp;             // pcm[0] 的流时间戳（毫秒）
+    bool has_timestamp;             // 时间戳是否有效
+    uint32_t generation;            // 放入时的代数，消费者据此丢弃清空之前的周期
+    bool has_tts;                   // 含 TTS 音频（只有附加播放流的周期不计入首帧播出）
+} linx_pcm_ring_period_t;
+
+/**
+ * 创建队列
+ * @param periods 周期数
+ * @param period_samples 每个周期的样本数（所有声道合计）
+ * @return 队列实例，失败返回 NULL
+ */
+linx_pcm_ring_t* linx_pcm_ring_create(size_t periods, size_t period_samples);
+
+void linx_pcm_ring_destroy(linx_pcm_ring_t* ring);
+
+/**
+ * 生产者：取得下一个空闲周期用于写入
+ * @return 空闲周期，队列已满时返回 NULL
+ */
+linx_pcm_ring_period_t* linx_pcm_ring_acquire(linx_pcm_ring_t* ring);
+
+/**
+ * 生产者：发布 acquire 取得的周期
+ */
+void linx_pcm_ring_commit(linx_pcm_ring_t* ring);
+
+/**
+ * 消费者：查看队首的周期
+ * @return 队首周期，队列为空时返回 NULL
+ */
+const linx_pcm_ring_period_t* linx_pcm_ring_peek(linx_pcm_ring_t* ring);
+
+/**
+ * 消费者：移除队首的周期
+ */
+void linx_pcm_ring_pop(linx_pcm_ring_t* ring);
+
+/* 状态查询（任意线程，结果是某一时刻的近似值） */
+size_t linx_pcm_ring_count(const linx_pcm_ring_t* ring);
+size_t linx_pcm_ring_capacity(const linx_pcm_ring_t* ring);
+size_t linx_pcm_ring_period_samples(const linx_pcm_ring_t* ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINX_PCM_RING_H */
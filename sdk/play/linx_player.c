@@ -1,24 +1,88 @@
 #include "linx_player.h"
 #include "../audio/audio_interface.h"
+#include "../audio/audio_dsp.h"
 #include "../codecs/audio_codec.h"
 #include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
+#include "../log/linx_thread_stats.h"
+#include "../linx_metrics.h"
+#include "../linx_trace.h"
+#include "../linx_tracepoint.h"
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <unistd.h>
 #include <errno.h>
+#include <time.h>
+#include <math.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_PLAY);
 
 // 默认配置常量
-#define DEFAULT_BUFFER_CAPACITY (64 * 1024)  // 64KB 缓冲区
 #define DECODE_BUFFER_SIZE 4096               // 解码缓冲区大小
-#define PLAYBACK_THREAD_SLEEP_US 10000        // 播放线程休眠时间（微秒）
+#define PLAYER_MAX_CONCEALED_FRAMES 5         // 单次最多补齐的丢失帧数，超过视为流中断直接重新同步
+#define PLAYER_GAIN_UNITY 32768               // Q15 增益 1.0
+#define PLAYER_SOUND_MAX_VOLUME 2.0f          // 提示音音量上限，保证 Q15 乘积不溢出
+#define PLAYER_DEFAULT_DUCK_DB 12
+#define PLAYER_DEFAULT_DUCK_RAMP_MS 20
+#define PLAYER_DEFAULT_VOLUME_RAMP_MS 30
+#define PLAYER_VOLUME_BLOCK 64                // 音量过渡按块推进，块内线性插值增益
+#define PLAYER_DEFAULT_BRIDGE_MS 200
+#define PLAYER_BRIDGE_CROSSFADE_MS 10         // 衔接结束时 PLC 与新句子的交叉淡化时长
 
 // 内部函数声明
 static void* playback_thread_func(void* arg);
+static void* output_thread_func(void* arg);
 static player_error_t change_state(linx_player_t* player, player_state_t new_state);
-static size_t circular_buffer_write(linx_player_t* player, const uint8_t* data, size_t size);
-static size_t circular_buffer_read(linx_player_t* player, uint8_t* data, size_t size);
-static size_t circular_buffer_available_space(linx_player_t* player);
-static size_t circular_buffer_available_data(linx_player_t* player);
+static player_state_t player_load_state(linx_player_t* player);
+static bool player_is_running(linx_player_t* player);
+static void wake_playback_thread(linx_player_t* player);
+static uint64_t player_now_ms(void);
+static void wait_for_packets(linx_player_t* player, int timeout_ms);
+static void player_drain_feed(linx_player_t* player);
+static void player_publish_depth(linx_player_t* player);
+static int player_queued_ms(linx_player_t* player);
+static void call_output_tap(linx_player_t* player, const int16_t* pcm, size_t samples, const uint32_t* timestamp);
+static void note_written(linx_player_t* player, size_t samples, const uint32_t* timestamp);
+static void tick_deadline(linx_player_t* player, size_t samples);
+static size_t player_deadline_context(void* user_data, char* buf, size_t size);
+static void play_packet(linx_player_t* player, const uint8_t* packet, size_t size, uint32_t timestamp,
+                        int16_t* pcm, size_t pcm_size);
+static int write_output(linx_player_t* player, int16_t* pcm, size_t samples, const uint32_t* timestamp,
+                        bool has_tts);
+static int push_output(linx_player_t* player, int16_t* pcm, size_t samples, const uint32_t* timestamp);
+static int enqueue_output(linx_player_t* player, int16_t* pcm, size_t samples, const uint32_t* timestamp,
+                          bool has_tts);
+static void setup_decode_ahead(linx_player_t* player);
+static void release_decode_ahead(linx_player_t* player);
+
+/* 拉模式下一次设备请求的输出目标 */
+typedef struct {
+    int16_t* output;                // 设备缓冲区
+    size_t needed;                  // 请求的样本数
+    size_t filled;                  // 已填充的样本数
+} pull_target_t;
+
+static int output_pcm(linx_player_t* player, pull_target_t* target, int16_t* pcm, size_t samples,
+                      const uint32_t* timestamp);
+static void conceal_lost_frames(linx_player_t* player, pull_target_t* target, uint32_t timestamp,
+                                const uint8_t* next_packet, size_t next_size,
+                                int16_t* pcm, size_t pcm_size);
+static size_t pull_callback(void* user_data, short* buffer, size_t frame_count);
+static bool setup_pull_mode(linx_player_t* player);
+static void release_pull_buffers(linx_player_t* player);
+static bool player_sounds_pending(linx_player_t* player);
+static void mix_sounds(linx_player_t* player, int16_t* pcm, size_t samples);
+static void play_sound_frame(linx_player_t* player, int16_t* pcm, size_t pcm_size);
+static linx_mixer_t* player_mixer(linx_player_t* player);
+static bool player_streams_pending(linx_player_t* player);
+static void play_stream_frame(linx_player_t* player, int16_t* pcm, size_t pcm_size);
+static void apply_volume(linx_player_t* player, int16_t* pcm, size_t samples);
+static void process_output(linx_player_t* player, int16_t* pcm, size_t samples);
+static linx_jitter_result_t player_pop(linx_player_t* player, uint8_t* buffer, size_t buffer_size,
+                                       size_t* size, uint32_t* timestamp, uint64_t now_ms);
+static bool bridge_gap(linx_player_t* player, pull_target_t* target, int16_t* pcm, size_t pcm_size);
+static size_t bridge_prepare(linx_player_t* player);
+static void bridge_finish(linx_player_t* player, int16_t* pcm, size_t samples, size_t crossfade);
 
 /**
  * 创建播放器实例
@@ -29,7 +93,7 @@ linx_player_t* linx_player_create(AudioInterface* audio_interface, audio_codec_t
         return NULL;
     }
     
-    linx_player_t* player = (linx_player_t*)calloc(1, sizeof(linx_player_t));
+    linx_player_t* player = (linx_player_t*)LINX_CALLOC(1, sizeof(linx_player_t));
     if (!player) {
         LOG_ERROR("Failed to allocate memory for player");
         return NULL;
@@ -44,24 +108,44 @@ linx_player_t* linx_player_create(AudioInterface* audio_interface, audio_codec_t
     // 初始化互斥锁和条件变量
     if (pthread_mutex_init(&player->state_mutex, NULL) != 0) {
         LOG_ERROR("Failed to initialize state mutex");
-        free(player);
+        LINX_FREE(player);
         return NULL;
     }
     
     if (pthread_mutex_init(&player->buffer_mutex, NULL) != 0) {
         LOG_ERROR("Failed to initialize buffer mutex");
         pthread_mutex_destroy(&player->state_mutex);
-        free(player);
+        LINX_FREE(player);
+        return NULL;
+    }
+    
+    // 二值信号量：多次唤醒合并为一次
+    player->wake_sem = linx_sem_create(0, 1);
+    if (!player->wake_sem) {
+        LOG_ERROR("Failed to create wake semaphore");
+        pthread_mutex_destroy(&player->state_mutex);
+        pthread_mutex_destroy(&player->buffer_mutex);
+        LINX_FREE(player);
         return NULL;
     }
     
-    if (pthread_cond_init(&player->buffer_cond, NULL) != 0) {
-        LOG_ERROR("Failed to initialize buffer condition");
+    if (pthread_mutex_init(&player->sound_mutex, NULL) != 0) {
+        LOG_ERROR("Failed to initialize sound mutex");
         pthread_mutex_destroy(&player->state_mutex);
         pthread_mutex_destroy(&player->buffer_mutex);
-        free(player);
+        linx_sem_destroy(player->wake_sem);
+        LINX_FREE(player);
         return NULL;
     }
+    player->buffer_lock = (linx_deadline_lock_t)LINX_DEADLINE_LOCK_INIT("player_buffer");
+    player->duck_gain_q15 = PLAYER_GAIN_UNITY;
+    player->duck_target_q15 = PLAYER_GAIN_UNITY;
+    player->duck_step_q15 = PLAYER_GAIN_UNITY;
+    player->volume_mdb = 0;
+    player->external_duck_mdb = 0;
+    player->volume_current_db = 0.0f;
+    player->volume_target_db = 0.0f;
+    player->volume_step_db = 0.0f;
     
     return player;
 }
@@ -82,24 +166,64 @@ player_error_t linx_player_init(linx_player_t* player, const player_audio_config
     // 保存配置
     player->config = *config;
     
-    // 分配音频缓冲区
-    player->buffer_capacity = DEFAULT_BUFFER_CAPACITY;
-    player->audio_buffer = (uint8_t*)malloc(player->buffer_capacity);
-    if (!player->audio_buffer) {
-        LOG_ERROR("Failed to allocate audio buffer");
+    // 提示音压低 TTS 的目标增益和过渡斜率（每个样本的增益变化）
+    int duck_db = config->sound_duck_db == 0 ? PLAYER_DEFAULT_DUCK_DB : config->sound_duck_db;
+    int ramp_ms = config->sound_duck_ramp_ms > 0 ? config->sound_duck_ramp_ms : PLAYER_DEFAULT_DUCK_RAMP_MS;
+    player->duck_target_q15 = duck_db > 0 ? (int32_t)(PLAYER_GAIN_UNITY * powf(10.0f, -(float)duck_db / 20.0f))
+                                          : PLAYER_GAIN_UNITY;
+    size_t ramp_samples = (size_t)(config->sample_rate > 0 ? config->sample_rate : 16000) *
+                          (size_t)(config->channels > 0 ? config->channels : 1) * (size_t)ramp_ms / 1000;
+    player->duck_step_q15 = (int32_t)((PLAYER_GAIN_UNITY - player->duck_target_q15) / (ramp_samples > 0 ? ramp_samples : 1));
+    if (player->duck_step_q15 <= 0) {
+        player->duck_step_q15 = 1;
+    }
+    
+    // 句间衔接：PLC 帧缓冲区按一帧（所有声道）分配
+    player->bridge_limit_ms = config->gapless_bridge_ms == 0 ? PLAYER_DEFAULT_BRIDGE_MS :
+                              (config->gapless_bridge_ms > 0 ? config->gapless_bridge_ms : 0);
+    if (player->bridge_limit_ms > 0 && config->frame_size > 0) {
+        player->bridge_pcm_size = (size_t)config->frame_size * (size_t)(config->channels > 0 ? config->channels : 1);
+        player->bridge_pcm = (int16_t*)LINX_MALLOC(player->bridge_pcm_size * sizeof(int16_t));
+        if (!player->bridge_pcm) {
+            LOG_WARN("Failed to allocate bridge buffer, gapless playback disabled");
+            player->bridge_pcm_size = 0;
+            player->bridge_limit_ms = 0;
+        }
+    } else {
+        player->bridge_limit_ms = 0;
+    }
+    
+    // 创建抖动缓冲区，包时长由帧大小与采样率推算
+    linx_jitter_buffer_config_t jitter_config = {
+        .frame_duration_ms = (config->sample_rate > 0 && config->frame_size > 0) ?
+                             config->frame_size * 1000 / config->sample_rate : 0,
+        .target_depth_ms = config->jitter_target_ms,
+        .min_depth_ms = 0,
+        .max_depth_ms = config->jitter_max_ms,
+        .adaptive = !config->jitter_fixed
+    };
+    player->jitter_buffer = linx_jitter_buffer_create(&jitter_config);
+    if (!player->jitter_buffer) {
+        LOG_ERROR("Failed to allocate jitter buffer");
         return PLAYER_ERROR_AUDIO_INTERFACE;
     }
     
-    // 初始化缓冲区状态
-    player->buffer_head = 0;
-    player->buffer_tail = 0;
-    player->buffer_count = 0;
+    // 下行包队列与抖动缓冲区容量相同：解码方暂停取包时 feed 与原来一样在缓冲区满时返回 BUFFER_FULL
+    player->feed_queue = linx_packet_queue_create(linx_jitter_buffer_capacity(player->jitter_buffer));
+    if (!player->feed_queue) {
+        LOG_ERROR("Failed to allocate packet queue");
+        linx_jitter_buffer_destroy(player->jitter_buffer);
+        player->jitter_buffer = NULL;
+        return PLAYER_ERROR_AUDIO_INTERFACE;
+    }
     
     // 先初始化音频接口（初始化PortAudio）
     if (audio_interface_init(player->audio_interface) != 0) {
         LOG_ERROR("Failed to initialize audio interface");
-        free(player->audio_buffer);
-        player->audio_buffer = NULL;
+        linx_jitter_buffer_destroy(player->jitter_buffer);
+        player->jitter_buffer = NULL;
+        linx_packet_queue_destroy(player->feed_queue);
+        player->feed_queue = NULL;
         return PLAYER_ERROR_AUDIO_INTERFACE;
     }
     
@@ -115,11 +239,52 @@ player_error_t linx_player_init(linx_player_t* player, const player_audio_config
     // 初始化播放
     if (audio_interface_init_play(player->audio_interface) != 0) {
         LOG_ERROR("Failed to initialize audio playback");
-        free(player->audio_buffer);
-        player->audio_buffer = NULL;
+        linx_jitter_buffer_destroy(player->jitter_buffer);
+        player->jitter_buffer = NULL;
+        linx_packet_queue_destroy(player->feed_queue);
+        player->feed_queue = NULL;
         return PLAYER_ERROR_AUDIO_INTERFACE;
     }
     
+    // 拉模式：由设备回调驱动解码，不支持时退回播放线程
+    if (config->pull_mode && !setup_pull_mode(player)) {
+        LOG_WARN("Audio interface does not support pull mode, using playback thread");
+    }
+    
+    // 外部循环：解码缓冲区放在堆上，不占用应用主循环的栈
+    if (config->external_loop && !player->pull_active) {
+        player->process_packet = (uint8_t*)LINX_MALLOC(DECODE_BUFFER_SIZE);
+        player->process_pcm = (int16_t*)LINX_MALLOC(DECODE_BUFFER_SIZE * sizeof(int16_t));
+        if (!player->process_packet || !player->process_pcm) {
+            LOG_ERROR("Failed to allocate decode buffers");
+            LINX_FREE(player->process_packet);
+            LINX_FREE(player->process_pcm);
+            player->process_packet = NULL;
+            player->process_pcm = NULL;
+            linx_jitter_buffer_destroy(player->jitter_buffer);
+            player->jitter_buffer = NULL;
+            linx_packet_queue_destroy(player->feed_queue);
+            player->feed_queue = NULL;
+            return PLAYER_ERROR_AUDIO_INTERFACE;
+        }
+    }
+    
+    // 播放线程解码超前，分配失败时退回在播放线程中直接写设备
+    if (!player->pull_active && !player->process_pcm) {
+        setup_decode_ahead(player);
+    }
+    
+    // 写设备的周期截止监测，创建失败（监测器已满）时不监测
+    if (config->sample_rate > 0 && config->frame_size > 0) {
+        linx_deadline_config_t deadline_config = {
+            .name = player->pull_active ? "player_pull" : (player->ahead_ring ? "player_out" : "player"),
+            .period_us = (uint32_t)((uint64_t)config->frame_size * 1000000u / (uint32_t)config->sample_rate),
+            .context = player_deadline_context,
+            .context_user_data = player
+        };
+        player->deadline = linx_deadline_create(&deadline_config);
+    }
+    
     player->initialized = true;
     LOG_INFO("Player initialized successfully");
     
@@ -144,6 +309,20 @@ player_error_t linx_player_set_event_callback(linx_player_t* player,
     return PLAYER_SUCCESS;
 }
 
+/**
+ * 设置输出抽头
+ */
+player_error_t linx_player_set_output_tap(linx_player_t* player, player_output_tap_t tap, void* user_data) {
+    if (!player) {
+        return PLAYER_ERROR_INVALID_PARAM;
+    }
+    
+    // 先写用户数据，读取方先读回调再读用户数据
+    __atomic_store_n(&player->output_tap_user_data, user_data, __ATOMIC_RELAXED);
+    __atomic_store_n(&player->output_tap, tap, __ATOMIC_RELEASE);
+    return PLAYER_SUCCESS;
+}
+
 /**
  * 开始播放
  */
@@ -168,17 +347,45 @@ player_error_t linx_player_start(linx_player_t* player) {
         return PLAYER_ERROR_INVALID_STATE;
     }
     
-    // 启动播放线程
+    // 启动播放线程（拉模式下由设备回调解码，外部循环模式由应用调用 linx_player_process，均无需线程）
     player->running = true;
-    if (pthread_create(&player->playback_thread, NULL, playback_thread_func, player) != 0) {
-        LOG_ERROR("Failed to create playback thread");
-        player->running = false;
-        pthread_mutex_unlock(&player->state_mutex);
-        return PLAYER_ERROR_THREAD;
+    if (!player->pull_active && !player->process_pcm) {
+        const linx_thread_attr_t defaults = {
+            .name = "player",
+            .priority = LINX_THREAD_PRIORITY_HIGH,
+            .core_mask = LINX_THREAD_AUDIO_CORE_MASK,
+            .sched_priority = LINX_THREAD_AUDIO_SCHED_PRIORITY
+        };
+        linx_thread_attr_t attr = linx_thread_attr_merge(&player->config.playback_thread_attr, &defaults);
+        // 输出线程先启动：没有周期时在 ahead_data_sem 上等待
+        if (player->ahead_ring) {
+            linx_thread_attr_t output_attr = attr;
+            output_attr.name = "player_out";
+            player->output_thread = linx_thread_create(&output_attr, output_thread_func, player);
+            if (!player->output_thread) {
+                LOG_ERROR("Failed to create output thread");
+                player->running = false;
+                pthread_mutex_unlock(&player->state_mutex);
+                return PLAYER_ERROR_THREAD;
+            }
+        }
+        player->playback_thread = linx_thread_create(&attr, playback_thread_func, player);
+        if (!player->playback_thread) {
+            LOG_ERROR("Failed to create playback thread");
+            __atomic_store_n(&player->running, false, __ATOMIC_RELEASE);
+            if (player->output_thread) {
+                linx_sem_give(player->ahead_data_sem);
+                linx_thread_join(player->output_thread);
+                player->output_thread = NULL;
+            }
+            pthread_mutex_unlock(&player->state_mutex);
+            return PLAYER_ERROR_THREAD;
+        }
     }
     
     change_state(player, PLAYER_STATE_PLAYING);
     pthread_mutex_unlock(&player->state_mutex);
+    wake_playback_thread(player);
     
     LOG_INFO("Player started");
     return PLAYER_SUCCESS;
@@ -222,9 +429,12 @@ player_error_t linx_player_resume(linx_player_t* player) {
     }
     
     change_state(player, PLAYER_STATE_PLAYING);
-    pthread_cond_signal(&player->buffer_cond);
     pthread_mutex_unlock(&player->state_mutex);
     
+    // 暂停时声音从波形中间截断，恢复时淡入避免爆音
+    __atomic_store_n(&player->volume_fade_in, true, __ATOMIC_RELEASE);
+    wake_playback_thread(player);
+    
     LOG_INFO("Player resumed");
     return PLAYER_SUCCESS;
 }
@@ -245,15 +455,22 @@ player_error_t linx_player_stop(linx_player_t* player) {
     }
     
     // 停止播放线程
-    player->running = false;
+    __atomic_store_n(&player->running, false, __ATOMIC_RELEASE);
     change_state(player, PLAYER_STATE_STOPPED);
-    pthread_cond_signal(&player->buffer_cond);
     pthread_mutex_unlock(&player->state_mutex);
+    wake_playback_thread(player);
     
-    // 等待播放线程结束
+    // 等待播放线程结束（可能正等待解码超前队列的空间）
+    if (player->ahead_space_sem) {
+        linx_sem_give(player->ahead_space_sem);
+    }
     if (player->playback_thread) {
-        pthread_join(player->playback_thread, NULL);
-        player->playback_thread = 0;
+        linx_thread_join(player->playback_thread);
+        player->playback_thread = NULL;
+    }
+    if (player->output_thread) {
+        linx_thread_join(player->output_thread);
+        player->output_thread = NULL;
     }
     
     // 清空缓冲区
@@ -267,6 +484,14 @@ player_error_t linx_player_stop(linx_player_t* player) {
  * 添加音频数据到播放缓冲区
  */
 player_error_t linx_player_feed_data(linx_player_t* player, const uint8_t* data, size_t size) {
+    return linx_player_feed_packet(player, data, size, 0, false);
+}
+
+/**
+ * 添加带时间戳的编码包到抖动缓冲区
+ */
+player_error_t linx_player_feed_packet(linx_player_t* player, const uint8_t* data, size_t size,
+                                       uint32_t timestamp, bool has_timestamp) {
     if (!player || !data || size == 0) {
         return PLAYER_ERROR_INVALID_PARAM;
     }
@@ -275,34 +500,26 @@ player_error_t linx_player_feed_data(linx_player_t* player, const uint8_t* data,
         return PLAYER_ERROR_NOT_INITIALIZED;
     }
     
-    LOG_DEBUG("📥 接收音频数据: %zu 字节", size);
-    
-    pthread_mutex_lock(&player->buffer_mutex);
-    
-    size_t available_space = circular_buffer_available_space(player);
-    float usage_before = (float)player->buffer_count / (float)player->buffer_capacity * 100.0f;
-    
-    // 检查缓冲区是否有足够空间
-    if (available_space < size) {
-        LOG_WARN("⚠️ 缓冲区空间不足: 需要 %zu 字节，可用 %zu 字节 (使用率: %.1f%%)", 
-                size, available_space, usage_before);
-        pthread_mutex_unlock(&player->buffer_mutex);
+    LOG_DEBUG_EVERY_N(50, "📥 接收音频包: %zu 字节, 时间戳: %u", size, timestamp);
+    LINX_TRACEPOINT(player_feed, size, timestamp);
+    
+    // 只放入无锁队列，排序、去重和抖动估计由解码方转入抖动缓冲区时完成（到达时间在这里记录）
+    size_t pending = __atomic_load_n(&player->jitter_packets, __ATOMIC_ACQUIRE) +
+                     linx_packet_queue_count(player->feed_queue);
+    bool was_empty = false;
+    linx_packet_queue_result_t result = pending >= linx_jitter_buffer_capacity(player->jitter_buffer) ?
+                                        LINX_PACKET_QUEUE_FULL :
+                                        linx_packet_queue_push(player->feed_queue, data, size, timestamp,
+                                                               has_timestamp, player_now_ms(), &was_empty);
+    if (result != LINX_PACKET_QUEUE_OK) {
+        linx_metrics_add(player->metrics, LINX_METRIC_DOWNLINK_DROPS, 1);
+        LOG_WARN_EVERY_MS(1000, "⚠️ 抖动缓冲区已满: %zu 包", pending);
         return PLAYER_ERROR_BUFFER_FULL;
     }
     
-    // 写入数据到环形缓冲区
-    size_t written = circular_buffer_write(player, data, size);
-    
-    float usage_after = (float)player->buffer_count / (float)player->buffer_capacity * 100.0f;
-    LOG_DEBUG("✅ 数据写入缓冲区: %zu 字节，使用率: %.1f%% -> %.1f%%", 
-             written, usage_before, usage_after);
-    
-    // 通知播放线程有新数据
-    pthread_cond_signal(&player->buffer_cond);
-    pthread_mutex_unlock(&player->buffer_mutex);
-    
-    if (written != size) {
-        LOG_WARN("⚠️ 部分写入: 写入 %zu / %zu 字节", written, size);
+    // 队列由空变为非空时播放线程可能在等待，其余情况它取包时会一并取走
+    if (was_empty) {
+        linx_sem_give(player->wake_sem);
     }
     
     return PLAYER_SUCCESS;
@@ -316,11 +533,7 @@ player_state_t linx_player_get_state(linx_player_t* player) {
         return PLAYER_STATE_ERROR;
     }
     
-    pthread_mutex_lock(&player->state_mutex);
-    player_state_t state = player->state;
-    pthread_mutex_unlock(&player->state_mutex);
-    
-    return state;
+    return player_load_state(player);
 }
 
 /**
@@ -331,11 +544,12 @@ bool linx_player_is_buffer_empty(linx_player_t* player) {
         return true;
     }
     
-    pthread_mutex_lock(&player->buffer_mutex);
-    bool empty = (player->buffer_count == 0);
-    pthread_mutex_unlock(&player->buffer_mutex);
+    if (!player->jitter_buffer) {
+        return true;
+    }
     
-    return empty;
+    return __atomic_load_n(&player->jitter_packets, __ATOMIC_ACQUIRE) == 0 &&
+           linx_packet_queue_count(player->feed_queue) == 0;
 }
 
 /**
@@ -346,26 +560,47 @@ bool linx_player_is_buffer_full(linx_player_t* player) {
         return false;
     }
     
-    pthread_mutex_lock(&player->buffer_mutex);
-    bool full = (player->buffer_count >= player->buffer_capacity);
-    pthread_mutex_unlock(&player->buffer_mutex);
+    if (!player->jitter_buffer) {
+        return false;
+    }
     
-    return full;
+    return __atomic_load_n(&player->jitter_packets, __ATOMIC_ACQUIRE) +
+           linx_packet_queue_count(player->feed_queue) >= linx_jitter_buffer_capacity(player->jitter_buffer);
 }
 
 /**
  * 获取缓冲区使用率
  */
 float linx_player_get_buffer_usage(linx_player_t* player) {
-    if (!player || player->buffer_capacity == 0) {
+    if (!player || !player->jitter_buffer) {
         return 0.0f;
     }
     
-    pthread_mutex_lock(&player->buffer_mutex);
-    float usage = (float)player->buffer_count / (float)player->buffer_capacity;
-    pthread_mutex_unlock(&player->buffer_mutex);
+    // 无锁：解码方发布的深度加上队列中尚未转入的包
+    float usage = (float)player_queued_ms(player) / (float)linx_jitter_buffer_max_depth_ms(player->jitter_buffer);
+    
+    return usage > 1.0f ? 1.0f : usage;
+}
+
+/**
+ * 获取已缓冲时长和容量
+ */
+player_error_t linx_player_get_buffer_level(linx_player_t* player, int* buffered_ms, int* capacity_ms) {
+    if (!player) {
+        return PLAYER_ERROR_INVALID_PARAM;
+    }
+    if (!player->jitter_buffer) {
+        return PLAYER_ERROR_NOT_INITIALIZED;
+    }
+    
+    if (buffered_ms) {
+        *buffered_ms = player_queued_ms(player);
+    }
+    if (capacity_ms) {
+        *capacity_ms = linx_jitter_buffer_capacity_ms(player->jitter_buffer);
+    }
     
-    return usage;
+    return PLAYER_SUCCESS;
 }
 
 /**
@@ -376,11 +611,91 @@ player_error_t linx_player_clear_buffer(linx_player_t* player) {
         return PLAYER_ERROR_INVALID_PARAM;
     }
     
-    pthread_mutex_lock(&player->buffer_mutex);
-    player->buffer_head = 0;
-    player->buffer_tail = 0;
-    player->buffer_count = 0;
-    pthread_mutex_unlock(&player->buffer_mutex);
+    // 持有 buffer_mutex 时本线程就是包队列的消费方
+    linx_deadline_lock(&player->buffer_lock, &player->buffer_mutex);
+    if (player->feed_queue) {
+        while (linx_packet_queue_peek(player->feed_queue)) {
+            linx_packet_queue_pop(player->feed_queue);
+        }
+    }
+    linx_jitter_buffer_clear(player->jitter_buffer);
+    player_publish_depth(player);
+    // 新的一段流从下一个包重新同步时间戳
+    player->has_expected_timestamp = false;
+    player->pull_pcm_discard = true;
+    player->bridge_discard = true;
+    linx_deadline_unlock(&player->buffer_lock, &player->buffer_mutex);
+    
+    // 已解码、还没写入设备的周期由输出线程丢弃
+    __atomic_fetch_add(&player->ahead_generation, 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&player->position_has_timestamp, false, __ATOMIC_RELEASE);
+    
+    return PLAYER_SUCCESS;
+}
+
+/**
+ * 清空播放缓冲区和音频设备中排队的PCM
+ */
+player_error_t linx_player_flush(linx_player_t* player) {
+    player_error_t ret = linx_player_clear_buffer(player);
+    if (ret != PLAYER_SUCCESS) {
+        return ret;
+    }
+    
+    // 拉模式下设备直接向播放器取数据，没有额外的排队
+    if (!player->pull_active) {
+        audio_interface_flush_play(player->audio_interface);
+    }
+    __atomic_store_n(&player->volume_fade_in, true, __ATOMIC_RELEASE);
+    return PLAYER_SUCCESS;
+}
+
+/**
+ * 获取播放位置和输出延迟
+ */
+player_error_t linx_player_get_position(linx_player_t* player, linx_player_position_t* position) {
+    if (!player || !position) {
+        return PLAYER_ERROR_INVALID_PARAM;
+    }
+    
+    if (!player->initialized) {
+        return PLAYER_ERROR_NOT_INITIALIZED;
+    }
+    
+    memset(position, 0, sizeof(*position));
+    uint32_t delay_us = 0;
+    position->device_delay = audio_interface_get_play_delay(player->audio_interface, &delay_us) == 0;
+    position->output_delay_us = position->device_delay ? delay_us : 0;
+    
+    // 写入方先更新时间戳再增加帧数，这里反过来读，两者最多差一次写入
+    position->frames_written = __atomic_load_n(&player->position_frames, __ATOMIC_ACQUIRE);
+    uint64_t delay_frames = (uint64_t)position->output_delay_us * (uint64_t)player->config.sample_rate / 1000000u;
+    position->frames_played = position->frames_written > delay_frames ? position->frames_written - delay_frames : 0;
+    if (__atomic_load_n(&player->position_has_timestamp, __ATOMIC_ACQUIRE)) {
+        position->timestamp = __atomic_load_n(&player->position_timestamp, __ATOMIC_RELAXED) -
+                              position->output_delay_us / 1000u;
+        position->has_timestamp = true;
+    }
+    return PLAYER_SUCCESS;
+}
+
+/**
+ * 获取抖动缓冲区统计信息
+ */
+player_error_t linx_player_get_jitter_stats(linx_player_t* player, linx_jitter_buffer_stats_t* stats) {
+    if (!player || !stats) {
+        return PLAYER_ERROR_INVALID_PARAM;
+    }
+    
+    if (!player->jitter_buffer) {
+        return PLAYER_ERROR_NOT_INITIALIZED;
+    }
+    
+    linx_deadline_lock(&player->buffer_lock, &player->buffer_mutex);
+    player_drain_feed(player);
+    linx_jitter_buffer_get_stats(player->jitter_buffer, stats);
+    player_publish_depth(player);
+    linx_deadline_unlock(&player->buffer_lock, &player->buffer_mutex);
     
     return PLAYER_SUCCESS;
 }
@@ -393,257 +708,1581 @@ player_error_t linx_player_get_stats(linx_player_t* player, size_t* total_bytes,
         return PLAYER_ERROR_INVALID_PARAM;
     }
     
-    pthread_mutex_lock(&player->state_mutex);
     if (total_bytes) {
-        *total_bytes = player->total_bytes_played;
+        *total_bytes = __atomic_load_n(&player->total_bytes_played, __ATOMIC_RELAXED);
     }
     if (total_frames) {
-        *total_frames = player->total_frames_played;
+        *total_frames = __atomic_load_n(&player->total_frames_played, __ATOMIC_RELAXED);
     }
-    pthread_mutex_unlock(&player->state_mutex);
     
     return PLAYER_SUCCESS;
 }
 
 /**
- * 销毁播放器实例
+ * 获取解码超前队列的状态
  */
-void linx_player_destroy(linx_player_t* player) {
+player_error_t linx_player_get_decode_ahead(linx_player_t* player, size_t* queued, size_t* capacity,
+                                            size_t* starved) {
     if (!player) {
-        return;
+        return PLAYER_ERROR_INVALID_PARAM;
     }
     
-    // 停止播放
-    linx_player_stop(player);
-    
-    // 销毁音频接口
-    if (player->audio_interface) {
-        audio_interface_destroy(player->audio_interface);
+    if (queued) {
+        *queued = player->ahead_ring ? linx_pcm_ring_count(player->ahead_ring) : 0;
     }
-    
-    // 释放缓冲区
-    if (player->audio_buffer) {
-        free(player->audio_buffer);
+    if (capacity) {
+        *capacity = player->ahead_ring ? linx_pcm_ring_capacity(player->ahead_ring) : 0;
+    }
+    if (starved) {
+        *starved = __atomic_load_n(&player->ahead_starved, __ATOMIC_RELAXED);
     }
     
-    // 销毁同步对象
-    pthread_mutex_destroy(&player->state_mutex);
-    pthread_mutex_destroy(&player->buffer_mutex);
-    pthread_cond_destroy(&player->buffer_cond);
+    return PLAYER_SUCCESS;
+}
+
+/**
+ * 设置运行指标记录器
+ */
+player_error_t linx_player_set_metrics(linx_player_t* player, struct linx_metrics* metrics) {
+    if (!player) {
+        return PLAYER_ERROR_INVALID_PARAM;
+    }
     
-    free(player);
-    LOG_INFO("Player destroyed");
+    player->metrics = metrics;
+    return PLAYER_SUCCESS;
 }
 
 /**
- * 获取错误描述字符串
+ * 设置对话时间线
  */
-const char* linx_player_error_string(player_error_t error) {
-    switch (error) {
-        case PLAYER_SUCCESS:
-            return "Success";
-        case PLAYER_ERROR_INVALID_PARAM:
-            return "Invalid parameter";
-        case PLAYER_ERROR_NOT_INITIALIZED:
-            return "Player not initialized";
-        case PLAYER_ERROR_AUDIO_INTERFACE:
-            return "Audio interface error";
-        case PLAYER_ERROR_CODEC:
-            return "Codec error";
-        case PLAYER_ERROR_THREAD:
-            return "Thread error";
-        case PLAYER_ERROR_BUFFER_FULL:
-            return "Buffer full";
-        case PLAYER_ERROR_INVALID_STATE:
-            return "Invalid state";
-        default:
-            return "Unknown error";
+player_error_t linx_player_set_trace(linx_player_t* player, struct linx_trace* trace) {
+    if (!player) {
+        return PLAYER_ERROR_INVALID_PARAM;
     }
+    
+    player->trace = trace;
+    return PLAYER_SUCCESS;
 }
 
-// 内部函数实现
+/**
+ * 获取丢包恢复统计信息
+ */
+player_error_t linx_player_get_loss_stats(linx_player_t* player, size_t* concealed_frames, size_t* recovered_frames) {
+    if (!player) {
+        return PLAYER_ERROR_INVALID_PARAM;
+    }
+    
+    if (concealed_frames) {
+        *concealed_frames = __atomic_load_n(&player->concealed_frames, __ATOMIC_RELAXED);
+    }
+    if (recovered_frames) {
+        *recovered_frames = __atomic_load_n(&player->recovered_frames, __ATOMIC_RELAXED);
+    }
+    
+    return PLAYER_SUCCESS;
+}
 
 /**
- * 播放线程函数
+ * 播放本地提示音
  */
-static void* playback_thread_func(void* arg) {
-    linx_player_t* player = (linx_player_t*)arg;
-    uint8_t encoded_buffer[DECODE_BUFFER_SIZE];
-    int16_t decoded_buffer[DECODE_BUFFER_SIZE];
-    size_t buffer_monitor_counter = 0;  // 缓冲区监控计数器
+player_error_t linx_player_play_sound(linx_player_t* player, const int16_t* pcm, size_t samples,
+                                      float volume, bool duck, uint32_t* sound_id) {
+    if (sound_id) {
+        *sound_id = 0;
+    }
     
-    LOG_INFO("🎵 播放线程已启动");
+    if (!player || !pcm || samples == 0 || !(volume >= 0.0f)) {
+        return PLAYER_ERROR_INVALID_PARAM;
+    }
     
-    while (player->running) {
-        pthread_mutex_lock(&player->state_mutex);
-        player_state_t current_state = player->state;
-        pthread_mutex_unlock(&player->state_mutex);
-        
-        // 每1000次循环打印一次缓冲区状态
-        buffer_monitor_counter++;
-        if (buffer_monitor_counter % 1000 == 0) {
-            pthread_mutex_lock(&player->buffer_mutex);
-            float usage = (float)player->buffer_count / (float)player->buffer_capacity * 100.0f;
-            LOG_INFO("📊 缓冲区状态: %zu/%zu 字节 (%.1f%% 使用率)", 
-                    player->buffer_count, player->buffer_capacity, usage);
-            pthread_mutex_unlock(&player->buffer_mutex);
-        }
-        
-        // 如果暂停，等待恢复
-        if (current_state == PLAYER_STATE_PAUSED) {
-            pthread_mutex_lock(&player->buffer_mutex);
-            pthread_cond_wait(&player->buffer_cond, &player->buffer_mutex);
-            pthread_mutex_unlock(&player->buffer_mutex);
-            continue;
-        }
-        
-        // 如果不是播放状态，休眠后继续
-        if (current_state != PLAYER_STATE_PLAYING) {
-            usleep(PLAYBACK_THREAD_SLEEP_US);
-            continue;
-        }
-        
-        // 从缓冲区读取数据
-        pthread_mutex_lock(&player->buffer_mutex);
-        
-        // 如果缓冲区为空，等待数据
-        if (player->buffer_count == 0) {
-            LOG_DEBUG("播放缓冲区为空，等待数据...");
-            pthread_cond_wait(&player->buffer_cond, &player->buffer_mutex);
-            pthread_mutex_unlock(&player->buffer_mutex);
-            continue;
-        }
-        
-        // 读取一帧编码数据（简化处理，假设每次读取固定大小）
-        size_t to_read = (player->buffer_count < sizeof(encoded_buffer)) ? 
-                        player->buffer_count : sizeof(encoded_buffer);
-        size_t read_size = circular_buffer_read(player, encoded_buffer, to_read);
-        
-        LOG_DEBUG("从缓冲区读取 %zu 字节数据，缓冲区剩余: %zu 字节", 
-                 read_size, player->buffer_count);
-        pthread_mutex_unlock(&player->buffer_mutex);
-        
-        if (read_size > 0) {
-            // 解码音频数据
-            size_t decoded_size = 0;
-            if (audio_codec_decode(player->decoder, encoded_buffer, read_size,
-                                 decoded_buffer, sizeof(decoded_buffer)/sizeof(int16_t), 
-                                 &decoded_size) == CODEC_SUCCESS) {
-                
-                LOG_DEBUG("解码成功: %zu 字节编码数据 -> %zu 个样本", read_size, decoded_size);
-                
-                // 播放解码后的音频
-                if (audio_interface_write(player->audio_interface, decoded_buffer, decoded_size) == 0) {
-                    // 更新统计信息
-                    pthread_mutex_lock(&player->state_mutex);
-                    player->total_bytes_played += read_size;
-                    player->total_frames_played++;
-                    
-                    // 每播放100帧打印一次统计信息
-                    if (player->total_frames_played % 100 == 0) {
-                        LOG_INFO("播放统计: 已播放 %zu 字节, %zu 帧", 
-                                player->total_bytes_played, player->total_frames_played);
-                    }
-                    pthread_mutex_unlock(&player->state_mutex);
-                    
-                    LOG_DEBUG("音频数据写入成功: %zu 个样本", decoded_size);
-                } else {
-                    LOG_ERROR("✗ 音频数据写入失败");
-                }
-            } else {
-                LOG_ERROR("✗ 音频解码失败: %zu 字节数据", read_size);
-            }
+    if (volume > PLAYER_SOUND_MAX_VOLUME) {
+        volume = PLAYER_SOUND_MAX_VOLUME;
+    }
+    
+    pthread_mutex_lock(&player->sound_mutex);
+    player_sound_voice_t* voice = NULL;
+    for (size_t i = 0; i < LINX_PLAYER_MAX_SOUNDS; i++) {
+        if (player->sounds[i].id == 0) {
+            voice = &player->sounds[i];
+            break;
         }
-        
-        // 短暂休眠避免过度占用CPU
-        usleep(PLAYBACK_THREAD_SLEEP_US);
+    }
+    if (!voice) {
+        pthread_mutex_unlock(&player->sound_mutex);
+        LOG_WARN("同时播放的提示音已满（%d 个）", LINX_PLAYER_MAX_SOUNDS);
+        return PLAYER_ERROR_BUFFER_FULL;
     }
     
-    LOG_INFO("Playback thread ended");
-    return NULL;
+    if (++player->next_sound_id == 0) {
+        player->next_sound_id = 1;
+    }
+    voice->pcm = pcm;
+    voice->samples = samples;
+    voice->position = 0;
+    voice->gain_q15 = (int32_t)(volume * PLAYER_GAIN_UNITY);
+    voice->duck = duck;
+    voice->id = player->next_sound_id;
+    if (sound_id) {
+        *sound_id = voice->id;
+    }
+    __atomic_store_n(&player->sounds_active, true, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&player->sound_mutex);
+    
+    // 空闲的播放线程需要醒来单独输出提示音
+    wake_playback_thread(player);
+    return PLAYER_SUCCESS;
 }
 
 /**
- * 改变播放器状态
+ * 停止提示音
  */
-static player_error_t change_state(linx_player_t* player, player_state_t new_state) {
-    player_state_t old_state = player->state;
-    player->state = new_state;
-    
-    // 调用事件回调
-    if (player->event_callback) {
-        player->event_callback(old_state, new_state, player->callback_user_data);
+player_error_t linx_player_stop_sound(linx_player_t* player, uint32_t sound_id) {
+    if (!player) {
+        return PLAYER_ERROR_INVALID_PARAM;
     }
     
+    pthread_mutex_lock(&player->sound_mutex);
+    bool active = false;
+    for (size_t i = 0; i < LINX_PLAYER_MAX_SOUNDS; i++) {
+        player_sound_voice_t* voice = &player->sounds[i];
+        if (voice->id != 0 && (sound_id == 0 || voice->id == sound_id)) {
+            voice->id = 0;
+            voice->pcm = NULL;
+        }
+        active = active || voice->id != 0;
+    }
+    __atomic_store_n(&player->sounds_active, active, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&player->sound_mutex);
     return PLAYER_SUCCESS;
 }
 
 /**
- * 环形缓冲区写入
+ * 提示音是否还在播放
  */
-static size_t circular_buffer_write(linx_player_t* player, const uint8_t* data, size_t size) {
-    size_t available = circular_buffer_available_space(player);
-    size_t to_write = (size < available) ? size : available;
-    
-    if (to_write == 0) {
-        return 0;
+bool linx_player_is_sound_playing(linx_player_t* player, uint32_t sound_id) {
+    if (!player || !player_sounds_pending(player)) {
+        return false;
     }
-    
-    // 处理环形缓冲区的边界情况
-    size_t first_part = player->buffer_capacity - player->buffer_head;
-    if (to_write <= first_part) {
-        // 数据可以一次性写入
-        memcpy(player->audio_buffer + player->buffer_head, data, to_write);
-        player->buffer_head = (player->buffer_head + to_write) % player->buffer_capacity;
-    } else {
-        // 需要分两次写入
-        memcpy(player->audio_buffer + player->buffer_head, data, first_part);
-        memcpy(player->audio_buffer, data + first_part, to_write - first_part);
-        player->buffer_head = to_write - first_part;
+    if (sound_id == 0) {
+        return true;
     }
     
-    player->buffer_count += to_write;
-    return to_write;
+    pthread_mutex_lock(&player->sound_mutex);
+    bool playing = false;
+    for (size_t i = 0; i < LINX_PLAYER_MAX_SOUNDS; i++) {
+        playing = playing || player->sounds[i].id == sound_id;
+    }
+    pthread_mutex_unlock(&player->sound_mutex);
+    return playing;
 }
 
 /**
- * 环形缓冲区读取
+ * 打开附加播放流
  */
-static size_t circular_buffer_read(linx_player_t* player, uint8_t* data, size_t size) {
-    size_t available = circular_buffer_available_data(player);
-    size_t to_read = (size < available) ? size : available;
-    
-    if (to_read == 0) {
-        return 0;
+linx_mixer_stream_t* linx_player_open_stream(linx_player_t* player, const linx_mixer_stream_config_t* config) {
+    if (!player || !config || !config->decoder) {
+        return NULL;
+    }
+    if (!player->initialized) {
+        LOG_ERROR("播放器未初始化，无法打开播放流");
+        return NULL;
     }
     
-    // 处理环形缓冲区的边界情况
-    size_t first_part = player->buffer_capacity - player->buffer_tail;
-    if (to_read <= first_part) {
-        // 数据可以一次性读取
-        memcpy(data, player->audio_buffer + player->buffer_tail, to_read);
-        player->buffer_tail = (player->buffer_tail + to_read) % player->buffer_capacity;
-    } else {
-        // 需要分两次读取
-        memcpy(data, player->audio_buffer + player->buffer_tail, first_part);
-        memcpy(data + first_part, player->audio_buffer, to_read - first_part);
-        player->buffer_tail = to_read - first_part;
+    // 第一次打开时创建混音器；解码方无锁读取指针，发布之后不再改变
+    pthread_mutex_lock(&player->state_mutex);
+    if (!player->mixer) {
+        linx_mixer_config_t mixer_config = {0};
+        mixer_config.sample_rate = player->config.sample_rate;
+        mixer_config.channels = player->config.channels;
+        mixer_config.duck_db = player->config.stream_duck_db;
+        __atomic_store_n(&player->mixer, linx_mixer_create(&mixer_config), __ATOMIC_RELEASE);
     }
+    linx_mixer_t* mixer = player->mixer;
+    pthread_mutex_unlock(&player->state_mutex);
     
-    player->buffer_count -= to_read;
-    return to_read;
+    linx_mixer_stream_t* stream = mixer ? linx_mixer_open(mixer, config) : NULL;
+    if (!stream) {
+        LOG_WARN("无法打开播放流（同时最多 %d 路）", LINX_MIXER_MAX_STREAMS);
+    }
+    return stream;
 }
 
 /**
- * 获取环形缓冲区可用空间
+ * 关闭附加播放流
  */
-static size_t circular_buffer_available_space(linx_player_t* player) {
-    return player->buffer_capacity - player->buffer_count;
+void linx_player_close_stream(linx_player_t* player, linx_mixer_stream_t* stream) {
+    if (!player || !stream) {
+        return;
+    }
+    linx_mixer_close(player_mixer(player), stream);
+}
+
+/**
+ * 向附加播放流放入编码包
+ */
+player_error_t linx_player_stream_feed(linx_player_t* player, linx_mixer_stream_t* stream,
+                                       const uint8_t* data, size_t size) {
+    if (!player || !stream || !data || size == 0) {
+        return PLAYER_ERROR_INVALID_PARAM;
+    }
+    bool was_empty = false;
+    if (!linx_mixer_feed(stream, data, size, &was_empty)) {
+        return PLAYER_ERROR_BUFFER_FULL;
+    }
+    // 空闲的播放线程需要醒来单独输出流的音频
+    if (was_empty) {
+        wake_playback_thread(player);
+    }
+    return PLAYER_SUCCESS;
 }
 
 /**
- * 获取环形缓冲区可用数据
+ * 设置附加播放流的增益
  */
-static size_t circular_buffer_available_data(linx_player_t* player) {
-    return player->buffer_count;
-}
\ No newline at end of file
+player_error_t linx_player_set_stream_gain(linx_player_t* player, linx_mixer_stream_t* stream, float gain) {
+    if (!player || !stream || !(gain >= 0.0f)) {
+        return PLAYER_ERROR_INVALID_PARAM;
+    }
+    linx_mixer_stream_set_gain(player_mixer(player), stream, gain);
+    return PLAYER_SUCCESS;
+}
+
+/**
+ * 附加播放流是否还有未播完的音频
+ */
+bool linx_player_is_stream_playing(linx_player_t* player, linx_mixer_stream_t* stream) {
+    if (!player || !stream) {
+        return false;
+    }
+    return linx_mixer_stream_is_playing(player_mixer(player), stream);
+}
+
+/* dB 转为千分之一 dB，静音统一存为下限 */
+static int32_t volume_db_to_mdb(float db) {
+    if (!(db > LINX_PLAYER_VOLUME_MIN_DB)) {
+        return (int32_t)(LINX_PLAYER_VOLUME_MIN_DB * 1000.0f);
+    }
+    if (db > LINX_PLAYER_VOLUME_MAX_DB) {
+        db = LINX_PLAYER_VOLUME_MAX_DB;
+    }
+    return (int32_t)lrintf(db * 1000.0f);
+}
+
+/**
+ * 设置软件音量（百分比）
+ */
+player_error_t linx_player_set_volume(linx_player_t* player, int percent) {
+    if (!player || percent < 0 || percent > 100) {
+        return PLAYER_ERROR_INVALID_PARAM;
+    }
+    
+    float db = percent == 0 ? LINX_PLAYER_VOLUME_MIN_DB : 40.0f * log10f((float)percent / 100.0f);
+    return linx_player_set_volume_db(player, db);
+}
+
+/**
+ * 设置软件音量（dB）
+ */
+player_error_t linx_player_set_volume_db(linx_player_t* player, float db) {
+    if (!player) {
+        return PLAYER_ERROR_INVALID_PARAM;
+    }
+    
+    __atomic_store_n(&player->volume_mdb, volume_db_to_mdb(db), __ATOMIC_RELAXED);
+    return PLAYER_SUCCESS;
+}
+
+/**
+ * 获取软件音量的目标值（dB）
+ */
+float linx_player_get_volume_db(linx_player_t* player) {
+    if (!player) {
+        return LINX_PLAYER_VOLUME_MIN_DB;
+    }
+    return (float)__atomic_load_n(&player->volume_mdb, __ATOMIC_RELAXED) / 1000.0f;
+}
+
+/**
+ * 标记当前回复是否还有后续音频
+ */
+player_error_t linx_player_set_continuation(linx_player_t* player, bool continuing) {
+    if (!player) {
+        return PLAYER_ERROR_INVALID_PARAM;
+    }
+    
+    // 新的回复不沿用上一段的尾音；回复结束时正在进行的衔接照常淡出
+    if (!__atomic_exchange_n(&player->continuing, continuing, __ATOMIC_ACQ_REL) && continuing) {
+        linx_deadline_lock(&player->buffer_lock, &player->buffer_mutex);
+        player->bridge_discard = true;
+        linx_deadline_unlock(&player->buffer_lock, &player->buffer_mutex);
+    }
+    return PLAYER_SUCCESS;
+}
+
+/**
+ * 压低全部输出
+ */
+player_error_t linx_player_set_duck(linx_player_t* player, float attenuation_db) {
+    if (!player || attenuation_db < 0.0f) {
+        return PLAYER_ERROR_INVALID_PARAM;
+    }
+    
+    int32_t mdb = attenuation_db > -LINX_PLAYER_VOLUME_MIN_DB ? (int32_t)(-LINX_PLAYER_VOLUME_MIN_DB * 1000.0f)
+                                                              : (int32_t)lrintf(attenuation_db * 1000.0f);
+    __atomic_store_n(&player->external_duck_mdb, mdb, __ATOMIC_RELAXED);
+    return PLAYER_SUCCESS;
+}
+
+/**
+ * 销毁播放器实例
+ */
+void linx_player_destroy(linx_player_t* player) {
+    if (!player) {
+        return;
+    }
+    
+    // 停止播放
+    linx_player_stop(player);
+    
+    // 销毁音频接口
+    if (player->audio_interface) {
+        audio_interface_destroy(player->audio_interface);
+    }
+    
+    // 释放抖动缓冲区（音频接口已销毁，设备回调不会再访问）
+    linx_deadline_destroy(player->deadline);
+    linx_deadline_lock_unregister(&player->buffer_lock);
+    linx_jitter_buffer_destroy(player->jitter_buffer);
+    linx_packet_queue_destroy(player->feed_queue);
+    release_pull_buffers(player);
+    release_decode_ahead(player);
+    linx_mixer_destroy(player->mixer);
+    LINX_FREE(player->process_packet);
+    LINX_FREE(player->process_pcm);
+    LINX_FREE(player->bridge_pcm);
+    
+    // 销毁同步对象
+    pthread_mutex_destroy(&player->state_mutex);
+    pthread_mutex_destroy(&player->buffer_mutex);
+    linx_sem_destroy(player->wake_sem);
+    pthread_mutex_destroy(&player->sound_mutex);
+    
+    LINX_FREE(player);
+    LOG_INFO("Player destroyed");
+}
+
+/**
+ * 获取错误描述字符串
+ */
+const char* linx_player_error_string(player_error_t error) {
+    switch (error) {
+        case PLAYER_SUCCESS:
+            return "Success";
+        case PLAYER_ERROR_INVALID_PARAM:
+            return "Invalid parameter";
+        case PLAYER_ERROR_NOT_INITIALIZED:
+            return "Player not initialized";
+        case PLAYER_ERROR_AUDIO_INTERFACE:
+            return "Audio interface error";
+        case PLAYER_ERROR_CODEC:
+            return "Codec error";
+        case PLAYER_ERROR_THREAD:
+            return "Thread error";
+        case PLAYER_ERROR_BUFFER_FULL:
+            return "Buffer full";
+        case PLAYER_ERROR_INVALID_STATE:
+            return "Invalid state";
+        default:
+            return "Unknown error";
+    }
+}
+
+// 内部函数实现
+
+/**
+ * 播放线程函数
+ */
+static void* playback_thread_func(void* arg) {
+    linx_player_t* player = (linx_player_t*)arg;
+    uint8_t encoded_buffer[DECODE_BUFFER_SIZE];
+    int16_t decoded_buffer[DECODE_BUFFER_SIZE];
+    int frame_ms = player->config.sample_rate > 0 ?
+                   player->config.frame_size * 1000 / player->config.sample_rate : 0;
+    
+    linx_thread_stats_register("player", LINX_THREAD_STAGE_PLAYBACK);
+    LOG_INFO("🎵 播放线程已启动");
+    
+    // 循环节奏由音频设备决定：audio_interface_write 在设备缓冲区满时阻塞（解码超前时
+    // 在队列满时等待输出线程取走周期），没有可播放的包时在 wake_sem 上等待，不使用固定休眠
+    while (player_is_running(player)) {
+        // 暂停或尚未进入播放状态时，等待 resume/stop 唤醒（信号量保留唤醒，不会丢失）
+        if (player_load_state(player) != PLAYER_STATE_PLAYING) {
+            __atomic_store_n(&player->ahead_decoding, false, __ATOMIC_RELEASE);
+            if (!player->ahead_ring) {
+                linx_deadline_idle(player->deadline);
+            }
+            if (player_is_running(player)) {
+                linx_sem_take(player->wake_sem, -1);
+            }
+            continue;
+        }
+        __atomic_store_n(&player->ahead_decoding, true, __ATOMIC_RELEASE);
+        
+        // 从抖动缓冲区取出一个完整的编码包
+        size_t read_size = 0;
+        uint32_t timestamp = 0;
+        uint64_t now_ms = player_now_ms();
+        linx_deadline_lock(&player->buffer_lock, &player->buffer_mutex);
+        // 解码超前队列里还有周期时，抖动缓冲区没包或队首之前缺包只是解码跑在了前面：
+        // 等新包（或迟到的包）到达、或队列快要播完再取，欠载、衔接和丢包补齐的判断
+        // 与不超前解码时在同一时刻发生，抖动缓冲区等待迟到包的时间不会被超前的周期占用
+        size_t ahead = player->ahead_ring ? linx_pcm_ring_count(player->ahead_ring) : 0;
+        if (ahead > 0) {
+            player_drain_feed(player);
+            if (!linx_jitter_buffer_head_in_order(player->jitter_buffer)) {
+                linx_deadline_unlock(&player->buffer_lock, &player->buffer_mutex);
+                __atomic_store_n(&player->ahead_decoding, false, __ATOMIC_RELEASE);
+                wait_for_packets(player, (int)ahead * frame_ms - frame_ms / 2);
+                continue;
+            }
+        }
+        linx_jitter_result_t result = player_pop(player, encoded_buffer, sizeof(encoded_buffer),
+                                                 &read_size, &timestamp, now_ms);
+        int wait_ms = linx_jitter_buffer_wait_hint_ms(player->jitter_buffer, now_ms);
+        linx_deadline_unlock(&player->buffer_lock, &player->buffer_mutex);
+        
+        if (result == LINX_JITTER_EMPTY || result == LINX_JITTER_BUFFERING) {
+            // 回复中途欠载时用 PLC 衔接，由设备写入决定节奏
+            linx_alloc_no_alloc_enter();
+            bool bridged = result == LINX_JITTER_EMPTY &&
+                           bridge_gap(player, NULL, decoded_buffer, sizeof(decoded_buffer)/sizeof(int16_t));
+            linx_alloc_no_alloc_leave();
+            if (bridged) {
+                continue;
+            }
+            // 没有 TTS 时单独输出附加播放流（提示音在同一帧混入）
+            if (player_streams_pending(player)) {
+                linx_alloc_no_alloc_enter();
+                play_stream_frame(player, decoded_buffer, sizeof(decoded_buffer)/sizeof(int16_t));
+                linx_alloc_no_alloc_leave();
+                continue;
+            }
+            // 没有 TTS 时单独输出提示音，由设备写入决定节奏（解码超前时由输出线程输出）
+            if (!player->ahead_ring && player_sounds_pending(player)) {
+                linx_alloc_no_alloc_enter();
+                play_sound_frame(player, decoded_buffer, sizeof(decoded_buffer)/sizeof(int16_t));
+                linx_alloc_no_alloc_leave();
+                continue;
+            }
+            // 缓冲区为空时等待新包；预缓冲中最多等待到可以开始出队
+            __atomic_store_n(&player->ahead_decoding, false, __ATOMIC_RELEASE);
+            wait_for_packets(player, wait_ms);
+            continue;
+        }
+        
+        if (result != LINX_JITTER_OK) {
+            LOG_WARN("丢弃超长音频包: %zu 字节", read_size);
+            continue;
+        }
+        
+        if (read_size == 0) {
+            continue;
+        }
+        
+        // 解码、丢包补齐和写设备都在预分配的缓冲区上完成
+        linx_alloc_no_alloc_enter();
+        play_packet(player, encoded_buffer, read_size, timestamp,
+                    decoded_buffer, sizeof(decoded_buffer)/sizeof(int16_t));
+        linx_alloc_no_alloc_leave();
+    }
+    
+    LOG_INFO("Playback thread ended");
+    if (!player->ahead_ring) {
+        linx_deadline_idle(player->deadline);
+    }
+    linx_thread_stats_unregister();
+    return NULL;
+}
+
+/**
+ * 解码超前的输出线程：按设备节奏把队列中的周期写入音频接口
+ * 混入提示音和软件音量在这里完成，与播放线程的解码互不阻塞；队列为空时单独输出提示音
+ */
+static void* output_thread_func(void* arg) {
+    linx_player_t* player = (linx_player_t*)arg;
+    size_t period_samples = linx_pcm_ring_period_samples(player->ahead_ring);
+    
+    linx_thread_stats_register("player_out", LINX_THREAD_STAGE_PLAYBACK);
+    
+    while (player_is_running(player)) {
+        if (player_load_state(player) != PLAYER_STATE_PLAYING) {
+            linx_deadline_idle(player->deadline);
+            if (player_is_running(player)) {
+                linx_sem_take(player->ahead_data_sem, -1);
+            }
+            continue;
+        }
+        
+        const linx_pcm_ring_period_t* period = linx_pcm_ring_peek(player->ahead_ring);
+        if (!period) {
+            // 刚才还在输出而播放线程并不缺包：解码没能赶上设备，这次的尖峰没有被吸收
+            if (player->ahead_streaming && __atomic_load_n(&player->ahead_decoding, __ATOMIC_ACQUIRE)) {
+                __atomic_fetch_add(&player->ahead_starved, 1, __ATOMIC_RELAXED);
+                linx_metrics_add(player->metrics, LINX_METRIC_DECODE_AHEAD_STARVED, 1);
+                LOG_DEBUG_EVERY_MS(1000, "解码超前队列播空");
+            }
+            player->ahead_streaming = false;
+            if (player_sounds_pending(player)) {
+                linx_alloc_no_alloc_enter();
+                play_sound_frame(player, player->ahead_pcm, period_samples);
+                linx_alloc_no_alloc_leave();
+                continue;
+            }
+            linx_deadline_idle(player->deadline);
+            linx_sem_take(player->ahead_data_sem, -1);
+            continue;
+        }
+        
+        // 清空之前解码的周期直接丢弃
+        if (period->generation != __atomic_load_n(&player->ahead_generation, __ATOMIC_ACQUIRE)) {
+            linx_pcm_ring_pop(player->ahead_ring);
+            linx_sem_give(player->ahead_space_sem);
+            continue;
+        }
+        
+        linx_metrics_record(player->metrics, LINX_METRIC_DECODE_AHEAD_DEPTH,
+                            (uint32_t)linx_pcm_ring_count(player->ahead_ring));
+        
+        // pop 之前周期归输出线程所有，就地混音和调音量
+        linx_alloc_no_alloc_enter();
+        int ret = write_output(player, period->pcm, period->samples,
+                               period->has_timestamp ? &period->timestamp : NULL, period->has_tts);
+        linx_alloc_no_alloc_leave();
+        linx_pcm_ring_pop(player->ahead_ring);
+        linx_sem_give(player->ahead_space_sem);
+        if (ret != 0) {
+            LOG_ERROR("✗ 音频数据写入失败");
+        }
+        player->ahead_streaming = ret == 0;
+    }
+    
+    linx_deadline_idle(player->deadline);
+    linx_thread_stats_unregister();
+    return NULL;
+}
+
+/**
+ * 解码一个包并写入音频接口（推模式：播放线程或外部循环）
+ */
+static void play_packet(linx_player_t* player, const uint8_t* packet, size_t size, uint32_t timestamp,
+                        int16_t* pcm, size_t pcm_size) {
+    // 补齐当前包之前丢失的帧，保持播放时间连续
+    if (player->config.conceal_loss) {
+        conceal_lost_frames(player, NULL, timestamp, packet, size, pcm, pcm_size);
+    }
+    
+    // 解码音频数据（衔接过空档时先生成交叉淡化用的 PLC）
+    size_t crossfade = bridge_prepare(player);
+    size_t decoded_size = 0;
+    uint64_t decode_start_us = player->metrics ? linx_metrics_now_us() : 0;
+    linx_deadline_activity("decode");
+    LINX_TRACEPOINT_BEGIN(player_decode);
+    if (audio_codec_decode(player->decoder, packet, size, pcm, pcm_size, &decoded_size) != CODEC_SUCCESS) {
+        LINX_TRACEPOINT_END(player_decode, size, 0);
+        LOG_ERROR("✗ 音频解码失败: %zu 字节数据", size);
+        return;
+    }
+    LINX_TRACEPOINT_END(player_decode, size, decoded_size);
+    if (player->metrics) {
+        linx_metrics_record(player->metrics, LINX_METRIC_DECODE_TIME,
+                            (uint32_t)(linx_metrics_now_us() - decode_start_us));
+    }
+    bridge_finish(player, pcm, decoded_size, crossfade);
+    
+    // 混入提示音、调节音量后播放（阻塞直到设备或解码超前队列有空间）
+    if (push_output(player, pcm, decoded_size, &timestamp) != 0) {
+        LOG_ERROR("✗ 音频数据写入失败");
+        return;
+    }
+    
+    __atomic_fetch_add(&player->total_bytes_played, size, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&player->total_frames_played, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * 混入提示音、调节音量后写入音频接口（阻塞直到设备有空间），再送给输出抽头
+ */
+static int write_output(linx_player_t* player, int16_t* pcm, size_t samples, const uint32_t* timestamp,
+                        bool has_tts) {
+    linx_deadline_activity("mix");
+    process_output(player, pcm, samples);
+    linx_deadline_activity("device_write");
+    LINX_TRACEPOINT_BEGIN(player_write);
+    int written = audio_interface_write(player->audio_interface, pcm, samples);
+    LINX_TRACEPOINT_END(player_write, samples, 0);
+    if (written < 0) {
+        return -1;
+    }
+    tick_deadline(player, samples);
+    note_written(player, samples, timestamp);
+    if (has_tts) {
+        linx_metrics_stage_end(player->metrics, LINX_METRIC_TTS_TO_PLAYBACK);
+        linx_trace_mark_first(player->trace, LINX_TRACE_FIRST_PLAYBACK);
+    }
+    call_output_tap(player, pcm, samples, timestamp);
+    return 0;
+}
+
+/**
+ * 推模式输出一段解码后的 TTS PCM：混入附加播放流后放入队列或写入音频接口
+ * @param timestamp pcm[0] 的流时间戳，未知时为 NULL
+ */
+static int push_output(linx_player_t* player, int16_t* pcm, size_t samples, const uint32_t* timestamp) {
+    linx_mixer_t* mixer = player_mixer(player);
+    if (mixer) {
+        linx_mixer_mix(mixer, pcm, samples, true);
+    }
+    return enqueue_output(player, pcm, samples, timestamp, true);
+}
+
+/**
+ * 推模式输出一段已混音的PCM
+ * 开启解码超前时按周期复制到队列（队列满时等待输出线程取走，超过一个周期的段拆开放入，
+ * 时间戳顺延），否则直接写入音频接口
+ * @param timestamp pcm[0] 的流时间戳，未知时为 NULL
+ */
+static int enqueue_output(linx_player_t* player, int16_t* pcm, size_t samples, const uint32_t* timestamp,
+                          bool has_tts) {
+    if (!player->ahead_ring) {
+        return write_output(player, pcm, samples, timestamp, has_tts);
+    }
+    
+    size_t period_samples = linx_pcm_ring_period_samples(player->ahead_ring);
+    size_t channels = player->config.channels > 0 ? (size_t)player->config.channels : 1;
+    uint32_t generation = __atomic_load_n(&player->ahead_generation, __ATOMIC_ACQUIRE);
+    uint32_t period_timestamp = timestamp ? *timestamp : 0;
+    for (size_t offset = 0; offset < samples; ) {
+        linx_pcm_ring_period_t* period;
+        while ((period = linx_pcm_ring_acquire(player->ahead_ring)) == NULL) {
+            if (!player_is_running(player)) {
+                return -1;
+            }
+            // 等待期间不算在解码，不计入输出线程的播空统计
+            __atomic_store_n(&player->ahead_decoding, false, __ATOMIC_RELEASE);
+            linx_sem_take(player->ahead_space_sem, -1);
+            __atomic_store_n(&player->ahead_decoding, true, __ATOMIC_RELEASE);
+        }
+        
+        size_t count = samples - offset < period_samples ? samples - offset : period_samples;
+        memcpy(period->pcm, pcm + offset, count * sizeof(int16_t));
+        period->samples = count;
+        period->timestamp = period_timestamp;
+        period->has_timestamp = timestamp != NULL;
+        period->generation = generation;
+        period->has_tts = has_tts;
+        linx_pcm_ring_commit(player->ahead_ring);
+        linx_sem_give(player->ahead_data_sem);
+        
+        offset += count;
+        if (player->config.sample_rate > 0) {
+            period_timestamp += (uint32_t)(count / channels * 1000 / (size_t)player->config.sample_rate);
+        }
+    }
+    return 0;
+}
+
+/**
+ * 外部循环模式下播放已到期的包
+ */
+player_error_t linx_player_process(linx_player_t* player, size_t max_packets, int* next_timeout_ms) {
+    if (next_timeout_ms) {
+        *next_timeout_ms = -1;
+    }
+    
+    if (!player) {
+        return PLAYER_ERROR_INVALID_PARAM;
+    }
+    
+    if (!player->initialized) {
+        return PLAYER_ERROR_NOT_INITIALIZED;
+    }
+    
+    if (!player->process_pcm) {
+        return PLAYER_ERROR_INVALID_STATE;
+    }
+    
+    size_t played = 0;
+    while (max_packets == 0 || played < max_packets) {
+        if (!player_is_running(player) || player_load_state(player) != PLAYER_STATE_PLAYING) {
+            linx_deadline_idle(player->deadline);
+            break;
+        }
+        
+        size_t read_size = 0;
+        uint32_t timestamp = 0;
+        uint64_t now_ms = player_now_ms();
+        linx_deadline_lock(&player->buffer_lock, &player->buffer_mutex);
+        linx_jitter_result_t result = player_pop(player, player->process_packet, DECODE_BUFFER_SIZE,
+                                                 &read_size, &timestamp, now_ms);
+        if (result == LINX_JITTER_BUFFERING && next_timeout_ms) {
+            *next_timeout_ms = linx_jitter_buffer_wait_hint_ms(player->jitter_buffer, now_ms);
+        }
+        linx_deadline_unlock(&player->buffer_lock, &player->buffer_mutex);
+        
+        // 回复中途欠载时用 PLC 衔接，每一帧占用一次播放
+        if (result == LINX_JITTER_EMPTY && bridge_gap(player, NULL, player->process_pcm, DECODE_BUFFER_SIZE)) {
+            played++;
+            continue;
+        }
+        
+        if (result == LINX_JITTER_EMPTY || result == LINX_JITTER_BUFFERING) {
+            // 没有 TTS 时每次调用输出一帧附加播放流或提示音，还有剩余时请应用尽快再调用
+            if (player_streams_pending(player)) {
+                play_stream_frame(player, player->process_pcm, DECODE_BUFFER_SIZE);
+            } else if (player_sounds_pending(player)) {
+                play_sound_frame(player, player->process_pcm, DECODE_BUFFER_SIZE);
+            } else {
+                // 等待下一个包期间不计时
+                linx_deadline_idle(player->deadline);
+            }
+            if (next_timeout_ms && (player_streams_pending(player) || player_sounds_pending(player))) {
+                *next_timeout_ms = 0;
+            }
+            break;
+        }
+        
+        if (result != LINX_JITTER_OK) {
+            LOG_WARN("丢弃超长音频包: %zu 字节", read_size);
+            continue;
+        }
+        
+        if (read_size > 0) {
+            play_packet(player, player->process_packet, read_size, timestamp,
+                        player->process_pcm, DECODE_BUFFER_SIZE);
+            played++;
+        }
+    }
+    
+    // 达到本次上限时可能还有包等待播放，应尽快再次调用
+    if (max_packets > 0 && played == max_packets && next_timeout_ms) {
+        *next_timeout_ms = 0;
+    }
+    
+    return PLAYER_SUCCESS;
+}
+
+/**
+ * 根据时间戳补齐丢失的帧
+ * 缺失 N 帧时，前 N-1 帧用 PLC 生成，紧邻当前包的最后一帧用当前包携带的带内FEC数据恢复
+ * （编码端未开启FEC时 Opus 会自动退化为 PLC）。
+ * 没有时间戳的包按到达顺序排列，时间戳恒为 0，不会触发补齐。
+ * target 为 NULL 时写入音频接口，否则填充到拉模式的设备缓冲区。
+ */
+static void conceal_lost_frames(linx_player_t* player, pull_target_t* target, uint32_t timestamp,
+                                const uint8_t* next_packet, size_t next_size,
+                                int16_t* pcm, size_t pcm_size) {
+    int frame_ms = player->config.sample_rate > 0 ?
+                   player->config.frame_size * 1000 / player->config.sample_rate : 0;
+    if (frame_ms <= 0 || !audio_codec_supports_loss_recovery(player->decoder)) {
+        return;
+    }
+    
+    linx_deadline_lock(&player->buffer_lock, &player->buffer_mutex);
+    bool has_expected = player->has_expected_timestamp;
+    uint32_t expected = player->expected_timestamp;
+    player->expected_timestamp = timestamp + (uint32_t)frame_ms;
+    player->has_expected_timestamp = true;
+    linx_deadline_unlock(&player->buffer_lock, &player->buffer_mutex);
+    
+    if (!has_expected) {
+        return;
+    }
+    
+    // 有符号差值处理时间戳回绕；回退或间隔过大时直接重新同步
+    int32_t gap_ms = (int32_t)(timestamp - expected);
+    if (gap_ms < frame_ms) {
+        return;
+    }
+    
+    int missing = gap_ms / frame_ms;
+    if (missing > PLAYER_MAX_CONCEALED_FRAMES) {
+        LOG_WARN("音频流中断 %d ms，跳过丢包恢复", (int)gap_ms);
+        return;
+    }
+    
+    LOG_DEBUG_EVERY_MS(1000, "检测到丢失 %d 帧（时间戳 %u -> %u）", missing, expected, timestamp);
+    
+    size_t frame_samples = (size_t)player->config.frame_size;
+    size_t concealed = 0;
+    size_t recovered = 0;
+    for (int i = 0; i < missing; i++) {
+        bool use_fec = (i == missing - 1);
+        size_t decoded_size = 0;
+        if (audio_codec_decode_lost(player->decoder,
+                                    use_fec ? next_packet : NULL, use_fec ? next_size : 0,
+                                    frame_samples, pcm, pcm_size, &decoded_size) != CODEC_SUCCESS) {
+            break;
+        }
+        uint32_t frame_timestamp = expected + (uint32_t)(i * frame_ms);
+        if (output_pcm(player, target, pcm, decoded_size, &frame_timestamp) != 0) {
+            LOG_ERROR("✗ 补齐音频写入失败");
+            break;
+        }
+        if (use_fec) {
+            recovered++;
+        } else {
+            concealed++;
+        }
+    }
+    
+    __atomic_fetch_add(&player->concealed_frames, concealed, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&player->recovered_frames, recovered, __ATOMIC_RELAXED);
+    linx_metrics_add(player->metrics, LINX_METRIC_CONCEALED_FRAMES, concealed + recovered);
+}
+
+/**
+ * 输出一段解码后的PCM
+ * 推模式写入音频接口（或解码超前队列）并送给输出抽头；拉模式复制到设备缓冲区，
+ * 放不下的部分暂存为余量留给下一次请求，timestamp 不使用
+ */
+static int output_pcm(linx_player_t* player, pull_target_t* target, int16_t* pcm, size_t samples,
+                      const uint32_t* timestamp) {
+    if (!target) {
+        return push_output(player, pcm, samples, timestamp);
+    }
+    
+    size_t room = target->needed - target->filled;
+    size_t copy = samples < room ? samples : room;
+    memcpy(target->output + target->filled, pcm, copy * sizeof(int16_t));
+    target->filled += copy;
+    
+    size_t rest = samples - copy;
+    if (rest == 0) {
+        return 0;
+    }
+    
+    // 压缩余量缓冲区后追加
+    if (player->pull_pcm_offset > 0) {
+        memmove(player->pull_pcm, player->pull_pcm + player->pull_pcm_offset,
+                player->pull_pcm_length * sizeof(int16_t));
+        player->pull_pcm_offset = 0;
+    }
+    if (rest > player->pull_pcm_capacity - player->pull_pcm_length) {
+        return -1;
+    }
+    memcpy(player->pull_pcm + player->pull_pcm_length, pcm + copy, rest * sizeof(int16_t));
+    player->pull_pcm_length += rest;
+    return 0;
+}
+
+/**
+ * 设备输出回调：取包并直接解码到设备缓冲区
+ * 包的时长大于剩余空间时先解码到临时缓冲区，超出部分下次请求时输出
+ * @return 实际填充的帧数，其余由设备补静音
+ */
+static size_t pull_callback(void* user_data, short* buffer, size_t frame_count) {
+    linx_player_t* player = (linx_player_t*)user_data;
+    size_t channels = player->config.channels > 0 ? (size_t)player->config.channels : 1;
+    pull_target_t target = { buffer, frame_count * channels, 0 };
+    uint8_t encoded_buffer[DECODE_BUFFER_SIZE];
+    
+    if (player_load_state(player) != PLAYER_STATE_PLAYING) {
+        linx_deadline_idle(player->deadline);
+        return 0;
+    }
+    // 设备按自己的节奏回调，下一次回调应在这次请求的帧播完时到来
+    linx_deadline_tick(player->deadline, player->config.sample_rate > 0 ?
+                       (uint32_t)((uint64_t)frame_count * 1000000u / (uint32_t)player->config.sample_rate) : 0);
+    linx_deadline_activity("jitter");
+    LINX_TRACEPOINT_BEGIN(player_write);
+    
+    linx_deadline_lock(&player->buffer_lock, &player->buffer_mutex);
+    if (player->pull_pcm_discard) {
+        player->pull_pcm_offset = 0;
+        player->pull_pcm_length = 0;
+        player->pull_pcm_discard = false;
+        player->tap_has_timestamp = false;
+    }
+    // 在零分配区之外转入新包，超长包需要抖动缓冲区单独分配
+    player_drain_feed(player);
+    linx_deadline_unlock(&player->buffer_lock, &player->buffer_mutex);
+    
+    // 先输出上一次剩余的样本
+    if (player->pull_pcm_length > 0) {
+        size_t copy = player->pull_pcm_length < target.needed ? player->pull_pcm_length : target.needed;
+        memcpy(target.output, player->pull_pcm + player->pull_pcm_offset, copy * sizeof(int16_t));
+        target.filled = copy;
+        player->pull_pcm_offset += copy;
+        player->pull_pcm_length -= copy;
+        if (player->pull_pcm_length == 0) {
+            player->pull_pcm_offset = 0;
+        }
+    }
+    
+    bool anchored = false;
+    linx_alloc_no_alloc_enter();
+    while (target.filled < target.needed) {
+        size_t read_size = 0;
+        uint32_t timestamp = 0;
+        linx_deadline_lock(&player->buffer_lock, &player->buffer_mutex);
+        linx_jitter_result_t result = player_pop(player, encoded_buffer, sizeof(encoded_buffer),
+                                                 &read_size, &timestamp, player_now_ms());
+        linx_deadline_unlock(&player->buffer_lock, &player->buffer_mutex);
+        
+        if (result == LINX_JITTER_EMPTY &&
+            bridge_gap(player, &target, player->pull_scratch, player->pull_scratch_size)) {
+            continue;
+        }
+        if (result == LINX_JITTER_EMPTY || result == LINX_JITTER_BUFFERING) {
+            break;
+        }
+        if (result != LINX_JITTER_OK || read_size == 0) {
+            continue;
+        }
+        
+        // 由本次第一个包的时间戳推算 buffer[0] 的时间戳：
+        // 包之前是已填充的样本和丢包补齐溢出到余量缓冲区的样本
+        if (!anchored && player->config.sample_rate > 0) {
+            size_t ahead = (target.filled + player->pull_pcm_length) / channels;
+            player->tap_next_timestamp = timestamp -
+                                         (uint32_t)(ahead * 1000 / (size_t)player->config.sample_rate);
+            player->tap_has_timestamp = true;
+            anchored = true;
+        }
+        
+        if (player->config.conceal_loss) {
+            conceal_lost_frames(player, &target, timestamp, encoded_buffer, read_size,
+                                player->pull_scratch, player->pull_scratch_size);
+        }
+        
+        // 剩余空间足够一帧时直接解码到设备缓冲区
+        size_t crossfade = bridge_prepare(player);
+        size_t decoded_size = 0;
+        codec_error_t err = CODEC_BUFFER_TOO_SMALL;
+        uint64_t decode_start_us = player->metrics ? linx_metrics_now_us() : 0;
+        linx_deadline_activity("decode");
+        LINX_TRACEPOINT_BEGIN(player_decode);
+        size_t room = target.needed - target.filled;
+        if (room >= (size_t)player->config.frame_size * channels) {
+            err = audio_codec_decode(player->decoder, encoded_buffer, read_size,
+                                     target.output + target.filled, room, &decoded_size);
+            if (err == CODEC_SUCCESS) {
+                bridge_finish(player, target.output + target.filled, decoded_size, crossfade);
+                target.filled += decoded_size;
+            }
+        }
+        if (err == CODEC_BUFFER_TOO_SMALL) {
+            err = audio_codec_decode(player->decoder, encoded_buffer, read_size,
+                                     player->pull_scratch, player->pull_scratch_size, &decoded_size);
+            if (err == CODEC_SUCCESS) {
+                bridge_finish(player, player->pull_scratch, decoded_size, crossfade);
+            }
+            if (err == CODEC_SUCCESS &&
+                output_pcm(player, &target, player->pull_scratch, decoded_size, NULL) != 0) {
+                LOG_WARN("拉模式余量缓冲区已满，丢弃 %zu 个样本", decoded_size);
+            }
+        }
+        LINX_TRACEPOINT_END(player_decode, read_size, err == CODEC_SUCCESS ? decoded_size : 0);
+        if (err != CODEC_SUCCESS) {
+            LOG_ERROR("✗ 音频解码失败: %zu 字节数据", read_size);
+            continue;
+        }
+        if (player->metrics) {
+            linx_metrics_record(player->metrics, LINX_METRIC_DECODE_TIME,
+                                (uint32_t)(linx_metrics_now_us() - decode_start_us));
+        }
+        
+        __atomic_fetch_add(&player->total_bytes_played, read_size, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&player->total_frames_played, 1, __ATOMIC_RELAXED);
+    }
+    
+    // 附加播放流和提示音铺满整个请求，TTS 不足的部分补静音后混音
+    size_t tts_filled = target.filled;
+    linx_mixer_t* mixer = player_mixer(player);
+    bool streams = mixer && linx_mixer_active(mixer);
+    if ((streams || player_sounds_pending(player)) && target.filled < target.needed) {
+        memset(target.output + target.filled, 0, (target.needed - target.filled) * sizeof(int16_t));
+        target.filled = target.needed;
+    }
+    linx_deadline_activity("mix");
+    if (streams) {
+        linx_mixer_mix(mixer, target.output, target.filled, tts_filled > 0);
+    }
+    process_output(player, target.output, target.filled);
+    linx_alloc_no_alloc_leave();
+    
+    size_t frames = target.filled / channels;
+    if (target.filled > 0) {
+        if (tts_filled > 0) {
+            linx_metrics_stage_end(player->metrics, LINX_METRIC_TTS_TO_PLAYBACK);
+            linx_trace_mark_first(player->trace, LINX_TRACE_FIRST_PLAYBACK);
+        }
+        call_output_tap(player, target.output, target.filled,
+                        player->tap_has_timestamp ? &player->tap_next_timestamp : NULL);
+    }
+    note_written(player, target.filled,
+                 tts_filled > 0 && player->tap_has_timestamp ? &player->tap_next_timestamp : NULL);
+    if (player->tap_has_timestamp && player->config.sample_rate > 0) {
+        player->tap_next_timestamp += (uint32_t)(frames * 1000 / (size_t)player->config.sample_rate);
+    }
+    LINX_TRACEPOINT_END(player_write, target.filled, 1);
+    return frames;
+}
+
+/**
+ * 把包队列中的包转入抖动缓冲区（调用方持有 buffer_mutex，即包队列的消费方）
+ * 在零分配区内遇到需要单独分配的超长包时停下，留给区外的下一次调用
+ */
+static void player_drain_feed(linx_player_t* player) {
+    if (!player->feed_queue) {
+        return;
+    }
+    
+    const linx_packet_queue_entry_t* entry;
+    while ((entry = linx_packet_queue_peek(player->feed_queue)) != NULL) {
+        if (entry->size > LINX_JITTER_BUFFER_SLOT_BYTES && linx_alloc_no_alloc_active()) {
+            break;
+        }
+        
+        linx_jitter_result_t result = linx_jitter_buffer_push(player->jitter_buffer, entry->data, entry->size,
+                                                              entry->timestamp, entry->has_timestamp,
+                                                              entry->arrival_ms);
+        if (result != LINX_JITTER_OK) {
+            linx_metrics_add(player->metrics, LINX_METRIC_DOWNLINK_DROPS, 1);
+        } else {
+            linx_metrics_record(player->metrics, LINX_METRIC_JITTER_DEPTH,
+                                (uint32_t)linx_jitter_buffer_depth_ms(player->jitter_buffer));
+        }
+        if (result == LINX_JITTER_FULL) {
+            LOG_WARN_EVERY_MS(1000, "⚠️ 抖动缓冲区已满: %zu 包 (%d ms)",
+                              linx_jitter_buffer_count(player->jitter_buffer),
+                              linx_jitter_buffer_depth_ms(player->jitter_buffer));
+        } else if (result == LINX_JITTER_LATE || result == LINX_JITTER_DUPLICATE) {
+            LOG_DEBUG_EVERY_MS(1000, "丢弃%s音频包, 时间戳: %u",
+                               result == LINX_JITTER_LATE ? "迟到" : "重复", entry->timestamp);
+        }
+        linx_packet_queue_pop(player->feed_queue);
+    }
+}
+
+/**
+ * 发布抖动缓冲区的包数和深度，供无锁查询（调用方持有 buffer_mutex）
+ */
+static void player_publish_depth(linx_player_t* player) {
+    __atomic_store_n(&player->jitter_packets, linx_jitter_buffer_count(player->jitter_buffer), __ATOMIC_RELEASE);
+    __atomic_store_n(&player->jitter_depth_ms, linx_jitter_buffer_depth_ms(player->jitter_buffer), __ATOMIC_RELEASE);
+}
+
+/**
+ * 已缓冲的时长：抖动缓冲区发布的深度加上包队列中尚未转入的包（按帧长估算），不加锁
+ */
+static int player_queued_ms(linx_player_t* player) {
+    int frame_ms = player->config.sample_rate > 0 && player->config.frame_size > 0 ?
+                   player->config.frame_size * 1000 / player->config.sample_rate :
+                   LINX_JITTER_BUFFER_DEFAULT_FRAME_MS;
+    size_t queued = player->feed_queue ? linx_packet_queue_count(player->feed_queue) : 0;
+    return __atomic_load_n(&player->jitter_depth_ms, __ATOMIC_ACQUIRE) + (int)queued * frame_ms;
+}
+
+/**
+ * 从抖动缓冲区取包（调用方持有 buffer_mutex），先转入包队列中新到的包
+ * 衔接空档期间下一句的第一个包到达即恢复出队，不再等待预缓冲
+ */
+static linx_jitter_result_t player_pop(linx_player_t* player, uint8_t* buffer, size_t buffer_size,
+                                       size_t* size, uint32_t* timestamp, uint64_t now_ms) {
+    player_drain_feed(player);
+    
+    if (player->bridge_discard) {
+        player->bridge_discard = false;
+        player->bridge_primed = false;
+        player->bridge_ms = 0;
+    }
+    
+    linx_jitter_result_t result = linx_jitter_buffer_pop(player->jitter_buffer, buffer, buffer_size,
+                                                         size, timestamp, now_ms);
+    if (result == LINX_JITTER_BUFFERING && player->bridge_ms > 0 &&
+        linx_jitter_buffer_resume(player->jitter_buffer)) {
+        result = linx_jitter_buffer_pop(player->jitter_buffer, buffer, buffer_size, size, timestamp, now_ms);
+    }
+    player_publish_depth(player);
+    return result;
+}
+
+/**
+ * 回复中途缓冲区为空时输出一帧 PLC，延续上一帧的音频并向静音淡出
+ * 衔接达到 bridge_limit_ms 时已经淡到静音，之后按普通欠载处理（等待预缓冲）；
+ * 衔接中回复结束时照常淡出
+ * target 为 NULL 时写入音频接口，否则填充到拉模式的设备缓冲区
+ * @return 输出了一帧时返回 true
+ */
+static bool bridge_gap(linx_player_t* player, pull_target_t* target, int16_t* pcm, size_t pcm_size) {
+    int frame_ms = player->config.sample_rate > 0 ?
+                   player->config.frame_size * 1000 / player->config.sample_rate : 0;
+    if (player->bridge_limit_ms <= 0 || !player->bridge_primed || frame_ms <= 0 ||
+        (player->bridge_ms == 0 && !__atomic_load_n(&player->continuing, __ATOMIC_ACQUIRE)) ||
+        !audio_codec_supports_loss_recovery(player->decoder)) {
+        return false;
+    }
+    
+    size_t decoded_size = 0;
+    if (audio_codec_decode_lost(player->decoder, NULL, 0, (size_t)player->config.frame_size,
+                                pcm, pcm_size, &decoded_size) != CODEC_SUCCESS || decoded_size == 0) {
+        player->bridge_primed = false;
+        player->bridge_ms = 0;
+        return false;
+    }
+    
+    if (player->bridge_ms == 0) {
+        // 衔接的音频不占用流时间戳，下一句从第一个包重新开始丢包检测
+        linx_deadline_lock(&player->buffer_lock, &player->buffer_mutex);
+        player->has_expected_timestamp = false;
+        linx_deadline_unlock(&player->buffer_lock, &player->buffer_mutex);
+        LOG_DEBUG_EVERY_MS(1000, "回复中途缓冲区为空，PLC 衔接");
+    }
+    
+    float limit = (float)player->bridge_limit_ms;
+    float gain_start = 1.0f - (float)player->bridge_ms / limit;
+    float gain_end = 1.0f - (float)(player->bridge_ms + frame_ms) / limit;
+    audio_dsp_gain_ramp(pcm, decoded_size, gain_start, gain_end > 0.0f ? gain_end : 0.0f);
+    player->bridge_ms += frame_ms;
+    if (player->bridge_ms >= player->bridge_limit_ms) {
+        // 已淡到静音，等下一次真实解码后才能再次衔接
+        player->bridge_primed = false;
+        player->bridge_ms = 0;
+    }
+    
+    if (output_pcm(player, target, pcm, decoded_size, NULL) != 0) {
+        LOG_ERROR("✗ 衔接音频写入失败");
+        return false;
+    }
+    __atomic_fetch_add(&player->concealed_frames, 1, __ATOMIC_RELAXED);
+    linx_metrics_add(player->metrics, LINX_METRIC_CONCEALED_FRAMES, 1);
+    return true;
+}
+
+/**
+ * 衔接过空档后、解码下一句第一个包之前调用：再生成一帧 PLC 存入 bridge_pcm，
+ * 从当前的衔接增益在 PLAYER_BRIDGE_CROSSFADE_MS 内淡到静音
+ * @return 需要与新解码音频交叉淡化的样本数，0 表示不需要
+ */
+static size_t bridge_prepare(linx_player_t* player) {
+    if (player->bridge_ms <= 0) {
+        return 0;
+    }
+    
+    size_t decoded_size = 0;
+    float gain = 1.0f - (float)player->bridge_ms / (float)player->bridge_limit_ms;
+    player->bridge_ms = 0;
+    if (audio_codec_decode_lost(player->decoder, NULL, 0, (size_t)player->config.frame_size,
+                                player->bridge_pcm, player->bridge_pcm_size, &decoded_size) != CODEC_SUCCESS) {
+        return 0;
+    }
+    
+    size_t channels = player->config.channels > 0 ? (size_t)player->config.channels : 1;
+    size_t crossfade = (size_t)player->config.sample_rate * PLAYER_BRIDGE_CROSSFADE_MS / 1000 * channels;
+    if (crossfade > decoded_size) {
+        crossfade = decoded_size;
+    }
+    audio_dsp_gain_ramp(player->bridge_pcm, crossfade, gain, 0.0f);
+    return crossfade;
+}
+
+/**
+ * 真实解码成功后调用：淡入新音频的开头并叠加 bridge_prepare() 的 PLC
+ */
+static void bridge_finish(linx_player_t* player, int16_t* pcm, size_t samples, size_t crossfade) {
+    if (crossfade > samples) {
+        crossfade = samples;
+    }
+    if (crossfade > 0) {
+        audio_dsp_gain_ramp(pcm, crossfade, 0.0f, 1.0f);
+        audio_dsp_mix(pcm, player->bridge_pcm, crossfade);
+    }
+    player->bridge_primed = player->bridge_limit_ms > 0;
+}
+
+/**
+ * 分配拉模式缓冲区并注册到音频接口
+ * 余量缓冲区可容纳一次补齐的全部丢失帧加上一个最长（120ms）的包
+ */
+static bool setup_pull_mode(linx_player_t* player) {
+    if (!audio_interface_supports_pull(player->audio_interface)) {
+        return false;
+    }
+    
+    size_t channels = player->config.channels > 0 ? (size_t)player->config.channels : 1;
+    size_t max_packet_samples = (size_t)player->config.sample_rate * 120 / 1000 * channels;
+    if (max_packet_samples == 0) {
+        return false;
+    }
+    
+    player->pull_scratch_size = max_packet_samples;
+    player->pull_pcm_capacity = max_packet_samples * (PLAYER_MAX_CONCEALED_FRAMES + 1);
+    player->pull_scratch = (int16_t*)LINX_MALLOC(player->pull_scratch_size * sizeof(int16_t));
+    player->pull_pcm = (int16_t*)LINX_MALLOC(player->pull_pcm_capacity * sizeof(int16_t));
+    if (!player->pull_scratch || !player->pull_pcm) {
+        LOG_ERROR("Failed to allocate pull-mode buffers");
+        release_pull_buffers(player);
+        return false;
+    }
+    
+    if (audio_interface_set_pull_source(player->audio_interface, pull_callback, player) != 0) {
+        release_pull_buffers(player);
+        return false;
+    }
+    
+    player->pull_active = true;
+    LOG_INFO("Player using pull mode");
+    return true;
+}
+
+/**
+ * 分配解码超前队列（推模式播放线程），每个周期为一帧
+ * 分配失败时关闭解码超前，由播放线程直接写设备
+ */
+static void setup_decode_ahead(linx_player_t* player) {
+    int periods = player->config.decode_ahead_periods == 0 ? LINX_PLAYER_DEFAULT_DECODE_AHEAD :
+                  player->config.decode_ahead_periods;
+    size_t channels = player->config.channels > 0 ? (size_t)player->config.channels : 1;
+    size_t period_samples = player->config.frame_size > 0 ? (size_t)player->config.frame_size * channels : 0;
+    if (periods <= 0 || period_samples == 0) {
+        return;
+    }
+    
+    player->ahead_ring = linx_pcm_ring_create((size_t)periods, period_samples);
+    player->ahead_pcm = (int16_t*)LINX_MALLOC(period_samples * sizeof(int16_t));
+    player->ahead_data_sem = linx_sem_create(0, 1);
+    player->ahead_space_sem = linx_sem_create(0, 1);
+    if (!player->ahead_ring || !player->ahead_pcm || !player->ahead_data_sem || !player->ahead_space_sem) {
+        LOG_WARN("Failed to allocate decode-ahead queue, decoding on the output path");
+        release_decode_ahead(player);
+        return;
+    }
+    LOG_INFO("Player decoding %d periods ahead", periods);
+}
+
+static void release_decode_ahead(linx_player_t* player) {
+    linx_pcm_ring_destroy(player->ahead_ring);
+    LINX_FREE(player->ahead_pcm);
+    if (player->ahead_data_sem) {
+        linx_sem_destroy(player->ahead_data_sem);
+    }
+    if (player->ahead_space_sem) {
+        linx_sem_destroy(player->ahead_space_sem);
+    }
+    player->ahead_ring = NULL;
+    player->ahead_pcm = NULL;
+    player->ahead_data_sem = NULL;
+    player->ahead_space_sem = NULL;
+}
+
+static void release_pull_buffers(linx_player_t* player) {
+    LINX_FREE(player->pull_pcm);
+    LINX_FREE(player->pull_scratch);
+    player->pull_pcm = NULL;
+    player->pull_scratch = NULL;
+    player->pull_pcm_capacity = 0;
+    player->pull_scratch_size = 0;
+    player->pull_pcm_offset = 0;
+    player->pull_pcm_length = 0;
+}
+
+/**
+ * 改变播放器状态
+ */
+static player_error_t change_state(linx_player_t* player, player_state_t new_state) {
+    player_state_t old_state = player->state;
+    __atomic_store_n(&player->state, new_state, __ATOMIC_RELEASE);
+    
+    // 调用事件回调
+    if (player->event_callback) {
+        player->event_callback(old_state, new_state, player->callback_user_data);
+    }
+    
+    return PLAYER_SUCCESS;
+}
+
+/**
+ * 无锁读取播放状态（写入方在 state_mutex 下调用 change_state）
+ */
+static player_state_t player_load_state(linx_player_t* player) {
+    return __atomic_load_n(&player->state, __ATOMIC_ACQUIRE);
+}
+
+static bool player_is_running(linx_player_t* player) {
+    return __atomic_load_n(&player->running, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * 把交给设备的PCM送给输出抽头
+ */
+static void call_output_tap(linx_player_t* player, const int16_t* pcm, size_t samples, const uint32_t* timestamp) {
+    player_output_tap_t tap = __atomic_load_n(&player->output_tap, __ATOMIC_ACQUIRE);
+    if (tap) {
+        tap(__atomic_load_n(&player->output_tap_user_data, __ATOMIC_RELAXED), pcm, samples, timestamp);
+    }
+}
+
+/**
+ * 记录交给设备的一段PCM（写设备的一方调用）
+ * @param timestamp pcm[0] 的 TTS 流时间戳，没有 TTS 时为 NULL
+ */
+static void note_written(linx_player_t* player, size_t samples, const uint32_t* timestamp) {
+    size_t channels = player->config.channels > 0 ? (size_t)player->config.channels : 1;
+    size_t frames = samples / channels;
+    if (timestamp && player->config.sample_rate > 0) {
+        __atomic_store_n(&player->position_timestamp,
+                         *timestamp + (uint32_t)(frames * 1000 / (size_t)player->config.sample_rate),
+                         __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&player->position_has_timestamp, timestamp != NULL, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&player->position_frames, (uint64_t)frames, __ATOMIC_RELEASE);
+}
+
+/**
+ * 一段PCM交给设备后开始下一个周期：下一次写入须在这段PCM播完之前到来
+ */
+static void tick_deadline(linx_player_t* player, size_t samples) {
+    size_t channels = player->config.channels > 0 ? (size_t)player->config.channels : 1;
+    uint32_t period_us = player->config.sample_rate > 0 ?
+                         (uint32_t)((uint64_t)(samples / channels) * 1000000u / (uint32_t)player->config.sample_rate) : 0;
+    linx_deadline_tick(player->deadline, period_us);
+}
+
+/**
+ * 超时现场中的队列深度（无锁读取）
+ */
+static size_t player_deadline_context(void* user_data, char* buf, size_t size) {
+    linx_player_t* player = (linx_player_t*)user_data;
+    size_t feed = player->feed_queue ? linx_packet_queue_count(player->feed_queue) : 0;
+    size_t ahead = player->ahead_ring ? linx_pcm_ring_count(player->ahead_ring) : 0;
+    int n = snprintf(buf, size, "jitter=%zu/%dms feed=%zu ahead=%zu",
+                     __atomic_load_n(&player->jitter_packets, __ATOMIC_ACQUIRE),
+                     __atomic_load_n(&player->jitter_depth_ms, __ATOMIC_ACQUIRE), feed, ahead);
+    return n > 0 ? (size_t)n : 0;
+}
+
+/**
+ * 是否有提示音等待输出（无锁）
+ */
+static bool player_sounds_pending(linx_player_t* player) {
+    return __atomic_load_n(&player->sounds_active, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * 在交给设备的PCM上混入提示音，并按提示音的要求压低或恢复 TTS
+ * 增益逐样本过渡，提示音从下一个输出样本开始，与 TTS 按样本对齐
+ */
+static void mix_sounds(linx_player_t* player, int16_t* pcm, size_t samples) {
+    if (samples == 0 || (!player_sounds_pending(player) && player->duck_gain_q15 == PLAYER_GAIN_UNITY)) {
+        return;
+    }
+    
+    pthread_mutex_lock(&player->sound_mutex);
+    bool duck = false;
+    for (size_t i = 0; i < LINX_PLAYER_MAX_SOUNDS; i++) {
+        duck = duck || (player->sounds[i].id != 0 && player->sounds[i].duck);
+    }
+    
+    // TTS 增益向目标逐样本过渡
+    int32_t target = duck ? player->duck_target_q15 : PLAYER_GAIN_UNITY;
+    int32_t gain = player->duck_gain_q15;
+    int32_t step = player->duck_step_q15;
+    if (gain != target || gain != PLAYER_GAIN_UNITY) {
+        for (size_t i = 0; i < samples; i++) {
+            if (gain < target) {
+                gain = gain + step < target ? gain + step : target;
+            } else if (gain > target) {
+                gain = gain - step > target ? gain - step : target;
+            }
+            pcm[i] = (int16_t)((pcm[i] * gain) >> 15);
+        }
+        player->duck_gain_q15 = gain;
+    }
+    
+    bool active = false;
+    for (size_t v = 0; v < LINX_PLAYER_MAX_SOUNDS; v++) {
+        player_sound_voice_t* voice = &player->sounds[v];
+        if (voice->id == 0) {
+            continue;
+        }
+        size_t count = voice->samples - voice->position;
+        count = count < samples ? count : samples;
+        const int16_t* src = voice->pcm + voice->position;
+        for (size_t i = 0; i < count; i++) {
+            int32_t mixed = pcm[i] + ((src[i] * voice->gain_q15) >> 15);
+            pcm[i] = (int16_t)(mixed > 32767 ? 32767 : (mixed < -32768 ? -32768 : mixed));
+        }
+        voice->position += count;
+        if (voice->position >= voice->samples) {
+            voice->id = 0;
+            voice->pcm = NULL;
+        } else {
+            active = true;
+        }
+    }
+    __atomic_store_n(&player->sounds_active, active, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&player->sound_mutex);
+}
+
+/**
+ * 没有 TTS 时输出一帧只有提示音的PCM（推模式：播放线程、解码超前的输出线程或外部循环）
+ */
+static void play_sound_frame(linx_player_t* player, int16_t* pcm, size_t pcm_size) {
+    size_t channels = player->config.channels > 0 ? (size_t)player->config.channels : 1;
+    size_t samples = (size_t)player->config.frame_size * channels;
+    if (samples == 0 || samples > pcm_size) {
+        samples = pcm_size;
+    }
+    memset(pcm, 0, samples * sizeof(int16_t));
+    linx_deadline_activity("mix");
+    process_output(player, pcm, samples);
+    linx_deadline_activity("device_write");
+    if (audio_interface_write(player->audio_interface, pcm, samples) < 0) {
+        LOG_ERROR("✗ 提示音写入失败");
+        return;
+    }
+    tick_deadline(player, samples);
+    note_written(player, samples, NULL);
+    call_output_tap(player, pcm, samples, NULL);
+}
+
+/**
+ * 附加播放流的混音器，还没有打开过流时为 NULL（无锁）
+ */
+static linx_mixer_t* player_mixer(linx_player_t* player) {
+    return __atomic_load_n(&player->mixer, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * 是否有附加播放流还有未播完的音频
+ */
+static bool player_streams_pending(linx_player_t* player) {
+    linx_mixer_t* mixer = player_mixer(player);
+    return mixer && linx_mixer_active(mixer);
+}
+
+/**
+ * 没有 TTS 时输出一帧只有附加播放流的PCM（推模式：播放线程或外部循环）
+ * 提示音和音量在写设备之前（或解码超前的输出线程里）照常处理
+ */
+static void play_stream_frame(linx_player_t* player, int16_t* pcm, size_t pcm_size) {
+    size_t channels = player->config.channels > 0 ? (size_t)player->config.channels : 1;
+    size_t samples = (size_t)player->config.frame_size * channels;
+    if (samples == 0 || samples > pcm_size) {
+        samples = pcm_size;
+    }
+    memset(pcm, 0, samples * sizeof(int16_t));
+    linx_mixer_mix(player_mixer(player), pcm, samples, false);
+    if (enqueue_output(player, pcm, samples, NULL, false) != 0) {
+        LOG_ERROR("✗ 播放流写入失败");
+    }
+}
+
+/* 增益（dB）转为线性值，不高于下限为静音 */
+static float volume_gain(float db) {
+    return db <= LINX_PLAYER_VOLUME_MIN_DB ? 0.0f : powf(10.0f, db / 20.0f);
+}
+
+/**
+ * 在交给设备的PCM上应用软件音量和外部压低
+ * 目标变化时在 volume_ramp_ms 内按 dB 线性过渡：每 PLAYER_VOLUME_BLOCK 个样本前进一步，
+ * 块内线性插值增益，块与块首尾相接；稳定后整段用同一增益
+ */
+static void apply_volume(linx_player_t* player, int16_t* pcm, size_t samples) {
+    if (samples == 0) {
+        return;
+    }
+    
+    int32_t target_mdb = __atomic_load_n(&player->volume_mdb, __ATOMIC_RELAXED) -
+                         __atomic_load_n(&player->external_duck_mdb, __ATOMIC_RELAXED);
+    float target = (float)target_mdb / 1000.0f;
+    if (target < LINX_PLAYER_VOLUME_MIN_DB) {
+        target = LINX_PLAYER_VOLUME_MIN_DB;
+    }
+    
+    bool fade_in = __atomic_load_n(&player->volume_fade_in, __ATOMIC_ACQUIRE) &&
+                   __atomic_exchange_n(&player->volume_fade_in, false, __ATOMIC_ACQ_REL);
+    if (fade_in) {
+        player->volume_current_db = LINX_PLAYER_VOLUME_MIN_DB;
+    }
+    
+    float current = player->volume_current_db;
+    if (fade_in || target != player->volume_target_db) {
+        int ramp_ms = player->config.volume_ramp_ms > 0 ? player->config.volume_ramp_ms : PLAYER_DEFAULT_VOLUME_RAMP_MS;
+        size_t ramp_samples = (size_t)(player->config.sample_rate > 0 ? player->config.sample_rate : 16000) *
+                              (size_t)(player->config.channels > 0 ? player->config.channels : 1) * (size_t)ramp_ms / 1000;
+        size_t blocks = ramp_samples / PLAYER_VOLUME_BLOCK;
+        player->volume_target_db = target;
+        player->volume_step_db = (target - current) / (float)(blocks > 0 ? blocks : 1);
+    }
+    
+    // 稳定：原始音量直接返回，静音清零
+    if (current == target) {
+        if (target == 0.0f) {
+            return;
+        }
+        if (target <= LINX_PLAYER_VOLUME_MIN_DB) {
+            memset(pcm, 0, samples * sizeof(int16_t));
+            return;
+        }
+        audio_dsp_gain(pcm, samples, volume_gain(target));
+        return;
+    }
+    
+    float step = player->volume_step_db;
+    for (size_t i = 0; i < samples; i += PLAYER_VOLUME_BLOCK) {
+        size_t count = samples - i < PLAYER_VOLUME_BLOCK ? samples - i : PLAYER_VOLUME_BLOCK;
+        float next = current + step * (float)count / (float)PLAYER_VOLUME_BLOCK;
+        // 越过目标或只差不到半步（浮点累计误差）时落到目标上
+        if ((step > 0.0f && next > target) || (step < 0.0f && next < target) ||
+            fabsf(target - next) < fabsf(step) * 0.5f) {
+            next = target;
+        }
+        audio_dsp_gain_ramp(pcm + i, count, volume_gain(current), volume_gain(next));
+        current = next;
+    }
+    player->volume_current_db = current;
+}
+
+/**
+ * 交给设备之前的输出处理：混入提示音，再应用软件音量
+ */
+static void process_output(linx_player_t* player, int16_t* pcm, size_t samples) {
+    mix_sounds(player, pcm, samples);
+    apply_volume(player, pcm, samples);
+}
+
+/**
+ * 唤醒播放线程和解码超前的输出线程：信号量保留计数，线程检查状态之后、进入等待之前的唤醒不会丢失
+ */
+static void wake_playback_thread(linx_player_t* player) {
+    linx_sem_give(player->wake_sem);
+    if (player->ahead_data_sem) {
+        linx_sem_give(player->ahead_data_sem);
+    }
+}
+
+/**
+ * 获取单调时钟时间（毫秒）
+ */
+static uint64_t player_now_ms(void) {
+    return linx_os_now_ms();
+}
+
+/**
+ * 等待新包（不持有 buffer_mutex）
+ * feed 只在队列由空变为非空时唤醒；等待前用顺序一致的检查再确认一次队列为空，
+ * 与 feed 的判断配对，取包之后到达的包不会被错过
+ * @param timeout_ms 超时时间，小于 0 表示一直等待
+ */
+static void wait_for_packets(linx_player_t* player, int timeout_ms) {
+    if (!linx_packet_queue_is_empty(player->feed_queue)) {
+        return;
+    }
+    // 解码超前时写设备的是输出线程，它自己在队列播空时进入空闲
+    if (!player->ahead_ring) {
+        linx_deadline_idle(player->deadline);
+    }
+    linx_sem_take(player->wake_sem, timeout_ms);
+}
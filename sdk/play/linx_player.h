@@ -5,6 +5,12 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <pthread.h>
+#include "linx_jitter_buffer.h"
+#include "linx_packet_queue.h"
+#include "linx_pcm_ring.h"
+#include "linx_mixer.h"
+#include "../os/linx_os.h"
+#include "../log/linx_deadline.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -13,6 +19,25 @@ extern "C" {
 // 前向声明
 typedef struct AudioInterface AudioInterface;
 typedef struct audio_codec audio_codec_t;
+struct linx_metrics;
+struct linx_trace;
+
+/* 解码超前的默认周期数（见 player_audio_config_t.decode_ahead_periods） */
+#ifndef LINX_PLAYER_DEFAULT_DECODE_AHEAD
+#define LINX_PLAYER_DEFAULT_DECODE_AHEAD 2
+#endif
+
+/**
+ * 播放位置（见 linx_player_get_position()）
+ */
+typedef struct {
+    uint64_t frames_written;        // 交给音频设备的帧数（每声道样本数，含提示音、附加流和 PLC）
+    uint64_t frames_played;         // 估计已从扬声器播出的帧数：frames_written 减去输出延迟
+    uint32_t output_delay_us;       // 现在交给设备的样本到播出的延迟（微秒），设备不报告时为 0
+    bool device_delay;              // output_delay_us 由音频设备报告（audio_interface_get_play_delay()）
+    uint32_t timestamp;             // 正在播出的 TTS 样本的流时间戳（毫秒，与下行包的时间戳同一时间轴）
+    bool has_timestamp;             // timestamp 有效：最近交给设备的是带时间戳的 TTS
+} linx_player_position_t;
 
 /**
  * 播放器状态枚举
@@ -47,6 +72,46 @@ typedef struct {
     int channels;           // 声道数
     int frame_size;         // 帧大小（样本数）
     int buffer_size;        // 缓冲区大小
+    
+    // 抖动缓冲区（为 0 时使用默认值）
+    int jitter_target_ms;   // 目标缓冲深度（毫秒）
+    int jitter_max_ms;      // 最大缓冲深度（毫秒）
+    bool jitter_fixed;      // true 时固定使用目标深度，不根据到达抖动自适应
+    
+    // 丢包恢复：根据时间戳检测缺失的帧，用下一个包的带内FEC或PLC补齐
+    bool conceal_loss;
+    
+    // 拉模式：由音频设备的输出回调按需向播放器请求PCM，直接解码到设备缓冲区，
+    // 不再创建播放线程；音频接口不支持时自动退回推模式
+    bool pull_mode;
+    
+    // 外部循环：不创建播放线程，由应用在自己的主循环中调用 linx_player_process()
+    // 解码并写入音频接口；与 pull_mode 同时设置且音频接口支持拉模式时以拉模式为准
+    bool external_loop;
+    
+    // 本地提示音（见 linx_player_play_sound()）
+    int sound_duck_db;      // 要求压低时 TTS 的衰减（dB），0 为默认值 12，<0 不压低
+    int sound_duck_ramp_ms; // 压低和恢复的过渡时长（毫秒），0 为默认值 20
+    
+    // 软件音量（见 linx_player_set_volume()）
+    int volume_ramp_ms;     // 音量、外部压低变化以及恢复播放后淡入的过渡时长（毫秒），0 为默认值 30
+    
+    // 句间衔接（见 linx_player_set_continuation()）
+    int gapless_bridge_ms;  // 回复中途欠载时用 PLC 衔接并淡出的最长时长（毫秒），0 为默认值 200，<0 关闭
+    
+    // 解码超前（推模式播放线程）：解码线程提前解码到一个 PCM 队列，输出线程按设备节奏写入，
+    // 单帧解码的耗时尖峰不再直接变成设备欠载；每个周期为一帧（frame_size），
+    // 0 为默认值 LINX_PLAYER_DEFAULT_DECODE_AHEAD，<0 关闭（解码和写设备在同一线程）。
+    // 超前的周期会增加同样时长的播放延迟；拉模式和外部循环不使用
+    int decode_ahead_periods;
+    
+    // 附加播放流（见 linx_player_open_stream()）
+    int stream_duck_db;     // 有更高优先级的声音时低优先级流的衰减（dB），0 为默认值 12，<0 不压低
+    
+    // 播放线程（推模式，见 os/linx_os.h）：零值字段取默认值，名称 "player"、HIGH 优先级，
+    // 核位图和实时优先级为板级默认值 LINX_THREAD_AUDIO_CORE_MASK / LINX_THREAD_AUDIO_SCHED_PRIORITY；
+    // 开启解码超前时输出线程使用相同的属性，名称为 "player_out"
+    linx_thread_attr_t playback_thread_attr;
 } player_audio_config_t;
 
 /**
@@ -54,6 +119,36 @@ typedef struct {
  */
 typedef void (*player_event_callback_t)(player_state_t old_state, player_state_t new_state, void* user_data);
 
+/**
+ * 播放输出抽头回调函数类型
+ * 每段 PCM 交给音频设备后调用（推模式在播放线程或解码超前的输出线程，拉模式在设备回调中），
+ * 用作回声消除的远端参考；回调中不要阻塞
+ * @param pcm 交错排列的PCM，按 config.channels 声道
+ * @param samples 样本数（所有声道合计）
+ * @param timestamp pcm[0] 的流时间戳（毫秒），未知时为 NULL
+ */
+typedef void (*player_output_tap_t)(void* user_data, const int16_t* pcm, size_t samples,
+                                    const uint32_t* timestamp);
+
+/* 同时混音的提示音数 */
+#define LINX_PLAYER_MAX_SOUNDS 4
+
+/* 软件音量范围（dB），不高于 LINX_PLAYER_VOLUME_MIN_DB 即静音 */
+#define LINX_PLAYER_VOLUME_MIN_DB (-60.0f)
+#define LINX_PLAYER_VOLUME_MAX_DB 12.0f
+
+/**
+ * 正在播放的一个提示音（由 sound_mutex 保护）
+ */
+typedef struct {
+    const int16_t* pcm;             // 交错PCM（不持有）
+    size_t samples;                 // 样本数（所有声道合计）
+    size_t position;                // 下一个输出的样本
+    int32_t gain_q15;               // 音量，32768 为原始音量
+    bool duck;                      // 播放期间压低 TTS
+    uint32_t id;                    // 0 表示空闲
+} player_sound_voice_t;
+
 /**
  * 播放器结构体
  */
@@ -71,25 +166,107 @@ typedef struct {
     bool running;
     
     // 线程和同步
-    pthread_t playback_thread;
+    linx_thread_t* playback_thread;
     pthread_mutex_t state_mutex;
-    pthread_mutex_t buffer_mutex;
-    pthread_cond_t buffer_cond;
+    pthread_mutex_t buffer_mutex;   // 解码方与清空、统计等控制操作之间的锁，feed 不获取
+    linx_sem_t* wake_sem;           // 唤醒播放线程：新包使队列由空变为非空、状态变化
     
-    // 音频缓冲区（环形缓冲区）
-    uint8_t* audio_buffer;
-    size_t buffer_capacity;
-    size_t buffer_head;     // 写入位置
-    size_t buffer_tail;     // 读取位置
-    size_t buffer_count;    // 当前缓冲区中的数据量
+    // 下行包队列：feed 无锁放入，解码方取出后转入抖动缓冲区
+    linx_packet_queue_t* feed_queue;
+    
+    // 抖动缓冲区（按包存放编码数据，由 buffer_mutex 保护）
+    linx_jitter_buffer_t* jitter_buffer;
+    size_t jitter_packets;          // 抖动缓冲区的包数和深度，解码方发布（原子读写），供无锁查询
+    int jitter_depth_ms;
     
     // 事件回调
     player_event_callback_t event_callback;
     void* callback_user_data;
     
-    // 统计信息
+    // 输出抽头（原子读写）
+    player_output_tap_t output_tap;
+    void* output_tap_user_data;
+    uint32_t tap_next_timestamp;    // 拉模式：下一次输出首个样本的时间戳（仅在设备回调中访问）
+    bool tap_has_timestamp;         // tap_next_timestamp 是否有效
+    
+    // 拉模式状态（余量缓冲区仅在设备回调中访问）
+    bool pull_active;               // 是否已切换到拉模式
+    int16_t* pull_pcm;              // 解码余量：设备请求的帧数小于一个包时暂存剩余样本
+    size_t pull_pcm_capacity;       // 余量缓冲区容量（样本数）
+    size_t pull_pcm_offset;         // 余量读取位置
+    size_t pull_pcm_length;         // 余量样本数
+    bool pull_pcm_discard;          // clear_buffer 后丢弃余量（由 buffer_mutex 保护）
+    int16_t* pull_scratch;          // 无法直接解码到设备缓冲区时使用的临时缓冲区
+    size_t pull_scratch_size;       // 临时缓冲区容量（样本数）
+    
+    // 解码超前：播放线程解码后放入 ahead_ring，输出线程取出后混音、调音量并写入设备
+    linx_pcm_ring_t* ahead_ring;    // NULL 表示关闭
+    linx_thread_t* output_thread;
+    linx_sem_t* ahead_data_sem;     // 唤醒输出线程：队列有新周期、状态变化、提示音
+    linx_sem_t* ahead_space_sem;    // 唤醒播放线程：输出线程取走了周期
+    int16_t* ahead_pcm;             // 输出线程单独输出提示音的缓冲区（一个周期）
+    uint32_t ahead_generation;      // clear_buffer 时递增，输出线程丢弃之前放入的周期（原子读写）
+    bool ahead_decoding;            // 播放线程正在解码一个包（原子读写）
+    bool ahead_streaming;           // 上一次写设备的是队列中的周期（仅输出线程访问）
+    size_t ahead_starved;           // 队列播空而解码方还有音频的次数（原子读写）
+    
+    // 附加播放流：第一次打开流时创建（由 state_mutex 保护创建，原子发布），在解码方与 TTS 混音
+    linx_mixer_t* mixer;
+    
+    // 外部循环模式的解码缓冲区（仅在 linx_player_process 中访问）
+    uint8_t* process_packet;
+    int16_t* process_pcm;
+    
+    // 丢包恢复状态（仅解码方访问：播放线程或设备回调）
+    uint32_t expected_timestamp;    // 下一个包应有的时间戳
+    bool has_expected_timestamp;    // expected_timestamp 是否有效
+    
+    // 统计信息（原子读写）
     size_t total_bytes_played;
     size_t total_frames_played;
+    size_t concealed_frames;        // PLC 补齐的帧数
+    size_t recovered_frames;        // 带内FEC恢复的帧数
+    
+    // 播放位置（只由写设备的一方更新：推模式的播放/输出线程、设备回调或外部循环；原子读写）
+    uint64_t position_frames;       // 交给设备的帧数
+    uint32_t position_timestamp;    // 最后交给设备的样本之后的流时间戳
+    bool position_has_timestamp;    // position_timestamp 有效
+    
+    // 运行指标（解码耗时、抖动缓冲深度、TTS 首帧到播出等），NULL 表示不记录
+    struct linx_metrics* metrics;
+    
+    // 对话时间线（每轮第一个样本交给音频设备的时刻），NULL 表示不记录
+    struct linx_trace* trace;
+    
+    // 写设备一方（播放线程、输出线程、设备回调或外部循环）的周期截止监测，创建失败时为 NULL
+    linx_deadline_t* deadline;
+    linx_deadline_lock_t buffer_lock;   // buffer_mutex 的持有标注，出现在超时现场中
+    
+    // 本地提示音：在交给设备的PCM上逐样本混音（voices 由 sound_mutex 保护）
+    pthread_mutex_t sound_mutex;
+    player_sound_voice_t sounds[LINX_PLAYER_MAX_SOUNDS];
+    bool sounds_active;             // 有提示音在播放（原子读写，输出路径先无锁检查）
+    uint32_t next_sound_id;
+    int32_t duck_gain_q15;          // TTS 当前增益（仅输出路径访问）
+    int32_t duck_target_q15;        // 压低后的增益
+    int32_t duck_step_q15;          // 过渡期间每个样本的增益变化
+    
+    // 软件音量：目标由任意线程设置（原子读写，千分之一 dB），其余仅输出路径访问
+    int32_t volume_mdb;             // 音量
+    int32_t external_duck_mdb;      // linx_player_set_duck() 的衰减
+    bool volume_fade_in;            // 下一段输出从静音淡入（恢复播放、打断之后，原子读写）
+    float volume_current_db;        // 当前增益
+    float volume_target_db;         // 过渡的目标
+    float volume_step_db;           // 过渡中每 PLAYER_VOLUME_BLOCK 个样本的变化
+    
+    // 句间衔接：回复中途缓冲区欠载时用 PLC 填补空档（continuing 原子读写，其余仅解码方访问）
+    bool continuing;                // 当前回复还有后续音频
+    bool bridge_discard;            // 回复开始或 clear_buffer 后放弃衔接（由 buffer_mutex 保护）
+    bool bridge_primed;             // 上一帧是真实解码的音频，解码器状态可用于 PLC
+    int bridge_limit_ms;            // 最长衔接时长，0 表示关闭
+    int bridge_ms;                  // 当前空档已衔接的时长
+    int16_t* bridge_pcm;            // 恢复时与新句子交叉淡化的 PLC 帧
+    size_t bridge_pcm_size;         // bridge_pcm 容量（样本数）
 } linx_player_t;
 
 /**
@@ -119,6 +296,15 @@ player_error_t linx_player_set_event_callback(linx_player_t* player,
                                              player_event_callback_t callback, 
                                              void* user_data);
 
+/**
+ * 设置输出抽头，每段交给音频设备的PCM都会经过它（如回声消除的远端参考）
+ * @param player 播放器实例
+ * @param tap 抽头回调，NULL 取消
+ * @param user_data 用户数据
+ * @return 错误码
+ */
+player_error_t linx_player_set_output_tap(linx_player_t* player, player_output_tap_t tap, void* user_data);
+
 /**
  * 开始播放
  * @param player 播放器实例
@@ -148,7 +334,7 @@ player_error_t linx_player_resume(linx_player_t* player);
 player_error_t linx_player_stop(linx_player_t* player);
 
 /**
- * 添加音频数据到播放缓冲区
+ * 添加音频数据到播放缓冲区（一个完整的编码包，按到达顺序播放）
  * @param player 播放器实例
  * @param data 编码的音频数据
  * @param size 数据大小（字节）
@@ -156,6 +342,29 @@ player_error_t linx_player_stop(linx_player_t* player);
  */
 player_error_t linx_player_feed_data(linx_player_t* player, const uint8_t* data, size_t size);
 
+/**
+ * 添加一个带时间戳的编码包到抖动缓冲区
+ * 时间戳用于排序、丢弃迟到/重复包以及估算到达抖动
+ * @param player 播放器实例
+ * @param data 一个完整的 Opus 包
+ * @param size 包大小（字节）
+ * @param timestamp 包时间戳（毫秒，见 linx_audio_stream_packet_t.timestamp）
+ * @param has_timestamp 时间戳是否有效（协议 v1/v3 不携带时间戳）
+ * @return 错误码
+ */
+player_error_t linx_player_feed_packet(linx_player_t* player, const uint8_t* data, size_t size,
+                                       uint32_t timestamp, bool has_timestamp);
+
+/**
+ * 外部循环模式下播放已到期的包，不阻塞等待新包
+ * 在应用主循环中周期调用；写入音频接口时是否阻塞取决于音频设备
+ * @param player 播放器实例
+ * @param max_packets 本次最多播放的包数，0 表示取完为止
+ * @param next_timeout_ms 输出：建议的下一次调用间隔（毫秒），-1 表示在新包到达前无需调用，可为 NULL
+ * @return 错误码；未启用 external_loop 或已处于拉模式时返回 PLAYER_ERROR_INVALID_STATE
+ */
+player_error_t linx_player_process(linx_player_t* player, size_t max_packets, int* next_timeout_ms);
+
 /**
  * 获取当前播放器状态
  * @param player 播放器实例
@@ -178,12 +387,30 @@ bool linx_player_is_buffer_empty(linx_player_t* player);
 bool linx_player_is_buffer_full(linx_player_t* player);
 
 /**
- * 获取缓冲区使用率（0.0-1.0）
+ * 获取抖动缓冲区统计信息（深度、目标深度、抖动估计、丢包等）
+ * @param player 播放器实例
+ * @param stats 统计信息（输出参数）
+ * @return 错误码
+ */
+player_error_t linx_player_get_jitter_stats(linx_player_t* player, linx_jitter_buffer_stats_t* stats);
+
+/**
+ * 获取缓冲区使用率（0.0-1.0，当前深度 / 最大深度）
  * @param player 播放器实例
  * @return 缓冲区使用率
  */
 float linx_player_get_buffer_usage(linx_player_t* player);
 
+/**
+ * 获取抖动缓冲区中已缓冲的音频时长和缓冲区满前可容纳的时长，供下行流控使用
+ * （见 LinxSdkConfig::downlink_buffer_ms）
+ * @param player 播放器实例
+ * @param buffered_ms 已缓冲时长（毫秒，输出参数），可为 NULL
+ * @param capacity_ms 可容纳时长（毫秒，输出参数），可为 NULL
+ * @return 错误码
+ */
+player_error_t linx_player_get_buffer_level(linx_player_t* player, int* buffered_ms, int* capacity_ms);
+
 /**
  * 清空播放缓冲区
  * @param player 播放器实例
@@ -191,6 +418,15 @@ float linx_player_get_buffer_usage(linx_player_t* player);
  */
 player_error_t linx_player_clear_buffer(linx_player_t* player);
 
+/**
+ * 立即停止正在播出的声音（打断）：清空播放缓冲区，并丢弃已交给音频设备、尚未播出的PCM
+ * 拉模式下余量在下一次设备回调时丢弃；推模式需要音频接口支持 flush_play，
+ * 不支持时已写入设备的部分仍会播完
+ * @param player 播放器实例
+ * @return 错误码
+ */
+player_error_t linx_player_flush(linx_player_t* player);
+
 /**
  * 获取播放统计信息
  * @param player 播放器实例
@@ -200,6 +436,179 @@ player_error_t linx_player_clear_buffer(linx_player_t* player);
  */
 player_error_t linx_player_get_stats(linx_player_t* player, size_t* total_bytes, size_t* total_frames);
 
+/**
+ * 获取播放位置和输出延迟
+ * 
+ * 写设备时记录交给设备的帧数和 TTS 时间戳，查询时加上设备报告的输出延迟
+ * （已排队未播放的PCM和设备自身的输出时延），得到此刻扬声器正在播出的位置。
+ * 用于回声参考对齐、字幕同步和打断时确定用户实际听到的位置。
+ * flush 丢弃的设备队列也计入 frames_written。
+ * 
+ * @param position 输出参数
+ * @return 错误码
+ * @note 线程安全，任意线程调用；结果是调用时刻的近似值
+ */
+player_error_t linx_player_get_position(linx_player_t* player, linx_player_position_t* position);
+
+/**
+ * 获取丢包恢复统计信息
+ * @param player 播放器实例
+ * @param concealed_frames PLC 补齐的帧数（输出参数，可为 NULL）
+ * @param recovered_frames 带内FEC恢复的帧数（输出参数，可为 NULL）
+ * @return 错误码
+ */
+player_error_t linx_player_get_loss_stats(linx_player_t* player, size_t* concealed_frames, size_t* recovered_frames);
+
+/**
+ * 获取解码超前队列的状态
+ * @param player 播放器实例
+ * @param queued 当前已解码、等待写入设备的周期数（输出参数，可为 NULL）
+ * @param capacity 队列容量（周期数，输出参数，可为 NULL），未开启解码超前时为 0
+ * @param starved 队列播空而解码方还有音频未解码的次数，即没能吸收住的解码尖峰（输出参数，可为 NULL）
+ * @return 错误码
+ */
+player_error_t linx_player_get_decode_ahead(linx_player_t* player, size_t* queued, size_t* capacity,
+                                            size_t* starved);
+
+/**
+ * 设置运行指标记录器（如 linx_sdk_get_metrics_recorder() 的返回值），start 之前调用
+ * 记录解码耗时、抖动缓冲深度、解码超前深度、下行丢包与补齐帧数，并在第一个样本交给音频设备时
+ * 结束 TTS 首帧到播出阶段
+ * @param player 播放器实例
+ * @param metrics 记录器，NULL 表示不再记录；需在播放器销毁前保持有效
+ * @return 错误码
+ */
+player_error_t linx_player_set_metrics(linx_player_t* player, struct linx_metrics* metrics);
+
+/**
+ * 设置对话时间线（如 linx_sdk_get_trace() 的返回值），start 之前调用
+ * 每轮第一个样本交给音频设备时记录 LINX_TRACE_FIRST_PLAYBACK
+ * @param player 播放器实例
+ * @param trace 时间线，NULL 表示不再记录；需在播放器销毁前保持有效
+ * @return 错误码
+ */
+player_error_t linx_player_set_trace(linx_player_t* player, struct linx_trace* trace);
+
+/**
+ * 播放一段本地提示音（提示音、固定语句），与 TTS 逐样本混音
+ * 
+ * 混音发生在交给音频设备的PCM上（推模式、拉模式和外部循环都支持），没有 TTS 时
+ * 单独输出提示音；输出抽头收到的是混音后的PCM，回声消除的参考保持一致。
+ * duck 为 true 时播放期间按 sound_duck_db 压低 TTS，前后各有 sound_duck_ramp_ms 的过渡。
+ * 播放器需处于 PLAYING 状态（暂停时提示音也暂停）。
+ * 
+ * @param pcm 交错PCM，采样率和声道数与播放器配置相同；播放结束前须一直有效
+ *            （常驻 flash 的数据或 linx_sound_bank 的缓存）
+ * @param samples 样本数（所有声道合计）
+ * @param volume 音量，1.0 为原始音量
+ * @param duck 播放期间压低 TTS
+ * @param sound_id 输出提示音编号，用于 linx_player_stop_sound()，可以为 NULL
+ * @return PLAYER_SUCCESS 成功；同时播放的提示音已满返回 PLAYER_ERROR_BUFFER_FULL
+ * @note 线程安全，不在输出路径上分配内存
+ */
+player_error_t linx_player_play_sound(linx_player_t* player, const int16_t* pcm, size_t samples,
+                                      float volume, bool duck, uint32_t* sound_id);
+
+/**
+ * 停止提示音
+ * @param sound_id linx_player_play_sound() 返回的编号，0 停止全部
+ * @note 返回后不再读取该提示音的PCM
+ */
+player_error_t linx_player_stop_sound(linx_player_t* player, uint32_t sound_id);
+
+/**
+ * 提示音是否还在播放
+ * @param sound_id linx_player_play_sound() 返回的编号，0 表示任意一个
+ */
+bool linx_player_is_sound_playing(linx_player_t* player, uint32_t sound_id);
+
+/**
+ * 打开一路附加播放流（音乐、通知、闹钟等），与 TTS 和其他流同时播放
+ * 
+ * 每路流有自己的解码器和编码包队列，解码方（播放线程、设备回调或外部循环）按需解码，
+ * 在交给设备的PCM上与 TTS 混音，始终只有一个设备写入方；没有 TTS 时单独输出流的音频。
+ * 有更高优先级的声音在播放时低优先级的流按 stream_duck_db 压低（TTS 的优先级为
+ * LINX_MIXER_PRIORITY_VOICE，LINX_MIXER_PRIORITY_ALERT 的流会压低 TTS）。
+ * 提示音和软件音量在混音之后生效，输出抽头收到的是混音后的PCM。
+ * 
+ * @param config 流配置；解码器须已按播放器的采样率和声道数初始化，关闭流之前保持有效
+ * @return 流句柄，同时打开的流已满（LINX_MIXER_MAX_STREAMS）或内存不足返回 NULL
+ * @note 线程安全，需在 linx_player_init() 之后调用
+ */
+linx_mixer_stream_t* linx_player_open_stream(linx_player_t* player, const linx_mixer_stream_config_t* config);
+
+/**
+ * 关闭附加播放流，丢弃尚未播放的音频；返回后播放器不再使用该流的解码器
+ */
+void linx_player_close_stream(linx_player_t* player, linx_mixer_stream_t* stream);
+
+/**
+ * 向附加播放流放入一个完整的编码包（按顺序播放，不经过抖动缓冲区）
+ * @return PLAYER_SUCCESS 成功；队列已满返回 PLAYER_ERROR_BUFFER_FULL
+ * @note 同一路流只能由一个线程放入，与其他流和 TTS 的 feed 互不影响
+ */
+player_error_t linx_player_stream_feed(linx_player_t* player, linx_mixer_stream_t* stream,
+                                       const uint8_t* data, size_t size);
+
+/**
+ * 设置附加播放流的增益（线性，1.0 为原始音量；与压低叠加，平滑过渡）
+ */
+player_error_t linx_player_set_stream_gain(linx_player_t* player, linx_mixer_stream_t* stream, float gain);
+
+/**
+ * 附加播放流是否还有未播完的音频
+ */
+bool linx_player_is_stream_playing(linx_player_t* player, linx_mixer_stream_t* stream);
+
+/**
+ * 设置软件音量（百分比）
+ * 
+ * 按 40·log10(percent/100) dB 映射（50% 约 -12 dB），听感上接近均匀；0 为静音。
+ * 音量在交给音频设备的PCM上生效（TTS 与提示音一起，输出抽头收到的是调节后的PCM），
+ * 各平台表现一致，不依赖音频设备的硬件音量。
+ * 
+ * @param percent 0-100
+ * @note 线程安全；变化按 dB 线性过渡 volume_ramp_ms，不会产生爆音
+ */
+player_error_t linx_player_set_volume(linx_player_t* player, int percent);
+
+/**
+ * 设置软件音量（dB）
+ * @param db 增益，限制在 LINX_PLAYER_VOLUME_MAX_DB 以内；不高于 LINX_PLAYER_VOLUME_MIN_DB 为静音
+ * @note 线程安全
+ */
+player_error_t linx_player_set_volume_db(linx_player_t* player, float db);
+
+/**
+ * 获取软件音量的目标值（dB），静音时为 LINX_PLAYER_VOLUME_MIN_DB
+ */
+float linx_player_get_volume_db(linx_player_t* player);
+
+/**
+ * 标记当前回复是否还有后续音频（TTS start 时为 true，stop 或打断时为 false）
+ * 
+ * 回复进行中缓冲区欠载（通常是句子之间服务端还没送来下一句）时，播放器不再输出
+ * 静音并重新预缓冲：解码器状态保持不变，用 PLC 延续上一句的尾音并在
+ * gapless_bridge_ms 内淡出；下一句的第一个包一到就立即出队，不等预缓冲，
+ * 与 PLC 交叉淡化 10ms 后接上。新的回复开始时不沿用上一段的尾音。
+ * 解码器不支持丢包恢复或 gapless_bridge_ms < 0 时不做衔接。
+ * 
+ * @param continuing 回复还有后续音频
+ * @note 线程安全
+ */
+player_error_t linx_player_set_continuation(linx_player_t* player, bool continuing);
+
+/**
+ * 压低全部输出（例如其他应用需要说话、来电提示）
+ * 
+ * 在音量之上叠加衰减（TTS 和提示音一起），与音量一样按 dB 线性过渡；
+ * 与 linx_player_play_sound() 的 duck（提示音压低 TTS）相互独立。
+ * 
+ * @param attenuation_db 衰减（dB），0 恢复
+ * @note 线程安全
+ */
+player_error_t linx_player_set_duck(linx_player_t* player, float attenuation_db);
+
 /**
  * 销毁播放器实例
  * @param player 播放器实例
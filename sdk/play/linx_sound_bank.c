@@ -0,0 +1,344 @@
+#include "linx_sound_bank.h"
+#include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
+#include <pthread.h>
+#include <string.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_PLAY);
+
+/* 一个已登记的资源 */
+typedef struct {
+    linx_sound_asset_t asset;
+    int16_t* pcm;                   // 解码缓存（编码资源），PCM 资源为 NULL
+    size_t samples;                 // 解码后的样本数，未解码时为 0
+    uint64_t last_used;             // 最近使用的序号，用于淘汰
+    linx_player_t* player;          // 最近一次播放所在的播放器
+    uint32_t sound_id;              // 最近一次播放的提示音编号
+} sound_entry_t;
+
+struct linx_sound_bank {
+    audio_codec_t* decoder;
+    size_t max_bytes;
+    pthread_mutex_t mutex;
+
+    sound_entry_t* entries;
+    size_t count;
+    size_t capacity;
+    uint64_t use_counter;
+
+    linx_sound_bank_stats_t stats;
+};
+
+/**
+ * 创建提示音库
+ */
+linx_sound_bank_t* linx_sound_bank_create(audio_codec_t* decoder, size_t max_bytes) {
+    linx_sound_bank_t* bank = (linx_sound_bank_t*)LINX_CALLOC(1, sizeof(linx_sound_bank_t));
+    if (!bank) {
+        LOG_ERROR("提示音库分配失败");
+        return NULL;
+    }
+
+    if (pthread_mutex_init(&bank->mutex, NULL) != 0) {
+        LOG_ERROR("提示音库互斥锁初始化失败");
+        LINX_FREE(bank);
+        return NULL;
+    }
+
+    bank->decoder = decoder;
+    bank->max_bytes = max_bytes;
+    return bank;
+}
+
+/**
+ * 登记一个资源
+ */
+int linx_sound_bank_add(linx_sound_bank_t* bank, const linx_sound_asset_t* asset) {
+    if (!bank || !asset || !asset->data || asset->size < sizeof(int16_t)) {
+        return -1;
+    }
+
+    if (asset->format == LINX_SOUND_PACKETS && !bank->decoder) {
+        LOG_ERROR("提示音 %s 是编码格式，但没有解码器", asset->name ? asset->name : "");
+        return -1;
+    }
+
+    pthread_mutex_lock(&bank->mutex);
+    if (bank->count == bank->capacity) {
+        size_t capacity = bank->capacity ? bank->capacity * 2 : 8;
+        sound_entry_t* entries = (sound_entry_t*)LINX_REALLOC(bank->entries, capacity * sizeof(sound_entry_t));
+        if (!entries) {
+            pthread_mutex_unlock(&bank->mutex);
+            LOG_ERROR("提示音库扩容失败");
+            return -1;
+        }
+        bank->entries = entries;
+        bank->capacity = capacity;
+    }
+
+    sound_entry_t* entry = &bank->entries[bank->count];
+    memset(entry, 0, sizeof(*entry));
+    entry->asset = *asset;
+    if (asset->format == LINX_SOUND_PCM16) {
+        entry->samples = asset->size / sizeof(int16_t);
+    }
+    int id = (int)bank->count++;
+    bank->stats.assets = bank->count;
+    pthread_mutex_unlock(&bank->mutex);
+    return id;
+}
+
+/**
+ * 按名称查找资源
+ */
+size_t linx_sound_bank_add_assets(linx_sound_bank_t* bank, const linx_assets_t* assets) {
+    size_t added = 0;
+    size_t count = linx_assets_count(assets);
+    for (size_t i = 0; i < count; i++) {
+        linx_asset_t item;
+        if (!linx_assets_get(assets, i, &item) ||
+            (item.type != LINX_ASSET_SOUND_PCM16 && item.type != LINX_ASSET_SOUND_PACKETS)) {
+            continue;
+        }
+        linx_sound_asset_t asset = {
+            .name = item.name,
+            .format = item.type == LINX_ASSET_SOUND_PCM16 ? LINX_SOUND_PCM16 : LINX_SOUND_PACKETS,
+            .data = item.data,
+            .size = item.size
+        };
+        if (linx_sound_bank_add(bank, &asset) >= 0) {
+            added++;
+        }
+    }
+    return added;
+}
+
+int linx_sound_bank_find(linx_sound_bank_t* bank, const char* name) {
+    if (!bank || !name) {
+        return -1;
+    }
+
+    int id = -1;
+    pthread_mutex_lock(&bank->mutex);
+    for (size_t i = 0; i < bank->count; i++) {
+        if (bank->entries[i].asset.name && strcmp(bank->entries[i].asset.name, name) == 0) {
+            id = (int)i;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&bank->mutex);
+    return id;
+}
+
+/* 释放一个资源的解码缓存（调用者持有锁） */
+static void release_entry(linx_sound_bank_t* bank, sound_entry_t* entry) {
+    if (!entry->pcm) {
+        return;
+    }
+    bank->stats.cached_bytes -= entry->samples * sizeof(int16_t);
+    LINX_FREE(entry->pcm);
+    entry->pcm = NULL;
+    entry->samples = 0;
+}
+
+/* 资源的PCM是否还在某个播放器上播放（调用者持有锁） */
+static bool entry_in_use(const sound_entry_t* entry) {
+    return entry->player && entry->sound_id != 0 &&
+           linx_player_is_sound_playing(entry->player, entry->sound_id);
+}
+
+/* 按最久未使用淘汰，直到能放下 bytes（调用者持有锁） */
+static void make_room(linx_sound_bank_t* bank, size_t bytes, const sound_entry_t* keep) {
+    if (bank->max_bytes == 0) {
+        return;
+    }
+
+    while (bank->stats.cached_bytes + bytes > bank->max_bytes) {
+        sound_entry_t* oldest = NULL;
+        for (size_t i = 0; i < bank->count; i++) {
+            sound_entry_t* entry = &bank->entries[i];
+            if (entry == keep || !entry->pcm || entry_in_use(entry)) {
+                continue;
+            }
+            if (!oldest || entry->last_used < oldest->last_used) {
+                oldest = entry;
+            }
+        }
+        if (!oldest) {
+            return;
+        }
+        LOG_INFO("淘汰提示音缓存 %s（%zu 字节）", oldest->asset.name ? oldest->asset.name : "",
+                 oldest->samples * sizeof(int16_t));
+        release_entry(bank, oldest);
+        bank->stats.evictions++;
+    }
+}
+
+/* 整段解码一个编码资源（调用者持有锁） */
+static bool decode_entry(linx_sound_bank_t* bank, sound_entry_t* entry) {
+    const uint8_t* data = (const uint8_t*)entry->asset.data;
+    size_t size = entry->asset.size;
+
+    // 先数包，确定解码缓冲区上限
+    size_t packets = 0;
+    for (size_t offset = 0; offset + 2 <= size; packets++) {
+        size_t length = ((size_t)data[offset] << 8) | data[offset + 1];
+        if (length == 0 || offset + 2 + length > size) {
+            LOG_ERROR("提示音 %s 数据损坏（第 %zu 个包）", entry->asset.name ? entry->asset.name : "", packets);
+            return false;
+        }
+        offset += 2 + length;
+    }
+
+    int max_output = audio_codec_get_max_output_size(bank->decoder);
+    if (packets == 0 || max_output <= 0) {
+        return false;
+    }
+
+    size_t capacity = packets * (size_t)max_output;
+    int16_t* pcm = (int16_t*)LINX_MALLOC_BULK(capacity * sizeof(int16_t));
+    if (!pcm) {
+        LOG_ERROR("提示音解码缓冲区分配失败（%zu 字节）", capacity * sizeof(int16_t));
+        return false;
+    }
+
+    size_t samples = 0;
+    for (size_t offset = 0; offset + 2 <= size; ) {
+        size_t length = ((size_t)data[offset] << 8) | data[offset + 1];
+        size_t decoded = 0;
+        if (audio_codec_decode(bank->decoder, data + offset + 2, length, pcm + samples,
+                               capacity - samples, &decoded) != CODEC_SUCCESS) {
+            LOG_ERROR("提示音 %s 解码失败", entry->asset.name ? entry->asset.name : "");
+            LINX_FREE(pcm);
+            return false;
+        }
+        samples += decoded;
+        offset += 2 + length;
+    }
+
+    if (samples == 0) {
+        LINX_FREE(pcm);
+        return false;
+    }
+
+    // 缩小到实际长度，再按上限淘汰其他缓存
+    int16_t* shrunk = (int16_t*)LINX_REALLOC_BULK(pcm, samples * sizeof(int16_t));
+    if (shrunk) {
+        pcm = shrunk;
+    }
+    make_room(bank, samples * sizeof(int16_t), entry);
+
+    entry->pcm = pcm;
+    entry->samples = samples;
+    bank->stats.cached_bytes += samples * sizeof(int16_t);
+    bank->stats.decodes++;
+    return true;
+}
+
+/* 取得资源的PCM，必要时解码（调用者持有锁） */
+static const int16_t* acquire_entry(linx_sound_bank_t* bank, int id, size_t* samples) {
+    if (id < 0 || (size_t)id >= bank->count) {
+        return NULL;
+    }
+
+    sound_entry_t* entry = &bank->entries[id];
+    entry->last_used = ++bank->use_counter;
+    if (entry->asset.format == LINX_SOUND_PCM16) {
+        *samples = entry->samples;
+        return (const int16_t*)entry->asset.data;
+    }
+
+    if (!entry->pcm && !decode_entry(bank, entry)) {
+        return NULL;
+    }
+    *samples = entry->samples;
+    return entry->pcm;
+}
+
+/**
+ * 预先解码一个资源
+ */
+bool linx_sound_bank_load(linx_sound_bank_t* bank, int id) {
+    size_t samples = 0;
+    return linx_sound_bank_get(bank, id, &samples) != NULL;
+}
+
+/**
+ * 获取资源的PCM
+ */
+const int16_t* linx_sound_bank_get(linx_sound_bank_t* bank, int id, size_t* samples) {
+    if (!bank || !samples) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&bank->mutex);
+    const int16_t* pcm = acquire_entry(bank, id, samples);
+    pthread_mutex_unlock(&bank->mutex);
+    return pcm;
+}
+
+/**
+ * 在播放器上播放一个资源
+ */
+player_error_t linx_sound_bank_play(linx_sound_bank_t* bank, linx_player_t* player, int id,
+                                    float volume, bool duck, uint32_t* sound_id) {
+    if (sound_id) {
+        *sound_id = 0;
+    }
+
+    if (!bank || !player) {
+        return PLAYER_ERROR_INVALID_PARAM;
+    }
+
+    // 持锁直到登记完播放编号，期间不会被其他线程淘汰
+    pthread_mutex_lock(&bank->mutex);
+    size_t samples = 0;
+    const int16_t* pcm = acquire_entry(bank, id, &samples);
+    if (!pcm) {
+        pthread_mutex_unlock(&bank->mutex);
+        return PLAYER_ERROR_INVALID_PARAM;
+    }
+
+    uint32_t id_out = 0;
+    player_error_t result = linx_player_play_sound(player, pcm, samples, volume, duck, &id_out);
+    if (result == PLAYER_SUCCESS) {
+        bank->entries[id].player = player;
+        bank->entries[id].sound_id = id_out;
+    }
+    pthread_mutex_unlock(&bank->mutex);
+
+    if (sound_id) {
+        *sound_id = id_out;
+    }
+    return result;
+}
+
+/**
+ * 获取统计信息
+ */
+bool linx_sound_bank_get_stats(linx_sound_bank_t* bank, linx_sound_bank_stats_t* stats) {
+    if (!bank || !stats) {
+        return false;
+    }
+
+    pthread_mutex_lock(&bank->mutex);
+    *stats = bank->stats;
+    pthread_mutex_unlock(&bank->mutex);
+    return true;
+}
+
+/**
+ * 销毁提示音库
+ */
+void linx_sound_bank_destroy(linx_sound_bank_t* bank) {
+    if (!bank) {
+        return;
+    }
+
+    for (size_t i = 0; i < bank->count; i++) {
+        release_entry(bank, &bank->entries[i]);
+    }
+    LINX_FREE(bank->entries);
+    pthread_mutex_destroy(&bank->mutex);
+    LINX_FREE(bank);
+}
@@ -0,0 +1,120 @@
+#ifndef LINX_SOUND_BANK_H
+#define LINX_SOUND_BANK_H
+
+/*
+ * 本地提示音库
+ *
+ * 管理开机提示、唤醒提示、"网络已断开"之类固定语句的音频，交给
+ * linx_player_play_sound() 与 TTS 混音播放，不必经过服务器往返。
+ *
+ * 资源有两种格式：
+ * - PCM：直接引用调用者提供的数据（通常常驻 flash），不拷贝
+ * - 编码包：2 字节大端长度 + 编码数据依次排列（与服务器下发的格式相同，
+ *   通常为 Opus），第一次使用时用创建时传入的解码器整段解码并缓存，
+ *   之后播放不再解码
+ *
+ * 解码缓存受 max_bytes 限制，超出时按最久未使用淘汰（正在播放的资源除外）。
+ * 线程安全。
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "linx_player.h"
+#include "../codecs/audio_codec.h"
+#include "../linx_assets.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 提示音库 - 前向声明（隐藏实现细节） */
+typedef struct linx_sound_bank linx_sound_bank_t;
+
+/* 资源格式 */
+typedef enum {
+    LINX_SOUND_PCM16 = 0,           // 交错的 16 位 PCM，采样率和声道数与播放器相同
+    LINX_SOUND_PACKETS              // 2 字节大端长度前缀的编码包序列
+} linx_sound_format_t;
+
+/* 资源描述；name 和 data 须在提示音库销毁前一直有效 */
+typedef struct {
+    const char* name;               // 资源名，用于 linx_sound_bank_find()
+    linx_sound_format_t format;
+    const void* data;
+    size_t size;                    // 字节数
+} linx_sound_asset_t;
+
+/* 统计信息 */
+typedef struct {
+    size_t assets;                  // 已登记的资源数
+    size_t cached_bytes;            // 解码缓存占用的字节数
+    size_t decodes;                 // 解码次数（首次使用和淘汰后重新解码）
+    size_t evictions;               // 淘汰次数
+} linx_sound_bank_stats_t;
+
+/**
+ * 创建提示音库
+ * @param decoder 已初始化的解码器，只有 PCM 资源时可以为 NULL；
+ *                解码在调用 linx_sound_bank_load()/play() 的线程进行，
+ *                不要与播放器共用同一个解码器实例
+ * @param max_bytes 解码缓存上限（字节），0 为不限制
+ * @return 提示音库实例，失败返回 NULL
+ */
+linx_sound_bank_t* linx_sound_bank_create(audio_codec_t* decoder, size_t max_bytes);
+
+/**
+ * 登记一个资源
+ * @return 资源编号（从 0 开始），失败返回 -1
+ */
+int linx_sound_bank_add(linx_sound_bank_t* bank, const linx_sound_asset_t* asset);
+
+/**
+ * 登记资源包中所有提示音（LINX_ASSET_SOUND_PCM16 / LINX_ASSET_SOUND_PACKETS），
+ * 数据和名称直接引用映射区；资源包须在提示音库销毁后才关闭
+ * @return 登记的资源数
+ */
+size_t linx_sound_bank_add_assets(linx_sound_bank_t* bank, const linx_assets_t* assets);
+
+/**
+ * 按名称查找资源
+ * @return 资源编号，不存在返回 -1
+ */
+int linx_sound_bank_find(linx_sound_bank_t* bank, const char* name);
+
+/**
+ * 预先解码一个资源（例如开机时预热常用提示音）
+ * @return 成功返回 true
+ */
+bool linx_sound_bank_load(linx_sound_bank_t* bank, int id);
+
+/**
+ * 获取资源的PCM（必要时先解码）
+ * @param samples 输出样本数（所有声道合计）
+ * @return PCM 数据，失败返回 NULL；淘汰或提示音库销毁后失效
+ */
+const int16_t* linx_sound_bank_get(linx_sound_bank_t* bank, int id, size_t* samples);
+
+/**
+ * 在播放器上播放一个资源，参数含义同 linx_player_play_sound()
+ * 正在播放的资源不会被淘汰
+ */
+player_error_t linx_sound_bank_play(linx_sound_bank_t* bank, linx_player_t* player, int id,
+                                    float volume, bool duck, uint32_t* sound_id);
+
+/**
+ * 获取统计信息
+ */
+bool linx_sound_bank_get_stats(linx_sound_bank_t* bank, linx_sound_bank_stats_t* stats);
+
+/**
+ * 销毁提示音库
+ * @note 调用前先停止使用其缓存的提示音（linx_player_stop_sound(player, 0)）
+ */
+void linx_sound_bank_destroy(linx_sound_bank_t* bank);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LINX_SOUND_BANK_H
@@ -9,6 +9,9 @@
  * - 音频数据输入和播放
  * - 状态管理和错误处理
  * - Opus 文件播放支持
+ * - 网络损伤压力测试（--stress，见 play_stress.h）
+ * - 本地提示音混音测试（--sounds，见 play_sound.h）
+ * - 编码包 SPSC 队列测试（--packet-queue，见 play_packet_queue.h）
  */
 
 #include <stdio.h>
@@ -26,6 +29,9 @@
 #include "../../codecs/codec_stub.h"
 #include "../../codecs/opus_codec.h"
 #include "../../log/linx_log.h"
+#include "play_stress.h"
+#include "play_sound.h"
+#include "play_packet_queue.h"
 
 // 测试配置常量
 #define TEST_SAMPLE_RATE    16000   // 与 linx_demo.c 一致
@@ -784,11 +790,18 @@ static void print_usage(const char* program_name) {
     printf("  -m, --buffer    运行缓冲区管理测试\n");
     printf("  -o, --opus      播放 Opus 文件（需要指定文件路径）\n");
     printf("  -a, --all       运行所有测试 (默认)\n");
+    printf("  --stress [...]  网络损伤压力测试（虚拟音频设备，无需声卡），其后的参数见下\n");
+    printf("  --sounds        本地提示音混音测试（虚拟音频设备，无需声卡）\n");
+    printf("  --packet-queue  编码包队列的单线程与生产者/消费者测试（建议 -fsanitize=thread 构建）\n");
+    printf("\n");
+    play_stress_print_usage();
     printf("\n");
     printf("示例:\n");
     printf("  %s --opus /path/to/audio.opus    # 播放 Opus 文件\n", program_name);
     printf("  %s --basic                       # 运行正弦波播放测试\n", program_name);
     printf("  %s --all                         # 运行所有测试\n", program_name);
+    printf("  %s --stress --jitter 40 --dist pareto --loss 5 --burst 3\n", program_name);
+    printf("  %s --stress --trace wifi_trace.txt # 重放现场设备录制的到达轨迹\n", program_name);
     printf("\n");
 }
 
@@ -844,6 +857,22 @@ int main(int argc, char* argv[]) {
             }
         } else if (strcmp(argv[i], "-a") == 0 || strcmp(argv[i], "--all") == 0) {
             run_all = true;
+        } else if (strcmp(argv[i], "--stress") == 0) {
+            // 其余参数全部交给压力测试
+            int ret = play_stress_main(argc - i - 1, argv + i + 1);
+            printf("\n================================================\n");
+            printf(ret == 0 ? "✅ 压力测试完成！\n" : "❌ 压力测试失败！\n");
+            return ret;
+        } else if (strcmp(argv[i], "--sounds") == 0) {
+            int ret = play_sound_main();
+            printf("\n================================================\n");
+            printf(ret == 0 ? "✅ 提示音测试完成！\n" : "❌ 提示音测试失败！\n");
+            return ret;
+        } else if (strcmp(argv[i], "--packet-queue") == 0) {
+            int ret = play_packet_queue_main();
+            printf("\n================================================\n");
+            printf(ret == 0 ? "✅ 编码包队列测试完成！\n" : "❌ 编码包队列测试失败！\n");
+            return ret;
         } else if (argv[i][0] != '-') {
             // 如果不是选项，可能是 Opus 文件路径
             if (!opus_file_path) {
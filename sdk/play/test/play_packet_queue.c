@@ -0,0 +1,224 @@
+/**
+ * @file play_packet_queue.c
+ * @brief 编码包 SPSC 队列测试
+ *
+ * 包的长度和内容都由序号决定，消费者据此逐字节校验；每 7 个包有一个超过
+ * LINX_PACKET_QUEUE_SLOT_BYTES，走单独分配的槽位。并发测试的队列只有 8 个槽位，
+ * 生产者时而停顿、时而把队列写满，两端都会反复经过空和满的边界。
+ * 消费者等待唤醒时带超时：超时时队列非空说明生产者放入时没有唤醒（丢失唤醒）。
+ */
+
+#include "play_packet_queue.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../linx_packet_queue.h"
+#include "../../os/linx_os.h"
+
+#define PQ_STRESS_PACKETS   200000
+#define PQ_STRESS_SLOTS     8
+#define PQ_MAX_PACKET       (LINX_PACKET_QUEUE_SLOT_BYTES * 2)
+#define PQ_WAKE_TIMEOUT_MS  2000
+
+static int s_failures = 0;
+
+#define PQ_CHECK(cond, msg) do { \
+    if (cond) { \
+        printf("  ✓ %s\n", msg); \
+    } else { \
+        printf("  ✗ %s (%s:%d)\n", msg, __FILE__, __LINE__); \
+        s_failures++; \
+    } \
+} while (0)
+
+// ==================== 由序号决定的包 ====================
+
+static size_t pq_packet_size(uint32_t seq) {
+    if (seq % 7 == 0) {
+        return LINX_PACKET_QUEUE_SLOT_BYTES + 1 + seq % (PQ_MAX_PACKET - LINX_PACKET_QUEUE_SLOT_BYTES);
+    }
+    return 1 + seq % LINX_PACKET_QUEUE_SLOT_BYTES;
+}
+
+static void pq_packet_fill(uint32_t seq, uint8_t* data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        data[i] = (uint8_t)(seq * 31u + i);
+    }
+}
+
+static bool pq_packet_check(const linx_packet_queue_entry_t* entry, uint32_t seq) {
+    if (!entry || entry->timestamp != seq || !entry->has_timestamp || entry->arrival_ms != seq ||
+        entry->size != pq_packet_size(seq)) {
+        return false;
+    }
+    for (size_t i = 0; i < entry->size; i++) {
+        if (entry->data[i] != (uint8_t)(seq * 31u + i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static linx_packet_queue_result_t pq_push(linx_packet_queue_t* queue, uint32_t seq, bool* was_empty) {
+    uint8_t data[PQ_MAX_PACKET];
+    size_t size = pq_packet_size(seq);
+    pq_packet_fill(seq, data, size);
+    return linx_packet_queue_push(queue, data, size, seq, true, seq, was_empty);
+}
+
+// ==================== 单线程 ====================
+
+static void test_single_thread(void) {
+    printf("单线程: 先进先出、超长包、队满和 was_empty\n");
+
+    linx_packet_queue_t* queue = linx_packet_queue_create(3);
+    PQ_CHECK(queue != NULL, "创建队列");
+    if (!queue) {
+        return;
+    }
+    PQ_CHECK(linx_packet_queue_capacity(queue) == 4, "槽位数向上取为 2 的幂");
+    PQ_CHECK(linx_packet_queue_is_empty(queue) && linx_packet_queue_peek(queue) == NULL, "新队列为空");
+
+    // 序号 7 和 14 是超长包
+    bool was_empty = false;
+    PQ_CHECK(pq_push(queue, 7, &was_empty) == LINX_PACKET_QUEUE_OK && was_empty, "首个包报告 was_empty");
+    PQ_CHECK(pq_push(queue, 8, &was_empty) == LINX_PACKET_QUEUE_OK && !was_empty, "非空时不报告 was_empty");
+    PQ_CHECK(pq_push(queue, 9, NULL) == LINX_PACKET_QUEUE_OK, "was_empty 可为 NULL");
+    PQ_CHECK(pq_push(queue, 14, &was_empty) == LINX_PACKET_QUEUE_OK, "放满 4 个槽位");
+    PQ_CHECK(pq_push(queue, 15, &was_empty) == LINX_PACKET_QUEUE_FULL, "队满时拒绝");
+    PQ_CHECK(linx_packet_queue_count(queue) == 4, "计数为 4");
+
+    const linx_packet_queue_entry_t* entry = linx_packet_queue_peek(queue);
+    PQ_CHECK(pq_packet_check(entry, 7) && entry->size > LINX_PACKET_QUEUE_SLOT_BYTES, "超长包内容完整");
+    linx_packet_queue_pop(queue);
+    PQ_CHECK(pq_packet_check(linx_packet_queue_peek(queue), 8), "按放入顺序取出");
+    linx_packet_queue_pop(queue);
+
+    // 回绕后超长包复用同一槽位
+    PQ_CHECK(pq_push(queue, 21, &was_empty) == LINX_PACKET_QUEUE_OK && !was_empty, "取出后可以再放入");
+    static const uint32_t rest[] = {9, 14, 21};
+    bool ordered = true;
+    for (size_t i = 0; i < sizeof(rest) / sizeof(rest[0]); i++) {
+        ordered = ordered && pq_packet_check(linx_packet_queue_peek(queue), rest[i]);
+        linx_packet_queue_pop(queue);
+    }
+    PQ_CHECK(ordered, "回绕后的包顺序和内容正确");
+    PQ_CHECK(linx_packet_queue_is_empty(queue), "全部取出后为空");
+    linx_packet_queue_pop(queue);
+    PQ_CHECK(linx_packet_queue_count(queue) == 0, "空队列 pop 无副作用");
+
+    PQ_CHECK(pq_push(queue, 28, &was_empty) == LINX_PACKET_QUEUE_OK && was_empty, "再次变为非空时报告 was_empty");
+
+    // 销毁时释放仍在队列中的超长包（用 ASan 检查泄漏）
+    PQ_CHECK(pq_push(queue, 35, NULL) == LINX_PACKET_QUEUE_OK, "销毁前留下超长包");
+    linx_packet_queue_destroy(queue);
+}
+
+// ==================== 生产者/消费者 ====================
+
+typedef struct {
+    linx_packet_queue_t* queue;
+    linx_sem_t* wake;               // 与播放器的 wake_sem 相同：二值信号量
+    uint64_t full_retries;
+    uint64_t wakeups;
+} pq_stress_t;
+
+static void* pq_producer(void* arg) {
+    pq_stress_t* stress = (pq_stress_t*)arg;
+
+    for (uint32_t seq = 0; seq < PQ_STRESS_PACKETS; seq++) {
+        bool was_empty = false;
+        linx_packet_queue_result_t result;
+        while ((result = pq_push(stress->queue, seq, &was_empty)) == LINX_PACKET_QUEUE_FULL) {
+            stress->full_retries++;
+            sched_yield();
+        }
+        if (result != LINX_PACKET_QUEUE_OK) {
+            break;
+        }
+        // 只在由空变为非空时唤醒，和 linx_player_feed_packet() 一样
+        if (was_empty) {
+            stress->wakeups++;
+            linx_sem_give(stress->wake);
+        }
+        // 时而停顿，让消费者把队列取空后进入等待
+        if (seq % 97 == 0) {
+            usleep(20);
+        }
+    }
+    return NULL;
+}
+
+static void test_producer_consumer(void) {
+    printf("双线程: %d 个包，%d 个槽位\n", PQ_STRESS_PACKETS, PQ_STRESS_SLOTS);
+
+    pq_stress_t stress = {0};
+    stress.queue = linx_packet_queue_create(PQ_STRESS_SLOTS);
+    stress.wake = linx_sem_create(0, 1);
+    PQ_CHECK(stress.queue != NULL && stress.wake != NULL, "创建队列和信号量");
+    if (!stress.queue || !stress.wake) {
+        linx_packet_queue_destroy(stress.queue);
+        linx_sem_destroy(stress.wake);
+        return;
+    }
+
+    pthread_t producer;
+    if (pthread_create(&producer, NULL, pq_producer, &stress) != 0) {
+        PQ_CHECK(false, "创建生产者线程");
+        linx_packet_queue_destroy(stress.queue);
+        linx_sem_destroy(stress.wake);
+        return;
+    }
+
+    uint32_t expected = 0;
+    uint32_t mismatches = 0;
+    uint32_t lost_wakeups = 0;
+    uint64_t waits = 0;
+    while (expected < PQ_STRESS_PACKETS) {
+        const linx_packet_queue_entry_t* entry = linx_packet_queue_peek(stress.queue);
+        if (entry) {
+            if (!pq_packet_check(entry, expected)) {
+                mismatches++;
+            }
+            linx_packet_queue_pop(stress.queue);
+            expected++;
+            continue;
+        }
+        // 等待前再确认一次为空，与生产者的 was_empty 判断配对
+        if (!linx_packet_queue_is_empty(stress.queue)) {
+            continue;
+        }
+        // 超时后继续取，避免生产者停在队满上
+        waits++;
+        if (!linx_sem_take(stress.wake, PQ_WAKE_TIMEOUT_MS) && !linx_packet_queue_is_empty(stress.queue)) {
+            lost_wakeups++;
+        }
+    }
+    pthread_join(producer, NULL);
+
+    printf("  等待 %llu 次，唤醒 %llu 次，队满重试 %llu 次\n", (unsigned long long)waits,
+           (unsigned long long)stress.wakeups, (unsigned long long)stress.full_retries);
+    PQ_CHECK(expected == PQ_STRESS_PACKETS, "收到全部包");
+    PQ_CHECK(mismatches == 0, "包的顺序和内容全部正确（含超长包）");
+    PQ_CHECK(lost_wakeups == 0, "没有丢失唤醒");
+    // 队满与否取决于调度，只要求消费者确实进入过等待
+    PQ_CHECK(waits > 0, "消费者经过了队列取空后的等待");
+    PQ_CHECK(linx_packet_queue_is_empty(stress.queue), "结束时队列为空");
+
+    linx_packet_queue_destroy(stress.queue);
+    linx_sem_destroy(stress.wake);
+}
+
+int play_packet_queue_main(void) {
+    printf("=== 编码包队列测试 ===\n");
+    test_single_thread();
+    test_producer_consumer();
+    printf("编码包队列测试: %s（%d 项失败）\n", s_failures == 0 ? "通过" : "失败", s_failures);
+    return s_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,20 @@
+/**
+ * @file play_packet_queue.h
+ * @brief 编码包 SPSC 队列测试
+ *
+ * 单线程检查先进先出、内联与超长包（单独分配）的存取、队满和 was_empty 标志；双线程
+ * 检查生产者/消费者并发时包的顺序和内容，以及生产者只在队列由空变为非空时唤醒消费者、
+ * 消费者等待前用 linx_packet_queue_is_empty() 确认的握手不会丢失唤醒。
+ * 不需要声卡，建议同时用 -fsanitize=thread 构建运行。
+ */
+
+#ifndef PLAY_PACKET_QUEUE_H
+#define PLAY_PACKET_QUEUE_H
+
+/**
+ * 运行编码包队列测试
+ * @return 0 成功，1 失败
+ */
+int play_packet_queue_main(void);
+
+#endif /* PLAY_PACKET_QUEUE_H */
@@ -0,0 +1,757 @@
+/**
+ * @file play_sound.c
+ * @brief Linx Player 本地提示音测试
+ *
+ * 播放器使用外部循环模式，每次 linx_player_process() 最多输出一帧，虚拟设备把写入的 PCM
+ * 全部记录下来。TTS 与提示音的混音结果按播放器的算法（Q15 增益逐样本过渡、饱和相加）
+ * 在测试中独立计算，和设备收到的数据逐样本比较：同样的包先单独播放一遍作为参照，
+ * 再在新的播放器和解码器上叠加提示音播放一遍。
+ * 软件音量用恒定电平的提示音检查过渡的平滑性、稳定后的增益，以及恢复播放后的淡入。
+ * 句间衔接检查欠载时 PLC 帧的数量和淡出、下一句首包立即播出，以及新回复不沿用尾音。
+ * 附加播放流用同样的包作为第二路流，检查单独播放与参照一致，以及与 TTS 混音时按优先级压低。
+ * 播出位置检查写入设备的帧数、设备报告的输出延迟和此刻播出的 TTS 时间戳。
+ */
+
+#include "play_sound.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "../linx_player.h"
+#include "../linx_sound_bank.h"
+#include "../../audio/audio_interface.h"
+#include "../../audio/audio_dsp.h"
+#include "../../codecs/audio_codec.h"
+#include "../../codecs/opus_codec.h"
+#include "../../log/linx_log.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define SOUND_SAMPLE_RATE   16000
+#define SOUND_FRAME_SAMPLES 320     // 20ms
+#define SOUND_PACKETS       20
+#define SOUND_MAX_PACKET    400
+#define SOUND_CAPTURE_MAX   (SOUND_FRAME_SAMPLES * 64)
+#define SOUND_DUCK_DB       12
+#define SOUND_RAMP_MS       20
+
+// ==================== 记录输出的虚拟设备 ====================
+
+typedef struct {
+    int16_t pcm[SOUND_CAPTURE_MAX];
+    size_t count;
+    uint32_t play_delay_us;         // 报告的输出延迟，0 表示不提供
+} capture_device_t;
+
+static int cap_init(AudioInterface* self) {
+    self->is_initialized = true;
+    return 0;
+}
+
+static void cap_set_config(AudioInterface* self, unsigned int sample_rate, int frame_size,
+                           int channels, int periods, int buffer_size, int period_size) {
+    self->sample_rate = sample_rate;
+    self->frame_size = frame_size;
+    self->channels = channels;
+    self->periods = periods;
+    self->buffer_size = buffer_size;
+    self->period_size = period_size;
+}
+
+static int cap_init_play(AudioInterface* self) {
+    self->is_playing = true;
+    return 0;
+}
+
+static int cap_write(AudioInterface* self, short* buffer, size_t frame_size) {
+    capture_device_t* dev = (capture_device_t*)self->impl_data;
+    size_t room = SOUND_CAPTURE_MAX - dev->count;
+    size_t count = frame_size < room ? frame_size : room;
+    memcpy(dev->pcm + dev->count, buffer, count * sizeof(int16_t));
+    dev->count += count;
+    return 0;
+}
+
+static int cap_get_play_delay(AudioInterface* self, uint32_t* delay_us) {
+    capture_device_t* dev = (capture_device_t*)self->impl_data;
+    if (dev->play_delay_us == 0) {
+        return -1;
+    }
+    *delay_us = dev->play_delay_us;
+    return 0;
+}
+
+static int cap_destroy(AudioInterface* self) {
+    (void)self;
+    return 0;
+}
+
+static const AudioInterfaceVTable cap_vtable = {
+    .init = cap_init,
+    .set_config = cap_set_config,
+    .write = cap_write,
+    .init_play = cap_init_play,
+    .get_play_delay = cap_get_play_delay,
+    .destroy = cap_destroy,
+};
+
+// ==================== 测试工具 ====================
+
+typedef struct {
+    capture_device_t device;
+    AudioInterface audio;
+    audio_codec_t* decoder;
+    linx_player_t* player;
+} sound_rig_t;
+
+static int failures = 0;
+
+#define SOUND_CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        printf("[FAIL] "); \
+        printf(__VA_ARGS__); \
+        printf("\n"); \
+        failures++; \
+    } \
+} while (0)
+
+static audio_codec_t* create_codec(bool encoder) {
+    audio_codec_t* codec = opus_codec_create();
+    audio_format_t format;
+    audio_format_init(&format, SOUND_SAMPLE_RATE, 1, 16, 20);
+    codec_error_t result = !codec ? CODEC_INITIALIZATION_FAILED :
+                           encoder ? audio_codec_init_encoder(codec, &format)
+                                   : audio_codec_init_decoder(codec, &format);
+    if (result != CODEC_SUCCESS) {
+        audio_codec_destroy(codec);
+        return NULL;
+    }
+    return codec;
+}
+
+static bool rig_open(sound_rig_t* rig) {
+    memset(rig, 0, sizeof(*rig));
+    rig->audio.vtable = &cap_vtable;
+    rig->audio.impl_data = &rig->device;
+    rig->decoder = create_codec(false);
+    rig->player = rig->decoder ? linx_player_create(&rig->audio, rig->decoder) : NULL;
+
+    player_audio_config_t config = {
+        .sample_rate = SOUND_SAMPLE_RATE,
+        .channels = 1,
+        .frame_size = SOUND_FRAME_SAMPLES,
+        .buffer_size = 8192,
+        .external_loop = true,
+        .sound_duck_db = SOUND_DUCK_DB,
+        .sound_duck_ramp_ms = SOUND_RAMP_MS,
+    };
+    if (!rig->player || linx_player_init(rig->player, &config) != PLAYER_SUCCESS ||
+        linx_player_start(rig->player) != PLAYER_SUCCESS) {
+        printf("[ERROR] 播放器初始化失败\n");
+        return false;
+    }
+    return true;
+}
+
+static void rig_close(sound_rig_t* rig) {
+    linx_player_destroy(rig->player);
+    audio_codec_destroy(rig->decoder);
+}
+
+/* 逐帧驱动外部循环，直到没有 TTS 也没有提示音 */
+static void rig_run(sound_rig_t* rig, size_t max_frames) {
+    for (size_t i = 0; i < max_frames; i++) {
+        size_t before = rig->device.count;
+        int next_timeout_ms = -1;
+        linx_player_process(rig->player, 1, &next_timeout_ms);
+        if (rig->device.count == before && !linx_player_is_sound_playing(rig->player, 0)) {
+            break;
+        }
+    }
+}
+
+/* 440Hz 正弦编码的包，sizes 为每包字节数 */
+static uint8_t* encode_packets(uint16_t* sizes) {
+    audio_codec_t* encoder = create_codec(true);
+    uint8_t* packets = encoder ? (uint8_t*)malloc(SOUND_PACKETS * SOUND_MAX_PACKET) : NULL;
+    int16_t pcm[SOUND_FRAME_SAMPLES];
+    double phase = 0.0;
+    for (int seq = 0; packets && seq < SOUND_PACKETS; seq++) {
+        for (int i = 0; i < SOUND_FRAME_SAMPLES; i++) {
+            pcm[i] = (int16_t)(sin(phase) * 12000.0);
+            phase += 2.0 * M_PI * 440.0 / SOUND_SAMPLE_RATE;
+        }
+        size_t encoded = 0;
+        if (audio_codec_encode(encoder, pcm, SOUND_FRAME_SAMPLES, packets + seq * SOUND_MAX_PACKET,
+                               SOUND_MAX_PACKET, &encoded) != CODEC_SUCCESS) {
+            encoded = 0;
+        }
+        sizes[seq] = (uint16_t)encoded;
+    }
+    audio_codec_destroy(encoder);
+    return packets;
+}
+
+static void feed_packets(linx_player_t* player, const uint8_t* packets, const uint16_t* sizes) {
+    for (int seq = 0; seq < SOUND_PACKETS; seq++) {
+        linx_player_feed_packet(player, packets + seq * SOUND_MAX_PACKET, sizes[seq],
+                                (uint32_t)seq * 20, true);
+    }
+}
+
+static int16_t saturate(int32_t value) {
+    return (int16_t)(value > 32767 ? 32767 : (value < -32768 ? -32768 : value));
+}
+
+static void make_chirp(int16_t* pcm, size_t samples) {
+    for (size_t i = 0; i < samples; i++) {
+        pcm[i] = (int16_t)(sin(2.0 * M_PI * (300.0 + (double)i * 0.2) * (double)i / SOUND_SAMPLE_RATE) * 20000.0);
+    }
+}
+
+// ==================== 测试用例 ====================
+
+/**
+ * 没有 TTS 时单独输出提示音，按帧补齐静音
+ */
+static void test_sound_alone(void) {
+    printf("[INFO] 单独播放提示音\n");
+    static int16_t chirp[1000];
+    make_chirp(chirp, 1000);
+
+    sound_rig_t rig;
+    if (!rig_open(&rig)) {
+        failures++;
+        rig_close(&rig);
+        return;
+    }
+
+    uint32_t id = 0;
+    SOUND_CHECK(linx_player_play_sound(rig.player, chirp, 1000, 0.5f, false, &id) == PLAYER_SUCCESS && id != 0,
+                "play_sound 失败");
+    SOUND_CHECK(linx_player_is_sound_playing(rig.player, id), "提示音应在播放");
+    rig_run(&rig, 16);
+
+    SOUND_CHECK(rig.device.count == 4 * SOUND_FRAME_SAMPLES, "输出 %zu 个样本，应为 %d", rig.device.count,
+                4 * SOUND_FRAME_SAMPLES);
+    size_t mismatches = 0;
+    for (size_t i = 0; i < rig.device.count; i++) {
+        int16_t expected = i < 1000 ? (int16_t)((chirp[i] * 16384) >> 15) : 0;
+        mismatches += rig.device.pcm[i] != expected;
+    }
+    SOUND_CHECK(mismatches == 0, "单独播放有 %zu 个样本不一致", mismatches);
+    SOUND_CHECK(!linx_player_is_sound_playing(rig.player, id), "提示音应已结束");
+
+    // 同时播放的数量上限与停止
+    uint32_t ids[LINX_PLAYER_MAX_SOUNDS];
+    for (int i = 0; i < LINX_PLAYER_MAX_SOUNDS; i++) {
+        SOUND_CHECK(linx_player_play_sound(rig.player, chirp, 1000, 1.0f, false, &ids[i]) == PLAYER_SUCCESS,
+                    "第 %d 个提示音失败", i + 1);
+    }
+    SOUND_CHECK(linx_player_play_sound(rig.player, chirp, 1000, 1.0f, false, NULL) == PLAYER_ERROR_BUFFER_FULL,
+                "超过上限应返回 BUFFER_FULL");
+    linx_player_stop_sound(rig.player, ids[0]);
+    SOUND_CHECK(!linx_player_is_sound_playing(rig.player, ids[0]) && linx_player_is_sound_playing(rig.player, ids[1]),
+                "只应停止指定的提示音");
+    linx_player_stop_sound(rig.player, 0);
+    SOUND_CHECK(!linx_player_is_sound_playing(rig.player, 0), "应全部停止");
+
+    rig_close(&rig);
+}
+
+/**
+ * 与 TTS 逐样本混音；duck 为 true 时验证压低和恢复的过渡
+ */
+static void test_sound_mix(const uint8_t* packets, const uint16_t* sizes, bool duck) {
+    printf("[INFO] 与 TTS 混音（%s）\n", duck ? "压低 TTS" : "不压低");
+    enum { SOUND_SAMPLES = SOUND_FRAME_SAMPLES * 10 };
+    static int16_t chirp[SOUND_SAMPLES];
+    make_chirp(chirp, SOUND_SAMPLES);
+
+    // 参照：同样的包单独播放
+    sound_rig_t* reference = (sound_rig_t*)calloc(1, sizeof(sound_rig_t));
+    sound_rig_t* mixed = (sound_rig_t*)calloc(1, sizeof(sound_rig_t));
+    if (!reference || !mixed || !rig_open(reference) || !rig_open(mixed)) {
+        failures++;
+        goto cleanup;
+    }
+    feed_packets(reference->player, packets, sizes);
+    rig_run(reference, 64);
+
+    feed_packets(mixed->player, packets, sizes);
+    linx_player_play_sound(mixed->player, chirp, SOUND_SAMPLES, 1.0f, duck, NULL);
+    rig_run(mixed, 64);
+
+    SOUND_CHECK(reference->device.count >= SOUND_SAMPLES + 2 * SOUND_FRAME_SAMPLES,
+                "参照输出过短: %zu", reference->device.count);
+    SOUND_CHECK(mixed->device.count == reference->device.count, "混音输出 %zu 个样本，参照 %zu 个",
+                mixed->device.count, reference->device.count);
+
+    // 独立计算期望：增益在提示音期间向压低目标过渡，结束后（下一帧起）恢复
+    int32_t target = duck ? (int32_t)(32768 * powf(10.0f, -(float)SOUND_DUCK_DB / 20.0f)) : 32768;
+    int32_t step = (32768 - target) / (SOUND_SAMPLE_RATE * SOUND_RAMP_MS / 1000);
+    if (step <= 0) {
+        step = 1;
+    }
+    int32_t gain = 32768;
+    size_t mismatches = 0;
+    size_t count = mixed->device.count < reference->device.count ? mixed->device.count : reference->device.count;
+    for (size_t i = 0; i < count; i++) {
+        int32_t want = i < SOUND_SAMPLES ? target : 32768;
+        if (gain < want) {
+            gain = gain + step < want ? gain + step : want;
+        } else if (gain > want) {
+            gain = gain - step > want ? gain - step : want;
+        }
+        int32_t value = (reference->device.pcm[i] * gain) >> 15;
+        if (i < SOUND_SAMPLES) {
+            value += chirp[i];
+        }
+        if (mixed->device.pcm[i] != saturate(value)) {
+            if (mismatches++ == 0) {
+                printf("[INFO] 第一个不一致: 样本 %zu 输出 %d 期望 %d\n", i, mixed->device.pcm[i], saturate(value));
+            }
+        }
+    }
+    SOUND_CHECK(mismatches == 0, "混音有 %zu 个样本不一致", mismatches);
+    SOUND_CHECK(gain == 32768, "TTS 增益应已恢复");
+
+cleanup:
+    if (reference) rig_close(reference);
+    if (mixed) rig_close(mixed);
+    free(reference);
+    free(mixed);
+}
+
+/* 长度前缀格式的资源：每包 2 字节大端长度 + 数据 */
+static uint8_t* build_packet_asset(const uint8_t* packets, const uint16_t* sizes, int count, size_t* size) {
+    uint8_t* blob = (uint8_t*)malloc((size_t)count * (SOUND_MAX_PACKET + 2));
+    size_t offset = 0;
+    for (int seq = 0; blob && seq < count; seq++) {
+        blob[offset++] = (uint8_t)(sizes[seq] >> 8);
+        blob[offset++] = (uint8_t)sizes[seq];
+        memcpy(blob + offset, packets + seq * SOUND_MAX_PACKET, sizes[seq]);
+        offset += sizes[seq];
+    }
+    *size = offset;
+    return blob;
+}
+
+/**
+ * 提示音库：PCM 资源不拷贝，编码资源解码一次并缓存，超出上限按最久未使用淘汰
+ */
+static void test_sound_bank(const uint8_t* packets, const uint16_t* sizes) {
+    printf("[INFO] 提示音库\n");
+    static int16_t chirp[800];
+    make_chirp(chirp, 800);
+    size_t blob_size = 0;
+    uint8_t* blob = build_packet_asset(packets, sizes, 10, &blob_size);
+    audio_codec_t* decoder = create_codec(false);
+    // 上限只放得下一段 10 帧的解码结果
+    linx_sound_bank_t* bank = decoder ? linx_sound_bank_create(decoder, 10 * SOUND_FRAME_SAMPLES * sizeof(int16_t) + 100)
+                                      : NULL;
+    sound_rig_t* rig = (sound_rig_t*)calloc(1, sizeof(sound_rig_t));
+    if (!blob || !bank || !rig || !rig_open(rig)) {
+        failures++;
+        goto cleanup;
+    }
+
+    linx_sound_asset_t beep = { "beep", LINX_SOUND_PCM16, chirp, sizeof(chirp) };
+    linx_sound_asset_t hello = { "hello", LINX_SOUND_PACKETS, blob, blob_size };
+    linx_sound_asset_t bye = { "bye", LINX_SOUND_PACKETS, blob, blob_size };
+    int beep_id = linx_sound_bank_add(bank, &beep);
+    int hello_id = linx_sound_bank_add(bank, &hello);
+    int bye_id = linx_sound_bank_add(bank, &bye);
+    SOUND_CHECK(beep_id == 0 && hello_id == 1 && bye_id == 2, "资源编号错误");
+    SOUND_CHECK(linx_sound_bank_find(bank, "bye") == bye_id && linx_sound_bank_find(bank, "none") == -1,
+                "按名称查找错误");
+
+    size_t samples = 0;
+    SOUND_CHECK(linx_sound_bank_get(bank, beep_id, &samples) == chirp && samples == 800, "PCM 资源不应拷贝");
+    const int16_t* pcm = linx_sound_bank_get(bank, hello_id, &samples);
+    SOUND_CHECK(pcm && samples == 10 * SOUND_FRAME_SAMPLES, "解码得到 %zu 个样本", samples);
+    SOUND_CHECK(linx_sound_bank_get(bank, hello_id, &samples) == pcm, "第二次使用应命中缓存");
+
+    linx_sound_bank_stats_t stats;
+    linx_sound_bank_get_stats(bank, &stats);
+    SOUND_CHECK(stats.assets == 3 && stats.decodes == 1 && stats.evictions == 0, "统计错误");
+
+    // 超出上限时淘汰最久未使用的 hello
+    SOUND_CHECK(linx_sound_bank_load(bank, bye_id), "预解码失败");
+    linx_sound_bank_get_stats(bank, &stats);
+    SOUND_CHECK(stats.decodes == 2 && stats.evictions == 1 && stats.cached_bytes == 10 * SOUND_FRAME_SAMPLES * 2,
+                "淘汰统计错误: 解码 %zu 淘汰 %zu 缓存 %zu", stats.decodes, stats.evictions, stats.cached_bytes);
+
+    // 正在播放的 bye 不会被淘汰，超出上限也保留
+    uint32_t id = 0;
+    SOUND_CHECK(linx_sound_bank_play(bank, rig->player, bye_id, 1.0f, false, &id) == PLAYER_SUCCESS, "播放失败");
+    SOUND_CHECK(linx_sound_bank_load(bank, hello_id), "重新解码失败");
+    linx_sound_bank_get_stats(bank, &stats);
+    SOUND_CHECK(stats.evictions == 1 && stats.cached_bytes == 2 * 10 * SOUND_FRAME_SAMPLES * 2,
+                "正在播放的资源被淘汰");
+    rig_run(rig, 64);
+    SOUND_CHECK(rig->device.count == 10 * SOUND_FRAME_SAMPLES, "播放输出 %zu 个样本", rig->device.count);
+    linx_player_stop_sound(rig->player, 0);
+
+cleanup:
+    if (rig) rig_close(rig);
+    free(rig);
+    linx_sound_bank_destroy(bank);
+    audio_codec_destroy(decoder);
+    free(blob);
+}
+
+/**
+ * 增益过渡内核与逐样本计算一致（覆盖向量路径和尾部）
+ */
+static void test_gain_ramp_kernel(void) {
+    printf("[INFO] 增益过渡内核（%s）\n", audio_dsp_backend());
+    static const float gains[][2] = { { 1.0f, 0.25f }, { 0.0f, 1.0f }, { 0.5f, 7.9f }, { 2.0f, 2.0f } };
+    int16_t input[77];
+    int16_t output[77];
+    for (size_t i = 0; i < 77; i++) {
+        input[i] = (int16_t)((i * 7919u) % 65536u - 32768);
+    }
+
+    size_t mismatches = 0;
+    for (size_t g = 0; g < sizeof(gains) / sizeof(gains[0]); g++) {
+        for (size_t count = 1; count <= 77; count += 4) {
+            memcpy(output, input, sizeof(output));
+            audio_dsp_gain_ramp(output, count, gains[g][0], gains[g][1]);
+            int32_t q_start = (int32_t)lrintf(gains[g][0] * 4096.0f);
+            int32_t q_end = (int32_t)lrintf(gains[g][1] * 4096.0f);
+            int32_t step = (int32_t)((int64_t)(q_end - q_start) * 32768 / (int64_t)count);
+            for (size_t i = 0; i < count; i++) {
+                int32_t gain = (q_start * 32768 + (int32_t)i * step) >> 15;
+                mismatches += output[i] != saturate((input[i] * gain + 2048) >> 12);
+            }
+        }
+    }
+    SOUND_CHECK(mismatches == 0, "增益过渡有 %zu 个样本不一致", mismatches);
+}
+
+/* 检查一段输出单调变化且相邻样本的跳变不超过 max_step */
+static void check_smooth(const int16_t* pcm, size_t count, bool rising, int max_step, const char* what) {
+    size_t bad = 0;
+    for (size_t i = 1; i < count; i++) {
+        int diff = pcm[i] - pcm[i - 1];
+        bad += (rising ? diff < 0 : diff > 0) || abs(diff) > max_step;
+    }
+    SOUND_CHECK(bad == 0, "%s: %zu 处不平滑", what, bad);
+}
+
+/**
+ * 软件音量：按 dB 平滑过渡到目标增益，静音，恢复播放后淡入
+ */
+static void test_volume(void) {
+    printf("[INFO] 软件音量\n");
+    static int16_t level[4000];
+    for (size_t i = 0; i < 4000; i++) {
+        level[i] = 20000;
+    }
+
+    sound_rig_t rig;
+    if (!rig_open(&rig)) {
+        failures++;
+        rig_close(&rig);
+        return;
+    }
+
+    // 默认 30ms 过渡：7 个 64 样本的块，之后稳定在一半
+    const size_t ramp = 7 * 64;
+    SOUND_CHECK(linx_player_set_volume_db(rig.player, -6.0206f) == PLAYER_SUCCESS, "设置音量失败");
+    SOUND_CHECK(fabsf(linx_player_get_volume_db(rig.player) + 6.0206f) < 0.001f, "音量读回错误");
+    SOUND_CHECK(linx_player_play_sound(rig.player, level, 4000, 1.0f, false, NULL) == PLAYER_SUCCESS,
+                "play_sound 失败");
+    rig_run(&rig, 4);
+    const int16_t* out = rig.device.pcm;
+    SOUND_CHECK(rig.device.count == 4 * SOUND_FRAME_SAMPLES, "输出 %zu 个样本", rig.device.count);
+    SOUND_CHECK(out[0] > 19900, "过渡应从原始音量开始（%d）", out[0]);
+    check_smooth(out, 4 * SOUND_FRAME_SAMPLES, false, 64, "降低音量");
+    size_t off = 0;
+    for (size_t i = ramp; i < 4 * SOUND_FRAME_SAMPLES; i++) {
+        off += out[i] != 10000;
+    }
+    SOUND_CHECK(off == 0, "过渡后 %zu 个样本不是一半音量", off);
+
+    // 静音：过渡后输出全零
+    size_t start = rig.device.count;
+    linx_player_set_volume(rig.player, 0);
+    rig_run(&rig, 4);
+    check_smooth(out + start, rig.device.count - start, false, 128, "静音");
+    off = 0;
+    for (size_t i = start + ramp; i < rig.device.count; i++) {
+        off += out[i] != 0;
+    }
+    SOUND_CHECK(off == 0, "静音后 %zu 个样本不为零", off);
+
+    // 恢复原始音量后暂停，恢复时从静音淡入
+    linx_player_set_volume(rig.player, 100);
+    rig_run(&rig, 2);
+    linx_player_pause(rig.player);
+    linx_player_resume(rig.player);
+    start = rig.device.count;
+    rig_run(&rig, 2);
+    SOUND_CHECK(rig.device.count - start == 2 * SOUND_FRAME_SAMPLES, "恢复后输出 %zu 个样本", rig.device.count - start);
+    SOUND_CHECK(out[start] < 100, "恢复播放应从静音淡入（%d）", out[start]);
+    check_smooth(out + start, rig.device.count - start, true, 2000, "淡入");
+    SOUND_CHECK(out[rig.device.count - 1] == 20000, "淡入后应为原始音量（%d）", out[rig.device.count - 1]);
+
+    rig_close(&rig);
+}
+
+static uint64_t frame_energy(const int16_t* pcm) {
+    uint64_t energy = 0;
+    for (size_t i = 0; i < SOUND_FRAME_SAMPLES; i++) {
+        energy += (uint64_t)((int32_t)pcm[i] * pcm[i]);
+    }
+    return energy;
+}
+
+/**
+ * 句间衔接：回复中途欠载时输出淡出的 PLC，下一句第一个包到达立即播放，
+ * 衔接最多 200ms（默认值）并淡到静音；新的回复不沿用上一段的尾音
+ */
+static void test_gapless(const uint8_t* packets, const uint16_t* sizes) {
+    printf("[INFO] 句间衔接\n");
+    sound_rig_t rig;
+    if (!rig_open(&rig)) {
+        failures++;
+        rig_close(&rig);
+        return;
+    }
+    linx_player_set_continuation(rig.player, true);
+
+    // 第一句 10 帧，之后缓冲区为空：每次 process 输出一帧衔接音频
+    const int half = SOUND_PACKETS / 2;
+    for (int seq = 0; seq < half; seq++) {
+        linx_player_feed_packet(rig.player, packets + seq * SOUND_MAX_PACKET, sizes[seq], (uint32_t)seq * 20, true);
+    }
+    for (int i = 0; i < half + 3; i++) {
+        linx_player_process(rig.player, 1, NULL);
+    }
+    const int16_t* out = rig.device.pcm;
+    SOUND_CHECK(rig.device.count == (size_t)(half + 3) * SOUND_FRAME_SAMPLES,
+                "衔接期间输出 %zu 个样本", rig.device.count);
+    uint64_t first = frame_energy(out + half * SOUND_FRAME_SAMPLES);
+    uint64_t third = frame_energy(out + (half + 2) * SOUND_FRAME_SAMPLES);
+    SOUND_CHECK(first > 0 && third < first, "衔接音频应逐渐淡出（%llu -> %llu）",
+                (unsigned long long)first, (unsigned long long)third);
+    size_t concealed = 0;
+    linx_player_get_loss_stats(rig.player, &concealed, NULL);
+    SOUND_CHECK(concealed == 3, "衔接帧计入 PLC（%zu）", concealed);
+
+    // 第二句的第一个包不等预缓冲，下一次 process 就播出
+    size_t start = rig.device.count;
+    linx_player_feed_packet(rig.player, packets + half * SOUND_MAX_PACKET, sizes[half], (uint32_t)half * 20, true);
+    linx_player_process(rig.player, 1, NULL);
+    SOUND_CHECK(rig.device.count - start == SOUND_FRAME_SAMPLES, "第二句首包应立即播出（%zu 个样本）",
+                rig.device.count - start);
+
+    // 播完第二句后一直没有新包：衔接 10 帧淡到静音后停止
+    for (int seq = half + 1; seq < SOUND_PACKETS; seq++) {
+        linx_player_feed_packet(rig.player, packets + seq * SOUND_MAX_PACKET, sizes[seq], (uint32_t)seq * 20, true);
+    }
+    start = rig.device.count;
+    rig_run(&rig, 64);
+    size_t frames = (rig.device.count - start) / SOUND_FRAME_SAMPLES;
+    SOUND_CHECK(frames == (size_t)(SOUND_PACKETS - half - 1) + 10, "第二句之后输出 %zu 帧", frames);
+    int peak = 0;
+    for (size_t i = rig.device.count - SOUND_FRAME_SAMPLES / 4; i < rig.device.count; i++) {
+        peak = abs(out[i]) > peak ? abs(out[i]) : peak;
+    }
+    SOUND_CHECK(peak < 1000, "衔接结束时应接近静音（%d）", peak);
+
+    // 回复结束后开始新的回复：缓冲区为空时不再衔接
+    linx_player_set_continuation(rig.player, false);
+    linx_player_set_continuation(rig.player, true);
+    start = rig.device.count;
+    rig_run(&rig, 4);
+    SOUND_CHECK(rig.device.count == start, "新回复不应沿用上一段的尾音");
+
+    rig_close(&rig);
+}
+
+/**
+ * 播出位置：写入帧数、设备输出延迟、此刻播出的 TTS 时间戳；清空后不再有时间戳
+ */
+static void test_position(const uint8_t* packets, const uint16_t* sizes) {
+    printf("[INFO] 播出位置\n");
+    sound_rig_t rig;
+    if (!rig_open(&rig)) {
+        failures++;
+        rig_close(&rig);
+        return;
+    }
+
+    linx_player_position_t position;
+    SOUND_CHECK(linx_player_get_position(rig.player, &position) == PLAYER_SUCCESS &&
+                position.frames_written == 0 && !position.has_timestamp, "开始时不应有播出位置");
+
+    feed_packets(rig.player, packets, sizes);
+    rig_run(&rig, 64);
+    linx_player_get_position(rig.player, &position);
+    SOUND_CHECK(position.frames_written == rig.device.count, "写入 %llu 帧，设备收到 %zu 个样本",
+                (unsigned long long)position.frames_written, rig.device.count);
+    SOUND_CHECK(!position.device_delay && position.frames_played == position.frames_written,
+                "设备不提供延迟时按已写入计算");
+    SOUND_CHECK(position.has_timestamp && position.timestamp == SOUND_PACKETS * 20,
+                "播出位置时间戳 %u", (unsigned)position.timestamp);
+
+    // 设备还有 60ms 没有播出
+    rig.device.play_delay_us = 60000;
+    linx_player_get_position(rig.player, &position);
+    SOUND_CHECK(position.device_delay && position.output_delay_us == 60000, "输出延迟 %u us",
+                (unsigned)position.output_delay_us);
+    SOUND_CHECK(position.frames_played == position.frames_written - SOUND_SAMPLE_RATE * 60 / 1000,
+                "已播出 %llu 帧", (unsigned long long)position.frames_played);
+    SOUND_CHECK(position.timestamp == SOUND_PACKETS * 20 - 60, "扣除延迟后的时间戳 %u",
+                (unsigned)position.timestamp);
+
+    linx_player_flush(rig.player);
+    linx_player_get_position(rig.player, &position);
+    SOUND_CHECK(!position.has_timestamp, "清空后不应有时间戳");
+
+    rig_close(&rig);
+}
+
+/* 打开一路附加播放流并放入全部包，decoder 由调用方销毁 */
+static linx_mixer_stream_t* open_stream(linx_player_t* player, audio_codec_t* decoder, int priority,
+                                        const uint8_t* packets, const uint16_t* sizes) {
+    linx_mixer_stream_config_t config = { .decoder = decoder, .priority = priority };
+    linx_mixer_stream_t* stream = decoder ? linx_player_open_stream(player, &config) : NULL;
+    for (int seq = 0; stream && seq < SOUND_PACKETS; seq++) {
+        linx_player_stream_feed(player, stream, packets + seq * SOUND_MAX_PACKET, sizes[seq]);
+    }
+    return stream;
+}
+
+/**
+ * 附加播放流：没有 TTS 时单独输出，与参照逐样本一致；流数上限
+ */
+static void test_stream_alone(const uint8_t* packets, const uint16_t* sizes) {
+    printf("[INFO] 单独播放附加流\n");
+    sound_rig_t* reference = (sound_rig_t*)calloc(1, sizeof(sound_rig_t));
+    sound_rig_t* rig = (sound_rig_t*)calloc(1, sizeof(sound_rig_t));
+    audio_codec_t* decoder = create_codec(false);
+    if (!reference || !rig || !decoder || !rig_open(reference) || !rig_open(rig)) {
+        failures++;
+        goto cleanup;
+    }
+    feed_packets(reference->player, packets, sizes);
+    rig_run(reference, 64);
+
+    linx_mixer_stream_t* stream = open_stream(rig->player, decoder, LINX_MIXER_PRIORITY_MEDIA, packets, sizes);
+    SOUND_CHECK(stream && linx_player_is_stream_playing(rig->player, stream), "流应在播放");
+    rig_run(rig, 64);
+    SOUND_CHECK(rig->device.count == reference->device.count, "流输出 %zu 个样本，参照 %zu 个",
+                rig->device.count, reference->device.count);
+    size_t count = rig->device.count < reference->device.count ? rig->device.count : reference->device.count;
+    size_t mismatches = 0;
+    for (size_t i = 0; i < count; i++) {
+        mismatches += rig->device.pcm[i] != reference->device.pcm[i];
+    }
+    SOUND_CHECK(mismatches == 0, "单独播放有 %zu 个样本不一致", mismatches);
+    SOUND_CHECK(!linx_player_is_stream_playing(rig->player, stream), "流应已播完");
+
+    // 同时打开的流数上限，关闭后可以重新打开
+    linx_mixer_stream_t* streams[LINX_MIXER_MAX_STREAMS];
+    linx_mixer_stream_config_t config = { .decoder = decoder };
+    streams[0] = stream;
+    for (int i = 1; i < LINX_MIXER_MAX_STREAMS; i++) {
+        streams[i] = linx_player_open_stream(rig->player, &config);
+        SOUND_CHECK(streams[i] != NULL, "第 %d 路流打开失败", i + 1);
+    }
+    SOUND_CHECK(linx_player_open_stream(rig->player, &config) == NULL, "超过上限应返回 NULL");
+    linx_player_close_stream(rig->player, streams[0]);
+    SOUND_CHECK(linx_player_open_stream(rig->player, &config) != NULL, "关闭后应能重新打开");
+
+cleanup:
+    if (reference) rig_close(reference);
+    if (rig) rig_close(rig);
+    audio_codec_destroy(decoder);
+    free(reference);
+    free(rig);
+}
+
+/**
+ * 附加播放流与 TTS 混音：媒体流在 TTS 期间被压低，TTS 停下后保持压低；告警流压低 TTS
+ */
+static void test_stream_mix(const uint8_t* packets, const uint16_t* sizes, int priority) {
+    bool alert = priority > LINX_MIXER_PRIORITY_VOICE;
+    printf("[INFO] 附加流与 TTS 混音（%s）\n", alert ? "告警压低 TTS" : "TTS 压低媒体");
+    const int half = SOUND_PACKETS / 2;
+    sound_rig_t* reference = (sound_rig_t*)calloc(1, sizeof(sound_rig_t));
+    sound_rig_t* rig = (sound_rig_t*)calloc(1, sizeof(sound_rig_t));
+    audio_codec_t* decoder = create_codec(false);
+    if (!reference || !rig || !decoder || !rig_open(reference) || !rig_open(rig)) {
+        failures++;
+        goto cleanup;
+    }
+    feed_packets(reference->player, packets, sizes);
+    rig_run(reference, 64);
+
+    // TTS 只有前一半的包，流有全部的包
+    for (int seq = 0; seq < half; seq++) {
+        linx_player_feed_packet(rig->player, packets + seq * SOUND_MAX_PACKET, sizes[seq], (uint32_t)seq * 20, true);
+    }
+    open_stream(rig->player, decoder, priority, packets, sizes);
+    rig_run(rig, 64);
+    SOUND_CHECK(rig->device.count == reference->device.count, "混音输出 %zu 个样本，参照 %zu 个",
+                rig->device.count, reference->device.count);
+
+    // 默认 50ms 过渡之后比较：被压低的一方乘以 12dB 的衰减（Q12 运算，允许 ±2 的误差）
+    float duck = powf(10.0f, -12.0f / 20.0f);
+    size_t start = (size_t)(SOUND_SAMPLE_RATE * 60 / 1000);
+    size_t tts_end = (size_t)half * SOUND_FRAME_SAMPLES;
+    size_t count = rig->device.count < reference->device.count ? rig->device.count : reference->device.count;
+    size_t mismatches = 0;
+    for (size_t i = start; i < count; i++) {
+        float tts = i < tts_end ? reference->device.pcm[i] : 0.0f;
+        float media = reference->device.pcm[i];
+        float want = alert ? tts * duck + media : tts + media * duck;
+        if (fabsf((float)rig->device.pcm[i] - want) > 2.0f) {
+            if (mismatches++ == 0) {
+                printf("[INFO] 第一个不一致: 样本 %zu 输出 %d 期望 %.0f\n", i, rig->device.pcm[i], want);
+            }
+        }
+    }
+    SOUND_CHECK(mismatches == 0, "混音有 %zu 个样本不一致", mismatches);
+
+cleanup:
+    if (reference) rig_close(reference);
+    if (rig) rig_close(rig);
+    audio_codec_destroy(decoder);
+    free(reference);
+    free(rig);
+}
+
+int play_sound_main(void) {
+    uint16_t sizes[SOUND_PACKETS];
+    uint8_t* packets = encode_packets(sizes);
+    if (!packets) {
+        printf("[ERROR] 编码测试数据失败\n");
+        return 1;
+    }
+
+    test_sound_alone();
+    test_sound_mix(packets, sizes, false);
+    test_sound_mix(packets, sizes, true);
+    test_sound_bank(packets, sizes);
+    test_gain_ramp_kernel();
+    test_volume();
+    test_gapless(packets, sizes);
+    test_stream_alone(packets, sizes);
+    test_stream_mix(packets, sizes, LINX_MIXER_PRIORITY_MEDIA);
+    test_stream_mix(packets, sizes, LINX_MIXER_PRIORITY_ALERT);
+    test_position(packets, sizes);
+    free(packets);
+
+    printf("[INFO] 提示音测试: %s（%d 项失败）\n", failures == 0 ? "通过" : "失败", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,18 @@
+/**
+ * @file play_sound.h
+ * @brief Linx Player 本地提示音测试
+ *
+ * 用记录全部输出的虚拟音频设备和外部循环模式逐样本检查提示音：单独播放、与 TTS 混音、
+ * 压低 TTS 的过渡、提示音库的解码缓存和淘汰、软件音量的过渡，以及句间的 PLC 衔接。不需要声卡。
+ */
+
+#ifndef PLAY_SOUND_H
+#define PLAY_SOUND_H
+
+/**
+ * 运行提示音测试
+ * @return 0 成功，1 失败
+ */
+int play_sound_main(void);
+
+#endif /* PLAY_SOUND_H */
@@ -0,0 +1,697 @@
+/**
+ * @file play_stress.c
+ * @brief Linx Player 网络损伤压力测试
+ *
+ * 发送端每 20ms 产生一个 Opus 包（时间戳 = 序号 × 20ms），网络模型为每个包决定是否丢失、
+ * 到达时刻（基础时延 + 抖动 + 乱序附加时延）以及是否重复到达；按到达时刻排序后由本线程
+ * 实时喂给播放器。抖动缓冲只有拿到时间戳才能识别乱序、重复和缺失，所以和协议 v2 一样
+ * 使用 linx_player_feed_packet() 传入时间戳。
+ *
+ * 输出写入虚拟音频设备：设备按采样率消费 PCM，内部缓冲满时 write 阻塞；写入时设备已经
+ * 播空即记一次欠载。输出抽头根据时间戳换算每帧从发送到开始播出的时延。
+ * 可以每隔若干帧让解码多耗时一段时间，模拟高复杂度帧和 CPU 抢占造成的解码尖峰。
+ *
+ * 到达轨迹文件每行 "send_ms recv_ms"，recv_ms 为 -1 表示丢失，同一 send_ms 出现多次表示
+ * 重复到达，'#' 开头为注释；测试时长超过轨迹时循环使用。
+ */
+
+#include "play_stress.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/resource.h>
+
+#include "../linx_player.h"
+#include "../../audio/audio_interface.h"
+#include "../../codecs/audio_codec.h"
+#include "../../codecs/opus_codec.h"
+#include "../../log/linx_log.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define STRESS_SAMPLE_RATE      16000
+#define STRESS_CHANNELS         1
+#define STRESS_FRAME_MS         20
+#define STRESS_FRAME_SAMPLES    (STRESS_SAMPLE_RATE * STRESS_FRAME_MS / 1000)
+#define STRESS_MAX_PACKET       400
+#define STRESS_DEVICE_BUFFER_MS 40      // 虚拟设备缓冲深度（声卡硬件缓冲）
+
+// ==================== 参数 ====================
+
+typedef enum {
+    JITTER_NONE,
+    JITTER_UNIFORM,     // [0, jitter_ms) 均匀分布
+    JITTER_NORMAL,      // |N(0, jitter_ms)|
+    JITTER_PARETO       // 形状 2 的帕累托分布，尺度 jitter_ms / 2（均值 jitter_ms），拖尾明显
+} jitter_dist_t;
+
+typedef struct {
+    int duration_s;
+    int base_delay_ms;
+    int jitter_ms;
+    jitter_dist_t jitter_dist;
+    double loss_percent;
+    double loss_burst;          // 平均突发丢包长度（包），1 为独立丢包
+    double reorder_percent;     // 被额外延迟 1-3 帧的包比例
+    double duplicate_percent;
+    const char* trace_path;
+    unsigned int seed;
+    int jb_target_ms;
+    int jb_max_ms;
+    bool jb_fixed;
+    bool conceal_loss;
+    int max_underruns;          // < 0 不检查
+    int decode_ahead;           // 播放器 decode_ahead_periods
+    int spike_ms;               // 解码尖峰时长，0 不模拟
+    int spike_every;            // 每隔多少帧出现一次解码尖峰
+} stress_config_t;
+
+// ==================== 虚拟音频设备 ====================
+
+typedef struct {
+    pthread_mutex_t mutex;
+    int sample_rate;
+    int channels;
+    bool started;
+    uint64_t drained_at_us;     // 已写入的 PCM 全部播完的时刻
+    uint64_t last_play_us;      // 最近一次写入的 PCM 开始播出的时刻
+    size_t underruns;
+    uint64_t underrun_us;       // 播空的总时长
+    size_t writes;
+} virtual_device_t;
+
+static uint64_t stress_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+static void stress_sleep_until_us(uint64_t deadline_us) {
+    uint64_t now = stress_now_us();
+    if (deadline_us <= now) return;
+    uint64_t wait = deadline_us - now;
+    struct timespec ts = { (time_t)(wait / 1000000ULL), (long)(wait % 1000000ULL) * 1000L };
+    nanosleep(&ts, NULL);
+}
+
+static int vdev_init(AudioInterface* self) {
+    self->is_initialized = true;
+    return 0;
+}
+
+static void vdev_set_config(AudioInterface* self, unsigned int sample_rate, int frame_size,
+                            int channels, int periods, int buffer_size, int period_size) {
+    virtual_device_t* dev = (virtual_device_t*)self->impl_data;
+    self->sample_rate = sample_rate;
+    self->frame_size = frame_size;
+    self->channels = channels;
+    self->periods = periods;
+    self->buffer_size = buffer_size;
+    self->period_size = period_size;
+    dev->sample_rate = (int)sample_rate;
+    dev->channels = channels > 0 ? channels : 1;
+}
+
+static int vdev_init_play(AudioInterface* self) {
+    self->is_playing = true;
+    return 0;
+}
+
+static int vdev_write(AudioInterface* self, short* buffer, size_t frame_size) {
+    virtual_device_t* dev = (virtual_device_t*)self->impl_data;
+    (void)buffer;
+
+    pthread_mutex_lock(&dev->mutex);
+    uint64_t now = stress_now_us();
+    uint64_t duration = (uint64_t)(frame_size / (size_t)dev->channels) * 1000000ULL / (uint64_t)dev->sample_rate;
+    if (!dev->started) {
+        dev->started = true;
+        dev->drained_at_us = now;
+    } else if (now > dev->drained_at_us) {
+        dev->underruns++;
+        dev->underrun_us += now - dev->drained_at_us;
+        dev->drained_at_us = now;
+    }
+    dev->last_play_us = dev->drained_at_us;
+    dev->drained_at_us += duration;
+    dev->writes++;
+    uint64_t wake = dev->drained_at_us - STRESS_DEVICE_BUFFER_MS * 1000ULL;
+    pthread_mutex_unlock(&dev->mutex);
+
+    // 设备缓冲满时阻塞，和真实声卡一样决定播放线程的节奏
+    stress_sleep_until_us(wake);
+    return 0;
+}
+
+static int vdev_flush_play(AudioInterface* self) {
+    virtual_device_t* dev = (virtual_device_t*)self->impl_data;
+    pthread_mutex_lock(&dev->mutex);
+    dev->started = false;
+    pthread_mutex_unlock(&dev->mutex);
+    return 0;
+}
+
+static int vdev_destroy(AudioInterface* self) {
+    // 设备状态归压力测试所有，测试结束后再读取统计
+    (void)self;
+    return 0;
+}
+
+static const AudioInterfaceVTable vdev_vtable = {
+    .init = vdev_init,
+    .set_config = vdev_set_config,
+    .write = vdev_write,
+    .init_play = vdev_init_play,
+    .destroy = vdev_destroy,
+    .flush_play = vdev_flush_play
+};
+
+// ==================== 解码尖峰 ====================
+
+// 包装解码器的 decode：每 spike_every 帧多耗时 spike_ms（忙等，和真实的解码耗时一样占用 CPU）
+static audio_codec_vtable_t spike_vtable;
+static const audio_codec_vtable_t* spike_base;
+static int spike_ms;
+static int spike_every;
+static unsigned int spike_frames;
+
+static codec_error_t spike_decode(audio_codec_t* codec, const uint8_t* input, size_t input_size,
+                                  int16_t* output, size_t output_size, size_t* decoded_size) {
+    if (++spike_frames % (unsigned int)spike_every == 0) {
+        uint64_t until = stress_now_us() + (uint64_t)spike_ms * 1000ULL;
+        while (stress_now_us() < until) {
+        }
+    }
+    return spike_base->decode(codec, input, input_size, output, output_size, decoded_size);
+}
+
+static void install_decode_spikes(audio_codec_t* decoder, const stress_config_t* config) {
+    if (config->spike_ms <= 0 || config->spike_every <= 0) return;
+    spike_base = decoder->vtable;
+    spike_vtable = *spike_base;
+    spike_vtable.decode = spike_decode;
+    spike_vtable.decode_batch = NULL;
+    spike_ms = config->spike_ms;
+    spike_every = config->spike_every;
+    spike_frames = 0;
+    decoder->vtable = &spike_vtable;
+}
+
+// ==================== 网络模型 ====================
+
+typedef struct {
+    uint64_t arrival_us;        // 相对发送起点的到达时刻
+    uint32_t seq;
+} arrival_t;
+
+typedef struct {
+    arrival_t* items;
+    size_t count;
+    size_t capacity;
+    size_t packets_sent;
+    size_t packets_lost;
+    size_t packets_reordered;
+    size_t packets_duplicated;
+} schedule_t;
+
+static double rand_unit(unsigned int* seed) {
+    return (double)rand_r(seed) / ((double)RAND_MAX + 1.0);
+}
+
+static double sample_jitter_ms(const stress_config_t* config, unsigned int* seed) {
+    double j = config->jitter_ms;
+    switch (config->jitter_dist) {
+        case JITTER_UNIFORM:
+            return rand_unit(seed) * j;
+        case JITTER_NORMAL: {
+            // Box-Muller
+            double u1 = rand_unit(seed) + 1e-12;
+            double u2 = rand_unit(seed);
+            return fabs(sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2)) * j;
+        }
+        case JITTER_PARETO: {
+            double u = rand_unit(seed) + 1e-12;
+            return (j / 2.0) / sqrt(u) - j / 2.0;
+        }
+        default:
+            return 0.0;
+    }
+}
+
+static bool schedule_add(schedule_t* schedule, uint32_t seq, double arrival_ms) {
+    if (arrival_ms < 0) arrival_ms = 0;
+    if (schedule->count == schedule->capacity) {
+        size_t capacity = schedule->capacity ? schedule->capacity * 2 : 1024;
+        arrival_t* grown = (arrival_t*)realloc(schedule->items, capacity * sizeof(arrival_t));
+        if (!grown) return false;
+        schedule->items = grown;
+        schedule->capacity = capacity;
+    }
+    schedule->items[schedule->count].arrival_us = (uint64_t)(arrival_ms * 1000.0);
+    schedule->items[schedule->count].seq = seq;
+    schedule->count++;
+    return true;
+}
+
+static int compare_arrival(const void* a, const void* b) {
+    const arrival_t* x = (const arrival_t*)a;
+    const arrival_t* y = (const arrival_t*)b;
+    if (x->arrival_us != y->arrival_us) return x->arrival_us < y->arrival_us ? -1 : 1;
+    return x->seq < y->seq ? -1 : (x->seq > y->seq);
+}
+
+/**
+ * 合成模型：Gilbert-Elliott 两状态突发丢包 + 抖动分布 + 乱序 + 重复
+ */
+static bool build_synthetic_schedule(const stress_config_t* config, uint32_t packet_count, schedule_t* schedule) {
+    unsigned int seed = config->seed;
+    double loss = config->loss_percent / 100.0;
+    double burst = config->loss_burst >= 1.0 ? config->loss_burst : 1.0;
+    double p_recover = 1.0 / burst;
+    double p_enter = loss < 1.0 ? p_recover * loss / (1.0 - loss) : 1.0;
+    bool bad = false;
+
+    for (uint32_t seq = 0; seq < packet_count; seq++) {
+        schedule->packets_sent++;
+        bad = bad ? rand_unit(&seed) >= p_recover : rand_unit(&seed) < p_enter;
+        if (bad) {
+            schedule->packets_lost++;
+            continue;
+        }
+
+        double arrival = (double)seq * STRESS_FRAME_MS + config->base_delay_ms + sample_jitter_ms(config, &seed);
+        if (rand_unit(&seed) * 100.0 < config->reorder_percent) {
+            arrival += STRESS_FRAME_MS * (1 + rand_r(&seed) % 3);
+            schedule->packets_reordered++;
+        }
+        if (!schedule_add(schedule, seq, arrival)) return false;
+
+        if (rand_unit(&seed) * 100.0 < config->duplicate_percent) {
+            if (!schedule_add(schedule, seq, arrival + 1.0 + rand_unit(&seed) * STRESS_FRAME_MS)) return false;
+            schedule->packets_duplicated++;
+        }
+    }
+    return true;
+}
+
+/**
+ * 轨迹模型：按录制的 send_ms/recv_ms 重放，时长不足时循环
+ */
+static bool build_trace_schedule(const stress_config_t* config, uint32_t packet_count, schedule_t* schedule) {
+    FILE* file = fopen(config->trace_path, "r");
+    if (!file) {
+        printf("[ERROR] 无法打开到达轨迹: %s\n", config->trace_path);
+        return false;
+    }
+
+    typedef struct { double send_ms; double recv_ms; } trace_entry_t;
+    trace_entry_t* entries = NULL;
+    size_t count = 0, capacity = 0;
+    double span_ms = 0.0;
+    char line[256];
+    while (fgets(line, sizeof(line), file)) {
+        double send_ms, recv_ms;
+        if (line[0] == '#' || sscanf(line, "%lf %lf", &send_ms, &recv_ms) != 2) {
+            continue;
+        }
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 1024;
+            trace_entry_t* grown = (trace_entry_t*)realloc(entries, capacity * sizeof(trace_entry_t));
+            if (!grown) break;
+            entries = grown;
+        }
+        entries[count].send_ms = send_ms;
+        entries[count].recv_ms = recv_ms;
+        count++;
+        if (send_ms + STRESS_FRAME_MS > span_ms) span_ms = send_ms + STRESS_FRAME_MS;
+    }
+    fclose(file);
+
+    if (count == 0) {
+        printf("[ERROR] 到达轨迹为空: %s\n", config->trace_path);
+        free(entries);
+        return false;
+    }
+
+    // 以轨迹第一个包的发送时刻为零点
+    double origin = entries[0].send_ms;
+    bool ok = true;
+    for (double offset = 0.0; ok; offset += span_ms - origin) {
+        bool added = false;
+        for (size_t i = 0; i < count && ok; i++) {
+            double send_ms = entries[i].send_ms - origin + offset;
+            uint32_t seq = (uint32_t)(send_ms / STRESS_FRAME_MS + 0.5);
+            if (seq >= packet_count) continue;
+            added = true;
+            bool duplicate = i > 0 && entries[i].send_ms == entries[i - 1].send_ms;
+            if (duplicate) {
+                schedule->packets_duplicated++;
+            } else {
+                schedule->packets_sent++;
+            }
+            if (entries[i].recv_ms < 0) {
+                schedule->packets_lost++;
+                continue;
+            }
+            double arrival = (double)seq * STRESS_FRAME_MS + (entries[i].recv_ms - entries[i].send_ms);
+            ok = schedule_add(schedule, seq, arrival);
+        }
+        if (!added) break;
+    }
+    free(entries);
+    return ok;
+}
+
+// ==================== 统计 ====================
+
+typedef struct {
+    pthread_mutex_t mutex;
+    virtual_device_t* device;
+    uint64_t send_origin_us;    // 时间戳 0 的发送时刻
+    uint32_t* latencies_us;     // 发送到开始播出
+    size_t count;
+    size_t capacity;
+} latency_log_t;
+
+// 每段 PCM 交给设备后调用：last_play_us 是这段 PCM 开始播出的时刻
+static void stress_output_tap(void* user_data, const int16_t* pcm, size_t samples, const uint32_t* timestamp) {
+    latency_log_t* log = (latency_log_t*)user_data;
+    (void)pcm;
+    (void)samples;
+    if (!timestamp) return;
+
+    pthread_mutex_lock(&log->device->mutex);
+    uint64_t play_us = log->device->last_play_us;
+    pthread_mutex_unlock(&log->device->mutex);
+
+    uint64_t send_us = log->send_origin_us + (uint64_t)*timestamp * 1000ULL;
+    pthread_mutex_lock(&log->mutex);
+    if (log->count == log->capacity) {
+        size_t capacity = log->capacity ? log->capacity * 2 : 1024;
+        uint32_t* grown = (uint32_t*)realloc(log->latencies_us, capacity * sizeof(uint32_t));
+        if (!grown) {
+            pthread_mutex_unlock(&log->mutex);
+            return;
+        }
+        log->latencies_us = grown;
+        log->capacity = capacity;
+    }
+    log->latencies_us[log->count++] = (uint32_t)(play_us > send_us ? play_us - send_us : 0);
+    pthread_mutex_unlock(&log->mutex);
+}
+
+static int compare_u32(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile_ms(const uint32_t* sorted, size_t count, double p) {
+    if (count == 0) return 0.0;
+    return sorted[(size_t)(p * (double)(count - 1) + 0.5)] / 1000.0;
+}
+
+static double cpu_seconds(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (double)usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+           (double)usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+// ==================== 测试流程 ====================
+
+/**
+ * 预先编码全部包：440Hz 正弦，每包独立
+ */
+static uint8_t* encode_packets(uint32_t packet_count, uint16_t* sizes) {
+    audio_codec_t* encoder = opus_codec_create();
+    audio_format_t format;
+    audio_format_init(&format, STRESS_SAMPLE_RATE, STRESS_CHANNELS, 16, STRESS_FRAME_MS);
+    if (!encoder || audio_codec_init_encoder(encoder, &format) != CODEC_SUCCESS) {
+        audio_codec_destroy(encoder);
+        return NULL;
+    }
+    opus_codec_set_inband_fec(encoder, 1);
+    opus_codec_set_packet_loss_perc(encoder, 10);
+
+    uint8_t* packets = (uint8_t*)malloc((size_t)packet_count * STRESS_MAX_PACKET);
+    int16_t pcm[STRESS_FRAME_SAMPLES * STRESS_CHANNELS];
+    double phase = 0.0;
+    for (uint32_t seq = 0; packets && seq < packet_count; seq++) {
+        for (int i = 0; i < STRESS_FRAME_SAMPLES; i++) {
+            pcm[i] = (int16_t)(sin(phase) * 8000.0);
+            phase += 2.0 * M_PI * 440.0 / STRESS_SAMPLE_RATE;
+        }
+        size_t encoded = 0;
+        if (audio_codec_encode(encoder, pcm, STRESS_FRAME_SAMPLES * STRESS_CHANNELS,
+                               packets + (size_t)seq * STRESS_MAX_PACKET, STRESS_MAX_PACKET,
+                               &encoded) != CODEC_SUCCESS) {
+            encoded = 0;
+        }
+        sizes[seq] = (uint16_t)encoded;
+    }
+    audio_codec_destroy(encoder);
+    return packets;
+}
+
+static int run_stress(const stress_config_t* config) {
+    uint32_t packet_count = (uint32_t)(config->duration_s * 1000 / STRESS_FRAME_MS);
+    schedule_t schedule = {0};
+    bool built = config->trace_path ? build_trace_schedule(config, packet_count, &schedule)
+                                    : build_synthetic_schedule(config, packet_count, &schedule);
+    uint16_t* sizes = (uint16_t*)calloc(packet_count, sizeof(uint16_t));
+    uint8_t* packets = sizes ? encode_packets(packet_count, sizes) : NULL;
+    if (!built || !packets) {
+        printf("[ERROR] 压力测试准备失败\n");
+        free(schedule.items);
+        free(sizes);
+        free(packets);
+        return 1;
+    }
+    qsort(schedule.items, schedule.count, sizeof(arrival_t), compare_arrival);
+
+    // 虚拟设备与播放器
+    virtual_device_t device = {0};
+    pthread_mutex_init(&device.mutex, NULL);
+    AudioInterface audio = { .vtable = &vdev_vtable, .impl_data = &device };
+    audio_codec_t* decoder = opus_codec_create();
+    audio_format_t format;
+    audio_format_init(&format, STRESS_SAMPLE_RATE, STRESS_CHANNELS, 16, STRESS_FRAME_MS);
+    linx_player_t* player = NULL;
+    if (decoder && audio_codec_init_decoder(decoder, &format) == CODEC_SUCCESS) {
+        install_decode_spikes(decoder, config);
+        player = linx_player_create(&audio, decoder);
+    }
+    player_audio_config_t player_config = {
+        .sample_rate = STRESS_SAMPLE_RATE,
+        .channels = STRESS_CHANNELS,
+        .frame_size = STRESS_FRAME_SAMPLES,
+        .buffer_size = 8192,
+        .jitter_target_ms = config->jb_target_ms,
+        .jitter_max_ms = config->jb_max_ms,
+        .jitter_fixed = config->jb_fixed,
+        .conceal_loss = config->conceal_loss,
+        .decode_ahead_periods = config->decode_ahead,
+    };
+    latency_log_t latency = { .device = &device };
+    pthread_mutex_init(&latency.mutex, NULL);
+    int ret = 1;
+    if (!player || linx_player_init(player, &player_config) != PLAYER_SUCCESS) {
+        printf("[ERROR] 播放器初始化失败\n");
+        goto cleanup;
+    }
+    linx_player_set_output_tap(player, stress_output_tap, &latency);
+    if (linx_player_start(player) != PLAYER_SUCCESS) {
+        printf("[ERROR] 启动播放器失败\n");
+        goto cleanup;
+    }
+
+    printf("[INFO] 压力测试: %d 秒, %u 包 (到达 %zu, 丢失 %zu, 乱序 %zu, 重复 %zu)\n",
+           config->duration_s, packet_count, schedule.count, schedule.packets_lost,
+           schedule.packets_reordered, schedule.packets_duplicated);
+
+    // 按到达时刻实时喂包
+    double cpu_start = cpu_seconds();
+    uint64_t origin = stress_now_us();
+    latency.send_origin_us = origin;
+    size_t feed_errors = 0;
+    for (size_t i = 0; i < schedule.count; i++) {
+        const arrival_t* arrival = &schedule.items[i];
+        stress_sleep_until_us(origin + arrival->arrival_us);
+        if (sizes[arrival->seq] == 0) continue;
+        if (linx_player_feed_packet(player, packets + (size_t)arrival->seq * STRESS_MAX_PACKET,
+                                    sizes[arrival->seq], arrival->seq * STRESS_FRAME_MS, true) != PLAYER_SUCCESS) {
+            feed_errors++;
+        }
+    }
+
+    // 等待缓冲区播完
+    for (int i = 0; i < 200 && !linx_player_is_buffer_empty(player); i++) {
+        stress_sleep_until_us(stress_now_us() + 10000);
+    }
+    stress_sleep_until_us(stress_now_us() + STRESS_DEVICE_BUFFER_MS * 1000ULL);
+    double wall_s = (double)(stress_now_us() - origin) / 1e6;
+    double cpu_s = cpu_seconds() - cpu_start;
+
+    linx_player_set_output_tap(player, NULL, NULL);
+    linx_jitter_buffer_stats_t jitter = {0};
+    size_t concealed = 0, recovered = 0, frames_played = 0, bytes_played = 0;
+    size_t ahead_capacity = 0, ahead_starved = 0;
+    linx_player_get_jitter_stats(player, &jitter);
+    linx_player_get_decode_ahead(player, NULL, &ahead_capacity, &ahead_starved);
+    linx_player_get_loss_stats(player, &concealed, &recovered);
+    linx_player_get_stats(player, &bytes_played, &frames_played);
+    linx_player_stop(player);
+
+    pthread_mutex_lock(&latency.mutex);
+    qsort(latency.latencies_us, latency.count, sizeof(uint32_t), compare_u32);
+    double base = config->base_delay_ms;
+    printf("[STATS] 播出帧: %zu (解码 %zu, PLC %zu, FEC恢复 %zu), 喂包失败: %zu\n",
+           latency.count, frames_played, concealed, recovered, feed_errors);
+    printf("[STATS] 欠载: %zu 次, 共 %.1f ms (抖动缓冲欠载 %zu)\n",
+           device.underruns, device.underrun_us / 1000.0, jitter.underruns);
+    printf("[STATS] 解码超前: %zu 周期, 播空 %zu 次\n", ahead_capacity, ahead_starved);
+    printf("[STATS] 抖动缓冲: 迟到丢弃 %zu, 重复丢弃 %zu, 溢出 %zu, 估算抖动 %.1f ms, 目标深度 %d ms\n",
+           jitter.late_packets, jitter.duplicate_packets, jitter.overflows, jitter.jitter_ms, jitter.target_depth_ms);
+    printf("[STATS] 发送->播出: p50 %.1f / p95 %.1f / p99 %.1f / max %.1f ms (扣除基础时延后 p50 %.1f ms)\n",
+           percentile_ms(latency.latencies_us, latency.count, 0.50),
+           percentile_ms(latency.latencies_us, latency.count, 0.95),
+           percentile_ms(latency.latencies_us, latency.count, 0.99),
+           latency.count ? latency.latencies_us[latency.count - 1] / 1000.0 : 0.0,
+           percentile_ms(latency.latencies_us, latency.count, 0.50) - base);
+    printf("[STATS] CPU: %.2f%% (%.2f s / %.1f s)\n", wall_s > 0 ? cpu_s / wall_s * 100.0 : 0.0, cpu_s, wall_s);
+    size_t played = latency.count;
+    pthread_mutex_unlock(&latency.mutex);
+
+    ret = 0;
+    if (played == 0) {
+        printf("[ERROR] 没有任何音频播出\n");
+        ret = 1;
+    } else if (config->max_underruns >= 0 && device.underruns > (size_t)config->max_underruns) {
+        printf("[ERROR] 欠载 %zu 次，超过上限 %d\n", device.underruns, config->max_underruns);
+        ret = 1;
+    }
+
+cleanup:
+    linx_player_destroy(player);
+    audio_codec_destroy(decoder);
+    pthread_mutex_destroy(&latency.mutex);
+    pthread_mutex_destroy(&device.mutex);
+    free(latency.latencies_us);
+    free(schedule.items);
+    free(sizes);
+    free(packets);
+    return ret;
+}
+
+void play_stress_print_usage(void) {
+    printf("压力测试选项 (--stress 之后):\n");
+    printf("  --duration S        测试时长，秒 (默认 30)\n");
+    printf("  --delay MS          基础单向时延 (默认 30)\n");
+    printf("  --jitter MS         抖动幅度 (默认 20)\n");
+    printf("  --dist D            抖动分布 none|uniform|normal|pareto (默认 normal)\n");
+    printf("  --loss P            丢包率 %% (默认 2)\n");
+    printf("  --burst N           平均突发丢包长度，包 (默认 2)\n");
+    printf("  --reorder P         额外延迟 1-3 帧的包 %% (默认 1)\n");
+    printf("  --dup P             重复到达的包 %% (默认 0.5)\n");
+    printf("  --trace FILE        重放到达轨迹 (每行 \"send_ms recv_ms\")，忽略上面的网络参数\n");
+    printf("  --seed N            随机种子 (默认 1)\n");
+    printf("  --jb-target MS      抖动缓冲目标深度 (默认由播放器决定)\n");
+    printf("  --jb-max MS         抖动缓冲最大深度\n");
+    printf("  --jb-fixed          固定抖动缓冲深度，不自适应\n");
+    printf("  --no-plc            关闭丢包补偿\n");
+    printf("  --max-underruns N   欠载超过 N 次时返回失败\n");
+    printf("  --decode-ahead N    解码超前的周期数 (默认由播放器决定，<0 关闭)\n");
+    printf("  --spike MS          模拟解码尖峰：单帧解码多耗时 MS\n");
+    printf("  --spike-every N     每 N 帧出现一次解码尖峰 (默认 50)\n");
+}
+
+int play_stress_main(int argc, char* argv[]) {
+    stress_config_t config = {
+        .duration_s = 30,
+        .base_delay_ms = 30,
+        .jitter_ms = 20,
+        .jitter_dist = JITTER_NORMAL,
+        .loss_percent = 2.0,
+        .loss_burst = 2.0,
+        .reorder_percent = 1.0,
+        .duplicate_percent = 0.5,
+        .seed = 1,
+        .conceal_loss = true,
+        .max_underruns = -1,
+        .spike_every = 50,
+    };
+
+    for (int i = 0; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        bool takes_value = true;
+        if (strcmp(arg, "--jb-fixed") == 0) {
+            config.jb_fixed = true;
+            takes_value = false;
+        } else if (strcmp(arg, "--no-plc") == 0) {
+            config.conceal_loss = false;
+            takes_value = false;
+        } else if (!value) {
+            printf("[ERROR] 选项 %s 缺少参数\n", arg);
+            play_stress_print_usage();
+            return 2;
+        } else if (strcmp(arg, "--duration") == 0) {
+            config.duration_s = atoi(value);
+        } else if (strcmp(arg, "--delay") == 0) {
+            config.base_delay_ms = atoi(value);
+        } else if (strcmp(arg, "--jitter") == 0) {
+            config.jitter_ms = atoi(value);
+        } else if (strcmp(arg, "--dist") == 0) {
+            if (strcmp(value, "none") == 0) config.jitter_dist = JITTER_NONE;
+            else if (strcmp(value, "uniform") == 0) config.jitter_dist = JITTER_UNIFORM;
+            else if (strcmp(value, "normal") == 0) config.jitter_dist = JITTER_NORMAL;
+            else if (strcmp(value, "pareto") == 0) config.jitter_dist = JITTER_PARETO;
+            else {
+                printf("[ERROR] 未知抖动分布: %s\n", value);
+                return 2;
+            }
+        } else if (strcmp(arg, "--loss") == 0) {
+            config.loss_percent = atof(value);
+        } else if (strcmp(arg, "--burst") == 0) {
+            config.loss_burst = atof(value);
+        } else if (strcmp(arg, "--reorder") == 0) {
+            config.reorder_percent = atof(value);
+        } else if (strcmp(arg, "--dup") == 0) {
+            config.duplicate_percent = atof(value);
+        } else if (strcmp(arg, "--trace") == 0) {
+            config.trace_path = value;
+        } else if (strcmp(arg, "--seed") == 0) {
+            config.seed = (unsigned int)strtoul(value, NULL, 10);
+        } else if (strcmp(arg, "--jb-target") == 0) {
+            config.jb_target_ms = atoi(value);
+        } else if (strcmp(arg, "--jb-max") == 0) {
+            config.jb_max_ms = atoi(value);
+        } else if (strcmp(arg, "--max-underruns") == 0) {
+            config.max_underruns = atoi(value);
+        } else if (strcmp(arg, "--decode-ahead") == 0) {
+            config.decode_ahead = atoi(value);
+        } else if (strcmp(arg, "--spike") == 0) {
+            config.spike_ms = atoi(value);
+        } else if (strcmp(arg, "--spike-every") == 0) {
+            config.spike_every = atoi(value);
+        } else {
+            printf("[ERROR] 未知压力测试选项: %s\n", arg);
+            play_stress_print_usage();
+            return 2;
+        }
+        if (takes_value) i++;
+    }
+
+    if (config.duration_s < 1 || config.loss_percent < 0 || config.loss_percent >= 100) {
+        play_stress_print_usage();
+        return 2;
+    }
+    return run_stress(&config);
+}
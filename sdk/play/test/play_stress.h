@@ -0,0 +1,28 @@
+/**
+ * @file play_stress.h
+ * @brief Linx Player 网络损伤压力测试
+ *
+ * 用合成的网络模型（或录制的 Wi-Fi 到达轨迹）驱动播放器：可配置抖动分布、突发丢包、
+ * 乱序和重复。输出写入一个按实时节奏消费的虚拟音频设备（不需要声卡），统计欠载、
+ * 发送到播出的时延、丢包补偿和 CPU 占用，用于在上线前验证抖动缓冲和 PLC 的改动。
+ */
+
+#ifndef PLAY_STRESS_H
+#define PLAY_STRESS_H
+
+#include <stdbool.h>
+
+/**
+ * 运行压力测试
+ * @param argc 参数个数（不含 --stress 本身）
+ * @param argv 压力测试参数，见 play_stress_print_usage()
+ * @return 0 成功；1 播放失败或超过 --max-underruns；2 参数错误
+ */
+int play_stress_main(int argc, char* argv[]);
+
+/**
+ * 打印压力测试参数说明
+ */
+void play_stress_print_usage(void);
+
+#endif /* PLAY_STRESS_H */
@@ -0,0 +1,58 @@
+#ifndef LINX_AES_CTR_H
+#define LINX_AES_CTR_H
+
+/*
+ * AES-128-CTR（FIPS 197 / NIST SP 800-38A）
+ *
+ * 只用于 MQTT+UDP 传输的音频加密（见 linx_mqtt_udp.h），密钥和计数器初值由服务端 hello 下发。
+ * 计数器为整个 16 字节按大端递增，与 mbedtls_aes_crypt_ctr() 一致。
+ * 轮函数查一张 1KB 的 T 表（其余三列由循环移位得到）加 256 字节 S 盒，不依赖 TLS 库；
+ * CTR 模式加密和解密是同一个操作。
+ * 设置了带 aes128_ctr 的加密提供者（见 linx_crypto.h）时 linx_aes128_ctr() 先交给提供者。
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LINX_AES_BLOCK_SIZE 16
+#define LINX_AES128_KEY_SIZE 16
+
+/* 展开后的轮密钥：11 轮 x 4 列，每列按大端存为一个字；原始密钥留给加密提供者 */
+typedef struct {
+    uint32_t round_keys[44];
+    uint8_t key[LINX_AES128_KEY_SIZE];
+} linx_aes128_t;
+
+/**
+ * 展开密钥
+ * @param aes 输出轮密钥
+ * @param key 16 字节密钥
+ */
+void linx_aes128_init(linx_aes128_t* aes, const uint8_t key[LINX_AES128_KEY_SIZE]);
+
+/**
+ * 加密一个分组
+ */
+void linx_aes128_encrypt_block(const linx_aes128_t* aes, const uint8_t in[LINX_AES_BLOCK_SIZE],
+                               uint8_t out[LINX_AES_BLOCK_SIZE]);
+
+/**
+ * CTR 模式加密或解密，in 与 out 可以是同一块内存
+ * @param aes 轮密钥
+ * @param counter 计数器初值（16 字节，不修改）
+ * @param in 输入数据
+ * @param out 输出数据
+ * @param size 数据长度
+ */
+void linx_aes128_ctr(const linx_aes128_t* aes, const uint8_t counter[LINX_AES_BLOCK_SIZE],
+                     const uint8_t* in, uint8_t* out, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINX_AES_CTR_H */
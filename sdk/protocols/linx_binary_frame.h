@@ -0,0 +1,176 @@
+#ifndef LINX_BINARY_FRAME_H
+#define LINX_BINARY_FRAME_H
+
+/*
+ * 二进制帧编解码的内联实现
+ *
+ * linx_protocol.h 的 linx_binary_protocol_* 接口按运行时的版本号分支，每个音频帧都要
+ * 经过一次函数调用和版本判断。这里把同样的编解码写成 static inline：调用方传入的
+ * version 是编译期常量时（见 linx_websocket.c 的 LINX_WS_PROTOCOL_VERSION），编译器
+ * 只保留该版本的一支，其他帧格式的代码整体去掉；传入变量时与导出接口行为完全一致
+ * （导出接口本身就是这些函数的包装）。
+ *
+ * 仅供协议层内部使用，应用请使用 linx_protocol.h 的接口。
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <arpa/inet.h>
+#include "linx_protocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 按版本编码帧头，type 为 LINX_BINARY_TYPE_*；返回值同 linx_binary_protocol_encode_header() */
+static inline int linx_binary_frame_encode(int version, uint8_t type, uint32_t timestamp, uint16_t sequence,
+                                           size_t payload_size, uint8_t* header) {
+    if (version == 2) {
+        linx_binary_protocol2_t bp2;
+        bp2.version = htons((uint16_t)version);
+        bp2.type = htons(type);
+        bp2.reserved = 0;
+        bp2.timestamp = htonl(timestamp);
+        bp2.payload_size = htonl((uint32_t)payload_size);
+        memcpy(header, &bp2, sizeof(bp2));
+        return (int)sizeof(bp2);
+    }
+    if (version == 3) {
+        if (payload_size > UINT16_MAX) {
+            return -1;
+        }
+        linx_binary_protocol3_t bp3;
+        bp3.type = type;
+        bp3.reserved = 0;
+        bp3.payload_size = htons((uint16_t)payload_size);
+        memcpy(header, &bp3, sizeof(bp3));
+        return (int)sizeof(bp3);
+    }
+    if (version == 4) {
+        if (payload_size > UINT16_MAX) {
+            return -1;
+        }
+        linx_binary_protocol4_t bp4;
+        bp4.type = type;
+        bp4.reserved = 0;
+        bp4.payload_size = htons((uint16_t)payload_size);
+        bp4.sequence = htons(sequence);
+        bp4.timestamp = htonl(timestamp);
+        memcpy(header, &bp4, sizeof(bp4));
+        return (int)sizeof(bp4);
+    }
+    return 0;
+}
+
+/* 按版本解析收到的二进制帧；参数和返回值同 linx_binary_protocol_decode() */
+static inline linx_binary_frame_result_t linx_binary_frame_decode(int version, const uint8_t* data, size_t size,
+                                                                  const uint8_t** payload, size_t* payload_size,
+                                                                  uint32_t* timestamp, uint16_t* sequence) {
+    *payload = NULL;
+    *payload_size = 0;
+    *timestamp = 0;
+    if (sequence) {
+        *sequence = 0;
+    }
+
+    if (version == 2) {
+        if (size < sizeof(linx_binary_protocol2_t)) {
+            return LINX_BINARY_FRAME_IGNORED;
+        }
+        const linx_binary_protocol2_t* bp2 = (const linx_binary_protocol2_t*)data;
+        uint16_t type = ntohs(bp2->type);
+        *payload_size = ntohl(bp2->payload_size);
+        if (*payload_size > size - sizeof(linx_binary_protocol2_t)) {
+            return LINX_BINARY_FRAME_TRUNCATED;
+        }
+        if ((type != LINX_BINARY_TYPE_AUDIO && type != LINX_BINARY_TYPE_CONTROL) || *payload_size == 0) {
+            return LINX_BINARY_FRAME_IGNORED;
+        }
+        *payload = bp2->payload;
+        if (type == LINX_BINARY_TYPE_CONTROL) {
+            return LINX_BINARY_FRAME_CONTROL;
+        }
+        *timestamp = ntohl(bp2->timestamp);
+        return LINX_BINARY_FRAME_AUDIO;
+    }
+    if (version == 3) {
+        if (size < sizeof(linx_binary_protocol3_t)) {
+            return LINX_BINARY_FRAME_IGNORED;
+        }
+        const linx_binary_protocol3_t* bp3 = (const linx_binary_protocol3_t*)data;
+        *payload_size = ntohs(bp3->payload_size);
+        if (*payload_size > size - sizeof(linx_binary_protocol3_t)) {
+            return LINX_BINARY_FRAME_TRUNCATED;
+        }
+        if ((bp3->type != LINX_BINARY_TYPE_AUDIO && bp3->type != LINX_BINARY_TYPE_CONTROL) || *payload_size == 0) {
+            return LINX_BINARY_FRAME_IGNORED;
+        }
+        *payload = bp3->payload;
+        if (bp3->type == LINX_BINARY_TYPE_CONTROL) {
+            return LINX_BINARY_FRAME_CONTROL;
+        }
+        return LINX_BINARY_FRAME_AUDIO;
+    }
+    if (version == 4) {
+        if (size < sizeof(linx_binary_protocol4_t)) {
+            return LINX_BINARY_FRAME_IGNORED;
+        }
+        const linx_binary_protocol4_t* bp4 = (const linx_binary_protocol4_t*)data;
+        *payload_size = ntohs(bp4->payload_size);
+        if (*payload_size > size - sizeof(linx_binary_protocol4_t)) {
+            return LINX_BINARY_FRAME_TRUNCATED;
+        }
+        if ((bp4->type != LINX_BINARY_TYPE_AUDIO && bp4->type != LINX_BINARY_TYPE_CONTROL) || *payload_size == 0) {
+            return LINX_BINARY_FRAME_IGNORED;
+        }
+        *payload = bp4->payload;
+        if (bp4->type == LINX_BINARY_TYPE_CONTROL) {
+            return LINX_BINARY_FRAME_CONTROL;
+        }
+        *timestamp = ntohl(bp4->timestamp);
+        if (sequence) {
+            *sequence = ntohs(bp4->sequence);
+        }
+        return LINX_BINARY_FRAME_AUDIO;
+    }
+
+    /* 其他版本整帧都是音频载荷 */
+    *payload = data;
+    *payload_size = size;
+    return LINX_BINARY_FRAME_AUDIO;
+}
+
+/* 流ID所在字节：v3/v4 的 reserved，v2 的 reserved 字段（大端）低字节；没有帧头的版本返回 -1 */
+static inline int linx_binary_frame_stream_offset(int version) {
+    if (version == 2) {
+        return (int)offsetof(linx_binary_protocol2_t, reserved) + 3;
+    }
+    if (version == 3 || version == 4) {
+        return (int)offsetof(linx_binary_protocol3_t, reserved);
+    }
+    return -1;
+}
+
+/* 在已编码的帧头中写入流ID；同 linx_binary_protocol_set_stream() */
+static inline bool linx_binary_frame_set_stream(int version, uint8_t* header, uint8_t stream_id) {
+    int offset = linx_binary_frame_stream_offset(version);
+    if (offset < 0) {
+        return false;
+    }
+    header[offset] = stream_id;
+    return true;
+}
+
+/* 读取二进制帧的流ID；同 linx_binary_protocol_get_stream() */
+static inline uint8_t linx_binary_frame_get_stream(int version, const uint8_t* data, size_t size) {
+    int offset = linx_binary_frame_stream_offset(version);
+    return offset >= 0 && size > (size_t)offset ? data[offset] : 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINX_BINARY_FRAME_H */
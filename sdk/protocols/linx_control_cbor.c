@@ -0,0 +1,350 @@
+#include "linx_control_cbor.h"
+#include <string.h>
+
+/* CBOR 主类型（RFC 8949 3.1） */
+#define CBOR_MAJOR_UINT     0
+#define CBOR_MAJOR_NEGINT   1
+#define CBOR_MAJOR_BYTES    2
+#define CBOR_MAJOR_TEXT     3
+#define CBOR_MAJOR_ARRAY    4
+#define CBOR_MAJOR_MAP      5
+#define CBOR_MAJOR_TAG      6
+#define CBOR_MAJOR_SIMPLE   7
+
+/* 跳过未知值时允许的最大嵌套深度 */
+#define CBOR_MAX_DEPTH      8
+
+static const char* const s_type_names[LINX_CONTROL_TYPE_COUNT] = {
+    [LINX_CONTROL_TYPE_LISTEN] = "listen",
+    [LINX_CONTROL_TYPE_TTS] = "tts",
+    [LINX_CONTROL_TYPE_STT] = "stt",
+    [LINX_CONTROL_TYPE_LLM] = "llm",
+    [LINX_CONTROL_TYPE_ABORT] = "abort",
+};
+
+static const char* const s_field_names[LINX_CONTROL_FIELD_COUNT] = {
+    [LINX_CONTROL_FIELD_SESSION_ID] = "session_id",
+    [LINX_CONTROL_FIELD_STATE] = "state",
+    [LINX_CONTROL_FIELD_TEXT] = "text",
+    [LINX_CONTROL_FIELD_MODE] = "mode",
+    [LINX_CONTROL_FIELD_REASON] = "reason",
+    [LINX_CONTROL_FIELD_EMOTION] = "emotion",
+};
+
+void linx_control_message_init(linx_control_message_t* message, linx_control_type_t type) {
+    memset(message, 0, sizeof(*message));
+    message->type = type;
+}
+
+void linx_control_message_set(linx_control_message_t* message, linx_control_field_t field, const char* value) {
+    if (field <= 0 || field >= LINX_CONTROL_FIELD_COUNT) {
+        return;
+    }
+    message->fields[field].data = value;
+    message->fields[field].length = value ? strlen(value) : 0;
+}
+
+bool linx_control_message_has(const linx_control_message_t* message, linx_control_field_t field) {
+    return field > 0 && field < LINX_CONTROL_FIELD_COUNT && message->fields[field].data != NULL;
+}
+
+bool linx_control_message_equals(const linx_control_message_t* message, linx_control_field_t field,
+                                 const char* str) {
+    if (!linx_control_message_has(message, field) || !str) {
+        return false;
+    }
+    const linx_control_string_t* value = &message->fields[field];
+    return strlen(str) == value->length && memcmp(value->data, str, value->length) == 0;
+}
+
+size_t linx_control_message_copy(const linx_control_message_t* message, linx_control_field_t field,
+                                 char* buffer, size_t size) {
+    if (!linx_control_message_has(message, field) || message->fields[field].length >= size) {
+        return (size_t)-1;
+    }
+    const linx_control_string_t* value = &message->fields[field];
+    memcpy(buffer, value->data, value->length);
+    buffer[value->length] = '\0';
+    return value->length;
+}
+
+const char* linx_control_type_name(linx_control_type_t type) {
+    if (type <= LINX_CONTROL_TYPE_INVALID || type >= LINX_CONTROL_TYPE_COUNT) {
+        return NULL;
+    }
+    return s_type_names[type];
+}
+
+linx_control_type_t linx_control_type_from_name(const char* name) {
+    if (!name) {
+        return LINX_CONTROL_TYPE_INVALID;
+    }
+    for (int t = LINX_CONTROL_TYPE_INVALID + 1; t < LINX_CONTROL_TYPE_COUNT; t++) {
+        if (strcmp(s_type_names[t], name) == 0) {
+            return (linx_control_type_t)t;
+        }
+    }
+    return LINX_CONTROL_TYPE_INVALID;
+}
+
+const char* linx_control_field_name(linx_control_field_t field) {
+    if (field <= 0 || field >= LINX_CONTROL_FIELD_COUNT) {
+        return NULL;
+    }
+    return s_field_names[field];
+}
+
+/* 编码 */
+
+/* 写入数据项头：主类型 + 参数，参数按最短形式编码 */
+static bool cbor_put_head(uint8_t** pos, const uint8_t* end, int major, uint64_t value) {
+    uint8_t head[9];
+    size_t n;
+
+    if (value < 24) {
+        head[0] = (uint8_t)(major << 5 | value);
+        n = 1;
+    } else if (value <= UINT8_MAX) {
+        head[0] = (uint8_t)(major << 5 | 24);
+        head[1] = (uint8_t)value;
+        n = 2;
+    } else if (value <= UINT16_MAX) {
+        head[0] = (uint8_t)(major << 5 | 25);
+        head[1] = (uint8_t)(value >> 8);
+        head[2] = (uint8_t)value;
+        n = 3;
+    } else if (value <= UINT32_MAX) {
+        head[0] = (uint8_t)(major << 5 | 26);
+        for (int i = 0; i < 4; i++) {
+            head[1 + i] = (uint8_t)(value >> (24 - 8 * i));
+        }
+        n = 5;
+    } else {
+        head[0] = (uint8_t)(major << 5 | 27);
+        for (int i = 0; i < 8; i++) {
+            head[1 + i] = (uint8_t)(value >> (56 - 8 * i));
+        }
+        n = 9;
+    }
+
+    if ((size_t)(end - *pos) < n) {
+        return false;
+    }
+    memcpy(*pos, head, n);
+    *pos += n;
+    return true;
+}
+
+size_t linx_control_cbor_encode(const linx_control_message_t* message, uint8_t* buffer, size_t size) {
+    if (!message || !buffer || !linx_control_type_name(message->type)) {
+        return 0;
+    }
+
+    size_t count = 1;
+    for (int f = 1; f < LINX_CONTROL_FIELD_COUNT; f++) {
+        if (message->fields[f].data) {
+            count++;
+        }
+    }
+
+    uint8_t* pos = buffer;
+    const uint8_t* end = buffer + size;
+    if (!cbor_put_head(&pos, end, CBOR_MAJOR_MAP, count) ||
+        !cbor_put_head(&pos, end, CBOR_MAJOR_UINT, 0) ||
+        !cbor_put_head(&pos, end, CBOR_MAJOR_UINT, (uint64_t)message->type)) {
+        return 0;
+    }
+
+    for (int f = 1; f < LINX_CONTROL_FIELD_COUNT; f++) {
+        const linx_control_string_t* value = &message->fields[f];
+        if (!value->data) {
+            continue;
+        }
+        if (!cbor_put_head(&pos, end, CBOR_MAJOR_UINT, (uint64_t)f) ||
+            !cbor_put_head(&pos, end, CBOR_MAJOR_TEXT, value->length) ||
+            (size_t)(end - pos) < value->length) {
+            return 0;
+        }
+        memcpy(pos, value->data, value->length);
+        pos += value->length;
+    }
+
+    return (size_t)(pos - buffer);
+}
+
+/* 解码 */
+
+typedef struct {
+    const uint8_t* pos;
+    const uint8_t* end;
+} cbor_reader_t;
+
+/* 读取数据项头；不支持不定长编码（附加信息 31）和保留值 28..30 */
+static bool cbor_get_head(cbor_reader_t* reader, int* major, uint64_t* value) {
+    if (reader->pos >= reader->end) {
+        return false;
+    }
+    uint8_t initial = *reader->pos++;
+    *major = initial >> 5;
+    uint8_t info = initial & 0x1f;
+
+    if (info < 24) {
+        *value = info;
+        return true;
+    }
+    if (info > 27) {
+        return false;
+    }
+
+    size_t n = (size_t)1 << (info - 24);
+    if ((size_t)(reader->end - reader->pos) < n) {
+        return false;
+    }
+    uint64_t v = 0;
+    for (size_t i = 0; i < n; i++) {
+        v = v << 8 | reader->pos[i];
+    }
+    reader->pos += n;
+    *value = v;
+    return true;
+}
+
+/* 跳过一个完整的数据项（含嵌套内容） */
+static bool cbor_skip(cbor_reader_t* reader, int depth) {
+    int major;
+    uint64_t value;
+    if (depth > CBOR_MAX_DEPTH || !cbor_get_head(reader, &major, &value)) {
+        return false;
+    }
+
+    switch (major) {
+        case CBOR_MAJOR_UINT:
+        case CBOR_MAJOR_NEGINT:
+        case CBOR_MAJOR_SIMPLE:
+            return true;     // 浮点数的字节已随参数读出
+        case CBOR_MAJOR_BYTES:
+        case CBOR_MAJOR_TEXT:
+            if (value > (uint64_t)(reader->end - reader->pos)) {
+                return false;
+            }
+            reader->pos += value;
+            return true;
+        case CBOR_MAJOR_ARRAY:
+        case CBOR_MAJOR_MAP: {
+            /* 每个元素至少 1 字节，先按剩余长度排除伪造的超大计数 */
+            uint64_t items = major == CBOR_MAJOR_MAP ? value * 2 : value;
+            if (value > (uint64_t)(reader->end - reader->pos) || items > (uint64_t)(reader->end - reader->pos)) {
+                return false;
+            }
+            for (uint64_t i = 0; i < items; i++) {
+                if (!cbor_skip(reader, depth + 1)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        case CBOR_MAJOR_TAG:
+            return cbor_skip(reader, depth + 1);
+        default:
+            return false;
+    }
+}
+
+bool linx_control_cbor_decode(const uint8_t* data, size_t size, linx_control_message_t* message) {
+    if (!data || !message) {
+        return false;
+    }
+    linx_control_message_init(message, LINX_CONTROL_TYPE_INVALID);
+
+    cbor_reader_t reader = { data, data + size };
+    int major;
+    uint64_t count;
+    if (!cbor_get_head(&reader, &major, &count) || major != CBOR_MAJOR_MAP ||
+        count > (uint64_t)(reader.end - reader.pos)) {
+        return false;
+    }
+
+    for (uint64_t i = 0; i < count; i++) {
+        /* 只认无符号整数键，其他键连同值一起跳过 */
+        const uint8_t* key_start = reader.pos;
+        uint64_t key;
+        if (!cbor_get_head(&reader, &major, &key)) {
+            return false;
+        }
+        if (major != CBOR_MAJOR_UINT || key >= LINX_CONTROL_FIELD_COUNT) {
+            if (major != CBOR_MAJOR_UINT) {
+                reader.pos = key_start;
+                if (!cbor_skip(&reader, 0)) {
+                    return false;
+                }
+            }
+            if (!cbor_skip(&reader, 0)) {
+                return false;
+            }
+            continue;
+        }
+
+        uint64_t value;
+        if (!cbor_get_head(&reader, &major, &value)) {
+            return false;
+        }
+        if (key == 0) {
+            if (major != CBOR_MAJOR_UINT || value == 0 || value >= LINX_CONTROL_TYPE_COUNT) {
+                return false;
+            }
+            message->type = (linx_control_type_t)value;
+            continue;
+        }
+        if (major != CBOR_MAJOR_TEXT || value > (uint64_t)(reader.end - reader.pos) ||
+            memchr(reader.pos, '\0', (size_t)value)) {
+            return false;
+        }
+        /* 重复的键以第一次出现为准（与 cJSON_GetObjectItem 一致） */
+        if (!message->fields[key].data) {
+            message->fields[key].data = (const char*)reader.pos;
+            message->fields[key].length = (size_t)value;
+        }
+        reader.pos += value;
+    }
+
+    return message->type != LINX_CONTROL_TYPE_INVALID && reader.pos == reader.end;
+}
+
+cJSON* linx_control_message_to_json(const linx_control_message_t* message) {
+    const char* type = message ? linx_control_type_name(message->type) : NULL;
+    if (!type) {
+        return NULL;
+    }
+
+    cJSON* root = cJSON_CreateObject();
+    if (!root || !cJSON_AddStringToObject(root, "type", type)) {
+        cJSON_Delete(root);
+        return NULL;
+    }
+
+    char small[128];
+    for (int f = 1; f < LINX_CONTROL_FIELD_COUNT; f++) {
+        const linx_control_string_t* value = &message->fields[f];
+        if (!value->data) {
+            continue;
+        }
+        /* cJSON 需要以 '\0' 结尾的字符串：短字段用栈缓冲区，长字段临时分配 */
+        char* str = value->length < sizeof(small) ? small : cJSON_malloc(value->length + 1);
+        if (!str) {
+            cJSON_Delete(root);
+            return NULL;
+        }
+        memcpy(str, value->data, value->length);
+        str[value->length] = '\0';
+        cJSON* item = cJSON_AddStringToObject(root, s_field_names[f], str);
+        if (str != small) {
+            cJSON_free(str);
+        }
+        if (!item) {
+            cJSON_Delete(root);
+            return NULL;
+        }
+    }
+
+    return root;
+}
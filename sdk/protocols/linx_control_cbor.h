@@ -0,0 +1,156 @@
+#ifndef LINX_CONTROL_CBOR_H
+#define LINX_CONTROL_CBOR_H
+
+/*
+ * 控制消息的 CBOR 二进制编码（RFC 8949）
+ *
+ * listen/tts/stt/llm/abort 是会话中最频繁的控制消息，JSON 编码时上行要拼接文本、
+ * 下行要扫描或构建 cJSON 树。双方在 hello 的 features.cbor_control 中都声明支持、
+ * 且二进制协议版本 >= 2 时，这些消息改用 CBOR 编码，放在类型为
+ * LINX_BINARY_TYPE_CONTROL 的二进制帧中（v2 帧头的 type 字段，v3/v4 同位置的 type 字节）。
+ * 其他消息（hello、mcp、goodbye 等）以及未协商时仍使用 JSON 文本帧。
+ *
+ * 消息是一个定长 CBOR map，键为无符号整数，值为文本串：
+ *
+ *   键  字段          JSON 中的键
+ *   0   消息类型码    "type"（值为无符号整数，见下表）
+ *   1   session_id    "session_id"
+ *   2   state         "state"
+ *   3   text          "text"
+ *   4   mode          "mode"
+ *   5   reason        "reason"
+ *   6   emotion       "emotion"
+ *
+ *   类型码  消息类型
+ *   1       listen
+ *   2       tts
+ *   3       stt
+ *   4       llm
+ *   5       abort
+ *
+ * 例如 {"type":"tts","state":"start"} 编码为 A2 00 02 02 65 "start"，共 10 字节。
+ * 解码时跳过未知的键（供以后追加字段），未知类型码的消息整体丢弃。
+ * 解码不分配内存、不拷贝，字段指向原始缓冲区；文本串不以 '\0' 结尾。
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "../cjson/cJSON.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 上行 CBOR 控制消息的最大编码长度（字节），超出时改发 JSON */
+#define LINX_CONTROL_CBOR_MAX_SIZE 512
+
+/* 控制消息类型码，0 为无效 */
+typedef enum {
+    LINX_CONTROL_TYPE_INVALID = 0,
+    LINX_CONTROL_TYPE_LISTEN = 1,
+    LINX_CONTROL_TYPE_TTS = 2,
+    LINX_CONTROL_TYPE_STT = 3,
+    LINX_CONTROL_TYPE_LLM = 4,
+    LINX_CONTROL_TYPE_ABORT = 5,
+    LINX_CONTROL_TYPE_COUNT
+} linx_control_type_t;
+
+/* 字段，枚举值即 CBOR 键（键 0 为消息类型，不是字段） */
+typedef enum {
+    LINX_CONTROL_FIELD_SESSION_ID = 1,
+    LINX_CONTROL_FIELD_STATE = 2,
+    LINX_CONTROL_FIELD_TEXT = 3,
+    LINX_CONTROL_FIELD_MODE = 4,
+    LINX_CONTROL_FIELD_REASON = 5,
+    LINX_CONTROL_FIELD_EMOTION = 6,
+    LINX_CONTROL_FIELD_COUNT
+} linx_control_field_t;
+
+/* 字段值：data 为 NULL 表示消息中没有该字段 */
+typedef struct {
+    const char* data;               // 文本起始位置，不以 '\0' 结尾
+    size_t length;                  // 文本长度
+} linx_control_string_t;
+
+/* 控制消息 */
+typedef struct {
+    linx_control_type_t type;                               // 消息类型
+    linx_control_string_t fields[LINX_CONTROL_FIELD_COUNT]; // 按 linx_control_field_t 下标，0 号不使用
+} linx_control_message_t;
+
+/**
+ * 初始化为指定类型、没有任何字段的消息
+ */
+void linx_control_message_init(linx_control_message_t* message, linx_control_type_t type);
+
+/**
+ * 设置字段为以 '\0' 结尾的字符串（不拷贝，编码前需保持有效）；value 为 NULL 时清除该字段
+ */
+void linx_control_message_set(linx_control_message_t* message, linx_control_field_t field, const char* value);
+
+/**
+ * 字段是否存在
+ */
+bool linx_control_message_has(const linx_control_message_t* message, linx_control_field_t field);
+
+/**
+ * 判断字段是否等于给定字符串
+ */
+bool linx_control_message_equals(const linx_control_message_t* message, linx_control_field_t field,
+                                 const char* str);
+
+/**
+ * 将字段复制到缓冲区并补 '\0'
+ * @param buffer 输出缓冲区
+ * @param size 缓冲区大小（含结束符）
+ * @return 写入的字节数（不含结束符）；字段不存在或缓冲区不足时返回 (size_t)-1
+ */
+size_t linx_control_message_copy(const linx_control_message_t* message, linx_control_field_t field,
+                                 char* buffer, size_t size);
+
+/**
+ * 消息类型名称（与 JSON 中的 "type" 相同），无效类型返回 NULL
+ */
+const char* linx_control_type_name(linx_control_type_t type);
+
+/**
+ * 按 JSON 消息类型名称查找类型码，不在表中返回 LINX_CONTROL_TYPE_INVALID
+ */
+linx_control_type_t linx_control_type_from_name(const char* name);
+
+/**
+ * 字段在 JSON 中的键名
+ */
+const char* linx_control_field_name(linx_control_field_t field);
+
+/**
+ * 编码为 CBOR
+ * @param message 消息，类型必须有效
+ * @param buffer 输出缓冲区
+ * @param size 缓冲区大小
+ * @return 编码长度；类型无效或缓冲区不足时返回 0
+ */
+size_t linx_control_cbor_encode(const linx_control_message_t* message, uint8_t* buffer, size_t size);
+
+/**
+ * 解码 CBOR，不分配内存，字段指向 data 内部
+ * @param data CBOR 数据
+ * @param size 数据长度
+ * @param message 输出消息
+ * @return 数据不是合法的控制消息 map、缺少类型、类型码未知、字段不是文本串
+ *         或含有 '\0' 时返回 false
+ */
+bool linx_control_cbor_decode(const uint8_t* data, size_t size, linx_control_message_t* message);
+
+/**
+ * 转换为等价的 JSON 对象，供按 cJSON 处理消息的代码使用
+ * @return cJSON 对象，调用者用 cJSON_Delete() 释放；内存不足时返回 NULL
+ */
+cJSON* linx_control_message_to_json(const linx_control_message_t* message);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINX_CONTROL_CBOR_H */
@@ -0,0 +1,211 @@
+#include "linx_endpoints.h"
+#include <string.h>
+
+/* Weight of a new sample in the moving averages: 1/2^EWMA_SHIFT */
+#define EWMA_SHIFT 3
+
+static uint32_t ewma_update(uint32_t average, uint32_t sample) {
+    return (uint32_t)(((uint64_t)average * ((1u << EWMA_SHIFT) - 1) + sample) >> EWMA_SHIFT);
+}
+
+static bool valid_index(const linx_endpoints_t* endpoints, int index) {
+    return endpoints && index >= 0 && (size_t)index < endpoints->count;
+}
+
+void linx_endpoints_init(linx_endpoints_t* endpoints) {
+    if (endpoints) {
+        memset(endpoints, 0, sizeof(*endpoints));
+    }
+}
+
+int linx_endpoints_find(const linx_endpoints_t* endpoints, const char* url) {
+    if (!endpoints || !url) {
+        return -1;
+    }
+    for (size_t i = 0; i < endpoints->count; i++) {
+        if (strcmp(endpoints->items[i].url, url) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+/* Append url to next, carrying over the measurements old has for it */
+static void endpoints_append(linx_endpoints_t* next, const linx_endpoints_t* old, const char* url, size_t len) {
+    if (len == 0 || len >= LINX_ENDPOINTS_URL_MAX || next->count >= LINX_ENDPOINTS_MAX) {
+        return;
+    }
+    char buf[LINX_ENDPOINTS_URL_MAX];
+    memcpy(buf, url, len);
+    buf[len] = '\0';
+    if (linx_endpoints_find(next, buf) >= 0) {
+        return;
+    }
+
+    linx_endpoint_t* item = &next->items[next->count++];
+    int known = linx_endpoints_find(old, buf);
+    if (known >= 0) {
+        *item = old->items[known];
+    } else {
+        memset(item, 0, sizeof(*item));
+        memcpy(item->url, buf, len + 1);
+    }
+}
+
+size_t linx_endpoints_set(linx_endpoints_t* endpoints, const char* primary, const char* list) {
+    if (!endpoints) {
+        return 0;
+    }
+    linx_endpoints_t next;
+    memset(&next, 0, sizeof(next));
+    if (primary) {
+        endpoints_append(&next, endpoints, primary, strlen(primary));
+    }
+    for (const char* p = list; p && *p;) {
+        p += strspn(p, ", \t\r\n");
+        size_t len = strcspn(p, ", \t\r\n");
+        endpoints_append(&next, endpoints, p, len);
+        p += len;
+    }
+    *endpoints = next;
+    return endpoints->count;
+}
+
+void linx_endpoints_record_rtt(linx_endpoints_t* endpoints, int index, uint32_t rtt_ms, uint64_t now_ms) {
+    if (!valid_index(endpoints, index)) {
+        return;
+    }
+    linx_endpoint_t* item = &endpoints->items[index];
+    if (!item->rtt_valid) {
+        item->rtt_valid = true;
+        item->srtt_ms = rtt_ms;
+        item->rtt_min_ms = rtt_ms;
+    } else {
+        item->srtt_ms = ewma_update(item->srtt_ms, rtt_ms);
+        if (rtt_ms < item->rtt_min_ms) {
+            item->rtt_min_ms = rtt_ms;
+        }
+    }
+    item->loss_permille = (uint16_t)ewma_update(item->loss_permille, 0);
+    item->probes++;
+    item->last_probe_ms = now_ms;
+}
+
+void linx_endpoints_record_loss(linx_endpoints_t* endpoints, int index, uint64_t now_ms) {
+    if (!valid_index(endpoints, index)) {
+        return;
+    }
+    linx_endpoint_t* item = &endpoints->items[index];
+    item->loss_permille = (uint16_t)ewma_update(item->loss_permille, 1000);
+    item->probes_lost++;
+    item->last_probe_ms = now_ms;
+}
+
+static void endpoints_record_failure(linx_endpoint_t* item, uint64_t now_ms) {
+    item->error_permille = (uint16_t)ewma_update(item->error_permille, 1000);
+    item->failures++;
+    if (item->consecutive_failures < UINT8_MAX) {
+        item->consecutive_failures++;
+    }
+    uint64_t cooldown = LINX_ENDPOINTS_COOLDOWN_BASE_MS;
+    for (uint8_t i = 1; i < item->consecutive_failures && cooldown < LINX_ENDPOINTS_COOLDOWN_MAX_MS; i++) {
+        cooldown *= 2;
+    }
+    if (cooldown > LINX_ENDPOINTS_COOLDOWN_MAX_MS) {
+        cooldown = LINX_ENDPOINTS_COOLDOWN_MAX_MS;
+    }
+    item->cooldown_until_ms = now_ms + cooldown;
+}
+
+void linx_endpoints_record_connect(linx_endpoints_t* endpoints, int index, bool ok, uint32_t handshake_ms,
+                                   uint64_t now_ms) {
+    if (!valid_index(endpoints, index)) {
+        return;
+    }
+    linx_endpoint_t* item = &endpoints->items[index];
+    if (!ok) {
+        endpoints_record_failure(item, now_ms);
+        return;
+    }
+    item->handshake_ms = item->handshake_valid ? ewma_update(item->handshake_ms, handshake_ms) : handshake_ms;
+    item->handshake_valid = true;
+    item->error_permille = (uint16_t)ewma_update(item->error_permille, 0);
+    item->connects++;
+    item->consecutive_failures = 0;
+    item->cooldown_until_ms = 0;
+}
+
+void linx_endpoints_record_drop(linx_endpoints_t* endpoints, int index, uint64_t now_ms) {
+    if (valid_index(endpoints, index)) {
+        endpoints_record_failure(&endpoints->items[index], now_ms);
+    }
+}
+
+bool linx_endpoints_cooling_down(const linx_endpoints_t* endpoints, int index, uint64_t now_ms) {
+    return valid_index(endpoints, index) && endpoints->items[index].cooldown_until_ms > now_ms;
+}
+
+uint32_t linx_endpoints_score(const linx_endpoints_t* endpoints, int index) {
+    if (!valid_index(endpoints, index)) {
+        return UINT32_MAX;
+    }
+    const linx_endpoint_t* item = &endpoints->items[index];
+    uint64_t score = item->rtt_valid ? item->srtt_ms : LINX_ENDPOINTS_UNKNOWN_RTT_MS;
+    if (item->handshake_valid) {
+        score += item->handshake_ms / LINX_ENDPOINTS_HANDSHAKE_DIVISOR;
+    }
+    score += (uint64_t)item->loss_permille * LINX_ENDPOINTS_LOSS_PENALTY_MS / 10;
+    score += (uint64_t)item->error_permille * LINX_ENDPOINTS_ERROR_PENALTY_MS / 10;
+    return score > UINT32_MAX ? UINT32_MAX : (uint32_t)score;
+}
+
+int linx_endpoints_best(const linx_endpoints_t* endpoints, int current, uint64_t now_ms) {
+    if (!endpoints || endpoints->count == 0) {
+        return -1;
+    }
+
+    int best = -1;
+    uint32_t best_score = UINT32_MAX;
+    int earliest = 0;
+    for (size_t i = 0; i < endpoints->count; i++) {
+        const linx_endpoint_t* item = &endpoints->items[i];
+        if (item->cooldown_until_ms < endpoints->items[earliest].cooldown_until_ms) {
+            earliest = (int)i;
+        }
+        if (item->cooldown_until_ms > now_ms) {
+            continue;
+        }
+        uint32_t score = linx_endpoints_score(endpoints, (int)i);
+        if (best < 0 || score < best_score) {
+            best = (int)i;
+            best_score = score;
+        }
+    }
+    if (best < 0) {
+        return earliest;
+    }
+
+    // Stay on the current endpoint unless the other one is clearly better
+    if (valid_index(endpoints, current) && current != best && !linx_endpoints_cooling_down(endpoints, current, now_ms) &&
+        linx_endpoints_score(endpoints, current) < best_score + LINX_ENDPOINTS_SWITCH_MARGIN_MS) {
+        return current;
+    }
+    return best;
+}
+
+int linx_endpoints_next_probe(const linx_endpoints_t* endpoints, int skip, uint64_t now_ms, uint32_t interval_ms) {
+    if (!endpoints) {
+        return -1;
+    }
+    int next = -1;
+    for (size_t i = 0; i < endpoints->count; i++) {
+        const linx_endpoint_t* item = &endpoints->items[i];
+        if ((int)i == skip || (item->last_probe_ms != 0 && now_ms - item->last_probe_ms < interval_ms)) {
+            continue;
+        }
+        if (next < 0 || item->last_probe_ms < endpoints->items[next].last_probe_ms) {
+            next = (int)i;
+        }
+    }
+    return next;
+}
@@ -0,0 +1,175 @@
+/**
+ * @file linx_endpoints.h
+ * @brief 服务器端点列表与连接健康度评分
+ *
+ * 同一服务部署在多个地域时，设备应连接往返时延最短、最稳定的那一个。本模块只做记账和
+ * 选择，不做网络 I/O：调用方（linx_sdk.c）把握手耗时、RTT 测量、探测丢失、连接失败和
+ * 异常断开记入对应端点，再用 linx_endpoints_best() 选出得分最低的端点。
+ *
+ * 得分以毫秒计，近似一轮对话因该端点多付出的时延：
+ *
+ *   score = 平滑 RTT + 握手耗时 / LINX_ENDPOINTS_HANDSHAKE_DIVISOR
+ *         + 丢包率(‰) * LINX_ENDPOINTS_LOSS_PENALTY_MS / 10
+ *         + 错误率(‰) * LINX_ENDPOINTS_ERROR_PENALTY_MS / 10
+ *
+ * RTT、握手耗时、丢包率和错误率都是指数加权平均（新样本权重 1/8），旧的测量逐渐淡出。
+ * 还没有测到 RTT 的端点按 LINX_ENDPOINTS_UNKNOWN_RTT_MS 计：测得较好的端点优先于未知端点，
+ * 未知端点优先于明显很差的端点。
+ *
+ * 连接失败后端点进入冷却期（从 LINX_ENDPOINTS_COOLDOWN_BASE_MS 起按连续失败次数翻倍，
+ * 上限 LINX_ENDPOINTS_COOLDOWN_MAX_MS），冷却期内只有所有端点都在冷却时才会被选中，
+ * 重连因此立即换到下一个端点。
+ *
+ * 不是线程安全的，由调用方加锁。
+ */
+
+#ifndef LINX_ENDPOINTS_H
+#define LINX_ENDPOINTS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 端点数上限 */
+#ifndef LINX_ENDPOINTS_MAX
+#define LINX_ENDPOINTS_MAX 4
+#endif
+
+#define LINX_ENDPOINTS_URL_MAX 256
+
+/* 尚未测到 RTT 的端点按该值计分(毫秒) */
+#ifndef LINX_ENDPOINTS_UNKNOWN_RTT_MS
+#define LINX_ENDPOINTS_UNKNOWN_RTT_MS 300
+#endif
+
+/* 握手只在建立连接时付出一次，按该比例折算进得分 */
+#ifndef LINX_ENDPOINTS_HANDSHAKE_DIVISOR
+#define LINX_ENDPOINTS_HANDSHAKE_DIVISOR 4
+#endif
+
+/* 每 1% 丢包、每 1% 连接错误折算的时延(毫秒) */
+#ifndef LINX_ENDPOINTS_LOSS_PENALTY_MS
+#define LINX_ENDPOINTS_LOSS_PENALTY_MS 10
+#endif
+#ifndef LINX_ENDPOINTS_ERROR_PENALTY_MS
+#define LINX_ENDPOINTS_ERROR_PENALTY_MS 10
+#endif
+
+/* 连接失败后的冷却期(毫秒) */
+#ifndef LINX_ENDPOINTS_COOLDOWN_BASE_MS
+#define LINX_ENDPOINTS_COOLDOWN_BASE_MS 10000
+#endif
+#ifndef LINX_ENDPOINTS_COOLDOWN_MAX_MS
+#define LINX_ENDPOINTS_COOLDOWN_MAX_MS 300000
+#endif
+
+/* 另一个端点的得分至少低这么多(毫秒)才换过去，避免在相近的端点之间来回切换 */
+#ifndef LINX_ENDPOINTS_SWITCH_MARGIN_MS
+#define LINX_ENDPOINTS_SWITCH_MARGIN_MS 20
+#endif
+
+/* 单个端点的测量 */
+typedef struct {
+    char url[LINX_ENDPOINTS_URL_MAX];
+    bool rtt_valid;
+    uint32_t srtt_ms;               // 平滑 RTT，rtt_valid 时有效
+    uint32_t rtt_min_ms;            // 最小 RTT，rtt_valid 时有效
+    bool handshake_valid;
+    uint32_t handshake_ms;          // 平滑的握手耗时（拨号到连接建立）
+    uint16_t loss_permille;         // 平滑的探测丢失率(‰)
+    uint16_t error_permille;        // 平滑的连接错误率(‰)：拨号失败和异常断开计 1000，成功的连接计 0
+    uint32_t probes;                // RTT 样本数
+    uint32_t probes_lost;           // 超时或失败的探测数
+    uint32_t connects;              // 成功建立的连接数
+    uint32_t failures;              // 拨号失败和异常断开的次数
+    uint8_t consecutive_failures;   // 连续失败次数，决定冷却期长短
+    uint64_t cooldown_until_ms;     // 冷却期结束时刻 (linx_os_now_ms)
+    uint64_t last_probe_ms;         // 最近一次测量 RTT 的时刻，0 为从未测量
+} linx_endpoint_t;
+
+/* 端点列表 */
+typedef struct {
+    linx_endpoint_t items[LINX_ENDPOINTS_MAX];
+    size_t count;
+} linx_endpoints_t;
+
+/**
+ * 清空列表
+ */
+void linx_endpoints_init(linx_endpoints_t* endpoints);
+
+/**
+ * 设置端点列表：primary 在前，list 中的地址（逗号或空白分隔）依次在后，重复的地址只保留一个
+ *
+ * 列表中已有的地址保留原来的测量，不再出现的地址被移除。
+ * @param primary 首选地址，可为 NULL 或空串
+ * @param list 备选地址，可为 NULL
+ * @return 端点数
+ */
+size_t linx_endpoints_set(linx_endpoints_t* endpoints, const char* primary, const char* list);
+
+/**
+ * 按地址查找端点
+ * @return 下标，找不到返回 -1
+ */
+int linx_endpoints_find(const linx_endpoints_t* endpoints, const char* url);
+
+/**
+ * 记入一个 RTT 样本（ping/pong 或 TCP 建连耗时），同时按一次成功的探测更新丢包率
+ */
+void linx_endpoints_record_rtt(linx_endpoints_t* endpoints, int index, uint32_t rtt_ms, uint64_t now_ms);
+
+/**
+ * 记入一次超时或失败的探测
+ */
+void linx_endpoints_record_loss(linx_endpoints_t* endpoints, int index, uint64_t now_ms);
+
+/**
+ * 记入一次拨号结果
+ * @param ok 连接已建立
+ * @param handshake_ms 拨号到连接建立的耗时，ok 时有效
+ */
+void linx_endpoints_record_connect(linx_endpoints_t* endpoints, int index, bool ok, uint32_t handshake_ms,
+                                   uint64_t now_ms);
+
+/**
+ * 记入一次已建立连接的异常断开（保活判定断线、服务端关闭等；主动断开不要记）
+ */
+void linx_endpoints_record_drop(linx_endpoints_t* endpoints, int index, uint64_t now_ms);
+
+/**
+ * 端点当前是否在连接失败后的冷却期内
+ */
+bool linx_endpoints_cooling_down(const linx_endpoints_t* endpoints, int index, uint64_t now_ms);
+
+/**
+ * 端点的得分(毫秒)，越低越好；不含冷却期
+ */
+uint32_t linx_endpoints_score(const linx_endpoints_t* endpoints, int index);
+
+/**
+ * 选择要连接的端点
+ *
+ * 跳过冷却期内的端点（全部在冷却时选冷却期最早结束的），在其余端点中选得分最低的；
+ * current 不在冷却期时只有得分至少低 LINX_ENDPOINTS_SWITCH_MARGIN_MS 的端点才会替换它。
+ * @param current 当前使用的端点，-1 为没有
+ * @return 下标，列表为空返回 -1
+ */
+int linx_endpoints_best(const linx_endpoints_t* endpoints, int current, uint64_t now_ms);
+
+/**
+ * 选择下一个该测量 RTT 的端点：距上次测量超过 interval_ms 的端点中最久未测的一个
+ * @param skip 不需要探测的端点（例如已连接、由保活测量 RTT 的端点），-1 为没有
+ * @return 下标，没有到期的端点返回 -1
+ */
+int linx_endpoints_next_probe(const linx_endpoints_t* endpoints, int skip, uint64_t now_ms, uint32_t interval_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINX_ENDPOINTS_H */
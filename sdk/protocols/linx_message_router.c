@@ -0,0 +1,208 @@
+#include "linx_message_router.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_PROTOCOL);
+
+/* 哈希桶数量，取处理函数上限的两倍以保持较低的装载因子（必须为2的幂） */
+#define LINX_MESSAGE_ROUTER_BUCKETS (LINX_MESSAGE_ROUTER_MAX_HANDLERS * 2)
+
+/* 路由表项 */
+typedef struct {
+    uint32_t hash;                                  // 类型名哈希，0 表示空槽
+    uint32_t id;                                    // 驻留后的类型ID
+    char type[LINX_MESSAGE_ROUTER_MAX_TYPE_LEN];    // 类型名
+    linx_message_handler_t handler;                 // 处理函数
+    void* user_data;                                // 用户数据
+} linx_message_route_t;
+
+/* 消息路由器：开放寻址哈希表，按类型名 FNV-1a 哈希定位 */
+struct linx_message_router {
+    pthread_mutex_t mutex;                          // 保护路由表（注册可能与网络线程的分发并发）
+    linx_message_route_t routes[LINX_MESSAGE_ROUTER_BUCKETS];
+    size_t count;                                   // 已注册数量
+    uint32_t next_id;                               // 下一个可分配的类型ID
+};
+
+/* FNV-1a 32位哈希，保证非0以便区分空槽 */
+static uint32_t linx_message_router_hash(const char* type) {
+    uint32_t hash = 2166136261u;
+    while (*type) {
+        hash ^= (uint8_t)*type++;
+        hash *= 16777619u;
+    }
+    return hash ? hash : 1;
+}
+
+/* 查找类型所在槽位；不存在时返回可插入的空槽（表满返回 NULL） */
+static linx_message_route_t* linx_message_router_probe(const linx_message_router_t* router,
+                                                       const char* type, uint32_t hash) {
+    size_t mask = LINX_MESSAGE_ROUTER_BUCKETS - 1;
+    size_t index = hash & mask;
+    linx_message_route_t* tombstone = NULL;
+    
+    for (size_t i = 0; i < LINX_MESSAGE_ROUTER_BUCKETS; i++) {
+        linx_message_route_t* route = (linx_message_route_t*)&router->routes[(index + i) & mask];
+        if (route->hash == 0) {
+            if (route->id == 0) {
+                /* 从未使用过的槽位，探测结束 */
+                return tombstone ? tombstone : route;
+            }
+            /* 已注销的槽位，记录下来以便复用 */
+            if (!tombstone) {
+                tombstone = route;
+            }
+            continue;
+        }
+        if (route->hash == hash && strcmp(route->type, type) == 0) {
+            return route;
+        }
+    }
+    
+    return tombstone;
+}
+
+linx_message_router_t* linx_message_router_create(void) {
+    linx_message_router_t* router = LINX_CALLOC(1, sizeof(linx_message_router_t));
+    if (!router) {
+        LOG_ERROR("Failed to allocate message router");
+        return NULL;
+    }
+    
+    router->next_id = 1;
+    pthread_mutex_init(&router->mutex, NULL);
+    return router;
+}
+
+void linx_message_router_destroy(linx_message_router_t* router) {
+    if (!router) {
+        return;
+    }
+    pthread_mutex_destroy(&router->mutex);
+    LINX_FREE(router);
+}
+
+/* 查询接口的参数是 const，互斥锁不属于路由表的逻辑状态 */
+static void linx_message_router_lock(const linx_message_router_t* router) {
+    pthread_mutex_lock((pthread_mutex_t*)&router->mutex);
+}
+
+static void linx_message_router_unlock(const linx_message_router_t* router) {
+    pthread_mutex_unlock((pthread_mutex_t*)&router->mutex);
+}
+
+uint32_t linx_message_router_register(linx_message_router_t* router, const char* type,
+                                      linx_message_handler_t handler, void* user_data) {
+    if (!router || !type || !type[0]) {
+        LOG_ERROR("Invalid parameters: router=%p, type=%p", router, type);
+        return LINX_MESSAGE_TYPE_INVALID;
+    }
+    
+    if (!handler) {
+        linx_message_router_unregister(router, type);
+        return LINX_MESSAGE_TYPE_INVALID;
+    }
+    
+    if (strlen(type) >= LINX_MESSAGE_ROUTER_MAX_TYPE_LEN) {
+        LOG_ERROR("Message type too long: %s", type);
+        return LINX_MESSAGE_TYPE_INVALID;
+    }
+    
+    uint32_t hash = linx_message_router_hash(type);
+    linx_message_router_lock(router);
+    linx_message_route_t* route = linx_message_router_probe(router, type, hash);
+    if (!route || (route->hash == 0 && router->count >= LINX_MESSAGE_ROUTER_MAX_HANDLERS)) {
+        linx_message_router_unlock(router);
+        LOG_ERROR("Message router is full, cannot register type: %s", type);
+        return LINX_MESSAGE_TYPE_INVALID;
+    }
+    
+    if (route->hash == 0) {
+        /* 新类型 */
+        route->hash = hash;
+        route->id = router->next_id++;
+        strcpy(route->type, type);
+        router->count++;
+        LOG_DEBUG("Registered message handler for type '%s' (id %u)", type, route->id);
+    }
+    
+    route->handler = handler;
+    route->user_data = user_data;
+    uint32_t id = route->id;
+    linx_message_router_unlock(router);
+    return id;
+}
+
+bool linx_message_router_unregister(linx_message_router_t* router, const char* type) {
+    if (!router || !type) {
+        return false;
+    }
+    
+    uint32_t hash = linx_message_router_hash(type);
+    linx_message_router_lock(router);
+    linx_message_route_t* route = linx_message_router_probe(router, type, hash);
+    bool found = route && route->hash != 0;
+    if (found) {
+        /* 保留 id 作为墓碑标记，避免截断其他类型的探测链 */
+        route->hash = 0;
+        route->type[0] = '\0';
+        route->handler = NULL;
+        route->user_data = NULL;
+        router->count--;
+    }
+    linx_message_router_unlock(router);
+    return found;
+}
+
+uint32_t linx_message_router_lookup(const linx_message_router_t* router, const char* type) {
+    if (!router || !type) {
+        return LINX_MESSAGE_TYPE_INVALID;
+    }
+    
+    uint32_t hash = linx_message_router_hash(type);
+    linx_message_router_lock(router);
+    const linx_message_route_t* route = linx_message_router_probe(router, type, hash);
+    uint32_t id = (route && route->hash != 0) ? route->id : LINX_MESSAGE_TYPE_INVALID;
+    linx_message_router_unlock(router);
+    return id;
+}
+
+linx_message_handler_t linx_message_router_get_handler(const linx_message_router_t* router, const char* type) {
+    if (!router || !type) {
+        return NULL;
+    }
+    
+    uint32_t hash = linx_message_router_hash(type);
+    linx_message_router_lock(router);
+    const linx_message_route_t* route = linx_message_router_probe(router, type, hash);
+    linx_message_handler_t handler = (route && route->hash != 0) ? route->handler : NULL;
+    linx_message_router_unlock(router);
+    return handler;
+}
+
+bool linx_message_router_dispatch(const linx_message_router_t* router, const char* type, const cJSON* root) {
+    if (!router || !type) {
+        return false;
+    }
+    
+    uint32_t hash = linx_message_router_hash(type);
+    linx_message_handler_t handler = NULL;
+    void* user_data = NULL;
+    linx_message_router_lock(router);
+    const linx_message_route_t* route = linx_message_router_probe(router, type, hash);
+    if (route && route->hash != 0) {
+        handler = route->handler;
+        user_data = route->user_data;
+    }
+    linx_message_router_unlock(router);
+    
+    /* 在锁外调用，处理函数中可以注册、注销 */
+    if (!handler) {
+        return false;
+    }
+    handler(root, user_data);
+    return true;
+}
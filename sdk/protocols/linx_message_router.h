@@ -0,0 +1,91 @@
+#ifndef LINX_MESSAGE_ROUTER_H
+#define LINX_MESSAGE_ROUTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "../cjson/cJSON.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 路由表最多可注册的消息类型数量 */
+#define LINX_MESSAGE_ROUTER_MAX_HANDLERS 32
+/* 消息类型名称最大长度（含结束符） */
+#define LINX_MESSAGE_ROUTER_MAX_TYPE_LEN 32
+
+/* 无效的消息类型ID */
+#define LINX_MESSAGE_TYPE_INVALID 0
+
+/* 消息处理函数：root 为完整消息，仅在回调期间有效 */
+typedef void (*linx_message_handler_t)(const cJSON* root, void* user_data);
+
+/*
+ * 消息路由器 - 前向声明（隐藏实现细节）
+ * 全部函数可在任意线程调用：注册、注销与网络线程上的分发可以并发。处理函数在锁外调用，
+ * 注销返回时另一线程上已经开始的分发可能仍在使用旧的处理函数和 user_data
+ */
+typedef struct linx_message_router linx_message_router_t;
+
+/**
+ * 创建消息路由器
+ * @return 路由器实例，失败返回 NULL
+ */
+linx_message_router_t* linx_message_router_create(void);
+
+/**
+ * 销毁消息路由器
+ * @param router 路由器实例
+ */
+void linx_message_router_destroy(linx_message_router_t* router);
+
+/**
+ * 注册（或替换）某个消息类型的处理函数
+ * @param router 路由器实例
+ * @param type 消息类型字符串，如 "tts"
+ * @param handler 处理函数，为 NULL 时等同于注销
+ * @param user_data 传给处理函数的用户数据
+ * @return 消息类型ID（驻留后的整数标识），失败返回 LINX_MESSAGE_TYPE_INVALID
+ */
+uint32_t linx_message_router_register(linx_message_router_t* router, const char* type,
+                                      linx_message_handler_t handler, void* user_data);
+
+/**
+ * 注销某个消息类型的处理函数
+ * @param router 路由器实例
+ * @param type 消息类型字符串
+ * @return 存在并已注销返回 true
+ */
+bool linx_message_router_unregister(linx_message_router_t* router, const char* type);
+
+/**
+ * 查找消息类型ID
+ * @param router 路由器实例
+ * @param type 消息类型字符串
+ * @return 消息类型ID，未注册返回 LINX_MESSAGE_TYPE_INVALID
+ */
+uint32_t linx_message_router_lookup(const linx_message_router_t* router, const char* type);
+
+/**
+ * 获取某个消息类型当前注册的处理函数
+ * @param router 路由器实例
+ * @param type 消息类型字符串
+ * @return 处理函数，未注册返回 NULL
+ */
+linx_message_handler_t linx_message_router_get_handler(const linx_message_router_t* router, const char* type);
+
+/**
+ * 按消息类型分发消息
+ * @param router 路由器实例
+ * @param type 消息类型字符串（调用方已从 root 中取出）
+ * @param root 完整消息
+ * @return 找到处理函数并已调用返回 true
+ */
+bool linx_message_router_dispatch(const linx_message_router_t* router, const char* type, const cJSON* root);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINX_MESSAGE_ROUTER_H */
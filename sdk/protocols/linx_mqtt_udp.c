@@ -0,0 +1,901 @@
+#include "linx_mqtt_udp.h"
+#include "linx_aes_ctr.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <arpa/inet.h>
+#include <pthread.h>
+#include <mongoose.h>
+#include "../cjson/cJSON.h"
+#include "../cjson/linx_json_scan.h"
+#include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_PROTOCOL);
+
+/* Uplink audio slots waiting for the event loop; a full ring drops the newest frame */
+#define LINX_MQTT_UDP_AUDIO_SLOTS 8
+
+/* Pending text messages from other threads; beyond this they are dropped */
+#define LINX_MQTT_UDP_TEXT_QUEUE_MAX 64
+
+/* Packet type byte of an audio datagram */
+#define LINX_MQTT_UDP_PACKET_AUDIO 0x01
+
+/* A text message queued by another thread */
+typedef struct linx_mqtt_udp_text_item {
+    struct linx_mqtt_udp_text_item* next;
+    size_t size;
+    char data[];
+} linx_mqtt_udp_text_item_t;
+
+struct linx_mqtt_udp_protocol {
+    linx_protocol_t base;                   // 基础协议结构，必须是第一个成员
+
+    /* Event loop */
+    linx_reactor_t* reactor;
+    bool own_reactor;                       // reactor 由本实例创建，销毁时一并释放
+    linx_reactor_hook_t reactor_hook;
+    struct mg_mgr* mgr;
+    struct mg_connection* mqtt_conn;
+    struct mg_connection* udp_conn;
+
+    /* Configuration */
+    char* broker_url;
+    char* client_id;
+    char* username;
+    char* password;
+    char* publish_topic;
+    char* subscribe_topic;
+    char* client_audio_format;
+    int keepalive_s;
+    int audio_sample_rate;
+    int audio_channels;
+    int audio_frame_duration;
+
+    /* Connection state; written on the loop, read anywhere */
+    bool connected;
+    bool udp_opened;
+    bool hello_pending;                     // hello 已发出，等待服务端回应（仅循环上下文）
+    uint64_t last_ping_ms;                  // 仅循环上下文
+
+    /* UDP session: key, counter template and sequence numbers */
+    pthread_mutex_t session_mutex;
+    linx_aes128_t aes;
+    uint8_t nonce[LINX_MQTT_UDP_HEADER_SIZE];
+    uint32_t tx_sequence;
+    uint32_t rx_sequence;                   // 仅循环上下文
+    uint64_t tx_epoch_ms;
+
+    /* Cross-thread send queues */
+    pthread_mutex_t queue_mutex;
+    uint8_t* audio_slots;                   // LINX_MQTT_UDP_AUDIO_SLOTS 个槽位，每个 slot_size 字节
+    size_t audio_slot_lengths[LINX_MQTT_UDP_AUDIO_SLOTS];
+    size_t slot_size;                       // 单个 UDP 包的最大长度（含包头）
+    size_t audio_head;
+    size_t audio_count;
+    linx_mqtt_udp_text_item_t* text_head;
+    linx_mqtt_udp_text_item_t* text_tail;
+    size_t text_depth;
+
+    /* Statistics (atomic) */
+    uint64_t tx_packets;
+    uint64_t tx_dropped;
+    uint64_t rx_packets;
+    uint64_t rx_lost;
+    uint64_t rx_stale;
+    uint64_t rx_invalid;
+
+    /* Decrypted downlink frame, reused for every datagram (loop context) */
+    uint8_t rx_buffer[LINX_MQTT_UDP_MAX_DATAGRAM];
+};
+
+static void linx_mqtt_udp_protocol_destroy(linx_mqtt_udp_protocol_t* mu);
+static void linx_mqtt_udp_mqtt_handler(struct mg_connection* conn, int ev, void* ev_data);
+static void linx_mqtt_udp_udp_handler(struct mg_connection* conn, int ev, void* ev_data);
+static void linx_mqtt_udp_handle_message(linx_mqtt_udp_protocol_t* mu, const char* data, size_t size);
+static bool linx_mqtt_udp_parse_server_hello(linx_mqtt_udp_protocol_t* mu, const cJSON* root);
+static void linx_mqtt_udp_handle_datagram(linx_mqtt_udp_protocol_t* mu, const uint8_t* data, size_t size);
+static bool linx_mqtt_udp_publish(linx_mqtt_udp_protocol_t* mu, const char* text, size_t size);
+static void linx_mqtt_udp_send_hello(linx_mqtt_udp_protocol_t* mu);
+static void linx_mqtt_udp_send_goodbye(linx_mqtt_udp_protocol_t* mu);
+static void linx_mqtt_udp_close_udp(linx_mqtt_udp_protocol_t* mu);
+static void linx_mqtt_udp_flush_queues(linx_mqtt_udp_protocol_t* mu);
+static void linx_mqtt_udp_clear_queues(linx_mqtt_udp_protocol_t* mu);
+static void linx_mqtt_udp_reactor_on_poll(void* user_data);
+static int linx_mqtt_udp_reactor_next_timeout(void* user_data, int idle_ms);
+static void linx_mqtt_udp_start_task(void* arg);
+static void linx_mqtt_udp_open_task(void* arg);
+static void linx_mqtt_udp_close_task(void* arg);
+static void linx_mqtt_udp_detach_task(void* arg);
+
+/* MQTT+UDP 协议的虚函数表 */
+static const linx_protocol_vtable_t linx_mqtt_udp_vtable = {
+    .start = linx_mqtt_udp_start,
+    .send_audio = linx_mqtt_udp_send_audio,
+    .send_text = linx_mqtt_udp_send_text,
+    .send_control = NULL,   // 控制消息始终是 MQTT 上的 JSON
+    .destroy = linx_mqtt_udp_destroy,
+};
+
+/* Start task result, filled in on the loop */
+typedef struct {
+    linx_mqtt_udp_protocol_t* mu;
+    bool result;
+} linx_mqtt_udp_task_op_t;
+
+static bool linx_mqtt_udp_copy_string(char** dst, const char* src) {
+    if (!src) {
+        *dst = NULL;
+        return true;
+    }
+    *dst = LINX_STRDUP(src);
+    return *dst != NULL;
+}
+
+linx_mqtt_udp_protocol_t* linx_mqtt_udp_create(const linx_mqtt_udp_config_t* config) {
+    if (!config || !config->broker_url || !config->client_id || !config->publish_topic) {
+        LOG_ERROR("MQTT+UDP protocol creation failed: broker_url, client_id and publish_topic are required");
+        return NULL;
+    }
+
+    linx_mqtt_udp_protocol_t* mu = LINX_CALLOC(1, sizeof(linx_mqtt_udp_protocol_t));
+    if (!mu) {
+        LOG_ERROR("MQTT+UDP protocol creation failed: memory allocation failed");
+        return NULL;
+    }
+
+    linx_protocol_init(&mu->base, &linx_mqtt_udp_vtable);
+    pthread_mutex_init(&mu->session_mutex, NULL);
+    pthread_mutex_init(&mu->queue_mutex, NULL);
+
+    if (!linx_mqtt_udp_copy_string(&mu->broker_url, config->broker_url) ||
+        !linx_mqtt_udp_copy_string(&mu->client_id, config->client_id) ||
+        !linx_mqtt_udp_copy_string(&mu->username, config->username) ||
+        !linx_mqtt_udp_copy_string(&mu->password, config->password) ||
+        !linx_mqtt_udp_copy_string(&mu->publish_topic, config->publish_topic) ||
+        !linx_mqtt_udp_copy_string(&mu->subscribe_topic, config->subscribe_topic) ||
+        !linx_mqtt_udp_copy_string(&mu->client_audio_format,
+                                   config->client_audio_format ? config->client_audio_format : "opus")) {
+        LOG_ERROR("MQTT+UDP protocol creation failed: memory allocation failed");
+        linx_mqtt_udp_protocol_destroy(mu);
+        return NULL;
+    }
+
+    mu->keepalive_s = config->keepalive_s > 0 ? config->keepalive_s : LINX_MQTT_UDP_KEEPALIVE_S;
+    mu->audio_sample_rate = config->audio_sample_rate;
+    mu->audio_channels = config->audio_channels;
+    mu->audio_frame_duration = config->audio_frame_duration;
+
+    /* One slot holds the largest frame of the configured duration, capped by the datagram size */
+    size_t payload = linx_audio_packet_pool_payload_size(config->audio_frame_duration);
+    if (payload > LINX_MQTT_UDP_MAX_DATAGRAM - LINX_MQTT_UDP_HEADER_SIZE) {
+        payload = LINX_MQTT_UDP_MAX_DATAGRAM - LINX_MQTT_UDP_HEADER_SIZE;
+    }
+    mu->slot_size = LINX_MQTT_UDP_HEADER_SIZE + payload;
+    mu->audio_slots = LINX_MALLOC(LINX_MQTT_UDP_AUDIO_SLOTS * mu->slot_size);
+    if (!mu->audio_slots) {
+        LOG_ERROR("MQTT+UDP protocol creation failed: memory allocation failed (audio slots)");
+        linx_mqtt_udp_protocol_destroy(mu);
+        return NULL;
+    }
+
+    if (config->reactor) {
+        mu->reactor = config->reactor;
+    } else {
+        mu->reactor = linx_reactor_create();
+        if (!mu->reactor) {
+            LOG_ERROR("MQTT+UDP protocol creation failed: reactor unavailable");
+            linx_mqtt_udp_protocol_destroy(mu);
+            return NULL;
+        }
+        mu->own_reactor = true;
+    }
+    mu->mgr = linx_reactor_get_mgr(mu->reactor);
+
+    mu->reactor_hook.on_poll = linx_mqtt_udp_reactor_on_poll;
+    mu->reactor_hook.next_timeout_ms = linx_mqtt_udp_reactor_next_timeout;
+    mu->reactor_hook.user_data = mu;
+    if (!linx_reactor_add_hook(mu->reactor, &mu->reactor_hook)) {
+        LOG_ERROR("Failed to register MQTT+UDP protocol on the reactor");
+        mu->reactor_hook.on_poll = NULL;
+        linx_mqtt_udp_protocol_destroy(mu);
+        return NULL;
+    }
+
+    LOG_INFO("MQTT+UDP protocol created - broker: %s, client: %s", mu->broker_url, mu->client_id);
+    return mu;
+}
+
+static void linx_mqtt_udp_protocol_destroy(linx_mqtt_udp_protocol_t* mu) {
+    if (!mu) {
+        return;
+    }
+
+    if (mu->reactor) {
+        if (mu->reactor_hook.on_poll) {
+            linx_reactor_remove_hook(mu->reactor, &mu->reactor_hook);
+        }
+        /* Say goodbye while the connection is still attached, then drop its callbacks */
+        linx_reactor_run(mu->reactor, linx_mqtt_udp_detach_task, mu);
+        if (mu->own_reactor) {
+            linx_reactor_destroy(mu->reactor);
+        }
+    }
+
+    linx_mqtt_udp_clear_queues(mu);
+    LINX_FREE(mu->audio_slots);
+    LINX_FREE(mu->broker_url);
+    LINX_FREE(mu->client_id);
+    LINX_FREE(mu->username);
+    LINX_FREE(mu->password);
+    LINX_FREE(mu->publish_topic);
+    LINX_FREE(mu->subscribe_topic);
+    LINX_FREE(mu->client_audio_format);
+
+    linx_protocol_deinit(&mu->base);
+    pthread_mutex_destroy(&mu->session_mutex);
+    pthread_mutex_destroy(&mu->queue_mutex);
+
+    LOG_INFO("MQTT+UDP protocol destroyed");
+    LINX_FREE(mu);
+}
+
+void linx_mqtt_udp_destroy(linx_protocol_t* protocol) {
+    linx_mqtt_udp_protocol_destroy((linx_mqtt_udp_protocol_t*)protocol);
+}
+
+bool linx_mqtt_udp_start(linx_protocol_t* protocol) {
+    linx_mqtt_udp_protocol_t* mu = (linx_mqtt_udp_protocol_t*)protocol;
+    if (!mu) {
+        return false;
+    }
+
+    if (mu->own_reactor && !linx_reactor_start(mu->reactor, 0)) {
+        LOG_ERROR("MQTT+UDP start failed: reactor thread unavailable");
+        return false;
+    }
+
+    linx_mqtt_udp_task_op_t op = { mu, false };
+    if (!linx_reactor_run(mu->reactor, linx_mqtt_udp_start_task, &op)) {
+        return false;
+    }
+    return op.result;
+}
+
+/* Dial the broker; runs on the loop */
+static void linx_mqtt_udp_start_task(void* arg) {
+    linx_mqtt_udp_task_op_t* op = (linx_mqtt_udp_task_op_t*)arg;
+    linx_mqtt_udp_protocol_t* mu = op->mu;
+
+    if (mu->mqtt_conn) {
+        op->result = true;
+        return;
+    }
+
+    struct mg_mqtt_opts opts;
+    memset(&opts, 0, sizeof(opts));
+    opts.client_id = mg_str(mu->client_id);
+    if (mu->username) {
+        opts.user = mg_str(mu->username);
+    }
+    if (mu->password) {
+        opts.pass = mg_str(mu->password);
+    }
+    opts.keepalive = (uint16_t)mu->keepalive_s;
+    opts.clean = true;
+    opts.version = 4;
+
+    LOG_INFO("MQTT connecting to %s", mu->broker_url);
+    mu->mqtt_conn = mg_mqtt_connect(mu->mgr, mu->broker_url, &opts, linx_mqtt_udp_mqtt_handler, mu);
+    if (!mu->mqtt_conn) {
+        LOG_ERROR("MQTT connect to %s failed", mu->broker_url);
+        op->result = false;
+        return;
+    }
+    op->result = true;
+}
+
+static void linx_mqtt_udp_mqtt_handler(struct mg_connection* conn, int ev, void* ev_data) {
+    linx_mqtt_udp_protocol_t* mu = (linx_mqtt_udp_protocol_t*)conn->fn_data;
+    if (!mu) {
+        /* Connection left behind by a destroyed instance */
+        return;
+    }
+
+    switch (ev) {
+        case MG_EV_CONNECT: {
+            if (mg_url_is_ssl(mu->broker_url)) {
+                struct mg_tls_opts opts;
+                memset(&opts, 0, sizeof(opts));
+                opts.name = mg_url_host(mu->broker_url);
+                mg_tls_init(conn, &opts);
+            }
+            break;
+        }
+
+        case MG_EV_MQTT_OPEN: {
+            /* Mongoose closes the connection itself when CONNACK carries an error code */
+            if (conn->is_closing) {
+                LOG_ERROR("MQTT broker refused the connection");
+                break;
+            }
+            LOG_INFO("MQTT connected to %s", mu->broker_url);
+            __atomic_store_n(&mu->connected, true, __ATOMIC_RELEASE);
+            mu->last_ping_ms = mg_millis();
+            if (mu->subscribe_topic) {
+                struct mg_mqtt_opts opts;
+                memset(&opts, 0, sizeof(opts));
+                opts.topic = mg_str(mu->subscribe_topic);
+                opts.qos = 0;
+                mg_mqtt_sub(conn, &opts);
+            }
+            if (mu->base.callbacks.on_connected) {
+                mu->base.callbacks.on_connected(mu->base.callbacks.user_data);
+            }
+            linx_mqtt_udp_send_hello(mu);
+            break;
+        }
+
+        case MG_EV_MQTT_MSG: {
+            struct mg_mqtt_message* mm = (struct mg_mqtt_message*)ev_data;
+            linx_protocol_mark_incoming(&mu->base);
+            linx_mqtt_udp_handle_message(mu, mm->data.buf, mm->data.len);
+            break;
+        }
+
+        case MG_EV_ERROR: {
+            char* error_msg = (char*)ev_data;
+            LOG_ERROR("MQTT connection error: %s", error_msg ? error_msg : "Unknown error");
+            linx_protocol_set_error(&mu->base, error_msg ? error_msg : "MQTT connection error");
+            break;
+        }
+
+        case MG_EV_CLOSE: {
+            bool was_connected = __atomic_exchange_n(&mu->connected, false, __ATOMIC_ACQ_REL);
+            mu->mqtt_conn = NULL;
+            mu->hello_pending = false;
+            linx_mqtt_udp_close_udp(mu);
+            LOG_INFO("MQTT connection closed");
+            if (was_connected && mu->base.callbacks.on_disconnected) {
+                mu->base.callbacks.on_disconnected(mu->base.callbacks.user_data);
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+/* One control message from the broker */
+static void linx_mqtt_udp_handle_message(linx_mqtt_udp_protocol_t* mu, const char* data, size_t size) {
+    LOG_DEBUG("MQTT received message: %.*s", (int)size, data);
+
+    /* Scan the top-level "type" first so hot-path messages can skip the cJSON tree */
+    linx_json_scan_field_t type_field = { .key = "type" };
+    char type_buf[32];
+    if (linx_json_scan_object(data, size, &type_field, 1) >= 0) {
+        if (linx_json_scan_copy_string(&type_field, type_buf, sizeof(type_buf)) == (size_t)-1) {
+            LOG_ERROR("MQTT invalid or missing message type");
+            return;
+        }
+        if (mu->base.callbacks.on_incoming_text &&
+            strcmp(type_buf, "hello") != 0 && strcmp(type_buf, "goodbye") != 0 &&
+            mu->base.callbacks.on_incoming_text(type_buf, data, size, mu->base.callbacks.user_data)) {
+            return;
+        }
+    }
+
+    cJSON* json = cJSON_ParseWithLength(data, size);
+    if (!json) {
+        LOG_ERROR("MQTT failed to parse JSON message");
+        return;
+    }
+    cJSON* type = cJSON_GetObjectItemCaseSensitive(json, "type");
+    if (!cJSON_IsString(type) || !type->valuestring) {
+        LOG_ERROR("MQTT invalid or missing message type");
+        cJSON_Delete(json);
+        return;
+    }
+
+    if (strcmp(type->valuestring, "hello") == 0) {
+        mu->hello_pending = false;
+        if (!linx_mqtt_udp_parse_server_hello(mu, json)) {
+            LOG_ERROR("MQTT failed to process server hello message");
+        }
+    } else if (strcmp(type->valuestring, "goodbye") == 0) {
+        /* A goodbye for another session is stale */
+        const cJSON* session_id = cJSON_GetObjectItemCaseSensitive(json, "session_id");
+        const char* current = mu->base.session_id;
+        if (!cJSON_IsString(session_id) || !current || strcmp(session_id->valuestring, current) == 0) {
+            LOG_INFO("MQTT server closed the audio channel");
+            linx_mqtt_udp_close_udp(mu);
+        }
+    }
+
+    if (mu->base.callbacks.on_incoming_message) {
+        mu->base.callbacks.on_incoming_message(json, type->valuestring, mu->base.callbacks.user_data);
+    } else if (mu->base.callbacks.on_incoming_json) {
+        mu->base.callbacks.on_incoming_json(json, mu->base.callbacks.user_data);
+    }
+    cJSON_Delete(json);
+}
+
+/* Decode exactly 2*size hex digits */
+static bool linx_mqtt_udp_parse_hex(const char* hex, uint8_t* out, size_t size) {
+    if (!hex || strlen(hex) != size * 2) {
+        return false;
+    }
+    for (size_t i = 0; i < size * 2; i++) {
+        char c = hex[i];
+        int v = c >= '0' && c <= '9' ? c - '0' :
+                c >= 'a' && c <= 'f' ? c - 'a' + 10 :
+                c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+        if (v < 0) {
+            return false;
+        }
+        out[i / 2] = (uint8_t)(i % 2 ? out[i / 2] | v : v << 4);
+    }
+    return true;
+}
+
+static bool linx_mqtt_udp_parse_server_hello(linx_mqtt_udp_protocol_t* mu, const cJSON* root) {
+    const cJSON* transport = cJSON_GetObjectItemCaseSensitive(root, "transport");
+    if (!cJSON_IsString(transport) || strcmp(transport->valuestring, "udp") != 0) {
+        LOG_ERROR("MQTT server hello: unsupported transport");
+        return false;
+    }
+
+    const cJSON* udp = cJSON_GetObjectItemCaseSensitive(root, "udp");
+    const cJSON* server = cJSON_GetObjectItemCaseSensitive(udp, "server");
+    const cJSON* port = cJSON_GetObjectItemCaseSensitive(udp, "port");
+    const cJSON* key = cJSON_GetObjectItemCaseSensitive(udp, "key");
+    const cJSON* nonce = cJSON_GetObjectItemCaseSensitive(udp, "nonce");
+    uint8_t key_bytes[LINX_AES128_KEY_SIZE];
+    uint8_t nonce_bytes[LINX_MQTT_UDP_HEADER_SIZE];
+    if (!cJSON_IsString(server) || !cJSON_IsNumber(port) || port->valueint <= 0 || port->valueint > 65535 ||
+        !cJSON_IsString(key) || !linx_mqtt_udp_parse_hex(key->valuestring, key_bytes, sizeof(key_bytes)) ||
+        !cJSON_IsString(nonce) || !linx_mqtt_udp_parse_hex(nonce->valuestring, nonce_bytes, sizeof(nonce_bytes))) {
+        LOG_ERROR("MQTT server hello: missing or invalid udp parameters");
+        return false;
+    }
+
+    const cJSON* session_id = cJSON_GetObjectItemCaseSensitive(root, "session_id");
+    if (cJSON_IsString(session_id) && session_id->valuestring) {
+        char* copy = LINX_STRDUP(session_id->valuestring);
+        if (copy) {
+            /* Uplink messages read the session ID under the writer lock */
+            pthread_mutex_lock(&mu->base.writer_mutex);
+            LINX_FREE(mu->base.session_id);
+            mu->base.session_id = copy;
+            pthread_mutex_unlock(&mu->base.writer_mutex);
+        }
+    }
+
+    const cJSON* audio_params = cJSON_GetObjectItemCaseSensitive(root, "audio_params");
+    if (cJSON_IsObject(audio_params)) {
+        const cJSON* sample_rate = cJSON_GetObjectItemCaseSensitive(audio_params, "sample_rate");
+        if (cJSON_IsNumber(sample_rate) && sample_rate->valueint > 0) {
+            mu->audio_sample_rate = sample_rate->valueint;
+        }
+        const cJSON* frame_duration = cJSON_GetObjectItemCaseSensitive(audio_params, "frame_duration");
+        if (cJSON_IsNumber(frame_duration) && frame_duration->valueint > 0) {
+            mu->audio_frame_duration = frame_duration->valueint;
+        }
+    }
+
+    linx_mqtt_udp_close_udp(mu);
+
+    char url[128];
+    snprintf(url, sizeof(url), "udp://%s:%d", server->valuestring, port->valueint);
+    mu->udp_conn = mg_connect(mu->mgr, url, linx_mqtt_udp_udp_handler, mu);
+    if (!mu->udp_conn) {
+        LOG_ERROR("MQTT+UDP failed to open %s", url);
+        return false;
+    }
+
+    pthread_mutex_lock(&mu->session_mutex);
+    linx_aes128_init(&mu->aes, key_bytes);
+    memcpy(mu->nonce, nonce_bytes, sizeof(mu->nonce));
+    mu->tx_sequence = 0;
+    mu->rx_sequence = 0;
+    mu->tx_epoch_ms = mg_millis();
+    pthread_mutex_unlock(&mu->session_mutex);
+
+    __atomic_store_n(&mu->udp_opened, true, __ATOMIC_RELEASE);
+    LOG_INFO("MQTT+UDP audio channel opened: %s", url);
+    return true;
+}
+
+static void linx_mqtt_udp_udp_handler(struct mg_connection* conn, int ev, void* ev_data) {
+    linx_mqtt_udp_protocol_t* mu = (linx_mqtt_udp_protocol_t*)conn->fn_data;
+    (void)ev_data;
+    if (!mu) {
+        return;
+    }
+
+    switch (ev) {
+        case MG_EV_READ: {
+            /* One datagram per read; consume it so the next one does not get appended */
+            linx_mqtt_udp_handle_datagram(mu, conn->recv.buf, conn->recv.len);
+            conn->recv.len = 0;
+            break;
+        }
+
+        case MG_EV_ERROR: {
+            LOG_WARN_EVERY_MS(1000, "UDP audio channel error: %s", ev_data ? (char*)ev_data : "Unknown error");
+            break;
+        }
+
+        case MG_EV_CLOSE: {
+            if (mu->udp_conn == conn) {
+                mu->udp_conn = NULL;
+                __atomic_store_n(&mu->udp_opened, false, __ATOMIC_RELEASE);
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+static void linx_mqtt_udp_handle_datagram(linx_mqtt_udp_protocol_t* mu, const uint8_t* data, size_t size) {
+    if (size <= LINX_MQTT_UDP_HEADER_SIZE || size > LINX_MQTT_UDP_MAX_DATAGRAM ||
+        data[0] != LINX_MQTT_UDP_PACKET_AUDIO) {
+        __atomic_fetch_add(&mu->rx_invalid, 1, __ATOMIC_RELAXED);
+        LOG_WARN_EVERY_MS(1000, "UDP audio: invalid packet (%zu bytes)", size);
+        return;
+    }
+
+    size_t payload_size = size - LINX_MQTT_UDP_HEADER_SIZE;
+    uint32_t timestamp;
+    uint32_t sequence;
+    memcpy(&timestamp, data + 8, sizeof(timestamp));
+    memcpy(&sequence, data + 12, sizeof(sequence));
+    timestamp = ntohl(timestamp);
+    sequence = ntohl(sequence);
+
+    /* Late or duplicate packets are dropped; a jump counts the skipped packets as lost */
+    if (sequence <= mu->rx_sequence) {
+        __atomic_fetch_add(&mu->rx_stale, 1, __ATOMIC_RELAXED);
+        LOG_DEBUG_EVERY_N(50, "UDP audio: stale packet %u (expected %u)", sequence, mu->rx_sequence + 1);
+        return;
+    }
+    if (sequence != mu->rx_sequence + 1) {
+        uint32_t lost = sequence - mu->rx_sequence - 1;
+        __atomic_fetch_add(&mu->rx_lost, lost, __ATOMIC_RELAXED);
+        LOG_WARN_EVERY_MS(1000, "UDP audio: %u packets lost before %u", lost, sequence);
+    }
+    mu->rx_sequence = sequence;
+
+    /* The header doubles as the AES-CTR counter block */
+    pthread_mutex_lock(&mu->session_mutex);
+    linx_aes128_ctr(&mu->aes, data, data + LINX_MQTT_UDP_HEADER_SIZE, mu->rx_buffer, payload_size);
+    pthread_mutex_unlock(&mu->session_mutex);
+    __atomic_fetch_add(&mu->rx_packets, 1, __ATOMIC_RELAXED);
+
+    if (!mu->base.callbacks.on_incoming_audio) {
+        return;
+    }
+    linx_audio_stream_packet_t packet;
+    linx_audio_stream_packet_init_view(&packet, mu->rx_buffer, payload_size);
+    packet.sample_rate = mu->audio_sample_rate;
+    packet.frame_duration = mu->audio_frame_duration;
+    packet.timestamp = timestamp;
+    packet.sequence = (uint16_t)sequence;
+    packet.has_sequence = true;
+
+    /* Steady-state downlink path: the receiver must not touch the heap per frame */
+    linx_alloc_no_alloc_enter();
+    mu->base.callbacks.on_incoming_audio(&packet, mu->base.callbacks.user_data);
+    linx_alloc_no_alloc_leave();
+}
+
+bool linx_mqtt_udp_send_audio(linx_protocol_t* protocol, linx_audio_stream_packet_t* packet) {
+    linx_mqtt_udp_protocol_t* mu = (linx_mqtt_udp_protocol_t*)protocol;
+    if (!mu || !packet) {
+        return false;
+    }
+    if (!__atomic_load_n(&mu->udp_opened, __ATOMIC_ACQUIRE)) {
+        __atomic_fetch_add(&mu->tx_dropped, 1, __ATOMIC_RELAXED);
+        LOG_WARN_EVERY_MS(1000, "UDP audio channel not open, dropping frame");
+        return false;
+    }
+    if (LINX_MQTT_UDP_HEADER_SIZE + packet->payload_size > mu->slot_size) {
+        LOG_ERROR("UDP audio frame too large (%zu bytes)", packet->payload_size);
+        return false;
+    }
+
+    bool in_loop = linx_reactor_in_loop(mu->reactor);
+    uint8_t local[LINX_MQTT_UDP_MAX_DATAGRAM];
+    uint8_t* datagram = local;
+    size_t size = LINX_MQTT_UDP_HEADER_SIZE + packet->payload_size;
+
+    /* Off the loop the frame is encrypted straight into its queue slot */
+    if (!in_loop) {
+        pthread_mutex_lock(&mu->queue_mutex);
+        if (mu->audio_count == LINX_MQTT_UDP_AUDIO_SLOTS) {
+            pthread_mutex_unlock(&mu->queue_mutex);
+            __atomic_fetch_add(&mu->tx_dropped, 1, __ATOMIC_RELAXED);
+            LOG_WARN_EVERY_MS(1000, "UDP audio send queue full, dropping frame");
+            return false;
+        }
+        size_t slot = (mu->audio_head + mu->audio_count) % LINX_MQTT_UDP_AUDIO_SLOTS;
+        datagram = mu->audio_slots + slot * mu->slot_size;
+    }
+
+    pthread_mutex_lock(&mu->session_mutex);
+    uint32_t timestamp = packet->timestamp ? packet->timestamp : (uint32_t)(mg_millis() - mu->tx_epoch_ms);
+    uint16_t length = htons((uint16_t)packet->payload_size);
+    uint32_t timestamp_be = htonl(timestamp);
+    uint32_t sequence_be = htonl(++mu->tx_sequence);
+    memcpy(datagram, mu->nonce, LINX_MQTT_UDP_HEADER_SIZE);
+    datagram[0] = LINX_MQTT_UDP_PACKET_AUDIO;
+    memcpy(datagram + 2, &length, sizeof(length));
+    memcpy(datagram + 8, &timestamp_be, sizeof(timestamp_be));
+    memcpy(datagram + 12, &sequence_be, sizeof(sequence_be));
+    linx_aes128_ctr(&mu->aes, datagram, packet->payload, datagram + LINX_MQTT_UDP_HEADER_SIZE,
+                    packet->payload_size);
+    pthread_mutex_unlock(&mu->session_mutex);
+
+    if (!in_loop) {
+        size_t slot = (mu->audio_head + mu->audio_count) % LINX_MQTT_UDP_AUDIO_SLOTS;
+        mu->audio_slot_lengths[slot] = size;
+        mu->audio_count++;
+        pthread_mutex_unlock(&mu->queue_mutex);
+        linx_reactor_wakeup(mu->reactor);
+        return true;
+    }
+
+    if (!mu->udp_conn || !mg_send(mu->udp_conn, datagram, size)) {
+        __atomic_fetch_add(&mu->tx_dropped, 1, __ATOMIC_RELAXED);
+        return false;
+    }
+    __atomic_fetch_add(&mu->tx_packets, 1, __ATOMIC_RELAXED);
+    return true;
+}
+
+bool linx_mqtt_udp_send_text(linx_protocol_t* protocol, const char* text) {
+    linx_mqtt_udp_protocol_t* mu = (linx_mqtt_udp_protocol_t*)protocol;
+    if (!mu || !text || !__atomic_load_n(&mu->connected, __ATOMIC_ACQUIRE)) {
+        LOG_ERROR("MQTT send text failed: invalid protocol or not connected");
+        return false;
+    }
+    LOG_DEBUG("MQTT sending text: %s", text);
+
+    size_t len = strlen(text);
+    if (linx_reactor_in_loop(mu->reactor)) {
+        return linx_mqtt_udp_publish(mu, text, len);
+    }
+
+    /* Mongoose is not thread-safe: hand the message to the event loop */
+    linx_mqtt_udp_text_item_t* item = LINX_MALLOC(sizeof(linx_mqtt_udp_text_item_t) + len);
+    if (!item) {
+        LOG_ERROR("MQTT send text failed: memory allocation failed");
+        return false;
+    }
+    item->next = NULL;
+    item->size = len;
+    memcpy(item->data, text, len);
+
+    pthread_mutex_lock(&mu->queue_mutex);
+    if (mu->text_depth >= LINX_MQTT_UDP_TEXT_QUEUE_MAX) {
+        pthread_mutex_unlock(&mu->queue_mutex);
+        LOG_WARN("MQTT text send queue full, dropping message");
+        LINX_FREE(item);
+        return false;
+    }
+    if (mu->text_tail) {
+        mu->text_tail->next = item;
+    } else {
+        mu->text_head = item;
+    }
+    mu->text_tail = item;
+    mu->text_depth++;
+    pthread_mutex_unlock(&mu->queue_mutex);
+
+    linx_reactor_wakeup(mu->reactor);
+    return true;
+}
+
+/* Publish to the uplink topic; loop context only */
+static bool linx_mqtt_udp_publish(linx_mqtt_udp_protocol_t* mu, const char* text, size_t size) {
+    if (!mu->mqtt_conn || !mu->connected) {
+        return false;
+    }
+    struct mg_mqtt_opts opts;
+    memset(&opts, 0, sizeof(opts));
+    opts.topic = mg_str(mu->publish_topic);
+    opts.message = mg_str_n(text, size);
+    opts.qos = 0;
+    mg_mqtt_pub(mu->mqtt_conn, &opts);
+    return true;
+}
+
+static void linx_mqtt_udp_send_hello(linx_mqtt_udp_protocol_t* mu) {
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddStringToObject(root, "type", "hello");
+    cJSON_AddNumberToObject(root, "version", 3);
+    cJSON_AddStringToObject(root, "transport", "udp");
+    cJSON* features = cJSON_CreateObject();
+    cJSON_AddBoolToObject(features, "mcp", true);
+    cJSON_AddItemToObject(root, "features", features);
+    cJSON* audio_params = cJSON_CreateObject();
+    cJSON_AddStringToObject(audio_params, "format", mu->client_audio_format);
+    cJSON_AddNumberToObject(audio_params, "sample_rate", mu->audio_sample_rate);
+    cJSON_AddNumberToObject(audio_params, "channels", mu->audio_channels);
+    cJSON_AddNumberToObject(audio_params, "frame_duration", mu->audio_frame_duration);
+    cJSON_AddItemToObject(root, "audio_params", audio_params);
+
+    /* Printed into the connection's message writer, which is reused for every outbound message */
+    pthread_mutex_lock(&mu->base.writer_mutex);
+    const char* hello = linx_json_print(&mu->base.writer, root);
+    cJSON_Delete(root);
+    if (hello) {
+        LOG_DEBUG("Sending MQTT hello message");
+        mu->hello_pending = linx_mqtt_udp_publish(mu, hello, mu->base.writer.length);
+    } else {
+        LOG_ERROR("Failed to generate MQTT hello message");
+    }
+    pthread_mutex_unlock(&mu->base.writer_mutex);
+}
+
+static void linx_mqtt_udp_send_goodbye(linx_mqtt_udp_protocol_t* mu) {
+    char goodbye[160];
+    const char* session_id = mu->base.session_id ? mu->base.session_id : "";
+    int n = snprintf(goodbye, sizeof(goodbye), "{\"session_id\":\"%s\",\"type\":\"goodbye\"}", session_id);
+    if (n > 0 && (size_t)n < sizeof(goodbye)) {
+        linx_mqtt_udp_publish(mu, goodbye, (size_t)n);
+    }
+}
+
+/* Drop the UDP session; loop context only */
+static void linx_mqtt_udp_close_udp(linx_mqtt_udp_protocol_t* mu) {
+    if (mu->udp_conn) {
+        mu->udp_conn->fn_data = NULL;
+        mu->udp_conn->is_closing = 1;
+        mu->udp_conn = NULL;
+    }
+    if (__atomic_exchange_n(&mu->udp_opened, false, __ATOMIC_ACQ_REL)) {
+        LOG_INFO("MQTT+UDP audio channel closed");
+    }
+}
+
+/* Send what other threads queued; loop context only */
+static void linx_mqtt_udp_flush_queues(linx_mqtt_udp_protocol_t* mu) {
+    pthread_mutex_lock(&mu->queue_mutex);
+    while (mu->audio_count > 0) {
+        const uint8_t* datagram = mu->audio_slots + mu->audio_head * mu->slot_size;
+        size_t size = mu->audio_slot_lengths[mu->audio_head];
+        if (mu->udp_conn && mg_send(mu->udp_conn, datagram, size)) {
+            __atomic_fetch_add(&mu->tx_packets, 1, __ATOMIC_RELAXED);
+        } else {
+            __atomic_fetch_add(&mu->tx_dropped, 1, __ATOMIC_RELAXED);
+        }
+        mu->audio_head = (mu->audio_head + 1) % LINX_MQTT_UDP_AUDIO_SLOTS;
+        mu->audio_count--;
+    }
+    linx_mqtt_udp_text_item_t* item = mu->text_head;
+    mu->text_head = NULL;
+    mu->text_tail = NULL;
+    mu->text_depth = 0;
+    pthread_mutex_unlock(&mu->queue_mutex);
+
+    while (item) {
+        linx_mqtt_udp_text_item_t* next = item->next;
+        linx_mqtt_udp_publish(mu, item->data, item->size);
+        LINX_FREE(item);
+        item = next;
+    }
+}
+
+static void linx_mqtt_udp_clear_queues(linx_mqtt_udp_protocol_t* mu) {
+    pthread_mutex_lock(&mu->queue_mutex);
+    linx_mqtt_udp_text_item_t* item = mu->text_head;
+    mu->text_head = NULL;
+    mu->text_tail = NULL;
+    mu->text_depth = 0;
+    mu->audio_count = 0;
+    pthread_mutex_unlock(&mu->queue_mutex);
+
+    while (item) {
+        linx_mqtt_udp_text_item_t* next = item->next;
+        LINX_FREE(item);
+        item = next;
+    }
+}
+
+static void linx_mqtt_udp_reactor_on_poll(void* user_data) {
+    linx_mqtt_udp_protocol_t* mu = (linx_mqtt_udp_protocol_t*)user_data;
+    linx_mqtt_udp_flush_queues(mu);
+
+    /* Ping at half the keepalive so the broker never sees a silent interval */
+    if (mu->mqtt_conn && mu->connected) {
+        uint64_t now = mg_millis();
+        if (now - mu->last_ping_ms >= (uint64_t)mu->keepalive_s * 500) {
+            mg_mqtt_ping(mu->mqtt_conn);
+            mu->last_ping_ms = now;
+        }
+    }
+}
+
+static int linx_mqtt_udp_reactor_next_timeout(void* user_data, int idle_ms) {
+    linx_mqtt_udp_protocol_t* mu = (linx_mqtt_udp_protocol_t*)user_data;
+    if (!mu->mqtt_conn || !mu->connected) {
+        return idle_ms;
+    }
+    uint64_t due = mu->last_ping_ms + (uint64_t)mu->keepalive_s * 500;
+    uint64_t now = mg_millis();
+    int wait = due > now ? (int)(due - now) : 0;
+    return wait < idle_ms ? wait : idle_ms;
+}
+
+bool linx_mqtt_udp_open_audio_channel(linx_mqtt_udp_protocol_t* protocol) {
+    if (!protocol || !__atomic_load_n(&protocol->connected, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+    return linx_reactor_run(protocol->reactor, linx_mqtt_udp_open_task, protocol);
+}
+
+static void linx_mqtt_udp_open_task(void* arg) {
+    linx_mqtt_udp_protocol_t* mu = (linx_mqtt_udp_protocol_t*)arg;
+    if (mu->connected && !mu->udp_opened && !mu->hello_pending) {
+        linx_mqtt_udp_send_hello(mu);
+    }
+}
+
+void linx_mqtt_udp_close_audio_channel(linx_mqtt_udp_protocol_t* protocol) {
+    if (protocol) {
+        linx_reactor_run(protocol->reactor, linx_mqtt_udp_close_task, protocol);
+    }
+}
+
+static void linx_mqtt_udp_close_task(void* arg) {
+    linx_mqtt_udp_protocol_t* mu = (linx_mqtt_udp_protocol_t*)arg;
+    if (mu->udp_opened) {
+        linx_mqtt_udp_send_goodbye(mu);
+    }
+    linx_mqtt_udp_close_udp(mu);
+}
+
+/* Say goodbye, then let the broker connection drain and close without calling back into this instance */
+static void linx_mqtt_udp_detach_task(void* arg) {
+    linx_mqtt_udp_protocol_t* mu = (linx_mqtt_udp_protocol_t*)arg;
+    linx_mqtt_udp_close_task(mu);
+    if (mu->mqtt_conn) {
+        struct mg_mqtt_opts opts;
+        memset(&opts, 0, sizeof(opts));
+        if (mu->connected) {
+            mg_mqtt_disconnect(mu->mqtt_conn, &opts);
+        }
+        mu->mqtt_conn->fn_data = NULL;
+        mu->mqtt_conn->is_draining = 1;
+        mu->mqtt_conn = NULL;
+    }
+    __atomic_store_n(&mu->connected, false, __ATOMIC_RELEASE);
+}
+
+bool linx_mqtt_udp_is_connected(const linx_mqtt_udp_protocol_t* protocol) {
+    return protocol ? __atomic_load_n(&protocol->connected, __ATOMIC_ACQUIRE) : false;
+}
+
+bool linx_mqtt_udp_is_audio_channel_opened(const linx_mqtt_udp_protocol_t* protocol) {
+    return protocol ? __atomic_load_n(&protocol->udp_opened, __ATOMIC_ACQUIRE) : false;
+}
+
+bool linx_mqtt_udp_get_stats(linx_mqtt_udp_protocol_t* protocol, linx_mqtt_udp_stats_t* stats) {
+    if (!protocol || !stats) {
+        return false;
+    }
+    stats->mqtt_connected = __atomic_load_n(&protocol->connected, __ATOMIC_ACQUIRE);
+    stats->udp_opened = __atomic_load_n(&protocol->udp_opened, __ATOMIC_ACQUIRE);
+    stats->tx_packets = __atomic_load_n(&protocol->tx_packets, __ATOMIC_RELAXED);
+    stats->tx_dropped = __atomic_load_n(&protocol->tx_dropped, __ATOMIC_RELAXED);
+    stats->rx_packets = __atomic_load_n(&protocol->rx_packets, __ATOMIC_RELAXED);
+    stats->rx_lost = __atomic_load_n(&protocol->rx_lost, __ATOMIC_RELAXED);
+    stats->rx_stale = __atomic_load_n(&protocol->rx_stale, __ATOMIC_RELAXED);
+    stats->rx_invalid = __atomic_load_n(&protocol->rx_invalid, __ATOMIC_RELAXED);
+    return true;
+}
@@ -0,0 +1,141 @@
+#ifndef LINX_MQTT_UDP_H
+#define LINX_MQTT_UDP_H
+
+/*
+ * MQTT + UDP 传输（xiaozhi 兼容服务端使用的方案）
+ *
+ * 控制消息走 MQTT，音频走加密的 UDP，丢一个音频包只丢一帧，不会像 TCP 那样
+ * 因为一个丢失的报文段把之后的 TTS 全部卡住一个重传超时。
+ *
+ * 会话流程：
+ * 1. 连接 MQTT 代理后向 publish_topic 发布 hello（"transport":"udp"），
+ *    服务端通过订阅主题回应 hello，其中 "udp" 对象给出 server、port、
+ *    key（AES-128 密钥）和 nonce（计数器模板），均为十六进制字符串；
+ * 2. 之后 listen/abort/mcp 等 JSON 控制消息仍在 MQTT 上收发，音频在 UDP 上收发；
+ * 3. 任一方发送 {"type":"goodbye"} 结束音频通道，需要时再次发送 hello 打开。
+ *
+ * UDP 包 = 16 字节头 + AES-128-CTR 加密的 Opus 帧，头本身就是该包的计数器初值：
+ *
+ *   偏移  长度  内容
+ *   0     1     类型，固定 0x01
+ *   1     1     标志，保留
+ *   2     2     载荷长度（大端）
+ *   4     4     SSRC，取自服务端 nonce
+ *   8     4     时间戳（毫秒，大端）
+ *   12    4     序号（大端），每个方向各自从 1 递增
+ *
+ * 其余字节与服务端 nonce 相同。收到序号不大于已收序号的包视为重复或过期而丢弃，
+ * 序号跳变计为丢包。每个包独立解密，乱序到达的包不影响其他包。
+ *
+ * 事件循环复用 linx_reactor：配置未给 reactor 时自建一个并启动其线程。
+ * 回调都在循环上下文中调用；发送函数可在任意线程调用。
+ * 断开后不自动重连，由应用重新调用 linx_mqtt_udp_start()。
+ */
+
+#include "linx_protocol.h"
+#include "linx_reactor.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* MQTT+UDP 协议实现结构体 - 前向声明（隐藏实现细节） */
+typedef struct linx_mqtt_udp_protocol linx_mqtt_udp_protocol_t;
+
+/* UDP 包头长度，也是 AES-CTR 计数器长度 */
+#define LINX_MQTT_UDP_HEADER_SIZE 16
+
+/* 单个 UDP 包的最大长度（字节） */
+#define LINX_MQTT_UDP_MAX_DATAGRAM 1500
+
+/* MQTT 默认心跳间隔（秒） */
+#define LINX_MQTT_UDP_KEEPALIVE_S 90
+
+/* 配置 */
+typedef struct {
+    const char* broker_url;          // MQTT 代理地址，如 "mqtts://broker.example.com:8883"
+    const char* client_id;           // MQTT 客户端ID
+    const char* username;            // 用户名，可为 NULL
+    const char* password;            // 密码，可为 NULL
+    const char* publish_topic;       // 上行控制消息主题
+    const char* subscribe_topic;     // 下行控制消息主题，NULL 时不订阅（由代理按客户端ID投递）
+    int keepalive_s;                 // MQTT 心跳间隔（秒），<=0 为 LINX_MQTT_UDP_KEEPALIVE_S
+
+    /* 音频参数（hello 中的 audio_params） */
+    const char* client_audio_format; // 音频格式，NULL 为 "opus"
+    int audio_sample_rate;           // 采样率
+    int audio_channels;              // 声道数
+    int audio_frame_duration;        // 帧持续时间（毫秒）
+
+    /* 共享事件循环：NULL 时自建 reactor 并启动其线程 */
+    linx_reactor_t* reactor;
+} linx_mqtt_udp_config_t;
+
+/* 统计 */
+typedef struct {
+    bool mqtt_connected;            // MQTT 已连接
+    bool udp_opened;                // 音频通道已打开
+    uint64_t tx_packets;            // 发出的音频包数
+    uint64_t tx_dropped;            // 通道未打开、队列已满或发送失败而丢弃的上行音频包数
+    uint64_t rx_packets;            // 收到并解密的音频包数
+    uint64_t rx_lost;               // 按序号跳变推算的丢包数
+    uint64_t rx_stale;              // 重复或过期而丢弃的包数
+    uint64_t rx_invalid;            // 包头非法的包数
+} linx_mqtt_udp_stats_t;
+
+/**
+ * 创建 MQTT+UDP 协议实例
+ * @param config 配置参数（字符串会被复制）
+ * @return 协议实例，参数缺失或内存不足时返回 NULL
+ */
+linx_mqtt_udp_protocol_t* linx_mqtt_udp_create(const linx_mqtt_udp_config_t* config);
+
+/* vtable 函数 */
+bool linx_mqtt_udp_start(linx_protocol_t* protocol);
+bool linx_mqtt_udp_send_audio(linx_protocol_t* protocol, linx_audio_stream_packet_t* packet);
+bool linx_mqtt_udp_send_text(linx_protocol_t* protocol, const char* text);
+
+/**
+ * 销毁协议实例：已打开音频通道时先发送 goodbye
+ * @param protocol 要销毁的协议实例
+ */
+void linx_mqtt_udp_destroy(linx_protocol_t* protocol);
+
+/**
+ * 重新打开音频通道（发送 hello），通道已打开或正在打开时不做任何操作
+ * @param protocol 协议实例
+ * @return MQTT 已连接返回 true
+ */
+bool linx_mqtt_udp_open_audio_channel(linx_mqtt_udp_protocol_t* protocol);
+
+/**
+ * 关闭音频通道：发送 goodbye 并关闭 UDP，MQTT 保持连接
+ * @param protocol 协议实例
+ */
+void linx_mqtt_udp_close_audio_channel(linx_mqtt_udp_protocol_t* protocol);
+
+/**
+ * MQTT 是否已连接
+ */
+bool linx_mqtt_udp_is_connected(const linx_mqtt_udp_protocol_t* protocol);
+
+/**
+ * 音频通道是否已打开
+ */
+bool linx_mqtt_udp_is_audio_channel_opened(const linx_mqtt_udp_protocol_t* protocol);
+
+/**
+ * 获取统计（可在任意线程调用）
+ * @param protocol 协议实例
+ * @param stats 统计信息（输出参数）
+ * @return 成功返回 true
+ */
+bool linx_mqtt_udp_get_stats(linx_mqtt_udp_protocol_t* protocol, linx_mqtt_udp_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINX_MQTT_UDP_H */
@@ -0,0 +1,483 @@
+#include "linx_ogg_recorder.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_PROTOCOL);
+
+#define LINX_OGG_HEADER_SIZE   27
+#define LINX_OGG_MAX_SEGMENTS  255
+#define LINX_OGG_MAX_BODY      (LINX_OGG_MAX_SEGMENTS * 255)
+#define LINX_OGG_MAX_PAGE      (LINX_OGG_HEADER_SIZE + LINX_OGG_MAX_SEGMENTS + LINX_OGG_MAX_BODY)
+
+#define LINX_OGG_FLAG_BOS      0x02
+#define LINX_OGG_FLAG_EOS      0x04
+
+/* 一页凑够这么多数据或这么长的音频就封页，页越大每包的页头开销越小，丢页时损失越多 */
+#define LINX_OGG_PAGE_TARGET_BYTES   4096
+#define LINX_OGG_PAGE_TARGET_SAMPLES 48000
+
+/* 写线程把缓冲区写入文件的间隔（毫秒）；缓冲区超过一半时提前唤醒 */
+#define LINX_OGG_RECORDER_FLUSH_MS   500
+
+#define LINX_OGG_OPUS_HEAD_SIZE      19
+#define LINX_OGG_VENDOR              "linx-os-sdk"
+
+/* 一个方向的文件和当前逻辑流 */
+typedef struct {
+    int fd;                         // -1 表示不录制该方向
+    bool failed;                    // 写文件出错后不再录制
+    bool started;                   // 已写出当前逻辑流的 OpusHead/OpusTags
+    uint32_t serial;                // 当前逻辑流的序列号
+    uint32_t page_sequence;         // 下一页的页序号
+    uint64_t granule;               // 已封入页的样本数（48kHz）
+    uint64_t page_granule;          // 当前页开始时的 granule
+    int sample_rate;                // 当前逻辑流的输入采样率
+    int channels;                   // 当前逻辑流的声道数
+    uint8_t lacing[LINX_OGG_MAX_SEGMENTS]; // 当前页的段表
+    size_t lacing_count;
+    uint8_t* body;                  // 当前页的数据，LINX_OGG_MAX_BODY 字节
+    size_t body_size;
+    uint8_t* fill;                  // 调用方追加页的缓冲区
+    size_t fill_size;
+    uint8_t* drain;                 // 写线程正在写出的缓冲区
+} linx_ogg_track_t;
+
+struct linx_ogg_recorder {
+    linx_ogg_track_t tracks[LINX_OGG_RECORDER_DIRECTIONS];
+    size_t buffer_size;             // 每个方向的 fill/drain 缓冲区大小
+    int sync_ms;                    // fsync 间隔，<0 不主动 fsync
+    uint32_t chains;                // 已开始的逻辑流数，参与生成序列号
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    pthread_t thread;
+    bool flush_requested;
+    bool stopping;
+    linx_ogg_recorder_stats_t stats;
+};
+
+static const char* const s_direction_names[LINX_OGG_RECORDER_DIRECTIONS] = { "uplink", "downlink" };
+
+static uint32_t s_crc_table[256];
+static pthread_once_t s_crc_once = PTHREAD_ONCE_INIT;
+
+/* Ogg 页校验：CRC-32，多项式 0x04c11db7，不反转、初值和结果异或均为 0 */
+static void linx_ogg_crc_init(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t r = i << 24;
+        for (int bit = 0; bit < 8; bit++) {
+            r = (r & 0x80000000u) ? (r << 1) ^ 0x04c11db7u : r << 1;
+        }
+        s_crc_table[i] = r;
+    }
+}
+
+static uint32_t linx_ogg_crc(const uint8_t* data, size_t size) {
+    uint32_t crc = 0;
+    for (size_t i = 0; i < size; i++) {
+        crc = (crc << 8) ^ s_crc_table[((crc >> 24) ^ data[i]) & 0xFF];
+    }
+    return crc;
+}
+
+static void linx_ogg_put_le32(uint8_t* out, uint32_t value) {
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+    out[2] = (uint8_t)(value >> 16);
+    out[3] = (uint8_t)(value >> 24);
+}
+
+static uint64_t linx_ogg_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)(ts.tv_nsec / 1000000);
+}
+
+int linx_ogg_opus_packet_samples(const uint8_t* data, size_t size) {
+    if (!data || size == 0) {
+        return 0;
+    }
+
+    int config = data[0] >> 3;
+    int frame_samples;
+    if (config < 12) {
+        /* SILK: 10/20/40/60 ms */
+        static const int silk[4] = { 480, 960, 1920, 2880 };
+        frame_samples = silk[config & 3];
+    } else if (config < 16) {
+        /* Hybrid: 10/20 ms */
+        frame_samples = (config & 1) ? 960 : 480;
+    } else {
+        /* CELT: 2.5/5/10/20 ms */
+        frame_samples = 120 << (config & 3);
+    }
+
+    int frames;
+    switch (data[0] & 3) {
+        case 0:
+            frames = 1;
+            break;
+        case 1:
+        case 2:
+            frames = 2;
+            break;
+        default:
+            if (size < 2) {
+                return 0;
+            }
+            frames = data[1] & 0x3F;
+            break;
+    }
+
+    int samples = frames * frame_samples;
+    return samples > 0 && samples <= 5760 ? samples : 0;
+}
+
+/* 封页并追加到 fill 缓冲区，调用时持有 mutex；缓冲区放不下时丢弃整页，页序号照常递增 */
+static void linx_ogg_emit_page(linx_ogg_recorder_t* recorder, linx_ogg_track_t* track, uint8_t flags) {
+    size_t page_size = LINX_OGG_HEADER_SIZE + track->lacing_count + track->body_size;
+
+    if (track->fill_size + page_size <= recorder->buffer_size) {
+        uint8_t* page = track->fill + track->fill_size;
+        memcpy(page, "OggS", 4);
+        page[4] = 0;
+        page[5] = flags;
+        for (int i = 0; i < 8; i++) {
+            page[6 + i] = (uint8_t)(track->granule >> (8 * i));
+        }
+        linx_ogg_put_le32(page + 14, track->serial);
+        linx_ogg_put_le32(page + 18, track->page_sequence);
+        linx_ogg_put_le32(page + 22, 0);
+        page[26] = (uint8_t)track->lacing_count;
+        memcpy(page + LINX_OGG_HEADER_SIZE, track->lacing, track->lacing_count);
+        memcpy(page + LINX_OGG_HEADER_SIZE + track->lacing_count, track->body, track->body_size);
+        linx_ogg_put_le32(page + 22, linx_ogg_crc(page, page_size));
+        track->fill_size += page_size;
+        recorder->stats.pages++;
+    } else {
+        recorder->stats.dropped_pages++;
+        LOG_WARN_EVERY_MS(5000, "Ogg recorder: write buffer full, dropped %llu pages so far",
+                          (unsigned long long)recorder->stats.dropped_pages);
+    }
+
+    track->page_sequence++;
+    track->page_granule = track->granule;
+    track->lacing_count = 0;
+    track->body_size = 0;
+
+    if (!recorder->flush_requested && track->fill_size > recorder->buffer_size / 2) {
+        recorder->flush_requested = true;
+        pthread_cond_signal(&recorder->cond);
+    }
+}
+
+/* 把一个完整的包放进当前页，调用方保证段表和数据区放得下 */
+static void linx_ogg_append_packet(linx_ogg_track_t* track, const uint8_t* data, size_t size) {
+    size_t remaining = size;
+    while (remaining >= 255) {
+        track->lacing[track->lacing_count++] = 255;
+        remaining -= 255;
+    }
+    track->lacing[track->lacing_count++] = (uint8_t)remaining;
+    memcpy(track->body + track->body_size, data, size);
+    track->body_size += size;
+}
+
+/* 开始新的逻辑流：OpusHead 和 OpusTags 各占一页 */
+static void linx_ogg_start_stream(linx_ogg_recorder_t* recorder, linx_ogg_recorder_direction_t direction,
+                                  int sample_rate, int channels) {
+    linx_ogg_track_t* track = &recorder->tracks[direction];
+
+    recorder->chains++;
+    track->serial = (uint32_t)linx_ogg_now_ms() ^ (recorder->chains * 0x9E3779B9u) ^ ((uint32_t)direction << 16);
+    track->page_sequence = 0;
+    track->granule = 0;
+    track->page_granule = 0;
+    track->sample_rate = sample_rate;
+    track->channels = channels;
+    track->started = true;
+
+    /* 从连接中途开始录制，编码器前导样本已不在流中，pre-skip 记为 0 */
+    uint8_t head[LINX_OGG_OPUS_HEAD_SIZE] = { 'O', 'p', 'u', 's', 'H', 'e', 'a', 'd' };
+    head[8] = 1;
+    head[9] = (uint8_t)channels;
+    linx_ogg_put_le32(head + 12, (uint32_t)sample_rate);
+    linx_ogg_append_packet(track, head, sizeof(head));
+    linx_ogg_emit_page(recorder, track, LINX_OGG_FLAG_BOS);
+
+    char comment[32];
+    int comment_len = snprintf(comment, sizeof(comment), "LINX_DIRECTION=%s", s_direction_names[direction]);
+    uint8_t tags[8 + 4 + sizeof(LINX_OGG_VENDOR) - 1 + 4 + 4 + sizeof(comment)];
+    size_t tags_size = 0;
+    memcpy(tags, "OpusTags", 8);
+    tags_size += 8;
+    linx_ogg_put_le32(tags + tags_size, (uint32_t)(sizeof(LINX_OGG_VENDOR) - 1));
+    tags_size += 4;
+    memcpy(tags + tags_size, LINX_OGG_VENDOR, sizeof(LINX_OGG_VENDOR) - 1);
+    tags_size += sizeof(LINX_OGG_VENDOR) - 1;
+    linx_ogg_put_le32(tags + tags_size, 1);
+    tags_size += 4;
+    linx_ogg_put_le32(tags + tags_size, (uint32_t)comment_len);
+    tags_size += 4;
+    memcpy(tags + tags_size, comment, (size_t)comment_len);
+    tags_size += (size_t)comment_len;
+    linx_ogg_append_packet(track, tags, tags_size);
+    linx_ogg_emit_page(recorder, track, 0);
+}
+
+/* 结束当前逻辑流：剩余的包连同 EOS 标志封入最后一页 */
+static void linx_ogg_end_stream(linx_ogg_recorder_t* recorder, linx_ogg_track_t* track) {
+    if (!track->started) {
+        return;
+    }
+    linx_ogg_emit_page(recorder, track, LINX_OGG_FLAG_EOS);
+    track->started = false;
+}
+
+static bool linx_ogg_write_all(int fd, const uint8_t* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        size -= (size_t)written;
+    }
+    return true;
+}
+
+static void* linx_ogg_writer_thread(void* arg) {
+    linx_ogg_recorder_t* recorder = (linx_ogg_recorder_t*)arg;
+    size_t drain_size[LINX_OGG_RECORDER_DIRECTIONS];
+    uint64_t next_sync_ms = linx_ogg_now_ms() + (uint64_t)(recorder->sync_ms > 0 ? recorder->sync_ms : 0);
+    bool dirty = false;
+
+    pthread_mutex_lock(&recorder->mutex);
+    for (;;) {
+        if (!recorder->stopping && !recorder->flush_requested) {
+            struct timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_nsec += (long)LINX_OGG_RECORDER_FLUSH_MS * 1000000L;
+            deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+            deadline.tv_nsec %= 1000000000L;
+            pthread_cond_timedwait(&recorder->cond, &recorder->mutex, &deadline);
+        }
+        bool stopping = recorder->stopping;
+        recorder->flush_requested = false;
+
+        /* 交换双缓冲，写文件时不持锁，调用方继续往另一块追加 */
+        for (int d = 0; d < LINX_OGG_RECORDER_DIRECTIONS; d++) {
+            linx_ogg_track_t* track = &recorder->tracks[d];
+            uint8_t* drain = track->drain;
+            track->drain = track->fill;
+            track->fill = drain;
+            drain_size[d] = track->fill_size;
+            track->fill_size = 0;
+        }
+        pthread_mutex_unlock(&recorder->mutex);
+
+        uint64_t written = 0;
+        bool failed[LINX_OGG_RECORDER_DIRECTIONS] = { false };
+        for (int d = 0; d < LINX_OGG_RECORDER_DIRECTIONS; d++) {
+            linx_ogg_track_t* track = &recorder->tracks[d];
+            if (track->fd < 0 || drain_size[d] == 0) {
+                continue;
+            }
+            if (linx_ogg_write_all(track->fd, track->drain, drain_size[d])) {
+                written += drain_size[d];
+                dirty = true;
+            } else {
+                LOG_ERROR("Ogg recorder: %s write failed (%s), recording stopped",
+                          s_direction_names[d], strerror(errno));
+                failed[d] = true;
+            }
+        }
+
+        uint64_t syncs = 0;
+        uint64_t now_ms = linx_ogg_now_ms();
+        if (dirty && recorder->sync_ms >= 0 && (stopping || now_ms >= next_sync_ms)) {
+            for (int d = 0; d < LINX_OGG_RECORDER_DIRECTIONS; d++) {
+                /* /dev/null 等不支持 fsync 的文件返回 EINVAL，忽略 */
+                if (recorder->tracks[d].fd >= 0 && fsync(recorder->tracks[d].fd) == 0) {
+                    syncs++;
+                }
+            }
+            dirty = false;
+            next_sync_ms = now_ms + (uint64_t)recorder->sync_ms;
+        }
+
+        pthread_mutex_lock(&recorder->mutex);
+        recorder->stats.bytes_written += written;
+        recorder->stats.syncs += syncs;
+        for (int d = 0; d < LINX_OGG_RECORDER_DIRECTIONS; d++) {
+            if (failed[d]) {
+                recorder->tracks[d].failed = true;
+            }
+        }
+        if (stopping) {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&recorder->mutex);
+    return NULL;
+}
+
+static void linx_ogg_recorder_free(linx_ogg_recorder_t* recorder) {
+    for (int d = 0; d < LINX_OGG_RECORDER_DIRECTIONS; d++) {
+        linx_ogg_track_t* track = &recorder->tracks[d];
+        if (track->fd >= 0) {
+            close(track->fd);
+        }
+        LINX_FREE(track->body);
+        LINX_FREE(track->fill);
+        LINX_FREE(track->drain);
+    }
+    pthread_cond_destroy(&recorder->cond);
+    pthread_mutex_destroy(&recorder->mutex);
+    LINX_FREE(recorder);
+}
+
+linx_ogg_recorder_t* linx_ogg_recorder_create(const char* uplink_path, const char* downlink_path,
+                                              size_t buffer_size, int sync_ms) {
+    if (!uplink_path && !downlink_path) {
+        return NULL;
+    }
+    pthread_once(&s_crc_once, linx_ogg_crc_init);
+
+    linx_ogg_recorder_t* recorder = LINX_CALLOC(1, sizeof(linx_ogg_recorder_t));
+    if (!recorder) {
+        return NULL;
+    }
+    /* 缓冲区至少放得下一个最大的页 */
+    recorder->buffer_size = buffer_size > 0 ? buffer_size : LINX_OGG_RECORDER_BUFFER_SIZE;
+    if (recorder->buffer_size < LINX_OGG_MAX_PAGE) {
+        recorder->buffer_size = LINX_OGG_MAX_PAGE;
+    }
+    recorder->sync_ms = sync_ms != 0 ? sync_ms : LINX_OGG_RECORDER_SYNC_MS;
+    pthread_mutex_init(&recorder->mutex, NULL);
+    pthread_cond_init(&recorder->cond, NULL);
+
+    const char* paths[LINX_OGG_RECORDER_DIRECTIONS] = { uplink_path, downlink_path };
+    for (int d = 0; d < LINX_OGG_RECORDER_DIRECTIONS; d++) {
+        linx_ogg_track_t* track = &recorder->tracks[d];
+        track->fd = -1;
+        if (!paths[d]) {
+            continue;
+        }
+        track->fd = open(paths[d], O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (track->fd < 0) {
+            LOG_ERROR("Ogg recorder: cannot create %s (%s)", paths[d], strerror(errno));
+            linx_ogg_recorder_free(recorder);
+            return NULL;
+        }
+        track->body = LINX_MALLOC(LINX_OGG_MAX_BODY);
+        track->fill = LINX_MALLOC(recorder->buffer_size);
+        track->drain = LINX_MALLOC(recorder->buffer_size);
+        if (!track->body || !track->fill || !track->drain) {
+            LOG_ERROR("Ogg recorder: out of memory for %zu byte buffers", recorder->buffer_size);
+            linx_ogg_recorder_free(recorder);
+            return NULL;
+        }
+    }
+
+    if (pthread_create(&recorder->thread, NULL, linx_ogg_writer_thread, recorder) != 0) {
+        LOG_ERROR("Ogg recorder: cannot start writer thread");
+        linx_ogg_recorder_free(recorder);
+        return NULL;
+    }
+
+    LOG_INFO("Ogg recorder started: uplink=%s downlink=%s", uplink_path ? uplink_path : "-",
+             downlink_path ? downlink_path : "-");
+    return recorder;
+}
+
+bool linx_ogg_recorder_write(linx_ogg_recorder_t* recorder, linx_ogg_recorder_direction_t direction,
+                             const uint8_t* data, size_t size, int sample_rate, int channels) {
+    if (!recorder || (int)direction < 0 || direction >= LINX_OGG_RECORDER_DIRECTIONS || !data || size == 0 ||
+        size > LINX_OGG_MAX_BODY || sample_rate <= 0 || (channels != 1 && channels != 2)) {
+        return false;
+    }
+    linx_ogg_track_t* track = &recorder->tracks[direction];
+    if (track->fd < 0) {
+        return false;
+    }
+
+    int samples = linx_ogg_opus_packet_samples(data, size);
+
+    pthread_mutex_lock(&recorder->mutex);
+    if (track->failed || recorder->stopping) {
+        pthread_mutex_unlock(&recorder->mutex);
+        return false;
+    }
+    if (samples == 0) {
+        recorder->stats.invalid_packets++;
+        pthread_mutex_unlock(&recorder->mutex);
+        return false;
+    }
+
+    if (track->started && (track->sample_rate != sample_rate || track->channels != channels)) {
+        linx_ogg_end_stream(recorder, track);
+    }
+    if (!track->started) {
+        linx_ogg_start_stream(recorder, direction, sample_rate, channels);
+    }
+
+    size_t segments = size / 255 + 1;
+    if (track->lacing_count + segments > LINX_OGG_MAX_SEGMENTS || track->body_size + size > LINX_OGG_MAX_BODY) {
+        linx_ogg_emit_page(recorder, track, 0);
+    }
+    linx_ogg_append_packet(track, data, size);
+    track->granule += (uint64_t)samples;
+    recorder->stats.packets++;
+
+    if (track->body_size >= LINX_OGG_PAGE_TARGET_BYTES ||
+        track->granule - track->page_granule >= LINX_OGG_PAGE_TARGET_SAMPLES) {
+        linx_ogg_emit_page(recorder, track, 0);
+    }
+    pthread_mutex_unlock(&recorder->mutex);
+    return true;
+}
+
+void linx_ogg_recorder_get_stats(linx_ogg_recorder_t* recorder, linx_ogg_recorder_stats_t* stats) {
+    if (!stats) {
+        return;
+    }
+    if (!recorder) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+    pthread_mutex_lock(&recorder->mutex);
+    *stats = recorder->stats;
+    pthread_mutex_unlock(&recorder->mutex);
+}
+
+void linx_ogg_recorder_destroy(linx_ogg_recorder_t* recorder) {
+    if (!recorder) {
+        return;
+    }
+
+    pthread_mutex_lock(&recorder->mutex);
+    for (int d = 0; d < LINX_OGG_RECORDER_DIRECTIONS; d++) {
+        if (!recorder->tracks[d].failed) {
+            linx_ogg_end_stream(recorder, &recorder->tracks[d]);
+        }
+    }
+    recorder->stopping = true;
+    pthread_cond_signal(&recorder->cond);
+    pthread_mutex_unlock(&recorder->mutex);
+    pthread_join(recorder->thread, NULL);
+
+    LOG_INFO("Ogg recorder closed: %llu packets, %llu pages (%llu dropped), %llu bytes written",
+             (unsigned long long)recorder->stats.packets, (unsigned long long)recorder->stats.pages,
+             (unsigned long long)recorder->stats.dropped_pages, (unsigned long long)recorder->stats.bytes_written);
+    linx_ogg_recorder_free(recorder);
+}
@@ -0,0 +1,97 @@
+#ifndef LINX_OGG_RECORDER_H
+#define LINX_OGG_RECORDER_H
+
+/*
+ * 会话音频录制（Ogg Opus）
+ *
+ * 把一次会话上下行的 Opus 包原样封装为两个 Ogg Opus 文件（RFC 7845），不重新编码，
+ * 可以直接用常见播放器或 ffmpeg 打开，用于质量评估和离线分析。与 linx_ws_capture.h
+ * 的逐帧录制不同，这里只保存音频，开销足够小，可以在试点部署中常开。
+ *
+ * - 调用方（WebSocket 的发送和接收路径）只在内存中组页并追加到有界写缓冲区，不做文件 I/O；
+ *   后台线程把缓冲区写入文件并定期 fsync。写线程跟不上时丢弃整页并计数，不阻塞音频路径，
+ *   读取端可由页序号的跳变发现丢失。
+ * - 粒度位置按 Opus 包 TOC 计算的样本数（48kHz）累加，不保留包之间的静音间隔。
+ * - 采样率或声道数变化时结束当前逻辑流并开始新的一段（Ogg 链式流）。
+ *
+ * 各函数可以在任意线程调用。
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 默认写缓冲区大小（字节，上下行各一份），足够缓存数秒的音频 */
+#define LINX_OGG_RECORDER_BUFFER_SIZE (128u * 1024u)
+
+/* 默认 fsync 间隔（毫秒） */
+#define LINX_OGG_RECORDER_SYNC_MS 2000
+
+/* 录制方向 */
+typedef enum {
+    LINX_OGG_RECORDER_UPLINK = 0,   // 发出的音频（麦克风）
+    LINX_OGG_RECORDER_DOWNLINK,     // 收到的音频（TTS）
+    LINX_OGG_RECORDER_DIRECTIONS
+} linx_ogg_recorder_direction_t;
+
+/* 录制统计（两个方向合计） */
+typedef struct {
+    uint64_t packets;               // 已录制的 Opus 包数
+    uint64_t invalid_packets;       // TOC 无法解析而跳过的包数
+    uint64_t pages;                 // 已生成的 Ogg 页数
+    uint64_t dropped_pages;         // 写缓冲区已满而丢弃的页数
+    uint64_t bytes_written;         // 已写入文件的字节数
+    uint64_t syncs;                 // fsync 次数
+} linx_ogg_recorder_stats_t;
+
+/* 录制器 - 前向声明 */
+typedef struct linx_ogg_recorder linx_ogg_recorder_t;
+
+/**
+ * 创建录制器并启动后台写线程（文件已存在时覆盖）
+ * @param uplink_path 上行录制文件路径，NULL 表示不录制上行
+ * @param downlink_path 下行录制文件路径，NULL 表示不录制下行
+ * @param buffer_size 每个方向的写缓冲区大小（字节），0 为 LINX_OGG_RECORDER_BUFFER_SIZE
+ * @param sync_ms fsync 间隔（毫秒），0 为 LINX_OGG_RECORDER_SYNC_MS，<0 不主动 fsync
+ * @return 录制器；两个路径都为 NULL 或文件无法创建时返回 NULL
+ */
+linx_ogg_recorder_t* linx_ogg_recorder_create(const char* uplink_path, const char* downlink_path,
+                                              size_t buffer_size, int sync_ms);
+
+/**
+ * 录制一个 Opus 包
+ * @param recorder 录制器，NULL 时无操作
+ * @param direction 方向；未配置该方向的文件时忽略
+ * @param data Opus 包（不含协议头）
+ * @param size 包长度，0 时忽略
+ * @param sample_rate 编码时的输入采样率（写入 OpusHead，仅作元数据）
+ * @param channels 声道数，只支持 1 和 2
+ * @return 已组入页返回 true；包无法解析、参数无效或该方向写入失败返回 false
+ */
+bool linx_ogg_recorder_write(linx_ogg_recorder_t* recorder, linx_ogg_recorder_direction_t direction,
+                             const uint8_t* data, size_t size, int sample_rate, int channels);
+
+/**
+ * 获取录制统计
+ */
+void linx_ogg_recorder_get_stats(linx_ogg_recorder_t* recorder, linx_ogg_recorder_stats_t* stats);
+
+/**
+ * 结束各逻辑流（写出 EOS 页），等待后台线程写完并 fsync 后关闭文件；recorder 为 NULL 时无操作
+ */
+void linx_ogg_recorder_destroy(linx_ogg_recorder_t* recorder);
+
+/**
+ * Opus 包解码后的样本数（按 48kHz 计，RFC 6716 第 3.1 节），包无效时返回 0
+ */
+int linx_ogg_opus_packet_samples(const uint8_t* data, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINX_OGG_RECORDER_H */
@@ -1,12 +1,29 @@
 #include "linx_protocol.h"
+#include "linx_binary_frame.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <time.h>
+#include <pthread.h>
+#include <arpa/inet.h>
 #include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_PROTOCOL);
 
 #define LINX_TIMEOUT_MS 120000  /* 120秒超时 */
 
+/* 音频数据包内存池 */
+struct linx_audio_packet_pool {
+    pthread_mutex_t mutex;
+    uint8_t* slab;                          // 连续分配的槽位内存
+    size_t slot_stride;                     // 单个槽位占用字节数（含数据包头）
+    size_t* free_list;                      // 空闲槽位索引栈
+    size_t free_count;                      // 空闲槽位数量
+    bool destroyed;                         // 已调用销毁，等借出的数据包全部归还后释放
+    linx_audio_packet_pool_stats_t stats;   // 统计信息
+};
+
 /* 获取当前时间戳（毫秒） */
 static uint64_t get_current_time_ms(void) {
     struct timespec ts;
@@ -30,10 +47,26 @@ void linx_protocol_init(linx_protocol_t* protocol,
     protocol->error_occurred = false;
     protocol->session_id = NULL;
     protocol->last_incoming_time = get_current_time_ms();
+    linx_json_writer_init(&protocol->writer);
+    pthread_mutex_init(&protocol->writer_mutex, NULL);
     
     LOG_INFO("Protocol initialized successfully ");
 }
 
+void linx_protocol_deinit(linx_protocol_t* protocol) {
+    if (!protocol) {
+        return;
+    }
+    
+    if (protocol->session_id) {
+        LINX_FREE(protocol->session_id);
+        protocol->session_id = NULL;
+    }
+    
+    linx_json_writer_free(&protocol->writer);
+    pthread_mutex_destroy(&protocol->writer_mutex);
+}
+
 void linx_protocol_destroy(linx_protocol_t* protocol) {
     if (!protocol) {
         LOG_WARN("Attempting to destroy NULL protocol");
@@ -98,8 +131,8 @@ bool linx_protocol_send_audio(linx_protocol_t* protocol, linx_audio_stream_packe
         return false;
     }
     
-    LOG_DEBUG("Sending audio packet - size: %zu, sample_rate: %d, timestamp: %u", 
-              packet->payload_size, packet->sample_rate, packet->timestamp);
+    LOG_DEBUG_EVERY_N(50, "Sending audio packet - size: %zu, sample_rate: %d, timestamp: %u",
+                      packet->payload_size, packet->sample_rate, packet->timestamp);
     
     bool result = protocol->vtable->send_audio(protocol, packet);
     if (!result) {
@@ -109,18 +142,72 @@ bool linx_protocol_send_audio(linx_protocol_t* protocol, linx_audio_stream_packe
     return result;
 }
 
+bool linx_protocol_send_text(linx_protocol_t* protocol, const char* text) {
+    if (!protocol || !protocol->vtable || !protocol->vtable->send_text || !text) {
+        LOG_ERROR("Invalid protocol or missing send_text function: protocol=%p", protocol);
+        return false;
+    }
+    
+    return protocol->vtable->send_text(protocol, text);
+}
+
 /* 高级消息发送函数 */
+
+/* 加锁并开始构建一条带 session_id/type 的上行消息 */
+static linx_json_writer_t* linx_protocol_begin_message(linx_protocol_t* protocol, const char* type) {
+    pthread_mutex_lock(&protocol->writer_mutex);
+    
+    linx_json_writer_t* writer = &protocol->writer;
+    linx_json_writer_reset(writer);
+    linx_json_writer_begin_object(writer);
+    linx_json_writer_add_string(writer, "session_id", protocol->session_id ? protocol->session_id : "");
+    linx_json_writer_add_string(writer, "type", type);
+    return writer;
+}
+
+/* 结束消息、发送并解锁 */
+static void linx_protocol_finish_message(linx_protocol_t* protocol) {
+    linx_json_writer_t* writer = &protocol->writer;
+    linx_json_writer_end_object(writer);
+    
+    const char* message = linx_json_writer_finish(writer);
+    if (message) {
+        protocol->vtable->send_text(protocol, message);
+    } else {
+        LOG_ERROR("Failed to build outbound message");
+    }
+    
+    pthread_mutex_unlock(&protocol->writer_mutex);
+}
+
+/* 发送一条控制消息：协议协商了二进制编码时发 CBOR，否则按相同字段发 JSON
+ * （字段都由 linx_control_message_set() 设置，以 '\0' 结尾） */
+static void linx_protocol_send_control(linx_protocol_t* protocol, linx_control_message_t* message) {
+    linx_control_message_set(message, LINX_CONTROL_FIELD_SESSION_ID, protocol->session_id ? protocol->session_id : "");
+    if (protocol->vtable->send_control && protocol->vtable->send_control(protocol, message)) {
+        return;
+    }
+    
+    linx_json_writer_t* writer = linx_protocol_begin_message(protocol, linx_control_type_name(message->type));
+    for (int f = LINX_CONTROL_FIELD_SESSION_ID + 1; f < LINX_CONTROL_FIELD_COUNT; f++) {
+        if (message->fields[f].data) {
+            linx_json_writer_add_string(writer, linx_control_field_name((linx_control_field_t)f),
+                                        message->fields[f].data);
+        }
+    }
+    linx_protocol_finish_message(protocol);
+}
+
 void linx_protocol_send_wake_word_detected(linx_protocol_t* protocol, const char* wake_word) {
     if (!protocol || !protocol->vtable || !protocol->vtable->send_text || !wake_word) {
         return;
     }
     
-    char message[512];
-    snprintf(message, sizeof(message), 
-             "{\"session_id\":\"%s\",\"type\":\"listen\",\"state\":\"detect\",\"text\":\"%s\"}", 
-             protocol->session_id ? protocol->session_id : "", wake_word);
-    
-    protocol->vtable->send_text(protocol, message);
+    linx_control_message_t message;
+    linx_control_message_init(&message, LINX_CONTROL_TYPE_LISTEN);
+    linx_control_message_set(&message, LINX_CONTROL_FIELD_STATE, "detect");
+    linx_control_message_set(&message, LINX_CONTROL_FIELD_TEXT, wake_word);
+    linx_protocol_send_control(protocol, &message);
 }
 
 void linx_protocol_send_start_listening(linx_protocol_t* protocol, linx_listening_mode_t mode) {
@@ -144,12 +231,11 @@ void linx_protocol_send_start_listening(linx_protocol_t* protocol, linx_listenin
             break;
     }
     
-    char message[256];
-    snprintf(message, sizeof(message), 
-             "{\"session_id\":\"%s\",\"type\":\"listen\",\"state\":\"start\",\"mode\":\"%s\"}", 
-             protocol->session_id ? protocol->session_id : "", mode_str);
-    
-    protocol->vtable->send_text(protocol, message);
+    linx_control_message_t message;
+    linx_control_message_init(&message, LINX_CONTROL_TYPE_LISTEN);
+    linx_control_message_set(&message, LINX_CONTROL_FIELD_STATE, "start");
+    linx_control_message_set(&message, LINX_CONTROL_FIELD_MODE, mode_str);
+    linx_protocol_send_control(protocol, &message);
 }
 
 void linx_protocol_send_stop_listening(linx_protocol_t* protocol) {
@@ -157,12 +243,10 @@ void linx_protocol_send_stop_listening(linx_protocol_t* protocol) {
         return;
     }
     
-    char message[256];
-    snprintf(message, sizeof(message), 
-             "{\"session_id\":\"%s\",\"type\":\"listen\",\"state\":\"stop\"}", 
-             protocol->session_id ? protocol->session_id : "");
-    
-    protocol->vtable->send_text(protocol, message);
+    linx_control_message_t message;
+    linx_control_message_init(&message, LINX_CONTROL_TYPE_LISTEN);
+    linx_control_message_set(&message, LINX_CONTROL_FIELD_STATE, "stop");
+    linx_protocol_send_control(protocol, &message);
 }
 
 void linx_protocol_send_abort_speaking(linx_protocol_t* protocol, linx_abort_reason_t reason) {
@@ -170,18 +254,12 @@ void linx_protocol_send_abort_speaking(linx_protocol_t* protocol, linx_abort_rea
         return;
     }
     
-    char message[256];
+    linx_control_message_t message;
+    linx_control_message_init(&message, LINX_CONTROL_TYPE_ABORT);
     if (reason == LINX_ABORT_REASON_WAKE_WORD_DETECTED) {
-        snprintf(message, sizeof(message), 
-                 "{\"session_id\":\"%s\",\"type\":\"abort\",\"reason\":\"wake_word_detected\"}", 
-                 protocol->session_id ? protocol->session_id : "");
-    } else {
-        snprintf(message, sizeof(message), 
-                 "{\"session_id\":\"%s\",\"type\":\"abort\"}", 
-                 protocol->session_id ? protocol->session_id : "");
+        linx_control_message_set(&message, LINX_CONTROL_FIELD_REASON, "wake_word_detected");
     }
-    
-    protocol->vtable->send_text(protocol, message);
+    linx_protocol_send_control(protocol, &message);
 }
 
 void linx_protocol_send_mcp_message(linx_protocol_t* protocol, const char* message) {
@@ -189,12 +267,35 @@ void linx_protocol_send_mcp_message(linx_protocol_t* protocol, const char* messa
         return;
     }
     
-    char mcp_message[1024];
-    snprintf(mcp_message, sizeof(mcp_message), 
-             "{\"session_id\":\"%s\",\"type\":\"mcp\",\"payload\":\"%s\"}", 
-             protocol->session_id ? protocol->session_id : "", message);
+    /* MCP 载荷本身就是 JSON-RPC 对象，原样嵌入，不再当作字符串 */
+    linx_json_writer_t* writer = linx_protocol_begin_message(protocol, "mcp");
+    linx_json_writer_add_raw(writer, "payload", message, strlen(message));
+    linx_protocol_finish_message(protocol);
+}
+
+void linx_protocol_send_tts_skip(linx_protocol_t* protocol, const char* text, uint32_t duration_ms) {
+    if (!protocol || !protocol->vtable || !protocol->vtable->send_text || !text) {
+        return;
+    }
     
-    protocol->vtable->send_text(protocol, mcp_message);
+    /* duration_ms 不在 CBOR 控制消息的字段表中，始终发 JSON */
+    linx_json_writer_t* writer = linx_protocol_begin_message(protocol, "tts");
+    linx_json_writer_add_string(writer, "state", "skip");
+    linx_json_writer_add_string(writer, "text", text);
+    linx_json_writer_add_int(writer, "duration_ms", duration_ms);
+    linx_protocol_finish_message(protocol);
+}
+
+void linx_protocol_send_playback_position(linx_protocol_t* protocol, uint32_t timestamp, uint32_t output_delay_ms) {
+    if (!protocol || !protocol->vtable || !protocol->vtable->send_text) {
+        return;
+    }
+    
+    linx_json_writer_t* writer = linx_protocol_begin_message(protocol, "tts");
+    linx_json_writer_add_string(writer, "state", "position");
+    linx_json_writer_add_int(writer, "timestamp", timestamp);
+    linx_json_writer_add_int(writer, "output_delay_ms", output_delay_ms);
+    linx_protocol_finish_message(protocol);
 }
 
 /* 工具函数 */
@@ -212,6 +313,12 @@ void linx_protocol_set_error(linx_protocol_t* protocol, const char* message) {
     }
 }
 
+void linx_protocol_mark_incoming(linx_protocol_t* protocol) {
+    if (protocol) {
+        protocol->last_incoming_time = get_current_time_ms();
+    }
+}
+
 bool linx_protocol_is_timeout(const linx_protocol_t* protocol) {
     if (!protocol) {
         LOG_WARN("Checking timeout on NULL protocol");
@@ -232,7 +339,7 @@ bool linx_protocol_is_timeout(const linx_protocol_t* protocol) {
 
 /* 音频数据包管理 */
 linx_audio_stream_packet_t* linx_audio_stream_packet_create(size_t payload_size) {
-    linx_audio_stream_packet_t* packet = malloc(sizeof(linx_audio_stream_packet_t));
+    linx_audio_stream_packet_t* packet = LINX_MALLOC(sizeof(linx_audio_stream_packet_t));
     if (!packet) {
         return NULL;
     }
@@ -241,25 +348,243 @@ linx_audio_stream_packet_t* linx_audio_stream_packet_create(size_t payload_size)
     
     // 如果需要载荷，分配内存
     if (payload_size > 0) {
-        packet->payload = malloc(payload_size);
+        packet->payload = LINX_MALLOC(payload_size);
         if (!packet->payload) {
-            free(packet);
+            LINX_FREE(packet);
             return NULL;
         }
         packet->payload_size = payload_size;
     }
+    packet->owned = true;
     
     return packet;
 }
 
+static void linx_audio_packet_pool_release(linx_audio_packet_pool_t* pool, linx_audio_stream_packet_t* packet);
+
 void linx_audio_stream_packet_destroy(linx_audio_stream_packet_t* packet) {
     if (!packet) {
         return;
     }
     
-    // 释放载荷内存
-    if (packet->payload) {
-        free(packet->payload);
+    // 归还到所属内存池
+    if (packet->pool) {
+        linx_audio_packet_pool_release(packet->pool, packet);
+        return;
+    }
+    
+    // 释放载荷内存（视图不持有载荷）
+    if (packet->owned && packet->payload) {
+        LINX_FREE(packet->payload);
     }
-    free(packet);
+    LINX_FREE(packet);
+}
+
+void linx_audio_stream_packet_init_view(linx_audio_stream_packet_t* packet,
+                                        const uint8_t* payload, size_t payload_size) {
+    if (!packet) {
+        return;
+    }
+    
+    memset(packet, 0, sizeof(linx_audio_stream_packet_t));
+    packet->payload = (uint8_t*)payload;
+    packet->payload_size = payload_size;
+    packet->owned = false;
+}
+
+linx_audio_stream_packet_t* linx_audio_stream_packet_retain(const linx_audio_stream_packet_t* packet) {
+    return linx_audio_packet_pool_retain(NULL, packet);
+}
+
+int linx_binary_protocol_encode_header(int version, uint32_t timestamp, uint16_t sequence,
+                                       size_t payload_size, uint8_t* header) {
+    return linx_binary_frame_encode(version, LINX_BINARY_TYPE_AUDIO, timestamp, sequence, payload_size, header);
+}
+
+int linx_binary_protocol_encode_control_header(int version, size_t payload_size, uint8_t* header) {
+    return linx_binary_frame_encode(version, LINX_BINARY_TYPE_CONTROL, 0, 0, payload_size, header);
+}
+
+linx_binary_frame_result_t linx_binary_protocol_decode(int version, const uint8_t* data, size_t size,
+                                                       const uint8_t** payload, size_t* payload_size,
+                                                       uint32_t* timestamp, uint16_t* sequence) {
+    return linx_binary_frame_decode(version, data, size, payload, payload_size, timestamp, sequence);
+}
+
+bool linx_binary_protocol_has_timestamp(int version) {
+    return version == 2 || version == 4;
+}
+
+bool linx_binary_protocol_set_stream(int version, uint8_t* header, uint8_t stream_id) {
+    return linx_binary_frame_set_stream(version, header, stream_id);
+}
+
+uint8_t linx_binary_protocol_get_stream(int version, const uint8_t* data, size_t size) {
+    return linx_binary_frame_get_stream(version, data, size);
+}
+
+size_t linx_audio_packet_pool_payload_size(int frame_duration_ms) {
+    if (frame_duration_ms <= 0) {
+        frame_duration_ms = 20;
+    }
+    
+    // Opus 每 20ms 帧最多 1275 字节，更长的包按帧数累加
+    size_t frames = (size_t)((frame_duration_ms + 19) / 20);
+    return frames * LINX_OPUS_MAX_FRAME_BYTES;
+}
+
+linx_audio_packet_pool_t* linx_audio_packet_pool_create(size_t slot_count, size_t slot_payload) {
+    if (slot_count == 0 || slot_payload == 0) {
+        LOG_ERROR("Invalid packet pool parameters: slot_count=%zu, slot_payload=%zu", slot_count, slot_payload);
+        return NULL;
+    }
+    
+    linx_audio_packet_pool_t* pool = LINX_CALLOC(1, sizeof(linx_audio_packet_pool_t));
+    if (!pool) {
+        LOG_ERROR("Failed to allocate packet pool");
+        return NULL;
+    }
+    
+    // 槽位头部按指针大小对齐，载荷紧跟在数据包结构之后
+    size_t header = (sizeof(linx_audio_stream_packet_t) + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+    pool->slot_stride = (header + slot_payload + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+    pool->slab = LINX_MALLOC(pool->slot_stride * slot_count);
+    pool->free_list = LINX_MALLOC(sizeof(size_t) * slot_count);
+    if (!pool->slab || !pool->free_list) {
+        LOG_ERROR("Failed to allocate packet pool slab: %zu slots x %zu bytes", slot_count, pool->slot_stride);
+        LINX_FREE(pool->slab);
+        LINX_FREE(pool->free_list);
+        LINX_FREE(pool);
+        return NULL;
+    }
+    
+    for (size_t i = 0; i < slot_count; i++) {
+        linx_audio_stream_packet_t* packet = (linx_audio_stream_packet_t*)(pool->slab + i * pool->slot_stride);
+        memset(packet, 0, sizeof(linx_audio_stream_packet_t));
+        packet->payload = (uint8_t*)packet + header;
+        packet->pool = pool;
+        pool->free_list[i] = slot_count - 1 - i;
+    }
+    pool->free_count = slot_count;
+    pool->stats.slot_count = slot_count;
+    pool->stats.slot_payload = slot_payload;
+    
+    pthread_mutex_init(&pool->mutex, NULL);
+    
+    LOG_INFO("Audio packet pool created: %zu slots, %zu bytes payload per slot", slot_count, slot_payload);
+    return pool;
+}
+
+static void linx_audio_packet_pool_free(linx_audio_packet_pool_t* pool) {
+    LOG_DEBUG("Audio packet pool stats - hits: %llu, misses: %llu, peak: %zu",
+              (unsigned long long)pool->stats.hits, (unsigned long long)pool->stats.misses,
+              pool->stats.peak_in_use);
+    
+    pthread_mutex_destroy(&pool->mutex);
+    LINX_FREE(pool->free_list);
+    LINX_FREE(pool->slab);
+    LINX_FREE(pool);
+}
+
+void linx_audio_packet_pool_destroy(linx_audio_packet_pool_t* pool) {
+    if (!pool) {
+        return;
+    }
+    
+    pthread_mutex_lock(&pool->mutex);
+    pool->destroyed = true;
+    size_t in_use = pool->stats.in_use;
+    pthread_mutex_unlock(&pool->mutex);
+    
+    if (in_use > 0) {
+        // 槽位仍借给别人（如应用保留的音频事件），最后一个数据包归还时再释放
+        LOG_DEBUG("Packet pool destroy deferred: %zu packets still in use", in_use);
+        return;
+    }
+    linx_audio_packet_pool_free(pool);
+}
+
+linx_audio_stream_packet_t* linx_audio_packet_pool_acquire(linx_audio_packet_pool_t* pool, size_t payload_size) {
+    if (!pool) {
+        return linx_audio_stream_packet_create(payload_size);
+    }
+    
+    linx_audio_stream_packet_t* packet = NULL;
+    
+    pthread_mutex_lock(&pool->mutex);
+    if (payload_size <= pool->stats.slot_payload && pool->free_count > 0) {
+        size_t index = pool->free_list[--pool->free_count];
+        packet = (linx_audio_stream_packet_t*)(pool->slab + index * pool->slot_stride);
+        pool->stats.hits++;
+        pool->stats.in_use++;
+        if (pool->stats.in_use > pool->stats.peak_in_use) {
+            pool->stats.peak_in_use = pool->stats.in_use;
+        }
+    } else {
+        pool->stats.misses++;
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    
+    if (!packet) {
+        // 池耗尽或载荷过大，回退到堆分配
+        return linx_audio_stream_packet_create(payload_size);
+    }
+    
+    packet->sample_rate = 0;
+    packet->frame_duration = 0;
+    packet->timestamp = 0;
+    packet->sequence = 0;
+    packet->has_sequence = false;
+    packet->payload_size = payload_size;
+    packet->owned = true;
+    return packet;
+}
+
+static void linx_audio_packet_pool_release(linx_audio_packet_pool_t* pool, linx_audio_stream_packet_t* packet) {
+    size_t index = (size_t)((uint8_t*)packet - pool->slab) / pool->slot_stride;
+    
+    pthread_mutex_lock(&pool->mutex);
+    pool->free_list[pool->free_count++] = index;
+    pool->stats.in_use--;
+    bool last = pool->destroyed && pool->stats.in_use == 0;
+    pthread_mutex_unlock(&pool->mutex);
+    
+    if (last) {
+        linx_audio_packet_pool_free(pool);
+    }
+}
+
+bool linx_audio_packet_pool_get_stats(linx_audio_packet_pool_t* pool, linx_audio_packet_pool_stats_t* stats) {
+    if (!pool || !stats) {
+        return false;
+    }
+    
+    pthread_mutex_lock(&pool->mutex);
+    *stats = pool->stats;
+    pthread_mutex_unlock(&pool->mutex);
+    return true;
+}
+
+linx_audio_stream_packet_t* linx_audio_packet_pool_retain(linx_audio_packet_pool_t* pool,
+                                                          const linx_audio_stream_packet_t* packet) {
+    if (!packet) {
+        return NULL;
+    }
+    
+    linx_audio_stream_packet_t* copy = linx_audio_packet_pool_acquire(pool, packet->payload_size);
+    if (!copy) {
+        LOG_ERROR("Failed to retain audio packet: memory allocation failed");
+        return NULL;
+    }
+    
+    copy->sample_rate = packet->sample_rate;
+    copy->frame_duration = packet->frame_duration;
+    copy->timestamp = packet->timestamp;
+    copy->sequence = packet->sequence;
+    copy->has_sequence = packet->has_sequence;
+    if (packet->payload_size > 0 && packet->payload) {
+        memcpy(copy->payload, packet->payload, packet->payload_size);
+    }
+    
+    return copy;
 }
\ No newline at end of file
@@ -4,27 +4,58 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <pthread.h>
 #include "../cjson/cJSON.h"
+#include "../cjson/linx_json_writer.h"
+#include "linx_control_cbor.h"
 #include "../log/linx_log.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-/* 音频流数据包结构 */
+/* 前向声明：音频数据包内存池 */
+typedef struct linx_audio_packet_pool linx_audio_packet_pool_t;
+
+/* 音频流数据包结构
+ *
+ * 接收路径上传给 on_incoming_audio 的数据包是一个"视图"：payload 直接指向
+ * 网络层的接收缓冲区，仅在回调执行期间有效（owned 为 false）。
+ * 需要在回调返回后继续使用数据时，调用 linx_audio_stream_packet_retain()
+ * 获取一份独立副本，并在使用完后用 linx_audio_stream_packet_destroy() 释放。
+ */
 typedef struct {
     int sample_rate;        // 采样率
     int frame_duration;     // 帧持续时间
     uint32_t timestamp;     // 时间戳
+    uint16_t sequence;      // 帧序号，仅 has_sequence 为 true 时有效
+    bool has_sequence;      // 帧头是否携带序号（协议 v4）
     uint8_t* payload;       // 音频数据载荷
     size_t payload_size;    // 载荷大小
+    bool owned;             // 载荷是否由数据包自身持有（视图为 false）
+    linx_audio_packet_pool_t* pool; // 所属内存池（NULL 表示堆分配）
 } linx_audio_stream_packet_t;
 
+/* Opus 单帧（20ms）最大字节数，见 RFC 6716 */
+#define LINX_OPUS_MAX_FRAME_BYTES   1275
+/* 默认内存池槽位数量 */
+#define LINX_AUDIO_PACKET_POOL_DEFAULT_SLOTS 16
+
+/* 音频数据包内存池统计信息 */
+typedef struct {
+    size_t slot_count;      // 槽位总数
+    size_t slot_payload;    // 单个槽位可容纳的最大载荷（字节）
+    size_t in_use;          // 当前已借出的槽位数
+    size_t peak_in_use;     // 借出槽位峰值
+    uint64_t hits;          // 从池中分配成功次数
+    uint64_t misses;        // 池耗尽或载荷过大而回退到堆分配的次数
+} linx_audio_packet_pool_stats_t;
+
 /* 二进制协议 v2 结构 */
 typedef struct __attribute__((packed)) {
     uint16_t version;       // 协议版本
-    uint16_t type;          // 消息类型 (0: OPUS, 1: JSON)
-    uint32_t reserved;      // 保留字段，供将来使用
+    uint16_t type;          // 消息类型，见 LINX_BINARY_TYPE_*
+    uint32_t reserved;      // 保留字段；多路复用时低字节为流ID
     uint32_t timestamp;     // 时间戳（毫秒），用于服务端回声消除
     uint32_t payload_size;  // 载荷大小（字节）
     uint8_t payload[];      // 载荷数据
@@ -33,11 +64,39 @@ typedef struct __attribute__((packed)) {
 /* 二进制协议 v3 结构 */
 typedef struct __attribute__((packed)) {
     uint8_t type;           // 消息类型
-    uint8_t reserved;       // 保留字段
+    uint8_t reserved;       // 保留字段；多路复用时为流ID
     uint16_t payload_size;  // 载荷大小
     uint8_t payload[];      // 载荷数据
 } linx_binary_protocol3_t;
 
+/* 二进制协议 v4 结构：v3 帧头后追加序号和媒体时间戳，供接收端检测丢包、重排和自适应播放 */
+typedef struct __attribute__((packed)) {
+    uint8_t type;           // 消息类型
+    uint8_t reserved;       // 保留字段；多路复用时为流ID
+    uint16_t payload_size;  // 载荷大小
+    uint16_t sequence;      // 帧序号，每个音频帧加 1，65535 后回绕到 0
+    uint32_t timestamp;     // 媒体时间戳（毫秒），32 位回绕
+    uint8_t payload[];      // 载荷数据
+} linx_binary_protocol4_t;
+
+/* 二进制帧的消息类型（v2 的 type 字段，v3/v4 的 type 字节） */
+#define LINX_BINARY_TYPE_AUDIO   0  // 音频帧
+#define LINX_BINARY_TYPE_CONTROL 1  // CBOR 编码的控制消息（见 linx_control_cbor.h），协商后使用
+
+/* 当前支持的最高二进制协议版本 */
+#define LINX_BINARY_PROTOCOL_MAX_VERSION 4
+
+/* 二进制音频帧头最大字节数（v2） */
+#define LINX_BINARY_HEADER_MAX_BYTES sizeof(linx_binary_protocol2_t)
+
+/* 二进制帧解析结果 */
+typedef enum {
+    LINX_BINARY_FRAME_AUDIO,        // 音频帧，载荷指向帧内数据
+    LINX_BINARY_FRAME_CONTROL,      // CBOR 控制消息，载荷指向帧内数据
+    LINX_BINARY_FRAME_IGNORED,      // 帧过短、未知类型或空载荷
+    LINX_BINARY_FRAME_TRUNCATED     // 帧头声明的载荷超出帧长度
+} linx_binary_frame_result_t;
+
 /* 中止原因枚举 */
 typedef enum {
     LINX_ABORT_REASON_NONE,                 // 无特定原因
@@ -57,6 +116,9 @@ typedef struct linx_protocol linx_protocol_t;
 /* 回调函数类型定义 */
 typedef void (*linx_on_incoming_audio_cb_t)(linx_audio_stream_packet_t* packet, void* user_data);
 typedef void (*linx_on_incoming_json_cb_t)(const cJSON* root, void* user_data);
+typedef void (*linx_on_incoming_message_cb_t)(const cJSON* root, const char* type, void* user_data);
+typedef bool (*linx_on_incoming_text_cb_t)(const char* type, const char* json, size_t length, void* user_data);
+typedef bool (*linx_on_incoming_control_cb_t)(const linx_control_message_t* message, void* user_data);
 typedef void (*linx_on_network_error_cb_t)(const char* message, void* user_data);
 typedef void (*linx_on_connected_cb_t)(void* user_data);
 typedef void (*linx_on_disconnected_cb_t)(void* user_data);
@@ -65,6 +127,9 @@ typedef void (*linx_on_disconnected_cb_t)(void* user_data);
 typedef struct {
     linx_on_incoming_audio_cb_t on_incoming_audio;      // 接收音频回调
     linx_on_incoming_json_cb_t on_incoming_json;        // 接收JSON回调
+    linx_on_incoming_message_cb_t on_incoming_message;  // 接收JSON回调（附带已解析的消息类型，优先于 on_incoming_json）
+    linx_on_incoming_text_cb_t on_incoming_text;        // 原始文本快速处理回调，返回 true 表示已处理、跳过完整解析
+    linx_on_incoming_control_cb_t on_incoming_control;  // CBOR 控制消息回调，返回 false 时转换为 cJSON 交给上面的 JSON 回调
     linx_on_network_error_cb_t on_network_error;        // 网络错误回调
     linx_on_connected_cb_t on_connected;                // 连接成功回调
     linx_on_disconnected_cb_t on_disconnected;          // 连接断开回调
@@ -76,6 +141,8 @@ typedef struct {
     bool (*start)(linx_protocol_t* protocol);
     bool (*send_audio)(linx_protocol_t* protocol, linx_audio_stream_packet_t* packet);
     bool (*send_text)(linx_protocol_t* protocol, const char* text);
+    /* 可选：以二进制编码发送控制消息，未协商或未能发出时返回 false，由调用方改发 JSON */
+    bool (*send_control)(linx_protocol_t* protocol, const linx_control_message_t* message);
     void (*destroy)(linx_protocol_t* protocol);
 } linx_protocol_vtable_t;
 
@@ -89,10 +156,15 @@ struct linx_protocol {
     bool error_occurred;            // 是否发生错误
     char* session_id;               // 会话ID
     uint64_t last_incoming_time;    // 最后接收数据的时间戳（毫秒）
+
+    linx_json_writer_t writer;      // 上行控制消息写入器（缓冲区按连接复用）
+    pthread_mutex_t writer_mutex;   // 保护 writer，允许多线程发送控制消息
 };
 
 /* 协议管理函数 */
 void linx_protocol_init(linx_protocol_t* protocol, const linx_protocol_vtable_t* vtable);
+/* 释放基类持有的资源（会话ID、消息写入器），由具体协议的 destroy 调用 */
+void linx_protocol_deinit(linx_protocol_t* protocol);
 void linx_protocol_destroy(linx_protocol_t* protocol);
 
 /* 回调函数配置 */
@@ -102,6 +174,7 @@ void linx_protocol_set_callbacks(linx_protocol_t* protocol, const linx_protocol_
 /* 协议操作函数 */
 bool linx_protocol_start(linx_protocol_t* protocol);
 bool linx_protocol_send_audio(linx_protocol_t* protocol, linx_audio_stream_packet_t* packet);
+bool linx_protocol_send_text(linx_protocol_t* protocol, const char* text);
 
 /* 高级消息发送函数 */
 void linx_protocol_send_wake_word_detected(linx_protocol_t* protocol, const char* wake_word);
@@ -110,14 +183,164 @@ void linx_protocol_send_stop_listening(linx_protocol_t* protocol);
 void linx_protocol_send_abort_speaking(linx_protocol_t* protocol, linx_abort_reason_t reason);
 void linx_protocol_send_mcp_message(linx_protocol_t* protocol, const char* message);
 
+/*
+ * 通知服务端设备已缓存当前句子的音频（hello 中协商了 features.tts_cache）：
+ *   {"session_id":"...","type":"tts","state":"skip","text":"<sentence_start 的文本>","duration_ms":1840}
+ * 服务端停止合成和下发这一句剩余的音频，下行时间戳按 duration_ms 前进（与下发了这一句相同），
+ * 然后照常继续下一句。skip 到达前已经发出的这一句的音频由设备丢弃。
+ */
+void linx_protocol_send_tts_skip(linx_protocol_t* protocol, const char* text, uint32_t duration_ms);
+
+/*
+ * 上报下行音频的播出位置（hello 中协商了 features.playback_position）：
+ *   {"session_id":"...","type":"tts","state":"position","timestamp":12340,"output_delay_ms":85}
+ * timestamp 是此刻从扬声器播出的下行音频的时间戳（与下行帧的时间戳同一时间轴），
+ * output_delay_ms 是已交给音频设备、还没播出的音频时长。服务端据此对齐回声参考和字幕。
+ */
+void linx_protocol_send_playback_position(linx_protocol_t* protocol, uint32_t timestamp, uint32_t output_delay_ms);
+
 /* 工具函数 */
 void linx_protocol_set_error(linx_protocol_t* protocol, const char* message);
 bool linx_protocol_is_timeout(const linx_protocol_t* protocol);
 
+/* 记录收到数据的时刻（last_incoming_time），由传输实现在读到任何数据时调用 */
+void linx_protocol_mark_incoming(linx_protocol_t* protocol);
+
 /* 音频数据包管理 */
 linx_audio_stream_packet_t* linx_audio_stream_packet_create(size_t payload_size);
 void linx_audio_stream_packet_destroy(linx_audio_stream_packet_t* packet);
 
+/**
+ * 初始化一个指向外部缓冲区的数据包视图（不分配内存、不拷贝）
+ * @param packet 待初始化的数据包（通常位于栈上）
+ * @param payload 外部载荷缓冲区
+ * @param payload_size 载荷大小
+ */
+void linx_audio_stream_packet_init_view(linx_audio_stream_packet_t* packet,
+                                        const uint8_t* payload, size_t payload_size);
+
+/**
+ * 将数据包（视图或自有包）复制为独立持有的数据包
+ * @param packet 源数据包
+ * @return 新数据包，需调用 linx_audio_stream_packet_destroy() 释放；失败返回 NULL
+ */
+linx_audio_stream_packet_t* linx_audio_stream_packet_retain(const linx_audio_stream_packet_t* packet);
+
+/* 二进制音频帧 */
+
+/**
+ * 按协议版本编码音频帧头（v2/v3/v4），字段为网络字节序
+ * @param version 协议版本；v1 等其他版本没有帧头
+ * @param timestamp 时间戳（毫秒），v2、v4 携带
+ * @param sequence 帧序号，仅 v4 携带
+ * @param payload_size 载荷大小
+ * @param header 输出缓冲区，至少 LINX_BINARY_HEADER_MAX_BYTES 字节
+ * @return 帧头字节数，无帧头的版本返回 0；载荷超出 v3/v4 上限返回 -1
+ */
+int linx_binary_protocol_encode_header(int version, uint32_t timestamp, uint16_t sequence,
+                                       size_t payload_size, uint8_t* header);
+
+/**
+ * 按协议版本编码控制消息帧头（v2/v3/v4），类型为 LINX_BINARY_TYPE_CONTROL、时间戳和序号为 0
+ * @param version 协议版本；v1 没有帧头，不能承载控制消息
+ * @param payload_size 载荷（CBOR）大小
+ * @param header 输出缓冲区，至少 LINX_BINARY_HEADER_MAX_BYTES 字节
+ * @return 帧头字节数；v1 等无帧头的版本返回 0；载荷超出 v3/v4 上限返回 -1
+ */
+int linx_binary_protocol_encode_control_header(int version, size_t payload_size, uint8_t* header);
+
+/**
+ * 按协议版本解析收到的二进制帧，不拷贝数据
+ * @param version 协议版本；v1 等其他版本整帧都是音频载荷
+ * @param data 帧数据
+ * @param size 帧长度
+ * @param payload 输出载荷起始位置（指向 data 内部）
+ * @param payload_size 输出载荷大小；TRUNCATED 时为帧头声明的大小
+ * @param timestamp 输出时间戳，v2、v4 的音频帧携带，其他情况为 0
+ * @param sequence 输出帧序号，只有 v4 携带，其他版本为 0；不需要时可传 NULL
+ * @return 解析结果
+ */
+linx_binary_frame_result_t linx_binary_protocol_decode(int version, const uint8_t* data, size_t size,
+                                                       const uint8_t** payload, size_t* payload_size,
+                                                       uint32_t* timestamp, uint16_t* sequence);
+
+/**
+ * 协议版本的音频帧是否携带时间戳（v2、v4）
+ */
+bool linx_binary_protocol_has_timestamp(int version);
+
+/**
+ * 在已编码的帧头中写入流ID（多路复用，见 linx_websocket_stream_create()）
+ * v3/v4 写入 reserved 字节，v2 写入 reserved 字段的低字节
+ * @param version 协议版本
+ * @param header 由 linx_binary_protocol_encode_header() 等编码的帧头
+ * @param stream_id 流ID，0 表示连接自身的会话
+ * @return 版本没有帧头时返回 false
+ */
+bool linx_binary_protocol_set_stream(int version, uint8_t* header, uint8_t stream_id);
+
+/**
+ * 读取二进制帧的流ID
+ * @return 流ID；帧过短或版本没有帧头时返回 0
+ */
+uint8_t linx_binary_protocol_get_stream(int version, const uint8_t* data, size_t size);
+
+/* 音频数据包内存池
+ *
+ * 固定大小的槽位一次性分配在一块连续内存上，避免每帧 malloc/free 带来的
+ * 堆碎片。池耗尽或载荷超过槽位大小时自动回退到堆分配并计入 misses。
+ * 从池中取得的数据包同样通过 linx_audio_stream_packet_destroy() 归还。
+ * 内存池是线程安全的；销毁内存池前必须归还所有借出的数据包。
+ */
+
+/**
+ * 根据帧时长计算单个数据包所需的最大载荷大小
+ * @param frame_duration_ms 帧持续时间（毫秒），<=0 时按 20ms 计算
+ * @return 最大载荷字节数
+ */
+size_t linx_audio_packet_pool_payload_size(int frame_duration_ms);
+
+/**
+ * 创建音频数据包内存池
+ * @param slot_count 槽位数量
+ * @param slot_payload 单个槽位最大载荷（字节）
+ * @return 内存池实例，失败返回 NULL
+ */
+linx_audio_packet_pool_t* linx_audio_packet_pool_create(size_t slot_count, size_t slot_payload);
+
+/**
+ * 销毁音频数据包内存池
+ * 仍有数据包借出时推迟到最后一个数据包归还（linx_audio_stream_packet_destroy）时释放，
+ * 借出的数据包在此之前保持有效；销毁后不能再从池中获取数据包
+ * @param pool 内存池实例
+ */
+void linx_audio_packet_pool_destroy(linx_audio_packet_pool_t* pool);
+
+/**
+ * 从内存池获取数据包，池为 NULL 时等同于 linx_audio_stream_packet_create()
+ * @param pool 内存池实例
+ * @param payload_size 载荷大小
+ * @return 数据包，失败返回 NULL
+ */
+linx_audio_stream_packet_t* linx_audio_packet_pool_acquire(linx_audio_packet_pool_t* pool, size_t payload_size);
+
+/**
+ * 将数据包（通常是零拷贝视图）复制到内存池中的数据包
+ * @param pool 内存池实例，可为 NULL
+ * @param packet 源数据包
+ * @return 新数据包，需调用 linx_audio_stream_packet_destroy() 释放；失败返回 NULL
+ */
+linx_audio_stream_packet_t* linx_audio_packet_pool_retain(linx_audio_packet_pool_t* pool,
+                                                          const linx_audio_stream_packet_t* packet);
+
+/**
+ * 获取内存池统计信息
+ * @param pool 内存池实例
+ * @param stats 统计信息（输出参数）
+ * @return 成功返回 true
+ */
+bool linx_audio_packet_pool_get_stats(linx_audio_packet_pool_t* pool, linx_audio_packet_pool_stats_t* stats);
+
 #ifdef __cplusplus
 }
 #endif
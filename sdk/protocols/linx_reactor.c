@@ -0,0 +1,398 @@
+#include "linx_reactor.h"
+#include "mongoose.h"
+#include "log/linx_log.h"
+#include "log/linx_alloc.h"
+#include "log/linx_thread_stats.h"
+#include "os/linx_os.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_PROTOCOL);
+
+/* How long a thread waiting in linx_reactor_run sleeps before trying to take over the loop */
+#define LINX_REACTOR_RUN_RETRY_MS 10
+
+/* A task handed to the loop; lives on the stack of the thread waiting in linx_reactor_run */
+typedef struct linx_reactor_task_item {
+    struct linx_reactor_task_item* next;
+    linx_reactor_task_t task;
+    void* arg;
+    bool done;
+} linx_reactor_task_item_t;
+
+struct linx_reactor {
+    struct mg_mgr mgr;
+    bool wakeup_enabled;
+
+    /* Deadlines of every attached instance (loop context only) */
+    linx_timer_wheel_t* timers;
+
+    /* Held by whichever thread is in the loop context; serializes all mgr access */
+    pthread_mutex_t loop_mutex;
+    pthread_t owner;
+    bool has_owner;
+
+    /* Tasks from other threads, run at the start and end of every poll */
+    pthread_mutex_t task_mutex;
+    pthread_cond_t task_cond;
+    linx_reactor_task_item_t* task_head;
+    linx_reactor_task_item_t* task_tail;
+
+    /* Poll hooks (loop context only); removed entries are compacted after iteration */
+    linx_reactor_hook_t* hooks;
+    size_t hook_count;
+    size_t hook_capacity;
+    int hook_iterating;
+    bool hooks_dirty;
+
+    /* Own loop thread */
+    linx_thread_t* thread;
+    bool thread_running;
+};
+
+static void linx_reactor_enter(linx_reactor_t* reactor) {
+    reactor->owner = pthread_self();
+    __atomic_store_n(&reactor->has_owner, true, __ATOMIC_RELEASE);
+}
+
+static void linx_reactor_leave(linx_reactor_t* reactor) {
+    __atomic_store_n(&reactor->has_owner, false, __ATOMIC_RELEASE);
+}
+
+linx_reactor_t* linx_reactor_create(void) {
+    linx_reactor_t* reactor = (linx_reactor_t*)LINX_CALLOC(1, sizeof(linx_reactor_t));
+    if (!reactor) {
+        LOG_ERROR("Reactor creation failed: memory allocation failed");
+        return NULL;
+    }
+
+    if (pthread_mutex_init(&reactor->loop_mutex, NULL) != 0) {
+        LINX_FREE(reactor);
+        return NULL;
+    }
+    if (pthread_mutex_init(&reactor->task_mutex, NULL) != 0) {
+        pthread_mutex_destroy(&reactor->loop_mutex);
+        LINX_FREE(reactor);
+        return NULL;
+    }
+    if (pthread_cond_init(&reactor->task_cond, NULL) != 0) {
+        pthread_mutex_destroy(&reactor->task_mutex);
+        pthread_mutex_destroy(&reactor->loop_mutex);
+        LINX_FREE(reactor);
+        return NULL;
+    }
+
+    reactor->timers = linx_timer_wheel_create(0, mg_millis);
+    if (!reactor->timers) {
+        pthread_cond_destroy(&reactor->task_cond);
+        pthread_mutex_destroy(&reactor->task_mutex);
+        pthread_mutex_destroy(&reactor->loop_mutex);
+        LINX_FREE(reactor);
+        return NULL;
+    }
+
+    mg_mgr_init(&reactor->mgr);
+    reactor->wakeup_enabled = mg_wakeup_init(&reactor->mgr);
+    if (!reactor->wakeup_enabled) {
+        LOG_WARN("Reactor wakeup pipe unavailable, cross-thread work waits for the poll timeout");
+    }
+
+    LOG_INFO("Reactor created");
+    return reactor;
+}
+
+void linx_reactor_destroy(linx_reactor_t* reactor) {
+    if (!reactor) {
+        return;
+    }
+
+    linx_reactor_stop(reactor);
+
+    pthread_mutex_lock(&reactor->loop_mutex);
+    mg_mgr_free(&reactor->mgr);
+    pthread_mutex_unlock(&reactor->loop_mutex);
+
+    linx_timer_wheel_destroy(reactor->timers);
+    LINX_FREE(reactor->hooks);
+    pthread_cond_destroy(&reactor->task_cond);
+    pthread_mutex_destroy(&reactor->task_mutex);
+    pthread_mutex_destroy(&reactor->loop_mutex);
+    LINX_FREE(reactor);
+    LOG_INFO("Reactor destroyed");
+}
+
+/* Run queued tasks; caller is in the loop context */
+static void linx_reactor_run_tasks(linx_reactor_t* reactor) {
+    for (;;) {
+        pthread_mutex_lock(&reactor->task_mutex);
+        linx_reactor_task_item_t* item = reactor->task_head;
+        if (item) {
+            reactor->task_head = item->next;
+            if (!reactor->task_head) {
+                reactor->task_tail = NULL;
+            }
+        }
+        pthread_mutex_unlock(&reactor->task_mutex);
+
+        if (!item) {
+            return;
+        }
+
+        item->task(item->arg);
+
+        pthread_mutex_lock(&reactor->task_mutex);
+        item->done = true;
+        pthread_cond_broadcast(&reactor->task_cond);
+        pthread_mutex_unlock(&reactor->task_mutex);
+    }
+}
+
+static int linx_reactor_hooks_timeout_ms(linx_reactor_t* reactor, int timeout_ms) {
+    for (size_t i = 0; i < reactor->hook_count; i++) {
+        const linx_reactor_hook_t* hook = &reactor->hooks[i];
+        if (hook->on_poll && hook->next_timeout_ms) {
+            int hook_ms = hook->next_timeout_ms(hook->user_data, timeout_ms);
+            if (hook_ms >= 0 && hook_ms < timeout_ms) {
+                timeout_ms = hook_ms;
+            }
+        }
+    }
+    return timeout_ms;
+}
+
+static void linx_reactor_run_hooks(linx_reactor_t* reactor) {
+    reactor->hook_iterating++;
+    /* Hooks may add or remove hooks; the count is re-read every step */
+    for (size_t i = 0; i < reactor->hook_count; i++) {
+        linx_reactor_hook_t hook = reactor->hooks[i];
+        if (hook.on_poll) {
+            hook.on_poll(hook.user_data);
+        }
+    }
+    reactor->hook_iterating--;
+
+    if (reactor->hook_iterating == 0 && reactor->hooks_dirty) {
+        size_t kept = 0;
+        for (size_t i = 0; i < reactor->hook_count; i++) {
+            if (reactor->hooks[i].on_poll) {
+                reactor->hooks[kept++] = reactor->hooks[i];
+            }
+        }
+        reactor->hook_count = kept;
+        reactor->hooks_dirty = false;
+    }
+}
+
+void linx_reactor_poll(linx_reactor_t* reactor, int timeout_ms) {
+    if (!reactor) {
+        return;
+    }
+
+    pthread_mutex_lock(&reactor->loop_mutex);
+    linx_reactor_enter(reactor);
+
+    linx_reactor_run_tasks(reactor);
+
+    if (timeout_ms < 0 || timeout_ms > LINX_REACTOR_IDLE_TIMEOUT_MS) {
+        timeout_ms = LINX_REACTOR_IDLE_TIMEOUT_MS;
+    }
+    timeout_ms = linx_timer_wheel_clamp_timeout(reactor->timers, linx_reactor_hooks_timeout_ms(reactor, timeout_ms));
+    mg_mgr_poll(&reactor->mgr, timeout_ms);
+    linx_reactor_run_hooks(reactor);
+    linx_timer_wheel_advance(reactor->timers);
+
+    linx_reactor_run_tasks(reactor);
+
+    linx_reactor_leave(reactor);
+    pthread_mutex_unlock(&reactor->loop_mutex);
+}
+
+static void* linx_reactor_thread(void* arg) {
+    linx_reactor_t* reactor = (linx_reactor_t*)arg;
+
+    linx_thread_stats_register("reactor", LINX_THREAD_STAGE_NETWORK);
+    LOG_INFO("Reactor loop started");
+    while (__atomic_load_n(&reactor->thread_running, __ATOMIC_ACQUIRE)) {
+        linx_reactor_poll(reactor, -1);
+    }
+    LOG_INFO("Reactor loop ended");
+    linx_thread_stats_unregister();
+    return NULL;
+}
+
+bool linx_reactor_start(linx_reactor_t* reactor, size_t stack_size) {
+    if (!reactor) {
+        return false;
+    }
+    if (__atomic_load_n(&reactor->thread_running, __ATOMIC_ACQUIRE)) {
+        return true;
+    }
+
+    linx_thread_attr_t attr = {
+        .name = "reactor",
+        .stack_size = stack_size,
+        .priority = LINX_THREAD_PRIORITY_NORMAL,
+        .core_mask = LINX_THREAD_NET_CORE_MASK
+    };
+
+    __atomic_store_n(&reactor->thread_running, true, __ATOMIC_RELEASE);
+    reactor->thread = linx_thread_create(&attr, linx_reactor_thread, reactor);
+    if (!reactor->thread) {
+        LOG_ERROR("Failed to create reactor thread");
+        __atomic_store_n(&reactor->thread_running, false, __ATOMIC_RELEASE);
+        return false;
+    }
+    return true;
+}
+
+void linx_reactor_stop(linx_reactor_t* reactor) {
+    if (!reactor || !__atomic_load_n(&reactor->thread_running, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+
+    __atomic_store_n(&reactor->thread_running, false, __ATOMIC_RELEASE);
+    linx_reactor_wakeup(reactor);
+    linx_thread_join(reactor->thread);
+    reactor->thread = NULL;
+}
+
+bool linx_reactor_wakeup(linx_reactor_t* reactor) {
+    if (!reactor || !reactor->wakeup_enabled) {
+        return false;
+    }
+    /* No connection has id 0: the message only interrupts mg_mgr_poll */
+    return mg_wakeup(&reactor->mgr, 0, "", 0);
+}
+
+bool linx_reactor_wakeup_enabled(const linx_reactor_t* reactor) {
+    return reactor && reactor->wakeup_enabled;
+}
+
+bool linx_reactor_in_loop(linx_reactor_t* reactor) {
+    return reactor && __atomic_load_n(&reactor->has_owner, __ATOMIC_ACQUIRE) &&
+           pthread_equal(reactor->owner, pthread_self());
+}
+
+bool linx_reactor_run(linx_reactor_t* reactor, linx_reactor_task_t task, void* arg) {
+    if (!reactor || !task) {
+        return false;
+    }
+
+    if (linx_reactor_in_loop(reactor)) {
+        task(arg);
+        return true;
+    }
+
+    linx_reactor_task_item_t item = { NULL, task, arg, false };
+    pthread_mutex_lock(&reactor->task_mutex);
+    if (reactor->task_tail) {
+        reactor->task_tail->next = &item;
+    } else {
+        reactor->task_head = &item;
+    }
+    reactor->task_tail = &item;
+    pthread_mutex_unlock(&reactor->task_mutex);
+
+    linx_reactor_wakeup(reactor);
+
+    for (;;) {
+        pthread_mutex_lock(&reactor->task_mutex);
+        bool done = item.done;
+        pthread_mutex_unlock(&reactor->task_mutex);
+        if (done) {
+            return true;
+        }
+
+        /* Nobody is polling right now: run the queue here */
+        if (pthread_mutex_trylock(&reactor->loop_mutex) == 0) {
+            linx_reactor_enter(reactor);
+            linx_reactor_run_tasks(reactor);
+            linx_reactor_leave(reactor);
+            pthread_mutex_unlock(&reactor->loop_mutex);
+            continue;
+        }
+
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += LINX_REACTOR_RUN_RETRY_MS * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        pthread_mutex_lock(&reactor->task_mutex);
+        if (!item.done) {
+            pthread_cond_timedwait(&reactor->task_cond, &reactor->task_mutex, &deadline);
+        }
+        pthread_mutex_unlock(&reactor->task_mutex);
+    }
+}
+
+typedef struct {
+    linx_reactor_t* reactor;
+    const linx_reactor_hook_t* hook;
+    bool result;
+} linx_reactor_hook_op_t;
+
+static void linx_reactor_add_hook_task(void* arg) {
+    linx_reactor_hook_op_t* op = (linx_reactor_hook_op_t*)arg;
+    linx_reactor_t* reactor = op->reactor;
+
+    if (reactor->hook_count == reactor->hook_capacity) {
+        size_t capacity = reactor->hook_capacity ? reactor->hook_capacity * 2 : 8;
+        linx_reactor_hook_t* hooks = (linx_reactor_hook_t*)LINX_REALLOC(reactor->hooks, capacity * sizeof(*hooks));
+        if (!hooks) {
+            op->result = false;
+            return;
+        }
+        reactor->hooks = hooks;
+        reactor->hook_capacity = capacity;
+    }
+    reactor->hooks[reactor->hook_count++] = *op->hook;
+    op->result = true;
+}
+
+static void linx_reactor_remove_hook_task(void* arg) {
+    linx_reactor_hook_op_t* op = (linx_reactor_hook_op_t*)arg;
+    linx_reactor_t* reactor = op->reactor;
+
+    for (size_t i = 0; i < reactor->hook_count; i++) {
+        linx_reactor_hook_t* hook = &reactor->hooks[i];
+        if (hook->on_poll != op->hook->on_poll || hook->user_data != op->hook->user_data) {
+            continue;
+        }
+        if (reactor->hook_iterating > 0) {
+            hook->on_poll = NULL;
+            reactor->hooks_dirty = true;
+        } else {
+            memmove(hook, hook + 1, (reactor->hook_count - i - 1) * sizeof(*hook));
+            reactor->hook_count--;
+        }
+        return;
+    }
+}
+
+bool linx_reactor_add_hook(linx_reactor_t* reactor, const linx_reactor_hook_t* hook) {
+    if (!reactor || !hook || !hook->on_poll) {
+        return false;
+    }
+    linx_reactor_hook_op_t op = { reactor, hook, false };
+    return linx_reactor_run(reactor, linx_reactor_add_hook_task, &op) && op.result;
+}
+
+void linx_reactor_remove_hook(linx_reactor_t* reactor, const linx_reactor_hook_t* hook) {
+    if (!reactor || !hook) {
+        return;
+    }
+    linx_reactor_hook_op_t op = { reactor, hook, false };
+    linx_reactor_run(reactor, linx_reactor_remove_hook_task, &op);
+}
+
+struct mg_mgr* linx_reactor_get_mgr(linx_reactor_t* reactor) {
+    return reactor ? &reactor->mgr : NULL;
+}
+
+linx_timer_wheel_t* linx_reactor_get_timers(linx_reactor_t* reactor) {
+    return reactor ? reactor->timers : NULL;
+}
@@ -0,0 +1,142 @@
+#ifndef LINX_REACTOR_H
+#define LINX_REACTOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "../linx_timer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 共享事件循环（reactor）
+ *
+ * 一个 reactor 持有一个 mongoose 管理器，多个 WebSocket 协议实例（及其 OTA 等连接）
+ * 挂在同一个管理器上，由一个线程统一轮询，适合在一个进程里模拟大量设备或做多房间网关。
+ *
+ * 管理器上的所有操作都在"循环上下文"中执行：即持有 reactor 循环锁的线程，
+ * 可以是 linx_reactor_start() 启动的线程，也可以是调用 linx_reactor_poll() 的应用线程。
+ * 其他线程通过 linx_reactor_run() 把操作交给循环上下文同步执行。
+ *
+ * reactor 自带一个时间轮（linx_reactor_get_timers()），挂在上面的实例的重连退避和保活探测
+ * 都是其中的定时器，每轮轮询后推进，轮询的等待时间不超过下一个定时器到期。
+ */
+typedef struct linx_reactor linx_reactor_t;
+
+struct mg_mgr;
+
+/**
+ * 每轮轮询后调用的钩子（在循环上下文中执行）
+ */
+typedef struct {
+    void (*on_poll)(void* user_data);                       // 每次 mg_mgr_poll 返回后调用
+    int (*next_timeout_ms)(void* user_data, int idle_ms);   // 返回本实例能接受的最长等待时间，可为 NULL
+    void* user_data;
+} linx_reactor_hook_t;
+
+/**
+ * 在循环上下文中执行的任务
+ */
+typedef void (*linx_reactor_task_t)(void* arg);
+
+/* 未启用任何计时器时的轮询等待上限（毫秒） */
+#define LINX_REACTOR_IDLE_TIMEOUT_MS 1000
+
+/**
+ * 创建 reactor
+ * @return reactor 实例，失败返回 NULL
+ */
+linx_reactor_t* linx_reactor_create(void);
+
+/**
+ * 销毁 reactor：停止循环线程并释放管理器
+ * 挂在上面的协议实例必须先销毁
+ * @param reactor reactor 实例，NULL 时不做任何操作
+ */
+void linx_reactor_destroy(linx_reactor_t* reactor);
+
+/**
+ * 启动 reactor 自己的循环线程
+ * @param reactor reactor 实例
+ * @param stack_size 线程栈大小（字节），0 为系统默认值
+ * @return 启动成功（或已在运行）返回 true
+ */
+bool linx_reactor_start(linx_reactor_t* reactor, size_t stack_size);
+
+/**
+ * 停止循环线程并等待其退出（不能在循环线程中调用）
+ * @param reactor reactor 实例
+ */
+void linx_reactor_stop(linx_reactor_t* reactor);
+
+/**
+ * 不启动线程时由应用驱动：执行一轮 mg_mgr_poll 和全部钩子
+ * @param reactor reactor 实例
+ * @param timeout_ms 最长等待时间（毫秒），-1 表示只受钩子的计时器限制
+ */
+void linx_reactor_poll(linx_reactor_t* reactor, int timeout_ms);
+
+/**
+ * 唤醒阻塞在 mg_mgr_poll 中的循环（可在任意线程调用）
+ * @param reactor reactor 实例
+ * @return 唤醒信号发送成功返回 true
+ */
+bool linx_reactor_wakeup(linx_reactor_t* reactor);
+
+/**
+ * 唤醒管道是否可用：不可用时跨线程的发送只能等到下一次轮询超时
+ * @param reactor reactor 实例
+ */
+bool linx_reactor_wakeup_enabled(const linx_reactor_t* reactor);
+
+/**
+ * 当前线程是否处于循环上下文
+ * @param reactor reactor 实例
+ */
+bool linx_reactor_in_loop(linx_reactor_t* reactor);
+
+/**
+ * 在循环上下文中同步执行任务，返回时任务已执行完
+ * 已在循环上下文中时直接调用；没有线程在轮询时由调用线程取得循环锁后执行
+ * @param reactor reactor 实例
+ * @param task 任务函数
+ * @param arg 任务参数
+ * @return 任务已执行返回 true
+ */
+bool linx_reactor_run(linx_reactor_t* reactor, linx_reactor_task_t task, void* arg);
+
+/**
+ * 注册轮询钩子（内容被复制），可在任意线程调用
+ * @param reactor reactor 实例
+ * @param hook 钩子
+ * @return 注册成功返回 true
+ */
+bool linx_reactor_add_hook(linx_reactor_t* reactor, const linx_reactor_hook_t* hook);
+
+/**
+ * 注销轮询钩子（按 on_poll 和 user_data 匹配），返回后钩子不会再被调用
+ * @param reactor reactor 实例
+ * @param hook 注册时使用的钩子
+ */
+void linx_reactor_remove_hook(linx_reactor_t* reactor, const linx_reactor_hook_t* hook);
+
+/**
+ * 获取共享的 mongoose 管理器，只能在循环上下文中使用
+ * @param reactor reactor 实例
+ * @return 管理器指针
+ */
+struct mg_mgr* linx_reactor_get_mgr(linx_reactor_t* reactor);
+
+/**
+ * 获取共享的时间轮（时钟为 mg_millis()），只能在循环上下文中使用
+ * @param reactor reactor 实例
+ * @return 时间轮指针
+ */
+linx_timer_wheel_t* linx_reactor_get_timers(linx_reactor_t* reactor);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LINX_REACTOR_H
@@ -1,20 +1,142 @@
 #include "linx_websocket.h"
+#include "linx_ws_capture.h"
+#include "linx_ogg_recorder.h"
+#include "linx_ws_deflate.h"
+#include "linx_control_cbor.h"
+#include "linx_binary_frame.h"
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <stdio.h>
 #include <arpa/inet.h>
+#include <pthread.h>
+#include <time.h>
 #include <mongoose.h>
 #include "../cjson/cJSON.h"
+#include "../cjson/linx_json_scan.h"
+#include "../cjson/linx_json_arena.h"
+#include "../cjson/linx_json_stream.h"
 #include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
+#include "../linx_tracepoint.h"
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_PROTOCOL);
+
+/*
+ * 编译期固定的二进制协议版本（1-4，由构建配置的 CONFIG_WS_PROTOCOL_VERSION 传入），0 为运行时协商
+ * 固定后音频收发路径按常量编解码帧头，其他版本的帧格式不编译进来；配置的版本被忽略，
+ * 只提供这一个版本，服务端 hello 选择其他版本时拒绝该会话
+ */
+#ifndef LINX_WS_PROTOCOL_VERSION
+#define LINX_WS_PROTOCOL_VERSION 0
+#endif
+
+#if LINX_WS_PROTOCOL_VERSION < 0 || LINX_WS_PROTOCOL_VERSION > LINX_BINARY_PROTOCOL_MAX_VERSION
+#error "LINX_WS_PROTOCOL_VERSION must be 0 (negotiated) or a supported binary protocol version"
+#endif
+
+/* 音频路径使用的帧格式版本：固定时是编译期常量 */
+#if LINX_WS_PROTOCOL_VERSION > 0
+#define LINX_WS_FRAME_VERSION(ws) ((void)(ws), LINX_WS_PROTOCOL_VERSION)
+#else
+#define LINX_WS_FRAME_VERSION(ws) ((ws)->version)
+#endif
+
+/* 进程内 DNS 缓存条目数（按 host:port 区分，多个协议实例共享） */
+#define LINX_WEBSOCKET_DNS_CACHE_SLOTS 4
+
+/* 尽快回放时每次轮询最多处理的记录数，之后让出一次轮询发送其他线程排队的帧 */
+#define LINX_WEBSOCKET_REPLAY_BURST 64
+
+/* 帧头第一个字节的 RSV1 位：permessage-deflate 压缩过的消息（mongoose 的 op 与 flags 都取该字节） */
+#define LINX_WEBSOCKET_FLAG_RSV1 0x40
+
+/* TLS 会话恢复需要 mbedTLS 后端，mongoose 的内置 TLS 不支持会话票据 */
+#if defined(MG_TLS_MBED) && MG_TLS == MG_TLS_MBED
+#define LINX_WEBSOCKET_TLS_RESUME 1
+#else
+#define LINX_WEBSOCKET_TLS_RESUME 0
+#endif
+
+/* 保存的 TLS 会话的最大字节数（含票据） */
+#define LINX_WEBSOCKET_TLS_SESSION_MAX 2048
+
+/* 发送队列最大深度（每个队列各自计数） */
+#define LINX_WEBSOCKET_SEND_QUEUE_MAX 256
+
+/* 发送队列节点：应用线程提交、事件循环线程发送 */
+typedef struct linx_websocket_send_item {
+    struct linx_websocket_send_item* next;
+    uint32_t timestamp;             // 音频时间戳
+    uint16_t sequence;              // 音频帧序号（协议 v4）
+    uint8_t stream;                 // 音频帧所属的流ID，0 为连接自身的会话
+    int op;                         // 文本队列：WEBSOCKET_OP_TEXT，或 WEBSOCKET_OP_BINARY（含帧头的控制消息）
+    size_t size;                    // 数据大小
+    uint8_t data[];                 // 音频载荷、文本内容或控制消息帧
+} linx_websocket_send_item_t;
+
+/* 出站优先级（见 linx_websocket_config_t::bulk_fragment_bytes） */
+typedef enum {
+    LINX_WEBSOCKET_PRIORITY_URGENT, // abort、listen start/detect：排在已排队的音频之前
+    LINX_WEBSOCKET_PRIORITY_NORMAL, // 其余消息：排在已排队的音频之后，listen stop 因此跟在最后几帧之后
+    LINX_WEBSOCKET_PRIORITY_BULK    // 超过一个分片的文本：最后发送，按分片写入
+} linx_websocket_priority_t;
+
+/* 等待发送的大消息总字节数上限，单条超过上限的消息只在队列为空时接受 */
+#define LINX_WEBSOCKET_BULK_QUEUE_MAX (1024 * 1024)
+
+/* 最近多久内有音频收发算作会话中，按 keepalive_active_ms 探测 */
+#define LINX_WEBSOCKET_ACTIVE_HOLD_MS 2000
+
+/* 探测超时：还没有 RTT 样本时的初值和下限（同 RFC 6298 的 RTO 下限） */
+#define LINX_WEBSOCKET_PROBE_TIMEOUT_INITIAL_MS 2000
+#define LINX_WEBSOCKET_PROBE_TIMEOUT_MIN_MS 1000
+
+/* 帧头第一个字节的 FIN 位：mg_ws_wrap() 总是置位，非最后一个分片需清除 */
+#define LINX_WEBSOCKET_FLAG_FIN 0x80
+
+/* WebSocket 帧头最大长度：2 字节 + 8 字节长度 + 4 字节掩码 */
+#define LINX_WEBSOCKET_WS_HEADER_MAX 14
+
+/* 跨线程音频发送节点池：槽位数与单槽载荷上限，超出上限或池空时回退到堆 */
+#define LINX_WEBSOCKET_AUDIO_ITEM_SLOTS 16
+#define LINX_WEBSOCKET_AUDIO_ITEM_PAYLOAD 512
+#define LINX_WEBSOCKET_AUDIO_ITEM_STRIDE \
+    ((sizeof(linx_websocket_send_item_t) + LINX_WEBSOCKET_AUDIO_ITEM_PAYLOAD + 7) & ~(size_t)7)
+
+/* 无锁多生产者单消费者队列：生产者 CAS 压栈，消费者一次性摘下整条链并反转为 FIFO */
+typedef struct {
+    linx_websocket_send_item_t* head;   // 最近入队的节点
+    size_t depth;                       // 当前排队数量
+} linx_websocket_send_queue_t;
+
+/* DNS 缓存条目：服务器名解析出的地址，在 TTL 内直接拨号，跳过 DNS 查询 */
+typedef struct {
+    char host[128];                 // 主机名，空表示未使用
+    uint16_t port;                  // 端口（主机字节序）
+    struct mg_addr addr;            // 解析结果（端口为网络字节序）
+    uint64_t expires_ms;            // 过期时刻（mg_millis）
+} linx_websocket_dns_entry_t;
+
+static linx_websocket_dns_entry_t s_dns_cache[LINX_WEBSOCKET_DNS_CACHE_SLOTS];
+static pthread_mutex_t s_dns_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 /* WebSocket 协议实现结构体 - 隐藏实现细节 */
 struct linx_websocket_protocol {
     linx_protocol_t base;           // 基础协议结构体
-    struct mg_mgr mgr;              // Mongoose 管理器
+    struct mg_mgr own_mgr;          // 未使用共享 reactor 时自带的 Mongoose 管理器
+    struct mg_mgr* mgr;             // 实际使用的管理器（own_mgr 或 reactor 的管理器）
+    linx_reactor_t* reactor;        // 共享事件循环，NULL 表示自己轮询
+    linx_reactor_hook_t reactor_hook; // 向共享事件循环提供流控等待时间的钩子
+    linx_timer_wheel_t* timers;     // 重连退避和保活的定时器（自带，或 reactor 的时间轮），事件循环线程使用
     struct mg_connection* conn;     // WebSocket 连接句柄
     bool connected;                 // 连接状态标志
     bool audio_channel_opened;      // 音频通道开启状态
-    int version;                    // 协议版本
+    int version;                    // 协议版本（服务端 hello 可协商降低）
+    int offered_version;            // 配置要求的协议版本，每次连接重新提供
+    uint16_t tx_sequence;           // 下一个上行音频帧序号（v4），任意线程原子递增
+    uint64_t tx_epoch_ms;           // 连接建立时刻，调用者未给时间戳时 v4 以此为零点
     bool server_hello_received;     // 服务器hello消息接收状态
     bool running;                   // 运行状态
     bool should_stop;               // 停止标志
@@ -29,17 +151,227 @@ struct linx_websocket_protocol {
 
     /* 协议状态 */
     char* client_audio_format;       // 客户端音频格式
+    char server_audio_format[16];    // 服务端 hello 确认的音频格式，空表示未指定
     int audio_sample_rate;           // 客户端采样率
     int audio_channels;              // 客户端声道数
     int audio_frame_duration;        // 客户端帧持续时间
     int protocol_version;           // 协议版本
+
+    /* 参数协商（audio_features 任意线程读取） */
+    char audio_formats[LINX_WEBSOCKET_MAX_AUDIO_FORMATS][16]; // 候选编码，首项为首选
+    int audio_format_count;
+    int frame_durations[LINX_WEBSOCKET_MAX_FRAME_DURATIONS];  // 候选帧长，首项为首选
+    int frame_duration_count;
+    uint32_t audio_features_offer;  // hello 中声明的可选特性
+    uint32_t audio_features;        // 服务端确认的可选特性
+
+    linx_audio_packet_pool_t* packet_pool; // 本会话的音频数据包内存池
+    linx_json_arena_t* json_arena;         // 入站消息的 cJSON 竞技场
+    cJSON_ParseLimits json_limits;         // 入站消息的解析限制
+
+    /* 事件循环 */
+    bool wakeup_enabled;            // 唤醒管道是否可用
+    unsigned long conn_id;          // 连接ID（用于唤醒）
+    pthread_t loop_thread;          // 运行 mg_mgr_poll 的线程
+    bool loop_thread_valid;         // loop_thread 是否已记录（原子读写，先写 loop_thread 再置位）
+
+    /* 跨线程发送队列（按 urgent、audio、text、bulk 的顺序发送） */
+    linx_websocket_send_queue_t urgent_queue;
+    linx_websocket_send_queue_t audio_queue;
+    linx_websocket_send_queue_t text_queue;
+    linx_websocket_send_queue_t bulk_queue;
+    uint8_t* audio_item_slab;       // 音频节点池内存，NULL 表示不可用
+    linx_websocket_send_item_t* audio_item_free; // 空闲节点链表，由 audio_item_mutex 保护
+    pthread_mutex_t audio_item_mutex;
+    uint64_t audio_item_misses;     // 节点池未命中、改用堆分配的次数
+
+    /* 上行拥塞观测（事件循环线程写入，任意线程读取） */
+    size_t send_backlog_bytes;      // 连接发送缓冲区中尚未写出的字节数
+    uint32_t rtt_ms;                // 最近一次 ping/pong 往返时间
+    bool rtt_valid;                 // rtt_ms 是否有效
+    uint32_t srtt_ms;               // 平滑 RTT
+    uint32_t rttvar_ms;             // RTT 偏差
+    uint32_t rtt_min_ms;            // 本连接的最小 RTT
+    bool ping_requested;            // 其他线程请求的 ping，由事件循环线程发出
+    uint64_t audio_dropped;         // 因发送队列已满而丢弃的音频帧数
+
+    /* 保活与断线检测（事件循环线程使用，last_audio_ms 和统计可在任意线程读写） */
+    int keepalive_idle_ms;          // 空闲保活间隔，0 表示关闭
+    int keepalive_active_ms;        // 会话中的探测间隔
+    int keepalive_max_missed;       // 连续丢失多少个探测判定断线
+    uint64_t last_rx_ms;            // 最近一次从 socket 读到数据的时刻
+    uint64_t last_audio_ms;         // 最近一次收发音频的时刻，区分会话中和空闲
+    uint64_t probe_sent_ms;         // 未应答探测的发送时刻，0 表示没有
+    uint64_t last_probe_ms;         // 最近一次发送探测的时刻
+    uint32_t probe_id;              // 最近一次探测的编号（ping 载荷，大端）
+    int probes_missed;              // 连续丢失的探测数
+    bool connection_dead;           // 当前连接已判定为半开
+    uint64_t keepalive_probes;
+    uint64_t keepalive_missed;
+    uint64_t dead_connections;
+    linx_timer_t keepalive_timer;   // 下一次探测或探测超时
+
+    /* 大消息分片发送（事件循环线程使用，统计可在任意线程读取） */
+    size_t bulk_fragment;           // 分片大小，也是大消息的判定阈值
+    bool bulk_interleave;           // 服务端 hello 确认，分片之间可穿插其他消息
+    linx_websocket_send_item_t* bulk_head; // 按提交顺序等待发送的大消息
+    linx_websocket_send_item_t* bulk_tail;
+    size_t bulk_offset;             // bulk_head 已写入发送缓冲区的字节数
+    size_t bulk_queued_bytes;       // 已提交、尚未发完的字节数（任意线程原子更新）
+    uint64_t bulk_fragments;
+    uint64_t urgent_messages;
+    uint64_t control_dropped;       // 二进制控制消息未能发送、改由调用方发 JSON 的次数
+
+    /* 收发缓冲区策略（事件循环线程使用，统计可在任意线程读取） */
+    size_t io_initial;              // 初始大小
+    size_t io_step;                 // 增长步长（iobuf 的 align）
+    size_t io_max;                  // 单个缓冲区上限，SIZE_MAX 为不限
+    int io_shrink_ms;               // 空闲多久后收缩，0 为不收缩
+    uint64_t io_recv_busy_ms;       // 接收缓冲区最近一次超过初始大小的时刻
+    uint64_t io_send_busy_ms;       // 发送缓冲区最近一次超过初始大小的时刻
+    size_t io_send_size;
+    size_t io_recv_size;
+    uint64_t io_shrinks;
+    uint64_t io_limit_drops;
+
+    /* 流式接收（事件循环线程使用） */
+    bool rx_enabled;                // 升级完成后由 SDK 解析帧
+    size_t rx_threshold;            // 单帧不小于该值的文本消息流式解析
+    linx_json_stream_t* rx_json;    // 增量解析器，第一条流式消息时创建
+    bool rx_active;                 // 分片消息进行中，下一个数据帧必须是延续帧
+    bool rx_streaming;              // 当前消息流式解析，否则拼接在 rx_buffer 中
+    bool rx_discard;                // 当前消息已出错或超限，丢弃其余部分
+    uint8_t rx_flags;               // 当前消息首帧的标志和操作码
+    uint64_t rx_frame_left;         // 当前流式帧尚未到达的载荷字节数
+    bool rx_frame_fin;              // 当前流式帧是消息的最后一帧
+    uint8_t* rx_buffer;             // 不流式解析的分片消息
+    size_t rx_length;
+    size_t rx_capacity;
+
+    /* 空闲上行（事件循环线程使用） */
+    linx_websocket_idle_sender_t idle_sender;  // 低优先级消息来源
+    void* idle_sender_user_data;
+    char* idle_buffer;              // LINX_WEBSOCKET_IDLE_MESSAGE_MAX 字节
+
+    /* 拨号钩子（事件循环线程使用） */
+    linx_websocket_dial_hook_t dial_hook;
+    void* dial_hook_user_data;
+
+    /* 到其他服务器的 RTT 探测（事件循环线程使用） */
+    struct mg_connection* rtt_probe_conn;   // 进行中的探测连接，NULL 为没有
+    char* rtt_probe_url;
+    linx_websocket_probe_cb_t rtt_probe_cb;
+    void* rtt_probe_user_data;
+    uint64_t rtt_probe_start_ms;            // 地址解析完成的时刻
+    uint64_t rtt_probe_deadline_ms;
+
+    /* 自动重连（事件循环线程使用，attempts/reconnecting 可在任意线程读取） */
+    bool auto_reconnect;            // 断开后是否自动重连
+    int reconnect_base_ms;          // 最小重连延迟
+    int reconnect_max_ms;           // 最大重连延迟
+    int reconnect_max_attempts;     // 连续重连次数上限，0 为不限
+    int reconnect_attempts;         // 自上次服务端 hello 以来的重连次数
+    int reconnect_delay_ms;         // 上次退避延迟，用于去相关抖动
+    uint64_t reconnect_at_ms;       // 下次重连时刻（mg_millis），0 表示没有待执行的重连（其他线程停止时只清零）
+    linx_timer_t reconnect_timer;   // 退避结束时执行重连
+    bool reconnecting;              // 从断开到重连成功或放弃之间为 true
+
+    /* 会话恢复 */
+    bool resume_allowed;            // 服务端 hello 声明 features.resume
+    bool session_resumed;           // 本次连接恢复了断开前的会话
+    linx_json_writer_t hello_cache; // 缓存的客户端 hello（为空时重建），服务端 hello 更新会话参数后清空
+    char* mcp_tools_hash;           // hello 的 features.mcp_tools_hash，NULL 表示不带
+
+    /* TLS 会话恢复（事件循环线程使用） */
+    uint8_t* tls_session;           // 握手时尝试恢复的会话，NULL 表示没有
+    size_t tls_session_len;
+
+    /* 连接预热（事件循环线程使用） */
+    int dns_cache_ttl_ms;           // DNS 缓存有效期，0 表示关闭
+    bool early_hello;               // 随升级请求一起发送 hello
+    bool hello_sent;                // 当前连接已发送 hello
+    bool dialed_cached_addr;        // 当前连接使用了缓存地址
+
+    /* 文本消息压缩（事件循环线程使用，统计可在任意线程读取） */
+    bool deflate_offer;             // 升级请求中提供 permessage-deflate
+    linx_ws_deflate_config_t deflate_config;
+    linx_ws_deflate_t* deflate;     // 当前连接协商成功的压缩器，NULL 表示不压缩
+    linx_ws_deflate_stats_t deflate_stats; // 最近一次协商成功的连接的统计，由 deflate_mutex 保护
+    pthread_mutex_t deflate_mutex;
+
+    /* 控制消息二进制编码 */
+    bool control_offer;             // hello 中声明 features.cbor_control
+    bool control_cbor;              // 服务端 hello 确认，上行控制消息发 CBOR；任意线程读取
+
+    /* 多路复用（streams 由 stream_mutex 保护，事件循环线程在调用流的回调期间持有） */
+    bool mux_offer;                 // hello 中声明 features.streams
+    bool mux_enabled;               // 服务端 hello 确认，可以打开流；任意线程读取
+    linx_websocket_stream_t* streams[LINX_WEBSOCKET_MAX_STREAMS]; // 按流ID - 1 索引
+    pthread_mutex_t stream_mutex;
+
+    /* 下行流控（事件循环线程使用，统计可在任意线程读取） */
+    linx_websocket_downlink_level_t flow_level; // 水位回调，NULL 表示关闭
+    void* flow_user_data;
+    int flow_capacity_ms;           // 通告的缓冲容量
+    int flow_high_ms;               // 暂停读取的水位
+    int flow_low_ms;                // 恢复读取的水位
+    bool flow_negotiated;           // 服务端确认，发送水位上报
+    bool flow_paused;               // 已暂停读取（conn->is_full）
+    uint64_t flow_paused_at_ms;     // 本次暂停开始时刻
+    int flow_level_ms;              // 最近一次查询到的水位
+    int flow_reported_ms;           // 最近一次上报的水位
+    uint64_t flow_reported_at_ms;   // 最近一次上报时刻
+    uint64_t flow_pauses;
+    uint64_t flow_paused_ms;        // 已结束的暂停累计时长
+    uint64_t flow_reports;
+
+    /* 会话录制与回放（事件循环线程使用，统计可在任意线程读取） */
+    linx_ws_capture_t* capture;     // 录制器，NULL 表示不录制
+    linx_ws_replay_t* replay;       // 回放读取器，非 NULL 时不连接网络
+    float replay_speed;             // 回放速度倍数，<=0 为尽快回放
+    uint64_t replay_start_us;       // 开始回放的时刻
+    uint64_t replay_base_us;        // 第一条记录的录制时刻
+    bool replay_base_set;           // replay_base_us 已确定
+    linx_ws_capture_record_t replay_pending; // 已读出、尚未到时间的记录
+    bool replay_pending_valid;
+    linx_websocket_replay_stats_t replay_stats;
+    linx_ogg_recorder_t* recorder;  // 上下行 Opus 录制，NULL 表示不录制
+};
+
+/* 复用连接上的一个会话（字段由承载连接的 stream_mutex 保护，opened 任意线程读取） */
+struct linx_websocket_stream {
+    linx_protocol_t base;           // 基础协议结构体，session_id 为本流的会话ID
+    linx_websocket_protocol_t* carrier; // 承载连接，连接先销毁时置为 NULL
+    uint8_t id;                     // 流ID
+    char* device_id;                // hello 中的设备ID
+    char* client_id;                // hello 中的客户端ID
+    bool started;                   // 已调用 start，服务端 hello 确认多路复用后发送本流 hello
+    bool hello_sent;                // 当前连接上已发送本流 hello
+    bool opened;                    // 服务端已回应本流 hello
+    uint16_t tx_sequence;           // 下一个上行音频帧序号（v4），任意线程原子递增
 };
 
+/* 在 reactor 循环上下文中执行的同步操作 */
+typedef struct {
+    linx_websocket_protocol_t* ws_protocol;
+    bool result;
+} linx_websocket_task_op_t;
+
 /* Internal helper function declarations */
 static void linx_websocket_protocol_destroy(linx_websocket_protocol_t* ws_protocol);
-static bool linx_websocket_parse_server_hello(linx_websocket_protocol_t* ws_protocol, const char* json_str);
-static char* linx_websocket_get_hello_message(linx_websocket_protocol_t* ws_protocol);
+static bool linx_websocket_parse_server_hello(linx_websocket_protocol_t* ws_protocol, const cJSON* root);
+static const char* linx_websocket_get_hello_message(linx_websocket_protocol_t* ws_protocol);
 static void linx_websocket_event_handler(struct mg_connection* conn, int ev, void* ev_data);
+static void linx_websocket_handle_open(linx_websocket_protocol_t* ws_protocol);
+static void linx_websocket_handle_message(linx_websocket_protocol_t* ws_protocol, const char* data,
+                                          size_t size, bool is_text);
+static void linx_websocket_handle_close(linx_websocket_protocol_t* ws_protocol);
+static bool linx_websocket_write_message(linx_websocket_protocol_t* ws_protocol, const void* data,
+                                         size_t size, int op);
+static void linx_websocket_replay_poll(linx_websocket_protocol_t* ws_protocol, int timeout_ms);
+static void linx_websocket_deflate_publish_stats(linx_websocket_protocol_t* ws_protocol);
+static void linx_websocket_deflate_accept(linx_websocket_protocol_t* ws_protocol, struct mg_http_message* hm);
+static bool linx_websocket_inflate(linx_websocket_protocol_t* ws_protocol, const char** data, size_t* size);
 static char* extract_json_string_value(const cJSON* json, const char* key);
 static int extract_json_int_value(const cJSON* json, const char* key);
 static bool linx_websocket_protocol_set_server_url(linx_websocket_protocol_t* ws_protocol, const char* url);
@@ -47,15 +379,111 @@ static bool linx_websocket_protocol_set_server(linx_websocket_protocol_t* ws_pro
 static bool linx_websocket_protocol_set_auth_token(linx_websocket_protocol_t* ws_protocol, const char* token);
 static bool linx_websocket_protocol_set_device_id(linx_websocket_protocol_t* ws_protocol, const char* device_id);
 static bool linx_websocket_protocol_set_client_id(linx_websocket_protocol_t* ws_protocol, const char* client_id);
+static void linx_websocket_dispatch_audio(linx_websocket_protocol_t* ws_protocol,
+                                          const linx_protocol_callbacks_t* callbacks, const uint8_t* payload,
+                                          size_t payload_size, uint32_t timestamp, uint16_t sequence);
+static void linx_websocket_deliver_text(linx_websocket_protocol_t* ws_protocol, linx_websocket_stream_t* stream,
+                                        const char* type, const char* text, size_t size);
+static bool linx_websocket_on_loop_thread(const linx_websocket_protocol_t* ws_protocol);
+static bool linx_websocket_send_queue_push(linx_websocket_send_queue_t* queue, linx_websocket_send_item_t* item);
+static linx_websocket_send_item_t* linx_websocket_send_queue_take(linx_websocket_send_queue_t* queue);
+static void linx_websocket_send_queue_clear(linx_websocket_protocol_t* ws_protocol,
+                                           linx_websocket_send_queue_t* queue);
+static void linx_websocket_flush_send_queues(linx_websocket_protocol_t* ws_protocol);
+static bool linx_websocket_audio_items_create(linx_websocket_protocol_t* ws_protocol);
+static void linx_websocket_audio_items_destroy(linx_websocket_protocol_t* ws_protocol);
+static linx_websocket_send_item_t* linx_websocket_audio_item_acquire(linx_websocket_protocol_t* ws_protocol,
+                                                                     size_t payload_size);
+static void linx_websocket_send_item_release(linx_websocket_protocol_t* ws_protocol,
+                                             linx_websocket_send_item_t* item);
+static bool linx_websocket_submit_audio(linx_websocket_protocol_t* ws_protocol, uint8_t stream_id,
+                                        const linx_audio_stream_packet_t* packet, uint16_t sequence);
+static bool linx_websocket_send_audio_now(linx_websocket_protocol_t* ws_protocol, uint8_t stream_id,
+                                          const uint8_t* payload, size_t payload_size, uint32_t timestamp,
+                                          uint16_t sequence);
+static bool linx_websocket_submit_text(linx_websocket_protocol_t* ws_protocol, const char* text, size_t len);
+static void linx_websocket_send_ping_now(linx_websocket_protocol_t* ws_protocol);
+static void linx_websocket_handle_pong(linx_websocket_protocol_t* ws_protocol, const struct mg_ws_message* wm);
+static void linx_websocket_keepalive(linx_websocket_protocol_t* ws_protocol);
+static void linx_websocket_keepalive_arm(linx_websocket_protocol_t* ws_protocol);
+static void linx_websocket_keepalive_timer(linx_timer_t* timer, void* user_data);
+static bool linx_websocket_send_control(linx_protocol_t* protocol, const linx_control_message_t* message);
+static bool linx_websocket_submit_control(linx_websocket_protocol_t* ws_protocol, uint8_t stream_id,
+                                          const linx_control_message_t* message);
+static void linx_websocket_handle_control(linx_websocket_protocol_t* ws_protocol,
+                                          const linx_protocol_callbacks_t* callbacks, const uint8_t* payload,
+                                          size_t size);
+static bool linx_websocket_stream_start(linx_protocol_t* protocol);
+static bool linx_websocket_stream_send_audio(linx_protocol_t* protocol, linx_audio_stream_packet_t* packet);
+static bool linx_websocket_stream_send_text(linx_protocol_t* protocol, const char* text);
+static bool linx_websocket_stream_send_control(linx_protocol_t* protocol, const linx_control_message_t* message);
+static void linx_websocket_stream_handle_text(linx_websocket_protocol_t* ws_protocol, int stream_id,
+                                              const char* type, const char* text, size_t size);
+static void linx_websocket_stream_handle_binary(linx_websocket_protocol_t* ws_protocol, uint8_t stream_id,
+                                                linx_binary_frame_result_t result, const uint8_t* payload,
+                                                size_t payload_size, uint32_t timestamp, uint16_t sequence);
+static void linx_websocket_stream_handle_hello(linx_websocket_stream_t* stream, const cJSON* root);
+static void linx_websocket_stream_mark_closed(linx_websocket_stream_t* stream);
+static void linx_websocket_streams_open(linx_websocket_protocol_t* ws_protocol);
+static void linx_websocket_streams_close(linx_websocket_protocol_t* ws_protocol);
+static void linx_websocket_publish_backlog(linx_websocket_protocol_t* ws_protocol);
+static void linx_websocket_io_open(linx_websocket_protocol_t* ws_protocol, struct mg_connection* conn);
+static bool linx_websocket_io_reserve(linx_websocket_protocol_t* ws_protocol, size_t size);
+static void linx_websocket_io_check_recv(linx_websocket_protocol_t* ws_protocol, struct mg_connection* conn);
+static void linx_websocket_io_trim(linx_websocket_protocol_t* ws_protocol);
+static void linx_websocket_handle_frame(linx_websocket_protocol_t* ws_protocol, const char* data, size_t size,
+                                        uint8_t flags);
+static void linx_websocket_deliver_json(linx_websocket_protocol_t* ws_protocol, linx_websocket_stream_t* stream,
+                                        cJSON* json);
+static void linx_websocket_rx_attach(linx_websocket_protocol_t* ws_protocol, struct mg_connection* conn);
+static void linx_websocket_rx_reset(linx_websocket_protocol_t* ws_protocol);
+static void linx_websocket_flow_update(linx_websocket_protocol_t* ws_protocol);
+static void linx_websocket_flow_resume(linx_websocket_protocol_t* ws_protocol);
+#if LINX_WEBSOCKET_TLS_RESUME
+static void linx_websocket_tls_session_apply(linx_websocket_protocol_t* ws_protocol, struct mg_connection* conn);
+static void linx_websocket_tls_session_save(linx_websocket_protocol_t* ws_protocol, struct mg_connection* conn);
+#endif
+static int linx_websocket_flow_poll_timeout(const linx_websocket_protocol_t* ws_protocol, int timeout_ms);
+static void linx_websocket_send_idle(linx_websocket_protocol_t* ws_protocol);
+static linx_websocket_priority_t linx_websocket_text_priority(const linx_websocket_protocol_t* ws_protocol,
+                                                              const char* text, size_t size);
+static bool linx_websocket_bulk_submit(linx_websocket_protocol_t* ws_protocol, linx_websocket_send_item_t* item);
+static void linx_websocket_bulk_append(linx_websocket_protocol_t* ws_protocol, linx_websocket_send_item_t* item);
+static void linx_websocket_bulk_pump(linx_websocket_protocol_t* ws_protocol);
+static void linx_websocket_bulk_clear(linx_websocket_protocol_t* ws_protocol);
+static bool linx_websocket_open_connection(linx_websocket_protocol_t* ws_protocol);
+static bool linx_websocket_schedule_reconnect(linx_websocket_protocol_t* ws_protocol);
+static void linx_websocket_run_reconnect(linx_websocket_protocol_t* ws_protocol);
+static void linx_websocket_reconnect_timer(linx_timer_t* timer, void* user_data);
+static void linx_websocket_cancel_reconnect(linx_websocket_protocol_t* ws_protocol);
+static bool linx_websocket_dns_lookup(const char* url, struct mg_addr* addr);
+static void linx_websocket_dns_store(const char* url, const struct mg_addr* addr, int ttl_ms);
+static void linx_websocket_dns_forget(const char* url);
+static void linx_websocket_reactor_on_poll(void* user_data);
+static int linx_websocket_reactor_next_timeout(void* user_data, int idle_ms);
+static void linx_websocket_start_task(void* arg);
+static void linx_websocket_rtt_probe_cancel(linx_websocket_protocol_t* ws_protocol);
+static void linx_websocket_stop_task(void* arg);
+static void linx_websocket_detach_task(void* arg);
 
 /* Protocol vtable for WebSocket implementation */
 static const linx_protocol_vtable_t linx_websocket_vtable = {
     .start = linx_websocket_start,
     .send_audio = linx_websocket_send_audio,
     .send_text = linx_websocket_send_text,
+    .send_control = linx_websocket_send_control,
     .destroy = linx_websocket_destroy
 };
 
+/* Protocol vtable for a stream multiplexed on a connection */
+static const linx_protocol_vtable_t linx_websocket_stream_vtable = {
+    .start = linx_websocket_stream_start,
+    .send_audio = linx_websocket_stream_send_audio,
+    .send_text = linx_websocket_stream_send_text,
+    .send_control = linx_websocket_stream_send_control,
+    .destroy = linx_websocket_stream_destroy
+};
+
 /* WebSocket protocol creation and destruction */
 linx_websocket_protocol_t* linx_websocket_protocol_create(const linx_websocket_config_t* config) {
     LOG_DEBUG("Creating WebSocket protocol with config: %p", config);
@@ -65,27 +493,44 @@ linx_websocket_protocol_t* linx_websocket_protocol_create(const linx_websocket_c
         return NULL;
     }
     
-    linx_websocket_protocol_t* ws_protocol = malloc(sizeof(linx_websocket_protocol_t));
+    linx_websocket_protocol_t* ws_protocol = LINX_MALLOC(sizeof(linx_websocket_protocol_t));
     if (!ws_protocol) {
         LOG_ERROR("WebSocket protocol creation failed: memory allocation failed");
         return NULL;
     }
     
     memset(ws_protocol, 0, sizeof(linx_websocket_protocol_t));
+    pthread_mutex_init(&ws_protocol->deflate_mutex, NULL);
+    pthread_mutex_init(&ws_protocol->stream_mutex, NULL);
     
     /* Initialize base protocol */
     linx_protocol_init(&ws_protocol->base, &linx_websocket_vtable);
     
     //设置log等级
     mg_log_set(MG_LL_INFO);
-    /* Initialize mongoose manager */
-    mg_mgr_init(&ws_protocol->mgr);
+    if (config->reactor) {
+        /* Shared loop: the reactor owns the manager and its wakeup pipe */
+        ws_protocol->reactor = config->reactor;
+        ws_protocol->mgr = linx_reactor_get_mgr(config->reactor);
+        ws_protocol->wakeup_enabled = linx_reactor_wakeup_enabled(config->reactor);
+    } else {
+        /* Initialize mongoose manager */
+        ws_protocol->mgr = &ws_protocol->own_mgr;
+        mg_mgr_init(ws_protocol->mgr);
+        
+        /* Wakeup pipe lets other threads interrupt a blocking mg_mgr_poll */
+        ws_protocol->wakeup_enabled = mg_wakeup_init(ws_protocol->mgr);
+        if (!ws_protocol->wakeup_enabled) {
+            LOG_WARN("WebSocket wakeup pipe unavailable, event loop relies on poll timeout");
+        }
+    }
     
     /* Set default values */
     ws_protocol->connected = false;
     ws_protocol->audio_channel_opened = false;
     ws_protocol->version = 1;
     ws_protocol->server_hello_received = false;
+    ws_protocol->server_audio_format[0] = '\0';
     ws_protocol->running = false;
     ws_protocol->should_stop = false;
     ws_protocol->conn = NULL;
@@ -101,7 +546,7 @@ linx_websocket_protocol_t* linx_websocket_protocol_create(const linx_websocket_c
         if (!linx_websocket_protocol_set_server_url(ws_protocol, config->url)) {
             LOG_ERROR("Failed to set WebSocket server URL");
             linx_websocket_protocol_destroy(ws_protocol);
-            free(ws_protocol);
+            LINX_FREE(ws_protocol);
             return NULL;
         }
     } else if (config->host && config->path) {
@@ -110,13 +555,13 @@ linx_websocket_protocol_t* linx_websocket_protocol_create(const linx_websocket_c
         if (!linx_websocket_protocol_set_server(ws_protocol, config->host, config->port, config->path)) {
             LOG_ERROR("Failed to set WebSocket server configuration");
             linx_websocket_protocol_destroy(ws_protocol);
-            free(ws_protocol);
+            LINX_FREE(ws_protocol);
             return NULL;
         }
     } else {
         LOG_ERROR("WebSocket protocol creation failed: neither URL nor host+path provided");
         linx_websocket_protocol_destroy(ws_protocol);
-        free(ws_protocol);
+        LINX_FREE(ws_protocol);
         return NULL; /* Either url or host+path must be provided */
     }
     
@@ -126,7 +571,7 @@ linx_websocket_protocol_t* linx_websocket_protocol_create(const linx_websocket_c
         if (!linx_websocket_protocol_set_auth_token(ws_protocol, config->auth_token)) {
             LOG_ERROR("Failed to set WebSocket auth token");
             linx_websocket_protocol_destroy(ws_protocol);
-            free(ws_protocol);
+            LINX_FREE(ws_protocol);
             return NULL;
         }
     }
@@ -136,7 +581,7 @@ linx_websocket_protocol_t* linx_websocket_protocol_create(const linx_websocket_c
         if (!linx_websocket_protocol_set_device_id(ws_protocol, config->device_id)) {
             LOG_ERROR("Failed to set WebSocket device ID");
             linx_websocket_protocol_destroy(ws_protocol);
-            free(ws_protocol);
+            LINX_FREE(ws_protocol);
             return NULL;
         }
     }
@@ -146,7 +591,7 @@ linx_websocket_protocol_t* linx_websocket_protocol_create(const linx_websocket_c
         if (!linx_websocket_protocol_set_client_id(ws_protocol, config->client_id)) {
             LOG_ERROR("Failed to set WebSocket client ID");
             linx_websocket_protocol_destroy(ws_protocol);
-            free(ws_protocol);
+            LINX_FREE(ws_protocol);
             return NULL;
         }
     }
@@ -156,12 +601,230 @@ linx_websocket_protocol_t* linx_websocket_protocol_create(const linx_websocket_c
         LOG_DEBUG("Setting WebSocket protocol version: %d", config->protocol_version);
         ws_protocol->version = config->protocol_version;
     }
+#if LINX_WS_PROTOCOL_VERSION > 0
+    if (ws_protocol->version != LINX_WS_PROTOCOL_VERSION) {
+        LOG_WARN("WebSocket protocol v%d requested, this build is fixed to v%d",
+                 ws_protocol->version, LINX_WS_PROTOCOL_VERSION);
+        ws_protocol->version = LINX_WS_PROTOCOL_VERSION;
+    }
+#endif
+    ws_protocol->offered_version = ws_protocol->version;
 
     ws_protocol->client_audio_format = config->client_audio_format;
     ws_protocol->audio_sample_rate = config->audio_sample_rate;
     ws_protocol->audio_channels = config->audio_channels;
     ws_protocol->audio_frame_duration = config->audio_frame_duration;
     
+    /* Ranked candidates for the hello; without a list the single configured values are offered */
+    const char* format_list = config->audio_formats;
+    while (format_list && *format_list && ws_protocol->audio_format_count < LINX_WEBSOCKET_MAX_AUDIO_FORMATS) {
+        size_t len = strcspn(format_list, ", ");
+        if (len > 0 && len < sizeof(ws_protocol->audio_formats[0])) {
+            memcpy(ws_protocol->audio_formats[ws_protocol->audio_format_count], format_list, len);
+            ws_protocol->audio_formats[ws_protocol->audio_format_count++][len] = '\0';
+        }
+        format_list += len;
+        format_list += strspn(format_list, ", ");
+    }
+    if (ws_protocol->audio_format_count == 0) {
+        snprintf(ws_protocol->audio_formats[0], sizeof(ws_protocol->audio_formats[0]), "%s",
+                 config->client_audio_format ? config->client_audio_format : "opus");
+        ws_protocol->audio_format_count = 1;
+    }
+    int longest_frame_ms = config->audio_frame_duration;
+    for (int i = 0; i < LINX_WEBSOCKET_MAX_FRAME_DURATIONS && config->frame_durations[i] > 0; i++) {
+        ws_protocol->frame_durations[ws_protocol->frame_duration_count++] = config->frame_durations[i];
+        if (config->frame_durations[i] > longest_frame_ms) {
+            longest_frame_ms = config->frame_durations[i];
+        }
+    }
+    if (ws_protocol->frame_duration_count > 0) {
+        ws_protocol->audio_frame_duration = ws_protocol->frame_durations[0];
+    } else if (config->audio_frame_duration > 0) {
+        ws_protocol->frame_durations[ws_protocol->frame_duration_count++] = config->audio_frame_duration;
+    }
+    ws_protocol->audio_features_offer = config->audio_features;
+    
+    ws_protocol->auto_reconnect = config->auto_reconnect;
+    ws_protocol->reconnect_base_ms = config->reconnect_base_ms > 0 ?
+        config->reconnect_base_ms : LINX_WEBSOCKET_RECONNECT_BASE_MS;
+    ws_protocol->reconnect_max_ms = config->reconnect_max_ms > 0 ?
+        config->reconnect_max_ms : LINX_WEBSOCKET_RECONNECT_MAX_MS;
+    if (ws_protocol->reconnect_max_ms < ws_protocol->reconnect_base_ms) {
+        ws_protocol->reconnect_max_ms = ws_protocol->reconnect_base_ms;
+    }
+    ws_protocol->reconnect_max_attempts = config->reconnect_max_attempts > 0 ?
+        config->reconnect_max_attempts : 0;
+    
+    ws_protocol->dns_cache_ttl_ms = config->dns_cache_ttl_ms == 0 ? LINX_WEBSOCKET_DNS_CACHE_TTL_MS :
+                                    config->dns_cache_ttl_ms > 0 ? config->dns_cache_ttl_ms : 0;
+    ws_protocol->early_hello = config->early_hello;
+    if (config->mcp_tools_hash && !(ws_protocol->mcp_tools_hash = LINX_STRDUP(config->mcp_tools_hash))) {
+        LOG_WARN("WebSocket MCP tools hash dropped: memory allocation failed");
+    }
+    
+    ws_protocol->deflate_offer = config->text_deflate;
+    ws_protocol->deflate_config.window_bits = config->deflate_window_bits;
+    ws_protocol->deflate_config.dictionary = config->deflate_dictionary;
+    
+    ws_protocol->control_offer = config->binary_control;
+    /* Stream IDs ride in the binary frame header, which v1 does not have */
+    ws_protocol->mux_offer = config->multiplex && ws_protocol->version >= 2;
+    if (config->multiplex && !ws_protocol->mux_offer) {
+        LOG_WARN("WebSocket multiplexing needs protocol v2 or later (configured v%d)", ws_protocol->version);
+    }
+    ws_protocol->bulk_fragment = config->bulk_fragment_bytes > 0 ? (size_t)config->bulk_fragment_bytes :
+                                 LINX_WEBSOCKET_BULK_FRAGMENT;
+    
+    ws_protocol->io_initial = config->io_buffer_initial_bytes > 0 ? (size_t)config->io_buffer_initial_bytes :
+                              LINX_WEBSOCKET_IO_BUFFER_INITIAL;
+    ws_protocol->io_step = config->io_buffer_step_bytes > 0 ? (size_t)config->io_buffer_step_bytes :
+                           LINX_WEBSOCKET_IO_BUFFER_STEP;
+    ws_protocol->io_max = config->io_buffer_max_bytes < 0 ? SIZE_MAX :
+                          config->io_buffer_max_bytes > 0 ? (size_t)config->io_buffer_max_bytes :
+                          LINX_WEBSOCKET_IO_BUFFER_MAX;
+    if (ws_protocol->io_max < ws_protocol->io_initial) {
+        ws_protocol->io_max = ws_protocol->io_initial;
+    }
+    /* A bulk message goes out whole behind up to one fragment of backlog unless interleaved */
+    if (ws_protocol->io_max < ws_protocol->bulk_fragment * 2) {
+        LOG_WARN("WebSocket buffer limit %zu is below two bulk fragments (%zu bytes)",
+                 ws_protocol->io_max, ws_protocol->bulk_fragment);
+    }
+    ws_protocol->io_shrink_ms = config->io_buffer_shrink_ms < 0 ? 0 :
+                                config->io_buffer_shrink_ms > 0 ? config->io_buffer_shrink_ms :
+                                LINX_WEBSOCKET_IO_BUFFER_SHRINK_MS;
+    
+    /* A capture records whole messages, so it keeps the reassembling path */
+    ws_protocol->rx_enabled = config->stream_receive && !config->capture_path;
+    ws_protocol->rx_threshold = config->stream_threshold_bytes > 0 ? (size_t)config->stream_threshold_bytes :
+                                LINX_WEBSOCKET_STREAM_THRESHOLD;
+    
+    ws_protocol->json_limits.max_length = config->max_text_bytes < 0 ? 0 :
+                                          config->max_text_bytes > 0 ? (size_t)config->max_text_bytes :
+                                          LINX_WEBSOCKET_MAX_TEXT_BYTES;
+    ws_protocol->json_limits.max_depth = config->max_json_depth < 0 ? 0 :
+                                         config->max_json_depth > 0 ? (size_t)config->max_json_depth :
+                                         LINX_WEBSOCKET_MAX_JSON_DEPTH;
+    ws_protocol->json_limits.max_items = config->max_json_items < 0 ? 0 :
+                                         config->max_json_items > 0 ? (size_t)config->max_json_items :
+                                         LINX_WEBSOCKET_MAX_JSON_ITEMS;
+    
+    ws_protocol->keepalive_idle_ms = config->keepalive_idle_ms < 0 ? 0 :
+                                     config->keepalive_idle_ms > 0 ? config->keepalive_idle_ms :
+                                     LINX_WEBSOCKET_KEEPALIVE_IDLE_MS;
+    ws_protocol->keepalive_active_ms = config->keepalive_active_ms > 0 ? config->keepalive_active_ms :
+                                       LINX_WEBSOCKET_KEEPALIVE_ACTIVE_MS;
+    ws_protocol->keepalive_max_missed = config->keepalive_max_missed > 0 ? config->keepalive_max_missed :
+                                        LINX_WEBSOCKET_KEEPALIVE_MAX_MISSED;
+    
+    if (config->downlink_level && config->downlink_capacity_ms > 0) {
+        ws_protocol->flow_level = config->downlink_level;
+        ws_protocol->flow_user_data = config->downlink_level_user_data;
+        ws_protocol->flow_capacity_ms = config->downlink_capacity_ms;
+        ws_protocol->flow_high_ms = config->downlink_high_ms > 0 ? config->downlink_high_ms :
+                                    config->downlink_capacity_ms * 3 / 4;
+        ws_protocol->flow_low_ms = config->downlink_low_ms > 0 ? config->downlink_low_ms :
+                                   config->downlink_capacity_ms / 2;
+        if (ws_protocol->flow_low_ms >= ws_protocol->flow_high_ms) {
+            ws_protocol->flow_low_ms = ws_protocol->flow_high_ms / 2;
+        }
+    }
+    ws_protocol->flow_level_ms = -1;
+    
+    /* Replay feeds recorded server frames instead of dialling; it never reconnects */
+    if (config->replay_path) {
+        if (config->reactor) {
+            LOG_ERROR("WebSocket replay cannot run on a shared reactor");
+            linx_websocket_protocol_destroy(ws_protocol);
+            return NULL;
+        }
+        ws_protocol->replay = linx_ws_replay_open(config->replay_path);
+        if (!ws_protocol->replay) {
+            linx_websocket_protocol_destroy(ws_protocol);
+            return NULL;
+        }
+        int recorded_version = linx_ws_replay_get_protocol_version(ws_protocol->replay);
+        if (recorded_version > 0 && recorded_version != ws_protocol->version && LINX_WS_PROTOCOL_VERSION > 0) {
+            LOG_ERROR("WebSocket replay: capture uses protocol v%d, this build is fixed to v%d",
+                      recorded_version, ws_protocol->version);
+            linx_websocket_protocol_destroy(ws_protocol);
+            return NULL;
+        }
+        if (recorded_version > 0 && recorded_version != ws_protocol->version) {
+            LOG_WARN("WebSocket replay: capture uses protocol v%d, configured v%d; using the capture's",
+                     recorded_version, ws_protocol->version);
+            ws_protocol->version = recorded_version;
+            ws_protocol->offered_version = recorded_version;
+        }
+        ws_protocol->replay_speed = config->replay_speed;
+        ws_protocol->auto_reconnect = false;
+        ws_protocol->dns_cache_ttl_ms = 0;
+    }
+    if (config->capture_path) {
+        ws_protocol->capture = linx_ws_capture_create(config->capture_path, ws_protocol->version);
+        if (!ws_protocol->capture) {
+            LOG_WARN("WebSocket capture unavailable, continuing without recording");
+        }
+    }
+    if (config->record_path) {
+        char uplink_path[512];
+        char downlink_path[512];
+        snprintf(uplink_path, sizeof(uplink_path), "%s.up.opus", config->record_path);
+        snprintf(downlink_path, sizeof(downlink_path), "%s.down.opus", config->record_path);
+        ws_protocol->recorder = linx_ogg_recorder_create(uplink_path, downlink_path, 0, 0);
+        if (!ws_protocol->recorder) {
+            LOG_WARN("WebSocket audio recorder unavailable, continuing without recording");
+        }
+    }
+    
+    /* Per-session packet pool, sized for the longest frame duration the server may pick */
+    ws_protocol->packet_pool = linx_audio_packet_pool_create(
+        LINX_AUDIO_PACKET_POOL_DEFAULT_SLOTS,
+        linx_audio_packet_pool_payload_size(longest_frame_ms));
+    if (!ws_protocol->packet_pool) {
+        LOG_WARN("WebSocket packet pool unavailable, falling back to heap packets");
+    }
+    
+    /* Preallocated cross-thread audio send items: no heap traffic per uplink frame */
+    if (!linx_websocket_audio_items_create(ws_protocol)) {
+        LOG_WARN("WebSocket audio send item pool unavailable, falling back to heap items");
+    }
+    
+    /* Per-connection cJSON arena: one inbound message's tree lives here and is reclaimed at once */
+    ws_protocol->json_arena = linx_json_arena_create(LINX_JSON_ARENA_DEFAULT_CAPACITY);
+    if (!ws_protocol->json_arena) {
+        LOG_WARN("WebSocket JSON arena unavailable, falling back to heap allocation");
+    }
+    
+    /* Backoff and keepalive deadlines live on a timer wheel driven by the event loop */
+    linx_timer_init(&ws_protocol->reconnect_timer, linx_websocket_reconnect_timer, ws_protocol);
+    linx_timer_init(&ws_protocol->keepalive_timer, linx_websocket_keepalive_timer, ws_protocol);
+    if (ws_protocol->reactor) {
+        ws_protocol->timers = linx_reactor_get_timers(ws_protocol->reactor);
+    } else {
+        ws_protocol->timers = linx_timer_wheel_create(0, mg_millis);
+        if (!ws_protocol->timers) {
+            LOG_ERROR("WebSocket protocol creation failed: timer wheel allocation failed");
+            linx_websocket_protocol_destroy(ws_protocol);
+            LINX_FREE(ws_protocol);
+            return NULL;
+        }
+    }
+    
+    if (ws_protocol->reactor) {
+        ws_protocol->reactor_hook.on_poll = linx_websocket_reactor_on_poll;
+        ws_protocol->reactor_hook.next_timeout_ms = linx_websocket_reactor_next_timeout;
+        ws_protocol->reactor_hook.user_data = ws_protocol;
+        if (!linx_reactor_add_hook(ws_protocol->reactor, &ws_protocol->reactor_hook)) {
+            LOG_ERROR("Failed to register WebSocket protocol on the reactor");
+            ws_protocol->reactor_hook.on_poll = NULL;
+            linx_websocket_protocol_destroy(ws_protocol);
+            LINX_FREE(ws_protocol);
+            return NULL;
+        }
+    }
+    
     LOG_INFO("WebSocket protocol created successfully - version: %d, URL: %s", 
              ws_protocol->version, ws_protocol->server_url ? ws_protocol->server_url : "N/A");
     
@@ -176,48 +839,103 @@ static void linx_websocket_protocol_destroy(linx_websocket_protocol_t* ws_protoc
     
     LOG_DEBUG("Destroying WebSocket protocol");
     
+    /* Streams still alive outlive their carrier: cut them loose so they neither send nor get callbacks */
+    pthread_mutex_lock(&ws_protocol->stream_mutex);
+    for (int i = 0; i < LINX_WEBSOCKET_MAX_STREAMS; i++) {
+        if (ws_protocol->streams[i]) {
+            LOG_WARN("WebSocket stream %d still open while its connection is destroyed", i + 1);
+            ws_protocol->streams[i]->carrier = NULL;
+            ws_protocol->streams[i] = NULL;
+        }
+    }
+    pthread_mutex_unlock(&ws_protocol->stream_mutex);
+    
     /* Stop the protocol if running */
     linx_websocket_stop(ws_protocol);
     
-    /* Clean up connection */
-    if (ws_protocol->conn) {
-        LOG_DEBUG("Closing WebSocket connection");
-        ws_protocol->conn->is_closing = 1;
-        ws_protocol->conn = NULL;
+    if (ws_protocol->reactor) {
+        /* The manager outlives this instance: detach its connections so their close events are dropped */
+        if (ws_protocol->reactor_hook.on_poll) {
+            linx_reactor_remove_hook(ws_protocol->reactor, &ws_protocol->reactor_hook);
+        }
+        linx_reactor_run(ws_protocol->reactor, linx_websocket_detach_task, ws_protocol);
+    } else {
+        /* Clean up connection */
+        if (ws_protocol->conn) {
+            LOG_DEBUG("Closing WebSocket connection");
+            ws_protocol->conn->is_closing = 1;
+            ws_protocol->conn = NULL;
+        }
+        
+        /* Clean up mongoose manager */
+        mg_mgr_free(ws_protocol->mgr);
+        linx_timer_wheel_destroy(ws_protocol->timers);
+        ws_protocol->timers = NULL;
     }
     
-    /* Clean up mongoose manager */
-    mg_mgr_free(&ws_protocol->mgr);
-    
     /* Free allocated strings */
     if (ws_protocol->server_url) {
-        free(ws_protocol->server_url);
+        LINX_FREE(ws_protocol->server_url);
     }
     if (ws_protocol->server_host) {
-        free(ws_protocol->server_host);
+        LINX_FREE(ws_protocol->server_host);
     }
     if (ws_protocol->server_path) {
-        free(ws_protocol->server_path);
+        LINX_FREE(ws_protocol->server_path);
     }
     if (ws_protocol->auth_token) {
-        free(ws_protocol->auth_token);
+        LINX_FREE(ws_protocol->auth_token);
     }
     if (ws_protocol->device_id) {
-        free(ws_protocol->device_id);
+        LINX_FREE(ws_protocol->device_id);
     }
     if (ws_protocol->client_id) {
-        free(ws_protocol->client_id);
+        LINX_FREE(ws_protocol->client_id);
     }
+    LINX_FREE(ws_protocol->session_id);
+    linx_json_writer_free(&ws_protocol->hello_cache);
+    LINX_FREE(ws_protocol->mcp_tools_hash);
+    LINX_FREE(ws_protocol->tls_session);
+    
+    linx_ws_capture_destroy(ws_protocol->capture);
+    ws_protocol->capture = NULL;
+    linx_ogg_recorder_destroy(ws_protocol->recorder);
+    ws_protocol->recorder = NULL;
+    linx_ws_deflate_destroy(ws_protocol->deflate);
+    ws_protocol->deflate = NULL;
+    linx_ws_replay_close(ws_protocol->replay);
+    ws_protocol->replay = NULL;
+    
+    /* Drop frames that were never sent */
+    linx_websocket_send_queue_clear(ws_protocol, &ws_protocol->urgent_queue);
+    linx_websocket_send_queue_clear(ws_protocol, &ws_protocol->audio_queue);
+    linx_websocket_send_queue_clear(ws_protocol, &ws_protocol->text_queue);
+    linx_websocket_send_queue_clear(ws_protocol, &ws_protocol->bulk_queue);
+    linx_websocket_bulk_clear(ws_protocol);
+    linx_websocket_audio_items_destroy(ws_protocol);
+    
+    LINX_FREE(ws_protocol->idle_buffer);
+    ws_protocol->idle_buffer = NULL;
+    
+    /* Release packet pool */
+    linx_audio_packet_pool_destroy(ws_protocol->packet_pool);
+    ws_protocol->packet_pool = NULL;
+    
+    /* Release JSON arena */
+    linx_json_arena_destroy(ws_protocol->json_arena);
+    ws_protocol->json_arena = NULL;
+    linx_websocket_rx_reset(ws_protocol);
+    linx_json_stream_destroy(ws_protocol->rx_json);
+    ws_protocol->rx_json = NULL;
     
     /* Clean up base protocol resources directly (avoid recursive call) */
-    if (ws_protocol->base.session_id) {
-        free(ws_protocol->base.session_id);
-        ws_protocol->base.session_id = NULL;
-    }
+    linx_protocol_deinit(&ws_protocol->base);
+    pthread_mutex_destroy(&ws_protocol->deflate_mutex);
+    pthread_mutex_destroy(&ws_protocol->stream_mutex);
     
     LOG_INFO("WebSocket protocol destroyed successfully");
     
-    free(ws_protocol);
+    LINX_FREE(ws_protocol);
 }
 
 /* Internal configuration functions */
@@ -227,10 +945,10 @@ static bool linx_websocket_protocol_set_server_url(linx_websocket_protocol_t* ws
     }
     
     if (ws_protocol->server_url) {
-        free(ws_protocol->server_url);
+        LINX_FREE(ws_protocol->server_url);
     }
     
-    ws_protocol->server_url = strdup(url);
+    ws_protocol->server_url = LINX_STRDUP(url);
     return ws_protocol->server_url != NULL;
 }
 
@@ -244,24 +962,24 @@ static bool linx_websocket_protocol_set_server(linx_websocket_protocol_t* ws_pro
     
     /* Free existing values */
     if (ws_protocol->server_host) {
-        free(ws_protocol->server_host);
+        LINX_FREE(ws_protocol->server_host);
     }
     if (ws_protocol->server_path) {
-        free(ws_protocol->server_path);
+        LINX_FREE(ws_protocol->server_path);
     }
     if (ws_protocol->server_url) {
-        free(ws_protocol->server_url);
+        LINX_FREE(ws_protocol->server_url);
     }
     
     /* Set new values */
-    ws_protocol->server_host = strdup(host);
+    ws_protocol->server_host = LINX_STRDUP(host);
     ws_protocol->server_port = port;
-    ws_protocol->server_path = strdup(path);
+    ws_protocol->server_path = LINX_STRDUP(path);
     
     /* Construct URL */
     char url[512];
     snprintf(url, sizeof(url), "ws://%s:%d%s", host, port, path);
-    ws_protocol->server_url = strdup(url);
+    ws_protocol->server_url = LINX_STRDUP(url);
     
     return ws_protocol->server_host && ws_protocol->server_path && ws_protocol->server_url;
 }
@@ -272,10 +990,10 @@ static bool linx_websocket_protocol_set_auth_token(linx_websocket_protocol_t* ws
     }
     
     if (ws_protocol->auth_token) {
-        free(ws_protocol->auth_token);
+        LINX_FREE(ws_protocol->auth_token);
     }
     
-    ws_protocol->auth_token = strdup(token);
+    ws_protocol->auth_token = LINX_STRDUP(token);
     return ws_protocol->auth_token != NULL;
 }
 
@@ -285,10 +1003,10 @@ static bool linx_websocket_protocol_set_device_id(linx_websocket_protocol_t* ws_
     }
     
     if (ws_protocol->device_id) {
-        free(ws_protocol->device_id);
+        LINX_FREE(ws_protocol->device_id);
     }
     
-    ws_protocol->device_id = strdup(device_id);
+    ws_protocol->device_id = LINX_STRDUP(device_id);
     return ws_protocol->device_id != NULL;
 }
 
@@ -298,179 +1016,164 @@ static bool linx_websocket_protocol_set_client_id(linx_websocket_protocol_t* ws_
     }
     
     if (ws_protocol->client_id) {
-        free(ws_protocol->client_id);
+        LINX_FREE(ws_protocol->client_id);
     }
     
-    ws_protocol->client_id = strdup(client_id);
+    ws_protocol->client_id = LINX_STRDUP(client_id);
     return ws_protocol->client_id != NULL;
 }
 
 /* Public configuration function */
 
 
+/* Tap for the Ogg recorder: only the connection's own session, only Opus, never re-encoded */
+static void linx_websocket_record_audio(linx_websocket_protocol_t* ws_protocol,
+                                        linx_ogg_recorder_direction_t direction,
+                                        const uint8_t* payload, size_t payload_size) {
+    const char* format = ws_protocol->server_audio_format[0] ? ws_protocol->server_audio_format
+                       : ws_protocol->audio_formats[0];
+    if (strcasecmp(format, "opus") == 0) {
+        linx_ogg_recorder_write(ws_protocol->recorder, direction, payload, payload_size,
+                                ws_protocol->audio_sample_rate, ws_protocol->audio_channels);
+    }
+}
+
+/**
+ * 将接收到的音频载荷以零拷贝视图的形式交给上层回调
+ * payload 指向 mongoose 的接收缓冲区，只在本次回调期间有效，
+ * 上层需要保留数据时应调用 linx_audio_stream_packet_retain()
+ */
+static void linx_websocket_dispatch_audio(linx_websocket_protocol_t* ws_protocol,
+                                          const linx_protocol_callbacks_t* callbacks, const uint8_t* payload,
+                                          size_t payload_size, uint32_t timestamp, uint16_t sequence) {
+    linx_audio_stream_packet_t packet;
+    linx_audio_stream_packet_init_view(&packet, payload, payload_size);
+    packet.sample_rate = ws_protocol->audio_sample_rate;
+    packet.frame_duration = ws_protocol->audio_frame_duration;
+    packet.timestamp = timestamp;
+    packet.sequence = sequence;
+    packet.has_sequence = LINX_WS_FRAME_VERSION(ws_protocol) == 4;
+    __atomic_store_n(&ws_protocol->last_audio_ms, mg_millis(), __ATOMIC_RELAXED);
+    if (ws_protocol->recorder && callbacks == &ws_protocol->base.callbacks) {
+        linx_websocket_record_audio(ws_protocol, LINX_OGG_RECORDER_DOWNLINK, payload, payload_size);
+    }
+    
+    /* Steady-state downlink path: the receiver must not touch the heap per frame */
+    linx_alloc_no_alloc_enter();
+    callbacks->on_incoming_audio(&packet, callbacks->user_data);
+    linx_alloc_no_alloc_leave();
+}
+
 /* Event handler for mongoose WebSocket events */
 static void linx_websocket_event_handler(struct mg_connection* conn, int ev, void* ev_data) {
     linx_websocket_protocol_t* ws_protocol = (linx_websocket_protocol_t*)conn->fn_data;
     
     if (!ws_protocol) {
-        LOG_ERROR("WebSocket event handler called with NULL protocol");
+        /* Connection left behind on a shared reactor by a destroyed instance */
         return;
     }
     
     switch (ev) {
+        case MG_EV_RESOLVE: {
+            /* Remember the address so the next dial can skip DNS */
+            if (!ws_protocol->dialed_cached_addr && ws_protocol->dns_cache_ttl_ms > 0) {
+                linx_websocket_dns_store(ws_protocol->server_url, &conn->rem, ws_protocol->dns_cache_ttl_ms);
+            }
+            break;
+        }
+        
         case MG_EV_CONNECT: {
             /* Connection established, WebSocket upgrade will happen automatically */
             LOG_DEBUG("WebSocket TCP connection established");
+            if (mg_url_is_ssl(ws_protocol->server_url)) {
+                /* SNI and certificate name come from the configured URL, not a cached address */
+                struct mg_tls_opts opts;
+                memset(&opts, 0, sizeof(opts));
+                opts.name = mg_url_host(ws_protocol->server_url);
+#if LINX_WEBSOCKET_TLS_RESUME
+                /* Hold the ClientHello back until the saved session is in place */
+                conn->is_connecting = 1;
+                mg_tls_init(conn, &opts);
+                conn->is_connecting = 0;
+                if (conn->tls && !conn->is_closing) {
+                    linx_websocket_tls_session_apply(ws_protocol, conn);
+                    mg_tls_handshake(conn);
+                }
+#else
+                mg_tls_init(conn, &opts);
+#endif
+            }
             break;
         }
         
         case MG_EV_WS_OPEN: {
-            /* WebSocket connection opened */
-            LOG_INFO("WebSocket connection opened successfully");
-            ws_protocol->connected = true;
-            if (ws_protocol->base.callbacks.on_connected) {
-                ws_protocol->base.callbacks.on_connected(ws_protocol->base.callbacks.user_data);
-            }
-            
-            /* Send hello message */
-            char* hello_msg = linx_websocket_get_hello_message(ws_protocol);
-            if (hello_msg) {
-                LOG_DEBUG("Sending WebSocket hello message");
-                mg_ws_send(conn, hello_msg, strlen(hello_msg), WEBSOCKET_OP_TEXT);
-                free(hello_msg);
-            } else {
-                LOG_ERROR("Failed to generate WebSocket hello message");
-            }
+#if LINX_WEBSOCKET_TLS_RESUME
+            linx_websocket_tls_session_save(ws_protocol, conn);
+#endif
+            linx_websocket_deflate_accept(ws_protocol, (struct mg_http_message*)ev_data);
+            linx_websocket_rx_attach(ws_protocol, conn);
+            linx_websocket_handle_open(ws_protocol);
             break;
         }
         
         case MG_EV_WS_MSG: {
             /* WebSocket message received */
             struct mg_ws_message* wm = (struct mg_ws_message*)ev_data;
-            
-            if (wm->flags & WEBSOCKET_OP_TEXT) {
-                /* Text message - parse as JSON */
-                LOG_DEBUG("WebSocket received text message (length: %zu)", wm->data.len);
-                LOG_DEBUG("WebSocket message content: %.*s", (int)wm->data.len, (const char*)wm->data.buf);
-                
-                cJSON* json = cJSON_ParseWithLength((const char*)wm->data.buf, wm->data.len);
-                if (!json) {
-                    LOG_ERROR("WebSocket failed to parse JSON message");
-                    return;
-                }
-
-               
-
-                
-                cJSON* type = cJSON_GetObjectItem(json, "type");
-                if (!cJSON_IsString(type) || !type->valuestring) {
-                    LOG_ERROR("WebSocket invalid or missing message type");
-                    cJSON_Delete(json);
-                    return;
-                }
-                
-                LOG_DEBUG("WebSocket message type: %s", type->valuestring);
-                
-                /* Handle different message types */
-                if (strcmp(type->valuestring, "hello") == 0) {
-                    /* Server hello message - handle internally */
-                    LOG_INFO("WebSocket processing server hello message");
-                    char* json_string = cJSON_Print(json);
-                    if (json_string) {
-                        linx_websocket_parse_server_hello(ws_protocol, json_string);
-                        LOG_INFO("WebSocket server hello processed successfully");
-                        free(json_string);
-                    } else {
-                        LOG_ERROR("WebSocket failed to serialize hello message");
-                    }
-                } 
-
-                /* Other message types - call user callback */
-                if (ws_protocol->base.callbacks.on_incoming_json) {
-                    ws_protocol->base.callbacks.on_incoming_json(json, ws_protocol->base.callbacks.user_data);
-                    LOG_DEBUG("WebSocket user callback executed for type: %s", type->valuestring);
-                } else {
-                    LOG_DEBUG("WebSocket no user callback registered");
+            linx_websocket_handle_frame(ws_protocol, (const char*)wm->data.buf, wm->data.len, wm->flags);
+            break;
+        }
+        
+        case MG_EV_READ: {
+            /* Any bytes at all prove the path is alive, even while a pong is stuck behind TTS audio */
+            ws_protocol->last_rx_ms = mg_millis();
+            ws_protocol->probes_missed = 0;
+            linx_protocol_mark_incoming(&ws_protocol->base);
+            linx_websocket_io_check_recv(ws_protocol, conn);
+            break;
+        }
+        
+        case MG_EV_WS_CTL: {
+            /* Control frame; a pong closes the RTT measurement started by its ping */
+            struct mg_ws_message* wm = (struct mg_ws_message*)ev_data;
+            if ((wm->flags & 0x0F) == WEBSOCKET_OP_PONG) {
+                linx_websocket_handle_pong(ws_protocol, wm);
+            }
+            break;
+        }
+        
+        case MG_EV_POLL:
+        case MG_EV_WAKEUP: {
+            /* Flush frames queued by other threads; they go out in this poll's write */
+            if (ws_protocol->connected) {
+                linx_websocket_flush_send_queues(ws_protocol);
+                if (__atomic_exchange_n(&ws_protocol->ping_requested, false, __ATOMIC_ACQUIRE)) {
+                    linx_websocket_send_ping_now(ws_protocol);
                 }
-              
-
-                cJSON_Delete(json);
-            } else if (wm->flags & WEBSOCKET_OP_BINARY) {
-               
-                /* Binary message - parse as audio data based on protocol version */
-                if (ws_protocol->base.callbacks.on_incoming_audio) {
-                    if (ws_protocol->version == 2) {
-                        /* Use binary protocol v2 */
-                        if (wm->data.len >= sizeof(linx_binary_protocol2_t)) {
-                            linx_binary_protocol2_t* bp2 = (linx_binary_protocol2_t*)wm->data.buf;
-                            uint16_t version = ntohs(bp2->version);
-                            uint16_t type = ntohs(bp2->type);
-                            uint32_t timestamp = ntohl(bp2->timestamp);
-                            uint32_t payload_size = ntohl(bp2->payload_size);
-                            
-                            if (type == 0 && payload_size > 0) { /* Audio data */
-                                linx_audio_stream_packet_t* packet = linx_audio_stream_packet_create(payload_size);
-                                if (packet) {
-                                    packet->sample_rate = ws_protocol->audio_sample_rate;
-                                    packet->frame_duration = ws_protocol->audio_frame_duration;
-                                    packet->timestamp = timestamp;
-                                    memcpy(packet->payload, bp2->payload, payload_size);
-                                    
-                                    ws_protocol->base.callbacks.on_incoming_audio(packet, ws_protocol->base.callbacks.user_data);
-                                    linx_audio_stream_packet_destroy(packet);
-                                }
-                            }
-                        }
-                    } else if (ws_protocol->version == 3) {
-                        /* Use binary protocol v3 */
-                        if (wm->data.len >= sizeof(linx_binary_protocol3_t)) {
-                            linx_binary_protocol3_t* bp3 = (linx_binary_protocol3_t*)wm->data.buf;
-                            uint8_t type = bp3->type;
-                            uint16_t payload_size = ntohs(bp3->payload_size);
-                            
-                            if (type == 0 && payload_size > 0) { /* Audio data */
-                                linx_audio_stream_packet_t* packet = linx_audio_stream_packet_create(payload_size);
-                                if (packet) {
-                                    packet->sample_rate = ws_protocol->audio_sample_rate;
-                                    packet->frame_duration = ws_protocol->audio_frame_duration;
-                                    packet->timestamp = 0; /* v3 protocol doesn't include timestamp */
-                                    memcpy(packet->payload, bp3->payload, payload_size);
-                                    
-                                    ws_protocol->base.callbacks.on_incoming_audio(packet, ws_protocol->base.callbacks.user_data);
-                                    linx_audio_stream_packet_destroy(packet);
-                                }
-                            }
-                        }
-                    } else {
-                        
-                        /* Fallback for unsupported protocol versions - treat as raw audio data */
-                        linx_audio_stream_packet_t* packet = linx_audio_stream_packet_create(wm->data.len);
-                        if (packet) {
-                            packet->sample_rate = ws_protocol->audio_sample_rate;
-                            packet->frame_duration = ws_protocol->audio_frame_duration;
-                            packet->timestamp = 0;
-                            memcpy(packet->payload, wm->data.buf, wm->data.len);
-                            
-                            LOG_DEBUG("[%s] Audio packet: %d bytes", __func__, wm->data.len);
-                            ws_protocol->base.callbacks.on_incoming_audio(packet, ws_protocol->base.callbacks.user_data);
-                            linx_audio_stream_packet_destroy(packet);
-                        }
-                    }
+                linx_websocket_keepalive_arm(ws_protocol);
+                linx_websocket_send_idle(ws_protocol);
+                /* While paused nothing arrives to trigger a check, so the player's drain is polled here */
+                if (ws_protocol->flow_paused || ws_protocol->flow_negotiated) {
+                    linx_websocket_flow_update(ws_protocol);
                 }
             }
+            if (ev == MG_EV_POLL) {
+                linx_websocket_io_trim(ws_protocol);
+            }
+            linx_websocket_publish_backlog(ws_protocol);
             break;
         }
         
-        case MG_EV_CLOSE: {
-            /* Connection closed */
-            LOG_INFO("WebSocket connection closed");
-            ws_protocol->connected = false;
-            ws_protocol->audio_channel_opened = false;
-            ws_protocol->conn = NULL;
-            
-            if (ws_protocol->base.callbacks.on_disconnected) {
-                ws_protocol->base.callbacks.on_disconnected(ws_protocol->base.callbacks.user_data);
+        case MG_EV_WRITE: {
+            /* The socket took some bytes: top the buffer up with the next bulk fragment */
+            if (ws_protocol->connected) {
+                linx_websocket_bulk_pump(ws_protocol);
             }
+            linx_websocket_publish_backlog(ws_protocol);
+            break;
+        }
+        
+        case MG_EV_CLOSE: {
+            linx_websocket_handle_close(ws_protocol);
             break;
         }
         
@@ -487,313 +1190,3078 @@ static void linx_websocket_event_handler(struct mg_connection* conn, int ev, voi
     }
 }
 
-/* Protocol implementation functions */
-bool linx_websocket_start(linx_protocol_t* protocol) {
-    linx_websocket_protocol_t* ws_protocol = (linx_websocket_protocol_t*)protocol;
-    
-    LOG_DEBUG("Starting WebSocket protocol");
-    
-    if (!ws_protocol || !ws_protocol->server_url) {
-        LOG_ERROR("Cannot start WebSocket: invalid protocol or missing server URL");
-        return false;
+/* One complete data message from mongoose or the streaming receiver; flags carry the first frame's opcode */
+static void linx_websocket_handle_frame(linx_websocket_protocol_t* ws_protocol, const char* data, size_t size,
+                                        uint8_t flags) {
+    LINX_TRACEPOINT(ws_rx, flags & 0x0F, size);
+    if (!(flags & (WEBSOCKET_OP_TEXT | WEBSOCKET_OP_BINARY))) {
+        return;
+    }
+    if ((flags & LINX_WEBSOCKET_FLAG_RSV1) && !linx_websocket_inflate(ws_protocol, &data, &size)) {
+        return;
+    }
+    linx_websocket_handle_message(ws_protocol, data, size, (flags & WEBSOCKET_OP_TEXT) != 0);
+}
+
+/* WebSocket upgrade finished; shared by live connections and replay */
+static void linx_websocket_handle_open(linx_websocket_protocol_t* ws_protocol) {
+    LOG_INFO("WebSocket connection opened successfully");
+    linx_ws_capture_write(ws_protocol->capture, LINX_WS_CAPTURE_OPEN, NULL, 0, NULL, 0);
+    ws_protocol->connected = true;
+    __atomic_store_n(&ws_protocol->reconnecting, false, __ATOMIC_RELAXED);
+    __atomic_store_n(&ws_protocol->tx_sequence, 0, __ATOMIC_RELAXED);
+    ws_protocol->tx_epoch_ms = mg_millis();
+    ws_protocol->last_rx_ms = ws_protocol->tx_epoch_ms;
+    ws_protocol->last_probe_ms = ws_protocol->tx_epoch_ms;
+    ws_protocol->probe_sent_ms = 0;
+    ws_protocol->probes_missed = 0;
+    ws_protocol->connection_dead = false;
+    if (ws_protocol->base.callbacks.on_connected) {
+        ws_protocol->base.callbacks.on_connected(ws_protocol->base.callbacks.user_data);
     }
     
-    LOG_INFO("Starting WebSocket connection to: %s", ws_protocol->server_url);
+    /* Send hello message; kept so failed reconnects do not rebuild it */
+    if (ws_protocol->hello_sent) {
+        return;
+    }
+    const char* hello = linx_websocket_get_hello_message(ws_protocol);
+    if (hello) {
+        LOG_DEBUG("Sending WebSocket hello message");
+        linx_websocket_write_message(ws_protocol, hello, ws_protocol->hello_cache.length, WEBSOCKET_OP_TEXT);
+        ws_protocol->hello_sent = true;
+    } else {
+        LOG_ERROR("Failed to generate WebSocket hello message");
+    }
+}
 
-    /* Create WebSocket connection with headers */
-    char headers[1024] = "";
+/* One inbound text or binary message; shared by live connections and replay */
+static void linx_websocket_handle_message(linx_websocket_protocol_t* ws_protocol, const char* data,
+                                          size_t size, bool is_text) {
+    linx_ws_capture_write(ws_protocol->capture, is_text ? LINX_WS_CAPTURE_IN_TEXT : LINX_WS_CAPTURE_IN_BINARY,
+                          data, size, NULL, 0);
+    bool multiplexed = __atomic_load_n(&ws_protocol->mux_enabled, __ATOMIC_RELAXED);
     
-    /* Build headers string */
-    if (ws_protocol->auth_token) {
-        char auth_header[512];
-        /* Add "Bearer " prefix if token doesn't have a space */
-        if (strchr(ws_protocol->auth_token, ' ') == NULL) {
-            snprintf(auth_header, sizeof(auth_header), "Authorization: Bearer %s\r\n", ws_protocol->auth_token);
+    if (is_text) {
+        /* Text message - parse as JSON, unless it is too big to even look at */
+        if (ws_protocol->json_limits.max_length > 0 && size > ws_protocol->json_limits.max_length) {
+            LOG_WARN_EVERY_MS(1000, "WebSocket dropped %zu byte text message (limit %zu)",
+                              size, ws_protocol->json_limits.max_length);
+            return;
+        }
+        LOG_DEBUG("WebSocket received text message (length: %zu)", size);
+        LOG_DEBUG("WebSocket message content: %.*s", (int)size, data);
+        
+        /* Scan the top-level "type" first so small hot-path messages can skip the cJSON tree */
+        linx_json_scan_field_t fields[2] = { { .key = "type" }, { .key = "stream" } };
+        char type_buf[32];
+        const char* type = NULL;
+        int stream_id = 0;
+        if (linx_json_scan_object(data, size, fields, multiplexed ? 2 : 1) >= 0) {
+            if (linx_json_scan_copy_string(&fields[0], type_buf, sizeof(type_buf)) == (size_t)-1) {
+                LOG_ERROR("WebSocket invalid or missing message type");
+                return;
+            }
+            type = type_buf;
+            stream_id = (int)linx_json_scan_number(&fields[1], 0);
+        }
+        
+        /* Messages tagged with a stream belong to that stream's session, untagged ones to the connection */
+        if (stream_id != 0) {
+            linx_websocket_stream_handle_text(ws_protocol, stream_id, type, data, size);
         } else {
-            snprintf(auth_header, sizeof(auth_header), "Authorization: %s\r\n", ws_protocol->auth_token);
+            linx_websocket_deliver_text(ws_protocol, NULL, type, data, size);
+        }
+    } else {
+       
+        /* Binary message - audio or a CBOR control message, framed by protocol version */
+        const uint8_t* payload = NULL;
+        size_t payload_size = 0;
+        uint32_t timestamp = 0;
+        uint16_t sequence = 0;
+        const int version = LINX_WS_FRAME_VERSION(ws_protocol);
+        linx_binary_frame_result_t result = linx_binary_frame_decode(
+            version, (const uint8_t*)data, size,
+            &payload, &payload_size, &timestamp, &sequence);
+        uint8_t stream_id = multiplexed ?
+            linx_binary_frame_get_stream(version, (const uint8_t*)data, size) : 0;
+        
+        if (result == LINX_BINARY_FRAME_TRUNCATED) {
+            LOG_WARN_EVERY_MS(1000, "WebSocket v%d frame truncated: payload_size=%zu, frame=%zu",
+                              version, payload_size, size);
+        } else if (stream_id != 0) {
+            linx_websocket_stream_handle_binary(ws_protocol, stream_id, result, payload, payload_size,
+                                                timestamp, sequence);
+        } else if (result == LINX_BINARY_FRAME_CONTROL) {
+            linx_websocket_handle_control(ws_protocol, &ws_protocol->base.callbacks, payload, payload_size);
+        } else if (result == LINX_BINARY_FRAME_AUDIO && ws_protocol->base.callbacks.on_incoming_audio) {
+            if (version < 2 || version > LINX_BINARY_PROTOCOL_MAX_VERSION) {
+                LOG_DEBUG_EVERY_N(50, "[%s] Audio packet: %zu bytes", __func__, size);
+            }
+            linx_websocket_dispatch_audio(ws_protocol, &ws_protocol->base.callbacks, payload, payload_size,
+                                          timestamp, sequence);
+            linx_websocket_flow_update(ws_protocol);
         }
-        strncat(headers, auth_header, sizeof(headers) - strlen(headers) - 1);
     }
+
+}
+
+/* Hand one JSON message to the connection's or a stream's callbacks; type is NULL when the scan failed */
+static void linx_websocket_deliver_text(linx_websocket_protocol_t* ws_protocol, linx_websocket_stream_t* stream,
+                                        const char* type, const char* text, size_t size) {
+    const linx_protocol_callbacks_t* callbacks = stream ? &stream->base.callbacks : &ws_protocol->base.callbacks;
     
-    if (ws_protocol->version > 0) {
-        char version_header[64];
-        snprintf(version_header, sizeof(version_header), "Protocol-Version: %d\r\n", ws_protocol->version);
-        strncat(headers, version_header, sizeof(headers) - strlen(headers) - 1);
+    /* hello and a stream's goodbye change session state, so they always take the full path */
+    if (type && callbacks->on_incoming_text && strcmp(type, "hello") != 0 &&
+        !(stream && strcmp(type, "goodbye") == 0) &&
+        callbacks->on_incoming_text(type, text, size, callbacks->user_data)) {
+        LOG_DEBUG("WebSocket fast path handled type: %s", type);
+        return;
     }
-    
-    if (ws_protocol->device_id) {
-        char device_header[256];
-        snprintf(device_header, sizeof(device_header), "Device-Id: %s\r\n", ws_protocol->device_id);
-        strncat(headers, device_header, sizeof(headers) - strlen(headers) - 1);
+
+    /* Every cJSON allocation from parse to cJSON_Delete comes from the arena */
+    linx_json_arena_scope_t arena_scope;
+    linx_json_arena_begin(ws_protocol->json_arena, &arena_scope);
+
+    cJSON* json = cJSON_ParseWithLimits(text, size, &ws_protocol->json_limits);
+    if (!json) {
+        LOG_ERROR("WebSocket failed to parse JSON message (malformed or over the depth/node limits)");
+    } else {
+        linx_websocket_deliver_json(ws_protocol, stream, json);
     }
+    linx_json_arena_end(&arena_scope);
+}
+
+/* Full path for one parsed message: hello handling, then the callbacks; takes ownership of json */
+static void linx_websocket_deliver_json(linx_websocket_protocol_t* ws_protocol, linx_websocket_stream_t* stream,
+                                        cJSON* json) {
+    const linx_protocol_callbacks_t* callbacks = stream ? &stream->base.callbacks : &ws_protocol->base.callbacks;
     
-    if (ws_protocol->client_id) {
-        char client_header[256];
-        snprintf(client_header, sizeof(client_header), "Client-Id: %s\r\n", ws_protocol->client_id);
-        strncat(headers, client_header, sizeof(headers) - strlen(headers) - 1);
+    cJSON* type_item = cJSON_GetObjectItemCaseSensitive(json, "type");
+    if (!cJSON_IsString(type_item) || !type_item->valuestring) {
+        LOG_ERROR("WebSocket invalid or missing message type");
+        cJSON_Delete(json);
+        return;
     }
     
-    ws_protocol->conn = mg_ws_connect(&ws_protocol->mgr, ws_protocol->server_url, 
-                                     linx_websocket_event_handler, ws_protocol, 
-                                     strlen(headers) > 0 ? "%s" : NULL, headers);
+    LOG_DEBUG("WebSocket message type: %s", type_item->valuestring);
     
-    if (!ws_protocol->conn) {
-        return false;
+    /* Handle different message types */
+    if (strcmp(type_item->valuestring, "hello") == 0) {
+        if (stream) {
+            /* The reply to a stream's hello opens that stream */
+            linx_websocket_stream_handle_hello(stream, json);
+        } else {
+            /* Server hello message - handle internally */
+            LOG_INFO("WebSocket processing server hello message");
+            if (linx_websocket_parse_server_hello(ws_protocol, json)) {
+                LOG_INFO("WebSocket server hello processed successfully");
+            } else {
+                LOG_ERROR("WebSocket failed to process server hello message");
+            }
+        }
+    } 
+
+    /* Other message types - call user callback */
+    if (callbacks->on_incoming_message) {
+        /* Hand over the type we already extracted so the receiver need not look it up again */
+        callbacks->on_incoming_message(json, type_item->valuestring, callbacks->user_data);
+        LOG_DEBUG("WebSocket user callback executed for type: %s", type_item->valuestring);
+    } else if (callbacks->on_incoming_json) {
+        callbacks->on_incoming_json(json, callbacks->user_data);
+        LOG_DEBUG("WebSocket user callback executed for type: %s", type_item->valuestring);
+    } else {
+        LOG_DEBUG("WebSocket no user callback registered");
     }
     
-    ws_protocol->running = true;
-    ws_protocol->should_stop = false;
-    
-    return true;
-}
-
-
-
+    /* The server ended this stream's session; the connection and the other streams carry on */
+    if (stream && strcmp(type_item->valuestring, "goodbye") == 0) {
+        linx_websocket_stream_mark_closed(stream);
+    }
 
+    cJSON_Delete(json);
+}
 
-bool linx_websocket_send_audio(linx_protocol_t* protocol, linx_audio_stream_packet_t* packet) {
-    linx_websocket_protocol_t* ws_protocol = (linx_websocket_protocol_t*)protocol;
+/* One inbound CBOR control message: fixed-struct fast path first, otherwise an equivalent cJSON tree */
+static void linx_websocket_handle_control(linx_websocket_protocol_t* ws_protocol,
+                                          const linx_protocol_callbacks_t* callbacks, const uint8_t* payload,
+                                          size_t size) {
+    linx_control_message_t message;
+    if (!linx_control_cbor_decode(payload, size, &message)) {
+        LOG_WARN_EVERY_MS(1000, "WebSocket dropped invalid CBOR control message (%zu bytes)", size);
+        return;
+    }
+    const char* type = linx_control_type_name(message.type);
+    LOG_DEBUG("WebSocket received CBOR control message: %s (%zu bytes)", type, size);
     
-    if (!ws_protocol || !ws_protocol->conn || !ws_protocol->connected || !packet) {
-        LOG_ERROR("Invalid websocket protocol or connection state");
-        return false;
+    if (callbacks->on_incoming_control && callbacks->on_incoming_control(&message, callbacks->user_data)) {
+        return;
     }
-    // LOG_DEBUG("Sending audio packet - Sample Rate: %d, Frame Duration: %d, Timestamp: %u, Payload Size: %zu, Version: %d", 
-    //           packet->sample_rate, packet->frame_duration, packet->timestamp, packet->payload_size, ws_protocol->version);
     
-    if (ws_protocol->version == 2) {
+    linx_json_arena_scope_t arena_scope;
+    linx_json_arena_begin(ws_protocol->json_arena, &arena_scope);
+    cJSON* json = linx_control_message_to_json(&message);
+    if (!json) {
+        LOG_ERROR("WebSocket failed to convert CBOR control message: %s", type);
+    } else if (callbacks->on_incoming_message) {
+        callbacks->on_incoming_message(json, type, callbacks->user_data);
+    } else if (callbacks->on_incoming_json) {
+        callbacks->on_incoming_json(json, callbacks->user_data);
+    }
+    cJSON_Delete(json);
+    linx_json_arena_end(&arena_scope);
+}
+
+/* Connection closed; shared by live connections and replay */
+static void linx_websocket_handle_close(linx_websocket_protocol_t* ws_protocol) {
+    LOG_INFO("WebSocket connection closed");
+    linx_ws_capture_write(ws_protocol->capture, LINX_WS_CAPTURE_CLOSE, NULL, 0, NULL, 0);
+    bool was_connected = ws_protocol->connected;
+    ws_protocol->connected = false;
+    if (!was_connected && ws_protocol->dialed_cached_addr) {
+        /* The cached address may be stale: resolve again next time */
+        LOG_WARN("WebSocket dial to cached address failed, dropping DNS cache entry");
+        linx_websocket_dns_forget(ws_protocol->server_url);
+    }
+    ws_protocol->server_hello_received = false;
+    linx_websocket_flow_resume(ws_protocol);
+    linx_ws_deflate_destroy(ws_protocol->deflate);
+    ws_protocol->deflate = NULL;
+    /* A bulk message cut off mid-fragment cannot be resumed on the next connection */
+    linx_websocket_send_queue_clear(ws_protocol, &ws_protocol->urgent_queue);
+    linx_websocket_send_queue_clear(ws_protocol, &ws_protocol->audio_queue);
+    linx_websocket_send_queue_clear(ws_protocol, &ws_protocol->text_queue);
+    linx_websocket_send_queue_clear(ws_protocol, &ws_protocol->bulk_queue);
+    linx_websocket_bulk_clear(ws_protocol);
+    ws_protocol->bulk_interleave = false;
+    ws_protocol->audio_channel_opened = false;
+    linx_websocket_rx_reset(ws_protocol);
+    ws_protocol->conn = NULL;
+    ws_protocol->probe_sent_ms = 0;
+    linx_timer_cancel(&ws_protocol->keepalive_timer);
+    __atomic_store_n(&ws_protocol->send_backlog_bytes, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&ws_protocol->rtt_valid, false, __ATOMIC_RELAXED);
+    
+    /* Failed reconnect attempts stay quiet; report the drop itself or giving up */
+    bool reconnecting = linx_websocket_schedule_reconnect(ws_protocol);
+    linx_websocket_streams_close(ws_protocol);
+    if ((was_connected || !reconnecting) && ws_protocol->base.callbacks.on_disconnected) {
+        ws_protocol->base.callbacks.on_disconnected(ws_protocol->base.callbacks.user_data);
+    }
+}
+
+/* Send one complete text or binary message and record it; replay discards it instead of writing */
+static bool linx_websocket_write_message(linx_websocket_protocol_t* ws_protocol, const void* data,
+                                         size_t size, int op) {
+    linx_ws_capture_write(ws_protocol->capture,
+                          op == WEBSOCKET_OP_TEXT ? LINX_WS_CAPTURE_OUT_TEXT : LINX_WS_CAPTURE_OUT_BINARY,
+                          data, size, NULL, 0);
+    if (ws_protocol->replay) {
+        __atomic_fetch_add(&ws_protocol->replay_stats.outbound, 1, __ATOMIC_RELAXED);
+        return true;
+    }
+    if (!ws_protocol->conn) {
+        return false;
+    }
+    LINX_TRACEPOINT(ws_tx, op, size);
+    /* Only text is compressed: Opus frames are already entropy coded */
+    const uint8_t* compressed = NULL;
+    size_t compressed_size = 0;
+    if (op == WEBSOCKET_OP_TEXT && ws_protocol->deflate &&
+        linx_ws_deflate_compress(ws_protocol->deflate, data, size, &compressed, &compressed_size)) {
+        linx_websocket_deflate_publish_stats(ws_protocol);
+        return linx_websocket_io_reserve(ws_protocol, compressed_size) &&
+               mg_ws_send(ws_protocol->conn, compressed, compressed_size, op | LINX_WEBSOCKET_FLAG_RSV1) > 0;
+    }
+    return linx_websocket_io_reserve(ws_protocol, size) && mg_ws_send(ws_protocol->conn, data, size, op) > 0;
+}
+
+/* Copy the compressor counters for readers on other threads */
+static void linx_websocket_deflate_publish_stats(linx_websocket_protocol_t* ws_protocol) {
+    pthread_mutex_lock(&ws_protocol->deflate_mutex);
+    linx_ws_deflate_get_stats(ws_protocol->deflate, &ws_protocol->deflate_stats);
+    pthread_mutex_unlock(&ws_protocol->deflate_mutex);
+}
+
+/* Read the server's answer to our permessage-deflate offer from the 101 response */
+static void linx_websocket_deflate_accept(linx_websocket_protocol_t* ws_protocol, struct mg_http_message* hm) {
+    linx_ws_deflate_destroy(ws_protocol->deflate);
+    ws_protocol->deflate = NULL;
+    if (!ws_protocol->deflate_offer || !hm) {
+        return;
+    }
+    struct mg_str* extensions = mg_http_get_header(hm, "Sec-WebSocket-Extensions");
+    struct mg_str* dictionary = mg_http_get_header(hm, "Linx-Deflate-Dictionary");
+    if (!extensions) {
+        LOG_DEBUG("WebSocket server did not accept permessage-deflate");
+        return;
+    }
+    ws_protocol->deflate = linx_ws_deflate_accept(&ws_protocol->deflate_config,
+                                                  extensions->buf, extensions->len,
+                                                  dictionary ? dictionary->buf : NULL,
+                                                  dictionary ? dictionary->len : 0);
+    if (ws_protocol->deflate) {
+        linx_websocket_deflate_publish_stats(ws_protocol);
+    }
+}
+
+/* Inflate a message with RSV1 set in place of the wire data; false drops the message */
+static bool linx_websocket_inflate(linx_websocket_protocol_t* ws_protocol, const char** data, size_t* size) {
+    if (!ws_protocol->deflate) {
+        LOG_WARN_EVERY_MS(1000, "WebSocket compressed message without negotiated deflate, dropping");
+        return false;
+    }
+    const uint8_t* plain = NULL;
+    size_t plain_size = 0;
+    bool ok = linx_ws_deflate_decompress(ws_protocol->deflate, *data, *size, &plain, &plain_size);
+    linx_websocket_deflate_publish_stats(ws_protocol);
+    if (!ok) {
+        return false;
+    }
+    *data = (const char*)plain;
+    *size = plain_size;
+    return true;
+}
+
+/* "scheme://<addr>:<port>/path" for `url`, with the host replaced by a resolved address */
+static bool linx_websocket_format_addr_url(const char* url, const struct mg_addr* addr, char* out, size_t size) {
+    const char* scheme_end = strstr(url, "://");
+    char ip[INET6_ADDRSTRLEN];
+    if (!scheme_end || !inet_ntop(addr->is_ip6 ? AF_INET6 : AF_INET, addr->ip, ip, sizeof(ip))) {
+        return false;
+    }
+    int n = snprintf(out, size, "%.*s://%s%s%s:%u%s", (int)(scheme_end - url), url,
+                     addr->is_ip6 ? "[" : "", ip, addr->is_ip6 ? "]" : "",
+                     (unsigned)ntohs(addr->port), mg_url_uri(url));
+    return n > 0 && (size_t)n < size;
+}
+
+/**
+ * mg_ws_connect() takes the Host header from the URL it dials. The upgrade
+ * request is still queued in c->send, so put the real server name back.
+ */
+static void linx_websocket_restore_host_header(struct mg_connection* c, struct mg_str host) {
+    static const char key[] = "\r\nHost: ";
+    struct mg_iobuf* io = &c->send;
+    for (size_t i = 0; i + sizeof(key) - 1 <= io->len; i++) {
+        if (memcmp(io->buf + i, key, sizeof(key) - 1) != 0) {
+            continue;
+        }
+        size_t start = i + sizeof(key) - 1;
+        size_t end = start;
+        while (end + 1 < io->len && !(io->buf[end] == '\r' && io->buf[end + 1] == '\n')) {
+            end++;
+        }
+        mg_iobuf_del(io, start, end - start);
+        mg_iobuf_add(io, start, host.buf, host.len);
+        return;
+    }
+}
+
+/* Protocol implementation functions */
+bool linx_websocket_start(linx_protocol_t* protocol) {
+    linx_websocket_protocol_t* ws_protocol = (linx_websocket_protocol_t*)protocol;
+    
+    LOG_DEBUG("Starting WebSocket protocol");
+    
+    if (!ws_protocol || !ws_protocol->server_url) {
+        LOG_ERROR("Cannot start WebSocket: invalid protocol or missing server URL");
+        return false;
+    }
+    
+    if (ws_protocol->replay) {
+        /* No network: the first recorded frame plays the part of the connection */
+        LOG_INFO("Starting WebSocket replay (speed %.2fx)", ws_protocol->replay_speed);
+        ws_protocol->replay_start_us = 0;
+        ws_protocol->running = true;
+        ws_protocol->should_stop = false;
+        return true;
+    }
+    
+    LOG_INFO("Starting WebSocket connection to: %s", ws_protocol->server_url);
+    
+    if (ws_protocol->reactor && !linx_reactor_in_loop(ws_protocol->reactor)) {
+        linx_websocket_task_op_t op = { ws_protocol, false };
+        linx_reactor_run(ws_protocol->reactor, linx_websocket_start_task, &op);
+        return op.result;
+    }
+    
+    linx_websocket_cancel_reconnect(ws_protocol);
+    __atomic_store_n(&ws_protocol->reconnect_attempts, 0, __ATOMIC_RELAXED);
+    ws_protocol->reconnect_delay_ms = 0;
+    
+    if (!linx_websocket_open_connection(ws_protocol)) {
+        return false;
+    }
+    
+    ws_protocol->running = true;
+    ws_protocol->should_stop = false;
+    
+    return true;
+}
+
+/* Dial the server on the existing manager; used by start and by reconnects */
+static bool linx_websocket_open_connection(linx_websocket_protocol_t* ws_protocol) {
+    /* The hook may switch to another server before this dial */
+    if (ws_protocol->dial_hook) {
+        ws_protocol->dial_hook(ws_protocol->dial_hook_user_data,
+                               __atomic_load_n(&ws_protocol->reconnect_attempts, __ATOMIC_RELAXED));
+    }
+    
+    /* Create WebSocket connection with headers */
+    char headers[1024] = "";
+    
+    /* Build headers string */
+    if (ws_protocol->auth_token) {
+        char auth_header[512];
+        /* Add "Bearer " prefix if token doesn't have a space */
+        if (strchr(ws_protocol->auth_token, ' ') == NULL) {
+            snprintf(auth_header, sizeof(auth_header), "Authorization: Bearer %s\r\n", ws_protocol->auth_token);
+        } else {
+            snprintf(auth_header, sizeof(auth_header), "Authorization: %s\r\n", ws_protocol->auth_token);
+        }
+        strncat(headers, auth_header, sizeof(headers) - strlen(headers) - 1);
+    }
+    
+    /* Every connection offers the configured version again; the server hello may lower it */
+    ws_protocol->version = ws_protocol->offered_version;
+    __atomic_store_n(&ws_protocol->control_cbor, false, __ATOMIC_RELAXED);
+    __atomic_store_n(&ws_protocol->flow_negotiated, false, __ATOMIC_RELAXED);
+    if (ws_protocol->deflate_offer) {
+        char deflate_header[256];
+        if (linx_ws_deflate_offer(&ws_protocol->deflate_config, deflate_header, sizeof(deflate_header)) > 0) {
+            strncat(headers, deflate_header, sizeof(headers) - strlen(headers) - 1);
+        }
+    }
+    
+    if (ws_protocol->version > 0) {
+        char version_header[64];
+        snprintf(version_header, sizeof(version_header), "Protocol-Version: %d\r\n", ws_protocol->version);
+        strncat(headers, version_header, sizeof(headers) - strlen(headers) - 1);
+    }
+    
+    if (ws_protocol->device_id) {
+        char device_header[256];
+        snprintf(device_header, sizeof(device_header), "Device-Id: %s\r\n", ws_protocol->device_id);
+        strncat(headers, device_header, sizeof(headers) - strlen(headers) - 1);
+    }
+    
+    if (ws_protocol->client_id) {
+        char client_header[256];
+        snprintf(client_header, sizeof(client_header), "Client-Id: %s\r\n", ws_protocol->client_id);
+        strncat(headers, client_header, sizeof(headers) - strlen(headers) - 1);
+    }
+    
+    /* Dial a cached address when there is one, the URL itself otherwise */
+    char cached_url[512];
+    struct mg_addr addr;
+    ws_protocol->dialed_cached_addr = ws_protocol->dns_cache_ttl_ms > 0 &&
+                                      linx_websocket_dns_lookup(ws_protocol->server_url, &addr) &&
+                                      linx_websocket_format_addr_url(ws_protocol->server_url, &addr,
+                                                                     cached_url, sizeof(cached_url));
+    const char* url = ws_protocol->dialed_cached_addr ? cached_url : ws_protocol->server_url;
+    if (ws_protocol->dialed_cached_addr) {
+        LOG_DEBUG("WebSocket dialling cached address %s", cached_url);
+    }
+    
+    ws_protocol->conn = mg_ws_connect(ws_protocol->mgr, url, 
+                                     linx_websocket_event_handler, ws_protocol, 
+                                     strlen(headers) > 0 ? "%s" : NULL, headers);
+    
+    if (!ws_protocol->conn) {
+        return false;
+    }
+    
+    ws_protocol->conn_id = ws_protocol->conn->id;
+    ws_protocol->hello_sent = false;
+    linx_websocket_io_open(ws_protocol, ws_protocol->conn);
+    
+    if (ws_protocol->dialed_cached_addr) {
+        linx_websocket_restore_host_header(ws_protocol->conn, mg_url_host(ws_protocol->server_url));
+    }
+    
+    /* Pipeline hello behind the upgrade request: saves a round trip before the server hello */
+    if (ws_protocol->early_hello) {
+        const char* hello = linx_websocket_get_hello_message(ws_protocol);
+        if (hello) {
+            linx_websocket_write_message(ws_protocol, hello, ws_protocol->hello_cache.length, WEBSOCKET_OP_TEXT);
+            ws_protocol->hello_sent = true;
+        }
+    }
+    return true;
+}
+
+/* DNS cache helpers; the key is the URL's host and port */
+static linx_websocket_dns_entry_t* linx_websocket_dns_find(struct mg_str host, uint16_t port) {
+    for (int i = 0; i < LINX_WEBSOCKET_DNS_CACHE_SLOTS; i++) {
+        linx_websocket_dns_entry_t* entry = &s_dns_cache[i];
+        if (entry->port == port && strlen(entry->host) == host.len &&
+            strncasecmp(entry->host, host.buf, host.len) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static bool linx_websocket_dns_lookup(const char* url, struct mg_addr* addr) {
+    struct mg_str host = mg_url_host(url);
+    bool found = false;
+    pthread_mutex_lock(&s_dns_cache_mutex);
+    linx_websocket_dns_entry_t* entry = linx_websocket_dns_find(host, mg_url_port(url));
+    if (entry && mg_millis() < entry->expires_ms) {
+        *addr = entry->addr;
+        found = true;
+    }
+    pthread_mutex_unlock(&s_dns_cache_mutex);
+    return found;
+}
+
+static void linx_websocket_dns_store(const char* url, const struct mg_addr* addr, int ttl_ms) {
+    struct mg_str host = mg_url_host(url);
+    uint16_t port = mg_url_port(url);
+    if (host.len == 0 || host.len >= sizeof(s_dns_cache[0].host)) {
+        return;
+    }
+    
+    pthread_mutex_lock(&s_dns_cache_mutex);
+    linx_websocket_dns_entry_t* entry = linx_websocket_dns_find(host, port);
+    if (!entry) {
+        /* Reuse the slot that expires first */
+        entry = &s_dns_cache[0];
+        for (int i = 1; i < LINX_WEBSOCKET_DNS_CACHE_SLOTS; i++) {
+            if (s_dns_cache[i].expires_ms < entry->expires_ms) {
+                entry = &s_dns_cache[i];
+            }
+        }
+        memcpy(entry->host, host.buf, host.len);
+        entry->host[host.len] = '\0';
+        entry->port = port;
+    }
+    entry->addr = *addr;
+    entry->expires_ms = mg_millis() + (uint64_t)ttl_ms;
+    pthread_mutex_unlock(&s_dns_cache_mutex);
+}
+
+static void linx_websocket_dns_forget(const char* url) {
+    pthread_mutex_lock(&s_dns_cache_mutex);
+    linx_websocket_dns_entry_t* entry = linx_websocket_dns_find(mg_url_host(url), mg_url_port(url));
+    if (entry) {
+        entry->expires_ms = 0;
+    }
+    pthread_mutex_unlock(&s_dns_cache_mutex);
+}
+
+/**
+ * Decorrelated jitter backoff: each delay is drawn from [base, 3 * previous]
+ * and capped, so a fleet that dropped together does not redial in lockstep.
+ * Returns false when reconnecting is disabled, stopped or out of attempts.
+ */
+static bool linx_websocket_schedule_reconnect(linx_websocket_protocol_t* ws_protocol) {
+    if (!ws_protocol->auto_reconnect || !ws_protocol->running || ws_protocol->should_stop) {
+        return false;
+    }
+    
+    int attempts = __atomic_load_n(&ws_protocol->reconnect_attempts, __ATOMIC_RELAXED);
+    if (ws_protocol->reconnect_max_attempts > 0 && attempts >= ws_protocol->reconnect_max_attempts) {
+        LOG_ERROR("WebSocket reconnect gave up after %d attempts", attempts);
+        ws_protocol->running = false;
+        __atomic_store_n(&ws_protocol->reconnecting, false, __ATOMIC_RELAXED);
+        return false;
+    }
+    
+    uint64_t base = (uint64_t)ws_protocol->reconnect_base_ms;
+    uint64_t prev = ws_protocol->reconnect_delay_ms > 0 ? (uint64_t)ws_protocol->reconnect_delay_ms : base;
+    uint64_t upper = prev * 3;
+    if (upper > (uint64_t)ws_protocol->reconnect_max_ms) {
+        upper = (uint64_t)ws_protocol->reconnect_max_ms;
+    }
+    uint32_t r = 0;
+    if (!mg_random(&r, sizeof(r))) {
+        r = (uint32_t)mg_millis();
+    }
+    uint64_t delay = upper > base ? base + r % (upper - base + 1) : base;
+    
+    ws_protocol->reconnect_delay_ms = (int)delay;
+    __atomic_store_n(&ws_protocol->reconnect_attempts, attempts + 1, __ATOMIC_RELAXED);
+    ws_protocol->reconnect_at_ms = mg_millis() + delay;
+    linx_timer_schedule_at(ws_protocol->timers, &ws_protocol->reconnect_timer, ws_protocol->reconnect_at_ms);
+    __atomic_store_n(&ws_protocol->reconnecting, true, __ATOMIC_RELAXED);
+    LOG_INFO("WebSocket reconnect #%d in %llu ms", attempts + 1, (unsigned long long)delay);
+    return true;
+}
+
+/* Called from the event loop once the backoff deadline has passed */
+static void linx_websocket_run_reconnect(linx_websocket_protocol_t* ws_protocol) {
+    ws_protocol->reconnect_at_ms = 0;
+    if (!ws_protocol->running || ws_protocol->should_stop) {
+        return;
+    }
+    
+    LOG_INFO("WebSocket reconnecting to: %s", ws_protocol->server_url);
+    if (linx_websocket_open_connection(ws_protocol)) {
+        return;
+    }
+    
+    /* Dial failed before a connection existed, so no MG_EV_CLOSE will follow */
+    if (!linx_websocket_schedule_reconnect(ws_protocol) && ws_protocol->base.callbacks.on_disconnected) {
+        ws_protocol->base.callbacks.on_disconnected(ws_protocol->base.callbacks.user_data);
+    }
+}
+
+/* Backoff timer; a stop from another thread only clears reconnect_at_ms, so check it here */
+static void linx_websocket_reconnect_timer(linx_timer_t* timer, void* user_data) {
+    linx_websocket_protocol_t* ws_protocol = (linx_websocket_protocol_t*)user_data;
+    (void)timer;
+    if (ws_protocol->reconnect_at_ms) {
+        linx_websocket_run_reconnect(ws_protocol);
+    }
+}
+
+/* Drop a pending reconnect; the timer itself is only touched on the loop thread */
+static void linx_websocket_cancel_reconnect(linx_websocket_protocol_t* ws_protocol) {
+    ws_protocol->reconnect_at_ms = 0;
+    if (ws_protocol->reactor ? linx_reactor_in_loop(ws_protocol->reactor) : linx_websocket_on_loop_thread(ws_protocol)) {
+        linx_timer_cancel(&ws_protocol->reconnect_timer);
+    }
+}
+
+
+
+
+
+/* Build a WebSocket frame header the way mg_ws_wrap() does; a client frame gets a fresh mask key
+ * in its last 4 bytes. Returns the header size (at most LINX_WEBSOCKET_WS_HEADER_MAX) */
+static size_t linx_websocket_ws_header(const struct mg_connection* conn, size_t len, int op, uint8_t* buf) {
+    size_t n;
+    buf[0] = (uint8_t)(op | LINX_WEBSOCKET_FLAG_FIN);
+    if (len < 126) {
+        buf[1] = (uint8_t)len;
+        n = 2;
+    } else if (len < 65536) {
+        buf[1] = 126;
+        buf[2] = (uint8_t)(len >> 8);
+        buf[3] = (uint8_t)len;
+        n = 4;
+    } else {
+        buf[1] = 127;
+        for (int i = 0; i < 8; i++) {
+            buf[2 + i] = (uint8_t)((uint64_t)len >> (56 - 8 * i));
+        }
+        n = 10;
+    }
+    if (conn->is_client) {
+        buf[1] |= 0x80;
+        mg_random(&buf[n], 4);
+        n += 4;
+    }
+    return n;
+}
+
+/* Copy into the send buffer, applying the client mask on the way; offset is the position in the frame payload */
+static void linx_websocket_ws_copy(uint8_t* dst, const uint8_t* src, size_t size, const uint8_t* mask,
+                                   size_t offset) {
+    if (!mask) {
+        memcpy(dst, src, size);
+        return;
+    }
+    for (size_t i = 0; i < size; i++) {
+        dst[i] = src[i] ^ mask[(offset + i) & 3];
+    }
+}
+
+/**
+ * 以分散写入的方式发送一帧二进制消息：先为整帧预留发送缓冲区（含 WebSocket 帧头的空间），
+ * 再把 WebSocket 帧头、协议头和载荷依次直接写入。载荷只拷贝一次（客户端帧在拷贝时加掩码），
+ * 不经过临时缓冲区，也不像 mg_ws_wrap() 那样为插入帧头整体搬移；预留之后不再有失败路径。
+ */
+static bool linx_websocket_send_framed(linx_websocket_protocol_t* ws_protocol,
+                                       const void* header, size_t header_size,
+                                       const uint8_t* payload, size_t payload_size) {
+    linx_ws_capture_write(ws_protocol->capture, LINX_WS_CAPTURE_OUT_BINARY, header, header_size,
+                          payload, payload_size);
+    if (ws_protocol->replay) {
+        __atomic_fetch_add(&ws_protocol->replay_stats.outbound, 1, __ATOMIC_RELAXED);
+        return true;
+    }
+    
+    struct mg_connection* conn = ws_protocol->conn;
+    size_t frame_size = header_size + payload_size;
+    
+    /* Reserves room for the largest frame header as well, so the writes below cannot fail */
+    if (!linx_websocket_io_reserve(ws_protocol, frame_size)) {
+        return false;
+    }
+    
+    uint8_t* out = conn->send.buf + conn->send.len;
+    size_t ws_header_size = linx_websocket_ws_header(conn, frame_size, WEBSOCKET_OP_BINARY, out);
+    const uint8_t* mask = conn->is_client ? out + ws_header_size - 4 : NULL;
+    out += ws_header_size;
+    linx_websocket_ws_copy(out, (const uint8_t*)header, header_size, mask, 0);
+    if (payload_size > 0) {
+        linx_websocket_ws_copy(out + header_size, payload, payload_size, mask, header_size);
+    }
+    conn->send.len += ws_header_size + frame_size;
+    
+    LINX_TRACEPOINT(ws_tx, WEBSOCKET_OP_BINARY, frame_size);
+    return true;
+}
+
+bool linx_websocket_send_audio(linx_protocol_t* protocol, linx_audio_stream_packet_t* packet) {
+    linx_websocket_protocol_t* ws_protocol = (linx_websocket_protocol_t*)protocol;
+    
+    if (!ws_protocol || (!ws_protocol->conn && !ws_protocol->replay) || !ws_protocol->connected || !packet) {
+        LOG_ERROR("Invalid websocket protocol or connection state");
+        return false;
+    }
+    // LOG_DEBUG("Sending audio packet - Sample Rate: %d, Frame Duration: %d, Timestamp: %u, Payload Size: %zu, Version: %d", 
+    //           packet->sample_rate, packet->frame_duration, packet->timestamp, packet->payload_size, ws_protocol->version);
+    
+    /* Number frames when they are handed in so frames dropped on the way show up as gaps (v4) */
+    uint16_t sequence = __atomic_fetch_add(&ws_protocol->tx_sequence, 1, __ATOMIC_RELAXED);
+    return linx_websocket_submit_audio(ws_protocol, 0, packet, sequence);
+}
+
+/* Send an audio frame from any thread: directly on the event loop thread, otherwise through the audio queue */
+static bool linx_websocket_submit_audio(linx_websocket_protocol_t* ws_protocol, uint8_t stream_id,
+                                        const linx_audio_stream_packet_t* packet, uint16_t sequence) {
+    __atomic_store_n(&ws_protocol->last_audio_ms, mg_millis(), __ATOMIC_RELAXED);
+    
+    uint32_t timestamp = packet->timestamp;
+    if (timestamp == 0 && LINX_WS_FRAME_VERSION(ws_protocol) == 4) {
+        timestamp = (uint32_t)(mg_millis() - ws_protocol->tx_epoch_ms);
+    }
+    
+    if (linx_websocket_on_loop_thread(ws_protocol)) {
+        return linx_websocket_send_audio_now(ws_protocol, stream_id, packet->payload, packet->payload_size,
+                                             timestamp, sequence);
+    }
+    
+    /* Mongoose is not thread-safe: hand the frame to the event loop */
+    linx_websocket_send_item_t* item = linx_websocket_audio_item_acquire(ws_protocol, packet->payload_size);
+    if (!item) {
+        LOG_ERROR("WebSocket send failed: memory allocation failed (audio queue)");
+        return false;
+    }
+    item->timestamp = timestamp;
+    item->sequence = sequence;
+    item->stream = stream_id;
+    item->size = packet->payload_size;
+    memcpy(item->data, packet->payload, packet->payload_size);
+    
+    if (!linx_websocket_send_queue_push(&ws_protocol->audio_queue, item)) {
+        LOG_WARN("WebSocket audio send queue full, dropping frame");
+        __atomic_fetch_add(&ws_protocol->audio_dropped, 1, __ATOMIC_RELAXED);
+        linx_websocket_send_item_release(ws_protocol, item);
+        return false;
+    }
+    
+    linx_websocket_wakeup(ws_protocol);
+    return true;
+}
+
+/* Build and send one audio frame; must run on the event loop thread */
+static bool linx_websocket_send_audio_now(linx_websocket_protocol_t* ws_protocol, uint8_t stream_id,
+                                          const uint8_t* payload, size_t payload_size, uint32_t timestamp,
+                                          uint16_t sequence) {
+    const int version = LINX_WS_FRAME_VERSION(ws_protocol);
+    uint8_t header[LINX_BINARY_HEADER_MAX_BYTES];
+    int header_size = linx_binary_frame_encode(version, LINX_BINARY_TYPE_AUDIO, timestamp, sequence,
+                                               payload_size, header);
+    if (header_size < 0) {
+        LOG_ERROR("WebSocket send failed: payload too large for protocol v%d (%zu bytes)",
+                  version, payload_size);
+        return false;
+    }
+    if (header_size > 0) {
+        if (stream_id != 0) {
+            linx_binary_frame_set_stream(version, header, stream_id);
+        }
+        if (!linx_websocket_send_framed(ws_protocol, header, (size_t)header_size, payload, payload_size)) {
+            return false;
+        }
+    } else if (!linx_websocket_write_message(ws_protocol, payload, payload_size, WEBSOCKET_OP_BINARY)) {
+        /* Fallback for unsupported protocol versions - raw payload */
+        return false;
+    }
+    
+    if (ws_protocol->recorder && stream_id == 0) {
+        linx_websocket_record_audio(ws_protocol, LINX_OGG_RECORDER_UPLINK, payload, payload_size);
+    }
+    return true;
+}
+
+bool linx_websocket_send_text(linx_protocol_t* protocol, const char* text) {
+    linx_websocket_protocol_t* ws_protocol = (linx_websocket_protocol_t*)protocol;
+    
+    if (!ws_protocol || (!ws_protocol->conn && !ws_protocol->replay) || !ws_protocol->connected || !text) {
+        LOG_ERROR("WebSocket send text failed: invalid protocol or connection or not connected or text is empty");
+        return false;
+    }
+    
+    return linx_websocket_submit_text(ws_protocol, text, strlen(text));
+}
+
+/* Send a text message from any thread, scheduled by its priority class */
+static bool linx_websocket_submit_text(linx_websocket_protocol_t* ws_protocol, const char* text, size_t len) {
+    linx_websocket_priority_t priority = linx_websocket_text_priority(ws_protocol, text, len);
+    if (priority == LINX_WEBSOCKET_PRIORITY_BULK) {
+        LOG_DEBUG("WebSocket queueing bulk text (%zu bytes)", len);
+    } else {
+        LOG_DEBUG("WebSocket sending text: %.*s", (int)len, text);
+    }
+    if (priority == LINX_WEBSOCKET_PRIORITY_URGENT) {
+        __atomic_fetch_add(&ws_protocol->urgent_messages, 1, __ATOMIC_RELAXED);
+    }
+    
+    if (priority != LINX_WEBSOCKET_PRIORITY_BULK && linx_websocket_on_loop_thread(ws_protocol)) {
+        linx_websocket_write_message(ws_protocol, text, len, WEBSOCKET_OP_TEXT);
+        return true;
+    }
+    
+    /* Mongoose is not thread-safe: hand the message to the event loop */
+    linx_websocket_send_item_t* item = LINX_MALLOC(sizeof(linx_websocket_send_item_t) + len);
+    if (!item) {
+        LOG_ERROR("WebSocket send text failed: memory allocation failed (text queue)");
+        return false;
+    }
+    item->timestamp = 0;
+    item->sequence = 0;
+    item->op = WEBSOCKET_OP_TEXT;
+    item->size = len;
+    memcpy(item->data, text, len);
+    
+    if (priority == LINX_WEBSOCKET_PRIORITY_BULK) {
+        return linx_websocket_bulk_submit(ws_protocol, item);
+    }
+    
+    linx_websocket_send_queue_t* queue = priority == LINX_WEBSOCKET_PRIORITY_URGENT ?
+                                         &ws_protocol->urgent_queue : &ws_protocol->text_queue;
+    if (!linx_websocket_send_queue_push(queue, item)) {
+        LOG_WARN("WebSocket text send queue full, dropping message");
+        LINX_FREE(item);
+        return false;
+    }
+    
+    linx_websocket_wakeup(ws_protocol);
+    return true;
+}
+
+/* Send a control message as CBOR in a binary frame; false when not negotiated so the caller sends JSON */
+static bool linx_websocket_send_control(linx_protocol_t* protocol, const linx_control_message_t* message) {
+    linx_websocket_protocol_t* ws_protocol = (linx_websocket_protocol_t*)protocol;
+    
+    if (!ws_protocol || !__atomic_load_n(&ws_protocol->control_cbor, __ATOMIC_RELAXED) ||
+        (!ws_protocol->conn && !ws_protocol->replay) || !ws_protocol->connected) {
+        return false;
+    }
+    return linx_websocket_submit_control(ws_protocol, 0, message);
+}
+
+/* Encode and send a CBOR control message from any thread; false when it cannot be encoded, queued or
+ * written, so the caller falls back to JSON instead of losing it */
+static bool linx_websocket_submit_control(linx_websocket_protocol_t* ws_protocol, uint8_t stream_id,
+                                          const linx_control_message_t* message) {
+    uint8_t cbor[LINX_CONTROL_CBOR_MAX_SIZE];
+    size_t cbor_size = linx_control_cbor_encode(message, cbor, sizeof(cbor));
+    uint8_t header[LINX_BINARY_HEADER_MAX_BYTES];
+    int header_size = cbor_size > 0 ?
+        linx_binary_frame_encode(LINX_WS_FRAME_VERSION(ws_protocol), LINX_BINARY_TYPE_CONTROL, 0, 0,
+                                 cbor_size, header) : 0;
+    if (header_size <= 0) {
+        return false;
+    }
+    if (stream_id != 0) {
+        linx_binary_frame_set_stream(LINX_WS_FRAME_VERSION(ws_protocol), header, stream_id);
+    }
+    LOG_DEBUG("WebSocket sending CBOR control message: %s (%zu bytes)",
+              linx_control_type_name(message->type), cbor_size);
+    
+    /* Same classes as JSON: listen stop has to follow the audio it ends */
+    const linx_control_string_t* state = &message->fields[LINX_CONTROL_FIELD_STATE];
+    bool urgent = message->type == LINX_CONTROL_TYPE_ABORT ||
+                  (message->type == LINX_CONTROL_TYPE_LISTEN &&
+                   !(state->data && state->length == 4 && memcmp(state->data, "stop", 4) == 0));
+    
+    if (linx_websocket_on_loop_thread(ws_protocol)) {
+        if (!linx_websocket_send_framed(ws_protocol, header, (size_t)header_size, cbor, cbor_size)) {
+            __atomic_fetch_add(&ws_protocol->control_dropped, 1, __ATOMIC_RELAXED);
+            return false;
+        }
+        if (urgent) {
+            __atomic_fetch_add(&ws_protocol->urgent_messages, 1, __ATOMIC_RELAXED);
+        }
+        return true;
+    }
+    
+    /* Queued with the JSON messages of the same class so control messages keep their relative order */
+    size_t size = (size_t)header_size + cbor_size;
+    linx_websocket_send_item_t* item = LINX_MALLOC(sizeof(linx_websocket_send_item_t) + size);
+    if (!item) {
+        LOG_ERROR("WebSocket send control failed: memory allocation failed (text queue)");
+        __atomic_fetch_add(&ws_protocol->control_dropped, 1, __ATOMIC_RELAXED);
+        return false;
+    }
+    item->timestamp = 0;
+    item->sequence = 0;
+    item->op = WEBSOCKET_OP_BINARY;
+    item->size = size;
+    memcpy(item->data, header, (size_t)header_size);
+    memcpy(item->data + header_size, cbor, cbor_size);
+    
+    if (!linx_websocket_send_queue_push(urgent ? &ws_protocol->urgent_queue : &ws_protocol->text_queue, item)) {
+        LOG_WARN("WebSocket text send queue full, dropping control message");
+        __atomic_fetch_add(&ws_protocol->control_dropped, 1, __ATOMIC_RELAXED);
+        LINX_FREE(item);
+        return false;
+    }
+    
+    if (urgent) {
+        __atomic_fetch_add(&ws_protocol->urgent_messages, 1, __ATOMIC_RELAXED);
+    }
+    linx_websocket_wakeup(ws_protocol);
+    return true;
+}
+
+/* Send queue helpers */
+static bool linx_websocket_on_loop_thread(const linx_websocket_protocol_t* ws_protocol) {
+    if (ws_protocol->reactor) {
+        return linx_reactor_in_loop(ws_protocol->reactor);
+    }
+    /* Until the first poll records its thread nobody is known to own mongoose, so callers queue */
+    return __atomic_load_n(&ws_protocol->loop_thread_valid, __ATOMIC_ACQUIRE) &&
+           pthread_equal(ws_protocol->loop_thread, pthread_self());
+}
+
+static bool linx_websocket_send_queue_push(linx_websocket_send_queue_t* queue, linx_websocket_send_item_t* item) {
+    if (__atomic_add_fetch(&queue->depth, 1, __ATOMIC_RELAXED) > LINX_WEBSOCKET_SEND_QUEUE_MAX) {
+        __atomic_sub_fetch(&queue->depth, 1, __ATOMIC_RELAXED);
+        return false;
+    }
+    
+    linx_websocket_send_item_t* head = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+    do {
+        item->next = head;
+    } while (!__atomic_compare_exchange_n(&queue->head, &head, item, true,
+                                          __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    return true;
+}
+
+/* Detach every queued item and return them oldest first */
+static linx_websocket_send_item_t* linx_websocket_send_queue_take(linx_websocket_send_queue_t* queue) {
+    linx_websocket_send_item_t* item = __atomic_exchange_n(&queue->head, NULL, __ATOMIC_ACQUIRE);
+    linx_websocket_send_item_t* fifo = NULL;
+    size_t count = 0;
+    
+    while (item) {
+        linx_websocket_send_item_t* next = item->next;
+        item->next = fifo;
+        fifo = item;
+        item = next;
+        count++;
+    }
+    
+    if (count > 0) {
+        __atomic_sub_fetch(&queue->depth, count, __ATOMIC_RELAXED);
+    }
+    return fifo;
+}
+
+static void linx_websocket_send_queue_clear(linx_websocket_protocol_t* ws_protocol,
+                                           linx_websocket_send_queue_t* queue) {
+    linx_websocket_send_item_t* item = linx_websocket_send_queue_take(queue);
+    while (item) {
+        linx_websocket_send_item_t* next = item->next;
+        linx_websocket_send_item_release(ws_protocol, item);
+        item = next;
+    }
+}
+
+/* Audio send item pool: a fixed slab carved into equal slots on a mutex-protected free list */
+static bool linx_websocket_audio_items_create(linx_websocket_protocol_t* ws_protocol) {
+    ws_protocol->audio_item_slab = LINX_MALLOC(LINX_WEBSOCKET_AUDIO_ITEM_SLOTS * LINX_WEBSOCKET_AUDIO_ITEM_STRIDE);
+    if (!ws_protocol->audio_item_slab) {
+        return false;
+    }
+    pthread_mutex_init(&ws_protocol->audio_item_mutex, NULL);
+    
+    ws_protocol->audio_item_free = NULL;
+    for (int i = LINX_WEBSOCKET_AUDIO_ITEM_SLOTS - 1; i >= 0; i--) {
+        linx_websocket_send_item_t* item = (linx_websocket_send_item_t*)
+            (ws_protocol->audio_item_slab + (size_t)i * LINX_WEBSOCKET_AUDIO_ITEM_STRIDE);
+        item->next = ws_protocol->audio_item_free;
+        ws_protocol->audio_item_free = item;
+    }
+    return true;
+}
+
+static void linx_websocket_audio_items_destroy(linx_websocket_protocol_t* ws_protocol) {
+    if (!ws_protocol->audio_item_slab) {
+        return;
+    }
+    uint64_t misses = __atomic_load_n(&ws_protocol->audio_item_misses, __ATOMIC_RELAXED);
+    if (misses > 0) {
+        LOG_DEBUG("WebSocket audio send item pool missed %llu times", (unsigned long long)misses);
+    }
+    pthread_mutex_destroy(&ws_protocol->audio_item_mutex);
+    LINX_FREE(ws_protocol->audio_item_slab);
+    ws_protocol->audio_item_slab = NULL;
+    ws_protocol->audio_item_free = NULL;
+}
+
+static linx_websocket_send_item_t* linx_websocket_audio_item_acquire(linx_websocket_protocol_t* ws_protocol,
+                                                                     size_t payload_size) {
+    linx_websocket_send_item_t* item = NULL;
+    
+    if (ws_protocol->audio_item_slab && payload_size <= LINX_WEBSOCKET_AUDIO_ITEM_PAYLOAD) {
+        pthread_mutex_lock(&ws_protocol->audio_item_mutex);
+        item = ws_protocol->audio_item_free;
+        if (item) {
+            ws_protocol->audio_item_free = item->next;
+        }
+        pthread_mutex_unlock(&ws_protocol->audio_item_mutex);
+    }
+    if (item) {
+        return item;
+    }
+    
+    /* Oversized frame or pool exhausted */
+    __atomic_fetch_add(&ws_protocol->audio_item_misses, 1, __ATOMIC_RELAXED);
+    return LINX_MALLOC(sizeof(linx_websocket_send_item_t) + payload_size);
+}
+
+/* Return an item to the pool it came from; text items and pool misses live on the heap */
+static void linx_websocket_send_item_release(linx_websocket_protocol_t* ws_protocol,
+                                             linx_websocket_send_item_t* item) {
+    uint8_t* addr = (uint8_t*)item;
+    uint8_t* slab = ws_protocol->audio_item_slab;
+    
+    if (slab && addr >= slab &&
+        addr < slab + LINX_WEBSOCKET_AUDIO_ITEM_SLOTS * LINX_WEBSOCKET_AUDIO_ITEM_STRIDE) {
+        pthread_mutex_lock(&ws_protocol->audio_item_mutex);
+        item->next = ws_protocol->audio_item_free;
+        ws_protocol->audio_item_free = item;
+        pthread_mutex_unlock(&ws_protocol->audio_item_mutex);
+        return;
+    }
+    LINX_FREE(item);
+}
+
+/* Drain the queues on the loop thread: urgent control, audio, the other
+ * messages, then bulk; everything but bulk lands in the connection's send
+ * iobuf and goes out in a single socket write */
+static void linx_websocket_flush_send_queues(linx_websocket_protocol_t* ws_protocol) {
+    linx_websocket_send_item_t* item = linx_websocket_send_queue_take(&ws_protocol->urgent_queue);
+    while (item) {
+        linx_websocket_send_item_t* next = item->next;
+        if (ws_protocol->conn || ws_protocol->replay) {
+            linx_websocket_write_message(ws_protocol, item->data, item->size, item->op);
+        }
+        linx_websocket_send_item_release(ws_protocol, item);
+        item = next;
+    }
+    
+    item = linx_websocket_send_queue_take(&ws_protocol->audio_queue);
+    linx_alloc_no_alloc_enter();
+    while (item) {
+        linx_websocket_send_item_t* next = item->next;
+        if (ws_protocol->conn || ws_protocol->replay) {
+            linx_websocket_send_audio_now(ws_protocol, item->stream, item->data, item->size, item->timestamp,
+                                          item->sequence);
+        }
+        linx_websocket_send_item_release(ws_protocol, item);
+        item = next;
+    }
+    linx_alloc_no_alloc_leave();
+    
+    item = linx_websocket_send_queue_take(&ws_protocol->text_queue);
+    while (item) {
+        linx_websocket_send_item_t* next = item->next;
+        if (ws_protocol->conn || ws_protocol->replay) {
+            linx_websocket_write_message(ws_protocol, item->data, item->size, item->op);
+        }
+        linx_websocket_send_item_release(ws_protocol, item);
+        item = next;
+    }
+    
+    item = linx_websocket_send_queue_take(&ws_protocol->bulk_queue);
+    while (item) {
+        linx_websocket_send_item_t* next = item->next;
+        linx_websocket_bulk_append(ws_protocol, item);
+        item = next;
+    }
+    linx_websocket_bulk_pump(ws_protocol);
+}
+
+/* Text above one fragment is bulk; listen start/detect and abort skip ahead of queued audio */
+static linx_websocket_priority_t linx_websocket_text_priority(const linx_websocket_protocol_t* ws_protocol,
+                                                              const char* text, size_t size) {
+    if (size > ws_protocol->bulk_fragment) {
+        return LINX_WEBSOCKET_PRIORITY_BULK;
+    }
+    
+    linx_json_scan_field_t fields[2] = { { .key = "type" }, { .key = "state" } };
+    if (linx_json_scan_object(text, size, fields, 2) < 0) {
+        return LINX_WEBSOCKET_PRIORITY_NORMAL;
+    }
+    if (linx_json_scan_equals(&fields[0], "abort") ||
+        (linx_json_scan_equals(&fields[0], "listen") && !linx_json_scan_equals(&fields[1], "stop"))) {
+        return LINX_WEBSOCKET_PRIORITY_URGENT;
+    }
+    return LINX_WEBSOCKET_PRIORITY_NORMAL;
+}
+
+/* Take ownership of a bulk message; the loop thread appends it directly, other threads hand it over */
+static bool linx_websocket_bulk_submit(linx_websocket_protocol_t* ws_protocol, linx_websocket_send_item_t* item) {
+    size_t size = item->size;
+    size_t queued = __atomic_add_fetch(&ws_protocol->bulk_queued_bytes, size, __ATOMIC_RELAXED);
+    if (queued > LINX_WEBSOCKET_BULK_QUEUE_MAX && queued > size) {
+        __atomic_sub_fetch(&ws_protocol->bulk_queued_bytes, size, __ATOMIC_RELAXED);
+        LOG_WARN("WebSocket bulk send queue full, dropping %zu byte message", size);
+        LINX_FREE(item);
+        return false;
+    }
+    
+    if (linx_websocket_on_loop_thread(ws_protocol)) {
+        linx_websocket_bulk_append(ws_protocol, item);
+        linx_websocket_bulk_pump(ws_protocol);
+        return true;
+    }
+    if (!linx_websocket_send_queue_push(&ws_protocol->bulk_queue, item)) {
+        __atomic_sub_fetch(&ws_protocol->bulk_queued_bytes, size, __ATOMIC_RELAXED);
+        LOG_WARN("WebSocket bulk send queue full, dropping %zu byte message", size);
+        LINX_FREE(item);
+        return false;
+    }
+    linx_websocket_wakeup(ws_protocol);
+    return true;
+}
+
+static void linx_websocket_bulk_append(linx_websocket_protocol_t* ws_protocol, linx_websocket_send_item_t* item) {
+    item->next = NULL;
+    if (ws_protocol->bulk_tail) {
+        ws_protocol->bulk_tail->next = item;
+    } else {
+        ws_protocol->bulk_head = item;
+    }
+    ws_protocol->bulk_tail = item;
+}
+
+static void linx_websocket_bulk_pop(linx_websocket_protocol_t* ws_protocol) {
+    linx_websocket_send_item_t* item = ws_protocol->bulk_head;
+    ws_protocol->bulk_head = item->next;
+    if (!ws_protocol->bulk_head) {
+        ws_protocol->bulk_tail = NULL;
+    }
+    ws_protocol->bulk_offset = 0;
+    __atomic_sub_fetch(&ws_protocol->bulk_queued_bytes, item->size, __ATOMIC_RELAXED);
+    linx_websocket_send_item_release(ws_protocol, item);
+}
+
+static void linx_websocket_bulk_clear(linx_websocket_protocol_t* ws_protocol) {
+    while (ws_protocol->bulk_head) {
+        linx_websocket_bulk_pop(ws_protocol);
+    }
+}
+
+/* Append one fragment of a fragmented message; op is the message opcode for the first fragment and
+ * WEBSOCKET_OP_CONTINUE afterwards */
+static bool linx_websocket_send_fragment(linx_websocket_protocol_t* ws_protocol, const uint8_t* data,
+                                         size_t size, int op, bool fin) {
+    struct mg_connection* conn = ws_protocol->conn;
+    size_t start = conn->send.len;
+    
+    if (!linx_websocket_io_reserve(ws_protocol, size)) {
+        return false;
+    }
+    if (!mg_send(conn, data, size)) {
+        conn->send.len = start;
+        LOG_ERROR("WebSocket send failed: unable to grow send buffer (%zu byte fragment)", size);
+        return false;
+    }
+    mg_ws_wrap(conn, size, op);
+    LINX_TRACEPOINT(ws_tx, op, size);
+    if (!fin) {
+        conn->send.buf[start] &= (uint8_t)~LINX_WEBSOCKET_FLAG_FIN;
+    }
+    return true;
+}
+
+/*
+ * Write bulk messages only while the send buffer holds less than one
+ * fragment, so a frame queued behind them never waits for more than that.
+ * With interleaving the head message goes out one fragment per call, and
+ * audio and control flushed in between travel as complete messages between
+ * its fragments. It is sent uncompressed: compressing it up front would put
+ * its bytes in the deflate window ahead of messages that reach the server
+ * before its end. Without interleaving a started message would hold every
+ * other frame back until its last fragment, so it goes out whole instead.
+ */
+static void linx_websocket_bulk_pump(linx_websocket_protocol_t* ws_protocol) {
+    while (ws_protocol->bulk_head) {
+        linx_websocket_send_item_t* item = ws_protocol->bulk_head;
+        struct mg_connection* conn = ws_protocol->conn;
+        
+        if (!conn && !ws_protocol->replay) {
+            return;
+        }
+        if (conn && conn->send.len >= ws_protocol->bulk_fragment) {
+            return;
+        }
+        if (!conn || !ws_protocol->bulk_interleave) {
+            linx_websocket_write_message(ws_protocol, item->data, item->size, item->op);
+            linx_websocket_bulk_pop(ws_protocol);
+            continue;
+        }
+        
+        size_t offset = ws_protocol->bulk_offset;
+        size_t size = item->size - offset;
+        if (size > ws_protocol->bulk_fragment) {
+            size = ws_protocol->bulk_fragment;
+        }
+        bool fin = offset + size == item->size;
+        if (offset == 0) {
+            linx_ws_capture_write(ws_protocol->capture,
+                                  item->op == WEBSOCKET_OP_TEXT ? LINX_WS_CAPTURE_OUT_TEXT : LINX_WS_CAPTURE_OUT_BINARY,
+                                  item->data, item->size, NULL, 0);
+        }
+        if (!linx_websocket_send_fragment(ws_protocol, item->data + offset, size,
+                                          offset == 0 ? item->op : WEBSOCKET_OP_CONTINUE, fin)) {
+            return;
+        }
+        __atomic_fetch_add(&ws_protocol->bulk_fragments, 1, __ATOMIC_RELAXED);
+        ws_protocol->bulk_offset = offset + size;
+        if (fin) {
+            linx_websocket_bulk_pop(ws_protocol);
+        }
+    }
+}
+
+void linx_websocket_destroy(linx_protocol_t* protocol) {
+    linx_websocket_protocol_t* ws_protocol = (linx_websocket_protocol_t*)protocol;
+    linx_websocket_protocol_destroy(ws_protocol);
+}
+
+/* Event loop functions */
+void linx_websocket_poll(linx_websocket_protocol_t* ws_protocol, int timeout_ms) {
+    if (!ws_protocol) {
+        return;
+    }
+    
+    if (ws_protocol->reactor) {
+        /* Reconnects and keepalives run from the reactor's timer wheel */
+        linx_reactor_poll(ws_protocol->reactor, timeout_ms);
+        return;
+    }
+    
+    if (!__atomic_load_n(&ws_protocol->loop_thread_valid, __ATOMIC_RELAXED)) {
+        ws_protocol->loop_thread = pthread_self();
+        __atomic_store_n(&ws_protocol->loop_thread_valid, true, __ATOMIC_RELEASE);
+    }
+    
+    if (ws_protocol->replay) {
+        linx_websocket_replay_poll(ws_protocol, timeout_ms);
+        return;
+    }
+    
+    /* Run due reconnects and keepalive probes, then sleep no longer than the next deadline */
+    linx_timer_wheel_advance(ws_protocol->timers);
+    timeout_ms = linx_websocket_flow_poll_timeout(ws_protocol, timeout_ms);
+    timeout_ms = linx_timer_wheel_clamp_timeout(ws_protocol->timers, timeout_ms);
+    
+    mg_mgr_poll(ws_protocol->mgr, timeout_ms);
+}
+
+static uint64_t linx_websocket_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)(ts.tv_nsec / 1000);
+}
+
+/* When the pending record is due, scaled by the replay speed (speed > 0 only) */
+static uint64_t linx_websocket_replay_due_us(const linx_websocket_protocol_t* ws_protocol) {
+    uint64_t offset = ws_protocol->replay_pending.timestamp_us - ws_protocol->replay_base_us;
+    return ws_protocol->replay_start_us + (uint64_t)((double)offset / ws_protocol->replay_speed);
+}
+
+/* Feed one recorded frame through the same handlers a live connection uses */
+static void linx_websocket_replay_record(linx_websocket_protocol_t* ws_protocol,
+                                         const linx_ws_capture_record_t* record) {
+    switch (record->type) {
+        case LINX_WS_CAPTURE_OPEN:
+            if (!ws_protocol->connected) {
+                linx_websocket_handle_open(ws_protocol);
+            }
+            break;
+        case LINX_WS_CAPTURE_CLOSE:
+            if (ws_protocol->connected) {
+                linx_websocket_handle_close(ws_protocol);
+            }
+            break;
+        case LINX_WS_CAPTURE_IN_TEXT:
+        case LINX_WS_CAPTURE_IN_BINARY:
+            if (ws_protocol->connected) {
+                linx_websocket_handle_message(ws_protocol, (const char*)record->data, record->size,
+                                              record->type == LINX_WS_CAPTURE_IN_TEXT);
+            }
+            break;
+        case LINX_WS_CAPTURE_OUT_TEXT:
+        case LINX_WS_CAPTURE_OUT_BINARY:
+            /* What the client sent at the time: counted so a replay can be checked against it */
+            __atomic_fetch_add(&ws_protocol->replay_stats.recorded_outbound, 1, __ATOMIC_RELAXED);
+            break;
+    }
+    __atomic_fetch_add(&ws_protocol->replay_stats.records, 1, __ATOMIC_RELAXED);
+}
+
+/* Replay loop step: deliver every record that is due, then wait for the next one or a wakeup */
+static void linx_websocket_replay_poll(linx_websocket_protocol_t* ws_protocol, int timeout_ms) {
+    int wait_ms = timeout_ms;
+    int burst = 0;
+    
+    if (ws_protocol->replay_start_us == 0) {
+        ws_protocol->replay_start_us = linx_websocket_now_us();
+    }
+    
+    while (ws_protocol->running && !ws_protocol->replay_stats.finished) {
+        if (!ws_protocol->replay_pending_valid) {
+            int result = linx_ws_replay_next(ws_protocol->replay, &ws_protocol->replay_pending);
+            if (result <= 0) {
+                /* End of capture: make sure the session sees a disconnect */
+                LOG_INFO("WebSocket replay %s after %llu records",
+                         result == 0 ? "finished" : "stopped on a corrupt record",
+                         (unsigned long long)ws_protocol->replay_stats.records);
+                if (ws_protocol->connected) {
+                    linx_websocket_handle_close(ws_protocol);
+                }
+                __atomic_store_n(&ws_protocol->replay_stats.finished, true, __ATOMIC_RELEASE);
+                break;
+            }
+            ws_protocol->replay_pending_valid = true;
+            if (!ws_protocol->replay_base_set) {
+                ws_protocol->replay_base_us = ws_protocol->replay_pending.timestamp_us;
+                ws_protocol->replay_base_set = true;
+            }
+        }
+        
+        if (ws_protocol->replay_speed > 0) {
+            uint64_t due = linx_websocket_replay_due_us(ws_protocol);
+            uint64_t now = linx_websocket_now_us();
+            if (now < due) {
+                uint64_t until_ms = (due - now + 999) / 1000;
+                if (timeout_ms < 0 || until_ms < (uint64_t)wait_ms) {
+                    wait_ms = (int)until_ms;
+                }
+                break;
+            }
+            if (now - due > ws_protocol->replay_stats.max_lag_us) {
+                __atomic_store_n(&ws_protocol->replay_stats.max_lag_us, now - due, __ATOMIC_RELAXED);
+            }
+        } else if (++burst > LINX_WEBSOCKET_REPLAY_BURST) {
+            wait_ms = 0;
+            break;
+        }
+        
+        ws_protocol->replay_pending_valid = false;
+        linx_websocket_replay_record(ws_protocol, &ws_protocol->replay_pending);
+    }
+    
+    /* Frames queued by other threads are "sent" here, as MG_EV_POLL would for a live connection */
+    if (ws_protocol->connected) {
+        linx_websocket_flush_send_queues(ws_protocol);
+        linx_websocket_send_idle(ws_protocol);
+    }
+    
+    /* The manager has no connections, only the wakeup pipe; polling it doubles as the wait */
+    mg_mgr_poll(ws_protocol->mgr, wait_ms);
+}
+
+/* Reactor hook: deadlines are timers on the reactor's wheel, so only the wait time is contributed */
+static void linx_websocket_reactor_on_poll(void* user_data) {
+    (void)user_data;
+}
+
+static int linx_websocket_reactor_next_timeout(void* user_data, int idle_ms) {
+    return linx_websocket_get_poll_timeout_ms((linx_websocket_protocol_t*)user_data, idle_ms);
+}
+
+static void linx_websocket_start_task(void* arg) {
+    linx_websocket_task_op_t* op = (linx_websocket_task_op_t*)arg;
+    op->result = linx_websocket_start(&op->ws_protocol->base);
+}
+
+static void linx_websocket_stop_task(void* arg) {
+    linx_websocket_stop((linx_websocket_protocol_t*)arg);
+}
+
+/* Close every connection this instance opened on the shared manager and drop their callbacks */
+static void linx_websocket_detach_task(void* arg) {
+    linx_websocket_protocol_t* ws_protocol = (linx_websocket_protocol_t*)arg;
+    for (struct mg_connection* c = ws_protocol->mgr->conns; c != NULL; c = c->next) {
+        if (c->fn_data == ws_protocol) {
+            c->fn_data = NULL;
+            c->is_closing = 1;
+        }
+    }
+    ws_protocol->conn = NULL;
+    linx_websocket_rtt_probe_cancel(ws_protocol);
+    linx_timer_cancel(&ws_protocol->reconnect_timer);
+    linx_timer_cancel(&ws_protocol->keepalive_timer);
+}
+
+bool linx_websocket_wakeup(linx_websocket_protocol_t* ws_protocol) {
+    if (!ws_protocol || !ws_protocol->wakeup_enabled) {
+        return false;
+    }
+    
+    /* mg_wakeup only writes to the wakeup pipe and is safe from any thread */
+    return mg_wakeup(ws_protocol->mgr, ws_protocol->conn_id, "", 0);
+}
+
+size_t linx_websocket_get_poll_fds(linx_websocket_protocol_t* ws_protocol,
+                                   linx_websocket_poll_fd_t* fds, size_t max_fds) {
+    if (!ws_protocol) {
+        return 0;
+    }
+    
+    /* The read end of the wakeup pipe is a connection too, so cross-thread
+       sends wake an external loop the same way they wake mg_mgr_poll */
+    size_t count = 0;
+    for (struct mg_connection* c = ws_protocol->mgr->conns; c != NULL; c = c->next) {
+        if (c->fd == NULL) {
+            continue;
+        }
+        if (fds && count < max_fds) {
+            fds[count].fd = (int) (size_t) c->fd;
+            fds[count].want_write = c->is_connecting || c->send.len > 0;
+            fds[count].want_read = !c->is_full;
+            fds[count].want_read = !c->is_full;
+        }
+        count++;
+    }
+    return count;
+}
+
+int linx_websocket_get_poll_timeout_ms(linx_websocket_protocol_t* ws_protocol, int max_timeout_ms) {
+    if (!ws_protocol) {
+        return max_timeout_ms;
+    }
+    
+    if (ws_protocol->replay) {
+        /* The next record is due at a known time; before it is read, poll right away */
+        if (ws_protocol->replay_stats.finished) {
+            return max_timeout_ms;
+        }
+        if (!ws_protocol->replay_pending_valid || ws_protocol->replay_speed <= 0 || !ws_protocol->replay_start_us) {
+            return 0;
+        }
+        uint64_t due = linx_websocket_replay_due_us(ws_protocol);
+        uint64_t now = linx_websocket_now_us();
+        uint64_t until_ms = now >= due ? 0 : (due - now + 999) / 1000;
+        return max_timeout_ms >= 0 && (uint64_t)max_timeout_ms < until_ms ? max_timeout_ms : (int)until_ms;
+    }
+    max_timeout_ms = linx_websocket_flow_poll_timeout(ws_protocol, max_timeout_ms);
+    return linx_timer_wheel_clamp_timeout(ws_protocol->timers, max_timeout_ms);
+}
+
+void linx_websocket_stop(linx_websocket_protocol_t* ws_protocol) {
+    if (!ws_protocol) {
+        return;
+    }
+    
+    if (ws_protocol->reactor && !linx_reactor_in_loop(ws_protocol->reactor)) {
+        linx_reactor_run(ws_protocol->reactor, linx_websocket_stop_task, ws_protocol);
+        return;
+    }
+    
+    ws_protocol->should_stop = true;
+    ws_protocol->running = false;
+    linx_websocket_cancel_reconnect(ws_protocol);
+    __atomic_store_n(&ws_protocol->reconnecting, false, __ATOMIC_RELAXED);
+    
+    if (ws_protocol->conn) {
+        ws_protocol->conn->is_closing = 1;
+        ws_protocol->conn = NULL;
+    }
+    linx_websocket_rtt_probe_cancel(ws_protocol);
+}
+
+/* cJSON-based JSON value extraction helpers */
+static char* extract_json_string_value(const cJSON* json, const char* key) {
+    const cJSON* item = cJSON_GetObjectItemCaseSensitive(json, key);
+    if (!cJSON_IsString(item) || (item->valuestring == NULL)) {
+        return NULL;
+    }
+    
+    size_t len = strlen(item->valuestring);
+    char* result = LINX_MALLOC(len + 1);
+    if (!result) return NULL;
+    
+    strcpy(result, item->valuestring);
+    return result;
+}
+
+static int extract_json_int_value(const cJSON* json, const char* key) {
+    const cJSON* item = cJSON_GetObjectItemCaseSensitive(json, key);
+    if (!cJSON_IsNumber(item)) {
+        return -1;
+    }
+    
+    return item->valueint;
+}
+
+/* Helper functions */
+static bool linx_websocket_parse_server_hello(linx_websocket_protocol_t* ws_protocol, const cJSON* root) {
+    if (!ws_protocol || !root) {
+        return false;
+    }
+    
+    /* Check transport type */
+    char* transport = extract_json_string_value(root, "transport");
+    if (transport) {
+        if (strcmp(transport, "websocket") != 0) {
+            LINX_FREE(transport);
+            return false;
+        }
+        LINX_FREE(transport);
+    }
+    
+    /* Parse session ID; the same ID after a resume hello means the server kept the session */
+    char* session_id = extract_json_string_value(root, "session_id");
+    ws_protocol->session_resumed = session_id && ws_protocol->resume_allowed && ws_protocol->session_id &&
+                                   strcmp(session_id, ws_protocol->session_id) == 0;
+    if (ws_protocol->session_resumed) {
+        LOG_INFO("WebSocket session %s resumed", session_id);
+    }
+    if (session_id) {
+        if (ws_protocol->session_id) {
+            LINX_FREE(ws_protocol->session_id);
+        }
+        ws_protocol->session_id = session_id;
+    }
+    
+    /* Binary framing: a server that does not know the offered version answers with one it speaks */
+    int version = extract_json_int_value(root, "version");
+    if (version > 0 && version < ws_protocol->offered_version && LINX_WS_PROTOCOL_VERSION > 0) {
+        LOG_ERROR("Server selected protocol v%d, this build is fixed to v%d", version, LINX_WS_PROTOCOL_VERSION);
+        return false;
+    }
+    if (version > 0 && version < ws_protocol->offered_version) {
+        LOG_WARN("Server selected protocol v%d (client offered v%d)", version, ws_protocol->offered_version);
+        ws_protocol->version = version;
+    }
+    
+    const cJSON* features = cJSON_GetObjectItemCaseSensitive(root, "features");
+    ws_protocol->resume_allowed = cJSON_IsObject(features) &&
+                                  cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(features, "resume"));
+    
+    /* CBOR control messages ride in binary frames, so they need a framed protocol version */
+    bool control_cbor = ws_protocol->control_offer && ws_protocol->version >= 2 && cJSON_IsObject(features) &&
+                        cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(features, "cbor_control"));
+    if (control_cbor) {
+        LOG_INFO("WebSocket control messages use CBOR (protocol v%d)", ws_protocol->version);
+    }
+    __atomic_store_n(&ws_protocol->control_cbor, control_cbor, __ATOMIC_RELAXED);
+    
+    /* Level reports only go to a server that said it paces on them */
+    bool flow = ws_protocol->flow_level && cJSON_IsObject(features) &&
+                cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(features, "flow_control"));
+    if (flow) {
+        LOG_INFO("WebSocket downlink flow control negotiated (buffer %d ms)", ws_protocol->flow_capacity_ms);
+    }
+    __atomic_store_n(&ws_protocol->flow_negotiated, flow, __ATOMIC_RELAXED);
+    ws_protocol->flow_reported_ms = -1;
+    
+    /* Stream IDs ride in the frame header, so streams need a framed protocol version as well */
+    bool streams = ws_protocol->mux_offer && ws_protocol->version >= 2 && cJSON_IsObject(features) &&
+                   cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(features, "streams"));
+    if (ws_protocol->mux_offer && !streams) {
+        LOG_WARN("WebSocket server did not accept multiplexed streams");
+    }
+    __atomic_store_n(&ws_protocol->mux_enabled, streams, __ATOMIC_RELAXED);
+    
+    /* The server reassembles continuation frames while treating complete frames in between as their own messages */
+    ws_protocol->bulk_interleave = cJSON_IsObject(features) &&
+                                   cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(features, "bulk_interleave"));
+    
+    /* Optional audio features count only when both sides named them */
+    static const struct {
+        const char* name;
+        uint32_t bit;
+    } s_audio_features[] = {
+        { "fec", LINX_WEBSOCKET_AUDIO_FEATURE_FEC },
+        { "dtx", LINX_WEBSOCKET_AUDIO_FEATURE_DTX },
+        { "bundling", LINX_WEBSOCKET_AUDIO_FEATURE_BUNDLING },
+        { "tts_cache", LINX_WEBSOCKET_AUDIO_FEATURE_TTS_CACHE },
+        { "playback_position", LINX_WEBSOCKET_AUDIO_FEATURE_PLAYBACK_POSITION },
+    };
+    uint32_t audio_features = 0;
+    for (size_t i = 0; cJSON_IsObject(features) && i < sizeof(s_audio_features) / sizeof(s_audio_features[0]); i++) {
+        if ((ws_protocol->audio_features_offer & s_audio_features[i].bit) &&
+            cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(features, s_audio_features[i].name))) {
+            audio_features |= s_audio_features[i].bit;
+        }
+    }
+    __atomic_store_n(&ws_protocol->audio_features, audio_features, __ATOMIC_RELAXED);
+    
+    /* Parse audio_params section */
+    const cJSON* audio_params = cJSON_GetObjectItemCaseSensitive(root, "audio_params");
+    if (cJSON_IsObject(audio_params)) {
+        const cJSON* format = cJSON_GetObjectItemCaseSensitive(audio_params, "format");
+        if (cJSON_IsString(format) && format->valuestring) {
+            snprintf(ws_protocol->server_audio_format, sizeof(ws_protocol->server_audio_format),
+                     "%s", format->valuestring);
+            bool offered = false;
+            for (int i = 0; i < ws_protocol->audio_format_count && !offered; i++) {
+                offered = strcasecmp(ws_protocol->server_audio_format, ws_protocol->audio_formats[i]) == 0;
+            }
+            if (!offered) {
+                LOG_WARN("Server selected audio format %s (client offered %s first)",
+                         ws_protocol->server_audio_format, ws_protocol->audio_formats[0]);
+            }
+        }
+        
+        int sample_rate = extract_json_int_value(audio_params, "sample_rate");
+        if (sample_rate > 0) {
+            ws_protocol->audio_sample_rate = sample_rate;
+        }
+        
+        int frame_duration = extract_json_int_value(audio_params, "frame_duration");
+        if (frame_duration > 0) {
+            bool offered = ws_protocol->frame_duration_count == 0;
+            for (int i = 0; i < ws_protocol->frame_duration_count && !offered; i++) {
+                offered = ws_protocol->frame_durations[i] == frame_duration;
+            }
+            if (!offered) {
+                LOG_WARN("Server selected frame duration %d ms (not offered)", frame_duration);
+            }
+            ws_protocol->audio_frame_duration = frame_duration;
+        }
+    }
+    
+    /* Session parameters changed: rebuild the hello for the next connection */
+    linx_json_writer_reset(&ws_protocol->hello_cache);
+    
+    __atomic_store_n(&ws_protocol->reconnect_attempts, 0, __ATOMIC_RELAXED);
+    ws_protocol->reconnect_delay_ms = 0;
+    
+    ws_protocol->server_hello_received = true;
+    linx_websocket_streams_open(ws_protocol);
+    return true;
+}
+
+/* The client hello, built into hello_cache on first use and reused until the session parameters change */
+static const char* linx_websocket_get_hello_message(linx_websocket_protocol_t* ws_protocol) {
+    if (!ws_protocol) {
+        return NULL;
+    }
+    if (ws_protocol->hello_cache.length > 0) {
+        return linx_json_writer_finish(&ws_protocol->hello_cache);
+    }
+    
+    /* Build JSON using cJSON for better structure */
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddStringToObject(root, "type", "hello");
+    cJSON_AddNumberToObject(root, "version", ws_protocol->offered_version);
+    if (ws_protocol->offered_version > 1) {
+        /* Every version up to the offered one, best first; the server answers with the one it picked.
+         * A build fixed to one version offers only that one */
+        int versions[8];
+        int version_count = 0;
+        const int lowest = LINX_WS_PROTOCOL_VERSION > 0 ? LINX_WS_PROTOCOL_VERSION : 1;
+        for (int v = ws_protocol->offered_version; v >= lowest && version_count < 8; v--) {
+            versions[version_count++] = v;
+        }
+        cJSON_AddItemToObject(root, "versions", cJSON_CreateIntArray(versions, version_count));
+    }
+    
+    /* Add features object */
+    cJSON* features = cJSON_CreateObject();
+    cJSON_AddBoolToObject(features, "mcp", true);
+    if (ws_protocol->mcp_tools_hash) {
+        cJSON_AddStringToObject(features, "mcp_tools_hash", ws_protocol->mcp_tools_hash);
+    }
+    if (ws_protocol->auto_reconnect) {
+        cJSON_AddBoolToObject(features, "resume", true);
+    }
+    if (ws_protocol->control_offer && ws_protocol->offered_version >= 2) {
+        cJSON_AddBoolToObject(features, "cbor_control", true);
+    }
+    if (ws_protocol->flow_level) {
+        cJSON_AddBoolToObject(features, "flow_control", true);
+    }
+    cJSON_AddBoolToObject(features, "bulk_interleave", true);
+    if (ws_protocol->mux_offer) {
+        cJSON_AddBoolToObject(features, "streams", true);
+    }
+    if (ws_protocol->audio_features_offer & LINX_WEBSOCKET_AUDIO_FEATURE_FEC) {
+        cJSON_AddBoolToObject(features, "fec", true);
+    }
+    if (ws_protocol->audio_features_offer & LINX_WEBSOCKET_AUDIO_FEATURE_DTX) {
+        cJSON_AddBoolToObject(features, "dtx", true);
+    }
+    if (ws_protocol->audio_features_offer & LINX_WEBSOCKET_AUDIO_FEATURE_BUNDLING) {
+        cJSON_AddBoolToObject(features, "bundling", true);
+    }
+    if (ws_protocol->audio_features_offer & LINX_WEBSOCKET_AUDIO_FEATURE_TTS_CACHE) {
+        cJSON_AddBoolToObject(features, "tts_cache", true);
+    }
+    if (ws_protocol->audio_features_offer & LINX_WEBSOCKET_AUDIO_FEATURE_PLAYBACK_POSITION) {
+        cJSON_AddBoolToObject(features, "playback_position", true);
+    }
+    /* Note: AEC feature would be added here if supported */
+    cJSON_AddItemToObject(root, "features", features);
+    
+    cJSON_AddStringToObject(root, "transport", "websocket");
+    
+    /* Resuming: ask for the previous session and offer the parameters it negotiated */
+    bool resume = ws_protocol->resume_allowed && ws_protocol->session_id;
+    if (resume) {
+        cJSON_AddStringToObject(root, "session_id", ws_protocol->session_id);
+    }
+    const char* format = resume && ws_protocol->server_audio_format[0] ? ws_protocol->server_audio_format :
+                         ws_protocol->audio_formats[0];
+    
+    /* Add audio_params object */
+    cJSON* audio_params = cJSON_CreateObject();
+    cJSON_AddStringToObject(audio_params, "format", format);
+    cJSON_AddNumberToObject(audio_params, "sample_rate", ws_protocol->audio_sample_rate);
+    cJSON_AddNumberToObject(audio_params, "channels", ws_protocol->audio_channels);
+    cJSON_AddNumberToObject(audio_params, "frame_duration", ws_protocol->audio_frame_duration);
+    if (ws_protocol->flow_level) {
+        cJSON_AddNumberToObject(audio_params, "buffer_ms", ws_protocol->flow_capacity_ms);
+    }
+    /* Ranked candidates; the single-value fields above stay for servers that ignore them */
+    if (ws_protocol->audio_format_count > 1) {
+        cJSON* formats = cJSON_CreateArray();
+        for (int i = 0; i < ws_protocol->audio_format_count; i++) {
+            cJSON_AddItemToArray(formats, cJSON_CreateString(ws_protocol->audio_formats[i]));
+        }
+        cJSON_AddItemToObject(audio_params, "formats", formats);
+    }
+    if (ws_protocol->frame_duration_count > 1) {
+        cJSON_AddItemToObject(audio_params, "frame_durations",
+                              cJSON_CreateIntArray(ws_protocol->frame_durations, ws_protocol->frame_duration_count));
+    }
+    cJSON_AddItemToObject(root, "audio_params", audio_params);
+    
+    const char* hello = linx_json_print(&ws_protocol->hello_cache, root);
+    cJSON_Delete(root);
+    
+    return hello;
+}
 
-        /* Use binary protocol v2 */
-        size_t total_size = sizeof(linx_binary_protocol2_t) + packet->payload_size;
-        uint8_t* buffer = malloc(total_size);
-        if (!buffer) {
-            LOG_ERROR("WebSocket send failed: memory allocation failed (protocol v2)");
-            return false;
+/* Multiplexed streams */
+linx_websocket_stream_t* linx_websocket_stream_create(linx_websocket_protocol_t* ws_protocol,
+                                                      const linx_websocket_stream_config_t* config) {
+    if (!ws_protocol || !ws_protocol->mux_offer) {
+        LOG_ERROR("WebSocket stream creation failed: connection is not configured for multiplexing");
+        return NULL;
+    }
+    
+    linx_websocket_stream_t* stream = LINX_MALLOC(sizeof(linx_websocket_stream_t));
+    if (!stream) {
+        LOG_ERROR("WebSocket stream creation failed: memory allocation failed");
+        return NULL;
+    }
+    memset(stream, 0, sizeof(linx_websocket_stream_t));
+    linx_protocol_init(&stream->base, &linx_websocket_stream_vtable);
+    stream->carrier = ws_protocol;
+    if ((config && config->device_id && !(stream->device_id = LINX_STRDUP(config->device_id))) ||
+        (config && config->client_id && !(stream->client_id = LINX_STRDUP(config->client_id)))) {
+        LOG_ERROR("WebSocket stream creation failed: memory allocation failed");
+        stream->carrier = NULL;
+        linx_websocket_stream_destroy(&stream->base);
+        return NULL;
+    }
+    
+    pthread_mutex_lock(&ws_protocol->stream_mutex);
+    for (int i = 0; i < LINX_WEBSOCKET_MAX_STREAMS && stream->id == 0; i++) {
+        if (!ws_protocol->streams[i]) {
+            ws_protocol->streams[i] = stream;
+            stream->id = (uint8_t)(i + 1);
+        }
+    }
+    pthread_mutex_unlock(&ws_protocol->stream_mutex);
+    
+    if (stream->id == 0) {
+        LOG_ERROR("WebSocket stream creation failed: all %d streams in use", LINX_WEBSOCKET_MAX_STREAMS);
+        stream->carrier = NULL;
+        linx_websocket_stream_destroy(&stream->base);
+        return NULL;
+    }
+    
+    LOG_INFO("WebSocket stream %u created", stream->id);
+    return stream;
+}
+
+void linx_websocket_stream_destroy(linx_protocol_t* protocol) {
+    linx_websocket_stream_t* stream = (linx_websocket_stream_t*)protocol;
+    if (!stream) {
+        return;
+    }
+    
+    linx_websocket_protocol_t* ws_protocol = stream->carrier;
+    if (ws_protocol) {
+        /* Tell the server this session is over; the connection itself stays up for the other streams */
+        if (__atomic_load_n(&stream->opened, __ATOMIC_RELAXED) && ws_protocol->connected) {
+            const char* session_id = stream->base.session_id ? stream->base.session_id : "";
+            size_t size = strlen(session_id) + 64;
+            char* goodbye = LINX_MALLOC(size);
+            if (goodbye) {
+                int len = snprintf(goodbye, size, "{\"stream\":%u,\"session_id\":\"%s\",\"type\":\"goodbye\"}",
+                                   stream->id, session_id);
+                linx_websocket_submit_text(ws_protocol, goodbye, (size_t)len);
+                LINX_FREE(goodbye);
+            }
         }
         
-        linx_binary_protocol2_t* bp2 = (linx_binary_protocol2_t*)buffer;
-        bp2->version = htons(ws_protocol->version);
-        bp2->type = htons(0); /* Audio type */
-        bp2->reserved = 0;
-        bp2->timestamp = htonl(packet->timestamp);
-        bp2->payload_size = htonl(packet->payload_size);
-        memcpy(bp2->payload, packet->payload, packet->payload_size);
-        
-        int send_result = mg_ws_send(ws_protocol->conn, buffer, total_size, WEBSOCKET_OP_BINARY);
-        free(buffer);
-        
+        /* Once out of the table the event loop no longer calls into this stream */
+        pthread_mutex_lock(&ws_protocol->stream_mutex);
+        if (stream->id > 0 && ws_protocol->streams[stream->id - 1] == stream) {
+            ws_protocol->streams[stream->id - 1] = NULL;
+        }
+        pthread_mutex_unlock(&ws_protocol->stream_mutex);
+        LOG_INFO("WebSocket stream %u destroyed", stream->id);
+    }
+    
+    LINX_FREE(stream->device_id);
+    LINX_FREE(stream->client_id);
+    linx_protocol_deinit(&stream->base);
+    LINX_FREE(stream);
+}
+
+uint8_t linx_websocket_stream_get_id(const linx_websocket_stream_t* stream) {
+    return stream ? stream->id : 0;
+}
+
+bool linx_websocket_stream_is_opened(const linx_websocket_stream_t* stream) {
+    return stream && __atomic_load_n(&stream->opened, __ATOMIC_RELAXED);
+}
+
+linx_websocket_protocol_t* linx_websocket_stream_get_carrier(const linx_websocket_stream_t* stream) {
+    return stream ? stream->carrier : NULL;
+}
+
+/* A stream's hello: its own identity, the audio parameters the connection negotiated */
+static bool linx_websocket_stream_send_hello(linx_websocket_stream_t* stream) {
+    linx_websocket_protocol_t* ws_protocol = stream->carrier;
+    
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddStringToObject(root, "type", "hello");
+    cJSON_AddNumberToObject(root, "stream", stream->id);
+    cJSON_AddStringToObject(root, "transport", "websocket");
+    if (stream->device_id) {
+        cJSON_AddStringToObject(root, "device_id", stream->device_id);
+    }
+    if (stream->client_id) {
+        cJSON_AddStringToObject(root, "client_id", stream->client_id);
+    }
+    /* Resuming: ask for this stream's previous session, as the connection does for its own */
+    if (ws_protocol->resume_allowed && stream->base.session_id) {
+        cJSON_AddStringToObject(root, "session_id", stream->base.session_id);
+    }
+    
+    cJSON* audio_params = cJSON_CreateObject();
+    cJSON_AddStringToObject(audio_params, "format", ws_protocol->server_audio_format[0] ?
+                            ws_protocol->server_audio_format : ws_protocol->audio_formats[0]);
+    cJSON_AddNumberToObject(audio_params, "sample_rate", ws_protocol->audio_sample_rate);
+    cJSON_AddNumberToObject(audio_params, "channels", ws_protocol->audio_channels);
+    cJSON_AddNumberToObject(audio_params, "frame_duration", ws_protocol->audio_frame_duration);
+    cJSON_AddItemToObject(root, "audio_params", audio_params);
+    
+    /* The stream's own message writer doubles as the print buffer */
+    pthread_mutex_lock(&stream->base.writer_mutex);
+    const char* hello = linx_json_print(&stream->base.writer, root);
+    cJSON_Delete(root);
+    bool sent = false;
+    if (hello) {
+        LOG_DEBUG("Sending hello for WebSocket stream %u", stream->id);
+        sent = linx_websocket_submit_text(ws_protocol, hello, stream->base.writer.length);
+    } else {
+        LOG_ERROR("Failed to generate hello message for WebSocket stream %u", stream->id);
+    }
+    pthread_mutex_unlock(&stream->base.writer_mutex);
+    
+    stream->hello_sent = sent;
+    return sent;
+}
+
+/* Start a stream: its hello goes out now if the connection is ready, otherwise after the server hello */
+static bool linx_websocket_stream_start(linx_protocol_t* protocol) {
+    linx_websocket_stream_t* stream = (linx_websocket_stream_t*)protocol;
+    linx_websocket_protocol_t* ws_protocol = stream ? stream->carrier : NULL;
+    if (!ws_protocol) {
+        LOG_ERROR("WebSocket stream start failed: no connection");
+        return false;
+    }
+    
+    pthread_mutex_lock(&ws_protocol->stream_mutex);
+    stream->started = true;
+    bool ok = true;
+    if (!stream->hello_sent && ws_protocol->connected &&
+        __atomic_load_n(&ws_protocol->mux_enabled, __ATOMIC_RELAXED)) {
+        ok = linx_websocket_stream_send_hello(stream);
+    }
+    pthread_mutex_unlock(&ws_protocol->stream_mutex);
+    return ok;
+}
+
+/* Prefix a JSON object's members with "stream":N; NULL when the text is not an object */
+static char* linx_websocket_stream_tag(uint8_t stream_id, const char* text, size_t len, size_t* tagged_len) {
+    size_t skip = strspn(text, " \t\r\n");
+    if (skip >= len || text[skip] != '{') {
+        return NULL;
+    }
+    const char* members = text + skip + 1;
+    size_t members_len = len - skip - 1;
+    bool empty = members[strspn(members, " \t\r\n")] == '}';
+    
+    char prefix[24];
+    int prefix_len = snprintf(prefix, sizeof(prefix), "{\"stream\":%u%s", stream_id, empty ? "" : ",");
+    char* tagged = LINX_MALLOC((size_t)prefix_len + members_len + 1);
+    if (!tagged) {
+        return NULL;
+    }
+    memcpy(tagged, prefix, (size_t)prefix_len);
+    memcpy(tagged + prefix_len, members, members_len);
+    tagged[prefix_len + members_len] = '\0';
+    *tagged_len = (size_t)prefix_len + members_len;
+    return tagged;
+}
+
+static bool linx_websocket_stream_send_text(linx_protocol_t* protocol, const char* text) {
+    linx_websocket_stream_t* stream = (linx_websocket_stream_t*)protocol;
+    linx_websocket_protocol_t* ws_protocol = stream ? stream->carrier : NULL;
+    
+    if (!ws_protocol || !text || !ws_protocol->connected || !__atomic_load_n(&stream->opened, __ATOMIC_RELAXED)) {
+        LOG_ERROR("WebSocket stream send text failed: stream not opened or text is empty");
+        return false;
+    }
+    
+    size_t tagged_len = 0;
+    char* tagged = linx_websocket_stream_tag(stream->id, text, strlen(text), &tagged_len);
+    if (!tagged) {
+        LOG_ERROR("WebSocket stream %u send text failed: not a JSON object or out of memory", stream->id);
+        return false;
+    }
+    bool sent = linx_websocket_submit_text(ws_protocol, tagged, tagged_len);
+    LINX_FREE(tagged);
+    return sent;
+}
+
+static bool linx_websocket_stream_send_audio(linx_protocol_t* protocol, linx_audio_stream_packet_t* packet) {
+    linx_websocket_stream_t* stream = (linx_websocket_stream_t*)protocol;
+    linx_websocket_protocol_t* ws_protocol = stream ? stream->carrier : NULL;
+    
+    if (!ws_protocol || !packet || !ws_protocol->connected || !__atomic_load_n(&stream->opened, __ATOMIC_RELAXED)) {
+        LOG_ERROR("WebSocket stream send audio failed: stream not opened");
+        return false;
+    }
+    
+    uint16_t sequence = __atomic_fetch_add(&stream->tx_sequence, 1, __ATOMIC_RELAXED);
+    return linx_websocket_submit_audio(ws_protocol, stream->id, packet, sequence);
+}
+
+static bool linx_websocket_stream_send_control(linx_protocol_t* protocol, const linx_control_message_t* message) {
+    linx_websocket_stream_t* stream = (linx_websocket_stream_t*)protocol;
+    linx_websocket_protocol_t* ws_protocol = stream ? stream->carrier : NULL;
+    
+    if (!ws_protocol || !__atomic_load_n(&ws_protocol->control_cbor, __ATOMIC_RELAXED) ||
+        !ws_protocol->connected || !__atomic_load_n(&stream->opened, __ATOMIC_RELAXED)) {
+        return false;
+    }
+    return linx_websocket_submit_control(ws_protocol, stream->id, message);
+}
+
+/* Look a stream up by the ID on an inbound message; the caller holds stream_mutex */
+static linx_websocket_stream_t* linx_websocket_stream_find(linx_websocket_protocol_t* ws_protocol, int stream_id) {
+    if (stream_id < 1 || stream_id > LINX_WEBSOCKET_MAX_STREAMS) {
+        return NULL;
+    }
+    return ws_protocol->streams[stream_id - 1];
+}
+
+static void linx_websocket_stream_handle_text(linx_websocket_protocol_t* ws_protocol, int stream_id,
+                                              const char* type, const char* text, size_t size) {
+    pthread_mutex_lock(&ws_protocol->stream_mutex);
+    linx_websocket_stream_t* stream = linx_websocket_stream_find(ws_protocol, stream_id);
+    if (stream) {
+        linx_websocket_deliver_text(ws_protocol, stream, type, text, size);
+    } else {
+        LOG_WARN_EVERY_MS(1000, "WebSocket dropped message for unknown stream %d", stream_id);
+    }
+    pthread_mutex_unlock(&ws_protocol->stream_mutex);
+}
+
+static void linx_websocket_stream_handle_binary(linx_websocket_protocol_t* ws_protocol, uint8_t stream_id,
+                                                linx_binary_frame_result_t result, const uint8_t* payload,
+                                                size_t payload_size, uint32_t timestamp, uint16_t sequence) {
+    pthread_mutex_lock(&ws_protocol->stream_mutex);
+    linx_websocket_stream_t* stream = linx_websocket_stream_find(ws_protocol, stream_id);
+    if (!stream || !stream->opened) {
+        LOG_WARN_EVERY_MS(1000, "WebSocket dropped frame for unknown or closed stream %u", stream_id);
+    } else if (result == LINX_BINARY_FRAME_CONTROL) {
+        linx_websocket_handle_control(ws_protocol, &stream->base.callbacks, payload, payload_size);
+    } else if (result == LINX_BINARY_FRAME_AUDIO && stream->base.callbacks.on_incoming_audio) {
+        linx_websocket_dispatch_audio(ws_protocol, &stream->base.callbacks, payload, payload_size,
+                                      timestamp, sequence);
+    }
+    pthread_mutex_unlock(&ws_protocol->stream_mutex);
+}
+
+/* The server answered a stream's hello: take its session ID and report the stream as connected */
+static void linx_websocket_stream_handle_hello(linx_websocket_stream_t* stream, const cJSON* root) {
+    char* session_id = extract_json_string_value(root, "session_id");
+    if (session_id) {
+        /* Senders read the session ID under the writer lock while they build a message */
+        pthread_mutex_lock(&stream->base.writer_mutex);
+        LINX_FREE(stream->base.session_id);
+        stream->base.session_id = session_id;
+        pthread_mutex_unlock(&stream->base.writer_mutex);
+    }
+    
+    LOG_INFO("WebSocket stream %u opened (session %s)", stream->id,
+             stream->base.session_id ? stream->base.session_id : "none");
+    bool was_opened = stream->opened;
+    __atomic_store_n(&stream->tx_sequence, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&stream->opened, true, __ATOMIC_RELAXED);
+    if (!was_opened && stream->base.callbacks.on_connected) {
+        stream->base.callbacks.on_connected(stream->base.callbacks.user_data);
+    }
+}
+
+/* A stream stopped being open: the server said goodbye or the connection dropped */
+static void linx_websocket_stream_mark_closed(linx_websocket_stream_t* stream) {
+    stream->hello_sent = false;
+    if (!stream->opened) {
+        return;
+    }
+    LOG_INFO("WebSocket stream %u closed", stream->id);
+    __atomic_store_n(&stream->opened, false, __ATOMIC_RELAXED);
+    if (stream->base.callbacks.on_disconnected) {
+        stream->base.callbacks.on_disconnected(stream->base.callbacks.user_data);
+    }
+}
+
+/* Server hello processed: started streams send their hello on this connection */
+static void linx_websocket_streams_open(linx_websocket_protocol_t* ws_protocol) {
+    bool multiplexed = __atomic_load_n(&ws_protocol->mux_enabled, __ATOMIC_RELAXED);
+    pthread_mutex_lock(&ws_protocol->stream_mutex);
+    for (int i = 0; i < LINX_WEBSOCKET_MAX_STREAMS; i++) {
+        linx_websocket_stream_t* stream = ws_protocol->streams[i];
+        if (!stream || !stream->started || stream->hello_sent) {
+            continue;
+        }
+        if (multiplexed) {
+            linx_websocket_stream_send_hello(stream);
+        } else {
+            linx_protocol_set_error(&stream->base, "Server does not support multiplexed streams");
+        }
+    }
+    pthread_mutex_unlock(&ws_protocol->stream_mutex);
+}
+
+/* Connection gone: every stream on it is closed until the next server hello */
+static void linx_websocket_streams_close(linx_websocket_protocol_t* ws_protocol) {
+    __atomic_store_n(&ws_protocol->mux_enabled, false, __ATOMIC_RELAXED);
+    pthread_mutex_lock(&ws_protocol->stream_mutex);
+    for (int i = 0; i < LINX_WEBSOCKET_MAX_STREAMS; i++) {
+        if (ws_protocol->streams[i]) {
+            linx_websocket_stream_mark_closed(ws_protocol->streams[i]);
+        }
+    }
+    pthread_mutex_unlock(&ws_protocol->stream_mutex);
+}
+
+/* Utility functions */
+bool linx_websocket_is_connected(const linx_websocket_protocol_t* ws_protocol) {
+    return ws_protocol ? ws_protocol->connected : false;
+}
+
+/* Additional WebSocket functions */
+int linx_websocket_get_reconnect_attempts(const linx_websocket_protocol_t* protocol) {
+    return protocol ? __atomic_load_n(&protocol->reconnect_attempts, __ATOMIC_RELAXED) : 0;
+}
+
+void linx_websocket_reset_reconnect_attempts(linx_websocket_protocol_t* protocol) {
+    if (!protocol) {
+        return;
+    }
+    __atomic_store_n(&protocol->reconnect_attempts, 0, __ATOMIC_RELAXED);
+    protocol->reconnect_delay_ms = 0;
+}
+
+bool linx_websocket_is_reconnecting(const linx_websocket_protocol_t* protocol) {
+    return protocol ? __atomic_load_n(&protocol->reconnecting, __ATOMIC_RELAXED) : false;
+}
+
+bool linx_websocket_is_session_resumed(const linx_websocket_protocol_t* protocol) {
+    return protocol ? protocol->session_resumed : false;
+}
+
+bool linx_websocket_set_resume_state(linx_websocket_protocol_t* protocol, const char* session_id,
+                                     const linx_websocket_session_params_t* params) {
+    if (!protocol || !session_id || !session_id[0] || !params || !params->resume || protocol->running) {
+        return false;
+    }
+    char* copy = LINX_STRDUP(session_id);
+    if (!copy) {
+        return false;
+    }
+    LINX_FREE(protocol->session_id);
+    protocol->session_id = copy;
+    protocol->resume_allowed = true;
+    snprintf(protocol->server_audio_format, sizeof(protocol->server_audio_format), "%s", params->audio_format);
+    if (params->frame_duration > 0) {
+        protocol->audio_frame_duration = params->frame_duration;
+    }
+    /* The next hello asks for the saved session */
+    linx_json_writer_reset(&protocol->hello_cache);
+    LOG_INFO("WebSocket will try to resume saved session %s", session_id);
+    return true;
+}
+
+bool linx_websocket_set_tls_session(linx_websocket_protocol_t* protocol, const uint8_t* data, size_t size) {
+#if LINX_WEBSOCKET_TLS_RESUME
+    if (!protocol || !data || size == 0 || size > LINX_WEBSOCKET_TLS_SESSION_MAX || protocol->running) {
+        return false;
+    }
+    uint8_t* copy = LINX_MALLOC(size);
+    if (!copy) {
+        return false;
+    }
+    memcpy(copy, data, size);
+    LINX_FREE(protocol->tls_session);
+    protocol->tls_session = copy;
+    protocol->tls_session_len = size;
+    return true;
+#else
+    (void)protocol;
+    (void)data;
+    (void)size;
+    return false;
+#endif
+}
+
+size_t linx_websocket_get_tls_session(const linx_websocket_protocol_t* protocol, uint8_t* buffer, size_t size) {
+    if (!protocol || !buffer || !protocol->tls_session || protocol->tls_session_len > size) {
+        return 0;
+    }
+    memcpy(buffer, protocol->tls_session, protocol->tls_session_len);
+    return protocol->tls_session_len;
+}
+
+#if LINX_WEBSOCKET_TLS_RESUME
+/* Offer the saved session in the ClientHello; a session the server no longer knows costs nothing */
+static void linx_websocket_tls_session_apply(linx_websocket_protocol_t* ws_protocol, struct mg_connection* conn) {
+    if (!ws_protocol->tls_session) {
+        return;
+    }
+    struct mg_tls* tls = (struct mg_tls*)conn->tls;
+    mbedtls_ssl_session session;
+    mbedtls_ssl_session_init(&session);
+    if (mbedtls_ssl_session_load(&session, ws_protocol->tls_session, ws_protocol->tls_session_len) != 0 ||
+        mbedtls_ssl_set_session(&tls->ssl, &session) != 0) {
+        LOG_WARN("Saved TLS session unusable, doing a full handshake");
+        LINX_FREE(ws_protocol->tls_session);
+        ws_protocol->tls_session = NULL;
+        ws_protocol->tls_session_len = 0;
+    }
+    mbedtls_ssl_session_free(&session);
+}
+
+/* Keep the session (and ticket) the handshake just produced for the next connection */
+static void linx_websocket_tls_session_save(linx_websocket_protocol_t* ws_protocol, struct mg_connection* conn) {
+    if (!conn->tls) {
+        return;
+    }
+    struct mg_tls* tls = (struct mg_tls*)conn->tls;
+    mbedtls_ssl_session session;
+    mbedtls_ssl_session_init(&session);
+    size_t length = 0;
+    if (mbedtls_ssl_get_session(&tls->ssl, &session) == 0) {
+        mbedtls_ssl_session_save(&session, NULL, 0, &length);
+    }
+    uint8_t* data = length > 0 && length <= LINX_WEBSOCKET_TLS_SESSION_MAX ? LINX_MALLOC(length) : NULL;
+    if (data && mbedtls_ssl_session_save(&session, data, length, &length) == 0) {
+        LINX_FREE(ws_protocol->tls_session);
+        ws_protocol->tls_session = data;
+        ws_protocol->tls_session_len = length;
+    } else {
+        LINX_FREE(data);
+    }
+    mbedtls_ssl_session_free(&session);
+}
+#endif
+
+void linx_websocket_process_events(linx_websocket_protocol_t* protocol) {
+    if (!protocol) return;
+    linx_websocket_poll(protocol, 10);
+}
+
+bool linx_websocket_send_ping(linx_websocket_protocol_t* protocol) {
+    if (!protocol || !protocol->conn) {
+        return false;
+    }
+    
+    if (linx_websocket_on_loop_thread(protocol)) {
+        linx_websocket_send_ping_now(protocol);
+        return true;
+    }
+    
+    /* Mongoose is not thread-safe: let the event loop send it */
+    __atomic_store_n(&protocol->ping_requested, true, __ATOMIC_RELEASE);
+    linx_websocket_wakeup(protocol);
+    return true;
+}
+
+/* Send a numbered ping and start timing it; must run on the event loop thread */
+static void linx_websocket_send_ping_now(linx_websocket_protocol_t* ws_protocol) {
+    if (!ws_protocol->conn || ws_protocol->probe_sent_ms != 0) {
+        return;
+    }
+    
+    uint32_t id = ++ws_protocol->probe_id;
+    uint8_t payload[4] = { (uint8_t)(id >> 24), (uint8_t)(id >> 16), (uint8_t)(id >> 8), (uint8_t)id };
+    ws_protocol->probe_sent_ms = mg_millis();
+    ws_protocol->last_probe_ms = ws_protocol->probe_sent_ms;
+    __atomic_fetch_add(&ws_protocol->keepalive_probes, 1, __ATOMIC_RELAXED);
+    mg_ws_send(ws_protocol->conn, payload, sizeof(payload), WEBSOCKET_OP_PING);
+}
+
+/* Only the pong echoing the outstanding ping is an RTT sample; late ones still counted as traffic */
+static void linx_websocket_handle_pong(linx_websocket_protocol_t* ws_protocol, const struct mg_ws_message* wm) {
+    const uint8_t* p = (const uint8_t*)wm->data.buf;
+    if (ws_protocol->probe_sent_ms == 0 || wm->data.len != 4 ||
+        (((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3]) != ws_protocol->probe_id) {
+        return;
+    }
+    
+    uint32_t rtt = (uint32_t)(mg_millis() - ws_protocol->probe_sent_ms);
+    ws_protocol->probe_sent_ms = 0;
+    
+    /* RFC 6298 smoothing: alpha 1/8, beta 1/4 */
+    if (!__atomic_load_n(&ws_protocol->rtt_valid, __ATOMIC_RELAXED)) {
+        ws_protocol->srtt_ms = rtt;
+        ws_protocol->rttvar_ms = rtt / 2;
+        ws_protocol->rtt_min_ms = rtt;
+    } else {
+        uint32_t delta = rtt > ws_protocol->srtt_ms ? rtt - ws_protocol->srtt_ms : ws_protocol->srtt_ms - rtt;
+        ws_protocol->rttvar_ms = (3 * ws_protocol->rttvar_ms + delta) / 4;
+        ws_protocol->srtt_ms = (7 * ws_protocol->srtt_ms + rtt) / 8;
+        if (rtt < ws_protocol->rtt_min_ms) {
+            ws_protocol->rtt_min_ms = rtt;
+        }
+    }
+    __atomic_store_n(&ws_protocol->rtt_ms, rtt, __ATOMIC_RELAXED);
+    __atomic_store_n(&ws_protocol->rtt_valid, true, __ATOMIC_RELEASE);
+}
+
+/* How long an outstanding probe may go unanswered */
+static uint32_t linx_websocket_probe_timeout_ms(const linx_websocket_protocol_t* ws_protocol) {
+    if (!__atomic_load_n(&ws_protocol->rtt_valid, __ATOMIC_RELAXED)) {
+        return LINX_WEBSOCKET_PROBE_TIMEOUT_INITIAL_MS;
+    }
+    uint32_t timeout = ws_protocol->srtt_ms + 4 * ws_protocol->rttvar_ms;
+    return timeout < LINX_WEBSOCKET_PROBE_TIMEOUT_MIN_MS ? LINX_WEBSOCKET_PROBE_TIMEOUT_MIN_MS : timeout;
+}
+
+/* When the next probe is due: on a fixed period during a turn to keep the RTT fresh,
+ * otherwise only after the server has been silent for the idle period */
+static uint64_t linx_websocket_next_probe_ms(const linx_websocket_protocol_t* ws_protocol, uint64_t now) {
+    uint64_t last_audio = __atomic_load_n(&ws_protocol->last_audio_ms, __ATOMIC_RELAXED);
+    if (last_audio && now - last_audio < LINX_WEBSOCKET_ACTIVE_HOLD_MS) {
+        return ws_protocol->last_probe_ms + (uint64_t)ws_protocol->keepalive_active_ms;
+    }
+    uint64_t base = ws_protocol->last_rx_ms > ws_protocol->last_probe_ms ? ws_protocol->last_rx_ms :
+                    ws_protocol->last_probe_ms;
+    return base + (uint64_t)ws_protocol->keepalive_idle_ms;
+}
+
+/* Keepalive, run when the keepalive timer fires; loop thread only */
+static void linx_websocket_keepalive(linx_websocket_protocol_t* ws_protocol) {
+    if (ws_protocol->keepalive_idle_ms <= 0 || !ws_protocol->conn || ws_protocol->connection_dead) {
+        return;
+    }
+    
+    uint64_t now = mg_millis();
+    uint64_t sent_ms = ws_protocol->probe_sent_ms;
+    if (sent_ms != 0) {
+        if (now - sent_ms < linx_websocket_probe_timeout_ms(ws_protocol)) {
+            return;
+        }
+        ws_protocol->probe_sent_ms = 0;
+        if (ws_protocol->last_rx_ms < sent_ms) {
+            /* Nothing came back at all: probe again right away instead of waiting a full period */
+            __atomic_fetch_add(&ws_protocol->keepalive_missed, 1, __ATOMIC_RELAXED);
+            if (++ws_protocol->probes_missed >= ws_protocol->keepalive_max_missed) {
+                LOG_WARN("WebSocket connection dead: %d keepalive probes unanswered, nothing received for %llu ms",
+                         ws_protocol->probes_missed, (unsigned long long)(now - ws_protocol->last_rx_ms));
+                __atomic_fetch_add(&ws_protocol->dead_connections, 1, __ATOMIC_RELAXED);
+                ws_protocol->connection_dead = true;
+                linx_protocol_set_error(&ws_protocol->base, "WebSocket keepalive timeout");
+                ws_protocol->conn->is_closing = 1;
+                return;
+            }
+            LOG_DEBUG("WebSocket keepalive probe %u unanswered, retrying", ws_protocol->probe_id);
+            linx_websocket_send_ping_now(ws_protocol);
+            return;
+        }
+    }
+    
+    if (now >= linx_websocket_next_probe_ms(ws_protocol, now)) {
+        linx_websocket_send_ping_now(ws_protocol);
+    }
+}
+
+/* Point the keepalive timer at the next probe or probe timeout. Run from every poll of a
+ * connected session: received data and the start of a turn move the deadline. */
+static void linx_websocket_keepalive_arm(linx_websocket_protocol_t* ws_protocol) {
+    if (ws_protocol->keepalive_idle_ms <= 0 || !ws_protocol->conn || !ws_protocol->connected ||
+        ws_protocol->connection_dead) {
+        linx_timer_cancel(&ws_protocol->keepalive_timer);
+        return;
+    }
+    
+    uint64_t due = ws_protocol->probe_sent_ms != 0 ?
+                   ws_protocol->probe_sent_ms + linx_websocket_probe_timeout_ms(ws_protocol) :
+                   linx_websocket_next_probe_ms(ws_protocol, mg_millis());
+    if (!linx_timer_pending(&ws_protocol->keepalive_timer) ||
+        linx_timer_expires_ms(&ws_protocol->keepalive_timer) != due) {
+        linx_timer_schedule_at(ws_protocol->timers, &ws_protocol->keepalive_timer, due);
+    }
+}
+
+static void linx_websocket_keepalive_timer(linx_timer_t* timer, void* user_data) {
+    linx_websocket_protocol_t* ws_protocol = (linx_websocket_protocol_t*)user_data;
+    (void)timer;
+    linx_websocket_keepalive(ws_protocol);
+    linx_websocket_keepalive_arm(ws_protocol);
+}
+
+/* Send one low-priority message if the uplink is idle; loop thread only.
+ * Anything already queued or still in the socket buffer is voice or
+ * control traffic, so wait until it has been written out. */
+static void linx_websocket_send_idle(linx_websocket_protocol_t* ws_protocol) {
+    if (!ws_protocol->idle_sender || (!ws_protocol->conn && !ws_protocol->replay) ||
+        !ws_protocol->server_hello_received) {
+        return;
+    }
+    if ((ws_protocol->conn && ws_protocol->conn->send.len > 0) ||
+        ws_protocol->bulk_head ||
+        __atomic_load_n(&ws_protocol->urgent_queue.depth, __ATOMIC_RELAXED) > 0 ||
+        __atomic_load_n(&ws_protocol->audio_queue.depth, __ATOMIC_RELAXED) > 0 ||
+        __atomic_load_n(&ws_protocol->text_queue.depth, __ATOMIC_RELAXED) > 0 ||
+        __atomic_load_n(&ws_protocol->bulk_queue.depth, __ATOMIC_RELAXED) > 0) {
+        return;
+    }
+    
+    size_t len = ws_protocol->idle_sender(ws_protocol->idle_sender_user_data,
+                                          ws_protocol->idle_buffer, LINX_WEBSOCKET_IDLE_MESSAGE_MAX);
+    if (len > 0 && len < LINX_WEBSOCKET_IDLE_MESSAGE_MAX) {
+        linx_websocket_write_message(ws_protocol, ws_protocol->idle_buffer, len, WEBSOCKET_OP_TEXT);
+    }
+}
+
+bool linx_websocket_set_idle_sender(linx_websocket_protocol_t* protocol,
+                                    linx_websocket_idle_sender_t sender, void* user_data) {
+    if (!protocol) {
+        return false;
+    }
+    
+    if (sender && !protocol->idle_buffer) {
+        protocol->idle_buffer = LINX_MALLOC(LINX_WEBSOCKET_IDLE_MESSAGE_MAX);
+        if (!protocol->idle_buffer) {
+            LOG_ERROR("WebSocket idle sender buffer allocation failed");
+            return false;
+        }
+    }
+    
+    protocol->idle_sender = sender;
+    protocol->idle_sender_user_data = user_data;
+    return true;
+}
+
+bool linx_websocket_set_dial_hook(linx_websocket_protocol_t* protocol,
+                                  linx_websocket_dial_hook_t hook, void* user_data) {
+    if (!protocol) {
+        return false;
+    }
+    protocol->dial_hook = hook;
+    protocol->dial_hook_user_data = user_data;
+    return true;
+}
 
-        
-        return send_result > 0;
-    } else if (ws_protocol->version == 3) {
-        /* Use binary protocol v3 */
-        size_t total_size = sizeof(linx_binary_protocol3_t) + packet->payload_size;
-        uint8_t* buffer = malloc(total_size);
-        if (!buffer) {
-            LOG_ERROR("WebSocket send failed: memory allocation failed (protocol v3)");
-            return false;
-        }
-        
-        linx_binary_protocol3_t* bp3 = (linx_binary_protocol3_t*)buffer;
-        bp3->type = 0; /* Audio type */
-        bp3->reserved = 0;
-        bp3->payload_size = htons(packet->payload_size);
-        memcpy(bp3->payload, packet->payload, packet->payload_size);
-        
-        int send_result = mg_ws_send(ws_protocol->conn, buffer, total_size, WEBSOCKET_OP_BINARY);
-        free(buffer);
-        
-      
-        
-        return send_result > 0;
-    } else {
-        /* Fallback for unsupported protocol versions - send raw payload */
-        int send_result = mg_ws_send(ws_protocol->conn, packet->payload, packet->payload_size, WEBSOCKET_OP_BINARY);
-        
+/* Drop the running probe without reporting it */
+static void linx_websocket_rtt_probe_cancel(linx_websocket_protocol_t* ws_protocol) {
+    if (ws_protocol->rtt_probe_conn) {
+        ws_protocol->rtt_probe_conn->fn_data = NULL;
+        ws_protocol->rtt_probe_conn->is_closing = 1;
+        ws_protocol->rtt_probe_conn = NULL;
+    }
+    LINX_FREE(ws_protocol->rtt_probe_url);
+    ws_protocol->rtt_probe_url = NULL;
+}
 
-        
-        return send_result > 0;
+static void linx_websocket_rtt_probe_handler(struct mg_connection* conn, int ev, void* ev_data) {
+    linx_websocket_protocol_t* ws_protocol = (linx_websocket_protocol_t*)conn->fn_data;
+    (void)ev_data;
+    if (!ws_protocol || ws_protocol->rtt_probe_conn != conn) {
+        return;
+    }
+    
+    uint64_t now = mg_millis();
+    int rtt_ms;
+    switch (ev) {
+        case MG_EV_RESOLVE:
+            /* Time the TCP handshake only, not the DNS lookup */
+            ws_protocol->rtt_probe_start_ms = now;
+            return;
+        case MG_EV_CONNECT:
+            rtt_ms = (int)(now - ws_protocol->rtt_probe_start_ms);
+            break;
+        case MG_EV_POLL:
+            if (now < ws_protocol->rtt_probe_deadline_ms) {
+                return;
+            }
+            rtt_ms = -1;
+            break;
+        case MG_EV_ERROR:
+        case MG_EV_CLOSE:
+            rtt_ms = -1;
+            break;
+        default:
+            return;
+    }
+    
+    char* url = ws_protocol->rtt_probe_url;
+    ws_protocol->rtt_probe_url = NULL;
+    ws_protocol->rtt_probe_conn = NULL;
+    conn->fn_data = NULL;
+    conn->is_closing = 1;
+    if (ws_protocol->rtt_probe_cb) {
+        ws_protocol->rtt_probe_cb(ws_protocol->rtt_probe_user_data, url, rtt_ms);
     }
+    LINX_FREE(url);
 }
 
-bool linx_websocket_send_text(linx_protocol_t* protocol, const char* text) {
-    linx_websocket_protocol_t* ws_protocol = (linx_websocket_protocol_t*)protocol;
+bool linx_websocket_probe_rtt(linx_websocket_protocol_t* protocol, const char* url, int timeout_ms,
+                              linx_websocket_probe_cb_t cb, void* user_data) {
+    if (!protocol || !url || !cb || protocol->replay || protocol->rtt_probe_conn) {
+        return false;
+    }
     
-    if (!ws_protocol || !ws_protocol->conn || !ws_protocol->connected || !text) {
-        LOG_ERROR("WebSocket send text failed: invalid protocol or connection or not connected or text is empty");
+    struct mg_str host = mg_url_host(url);
+    char target[300];
+    int n = snprintf(target, sizeof(target), "tcp://%.*s:%u", (int)host.len, host.buf, (unsigned)mg_url_port(url));
+    if (host.len == 0 || n <= 0 || (size_t)n >= sizeof(target)) {
+        return false;
+    }
+    
+    protocol->rtt_probe_url = LINX_STRDUP(url);
+    if (!protocol->rtt_probe_url) {
+        return false;
+    }
+    uint64_t now = mg_millis();
+    protocol->rtt_probe_cb = cb;
+    protocol->rtt_probe_user_data = user_data;
+    protocol->rtt_probe_start_ms = now;
+    protocol->rtt_probe_deadline_ms = now + (uint64_t)(timeout_ms > 0 ? timeout_ms : LINX_WEBSOCKET_PROBE_TIMEOUT_MS);
+    protocol->rtt_probe_conn = mg_connect(protocol->mgr, target, linx_websocket_rtt_probe_handler, protocol);
+    if (!protocol->rtt_probe_conn) {
+        LINX_FREE(protocol->rtt_probe_url);
+        protocol->rtt_probe_url = NULL;
         return false;
     }
-    LOG_DEBUG("WebSocket sending text: %s", text);
-    mg_ws_send(ws_protocol->conn, text, strlen(text), WEBSOCKET_OP_TEXT);
     return true;
 }
 
-void linx_websocket_destroy(linx_protocol_t* protocol) {
-    linx_websocket_protocol_t* ws_protocol = (linx_websocket_protocol_t*)protocol;
-    linx_websocket_protocol_destroy(ws_protocol);
+bool linx_websocket_set_server_url(linx_websocket_protocol_t* protocol, const char* url) {
+    if (!protocol || !url || !url[0]) {
+        return false;
+    }
+    if (protocol->server_url && strcmp(protocol->server_url, url) == 0) {
+        return true;
+    }
+    LOG_INFO("WebSocket server changed to %s", url);
+    return linx_websocket_protocol_set_server_url(protocol, url);
 }
 
-/* Event loop functions */
-void linx_websocket_poll(linx_websocket_protocol_t* ws_protocol, int timeout_ms) {
-    if (!ws_protocol) {
+/* Publish the unsent byte count of the connection for other threads; loop thread only */
+/* Tell a negotiated server how much audio the player holds; loop thread only */
+static void linx_websocket_flow_report(linx_websocket_protocol_t* ws_protocol, int level_ms, uint64_t now_ms) {
+    char message[192];
+    int n = snprintf(message, sizeof(message),
+                     "{\"session_id\":\"%s\",\"type\":\"flow\",\"buffer_ms\":%d,\"capacity_ms\":%d,\"paused\":%s}",
+                     ws_protocol->session_id ? ws_protocol->session_id : "", level_ms < 0 ? 0 : level_ms,
+                     ws_protocol->flow_capacity_ms, ws_protocol->flow_paused ? "true" : "false");
+    if (n <= 0 || (size_t)n >= sizeof(message)) {
         return;
     }
-    
-    mg_mgr_poll(&ws_protocol->mgr, timeout_ms);
+    linx_websocket_write_message(ws_protocol, message, (size_t)n, WEBSOCKET_OP_TEXT);
+    ws_protocol->flow_reported_ms = level_ms;
+    ws_protocol->flow_reported_at_ms = now_ms;
+    __atomic_fetch_add(&ws_protocol->flow_reports, 1, __ATOMIC_RELAXED);
 }
 
-void linx_websocket_stop(linx_websocket_protocol_t* ws_protocol) {
-    if (!ws_protocol) {
+/* Pause socket reads at the high watermark and resume at the low one; loop thread only */
+static void linx_websocket_flow_update(linx_websocket_protocol_t* ws_protocol) {
+    if (!ws_protocol->flow_level || !ws_protocol->conn || !ws_protocol->connected) {
         return;
     }
     
-    ws_protocol->should_stop = true;
-    ws_protocol->running = false;
+    int level_ms = ws_protocol->flow_level(ws_protocol->flow_user_data);
+    uint64_t now_ms = mg_millis();
+    bool was_paused = ws_protocol->flow_paused;
+    __atomic_store_n(&ws_protocol->flow_level_ms, level_ms, __ATOMIC_RELAXED);
+    
+    if (!was_paused && level_ms >= ws_protocol->flow_high_ms) {
+        /* Mongoose stops reading; the kernel buffer fills and TCP flow control slows the server */
+        ws_protocol->conn->is_full = 1;
+        __atomic_store_n(&ws_protocol->flow_paused_at_ms, now_ms, __ATOMIC_RELAXED);
+        __atomic_store_n(&ws_protocol->flow_paused, true, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&ws_protocol->flow_pauses, 1, __ATOMIC_RELAXED);
+        LOG_DEBUG("WebSocket downlink paused at %d ms buffered", level_ms);
+    } else if (was_paused && level_ms <= ws_protocol->flow_low_ms) {
+        linx_websocket_flow_resume(ws_protocol);
+        LOG_DEBUG("WebSocket downlink resumed at %d ms buffered", level_ms);
+    }
     
+    if (ws_protocol->flow_negotiated &&
+        (ws_protocol->flow_paused != was_paused ||
+         (level_ms != ws_protocol->flow_reported_ms &&
+          now_ms - ws_protocol->flow_reported_at_ms >= LINX_WEBSOCKET_FLOW_REPORT_MS))) {
+        linx_websocket_flow_report(ws_protocol, level_ms, now_ms);
+    }
+}
+
+/* Lift a pause, e.g. on resume or when the connection goes away; loop thread only */
+static void linx_websocket_flow_resume(linx_websocket_protocol_t* ws_protocol) {
+    if (!ws_protocol->flow_paused) {
+        return;
+    }
     if (ws_protocol->conn) {
-        ws_protocol->conn->is_closing = 1;
-        ws_protocol->conn = NULL;
+        ws_protocol->conn->is_full = 0;
     }
+    __atomic_fetch_add(&ws_protocol->flow_paused_ms, mg_millis() - ws_protocol->flow_paused_at_ms, __ATOMIC_RELAXED);
+    __atomic_store_n(&ws_protocol->flow_paused, false, __ATOMIC_RELAXED);
 }
 
-/* cJSON-based JSON value extraction helpers */
-static char* extract_json_string_value(const cJSON* json, const char* key) {
-    const cJSON* item = cJSON_GetObjectItemCaseSensitive(json, key);
-    if (!cJSON_IsString(item) || (item->valuestring == NULL)) {
-        return NULL;
+/* Paused reads resume once the player drains, so wake about once per frame to check */
+static int linx_websocket_flow_poll_timeout(const linx_websocket_protocol_t* ws_protocol, int timeout_ms) {
+    if (!ws_protocol->flow_paused) {
+        return timeout_ms;
+    }
+    int check_ms = ws_protocol->audio_frame_duration > 0 ? ws_protocol->audio_frame_duration : 20;
+    return timeout_ms < 0 || check_ms < timeout_ms ? check_ms : timeout_ms;
+}
+
+static void linx_websocket_publish_backlog(linx_websocket_protocol_t* ws_protocol) {
+    struct mg_connection* conn = ws_protocol->conn;
+    size_t backlog = conn ? conn->send.len : 0;
+    __atomic_store_n(&ws_protocol->send_backlog_bytes, backlog, __ATOMIC_RELAXED);
+    __atomic_store_n(&ws_protocol->io_send_size, conn ? conn->send.size : 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&ws_protocol->io_recv_size, conn ? conn->recv.size : 0, __ATOMIC_RELAXED);
+}
+
+/*
+ * Buffer policy. mongoose grows an iobuf to a multiple of its align field
+ * (MG_IO_SIZE by default) and never gives memory back, so a large outgoing
+ * message is appended through several reallocs and its peak stays allocated
+ * for the life of the connection. Both buffers start at io_initial and step
+ * in io_step units instead; a message is reserved in one resize before it is
+ * appended, and the part above io_initial is returned once it has been unused
+ * for io_shrink_ms.
+ */
+static void linx_websocket_io_open(linx_websocket_protocol_t* ws_protocol, struct mg_connection* conn) {
+    conn->recv.align = ws_protocol->io_step;
+    conn->send.align = ws_protocol->io_step;
+    if (conn->recv.size < ws_protocol->io_initial) {
+        mg_iobuf_resize(&conn->recv, ws_protocol->io_initial);
     }
+    /* The upgrade request is already queued */
+    if (conn->send.size < ws_protocol->io_initial) {
+        mg_iobuf_resize(&conn->send, ws_protocol->io_initial);
+    }
+    uint64_t now = mg_millis();
+    ws_protocol->io_recv_busy_ms = now;
+    ws_protocol->io_send_busy_ms = now;
+}
+
+/* Grow the send buffer once for a frame of size payload bytes; refuses past io_max */
+static bool linx_websocket_io_reserve(linx_websocket_protocol_t* ws_protocol, size_t size) {
+    struct mg_connection* conn = ws_protocol->conn;
+    size_t need = conn->send.len + size + LINX_WEBSOCKET_WS_HEADER_MAX;
     
-    size_t len = strlen(item->valuestring);
-    char* result = malloc(len + 1);
-    if (!result) return NULL;
+    if (need > ws_protocol->io_max) {
+        __atomic_fetch_add(&ws_protocol->io_limit_drops, 1, __ATOMIC_RELAXED);
+        LOG_WARN_EVERY_MS(1000, "WebSocket send buffer limit reached: %zu queued + %zu bytes > %zu",
+                          conn->send.len, size, ws_protocol->io_max);
+        return false;
+    }
+    if (need > ws_protocol->io_initial) {
+        ws_protocol->io_send_busy_ms = mg_millis();
+    }
+    if (need > conn->send.size && !mg_iobuf_resize(&conn->send, need)) {
+        LOG_ERROR("WebSocket send failed: unable to grow send buffer to %zu bytes", need);
+        return false;
+    }
+    return true;
+}
+
+/* A frame that does not fit under io_max can never complete, so the connection is dropped */
+static void linx_websocket_io_check_recv(linx_websocket_protocol_t* ws_protocol, struct mg_connection* conn) {
+    if (conn->recv.len <= ws_protocol->io_initial) {
+        return;
+    }
+    ws_protocol->io_recv_busy_ms = mg_millis();
+    if (conn->recv.len >= ws_protocol->io_max) {
+        LOG_ERROR("WebSocket receive buffer limit reached (%zu bytes), closing connection", ws_protocol->io_max);
+        mg_error(conn, "receive buffer limit reached");
+    }
+}
+
+static bool linx_websocket_io_shrink(struct mg_iobuf* io, size_t size) {
+    if (io->size <= size || io->len > size) {
+        return false;
+    }
+    mg_iobuf_resize(io, size);
+    return true;
+}
+
+static void linx_websocket_io_trim(linx_websocket_protocol_t* ws_protocol) {
+    struct mg_connection* conn = ws_protocol->conn;
+    if (!conn || ws_protocol->io_shrink_ms <= 0) {
+        return;
+    }
     
-    strcpy(result, item->valuestring);
-    return result;
+    uint64_t now = mg_millis();
+    size_t target = ws_protocol->io_initial;
+    /* mg_iobuf_resize() rounds up to align, so compare against what it would allocate */
+    target = (target + ws_protocol->io_step - 1) / ws_protocol->io_step * ws_protocol->io_step;
+    
+    if (conn->send.len > ws_protocol->io_initial) {
+        ws_protocol->io_send_busy_ms = now;
+    } else if (now - ws_protocol->io_send_busy_ms >= (uint64_t)ws_protocol->io_shrink_ms &&
+               linx_websocket_io_shrink(&conn->send, target)) {
+        __atomic_fetch_add(&ws_protocol->io_shrinks, 1, __ATOMIC_RELAXED);
+    }
+    if (conn->recv.len > ws_protocol->io_initial) {
+        ws_protocol->io_recv_busy_ms = now;
+    } else if (now - ws_protocol->io_recv_busy_ms >= (uint64_t)ws_protocol->io_shrink_ms &&
+               linx_websocket_io_shrink(&conn->recv, target)) {
+        __atomic_fetch_add(&ws_protocol->io_shrinks, 1, __ATOMIC_RELAXED);
+    }
 }
 
-static int extract_json_int_value(const cJSON* json, const char* key) {
-    const cJSON* item = cJSON_GetObjectItemCaseSensitive(json, key);
-    if (!cJSON_IsNumber(item)) {
-        return -1;
+/*
+ * Streaming receive. Once the upgrade is done the connection's protocol
+ * handler is swapped for linx_websocket_rx_handler(), which takes frames off
+ * the front of conn->recv itself instead of letting mongoose reassemble each
+ * message there. A large or fragmented text message is fed to linx_json_stream
+ * as its bytes arrive and its payload is dropped from recv straight away, so
+ * neither recv nor an extra copy ever has to hold the whole message. Every
+ * other frame is still handled once it is complete, exactly as mongoose would
+ * handle it, and one whose header already shows it cannot fit under io_max
+ * closes the connection before its payload is buffered.
+ */
+
+/* mongoose's WebSocket protocol handler, the same function for every connection */
+static mg_event_handler_t s_mg_ws_handler;
+
+static void linx_websocket_rx_reset(linx_websocket_protocol_t* ws_protocol) {
+    ws_protocol->rx_active = false;
+    ws_protocol->rx_streaming = false;
+    ws_protocol->rx_discard = false;
+    ws_protocol->rx_frame_left = 0;
+    ws_protocol->rx_frame_fin = false;
+    LINX_FREE(ws_protocol->rx_buffer);
+    ws_protocol->rx_buffer = NULL;
+    ws_protocol->rx_length = 0;
+    ws_protocol->rx_capacity = 0;
+    linx_json_stream_reset(ws_protocol->rx_json);
+}
+
+static void linx_websocket_rx_fail(struct mg_connection* conn, const char* reason) {
+    LOG_ERROR("WebSocket closing connection: %s", reason);
+    mg_error(conn, "%s", reason);
+}
+
+static void linx_websocket_rx_feed(linx_websocket_protocol_t* ws_protocol, const uint8_t* data, size_t size) {
+    if (ws_protocol->rx_discard || size == 0) {
+        return;
+    }
+    /* Nodes come from the heap: the message spans several reads and no arena scope is open */
+    bool suspended = linx_json_arena_suspend();
+    linx_json_stream_status_t status = linx_json_stream_feed(ws_protocol->rx_json, (const char*)data, size);
+    linx_json_arena_resume(suspended);
+    if (status == LINX_JSON_STREAM_ERROR) {
+        LOG_WARN_EVERY_MS(1000, "WebSocket dropping streamed text message after %zu bytes: %s",
+                          linx_json_stream_consumed(ws_protocol->rx_json),
+                          linx_json_stream_error(ws_protocol->rx_json));
+        ws_protocol->rx_discard = true;
     }
+}
+
+/* The last frame of a streamed message is in: route its tree like a parsed text message */
+static void linx_websocket_rx_finish(linx_websocket_protocol_t* ws_protocol) {
+    size_t size = linx_json_stream_consumed(ws_protocol->rx_json);
+    bool discard = ws_protocol->rx_discard;
+    ws_protocol->rx_streaming = false;
+    ws_protocol->rx_discard = false;
     
-    return item->valueint;
+    bool suspended = linx_json_arena_suspend();
+    cJSON* json = linx_json_stream_finish(ws_protocol->rx_json);
+    linx_json_arena_resume(suspended);
+    if (discard) {
+        cJSON_Delete(json);
+        return;
+    }
+    if (!json) {
+        LOG_WARN_EVERY_MS(1000, "WebSocket dropped streamed text message (%zu bytes): %s", size,
+                          linx_json_stream_error(ws_protocol->rx_json));
+        return;
+    }
+    LOG_DEBUG("WebSocket received streamed text message (length: %zu)", size);
+    
+    int stream_id = 0;
+    if (__atomic_load_n(&ws_protocol->mux_enabled, __ATOMIC_RELAXED)) {
+        const cJSON* stream_item = cJSON_GetObjectItemCaseSensitive(json, "stream");
+        stream_id = cJSON_IsNumber(stream_item) ? (int)stream_item->valuedouble : 0;
+    }
+    
+    linx_json_arena_scope_t arena_scope;
+    linx_json_arena_begin(ws_protocol->json_arena, &arena_scope);
+    if (stream_id != 0) {
+        pthread_mutex_lock(&ws_protocol->stream_mutex);
+        linx_websocket_stream_t* stream = linx_websocket_stream_find(ws_protocol, stream_id);
+        if (stream) {
+            linx_websocket_deliver_json(ws_protocol, stream, json);
+        } else {
+            LOG_WARN_EVERY_MS(1000, "WebSocket dropped message for unknown stream %d", stream_id);
+            cJSON_Delete(json);
+        }
+        pthread_mutex_unlock(&ws_protocol->stream_mutex);
+    } else {
+        linx_websocket_deliver_json(ws_protocol, NULL, json);
+    }
+    linx_json_arena_end(&arena_scope);
 }
 
-/* Helper functions */
-static bool linx_websocket_parse_server_hello(linx_websocket_protocol_t* ws_protocol, const char* json_str) {
-    if (!ws_protocol || !json_str) {
-        return false;
+/* Control frames get the replies mongoose would send */
+static void linx_websocket_rx_control(linx_websocket_protocol_t* ws_protocol, struct mg_connection* conn,
+                                      uint8_t op, const uint8_t* data, size_t size) {
+    LINX_TRACEPOINT(ws_rx, op, size);
+    if (op == WEBSOCKET_OP_PING) {
+        mg_ws_send(conn, data, size, WEBSOCKET_OP_PONG);
+    } else if (op == WEBSOCKET_OP_PONG) {
+        struct mg_ws_message wm;
+        memset(&wm, 0, sizeof(wm));
+        wm.data.buf = (char*)data;
+        wm.data.len = size;
+        wm.flags = (uint8_t)(0x80 | op);
+        linx_websocket_handle_pong(ws_protocol, &wm);
+    } else if (op == WEBSOCKET_OP_CLOSE) {
+        mg_ws_send(conn, data, size, WEBSOCKET_OP_CLOSE);
+        conn->is_draining = 1;
     }
+}
+
+/* Append a frame of a fragmented message that is not streamed */
+static bool linx_websocket_rx_append(linx_websocket_protocol_t* ws_protocol, const uint8_t* data, size_t size) {
+    if (ws_protocol->rx_length + size > ws_protocol->rx_capacity) {
+        size_t capacity = ws_protocol->rx_length + size;
+        capacity = (capacity + ws_protocol->io_step - 1) / ws_protocol->io_step * ws_protocol->io_step;
+        uint8_t* grown = (uint8_t*)LINX_REALLOC(ws_protocol->rx_buffer, capacity);
+        if (!grown) {
+            return false;
+        }
+        ws_protocol->rx_buffer = grown;
+        ws_protocol->rx_capacity = capacity;
+    }
+    memcpy(ws_protocol->rx_buffer + ws_protocol->rx_length, data, size);
+    ws_protocol->rx_length += size;
+    return true;
+}
+
+/*
+ * Take one step off the front of conn->recv: some payload of the streamed
+ * frame in progress, or one whole frame. Returns false when more bytes are
+ * needed or the connection is being closed.
+ */
+static bool linx_websocket_rx_step(linx_websocket_protocol_t* ws_protocol, struct mg_connection* conn) {
+    const uint8_t* p = conn->recv.buf;
+    size_t avail = conn->recv.len;
     
-    cJSON* root = cJSON_Parse(json_str);
-    if (!root) {
-        return false;
+    if (ws_protocol->rx_frame_left > 0) {
+        size_t n = avail < ws_protocol->rx_frame_left ? avail : (size_t)ws_protocol->rx_frame_left;
+        linx_websocket_rx_feed(ws_protocol, p, n);
+        mg_iobuf_del(&conn->recv, 0, n);
+        ws_protocol->rx_frame_left -= n;
+        if (ws_protocol->rx_frame_left == 0 && ws_protocol->rx_frame_fin) {
+            linx_websocket_rx_finish(ws_protocol);
+        }
+        return true;
     }
     
-    /* Check transport type */
-    char* transport = extract_json_string_value(root, "transport");
-    if (transport) {
-        if (strcmp(transport, "websocket") != 0) {
-            free(transport);
-            cJSON_Delete(root);
+    if (avail < 2) {
+        return false;
+    }
+    uint8_t flags = p[0];
+    uint8_t op = flags & 0x0F;
+    bool fin = (flags & 0x80) != 0;
+    if (p[1] & 0x80) {
+        linx_websocket_rx_fail(conn, "masked frame from server");
+        return false;
+    }
+    size_t header = 2;
+    uint64_t length = p[1] & 0x7F;
+    if (length == 126) {
+        if (avail < 4) {
+            return false;
+        }
+        length = ((uint64_t)p[2] << 8) | p[3];
+        header = 4;
+    } else if (length == 127) {
+        if (avail < 10) {
             return false;
         }
-        free(transport);
+        length = 0;
+        for (int i = 2; i < 10; i++) {
+            length = (length << 8) | p[i];
+        }
+        header = 10;
     }
     
-    /* Parse session ID */
-    char* session_id = extract_json_string_value(root, "session_id");
-    if (session_id) {
-        if (ws_protocol->session_id) {
-            free(ws_protocol->session_id);
+    if (op & 0x08) {
+        if (!fin || length > 125) {
+            linx_websocket_rx_fail(conn, "invalid control frame");
+            return false;
         }
-        ws_protocol->session_id = session_id;
+        if (avail < header + length) {
+            return false;
+        }
+        linx_websocket_rx_control(ws_protocol, conn, op, p + header, (size_t)length);
+        mg_iobuf_del(&conn->recv, 0, header + (size_t)length);
+        return true;
     }
     
-    /* Parse audio_params section */
-    const cJSON* audio_params = cJSON_GetObjectItemCaseSensitive(root, "audio_params");
-    if (cJSON_IsObject(audio_params)) {
-        int sample_rate = extract_json_int_value(audio_params, "sample_rate");
-        if (sample_rate > 0) {
-            ws_protocol->audio_sample_rate = sample_rate;
+    bool first = op != WEBSOCKET_OP_CONTINUE;
+    if (first == ws_protocol->rx_active) {
+        linx_websocket_rx_fail(conn, first ? "new message inside a fragmented one" : "unexpected continuation frame");
+        return false;
+    }
+    if (first) {
+        ws_protocol->rx_flags = flags;
+        ws_protocol->rx_streaming = op == WEBSOCKET_OP_TEXT && !(flags & LINX_WEBSOCKET_FLAG_RSV1) &&
+                                    (!fin || length >= ws_protocol->rx_threshold);
+        if (ws_protocol->rx_streaming && !ws_protocol->rx_json &&
+            !(ws_protocol->rx_json = linx_json_stream_create(&ws_protocol->json_limits))) {
+            LOG_WARN("WebSocket streaming parser unavailable, buffering the message");
+            ws_protocol->rx_streaming = false;
         }
-        
-        int frame_duration = extract_json_int_value(audio_params, "frame_duration");
-        if (frame_duration > 0) {
-            ws_protocol->audio_frame_duration = frame_duration;
+    }
+    
+    if (ws_protocol->rx_streaming) {
+        mg_iobuf_del(&conn->recv, 0, header);
+        ws_protocol->rx_active = !fin;
+        ws_protocol->rx_frame_left = length;
+        ws_protocol->rx_frame_fin = fin;
+        if (length == 0 && fin) {
+            linx_websocket_rx_finish(ws_protocol);
         }
+        return true;
     }
     
-    ws_protocol->server_hello_received = true;
-    cJSON_Delete(root);
+    /* Everything else is handled whole, so it has to fit */
+    if (header + length > ws_protocol->io_max || ws_protocol->rx_length + length > ws_protocol->io_max) {
+        char reason[80];
+        snprintf(reason, sizeof(reason), "%llu byte frame over the %zu byte buffer limit",
+                 (unsigned long long)length, ws_protocol->io_max);
+        linx_websocket_rx_fail(conn, reason);
+        return false;
+    }
+    if (avail < header + length) {
+        return false;
+    }
+    if (first && fin) {
+        linx_websocket_handle_frame(ws_protocol, (const char*)p + header, (size_t)length, flags);
+    } else if (!linx_websocket_rx_append(ws_protocol, p + header, (size_t)length)) {
+        linx_websocket_rx_fail(conn, "out of memory reassembling a fragmented message");
+        return false;
+    } else if (fin) {
+        linx_websocket_handle_frame(ws_protocol, (const char*)ws_protocol->rx_buffer, ws_protocol->rx_length,
+                                    ws_protocol->rx_flags);
+        LINX_FREE(ws_protocol->rx_buffer);
+        ws_protocol->rx_buffer = NULL;
+        ws_protocol->rx_length = 0;
+        ws_protocol->rx_capacity = 0;
+    }
+    ws_protocol->rx_active = !fin;
+    /* The handlers above may have closed or replaced the connection */
+    if (ws_protocol->conn == conn) {
+        mg_iobuf_del(&conn->recv, 0, header + (size_t)length);
+    }
     return true;
 }
 
-static char* linx_websocket_get_hello_message(linx_websocket_protocol_t* ws_protocol) {
-    if (!ws_protocol) {
-        return NULL;
-    }
+static void linx_websocket_rx_handler(struct mg_connection* conn, int ev, void* ev_data) {
+    linx_websocket_protocol_t* ws_protocol = (linx_websocket_protocol_t*)conn->fn_data;
     
-    /* Build JSON using cJSON for better structure */
-    cJSON* root = cJSON_CreateObject();
-    cJSON_AddStringToObject(root, "type", "hello");
-    cJSON_AddNumberToObject(root, "version", ws_protocol->version);
+    /* mongoose keeps the offset of a message it is still reassembling in pfn_data: let it finish that one */
+    if (ev != MG_EV_READ || !ws_protocol || ws_protocol->conn != conn || conn->pfn_data != NULL) {
+        s_mg_ws_handler(conn, ev, ev_data);
+        return;
+    }
+    while (conn->recv.len > 0 && !conn->is_closing && !conn->is_draining && ws_protocol->conn == conn &&
+           linx_websocket_rx_step(ws_protocol, conn)) {
+    }
+}
+
+static void linx_websocket_rx_attach(linx_websocket_protocol_t* ws_protocol, struct mg_connection* conn) {
+    linx_websocket_rx_reset(ws_protocol);
+    if (!ws_protocol->rx_enabled || !conn->pfn) {
+        return;
+    }
+    s_mg_ws_handler = conn->pfn;
+    conn->pfn = linx_websocket_rx_handler;
+}
+
+bool linx_websocket_get_uplink_stats(linx_websocket_protocol_t* protocol,
+                                     linx_websocket_uplink_stats_t* stats) {
+    if (!protocol || !stats) {
+        return false;
+    }
     
-    /* Add features object */
-    cJSON* features = cJSON_CreateObject();
-    cJSON_AddBoolToObject(features, "mcp", true);
-    /* Note: AEC feature would be added here if supported */
-    cJSON_AddItemToObject(root, "features", features);
+    stats->queued_audio_frames = __atomic_load_n(&protocol->audio_queue.depth, __ATOMIC_RELAXED);
+    stats->send_backlog_bytes = __atomic_load_n(&protocol->send_backlog_bytes, __ATOMIC_RELAXED);
+    stats->rtt_valid = __atomic_load_n(&protocol->rtt_valid, __ATOMIC_ACQUIRE);
+    stats->rtt_ms = stats->rtt_valid ? __atomic_load_n(&protocol->rtt_ms, __ATOMIC_RELAXED) : 0;
+    stats->srtt_ms = stats->rtt_valid ? __atomic_load_n(&protocol->srtt_ms, __ATOMIC_RELAXED) : 0;
+    stats->rtt_min_ms = stats->rtt_valid ? __atomic_load_n(&protocol->rtt_min_ms, __ATOMIC_RELAXED) : 0;
+    stats->keepalive_probes = __atomic_load_n(&protocol->keepalive_probes, __ATOMIC_RELAXED);
+    stats->keepalive_missed = __atomic_load_n(&protocol->keepalive_missed, __ATOMIC_RELAXED);
+    stats->dead_connections = __atomic_load_n(&protocol->dead_connections, __ATOMIC_RELAXED);
+    stats->dropped_audio_frames = __atomic_load_n(&protocol->audio_dropped, __ATOMIC_RELAXED);
+    stats->queued_bulk_bytes = __atomic_load_n(&protocol->bulk_queued_bytes, __ATOMIC_RELAXED);
+    stats->bulk_fragments = __atomic_load_n(&protocol->bulk_fragments, __ATOMIC_RELAXED);
+    stats->urgent_messages = __atomic_load_n(&protocol->urgent_messages, __ATOMIC_RELAXED);
+    stats->dropped_control_messages = __atomic_load_n(&protocol->control_dropped, __ATOMIC_RELAXED);
+    stats->send_buffer_bytes = __atomic_load_n(&protocol->io_send_size, __ATOMIC_RELAXED);
+    stats->recv_buffer_bytes = __atomic_load_n(&protocol->io_recv_size, __ATOMIC_RELAXED);
+    stats->buffer_shrinks = __atomic_load_n(&protocol->io_shrinks, __ATOMIC_RELAXED);
+    stats->buffer_limit_drops = __atomic_load_n(&protocol->io_limit_drops, __ATOMIC_RELAXED);
+    return true;
+}
+
+bool linx_websocket_get_flow_stats(linx_websocket_protocol_t* protocol, linx_websocket_flow_stats_t* stats) {
+    if (!protocol || !stats) {
+        return false;
+    }
     
-    cJSON_AddStringToObject(root, "transport", "websocket");
+    stats->enabled = protocol->flow_level != NULL;
+    stats->negotiated = __atomic_load_n(&protocol->flow_negotiated, __ATOMIC_RELAXED);
+    stats->paused = __atomic_load_n(&protocol->flow_paused, __ATOMIC_RELAXED);
+    stats->level_ms = __atomic_load_n(&protocol->flow_level_ms, __ATOMIC_RELAXED);
+    stats->capacity_ms = protocol->flow_capacity_ms;
+    stats->pauses = __atomic_load_n(&protocol->flow_pauses, __ATOMIC_RELAXED);
+    stats->paused_ms = __atomic_load_n(&protocol->flow_paused_ms, __ATOMIC_RELAXED);
+    if (stats->paused) {
+        stats->paused_ms += mg_millis() - __atomic_load_n(&protocol->flow_paused_at_ms, __ATOMIC_RELAXED);
+    }
+    stats->reports = __atomic_load_n(&protocol->flow_reports, __ATOMIC_RELAXED);
+    return true;
+}
+
+bool linx_websocket_get_replay_stats(linx_websocket_protocol_t* protocol,
+                                     linx_websocket_replay_stats_t* stats) {
+    if (!protocol || !stats || !protocol->replay) {
+        return false;
+    }
     
-    /* Add audio_params object */
-    cJSON* audio_params = cJSON_CreateObject();
-    cJSON_AddStringToObject(audio_params, "format", ws_protocol->client_audio_format);
-    cJSON_AddNumberToObject(audio_params, "sample_rate", ws_protocol->audio_sample_rate);
-    cJSON_AddNumberToObject(audio_params, "channels", ws_protocol->audio_channels);
-    cJSON_AddNumberToObject(audio_params, "frame_duration", ws_protocol->audio_frame_duration);
-    cJSON_AddItemToObject(root, "audio_params", audio_params);
+    stats->finished = __atomic_load_n(&protocol->replay_stats.finished, __ATOMIC_ACQUIRE);
+    stats->records = __atomic_load_n(&protocol->replay_stats.records, __ATOMIC_RELAXED);
+    stats->recorded_outbound = __atomic_load_n(&protocol->replay_stats.recorded_outbound, __ATOMIC_RELAXED);
+    stats->outbound = __atomic_load_n(&protocol->replay_stats.outbound, __ATOMIC_RELAXED);
+    stats->max_lag_us = __atomic_load_n(&protocol->replay_stats.max_lag_us, __ATOMIC_RELAXED);
+    return true;
+}
+
+bool linx_websocket_get_deflate_stats(linx_websocket_protocol_t* protocol, linx_ws_deflate_stats_t* stats) {
+    if (!protocol || !stats) {
+        return false;
+    }
     
-    char* json_string = cJSON_PrintUnformatted(root);
-    cJSON_Delete(root);
+    pthread_mutex_lock(&protocol->deflate_mutex);
+    *stats = protocol->deflate_stats;
+    pthread_mutex_unlock(&protocol->deflate_mutex);
+    return stats->client_window_bits > 0;
+}
+
+bool linx_websocket_get_audio_format(linx_websocket_protocol_t* protocol, char* format, size_t size) {
+    if (!protocol || !format || size == 0) {
+        return false;
+    }
     
-    return json_string;
+    const char* negotiated = protocol->server_audio_format[0] ? protocol->server_audio_format
+                           : protocol->audio_formats[0];
+    snprintf(format, size, "%s", negotiated);
+    return true;
 }
 
-/* Utility functions */
-bool linx_websocket_is_connected(const linx_websocket_protocol_t* ws_protocol) {
-    return ws_protocol ? ws_protocol->connected : false;
+bool linx_websocket_get_session_params(linx_websocket_protocol_t* protocol,
+                                       linx_websocket_session_params_t* params) {
+    if (!protocol || !params || !protocol->server_hello_received) {
+        return false;
+    }
+    
+    memset(params, 0, sizeof(*params));
+    linx_websocket_get_audio_format(protocol, params->audio_format, sizeof(params->audio_format));
+    params->sample_rate = protocol->audio_sample_rate;
+    params->channels = protocol->audio_channels;
+    params->frame_duration = protocol->audio_frame_duration;
+    params->version = protocol->version;
+    params->audio_features = __atomic_load_n(&protocol->audio_features, __ATOMIC_RELAXED);
+    params->text_deflate = protocol->deflate != NULL;
+    params->cbor_control = __atomic_load_n(&protocol->control_cbor, __ATOMIC_RELAXED);
+    params->flow_control = __atomic_load_n(&protocol->flow_negotiated, __ATOMIC_RELAXED);
+    params->bulk_interleave = protocol->bulk_interleave;
+    params->resume = protocol->resume_allowed;
+    params->streams = __atomic_load_n(&protocol->mux_enabled, __ATOMIC_RELAXED);
+    return true;
 }
 
-/* Additional WebSocket functions */
-int linx_websocket_get_reconnect_attempts(const linx_websocket_protocol_t* protocol) {
-    /* TODO: Add reconnect attempts tracking */
-    return 0;
+bool linx_websocket_is_connection_timeout(const linx_websocket_protocol_t* protocol) {
+    if (!protocol) {
+        return false;
+    }
+    if (protocol->keepalive_idle_ms > 0) {
+        return protocol->connection_dead;
+    }
+    return protocol->connected && linx_protocol_is_timeout(&protocol->base);
 }
 
-void linx_websocket_reset_reconnect_attempts(linx_websocket_protocol_t* protocol) {
-    /* TODO: Reset reconnect attempts counter */
+linx_audio_packet_pool_t* linx_websocket_get_packet_pool(linx_websocket_protocol_t* protocol) {
+    return protocol ? protocol->packet_pool : NULL;
 }
 
-void linx_websocket_process_events(linx_websocket_protocol_t* protocol) {
-    if (!protocol) return;
-    linx_websocket_poll(protocol, 10);
+bool linx_websocket_get_packet_pool_stats(linx_websocket_protocol_t* protocol,
+                                          linx_audio_packet_pool_stats_t* stats) {
+    if (!protocol) {
+        return false;
+    }
+    return linx_audio_packet_pool_get_stats(protocol->packet_pool, stats);
 }
 
-bool linx_websocket_send_ping(linx_websocket_protocol_t* protocol) {
-    if (!protocol || !protocol->conn) {
+bool linx_websocket_get_json_arena_stats(linx_websocket_protocol_t* protocol,
+                                         linx_json_arena_stats_t* stats) {
+    if (!protocol) {
         return false;
     }
-    
-    mg_ws_send(protocol->conn, "", 0, WEBSOCKET_OP_PING);
-    return true;
+    return linx_json_arena_get_stats(protocol->json_arena, stats);
 }
 
-bool linx_websocket_is_connection_timeout(const linx_websocket_protocol_t* protocol) {
-    /* TODO: Implement connection timeout check */
-    return false;
+struct mg_mgr* linx_websocket_get_mgr(linx_websocket_protocol_t* protocol) {
+    return protocol ? protocol->mgr : NULL;
 }
 
 /* WebSocket create function with config */
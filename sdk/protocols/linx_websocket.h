@@ -2,6 +2,9 @@
 #define LINX_WEBSOCKET_H
 
 #include "linx_protocol.h"
+#include "linx_reactor.h"
+#include "linx_ws_deflate.h"
+#include "../cjson/linx_json_arena.h"
 #include <stdbool.h>
 
 #ifdef __cplusplus
@@ -12,6 +15,29 @@ extern "C" {
 /* WebSocket 协议实现结构体 - 前向声明（隐藏实现细节） */
 typedef struct linx_websocket_protocol linx_websocket_protocol_t;
 
+/* 复用连接上的一个会话（见 linx_websocket_stream_create()） */
+typedef struct linx_websocket_stream linx_websocket_stream_t;
+
+struct mg_mgr;
+
+/**
+ * 下行流控水位回调：在事件循环线程中调用
+ * @param user_data 配置中的 downlink_level_user_data
+ * @return 播放端已缓冲的音频时长（毫秒），<0 表示未知（不暂停读取）
+ */
+typedef int (*linx_websocket_downlink_level_t)(void* user_data);
+
+/* hello 中候选编码、候选帧长的最大个数 */
+#define LINX_WEBSOCKET_MAX_AUDIO_FORMATS 4
+#define LINX_WEBSOCKET_MAX_FRAME_DURATIONS 4
+
+/* 可选音频特性，在 hello 的 features 中协商 */
+#define LINX_WEBSOCKET_AUDIO_FEATURE_FEC      (1u << 0) // Opus 带内 FEC
+#define LINX_WEBSOCKET_AUDIO_FEATURE_DTX      (1u << 1) // 静音期间 DTX，只发 1-2 字节的帧或不发
+#define LINX_WEBSOCKET_AUDIO_FEATURE_BUNDLING (1u << 2) // 一条消息携带多帧合成的 Opus 包
+#define LINX_WEBSOCKET_AUDIO_FEATURE_TTS_CACHE (1u << 3) // 设备缓存句子音频，服务端按 tts skip 跳过（见 linx_protocol_send_tts_skip()）
+#define LINX_WEBSOCKET_AUDIO_FEATURE_PLAYBACK_POSITION (1u << 4) // 设备上报下行音频的播出位置和输出延迟（见 linx_protocol_send_playback_position()）
+
 /* WebSocket 配置结构体 */
 typedef struct {
     const char* url;                // WebSocket 服务器URL
@@ -24,14 +50,255 @@ typedef struct {
     
 
      /* 协议状态 */
-    char* client_audio_format;       // 客户端音频格式
+    char* client_audio_format;       // 客户端音频格式 (hello 中的 audio_params.format，NULL 为 "opus")
     int audio_sample_rate;           // 客户端采样率
     int audio_channels;              // 客户端声道数
     int audio_frame_duration;        // 客户端帧持续时间
-    int protocol_version;           // 协议版本
+    int protocol_version;           // 协议版本（1-4），v4 音频帧携带序号和时间戳，服务端 hello 可降低；
+                                    // 构建固定了 LINX_WS_PROTOCOL_VERSION 时忽略，只使用该版本
+
+    /* 自动重连：断开后在同一个 mg_mgr 上重新连接，不重建协议对象 */
+    bool auto_reconnect;             // 是否自动重连
+    int reconnect_base_ms;           // 最小重连延迟（毫秒），<=0 为默认值
+    int reconnect_max_ms;            // 最大重连延迟（毫秒），<=0 为默认值
+    int reconnect_max_attempts;      // 连续重连次数上限，0 为不限
+
+    /* 连接预热 */
+    int dns_cache_ttl_ms;            // 服务器地址缓存有效期（毫秒），0 为默认值，<0 关闭
+    bool early_hello;                // hello 紧跟升级请求发出，不等 101 响应（服务端需支持）
+
+    /* 文本消息压缩（permessage-deflate，见 linx_ws_deflate.h），音频帧从不压缩 */
+    bool text_deflate;               // 在升级请求中协商压缩，服务端不支持时照常不压缩
+    int deflate_window_bits;         // 双方窗口位数 9-15，<=0 为 LINX_WS_DEFLATE_WINDOW_BITS_DEFAULT
+    bool deflate_dictionary;         // 协商 SDK 预置字典（服务端需支持）
+
+    /* 控制消息二进制编码（见 linx_control_cbor.h），需要协议版本 >= 2 */
+    bool binary_control;             // 在 hello 中声明 features.cbor_control，服务端确认后 listen/abort 等改发 CBOR
+
+    /*
+     * 下行流控：服务端推送 TTS 快于实时，播放端缓冲达到高水位时暂停读取 socket，
+     * 由 TCP 接收窗口让服务端放慢推送，回落到低水位后恢复，缓冲满时不再丢帧。
+     * 容量在 hello 的 audio_params.buffer_ms 中通告（features.flow_control），
+     * 服务端 hello 确认后，暂停、恢复以及水位变化时发送 {"type":"flow"} 上报。
+     * 已在同一次 socket 读取中到达的帧仍会交给播放端，高水位应留出一次读取的余量。
+     */
+    linx_websocket_downlink_level_t downlink_level; // 水位回调，NULL 关闭流控
+    void* downlink_level_user_data;
+    int downlink_capacity_ms;        // 播放端缓冲容量（毫秒），<=0 关闭流控
+    int downlink_high_ms;            // 达到后暂停读取，<=0 为容量的 3/4
+    int downlink_low_ms;             // 回落到此以下恢复读取，<=0 为容量的 1/2
+
+    /*
+     * 出站调度：abort 和 listen start/detect 排在已排队的音频之前，其余 JSON 在音频之后，
+     * 超过一个分片的文本消息（如带图片的 MCP 结果）最后发送，且只在 socket 发送缓冲区
+     * 不足一个分片时才写入，音频帧最多排在一个分片之后。服务端 hello 确认
+     * features.bulk_interleave 时大消息拆成 WebSocket 延续帧，分片之间穿插完整的音频和控制消息
+     * （RFC 6455 要求双方事先约定）；否则整条发送，只是不再插到音频前面。
+     */
+    int bulk_fragment_bytes;         // 分片大小，也是大消息的判定阈值，<=0 为 LINX_WEBSOCKET_BULK_FRAGMENT
+
+    /*
+     * 参数协商：hello 的 audio_params 保留单值字段（首选项，兼容旧服务端），另附按优先级排列的
+     * formats、frame_durations，顶层 versions 列出 protocol_version 及以下的所有版本，
+     * features 中声明 fec/dtx/bundling。服务端各选一个写回 audio_params 和 version，
+     * 并在 features 中确认接受的可选特性，结果见 linx_websocket_get_session_params()。
+     */
+    const char* audio_formats;       // 候选编码，逗号分隔，如 "opus,adpcm"；NULL 只提供 client_audio_format
+    int frame_durations[LINX_WEBSOCKET_MAX_FRAME_DURATIONS]; // 候选帧长（毫秒），0 结束；为空只提供 audio_frame_duration
+    uint32_t audio_features;         // 可提供的可选特性（LINX_WEBSOCKET_AUDIO_FEATURE_* 按位或）
+
+    /*
+     * 保活与断线检测：空闲时 keepalive_idle_ms 内没有收到任何数据就发送 ping（维持 NAT 映射），
+     * 最近有音频收发时不论是否有数据都每 keepalive_active_ms 发送一次，持续测量 RTT。
+     * ping 载荷带编号，对应的 pong 给出一个 RTT 样本；超时（平滑 RTT 加 4 倍偏差，至少 1 秒）内
+     * pong 和任何数据都没有收到记为一次丢失并立即补发，连续 keepalive_max_missed 次后判定为
+     * 半开连接并关闭，开启 auto_reconnect 时随即重连。
+     */
+    int keepalive_idle_ms;           // 空闲保活间隔（毫秒），0 为 LINX_WEBSOCKET_KEEPALIVE_IDLE_MS，<0 关闭保活
+    int keepalive_active_ms;         // 会话中的探测间隔（毫秒），<=0 为 LINX_WEBSOCKET_KEEPALIVE_ACTIVE_MS
+    int keepalive_max_missed;        // 判定断线前允许连续丢失的探测数，<=0 为 LINX_WEBSOCKET_KEEPALIVE_MAX_MISSED
+
+    /* 共享事件循环：非 NULL 时连接挂在 reactor 的管理器上，由 reactor 轮询，应用负责其生命周期 */
+    linx_reactor_t* reactor;
+
+    /* 多路复用（见 linx_websocket_stream_create()）：在 hello 中声明 features.streams，需要协议版本 >= 2 */
+    bool multiplex;
+
+    /* 会话录制与回放（见 linx_ws_capture.h）*/
+    const char* capture_path;        // 非 NULL 时把收发的每一帧录制到该文件
+    const char* replay_path;         // 非 NULL 时不连接网络，按录制文件回放服务端消息；不能与 reactor 同时使用
+    float replay_speed;              // 回放速度倍数，1 为录制时的节奏，<=0 为尽快回放
+
+    /*
+     * 音频录制（见 linx_ogg_recorder.h）：非 NULL 时把本连接会话（不含多路复用的流）收发的 Opus 包
+     * 分别录制为 <record_path>.up.opus 和 <record_path>.down.opus；协商的编码不是 opus 时不录制
+     */
+    const char* record_path;
+
+    /*
+     * 入站 JSON 限制（见 cJSON_ParseWithLimits()）：超过大小的文本消息在扫描和分配之前丢弃，
+     * 嵌套或节点数超限的在解析中途放弃并释放已建的节点，只丢这一条消息，连接不受影响
+     */
+    int max_text_bytes;              // 文本消息最大字节数（解压后），0 为 LINX_WEBSOCKET_MAX_TEXT_BYTES，<0 不限
+    int max_json_depth;              // 最大嵌套层数，0 为 LINX_WEBSOCKET_MAX_JSON_DEPTH，<0 只受 CJSON_NESTING_LIMIT 限制
+    int max_json_items;              // 一条消息最多的 cJSON 节点数，0 为 LINX_WEBSOCKET_MAX_JSON_ITEMS，<0 不限
+
+    /* MCP 工具表摘要（见 linx_session_cache.h）：服务端上次取得的工具表未变时放入 hello 的 features.mcp_tools_hash，
+     * 服务端可跳过 tools/list；NULL 不带 */
+    const char* mcp_tools_hash;
+
+    /*
+     * 收发缓冲区策略：mongoose 的 recv/send 缓冲区默认按 MG_IO_SIZE 逐段 realloc 增长、从不收缩，
+     * 一条大的 tools/call 结果会让发送缓冲区连续 realloc，峰值内存一直占着。连接建立时按初始大小
+     * 预分配，之后按步长增长（一条消息一次分配到位），单个缓冲区不超过上限：超过上限的出站消息
+     * 丢弃并记入统计，入站数据超过上限时关闭连接。超过初始大小的部分空闲一段时间后收缩回初始大小。
+     */
+    int io_buffer_initial_bytes;     // 初始大小，0 为 LINX_WEBSOCKET_IO_BUFFER_INITIAL
+    int io_buffer_step_bytes;        // 增长步长，0 为 LINX_WEBSOCKET_IO_BUFFER_STEP
+    int io_buffer_max_bytes;         // 单个缓冲区上限，0 为 LINX_WEBSOCKET_IO_BUFFER_MAX，<0 不限
+    int io_buffer_shrink_ms;         // 超过初始大小的部分空闲多久后收缩（毫秒），0 为 LINX_WEBSOCKET_IO_BUFFER_SHRINK_MS，<0 不收缩
+
+    /*
+     * 流式接收：默认由 mongoose 把整条消息拼接在接收缓冲区中再解析成 cJSON 树，大消息的峰值约为
+     * 原文（压缩时再加解压副本）加上树。开启后帧由 SDK 自己解析：单帧不小于 stream_threshold_bytes
+     * 或分片到达的文本消息每收到一段就交给增量 JSON 解析器（见 linx_json_stream.h）直接建树，
+     * 接收缓冲区只保留一次读取的数据；超过 max_text_bytes 或 JSON 限制的消息丢弃其余部分，不再缓冲。
+     * 其他帧（二进制、压缩的文本、控制帧）仍整帧处理，帧头声明的长度超过收发缓冲区上限时立即关闭
+     * 连接，不等数据到齐。流式接收的消息不经过 on_incoming_text 快速路径；配置了 capture_path 时不流式接收。
+     */
+    bool stream_receive;
+    int stream_threshold_bytes;      // 流式接收的单帧阈值，0 为 LINX_WEBSOCKET_STREAM_THRESHOLD
 
 } linx_websocket_config_t;
 
+/* 入站 JSON 默认限制：约 64 字节/节点，节点上限对应的树不超过 128KB */
+#define LINX_WEBSOCKET_MAX_TEXT_BYTES (64 * 1024)
+#define LINX_WEBSOCKET_MAX_JSON_DEPTH 32
+#define LINX_WEBSOCKET_MAX_JSON_ITEMS 2048
+
+/* 收发缓冲区默认策略，初始大小和上限来自构建配置的 CONFIG_NETWORK_BUFFER_SIZE / CONFIG_NETWORK_BUFFER_MAX */
+#ifndef LINX_WEBSOCKET_IO_BUFFER_INITIAL
+#define LINX_WEBSOCKET_IO_BUFFER_INITIAL 4096
+#endif
+#ifndef LINX_WEBSOCKET_IO_BUFFER_MAX
+#define LINX_WEBSOCKET_IO_BUFFER_MAX (256 * 1024)
+#endif
+#define LINX_WEBSOCKET_IO_BUFFER_STEP 4096
+#define LINX_WEBSOCKET_IO_BUFFER_SHRINK_MS 10000
+
+/* 流式接收的默认单帧阈值（字节） */
+#define LINX_WEBSOCKET_STREAM_THRESHOLD 4096
+
+/* 自动重连默认参数 */
+#define LINX_WEBSOCKET_RECONNECT_BASE_MS 500
+#define LINX_WEBSOCKET_RECONNECT_MAX_MS  30000
+
+/**
+ * 服务器地址缓存默认有效期
+ * 同一进程内的所有协议实例共享缓存，有效期内重连直接拨号已解析的地址；
+ * wss 的 SNI、证书校验和 Host 头仍使用原主机名。拨号失败时缓存条目立即作废。
+ */
+#define LINX_WEBSOCKET_DNS_CACHE_TTL_MS  300000
+
+/* hello 协商结果（见 linx_websocket_get_session_params()） */
+typedef struct {
+    char audio_format[16];          // 音频格式，见 codec_factory_parse_format()
+    int sample_rate;                // 采样率
+    int channels;                   // 声道数
+    int frame_duration;             // 帧持续时间（毫秒）
+    int version;                    // 二进制协议版本
+    uint32_t audio_features;        // 双方都支持的 LINX_WEBSOCKET_AUDIO_FEATURE_*
+    bool text_deflate;              // 文本消息压缩已启用（permessage-deflate，在升级请求中协商）
+    bool cbor_control;              // 控制消息使用 CBOR
+    bool flow_control;              // 发送下行水位上报
+    bool bulk_interleave;           // 大消息分片之间穿插其他消息
+    bool resume;                    // 服务端支持会话恢复
+    bool streams;                   // 服务端接受多路复用，可以创建流
+} linx_websocket_session_params_t;
+
+/* 一条连接上最多的流数，流ID为 1 到该值（0 是连接自身的会话） */
+#define LINX_WEBSOCKET_MAX_STREAMS 16
+
+/* 流配置 */
+typedef struct {
+    const char* device_id;           // 该会话的设备ID（hello 的 device_id），NULL 表示不带
+    const char* client_id;           // 该会话的客户端ID（hello 的 client_id），NULL 表示不带
+} linx_websocket_stream_config_t;
+
+/* 保活默认参数 */
+#define LINX_WEBSOCKET_KEEPALIVE_IDLE_MS    15000
+#define LINX_WEBSOCKET_KEEPALIVE_ACTIVE_MS  1000
+#define LINX_WEBSOCKET_KEEPALIVE_MAX_MISSED 2
+
+/* 大消息默认分片大小（字节） */
+#define LINX_WEBSOCKET_BULK_FRAGMENT 4096
+
+/* 上行拥塞观测统计 */
+typedef struct {
+    size_t queued_audio_frames;     // 跨线程发送队列中等待发送的音频帧数
+    size_t send_backlog_bytes;      // socket 发送缓冲区中尚未写出的字节数
+    uint32_t rtt_ms;                // 最近一次 ping/pong 往返时间（毫秒）
+    bool rtt_valid;                 // 是否已测得 rtt_ms
+    uint32_t srtt_ms;               // 平滑 RTT（RFC 6298），rtt_valid 时有效
+    uint32_t rtt_min_ms;            // 本连接的最小 RTT，rtt_valid 时有效
+    uint64_t keepalive_probes;      // 已发送的保活探测数
+    uint64_t keepalive_missed;      // 超时未应答的探测数
+    uint64_t dead_connections;      // 判定为半开而关闭的连接数
+    uint64_t dropped_audio_frames;  // 因发送队列已满而丢弃的音频帧数
+    size_t queued_bulk_bytes;       // 等待发送的大消息字节数（含正在分片发送的一条）
+    uint64_t bulk_fragments;        // 已发出的大消息分片数
+    uint64_t urgent_messages;       // 插到音频之前发送的控制消息数
+    uint64_t dropped_control_messages; // 二进制控制消息因队满或写入失败未发出（改发 JSON）的次数
+    size_t send_buffer_bytes;       // 连接发送缓冲区当前分配的大小
+    size_t recv_buffer_bytes;       // 连接接收缓冲区当前分配的大小
+    uint64_t buffer_shrinks;        // 缓冲区空闲后收缩的次数
+    uint64_t buffer_limit_drops;    // 因发送缓冲区达到上限而丢弃的消息数
+} linx_websocket_uplink_stats_t;
+
+/* 下行流控的水位上报间隔：水位有变化时最多每隔这么久上报一次 */
+#define LINX_WEBSOCKET_FLOW_REPORT_MS 500
+
+/* 下行流控统计 */
+typedef struct {
+    bool enabled;                   // 已配置流控
+    bool negotiated;                // 服务端 hello 确认 features.flow_control，会收到水位上报
+    bool paused;                    // 当前暂停读取
+    int level_ms;                   // 最近一次查询到的缓冲时长，<0 表示未知
+    int capacity_ms;                // 通告的缓冲容量
+    uint64_t pauses;                // 暂停次数
+    uint64_t paused_ms;             // 累计暂停时长（含正在进行的一次）
+    uint64_t reports;               // 发出的水位上报数
+} linx_websocket_flow_stats_t;
+
+/* 回放统计 */
+typedef struct {
+    bool finished;                  // 录制文件已全部回放（结尾未录到断开时补一次断开回调）
+    uint64_t records;               // 已回放的记录数
+    uint64_t recorded_outbound;     // 已回放部分中录制时客户端发出的消息数
+    uint64_t outbound;              // 回放期间本实例发出的消息数（不写网络）
+    uint64_t max_lag_us;            // 记录晚于录制节奏处理的最大延迟，尽快回放时为 0
+} linx_websocket_replay_stats_t;
+
+/* 空闲上行消息的最大长度（含结尾的 '\0'） */
+#define LINX_WEBSOCKET_IDLE_MESSAGE_MAX 4096
+
+/**
+ * 空闲上行回调：在事件循环线程中调用，把一条低优先级文本消息写入 buffer
+ * @param user_data 注册时传入的用户指针
+ * @param buffer 消息缓冲区
+ * @param size 缓冲区大小（LINX_WEBSOCKET_IDLE_MESSAGE_MAX）
+ * @return 消息长度，0 表示暂无数据
+ */
+typedef size_t (*linx_websocket_idle_sender_t)(void* user_data, char* buffer, size_t size);
+
+/**
+ * 拨号钩子：每次拨号（首次连接和每次自动重连）之前在事件循环线程中调用，
+ * 可在其中调用 linx_websocket_set_server_url() 换一个服务器（端点故障转移，见 linx_endpoints.h）
+ * @param user_data 注册时传入的用户指针
+ * @param reconnect_attempt 本次是连续第几次重连，首次连接为 0
+ */
+typedef void (*linx_websocket_dial_hook_t)(void* user_data, int reconnect_attempt);
+
 /* 核心接口函数 */
 
 /**
@@ -56,11 +323,52 @@ void linx_websocket_destroy(linx_protocol_t* protocol);
 
 /**
  * 轮询 WebSocket 事件
+ * 使用共享 reactor 时等同于 linx_reactor_poll()，会驱动同一 reactor 上的所有实例
  * @param protocol WebSocket 协议实例
  * @param timeout_ms 超时时间（毫秒）
  */
 void linx_websocket_poll(linx_websocket_protocol_t* protocol, int timeout_ms);
 
+/**
+ * 唤醒阻塞在 linx_websocket_poll() 中的事件循环（可在任意线程调用）
+ * 非事件循环线程调用 send_audio/send_text 时数据会进入无锁发送队列，
+ * 并自动调用本函数，由事件循环线程统一发送（音频优先）
+ * @param protocol WebSocket 协议实例
+ * @return 唤醒信号发送成功返回 true
+ */
+bool linx_websocket_wakeup(linx_websocket_protocol_t* protocol);
+
+/**
+ * 外部事件循环需要监听的文件描述符
+ */
+typedef struct {
+    int fd;                         // socket 或唤醒管道
+    bool want_write;                // 有待发送数据或连接尚未建立，需要同时监听可写
+    bool want_read;                 // 需要监听可读；下行流控暂停读取时为 false
+} linx_websocket_poll_fd_t;
+
+/**
+ * 获取管理器上全部连接（含 DNS、OTA 等同一管理器上的连接）及唤醒管道的描述符，
+ * 供应用加入自己的 epoll/kqueue/select；任一描述符就绪后调用 linx_websocket_poll(protocol, 0)
+ * 描述符集合在每次 poll 后可能变化（重连、DNS 查询结束等），应在每次 poll 后重新获取
+ * 只能在调用 linx_websocket_poll() 的线程中使用
+ * @param protocol WebSocket 协议实例
+ * @param fds 输出数组
+ * @param max_fds 数组容量
+ * @return 描述符总数（可能大于 max_fds，此时只填充前 max_fds 个）
+ */
+size_t linx_websocket_get_poll_fds(linx_websocket_protocol_t* protocol,
+                                   linx_websocket_poll_fd_t* fds, size_t max_fds);
+
+/**
+ * 外部事件循环在没有描述符就绪时最多等待多久再调用 linx_websocket_poll()
+ * 考虑了时间轮上待执行的重连和保活探测；mongoose 内部定时器（DNS 超时等）的精度由 max_timeout_ms 决定
+ * @param protocol WebSocket 协议实例
+ * @param max_timeout_ms 上限（毫秒），-1 表示不设上限
+ * @return 等待时间（毫秒），-1 表示无限等待
+ */
+int linx_websocket_get_poll_timeout_ms(linx_websocket_protocol_t* protocol, int max_timeout_ms);
+
 /**
  * 停止 WebSocket 连接
  * @param protocol WebSocket 协议实例
@@ -77,18 +385,80 @@ void linx_websocket_stop(linx_websocket_protocol_t* protocol);
 bool linx_websocket_is_connected(const linx_websocket_protocol_t* protocol);
 
 /**
- * 获取重连尝试次数
+ * 获取重连尝试次数（可在任意线程调用）
+ * 自上次收到服务端 hello 以来连续发起的重连次数
  * @param protocol WebSocket 协议实例
  * @return 重连尝试次数
  */
 int linx_websocket_get_reconnect_attempts(const linx_websocket_protocol_t* protocol);
 
 /**
- * 重置重连尝试次数
+ * 重置重连尝试次数，下次退避从最小延迟重新开始
  * @param protocol WebSocket 协议实例
  */
 void linx_websocket_reset_reconnect_attempts(linx_websocket_protocol_t* protocol);
 
+/**
+ * 是否正在等待或进行自动重连（可在任意线程调用）
+ * 
+ * 连接断开后按去相关抖动的指数退避安排重连：每次延迟在
+ * [reconnect_base_ms, 3 × 上次延迟] 中随机选取，不超过 reconnect_max_ms，
+ * 大量设备同时断线时不会在同一时刻重连。重连由 linx_websocket_poll() 执行，
+ * 轮询超时会自动缩短到下次重连时刻。
+ * 
+ * on_disconnected 在已建立的连接断开时，以及放弃重连时调用；
+ * 重连期间连接失败不会重复调用。
+ * @param protocol WebSocket 协议实例
+ * @return 断开后尚未重新连上且未放弃时返回 true
+ */
+bool linx_websocket_is_reconnecting(const linx_websocket_protocol_t* protocol);
+
+/**
+ * 本次连接是否恢复了断开前的会话
+ * 
+ * 服务端 hello 的 features.resume 为 true 时，重连的 hello 会带上原 session_id
+ * 和已协商的音频参数；服务端返回相同的 session_id 即为恢复成功。
+ * @param protocol WebSocket 协议实例
+ * @return 恢复成功返回 true
+ */
+bool linx_websocket_is_session_resumed(const linx_websocket_protocol_t* protocol);
+
+/**
+ * 用保存下来的会话初始化恢复状态（如重启后的第一次连接，见 linx_session_cache.h）
+ * 
+ * 在 linx_websocket_start() 之前调用，效果如同本实例断开前建立过该会话：params->resume
+ * 为 true 时第一条 hello 就带上 session_id 和 params 中的音频格式、帧长，服务端仍保留
+ * 该会话时直接恢复，否则照常建立新会话。
+ * @param protocol WebSocket 协议实例
+ * @param session_id 上次会话的 session_id
+ * @param params 上次的 hello 协商结果
+ * @return 参数有效且服务端支持恢复返回 true
+ */
+bool linx_websocket_set_resume_state(linx_websocket_protocol_t* protocol, const char* session_id,
+                                     const linx_websocket_session_params_t* params);
+
+/**
+ * 设置 wss 握手时尝试恢复的 TLS 会话（mbedtls_ssl_session_save() 的输出）
+ * 
+ * 恢复成功时省去证书链传输和校验、密钥交换的计算。在 linx_websocket_start() 之前调用；
+ * 每次握手成功后当前会话替换保存的会话。只有 mbedTLS 后端（LINX_TLS_BACKEND=mbedtls）
+ * 支持会话恢复，内置 TLS 时返回 false。
+ * @param protocol WebSocket 协议实例
+ * @param data 会话数据，会被复制
+ * @param size 字节数
+ * @return 已保存返回 true
+ */
+bool linx_websocket_set_tls_session(linx_websocket_protocol_t* protocol, const uint8_t* data, size_t size);
+
+/**
+ * 读取最近一次握手的 TLS 会话，在事件循环线程上调用（如服务端 hello 的处理中）
+ * @param protocol WebSocket 协议实例
+ * @param buffer 输出缓冲区
+ * @param size 缓冲区大小
+ * @return 会话字节数，没有会话或缓冲区不足返回 0
+ */
+size_t linx_websocket_get_tls_session(const linx_websocket_protocol_t* protocol, uint8_t* buffer, size_t size);
+
 /**
  * 处理 WebSocket 事件
  * @param protocol WebSocket 协议实例
@@ -96,19 +466,222 @@ void linx_websocket_reset_reconnect_attempts(linx_websocket_protocol_t* protocol
 void linx_websocket_process_events(linx_websocket_protocol_t* protocol);
 
 /**
- * 发送 ping 消息
+ * 立即发送一次保活探测（ping），已有未应答的探测时不重复发送
+ * 收到 pong 后更新往返时间，可通过 linx_websocket_get_uplink_stats() 读取；
+ * 非事件循环线程调用时由事件循环线程代为发送。保活开启时事件循环会按计划自动探测，无需调用
  * @param protocol WebSocket 协议实例
  * @return 发送成功返回 true
  */
 bool linx_websocket_send_ping(linx_websocket_protocol_t* protocol);
 
 /**
- * 检查连接是否超时
+ * 获取上行拥塞观测统计（可在任意线程调用）
+ * 发送积压在每次事件循环轮询时更新，RTT 在收到 pong 时更新
+ * @param protocol WebSocket 协议实例
+ * @param stats 统计信息（输出参数）
+ * @return 成功返回 true
+ */
+bool linx_websocket_get_uplink_stats(linx_websocket_protocol_t* protocol,
+                                     linx_websocket_uplink_stats_t* stats);
+
+/**
+ * 获取下行流控统计（可在任意线程调用）
+ * @param protocol WebSocket 协议实例
+ * @param stats 统计信息（输出参数）
+ * @return 成功返回 true
+ */
+bool linx_websocket_get_flow_stats(linx_websocket_protocol_t* protocol, linx_websocket_flow_stats_t* stats);
+
+/**
+ * 获取回放统计（可在任意线程调用）
+ * 回放期间 outbound 与 recorded_outbound 明显不同说明客户端行为与录制时不一致
+ * @param protocol WebSocket 协议实例
+ * @param stats 统计信息（输出参数）
+ * @return 成功返回 true；未处于回放模式返回 false
+ */
+bool linx_websocket_get_replay_stats(linx_websocket_protocol_t* protocol,
+                                     linx_websocket_replay_stats_t* stats);
+
+/**
+ * 获取文本消息压缩统计（可在任意线程调用）
+ * 统计属于最近一次协商成功的连接，断开后保留到下一次协商成功
+ * @param protocol WebSocket 协议实例
+ * @param stats 统计信息（输出参数）
+ * @return 有连接协商成功过返回 true
+ */
+bool linx_websocket_get_deflate_stats(linx_websocket_protocol_t* protocol, linx_ws_deflate_stats_t* stats);
+
+/**
+ * 获取协商后的音频格式
+ * 服务端 hello 的 audio_params.format 优先，未指定时为客户端提供的格式
+ * @param protocol WebSocket 协议实例
+ * @param format 格式名（输出参数），见 codec_factory_parse_format()
+ * @param size format 缓冲区大小
+ * @return 成功返回 true
+ */
+bool linx_websocket_get_audio_format(linx_websocket_protocol_t* protocol, char* format, size_t size);
+
+/**
+ * 获取 hello 协商结果，在收到服务端 hello（会话建立事件）之后调用
+ * 服务端没有回应的项保持客户端首选值，未确认的可选特性视为不支持
+ * @param protocol WebSocket 协议实例
+ * @param params 协商结果（输出参数）
+ * @return 已收到服务端 hello 返回 true
+ */
+bool linx_websocket_get_session_params(linx_websocket_protocol_t* protocol,
+                                       linx_websocket_session_params_t* params);
+
+/**
+ * 检查连接是否超时：保活判定当前连接已半开，或关闭保活时超过 120 秒没有收到任何数据
  * @param protocol WebSocket 协议实例
  * @return 超时返回 true
  */
 bool linx_websocket_is_connection_timeout(const linx_websocket_protocol_t* protocol);
 
+/**
+ * 获取本会话的音频数据包内存池
+ * 可配合 linx_audio_packet_pool_retain() 保留接收回调中的零拷贝数据包
+ * @param protocol WebSocket 协议实例
+ * @return 内存池实例，不可用时返回 NULL
+ */
+linx_audio_packet_pool_t* linx_websocket_get_packet_pool(linx_websocket_protocol_t* protocol);
+
+/**
+ * 获取本会话音频数据包内存池的命中/未命中统计
+ * @param protocol WebSocket 协议实例
+ * @param stats 统计信息（输出参数）
+ * @return 成功返回 true
+ */
+bool linx_websocket_get_packet_pool_stats(linx_websocket_protocol_t* protocol,
+                                          linx_audio_packet_pool_stats_t* stats);
+
+/**
+ * 获取本会话入站消息 cJSON 竞技场的使用统计
+ * 可用于确认竞技场容量是否足够（fallbacks 应保持为 0）
+ * @param protocol WebSocket 协议实例
+ * @param stats 统计信息（输出参数）
+ * @return 成功返回 true
+ */
+bool linx_websocket_get_json_arena_stats(linx_websocket_protocol_t* protocol,
+                                         linx_json_arena_stats_t* stats);
+
+/**
+ * 注册空闲上行回调（如远程日志），需在 linx_websocket_start() 之前调用
+ * 只在连接已完成握手、所有发送队列（含大消息）为空且发送缓冲区已全部写出时调用，
+ * 每次轮询最多发送一条，语音帧总是优先于这类消息
+ * @param protocol WebSocket 协议实例
+ * @param sender 回调函数，NULL 取消
+ * @param user_data 用户指针
+ * @return 成功返回 true
+ */
+bool linx_websocket_set_idle_sender(linx_websocket_protocol_t* protocol,
+                                    linx_websocket_idle_sender_t sender, void* user_data);
+
+/**
+ * 注册拨号钩子，需在 linx_websocket_start() 之前调用
+ * @param protocol WebSocket 协议实例
+ * @param hook 钩子函数，NULL 取消
+ * @param user_data 用户指针
+ * @return 成功返回 true
+ */
+bool linx_websocket_set_dial_hook(linx_websocket_protocol_t* protocol,
+                                  linx_websocket_dial_hook_t hook, void* user_data);
+
+/* RTT 探测的默认超时（毫秒） */
+#define LINX_WEBSOCKET_PROBE_TIMEOUT_MS 3000
+
+/**
+ * RTT 探测结果回调（事件循环线程）
+ * @param user_data 发起探测时传入的用户指针
+ * @param url 探测的地址
+ * @param rtt_ms 地址解析完成到 TCP 连接建立的耗时（毫秒），<0 表示失败或超时
+ */
+typedef void (*linx_websocket_probe_cb_t)(void* user_data, const char* url, int rtt_ms);
+
+/**
+ * 测量到另一个服务器的往返时延：在本连接的 mongoose 管理器上向 url 的主机和端口建立一条
+ * TCP 连接，建立后立即关闭，不发送数据、不做 TLS 握手，TCP 握手正好是一个往返
+ *
+ * 同一时刻只进行一个探测；停止或销毁协议实例时取消进行中的探测，不再回调。
+ * 只能在事件循环线程中调用
+ * @param protocol WebSocket 协议实例
+ * @param url 服务器URL（ws:// 或 wss://）
+ * @param timeout_ms 超时时间（毫秒），<=0 为 LINX_WEBSOCKET_PROBE_TIMEOUT_MS
+ * @param cb 结果回调
+ * @param user_data 用户指针
+ * @return 已发起探测返回 true；已有探测在进行或连接创建失败返回 false
+ */
+bool linx_websocket_probe_rtt(linx_websocket_protocol_t* protocol, const char* url, int timeout_ms,
+                              linx_websocket_probe_cb_t cb, void* user_data);
+
+/**
+ * 更换服务器地址，下次拨号生效，当前连接不受影响
+ * 只能在 linx_websocket_start() 之前或事件循环线程中（例如拨号钩子里）调用
+ * @param protocol WebSocket 协议实例
+ * @param url 新的服务器URL
+ * @return 成功返回 true
+ */
+bool linx_websocket_set_server_url(linx_websocket_protocol_t* protocol, const char* url);
+
+/**
+ * 获取驱动本连接的 mongoose 管理器
+ * 其他模块（如 OTA）可在同一事件循环上建立自己的连接，
+ * 只能在调用 linx_websocket_poll() 的线程中使用（共享 reactor 时为其循环上下文）
+ * @param protocol WebSocket 协议实例
+ * @return 管理器指针，protocol 为 NULL 时返回 NULL
+ */
+struct mg_mgr* linx_websocket_get_mgr(linx_websocket_protocol_t* protocol);
+
+/*
+ * 多路复用：网关这类一台设备上运行多个逻辑设备的场景，多个会话共用一条 WebSocket 连接，
+ * TCP/TLS 握手和保活都只有一份。承载连接配置 multiplex，服务端 hello 确认 features.streams 后
+ * 流才能打开。每个流有自己的编号、hello 和 session_id：
+ * - 上行 JSON 顶层带 "stream":N，下行消息同样按 "stream" 分发，不带或为 0 的属于连接自身；
+ * - 音频和 CBOR 控制消息的流ID写在二进制帧头的保留字节中（linx_binary_protocol_set_stream()）；
+ * - 流的 hello 为 {"type":"hello","stream":N,"device_id":...,"audio_params":{...}}，音频参数沿用
+ *   连接协商的结果；服务端回应同一 stream 的 hello（其中的 session_id 属于该流）后流才打开，
+ *   此时调用流的 on_connected，随后这条 hello 照常交给消息回调；
+ * - 销毁流时发送 {"type":"goodbye","stream":N}，服务端发来 goodbye 时流关闭并调用 on_disconnected。
+ * 连接断开时已打开的流都收到 on_disconnected，重连后服务端 hello 到达时各自重新发送 hello
+ * （服务端支持 resume 时带上原 session_id）。连接的保活、重连、流控、录制都按连接进行，
+ * 下行流控只跟随连接自身会话的播放端。
+ *
+ * 流以 linx_protocol_t 开头，可转换后交给 linx_protocol_start()、linx_protocol_send_audio()、
+ * linx_protocol_send_text()、linx_protocol_send_start_listening() 等函数，发送函数可在任意线程调用。
+ * 回调在承载连接的事件循环上下文中调用，回调中不能销毁流；流必须在承载连接之前销毁。
+ */
+
+/**
+ * 在连接上创建一个流，分配最小的空闲流ID
+ * 可在连接建立之前创建，linx_protocol_start() 后随服务端 hello 一起打开
+ * @param protocol 承载连接（配置了 multiplex）
+ * @param config 流配置，字符串会被复制；可为 NULL
+ * @return 流实例，用 linx_websocket_stream_destroy() 销毁；流ID已用完、未配置 multiplex 或内存不足时返回 NULL
+ */
+linx_websocket_stream_t* linx_websocket_stream_create(linx_websocket_protocol_t* protocol,
+                                                      const linx_websocket_stream_config_t* config);
+
+/**
+ * 销毁流：已打开时先发送 goodbye，之后不再调用它的回调
+ * @param protocol 要销毁的流
+ */
+void linx_websocket_stream_destroy(linx_protocol_t* protocol);
+
+/**
+ * 流ID（1 到 LINX_WEBSOCKET_MAX_STREAMS）
+ */
+uint8_t linx_websocket_stream_get_id(const linx_websocket_stream_t* stream);
+
+/**
+ * 服务端是否已回应本流的 hello
+ */
+bool linx_websocket_stream_is_opened(const linx_websocket_stream_t* stream);
+
+/**
+ * 流所在的承载连接，用于读取统计、协商参数等连接级信息
+ */
+linx_websocket_protocol_t* linx_websocket_stream_get_carrier(const linx_websocket_stream_t* stream);
+
 /**
  * 创建 WebSocket 协议实例（别名函数）
  * @param config WebSocket 配置参数
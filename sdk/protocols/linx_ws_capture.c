@@ -0,0 +1,249 @@
+#include "linx_ws_capture.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_PROTOCOL);
+
+#define LINX_WS_CAPTURE_MAGIC "LXWS"
+#define LINX_WS_CAPTURE_HEADER_SIZE 16
+
+/* 录制文件的 stdio 缓冲区，减少音频帧逐条记录时的系统调用 */
+#define LINX_WS_CAPTURE_BUFFER_SIZE (64 * 1024)
+
+struct linx_ws_capture {
+    FILE* file;
+    char* buffer;                   // setvbuf 缓冲区
+    uint64_t start_us;              // 录制开始时刻（CLOCK_MONOTONIC）
+    uint64_t last_us;               // 上一条记录的时刻（距录制开始）
+    uint64_t records;               // 已写入的记录数
+    bool failed;                    // 写入出错后不再记录
+};
+
+struct linx_ws_replay {
+    FILE* file;
+    int protocol_version;
+    uint64_t timestamp_us;          // 最近一条记录的时刻
+    uint8_t* data;                  // 记录数据缓冲区
+    size_t capacity;
+};
+
+static uint64_t linx_ws_capture_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)(ts.tv_nsec / 1000);
+}
+
+static size_t linx_ws_capture_put_varint(uint8_t* out, uint64_t value) {
+    size_t len = 0;
+    while (value >= 0x80) {
+        out[len++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[len++] = (uint8_t)value;
+    return len;
+}
+
+/* 返回 1 成功，0 在第一个字节处遇到文件结束，-1 截断或超长 */
+static int linx_ws_capture_get_varint(FILE* file, uint64_t* value) {
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int c = fgetc(file);
+        if (c == EOF) {
+            return shift == 0 ? 0 : -1;
+        }
+        result |= (uint64_t)(c & 0x7F) << shift;
+        if (!(c & 0x80)) {
+            *value = result;
+            return 1;
+        }
+    }
+    return -1;
+}
+
+linx_ws_capture_t* linx_ws_capture_create(const char* path, int protocol_version) {
+    if (!path) {
+        return NULL;
+    }
+    
+    linx_ws_capture_t* capture = LINX_CALLOC(1, sizeof(linx_ws_capture_t));
+    if (!capture) {
+        return NULL;
+    }
+    capture->file = fopen(path, "wb");
+    if (!capture->file) {
+        LOG_ERROR("WebSocket capture: cannot create %s", path);
+        LINX_FREE(capture);
+        return NULL;
+    }
+    capture->buffer = LINX_MALLOC(LINX_WS_CAPTURE_BUFFER_SIZE);
+    if (capture->buffer) {
+        setvbuf(capture->file, capture->buffer, _IOFBF, LINX_WS_CAPTURE_BUFFER_SIZE);
+    }
+    
+    uint8_t header[LINX_WS_CAPTURE_HEADER_SIZE] = {0};
+    memcpy(header, LINX_WS_CAPTURE_MAGIC, 4);
+    header[4] = (uint8_t)(LINX_WS_CAPTURE_FORMAT_VERSION & 0xFF);
+    header[5] = (uint8_t)(LINX_WS_CAPTURE_FORMAT_VERSION >> 8);
+    header[6] = (uint8_t)(protocol_version & 0xFF);
+    header[7] = (uint8_t)((protocol_version >> 8) & 0xFF);
+    if (fwrite(header, 1, sizeof(header), capture->file) != sizeof(header)) {
+        LOG_ERROR("WebSocket capture: cannot write header to %s", path);
+        linx_ws_capture_destroy(capture);
+        return NULL;
+    }
+    
+    capture->start_us = linx_ws_capture_now_us();
+    LOG_INFO("WebSocket capture started: %s (protocol v%d)", path, protocol_version);
+    return capture;
+}
+
+bool linx_ws_capture_write(linx_ws_capture_t* capture, linx_ws_capture_type_t type,
+                           const void* head, size_t head_size, const void* body, size_t body_size) {
+    if (!capture || capture->failed) {
+        return false;
+    }
+    
+    size_t size = head_size + body_size;
+    uint64_t now = linx_ws_capture_now_us() - capture->start_us;
+    uint64_t delta = now >= capture->last_us ? now - capture->last_us : 0;
+    
+    uint8_t prefix[1 + 10 + 10];
+    size_t prefix_len = 0;
+    prefix[prefix_len++] = (uint8_t)type;
+    prefix_len += linx_ws_capture_put_varint(prefix + prefix_len, delta);
+    prefix_len += linx_ws_capture_put_varint(prefix + prefix_len, size);
+    
+    if (fwrite(prefix, 1, prefix_len, capture->file) != prefix_len ||
+        (head_size > 0 && fwrite(head, 1, head_size, capture->file) != head_size) ||
+        (body_size > 0 && fwrite(body, 1, body_size, capture->file) != body_size)) {
+        LOG_ERROR("WebSocket capture: write failed after %llu records, capture stopped",
+                  (unsigned long long)capture->records);
+        capture->failed = true;
+        return false;
+    }
+    
+    capture->last_us = now;
+    capture->records++;
+    return true;
+}
+
+uint64_t linx_ws_capture_get_records(const linx_ws_capture_t* capture) {
+    return capture ? capture->records : 0;
+}
+
+void linx_ws_capture_destroy(linx_ws_capture_t* capture) {
+    if (!capture) {
+        return;
+    }
+    if (capture->file) {
+        fclose(capture->file);
+    }
+    LINX_FREE(capture->buffer);
+    LINX_FREE(capture);
+}
+
+linx_ws_replay_t* linx_ws_replay_open(const char* path) {
+    if (!path) {
+        return NULL;
+    }
+    
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        LOG_ERROR("WebSocket replay: cannot open %s", path);
+        return NULL;
+    }
+    
+    uint8_t header[LINX_WS_CAPTURE_HEADER_SIZE];
+    if (fread(header, 1, sizeof(header), file) != sizeof(header) ||
+        memcmp(header, LINX_WS_CAPTURE_MAGIC, 4) != 0) {
+        LOG_ERROR("WebSocket replay: %s is not a capture file", path);
+        fclose(file);
+        return NULL;
+    }
+    int format = header[4] | (header[5] << 8);
+    if (format != LINX_WS_CAPTURE_FORMAT_VERSION) {
+        LOG_ERROR("WebSocket replay: unsupported capture format %d in %s", format, path);
+        fclose(file);
+        return NULL;
+    }
+    
+    linx_ws_replay_t* replay = LINX_CALLOC(1, sizeof(linx_ws_replay_t));
+    if (!replay) {
+        fclose(file);
+        return NULL;
+    }
+    replay->file = file;
+    replay->protocol_version = header[6] | (header[7] << 8);
+    return replay;
+}
+
+int linx_ws_replay_get_protocol_version(const linx_ws_replay_t* replay) {
+    return replay ? replay->protocol_version : 0;
+}
+
+int linx_ws_replay_next(linx_ws_replay_t* replay, linx_ws_capture_record_t* record) {
+    if (!replay || !record) {
+        return -1;
+    }
+    
+    int type = fgetc(replay->file);
+    if (type == EOF) {
+        return 0;
+    }
+    if (type < LINX_WS_CAPTURE_OPEN || type > LINX_WS_CAPTURE_OUT_BINARY) {
+        LOG_ERROR("WebSocket replay: unknown record type %d", type);
+        return -1;
+    }
+    
+    uint64_t delta = 0;
+    uint64_t size = 0;
+    if (linx_ws_capture_get_varint(replay->file, &delta) != 1 ||
+        linx_ws_capture_get_varint(replay->file, &size) != 1 || size > LINX_WS_CAPTURE_MAX_RECORD) {
+        LOG_ERROR("WebSocket replay: truncated or oversized record");
+        return -1;
+    }
+    
+    if (size > replay->capacity) {
+        uint8_t* grown = LINX_REALLOC(replay->data, (size_t)size);
+        if (!grown) {
+            return -1;
+        }
+        replay->data = grown;
+        replay->capacity = (size_t)size;
+    }
+    if (size > 0 && fread(replay->data, 1, (size_t)size, replay->file) != size) {
+        LOG_ERROR("WebSocket replay: truncated record data");
+        return -1;
+    }
+    
+    replay->timestamp_us += delta;
+    record->type = (linx_ws_capture_type_t)type;
+    record->timestamp_us = replay->timestamp_us;
+    record->data = replay->data;
+    record->size = (size_t)size;
+    return 1;
+}
+
+void linx_ws_replay_close(linx_ws_replay_t* replay) {
+    if (!replay) {
+        return;
+    }
+    fclose(replay->file);
+    LINX_FREE(replay->data);
+    LINX_FREE(replay);
+}
+
+const char* linx_ws_capture_type_name(linx_ws_capture_type_t type) {
+    switch (type) {
+        case LINX_WS_CAPTURE_OPEN:       return "open";
+        case LINX_WS_CAPTURE_CLOSE:      return "close";
+        case LINX_WS_CAPTURE_IN_TEXT:    return "in_text";
+        case LINX_WS_CAPTURE_IN_BINARY:  return "in_binary";
+        case LINX_WS_CAPTURE_OUT_TEXT:   return "out_text";
+        case LINX_WS_CAPTURE_OUT_BINARY: return "out_binary";
+        default:                         return "unknown";
+    }
+}
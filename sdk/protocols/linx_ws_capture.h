@@ -0,0 +1,115 @@
+#ifndef LINX_WS_CAPTURE_H
+#define LINX_WS_CAPTURE_H
+
+/*
+ * WebSocket 会话录制文件
+ *
+ * 按时间顺序记录一次会话在 WebSocket 上收发的每一帧（连接建立、断开、收到和发出的
+ * 文本/二进制消息），用于把线上的时延问题复现为可重复运行的基准（见
+ * linx_websocket_config_t::replay_path）。
+ *
+ * 文件格式（整数均为小端）：
+ *   文件头 16 字节: "LXWS" | u16 格式版本 | u16 协议版本 | u64 保留
+ *   记录: u8 类型 | varint 距上一条记录的微秒数 | varint 数据长度 | 数据
+ * 二进制消息按线上格式保存（含 v2/v3 协议头），回放时重新走协议解析。
+ *
+ * 写入和读取都不是线程安全的：WebSocket 只在事件循环线程上写入。
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 录制格式版本 */
+#define LINX_WS_CAPTURE_FORMAT_VERSION 1
+
+/* 单条记录的数据上限，超出的记录视为文件损坏 */
+#define LINX_WS_CAPTURE_MAX_RECORD (16u * 1024u * 1024u)
+
+/* 记录类型 */
+typedef enum {
+    LINX_WS_CAPTURE_OPEN = 1,       // WebSocket 连接建立（无数据）
+    LINX_WS_CAPTURE_CLOSE,          // 连接断开（无数据）
+    LINX_WS_CAPTURE_IN_TEXT,        // 收到文本消息
+    LINX_WS_CAPTURE_IN_BINARY,      // 收到二进制消息
+    LINX_WS_CAPTURE_OUT_TEXT,       // 发出文本消息
+    LINX_WS_CAPTURE_OUT_BINARY,     // 发出二进制消息
+} linx_ws_capture_type_t;
+
+/* 一条记录 */
+typedef struct {
+    linx_ws_capture_type_t type;    // 记录类型
+    uint64_t timestamp_us;          // 距录制开始的微秒数
+    const uint8_t* data;            // 数据，在下一次读取前有效
+    size_t size;                    // 数据长度
+} linx_ws_capture_record_t;
+
+/* 录制器 / 读取器 - 前向声明 */
+typedef struct linx_ws_capture linx_ws_capture_t;
+typedef struct linx_ws_replay linx_ws_replay_t;
+
+/**
+ * 创建录制文件（已存在时覆盖）
+ * @param path 文件路径
+ * @param protocol_version 会话使用的协议版本，回放时据此解析二进制帧
+ * @return 录制器，失败返回 NULL
+ */
+linx_ws_capture_t* linx_ws_capture_create(const char* path, int protocol_version);
+
+/**
+ * 追加一条记录
+ * 数据由 head 和 body 两段拼接而成，便于直接记录分开存放的协议头和载荷；不需要时传 NULL/0
+ * @return 写入成功返回 true；写入失败后录制器停止记录，之后的调用都返回 false
+ */
+bool linx_ws_capture_write(linx_ws_capture_t* capture, linx_ws_capture_type_t type,
+                           const void* head, size_t head_size, const void* body, size_t body_size);
+
+/**
+ * 已写入的记录数
+ */
+uint64_t linx_ws_capture_get_records(const linx_ws_capture_t* capture);
+
+/**
+ * 写出缓冲的数据并关闭文件；capture 为 NULL 时无操作
+ */
+void linx_ws_capture_destroy(linx_ws_capture_t* capture);
+
+/**
+ * 打开录制文件
+ * @param path 文件路径
+ * @return 读取器；文件不存在或文件头不符时返回 NULL
+ */
+linx_ws_replay_t* linx_ws_replay_open(const char* path);
+
+/**
+ * 录制时的协议版本
+ */
+int linx_ws_replay_get_protocol_version(const linx_ws_replay_t* replay);
+
+/**
+ * 读取下一条记录
+ * @param replay 读取器
+ * @param record 输出记录，data 指向读取器内部缓冲区
+ * @return 1 读到一条记录；0 文件结束；-1 文件损坏或截断
+ */
+int linx_ws_replay_next(linx_ws_replay_t* replay, linx_ws_capture_record_t* record);
+
+/**
+ * 关闭读取器；replay 为 NULL 时无操作
+ */
+void linx_ws_replay_close(linx_ws_replay_t* replay);
+
+/**
+ * 记录类型名称（"open"、"in_text" 等），越界返回 "unknown"
+ */
+const char* linx_ws_capture_type_name(linx_ws_capture_type_t type);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINX_WS_CAPTURE_H */
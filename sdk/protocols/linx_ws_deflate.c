@@ -0,0 +1,797 @@
+#include "linx_ws_deflate.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_PROTOCOL);
+
+/* DEFLATE 常量（RFC 1951） */
+#define DEFLATE_MIN_MATCH   3
+#define DEFLATE_MAX_MATCH   258
+#define DEFLATE_MAX_BITS    15
+#define DEFLATE_MAX_LITLEN  288
+#define DEFLATE_MAX_DIST    30
+
+/*
+ * 预置字典：SDK 收发的控制消息中最常见的片段。DEFLATE 回溯距离越短编码越短，
+ * 越常见的片段越靠后。修改内容必须升级 LINX_WS_DEFLATE_DICTIONARY_VERSION。
+ */
+static const char s_dictionary[] =
+    "\"protocolVersion\":\"2024-11-05\",\"capabilities\":{\"tools\":{\"listChanged\":false}},"
+    "\"serverInfo\":{\"name\":\"\",\"version\":\"\"},\"annotations\":{\"audience\":[\"user\"]},"
+    "\"mimeType\":\"image/jpeg\",\"data\":\"\",\"error\":{\"code\":-32602,\"message\":\"\"},"
+    "\"nextCursor\":\"\",\"minimum\":0,\"maximum\":100,\"default\":"
+    "{\"type\":\"hello\",\"version\":1,\"features\":{\"mcp\":true,\"resume\":true},"
+    "\"transport\":\"websocket\",\"audio_params\":{\"format\":\"opus\",\"sample_rate\":16000,"
+    "\"channels\":1,\"frame_duration\":60}}"
+    "{\"type\":\"listen\",\"state\":\"detect\",\"mode\":\"auto\",\"text\":\"\"}"
+    "{\"type\":\"abort\",\"reason\":\"wake_word_detected\"}"
+    "{\"type\":\"llm\",\"emotion\":\"\"}"
+    "{\"type\":\"stt\",\"text\":\"\"}"
+    "{\"type\":\"tts\",\"state\":\"stop\"}{\"type\":\"tts\",\"state\":\"start\"}"
+    "{\"type\":\"tts\",\"state\":\"sentence_end\"}{\"type\":\"tts\",\"state\":\"sentence_start\",\"text\":\""
+    "\",\"session_id\":\"\"}"
+    "\"params\":{\"name\":\"self.\",\"arguments\":{}},\"method\":\"tools/call\",\"method\":\"tools/list\","
+    "\"content\":[{\"type\":\"text\",\"text\":\"\"}],\"isError\":false}"
+    "{\"type\":\"integer\",\"type\":\"boolean\",\"type\":\"string\","
+    "{\"name\":\"self.\",\"description\":\"\",\"inputSchema\":{\"type\":\"object\",\"properties\":{"
+    "},\"required\":[]}},"
+    "{\"type\":\"mcp\",\"payload\":{\"jsonrpc\":\"2.0\",\"id\":1,\"result\":{\"tools\":[";
+
+/* 长度与距离编码表 */
+static const uint16_t s_length_base[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t s_length_extra[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const uint16_t s_dist_base[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+static const uint8_t s_dist_extra[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+/* 动态块中码长码的传输顺序 */
+static const uint8_t s_code_length_order[19] = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+/* 范式 Huffman 解码表：各码长的码字数和按码字排序的符号 */
+typedef struct {
+    uint16_t count[DEFLATE_MAX_BITS + 1];
+    uint16_t symbol[DEFLATE_MAX_LITLEN];
+} ws_huffman_t;
+
+struct linx_ws_deflate {
+    int client_window_bits;         // 本端压缩的回溯距离上限位数
+    int server_window_bits;         // 服务端压缩的窗口位数
+    bool dictionary;
+    bool server_context_takeover;
+    size_t min_size;
+
+    uint16_t hash[1u << LINX_WS_DEFLATE_HASH_BITS]; // 3 字节前缀 -> 最近出现的位置
+    uint8_t* work;                  // 压缩：字典末尾 + 消息
+    size_t work_capacity;
+    uint8_t* out;                   // 压缩输出
+    size_t out_capacity;
+
+    uint8_t* inflated;              // 解压：历史 + 消息
+    size_t inflated_capacity;
+    uint8_t* history;               // 解压历史（字典末尾或服务端保留的上下文）
+    size_t history_len;
+    size_t history_capacity;
+    ws_huffman_t litlen;
+    ws_huffman_t dist;
+    ws_huffman_t codelen;
+
+    linx_ws_deflate_stats_t stats;
+};
+
+/* ==================== 协商 ==================== */
+
+static int ws_deflate_window_bits(const linx_ws_deflate_config_t* config) {
+    if (config->window_bits <= 0) {
+        return LINX_WS_DEFLATE_WINDOW_BITS_DEFAULT;
+    }
+    if (config->window_bits < LINX_WS_DEFLATE_WINDOW_BITS_MIN) {
+        return LINX_WS_DEFLATE_WINDOW_BITS_MIN;
+    }
+    if (config->window_bits > LINX_WS_DEFLATE_WINDOW_BITS_MAX) {
+        return LINX_WS_DEFLATE_WINDOW_BITS_MAX;
+    }
+    return config->window_bits;
+}
+
+size_t linx_ws_deflate_offer(const linx_ws_deflate_config_t* config, char* buffer, size_t size) {
+    if (!config || !buffer || size == 0) {
+        return 0;
+    }
+    int bits = ws_deflate_window_bits(config);
+    int len = snprintf(buffer, size,
+                       "Sec-WebSocket-Extensions: permessage-deflate; client_no_context_takeover; "
+                       "server_no_context_takeover; client_max_window_bits=%d; server_max_window_bits=%d\r\n",
+                       bits, bits);
+    if (len < 0 || (size_t)len >= size) {
+        buffer[0] = '\0';
+        return 0;
+    }
+    if (config->dictionary) {
+        int extra = snprintf(buffer + len, size - (size_t)len, "Linx-Deflate-Dictionary: %d\r\n",
+                             LINX_WS_DEFLATE_DICTIONARY_VERSION);
+        if (extra < 0 || (size_t)extra >= size - (size_t)len) {
+            buffer[0] = '\0';
+            return 0;
+        }
+        len += extra;
+    }
+    return (size_t)len;
+}
+
+/* 解析窗口位数参数值（可带引号），非法返回 -1 */
+static int ws_deflate_parse_bits(const char* value, size_t len) {
+    if (len >= 2 && value[0] == '"' && value[len - 1] == '"') {
+        value++;
+        len -= 2;
+    }
+    if (len == 0 || len > 2) {
+        return -1;
+    }
+    int bits = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (!isdigit((unsigned char)value[i])) {
+            return -1;
+        }
+        bits = bits * 10 + (value[i] - '0');
+    }
+    return bits >= 8 && bits <= LINX_WS_DEFLATE_WINDOW_BITS_MAX ? bits : -1;
+}
+
+static bool ws_deflate_token_is(const char* token, size_t len, const char* name) {
+    return strlen(name) == len && strncasecmp(token, name, len) == 0;
+}
+
+/* 在 Sec-WebSocket-Extensions 中找到 permessage-deflate 并解析参数；服务端未接受或参数非法返回 false */
+static bool ws_deflate_parse_response(linx_ws_deflate_t* deflate, int offered_bits,
+                                      const char* extensions, size_t len) {
+    const char* end = extensions + len;
+    const char* p = extensions;
+
+    while (p < end) {
+        const char* ext_end = memchr(p, ',', (size_t)(end - p));
+        if (!ext_end) {
+            ext_end = end;
+        }
+
+        bool matched = false;
+        bool valid = true;
+        const char* q = p;
+        while (q < ext_end) {
+            const char* param_end = memchr(q, ';', (size_t)(ext_end - q));
+            if (!param_end) {
+                param_end = ext_end;
+            }
+            while (q < param_end && isspace((unsigned char)*q)) {
+                q++;
+            }
+            const char* token_end = param_end;
+            while (token_end > q && isspace((unsigned char)token_end[-1])) {
+                token_end--;
+            }
+            const char* eq = memchr(q, '=', (size_t)(token_end - q));
+            size_t name_len = (size_t)((eq ? eq : token_end) - q);
+            while (name_len > 0 && isspace((unsigned char)q[name_len - 1])) {
+                name_len--;
+            }
+            const char* value = NULL;
+            size_t value_len = 0;
+            if (eq) {
+                value = eq + 1;
+                while (value < token_end && isspace((unsigned char)*value)) {
+                    value++;
+                }
+                value_len = (size_t)(token_end - value);
+            }
+
+            if (q == p) {
+                /* 第一个记号是扩展名 */
+                matched = ws_deflate_token_is(q, name_len, "permessage-deflate");
+                if (!matched) {
+                    break;
+                }
+            } else if (ws_deflate_token_is(q, name_len, "server_no_context_takeover") && !value) {
+                deflate->server_context_takeover = false;
+            } else if (ws_deflate_token_is(q, name_len, "client_no_context_takeover") && !value) {
+                /* 本端本来就不保留上下文 */
+            } else if (ws_deflate_token_is(q, name_len, "server_max_window_bits")) {
+                int bits = value ? ws_deflate_parse_bits(value, value_len) : -1;
+                if (bits < 0 || bits > offered_bits) {
+                    valid = false;
+                } else {
+                    deflate->server_window_bits = bits;
+                }
+            } else if (ws_deflate_token_is(q, name_len, "client_max_window_bits")) {
+                int bits = value ? ws_deflate_parse_bits(value, value_len) : -1;
+                if (bits < 0) {
+                    valid = false;
+                } else if (bits < deflate->client_window_bits) {
+                    deflate->client_window_bits = bits;
+                }
+            } else {
+                valid = false;
+            }
+            q = param_end + 1;
+        }
+
+        if (matched) {
+            if (!valid) {
+                LOG_WARN("WebSocket deflate: invalid server response \"%.*s\"", (int)len, extensions);
+            }
+            return valid;
+        }
+        p = ext_end + 1;
+    }
+    return false;
+}
+
+linx_ws_deflate_t* linx_ws_deflate_accept(const linx_ws_deflate_config_t* config,
+                                          const char* extensions, size_t extensions_len,
+                                          const char* dictionary, size_t dictionary_len) {
+    if (!config || !extensions || extensions_len == 0) {
+        return NULL;
+    }
+
+    linx_ws_deflate_t* deflate = LINX_CALLOC(1, sizeof(linx_ws_deflate_t));
+    if (!deflate) {
+        LOG_ERROR("WebSocket deflate: out of memory");
+        return NULL;
+    }
+    int bits = ws_deflate_window_bits(config);
+    deflate->client_window_bits = bits;
+    deflate->server_window_bits = bits;
+    deflate->server_context_takeover = true;
+    deflate->min_size = config->min_size > 0 ? config->min_size : LINX_WS_DEFLATE_MIN_SIZE_DEFAULT;
+
+    if (!ws_deflate_parse_response(deflate, bits, extensions, extensions_len)) {
+        LINX_FREE(deflate);
+        return NULL;
+    }
+
+    char version[8];
+    snprintf(version, sizeof(version), "%d", LINX_WS_DEFLATE_DICTIONARY_VERSION);
+    deflate->dictionary = config->dictionary && dictionary && dictionary_len == strlen(version) &&
+                          memcmp(dictionary, version, dictionary_len) == 0;
+
+    /* 解压历史：服务端保留上下文时为一个窗口，否则只放字典末尾 */
+    size_t window = (size_t)1 << deflate->server_window_bits;
+    size_t dict_len = sizeof(s_dictionary) - 1;
+    deflate->history_capacity = deflate->server_context_takeover ? window :
+                                deflate->dictionary ? (dict_len < window ? dict_len : window) : 0;
+    if (deflate->history_capacity > 0) {
+        deflate->history = LINX_MALLOC(deflate->history_capacity);
+        if (!deflate->history) {
+            LOG_ERROR("WebSocket deflate: out of memory");
+            LINX_FREE(deflate);
+            return NULL;
+        }
+    }
+    if (deflate->dictionary) {
+        size_t tail = dict_len < window ? dict_len : window;
+        memcpy(deflate->history, s_dictionary + dict_len - tail, tail);
+        deflate->history_len = tail;
+    }
+
+    deflate->stats.client_window_bits = deflate->client_window_bits;
+    deflate->stats.server_window_bits = deflate->server_window_bits;
+    deflate->stats.dictionary = deflate->dictionary;
+    deflate->stats.server_context_takeover = deflate->server_context_takeover;
+    LOG_INFO("WebSocket deflate negotiated: client window %d bits, server window %d bits%s%s",
+             deflate->client_window_bits, deflate->server_window_bits,
+             deflate->server_context_takeover ? ", server context takeover" : "",
+             deflate->dictionary ? ", preset dictionary" : "");
+    return deflate;
+}
+
+void linx_ws_deflate_destroy(linx_ws_deflate_t* deflate) {
+    if (!deflate) {
+        return;
+    }
+    LINX_FREE(deflate->work);
+    LINX_FREE(deflate->out);
+    LINX_FREE(deflate->inflated);
+    LINX_FREE(deflate->history);
+    LINX_FREE(deflate);
+}
+
+void linx_ws_deflate_get_stats(const linx_ws_deflate_t* deflate, linx_ws_deflate_stats_t* stats) {
+    if (!stats) {
+        return;
+    }
+    if (!deflate) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+    *stats = deflate->stats;
+}
+
+const uint8_t* linx_ws_deflate_dictionary(size_t* size) {
+    if (size) {
+        *size = sizeof(s_dictionary) - 1;
+    }
+    return (const uint8_t*)s_dictionary;
+}
+
+static bool ws_deflate_reserve(uint8_t** buffer, size_t* capacity, size_t needed) {
+    if (*capacity >= needed) {
+        return true;
+    }
+    size_t new_capacity = *capacity ? *capacity : 1024;
+    while (new_capacity < needed) {
+        new_capacity *= 2;
+    }
+    uint8_t* grown = LINX_REALLOC(*buffer, new_capacity);
+    if (!grown) {
+        return false;
+    }
+    *buffer = grown;
+    *capacity = new_capacity;
+    return true;
+}
+
+/* ==================== 压缩（LZ77 + 固定 Huffman） ==================== */
+
+typedef struct {
+    uint8_t* out;
+    size_t pos;
+    uint32_t bits;
+    int count;
+} ws_bit_writer_t;
+
+/* 按 DEFLATE 的位序（低位先出）写入 n 位 */
+static void ws_put_bits(ws_bit_writer_t* w, uint32_t value, int n) {
+    w->bits |= value << w->count;
+    w->count += n;
+    while (w->count >= 8) {
+        w->out[w->pos++] = (uint8_t)w->bits;
+        w->bits >>= 8;
+        w->count -= 8;
+    }
+}
+
+/* Huffman 码字高位先出，写入前需要翻转 */
+static void ws_put_code(ws_bit_writer_t* w, uint32_t code, int n) {
+    uint32_t reversed = 0;
+    for (int i = 0; i < n; i++) {
+        reversed = (reversed << 1) | ((code >> i) & 1);
+    }
+    ws_put_bits(w, reversed, n);
+}
+
+static void ws_put_litlen(ws_bit_writer_t* w, int symbol) {
+    if (symbol < 144) {
+        ws_put_code(w, 0x30u + (uint32_t)symbol, 8);
+    } else if (symbol < 256) {
+        ws_put_code(w, 0x190u + (uint32_t)(symbol - 144), 9);
+    } else if (symbol < 280) {
+        ws_put_code(w, (uint32_t)(symbol - 256), 7);
+    } else {
+        ws_put_code(w, 0xC0u + (uint32_t)(symbol - 280), 8);
+    }
+}
+
+static void ws_put_match(ws_bit_writer_t* w, size_t length, size_t distance) {
+    int l = 28;
+    while (s_length_base[l] > length) {
+        l--;
+    }
+    ws_put_litlen(w, 257 + l);
+    ws_put_bits(w, (uint32_t)(length - s_length_base[l]), s_length_extra[l]);
+
+    int d = 29;
+    while (s_dist_base[d] > distance) {
+        d--;
+    }
+    ws_put_code(w, (uint32_t)d, 5);
+    ws_put_bits(w, (uint32_t)(distance - s_dist_base[d]), s_dist_extra[d]);
+}
+
+static uint32_t ws_hash3(const uint8_t* p) {
+    uint32_t v = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16);
+    return (v * 2654435761u) >> (32 - LINX_WS_DEFLATE_HASH_BITS);
+}
+
+bool linx_ws_deflate_compress(linx_ws_deflate_t* deflate, const void* data, size_t size,
+                              const uint8_t** out, size_t* out_size) {
+    if (!deflate || !data || !out || !out_size) {
+        return false;
+    }
+    if (size < deflate->min_size || size > LINX_WS_DEFLATE_MAX_MESSAGE) {
+        deflate->stats.plain_messages++;
+        return false;
+    }
+
+    size_t window = (size_t)1 << deflate->client_window_bits;
+    size_t dict_len = sizeof(s_dictionary) - 1;
+    size_t base = deflate->dictionary ? (dict_len < window ? dict_len : window) : 0;
+    size_t n = base + size;
+    /* 固定 Huffman 字面量最长 9 位，另加块头和结尾 */
+    size_t bound = size + size / 8 + 16;
+    if (!ws_deflate_reserve(&deflate->work, &deflate->work_capacity, n) ||
+        !ws_deflate_reserve(&deflate->out, &deflate->out_capacity, bound)) {
+        LOG_WARN("WebSocket deflate: out of memory, sending uncompressed");
+        deflate->stats.plain_messages++;
+        return false;
+    }
+    memcpy(deflate->work, s_dictionary + dict_len - base, base);
+    memcpy(deflate->work + base, data, size);
+
+    const uint8_t* src = deflate->work;
+    uint16_t* table = deflate->hash;
+    memset(table, 0, sizeof(deflate->hash));
+    for (size_t i = 0; i + DEFLATE_MIN_MATCH <= base; i++) {
+        table[ws_hash3(src + i)] = (uint16_t)i;
+    }
+
+    ws_bit_writer_t w = { deflate->out, 0, 0, 0 };
+    ws_put_bits(&w, 0, 1);          // BFINAL=0：后面跟一个空的存储块
+    ws_put_bits(&w, 1, 2);          // BTYPE=01 固定 Huffman
+
+    size_t ip = base;
+    while (ip < n) {
+        if (ip + DEFLATE_MIN_MATCH <= n) {
+            uint32_t hash = ws_hash3(src + ip);
+            size_t ref = table[hash];
+            table[hash] = (uint16_t)ip;
+
+            /* 表项初始为0，必须校验内容才能当作匹配 */
+            if (ref < ip && ip - ref <= window && memcmp(src + ref, src + ip, DEFLATE_MIN_MATCH) == 0) {
+                size_t max_len = n - ip < DEFLATE_MAX_MATCH ? n - ip : DEFLATE_MAX_MATCH;
+                size_t len = DEFLATE_MIN_MATCH;
+                while (len < max_len && src[ref + len] == src[ip + len]) {
+                    len++;
+                }
+                ws_put_match(&w, len, ip - ref);
+                for (size_t j = ip + 1; j < ip + len && j + DEFLATE_MIN_MATCH <= n; j++) {
+                    table[ws_hash3(src + j)] = (uint16_t)j;
+                }
+                ip += len;
+                continue;
+            }
+        }
+        ws_put_litlen(&w, src[ip]);
+        ip++;
+    }
+    ws_put_litlen(&w, 256);         // 块结束
+
+    /* 空存储块的块头后对齐到字节；其 LEN/NLEN（00 00 FF FF）按 RFC 7692 省略 */
+    ws_put_bits(&w, 0, 3);
+    if (w.count > 0) {
+        ws_put_bits(&w, 0, 8 - w.count);
+    }
+
+    if (w.pos >= size) {
+        deflate->stats.plain_messages++;
+        return false;
+    }
+    deflate->stats.compressed_messages++;
+    deflate->stats.tx_plain_bytes += size;
+    deflate->stats.tx_wire_bytes += w.pos;
+    *out = deflate->out;
+    *out_size = w.pos;
+    return true;
+}
+
+/* ==================== 解压 ==================== */
+
+/* RFC 7692：接收端在消息末尾补回 00 00 FF FF 再解压 */
+static const uint8_t s_flush_tail[4] = { 0x00, 0x00, 0xFF, 0xFF };
+
+typedef struct {
+    linx_ws_deflate_t* deflate;
+    const uint8_t* in;
+    size_t in_len;                  // 不含补回的尾部
+    size_t pos;                     // 含尾部的读取位置
+    uint32_t bits;
+    int count;
+    size_t out_len;                 // deflate->inflated 中已写入的字节数（含历史）
+    size_t out_limit;
+    bool error;
+} ws_inflate_t;
+
+static int ws_get_byte(ws_inflate_t* s) {
+    if (s->pos < s->in_len) {
+        return s->in[s->pos++];
+    }
+    if (s->pos < s->in_len + sizeof(s_flush_tail)) {
+        return s_flush_tail[s->pos++ - s->in_len];
+    }
+    return -1;
+}
+
+static bool ws_input_done(const ws_inflate_t* s) {
+    return s->pos >= s->in_len + sizeof(s_flush_tail);
+}
+
+static uint32_t ws_get_bits(ws_inflate_t* s, int n) {
+    while (s->count < n) {
+        int byte = ws_get_byte(s);
+        if (byte < 0) {
+            s->error = true;
+            return 0;
+        }
+        s->bits |= (uint32_t)byte << s->count;
+        s->count += 8;
+    }
+    uint32_t value = s->bits & (((uint32_t)1 << n) - 1);
+    s->bits >>= n;
+    s->count -= n;
+    return value;
+}
+
+static bool ws_put_byte(ws_inflate_t* s, uint8_t byte) {
+    linx_ws_deflate_t* deflate = s->deflate;
+    if (s->out_len >= s->out_limit ||
+        !ws_deflate_reserve(&deflate->inflated, &deflate->inflated_capacity, s->out_len + 1)) {
+        s->error = true;
+        return false;
+    }
+    deflate->inflated[s->out_len++] = byte;
+    return true;
+}
+
+/* 由各符号的码长构造解码表；码长超额时返回 false */
+static bool ws_huffman_build(ws_huffman_t* h, const uint8_t* lengths, int n) {
+    uint16_t offsets[DEFLATE_MAX_BITS + 1];
+    memset(h->count, 0, sizeof(h->count));
+    for (int i = 0; i < n; i++) {
+        h->count[lengths[i]]++;
+    }
+    int left = 1;
+    for (int len = 1; len <= DEFLATE_MAX_BITS; len++) {
+        left = (left << 1) - h->count[len];
+        if (left < 0) {
+            return false;
+        }
+    }
+    offsets[1] = 0;
+    for (int len = 1; len < DEFLATE_MAX_BITS; len++) {
+        offsets[len + 1] = (uint16_t)(offsets[len] + h->count[len]);
+    }
+    for (int i = 0; i < n; i++) {
+        if (lengths[i] != 0) {
+            h->symbol[offsets[lengths[i]]++] = (uint16_t)i;
+        }
+    }
+    return true;
+}
+
+/* 逐位解码一个符号；不完整的码表遇到未分配的码字时返回 -1 */
+static int ws_huffman_decode(ws_inflate_t* s, const ws_huffman_t* h) {
+    int code = 0;
+    int first = 0;
+    int index = 0;
+    for (int len = 1; len <= DEFLATE_MAX_BITS; len++) {
+        code |= (int)ws_get_bits(s, 1);
+        if (s->error) {
+            return -1;
+        }
+        int count = h->count[len];
+        if (code - count < first) {
+            return h->symbol[index + (code - first)];
+        }
+        index += count;
+        first = (first + count) << 1;
+        code <<= 1;
+    }
+    return -1;
+}
+
+static bool ws_inflate_stored(ws_inflate_t* s) {
+    /* 丢弃到字节边界 */
+    s->bits = 0;
+    s->count = 0;
+    int b0 = ws_get_byte(s);
+    int b1 = ws_get_byte(s);
+    int b2 = ws_get_byte(s);
+    int b3 = ws_get_byte(s);
+    if (b3 < 0) {
+        return false;
+    }
+    unsigned len = (unsigned)b0 | ((unsigned)b1 << 8);
+    unsigned nlen = (unsigned)b2 | ((unsigned)b3 << 8);
+    if (len != (~nlen & 0xFFFFu)) {
+        return false;
+    }
+    while (len-- > 0) {
+        int byte = ws_get_byte(s);
+        if (byte < 0 || !ws_put_byte(s, (uint8_t)byte)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool ws_inflate_codes(ws_inflate_t* s, const ws_huffman_t* litlen, const ws_huffman_t* dist) {
+    for (;;) {
+        int symbol = ws_huffman_decode(s, litlen);
+        if (symbol < 0) {
+            return false;
+        }
+        if (symbol < 256) {
+            if (!ws_put_byte(s, (uint8_t)symbol)) {
+                return false;
+            }
+            continue;
+        }
+        if (symbol == 256) {
+            return true;
+        }
+
+        symbol -= 257;
+        if (symbol >= 29) {
+            return false;
+        }
+        size_t length = s_length_base[symbol] + ws_get_bits(s, s_length_extra[symbol]);
+        int dsym = ws_huffman_decode(s, dist);
+        if (dsym < 0 || dsym >= DEFLATE_MAX_DIST) {
+            return false;
+        }
+        size_t distance = s_dist_base[dsym] + ws_get_bits(s, s_dist_extra[dsym]);
+        if (s->error || distance > s->out_len) {
+            return false;
+        }
+        /* 逐字节复制，允许与输出重叠 */
+        while (length-- > 0) {
+            if (!ws_put_byte(s, s->deflate->inflated[s->out_len - distance])) {
+                return false;
+            }
+        }
+    }
+}
+
+static bool ws_inflate_fixed(ws_inflate_t* s) {
+    linx_ws_deflate_t* deflate = s->deflate;
+    uint8_t lengths[DEFLATE_MAX_LITLEN];
+    int i = 0;
+    for (; i < 144; i++) lengths[i] = 8;
+    for (; i < 256; i++) lengths[i] = 9;
+    for (; i < 280; i++) lengths[i] = 7;
+    for (; i < DEFLATE_MAX_LITLEN; i++) lengths[i] = 8;
+    ws_huffman_build(&deflate->litlen, lengths, DEFLATE_MAX_LITLEN);
+    memset(lengths, 5, DEFLATE_MAX_DIST);
+    ws_huffman_build(&deflate->dist, lengths, DEFLATE_MAX_DIST);
+    return ws_inflate_codes(s, &deflate->litlen, &deflate->dist);
+}
+
+static bool ws_inflate_dynamic(ws_inflate_t* s) {
+    linx_ws_deflate_t* deflate = s->deflate;
+    uint8_t lengths[DEFLATE_MAX_LITLEN + DEFLATE_MAX_DIST + 2];
+
+    int nlen = (int)ws_get_bits(s, 5) + 257;
+    int ndist = (int)ws_get_bits(s, 5) + 1;
+    int ncode = (int)ws_get_bits(s, 4) + 4;
+    if (s->error || nlen > 286 || ndist > DEFLATE_MAX_DIST) {
+        return false;
+    }
+
+    memset(lengths, 0, 19);
+    for (int i = 0; i < ncode; i++) {
+        lengths[s_code_length_order[i]] = (uint8_t)ws_get_bits(s, 3);
+    }
+    if (s->error || !ws_huffman_build(&deflate->codelen, lengths, 19)) {
+        return false;
+    }
+
+    int index = 0;
+    while (index < nlen + ndist) {
+        int symbol = ws_huffman_decode(s, &deflate->codelen);
+        if (symbol < 0) {
+            return false;
+        }
+        if (symbol < 16) {
+            lengths[index++] = (uint8_t)symbol;
+            continue;
+        }
+        uint8_t value = 0;
+        int repeat;
+        if (symbol == 16) {
+            if (index == 0) {
+                return false;
+            }
+            value = lengths[index - 1];
+            repeat = 3 + (int)ws_get_bits(s, 2);
+        } else if (symbol == 17) {
+            repeat = 3 + (int)ws_get_bits(s, 3);
+        } else {
+            repeat = 11 + (int)ws_get_bits(s, 7);
+        }
+        if (s->error || index + repeat > nlen + ndist) {
+            return false;
+        }
+        while (repeat-- > 0) {
+            lengths[index++] = value;
+        }
+    }
+    if (lengths[256] == 0) {
+        return false;
+    }
+
+    if (!ws_huffman_build(&deflate->litlen, lengths, nlen) ||
+        !ws_huffman_build(&deflate->dist, lengths + nlen, ndist)) {
+        return false;
+    }
+    return ws_inflate_codes(s, &deflate->litlen, &deflate->dist);
+}
+
+bool linx_ws_deflate_decompress(linx_ws_deflate_t* deflate, const void* data, size_t size,
+                                const uint8_t** out, size_t* out_size) {
+    if (!deflate || (!data && size > 0) || !out || !out_size) {
+        return false;
+    }
+
+    /* 历史放在输出前面，回溯距离可以落进历史 */
+    size_t prefix = deflate->history_len;
+    if (!ws_deflate_reserve(&deflate->inflated, &deflate->inflated_capacity, prefix + size * 4 + 64)) {
+        deflate->stats.inflate_errors++;
+        return false;
+    }
+    if (prefix > 0) {
+        memcpy(deflate->inflated, deflate->history, prefix);
+    }
+
+    ws_inflate_t s = {
+        .deflate = deflate,
+        .in = (const uint8_t*)data,
+        .in_len = size,
+        .out_len = prefix,
+        .out_limit = prefix + LINX_WS_DEFLATE_MAX_MESSAGE,
+    };
+
+    bool ok = true;
+    for (;;) {
+        uint32_t last = ws_get_bits(&s, 1);
+        uint32_t type = ws_get_bits(&s, 2);
+        if (s.error) {
+            ok = false;
+            break;
+        }
+        if (type == 0) {
+            ok = ws_inflate_stored(&s);
+        } else if (type == 1) {
+            ok = ws_inflate_fixed(&s);
+        } else if (type == 2) {
+            ok = ws_inflate_dynamic(&s);
+        } else {
+            ok = false;
+        }
+        if (!ok || s.error || last || ws_input_done(&s)) {
+            break;
+        }
+    }
+    if (!ok || s.error) {
+        deflate->stats.inflate_errors++;
+        LOG_WARN("WebSocket deflate: corrupt or oversized message (%zu bytes)", size);
+        return false;
+    }
+
+    size_t produced = s.out_len - prefix;
+    if (deflate->server_context_takeover) {
+        size_t keep = s.out_len < deflate->history_capacity ? s.out_len : deflate->history_capacity;
+        memcpy(deflate->history, deflate->inflated + s.out_len - keep, keep);
+        deflate->history_len = keep;
+    }
+
+    deflate->stats.inflated_messages++;
+    deflate->stats.rx_wire_bytes += size;
+    deflate->stats.rx_plain_bytes += produced;
+    *out = deflate->inflated + prefix;
+    *out_size = produced;
+    return true;
+}
@@ -0,0 +1,141 @@
+#ifndef LINX_WS_DEFLATE_H
+#define LINX_WS_DEFLATE_H
+
+/*
+ * WebSocket 文本消息压缩（permessage-deflate，RFC 7692）
+ *
+ * hello、listen、stt/llm/tts、MCP tools/list 等控制消息是键名高度重复的 JSON，
+ * tools/list 的响应每次建立会话都有数 KB。协商成功后只压缩发出的文本消息；
+ * 音频帧从不压缩（Opus 已是熵编码，压缩只会白费 CPU）。服务端压缩过的任意
+ * 消息（RSV1 置位）都会先解压再交给协议解析。
+ *
+ * 面向 MCU 的取舍：
+ * - 客户端不保留压缩上下文（client_no_context_takeover），每条消息独立压缩，
+ *   压缩器只有一张 2^LINX_WS_DEFLATE_HASH_BITS 项的哈希表，编码使用固定 Huffman 表；
+ * - 请求服务端也不保留上下文（server_no_context_takeover）；服务端坚持保留时，
+ *   解压器保存上一条消息末尾 2^server_max_window_bits 字节作为历史
+ * - 滑动窗口 LINX_WS_DEFLATE_WINDOW_BITS_MIN..15 位，由配置限定双方的回溯距离；
+ * - 解压后超过 LINX_WS_DEFLATE_MAX_MESSAGE 的消息视为异常并丢弃
+ *
+ * 预置字典（可选）：RFC 7692 没有字典，另用请求头 "Linx-Deflate-Dictionary: <版本>"
+ * 协商，服务端在 101 响应中回应相同版本号才启用。启用后每条消息压缩和解压前都以
+ * linx_ws_deflate_dictionary() 的内容作为历史数据（zlib 中对应原始 deflate 流上的
+ * deflateSetDictionary()/inflateSetDictionary()，只取字典末尾一个窗口大小）。
+ * 字典内容随版本号固定，修改内容必须升级 LINX_WS_DEFLATE_DICTIONARY_VERSION。
+ *
+ * 会话录制（linx_ws_capture.h）保存的是压缩前/解压后的消息，回放不涉及压缩。
+ *
+ * 非线程安全：一个连接一个实例，只在事件循环线程上使用。
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 窗口位数范围与默认值 */
+#define LINX_WS_DEFLATE_WINDOW_BITS_MIN     9
+#define LINX_WS_DEFLATE_WINDOW_BITS_MAX     15
+#define LINX_WS_DEFLATE_WINDOW_BITS_DEFAULT 11
+
+/* 压缩器哈希表位数（每项 2 字节） */
+#define LINX_WS_DEFLATE_HASH_BITS 10
+
+/* 默认不压缩的短消息长度（字节） */
+#define LINX_WS_DEFLATE_MIN_SIZE_DEFAULT 64
+
+/* 解压后单条消息的上限（字节），也是能压缩的最大消息 */
+#define LINX_WS_DEFLATE_MAX_MESSAGE (60u * 1024u)
+
+/* 预置字典版本号 */
+#define LINX_WS_DEFLATE_DICTIONARY_VERSION 1
+
+/* 压缩配置 */
+typedef struct {
+    int window_bits;                // 双方的窗口位数，<=0 为默认值
+    bool dictionary;                // 是否请求预置字典
+    size_t min_size;                // 短于此长度的消息不压缩，0 为默认值
+} linx_ws_deflate_config_t;
+
+/* 统计 */
+typedef struct {
+    int client_window_bits;         // 协商后本端压缩的窗口位数
+    int server_window_bits;         // 协商后服务端压缩的窗口位数
+    bool dictionary;                // 是否启用了预置字典
+    bool server_context_takeover;   // 服务端是否跨消息保留上下文
+    uint64_t compressed_messages;   // 压缩发出的消息数
+    uint64_t plain_messages;        // 太短或压缩无收益而原样发出的文本消息数
+    uint64_t tx_plain_bytes;        // 压缩前的字节数
+    uint64_t tx_wire_bytes;         // 压缩后的字节数
+    uint64_t inflated_messages;     // 解压的消息数
+    uint64_t rx_wire_bytes;         // 解压前的字节数
+    uint64_t rx_plain_bytes;        // 解压后的字节数
+    uint64_t inflate_errors;        // 解压失败的消息数
+} linx_ws_deflate_stats_t;
+
+typedef struct linx_ws_deflate linx_ws_deflate_t;
+
+/**
+ * 生成升级请求中的协商头（每行以 "\r\n" 结尾）
+ * @param config 压缩配置
+ * @param buffer 输出缓冲区
+ * @param size 缓冲区大小，不够时返回 0
+ * @return 写入的长度（不含结尾 '\0'）
+ */
+size_t linx_ws_deflate_offer(const linx_ws_deflate_config_t* config, char* buffer, size_t size);
+
+/**
+ * 按服务端 101 响应的协商结果创建实例
+ * @param config 与生成请求头时相同的配置
+ * @param extensions Sec-WebSocket-Extensions 响应头的值，没有时传 NULL
+ * @param extensions_len 长度
+ * @param dictionary Linx-Deflate-Dictionary 响应头的值，没有时传 NULL
+ * @param dictionary_len 长度
+ * @return 实例；服务端未接受、回应的参数非法或内存不足时返回 NULL（不压缩）
+ */
+linx_ws_deflate_t* linx_ws_deflate_accept(const linx_ws_deflate_config_t* config,
+                                          const char* extensions, size_t extensions_len,
+                                          const char* dictionary, size_t dictionary_len);
+
+/**
+ * 压缩一条待发送的消息
+ * @param out 输出压缩数据（实例内部缓冲区，下一次调用前有效）
+ * @param out_size 输出长度
+ * @return 返回 true 时按压缩帧（RSV1）发送 out；false 表示原样发送
+ */
+bool linx_ws_deflate_compress(linx_ws_deflate_t* deflate, const void* data, size_t size,
+                              const uint8_t** out, size_t* out_size);
+
+/**
+ * 解压一条 RSV1 置位的消息
+ * @param out 输出解压数据（实例内部缓冲区，下一次调用前有效）
+ * @param out_size 输出长度
+ * @return 数据损坏或超出 LINX_WS_DEFLATE_MAX_MESSAGE 时返回 false
+ */
+bool linx_ws_deflate_decompress(linx_ws_deflate_t* deflate, const void* data, size_t size,
+                                const uint8_t** out, size_t* out_size);
+
+/**
+ * 获取统计
+ */
+void linx_ws_deflate_get_stats(const linx_ws_deflate_t* deflate, linx_ws_deflate_stats_t* stats);
+
+/**
+ * 释放实例；deflate 为 NULL 时无操作
+ */
+void linx_ws_deflate_destroy(linx_ws_deflate_t* deflate);
+
+/**
+ * 预置字典内容（LINX_WS_DEFLATE_DICTIONARY_VERSION 版），服务端实现需使用完全相同的字节
+ * @param size 输出字典长度
+ */
+const uint8_t* linx_ws_deflate_dictionary(size_t* size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINX_WS_DEFLATE_H */
@@ -0,0 +1,798 @@
+/**
+ * @file bench_loopback.c
+ * @brief 本机回环端到端时延基准
+ *
+ * 进程内启动一个 mongoose 模拟服务端（hello/listen/tts，支持协议 v1/v2/v3/v4），把每路上行
+ * Opus 帧原样作为 TTS 音频回送。每路客户端使用无声卡的 audio_stub：采集端按实时节奏
+ * 周期性注入短促的正弦音，播放端检测音头并记录"嘴到耳"时延，即一个音从被采集到
+ * 经编码、上行、服务端、下行、抖动缓冲、解码后写入音频设备的时间。
+ *
+ * 所有会话共享一个 linx_reactor。每个协议版本运行一轮，输出时延的 p50/p90/p99/max、
+ * 丢失的音和每路 CPU 占用；指定 -t 时 p99 超过阈值或没有收到任何音则以非零状态退出，
+ * 供 CI 发现时延回归。指定 -z 时打开 zero_alloc_assert，会话建立后音频热路径上的
+ * 每次堆分配都记为违规并输出位置，有违规时以非零状态退出。指定 -c 时把每轮第一路会话
+ * 录制为 <前缀>_v<协议版本>.lxws，可用 replay_session 离线回放。
+ *
+ * 指定 -b 时打开堆跟踪和线程统计（见 linx_budget.h），每轮在稳态下记录堆峰值、各线程
+ * 栈高水位和各流水线阶段 CPU，写入 JSON 文件，由 budget_report.py 与 map 文件中的静态
+ * RAM/Flash 合并成预算表。-C 读取 build/configs 下的板级配置：CONFIG_ENABLE_OPUS=n 时
+ * 改用 ADPCM，路数不超过 CONFIG_MAX_CONNECTIONS，全部配置项随报告输出。
+ *
+ * 用法: bench_loopback [-s 路数] [-d 每轮秒数] [-v 1,2,3,4] [-p 端口] [-t p99阈值毫秒] [-z] [-c 录制前缀]
+ *                      [-b 预算报告.json] [-C 板级配置]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <time.h>
+#include <arpa/inet.h>
+#include <sys/resource.h>
+#include "mongoose.h"
+#include "cJSON.h"
+#include "linx_log.h"
+#include "linx_alloc.h"
+#include "linx_thread_stats.h"
+#include "linx_sdk.h"
+#include "linx_budget.h"
+#include "linx_reactor.h"
+#include "audio/audio_stub.h"
+#include "codecs/codec_factory.h"
+#include "play/linx_player.h"
+
+#define BENCH_SAMPLE_RATE      16000
+#define BENCH_CHANNELS         1
+#define BENCH_FRAME_MS         20
+#define BENCH_FRAME_SAMPLES    (BENCH_SAMPLE_RATE * BENCH_FRAME_MS / 1000)
+#define BENCH_MAX_STREAMS      64
+#define BENCH_MAX_VERSIONS     4
+#define BENCH_MAX_PACKET       1500
+#define BENCH_MAX_REPORTED_VIOLATIONS 8
+#define BENCH_MAX_CONFIG_ITEMS 64
+
+// -z: 会话建立后检查音频热路径上的堆分配
+static bool s_zero_alloc_assert = false;
+
+// -c: 每轮第一路会话的录制文件前缀
+static const char* s_capture_prefix = NULL;
+
+// -b: 预算报告输出文件
+static const char* s_budget_path = NULL;
+
+// 上下行音频格式，-C 配置关闭 Opus 时为 ADPCM
+static const char* s_audio_format = "opus";
+
+// -C: 板级配置项（KEY=VALUE，值已去掉引号）
+typedef struct {
+    char key[48];
+    char value[80];
+} bench_config_item_t;
+
+static char s_config_name[64];
+static bench_config_item_t s_config_items[BENCH_MAX_CONFIG_ITEMS];
+static int s_config_count = 0;
+
+/**
+ * @brief 零分配区陷阱：计数并输出前几次违规的位置，不中止进程
+ */
+static void bench_alloc_trap(const linx_alloc_site_t* site, size_t size, void* user_data) {
+    (void)user_data;
+    if (linx_alloc_get_violations() <= BENCH_MAX_REPORTED_VIOLATIONS) {
+        fprintf(stderr, "热路径堆分配: %zu 字节, %s:%d (%s)\n", size, site->file, site->line,
+                linx_alloc_module_name(site->module));
+    }
+}
+
+// ==================== 模拟服务端 ====================
+
+/**
+ * @brief 每个服务端连接的状态，保存在 mg_connection::data 中
+ */
+typedef struct {
+    uint8_t version;            // 客户端 Protocol-Version，缺省为 1
+    bool tts_started;           // 已发送 tts start
+    uint32_t timestamp;         // v2/v4 下行帧时间戳（毫秒）
+    uint16_t sequence;          // v4 下行帧序号
+    uint16_t uplink_sequence;   // v4 期望的下一个上行帧序号
+    bool uplink_started;        // 已收到第一个 v4 上行帧
+    uint32_t bad_frames;        // 帧头与协议版本不符的上行帧
+    uint32_t sequence_gaps;     // v4 上行帧序号不连续的次数
+} mock_conn_t;
+
+typedef struct {
+    struct mg_mgr mgr;
+    pthread_t thread;
+    volatile bool running;
+    uint32_t bad_frames;        // 所有连接的非法上行帧（服务端线程内累加）
+    uint32_t sequence_gaps;     // 所有连接的 v4 上行序号跳变（发送队列满丢帧时会出现）
+} mock_server_t;
+
+static mock_conn_t* mock_conn(struct mg_connection* c) {
+    return (mock_conn_t*)c->data;
+}
+
+static void mock_send_json(struct mg_connection* c, cJSON* json) {
+    char* text = cJSON_PrintUnformatted(json);
+    if (text) {
+        mg_ws_send(c, text, strlen(text), WEBSOCKET_OP_TEXT);
+        cJSON_free(text);
+    }
+}
+
+static void mock_reply_hello(struct mg_connection* c) {
+    char session_id[32];
+    snprintf(session_id, sizeof(session_id), "bench-%lu", c->id);
+
+    cJSON* hello = cJSON_CreateObject();
+    cJSON_AddStringToObject(hello, "type", "hello");
+    cJSON_AddNumberToObject(hello, "version", mock_conn(c)->version);
+    cJSON_AddStringToObject(hello, "transport", "websocket");
+    cJSON_AddStringToObject(hello, "session_id", session_id);
+    cJSON* params = cJSON_AddObjectToObject(hello, "audio_params");
+    cJSON_AddStringToObject(params, "format", s_audio_format);
+    cJSON_AddNumberToObject(params, "sample_rate", BENCH_SAMPLE_RATE);
+    cJSON_AddNumberToObject(params, "channels", BENCH_CHANNELS);
+    cJSON_AddNumberToObject(params, "frame_duration", BENCH_FRAME_MS);
+    mock_send_json(c, hello);
+    cJSON_Delete(hello);
+}
+
+static void mock_send_tts_start(struct mg_connection* c) {
+    char session_id[32];
+    snprintf(session_id, sizeof(session_id), "bench-%lu", c->id);
+
+    cJSON* tts = cJSON_CreateObject();
+    cJSON_AddStringToObject(tts, "type", "tts");
+    cJSON_AddStringToObject(tts, "state", "start");
+    cJSON_AddStringToObject(tts, "session_id", session_id);
+    mock_send_json(c, tts);
+    cJSON_Delete(tts);
+}
+
+/**
+ * @brief 校验上行帧头并原样回送；v2/v4 改写时间戳为连续的下行时间，v4 同时改写序号
+ */
+static void mock_echo_audio(mock_server_t* server, struct mg_connection* c, const uint8_t* data, size_t size) {
+    mock_conn_t* conn = mock_conn(c);
+    uint8_t frame[BENCH_MAX_PACKET + sizeof(linx_binary_protocol2_t)];
+    if (size > sizeof(frame)) {
+        conn->bad_frames++;
+        server->bad_frames++;
+        return;
+    }
+    memcpy(frame, data, size);
+
+    bool valid = size > 0;
+    if (conn->version == 2) {
+        linx_binary_protocol2_t* header = (linx_binary_protocol2_t*)frame;
+        valid = size >= sizeof(*header) && ntohs(header->version) == 2 &&
+                ntohl(header->payload_size) == size - sizeof(*header);
+        if (valid) {
+            header->timestamp = htonl(conn->timestamp);
+            conn->timestamp += BENCH_FRAME_MS;
+        }
+    } else if (conn->version == 3) {
+        const linx_binary_protocol3_t* header = (const linx_binary_protocol3_t*)frame;
+        valid = size >= sizeof(*header) && ntohs(header->payload_size) == size - sizeof(*header);
+    } else if (conn->version == 4) {
+        linx_binary_protocol4_t* header = (linx_binary_protocol4_t*)frame;
+        valid = size >= sizeof(*header) && ntohs(header->payload_size) == size - sizeof(*header);
+        if (valid) {
+            uint16_t sequence = ntohs(header->sequence);
+            if (conn->uplink_started && sequence != conn->uplink_sequence) {
+                conn->sequence_gaps++;
+                server->sequence_gaps++;
+            }
+            conn->uplink_sequence = (uint16_t)(sequence + 1);
+            conn->uplink_started = true;
+            header->sequence = htons(conn->sequence++);
+            header->timestamp = htonl(conn->timestamp);
+            conn->timestamp += BENCH_FRAME_MS;
+        }
+    }
+    if (!valid) {
+        conn->bad_frames++;
+        server->bad_frames++;
+        return;
+    }
+
+    if (!conn->tts_started) {
+        mock_send_tts_start(c);
+        conn->tts_started = true;
+    }
+    mg_ws_send(c, frame, size, WEBSOCKET_OP_BINARY);
+}
+
+static void mock_event_handler(struct mg_connection* c, int ev, void* ev_data) {
+    mock_server_t* server = (mock_server_t*)c->fn_data;
+
+    if (ev == MG_EV_HTTP_MSG) {
+        struct mg_http_message* hm = (struct mg_http_message*)ev_data;
+        mock_conn_t* conn = mock_conn(c);
+        memset(conn, 0, sizeof(*conn));
+        conn->version = 1;
+        struct mg_str* version = mg_http_get_header(hm, "Protocol-Version");
+        if (version && version->len == 1 && version->buf[0] >= '1' && version->buf[0] <= '4') {
+            conn->version = (uint8_t)(version->buf[0] - '0');
+        }
+        mg_ws_upgrade(c, hm, NULL);
+    } else if (ev == MG_EV_WS_MSG) {
+        struct mg_ws_message* wm = (struct mg_ws_message*)ev_data;
+        if ((wm->flags & 0x0F) == WEBSOCKET_OP_BINARY) {
+            mock_echo_audio(server, c, (const uint8_t*)wm->data.buf, wm->data.len);
+            return;
+        }
+
+        cJSON* json = cJSON_ParseWithLength(wm->data.buf, wm->data.len);
+        const cJSON* type = json ? cJSON_GetObjectItemCaseSensitive(json, "type") : NULL;
+        if (cJSON_IsString(type) && strcmp(type->valuestring, "hello") == 0) {
+            mock_reply_hello(c);
+        }
+        // listen/abort 等其他消息无需回复：回环服务端一直在"说话"
+        cJSON_Delete(json);
+    }
+}
+
+static void* mock_server_thread(void* arg) {
+    mock_server_t* server = (mock_server_t*)arg;
+    while (server->running) {
+        mg_mgr_poll(&server->mgr, 5);
+    }
+    return NULL;
+}
+
+static bool mock_server_start(mock_server_t* server, int port) {
+    char url[64];
+    snprintf(url, sizeof(url), "http://127.0.0.1:%d", port);
+
+    memset(server, 0, sizeof(*server));
+    mg_mgr_init(&server->mgr);
+    if (!mg_http_listen(&server->mgr, url, mock_event_handler, server)) {
+        fprintf(stderr, "模拟服务端监听失败: %s\n", url);
+        mg_mgr_free(&server->mgr);
+        return false;
+    }
+
+    server->running = true;
+    if (pthread_create(&server->thread, NULL, mock_server_thread, server) != 0) {
+        mg_mgr_free(&server->mgr);
+        return false;
+    }
+    return true;
+}
+
+static void mock_server_stop(mock_server_t* server) {
+    server->running = false;
+    pthread_join(server->thread, NULL);
+    mg_mgr_free(&server->mgr);
+}
+
+// ==================== 客户端会话 ====================
+
+/**
+ * @brief 一路客户端：桩音频设备、编解码器、播放器、SDK 会话和采集线程
+ */
+typedef struct {
+    AudioInterface* audio;
+    audio_codec_t* encoder;
+    audio_codec_t* decoder;
+    linx_player_t* player;
+    LinxSdk* sdk;
+    pthread_t capture_thread;
+    bool capture_started;
+    uint32_t protocol_version;
+    volatile bool running;
+} bench_stream_t;
+
+static void stream_event_callback(const LinxEvent* event, void* user_data) {
+    bench_stream_t* stream = (bench_stream_t*)user_data;
+    if (event->type != LINX_EVENT_AUDIO_DATA) {
+        return;
+    }
+
+    const linx_audio_stream_packet_t* packet = event->data.audio_data.value;
+    linx_player_feed_packet(stream->player, packet->payload, packet->payload_size,
+                            packet->timestamp, linx_binary_protocol_has_timestamp((int)stream->protocol_version));
+}
+
+static void* stream_capture_thread(void* arg) {
+    bench_stream_t* stream = (bench_stream_t*)arg;
+    short pcm[BENCH_FRAME_SAMPLES * BENCH_CHANNELS];
+    uint8_t packet[BENCH_MAX_PACKET];
+    linx_thread_stats_register("capture", LINX_THREAD_STAGE_CAPTURE);
+
+    // audio_stub 的 read 按实时节奏返回，循环无需额外休眠
+    while (stream->running) {
+        if (audio_interface_read(stream->audio, pcm, BENCH_FRAME_SAMPLES * BENCH_CHANNELS) != 0) {
+            break;
+        }
+        size_t encoded = 0;
+        if (audio_codec_encode(stream->encoder, pcm, BENCH_FRAME_SAMPLES * BENCH_CHANNELS,
+                               packet, sizeof(packet), &encoded) == CODEC_SUCCESS && encoded > 0) {
+            linx_sdk_send_audio(stream->sdk, packet, encoded);
+        }
+    }
+    linx_thread_stats_unregister();
+    return NULL;
+}
+
+static void stream_destroy(bench_stream_t* stream) {
+    stream->running = false;
+    if (stream->capture_started) {
+        pthread_join(stream->capture_thread, NULL);
+        stream->capture_started = false;
+    }
+    if (stream->sdk) {
+        linx_sdk_destroy(stream->sdk);
+    }
+    if (stream->player) {
+        linx_player_stop(stream->player);
+        linx_player_destroy(stream->player);
+    }
+    if (stream->encoder) {
+        audio_codec_destroy(stream->encoder);
+    }
+    if (stream->decoder) {
+        audio_codec_destroy(stream->decoder);
+    }
+    if (stream->audio) {
+        audio_interface_destroy(stream->audio);
+        free(stream->audio);
+    }
+    memset(stream, 0, sizeof(*stream));
+}
+
+static bool stream_create(bench_stream_t* stream, linx_reactor_t* reactor, int port, uint32_t version, int index) {
+    memset(stream, 0, sizeof(*stream));
+    stream->protocol_version = version;
+
+    // 各路错开注入时间，避免所有音头落在同一轮询周期
+    audio_stub_tone_config_t tone = {
+        .interval_ms = 1000,
+        .duration_ms = 100,
+        .frequency_hz = 1000 + (unsigned int)(index % 8) * 125,
+    };
+    stream->audio = audio_stub_create();
+    if (!stream->audio || audio_interface_init(stream->audio) != 0) {
+        goto fail;
+    }
+    audio_interface_set_config(stream->audio, BENCH_SAMPLE_RATE, BENCH_FRAME_SAMPLES, BENCH_CHANNELS, 4, 8192, 2048);
+    if (audio_stub_enable_tone(stream->audio, &tone) != 0) {
+        goto fail;
+    }
+
+    audio_format_t format = {0};
+    audio_format_init(&format, BENCH_SAMPLE_RATE, BENCH_CHANNELS, 16, BENCH_FRAME_MS);
+    stream->encoder = codec_factory_create_for_format(s_audio_format);
+    stream->decoder = codec_factory_create_for_format(s_audio_format);
+    if (!stream->encoder || !stream->decoder ||
+        audio_codec_init_encoder(stream->encoder, &format) != CODEC_SUCCESS ||
+        audio_codec_init_decoder(stream->decoder, &format) != CODEC_SUCCESS) {
+        goto fail;
+    }
+
+    stream->player = linx_player_create(stream->audio, stream->decoder);
+    player_audio_config_t player_config = {
+        .sample_rate = BENCH_SAMPLE_RATE,
+        .channels = BENCH_CHANNELS,
+        .frame_size = BENCH_FRAME_SAMPLES,
+        .buffer_size = 8192,
+        .conceal_loss = true,
+    };
+    if (!stream->player || linx_player_init(stream->player, &player_config) != PLAYER_SUCCESS ||
+        linx_player_start(stream->player) != PLAYER_SUCCESS) {
+        goto fail;
+    }
+
+    LinxSdkConfig config = {0};
+    snprintf(config.server_url, sizeof(config.server_url), "ws://127.0.0.1:%d", port);
+    snprintf(config.audio_format, sizeof(config.audio_format), "%s", s_audio_format);
+    snprintf(config.device_id, sizeof(config.device_id), "bench-device-%d", index);
+    snprintf(config.client_id, sizeof(config.client_id), "bench-client-%d", index);
+    config.sample_rate = BENCH_SAMPLE_RATE;
+    config.channels = BENCH_CHANNELS;
+    config.timeout_ms = 5000;
+    config.protocol_version = version;
+    config.listening_mode = LINX_LISTENING_MODE_REALTIME;
+    config.reactor = reactor;
+    config.zero_alloc_assert = s_zero_alloc_assert;
+    if (s_capture_prefix && index == 0) {
+        snprintf(config.capture_path, sizeof(config.capture_path), "%s_v%u.lxws", s_capture_prefix, version);
+    }
+    stream->sdk = linx_sdk_create(&config);
+    if (!stream->sdk) {
+        goto fail;
+    }
+    linx_sdk_set_player(stream->sdk, stream->player);
+    linx_sdk_set_event_callback(stream->sdk, stream_event_callback, stream);
+    if (linx_sdk_connect(stream->sdk) != LINX_SDK_SUCCESS) {
+        goto fail;
+    }
+    return true;
+
+fail:
+    stream_destroy(stream);
+    return false;
+}
+
+static bool stream_start_capture(bench_stream_t* stream) {
+    if (audio_interface_record(stream->audio) != 0 || audio_interface_init_play(stream->audio) != 0) {
+        return false;
+    }
+    stream->running = true;
+    stream->capture_started = pthread_create(&stream->capture_thread, NULL, stream_capture_thread, stream) == 0;
+    return stream->capture_started;
+}
+
+// ==================== 统计与报告 ====================
+
+typedef struct {
+    uint32_t version;
+    size_t streams;
+    size_t samples;
+    double p50_ms, p90_ms, p99_ms, max_ms;
+    uint64_t sent, received, lost;
+    double cpu_percent_per_stream;
+    char* budget_json;          // -b: 稳态时的 linx_budget_to_json()，调用者释放
+} bench_result_t;
+
+static int compare_u32(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile_ms(const uint32_t* sorted, size_t count, double p) {
+    if (count == 0) return 0.0;
+    size_t index = (size_t)(p * (double)(count - 1) + 0.5);
+    return sorted[index] / 1000.0;
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static double cpu_s(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (double)usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+           (double)usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+/**
+ * @brief 运行一个协议版本：建立全部会话，等待连接后注入音频 duration_s 秒
+ */
+static bool run_version(linx_reactor_t* reactor, int port, uint32_t version, int stream_count,
+                        int duration_s, bench_result_t* result) {
+    bench_stream_t streams[BENCH_MAX_STREAMS];
+    int created = 0;
+    bool ok = true;
+
+    memset(result, 0, sizeof(*result));
+    result->version = version;
+    // 每轮单独统计：堆峰值从当前占用重新开始，上一轮已退出的线程不再列出
+    if (s_budget_path) {
+        linx_alloc_reset_peak();
+        linx_thread_stats_clear_exited();
+    }
+
+    for (; created < stream_count; created++) {
+        if (!stream_create(&streams[created], reactor, port, version, created)) {
+            fprintf(stderr, "v%u: 第 %d 路会话创建失败\n", version, created);
+            ok = false;
+            break;
+        }
+    }
+
+    // 等待全部会话完成 hello（最多 5 秒）
+    double deadline = now_s() + 5.0;
+    for (int i = 0; ok && i < created; i++) {
+        while (linx_sdk_get_listen_state(streams[i].sdk) != LINX_LISTEN_STATE_STARTED && now_s() < deadline) {
+            usleep(10 * 1000);
+        }
+        if (linx_sdk_get_listen_state(streams[i].sdk) != LINX_LISTEN_STATE_STARTED) {
+            fprintf(stderr, "v%u: 第 %d 路会话未建立\n", version, i);
+            ok = false;
+        }
+    }
+
+    double wall_start = now_s();
+    double cpu_start = cpu_s();
+    for (int i = 0; ok && i < created; i++) {
+        ok = stream_start_capture(&streams[i]);
+    }
+    if (ok) {
+        linx_budget_window_begin();
+        sleep((unsigned int)duration_s);
+    }
+    double cpu_used = cpu_s() - cpu_start;
+    double wall_used = now_s() - wall_start;
+    if (ok && s_budget_path) {
+        result->budget_json = linx_budget_to_json();
+    }
+
+    for (int i = 0; i < created; i++) {
+        streams[i].running = false;
+    }
+
+    // 汇总所有路的时延
+    size_t total = 0;
+    uint32_t* latencies = NULL;
+    for (int i = 0; i < created; i++) {
+        size_t count = audio_stub_get_latencies(streams[i].audio, NULL, 0);
+        uint32_t* grown = (uint32_t*)realloc(latencies, (total + count + 1) * sizeof(uint32_t));
+        if (!grown) break;
+        latencies = grown;
+        total += audio_stub_get_latencies(streams[i].audio, latencies + total, count);
+
+        audio_stub_tone_stats_t stats;
+        if (audio_stub_get_tone_stats(streams[i].audio, &stats)) {
+            result->sent += stats.bursts_sent;
+            result->received += stats.bursts_received;
+            result->lost += stats.bursts_lost;
+        }
+    }
+    for (int i = 0; i < created; i++) {
+        stream_destroy(&streams[i]);
+    }
+
+    if (latencies) {
+        qsort(latencies, total, sizeof(uint32_t), compare_u32);
+    }
+    result->streams = (size_t)created;
+    result->samples = total;
+    result->p50_ms = percentile_ms(latencies, total, 0.50);
+    result->p90_ms = percentile_ms(latencies, total, 0.90);
+    result->p99_ms = percentile_ms(latencies, total, 0.99);
+    result->max_ms = total > 0 ? latencies[total - 1] / 1000.0 : 0.0;
+    if (created > 0 && wall_used > 0) {
+        result->cpu_percent_per_stream = cpu_used / wall_used * 100.0 / created;
+    }
+    free(latencies);
+    return ok;
+}
+
+// ==================== 板级配置与预算报告 ====================
+
+static const char* config_value(const char* key) {
+    for (int i = 0; i < s_config_count; i++) {
+        if (strcmp(s_config_items[i].key, key) == 0) {
+            return s_config_items[i].value;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief 读取 build/configs/<板子>.config（与 linxos.py 相同的 KEY=VALUE 格式）
+ */
+static bool load_board_config(const char* path) {
+    FILE* fp = fopen(path, "r");
+    if (!fp) {
+        fprintf(stderr, "无法打开板级配置: %s\n", path);
+        return false;
+    }
+
+    const char* base = strrchr(path, '/');
+    snprintf(s_config_name, sizeof(s_config_name), "%s", base ? base + 1 : path);
+    char* ext = strstr(s_config_name, ".config");
+    if (ext) {
+        *ext = '\0';
+    }
+
+    char line[256];
+    while (fgets(line, sizeof(line), fp) && s_config_count < BENCH_MAX_CONFIG_ITEMS) {
+        line[strcspn(line, "\r\n")] = '\0';
+        char* eq = strchr(line, '=');
+        if (line[0] == '#' || !eq) {
+            continue;
+        }
+        *eq = '\0';
+        char* value = eq + 1;
+        size_t len = strlen(value);
+        if (len >= 2 && (value[0] == '"' || value[0] == '\'') && value[len - 1] == value[0]) {
+            value[len - 1] = '\0';
+            value++;
+        }
+        bench_config_item_t* item = &s_config_items[s_config_count++];
+        snprintf(item->key, sizeof(item->key), "%s", line);
+        snprintf(item->value, sizeof(item->value), "%s", value);
+    }
+    fclose(fp);
+    return true;
+}
+
+/**
+ * @brief 写出预算报告：配置项、每轮的时延与 linx_budget_to_json()
+ */
+static bool write_budget_report(const char* path, const bench_result_t* results, int count, int duration_s) {
+    cJSON* root = cJSON_CreateObject();
+    if (s_config_count > 0) {
+        cJSON* config = cJSON_AddObjectToObject(root, "config");
+        cJSON_AddStringToObject(config, "name", s_config_name);
+        cJSON* items = cJSON_AddObjectToObject(config, "items");
+        for (int i = 0; i < s_config_count; i++) {
+            cJSON_AddStringToObject(items, s_config_items[i].key, s_config_items[i].value);
+        }
+    } else {
+        cJSON_AddNullToObject(root, "config");
+    }
+    cJSON_AddStringToObject(root, "audio_format", s_audio_format);
+    cJSON_AddNumberToObject(root, "duration_s", duration_s);
+
+    cJSON* runs = cJSON_AddArrayToObject(root, "runs");
+    for (int i = 0; i < count; i++) {
+        cJSON* run = cJSON_CreateObject();
+        cJSON_AddNumberToObject(run, "version", results[i].version);
+        cJSON_AddNumberToObject(run, "streams", (double)results[i].streams);
+        cJSON_AddNumberToObject(run, "p50_ms", results[i].p50_ms);
+        cJSON_AddNumberToObject(run, "p99_ms", results[i].p99_ms);
+        cJSON_AddNumberToObject(run, "cpu_percent_per_stream", results[i].cpu_percent_per_stream);
+        cJSON* budget = results[i].budget_json ? cJSON_Parse(results[i].budget_json) : NULL;
+        if (budget) {
+            cJSON_AddItemToObject(run, "budget", budget);
+        } else {
+            cJSON_AddNullToObject(run, "budget");
+        }
+        cJSON_AddItemToArray(runs, run);
+    }
+
+    char* text = cJSON_Print(root);
+    cJSON_Delete(root);
+    FILE* fp = text ? fopen(path, "w") : NULL;
+    bool ok = fp && fputs(text, fp) >= 0 && fputc('\n', fp) != EOF;
+    if (fp && fclose(fp) != 0) {
+        ok = false;
+    }
+    cJSON_free(text);
+    if (!ok) {
+        fprintf(stderr, "写入预算报告失败: %s\n", path);
+    }
+    return ok;
+}
+
+static void usage(const char* program) {
+    printf("用法: %s [-s 路数] [-d 每轮秒数] [-v 1,2,3,4] [-p 端口] [-t p99阈值毫秒] [-z] [-c 录制前缀]\n"
+           "       [-b 预算报告.json] [-C 板级配置]\n", program);
+    printf("  -s  并发会话数 (默认 1，最多 %d)\n", BENCH_MAX_STREAMS);
+    printf("  -d  每个协议版本的测量时长，秒 (默认 10)\n");
+    printf("  -v  要测试的协议版本，逗号分隔 (默认 1,2,3,4)\n");
+    printf("  -p  模拟服务端端口 (默认 18765)\n");
+    printf("  -t  p99 时延阈值，毫秒；超过或没有收到任何音时退出码为 1 (默认不检查)\n");
+    printf("  -z  检查会话建立后音频热路径上的堆分配，有分配时退出码为 1\n");
+    printf("  -c  把每轮第一路会话录制到 <前缀>_v<协议版本>.lxws，供 replay_session 回放\n");
+    printf("  -b  统计每轮稳态下的堆峰值、线程栈高水位和各阶段 CPU，写入 JSON 文件\n");
+    printf("  -C  按 build/configs 下的板级配置运行（Opus 开关、最大连接数），配置项写入预算报告\n");
+}
+
+int main(int argc, char* argv[]) {
+    int stream_count = 1;
+    int duration_s = 10;
+    int port = 18765;
+    double p99_limit_ms = 0.0;
+    uint32_t versions[BENCH_MAX_VERSIONS] = {1, 2, 3, 4};
+    int version_count = 4;
+    const char* config_path = NULL;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "s:d:v:p:t:zc:b:C:h")) != -1) {
+        switch (opt) {
+            case 's': stream_count = atoi(optarg); break;
+            case 'd': duration_s = atoi(optarg); break;
+            case 'p': port = atoi(optarg); break;
+            case 't': p99_limit_ms = atof(optarg); break;
+            case 'z': s_zero_alloc_assert = true; break;
+            case 'c': s_capture_prefix = optarg; break;
+            case 'b': s_budget_path = optarg; break;
+            case 'C': config_path = optarg; break;
+            case 'v': {
+                version_count = 0;
+                for (const char* p = optarg; *p && version_count < BENCH_MAX_VERSIONS; p++) {
+                    if (*p >= '1' && *p <= '4') {
+                        versions[version_count++] = (uint32_t)(*p - '0');
+                    }
+                }
+                break;
+            }
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 2;
+        }
+    }
+    if (stream_count < 1 || stream_count > BENCH_MAX_STREAMS || duration_s < 1 || version_count == 0) {
+        usage(argv[0]);
+        return 2;
+    }
+    if (config_path) {
+        if (!load_board_config(config_path)) {
+            return 2;
+        }
+        const char* opus = config_value("CONFIG_ENABLE_OPUS");
+        if (opus && strcmp(opus, "y") != 0) {
+            s_audio_format = "adpcm";
+        }
+        const char* max_connections = config_value("CONFIG_MAX_CONNECTIONS");
+        if (max_connections && atoi(max_connections) > 0 && stream_count > atoi(max_connections)) {
+            stream_count = atoi(max_connections);
+        }
+    }
+
+    // 堆跟踪必须在任何 SDK 调用（包括 log_init）之前启用
+    if (s_budget_path && !linx_budget_enable()) {
+        fprintf(stderr, "启用堆跟踪失败\n");
+        return 1;
+    }
+
+    log_config_t log_config = LOG_DEFAULT_CONFIG;
+    log_config.level = LOG_LEVEL_WARN;
+    log_init(&log_config);
+    if (s_zero_alloc_assert) {
+        linx_alloc_set_trap(bench_alloc_trap, NULL);
+    }
+
+    mock_server_t server;
+    if (!mock_server_start(&server, port)) {
+        return 1;
+    }
+    linx_reactor_t* reactor = linx_reactor_create();
+    if (!reactor || !linx_reactor_start(reactor, 0)) {
+        fprintf(stderr, "创建事件循环失败\n");
+        mock_server_stop(&server);
+        return 1;
+    }
+
+    printf("回环时延基准: %d 路, 每轮 %d 秒, %s%s%s\n", stream_count, duration_s, s_audio_format,
+           s_config_count > 0 ? ", 配置 " : "", s_config_count > 0 ? s_config_name : "");
+    printf("%-4s %6s %8s %8s %8s %8s %6s %6s %10s\n",
+           "协议", "样本", "p50(ms)", "p90(ms)", "p99(ms)", "max(ms)", "发出", "丢失", "CPU/路(%)");
+
+    int exit_code = 0;
+    bench_result_t results[BENCH_MAX_VERSIONS];
+    for (int i = 0; i < version_count; i++) {
+        bench_result_t result;
+        bool ok = run_version(reactor, port, versions[i], stream_count, duration_s, &result);
+        results[i] = result;
+        printf("v%-3u %6zu %8.1f %8.1f %8.1f %8.1f %6llu %6llu %10.1f\n",
+               result.version, result.samples, result.p50_ms, result.p90_ms, result.p99_ms, result.max_ms,
+               (unsigned long long)result.sent, (unsigned long long)result.lost,
+               result.cpu_percent_per_stream);
+
+        if (!ok || result.samples == 0) {
+            fprintf(stderr, "v%u: 没有测到回环音频\n", result.version);
+            exit_code = 1;
+        } else if (p99_limit_ms > 0 && result.p99_ms > p99_limit_ms) {
+            fprintf(stderr, "v%u: p99 %.1f ms 超过阈值 %.1f ms\n", result.version, result.p99_ms, p99_limit_ms);
+            exit_code = 1;
+        }
+    }
+    if (s_zero_alloc_assert && linx_alloc_get_violations() > 0) {
+        fprintf(stderr, "音频热路径上发生 %llu 次堆分配\n", (unsigned long long)linx_alloc_get_violations());
+        exit_code = 1;
+    }
+    if (s_budget_path) {
+        if (!write_budget_report(s_budget_path, results, version_count, duration_s)) {
+            exit_code = 1;
+        }
+        for (int i = 0; i < version_count; i++) {
+            linx_free(results[i].budget_json);
+        }
+        printf("预算报告: %s\n", s_budget_path);
+    }
+    if (server.bad_frames > 0) {
+        fprintf(stderr, "模拟服务端收到 %u 个帧头不符的上行帧\n", server.bad_frames);
+        exit_code = 1;
+    }
+    if (server.sequence_gaps > 0) {
+        printf("模拟服务端检测到 %u 次 v4 上行序号跳变\n", server.sequence_gaps);
+    }
+
+    linx_reactor_stop(reactor);
+    linx_reactor_destroy(reactor);
+    mock_server_stop(&server);
+    log_cleanup();
+    return exit_code;
+}
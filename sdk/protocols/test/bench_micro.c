@@ -0,0 +1,822 @@
+/**
+ * @file bench_micro.c
+ * @brief 音频热路径基础组件的微基准
+ *
+ * 逐项测量每次操作的耗时（纳秒）和周期数，作为修改这些组件时的前后对照：
+ * - 二进制帧头编码 / 解析（linx_binary_protocol_encode_header / decode，v2、v3、v4）
+ * - 音频数据包：堆分配 linx_audio_stream_packet_create、内存池借还、零拷贝视图保留
+ * - 抖动缓冲区稳定状态下的一进一出（取代原先的环形缓冲区），含播放器加锁的版本
+ * - 事件队列的音频事件入队 / 出队，文本事件复制进事件历史（回调返回后字符串仍有效）
+ * - 下行 tts 控制消息的解析：CBOR 解码到定长结构、linx_json_scan 扫描、cJSON 建树（含带限制的版本）
+ * - 嵌套过深的恶意消息按 WebSocket 默认限制被拒绝的耗时（cJSON_ParseWithLimits）
+ * - 长字符串（16KB base64，相当于 MCP 图片结果的一段）的转义输出和解析（cJSON_StringPlainSpan 的向量扫描）
+ * - MQTT+UDP 传输的单帧 AES-128-CTR 加密
+ * - 会话音频录制的单包组页（写入 /dev/null，只计调用方的开销，文件 I/O 在后台线程）
+ * - 64 个成员的 cJSON 对象上区分大小写的键查找：线性扫描与哈希索引（cJSON_SetObjectIndexThreshold）
+ * - 时间轮上重新安排一个定时器（每个连接的保活、重连退避都是这样的操作），轮上同时挂着上千个定时器
+ *
+ * 指定 -t 时，线程安全的组件再用 N 个线程同时运行一遍，测量有竞争时的开销，
+ * 用于评估无锁实现相对当前互斥锁实现的收益。
+ *
+ * 周期数在 x86 上读取 TSC（参考周期，不随睿频变化）；其他平台可用 -m 指定主频
+ * 按耗时换算，未指定时不输出。每项运行 -r 轮取中位数。
+ *
+ * 前后对照：修改前 -o before.csv 保存结果，修改后 -b before.csv 输出变化百分比。
+ *
+ * 用法: bench_micro [-n 每轮次数] [-r 轮数] [-t 线程数] [-f 名称过滤] [-m 主频MHz]
+ *                   [-o 结果.csv] [-b 基线.csv]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include "linx_log.h"
+#include "linx_protocol.h"
+#include "linx_control_cbor.h"
+#include "linx_aes_ctr.h"
+#include "linx_ogg_recorder.h"
+#include "linx_json_scan.h"
+#include "linx_json_writer.h"
+#include "linx_event_queue.h"
+#include "linx_timer.h"
+#include "linx_websocket.h"
+#include "play/linx_jitter_buffer.h"
+
+#define BENCH_DEFAULT_ITERATIONS 200000
+#define BENCH_DEFAULT_ROUNDS     5
+#define BENCH_MAX_ROUNDS         32
+#define BENCH_MAX_THREADS        16
+#define BENCH_MAX_BASELINE       64
+#define BENCH_FRAME_MS           60
+#define BENCH_PAYLOAD_BYTES      180     // 16kHz 单声道 60ms Opus 帧的典型大小
+#define BENCH_JSON_MEMBERS       64
+#define BENCH_EVENT_HISTORY      8
+#define BENCH_JSON_INDEX_THRESHOLD 16
+#define BENCH_JSON_LONG_STRING    (16 * 1024)
+#define BENCH_JSON_HOSTILE_DEPTH 512    // 远超 LINX_WEBSOCKET_MAX_JSON_DEPTH 的嵌套层数
+#define BENCH_TIMERS             1024   // 时间轮上同时安排的定时器数
+
+// ==================== 计时 ====================
+
+static uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static bool bench_has_cycle_counter(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+static uint64_t bench_cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// 防止编译器把被测操作当作无用代码删除
+static volatile uint64_t s_sink;
+
+// ==================== 被测组件 ====================
+
+typedef struct {
+    uint8_t payload[BENCH_PAYLOAD_BYTES];
+    uint8_t frame_v2[LINX_BINARY_HEADER_MAX_BYTES + BENCH_PAYLOAD_BYTES];
+    uint8_t frame_v3[LINX_BINARY_HEADER_MAX_BYTES + BENCH_PAYLOAD_BYTES];
+    uint8_t frame_v4[LINX_BINARY_HEADER_MAX_BYTES + BENCH_PAYLOAD_BYTES];
+    size_t frame_v2_size;
+    size_t frame_v3_size;
+    size_t frame_v4_size;
+    linx_audio_packet_pool_t* pool;
+    linx_jitter_buffer_t* jitter;
+    pthread_mutex_t jitter_mutex;
+    uint32_t jitter_timestamp;
+    uint64_t jitter_now_ms;
+    linx_event_queue_t* events;
+    linx_event_history_t* history;
+    uint8_t control_cbor[LINX_CONTROL_CBOR_MAX_SIZE];
+    size_t control_cbor_size;
+    char control_json[LINX_CONTROL_CBOR_MAX_SIZE];
+    size_t control_json_size;
+    cJSON_ParseLimits json_limits;  // WebSocket 的默认入站限制
+    char hostile_json[BENCH_JSON_HOSTILE_DEPTH * 2 + 1];
+    char long_string[BENCH_JSON_LONG_STRING + 1];
+    char long_json[BENCH_JSON_LONG_STRING + 3];
+    linx_json_writer_t long_writer;
+    linx_aes128_t aes;
+    uint8_t opus_packet[BENCH_PAYLOAD_BYTES];
+    linx_ogg_recorder_t* recorder;
+    cJSON* json_object;
+    cJSON* json_linear;             // json_object 的引用：引用节点不建索引，查找始终线性扫描
+    char json_keys[BENCH_JSON_MEMBERS][16];
+    linx_timer_wheel_t* timers;
+    linx_timer_t timer_nodes[BENCH_TIMERS];
+} bench_state_t;
+
+static bench_state_t s_state;
+
+static void op_noop(size_t i) {
+    s_sink += i;
+}
+
+static void op_header_encode_v2(size_t i) {
+    uint8_t header[LINX_BINARY_HEADER_MAX_BYTES];
+    s_sink += (uint64_t)linx_binary_protocol_encode_header(2, (uint32_t)i, 0, BENCH_PAYLOAD_BYTES, header);
+    s_sink += header[8];
+}
+
+static void op_header_encode_v3(size_t i) {
+    uint8_t header[LINX_BINARY_HEADER_MAX_BYTES];
+    s_sink += (uint64_t)linx_binary_protocol_encode_header(3, (uint32_t)i, 0, BENCH_PAYLOAD_BYTES, header);
+    s_sink += header[2];
+}
+
+static void op_header_encode_v4(size_t i) {
+    uint8_t header[LINX_BINARY_HEADER_MAX_BYTES];
+    s_sink += (uint64_t)linx_binary_protocol_encode_header(4, (uint32_t)i, (uint16_t)i, BENCH_PAYLOAD_BYTES,
+                                                           header);
+    s_sink += header[4];
+}
+
+static void op_frame_decode(int version, const uint8_t* frame, size_t size) {
+    const uint8_t* payload = NULL;
+    size_t payload_size = 0;
+    uint32_t timestamp = 0;
+    uint16_t sequence = 0;
+    if (linx_binary_protocol_decode(version, frame, size, &payload, &payload_size,
+                                    &timestamp, &sequence) == LINX_BINARY_FRAME_AUDIO) {
+        s_sink += payload_size + timestamp + sequence + payload[0];
+    }
+}
+
+static void op_frame_decode_v2(size_t i) {
+    (void)i;
+    op_frame_decode(2, s_state.frame_v2, s_state.frame_v2_size);
+}
+
+static void op_frame_decode_v3(size_t i) {
+    (void)i;
+    op_frame_decode(3, s_state.frame_v3, s_state.frame_v3_size);
+}
+
+static void op_frame_decode_v4(size_t i) {
+    (void)i;
+    op_frame_decode(4, s_state.frame_v4, s_state.frame_v4_size);
+}
+
+static void op_packet_create(size_t i) {
+    (void)i;
+    linx_audio_stream_packet_t* packet = linx_audio_stream_packet_create(BENCH_PAYLOAD_BYTES);
+    if (packet) {
+        packet->payload[0] = 1;
+        linx_audio_stream_packet_destroy(packet);
+    }
+}
+
+static void op_pool_acquire(size_t i) {
+    (void)i;
+    linx_audio_stream_packet_t* packet = linx_audio_packet_pool_acquire(s_state.pool, BENCH_PAYLOAD_BYTES);
+    if (packet) {
+        packet->payload[0] = 1;
+        linx_audio_stream_packet_destroy(packet);
+    }
+}
+
+static void op_pool_retain(size_t i) {
+    linx_audio_stream_packet_t view;
+    linx_audio_stream_packet_init_view(&view, s_state.payload, sizeof(s_state.payload));
+    view.timestamp = (uint32_t)i;
+    linx_audio_stream_packet_t* packet = linx_audio_packet_pool_retain(s_state.pool, &view);
+    linx_audio_stream_packet_destroy(packet);
+}
+
+static void jitter_push_pop(void) {
+    uint8_t out[LINX_JITTER_BUFFER_SLOT_BYTES];
+    size_t size = 0;
+    s_state.jitter_timestamp += BENCH_FRAME_MS;
+    s_state.jitter_now_ms += BENCH_FRAME_MS;
+    linx_jitter_buffer_push(s_state.jitter, s_state.payload, sizeof(s_state.payload),
+                            s_state.jitter_timestamp, true, s_state.jitter_now_ms);
+    if (linx_jitter_buffer_pop(s_state.jitter, out, sizeof(out), &size, NULL,
+                               s_state.jitter_now_ms) == LINX_JITTER_OK) {
+        s_sink += size;
+    }
+}
+
+static void op_jitter(size_t i) {
+    (void)i;
+    jitter_push_pop();
+}
+
+// 与播放器一致：推包和取包各自持有一次 buffer_mutex
+static void op_jitter_locked(size_t i) {
+    (void)i;
+    uint8_t out[LINX_JITTER_BUFFER_SLOT_BYTES];
+    size_t size = 0;
+    pthread_mutex_lock(&s_state.jitter_mutex);
+    s_state.jitter_timestamp += BENCH_FRAME_MS;
+    s_state.jitter_now_ms += BENCH_FRAME_MS;
+    linx_jitter_buffer_push(s_state.jitter, s_state.payload, sizeof(s_state.payload),
+                            s_state.jitter_timestamp, true, s_state.jitter_now_ms);
+    pthread_mutex_unlock(&s_state.jitter_mutex);
+
+    pthread_mutex_lock(&s_state.jitter_mutex);
+    if (linx_jitter_buffer_pop(s_state.jitter, out, sizeof(out), &size, NULL,
+                               s_state.jitter_now_ms) == LINX_JITTER_OK) {
+        s_sink += size;
+    }
+    pthread_mutex_unlock(&s_state.jitter_mutex);
+}
+
+static void op_event_queue(size_t i) {
+    linx_audio_stream_packet_t view;
+    linx_audio_stream_packet_init_view(&view, s_state.payload, sizeof(s_state.payload));
+    LinxEvent event = {
+        .type = LINX_EVENT_AUDIO_DATA,
+        .timestamp = (time_t)i,
+        .data.audio_data.value = &view
+    };
+    linx_event_queue_push(s_state.events, &event, s_state.pool);
+    LinxEvent* popped = linx_event_queue_pop(s_state.events, 0);
+    if (popped) {
+        s_sink += popped->data.audio_data.value->payload_size;
+        linx_event_release(popped);
+    }
+}
+
+// 一条典型的下行 tts 消息
+#define BENCH_CONTROL_SESSION "a3f1c2d4-5e6f-4701-8b9c-0d1e2f3a4b5c"
+#define BENCH_CONTROL_TEXT    "今天天气晴，最高气温二十五度，适合出门散步。"
+
+static void op_event_history(size_t i) {
+    LinxEvent event = {
+        .type = LINX_EVENT_SENTENCE_START,
+        .timestamp = (time_t)i,
+        .data.text_message = { .text = BENCH_CONTROL_TEXT, .role = "assistant" }
+    };
+    LinxEvent* kept = linx_event_history_copy(s_state.history, &event);
+    linx_event_history_keep(s_state.history, kept);
+    if (kept) {
+        s_sink += (uint64_t)kept->data.text_message.text[0];
+    }
+    linx_event_release(kept);
+}
+
+static void op_control_decode_cbor(size_t i) {
+    (void)i;
+    linx_control_message_t message;
+    if (linx_control_cbor_decode(s_state.control_cbor, s_state.control_cbor_size, &message)) {
+        s_sink += message.fields[LINX_CONTROL_FIELD_TEXT].length + (uint64_t)message.type;
+    }
+}
+
+static void op_control_scan_json(size_t i) {
+    (void)i;
+    linx_json_scan_field_t fields[] = {
+        { .key = "type" },
+        { .key = "state" },
+        { .key = "text" },
+    };
+    if (linx_json_scan_object(s_state.control_json, s_state.control_json_size, fields, 3) == 3) {
+        s_sink += fields[2].length + (uint64_t)linx_json_scan_equals(&fields[0], "tts");
+    }
+}
+
+static void op_control_parse_json(size_t i) {
+    (void)i;
+    cJSON* root = cJSON_ParseWithLength(s_state.control_json, s_state.control_json_size);
+    const cJSON* text = cJSON_GetObjectItem(root, "text");
+    if (cJSON_IsString(text)) {
+        s_sink += strlen(text->valuestring);
+    }
+    cJSON_Delete(root);
+}
+
+static void op_control_parse_limited(size_t i) {
+    (void)i;
+    cJSON* root = cJSON_ParseWithLimits(s_state.control_json, s_state.control_json_size, &s_state.json_limits);
+    const cJSON* text = cJSON_GetObjectItem(root, "text");
+    if (cJSON_IsString(text)) {
+        s_sink += strlen(text->valuestring);
+    }
+    cJSON_Delete(root);
+}
+
+static void op_json_reject_deep(size_t i) {
+    (void)i;
+    cJSON* root = cJSON_ParseWithLimits(s_state.hostile_json, sizeof(s_state.hostile_json) - 1,
+                                        &s_state.json_limits);
+    s_sink += (uint64_t)(root == NULL);
+    cJSON_Delete(root);
+}
+
+static void op_json_print_long(size_t i) {
+    (void)i;
+    linx_json_writer_reset(&s_state.long_writer);
+    linx_json_writer_string(&s_state.long_writer, s_state.long_string);
+    s_sink += s_state.long_writer.length;
+}
+
+static void op_json_parse_long(size_t i) {
+    (void)i;
+    cJSON* root = cJSON_ParseWithLength(s_state.long_json, sizeof(s_state.long_json) - 1);
+    s_sink += (uint64_t)cJSON_IsString(root);
+    cJSON_Delete(root);
+}
+
+static void op_udp_encrypt(size_t i) {
+    uint8_t counter[LINX_AES_BLOCK_SIZE] = { 0x01 };
+    uint8_t out[BENCH_PAYLOAD_BYTES];
+    counter[15] = (uint8_t)i;
+    linx_aes128_ctr(&s_state.aes, counter, s_state.payload, out, sizeof(out));
+    s_sink += out[0];
+}
+
+static void op_ogg_record(size_t i) {
+    (void)i;
+    s_sink += linx_ogg_recorder_write(s_state.recorder, LINX_OGG_RECORDER_UPLINK, s_state.opus_packet,
+                                      sizeof(s_state.opus_packet), 16000, 1);
+}
+
+static void op_timer_rearm(size_t i) {
+    // 延迟从几十毫秒到几十秒不等，覆盖时间轮的前三级
+    linx_timer_schedule(s_state.timers, &s_state.timer_nodes[i % BENCH_TIMERS], (uint32_t)(i * 37 % 60000) + 20, 0);
+    s_sink += linx_timer_wheel_pending(s_state.timers);
+}
+
+static void bench_timer_callback(linx_timer_t* timer, void* user_data) {
+    (void)timer;
+    (void)user_data;
+}
+
+static void op_json_lookup(const cJSON* object, size_t i) {
+    const cJSON* item = cJSON_GetObjectItemCaseSensitive(object, s_state.json_keys[(i * 37) % BENCH_JSON_MEMBERS]);
+    s_sink += (uint64_t)(item ? item->valueint : -1);
+}
+
+static void op_json_lookup_linear(size_t i) {
+    op_json_lookup(s_state.json_linear, i);
+}
+
+static void op_json_lookup_indexed(size_t i) {
+    op_json_lookup(s_state.json_object, i);
+}
+
+static bool setup_json(void) {
+    cJSON_SetObjectIndexThreshold(BENCH_JSON_INDEX_THRESHOLD);
+    s_state.json_object = cJSON_CreateObject();
+    for (int i = 0; i < BENCH_JSON_MEMBERS && s_state.json_object; i++) {
+        snprintf(s_state.json_keys[i], sizeof(s_state.json_keys[i]), "field_%02d", i);
+        cJSON_AddNumberToObject(s_state.json_object, s_state.json_keys[i], i);
+    }
+    s_state.json_linear = cJSON_CreateObjectReference(s_state.json_object ? s_state.json_object->child : NULL);
+
+    // 两种查找必须得到同一个成员
+    for (int i = 0; i < BENCH_JSON_MEMBERS && s_state.json_linear; i++) {
+        if (cJSON_GetObjectItemCaseSensitive(s_state.json_object, s_state.json_keys[i]) !=
+            cJSON_GetObjectItemCaseSensitive(s_state.json_linear, s_state.json_keys[i])) {
+            return false;
+        }
+    }
+    static const char base64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    for (int i = 0; i < BENCH_JSON_LONG_STRING; i++) {
+        s_state.long_string[i] = base64[(i * 7 + i / 64) % 64];
+    }
+    snprintf(s_state.long_json, sizeof(s_state.long_json), "\"%s\"", s_state.long_string);
+    linx_json_writer_init(&s_state.long_writer);
+
+    // 写出的必须是原样加引号
+    linx_json_writer_string(&s_state.long_writer, s_state.long_string);
+    const char* printed = linx_json_writer_finish(&s_state.long_writer);
+    return printed && strcmp(printed, s_state.long_json) == 0 &&
+           s_state.json_linear && s_state.json_object->key_index && !s_state.json_linear->key_index;
+}
+
+static bool setup_history(void) {
+    // 历史中的字符串不随源缓冲区变化，再来 depth - 1 个文本事件后仍然有效
+    char text[32] = "first sentence";
+    LinxEvent event = { .type = LINX_EVENT_TEXT_MESSAGE, .data.text_message = { .text = text, .role = "user" } };
+    LinxEvent* first = linx_event_history_copy(s_state.history, &event);
+    if (!first) {
+        return false;
+    }
+    linx_event_history_keep(s_state.history, first);
+    const char* kept_text = first->data.text_message.text;
+    linx_event_release(first);
+
+    for (int i = 1; i < BENCH_EVENT_HISTORY; i++) {
+        snprintf(text, sizeof(text), "sentence %d", i);
+        LinxEvent* next = linx_event_history_copy(s_state.history, &event);
+        linx_event_history_keep(s_state.history, next);
+        linx_event_release(next);
+    }
+    return strcmp(kept_text, "first sentence") == 0 && linx_event_history_accepts(LINX_EVENT_SENTENCE_START) &&
+           !linx_event_history_accepts(LINX_EVENT_AUDIO_DATA);
+}
+
+static bool setup_control(void) {
+    linx_control_message_t message;
+    linx_control_message_init(&message, LINX_CONTROL_TYPE_TTS);
+    linx_control_message_set(&message, LINX_CONTROL_FIELD_SESSION_ID, BENCH_CONTROL_SESSION);
+    linx_control_message_set(&message, LINX_CONTROL_FIELD_STATE, "sentence_start");
+    linx_control_message_set(&message, LINX_CONTROL_FIELD_TEXT, BENCH_CONTROL_TEXT);
+    s_state.control_cbor_size = linx_control_cbor_encode(&message, s_state.control_cbor,
+                                                         sizeof(s_state.control_cbor));
+    s_state.control_json_size = (size_t)snprintf(s_state.control_json, sizeof(s_state.control_json),
+        "{\"session_id\":\"%s\",\"type\":\"tts\",\"state\":\"sentence_start\",\"text\":\"%s\"}",
+        BENCH_CONTROL_SESSION, BENCH_CONTROL_TEXT);
+
+    s_state.json_limits.max_length = LINX_WEBSOCKET_MAX_TEXT_BYTES;
+    s_state.json_limits.max_depth = LINX_WEBSOCKET_MAX_JSON_DEPTH;
+    s_state.json_limits.max_items = LINX_WEBSOCKET_MAX_JSON_ITEMS;
+    for (int i = 0; i < BENCH_JSON_HOSTILE_DEPTH; i++) {
+        s_state.hostile_json[i] = '[';
+        s_state.hostile_json[BENCH_JSON_HOSTILE_DEPTH * 2 - 1 - i] = ']';
+    }
+
+    // 限制内的消息照常解析；过深、节点过多、过大的消息都被拒绝
+    cJSON* limited = cJSON_ParseWithLimits(s_state.control_json, s_state.control_json_size, &s_state.json_limits);
+    bool limits_ok = limited != NULL;
+    cJSON_Delete(limited);
+    cJSON_ParseLimits few_items = { 0, 0, 4 };
+    cJSON_ParseLimits short_input = { 16, 0, 0 };
+    limits_ok = limits_ok &&
+                !cJSON_ParseWithLimits(s_state.hostile_json, sizeof(s_state.hostile_json) - 1, &s_state.json_limits) &&
+                !cJSON_ParseWithLimits(s_state.control_json, s_state.control_json_size, &few_items) &&
+                !cJSON_ParseWithLimits(s_state.control_json, s_state.control_json_size, &short_input);
+
+    // 两种编码必须表达同一条消息
+    linx_control_message_t decoded;
+    char text[256];
+    return limits_ok && s_state.control_cbor_size > 0 &&
+           linx_control_cbor_decode(s_state.control_cbor, s_state.control_cbor_size, &decoded) &&
+           decoded.type == LINX_CONTROL_TYPE_TTS &&
+           linx_control_message_equals(&decoded, LINX_CONTROL_FIELD_STATE, "sentence_start") &&
+           linx_control_message_copy(&decoded, LINX_CONTROL_FIELD_TEXT, text, sizeof(text)) != (size_t)-1 &&
+           strcmp(text, BENCH_CONTROL_TEXT) == 0;
+}
+
+static bool setup_state(void) {
+    for (size_t i = 0; i < sizeof(s_state.payload); i++) {
+        s_state.payload[i] = (uint8_t)(i * 31 + 7);
+    }
+    int header = linx_binary_protocol_encode_header(2, 1234, 0, BENCH_PAYLOAD_BYTES, s_state.frame_v2);
+    memcpy(s_state.frame_v2 + header, s_state.payload, BENCH_PAYLOAD_BYTES);
+    s_state.frame_v2_size = (size_t)header + BENCH_PAYLOAD_BYTES;
+    header = linx_binary_protocol_encode_header(3, 0, 0, BENCH_PAYLOAD_BYTES, s_state.frame_v3);
+    memcpy(s_state.frame_v3 + header, s_state.payload, BENCH_PAYLOAD_BYTES);
+    s_state.frame_v3_size = (size_t)header + BENCH_PAYLOAD_BYTES;
+    header = linx_binary_protocol_encode_header(4, 1234, 42, BENCH_PAYLOAD_BYTES, s_state.frame_v4);
+    memcpy(s_state.frame_v4 + header, s_state.payload, BENCH_PAYLOAD_BYTES);
+    s_state.frame_v4_size = (size_t)header + BENCH_PAYLOAD_BYTES;
+
+    // 载荷前面补一个 60ms SILK 单帧的 TOC，录制时按 TOC 计算样本数
+    memcpy(s_state.opus_packet, s_state.payload, sizeof(s_state.opus_packet));
+    s_state.opus_packet[0] = (uint8_t)(3 << 3);
+    s_state.recorder = linx_ogg_recorder_create("/dev/null", NULL, 0, -1);
+
+    static const uint8_t key[LINX_AES128_KEY_SIZE] = "linx-bench-key16";
+    linx_aes128_init(&s_state.aes, key);
+
+    s_state.pool = linx_audio_packet_pool_create(LINX_AUDIO_PACKET_POOL_DEFAULT_SLOTS,
+                                                 linx_audio_packet_pool_payload_size(BENCH_FRAME_MS));
+
+    linx_jitter_buffer_config_t jitter_config = {
+        .frame_duration_ms = BENCH_FRAME_MS,
+        .target_depth_ms = BENCH_FRAME_MS * 2,
+    };
+    s_state.jitter = linx_jitter_buffer_create(&jitter_config);
+    pthread_mutex_init(&s_state.jitter_mutex, NULL);
+    // 先填到目标深度，之后每次一进一出都处于稳定状态
+    for (int i = 0; i < 2; i++) {
+        s_state.jitter_timestamp += BENCH_FRAME_MS;
+        linx_jitter_buffer_push(s_state.jitter, s_state.payload, sizeof(s_state.payload),
+                                s_state.jitter_timestamp, true, s_state.jitter_now_ms);
+    }
+
+    s_state.timers = linx_timer_wheel_create(0, NULL);
+    for (size_t i = 0; s_state.timers && i < BENCH_TIMERS; i++) {
+        linx_timer_init(&s_state.timer_nodes[i], bench_timer_callback, NULL);
+        op_timer_rearm(i);
+    }
+
+    s_state.history = linx_event_history_create(BENCH_EVENT_HISTORY);
+    s_state.events = linx_event_queue_create(0);
+    if (s_state.events) {
+        linx_event_queue_reserve(s_state.events, 0);
+    }
+    return s_state.pool && s_state.jitter && s_state.events && s_state.history && s_state.recorder && s_state.timers &&
+           setup_history() && setup_control() && setup_json();
+}
+
+static void teardown_state(void) {
+    linx_json_writer_free(&s_state.long_writer);
+    cJSON_Delete(s_state.json_linear);
+    cJSON_Delete(s_state.json_object);
+    linx_ogg_recorder_destroy(s_state.recorder);
+    linx_event_queue_destroy(s_state.events);
+    linx_event_history_destroy(s_state.history);
+    linx_jitter_buffer_destroy(s_state.jitter);
+    pthread_mutex_destroy(&s_state.jitter_mutex);
+    linx_audio_packet_pool_destroy(s_state.pool);
+    linx_timer_wheel_destroy(s_state.timers);
+}
+
+// ==================== 测量 ====================
+
+typedef struct {
+    const char* name;
+    void (*op)(size_t i);
+    bool thread_safe;               // 可以在多个线程上同时运行
+} bench_case_t;
+
+static const bench_case_t s_cases[] = {
+    { "noop",               op_noop,             false },
+    { "header_encode_v2",   op_header_encode_v2, true  },
+    { "header_encode_v3",   op_header_encode_v3, true  },
+    { "header_encode_v4",   op_header_encode_v4, true  },
+    { "frame_decode_v2",    op_frame_decode_v2,  true  },
+    { "frame_decode_v3",    op_frame_decode_v3,  true  },
+    { "frame_decode_v4",    op_frame_decode_v4,  true  },
+    { "packet_create",      op_packet_create,    true  },
+    { "pool_acquire",       op_pool_acquire,     true  },
+    { "pool_retain_view",   op_pool_retain,      true  },
+    { "jitter_push_pop",    op_jitter,           false },
+    { "jitter_locked",      op_jitter_locked,    true  },
+    { "event_queue_audio",  op_event_queue,      true  },
+    { "event_history_text", op_event_history,    true  },
+    { "control_decode_cbor", op_control_decode_cbor, true },
+    { "control_scan_json",  op_control_scan_json, true  },
+    { "control_parse_json", op_control_parse_json, true },
+    { "control_parse_limited", op_control_parse_limited, true },
+    { "json_reject_deep",   op_json_reject_deep, true  },
+    { "json_print_long",    op_json_print_long,  false },
+    { "json_parse_long",    op_json_parse_long,  true  },
+    { "udp_encrypt",        op_udp_encrypt,      true  },
+    { "ogg_record",         op_ogg_record,       true  },
+    { "json_lookup_linear", op_json_lookup_linear, true },
+    { "json_lookup_indexed", op_json_lookup_indexed, true },
+    { "timer_rearm",        op_timer_rearm,      false },
+};
+
+typedef struct {
+    char name[48];
+    double ns_per_op;
+} bench_baseline_t;
+
+typedef struct {
+    const bench_case_t* bench;
+    size_t iterations;
+    pthread_barrier_t* barrier;
+    uint64_t start_ns;              // 由各线程自己记录，主线程可能晚于工作线程被调度
+    uint64_t end_ns;
+    uint64_t start_cycles;
+    uint64_t end_cycles;
+} bench_thread_arg_t;
+
+static void* bench_thread(void* arg) {
+    bench_thread_arg_t* thread_arg = (bench_thread_arg_t*)arg;
+    pthread_barrier_wait(thread_arg->barrier);
+    thread_arg->start_ns = bench_now_ns();
+    thread_arg->start_cycles = bench_cycles();
+    for (size_t i = 0; i < thread_arg->iterations; i++) {
+        thread_arg->bench->op(i);
+    }
+    thread_arg->end_cycles = bench_cycles();
+    thread_arg->end_ns = bench_now_ns();
+    return NULL;
+}
+
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief 运行一项测量，threads 为 1 时在当前线程上运行
+ * @param cycles_per_op 输出每次操作的周期数，无法测量时为负数
+ * @return 中位数耗时（纳秒/次）
+ */
+static double bench_run(const bench_case_t* bench, size_t iterations, int rounds, int threads,
+                        double mhz, double* cycles_per_op) {
+    double ns[BENCH_MAX_ROUNDS];
+    double cycles[BENCH_MAX_ROUNDS];
+
+    // 预热：填充缓存、让内存池和空闲链表进入稳定状态
+    for (size_t i = 0; i < iterations / 10; i++) {
+        bench->op(i);
+    }
+
+    for (int r = 0; r < rounds; r++) {
+        uint64_t elapsed_ns = 0;
+        uint64_t elapsed_cycles = 0;
+        if (threads <= 1) {
+            uint64_t start_ns = bench_now_ns();
+            uint64_t start_cycles = bench_cycles();
+            for (size_t i = 0; i < iterations; i++) {
+                bench->op(i);
+            }
+            elapsed_cycles = bench_cycles() - start_cycles;
+            elapsed_ns = bench_now_ns() - start_ns;
+        } else {
+            // 从最早开始的线程到最晚结束的线程
+            pthread_barrier_t barrier;
+            pthread_t tids[BENCH_MAX_THREADS];
+            bench_thread_arg_t args[BENCH_MAX_THREADS];
+            pthread_barrier_init(&barrier, NULL, (unsigned)threads);
+            for (int t = 0; t < threads; t++) {
+                args[t] = (bench_thread_arg_t){ bench, iterations / (size_t)threads, &barrier, 0, 0, 0, 0 };
+                pthread_create(&tids[t], NULL, bench_thread, &args[t]);
+            }
+            uint64_t first_ns = UINT64_MAX, last_ns = 0, first_cycles = UINT64_MAX, last_cycles = 0;
+            for (int t = 0; t < threads; t++) {
+                pthread_join(tids[t], NULL);
+                first_ns = args[t].start_ns < first_ns ? args[t].start_ns : first_ns;
+                last_ns = args[t].end_ns > last_ns ? args[t].end_ns : last_ns;
+                first_cycles = args[t].start_cycles < first_cycles ? args[t].start_cycles : first_cycles;
+                last_cycles = args[t].end_cycles > last_cycles ? args[t].end_cycles : last_cycles;
+            }
+            pthread_barrier_destroy(&barrier);
+            elapsed_ns = last_ns - first_ns;
+            elapsed_cycles = last_cycles - first_cycles;
+        }
+        ns[r] = (double)elapsed_ns / (double)iterations;
+        cycles[r] = (double)elapsed_cycles / (double)iterations;
+    }
+
+    qsort(ns, (size_t)rounds, sizeof(double), compare_double);
+    qsort(cycles, (size_t)rounds, sizeof(double), compare_double);
+    double median_ns = ns[rounds / 2];
+    if (bench_has_cycle_counter()) {
+        *cycles_per_op = cycles[rounds / 2];
+    } else {
+        *cycles_per_op = mhz > 0 ? median_ns * mhz / 1000.0 : -1.0;
+    }
+    return median_ns;
+}
+
+static size_t load_baseline(const char* path, bench_baseline_t* baseline, size_t max_entries) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "无法打开基线文件: %s\n", path);
+        return 0;
+    }
+    char line[256];
+    size_t count = 0;
+    while (count < max_entries && fgets(line, sizeof(line), file)) {
+        char name[48];
+        double ns_per_op = 0.0;
+        if (sscanf(line, "%47[^,],%lf", name, &ns_per_op) == 2) {
+            snprintf(baseline[count].name, sizeof(baseline[count].name), "%s", name);
+            baseline[count].ns_per_op = ns_per_op;
+            count++;
+        }
+    }
+    fclose(file);
+    return count;
+}
+
+static const bench_baseline_t* find_baseline(const bench_baseline_t* baseline, size_t count, const char* name) {
+    for (size_t i = 0; i < count; i++) {
+        if (strcmp(baseline[i].name, name) == 0) {
+            return &baseline[i];
+        }
+    }
+    return NULL;
+}
+
+static void report(FILE* csv, const char* name, double ns_per_op, double cycles_per_op,
+                   const bench_baseline_t* baseline, size_t baseline_count) {
+    char cycles[32];
+    if (cycles_per_op >= 0) {
+        snprintf(cycles, sizeof(cycles), "%.1f", cycles_per_op);
+    } else {
+        snprintf(cycles, sizeof(cycles), "-");
+    }
+
+    const bench_baseline_t* before = find_baseline(baseline, baseline_count, name);
+    if (before && before->ns_per_op > 0) {
+        printf("%-24s %10.1f %12s %+9.1f%%\n", name, ns_per_op, cycles,
+               (ns_per_op - before->ns_per_op) / before->ns_per_op * 100.0);
+    } else {
+        printf("%-24s %10.1f %12s %10s\n", name, ns_per_op, cycles, "");
+    }
+    if (csv) {
+        fprintf(csv, "%s,%.2f,%.2f\n", name, ns_per_op, cycles_per_op);
+    }
+}
+
+static void usage(const char* program) {
+    printf("用法: %s [-n 每轮次数] [-r 轮数] [-t 线程数] [-f 名称过滤] [-m 主频MHz] [-o 结果.csv] [-b 基线.csv]\n",
+           program);
+    printf("  -n  每轮执行次数 (默认 %d)\n", BENCH_DEFAULT_ITERATIONS);
+    printf("  -r  轮数，取中位数 (默认 %d，最多 %d)\n", BENCH_DEFAULT_ROUNDS, BENCH_MAX_ROUNDS);
+    printf("  -t  额外用 N 个线程并发运行线程安全的项目 (默认不运行，最多 %d)\n", BENCH_MAX_THREADS);
+    printf("  -f  只运行名称包含该字符串的项目\n");
+    printf("  -m  CPU 主频，没有周期计数器的平台据此换算周期数\n");
+    printf("  -o  把结果写入 CSV（名称,纳秒/次,周期/次）\n");
+    printf("  -b  与之前 -o 保存的结果对比，输出耗时变化百分比\n");
+}
+
+int main(int argc, char* argv[]) {
+    size_t iterations = BENCH_DEFAULT_ITERATIONS;
+    int rounds = BENCH_DEFAULT_ROUNDS;
+    int threads = 0;
+    double mhz = 0.0;
+    const char* filter = NULL;
+    const char* output_path = NULL;
+    const char* baseline_path = NULL;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:r:t:f:m:o:b:h")) != -1) {
+        switch (opt) {
+            case 'n': iterations = (size_t)strtoul(optarg, NULL, 10); break;
+            case 'r': rounds = atoi(optarg); break;
+            case 't': threads = atoi(optarg); break;
+            case 'f': filter = optarg; break;
+            case 'm': mhz = atof(optarg); break;
+            case 'o': output_path = optarg; break;
+            case 'b': baseline_path = optarg; break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 2;
+        }
+    }
+    if (iterations < 100 || rounds < 1 || rounds > BENCH_MAX_ROUNDS || threads < 0 || threads > BENCH_MAX_THREADS) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    log_config_t log_config = LOG_DEFAULT_CONFIG;
+    log_config.level = LOG_LEVEL_WARN;
+    log_init(&log_config);
+
+    bench_baseline_t baseline[BENCH_MAX_BASELINE];
+    size_t baseline_count = baseline_path ? load_baseline(baseline_path, baseline, BENCH_MAX_BASELINE) : 0;
+
+    FILE* csv = NULL;
+    if (output_path) {
+        csv = fopen(output_path, "w");
+        if (!csv) {
+            fprintf(stderr, "无法写入结果文件: %s\n", output_path);
+            return 1;
+        }
+    }
+
+    if (!setup_state()) {
+        fprintf(stderr, "初始化被测组件失败\n");
+        teardown_state();
+        if (csv) {
+            fclose(csv);
+        }
+        return 1;
+    }
+
+    printf("微基准: 每轮 %zu 次, %d 轮取中位数, 周期数%s\n", iterations, rounds,
+           bench_has_cycle_counter() ? "来自 TSC" : (mhz > 0 ? "按主频换算" : "不可用"));
+    printf("%-24s %10s %12s %10s\n", "项目", "ns/次", "周期/次", baseline_count ? "变化" : "");
+
+    size_t case_count = sizeof(s_cases) / sizeof(s_cases[0]);
+    for (size_t c = 0; c < case_count; c++) {
+        const bench_case_t* bench = &s_cases[c];
+        if (filter && !strstr(bench->name, filter)) {
+            continue;
+        }
+        double cycles_per_op = -1.0;
+        double ns_per_op = bench_run(bench, iterations, rounds, 1, mhz, &cycles_per_op);
+        report(csv, bench->name, ns_per_op, cycles_per_op, baseline, baseline_count);
+    }
+
+    if (threads > 1) {
+        for (size_t c = 0; c < case_count; c++) {
+            const bench_case_t* bench = &s_cases[c];
+            if (!bench->thread_safe || (filter && !strstr(bench->name, filter))) {
+                continue;
+            }
+            char name[48];
+            snprintf(name, sizeof(name), "%s@%dt", bench->name, threads);
+            double cycles_per_op = -1.0;
+            double ns_per_op = bench_run(bench, iterations, rounds, threads, mhz, &cycles_per_op);
+            report(csv, name, ns_per_op, cycles_per_op, baseline, baseline_count);
+        }
+    }
+
+    teardown_state();
+    if (csv) {
+        fclose(csv);
+    }
+    log_cleanup();
+    return 0;
+}
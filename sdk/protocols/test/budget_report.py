@@ -0,0 +1,365 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+各板级配置的 CPU / 内存预算报告
+
+合并两类数据：
+- 静态 RAM/Flash：从链接 map 文件按模块汇总（GNU ld -Map 与 macOS ld64 -map 两种格式）
+- 运行期：bench_loopback -C <配置> -b <json> 输出的堆峰值、线程栈高水位和各阶段 CPU
+
+用法:
+  budget_report.py --map build/budget/bench_loopback.map build/budget/runtime_*.json
+  budget_report.py --map build/budget/bench_loopback.map --map ESP32=firmware.map \\
+                   -o report.md --json report.json runtime_ESP32.json runtime_Ubuntu.json
+
+不带配置名的 --map 用于所有配置；NAME=FILE 形式只用于名为 NAME 的配置（如板子固件的 map），
+这样主机上跑出的运行期数据可以和真实固件的静态占用放在一起比较。
+"""
+
+import argparse
+import json
+import os
+import re
+import sys
+from typing import Dict, List, Optional, Tuple
+
+# SDK 目录名 -> 模块名（与 linx_alloc 的模块名一致）
+MODULE_DIRS = {
+    "protocols": "protocol",
+    "cjson": "json",
+    "log": "log",
+    "os": "os",
+    "mcp": "mcp",
+    "codecs": "codec",
+    "audio": "audio",
+    "play": "play",
+    "ota": "ota",
+    "camera": "camera",
+    "board": "board",
+}
+
+# 静态库名中的关键字 -> 模块名
+ARCHIVE_MODULES = {
+    "mongoose": "mongoose",
+    "opus": "opus",
+    "lvgl": "lvgl",
+    "linx_sdk": None,   # SDK 静态库：按成员文件名再判断
+}
+
+# 段名前缀 -> (占 Flash, 占 RAM)
+SECTION_CLASSES = [
+    ((".text", ".literal", ".rodata", ".srodata", ".flash.", ".irom", ".init", ".fini",
+      ".eh_frame", ".gcc_except_table", ".ctors", ".dtors", ".init_array", ".fini_array"), (True, False)),
+    ((".data", ".sdata", ".tdata", ".dram0.data", ".iram1", ".iram0"), (True, True)),
+    ((".bss", ".sbss", ".tbss", "COMMON", ".dram0.bss", ".noinit"), (False, True)),
+]
+
+STAGE_ORDER = ["network", "dispatch", "playback", "capture", "mcp", "log", "other"]
+
+
+def fmt_bytes(value: int) -> str:
+    if value >= 1024 * 1024:
+        return f"{value / (1024 * 1024):.1f} MiB"
+    if value >= 1024:
+        return f"{value / 1024:.1f} KiB"
+    return f"{value} B"
+
+
+def classify_section(name: str) -> Optional[Tuple[bool, bool]]:
+    for prefixes, result in SECTION_CLASSES:
+        if name.startswith(prefixes):
+            return result
+    return None
+
+
+def module_of(path: str) -> str:
+    """由目标文件路径（或 libfoo.a(member.o)）判断所属模块"""
+    path = path.strip().replace("\\", "/")
+    member = None
+    archive_match = re.match(r"(.*)\((.*)\)$", path)
+    if archive_match:
+        path, member = archive_match.group(1), archive_match.group(2)
+        archive = os.path.basename(path)
+        for key, module in ARCHIVE_MODULES.items():
+            if key in archive:
+                if module:
+                    return module
+                return module_of(member)
+        return "system"
+
+    parts = [p for p in path.split("/") if p]
+    # 从后往前找第一个 SDK 模块目录，兼容 CMake 的 CMakeFiles/xxx.dir/sdk/protocols/x.c.o
+    for part in reversed(parts[:-1]):
+        if part in MODULE_DIRS:
+            return MODULE_DIRS[part]
+        if part in ("mongoose", "opus", "liblvgl"):
+            return part.replace("lib", "")
+    name = parts[-1] if parts else path
+    if name.startswith("linx_"):
+        return "core"
+    if name.startswith(("bench_", "replay_", "example_", "main")):
+        return "app"
+    if name.startswith(("crt", "lib")) or path.startswith("/usr/"):
+        return "system"
+    return "other"
+
+
+def parse_gnu_map(lines: List[str]) -> Dict[str, Dict[str, int]]:
+    """GNU ld -Map：统计 "Linker script and memory map" 之后的输入段"""
+    modules: Dict[str, Dict[str, int]] = {}
+    in_memory_map = False
+    pending = None
+    entry = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+    named = re.compile(r"^ (\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+
+    for line in lines:
+        line = line.rstrip("\n")
+        if line.startswith("Linker script and memory map"):
+            in_memory_map = True
+            continue
+        if not in_memory_map:
+            continue
+
+        section, size, path = None, 0, None
+        m = named.match(line)
+        if m:
+            section, size, path = m.group(1), int(m.group(3), 16), m.group(4)
+        elif pending:
+            m = entry.match(line)
+            if m:
+                section, size, path = pending, int(m.group(2), 16), m.group(3)
+            pending = None
+        if not section:
+            # 段名过长时单独占一行，地址和大小在下一行
+            m = re.match(r"^ (\S+)$", line)
+            if m and not m.group(1).startswith("0x"):
+                pending = m.group(1)
+            continue
+        if size == 0 or section == "*fill*":
+            continue
+        cls = classify_section(section)
+        if not cls:
+            continue
+        stats = modules.setdefault(module_of(path), {"flash": 0, "ram": 0})
+        if cls[0]:
+            stats["flash"] += size
+        if cls[1]:
+            stats["ram"] += size
+    return modules
+
+
+def parse_ld64_map(lines: List[str]) -> Dict[str, Dict[str, int]]:
+    """macOS ld64 -map：按符号所在段和所属目标文件统计"""
+    objects: Dict[int, str] = {}
+    sections: List[Tuple[int, int, str, str]] = []
+    modules: Dict[str, Dict[str, int]] = {}
+    part = None
+
+    for line in lines:
+        line = line.rstrip("\n")
+        if line.startswith("# Object files:"):
+            part = "objects"
+            continue
+        if line.startswith("# Sections:"):
+            part = "sections"
+            continue
+        if line.startswith("# Symbols:"):
+            part = "symbols"
+            continue
+        if line.startswith("#") or not line.strip():
+            continue
+
+        if part == "objects":
+            m = re.match(r"^\[\s*(\d+)\]\s+(.*)$", line)
+            if m:
+                objects[int(m.group(1))] = m.group(2)
+        elif part == "sections":
+            fields = line.split()
+            if len(fields) >= 4:
+                sections.append((int(fields[0], 16), int(fields[1], 16), fields[2], fields[3]))
+        elif part == "symbols":
+            m = re.match(r"^0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+\[\s*(\d+)\]", line)
+            if not m:
+                continue
+            address, size, index = int(m.group(1), 16), int(m.group(2), 16), int(m.group(3))
+            segment = section = None
+            for start, length, seg, sect in sections:
+                if start <= address < start + length:
+                    segment, section = seg, sect
+                    break
+            if not segment or segment == "__PAGEZERO" or size == 0:
+                continue
+            stats = modules.setdefault(module_of(objects.get(index, "linker synthesized")), {"flash": 0, "ram": 0})
+            if segment == "__TEXT":
+                stats["flash"] += size
+            elif section in ("__bss", "__common", "__thread_bss"):
+                stats["ram"] += size
+            else:
+                stats["flash"] += size
+                stats["ram"] += size
+    return modules
+
+
+def parse_map(path: str) -> Dict[str, Dict[str, int]]:
+    with open(path, "r", encoding="utf-8", errors="replace") as f:
+        lines = f.readlines()
+    if any(line.startswith("# Object files:") for line in lines[:50]):
+        return parse_ld64_map(lines)
+    return parse_gnu_map(lines)
+
+
+def select_run(runtime: Dict) -> Optional[Dict]:
+    """取最后一个有预算数据的轮次（一般只运行一个协议版本）"""
+    runs = [run for run in runtime.get("runs", []) if run.get("budget")]
+    return runs[-1] if runs else None
+
+
+def config_summary(config: Optional[Dict]) -> str:
+    if not config:
+        return "（未指定板级配置）"
+    items = config.get("items", {})
+    keys = [k for k in sorted(items) if k.startswith("CONFIG_ENABLE_") or k in
+            ("CONFIG_NETWORK_BUFFER_SIZE", "CONFIG_NETWORK_BUFFER_MAX", "CONFIG_MAX_CONNECTIONS", "CONFIG_LOG_LEVEL", "CONFIG_ARCH")]
+    return " ".join(f"{k}={items[k]}" for k in keys)
+
+
+def build_entry(runtime: Dict, static: Optional[Dict[str, Dict[str, int]]], map_path: Optional[str]) -> Dict:
+    config = runtime.get("config")
+    run = select_run(runtime)
+    budget = run["budget"] if run else {}
+    threads = budget.get("threads", [])
+    heap = budget.get("heap", {})
+
+    static_flash = sum(m["flash"] for m in static.values()) if static else 0
+    static_ram = sum(m["ram"] for m in static.values()) if static else 0
+    stack_reserved = sum(t.get("stack_used", 0) for t in threads)
+    streams = run.get("streams", 0) if run else 0
+    return {
+        "name": config.get("name") if config else "default",
+        "description": config.get("items", {}).get("CONFIG_DESCRIPTION", "") if config else "",
+        "config": config,
+        "audio_format": runtime.get("audio_format"),
+        "map": map_path,
+        "static": static or {},
+        "run": {k: v for k, v in (run or {}).items() if k != "budget"},
+        "heap": heap,
+        "stages": budget.get("stages", {}),
+        "threads": threads,
+        "totals": {
+            "static_flash": static_flash,
+            "static_ram": static_ram,
+            "heap_peak": heap.get("peak", 0),
+            "stack_used": stack_reserved,
+            # 静态 RAM + 堆峰值 + 各线程栈高水位，是这组功能需要的 RAM 下限
+            "ram_estimate": static_ram + heap.get("peak", 0) + stack_reserved,
+            "cpu_permille": sum(s.get("cpu_permille", 0) for s in budget.get("stages", {}).values()),
+            "streams": streams,
+        },
+    }
+
+
+def render_markdown(entries: List[Dict]) -> str:
+    out = ["# 资源预算报告", ""]
+    out.append("| 配置 | 格式 | 路数 | 静态 Flash | 静态 RAM | 堆峰值 | 栈高水位合计 | RAM 估计 | CPU (%核) |")
+    out.append("|---|---|---:|---:|---:|---:|---:|---:|---:|")
+    for e in entries:
+        t = e["totals"]
+        out.append(f"| {e['name']} | {e['audio_format']} | {t['streams']} | {fmt_bytes(t['static_flash'])} | "
+                   f"{fmt_bytes(t['static_ram'])} | {fmt_bytes(t['heap_peak'])} | {fmt_bytes(t['stack_used'])} | "
+                   f"{fmt_bytes(t['ram_estimate'])} | {t['cpu_permille'] / 10:.1f} |")
+    out.append("")
+    out.append("RAM 估计 = 静态 RAM + 堆峰值 + 各线程栈高水位；CPU 为统计窗口内占单核的百分比，"
+               "运行期数据来自主机上的回环基准。")
+
+    for e in entries:
+        out += ["", f"## {e['name']}" + (f" — {e['description']}" if e["description"] else ""), ""]
+        out.append(f"配置: {config_summary(e['config'])}")
+        run = e["run"]
+        if run:
+            out.append(f"运行: 协议 v{run.get('version')}, {run.get('streams')} 路, {e['audio_format']}, "
+                       f"p50 {run.get('p50_ms', 0):.1f} ms, p99 {run.get('p99_ms', 0):.1f} ms")
+
+        if e["static"]:
+            out += ["", f"### 静态占用（{os.path.basename(e['map'])}）", "",
+                    "| 模块 | Flash | RAM (data+bss) |", "|---|---:|---:|"]
+            for name, m in sorted(e["static"].items(), key=lambda kv: -(kv[1]["flash"] + kv[1]["ram"])):
+                out.append(f"| {name} | {fmt_bytes(m['flash'])} | {fmt_bytes(m['ram'])} |")
+
+        modules = e["heap"].get("modules", {})
+        if modules:
+            out += ["", f"### 堆（峰值 {fmt_bytes(e['heap'].get('peak', 0))}）", "",
+                    "| 模块 | 峰值时占用 | 模块自身峰值 |", "|---|---:|---:|"]
+            for name, m in sorted(modules.items(), key=lambda kv: -kv[1].get("at_peak", 0)):
+                out.append(f"| {name} | {fmt_bytes(m.get('at_peak', 0))} | {fmt_bytes(m.get('peak', 0))} |")
+
+        if e["stages"]:
+            out += ["", "### 流水线阶段", "", "| 阶段 | 线程 | CPU (%核) | 最大栈高水位 |", "|---|---:|---:|---:|"]
+            for name in STAGE_ORDER:
+                s = e["stages"].get(name)
+                if s:
+                    out.append(f"| {name} | {s['threads']} | {s['cpu_permille'] / 10:.1f} | {fmt_bytes(s['stack_max'])} |")
+
+        if e["threads"]:
+            out += ["", "### 线程", "", "| 线程 | 阶段 | 栈大小 | 栈高水位 | CPU (%核) |", "|---|---|---:|---:|---:|"]
+            for t in e["threads"]:
+                used = fmt_bytes(t["stack_used"]) + ("+" if t.get("stack_saturated") else "")
+                out.append(f"| {t['name']} | {t['stage']} | {fmt_bytes(t['stack_size'])} | {used} | "
+                           f"{t['cpu_permille'] / 10:.1f} |")
+    out.append("")
+    return "\n".join(out)
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="各板级配置的 CPU/内存预算报告")
+    parser.add_argument("runtime", nargs="+", help="bench_loopback -b 输出的 JSON")
+    parser.add_argument("--map", action="append", default=[],
+                        help="链接 map 文件；NAME=FILE 只用于名为 NAME 的配置")
+    parser.add_argument("-o", "--output", help="Markdown 报告输出路径（默认打印到标准输出）")
+    parser.add_argument("--json", help="合并后的 JSON 输出路径")
+    args = parser.parse_args()
+
+    default_map = None
+    board_maps: Dict[str, str] = {}
+    for item in args.map:
+        name, sep, path = item.partition("=")
+        if sep and not os.path.exists(item):
+            board_maps[name] = path
+        else:
+            default_map = item
+
+    parsed: Dict[str, Dict[str, Dict[str, int]]] = {}
+    entries = []
+    for path in args.runtime:
+        try:
+            with open(path, "r", encoding="utf-8") as f:
+                runtime = json.load(f)
+        except (OSError, ValueError) as e:
+            print(f"读取运行期数据失败 {path}: {e}", file=sys.stderr)
+            return 1
+        config = runtime.get("config") or {}
+        map_path = board_maps.get(config.get("name", ""), default_map)
+        static = None
+        if map_path:
+            if map_path not in parsed:
+                try:
+                    parsed[map_path] = parse_map(map_path)
+                except OSError as e:
+                    print(f"读取 map 文件失败 {map_path}: {e}", file=sys.stderr)
+                    return 1
+            static = parsed[map_path]
+        entries.append(build_entry(runtime, static, map_path))
+
+    report = render_markdown(entries)
+    if args.output:
+        with open(args.output, "w", encoding="utf-8") as f:
+            f.write(report)
+    else:
+        print(report)
+    if args.json:
+        with open(args.json, "w", encoding="utf-8") as f:
+            json.dump(entries, f, ensure_ascii=False, indent=2)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+PGO + LTO 优化前后的对照报告
+
+输入两次回环基准的运行期数据（bench_loopback -b 输出的 JSON）：一次链接普通编译的 SDK，
+一次链接 PGO + LTO 编译的 SDK（见 linxos.py optimize）。输出：
+- 各协议版本的每路 CPU 和时延
+- 各流水线阶段（网络、派发、播放、采集…）的 CPU 及加速比
+- 给出 map 文件时，各模块代码量的变化（PGO 会内联热路径、把冷代码移走，代码量可能增减）
+
+用法:
+  pgo_report.py --base runtime_base.json --pgo runtime_pgo.json \\
+                --base-map base.map --pgo-map pgo.map -o pgo_report.md --json pgo_report.json
+"""
+
+import argparse
+import json
+import sys
+from typing import Dict, List, Optional
+
+from budget_report import STAGE_ORDER, fmt_bytes, parse_map
+
+
+def load_json(path: str) -> Optional[Dict]:
+    try:
+        with open(path, "r", encoding="utf-8") as f:
+            return json.load(f)
+    except (OSError, ValueError) as e:
+        print(f"读取运行期数据失败 {path}: {e}", file=sys.stderr)
+        return None
+
+
+def speedup(base: float, optimized: float) -> Optional[float]:
+    return base / optimized if base > 0 and optimized > 0 else None
+
+
+def fmt_speedup(value: Optional[float]) -> str:
+    return f"{value:.2f}x" if value is not None else "-"
+
+
+def compare_runs(base: Dict, pgo: Dict) -> List[Dict]:
+    """按协议版本配对两次运行"""
+    pgo_runs = {run.get("version"): run for run in pgo.get("runs", [])}
+    rows = []
+    for run in base.get("runs", []):
+        other = pgo_runs.get(run.get("version"))
+        if not other:
+            continue
+        rows.append({
+            "version": run.get("version"),
+            "streams": run.get("streams", 0),
+            "base_cpu": run.get("cpu_percent_per_stream", 0.0),
+            "pgo_cpu": other.get("cpu_percent_per_stream", 0.0),
+            "base_p99_ms": run.get("p99_ms", 0.0),
+            "pgo_p99_ms": other.get("p99_ms", 0.0),
+            "speedup": speedup(run.get("cpu_percent_per_stream", 0.0), other.get("cpu_percent_per_stream", 0.0)),
+        })
+    return rows
+
+
+def stage_totals(runtime: Dict) -> Dict[str, int]:
+    """各阶段 CPU（‰核）在所有轮次上求和，减小单轮的波动"""
+    totals: Dict[str, int] = {}
+    for run in runtime.get("runs", []):
+        for name, stage in ((run.get("budget") or {}).get("stages") or {}).items():
+            totals[name] = totals.get(name, 0) + stage.get("cpu_permille", 0)
+    return totals
+
+
+def compare_stages(base: Dict, pgo: Dict) -> List[Dict]:
+    base_stages = stage_totals(base)
+    pgo_stages = stage_totals(pgo)
+    names = [n for n in STAGE_ORDER if n in base_stages or n in pgo_stages]
+    names += sorted(n for n in set(base_stages) | set(pgo_stages) if n not in names)
+    return [{
+        "stage": name,
+        "base_permille": base_stages.get(name, 0),
+        "pgo_permille": pgo_stages.get(name, 0),
+        "speedup": speedup(base_stages.get(name, 0), pgo_stages.get(name, 0)),
+    } for name in names]
+
+
+def compare_modules(base_map: Optional[str], pgo_map: Optional[str]) -> List[Dict]:
+    if not base_map or not pgo_map:
+        return []
+    base_static = parse_map(base_map)
+    pgo_static = parse_map(pgo_map)
+    rows = []
+    for name in sorted(set(base_static) | set(pgo_static)):
+        before = base_static.get(name, {}).get("flash", 0)
+        after = pgo_static.get(name, {}).get("flash", 0)
+        rows.append({"module": name, "base_flash": before, "pgo_flash": after})
+    rows.sort(key=lambda r: -max(r["base_flash"], r["pgo_flash"]))
+    return rows
+
+
+def render_markdown(runs: List[Dict], stages: List[Dict], modules: List[Dict]) -> str:
+    out = ["# PGO + LTO 优化报告", ""]
+    out += ["## 端到端", "", "| 协议 | 路数 | 每路 CPU（优化前） | 每路 CPU（优化后） | 加速比 | p99 前/后 (ms) |",
+            "|---|---:|---:|---:|---:|---:|"]
+    for r in runs:
+        out.append(f"| v{r['version']} | {r['streams']} | {r['base_cpu']:.2f}% | {r['pgo_cpu']:.2f}% | "
+                   f"{fmt_speedup(r['speedup'])} | {r['base_p99_ms']:.1f} / {r['pgo_p99_ms']:.1f} |")
+
+    if stages:
+        out += ["", "## 流水线阶段", "",
+                "CPU 为各轮稳态统计窗口内占单核的千分比之和；编解码计入采集和播放阶段，"
+                "WebSocket 收发和协议解析计入网络阶段。", "",
+                "| 阶段 | 优化前 (‰核) | 优化后 (‰核) | 加速比 |", "|---|---:|---:|---:|"]
+        for s in stages:
+            out.append(f"| {s['stage']} | {s['base_permille']} | {s['pgo_permille']} | {fmt_speedup(s['speedup'])} |")
+
+    if modules:
+        out += ["", "## 模块代码量", "", "| 模块 | 优化前 | 优化后 | 变化 |", "|---|---:|---:|---:|"]
+        for m in modules:
+            delta = m["pgo_flash"] - m["base_flash"]
+            pct = f"{delta / m['base_flash'] * 100:+.1f}%" if m["base_flash"] else "-"
+            out.append(f"| {m['module']} | {fmt_bytes(m['base_flash'])} | {fmt_bytes(m['pgo_flash'])} | {pct} |")
+    out.append("")
+    return "\n".join(out)
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="PGO + LTO 优化前后的对照报告")
+    parser.add_argument("--base", required=True, help="普通编译的回环基准输出（bench_loopback -b）")
+    parser.add_argument("--pgo", required=True, help="PGO + LTO 编译的回环基准输出")
+    parser.add_argument("--base-map", help="普通编译的链接 map 文件")
+    parser.add_argument("--pgo-map", help="PGO + LTO 编译的链接 map 文件")
+    parser.add_argument("-o", "--output", help="Markdown 报告输出路径（默认打印到标准输出）")
+    parser.add_argument("--json", help="JSON 输出路径")
+    args = parser.parse_args()
+
+    base = load_json(args.base)
+    pgo = load_json(args.pgo)
+    if base is None or pgo is None:
+        return 1
+
+    runs = compare_runs(base, pgo)
+    stages = compare_stages(base, pgo)
+    try:
+        modules = compare_modules(args.base_map, args.pgo_map)
+    except OSError as e:
+        print(f"读取 map 文件失败: {e}", file=sys.stderr)
+        return 1
+
+    report = render_markdown(runs, stages, modules)
+    if args.output:
+        with open(args.output, "w", encoding="utf-8") as f:
+            f.write(report)
+    else:
+        print(report)
+    if args.json:
+        with open(args.json, "w", encoding="utf-8") as f:
+            json.dump({"runs": runs, "stages": stages, "modules": modules}, f, ensure_ascii=False, indent=2)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,313 @@
+/**
+ * @file replay_session.c
+ * @brief 录制会话回放基准
+ *
+ * 读取 LinxSdkConfig::capture_path 录制的 WebSocket 会话文件，以回放模式驱动完整的 LinxSdk
+ * （不连接网络）：服务端消息按录制时间戳、经与真实连接相同的解析和派发路径送达，下行音频
+ * 交给使用 audio_stub 的播放器解码。这样线上复现的时延问题可以离线重复运行，也可以单独
+ * 剖析 SDK 自身的 CPU 开销。
+ *
+ * 每轮输出墙钟时间、CPU 时间、回放记录数、SDK 发出与录制时发出的消息数、回放延迟
+ * 以及下行解码和 TTS 首帧到播出的分位数。指定 -t 时 CPU 时间中位数超过阈值则以非零状态退出。
+ *
+ * 用法: replay_session -i 录制文件 [-x 速度] [-n 轮数] [-c 回放输出录制文件] [-t CPU阈值毫秒] [-P] [-w 超时秒数]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <stdbool.h>
+#include <time.h>
+#include <sys/resource.h>
+#include "linx_log.h"
+#include "linx_sdk.h"
+#include "linx_ws_capture.h"
+#include "audio/audio_stub.h"
+#include "codecs/opus_codec.h"
+#include "play/linx_player.h"
+
+#define REPLAY_SAMPLE_RATE      16000
+#define REPLAY_CHANNELS         1
+#define REPLAY_FRAME_MS         20
+#define REPLAY_FRAME_SAMPLES    (REPLAY_SAMPLE_RATE * REPLAY_FRAME_MS / 1000)
+#define REPLAY_MAX_ROUNDS       32
+
+typedef struct {
+    const char* input;          // 录制文件
+    const char* capture;        // 回放时再录制一份输出，便于与原始录制比对
+    float speed;                // 回放速度，<=0 为尽快回放
+    int rounds;                 // 回放轮数
+    double cpu_limit_ms;        // CPU 时间中位数阈值，0 为不检查
+    bool use_player;            // 下行音频交给播放器解码
+    int timeout_s;              // 单轮超时
+} replay_options_t;
+
+typedef struct {
+    double wall_ms;
+    double cpu_ms;
+    LinxReplayStats stats;
+    linx_metrics_snapshot_t metrics;
+} replay_result_t;
+
+/**
+ * @brief 回放会话：桩音频设备、解码器、播放器和 SDK
+ */
+typedef struct {
+    AudioInterface* audio;
+    audio_codec_t* decoder;
+    linx_player_t* player;
+    LinxSdk* sdk;
+    int protocol_version;
+} replay_session_t;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1e6;
+}
+
+static double cpu_ms(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (double)usage.ru_utime.tv_sec * 1000.0 + usage.ru_utime.tv_usec / 1000.0 +
+           (double)usage.ru_stime.tv_sec * 1000.0 + usage.ru_stime.tv_usec / 1000.0;
+}
+
+static void session_event_callback(const LinxEvent* event, void* user_data) {
+    replay_session_t* session = (replay_session_t*)user_data;
+    if (event->type != LINX_EVENT_AUDIO_DATA || !session->player) {
+        return;
+    }
+
+    const linx_audio_stream_packet_t* packet = event->data.audio_data.value;
+    linx_player_feed_packet(session->player, packet->payload, packet->payload_size,
+                            packet->timestamp, linx_binary_protocol_has_timestamp(session->protocol_version));
+}
+
+static void session_destroy(replay_session_t* session) {
+    if (session->sdk) {
+        linx_sdk_destroy(session->sdk);
+    }
+    if (session->player) {
+        linx_player_stop(session->player);
+        linx_player_destroy(session->player);
+    }
+    if (session->decoder) {
+        audio_codec_destroy(session->decoder);
+    }
+    if (session->audio) {
+        audio_interface_destroy(session->audio);
+        free(session->audio);
+    }
+    memset(session, 0, sizeof(*session));
+}
+
+static bool session_create(replay_session_t* session, const replay_options_t* options, int protocol_version) {
+    memset(session, 0, sizeof(*session));
+    session->protocol_version = protocol_version;
+
+    if (options->use_player) {
+        session->audio = audio_stub_create();
+        if (!session->audio || audio_interface_init(session->audio) != 0) {
+            goto fail;
+        }
+        audio_interface_set_config(session->audio, REPLAY_SAMPLE_RATE, REPLAY_FRAME_SAMPLES, REPLAY_CHANNELS,
+                                   4, 8192, 2048);
+        if (audio_interface_init_play(session->audio) != 0) {
+            goto fail;
+        }
+
+        audio_format_t format = {0};
+        audio_format_init(&format, REPLAY_SAMPLE_RATE, REPLAY_CHANNELS, 16, REPLAY_FRAME_MS);
+        session->decoder = opus_codec_create();
+        if (!session->decoder || audio_codec_init_decoder(session->decoder, &format) != CODEC_SUCCESS) {
+            goto fail;
+        }
+
+        session->player = linx_player_create(session->audio, session->decoder);
+        player_audio_config_t player_config = {
+            .sample_rate = REPLAY_SAMPLE_RATE,
+            .channels = REPLAY_CHANNELS,
+            .frame_size = REPLAY_FRAME_SAMPLES,
+            .buffer_size = 8192,
+            .conceal_loss = true,
+        };
+        if (!session->player || linx_player_init(session->player, &player_config) != PLAYER_SUCCESS ||
+            linx_player_start(session->player) != PLAYER_SUCCESS) {
+            goto fail;
+        }
+    }
+
+    // 回放模式不连接网络，服务器地址只需非空
+    LinxSdkConfig config = {0};
+    snprintf(config.server_url, sizeof(config.server_url), "ws://replay.invalid/");
+    snprintf(config.audio_format, sizeof(config.audio_format), "opus");
+    snprintf(config.device_id, sizeof(config.device_id), "replay-device");
+    snprintf(config.client_id, sizeof(config.client_id), "replay-client");
+    snprintf(config.replay_path, sizeof(config.replay_path), "%s", options->input);
+    if (options->capture) {
+        snprintf(config.capture_path, sizeof(config.capture_path), "%s", options->capture);
+    }
+    config.replay_speed = options->speed;
+    config.sample_rate = REPLAY_SAMPLE_RATE;
+    config.channels = REPLAY_CHANNELS;
+    config.timeout_ms = 5000;
+    config.protocol_version = protocol_version;
+    config.listening_mode = LINX_LISTENING_MODE_REALTIME;
+    session->sdk = linx_sdk_create(&config);
+    if (!session->sdk) {
+        goto fail;
+    }
+    if (session->player) {
+        linx_sdk_set_player(session->sdk, session->player);
+    }
+    linx_sdk_set_event_callback(session->sdk, session_event_callback, session);
+    return true;
+
+fail:
+    session_destroy(session);
+    return false;
+}
+
+/**
+ * @brief 回放一轮：从连接开始计时，到文件回放完毕为止
+ */
+static bool run_round(const replay_options_t* options, int protocol_version, replay_result_t* result) {
+    replay_session_t session;
+    memset(result, 0, sizeof(*result));
+
+    if (!session_create(&session, options, protocol_version)) {
+        fprintf(stderr, "回放会话创建失败\n");
+        return false;
+    }
+
+    double wall_start = now_ms();
+    double cpu_start = cpu_ms();
+    bool ok = linx_sdk_connect(session.sdk) == LINX_SDK_SUCCESS;
+    double deadline = wall_start + options->timeout_s * 1000.0;
+    while (ok) {
+        if (linx_sdk_get_replay_stats(session.sdk, &result->stats) != LINX_SDK_SUCCESS) {
+            ok = false;
+            break;
+        }
+        if (result->stats.finished) {
+            break;
+        }
+        if (now_ms() > deadline) {
+            fprintf(stderr, "回放超时 (%d 秒)\n", options->timeout_s);
+            ok = false;
+            break;
+        }
+        usleep(5 * 1000);
+    }
+    if (session.player) {
+        // 等播放器把已收到的音频放完，解码开销计入本轮
+        while (ok && linx_player_get_buffer_usage(session.player) > 0.0f && now_ms() < deadline) {
+            usleep(5 * 1000);
+        }
+    }
+    result->cpu_ms = cpu_ms() - cpu_start;
+    result->wall_ms = now_ms() - wall_start;
+
+    linx_sdk_get_metrics(session.sdk, &result->metrics);
+    session_destroy(&session);
+    return ok;
+}
+
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static void usage(const char* program) {
+    printf("用法: %s -i 录制文件 [-x 速度] [-n 轮数] [-c 输出录制文件] [-t CPU阈值毫秒] [-P] [-w 超时秒数]\n", program);
+    printf("  -i  LinxSdkConfig::capture_path 录制的会话文件\n");
+    printf("  -x  回放速度倍数，1 为录制节奏，0 为尽快回放 (默认 1)\n");
+    printf("  -n  回放轮数，报告 CPU 时间中位数 (默认 1，最多 %d)\n", REPLAY_MAX_ROUNDS);
+    printf("  -c  把回放时的收发再录制到该文件，便于与原始录制比对\n");
+    printf("  -t  CPU 时间中位数阈值，毫秒；超过时退出码为 1 (默认不检查)\n");
+    printf("  -P  不解码下行音频，只剖析协议和 SDK\n");
+    printf("  -w  单轮超时，秒 (默认 600)\n");
+}
+
+int main(int argc, char* argv[]) {
+    replay_options_t options = {
+        .speed = 1.0f,
+        .rounds = 1,
+        .use_player = true,
+        .timeout_s = 600,
+    };
+
+    int opt;
+    while ((opt = getopt(argc, argv, "i:x:n:c:t:Pw:h")) != -1) {
+        switch (opt) {
+            case 'i': options.input = optarg; break;
+            case 'x': options.speed = (float)atof(optarg); break;
+            case 'n': options.rounds = atoi(optarg); break;
+            case 'c': options.capture = optarg; break;
+            case 't': options.cpu_limit_ms = atof(optarg); break;
+            case 'P': options.use_player = false; break;
+            case 'w': options.timeout_s = atoi(optarg); break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 2;
+        }
+    }
+    if (!options.input || options.rounds < 1 || options.rounds > REPLAY_MAX_ROUNDS || options.timeout_s < 1) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    log_config_t log_config = LOG_DEFAULT_CONFIG;
+    log_config.level = LOG_LEVEL_WARN;
+    log_init(&log_config);
+
+    // 二进制帧按录制时的协议版本解析
+    linx_ws_replay_t* probe = linx_ws_replay_open(options.input);
+    if (!probe) {
+        fprintf(stderr, "无法读取录制文件: %s\n", options.input);
+        log_cleanup();
+        return 1;
+    }
+    int protocol_version = linx_ws_replay_get_protocol_version(probe);
+    linx_ws_replay_close(probe);
+
+    printf("会话回放: %s, 协议 v%d, 速度 %s, %d 轮\n", options.input, protocol_version,
+           options.speed > 0 ? "按录制节奏缩放" : "尽快", options.rounds);
+    printf("%-4s %10s %10s %8s %8s %8s %10s %10s %10s %10s\n", "轮次", "墙钟(ms)", "CPU(ms)", "记录",
+           "发出", "录制发出", "最大延迟ms", "解码p50us", "解码p99us", "首帧p99us");
+
+    double cpu_samples[REPLAY_MAX_ROUNDS];
+    int exit_code = 0;
+    int completed = 0;
+    for (int i = 0; i < options.rounds; i++) {
+        replay_result_t result;
+        bool ok = run_round(&options, protocol_version, &result);
+        const linx_metrics_histogram_t* decode = &result.metrics.histograms[LINX_METRIC_DECODE_TIME];
+        const linx_metrics_histogram_t* first = &result.metrics.histograms[LINX_METRIC_TTS_TO_PLAYBACK];
+        printf("%-4d %10.1f %10.1f %8llu %8llu %8llu %10.1f %10u %10u %10u\n", i + 1, result.wall_ms,
+               result.cpu_ms, (unsigned long long)result.stats.records,
+               (unsigned long long)result.stats.outbound, (unsigned long long)result.stats.recorded_outbound,
+               result.stats.max_lag_us / 1000.0, linx_metrics_histogram_percentile(decode, 50),
+               linx_metrics_histogram_percentile(decode, 99), linx_metrics_histogram_percentile(first, 99));
+        if (!ok) {
+            exit_code = 1;
+            continue;
+        }
+        cpu_samples[completed++] = result.cpu_ms;
+    }
+
+    if (completed > 0) {
+        qsort(cpu_samples, (size_t)completed, sizeof(double), compare_double);
+        double median = cpu_samples[completed / 2];
+        printf("CPU 时间中位数: %.1f ms (%d 轮)\n", median, completed);
+        if (options.cpu_limit_ms > 0 && median > options.cpu_limit_ms) {
+            fprintf(stderr, "CPU 时间中位数 %.1f ms 超过阈值 %.1f ms\n", median, options.cpu_limit_ms);
+            exit_code = 1;
+        }
+    }
+
+    log_cleanup();
+    return exit_code;
+}
@@ -429,7 +429,9 @@
 /*Demonstrate special features*/
 #define LV_FONT_MONTSERRAT_28_COMPRESSED 0  /*bpp = 3*/
 #define LV_FONT_DEJAVU_16_PERSIAN_HEBREW 0  /*Hebrew, Arabic, Persian letters and all their forms*/
+#ifndef LV_FONT_SIMSUN_16_CJK
 #define LV_FONT_SIMSUN_16_CJK            0  /*1000 most common CJK radicals*/
+#endif
 
 /*Pixel perfect monospace fonts*/
 #define LV_FONT_UNSCII_8  0
@@ -889,8 +891,10 @@
  * DEVICES
  *==================*/
 
-/*Use SDL to open window on PC and handle mouse and keyboard*/
+/*Use SDL to open window on PC and handle mouse and keyboard (headless builds pass -DLV_USE_SDL=0)*/
+#ifndef LV_USE_SDL
 #define LV_USE_SDL              1
+#endif
 #if LV_USE_SDL
     #define LV_SDL_INCLUDE_PATH     <SDL2/SDL.h>
     #define LV_SDL_RENDER_MODE      LV_DISPLAY_RENDER_MODE_DIRECT   /*LV_DISPLAY_RENDER_MODE_DIRECT is recommended for best performance*/
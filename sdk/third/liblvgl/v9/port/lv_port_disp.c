@@ -0,0 +1,255 @@
+/**
+ * @file lv_port_disp.c
+ * Partial-refresh, double-buffered display driver for SPI/RGB panels
+ */
+
+#include "lv_port_disp.h"
+#include "src/display/lv_display_private.h"
+#include "src/draw/sw/lv_draw_sw.h"
+#include <pthread.h>
+#include <string.h>
+
+#define LV_PORT_DISP_DEFAULT_TE_TIMEOUT_MS 20
+
+typedef struct {
+    lv_port_disp_config_t config;
+    void * buf1;
+    void * buf2;
+
+    /* A transfer is in flight between flush_start() and lv_port_disp_flush_done() */
+    volatile bool busy;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+
+    /* Set at the start of every refresh; the first transfer of the frame waits for TE */
+    bool frame_start;
+    bool frame_flushed;
+
+    lv_port_disp_stats_t stats;
+} lv_port_disp_t;
+
+/**
+ * Round `area` outwards to the configured alignment, clipped to the screen
+ */
+static void round_area(const lv_port_disp_t * drv, lv_area_t * area)
+{
+    int32_t a = drv->config.align;
+    if(a <= 1) return;
+
+    area->x1 &= ~(a - 1);
+    area->y1 &= ~(a - 1);
+    area->x2 = ((area->x2 + a) & ~(a - 1)) - 1;
+    area->y2 = ((area->y2 + a) & ~(a - 1)) - 1;
+    if(area->x2 >= drv->config.hor_res) area->x2 = drv->config.hor_res - 1;
+    if(area->y2 >= drv->config.ver_res) area->y2 = drv->config.ver_res - 1;
+}
+
+/**
+ * Merge a new dirty area into a saved one when the bounding box costs at most
+ * `merge_slack` % more pixels than the two areas. LVGL itself only joins areas
+ * whose bounding box is smaller than their sum, so near-by widgets updated in
+ * the same frame (state label, subtitle, ...) would be sent one by one.
+ * The merged box is written back to `area`, which LVGL then finds inside the
+ * saved area and skips.
+ */
+static void merge_area(lv_port_disp_t * drv, lv_display_t * disp, lv_area_t * area)
+{
+    if(drv->config.merge_slack == 0) return;
+
+    uint64_t new_size = lv_area_get_size(area);
+    for(uint32_t i = 0; i < disp->inv_p; i++) {
+        if(disp->inv_area_joined[i]) continue;
+
+        lv_area_t joined;
+        _lv_area_join(&joined, area, &disp->inv_areas[i]);
+        uint64_t sum = new_size + lv_area_get_size(&disp->inv_areas[i]);
+        if(lv_area_get_size(&joined) * 100 <= sum * (100 + drv->config.merge_slack)) {
+            disp->inv_areas[i] = joined;
+            *area = joined;
+            drv->stats.merged++;
+            return;
+        }
+    }
+}
+
+static void disp_event_cb(lv_event_t * e)
+{
+    lv_display_t * disp = lv_event_get_target(e);
+    lv_port_disp_t * drv = lv_display_get_driver_data(disp);
+
+    switch(lv_event_get_code(e)) {
+        case LV_EVENT_INVALIDATE_AREA: {
+                /* Also sent while rendering to round the buffer height; only
+                 * real invalidations are merged */
+                lv_area_t * area = lv_event_get_param(e);
+                round_area(drv, area);
+                if(!disp->rendering_in_progress) merge_area(drv, disp, area);
+                break;
+            }
+        case LV_EVENT_REFR_START:
+            drv->frame_start = true;
+            drv->frame_flushed = false;
+            break;
+        case LV_EVENT_REFR_READY:
+            if(drv->frame_flushed) drv->stats.frames++;
+            break;
+        default:
+            break;
+    }
+}
+
+static void flush_cb(lv_display_t * disp, const lv_area_t * area, uint8_t * px_map)
+{
+    lv_port_disp_t * drv = lv_display_get_driver_data(disp);
+
+    if(drv->config.swap_bytes) {
+        lv_draw_sw_rgb565_swap(px_map, lv_area_get_size(area));
+    }
+
+    if(drv->config.tear_sync && drv->frame_start && drv->config.panel.wait_te) {
+        uint32_t timeout = drv->config.te_timeout_ms ? drv->config.te_timeout_ms : LV_PORT_DISP_DEFAULT_TE_TIMEOUT_MS;
+        if(!drv->config.panel.wait_te(timeout, drv->config.panel.user_data)) {
+            drv->stats.te_timeouts++;
+        }
+    }
+    drv->frame_start = false;
+    drv->frame_flushed = true;
+
+    drv->stats.flushes++;
+    drv->stats.pixels += lv_area_get_size(area);
+    drv->busy = true;
+    drv->config.panel.flush_start(area, px_map, drv->config.panel.user_data);
+}
+
+/**
+ * Block the rendering thread until the in-flight transfer finished
+ */
+static void flush_wait_cb(lv_display_t * disp)
+{
+    lv_port_disp_t * drv = lv_display_get_driver_data(disp);
+
+    if(drv->config.panel.wait_done) {
+        /* A stale wake-up from an earlier transfer only costs another call */
+        while(drv->busy) drv->config.panel.wait_done(drv->config.panel.user_data);
+        return;
+    }
+
+    pthread_mutex_lock(&drv->mutex);
+    while(drv->busy) {
+        pthread_cond_wait(&drv->cond, &drv->mutex);
+    }
+    pthread_mutex_unlock(&drv->mutex);
+}
+
+static void * buf_alloc(lv_port_disp_t * drv, size_t size)
+{
+    if(drv->config.panel.buf_alloc) return drv->config.panel.buf_alloc(size, drv->config.panel.user_data);
+    return lv_malloc(size);
+}
+
+static void buf_free(lv_port_disp_t * drv, void * buf)
+{
+    if(!buf) return;
+    if(drv->config.panel.buf_alloc) drv->config.panel.buf_free(buf, drv->config.panel.user_data);
+    else lv_free(buf);
+}
+
+void lv_port_disp_config_init(lv_port_disp_config_t * config)
+{
+    memset(config, 0, sizeof(*config));
+    config->merge_slack = 25;
+    config->te_timeout_ms = LV_PORT_DISP_DEFAULT_TE_TIMEOUT_MS;
+}
+
+lv_display_t * lv_port_disp_create(const lv_port_disp_config_t * config)
+{
+    if(!config || !config->panel.flush_start || config->hor_res <= 0 || config->ver_res <= 0) {
+        LV_LOG_ERROR("invalid display config");
+        return NULL;
+    }
+    if(config->panel.buf_alloc && !config->panel.buf_free) {
+        LV_LOG_ERROR("buf_alloc requires buf_free");
+        return NULL;
+    }
+
+    lv_port_disp_t * drv = lv_malloc_zeroed(sizeof(lv_port_disp_t));
+    if(!drv) return NULL;
+    drv->config = *config;
+
+    lv_display_t * disp = lv_display_create(config->hor_res, config->ver_res);
+    if(!disp) {
+        lv_free(drv);
+        return NULL;
+    }
+
+    uint32_t lines = config->buf_lines ? config->buf_lines : (uint32_t)config->ver_res / 10;
+    if(lines == 0) lines = 1;
+    if(lines > (uint32_t)config->ver_res) lines = config->ver_res;
+    lv_color_format_t cf = lv_display_get_color_format(disp);
+    uint32_t buf_size = lv_draw_buf_width_to_stride(config->hor_res, cf) * lines;
+
+    drv->buf1 = buf_alloc(drv, buf_size);
+    drv->buf2 = buf_alloc(drv, buf_size);
+    if(!drv->buf1 || !drv->buf2) {
+        LV_LOG_ERROR("failed to allocate %" LV_PRIu32 " byte draw buffers", buf_size);
+        buf_free(drv, drv->buf1);
+        buf_free(drv, drv->buf2);
+        lv_display_delete(disp);
+        lv_free(drv);
+        return NULL;
+    }
+
+    pthread_mutex_init(&drv->mutex, NULL);
+    pthread_cond_init(&drv->cond, NULL);
+
+    lv_display_set_driver_data(disp, drv);
+    lv_display_set_buffers(disp, drv->buf1, drv->buf2, buf_size, LV_DISPLAY_RENDER_MODE_PARTIAL);
+    lv_display_set_flush_cb(disp, flush_cb);
+    lv_display_set_flush_wait_cb(disp, flush_wait_cb);
+    lv_display_add_event_cb(disp, disp_event_cb, LV_EVENT_INVALIDATE_AREA, NULL);
+    lv_display_add_event_cb(disp, disp_event_cb, LV_EVENT_REFR_START, NULL);
+    lv_display_add_event_cb(disp, disp_event_cb, LV_EVENT_REFR_READY, NULL);
+
+    LV_LOG_INFO("display %" LV_PRId32 "x%" LV_PRId32 ", 2 x %" LV_PRIu32 " lines",
+                config->hor_res, config->ver_res, lines);
+    return disp;
+}
+
+void lv_port_disp_delete(lv_display_t * disp)
+{
+    if(!disp) return;
+    lv_port_disp_t * drv = lv_display_get_driver_data(disp);
+
+    /* The panel may still be reading one of the buffers */
+    flush_wait_cb(disp);
+    lv_display_delete(disp);
+
+    buf_free(drv, drv->buf1);
+    buf_free(drv, drv->buf2);
+    pthread_cond_destroy(&drv->cond);
+    pthread_mutex_destroy(&drv->mutex);
+    lv_free(drv);
+}
+
+void lv_port_disp_flush_done(lv_display_t * disp)
+{
+    lv_port_disp_t * drv = lv_display_get_driver_data(disp);
+
+    if(drv->config.panel.wait_done) {
+        drv->busy = false;
+        lv_display_flush_ready(disp);
+        return;
+    }
+
+    pthread_mutex_lock(&drv->mutex);
+    drv->busy = false;
+    lv_display_flush_ready(disp);
+    pthread_cond_signal(&drv->cond);
+    pthread_mutex_unlock(&drv->mutex);
+}
+
+void lv_port_disp_get_stats(lv_display_t * disp, lv_port_disp_stats_t * stats)
+{
+    lv_port_disp_t * drv = lv_display_get_driver_data(disp);
+    *stats = drv->stats;
+}
@@ -0,0 +1,123 @@
+/**
+ * @file lv_port_disp.h
+ * Partial-refresh, double-buffered display driver for SPI/RGB panels
+ *
+ * LVGL renders into one of two partial buffers while the panel driver
+ * transfers the other one by DMA. The board only provides the transfer:
+ * flush_start() starts it and returns, and the DMA completion handler calls
+ * lv_port_disp_flush_done(). While LVGL waits for a busy buffer the calling
+ * thread blocks instead of spinning, so audio threads keep the CPU on
+ * single-core boards.
+ *
+ * Small dirty areas close to each other are merged before rendering, which
+ * saves the per-transfer window setup on SPI controllers. With tear_sync the
+ * first transfer of every frame waits for the panel's tearing-effect signal.
+ */
+
+#ifndef LV_PORT_DISP_H
+#define LV_PORT_DISP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "lvgl.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Panel operations provided by the board
+ */
+typedef struct {
+    /**
+     * Allocate a DMA-capable draw buffer (optional, lv_malloc() is used when NULL).
+     * The buffer must be aligned to LV_DRAW_BUF_ALIGN.
+     */
+    void * (*buf_alloc)(size_t size, void * user_data);
+
+    /** Free a buffer returned by buf_alloc (required when buf_alloc is set) */
+    void (*buf_free)(void * buf, void * user_data);
+
+    /**
+     * Start transferring `px` to `area` of the panel and return immediately.
+     * Call lv_port_disp_flush_done() when the transfer has finished.
+     */
+    void (*flush_start)(const lv_area_t * area, const uint8_t * px, void * user_data);
+
+    /**
+     * Block until the tearing-effect signal or `timeout_ms` (optional).
+     * @return false on timeout
+     */
+    bool (*wait_te)(uint32_t timeout_ms, void * user_data);
+
+    /**
+     * Block until the current transfer finished (optional). Provide it when
+     * lv_port_disp_flush_done() is called from an interrupt, e.g. take a
+     * binary semaphore that the interrupt gives after flush_done. It is
+     * called again while the transfer is still busy, so extra wake-ups are
+     * harmless. The default waits on a condition variable.
+     */
+    void (*wait_done)(void * user_data);
+
+    void * user_data;
+} lv_port_panel_t;
+
+/**
+ * Display configuration
+ */
+typedef struct {
+    int32_t hor_res;
+    int32_t ver_res;
+    uint32_t buf_lines;         /**< Lines per draw buffer, 0: ver_res / 10 */
+    uint8_t align;              /**< Round areas to this many pixels (power of 2), 0/1: no rounding */
+    uint8_t merge_slack;        /**< Merge two dirty areas if their bounding box grows at most this % */
+    bool swap_bytes;            /**< Swap RGB565 bytes for big-endian SPI controllers */
+    bool tear_sync;             /**< Wait for the TE signal before the first transfer of a frame */
+    uint32_t te_timeout_ms;     /**< TE wait timeout, 0: 20 ms */
+    lv_port_panel_t panel;
+} lv_port_disp_config_t;
+
+/**
+ * Driver statistics
+ */
+typedef struct {
+    uint32_t frames;            /**< Refreshes that flushed at least one area */
+    uint32_t flushes;           /**< Transfers started */
+    uint64_t pixels;            /**< Pixels transferred */
+    uint32_t merged;            /**< Dirty areas merged into a neighbour */
+    uint32_t te_timeouts;       /**< TE waits that timed out */
+} lv_port_disp_stats_t;
+
+/**
+ * Initialize a configuration with defaults
+ */
+void lv_port_disp_config_init(lv_port_disp_config_t * config);
+
+/**
+ * Create a display with two partial buffers
+ * @param config    configuration, panel.flush_start is required
+ * @return the display or NULL on error
+ */
+lv_display_t * lv_port_disp_create(const lv_port_disp_config_t * config);
+
+/**
+ * Delete a display created by lv_port_disp_create() and free its buffers
+ */
+void lv_port_disp_delete(lv_display_t * disp);
+
+/**
+ * Report that the transfer started by flush_start() finished.
+ * Safe to call from an interrupt when panel.wait_done is provided.
+ */
+void lv_port_disp_flush_done(lv_display_t * disp);
+
+/**
+ * Get the driver statistics
+ */
+void lv_port_disp_get_stats(lv_display_t * disp, lv_port_disp_stats_t * stats);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_PORT_DISP_H*/
@@ -0,0 +1,400 @@
+/**
+ * @file lv_port_font_cache.c
+ * Glyph cache for built-in bitmap fonts (lv_font_fmt_txt)
+ */
+
+#include "lv_port_font_cache.h"
+#include <stdlib.h>
+
+/*Chained buckets per budget byte (a 16 px CJK glyph takes about 300 bytes)*/
+#define BUCKET_BYTES    256
+#define BUCKETS_MIN     16
+#define BUCKETS_MAX     4096
+
+typedef struct {
+    uint32_t unicode;
+    uint32_t gid;
+} index_entry_t;
+
+typedef struct glyph_entry {
+    struct glyph_entry * hash_next;
+    struct glyph_entry * prev;      /*Towards the most recently used*/
+    struct glyph_entry * next;      /*Towards the least recently used*/
+    uint32_t letter;
+    uint32_t refs;                  /*Draw units using the bitmap*/
+    size_t size;
+    lv_draw_buf_t buf;
+    /*A8 pixels follow*/
+} glyph_entry_t;
+
+typedef struct {
+    lv_font_t font;                 /*Must be first: handed to LVGL as the font*/
+    index_entry_t * index;
+    uint32_t index_len;
+    glyph_entry_t ** buckets;
+    uint32_t bucket_mask;
+    glyph_entry_t * lru_head;
+    glyph_entry_t * lru_tail;
+    size_t budget;
+    lv_mutex_t lock;
+    lv_port_font_cache_stats_t stats;
+} font_cache_t;
+
+static bool cache_get_glyph_dsc(const lv_font_t * font, lv_font_glyph_dsc_t * dsc_out, uint32_t letter,
+                                uint32_t letter_next);
+static const void * cache_get_glyph_bitmap(lv_font_glyph_dsc_t * g_dsc, uint32_t letter, lv_draw_buf_t * draw_buf);
+static void cache_release_glyph(const lv_font_t * font, lv_font_glyph_dsc_t * g_dsc);
+
+/**********************
+ *   LOOKUP INDEX
+ **********************/
+
+static int index_compare(const void * a, const void * b)
+{
+    uint32_t ua = ((const index_entry_t *)a)->unicode;
+    uint32_t ub = ((const index_entry_t *)b)->unicode;
+    return ua < ub ? -1 : (ua > ub ? 1 : 0);
+}
+
+/*lv_font_fmt_txt maps a code point with the first cmap whose range covers it*/
+static bool covered_before(const lv_font_fmt_txt_dsc_t * fdsc, uint16_t cmap, uint32_t unicode)
+{
+    uint16_t i;
+    for(i = 0; i < cmap; i++) {
+        if(unicode - fdsc->cmaps[i].range_start < fdsc->cmaps[i].range_length) return true;
+    }
+    return false;
+}
+
+static uint32_t cmap_glyph_count(const lv_font_fmt_txt_cmap_t * cmap)
+{
+    if(cmap->type == LV_FONT_FMT_TXT_CMAP_SPARSE_TINY || cmap->type == LV_FONT_FMT_TXT_CMAP_SPARSE_FULL) {
+        return cmap->list_length;
+    }
+    return cmap->range_length;
+}
+
+static bool index_build(font_cache_t * cache)
+{
+    const lv_font_fmt_txt_dsc_t * fdsc = cache->font.dsc;
+    uint32_t capacity = 0;
+    uint16_t i;
+    for(i = 0; i < fdsc->cmap_num; i++) capacity += cmap_glyph_count(&fdsc->cmaps[i]);
+    if(capacity == 0) return true;
+
+    cache->index = lv_malloc(capacity * sizeof(index_entry_t));
+    if(cache->index == NULL) return false;
+
+    uint32_t n = 0;
+    for(i = 0; i < fdsc->cmap_num; i++) {
+        const lv_font_fmt_txt_cmap_t * cmap = &fdsc->cmaps[i];
+        uint32_t count = cmap_glyph_count(cmap);
+        uint32_t j;
+        for(j = 0; j < count; j++) {
+            uint32_t unicode;
+            uint32_t gid;
+            switch(cmap->type) {
+                case LV_FONT_FMT_TXT_CMAP_FORMAT0_TINY:
+                    unicode = cmap->range_start + j;
+                    gid = cmap->glyph_id_start + j;
+                    break;
+                case LV_FONT_FMT_TXT_CMAP_FORMAT0_FULL:
+                    unicode = cmap->range_start + j;
+                    gid = cmap->glyph_id_start + ((const uint8_t *)cmap->glyph_id_ofs_list)[j];
+                    break;
+                case LV_FONT_FMT_TXT_CMAP_SPARSE_TINY:
+                    unicode = cmap->range_start + cmap->unicode_list[j];
+                    gid = cmap->glyph_id_start + j;
+                    break;
+                default:
+                    unicode = cmap->range_start + cmap->unicode_list[j];
+                    gid = cmap->glyph_id_start + ((const uint16_t *)cmap->glyph_id_ofs_list)[j];
+                    break;
+            }
+            if(unicode == 0 || gid == 0 || covered_before(fdsc, i, unicode)) continue;
+            cache->index[n].unicode = unicode;
+            cache->index[n].gid = gid;
+            n++;
+        }
+    }
+
+    qsort(cache->index, n, sizeof(index_entry_t), index_compare);
+    cache->index_len = n;
+    cache->stats.index_glyphs = n;
+    cache->stats.index_bytes = capacity * sizeof(index_entry_t);
+    return true;
+}
+
+static uint32_t index_find(const font_cache_t * cache, uint32_t unicode)
+{
+    uint32_t lo = 0;
+    uint32_t hi = cache->index_len;
+    while(lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        uint32_t u = cache->index[mid].unicode;
+        if(u == unicode) return cache->index[mid].gid;
+        if(u < unicode) lo = mid + 1;
+        else hi = mid;
+    }
+    return 0;
+}
+
+/**********************
+ *   BITMAP LRU
+ **********************/
+
+static inline uint32_t bucket_of(const font_cache_t * cache, uint32_t letter)
+{
+    return (letter * 2654435761u) & cache->bucket_mask;
+}
+
+static glyph_entry_t * entry_find(font_cache_t * cache, uint32_t letter)
+{
+    glyph_entry_t * e = cache->buckets[bucket_of(cache, letter)];
+    while(e && e->letter != letter) e = e->hash_next;
+    return e;
+}
+
+static void lru_unlink(font_cache_t * cache, glyph_entry_t * e)
+{
+    if(e->prev) e->prev->next = e->next;
+    else cache->lru_head = e->next;
+    if(e->next) e->next->prev = e->prev;
+    else cache->lru_tail = e->prev;
+    e->prev = NULL;
+    e->next = NULL;
+}
+
+static void lru_push_front(font_cache_t * cache, glyph_entry_t * e)
+{
+    e->prev = NULL;
+    e->next = cache->lru_head;
+    if(cache->lru_head) cache->lru_head->prev = e;
+    cache->lru_head = e;
+    if(cache->lru_tail == NULL) cache->lru_tail = e;
+}
+
+static void entry_remove(font_cache_t * cache, glyph_entry_t * e)
+{
+    glyph_entry_t ** link = &cache->buckets[bucket_of(cache, e->letter)];
+    while(*link != e) link = &(*link)->hash_next;
+    *link = e->hash_next;
+    lru_unlink(cache, e);
+    cache->stats.entries--;
+    cache->stats.bytes -= e->size;
+    lv_free(e);
+}
+
+/*Drop unpinned bitmaps from the cold end until `size` more bytes fit*/
+static void evict_for(font_cache_t * cache, size_t size, bool count)
+{
+    glyph_entry_t * e = cache->lru_tail;
+    while(e && cache->stats.bytes + size > cache->budget) {
+        glyph_entry_t * prev = e->prev;
+        if(e->refs == 0) {
+            entry_remove(cache, e);
+            if(count) cache->stats.evictions++;
+        }
+        e = prev;
+    }
+}
+
+/**********************
+ *   FONT CALLBACKS
+ **********************/
+
+static bool cache_get_glyph_dsc(const lv_font_t * font, lv_font_glyph_dsc_t * dsc_out, uint32_t letter,
+                                uint32_t letter_next)
+{
+    const font_cache_t * cache = (const font_cache_t *)font;
+    const lv_font_fmt_txt_dsc_t * fdsc = font->dsc;
+
+    dsc_out->entry = NULL;
+
+    /*Kerning is looked up by glyph id pairs, leave it to lv_font_fmt_txt*/
+    if(fdsc->kern_dsc && letter_next) {
+        return lv_font_get_glyph_dsc_fmt_txt(font, dsc_out, letter, letter_next);
+    }
+
+    bool is_tab = letter == '\t';
+    if(is_tab) letter = ' ';
+    uint32_t gid = index_find(cache, letter);
+    if(gid == 0) return false;
+
+    const lv_font_fmt_txt_glyph_dsc_t * gdsc = &fdsc->glyph_dsc[gid];
+    uint32_t adv_w = gdsc->adv_w;
+    if(is_tab) adv_w *= 2;
+
+    dsc_out->adv_w = (adv_w + (1 << 3)) >> 4;
+    dsc_out->box_h = gdsc->box_h;
+    dsc_out->box_w = is_tab ? gdsc->box_w * 2 : gdsc->box_w;
+    dsc_out->ofs_x = gdsc->ofs_x;
+    dsc_out->ofs_y = gdsc->ofs_y;
+    dsc_out->format = (uint8_t)fdsc->bpp;
+    dsc_out->is_placeholder = false;
+    dsc_out->glyph_index = gid;
+    return true;
+}
+
+static const void * cache_get_glyph_bitmap(lv_font_glyph_dsc_t * g_dsc, uint32_t letter, lv_draw_buf_t * draw_buf)
+{
+    font_cache_t * cache = (font_cache_t *)g_dsc->resolved_font;
+    if(g_dsc->box_w == 0 || g_dsc->box_h == 0) return NULL;
+
+    lv_mutex_lock(&cache->lock);
+    glyph_entry_t * e = entry_find(cache, letter);
+    if(e) {
+        lru_unlink(cache, e);
+        lru_push_front(cache, e);
+        e->refs++;
+        cache->stats.hits++;
+        lv_mutex_unlock(&cache->lock);
+        g_dsc->entry = (lv_cache_entry_t *)e;
+        return &e->buf;
+    }
+    cache->stats.misses++;
+    lv_mutex_unlock(&cache->lock);
+
+    /*Expand outside the lock, another draw unit may be rendering meanwhile*/
+    uint32_t stride = lv_draw_buf_width_to_stride(g_dsc->box_w, LV_COLOR_FORMAT_A8);
+    uint32_t data_size = stride * g_dsc->box_h + LV_DRAW_BUF_ALIGN - 1;
+    size_t size = sizeof(glyph_entry_t) + data_size;
+    e = lv_malloc(size);
+    if(e == NULL) return lv_font_get_bitmap_fmt_txt(g_dsc, letter, draw_buf);
+
+    lv_memzero(e, sizeof(glyph_entry_t));
+    e->letter = letter;
+    e->size = size;
+    lv_draw_buf_init(&e->buf, g_dsc->box_w, g_dsc->box_h, LV_COLOR_FORMAT_A8, stride, e + 1, data_size);
+    if(lv_font_get_bitmap_fmt_txt(g_dsc, letter, &e->buf) != &e->buf) {
+        lv_free(e);
+        return NULL;
+    }
+
+    lv_mutex_lock(&cache->lock);
+    glyph_entry_t * other = entry_find(cache, letter);
+    if(other) {
+        /*Another draw unit expanded the same glyph first*/
+        lv_free(e);
+        e = other;
+    }
+    else {
+        evict_for(cache, size, true);
+        uint32_t b = bucket_of(cache, letter);
+        e->hash_next = cache->buckets[b];
+        cache->buckets[b] = e;
+        lru_push_front(cache, e);
+        cache->stats.entries++;
+        cache->stats.bytes += size;
+    }
+    e->refs++;
+    lv_mutex_unlock(&cache->lock);
+
+    g_dsc->entry = (lv_cache_entry_t *)e;
+    return &e->buf;
+}
+
+static void cache_release_glyph(const lv_font_t * font, lv_font_glyph_dsc_t * g_dsc)
+{
+    /*Glyphs resolved by a fallback font were not cached*/
+    if(g_dsc->entry == NULL || g_dsc->resolved_font != font) return;
+
+    font_cache_t * cache = (font_cache_t *)font;
+    glyph_entry_t * e = (glyph_entry_t *)g_dsc->entry;
+    lv_mutex_lock(&cache->lock);
+    e->refs--;
+    lv_mutex_unlock(&cache->lock);
+    g_dsc->entry = NULL;
+}
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+lv_font_t * lv_port_font_cache_create(const lv_font_t * base, size_t budget)
+{
+    if(base == NULL || base->get_glyph_bitmap != lv_font_get_bitmap_fmt_txt ||
+       base->get_glyph_dsc != lv_font_get_glyph_dsc_fmt_txt) {
+        LV_LOG_WARN("only lv_font_fmt_txt fonts can be cached");
+        return NULL;
+    }
+
+    font_cache_t * cache = lv_malloc_zeroed(sizeof(font_cache_t));
+    if(cache == NULL) return NULL;
+
+    /*Same metrics, dsc and fallback; only the glyph callbacks differ*/
+    cache->font = *base;
+    cache->font.get_glyph_dsc = cache_get_glyph_dsc;
+    cache->font.get_glyph_bitmap = cache_get_glyph_bitmap;
+    cache->font.release_glyph = cache_release_glyph;
+    cache->budget = budget ? budget : LV_PORT_FONT_CACHE_DEFAULT_BUDGET;
+    cache->stats.budget = cache->budget;
+
+    uint32_t buckets = BUCKETS_MIN;
+    while(buckets < BUCKETS_MAX && buckets * BUCKET_BYTES < cache->budget) buckets <<= 1;
+    cache->buckets = lv_malloc_zeroed(buckets * sizeof(glyph_entry_t *));
+    cache->bucket_mask = buckets - 1;
+
+    if(cache->buckets == NULL || !index_build(cache)) {
+        LV_LOG_WARN("out of memory");
+        lv_free(cache->buckets);
+        lv_free(cache->index);
+        lv_free(cache);
+        return NULL;
+    }
+    lv_mutex_init(&cache->lock);
+
+    LV_LOG_INFO("font cache: %" LV_PRIu32 " glyphs indexed, %" LV_PRIu32 " bytes budget",
+                cache->index_len, (uint32_t)cache->budget);
+    return &cache->font;
+}
+
+void lv_port_font_cache_delete(lv_font_t * font)
+{
+    if(font == NULL || !lv_port_font_cache_is(font)) return;
+
+    font_cache_t * cache = (font_cache_t *)font;
+    glyph_entry_t * e = cache->lru_head;
+    while(e) {
+        glyph_entry_t * next = e->next;
+        LV_ASSERT(e->refs == 0);
+        lv_free(e);
+        e = next;
+    }
+    lv_mutex_delete(&cache->lock);
+    lv_free(cache->buckets);
+    lv_free(cache->index);
+    lv_free(cache);
+}
+
+bool lv_port_font_cache_is(const lv_font_t * font)
+{
+    return font != NULL && font->get_glyph_bitmap == cache_get_glyph_bitmap;
+}
+
+void lv_port_font_cache_flush(lv_font_t * font)
+{
+    if(!lv_port_font_cache_is(font)) return;
+
+    font_cache_t * cache = (font_cache_t *)font;
+    lv_mutex_lock(&cache->lock);
+    size_t budget = cache->budget;
+    cache->budget = 0;
+    evict_for(cache, 1, false);
+    cache->budget = budget;
+    lv_mutex_unlock(&cache->lock);
+}
+
+void lv_port_font_cache_get_stats(const lv_font_t * font, lv_port_font_cache_stats_t * stats)
+{
+    if(stats == NULL) return;
+    if(!lv_port_font_cache_is(font)) {
+        lv_memzero(stats, sizeof(*stats));
+        return;
+    }
+
+    font_cache_t * cache = (font_cache_t *)font;
+    lv_mutex_lock(&cache->lock);
+    *stats = cache->stats;
+    lv_mutex_unlock(&cache->lock);
+}
@@ -0,0 +1,86 @@
+/**
+ * @file lv_port_font_cache.h
+ * Glyph cache for built-in bitmap fonts (lv_font_fmt_txt)
+ *
+ * LVGL looks up every glyph again on each redraw: the code point is mapped
+ * to a glyph id by walking the font's cmaps (a binary search in the sparse
+ * ones, which is where CJK fonts keep almost all of their glyphs), and the
+ * 1/2/4 bpp or RLE compressed bitmap is expanded to A8 into a scratch
+ * buffer. Both are repeated for every visible character of every label in
+ * every refreshed area.
+ *
+ * lv_port_font_cache_create() wraps such a font in a font of its own that
+ * can be used wherever an lv_font_t is expected:
+ * - a sorted code point -> glyph id index of the whole font is built once,
+ *   so a descriptor costs one binary search without touching flash twice
+ * - expanded A8 bitmaps are kept in an LRU bounded by a byte budget and
+ *   handed to the renderer directly; glyphs in use by a draw unit are
+ *   pinned until LVGL releases them, so the budget may be exceeded briefly
+ *
+ * Fallback fonts are used as they are; glyphs found in them are not cached.
+ * Use the cached font as the top level font (label style or canvas text),
+ * not as another font's fallback: LVGL releases glyphs through the top
+ * level font only.
+ *
+ * Create and delete on the LVGL thread; the lookups are safe from several
+ * draw units.
+ */
+
+#ifndef LV_PORT_FONT_CACHE_H
+#define LV_PORT_FONT_CACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "lvgl.h"
+#include <stddef.h>
+
+/** Default bitmap budget: about 200 glyphs of a 16 px CJK font */
+#define LV_PORT_FONT_CACHE_DEFAULT_BUDGET   (64 * 1024)
+
+typedef struct {
+    uint32_t hits;          /**< Bitmaps served from the cache */
+    uint32_t misses;        /**< Bitmaps expanded from the font */
+    uint32_t evictions;     /**< Bitmaps dropped to stay within the budget */
+    uint32_t entries;       /**< Bitmaps in the cache */
+    size_t bytes;           /**< Memory used by the cached bitmaps */
+    size_t budget;          /**< Byte budget of the bitmaps */
+    uint32_t index_glyphs;  /**< Code points in the lookup index */
+    size_t index_bytes;     /**< Memory used by the lookup index */
+} lv_port_font_cache_stats_t;
+
+/**
+ * Create a cached copy of a built-in bitmap font.
+ * @param base      an lv_font_fmt_txt font (the built-in fonts, lv_binfont_create())
+ * @param budget    bitmap bytes to keep, 0: LV_PORT_FONT_CACHE_DEFAULT_BUDGET
+ * @return the cached font, NULL if `base` is not a bitmap font or on out of memory
+ */
+lv_font_t * lv_port_font_cache_create(const lv_font_t * base, size_t budget);
+
+/**
+ * Delete a cached font. No object may use it any more.
+ * @param font      a font from lv_port_font_cache_create(), NULL is ignored
+ */
+void lv_port_font_cache_delete(lv_font_t * font);
+
+/**
+ * Check whether a font was made by lv_port_font_cache_create()
+ */
+bool lv_port_font_cache_is(const lv_font_t * font);
+
+/**
+ * Drop every bitmap that is not in use, e.g. before a screen with other text
+ */
+void lv_port_font_cache_flush(lv_font_t * font);
+
+/**
+ * Get the statistics of a cached font
+ */
+void lv_port_font_cache_get_stats(const lv_font_t * font, lv_port_font_cache_stats_t * stats);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_PORT_FONT_CACHE_H*/
@@ -0,0 +1,107 @@
+/**
+ * @file lv_port_mem.c
+ * Heap hooks for LVGL (LV_USE_STDLIB_MALLOC == LV_STDLIB_CUSTOM)
+ */
+
+#include "lv_port_mem.h"
+#include <stdlib.h>
+
+static void * libc_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void * libc_realloc(void * p, size_t size)
+{
+    return realloc(p, size);
+}
+
+static void libc_free(void * p)
+{
+    free(p);
+}
+
+static lv_port_mem_hooks_t s_hooks = {
+    .malloc_fn = libc_malloc,
+    .realloc_fn = libc_realloc,
+    .free_fn = libc_free,
+};
+
+bool lv_port_mem_set_hooks(const lv_port_mem_hooks_t * hooks)
+{
+    if(hooks == NULL) {
+        s_hooks.malloc_fn = libc_malloc;
+        s_hooks.realloc_fn = libc_realloc;
+        s_hooks.free_fn = libc_free;
+        s_hooks.buf_malloc_fn = NULL;
+        s_hooks.buf_free_fn = NULL;
+        return true;
+    }
+    if(hooks->malloc_fn == NULL || hooks->realloc_fn == NULL || hooks->free_fn == NULL ||
+       (hooks->buf_malloc_fn != NULL && hooks->buf_free_fn == NULL)) {
+        return false;
+    }
+    s_hooks = *hooks;
+    return true;
+}
+
+static void * draw_buf_malloc(size_t size, lv_color_format_t color_format)
+{
+    LV_UNUSED(color_format);
+    /*Same over-allocation as LVGL's default so the data can be aligned*/
+    return s_hooks.buf_malloc_fn(size + LV_DRAW_BUF_ALIGN - 1);
+}
+
+static void draw_buf_free(void * buf)
+{
+    s_hooks.buf_free_fn(buf);
+}
+
+void lv_port_mem_init_draw_buf(void)
+{
+    if(s_hooks.buf_malloc_fn == NULL) {
+        return;
+    }
+    lv_draw_buf_handlers_t * handlers = lv_draw_buf_get_handlers();
+    handlers->buf_malloc_cb = draw_buf_malloc;
+    handlers->buf_free_cb = draw_buf_free;
+}
+
+/**
+ * Core malloc function, called by lv_malloc()
+ * @param size size in bytes to allocate
+ * @return pointer to allocated memory or NULL on failure
+ */
+void * lv_malloc_core(size_t size)
+{
+    return s_hooks.malloc_fn(size);
+}
+
+/**
+ * Core free function, called by lv_free()
+ * @param p pointer to memory to free
+ */
+void lv_free_core(void * p)
+{
+    s_hooks.free_fn(p);
+}
+
+/**
+ * Core realloc function, called by lv_realloc()
+ * @param p pointer to memory to reallocate
+ * @param new_size new size in bytes
+ * @return pointer to reallocated memory or NULL on failure
+ */
+void * lv_realloc_core(void * p, size_t new_size)
+{
+    return s_hooks.realloc_fn(p, new_size);
+}
+
+/**
+ * Memory deinitialization function
+ * Called when LVGL is deinitialized
+ */
+void lv_mem_deinit(void)
+{
+    /*Nothing to release: blocks belong to the hooked allocators*/
+}
@@ -0,0 +1,51 @@
+/**
+ * @file lv_port_mem.h
+ * Heap hooks for LVGL (LV_USE_STDLIB_MALLOC == LV_STDLIB_CUSTOM)
+ *
+ * LVGL has no pool of its own in this configuration: lv_malloc() goes to
+ * lv_malloc_core(), which calls the installed hooks (libc by default). Small,
+ * hot allocations (objects, styles, timers, the flush buffers when the panel
+ * does not provide them) and image/canvas draw buffers can be sent to
+ * different allocators, so draw buffers can live in external RAM while the
+ * object tree stays in internal SRAM.
+ */
+
+#ifndef LV_PORT_MEM_H
+#define LV_PORT_MEM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "lvgl.h"
+#include <stddef.h>
+
+typedef struct {
+    void * (*malloc_fn)(size_t size);
+    void * (*realloc_fn)(void * p, size_t size);
+    void (*free_fn)(void * p);
+    /** Draw buffers created with lv_draw_buf_create() (optional, malloc_fn when NULL) */
+    void * (*buf_malloc_fn)(size_t size);
+    /** Free a buffer from buf_malloc_fn (required when buf_malloc_fn is set) */
+    void (*buf_free_fn)(void * p);
+} lv_port_mem_hooks_t;
+
+/**
+ * Install heap hooks. Call before lv_init() and only while LVGL is not
+ * initialized; the hooks are copied.
+ * @param hooks the allocators, NULL to restore libc
+ * @return true on success, false if a required function is missing
+ */
+bool lv_port_mem_set_hooks(const lv_port_mem_hooks_t * hooks);
+
+/**
+ * Route draw buffer allocations to buf_malloc_fn / buf_free_fn.
+ * Call right after lv_init(), which resets the draw buffer handlers.
+ */
+void lv_port_mem_init_draw_buf(void);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_PORT_MEM_H*/
@@ -0,0 +1,189 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+资源包打包工具（格式见 sdk/linx_assets.h）
+
+把提示音、字体和表情动画打成一个只读资源包，设备上 mmap / esp_partition_mmap 后原地使用。
+
+用法:
+  linx_assets_pack.py -o assets.bin sounds/ emotions/ fonts/
+  linx_assets_pack.py -o assets.bin wake=sounds/wake.opus happy=emotions/happy.lxem:emotion
+  linx_assets_pack.py --list assets.bin
+
+参数是目录或 NAME=FILE[:TYPE]：
+- 目录下的文件按扩展名推断类型，资源名为去掉扩展名的文件名，子目录中的文件名带相对路径
+- NAME=FILE 指定资源名，TYPE 省略时按扩展名推断
+
+扩展名与类型：.pcm -> sound_pcm16，.opus/.pkt -> sound_packets（2 字节大端长度前缀的编码包），
+.lxem -> emotion，.ttf/.otf/.fnt -> font，.png/.bin565 -> image，其他 -> raw。
+工具只打包，不转换格式：PCM 须已是播放器的采样率和声道数，表情须已是 LXEM 格式。
+
+ESP32 上把资源包烧写到分区表中的数据分区，例如:
+  parttool.py write_partition --partition-name assets --input assets.bin
+"""
+
+import argparse
+import os
+import struct
+import sys
+import zlib
+from typing import List, Tuple
+
+MAGIC = b"LXAB"
+VERSION = 1
+HEADER_FORMAT = "<4sHHIIIIII"       # linx_assets_header_t，32 字节
+ENTRY_FORMAT = "<IIIIHHI"           # linx_assets_entry_t，24 字节
+
+TYPES = {
+    "raw": 0,
+    "sound_pcm16": 1,
+    "sound_packets": 2,
+    "emotion": 3,
+    "font": 4,
+    "image": 5,
+}
+
+EXTENSIONS = {
+    ".pcm": "sound_pcm16",
+    ".opus": "sound_packets",
+    ".pkt": "sound_packets",
+    ".lxem": "emotion",
+    ".ttf": "font",
+    ".otf": "font",
+    ".fnt": "font",
+    ".png": "image",
+    ".bin565": "image",
+}
+
+
+def fnv1a(name: bytes) -> int:
+    h = 2166136261
+    for b in name:
+        h ^= b
+        h = (h * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def guess_type(path: str) -> str:
+    return EXTENSIONS.get(os.path.splitext(path)[1].lower(), "raw")
+
+
+def collect(args: List[str]) -> List[Tuple[str, str, str]]:
+    """返回 (资源名, 文件, 类型) 列表"""
+    items = []
+    for arg in args:
+        if "=" in arg:
+            name, spec = arg.split("=", 1)
+            path, _, kind = spec.partition(":")
+            items.append((name, path, kind or guess_type(path)))
+        elif os.path.isdir(arg):
+            for root, dirs, files in os.walk(arg):
+                dirs.sort()
+                for file in sorted(files):
+                    if file.startswith("."):
+                        continue
+                    path = os.path.join(root, file)
+                    rel = os.path.relpath(path, arg)
+                    name = os.path.splitext(rel)[0].replace(os.sep, "/")
+                    items.append((name, path, guess_type(path)))
+        else:
+            sys.exit(f"不是目录或 NAME=FILE: {arg}")
+
+    names = set()
+    for name, path, kind in items:
+        if kind not in TYPES:
+            sys.exit(f"{name}: 未知类型 {kind}（可用: {', '.join(TYPES)}）")
+        if name in names:
+            sys.exit(f"资源名重复: {name}")
+        names.add(name)
+    return items
+
+
+def align_up(value: int, alignment: int) -> int:
+    return (value + alignment - 1) & ~(alignment - 1)
+
+
+def pack(items: List[Tuple[str, str, str]], alignment: int) -> bytes:
+    encoded = [(name.encode("utf-8"), path, kind) for name, path, kind in items]
+    # 索引按 (哈希, 名称) 排序，设备上二分查找
+    encoded.sort(key=lambda item: (fnv1a(item[0]), item[0]))
+
+    names = bytearray()
+    name_offsets = []
+    for name, _, _ in encoded:
+        name_offsets.append(len(names))
+        names += name + b"\0"
+
+    header_size = struct.calcsize(HEADER_FORMAT)
+    entry_size = struct.calcsize(ENTRY_FORMAT)
+    index_offset = header_size
+    names_offset = index_offset + entry_size * len(encoded)
+    offset = align_up(names_offset + len(names), alignment)
+
+    index = bytearray()
+    data = bytearray()
+    data_start = offset
+    for (name, path, kind), name_offset in zip(encoded, name_offsets):
+        with open(path, "rb") as f:
+            payload = f.read()
+        data += b"\0" * (offset - data_start - len(data))
+        index += struct.pack(ENTRY_FORMAT, fnv1a(name), name_offset, offset, len(payload),
+                             TYPES[kind], 0, zlib.crc32(payload) & 0xFFFFFFFF)
+        data += payload
+        offset = align_up(offset + len(payload), alignment)
+
+    total_size = data_start + len(data)
+    index_crc = zlib.crc32(bytes(index) + bytes(names)) & 0xFFFFFFFF
+    header = struct.pack(HEADER_FORMAT, MAGIC, VERSION, alignment, len(encoded), index_offset,
+                         names_offset, len(names), total_size, index_crc)
+    padding = b"\0" * (data_start - names_offset - len(names))
+    return header + bytes(index) + bytes(names) + padding + bytes(data)
+
+
+def list_bundle(path: str) -> None:
+    with open(path, "rb") as f:
+        blob = f.read()
+    header_size = struct.calcsize(HEADER_FORMAT)
+    entry_size = struct.calcsize(ENTRY_FORMAT)
+    magic, version, alignment, count, index_offset, names_offset, names_size, total_size, index_crc = \
+        struct.unpack_from(HEADER_FORMAT, blob)
+    if magic != MAGIC:
+        sys.exit(f"{path}: 不是资源包")
+    kinds = {v: k for k, v in TYPES.items()}
+    print(f"{path}: 版本 {version}，{count} 项，对齐 {alignment}，{total_size} 字节")
+    for i in range(count):
+        name_hash, name_offset, offset, size, kind, _, crc = \
+            struct.unpack_from(ENTRY_FORMAT, blob, index_offset + i * entry_size)
+        name_start = names_offset + name_offset
+        name = blob[name_start:blob.index(b"\0", name_start)].decode("utf-8")
+        ok = zlib.crc32(blob[offset:offset + size]) & 0xFFFFFFFF == crc
+        print(f"  {offset:8d} {size:8d}  {kinds.get(kind, kind):13s} {name}{'' if ok else '  (CRC 错误)'}")
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="LinX 资源包打包工具")
+    parser.add_argument("inputs", nargs="*", help="目录或 NAME=FILE[:TYPE]")
+    parser.add_argument("-o", "--output", help="输出的资源包")
+    parser.add_argument("-a", "--align", type=int, default=32,
+                        help="数据对齐字节数，2 的幂（默认 32，满足 DMA 和 LVGL 图像的对齐）")
+    parser.add_argument("--list", metavar="BUNDLE", help="列出资源包内容并检查 CRC")
+    args = parser.parse_args()
+
+    if args.list:
+        list_bundle(args.list)
+        return 0
+    if not args.output or not args.inputs:
+        parser.error("需要 -o 和至少一个输入")
+    if args.align <= 0 or args.align & (args.align - 1) or args.align > 0xFFFF:
+        parser.error("--align 必须是 2 的幂")
+
+    items = collect(args.inputs)
+    blob = pack(items, args.align)
+    with open(args.output, "wb") as f:
+        f.write(blob)
+    print(f"{args.output}: {len(items)} 项，{len(blob)} 字节")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
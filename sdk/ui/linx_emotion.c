@@ -0,0 +1,623 @@
+/**
+ * @file linx_emotion.c
+ * @brief 表情动画缓存实现
+ */
+
+#include "linx_emotion.h"
+#include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_UI);
+
+/* LVGL 索引色图像要求完整的 256 项 ARGB8888 调色板在像素之前 */
+#define EMOTION_I8_PALETTE_BYTES (256 * 4)
+
+/* 一帧已解码的缓冲，按最近使用串成双向链表 */
+typedef struct emotion_frame {
+    struct emotion_frame* prev;
+    struct emotion_frame* next;
+    struct emotion_asset* asset;
+    uint16_t index;
+    uint16_t pins;                          // 正在显示该帧的播放器数，非零时不淘汰
+    size_t size;
+    uint8_t data[];                         // 索引色时为调色板 + 像素
+} emotion_frame_t;
+
+typedef struct emotion_asset {
+    char name[LINX_EMOTION_NAME_LENGTH];
+    const uint8_t* base;                    // 资源数据（映射区或调用方内存）
+    size_t size;
+    void* mapping;                          // mmap 的起始地址，内存资源为 NULL
+    linx_emotion_file_header_t header;
+    size_t frame_bytes;                     // 解码后一帧的字节数
+    bool zero_copy;                         // 未压缩 RGB565 且对齐，帧直接指向映射区
+    emotion_frame_t** frames;               // 已解码的帧，按需分配
+} emotion_asset_t;
+
+typedef struct {
+    char alias[LINX_EMOTION_NAME_LENGTH];
+    emotion_asset_t* asset;
+} emotion_alias_t;
+
+struct linx_emotion_cache {
+    emotion_asset_t assets[LINX_EMOTION_MAX_ASSETS];
+    size_t asset_count;
+    emotion_alias_t aliases[LINX_EMOTION_MAX_ALIASES];
+    size_t alias_count;
+    emotion_asset_t* fallback;
+
+    emotion_frame_t* lru_head;              // 最近使用
+    emotion_frame_t* lru_tail;              // 最久未用，优先淘汰
+    linx_emotion_stats_t stats;
+};
+
+struct linx_emotion_player {
+    linx_emotion_cache_t* cache;
+    lv_obj_t* image;
+    lv_timer_t* timer;
+    emotion_asset_t* asset;
+    uint16_t frame;
+    uint16_t step;                          // 每次定时器前进的帧数，限制帧间隔时跳帧
+    uint32_t min_frame_ms;                  // 最短帧间隔，0 按动画自身的帧时长
+    bool paused;
+    emotion_frame_t* shown;                 // 当前显示且已固定的解码帧，零拷贝帧为 NULL
+    lv_image_dsc_t dsc;
+};
+
+/* ============================================================================
+ * LRU
+ * ============================================================================ */
+
+static void lru_unlink(linx_emotion_cache_t* cache, emotion_frame_t* frame) {
+    if (frame->prev) {
+        frame->prev->next = frame->next;
+    } else {
+        cache->lru_head = frame->next;
+    }
+    if (frame->next) {
+        frame->next->prev = frame->prev;
+    } else {
+        cache->lru_tail = frame->prev;
+    }
+    frame->prev = NULL;
+    frame->next = NULL;
+}
+
+static void lru_push_front(linx_emotion_cache_t* cache, emotion_frame_t* frame) {
+    frame->prev = NULL;
+    frame->next = cache->lru_head;
+    if (cache->lru_head) {
+        cache->lru_head->prev = frame;
+    } else {
+        cache->lru_tail = frame;
+    }
+    cache->lru_head = frame;
+}
+
+static void frame_free(linx_emotion_cache_t* cache, emotion_frame_t* frame) {
+    lru_unlink(cache, frame);
+    frame->asset->frames[frame->index] = NULL;
+    cache->stats.used_bytes -= frame->size;
+    LINX_FREE(frame);
+}
+
+/* 从最久未用的一端淘汰未固定的帧，直到能放下 need 字节 */
+static void lru_make_room(linx_emotion_cache_t* cache, size_t need) {
+    emotion_frame_t* frame = cache->lru_tail;
+    while (frame && cache->stats.used_bytes + need > cache->stats.budget_bytes) {
+        emotion_frame_t* prev = frame->prev;
+        if (frame->pins == 0) {
+            frame_free(cache, frame);
+            cache->stats.evictions++;
+        }
+        frame = prev;
+    }
+}
+
+/* ============================================================================
+ * 解码
+ * ============================================================================ */
+
+/* 按像素的 PackBits 解码，输出必须正好填满 out_pixels 个像素 */
+static bool rle_decode(const uint8_t* in, size_t in_size, uint8_t* out, size_t out_pixels, size_t pixel_size) {
+    size_t ip = 0;
+    size_t op = 0;
+    while (op < out_pixels) {
+        if (ip >= in_size) {
+            return false;
+        }
+        uint8_t n = in[ip++];
+        if (n < 128) {
+            size_t count = (size_t)n + 1;
+            size_t bytes = count * pixel_size;
+            if (count > out_pixels - op || bytes > in_size - ip) {
+                return false;
+            }
+            memcpy(out + op * pixel_size, in + ip, bytes);
+            ip += bytes;
+            op += count;
+        } else {
+            size_t count = (size_t)n - 126;
+            if (count > out_pixels - op || pixel_size > in_size - ip) {
+                return false;
+            }
+            if (pixel_size == 1) {
+                memset(out + op, in[ip], count);
+            } else {
+                for (size_t i = 0; i < count; i++) {
+                    memcpy(out + (op + i) * pixel_size, in + ip, pixel_size);
+                }
+            }
+            ip += pixel_size;
+            op += count;
+        }
+    }
+    return true;
+}
+
+/* 读取帧表项，越界返回 NULL */
+static const uint8_t* asset_frame_data(const emotion_asset_t* asset, uint16_t index, size_t* size) {
+    uint64_t entry = (uint64_t)asset->header.frames_offset + (uint64_t)index * 8;
+    if (entry + 8 > asset->size) {
+        return NULL;
+    }
+    uint32_t offset;
+    uint32_t length;
+    memcpy(&offset, asset->base + entry, 4);
+    memcpy(&length, asset->base + entry + 4, 4);
+    if ((uint64_t)offset + length > asset->size) {
+        return NULL;
+    }
+    *size = length;
+    return asset->base + offset;
+}
+
+/* 把帧解码进缓冲，索引色时先写入 256 项调色板 */
+static bool asset_decode(const emotion_asset_t* asset, uint16_t index, uint8_t* out) {
+    const linx_emotion_file_header_t* h = &asset->header;
+    size_t pixels = (size_t)h->width * h->height;
+    size_t pixel_size = h->format == LINX_EMOTION_FORMAT_I8 ? 1 : 2;
+
+    if (h->format == LINX_EMOTION_FORMAT_I8) {
+        memset(out, 0, EMOTION_I8_PALETTE_BYTES);
+        memcpy(out, asset->base + h->palette_offset, (size_t)h->palette_count * 4);
+        out += EMOTION_I8_PALETTE_BYTES;
+    }
+
+    size_t size = 0;
+    const uint8_t* data = asset_frame_data(asset, index, &size);
+    if (!data) {
+        return false;
+    }
+    if (h->compression == LINX_EMOTION_COMPRESSION_RLE) {
+        return rle_decode(data, size, out, pixels, pixel_size);
+    }
+    if (size != pixels * pixel_size) {
+        return false;
+    }
+    memcpy(out, data, size);
+    return true;
+}
+
+/**
+ * 取帧像素：零拷贝帧直接返回映射区，其余命中缓存或解码
+ * @param frame_out 解码帧的缓存项，零拷贝时为 NULL
+ */
+static const uint8_t* cache_get_frame(linx_emotion_cache_t* cache, emotion_asset_t* asset, uint16_t index,
+                                      emotion_frame_t** frame_out) {
+    *frame_out = NULL;
+    if (asset->zero_copy) {
+        size_t size = 0;
+        const uint8_t* data = asset_frame_data(asset, index, &size);
+        if (!data || size != asset->frame_bytes) {
+            cache->stats.decode_errors++;
+            return NULL;
+        }
+        cache->stats.hits++;
+        return data;
+    }
+
+    emotion_frame_t* frame = asset->frames[index];
+    if (frame) {
+        cache->stats.hits++;
+        lru_unlink(cache, frame);
+        lru_push_front(cache, frame);
+        *frame_out = frame;
+        return frame->data;
+    }
+
+    cache->stats.misses++;
+    lru_make_room(cache, asset->frame_bytes);
+    if (cache->stats.used_bytes + asset->frame_bytes > cache->stats.budget_bytes) {
+        LOG_WARN_EVERY_MS(5000, "Emotion: budget %zu exceeded by pinned frames", cache->stats.budget_bytes);
+    }
+
+    frame = (emotion_frame_t*)LINX_MALLOC_BULK(sizeof(emotion_frame_t) + asset->frame_bytes);
+    if (!frame) {
+        return NULL;
+    }
+    memset(frame, 0, sizeof(*frame));
+    if (!asset_decode(asset, index, frame->data)) {
+        LOG_WARN_EVERY_MS(5000, "Emotion: corrupt frame %u of '%s'", (unsigned)index, asset->name);
+        cache->stats.decode_errors++;
+        LINX_FREE(frame);
+        return NULL;
+    }
+    frame->asset = asset;
+    frame->index = index;
+    frame->size = asset->frame_bytes;
+    asset->frames[index] = frame;
+    cache->stats.used_bytes += frame->size;
+    lru_push_front(cache, frame);
+    *frame_out = frame;
+    return frame->data;
+}
+
+/* ============================================================================
+ * 缓存
+ * ============================================================================ */
+
+linx_emotion_cache_t* linx_emotion_cache_create(size_t budget_bytes) {
+    linx_emotion_cache_t* cache = (linx_emotion_cache_t*)LINX_CALLOC(1, sizeof(linx_emotion_cache_t));
+    if (!cache) {
+        return NULL;
+    }
+    cache->stats.budget_bytes = budget_bytes ? budget_bytes : LINX_EMOTION_DEFAULT_BUDGET;
+    return cache;
+}
+
+void linx_emotion_cache_destroy(linx_emotion_cache_t* cache) {
+    if (!cache) {
+        return;
+    }
+    while (cache->lru_head) {
+        frame_free(cache, cache->lru_head);
+    }
+    for (size_t i = 0; i < cache->asset_count; i++) {
+        emotion_asset_t* asset = &cache->assets[i];
+        if (asset->mapping) {
+            munmap(asset->mapping, asset->size);
+        }
+        LINX_FREE(asset->frames);
+    }
+    LINX_FREE(cache);
+}
+
+static emotion_asset_t* cache_find_asset(linx_emotion_cache_t* cache, const char* name) {
+    for (size_t i = 0; i < cache->asset_count; i++) {
+        if (strcmp(cache->assets[i].name, name) == 0) {
+            return &cache->assets[i];
+        }
+    }
+    return NULL;
+}
+
+/* 在调用方持有的映射上解析文件头，成功后登记资源 */
+static bool cache_register(linx_emotion_cache_t* cache, const char* emotion, const uint8_t* data, size_t size,
+                           void* mapping) {
+    if (!emotion || strlen(emotion) >= LINX_EMOTION_NAME_LENGTH || cache_find_asset(cache, emotion)) {
+        LOG_WARN("Emotion: invalid or duplicate name '%s'", emotion ? emotion : "(null)");
+        return false;
+    }
+    if (cache->asset_count >= LINX_EMOTION_MAX_ASSETS) {
+        LOG_WARN("Emotion: too many assets, '%s' ignored", emotion);
+        return false;
+    }
+
+    linx_emotion_file_header_t h;
+    if (size < sizeof(h)) {
+        LOG_WARN("Emotion: '%s' too short", emotion);
+        return false;
+    }
+    memcpy(&h, data, sizeof(h));
+    bool indexed = h.format == LINX_EMOTION_FORMAT_I8;
+    if (memcmp(h.magic, LINX_EMOTION_MAGIC, 4) != 0 || h.version != LINX_EMOTION_VERSION ||
+        h.format > LINX_EMOTION_FORMAT_I8 || h.compression > LINX_EMOTION_COMPRESSION_RLE ||
+        h.width == 0 || h.height == 0 || h.frame_count == 0 ||
+        (uint64_t)h.frames_offset + (uint64_t)h.frame_count * 8 > size ||
+        (indexed && (h.palette_count == 0 || h.palette_count > 256 ||
+                     (uint64_t)h.palette_offset + (uint64_t)h.palette_count * 4 > size))) {
+        LOG_WARN("Emotion: '%s' has an invalid header", emotion);
+        return false;
+    }
+
+    emotion_asset_t* asset = &cache->assets[cache->asset_count];
+    memset(asset, 0, sizeof(*asset));
+    asset->frames = (emotion_frame_t**)LINX_CALLOC(h.frame_count, sizeof(emotion_frame_t*));
+    if (!asset->frames) {
+        return false;
+    }
+    strcpy(asset->name, emotion);
+    asset->base = data;
+    asset->size = size;
+    asset->mapping = mapping;
+    asset->header = h;
+    size_t pixels = (size_t)h.width * h.height;
+    asset->frame_bytes = indexed ? EMOTION_I8_PALETTE_BYTES + pixels : pixels * 2;
+
+    // 未压缩 RGB565 帧按 LVGL 的缓冲对齐时直接绘制映射区
+    asset->zero_copy = !indexed && h.compression == LINX_EMOTION_COMPRESSION_NONE;
+    for (uint16_t i = 0; asset->zero_copy && i < h.frame_count; i++) {
+        size_t frame_size = 0;
+        const uint8_t* frame = asset_frame_data(asset, i, &frame_size);
+        asset->zero_copy = frame && ((uintptr_t)frame % LV_DRAW_BUF_ALIGN) == 0;
+    }
+
+    cache->asset_count++;
+    if (!cache->fallback) {
+        cache->fallback = asset;
+    }
+    LOG_INFO("Emotion: '%s' %ux%u x%u frames, %s%s", emotion, (unsigned)h.width, (unsigned)h.height,
+             (unsigned)h.frame_count, indexed ? "I8" : "RGB565", asset->zero_copy ? ", zero-copy" : "");
+    return true;
+}
+
+bool linx_emotion_cache_add_memory(linx_emotion_cache_t* cache, const char* emotion, const void* data, size_t size) {
+    if (!cache || !data) {
+        return false;
+    }
+    return cache_register(cache, emotion, (const uint8_t*)data, size, NULL);
+}
+
+bool linx_emotion_cache_add_file(linx_emotion_cache_t* cache, const char* emotion, const char* path) {
+    if (!cache || !path) {
+        return false;
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        LOG_WARN("Emotion: cannot open '%s'", path);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+    // 只读映射，页面在首次访问帧时才换入；映射在关闭描述符后仍有效
+    void* mapping = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        LOG_WARN("Emotion: cannot map '%s'", path);
+        return false;
+    }
+
+    if (!cache_register(cache, emotion, (const uint8_t*)mapping, (size_t)st.st_size, mapping)) {
+        munmap(mapping, (size_t)st.st_size);
+        return false;
+    }
+    return true;
+}
+
+size_t linx_emotion_cache_add_assets(linx_emotion_cache_t* cache, const linx_assets_t* assets) {
+    if (!cache) {
+        return 0;
+    }
+    size_t added = 0;
+    size_t count = linx_assets_count(assets);
+    for (size_t i = 0; i < count; i++) {
+        linx_asset_t item;
+        if (linx_assets_get(assets, i, &item) && item.type == LINX_ASSET_EMOTION &&
+            cache_register(cache, item.name, (const uint8_t*)item.data, item.size, NULL)) {
+            added++;
+        }
+    }
+    return added;
+}
+
+bool linx_emotion_cache_add_alias(linx_emotion_cache_t* cache, const char* alias, const char* emotion) {
+    if (!cache || !alias || !emotion || strlen(alias) >= LINX_EMOTION_NAME_LENGTH ||
+        cache->alias_count >= LINX_EMOTION_MAX_ALIASES) {
+        return false;
+    }
+    emotion_asset_t* asset = cache_find_asset(cache, emotion);
+    if (!asset) {
+        return false;
+    }
+    strcpy(cache->aliases[cache->alias_count].alias, alias);
+    cache->aliases[cache->alias_count].asset = asset;
+    cache->alias_count++;
+    return true;
+}
+
+bool linx_emotion_cache_set_fallback(linx_emotion_cache_t* cache, const char* emotion) {
+    emotion_asset_t* asset = cache && emotion ? cache_find_asset(cache, emotion) : NULL;
+    if (!asset) {
+        return false;
+    }
+    cache->fallback = asset;
+    return true;
+}
+
+/* 按名称、别名查找，不使用回退 */
+static emotion_asset_t* cache_lookup(linx_emotion_cache_t* cache, const char* emotion) {
+    if (!emotion) {
+        return NULL;
+    }
+    emotion_asset_t* asset = cache_find_asset(cache, emotion);
+    for (size_t i = 0; !asset && i < cache->alias_count; i++) {
+        if (strcmp(cache->aliases[i].alias, emotion) == 0) {
+            asset = cache->aliases[i].asset;
+        }
+    }
+    return asset;
+}
+
+bool linx_emotion_cache_has(linx_emotion_cache_t* cache, const char* emotion) {
+    return cache && cache_lookup(cache, emotion) != NULL;
+}
+
+void linx_emotion_cache_get_stats(linx_emotion_cache_t* cache, linx_emotion_stats_t* stats) {
+    if (cache && stats) {
+        *stats = cache->stats;
+    }
+}
+
+/* ============================================================================
+ * 播放器
+ * ============================================================================ */
+
+/* 显示第 index 帧，失败时保持当前帧 */
+static bool player_show_frame(linx_emotion_player_t* player, uint16_t index) {
+    emotion_asset_t* asset = player->asset;
+    emotion_frame_t* frame = NULL;
+    const uint8_t* data = cache_get_frame(player->cache, asset, index, &frame);
+    if (!data) {
+        return false;
+    }
+
+    // 先固定新帧再释放旧帧，避免淘汰正在绘制的缓冲
+    if (frame) {
+        frame->pins++;
+    }
+    if (player->shown) {
+        player->shown->pins--;
+    }
+    player->shown = frame;
+    player->frame = index;
+
+    const linx_emotion_file_header_t* h = &asset->header;
+    lv_image_dsc_t* dsc = &player->dsc;
+    memset(dsc, 0, sizeof(*dsc));
+    dsc->header.magic = LV_IMAGE_HEADER_MAGIC;
+    dsc->header.w = h->width;
+    dsc->header.h = h->height;
+    if (h->format == LINX_EMOTION_FORMAT_I8) {
+        dsc->header.cf = LV_COLOR_FORMAT_I8;
+        dsc->header.stride = h->width;
+    } else {
+        dsc->header.cf = LV_COLOR_FORMAT_RGB565;
+        dsc->header.stride = (uint32_t)h->width * 2;
+    }
+    dsc->data = data;
+    dsc->data_size = (uint32_t)asset->frame_bytes;
+
+    lv_image_cache_drop(dsc);
+    lv_image_set_src(player->image, dsc);
+    return true;
+}
+
+static void player_timer_cb(lv_timer_t* timer) {
+    linx_emotion_player_t* player = (linx_emotion_player_t*)lv_timer_get_user_data(timer);
+    const linx_emotion_file_header_t* h = &player->asset->header;
+
+    uint32_t next = (uint32_t)player->frame + player->step;
+    if (next >= h->frame_count) {
+        if (!(h->flags & LINX_EMOTION_FLAG_LOOP)) {
+            // 跳帧时也停在最后一帧
+            if (player->frame + 1u < h->frame_count) {
+                player_show_frame(player, (uint16_t)(h->frame_count - 1));
+            }
+            lv_timer_pause(timer);
+            return;
+        }
+        next %= h->frame_count;
+    }
+    player_show_frame(player, (uint16_t)next);
+}
+
+/* 按帧时长和最短帧间隔设置定时器：间隔放大为帧时长的整数倍并相应跳帧，播放速度不变 */
+static void player_schedule(linx_emotion_player_t* player, bool restart) {
+    const emotion_asset_t* asset = player->asset;
+    if (!asset || asset->header.frame_count <= 1 || player->paused) {
+        lv_timer_pause(player->timer);
+        return;
+    }
+    if (!restart && player->frame + 1u >= asset->header.frame_count &&
+        !(asset->header.flags & LINX_EMOTION_FLAG_LOOP)) {
+        return;     // 非循环动画已播完
+    }
+    uint32_t frame_ms = asset->header.frame_ms ? asset->header.frame_ms : 100;
+    uint32_t step = 1;
+    if (player->min_frame_ms > frame_ms) {
+        step = (player->min_frame_ms + frame_ms - 1) / frame_ms;
+        if (step >= asset->header.frame_count) {
+            step = asset->header.frame_count - 1;
+        }
+    }
+    player->step = (uint16_t)step;
+    lv_timer_set_period(player->timer, frame_ms * step);
+    lv_timer_reset(player->timer);
+    lv_timer_resume(player->timer);
+}
+
+linx_emotion_player_t* linx_emotion_player_create(linx_emotion_cache_t* cache, lv_obj_t* parent) {
+    if (!cache || !parent) {
+        return NULL;
+    }
+    linx_emotion_player_t* player = (linx_emotion_player_t*)LINX_CALLOC(1, sizeof(linx_emotion_player_t));
+    if (!player) {
+        return NULL;
+    }
+    player->cache = cache;
+    player->step = 1;
+    player->image = lv_image_create(parent);
+    player->timer = lv_timer_create(player_timer_cb, 100, player);
+    if (!player->image || !player->timer) {
+        linx_emotion_player_delete(player);
+        return NULL;
+    }
+    lv_timer_pause(player->timer);
+    return player;
+}
+
+void linx_emotion_player_delete(linx_emotion_player_t* player) {
+    if (!player) {
+        return;
+    }
+    if (player->timer) {
+        lv_timer_delete(player->timer);
+    }
+    if (player->image) {
+        lv_obj_delete(player->image);
+    }
+    if (player->shown) {
+        player->shown->pins--;
+    }
+    LINX_FREE(player);
+}
+
+bool linx_emotion_player_show(linx_emotion_player_t* player, const char* emotion) {
+    if (!player) {
+        return false;
+    }
+    emotion_asset_t* asset = cache_lookup(player->cache, emotion);
+    if (!asset) {
+        asset = player->cache->fallback;
+    }
+    if (!asset) {
+        return false;
+    }
+    if (asset == player->asset) {
+        return true;
+    }
+
+    // 只解码第一帧，其余帧播放到时再解码
+    emotion_asset_t* previous = player->asset;
+    player->asset = asset;
+    if (!player_show_frame(player, 0)) {
+        player->asset = previous;
+        return false;
+    }
+
+    player_schedule(player, true);
+    return true;
+}
+
+void linx_emotion_player_set_pace(linx_emotion_player_t* player, uint32_t min_frame_ms, bool paused) {
+    if (!player || (player->min_frame_ms == min_frame_ms && player->paused == paused)) {
+        return;
+    }
+    player->min_frame_ms = min_frame_ms;
+    player->paused = paused;
+    player_schedule(player, false);
+}
+
+lv_obj_t* linx_emotion_player_get_obj(linx_emotion_player_t* player) {
+    return player ? player->image : NULL;
+}
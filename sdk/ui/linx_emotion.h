@@ -0,0 +1,177 @@
+/**
+ * @file linx_emotion.h
+ * @brief 表情动画缓存
+ *
+ * 服务端的表情字符串（LINX_EVENT_EMOTION_MESSAGE，如 "happy"）映射到
+ * 预先制作好的动画资源。资源是竖排的序列帧（精灵条），每帧 RGB565 或
+ * 8 位索引色，可按帧做 RLE 压缩。注册时只解析文件头：文件通过 mmap 映射、
+ * 内存资源直接引用（如链接进 Flash 的数组），帧数据在首次播放时才读取。
+ *
+ * 未压缩的帧直接指向映射区，不占内存；压缩的帧逐帧解码成可直接绘制的
+ * 缓冲，放进按内存预算淘汰的 LRU 缓存。切换表情时只解码第一帧，其余帧在
+ * 播放到时才解码，解码成本分摊到每一帧，不会因换表情卡住渲染。
+ * 预算不足且无法淘汰其他动画时，正在播放的动画只保留当前帧，循环时重新解码。
+ *
+ * 缓存和播放器只能在 LVGL 线程（linx_ui 的 UI 线程）上使用。
+ *
+ * 资源文件格式（小端）：
+ *   linx_emotion_file_header_t
+ *   调色板（仅索引色）：palette_count 个 uint32_t ARGB8888
+ *   帧表：frame_count 个 { uint32_t offset; uint32_t size; }，偏移相对文件头
+ *   帧数据：未压缩时为 width*height 个像素；RLE 时每个控制字节 n：
+ *           n < 128 其后 n+1 个像素原样复制，n >= 128 其后 1 个像素重复 n-126 次
+ */
+
+#ifndef LINX_EMOTION_H
+#define LINX_EMOTION_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "lvgl.h"
+#include "../linx_assets.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LINX_EMOTION_MAGIC          "LXEM"
+#define LINX_EMOTION_VERSION        1
+#define LINX_EMOTION_NAME_LENGTH    24      // 表情名最大长度（含结尾0）
+#define LINX_EMOTION_MAX_ASSETS     32      // 最多注册的动画数
+#define LINX_EMOTION_MAX_ALIASES    32      // 最多注册的别名数
+#define LINX_EMOTION_DEFAULT_BUDGET (256 * 1024)
+
+/* 像素格式 */
+typedef enum {
+    LINX_EMOTION_FORMAT_RGB565 = 0,         // 每像素 2 字节，直接绘制
+    LINX_EMOTION_FORMAT_I8                  // 每像素 1 字节索引 + 调色板
+} linx_emotion_format_t;
+
+/* 帧压缩方式 */
+typedef enum {
+    LINX_EMOTION_COMPRESSION_NONE = 0,      // 帧直接引用映射区
+    LINX_EMOTION_COMPRESSION_RLE            // 按像素的 PackBits
+} linx_emotion_compression_t;
+
+#define LINX_EMOTION_FLAG_LOOP      0x01    // 播完后从第一帧循环
+
+/**
+ * 资源文件头（32 字节）
+ */
+typedef struct {
+    char magic[4];                          // LINX_EMOTION_MAGIC
+    uint8_t version;                        // LINX_EMOTION_VERSION
+    uint8_t format;                         // linx_emotion_format_t
+    uint8_t compression;                    // linx_emotion_compression_t
+    uint8_t flags;                          // LINX_EMOTION_FLAG_*
+    uint16_t width;
+    uint16_t height;
+    uint16_t frame_count;
+    uint16_t frame_ms;                      // 每帧显示时长(毫秒)
+    uint16_t palette_count;                 // 调色板项数（仅索引色，1~256）
+    uint16_t reserved;
+    uint32_t palette_offset;                // 调色板偏移
+    uint32_t frames_offset;                 // 帧表偏移
+    uint32_t reserved2;
+} linx_emotion_file_header_t;
+
+/**
+ * 缓存统计
+ */
+typedef struct {
+    size_t used_bytes;                      // 已解码帧占用的内存
+    size_t budget_bytes;                    // 内存预算
+    uint32_t hits;                          // 取帧时已解码
+    uint32_t misses;                        // 取帧时需要解码
+    uint32_t evictions;                     // 因预算淘汰的帧数
+    uint32_t decode_errors;                 // 帧数据损坏
+} linx_emotion_stats_t;
+
+typedef struct linx_emotion_cache linx_emotion_cache_t;
+typedef struct linx_emotion_player linx_emotion_player_t;
+
+/**
+ * 创建缓存
+ * @param budget_bytes 解码帧的内存预算，0 使用 LINX_EMOTION_DEFAULT_BUDGET
+ */
+linx_emotion_cache_t* linx_emotion_cache_create(size_t budget_bytes);
+
+/**
+ * 释放缓存、解码帧和文件映射（播放器须先删除）
+ */
+void linx_emotion_cache_destroy(linx_emotion_cache_t* cache);
+
+/**
+ * 注册内存中的资源（数据须在缓存生存期内有效，不复制）
+ * @return 文件头合法且未超出数量上限返回 true
+ */
+bool linx_emotion_cache_add_memory(linx_emotion_cache_t* cache, const char* emotion,
+                                   const void* data, size_t size);
+
+/**
+ * 注册资源文件，以只读方式 mmap，帧数据按需换入
+ */
+bool linx_emotion_cache_add_file(linx_emotion_cache_t* cache, const char* emotion, const char* path);
+
+/**
+ * 注册资源包中所有表情动画（LINX_ASSET_EMOTION），资源名即表情名，帧直接引用映射区；
+ * 资源包须在缓存销毁后才关闭
+ * @return 注册的动画数
+ */
+size_t linx_emotion_cache_add_assets(linx_emotion_cache_t* cache, const linx_assets_t* assets);
+
+/**
+ * 把服务端的表情名映射到已注册的动画，如 "laughing" -> "happy"
+ */
+bool linx_emotion_cache_add_alias(linx_emotion_cache_t* cache, const char* alias, const char* emotion);
+
+/**
+ * 设置找不到表情时使用的动画（默认是第一个注册的动画）
+ */
+bool linx_emotion_cache_set_fallback(linx_emotion_cache_t* cache, const char* emotion);
+
+/**
+ * 表情名（或别名）是否有对应动画
+ */
+bool linx_emotion_cache_has(linx_emotion_cache_t* cache, const char* emotion);
+
+/**
+ * 获取缓存统计
+ */
+void linx_emotion_cache_get_stats(linx_emotion_cache_t* cache, linx_emotion_stats_t* stats);
+
+/**
+ * 创建播放器：一个 lv_image 控件，按帧时长切换帧，非循环动画停在最后一帧
+ * 暂停时不保留定时器运行，UI 线程可以睡眠
+ */
+linx_emotion_player_t* linx_emotion_player_create(linx_emotion_cache_t* cache, lv_obj_t* parent);
+
+/**
+ * 删除播放器和控件
+ */
+void linx_emotion_player_delete(linx_emotion_player_t* player);
+
+/**
+ * 切换表情，找不到时使用回退动画；与当前表情相同时不重新开始
+ * @return 有可播放的动画返回 true
+ */
+bool linx_emotion_player_show(linx_emotion_player_t* player, const char* emotion);
+
+/**
+ * 限制播放节奏，用于按设备状态降低动画帧率
+ * @param min_frame_ms 最短帧间隔，大于动画帧时长时跳帧（播放速度不变），0 不限制
+ * @param paused       为 true 时停在当前帧，定时器暂停
+ */
+void linx_emotion_player_set_pace(linx_emotion_player_t* player, uint32_t min_frame_ms, bool paused);
+
+/**
+ * 获取播放器的 LVGL 控件，用于布局
+ */
+lv_obj_t* linx_emotion_player_get_obj(linx_emotion_player_t* player);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LINX_EMOTION_H
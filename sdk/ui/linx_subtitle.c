@@ -0,0 +1,332 @@
+/**
+ * @file linx_subtitle.c
+ * @brief 流式字幕控件实现
+ */
+
+#include "linx_subtitle.h"
+#include "lv_port_font_cache.h"
+#include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
+#include <string.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_UI);
+
+/* 取出的字形，bitmap 在 glyph_release() 之前有效 */
+typedef struct {
+    lv_font_glyph_dsc_t dsc;
+    const lv_draw_buf_t* bitmap;    // A8，空白、占位和图片/矢量字形为 NULL
+} subtitle_glyph_t;
+
+struct linx_subtitle {
+    linx_subtitle_config_t config;
+    const lv_font_t* font;          // 实际使用的字体，通常是 lv_port_font_cache 缓存字体
+    lv_font_t* owned_font;          // 控件自建的缓存字体
+    lv_draw_buf_t* scratch;         // 回退字体中的字形（不经缓存）展开到这里
+    lv_obj_t* canvas;
+    lv_draw_buf_t* buf;
+    int32_t height;
+    int32_t line_height;
+    int32_t base_line;
+    uint16_t fg;                    // RGB565
+    uint16_t bg;
+
+    int32_t cursor_x;
+    uint16_t line;                  // 光标所在行
+
+    // 当前段落：已绘制的字节数和开头部分，用于识别增量文本
+    size_t paragraph_len;
+    char paragraph[LINX_SUBTITLE_PARAGRAPH_SIZE];
+
+    linx_subtitle_stats_t stats;
+};
+
+/* ============================================================================
+ * 字形
+ * ============================================================================ */
+
+/* 向（缓存）字体查询字形和 A8 位图，字体没有该字时返回 false */
+static bool glyph_get(linx_subtitle_t* sub, uint32_t letter, subtitle_glyph_t* glyph) {
+    glyph->bitmap = NULL;
+    if (!lv_font_get_glyph_dsc(sub->font, &glyph->dsc, letter, 0)) {
+        return false;
+    }
+
+    // 占位字形和图片/矢量字形只保留前进宽度
+    const lv_font_glyph_dsc_t* dsc = &glyph->dsc;
+    if (dsc->is_placeholder || dsc->box_w == 0 || dsc->box_h == 0 || dsc->format > LV_FONT_GLYPH_FORMAT_A8) {
+        return true;
+    }
+
+    // 缓存字体直接返回缓存中的位图，scratch 只给回退字体用
+    lv_draw_buf_t* scratch = lv_draw_buf_reshape(sub->scratch, LV_COLOR_FORMAT_A8, dsc->box_w, dsc->box_h, 0);
+    if (!scratch) {
+        if (sub->scratch) {
+            lv_draw_buf_destroy(sub->scratch);
+        }
+        scratch = sub->scratch = lv_draw_buf_create(dsc->box_w, dsc->box_h, LV_COLOR_FORMAT_A8, 0);
+        if (!scratch) {
+            return true;
+        }
+    }
+    glyph->bitmap = (const lv_draw_buf_t*)lv_font_get_glyph_bitmap(&glyph->dsc, letter, scratch);
+    return true;
+}
+
+static void glyph_release(linx_subtitle_t* sub, subtitle_glyph_t* glyph) {
+    if (sub->font->release_glyph) {
+        sub->font->release_glyph(sub->font, &glyph->dsc);
+    }
+}
+
+/* ============================================================================
+ * 绘制
+ * ============================================================================ */
+
+static inline uint16_t* canvas_row(linx_subtitle_t* sub, int32_t y) {
+    return (uint16_t*)(sub->buf->data + (size_t)y * sub->buf->header.stride);
+}
+
+static void fill_rows(linx_subtitle_t* sub, int32_t y, int32_t rows) {
+    for (int32_t r = 0; r < rows; r++) {
+        uint16_t* row = canvas_row(sub, y + r);
+        for (int32_t x = 0; x < sub->config.width; x++) {
+            row[x] = sub->bg;
+        }
+    }
+}
+
+/* 按 8 位覆盖率混合 RGB565 */
+static inline uint16_t blend565(uint16_t fg, uint16_t bg, uint8_t a) {
+    uint32_t inv = 255u - a;
+    uint32_t r = (((fg >> 11) & 0x1F) * a + ((bg >> 11) & 0x1F) * inv) / 255u;
+    uint32_t g = (((fg >> 5) & 0x3F) * a + ((bg >> 5) & 0x3F) * inv) / 255u;
+    uint32_t b = ((fg & 0x1F) * a + (bg & 0x1F) * inv) / 255u;
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+/* 把字形画到 (x, 行顶 y)，返回画布上的外接矩形（裁剪后，可能为空） */
+static bool draw_glyph(linx_subtitle_t* sub, const subtitle_glyph_t* glyph, int32_t x, int32_t line_y,
+                       lv_area_t* area) {
+    if (!glyph->bitmap) {
+        return false;
+    }
+    const lv_font_glyph_dsc_t* dsc = &glyph->dsc;
+    int32_t gx = x + dsc->ofs_x;
+    int32_t gy = line_y + (sub->line_height - sub->base_line) - dsc->box_h - dsc->ofs_y;
+
+    area->x1 = LV_MAX(gx, 0);
+    area->y1 = LV_MAX(gy, line_y);
+    area->x2 = LV_MIN(gx + dsc->box_w - 1, sub->config.width - 1);
+    area->y2 = LV_MIN(gy + dsc->box_h - 1, line_y + sub->line_height - 1);
+    if (area->x1 > area->x2 || area->y1 > area->y2) {
+        return false;
+    }
+
+    for (int32_t y = area->y1; y <= area->y2; y++) {
+        const uint8_t* src = glyph->bitmap->data + (size_t)(y - gy) * glyph->bitmap->header.stride;
+        uint16_t* dst = canvas_row(sub, y);
+        for (int32_t px = area->x1; px <= area->x2; px++) {
+            uint8_t a = src[px - gx];
+            if (a == 255) {
+                dst[px] = sub->fg;
+            } else if (a) {
+                dst[px] = blend565(sub->fg, dst[px], a);
+            }
+        }
+    }
+    sub->stats.glyphs_drawn++;
+    return true;
+}
+
+/* 光标移到下一行，已在最后一行时把画布上移一行 */
+static bool next_line(linx_subtitle_t* sub) {
+    sub->cursor_x = 0;
+    if (sub->line + 1 < sub->config.lines) {
+        sub->line++;
+        return false;
+    }
+
+    size_t stride = sub->buf->header.stride;
+    size_t keep = (size_t)(sub->height - sub->line_height) * stride;
+    memmove(sub->buf->data, sub->buf->data + (size_t)sub->line_height * stride, keep);
+    fill_rows(sub, sub->height - sub->line_height, sub->line_height);
+    sub->stats.scrolls++;
+    return true;
+}
+
+/* 让画布上的矩形失效（画布坐标转屏幕坐标） */
+static void invalidate_local(linx_subtitle_t* sub, const lv_area_t* local) {
+    lv_area_t coords;
+    lv_obj_get_coords(sub->canvas, &coords);
+    lv_area_t area = *local;
+    lv_area_move(&area, coords.x1, coords.y1);
+    lv_obj_invalidate_area(sub->canvas, &area);
+}
+
+/* ============================================================================
+ * 公共接口
+ * ============================================================================ */
+
+linx_subtitle_config_t linx_subtitle_default_config(void) {
+    linx_subtitle_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.width = 240;
+    config.lines = 3;
+    config.text_color = lv_color_white();
+    config.bg_color = lv_color_black();
+    return config;
+}
+
+linx_subtitle_t* linx_subtitle_create(lv_obj_t* parent, const linx_subtitle_config_t* config) {
+    if (!parent || !config || config->width <= 0 || config->lines == 0) {
+        return NULL;
+    }
+
+    linx_subtitle_t* sub = (linx_subtitle_t*)LINX_CALLOC(1, sizeof(linx_subtitle_t));
+    if (!sub) {
+        return NULL;
+    }
+    sub->config = *config;
+    if (!sub->config.font) {
+        sub->config.font = LV_FONT_DEFAULT;
+    }
+    // 已是缓存字体（如与状态标签共用）时直接使用，否则自建一个；不能缓存的字体按原样使用
+    sub->font = sub->config.font;
+    if (!lv_port_font_cache_is(sub->font)) {
+        sub->owned_font = lv_port_font_cache_create(sub->font, sub->config.glyph_cache_bytes);
+        if (sub->owned_font) {
+            sub->font = sub->owned_font;
+        }
+    }
+    sub->line_height = lv_font_get_line_height(sub->font);
+    sub->base_line = sub->font->base_line;
+    sub->height = sub->line_height * sub->config.lines;
+    sub->fg = lv_color_to_u16(sub->config.text_color);
+    sub->bg = lv_color_to_u16(sub->config.bg_color);
+
+    sub->buf = lv_draw_buf_create(sub->config.width, sub->height, LV_COLOR_FORMAT_RGB565, 0);
+    sub->canvas = sub->buf ? lv_canvas_create(parent) : NULL;
+    if (!sub->canvas) {
+        LOG_ERROR("Subtitle: failed to create %dx%d canvas", (int)sub->config.width, (int)sub->height);
+        linx_subtitle_delete(sub);
+        return NULL;
+    }
+    fill_rows(sub, 0, sub->height);
+    lv_canvas_set_draw_buf(sub->canvas, sub->buf);
+    return sub;
+}
+
+void linx_subtitle_delete(linx_subtitle_t* subtitle) {
+    if (!subtitle) {
+        return;
+    }
+    if (subtitle->canvas) {
+        lv_obj_delete(subtitle->canvas);
+    }
+    if (subtitle->buf) {
+        lv_draw_buf_destroy(subtitle->buf);
+    }
+    if (subtitle->scratch) {
+        lv_draw_buf_destroy(subtitle->scratch);
+    }
+    lv_port_font_cache_delete(subtitle->owned_font);
+    LINX_FREE(subtitle);
+}
+
+void linx_subtitle_append(linx_subtitle_t* subtitle, const char* text) {
+    if (!subtitle || !text || !text[0]) {
+        return;
+    }
+
+    bool scrolled = false;
+    bool dirty = false;
+    lv_area_t dirty_area = {0};
+    uint32_t i = 0;
+    uint32_t letter;
+    while ((letter = _lv_text_encoded_next(text, &i)) != 0) {
+        if (letter == '\r') {
+            continue;
+        }
+        if (letter == '\n') {
+            scrolled |= next_line(subtitle);
+            continue;
+        }
+        subtitle_glyph_t glyph;
+        if (!glyph_get(subtitle, letter, &glyph)) {
+            continue;
+        }
+        if (subtitle->cursor_x > 0 && subtitle->cursor_x + glyph.dsc.adv_w > subtitle->config.width) {
+            scrolled |= next_line(subtitle);
+        }
+
+        lv_area_t area;
+        if (draw_glyph(subtitle, &glyph, subtitle->cursor_x, subtitle->line * subtitle->line_height, &area)) {
+            if (dirty) {
+                _lv_area_join(&dirty_area, &dirty_area, &area);
+            } else {
+                dirty_area = area;
+                dirty = true;
+            }
+        }
+        subtitle->cursor_x += glyph.dsc.adv_w;
+        glyph_release(subtitle, &glyph);
+    }
+
+    // 上移后整块画布已变化，否则只刷新新字形覆盖的区域
+    if (scrolled) {
+        lv_obj_invalidate(subtitle->canvas);
+    } else if (dirty) {
+        invalidate_local(subtitle, &dirty_area);
+    }
+}
+
+void linx_subtitle_update(linx_subtitle_t* subtitle, const char* text) {
+    if (!subtitle || !text) {
+        return;
+    }
+
+    size_t len = strlen(text);
+    size_t known = LV_MIN(subtitle->paragraph_len, sizeof(subtitle->paragraph));
+    if (subtitle->paragraph_len > 0 && len >= subtitle->paragraph_len &&
+        memcmp(text, subtitle->paragraph, known) == 0) {
+        linx_subtitle_append(subtitle, text + subtitle->paragraph_len);
+    } else {
+        if (subtitle->cursor_x > 0) {
+            bool scrolled = next_line(subtitle);
+            if (scrolled) {
+                lv_obj_invalidate(subtitle->canvas);
+            }
+        }
+        linx_subtitle_append(subtitle, text);
+    }
+
+    subtitle->paragraph_len = len;
+    memcpy(subtitle->paragraph, text, LV_MIN(len, sizeof(subtitle->paragraph)));
+}
+
+void linx_subtitle_clear(linx_subtitle_t* subtitle) {
+    if (!subtitle) {
+        return;
+    }
+    fill_rows(subtitle, 0, subtitle->height);
+    subtitle->cursor_x = 0;
+    subtitle->line = 0;
+    subtitle->paragraph_len = 0;
+    lv_obj_invalidate(subtitle->canvas);
+}
+
+lv_obj_t* linx_subtitle_get_obj(linx_subtitle_t* subtitle) {
+    return subtitle ? subtitle->canvas : NULL;
+}
+
+void linx_subtitle_get_stats(linx_subtitle_t* subtitle, linx_subtitle_stats_t* stats) {
+    if (!subtitle || !stats) {
+        return;
+    }
+    *stats = subtitle->stats;
+    lv_port_font_cache_stats_t cache;
+    lv_port_font_cache_get_stats(subtitle->font, &cache);
+    stats->glyph_hits = cache.hits;
+    stats->glyph_misses = cache.misses;
+    stats->glyph_evictions = cache.evictions;
+}
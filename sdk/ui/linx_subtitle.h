@@ -0,0 +1,101 @@
+/**
+ * @file linx_subtitle.h
+ * @brief 流式字幕控件
+ *
+ * 字幕画在控件自己的 RGB565 画布上，而不是 lv_label：追加文字时只绘制
+ * 新字形并只让新字形所在的矩形失效，已显示的文字不重新排版、不重新渲染。
+ * 写满最后一行时把画布内容整体上移一行（memmove），只清空并绘制新行。
+ *
+ * 字形经 lv_port_font_cache 缓存字体取得：描述查预建的有序索引，A8 位图在
+ * 按字节预算的 LRU 中直接使用，CJK 字体的 bpp 展开和解压每个字只做一次。
+ * 传入的字体已是缓存字体时（如 linx_ui 内置视图与状态标签共用的字体）直接
+ * 使用，否则控件自建一个。换行按字符折行（中文字幕的常见做法）。
+ *
+ * 只能在 LVGL 线程（linx_ui 的 UI 线程）上使用。
+ */
+
+#ifndef LINX_SUBTITLE_H
+#define LINX_SUBTITLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LINX_SUBTITLE_PARAGRAPH_SIZE    512     // 用于识别增量文本的当前段落长度上限（字节）
+
+/**
+ * 字幕配置
+ */
+typedef struct {
+    int32_t width;                  // 画布宽度（像素）
+    uint16_t lines;                 // 显示的行数
+    const lv_font_t* font;          // 字体或 lv_port_font_cache 缓存字体，NULL 使用 LV_FONT_DEFAULT
+    lv_color_t text_color;
+    lv_color_t bg_color;
+    size_t glyph_cache_bytes;       // font 不是缓存字体时自建缓存的位图预算，0 使用默认值
+} linx_subtitle_config_t;
+
+/**
+ * 字幕统计
+ */
+typedef struct {
+    uint32_t glyph_hits;            // 字形缓存命中（共用缓存字体时包含其他控件）
+    uint32_t glyph_misses;          // 需要从字体展开位图
+    uint32_t glyph_evictions;       // 超出预算时淘汰的位图
+    uint32_t glyphs_drawn;          // 绘制的字形数
+    uint32_t scrolls;               // 上移的行数
+} linx_subtitle_stats_t;
+
+typedef struct linx_subtitle linx_subtitle_t;
+
+/**
+ * 获取默认配置：240 像素宽、3 行、白字黑底
+ */
+linx_subtitle_config_t linx_subtitle_default_config(void);
+
+/**
+ * 创建字幕控件
+ */
+linx_subtitle_t* linx_subtitle_create(lv_obj_t* parent, const linx_subtitle_config_t* config);
+
+/**
+ * 删除控件并释放画布和自建的缓存字体
+ */
+void linx_subtitle_delete(linx_subtitle_t* subtitle);
+
+/**
+ * 在光标处追加 UTF-8 文本，'\n' 换行
+ */
+void linx_subtitle_append(linx_subtitle_t* subtitle, const char* text);
+
+/**
+ * 显示一段可能逐步增长的文本：以当前段落开头时只追加新增部分
+ * （如 stt 的中间结果），否则另起一行开始新段落（如下一句 sentence_start）
+ */
+void linx_subtitle_update(linx_subtitle_t* subtitle, const char* text);
+
+/**
+ * 清空画布，光标回到第一行
+ */
+void linx_subtitle_clear(linx_subtitle_t* subtitle);
+
+/**
+ * 获取控件对象，用于布局
+ */
+lv_obj_t* linx_subtitle_get_obj(linx_subtitle_t* subtitle);
+
+/**
+ * 获取统计
+ */
+void linx_subtitle_get_stats(linx_subtitle_t* subtitle, linx_subtitle_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LINX_SUBTITLE_H
@@ -0,0 +1,852 @@
+/**
+ * @file linx_ui.c
+ * @brief LVGL 界面线程实现
+ */
+
+#include "linx_ui.h"
+#include "linx_emotion.h"
+#include "linx_subtitle.h"
+#include "lvgl.h"
+#include "lv_port_mem.h"
+#include "lv_port_font_cache.h"
+#include "../log/linx_log.h"
+#include "../log/linx_alloc.h"
+#include "../log/linx_thread_stats.h"
+#include "../os/linx_os.h"
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_UI);
+
+/* 电平表默认刷新周期：约 30 帧/秒，音频周期一般为 20~60ms，更快读取只会看到同一个值 */
+#define LINX_UI_METER_PERIOD_MS     33
+#define LINX_UI_METER_RANGE_DB      60      /* 显示 -60..0 dBFS */
+#define LINX_UI_METER_DECAY_DB      3       /* 每次刷新最多回落的 dB 数 */
+
+/* UI 命令类型 */
+typedef enum {
+    LINX_UI_CMD_STATE = 0,
+    LINX_UI_CMD_EMOTION,
+    LINX_UI_CMD_SENTENCE,
+    LINX_UI_CMD_CALL
+} linx_ui_cmd_type_t;
+
+/* 内置视图的一个电平表 */
+typedef struct {
+    const audio_level_meter_t* source;
+    lv_obj_t* bar;
+    uint32_t sequence;              /* 上次读到的周期序号，不变表示没有新音频 */
+    int32_t value;                  /* 当前显示值，0..LINX_UI_METER_RANGE_DB */
+} linx_ui_meter_t;
+
+/* 队列中的一条命令 */
+typedef struct {
+    size_t sequence;                /* 槽位序号：等于写入位置+1 表示可读，等于读取位置+容量表示可写 */
+    linx_ui_cmd_type_t type;
+    LinxDeviceState state;
+    linx_ui_call_t fn;
+    void* arg;
+    char text[LINX_UI_TEXT_SIZE];
+} linx_ui_cmd_t;
+
+struct linx_ui {
+    linx_ui_config_t config;
+    const linx_ui_view_t* view;
+
+    /* 有界多生产者单消费者无锁队列（按槽位序号同步，生产者只做一次 CAS） */
+    linx_ui_cmd_t* slots;
+    size_t mask;                    /* 容量-1，容量为2的幂 */
+    size_t enqueue_pos;             /* 生产者 CAS 推进 */
+    size_t dequeue_pos;             /* 仅 UI 线程推进 */
+
+    linx_thread_t* thread;
+    bool running;
+    bool sleeping;                  /* UI 线程正在等待，入队后需要唤醒 */
+    bool wake_pending;              /* linx_ui_wake() 请求运行一次定时器 */
+    pthread_mutex_t wait_mutex;
+    pthread_cond_t wait_cond;
+
+    /* 启动握手：UI 线程完成初始化后置 started，init_ok 为初始化结果 */
+    bool started;
+    bool init_ok;
+
+    linx_ui_stats_t stats;
+
+    /* 内置视图的控件 */
+    lv_obj_t* state_label;
+    lv_obj_t* emotion_label;
+    linx_subtitle_t* subtitle;
+    lv_font_t* font_cache;          /* 标签和字幕共用，字体不能缓存时为 NULL */
+    linx_emotion_player_t* emotion_player;
+    linx_ui_meter_t meters[2];      /* 麦克风、播放 */
+    lv_timer_t* meter_timer;        /* 只在聆听和播报状态下运行 */
+
+    /* 电源策略，只在 UI 线程上访问 */
+    linx_ui_power_profile_t power_profiles[LINX_UI_POWER_PROFILES];
+    const linx_ui_power_profile_t* profile;     /* 当前状态的档位 */
+    lv_timer_t* dim_timer;          /* 等待无活动超时，调暗后暂停 */
+    bool dimmed;
+    int backlight;                  /* 最近设置的亮度，-1 表示未设置 */
+    uint32_t frame_divider;         /* 刷新和动画周期的倍数（原子读写），1 为档位原值 */
+};
+
+/* 默认档位：聆听和播报全速；空闲和断开时暂停动画、放慢刷新，无活动后调暗或关闭背光 */
+static const linx_ui_power_profile_t s_default_power_profiles[LINX_UI_POWER_PROFILES] = {
+    [LINX_DEVICE_STATE_IDLE]         = { 50, 0,  true,  60,  15000, 10 },
+    [LINX_DEVICE_STATE_CONNECTING]   = { 33, 66, false, 80,  0,     0  },
+    [LINX_DEVICE_STATE_LISTENING]    = { 16, 0,  false, 100, 0,     0  },
+    [LINX_DEVICE_STATE_SPEAKING]     = { 16, 0,  false, 100, 0,     0  },
+    [LINX_DEVICE_STATE_DISCONNECTED] = { 50, 0,  true,  40,  5000,  0  },
+    [LINX_DEVICE_STATE_ERROR]        = { 50, 0,  true,  60,  30000, 0  },
+};
+
+/* 内置视图动画的帧间隔：档位值乘以降帧倍数，档位不限帧率时以电平表周期为基准 */
+static uint32_t linx_ui_anim_period(linx_ui_t* ui) {
+    uint32_t divider = __atomic_load_n(&ui->frame_divider, __ATOMIC_RELAXED);
+    uint32_t period = ui->profile->anim_period_ms;
+    if (divider <= 1) {
+        return period;
+    }
+    return (period ? period : LINX_UI_METER_PERIOD_MS) * divider;
+}
+
+/* 显示刷新周期 */
+static uint32_t linx_ui_refr_period(linx_ui_t* ui) {
+    uint32_t divider = __atomic_load_n(&ui->frame_divider, __ATOMIC_RELAXED);
+    uint32_t period = ui->profile->refr_period_ms ? ui->profile->refr_period_ms : LV_DEF_REFR_PERIOD;
+    return divider > 1 ? period * divider : period;
+}
+
+/* ============================================================================
+ * 内置视图
+ * ============================================================================ */
+
+static const char* linx_ui_state_name(LinxDeviceState state) {
+    switch (state) {
+        case LINX_DEVICE_STATE_IDLE:         return "Idle";
+        case LINX_DEVICE_STATE_CONNECTING:   return "Connecting";
+        case LINX_DEVICE_STATE_LISTENING:    return "Listening";
+        case LINX_DEVICE_STATE_SPEAKING:     return "Speaking";
+        case LINX_DEVICE_STATE_DISCONNECTED: return "Disconnected";
+        case LINX_DEVICE_STATE_ERROR:        return "Error";
+        default:                             return "Unknown";
+    }
+}
+
+/* 读取电平信箱：快速上升、缓慢回落，信箱没有更新时按静音回落 */
+static void default_view_meter_tick(lv_timer_t* timer) {
+    linx_ui_t* ui = (linx_ui_t*)lv_timer_get_user_data(timer);
+    for (size_t i = 0; i < sizeof(ui->meters) / sizeof(ui->meters[0]); i++) {
+        linx_ui_meter_t* meter = &ui->meters[i];
+        if (!meter->bar) {
+            continue;
+        }
+        audio_level_t level;
+        audio_level_meter_read(meter->source, &level);
+        int32_t target = 0;
+        if (level.sequence != meter->sequence) {
+            meter->sequence = level.sequence;
+            float db = audio_level_to_dbfs(level.rms, -(float)LINX_UI_METER_RANGE_DB);
+            target = (int32_t)(db + (float)LINX_UI_METER_RANGE_DB + 0.5f);
+        }
+        if (target < meter->value - LINX_UI_METER_DECAY_DB) {
+            target = meter->value - LINX_UI_METER_DECAY_DB;
+        }
+        meter->value = target;
+        lv_bar_set_value(meter->bar, target, LV_ANIM_OFF);
+    }
+}
+
+static bool default_view_create_meter(linx_ui_t* ui, lv_obj_t* screen, size_t index,
+                                      const audio_level_meter_t* source, lv_align_t align, int32_t x) {
+    if (!source) {
+        return true;
+    }
+    linx_ui_meter_t* meter = &ui->meters[index];
+    meter->source = source;
+    meter->bar = lv_bar_create(screen);
+    if (!meter->bar) {
+        return false;
+    }
+    // 高大于宽时 lv_bar 自动竖向填充
+    lv_obj_set_size(meter->bar, 8, lv_pct(40));
+    lv_bar_set_range(meter->bar, 0, LINX_UI_METER_RANGE_DB);
+    lv_obj_align(meter->bar, align, x, 0);
+    return true;
+}
+
+static bool default_view_create(void* user_data) {
+    linx_ui_t* ui = (linx_ui_t*)user_data;
+    lv_obj_t* screen = lv_screen_active();
+
+    const lv_font_t* font = ui->config.font ? ui->config.font : LV_FONT_DEFAULT;
+    ui->font_cache = lv_port_font_cache_create(font, ui->config.font_cache_bytes);
+    if (ui->font_cache) {
+        font = ui->font_cache;
+    } else {
+        LOG_WARN("UI: font cannot be cached, glyphs are expanded on every redraw");
+    }
+
+    ui->state_label = lv_label_create(screen);
+    ui->emotion_label = lv_label_create(screen);
+    if (!ui->state_label || !ui->emotion_label) {
+        return false;
+    }
+    lv_obj_set_style_text_font(ui->state_label, font, LV_PART_MAIN);
+    lv_obj_set_style_text_font(ui->emotion_label, font, LV_PART_MAIN);
+
+    lv_label_set_text(ui->state_label, linx_ui_state_name(LINX_DEVICE_STATE_IDLE));
+    lv_obj_align(ui->state_label, LV_ALIGN_TOP_MID, 0, 8);
+
+    lv_label_set_text(ui->emotion_label, "");
+    lv_obj_align(ui->emotion_label, LV_ALIGN_CENTER, 0, 0);
+
+    // 配置了表情动画时以动画代替表情文字
+    if (ui->config.emotions) {
+        ui->emotion_player = linx_emotion_player_create(ui->config.emotions, screen);
+        if (!ui->emotion_player) {
+            return false;
+        }
+        lv_obj_align(linx_emotion_player_get_obj(ui->emotion_player), LV_ALIGN_CENTER, 0, 0);
+        linx_emotion_player_set_pace(ui->emotion_player, linx_ui_anim_period(ui), ui->profile->anim_paused);
+        linx_emotion_player_show(ui->emotion_player, NULL);
+    }
+
+    // 字幕占屏宽的 90%，固定在底部，底色与屏幕一致
+    linx_subtitle_config_t subtitle_config = linx_subtitle_default_config();
+    subtitle_config.width = lv_display_get_horizontal_resolution(lv_display_get_default()) * 9 / 10;
+    subtitle_config.bg_color = lv_obj_get_style_bg_color(screen, LV_PART_MAIN);
+    subtitle_config.text_color = lv_obj_get_style_text_color(screen, LV_PART_MAIN);
+    subtitle_config.font = font;
+    subtitle_config.glyph_cache_bytes = ui->config.font_cache_bytes;
+    ui->subtitle = linx_subtitle_create(screen, &subtitle_config);
+    if (!ui->subtitle) {
+        return false;
+    }
+    lv_obj_align(linx_subtitle_get_obj(ui->subtitle), LV_ALIGN_BOTTOM_MID, 0, -8);
+
+    // 电平表在屏幕两侧，定时器创建后先暂停，空闲界面仍然不醒
+    if (!default_view_create_meter(ui, screen, 0, ui->config.capture_level, LV_ALIGN_LEFT_MID, 8) ||
+        !default_view_create_meter(ui, screen, 1, ui->config.playback_level, LV_ALIGN_RIGHT_MID, -8)) {
+        return false;
+    }
+    if (ui->meters[0].bar || ui->meters[1].bar) {
+        ui->meter_timer = lv_timer_create(default_view_meter_tick, LINX_UI_METER_PERIOD_MS, ui);
+        if (!ui->meter_timer) {
+            return false;
+        }
+        lv_timer_pause(ui->meter_timer);
+    }
+    return true;
+}
+
+static void default_view_destroy(void* user_data) {
+    linx_ui_t* ui = (linx_ui_t*)user_data;
+    linx_emotion_player_delete(ui->emotion_player);
+    ui->emotion_player = NULL;
+    if (ui->meter_timer) {
+        lv_timer_delete(ui->meter_timer);
+        ui->meter_timer = NULL;
+    }
+    for (size_t i = 0; i < sizeof(ui->meters) / sizeof(ui->meters[0]); i++) {
+        if (ui->meters[i].bar) {
+            lv_obj_delete(ui->meters[i].bar);
+        }
+    }
+    memset(ui->meters, 0, sizeof(ui->meters));
+    lv_obj_delete(ui->state_label);
+    lv_obj_delete(ui->emotion_label);
+    linx_subtitle_delete(ui->subtitle);
+    ui->state_label = NULL;
+    ui->emotion_label = NULL;
+    ui->subtitle = NULL;
+    // 使用该字体的控件都已删除
+    lv_port_font_cache_delete(ui->font_cache);
+    ui->font_cache = NULL;
+}
+
+static void default_view_on_state(LinxDeviceState state, void* user_data) {
+    linx_ui_t* ui = (linx_ui_t*)user_data;
+    lv_label_set_text(ui->state_label, linx_ui_state_name(state));
+
+    // 档位已在命令处理时切换
+    const linx_ui_power_profile_t* profile = ui->profile;
+    uint32_t anim_period = linx_ui_anim_period(ui);
+    linx_emotion_player_set_pace(ui->emotion_player, anim_period, profile->anim_paused);
+
+    if (!ui->meter_timer) {
+        return;
+    }
+    if ((state == LINX_DEVICE_STATE_LISTENING || state == LINX_DEVICE_STATE_SPEAKING) && !profile->anim_paused) {
+        lv_timer_set_period(ui->meter_timer, anim_period ? anim_period : LINX_UI_METER_PERIOD_MS);
+        lv_timer_resume(ui->meter_timer);
+        return;
+    }
+    lv_timer_pause(ui->meter_timer);
+    for (size_t i = 0; i < sizeof(ui->meters) / sizeof(ui->meters[0]); i++) {
+        if (ui->meters[i].bar) {
+            ui->meters[i].value = 0;
+            lv_bar_set_value(ui->meters[i].bar, 0, LV_ANIM_OFF);
+        }
+    }
+}
+
+static void default_view_on_emotion(const char* emotion, void* user_data) {
+    linx_ui_t* ui = (linx_ui_t*)user_data;
+    if (ui->emotion_player && linx_emotion_player_show(ui->emotion_player, emotion)) {
+        return;
+    }
+    lv_label_set_text(ui->emotion_label, emotion);
+}
+
+static void default_view_on_sentence(const char* text, void* user_data) {
+    linx_ui_t* ui = (linx_ui_t*)user_data;
+    linx_subtitle_update(ui->subtitle, text);
+}
+
+static const linx_ui_view_t s_default_view = {
+    .create = default_view_create,
+    .destroy = default_view_destroy,
+    .on_state = default_view_on_state,
+    .on_emotion = default_view_on_emotion,
+    .on_sentence = default_view_on_sentence,
+};
+
+/* ============================================================================
+ * 电源策略
+ * ============================================================================ */
+
+static void linx_ui_set_backlight(linx_ui_t* ui, uint8_t percent) {
+    if (ui->config.set_backlight && ui->backlight != (int)percent) {
+        ui->config.set_backlight(percent, ui->config.user_data);
+    }
+    ui->backlight = percent;
+}
+
+/* 恢复当前档位的背光，重新开始无活动计时 */
+static void linx_ui_power_wake(linx_ui_t* ui) {
+    const linx_ui_power_profile_t* profile = ui->profile;
+    ui->dimmed = false;
+    linx_ui_set_backlight(ui, profile->backlight);
+    if (!ui->dim_timer) {
+        return;
+    }
+    if (profile->dim_after_ms > 0) {
+        lv_timer_set_period(ui->dim_timer, profile->dim_after_ms);
+        lv_timer_reset(ui->dim_timer);
+        lv_timer_resume(ui->dim_timer);
+    } else {
+        lv_timer_pause(ui->dim_timer);
+    }
+}
+
+/* 输入设备的活动也会推迟调暗：到期时按 LVGL 记录的无活动时间重新计时 */
+static void linx_ui_dim_tick(lv_timer_t* timer) {
+    linx_ui_t* ui = (linx_ui_t*)lv_timer_get_user_data(timer);
+    const linx_ui_power_profile_t* profile = ui->profile;
+    uint32_t inactive = lv_display_get_inactive_time(NULL);
+    if (inactive < profile->dim_after_ms) {
+        lv_timer_set_period(timer, profile->dim_after_ms - inactive);
+        return;
+    }
+    lv_timer_pause(timer);
+    ui->dimmed = true;
+    linx_ui_set_backlight(ui, profile->dim_backlight);
+    __atomic_add_fetch(&ui->stats.dims, 1, __ATOMIC_RELAXED);
+}
+
+/* 切换到设备状态的档位：刷新周期和背光在这里设置，内置视图的动画在 on_state 中调整 */
+static void linx_ui_power_apply(linx_ui_t* ui, LinxDeviceState state) {
+    size_t index = (size_t)state < LINX_UI_POWER_PROFILES ? (size_t)state : LINX_DEVICE_STATE_ERROR;
+    ui->profile = &ui->power_profiles[index];
+
+    lv_display_t* display = lv_display_get_default();
+    lv_timer_t* refr_timer = display ? lv_display_get_refr_timer(display) : NULL;
+    if (refr_timer) {
+        lv_timer_set_period(refr_timer, linx_ui_refr_period(ui));
+    }
+    lv_display_trigger_activity(NULL);
+    linx_ui_power_wake(ui);
+}
+
+/* 降帧倍数改变后重新设置刷新和动画周期，不算作活动 */
+static void linx_ui_frame_rate_apply(void* arg) {
+    linx_ui_t* ui = (linx_ui_t*)arg;
+    lv_display_t* display = lv_display_get_default();
+    lv_timer_t* refr_timer = display ? lv_display_get_refr_timer(display) : NULL;
+    if (refr_timer) {
+        lv_timer_set_period(refr_timer, linx_ui_refr_period(ui));
+    }
+    uint32_t anim_period = linx_ui_anim_period(ui);
+    linx_emotion_player_set_pace(ui->emotion_player, anim_period, ui->profile->anim_paused);
+    if (ui->meter_timer) {
+        lv_timer_set_period(ui->meter_timer, anim_period ? anim_period : LINX_UI_METER_PERIOD_MS);
+    }
+}
+
+/* 调暗后有输入设备活动时恢复背光 */
+static void linx_ui_power_check(linx_ui_t* ui) {
+    if (ui->dimmed && lv_display_get_inactive_time(NULL) < ui->profile->dim_after_ms) {
+        linx_ui_power_wake(ui);
+    }
+}
+
+static void linx_ui_power_activity(void* arg) {
+    linx_ui_t* ui = (linx_ui_t*)arg;
+    lv_display_trigger_activity(NULL);
+    linx_ui_power_wake(ui);
+}
+
+/* ============================================================================
+ * 命令队列
+ * ============================================================================ */
+
+/* LVGL 的系统节拍，使用单调时钟 */
+static uint32_t linx_ui_tick_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u);
+}
+
+/* LVGL 的堆经 SDK 分配器（计入 ui 模块）：控件等小对象为 HOT，绘制缓冲为 BULK */
+static void* linx_ui_lv_malloc(size_t size) {
+    return LINX_MALLOC(size);
+}
+
+static void* linx_ui_lv_realloc(void* p, size_t size) {
+    return LINX_REALLOC(p, size);
+}
+
+static void linx_ui_lv_free(void* p) {
+    LINX_FREE(p);
+}
+
+static void* linx_ui_lv_buf_malloc(size_t size) {
+    return LINX_MALLOC_BULK(size);
+}
+
+static const lv_port_mem_hooks_t s_lv_mem_hooks = {
+    .malloc_fn = linx_ui_lv_malloc,
+    .realloc_fn = linx_ui_lv_realloc,
+    .free_fn = linx_ui_lv_free,
+    .buf_malloc_fn = linx_ui_lv_buf_malloc,
+    .buf_free_fn = linx_ui_lv_free,
+};
+
+/* 视图回调的 user_data：内置视图使用界面自身 */
+static void* linx_ui_view_data(linx_ui_t* ui) {
+    return ui->view == &s_default_view ? (void*)ui : ui->config.user_data;
+}
+
+/* 把 text 复制进 dst，超长时在 UTF-8 字符边界截断 */
+static void linx_ui_copy_text(char* dst, const char* text) {
+    size_t len = text ? strlen(text) : 0;
+    if (len >= LINX_UI_TEXT_SIZE) {
+        len = LINX_UI_TEXT_SIZE - 1;
+        while (len > 0 && ((unsigned char)text[len] & 0xC0) == 0x80) {
+            len--;
+        }
+    }
+    if (len > 0) {
+        memcpy(dst, text, len);
+    }
+    dst[len] = '\0';
+}
+
+/* UI 线程空闲时唤醒，它忙于渲染时入队不涉及任何锁 */
+static void linx_ui_signal(linx_ui_t* ui) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ui->sleeping, __ATOMIC_RELAXED)) {
+        pthread_mutex_lock(&ui->wait_mutex);
+        pthread_cond_signal(&ui->wait_cond);
+        pthread_mutex_unlock(&ui->wait_mutex);
+    }
+}
+
+/* 抢占一个槽位，队列满时返回 NULL；*pos 返回写入位置 */
+static linx_ui_cmd_t* linx_ui_reserve(linx_ui_t* ui, size_t* pos_out) {
+    size_t pos = __atomic_load_n(&ui->enqueue_pos, __ATOMIC_RELAXED);
+    for (;;) {
+        linx_ui_cmd_t* slot = &ui->slots[pos & ui->mask];
+        size_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&ui->enqueue_pos, &pos, pos + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                *pos_out = pos;
+                return slot;
+            }
+        } else if (diff < 0) {
+            __atomic_add_fetch(&ui->stats.dropped, 1, __ATOMIC_RELAXED);
+            return NULL;  /* 队列已满 */
+        } else {
+            pos = __atomic_load_n(&ui->enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+/* 发布已写好的槽位并唤醒 UI 线程 */
+static void linx_ui_commit(linx_ui_t* ui, linx_ui_cmd_t* slot, size_t pos) {
+    __atomic_store_n(&slot->sequence, pos + 1, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&ui->stats.posted, 1, __ATOMIC_RELAXED);
+    linx_ui_signal(ui);
+}
+
+/* 队首命令是否已写完可读 */
+static bool linx_ui_pending(linx_ui_t* ui) {
+    size_t pos = ui->dequeue_pos;
+    linx_ui_cmd_t* slot = &ui->slots[pos & ui->mask];
+    return __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) == pos + 1;
+}
+
+/* 在 UI 线程上执行队列中已写完的命令，返回执行的条数 */
+static size_t linx_ui_drain(linx_ui_t* ui) {
+    size_t count = 0;
+    size_t capacity = ui->mask + 1;
+    void* view_data = linx_ui_view_data(ui);
+
+    while (linx_ui_pending(ui)) {
+        size_t pos = ui->dequeue_pos;
+        linx_ui_cmd_t* slot = &ui->slots[pos & ui->mask];
+
+        switch (slot->type) {
+            case LINX_UI_CMD_STATE:
+                linx_ui_power_apply(ui, slot->state);
+                if (ui->view->on_state) {
+                    ui->view->on_state(slot->state, view_data);
+                }
+                break;
+            case LINX_UI_CMD_EMOTION:
+                linx_ui_power_activity(ui);
+                if (ui->view->on_emotion) {
+                    ui->view->on_emotion(slot->text, view_data);
+                }
+                break;
+            case LINX_UI_CMD_SENTENCE:
+                linx_ui_power_activity(ui);
+                if (ui->view->on_sentence) {
+                    ui->view->on_sentence(slot->text, view_data);
+                }
+                break;
+            case LINX_UI_CMD_CALL:
+                slot->fn(slot->arg);
+                break;
+        }
+
+        __atomic_store_n(&slot->sequence, pos + capacity, __ATOMIC_RELEASE);
+        ui->dequeue_pos = pos + 1;
+        count++;
+    }
+    return count;
+}
+
+/* ============================================================================
+ * UI 线程
+ * ============================================================================ */
+
+/* 等待命令或唤醒请求，timeout_ms 为 LV_NO_TIMER_READY 时不设超时 */
+static void linx_ui_wait(linx_ui_t* ui, uint32_t timeout_ms) {
+    struct timespec deadline;
+    if (timeout_ms != LV_NO_TIMER_READY) {
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += timeout_ms / 1000;
+        deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec += 1;
+            deadline.tv_nsec -= 1000000000L;
+        }
+    }
+
+    pthread_mutex_lock(&ui->wait_mutex);
+    __atomic_store_n(&ui->sleeping, true, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    int rc = 0;
+    while (rc != ETIMEDOUT && __atomic_load_n(&ui->running, __ATOMIC_ACQUIRE) &&
+           !__atomic_load_n(&ui->wake_pending, __ATOMIC_ACQUIRE) && !linx_ui_pending(ui)) {
+        if (timeout_ms == LV_NO_TIMER_READY) {
+            rc = pthread_cond_wait(&ui->wait_cond, &ui->wait_mutex);
+        } else {
+            rc = pthread_cond_timedwait(&ui->wait_cond, &ui->wait_mutex, &deadline);
+        }
+    }
+    if (rc != ETIMEDOUT) {
+        __atomic_add_fetch(&ui->stats.wakeups, 1, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&ui->sleeping, false, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&ui->wait_mutex);
+}
+
+/* 在 UI 线程上初始化 LVGL、显示和视图，结果通过启动握手返回 */
+static bool linx_ui_thread_init(linx_ui_t* ui) {
+    lv_port_mem_set_hooks(&s_lv_mem_hooks);
+    lv_init();
+    lv_port_mem_init_draw_buf();
+    lv_tick_set_cb(linx_ui_tick_ms);
+
+    if (!ui->config.display_init(ui->config.user_data)) {
+        LOG_ERROR("UI: display init failed");
+        lv_deinit();
+        return false;
+    }
+
+    // 视图创建前选好档位，内置视图按它设置动画节奏
+    ui->backlight = -1;
+    ui->dim_timer = lv_timer_create(linx_ui_dim_tick, 1000, ui);
+    if (ui->dim_timer) {
+        lv_timer_pause(ui->dim_timer);
+    }
+    linx_ui_power_apply(ui, LINX_DEVICE_STATE_IDLE);
+
+    if (ui->view->create && !ui->view->create(linx_ui_view_data(ui))) {
+        LOG_ERROR("UI: view create failed");
+        if (ui->config.display_deinit) {
+            ui->config.display_deinit(ui->config.user_data);
+        }
+        lv_deinit();
+        return false;
+    }
+    return true;
+}
+
+static void* linx_ui_thread(void* arg) {
+    linx_ui_t* ui = (linx_ui_t*)arg;
+    linx_thread_stats_register("ui", LINX_THREAD_STAGE_UI);
+
+    bool ok = linx_ui_thread_init(ui);
+    pthread_mutex_lock(&ui->wait_mutex);
+    ui->init_ok = ok;
+    ui->started = true;
+    pthread_cond_broadcast(&ui->wait_cond);
+    pthread_mutex_unlock(&ui->wait_mutex);
+    if (!ok) {
+        linx_thread_stats_unregister();
+        return NULL;
+    }
+
+    while (__atomic_load_n(&ui->running, __ATOMIC_ACQUIRE)) {
+        __atomic_store_n(&ui->wake_pending, false, __ATOMIC_RELAXED);
+        linx_ui_drain(ui);
+        linx_ui_power_check(ui);
+
+        // 控件属性变化会恢复刷新定时器，处理命令后运行一次即可重绘；
+        // 没有脏区域和动画时返回 LV_NO_TIMER_READY
+        uint32_t next_ms = lv_timer_handler();
+        __atomic_add_fetch(&ui->stats.handler_runs, 1, __ATOMIC_RELAXED);
+        if (next_ms == LV_NO_TIMER_READY && ui->config.max_sleep_ms > 0) {
+            next_ms = ui->config.max_sleep_ms;
+        }
+        if (next_ms > 0) {
+            linx_ui_wait(ui, next_ms);
+        }
+    }
+
+    if (ui->view->destroy) {
+        ui->view->destroy(linx_ui_view_data(ui));
+    }
+    if (ui->config.display_deinit) {
+        ui->config.display_deinit(ui->config.user_data);
+    }
+    lv_deinit();
+    linx_thread_stats_unregister();
+    return NULL;
+}
+
+/* ============================================================================
+ * 公共接口
+ * ============================================================================ */
+
+const linx_ui_power_profile_t* linx_ui_default_power_profiles(void) {
+    return s_default_power_profiles;
+}
+
+linx_ui_config_t linx_ui_default_config(void) {
+    linx_ui_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.queue_size = LINX_UI_DEFAULT_QUEUE_SIZE;
+    return config;
+}
+
+linx_ui_t* linx_ui_create(const linx_ui_config_t* config) {
+    if (!config || !config->display_init) {
+        LOG_ERROR("UI: display_init is required");
+        return NULL;
+    }
+
+    linx_ui_t* ui = (linx_ui_t*)LINX_CALLOC(1, sizeof(linx_ui_t));
+    if (!ui) {
+        return NULL;
+    }
+    ui->config = *config;
+    ui->frame_divider = 1;
+    ui->view = config->view ? config->view : &s_default_view;
+    memcpy(ui->power_profiles, config->power_profiles ? config->power_profiles : s_default_power_profiles,
+           sizeof(ui->power_profiles));
+
+    size_t queue_size = config->queue_size ? config->queue_size : LINX_UI_DEFAULT_QUEUE_SIZE;
+    size_t capacity = 2;
+    while (capacity < queue_size) {
+        capacity <<= 1;
+    }
+    ui->slots = (linx_ui_cmd_t*)LINX_MALLOC(capacity * sizeof(linx_ui_cmd_t));
+    if (!ui->slots) {
+        LINX_FREE(ui);
+        return NULL;
+    }
+    for (size_t i = 0; i < capacity; i++) {
+        ui->slots[i].sequence = i;
+    }
+    ui->mask = capacity - 1;
+
+    ui->running = true;
+    pthread_mutex_init(&ui->wait_mutex, NULL);
+    pthread_cond_init(&ui->wait_cond, NULL);
+    const linx_thread_attr_t defaults = {
+        .name = "ui",
+        .priority = LINX_THREAD_PRIORITY_LOW,
+        .core_mask = LINX_THREAD_UI_CORE_MASK
+    };
+    linx_thread_attr_t attr = linx_thread_attr_merge(&config->thread_attr, &defaults);
+    ui->thread = linx_thread_create(&attr, linx_ui_thread, ui);
+    if (!ui->thread) {
+        LOG_ERROR("UI: failed to create thread");
+        pthread_cond_destroy(&ui->wait_cond);
+        pthread_mutex_destroy(&ui->wait_mutex);
+        LINX_FREE(ui->slots);
+        LINX_FREE(ui);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&ui->wait_mutex);
+    while (!ui->started) {
+        pthread_cond_wait(&ui->wait_cond, &ui->wait_mutex);
+    }
+    bool ok = ui->init_ok;
+    pthread_mutex_unlock(&ui->wait_mutex);
+    if (!ok) {
+        linx_thread_join(ui->thread);
+        pthread_cond_destroy(&ui->wait_cond);
+        pthread_mutex_destroy(&ui->wait_mutex);
+        LINX_FREE(ui->slots);
+        LINX_FREE(ui);
+        return NULL;
+    }
+
+    LOG_INFO("UI: started, queue %zu", capacity);
+    return ui;
+}
+
+void linx_ui_destroy(linx_ui_t* ui) {
+    if (!ui) {
+        return;
+    }
+
+    pthread_mutex_lock(&ui->wait_mutex);
+    __atomic_store_n(&ui->running, false, __ATOMIC_RELEASE);
+    pthread_cond_signal(&ui->wait_cond);
+    pthread_mutex_unlock(&ui->wait_mutex);
+    linx_thread_join(ui->thread);
+
+    pthread_cond_destroy(&ui->wait_cond);
+    pthread_mutex_destroy(&ui->wait_mutex);
+    LINX_FREE(ui->slots);
+    LINX_FREE(ui);
+}
+
+bool linx_ui_post_event(linx_ui_t* ui, const LinxEvent* event) {
+    if (!ui || !event) {
+        return false;
+    }
+
+    linx_ui_cmd_type_t type;
+    const char* text = NULL;
+    switch (event->type) {
+        case LINX_EVENT_STATE_CHANGED:
+            type = LINX_UI_CMD_STATE;
+            break;
+        case LINX_EVENT_EMOTION_MESSAGE:
+            type = LINX_UI_CMD_EMOTION;
+            text = event->data.emotion.value;
+            break;
+        case LINX_EVENT_TEXT_MESSAGE:
+        case LINX_EVENT_SENTENCE_START:
+            type = LINX_UI_CMD_SENTENCE;
+            text = event->data.text_message.text;
+            break;
+        default:
+            return false;
+    }
+
+    size_t pos;
+    linx_ui_cmd_t* slot = linx_ui_reserve(ui, &pos);
+    if (!slot) {
+        LOG_WARN_EVERY_MS(1000, "UI: command queue full, event %d dropped", (int)event->type);
+        return false;
+    }
+    slot->type = type;
+    if (type == LINX_UI_CMD_STATE) {
+        slot->state = event->data.state_changed.new_state;
+    } else {
+        linx_ui_copy_text(slot->text, text);
+    }
+    linx_ui_commit(ui, slot, pos);
+    return true;
+}
+
+void linx_ui_event_callback(const LinxEvent* event, void* user_data) {
+    linx_ui_post_event((linx_ui_t*)user_data, event);
+}
+
+bool linx_ui_call(linx_ui_t* ui, linx_ui_call_t fn, void* arg) {
+    if (!ui || !fn) {
+        return false;
+    }
+
+    size_t pos;
+    linx_ui_cmd_t* slot = linx_ui_reserve(ui, &pos);
+    if (!slot) {
+        LOG_WARN_EVERY_MS(1000, "UI: command queue full, call dropped");
+        return false;
+    }
+    slot->type = LINX_UI_CMD_CALL;
+    slot->fn = fn;
+    slot->arg = arg;
+    linx_ui_commit(ui, slot, pos);
+    return true;
+}
+
+void linx_ui_wake(linx_ui_t* ui) {
+    if (!ui) {
+        return;
+    }
+    __atomic_store_n(&ui->wake_pending, true, __ATOMIC_RELEASE);
+    linx_ui_signal(ui);
+}
+
+void linx_ui_get_stats(linx_ui_t* ui, linx_ui_stats_t* stats) {
+    if (!ui || !stats) {
+        return;
+    }
+    stats->posted = __atomic_load_n(&ui->stats.posted, __ATOMIC_RELAXED);
+    stats->dropped = __atomic_load_n(&ui->stats.dropped, __ATOMIC_RELAXED);
+    stats->handler_runs = __atomic_load_n(&ui->stats.handler_runs, __ATOMIC_RELAXED);
+    stats->wakeups = __atomic_load_n(&ui->stats.wakeups, __ATOMIC_RELAXED);
+    stats->dims = __atomic_load_n(&ui->stats.dims, __ATOMIC_RELAXED);
+}
+
+bool linx_ui_notify_activity(linx_ui_t* ui) {
+    return linx_ui_call(ui, linx_ui_power_activity, ui);
+}
+
+bool linx_ui_set_frame_divider(linx_ui_t* ui, uint32_t divider) {
+    if (!ui || divider == 0) {
+        return false;
+    }
+    __atomic_store_n(&ui->frame_divider, divider, __ATOMIC_RELAXED);
+    return linx_ui_call(ui, linx_ui_frame_rate_apply, ui);
+}
+
+bool linx_ui_governor_apply(void* user_data, int level) {
+    return level >= 0 && level < 31 && linx_ui_set_frame_divider((linx_ui_t*)user_data, 1u << level);
+}
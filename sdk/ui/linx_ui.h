@@ -0,0 +1,202 @@
+/**
+ * @file linx_ui.h
+ * @brief LVGL 界面线程
+ *
+ * SDK 事件（状态变化、表情、句子开始和识别文本）在任意线程投递到有界无锁队列，
+ * 由专用的 LVGL 线程取出并更新界面。所有 LVGL 调用都发生在该线程上
+ * （lv_conf.h 中 LV_USE_OS 为 NONE，LVGL 本身不加锁）。
+ *
+ * UI 线程不按固定 10ms 节拍调用 lv_timer_handler()：每轮处理完命令后
+ * 调用一次，按其返回的下一个定时器到期时间睡眠。没有脏区域、动画和
+ * 轮询输入设备时 LVGL 的定时器全部暂停，线程一直睡到下一条命令，
+ * 空闲界面在语音会话期间不占 CPU。
+ *
+ * 用法：
+ *   linx_ui_config_t config = linx_ui_default_config();
+ *   config.display_init = my_display_init;   // UI 线程上创建显示和输入设备
+ *   linx_ui_t* ui = linx_ui_create(&config);
+ *   linx_sdk_set_event_callback(sdk, linx_ui_event_callback, ui);
+ *   // 或在应用自己的事件回调中调用 linx_ui_post_event(ui, event)
+ *
+ * LVGL 的堆（lv_port_mem.h）接到 SDK 分配器并计入 ui 模块：控件、样式等小对象按
+ * LINX_ALLOC_HOT 分配，图像和画布的绘制缓冲按 LINX_ALLOC_BULK 分配，配合
+ * linx_alloc_placement_hooks() 可把后者放进 PSRAM。
+ *
+ * 内置视图可显示麦克风和播放电平表：音频线程在 audio_interface_read/write 中测得
+ * 每个周期的电平并写入无锁单值信箱（audio_level.h），UI 线程只在聆听和播报状态下
+ * 按显示节奏读取，音频路径上不加锁，也不向 UI 线程投递命令。
+ *
+ * 内置视图的状态、表情标签和字幕共用一个 lv_port_font_cache 缓存字体：字形查找走
+ * 预建的有序索引，展开后的位图按字节预算保留，长回答滚动时 CJK 字形不再逐帧解压。
+ *
+ * 电源档位（linx_ui_power_profile_t）按设备状态调节显示刷新周期、内置视图的动画帧率
+ * 和背光：聆听和播报时全速，空闲和断开时暂停动画、放慢刷新，无活动一段时间后调暗
+ * 或关闭背光。状态、表情和文本命令以及输入设备的读取都算作活动，会恢复背光；
+ * 调暗后没有运行的定时器，UI 线程一直睡到下一条命令。
+ *
+ * 输入设备应设为 LV_INDEV_MODE_EVENT，由驱动在有输入时通过 linx_ui_call()
+ * 调用 lv_indev_read()；定时轮询的输入设备会让 UI 线程按读取周期醒来。
+ */
+
+#ifndef LINX_UI_H
+#define LINX_UI_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "../linx_sdk.h"
+#include "../audio/audio_level.h"
+#include "../os/linx_os.h"
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 命令中文本的最大字节数（含结尾0），更长的句子按 UTF-8 字符边界截断 */
+#define LINX_UI_TEXT_SIZE 256
+
+/* 默认命令队列容量 */
+#define LINX_UI_DEFAULT_QUEUE_SIZE 32
+
+/* 电源档位数，按 LinxDeviceState 索引 */
+#define LINX_UI_POWER_PROFILES 6
+
+typedef struct linx_ui linx_ui_t;
+struct linx_emotion_cache;
+
+/* 在 UI 线程上执行的函数 */
+typedef void (*linx_ui_call_t)(void* arg);
+
+/**
+ * 界面视图：全部回调都在 UI 线程上调用，可以直接操作 LVGL 对象
+ */
+typedef struct {
+    bool (*create)(void* user_data);                             // 创建控件（display_init 之后），返回 false 时创建失败
+    void (*destroy)(void* user_data);                            // 删除控件（可为 NULL）
+    void (*on_state)(LinxDeviceState state, void* user_data);    // 设备状态变化（可为 NULL）
+    void (*on_emotion)(const char* emotion, void* user_data);    // 表情，如 "happy"（可为 NULL）
+    void (*on_sentence)(const char* text, void* user_data);      // 开始播报的句子或识别文本，可能是上一段的延长（可为 NULL）
+} linx_ui_view_t;
+
+/**
+ * 电源档位：一个设备状态下的刷新、动画和背光策略
+ */
+typedef struct {
+    uint32_t refr_period_ms;    // 显示刷新周期，即有脏区域时的最短重绘间隔，0 使用 LV_DEF_REFR_PERIOD
+    uint32_t anim_period_ms;    // 内置视图动画（表情、电平表）的最短帧间隔，0 按动画自身的帧率
+    bool anim_paused;           // 暂停内置视图的动画，表情停在当前帧
+    uint8_t backlight;          // 背光亮度 0-100
+    uint32_t dim_after_ms;      // 无活动多久后调暗背光，0 不调暗
+    uint8_t dim_backlight;      // 调暗后的亮度，0 关闭背光
+} linx_ui_power_profile_t;
+
+/**
+ * 界面配置
+ */
+typedef struct {
+    size_t queue_size;                          // 命令队列容量，0 使用默认值，向上取 2 的幂
+    bool (*display_init)(void* user_data);      // lv_init() 之后在 UI 线程上创建显示和输入设备，返回 false 时创建失败
+    void (*display_deinit)(void* user_data);    // lv_deinit() 之前在 UI 线程上释放显示（可为 NULL）
+    const linx_ui_view_t* view;                 // 界面视图，NULL 使用内置的状态、表情和流式字幕（linx_subtitle.h）
+    struct linx_emotion_cache* emotions;        // 内置视图的表情动画（见 linx_emotion.h），NULL 时以文字显示表情
+    const audio_level_meter_t* capture_level;   // 内置视图的麦克风电平表（audio_interface_set_level_meters），NULL 不显示
+    const audio_level_meter_t* playback_level;  // 内置视图的播放电平表，NULL 不显示
+    const lv_font_t* font;                      // 内置视图的字体（如中文字体），NULL 使用 LV_FONT_DEFAULT
+    size_t font_cache_bytes;                    // 内置视图字形缓存的位图预算，0 使用默认值
+    void* user_data;                            // 传给 display_init / display_deinit 和视图回调
+    uint32_t max_sleep_ms;                      // 没有待运行定时器时的最长睡眠，0 表示一直等到有命令
+    const linx_ui_power_profile_t* power_profiles;     // LINX_UI_POWER_PROFILES 项，创建时复制，NULL 使用默认档位
+    void (*set_backlight)(uint8_t percent, void* user_data);  // 在 UI 线程上设置背光亮度（可为 NULL）
+    linx_thread_attr_t thread_attr;             // UI 线程属性（见 os/linx_os.h），零值字段取默认值：名称 "ui"、
+                                                // LOW 优先级（低于音频和网络线程），核位图 LINX_THREAD_UI_CORE_MASK
+} linx_ui_config_t;
+
+/**
+ * 界面统计
+ */
+typedef struct {
+    uint64_t posted;            // 入队的命令数
+    uint64_t dropped;           // 队列满时丢弃的命令数
+    uint64_t handler_runs;      // lv_timer_handler() 调用次数
+    uint64_t wakeups;           // UI 线程被命令唤醒的次数
+    uint64_t dims;              // 无活动调暗背光的次数
+} linx_ui_stats_t;
+
+/**
+ * 获取默认配置
+ */
+linx_ui_config_t linx_ui_default_config(void);
+
+/**
+ * 获取默认电源档位（LINX_UI_POWER_PROFILES 项，按 LinxDeviceState 索引）
+ */
+const linx_ui_power_profile_t* linx_ui_default_power_profiles(void);
+
+/**
+ * 创建界面：启动 UI 线程，在该线程上初始化 LVGL、显示和视图后返回
+ * @param config 配置，display_init 不能为空
+ * @return 界面句柄，线程启动或初始化失败时返回 NULL
+ */
+linx_ui_t* linx_ui_create(const linx_ui_config_t* config);
+
+/**
+ * 停止 UI 线程并释放界面（未处理的命令被丢弃）
+ */
+void linx_ui_destroy(linx_ui_t* ui);
+
+/**
+ * 投递 SDK 事件，只处理状态变化、表情、句子开始和文本消息（stt），其他事件忽略
+ * 任意线程可调用，不加锁；事件中的字符串在返回前已复制
+ * @return 事件已入队返回 true，事件被忽略或队列已满返回 false
+ */
+bool linx_ui_post_event(linx_ui_t* ui, const LinxEvent* event);
+
+/**
+ * 可直接注册为 SDK 事件回调的包装，user_data 为 linx_ui_t*
+ */
+void linx_ui_event_callback(const LinxEvent* event, void* user_data);
+
+/**
+ * 在 UI 线程上执行 fn(arg)，用于从其他线程修改 LVGL 对象
+ * @return 已入队返回 true，队列已满返回 false
+ */
+bool linx_ui_call(linx_ui_t* ui, linx_ui_call_t fn, void* arg);
+
+/**
+ * 唤醒 UI 线程运行一次 lv_timer_handler()，
+ * 用于 LVGL 之外的代码（如显示驱动的刷新完成中断）改变了定时器状态
+ */
+void linx_ui_wake(linx_ui_t* ui);
+
+/**
+ * 报告 LVGL 之外的用户活动（如实体按键），恢复当前档位的背光并重新开始无活动计时
+ * 任意线程可调用
+ * @return 已入队返回 true，队列已满返回 false
+ */
+bool linx_ui_notify_activity(linx_ui_t* ui);
+
+/**
+ * 降低界面帧率：当前档位的刷新周期和内置视图的动画帧间隔乘以 divider，1 恢复档位原值
+ * 任意线程可调用，在 UI 线程上生效，不算作活动
+ * @return 已入队返回 true，队列已满或 divider 为 0 返回 false
+ */
+bool linx_ui_set_frame_divider(linx_ui_t* ui, uint32_t divider);
+
+/**
+ * 质量调速器的界面帧率调节回调（linx_governor_apply_t，user_data 为 linx_ui_t*）：
+ * 第 level 级帧率降为 1/2^level，例如
+ *   linx_sdk_set_governor_knob(sdk, LINX_GOVERNOR_UI_FPS, 2, linx_ui_governor_apply, ui);
+ */
+bool linx_ui_governor_apply(void* user_data, int level);
+
+/**
+ * 获取界面统计
+ */
+void linx_ui_get_stats(linx_ui_t* ui, linx_ui_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LINX_UI_H
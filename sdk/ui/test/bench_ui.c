@@ -0,0 +1,837 @@
+/**
+ * @file bench_ui.c
+ * @brief SDK 标准界面的离屏渲染基准
+ *
+ * 不需要屏幕和窗口：LVGL 软件渲染器经 lv_port_disp 画进部分刷新缓冲，
+ * 面板的 flush_start 只统计像素后立即完成传输。逐个界面测量：
+ * - status:   状态文字、表情文字和两侧的电平表（与 linx_ui 内置视图相同的控件）
+ * - emotion:  linx_emotion 播放 RLE 压缩的 RGB565 循环动画
+ * - subtitle: linx_subtitle 逐字追加一段中英文混合的长回答，写满后滚动
+ *             （Makefile 打开 LV_FONT_SIMSUN_16_CJK，否则中文没有字形）
+ * - answer:   多段长回答放在一个折行的 lv_label 中，每帧上移 2 像素
+ * - camera:   camera_preview 把 640x480 的 BGRA 帧缩放进显示格式的缓冲并显示
+ *
+ * 每个界面先渲染一次整屏（首帧），然后运行 -n 帧，每帧前改变界面内容并把
+ * LVGL 的节拍推进 -p 毫秒（虚拟时钟，动画和定时器的进度与真实帧率一致，
+ * 结果不受机器负载影响）。每帧耗时是 lv_timer_handler() 的调用时间，
+ * 即定时器、动画、布局和渲染之和；摄像头帧的缩放在生产者线程完成，不计入。
+ *
+ * 输出每个界面的帧耗时（平均、p95、最大）、每帧刷新的像素（传给面板的
+ * 脏区域，已按 lv_port_disp 的规则合并和对齐）和内存峰值（跟踪分配器在
+ * 该界面生存期内相对创建前的最高增量，含 LVGL 堆、解码帧和绘制缓冲）。
+ *
+ * -C 读取 build/configs 下的板级配置：CONFIG_DISPLAY_HOR_RES / VER_RES /
+ * BUF_LINES 决定分辨率和部分刷新缓冲的行数，和产品的面板一致。-t 指定帧
+ * 预算，任一界面的 p95 超过预算时返回 1，用于在上板前发现超出低端面板
+ * 帧预算的界面改动。宿主机比目标板快，预算应按两者的比例换算。
+ *
+ * 标签和字幕与 linx_ui 内置视图一样使用 lv_port_font_cache 缓存字体，每个界面
+ * 开始前清空缓存，首帧包含字形展开；-G 让标签直接使用原字体，用于对比
+ * （字幕控件总是经缓存取字形）。
+ *
+ * 前后对照：修改前 -o before.csv 保存结果，修改后 -b before.csv 输出变化百分比。
+ *
+ * 用法: bench_ui [-W 宽] [-H 高] [-L 缓冲行数] [-n 帧数] [-p 帧间隔毫秒] [-f 名称过滤]
+ *                [-C 板级配置] [-t 帧预算毫秒] [-o 结果.csv] [-b 基线.csv] [-G]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include "lvgl.h"
+#include "lv_port_disp.h"
+#include "lv_port_mem.h"
+#include "lv_port_font_cache.h"
+#include "linx_log.h"
+#include "linx_alloc.h"
+#include "ui/linx_emotion.h"
+#include "ui/linx_subtitle.h"
+#include "camera/camera_preview.h"
+
+LINX_ALLOC_MODULE_DEFINE(LINX_ALLOC_MODULE_UI);
+
+#define BENCH_DEFAULT_WIDTH      240
+#define BENCH_DEFAULT_HEIGHT     240
+#define BENCH_DEFAULT_FRAMES     300
+#define BENCH_DEFAULT_PERIOD_MS  33
+#define BENCH_MAX_FRAMES         10000
+#define BENCH_MAX_BASELINE       64
+#define BENCH_MAX_CONFIG_ITEMS   64
+#define BENCH_EMOTION_SIZE       120
+#define BENCH_EMOTION_FRAMES     8
+#define BENCH_EMOTION_FRAME_MS   66
+#define BENCH_CAMERA_WIDTH       640
+#define BENCH_CAMERA_HEIGHT      480
+#define BENCH_METER_RANGE        60
+#define BENCH_ANSWER_REPEAT      4
+#define BENCH_ANSWER_SCROLL_PX   2
+
+// 字幕按 tts 的速度追加：约每 2 帧一个字
+static const char* const s_answer =
+    "今天北京晴，最高气温二十六度，最低气温十五度，空气质量良好，适合户外活动。"
+    "Tomorrow will be cloudy with a light breeze from the north-east. "
+    "明天多云，午后可能有阵雨，出门记得带伞。周末气温回升，紫外线较强，注意防晒。";
+
+// -C: 板级配置项（KEY=VALUE，值已去掉引号）
+typedef struct {
+    char key[48];
+    char value[80];
+} bench_config_item_t;
+
+static char s_config_name[64];
+static bench_config_item_t s_config_items[BENCH_MAX_CONFIG_ITEMS];
+static int s_config_count = 0;
+
+#define BENCH_NAME_SIZE          80      // 界面名@配置名
+
+typedef struct {
+    char name[BENCH_NAME_SIZE];
+    double avg_ms;
+} bench_baseline_t;
+
+/**
+ * @brief 一个界面的测量结果
+ */
+typedef struct {
+    double first_ms;            // 首帧（整屏）耗时
+    double avg_ms;
+    double p95_ms;
+    double max_ms;
+    double pixels_per_frame;    // 首帧之后每帧刷新的平均像素
+    double flushes_per_frame;
+    size_t peak_bytes;          // 界面生存期内的内存峰值增量
+} bench_result_t;
+
+/**
+ * @brief 被测界面：create 在当前屏幕上建控件，frame 在每帧渲染前改变内容（不计时），
+ *        present 是 UI 线程在渲染前要做的工作（计入帧耗时，可为 NULL）
+ */
+typedef struct {
+    const char* name;
+    bool (*create)(lv_obj_t* screen);
+    void (*frame)(uint32_t index);
+    void (*present)(void);
+    void (*destroy)(void);
+} bench_screen_t;
+
+static lv_display_t* s_display = NULL;
+static uint32_t s_tick_ms = 0;
+static int32_t s_width = BENCH_DEFAULT_WIDTH;
+static int32_t s_height = BENCH_DEFAULT_HEIGHT;
+static const lv_font_t* s_font = NULL;      // 标签和字幕的字体，通常是缓存字体
+static lv_font_t* s_font_cache = NULL;
+
+// ==================== 显示与内存 ====================
+
+static uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// 虚拟时钟：每帧推进固定的毫秒数
+static uint32_t bench_tick(void) {
+    return s_tick_ms;
+}
+
+// 面板传输立即完成，只有 lv_port_disp 的统计记录脏区域
+static void bench_flush_start(const lv_area_t* area, const uint8_t* px, void* user_data) {
+    (void)area;
+    (void)px;
+    (void)user_data;
+    lv_port_disp_flush_done(s_display);
+}
+
+// 与 linx_ui 相同：LVGL 的堆经 SDK 分配器，绘制缓冲为 BULK
+static void* bench_lv_malloc(size_t size) {
+    return LINX_MALLOC(size);
+}
+
+static void* bench_lv_realloc(void* p, size_t size) {
+    return LINX_REALLOC(p, size);
+}
+
+static void bench_lv_free(void* p) {
+    LINX_FREE(p);
+}
+
+static void* bench_lv_buf_malloc(size_t size) {
+    return LINX_MALLOC_BULK(size);
+}
+
+static const lv_port_mem_hooks_t s_lv_mem_hooks = {
+    .malloc_fn = bench_lv_malloc,
+    .realloc_fn = bench_lv_realloc,
+    .free_fn = bench_lv_free,
+    .buf_malloc_fn = bench_lv_buf_malloc,
+    .buf_free_fn = bench_lv_free,
+};
+
+// ==================== status ====================
+
+static const char* const s_states[] = { "Listening", "Speaking", "Idle", "Connecting" };
+static const char* const s_emotions[] = { "happy", "thinking", "neutral", "surprised" };
+
+static lv_obj_t* s_state_label = NULL;
+static lv_obj_t* s_emotion_label = NULL;
+static lv_obj_t* s_meters[2] = { NULL, NULL };
+
+static bool status_create(lv_obj_t* screen) {
+    s_state_label = lv_label_create(screen);
+    s_emotion_label = lv_label_create(screen);
+    s_meters[0] = lv_bar_create(screen);
+    s_meters[1] = lv_bar_create(screen);
+    if (!s_state_label || !s_emotion_label || !s_meters[0] || !s_meters[1]) {
+        return false;
+    }
+    lv_obj_set_style_text_font(s_state_label, s_font, LV_PART_MAIN);
+    lv_obj_set_style_text_font(s_emotion_label, s_font, LV_PART_MAIN);
+    lv_label_set_text(s_state_label, s_states[0]);
+    lv_obj_align(s_state_label, LV_ALIGN_TOP_MID, 0, 8);
+    lv_label_set_text(s_emotion_label, s_emotions[0]);
+    lv_obj_align(s_emotion_label, LV_ALIGN_CENTER, 0, 0);
+    for (int i = 0; i < 2; i++) {
+        lv_obj_set_size(s_meters[i], 8, lv_pct(40));
+        lv_bar_set_range(s_meters[i], 0, BENCH_METER_RANGE);
+        lv_obj_align(s_meters[i], i == 0 ? LV_ALIGN_LEFT_MID : LV_ALIGN_RIGHT_MID, i == 0 ? 8 : -8, 0);
+    }
+    return true;
+}
+
+static void status_frame(uint32_t index) {
+    // 电平表每帧变化（说话时的常态），状态和表情每 2 秒换一次
+    lv_bar_set_value(s_meters[0], (int32_t)((index * 7) % BENCH_METER_RANGE), LV_ANIM_OFF);
+    lv_bar_set_value(s_meters[1], (int32_t)((index * 13 + 20) % BENCH_METER_RANGE), LV_ANIM_OFF);
+    if (index % 60 == 59) {
+        lv_label_set_text(s_state_label, s_states[(index / 60) % 4]);
+        lv_label_set_text(s_emotion_label, s_emotions[(index / 60) % 4]);
+    }
+}
+
+static void status_destroy(void) {
+    lv_obj_t* objs[] = { s_state_label, s_emotion_label, s_meters[0], s_meters[1] };
+    for (size_t i = 0; i < sizeof(objs) / sizeof(objs[0]); i++) {
+        if (objs[i]) {
+            lv_obj_delete(objs[i]);
+        }
+    }
+    s_state_label = NULL;
+    s_emotion_label = NULL;
+    s_meters[0] = NULL;
+    s_meters[1] = NULL;
+}
+
+// ==================== emotion ====================
+
+static uint8_t* s_emotion_asset = NULL;
+static size_t s_emotion_asset_size = 0;
+static linx_emotion_cache_t* s_emotion_cache = NULL;
+static linx_emotion_player_t* s_emotion_player = NULL;
+
+/**
+ * @brief 生成 RLE 压缩的 RGB565 循环动画：每行几段纯色，逐帧平移，与实际表情资源的压缩率相近
+ */
+static bool emotion_build_asset(void) {
+    const int size = BENCH_EMOTION_SIZE;
+    const int frames = BENCH_EMOTION_FRAMES;
+    // 最坏情况每个像素一个控制字节
+    size_t capacity = sizeof(linx_emotion_file_header_t) + (size_t)frames * 8 +
+                      (size_t)frames * ((size_t)size * size * 3 + 4);
+    uint8_t* data = (uint8_t*)calloc(1, capacity);
+    if (!data) {
+        return false;
+    }
+
+    linx_emotion_file_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, LINX_EMOTION_MAGIC, 4);
+    header.version = LINX_EMOTION_VERSION;
+    header.format = LINX_EMOTION_FORMAT_RGB565;
+    header.compression = LINX_EMOTION_COMPRESSION_RLE;
+    header.flags = LINX_EMOTION_FLAG_LOOP;
+    header.width = (uint16_t)size;
+    header.height = (uint16_t)size;
+    header.frame_count = (uint16_t)frames;
+    header.frame_ms = BENCH_EMOTION_FRAME_MS;
+    header.frames_offset = sizeof(header);
+
+    size_t table = header.frames_offset;
+    size_t pos = table + (size_t)frames * 8;
+    for (int f = 0; f < frames; f++) {
+        uint32_t offset = (uint32_t)pos;
+        for (int y = 0; y < size; y++) {
+            int x = 0;
+            while (x < size) {
+                // 每 12 像素一段颜色，段的起点随帧移动
+                int run = 12 - ((x + f * 3 + y / 8) % 12);
+                if (run > size - x) {
+                    run = size - x;
+                }
+                uint16_t color = (uint16_t)(((x + f * 3) / 12 * 0x0841 + y / 8 * 0x1000) & 0xFFFF);
+                if (run >= 2) {
+                    data[pos++] = (uint8_t)(run + 126);
+                    memcpy(data + pos, &color, 2);
+                    pos += 2;
+                } else {
+                    data[pos++] = 0;
+                    memcpy(data + pos, &color, 2);
+                    pos += 2;
+                }
+                x += run;
+            }
+        }
+        uint32_t frame_size = (uint32_t)pos - offset;
+        memcpy(data + table + (size_t)f * 8, &offset, 4);
+        memcpy(data + table + (size_t)f * 8 + 4, &frame_size, 4);
+        pos = (pos + 3) & ~(size_t)3;
+    }
+    memcpy(data, &header, sizeof(header));
+    s_emotion_asset = data;
+    s_emotion_asset_size = pos;
+    return true;
+}
+
+static bool emotion_create(lv_obj_t* screen) {
+    if (!s_emotion_asset && !emotion_build_asset()) {
+        return false;
+    }
+    s_emotion_cache = linx_emotion_cache_create(0);
+    if (!s_emotion_cache ||
+        !linx_emotion_cache_add_memory(s_emotion_cache, "happy", s_emotion_asset, s_emotion_asset_size)) {
+        return false;
+    }
+    s_emotion_player = linx_emotion_player_create(s_emotion_cache, screen);
+    if (!s_emotion_player) {
+        return false;
+    }
+    lv_obj_align(linx_emotion_player_get_obj(s_emotion_player), LV_ALIGN_CENTER, 0, 0);
+    return linx_emotion_player_show(s_emotion_player, "happy");
+}
+
+static void emotion_frame(uint32_t index) {
+    // 动画由播放器的定时器按虚拟时钟推进
+    (void)index;
+}
+
+static void emotion_destroy(void) {
+    linx_emotion_player_delete(s_emotion_player);
+    linx_emotion_cache_destroy(s_emotion_cache);
+    s_emotion_player = NULL;
+    s_emotion_cache = NULL;
+}
+
+// ==================== subtitle ====================
+
+static linx_subtitle_t* s_subtitle = NULL;
+static size_t s_subtitle_pos = 0;
+
+static bool subtitle_create(lv_obj_t* screen) {
+    linx_subtitle_config_t config = linx_subtitle_default_config();
+    config.width = s_width * 9 / 10;
+    config.bg_color = lv_obj_get_style_bg_color(screen, LV_PART_MAIN);
+    config.text_color = lv_obj_get_style_text_color(screen, LV_PART_MAIN);
+    config.font = s_font;
+    s_subtitle = linx_subtitle_create(screen, &config);
+    if (!s_subtitle) {
+        return false;
+    }
+    lv_obj_align(linx_subtitle_get_obj(s_subtitle), LV_ALIGN_BOTTOM_MID, 0, -8);
+    s_subtitle_pos = 0;
+    return true;
+}
+
+static void subtitle_frame(uint32_t index) {
+    if (index % 2 != 0) {
+        return;
+    }
+    size_t len = strlen(s_answer);
+    if (s_subtitle_pos >= len) {
+        s_subtitle_pos = 0;
+        linx_subtitle_append(s_subtitle, "\n");
+    }
+    // 追加一个完整的 UTF-8 字符
+    char text[8];
+    size_t n = 1;
+    while (s_subtitle_pos + n < len && ((unsigned char)s_answer[s_subtitle_pos + n] & 0xC0) == 0x80) {
+        n++;
+    }
+    memcpy(text, s_answer + s_subtitle_pos, n);
+    text[n] = '\0';
+    s_subtitle_pos += n;
+    linx_subtitle_append(s_subtitle, text);
+}
+
+static void subtitle_destroy(void) {
+    linx_subtitle_delete(s_subtitle);
+    s_subtitle = NULL;
+}
+
+// ==================== answer ====================
+
+static lv_obj_t* s_answer_label = NULL;
+static int32_t s_answer_range = 1;          // 可上移的像素
+
+static bool answer_create(lv_obj_t* screen) {
+    size_t len = strlen(s_answer);
+    char* text = (char*)malloc((len + 1) * BENCH_ANSWER_REPEAT);
+    s_answer_label = text ? lv_label_create(screen) : NULL;
+    if (!s_answer_label) {
+        free(text);
+        return false;
+    }
+    char* p = text;
+    for (int i = 0; i < BENCH_ANSWER_REPEAT; i++) {
+        memcpy(p, s_answer, len);
+        p += len;
+        *p++ = i + 1 < BENCH_ANSWER_REPEAT ? '\n' : '\0';
+    }
+    lv_obj_set_width(s_answer_label, s_width * 9 / 10);
+    lv_obj_set_style_text_font(s_answer_label, s_font, LV_PART_MAIN);
+    lv_label_set_long_mode(s_answer_label, LV_LABEL_LONG_WRAP);
+    lv_label_set_text(s_answer_label, text);
+    free(text);
+    lv_obj_align(s_answer_label, LV_ALIGN_TOP_MID, 0, 0);
+    lv_obj_update_layout(s_answer_label);
+    s_answer_range = LV_MAX(lv_obj_get_height(s_answer_label) - s_height, 1);
+    return true;
+}
+
+static void answer_frame(uint32_t index) {
+    // 到底后回到开头
+    int32_t y = (int32_t)((index * BENCH_ANSWER_SCROLL_PX) % (uint32_t)s_answer_range);
+    lv_obj_set_y(s_answer_label, -y);
+}
+
+static void answer_destroy(void) {
+    if (s_answer_label) {
+        lv_obj_delete(s_answer_label);
+        s_answer_label = NULL;
+    }
+}
+
+// ==================== camera ====================
+
+static camera_preview_t* s_preview = NULL;
+static uint8_t* s_camera_frame = NULL;
+
+static bool camera_create(lv_obj_t* screen) {
+    if (!s_camera_frame) {
+        s_camera_frame = (uint8_t*)malloc((size_t)BENCH_CAMERA_WIDTH * BENCH_CAMERA_HEIGHT * 4);
+        if (!s_camera_frame) {
+            return false;
+        }
+    }
+    camera_preview_config_t config = camera_preview_default_config();
+    config.width = s_width;
+    config.height = s_height * 3 / 4;
+    s_preview = camera_preview_create(screen, &config);
+    if (!s_preview) {
+        return false;
+    }
+    lv_obj_align(camera_preview_get_obj(s_preview), LV_ALIGN_TOP_MID, 0, 0);
+    return true;
+}
+
+static void camera_frame(uint32_t index) {
+    // 移动的渐变，保证每帧内容不同
+    for (int y = 0; y < BENCH_CAMERA_HEIGHT; y++) {
+        uint8_t* row = s_camera_frame + (size_t)y * BENCH_CAMERA_WIDTH * 4;
+        for (int x = 0; x < BENCH_CAMERA_WIDTH; x++) {
+            row[x * 4 + 0] = (uint8_t)(x + index * 4);
+            row[x * 4 + 1] = (uint8_t)(y + index * 2);
+            row[x * 4 + 2] = (uint8_t)((x ^ y) + index);
+            row[x * 4 + 3] = 0xFF;
+        }
+    }
+    CameraPixels pixels;
+    pixels.data = s_camera_frame;
+    pixels.stride = (size_t)BENCH_CAMERA_WIDTH * 4;
+    pixels.width = BENCH_CAMERA_WIDTH;
+    pixels.height = BENCH_CAMERA_HEIGHT;
+    pixels.format = CAMERA_PIXEL_BGRA32;
+    camera_preview_submit(s_preview, &pixels);
+}
+
+static void camera_present(void) {
+    camera_preview_present(s_preview);
+}
+
+static void camera_destroy(void) {
+    camera_preview_delete(s_preview);
+    s_preview = NULL;
+}
+
+static const bench_screen_t s_screens[] = {
+    { "status",   status_create,   status_frame,   NULL,           status_destroy   },
+    { "emotion",  emotion_create,  emotion_frame,  NULL,           emotion_destroy  },
+    { "subtitle", subtitle_create, subtitle_frame, NULL,           subtitle_destroy },
+    { "answer",   answer_create,   answer_frame,   NULL,           answer_destroy   },
+    { "camera",   camera_create,   camera_frame,   camera_present, camera_destroy   },
+};
+
+// ==================== 测量 ====================
+
+static uint64_t bench_render(const bench_screen_t* screen) {
+    uint64_t start = bench_now_ns();
+    if (screen->present) {
+        screen->present();
+    }
+    lv_timer_handler();
+    return bench_now_ns() - start;
+}
+
+static int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+/**
+ * @brief 测量一个界面
+ */
+static bool bench_screen(const bench_screen_t* screen, uint32_t frames, uint32_t period_ms,
+                         bench_result_t* result) {
+    memset(result, 0, sizeof(*result));
+    uint64_t* times = (uint64_t*)malloc(sizeof(uint64_t) * frames);
+    if (!times) {
+        return false;
+    }
+
+    // 每个界面从空缓存开始，首帧和内存峰值包含它自己的字形
+    lv_port_font_cache_flush(s_font_cache);
+    size_t base_bytes = linx_alloc_get_total(NULL);
+    linx_alloc_reset_peak();
+
+    lv_obj_t* active = lv_screen_active();
+    if (!screen->create(active)) {
+        fprintf(stderr, "创建界面失败: %s\n", screen->name);
+        screen->destroy();
+        free(times);
+        return false;
+    }
+
+    lv_port_disp_stats_t before;
+    lv_port_disp_stats_t after;
+
+    // 首帧：整屏失效后渲染一次
+    lv_obj_invalidate(active);
+    screen->frame(0);
+    s_tick_ms += period_ms;
+    result->first_ms = (double)bench_render(screen) / 1e6;
+
+    lv_port_disp_get_stats(s_display, &before);
+    double total_ns = 0.0;
+    for (uint32_t i = 0; i < frames; i++) {
+        screen->frame(i + 1);
+        s_tick_ms += period_ms;
+        times[i] = bench_render(screen);
+        total_ns += (double)times[i];
+    }
+    lv_port_disp_get_stats(s_display, &after);
+
+    size_t peak_bytes = 0;
+    linx_alloc_get_total(&peak_bytes);
+    screen->destroy();
+    // 删除控件后刷新一次，下一个界面从空屏开始
+    s_tick_ms += period_ms;
+    lv_timer_handler();
+
+    qsort(times, frames, sizeof(uint64_t), compare_u64);
+    size_t p95 = (size_t)((double)frames * 0.95);
+    if (p95 >= frames) {
+        p95 = frames - 1;
+    }
+    result->avg_ms = total_ns / frames / 1e6;
+    result->p95_ms = (double)times[p95] / 1e6;
+    result->max_ms = (double)times[frames - 1] / 1e6;
+    result->pixels_per_frame = (double)(after.pixels - before.pixels) / frames;
+    result->flushes_per_frame = (double)(after.flushes - before.flushes) / frames;
+    result->peak_bytes = peak_bytes > base_bytes ? peak_bytes - base_bytes : 0;
+    free(times);
+    return true;
+}
+
+// ==================== 板级配置与结果 ====================
+
+static const char* config_value(const char* key) {
+    for (int i = 0; i < s_config_count; i++) {
+        if (strcmp(s_config_items[i].key, key) == 0) {
+            return s_config_items[i].value;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief 读取 build/configs/<板子>.config（与 linxos.py 相同的 KEY=VALUE 格式）
+ */
+static bool load_board_config(const char* path) {
+    FILE* fp = fopen(path, "r");
+    if (!fp) {
+        fprintf(stderr, "无法打开板级配置: %s\n", path);
+        return false;
+    }
+
+    const char* base = strrchr(path, '/');
+    snprintf(s_config_name, sizeof(s_config_name), "%s", base ? base + 1 : path);
+    char* ext = strstr(s_config_name, ".config");
+    if (ext) {
+        *ext = '\0';
+    }
+
+    char line[256];
+    while (fgets(line, sizeof(line), fp) && s_config_count < BENCH_MAX_CONFIG_ITEMS) {
+        line[strcspn(line, "\r\n")] = '\0';
+        char* eq = strchr(line, '=');
+        if (line[0] == '#' || !eq) {
+            continue;
+        }
+        *eq = '\0';
+        char* value = eq + 1;
+        size_t len = strlen(value);
+        if (len >= 2 && (value[0] == '"' || value[0] == '\'') && value[len - 1] == value[0]) {
+            value[len - 1] = '\0';
+            value++;
+        }
+        bench_config_item_t* item = &s_config_items[s_config_count++];
+        snprintf(item->key, sizeof(item->key), "%.*s", (int)sizeof(item->key) - 1, line);
+        snprintf(item->value, sizeof(item->value), "%.*s", (int)sizeof(item->value) - 1, value);
+    }
+    fclose(fp);
+    return true;
+}
+
+static size_t load_baseline(const char* path, bench_baseline_t* baseline, size_t max_entries) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "无法打开基线文件: %s\n", path);
+        return 0;
+    }
+    char line[256];
+    size_t count = 0;
+    while (count < max_entries && fgets(line, sizeof(line), file)) {
+        char name[BENCH_NAME_SIZE];
+        double avg_ms = 0.0;
+        if (sscanf(line, "%79[^,],%lf", name, &avg_ms) == 2) {
+            snprintf(baseline[count].name, sizeof(baseline[count].name), "%s", name);
+            baseline[count].avg_ms = avg_ms;
+            count++;
+        }
+    }
+    fclose(file);
+    return count;
+}
+
+static const bench_baseline_t* find_baseline(const bench_baseline_t* baseline, size_t count, const char* name) {
+    for (size_t i = 0; i < count; i++) {
+        if (strcmp(baseline[i].name, name) == 0) {
+            return &baseline[i];
+        }
+    }
+    return NULL;
+}
+
+static void report(FILE* csv, const char* name, const bench_result_t* result,
+                   const bench_baseline_t* baseline, size_t baseline_count) {
+    char change[16] = "";
+    const bench_baseline_t* before = find_baseline(baseline, baseline_count, name);
+    if (before && before->avg_ms > 0) {
+        snprintf(change, sizeof(change), "%+.1f%%", (result->avg_ms - before->avg_ms) / before->avg_ms * 100.0);
+    }
+    double screen_pixels = (double)s_width * (double)s_height;
+    printf("%-20s %8.2f %8.3f %8.3f %8.3f %9.0f %6.1f%% %7.1f %9.1f %8s\n", name,
+           result->first_ms, result->avg_ms, result->p95_ms, result->max_ms,
+           result->pixels_per_frame, result->pixels_per_frame / screen_pixels * 100.0,
+           result->flushes_per_frame, (double)result->peak_bytes / 1024.0, change);
+    if (csv) {
+        fprintf(csv, "%s,%.4f,%.4f,%.4f,%.4f,%.0f,%.2f,%zu\n", name, result->avg_ms, result->p95_ms,
+                result->max_ms, result->first_ms, result->pixels_per_frame, result->flushes_per_frame,
+                result->peak_bytes);
+    }
+}
+
+static void usage(const char* program) {
+    printf("用法: %s [-W 宽] [-H 高] [-L 缓冲行数] [-n 帧数] [-p 帧间隔毫秒] [-f 名称过滤]\n"
+           "       [-C 板级配置] [-t 帧预算毫秒] [-o 结果.csv] [-b 基线.csv] [-G]\n", program);
+    printf("  -W/-H  分辨率 (默认 %dx%d，覆盖 -C 配置)\n", BENCH_DEFAULT_WIDTH, BENCH_DEFAULT_HEIGHT);
+    printf("  -L  部分刷新缓冲的行数 (默认高度的 1/10)\n");
+    printf("  -n  每个界面渲染的帧数 (默认 %d)\n", BENCH_DEFAULT_FRAMES);
+    printf("  -p  每帧推进的虚拟时间 (默认 %d 毫秒)\n", BENCH_DEFAULT_PERIOD_MS);
+    printf("  -f  只运行名称包含该字符串的界面\n");
+    printf("  -C  按 build/configs 下的板级配置运行（CONFIG_DISPLAY_HOR_RES / VER_RES / BUF_LINES）\n");
+    printf("  -t  帧预算，任一界面的 p95 帧耗时超过时返回 1\n");
+    printf("  -o  把结果写入 CSV（名称,平均,p95,最大,首帧毫秒,像素/帧,传输/帧,峰值字节）\n");
+    printf("  -b  与之前 -o 保存的结果对比，输出平均帧耗时的变化百分比\n");
+    printf("  -G  标签不使用字形缓存\n");
+}
+
+int main(int argc, char* argv[]) {
+    int32_t width = 0;
+    int32_t height = 0;
+    uint32_t buf_lines = 0;
+    uint32_t frames = BENCH_DEFAULT_FRAMES;
+    uint32_t period_ms = BENCH_DEFAULT_PERIOD_MS;
+    double budget_ms = 0.0;
+    const char* filter = NULL;
+    const char* config_path = NULL;
+    const char* output_path = NULL;
+    const char* baseline_path = NULL;
+    bool glyph_cache = true;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "W:H:L:n:p:f:C:t:o:b:Gh")) != -1) {
+        switch (opt) {
+            case 'W': width = atoi(optarg); break;
+            case 'H': height = atoi(optarg); break;
+            case 'L': buf_lines = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'n': frames = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'p': period_ms = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'f': filter = optarg; break;
+            case 'C': config_path = optarg; break;
+            case 't': budget_ms = atof(optarg); break;
+            case 'o': output_path = optarg; break;
+            case 'b': baseline_path = optarg; break;
+            case 'G': glyph_cache = false; break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 2;
+        }
+    }
+    if (config_path) {
+        if (!load_board_config(config_path)) {
+            return 1;
+        }
+        const char* value;
+        if (!width && (value = config_value("CONFIG_DISPLAY_HOR_RES"))) {
+            width = atoi(value);
+        }
+        if (!height && (value = config_value("CONFIG_DISPLAY_VER_RES"))) {
+            height = atoi(value);
+        }
+        if (!buf_lines && (value = config_value("CONFIG_DISPLAY_BUF_LINES"))) {
+            buf_lines = (uint32_t)strtoul(value, NULL, 10);
+        }
+    }
+    s_width = width > 0 ? width : BENCH_DEFAULT_WIDTH;
+    s_height = height > 0 ? height : BENCH_DEFAULT_HEIGHT;
+    if (frames < 1 || frames > BENCH_MAX_FRAMES || period_ms < 1 || s_width < 16 || s_height < 16) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    log_config_t log_config = LOG_DEFAULT_CONFIG;
+    log_config.level = LOG_LEVEL_WARN;
+    log_init(&log_config);
+
+    // 跟踪分配器须在任何分配之前安装
+    if (!linx_alloc_tracking_enable(NULL)) {
+        fprintf(stderr, "无法安装跟踪分配器\n");
+        return 1;
+    }
+
+    bench_baseline_t baseline[BENCH_MAX_BASELINE];
+    size_t baseline_count = baseline_path ? load_baseline(baseline_path, baseline, BENCH_MAX_BASELINE) : 0;
+
+    FILE* csv = NULL;
+    if (output_path) {
+        csv = fopen(output_path, "w");
+        if (!csv) {
+            fprintf(stderr, "无法写入结果文件: %s\n", output_path);
+            return 1;
+        }
+    }
+
+    lv_port_mem_set_hooks(&s_lv_mem_hooks);
+    lv_init();
+    lv_port_mem_init_draw_buf();
+    lv_tick_set_cb(bench_tick);
+
+#if LV_FONT_SIMSUN_16_CJK
+    s_font = &lv_font_simsun_16_cjk;
+#else
+    s_font = LV_FONT_DEFAULT;
+#endif
+    if (glyph_cache) {
+        s_font_cache = lv_port_font_cache_create(s_font, 0);
+        if (s_font_cache) {
+            s_font = s_font_cache;
+        }
+    }
+
+    size_t lvgl_bytes = linx_alloc_get_total(NULL);
+    lv_port_disp_config_t disp_config;
+    lv_port_disp_config_init(&disp_config);
+    disp_config.hor_res = s_width;
+    disp_config.ver_res = s_height;
+    disp_config.buf_lines = buf_lines;
+    disp_config.panel.flush_start = bench_flush_start;
+    s_display = lv_port_disp_create(&disp_config);
+    if (!s_display) {
+        fprintf(stderr, "创建显示失败\n");
+        lv_deinit();
+        if (csv) {
+            fclose(csv);
+        }
+        return 1;
+    }
+    // 空屏渲染一次，之后每个界面的统计只包含它自己的脏区域
+    s_tick_ms += period_ms;
+    lv_timer_handler();
+    size_t display_bytes = linx_alloc_get_total(NULL) - lvgl_bytes;
+
+    printf("界面基准: %dx%d, %d 位色, 缓冲 %u 行, 显示占用 %.1f KB, 每个界面 %u 帧, 每帧 %u 毫秒%s%s\n",
+           (int)s_width, (int)s_height, LV_COLOR_DEPTH, buf_lines ? buf_lines : (uint32_t)s_height / 10,
+           (double)display_bytes / 1024.0, frames, period_ms,
+           s_config_count > 0 ? ", 配置 " : "", s_config_count > 0 ? s_config_name : "");
+    printf("%-20s %8s %8s %8s %8s %9s %7s %7s %9s %8s\n", "界面", "首帧ms", "平均ms", "p95ms", "最大ms",
+           "像素/帧", "占屏", "传输/帧", "峰值KB", baseline_count ? "变化" : "");
+
+    int exit_code = 0;
+    size_t screen_count = sizeof(s_screens) / sizeof(s_screens[0]);
+    for (size_t i = 0; i < screen_count; i++) {
+        const bench_screen_t* screen = &s_screens[i];
+        if (filter && !strstr(screen->name, filter)) {
+            continue;
+        }
+        bench_result_t result;
+        if (!bench_screen(screen, frames, period_ms, &result)) {
+            exit_code = 1;
+            continue;
+        }
+        char name[BENCH_NAME_SIZE];
+        if (s_config_count > 0) {
+            snprintf(name, sizeof(name), "%s@%s", screen->name, s_config_name);
+        } else {
+            snprintf(name, sizeof(name), "%s", screen->name);
+        }
+        report(csv, name, &result, baseline, baseline_count);
+        if (budget_ms > 0 && result.p95_ms > budget_ms) {
+            fprintf(stderr, "%s: p95 帧耗时 %.3f ms 超出预算 %.3f ms\n", name, result.p95_ms, budget_ms);
+            exit_code = 1;
+        }
+    }
+
+    if (s_font_cache) {
+        lv_port_font_cache_stats_t stats;
+        lv_port_font_cache_get_stats(s_font_cache, &stats);
+        printf("字形缓存: 命中 %u, 展开 %u, 淘汰 %u, 位图 %.1f/%.1f KB, 索引 %u 字 %.1f KB\n",
+               (unsigned)stats.hits, (unsigned)stats.misses, (unsigned)stats.evictions,
+               (double)stats.bytes / 1024.0, (double)stats.budget / 1024.0,
+               (unsigned)stats.index_glyphs, (double)stats.index_bytes / 1024.0);
+    }
+
+    lv_port_disp_delete(s_display);
+    lv_port_font_cache_delete(s_font_cache);
+    lv_deinit();
+    free(s_emotion_asset);
+    free(s_camera_frame);
+    if (csv) {
+        fclose(csv);
+    }
+    log_cleanup();
+    return exit_code;
+}